@@ -0,0 +1,253 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+// Benchmarks bundle adjustment on Bundle Adjustment in the Large problems
+// (http://grail.cs.washington.edu/projects/bal/) and Theia reconstructions.
+// Every problem is bundle adjusted with each combination of linear solver,
+// preconditioner (iterative solvers only), number of threads and loss function,
+// always starting from the problem as read from disk. One CSV line is written
+// per run with the number of iterations, the costs and the breakdown of the
+// solve time reported by Ceres, so that runs of different builds (e.g. before
+// and after a Ceres upgrade) can be compared directly. For example:
+//
+//   ./benchmark_bundle_adjustment --bal_files=problem-49-7776-pre.txt
+//     --linear_solver_types=SPARSE_SCHUR,ITERATIVE_SCHUR --num_threads=1,8
+//     --output_csv=ba_benchmark.csv
+
+#include <ceres/ceres.h>
+#include <ceres/version.h>
+#include <gflags/gflags.h>
+#include <glog/logging.h>
+#include <theia/theia.h>
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "applications/command_line_helpers.h"
+
+DEFINE_string(bal_files, "", "Comma-separated BAL problem files.");
+DEFINE_string(reconstructions,
+              "",
+              "Comma-separated Theia reconstruction files.");
+DEFINE_string(linear_solver_types,
+              "SPARSE_SCHUR,ITERATIVE_SCHUR",
+              "Comma-separated Ceres linear solver types.");
+DEFINE_string(preconditioner_types,
+              "SCHUR_JACOBI,CLUSTER_JACOBI",
+              "Comma-separated Ceres preconditioner types. Only used with the "
+              "ITERATIVE_SCHUR and CGNR linear solvers.");
+DEFINE_string(num_threads, "1", "Comma-separated numbers of threads.");
+DEFINE_string(loss_functions,
+              "NONE",
+              "Comma-separated loss functions: NONE, HUBER, SOFTLONE, CAUCHY, "
+              "ARCTAN or TUKEY.");
+DEFINE_double(robust_loss_width,
+              2.0,
+              "Width of the robust loss functions in pixels.");
+DEFINE_string(intrinsics_to_optimize,
+              "NONE",
+              "Camera intrinsics to optimize, see build_reconstruction.");
+DEFINE_int32(max_num_iterations, 50, "Maximum number of iterations per run.");
+DEFINE_string(output_csv,
+              "",
+              "If set, the results are also written to this CSV file.");
+
+namespace {
+
+std::vector<std::string> SplitString(const std::string& list) {
+  std::vector<std::string> items;
+  std::stringstream ss(list);
+  std::string item;
+  while (std::getline(ss, item, ',')) {
+    if (!item.empty()) {
+      items.emplace_back(item);
+    }
+  }
+  return items;
+}
+
+struct BenchmarkProblem {
+  std::string filename;
+  bool is_bal_file;
+};
+
+bool LoadProblem(const BenchmarkProblem& problem,
+                 theia::Reconstruction* reconstruction) {
+  if (problem.is_bal_file) {
+    return theia::ReadBalFile(problem.filename, reconstruction);
+  }
+  return theia::ReadReconstruction(problem.filename, reconstruction);
+}
+
+int NumObservations(const theia::Reconstruction& reconstruction) {
+  int num_observations = 0;
+  for (const theia::TrackId track_id : reconstruction.TrackIds()) {
+    num_observations += reconstruction.Track(track_id)->NumViews();
+  }
+  return num_observations;
+}
+
+bool IsIterativeSolver(const ceres::LinearSolverType linear_solver_type) {
+  return linear_solver_type == ceres::ITERATIVE_SCHUR ||
+         linear_solver_type == ceres::CGNR;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  THEIA_GFLAGS_NAMESPACE::ParseCommandLineFlags(&argc, &argv, true);
+  google::InitGoogleLogging(argv[0]);
+
+  std::vector<BenchmarkProblem> problems;
+  for (const std::string& filename : SplitString(FLAGS_bal_files)) {
+    problems.push_back({filename, true});
+  }
+  for (const std::string& filename : SplitString(FLAGS_reconstructions)) {
+    problems.push_back({filename, false});
+  }
+  CHECK(!problems.empty())
+      << "Please specify --bal_files and/or --reconstructions.";
+
+  std::vector<ceres::LinearSolverType> linear_solver_types;
+  for (const std::string& name : SplitString(FLAGS_linear_solver_types)) {
+    ceres::LinearSolverType linear_solver_type;
+    CHECK(ceres::StringToLinearSolverType(name, &linear_solver_type))
+        << "Invalid linear solver type: " << name;
+    linear_solver_types.emplace_back(linear_solver_type);
+  }
+  std::vector<ceres::PreconditionerType> preconditioner_types;
+  for (const std::string& name : SplitString(FLAGS_preconditioner_types)) {
+    ceres::PreconditionerType preconditioner_type;
+    CHECK(ceres::StringToPreconditionerType(name, &preconditioner_type))
+        << "Invalid preconditioner type: " << name;
+    preconditioner_types.emplace_back(preconditioner_type);
+  }
+  std::vector<int> num_threads;
+  for (const std::string& value : SplitString(FLAGS_num_threads)) {
+    num_threads.emplace_back(std::stoi(value));
+    CHECK_GT(num_threads.back(), 0);
+  }
+  const std::vector<std::string> loss_functions =
+      SplitString(FLAGS_loss_functions);
+  CHECK(!linear_solver_types.empty() && !preconditioner_types.empty() &&
+        !num_threads.empty() && !loss_functions.empty());
+
+  std::ofstream csv_file;
+  if (!FLAGS_output_csv.empty()) {
+    csv_file.open(FLAGS_output_csv.c_str());
+    CHECK(csv_file.is_open()) << "Cannot write to " << FLAGS_output_csv;
+  }
+  const auto write_line = [&](const std::string& line) {
+    printf("%s\n", line.c_str());
+    fflush(stdout);
+    if (csv_file.is_open()) {
+      csv_file << line << std::endl;
+    }
+  };
+
+  write_line(
+      "ceres_version,problem,num_views,num_tracks,num_observations,"
+      "linear_solver,preconditioner,num_threads,loss_function,success,"
+      "num_iterations,initial_cost,final_cost,setup_time_in_seconds,"
+      "solve_time_in_seconds,time_per_iteration_in_seconds,"
+      "residual_evaluation_time_in_seconds,"
+      "jacobian_evaluation_time_in_seconds,linear_solver_time_in_seconds");
+
+  for (const BenchmarkProblem& problem : problems) {
+    for (const ceres::LinearSolverType linear_solver_type :
+         linear_solver_types) {
+      // Direct solvers ignore the preconditioner and are run only once.
+      const int num_preconditioners = IsIterativeSolver(linear_solver_type)
+                                          ? preconditioner_types.size()
+                                          : 1;
+      for (int p = 0; p < num_preconditioners; p++) {
+        for (const int threads : num_threads) {
+          for (const std::string& loss_function : loss_functions) {
+            theia::Reconstruction reconstruction;
+            CHECK(LoadProblem(problem, &reconstruction))
+                << "Could not read " << problem.filename;
+
+            theia::BundleAdjustmentOptions options;
+            options.linear_solver_type = linear_solver_type;
+            options.preconditioner_type = preconditioner_types[p];
+            options.num_threads = threads;
+            options.loss_function_type = StringToLossFunction(loss_function);
+            options.robust_loss_width = FLAGS_robust_loss_width;
+            options.intrinsics_to_optimize =
+                StringToOptimizeIntrinsicsType(FLAGS_intrinsics_to_optimize);
+            options.max_num_iterations = FLAGS_max_num_iterations;
+            options.use_inner_iterations = false;
+
+            const theia::BundleAdjustmentSummary summary =
+                theia::BundleAdjustReconstruction(options, &reconstruction);
+
+            const std::string preconditioner =
+                IsIterativeSolver(linear_solver_type)
+                    ? ceres::PreconditionerTypeToString(
+                          preconditioner_types[p])
+                    : "NONE";
+            write_line(theia::StringPrintf(
+                "%s,%s,%d,%d,%d,%s,%s,%d,%s,%d,%d,%.10e,%.10e,%.6f,%.6f,%.6f,"
+                "%.6f,%.6f,%.6f",
+                CERES_VERSION_STRING,
+                problem.filename.c_str(),
+                reconstruction.NumViews(),
+                reconstruction.NumTracks(),
+                NumObservations(reconstruction),
+                ceres::LinearSolverTypeToString(linear_solver_type),
+                preconditioner.c_str(),
+                threads,
+                loss_function.c_str(),
+                summary.success ? 1 : 0,
+                summary.num_iterations,
+                summary.initial_cost,
+                summary.final_cost,
+                summary.setup_time_in_seconds,
+                summary.solve_time_in_seconds,
+                summary.num_iterations > 0
+                    ? summary.solve_time_in_seconds / summary.num_iterations
+                    : 0.0,
+                summary.residual_evaluation_time_in_seconds,
+                summary.jacobian_evaluation_time_in_seconds,
+                summary.linear_solver_time_in_seconds));
+          }
+        }
+      }
+    }
+  }
+  return 0;
+}
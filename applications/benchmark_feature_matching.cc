@@ -0,0 +1,424 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+// Throughput benchmarks for the feature matching pipeline: the descriptor
+// distance kernels, cascade hashing, brute force matching and end-to-end
+// FeatureMatcher::MatchImages over the available databases. Each benchmark is
+// repeated until it ran for at least --min_time_in_seconds and reports the
+// time per iteration, the throughput in descriptors/sec or pairs/sec and the
+// peak resident set size of the process so far. Results are written in a
+// column format that is easy to diff between runs and machines, e.g.:
+//
+//   ./benchmark_feature_matching --feature_counts=1000,8000 \
+//       --benchmark_filter=BruteForce
+
+#include <gflags/gflags.h>
+#include <glog/logging.h>
+#include <sys/resource.h>
+#include <theia/theia.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+DEFINE_double(min_time_in_seconds,
+              0.5,
+              "Minimum time each benchmark is repeated for.");
+DEFINE_string(feature_counts,
+              "1000,4000,8000",
+              "Comma-separated numbers of features per image.");
+DEFINE_int32(num_images,
+             8,
+             "Number of images used by the end-to-end MatchImages "
+             "benchmarks. All pairs are matched.");
+DEFINE_int32(num_threads, 1, "Number of threads to use for matching.");
+DEFINE_string(benchmark_filter,
+              "",
+              "Only benchmarks whose name contains this string are run.");
+DEFINE_string(rocksdb_directory,
+              "",
+              "Directory of a scratch RocksDB database. If set (and Theia was "
+              "built with RocksDB), MatchImages is also benchmarked against "
+              "RocksDbFeaturesAndMatchesDatabase. Any existing matches in the "
+              "database are removed.");
+
+namespace {
+
+using theia::CascadeHasher;
+using theia::DescriptorMatrix;
+using theia::FeatureMatcher;
+using theia::FeatureMatcherOptions;
+using theia::FeaturesAndMatchesDatabase;
+using theia::HashedImage;
+using theia::IndexedFeatureMatch;
+using theia::Keypoint;
+using theia::KeypointsAndDescriptors;
+using theia::MatchingStrategy;
+using theia::RandomNumberGenerator;
+
+static const int kSiftDimension = 128;
+static const int kAkazeDescriptorSizeInBytes = 61;
+
+// Returns the peak resident set size of the process in megabytes.
+double PeakResidentSetSizeInMb() {
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) != 0) {
+    return 0.0;
+  }
+#ifdef __APPLE__
+  // Reported in bytes on macOS and in kilobytes everywhere else.
+  return usage.ru_maxrss / (1024.0 * 1024.0);
+#else
+  return usage.ru_maxrss / 1024.0;
+#endif
+}
+
+// Runs the benchmark repeatedly, doubling the number of iterations until the
+// total time exceeds --min_time_in_seconds, and prints the result. Each
+// iteration processes items_per_iteration items of the given unit.
+void RunBenchmark(const std::string& name,
+                  const double items_per_iteration,
+                  const std::string& unit,
+                  const std::function<void()>& benchmark) {
+  if (name.find(FLAGS_benchmark_filter) == std::string::npos) {
+    return;
+  }
+
+  // Warm up caches and lazily initialized state.
+  benchmark();
+
+  int num_iterations = 1;
+  double elapsed_time = 0.0;
+  while (true) {
+    theia::Timer timer;
+    for (int i = 0; i < num_iterations; i++) {
+      benchmark();
+    }
+    elapsed_time = timer.ElapsedTimeInSeconds();
+    if (elapsed_time >= FLAGS_min_time_in_seconds ||
+        num_iterations >= (1 << 30)) {
+      break;
+    }
+    num_iterations *= 2;
+  }
+
+  const double time_per_iteration = elapsed_time / num_iterations;
+  printf("%-48s %10d %14.4f ms %14.4g %-15s %10.1f MB\n",
+         name.c_str(),
+         num_iterations,
+         1e3 * time_per_iteration,
+         items_per_iteration / time_per_iteration,
+         (unit + "/sec").c_str(),
+         PeakResidentSetSizeInMb());
+  fflush(stdout);
+}
+
+// Creates unit-norm, non-negative SIFT-like descriptors.
+DescriptorMatrix RandomSiftDescriptors(const int num_descriptors,
+                                       RandomNumberGenerator* rng) {
+  DescriptorMatrix descriptors(num_descriptors, kSiftDimension);
+  for (int i = 0; i < num_descriptors; i++) {
+    for (int j = 0; j < kSiftDimension; j++) {
+      descriptors(i, j) = rng->RandFloat(0.0f, 1.0f);
+    }
+    descriptors.row(i).normalize();
+  }
+  return descriptors;
+}
+
+// Creates descriptors that are noisy copies of a random subset of the shared
+// descriptors, so that images of the same synthetic scene have true matches.
+KeypointsAndDescriptors RandomImageFeatures(const std::string& image_name,
+                                            const DescriptorMatrix& scene,
+                                            const int num_features,
+                                            RandomNumberGenerator* rng) {
+  KeypointsAndDescriptors features;
+  features.image_name = image_name;
+  features.keypoints.reserve(num_features);
+  features.descriptor_matrix.resize(num_features, scene.cols());
+  for (int i = 0; i < num_features; i++) {
+    features.keypoints.emplace_back(rng->RandFloat(0.0f, 1920.0f),
+                                    rng->RandFloat(0.0f, 1080.0f),
+                                    Keypoint::OTHER);
+    features.descriptor_matrix.row(i) =
+        scene.row(rng->RandInt(0, scene.rows() - 1));
+    for (int j = 0; j < scene.cols(); j++) {
+      features.descriptor_matrix(i, j) += rng->RandGaussian(0.0, 0.01);
+    }
+    features.descriptor_matrix.row(i).normalize();
+  }
+  return features;
+}
+
+std::vector<int> ParseFeatureCounts(const std::string& feature_counts) {
+  std::vector<int> counts;
+  std::stringstream ss(feature_counts);
+  std::string count;
+  while (std::getline(ss, count, ',')) {
+    counts.emplace_back(std::stoi(count));
+    CHECK_GT(counts.back(), 1) << "Feature counts must be greater than 1.";
+  }
+  return counts;
+}
+
+std::string StrategyName(const MatchingStrategy strategy) {
+  switch (strategy) {
+    case MatchingStrategy::BRUTE_FORCE:
+      return "BruteForce";
+    case MatchingStrategy::CASCADE_HASHING:
+      return "CascadeHashing";
+    case MatchingStrategy::KD_TREE:
+      return "KdTree";
+    default:
+      return "BinaryLsh";
+  }
+}
+
+void BenchmarkDistanceKernels(const int num_descriptors) {
+  RandomNumberGenerator rng(59);
+  const DescriptorMatrix descriptors =
+      RandomSiftDescriptors(num_descriptors, &rng);
+
+  KeypointsAndDescriptors quantized;
+  quantized.descriptor_matrix = descriptors;
+  quantized.QuantizeDescriptors(theia::kDefaultDescriptorQuantizationScale);
+
+  theia::BinaryDescriptorMatrix binary_descriptors(num_descriptors,
+                                                   kAkazeDescriptorSizeInBytes);
+  for (int i = 0; i < binary_descriptors.size(); i++) {
+    binary_descriptors.data()[i] = static_cast<uint8_t>(rng.RandInt(0, 255));
+  }
+
+  // Each iteration compares the first descriptor against all others, which
+  // is the access pattern of the brute force matcher.
+  const std::string suffix = "/" + std::to_string(num_descriptors);
+  volatile float l2_sink = 0.0f;
+  RunBenchmark(
+      "Distance/L2/128" + suffix, num_descriptors, "descriptors", [&]() {
+        float sum = 0.0f;
+        for (int i = 0; i < num_descriptors; i++) {
+          sum += theia::SquaredL2Distance(descriptors.row(0).data(),
+                                          descriptors.row(i).data(),
+                                          kSiftDimension);
+        }
+        l2_sink = sum;
+      });
+
+  volatile int quantized_sink = 0;
+  RunBenchmark(
+      "Distance/QuantizedL2/128" + suffix,
+      num_descriptors,
+      "descriptors",
+      [&]() {
+        int sum = 0;
+        for (int i = 0; i < num_descriptors; i++) {
+          sum += theia::QuantizedSquaredL2Distance(
+              quantized.quantized_descriptor_matrix.row(0).data(),
+              quantized.quantized_descriptor_matrix.row(i).data(),
+              kSiftDimension);
+        }
+        quantized_sink = sum;
+      });
+
+  volatile int hamming_sink = 0;
+  RunBenchmark(
+      "Distance/Hamming/61" + suffix, num_descriptors, "descriptors", [&]() {
+        int sum = 0;
+        for (int i = 0; i < num_descriptors; i++) {
+          sum += theia::HammingDistance(binary_descriptors.row(0).data(),
+                                        binary_descriptors.row(i).data(),
+                                        kAkazeDescriptorSizeInBytes);
+        }
+        hamming_sink = sum;
+      });
+}
+
+void BenchmarkCascadeHasher(const int num_features) {
+  std::shared_ptr<RandomNumberGenerator> rng =
+      std::make_shared<RandomNumberGenerator>(61);
+  const DescriptorMatrix scene =
+      RandomSiftDescriptors(2 * num_features, rng.get());
+  const KeypointsAndDescriptors features1 =
+      RandomImageFeatures("1", scene, num_features, rng.get());
+  const KeypointsAndDescriptors features2 =
+      RandomImageFeatures("2", scene, num_features, rng.get());
+
+  CascadeHasher hasher(rng);
+  CHECK(hasher.Initialize(kSiftDimension));
+
+  const std::string suffix = "/" + std::to_string(num_features);
+  RunBenchmark(
+      "CascadeHasher/Hash" + suffix, num_features, "descriptors", [&]() {
+        const HashedImage hashed_image =
+            hasher.CreateHashedSiftDescriptors(features1.descriptor_matrix);
+        CHECK_EQ(hashed_image.hashed_desc.size(), num_features);
+      });
+
+  const HashedImage hashed_image1 =
+      hasher.CreateHashedSiftDescriptors(features1.descriptor_matrix);
+  const HashedImage hashed_image2 =
+      hasher.CreateHashedSiftDescriptors(features2.descriptor_matrix);
+  RunBenchmark("CascadeHasher/Match" + suffix, 1, "pairs", [&]() {
+    std::vector<IndexedFeatureMatch> matches;
+    hasher.MatchImages(hashed_image1,
+                       features1.descriptor_matrix,
+                       hashed_image2,
+                       features2.descriptor_matrix,
+                       0.8,
+                       &matches);
+  });
+}
+
+// Matches all pairs of the images in the database with a new matcher every
+// iteration, so that no state is reused between iterations except for what
+// the database itself keeps.
+void BenchmarkMatchImages(const std::string& name,
+                          const MatchingStrategy strategy,
+                          const std::vector<std::string>& image_names,
+                          const int num_features,
+                          FeaturesAndMatchesDatabase* database) {
+  FeatureMatcherOptions options;
+  options.num_threads = FLAGS_num_threads;
+  options.perform_geometric_verification = false;
+  options.min_num_feature_matches = 0;
+  // Hashed images would otherwise be reused across iterations.
+  options.store_hashed_images_in_database = false;
+
+  const int num_pairs = image_names.size() * (image_names.size() - 1) / 2;
+  const std::string benchmark_name = name + "/" + StrategyName(strategy) + "/" +
+                                     std::to_string(image_names.size()) + "x" +
+                                     std::to_string(num_features);
+  RunBenchmark(benchmark_name, num_pairs, "pairs", [&]() {
+    database->RemoveAllMatches();
+    std::unique_ptr<FeatureMatcher> matcher =
+        theia::CreateFeatureMatcher(strategy, options, database);
+    matcher->AddImages(image_names);
+    matcher->MatchImages();
+  });
+}
+
+void BenchmarkFeatureMatchers(const int num_features,
+                              FeaturesAndMatchesDatabase* in_memory_database,
+                              FeaturesAndMatchesDatabase* rocksdb_database) {
+  RandomNumberGenerator rng(67);
+  const DescriptorMatrix scene = RandomSiftDescriptors(2 * num_features, &rng);
+
+  // A single pair for the per-matcher benchmarks and all images for the
+  // end-to-end benchmarks.
+  std::vector<std::string> image_names;
+  for (int i = 0; i < std::max(2, FLAGS_num_images); i++) {
+    image_names.emplace_back("image_" + std::to_string(num_features) + "_" +
+                             std::to_string(i));
+    const KeypointsAndDescriptors features =
+        RandomImageFeatures(image_names.back(), scene, num_features, &rng);
+    in_memory_database->PutFeatures(image_names.back(), features);
+    if (rocksdb_database != nullptr) {
+      rocksdb_database->PutFeatures(image_names.back(), features);
+    }
+  }
+  const std::vector<std::string> image_pair(image_names.begin(),
+                                            image_names.begin() + 2);
+
+  BenchmarkMatchImages("BruteForce",
+                       MatchingStrategy::BRUTE_FORCE,
+                       image_pair,
+                       num_features,
+                       in_memory_database);
+  BenchmarkMatchImages("MatchImages/InMemory",
+                       MatchingStrategy::CASCADE_HASHING,
+                       image_names,
+                       num_features,
+                       in_memory_database);
+  BenchmarkMatchImages("MatchImages/InMemory",
+                       MatchingStrategy::KD_TREE,
+                       image_names,
+                       num_features,
+                       in_memory_database);
+  if (rocksdb_database != nullptr) {
+    BenchmarkMatchImages("MatchImages/RocksDb",
+                         MatchingStrategy::CASCADE_HASHING,
+                         image_names,
+                         num_features,
+                         rocksdb_database);
+    BenchmarkMatchImages("MatchImages/RocksDb",
+                         MatchingStrategy::KD_TREE,
+                         image_names,
+                         num_features,
+                         rocksdb_database);
+  }
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  THEIA_GFLAGS_NAMESPACE::ParseCommandLineFlags(&argc, &argv, true);
+  google::InitGoogleLogging(argv[0]);
+
+  std::unique_ptr<FeaturesAndMatchesDatabase> rocksdb_database;
+  if (!FLAGS_rocksdb_directory.empty()) {
+#ifdef WITH_ROCKSDB
+    rocksdb_database.reset(
+        new theia::RocksDbFeaturesAndMatchesDatabase(FLAGS_rocksdb_directory));
+#else
+    LOG(WARNING) << "Theia was built without RocksDB. Skipping the RocksDB "
+                    "benchmarks.";
+#endif
+  }
+
+  printf("%-48s %10s %17s %30s %13s\n",
+         "Benchmark",
+         "Iterations",
+         "Time",
+         "Throughput",
+         "Peak RSS");
+  const std::vector<int> feature_counts =
+      ParseFeatureCounts(FLAGS_feature_counts);
+  for (const int num_features : feature_counts) {
+    BenchmarkDistanceKernels(num_features);
+  }
+  for (const int num_features : feature_counts) {
+    BenchmarkCascadeHasher(num_features);
+  }
+  for (const int num_features : feature_counts) {
+    theia::InMemoryFeaturesAndMatchesDatabase in_memory_database;
+    BenchmarkFeatureMatchers(
+        num_features, &in_memory_database, rocksdb_database.get());
+  }
+  return 0;
+}
@@ -0,0 +1,566 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+
+// Benchmarks the full reconstruction pipeline on one workload: feature
+// extraction, feature matching, geometric verification, track building and
+// the reconstruction with each of the requested ReconstructionEstimatorTypes.
+// The workload is either a directory of images or a synthetic scene of cameras
+// on a ring around a point cloud, whose features are generated directly (so
+// extraction is skipped). The whole pipeline is run once for each of the
+// --thread_counts, and the wall time, CPU time, throughput, thread utilization
+// and peak resident set size of every stage is written as JSON, so that runs
+// of different releases or machines on the same workload can be compared:
+//
+//   ./benchmark_pipeline --num_views=50 --thread_counts=1,2,4,8 \
+//       --output_json=pipeline.json
+//
+// Thread utilization is the CPU time of the process during the stage divided
+// by the wall time and the number of threads, so 1.0 means that all threads
+// were busy for the whole stage.
+
+#include <gflags/gflags.h>
+#include <glog/logging.h>
+#include <sys/resource.h>
+#include <theia/theia.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>  // NOLINT
+#include <utility>
+#include <vector>
+
+#include "applications/command_line_helpers.h"
+
+DEFINE_string(images,
+              "",
+              "Wildcard of the images to benchmark on, e.g. "
+              "/home/my_username/my_images/*.jpg. If empty, a synthetic "
+              "scene is generated instead.");
+DEFINE_int32(num_views, 32, "Number of views of the synthetic scene.");
+DEFINE_int32(num_points, 4000, "Number of 3D points of the synthetic scene.");
+DEFINE_int32(num_clutter_features,
+             500,
+             "Number of features per synthetic view that do not belong to "
+             "any 3D point.");
+DEFINE_double(pixel_noise,
+              0.5,
+              "Standard deviation of the noise added to the synthetic "
+              "keypoints in pixels.");
+DEFINE_string(thread_counts,
+              "1",
+              "Comma-separated numbers of threads. The whole pipeline is run "
+              "once with each of them.");
+DEFINE_string(reconstruction_estimators,
+              "GLOBAL,INCREMENTAL,HYBRID,HIERARCHICAL",
+              "Comma-separated reconstruction estimator types to benchmark.");
+DEFINE_string(matching_strategy,
+              "CASCADE_HASHING",
+              "Strategy used to match features. Must be BRUTE_FORCE, "
+              "CASCADE_HASHING or KD_TREE.");
+DEFINE_string(output_json,
+              "",
+              "If set, the results are written to this file instead of "
+              "stdout.");
+
+namespace {
+
+using theia::CameraIntrinsicsPrior;
+using theia::DescriptorMatrix;
+using theia::FeatureMatcher;
+using theia::FeatureMatcherOptions;
+using theia::InMemoryFeaturesAndMatchesDatabase;
+using theia::Keypoint;
+using theia::KeypointsAndDescriptors;
+using theia::RandomNumberGenerator;
+using theia::Reconstruction;
+using theia::ReconstructionBuilder;
+using theia::ReconstructionBuilderOptions;
+
+static const int kSiftDimension = 128;
+static const int kSyntheticImageWidth = 1920;
+static const int kSyntheticImageHeight = 1080;
+static const double kSyntheticFocalLength = 1500.0;
+
+std::vector<std::string> SplitString(const std::string& list) {
+  std::vector<std::string> items;
+  std::stringstream ss(list);
+  std::string item;
+  while (std::getline(ss, item, ',')) {
+    if (!item.empty()) {
+      items.emplace_back(item);
+    }
+  }
+  return items;
+}
+
+// Returns the peak resident set size of the process in megabytes.
+double PeakResidentSetSizeInMb() {
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) != 0) {
+    return 0.0;
+  }
+#ifdef __APPLE__
+  // Reported in bytes on macOS and in kilobytes everywhere else.
+  return usage.ru_maxrss / (1024.0 * 1024.0);
+#else
+  return usage.ru_maxrss / 1024.0;
+#endif
+}
+
+// Returns the user and system CPU time of all threads of the process.
+double ProcessCpuTimeInSeconds() {
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) != 0) {
+    return 0.0;
+  }
+  return usage.ru_utime.tv_sec + usage.ru_stime.tv_sec +
+         1e-6 * (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec);
+}
+
+// The images of the workload. For synthetic workloads the features are
+// generated up front and the extraction stage is skipped.
+struct Workload {
+  std::vector<std::string> image_filepaths;
+  std::vector<std::string> image_names;
+  std::vector<CameraIntrinsicsPrior> intrinsics_priors;
+  std::vector<KeypointsAndDescriptors> features;
+  bool is_synthetic = false;
+};
+
+struct StageResult {
+  std::string name;
+  double wall_time_in_seconds = 0.0;
+  double cpu_time_in_seconds = 0.0;
+  double num_items = 0.0;
+  std::string unit;
+  double peak_rss_in_mb = 0.0;
+  // Stage-specific counts, e.g. the number of estimated views.
+  std::vector<std::pair<std::string, double> > counts;
+  bool skipped = false;
+};
+
+// Measures the wall and CPU time from its construction to Finish.
+class StageTimer {
+ public:
+  StageTimer() : start_cpu_time_(ProcessCpuTimeInSeconds()) {}
+
+  StageResult Finish(const std::string& name,
+                     const double num_items,
+                     const std::string& unit) {
+    StageResult result;
+    result.name = name;
+    result.wall_time_in_seconds = timer_.ElapsedTimeInSeconds();
+    result.cpu_time_in_seconds = ProcessCpuTimeInSeconds() - start_cpu_time_;
+    result.num_items = num_items;
+    result.unit = unit;
+    result.peak_rss_in_mb = PeakResidentSetSizeInMb();
+    return result;
+  }
+
+ private:
+  theia::Timer timer_;
+  const double start_cpu_time_;
+};
+
+// Creates unit-norm, non-negative SIFT-like descriptors.
+DescriptorMatrix RandomSiftDescriptors(const int num_descriptors,
+                                       RandomNumberGenerator* rng) {
+  DescriptorMatrix descriptors(num_descriptors, kSiftDimension);
+  for (int i = 0; i < num_descriptors; i++) {
+    for (int j = 0; j < kSiftDimension; j++) {
+      descriptors(i, j) = rng->RandFloat(0.0f, 1.0f);
+    }
+    descriptors.row(i).normalize();
+  }
+  return descriptors;
+}
+
+// Places the cameras on a ring around a cube of random points, all looking at
+// the center of the cube. Every point has a descriptor and each view observes
+// a noisy copy of it at the noisy projection of the point, plus random clutter
+// features, so that matching and geometric verification do real work.
+Workload CreateSyntheticWorkload() {
+  CHECK_GE(FLAGS_num_views, 2);
+  RandomNumberGenerator rng(73);
+
+  std::vector<Eigen::Vector4d> points(FLAGS_num_points);
+  for (Eigen::Vector4d& point : points) {
+    point = Eigen::Vector4d(rng.RandDouble(-3.0, 3.0),
+                            rng.RandDouble(-3.0, 3.0),
+                            rng.RandDouble(-3.0, 3.0),
+                            1.0);
+  }
+  const DescriptorMatrix point_descriptors =
+      RandomSiftDescriptors(FLAGS_num_points, &rng);
+  const DescriptorMatrix clutter_descriptors =
+      RandomSiftDescriptors(FLAGS_num_clutter_features, &rng);
+
+  Workload workload;
+  workload.is_synthetic = true;
+  for (int i = 0; i < FLAGS_num_views; i++) {
+    // The ring covers half a circle so that neighboring views overlap while
+    // the views at its ends see the scene from opposite sides.
+    const double angle = M_PI * i / FLAGS_num_views;
+    const Eigen::Vector3d position(10.0 * std::cos(angle),
+                                   rng.RandDouble(-1.0, 1.0),
+                                   10.0 * std::sin(angle));
+    const Eigen::Vector3d z_axis = -position.normalized();
+    const Eigen::Vector3d x_axis =
+        Eigen::Vector3d(0.0, -1.0, 0.0).cross(z_axis).normalized();
+    Eigen::Matrix3d rotation;
+    rotation.row(0) = x_axis;
+    rotation.row(1) = z_axis.cross(x_axis);
+    rotation.row(2) = z_axis;
+
+    theia::Camera camera;
+    camera.SetFocalLength(kSyntheticFocalLength);
+    camera.SetPrincipalPoint(kSyntheticImageWidth / 2.0,
+                             kSyntheticImageHeight / 2.0);
+    camera.SetImageSize(kSyntheticImageWidth, kSyntheticImageHeight);
+    camera.SetPosition(position);
+    camera.SetOrientationFromRotationMatrix(rotation);
+
+    KeypointsAndDescriptors features;
+    features.image_name = theia::StringPrintf("view_%05d.jpg", i);
+    std::vector<int> descriptor_rows;
+    for (int j = 0; j < points.size(); j++) {
+      Eigen::Vector2d pixel;
+      if (camera.ProjectPoint(points[j], &pixel) <= 0.0 || pixel.x() < 0.0 ||
+          pixel.y() < 0.0 || pixel.x() >= kSyntheticImageWidth ||
+          pixel.y() >= kSyntheticImageHeight) {
+        continue;
+      }
+      features.keypoints.emplace_back(
+          pixel.x() + rng.RandGaussian(0.0, FLAGS_pixel_noise),
+          pixel.y() + rng.RandGaussian(0.0, FLAGS_pixel_noise),
+          Keypoint::OTHER);
+      descriptor_rows.emplace_back(j);
+    }
+    const int num_point_features = descriptor_rows.size();
+    for (int j = 0; j < FLAGS_num_clutter_features; j++) {
+      features.keypoints.emplace_back(
+          rng.RandDouble(0.0, kSyntheticImageWidth),
+          rng.RandDouble(0.0, kSyntheticImageHeight),
+          Keypoint::OTHER);
+    }
+
+    features.descriptor_matrix.resize(features.keypoints.size(),
+                                      kSiftDimension);
+    for (int j = 0; j < features.keypoints.size(); j++) {
+      features.descriptor_matrix.row(j) =
+          j < num_point_features
+              ? point_descriptors.row(descriptor_rows[j])
+              : clutter_descriptors.row(j - num_point_features);
+      for (int k = 0; k < kSiftDimension; k++) {
+        features.descriptor_matrix(j, k) += rng.RandGaussian(0.0, 0.01);
+      }
+      features.descriptor_matrix.row(j).normalize();
+    }
+
+    CameraIntrinsicsPrior prior;
+    prior.image_width = kSyntheticImageWidth;
+    prior.image_height = kSyntheticImageHeight;
+    prior.focal_length.is_set = true;
+    prior.focal_length.value[0] = kSyntheticFocalLength;
+    prior.principal_point.is_set = true;
+    prior.principal_point.value[0] = kSyntheticImageWidth / 2.0;
+    prior.principal_point.value[1] = kSyntheticImageHeight / 2.0;
+
+    workload.image_names.emplace_back(features.image_name);
+    workload.intrinsics_priors.emplace_back(prior);
+    workload.features.emplace_back(std::move(features));
+  }
+  return workload;
+}
+
+Workload CreateWorkloadFromImages() {
+  Workload workload;
+  CHECK(theia::GetFilepathsFromWildcard(FLAGS_images,
+                                        &workload.image_filepaths))
+      << "Could not find images that matched the filepath: " << FLAGS_images;
+  CHECK_GE(workload.image_filepaths.size(), 2);
+
+  // Reading the EXIF data is not part of the benchmark.
+  theia::ExifReader exif_reader;
+  for (const std::string& image_filepath : workload.image_filepaths) {
+    std::string image_name;
+    CHECK(theia::GetFilenameFromFilepath(image_filepath, true, &image_name));
+    CameraIntrinsicsPrior prior;
+    CHECK(exif_reader.ExtractEXIFMetadata(image_filepath, &prior))
+        << "Could not read " << image_filepath;
+    workload.image_names.emplace_back(image_name);
+    workload.intrinsics_priors.emplace_back(prior);
+  }
+  return workload;
+}
+
+// Extracts the features of the workload images into the database, or copies
+// the synthetic features into it.
+StageResult ExtractFeatures(const Workload& workload,
+                            const int num_threads,
+                            InMemoryFeaturesAndMatchesDatabase* database) {
+  for (int i = 0; i < workload.image_names.size(); i++) {
+    database->PutCameraIntrinsicsPrior(workload.image_names[i],
+                                       workload.intrinsics_priors[i]);
+  }
+  if (workload.is_synthetic) {
+    for (const KeypointsAndDescriptors& features : workload.features) {
+      database->PutFeatures(features.image_name, features);
+    }
+    StageResult result = StageTimer().Finish(
+        "extraction", workload.image_names.size(), "images");
+    result.skipped = true;
+    return result;
+  }
+
+  StageTimer timer;
+  theia::FeatureExtractor::Options options;
+  options.num_threads = num_threads;
+  theia::FeatureExtractor extractor(options);
+  std::vector<std::vector<Keypoint> > keypoints;
+  std::vector<std::vector<Eigen::VectorXf> > descriptors;
+  CHECK(extractor.Extract(workload.image_filepaths, &keypoints, &descriptors));
+  int num_features = 0;
+  for (int i = 0; i < workload.image_names.size(); i++) {
+    KeypointsAndDescriptors features;
+    features.image_name = workload.image_names[i];
+    features.keypoints = keypoints[i];
+    features.SetDescriptors(descriptors[i]);
+    num_features += features.keypoints.size();
+    database->PutFeatures(features.image_name, features);
+  }
+  StageResult result =
+      timer.Finish("extraction", workload.image_names.size(), "images");
+  result.counts.emplace_back("num_features", num_features);
+  return result;
+}
+
+// Matches all image pairs, with or without geometric verification.
+void MatchAllPairs(const std::vector<std::string>& image_names,
+                   const int num_threads,
+                   const bool perform_geometric_verification,
+                   InMemoryFeaturesAndMatchesDatabase* database) {
+  FeatureMatcherOptions options;
+  options.num_threads = num_threads;
+  options.perform_geometric_verification = perform_geometric_verification;
+  database->RemoveAllMatches();
+  std::unique_ptr<FeatureMatcher> matcher = theia::CreateFeatureMatcher(
+      StringToMatchingStrategyType(FLAGS_matching_strategy), options, database);
+  matcher->AddImages(image_names);
+  matcher->MatchImages();
+}
+
+// Geometric verification runs inside of the matcher, so its cost is measured
+// as the difference between matching with and without verification.
+std::vector<StageResult> MatchAndVerifyFeatures(
+    const Workload& workload,
+    const int num_threads,
+    InMemoryFeaturesAndMatchesDatabase* database) {
+  const int num_pairs =
+      workload.image_names.size() * (workload.image_names.size() - 1) / 2;
+
+  StageTimer matching_timer;
+  MatchAllPairs(workload.image_names, num_threads, false, database);
+  StageResult matching = matching_timer.Finish("matching", num_pairs, "pairs");
+  matching.counts.emplace_back("num_matched_pairs", database->NumMatches());
+
+  StageTimer verification_timer;
+  MatchAllPairs(workload.image_names, num_threads, true, database);
+  StageResult verification =
+      verification_timer.Finish("verification", num_pairs, "pairs");
+  verification.wall_time_in_seconds = std::max(
+      0.0, verification.wall_time_in_seconds - matching.wall_time_in_seconds);
+  verification.cpu_time_in_seconds = std::max(
+      0.0, verification.cpu_time_in_seconds - matching.cpu_time_in_seconds);
+  verification.counts.emplace_back("num_verified_pairs",
+                                   database->NumMatches());
+  return {matching, verification};
+}
+
+// Builds the tracks from the verified matches and estimates the reconstruction
+// with the given estimator type.
+std::vector<StageResult> Reconstruct(
+    const Workload& workload,
+    const std::string& estimator_name,
+    const int num_threads,
+    InMemoryFeaturesAndMatchesDatabase* database) {
+  ReconstructionBuilderOptions options;
+  options.num_threads = num_threads;
+  options.reconstruction_estimator_options.num_threads = num_threads;
+  options.reconstruction_estimator_options.reconstruction_estimator_type =
+      StringToReconstructionEstimatorType(estimator_name);
+
+  StageTimer track_timer;
+  ReconstructionBuilder builder(options, database);
+  for (int i = 0; i < workload.image_names.size(); i++) {
+    CHECK(builder.AddImageWithCameraIntrinsicsPrior(
+        workload.image_names[i], workload.intrinsics_priors[i], 0.0));
+  }
+  const auto match_keys = database->ImageNamesOfMatches();
+  for (const auto& match_key : match_keys) {
+    CHECK(builder.AddTwoViewMatch(
+        match_key.first,
+        match_key.second,
+        database->GetImagePairMatch(match_key.first, match_key.second)));
+  }
+  const StageResult track_building = track_timer.Finish(
+      "track_building/" + estimator_name, match_keys.size(), "pairs");
+
+  StageTimer reconstruction_timer;
+  std::vector<Reconstruction*> reconstructions;
+  const bool success = builder.BuildReconstruction(&reconstructions);
+  std::vector<std::unique_ptr<Reconstruction> > owned_reconstructions(
+      reconstructions.begin(), reconstructions.end());
+  StageResult reconstruction = reconstruction_timer.Finish(
+      "reconstruction/" + estimator_name, workload.image_names.size(), "views");
+
+  int num_estimated_views = 0;
+  int num_estimated_tracks = 0;
+  for (const auto& estimated_reconstruction : owned_reconstructions) {
+    num_estimated_views +=
+        theia::NumEstimatedViews(*estimated_reconstruction);
+    num_estimated_tracks +=
+        theia::NumEstimatedTracks(*estimated_reconstruction);
+  }
+  reconstruction.counts.emplace_back("success", success ? 1 : 0);
+  reconstruction.counts.emplace_back("num_reconstructions",
+                                     owned_reconstructions.size());
+  reconstruction.counts.emplace_back("num_estimated_views",
+                                     num_estimated_views);
+  reconstruction.counts.emplace_back("num_estimated_tracks",
+                                     num_estimated_tracks);
+  return {track_building, reconstruction};
+}
+
+std::string StageToJson(const StageResult& stage, const int num_threads) {
+  const double throughput =
+      stage.wall_time_in_seconds > 0.0
+          ? stage.num_items / stage.wall_time_in_seconds
+          : 0.0;
+  const double utilization =
+      stage.wall_time_in_seconds > 0.0
+          ? stage.cpu_time_in_seconds /
+                (stage.wall_time_in_seconds * num_threads)
+          : 0.0;
+  std::string json = theia::StringPrintf(
+      "{\"name\": \"%s\", \"skipped\": %s, \"wall_time_in_seconds\": %.6f, "
+      "\"cpu_time_in_seconds\": %.6f, \"num_items\": %.0f, \"unit\": \"%s\", "
+      "\"throughput_per_second\": %.6g, \"thread_utilization\": %.4f, "
+      "\"peak_rss_in_mb\": %.1f",
+      stage.name.c_str(),
+      stage.skipped ? "true" : "false",
+      stage.wall_time_in_seconds,
+      stage.cpu_time_in_seconds,
+      stage.num_items,
+      stage.unit.c_str(),
+      throughput,
+      utilization,
+      stage.peak_rss_in_mb);
+  for (const auto& count : stage.counts) {
+    json += theia::StringPrintf(
+        ", \"%s\": %.0f", count.first.c_str(), count.second);
+  }
+  return json + "}";
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  THEIA_GFLAGS_NAMESPACE::ParseCommandLineFlags(&argc, &argv, true);
+  google::InitGoogleLogging(argv[0]);
+
+  std::vector<int> thread_counts;
+  for (const std::string& value : SplitString(FLAGS_thread_counts)) {
+    thread_counts.emplace_back(std::stoi(value));
+    CHECK_GT(thread_counts.back(), 0);
+  }
+  const std::vector<std::string> estimator_names =
+      SplitString(FLAGS_reconstruction_estimators);
+  CHECK(!thread_counts.empty());
+
+  const Workload workload = FLAGS_images.empty() ? CreateSyntheticWorkload()
+                                                 : CreateWorkloadFromImages();
+
+  std::ostringstream json;
+  json << "{\n  \"workload\": {\"synthetic\": "
+       << (workload.is_synthetic ? "true" : "false")
+       << ", \"num_images\": " << workload.image_names.size()
+       << ", \"matching_strategy\": \"" << FLAGS_matching_strategy
+       << "\", \"hardware_concurrency\": "
+       << std::thread::hardware_concurrency() << "},\n  \"runs\": [";
+  for (int i = 0; i < thread_counts.size(); i++) {
+    const int num_threads = thread_counts[i];
+    LOG(INFO) << "Running the pipeline with " << num_threads << " threads.";
+
+    // Every run starts from an empty database so that no features, matches
+    // or hashed images are reused between runs.
+    InMemoryFeaturesAndMatchesDatabase database;
+    std::vector<StageResult> stages;
+    stages.emplace_back(ExtractFeatures(workload, num_threads, &database));
+    for (const StageResult& stage :
+         MatchAndVerifyFeatures(workload, num_threads, &database)) {
+      stages.emplace_back(stage);
+    }
+    for (const std::string& estimator_name : estimator_names) {
+      for (const StageResult& stage :
+           Reconstruct(workload, estimator_name, num_threads, &database)) {
+        stages.emplace_back(stage);
+      }
+    }
+
+    json << (i > 0 ? ",\n" : "\n") << "    {\"num_threads\": " << num_threads
+         << ", \"stages\": [";
+    for (int j = 0; j < stages.size(); j++) {
+      json << (j > 0 ? ",\n" : "\n") << "      "
+           << StageToJson(stages[j], num_threads);
+    }
+    json << "]}";
+  }
+  json << "\n  ]\n}\n";
+
+  if (FLAGS_output_json.empty()) {
+    printf("%s", json.str().c_str());
+  } else {
+    std::ofstream json_file(FLAGS_output_json.c_str());
+    CHECK(json_file.is_open()) << "Cannot write to " << FLAGS_output_json;
+    json_file << json.str();
+  }
+  return 0;
+}
@@ -0,0 +1,533 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+// Micro-benchmarks for the minimal pose solvers and the RANSAC variants. Each
+// solver is timed on a set of synthetic problems created with the pose test
+// utilities, and each RANSAC variant is timed on a line fitting problem at
+// several inlier ratios. Every benchmark is repeated until it ran for at least
+// --min_time_in_seconds and reports the time per call, the number of heap
+// allocations per call and either the number of solutions or the number of
+// RANSAC iterations per call. For example:
+//
+//   ./benchmark_solvers --inlier_ratios=0.2,0.5 --benchmark_filter=Ransac
+
+#include <gflags/gflags.h>
+#include <glog/logging.h>
+#include <theia/theia.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <new>
+#include <sstream>
+#include <string>
+#include <vector>
+
+DEFINE_double(min_time_in_seconds,
+              0.5,
+              "Minimum time each benchmark is repeated for.");
+DEFINE_string(inlier_ratios,
+              "0.25,0.5,0.75",
+              "Comma-separated inlier ratios of the RANSAC benchmarks.");
+DEFINE_int32(num_ransac_points,
+             1000,
+             "Number of data points of the RANSAC benchmarks.");
+DEFINE_int32(num_problems,
+             64,
+             "Number of random problems that the solver benchmarks cycle "
+             "through.");
+DEFINE_string(benchmark_filter,
+              "",
+              "Only benchmarks whose name contains this string are run.");
+
+namespace {
+
+// The number of heap allocations since the start of the process. On glibc
+// malloc itself is wrapped so that allocations made by Eigen (which bypass
+// operator new) are counted as well.
+std::atomic<int64_t> num_heap_allocations(0);
+
+}  // namespace
+
+#ifdef __GLIBC__
+extern "C" {
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t num, size_t size);
+void* __libc_realloc(void* ptr, size_t size);
+
+void* malloc(size_t size) {
+  ++num_heap_allocations;
+  return __libc_malloc(size);
+}
+
+void* calloc(size_t num, size_t size) {
+  ++num_heap_allocations;
+  return __libc_calloc(num, size);
+}
+
+void* realloc(void* ptr, size_t size) {
+  ++num_heap_allocations;
+  return __libc_realloc(ptr, size);
+}
+}  // extern "C"
+#else
+void* operator new(size_t size) {
+  ++num_heap_allocations;
+  void* ptr = std::malloc(size);
+  if (ptr == nullptr) {
+    throw std::bad_alloc();
+  }
+  return ptr;
+}
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+#endif  // __GLIBC__
+
+namespace {
+
+using Eigen::Matrix3d;
+using Eigen::Quaterniond;
+using Eigen::Vector2d;
+using Eigen::Vector3d;
+using theia::RandomNumberGenerator;
+using theia::RansacParameters;
+using theia::RansacSummary;
+
+// The focal length of the pixel coordinates given to P4Pf.
+static const double kFocalLength = 800.0;
+// The noise added to the normalized image points, about 0.5 pixels.
+static const double kProjectionNoise = 5e-4;
+
+// Runs the benchmark repeatedly, doubling the number of calls until the total
+// time exceeds --min_time_in_seconds, and prints the time and the number of
+// allocations per call. The benchmark returns a count (the number of
+// solutions or RANSAC iterations) whose average is printed with count_name.
+void RunBenchmark(const std::string& name,
+                  const std::string& count_name,
+                  const std::function<int()>& benchmark) {
+  if (name.find(FLAGS_benchmark_filter) == std::string::npos) {
+    return;
+  }
+
+  // Warm up caches and lazily initialized state.
+  benchmark();
+
+  int num_calls = 1;
+  double elapsed_time = 0.0;
+  int64_t num_allocations = 0;
+  int64_t total_count = 0;
+  while (true) {
+    total_count = 0;
+    const int64_t num_allocations_before = num_heap_allocations;
+    theia::Timer timer;
+    for (int i = 0; i < num_calls; i++) {
+      total_count += benchmark();
+    }
+    elapsed_time = timer.ElapsedTimeInSeconds();
+    num_allocations = num_heap_allocations - num_allocations_before;
+    if (elapsed_time >= FLAGS_min_time_in_seconds || num_calls >= (1 << 30)) {
+      break;
+    }
+    num_calls *= 2;
+  }
+
+  printf("%-48s %10d %14.1f ns %14.2f %14.2f %s\n",
+         name.c_str(),
+         num_calls,
+         1e9 * elapsed_time / num_calls,
+         static_cast<double>(num_allocations) / num_calls,
+         static_cast<double>(total_count) / num_calls,
+         count_name.c_str());
+  fflush(stdout);
+}
+
+std::vector<double> ParseInlierRatios(const std::string& inlier_ratios) {
+  std::vector<double> ratios;
+  std::stringstream ss(inlier_ratios);
+  std::string ratio;
+  while (std::getline(ss, ratio, ',')) {
+    ratios.emplace_back(std::stod(ratio));
+    CHECK(ratios.back() > 0.0 && ratios.back() <= 1.0)
+        << "Inlier ratios must be in (0, 1].";
+  }
+  return ratios;
+}
+
+// ------------------------------ Solvers ----------------------------------- //
+
+// Correspondences of a random two view problem. The first camera is at the
+// origin and features1 and world_points are the observations in it.
+struct PoseProblem {
+  std::vector<Vector3d> world_points;
+  std::vector<Vector2d> features1;
+  std::vector<Vector2d> features2;
+  // The observations of the second camera in pixels.
+  std::vector<Vector2d> pixels2;
+  // The radially distorted observations in both cameras.
+  std::vector<Vector2d> distorted_features1;
+  std::vector<Vector2d> distorted_features2;
+};
+
+// Creates problems with num_points points. If planar is true the points lie
+// on a plane, as needed by the homography solvers.
+std::vector<PoseProblem> CreatePoseProblems(const int num_points,
+                                            const bool planar,
+                                            RandomNumberGenerator* rng) {
+  static const double kRadialDistortion = -0.1;
+  std::vector<PoseProblem> problems(FLAGS_num_problems);
+  for (PoseProblem& problem : problems) {
+    theia::CreateRandomPointsInFrustum(
+        1.0, 1.0, 2.0, 8.0, num_points, rng, &problem.world_points);
+    if (planar) {
+      for (Vector3d& point : problem.world_points) {
+        point.z() = 5.0 + 0.2 * point.x();
+      }
+    }
+
+    const Matrix3d rotation = theia::RandomRotation(15.0, rng);
+    const Vector3d translation = rng->RandVector3d().normalized();
+    for (const Vector3d& point : problem.world_points) {
+      const Vector3d point2 = rotation * point + translation;
+      problem.features1.emplace_back(point.hnormalized());
+      problem.features2.emplace_back(point2.hnormalized());
+      theia::AddNoiseToProjection(kProjectionNoise, rng, &problem.features1.back());
+      theia::AddNoiseToProjection(kProjectionNoise, rng, &problem.features2.back());
+      problem.pixels2.emplace_back(kFocalLength * problem.features2.back());
+
+      Vector2d distorted_feature;
+      theia::DistortPoint(point, 1.0, kRadialDistortion, distorted_feature);
+      problem.distorted_features1.emplace_back(distorted_feature);
+      theia::DistortPoint(point2, 1.0, kRadialDistortion, distorted_feature);
+      problem.distorted_features2.emplace_back(distorted_feature);
+    }
+  }
+  return problems;
+}
+
+// Times the solver on the problems in turn. The solver returns the number of
+// solutions.
+void BenchmarkSolver(const std::string& name,
+                     const std::vector<PoseProblem>& problems,
+                     const std::function<int(const PoseProblem&)>& solver) {
+  int problem_index = 0;
+  RunBenchmark("Solver/" + name, "solutions", [&]() {
+    const PoseProblem& problem = problems[problem_index];
+    problem_index = (problem_index + 1) % problems.size();
+    return solver(problem);
+  });
+}
+
+void BenchmarkSolvers() {
+  // The solvers are given exactly as many correspondences as they need so
+  // that no copies are made inside the timed calls.
+  RandomNumberGenerator rng(59);
+  const std::vector<PoseProblem> problems3 = CreatePoseProblems(3, false, &rng);
+  const std::vector<PoseProblem> problems4 = CreatePoseProblems(4, false, &rng);
+  const std::vector<PoseProblem> problems5 = CreatePoseProblems(5, false, &rng);
+  const std::vector<PoseProblem> problems7 = CreatePoseProblems(7, false, &rng);
+  const std::vector<PoseProblem> problems8 = CreatePoseProblems(8, false, &rng);
+  const std::vector<PoseProblem> planar_problems4 =
+      CreatePoseProblems(4, true, &rng);
+  const std::vector<PoseProblem> planar_problems6 =
+      CreatePoseProblems(6, true, &rng);
+
+  BenchmarkSolver("FivePoint", problems5, [](const PoseProblem& problem) {
+    std::vector<Matrix3d> essential_matrices;
+    theia::FivePointRelativePose(
+        problem.features1, problem.features2, &essential_matrices);
+    return static_cast<int>(essential_matrices.size());
+  });
+
+  BenchmarkSolver(
+      "FivePoint/FixedCapacity", problems5, [](const PoseProblem& problem) {
+        theia::FixedCapacityVector<Matrix3d, 10> essential_matrices;
+        theia::FivePointRelativePose(problem.features1.data(),
+                                     problem.features2.data(),
+                                     &essential_matrices);
+        return essential_matrices.size();
+      });
+
+  BenchmarkSolver("SevenPoint", problems7, [](const PoseProblem& problem) {
+    std::vector<Matrix3d> fundamental_matrices;
+    theia::SevenPointFundamentalMatrix(
+        problem.features1, problem.features2, &fundamental_matrices);
+    return static_cast<int>(fundamental_matrices.size());
+  });
+
+  BenchmarkSolver("EightPoint", problems8, [](const PoseProblem& problem) {
+    Matrix3d fundamental_matrix;
+    return theia::NormalizedEightPointFundamentalMatrix(
+               problem.features1, problem.features2, &fundamental_matrix)
+               ? 1
+               : 0;
+  });
+
+  BenchmarkSolver("P3P", problems3, [](const PoseProblem& problem) {
+    std::vector<Matrix3d> rotations;
+    std::vector<Vector3d> translations;
+    theia::PoseFromThreePoints(
+        problem.features1, problem.world_points, &rotations, &translations);
+    return static_cast<int>(rotations.size());
+  });
+
+  BenchmarkSolver("P3P/FixedCapacity", problems3, [](const PoseProblem& problem) {
+    theia::FixedCapacityVector<Matrix3d, 4> rotations;
+    theia::FixedCapacityVector<Vector3d, 4> translations;
+    theia::PoseFromThreePoints(problem.features1.data(),
+                               problem.world_points.data(),
+                               &rotations,
+                               &translations);
+    return rotations.size();
+  });
+
+  BenchmarkSolver("DLS", problems8, [](const PoseProblem& problem) {
+    std::vector<Quaterniond> rotations;
+    std::vector<Vector3d> translations;
+    theia::DlsPnp(
+        problem.features1, problem.world_points, &rotations, &translations);
+    return static_cast<int>(rotations.size());
+  });
+
+  BenchmarkSolver("UPnP", problems8, [](const PoseProblem& problem) {
+    std::vector<Quaterniond> rotations;
+    std::vector<Vector3d> translations;
+    theia::Upnp(
+        problem.features1, problem.world_points, &rotations, &translations);
+    return static_cast<int>(rotations.size());
+  });
+
+  BenchmarkSolver("SQPnP", problems8, [](const PoseProblem& problem) {
+    std::vector<Quaterniond> rotations;
+    std::vector<Vector3d> translations;
+    theia::SQPnP(
+        problem.features1, problem.world_points, &rotations, &translations);
+    return static_cast<int>(rotations.size());
+  });
+
+  // The first camera of the problems is at the origin, so P4Pf is run on the
+  // second camera which observes the points with a non-trivial pose.
+  BenchmarkSolver(
+      "FourPointFocalLength", problems4, [](const PoseProblem& problem) {
+        std::vector<Eigen::Matrix<double, 3, 4> > projection_matrices;
+        theia::FourPointPoseAndFocalLength(
+            problem.pixels2, problem.world_points, &projection_matrices);
+        return static_cast<int>(projection_matrices.size());
+      });
+
+  BenchmarkSolver(
+      "FourPointHomography", planar_problems4, [](const PoseProblem& problem) {
+        Matrix3d homography;
+        return theia::FourPointHomography(
+                   problem.features1, problem.features2, &homography)
+                   ? 1
+                   : 0;
+      });
+
+  BenchmarkSolver("SixPointRadialDistortionHomography",
+                  planar_problems6,
+                  [](const PoseProblem& problem) {
+                    std::vector<theia::RadialHomographyResult> results;
+                    theia::SixPointRadialDistortionHomography(
+                        problem.distorted_features1,
+                        problem.distorted_features2,
+                        &results);
+                    return static_cast<int>(results.size());
+                  });
+}
+
+// ------------------------------ RANSAC ------------------------------------ //
+
+struct Point {
+  double x;
+  double y;
+};
+
+// y = mx + b
+struct Line {
+  double m;
+  double b;
+};
+
+class LineEstimator : public theia::Estimator<Point, Line> {
+ public:
+  double SampleSize() const { return 2; }
+
+  bool EstimateModel(const std::vector<Point>& data,
+                     std::vector<Line>* models) const {
+    if (data[1].x == data[0].x) {
+      return false;
+    }
+    Line line;
+    line.m = (data[1].y - data[0].y) / (data[1].x - data[0].x);
+    line.b = data[1].y - line.m * data[1].x;
+    models->emplace_back(line);
+    return true;
+  }
+
+  double Error(const Point& point, const Line& line) const {
+    return std::abs(point.y - line.m * point.x - line.b) /
+           std::sqrt(line.m * line.m + 1.0);
+  }
+};
+
+// Points on the line y = x with outliers spread over the same area, in a
+// random order. The sorted distances of the two nearest descriptor matches
+// used by Evsac are simulated so that inliers have distinctive matches. The
+// points sorted by their distance ratio are used for Prosac.
+struct LineProblem {
+  std::vector<Point> points;
+  std::vector<Point> points_sorted_by_quality;
+  Eigen::MatrixXd sorted_distances;
+};
+
+LineProblem CreateLineProblem(const int num_points,
+                              const double inlier_ratio,
+                              RandomNumberGenerator* rng) {
+  std::vector<Point> points(num_points);
+  std::vector<double> distance_ratios(num_points);
+  Eigen::MatrixXd sorted_distances(num_points, 2);
+  for (int i = 0; i < num_points; i++) {
+    if (rng->RandDouble(0.0, 1.0) < inlier_ratio) {
+      const double x = rng->RandDouble(0.0, 1000.0);
+      points[i].x = x + rng->RandGaussian(0.0, 0.1);
+      points[i].y = x + rng->RandGaussian(0.0, 0.1);
+      sorted_distances(i, 0) = rng->RandDouble(0.1, 0.4);
+      sorted_distances(i, 1) = rng->RandDouble(0.5, 0.9);
+    } else {
+      points[i].x = rng->RandDouble(0.0, 1000.0);
+      points[i].y = rng->RandDouble(0.0, 1000.0);
+      sorted_distances(i, 0) = rng->RandDouble(0.4, 0.8);
+      sorted_distances(i, 1) =
+          sorted_distances(i, 0) + rng->RandDouble(0.0, 0.1);
+    }
+    distance_ratios[i] = sorted_distances(i, 0) / sorted_distances(i, 1);
+  }
+
+  std::vector<int> order(num_points);
+  for (int i = 0; i < num_points; i++) {
+    order[i] = i;
+  }
+  std::sort(order.begin(), order.end(), [&](const int i, const int j) {
+    return distance_ratios[i] < distance_ratios[j];
+  });
+
+  LineProblem problem;
+  problem.points = points;
+  problem.sorted_distances = sorted_distances;
+  for (const int i : order) {
+    problem.points_sorted_by_quality.emplace_back(points[i]);
+  }
+  return problem;
+}
+
+// Times repeated estimations with the RANSAC variant and reports the average
+// number of iterations it needed.
+void BenchmarkRansacVariant(
+    const std::string& name,
+    const std::vector<Point>& points,
+    theia::SampleConsensusEstimator<LineEstimator>* ransac) {
+  CHECK(ransac->Initialize());
+  RunBenchmark(name, "iterations", [&]() {
+    Line line;
+    RansacSummary summary;
+    ransac->Estimate(points, &line, &summary);
+    return summary.num_iterations;
+  });
+}
+
+void BenchmarkRansacVariants(const double inlier_ratio) {
+  RandomNumberGenerator rng(61);
+  const LineProblem problem =
+      CreateLineProblem(FLAGS_num_ransac_points, inlier_ratio, &rng);
+
+  const LineEstimator estimator;
+  RansacParameters params;
+  params.rng = std::make_shared<RandomNumberGenerator>(67);
+  params.error_thresh = 0.5;
+  params.max_iterations = 100000;
+  char suffix[32];
+  snprintf(suffix, sizeof(suffix), "/%d/%.2f", FLAGS_num_ransac_points,
+           inlier_ratio);
+
+  theia::Ransac<LineEstimator> ransac(params, estimator);
+  BenchmarkRansacVariant(
+      std::string("Ransac/Ransac") + suffix, problem.points, &ransac);
+
+  theia::Prosac<LineEstimator> prosac(params, estimator);
+  BenchmarkRansacVariant(std::string("Ransac/Prosac") + suffix,
+                         problem.points_sorted_by_quality,
+                         &prosac);
+
+  theia::Evsac<LineEstimator> evsac(
+      params, estimator, problem.sorted_distances, 0.65, theia::MLE);
+  BenchmarkRansacVariant(
+      std::string("Ransac/Evsac") + suffix, problem.points, &evsac);
+
+  theia::LMed<LineEstimator> lmed(params, estimator);
+  BenchmarkRansacVariant(
+      std::string("Ransac/LMed") + suffix, problem.points, &lmed);
+
+  theia::ExhaustiveRansac<LineEstimator> exhaustive_ransac(params, estimator);
+  BenchmarkRansacVariant(std::string("Ransac/ExhaustiveRansac") + suffix,
+                         problem.points,
+                         &exhaustive_ransac);
+
+  theia::PreemptiveRansac<LineEstimator> preemptive_ransac(params, estimator);
+  BenchmarkRansacVariant(std::string("Ransac/PreemptiveRansac") + suffix,
+                         problem.points,
+                         &preemptive_ransac);
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  THEIA_GFLAGS_NAMESPACE::ParseCommandLineFlags(&argc, &argv, true);
+  google::InitGoogleLogging(argv[0]);
+
+  printf("%-48s %10s %17s %14s %14s\n",
+         "Benchmark",
+         "Calls",
+         "Time/call",
+         "Allocs/call",
+         "Count/call");
+  BenchmarkSolvers();
+  for (const double inlier_ratio : ParseInlierRatios(FLAGS_inlier_ratios)) {
+    BenchmarkRansacVariants(inlier_ratio);
+  }
+  return 0;
+}
@@ -298,8 +298,10 @@ InitializeReconstructionBuilderFrom1DSFM() {
       SetReconstructionBuilderOptions();
   std::unique_ptr<Reconstruction> reconstruction(new Reconstruction);
   std::unique_ptr<theia::ViewGraph> view_graph(new theia::ViewGraph);
-  CHECK(Read1DSFM(
-      FLAGS_1dsfm_dataset_directory, reconstruction.get(), view_graph.get()))
+  CHECK(Read1DSFM(FLAGS_1dsfm_dataset_directory,
+                  reconstruction.get(),
+                  view_graph.get(),
+                  FLAGS_num_threads))
       << "Could not read 1dsfm dataset from " << FLAGS_1dsfm_dataset_directory;
   LOG(INFO) << "Initializing reconstruction builder from 1dsfm.";
   return std::unique_ptr<ReconstructionBuilder>(new ReconstructionBuilder(
@@ -324,8 +326,8 @@ int main(int argc, char* argv[]) {
   std::unique_ptr<theia::Reconstruction> gt_reconstruction(
       new theia::Reconstruction());
   LOG(INFO) << "Converting ground truth bundler file to Theia reconstruction.";
-  CHECK(
-      theia::ReadBundlerFiles(lists_file, bundle_file, gt_reconstruction.get()))
+  CHECK(theia::ReadBundlerFiles(
+      lists_file, bundle_file, gt_reconstruction.get(), FLAGS_num_threads))
       << "Could not the ground truth Bundler file at " << bundle_file;
 
   CHECK(theia::WriteReconstruction(*gt_reconstruction.get(),
@@ -32,9 +32,13 @@
 // Please contact the author of this library if you have any questions.
 // Author: Chris Sweeney (cmsweeney@cs.ucsb.edu)
 
+#include <algorithm>
 #include <chrono>  // NOLINT
+#include <fstream>  // NOLINT
 #include <gflags/gflags.h>
 #include <glog/logging.h>
+#include <map>
+#include <set>
 #include <string>
 #include <theia/theia.h>
 #include <time.h>
@@ -46,7 +50,14 @@
 DEFINE_int32(max_num_images, 10000, "Maximum number of images to process.");
 DEFINE_string(images, "", "Wildcard of images to reconstruct.");
 DEFINE_string(image_masks, "", "Wildcard of image masks to reconstruct.");
-DEFINE_string(matches_file, "", "Filename of the matches file.");
+DEFINE_string(matches_file,
+              "",
+              "Filename of a chunked matches file to reconstruct from instead "
+              "of extracting and matching features.");
+DEFINE_string(output_matches_file,
+              "",
+              "If set, the matches are exported to this chunked matches file "
+              "so that they can be loaded with --matches_file.");
 DEFINE_string(calibration_file,
               "",
               "Calibration file containing image calibration data.");
@@ -60,6 +71,15 @@ DEFINE_string(
 DEFINE_int32(num_threads,
              1,
              "Number of threads to use for feature extraction and matching.");
+DEFINE_bool(deterministic,
+            false,
+            "Set to true to produce the same reconstruction regardless of the "
+            "number of threads. Bundle adjustment then runs on a single "
+            "thread.");
+DEFINE_bool(numa_aware,
+            false,
+            "Set to true to pin the threads to the NUMA nodes of the machine "
+            "during matching and reconstruction estimation.");
 
 // Feature and matching options.
 DEFINE_string(
@@ -112,6 +132,11 @@ DEFINE_int32(max_num_features_for_fisher_vector_training,
              1000000,
              "Number of features to use to train the Fisher Vector kernel for "
              "global image descriptor extraction.");
+DEFINE_int32(global_descriptor_pca_dimension,
+             256,
+             "Fisher Vectors are compressed to this many dimensions with PCA "
+             "whitening before the nearest neighbor images are searched. Set "
+             "to 0 to compare the full Fisher Vectors.");
 
 // Reconstruction building options.
 DEFINE_string(reconstruction_estimator,
@@ -159,6 +184,15 @@ DEFINE_double(post_rotation_filtering_degrees,
               5.0,
               "Max degrees difference in relative rotation and rotation "
               "estimates for rotation filtering.");
+DEFINE_int32(view_graph_sparsification_num_edges_per_view,
+             0,
+             "If positive, the view graph is sparsified before global SfM to "
+             "its maximum spanning tree plus this many of the strongest view "
+             "pairs of each view. This greatly speeds up dense captures.");
+DEFINE_bool(view_graph_sparsification_use_visibility_score,
+            false,
+            "Rank the view pairs for view graph sparsification by their "
+            "visibility score instead of their number of verified matches.");
 DEFINE_bool(extract_maximal_rigid_subgraph,
             false,
             "If true, only cameras that are well-conditioned for position "
@@ -205,10 +239,30 @@ DEFINE_double(full_bundle_adjustment_growth_percent,
               "Full BA is only triggered for incremental SfM when the "
               "reconstruction has growth by this percent since the last time "
               "full BA was used.");
+DEFINE_double(full_bundle_adjustment_drift_ratio,
+              1.5,
+              "Full BA is also triggered for incremental SfM when the mean "
+              "reprojection error after partial BA exceeds this factor times "
+              "the error after the last full BA. Set to 0 to disable.");
 DEFINE_int32(partial_bundle_adjustment_num_views,
              20,
              "When full BA is not being run, partial BA is executed on a "
-             "constant number of views specified by this parameter.");
+             "number of views specified by this parameter: the new views and "
+             "the views that share the most tracks with them.");
+
+// Hierarchical SfM options.
+DEFINE_string(hierarchical_cluster_estimator,
+              "GLOBAL",
+              "Type of SfM reconstruction estimation used for each cluster of "
+              "hierarchical SfM.");
+DEFINE_int32(hierarchical_max_views_per_cluster,
+             100,
+             "Hierarchical SfM splits the view graph until no cluster has more "
+             "than this many views.");
+DEFINE_int32(hierarchical_num_overlapping_views,
+             10,
+             "Number of views shared by adjacent clusters in hierarchical SfM. "
+             "Clusters are merged by aligning these views.");
 
 // Triangulation options.
 DEFINE_double(min_triangulation_angle_degrees,
@@ -234,6 +288,10 @@ DEFINE_double(bundle_adjustment_robust_loss_width,
               "If the BA loss function is not NONE, then this value controls "
               "where the robust loss begins with respect to reprojection error "
               "in pixels.");
+DEFINE_bool(use_gpu_bundle_adjustment,
+            false,
+            "Set to true to solve the bundle adjustment linear systems on the "
+            "GPU. Requires Ceres 2.2 or newer built with CUDA.");
 
 // Track Subsampling parameters.
 DEFINE_bool(subsample_tracks_for_bundle_adjustment,
@@ -258,10 +316,242 @@ DEFINE_int32(min_num_optimized_tracks_per_view,
              "When track subsampling is enabled, tracks are selected such that "
              "each view observes a minimum number of optimized tracks.");
 
+// Metrics options.
+DEFINE_string(metrics_output_file,
+              "",
+              "If set, the metrics of the pipeline are written to this file "
+              "periodically, as Prometheus text if the file ends with .prom "
+              "and as JSON otherwise.");
+DEFINE_double(metrics_export_interval_seconds,
+              30.0,
+              "Interval in seconds between writes of the metrics file.");
+
+// Resuming options.
+DEFINE_string(checkpoint_directory,
+              "",
+              "If set, the state of the pipeline is saved to this directory "
+              "after the tracks are built, after the rotations and positions "
+              "are estimated and after each reconstruction, and a run with "
+              "the same directory resumes from it. The directory also records "
+              "the images and flags of the last run, so that only the stages "
+              "whose inputs changed are run again.");
+DEFINE_string(start_stage,
+              "",
+              "Stage to run again, along with all the stages after it: "
+              "features, matches, view_graph, rotations, positions or "
+              "structure (triangulation and bundle adjustment). By default "
+              "the run starts at the first stage whose inputs changed since "
+              "the last run. Features already in the database are always "
+              "reused, so features is the same as matches.");
+DEFINE_string(stop_after_stage,
+              "structure",
+              "Stage after which the run stops: features, matches, view_graph, "
+              "rotations, positions or structure. The stages after matches "
+              "require a checkpoint directory, and stopping after rotations or "
+              "positions requires the GLOBAL reconstruction estimator.");
+
 using theia::FeaturesAndMatchesDatabase;
 using theia::Reconstruction;
 using theia::ReconstructionBuilder;
 using theia::ReconstructionBuilderOptions;
+using theia::ReconstructionCheckpointStage;
+
+// The stages of the pipeline that a run can start from or stop after.
+enum class BuildStage {
+  FEATURES = 0,
+  MATCHES = 1,
+  VIEW_GRAPH = 2,
+  ROTATIONS = 3,
+  POSITIONS = 4,
+  STRUCTURE = 5
+};
+
+BuildStage StringToBuildStage(const std::string& stage) {
+  static const std::map<std::string, BuildStage> kBuildStages = {
+      {"features", BuildStage::FEATURES},
+      {"matches", BuildStage::MATCHES},
+      {"view_graph", BuildStage::VIEW_GRAPH},
+      {"rotations", BuildStage::ROTATIONS},
+      {"positions", BuildStage::POSITIONS},
+      {"structure", BuildStage::STRUCTURE}};
+  const auto it = kBuildStages.find(stage);
+  CHECK(it != kBuildStages.end()) << "Invalid stage: " << stage;
+  return it->second;
+}
+
+// The first stage whose result depends on each flag. Flags that are not listed
+// only affect the structure estimation and bundle adjustment, unless they are
+// listed in kFlagsWithoutEffect.
+const std::map<std::string, BuildStage> kFirstStageOfFlag = {
+    {"images", BuildStage::MATCHES},
+    {"image_masks", BuildStage::MATCHES},
+    {"max_num_images", BuildStage::MATCHES},
+    {"calibration_file", BuildStage::MATCHES},
+    {"descriptor", BuildStage::MATCHES},
+    {"feature_density", BuildStage::MATCHES},
+    {"matching_strategy", BuildStage::MATCHES},
+    {"lowes_ratio", BuildStage::MATCHES},
+    {"max_sampson_error_for_verified_match", BuildStage::MATCHES},
+    {"min_num_inliers_for_valid_match", BuildStage::MATCHES},
+    {"bundle_adjust_two_view_geometry", BuildStage::MATCHES},
+    {"keep_only_symmetric_matches", BuildStage::MATCHES},
+    {"select_image_pairs_with_global_image_descriptor_matching",
+     BuildStage::MATCHES},
+    {"num_nearest_neighbors_for_global_descriptor_matching",
+     BuildStage::MATCHES},
+    {"num_gmm_clusters_for_fisher_vector", BuildStage::MATCHES},
+    {"max_num_features_for_fisher_vector_training", BuildStage::MATCHES},
+    {"global_descriptor_pca_dimension", BuildStage::MATCHES},
+    // The geometric verification of the matches triangulates the features.
+    {"triangulation_reprojection_error_pixels", BuildStage::MATCHES},
+    {"min_triangulation_angle_degrees", BuildStage::MATCHES},
+    {"max_reprojection_error_pixels", BuildStage::MATCHES},
+    {"matches_file", BuildStage::VIEW_GRAPH},
+    {"shared_calibration", BuildStage::VIEW_GRAPH},
+    {"only_calibrated_views", BuildStage::VIEW_GRAPH},
+    {"min_track_length", BuildStage::VIEW_GRAPH},
+    {"max_track_length", BuildStage::VIEW_GRAPH},
+    {"reconstruction_estimator", BuildStage::VIEW_GRAPH},
+    {"reconstruct_largest_connected_component", BuildStage::VIEW_GRAPH},
+    {"hierarchical_cluster_estimator", BuildStage::VIEW_GRAPH},
+    {"hierarchical_max_views_per_cluster", BuildStage::VIEW_GRAPH},
+    {"hierarchical_num_overlapping_views", BuildStage::VIEW_GRAPH},
+    {"view_graph_sparsification_num_edges_per_view", BuildStage::ROTATIONS},
+    {"view_graph_sparsification_use_visibility_score", BuildStage::ROTATIONS},
+    {"global_rotation_estimator", BuildStage::ROTATIONS},
+    {"post_rotation_filtering_degrees", BuildStage::ROTATIONS},
+    {"global_position_estimator", BuildStage::POSITIONS},
+    {"refine_relative_translations_after_rotation_estimation",
+     BuildStage::POSITIONS},
+    {"extract_maximal_rigid_subgraph", BuildStage::POSITIONS},
+    {"filter_relative_translations_with_1dsfm", BuildStage::POSITIONS},
+    {"position_estimation_min_num_tracks_per_view", BuildStage::POSITIONS},
+    {"position_estimation_robust_loss_width", BuildStage::POSITIONS}};
+
+const std::set<std::string> kFlagsWithoutEffect = {
+    "output_reconstruction",
+    "output_matches_file",
+    "num_threads",
+    "numa_aware",
+    "matching_working_directory",
+    "checkpoint_directory",
+    "start_stage",
+    "stop_after_stage",
+    "metrics_output_file",
+    "metrics_export_interval_seconds"};
+
+// The inputs of a run, each as a line of the first stage that depends on it.
+// These are the flags of this application and the signatures of the images.
+std::set<std::string> InputsOfRun() {
+  std::set<std::string> inputs;
+  std::vector<THEIA_GFLAGS_NAMESPACE::CommandLineFlagInfo> flags;
+  THEIA_GFLAGS_NAMESPACE::GetAllFlags(&flags);
+  for (const auto& flag : flags) {
+    if (flag.filename.find("build_reconstruction") == std::string::npos ||
+        kFlagsWithoutEffect.count(flag.name) > 0) {
+      continue;
+    }
+    const auto stage = kFirstStageOfFlag.find(flag.name);
+    const BuildStage first_stage = stage != kFirstStageOfFlag.end()
+                                       ? stage->second
+                                       : BuildStage::STRUCTURE;
+    inputs.emplace(theia::StringPrintf("%d flag %s=%s",
+                                       static_cast<int>(first_stage),
+                                       flag.name.c_str(),
+                                       flag.current_value.c_str()));
+  }
+
+  std::vector<std::string> image_files;
+  if (!FLAGS_images.empty() &&
+      theia::GetFilepathsFromWildcard(FLAGS_images, &image_files)) {
+    for (const std::string& image_file : image_files) {
+      theia::FileSignature signature;
+      theia::GetFileSignature(image_file, &signature);
+      inputs.emplace(theia::StringPrintf(
+          "%d image %s %llu %lld",
+          static_cast<int>(BuildStage::MATCHES),
+          image_file.c_str(),
+          static_cast<unsigned long long>(signature.size),  // NOLINT
+          static_cast<long long>(signature.modification_time)));  // NOLINT
+    }
+  }
+  return inputs;
+}
+
+std::string InputsFilepath() {
+  std::string directory = FLAGS_checkpoint_directory;
+  theia::AppendTrailingSlashIfNeeded(&directory);
+  return directory + "build_reconstruction_inputs.txt";
+}
+
+// Finds the first stage whose inputs differ from the inputs recorded by the
+// last run. Returns false if no inputs were recorded or none of them changed.
+bool FindFirstStageWithChangedInputs(const std::set<std::string>& inputs,
+                                 BuildStage* first_changed_stage) {
+  std::ifstream inputs_reader(InputsFilepath());
+  if (!inputs_reader.is_open()) {
+    return false;
+  }
+  std::set<std::string> previous_inputs;
+  std::string line;
+  while (std::getline(inputs_reader, line)) {
+    previous_inputs.emplace(line);
+  }
+
+  std::vector<std::string> changed_inputs;
+  std::set_symmetric_difference(inputs.begin(),
+                                inputs.end(),
+                                previous_inputs.begin(),
+                                previous_inputs.end(),
+                                std::back_inserter(changed_inputs));
+  int first_stage = static_cast<int>(BuildStage::STRUCTURE);
+  for (const std::string& changed_input : changed_inputs) {
+    VLOG(1) << "Changed input: " << changed_input;
+    first_stage = std::min(first_stage, std::stoi(changed_input));
+  }
+  *first_changed_stage = static_cast<BuildStage>(first_stage);
+  return !changed_inputs.empty();
+}
+
+void WriteInputsOfRun(const std::set<std::string>& inputs) {
+  std::ofstream inputs_writer(InputsFilepath());
+  for (const std::string& input : inputs) {
+    inputs_writer << input << "\n";
+  }
+  LOG_IF(WARNING, !inputs_writer.good())
+      << "Could not write the inputs of the run to " << InputsFilepath();
+}
+
+// The checkpoint stage that the reconstruction builder restarts from so that
+// the given stage is run again.
+ReconstructionCheckpointStage RestartStageOfBuildStage(const BuildStage stage) {
+  switch (stage) {
+    case BuildStage::FEATURES:
+    case BuildStage::MATCHES:
+    case BuildStage::VIEW_GRAPH:
+      return ReconstructionCheckpointStage::NONE;
+    case BuildStage::ROTATIONS:
+      return ReconstructionCheckpointStage::TRACKS_BUILT;
+    case BuildStage::POSITIONS:
+      return ReconstructionCheckpointStage::ROTATIONS_ESTIMATED;
+    default:
+      return ReconstructionCheckpointStage::POSITIONS_ESTIMATED;
+  }
+}
+
+// The checkpoint stage after which the reconstruction builder stops.
+ReconstructionCheckpointStage StopStageOfBuildStage(const BuildStage stage) {
+  switch (stage) {
+    case BuildStage::VIEW_GRAPH:
+      return ReconstructionCheckpointStage::TRACKS_BUILT;
+    case BuildStage::ROTATIONS:
+      return ReconstructionCheckpointStage::ROTATIONS_ESTIMATED;
+    case BuildStage::POSITIONS:
+      return ReconstructionCheckpointStage::POSITIONS_ESTIMATED;
+    default:
+      return ReconstructionCheckpointStage::FINISHED;
+  }
+}
 
 // Sets the feature extraction, matching, and reconstruction options based on
 // the command line flags. There are many more options beside just these located
@@ -269,6 +559,8 @@ using theia::ReconstructionBuilderOptions;
 ReconstructionBuilderOptions SetReconstructionBuilderOptions() {
   ReconstructionBuilderOptions options;
   options.num_threads = FLAGS_num_threads;
+  options.deterministic = FLAGS_deterministic;
+  options.matching_options.numa_aware = FLAGS_numa_aware;
 
   options.descriptor_type = StringToDescriptorExtractorType(FLAGS_descriptor);
   options.feature_density = StringToFeatureDensity(FLAGS_feature_density);
@@ -301,6 +593,8 @@ ReconstructionBuilderOptions SetReconstructionBuilderOptions() {
       FLAGS_num_gmm_clusters_for_fisher_vector;
   options.max_num_features_for_fisher_vector_training =
       FLAGS_max_num_features_for_fisher_vector_training;
+  options.global_descriptor_pca_dimension =
+      FLAGS_global_descriptor_pca_dimension;
 
   options.min_track_length = FLAGS_min_track_length;
   options.max_track_length = FLAGS_max_track_length;
@@ -311,6 +605,7 @@ ReconstructionBuilderOptions SetReconstructionBuilderOptions() {
   reconstruction_estimator_options.min_num_two_view_inliers =
       FLAGS_min_num_inliers_for_valid_match;
   reconstruction_estimator_options.num_threads = FLAGS_num_threads;
+  reconstruction_estimator_options.numa_aware = FLAGS_numa_aware;
   reconstruction_estimator_options.intrinsics_to_optimize =
       StringToOptimizeIntrinsicsType(FLAGS_intrinsics_to_optimize);
   options.reconstruct_largest_connected_component =
@@ -335,6 +630,12 @@ ReconstructionBuilderOptions SetReconstructionBuilderOptions() {
       FLAGS_refine_relative_translations_after_rotation_estimation;
   reconstruction_estimator_options.extract_maximal_rigid_subgraph =
       FLAGS_extract_maximal_rigid_subgraph;
+  reconstruction_estimator_options
+      .view_graph_sparsification_num_edges_per_view =
+      FLAGS_view_graph_sparsification_num_edges_per_view;
+  reconstruction_estimator_options
+      .view_graph_sparsification_use_visibility_score =
+      FLAGS_view_graph_sparsification_use_visibility_score;
   reconstruction_estimator_options.filter_relative_translations_with_1dsfm =
       FLAGS_filter_relative_translations_with_1dsfm;
   reconstruction_estimator_options.rotation_filtering_max_difference_degrees =
@@ -353,9 +654,19 @@ ReconstructionBuilderOptions SetReconstructionBuilderOptions() {
       FLAGS_min_num_absolute_pose_inliers;
   reconstruction_estimator_options.full_bundle_adjustment_growth_percent =
       FLAGS_full_bundle_adjustment_growth_percent;
+  reconstruction_estimator_options.full_bundle_adjustment_drift_ratio =
+      FLAGS_full_bundle_adjustment_drift_ratio;
   reconstruction_estimator_options.partial_bundle_adjustment_num_views =
       FLAGS_partial_bundle_adjustment_num_views;
 
+  // Hierarchical SfM Options.
+  reconstruction_estimator_options.hierarchical_cluster_estimator_type =
+      StringToReconstructionEstimatorType(FLAGS_hierarchical_cluster_estimator);
+  reconstruction_estimator_options.hierarchical_max_views_per_cluster =
+      FLAGS_hierarchical_max_views_per_cluster;
+  reconstruction_estimator_options.hierarchical_num_overlapping_views =
+      FLAGS_hierarchical_num_overlapping_views;
+
   // Triangulation options (used by all SfM pipelines).
   reconstruction_estimator_options.min_triangulation_angle_degrees =
       FLAGS_min_triangulation_angle_degrees;
@@ -370,6 +681,9 @@ ReconstructionBuilderOptions SetReconstructionBuilderOptions() {
       StringToLossFunction(FLAGS_bundle_adjustment_robust_loss_function);
   reconstruction_estimator_options.bundle_adjustment_robust_loss_width =
       FLAGS_bundle_adjustment_robust_loss_width;
+  reconstruction_estimator_options.bundle_adjustment_backend =
+      FLAGS_use_gpu_bundle_adjustment ? theia::BundleAdjustmentBackend::CUDA
+                                      : theia::BundleAdjustmentBackend::CPU;
 
   // Track subsampling options.
   reconstruction_estimator_options.subsample_tracks_for_bundle_adjustment =
@@ -381,6 +695,15 @@ ReconstructionBuilderOptions SetReconstructionBuilderOptions() {
       FLAGS_track_selection_image_grid_cell_size_pixels;
   reconstruction_estimator_options.min_num_optimized_tracks_per_view =
       FLAGS_min_num_optimized_tracks_per_view;
+
+  options.metrics_output_file = FLAGS_metrics_output_file;
+  options.metrics_export_interval_in_seconds =
+      FLAGS_metrics_export_interval_seconds;
+
+  options.checkpoint_directory = FLAGS_checkpoint_directory;
+  const BuildStage stop_stage = StringToBuildStage(FLAGS_stop_after_stage);
+  options.stop_stage = StopStageOfBuildStage(stop_stage);
+  options.match_features = stop_stage != BuildStage::FEATURES;
   return options;
 }
 
@@ -410,16 +733,40 @@ void AddMatchesToReconstructionBuilder(
         intrinsics_group_id);
   }
 
-  // Add the matches.
-  const auto match_keys = features_and_matches_database->ImageNamesOfMatches();
-  LOG(INFO) << "Loading " << match_keys.size() << " matches from the DB.";
-  for (const auto& match_key : match_keys) {
-    const theia::ImagePairMatch& match =
-        features_and_matches_database->GetImagePairMatch(match_key.first,
-                                                         match_key.second);
-    CHECK(reconstruction_builder->AddTwoViewMatch(
-        match_key.first, match_key.second, match));
+  // Stream the matches so that they are never all in memory at once.
+  LOG(INFO) << "Loading " << features_and_matches_database->NumMatches()
+            << " matches from the DB.";
+  features_and_matches_database->ForEachImagePairMatch(
+      [&](const std::string& image_name1,
+          const std::string& image_name2,
+          const theia::ImagePairMatch& match) {
+        CHECK(reconstruction_builder->AddTwoViewMatch(
+            image_name1, image_name2, match));
+        return true;
+      });
+}
+
+void AddMatchesFileToReconstructionBuilder(
+    ReconstructionBuilder* reconstruction_builder) {
+  theia::CameraIntrinsicsGroupId intrinsics_group_id =
+      theia::kInvalidCameraIntrinsicsGroupId;
+  if (FLAGS_shared_calibration) {
+    intrinsics_group_id = 0;
+  }
+  CHECK(reconstruction_builder->AddTwoViewMatchesFromFile(FLAGS_matches_file,
+                                                          intrinsics_group_id))
+      << "Could not read the matches file: " << FLAGS_matches_file;
+}
+
+void ExportMatches(FeaturesAndMatchesDatabase* features_and_matches_database) {
+  if (FLAGS_output_matches_file.empty()) {
+    return;
   }
+  theia::ChunkedMatchesWriterOptions options;
+  options.compress = true;
+  CHECK(theia::WriteChunkedMatchesFromDatabase(
+      features_and_matches_database, FLAGS_output_matches_file, options))
+      << "Could not write the matches file: " << FLAGS_output_matches_file;
 }
 
 void AddImagesToReconstructionBuilder(
@@ -505,6 +852,28 @@ int main(int argc, char* argv[]) {
   google::InitGoogleLogging(argv[0]);
 
   CHECK_GT(FLAGS_output_reconstruction.size(), 0);
+  const BuildStage stop_stage = StringToBuildStage(FLAGS_stop_after_stage);
+  CHECK(stop_stage <= BuildStage::MATCHES ||
+        !FLAGS_checkpoint_directory.empty())
+      << "Stopping after " << FLAGS_stop_after_stage
+      << " requires a checkpoint directory.";
+
+  // Choose the stage to start from: the requested one, or the first one whose
+  // inputs changed since the last run.
+  const std::set<std::string> inputs = InputsOfRun();
+  BuildStage start_stage = BuildStage::STRUCTURE;
+  bool restart = false;
+  if (!FLAGS_start_stage.empty()) {
+    start_stage = StringToBuildStage(FLAGS_start_stage);
+    restart = true;
+  } else if (!FLAGS_checkpoint_directory.empty() &&
+             FindFirstStageWithChangedInputs(inputs, &start_stage)) {
+    restart = true;
+  }
+  if (restart) {
+    LOG(INFO) << "Running the stages from stage "
+              << static_cast<int>(start_stage) << " again.";
+  }
 
   // Initialize the features and matches database.
 #ifdef WITH_ROCKSDB
@@ -515,26 +884,60 @@ int main(int argc, char* argv[]) {
   std::unique_ptr<FeaturesAndMatchesDatabase> features_and_matches_database(
       new theia::InMemoryFeaturesAndMatchesDatabase());
 #endif
+  if (restart && start_stage <= BuildStage::MATCHES &&
+      features_and_matches_database->NumMatches() > 0) {
+    LOG(INFO) << "Removing the matches of the last run.";
+    features_and_matches_database->RemoveAllMatches();
+  }
+
   // Create the reconstruction builder.
-  const ReconstructionBuilderOptions options =
-      SetReconstructionBuilderOptions();
+  ReconstructionBuilderOptions options = SetReconstructionBuilderOptions();
+  if (restart) {
+    options.restart_stage = RestartStageOfBuildStage(start_stage);
+  }
   ReconstructionBuilder reconstruction_builder(
       options, features_and_matches_database.get());
 
   // If matches are provided, load matches otherwise load images.
-  if (features_and_matches_database->NumMatches() > 0) {
+  if (!FLAGS_matches_file.empty()) {
+    AddMatchesFileToReconstructionBuilder(&reconstruction_builder);
+  } else if (features_and_matches_database->NumMatches() > 0) {
+    if (stop_stage <= BuildStage::MATCHES) {
+      LOG(INFO) << "The matches are already in the database.";
+      ExportMatches(features_and_matches_database.get());
+      return 0;
+    }
     AddMatchesToReconstructionBuilder(features_and_matches_database.get(),
                                       &reconstruction_builder);
   } else if (FLAGS_images.size() != 0) {
     AddImagesToReconstructionBuilder(&reconstruction_builder);
   } else {
-    LOG(FATAL) << "You must specifiy either images to reconstruct or supply a "
-                  "database with matches stored in it.";
+    LOG(FATAL) << "You must specifiy either images to reconstruct, a matches "
+                  "file, or a database with matches stored in it.";
+  }
+
+  if (stop_stage <= BuildStage::MATCHES) {
+    features_and_matches_database->Flush();
+    ExportMatches(features_and_matches_database.get());
+    if (!FLAGS_checkpoint_directory.empty()) {
+      WriteInputsOfRun(inputs);
+    }
+    LOG(INFO) << "Stopped after the " << FLAGS_stop_after_stage << " stage.";
+    return 0;
   }
 
   std::vector<Reconstruction*> reconstructions;
-  CHECK(reconstruction_builder.BuildReconstruction(&reconstructions))
-      << "Could not create a reconstruction.";
+  const bool success =
+      reconstruction_builder.BuildReconstruction(&reconstructions);
+  ExportMatches(features_and_matches_database.get());
+  if (!FLAGS_checkpoint_directory.empty()) {
+    WriteInputsOfRun(inputs);
+  }
+  if (stop_stage < BuildStage::STRUCTURE) {
+    LOG(INFO) << "Stopped after the " << FLAGS_stop_after_stage << " stage.";
+    return 0;
+  }
+  CHECK(success) << "Could not create a reconstruction.";
 
   for (int i = 0; i < reconstructions.size(); i++) {
     const std::string output_file =
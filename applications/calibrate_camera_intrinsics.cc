@@ -32,12 +32,16 @@
 // Please contact the author of this library if you have any questions.
 // Author: Chris Sweeney (cmsweeney@cs.ucsb.edu)
 
+#include <algorithm>
 #include <chrono>  // NOLINT
+#include <fstream>  // NOLINT
 #include <gflags/gflags.h>
 #include <glog/logging.h>
+#include <sstream>
 #include <string>
 #include <theia/theia.h>
 #include <time.h>
+#include <unordered_map>
 #include <vector>
 
 #include "applications/command_line_helpers.h"
@@ -57,6 +61,25 @@ DEFINE_string(camera_model,
 
 // Input/output files.
 DEFINE_string(images, "", "Wildcard of images to reconstruct.");
+DEFINE_string(input_reconstruction,
+              "",
+              "If set, the intrinsics groups of this reconstruction are "
+              "calibrated in parallel with bundle adjustment instead of "
+              "reconstructing the images. Each group is only adjusted with its "
+              "own views and a well distributed subsample of their tracks. "
+              "--intrinsics_to_optimize selects the calibrated intrinsics.");
+DEFINE_string(output_reconstruction,
+              "",
+              "Output file for the calibrated --input_reconstruction.");
+DEFINE_string(calibration_cache,
+              "",
+              "JSON file of the calibrations of the intrinsics groups of "
+              "--input_reconstruction. Converged groups in the file are not "
+              "calibrated again, and the file is updated after calibration.");
+DEFINE_int32(min_num_optimized_tracks_per_view,
+             100,
+             "Minimum number of tracks of each view that are used to calibrate "
+             "the intrinsics groups of --input_reconstruction.");
 
 // Multithreading.
 DEFINE_int32(num_threads,
@@ -261,10 +284,86 @@ void AddImagesToReconstructionBuilder(
   CHECK(reconstruction_builder->ExtractAndMatchFeatures());
 }
 
+// Calibrates the intrinsics groups of an existing reconstruction. The groups
+// are calibrated in parallel for up to --num_calibration_iterations rounds,
+// where each round only calibrates the groups that have not converged yet.
+void CalibrateIntrinsicsGroupsOfReconstruction() {
+  Reconstruction reconstruction;
+  CHECK(theia::ReadReconstruction(FLAGS_input_reconstruction, &reconstruction))
+      << "Could not read the reconstruction: " << FLAGS_input_reconstruction;
+
+  std::unordered_map<theia::CameraIntrinsicsGroupId,
+                     theia::IntrinsicsGroupCalibration>
+      calibrations;
+  if (!FLAGS_calibration_cache.empty() &&
+      theia::FileExists(FLAGS_calibration_cache)) {
+    std::ifstream cache_file(FLAGS_calibration_cache);
+    std::stringstream cache;
+    cache << cache_file.rdbuf();
+    CHECK(theia::IntrinsicsGroupCalibrationsFromJson(cache.str(),
+                                                     &calibrations))
+        << "Could not parse the calibration cache: " << FLAGS_calibration_cache;
+  }
+
+  theia::CalibrateIntrinsicsGroupsOptions options;
+  options.num_threads = FLAGS_num_threads;
+  options.min_num_optimized_tracks_per_view =
+      FLAGS_min_num_optimized_tracks_per_view;
+  theia::BundleAdjustmentOptions& ba_options =
+      options.bundle_adjustment_options;
+  ba_options.intrinsics_to_optimize =
+      StringToOptimizeIntrinsicsType(FLAGS_intrinsics_to_optimize);
+  CHECK(ba_options.intrinsics_to_optimize !=
+        theia::OptimizeIntrinsicsType::NONE)
+      << "Set --intrinsics_to_optimize to the intrinsics to calibrate.";
+  ba_options.loss_function_type =
+      StringToLossFunction(FLAGS_bundle_adjustment_robust_loss_function);
+  ba_options.robust_loss_width = FLAGS_bundle_adjustment_robust_loss_width;
+  // The threads are shared by the groups that are calibrated in parallel.
+  ba_options.num_threads =
+      std::max(1,
+               FLAGS_num_threads /
+                   std::max(1, reconstruction.NumCameraIntrinsicGroups()));
+
+  for (int i = 0; i < FLAGS_num_calibration_iterations; i++) {
+    const int num_calibrated_groups = theia::CalibrateIntrinsicsGroups(
+        options, &reconstruction, &calibrations);
+    LOG(INFO) << "Calibration iteration " << i + 1 << " calibrated "
+              << num_calibrated_groups << " intrinsics groups.";
+    if (num_calibrated_groups == 0) {
+      break;
+    }
+  }
+
+  int num_converged_groups = 0;
+  for (const auto& calibration : calibrations) {
+    num_converged_groups += calibration.second.converged ? 1 : 0;
+  }
+  LOG(INFO) << num_converged_groups << " of " << calibrations.size()
+            << " intrinsics groups have converged.";
+  PrintReprojectionErrors(reconstruction);
+
+  if (!FLAGS_calibration_cache.empty()) {
+    std::ofstream cache_file(FLAGS_calibration_cache);
+    cache_file << theia::IntrinsicsGroupCalibrationsToJson(calibrations);
+  }
+  if (!FLAGS_output_reconstruction.empty()) {
+    CHECK(theia::WriteReconstruction(reconstruction,
+                                     FLAGS_output_reconstruction))
+        << "Could not write the reconstruction to: "
+        << FLAGS_output_reconstruction;
+  }
+}
+
 int main(int argc, char* argv[]) {
   THEIA_GFLAGS_NAMESPACE::ParseCommandLineFlags(&argc, &argv, true);
   google::InitGoogleLogging(argv[0]);
 
+  if (!FLAGS_input_reconstruction.empty()) {
+    CalibrateIntrinsicsGroupsOfReconstruction();
+    return 0;
+  }
+
   LOG(INFO) << "This calibration technique simply runs incremental SfM several "
                "times while refining the intrinsic parameters. After each "
                "iteration, the intrinsic parameters output are then used as "
@@ -57,6 +57,8 @@ inline DescriptorExtractorType StringToDescriptorExtractorType(
     return DescriptorExtractorType::SIFT;
   } else if (descriptor == "AKAZE") {
     return DescriptorExtractorType::AKAZE;
+  } else if (descriptor == "SIFT_GPU") {
+    return DescriptorExtractorType::SIFT_GPU;
   } else {
     LOG(FATAL) << "Invalid DescriptorExtractor specified. Using SIFT instead.";
     return DescriptorExtractorType::SIFT;
@@ -99,6 +101,8 @@ inline ReconstructionEstimatorType StringToReconstructionEstimatorType(
     return ReconstructionEstimatorType::INCREMENTAL;
   } else if (reconstruction_estimator == "HYBRID") {
     return ReconstructionEstimatorType::HYBRID;
+  } else if (reconstruction_estimator == "HIERARCHICAL") {
+    return ReconstructionEstimatorType::HIERARCHICAL;
   } else {
     LOG(FATAL)
         << "Invalid reconstruction estimator type. Using GLOBAL instead.";
@@ -39,8 +39,10 @@
 #include <theia/theia.h>
 
 #include <algorithm>
+#include <fstream>
 #include <memory>
 #include <string>
+#include <vector>
 
 DEFINE_string(reference_reconstruction,
               "",
@@ -57,6 +59,12 @@ DEFINE_double(robust_alignment_threshold,
               "If greater than 0.0, this threshold sets determines inliers for "
               "RANSAC alignment of reconstructions. The inliers are then used "
               "for a least squares alignment.");
+DEFINE_int32(num_threads,
+             1,
+             "Number of threads used to compute the errors of the views.");
+DEFINE_string(output_json,
+              "",
+              "If set, the comparison is also written to this file as JSON.");
 
 using theia::Reconstruction;
 using theia::TrackId;
@@ -81,6 +89,35 @@ std::string PrintMeanMedianHistogram(
   return error_msg;
 }
 
+template <typename T>
+std::string VectorToJson(const std::vector<T>& values) {
+  std::string json = "[";
+  for (int i = 0; i < values.size(); i++) {
+    json += (i > 0 ? ", " : "") + std::to_string(values[i]);
+  }
+  return json + "]";
+}
+
+// The machine-readable counterpart of PrintMeanMedianHistogram.
+std::string MeanMedianHistogramJson(const std::vector<double>& sorted_errors,
+                                    const std::vector<double>& histogram_bins) {
+  theia::Histogram<double> histogram(histogram_bins);
+  double mean = 0;
+  for (const auto& error : sorted_errors) {
+    histogram.Add(error);
+    mean += error;
+  }
+  mean /= static_cast<double>(sorted_errors.size());
+  return theia::StringPrintf(
+      "{\"mean\": %.10g, \"median\": %.10g, \"max\": %.10g, "
+      "\"histogram\": {\"boundaries\": %s, \"counts\": %s}}",
+      mean,
+      sorted_errors[sorted_errors.size() / 2],
+      sorted_errors.back(),
+      VectorToJson(histogram.Boundaries()).c_str(),
+      VectorToJson(histogram.Counts()).c_str());
+}
+
 double AngularDifference(const Eigen::Vector3d& rotation1,
                          const Eigen::Vector3d& rotation2) {
   Eigen::Matrix3d rotation1_mat(
@@ -92,10 +129,11 @@ double AngularDifference(const Eigen::Vector3d& rotation1,
 }
 
 // Aligns the orientations of the models (ignoring the positions) and reports
-// the difference in orientations after alignment.
-void EvaluateRotations(const Reconstruction& reference_reconstruction,
-                       const Reconstruction& reconstruction_to_align,
-                       const std::vector<std::string>& common_view_names) {
+// the difference in orientations after alignment. Returns the errors as JSON.
+std::string EvaluateRotations(
+    const Reconstruction& reference_reconstruction,
+    const Reconstruction& reconstruction_to_align,
+    const std::vector<std::string>& common_view_names) {
   // Gather all the rotations in common with both views.
   std::vector<Eigen::Vector3d> rotations1, rotations2;
   rotations1.reserve(common_view_names.size());
@@ -116,9 +154,14 @@ void EvaluateRotations(const Reconstruction& reference_reconstruction,
 
   // Measure the difference in rotations.
   std::vector<double> rotation_error_degrees(rotations1.size());
-  for (int i = 0; i < rotations1.size(); i++) {
-    rotation_error_degrees[i] = AngularDifference(rotations1[i], rotations2[i]);
-  }
+  theia::ParallelFor(FLAGS_num_threads,
+                     rotations1.size(),
+                     [&](const int start, const int end) {
+                       for (int i = start; i < end; i++) {
+                         rotation_error_degrees[i] =
+                             AngularDifference(rotations1[i], rotations2[i]);
+                       }
+                     });
   std::sort(rotation_error_degrees.begin(), rotation_error_degrees.end());
 
   std::vector<double> histogram_bins = {1, 2, 5, 10, 15, 20, 45};
@@ -126,12 +169,15 @@ void EvaluateRotations(const Reconstruction& reference_reconstruction,
       PrintMeanMedianHistogram(rotation_error_degrees, histogram_bins);
   LOG(INFO) << "Rotation difference when aligning orientations:\n"
             << rotation_error_msg;
+  return MeanMedianHistogramJson(rotation_error_degrees, histogram_bins);
 }
 
-// Align the reconstructions then evaluate the pose errors.
-void EvaluateAlignedPoseError(const std::vector<std::string>& common_view_names,
-                              const Reconstruction& reference_reconstruction,
-                              Reconstruction* reconstruction_to_align) {
+// Align the reconstructions then evaluate the pose errors. Returns the errors
+// as JSON.
+std::string EvaluateAlignedPoseError(
+    const std::vector<std::string>& common_view_names,
+    const Reconstruction& reference_reconstruction,
+    Reconstruction* reconstruction_to_align) {
   if (FLAGS_robust_alignment_threshold > 0.0) {
     AlignReconstructionsRobust(FLAGS_robust_alignment_threshold,
                                reference_reconstruction,
@@ -142,32 +188,41 @@ void EvaluateAlignedPoseError(const std::vector<std::string>& common_view_names,
 
   std::vector<double> rotation_bins = {1, 2, 5, 10, 15, 20, 45};
   std::vector<double> position_bins = {1, 5, 10, 50, 100, 1000};
+  const int num_views = common_view_names.size();
+  std::vector<double> rotation_errors(num_views);
+  std::vector<double> position_errors(num_views);
+  std::vector<double> focal_length_errors(num_views);
+  theia::ParallelFor(
+      FLAGS_num_threads, num_views, [&](const int start, const int end) {
+        for (int i = start; i < end; i++) {
+          const ViewId view_id1 =
+              reference_reconstruction.ViewIdFromName(common_view_names[i]);
+          const ViewId view_id2 =
+              reconstruction_to_align->ViewIdFromName(common_view_names[i]);
+          const theia::Camera& camera1 =
+              reference_reconstruction.View(view_id1)->Camera();
+          const theia::Camera& camera2 =
+              reconstruction_to_align->View(view_id2)->Camera();
+
+          // Rotation error.
+          rotation_errors[i] =
+              AngularDifference(camera1.GetOrientationAsAngleAxis(),
+                                camera2.GetOrientationAsAngleAxis());
+
+          // Position error.
+          position_errors[i] =
+              (camera1.GetPosition() - camera2.GetPosition()).norm();
+
+          // Focal length error.
+          focal_length_errors[i] =
+              std::abs(camera1.FocalLength() - camera2.FocalLength()) /
+              camera1.FocalLength();
+        }
+      });
+
   theia::PoseError pose_error(rotation_bins, position_bins);
-  std::vector<double> focal_length_errors(common_view_names.size());
-  for (int i = 0; i < common_view_names.size(); i++) {
-    const ViewId view_id1 =
-        reference_reconstruction.ViewIdFromName(common_view_names[i]);
-    const ViewId view_id2 =
-        reconstruction_to_align->ViewIdFromName(common_view_names[i]);
-    const theia::Camera& camera1 =
-        reference_reconstruction.View(view_id1)->Camera();
-    const theia::Camera& camera2 =
-        reconstruction_to_align->View(view_id2)->Camera();
-
-    // Rotation error.
-    const double rotation_error =
-        AngularDifference(camera1.GetOrientationAsAngleAxis(),
-                          camera2.GetOrientationAsAngleAxis());
-
-    // Position error.
-    const double position_error =
-        (camera1.GetPosition() - camera2.GetPosition()).norm();
-    pose_error.AddError(rotation_error, position_error);
-
-    // Focal length error.
-    focal_length_errors[i] =
-        std::abs(camera1.FocalLength() - camera2.FocalLength()) /
-        camera1.FocalLength();
+  for (int i = 0; i < num_views; i++) {
+    pose_error.AddError(rotation_errors[i], position_errors[i]);
   }
   LOG(INFO) << "Pose error:\n" << pose_error.PrintMeanMedianHistogram();
 
@@ -176,6 +231,14 @@ void EvaluateAlignedPoseError(const std::vector<std::string>& common_view_names,
   const std::string focal_length_error_msg =
       PrintMeanMedianHistogram(focal_length_errors, histogram_bins);
   LOG(INFO) << "Focal length errors: \n" << focal_length_error_msg;
+
+  std::sort(rotation_errors.begin(), rotation_errors.end());
+  std::sort(position_errors.begin(), position_errors.end());
+  return theia::StringPrintf(
+      "{\"rotation\": %s, \"position\": %s, \"focal_length\": %s}",
+      MeanMedianHistogramJson(rotation_errors, rotation_bins).c_str(),
+      MeanMedianHistogramJson(position_errors, position_bins).c_str(),
+      MeanMedianHistogramJson(focal_length_errors, histogram_bins).c_str());
 }
 
 void ComputeTrackLengthHistogram(const Reconstruction& reconstruction) {
@@ -228,13 +291,30 @@ int main(int argc, char* argv[]) {
             << "\n\tReconstruction 2: " << reconstruction_to_align->NumTracks();
 
   // Evaluate rotation independent of positions.
-  EvaluateRotations(
+  const std::string rotation_errors_json = EvaluateRotations(
       *reference_reconstruction, *reconstruction_to_align, common_view_names);
 
   // Align models and evaluate position and rotation errors.
-  EvaluateAlignedPoseError(common_view_names,
-                           *reference_reconstruction,
-                           reconstruction_to_align.get());
+  const std::string pose_errors_json =
+      EvaluateAlignedPoseError(common_view_names,
+                               *reference_reconstruction,
+                               reconstruction_to_align.get());
+
+  if (!FLAGS_output_json.empty()) {
+    std::ofstream json_file(FLAGS_output_json.c_str());
+    CHECK(json_file.is_open()) << "Cannot write to " << FLAGS_output_json;
+    json_file << theia::StringPrintf(
+        "{\"num_views\": [%d, %d], \"num_common_views\": %d, "
+        "\"num_tracks\": [%d, %d], \"rotation_errors_before_alignment\": "
+        "%s, \"aligned_pose_errors\": %s}\n",
+        reference_reconstruction->NumViews(),
+        reconstruction_to_align->NumViews(),
+        static_cast<int>(common_view_names.size()),
+        reference_reconstruction->NumTracks(),
+        reconstruction_to_align->NumTracks(),
+        rotation_errors_json.c_str(),
+        pose_errors_json.c_str());
+  }
 
   return 0;
 }
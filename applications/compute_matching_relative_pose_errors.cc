@@ -47,93 +47,15 @@ DEFINE_string(
 
 DEFINE_string(reconstruction, "", "Reconstruction to use as ground truth.");
 
-using theia::Reconstruction;
-using theia::TrackId;
-using theia::ViewId;
-
-// Computes the error in the relative rotation based on the ground truth
-// rotations rotation1 and rotation2 (which specify world-to-camera
-// transformations).
-double ComputeRelativeRotationError(const Eigen::Matrix3d& rotation1,
-                                    const Eigen::Matrix3d& rotation2,
-                                    const Eigen::Vector3d& relative_rotation) {
-  Eigen::Matrix3d relative_rotation_matrix;
-  ceres::AngleAxisToRotationMatrix(
-      relative_rotation.data(),
-      ceres::ColumnMajorAdapter3x3(relative_rotation_matrix.data()));
-  const Eigen::Matrix3d loop_rotation = relative_rotation_matrix.transpose() *
-                                        (rotation2 * rotation1.transpose());
-  Eigen::Vector3d loop_rotation_aa;
-  ceres::RotationMatrixToAngleAxis(
-      ceres::ColumnMajorAdapter3x3(loop_rotation.data()),
-      loop_rotation_aa.data());
-  return theia::RadToDeg(loop_rotation_aa.norm());
-}
-
-double ComputeRelativeTranslationError(
-    const Eigen::Vector3d& position1,
-    const Eigen::Vector3d& position2,
-    const Eigen::Matrix3d& rotation1,
-    const Eigen::Vector3d& relative_translation) {
-  const Eigen::Vector3d world_translation =
-      rotation1 * (position2 - position1).normalized();
-  return theia::RadToDeg(acos(
-      theia::Clamp(relative_translation.dot(world_translation), -1.0, 1.0)));
-}
-
-void EvaluateRelativeError(const std::vector<std::string>& view_names,
-                           const Reconstruction& gt_reconstruction,
-                           theia::FeaturesAndMatchesDatabase* database) {
-  // For each edge, get the rotate translation and check the error.
-  int num_matches_evaluated = 0;
-  const std::vector<double> histogram_bins = {
-      2, 5, 10, 15, 25, 50, 90, 135, 180, 225, 270, 316};
-
-  theia::PoseError relative_pose_error(histogram_bins, histogram_bins);
-  const auto match_keys = database->ImageNamesOfMatches();
-  for (const auto& match_key : match_keys) {
-    const std::string view1_name = match_key.first;
-    const std::string view2_name = match_key.second;
-    const theia::ImagePairMatch& match =
-        database->GetImagePairMatch(view1_name, view2_name);
-
-    const ViewId view_id1 = gt_reconstruction.ViewIdFromName(view1_name);
-    const ViewId view_id2 = gt_reconstruction.ViewIdFromName(view2_name);
-    const theia::View* view1 = gt_reconstruction.View(view_id1);
-    const theia::View* view2 = gt_reconstruction.View(view_id2);
-    if (view1 == nullptr || view2 == nullptr) {
-      continue;
-    }
-    const theia::Camera& camera1 = view1->Camera();
-    const theia::Camera& camera2 = view2->Camera();
-
-    const double rotation_angular_error =
-        ComputeRelativeRotationError(camera1.GetOrientationAsRotationMatrix(),
-                                     camera2.GetOrientationAsRotationMatrix(),
-                                     match.twoview_info.rotation_2);
-    const double translation_angular_error = ComputeRelativeTranslationError(
-        camera1.GetPosition(),
-        camera2.GetPosition(),
-        camera1.GetOrientationAsRotationMatrix(),
-        match.twoview_info.position_2);
-
-    relative_pose_error.AddError(rotation_angular_error,
-                                 translation_angular_error);
-    ++num_matches_evaluated;
-  }
-  LOG(INFO) << "Evaluated " << view_names.size() << " common views containing "
-            << num_matches_evaluated << " two-view matches.";
-  LOG(INFO) << relative_pose_error.PrintMeanMedianHistogram();
-}
+DEFINE_int32(num_threads,
+             1,
+             "Number of threads used to compute the relative pose errors.");
 
 int main(int argc, char* argv[]) {
   google::InitGoogleLogging(argv[0]);
   THEIA_GFLAGS_NAMESPACE::ParseCommandLineFlags(&argc, &argv, true);
 
   LOG(INFO) << "Reading the matches.";
-
-  std::vector<std::string> view_names;
-  std::vector<theia::CameraIntrinsicsPrior> camera_intrinsics_prior;
   theia::RocksDbFeaturesAndMatchesDatabase features_and_matches_database(
       FLAGS_matches_db);
 
@@ -142,8 +64,15 @@ int main(int argc, char* argv[]) {
   CHECK(theia::ReadReconstruction(FLAGS_reconstruction, reconstruction.get()))
       << "Could not read reconstruction from " << FLAGS_reconstruction;
 
-  EvaluateRelativeError(
-      view_names, *reconstruction, &features_and_matches_database);
+  // The matches are streamed from the database in batches whose errors are
+  // computed in parallel.
+  theia::RelativePoseEvaluatorOptions options;
+  options.num_threads = FLAGS_num_threads;
+  theia::RelativePoseEvaluator evaluator(options, *reconstruction);
+  evaluator.AddMatches(&features_and_matches_database);
+  LOG(INFO) << "Evaluated " << evaluator.NumEvaluatedViewPairs()
+            << " two-view matches between views of the reconstruction.";
+  LOG(INFO) << evaluator.PrintMeanMedianHistogram();
 
   return 0;
 }
@@ -32,37 +32,48 @@
 // Please contact the author of this library if you have any questions.
 // Author: Chris Sweeney (cmsweeney@cs.ucsb.edu)
 
-#include <Eigen/Core>
 #include <gflags/gflags.h>
 #include <glog/logging.h>
 #include <theia/theia.h>
 
-#include <algorithm>
+#include <fstream>
 #include <memory>
 #include <string>
 
 #include "print_reconstruction_statistics.h"
 
 DEFINE_string(reconstruction, "", "Reconstruction file");
+DEFINE_int32(num_threads, 1, "Number of threads used to evaluate the tracks.");
+DEFINE_double(track_sampling_ratio,
+              1.0,
+              "Fraction of the estimated tracks that are evaluated. Values "
+              "below 1 give approximate statistics of large reconstructions "
+              "faster. The same tracks are sampled in every run.");
+DEFINE_string(output_json,
+              "",
+              "If set, the statistics are also written to this file as JSON.");
 
 int main(int argc, char* argv[]) {
   google::InitGoogleLogging(argv[0]);
   THEIA_GFLAGS_NAMESPACE::ParseCommandLineFlags(&argc, &argv, true);
 
-  // Load the SIFT descriptors into the cameras.
   std::unique_ptr<theia::Reconstruction> reconstruction(
       new theia::Reconstruction());
   CHECK(theia::ReadReconstruction(FLAGS_reconstruction, reconstruction.get()))
       << "Could not read reconstruction file.";
 
-  LOG(INFO) << "\nNum views: " << reconstruction->NumViews()
-            << "\nNum 3D points: " << reconstruction->NumTracks();
+  theia::ReconstructionStatisticsOptions options;
+  options.num_threads = FLAGS_num_threads;
+  options.track_sampling_ratio = FLAGS_track_sampling_ratio;
+  const theia::ReconstructionStatistics statistics =
+      theia::ComputeReconstructionStatistics(options, *reconstruction);
+  PrintReconstructionStatistics(statistics);
 
-  // Check that the reprojection errors are sane.
-  PrintReprojectionErrors(*reconstruction);
-
-  // Compute track length statistics.
-  PrintTrackLengthHistogram(*reconstruction);
+  if (!FLAGS_output_json.empty()) {
+    std::ofstream json_file(FLAGS_output_json.c_str());
+    CHECK(json_file.is_open()) << "Cannot write to " << FLAGS_output_json;
+    json_file << theia::ReconstructionStatisticsToJson(statistics);
+  }
 
   return 0;
 }
@@ -35,6 +35,7 @@
 #include <Eigen/Core>
 #include <gflags/gflags.h>
 #include <glog/logging.h>
+#include <atomic>
 #include <string>
 #include <theia/theia.h>
 #include <vector>
@@ -47,28 +48,78 @@ DEFINE_string(output_sift_key_file,
               "",
               "Output sift key file in binary format. Should end in .bin");
 
-// This function will load the sift descriptors from the key text files and
-// convert them to binary files.
+DEFINE_string(input_sift_key_files,
+              "",
+              "Wildcard of sift key text files to convert in a batch, e.g. "
+              "/path/to/keys/*.key. Overrides --input_sift_key_file.");
+
+DEFINE_string(output_directory,
+              "",
+              "Directory for the binary sift key files of the batch. Each file "
+              "is named after its input file with the extension .bin.");
+
+DEFINE_int32(num_threads, 1, "Number of files to convert in parallel.");
+
+// This function will load the sift descriptors from the key text file directly
+// into a contiguous descriptor block and write them to a binary file.
 bool ConvertSiftKeyFile(const std::string& input_sift_key_file,
                         const std::string& output_sift_key_file) {
-  // Read text file.
-  std::vector<Eigen::VectorXf> descriptor;
-  std::vector<theia::Keypoint> keypoint;
-  CHECK(
-      theia::ReadSiftKeyTextFile(input_sift_key_file, &descriptor, &keypoint));
+  theia::KeypointsAndDescriptors features;
+  if (!theia::ReadSiftKeyTextFile(input_sift_key_file, 1, &features)) {
+    LOG(ERROR) << "Could not read " << input_sift_key_file;
+    return false;
+  }
+  if (!theia::WriteSiftKeyBinaryFile(output_sift_key_file, features)) {
+    LOG(ERROR) << "Could not write " << output_sift_key_file;
+    return false;
+  }
+  return true;
+}
 
-  // Write binary file.
-  CHECK(theia::WriteSiftKeyBinaryFile(
-      output_sift_key_file, descriptor, keypoint));
+// Converts the files in parallel. Each file is read with a single thread since
+// there are typically many more files than threads.
+bool ConvertSiftKeyFiles(const std::string& input_sift_key_files,
+                         const std::string& output_directory,
+                         const int num_threads) {
+  std::vector<std::string> input_files;
+  CHECK(theia::GetFilepathsFromWildcard(input_sift_key_files, &input_files))
+      << "Could not find sift key files that matched the filepath: "
+      << input_sift_key_files;
+  if (!theia::DirectoryExists(output_directory)) {
+    CHECK(theia::CreateNewDirectory(output_directory))
+        << "Could not create the output directory: " << output_directory;
+  }
 
-  return true;
+  std::atomic<int> num_failed(0);
+  theia::ParallelFor(
+      num_threads, input_files.size(), [&](const int first, const int last) {
+        for (int i = first; i < last; i++) {
+          std::string filename;
+          CHECK(theia::GetFilenameFromFilepath(
+              input_files[i], false, &filename));
+          const std::string output_file =
+              output_directory + "/" + filename + ".bin";
+          if (!ConvertSiftKeyFile(input_files[i], output_file)) {
+            ++num_failed;
+          }
+        }
+      });
+  LOG(INFO) << "Converted " << input_files.size() - num_failed << " of "
+            << input_files.size() << " sift key files.";
+  return num_failed == 0;
 }
 
 int main(int argc, char* argv[]) {
   google::InitGoogleLogging(argv[0]);
   THEIA_GFLAGS_NAMESPACE::ParseCommandLineFlags(&argc, &argv, true);
 
-  // Load the SIFT descriptors into the cameras.
+  if (!FLAGS_input_sift_key_files.empty()) {
+    CHECK(ConvertSiftKeyFiles(FLAGS_input_sift_key_files,
+                              FLAGS_output_directory,
+                              FLAGS_num_threads));
+    return 0;
+  }
+
   CHECK(ConvertSiftKeyFile(FLAGS_input_sift_key_file,
                            FLAGS_output_sift_key_file));
 
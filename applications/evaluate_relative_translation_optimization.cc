@@ -45,9 +45,16 @@
 
 #include <memory>
 #include <string>
+#include <vector>
 
 DEFINE_string(matches, "", "Matches database directory (generated by RocksDB)");
 DEFINE_string(reconstruction, "", "Reconstruction to use as ground truth.");
+DEFINE_int32(num_threads,
+             1,
+             "Number of threads used to optimize the relative translations.");
+DEFINE_int32(batch_size,
+             4096,
+             "Number of image pairs that are read and optimized at a time.");
 
 using theia::Reconstruction;
 using theia::TrackId;
@@ -85,15 +92,58 @@ void GetFeatureCorrespondences(
   }
 }
 
-double ComputeRelativeTranslationError(
-    const Eigen::Vector3d& position1,
-    const Eigen::Vector3d& position2,
-    const Eigen::Matrix3d& rotation1,
-    const Eigen::Vector3d& relative_translation) {
-  const Eigen::Vector3d world_translation =
-      rotation1 * (position2 - position1).normalized();
-  return theia::RadToDeg(acos(
-      theia::Clamp(relative_translation.dot(world_translation), -1.0, 1.0)));
+// The angular errors of the relative translation of an image pair before and
+// after the optimization. Pairs whose views are not in the reconstruction are
+// not evaluated.
+struct TranslationErrors {
+  bool evaluated = false;
+  double before = 0;
+  double after = 0;
+};
+
+// Optimizes the relative translations of a batch of image pairs in parallel.
+void OptimizeRelativeTranslations(
+    const theia::Reconstruction& reconstruction,
+    const std::vector<ViewIdPair>& view_pairs,
+    const std::vector<theia::TwoViewInfo>& twoview_infos,
+    std::vector<TranslationErrors>* errors) {
+  errors->assign(view_pairs.size(), TranslationErrors());
+  theia::ParallelFor(
+      FLAGS_num_threads,
+      view_pairs.size(),
+      [&](const int start, const int end) {
+        for (int i = start; i < end; i++) {
+          const theia::View* view1 = reconstruction.View(view_pairs[i].first);
+          const theia::View* view2 = reconstruction.View(view_pairs[i].second);
+          if (view1 == nullptr || view2 == nullptr) {
+            continue;
+          }
+          const theia::Camera& camera1 = view1->Camera();
+          const theia::Camera& camera2 = view2->Camera();
+
+          Eigen::Vector3d relative_position = twoview_infos[i].position_2;
+          (*errors)[i].before = theia::RelativeTranslationError(
+              camera1.GetPosition(),
+              camera2.GetPosition(),
+              camera1.GetOrientationAsRotationMatrix(),
+              relative_position);
+
+          // Optimize the relative position and recompute the error.
+          std::vector<theia::FeatureCorrespondence> correspondences;
+          GetFeatureCorrespondences(*view1, *view2, &correspondences);
+          CHECK(theia::OptimizeRelativePositionWithKnownRotation(
+              correspondences,
+              camera1.GetOrientationAsAngleAxis(),
+              camera2.GetOrientationAsAngleAxis(),
+              &relative_position));
+          (*errors)[i].after = theia::RelativeTranslationError(
+              camera1.GetPosition(),
+              camera2.GetPosition(),
+              camera1.GetOrientationAsRotationMatrix(),
+              relative_position);
+          (*errors)[i].evaluated = true;
+        }
+      });
 }
 
 void EvaluateTranslationOptimization(
@@ -108,50 +158,38 @@ void EvaluateTranslationOptimization(
   // Open the DB containing match data.
   theia::RocksDbFeaturesAndMatchesDatabase database(matches_directory);
 
-  // Collect relative translations.
-  const auto match_keys = database.ImageNamesOfMatches();
-  for (const auto& match_key : match_keys) {
-    const theia::ImagePairMatch& match =
-        database.GetImagePairMatch(match_key.first, match_key.second);
-    // Get the ViewIds from the names.
-    const theia::ViewId view_id1 = reconstruction.ViewIdFromName(match.image1);
-    const theia::ViewId view_id2 = reconstruction.ViewIdFromName(match.image2);
-    const theia::View* view1 = reconstruction.View(view_id1);
-    const theia::View* view2 = reconstruction.View(view_id2);
-    if (view1 == nullptr || view2 == nullptr) {
-      continue;
+  // Stream the relative translations from the database and optimize them in
+  // batches.
+  std::vector<ViewIdPair> view_pairs;
+  std::vector<theia::TwoViewInfo> twoview_infos;
+  const auto evaluate_batch = [&]() {
+    std::vector<TranslationErrors> errors;
+    OptimizeRelativeTranslations(
+        reconstruction, view_pairs, twoview_infos, &errors);
+    for (const TranslationErrors& error : errors) {
+      if (!error.evaluated) {
+        continue;
+      }
+      before_hist.Add(error.before);
+      after_hist.Add(error.after);
+      change_hist.Add(error.after - error.before);
     }
-    const theia::Camera& camera1 = view1->Camera();
-    const theia::Camera& camera2 = view2->Camera();
-
-    Eigen::Vector3d relative_position = match.twoview_info.position_2;
-    const double translation_angular_error = ComputeRelativeTranslationError(
-        camera1.GetPosition(),
-        camera2.GetPosition(),
-        camera1.GetOrientationAsRotationMatrix(),
-        relative_position);
-    before_hist.Add(translation_angular_error);
-
-    // Optimize the relative position and recompute the error.
-    std::vector<theia::FeatureCorrespondence> correspondences;
-    GetFeatureCorrespondences(*view1, *view2, &correspondences);
-    CHECK(theia::OptimizeRelativePositionWithKnownRotation(
-        correspondences,
-        camera1.GetOrientationAsAngleAxis(),
-        camera2.GetOrientationAsAngleAxis(),
-        &relative_position));
-
-    const double optimized_translation_angular_error =
-        ComputeRelativeTranslationError(
-            camera1.GetPosition(),
-            camera2.GetPosition(),
-            camera1.GetOrientationAsRotationMatrix(),
-            relative_position);
-    after_hist.Add(optimized_translation_angular_error);
-
-    change_hist.Add(optimized_translation_angular_error -
-                    translation_angular_error);
-  }
+    view_pairs.clear();
+    twoview_infos.clear();
+  };
+  database.ForEachImagePairMatch([&](const std::string& image_name1,
+                                     const std::string& image_name2,
+                                     const theia::ImagePairMatch& match) {
+    view_pairs.emplace_back(reconstruction.ViewIdFromName(image_name1),
+                            reconstruction.ViewIdFromName(image_name2));
+    twoview_infos.emplace_back(match.twoview_info);
+    if (view_pairs.size() == FLAGS_batch_size) {
+      evaluate_batch();
+    }
+    return true;
+  });
+  evaluate_batch();
+
   LOG(INFO) << "Before histogram:\n"
             << before_hist.PrintString() << "\n\nAfter histogram:\n"
             << after_hist.PrintString() << "\n\nChange histogram:\n"
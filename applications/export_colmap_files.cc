@@ -40,11 +40,61 @@
 
 #include <algorithm>
 #include <string>
+#include <vector>
 
 DEFINE_string(output_folder, "", "Folder to output the colmap files.");
 DEFINE_string(input_reconstruction_file,
               "",
               "Input Theia reconstruction (.bin).");
+DEFINE_bool(binary,
+            false,
+            "Write the COLMAP binary files (cameras.bin, images.bin and "
+            "points3D.bin) instead of the text files.");
+DEFINE_int32(num_threads,
+             1,
+             "Number of threads used to format the output and to undistort "
+             "the images.");
+DEFINE_string(input_image_directory,
+              "",
+              "If set, the reconstruction and the images in this directory "
+              "are undistorted, and the output folder is laid out as a COLMAP "
+              "dense workspace: the undistorted images are written to "
+              "<output_folder>/images and the model to "
+              "<output_folder>/sparse.");
+
+// Undistorts the reconstruction in place and writes the undistorted images of
+// its estimated views to the directory.
+void UndistortImagesToDirectory(const std::string& output_image_directory,
+                                theia::Reconstruction* reconstruction) {
+  const theia::Reconstruction distorted_reconstruction = *reconstruction;
+  CHECK(theia::UndistortReconstruction(reconstruction))
+      << "Could not undistort the reconstruction.";
+
+  std::string input_image_directory = FLAGS_input_image_directory;
+  theia::AppendTrailingSlashIfNeeded(&input_image_directory);
+  std::vector<theia::UndistortImageJob> jobs;
+  for (const theia::ViewId view_id : reconstruction->ViewIds()) {
+    const theia::View* view = reconstruction->View(view_id);
+    if (!view->IsEstimated()) {
+      continue;
+    }
+    theia::UndistortImageJob job;
+    job.input_image_filepath = input_image_directory + view->Name();
+    job.output_image_filepath = output_image_directory + view->Name();
+    job.distorted_camera = distorted_reconstruction.View(view_id)->Camera();
+    job.undistorted_camera = view->Camera();
+    jobs.emplace_back(job);
+  }
+
+  theia::UndistortionMapCache undistortion_maps;
+  theia::UndistortImagesOptions options;
+  options.num_threads = FLAGS_num_threads;
+  const int num_images_written =
+      theia::UndistortImages(options, jobs, &undistortion_maps);
+  LOG(INFO) << "Wrote " << num_images_written << " of " << jobs.size()
+            << " undistorted images to " << output_image_directory;
+}
+
 int main(int argc, char* argv[]) {
   google::InitGoogleLogging(argv[0]);
   THEIA_GFLAGS_NAMESPACE::ParseCommandLineFlags(&argc, &argv, true);
@@ -55,7 +105,28 @@ int main(int argc, char* argv[]) {
                                   &reconstruction))
       << "Could not read reconstruction.";
 
-  CHECK(WriteColmapFiles(reconstruction, FLAGS_output_folder))
-      << "Could not write out reconstruction file.";
+  std::string model_folder = FLAGS_output_folder;
+  if (!FLAGS_input_image_directory.empty()) {
+    theia::AppendTrailingSlashIfNeeded(&model_folder);
+    const std::string image_directory = model_folder + "images/";
+    model_folder += "sparse";
+    for (const std::string& directory :
+         {FLAGS_output_folder, image_directory, model_folder}) {
+      if (!theia::DirectoryExists(directory)) {
+        CHECK(theia::CreateNewDirectory(directory))
+            << "Could not create the directory: " << directory;
+      }
+    }
+    UndistortImagesToDirectory(image_directory, &reconstruction);
+  }
+
+  if (FLAGS_binary) {
+    CHECK(WriteColmapBinaryFiles(
+        reconstruction, model_folder, FLAGS_num_threads))
+        << "Could not write out reconstruction file.";
+  } else {
+    CHECK(WriteColmapFiles(reconstruction, model_folder, FLAGS_num_threads))
+        << "Could not write out reconstruction file.";
+  }
   return 0;
 }
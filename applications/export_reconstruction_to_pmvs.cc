@@ -37,6 +37,8 @@
 #include <theia/theia.h>
 
 #include <fstream>  // NOLINT
+#include <string>
+#include <vector>
 
 DEFINE_string(reconstruction, "", "Theia Reconstruction file.");
 DEFINE_string(images,
@@ -46,7 +48,9 @@ DEFINE_string(images,
 DEFINE_string(pmvs_working_directory,
               "",
               "A directory to store the necessary pmvs files.");
-DEFINE_int32(num_threads, 1, "Number of threads used in PMVS.");
+DEFINE_int32(num_threads,
+             1,
+             "Number of threads used to undistort the images and in PMVS.");
 
 void CreateDirectoryIfDoesNotExist(const std::string& directory) {
   if (!theia::DirectoryExists(directory)) {
@@ -69,6 +73,9 @@ int WriteCamerasToPMVS(const theia::Reconstruction& reconstruction) {
   // Format for printing eigen matrices.
   const Eigen::IOFormat unaligned(Eigen::StreamPrecision, Eigen::DontAlignCols);
 
+  // The projection matrices are written right away, and the images are
+  // undistorted and written in parallel afterwards.
+  std::vector<theia::UndistortImageJob> jobs;
   int current_image_index = 0;
   for (int i = 0; i < image_files.size(); i++) {
     std::string image_name;
@@ -78,40 +85,41 @@ int WriteCamerasToPMVS(const theia::Reconstruction& reconstruction) {
       continue;
     }
 
-    LOG(INFO) << "Undistorting image " << image_name;
-    const theia::Camera& distorted_camera =
-        reconstruction.View(view_id)->Camera();
-    theia::Camera undistorted_camera;
-    CHECK(theia::UndistortCamera(distorted_camera, &undistorted_camera));
-
-    theia::FloatImage distorted_image(image_files[i]);
-    theia::FloatImage undistorted_image;
-    CHECK(theia::UndistortImage(distorted_camera,
-                                distorted_image,
-                                undistorted_camera,
-                                &undistorted_image));
-
     LOG(INFO) << "Exporting parameters for image: " << image_name;
+    theia::UndistortImageJob job;
+    job.distorted_camera = reconstruction.View(view_id)->Camera();
+    CHECK(theia::UndistortCamera(job.distorted_camera,
+                                 &job.undistorted_camera));
 
     // Copy the image into a jpeg format with the filename in the form of
     // %08d.jpg.
-    const std::string new_image_file = theia::StringPrintf(
+    job.input_image_filepath = image_files[i];
+    job.output_image_filepath = theia::StringPrintf(
         "%s/%08d.jpg", visualize_dir.c_str(), current_image_index);
-    undistorted_image.Write(new_image_file);
 
     // Write the camera projection matrix.
     const std::string txt_file = theia::StringPrintf(
         "%s/%08d.txt", txt_dir.c_str(), current_image_index);
     theia::Matrix3x4d projection_matrix;
-    undistorted_camera.GetProjectionMatrix(&projection_matrix);
+    job.undistorted_camera.GetProjectionMatrix(&projection_matrix);
     std::ofstream ofs(txt_file);
     ofs << "CONTOUR" << std::endl;
     ofs << projection_matrix.format(unaligned);
     ofs.close();
 
+    jobs.emplace_back(job);
     ++current_image_index;
   }
 
+  // Views that share a camera reuse the same undistortion map.
+  LOG(INFO) << "Undistorting " << jobs.size() << " images.";
+  theia::UndistortionMapCache undistortion_maps;
+  theia::UndistortImagesOptions options;
+  options.num_threads = FLAGS_num_threads;
+  CHECK_EQ(theia::UndistortImages(options, jobs, &undistortion_maps),
+           static_cast<int>(jobs.size()))
+      << "Not all images could be undistorted.";
+
   return current_image_index;
 }
 
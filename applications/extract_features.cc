@@ -61,6 +61,15 @@ DEFINE_string(feature_density,
               "NORMAL",
               "Set to SPARSE, NORMAL, or DENSE to extract fewer or more "
               "features from each image.");
+DEFINE_int32(num_shards,
+             1,
+             "Number of workers that the images are split across. Each worker "
+             "runs this program with the same images and output directory and "
+             "its own --shard_index.");
+DEFINE_int32(shard_index,
+             0,
+             "The shard of the images to extract features from, in "
+             "[0, num_shards).");
 
 int main(int argc, char* argv[]) {
   THEIA_GFLAGS_NAMESPACE::ParseCommandLineFlags(&argc, &argv, true);
@@ -72,6 +81,31 @@ int main(int argc, char* argv[]) {
   CHECK_GT(img_filepaths.size(), 0)
       << "No images found in: " << FLAGS_input_images;
 
+  // Only keep the images of this shard. Images are assigned to shards by their
+  // filename so that all workers agree on the assignment.
+  if (FLAGS_num_shards > 1) {
+    std::vector<std::string> img_filenames(img_filepaths.size());
+    for (int i = 0; i < img_filepaths.size(); i++) {
+      CHECK(theia::GetFilenameFromFilepath(
+          img_filepaths[i], true, &img_filenames[i]));
+    }
+    const std::vector<std::string> shard_filenames = theia::ImagesOfShard(
+        img_filenames, FLAGS_num_shards, FLAGS_shard_index);
+    std::vector<std::string> shard_filepaths;
+    for (int i = 0, j = 0;
+         i < img_filepaths.size() && j < shard_filenames.size();
+         i++) {
+      if (img_filenames[i] == shard_filenames[j]) {
+        shard_filepaths.emplace_back(img_filepaths[i]);
+        ++j;
+      }
+    }
+    LOG(INFO) << "Extracting features from " << shard_filepaths.size()
+              << " of " << img_filepaths.size() << " images in shard "
+              << FLAGS_shard_index << " of " << FLAGS_num_shards << ".";
+    img_filepaths.swap(shard_filepaths);
+  }
+
   // Set up the feature extractor.
   theia::FeatureExtractor::Options options;
   options.descriptor_extractor_type =
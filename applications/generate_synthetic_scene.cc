@@ -0,0 +1,153 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+// Generates a reproducible synthetic scene of arbitrary size for benchmarks
+// and capacity tests, see theia/sfm/synthetic_scene.h. The ground truth
+// reconstruction (whose tracks hold the noisy observations), the view graph of
+// verified relative poses and, if Theia is built with RocksDB, a features and
+// matches database of the scene are written. For example:
+//
+//   ./generate_synthetic_scene --num_views=100000 --num_points=5000000 \
+//       --output_reconstruction=scene.bin --output_view_graph=scene.vg \
+//       --output_matches_database_directory=scene_db --num_threads=16
+
+#include <gflags/gflags.h>
+#include <glog/logging.h>
+#include <theia/theia.h>
+
+#include <memory>
+#include <string>
+
+DEFINE_int32(num_views, 1000, "Number of views.");
+DEFINE_int32(num_points, 100000, "Number of 3D points.");
+DEFINE_double(camera_spacing,
+              1.0,
+              "Distance between neighboring cameras of the grid.");
+DEFINE_double(camera_height, 10.0, "Height of the cameras above the ground.");
+DEFINE_double(max_point_height, 2.0, "Maximum height of the 3D points.");
+DEFINE_double(max_camera_tilt_degrees,
+              5.0,
+              "Maximum tilt of the cameras from looking straight down.");
+DEFINE_int32(max_track_length, 8, "Maximum number of views per track.");
+DEFINE_double(pixel_noise,
+              0.5,
+              "Standard deviation of the observation noise in pixels.");
+DEFINE_double(outlier_observation_ratio,
+              0.0,
+              "Fraction of the observations that are random pixels.");
+DEFINE_int32(min_num_shared_tracks,
+             16,
+             "Minimum number of shared tracks of a view graph edge.");
+DEFINE_double(relative_rotation_noise_degrees,
+              0.0,
+              "Maximum noise of the relative rotations and translation "
+              "directions of the view graph edges.");
+DEFINE_double(outlier_edge_ratio,
+              0.0,
+              "Fraction of the view graph edges with a random relative pose.");
+DEFINE_int32(descriptor_dimension,
+             0,
+             "Dimension of the random descriptors written to the database. "
+             "No descriptors are written if 0.");
+DEFINE_int32(seed, 42, "Seed of the random numbers.");
+DEFINE_int32(num_threads, 1, "Number of threads to use.");
+DEFINE_string(output_reconstruction,
+              "",
+              "If set, the ground truth reconstruction is written here.");
+DEFINE_string(output_view_graph,
+              "",
+              "If set, the view graph is written here.");
+DEFINE_string(output_matches_database_directory,
+              "",
+              "If set, the features and matches of the scene are written to a "
+              "RocksDB database in this directory.");
+
+int main(int argc, char* argv[]) {
+  THEIA_GFLAGS_NAMESPACE::ParseCommandLineFlags(&argc, &argv, true);
+  google::InitGoogleLogging(argv[0]);
+
+  theia::SyntheticSceneOptions options;
+  options.num_views = FLAGS_num_views;
+  options.num_points = FLAGS_num_points;
+  options.camera_spacing = FLAGS_camera_spacing;
+  options.camera_height = FLAGS_camera_height;
+  options.max_point_height = FLAGS_max_point_height;
+  options.max_camera_tilt_degrees = FLAGS_max_camera_tilt_degrees;
+  options.max_track_length = FLAGS_max_track_length;
+  options.pixel_noise = FLAGS_pixel_noise;
+  options.outlier_observation_ratio = FLAGS_outlier_observation_ratio;
+  options.min_num_shared_tracks = FLAGS_min_num_shared_tracks;
+  options.relative_rotation_noise_degrees =
+      FLAGS_relative_rotation_noise_degrees;
+  options.outlier_edge_ratio = FLAGS_outlier_edge_ratio;
+  options.descriptor_dimension = FLAGS_descriptor_dimension;
+  options.seed = FLAGS_seed;
+  options.num_threads = FLAGS_num_threads;
+
+  theia::Timer timer;
+  theia::Reconstruction reconstruction;
+  theia::ViewGraph view_graph;
+  CHECK(theia::GenerateSyntheticScene(options, &reconstruction, &view_graph))
+      << "The scene does not have any tracks.";
+  LOG(INFO) << "Generated " << reconstruction.NumViews() << " views, "
+            << reconstruction.NumTracks() << " tracks and "
+            << view_graph.NumEdges() << " view graph edges in "
+            << timer.ElapsedTimeInSeconds() << " seconds.";
+
+  if (!FLAGS_output_reconstruction.empty()) {
+    CHECK(theia::WriteReconstruction(reconstruction,
+                                     FLAGS_output_reconstruction))
+        << "Could not write the reconstruction to "
+        << FLAGS_output_reconstruction;
+  }
+  if (!FLAGS_output_view_graph.empty()) {
+    CHECK(view_graph.WriteToDisk(FLAGS_output_view_graph))
+        << "Could not write the view graph to " << FLAGS_output_view_graph;
+  }
+  if (!FLAGS_output_matches_database_directory.empty()) {
+#ifdef WITH_ROCKSDB
+    timer.Reset();
+    theia::RocksDbFeaturesAndMatchesDatabase database(
+        FLAGS_output_matches_database_directory);
+    theia::WriteSyntheticSceneToDatabase(
+        options, reconstruction, view_graph, &database);
+    LOG(INFO) << "Wrote the features and matches database in "
+              << timer.ElapsedTimeInSeconds() << " seconds.";
+#else
+    LOG(FATAL) << "Writing the database requires Theia to be built with "
+                  "RocksDB.";
+#endif
+  }
+  return 0;
+}
@@ -0,0 +1,86 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+
+#include <gflags/gflags.h>
+#include <glog/logging.h>
+#include <memory>
+#include <sstream>  // NOLINT
+#include <string>
+#include <theia/theia.h>
+#include <vector>
+
+DEFINE_string(shard_directories,
+              "",
+              "Comma-separated list of the RocksDB feature and match database "
+              "directories written by the workers of a sharded run.");
+DEFINE_string(output_directory,
+              "",
+              "Directory of the RocksDB database that the shards are merged "
+              "into. Features and matches already in it are not copied again, "
+              "so an interrupted merge can be run again.");
+
+int main(int argc, char* argv[]) {
+  THEIA_GFLAGS_NAMESPACE::ParseCommandLineFlags(&argc, &argv, true);
+  google::InitGoogleLogging(argv[0]);
+
+#ifdef WITH_ROCKSDB
+  CHECK_GT(FLAGS_output_directory.size(), 0);
+
+  std::vector<std::unique_ptr<theia::FeaturesAndMatchesDatabase> > shards;
+  std::vector<theia::FeaturesAndMatchesDatabase*> shard_pointers;
+  std::stringstream shard_directories(FLAGS_shard_directories);
+  std::string shard_directory;
+  while (std::getline(shard_directories, shard_directory, ',')) {
+    if (shard_directory.empty()) {
+      continue;
+    }
+    shards.emplace_back(
+        new theia::RocksDbFeaturesAndMatchesDatabase(shard_directory));
+    shard_pointers.emplace_back(shards.back().get());
+  }
+  CHECK_GT(shards.size(), 0) << "No shard directories were given.";
+
+  theia::RocksDbFeaturesAndMatchesDatabase merged(FLAGS_output_directory);
+  theia::Timer timer;
+  const int num_copied =
+      theia::MergeFeaturesAndMatchesDatabases(shard_pointers, &merged);
+  LOG(INFO) << "Copied " << num_copied << " features and matches from "
+            << shards.size() << " shards in " << timer.ElapsedTimeInSeconds()
+            << " seconds. The merged database has " << merged.NumImages()
+            << " images and " << merged.NumMatches() << " matches.";
+#else
+  LOG(FATAL) << "Merging databases requires Theia to be built with RocksDB.";
+#endif
+}
@@ -35,92 +35,73 @@
 #ifndef APPLICATIONS_PRINT_RECONSTRUCTION_STATISTICS_H_
 #define APPLICATIONS_PRINT_RECONSTRUCTION_STATISTICS_H_
 
-#include <Eigen/Core>
 #include <glog/logging.h>
 #include <theia/theia.h>
 
-#include <algorithm>
 #include <string>
-#include <vector>
 
-inline void PrintReprojectionErrors(
-    const theia::Reconstruction& reconstruction) {
-  std::vector<double> reprojection_errors;
-  int num_projections_behind_camera = 0;
-  for (const theia::TrackId track_id : reconstruction.TrackIds()) {
-    const theia::Track* track = CHECK_NOTNULL(reconstruction.Track(track_id));
-    for (const theia::ViewId view_id : track->ViewIds()) {
-      const theia::Feature* feature =
-          reconstruction.View(view_id)->GetFeature(track_id);
-
-      // Reproject the observations.
-      Eigen::Vector2d projection;
-      if (reconstruction.View(view_id)->Camera().ProjectPoint(
-              track->Point(), &projection) < 0) {
-        ++num_projections_behind_camera;
-      }
-
-      // Compute reprojection error.
-      const double reprojection_error = ((*feature).point_ - projection).norm();
-      reprojection_errors.emplace_back(reprojection_error);
-    }
-  }
+// Logs the statistics computed by theia::ComputeReconstructionStatistics.
+inline void PrintReconstructionStatistics(
+    const theia::ReconstructionStatistics& statistics) {
+  LOG(INFO) << "\nNum views: " << statistics.num_views
+            << " (" << statistics.num_estimated_views << " estimated)"
+            << "\nNum 3D points: " << statistics.num_tracks << " ("
+            << statistics.num_estimated_tracks << " estimated, "
+            << statistics.num_evaluated_tracks << " evaluated)";
 
-  if (reprojection_errors.size() == 0) {
+  if (statistics.num_observations == 0) {
     LOG(INFO) << "No estimated 3d points were found. Cannot compute "
                  "reprojection error statistics.";
     return;
   }
+  LOG(INFO) << "\nNum observations: " << statistics.num_observations
+            << "\nNum reprojections behind camera: "
+            << statistics.num_projections_behind_camera
+            << "\nMean reprojection error = "
+            << statistics.mean_reprojection_error
+            << "\nMedian reprojection_error = "
+            << statistics.median_reprojection_error
+            << "\nMax reprojection_error = "
+            << statistics.max_reprojection_error;
 
-  std::sort(reprojection_errors.begin(), reprojection_errors.end());
-  const double mean_reprojection_error =
-      std::accumulate(
-          reprojection_errors.begin(), reprojection_errors.end(), 0.0) /
-      static_cast<double>(reprojection_errors.size());
-  const double median_reprojection_error =
-      reprojection_errors[reprojection_errors.size() / 2];
+  LOG(INFO) << "Mean track length: " << statistics.mean_track_length;
+  LOG(INFO) << "Median track length: " << statistics.median_track_length;
+  LOG(INFO) << "Track length histogram = \n"
+            << statistics.track_length_histogram.PrintString();
+}
 
-  LOG(INFO) << "\nNum observations: " << reprojection_errors.size()
+inline void PrintReprojectionErrors(
+    const theia::Reconstruction& reconstruction) {
+  const theia::ReconstructionStatistics statistics =
+      theia::ComputeReconstructionStatistics(
+          theia::ReconstructionStatisticsOptions(), reconstruction);
+  if (statistics.num_observations == 0) {
+    LOG(INFO) << "No estimated 3d points were found. Cannot compute "
+                 "reprojection error statistics.";
+    return;
+  }
+  LOG(INFO) << "\nNum observations: " << statistics.num_observations
             << "\nNum reprojections behind camera: "
-            << num_projections_behind_camera
-            << "\nMean reprojection error = " << mean_reprojection_error
-            << "\nMedian reprojection_error = " << median_reprojection_error;
+            << statistics.num_projections_behind_camera
+            << "\nMean reprojection error = "
+            << statistics.mean_reprojection_error
+            << "\nMedian reprojection_error = "
+            << statistics.median_reprojection_error;
 }
 
 inline void PrintTrackLengthHistogram(
     const theia::Reconstruction& reconstruction) {
-  std::vector<int> histogram_bins = {
-      2, 3, 4, 5, 6, 7, 8, 9, 10, 15, 20, 25, 50};
-  theia::Histogram<int> histogram(histogram_bins);
-  std::vector<int> track_lengths;
-  for (const theia::TrackId track_id : reconstruction.TrackIds()) {
-    const theia::Track* track = reconstruction.Track(track_id);
-    track_lengths.emplace_back(track->NumViews());
-    histogram.Add(track->NumViews());
-  }
-
-  // Exit if there were no tracks found.
-  if (track_lengths.size() == 0) {
+  const theia::ReconstructionStatistics statistics =
+      theia::ComputeReconstructionStatistics(
+          theia::ReconstructionStatisticsOptions(), reconstruction);
+  if (statistics.num_evaluated_tracks == 0) {
     LOG(INFO) << "No valid tracks were present in the reconstruction.";
     return;
   }
-
-  // Compute the mean and median track lengths.
-  const float mean_track_length =
-      std::accumulate(track_lengths.begin(), track_lengths.end(), 0) /
-      static_cast<float>(track_lengths.size());
-  LOG(INFO) << "Mean track length: " << mean_track_length;
-
-  // Sort the median track length.
-  std::nth_element(track_lengths.begin(),
-                   track_lengths.begin() + track_lengths.size() / 2,
-                   track_lengths.end());
-  const int median_track_length = track_lengths[track_lengths.size() / 2];
-  LOG(INFO) << "Median track length: " << median_track_length;
-
-  // Display the track length histogram.
-  const std::string hist_msg = histogram.PrintString();
-  LOG(INFO) << "Track length histogram = \n" << hist_msg;
+  LOG(INFO) << "Mean track length: " << statistics.mean_track_length;
+  LOG(INFO) << "Median track length: " << statistics.median_track_length;
+  LOG(INFO) << "Track length histogram = \n"
+            << statistics.track_length_histogram.PrintString();
 }
 
 #endif  // APPLICATIONS_PRINT_RECONSTRUCTION_STATISTICS_H_
@@ -39,6 +39,7 @@
 
 #include <algorithm>
 #include <string>
+#include <vector>
 
 DEFINE_string(input_reconstruction,
               "",
@@ -61,26 +62,6 @@ DEFINE_string(output_image_directory,
 
 DEFINE_int32(num_threads, 1, "Number of threads to use for undistortion.");
 
-void UndistortImageAndWriteToFile(const std::string input_image_filepath,
-                                  const std::string output_image_filepath,
-                                  const theia::Camera& distorted_camera,
-                                  const theia::Camera& undistorted_camera) {
-  LOG(INFO) << "Undistorting image " << input_image_filepath;
-
-  // Undistort the image.
-  const theia::FloatImage distorted_image(input_image_filepath);
-  theia::FloatImage undistorted_image;
-  CHECK(theia::UndistortImage(distorted_camera,
-                              distorted_image,
-                              undistorted_camera,
-                              &undistorted_image))
-      << "Could not undistort image: " << input_image_filepath;
-
-  // Save the image to the output directory.
-  LOG(INFO) << "Writing undistorted image to: " << output_image_filepath;
-  undistorted_image.Write(output_image_filepath);
-}
-
 int main(int argc, char* argv[]) {
   google::InitGoogleLogging(argv[0]);
   THEIA_GFLAGS_NAMESPACE::ParseCommandLineFlags(&argc, &argv, true);
@@ -114,24 +95,30 @@ int main(int argc, char* argv[]) {
   std::string output_image_directory = FLAGS_output_image_directory;
   theia::AppendTrailingSlashIfNeeded(&output_image_directory);
 
-  // Undistort images in parallel.
-  theia::ThreadPool pool(FLAGS_num_threads);
-  const auto& view_ids = distorted_reconstruction.ViewIds();
-  for (const theia::ViewId view_id : view_ids) {
+  // Undistort images in parallel. Views that share a camera reuse the same
+  // undistortion map.
+  std::vector<theia::UndistortImageJob> jobs;
+  for (const theia::ViewId view_id : distorted_reconstruction.ViewIds()) {
     const theia::View* distorted_view = distorted_reconstruction.View(view_id);
     const theia::View* undistorted_view =
         undistorted_reconstruction.View(view_id);
 
-    const std::string input_image_filepath =
-        FLAGS_input_image_directory + distorted_view->Name();
-    const std::string output_image_filepath =
-        FLAGS_output_image_directory + undistorted_view->Name();
-    pool.Add(UndistortImageAndWriteToFile,
-             input_image_filepath,
-             output_image_filepath,
-             distorted_view->Camera(),
-             undistorted_view->Camera());
+    theia::UndistortImageJob job;
+    job.input_image_filepath = input_image_directory + distorted_view->Name();
+    job.output_image_filepath =
+        output_image_directory + undistorted_view->Name();
+    job.distorted_camera = distorted_view->Camera();
+    job.undistorted_camera = undistorted_view->Camera();
+    jobs.emplace_back(job);
   }
 
+  theia::UndistortionMapCache undistortion_maps;
+  theia::UndistortImagesOptions options;
+  options.num_threads = FLAGS_num_threads;
+  const int num_images_written =
+      theia::UndistortImages(options, jobs, &undistortion_maps);
+  LOG(INFO) << "Wrote " << num_images_written << " of " << jobs.size()
+            << " undistorted images to " << output_image_directory;
+
   return 0;
 }
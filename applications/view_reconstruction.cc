@@ -35,8 +35,17 @@
 #include <Eigen/Core>
 #include <gflags/gflags.h>
 #include <glog/logging.h>
-#include <string>
 #include <theia/theia.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <queue>
+#include <random>
+#include <string>
+#include <utility>
 #include <vector>
 
 #ifdef __APPLE__
@@ -60,12 +69,56 @@
 #endif  // __APPLE__
 
 DEFINE_string(reconstruction, "", "Reconstruction file to be viewed.");
+DEFINE_int32(max_rendered_points,
+             5000000,
+             "Maximum number of points drawn per frame. The nodes of the "
+             "point octree closest to the viewer are refined first.");
+DEFINE_int32(gpu_memory_budget_in_mb,
+             1024,
+             "GPU memory used for point buffers. The buffers of the octree "
+             "nodes that were not drawn for the longest time are freed when "
+             "the budget is exceeded.");
+
+// The points are stored in an octree where every node holds a uniform
+// subsample of the points in its bounding box that are not held by any of
+// its ancestors. Drawing a node and any subset of its descendants therefore
+// renders the points at a level of detail that increases with the number of
+// descendants drawn, and no point is drawn twice.
+static const int kMaxPointsPerOctreeNode = 32768;
+static const int kMaxOctreeDepth = 21;
+// Nodes are only refined while they cover more pixels than this.
+static const float kMinOctreeNodeSizeInPixels = 64.0f;
+// Point buffers are uploaded to the GPU when a node is first drawn. Limiting
+// the uploads per frame keeps the viewer responsive while the detail of a new
+// viewpoint streams in.
+static const int kMaxOctreeNodeUploadsPerFrame = 16;
+
+// The layout of a point in the vertex buffers.
+struct PointVertex {
+  float position[3];
+  uint8_t color[4];
+};
+
+struct OctreeNode {
+  Eigen::Vector3f min_corner;
+  Eigen::Vector3f max_corner;
+  std::vector<PointVertex> points;
+  // The points are sorted by decreasing number of views, and entry i holds the
+  // number of points observed in at least i views, so that the points with
+  // too few views are skipped by drawing a prefix of the buffer.
+  std::vector<int> num_points_with_min_num_views;
+  int children[8] = {-1, -1, -1, -1, -1, -1, -1, -1};
+
+  GLuint vertex_buffer = 0;
+  int last_drawn_frame = -1;
+};
 
 // Containers for the data.
 std::vector<theia::Camera> cameras;
-std::vector<Eigen::Vector3d> world_points;
-std::vector<Eigen::Vector3f> point_colors;
-std::vector<int> num_views_for_track;
+std::vector<OctreeNode> octree_nodes;
+size_t gpu_memory_in_bytes = 0;
+int frame_number = 0;
+GLuint point_shader_program = 0;
 
 // Parameters for OpenGL.
 int width = 1200;
@@ -197,47 +250,374 @@ void DrawCamera(const theia::Camera& camera) {
   glPopMatrix();
 }
 
-void DrawPoints(const float point_scale,
+int NumPointsToDraw(const OctreeNode& node) {
+  if (min_num_views_for_track <= 0) {
+    return node.points.size();
+  }
+  if (min_num_views_for_track >= node.num_points_with_min_num_views.size()) {
+    return 0;
+  }
+  return node.num_points_with_min_num_views[min_num_views_for_track];
+}
+
+// Builds the subtree of the points indexed by [begin, end), which are in
+// random order, and returns the index of its root node.
+int BuildOctreeNode(const std::vector<Eigen::Vector3f>& world_points,
+                    const std::vector<Eigen::Vector3f>& point_colors,
+                    const std::vector<int>& num_views_for_track,
+                    const Eigen::Vector3f& min_corner,
+                    const Eigen::Vector3f& max_corner,
+                    const int depth,
+                    const std::vector<int>::iterator begin,
+                    const std::vector<int>::iterator end) {
+  const int node_index = octree_nodes.size();
+  octree_nodes.emplace_back();
+  octree_nodes[node_index].min_corner = min_corner;
+  octree_nodes[node_index].max_corner = max_corner;
+
+  // The points are in random order, so the first points of the range are a
+  // uniform subsample of it.
+  const int num_points = std::distance(begin, end);
+  const std::vector<int>::iterator end_of_node =
+      (num_points <= kMaxPointsPerOctreeNode || depth == kMaxOctreeDepth)
+          ? end
+          : begin + kMaxPointsPerOctreeNode;
+  std::vector<int> node_points(begin, end_of_node);
+  std::stable_sort(node_points.begin(), node_points.end(), [&](int i, int j) {
+    return num_views_for_track[i] > num_views_for_track[j];
+  });
+
+  OctreeNode& node = octree_nodes[node_index];
+  node.points.resize(node_points.size());
+  for (int i = 0; i < node_points.size(); i++) {
+    const int point_index = node_points[i];
+    Eigen::Map<Eigen::Vector3f>(node.points[i].position) =
+        world_points[point_index];
+    for (int j = 0; j < 3; j++) {
+      node.points[i].color[j] = static_cast<uint8_t>(
+          std::min(255.0f, std::max(0.0f, point_colors[point_index][j])));
+    }
+    node.points[i].color[3] = 255;
+  }
+  const int max_num_views =
+      node_points.empty() ? 0 : num_views_for_track[node_points.front()];
+  node.num_points_with_min_num_views.resize(max_num_views + 1, 0);
+  for (const int point_index : node_points) {
+    ++node.num_points_with_min_num_views[num_views_for_track[point_index]];
+  }
+  for (int i = max_num_views - 1; i >= 0; i--) {
+    node.num_points_with_min_num_views[i] +=
+        node.num_points_with_min_num_views[i + 1];
+  }
+
+  // Split the remaining points into the octants. The partitions are stable so
+  // that each octant remains in random order.
+  const Eigen::Vector3f center = (min_corner + max_corner) / 2.0f;
+  std::vector<int>::iterator octant_begin[9];
+  octant_begin[0] = end_of_node;
+  octant_begin[8] = end;
+  octant_begin[4] = std::stable_partition(
+      octant_begin[0], octant_begin[8], [&](const int i) {
+        return world_points[i].x() < center.x();
+      });
+  for (int i = 0; i < 8; i += 4) {
+    octant_begin[i + 2] = std::stable_partition(
+        octant_begin[i], octant_begin[i + 4], [&](const int j) {
+          return world_points[j].y() < center.y();
+        });
+  }
+  for (int i = 0; i < 8; i += 2) {
+    octant_begin[i + 1] = std::stable_partition(
+        octant_begin[i], octant_begin[i + 2], [&](const int j) {
+          return world_points[j].z() < center.z();
+        });
+  }
+
+  for (int i = 0; i < 8; i++) {
+    if (octant_begin[i] == octant_begin[i + 1]) {
+      continue;
+    }
+    Eigen::Vector3f child_min_corner = min_corner;
+    Eigen::Vector3f child_max_corner = max_corner;
+    for (int axis = 0; axis < 3; axis++) {
+      if (i & (4 >> axis)) {
+        child_min_corner[axis] = center[axis];
+      } else {
+        child_max_corner[axis] = center[axis];
+      }
+    }
+    const int child_index = BuildOctreeNode(world_points,
+                                            point_colors,
+                                            num_views_for_track,
+                                            child_min_corner,
+                                            child_max_corner,
+                                            depth + 1,
+                                            octant_begin[i],
+                                            octant_begin[i + 1]);
+    octree_nodes[node_index].children[i] = child_index;
+  }
+  return node_index;
+}
+
+void BuildOctree(const std::vector<Eigen::Vector3f>& world_points,
+                 const std::vector<Eigen::Vector3f>& point_colors,
+                 const std::vector<int>& num_views_for_track) {
+  octree_nodes.clear();
+  if (world_points.empty()) {
+    return;
+  }
+
+  Eigen::Vector3f min_corner = world_points[0];
+  Eigen::Vector3f max_corner = world_points[0];
+  for (const Eigen::Vector3f& point : world_points) {
+    min_corner = min_corner.cwiseMin(point);
+    max_corner = max_corner.cwiseMax(point);
+  }
+  // Use a cube so that the nodes of each level have the same size.
+  const float size = (max_corner - min_corner).maxCoeff();
+  max_corner = min_corner + Eigen::Vector3f::Constant(size);
+
+  std::vector<int> point_indices(world_points.size());
+  std::iota(point_indices.begin(), point_indices.end(), 0);
+  std::mt19937 rng(13);
+  std::shuffle(point_indices.begin(), point_indices.end(), rng);
+  BuildOctreeNode(world_points,
+                  point_colors,
+                  num_views_for_track,
+                  min_corner,
+                  max_corner,
+                  0,
+                  point_indices.begin(),
+                  point_indices.end());
+  LOG(INFO) << "Built an octree of " << octree_nodes.size() << " nodes for "
+            << world_points.size() << " points.";
+}
+
+GLuint CompileShader(const GLenum type, const char* source) {
+  const GLuint shader = glCreateShader(type);
+  glShaderSource(shader, 1, &source, nullptr);
+  glCompileShader(shader);
+  GLint status;
+  glGetShaderiv(shader, GL_COMPILE_STATUS, &status);
+  if (status != GL_TRUE) {
+    char log[1024];
+    glGetShaderInfoLog(shader, sizeof(log), nullptr, log);
+    LOG(FATAL) << "Could not compile the point shader: " << log;
+  }
+  return shader;
+}
+
+// The shader program scales the colors of the points and attenuates the point
+// size with the distance to the viewer in the same way as
+// GL_POINT_DISTANCE_ATTENUATION, since the colors come from the vertex buffers
+// and cannot be scaled with glColor.
+void CreatePointShaderProgram() {
+  static const char kVertexShader[] =
+      "#version 120\n"
+      "uniform float point_size;\n"
+      "uniform float color_scale;\n"
+      "uniform float alpha;\n"
+      "varying vec4 color;\n"
+      "void main() {\n"
+      "  vec4 eye_position = gl_ModelViewMatrix * gl_Vertex;\n"
+      "  gl_PointSize = point_size / sqrt(1.0 + 0.055 * "
+      "length(eye_position.xyz));\n"
+      "  color = vec4(color_scale * gl_Color.rgb, alpha);\n"
+      "  gl_Position = gl_ProjectionMatrix * eye_position;\n"
+      "}\n";
+  static const char kFragmentShader[] =
+      "#version 120\n"
+      "varying vec4 color;\n"
+      "void main() {\n"
+      "  gl_FragColor = color;\n"
+      "}\n";
+
+  point_shader_program = glCreateProgram();
+  glAttachShader(point_shader_program,
+                 CompileShader(GL_VERTEX_SHADER, kVertexShader));
+  glAttachShader(point_shader_program,
+                 CompileShader(GL_FRAGMENT_SHADER, kFragmentShader));
+  glLinkProgram(point_shader_program);
+  GLint status;
+  glGetProgramiv(point_shader_program, GL_LINK_STATUS, &status);
+  CHECK_EQ(status, GL_TRUE) << "Could not link the point shader.";
+}
+
+void UploadOctreeNode(OctreeNode* node) {
+  const size_t size_in_bytes = node->points.size() * sizeof(PointVertex);
+  glGenBuffers(1, &node->vertex_buffer);
+  glBindBuffer(GL_ARRAY_BUFFER, node->vertex_buffer);
+  glBufferData(
+      GL_ARRAY_BUFFER, size_in_bytes, node->points.data(), GL_STATIC_DRAW);
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+  gpu_memory_in_bytes += size_in_bytes;
+}
+
+// Frees the buffers of the nodes that were drawn least recently until the GPU
+// memory budget is met. Nodes drawn in the current frame are kept.
+void EvictOctreeNodes() {
+  const size_t budget_in_bytes =
+      static_cast<size_t>(FLAGS_gpu_memory_budget_in_mb) * 1024 * 1024;
+  if (gpu_memory_in_bytes <= budget_in_bytes) {
+    return;
+  }
+
+  std::vector<int> resident_nodes;
+  for (int i = 0; i < octree_nodes.size(); i++) {
+    if (octree_nodes[i].vertex_buffer != 0 &&
+        octree_nodes[i].last_drawn_frame < frame_number) {
+      resident_nodes.emplace_back(i);
+    }
+  }
+  std::sort(resident_nodes.begin(), resident_nodes.end(), [](int i, int j) {
+    return octree_nodes[i].last_drawn_frame < octree_nodes[j].last_drawn_frame;
+  });
+  for (const int node_index : resident_nodes) {
+    if (gpu_memory_in_bytes <= budget_in_bytes) {
+      break;
+    }
+    OctreeNode& node = octree_nodes[node_index];
+    glDeleteBuffers(1, &node.vertex_buffer);
+    node.vertex_buffer = 0;
+    gpu_memory_in_bytes -= node.points.size() * sizeof(PointVertex);
+  }
+}
+
+// Returns true if the box is entirely outside of one of the frustum planes.
+// The planes are stored as the rows of the matrix and the points on the inner
+// side of a plane have a positive signed distance.
+bool IsOutsideOfFrustum(const Eigen::Matrix<float, 6, 4>& frustum_planes,
+                        const Eigen::Vector3f& min_corner,
+                        const Eigen::Vector3f& max_corner) {
+  for (int i = 0; i < 6; i++) {
+    // The corner of the box that is farthest along the plane normal.
+    Eigen::Vector4f corner(0.0f, 0.0f, 0.0f, 1.0f);
+    for (int j = 0; j < 3; j++) {
+      corner[j] =
+          frustum_planes(i, j) >= 0.0f ? max_corner[j] : min_corner[j];
+    }
+    if (frustum_planes.row(i).dot(corner) < 0.0f) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Selects the octree nodes to draw with the current modelview and projection
+// matrices. Starting from the root, the visible nodes that cover the most
+// pixels are refined first until the point budget is used up. A node is only
+// refined once its own points are on the GPU, since its children only hold
+// the points that it does not.
+std::vector<int> SelectOctreeNodes() {
+  std::vector<int> selected_nodes;
+  if (octree_nodes.empty()) {
+    return selected_nodes;
+  }
+
+  Eigen::Matrix4f modelview, projection;
+  glGetFloatv(GL_MODELVIEW_MATRIX, modelview.data());
+  glGetFloatv(GL_PROJECTION_MATRIX, projection.data());
+  const Eigen::Matrix4f clip = projection * modelview;
+  Eigen::Matrix<float, 6, 4> frustum_planes;
+  for (int i = 0; i < 3; i++) {
+    frustum_planes.row(2 * i) = clip.row(3) + clip.row(i);
+    frustum_planes.row(2 * i + 1) = clip.row(3) - clip.row(i);
+  }
+
+  // The focal length of the viewer in pixels.
+  const float focal_length = projection(1, 1) * height / 2.0f;
+  const auto size_in_pixels = [&](const OctreeNode& node) {
+    const Eigen::Vector3f center = (node.min_corner + node.max_corner) / 2.0f;
+    const float radius = (node.max_corner - node.min_corner).norm() / 2.0f;
+    const float distance =
+        (modelview * center.homogeneous()).head<3>().norm() - radius;
+    return distance <= 0.0f ? std::numeric_limits<float>::max()
+                            : focal_length * radius / distance;
+  };
+
+  std::priority_queue<std::pair<float, int> > queue;
+  queue.emplace(size_in_pixels(octree_nodes[0]), 0);
+  int num_points = 0;
+  int num_uploads = 0;
+  while (!queue.empty() && num_points < FLAGS_max_rendered_points) {
+    const float node_size_in_pixels = queue.top().first;
+    OctreeNode& node = octree_nodes[queue.top().second];
+    const int node_index = queue.top().second;
+    queue.pop();
+    if (IsOutsideOfFrustum(frustum_planes, node.min_corner, node.max_corner)) {
+      continue;
+    }
+
+    if (node.vertex_buffer == 0) {
+      if (num_uploads == kMaxOctreeNodeUploadsPerFrame) {
+        continue;
+      }
+      UploadOctreeNode(&node);
+      ++num_uploads;
+    }
+    node.last_drawn_frame = frame_number;
+    selected_nodes.emplace_back(node_index);
+    num_points += NumPointsToDraw(node);
+
+    if (node_size_in_pixels < kMinOctreeNodeSizeInPixels) {
+      continue;
+    }
+    for (const int child_index : node.children) {
+      if (child_index != -1) {
+        queue.emplace(size_in_pixels(octree_nodes[child_index]), child_index);
+      }
+    }
+  }
+  return selected_nodes;
+}
+
+void DrawPoints(const std::vector<int>& octree_node_indices,
+                const float point_scale,
                 const float color_scale,
                 const float alpha_scale) {
   const float default_point_size = point_size;
   const float default_alpha_scale = anti_aliasing_blend;
 
-  // TODO(cmsweeney): Render points with the actual 3D point color! This would
-  // require Theia to save the colors during feature extraction.
-  // const Eigen::Vector3f default_color(0.05, 0.05, 0.05);
-
   // Enable anti-aliasing for round points and alpha blending that helps make
   // points look nicer.
   glDisable(GL_LIGHTING);
   glEnable(GL_MULTISAMPLE);
   glEnable(GL_BLEND);
   glEnable(GL_POINT_SMOOTH);
+  glEnable(GL_VERTEX_PROGRAM_POINT_SIZE);
   glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
-  // The coordinates for calculating point attenuation. This allows for points
-  // to get smaller as the OpenGL camera moves farther away.
-  GLfloat point_size_coords[3];
-  point_size_coords[0] = 1.0f;
-  point_size_coords[1] = 0.055f;
-  point_size_coords[2] = 0.0f;
-  glPointParameterfv(GL_POINT_DISTANCE_ATTENUATION, point_size_coords);
-
-  glPointSize(point_scale * default_point_size);
-  glBegin(GL_POINTS);
-  for (int i = 0; i < world_points.size(); i++) {
-    if (num_views_for_track[i] < min_num_views_for_track) {
-      continue;
-    }
-    const Eigen::Vector3f color = point_colors[i] / 255.0;
-    glColor4f(color_scale * color[0],
-              color_scale * color[1],
-              color_scale * color[2],
+  // The point size is attenuated in the shader so that points get smaller as
+  // the OpenGL camera moves farther away.
+  glUseProgram(point_shader_program);
+  glUniform1f(glGetUniformLocation(point_shader_program, "point_size"),
+              point_scale * default_point_size);
+  glUniform1f(glGetUniformLocation(point_shader_program, "color_scale"),
+              color_scale);
+  glUniform1f(glGetUniformLocation(point_shader_program, "alpha"),
               alpha_scale * default_alpha_scale);
 
-    glVertex3d(world_points[i].x(), world_points[i].y(), world_points[i].z());
+  glEnableClientState(GL_VERTEX_ARRAY);
+  glEnableClientState(GL_COLOR_ARRAY);
+  for (const int node_index : octree_node_indices) {
+    const OctreeNode& node = octree_nodes[node_index];
+    glBindBuffer(GL_ARRAY_BUFFER, node.vertex_buffer);
+    glVertexPointer(3,
+                    GL_FLOAT,
+                    sizeof(PointVertex),
+                    reinterpret_cast<const GLvoid*>(
+                        offsetof(PointVertex, position)));
+    glColorPointer(4,
+                   GL_UNSIGNED_BYTE,
+                   sizeof(PointVertex),
+                   reinterpret_cast<const GLvoid*>(
+                       offsetof(PointVertex, color)));
+    glDrawArrays(GL_POINTS, 0, NumPointsToDraw(node));
   }
-  glEnd();
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+  glDisableClientState(GL_COLOR_ARRAY);
+  glDisableClientState(GL_VERTEX_ARRAY);
+  glUseProgram(0);
 }
 
 void RenderScene() {
@@ -269,9 +649,21 @@ void RenderScene() {
   const float small_alpha_scale = 1.0, medium_alpha_scale = 2.1,
               large_alpha_scale = 3.3;
 
-  DrawPoints(small_point_scale, small_color_scale, small_alpha_scale);
-  DrawPoints(medium_point_scale, medium_color_scale, medium_alpha_scale);
-  DrawPoints(large_point_scale, large_color_scale, large_alpha_scale);
+  const std::vector<int> octree_node_indices = SelectOctreeNodes();
+  DrawPoints(octree_node_indices,
+             small_point_scale,
+             small_color_scale,
+             small_alpha_scale);
+  DrawPoints(octree_node_indices,
+             medium_point_scale,
+             medium_color_scale,
+             medium_alpha_scale);
+  DrawPoints(octree_node_indices,
+             large_point_scale,
+             large_color_scale,
+             large_alpha_scale);
+  EvictOctreeNodes();
+  ++frame_number;
 
   // Draw the cameras.
   if (draw_cameras) {
@@ -409,6 +801,14 @@ void Keyboard(unsigned char key, int x, int y) {
         anti_aliasing_blend += 0.01;
       }
       break;
+    case 'l':
+      FLAGS_max_rendered_points =
+          std::max(kMaxPointsPerOctreeNode, FLAGS_max_rendered_points / 2);
+      break;
+    case 'L':
+      FLAGS_max_rendered_points =
+          std::min(1 << 30, 2 * FLAGS_max_rendered_points);
+      break;
   }
 }
 
@@ -436,20 +836,26 @@ int main(int argc, char* argv[]) {
   }
 
   // Set up world points and colors.
-  world_points.reserve(reconstruction->NumTracks());
-  point_colors.reserve(reconstruction->NumTracks());
-  for (const theia::TrackId track_id : reconstruction->TrackIds()) {
-    const auto* track = reconstruction->Track(track_id);
-    if (track == nullptr || !track->IsEstimated()) {
-      continue;
+  {
+    std::vector<Eigen::Vector3f> world_points;
+    std::vector<Eigen::Vector3f> point_colors;
+    std::vector<int> num_views_for_track;
+    world_points.reserve(reconstruction->NumTracks());
+    point_colors.reserve(reconstruction->NumTracks());
+    num_views_for_track.reserve(reconstruction->NumTracks());
+    for (const theia::TrackId track_id : reconstruction->TrackIds()) {
+      const auto* track = reconstruction->Track(track_id);
+      if (track == nullptr || !track->IsEstimated()) {
+        continue;
+      }
+      world_points.emplace_back(track->Point().hnormalized().cast<float>());
+      point_colors.emplace_back(track->Color().cast<float>());
+      num_views_for_track.emplace_back(track->NumViews());
     }
-    world_points.emplace_back(track->Point().hnormalized());
-    point_colors.emplace_back(track->Color().cast<float>());
-    num_views_for_track.emplace_back(track->NumViews());
+    reconstruction.reset();
+    BuildOctree(world_points, point_colors, num_views_for_track);
   }
 
-  reconstruction.release();
-
   // Set up opengl and glut.
   glutInit(&argc, argv);
   glutInitWindowPosition(600, 600);
@@ -461,6 +867,7 @@ int main(int argc, char* argv[]) {
   // Set up glew.
   CHECK_EQ(GLEW_OK, glewInit()) << "Failed initializing GLEW.";
 #endif
+  CreatePointShaderProgram();
 
   // Set the camera
   gluLookAt(0.0f, 0.0f, -6.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f);
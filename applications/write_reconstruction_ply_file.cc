@@ -42,6 +42,15 @@ DEFINE_int32(min_num_observations_per_point,
              3,
              "Minimum number of observations for a point to be written out to "
              "the PLY file. This helps reduce noise in the resulty PLY file.");
+DEFINE_bool(binary,
+            true,
+            "Write a binary PLY file, which is smaller and faster to write "
+            "than an ASCII PLY file.");
+DEFINE_double(voxel_size,
+              0.0,
+              "If positive, the points are decimated on a voxel grid with this "
+              "cell size to create a light-weight preview of the model.");
+DEFINE_int32(num_threads, 1, "Number of threads used to write the file.");
 
 int main(int argc, char* argv[]) {
   google::InitGoogleLogging(argv[0]);
@@ -51,8 +60,13 @@ int main(int argc, char* argv[]) {
   CHECK(theia::ReadReconstruction(FLAGS_reconstruction, &reconstruction))
       << "Could not read Reconstruction files.";
 
-  CHECK(WritePlyFile(
-      FLAGS_ply_file, reconstruction, FLAGS_min_num_observations_per_point))
+  theia::WritePlyFileOptions options;
+  options.min_num_observations_per_point =
+      FLAGS_min_num_observations_per_point;
+  options.binary = FLAGS_binary;
+  options.voxel_size = FLAGS_voxel_size;
+  options.num_threads = FLAGS_num_threads;
+  CHECK(theia::WritePlyFile(FLAGS_ply_file, reconstruction, options))
       << "Could not write out PLY file.";
   return 0;
 }
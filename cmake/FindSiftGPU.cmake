@@ -0,0 +1,59 @@
+# -*- mode: cmake; -*-
+# - Try to find the SiftGPU include dirs and libraries
+# Usage of this module as follows:
+# This file defines:
+# * SIFTGPU_FOUND if SiftGPU was found
+# * SIFTGPU_LIBRARIES The libraries to link to.
+# * SIFTGPU_INCLUDE_DIR The include directory such that SiftGPU/SiftGPU.h can
+#   be included.
+# The search can be guided by setting SIFTGPU_HOME.
+
+include(FindPackageHandleStandardArgs)
+
+set(_siftgpu_INCLUDE_SEARCH_DIRS
+  ${CMAKE_INCLUDE_PATH}
+  /usr/local/include
+  /usr/include
+  /opt/SiftGPU/include
+  )
+
+set(_siftgpu_LIBRARIES_SEARCH_DIRS
+  ${CMAKE_LIBRARY_PATH}
+  /usr/local/lib
+  /usr/lib
+  /opt/SiftGPU/lib
+  )
+
+if ("${SIFTGPU_HOME}" STREQUAL "" AND NOT "$ENV{SIFTGPU_HOME}" STREQUAL "")
+  set(SIFTGPU_HOME "$ENV{SIFTGPU_HOME}")
+endif ()
+
+if (NOT "${SIFTGPU_HOME}" STREQUAL "")
+  set(_siftgpu_INCLUDE_SEARCH_DIRS
+    ${SIFTGPU_HOME}/include ${SIFTGPU_HOME}/src ${_siftgpu_INCLUDE_SEARCH_DIRS})
+  set(_siftgpu_LIBRARIES_SEARCH_DIRS
+    ${SIFTGPU_HOME}/lib ${SIFTGPU_HOME}/bin ${_siftgpu_LIBRARIES_SEARCH_DIRS})
+endif ()
+
+# find the include files
+find_path(SIFTGPU_INCLUDE_DIR SiftGPU/SiftGPU.h
+  HINTS ${_siftgpu_INCLUDE_SEARCH_DIRS})
+
+# locate the library
+find_library(SIFTGPU_LIBRARY NAMES siftgpu SiftGPU
+  HINTS ${_siftgpu_LIBRARIES_SEARCH_DIRS})
+
+# SiftGPU renders the scale space with OpenGL and GLEW.
+find_package(OpenGL)
+find_library(SIFTGPU_GLEW_LIBRARY NAMES GLEW glew32
+  HINTS ${_siftgpu_LIBRARIES_SEARCH_DIRS})
+
+find_package_handle_standard_args(SIFTGPU DEFAULT_MSG
+  SIFTGPU_LIBRARY SIFTGPU_GLEW_LIBRARY SIFTGPU_INCLUDE_DIR)
+
+if (SIFTGPU_INCLUDE_DIR AND SIFTGPU_LIBRARY AND SIFTGPU_GLEW_LIBRARY)
+  set(SIFTGPU_FOUND "YES")
+  set(SIFTGPU_LIBRARIES
+    ${SIFTGPU_LIBRARY} ${SIFTGPU_GLEW_LIBRARY} ${OPENGL_LIBRARIES})
+  message(STATUS "Found SiftGPU")
+endif ()
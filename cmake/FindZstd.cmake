@@ -0,0 +1,50 @@
+# -*- mode: cmake; -*-
+# - Try to find the zstd include dirs and libraries
+# Usage of this module as follows:
+# This file defines:
+# * ZSTD_FOUND if zstd was found
+# * ZSTD_LIBRARIES The libraries to link to.
+# * ZSTD_INCLUDE_DIR The include directory such that zstd.h can be included.
+# The search can be guided by setting ZSTD_HOME.
+
+include(FindPackageHandleStandardArgs)
+
+set(_zstd_INCLUDE_SEARCH_DIRS
+  ${CMAKE_INCLUDE_PATH}
+  /usr/local/include
+  /usr/include
+  )
+
+set(_zstd_LIBRARIES_SEARCH_DIRS
+  ${CMAKE_LIBRARY_PATH}
+  /usr/local/lib
+  /usr/lib
+  )
+
+if ("${ZSTD_HOME}" STREQUAL "" AND NOT "$ENV{ZSTD_HOME}" STREQUAL "")
+  set(ZSTD_HOME "$ENV{ZSTD_HOME}")
+endif ()
+
+if (NOT "${ZSTD_HOME}" STREQUAL "")
+  set(_zstd_INCLUDE_SEARCH_DIRS
+    ${ZSTD_HOME}/include ${ZSTD_HOME}/lib ${_zstd_INCLUDE_SEARCH_DIRS})
+  set(_zstd_LIBRARIES_SEARCH_DIRS
+    ${ZSTD_HOME}/lib ${_zstd_LIBRARIES_SEARCH_DIRS})
+endif ()
+
+# find the include files
+find_path(ZSTD_INCLUDE_DIR zstd.h
+  HINTS ${_zstd_INCLUDE_SEARCH_DIRS})
+
+# locate the library
+find_library(ZSTD_LIBRARY NAMES zstd zstd_static
+  HINTS ${_zstd_LIBRARIES_SEARCH_DIRS})
+
+find_package_handle_standard_args(ZSTD DEFAULT_MSG
+  ZSTD_LIBRARY ZSTD_INCLUDE_DIR)
+
+if (ZSTD_INCLUDE_DIR AND ZSTD_LIBRARY)
+  set(ZSTD_FOUND "YES")
+  set(ZSTD_LIBRARIES ${ZSTD_LIBRARY})
+  message(STATUS "Found zstd")
+endif ()
@@ -47,41 +47,57 @@
 //#include "theia/image/keypoint_detector/sift_detector.h"
 //#include "theia/image/keypoint_detector/sift_parameters.h"
 #include "theia/io/bundler_file_reader.h"
+#include "theia/io/chunked_matches_file.h"
+#include "theia/io/colmap_camera_models.h"
+#include "theia/io/columnar_reconstruction.h"
+#include "theia/io/columnar_view_graph.h"
 #include "theia/io/eigen_serializable.h"
 #include "theia/io/import_nvm_file.h"
 #include "theia/io/populate_image_sizes.h"
 #include "theia/io/read_1dsfm.h"
+#include "theia/io/read_bal_file.h"
 #include "theia/io/read_bundler_files.h"
 #include "theia/io/read_calibration.h"
+#include "theia/io/read_colmap_files.h"
 #include "theia/io/read_keypoints_and_descriptors.h"
 #include "theia/io/read_strecha_dataset.h"
 #include "theia/io/reconstruction_reader.h"
 #include "theia/io/reconstruction_writer.h"
 #include "theia/io/sift_binary_file.h"
 #include "theia/io/sift_text_file.h"
+#include "theia/io/text_parser.h"
 #include "theia/io/write_bundler_files.h"
 #include "theia/io/write_calibration.h"
+#include "theia/io/write_colmap_files.h"
 #include "theia/io/write_keypoints_and_descriptors.h"
 #include "theia/io/write_matches.h"
 #include "theia/io/write_nvm_file.h"
 #include "theia/io/write_ply_file.h"
 #include "theia/matching/brute_force_feature_matcher.h"
 #include "theia/matching/cascade_hasher.h"
+#include "theia/matching/cached_features_and_matches_database.h"
 #include "theia/matching/cascade_hashing_feature_matcher.h"
 #include "theia/matching/create_feature_matcher.h"
+#include "theia/matching/descriptor_types.h"
 #include "theia/matching/distance.h"
 #include "theia/matching/feature_correspondence.h"
 #include "theia/matching/feature_matcher.h"
 #include "theia/matching/feature_matcher_options.h"
 #include "theia/matching/feature_matcher_utils.h"
 #include "theia/matching/features_and_matches_database.h"
+#include "theia/matching/features_and_matches_database_shards.h"
 #include "theia/matching/fisher_vector_extractor.h"
 #include "theia/matching/global_descriptor_extractor.h"
+#include "theia/matching/global_descriptor_nearest_neighbors.h"
 #include "theia/matching/guided_epipolar_matcher.h"
+#include "theia/matching/image_id_map.h"
+#include "theia/matching/image_pair_bitset.h"
 #include "theia/matching/image_pair_match.h"
+#include "theia/matching/image_pair_match_encoding.h"
 #include "theia/matching/in_memory_features_and_matches_database.h"
 #include "theia/matching/indexed_feature_match.h"
 #include "theia/matching/keypoints_and_descriptors.h"
+#include "theia/matching/memory_mapped_features_and_matches_database.h"
 #include "theia/matching/rocksdb_features_and_matches_database.h"
 #include "theia/math/bcm_sdp_solver.h"
 #include "theia/math/closed_form_polynomial_solver.h"
@@ -89,12 +105,18 @@
 #include "theia/math/distribution.h"
 #include "theia/math/find_polynomial_roots_companion_matrix.h"
 #include "theia/math/find_polynomial_roots_jenkins_traub.h"
+#include "theia/math/gaussian_mixture_model.h"
+#include "theia/math/graph/concurrent_union_find.h"
 #include "theia/math/graph/connected_components.h"
 #include "theia/math/graph/minimum_spanning_tree.h"
 #include "theia/math/graph/normalized_graph_cut.h"
+#include "theia/math/graph/parallel_connected_components.h"
+#include "theia/math/graph/parallel_minimum_spanning_tree.h"
 #include "theia/math/graph/triplet_extractor.h"
 #include "theia/math/histogram.h"
 #include "theia/math/l1_solver.h"
+#include "theia/math/parallel_selection.h"
+#include "theia/math/matrix/block_sparse_matrix.h"
 #include "theia/math/matrix/gauss_jordan.h"
 #include "theia/math/matrix/linear_operator.h"
 #include "theia/math/matrix/rq_decomposition.h"
@@ -102,6 +124,7 @@
 #include "theia/math/matrix/sparse_matrix.h"
 #include "theia/math/matrix/spectra_linear_operator.h"
 #include "theia/math/polynomial.h"
+#include "theia/math/principal_component_analysis.h"
 #include "theia/math/probability/sequential_probability_ratio.h"
 #include "theia/math/qp_solver.h"
 #include "theia/math/rank_restricted_sdp_solver.h"
@@ -112,18 +135,27 @@
 #include "theia/math/sdp_solver.h"
 #include "theia/math/solver_options.h"
 #include "theia/math/util.h"
+#include "theia/sfm/batched_two_view_match_geometric_verification.h"
 #include "theia/sfm/bundle_adjustment/angular_epipolar_error.h"
 #include "theia/sfm/bundle_adjustment/bundle_adjust_two_views.h"
 #include "theia/sfm/bundle_adjustment/bundle_adjuster.h"
 #include "theia/sfm/bundle_adjustment/bundle_adjustment.h"
 #include "theia/sfm/bundle_adjustment/create_loss_function.h"
+#include "theia/sfm/bundle_adjustment/incremental_bundle_adjuster.h"
+#include "theia/sfm/bundle_adjustment/marginal_covariance.h"
 #include "theia/sfm/bundle_adjustment/optimize_relative_position_with_known_rotation.h"
 #include "theia/sfm/bundle_adjustment/orthogonal_vector_error.h"
+#include "theia/sfm/bundle_adjustment/partitioned_bundle_adjustment.h"
+#include "theia/sfm/bundle_adjustment/refine_relative_pose.h"
+#include "theia/sfm/bundle_adjustment/refine_tracks.h"
+#include "theia/sfm/bundle_adjustment/select_linear_solver.h"
 #include "theia/sfm/bundle_adjustment/sampson_error.h"
 #include "theia/sfm/bundle_adjustment/position_error.h"
 #include "theia/sfm/bundle_adjustment/gravity_error.h"
 #include "theia/sfm/bundle_adjustment/fundamental_matrix_parameterization.h"
 #include "theia/sfm/bundle_adjustment/unit_norm_three_vector_parameterization.h"
+#include "theia/sfm/calibrate_intrinsics_groups.h"
+#include "theia/sfm/camera/analytic_reprojection_error.h"
 #include "theia/sfm/camera/camera.h"
 #include "theia/sfm/camera/camera_intrinsics_model.h"
 #include "theia/sfm/camera/camera_intrinsics_model_type.h"
@@ -138,10 +170,15 @@
 #include "theia/sfm/camera/pinhole_radial_tangential_camera_model.h"
 #include "theia/sfm/camera/projection_matrix_utils.h"
 #include "theia/sfm/camera/reprojection_error.h"
+#include "theia/sfm/camera/undistortion_map.h"
 #include "theia/sfm/camera_intrinsics_prior.h"
+#include "theia/sfm/camera_rig.h"
 #include "theia/sfm/colorize_reconstruction.h"
+#include "theia/sfm/covisibility_graph.h"
 #include "theia/sfm/estimate_track.h"
 #include "theia/sfm/estimate_twoview_info.h"
+#include "theia/sfm/evaluate_relative_poses.h"
+#include "theia/sfm/estimators/batch_estimators.h"
 #include "theia/sfm/estimators/estimate_absolute_pose_with_known_orientation.h"
 #include "theia/sfm/estimators/estimate_calibrated_absolute_pose.h"
 #include "theia/sfm/estimators/estimate_dominant_plane_from_points.h"
@@ -182,13 +219,20 @@
 #include "theia/sfm/global_pose_estimation/pairwise_translation_error.h"
 #include "theia/sfm/global_pose_estimation/position_estimator.h"
 #include "theia/sfm/global_pose_estimation/robust_rotation_estimator.h"
+#include "theia/sfm/global_pose_estimation/rotation_averaging_linear_system.h"
 #include "theia/sfm/global_pose_estimation/rotation_estimator.h"
 #include "theia/sfm/global_pose_estimation/rotation_estimator_util.h"
 #include "theia/sfm/global_reconstruction_estimator.h"
 #include "theia/sfm/gps_converter.h"
+#include "theia/sfm/hierarchical_reconstruction_estimator.h"
 #include "theia/sfm/hybrid_reconstruction_estimator.h"
 #include "theia/sfm/incremental_reconstruction_estimator.h"
+#include "theia/sfm/localization_index.h"
 #include "theia/sfm/localize_view_to_reconstruction.h"
+#include "theia/sfm/next_best_view_selector.h"
+#include "theia/sfm/online_reconstruction_builder.h"
+#include "theia/sfm/paged_track_store.h"
+#include "theia/sfm/parallel_track_builder.h"
 #include "theia/sfm/pose/dls_impl.h"
 #include "theia/sfm/pose/dls_pnp.h"
 #include "theia/sfm/pose/eight_point_fundamental_matrix.h"
@@ -217,18 +261,29 @@
 #include "theia/sfm/pose/util.h"
 #include "theia/sfm/pose_error.h"
 #include "theia/sfm/reconstruction.h"
+#include "theia/sfm/reconstruction_arrays.h"
 #include "theia/sfm/reconstruction_builder.h"
+#include "theia/sfm/reconstruction_checkpoint.h"
 #include "theia/sfm/reconstruction_estimator.h"
 #include "theia/sfm/reconstruction_estimator_options.h"
 #include "theia/sfm/reconstruction_estimator_utils.h"
+#include "theia/sfm/reconstruction_spatial_index.h"
+#include "theia/sfm/reconstruction_statistics.h"
 #include "theia/sfm/rigid_transformation.h"
+//#include "theia/sfm/scan_image_metadata.h"
 #include "theia/sfm/select_good_tracks_for_bundle_adjustment.h"
+#include "theia/sfm/select_track_observations_for_bundle_adjustment.h"
 #include "theia/sfm/set_camera_intrinsics_from_priors.h"
 #include "theia/sfm/set_outlier_tracks_to_unestimated.h"
+#include "theia/sfm/set_position_priors_from_gps.h"
 #include "theia/sfm/similarity_transformation.h"
+#include "theia/sfm/sort_tracks_spatially.h"
+#include "theia/sfm/sub_reconstruction.h"
+#include "theia/sfm/synthetic_scene.h"
 #include "theia/sfm/track.h"
 #include "theia/sfm/track_builder.h"
 #include "theia/sfm/transformation/align_point_clouds.h"
+#include "theia/sfm/transformation/align_multiple_reconstructions.h"
 #include "theia/sfm/transformation/align_reconstructions.h"
 #include "theia/sfm/transformation/align_rotations.h"
 #include "theia/sfm/transformation/gdls_similarity_transform.h"
@@ -239,8 +294,10 @@
 #include "theia/sfm/types.h"
 //#include "theia/sfm/undistort_image.h"
 #include "theia/sfm/view.h"
+#include "theia/sfm/view_graph/compact_view_graph.h"
 #include "theia/sfm/view_graph/orientations_from_maximum_spanning_tree.h"
 #include "theia/sfm/view_graph/remove_disconnected_view_pairs.h"
+#include "theia/sfm/view_graph/sparsify_view_graph.h"
 #include "theia/sfm/view_graph/view_graph.h"
 #include "theia/sfm/visibility_pyramid.h"
 #include "theia/solvers/estimator.h"
@@ -252,24 +309,41 @@
 #include "theia/solvers/lmed.h"
 #include "theia/solvers/lmed_quality_measurement.h"
 #include "theia/solvers/mle_quality_measurement.h"
+#include "theia/solvers/preemptive_ransac.h"
 #include "theia/solvers/prosac.h"
 #include "theia/solvers/prosac_sampler.h"
 #include "theia/solvers/quality_measurement.h"
 #include "theia/solvers/random_sampler.h"
 #include "theia/solvers/ransac.h"
+#include "theia/solvers/ransac_statistics.h"
 #include "theia/solvers/sample_consensus_estimator.h"
 #include "theia/solvers/sampler.h"
+#include "theia/util/arena.h"
 #include "theia/util/enable_enum_bitmask_operators.h"
+#include "theia/util/executor.h"
 #include "theia/util/filesystem.h"
+#include "theia/util/fixed_capacity_vector.h"
+#include "theia/util/flat_hash_map.h"
+#include "theia/util/flat_set.h"
 #include "theia/util/hash.h"
 #include "theia/util/lru_cache.h"
 #include "theia/util/map_util.h"
+#include "theia/util/mapped_file.h"
+#include "theia/util/memory_accounting.h"
+#include "theia/util/memory_stream_buffer.h"
+#include "theia/util/metrics.h"
 #include "theia/util/mutable_priority_queue.h"
+#include "theia/util/numa.h"
+#include "theia/util/point_octree.h"
 #include "theia/util/random.h"
+#include "theia/util/sharded_lru_cache.h"
+#include "theia/util/slot_map.h"
+#include "theia/util/small_vector.h"
 #include "theia/util/string.h"
 #include "theia/util/stringprintf.h"
 #include "theia/util/threadpool.h"
 #include "theia/util/timer.h"
+#include "theia/util/trace.h"
 #include "theia/util/util.h"
 
 #endif  // THEIA_THEIA_H_
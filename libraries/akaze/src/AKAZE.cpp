@@ -462,8 +462,9 @@ void AKAZE::Compute_Descriptors(std::vector<AKAZEKeypoint>& kpts,
       t = options_.descriptor_size;
     }
 
+    // The descriptor bits are OR-ed into the bytes so they must start zeroed.
     for (int i = 0; i < desc.binary_descriptor.size(); i++) {
-      desc.binary_descriptor[i].resize(t);
+      desc.binary_descriptor[i].setZero((t + 7) / 8);
     }
   }
 
@@ -0,0 +1,91 @@
+import pytheia as pt
+import numpy as np
+from scipy.spatial.transform import Rotation as R
+
+
+def generate_problems(num_problems, num_correspondences):
+    correspondences = []
+    for i in range(num_problems):
+        points3d = np.random.uniform([-2, -2, 4], [2, 2, 6],
+                                     size=(num_correspondences, 3))
+        rotation = R.from_rotvec(np.random.uniform(-0.2, 0.2, 3)).as_matrix()
+        translation = np.array([1.0, 0.0, 0.1])
+        points2 = points3d @ rotation.T + translation
+        correspondences.append(
+            np.hstack([points3d[:, :2] / points3d[:, 2:],
+                       points2[:, :2] / points2[:, 2:]]))
+    offsets = np.arange(num_problems + 1) * num_correspondences
+    return np.vstack(correspondences), offsets
+
+
+def test_EstimateEssentialMatrices():
+    correspondences, offsets = generate_problems(20, 50)
+
+    params = pt.solvers.RansacParameters()
+    params.error_thresh = 1e-6
+    success, result = pt.sfm.EstimateEssentialMatrices(
+        params, pt.sfm.RansacType.RANSAC, correspondences, offsets,
+        num_threads=4)
+    assert success
+    assert np.all(result.success)
+    assert result.models.shape == (20, 9)
+    assert result.inliers.shape == (correspondences.shape[0],)
+    assert np.all(result.num_inliers == 50)
+
+    # The epipolar constraint holds for all correspondences.
+    for i in range(20):
+        E = result.models[i].reshape(3, 3)
+        for x1, y1, x2, y2 in correspondences[offsets[i]:offsets[i + 1]]:
+            assert abs(np.array([x2, y2, 1]) @ E @ np.array([x1, y1, 1])) \
+                < 1e-6 * np.linalg.norm(E)
+
+
+def test_EstimateSimilarityTransformations():
+    num_problems, num_correspondences = 10, 30
+    correspondences = []
+    for i in range(num_problems):
+        rotation = R.from_rotvec(np.random.uniform(-1, 1, 3)).as_matrix()
+        translation = np.random.uniform(-5, 5, 3)
+        scale = np.random.uniform(0.5, 2.0)
+        points2 = np.random.uniform(-10, 10, size=(num_correspondences, 3))
+        points1 = scale * points2 @ rotation.T + translation
+        # The first 5 correspondences of each problem are outliers.
+        points1[:5] += np.random.uniform(5, 10, size=(5, 3))
+        correspondences.append(np.hstack([points1, points2]))
+    correspondences = np.vstack(correspondences)
+    offsets = np.arange(num_problems + 1) * num_correspondences
+
+    params = pt.solvers.RansacParameters()
+    params.error_thresh = 1e-4
+    success, result = pt.sfm.EstimateSimilarityTransformations(
+        params, pt.sfm.RansacType.RANSAC, correspondences, offsets,
+        num_threads=4)
+    assert success
+    assert np.all(result.success)
+    assert result.models.shape == (num_problems, 13)
+    assert np.all(result.num_inliers == num_correspondences - 5)
+
+    for i in range(num_problems):
+        rotation = result.models[i, :9].reshape(3, 3)
+        translation = result.models[i, 9:12]
+        scale = result.models[i, 12]
+        points1 = correspondences[offsets[i] + 5:offsets[i + 1], :3]
+        points2 = correspondences[offsets[i] + 5:offsets[i + 1], 3:]
+        assert np.allclose(scale * points2 @ rotation.T + translation,
+                           points1, atol=1e-6)
+
+
+def test_InvalidOffsets():
+    correspondences, offsets = generate_problems(2, 20)
+    params = pt.solvers.RansacParameters()
+    params.error_thresh = 1e-6
+    success, _ = pt.sfm.EstimateHomographies(
+        params, pt.sfm.RansacType.RANSAC, correspondences,
+        np.array([0, 10, 30]))
+    assert not success
+
+
+if __name__ == "__main__":
+    test_EstimateEssentialMatrices()
+    test_EstimateSimilarityTransformations()
+    test_InvalidOffsets()
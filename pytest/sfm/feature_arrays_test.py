@@ -0,0 +1,70 @@
+import pytheia as pt
+import numpy as np
+
+
+def test_FloatImageBufferProtocol():
+    pixels = np.random.randint(0, 256, size=(20, 30, 3), dtype=np.uint8)
+    image = pt.image.FloatImage(pixels)
+    assert image.Rows() == 20 and image.Cols() == 30 and image.Channels() == 3
+
+    # np.asarray is a view of the pixels of the image.
+    view = np.asarray(image)
+    assert view.dtype == np.float32 and view.shape == (20, 30, 3)
+    assert np.allclose(view, pixels / 255.0)
+    view[0, 0, 0] = 0.5
+    assert np.asarray(image)[0, 0, 0] == 0.5
+
+
+def test_FloatImageFromBuffer():
+    pixels = np.random.rand(20, 30).astype(np.float32)
+    image = pt.image.FloatImage.FromBuffer(pixels)
+    assert image.Channels() == 1
+
+    # The image shares the pixels with the array.
+    pixels[1, 2] = 7.0
+    assert np.asarray(image)[1, 2, 0] == 7.0
+
+
+def test_KeypointsAndDescriptorsFromArrays():
+    keypoints = np.random.rand(50, 2) * 100.0
+    descriptors = np.random.rand(50, 128).astype(np.float32)
+    features = pt.matching.KeypointsAndDescriptors("a.jpg", keypoints,
+                                                   descriptors)
+    assert features.NumDescriptors() == 50
+    assert np.all(features.keypoint_coordinates == keypoints)
+    assert np.all(features.descriptor_matrix == descriptors)
+
+    # The descriptor matrix is returned as a view of the stored matrix.
+    features.descriptor_matrix[0, 0] = 2.0
+    assert features.descriptor_matrix[0, 0] == 2.0
+
+    quantized = np.random.randint(0, 256, size=(50, 128), dtype=np.uint8)
+    quantized_features = pt.matching.KeypointsAndDescriptors(
+        "b.jpg", keypoints, quantized, descriptor_quantization_scale=255.0)
+    assert quantized_features.HasQuantizedDescriptors()
+    assert np.all(quantized_features.quantized_descriptor_matrix == quantized)
+
+
+def test_MatchFeaturesFromArrays():
+    keypoints = np.random.rand(100, 2) * 100.0
+    descriptors = np.random.rand(100, 64).astype(np.float32)
+    database = pt.matching.InMemoryFeaturesAndMatchesDatabase()
+    for image_name in ["a.jpg", "b.jpg"]:
+        database.PutFeatures(
+            image_name,
+            pt.matching.KeypointsAndDescriptors(image_name, keypoints,
+                                                descriptors))
+
+    options = pt.matching.FeatureMatcherOptions()
+    options.perform_geometric_verification = False
+    matcher = pt.matching.BruteForceFeatureMatcher(options, database)
+    matcher.AddImages(["a.jpg", "b.jpg"])
+    matcher.MatchImages()
+    assert database.NumMatches() == 1
+
+
+if __name__ == "__main__":
+    test_FloatImageBufferProtocol()
+    test_FloatImageFromBuffer()
+    test_KeypointsAndDescriptorsFromArrays()
+    test_MatchFeaturesFromArrays()
@@ -0,0 +1,26 @@
+import pytheia as pt
+from random_recon_gen import RandomReconGenerator
+
+
+def test_BundleAdjustReconstructionAsync():
+    ba_options = pt.sfm.BundleAdjustmentOptions()
+    ba_options.intrinsics_to_optimize = pt.sfm.OptimizeIntrinsicsType.NONE
+
+    # The reconstructions are bundle adjusted at the same time on the thread
+    # pool of pytheia.futures.
+    generators = []
+    for _ in range(4):
+        gen = RandomReconGenerator()
+        gen.generate_random_recon(nr_views=5, nr_tracks=50, pixel_noise=0.5)
+        gen.add_noise_to_views(noise_pos=1e-3, noise_angle=1e-1)
+        generators.append(gen)
+
+    futures = [pt.futures.BundleAdjustReconstructionAsync(ba_options,
+                                                          gen.recon)
+               for gen in generators]
+    for future in futures:
+        assert future.result().success
+
+
+if __name__ == "__main__":
+    test_BundleAdjustReconstructionAsync()
@@ -0,0 +1,21 @@
+import pytheia as pt
+import numpy as np
+
+def test_batch_conversions():
+    rng = np.random.RandomState(42)
+    lla = np.vstack([rng.uniform(-90.0, 90.0, 50),
+                     rng.uniform(-180.0, 180.0, 50),
+                     rng.uniform(-100.0, 1000.0, 50)])
+    ecef = pt.sfm.GPSConverter.LLAToECEFBatch(lla)
+    assert ecef.shape == (3, 50)
+    for i in range(lla.shape[1]):
+        assert np.allclose(ecef[:, i], pt.sfm.GPSConverter.LLAToECEF(lla[:, i]))
+    assert np.allclose(pt.sfm.GPSConverter.ECEFToLLABatch(ecef), lla)
+
+def test_enu():
+    reference_lla = np.array([27.173891, 78.042068, 168.0])
+    lla = np.array([reference_lla, reference_lla + [0.0, 0.0, 10.0]]).T
+    enu = pt.sfm.GPSConverter.LLAToENU(lla, reference_lla)
+    assert np.allclose(enu[:, 0], 0.0, atol=1e-6)
+    assert np.allclose(enu[:, 1], [0.0, 0.0, 10.0], atol=1e-6)
+    assert np.allclose(pt.sfm.GPSConverter.ENUToLLA(enu, reference_lla), lla)
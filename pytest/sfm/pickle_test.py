@@ -0,0 +1,68 @@
+import pickle
+
+import numpy as np
+import pytheia as pt
+from random_recon_gen import RandomReconGenerator
+from view_graph_test import get_view_graph
+
+
+def check_reconstructions_equal(recon, loaded_recon):
+    assert sorted(loaded_recon.ViewIds()) == sorted(recon.ViewIds())
+    assert sorted(loaded_recon.TrackIds()) == sorted(recon.TrackIds())
+    for view_id in recon.ViewIds():
+        view = recon.View(view_id)
+        loaded_view = loaded_recon.View(view_id)
+        assert loaded_view.Name() == view.Name()
+        assert np.all(loaded_view.Camera().GetPosition() ==
+                      view.Camera().GetPosition())
+    for track_id in recon.TrackIds():
+        assert np.all(loaded_recon.Track(track_id).Point() ==
+                      recon.Track(track_id).Point())
+
+
+def test_PickleReconstruction():
+    gen = RandomReconGenerator()
+    gen.generate_random_recon(nr_views=5, nr_tracks=100)
+    recon = gen.recon
+
+    for protocol in range(2, pickle.HIGHEST_PROTOCOL + 1):
+        loaded_recon = pickle.loads(pickle.dumps(recon, protocol=protocol))
+        check_reconstructions_equal(recon, loaded_recon)
+
+
+def test_PickleReconstructionOutOfBand():
+    if pickle.HIGHEST_PROTOCOL < 5:
+        return
+    gen = RandomReconGenerator()
+    gen.generate_random_recon(nr_views=5, nr_tracks=100)
+    recon = gen.recon
+
+    # The serialized reconstruction is passed as a buffer instead of being
+    # copied into the pickle.
+    buffers = []
+    data = pickle.dumps(recon, protocol=5, buffer_callback=buffers.append)
+    assert len(buffers) == 1
+    assert len(data) < len(buffers[0].raw())
+    loaded_recon = pickle.loads(data, buffers=buffers)
+    check_reconstructions_equal(recon, loaded_recon)
+
+
+def test_PickleViewGraph():
+    gen = RandomReconGenerator()
+    gen.generate_random_recon(nr_views=6, nr_tracks=10)
+    view_graph, _ = get_view_graph(gen.recon, outlier_chance=0.0)
+
+    for protocol in range(2, pickle.HIGHEST_PROTOCOL + 1):
+        loaded_view_graph = pickle.loads(
+            pickle.dumps(view_graph, protocol=protocol))
+        assert loaded_view_graph.NumViews() == view_graph.NumViews()
+        assert loaded_view_graph.NumEdges() == view_graph.NumEdges()
+        for view_pair, info in view_graph.GetAllEdges().items():
+            loaded_info = loaded_view_graph.GetEdge(view_pair[0], view_pair[1])
+            assert np.all(loaded_info.rotation_2 == info.rotation_2)
+
+
+if __name__ == "__main__":
+    test_PickleReconstruction()
+    test_PickleReconstructionOutOfBand()
+    test_PickleViewGraph()
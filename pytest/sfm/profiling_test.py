@@ -0,0 +1,47 @@
+import pytheia as pt
+import numpy as np
+
+
+def test_MeasureMetricsAndTrace():
+    keypoints = np.random.rand(200, 2) * 100.0
+    descriptors = np.random.rand(200, 64).astype(np.float32)
+    database = pt.matching.InMemoryFeaturesAndMatchesDatabase()
+    for image_name in ["a.jpg", "b.jpg"]:
+        database.PutFeatures(
+            image_name,
+            pt.matching.KeypointsAndDescriptors(image_name, keypoints,
+                                                descriptors))
+
+    options = pt.matching.FeatureMatcherOptions()
+    options.perform_geometric_verification = False
+    matcher = pt.matching.BruteForceFeatureMatcher(options, database)
+    matcher.AddImages(["a.jpg", "b.jpg"])
+    with pt.profiling.Trace() as trace, \
+            pt.profiling.MeasureMetrics() as metrics:
+        matcher.MatchImages()
+
+    assert not pt.util.Tracer.IsEnabled()
+    assert metrics.delta["seconds"] >= 0.0
+    assert all(delta >= 0 for delta in metrics.delta["counters"].values())
+    for stage in trace.StageTimings().values():
+        assert stage["count"] > 0
+        assert stage["max_seconds"] <= stage["total_seconds"]
+
+
+def test_ToDict():
+    params = pt.solvers.RansacParameters()
+    fields = pt.profiling.ToDict(params)
+    assert fields["error_thresh"] == params.error_thresh
+    assert fields["max_iterations"] == params.max_iterations
+
+
+def test_Benchmark():
+    results = pt.benchmark.Run(["relative_pose"], repeats=2, num_threads=2)
+    assert len(results["relative_pose"]["seconds"]) == 2
+    assert results["relative_pose"]["median_seconds"] > 0.0
+
+
+if __name__ == "__main__":
+    test_MeasureMetricsAndTrace()
+    test_ToDict()
+    test_Benchmark()
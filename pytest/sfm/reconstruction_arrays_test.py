@@ -0,0 +1,56 @@
+import pytheia as pt
+import numpy as np
+from random_recon_gen import RandomReconGenerator
+
+
+def test_GetAndSetTrackArrays():
+    gen = RandomReconGenerator()
+    gen.generate_random_recon(nr_views=5, nr_tracks=100)
+    recon = gen.recon
+
+    arrays = pt.sfm.GetTrackArrays(recon, num_threads=2)
+    assert arrays.points.shape == (recon.NumTracks(), 4)
+    assert arrays.colors.shape == (recon.NumTracks(), 3)
+    for i, track_id in enumerate(arrays.track_ids):
+        assert np.all(arrays.points[i] == recon.Track(track_id).Point())
+
+    # The points are modified in place and written back.
+    arrays.points[:, :3] += 1.0
+    assert pt.sfm.SetTrackArrays(arrays, recon)
+    for i, track_id in enumerate(arrays.track_ids):
+        assert np.all(arrays.points[i] == recon.Track(track_id).Point())
+
+
+def test_GetAndSetViewArrays():
+    gen = RandomReconGenerator()
+    gen.generate_random_recon(nr_views=5, nr_tracks=100)
+    recon = gen.recon
+
+    arrays = pt.sfm.GetViewArrays(recon)
+    assert arrays.positions.shape == (recon.NumViews(), 3)
+    arrays.positions[:] = np.arange(3 * recon.NumViews()).reshape(-1, 3)
+    assert pt.sfm.SetViewArrays(arrays, recon)
+    for i, view_id in enumerate(arrays.view_ids):
+        position = recon.View(view_id).Camera().GetPosition()
+        assert np.all(position == arrays.positions[i])
+
+
+def test_GetObservationArrays():
+    gen = RandomReconGenerator()
+    gen.generate_random_recon(nr_views=5, nr_tracks=100)
+    recon = gen.recon
+
+    arrays = pt.sfm.GetObservationArrays(recon)
+    num_observations = sum(recon.View(view_id).NumFeatures()
+                           for view_id in recon.ViewIds())
+    assert arrays.features.shape == (num_observations, 2)
+    for view_id, track_id, feature in zip(arrays.view_ids, arrays.track_ids,
+                                          arrays.features):
+        observed = recon.View(view_id).GetFeature(track_id)
+        assert np.all(feature == observed.point)
+
+
+if __name__ == "__main__":
+    test_GetAndSetTrackArrays()
+    test_GetAndSetViewArrays()
+    test_GetObservationArrays()
@@ -0,0 +1,42 @@
+from random_recon_gen import RandomReconGenerator
+import pytheia as pt
+import numpy as np
+
+def get_two_view_info(recon, vid1, vid2):
+    camera1 = recon.View(vid1).Camera()
+    camera2 = recon.View(vid2).Camera()
+    two_view_info = pt.sfm.TwoViewInfo()
+    two_view_info.rotation_2 = pt.math.RelativeRotationFromTwoRotations(
+        camera1.GetOrientationAsAngleAxis(), camera2.GetOrientationAsAngleAxis())
+    translation = camera1.GetOrientationAsRotationMatrix() @ (
+        camera2.GetPosition() - camera1.GetPosition())
+    two_view_info.position_2 = translation / np.linalg.norm(translation)
+    return two_view_info
+
+def test_relative_pose_evaluator():
+    gen = RandomReconGenerator()
+    gen.generate_random_recon()
+    recon = gen.recon
+
+    vids = sorted(recon.ViewIds())
+    view_graph = pt.sfm.ViewGraph()
+    for i in range(len(vids)):
+        for j in range(i + 1, len(vids)):
+            view_graph.AddEdge(
+                vids[i], vids[j], get_two_view_info(recon, vids[i], vids[j]))
+
+    options = pt.sfm.RelativePoseEvaluatorOptions()
+    options.num_threads = 4
+    evaluator = pt.sfm.RelativePoseEvaluator(options, recon)
+    num_pairs = len(vids) * (len(vids) - 1) // 2
+    assert evaluator.AddViewGraph(view_graph) == num_pairs
+    assert evaluator.NumSkippedViewPairs() == 0
+    assert len(evaluator.EvaluatedViewPairs()) == num_pairs
+    assert np.max(evaluator.RotationErrors()) < 1e-4
+    assert np.max(evaluator.TranslationErrors()) < 1e-2
+    # All errors fall into the first histogram bin.
+    assert evaluator.RotationHistogramCounts()[0] == num_pairs
+    assert evaluator.TranslationHistogramCounts()[0] == num_pairs
+
+if __name__ == "__main__":
+    test_relative_pose_evaluator()
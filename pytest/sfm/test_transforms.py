@@ -84,6 +84,40 @@ def test_AlignReconstructions():
         ).GetPosition() - recon_fix.View(i).Camera().GetPosition()) < 1e-10
 
 
+def test_AlignMultipleReconstructions():
+    nr_cams = 8
+    X = np.random.random((nr_cams, 3)) * 10
+    recons = []
+    for _ in range(3):
+        recon = pt.sfm.Reconstruction()
+        for i in range(nr_cams):
+            view_id = recon.AddView(str(i), 0, i)
+            view = recon.View(view_id)
+            view.SetIsEstimated(True)
+            view.MutableCamera().SetPosition(X[i, :])
+        recons.append(recon)
+
+    pt.sfm.TransformReconstruction(recons[1], np.eye(3), np.array([1, 2, 3]),
+                                   2.0)
+    pt.sfm.TransformReconstruction(recons[2], np.eye(3), np.array([-1, 0, 1]),
+                                   0.5)
+
+    options = pt.sfm.MultipleReconstructionAlignmentOptions()
+    options.num_threads = 2
+    success, summary = pt.sfm.AlignMultipleReconstructions(options, recons)
+    assert success
+    assert summary.aligned == [True, True, True]
+    assert summary.num_aligned_pairs == 3
+    assert abs(summary.transformations[1].scale - 0.5) < 1e-8
+
+    for recon in recons[1:]:
+        for view_id in recon.ViewIds():
+            assert np.linalg.norm(recon.View(view_id).Camera().GetPosition()
+                                  - recons[0].View(view_id).Camera()
+                                  .GetPosition()) < 1e-8
+
+
 if __name__ == "__main__":
     test_TransformReconstruction()
     test_AlignReconstructions()
+    test_AlignMultipleReconstructions()
@@ -1,2 +1,5 @@
-from pytheia.pytheia import (io, sfm, math, matching, solvers)
-import pytheia.pytheia as pytheia
\ No newline at end of file
+from pytheia.pytheia import (image, io, sfm, math, matching, solvers, util)
+import pytheia.pytheia as pytheia
+from pytheia import futures
+from pytheia import profiling
+from pytheia import benchmark
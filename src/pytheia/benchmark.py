@@ -0,0 +1,217 @@
+"""Synthetic workloads for comparing pytheia on different machines.
+
+Each workload generates its input once from a fixed seed and times only the
+pytheia call, so the numbers of two machines (or two builds) are comparable:
+
+    python -m pytheia.benchmark --num_threads 8
+
+Run returns the timings, and the metrics and stage timings recorded while the
+workload ran, as dicts that can be written to JSON.
+"""
+import argparse
+import collections
+import json
+import statistics
+import time
+
+import numpy as np
+
+from pytheia.pytheia import matching, sfm, solvers
+from pytheia import profiling
+
+
+def _MatchingWorkload(num_threads, rng, num_images=8, num_features=2000):
+    """Brute force matching of all pairs of images with random SIFT-sized
+    descriptors. Geometric verification is skipped, so this measures the
+    descriptor distance and ratio test throughput."""
+    database = matching.InMemoryFeaturesAndMatchesDatabase()
+    image_names = ["{}.jpg".format(i) for i in range(num_images)]
+    for image_name in image_names:
+        keypoints = rng.uniform(0.0, 1000.0, size=(num_features, 2))
+        descriptors = rng.standard_normal(
+            size=(num_features, 128)).astype(np.float32)
+        descriptors /= np.linalg.norm(descriptors, axis=1, keepdims=True)
+        database.PutFeatures(
+            image_name,
+            matching.KeypointsAndDescriptors(image_name, keypoints,
+                                             descriptors))
+
+    def Run():
+        options = matching.FeatureMatcherOptions()
+        options.num_threads = num_threads
+        options.perform_geometric_verification = False
+        matcher = matching.BruteForceFeatureMatcher(options, database)
+        matcher.AddImages(image_names)
+        matcher.MatchImages()
+
+    return Run
+
+
+def _RelativePoseWorkload(num_threads, rng, num_problems=200,
+                          num_correspondences=500, outlier_ratio=0.3):
+    """RANSAC relative pose estimation for many independent image pairs with
+    a fixed fraction of outliers."""
+    correspondences = []
+    for _ in range(num_problems):
+        points = rng.uniform([-2.0, -2.0, 4.0], [2.0, 2.0, 6.0],
+                             size=(num_correspondences, 3))
+        angle_axis = rng.uniform(-0.2, 0.2, size=3)
+        rotation = _RotationFromAngleAxis(angle_axis)
+        points2 = points @ rotation.T + np.array([1.0, 0.0, 0.1])
+        problem = np.hstack([points[:, :2] / points[:, 2:],
+                             points2[:, :2] / points2[:, 2:]])
+        num_outliers = int(outlier_ratio * num_correspondences)
+        problem[:num_outliers, 2:] = rng.uniform(
+            -0.5, 0.5, size=(num_outliers, 2))
+        correspondences.append(problem)
+    correspondences = np.vstack(correspondences)
+    offsets = np.arange(num_problems + 1) * num_correspondences
+
+    def Run():
+        params = solvers.RansacParameters()
+        params.error_thresh = 1e-5
+        sfm.EstimateRelativePoses(params, sfm.RansacType.RANSAC,
+                                  correspondences, offsets,
+                                  num_threads=num_threads)
+
+    return Run
+
+
+def _BundleAdjustmentWorkload(num_threads, rng, num_views=30,
+                              num_tracks=3000, pixel_noise=1.0):
+    """Full bundle adjustment of a scene of cameras looking at a point cloud,
+    with noisy observations and perturbed points."""
+    camera = sfm.Camera()
+    camera.SetFocalLength(1000.0)
+    camera.SetPrincipalPoint(500.0, 500.0)
+    camera.SetImageSize(1000, 1000)
+
+    def MakeReconstruction():
+        # The scene is regenerated from the same seed for every run, because
+        # bundle adjustment modifies the reconstruction.
+        scene_rng = np.random.default_rng(rng.integers(1 << 31))
+        reconstruction = sfm.Reconstruction()
+        for track_point in scene_rng.uniform([-4.0, -4.0, 8.0],
+                                             [4.0, 4.0, 12.0],
+                                             size=(num_tracks, 3)):
+            track_id = reconstruction.AddTrack()
+            track = reconstruction.MutableTrack(track_id)
+            track.SetPoint(np.append(track_point, 1.0))
+            track.SetIsEstimated(True)
+
+        for i in range(num_views):
+            view_id = reconstruction.AddView(str(i), 0, i)
+            view = reconstruction.MutableView(view_id)
+            view_camera = view.MutableCamera()
+            view_camera.DeepCopy(camera)
+            view_camera.SetPosition(
+                scene_rng.uniform([-3.0, -3.0, -1.0], [3.0, 3.0, 1.0]))
+            view_camera.SetOrientationFromAngleAxis(
+                scene_rng.uniform(-0.1, 0.1, size=3))
+            view.SetIsEstimated(True)
+
+            for track_id in reconstruction.TrackIds():
+                point = reconstruction.Track(track_id).Point()
+                depth, pixel = view_camera.ProjectPoint(point)
+                if depth <= 0.0 or np.any(pixel < 0.0) or \
+                        np.any(pixel > 1000.0):
+                    continue
+                pixel = pixel + scene_rng.standard_normal(2) * pixel_noise
+                reconstruction.AddObservation(view_id, track_id,
+                                              sfm.Feature(pixel))
+
+        for track_id in reconstruction.TrackIds():
+            track = reconstruction.MutableTrack(track_id)
+            point = track.Point()
+            point[:3] += scene_rng.standard_normal(3) * 0.05
+            track.SetPoint(point)
+        return reconstruction
+
+    seed_state = rng.bit_generator.state
+
+    def Run():
+        rng.bit_generator.state = seed_state
+        reconstruction = MakeReconstruction()
+        options = sfm.BundleAdjustmentOptions()
+        options.num_threads = num_threads
+        start = time.perf_counter()
+        sfm.BundleAdjustReconstruction(options, reconstruction)
+        return time.perf_counter() - start
+
+    return Run
+
+
+def _RotationFromAngleAxis(angle_axis):
+    angle = np.linalg.norm(angle_axis)
+    if angle == 0.0:
+        return np.eye(3)
+    axis = angle_axis / angle
+    cross = np.array([[0.0, -axis[2], axis[1]],
+                      [axis[2], 0.0, -axis[0]],
+                      [-axis[1], axis[0], 0.0]])
+    return np.eye(3) + np.sin(angle) * cross + \
+        (1.0 - np.cos(angle)) * cross @ cross
+
+
+WORKLOADS = collections.OrderedDict([
+    ("matching", _MatchingWorkload),
+    ("relative_pose", _RelativePoseWorkload),
+    ("bundle_adjustment", _BundleAdjustmentWorkload),
+])
+
+
+def Run(workloads=None, repeats=3, num_threads=1, seed=42):
+    """Runs the workloads (all by default) repeats times each and returns a
+    dict with the wall clock seconds of every run, their median, and the
+    metrics and stage timings recorded during the last run of each workload.
+    A workload may return the seconds of its timed part, which excludes the
+    input it regenerates in every run."""
+    if workloads is None:
+        workloads = list(WORKLOADS)
+    results = collections.OrderedDict()
+    for name in workloads:
+        if name not in WORKLOADS:
+            raise ValueError("Unknown workload: {}".format(name))
+        workload = WORKLOADS[name](num_threads, np.random.default_rng(seed))
+        seconds = []
+        for _ in range(repeats):
+            with profiling.Trace() as trace, \
+                    profiling.MeasureMetrics() as metrics:
+                start = time.perf_counter()
+                timed_seconds = workload()
+                elapsed = time.perf_counter() - start
+            seconds.append(elapsed if timed_seconds is None
+                           else timed_seconds)
+        results[name] = {
+            "seconds": seconds,
+            "median_seconds": statistics.median(seconds),
+            "num_threads": num_threads,
+            "stages": trace.StageTimings(),
+            "counters": metrics.delta["counters"],
+        }
+    return results
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--workloads", nargs="*", choices=list(WORKLOADS),
+                        default=None)
+    parser.add_argument("--repeats", type=int, default=3)
+    parser.add_argument("--num_threads", type=int, default=1)
+    parser.add_argument("--seed", type=int, default=42)
+    parser.add_argument("--json", default=None,
+                        help="Writes the results to this file.")
+    args = parser.parse_args()
+
+    results = Run(args.workloads, args.repeats, args.num_threads, args.seed)
+    for name, result in results.items():
+        print("{:<20} median {:8.3f} s over {} runs ({} threads)".format(
+            name, result["median_seconds"], len(result["seconds"]),
+            result["num_threads"]))
+    if args.json:
+        with open(args.json, "w") as json_file:
+            json.dump(results, json_file, indent=2)
+
+
+if __name__ == "__main__":
+    main()
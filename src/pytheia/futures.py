@@ -0,0 +1,80 @@
+"""Future-returning variants of the long running pytheia calls.
+
+The bindings release the GIL while the reconstruction, matching, bundle
+adjustment and RANSAC calls run, so these calls run in parallel with other
+Python threads. The functions below run them on a shared thread pool and return
+a concurrent.futures.Future, which asyncio code can await with
+asyncio.wrap_future.
+
+The calls read and modify their arguments without locking, so the arguments
+(e.g. a reconstruction that is bundle adjusted) must not be used by other
+threads until the future is done.
+"""
+import concurrent.futures
+import threading
+
+from pytheia.pytheia import sfm
+
+_executor = None
+_executor_lock = threading.Lock()
+_max_workers = None
+
+
+def SetMaxWorkers(max_workers):
+    """Sets the number of calls that run at the same time. Must be called
+    before the first asynchronous call."""
+    global _max_workers
+    with _executor_lock:
+        if _executor is not None:
+            raise RuntimeError(
+                "The number of workers must be set before the first call.")
+        _max_workers = max_workers
+
+
+def GetExecutor():
+    """Returns the thread pool that runs the asynchronous calls."""
+    global _executor
+    with _executor_lock:
+        if _executor is None:
+            _executor = concurrent.futures.ThreadPoolExecutor(
+                max_workers=_max_workers, thread_name_prefix="pytheia")
+        return _executor
+
+
+def Submit(function, *args, **kwargs):
+    """Runs function(*args, **kwargs) on the thread pool and returns a
+    future of its result."""
+    return GetExecutor().submit(function, *args, **kwargs)
+
+
+def BuildReconstructionAsync(reconstruction_builder):
+    """Future of ReconstructionBuilder.BuildReconstruction()."""
+    return Submit(reconstruction_builder.BuildReconstruction)
+
+
+def ExtractAndMatchFeaturesAsync(reconstruction_builder):
+    """Future of ReconstructionBuilder.ExtractAndMatchFeatures()."""
+    return Submit(reconstruction_builder.ExtractAndMatchFeatures)
+
+
+def MatchImagesAsync(feature_matcher):
+    """Future of FeatureMatcher.MatchImages()."""
+    return Submit(feature_matcher.MatchImages)
+
+
+def EstimateReconstructionAsync(reconstruction_estimator, view_graph,
+                                reconstruction):
+    """Future of ReconstructionEstimator.Estimate(view_graph,
+    reconstruction)."""
+    return Submit(reconstruction_estimator.Estimate, view_graph,
+                  reconstruction)
+
+
+def BundleAdjustReconstructionAsync(*args):
+    """Future of sfm.BundleAdjustReconstruction(*args)."""
+    return Submit(sfm.BundleAdjustReconstruction, *args)
+
+
+def EstimateTwoViewInfosAsync(*args):
+    """Future of sfm.EstimateTwoViewInfos(*args)."""
+    return Submit(sfm.EstimateTwoViewInfos, *args)
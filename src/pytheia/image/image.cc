@@ -0,0 +1,215 @@
+// Copyright (C) 2015 The Regents of the University of California (Regents).
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: Steffen Urban (urbse@googlemail.com), Shengyu Yin
+
+#include "pytheia/image/image.h"
+
+#include <pybind11/eigen.h>
+#include <pybind11/numpy.h>
+#include <pybind11/pybind11.h>
+#include <pybind11/stl.h>
+
+#include <Eigen/Core>
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "theia/image/descriptor/create_descriptor_extractor.h"
+#include "theia/image/descriptor/descriptor_extractor.h"
+#include "theia/image/image.h"
+#include "theia/matching/keypoints_and_descriptors.h"
+
+namespace py = pybind11;
+
+namespace pytheia {
+namespace image {
+
+namespace {
+
+// NumPy arrays of images are rows x cols or rows x cols x channels.
+void GetImageShape(const py::array& array,
+                   int* rows,
+                   int* cols,
+                   int* channels) {
+  if (array.ndim() != 2 && array.ndim() != 3) {
+    throw py::value_error(
+        "Images must be rows x cols or rows x cols x channels arrays.");
+  }
+  *rows = static_cast<int>(array.shape(0));
+  *cols = static_cast<int>(array.shape(1));
+  *channels = array.ndim() == 3 ? static_cast<int>(array.shape(2)) : 1;
+}
+
+// Copies the float pixels of the array into a new image.
+theia::FloatImage FloatImageFromArray(
+    const py::array_t<float, py::array::c_style | py::array::forcecast>&
+        array) {
+  int rows, cols, channels;
+  GetImageShape(array, &rows, &cols, &channels);
+  theia::FloatImage image(cols, rows, channels);
+  std::copy(array.data(), array.data() + array.size(), image.Data());
+  return image;
+}
+
+// Copies the 8-bit pixels of the array into a new image, mapping them from
+// [0, 255] to [0, 1].
+theia::FloatImage FloatImageFromByteArray(
+    const py::array_t<uint8_t, py::array::c_style>& array) {
+  int rows, cols, channels;
+  GetImageShape(array, &rows, &cols, &channels);
+  theia::FloatImage image(cols, rows, channels);
+  float* pixels = image.Data();
+  const uint8_t* bytes = array.data();
+  for (py::ssize_t i = 0; i < array.size(); i++) {
+    pixels[i] = bytes[i] / 255.0f;
+  }
+  return image;
+}
+
+// Wraps the pixels of the array without copying them. The array must outlive
+// the image, which the binding ensures by keeping the array alive.
+std::unique_ptr<theia::FloatImage> FloatImageWrappingArray(
+    py::array_t<float, py::array::c_style>& array) {
+  int rows, cols, channels;
+  GetImageShape(array, &rows, &cols, &channels);
+  return std::unique_ptr<theia::FloatImage>(
+      new theia::FloatImage(cols, rows, channels, array.mutable_data()));
+}
+
+std::tuple<bool, theia::KeypointsAndDescriptors> DetectAndExtractFeatures(
+    const theia::FloatImage& image,
+    const theia::DescriptorExtractorType& descriptor_type,
+    const theia::FeatureDensity& feature_density,
+    const int num_threads,
+    const int max_num_features) {
+  theia::KeypointsAndDescriptors features;
+  std::unique_ptr<theia::DescriptorExtractor> extractor =
+      theia::CreateDescriptorExtractor(
+          descriptor_type, feature_density, num_threads, max_num_features);
+  if (!extractor->Initialize()) {
+    return std::make_tuple(false, features);
+  }
+
+  bool success;
+  if (extractor->ProducesBinaryDescriptors()) {
+    success = extractor->DetectAndExtractBinaryDescriptors(
+        image, &features.keypoints, &features.binary_descriptor_matrix);
+  } else {
+    std::vector<Eigen::VectorXf> descriptors;
+    success = extractor->DetectAndExtractDescriptors(
+        image, &features.keypoints, &descriptors);
+    features.SetDescriptors(descriptors);
+  }
+  return std::make_tuple(success, features);
+}
+
+}  // namespace
+
+void pytheia_image_classes(py::module& m) {
+  // FloatImage. The pixels are exposed through the buffer protocol, so
+  // np.asarray(image) is a rows x cols x channels float32 view of the image.
+  py::class_<theia::FloatImage>(m, "FloatImage", py::buffer_protocol())
+      .def(py::init<>())
+      .def(py::init<const std::string&>())
+      .def(py::init<const std::string&, const int>())
+      .def(py::init<const int, const int, const int>())
+      .def(py::init(&FloatImageFromByteArray), py::arg("array"))
+      .def(py::init(&FloatImageFromArray), py::arg("array"))
+      .def_buffer([](theia::FloatImage& image) -> py::buffer_info {
+        if (image.Data() == nullptr) {
+          throw py::value_error("The image has no pixels in memory.");
+        }
+        const py::ssize_t channel_stride = sizeof(float);
+        const py::ssize_t col_stride = channel_stride * image.Channels();
+        const py::ssize_t row_stride = col_stride * image.Cols();
+        return py::buffer_info(image.Data(),
+                               sizeof(float),
+                               py::format_descriptor<float>::format(),
+                               3,
+                               {image.Rows(), image.Cols(), image.Channels()},
+                               {row_stride, col_stride, channel_stride});
+      })
+      // Wraps a C-contiguous float32 array without copying it. The image
+      // shares the pixels with the array and cannot be resized.
+      .def_static("FromBuffer",
+                  &FloatImageWrappingArray,
+                  py::arg("array"),
+                  py::keep_alive<0, 1>())
+      .def("Rows", &theia::FloatImage::Rows)
+      .def("Cols", &theia::FloatImage::Cols)
+      .def("Width", &theia::FloatImage::Width)
+      .def("Height", &theia::FloatImage::Height)
+      .def("Channels", &theia::FloatImage::Channels)
+      .def("AsGrayscaleImage", &theia::FloatImage::AsGrayscaleImage)
+      .def("AsRGBImage", &theia::FloatImage::AsRGBImage)
+      .def("ConvertToGrayscaleImage",
+           &theia::FloatImage::ConvertToGrayscaleImage)
+      .def("ConvertToRGBImage", &theia::FloatImage::ConvertToRGBImage)
+      .def("ScalePixels", &theia::FloatImage::ScalePixels)
+      .def("Read", &theia::FloatImage::Read)
+      .def("Write", &theia::FloatImage::Write);
+
+  // Arrays passed where a FloatImage is expected are copied into an image.
+  py::implicitly_convertible<py::array, theia::FloatImage>();
+
+  py::enum_<theia::DescriptorExtractorType>(m, "DescriptorExtractorType")
+      .value("SIFT", theia::DescriptorExtractorType::SIFT)
+      .value("AKAZE", theia::DescriptorExtractorType::AKAZE)
+      .value("SIFT_GPU", theia::DescriptorExtractorType::SIFT_GPU)
+      .export_values();
+
+  py::enum_<theia::FeatureDensity>(m, "FeatureDensity")
+      .value("SPARSE", theia::FeatureDensity::SPARSE)
+      .value("NORMAL", theia::FeatureDensity::NORMAL)
+      .value("DENSE", theia::FeatureDensity::DENSE)
+      .export_values();
+
+  m.def("DetectAndExtractFeatures",
+        &DetectAndExtractFeatures,
+        py::arg("image"),
+        py::arg("descriptor_type") = theia::DescriptorExtractorType::SIFT,
+        py::arg("feature_density") = theia::FeatureDensity::NORMAL,
+        py::arg("num_threads") = 1,
+        py::arg("max_num_features") = 0,
+        py::call_guard<py::gil_scoped_release>());
+}
+
+void pytheia_image(py::module& m) {
+  py::module m_submodule = m.def_submodule("image");
+  pytheia_image_classes(m_submodule);
+}
+
+}  // namespace image
+}  // namespace pytheia
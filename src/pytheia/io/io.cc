@@ -43,6 +43,8 @@
 #include <pybind11/stl.h>
 
 #include "theia/io/bundler_file_reader.h"
+#include "theia/io/columnar_reconstruction.h"
+#include "theia/io/columnar_view_graph.h"
 #include "theia/io/import_nvm_file.h"
 #include "theia/io/io_wrapper.h"
 #include "theia/io/populate_image_sizes.h"
@@ -98,26 +100,152 @@ void pytheia_io_classes(py::module& m) {
       .def_readwrite("second_entry", &theia::ListImgEntry::second_entry)
       .def_readwrite("focal_length", &theia::ListImgEntry::focal_length);
 
-  m.def("ImportNVMFile", theia::ImportNVMFileWrapper);
+  py::class_<theia::ColumnarReconstructionWriterOptions>(
+      m, "ColumnarReconstructionWriterOptions")
+      .def(py::init())
+      .def_readwrite("num_threads",
+                     &theia::ColumnarReconstructionWriterOptions::num_threads)
+      .def_readwrite(
+          "num_tracks_per_chunk",
+          &theia::ColumnarReconstructionWriterOptions::num_tracks_per_chunk)
+      .def_readwrite("compress",
+                     &theia::ColumnarReconstructionWriterOptions::compress)
+      .def_readwrite(
+          "compression_level",
+          &theia::ColumnarReconstructionWriterOptions::compression_level);
+
+  py::class_<theia::WritePlyFileOptions>(m, "WritePlyFileOptions")
+      .def(py::init())
+      .def_readwrite("camera_color", &theia::WritePlyFileOptions::camera_color)
+      .def_readwrite(
+          "min_num_observations_per_point",
+          &theia::WritePlyFileOptions::min_num_observations_per_point)
+      .def_readwrite("binary", &theia::WritePlyFileOptions::binary)
+      .def_readwrite("voxel_size", &theia::WritePlyFileOptions::voxel_size)
+      .def_readwrite("num_threads", &theia::WritePlyFileOptions::num_threads);
+
+  m.def("ImportNVMFile",
+        theia::ImportNVMFileWrapper,
+        py::arg("nvm_filepath"),
+        py::arg("num_threads") = 1,
+        py::call_guard<py::gil_scoped_release>());
   m.def("PopulateImageSizesAndPrincipalPoints",
-        theia::PopulateImageSizesAndPrincipalPointsWrapper);
-  m.def("Read1DSFM", theia::Read1DSFMWrapper);
-  m.def("ReadBundlerFiles", theia::ReadBundlerFilesWrapper);
+        theia::PopulateImageSizesAndPrincipalPointsWrapper,
+        py::call_guard<py::gil_scoped_release>());
+  m.def("Read1DSFM",
+        theia::Read1DSFMWrapper,
+        py::arg("dataset_directory"),
+        py::arg("num_threads") = 1,
+        py::call_guard<py::gil_scoped_release>());
+  m.def("ReadBalFile",
+        theia::ReadBalFileWrapper,
+        py::call_guard<py::gil_scoped_release>());
+  m.def("ReadBundlerFiles",
+        theia::ReadBundlerFilesWrapper,
+        py::arg("lists_file"),
+        py::arg("bundle_file"),
+        py::arg("num_threads") = 1,
+        py::call_guard<py::gil_scoped_release>());
   m.def("ReadKeypointsAndDescriptors",
-        theia::ReadKeypointsAndDescriptorsWrapper);
-
-  m.def("ReadStrechaDataset", theia::ReadStrechaDatasetWrapper);
-  m.def("ReadReconstruction", theia::ReadReconstructionWrapper);
-  m.def("WriteReconstruction", theia::WriteReconstruction);
-  m.def("WriteReconstructionJson", theia::WriteReconstructionJson);
-  m.def("WriteSiftKeyBinaryFile", theia::WriteSiftKeyBinaryFile);
-  m.def("ReadSiftKeyBinaryFile", theia::ReadSiftKeyBinaryFileWrapper);
-  m.def("ReadSiftKeyTextFile", theia::ReadSiftKeyTextFileWrapper);
-  m.def("WriteBundlerFiles", theia::WriteBundlerFiles);
-  m.def("WriteColmapFiles", theia::WriteColmapFiles);
-  m.def("WriteKeypointsAndDescriptors", theia::WriteKeypointsAndDescriptors);
-  m.def("WriteNVMFile", theia::WriteNVMFile);
-  m.def("WritePlyFile", theia::WritePlyFile);
+        theia::ReadKeypointsAndDescriptorsWrapper,
+        py::call_guard<py::gil_scoped_release>());
+
+  m.def("ReadStrechaDataset",
+        theia::ReadStrechaDatasetWrapper,
+        py::call_guard<py::gil_scoped_release>());
+  m.def("ReadReconstruction",
+        theia::ReadReconstructionWrapper,
+        py::call_guard<py::gil_scoped_release>());
+  m.def("WriteReconstruction",
+        theia::WriteReconstruction,
+        py::call_guard<py::gil_scoped_release>());
+  m.def("WriteReconstructionJson",
+        theia::WriteReconstructionJson,
+        py::call_guard<py::gil_scoped_release>());
+  m.def("ReadColumnarReconstruction",
+        theia::ReadColumnarReconstructionWrapper,
+        py::arg("input_file"),
+        py::arg("num_threads") = 1,
+        py::call_guard<py::gil_scoped_release>());
+  m.def("WriteColumnarReconstruction",
+        theia::WriteColumnarReconstruction,
+        py::arg("reconstruction"),
+        py::arg("output_file"),
+        py::arg("options") = theia::ColumnarReconstructionWriterOptions(),
+        py::call_guard<py::gil_scoped_release>());
+  m.def("ReadColumnarViewGraph",
+        theia::ReadColumnarViewGraphWrapper,
+        py::arg("input_file"),
+        py::call_guard<py::gil_scoped_release>());
+  m.def("WriteColumnarViewGraph",
+        py::overload_cast<const theia::ViewGraph&, const std::string&>(
+            theia::WriteColumnarViewGraph),
+        py::arg("view_graph"),
+        py::arg("output_file"),
+        py::call_guard<py::gil_scoped_release>());
+  m.def("WriteSiftKeyBinaryFile",
+        py::overload_cast<const std::string&,
+                          const std::vector<Eigen::VectorXf>&,
+                          const std::vector<theia::Keypoint>&>(
+            theia::WriteSiftKeyBinaryFile),
+        py::call_guard<py::gil_scoped_release>());
+  m.def("WriteSiftKeyBinaryFile",
+        py::overload_cast<const std::string&,
+                          const theia::KeypointsAndDescriptors&>(
+            theia::WriteSiftKeyBinaryFile),
+        py::call_guard<py::gil_scoped_release>());
+  m.def("ReadSiftKeyBinaryFile",
+        theia::ReadSiftKeyBinaryFileWrapper,
+        py::call_guard<py::gil_scoped_release>());
+  m.def("ReadSiftKeyTextFile",
+        theia::ReadSiftKeyTextFileWrapper,
+        py::call_guard<py::gil_scoped_release>());
+  m.def("ReadSiftKeyBinaryFileToFeatures",
+        theia::ReadSiftKeyBinaryFileToFeaturesWrapper,
+        py::arg("input_sift_key_file"),
+        py::arg("num_threads") = 1,
+        py::call_guard<py::gil_scoped_release>());
+  m.def("ReadSiftKeyTextFileToFeatures",
+        theia::ReadSiftKeyTextFileToFeaturesWrapper,
+        py::arg("sift_key_file"),
+        py::arg("num_threads") = 1,
+        py::call_guard<py::gil_scoped_release>());
+  m.def("WriteBundlerFiles",
+        theia::WriteBundlerFiles,
+        py::call_guard<py::gil_scoped_release>());
+  m.def("WriteColmapFiles",
+        theia::WriteColmapFiles,
+        py::arg("reconstruction"),
+        py::arg("output_directory"),
+        py::arg("num_threads") = 1,
+        py::call_guard<py::gil_scoped_release>());
+  m.def("WriteColmapBinaryFiles",
+        theia::WriteColmapBinaryFiles,
+        py::arg("reconstruction"),
+        py::arg("output_directory"),
+        py::arg("num_threads") = 1,
+        py::call_guard<py::gil_scoped_release>());
+  m.def("ReadColmapBinaryFiles",
+        theia::ReadColmapBinaryFilesWrapper,
+        py::call_guard<py::gil_scoped_release>());
+  m.def("WriteKeypointsAndDescriptors",
+        theia::WriteKeypointsAndDescriptors,
+        py::call_guard<py::gil_scoped_release>());
+  m.def("WriteNVMFile",
+        theia::WriteNVMFile,
+        py::call_guard<py::gil_scoped_release>());
+  m.def("WritePlyFile",
+        py::overload_cast<const std::string&,
+                          const theia::Reconstruction&,
+                          const theia::WritePlyFileOptions&>(
+            theia::WritePlyFile),
+        py::call_guard<py::gil_scoped_release>());
+  m.def("WritePlyFile",
+        py::overload_cast<const std::string&,
+                          const theia::Reconstruction&,
+                          const Eigen::Vector3i&,
+                          const int>(theia::WritePlyFile),
+        py::call_guard<py::gil_scoped_release>());
 }
 
 void pytheia_io(py::module& m) {
@@ -45,6 +45,7 @@
 
 #include "theia/matching/brute_force_feature_matcher.h"
 #include "theia/matching/cascade_hasher.h"
+#include "theia/matching/cached_features_and_matches_database.h"
 #include "theia/matching/cascade_hashing_feature_matcher.h"
 #include "theia/matching/feature_matcher.h"
 #include "theia/matching/feature_matcher_options.h"
@@ -52,18 +53,45 @@
 #include "theia/matching/fisher_vector_extractor.h"
 #include "theia/matching/global_descriptor_extractor.h"
 #include "theia/matching/indexed_feature_match.h"
+#include "theia/matching/kd_tree_feature_matcher.h"
 #include "theia/matching/keypoints_and_descriptors.h"
+#include "theia/matching/lsh_feature_matcher.h"
+#include "theia/matching/sequential_pair_selector.h"
+#include "theia/matching/spatial_pair_selection.h"
+#include "theia/matching/spatial_reranking.h"
+#include "theia/matching/vocabulary_tree.h"
 #include "theia/sfm/feature.h"
 #include "theia/sfm/two_view_match_geometric_verification.h"
 //#include "theia/matching/rocksdb_features_and_matches_database.h"
 //#include "theia/matching/local_features_and_matches_database.h"
 #include "theia/matching/create_feature_matcher.h"
 #include "theia/matching/in_memory_features_and_matches_database.h"
+#include "theia/matching/memory_mapped_features_and_matches_database.h"
 namespace py = pybind11;
 
 namespace pytheia {
 namespace matching {
 
+namespace {
+
+// The x and y coordinates of the keypoints, one keypoint per row.
+typedef Eigen::Matrix<double, Eigen::Dynamic, 2, Eigen::RowMajor>
+    KeypointCoordinates;
+
+// Replaces the keypoints with keypoints at the given coordinates, e.g. those
+// found by a learned detector.
+void SetKeypointCoordinates(const Eigen::Ref<const KeypointCoordinates>& xy,
+                            theia::KeypointsAndDescriptors* features) {
+  features->keypoints.clear();
+  features->keypoints.reserve(xy.rows());
+  for (int i = 0; i < xy.rows(); i++) {
+    features->keypoints.emplace_back(
+        xy(i, 0), xy(i, 1), theia::Keypoint::OTHER);
+  }
+}
+
+}  // namespace
+
 void pytheia_matching_classes(py::module& m) {
   // FeaturesAndMatchesDatabase
   py::class_<theia::FeaturesAndMatchesDatabase /*, theia::PyFeaturesAndMatchesDatabase */>(m, "FeaturesAndMatchesDatabase")
@@ -138,11 +166,63 @@ void pytheia_matching_classes(py::module& m) {
                ImageNamesOfCameraIntrinsicsPriors)
       .def("ImageNamesOfMatches",
            &theia::InMemoryFeaturesAndMatchesDatabase::ImageNamesOfMatches)
+      .def("ImageNamesOfFailedImagePairs",
+           &theia::InMemoryFeaturesAndMatchesDatabase::
+               ImageNamesOfFailedImagePairs)
       .def("ContainsCameraIntrinsicsPrior",
            &theia::InMemoryFeaturesAndMatchesDatabase::
                ContainsCameraIntrinsicsPrior)
 
       ;
+
+  // MemoryMappedFeaturesAndMatchesDatabase
+  py::class_<theia::MemoryMappedFeaturesAndMatchesDatabase,
+             theia::InMemoryFeaturesAndMatchesDatabase>(
+      m, "MemoryMappedFeaturesAndMatchesDatabase")
+      .def(py::init<std::string>())
+      .def("ContainsFeatures",
+           &theia::MemoryMappedFeaturesAndMatchesDatabase::ContainsFeatures)
+      .def("GetFeatures",
+           &theia::MemoryMappedFeaturesAndMatchesDatabase::GetFeatures)
+      .def("PutFeatures",
+           &theia::MemoryMappedFeaturesAndMatchesDatabase::PutFeatures)
+      .def("ImageNamesOfFeatures",
+           &theia::MemoryMappedFeaturesAndMatchesDatabase::ImageNamesOfFeatures)
+      .def("NumImages",
+           &theia::MemoryMappedFeaturesAndMatchesDatabase::NumImages)
+      .def("Flush", &theia::MemoryMappedFeaturesAndMatchesDatabase::Flush)
+
+      ;
+
+  // CachedFeaturesAndMatchesDatabase
+  py::class_<theia::CachedFeaturesAndMatchesDatabase,
+             theia::FeaturesAndMatchesDatabase>(
+      m, "CachedFeaturesAndMatchesDatabase")
+      .def(py::init<theia::FeaturesAndMatchesDatabase*, size_t>(),
+           py::keep_alive<1, 2>())
+      .def("ContainsFeatures",
+           &theia::CachedFeaturesAndMatchesDatabase::ContainsFeatures)
+      .def("GetFeatures", &theia::CachedFeaturesAndMatchesDatabase::GetFeatures)
+      .def("PutFeatures", &theia::CachedFeaturesAndMatchesDatabase::PutFeatures)
+      .def("ImageNamesOfFeatures",
+           &theia::CachedFeaturesAndMatchesDatabase::ImageNamesOfFeatures)
+      .def("NumImages", &theia::CachedFeaturesAndMatchesDatabase::NumImages)
+      .def("GetImagePairMatch",
+           &theia::CachedFeaturesAndMatchesDatabase::GetImagePairMatch)
+      .def("PutImagePairMatch",
+           &theia::CachedFeaturesAndMatchesDatabase::PutImagePairMatch)
+      .def("NumMatches", &theia::CachedFeaturesAndMatchesDatabase::NumMatches)
+      .def("MaxSizeInBytes",
+           &theia::CachedFeaturesAndMatchesDatabase::MaxSizeInBytes)
+      .def("SizeInBytes", &theia::CachedFeaturesAndMatchesDatabase::SizeInBytes)
+      .def("NumCacheHits",
+           &theia::CachedFeaturesAndMatchesDatabase::NumCacheHits)
+      .def("NumCacheMisses",
+           &theia::CachedFeaturesAndMatchesDatabase::NumCacheMisses)
+      .def("NumEvictions",
+           &theia::CachedFeaturesAndMatchesDatabase::NumEvictions)
+
+      ;
   py::class_<theia::ImagePairMatch>(m, "ImagePairMatch")
       .def(py::init<>())
       .def_readwrite("image1", &theia::ImagePairMatch::image1)
@@ -181,11 +261,41 @@ void pytheia_matching_classes(py::module& m) {
   py::class_<theia::FeatureMatcherOptions>(m, "FeatureMatcherOptions")
       .def(py::init<>())
       .def_readwrite("num_threads", &theia::FeatureMatcherOptions::num_threads)
+      .def_readwrite("numa_aware", &theia::FeatureMatcherOptions::numa_aware)
+      .def_readwrite("schedule_pairs_by_cost",
+                     &theia::FeatureMatcherOptions::schedule_pairs_by_cost)
+      .def_readwrite("match_pairs_in_blocks",
+                     &theia::FeatureMatcherOptions::match_pairs_in_blocks)
+      .def_readwrite("prefetch_features",
+                     &theia::FeatureMatcherOptions::prefetch_features)
       .def_readwrite("keep_only_symmetric_matches",
                      &theia::FeatureMatcherOptions::keep_only_symmetric_matches)
       .def_readwrite("use_lowes_ratio",
                      &theia::FeatureMatcherOptions::use_lowes_ratio)
       .def_readwrite("lowes_ratio", &theia::FeatureMatcherOptions::lowes_ratio)
+      .def_readwrite(
+          "use_blocked_brute_force_matching",
+          &theia::FeatureMatcherOptions::use_blocked_brute_force_matching)
+      .def_readwrite("brute_force_block_size",
+                     &theia::FeatureMatcherOptions::brute_force_block_size)
+      .def_readwrite("num_lsh_tables",
+                     &theia::FeatureMatcherOptions::num_lsh_tables)
+      .def_readwrite("lsh_key_size_in_bits",
+                     &theia::FeatureMatcherOptions::lsh_key_size_in_bits)
+      .def_readwrite("num_kd_trees",
+                     &theia::FeatureMatcherOptions::num_kd_trees)
+      .def_readwrite("num_kd_tree_checks",
+                     &theia::FeatureMatcherOptions::num_kd_tree_checks)
+      .def_readwrite("kd_tree_index_cache_size",
+                     &theia::FeatureMatcherOptions::kd_tree_index_cache_size)
+      .def_readwrite(
+          "hashed_images_cache_size_in_mb",
+          &theia::FeatureMatcherOptions::hashed_images_cache_size_in_mb)
+      .def_readwrite(
+          "store_hashed_images_in_database",
+          &theia::FeatureMatcherOptions::store_hashed_images_in_database)
+      .def_readwrite("match_incrementally",
+                     &theia::FeatureMatcherOptions::match_incrementally)
       .def_readwrite(
           "perform_geometric_verification",
           &theia::FeatureMatcherOptions::perform_geometric_verification)
@@ -197,13 +307,112 @@ void pytheia_matching_classes(py::module& m) {
 
       ;
 
-  // KeypointsAndDescriptors
+  // KeypointsAndDescriptors. The descriptor matrices are returned as NumPy
+  // views of the stored matrices, and float32 and uint8 arrays are copied into
+  // them with a single copy.
   py::class_<theia::KeypointsAndDescriptors>(m, "KeypointsAndDescriptors")
       .def(py::init<>())
+      .def(py::init([](const std::string& image_name,
+                       const Eigen::Ref<const KeypointCoordinates>& keypoints,
+                       const Eigen::Ref<const theia::DescriptorMatrix>&
+                           descriptors) {
+             theia::KeypointsAndDescriptors features;
+             features.image_name = image_name;
+             SetKeypointCoordinates(keypoints, &features);
+             features.descriptor_matrix = descriptors;
+             return features;
+           }),
+           py::arg("image_name"),
+           py::arg("keypoints"),
+           py::arg("descriptors"))
+      .def(py::init([](const std::string& image_name,
+                       const Eigen::Ref<const KeypointCoordinates>& keypoints,
+                       const Eigen::Ref<const theia::QuantizedDescriptorMatrix>&
+                           descriptors,
+                       const float descriptor_quantization_scale) {
+             theia::KeypointsAndDescriptors features;
+             features.image_name = image_name;
+             SetKeypointCoordinates(keypoints, &features);
+             features.quantized_descriptor_matrix = descriptors;
+             features.descriptor_quantization_scale =
+                 descriptor_quantization_scale;
+             return features;
+           }),
+           py::arg("image_name"),
+           py::arg("keypoints"),
+           py::arg("descriptors"),
+           py::arg("descriptor_quantization_scale"))
       .def_readwrite("image_name", &theia::KeypointsAndDescriptors::image_name)
       .def_readwrite("keypoints", &theia::KeypointsAndDescriptors::keypoints)
-      .def_readwrite("descriptors",
-                     &theia::KeypointsAndDescriptors::descriptors);
+      .def_property(
+          "keypoint_coordinates",
+          [](const theia::KeypointsAndDescriptors& features) {
+            KeypointCoordinates coordinates(features.keypoints.size(), 2);
+            for (int i = 0; i < coordinates.rows(); i++) {
+              coordinates(i, 0) = features.keypoints[i].x();
+              coordinates(i, 1) = features.keypoints[i].y();
+            }
+            return coordinates;
+          },
+          [](theia::KeypointsAndDescriptors& features,
+             const Eigen::Ref<const KeypointCoordinates>& coordinates) {
+            SetKeypointCoordinates(coordinates, &features);
+          })
+      .def_property(
+          "descriptor_matrix",
+          [](theia::KeypointsAndDescriptors& features)
+              -> theia::DescriptorMatrix& {
+            return features.descriptor_matrix;
+          },
+          [](theia::KeypointsAndDescriptors& features,
+             const Eigen::Ref<const theia::DescriptorMatrix>& descriptors) {
+            features.descriptor_matrix = descriptors;
+          },
+          py::return_value_policy::reference_internal)
+      .def_property("descriptors",
+                    &theia::KeypointsAndDescriptors::GetDescriptors,
+                    &theia::KeypointsAndDescriptors::SetDescriptors)
+      .def("NumDescriptors", &theia::KeypointsAndDescriptors::NumDescriptors)
+      .def("DescriptorDimension",
+           &theia::KeypointsAndDescriptors::DescriptorDimension)
+      .def_property(
+          "binary_descriptor_matrix",
+          [](theia::KeypointsAndDescriptors& features)
+              -> theia::BinaryDescriptorMatrix& {
+            return features.binary_descriptor_matrix;
+          },
+          [](theia::KeypointsAndDescriptors& features,
+             const Eigen::Ref<const theia::BinaryDescriptorMatrix>&
+                 descriptors) {
+            features.binary_descriptor_matrix = descriptors;
+          },
+          py::return_value_policy::reference_internal)
+      .def("NumBinaryDescriptors",
+           &theia::KeypointsAndDescriptors::NumBinaryDescriptors)
+      .def("BinaryDescriptorSizeInBytes",
+           &theia::KeypointsAndDescriptors::BinaryDescriptorSizeInBytes)
+      .def("HasBinaryDescriptors",
+           &theia::KeypointsAndDescriptors::HasBinaryDescriptors)
+      .def_property(
+          "quantized_descriptor_matrix",
+          [](theia::KeypointsAndDescriptors& features)
+              -> theia::QuantizedDescriptorMatrix& {
+            return features.quantized_descriptor_matrix;
+          },
+          [](theia::KeypointsAndDescriptors& features,
+             const Eigen::Ref<const theia::QuantizedDescriptorMatrix>&
+                 descriptors) {
+            features.quantized_descriptor_matrix = descriptors;
+          },
+          py::return_value_policy::reference_internal)
+      .def_readwrite(
+          "descriptor_quantization_scale",
+          &theia::KeypointsAndDescriptors::descriptor_quantization_scale)
+      .def("HasQuantizedDescriptors",
+           &theia::KeypointsAndDescriptors::HasQuantizedDescriptors)
+      .def("QuantizeDescriptors",
+           &theia::KeypointsAndDescriptors::QuantizeDescriptors,
+           py::arg("scale") = theia::kDefaultDescriptorQuantizationScale);
 
   // IndexedFeatureMatch
   py::class_<theia::IndexedFeatureMatch>(m, "IndexedFeatureMatch")
@@ -231,11 +440,16 @@ void pytheia_matching_classes(py::module& m) {
   py::class_<theia::FisherVectorExtractor::Options>(
       m, "FisherVectorExtractorOptions")
       .def(py::init<>())
-      .def_readwrite("num_threads",
+      .def_readwrite("num_gmm_clusters",
                      &theia::FisherVectorExtractor::Options::num_gmm_clusters)
       .def_readwrite(
-          "keep_only_symmetric_matches",
+          "max_num_features_for_training",
           &theia::FisherVectorExtractor::Options::max_num_features_for_training)
+      .def_readwrite("num_threads",
+                     &theia::FisherVectorExtractor::Options::num_threads)
+      .def_readwrite("max_num_components_per_feature",
+                     &theia::FisherVectorExtractor::Options::
+                         max_num_components_per_feature)
 
       ;
 
@@ -245,9 +459,128 @@ void pytheia_matching_classes(py::module& m) {
       .def(py::init<theia::FisherVectorExtractor::Options>())
       .def("AddFeaturesForTraining",
            &theia::FisherVectorExtractor::AddFeaturesForTraining)
-      .def("Train", &theia::FisherVectorExtractor::Train)
+      .def("Train",
+           &theia::FisherVectorExtractor::Train,
+           py::call_guard<py::gil_scoped_release>())
       .def("ExtractGlobalDescriptor",
-           &theia::FisherVectorExtractor::ExtractGlobalDescriptor)
+           &theia::FisherVectorExtractor::ExtractGlobalDescriptor,
+           py::call_guard<py::gil_scoped_release>())
+      .def("ReadFromDisk", &theia::FisherVectorExtractor::ReadFromDisk)
+      .def("WriteToDisk", &theia::FisherVectorExtractor::WriteToDisk)
+
+      ;
+
+  py::enum_<theia::GlobalDescriptorExtractorType>(
+      m, "GlobalDescriptorExtractorType")
+      .value("FISHER_VECTOR",
+             theia::GlobalDescriptorExtractorType::FISHER_VECTOR)
+      .value("VOCABULARY_TREE",
+             theia::GlobalDescriptorExtractorType::VOCABULARY_TREE)
+      .export_values();
+
+  // VocabularyTree Options
+  py::class_<theia::VocabularyTree::Options>(m, "VocabularyTreeOptions")
+      .def(py::init<>())
+      .def_readwrite("branching_factor",
+                     &theia::VocabularyTree::Options::branching_factor)
+      .def_readwrite("depth", &theia::VocabularyTree::Options::depth)
+      .def_readwrite(
+          "max_num_features_for_training",
+          &theia::VocabularyTree::Options::max_num_features_for_training)
+      .def_readwrite(
+          "max_num_kmeans_iterations",
+          &theia::VocabularyTree::Options::max_num_kmeans_iterations)
+
+      ;
+
+  // VocabularyTree
+  py::class_<theia::VocabularyTree, theia::GlobalDescriptorExtractor>(
+      m, "VocabularyTree")
+      .def(py::init<theia::VocabularyTree::Options>())
+      .def("AddFeaturesForTraining",
+           &theia::VocabularyTree::AddFeaturesForTraining)
+      .def("Train",
+           &theia::VocabularyTree::Train,
+           py::call_guard<py::gil_scoped_release>())
+      .def("ExtractGlobalDescriptor",
+           &theia::VocabularyTree::ExtractGlobalDescriptor,
+           py::call_guard<py::gil_scoped_release>())
+      .def("Quantize", &theia::VocabularyTree::Quantize)
+      .def("AddImage", &theia::VocabularyTree::AddImage)
+      .def("Query",
+           [](const theia::VocabularyTree& vocabulary_tree,
+              const std::vector<Eigen::VectorXf>& features,
+              const int num_images) {
+             std::vector<std::pair<float, int>> results;
+             vocabulary_tree.Query(features, num_images, &results);
+             return results;
+           },
+           py::call_guard<py::gil_scoped_release>())
+      .def("NumWords", &theia::VocabularyTree::NumWords)
+      .def("NumImages", &theia::VocabularyTree::NumImages)
+
+      ;
+
+  // SequentialPairSelector Options
+  py::class_<theia::SequentialPairSelector::Options>(
+      m, "SequentialPairSelectorOptions")
+      .def(py::init<>())
+      .def_readwrite("min_window_size",
+                     &theia::SequentialPairSelector::Options::min_window_size)
+      .def_readwrite("max_window_size",
+                     &theia::SequentialPairSelector::Options::max_window_size)
+      .def_readwrite("min_inlier_ratio_to_grow_window",
+                     &theia::SequentialPairSelector::Options::
+                         min_inlier_ratio_to_grow_window)
+
+      ;
+
+  // SequentialPairSelector
+  py::class_<theia::SequentialPairSelector>(m, "SequentialPairSelector")
+      .def(py::init<theia::SequentialPairSelector::Options, int>())
+      .def("NextPairsToMatch",
+           &theia::SequentialPairSelector::NextPairsToMatch)
+      .def("UpdateWindows", &theia::SequentialPairSelector::UpdateWindows)
+      .def("WindowSize", &theia::SequentialPairSelector::WindowSize)
+
+      ;
+
+  // SpatialPairSelectionOptions
+  py::class_<theia::SpatialPairSelectionOptions>(
+      m, "SpatialPairSelectionOptions")
+      .def(py::init<>())
+      .def_readwrite("num_nearest_neighbors",
+                     &theia::SpatialPairSelectionOptions::num_nearest_neighbors)
+      .def_readwrite("max_distance",
+                     &theia::SpatialPairSelectionOptions::max_distance)
+
+      ;
+
+  m.def("SelectImagePairsWithPositionPriors",
+        [](const theia::SpatialPairSelectionOptions& options,
+           const std::vector<Eigen::Vector3d>& positions) {
+          std::vector<std::pair<int, int>> image_pairs;
+          theia::SelectImagePairsWithPositionPriors(
+              options, positions, &image_pairs);
+          return image_pairs;
+        });
+
+  // SpatialRerankingOptions
+  py::class_<theia::SpatialRerankingOptions>(m, "SpatialRerankingOptions")
+      .def(py::init<>())
+      .def_readwrite("max_num_features",
+                     &theia::SpatialRerankingOptions::max_num_features)
+      .def_readwrite("lowes_ratio",
+                     &theia::SpatialRerankingOptions::lowes_ratio)
+      .def_readwrite(
+          "max_transfer_error_pixels",
+          &theia::SpatialRerankingOptions::max_transfer_error_pixels)
+      .def_readwrite("min_num_inliers",
+                     &theia::SpatialRerankingOptions::min_num_inliers)
+      .def_readwrite("min_num_pairs_per_image",
+                     &theia::SpatialRerankingOptions::min_num_pairs_per_image)
+      .def_readwrite("num_threads",
+                     &theia::SpatialRerankingOptions::num_threads)
 
       ;
 
@@ -259,21 +592,50 @@ void pytheia_matching_classes(py::module& m) {
       .def("AddImages",
            (void (theia::FeatureMatcher::*)(const std::vector<std::string>&)) &
                theia::FeatureMatcher::AddImages,
-           py::return_value_policy::reference_internal)
+           py::return_value_policy::reference_internal,
+           py::call_guard<py::gil_scoped_release>())
       .def("AddImage",
            (void (theia::FeatureMatcher::*)(const std::string&)) &
                theia::FeatureMatcher::AddImage,
            py::return_value_policy::reference_internal)
-      .def("MatchImages", &theia::FeatureMatcher::MatchImages)
+      .def("MatchImages",
+           &theia::FeatureMatcher::MatchImages,
+           py::call_guard<py::gil_scoped_release>())
       .def("SetImagePairsToMatch", &theia::FeatureMatcher::SetImagePairsToMatch)
+      .def("GetGeometricVerificationSummary",
+           &theia::FeatureMatcher::GetGeometricVerificationSummary)
 
       ;
 
+  // FeatureMatcher::GeometricVerificationSummary
+  py::class_<theia::FeatureMatcher::GeometricVerificationSummary>(
+      m, "GeometricVerificationSummary")
+      .def(py::init<>())
+      .def_readwrite("num_verified_pairs",
+                     &theia::FeatureMatcher::GeometricVerificationSummary::
+                         num_verified_pairs)
+      .def_readwrite("num_pre_verification_rejections",
+                     &theia::FeatureMatcher::GeometricVerificationSummary::
+                         num_pre_verification_rejections)
+      .def_readwrite("num_pre_verification_hypotheses",
+                     &theia::FeatureMatcher::GeometricVerificationSummary::
+                         num_pre_verification_hypotheses)
+      .def_readwrite("num_pre_verification_hypotheses_rejected_by_sprt",
+                     &theia::FeatureMatcher::GeometricVerificationSummary::
+                         num_pre_verification_hypotheses_rejected_by_sprt)
+      .def_readwrite("num_pre_verification_residuals_evaluated",
+                     &theia::FeatureMatcher::GeometricVerificationSummary::
+                         num_pre_verification_residuals_evaluated)
+      .def_readwrite("ransac_statistics",
+                     &theia::FeatureMatcher::GeometricVerificationSummary::
+                         ransac_statistics);
+
   // BruteForceFeatureMatcher
   py::class_<theia::BruteForceFeatureMatcher, theia::FeatureMatcher>(
       m, "BruteForceFeatureMatcher")
       .def(py::init<theia::FeatureMatcherOptions,
-                    theia::FeaturesAndMatchesDatabase*>())
+                    theia::FeaturesAndMatchesDatabase*>(),
+           py::keep_alive<1, 3>())
       // abstract class in the constructor
       //.def(py::init<theia::FeatureMatcherOptions,
       //theia::FeaturesAndMatchesDatabase>())
@@ -285,12 +647,14 @@ void pytheia_matching_classes(py::module& m) {
       m, "CascadeHashingFeatureMatcher")
       // abstract class in the constructor
       .def(py::init<theia::FeatureMatcherOptions,
-                    theia::FeaturesAndMatchesDatabase*>())
+                    theia::FeaturesAndMatchesDatabase*>(),
+           py::keep_alive<1, 3>())
       .def("AddImages",
            (void (theia::CascadeHashingFeatureMatcher::*)(
                const std::vector<std::string>&)) &
                theia::CascadeHashingFeatureMatcher::AddImages,
-           py::return_value_policy::reference_internal)
+           py::return_value_policy::reference_internal,
+           py::call_guard<py::gil_scoped_release>())
       .def("AddImage",
            (void (theia::CascadeHashingFeatureMatcher::*)(const std::string&)) &
                theia::CascadeHashingFeatureMatcher::AddImage,
@@ -298,9 +662,25 @@ void pytheia_matching_classes(py::module& m) {
 
       ;
 
+  // LshFeatureMatcher
+  py::class_<theia::LshFeatureMatcher, theia::FeatureMatcher>(
+      m, "LshFeatureMatcher")
+      .def(py::init<theia::FeatureMatcherOptions,
+                    theia::FeaturesAndMatchesDatabase*>(),
+           py::keep_alive<1, 3>());
+
+  // KdTreeFeatureMatcher
+  py::class_<theia::KdTreeFeatureMatcher, theia::FeatureMatcher>(
+      m, "KdTreeFeatureMatcher")
+      .def(py::init<theia::FeatureMatcherOptions,
+                    theia::FeaturesAndMatchesDatabase*>(),
+           py::keep_alive<1, 3>());
+
   py::enum_<theia::MatchingStrategy>(m, "MatchingStrategy")
       .value("GLOBAL", theia::MatchingStrategy::BRUTE_FORCE)
       .value("INCREMENTAL", theia::MatchingStrategy::CASCADE_HASHING)
+      .value("BINARY_LSH", theia::MatchingStrategy::BINARY_LSH)
+      .value("KD_TREE", theia::MatchingStrategy::KD_TREE)
       .export_values();
 }
 
@@ -0,0 +1,160 @@
+"""Structured access to the pipeline instrumentation from Python.
+
+The C++ pipeline records the spans of its stages with the tracer
+(pytheia.util.Tracer) and keeps counters, gauges and histograms in a process
+wide registry (pytheia.util.Metrics). The functions below return them as
+dicts, and the context managers scope them to a block of Python code:
+
+    with profiling.Trace() as trace, profiling.MeasureMetrics() as metrics:
+        builder.BuildReconstruction()
+    print(trace.StageTimings())
+    print(metrics.delta["counters"])
+
+RANSAC summaries, bundle adjustment summaries and feature caches are plain
+objects; ToDict and CacheStatistics convert them for logging.
+"""
+import collections
+import json
+import numbers
+
+from pytheia.pytheia import util
+
+
+def MetricsSnapshot():
+    """Returns the current metrics as a dict with the uptime and the
+    counters, gauges and histograms by name."""
+    return json.loads(util.Metrics.Json())
+
+
+def _CounterDeltas(after, before):
+    """The increase of each counter between two snapshots."""
+    return {name: counter["value"] -
+            before.get(name, {}).get("value", 0)
+            for name, counter in after.items()}
+
+
+def _HistogramDeltas(after, before):
+    """The observations added to each histogram between two snapshots."""
+    deltas = {}
+    for name, histogram in after.items():
+        previous = before.get(name, {"count": 0, "sum": 0.0, "buckets": []})
+        previous_counts = {bucket["le"]: bucket["count"]
+                           for bucket in previous["buckets"]}
+        deltas[name] = {
+            "count": histogram["count"] - previous["count"],
+            "sum": histogram["sum"] - previous["sum"],
+            "buckets": [{"le": bucket["le"],
+                         "count": bucket["count"] -
+                         previous_counts.get(bucket["le"], 0)}
+                        for bucket in histogram["buckets"]],
+        }
+    return deltas
+
+
+class MeasureMetrics(object):
+    """Snapshots the metrics when the block is entered and left. delta holds
+    the change of the counters and histograms over the block. Gauges are
+    levels rather than totals and are reported with their final value."""
+
+    def __init__(self):
+        self.before = None
+        self.after = None
+        self.delta = None
+
+    def __enter__(self):
+        self.before = MetricsSnapshot()
+        return self
+
+    def __exit__(self, *exc_info):
+        self.after = MetricsSnapshot()
+        self.delta = {
+            "seconds": self.after["uptime_seconds"] -
+            self.before["uptime_seconds"],
+            "counters": _CounterDeltas(self.after["counters"],
+                                       self.before["counters"]),
+            "gauges": self.after["gauges"],
+            "histograms": _HistogramDeltas(self.after["histograms"],
+                                           self.before["histograms"]),
+        }
+        return False
+
+
+class Trace(object):
+    """Records the spans of the pipeline stages that run inside the block.
+    Recording clears the spans recorded before, and tracing is restored to
+    its previous state when the block is left."""
+
+    def __init__(self):
+        self.events = []
+        self._was_enabled = False
+
+    def __enter__(self):
+        self._was_enabled = util.Tracer.IsEnabled()
+        util.Tracer.Clear()
+        util.Tracer.Enable()
+        return self
+
+    def __exit__(self, *exc_info):
+        if not self._was_enabled:
+            util.Tracer.Disable()
+        self.events = [event for event in
+                       json.loads(util.Tracer.ChromeTrace())["traceEvents"]
+                       if event.get("ph") == "X"]
+        return False
+
+    def StageTimings(self):
+        """Returns the number of calls, total seconds and maximum seconds of
+        each traced stage, by stage name. Stages that run on several threads
+        are summed over the threads."""
+        timings = collections.OrderedDict()
+        for event in sorted(self.events, key=lambda event: event["ts"]):
+            stage = timings.setdefault(
+                event["name"],
+                {"count": 0, "total_seconds": 0.0, "max_seconds": 0.0})
+            seconds = event["dur"] * 1e-6
+            stage["count"] += 1
+            stage["total_seconds"] += seconds
+            stage["max_seconds"] = max(stage["max_seconds"], seconds)
+        return timings
+
+    def Write(self, filepath):
+        """Writes the trace in the Chrome trace format, which is read by
+        chrome://tracing and https://ui.perfetto.dev."""
+        with open(filepath, "w") as trace_file:
+            json.dump({"traceEvents": self.events}, trace_file)
+
+
+def ToDict(summary):
+    """Converts a summary or statistics object (e.g. RansacSummary,
+    RansacStatistics, BundleAdjustmentSummary) to a dict of its fields.
+    Nested objects are converted recursively."""
+    if isinstance(summary, (numbers.Number, str, bool)) or summary is None:
+        return summary
+    if isinstance(summary, (list, tuple)):
+        return [ToDict(value) for value in summary]
+    if hasattr(summary, "tolist"):
+        return summary.tolist()
+    fields = {}
+    for name in dir(summary):
+        if name.startswith("_"):
+            continue
+        value = getattr(summary, name)
+        if callable(value):
+            continue
+        fields[name] = ToDict(value)
+    return fields
+
+
+def CacheStatistics(database):
+    """Returns the hit, miss and eviction counts and the size of a
+    CachedFeaturesAndMatchesDatabase."""
+    hits = database.NumCacheHits()
+    misses = database.NumCacheMisses()
+    return {
+        "hits": hits,
+        "misses": misses,
+        "hit_rate": hits / float(hits + misses) if hits + misses > 0 else 0.0,
+        "evictions": database.NumEvictions(),
+        "size_in_bytes": database.SizeInBytes(),
+        "max_size_in_bytes": database.MaxSizeInBytes(),
+    }
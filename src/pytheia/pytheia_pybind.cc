@@ -34,11 +34,13 @@
 
 #include <pybind11/pybind11.h>
 
+#include "pytheia/image/image.h"
 #include "pytheia/io/io.h"
 #include "pytheia/matching/matching.h"
 #include "pytheia/math/math.h"
 #include "pytheia/sfm/sfm.h"
 #include "pytheia/solvers/solvers.h"
+#include "pytheia/util/util.h"
 
 namespace pytheia {
 
@@ -46,11 +48,13 @@ PYBIND11_MODULE(pytheia, m) {
   m.doc() = "Python binding for TheiaSfM";
 
   // register all submodules here
+  image::pytheia_image(m);
   io::pytheia_io(m);
   matching::pytheia_matching(m);
   math::pytheia_math(m);
   sfm::pytheia_sfm(m);
   solvers::pytheia_solvers(m);
+  util::pytheia_util(m);
 }
 
 }  // namespace pytheia
\ No newline at end of file
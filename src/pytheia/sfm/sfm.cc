@@ -43,17 +43,27 @@
 #include <complex>
 #include <glog/logging.h>
 #include <math.h>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <vector>
 
+#include "theia/io/columnar_view_graph.h"
+#include "theia/io/reconstruction_reader.h"
+#include "theia/io/reconstruction_writer.h"
 #include "theia/math/polynomial.h"
 #include "theia/sfm/pose/util.h"
 
 #include "theia/matching/features_and_matches_database.h"
+#include "theia/sfm/evaluate_relative_poses.h"
 #include "theia/sfm/feature.h"
 
 #include "theia/sfm/pose/pose_wrapper.h"
 #include "theia/sfm/triangulation/triangulation.h"
 #include "theia/sfm/triangulation/triangulation_wrapper.h"
 
+#include "theia/sfm/transformation/align_multiple_reconstructions.h"
 #include "theia/sfm/transformation/align_point_clouds.h"
 #include "theia/sfm/transformation/align_reconstructions.h"
 #include "theia/sfm/transformation/gdls_similarity_transform.h"
@@ -61,6 +71,7 @@
 
 #include "theia/sfm/camera/camera.h"
 #include "theia/sfm/camera/camera_intrinsics_model.h"
+#include "theia/sfm/camera_rig.h"
 #include "theia/sfm/camera/camera_wrapper.h"
 #include "theia/sfm/camera/division_undistortion_camera_model.h"
 #include "theia/sfm/camera/fisheye_camera_model.h"
@@ -92,6 +103,7 @@
 // reconstruction view track
 #include "theia/matching/keypoints_and_descriptors.h"
 #include "theia/sfm/reconstruction.h"
+#include "theia/sfm/reconstruction_arrays.h"
 #include "theia/sfm/track.h"
 #include "theia/sfm/two_view_match_geometric_verification.h"
 #include "theia/sfm/twoview_info.h"
@@ -99,10 +111,12 @@
 #include "theia/sfm/view_graph/view_graph.h"
 #include "theia/sfm/visibility_pyramid.h"
 #include "theia/sfm/view_graph/remove_disconnected_view_pairs.h"
+#include "theia/sfm/view_graph/sparsify_view_graph.h"
 
 #include "theia/sfm/global_reconstruction_estimator.h"
 #include "theia/sfm/hybrid_reconstruction_estimator.h"
 #include "theia/sfm/incremental_reconstruction_estimator.h"
+#include "theia/sfm/online_reconstruction_builder.h"
 #include "theia/sfm/reconstruction_builder.h"
 #include "theia/sfm/reconstruction_estimator.h"
 #include "theia/sfm/reconstruction_estimator_options.h"
@@ -135,11 +149,15 @@
 #include "theia/sfm/find_common_tracks_in_views.h"
 #include "theia/sfm/find_common_views_by_name.h"
 #include "theia/sfm/gps_converter.h"
+#include "theia/sfm/localization_index.h"
 #include "theia/sfm/localize_view_to_reconstruction.h"
+#include "theia/sfm/parallel_track_builder.h"
 #include "theia/sfm/pose/upnp.h"
 #include "theia/sfm/select_good_tracks_for_bundle_adjustment.h"
 #include "theia/sfm/set_camera_intrinsics_from_priors.h"
+#include "theia/sfm/set_position_priors_from_gps.h"
 #include "theia/sfm/set_outlier_tracks_to_unestimated.h"
+#include "theia/sfm/sub_reconstruction.h"
 #include "theia/sfm/sfm_wrapper.h"
 #include "theia/sfm/undistort_image.h"
 
@@ -165,10 +183,76 @@ void AddIntrinsicsPriorType(py::module& m, const std::string& name) {
                     &theia::Prior<N>::SetParametersValues);
 }
 
+// A serialized object that is exposed through the buffer protocol, so that
+// pickle protocol 5 can pass it out-of-band instead of copying it into bytes.
+struct SerializedBuffer {
+  std::string data;
+};
+
+// Pickling of large objects through their binary formats. The state is the
+// serialized object, which is passed to pickle as a PickleBuffer for protocol 5
+// and as bytes otherwise. The GIL is released while (de)serializing.
+template <class T, void (*Serialize)(const T&, std::string*)>
+std::unique_ptr<SerializedBuffer> SerializeWithoutGil(const T& object) {
+  std::unique_ptr<SerializedBuffer> buffer(new SerializedBuffer);
+  py::gil_scoped_release release;
+  Serialize(object, &buffer->data);
+  return buffer;
+}
+
+template <class T, void (*Serialize)(const T&, std::string*)>
+py::buffer GetPickleState(const T& object) {
+  return py::buffer(
+      py::bytes(SerializeWithoutGil<T, Serialize>(object)->data));
+}
+
+template <class T, bool (*Deserialize)(const char*, const size_t, T*)>
+std::unique_ptr<T> SetPickleState(const py::buffer& state) {
+  const py::buffer_info info = state.request();
+  std::unique_ptr<T> object(new T);
+  bool success;
+  {
+    py::gil_scoped_release release;
+    success = Deserialize(static_cast<const char*>(info.ptr),
+                          info.size * info.itemsize,
+                          object.get());
+  }
+  if (!success) {
+    throw std::runtime_error("Could not unpickle the serialized object.");
+  }
+  return object;
+}
+
+template <class T, void (*Serialize)(const T&, std::string*)>
+py::tuple ReduceEx(const py::object& self, const int protocol) {
+  const py::module pickle = py::module::import("pickle");
+  py::object state;
+  if (protocol >= 5 && py::hasattr(pickle, "PickleBuffer")) {
+    state = pickle.attr("PickleBuffer")(
+        py::cast(SerializeWithoutGil<T, Serialize>(self.cast<const T&>())));
+  } else {
+    state = GetPickleState<T, Serialize>(self.cast<const T&>());
+  }
+  return py::make_tuple(py::module::import("copyreg").attr("__newobj__"),
+                        py::make_tuple(self.get_type()),
+                        state);
+}
+
 namespace pytheia {
 namespace sfm {
 
 void pytheia_sfm_classes(py::module& m) {
+  py::class_<SerializedBuffer>(m, "SerializedBuffer", py::buffer_protocol())
+      .def_buffer([](SerializedBuffer& buffer) {
+        return py::buffer_info(&buffer.data[0],
+                               sizeof(uint8_t),
+                               py::format_descriptor<uint8_t>::format(),
+                               1,
+                               {buffer.data.size()},
+                               {sizeof(uint8_t)},
+                               /*readonly=*/true);
+      });
+
   m.attr("kInvalidTrackId") = theia::kInvalidTrackId;
   m.attr("kInvalidViewId") = theia::kInvalidViewId;
   // camera
@@ -202,9 +286,13 @@ void pytheia_sfm_classes(py::module& m) {
       .def("SetPrincipalPoint",
            &theia::CameraIntrinsicsModel::SetPrincipalPoint)
       .def("CameraToImageCoordinates",
-           &theia::CameraIntrinsicsModel::CameraToImageCoordinates)
+           py::overload_cast<const Eigen::Vector3d&>(
+               &theia::CameraIntrinsicsModel::CameraToImageCoordinates,
+               py::const_))
       .def("ImageToCameraCoordinates",
-           &theia::CameraIntrinsicsModel::ImageToCameraCoordinates)
+           py::overload_cast<const Eigen::Vector2d&>(
+               &theia::CameraIntrinsicsModel::ImageToCameraCoordinates,
+               py::const_))
       .def("GetParameter", &theia::CameraIntrinsicsModel::GetParameter)
       .def("SetParameter", &theia::CameraIntrinsicsModel::SetParameter)
       // .def("DistortPoint", py::overload_cast<const
@@ -460,6 +548,9 @@ void pytheia_sfm_classes(py::module& m) {
            &theia::Camera::PixelToNormalizedCoordinates)
       .def("PixelToUnitDepthRay", &theia::Camera::PixelToUnitDepthRay)
       .def("ProjectPoint", &theia::Camera::ProjectPointWrapper)
+      .def("ProjectPoints", &theia::Camera::ProjectPointsWrapper)
+      .def("PixelsToBearings", &theia::Camera::PixelsToBearingsWrapper)
+      .def("BuildUndistortionMap", &theia::Camera::BuildUndistortionMap)
       //.def_readonly_static("kExtrinsicsSize", &theia::Camera::kExtrinsicsSize)
       ;
 
@@ -558,10 +649,74 @@ void pytheia_sfm_classes(py::module& m) {
         theia::AlignPointCloudsUmeyamaWithWeightsWrapper);
   m.def("GdlsSimilarityTransform", theia::GdlsSimilarityTransformWrapper);
   m.def("AlignRotations", theia::AlignRotationsWrapper);
-  m.def("AlignReconstructions", theia::AlignReconstructionsWrapper);
-  m.def("AlignReconstructionsRobust", theia::AlignReconstructionsRobustWrapper);
+  m.def("AlignReconstructions",
+        theia::AlignReconstructionsWrapper,
+        py::call_guard<py::gil_scoped_release>());
+  m.def("AlignReconstructionsRobust",
+        theia::AlignReconstructionsRobustWrapper,
+        py::call_guard<py::gil_scoped_release>());
   m.def("TransformReconstruction", theia::TransformReconstructionWrapper);
 
+  py::class_<theia::MultipleReconstructionAlignmentOptions>(
+      m, "MultipleReconstructionAlignmentOptions")
+      .def(py::init<>())
+      .def_readwrite(
+          "num_threads",
+          &theia::MultipleReconstructionAlignmentOptions::num_threads)
+      .def_readwrite("reference_reconstruction",
+                     &theia::MultipleReconstructionAlignmentOptions::
+                         reference_reconstruction)
+      .def_readwrite("min_num_correspondences",
+                     &theia::MultipleReconstructionAlignmentOptions::
+                         min_num_correspondences)
+      .def_readwrite(
+          "use_shared_tracks",
+          &theia::MultipleReconstructionAlignmentOptions::use_shared_tracks)
+      .def_readwrite("min_num_shared_observations",
+                     &theia::MultipleReconstructionAlignmentOptions::
+                         min_num_shared_observations)
+      .def_readwrite("relative_error_threshold",
+                     &theia::MultipleReconstructionAlignmentOptions::
+                         relative_error_threshold)
+      .def_readwrite("max_num_correspondences_per_pair",
+                     &theia::MultipleReconstructionAlignmentOptions::
+                         max_num_correspondences_per_pair)
+      .def_readwrite(
+          "robust_loss_width",
+          &theia::MultipleReconstructionAlignmentOptions::robust_loss_width)
+      .def_readwrite(
+          "max_num_iterations",
+          &theia::MultipleReconstructionAlignmentOptions::max_num_iterations)
+      .def_readwrite(
+          "random_seed",
+          &theia::MultipleReconstructionAlignmentOptions::random_seed);
+
+  py::class_<theia::MultipleReconstructionAlignmentSummary>(
+      m, "MultipleReconstructionAlignmentSummary")
+      .def(py::init<>())
+      .def_readonly(
+          "transformations",
+          &theia::MultipleReconstructionAlignmentSummary::transformations)
+      .def_readonly("aligned",
+                    &theia::MultipleReconstructionAlignmentSummary::aligned)
+      .def_readonly(
+          "num_aligned_pairs",
+          &theia::MultipleReconstructionAlignmentSummary::num_aligned_pairs);
+
+  // Returns whether all reconstructions were aligned and the summary.
+  m.def(
+      "AlignMultipleReconstructions",
+      [](const theia::MultipleReconstructionAlignmentOptions& options,
+         const std::vector<theia::Reconstruction*>& reconstructions) {
+        theia::MultipleReconstructionAlignmentSummary summary;
+        const bool success = theia::AlignMultipleReconstructions(
+            options, reconstructions, &summary);
+        return std::make_tuple(success, summary);
+      },
+      py::arg("options"),
+      py::arg("reconstructions"),
+      py::call_guard<py::gil_scoped_release>());
+
   py::class_<theia::SimilarityTransformation>(m, "SimilarityTransformation")
       .def(py::init<>())
       .def_readwrite("rotation", &theia::SimilarityTransformation::rotation)
@@ -642,6 +797,15 @@ void pytheia_sfm_classes(py::module& m) {
       .def_readwrite("point", &theia::Plane::point)
       .def_readwrite("unit_normal", &theia::Plane::unit_normal);
 
+  py::class_<theia::DominantPlanesOptions>(m, "DominantPlanesOptions")
+      .def(py::init<>())
+      .def_readwrite("voxel_size", &theia::DominantPlanesOptions::voxel_size)
+      .def_readwrite("num_threads", &theia::DominantPlanesOptions::num_threads)
+      .def_readwrite("max_num_planes",
+                     &theia::DominantPlanesOptions::max_num_planes)
+      .def_readwrite("min_num_inliers",
+                     &theia::DominantPlanesOptions::min_num_inliers);
+
   py::class_<theia::RadialDistortionFeatureCorrespondence>(
       m, "RadialDistortionFeatureCorrespondence")
       .def(py::init<>())
@@ -692,38 +856,134 @@ void pytheia_sfm_classes(py::module& m) {
       .value("PROSAC", theia::RansacType::PROSAC)
       .value("LMED", theia::RansacType::LMED)
       .value("EXHAUSTIVE", theia::RansacType::EXHAUSTIVE)
+      .value("PREEMPTIVE", theia::RansacType::PREEMPTIVE)
       .export_values();
  
    py::enum_<theia::PnPType>(m, "PnPType")
       .value("KNEIP", theia::PnPType::KNEIP)
       .value("DLS", theia::PnPType::DLS)
       .value("SQPnP", theia::PnPType::SQPnP)
+      .value("CASCADE", theia::PnPType::CASCADE)
       .export_values();
 
   m.def("EstimateAbsolutePoseWithKnownOrientation",
-        theia::EstimateAbsolutePoseWithKnownOrientationWrapper);
+        theia::EstimateAbsolutePoseWithKnownOrientationWrapper,
+        py::call_guard<py::gil_scoped_release>());
   m.def("EstimateCalibratedAbsolutePose",
-        theia::EstimateCalibratedAbsolutePoseWrapper);
+        theia::EstimateCalibratedAbsolutePoseWrapper,
+        py::call_guard<py::gil_scoped_release>());
+  m.def("EstimateCalibratedAbsolutePoseWithKnownGravity",
+        theia::EstimateCalibratedAbsolutePoseWithKnownGravityWrapper,
+        py::call_guard<py::gil_scoped_release>());
   m.def("EstimateDominantPlaneFromPoints",
-        theia::EstimateDominantPlaneFromPointsWrapper);
-
-  m.def("EstimateEssentialMatrix", theia::EstimateEssentialMatrixWrapper);
-  m.def("EstimateFundamentalMatrix", theia::EstimateFundamentalMatrixWrapper);
-  m.def("EstimateHomography", theia::EstimateHomographyWrapper);
+        theia::EstimateDominantPlaneFromPointsWrapper,
+        py::call_guard<py::gil_scoped_release>());
+  m.def("EstimateDominantPlanesFromPoints",
+        theia::EstimateDominantPlanesFromPointsWrapper,
+        py::call_guard<py::gil_scoped_release>());
+
+  m.def("EstimateEssentialMatrix",
+        theia::EstimateEssentialMatrixWrapper,
+        py::call_guard<py::gil_scoped_release>());
+  m.def("EstimateFundamentalMatrix",
+        theia::EstimateFundamentalMatrixWrapper,
+        py::call_guard<py::gil_scoped_release>());
+  m.def("EstimateHomography",
+        theia::EstimateHomographyWrapper,
+        py::call_guard<py::gil_scoped_release>());
   m.def("EstimateRadialHomographyMatrix",
-        theia::EstimateRadialHomographyMatrixWrapper);
-  m.def("EstimateRelativePose", theia::EstimateRelativePoseWrapper);
+        theia::EstimateRadialHomographyMatrixWrapper,
+        py::call_guard<py::gil_scoped_release>());
+  m.def("EstimateRelativePose",
+        theia::EstimateRelativePoseWrapper,
+        py::call_guard<py::gil_scoped_release>());
   m.def("EstimateRelativePoseWithKnownOrientation",
-        theia::EstimateRelativePoseWithKnownOrientationWrapper);
+        theia::EstimateRelativePoseWithKnownOrientationWrapper,
+        py::call_guard<py::gil_scoped_release>());
   m.def("EstimateRigidTransformation2D3D",
-        theia::EstimateRigidTransformation2D3DWrapper);
+        theia::EstimateRigidTransformation2D3DWrapper,
+        py::call_guard<py::gil_scoped_release>());
   m.def("EstimateRigidTransformation2D3DNormalized",
-        theia::EstimateRigidTransformation2D3DNormalizedWrapper);
-  m.def("EstimateTriangulation", theia::EstimateTriangulationWrapper);
+        theia::EstimateRigidTransformation2D3DNormalizedWrapper,
+        py::call_guard<py::gil_scoped_release>());
+  m.def("EstimateTriangulation",
+        theia::EstimateTriangulationWrapper,
+        py::call_guard<py::gil_scoped_release>());
   m.def("EstimateUncalibratedAbsolutePose",
-        theia::EstimateUncalibratedAbsolutePoseWrapper);
+        theia::EstimateUncalibratedAbsolutePoseWrapper,
+        py::call_guard<py::gil_scoped_release>());
   m.def("EstimateUncalibratedRelativePose",
-        theia::EstimateUncalibratedRelativePoseWrapper);
+        theia::EstimateUncalibratedRelativePoseWrapper,
+        py::call_guard<py::gil_scoped_release>());
+
+  // Batch estimators. The correspondences of problem i are the rows
+  // [offsets[i], offsets[i + 1]) of the correspondence array.
+  py::class_<theia::BatchEstimationResult>(m, "BatchEstimationResult")
+      .def(py::init<>())
+      .def_readonly("success", &theia::BatchEstimationResult::success)
+      .def_readonly("models", &theia::BatchEstimationResult::models)
+      .def_readonly("num_inliers", &theia::BatchEstimationResult::num_inliers)
+      .def_readonly("inliers", &theia::BatchEstimationResult::inliers);
+
+  m.def("EstimateCalibratedAbsolutePoses",
+        theia::EstimateCalibratedAbsolutePosesWrapper,
+        py::arg("ransac_params"),
+        py::arg("ransac_type"),
+        py::arg("pnp_type"),
+        py::arg("normalized_correspondences"),
+        py::arg("offsets"),
+        py::arg("num_threads") = 1,
+        py::call_guard<py::gil_scoped_release>());
+  m.def("EstimateEssentialMatrices",
+        theia::EstimateEssentialMatricesWrapper,
+        py::arg("ransac_params"),
+        py::arg("ransac_type"),
+        py::arg("normalized_correspondences"),
+        py::arg("offsets"),
+        py::arg("num_threads") = 1,
+        py::call_guard<py::gil_scoped_release>());
+  m.def("EstimateFundamentalMatrices",
+        theia::EstimateFundamentalMatricesWrapper,
+        py::arg("ransac_params"),
+        py::arg("ransac_type"),
+        py::arg("correspondences"),
+        py::arg("offsets"),
+        py::arg("num_threads") = 1,
+        py::call_guard<py::gil_scoped_release>());
+  m.def("EstimateHomographies",
+        theia::EstimateHomographiesWrapper,
+        py::arg("ransac_params"),
+        py::arg("ransac_type"),
+        py::arg("correspondences"),
+        py::arg("offsets"),
+        py::arg("num_threads") = 1,
+        py::call_guard<py::gil_scoped_release>());
+  m.def("EstimateRelativePoses",
+        theia::EstimateRelativePosesWrapper,
+        py::arg("ransac_params"),
+        py::arg("ransac_type"),
+        py::arg("normalized_correspondences"),
+        py::arg("offsets"),
+        py::arg("num_threads") = 1,
+        py::call_guard<py::gil_scoped_release>());
+  // Models are rows of the rotation, translation and scale of the similarity
+  // transformations.
+  m.def("EstimateSimilarityTransformations",
+        theia::EstimateSimilarityTransformationsWrapper,
+        py::arg("ransac_params"),
+        py::arg("ransac_type"),
+        py::arg("correspondences"),
+        py::arg("offsets"),
+        py::arg("num_threads") = 1,
+        py::call_guard<py::gil_scoped_release>());
+  m.def("EstimateSimilarityTransformationsFromRays",
+        theia::EstimateSimilarityTransformationsFromRaysWrapper,
+        py::arg("ransac_params"),
+        py::arg("ransac_type"),
+        py::arg("correspondences"),
+        py::arg("offsets"),
+        py::arg("num_threads") = 1,
+        py::call_guard<py::gil_scoped_release>());
 
   // triangulation
   m.def("Triangulate", theia::TriangulateWrapper);
@@ -731,6 +991,15 @@ void pytheia_sfm_classes(py::module& m) {
   m.def("TriangulateDLT", theia::TriangulateDLTWrapper);
   m.def("TriangulateNViewSVD", theia::TriangulateNViewSVDWrapper);
   m.def("TriangulateNView", theia::TriangulateNViewWrapper);
+  m.def("TriangulateNViewBatch",
+        theia::TriangulateNViewBatchWrapper,
+        py::call_guard<py::gil_scoped_release>());
+  m.def("TriangulateNViewSVDBatch",
+        theia::TriangulateNViewSVDBatchWrapper,
+        py::call_guard<py::gil_scoped_release>());
+  m.def("TriangulateMidpointBatch",
+        theia::TriangulateMidpointBatchWrapper,
+        py::call_guard<py::gil_scoped_release>());
   m.def("IsTriangulatedPointInFrontOfCameras",
         theia::IsTriangulatedPointInFrontOfCameras);
   m.def("SufficientTriangulationAngle", theia::SufficientTriangulationAngle);
@@ -753,7 +1022,11 @@ void pytheia_sfm_classes(py::module& m) {
                      &theia::EstimateTwoViewInfoOptions::max_ransac_iterations)
       .def_readwrite("use_mle", &theia::EstimateTwoViewInfoOptions::use_mle)
       .def_readwrite("use_lo", &theia::EstimateTwoViewInfoOptions::use_lo)
-      .def_readwrite("lo_start_iterations", &theia::EstimateTwoViewInfoOptions::lo_start_iterations);
+      .def_readwrite("lo_start_iterations", &theia::EstimateTwoViewInfoOptions::lo_start_iterations)
+      .def_readwrite("lo_type", &theia::EstimateTwoViewInfoOptions::lo_type)
+      .def_readwrite(
+          "collect_ransac_statistics",
+          &theia::EstimateTwoViewInfoOptions::collect_ransac_statistics);
 
   py::class_<theia::FilterViewPairsFromRelativeTranslationOptions>(
       m, "FilterViewPairsFromRelativeTranslationOptions")
@@ -777,6 +1050,11 @@ void pytheia_sfm_classes(py::module& m) {
       .def_readwrite(
           "assume_known_orientation",
           &theia::LocalizeViewToReconstructionOptions::assume_known_orientation)
+      .def_readwrite("pnp_type",
+                     &theia::LocalizeViewToReconstructionOptions::pnp_type)
+      .def_readwrite(
+          "use_gravity_prior",
+          &theia::LocalizeViewToReconstructionOptions::use_gravity_prior)
       .def_readwrite("ransac_params",
                      &theia::LocalizeViewToReconstructionOptions::ransac_params)
       .def_readwrite(
@@ -788,24 +1066,111 @@ void pytheia_sfm_classes(py::module& m) {
           "min_num_inliers",
           &theia::LocalizeViewToReconstructionOptions::min_num_inliers);
 
-  m.def("EstimateTwoViewInfo", theia::EstimateTwoViewInfoWrapper);
-  m.def("ColorizeReconstruction", theia::ColorizeReconstruction);
+  py::class_<theia::LocalizationIndexOptions>(m, "LocalizationIndexOptions")
+      .def(py::init<>())
+      .def_readwrite("num_kd_trees",
+                     &theia::LocalizationIndexOptions::num_kd_trees)
+      .def_readwrite("num_kd_tree_checks",
+                     &theia::LocalizationIndexOptions::num_kd_tree_checks)
+      .def_readwrite("lowes_ratio",
+                     &theia::LocalizationIndexOptions::lowes_ratio)
+      .def_readwrite("num_candidate_views",
+                     &theia::LocalizationIndexOptions::num_candidate_views)
+      .def_readwrite("num_threads",
+                     &theia::LocalizationIndexOptions::num_threads)
+      .def_readwrite("localization_options",
+                     &theia::LocalizationIndexOptions::localization_options);
+
+  py::class_<theia::LocalizationSummary>(m, "LocalizationSummary")
+      .def(py::init<>())
+      .def_readwrite("candidate_view_ids",
+                     &theia::LocalizationSummary::candidate_view_ids)
+      .def_readwrite("matches", &theia::LocalizationSummary::matches)
+      .def_readwrite("ransac_summary",
+                     &theia::LocalizationSummary::ransac_summary);
+
+  py::class_<theia::LocalizationIndex>(m, "LocalizationIndex")
+      .def(py::init<theia::LocalizationIndexOptions>())
+      .def("Build",
+           &theia::LocalizationIndex::Build,
+           py::call_guard<py::gil_scoped_release>())
+      .def("Localize",
+           [](const theia::LocalizationIndex& index,
+              const theia::KeypointsAndDescriptors& features,
+              const theia::Camera& camera) {
+             theia::Camera localized_camera(camera);
+             theia::LocalizationSummary summary;
+             const bool success =
+                 index.Localize(features, &localized_camera, &summary);
+             return std::make_tuple(success, localized_camera, summary);
+           },
+           py::call_guard<py::gil_scoped_release>())
+      .def("ReadFromDisk", &theia::LocalizationIndex::ReadFromDisk)
+      .def("WriteToDisk", &theia::LocalizationIndex::WriteToDisk)
+      .def("NumTracks", &theia::LocalizationIndex::NumTracks)
+      .def("NumViews", &theia::LocalizationIndex::NumViews);
+
+  m.def("EstimateTwoViewInfo",
+        theia::EstimateTwoViewInfoWrapper,
+        py::call_guard<py::gil_scoped_release>());
+  m.def("EstimateTwoViewInfos",
+        theia::EstimateTwoViewInfosWrapper,
+        py::call_guard<py::gil_scoped_release>());
+  m.def("ColorizeReconstruction",
+        overload_cast_<const std::string&, const int, theia::Reconstruction*>()(
+            &theia::ColorizeReconstruction),
+        py::call_guard<py::gil_scoped_release>());
+  m.def("ColorizeReconstruction",
+        overload_cast_<const std::string&,
+                       const int,
+                       const int,
+                       theia::Reconstruction*>()(
+            &theia::ColorizeReconstruction),
+        py::call_guard<py::gil_scoped_release>());
   m.def("ExtractMaximallyParallelRigidSubgraph",
-        theia::ExtractMaximallyParallelRigidSubgraph);
+        overload_cast_<const std::unordered_map<theia::ViewId,
+                                                Eigen::Vector3d>&,
+                       theia::ViewGraph*>()(
+            &theia::ExtractMaximallyParallelRigidSubgraph));
+  m.def("ExtractMaximallyParallelRigidSubgraph",
+        overload_cast_<const std::unordered_map<theia::ViewId,
+                                                Eigen::Vector3d>&,
+                       const int,
+                       theia::ViewGraph*>()(
+            &theia::ExtractMaximallyParallelRigidSubgraph),
+        py::call_guard<py::gil_scoped_release>());
+  m.def("FilterViewGraphCyclesByRotation",
+        overload_cast_<const double, theia::ViewGraph*>()(
+            &theia::FilterViewGraphCyclesByRotation));
   m.def("FilterViewGraphCyclesByRotation",
-        theia::FilterViewGraphCyclesByRotation);
+        overload_cast_<const double, const int, theia::ViewGraph*>()(
+            &theia::FilterViewGraphCyclesByRotation));
   m.def("FilterViewPairsFromOrientation",
-        theia::FilterViewPairsFromOrientation);
+        overload_cast_<const std::unordered_map<theia::ViewId,
+                                                Eigen::Vector3d>&,
+                       const double,
+                       theia::ViewGraph*>()(
+            &theia::FilterViewPairsFromOrientation));
+  m.def("FilterViewPairsFromOrientation",
+        overload_cast_<const std::unordered_map<theia::ViewId,
+                                                Eigen::Vector3d>&,
+                       const double,
+                       const int,
+                       theia::ViewGraph*>()(
+            &theia::FilterViewPairsFromOrientation));
   m.def("FilterViewPairsFromRelativeTranslation",
         theia::FilterViewPairsFromRelativeTranslation);
   m.def("LocalizeViewToReconstruction",
-        theia::LocalizeViewToReconstruction);
+        theia::LocalizeViewToReconstruction,
+        py::call_guard<py::gil_scoped_release>());
   m.def("SelectGoodTracksForBundleAdjustment",
-        theia::SelectGoodTracksForBundleAdjustmentWrapper);
+        theia::SelectGoodTracksForBundleAdjustmentWrapper,
+        py::call_guard<py::gil_scoped_release>());
   m.def("SetOutlierTracksToUnestimated",
         theia::SetOutlierTracksToUnestimatedWrapper);
   m.def("SetCameraIntrinsicsFromPriors",
         theia::SetCameraIntrinsicsFromPriors);
+  m.def("SetPositionPriorsFromGPS", theia::SetPositionPriorsFromGPS);
   // m.def("UndistortImage", theia::UndistortImageWrapper);
   // m.def("UndistortCamera", theia::UndistortCameraWrapper);
   // m.def("UndistortReconstruction", theia::UndistortReconstructionWrapper);
@@ -815,6 +1180,16 @@ void pytheia_sfm_classes(py::module& m) {
 
   m.def("RemoveDisconnectedViewPairs", theia::RemoveDisconnectedViewPairs);
 
+  py::class_<theia::SparsifyViewGraphOptions>(m, "SparsifyViewGraphOptions")
+      .def(py::init<>())
+      .def_readwrite("num_edges_per_view",
+                     &theia::SparsifyViewGraphOptions::num_edges_per_view)
+      .def_readwrite("use_visibility_score",
+                     &theia::SparsifyViewGraphOptions::use_visibility_score)
+      .def_readwrite("num_threads",
+                     &theia::SparsifyViewGraphOptions::num_threads);
+  m.def("SparsifyViewGraph", theia::SparsifyViewGraph);
+
   // View class
   py::class_<theia::View>(m, "View")
       .def(py::init<>())
@@ -868,6 +1243,18 @@ void pytheia_sfm_classes(py::module& m) {
       .def_readwrite("min_num_inlier_matches",
                      &theia::TwoViewMatchGeometricVerification::Options::
                          min_num_inlier_matches)
+      .def_readwrite(
+          "pre_verification",
+          &theia::TwoViewMatchGeometricVerification::Options::pre_verification)
+      .def_readwrite("pre_verification_max_num_samples",
+                     &theia::TwoViewMatchGeometricVerification::Options::
+                         pre_verification_max_num_samples)
+      .def_readwrite("pre_verification_max_sampson_error_pixels",
+                     &theia::TwoViewMatchGeometricVerification::Options::
+                         pre_verification_max_sampson_error_pixels)
+      .def_readwrite("pre_verification_sprt_sigma",
+                     &theia::TwoViewMatchGeometricVerification::Options::
+                         pre_verification_sprt_sigma)
       .def_readwrite(
           "guided_matching",
           &theia::TwoViewMatchGeometricVerification::Options::guided_matching)
@@ -889,6 +1276,9 @@ void pytheia_sfm_classes(py::module& m) {
       .def_readwrite("final_max_reprojection_error",
                      &theia::TwoViewMatchGeometricVerification::Options::
                          final_max_reprojection_error)
+      .def_readwrite("refine_relative_pose",
+                     &theia::TwoViewMatchGeometricVerification::Options::
+                         refine_relative_pose)
 
       ;
 
@@ -914,7 +1304,8 @@ void pytheia_sfm_classes(py::module& m) {
                     theia::KeypointsAndDescriptors,
                     std::vector<theia::IndexedFeatureMatch>>())
       .def("VerifyMatches",
-           &theia::TwoViewMatchGeometricVerification::VerifyMatches);
+           &theia::TwoViewMatchGeometricVerification::VerifyMatches,
+           py::call_guard<py::gil_scoped_release>());
 
   // Track class
   py::class_<theia::Track>(m, "Track")
@@ -924,7 +1315,10 @@ void pytheia_sfm_classes(py::module& m) {
       .def("NumViews", &theia::Track::NumViews)
       .def("AddView", &theia::Track::AddView)
       .def("RemoveView", &theia::Track::RemoveView)
-      .def("ViewIds", &theia::Track::ViewIds)
+      .def("ViewIds",
+           [](const theia::Track& track) {
+             return std::unordered_set<theia::ViewId>(track.ViewIds());
+           })
       .def("Point", &theia::Track::Point)
       .def("SetPoint", &theia::Track::SetPoint)
       .def("Color", &theia::Track::Color)
@@ -943,12 +1337,86 @@ void pytheia_sfm_classes(py::module& m) {
       .def("AddFeatureCorrespondence",
            &theia::TrackBuilder::AddFeatureCorrespondence)
       .def("BuildTracks", 
-           &theia::TrackBuilder::BuildTracks)
+           &theia::TrackBuilder::BuildTracks,
+           py::call_guard<py::gil_scoped_release>())
       .def("BuildTracksIncremental", 
-           &theia::TrackBuilder::BuildTracksIncremental);
+           &theia::TrackBuilder::BuildTracksIncremental,
+           py::call_guard<py::gil_scoped_release>());
+
+  py::class_<theia::ParallelTrackBuilder>(m, "ParallelTrackBuilder")
+      .def(py::init<int, int, int>())
+      .def("BuildTracks",
+           [](theia::ParallelTrackBuilder& self,
+              theia::FeaturesAndMatchesDatabase* database,
+              theia::Reconstruction* reconstruction) {
+             return self.BuildTracks(database, reconstruction);
+           },
+           py::call_guard<py::gil_scoped_release>());
+
+  py::enum_<theia::BundleAdjustmentBackend>(m, "BundleAdjustmentBackend")
+      .value("CPU", theia::BundleAdjustmentBackend::CPU)
+      .value("CUDA", theia::BundleAdjustmentBackend::CUDA)
+      .export_values();
+
+  py::class_<theia::LinearSolverSelectionOptions>(
+      m, "LinearSolverSelectionOptions")
+      .def(py::init<>())
+      .def_readwrite("max_blocks_for_small_dense_schur",
+                     &theia::LinearSolverSelectionOptions::max_blocks_for_small_dense_schur)
+      .def_readwrite("max_blocks_for_dense_schur",
+                     &theia::LinearSolverSelectionOptions::max_blocks_for_dense_schur)
+      .def_readwrite("min_density_for_dense_schur",
+                     &theia::LinearSolverSelectionOptions::min_density_for_dense_schur)
+      .def_readwrite("min_blocks_for_iterative_schur",
+                     &theia::LinearSolverSelectionOptions::min_blocks_for_iterative_schur)
+      .def_readwrite("max_nonzero_blocks_for_sparse_schur",
+                     &theia::LinearSolverSelectionOptions::max_nonzero_blocks_for_sparse_schur)
+      .def_readwrite("min_mean_covisibility_for_cluster_jacobi",
+                     &theia::LinearSolverSelectionOptions::min_mean_covisibility_for_cluster_jacobi)
+      .def_readwrite("max_cameras_for_cluster_jacobi",
+                     &theia::LinearSolverSelectionOptions::max_cameras_for_cluster_jacobi)
+      .def_readwrite("min_cameras_for_jacobi",
+                     &theia::LinearSolverSelectionOptions::min_cameras_for_jacobi);
+
+  py::class_<theia::BundleAdjustmentProblemStructure>(
+      m, "BundleAdjustmentProblemStructure")
+      .def(py::init<>())
+      .def_readwrite("num_cameras",
+                     &theia::BundleAdjustmentProblemStructure::num_cameras)
+      .def_readwrite("num_camera_intrinsics_groups",
+                     &theia::BundleAdjustmentProblemStructure::num_camera_intrinsics_groups)
+      .def_readwrite("num_points",
+                     &theia::BundleAdjustmentProblemStructure::num_points)
+      .def_readwrite("num_covisible_camera_pairs",
+                     &theia::BundleAdjustmentProblemStructure::num_covisible_camera_pairs);
+
+  py::class_<theia::BundleAdjustmentIterationSummary>(
+      m, "BundleAdjustmentIterationSummary")
+      .def(py::init<>())
+      .def_readwrite("iteration",
+                     &theia::BundleAdjustmentIterationSummary::iteration)
+      .def_readwrite("step_is_successful",
+                     &theia::BundleAdjustmentIterationSummary::step_is_successful)
+      .def_readwrite("cost",
+                     &theia::BundleAdjustmentIterationSummary::cost)
+      .def_readwrite("cost_change",
+                     &theia::BundleAdjustmentIterationSummary::cost_change)
+      .def_readwrite("gradient_max_norm",
+                     &theia::BundleAdjustmentIterationSummary::gradient_max_norm)
+      .def_readwrite("step_norm",
+                     &theia::BundleAdjustmentIterationSummary::step_norm)
+      .def_readwrite("trust_region_radius",
+                     &theia::BundleAdjustmentIterationSummary::trust_region_radius)
+      .def_readwrite("linear_solver_iterations",
+                     &theia::BundleAdjustmentIterationSummary::linear_solver_iterations)
+      .def_readwrite("iteration_time_in_seconds",
+                     &theia::BundleAdjustmentIterationSummary::iteration_time_in_seconds)
+      .def_readwrite("cumulative_time_in_seconds",
+                     &theia::BundleAdjustmentIterationSummary::cumulative_time_in_seconds);
 
   py::class_<theia::BundleAdjustmentOptions>(m, "BundleAdjustmentOptions")
       .def(py::init<>())
+      .def_readwrite("backend", &theia::BundleAdjustmentOptions::backend)
       .def_readwrite("loss_function_type",
                      &theia::BundleAdjustmentOptions::loss_function_type)
       .def_readwrite("robust_loss_width",
@@ -985,7 +1453,37 @@ void pytheia_sfm_classes(py::module& m) {
       .def_readwrite("orthographic_camera",
                      &theia::BundleAdjustmentOptions::orthographic_camera)
       .def_readwrite("use_homogeneous_point_parametrization",
-                     &theia::BundleAdjustmentOptions::use_homogeneous_point_parametrization);
+                     &theia::BundleAdjustmentOptions::use_homogeneous_point_parametrization)
+      .def_readwrite("use_analytic_reprojection_jacobians",
+                     &theia::BundleAdjustmentOptions::use_analytic_reprojection_jacobians)
+      .def_readwrite("use_mixed_precision",
+                     &theia::BundleAdjustmentOptions::use_mixed_precision)
+      .def_readwrite("numa_aware", &theia::BundleAdjustmentOptions::numa_aware)
+      .def_readwrite("use_marginal_covariance_estimation",
+                     &theia::BundleAdjustmentOptions::use_marginal_covariance_estimation)
+      .def_readwrite("covariance_max_memory_in_bytes",
+                     &theia::BundleAdjustmentOptions::covariance_max_memory_in_bytes)
+      .def_readwrite("refine_tracks_independently",
+                     &theia::BundleAdjustmentOptions::refine_tracks_independently)
+      .def_readwrite("max_num_optimized_observations_per_track",
+                     &theia::BundleAdjustmentOptions::
+                         max_num_optimized_observations_per_track)
+      .def_readwrite("min_num_optimized_observations_per_view",
+                     &theia::BundleAdjustmentOptions::
+                         min_num_optimized_observations_per_view)
+      .def_readwrite("iteration_callback",
+                     &theia::BundleAdjustmentOptions::iteration_callback)
+      .def_readwrite("select_linear_solver_automatically",
+                     &theia::BundleAdjustmentOptions::
+                         select_linear_solver_automatically)
+      .def_readwrite("linear_solver_selection_options",
+                     &theia::BundleAdjustmentOptions::
+                         linear_solver_selection_options)
+      .def_readwrite("use_camera_rigs",
+                     &theia::BundleAdjustmentOptions::use_camera_rigs)
+      .def_readwrite("optimize_camera_rig_extrinsics",
+                     &theia::BundleAdjustmentOptions::
+                         optimize_camera_rig_extrinsics);
 
   // Reconstruction Options
   py::enum_<theia::TriangulationMethodType>(m, "TriangulationMethodType")
@@ -1010,7 +1508,9 @@ void pytheia_sfm_classes(py::module& m) {
       .def_readwrite("multithreaded_step_size",
                      &theia::TrackEstimator::Options::multithreaded_step_size)
       .def_readwrite("triangulation_method",
-        &theia::TrackEstimator::Options::triangulation_method);
+        &theia::TrackEstimator::Options::triangulation_method)
+      .def_readwrite("joint_bundle_adjustment",
+                     &theia::TrackEstimator::Options::joint_bundle_adjustment);
 
   // Track Estimator Summary
   py::class_<theia::TrackEstimator::Summary>(m, "TrackEstimatorSummary")
@@ -1025,9 +1525,15 @@ void pytheia_sfm_classes(py::module& m) {
 
   // Track Estimator class
   py::class_<theia::TrackEstimator>(m, "TrackEstimator")
-      .def(py::init<const theia::TrackEstimator::Options&, theia::Reconstruction*>())
-      .def("EstimateAllTracks", &theia::TrackEstimator::EstimateAllTracks)
-      .def("EstimateTracks", &theia::TrackEstimator::EstimateTracks);
+      .def(py::init<const theia::TrackEstimator::Options&,
+                    theia::Reconstruction*>(),
+           py::keep_alive<1, 3>())
+      .def("EstimateAllTracks",
+           &theia::TrackEstimator::EstimateAllTracks,
+           py::call_guard<py::gil_scoped_release>())
+      .def("EstimateTracks",
+           &theia::TrackEstimator::EstimateTracks,
+           py::call_guard<py::gil_scoped_release>());
 
   // ReconstructionEstimatorSummary
   py::class_<theia::ReconstructionEstimatorSummary>(
@@ -1063,20 +1569,29 @@ void pytheia_sfm_classes(py::module& m) {
   py::class_<theia::GlobalReconstructionEstimator,
              theia::ReconstructionEstimator>(m, "GlobalReconstructionEstimator")
       .def(py::init<theia::ReconstructionEstimatorOptions>())
-      .def("Estimate", &theia::GlobalReconstructionEstimator::Estimate);
+      .def("Estimate",
+           &theia::GlobalReconstructionEstimator::Estimate,
+           py::call_guard<py::gil_scoped_release>())
+      .def("EstimateNewViews",
+           &theia::GlobalReconstructionEstimator::EstimateNewViews,
+           py::call_guard<py::gil_scoped_release>());
 
   // not sure about pointer  IncrementalReconstructionEstimator
   py::class_<theia::IncrementalReconstructionEstimator,
              theia::ReconstructionEstimator>(
       m, "IncrementalReconstructionEstimator")
       .def(py::init<theia::ReconstructionEstimatorOptions>())
-      .def("Estimate", &theia::IncrementalReconstructionEstimator::Estimate);
+      .def("Estimate",
+           &theia::IncrementalReconstructionEstimator::Estimate,
+           py::call_guard<py::gil_scoped_release>());
 
   // not sure about pointer  HybridReconstructionEstimator
   py::class_<theia::HybridReconstructionEstimator,
              theia::ReconstructionEstimator>(m, "HybridReconstructionEstimator")
       .def(py::init<theia::ReconstructionEstimatorOptions>())
-      .def("Estimate", &theia::HybridReconstructionEstimator::Estimate);
+      .def("Estimate",
+           &theia::HybridReconstructionEstimator::Estimate,
+           py::call_guard<py::gil_scoped_release>());
 
   // Reconstruction Builder Options
   py::class_<theia::ReconstructionBuilderOptions>(
@@ -1088,6 +1603,8 @@ void pytheia_sfm_classes(py::module& m) {
       .def_readwrite(
           "only_calibrated_views",
           &theia::ReconstructionBuilderOptions::only_calibrated_views)
+      .def_readwrite("deterministic",
+                     &theia::ReconstructionBuilderOptions::deterministic)
       .def_readwrite("min_track_length",
                      &theia::ReconstructionBuilderOptions::min_track_length)
       .def_readwrite("max_track_length",
@@ -1099,6 +1616,9 @@ void pytheia_sfm_classes(py::module& m) {
                      &theia::ReconstructionBuilderOptions::descriptor_type)
       .def_readwrite("feature_density",
                      &theia::ReconstructionBuilderOptions::feature_density)
+      .def_readwrite(
+          "quantize_descriptors",
+          &theia::ReconstructionBuilderOptions::quantize_descriptors)
       .def_readwrite("matching_strategy",
                      &theia::ReconstructionBuilderOptions::matching_strategy)
       .def_readwrite("matching_options",
@@ -1123,6 +1643,54 @@ void pytheia_sfm_classes(py::module& m) {
       .def_readwrite("max_num_features_for_fisher_vector_training",
                      &theia::ReconstructionBuilderOptions::
                          max_num_features_for_fisher_vector_training)
+      .def_readwrite("global_descriptor_pca_dimension",
+                     &theia::ReconstructionBuilderOptions::
+                         global_descriptor_pca_dimension)
+      .def_readwrite("global_descriptor_extractor_type",
+                     &theia::ReconstructionBuilderOptions::
+                         global_descriptor_extractor_type)
+      .def_readwrite("vocabulary_tree_branching_factor",
+                     &theia::ReconstructionBuilderOptions::
+                         vocabulary_tree_branching_factor)
+      .def_readwrite("vocabulary_tree_depth",
+                     &theia::ReconstructionBuilderOptions::vocabulary_tree_depth)
+      .def_readwrite("max_num_features_for_vocabulary_tree_training",
+                     &theia::ReconstructionBuilderOptions::
+                         max_num_features_for_vocabulary_tree_training)
+      .def_readwrite("rerank_retrieved_image_pairs",
+                     &theia::ReconstructionBuilderOptions::
+                         rerank_retrieved_image_pairs)
+      .def_readwrite("spatial_reranking_options",
+                     &theia::ReconstructionBuilderOptions::
+                         spatial_reranking_options)
+      .def_readwrite("select_image_pairs_sequentially",
+                     &theia::ReconstructionBuilderOptions::
+                         select_image_pairs_sequentially)
+      .def_readwrite("sequential_pair_selector_options",
+                     &theia::ReconstructionBuilderOptions::
+                         sequential_pair_selector_options)
+      .def_readwrite("select_image_pairs_with_position_priors",
+                     &theia::ReconstructionBuilderOptions::
+                         select_image_pairs_with_position_priors)
+      .def_readwrite("spatial_pair_selection_options",
+                     &theia::ReconstructionBuilderOptions::
+                         spatial_pair_selection_options)
+      .def_readwrite("intersect_spatial_pairs_with_retrieval",
+                     &theia::ReconstructionBuilderOptions::
+                         intersect_spatial_pairs_with_retrieval)
+      .def_readwrite("checkpoint_directory",
+                     &theia::ReconstructionBuilderOptions::checkpoint_directory)
+      .def_readwrite("restart_stage",
+                     &theia::ReconstructionBuilderOptions::restart_stage)
+      .def_readwrite("stop_stage",
+                     &theia::ReconstructionBuilderOptions::stop_stage)
+      .def_readwrite("match_features",
+                     &theia::ReconstructionBuilderOptions::match_features)
+      .def_readwrite("metrics_output_file",
+                     &theia::ReconstructionBuilderOptions::metrics_output_file)
+      .def_readwrite("metrics_export_interval_in_seconds",
+                     &theia::ReconstructionBuilderOptions::
+                         metrics_export_interval_in_seconds)
       .def_readwrite("reconstruction_estimator_options",
                      &theia::ReconstructionBuilderOptions::
                          reconstruction_estimator_options);
@@ -1131,7 +1699,8 @@ void pytheia_sfm_classes(py::module& m) {
   py::class_<theia::ReconstructionBuilder>(m, "ReconstructionBuilder")
       //.def(py::init<>())
       .def(py::init<theia::ReconstructionBuilderOptions,
-                    theia::FeaturesAndMatchesDatabase*>())
+                    theia::FeaturesAndMatchesDatabase*>(),
+           py::keep_alive<1, 3>())
       .def("AddImage",
            (bool (theia::ReconstructionBuilder::*)(const std::string&,
                                                    const double)) &
@@ -1154,19 +1723,127 @@ void pytheia_sfm_classes(py::module& m) {
                const double)) &
                theia::ReconstructionBuilder::AddImageWithCameraIntrinsicsPrior)
       //.def("AddTwoViewMatch", &theia::ReconstructionBuilder::AddTwoViewMatch)
+      .def("AddTwoViewMatchesFromFile",
+           &theia::ReconstructionBuilder::AddTwoViewMatchesFromFile)
+      .def("SetImagePositionPrior",
+           &theia::ReconstructionBuilder::SetImagePositionPrior)
       .def("AddMaskForFeaturesExtraction",
            &theia::ReconstructionBuilder::AddMaskForFeaturesExtraction)
       .def("ExtractAndMatchFeatures",
-           &theia::ReconstructionBuilder::ExtractAndMatchFeatures)
+           &theia::ReconstructionBuilder::ExtractAndMatchFeatures,
+           py::call_guard<py::gil_scoped_release>())
+      .def("BuildReconstruction",
+           [](theia::ReconstructionBuilder& builder) {
+             std::vector<theia::Reconstruction*> reconstructions;
+             const bool success = builder.BuildReconstruction(&reconstructions);
+             std::vector<theia::Reconstruction> output;
+             output.reserve(reconstructions.size());
+             for (theia::Reconstruction* reconstruction : reconstructions) {
+               output.emplace_back(*reconstruction);
+               delete reconstruction;
+             }
+             return std::make_tuple(success, output);
+           },
+           py::call_guard<py::gil_scoped_release>())
 
       ;
 
+  // Online Reconstruction Builder Options
+  py::class_<theia::OnlineReconstructionBuilderOptions>(
+      m, "OnlineReconstructionBuilderOptions")
+      .def(py::init<>())
+      .def_readwrite("num_threads",
+                     &theia::OnlineReconstructionBuilderOptions::num_threads)
+      .def_readwrite("queue_capacity",
+                     &theia::OnlineReconstructionBuilderOptions::queue_capacity)
+      .def_readwrite(
+          "min_track_length",
+          &theia::OnlineReconstructionBuilderOptions::min_track_length)
+      .def_readwrite(
+          "max_track_length",
+          &theia::OnlineReconstructionBuilderOptions::max_track_length)
+      .def_readwrite(
+          "min_num_inlier_matches",
+          &theia::OnlineReconstructionBuilderOptions::min_num_inlier_matches)
+      .def_readwrite(
+          "matching_strategy",
+          &theia::OnlineReconstructionBuilderOptions::matching_strategy)
+      .def_readwrite(
+          "matching_options",
+          &theia::OnlineReconstructionBuilderOptions::matching_options)
+      .def_readwrite("num_sequential_images_to_match",
+                     &theia::OnlineReconstructionBuilderOptions::
+                         num_sequential_images_to_match)
+      .def_readwrite("num_retrieved_images_to_match",
+                     &theia::OnlineReconstructionBuilderOptions::
+                         num_retrieved_images_to_match)
+      .def_readwrite("max_num_localization_attempts",
+                     &theia::OnlineReconstructionBuilderOptions::
+                         max_num_localization_attempts)
+      .def_readwrite("full_bundle_adjustment_interval",
+                     &theia::OnlineReconstructionBuilderOptions::
+                         full_bundle_adjustment_interval)
+      .def_readwrite("reconstruction_estimator_options",
+                     &theia::OnlineReconstructionBuilderOptions::
+                         reconstruction_estimator_options);
+
+  // Online Reconstruction Builder
+  py::class_<theia::OnlineReconstructionBuilder>(m,
+                                                 "OnlineReconstructionBuilder")
+      .def(py::init<theia::OnlineReconstructionBuilderOptions,
+                    theia::FeaturesAndMatchesDatabase*>(),
+           py::keep_alive<1, 3>())
+      .def("AddImage",
+           (bool (theia::OnlineReconstructionBuilder::*)(
+               const std::string&,
+               const double,
+               const theia::CameraIntrinsicsPrior&,
+               const theia::KeypointsAndDescriptors&)) &
+               theia::OnlineReconstructionBuilder::AddImage,
+           py::call_guard<py::gil_scoped_release>())
+      .def("AddImage",
+           (bool (theia::OnlineReconstructionBuilder::*)(
+               const std::string&,
+               const double,
+               const theia::CameraIntrinsicsPrior&,
+               const unsigned int,
+               const theia::KeypointsAndDescriptors&)) &
+               theia::OnlineReconstructionBuilder::AddImage,
+           py::call_guard<py::gil_scoped_release>())
+      .def("WaitUntilIdle",
+           &theia::OnlineReconstructionBuilder::WaitUntilIdle,
+           py::call_guard<py::gil_scoped_release>())
+      .def("Stop",
+           &theia::OnlineReconstructionBuilder::Stop,
+           py::call_guard<py::gil_scoped_release>())
+      .def("GetSnapshot",
+           [](const theia::OnlineReconstructionBuilder& builder) {
+             theia::Reconstruction reconstruction;
+             builder.GetSnapshot(&reconstruction);
+             return reconstruction;
+           })
+      .def("NumViews", &theia::OnlineReconstructionBuilder::NumViews)
+      .def("NumEstimatedViews",
+           &theia::OnlineReconstructionBuilder::NumEstimatedViews);
+
   // Reconstruction Options
+  py::enum_<theia::ReconstructionCheckpointStage>(
+      m, "ReconstructionCheckpointStage")
+      .value("NONE", theia::ReconstructionCheckpointStage::NONE)
+      .value("TRACKS_BUILT", theia::ReconstructionCheckpointStage::TRACKS_BUILT)
+      .value("ROTATIONS_ESTIMATED",
+             theia::ReconstructionCheckpointStage::ROTATIONS_ESTIMATED)
+      .value("POSITIONS_ESTIMATED",
+             theia::ReconstructionCheckpointStage::POSITIONS_ESTIMATED)
+      .value("FINISHED", theia::ReconstructionCheckpointStage::FINISHED)
+      .export_values();
+
   py::enum_<theia::ReconstructionEstimatorType>(m,
                                                 "ReconstructionEstimatorType")
       .value("GLOBAL", theia::ReconstructionEstimatorType::GLOBAL)
       .value("INCREMENTAL", theia::ReconstructionEstimatorType::INCREMENTAL)
       .value("HYBRID", theia::ReconstructionEstimatorType::HYBRID)
+      .value("HIERARCHICAL", theia::ReconstructionEstimatorType::HIERARCHICAL)
       .export_values();
 
   py::enum_<theia::GlobalPositionEstimatorType>(m,
@@ -1205,12 +1882,22 @@ void pytheia_sfm_classes(py::module& m) {
                          global_rotation_estimator_type)
       .def_readwrite("num_threads",
                      &theia::ReconstructionEstimatorOptions::num_threads)
+      .def_readwrite("deterministic",
+                     &theia::ReconstructionEstimatorOptions::deterministic)
+      .def_readwrite("numa_aware",
+                     &theia::ReconstructionEstimatorOptions::numa_aware)
       .def_readwrite("max_reprojection_error_in_pixels",
                      &theia::ReconstructionEstimatorOptions::
                          max_reprojection_error_in_pixels)
       .def_readwrite(
           "min_num_two_view_inliers",
           &theia::ReconstructionEstimatorOptions::min_num_two_view_inliers)
+      .def_readwrite("view_graph_sparsification_num_edges_per_view",
+                     &theia::ReconstructionEstimatorOptions::
+                         view_graph_sparsification_num_edges_per_view)
+      .def_readwrite("view_graph_sparsification_use_visibility_score",
+                     &theia::ReconstructionEstimatorOptions::
+                         view_graph_sparsification_use_visibility_score)
       .def_readwrite("ransac_confidence",
                      &theia::ReconstructionEstimatorOptions::ransac_confidence)
       .def_readwrite(
@@ -1255,6 +1942,9 @@ void pytheia_sfm_classes(py::module& m) {
           "refine_camera_positions_and_points_after_position_estimation",
           &theia::ReconstructionEstimatorOptions::
               refine_camera_positions_and_points_after_position_estimation)
+      .def_readwrite("incremental_global_update_neighborhood_size",
+                     &theia::ReconstructionEstimatorOptions::
+                         incremental_global_update_neighborhood_size)
       .def_readwrite("multiple_view_localization_ratio",
                      &theia::ReconstructionEstimatorOptions::
                          multiple_view_localization_ratio)
@@ -1264,15 +1954,41 @@ void pytheia_sfm_classes(py::module& m) {
       .def_readwrite(
           "min_num_absolute_pose_inliers",
           &theia::ReconstructionEstimatorOptions::min_num_absolute_pose_inliers)
+      .def_readwrite(
+          "absolute_pose_pnp_type",
+          &theia::ReconstructionEstimatorOptions::absolute_pose_pnp_type)
+      .def_readwrite(
+          "localize_with_gravity_priors",
+          &theia::ReconstructionEstimatorOptions::localize_with_gravity_priors)
       .def_readwrite("full_bundle_adjustment_growth_percent",
                      &theia::ReconstructionEstimatorOptions::
                          full_bundle_adjustment_growth_percent)
+      .def_readwrite("full_bundle_adjustment_drift_ratio",
+                     &theia::ReconstructionEstimatorOptions::
+                         full_bundle_adjustment_drift_ratio)
       .def_readwrite("partial_bundle_adjustment_num_views",
                      &theia::ReconstructionEstimatorOptions::
                          partial_bundle_adjustment_num_views)
+      .def_readwrite("use_camera_rigs",
+                     &theia::ReconstructionEstimatorOptions::use_camera_rigs)
+      .def_readwrite("optimize_camera_rig_extrinsics",
+                     &theia::ReconstructionEstimatorOptions::
+                         optimize_camera_rig_extrinsics)
       .def_readwrite("relative_position_estimation_max_sampson_error_pixels",
                      &theia::ReconstructionEstimatorOptions::
                          relative_position_estimation_max_sampson_error_pixels)
+      .def_readwrite("hierarchical_max_views_per_cluster",
+                     &theia::ReconstructionEstimatorOptions::
+                         hierarchical_max_views_per_cluster)
+      .def_readwrite("hierarchical_num_overlapping_views",
+                     &theia::ReconstructionEstimatorOptions::
+                         hierarchical_num_overlapping_views)
+      .def_readwrite("hierarchical_cluster_estimator_type",
+                     &theia::ReconstructionEstimatorOptions::
+                         hierarchical_cluster_estimator_type)
+      .def_readwrite("hierarchical_alignment_relative_error_threshold",
+                     &theia::ReconstructionEstimatorOptions::
+                         hierarchical_alignment_relative_error_threshold)
       .def_readwrite("min_triangulation_angle_degrees",
                      &theia::ReconstructionEstimatorOptions::
                          min_triangulation_angle_degrees)
@@ -1294,6 +2010,12 @@ void pytheia_sfm_classes(py::module& m) {
       .def_readwrite("min_cameras_for_iterative_solver",
                      &theia::ReconstructionEstimatorOptions::
                          min_cameras_for_iterative_solver)
+      .def_readwrite("bundle_adjustment_backend",
+                     &theia::ReconstructionEstimatorOptions::
+                         bundle_adjustment_backend)
+      .def_readwrite("select_bundle_adjustment_linear_solver_automatically",
+                     &theia::ReconstructionEstimatorOptions::
+                         select_bundle_adjustment_linear_solver_automatically)
       .def_readwrite(
           "intrinsics_to_optimize",
           &theia::ReconstructionEstimatorOptions::intrinsics_to_optimize)
@@ -1308,13 +2030,46 @@ void pytheia_sfm_classes(py::module& m) {
                          track_selection_image_grid_cell_size_pixels)
       .def_readwrite("min_num_optimized_tracks_per_view",
                      &theia::ReconstructionEstimatorOptions::
-                         min_num_optimized_tracks_per_view);
+                         min_num_optimized_tracks_per_view)
+      .def_readwrite("max_num_optimized_observations_per_track",
+                     &theia::ReconstructionEstimatorOptions::
+                         max_num_optimized_observations_per_track)
+      .def_readwrite("min_num_optimized_observations_per_view",
+                     &theia::ReconstructionEstimatorOptions::
+                         min_num_optimized_observations_per_view);
+
+  // Camera rigs
+  py::class_<theia::CameraRig>(m, "CameraRig")
+      .def(py::init<>())
+      .def("AddCamera", &theia::CameraRig::AddCamera)
+      .def("NumCameras", &theia::CameraRig::NumCameras)
+      .def("CameraPosition", &theia::CameraRig::CameraPosition)
+      .def("CameraOrientationAsAngleAxis",
+           &theia::CameraRig::CameraOrientationAsAngleAxis)
+      .def("SetCameraPosition", &theia::CameraRig::SetCameraPosition)
+      .def("SetCameraOrientationFromAngleAxis",
+           &theia::CameraRig::SetCameraOrientationFromAngleAxis);
+
+  py::class_<theia::CameraRigMembership>(m, "CameraRigMembership")
+      .def(py::init<>())
+      .def_readwrite("rig_id", &theia::CameraRigMembership::rig_id)
+      .def_readwrite("camera_index",
+                     &theia::CameraRigMembership::camera_index)
+      .def_readwrite("frame_id", &theia::CameraRigMembership::frame_id);
 
   // Reconstruction class
   py::class_<theia::Reconstruction>(m, "Reconstruction")
       .def(py::init<>())
       .def("NumViews", &theia::Reconstruction::NumViews)
       .def("ViewIdFromName", &theia::Reconstruction::ViewIdFromName)
+      .def("ViewIdFromTimestamp", &theia::Reconstruction::ViewIdFromTimestamp)
+      .def("ViewIdsSortedByTimestamp",
+           &theia::Reconstruction::ViewIdsSortedByTimestamp)
+      .def("ViewIdsInTimeRange", &theia::Reconstruction::ViewIdsInTimeRange)
+      .def("ViewIdNearestToTimestamp",
+           &theia::Reconstruction::ViewIdNearestToTimestamp)
+      .def("KNearestViewIdsToTimestamp",
+           &theia::Reconstruction::KNearestViewIdsToTimestamp)
       .def("AddView",
            (theia::ViewId(theia::Reconstruction::*)(const std::string&,
                                                     const double)) &
@@ -1356,7 +2111,11 @@ void pytheia_sfm_classes(py::module& m) {
       .def("AddObservation", &theia::Reconstruction::AddObservation)
       .def("NumCameraIntrinsicGroups",
                              &theia::Reconstruction::NumCameraIntrinsicGroups)
-      .def("Normalize", &theia::Reconstruction::Normalize)
+      .def("Normalize",
+           static_cast<void (theia::Reconstruction::*)(const int)>(
+               &theia::Reconstruction::Normalize),
+           py::arg("num_threads") = 1,
+           py::call_guard<py::gil_scoped_release>())
       .def("CameraIntrinsicsGroupIdFromViewId",
            &theia::Reconstruction::CameraIntrinsicsGroupIdFromViewId)
       .def("CameraIntrinsicsGroupIds",
@@ -1375,10 +2134,133 @@ void pytheia_sfm_classes(py::module& m) {
            py::return_value_policy::reference_internal)
       .def("GetViewsInCameraIntrinsicGroup",
            &theia::Reconstruction::GetViewsInCameraIntrinsicGroup)
+      .def("AddCameraRig", &theia::Reconstruction::AddCameraRig)
+      .def("NumCameraRigs", &theia::Reconstruction::NumCameraRigs)
+      .def("CameraRig",
+           &theia::Reconstruction::CameraRig,
+           py::return_value_policy::reference_internal)
+      .def("MutableCameraRig",
+           &theia::Reconstruction::MutableCameraRig,
+           py::return_value_policy::reference_internal)
+      .def("CameraRigIds", &theia::Reconstruction::CameraRigIds)
+      .def("AddViewToCameraRig", &theia::Reconstruction::AddViewToCameraRig)
+      .def("CameraRigMembershipFromViewId",
+           &theia::Reconstruction::CameraRigMembershipFromViewId,
+           py::return_value_policy::reference_internal)
+      .def("GetViewsInCameraRigFrame",
+           &theia::Reconstruction::GetViewsInCameraRigFrame)
+      // Pickled in the binary format of WriteReconstruction.
+      .def(py::pickle(
+          &GetPickleState<theia::Reconstruction,
+                          theia::WriteReconstructionToBuffer>,
+          &SetPickleState<theia::Reconstruction,
+                          theia::ReadReconstructionFromBuffer>))
+      .def("__reduce_ex__",
+           &ReduceEx<theia::Reconstruction, theia::WriteReconstructionToBuffer>)
       //.def("GetSubReconstruction",
       //&theia::Reconstruction::GetSubReconstructionWrapper)
       ;
 
+  // Bulk arrays of the reconstruction geometry. The members are returned as
+  // NumPy views of the arrays, so they may be modified in place and written
+  // back with SetViewArrays and SetTrackArrays.
+  py::class_<theia::ViewArrays>(m, "ViewArrays")
+      .def(py::init<>())
+      .def_readwrite("view_ids", &theia::ViewArrays::view_ids)
+      .def_readwrite("positions", &theia::ViewArrays::positions)
+      .def_readwrite("orientations", &theia::ViewArrays::orientations)
+      .def_readwrite("is_estimated", &theia::ViewArrays::is_estimated);
+
+  py::class_<theia::TrackArrays>(m, "TrackArrays")
+      .def(py::init<>())
+      .def_readwrite("track_ids", &theia::TrackArrays::track_ids)
+      .def_readwrite("points", &theia::TrackArrays::points)
+      .def_readwrite("colors", &theia::TrackArrays::colors)
+      .def_readwrite("is_estimated", &theia::TrackArrays::is_estimated);
+
+  py::class_<theia::ObservationArrays>(m, "ObservationArrays")
+      .def(py::init<>())
+      .def_readwrite("view_ids", &theia::ObservationArrays::view_ids)
+      .def_readwrite("track_ids", &theia::ObservationArrays::track_ids)
+      .def_readwrite("features", &theia::ObservationArrays::features);
+
+  m.def("GetViewArrays",
+        [](const theia::Reconstruction& reconstruction,
+           const int num_threads) {
+          theia::ViewArrays arrays;
+          theia::GetViewArrays(reconstruction, num_threads, &arrays);
+          return arrays;
+        },
+        py::arg("reconstruction"),
+        py::arg("num_threads") = 1,
+        py::call_guard<py::gil_scoped_release>());
+  m.def("GetTrackArrays",
+        [](const theia::Reconstruction& reconstruction,
+           const int num_threads) {
+          theia::TrackArrays arrays;
+          theia::GetTrackArrays(reconstruction, num_threads, &arrays);
+          return arrays;
+        },
+        py::arg("reconstruction"),
+        py::arg("num_threads") = 1,
+        py::call_guard<py::gil_scoped_release>());
+  m.def("GetObservationArrays",
+        [](const theia::Reconstruction& reconstruction,
+           const int num_threads) {
+          theia::ObservationArrays arrays;
+          theia::GetObservationArrays(reconstruction, num_threads, &arrays);
+          return arrays;
+        },
+        py::arg("reconstruction"),
+        py::arg("num_threads") = 1,
+        py::call_guard<py::gil_scoped_release>());
+  m.def("SetViewArrays",
+        [](const theia::ViewArrays& arrays,
+           theia::Reconstruction* reconstruction,
+           const int num_threads) {
+          return theia::SetViewArrays(arrays, num_threads, reconstruction);
+        },
+        py::arg("arrays"),
+        py::arg("reconstruction"),
+        py::arg("num_threads") = 1,
+        py::call_guard<py::gil_scoped_release>());
+  m.def("SetTrackArrays",
+        [](const theia::TrackArrays& arrays,
+           theia::Reconstruction* reconstruction,
+           const int num_threads) {
+          return theia::SetTrackArrays(arrays, num_threads, reconstruction);
+        },
+        py::arg("arrays"),
+        py::arg("reconstruction"),
+        py::arg("num_threads") = 1,
+        py::call_guard<py::gil_scoped_release>());
+
+  // SubReconstruction
+  py::class_<theia::SubReconstruction>(m, "SubReconstruction")
+      .def(py::init<theia::Reconstruction*,
+                    const std::unordered_set<theia::ViewId>&>(),
+           py::keep_alive<1, 2>())
+      .def("ViewIds", &theia::SubReconstruction::ViewIds)
+      .def("TrackIds", &theia::SubReconstruction::TrackIds)
+      .def("NumViews", &theia::SubReconstruction::NumViews)
+      .def("NumTracks", &theia::SubReconstruction::NumTracks)
+      .def("View",
+           &theia::SubReconstruction::View,
+           py::return_value_policy::reference_internal)
+      .def("MutableView",
+           &theia::SubReconstruction::MutableView,
+           py::return_value_policy::reference_internal)
+      .def("Track",
+           &theia::SubReconstruction::Track,
+           py::return_value_policy::reference_internal)
+      .def("MutableTrack",
+           &theia::SubReconstruction::MutableTrack,
+           py::return_value_policy::reference_internal)
+      .def("NumModifiedViews", &theia::SubReconstruction::NumModifiedViews)
+      .def("NumModifiedTracks", &theia::SubReconstruction::NumModifiedTracks)
+      .def("WriteBack", &theia::SubReconstruction::WriteBack)
+      .def("DiscardChanges", &theia::SubReconstruction::DiscardChanges);
+
   m.def("SetUnderconstrainedTracksToUnestimated", theia::SetUnderconstrainedTracksToUnestimated);
   m.def("SetUnderconstrainedViewsToUnestimated", theia::SetUnderconstrainedViewsToUnestimated);
 
@@ -1399,6 +2281,59 @@ void pytheia_sfm_classes(py::module& m) {
 
   m.def("SwapCameras", &theia::SwapCameras);
 
+  // Relative pose evaluation
+  m.def("RelativeRotationError", &theia::RelativeRotationError);
+  m.def("RelativeTranslationError", &theia::RelativeTranslationError);
+
+  py::class_<theia::RelativePoseEvaluatorOptions>(
+      m, "RelativePoseEvaluatorOptions")
+      .def(py::init<>())
+      .def_readwrite("num_threads",
+                     &theia::RelativePoseEvaluatorOptions::num_threads)
+      .def_readwrite("batch_size",
+                     &theia::RelativePoseEvaluatorOptions::batch_size)
+      .def_readwrite(
+          "rotation_histogram_bins",
+          &theia::RelativePoseEvaluatorOptions::rotation_histogram_bins)
+      .def_readwrite(
+          "translation_histogram_bins",
+          &theia::RelativePoseEvaluatorOptions::translation_histogram_bins);
+
+  // The errors are computed without the GIL so that other Python threads keep
+  // running during long evaluations.
+  py::class_<theia::RelativePoseEvaluator>(m, "RelativePoseEvaluator")
+      .def(py::init<const theia::RelativePoseEvaluatorOptions&,
+                    const theia::Reconstruction&>(),
+           py::keep_alive<1, 3>())
+      .def("AddRelativePoses",
+           &theia::RelativePoseEvaluator::AddRelativePoses,
+           py::call_guard<py::gil_scoped_release>())
+      .def("AddViewGraph",
+           &theia::RelativePoseEvaluator::AddViewGraph,
+           py::call_guard<py::gil_scoped_release>())
+      .def("AddMatches",
+           &theia::RelativePoseEvaluator::AddMatches,
+           py::call_guard<py::gil_scoped_release>())
+      .def("NumEvaluatedViewPairs",
+           &theia::RelativePoseEvaluator::NumEvaluatedViewPairs)
+      .def("NumSkippedViewPairs",
+           &theia::RelativePoseEvaluator::NumSkippedViewPairs)
+      .def("EvaluatedViewPairs",
+           &theia::RelativePoseEvaluator::EvaluatedViewPairs)
+      .def("RotationErrors", &theia::RelativePoseEvaluator::RotationErrors)
+      .def("TranslationErrors",
+           &theia::RelativePoseEvaluator::TranslationErrors)
+      .def("RotationHistogramCounts",
+           [](const theia::RelativePoseEvaluator& evaluator) {
+             return evaluator.RotationHistogram().Counts();
+           })
+      .def("TranslationHistogramCounts",
+           [](const theia::RelativePoseEvaluator& evaluator) {
+             return evaluator.TranslationHistogram().Counts();
+           })
+      .def("PrintMeanMedianHistogram",
+           &theia::RelativePoseEvaluator::PrintMeanMedianHistogram);
+
   // ViewGraph
   py::class_<theia::ViewGraph>(m, "ViewGraph")
       .def(py::init<>())
@@ -1419,6 +2354,14 @@ void pytheia_sfm_classes(py::module& m) {
            &theia::ViewGraph::GetEdge,
            py::return_value_policy::reference)
       .def("GetAllEdges", &theia::ViewGraph::GetAllEdges)
+      // Pickled in the columnar view graph format.
+      .def(py::pickle(
+          &GetPickleState<theia::ViewGraph,
+                          theia::WriteColumnarViewGraphToBuffer>,
+          &SetPickleState<theia::ViewGraph,
+                          theia::ReadColumnarViewGraphFromBuffer>))
+      .def("__reduce_ex__",
+           &ReduceEx<theia::ViewGraph, theia::WriteColumnarViewGraphToBuffer>)
 
       // not sure pointer as input
       //.def("ExtractSubgraph", &theia::ViewGraph::ExtractSubgraph)
@@ -1431,7 +2374,15 @@ void pytheia_sfm_classes(py::module& m) {
   py::class_<theia::GPSConverter>(m, "GPSConverter")
       .def(py::init<>())
       .def_static("ECEFToLLA", theia::GPSConverter::ECEFToLLA)
-      .def_static("LLAToECEF", theia::GPSConverter::LLAToECEF);
+      .def_static("LLAToECEF", theia::GPSConverter::LLAToECEF)
+      .def_static("ECEFToLLABatch", theia::GPSConverter::ECEFToLLABatch)
+      .def_static("LLAToECEFBatch", theia::GPSConverter::LLAToECEFBatch)
+      .def_static("ECEFToENURotation",
+                  theia::GPSConverter::ECEFToENURotation)
+      .def_static("ECEFToENU", theia::GPSConverter::ECEFToENU)
+      .def_static("ENUToECEF", theia::GPSConverter::ENUToECEF)
+      .def_static("LLAToENU", theia::GPSConverter::LLAToENU)
+      .def_static("ENUToLLA", theia::GPSConverter::ENUToLLA);
 
   // Bundle Adjustment
   py::enum_<theia::OptimizeIntrinsicsType>(m, "OptimizeIntrinsicsType")
@@ -1480,23 +2431,64 @@ void pytheia_sfm_classes(py::module& m) {
       .def_readwrite("setup_time_in_seconds",
                      &theia::BundleAdjustmentSummary::setup_time_in_seconds)
       .def_readwrite("solve_time_in_seconds",
-                     &theia::BundleAdjustmentSummary::solve_time_in_seconds);
-
-  m.def("BundleAdjustPartialReconstruction", theia::BundleAdjustPartialReconstructionWrapper);
-  m.def("BundleAdjustPartialViewsConstant", theia::BundleAdjustPartialViewsConstantWrapper);
-  m.def("BundleAdjustReconstruction", theia::BundleAdjustReconstructionWrapper);
-  m.def("BundleAdjustView", theia::BundleAdjustViewWrapper);
-  m.def("BundleAdjustViews", theia::BundleAdjustViewsWrapper);
-  m.def("BundleAdjustViewWithCov", theia::BundleAdjustViewWithCovWrapper);
-  m.def("BundleAdjustViewsWithCov", theia::BundleAdjustViewsWithCovWrapper);
+                     &theia::BundleAdjustmentSummary::solve_time_in_seconds)
+      .def_readwrite("num_iterations",
+                     &theia::BundleAdjustmentSummary::num_iterations)
+      .def_readwrite(
+          "residual_evaluation_time_in_seconds",
+          &theia::BundleAdjustmentSummary::residual_evaluation_time_in_seconds)
+      .def_readwrite(
+          "jacobian_evaluation_time_in_seconds",
+          &theia::BundleAdjustmentSummary::jacobian_evaluation_time_in_seconds)
+      .def_readwrite(
+          "linear_solver_time_in_seconds",
+          &theia::BundleAdjustmentSummary::linear_solver_time_in_seconds)
+      .def_readwrite(
+          "stopped_by_iteration_callback",
+          &theia::BundleAdjustmentSummary::stopped_by_iteration_callback);
+
+  m.def("BundleAdjustPartialReconstruction",
+        theia::BundleAdjustPartialReconstructionWrapper,
+        py::call_guard<py::gil_scoped_release>());
+  m.def("BundleAdjustPartialViewsConstant",
+        theia::BundleAdjustPartialViewsConstantWrapper,
+        py::call_guard<py::gil_scoped_release>());
+  m.def("BundleAdjustSubReconstruction",
+        theia::BundleAdjustSubReconstructionWrapper,
+        py::call_guard<py::gil_scoped_release>());
+  m.def("BundleAdjustReconstruction",
+        theia::BundleAdjustReconstructionWrapper,
+        py::call_guard<py::gil_scoped_release>());
+  m.def("BundleAdjustView",
+        theia::BundleAdjustViewWrapper,
+        py::call_guard<py::gil_scoped_release>());
+  m.def("BundleAdjustViews",
+        theia::BundleAdjustViewsWrapper,
+        py::call_guard<py::gil_scoped_release>());
+  m.def("BundleAdjustViewWithCov",
+        theia::BundleAdjustViewWithCovWrapper,
+        py::call_guard<py::gil_scoped_release>());
+  m.def("BundleAdjustViewsWithCov",
+        theia::BundleAdjustViewsWithCovWrapper,
+        py::call_guard<py::gil_scoped_release>());
  
-  m.def("BundleAdjustTrack", theia::BundleAdjustTrackWrapper);
-  m.def("BundleAdjustTracks", theia::BundleAdjustTracksWrapper);
-  m.def("BundleAdjustTrackWithCov", theia::BundleAdjustTrackWithCovWrapper);
-  m.def("BundleAdjustTracksWithCov", theia::BundleAdjustTracksWithCovWrapper);
+  m.def("BundleAdjustTrack",
+        theia::BundleAdjustTrackWrapper,
+        py::call_guard<py::gil_scoped_release>());
+  m.def("BundleAdjustTracks",
+        theia::BundleAdjustTracksWrapper,
+        py::call_guard<py::gil_scoped_release>());
+  m.def("BundleAdjustTrackWithCov",
+        theia::BundleAdjustTrackWithCovWrapper,
+        py::call_guard<py::gil_scoped_release>());
+  m.def("BundleAdjustTracksWithCov",
+        theia::BundleAdjustTracksWithCovWrapper,
+        py::call_guard<py::gil_scoped_release>());
   // m.def("BundleAdjustTwoViews", theia::BundleAdjustTwoViewsWrapper);
   m.def("BundleAdjustTwoViewsAngular",
-        theia::BundleAdjustTwoViewsAngularWrapper);
+        theia::BundleAdjustTwoViewsAngularWrapper,
+        py::call_guard<py::gil_scoped_release>());
+  m.def("RefineRelativePose", theia::RefineRelativePoseWrapper);
   m.def("OptimizeRelativePositionWithKnownRotation",
   theia::OptimizeRelativePositionWithKnownRotationWrapper);
 
@@ -1507,7 +2499,9 @@ void pytheia_sfm_classes(py::module& m) {
       //.def(py::init<theia::BundleAdjustmentOptions, theia::Reconstruction>())
       .def("AddView", &theia::BundleAdjuster::AddView)
       .def("AddTrack", &theia::BundleAdjuster::AddTrack)
-      .def("Optimize", &theia::BundleAdjuster::Optimize)
+      .def("Optimize",
+           &theia::BundleAdjuster::Optimize,
+           py::call_guard<py::gil_scoped_release>())
       //.def("SetCameraExtrinsicsParameterization",
       //&theia::BundleAdjuster::SetCameraExtrinsicsParameterization)
       //.def("SetCameraIntrinsicsParameterization",
@@ -1544,9 +2538,11 @@ void pytheia_sfm_classes(py::module& m) {
   py::class_<theia::LinearPositionEstimator, theia::PositionEstimator>(
       m, "LinearPositionEstimator")
       .def(py::init<const theia::LinearPositionEstimator::Options&,
-                    const theia::Reconstruction&>())
+                    const theia::Reconstruction&>(),
+           py::keep_alive<1, 3>())
       .def("EstimatePositions",
-           &theia::LinearPositionEstimator::EstimatePositionsWrapper);
+           &theia::LinearPositionEstimator::EstimatePositionsWrapper,
+           py::call_guard<py::gil_scoped_release>());
 
   py::class_<theia::NonlinearPositionEstimator::Options>(
       m, "NonlinearPositionEstimatorOptions")
@@ -1560,16 +2556,27 @@ void pytheia_sfm_classes(py::module& m) {
     .def_readwrite("min_num_points_per_view", 
           &theia::NonlinearPositionEstimator::Options::num_threads)
     .def_readwrite("point_to_camera_weight", 
-          &theia::NonlinearPositionEstimator::Options::max_num_iterations);
+          &theia::NonlinearPositionEstimator::Options::max_num_iterations)
+    .def_readwrite("use_analytic_jacobians", 
+          &theia::NonlinearPositionEstimator::Options::use_analytic_jacobians)
+    .def_readwrite("subsample_view_pairs", 
+          &theia::NonlinearPositionEstimator::Options::subsample_view_pairs)
+    .def_readwrite("min_num_view_pairs_per_view", 
+          &theia::NonlinearPositionEstimator::Options::min_num_view_pairs_per_view)
+    .def_readwrite("initialize_with_ligt", 
+          &theia::NonlinearPositionEstimator::Options::initialize_with_ligt);
 
   py::class_<theia::NonlinearPositionEstimator, theia::PositionEstimator>(
       m, "NonlinearPositionEstimator")
       .def(py::init<const theia::NonlinearPositionEstimator::Options&,
-                    const theia::Reconstruction&>())
+                    const theia::Reconstruction&>(),
+           py::keep_alive<1, 3>())
       .def("EstimatePositions",
-           &theia::NonlinearPositionEstimator::EstimatePositionsWrapper)
+           &theia::NonlinearPositionEstimator::EstimatePositionsWrapper,
+           py::call_guard<py::gil_scoped_release>())
       .def("EstimateRemainingPositionsInRecon",
-           &theia::NonlinearPositionEstimator::EstimateRemainingPositionsInReconWrapper);
+           &theia::NonlinearPositionEstimator::EstimateRemainingPositionsInReconWrapper,
+           py::call_guard<py::gil_scoped_release>());
 
   py::class_<theia::LeastUnsquaredDeviationPositionEstimator::Options>(
       m, "LeastUnsquaredDeviationPositionEstimatorOptions")
@@ -1579,7 +2586,9 @@ void pytheia_sfm_classes(py::module& m) {
     .def_readwrite("max_num_reweighted_iterations", 
           &theia::LeastUnsquaredDeviationPositionEstimator::Options::max_num_reweighted_iterations)
     .def_readwrite("convergence_criterion", 
-          &theia::LeastUnsquaredDeviationPositionEstimator::Options::convergence_criterion);
+          &theia::LeastUnsquaredDeviationPositionEstimator::Options::convergence_criterion)
+    .def_readwrite("num_threads",
+          &theia::LeastUnsquaredDeviationPositionEstimator::Options::num_threads);
           
   py::class_<theia::LeastUnsquaredDeviationPositionEstimator,
              theia::PositionEstimator>(
@@ -1587,7 +2596,8 @@ void pytheia_sfm_classes(py::module& m) {
       .def(py::init<theia::LeastUnsquaredDeviationPositionEstimator::Options>())
       .def("EstimatePositions",
            &theia::LeastUnsquaredDeviationPositionEstimator::
-               EstimatePositionsWrapper);
+               EstimatePositionsWrapper,
+           py::call_guard<py::gil_scoped_release>());
 
   py::class_<theia::LiGTPositionEstimator::Options>(
       m, "LiGTPositionEstimatorOptions")
@@ -1597,14 +2607,18 @@ void pytheia_sfm_classes(py::module& m) {
     .def_readwrite("max_power_iterations", 
           &theia::LiGTPositionEstimator::Options::max_power_iterations)
     .def_readwrite("eigensolver_threshold", 
-          &theia::LiGTPositionEstimator::Options::eigensolver_threshold);
+          &theia::LiGTPositionEstimator::Options::eigensolver_threshold)
+    .def_readwrite("max_num_tracks_per_view_pair", 
+          &theia::LiGTPositionEstimator::Options::max_num_tracks_per_view_pair);
 
   py::class_<theia::LiGTPositionEstimator, theia::PositionEstimator>(
       m, "LiGTPositionEstimator")
       .def(py::init<const theia::LiGTPositionEstimator::Options&,
-                    const theia::Reconstruction&>())
+                    const theia::Reconstruction&>(),
+           py::keep_alive<1, 3>())
       .def("EstimatePositions",
-           &theia::LiGTPositionEstimator::EstimatePositionsWrapper);
+           &theia::LiGTPositionEstimator::EstimatePositionsWrapper,
+           py::call_guard<py::gil_scoped_release>());
 
   // base RotationEstimator class
   py::class_<theia::RotationEstimator>(m, "RotationEstimator");
@@ -1620,14 +2634,17 @@ void pytheia_sfm_classes(py::module& m) {
       .def_readwrite("irls_step_convergence_threshold", 
           &theia::RobustRotationEstimator::Options::irls_step_convergence_threshold)
       .def_readwrite("irls_loss_parameter_sigma", 
-          &theia::RobustRotationEstimator::Options::irls_loss_parameter_sigma);
+          &theia::RobustRotationEstimator::Options::irls_loss_parameter_sigma)
+      .def_readwrite("num_threads",
+          &theia::RobustRotationEstimator::Options::num_threads);
 
   // Global Rotation Estimators
   py::class_<theia::RobustRotationEstimator, theia::RotationEstimator>(
       m, "RobustRotationEstimator")
       .def(py::init<const theia::RobustRotationEstimator::Options&>())
       .def("EstimateRotations",
-           &theia::RobustRotationEstimator::EstimateRotationsWrapper)
+           &theia::RobustRotationEstimator::EstimateRotationsWrapper,
+           py::call_guard<py::gil_scoped_release>())
       .def("AddRelativeRotationConstraint",
            &theia::RobustRotationEstimator::AddRelativeRotationConstraint)
       .def("SetFixedGlobalRotations", 
@@ -1638,7 +2655,8 @@ void pytheia_sfm_classes(py::module& m) {
       .def(py::init<>())
       .def(py::init<double>())
       .def("EstimateRotations",
-           &theia::NonlinearRotationEstimator::EstimateRotationsWrapper);
+           &theia::NonlinearRotationEstimator::EstimateRotationsWrapper,
+           py::call_guard<py::gil_scoped_release>());
 
   py::class_<theia::LinearRotationEstimator, theia::RotationEstimator>(
       m, "LinearRotationEstimator")
@@ -1646,19 +2664,22 @@ void pytheia_sfm_classes(py::module& m) {
       .def("AddRelativeRotationConstraint",
            &theia::LinearRotationEstimator::AddRelativeRotationConstraint)
       .def("EstimateRotations",
-           &theia::LinearRotationEstimator::EstimateRotationsWrapper);
+           &theia::LinearRotationEstimator::EstimateRotationsWrapper,
+           py::call_guard<py::gil_scoped_release>());
 
   py::class_<theia::LagrangeDualRotationEstimator, theia::RotationEstimator>(
       m, "LagrangeDualRotationEstimator")
       .def(py::init<>())
       .def("EstimateRotations",
-           &theia::LagrangeDualRotationEstimator::EstimateRotationsWrapper);
+           &theia::LagrangeDualRotationEstimator::EstimateRotationsWrapper,
+           py::call_guard<py::gil_scoped_release>());
 
   py::class_<theia::HybridRotationEstimator, theia::RotationEstimator>(
       m, "HybridRotationEstimator")
       .def(py::init<>())
       .def("EstimateRotations",
-           &theia::HybridRotationEstimator::EstimateRotationsWrapper);
+           &theia::HybridRotationEstimator::EstimateRotationsWrapper,
+           py::call_guard<py::gil_scoped_release>());
 }
 
 void pytheia_sfm(py::module& m) {
@@ -56,6 +56,7 @@
 #include "theia/solvers/prosac_sampler.h"
 #include "theia/solvers/quality_measurement.h"
 #include "theia/solvers/random_sampler.h"
+#include "theia/solvers/ransac_statistics.h"
 #include "theia/solvers/sample_consensus_estimator.h"
 #include "theia/solvers/sampler.h"
 #include "theia/util/random.h"
@@ -70,6 +71,7 @@ void pytheia_solvers_classes(py::module& m) {
   py::class_<theia::RandomNumberGenerator>(m, "RandomNumberGenerator")
       .def(py::init<>())
       .def(py::init<int>())
+      .def(py::init<unsigned, uint64_t>())
       .def("Seed", &theia::RandomNumberGenerator::Seed)
       .def("RandDouble", &theia::RandomNumberGenerator::RandDouble)
       .def("RandFloat", &theia::RandomNumberGenerator::RandFloat)
@@ -78,6 +80,25 @@ void pytheia_solvers_classes(py::module& m) {
 
       ;
 
+  // RansacStatistics
+  py::class_<theia::RansacStatistics>(m, "RansacStatistics")
+      .def(py::init<>())
+      .def_readwrite("num_estimations",
+                     &theia::RansacStatistics::num_estimations)
+      .def_readwrite("sampling_time", &theia::RansacStatistics::sampling_time)
+      .def_readwrite("solver_time", &theia::RansacStatistics::solver_time)
+      .def_readwrite("scoring_time", &theia::RansacStatistics::scoring_time)
+      .def_readwrite("lo_time", &theia::RansacStatistics::lo_time)
+      .def_readwrite("num_samples", &theia::RansacStatistics::num_samples)
+      .def_readwrite("num_degenerate_samples",
+                     &theia::RansacStatistics::num_degenerate_samples)
+      .def_readwrite("num_models", &theia::RansacStatistics::num_models)
+      .def_readwrite("inlier_ratio_histogram",
+                     &theia::RansacStatistics::inlier_ratio_histogram)
+      .def("SolutionsPerSample", &theia::RansacStatistics::SolutionsPerSample)
+      .def("Merge", &theia::RansacStatistics::Merge)
+      ;
+
   // RansacSummary
   py::class_<theia::RansacSummary>(m, "RansacSummary")
       .def_readwrite("inliers", &theia::RansacSummary::inliers)
@@ -86,8 +107,19 @@ void pytheia_solvers_classes(py::module& m) {
       .def_readwrite("num_iterations", &theia::RansacSummary::num_iterations)
       .def_readwrite("confidence", &theia::RansacSummary::confidence)
       .def_readwrite("num_lo_iterations", &theia::RansacSummary::num_lo_iterations)
+      .def_readwrite("hypothesis_generation_time",
+                     &theia::RansacSummary::hypothesis_generation_time)
+      .def_readwrite("hypothesis_scoring_time",
+                     &theia::RansacSummary::hypothesis_scoring_time)
+      .def_readwrite("refinement_time", &theia::RansacSummary::refinement_time)
+      .def_readwrite("statistics", &theia::RansacSummary::statistics)
       ;
 
+  py::enum_<theia::LocalOptimizationType>(m, "LocalOptimizationType")
+      .value("REFINE_MODEL", theia::LocalOptimizationType::REFINE_MODEL)
+      .value("INNER_RANSAC", theia::LocalOptimizationType::INNER_RANSAC)
+      .export_values();
+
   py::class_<theia::RansacParameters>(m, "RansacParameters")
       .def(py::init<>())
       .def_readwrite("error_thresh", &theia::RansacParameters::error_thresh)
@@ -100,7 +132,25 @@ void pytheia_solvers_classes(py::module& m) {
       .def_readwrite("use_mle", &theia::RansacParameters::use_mle)
       .def_readwrite("use_lo", &theia::RansacParameters::use_lo)
       .def_readwrite("lo_start_iterations", &theia::RansacParameters::lo_start_iterations)
-      .def_readwrite("use_Tdd_test", &theia::RansacParameters::use_Tdd_test);
+      .def_readwrite("lo_type", &theia::RansacParameters::lo_type)
+      .def_readwrite("lo_num_inner_iterations",
+                     &theia::RansacParameters::lo_num_inner_iterations)
+      .def_readwrite("lo_num_least_squares_iterations",
+                     &theia::RansacParameters::lo_num_least_squares_iterations)
+      .def_readwrite("lo_threshold_multiplier",
+                     &theia::RansacParameters::lo_threshold_multiplier)
+      .def_readwrite("use_Tdd_test", &theia::RansacParameters::use_Tdd_test)
+      .def_readwrite("num_threads", &theia::RansacParameters::num_threads)
+      .def_readwrite("preemptive_num_hypotheses",
+                     &theia::RansacParameters::preemptive_num_hypotheses)
+      .def_readwrite("preemptive_block_size",
+                     &theia::RansacParameters::preemptive_block_size)
+      .def_readwrite("lmed_approximate_median",
+                     &theia::RansacParameters::lmed_approximate_median)
+      .def_readwrite("exhaustive_sample_by_quality",
+                     &theia::RansacParameters::exhaustive_sample_by_quality)
+      .def_readwrite("collect_statistics",
+                     &theia::RansacParameters::collect_statistics);
   /*
   py::enum_<theia::FittingMethod>(m, "FittingMethod")
     .value("MLE", theia::FittingMethod::MLE)
@@ -32,7 +32,7 @@
 // Please contact the author of this library if you have any questions.
 // Author: Steffen Urban (urbse@googlemail.com), Shengyu Yin
 
-#include "pytheia/solvers/solvers.h"
+#include "pytheia/util/util.h"
 
 #include <pybind11/eigen.h>
 #include <pybind11/pybind11.h>
@@ -44,13 +44,33 @@
 #include <vector>
 
 #include "theia/util/map_util.h"
+#include "theia/util/metrics.h"
+#include "theia/util/trace.h"
 
 namespace py = pybind11;
 
 namespace pytheia {
 namespace util {
 
-void pytheia_util_classes(py::module& m) {}
+void pytheia_util_classes(py::module& m) {
+  py::class_<theia::Tracer>(m, "Tracer")
+      .def_static("Enable", &theia::Tracer::Enable)
+      .def_static("Disable", &theia::Tracer::Disable)
+      .def_static("IsEnabled", &theia::Tracer::IsEnabled)
+      .def_static("Clear", &theia::Tracer::Clear)
+      .def_static("NumSpans", &theia::Tracer::NumSpans)
+      .def_static("SetThreadName", &theia::Tracer::SetThreadName)
+      .def_static("ChromeTrace", &theia::Tracer::ChromeTrace)
+      .def_static("WriteChromeTrace", &theia::Tracer::WriteChromeTrace);
+
+  py::class_<theia::Metrics>(m, "Metrics")
+      .def_static("Reset", &theia::Metrics::Reset)
+      .def_static("UptimeInSeconds", &theia::Metrics::UptimeInSeconds)
+      .def_static("PrometheusText", &theia::Metrics::PrometheusText)
+      .def_static("Json", &theia::Metrics::Json)
+      .def_static("WritePrometheusText", &theia::Metrics::WritePrometheusText)
+      .def_static("WriteJson", &theia::Metrics::WriteJson);
+}
 
 void pytheia_util(py::module& m) {
   py::module m_submodule = m.def_submodule("util");
@@ -0,0 +1,177 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#include "theia/image/byte_image.h"
+
+#include <OpenImageIO/imagebuf.h>
+#include <OpenImageIO/imagebufalgo.h>
+#include <glog/logging.h>
+
+#include <string>
+
+#include "theia/image/image.h"
+
+namespace theia {
+
+ByteImage::ByteImage() : ByteImage(0, 0, 1) {}
+
+ByteImage::ByteImage(const std::string& filename) { Read(filename); }
+
+ByteImage::ByteImage(const std::string& filename,
+                     const int scale_denominator) {
+  ReadAtScale(filename, scale_denominator);
+}
+
+ByteImage::ByteImage(const int width, const int height, const int channels) {
+  oiio::ImageSpec image_spec(width, height, channels, oiio::TypeDesc::UINT8);
+  image_.reset(image_spec);
+}
+
+ByteImage::ByteImage(const FloatImage& image) {
+  const oiio::ImageSpec image_spec(
+      image.Width(), image.Height(), image.Channels(), oiio::TypeDesc::UINT8);
+  image_.reset(image_spec);
+  // OpenImageIO clamps and rounds the float values when converting them.
+  CHECK(image_.set_pixels(image_.roi(), oiio::TypeDesc::FLOAT, image.Data()));
+}
+
+oiio::ImageBuf& ByteImage::GetOpenImageIOImageBuf() { return image_; }
+
+const oiio::ImageBuf& ByteImage::GetOpenImageIOImageBuf() const {
+  return image_;
+}
+
+int ByteImage::Rows() const { return Height(); }
+
+int ByteImage::Cols() const { return Width(); }
+
+int ByteImage::Width() const { return image_.spec().width; }
+
+int ByteImage::Height() const { return image_.spec().height; }
+
+int ByteImage::Channels() const { return image_.nchannels(); }
+
+void ByteImage::SetXY(const int x,
+                      const int y,
+                      const int c,
+                      const unsigned char value) {
+  DCHECK_GE(x, 0);
+  DCHECK_LT(x, Width());
+  DCHECK_GE(y, 0);
+  DCHECK_LT(y, Height());
+  DCHECK_GE(c, 0);
+  DCHECK_LT(c, Channels());
+  Data()[(static_cast<size_t>(y) * Width() + x) * Channels() + c] = value;
+}
+
+unsigned char ByteImage::GetXY(const int x, const int y, const int c) const {
+  DCHECK_GE(x, 0);
+  DCHECK_LT(x, Width());
+  DCHECK_GE(y, 0);
+  DCHECK_LT(y, Height());
+  DCHECK_GE(c, 0);
+  DCHECK_LT(c, Channels());
+  return Data()[(static_cast<size_t>(y) * Width() + x) * Channels() + c];
+}
+
+void ByteImage::SetRowCol(const int row,
+                          const int col,
+                          const int channel,
+                          const unsigned char value) {
+  SetXY(col, row, channel, value);
+}
+
+unsigned char ByteImage::GetRowCol(const int row,
+                                   const int col,
+                                   const int channel) const {
+  return GetXY(col, row, channel);
+}
+
+FloatImage ByteImage::AsFloatImage() const {
+  FloatImage float_image(Width(), Height(), Channels());
+  CHECK(image_.get_pixels(image_.roi(), oiio::TypeDesc::FLOAT,
+                          float_image.Data()));
+  return float_image;
+}
+
+void ByteImage::ConvertToGrayscaleImage() {
+  if (Channels() == 1) {
+    VLOG(2) << "Image is already a grayscale image. No conversion necessary.";
+    return;
+  }
+
+  // Compute luminance via a weighted sum of R,G,B with the same weights as
+  // FloatImage.
+  const float luma_weights[3] = {.2126, .7152, .0722};
+  const oiio::ImageBuf source(image_);
+  image_.reset(oiio::ImageSpec(Width(), Height(), 1, oiio::TypeDesc::UINT8));
+  CHECK(oiio::ImageBufAlgo::channel_sum(image_, source, luma_weights));
+}
+
+void ByteImage::Read(const std::string& filename) {
+  ReadAtScale(filename, 1);
+}
+
+void ByteImage::ReadAtScale(const std::string& filename,
+                            const int scale_denominator) {
+  CHECK(ReadImageAtScale(
+      filename, scale_denominator, oiio::TypeDesc::UINT8, &image_))
+      << "Could not read image " << filename;
+}
+
+void ByteImage::Write(const std::string& filename) const {
+  image_.write(filename);
+}
+
+unsigned char* ByteImage::Data() {
+  return reinterpret_cast<unsigned char*>(image_.localpixels());
+}
+
+const unsigned char* ByteImage::Data() const {
+  return reinterpret_cast<const unsigned char*>(image_.localpixels());
+}
+
+void ByteImage::Resize(int new_width, int new_height) {
+  oiio::ROI roi(0, new_width, 0, new_height, 0, 1, 0, Channels());
+  oiio::ImageBuf dst;
+  CHECK(oiio::ImageBufAlgo::resize(dst, image_, nullptr, roi))
+      << oiio::geterror();
+  image_.swap(dst);
+}
+
+void ByteImage::Resize(double scale) {
+  Resize(static_cast<int>(scale * Width()), static_cast<int>(scale * Height()));
+}
+
+}  // namespace theia
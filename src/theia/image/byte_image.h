@@ -0,0 +1,116 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#ifndef THEIA_IMAGE_BYTE_IMAGE_H_
+#define THEIA_IMAGE_BYTE_IMAGE_H_
+
+#include <OpenImageIO/imagebuf.h>
+#include <string>
+
+#include "theia/image/image.h"
+
+namespace theia {
+
+// An image that stores each channel of a pixel in 8 bits with values ranging
+// from 0 to 255. Most images are 8-bit JPEGs, and holding them as a FloatImage
+// takes 4 times as much memory, so ByteImage is useful for keeping many images
+// (e.g. thumbnails for image retrieval) in memory. Images are converted to a
+// FloatImage for any processing with AsFloatImage.
+class ByteImage {
+ public:
+  ByteImage();
+
+  // Read from file.
+  explicit ByteImage(const std::string& filename);
+  // Read from file at 1 / scale_denominator of the full resolution. See
+  // ReadAtScale.
+  ByteImage(const std::string& filename, const int scale_denominator);
+  ByteImage(const int width, const int height, const int channels);
+
+  // Converts the image to 8 bits per channel. Pixel values are clamped to the
+  // range 0 to 1.0.
+  explicit ByteImage(const FloatImage& image);
+  ~ByteImage() {}
+
+  // Get a reference to the underlying ImageBuf object for direct manipulation.
+  oiio::ImageBuf& GetOpenImageIOImageBuf();
+  const oiio::ImageBuf& GetOpenImageIOImageBuf() const;
+
+  // Image information
+  int Rows() const;
+  int Cols() const;
+  int Width() const;
+  int Height() const;
+  int Channels() const;
+
+  // Set and get the pixel value at (x, y) in channel c.
+  void SetXY(const int x, const int y, const int c, const unsigned char value);
+  unsigned char GetXY(const int x, const int y, const int c) const;
+
+  // Set and get the pixel value at row and column in channel c.
+  void SetRowCol(const int row,
+                 const int col,
+                 const int channel,
+                 const unsigned char value);
+  unsigned char GetRowCol(const int row,
+                          const int col,
+                          const int channel) const;
+
+  // Convert to a floating point image with pixel values ranging from 0 to 1.0.
+  FloatImage AsFloatImage() const;
+  void ConvertToGrayscaleImage();
+
+  // Read the image from file. Images with more than 8 bits per channel are
+  // quantized to 8 bits.
+  void Read(const std::string& filename);
+  // Read the image at 1 / scale_denominator of the full resolution, see
+  // ReadImageAtScale.
+  void ReadAtScale(const std::string& filename, const int scale_denominator);
+  void Write(const std::string& filename) const;
+
+  // Get a pointer to the row-major pixel data.
+  unsigned char* Data();
+  const unsigned char* Data() const;
+
+  // Resize using a Lanczos 3 filter.
+  void Resize(int new_width, int new_height);
+  void Resize(double scale);
+
+ protected:
+  oiio::ImageBuf image_;
+};
+
+}  // namespace theia
+
+#endif  // THEIA_IMAGE_BYTE_IMAGE_H_
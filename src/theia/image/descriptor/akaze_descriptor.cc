@@ -45,20 +45,17 @@
 #include "theia/image/keypoint_detector/keypoint.h"
 
 namespace theia {
-bool AkazeDescriptorExtractor::ComputeDescriptor(const FloatImage& image,
-                                                 const Keypoint& keypoint,
-                                                 Eigen::VectorXf* descriptor) {
-  LOG(FATAL) << "AKAZE must use its own Keypoints and so calling the AKAZE "
-                "descriptor extractor with different keypoint cannot be used. "
-                "Please use "
-                "AkazeDescriptorExtractor::DetectAndExtractDescriptors() "
-                "instead.";
-}
+namespace {
 
-bool AkazeDescriptorExtractor::DetectAndExtractDescriptors(
-    const FloatImage& image,
-    std::vector<Keypoint>* keypoints,
-    std::vector<Eigen::VectorXf>* descriptors) {
+// The full MLDB descriptor with 3 channels has (6 + 36 + 120) * 3 = 486 bits.
+static const int kNumBytesMLDBDescriptor = (486 + 7) / 8;
+
+// Runs the AKAZE detector and computes the descriptors of the given type.
+void DetectAndExtractAkaze(const AkazeParameters& akaze_params,
+                           const libAKAZE::DESCRIPTOR_TYPE descriptor_type,
+                           const FloatImage& image,
+                           std::vector<Keypoint>* keypoints,
+                           libAKAZE::AKAZEDescriptors* akaze_descriptors) {
   // Try to convert the image to grayscale and eigen type.
   const FloatImage& gray_image = image.AsGrayscaleImage();
   libAKAZE::RowMatrixXf img_32 = Eigen::Map<
@@ -70,16 +67,16 @@ bool AkazeDescriptorExtractor::DetectAndExtractDescriptors(
   libAKAZE::AKAZEOptions options;
   options.img_width = img_32.cols();
   options.img_height = img_32.rows();
-  options.num_threads = 1;
+  options.num_threads = std::max(1, akaze_params.num_threads);
   options.soffset = 1.6f;
   options.derivative_factor = 1.5f;
-  options.omax = akaze_params_.maximum_octave_levels;
-  options.nsublevels = akaze_params_.num_sublevels;
-  options.dthreshold = akaze_params_.hessian_threshold;
+  options.omax = akaze_params.maximum_octave_levels;
+  options.nsublevels = akaze_params.num_sublevels;
+  options.dthreshold = akaze_params.hessian_threshold;
   options.min_dthreshold = 0.00001f;
 
   options.diffusivity = libAKAZE::PM_G2;
-  options.descriptor = libAKAZE::MSURF;
+  options.descriptor = descriptor_type;
   options.descriptor_size = 0;
   options.descriptor_channels = 3;
   options.descriptor_pattern_size = 10;
@@ -98,8 +95,7 @@ bool AkazeDescriptorExtractor::DetectAndExtractDescriptors(
   evolution.Feature_Detection(akaze_keypoints);
 
   // Compute descriptors.
-  libAKAZE::AKAZEDescriptors akaze_descriptors;
-  evolution.Compute_Descriptors(akaze_keypoints, akaze_descriptors);
+  evolution.Compute_Descriptors(akaze_keypoints, *akaze_descriptors);
 
   // Set the output keypoints.
   keypoints->reserve(akaze_keypoints.size());
@@ -111,10 +107,56 @@ bool AkazeDescriptorExtractor::DetectAndExtractDescriptors(
     keypoint.set_orientation(akaze_keypoint.angle);
     keypoints->emplace_back(keypoint);
   }
+}
+
+}  // namespace
+
+bool AkazeDescriptorExtractor::ComputeDescriptor(const FloatImage& image,
+                                                 const Keypoint& keypoint,
+                                                 Eigen::VectorXf* descriptor) {
+  LOG(FATAL) << "AKAZE must use its own Keypoints and so calling the AKAZE "
+                "descriptor extractor with different keypoint cannot be used. "
+                "Please use "
+                "AkazeDescriptorExtractor::DetectAndExtractDescriptors() "
+                "instead.";
+}
+
+bool AkazeDescriptorExtractor::DetectAndExtractDescriptors(
+    const FloatImage& image,
+    std::vector<Keypoint>* keypoints,
+    std::vector<Eigen::VectorXf>* descriptors) {
+  if (akaze_params_.use_binary_descriptors) {
+    LOG(ERROR) << "The AKAZE extractor is configured for binary descriptors. "
+                  "Use DetectAndExtractBinaryDescriptors() instead.";
+    return false;
+  }
+
+  libAKAZE::AKAZEDescriptors akaze_descriptors;
+  DetectAndExtractAkaze(
+      akaze_params_, libAKAZE::MSURF, image, keypoints, &akaze_descriptors);
 
   // Set the output descriptors.
   std::swap(*descriptors, akaze_descriptors.float_descriptor);
   return true;
 }
 
+bool AkazeDescriptorExtractor::DetectAndExtractBinaryDescriptors(
+    const FloatImage& image,
+    std::vector<Keypoint>* keypoints,
+    BinaryDescriptorMatrix* descriptors) {
+  libAKAZE::AKAZEDescriptors akaze_descriptors;
+  DetectAndExtractAkaze(
+      akaze_params_, libAKAZE::MLDB, image, keypoints, &akaze_descriptors);
+
+  // Pack the descriptors into a contiguous matrix.
+  descriptors->resize(akaze_descriptors.binary_descriptor.size(),
+                      kNumBytesMLDBDescriptor);
+  for (int i = 0; i < akaze_descriptors.binary_descriptor.size(); i++) {
+    descriptors->row(i) = akaze_descriptors.binary_descriptor[i]
+                              .head(kNumBytesMLDBDescriptor)
+                              .transpose();
+  }
+  return true;
+}
+
 }  // namespace theia
@@ -51,6 +51,15 @@ struct AkazeParameters {
   int num_sublevels = 4;
   // Lowering this threshold will increase the number of features.
   float hessian_threshold = 0.001f;
+  // If true, 486-bit binary MLDB descriptors are extracted with
+  // DetectAndExtractBinaryDescriptors. Otherwise, 64-dimensional float MSURF
+  // descriptors are extracted.
+  bool use_binary_descriptors = false;
+  // Number of threads used to process a single image. AKAZE parallelizes the
+  // convolutions and the FED diffusion steps of the nonlinear scale space, the
+  // detector response and the descriptors with OpenMP, so this only has an
+  // effect if libAKAZE is built with OpenMP (AKAZE_USE_OPENMP).
+  int num_threads = 1;
 };
 
 class AkazeDescriptorExtractor : public DescriptorExtractor {
@@ -71,6 +80,16 @@ class AkazeDescriptorExtractor : public DescriptorExtractor {
                                    std::vector<Keypoint>* keypoints,
                                    std::vector<Eigen::VectorXf>* descriptors);
 
+  bool ProducesBinaryDescriptors() const {
+    return akaze_params_.use_binary_descriptors;
+  }
+
+  // Detects AKAZE keypoints and extracts the bit-packed MLDB descriptors. Each
+  // descriptor is 61 bytes long.
+  bool DetectAndExtractBinaryDescriptors(const FloatImage& image,
+                                         std::vector<Keypoint>* keypoints,
+                                         BinaryDescriptorMatrix* descriptors);
+
  private:
   const AkazeParameters akaze_params_;
 
@@ -35,11 +35,15 @@
 #include "theia/image/descriptor/create_descriptor_extractor.h"
 
 #include <glog/logging.h>
+#include <algorithm>
 #include <memory>
 
 #include "theia/image/descriptor/akaze_descriptor.h"
 #include "theia/image/descriptor/descriptor_extractor.h"
 #include "theia/image/descriptor/sift_descriptor.h"
+#ifdef WITH_SIFTGPU
+#include "theia/image/descriptor/sift_gpu_descriptor.h"
+#endif
 #include "theia/image/keypoint_detector/sift_parameters.h"
 
 namespace theia {
@@ -84,17 +88,40 @@ inline AkazeParameters FeatureDensityToAkazeParameters(
 
 std::unique_ptr<DescriptorExtractor> CreateDescriptorExtractor(
     const DescriptorExtractorType& descriptor_type,
-    const FeatureDensity& feature_density) {
+    const FeatureDensity& feature_density,
+    const int num_threads_per_image,
+    const int max_num_features) {
+  CHECK_GT(num_threads_per_image, 0);
   std::unique_ptr<DescriptorExtractor> descriptor_extractor;
   switch (descriptor_type) {
-    case DescriptorExtractorType::SIFT:
-      descriptor_extractor.reset(new SiftDescriptorExtractor(
-          FeatureDensityToSiftParameters(feature_density)));
+    case DescriptorExtractorType::SIFT: {
+      SiftParameters sift_params =
+          FeatureDensityToSiftParameters(feature_density);
+      sift_params.num_threads = num_threads_per_image;
+      sift_params.max_num_features = max_num_features;
+      descriptor_extractor.reset(new SiftDescriptorExtractor(sift_params));
       break;
-    case DescriptorExtractorType::AKAZE:
-      descriptor_extractor.reset(new AkazeDescriptorExtractor(
-          FeatureDensityToAkazeParameters(feature_density)));
+    }
+    case DescriptorExtractorType::AKAZE: {
+      AkazeParameters akaze_params =
+          FeatureDensityToAkazeParameters(feature_density);
+      akaze_params.num_threads = num_threads_per_image;
+      descriptor_extractor.reset(new AkazeDescriptorExtractor(akaze_params));
       break;
+    }
+    case DescriptorExtractorType::SIFT_GPU: {
+#ifdef WITH_SIFTGPU
+      SiftGpuParameters sift_gpu_params;
+      sift_gpu_params.sift_params =
+          FeatureDensityToSiftParameters(feature_density);
+      descriptor_extractor.reset(
+          new SiftGpuDescriptorExtractor(sift_gpu_params));
+#else
+      LOG(FATAL) << "SIFT_GPU descriptors require Theia to be built with "
+                    "WITH_SIFTGPU.";
+#endif
+      break;
+    }
     default:
       LOG(ERROR) << "Invalid Descriptor Extractor specified.";
   }
@@ -103,4 +130,10 @@ std::unique_ptr<DescriptorExtractor> CreateDescriptorExtractor(
   return descriptor_extractor;
 }
 
+int NumThreadsPerImage(const int num_threads, const int num_images) {
+  const int num_parallel_images =
+      std::max(1, std::min(num_threads, num_images));
+  return std::max(1, num_threads / num_parallel_images);
+}
+
 }  // namespace theia
@@ -47,6 +47,9 @@ class DescriptorExtractor;
 enum class DescriptorExtractorType {
   SIFT = 0,
   AKAZE = 1,
+  // SIFT extracted on the GPU with SiftGPU. The features are compatible with
+  // SIFT features. Only available if Theia is built with WITH_SIFTGPU.
+  SIFT_GPU = 2,
 };
 
 // Users may specify feature density to target their specific
@@ -56,10 +59,23 @@ enum class DescriptorExtractorType {
 // reconstructions and so will want to extract many features (DENSE).
 enum class FeatureDensity { SPARSE = 0, NORMAL = 1, DENSE = 2 };
 
-// Factory method to create the keypoint detector and descriptor extractor.
+// Factory method to create the keypoint detector and descriptor extractor. The
+// extractor uses num_threads_per_image threads to process each image if the
+// descriptor type supports it. If max_num_features is positive, SIFT keeps at
+// most that many spatially uniform keypoints before computing descriptors.
 std::unique_ptr<DescriptorExtractor> CreateDescriptorExtractor(
     const DescriptorExtractorType& descriptor_type,
-    const FeatureDensity& feature_density);
+    const FeatureDensity& feature_density,
+    const int num_threads_per_image = 1,
+    const int max_num_features = 0);
+
+// Splits num_threads threads between extracting features from num_images
+// images in parallel and processing each image with multiple threads. One
+// thread per image is used as long as there are enough images to keep all
+// threads busy, and the remaining threads are used within each image
+// otherwise. Returns the number of threads per image, and the number of images
+// processed in parallel is num_threads / num_threads_per_image.
+int NumThreadsPerImage(const int num_threads, const int num_images);
 
 }  // namespace theia
 
@@ -35,6 +35,9 @@
 #include "theia/image/descriptor/descriptor_extractor.h"
 
 #include <Eigen/Core>
+#include <glog/logging.h>
+#include <utility>
+#include <vector>
 
 #include "theia/image/image.h"
 #include "theia/image/keypoint_detector/keypoint.h"
@@ -58,8 +61,56 @@ bool DescriptorExtractor::ComputeDescriptors(
     }
 
     descriptors->push_back(descriptor);
+    ++keypoint_it;
   }
   return true;
 }
 
+bool DescriptorExtractor::DetectAndExtractFilteredDescriptors(
+    const FloatImage& image,
+    const KeypointPositionFilter& keep_position,
+    std::vector<Keypoint>* keypoints,
+    std::vector<Eigen::VectorXf>* descriptors) {
+  std::vector<Keypoint> detected_keypoints;
+  std::vector<Eigen::VectorXf> detected_descriptors;
+  if (!DetectAndExtractDescriptors(
+          image, &detected_keypoints, &detected_descriptors)) {
+    return false;
+  }
+
+  for (int i = 0; i < detected_keypoints.size(); i++) {
+    if (keep_position == nullptr ||
+        keep_position(detected_keypoints[i].x(), detected_keypoints[i].y())) {
+      keypoints->emplace_back(detected_keypoints[i]);
+      descriptors->emplace_back(std::move(detected_descriptors[i]));
+    }
+  }
+  return true;
+}
+
+bool DescriptorExtractor::ComputeDescriptorsOfImages(
+    const std::vector<const FloatImage*>& images,
+    const int num_threads,
+    std::vector<std::vector<Keypoint> >* keypoints,
+    std::vector<std::vector<Eigen::VectorXf> >* descriptors) {
+  CHECK_EQ(images.size(), CHECK_NOTNULL(keypoints)->size());
+  CHECK_NOTNULL(descriptors)->resize(images.size());
+  bool success = true;
+  for (int i = 0; i < images.size(); i++) {
+    (*descriptors)[i].clear();
+    success &=
+        ComputeDescriptors(*images[i], &(*keypoints)[i], &(*descriptors)[i]);
+  }
+  return success;
+}
+
+bool DescriptorExtractor::DetectAndExtractBinaryDescriptors(
+    const FloatImage& image,
+    std::vector<Keypoint>* keypoints,
+    BinaryDescriptorMatrix* descriptors) {
+  LOG(ERROR) << "This descriptor extractor does not produce binary "
+                "descriptors. Use DetectAndExtractDescriptors() instead.";
+  return false;
+}
+
 }  // namespace theia
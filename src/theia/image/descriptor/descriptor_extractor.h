@@ -36,8 +36,11 @@
 #define THEIA_IMAGE_DESCRIPTOR_DESCRIPTOR_EXTRACTOR_H_
 
 #include <Eigen/Core>
+#include <stdint.h>
 #include <vector>
 
+#include "theia/image/keypoint_detector/keypoint_detector.h"
+#include "theia/matching/descriptor_types.h"
 #include "theia/util/util.h"
 
 namespace theia {
@@ -71,6 +74,20 @@ class DescriptorExtractor {
                                   std::vector<Keypoint>* keypoints,
                                   std::vector<Eigen::VectorXf>* descriptors);
 
+  // Computes the descriptors of given keypoints, e.g. from an external or
+  // learned detector, for a batch of images. (*keypoints)[i] holds the
+  // keypoints of images[i] and (*descriptors)[i] receives their descriptors;
+  // keypoints are removed as in ComputeDescriptors. Extractors that can share
+  // work between the keypoints of an image or run images concurrently use up
+  // to num_threads threads. The default implementation calls
+  // ComputeDescriptors for one image after the other. Returns false if any
+  // image fails.
+  virtual bool ComputeDescriptorsOfImages(
+      const std::vector<const FloatImage*>& images,
+      const int num_threads,
+      std::vector<std::vector<Keypoint> >* keypoints,
+      std::vector<std::vector<Eigen::VectorXf> >* descriptors);
+
   // Detects keypoints using the default method for the given descriptor. This
   // can be more efficient (e.g., with SIFT) because there is some overhead
   // required for creating the keypoint and descriptor objects.
@@ -79,6 +96,28 @@ class DescriptorExtractor {
       std::vector<Keypoint>* keypoints,
       std::vector<Eigen::VectorXf>* descriptors) = 0;
 
+  // Same as DetectAndExtractDescriptors, but only keeps the keypoints whose
+  // position passes the filter, e.g. the keypoints that are not masked out.
+  // Extractors that can test keypoints before describing them (e.g. SIFT) skip
+  // the descriptors of the dropped keypoints, and the default implementation
+  // removes them after the extraction.
+  virtual bool DetectAndExtractFilteredDescriptors(
+      const FloatImage& image,
+      const KeypointPositionFilter& keep_position,
+      std::vector<Keypoint>* keypoints,
+      std::vector<Eigen::VectorXf>* descriptors);
+
+  // Returns true if the extractor produces binary descriptors, in which case
+  // DetectAndExtractBinaryDescriptors should be used.
+  virtual bool ProducesBinaryDescriptors() const { return false; }
+
+  // Detects keypoints and extracts bit-packed binary descriptors, one per row
+  // of the descriptor matrix. Extractors of float descriptors return false.
+  virtual bool DetectAndExtractBinaryDescriptors(
+      const FloatImage& image,
+      std::vector<Keypoint>* keypoints,
+      BinaryDescriptorMatrix* descriptors);
+
  private:
   DISALLOW_COPY_AND_ASSIGN(DescriptorExtractor);
 };
@@ -35,6 +35,8 @@
 #include "theia/image/descriptor/sift_descriptor.h"
 
 #include <algorithm>
+#include <memory>
+#include <numeric>
 extern "C" {
 #include <vlfeat/vl/sift.h>
 }
@@ -44,6 +46,8 @@ extern "C" {
 #include "theia/image/descriptor/descriptor_extractor.h"
 #include "theia/image/image.h"
 #include "theia/image/keypoint_detector/keypoint.h"
+#include "theia/image/keypoint_detector/sift_detector.h"
+#include "theia/util/executor.h"
 #include <Eigen/Core>
 
 namespace theia {
@@ -67,6 +71,118 @@ double GetValidFirstOctave(const int first_octave,
   return valid_first_octave;
 }
 
+typedef std::unique_ptr<VlSiftFilt, void (*)(VlSiftFilt*)> SiftFilter;
+
+// Creates a new sift filter unless the filter was created for an image of the
+// same size.
+void ResetSiftFilterIfNeeded(const SiftParameters& sift_params,
+                             const FloatImage& image,
+                             SiftFilter* sift_filter) {
+  if (*sift_filter != nullptr && (*sift_filter)->width == image.Cols() &&
+      (*sift_filter)->height == image.Rows()) {
+    return;
+  }
+  const int first_octave =
+      GetValidFirstOctave(sift_params.first_octave, image.Rows(), image.Cols());
+  sift_filter->reset(vl_sift_new(image.Cols(),
+                                 image.Rows(),
+                                 sift_params.num_octaves,
+                                 sift_params.num_levels,
+                                 first_octave));
+}
+
+// Computes the descriptors of the keypoints of the image. The scale space is
+// built once, octave by octave, and the octaves above the highest octave of
+// the keypoints are not built at all. The keypoints are grouped by octave so
+// that each octave only visits its own keypoints, which are split into
+// contiguous blocks that are described in parallel.
+void ComputeSiftDescriptorsOfKeypoints(
+    const SiftParameters& sift_params,
+    VlSiftFilt* sift_filter,
+    const FloatImage& image,
+    std::vector<Keypoint>* keypoints,
+    std::vector<Eigen::VectorXf>* descriptors) {
+  const int num_keypoints = keypoints->size();
+  std::vector<VlSiftKeypoint> sift_keypoints(num_keypoints);
+  // The keypoints of octave o are order[octave_offsets[o - o_min]] to
+  // order[octave_offsets[o - o_min + 1] - 1], in the order of the input.
+  std::vector<int> octave_offsets(sift_filter->O + 1, 0);
+  for (int i = 0; i < num_keypoints; i++) {
+    CHECK((*keypoints)[i].has_scale())
+        << "Keypoint must have a scale to compute a SIFT descriptor.";
+    vl_sift_keypoint_init(sift_filter,
+                          &sift_keypoints[i],
+                          (*keypoints)[i].x(),
+                          (*keypoints)[i].y(),
+                          (*keypoints)[i].scale());
+    ++octave_offsets[sift_keypoints[i].o - sift_filter->o_min + 1];
+  }
+  std::partial_sum(
+      octave_offsets.begin(), octave_offsets.end(), octave_offsets.begin());
+  std::vector<int> order(num_keypoints);
+  {
+    std::vector<int> next_index(octave_offsets.begin(),
+                                octave_offsets.end() - 1);
+    for (int i = 0; i < num_keypoints; i++) {
+      order[next_index[sift_keypoints[i].o - sift_filter->o_min]++] = i;
+    }
+  }
+
+  // Keypoints in octaves that are too small to be built keep a zero
+  // descriptor.
+  descriptors->assign(num_keypoints,
+                      Eigen::VectorXf::Zero(kNumSiftDimensions));
+  if (num_keypoints == 0) {
+    return;
+  }
+
+  // The VLFeat functions take in a non-const image pointer so that it can
+  // calculate gaussian pyramids. Obviously, we do not want to break our const
+  // input, so the best solution (for now) is to copy the image.
+  FloatImage mutable_image = image.AsGrayscaleImage();
+  int vl_status =
+      vl_sift_process_first_octave(sift_filter, mutable_image.Data());
+  // VLFeat caches the gradient by octave index only, so the cache must be
+  // invalidated whenever the scale space is (re)computed.
+  sift_filter->grad_o = sift_filter->o_min - 1;
+  while (vl_status != VL_ERR_EOF) {
+    const int octave = sift_filter->o_cur - sift_filter->o_min;
+    const int octave_start = octave_offsets[octave];
+    const int num_octave_keypoints = octave_offsets[octave + 1] - octave_start;
+    if (num_octave_keypoints > 0) {
+      UpdateSiftOctaveGradient(sift_filter);
+      ParallelFor(
+          sift_params.num_threads,
+          num_octave_keypoints,
+          [&](const int start, const int end) {
+            for (int j = octave_start + start; j < octave_start + end; j++) {
+              const int i = order[j];
+              Keypoint& keypoint = (*keypoints)[i];
+              if (!keypoint.has_orientation()) {
+                double angles[4];
+                const int num_angles = vl_sift_calc_keypoint_orientations(
+                    sift_filter, angles, &sift_keypoints[i]);
+                keypoint.set_orientation(num_angles > 0 ? angles[0] : 0.0);
+              }
+              vl_sift_calc_keypoint_descriptor(sift_filter,
+                                               (*descriptors)[i].data(),
+                                               &sift_keypoints[i],
+                                               keypoint.orientation());
+              if (sift_params.root_sift) {
+                SiftDescriptorExtractor::ConvertToRootSift(
+                    &(*descriptors)[i]);
+              }
+            }
+          });
+    }
+    // No keypoint needs the higher octaves.
+    if (octave_offsets[octave + 1] == num_keypoints) {
+      break;
+    }
+    vl_status = vl_sift_process_next_octave(sift_filter);
+  }
+}
+
 }  // namespace
 
 SiftDescriptorExtractor::SiftDescriptorExtractor(
@@ -155,61 +271,30 @@ bool SiftDescriptorExtractor::ComputeDescriptors(
   // width and height are different) then we must make a new filter. Adding this
   // statement will save the function from regenerating the filter for
   // successive calls with images of the same size (e.g. a video sequence).
-  if (!sift_filter_ || (sift_filter_->width != image.Cols() ||
-                        sift_filter_->height != image.Rows())) {
-    const int first_octave = GetValidFirstOctave(
-        sift_params_.first_octave, image.Rows(), image.Cols());
-    sift_filter_.reset(vl_sift_new(image.Cols(),
-                                   image.Rows(),
-                                   sift_params_.num_octaves,
-                                   sift_params_.num_levels,
-                                   first_octave));
-  }
-
-  // Create the vl sift keypoint from the one passed in.
-  std::vector<VlSiftKeypoint> sift_keypoints(keypoints->size());
-  for (int i = 0; i < keypoints->size(); i++) {
-    CHECK((*keypoints)[i].has_scale() && (*keypoints)[i].has_orientation())
-        << "Keypoint must have scale and orientation to compute a SIFT "
-        << "descriptor.";
-    vl_sift_keypoint_init(sift_filter_.get(),
-                          &sift_keypoints[i],
-                          (*keypoints)[i].x(),
-                          (*keypoints)[i].y(),
-                          (*keypoints)[i].scale());
-  }
-  // The VLFeat functions take in a non-const image pointer so that it can
-  // calculate gaussian pyramids. Obviously, we do not want to break our const
-  // input, so the best solution (for now) is to copy the image.
-  FloatImage mutable_image = image.AsGrayscaleImage();
-
-  // Calculate the first octave to process.
-  int vl_status =
-      vl_sift_process_first_octave(sift_filter_.get(), mutable_image.Data());
-
-  // Proceed through the octaves we reach the same one as the keypoint.  We
-  // first resize the descriptors vector so that the keypoint indicies will be
-  // properly matched to the descriptors.
-  descriptors->resize(keypoints->size(), Eigen::VectorXf(128));
-  while (vl_status != VL_ERR_EOF) {
-    // Go through each keypoint to see if it came from this octave.
-    for (int i = 0; i < sift_keypoints.size(); i++) {
-      if (sift_keypoints[i].o != sift_filter_->o_cur) continue;
-
-      vl_sift_calc_keypoint_descriptor(sift_filter_.get(),
-                                       (*descriptors)[i].data(),
-                                       &sift_keypoints[i],
-                                       (*keypoints)[i].orientation());
-    }
-    vl_status = vl_sift_process_next_octave(sift_filter_.get());
-  }
+  ResetSiftFilterIfNeeded(sift_params_, image, &sift_filter_);
+  ComputeSiftDescriptorsOfKeypoints(
+      sift_params_, sift_filter_.get(), image, keypoints, descriptors);
+  return true;
+}
 
-  if (sift_params_.root_sift) {
-    for (int i = 0; i < descriptors->size(); i++) {
-      ConvertToRootSift(&(*descriptors)[i]);
+bool SiftDescriptorExtractor::ComputeDescriptorsOfImages(
+    const std::vector<const FloatImage*>& images,
+    const int num_threads,
+    std::vector<std::vector<Keypoint> >* keypoints,
+    std::vector<std::vector<Eigen::VectorXf> >* descriptors) {
+  CHECK_EQ(images.size(), CHECK_NOTNULL(keypoints)->size());
+  CHECK_NOTNULL(descriptors)->resize(images.size());
+  ParallelFor(num_threads, images.size(), [&](const int start, const int end) {
+    SiftFilter sift_filter(nullptr, vl_sift_delete);
+    for (int i = start; i < end; i++) {
+      ResetSiftFilterIfNeeded(sift_params_, *images[i], &sift_filter);
+      ComputeSiftDescriptorsOfKeypoints(sift_params_,
+                                        sift_filter.get(),
+                                        *images[i],
+                                        &(*keypoints)[i],
+                                        &(*descriptors)[i]);
     }
-  }
-
+  });
   return true;
 }
 
@@ -217,6 +302,15 @@ bool SiftDescriptorExtractor::DetectAndExtractDescriptors(
     const FloatImage& image,
     std::vector<Keypoint>* keypoints,
     std::vector<Eigen::VectorXf>* descriptors) {
+  return DetectAndExtractFilteredDescriptors(
+      image, nullptr, keypoints, descriptors);
+}
+
+bool SiftDescriptorExtractor::DetectAndExtractFilteredDescriptors(
+    const FloatImage& image,
+    const KeypointPositionFilter& keep_position,
+    std::vector<Keypoint>* keypoints,
+    std::vector<Eigen::VectorXf>* descriptors) {
   // If the filter has been set, but is not usable for the input image (i.e. the
   // width and height are different) then we must make a new filter. Adding this
   // statement will save the function from regenerating the filter for
@@ -239,46 +333,13 @@ bool SiftDescriptorExtractor::DetectAndExtractDescriptors(
   // input, so the best solution (for now) is to copy the image.
   FloatImage mutable_image = image.AsGrayscaleImage();
 
-  // Calculate the first octave to process.
-  int vl_status =
-      vl_sift_process_first_octave(sift_filter_.get(), mutable_image.Data());
-  // Process octaves until you can't anymore.
-  while (vl_status != VL_ERR_EOF) {
-    // Detect the keypoints.
-    vl_sift_detect(sift_filter_.get());
-
-    // Get the keypoints.
-    const VlSiftKeypoint* vl_keypoints =
-        vl_sift_get_keypoints(sift_filter_.get());
-    const int num_keypoints = vl_sift_get_nkeypoints(sift_filter_.get());
-
-    for (int i = 0; i < num_keypoints; ++i) {
-      // Calculate (up to 4) orientations of the keypoint.
-      double angles[4];
-      int num_angles = vl_sift_calc_keypoint_orientations(
-          sift_filter_.get(), angles, &vl_keypoints[i]);
-      // If upright sift is enabled, only use the first keypoint at a given
-      // pixel location.
-      if (sift_params_.upright_sift && num_angles > 1) {
-        num_angles = 1;
-      }
-
-      Eigen::VectorXf descriptor(kNumSiftDimensions);
-      for (int j = 0; j < num_angles; ++j) {
-        descriptor.setZero();
-        vl_sift_calc_keypoint_descriptor(
-            sift_filter_.get(), descriptor.data(), &vl_keypoints[i], angles[j]);
-        descriptors->push_back(descriptor);
-
-        Keypoint keypoint(vl_keypoints[i].x, vl_keypoints[i].y, Keypoint::SIFT);
-        keypoint.set_scale(vl_keypoints[i].sigma);
-        keypoint.set_orientation(angles[j]);
-        keypoints->push_back(keypoint);
-      }
-    }
-    // Attempt to process the next octave.
-    vl_status = vl_sift_process_next_octave(sift_filter_.get());
-  }
+  // Detect the keypoints and compute their orientations and descriptors.
+  DetectSiftKeypoints(sift_params_,
+                      sift_filter_.get(),
+                      mutable_image.Data(),
+                      keep_position,
+                      keypoints,
+                      descriptors);
 
   if (sift_params_.root_sift) {
     for (auto& descriptor : *descriptors) {
@@ -66,17 +66,39 @@ class SiftDescriptorExtractor : public DescriptorExtractor {
                          const Keypoint& keypoint,
                          Eigen::VectorXf* descriptor);
 
-  // Compute multiple descriptors for keypoints from a single image.
+  // Compute multiple descriptors for keypoints from a single image. The scale
+  // space is built once and only up to the highest octave of the keypoints.
+  // The keypoints of each octave are described in contiguous blocks on
+  // sift_params.num_threads threads. Keypoints must have a scale; keypoints
+  // without an orientation are assigned the dominant SIFT orientation.
   bool ComputeDescriptors(const FloatImage& image,
                           std::vector<Keypoint>* keypoints,
                           std::vector<Eigen::VectorXf>* descriptors);
 
+  // Same as ComputeDescriptors for a batch of images, which are processed in
+  // parallel on num_threads threads. Each thread keeps its own sift filter, so
+  // this does not use the filter of the extractor, and consecutive images of
+  // the same size reuse the filter.
+  bool ComputeDescriptorsOfImages(
+      const std::vector<const FloatImage*>& images,
+      const int num_threads,
+      std::vector<std::vector<Keypoint> >* keypoints,
+      std::vector<std::vector<Eigen::VectorXf> >* descriptors);
+
   // Detect keypoints using the Sift keypoint detector and extracts them at the
   // same time.
   bool DetectAndExtractDescriptors(const FloatImage& image,
                                    std::vector<Keypoint>* keypoints,
                                    std::vector<Eigen::VectorXf>* descriptors);
 
+  // Drops the keypoints that fail the filter right after their detection, so
+  // that their orientations and descriptors are never computed.
+  bool DetectAndExtractFilteredDescriptors(
+      const FloatImage& image,
+      const KeypointPositionFilter& keep_position,
+      std::vector<Keypoint>* keypoints,
+      std::vector<Eigen::VectorXf>* descriptors);
+
   // This method is only public so that we can easily test it.
   static void ConvertToRootSift(Eigen::VectorXf* descriptor);
 
@@ -36,6 +36,7 @@
 #include <gflags/gflags.h>
 #include <glog/logging.h>
 #include <string>
+#include <vector>
 
 #include "theia/image/descriptor/sift_descriptor.h"
 #include "theia/image/image.h"
@@ -100,4 +101,120 @@ TEST(SiftDescriptor, DifferentImageSizes) {
       input_img2, &keypoints, &descriptors));
 }
 
+TEST(SiftDescriptor, MultiThreadedExtractionMatchesSingleThreaded) {
+  FloatImage input_img(img_filename);
+
+  SiftParameters sift_params;
+  SiftDescriptorExtractor single_threaded_extractor(sift_params);
+  std::vector<Keypoint> keypoints;
+  std::vector<Eigen::VectorXf> descriptors;
+  EXPECT_TRUE(single_threaded_extractor.DetectAndExtractDescriptors(
+      input_img, &keypoints, &descriptors));
+
+  sift_params.num_threads = 4;
+  SiftDescriptorExtractor multi_threaded_extractor(sift_params);
+  std::vector<Keypoint> multi_threaded_keypoints;
+  std::vector<Eigen::VectorXf> multi_threaded_descriptors;
+  EXPECT_TRUE(multi_threaded_extractor.DetectAndExtractDescriptors(
+      input_img, &multi_threaded_keypoints, &multi_threaded_descriptors));
+
+  ASSERT_EQ(keypoints.size(), multi_threaded_keypoints.size());
+  ASSERT_EQ(descriptors.size(), multi_threaded_descriptors.size());
+  for (int i = 0; i < keypoints.size(); i++) {
+    EXPECT_EQ(keypoints[i].x(), multi_threaded_keypoints[i].x());
+    EXPECT_EQ(keypoints[i].y(), multi_threaded_keypoints[i].y());
+    EXPECT_EQ(keypoints[i].orientation(),
+              multi_threaded_keypoints[i].orientation());
+    EXPECT_TRUE(descriptors[i] == multi_threaded_descriptors[i]);
+  }
+
+  // Computing the descriptors of given keypoints is multi-threaded as well.
+  std::vector<Eigen::VectorXf> computed_descriptors;
+  EXPECT_TRUE(multi_threaded_extractor.ComputeDescriptors(
+      input_img, &keypoints, &computed_descriptors));
+  EXPECT_EQ(computed_descriptors.size(), keypoints.size());
+}
+
+TEST(SiftDescriptor, ComputeDescriptorsOfImages) {
+  const FloatImage image1(img_filename);
+  const FloatImage image2(THEIA_DATA_DIR + std::string("/image/test1.jpg"));
+  const std::vector<const FloatImage*> images = {&image1, &image2, &image1};
+
+  SiftParameters sift_params;
+  SiftDescriptorExtractor sift_extractor(sift_params);
+  std::vector<std::vector<Keypoint> > keypoints(images.size());
+  std::vector<std::vector<Eigen::VectorXf> > expected_descriptors(
+      images.size());
+  for (int i = 0; i < images.size(); i++) {
+    std::vector<Eigen::VectorXf> detected_descriptors;
+    EXPECT_TRUE(sift_extractor.DetectAndExtractDescriptors(
+        *images[i], &keypoints[i], &detected_descriptors));
+    EXPECT_TRUE(sift_extractor.ComputeDescriptors(
+        *images[i], &keypoints[i], &expected_descriptors[i]));
+  }
+
+  // The batch gives the same descriptors as one image at a time.
+  sift_params.num_threads = 2;
+  SiftDescriptorExtractor batch_extractor(sift_params);
+  std::vector<std::vector<Keypoint> > batch_keypoints = keypoints;
+  std::vector<std::vector<Eigen::VectorXf> > descriptors;
+  EXPECT_TRUE(batch_extractor.ComputeDescriptorsOfImages(
+      images, 2, &batch_keypoints, &descriptors));
+  ASSERT_EQ(descriptors.size(), images.size());
+  for (int i = 0; i < images.size(); i++) {
+    ASSERT_EQ(descriptors[i].size(), expected_descriptors[i].size());
+    for (int j = 0; j < descriptors[i].size(); j++) {
+      EXPECT_TRUE(descriptors[i][j] == expected_descriptors[i][j]);
+    }
+  }
+
+  // Keypoints of an external detector may lack an orientation.
+  std::vector<std::vector<Keypoint> > unoriented_keypoints(1);
+  for (const Keypoint& keypoint : keypoints[0]) {
+    Keypoint unoriented_keypoint(keypoint.x(), keypoint.y(), Keypoint::OTHER);
+    unoriented_keypoint.set_scale(keypoint.scale());
+    unoriented_keypoints[0].emplace_back(unoriented_keypoint);
+  }
+  EXPECT_TRUE(batch_extractor.ComputeDescriptorsOfImages(
+      {&image1}, 1, &unoriented_keypoints, &descriptors));
+  ASSERT_EQ(descriptors[0].size(), keypoints[0].size());
+  for (const Keypoint& keypoint : unoriented_keypoints[0]) {
+    EXPECT_TRUE(keypoint.has_orientation());
+  }
+}
+
+TEST(SiftDescriptor, MaxNumFeatures) {
+  FloatImage input_img(img_filename);
+
+  SiftParameters sift_params;
+  SiftDescriptorExtractor unbounded_extractor(sift_params);
+  std::vector<Keypoint> keypoints;
+  std::vector<Eigen::VectorXf> descriptors;
+  EXPECT_TRUE(unbounded_extractor.DetectAndExtractDescriptors(
+      input_img, &keypoints, &descriptors));
+
+  sift_params.max_num_features = keypoints.size() / 2;
+  SiftDescriptorExtractor bounded_extractor(sift_params);
+  std::vector<Keypoint> bounded_keypoints;
+  std::vector<Eigen::VectorXf> bounded_descriptors;
+  EXPECT_TRUE(bounded_extractor.DetectAndExtractDescriptors(
+      input_img, &bounded_keypoints, &bounded_descriptors));
+  ASSERT_EQ(bounded_keypoints.size(), sift_params.max_num_features);
+  ASSERT_EQ(bounded_descriptors.size(), sift_params.max_num_features);
+
+  // The selected features are a subsequence of the unbounded features since
+  // the scale space is recomputed identically.
+  int j = 0;
+  for (int i = 0; i < bounded_keypoints.size(); i++) {
+    while (j < keypoints.size() &&
+           (keypoints[j].x() != bounded_keypoints[i].x() ||
+            keypoints[j].y() != bounded_keypoints[i].y())) {
+      ++j;
+    }
+    ASSERT_LT(j, keypoints.size());
+    EXPECT_EQ(keypoints[j].strength(), bounded_keypoints[i].strength());
+    EXPECT_TRUE(descriptors[j] == bounded_descriptors[i]);
+  }
+}
+
 }  // namespace theia
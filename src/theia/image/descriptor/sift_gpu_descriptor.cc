@@ -0,0 +1,295 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#include "theia/image/descriptor/sift_gpu_descriptor.h"
+
+#include <SiftGPU/SiftGPU.h>
+#include <glog/logging.h>
+
+#include <Eigen/Core>
+#include <algorithm>
+#include <future>  // NOLINT
+#include <string>
+#include <vector>
+
+#include "theia/image/descriptor/sift_descriptor.h"
+#include "theia/image/image.h"
+#include "theia/image/keypoint_detector/keypoint.h"
+
+namespace theia {
+namespace {
+
+static constexpr int kNumSiftDimensions = 128;
+
+// SiftGPU takes the OpenGL pixel format and type of the image data. These are
+// the values of GL_LUMINANCE and GL_FLOAT so that we do not depend on the
+// OpenGL headers.
+static constexpr unsigned int kGlLuminance = 0x1909;
+static constexpr unsigned int kGlFloat = 0x1406;
+
+typedef Eigen::
+    Matrix<float, Eigen::Dynamic, kNumSiftDimensions, Eigen::RowMajor>
+        SiftGpuDescriptors;
+
+// Maps a coordinate between the original and the downscaled image. Pixel
+// centers are at integer coordinates, so pixel corners are scaled instead.
+double ScaleCoordinate(const double coordinate, const double scale) {
+  return (coordinate + 0.5) * scale - 0.5;
+}
+
+}  // namespace
+
+SiftGpuDescriptorExtractor::SiftGpuDescriptorExtractor(
+    const SiftGpuParameters& params)
+    : params_(params) {}
+
+SiftGpuDescriptorExtractor::~SiftGpuDescriptorExtractor() {}
+
+bool SiftGpuDescriptorExtractor::Initialize() {
+  const SiftParameters& sift_params = params_.sift_params;
+  std::vector<std::string> arguments = {
+      // Use Lowe's convention of keypoint coordinates, which is the one used
+      // by VLFeat.
+      "-loweo",
+      "-v",
+      "0",
+      "-fo",
+      std::to_string(sift_params.first_octave),
+      "-d",
+      std::to_string(sift_params.num_levels),
+      "-t",
+      std::to_string(sift_params.peak_threshold),
+      "-e",
+      std::to_string(sift_params.edge_threshold),
+      "-m",
+      std::to_string(sift_params.upright_sift ? 1 : 4),
+      "-tc2",
+      std::to_string(params_.max_num_features),
+      "-maxd",
+      std::to_string(params_.max_image_dimension)};
+  if (sift_params.num_octaves > 0) {
+    arguments.emplace_back("-no");
+    arguments.emplace_back(std::to_string(sift_params.num_octaves));
+  }
+  if (params_.gpu_index >= 0) {
+    arguments.emplace_back("-cuda");
+    arguments.emplace_back(std::to_string(params_.gpu_index));
+  }
+  std::vector<const char*> argv;
+  for (const std::string& argument : arguments) {
+    argv.emplace_back(argument.c_str());
+  }
+
+  sift_gpu_.reset(CreateNewSiftGPU(1));
+  sift_gpu_->ParseParam(argv.size(), argv.data());
+  if (sift_gpu_->VerifyContextGL() != SiftGPU::SIFTGPU_FULL_SUPPORTED) {
+    LOG(ERROR) << "SiftGPU is not fully supported by the GPU.";
+    sift_gpu_.reset();
+    return false;
+  }
+
+  // Allocate the scale space once for the largest images.
+  if (!sift_gpu_->AllocatePyramid(params_.max_image_dimension,
+                                  params_.max_image_dimension)) {
+    LOG(ERROR) << "Could not allocate the SiftGPU scale space for images of "
+               << params_.max_image_dimension << " pixels.";
+    sift_gpu_.reset();
+    return false;
+  }
+  return true;
+}
+
+bool SiftGpuDescriptorExtractor::ComputeDescriptor(
+    const FloatImage& image,
+    const Keypoint& keypoint,
+    Eigen::VectorXf* descriptor) {
+  std::vector<Keypoint> keypoints = {keypoint};
+  std::vector<Eigen::VectorXf> descriptors;
+  if (!ComputeDescriptors(image, &keypoints, &descriptors) ||
+      descriptors.empty()) {
+    return false;
+  }
+  *CHECK_NOTNULL(descriptor) = descriptors[0];
+  return true;
+}
+
+bool SiftGpuDescriptorExtractor::ComputeDescriptors(
+    const FloatImage& image,
+    std::vector<Keypoint>* keypoints,
+    std::vector<Eigen::VectorXf>* descriptors) {
+  CHECK(sift_gpu_) << "Initialize must be called before extracting features.";
+  double scale;
+  const FloatImage grayscale_image = PrepareImage(image, &scale);
+
+  // The keypoint list is used by the next call to RunSIFT, which then only
+  // computes the descriptors of these keypoints.
+  std::vector<SiftGPU::SiftKeypoint> sift_keypoints(keypoints->size());
+  for (int i = 0; i < keypoints->size(); i++) {
+    const Keypoint& keypoint = (*keypoints)[i];
+    CHECK(keypoint.has_scale() && keypoint.has_orientation())
+        << "Keypoint must have scale and orientation to compute a SIFT "
+        << "descriptor.";
+    sift_keypoints[i].x = ScaleCoordinate(keypoint.x(), scale);
+    sift_keypoints[i].y = ScaleCoordinate(keypoint.y(), scale);
+    sift_keypoints[i].s = keypoint.scale() * scale;
+    sift_keypoints[i].o = keypoint.orientation();
+  }
+  sift_gpu_->SetKeypointList(sift_keypoints.size(), sift_keypoints.data(), 1);
+
+  std::vector<Keypoint> computed_keypoints;
+  descriptors->clear();
+  if (!DetectAndExtractPreparedDescriptors(
+          grayscale_image, scale, &computed_keypoints, descriptors)) {
+    return false;
+  }
+  if (descriptors->size() != keypoints->size()) {
+    LOG(ERROR) << "SiftGPU computed " << descriptors->size()
+               << " descriptors for " << keypoints->size() << " keypoints.";
+    return false;
+  }
+  return true;
+}
+
+bool SiftGpuDescriptorExtractor::DetectAndExtractDescriptors(
+    const FloatImage& image,
+    std::vector<Keypoint>* keypoints,
+    std::vector<Eigen::VectorXf>* descriptors) {
+  CHECK(sift_gpu_) << "Initialize must be called before extracting features.";
+  double scale;
+  const FloatImage grayscale_image = PrepareImage(image, &scale);
+  return DetectAndExtractPreparedDescriptors(
+      grayscale_image, scale, keypoints, descriptors);
+}
+
+bool SiftGpuDescriptorExtractor::DetectAndExtractDescriptorsInBatch(
+    const std::vector<const FloatImage*>& images,
+    std::vector<std::vector<Keypoint> >* keypoints,
+    std::vector<std::vector<Eigen::VectorXf> >* descriptors) {
+  CHECK(sift_gpu_) << "Initialize must be called before extracting features.";
+  keypoints->resize(images.size());
+  descriptors->resize(images.size());
+  if (images.empty()) {
+    return true;
+  }
+
+  const auto prepare_image = [this](const FloatImage* image, double* scale) {
+    return PrepareImage(*image, scale);
+  };
+  std::vector<double> scales(images.size());
+  std::future<FloatImage> next_image =
+      std::async(std::launch::async, prepare_image, images[0], &scales[0]);
+  bool success = true;
+  for (int i = 0; i < images.size(); i++) {
+    const FloatImage grayscale_image = next_image.get();
+    if (i + 1 < images.size()) {
+      next_image = std::async(
+          std::launch::async, prepare_image, images[i + 1], &scales[i + 1]);
+    }
+    if (!DetectAndExtractPreparedDescriptors(grayscale_image,
+                                             scales[i],
+                                             &(*keypoints)[i],
+                                             &(*descriptors)[i])) {
+      success = false;
+    }
+  }
+  return success;
+}
+
+void SiftGpuDescriptorExtractor::ConvertToVlFeatDescriptorLayout(
+    Eigen::VectorXf* descriptor) {
+  static const int kNumOrientationBins = 8;
+  for (int i = 0; i < kNumSiftDimensions; i += kNumOrientationBins) {
+    std::reverse(descriptor->data() + i + 1,
+                 descriptor->data() + i + kNumOrientationBins);
+  }
+}
+
+FloatImage SiftGpuDescriptorExtractor::PrepareImage(const FloatImage& image,
+                                                    double* scale) const {
+  FloatImage grayscale_image = image.AsGrayscaleImage();
+  const int max_dimension = std::max(image.Width(), image.Height());
+  *scale = 1.0;
+  if (max_dimension > params_.max_image_dimension) {
+    *scale = static_cast<double>(params_.max_image_dimension) / max_dimension;
+    grayscale_image.Resize(*scale);
+  }
+  return grayscale_image;
+}
+
+bool SiftGpuDescriptorExtractor::DetectAndExtractPreparedDescriptors(
+    const FloatImage& grayscale_image,
+    const double scale,
+    std::vector<Keypoint>* keypoints,
+    std::vector<Eigen::VectorXf>* descriptors) {
+  if (!sift_gpu_->RunSIFT(grayscale_image.Width(),
+                          grayscale_image.Height(),
+                          grayscale_image.Data(),
+                          kGlLuminance,
+                          kGlFloat)) {
+    LOG(ERROR) << "SiftGPU could not extract features.";
+    return false;
+  }
+  GetFeatures(scale, keypoints, descriptors);
+  return true;
+}
+
+void SiftGpuDescriptorExtractor::GetFeatures(
+    const double scale,
+    std::vector<Keypoint>* keypoints,
+    std::vector<Eigen::VectorXf>* descriptors) {
+  const int num_features = sift_gpu_->GetFeatureNum();
+  std::vector<SiftGPU::SiftKeypoint> sift_keypoints(num_features);
+  SiftGpuDescriptors sift_descriptors(num_features, kNumSiftDimensions);
+  sift_gpu_->GetFeatureVector(sift_keypoints.data(), sift_descriptors.data());
+
+  keypoints->reserve(keypoints->size() + num_features);
+  descriptors->reserve(descriptors->size() + num_features);
+  for (int i = 0; i < num_features; i++) {
+    Keypoint keypoint(ScaleCoordinate(sift_keypoints[i].x, 1.0 / scale),
+                      ScaleCoordinate(sift_keypoints[i].y, 1.0 / scale),
+                      Keypoint::SIFT);
+    keypoint.set_scale(sift_keypoints[i].s / scale);
+    keypoint.set_orientation(sift_keypoints[i].o);
+    keypoints->emplace_back(keypoint);
+
+    Eigen::VectorXf descriptor = sift_descriptors.row(i).transpose();
+    ConvertToVlFeatDescriptorLayout(&descriptor);
+    if (params_.sift_params.root_sift) {
+      SiftDescriptorExtractor::ConvertToRootSift(&descriptor);
+    }
+    descriptors->emplace_back(descriptor);
+  }
+}
+
+}  // namespace theia
@@ -0,0 +1,150 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#ifndef THEIA_IMAGE_DESCRIPTOR_SIFT_GPU_DESCRIPTOR_H_
+#define THEIA_IMAGE_DESCRIPTOR_SIFT_GPU_DESCRIPTOR_H_
+
+#include <Eigen/Core>
+#include <memory>
+#include <vector>
+
+#include "theia/image/descriptor/descriptor_extractor.h"
+#include "theia/image/keypoint_detector/sift_parameters.h"
+#include "theia/util/util.h"
+
+class SiftGPU;
+
+namespace theia {
+
+class FloatImage;
+class Keypoint;
+
+// Parameters of the GPU SIFT extractor. The detector and descriptor parameters
+// are shared with the VLFeat extractor so that both produce comparable
+// features.
+struct SiftGpuParameters {
+  SiftParameters sift_params;
+
+  // The CUDA device to use, or -1 to use the OpenGL (GLSL) implementation in
+  // the current OpenGL context.
+  int gpu_index = -1;
+
+  // Images whose largest dimension exceeds this value are downscaled before
+  // they are uploaded to the GPU so that the scale space fits into the GPU
+  // memory that is allocated once at initialization. The keypoints are
+  // returned in the coordinates of the original image.
+  int max_image_dimension = 3200;
+
+  // The maximum number of features extracted per image. The features at the
+  // coarsest scales are kept.
+  int max_num_features = 8192;
+};
+
+// SIFT extractor that runs on the GPU with SiftGPU
+// (https://github.com/pitzer/SiftGPU). Keypoints use the same conventions as
+// the VLFeat extractor (the center of the top-left pixel is at (0, 0) and the
+// scale is the keypoint sigma), and descriptors are returned in the VLFeat
+// layout, so the features can be matched against features extracted by
+// SiftDescriptorExtractor.
+//
+// The OpenGL context or CUDA device is bound to the thread that calls
+// Initialize, so each extraction thread must create its own extractor. This
+// extractor is only available if Theia is built with WITH_SIFTGPU.
+class SiftGpuDescriptorExtractor : public DescriptorExtractor {
+ public:
+  explicit SiftGpuDescriptorExtractor(const SiftGpuParameters& params);
+  ~SiftGpuDescriptorExtractor();
+
+  // Creates the SiftGPU context and allocates the scale space on the GPU for
+  // images of up to max_image_dimension pixels. Returns false if the GPU does
+  // not support SiftGPU.
+  bool Initialize();
+
+  // Computes a descriptor at a single keypoint.
+  bool ComputeDescriptor(const FloatImage& image,
+                         const Keypoint& keypoint,
+                         Eigen::VectorXf* descriptor);
+
+  // Compute multiple descriptors for keypoints from a single image.
+  bool ComputeDescriptors(const FloatImage& image,
+                          std::vector<Keypoint>* keypoints,
+                          std::vector<Eigen::VectorXf>* descriptors);
+
+  // Detect keypoints using the Sift keypoint detector and extracts them at the
+  // same time.
+  bool DetectAndExtractDescriptors(const FloatImage& image,
+                                   std::vector<Keypoint>* keypoints,
+                                   std::vector<Eigen::VectorXf>* descriptors);
+
+  // Detects keypoints and extracts descriptors for a batch of images. The next
+  // image is converted to a grayscale image of the GPU resolution on the CPU
+  // while the GPU processes the current image, so the GPU does not wait for
+  // the host between images.
+  bool DetectAndExtractDescriptorsInBatch(
+      const std::vector<const FloatImage*>& images,
+      std::vector<std::vector<Keypoint> >* keypoints,
+      std::vector<std::vector<Eigen::VectorXf> >* descriptors);
+
+  // SiftGPU orders the orientation bins of each spatial bin of the descriptor
+  // as in Lowe's implementation, which is the reverse of the VLFeat order
+  // (except for the first bin). This method is only public so that we can
+  // easily test it.
+  static void ConvertToVlFeatDescriptorLayout(Eigen::VectorXf* descriptor);
+
+ private:
+  // Converts the image to a grayscale image that is no larger than
+  // max_image_dimension, and returns the scale that was applied.
+  FloatImage PrepareImage(const FloatImage& image, double* scale) const;
+
+  // Runs the detection and description on an image returned by PrepareImage.
+  bool DetectAndExtractPreparedDescriptors(
+      const FloatImage& grayscale_image,
+      const double scale,
+      std::vector<Keypoint>* keypoints,
+      std::vector<Eigen::VectorXf>* descriptors);
+
+  // Reads the features of the last run from the GPU.
+  void GetFeatures(const double scale,
+                   std::vector<Keypoint>* keypoints,
+                   std::vector<Eigen::VectorXf>* descriptors);
+
+  const SiftGpuParameters params_;
+  std::unique_ptr<SiftGPU> sift_gpu_;
+
+  DISALLOW_COPY_AND_ASSIGN(SiftGpuDescriptorExtractor);
+};
+
+}  // namespace theia
+
+#endif  // THEIA_IMAGE_DESCRIPTOR_SIFT_GPU_DESCRIPTOR_H_
@@ -0,0 +1,66 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#include <Eigen/Core>
+
+#include "gtest/gtest.h"
+
+#include "theia/image/descriptor/sift_gpu_descriptor.h"
+
+namespace theia {
+
+TEST(SiftGpuDescriptor, ConvertToVlFeatDescriptorLayout) {
+  Eigen::VectorXf descriptor(128);
+  for (int i = 0; i < descriptor.size(); i++) {
+    descriptor[i] = i;
+  }
+  SiftGpuDescriptorExtractor::ConvertToVlFeatDescriptorLayout(&descriptor);
+
+  // The first orientation bin of each spatial bin stays in place and the
+  // remaining bins are reversed.
+  static const int kVlFeatOrder[8] = {0, 7, 6, 5, 4, 3, 2, 1};
+  for (int i = 0; i < 16; i++) {
+    for (int j = 0; j < 8; j++) {
+      EXPECT_EQ(descriptor[8 * i + j], 8 * i + kVlFeatOrder[j]);
+    }
+  }
+
+  // The conversion is its own inverse.
+  Eigen::VectorXf converted = descriptor;
+  SiftGpuDescriptorExtractor::ConvertToVlFeatDescriptorLayout(&converted);
+  SiftGpuDescriptorExtractor::ConvertToVlFeatDescriptorLayout(&converted);
+  EXPECT_TRUE(converted == descriptor);
+}
+
+}  // namespace theia
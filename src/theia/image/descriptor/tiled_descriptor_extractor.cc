@@ -0,0 +1,325 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#include "theia/image/descriptor/tiled_descriptor_extractor.h"
+
+#include <Eigen/Core>
+#include <OpenImageIO/imagebuf.h>
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <atomic>
+#include <limits>
+#include <memory>
+#include <numeric>
+#include <string>
+#include <vector>
+
+#include "theia/image/image.h"
+#include "theia/image/image_mask.h"
+#include "theia/image/keypoint_detector/keypoint.h"
+#include "theia/util/executor.h"
+
+namespace theia {
+
+namespace {
+
+// Masks are small bitmaps, so the default cache holds the masks of many
+// cameras.
+static const size_t kDefaultMaskCacheSizeInBytes = 256 * 1024 * 1024;
+
+struct Tile {
+  // The region owned by the tile and the region that is read from the image.
+  oiio::ROI core;
+  oiio::ROI padded;
+};
+
+std::vector<Tile> ComputeTiles(const int width,
+                               const int height,
+                               const int tile_size,
+                               const int tile_overlap) {
+  std::vector<Tile> tiles;
+  for (int y = 0; y < height; y += tile_size) {
+    for (int x = 0; x < width; x += tile_size) {
+      Tile tile;
+      tile.core = oiio::ROI(x,
+                            std::min(x + tile_size, width),
+                            y,
+                            std::min(y + tile_size, height));
+      tile.padded = oiio::ROI(std::max(x - tile_overlap, 0),
+                              std::min(x + tile_size + tile_overlap, width),
+                              std::max(y - tile_overlap, 0),
+                              std::min(y + tile_size + tile_overlap, height));
+      tiles.emplace_back(tile);
+    }
+  }
+  return tiles;
+}
+
+// Reads the pixels of all channels in the region into the tile, which must
+// have the size of the region.
+bool ReadTile(const oiio::ImageBuf& image,
+              const oiio::ROI& region,
+              FloatImage* tile) {
+  oiio::ROI roi = region;
+  roi.chbegin = 0;
+  roi.chend = image.nchannels();
+  return image.get_pixels(roi, oiio::TypeDesc::FLOAT, tile->Data());
+}
+
+// Keeps the strongest features, or the first ones if the keypoints have no
+// strength. The kept features stay in the order of the detector.
+void KeepStrongestFeatures(const int max_num_features,
+                           std::vector<Keypoint>* keypoints,
+                           std::vector<Eigen::VectorXf>* descriptors) {
+  if (keypoints->size() <= max_num_features) {
+    return;
+  }
+
+  std::vector<int> indices(keypoints->size());
+  std::iota(indices.begin(), indices.end(), 0);
+  std::stable_sort(
+      indices.begin(), indices.end(), [keypoints](const int i, const int j) {
+        const Keypoint& a = (*keypoints)[i];
+        const Keypoint& b = (*keypoints)[j];
+        if (a.has_strength() && b.has_strength()) {
+          return a.strength() > b.strength();
+        }
+        return a.has_strength() && !b.has_strength();
+      });
+  indices.resize(max_num_features);
+  std::sort(indices.begin(), indices.end());
+
+  for (int i = 0; i < indices.size(); i++) {
+    (*keypoints)[i] = (*keypoints)[indices[i]];
+    (*descriptors)[i] = (*descriptors)[indices[i]];
+  }
+  keypoints->resize(max_num_features);
+  descriptors->resize(max_num_features);
+}
+
+// Extracts the features of all tiles. The mask may be null.
+bool ExtractFromTiles(
+    const TiledExtractionOptions& options,
+    const TiledDescriptorExtractor::CreateDescriptorExtractorFunction&
+        create_descriptor_extractor,
+    const oiio::ImageBuf& image,
+    const ImageMask* mask,
+    std::vector<Keypoint>* keypoints,
+    std::vector<Eigen::VectorXf>* descriptors) {
+  CHECK_NOTNULL(keypoints)->clear();
+  CHECK_NOTNULL(descriptors)->clear();
+
+  const std::vector<Tile> tiles = ComputeTiles(image.spec().width,
+                                               image.spec().height,
+                                               options.tile_size,
+                                               options.tile_overlap);
+  std::vector<std::vector<Keypoint> > tile_keypoints(tiles.size());
+  std::vector<std::vector<Eigen::VectorXf> > tile_descriptors(tiles.size());
+
+  // Tiles vary a lot in cost (e.g. water vs. buildings in aerial images), so
+  // each thread pulls the next tile from a shared counter and reuses its own
+  // descriptor extractor for all of its tiles.
+  std::atomic<int> next_tile(0);
+  std::atomic<bool> success(true);
+  const auto process_tiles = [&]() {
+    std::unique_ptr<DescriptorExtractor> descriptor_extractor =
+        create_descriptor_extractor();
+    if (!descriptor_extractor->Initialize()) {
+      LOG(ERROR) << "Could not initialize the descriptor extractor.";
+      success = false;
+      return;
+    }
+
+    for (int i = next_tile++; i < tiles.size() && success; i = next_tile++) {
+      const Tile& tile = tiles[i];
+      const int width = tile.padded.width();
+      const int height = tile.padded.height();
+
+      if (mask != nullptr && !mask->HasUnmaskedPixels(tile.core.xbegin,
+                                                      tile.core.xend,
+                                                      tile.core.ybegin,
+                                                      tile.core.yend)) {
+        continue;
+      }
+
+      FloatImage image_tile(width, height, image.nchannels());
+      if (!ReadTile(image, tile.padded, &image_tile)) {
+        LOG(ERROR) << "Could not read the pixels of tile " << i;
+        success = false;
+        return;
+      }
+
+      // Keep the keypoints in the core of the tile that are not masked out.
+      // The core of a tile at the image border extends past the border since
+      // keypoints may be located slightly outside of the image. The keypoints
+      // are culled before their descriptors are computed if the extractor
+      // supports it.
+      const double kInfinity = std::numeric_limits<double>::infinity();
+      const double min_x =
+          tile.core.xbegin == 0 ? -kInfinity : tile.core.xbegin;
+      const double max_x =
+          tile.core.xend == image.spec().width ? kInfinity : tile.core.xend;
+      const double min_y =
+          tile.core.ybegin == 0 ? -kInfinity : tile.core.ybegin;
+      const double max_y =
+          tile.core.yend == image.spec().height ? kInfinity : tile.core.yend;
+      const auto keep_position = [&](const double tile_x, const double tile_y) {
+        const double x = tile_x + tile.padded.xbegin;
+        const double y = tile_y + tile.padded.ybegin;
+        return x >= min_x && x < max_x && y >= min_y && y < max_y &&
+               (mask == nullptr || mask->IsUnmasked(x, y));
+      };
+
+      std::vector<Keypoint>& kept_keypoints = tile_keypoints[i];
+      std::vector<Eigen::VectorXf>& kept_descriptors = tile_descriptors[i];
+      if (!descriptor_extractor->DetectAndExtractFilteredDescriptors(
+              image_tile, keep_position, &kept_keypoints, &kept_descriptors)) {
+        LOG(ERROR) << "Could not extract descriptors in tile " << i;
+        success = false;
+        return;
+      }
+      for (Keypoint& keypoint : kept_keypoints) {
+        keypoint.set_x(keypoint.x() + tile.padded.xbegin);
+        keypoint.set_y(keypoint.y() + tile.padded.ybegin);
+      }
+
+      if (options.max_num_features_per_tile > 0) {
+        KeepStrongestFeatures(options.max_num_features_per_tile,
+                              &kept_keypoints,
+                              &kept_descriptors);
+      }
+    }
+  };
+
+  const int num_threads =
+      std::min(options.num_threads, static_cast<int>(tiles.size()));
+  // The calling thread processes tiles as well, so the tiles are finished even
+  // if all threads of the executor are busy.
+  TaskGroup task_group;
+  for (int i = 1; i < num_threads; i++) {
+    task_group.Run(process_tiles);
+  }
+  process_tiles();
+  task_group.Wait();
+  if (!success) {
+    return false;
+  }
+
+  // Concatenate the features in tile order so that the result does not depend
+  // on the number of threads.
+  for (int i = 0; i < tiles.size(); i++) {
+    keypoints->insert(
+        keypoints->end(), tile_keypoints[i].begin(), tile_keypoints[i].end());
+    descriptors->insert(descriptors->end(),
+                        tile_descriptors[i].begin(),
+                        tile_descriptors[i].end());
+  }
+  return true;
+}
+
+}  // namespace
+
+TiledDescriptorExtractor::TiledDescriptorExtractor(
+    const TiledExtractionOptions& options,
+    const CreateDescriptorExtractorFunction& create_descriptor_extractor)
+    : options_(options),
+      create_descriptor_extractor_(create_descriptor_extractor),
+      mask_cache_(options.mask_cache) {
+  CHECK_GT(options_.tile_size, 0);
+  CHECK_GE(options_.tile_overlap, 0);
+  CHECK_GT(options_.num_threads, 0);
+  if (mask_cache_ == nullptr) {
+    mask_cache_ = std::make_shared<ImageMaskCache>(
+        options_.mask_cell_size, kDefaultMaskCacheSizeInBytes);
+  }
+}
+
+bool TiledDescriptorExtractor::DetectAndExtractDescriptors(
+    const std::string& image_filepath,
+    const std::string& mask_filepath,
+    std::vector<Keypoint>* keypoints,
+    std::vector<Eigen::VectorXf>* descriptors) {
+  // Only the header is read here. The pixels of each tile are read on demand
+  // when the tile is processed, which lets OpenImageIO back the image with its
+  // image cache instead of decoding the whole image into memory.
+  oiio::ImageBuf image;
+  if (!image.init_spec(image_filepath, 0, 0)) {
+    LOG(ERROR) << "Could not read the image " << image_filepath;
+    return false;
+  }
+
+  if (mask_filepath.empty()) {
+    return ExtractFromTiles(options_,
+                            create_descriptor_extractor_,
+                            image,
+                            nullptr,
+                            keypoints,
+                            descriptors);
+  }
+
+  // The mask is decoded once and shared with every other image that uses it.
+  const std::shared_ptr<const ImageMask> mask =
+      mask_cache_->FetchMask(mask_filepath);
+  if (mask == nullptr) {
+    return false;
+  }
+  CHECK(mask->Width() == image.spec().width &&
+        mask->Height() == image.spec().height)
+      << "The image and the mask don't have the same size. \n"
+      << "- Image: " << image_filepath << "\t(" << image.spec().width << " x "
+      << image.spec().height << ")\n"
+      << "- Mask: " << mask_filepath << "\t(" << mask->Width() << " x "
+      << mask->Height() << ")";
+  return ExtractFromTiles(options_,
+                          create_descriptor_extractor_,
+                          image,
+                          mask.get(),
+                          keypoints,
+                          descriptors);
+}
+
+bool TiledDescriptorExtractor::DetectAndExtractDescriptors(
+    const FloatImage& image,
+    std::vector<Keypoint>* keypoints,
+    std::vector<Eigen::VectorXf>* descriptors) {
+  return ExtractFromTiles(options_,
+                          create_descriptor_extractor_,
+                          image.GetOpenImageIOImageBuf(),
+                          nullptr,
+                          keypoints,
+                          descriptors);
+}
+
+}  // namespace theia
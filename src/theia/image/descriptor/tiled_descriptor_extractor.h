@@ -0,0 +1,131 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#ifndef THEIA_IMAGE_DESCRIPTOR_TILED_DESCRIPTOR_EXTRACTOR_H_
+#define THEIA_IMAGE_DESCRIPTOR_TILED_DESCRIPTOR_EXTRACTOR_H_
+
+#include <Eigen/Core>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "theia/image/descriptor/descriptor_extractor.h"
+#include "theia/util/util.h"
+
+namespace theia {
+
+class FloatImage;
+class ImageMaskCache;
+class Keypoint;
+
+struct TiledExtractionOptions {
+  // The image is split into a grid of tiles of tile_size x tile_size pixels.
+  // Each tile is extended by tile_overlap pixels on every side before the
+  // features are extracted so that keypoints near the tile borders see their
+  // full support region. The overlap should cover the descriptor support of
+  // the coarsest scale that matters.
+  int tile_size = 4096;
+  int tile_overlap = 128;
+
+  // At most this many features are kept in each tile, which spreads the
+  // features uniformly over the image. The strongest features are kept. No
+  // limit is applied if the value is not positive.
+  int max_num_features_per_tile = 4096;
+
+  // Number of threads used to process the tiles of an image.
+  int num_threads = 1;
+
+  // Masks are decoded into bitmaps with one bit per mask_cell_size x
+  // mask_cell_size pixels (see ImageMask). Larger cells use less memory but
+  // cull keypoints at a coarser resolution.
+  int mask_cell_size = 1;
+
+  // Decoded masks are kept in this cache so that a mask shared by many images
+  // (e.g. a fixed vehicle hood mask for every frame of a camera) is only read
+  // once. Extractors may share a cache; its cell size overrides mask_cell_size.
+  // If it is null the extractor creates its own cache.
+  std::shared_ptr<ImageMaskCache> mask_cache;
+};
+
+// Extracts features from very large images (e.g. gigapixel aerial mosaics or
+// panoramas) by running a descriptor extractor on overlapping tiles. Tiles are
+// read from the image file on demand through OpenImageIO, so the full image is
+// never held in memory, and tiles are processed in parallel which balances the
+// load much better than a single extraction over the whole image.
+//
+// Each tile owns the keypoints that lie in its core, i.e. the tile without the
+// overlap. Keypoints that are detected in the overlap of a tile are dropped
+// since the neighboring tile detects them in its core, so no keypoint is
+// returned twice. Keypoints are returned in the coordinates of the full image.
+//
+// Only float descriptors are supported.
+class TiledDescriptorExtractor {
+ public:
+  // Each thread creates its own extractor with this function since extractors
+  // are not thread-safe.
+  typedef std::function<std::unique_ptr<DescriptorExtractor>()>
+      CreateDescriptorExtractorFunction;
+
+  TiledDescriptorExtractor(
+      const TiledExtractionOptions& options,
+      const CreateDescriptorExtractorFunction& create_descriptor_extractor);
+  ~TiledDescriptorExtractor() {}
+
+  // Extracts the features of the image file. If a mask file is given, tiles
+  // that are entirely masked out are skipped and keypoints in the black parts
+  // of the mask are removed before their descriptors are computed, if the
+  // descriptor extractor supports it. The mask must have the same size as the
+  // image.
+  bool DetectAndExtractDescriptors(const std::string& image_filepath,
+                                   const std::string& mask_filepath,
+                                   std::vector<Keypoint>* keypoints,
+                                   std::vector<Eigen::VectorXf>* descriptors);
+
+  // Extracts the features of an image that is already in memory.
+  bool DetectAndExtractDescriptors(const FloatImage& image,
+                                   std::vector<Keypoint>* keypoints,
+                                   std::vector<Eigen::VectorXf>* descriptors);
+
+ private:
+  const TiledExtractionOptions options_;
+  const CreateDescriptorExtractorFunction create_descriptor_extractor_;
+  std::shared_ptr<ImageMaskCache> mask_cache_;
+
+  DISALLOW_COPY_AND_ASSIGN(TiledDescriptorExtractor);
+};
+
+}  // namespace theia
+
+#endif  // THEIA_IMAGE_DESCRIPTOR_TILED_DESCRIPTOR_EXTRACTOR_H_
@@ -0,0 +1,155 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#include <Eigen/Core>
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "theia/image/descriptor/sift_descriptor.h"
+#include "theia/image/descriptor/tiled_descriptor_extractor.h"
+#include "theia/image/image.h"
+#include "theia/image/keypoint_detector/keypoint.h"
+
+namespace theia {
+
+namespace {
+
+const std::string img_filename =
+    THEIA_DATA_DIR + std::string("/image/descriptor/img1.png");
+
+std::unique_ptr<DescriptorExtractor> CreateSiftExtractor() {
+  return std::unique_ptr<DescriptorExtractor>(new SiftDescriptorExtractor());
+}
+
+}  // namespace
+
+TEST(TiledDescriptorExtractor, SingleTileMatchesUntiledExtraction) {
+  const FloatImage image(img_filename);
+  SiftDescriptorExtractor sift_extractor;
+  std::vector<Keypoint> keypoints;
+  std::vector<Eigen::VectorXf> descriptors;
+  EXPECT_TRUE(sift_extractor.DetectAndExtractDescriptors(
+      image, &keypoints, &descriptors));
+
+  TiledExtractionOptions options;
+  options.tile_size = std::max(image.Width(), image.Height());
+  options.max_num_features_per_tile = 0;
+  TiledDescriptorExtractor tiled_extractor(options, CreateSiftExtractor);
+  std::vector<Keypoint> tiled_keypoints;
+  std::vector<Eigen::VectorXf> tiled_descriptors;
+  EXPECT_TRUE(tiled_extractor.DetectAndExtractDescriptors(
+      img_filename, "", &tiled_keypoints, &tiled_descriptors));
+
+  ASSERT_EQ(keypoints.size(), tiled_keypoints.size());
+  for (int i = 0; i < keypoints.size(); i++) {
+    EXPECT_EQ(keypoints[i].x(), tiled_keypoints[i].x());
+    EXPECT_EQ(keypoints[i].y(), tiled_keypoints[i].y());
+    EXPECT_EQ(descriptors[i], tiled_descriptors[i]);
+  }
+}
+
+TEST(TiledDescriptorExtractor, OverlappingTilesDoNotDuplicateKeypoints) {
+  const FloatImage image(img_filename);
+  TiledExtractionOptions options;
+  options.tile_size = 128;
+  options.tile_overlap = 32;
+  options.max_num_features_per_tile = 0;
+  options.num_threads = 4;
+  TiledDescriptorExtractor tiled_extractor(options, CreateSiftExtractor);
+  std::vector<Keypoint> keypoints;
+  std::vector<Eigen::VectorXf> descriptors;
+  EXPECT_TRUE(tiled_extractor.DetectAndExtractDescriptors(
+      image, &keypoints, &descriptors));
+  EXPECT_GT(keypoints.size(), 0);
+  EXPECT_EQ(keypoints.size(), descriptors.size());
+
+  // Keypoints are returned in the coordinates of the full image.
+  for (const Keypoint& keypoint : keypoints) {
+    EXPECT_GT(keypoint.x(), -1.0);
+    EXPECT_LT(keypoint.x(), image.Width());
+    EXPECT_GT(keypoint.y(), -1.0);
+    EXPECT_LT(keypoint.y(), image.Height());
+  }
+
+  // Repeating the extraction with a single thread gives the same features.
+  options.num_threads = 1;
+  TiledDescriptorExtractor single_threaded_extractor(options,
+                                                     CreateSiftExtractor);
+  std::vector<Keypoint> single_threaded_keypoints;
+  std::vector<Eigen::VectorXf> single_threaded_descriptors;
+  EXPECT_TRUE(single_threaded_extractor.DetectAndExtractDescriptors(
+      image, &single_threaded_keypoints, &single_threaded_descriptors));
+  ASSERT_EQ(keypoints.size(), single_threaded_keypoints.size());
+  for (int i = 0; i < keypoints.size(); i++) {
+    EXPECT_EQ(keypoints[i].x(), single_threaded_keypoints[i].x());
+    EXPECT_EQ(keypoints[i].y(), single_threaded_keypoints[i].y());
+  }
+}
+
+TEST(TiledDescriptorExtractor, FeatureBudgetPerTile) {
+  const FloatImage image(img_filename);
+  static const int kMaxNumFeaturesPerTile = 5;
+  TiledExtractionOptions options;
+  options.tile_size = 128;
+  options.tile_overlap = 32;
+  options.max_num_features_per_tile = kMaxNumFeaturesPerTile;
+  TiledDescriptorExtractor tiled_extractor(options, CreateSiftExtractor);
+  std::vector<Keypoint> keypoints;
+  std::vector<Eigen::VectorXf> descriptors;
+  EXPECT_TRUE(tiled_extractor.DetectAndExtractDescriptors(
+      image, &keypoints, &descriptors));
+
+  const int num_tiles_x =
+      (image.Width() + options.tile_size - 1) / options.tile_size;
+  const int num_tiles_y =
+      (image.Height() + options.tile_size - 1) / options.tile_size;
+  std::vector<int> num_features_per_tile(num_tiles_x * num_tiles_y, 0);
+  for (const Keypoint& keypoint : keypoints) {
+    const int tile_x = std::min(
+        std::max(static_cast<int>(keypoint.x()), 0) / options.tile_size,
+        num_tiles_x - 1);
+    const int tile_y = std::min(
+        std::max(static_cast<int>(keypoint.y()), 0) / options.tile_size,
+        num_tiles_y - 1);
+    ++num_features_per_tile[tile_y * num_tiles_x + tile_x];
+  }
+  for (const int num_features : num_features_per_tile) {
+    EXPECT_LE(num_features, kMaxNumFeaturesPerTile);
+  }
+}
+
+}  // namespace theia
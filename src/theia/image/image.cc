@@ -38,6 +38,11 @@
 #include <OpenImageIO/imagebuf.h>
 #include <OpenImageIO/imagebufalgo.h>
 #include <glog/logging.h>
+#ifdef WITH_LIBJPEG
+#include <csetjmp>
+#include <cstdio>
+#include <jpeglib.h>
+#endif  // WITH_LIBJPEG
 
 #include <algorithm>
 #include <cmath>
@@ -46,15 +51,173 @@
 #include <string>
 #include <vector>
 
+#include "theia/image/image_filters.h"
 #include "theia/util/util.h"
 
 namespace theia {
 
+namespace {
+
+#ifdef WITH_LIBJPEG
+// libjpeg calls exit() on errors by default, so errors jump back to the
+// decoder instead.
+struct JpegErrorManager {
+  jpeg_error_mgr pub;
+  jmp_buf setjmp_buffer;
+};
+
+void JpegErrorExit(j_common_ptr cinfo) {
+  char message[JMSG_LENGTH_MAX];
+  (*cinfo->err->format_message)(cinfo, message);
+  VLOG(2) << "Could not decode JPEG image: " << message;
+  JpegErrorManager* error_manager =
+      reinterpret_cast<JpegErrorManager*>(cinfo->err);
+  longjmp(error_manager->setjmp_buffer, 1);
+}
+
+bool IsJpegFile(FILE* file) {
+  unsigned char magic[2];
+  const bool is_jpeg = fread(magic, 1, 2, file) == 2 && magic[0] == 0xFF &&
+                       magic[1] == 0xD8;
+  rewind(file);
+  return is_jpeg;
+}
+
+// Decodes a JPEG image at 1 / scale_denominator of the full resolution into
+// 8-bit pixels with libjpeg DCT scaling. No C++ objects may be constructed
+// between setjmp and the end of the decoding since longjmp does not call
+// destructors, so the pixel buffer is owned by the caller.
+bool DecodeJpegAtScale(FILE* file,
+                       const int scale_denominator,
+                       int* width,
+                       int* height,
+                       int* channels,
+                       std::vector<unsigned char>* pixels) {
+  jpeg_decompress_struct cinfo;
+  JpegErrorManager error_manager;
+  cinfo.err = jpeg_std_error(&error_manager.pub);
+  error_manager.pub.error_exit = JpegErrorExit;
+  if (setjmp(error_manager.setjmp_buffer)) {
+    jpeg_destroy_decompress(&cinfo);
+    return false;
+  }
+
+  jpeg_create_decompress(&cinfo);
+  jpeg_stdio_src(&cinfo, file);
+  jpeg_read_header(&cinfo, TRUE);
+  // CMYK images are left to OpenImageIO.
+  if (cinfo.num_components != 1 && cinfo.num_components != 3) {
+    jpeg_destroy_decompress(&cinfo);
+    return false;
+  }
+  cinfo.out_color_space =
+      cinfo.num_components == 1 ? JCS_GRAYSCALE : JCS_RGB;
+  cinfo.scale_num = 1;
+  cinfo.scale_denom = scale_denominator;
+  jpeg_start_decompress(&cinfo);
+
+  *width = cinfo.output_width;
+  *height = cinfo.output_height;
+  *channels = cinfo.output_components;
+  const int row_stride = *width * *channels;
+  pixels->resize(static_cast<size_t>(row_stride) * *height);
+  while (cinfo.output_scanline < cinfo.output_height) {
+    JSAMPROW row = pixels->data() +
+                   static_cast<size_t>(cinfo.output_scanline) * row_stride;
+    jpeg_read_scanlines(&cinfo, &row, 1);
+  }
+
+  jpeg_finish_decompress(&cinfo);
+  jpeg_destroy_decompress(&cinfo);
+  return true;
+}
+
+// Reads the JPEG image with libjpeg if possible. Returns false if the file is
+// not a JPEG image that libjpeg can downscale.
+bool ReadJpegAtScale(const std::string& filename,
+                     const int scale_denominator,
+                     const oiio::TypeDesc& pixel_type,
+                     oiio::ImageBuf* image) {
+  if (scale_denominator != 1 && scale_denominator != 2 &&
+      scale_denominator != 4 && scale_denominator != 8) {
+    return false;
+  }
+
+  FILE* file = fopen(filename.c_str(), "rb");
+  if (file == nullptr) {
+    return false;
+  }
+  int width, height, channels;
+  std::vector<unsigned char> pixels;
+  const bool success =
+      IsJpegFile(file) && DecodeJpegAtScale(file,
+                                            scale_denominator,
+                                            &width,
+                                            &height,
+                                            &channels,
+                                            &pixels);
+  fclose(file);
+  if (!success) {
+    return false;
+  }
+
+  // Converts the 8-bit pixels to the requested type, e.g. FLOAT pixels are
+  // normalized to the range 0 to 1.0.
+  image->reset(oiio::ImageSpec(width, height, channels, pixel_type));
+  return image->set_pixels(image->roi(), oiio::TypeDesc::UINT8, pixels.data());
+}
+#endif  // WITH_LIBJPEG
+
+}  // namespace
+
+bool ReadImageAtScale(const std::string& filename,
+                      const int scale_denominator,
+                      const oiio::TypeDesc& pixel_type,
+                      oiio::ImageBuf* image) {
+  CHECK_GT(scale_denominator, 0);
+  CHECK_NOTNULL(image);
+#ifdef WITH_LIBJPEG
+  if (ReadJpegAtScale(filename, scale_denominator, pixel_type, image)) {
+    return true;
+  }
+#endif  // WITH_LIBJPEG
+
+  image->reset(filename);
+  if (!image->read(0, 0, true, pixel_type)) {
+    VLOG(2) << "Could not read image " << filename << ": "
+            << image->geterror();
+    return false;
+  }
+  if (scale_denominator == 1) {
+    return true;
+  }
+
+  // Round up to match the image size of the libjpeg DCT scaling.
+  const int new_width =
+      (image->spec().width + scale_denominator - 1) / scale_denominator;
+  const int new_height =
+      (image->spec().height + scale_denominator - 1) / scale_denominator;
+  oiio::ROI roi(0, new_width, 0, new_height, 0, 1, 0, image->nchannels());
+  oiio::ImageBuf resized;
+  if (!oiio::ImageBufAlgo::resize(resized, *image, nullptr, roi)) {
+    VLOG(2) << "Could not resize image " << filename << ": "
+            << oiio::geterror();
+    return false;
+  }
+  image->swap(resized);
+  return true;
+}
+
 FloatImage::FloatImage() : FloatImage(0, 0, 1) {}
 
 // Read from file.
 FloatImage::FloatImage(const std::string& filename) { Read(filename); }
 
+FloatImage::FloatImage(const std::string& filename,
+                       const int scale_denominator) {
+  ReadAtScale(filename, scale_denominator);
+}
+
 FloatImage::FloatImage(const FloatImage& image_to_copy) {
   CHECK(image_.copy(image_to_copy.image_));
 }
@@ -253,6 +416,13 @@ void FloatImage::Read(const std::string& filename) {
   image_.read(0, 0, true, oiio::TypeDesc::FLOAT);
 }
 
+void FloatImage::ReadAtScale(const std::string& filename,
+                             const int scale_denominator) {
+  CHECK(ReadImageAtScale(
+      filename, scale_denominator, oiio::TypeDesc::FLOAT, &image_))
+      << "Could not read image " << filename;
+}
+
 void FloatImage::Write(const std::string& filename) const {
   image_.write(filename);
 }
@@ -264,7 +434,32 @@ const float* FloatImage::Data() const {
   return reinterpret_cast<const float*>(image_.localpixels());
 }
 
-FloatImage FloatImage::ComputeGradientX() const {
+namespace {
+
+// The Sobel filters as separable kernels. The x gradient is the correlation
+// with kSobelDerivative along the rows and kSobelSmoothing along the columns.
+const std::vector<float> kSobelDerivative = {-0.5f, 0.0f, 0.5f};
+const std::vector<float> kSobelSmoothing = {0.25f, 0.5f, 0.25f};
+
+}  // namespace
+
+bool FloatImage::HasContiguousGrayscalePixels() const {
+  return Channels() == 1 && image_.localpixels() != nullptr;
+}
+
+FloatImage FloatImage::ComputeGradientX(const int num_threads) const {
+  if (HasContiguousGrayscalePixels()) {
+    FloatImage gradient_x(Width(), Height(), 1);
+    SeparableCorrelation(Data(),
+                         Width(),
+                         Height(),
+                         kSobelDerivative,
+                         kSobelSmoothing,
+                         num_threads,
+                         gradient_x.Data());
+    return gradient_x;
+  }
+
   float sobel_filter_x[9] = {-.125, 0, .125, -.25, 0, .25, -.125, 0, .125};
   oiio::ImageSpec spec(3, 3, 1, oiio::TypeDesc::FLOAT);
   oiio::ImageBuf kernel_x(spec, sobel_filter_x);
@@ -273,7 +468,19 @@ FloatImage FloatImage::ComputeGradientX() const {
   return FloatImage(gradient_x);
 }
 
-FloatImage FloatImage::ComputeGradientY() const {
+FloatImage FloatImage::ComputeGradientY(const int num_threads) const {
+  if (HasContiguousGrayscalePixels()) {
+    FloatImage gradient_y(Width(), Height(), 1);
+    SeparableCorrelation(Data(),
+                         Width(),
+                         Height(),
+                         kSobelSmoothing,
+                         kSobelDerivative,
+                         num_threads,
+                         gradient_y.Data());
+    return gradient_y;
+  }
+
   float sobel_filter_y[9] = {-.125, -.25, -.125, 0, 0, 0, .125, .25, .125};
   oiio::ImageSpec spec(3, 3, 1, oiio::TypeDesc::FLOAT);
   oiio::ImageBuf kernel_y(spec, sobel_filter_y);
@@ -282,7 +489,20 @@ FloatImage FloatImage::ComputeGradientY() const {
   return FloatImage(gradient_y);
 }
 
-FloatImage FloatImage::ComputeGradient() const {
+FloatImage FloatImage::ComputeGradient(const int num_threads) const {
+  if (HasContiguousGrayscalePixels()) {
+    FloatImage gradient = ComputeGradientX(num_threads);
+    const FloatImage gradient_y = ComputeGradientY(num_threads);
+    float* gradient_data = gradient.Data();
+    const float* gradient_y_data = gradient_y.Data();
+    const size_t num_pixels = static_cast<size_t>(Width()) * Height();
+    for (size_t i = 0; i < num_pixels; ++i) {
+      gradient_data[i] =
+          std::abs(gradient_data[i]) + std::abs(gradient_y_data[i]);
+    }
+    return gradient;
+  }
+
   // Get Dx and Dy.
   float sobel_filter_x[9] = {-.125, 0, .125, -.25, 0, .25, -.125, 0, .125};
   float sobel_filter_y[9] = {-.125, -.25, -.125, 0, 0, 0, .125, .25, .125};
@@ -301,7 +521,20 @@ FloatImage FloatImage::ComputeGradient() const {
   return FloatImage(gradient);
 }
 
-void FloatImage::ApproximateGaussianBlur(const int kernel_size) {
+void FloatImage::ApproximateGaussianBlur(const int kernel_size,
+                                         const int num_threads) {
+  if (HasContiguousGrayscalePixels()) {
+    // The gaussian is separable so the blur only costs 2 * kernel_size
+    // operations per pixel instead of kernel_size^2.
+    const std::vector<float> kernel =
+        GaussianKernel(static_cast<float>(kernel_size));
+    // The rows are filtered into a temporary buffer first, so the image may
+    // be filtered in place.
+    SeparableCorrelation(
+        Data(), Width(), Height(), kernel, kernel, num_threads, Data());
+    return;
+  }
+
   oiio::ImageBuf kernel;
   oiio::ImageBufAlgo::make_kernel(kernel,
                                   "gaussian",
@@ -310,11 +543,28 @@ void FloatImage::ApproximateGaussianBlur(const int kernel_size) {
   oiio::ImageBufAlgo::convolve(image_, image_, kernel);
 }
 
-void FloatImage::MedianFilter(const int patch_width) {
+void FloatImage::MedianFilter(const int patch_width, const int num_threads) {
+  if (HasContiguousGrayscalePixels()) {
+    const FloatImage image_copy(*this);
+    theia::MedianFilter(image_copy.Data(),
+                        Width(),
+                        Height(),
+                        patch_width,
+                        num_threads,
+                        Data());
+    return;
+  }
+
   CHECK(oiio::ImageBufAlgo::median_filter(image_, image_, patch_width));
 }
 
-void FloatImage::Integrate(FloatImage* integral) const {
+void FloatImage::Integrate(FloatImage* integral, const int num_threads) const {
+  if (HasContiguousGrayscalePixels()) {
+    *integral = FloatImage(Width() + 1, Height() + 1, 1);
+    IntegralImage(Data(), Width(), Height(), num_threads, integral->Data());
+    return;
+  }
+
   integral->ResizeRowsCols(Rows() + 1, Cols() + 1);
   for (int i = 0; i < Channels(); i++) {
     // Fill the first row with zeros.
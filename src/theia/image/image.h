@@ -54,6 +54,9 @@ class FloatImage {
 
   // Read from file.
   explicit FloatImage(const std::string& filename);
+  // Read from file at 1 / scale_denominator of the full resolution. See
+  // ReadAtScale.
+  FloatImage(const std::string& filename, const int scale_denominator);
   FloatImage(const int width, const int height, const int channels);
 
   // The image class may also be used as a wrapper around an existing buffer of
@@ -131,35 +134,46 @@ class FloatImage {
 
   // Write image to file.
   void Read(const std::string& filename);
+  // Read the image at 1 / scale_denominator of the full resolution. This is
+  // much cheaper than reading the full image and calling Resize since JPEG
+  // images may be downscaled while decoding, see ReadImageAtScale.
+  void ReadAtScale(const std::string& filename, const int scale_denominator);
   void Write(const std::string& filename) const;
 
   // Get a pointer to the data.
   float* Data();
   const float* Data() const;
 
+  // The filtering methods below have fast paths for grayscale images that
+  // split the rows between num_threads threads (see image_filters.h). Pixels
+  // outside of grayscale images are clamped to the border. Other images are
+  // filtered with OpenImageIO on a single thread.
+
   // Computes the gradient in each respective dimension.
-  FloatImage ComputeGradientX() const;
-  FloatImage ComputeGradientY() const;
+  FloatImage ComputeGradientX(const int num_threads = 1) const;
+  FloatImage ComputeGradientY(const int num_threads = 1) const;
   // Computes the gradient in x and y and returns the summation to obtain the
   // gradient magnitude at each pixel.
-  FloatImage ComputeGradient() const;
+  FloatImage ComputeGradient(const int num_threads = 1) const;
 
   // Apply a median filter to the image. Each pixel value is replaced by taking
   // the median value in a patch_width x patch_width window centered at the
   // pixel.
-  void MedianFilter(const int patch_width);
+  void MedianFilter(const int patch_width, const int num_threads = 1);
 
   // Compute the integral image where pixel (x, y) is equal to the sum of all
   // values in the rectangle from (0, 0) to (x, y) non-inclusive. This means
   // that the first row and column are all zeros, and the returned integral
   // image is one pixel wider and taller than the caller.
   //
-  // NOTE: This method should be called with precise number types such as double
-  // otherwise floating roundoff errors are sure to occur.
-  void Integrate(FloatImage* integral) const;
+  // NOTE: The sums of grayscale images are accumulated in double precision.
+  // For other images, floating roundoff errors are sure to occur for large
+  // images.
+  void Integrate(FloatImage* integral, const int num_threads = 1) const;
 
   // Computes a fast approximate gaussian blur of the image.
-  void ApproximateGaussianBlur(const int kernel_size);
+  void ApproximateGaussianBlur(const int kernel_size,
+                               const int num_threads = 1);
 
   // Resize using a Lanczos 3 filter.
   void Resize(int new_width, int new_height);
@@ -168,8 +182,27 @@ class FloatImage {
   void Resize(double scale);
 
  protected:
+  // Returns true if the image is a grayscale image with its pixels in memory,
+  // which is required by the fast filtering paths.
+  bool HasContiguousGrayscalePixels() const;
+
   oiio::ImageBuf image_;
 };
+
+// Reads the image file into image with pixels of the given type at
+// 1 / scale_denominator of the full resolution, i.e. the image is
+// ceil(width / scale_denominator) x ceil(height / scale_denominator). If Theia
+// is built with libjpeg (WITH_LIBJPEG) and scale_denominator is 1, 2, 4 or 8,
+// JPEG images are downscaled by libjpeg with DCT scaling so that only the
+// coarse DCT coefficients are decoded. All other images are decoded at full
+// resolution by OpenImageIO and then resized. Integer pixel types are not
+// normalized, e.g. UINT8 pixels range from 0 to 255 while FLOAT pixels range
+// from 0 to 1.0. Returns false if the image could not be read.
+bool ReadImageAtScale(const std::string& filename,
+                      const int scale_denominator,
+                      const oiio::TypeDesc& pixel_type,
+                      oiio::ImageBuf* image);
+
 }  // namespace theia
 
 #endif  // THEIA_IMAGE_IMAGE_H_
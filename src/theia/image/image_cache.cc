@@ -34,13 +34,21 @@
 
 #include "theia/image/image_cache.h"
 
+#include <glog/logging.h>
+#include <future>  // NOLINT
 #include <memory>
+#include <mutex>  // NOLINT
 #include <string>
+#include <vector>
 
 #include "theia/image/image.h"
 #include "theia/util/filesystem.h"
-#include "theia/util/lru_cache.h"
+#include "theia/util/map_util.h"
+#include "theia/util/memory_accounting.h"
+#include "theia/util/metrics.h"
+#include "theia/util/sharded_lru_cache.h"
 #include "theia/util/string.h"
+#include "theia/util/threadpool.h"
 
 namespace theia {
 
@@ -74,4 +82,185 @@ std::shared_ptr<const FloatImage> ImageCache::FetchImagesFromDisk(
   return image;
 }
 
+PrefetchingImageCache::PrefetchingImageCache(
+    const std::string& image_directory,
+    const size_t max_size_in_bytes,
+    const int num_prefetch_threads)
+    : image_directory_(image_directory),
+      max_size_in_bytes_(max_size_in_bytes),
+      size_in_bytes_(0),
+      access_counter_(0),
+      num_cache_hits_(0),
+      num_cache_misses_(0),
+      num_evictions_(0),
+      num_prefetches_(0),
+      stop_prefetching_(false) {
+  CHECK_GT(max_size_in_bytes_, 0)
+      << "The memory budget of the image cache must be positive.";
+  CHECK_GE(num_prefetch_threads, 0);
+  AppendTrailingSlashIfNeeded(&image_directory_);
+  memory_consumer_.reset(new ScopedMemoryConsumer(
+      "image_cache",
+      [this]() { return SizeInBytes(); },
+      [this](const size_t num_bytes) { return ReleaseMemory(num_bytes); }));
+  if (num_prefetch_threads > 0) {
+    prefetch_pool_.reset(new ThreadPool(num_prefetch_threads));
+  }
+}
+
+PrefetchingImageCache::~PrefetchingImageCache() {
+  // Skip the queued prefetches and wait for the ones in flight.
+  stop_prefetching_ = true;
+  prefetch_pool_.reset();
+  memory_consumer_.reset();
+}
+
+std::shared_ptr<const FloatImage> PrefetchingImageCache::FetchImage(
+    const std::string& image_filename) {
+  static Counter* const num_hits = Metrics::GetCounter(
+      "theia_image_cache_hits_total", "Hits of the image cache.");
+  static Counter* const num_misses = Metrics::GetCounter(
+      "theia_image_cache_misses_total", "Misses of the image cache.");
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  auto it = entries_.find(image_filename);
+  if (it != entries_.end()) {
+    ++num_cache_hits_;
+    num_hits->Increment();
+    it->second.last_access = ++access_counter_;
+    // Copy the future so that the entry may be evicted while we wait.
+    const auto image = it->second.image;
+    lock.unlock();
+    return image.get();
+  }
+
+  // Reserve the entry so that concurrent requests wait for this load, then
+  // load the image without holding the lock.
+  ++num_cache_misses_;
+  num_misses->Increment();
+  std::promise<std::shared_ptr<const FloatImage> > promise;
+  Entry& entry = entries_[image_filename];
+  entry.image = promise.get_future().share();
+  entry.last_access = ++access_counter_;
+  lock.unlock();
+
+  return LoadEntry(image_filename, &promise);
+}
+
+void PrefetchingImageCache::Prefetch(
+    const std::vector<std::string>& image_filenames) {
+  if (prefetch_pool_ == nullptr) {
+    return;
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (const std::string& image_filename : image_filenames) {
+    if (ContainsKey(entries_, image_filename)) {
+      continue;
+    }
+
+    ++num_prefetches_;
+    auto promise =
+        std::make_shared<std::promise<std::shared_ptr<const FloatImage> > >();
+    Entry& entry = entries_[image_filename];
+    entry.image = promise->get_future().share();
+    entry.last_access = ++access_counter_;
+    prefetch_pool_->Add([this, image_filename, promise]() {
+      if (stop_prefetching_) {
+        promise->set_value(nullptr);
+        return;
+      }
+      LoadEntry(image_filename, promise.get());
+    });
+  }
+}
+
+std::shared_ptr<const FloatImage> PrefetchingImageCache::ReadImage(
+    const std::string& image_filename) const {
+  const std::string image_filepath = image_directory_ + image_filename;
+  CHECK(FileExists(image_filepath))
+      << "The image file " << image_filepath << " does not exist.";
+  return std::make_shared<const FloatImage>(image_filepath);
+}
+
+std::shared_ptr<const FloatImage> PrefetchingImageCache::LoadEntry(
+    const std::string& image_filename,
+    std::promise<std::shared_ptr<const FloatImage> >* promise) {
+  const std::shared_ptr<const FloatImage> image = ReadImage(image_filename);
+  promise->set_value(image);
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    // Entries that are not ready are never evicted so the entry still exists.
+    Entry& entry = FindOrDie(entries_, image_filename);
+    entry.is_ready = true;
+    entry.size_in_bytes = sizeof(float) * image->Width() * image->Height() *
+                          image->Channels();
+    size_in_bytes_ += entry.size_in_bytes;
+    EvictUntilSizeIsAtMost(max_size_in_bytes_);
+  }
+
+  MemoryAccounting::EnforceBudget();
+  return image;
+}
+
+void PrefetchingImageCache::EvictUntilSizeIsAtMost(
+    const size_t size_in_bytes) {
+  while (size_in_bytes_ > size_in_bytes) {
+    auto entry_to_evict = entries_.end();
+    for (auto it = entries_.begin(); it != entries_.end(); ++it) {
+      if (it->second.is_ready &&
+          (entry_to_evict == entries_.end() ||
+           it->second.last_access < entry_to_evict->second.last_access)) {
+        entry_to_evict = it;
+      }
+    }
+
+    if (entry_to_evict == entries_.end()) {
+      return;
+    }
+    size_in_bytes_ -= entry_to_evict->second.size_in_bytes;
+    ++num_evictions_;
+    entries_.erase(entry_to_evict);
+  }
+}
+
+size_t PrefetchingImageCache::ReleaseMemory(const size_t num_bytes) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  const size_t old_size_in_bytes = size_in_bytes_;
+  EvictUntilSizeIsAtMost(
+      old_size_in_bytes > num_bytes ? old_size_in_bytes - num_bytes : 0);
+  return old_size_in_bytes - size_in_bytes_;
+}
+
+size_t PrefetchingImageCache::SizeInBytes() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return size_in_bytes_;
+}
+
+int PrefetchingImageCache::Size() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return entries_.size();
+}
+
+int PrefetchingImageCache::NumCacheHits() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return num_cache_hits_;
+}
+
+int PrefetchingImageCache::NumCacheMisses() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return num_cache_misses_;
+}
+
+int PrefetchingImageCache::NumEvictions() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return num_evictions_;
+}
+
+int PrefetchingImageCache::NumPrefetches() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return num_prefetches_;
+}
+
 }  // namespace theia
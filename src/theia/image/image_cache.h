@@ -35,17 +35,27 @@
 #ifndef THEIA_IMAGE_IMAGE_CACHE_H_
 #define THEIA_IMAGE_IMAGE_CACHE_H_
 
+#include <stdint.h>
+#include <atomic>
+#include <future>  // NOLINT
 #include <memory>
+#include <mutex>  // NOLINT
 #include <string>
+#include <unordered_map>
+#include <vector>
 
-#include "theia/util/lru_cache.h"
+#include "theia/util/memory_accounting.h"
+#include "theia/util/sharded_lru_cache.h"
+#include "theia/util/util.h"
 
 namespace theia {
 class FloatImage;
 
 // An LRU cache for retreiving images from disk. It is assumed that all images
 // are held in the same directory and are referenced by their filename
-// (including the extension).
+// (including the extension). The cache is sharded so that threads fetching
+// different images do not serialize on a single lock, and concurrent fetches of
+// the same image wait for a single read.
 class ImageCache {
  public:
   // We require that all images are held in the same directory for
@@ -68,7 +78,8 @@ class ImageCache {
       const std::string& image_filename) const;
 
  private:
-  typedef LRUCache<std::string, std::shared_ptr<const theia::FloatImage> >
+  typedef ShardedLRUCache<std::string,
+                          std::shared_ptr<const theia::FloatImage> >
       ImageLRUCache;
 
   // Method to fetch images from disk.
@@ -82,6 +93,102 @@ class ImageCache {
   std::unique_ptr<ImageLRUCache> images_;
 };
 
+class ThreadPool;
+
+// A thread-safe image cache that is bounded by the memory used by the images
+// rather than the number of images, since image sizes may vary by an order of
+// magnitude. The least recently used images are evicted once the memory budget
+// is exceeded.
+//
+// Workers that know which images they will need next (e.g. when colorizing or
+// undistorting the views of a reconstruction in order) can hint them with
+// Prefetch so that the images are loaded on background threads instead of
+// stalling the caller on a cache miss. Concurrent requests for the same image
+// wait for a single load. The cache reports its memory to the MemoryAccounting
+// and evicts images when the global memory budget is exceeded.
+class PrefetchingImageCache {
+ public:
+  // All images are held in the image directory. Images are prefetched with
+  // num_prefetch_threads threads; if it is 0, Prefetch has no effect.
+  PrefetchingImageCache(const std::string& image_directory,
+                        const size_t max_size_in_bytes,
+                        const int num_prefetch_threads);
+  ~PrefetchingImageCache();
+
+  // Returns the image, loading it on the calling thread if it is neither in
+  // the cache nor being prefetched. The returned pointer remains valid even if
+  // the image is evicted.
+  std::shared_ptr<const FloatImage> FetchImage(
+      const std::string& image_filename);
+
+  // Loads the images in the background, in the given order. Images that are
+  // already cached or being loaded are skipped. Prefetched images count as
+  // recently used, so the hinted images should fit in the memory budget.
+  void Prefetch(const std::vector<std::string>& image_filenames);
+
+  // Various statistics for the cache.
+  size_t MaxSizeInBytes() const { return max_size_in_bytes_; }
+  size_t SizeInBytes();
+  int Size();
+  int NumCacheHits();
+  int NumCacheMisses();
+  int NumEvictions();
+  int NumPrefetches();
+
+ private:
+  struct Entry {
+    std::shared_future<std::shared_ptr<const FloatImage> > image;
+    // Entries that are still being loaded cannot be evicted.
+    bool is_ready = false;
+    size_t size_in_bytes = 0;
+    uint64_t last_access = 0;
+  };
+
+  // Reads the image from disk.
+  std::shared_ptr<const FloatImage> ReadImage(
+      const std::string& image_filename) const;
+
+  // Loads the image of a reserved entry and marks the entry as ready.
+  std::shared_ptr<const FloatImage> LoadEntry(
+      const std::string& image_filename,
+      std::promise<std::shared_ptr<const FloatImage> >* promise);
+
+  // Removes the least recently used entries until the cache is within the
+  // given size.
+  //
+  // NOTE: This method is not thread-safe and must be called with the mutex
+  // locked.
+  void EvictUntilSizeIsAtMost(const size_t size_in_bytes);
+
+  // Evicts entries until at least num_bytes are released. Returns the number of
+  // bytes that were released.
+  size_t ReleaseMemory(const size_t num_bytes);
+
+  std::string image_directory_;
+  const size_t max_size_in_bytes_;
+
+  std::mutex mutex_;
+  std::unordered_map<std::string, Entry> entries_;
+  size_t size_in_bytes_;
+  uint64_t access_counter_;
+  int num_cache_hits_;
+  int num_cache_misses_;
+  int num_evictions_;
+  int num_prefetches_;
+
+  // Set when the cache is destroyed so that queued prefetches are skipped.
+  std::atomic<bool> stop_prefetching_;
+
+  // Unregistered before the entries are destroyed.
+  std::unique_ptr<ScopedMemoryConsumer> memory_consumer_;
+
+  // The thread pool is declared last so that it is destroyed, and its threads
+  // are joined, before the entries.
+  std::unique_ptr<ThreadPool> prefetch_pool_;
+
+  DISALLOW_COPY_AND_ASSIGN(PrefetchingImageCache);
+};
+
 }  // namespace theia
 
 #endif  // THEIA_IMAGE_IMAGE_CACHE_H_
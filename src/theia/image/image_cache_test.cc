@@ -0,0 +1,104 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "theia/image/image.h"
+#include "theia/image/image_cache.h"
+
+namespace theia {
+
+namespace {
+
+const std::string image_directory =
+    THEIA_DATA_DIR + std::string("/") + "image/";
+
+size_t ImageSizeInBytes(const FloatImage& image) {
+  return sizeof(float) * image.Width() * image.Height() * image.Channels();
+}
+
+}  // namespace
+
+TEST(PrefetchingImageCache, EvictsLeastRecentlyUsedImages) {
+  const FloatImage image(image_directory + "img1.png");
+  // All test images have the same size, so two fit in the cache.
+  PrefetchingImageCache cache(
+      image_directory, 2 * ImageSizeInBytes(image), 0);
+
+  cache.FetchImage("img1.png");
+  cache.FetchImage("img2.png");
+  EXPECT_EQ(cache.Size(), 2);
+  EXPECT_EQ(cache.NumCacheMisses(), 2);
+
+  // Refresh img1 so that img2 is evicted next.
+  cache.FetchImage("img1.png");
+  EXPECT_EQ(cache.NumCacheHits(), 1);
+  cache.FetchImage("img3.png");
+  EXPECT_EQ(cache.Size(), 2);
+  EXPECT_EQ(cache.NumEvictions(), 1);
+  EXPECT_LE(cache.SizeInBytes(), cache.MaxSizeInBytes());
+
+  cache.FetchImage("img1.png");
+  EXPECT_EQ(cache.NumCacheHits(), 2);
+  cache.FetchImage("img2.png");
+  EXPECT_EQ(cache.NumCacheMisses(), 4);
+}
+
+TEST(PrefetchingImageCache, Prefetch) {
+  const FloatImage image(image_directory + "img1.png");
+  PrefetchingImageCache cache(
+      image_directory, 4 * ImageSizeInBytes(image), 2);
+
+  const std::vector<std::string> image_filenames = {
+      "img1.png", "img2.png", "img3.png"};
+  cache.Prefetch(image_filenames);
+  // Images that are already being loaded are not prefetched twice.
+  cache.Prefetch(image_filenames);
+  EXPECT_EQ(cache.NumPrefetches(), 3);
+
+  for (const std::string& image_filename : image_filenames) {
+    const std::shared_ptr<const FloatImage> prefetched_image =
+        cache.FetchImage(image_filename);
+    ASSERT_NE(prefetched_image, nullptr);
+    EXPECT_EQ(prefetched_image->Width(), image.Width());
+  }
+  EXPECT_EQ(cache.NumCacheHits(), 3);
+  EXPECT_EQ(cache.NumCacheMisses(), 0);
+  EXPECT_EQ(cache.SizeInBytes(), 3 * ImageSizeInBytes(image));
+}
+
+}  // namespace theia
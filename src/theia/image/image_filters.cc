@@ -0,0 +1,239 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#include "theia/image/image_filters.h"
+
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <vector>
+
+#include "theia/util/executor.h"
+
+namespace theia {
+namespace {
+
+inline int Clamp(const int value, const int max_value) {
+  return std::min(std::max(value, 0), max_value);
+}
+
+// Correlates the row with the kernel.
+void CorrelateRow(const float* row,
+                  const int width,
+                  const std::vector<float>& kernel,
+                  float* output) {
+  const int radius = kernel.size() / 2;
+  // The pixels in [begin, end) do not need to be clamped. The loop over the
+  // kernel is the outer loop so that the inner loop is vectorized.
+  const int begin = std::min(radius, width);
+  const int end = std::max(width - radius, begin);
+  std::fill(output + begin, output + end, 0.0f);
+  for (int k = 0; k < kernel.size(); ++k) {
+    const float weight = kernel[k];
+    const int offset = k - radius;
+    for (int x = begin; x < end; ++x) {
+      output[x] += weight * row[x + offset];
+    }
+  }
+
+  const auto correlate_border_pixel = [&](const int x) {
+    float sum = 0.0f;
+    for (int k = 0; k < kernel.size(); ++k) {
+      sum += kernel[k] * row[Clamp(x + k - radius, width - 1)];
+    }
+    output[x] = sum;
+  };
+  for (int x = 0; x < begin; ++x) {
+    correlate_border_pixel(x);
+  }
+  for (int x = end; x < width; ++x) {
+    correlate_border_pixel(x);
+  }
+}
+
+}  // namespace
+
+void SeparableCorrelation(const float* image,
+                          const int width,
+                          const int height,
+                          const std::vector<float>& row_kernel,
+                          const std::vector<float>& column_kernel,
+                          const int num_threads,
+                          float* output) {
+  CHECK_EQ(row_kernel.size() % 2, 1);
+  CHECK_EQ(column_kernel.size() % 2, 1);
+  CHECK_GT(num_threads, 0);
+
+  // Filter the rows.
+  std::vector<float> row_filtered(static_cast<size_t>(width) * height);
+  ParallelFor(num_threads, height, [&](const int start, const int end) {
+    for (int y = start; y < end; ++y) {
+      CorrelateRow(image + static_cast<size_t>(y) * width,
+                   width,
+                   row_kernel,
+                   row_filtered.data() + static_cast<size_t>(y) * width);
+    }
+  });
+
+  // Filter the columns. Whole rows are weighted and accumulated at once so
+  // that the inner loop runs over contiguous pixels.
+  const int radius = column_kernel.size() / 2;
+  ParallelFor(num_threads, height, [&](const int start, const int end) {
+    for (int y = start; y < end; ++y) {
+      float* output_row = output + static_cast<size_t>(y) * width;
+      std::fill(output_row, output_row + width, 0.0f);
+      for (int k = 0; k < column_kernel.size(); ++k) {
+        const float weight = column_kernel[k];
+        const float* row =
+            row_filtered.data() +
+            static_cast<size_t>(Clamp(y + k - radius, height - 1)) * width;
+        for (int x = 0; x < width; ++x) {
+          output_row[x] += weight * row[x];
+        }
+      }
+    }
+  });
+}
+
+std::vector<float> GaussianKernel(const float width) {
+  CHECK_GT(width, 0.0f);
+  // The kernel has an odd number of taps that cover the width of the filter,
+  // and the gaussian vanishes at half of the width.
+  const int radius = static_cast<int>(std::ceil(width)) / 2;
+  const float scale = 2.0f / width;
+  std::vector<float> kernel(2 * radius + 1);
+  float sum = 0.0f;
+  for (int i = -radius; i <= radius; ++i) {
+    const float x = i * scale;
+    const float weight = std::abs(x) < 1.0f ? std::exp(-2.0f * x * x) : 0.0f;
+    kernel[i + radius] = weight;
+    sum += weight;
+  }
+  for (float& weight : kernel) {
+    weight /= sum;
+  }
+  return kernel;
+}
+
+void MedianFilter(const float* image,
+                  const int width,
+                  const int height,
+                  const int patch_width,
+                  const int num_threads,
+                  float* output) {
+  CHECK_GT(patch_width, 0);
+  CHECK_GT(num_threads, 0);
+  const int radius = patch_width / 2;
+  ParallelFor(num_threads, height, [&](const int start, const int end) {
+    // The window is reused by all pixels of the block.
+    std::vector<float> window(patch_width * patch_width);
+    const auto median = window.begin() + window.size() / 2;
+    for (int y = start; y < end; ++y) {
+      for (int x = 0; x < width; ++x) {
+        auto it = window.begin();
+        for (int dy = 0; dy < patch_width; ++dy) {
+          const float* row =
+              image +
+              static_cast<size_t>(Clamp(y + dy - radius, height - 1)) *
+                  width;
+          for (int dx = 0; dx < patch_width; ++dx) {
+            *it++ = row[Clamp(x + dx - radius, width - 1)];
+          }
+        }
+        std::nth_element(window.begin(), median, window.end());
+        output[static_cast<size_t>(y) * width + x] = *median;
+      }
+    }
+  });
+}
+
+void IntegralImage(const float* image,
+                   const int width,
+                   const int height,
+                   const int num_threads,
+                   float* integral) {
+  CHECK_GT(num_threads, 0);
+  const int integral_width = width + 1;
+
+  // The columns are split into strips that are accumulated independently. To
+  // do so, we first compute the sum of each row within each strip so that the
+  // prefix sum of a row at the start of every strip is known.
+  const int num_strips = std::max(1, std::min(num_threads, width));
+  const int strip_width = (width + num_strips - 1) / std::max(num_strips, 1);
+  std::vector<double> row_offsets(static_cast<size_t>(height) * num_strips);
+  ParallelFor(num_threads, height, [&](const int start, const int end) {
+    for (int y = start; y < end; ++y) {
+      const float* row = image + static_cast<size_t>(y) * width;
+      double offset = 0.0;
+      for (int s = 0; s < num_strips; ++s) {
+        row_offsets[static_cast<size_t>(y) * num_strips + s] = offset;
+        const int strip_end = std::min((s + 1) * strip_width, width);
+        for (int x = s * strip_width; x < strip_end; ++x) {
+          offset += row[x];
+        }
+      }
+    }
+  });
+
+  // The first row and column are all zeros.
+  std::fill(integral, integral + integral_width, 0.0f);
+  for (int y = 1; y <= height; ++y) {
+    integral[static_cast<size_t>(y) * integral_width] = 0.0f;
+  }
+
+  // Accumulate each strip down the columns, keeping the running column sums
+  // in double precision.
+  ParallelFor(num_strips, num_strips, [&](const int start, const int end) {
+    for (int s = start; s < end; ++s) {
+      const int strip_begin = s * strip_width;
+      const int strip_end = std::min(strip_begin + strip_width, width);
+      std::vector<double> column_sums(strip_end - strip_begin, 0.0);
+      for (int y = 0; y < height; ++y) {
+        const float* row = image + static_cast<size_t>(y) * width;
+        float* integral_row =
+            integral + static_cast<size_t>(y + 1) * integral_width + 1;
+        double row_sum = row_offsets[static_cast<size_t>(y) * num_strips + s];
+        for (int x = strip_begin; x < strip_end; ++x) {
+          row_sum += row[x];
+          column_sums[x - strip_begin] += row_sum;
+          integral_row[x] = static_cast<float>(column_sums[x - strip_begin]);
+        }
+      }
+    }
+  });
+}
+
+}  // namespace theia
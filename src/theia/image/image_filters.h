@@ -0,0 +1,86 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#ifndef THEIA_IMAGE_IMAGE_FILTERS_H_
+#define THEIA_IMAGE_IMAGE_FILTERS_H_
+
+#include <vector>
+
+namespace theia {
+
+// Filtering kernels for single-channel float images stored contiguously in
+// row-major order. These are the fast paths of the FloatImage filtering
+// methods: the rows of the output are split between num_threads threads and
+// the inner loops run over contiguous pixels so that they are vectorized by
+// the compiler. Pixels outside of the image are clamped to the nearest border
+// pixel.
+
+// Correlates the image with the separable kernel row_kernel x column_kernel,
+// i.e. with the 2D kernel whose entry (x, y) is row_kernel[x] *
+// column_kernel[y]. Both kernels must have an odd length and are centered on
+// the output pixel. The output may be the input image.
+void SeparableCorrelation(const float* image,
+                          const int width,
+                          const int height,
+                          const std::vector<float>& row_kernel,
+                          const std::vector<float>& column_kernel,
+                          const int num_threads,
+                          float* output);
+
+// Returns the normalized 1D kernel of the gaussian filter of the given width
+// (sigma = width / 4), which matches the "gaussian" filter of OpenImageIO.
+std::vector<float> GaussianKernel(const float width);
+
+// Replaces each pixel by the median of the patch_width x patch_width window
+// centered at the pixel.
+void MedianFilter(const float* image,
+                  const int width,
+                  const int height,
+                  const int patch_width,
+                  const int num_threads,
+                  float* output);
+
+// Computes the (width + 1) x (height + 1) integral image, where pixel (x, y)
+// is the sum of all pixels in the rectangle from (0, 0) to (x, y)
+// non-inclusive. The sums are accumulated in double precision so the only
+// error is the final rounding of each sum to float.
+void IntegralImage(const float* image,
+                   const int width,
+                   const int height,
+                   const int num_threads,
+                   float* integral);
+
+}  // namespace theia
+
+#endif  // THEIA_IMAGE_IMAGE_FILTERS_H_
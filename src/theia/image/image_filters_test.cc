@@ -0,0 +1,179 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "theia/image/image_filters.h"
+
+namespace theia {
+
+namespace {
+
+static const int kWidth = 37;
+static const int kHeight = 23;
+
+std::vector<float> RandomImage(const int width, const int height) {
+  std::mt19937 rng(59);
+  std::uniform_real_distribution<float> distribution(0.0f, 1.0f);
+  std::vector<float> image(width * height);
+  for (float& pixel : image) {
+    pixel = distribution(rng);
+  }
+  return image;
+}
+
+float ClampedPixel(const std::vector<float>& image,
+                   const int width,
+                   const int height,
+                   const int x,
+                   const int y) {
+  return image[std::min(std::max(y, 0), height - 1) * width +
+               std::min(std::max(x, 0), width - 1)];
+}
+
+}  // namespace
+
+TEST(ImageFilters, SeparableCorrelationMatchesDirectCorrelation) {
+  const std::vector<float> image = RandomImage(kWidth, kHeight);
+  const std::vector<float> row_kernel = {-0.5f, 0.0f, 0.5f};
+  const std::vector<float> column_kernel = GaussianKernel(5.0f);
+  const int row_radius = row_kernel.size() / 2;
+  const int column_radius = column_kernel.size() / 2;
+
+  for (const int num_threads : {1, 4}) {
+    std::vector<float> output(image.size());
+    SeparableCorrelation(image.data(),
+                         kWidth,
+                         kHeight,
+                         row_kernel,
+                         column_kernel,
+                         num_threads,
+                         output.data());
+    for (int y = 0; y < kHeight; y++) {
+      for (int x = 0; x < kWidth; x++) {
+        float expected = 0.0f;
+        for (int i = 0; i < column_kernel.size(); i++) {
+          for (int j = 0; j < row_kernel.size(); j++) {
+            expected += column_kernel[i] * row_kernel[j] *
+                        ClampedPixel(image,
+                                     kWidth,
+                                     kHeight,
+                                     x + j - row_radius,
+                                     y + i - column_radius);
+          }
+        }
+        EXPECT_NEAR(output[y * kWidth + x], expected, 1e-6);
+      }
+    }
+  }
+}
+
+TEST(ImageFilters, SeparableCorrelationInPlace) {
+  std::vector<float> image = RandomImage(kWidth, kHeight);
+  const std::vector<float> kernel = GaussianKernel(3.0f);
+  std::vector<float> expected(image.size());
+  SeparableCorrelation(
+      image.data(), kWidth, kHeight, kernel, kernel, 2, expected.data());
+  SeparableCorrelation(
+      image.data(), kWidth, kHeight, kernel, kernel, 2, image.data());
+  EXPECT_EQ(image, expected);
+}
+
+TEST(ImageFilters, GaussianKernel) {
+  for (const float width : {1.0f, 3.0f, 4.5f, 9.0f}) {
+    const std::vector<float> kernel = GaussianKernel(width);
+    EXPECT_EQ(kernel.size() % 2, 1);
+    float sum = 0.0f;
+    for (int i = 0; i < kernel.size(); i++) {
+      sum += kernel[i];
+      // The kernel is symmetric and decreasing away from the center.
+      EXPECT_FLOAT_EQ(kernel[i], kernel[kernel.size() - 1 - i]);
+      if (i > 0 && i <= kernel.size() / 2) {
+        EXPECT_LE(kernel[i - 1], kernel[i]);
+      }
+    }
+    EXPECT_NEAR(sum, 1.0f, 1e-6);
+  }
+}
+
+TEST(ImageFilters, MedianFilter) {
+  const std::vector<float> image = RandomImage(kWidth, kHeight);
+  static const int kPatchWidth = 3;
+  for (const int num_threads : {1, 4}) {
+    std::vector<float> output(image.size());
+    MedianFilter(image.data(),
+                 kWidth,
+                 kHeight,
+                 kPatchWidth,
+                 num_threads,
+                 output.data());
+    for (int y = 0; y < kHeight; y++) {
+      for (int x = 0; x < kWidth; x++) {
+        std::vector<float> window;
+        for (int dy = -1; dy <= 1; dy++) {
+          for (int dx = -1; dx <= 1; dx++) {
+            window.emplace_back(
+                ClampedPixel(image, kWidth, kHeight, x + dx, y + dy));
+          }
+        }
+        std::sort(window.begin(), window.end());
+        EXPECT_EQ(output[y * kWidth + x], window[window.size() / 2]);
+      }
+    }
+  }
+}
+
+TEST(ImageFilters, IntegralImage) {
+  const std::vector<float> image = RandomImage(kWidth, kHeight);
+  for (const int num_threads : {1, 3, 64}) {
+    std::vector<float> integral((kWidth + 1) * (kHeight + 1), -1.0f);
+    IntegralImage(image.data(), kWidth, kHeight, num_threads, integral.data());
+    for (int y = 0; y <= kHeight; y++) {
+      for (int x = 0; x <= kWidth; x++) {
+        double expected = 0.0;
+        for (int i = 0; i < y; i++) {
+          for (int j = 0; j < x; j++) {
+            expected += image[i * kWidth + j];
+          }
+        }
+        EXPECT_NEAR(integral[y * (kWidth + 1) + x], expected, 1e-4);
+      }
+    }
+  }
+}
+
+}  // namespace theia
@@ -0,0 +1,202 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+
+#include "theia/image/image_mask.h"
+
+#include <OpenImageIO/imagebuf.h>
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "theia/image/image.h"
+#include "theia/util/sharded_lru_cache.h"
+
+namespace theia {
+
+namespace {
+
+static const float kMaskThreshold = 0.5;
+
+// Returns a word with the bits [begin, end) set, where 0 <= begin < end <= 64.
+uint64_t BitRange(const int begin, const int end) {
+  const uint64_t below_end =
+      end == 64 ? ~uint64_t(0) : (uint64_t(1) << end) - 1;
+  return below_end & ~((uint64_t(1) << begin) - 1);
+}
+
+}  // namespace
+
+ImageMask::ImageMask(const int width, const int height, const int cell_size)
+    : width_(width), height_(height), cell_size_(cell_size) {
+  CHECK_GT(cell_size_, 0);
+  num_cell_cols_ = (width_ + cell_size_ - 1) / cell_size_;
+  num_cell_rows_ = (height_ + cell_size_ - 1) / cell_size_;
+  words_per_row_ = (num_cell_cols_ + 63) / 64;
+  bits_.resize(num_cell_rows_ * words_per_row_, 0);
+}
+
+ImageMask::ImageMask(const FloatImage& mask, const int cell_size)
+    : ImageMask(mask.Width(), mask.Height(), cell_size) {
+  const FloatImage grayscale_mask = mask.AsGrayscaleImage();
+  for (int cell_row = 0; cell_row < num_cell_rows_; cell_row++) {
+    SetCellRow(cell_row, grayscale_mask, 0);
+  }
+}
+
+std::shared_ptr<const ImageMask> ImageMask::Read(const std::string& filepath,
+                                                 const int cell_size) {
+  oiio::ImageBuf image;
+  if (!image.init_spec(filepath, 0, 0)) {
+    LOG(ERROR) << "Could not read the image mask " << filepath;
+    return nullptr;
+  }
+
+  const oiio::ImageSpec& spec = image.spec();
+  std::shared_ptr<ImageMask> mask(
+      new ImageMask(spec.width, spec.height, cell_size));
+  for (int cell_row = 0; cell_row < mask->num_cell_rows_; cell_row++) {
+    const int first_row = cell_row * cell_size;
+    const int last_row = std::min(first_row + cell_size, spec.height);
+    FloatImage band(spec.width, last_row - first_row, spec.nchannels);
+    const oiio::ROI roi(0, spec.width, first_row, last_row, 0, 1, 0,
+                        spec.nchannels);
+    if (!image.get_pixels(roi, oiio::TypeDesc::FLOAT, band.Data())) {
+      LOG(ERROR) << "Could not read the pixels of the image mask " << filepath;
+      return nullptr;
+    }
+    band.ConvertToGrayscaleImage();
+    mask->SetCellRow(cell_row, band, first_row);
+  }
+  return mask;
+}
+
+void ImageMask::SetCellRow(const int cell_row,
+                           const FloatImage& grayscale_mask,
+                           const int first_row) {
+  const int ybegin = cell_row * cell_size_;
+  const int yend = std::min(ybegin + cell_size_, height_);
+  for (int cell_col = 0; cell_col < num_cell_cols_; cell_col++) {
+    const int xbegin = cell_col * cell_size_;
+    const int xend = std::min(xbegin + cell_size_, width_);
+    double sum = 0;
+    for (int y = ybegin; y < yend; y++) {
+      for (int x = xbegin; x < xend; x++) {
+        sum += grayscale_mask.GetXY(x, y - first_row, 0);
+      }
+    }
+    if (sum >= kMaskThreshold * (xend - xbegin) * (yend - ybegin)) {
+      bits_[cell_row * words_per_row_ + cell_col / 64] |= uint64_t(1)
+                                                          << (cell_col % 64);
+    }
+  }
+}
+
+bool ImageMask::IsUnmasked(const double x, const double y) const {
+  if (bits_.empty()) {
+    return false;
+  }
+  const int cell_x = std::min(
+      std::max(static_cast<int>(std::floor(x)), 0) / cell_size_,
+      num_cell_cols_ - 1);
+  const int cell_y = std::min(
+      std::max(static_cast<int>(std::floor(y)), 0) / cell_size_,
+      num_cell_rows_ - 1);
+  return IsCellUnmasked(cell_x, cell_y);
+}
+
+bool ImageMask::HasUnmaskedPixels(const int xbegin,
+                                  const int xend,
+                                  const int ybegin,
+                                  const int yend) const {
+  const int clamped_xbegin = std::max(xbegin, 0);
+  const int clamped_xend = std::min(xend, width_);
+  const int clamped_ybegin = std::max(ybegin, 0);
+  const int clamped_yend = std::min(yend, height_);
+  if (clamped_xbegin >= clamped_xend || clamped_ybegin >= clamped_yend) {
+    return false;
+  }
+
+  // Test the cells of each row a word at a time.
+  const int first_cell_col = clamped_xbegin / cell_size_;
+  const int last_cell_col = (clamped_xend - 1) / cell_size_;
+  const int first_word = first_cell_col / 64;
+  const int last_word = last_cell_col / 64;
+  for (int cell_row = clamped_ybegin / cell_size_;
+       cell_row <= (clamped_yend - 1) / cell_size_;
+       cell_row++) {
+    const uint64_t* row = bits_.data() + cell_row * words_per_row_;
+    for (int word = first_word; word <= last_word; word++) {
+      const int begin = word == first_word ? first_cell_col % 64 : 0;
+      const int end = word == last_word ? last_cell_col % 64 + 1 : 64;
+      if (row[word] & BitRange(begin, end)) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+size_t ImageMask::SizeInBytes() const {
+  return sizeof(*this) + bits_.size() * sizeof(bits_[0]);
+}
+
+ImageMaskCache::ImageMaskCache(const int cell_size,
+                               const size_t max_size_in_bytes)
+    : cell_size_(cell_size),
+      masks_(
+          [cell_size](const std::string& filepath) {
+            return ImageMask::Read(filepath, cell_size);
+          },
+          max_size_in_bytes,
+          ShardedLRUCache<std::string, std::shared_ptr<const ImageMask> >::
+              kDefaultNumShards,
+          [](const std::shared_ptr<const ImageMask>& mask) {
+            // Masks that could not be read are cached as well so that a
+            // missing mask is not read again for every image.
+            return mask != nullptr ? mask->SizeInBytes() : 1;
+          }) {
+  CHECK_GT(cell_size_, 0);
+}
+
+std::shared_ptr<const ImageMask> ImageMaskCache::FetchMask(
+    const std::string& filepath) {
+  return masks_.Fetch(filepath);
+}
+
+}  // namespace theia
@@ -0,0 +1,141 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+
+#ifndef THEIA_IMAGE_IMAGE_MASK_H_
+#define THEIA_IMAGE_IMAGE_MASK_H_
+
+#include <stdint.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "theia/util/sharded_lru_cache.h"
+#include "theia/util/util.h"
+
+namespace theia {
+class FloatImage;
+
+// A feature extraction mask packed into a bitmap. The mask image is split into
+// cells of cell_size x cell_size pixels and each cell is stored as a single bit
+// that is set if the mean grayscale value of its pixels is at least 0.5, i.e.
+// if features may be detected in the cell. A full resolution mask thus takes
+// 32 times less memory than the float image it was decoded from, and larger
+// cells downsample the mask further.
+class ImageMask {
+ public:
+  // Thresholds the mask image, which may have any number of channels.
+  explicit ImageMask(const FloatImage& mask, const int cell_size = 1);
+
+  // Reads the mask image from disk, cell_size rows at a time, so the decoded
+  // float image is never held in memory. Returns a nullptr if the mask cannot
+  // be read.
+  static std::shared_ptr<const ImageMask> Read(const std::string& filepath,
+                                               const int cell_size = 1);
+
+  // Size of the mask image in pixels.
+  int Width() const { return width_; }
+  int Height() const { return height_; }
+  int CellSize() const { return cell_size_; }
+
+  // Returns true if the cell that contains the position (in pixels) is not
+  // masked out. Positions outside of the mask are clamped to its border since
+  // keypoints may lie slightly outside of the image.
+  bool IsUnmasked(const double x, const double y) const;
+
+  // Returns true if any cell that overlaps the pixels [xbegin, xend) x
+  // [ybegin, yend) is not masked out.
+  bool HasUnmaskedPixels(const int xbegin,
+                         const int xend,
+                         const int ybegin,
+                         const int yend) const;
+
+  // The memory used by the bitmap.
+  size_t SizeInBytes() const;
+
+ private:
+  ImageMask(const int width, const int height, const int cell_size);
+
+  // Thresholds the cells of a row of cells. The rows of the grayscale image
+  // start at pixel row first_row.
+  void SetCellRow(const int cell_row,
+                  const FloatImage& grayscale_mask,
+                  const int first_row);
+
+  bool IsCellUnmasked(const int cell_x, const int cell_y) const {
+    return (bits_[cell_y * words_per_row_ + cell_x / 64] >> (cell_x % 64)) & 1;
+  }
+
+  int width_;
+  int height_;
+  int cell_size_;
+  int num_cell_cols_;
+  int num_cell_rows_;
+  int words_per_row_;
+  std::vector<uint64_t> bits_;
+
+  DISALLOW_COPY_AND_ASSIGN(ImageMask);
+};
+
+// A thread-safe cache of decoded masks keyed by their filepath. Masks are often
+// shared by many images (e.g. the same vehicle hood mask for every frame of a
+// camera), so each mask file is decoded and thresholded once and the bitmap is
+// shared by all images that use it. Concurrent fetches of a mask that is being
+// read wait for the single read, and the least recently used masks are evicted
+// once the bitmaps exceed the memory budget.
+class ImageMaskCache {
+ public:
+  ImageMaskCache(const int cell_size, const size_t max_size_in_bytes);
+  ~ImageMaskCache() {}
+
+  // Returns the mask, or a nullptr if the mask cannot be read. The returned
+  // mask remains valid even if it is evicted.
+  std::shared_ptr<const ImageMask> FetchMask(const std::string& filepath);
+
+  int CellSize() const { return cell_size_; }
+
+  // Various statistics for the cache.
+  int NumCacheHits() const { return masks_.NumCacheHits(); }
+  int NumCacheMisses() const { return masks_.NumCacheMisses(); }
+
+ private:
+  const int cell_size_;
+  ShardedLRUCache<std::string, std::shared_ptr<const ImageMask> > masks_;
+
+  DISALLOW_COPY_AND_ASSIGN(ImageMaskCache);
+};
+
+}  // namespace theia
+
+#endif  // THEIA_IMAGE_IMAGE_MASK_H_
@@ -0,0 +1,146 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+
+#include <memory>
+#include <string>
+
+#include "gtest/gtest.h"
+#include "theia/image/image.h"
+#include "theia/image/image_mask.h"
+
+namespace theia {
+
+namespace {
+
+const std::string image_directory =
+    THEIA_DATA_DIR + std::string("/") + "image/";
+
+// Returns a mask image with the pixels of the rectangle [xbegin, xend) x
+// [ybegin, yend) set to 1.
+FloatImage MaskImage(const int width,
+                     const int height,
+                     const int xbegin,
+                     const int xend,
+                     const int ybegin,
+                     const int yend) {
+  FloatImage mask(width, height, 1);
+  for (int y = 0; y < height; y++) {
+    for (int x = 0; x < width; x++) {
+      const bool unmasked = x >= xbegin && x < xend && y >= ybegin && y < yend;
+      mask.SetXY(x, y, 0, unmasked ? 1.0f : 0.0f);
+    }
+  }
+  return mask;
+}
+
+}  // namespace
+
+TEST(ImageMask, FullResolution) {
+  const ImageMask mask(MaskImage(150, 20, 70, 130, 5, 10));
+  EXPECT_EQ(mask.Width(), 150);
+  EXPECT_EQ(mask.Height(), 20);
+  for (int y = 0; y < 20; y++) {
+    for (int x = 0; x < 150; x++) {
+      const bool unmasked = x >= 70 && x < 130 && y >= 5 && y < 10;
+      EXPECT_EQ(mask.IsUnmasked(x + 0.5, y + 0.5), unmasked);
+    }
+  }
+
+  // The unmasked rectangle spans the second and third word of each row.
+  EXPECT_TRUE(mask.HasUnmaskedPixels(0, 150, 0, 20));
+  EXPECT_TRUE(mask.HasUnmaskedPixels(129, 130, 9, 10));
+  EXPECT_TRUE(mask.HasUnmaskedPixels(0, 71, 0, 6));
+  EXPECT_FALSE(mask.HasUnmaskedPixels(0, 70, 0, 20));
+  EXPECT_FALSE(mask.HasUnmaskedPixels(130, 150, 0, 20));
+  EXPECT_FALSE(mask.HasUnmaskedPixels(0, 150, 10, 20));
+  EXPECT_FALSE(mask.HasUnmaskedPixels(80, 80, 0, 20));
+
+  // The bitmap uses one bit per pixel.
+  EXPECT_LT(mask.SizeInBytes(), 150 * 20 / 8 + 20 * 8 + sizeof(mask));
+}
+
+TEST(ImageMask, PositionsAreClampedToTheBorder) {
+  const ImageMask mask(MaskImage(10, 10, 0, 1, 0, 1));
+  EXPECT_TRUE(mask.IsUnmasked(-0.5, -0.5));
+  EXPECT_FALSE(mask.IsUnmasked(10.5, 10.5));
+  EXPECT_TRUE(mask.HasUnmaskedPixels(-5, 5, -5, 5));
+}
+
+TEST(ImageMask, DownsampledCellsUseTheMeanOfTheirPixels) {
+  // A cell of 4 x 4 pixels is unmasked if at least half of its pixels are.
+  const ImageMask mask(MaskImage(10, 8, 0, 2, 0, 8), 4);
+  EXPECT_EQ(mask.CellSize(), 4);
+  EXPECT_TRUE(mask.IsUnmasked(3.5, 3.5));
+  EXPECT_TRUE(mask.IsUnmasked(0.5, 7.5));
+  EXPECT_FALSE(mask.IsUnmasked(4.5, 0.5));
+  EXPECT_FALSE(mask.HasUnmaskedPixels(4, 10, 0, 8));
+
+  // The last column of cells is only 2 pixels wide.
+  const ImageMask border_mask(MaskImage(10, 8, 9, 10, 0, 8), 4);
+  EXPECT_TRUE(border_mask.IsUnmasked(8.5, 0.5));
+  EXPECT_FALSE(border_mask.IsUnmasked(7.5, 0.5));
+}
+
+TEST(ImageMask, ReadMatchesDecodedImage) {
+  const std::string filepath = image_directory + "img1.png";
+  const FloatImage image(filepath);
+  const ImageMask expected_mask(image, 3);
+  const std::shared_ptr<const ImageMask> mask = ImageMask::Read(filepath, 3);
+  ASSERT_NE(mask, nullptr);
+  ASSERT_EQ(mask->Width(), image.Width());
+  ASSERT_EQ(mask->Height(), image.Height());
+  for (int y = 0; y < image.Height(); y++) {
+    for (int x = 0; x < image.Width(); x++) {
+      EXPECT_EQ(mask->IsUnmasked(x, y), expected_mask.IsUnmasked(x, y));
+    }
+  }
+
+  EXPECT_EQ(ImageMask::Read(image_directory + "missing_mask.png"), nullptr);
+}
+
+TEST(ImageMaskCache, SharesMasksBetweenImages) {
+  ImageMaskCache cache(2, 1024 * 1024);
+  const std::string filepath = image_directory + "img1.png";
+  const std::shared_ptr<const ImageMask> mask = cache.FetchMask(filepath);
+  ASSERT_NE(mask, nullptr);
+  EXPECT_EQ(mask->CellSize(), 2);
+  EXPECT_EQ(cache.FetchMask(filepath), mask);
+  EXPECT_EQ(cache.NumCacheMisses(), 1);
+  EXPECT_EQ(cache.NumCacheHits(), 1);
+
+  EXPECT_EQ(cache.FetchMask(image_directory + "missing_mask.png"), nullptr);
+}
+
+}  // namespace theia
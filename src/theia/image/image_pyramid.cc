@@ -0,0 +1,147 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#include "theia/image/image_pyramid.h"
+
+#include <OpenImageIO/imagebuf.h>
+#include <OpenImageIO/imagebufalgo.h>
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <string>
+
+#include "theia/image/image.h"
+
+namespace theia {
+
+namespace {
+
+// libjpeg DCT scaling supports downscaling by at most a factor of 8.
+static const int kMaxDecodeScaleDenominator = 8;
+
+}  // namespace
+
+ImagePyramid::ImagePyramid(const std::string& filename, const int num_levels)
+    : filename_(filename), num_levels_(num_levels) {
+  CHECK_GT(num_levels_, 0);
+  oiio::ImageBuf header;
+  CHECK(header.init_spec(filename_, 0, 0))
+      << "Could not read the header of image " << filename_;
+  width_ = header.spec().width;
+  height_ = header.spec().height;
+  levels_.resize(num_levels_);
+}
+
+ImagePyramid::ImagePyramid(const FloatImage& image, const int num_levels)
+    : num_levels_(num_levels), width_(image.Width()), height_(image.Height()) {
+  CHECK_GT(num_levels_, 0);
+  levels_.resize(num_levels_);
+  levels_[0] = std::make_shared<const FloatImage>(image);
+}
+
+ImagePyramid::~ImagePyramid() {}
+
+int ImagePyramid::Width(const int level) const {
+  DCHECK_GE(level, 0);
+  DCHECK_LT(level, num_levels_);
+  const int scale_denominator = 1 << level;
+  return (width_ + scale_denominator - 1) / scale_denominator;
+}
+
+int ImagePyramid::Height(const int level) const {
+  DCHECK_GE(level, 0);
+  DCHECK_LT(level, num_levels_);
+  const int scale_denominator = 1 << level;
+  return (height_ + scale_denominator - 1) / scale_denominator;
+}
+
+double ImagePyramid::Scale(const int level) const {
+  DCHECK_GE(level, 0);
+  DCHECK_LT(level, num_levels_);
+  return 1.0 / static_cast<double>(1 << level);
+}
+
+std::shared_ptr<const FloatImage> ImagePyramid::Level(const int level) {
+  CHECK_GE(level, 0);
+  CHECK_LT(level, num_levels_);
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (levels_[level] == nullptr) {
+    levels_[level] = ComputeLevel(level);
+  }
+  return levels_[level];
+}
+
+bool ImagePyramid::HasLevel(const int level) const {
+  CHECK_GE(level, 0);
+  CHECK_LT(level, num_levels_);
+  std::lock_guard<std::mutex> lock(mutex_);
+  return levels_[level] != nullptr;
+}
+
+void ImagePyramid::ClearLevel(const int level) {
+  CHECK_GE(level, 0);
+  CHECK_LT(level, num_levels_);
+  std::lock_guard<std::mutex> lock(mutex_);
+  levels_[level].reset();
+}
+
+std::shared_ptr<const FloatImage> ImagePyramid::ComputeLevel(
+    const int level) const {
+  std::shared_ptr<FloatImage> image;
+  int finer_level = level - 1;
+  while (finer_level >= 0 && levels_[finer_level] == nullptr) {
+    --finer_level;
+  }
+
+  if (finer_level >= 0) {
+    image = std::make_shared<FloatImage>(*levels_[finer_level]);
+  } else {
+    CHECK(!filename_.empty())
+        << "Level 0 of an image pyramid created from an image was cleared.";
+    const int scale_denominator =
+        std::min(1 << level, kMaxDecodeScaleDenominator);
+    image = std::make_shared<FloatImage>(filename_, scale_denominator);
+  }
+
+  // The Lanczos filter of Resize is widened for larger scale factors, so the
+  // level may be downsampled from any finer level in one step.
+  if (image->Width() != Width(level) || image->Height() != Height(level)) {
+    image->Resize(Width(level), Height(level));
+  }
+  return image;
+}
+
+}  // namespace theia
@@ -0,0 +1,106 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#ifndef THEIA_IMAGE_IMAGE_PYRAMID_H_
+#define THEIA_IMAGE_IMAGE_PYRAMID_H_
+
+#include <memory>
+#include <mutex>  // NOLINT
+#include <string>
+#include <vector>
+
+#include "theia/util/util.h"
+
+namespace theia {
+class FloatImage;
+
+// A multi-resolution pyramid of an image where each level is half the size of
+// the previous one, i.e. level i is ceil(width / 2^i) x ceil(height / 2^i).
+// Levels are computed the first time they are requested and are cached
+// afterwards, so callers that only need a coarse level (e.g. matching at half
+// resolution or thumbnails for image retrieval) never touch the full
+// resolution image.
+//
+// A missing level is downsampled from the nearest finer level in the cache. If
+// there is none and the pyramid was created from an image file, the level is
+// decoded directly at its resolution with ReadImageAtScale, which is much
+// faster than decoding the full image for JPEG images. Fetching levels is
+// thread-safe.
+class ImagePyramid {
+ public:
+  // Creates a pyramid for the image file. Only the image header is read here.
+  ImagePyramid(const std::string& filename, const int num_levels);
+  // Creates a pyramid for the image. The image is copied into level 0.
+  ImagePyramid(const FloatImage& image, const int num_levels);
+  ~ImagePyramid();
+
+  int NumLevels() const { return num_levels_; }
+
+  // The size of the level, which is known without computing the level.
+  int Width(const int level) const;
+  int Height(const int level) const;
+
+  // The scale of the level with respect to the full resolution image.
+  double Scale(const int level) const;
+
+  // Returns the level, computing it if it is not in the cache yet. The
+  // shared_ptr keeps the level alive while the caller uses it even if the
+  // level is evicted with ClearLevel.
+  std::shared_ptr<const FloatImage> Level(const int level);
+
+  // Returns true if the level has been computed and is held in the cache.
+  bool HasLevel(const int level) const;
+
+  // Removes the level from the cache to free memory.
+  void ClearLevel(const int level);
+
+ private:
+  // Computes the level from the nearest finer level in the cache or from the
+  // image file.
+  std::shared_ptr<const FloatImage> ComputeLevel(const int level) const;
+
+  const std::string filename_;
+  const int num_levels_;
+  int width_;
+  int height_;
+
+  mutable std::mutex mutex_;
+  std::vector<std::shared_ptr<const FloatImage> > levels_;
+
+  DISALLOW_COPY_AND_ASSIGN(ImagePyramid);
+};
+
+}  // namespace theia
+
+#endif  // THEIA_IMAGE_IMAGE_PYRAMID_H_
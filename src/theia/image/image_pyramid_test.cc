@@ -0,0 +1,92 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#include <string>
+
+#include "gtest/gtest.h"
+#include "theia/image/image.h"
+#include "theia/image/image_pyramid.h"
+
+namespace theia {
+
+namespace {
+
+const std::string img_filename =
+    THEIA_DATA_DIR + std::string("/") + "image/test1.jpg";
+
+}  // namespace
+
+TEST(ImagePyramid, LevelSizes) {
+  const FloatImage image(img_filename);
+  static const int kNumLevels = 5;
+  ImagePyramid pyramid(img_filename, kNumLevels);
+  EXPECT_EQ(pyramid.NumLevels(), kNumLevels);
+  for (int i = 0; i < kNumLevels; i++) {
+    EXPECT_FALSE(pyramid.HasLevel(i));
+    const int scale_denominator = 1 << i;
+    EXPECT_EQ(pyramid.Width(i),
+              (image.Width() + scale_denominator - 1) / scale_denominator);
+    EXPECT_EQ(pyramid.Height(i),
+              (image.Height() + scale_denominator - 1) / scale_denominator);
+    EXPECT_DOUBLE_EQ(pyramid.Scale(i), 1.0 / scale_denominator);
+  }
+
+  // Coarse levels are decoded directly from the file, including levels that
+  // are coarser than the maximum libjpeg scaling.
+  for (int i = kNumLevels - 1; i >= 0; i--) {
+    const std::shared_ptr<const FloatImage> level = pyramid.Level(i);
+    EXPECT_TRUE(pyramid.HasLevel(i));
+    EXPECT_EQ(level->Width(), pyramid.Width(i));
+    EXPECT_EQ(level->Height(), pyramid.Height(i));
+    EXPECT_EQ(level->Channels(), image.Channels());
+  }
+}
+
+TEST(ImagePyramid, CachesLevels) {
+  const FloatImage image(img_filename);
+  ImagePyramid pyramid(image, 3);
+  EXPECT_TRUE(pyramid.HasLevel(0));
+  EXPECT_FALSE(pyramid.HasLevel(2));
+
+  const std::shared_ptr<const FloatImage> level = pyramid.Level(2);
+  EXPECT_EQ(level.get(), pyramid.Level(2).get());
+  EXPECT_FALSE(pyramid.HasLevel(1));
+
+  // The caller keeps the level alive after it is cleared from the cache.
+  pyramid.ClearLevel(2);
+  EXPECT_FALSE(pyramid.HasLevel(2));
+  EXPECT_EQ(level->Width(), pyramid.Width(2));
+}
+
+}  // namespace theia
@@ -37,8 +37,10 @@
 #include <OpenImageIO/imagebufalgo.h>
 #include <gflags/gflags.h>
 #include <stdio.h>
+#include <cmath>
 #include <string>
 
+#include "theia/image/byte_image.h"
 #include "theia/image/image.h"
 #include "theia/util/random.h"
 #include "gtest/gtest.h"
@@ -221,4 +223,56 @@ TEST(Image, ResizeUninitialized) {
   EXPECT_EQ(theia_img2.Channels(), 3);
 }
 
+TEST(Image, ReadAtScale) {
+  const FloatImage full_img(img_filename);
+  for (const int scale_denominator : {1, 2, 4, 8}) {
+    const FloatImage theia_img(img_filename, scale_denominator);
+    EXPECT_EQ(theia_img.Width(),
+              (full_img.Width() + scale_denominator - 1) / scale_denominator);
+    EXPECT_EQ(theia_img.Height(),
+              (full_img.Height() + scale_denominator - 1) / scale_denominator);
+    EXPECT_EQ(theia_img.Channels(), full_img.Channels());
+  }
+
+  // Decoding at scale should be close to resizing the full image.
+  static const float kTolerance = 0.1;
+  FloatImage resized_img(full_img);
+  const FloatImage half_img(img_filename, 2);
+  resized_img.Resize(half_img.Width(), half_img.Height());
+  double mean_error = 0;
+  for (int y = 0; y < half_img.Height(); y++) {
+    for (int x = 0; x < half_img.Width(); x++) {
+      mean_error += std::abs(half_img.GetXY(x, y, 0) -
+                             resized_img.GetXY(x, y, 0));
+    }
+  }
+  mean_error /= half_img.Width() * half_img.Height();
+  EXPECT_LT(mean_error, kTolerance);
+}
+
+TEST(Image, ByteImage) {
+  // Both images are decoded the same way when read at scale.
+  const FloatImage float_img(img_filename, 1);
+  const ByteImage byte_img(img_filename);
+  ASSERT_EQ(byte_img.Width(), float_img.Width());
+  ASSERT_EQ(byte_img.Height(), float_img.Height());
+  ASSERT_EQ(byte_img.Channels(), float_img.Channels());
+
+  // The test image is an 8-bit image so the conversion is lossless.
+  const FloatImage converted_img = byte_img.AsFloatImage();
+  for (int y = 0; y < float_img.Height(); y++) {
+    for (int x = 0; x < float_img.Width(); x++) {
+      for (int c = 0; c < float_img.Channels(); c++) {
+        EXPECT_FLOAT_EQ(converted_img.GetXY(x, y, c),
+                        float_img.GetXY(x, y, c));
+        EXPECT_EQ(byte_img.GetXY(x, y, c),
+                  static_cast<int>(float_img.GetXY(x, y, c) * 255.0f + 0.5f));
+      }
+    }
+  }
+
+  const ByteImage quantized_img(float_img);
+  EXPECT_EQ(quantized_img.GetXY(10, 10, 0), byte_img.GetXY(10, 10, 0));
+}
+
 }  // namespace theia
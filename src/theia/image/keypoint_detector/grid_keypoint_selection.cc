@@ -0,0 +1,108 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#include "theia/image/keypoint_detector/grid_keypoint_selection.h"
+
+#include <Eigen/Core>
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <numeric>
+#include <vector>
+
+namespace theia {
+
+std::vector<int> SelectKeypointsInGrid(
+    const std::vector<Eigen::Vector2d>& positions,
+    const std::vector<double>& responses,
+    const int image_width,
+    const int image_height,
+    const int cell_size,
+    const int max_num_keypoints) {
+  CHECK_EQ(positions.size(), responses.size());
+  CHECK_GT(cell_size, 0);
+  CHECK_GE(max_num_keypoints, 0);
+
+  const int num_keypoints = positions.size();
+  std::vector<int> selected(num_keypoints);
+  std::iota(selected.begin(), selected.end(), 0);
+  if (num_keypoints <= max_num_keypoints) {
+    return selected;
+  }
+
+  // Assign each keypoint to its cell. Keypoints slightly outside of the image
+  // are assigned to the border cells.
+  const int num_cols = std::max((image_width + cell_size - 1) / cell_size, 1);
+  const int num_rows = std::max((image_height + cell_size - 1) / cell_size, 1);
+  std::vector<int> cells(num_keypoints);
+  for (int i = 0; i < num_keypoints; i++) {
+    const int col = std::min(
+        std::max(static_cast<int>(positions[i].x()) / cell_size, 0),
+        num_cols - 1);
+    const int row = std::min(
+        std::max(static_cast<int>(positions[i].y()) / cell_size, 0),
+        num_rows - 1);
+    cells[i] = row * num_cols + col;
+  }
+
+  // Rank the keypoints within each cell by decreasing response.
+  std::vector<int> order(num_keypoints);
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(), [&](const int i, const int j) {
+    if (cells[i] != cells[j]) {
+      return cells[i] < cells[j];
+    }
+    return responses[i] > responses[j];
+  });
+  std::vector<int> rank_in_cell(num_keypoints);
+  for (int i = 0; i < num_keypoints; i++) {
+    rank_in_cell[order[i]] =
+        (i > 0 && cells[order[i]] == cells[order[i - 1]])
+            ? rank_in_cell[order[i - 1]] + 1
+            : 0;
+  }
+
+  // Take the keypoints by rank and then by response.
+  std::stable_sort(order.begin(), order.end(), [&](const int i, const int j) {
+    if (rank_in_cell[i] != rank_in_cell[j]) {
+      return rank_in_cell[i] < rank_in_cell[j];
+    }
+    return responses[i] > responses[j];
+  });
+  selected.assign(order.begin(), order.begin() + max_num_keypoints);
+  std::sort(selected.begin(), selected.end());
+  return selected;
+}
+
+}  // namespace theia
@@ -0,0 +1,65 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#ifndef THEIA_IMAGE_KEYPOINT_DETECTOR_GRID_KEYPOINT_SELECTION_H_
+#define THEIA_IMAGE_KEYPOINT_DETECTOR_GRID_KEYPOINT_SELECTION_H_
+
+#include <Eigen/Core>
+#include <vector>
+
+namespace theia {
+
+// Selects at most max_num_keypoints keypoints that are spread uniformly over
+// the image. The image is divided into a grid of cell_size x cell_size cells
+// and the keypoints of each cell are ranked by their response. Keypoints are
+// then taken by rank across all cells, i.e. the strongest keypoint of every
+// cell is selected before the second strongest keypoint of any cell, and
+// keypoints of equal rank are taken by decreasing response. Cells with few
+// keypoints therefore leave their share of the budget to the dense cells, and
+// weak keypoints in textured regions are suppressed in favor of keypoints in
+// sparse regions.
+//
+// Returns the indices of the selected keypoints in increasing order. All
+// keypoints are selected if there are at most max_num_keypoints of them.
+std::vector<int> SelectKeypointsInGrid(
+    const std::vector<Eigen::Vector2d>& positions,
+    const std::vector<double>& responses,
+    const int image_width,
+    const int image_height,
+    const int cell_size,
+    const int max_num_keypoints);
+
+}  // namespace theia
+
+#endif  // THEIA_IMAGE_KEYPOINT_DETECTOR_GRID_KEYPOINT_SELECTION_H_
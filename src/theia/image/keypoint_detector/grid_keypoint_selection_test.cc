@@ -0,0 +1,82 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#include <Eigen/Core>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "theia/image/keypoint_detector/grid_keypoint_selection.h"
+
+namespace theia {
+
+TEST(SelectKeypointsInGrid, KeepsAllKeypointsWithinBudget) {
+  const std::vector<Eigen::Vector2d> positions = {
+      Eigen::Vector2d(1, 1), Eigen::Vector2d(2, 2), Eigen::Vector2d(50, 50)};
+  const std::vector<double> responses = {1.0, 2.0, 3.0};
+  const std::vector<int> selected =
+      SelectKeypointsInGrid(positions, responses, 100, 100, 10, 3);
+  EXPECT_EQ(selected, std::vector<int>({0, 1, 2}));
+}
+
+TEST(SelectKeypointsInGrid, SpreadsKeypointsOverCells) {
+  // Many strong keypoints in the top-left cell and a weak keypoint in each of
+  // the other cells.
+  std::vector<Eigen::Vector2d> positions;
+  std::vector<double> responses;
+  for (int i = 0; i < 10; i++) {
+    positions.emplace_back(i, i);
+    responses.emplace_back(10.0 + i);
+  }
+  positions.emplace_back(15, 5);
+  responses.emplace_back(1.0);
+  positions.emplace_back(5, 15);
+  responses.emplace_back(2.0);
+  positions.emplace_back(15, 15);
+  responses.emplace_back(3.0);
+
+  // The best keypoint of each cell is selected first.
+  std::vector<int> selected =
+      SelectKeypointsInGrid(positions, responses, 20, 20, 10, 4);
+  EXPECT_EQ(selected, std::vector<int>({9, 10, 11, 12}));
+
+  // The remaining budget goes to the strongest keypoints of the dense cell.
+  selected = SelectKeypointsInGrid(positions, responses, 20, 20, 10, 6);
+  EXPECT_EQ(selected, std::vector<int>({7, 8, 9, 10, 11, 12}));
+
+  // Keypoints of the same rank are taken by response.
+  selected = SelectKeypointsInGrid(positions, responses, 20, 20, 10, 2);
+  EXPECT_EQ(selected, std::vector<int>({9, 12}));
+}
+
+}  // namespace theia
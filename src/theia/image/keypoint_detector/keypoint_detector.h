@@ -35,6 +35,7 @@
 #ifndef THEIA_IMAGE_KEYPOINT_DETECTOR_KEYPOINT_DETECTOR_H_
 #define THEIA_IMAGE_KEYPOINT_DETECTOR_KEYPOINT_DETECTOR_H_
 
+#include <functional>
 #include <vector>
 
 #include "theia/image/keypoint_detector/keypoint.h"
@@ -43,6 +44,12 @@
 namespace theia {
 class FloatImage;
 
+// Decides from the position (in pixels) of a detected keypoint whether the
+// keypoint is kept, e.g. because it is not masked out. Detectors that support
+// a filter test keypoints before computing their orientations and descriptors.
+typedef std::function<bool(const double x, const double y)>
+    KeypointPositionFilter;
+
 // A pure virtual class for keypoint detectors. We assume that the keypoint
 // detectors only use grayimages for now.
 class KeypointDetector {
@@ -38,12 +38,232 @@ extern "C" {
 #include <vlfeat/vl/sift.h>
 }
 
+#include <glog/logging.h>
+
+#include <array>
+#include <cmath>
+#include <memory>
 #include <vector>
 
 #include "theia/image/image.h"
+#include "theia/image/keypoint_detector/grid_keypoint_selection.h"
 #include "theia/image/keypoint_detector/keypoint.h"
+#include "theia/util/executor.h"
 
 namespace theia {
+namespace {
+
+static constexpr int kNumSiftDimensions = 128;
+
+// Returns the keypoints detected in the current octave of the sift filter that
+// are kept by the filter, or all of them if there is no filter.
+std::vector<VlSiftKeypoint> FilterSiftKeypoints(
+    const KeypointPositionFilter& keep_position,
+    const VlSiftFilt* sift_filter) {
+  const VlSiftKeypoint* vl_keypoints = vl_sift_get_keypoints(sift_filter);
+  const int num_keypoints = vl_sift_get_nkeypoints(sift_filter);
+  std::vector<VlSiftKeypoint> kept_keypoints;
+  kept_keypoints.reserve(num_keypoints);
+  for (int i = 0; i < num_keypoints; i++) {
+    if (keep_position == nullptr ||
+        keep_position(vl_keypoints[i].x, vl_keypoints[i].y)) {
+      kept_keypoints.emplace_back(vl_keypoints[i]);
+    }
+  }
+  return kept_keypoints;
+}
+
+}  // namespace
+
+void UpdateSiftOctaveGradient(VlSiftFilt* sift_filter) {
+  // The orientation of a keypoint at the origin of the octave at the lowest
+  // valid scale is cheap to compute and always updates the gradient.
+  VlSiftKeypoint keypoint;
+  keypoint.o = sift_filter->o_cur;
+  keypoint.ix = 0;
+  keypoint.iy = 0;
+  keypoint.is = sift_filter->s_min + 1;
+  keypoint.x = 0;
+  keypoint.y = 0;
+  keypoint.s = keypoint.is;
+  keypoint.sigma = std::pow(2.0, sift_filter->o_cur) * sift_filter->sigma0;
+  double angles[4];
+  vl_sift_calc_keypoint_orientations(sift_filter, angles, &keypoint);
+}
+
+double SiftKeypointResponse(const VlSiftFilt* sift_filter,
+                            const VlSiftKeypoint& keypoint) {
+  // The DoG levels of the octave range from s_min to s_max - 1.
+  const int width = sift_filter->octave_width;
+  const int height = sift_filter->octave_height;
+  const vl_sift_pix* dog =
+      sift_filter->dog + keypoint.ix + width * keypoint.iy +
+      width * height * (keypoint.is - sift_filter->s_min);
+  return std::abs(*dog);
+}
+
+void ComputeSiftOctaveKeypoints(const SiftParameters& sift_params,
+                                VlSiftFilt* sift_filter,
+                                std::vector<Keypoint>* keypoints,
+                                std::vector<Eigen::VectorXf>* descriptors) {
+  const VlSiftKeypoint* vl_keypoints = vl_sift_get_keypoints(sift_filter);
+  const int num_keypoints = vl_sift_get_nkeypoints(sift_filter);
+  ComputeSiftOctaveKeypoints(
+      sift_params,
+      sift_filter,
+      std::vector<VlSiftKeypoint>(vl_keypoints, vl_keypoints + num_keypoints),
+      keypoints,
+      descriptors);
+}
+
+void ComputeSiftOctaveKeypoints(const SiftParameters& sift_params,
+                                VlSiftFilt* sift_filter,
+                                const std::vector<VlSiftKeypoint>& vl_keypoints,
+                                std::vector<Keypoint>* keypoints,
+                                std::vector<Eigen::VectorXf>* descriptors) {
+  const int num_keypoints = vl_keypoints.size();
+  if (num_keypoints == 0) {
+    return;
+  }
+
+  // The results are stored per keypoint so that they can be appended in the
+  // order of detection once all blocks are processed.
+  std::vector<std::array<double, 4> > angles(num_keypoints);
+  std::vector<int> num_angles(num_keypoints);
+  std::vector<Eigen::VectorXf> octave_descriptors(
+      descriptors != nullptr ? 4 * num_keypoints : 0);
+
+  UpdateSiftOctaveGradient(sift_filter);
+  ParallelFor(
+      sift_params.num_threads,
+      num_keypoints,
+      [&](const int start, const int end) {
+        for (int i = start; i < end; i++) {
+          // Calculate (up to 4) orientations of the keypoint.
+          num_angles[i] = vl_sift_calc_keypoint_orientations(
+              sift_filter, angles[i].data(), &vl_keypoints[i]);
+          // If upright sift is enabled, only use the first keypoint at a given
+          // pixel location.
+          if (sift_params.upright_sift && num_angles[i] > 1) {
+            num_angles[i] = 1;
+          }
+          if (descriptors == nullptr) {
+            continue;
+          }
+          for (int j = 0; j < num_angles[i]; j++) {
+            Eigen::VectorXf& descriptor = octave_descriptors[4 * i + j];
+            descriptor.setZero(kNumSiftDimensions);
+            vl_sift_calc_keypoint_descriptor(
+                sift_filter, descriptor.data(), &vl_keypoints[i], angles[i][j]);
+          }
+        }
+      });
+
+  for (int i = 0; i < num_keypoints; i++) {
+    for (int j = 0; j < num_angles[i]; j++) {
+      Keypoint keypoint(vl_keypoints[i].x, vl_keypoints[i].y, Keypoint::SIFT);
+      keypoint.set_strength(
+          SiftKeypointResponse(sift_filter, vl_keypoints[i]));
+      keypoint.set_scale(vl_keypoints[i].sigma);
+      keypoint.set_orientation(angles[i][j]);
+      keypoints->push_back(keypoint);
+      if (descriptors != nullptr) {
+        descriptors->emplace_back(std::move(octave_descriptors[4 * i + j]));
+      }
+    }
+  }
+}
+
+void DetectSiftKeypoints(const SiftParameters& sift_params,
+                         VlSiftFilt* sift_filter,
+                         float* image_data,
+                         const KeypointPositionFilter& keep_position,
+                         std::vector<Keypoint>* keypoints,
+                         std::vector<Eigen::VectorXf>* descriptors) {
+  // VLFeat caches the gradient by octave index only, so the cache must be
+  // invalidated whenever the scale space is (re)computed.
+  int vl_status = vl_sift_process_first_octave(sift_filter, image_data);
+  sift_filter->grad_o = sift_filter->o_min - 1;
+
+  if (sift_params.max_num_features <= 0) {
+    // Process octaves until you can't anymore.
+    while (vl_status != VL_ERR_EOF) {
+      // Detect the keypoints and compute their orientations and descriptors.
+      vl_sift_detect(sift_filter);
+      if (keep_position == nullptr) {
+        ComputeSiftOctaveKeypoints(
+            sift_params, sift_filter, keypoints, descriptors);
+      } else {
+        ComputeSiftOctaveKeypoints(sift_params,
+                                   sift_filter,
+                                   FilterSiftKeypoints(keep_position,
+                                                       sift_filter),
+                                   keypoints,
+                                   descriptors);
+      }
+      // Attempt to process the next octave.
+      vl_status = vl_sift_process_next_octave(sift_filter);
+    }
+    return;
+  }
+
+  // Detect the keypoints of all octaves without computing orientations or
+  // descriptors.
+  std::vector<std::vector<VlSiftKeypoint> > octave_keypoints;
+  std::vector<Eigen::Vector2d> positions;
+  std::vector<double> responses;
+  while (vl_status != VL_ERR_EOF) {
+    vl_sift_detect(sift_filter);
+    // Filtered keypoints are dropped before the selection so that they do not
+    // take the place of kept keypoints in the grid.
+    octave_keypoints.emplace_back(
+        FilterSiftKeypoints(keep_position, sift_filter));
+    for (const VlSiftKeypoint& vl_keypoint : octave_keypoints.back()) {
+      positions.emplace_back(vl_keypoint.x, vl_keypoint.y);
+      responses.emplace_back(SiftKeypointResponse(sift_filter, vl_keypoint));
+    }
+    vl_status = vl_sift_process_next_octave(sift_filter);
+  }
+
+  const std::vector<int> selected = SelectKeypointsInGrid(
+      positions,
+      responses,
+      sift_filter->width,
+      sift_filter->height,
+      sift_params.feature_grid_cell_size,
+      sift_params.max_num_features);
+  VLOG(2) << "Selected " << selected.size() << " of " << positions.size()
+          << " SIFT keypoints.";
+
+  // Keep the selected keypoints of each octave in the order of detection.
+  std::vector<std::vector<VlSiftKeypoint> > selected_keypoints(
+      octave_keypoints.size());
+  int octave = 0;
+  int octave_start = 0;
+  for (const int index : selected) {
+    while (index >= octave_start + octave_keypoints[octave].size()) {
+      octave_start += octave_keypoints[octave].size();
+      ++octave;
+    }
+    selected_keypoints[octave].emplace_back(
+        octave_keypoints[octave][index - octave_start]);
+  }
+
+  // Recompute the scale space to compute the orientations and descriptors of
+  // the selected keypoints only.
+  vl_status = vl_sift_process_first_octave(sift_filter, image_data);
+  sift_filter->grad_o = sift_filter->o_min - 1;
+  for (octave = 0; octave < selected_keypoints.size(); ++octave) {
+    CHECK_NE(vl_status, VL_ERR_EOF);
+    ComputeSiftOctaveKeypoints(sift_params,
+                               sift_filter,
+                               selected_keypoints[octave],
+                               keypoints,
+                               descriptors);
+    vl_status = vl_sift_process_next_octave(sift_filter);
+  }
+}
+
 SiftDetector::~SiftDetector() {
   if (sift_filter_ != nullptr) vl_sift_delete(sift_filter_);
 }
@@ -71,41 +291,13 @@ bool SiftDetector::DetectKeypoints(const FloatImage& image,
   // input, so the best solution (for now) is to copy the image.
   FloatImage mutable_image(image.AsGrayscaleImage());
 
-  // Calculate the first octave to process.
-  int vl_status =
-      vl_sift_process_first_octave(sift_filter_, mutable_image.Data());
   // Reserve an amount that is slightly larger than what a typical detector
   // would return.
   keypoints->reserve(2000);
 
-  // Process octaves until you can't anymore.
-  while (vl_status != VL_ERR_EOF) {
-    // Detect the keypoints.
-    vl_sift_detect(sift_filter_);
-    // Get the keypoints.
-    const VlSiftKeypoint* vl_keypoints = vl_sift_get_keypoints(sift_filter_);
-    int num_keypoints = vl_sift_get_nkeypoints(sift_filter_);
-
-    for (int i = 0; i < num_keypoints; i++) {
-      // Calculate (up to 4) orientations of the keypoint.
-      double angles[4];
-      int num_angles = vl_sift_calc_keypoint_orientations(
-          sift_filter_, angles, &vl_keypoints[i]);
-      // If upright sift is enabled, only use the first keypoint at a given
-      // pixel location.
-      if (sift_params_.upright_sift && num_angles > 1) {
-        num_angles = 1;
-      }
-      for (int j = 0; j < num_angles; j++) {
-        Keypoint keypoint(vl_keypoints[i].x, vl_keypoints[i].y, Keypoint::SIFT);
-        keypoint.set_scale(vl_keypoints[i].sigma);
-        keypoint.set_orientation(angles[j]);
-        keypoints->push_back(keypoint);
-      }
-    }
-    // Attempt to process the next octave.
-    vl_status = vl_sift_process_next_octave(sift_filter_);
-  }
+  DetectSiftKeypoints(
+      sift_params_, sift_filter_, mutable_image.Data(), nullptr, keypoints,
+      nullptr);
   return true;
 }
 }  // namespace theia
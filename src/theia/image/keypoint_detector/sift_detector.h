@@ -39,6 +39,7 @@ extern "C" {
 #include <vlfeat/vl/sift.h>
 }
 
+#include <Eigen/Core>
 #include <vector>
 
 #include "theia/image/keypoint_detector/keypoint_detector.h"
@@ -49,6 +50,51 @@ namespace theia {
 class FloatImage;
 class Keypoint;
 
+// VLFeat computes the gradient of an octave lazily when the first orientation
+// or descriptor of the octave is computed, so these computations cannot run
+// concurrently until the gradient is up to date. This function updates the
+// gradient of the current octave of the sift filter so that orientations and
+// descriptors can be computed in parallel afterwards.
+void UpdateSiftOctaveGradient(VlSiftFilt* sift_filter);
+
+// Returns the absolute difference of Gaussians response of a keypoint detected
+// in the current octave of the sift filter.
+double SiftKeypointResponse(const VlSiftFilt* sift_filter,
+                            const VlSiftKeypoint& keypoint);
+
+// Computes the orientations of the keypoints detected in the current octave of
+// the sift filter and appends the oriented keypoints. If descriptors is not
+// null the descriptors of the keypoints are appended as well. The keypoints are
+// processed in blocks on sift_params.num_threads threads and are returned in
+// the order of detection regardless of the number of threads.
+void ComputeSiftOctaveKeypoints(const SiftParameters& sift_params,
+                                VlSiftFilt* sift_filter,
+                                std::vector<Keypoint>* keypoints,
+                                std::vector<Eigen::VectorXf>* descriptors);
+
+// Same as above for the given keypoints, which must belong to the current
+// octave of the sift filter.
+void ComputeSiftOctaveKeypoints(const SiftParameters& sift_params,
+                                VlSiftFilt* sift_filter,
+                                const std::vector<VlSiftKeypoint>& vl_keypoints,
+                                std::vector<Keypoint>* keypoints,
+                                std::vector<Eigen::VectorXf>* descriptors);
+
+// Runs the sift filter over all octaves of the grayscale image and appends the
+// oriented keypoints, and their descriptors if descriptors is not null. If
+// sift_params.max_num_features is positive, the keypoints of all octaves are
+// detected and selected first, and the octaves are processed a second time to
+// compute the orientations and descriptors of the selected keypoints. If
+// keep_position is not null, keypoints at the positions it rejects are dropped
+// right after detection, before their orientations and descriptors are
+// computed and before the selection.
+void DetectSiftKeypoints(const SiftParameters& sift_params,
+                         VlSiftFilt* sift_filter,
+                         float* image_data,
+                         const KeypointPositionFilter& keep_position,
+                         std::vector<Keypoint>* keypoints,
+                         std::vector<Eigen::VectorXf>* descriptors);
+
 // SIFT detector as originally proposed by David Lowe. This relies on the open
 // source software VLFeat (www.vlfeat.org) to detect keypoints.
 class SiftDetector : public KeypointDetector {
@@ -76,4 +76,28 @@ TEST(SiftDetector, DifferentImageSizes) {
   EXPECT_TRUE(sift_extractor.DetectKeypoints(input_img2, &keypoints));
 }
 
+TEST(SiftDetector, MultiThreadedDetectionMatchesSingleThreaded) {
+  FloatImage input_img(img_filename);
+
+  SiftParameters sift_params;
+  SiftDetector single_threaded_detector(sift_params);
+  std::vector<Keypoint> keypoints;
+  EXPECT_TRUE(single_threaded_detector.DetectKeypoints(input_img, &keypoints));
+
+  sift_params.num_threads = 4;
+  SiftDetector multi_threaded_detector(sift_params);
+  std::vector<Keypoint> multi_threaded_keypoints;
+  EXPECT_TRUE(multi_threaded_detector.DetectKeypoints(
+      input_img, &multi_threaded_keypoints));
+
+  ASSERT_EQ(keypoints.size(), multi_threaded_keypoints.size());
+  for (int i = 0; i < keypoints.size(); i++) {
+    EXPECT_EQ(keypoints[i].x(), multi_threaded_keypoints[i].x());
+    EXPECT_EQ(keypoints[i].y(), multi_threaded_keypoints[i].y());
+    EXPECT_EQ(keypoints[i].scale(), multi_threaded_keypoints[i].scale());
+    EXPECT_EQ(keypoints[i].orientation(),
+              multi_threaded_keypoints[i].orientation());
+  }
+}
+
 }  // namespace theia
@@ -72,6 +72,24 @@ struct SiftParameters {
   // location. This is useful for SfM for a number of reasons, especially during
   // geometric verification.
   bool upright_sift = true;
+
+  // Number of threads used to process a single image. VLFeat builds the scale
+  // space of an octave from the previous octave, so the octaves are computed
+  // one after the other, but the orientations and descriptors of the keypoints
+  // within an octave are computed in parallel. The keypoints and descriptors
+  // are the same for any number of threads.
+  int num_threads = 1;
+
+  // If positive, at most max_num_features keypoints are kept per image. The
+  // keypoints of all octaves are detected first and selected with
+  // SelectKeypointsInGrid on cells of feature_grid_cell_size pixels by their
+  // DoG response, so that the features are spread over the image. Only the
+  // selected keypoints have their orientations and descriptors computed, which
+  // requires building the scale space a second time. With upright_sift
+  // disabled, a keypoint may produce up to 4 features with different
+  // orientations.
+  int max_num_features = 0;
+  int feature_grid_cell_size = 128;
 };
 
 }  // namespace theia
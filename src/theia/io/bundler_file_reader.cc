@@ -42,25 +42,23 @@
 #include <Eigen/Core>
 #include <glog/logging.h>
 
+#include "theia/io/text_parser.h"
 #include "theia/sfm/reconstruction.h"
+#include "theia/util/filesystem.h"
+#include "theia/util/mapped_file.h"
 
 namespace theia {
 namespace {
-bool ReadHeader(FILE* in, int* num_cameras, int* num_points) {
+bool ReadHeader(TextParser* in, int* num_cameras, int* num_points) {
   // Read the comment.
-  char* line = nullptr;
-  size_t length = 0;
-  if ((getline(&line, &length, in) == -1) || line[0] != '#') {
-    free(line);
+  if (in->AtEnd() || *in->position() != '#') {
     return false;
   }
-  VLOG(3) << "Comment: " << line;
-  free(line);
+  in->SkipLine();
   // Read number of points and cameras.
-  if (fscanf(
-          in, "%d %d", CHECK_NOTNULL(num_cameras), CHECK_NOTNULL(num_points)) !=
-          2 ||
-      *num_cameras < 1 || *num_points < 1) {
+  if (!in->ParseInt(CHECK_NOTNULL(num_cameras)) ||
+      !in->ParseInt(CHECK_NOTNULL(num_points)) || *num_cameras < 1 ||
+      *num_points < 1) {
     return false;
   }
   VLOG(3) << "Num cameras to read: " << *num_cameras;
@@ -68,57 +66,37 @@ bool ReadHeader(FILE* in, int* num_cameras, int* num_points) {
   return true;
 }
 
-bool ReadCamera(FILE* in, BundlerCamera* camera) {
+bool ReadCamera(TextParser* in, BundlerCamera* camera) {
   // Read focal length and radial distortion coeffs.
-  if (fscanf(in,
-             "%f %f %f",
-             &camera->focal_length,
-             &camera->radial_coeff_1,
-             &camera->radial_coeff_2) != 3) {
+  if (!in->ParseFloat(&camera->focal_length) ||
+      !in->ParseFloat(&camera->radial_coeff_1) ||
+      !in->ParseFloat(&camera->radial_coeff_2)) {
     VLOG(3) << "Unable to read focal length and radial distortion coeffs.";
     return false;
   }
   // Read rotation matrix.
   Eigen::Matrix3d& rotation = camera->rotation;
-  if (fscanf(in,
-             "%lf %lf %lf",
-             &rotation(0, 0),
-             &rotation(0, 1),
-             &rotation(0, 2)) != 3) {
-    VLOG(3) << "Unable to read first row of rotation matrix.";
-    return false;
-  }
-  if (fscanf(in,
-             "%lf %lf %lf",
-             &rotation(1, 0),
-             &rotation(1, 1),
-             &rotation(1, 2)) != 3) {
-    VLOG(3) << "Unable to read second row of rotation matrix.";
-    return false;
-  }
-  if (fscanf(in,
-             "%lf %lf %lf",
-             &rotation(2, 0),
-             &rotation(2, 1),
-             &rotation(2, 2)) != 3) {
-    VLOG(3) << "Unable to read third row of rotation matrix.";
-    return false;
+  for (int i = 0; i < 3; i++) {
+    for (int j = 0; j < 3; j++) {
+      if (!in->ParseDouble(&rotation(i, j))) {
+        VLOG(3) << "Unable to read row " << i << " of rotation matrix.";
+        return false;
+      }
+    }
   }
   // Read position.
   Eigen::Vector3d& translation = camera->translation;
-  if (fscanf(in,
-             "%lf %lf %lf",
-             &translation(0),
-             &translation(1),
-             &translation(2)) != 3) {
-    VLOG(3) << "Unable to read camera translation.";
-    return false;
+  for (int i = 0; i < 3; i++) {
+    if (!in->ParseDouble(&translation(i))) {
+      VLOG(3) << "Unable to read camera translation.";
+      return false;
+    }
   }
   return true;
 }
 
 bool ReadCameras(const int num_cameras,
-                 FILE* in,
+                 TextParser* in,
                  std::vector<BundlerCamera>* cameras) {
   CHECK_NOTNULL(cameras)->reserve(num_cameras);
   for (int i = 0; i < num_cameras; ++i) {
@@ -142,51 +120,43 @@ bool ReadCameras(const int num_cameras,
   return true;
 }
 
-bool ReadViewList(FILE* in, std::vector<FeatureInfo>* view_list) {
+bool ReadViewList(TextParser* in, std::vector<FeatureInfo>* view_list) {
   // Read number of views.
   int num_views = 0;
-  if (fscanf(in, "%d", &num_views) != 1) {
+  if (!in->ParseInt(&num_views) || num_views < 0) {
     VLOG(3) << "Unable to read number of views for point.";
+    return false;
   }
-  VLOG(3) << "Num. views to read: " << num_views;
   view_list->resize(num_views);
-  float entry = 0;
+  // The entries are parsed as floating point numbers since some tools write
+  // the indices and pixel positions that way.
+  double entry[4];
   for (int i = 0; i < view_list->size(); ++i) {
-    // Camera index.
-    if (fscanf(in, "%f", &entry) != 1) {
-      return false;
-    }
-    (*view_list)[i].camera_index = static_cast<int>(entry);
-    // Sift index.
-    if (fscanf(in, "%f", &entry) != 1) {
-      return false;
-    }
-    (*view_list)[i].sift_index = static_cast<int>(entry);
-    // Kpt x.
-    if (fscanf(in, "%f", &entry) != 1) {
-      return false;
-    }
-    (*view_list)[i].kpt_x = static_cast<int>(entry);
-    // Kpt y.
-    if (fscanf(in, "%f", &entry) != 1) {
-      return false;
+    for (int j = 0; j < 4; j++) {
+      if (!in->ParseDouble(&entry[j])) {
+        return false;
+      }
     }
-    (*view_list)[i].kpt_y = static_cast<int>(entry);
+    (*view_list)[i].camera_index = static_cast<int>(entry[0]);
+    (*view_list)[i].sift_index = static_cast<int>(entry[1]);
+    (*view_list)[i].kpt_x = static_cast<int>(entry[2]);
+    (*view_list)[i].kpt_y = static_cast<int>(entry[3]);
   }
   return true;
 }
 
-bool ReadPoint(FILE* in, BundlerPoint* point) {
+bool ReadPoint(TextParser* in, BundlerPoint* point) {
   // Read position.
   Eigen::Vector3d& position = point->position;
-  if (fscanf(in, "%lf %lf %lf", &position(0), &position(1), &position(2)) !=
-      3) {
+  if (!in->ParseDouble(&position(0)) || !in->ParseDouble(&position(1)) ||
+      !in->ParseDouble(&position(2))) {
     VLOG(3) << "Unable to read point position. ";
     return false;
   }
   // Read color.
   Eigen::Vector3d& color = point->color;
-  if (fscanf(in, "%lf %lf %lf", &color(0), &color(1), &color(2)) != 3) {
+  if (!in->ParseDouble(&color(0)) || !in->ParseDouble(&color(1)) ||
+      !in->ParseDouble(&color(2))) {
     VLOG(3) << "Unable to read point color.";
     return false;
   }
@@ -198,16 +168,28 @@ bool ReadPoint(FILE* in, BundlerPoint* point) {
   return true;
 }
 
+// Bundler writes each point on three lines (position, color and view list), so
+// the points are parsed in parallel.
 bool ReadPoints(const int num_points,
-                FILE* in,
+                const int num_threads,
+                TextParser* in,
+                const char* end,
                 std::vector<BundlerPoint>* points) {
-  CHECK_NOTNULL(points)->reserve(num_points);
-  for (int i = 0; i < num_points; ++i) {
-    points->emplace_back();
-    if (!ReadPoint(in, &points->back())) {
-      return false;
-    }
+  CHECK_NOTNULL(points)->resize(num_points);
+  const auto read_point = [&](TextParser* parser, const int i) {
+    return ReadPoint(parser, &(*points)[i]);
+  };
+  const char* points_end;
+  if (!ParseRecords(in->position(),
+                    end,
+                    num_points,
+                    3,
+                    num_threads,
+                    read_point,
+                    &points_end)) {
+    return false;
   }
+  *in = TextParser(points_end, end);
   return true;
 }
 
@@ -250,34 +232,31 @@ bool ReadPoints(const int num_points,
 // towards the top of the image. Thus, (-w/2, -h/2) is the lower-left corner of
 // the image, and (w/2, h/2) is the top-right corner (where w and h are the
 // width and height of the image).
-bool BundlerFileReader::ParseBundleFile() {
-  FILE* in = fopen(bundler_filepath_.c_str(), "r");
-  if (in == nullptr) {
+bool BundlerFileReader::ParseBundleFile(const int num_threads) {
+  if (!FileExists(bundler_filepath_)) {
     LOG(INFO) << "Could not open: " << bundler_filepath_;
     return false;
   }
+  const MappedFile file(bundler_filepath_);
+  const char* end = file.data() + file.size();
+  TextParser in(file.data(), end);
   // Read Header.
   int num_cameras;
   int num_points;
-  if (!ReadHeader(in, &num_cameras, &num_points)) {
-    fclose(in);
+  if (!ReadHeader(&in, &num_cameras, &num_points)) {
     VLOG(3) << "Unable to read header.";
     return false;
   }
   // Read Cameras.
-  if (!ReadCameras(num_cameras, in, &cameras_)) {
-    fclose(in);
+  if (!ReadCameras(num_cameras, &in, &cameras_)) {
     VLOG(3) << "Unable to read cameras.";
     return false;
   }
   // Read Points.
-  if (!ReadPoints(num_points, in, &points_)) {
-    fclose(in);
+  if (!ReadPoints(num_points, num_threads, &in, end, &points_)) {
     VLOG(3) << "Unable to read points.";
     return false;
   }
-  // Close the file.
-  fclose(in);
   bundler_file_parsed_ = true;
   return true;
 }
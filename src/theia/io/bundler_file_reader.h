@@ -104,9 +104,9 @@ class BundlerFileReader {
         lists_file_parsed_(false) {}
   virtual ~BundlerFileReader() {}
 
-  // Parses the bundler output file: bundler_filepath_. Returns true upon
-  // success, and false otherwise.
-  bool ParseBundleFile();
+  // Parses the bundler output file: bundler_filepath_. The points are parsed
+  // with num_threads threads. Returns true upon success, and false otherwise.
+  bool ParseBundleFile(const int num_threads = 1);
 
   // Parses the lists.txt file. Returns true upon success, and false otherwise.
   bool ParseListsFile();
@@ -0,0 +1,393 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+
+#include "theia/io/chunked_matches_file.h"
+
+#include <cereal/archives/portable_binary.hpp>
+#include <cereal/types/string.hpp>
+#include <cereal/types/utility.hpp>
+#include <cereal/types/vector.hpp>
+#include <glog/logging.h>
+
+#include <cstring>
+#include <exception>
+#include <fstream>  // NOLINT
+#include <sstream>  // NOLINT
+#include <string>
+#include <utility>
+#include <vector>
+
+#ifdef WITH_ZSTD
+#include <zstd.h>
+#endif
+
+#include "theia/matching/features_and_matches_database.h"
+#include "theia/matching/image_pair_match.h"
+#include "theia/sfm/camera_intrinsics_prior.h"
+
+namespace theia {
+
+namespace {
+
+static const uint32_t kFileMagic = 0x464d4354;  // "TCMF"
+static const uint32_t kFileVersion = 1;
+
+enum ChunkType : uint32_t { PRIORS = 0, MATCHES = 1, END = 2 };
+enum ChunkCodec : uint32_t { NO_COMPRESSION = 0, ZSTD = 1 };
+
+struct FileHeader {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t reserved[6];
+};
+
+static_assert(sizeof(FileHeader) == 32, "Unexpected file header padding.");
+
+// The header that precedes the stored bytes of each chunk.
+struct ChunkHeader {
+  uint32_t type;
+  uint32_t codec;
+  uint64_t stored_size;
+  uint64_t raw_size;
+  uint32_t num_records;
+  uint32_t reserved;
+};
+
+static_assert(sizeof(ChunkHeader) == 32, "Unexpected chunk header padding.");
+
+template <typename Record>
+std::string SerializeRecords(const std::vector<Record>& records) {
+  std::ostringstream stream;
+  {
+    cereal::PortableBinaryOutputArchive output_archive(stream);
+    output_archive(records);
+  }
+  return stream.str();
+}
+
+template <typename Record>
+bool DeserializeRecords(const std::string& raw,
+                        const uint32_t num_records,
+                        std::vector<Record>* records) {
+  std::istringstream stream(raw);
+  try {
+    cereal::PortableBinaryInputArchive input_archive(stream);
+    input_archive(*records);
+  } catch (const std::exception& e) {
+    LOG(ERROR) << "Could not deserialize a chunk of the matches file: "
+               << e.what();
+    return false;
+  }
+  return records->size() == num_records;
+}
+
+// Returns the decompressed bytes of the chunk in raw.
+bool DecodeChunk(const ChunkHeader& header,
+                 std::string* stored,
+                 std::string* raw) {
+  if (header.codec == NO_COMPRESSION) {
+    std::swap(*stored, *raw);
+    return true;
+  }
+
+#ifdef WITH_ZSTD
+  if (ZSTD_getFrameContentSize(stored->data(), stored->size()) !=
+      header.raw_size) {
+    return false;
+  }
+  raw->resize(header.raw_size);
+  const size_t raw_size = ZSTD_decompress(
+      &(*raw)[0], raw->size(), stored->data(), stored->size());
+  return !ZSTD_isError(raw_size) && raw_size == header.raw_size;
+#else
+  LOG(ERROR) << "The matches file is compressed with zstd but Theia was built "
+                "without zstd. Please build with WITH_ZSTD.";
+  return false;
+#endif
+}
+
+}  // namespace
+
+ChunkedMatchesWriter::ChunkedMatchesWriter(
+    const ChunkedMatchesWriterOptions& options)
+    : options_(options) {
+  CHECK_GT(options_.num_records_per_chunk, 0);
+#ifndef WITH_ZSTD
+  if (options_.compress) {
+    LOG(WARNING) << "Theia was built without zstd. The matches file is written "
+                    "uncompressed.";
+    options_.compress = false;
+  }
+#endif
+}
+
+ChunkedMatchesWriter::~ChunkedMatchesWriter() {
+  if (writer_.is_open()) {
+    LOG(WARNING) << "The matches file was not closed and is incomplete.";
+  }
+}
+
+bool ChunkedMatchesWriter::Open(const std::string& output_file) {
+  CHECK(!writer_.is_open()) << "The matches file is already open.";
+  writer_.open(output_file,
+               std::ios::out | std::ios::binary | std::ios::trunc);
+  if (!writer_.is_open()) {
+    LOG(ERROR) << "Could not open the file: " << output_file
+               << " for writing.";
+    return false;
+  }
+
+  FileHeader header;
+  memset(&header, 0, sizeof(header));
+  header.magic = kFileMagic;
+  header.version = kFileVersion;
+  writer_.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  return writer_.good();
+}
+
+bool ChunkedMatchesWriter::AddCameraIntrinsicsPrior(
+    const std::string& image_name, const CameraIntrinsicsPrior& prior) {
+  CHECK(writer_.is_open()) << "The matches file is not open.";
+  if (!matches_.empty() && !WriteChunk()) {
+    return false;
+  }
+  priors_.emplace_back(image_name, prior);
+  if (static_cast<int>(priors_.size()) < options_.num_records_per_chunk) {
+    return true;
+  }
+  return WriteChunk();
+}
+
+bool ChunkedMatchesWriter::AddImagePairMatch(const ImagePairMatch& match) {
+  CHECK(writer_.is_open()) << "The matches file is not open.";
+  if (!priors_.empty() && !WriteChunk()) {
+    return false;
+  }
+  matches_.emplace_back(match);
+  if (static_cast<int>(matches_.size()) < options_.num_records_per_chunk) {
+    return true;
+  }
+  return WriteChunk();
+}
+
+bool ChunkedMatchesWriter::Close() {
+  CHECK(writer_.is_open()) << "The matches file is not open.";
+  bool success = WriteChunk();
+
+  ChunkHeader end_header;
+  memset(&end_header, 0, sizeof(end_header));
+  end_header.type = END;
+  writer_.write(reinterpret_cast<const char*>(&end_header),
+                sizeof(end_header));
+  writer_.close();
+  success = success && !writer_.fail();
+  if (!success) {
+    LOG(ERROR) << "Could not write the matches file.";
+  }
+  return success;
+}
+
+bool ChunkedMatchesWriter::WriteChunk() {
+  if (priors_.empty() && matches_.empty()) {
+    return true;
+  }
+
+  ChunkHeader header;
+  memset(&header, 0, sizeof(header));
+  std::string raw;
+  if (!priors_.empty()) {
+    header.type = PRIORS;
+    header.num_records = priors_.size();
+    raw = SerializeRecords(priors_);
+    priors_.clear();
+  } else {
+    header.type = MATCHES;
+    header.num_records = matches_.size();
+    raw = SerializeRecords(matches_);
+    matches_.clear();
+  }
+  header.codec = NO_COMPRESSION;
+  header.raw_size = raw.size();
+  header.stored_size = raw.size();
+
+  const std::string* stored = &raw;
+#ifdef WITH_ZSTD
+  std::string compressed;
+  if (options_.compress) {
+    compressed.resize(ZSTD_compressBound(raw.size()));
+    const size_t compressed_size = ZSTD_compress(&compressed[0],
+                                                 compressed.size(),
+                                                 raw.data(),
+                                                 raw.size(),
+                                                 options_.compression_level);
+    if (!ZSTD_isError(compressed_size) && compressed_size < raw.size()) {
+      compressed.resize(compressed_size);
+      header.codec = ZSTD;
+      header.stored_size = compressed_size;
+      stored = &compressed;
+    }
+  }
+#endif
+
+  writer_.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  writer_.write(stored->data(), stored->size());
+  return writer_.good();
+}
+
+bool WriteChunkedMatchesFromDatabase(
+    FeaturesAndMatchesDatabase* features_and_matches_database,
+    const std::string& output_file,
+    const ChunkedMatchesWriterOptions& options) {
+  CHECK_NOTNULL(features_and_matches_database);
+  ChunkedMatchesWriter writer(options);
+  if (!writer.Open(output_file)) {
+    return false;
+  }
+
+  for (const std::string& image_name :
+       features_and_matches_database->ImageNamesOfCameraIntrinsicsPriors()) {
+    if (!writer.AddCameraIntrinsicsPrior(
+            image_name,
+            features_and_matches_database->GetCameraIntrinsicsPrior(
+                image_name))) {
+      return false;
+    }
+  }
+
+  bool success = true;
+  features_and_matches_database->ForEachImagePairMatch(
+      [&](const std::string& image_name1,
+          const std::string& image_name2,
+          const ImagePairMatch& match) {
+        // The matches are identified by their image names in the file, which
+        // databases do not necessarily store in the match itself.
+        if (match.image1 == image_name1 && match.image2 == image_name2) {
+          success = writer.AddImagePairMatch(match);
+        } else {
+          ImagePairMatch named_match = match;
+          named_match.image1 = image_name1;
+          named_match.image2 = image_name2;
+          success = writer.AddImagePairMatch(named_match);
+        }
+        return success;
+      });
+  return writer.Close() && success;
+}
+
+bool ReadChunkedMatches(const std::string& input_file,
+                        const ChunkedPriorCallback& prior_callback,
+                        const ChunkedMatchCallback& match_callback) {
+  std::ifstream reader(input_file, std::ios::in | std::ios::binary);
+  if (!reader.is_open()) {
+    LOG(ERROR) << "Could not open the file: " << input_file
+               << " for reading.";
+    return false;
+  }
+  reader.seekg(0, std::ios::end);
+  const uint64_t file_size = reader.tellg();
+  reader.seekg(0, std::ios::beg);
+
+  FileHeader file_header;
+  if (!reader.read(reinterpret_cast<char*>(&file_header),
+                   sizeof(file_header)) ||
+      file_header.magic != kFileMagic) {
+    LOG(ERROR) << input_file << " is not a chunked matches file.";
+    return false;
+  }
+  if (file_header.version != kFileVersion) {
+    LOG(ERROR) << "Unsupported version " << file_header.version
+               << " of the chunked matches file " << input_file;
+    return false;
+  }
+
+  std::string stored, raw;
+  std::vector<std::pair<std::string, CameraIntrinsicsPrior>> priors;
+  std::vector<ImagePairMatch> matches;
+  uint64_t offset = sizeof(file_header);
+  while (true) {
+    ChunkHeader header;
+    if (!reader.read(reinterpret_cast<char*>(&header), sizeof(header))) {
+      LOG(ERROR) << "The matches file " << input_file << " is truncated.";
+      return false;
+    }
+    offset += sizeof(header);
+    if (header.type == END) {
+      return true;
+    }
+
+    // Validate the header before allocating the chunk.
+    if ((header.type != PRIORS && header.type != MATCHES) ||
+        (header.codec != NO_COMPRESSION && header.codec != ZSTD) ||
+        (header.codec == NO_COMPRESSION &&
+         header.stored_size != header.raw_size) ||
+        header.stored_size > file_size - offset) {
+      LOG(ERROR) << "The matches file " << input_file << " is corrupt.";
+      return false;
+    }
+    stored.resize(header.stored_size);
+    if (!reader.read(&stored[0], stored.size())) {
+      LOG(ERROR) << "The matches file " << input_file << " is truncated.";
+      return false;
+    }
+    offset += header.stored_size;
+    if (!DecodeChunk(header, &stored, &raw)) {
+      LOG(ERROR) << "Could not decode a chunk of the matches file "
+                 << input_file;
+      return false;
+    }
+
+    if (header.type == PRIORS) {
+      if (!DeserializeRecords(raw, header.num_records, &priors)) {
+        return false;
+      }
+      for (const auto& prior : priors) {
+        if (!prior_callback(prior.first, prior.second)) {
+          return true;
+        }
+      }
+    } else {
+      if (!DeserializeRecords(raw, header.num_records, &matches)) {
+        return false;
+      }
+      for (const ImagePairMatch& match : matches) {
+        if (!match_callback(match)) {
+          return true;
+        }
+      }
+    }
+  }
+}
+
+}  // namespace theia
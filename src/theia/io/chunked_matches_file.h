@@ -0,0 +1,147 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+
+#ifndef THEIA_IO_CHUNKED_MATCHES_FILE_H_
+#define THEIA_IO_CHUNKED_MATCHES_FILE_H_
+
+#include <fstream>  // NOLINT
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "theia/matching/image_pair_match.h"
+#include "theia/sfm/camera_intrinsics_prior.h"
+#include "theia/util/util.h"
+
+namespace theia {
+
+class FeaturesAndMatchesDatabase;
+
+// A streaming format for the camera intrinsics priors and the two view matches
+// of a reconstruction. The file is a header followed by a sequence of chunks,
+// each of which holds up to num_records_per_chunk priors or matches serialized
+// with cereal and optionally compressed with zstd. The last chunk is an end
+// marker so that files that were not written completely are detected.
+//
+// Unlike WriteMatchesAndGeometry, which serializes all matches at once, the
+// writer and reader only hold a single chunk in memory. This makes it possible
+// to export and load the matches of reconstructions whose matches do not fit
+// in memory.
+
+struct ChunkedMatchesWriterOptions {
+  // The maximum number of priors or matches in each chunk. Larger chunks
+  // compress better but use more memory while writing and reading.
+  int num_records_per_chunk = 256;
+
+  // If true, the chunks are compressed with zstd at the given level. This
+  // requires Theia to be built with WITH_ZSTD and is ignored with a warning
+  // otherwise. Chunks that do not become smaller are stored uncompressed.
+  bool compress = false;
+  int compression_level = 3;
+};
+
+// Writes the priors and matches to a file incrementally, e.g.:
+//
+//   ChunkedMatchesWriter writer;
+//   CHECK(writer.Open(filepath));
+//   for (const ImagePairMatch& match : ...) {
+//     CHECK(writer.AddImagePairMatch(match));
+//   }
+//   CHECK(writer.Close());
+//
+// Priors and matches may be added in any order, but files whose priors are
+// added before the matches can be loaded by ReconstructionBuilder. A file that
+// is not closed is reported as truncated by ReadChunkedMatches.
+class ChunkedMatchesWriter {
+ public:
+  explicit ChunkedMatchesWriter(const ChunkedMatchesWriterOptions& options =
+                                    ChunkedMatchesWriterOptions());
+  ~ChunkedMatchesWriter();
+
+  // Creates the file and writes its header. Returns false if the file could
+  // not be created.
+  bool Open(const std::string& output_file);
+
+  // Adds a record to the current chunk, which is written to the file once it
+  // is full. Returns false if a chunk could not be written.
+  bool AddCameraIntrinsicsPrior(const std::string& image_name,
+                                const CameraIntrinsicsPrior& prior);
+  bool AddImagePairMatch(const ImagePairMatch& match);
+
+  // Writes the remaining records and the end marker and closes the file.
+  // Returns false if the file could not be written.
+  bool Close();
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(ChunkedMatchesWriter);
+
+  // Writes the buffered records as a chunk and clears them.
+  bool WriteChunk();
+
+  ChunkedMatchesWriterOptions options_;
+  std::ofstream writer_;
+  std::vector<std::pair<std::string, CameraIntrinsicsPrior>> priors_;
+  std::vector<ImagePairMatch> matches_;
+};
+
+// Writes the camera intrinsics priors and then the matches of the database.
+// The matches are streamed from the database with ForEachImagePairMatch.
+// Returns false if the file could not be written.
+bool WriteChunkedMatchesFromDatabase(
+    FeaturesAndMatchesDatabase* features_and_matches_database,
+    const std::string& output_file,
+    const ChunkedMatchesWriterOptions& options =
+        ChunkedMatchesWriterOptions());
+
+// Called for each prior and match of the file, in the order in which they were
+// written. Returning false stops the reading.
+typedef std::function<bool(const std::string& image_name,
+                           const CameraIntrinsicsPrior& prior)>
+    ChunkedPriorCallback;
+typedef std::function<bool(const ImagePairMatch& match)> ChunkedMatchCallback;
+
+// Reads the file one chunk at a time and calls the callbacks with its records.
+// Returns false if the file could not be read, is not a valid chunked matches
+// file, or is truncated. The records of the chunks before an invalid chunk
+// have already been passed to the callbacks in that case.
+bool ReadChunkedMatches(
+    const std::string& input_file,
+    const ChunkedPriorCallback& prior_callback,
+    const ChunkedMatchCallback& match_callback);
+
+}  // namespace theia
+
+#endif  // THEIA_IO_CHUNKED_MATCHES_FILE_H_
@@ -0,0 +1,260 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+
+#include <fstream>  // NOLINT
+#include <iterator>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "theia/io/chunked_matches_file.h"
+#include "theia/matching/image_pair_match.h"
+#include "theia/matching/in_memory_features_and_matches_database.h"
+#include "theia/sfm/camera_intrinsics_prior.h"
+#include "theia/util/stringprintf.h"
+
+namespace theia {
+
+namespace {
+
+static const int kNumImages = 7;
+
+std::string TestFilepath(const std::string& filename) {
+  return testing::internal::TempDir() + "/" + filename;
+}
+
+CameraIntrinsicsPrior MakePrior(const int image_index) {
+  CameraIntrinsicsPrior prior;
+  prior.image_width = 1000 + image_index;
+  prior.image_height = 800;
+  prior.focal_length.is_set = true;
+  prior.focal_length.value[0] = 500.0 + image_index;
+  return prior;
+}
+
+ImagePairMatch MakeMatch(const int image_index1, const int image_index2) {
+  ImagePairMatch match;
+  match.image1 = StringPrintf("%d.jpg", image_index1);
+  match.image2 = StringPrintf("%d.jpg", image_index2);
+  match.twoview_info.focal_length_1 = 500.0 + image_index1;
+  match.twoview_info.num_verified_matches = image_index1 + image_index2;
+  for (int i = 0; i < image_index1 + image_index2; i++) {
+    match.correspondences.emplace_back(Feature(i, image_index1),
+                                       Feature(i, image_index2));
+  }
+  return match;
+}
+
+// The priors of all images followed by the matches of all image pairs.
+void GetPriorsAndMatches(
+    std::vector<std::pair<std::string, CameraIntrinsicsPrior>>* priors,
+    std::vector<ImagePairMatch>* matches) {
+  for (int i = 0; i < kNumImages; i++) {
+    priors->emplace_back(StringPrintf("%d.jpg", i), MakePrior(i));
+    for (int j = i + 1; j < kNumImages; j++) {
+      matches->emplace_back(MakeMatch(i, j));
+    }
+  }
+}
+
+bool ReadPriorsAndMatches(
+    const std::string& filepath,
+    std::vector<std::pair<std::string, CameraIntrinsicsPrior>>* priors,
+    std::vector<ImagePairMatch>* matches) {
+  return ReadChunkedMatches(
+      filepath,
+      [&](const std::string& image_name, const CameraIntrinsicsPrior& prior) {
+        priors->emplace_back(image_name, prior);
+        return true;
+      },
+      [&](const ImagePairMatch& match) {
+        matches->emplace_back(match);
+        return true;
+      });
+}
+
+void ExpectEqualMatches(const ImagePairMatch& expected,
+                        const ImagePairMatch& actual) {
+  EXPECT_EQ(expected.image1, actual.image1);
+  EXPECT_EQ(expected.image2, actual.image2);
+  EXPECT_EQ(expected.twoview_info.focal_length_1,
+            actual.twoview_info.focal_length_1);
+  EXPECT_EQ(expected.twoview_info.num_verified_matches,
+            actual.twoview_info.num_verified_matches);
+  EXPECT_TRUE(expected.correspondences == actual.correspondences);
+}
+
+void WriteAndReadPriorsAndMatches(const ChunkedMatchesWriterOptions& options) {
+  std::vector<std::pair<std::string, CameraIntrinsicsPrior>> priors;
+  std::vector<ImagePairMatch> matches;
+  GetPriorsAndMatches(&priors, &matches);
+
+  const std::string filepath = TestFilepath("chunked_matches");
+  ChunkedMatchesWriter writer(options);
+  ASSERT_TRUE(writer.Open(filepath));
+  for (const auto& prior : priors) {
+    ASSERT_TRUE(writer.AddCameraIntrinsicsPrior(prior.first, prior.second));
+  }
+  for (const ImagePairMatch& match : matches) {
+    ASSERT_TRUE(writer.AddImagePairMatch(match));
+  }
+  ASSERT_TRUE(writer.Close());
+
+  std::vector<std::pair<std::string, CameraIntrinsicsPrior>> read_priors;
+  std::vector<ImagePairMatch> read_matches;
+  ASSERT_TRUE(ReadPriorsAndMatches(filepath, &read_priors, &read_matches));
+  ASSERT_EQ(read_priors.size(), priors.size());
+  for (int i = 0; i < priors.size(); i++) {
+    EXPECT_EQ(read_priors[i].first, priors[i].first);
+    EXPECT_EQ(read_priors[i].second.image_width, priors[i].second.image_width);
+    EXPECT_EQ(read_priors[i].second.focal_length.value[0],
+              priors[i].second.focal_length.value[0]);
+  }
+  ASSERT_EQ(read_matches.size(), matches.size());
+  for (int i = 0; i < matches.size(); i++) {
+    ExpectEqualMatches(matches[i], read_matches[i]);
+  }
+}
+
+}  // namespace
+
+TEST(ChunkedMatchesFile, WriteAndRead) {
+  ChunkedMatchesWriterOptions options;
+  options.num_records_per_chunk = 4;
+  WriteAndReadPriorsAndMatches(options);
+}
+
+TEST(ChunkedMatchesFile, WriteAndReadCompressed) {
+  // Without zstd the file is written uncompressed.
+  ChunkedMatchesWriterOptions options;
+  options.num_records_per_chunk = 4;
+  options.compress = true;
+  WriteAndReadPriorsAndMatches(options);
+}
+
+TEST(ChunkedMatchesFile, WriteFromDatabase) {
+  std::vector<std::pair<std::string, CameraIntrinsicsPrior>> priors;
+  std::vector<ImagePairMatch> matches;
+  GetPriorsAndMatches(&priors, &matches);
+
+  InMemoryFeaturesAndMatchesDatabase database;
+  for (const auto& prior : priors) {
+    database.PutCameraIntrinsicsPrior(prior.first, prior.second);
+  }
+  for (const ImagePairMatch& match : matches) {
+    database.PutImagePairMatch(match.image1, match.image2, match);
+  }
+
+  const std::string filepath = TestFilepath("chunked_matches_from_database");
+  ChunkedMatchesWriterOptions options;
+  options.num_records_per_chunk = 5;
+  ASSERT_TRUE(WriteChunkedMatchesFromDatabase(&database, filepath, options));
+
+  std::vector<std::pair<std::string, CameraIntrinsicsPrior>> read_priors;
+  std::vector<ImagePairMatch> read_matches;
+  ASSERT_TRUE(ReadPriorsAndMatches(filepath, &read_priors, &read_matches));
+  EXPECT_EQ(read_priors.size(), priors.size());
+  ASSERT_EQ(read_matches.size(), matches.size());
+  for (const ImagePairMatch& read_match : read_matches) {
+    ExpectEqualMatches(
+        database.GetImagePairMatch(read_match.image1, read_match.image2),
+        read_match);
+  }
+}
+
+TEST(ChunkedMatchesFile, StopReading) {
+  const std::string filepath = TestFilepath("chunked_matches_stop");
+  ChunkedMatchesWriterOptions options;
+  options.num_records_per_chunk = 2;
+  ChunkedMatchesWriter writer(options);
+  ASSERT_TRUE(writer.Open(filepath));
+  for (int i = 1; i < kNumImages; i++) {
+    ASSERT_TRUE(writer.AddImagePairMatch(MakeMatch(0, i)));
+  }
+  ASSERT_TRUE(writer.Close());
+
+  int num_matches = 0;
+  EXPECT_TRUE(ReadChunkedMatches(
+      filepath,
+      [](const std::string& image_name, const CameraIntrinsicsPrior& prior) {
+        return true;
+      },
+      [&](const ImagePairMatch& match) {
+        ++num_matches;
+        return num_matches < 3;
+      }));
+  EXPECT_EQ(num_matches, 3);
+}
+
+TEST(ChunkedMatchesFile, TruncatedFileIsInvalid) {
+  const std::string filepath = TestFilepath("chunked_matches_truncated");
+  ChunkedMatchesWriterOptions options;
+  options.num_records_per_chunk = 2;
+  ChunkedMatchesWriter writer(options);
+  ASSERT_TRUE(writer.Open(filepath));
+  for (int i = 1; i < kNumImages; i++) {
+    ASSERT_TRUE(writer.AddImagePairMatch(MakeMatch(0, i)));
+  }
+  ASSERT_TRUE(writer.Close());
+
+  std::string contents;
+  {
+    std::ifstream reader(filepath, std::ios::in | std::ios::binary);
+    contents.assign(std::istreambuf_iterator<char>(reader),
+                    std::istreambuf_iterator<char>());
+  }
+
+  // Remove the end marker, and then a part of the last chunk.
+  for (const int num_removed_bytes : {32, 40}) {
+    {
+      std::ofstream truncated_file(filepath,
+                                   std::ios::out | std::ios::binary |
+                                       std::ios::trunc);
+      truncated_file.write(contents.data(),
+                           contents.size() - num_removed_bytes);
+    }
+    std::vector<std::pair<std::string, CameraIntrinsicsPrior>> priors;
+    std::vector<ImagePairMatch> matches;
+    EXPECT_FALSE(ReadPriorsAndMatches(filepath, &priors, &matches));
+  }
+
+  EXPECT_FALSE(ReadChunkedMatches(TestFilepath("missing_chunked_matches"),
+                                  nullptr,
+                                  nullptr));
+}
+
+}  // namespace theia
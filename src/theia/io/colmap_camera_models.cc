@@ -0,0 +1,270 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#include "theia/io/colmap_camera_models.h"
+
+#include <glog/logging.h>
+#include <string>
+#include <vector>
+
+#include "theia/sfm/camera/camera.h"
+#include "theia/sfm/camera/camera_intrinsics_model.h"
+#include "theia/sfm/camera/fisheye_camera_model.h"
+#include "theia/sfm/camera/pinhole_camera_model.h"
+#include "theia/sfm/camera/pinhole_radial_tangential_camera_model.h"
+
+namespace theia {
+
+namespace {
+
+static const int kNumColmapCameraModels = 11;
+static const int kNumColmapCameraParameters[kNumColmapCameraModels] = {
+    3, 4, 4, 5, 8, 8, 12, 5, 4, 5, 12};
+static const char* kColmapCameraModelNames[kNumColmapCameraModels] = {
+    "SIMPLE_PINHOLE",
+    "PINHOLE",
+    "SIMPLE_RADIAL",
+    "RADIAL",
+    "OPENCV",
+    "OPENCV_FISHEYE",
+    "FULL_OPENCV",
+    "FOV",
+    "SIMPLE_RADIAL_FISHEYE",
+    "RADIAL_FISHEYE",
+    "THIN_PRISM_FISHEYE"};
+
+void SetPinholeCamera(const double focal_length_x,
+                      const double focal_length_y,
+                      const double principal_point_x,
+                      const double principal_point_y,
+                      const double radial_distortion_1,
+                      const double radial_distortion_2,
+                      Camera* camera) {
+  camera->SetCameraIntrinsicsModelType(CameraIntrinsicsModelType::PINHOLE);
+  double* intrinsics = camera->mutable_intrinsics();
+  intrinsics[PinholeCameraModel::FOCAL_LENGTH] = focal_length_x;
+  intrinsics[PinholeCameraModel::ASPECT_RATIO] =
+      focal_length_y / focal_length_x;
+  intrinsics[PinholeCameraModel::SKEW] = 0.0;
+  intrinsics[PinholeCameraModel::PRINCIPAL_POINT_X] = principal_point_x;
+  intrinsics[PinholeCameraModel::PRINCIPAL_POINT_Y] = principal_point_y;
+  intrinsics[PinholeCameraModel::RADIAL_DISTORTION_1] = radial_distortion_1;
+  intrinsics[PinholeCameraModel::RADIAL_DISTORTION_2] = radial_distortion_2;
+}
+
+// The parameters are fx, fy, cx, cy, k1, k2, p1, p2 and k3.
+void SetPinholeRadialTangentialCamera(const double* parameters,
+                                      Camera* camera) {
+  typedef PinholeRadialTangentialCameraModel Model;
+  camera->SetCameraIntrinsicsModelType(
+      CameraIntrinsicsModelType::PINHOLE_RADIAL_TANGENTIAL);
+  double* intrinsics = camera->mutable_intrinsics();
+  intrinsics[Model::FOCAL_LENGTH] = parameters[0];
+  intrinsics[Model::ASPECT_RATIO] = parameters[1] / parameters[0];
+  intrinsics[Model::SKEW] = 0.0;
+  intrinsics[Model::PRINCIPAL_POINT_X] = parameters[2];
+  intrinsics[Model::PRINCIPAL_POINT_Y] = parameters[3];
+  intrinsics[Model::RADIAL_DISTORTION_1] = parameters[4];
+  intrinsics[Model::RADIAL_DISTORTION_2] = parameters[5];
+  intrinsics[Model::TANGENTIAL_DISTORTION_1] = parameters[6];
+  intrinsics[Model::TANGENTIAL_DISTORTION_2] = parameters[7];
+  intrinsics[Model::RADIAL_DISTORTION_3] = parameters[8];
+}
+
+}  // namespace
+
+int NumColmapCameraParameters(const int model_id) {
+  if (model_id < 0 || model_id >= kNumColmapCameraModels) {
+    return -1;
+  }
+  return kNumColmapCameraParameters[model_id];
+}
+
+std::string ColmapCameraModelName(const ColmapCameraModel model) {
+  return kColmapCameraModelNames[static_cast<int>(model)];
+}
+
+bool ColmapCameraFromCamera(const Camera& camera,
+                            ColmapCameraModel* model,
+                            std::vector<double>* parameters) {
+  const CameraIntrinsicsModelType type = camera.GetCameraIntrinsicsModelType();
+  if (type != CameraIntrinsicsModelType::PINHOLE &&
+      type != CameraIntrinsicsModelType::PINHOLE_RADIAL_TANGENTIAL &&
+      type != CameraIntrinsicsModelType::FISHEYE) {
+    return false;
+  }
+
+  const CameraIntrinsicsModel& intrinsics = *camera.CameraIntrinsics();
+  const double focal_length_x = camera.FocalLength();
+  // The models that are converted share the leading parameters.
+  const double aspect_ratio =
+      intrinsics.GetParameter(PinholeCameraModel::ASPECT_RATIO);
+  const double focal_length_y = focal_length_x * aspect_ratio;
+  const double skew = intrinsics.GetParameter(PinholeCameraModel::SKEW);
+  const double principal_point_x = camera.PrincipalPointX();
+  const double principal_point_y = camera.PrincipalPointY();
+
+  switch (type) {
+    case CameraIntrinsicsModelType::PINHOLE: {
+      const double radial_distortion_1 =
+          intrinsics.GetParameter(PinholeCameraModel::RADIAL_DISTORTION_1);
+      const double radial_distortion_2 =
+          intrinsics.GetParameter(PinholeCameraModel::RADIAL_DISTORTION_2);
+      if (aspect_ratio == 1.0) {
+        *model = ColmapCameraModel::RADIAL;
+        *parameters = {focal_length_x,
+                       principal_point_x,
+                       principal_point_y,
+                       radial_distortion_1,
+                       radial_distortion_2};
+      } else {
+        *model = ColmapCameraModel::OPENCV;
+        *parameters = {focal_length_x,
+                       focal_length_y,
+                       principal_point_x,
+                       principal_point_y,
+                       radial_distortion_1,
+                       radial_distortion_2,
+                       0.0,
+                       0.0};
+      }
+      break;
+    }
+    case CameraIntrinsicsModelType::PINHOLE_RADIAL_TANGENTIAL: {
+      typedef PinholeRadialTangentialCameraModel Model;
+      *model = ColmapCameraModel::FULL_OPENCV;
+      *parameters = {focal_length_x,
+                     focal_length_y,
+                     principal_point_x,
+                     principal_point_y,
+                     intrinsics.GetParameter(Model::RADIAL_DISTORTION_1),
+                     intrinsics.GetParameter(Model::RADIAL_DISTORTION_2),
+                     intrinsics.GetParameter(Model::TANGENTIAL_DISTORTION_1),
+                     intrinsics.GetParameter(Model::TANGENTIAL_DISTORTION_2),
+                     intrinsics.GetParameter(Model::RADIAL_DISTORTION_3),
+                     0.0,
+                     0.0,
+                     0.0};
+      break;
+    }
+    case CameraIntrinsicsModelType::FISHEYE: {
+      *model = ColmapCameraModel::OPENCV_FISHEYE;
+      *parameters = {
+          focal_length_x,
+          focal_length_y,
+          principal_point_x,
+          principal_point_y,
+          intrinsics.GetParameter(FisheyeCameraModel::RADIAL_DISTORTION_1),
+          intrinsics.GetParameter(FisheyeCameraModel::RADIAL_DISTORTION_2),
+          intrinsics.GetParameter(FisheyeCameraModel::RADIAL_DISTORTION_3),
+          intrinsics.GetParameter(FisheyeCameraModel::RADIAL_DISTORTION_4)};
+      break;
+    }
+    default:
+      break;
+  }
+
+  if (skew != 0.0) {
+    LOG(WARNING) << "COLMAP cameras do not have a skew. The skew of " << skew
+                 << " is dropped.";
+  }
+  return true;
+}
+
+bool CameraFromColmapCamera(const int model_id,
+                            const std::vector<double>& parameters,
+                            Camera* camera) {
+  CHECK_NOTNULL(camera);
+  if (NumColmapCameraParameters(model_id) != parameters.size()) {
+    LOG(ERROR) << "Invalid COLMAP camera model " << model_id << " with "
+               << parameters.size() << " parameters.";
+    return false;
+  }
+
+  const double* p = parameters.data();
+  switch (static_cast<ColmapCameraModel>(model_id)) {
+    case ColmapCameraModel::SIMPLE_PINHOLE:
+      SetPinholeCamera(p[0], p[0], p[1], p[2], 0.0, 0.0, camera);
+      return true;
+    case ColmapCameraModel::PINHOLE:
+      SetPinholeCamera(p[0], p[1], p[2], p[3], 0.0, 0.0, camera);
+      return true;
+    case ColmapCameraModel::SIMPLE_RADIAL:
+      SetPinholeCamera(p[0], p[0], p[1], p[2], p[3], 0.0, camera);
+      return true;
+    case ColmapCameraModel::RADIAL:
+      SetPinholeCamera(p[0], p[0], p[1], p[2], p[3], p[4], camera);
+      return true;
+    case ColmapCameraModel::OPENCV: {
+      if (p[6] == 0.0 && p[7] == 0.0) {
+        SetPinholeCamera(p[0], p[1], p[2], p[3], p[4], p[5], camera);
+        return true;
+      }
+      const double opencv_parameters[9] = {
+          p[0], p[1], p[2], p[3], p[4], p[5], p[6], p[7], 0.0};
+      SetPinholeRadialTangentialCamera(opencv_parameters, camera);
+      return true;
+    }
+    case ColmapCameraModel::FULL_OPENCV:
+      // The rational distortion terms k4, k5 and k6 have no counterpart.
+      if (p[9] != 0.0 || p[10] != 0.0 || p[11] != 0.0) {
+        break;
+      }
+      SetPinholeRadialTangentialCamera(p, camera);
+      return true;
+    case ColmapCameraModel::OPENCV_FISHEYE: {
+      camera->SetCameraIntrinsicsModelType(CameraIntrinsicsModelType::FISHEYE);
+      double* intrinsics = camera->mutable_intrinsics();
+      intrinsics[FisheyeCameraModel::FOCAL_LENGTH] = p[0];
+      intrinsics[FisheyeCameraModel::ASPECT_RATIO] = p[1] / p[0];
+      intrinsics[FisheyeCameraModel::SKEW] = 0.0;
+      intrinsics[FisheyeCameraModel::PRINCIPAL_POINT_X] = p[2];
+      intrinsics[FisheyeCameraModel::PRINCIPAL_POINT_Y] = p[3];
+      intrinsics[FisheyeCameraModel::RADIAL_DISTORTION_1] = p[4];
+      intrinsics[FisheyeCameraModel::RADIAL_DISTORTION_2] = p[5];
+      intrinsics[FisheyeCameraModel::RADIAL_DISTORTION_3] = p[6];
+      intrinsics[FisheyeCameraModel::RADIAL_DISTORTION_4] = p[7];
+      return true;
+    }
+    default:
+      break;
+  }
+
+  LOG(ERROR) << "The COLMAP camera model "
+             << kColmapCameraModelNames[model_id]
+             << " cannot be represented by a Theia camera model.";
+  return false;
+}
+
+}  // namespace theia
@@ -0,0 +1,89 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#ifndef THEIA_IO_COLMAP_CAMERA_MODELS_H_
+#define THEIA_IO_COLMAP_CAMERA_MODELS_H_
+
+#include <string>
+#include <vector>
+
+namespace theia {
+
+class Camera;
+
+// The camera models of COLMAP. The values are the model ids that COLMAP uses in
+// its binary files.
+enum class ColmapCameraModel {
+  SIMPLE_PINHOLE = 0,
+  PINHOLE = 1,
+  SIMPLE_RADIAL = 2,
+  RADIAL = 3,
+  OPENCV = 4,
+  OPENCV_FISHEYE = 5,
+  FULL_OPENCV = 6,
+  FOV = 7,
+  SIMPLE_RADIAL_FISHEYE = 8,
+  RADIAL_FISHEYE = 9,
+  THIN_PRISM_FISHEYE = 10,
+};
+
+// Returns the number of parameters of the COLMAP camera model with the given
+// id, or -1 if the id is not a COLMAP camera model.
+int NumColmapCameraParameters(const int model_id);
+
+// Returns the name of the camera model as it appears in COLMAP text files.
+std::string ColmapCameraModelName(const ColmapCameraModel model);
+
+// Converts the intrinsics of the camera to the COLMAP camera model with the
+// same projection. Pinhole cameras become RADIAL cameras (or OPENCV cameras if
+// their aspect ratio is not 1), pinhole radial tangential cameras become
+// FULL_OPENCV cameras and fisheye cameras become OPENCV_FISHEYE cameras. The
+// skew is dropped since COLMAP does not model it. Returns false for the other
+// camera models.
+bool ColmapCameraFromCamera(const Camera& camera,
+                            ColmapCameraModel* model,
+                            std::vector<double>* parameters);
+
+// Sets the intrinsics of the camera from a COLMAP camera model. The pinhole,
+// radial and OpenCV models of COLMAP are supported as long as they are
+// representable by a Theia camera model. OpenCV cameras without tangential
+// distortion become pinhole cameras, so converting a camera to COLMAP and back
+// keeps its model. Returns false for the other models.
+bool CameraFromColmapCamera(const int model_id,
+                            const std::vector<double>& parameters,
+                            Camera* camera);
+
+}  // namespace theia
+
+#endif  // THEIA_IO_COLMAP_CAMERA_MODELS_H_
@@ -0,0 +1,859 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#include "theia/io/columnar_reconstruction.h"
+
+#include <Eigen/Core>
+#include <Eigen/Geometry>
+#include <cereal/archives/portable_binary.hpp>
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>  // NOLINT
+#include <limits>
+#include <memory>
+#include <sstream>  // NOLINT
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#ifdef WITH_ZSTD
+#include <zstd.h>
+#endif
+
+#include "theia/io/eigen_serializable.h"
+#include "theia/sfm/camera/camera.h"
+#include "theia/sfm/camera_intrinsics_prior.h"
+#include "theia/sfm/feature.h"
+#include "theia/sfm/reconstruction.h"
+#include "theia/sfm/sort_tracks_spatially.h"
+#include "theia/sfm/track.h"
+#include "theia/sfm/types.h"
+#include "theia/sfm/view.h"
+#include "theia/util/executor.h"
+#include "theia/util/filesystem.h"
+#include "theia/util/mapped_file.h"
+
+namespace theia {
+
+namespace {
+
+static const uint32_t kFileMagic = 0x46524354;  // "TCRF"
+static const uint32_t kFileVersion = 1;
+
+// Chunks and the columns within a chunk start at multiples of these many bytes
+// so that the columns of uncompressed chunks can be read in place.
+static const uint64_t kChunkAlignment = 64;
+static const uint64_t kColumnAlignment = sizeof(double);
+
+// The number of values stored for each observation: the feature position, its
+// covariance in column-major order, the depth prior and its variance.
+static const int kFeatureSize = 8;
+
+enum ChunkType : uint32_t { CAMERA_TABLE = 0, TRACKS = 1 };
+enum ChunkCodec : uint32_t { NO_COMPRESSION = 0, ZSTD = 1 };
+
+struct FileHeader {
+  uint32_t magic;
+  uint32_t version;
+  uint64_t num_views;
+  uint64_t num_tracks;
+  uint64_t num_observations;
+  uint64_t index_offset;
+  uint32_t num_chunks;
+  uint32_t reserved[5];
+};
+
+static_assert(sizeof(FileHeader) == 64, "Unexpected file header padding.");
+
+// The entry of a chunk in the index at the end of the file. The bounding box
+// only covers the finite points of a track chunk.
+struct ChunkHeader {
+  uint32_t type;
+  uint32_t codec;
+  uint64_t offset;
+  uint64_t stored_size;
+  uint64_t raw_size;
+  uint32_t num_tracks;
+  uint32_t num_observations;
+  double min_point[3];
+  double max_point[3];
+  uint64_t reserved;
+};
+
+static_assert(sizeof(ChunkHeader) == 96, "Unexpected chunk header padding.");
+
+// The offsets of the columns in a decoded track chunk.
+struct TrackChunkLayout {
+  uint64_t points_offset;
+  uint64_t reference_bearings_offset;
+  uint64_t inverse_depths_offset;
+  uint64_t features_offset;
+  uint64_t observation_offsets_offset;
+  uint64_t observation_views_offset;
+  uint64_t colors_offset;
+  uint64_t is_estimated_offset;
+  uint64_t size;
+};
+
+uint64_t AlignUp(const uint64_t value, const uint64_t alignment) {
+  return (value + alignment - 1) / alignment * alignment;
+}
+
+TrackChunkLayout GetTrackChunkLayout(const uint64_t num_tracks,
+                                     const uint64_t num_observations) {
+  TrackChunkLayout layout;
+  layout.points_offset = 0;
+  layout.reference_bearings_offset =
+      layout.points_offset + 4 * num_tracks * sizeof(double);
+  layout.inverse_depths_offset =
+      layout.reference_bearings_offset + 3 * num_tracks * sizeof(double);
+  layout.features_offset =
+      layout.inverse_depths_offset + num_tracks * sizeof(double);
+  layout.observation_offsets_offset =
+      layout.features_offset +
+      kFeatureSize * num_observations * sizeof(double);
+  layout.observation_views_offset =
+      layout.observation_offsets_offset +
+      AlignUp((num_tracks + 1) * sizeof(uint32_t), kColumnAlignment);
+  layout.colors_offset =
+      layout.observation_views_offset +
+      AlignUp(num_observations * sizeof(uint32_t), kColumnAlignment);
+  layout.is_estimated_offset =
+      layout.colors_offset + AlignUp(3 * num_tracks, kColumnAlignment);
+  layout.size = layout.is_estimated_offset +
+                AlignUp(num_tracks, kColumnAlignment);
+  return layout;
+}
+
+// A row of the camera table. The views are written to a single archive so
+// that cameras sharing their intrinsics still share them after reading.
+struct ViewRecord {
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+  std::string name;
+  CameraIntrinsicsGroupId intrinsics_group_id;
+  double timestamp;
+  bool is_estimated;
+  Camera camera;
+  CameraIntrinsicsPrior camera_intrinsics_prior;
+  bool has_position_prior;
+  Eigen::Vector3d position_prior;
+  Eigen::Matrix3d position_prior_sqrt_information;
+  bool has_gravity_prior;
+  Eigen::Vector3d gravity_prior;
+  Eigen::Matrix3d gravity_prior_sqrt_information;
+
+  template <class Archive>
+  void serialize(Archive& ar) {  // NOLINT
+    ar(name,
+       intrinsics_group_id,
+       timestamp,
+       is_estimated,
+       camera,
+       camera_intrinsics_prior,
+       has_position_prior,
+       position_prior,
+       position_prior_sqrt_information,
+       has_gravity_prior,
+       gravity_prior,
+       gravity_prior_sqrt_information);
+  }
+};
+
+// Calls function(record) for each row of the camera table. Returns false if
+// the camera table is corrupt, in which case the function may have been called
+// for some of the rows.
+template <class Function>
+bool ForEachViewRecord(const char* data,
+                       const uint64_t size,
+                       const Function& function) {
+  std::istringstream stream(std::string(data, size));
+  try {
+    cereal::PortableBinaryInputArchive input_archive(stream);
+    cereal::size_type num_views;
+    input_archive(cereal::make_size_tag(num_views));
+    for (cereal::size_type i = 0; i < num_views; i++) {
+      ViewRecord record;
+      input_archive(record);
+      function(record);
+    }
+  } catch (const cereal::Exception& e) {
+    LOG(ERROR) << "Could not read the camera table of the columnar "
+                  "reconstruction: "
+               << e.what();
+    return false;
+  }
+  return true;
+}
+
+// A chunk that is ready to be written. The contents are either the raw columns
+// or their compressed form.
+struct EncodedChunk {
+  ChunkHeader header;
+  std::vector<double> raw;
+  std::string compressed;
+
+  const char* data() const {
+    return header.codec == NO_COMPRESSION
+               ? reinterpret_cast<const char*>(raw.data())
+               : compressed.data();
+  }
+};
+
+void InitializeChunkHeader(const ChunkType type,
+                           const uint64_t raw_size,
+                           ChunkHeader* header) {
+  memset(header, 0, sizeof(*header));
+  header->type = type;
+  header->codec = NO_COMPRESSION;
+  header->raw_size = raw_size;
+  header->stored_size = raw_size;
+}
+
+// Compresses the chunk if this makes it smaller.
+void CompressChunk(const int compression_level, EncodedChunk* chunk) {
+#ifdef WITH_ZSTD
+  const size_t raw_size = chunk->header.raw_size;
+  chunk->compressed.resize(ZSTD_compressBound(raw_size));
+  const size_t compressed_size = ZSTD_compress(&chunk->compressed[0],
+                                               chunk->compressed.size(),
+                                               chunk->raw.data(),
+                                               raw_size,
+                                               compression_level);
+  if (ZSTD_isError(compressed_size) || compressed_size >= raw_size) {
+    chunk->compressed.clear();
+    return;
+  }
+  chunk->compressed.resize(compressed_size);
+  chunk->compressed.shrink_to_fit();
+  chunk->header.codec = ZSTD;
+  chunk->header.stored_size = compressed_size;
+  std::vector<double>().swap(chunk->raw);
+#endif
+}
+
+void EncodeCameraTable(
+    const Reconstruction& reconstruction,
+    const std::vector<ViewId>& view_ids,
+    EncodedChunk* chunk) {
+  std::ostringstream stream;
+  {
+    cereal::PortableBinaryOutputArchive output_archive(stream);
+    output_archive(cereal::make_size_tag(
+        static_cast<cereal::size_type>(view_ids.size())));
+    for (const ViewId view_id : view_ids) {
+      const View& view = *reconstruction.View(view_id);
+      ViewRecord record;
+      record.name = view.Name();
+      record.intrinsics_group_id =
+          reconstruction.CameraIntrinsicsGroupIdFromViewId(view_id);
+      record.timestamp = view.GetTimestamp();
+      record.is_estimated = view.IsEstimated();
+      record.camera = view.Camera();
+      record.camera_intrinsics_prior = view.CameraIntrinsicsPrior();
+      record.has_position_prior = view.HasPositionPrior();
+      record.position_prior = view.GetPositionPrior();
+      record.position_prior_sqrt_information =
+          view.GetPositionPriorSqrtInformation();
+      record.has_gravity_prior = view.HasGravityPrior();
+      record.gravity_prior = view.GetGravityPrior();
+      record.gravity_prior_sqrt_information =
+          view.GetGravityPriorSqrtInformation();
+      output_archive(record);
+    }
+  }
+
+  const std::string table = stream.str();
+  InitializeChunkHeader(CAMERA_TABLE, table.size(), &chunk->header);
+  chunk->raw.resize(AlignUp(table.size(), sizeof(double)) / sizeof(double));
+  memcpy(chunk->raw.data(), table.data(), table.size());
+}
+
+void EncodeTrackChunk(
+    const Reconstruction& reconstruction,
+    const std::vector<TrackId>& track_ids,
+    const std::unordered_map<ViewId, uint32_t>& view_indices,
+    EncodedChunk* chunk) {
+  uint64_t num_observations = 0;
+  for (const TrackId track_id : track_ids) {
+    num_observations += reconstruction.Track(track_id)->NumViews();
+  }
+  CHECK_LE(num_observations, std::numeric_limits<uint32_t>::max())
+      << "Too many observations in a chunk. Use fewer tracks per chunk.";
+
+  const TrackChunkLayout layout =
+      GetTrackChunkLayout(track_ids.size(), num_observations);
+  InitializeChunkHeader(TRACKS, layout.size, &chunk->header);
+  chunk->header.num_tracks = track_ids.size();
+  chunk->header.num_observations = num_observations;
+  chunk->raw.assign(layout.size / sizeof(double), 0.0);
+
+  char* data = reinterpret_cast<char*>(chunk->raw.data());
+  double* points = reinterpret_cast<double*>(data + layout.points_offset);
+  double* reference_bearings =
+      reinterpret_cast<double*>(data + layout.reference_bearings_offset);
+  double* inverse_depths =
+      reinterpret_cast<double*>(data + layout.inverse_depths_offset);
+  double* features = reinterpret_cast<double*>(data + layout.features_offset);
+  uint32_t* observation_offsets =
+      reinterpret_cast<uint32_t*>(data + layout.observation_offsets_offset);
+  uint32_t* observation_views =
+      reinterpret_cast<uint32_t*>(data + layout.observation_views_offset);
+  uint8_t* colors = reinterpret_cast<uint8_t*>(data + layout.colors_offset);
+  uint8_t* is_estimated =
+      reinterpret_cast<uint8_t*>(data + layout.is_estimated_offset);
+
+  Eigen::AlignedBox3d bounds;
+  uint32_t observation_index = 0;
+  for (int i = 0; i < track_ids.size(); i++) {
+    const Track& track = *reconstruction.Track(track_ids[i]);
+    Eigen::Map<Eigen::Vector4d>(points + 4 * i) = track.Point();
+    Eigen::Map<Eigen::Vector3d>(reference_bearings + 3 * i) =
+        track.ReferenceBearingVector();
+    inverse_depths[i] = track.InverseDepth();
+    Eigen::Map<Eigen::Matrix<uint8_t, 3, 1> >(colors + 3 * i) = track.Color();
+    is_estimated[i] = track.IsEstimated() ? 1 : 0;
+    if (IsFinitePoint(track.Point())) {
+      bounds.extend(track.Point().hnormalized());
+    }
+
+    // The reference view is written first since the first view that is added
+    // to a track becomes its reference view.
+    std::vector<ViewId> view_ids(track.ViewIds().begin(),
+                                 track.ViewIds().end());
+    const auto reference_view = std::find(
+        view_ids.begin(), view_ids.end(), track.ReferenceViewId());
+    if (reference_view != view_ids.end()) {
+      std::rotate(view_ids.begin(), reference_view, reference_view + 1);
+    }
+
+    observation_offsets[i] = observation_index;
+    for (const ViewId view_id : view_ids) {
+      const Feature& feature =
+          *reconstruction.View(view_id)->GetFeature(track_ids[i]);
+      double* values = features + kFeatureSize * observation_index;
+      std::copy(feature.point_.data(), feature.point_.data() + 2, values);
+      std::copy(feature.covariance_.data(),
+                feature.covariance_.data() + 4,
+                values + 2);
+      values[6] = feature.depth_prior_;
+      values[7] = feature.depth_prior_variance_;
+      observation_views[observation_index] = view_indices.at(view_id);
+      ++observation_index;
+    }
+  }
+  observation_offsets[track_ids.size()] = observation_index;
+
+  Eigen::Map<Eigen::Vector3d>(chunk->header.min_point) = bounds.min();
+  Eigen::Map<Eigen::Vector3d>(chunk->header.max_point) = bounds.max();
+}
+
+bool WriteChunk(const EncodedChunk& chunk,
+                std::ofstream* writer,
+                std::vector<ChunkHeader>* index) {
+  static const char kPadding[kChunkAlignment] = {};
+  const uint64_t position = writer->tellp();
+  const uint64_t offset = AlignUp(position, kChunkAlignment);
+  writer->write(kPadding, offset - position);
+  writer->write(chunk.data(), chunk.header.stored_size);
+  index->emplace_back(chunk.header);
+  index->back().offset = offset;
+  return writer->good();
+}
+
+// Returns true if the track chunk lies within the file and its sizes are
+// consistent with its number of tracks and observations.
+bool IsValidChunk(const ChunkHeader& chunk, const uint64_t file_size) {
+  if (chunk.offset % kChunkAlignment != 0 || chunk.offset > file_size ||
+      chunk.stored_size > file_size - chunk.offset) {
+    return false;
+  }
+  if (chunk.codec == NO_COMPRESSION && chunk.stored_size != chunk.raw_size) {
+    return false;
+  }
+  if (chunk.codec != NO_COMPRESSION && chunk.codec != ZSTD) {
+    return false;
+  }
+  if (chunk.type == TRACKS &&
+      chunk.raw_size !=
+          GetTrackChunkLayout(chunk.num_tracks, chunk.num_observations).size) {
+    return false;
+  }
+  return chunk.type == CAMERA_TABLE || chunk.type == TRACKS;
+}
+
+}  // namespace
+
+bool WriteColumnarReconstruction(
+    const Reconstruction& reconstruction,
+    const std::string& output_file,
+    const ColumnarReconstructionWriterOptions& options) {
+  CHECK_GT(options.num_tracks_per_chunk, 0);
+  bool compress = options.compress;
+#ifndef WITH_ZSTD
+  if (compress) {
+    LOG(WARNING) << "Theia was built without zstd. The columnar reconstruction "
+                    "is written uncompressed.";
+    compress = false;
+  }
+#endif
+
+  std::ofstream writer(output_file,
+                       std::ios::out | std::ios::binary | std::ios::trunc);
+  if (!writer.is_open()) {
+    LOG(ERROR) << "Could not open the file: " << output_file
+               << " for writing.";
+    return false;
+  }
+
+  // The header is written again with the location of the index once all
+  // chunks have been written.
+  FileHeader header;
+  memset(&header, 0, sizeof(header));
+  header.magic = kFileMagic;
+  header.version = kFileVersion;
+  writer.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+  std::vector<ViewId> view_ids = reconstruction.ViewIds();
+  std::sort(view_ids.begin(), view_ids.end());
+  std::unordered_map<ViewId, uint32_t> view_indices;
+  for (int i = 0; i < view_ids.size(); i++) {
+    view_indices[view_ids[i]] = i;
+  }
+
+  std::vector<ChunkHeader> index;
+  EncodedChunk camera_table;
+  EncodeCameraTable(reconstruction, view_ids, &camera_table);
+  if (compress) {
+    CompressChunk(options.compression_level, &camera_table);
+  }
+  WriteChunk(camera_table, &writer, &index);
+
+  // The chunks are encoded in parallel in batches and written in order, so
+  // that only a batch of chunks is held in memory at a time.
+  const std::vector<TrackId> track_ids = SortTracksSpatially(reconstruction);
+  const int num_track_chunks =
+      (track_ids.size() + options.num_tracks_per_chunk - 1) /
+      options.num_tracks_per_chunk;
+  const int num_threads = AvailableNumThreads(options.num_threads);
+  const int batch_size = 2 * num_threads;
+  for (int batch_start = 0; batch_start < num_track_chunks;
+       batch_start += batch_size) {
+    const int batch_end = std::min(batch_start + batch_size, num_track_chunks);
+    std::vector<EncodedChunk> chunks(batch_end - batch_start);
+    ParallelFor(num_threads,
+                chunks.size(),
+                [&](const int begin, const int end) {
+                  for (int i = begin; i < end; i++) {
+                    const int first_track =
+                        (batch_start + i) * options.num_tracks_per_chunk;
+                    const int last_track = std::min<int>(
+                        first_track + options.num_tracks_per_chunk,
+                        track_ids.size());
+                    EncodeTrackChunk(
+                        reconstruction,
+                        std::vector<TrackId>(track_ids.begin() + first_track,
+                                             track_ids.begin() + last_track),
+                        view_indices,
+                        &chunks[i]);
+                    if (compress) {
+                      CompressChunk(options.compression_level, &chunks[i]);
+                    }
+                  }
+                });
+
+    for (const EncodedChunk& chunk : chunks) {
+      header.num_observations += chunk.header.num_observations;
+      WriteChunk(chunk, &writer, &index);
+    }
+  }
+
+  header.num_views = view_ids.size();
+  header.num_tracks = track_ids.size();
+  header.num_chunks = index.size();
+  header.index_offset = writer.tellp();
+  writer.write(reinterpret_cast<const char*>(index.data()),
+               index.size() * sizeof(index[0]));
+  writer.seekp(0);
+  writer.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  if (!writer.good()) {
+    LOG(ERROR) << "Could not write the columnar reconstruction to "
+               << output_file;
+    return false;
+  }
+  return true;
+}
+
+ColumnarReconstructionReader::ColumnarReconstructionReader()
+    : num_tracks_(0) {}
+
+ColumnarReconstructionReader::~ColumnarReconstructionReader() {}
+
+bool ColumnarReconstructionReader::Open(const std::string& input_file) {
+  file_.reset();
+  track_chunks_.clear();
+  view_names_.clear();
+  num_tracks_ = 0;
+
+  if (!FileExists(input_file)) {
+    LOG(ERROR) << "Could not open the file: " << input_file << " for reading.";
+    return false;
+  }
+  file_.reset(new MappedFile(input_file));
+
+  FileHeader header;
+  if (file_->size() < sizeof(header)) {
+    LOG(ERROR) << input_file << " is not a columnar reconstruction.";
+    return false;
+  }
+  memcpy(&header, file_->data(), sizeof(header));
+  if (header.magic != kFileMagic) {
+    LOG(ERROR) << input_file << " is not a columnar reconstruction.";
+    return false;
+  }
+  if (header.version != kFileVersion) {
+    LOG(ERROR) << "Unsupported columnar reconstruction version "
+               << header.version << " in " << input_file;
+    return false;
+  }
+  if (header.num_chunks == 0 || header.index_offset > file_->size() ||
+      header.num_chunks > (file_->size() - header.index_offset) /
+                              sizeof(ChunkHeader)) {
+    LOG(ERROR) << "The index of " << input_file << " is corrupt.";
+    return false;
+  }
+
+  std::vector<ChunkHeader> index(header.num_chunks);
+  memcpy(index.data(),
+         file_->data() + header.index_offset,
+         index.size() * sizeof(index[0]));
+  uint64_t num_tracks = 0;
+  for (int i = 0; i < index.size(); i++) {
+    const ChunkHeader& chunk_header = index[i];
+    if (!IsValidChunk(chunk_header, file_->size()) ||
+        (chunk_header.type == CAMERA_TABLE) != (i == 0)) {
+      LOG(ERROR) << "Chunk " << i << " of " << input_file << " is corrupt.";
+      return false;
+    }
+
+    Chunk chunk;
+    chunk.codec = chunk_header.codec;
+    chunk.offset = chunk_header.offset;
+    chunk.stored_size = chunk_header.stored_size;
+    chunk.raw_size = chunk_header.raw_size;
+    chunk.num_tracks = chunk_header.num_tracks;
+    chunk.num_observations = chunk_header.num_observations;
+    chunk.bounds.min() = Eigen::Map<const Eigen::Vector3d>(
+        chunk_header.min_point);
+    chunk.bounds.max() = Eigen::Map<const Eigen::Vector3d>(
+        chunk_header.max_point);
+    if (i == 0) {
+      camera_table_ = chunk;
+    } else {
+      track_chunks_.emplace_back(chunk);
+      num_tracks += chunk.num_tracks;
+    }
+  }
+  if (num_tracks != header.num_tracks) {
+    LOG(ERROR) << "The index of " << input_file << " is corrupt.";
+    return false;
+  }
+  num_tracks_ = num_tracks;
+
+  std::vector<double> buffer;
+  const char* camera_table = DecodeChunk(camera_table_, &buffer);
+  if (camera_table == nullptr) {
+    return false;
+  }
+  if (!ForEachViewRecord(camera_table,
+                         camera_table_.raw_size,
+                         [&](const ViewRecord& record) {
+                           view_names_.emplace_back(record.name);
+                         }) ||
+      view_names_.size() != header.num_views) {
+    LOG(ERROR) << "The camera table of " << input_file << " is corrupt.";
+    return false;
+  }
+  return true;
+}
+
+int ColumnarReconstructionReader::NumViews() const {
+  return view_names_.size();
+}
+
+int ColumnarReconstructionReader::NumTracks() const { return num_tracks_; }
+
+int ColumnarReconstructionReader::NumTrackChunks() const {
+  return track_chunks_.size();
+}
+
+const char* ColumnarReconstructionReader::DecodeChunk(
+    const Chunk& chunk, std::vector<double>* buffer) const {
+  const char* stored_data = file_->data() + chunk.offset;
+  if (chunk.codec == NO_COMPRESSION) {
+    return stored_data;
+  }
+
+#ifdef WITH_ZSTD
+  buffer->resize(AlignUp(chunk.raw_size, sizeof(double)) / sizeof(double));
+  const size_t raw_size = ZSTD_decompress(
+      buffer->data(), chunk.raw_size, stored_data, chunk.stored_size);
+  if (ZSTD_isError(raw_size) || raw_size != chunk.raw_size) {
+    LOG(ERROR) << "Could not decompress a chunk of the columnar "
+                  "reconstruction.";
+    return nullptr;
+  }
+  return reinterpret_cast<const char*>(buffer->data());
+#else
+  LOG(ERROR) << "The columnar reconstruction is compressed with zstd but Theia "
+                "was built without zstd. Please build with WITH_ZSTD.";
+  return nullptr;
+#endif
+}
+
+bool ColumnarReconstructionReader::ReadViews(
+    Reconstruction* reconstruction) const {
+  CHECK_NOTNULL(reconstruction);
+  CHECK(file_ != nullptr) << "The columnar reconstruction is not open.";
+
+  std::vector<double> buffer;
+  const char* camera_table = DecodeChunk(camera_table_, &buffer);
+  if (camera_table == nullptr) {
+    return false;
+  }
+
+  // The intrinsics groups are given new ids since the reconstruction may
+  // already contain groups.
+  std::unordered_map<CameraIntrinsicsGroupId, ViewId> view_in_group;
+  bool success = true;
+  const bool read_camera_table = ForEachViewRecord(
+      camera_table, camera_table_.raw_size, [&](const ViewRecord& record) {
+        if (!success) {
+          return;
+        }
+        const auto group = view_in_group.find(record.intrinsics_group_id);
+        const ViewId view_id =
+            group == view_in_group.end()
+                ? reconstruction->AddView(record.name, record.timestamp)
+                : reconstruction->AddView(
+                      record.name,
+                      reconstruction->CameraIntrinsicsGroupIdFromViewId(
+                          group->second),
+                      record.timestamp);
+        if (view_id == kInvalidViewId) {
+          LOG(ERROR) << "Could not add the view " << record.name
+                     << " to the reconstruction.";
+          success = false;
+          return;
+        }
+        view_in_group.emplace(record.intrinsics_group_id, view_id);
+
+        View* view = reconstruction->MutableView(view_id);
+        *view->MutableCamera() = record.camera;
+        view->SetEstimated(record.is_estimated);
+        view->SetCameraIntrinsicsPrior(record.camera_intrinsics_prior);
+        if (record.has_position_prior) {
+          view->SetPositionPrior(record.position_prior,
+                                 record.position_prior_sqrt_information);
+        }
+        if (record.has_gravity_prior) {
+          view->SetGravityPrior(record.gravity_prior,
+                                record.gravity_prior_sqrt_information);
+        }
+      });
+  return read_camera_table && success;
+}
+
+template <class Selector>
+bool ColumnarReconstructionReader::ReadTrackChunks(
+    const std::vector<int>& chunk_indices,
+    const Selector& is_selected,
+    Reconstruction* reconstruction,
+    const int num_threads) const {
+  CHECK_NOTNULL(reconstruction);
+  CHECK(file_ != nullptr) << "The columnar reconstruction is not open.";
+
+  std::vector<ViewId> view_ids(view_names_.size());
+  for (int i = 0; i < view_names_.size(); i++) {
+    view_ids[i] = reconstruction->ViewIdFromName(view_names_[i]);
+    if (view_ids[i] == kInvalidViewId) {
+      LOG(ERROR) << "The view " << view_names_[i]
+                 << " is not in the reconstruction. The views must be read "
+                    "before the tracks.";
+      return false;
+    }
+  }
+
+  // The chunks are decoded in parallel in batches and their tracks are added
+  // in order, since the reconstruction is not thread-safe.
+  const int num_decoding_threads = AvailableNumThreads(num_threads);
+  const int batch_size = 2 * num_decoding_threads;
+  for (int batch_start = 0; batch_start < chunk_indices.size();
+       batch_start += batch_size) {
+    const int batch_end =
+        std::min<int>(batch_start + batch_size, chunk_indices.size());
+    std::vector<std::vector<double> > buffers(batch_end - batch_start);
+    std::vector<const char*> decoded_chunks(buffers.size());
+    ParallelFor(num_decoding_threads,
+                buffers.size(),
+                [&](const int begin, const int end) {
+                  for (int i = begin; i < end; i++) {
+                    decoded_chunks[i] = DecodeChunk(
+                        track_chunks_[chunk_indices[batch_start + i]],
+                        &buffers[i]);
+                  }
+                });
+
+    for (int i = 0; i < decoded_chunks.size(); i++) {
+      const char* data = decoded_chunks[i];
+      if (data == nullptr) {
+        return false;
+      }
+      const Chunk& chunk = track_chunks_[chunk_indices[batch_start + i]];
+      const TrackChunkLayout layout =
+          GetTrackChunkLayout(chunk.num_tracks, chunk.num_observations);
+      const double* points =
+          reinterpret_cast<const double*>(data + layout.points_offset);
+      const double* reference_bearings = reinterpret_cast<const double*>(
+          data + layout.reference_bearings_offset);
+      const double* inverse_depths =
+          reinterpret_cast<const double*>(data + layout.inverse_depths_offset);
+      const double* features =
+          reinterpret_cast<const double*>(data + layout.features_offset);
+      const uint32_t* observation_offsets = reinterpret_cast<const uint32_t*>(
+          data + layout.observation_offsets_offset);
+      const uint32_t* observation_views = reinterpret_cast<const uint32_t*>(
+          data + layout.observation_views_offset);
+      const uint8_t* colors =
+          reinterpret_cast<const uint8_t*>(data + layout.colors_offset);
+      const uint8_t* is_estimated =
+          reinterpret_cast<const uint8_t*>(data + layout.is_estimated_offset);
+
+      for (int j = 0; j < chunk.num_tracks; j++) {
+        const Eigen::Map<const Eigen::Vector4d> point(points + 4 * j);
+        if (!is_selected(point)) {
+          continue;
+        }
+        if (observation_offsets[j] > observation_offsets[j + 1] ||
+            observation_offsets[j + 1] > chunk.num_observations) {
+          LOG(ERROR) << "A track chunk of the columnar reconstruction is "
+                        "corrupt.";
+          return false;
+        }
+
+        const TrackId track_id = reconstruction->AddTrack();
+        for (uint32_t k = observation_offsets[j];
+             k < observation_offsets[j + 1];
+             k++) {
+          if (observation_views[k] >= view_ids.size()) {
+            LOG(ERROR) << "A track chunk of the columnar reconstruction is "
+                          "corrupt.";
+            return false;
+          }
+          const double* values = features + kFeatureSize * k;
+          const Feature feature(Eigen::Map<const Eigen::Vector2d>(values),
+                                Eigen::Map<const Eigen::Matrix2d>(values + 2),
+                                values[6],
+                                values[7]);
+          reconstruction->AddObservation(
+              view_ids[observation_views[k]], track_id, feature);
+        }
+
+        Track* track = reconstruction->MutableTrack(track_id);
+        track->SetPoint(point);
+        track->SetReferenceBearingVector(
+            Eigen::Map<const Eigen::Vector3d>(reference_bearings + 3 * j));
+        track->SetInverseDepth(inverse_depths[j]);
+        track->SetColor(
+            Eigen::Map<const Eigen::Matrix<uint8_t, 3, 1> >(colors + 3 * j));
+        track->SetEstimated(is_estimated[j] != 0);
+      }
+    }
+  }
+  return true;
+}
+
+bool ColumnarReconstructionReader::ReadTracks(Reconstruction* reconstruction,
+                                              const int num_threads) const {
+  std::vector<int> chunk_indices(track_chunks_.size());
+  for (int i = 0; i < chunk_indices.size(); i++) {
+    chunk_indices[i] = i;
+  }
+  return ReadTrackChunks(
+      chunk_indices,
+      [](const Eigen::Vector4d& point) { return true; },
+      reconstruction,
+      num_threads);
+}
+
+bool ColumnarReconstructionReader::ReadTracksInBox(
+    const Eigen::AlignedBox3d& box,
+    Reconstruction* reconstruction,
+    const int num_threads) const {
+  std::vector<int> chunk_indices;
+  for (int i = 0; i < track_chunks_.size(); i++) {
+    if (track_chunks_[i].bounds.intersects(box)) {
+      chunk_indices.emplace_back(i);
+    }
+  }
+  return ReadTrackChunks(
+      chunk_indices,
+      [&](const Eigen::Vector4d& point) {
+        return IsFinitePoint(point) && box.contains(point.hnormalized());
+      },
+      reconstruction,
+      num_threads);
+}
+
+bool ReadColumnarReconstruction(const std::string& input_file,
+                                Reconstruction* reconstruction,
+                                const int num_threads) {
+  CHECK_NOTNULL(reconstruction);
+  CHECK_EQ(reconstruction->NumViews(), 0) << "You must provide an empty "
+                                             "reconstruction before reading a "
+                                             "reconstruction from disk";
+  CHECK_EQ(reconstruction->NumTracks(), 0) << "You must provide an empty "
+                                              "reconstruction before reading a "
+                                              "reconstruction from disk";
+
+  ColumnarReconstructionReader reader;
+  return reader.Open(input_file) && reader.ReadViews(reconstruction) &&
+         reader.ReadTracks(reconstruction, num_threads);
+}
+
+}  // namespace theia
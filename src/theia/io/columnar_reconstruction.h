@@ -0,0 +1,183 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#ifndef THEIA_IO_COLUMNAR_RECONSTRUCTION_H_
+#define THEIA_IO_COLUMNAR_RECONSTRUCTION_H_
+
+#include <Eigen/Core>
+#include <Eigen/Geometry>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "theia/util/util.h"
+
+namespace theia {
+
+class MappedFile;
+class Reconstruction;
+
+// A versioned binary format for large reconstructions that is fast to write
+// and that can be loaded partially. The file consists of a header, a list of
+// chunks and an index of the chunks at the end of the file:
+//
+//   - The first chunk is the camera table, which holds the name, camera and
+//     priors of every view but none of the observations.
+//   - The tracks follow in chunks of up to num_tracks_per_chunk tracks. Each
+//     chunk stores its tracks column by column: the points, the reference
+//     bearings and inverse depths, the colors, the estimated flags, and the
+//     observation offsets, followed by the view and feature of each
+//     observation.
+//   - The index stores the offset, size and codec of each chunk, and for track
+//     chunks the bounding box of their points.
+//
+// Tracks are sorted along a space-filling curve before they are split into
+// chunks, so each chunk covers a compact region of the scene and a spatial
+// query only decodes the chunks that intersect it. Chunks start at multiples of
+// 64 bytes and store their columns aligned, so uncompressed chunks are read in
+// place from a memory mapping of the file. Chunks may be compressed with zstd
+// when Theia is built with WITH_ZSTD. All values are in native byte order.
+//
+// The ids of the views and tracks are not preserved and the reference
+// descriptors of the tracks are not stored.
+
+struct ColumnarReconstructionWriterOptions {
+  // The number of threads used to encode and compress the chunks.
+  int num_threads = 1;
+
+  // The maximum number of tracks in each chunk. Smaller chunks make spatial
+  // queries more selective while larger chunks compress better.
+  int num_tracks_per_chunk = 65536;
+
+  // If true, the chunks are compressed with zstd at the given level. This
+  // requires Theia to be built with WITH_ZSTD and is ignored with a warning
+  // otherwise. Chunks that do not become smaller are stored uncompressed.
+  bool compress = false;
+  int compression_level = 3;
+};
+
+// Writes the reconstruction in the columnar format. Returns false if the file
+// could not be written.
+bool WriteColumnarReconstruction(
+    const Reconstruction& reconstruction,
+    const std::string& output_file,
+    const ColumnarReconstructionWriterOptions& options =
+        ColumnarReconstructionWriterOptions());
+
+// Reads a reconstruction, or parts of it, from a file in the columnar format.
+// The file is memory mapped, so only the chunks that are read are loaded from
+// disk. For instance, the cameras of a reconstruction are read with:
+//
+//   ColumnarReconstructionReader reader;
+//   CHECK(reader.Open(filepath));
+//   Reconstruction reconstruction;
+//   CHECK(reader.ReadViews(&reconstruction));
+//
+// and the tracks within a region are then added with ReadTracksInBox.
+class ColumnarReconstructionReader {
+ public:
+  ColumnarReconstructionReader();
+  ~ColumnarReconstructionReader();
+
+  // Maps the file and reads its index and the names of the views. Returns
+  // false if the file is not a valid columnar reconstruction.
+  bool Open(const std::string& input_file);
+
+  int NumViews() const;
+  int NumTracks() const;
+  int NumTrackChunks() const;
+
+  // Adds the views of the file to the reconstruction with their cameras,
+  // intrinsics groups and priors. The views do not have any features until
+  // tracks are read.
+  bool ReadViews(Reconstruction* reconstruction) const;
+
+  // Adds all tracks and their observations to the reconstruction. The views of
+  // the file must have been added to the reconstruction with ReadViews. The
+  // chunks are decoded with up to num_threads threads.
+  bool ReadTracks(Reconstruction* reconstruction,
+                  const int num_threads = 1) const;
+
+  // Adds the tracks whose points lie within the box to the reconstruction, as
+  // in ReadTracks. Only the chunks whose bounding box intersects the box are
+  // decoded. Points at infinity are never within the box.
+  bool ReadTracksInBox(const Eigen::AlignedBox3d& box,
+                       Reconstruction* reconstruction,
+                       const int num_threads = 1) const;
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(ColumnarReconstructionReader);
+
+  struct Chunk {
+    uint32_t codec;
+    uint64_t offset;
+    uint64_t stored_size;
+    uint64_t raw_size;
+    uint32_t num_tracks;
+    uint32_t num_observations;
+    Eigen::AlignedBox3d bounds;
+  };
+
+  // Returns a pointer to the decoded contents of the chunk. Compressed chunks
+  // are decompressed into buffer. Returns nullptr if the chunk is corrupt.
+  const char* DecodeChunk(const Chunk& chunk,
+                          std::vector<double>* buffer) const;
+
+  // Decodes the chunks with the given indices and adds the tracks for which
+  // is_selected(point) returns true.
+  template <class Selector>
+  bool ReadTrackChunks(const std::vector<int>& chunk_indices,
+                       const Selector& is_selected,
+                       Reconstruction* reconstruction,
+                       const int num_threads) const;
+
+  std::unique_ptr<MappedFile> file_;
+  uint64_t num_tracks_;
+  Chunk camera_table_;
+  std::vector<Chunk> track_chunks_;
+  std::vector<std::string> view_names_;
+};
+
+// Reads the whole reconstruction from a file in the columnar format into an
+// empty reconstruction. The track chunks are decoded with up to num_threads
+// threads.
+bool ReadColumnarReconstruction(const std::string& input_file,
+                                Reconstruction* reconstruction,
+                                const int num_threads = 1);
+
+}  // namespace theia
+
+#endif  // THEIA_IO_COLUMNAR_RECONSTRUCTION_H_
@@ -0,0 +1,376 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#include <Eigen/Core>
+#include <Eigen/Geometry>
+
+#include <cstring>
+#include <fstream>  // NOLINT
+#include <iterator>
+#include <map>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "theia/io/columnar_reconstruction.h"
+#include "theia/sfm/camera/camera.h"
+#include "theia/sfm/reconstruction.h"
+#include "theia/sfm/track.h"
+#include "theia/sfm/view.h"
+#include "theia/util/random.h"
+#include "theia/util/stringprintf.h"
+
+namespace theia {
+
+namespace {
+
+static const int kNumViews = 12;
+static const int kNumTracks = 500;
+static const int kNumTracksPerChunk = 64;
+
+typedef std::tuple<double, double, double, double> PointKey;
+
+PointKey KeyOfPoint(const Eigen::Vector4d& point) {
+  return PointKey(point[0], point[1], point[2], point[3]);
+}
+
+std::string TestFilepath(const std::string& filename) {
+  return testing::internal::TempDir() + "/" + filename;
+}
+
+// Builds a reconstruction in which pairs of views share their intrinsics and
+// each track is observed by three views.
+void BuildReconstruction(Reconstruction* reconstruction) {
+  RandomNumberGenerator rng(59);
+  ViewId previous_view_id = kInvalidViewId;
+  for (int i = 0; i < kNumViews; i++) {
+    const std::string name = StringPrintf("view_%d.jpg", i);
+    const ViewId view_id =
+        i % 2 == 0 ? reconstruction->AddView(name, i)
+                   : reconstruction->AddView(
+                         name,
+                         reconstruction->CameraIntrinsicsGroupIdFromViewId(
+                             previous_view_id),
+                         i);
+    previous_view_id = view_id;
+    View* view = reconstruction->MutableView(view_id);
+    view->SetEstimated(i != 3);
+    Camera* camera = view->MutableCamera();
+    camera->SetPosition(rng.RandVector3d());
+    camera->SetOrientationFromAngleAxis(0.1 * rng.RandVector3d());
+    camera->SetImageSize(640, 480);
+    if (i % 2 == 0) {
+      camera->SetFocalLength(rng.RandDouble(400.0, 800.0));
+    }
+    if (i % 3 == 0) {
+      view->SetPositionPrior(rng.RandVector3d(),
+                             (i + 1) * Eigen::Matrix3d::Identity());
+    }
+  }
+
+  const std::vector<ViewId> view_ids = reconstruction->ViewIds();
+  for (int i = 0; i < kNumTracks; i++) {
+    const TrackId track_id = reconstruction->AddTrack();
+    for (int j = 0; j < 3; j++) {
+      const Feature feature(rng.RandVector2d(0.0, 480.0),
+                            rng.RandDouble(0.5, 2.0) *
+                                Eigen::Matrix2d::Identity(),
+                            rng.RandDouble(1.0, 2.0),
+                            rng.RandDouble(0.0, 0.1));
+      reconstruction->AddObservation(
+          view_ids[(i + 5 * j) % view_ids.size()], track_id, feature);
+    }
+
+    Track* track = reconstruction->MutableTrack(track_id);
+    track->SetEstimated(i % 7 != 0);
+    // Every 50th track is a point at infinity.
+    Eigen::Vector4d point = (10.0 * rng.RandVector3d()).homogeneous();
+    if (i % 50 == 0) {
+      point[3] = 0.0;
+    }
+    track->SetPoint(point);
+    track->SetColor(Eigen::Matrix<uint8_t, 3, 1>(i % 256, 7, 255 - i % 256));
+    track->SetInverseDepth(rng.RandDouble(0.1, 1.0));
+    track->SetReferenceBearingVector(rng.RandVector3d().normalized());
+  }
+}
+
+void ExpectViewsEqual(const Reconstruction& expected,
+                      const Reconstruction& actual) {
+  ASSERT_EQ(expected.NumViews(), actual.NumViews());
+  for (const ViewId expected_view_id : expected.ViewIds()) {
+    const View* expected_view = expected.View(expected_view_id);
+    const ViewId actual_view_id =
+        actual.ViewIdFromName(expected_view->Name());
+    ASSERT_NE(actual_view_id, kInvalidViewId);
+    const View* actual_view = actual.View(actual_view_id);
+
+    EXPECT_EQ(expected_view->GetTimestamp(), actual_view->GetTimestamp());
+    EXPECT_EQ(expected_view->IsEstimated(), actual_view->IsEstimated());
+    EXPECT_EQ(expected_view->HasPositionPrior(),
+              actual_view->HasPositionPrior());
+    EXPECT_EQ(expected_view->GetPositionPrior(),
+              actual_view->GetPositionPrior());
+    EXPECT_TRUE(expected_view->GetPositionPriorSqrtInformation() ==
+                actual_view->GetPositionPriorSqrtInformation());
+
+    const Camera& expected_camera = expected_view->Camera();
+    const Camera& actual_camera = actual_view->Camera();
+    EXPECT_EQ(expected_camera.GetPosition(), actual_camera.GetPosition());
+    EXPECT_EQ(expected_camera.GetOrientationAsAngleAxis(),
+              actual_camera.GetOrientationAsAngleAxis());
+    EXPECT_EQ(expected_camera.FocalLength(), actual_camera.FocalLength());
+    EXPECT_EQ(expected_camera.ImageWidth(), actual_camera.ImageWidth());
+    EXPECT_EQ(expected_camera.ImageHeight(), actual_camera.ImageHeight());
+
+    // Views in the same intrinsics group share their intrinsics.
+    for (const ViewId expected_group_view_id :
+         expected.GetViewsInCameraIntrinsicGroup(
+             expected.CameraIntrinsicsGroupIdFromViewId(expected_view_id))) {
+      const ViewId actual_group_view_id = actual.ViewIdFromName(
+          expected.View(expected_group_view_id)->Name());
+      EXPECT_EQ(actual.CameraIntrinsicsGroupIdFromViewId(actual_view_id),
+                actual.CameraIntrinsicsGroupIdFromViewId(
+                    actual_group_view_id));
+      EXPECT_EQ(actual_camera.CameraIntrinsics(),
+                actual.View(actual_group_view_id)->Camera().CameraIntrinsics());
+    }
+  }
+}
+
+void ExpectTrackEqual(const Reconstruction& expected,
+                      const TrackId expected_track_id,
+                      const Reconstruction& actual,
+                      const TrackId actual_track_id) {
+  const Track* expected_track = expected.Track(expected_track_id);
+  const Track* actual_track = actual.Track(actual_track_id);
+  EXPECT_EQ(expected_track->Point(), actual_track->Point());
+  EXPECT_EQ(expected_track->Color(), actual_track->Color());
+  EXPECT_EQ(expected_track->IsEstimated(), actual_track->IsEstimated());
+  EXPECT_EQ(expected_track->InverseDepth(), actual_track->InverseDepth());
+  EXPECT_EQ(expected_track->ReferenceBearingVector(),
+            actual_track->ReferenceBearingVector());
+  EXPECT_EQ(expected.View(expected_track->ReferenceViewId())->Name(),
+            actual.View(actual_track->ReferenceViewId())->Name());
+
+  ASSERT_EQ(expected_track->NumViews(), actual_track->NumViews());
+  for (const ViewId expected_view_id : expected_track->ViewIds()) {
+    const ViewId actual_view_id =
+        actual.ViewIdFromName(expected.View(expected_view_id)->Name());
+    const Feature* expected_feature =
+        expected.View(expected_view_id)->GetFeature(expected_track_id);
+    const Feature* actual_feature =
+        actual.View(actual_view_id)->GetFeature(actual_track_id);
+    ASSERT_TRUE(actual_feature != nullptr);
+    EXPECT_EQ(expected_feature->point_, actual_feature->point_);
+    EXPECT_TRUE(expected_feature->covariance_ == actual_feature->covariance_);
+    EXPECT_EQ(expected_feature->depth_prior_, actual_feature->depth_prior_);
+    EXPECT_EQ(expected_feature->depth_prior_variance_,
+              actual_feature->depth_prior_variance_);
+  }
+}
+
+// Checks that actual contains exactly the tracks of expected in
+// expected_track_ids. Tracks are matched by their points, which are unique.
+void ExpectTracksEqual(const Reconstruction& expected,
+                       const std::vector<TrackId>& expected_track_ids,
+                       const Reconstruction& actual) {
+  std::map<PointKey, TrackId> actual_track_ids;
+  for (const TrackId track_id : actual.TrackIds()) {
+    actual_track_ids[KeyOfPoint(actual.Track(track_id)->Point())] = track_id;
+  }
+  ASSERT_EQ(actual_track_ids.size(), expected_track_ids.size());
+
+  for (const TrackId expected_track_id : expected_track_ids) {
+    const auto actual_track_id = actual_track_ids.find(
+        KeyOfPoint(expected.Track(expected_track_id)->Point()));
+    ASSERT_TRUE(actual_track_id != actual_track_ids.end());
+    ExpectTrackEqual(
+        expected, expected_track_id, actual, actual_track_id->second);
+  }
+}
+
+void WriteAndReadReconstruction(
+    const ColumnarReconstructionWriterOptions& options,
+    const std::string& filename) {
+  Reconstruction expected;
+  BuildReconstruction(&expected);
+  const std::string filepath = TestFilepath(filename);
+  EXPECT_TRUE(WriteColumnarReconstruction(expected, filepath, options));
+
+  Reconstruction actual;
+  EXPECT_TRUE(ReadColumnarReconstruction(filepath, &actual, 2));
+  ExpectViewsEqual(expected, actual);
+  ExpectTracksEqual(expected, expected.TrackIds(), actual);
+}
+
+}  // namespace
+
+TEST(ColumnarReconstruction, WriteAndRead) {
+  ColumnarReconstructionWriterOptions options;
+  options.num_tracks_per_chunk = kNumTracksPerChunk;
+  WriteAndReadReconstruction(options, "columnar_reconstruction.bin");
+}
+
+TEST(ColumnarReconstruction, WriteInParallelAndRead) {
+  ColumnarReconstructionWriterOptions options;
+  options.num_threads = 4;
+  options.num_tracks_per_chunk = kNumTracksPerChunk;
+  WriteAndReadReconstruction(options, "columnar_reconstruction_parallel.bin");
+}
+
+// Without zstd the chunks are written uncompressed, so this test passes in
+// both builds.
+TEST(ColumnarReconstruction, WriteCompressedAndRead) {
+  ColumnarReconstructionWriterOptions options;
+  options.num_threads = 2;
+  options.num_tracks_per_chunk = kNumTracksPerChunk;
+  options.compress = true;
+  WriteAndReadReconstruction(options,
+                             "columnar_reconstruction_compressed.bin");
+}
+
+TEST(ColumnarReconstruction, ReadViewsOnly) {
+  Reconstruction expected;
+  BuildReconstruction(&expected);
+  const std::string filepath = TestFilepath("columnar_reconstruction.bin");
+  ColumnarReconstructionWriterOptions options;
+  options.num_tracks_per_chunk = kNumTracksPerChunk;
+  EXPECT_TRUE(WriteColumnarReconstruction(expected, filepath, options));
+
+  ColumnarReconstructionReader reader;
+  ASSERT_TRUE(reader.Open(filepath));
+  EXPECT_EQ(reader.NumViews(), kNumViews);
+  EXPECT_EQ(reader.NumTracks(), kNumTracks);
+  EXPECT_EQ(reader.NumTrackChunks(),
+            (kNumTracks + kNumTracksPerChunk - 1) / kNumTracksPerChunk);
+
+  Reconstruction actual;
+  EXPECT_TRUE(reader.ReadViews(&actual));
+  ExpectViewsEqual(expected, actual);
+  EXPECT_EQ(actual.NumTracks(), 0);
+  for (const ViewId view_id : actual.ViewIds()) {
+    EXPECT_EQ(actual.View(view_id)->NumFeatures(), 0);
+  }
+}
+
+TEST(ColumnarReconstruction, ReadTracksInBox) {
+  Reconstruction expected;
+  BuildReconstruction(&expected);
+  const std::string filepath = TestFilepath("columnar_reconstruction.bin");
+  ColumnarReconstructionWriterOptions options;
+  options.num_tracks_per_chunk = kNumTracksPerChunk;
+  EXPECT_TRUE(WriteColumnarReconstruction(expected, filepath, options));
+
+  const Eigen::AlignedBox3d box(Eigen::Vector3d(-2.0, -10.0, -3.0),
+                                Eigen::Vector3d(6.0, 1.0, 10.0));
+  std::vector<TrackId> expected_track_ids;
+  for (const TrackId track_id : expected.TrackIds()) {
+    const Eigen::Vector4d& point = expected.Track(track_id)->Point();
+    if (point[3] != 0.0 && box.contains(point.hnormalized())) {
+      expected_track_ids.emplace_back(track_id);
+    }
+  }
+  ASSERT_GT(expected_track_ids.size(), 0);
+  ASSERT_LT(expected_track_ids.size(), kNumTracks);
+
+  ColumnarReconstructionReader reader;
+  ASSERT_TRUE(reader.Open(filepath));
+  Reconstruction actual;
+  EXPECT_TRUE(reader.ReadViews(&actual));
+  EXPECT_TRUE(reader.ReadTracksInBox(box, &actual, 2));
+  ExpectTracksEqual(expected, expected_track_ids, actual);
+}
+
+TEST(ColumnarReconstruction, TracksMustBeReadAfterViews) {
+  Reconstruction expected;
+  BuildReconstruction(&expected);
+  const std::string filepath = TestFilepath("columnar_reconstruction.bin");
+  EXPECT_TRUE(WriteColumnarReconstruction(expected, filepath));
+
+  ColumnarReconstructionReader reader;
+  ASSERT_TRUE(reader.Open(filepath));
+  Reconstruction actual;
+  EXPECT_FALSE(reader.ReadTracks(&actual));
+}
+
+TEST(ColumnarReconstruction, RejectsTruncatedFiles) {
+  Reconstruction reconstruction;
+  BuildReconstruction(&reconstruction);
+  const std::string filepath =
+      TestFilepath("columnar_reconstruction_truncated.bin");
+  ColumnarReconstructionWriterOptions options;
+  options.compress = false;
+  EXPECT_TRUE(WriteColumnarReconstruction(reconstruction, filepath, options));
+  std::string contents;
+  {
+    std::ifstream reader(filepath, std::ios::in | std::ios::binary);
+    contents.assign(std::istreambuf_iterator<char>(reader),
+                    std::istreambuf_iterator<char>());
+  }
+
+  // The index at the end of the file is cut off.
+  {
+    std::ofstream writer(filepath, std::ios::out | std::ios::binary);
+    writer.write(contents.data(), contents.size() / 2);
+  }
+  ColumnarReconstructionReader reader;
+  EXPECT_FALSE(reader.Open(filepath));
+
+  // The camera table, which is the first chunk after the 64 byte file header,
+  // claims more views than it holds, so its rows end early. Its view count
+  // follows the endianness flag of the cereal archive.
+  const uint64_t num_views = 1000;
+  memcpy(&contents[65], &num_views, sizeof(num_views));
+  {
+    std::ofstream writer(filepath, std::ios::out | std::ios::binary);
+    writer.write(contents.data(), contents.size());
+  }
+  EXPECT_FALSE(reader.Open(filepath));
+}
+
+TEST(ColumnarReconstruction, RejectsOtherFiles) {
+  const std::string filepath = TestFilepath("not_a_reconstruction.bin");
+  {
+    std::ofstream writer(filepath, std::ios::out | std::ios::binary);
+    writer << std::string(256, 'x');
+  }
+  ColumnarReconstructionReader reader;
+  EXPECT_FALSE(reader.Open(filepath));
+  EXPECT_FALSE(reader.Open(TestFilepath("missing_reconstruction.bin")));
+}
+
+}  // namespace theia
@@ -0,0 +1,377 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#include "theia/io/columnar_view_graph.h"
+
+#include <Eigen/Core>
+#include <glog/logging.h>
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>  // NOLINT
+#include <memory>
+#include <ostream>  // NOLINT
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "theia/sfm/twoview_info.h"
+#include "theia/sfm/types.h"
+#include "theia/sfm/view_graph/compact_view_graph.h"
+#include "theia/sfm/view_graph/view_graph.h"
+#include "theia/util/filesystem.h"
+#include "theia/util/mapped_file.h"
+#include "theia/util/memory_stream_buffer.h"
+
+namespace theia {
+
+namespace {
+
+static const uint32_t kFileMagic = 0x47565443;  // "CTVG"
+static const uint32_t kFileVersion = 1;
+
+// The columns start at multiples of these many bytes so that they can be read
+// in place from the memory mapping.
+static const uint64_t kColumnAlignment = sizeof(double);
+
+struct FileHeader {
+  uint32_t magic;
+  uint32_t version;
+  uint64_t num_views;
+  uint64_t num_edges;
+  uint32_t reserved[10];
+};
+
+static_assert(sizeof(FileHeader) == 64, "Unexpected file header padding.");
+
+// The offsets of the columns in the file.
+struct ColumnLayout {
+  uint64_t view_ids_offset;
+  uint64_t edge_views1_offset;
+  uint64_t edge_views2_offset;
+  uint64_t focal_lengths1_offset;
+  uint64_t focal_lengths2_offset;
+  uint64_t positions_offset;
+  uint64_t rotations_offset;
+  uint64_t num_verified_matches_offset;
+  uint64_t num_homography_inliers_offset;
+  uint64_t visibility_scores_offset;
+  uint64_t size;
+};
+
+uint64_t AlignUp(const uint64_t value, const uint64_t alignment) {
+  return (value + alignment - 1) / alignment * alignment;
+}
+
+ColumnLayout GetColumnLayout(const uint64_t num_views,
+                             const uint64_t num_edges) {
+  const uint64_t int_column_size =
+      AlignUp(num_edges * sizeof(int32_t), kColumnAlignment);
+  ColumnLayout layout;
+  layout.view_ids_offset = sizeof(FileHeader);
+  layout.edge_views1_offset =
+      layout.view_ids_offset +
+      AlignUp(num_views * sizeof(ViewId), kColumnAlignment);
+  layout.edge_views2_offset = layout.edge_views1_offset + int_column_size;
+  layout.focal_lengths1_offset = layout.edge_views2_offset + int_column_size;
+  layout.focal_lengths2_offset =
+      layout.focal_lengths1_offset + num_edges * sizeof(double);
+  layout.positions_offset =
+      layout.focal_lengths2_offset + num_edges * sizeof(double);
+  layout.rotations_offset =
+      layout.positions_offset + 3 * num_edges * sizeof(double);
+  layout.num_verified_matches_offset =
+      layout.rotations_offset + 3 * num_edges * sizeof(double);
+  layout.num_homography_inliers_offset =
+      layout.num_verified_matches_offset + int_column_size;
+  layout.visibility_scores_offset =
+      layout.num_homography_inliers_offset + int_column_size;
+  layout.size = layout.visibility_scores_offset + int_column_size;
+  return layout;
+}
+
+// Writes a column of num_values * Width values, where get_values(i, values)
+// fills the Width values of row i, and pads it to the column alignment.
+template <class T, int Width, class GetValues>
+void WriteColumn(const int num_values,
+                 const GetValues& get_values,
+                 std::ostream* writer) {
+  static const char kPadding[kColumnAlignment] = {};
+  std::vector<T> column(static_cast<size_t>(num_values) * Width);
+  for (int i = 0; i < num_values; i++) {
+    get_values(i, column.data() + static_cast<size_t>(i) * Width);
+  }
+  const uint64_t size = column.size() * sizeof(T);
+  writer->write(reinterpret_cast<const char*>(column.data()), size);
+  writer->write(kPadding, AlignUp(size, kColumnAlignment) - size);
+}
+
+template <class T>
+const T* Column(const char* data, const uint64_t offset) {
+  return reinterpret_cast<const T*>(data + offset);
+}
+
+void WriteColumns(const CompactViewGraph& graph, std::ostream* writer_ptr) {
+  std::ostream& writer = *writer_ptr;
+  FileHeader header;
+  memset(&header, 0, sizeof(header));
+  header.magic = kFileMagic;
+  header.version = kFileVersion;
+  header.num_views = graph.NumViews();
+  header.num_edges = graph.NumEdges();
+  writer.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+  const int num_edges = graph.NumEdges();
+  WriteColumn<ViewId, 1>(
+      graph.NumViews(),
+      [&](const int i, ViewId* view_id) { *view_id = graph.ViewIdForIndex(i); },
+      &writer);
+  WriteColumn<int32_t, 1>(
+      num_edges,
+      [&](const int i, int32_t* view) { *view = graph.EdgeView1(i); },
+      &writer);
+  WriteColumn<int32_t, 1>(
+      num_edges,
+      [&](const int i, int32_t* view) { *view = graph.EdgeView2(i); },
+      &writer);
+  WriteColumn<double, 1>(
+      num_edges,
+      [&](const int i, double* focal_length) {
+        *focal_length = graph.Edge(i).focal_length_1;
+      },
+      &writer);
+  WriteColumn<double, 1>(
+      num_edges,
+      [&](const int i, double* focal_length) {
+        *focal_length = graph.Edge(i).focal_length_2;
+      },
+      &writer);
+  WriteColumn<double, 3>(
+      num_edges,
+      [&](const int i, double* position) {
+        Eigen::Map<Eigen::Vector3d> position_column(position);
+        position_column = graph.Edge(i).position_2;
+      },
+      &writer);
+  WriteColumn<double, 3>(
+      num_edges,
+      [&](const int i, double* rotation) {
+        Eigen::Map<Eigen::Vector3d> rotation_column(rotation);
+        rotation_column = graph.Edge(i).rotation_2;
+      },
+      &writer);
+  WriteColumn<int32_t, 1>(
+      num_edges,
+      [&](const int i, int32_t* value) {
+        *value = graph.Edge(i).num_verified_matches;
+      },
+      &writer);
+  WriteColumn<int32_t, 1>(
+      num_edges,
+      [&](const int i, int32_t* value) {
+        *value = graph.Edge(i).num_homography_inliers;
+      },
+      &writer);
+  WriteColumn<int32_t, 1>(
+      num_edges,
+      [&](const int i, int32_t* value) {
+        *value = graph.Edge(i).visibility_score;
+      },
+      &writer);
+}
+
+// Decodes the columns of a view graph from data. input_file names the source
+// of the data in error messages.
+bool ReadColumns(const char* data,
+                 const uint64_t size,
+                 const std::string& input_file,
+                 std::unique_ptr<CompactViewGraph>* compact_view_graph) {
+  FileHeader header;
+  if (size < sizeof(header)) {
+    LOG(ERROR) << input_file << " is not a columnar view graph.";
+    return false;
+  }
+  memcpy(&header, data, sizeof(header));
+  if (header.magic != kFileMagic) {
+    LOG(ERROR) << input_file << " is not a columnar view graph.";
+    return false;
+  }
+  if (header.version != kFileVersion) {
+    LOG(ERROR) << "Unsupported columnar view graph version " << header.version
+               << " in " << input_file;
+    return false;
+  }
+  // The sizes are bounded by the file size before the layout is computed so
+  // that a corrupt header cannot overflow the offsets.
+  if (header.num_views > size || header.num_edges > size ||
+      GetColumnLayout(header.num_views, header.num_edges).size > size) {
+    LOG(ERROR) << "The columns of " << input_file << " are truncated.";
+    return false;
+  }
+  const ColumnLayout layout =
+      GetColumnLayout(header.num_views, header.num_edges);
+  const int num_views = header.num_views;
+  const int num_edges = header.num_edges;
+
+  const ViewId* view_ids_column = Column<ViewId>(data, layout.view_ids_offset);
+  std::vector<ViewId> view_ids(view_ids_column, view_ids_column + num_views);
+  for (int i = 1; i < num_views; i++) {
+    if (view_ids[i - 1] >= view_ids[i]) {
+      LOG(ERROR) << "The view ids of " << input_file << " are not sorted.";
+      return false;
+    }
+  }
+
+  const int32_t* edge_views1 = Column<int32_t>(data, layout.edge_views1_offset);
+  const int32_t* edge_views2 = Column<int32_t>(data, layout.edge_views2_offset);
+  std::vector<std::pair<int, int> > edge_views(num_edges);
+  for (int i = 0; i < num_edges; i++) {
+    edge_views[i] = std::make_pair(edge_views1[i], edge_views2[i]);
+    if (edge_views[i].first < 0 ||
+        edge_views[i].first >= edge_views[i].second ||
+        edge_views[i].second >= num_views ||
+        (i > 0 && edge_views[i - 1] >= edge_views[i])) {
+      LOG(ERROR) << "Edge " << i << " of " << input_file << " is corrupt.";
+      return false;
+    }
+  }
+
+  const double* focal_lengths1 =
+      Column<double>(data, layout.focal_lengths1_offset);
+  const double* focal_lengths2 =
+      Column<double>(data, layout.focal_lengths2_offset);
+  const double* positions = Column<double>(data, layout.positions_offset);
+  const double* rotations = Column<double>(data, layout.rotations_offset);
+  const int32_t* num_verified_matches =
+      Column<int32_t>(data, layout.num_verified_matches_offset);
+  const int32_t* num_homography_inliers =
+      Column<int32_t>(data, layout.num_homography_inliers_offset);
+  const int32_t* visibility_scores =
+      Column<int32_t>(data, layout.visibility_scores_offset);
+  std::vector<TwoViewInfo> edges(num_edges);
+  for (int i = 0; i < num_edges; i++) {
+    TwoViewInfo& edge = edges[i];
+    edge.focal_length_1 = focal_lengths1[i];
+    edge.focal_length_2 = focal_lengths2[i];
+    edge.position_2 = Eigen::Map<const Eigen::Vector3d>(positions + 3 * i);
+    edge.rotation_2 = Eigen::Map<const Eigen::Vector3d>(rotations + 3 * i);
+    edge.num_verified_matches = num_verified_matches[i];
+    edge.num_homography_inliers = num_homography_inliers[i];
+    edge.visibility_score = visibility_scores[i];
+  }
+
+  compact_view_graph->reset(new CompactViewGraph(
+      std::move(view_ids), std::move(edge_views), std::move(edges)));
+  return true;
+}
+
+}  // namespace
+
+bool WriteColumnarViewGraph(const ViewGraph& view_graph,
+                            const std::string& output_file) {
+  return WriteColumnarViewGraph(CompactViewGraph(view_graph), output_file);
+}
+
+bool WriteColumnarViewGraph(const CompactViewGraph& graph,
+                            const std::string& output_file) {
+  std::ofstream writer(output_file,
+                       std::ios::out | std::ios::binary | std::ios::trunc);
+  if (!writer.is_open()) {
+    LOG(ERROR) << "Could not open the file: " << output_file
+               << " for writing.";
+    return false;
+  }
+
+  WriteColumns(graph, &writer);
+  if (!writer.good()) {
+    LOG(ERROR) << "Could not write the columnar view graph to " << output_file;
+    return false;
+  }
+  return true;
+}
+
+void WriteColumnarViewGraphToBuffer(const ViewGraph& view_graph,
+                                    std::string* buffer) {
+  CHECK_NOTNULL(buffer)->clear();
+  const CompactViewGraph graph(view_graph);
+  buffer->reserve(GetColumnLayout(graph.NumViews(), graph.NumEdges()).size);
+  StringOutputStreamBuffer stream_buffer(buffer);
+  std::ostream writer(&stream_buffer);
+  WriteColumns(graph, &writer);
+}
+
+bool ReadColumnarViewGraph(
+    const std::string& input_file,
+    std::unique_ptr<CompactViewGraph>* compact_view_graph) {
+  CHECK_NOTNULL(compact_view_graph);
+  if (!FileExists(input_file)) {
+    LOG(ERROR) << "Could not open the file: " << input_file << " for reading.";
+    return false;
+  }
+  const MappedFile file(input_file);
+  return ReadColumns(file.data(), file.size(), input_file, compact_view_graph);
+}
+
+bool ReadColumnarViewGraph(const std::string& input_file,
+                           ViewGraph* view_graph) {
+  CHECK_NOTNULL(view_graph);
+  std::unique_ptr<CompactViewGraph> compact_view_graph;
+  if (!ReadColumnarViewGraph(input_file, &compact_view_graph)) {
+    return false;
+  }
+  view_graph->SetFromCompactViewGraph(*compact_view_graph);
+  return true;
+}
+
+bool ReadColumnarViewGraphFromBuffer(const char* data,
+                                     const size_t size,
+                                     ViewGraph* view_graph) {
+  CHECK_NOTNULL(view_graph);
+  // The columns are read in place, so a misaligned buffer is copied first.
+  std::vector<double> aligned_data;
+  if (reinterpret_cast<uintptr_t>(data) % kColumnAlignment != 0) {
+    aligned_data.resize(AlignUp(size, sizeof(double)) / sizeof(double));
+    memcpy(aligned_data.data(), data, size);
+    data = reinterpret_cast<const char*>(aligned_data.data());
+  }
+
+  std::unique_ptr<CompactViewGraph> compact_view_graph;
+  if (!ReadColumns(data, size, "the buffer", &compact_view_graph)) {
+    return false;
+  }
+  view_graph->SetFromCompactViewGraph(*compact_view_graph);
+  return true;
+}
+
+}  // namespace theia
@@ -0,0 +1,92 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#ifndef THEIA_IO_COLUMNAR_VIEW_GRAPH_H_
+#define THEIA_IO_COLUMNAR_VIEW_GRAPH_H_
+
+#include <cstddef>
+#include <memory>
+#include <string>
+
+namespace theia {
+
+class CompactViewGraph;
+class ViewGraph;
+
+// A versioned binary format for large view graphs that is fast to write and to
+// load. The file holds a 64 byte header followed by one column per field:
+//
+//   - the sorted view ids, including views without edges,
+//   - the two view indices of each edge (view index 1 < view index 2), with
+//     the edges sorted by their view indices,
+//   - the focal lengths, relative positions and relative rotations of the
+//     TwoViewInfo of each edge, and
+//   - the number of verified matches, homography inliers and the visibility
+//     score of each edge.
+//
+// This is the layout of a CompactViewGraph, so the file is memory mapped and
+// its columns are copied straight into the CSR snapshot instead of being
+// deserialized edge by edge into hash maps. All values are in native byte
+// order.
+
+// Writes the view graph in the columnar format. Returns false if the file
+// could not be written.
+bool WriteColumnarViewGraph(const ViewGraph& view_graph,
+                            const std::string& output_file);
+bool WriteColumnarViewGraph(const CompactViewGraph& compact_view_graph,
+                            const std::string& output_file);
+
+// Reads a view graph in the columnar format into a CompactViewGraph. Returns
+// false if the file is not a valid columnar view graph.
+bool ReadColumnarViewGraph(
+    const std::string& input_file,
+    std::unique_ptr<CompactViewGraph>* compact_view_graph);
+
+// Reads a view graph in the columnar format. The contents of view_graph are
+// replaced.
+bool ReadColumnarViewGraph(const std::string& input_file,
+                           ViewGraph* view_graph);
+
+// In-memory variants of the above, which are used to send view graphs between
+// processes. The contents of buffer are replaced. Buffers aligned to 8 bytes
+// are read in place.
+void WriteColumnarViewGraphToBuffer(const ViewGraph& view_graph,
+                                    std::string* buffer);
+bool ReadColumnarViewGraphFromBuffer(const char* data,
+                                     const size_t size,
+                                     ViewGraph* view_graph);
+
+}  // namespace theia
+
+#endif  // THEIA_IO_COLUMNAR_VIEW_GRAPH_H_
@@ -0,0 +1,218 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#include <algorithm>
+#include <fstream>  // NOLINT
+#include <iterator>
+#include <memory>
+#include <string>
+
+#include "gtest/gtest.h"
+
+#include "theia/io/columnar_view_graph.h"
+#include "theia/sfm/twoview_info.h"
+#include "theia/sfm/view_graph/compact_view_graph.h"
+#include "theia/sfm/view_graph/view_graph.h"
+#include "theia/util/random.h"
+
+namespace theia {
+
+namespace {
+
+static const int kNumViews = 40;
+static const int kNumEdges = 200;
+
+std::string TestFilepath(const std::string& filename) {
+  return testing::internal::TempDir() + "/" + filename;
+}
+
+// Builds a random view graph in which one view does not have any edges.
+void BuildViewGraph(ViewGraph* view_graph) {
+  RandomNumberGenerator rng(61);
+  for (int i = 0; i < kNumEdges; i++) {
+    const ViewId view_id1 = rng.RandInt(0, kNumViews - 1);
+    const ViewId view_id2 = rng.RandInt(0, kNumViews - 1);
+    TwoViewInfo info;
+    info.focal_length_1 = rng.RandDouble(500.0, 1500.0);
+    info.focal_length_2 = rng.RandDouble(500.0, 1500.0);
+    info.position_2 = rng.RandVector3d();
+    info.rotation_2 = rng.RandVector3d();
+    info.num_verified_matches = rng.RandInt(0, 1000);
+    info.num_homography_inliers = rng.RandInt(0, 1000);
+    info.visibility_score = rng.RandInt(0, 1000);
+    view_graph->AddEdge(std::min(view_id1, view_id2),
+                        std::max(view_id1, view_id2),
+                        info);
+  }
+  TwoViewInfo info;
+  info.visibility_score = 0;
+  view_graph->AddEdge(kNumViews, kNumViews + 1, info);
+  view_graph->RemoveEdge(kNumViews, kNumViews + 1);
+}
+
+void ExpectEqualEdges(const TwoViewInfo& expected, const TwoViewInfo& actual) {
+  EXPECT_EQ(expected.focal_length_1, actual.focal_length_1);
+  EXPECT_EQ(expected.focal_length_2, actual.focal_length_2);
+  EXPECT_EQ(expected.position_2, actual.position_2);
+  EXPECT_EQ(expected.rotation_2, actual.rotation_2);
+  EXPECT_EQ(expected.num_verified_matches, actual.num_verified_matches);
+  EXPECT_EQ(expected.num_homography_inliers, actual.num_homography_inliers);
+  EXPECT_EQ(expected.visibility_score, actual.visibility_score);
+}
+
+}  // namespace
+
+TEST(ColumnarViewGraph, ViewGraphRoundTrip) {
+  const std::string filepath = TestFilepath("view_graph_round_trip.tvg");
+  ViewGraph view_graph;
+  BuildViewGraph(&view_graph);
+  ASSERT_TRUE(WriteColumnarViewGraph(view_graph, filepath));
+
+  ViewGraph read_view_graph;
+  read_view_graph.AddEdge(1000, 1001, TwoViewInfo());
+  ASSERT_TRUE(ReadColumnarViewGraph(filepath, &read_view_graph));
+  EXPECT_EQ(read_view_graph.ViewIds(), view_graph.ViewIds());
+  EXPECT_EQ(read_view_graph.NumEdges(), view_graph.NumEdges());
+  for (const auto& edge : view_graph.GetAllEdges()) {
+    const TwoViewInfo* read_edge =
+        read_view_graph.GetEdge(edge.first.first, edge.first.second);
+    ASSERT_NE(read_edge, nullptr);
+    ExpectEqualEdges(edge.second, *read_edge);
+  }
+  for (const ViewId view_id : view_graph.ViewIds()) {
+    EXPECT_EQ(*read_view_graph.GetNeighborIdsForView(view_id),
+              *view_graph.GetNeighborIdsForView(view_id));
+  }
+}
+
+TEST(ColumnarViewGraph, BufferRoundTrip) {
+  ViewGraph view_graph;
+  BuildViewGraph(&view_graph);
+  std::string buffer;
+  WriteColumnarViewGraphToBuffer(view_graph, &buffer);
+  std::string file_contents;
+  const std::string filepath = TestFilepath("view_graph_buffer.tvg");
+  ASSERT_TRUE(WriteColumnarViewGraph(view_graph, filepath));
+  {
+    std::ifstream reader(filepath, std::ios::in | std::ios::binary);
+    file_contents.assign(std::istreambuf_iterator<char>(reader),
+                         std::istreambuf_iterator<char>());
+  }
+  EXPECT_EQ(buffer, file_contents);
+
+  // Read the buffer in place and from a misaligned copy.
+  const std::string misaligned_buffer = " " + buffer;
+  for (const char* data : {buffer.data(), misaligned_buffer.data() + 1}) {
+    ViewGraph read_view_graph;
+    ASSERT_TRUE(
+        ReadColumnarViewGraphFromBuffer(data, buffer.size(), &read_view_graph));
+    EXPECT_EQ(read_view_graph.ViewIds(), view_graph.ViewIds());
+    ASSERT_EQ(read_view_graph.NumEdges(), view_graph.NumEdges());
+    for (const auto& edge : view_graph.GetAllEdges()) {
+      const TwoViewInfo* read_edge =
+          read_view_graph.GetEdge(edge.first.first, edge.first.second);
+      ASSERT_NE(read_edge, nullptr);
+      ExpectEqualEdges(edge.second, *read_edge);
+    }
+  }
+
+  ViewGraph read_view_graph;
+  EXPECT_FALSE(ReadColumnarViewGraphFromBuffer(
+      buffer.data(), buffer.size() / 2, &read_view_graph));
+}
+
+TEST(ColumnarViewGraph, ReadCompactViewGraph) {
+  const std::string filepath = TestFilepath("compact_view_graph.tvg");
+  ViewGraph view_graph;
+  BuildViewGraph(&view_graph);
+  const CompactViewGraph expected_graph(view_graph);
+  ASSERT_TRUE(WriteColumnarViewGraph(expected_graph, filepath));
+
+  std::unique_ptr<CompactViewGraph> graph;
+  ASSERT_TRUE(ReadColumnarViewGraph(filepath, &graph));
+  ASSERT_EQ(graph->NumViews(), expected_graph.NumViews());
+  ASSERT_EQ(graph->NumEdges(), expected_graph.NumEdges());
+  for (int i = 0; i < graph->NumViews(); i++) {
+    EXPECT_EQ(graph->ViewIdForIndex(i), expected_graph.ViewIdForIndex(i));
+    ASSERT_EQ(graph->Degree(i), expected_graph.Degree(i));
+    for (int j = 0; j < graph->Degree(i); j++) {
+      EXPECT_EQ(graph->Neighbors(i)[j], expected_graph.Neighbors(i)[j]);
+      EXPECT_EQ(graph->IncidentEdges(i)[j],
+                expected_graph.IncidentEdges(i)[j]);
+    }
+  }
+  for (int i = 0; i < graph->NumEdges(); i++) {
+    EXPECT_EQ(graph->EdgeViewIds(i), expected_graph.EdgeViewIds(i));
+    ExpectEqualEdges(expected_graph.Edge(i), graph->Edge(i));
+  }
+}
+
+TEST(ColumnarViewGraph, EmptyViewGraph) {
+  const std::string filepath = TestFilepath("empty_view_graph.tvg");
+  ASSERT_TRUE(WriteColumnarViewGraph(ViewGraph(), filepath));
+
+  ViewGraph view_graph;
+  ASSERT_TRUE(ReadColumnarViewGraph(filepath, &view_graph));
+  EXPECT_EQ(view_graph.NumViews(), 0);
+  EXPECT_EQ(view_graph.NumEdges(), 0);
+}
+
+TEST(ColumnarViewGraph, InvalidFiles) {
+  ViewGraph view_graph;
+  EXPECT_FALSE(ReadColumnarViewGraph(TestFilepath("missing.tvg"), &view_graph));
+
+  const std::string filepath = TestFilepath("invalid_view_graph.tvg");
+  {
+    std::ofstream writer(filepath, std::ios::out | std::ios::binary);
+    writer << "This is not a view graph.";
+  }
+  EXPECT_FALSE(ReadColumnarViewGraph(filepath, &view_graph));
+
+  // A valid file that is truncated.
+  BuildViewGraph(&view_graph);
+  ASSERT_TRUE(WriteColumnarViewGraph(view_graph, filepath));
+  std::string contents;
+  {
+    std::ifstream reader(filepath, std::ios::in | std::ios::binary);
+    contents.assign(std::istreambuf_iterator<char>(reader),
+                    std::istreambuf_iterator<char>());
+  }
+  {
+    std::ofstream writer(filepath, std::ios::out | std::ios::binary);
+    writer.write(contents.data(), contents.size() / 2);
+  }
+  EXPECT_FALSE(ReadColumnarViewGraph(filepath, &view_graph));
+}
+
+}  // namespace theia
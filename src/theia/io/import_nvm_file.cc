@@ -33,117 +33,247 @@
 // Author: Chris Sweeney (cmsweeney@cs.ucsb.edu)
 
 #include <Eigen/Core>
+#include <Eigen/Geometry>
 #include <glog/logging.h>
 #include <string>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
 #include "theia/io/import_nvm_file.h"
+#include "theia/io/text_parser.h"
 #include "theia/sfm/camera/camera.h"
 #include "theia/sfm/reconstruction.h"
 #include "theia/sfm/track.h"
 #include "theia/sfm/view.h"
 #include "theia/util/filesystem.h"
-#include "theia/util/map_util.h"
-
-#include "visual_sfm/DataInterface.h"
-#include "visual_sfm/util.h"
+#include "theia/util/mapped_file.h"
 
 namespace theia {
 
 namespace {
-struct VSFMReconstruction {
-  std::vector<CameraT> camera_data;
-  std::vector<Point3D> point_data;
-  std::vector<Point2D> measurements;
-  std::vector<int> point_index;
-  std::vector<int> camera_index;
-  std::vector<string> view_names;
-  std::vector<int> point_colors;
+
+struct NVMCamera {
+  std::string filename;
+  double focal_length;
+  // The rotation from world to camera coordinates.
+  Eigen::Matrix3d rotation;
+  Eigen::Vector3d position;
 };
+
+struct NVMPoint {
+  Eigen::Vector3d position;
+  Eigen::Vector3i color;
+  // The camera index and the position of each observation. The positions are
+  // relative to the principal point.
+  std::vector<std::pair<int, Eigen::Vector2d> > observations;
+};
+
+// Reads the optional header line, which states whether the rotations are given
+// as quaternions (NVM_V3) or as rotation matrices (NVM_V3_R9T). Calibration
+// settings such as FixedK are ignored.
+void ReadNVMHeader(TextParser* in, bool* rotation_as_matrix) {
+  *rotation_as_matrix = false;
+  if (!in->AtEnd() && *in->position() == 'N') {
+    std::string header;
+    in->ParseToken(&header);
+    *rotation_as_matrix = header.find("R9T") != std::string::npos;
+    in->SkipLine();
+  }
+}
+
+// Each camera has the form:
+//   <filename> <focal length> <quaternion wxyz> <camera center> <distortion> 0
+// or, in the R9T format, a row-major rotation matrix and a translation in place
+// of the quaternion and the camera center.
+bool ReadNVMCamera(const bool rotation_as_matrix,
+                   TextParser* in,
+                   NVMCamera* camera) {
+  if (!in->ParseToken(&camera->filename) ||
+      !in->ParseDouble(&camera->focal_length)) {
+    return false;
+  }
+  double rotation[9];
+  const int num_rotation_parameters = rotation_as_matrix ? 9 : 4;
+  for (int i = 0; i < num_rotation_parameters; i++) {
+    if (!in->ParseDouble(&rotation[i])) {
+      return false;
+    }
+  }
+  // The distortion parameters are not used.
+  double center[3], distortion[2];
+  if (!in->ParseDouble(&center[0]) || !in->ParseDouble(&center[1]) ||
+      !in->ParseDouble(&center[2]) || !in->ParseDouble(&distortion[0]) ||
+      !in->ParseDouble(&distortion[1])) {
+    return false;
+  }
+
+  const Eigen::Vector3d center_or_translation(center[0], center[1], center[2]);
+  if (rotation_as_matrix) {
+    for (int i = 0; i < 9; i++) {
+      camera->rotation(i / 3, i % 3) = rotation[i];
+    }
+    camera->position = -camera->rotation.transpose() * center_or_translation;
+  } else {
+    const Eigen::Quaterniond quaternion(
+        rotation[0], rotation[1], rotation[2], rotation[3]);
+    camera->rotation = quaternion.norm() > 0.0
+                           ? quaternion.normalized().toRotationMatrix()
+                           : Eigen::Matrix3d::Identity();
+    camera->position = center_or_translation;
+  }
+  return true;
+}
+
+// Each point is written on one line as:
+//   <position> <color> <num observations> <observation 1> <observation 2> ...
+// where each observation is <camera index> <feature index> <x> <y>.
+bool ReadNVMPoint(const int num_cameras, TextParser* in, NVMPoint* point) {
+  int num_observations;
+  if (!in->ParseDouble(&point->position[0]) ||
+      !in->ParseDouble(&point->position[1]) ||
+      !in->ParseDouble(&point->position[2]) ||
+      !in->ParseInt(&point->color[0]) || !in->ParseInt(&point->color[1]) ||
+      !in->ParseInt(&point->color[2]) || !in->ParseInt(&num_observations) ||
+      num_observations < 0) {
+    return false;
+  }
+  point->observations.resize(num_observations);
+  for (auto& observation : point->observations) {
+    int feature_index;
+    if (!in->ParseInt(&observation.first) || !in->ParseInt(&feature_index) ||
+        !in->ParseDouble(&observation.second[0]) ||
+        !in->ParseDouble(&observation.second[1]) || observation.first < 0 ||
+        observation.first >= num_cameras) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Reads the first model of an NVM file. The points are parsed in parallel.
+bool ReadNVMFile(const std::string& nvm_filepath,
+                 const int num_threads,
+                 std::vector<NVMCamera>* cameras,
+                 std::vector<NVMPoint>* points) {
+  if (!FileExists(nvm_filepath)) {
+    LOG(ERROR) << "Could not open the NVM file: " << nvm_filepath;
+    return false;
+  }
+  const MappedFile file(nvm_filepath);
+  const char* end = file.data() + file.size();
+  TextParser in(file.data(), end);
+
+  bool rotation_as_matrix;
+  ReadNVMHeader(&in, &rotation_as_matrix);
+
+  int num_cameras;
+  if (!in.ParseInt(&num_cameras) || num_cameras < 1) {
+    LOG(ERROR) << "Could not read the number of cameras from "
+               << nvm_filepath;
+    return false;
+  }
+  cameras->resize(num_cameras);
+  for (NVMCamera& camera : *cameras) {
+    if (!ReadNVMCamera(rotation_as_matrix, &in, &camera)) {
+      LOG(ERROR) << "Could not read the cameras from " << nvm_filepath;
+      return false;
+    }
+  }
+
+  int num_points;
+  if (!in.ParseInt(&num_points) || num_points < 0) {
+    LOG(ERROR) << "Could not read the number of points from " << nvm_filepath;
+    return false;
+  }
+  points->resize(num_points);
+  const auto read_point = [&](TextParser* parser, const int i) {
+    return ReadNVMPoint(num_cameras, parser, &(*points)[i]);
+  };
+  if (!ParseRecords(in.position(),
+                    end,
+                    num_points,
+                    1,
+                    num_threads,
+                    read_point,
+                    nullptr)) {
+    LOG(ERROR) << "Could not read the points from " << nvm_filepath;
+    return false;
+  }
+  return true;
+}
+
 }  // namespace
 
 bool ImportNVMFile(const std::string& nvm_filepath,
-                   Reconstruction* reconstruction) {
+                   Reconstruction* reconstruction,
+                   const int num_threads) {
   CHECK_GT(nvm_filepath.length(), 0);
   CHECK_NOTNULL(reconstruction);
 
   // Read VSFM file.
-  VSFMReconstruction vsfm_reconstruction;
-  CHECK(LoadModelFile(nvm_filepath.c_str(),
-                      vsfm_reconstruction.camera_data,
-                      vsfm_reconstruction.point_data,
-                      vsfm_reconstruction.measurements,
-                      vsfm_reconstruction.point_index,
-                      vsfm_reconstruction.camera_index,
-                      vsfm_reconstruction.view_names,
-                      vsfm_reconstruction.point_colors));
-
-  // Check the NVM reconstruction for sanity.
-  CHECK_EQ(vsfm_reconstruction.view_names.size(),
-           vsfm_reconstruction.camera_data.size());
-  CHECK_EQ(vsfm_reconstruction.measurements.size(),
-           vsfm_reconstruction.point_index.size());
-  CHECK_EQ(vsfm_reconstruction.point_index.size(),
-           vsfm_reconstruction.camera_index.size());
+  std::vector<NVMCamera> cameras;
+  std::vector<NVMPoint> points;
+  if (!ReadNVMFile(nvm_filepath, num_threads, &cameras, &points)) {
+    return false;
+  }
 
   // Add all cameras to the reconstruction.
-  for (int i = 0; i < vsfm_reconstruction.camera_data.size(); i++) {
+  std::vector<ViewId> view_ids(cameras.size());
+  for (int i = 0; i < cameras.size(); i++) {
     std::string view_name;
-    GetFilenameFromFilepath(
-        vsfm_reconstruction.view_names[i], true, &view_name);
+    GetFilenameFromFilepath(cameras[i].filename, true, &view_name);
     // Add the view to the reconstruction.
     LOG(INFO) << "Adding view " << view_name << " to the reconstruction.";
-    const ViewId view_id = reconstruction->AddView(view_name, i);
-    CHECK_NE(view_id, kInvalidViewId);
-    View* view = reconstruction->MutableView(view_id);
+    view_ids[i] = reconstruction->AddView(view_name, i);
+    CHECK_NE(view_ids[i], kInvalidViewId);
+    View* view = reconstruction->MutableView(view_ids[i]);
     view->SetEstimated(true);
 
-    // Set the camera intrinsic parameters.
-    const CameraT& vsfm_camera = vsfm_reconstruction.camera_data[i];
+    // Set the camera intrinsic and extrinsic parameters.
     Camera* camera = view->MutableCamera();
     camera->SetCameraIntrinsicsModelType(CameraIntrinsicsModelType::PINHOLE);
-    camera->SetFocalLength(vsfm_camera.GetFocalLength());
-
-    // Set the camera extrinsic parameters. The rotation matrix is retreived
-    // from visual sfm in row-major order, hence the transpose.
-    Eigen::Matrix3f rotation;
-    vsfm_camera.GetMatrixRotation(rotation.data());
-    camera->SetOrientationFromRotationMatrix(
-        rotation.transpose().cast<double>());
-    Eigen::Vector3f position;
-    vsfm_camera.GetCameraCenter(position.data());
-    camera->SetPosition(position.cast<double>());
+    camera->SetFocalLength(cameras[i].focal_length);
+    camera->SetOrientationFromRotationMatrix(cameras[i].rotation);
+    camera->SetPosition(cameras[i].position);
   }
 
-  // Create the track correspondences.
-  std::unordered_map<int, std::vector<std::pair<ViewId, Feature>>> tracks;
-  for (int i = 0; i < vsfm_reconstruction.measurements.size(); i++) {
-    const Feature feature(
-        Eigen::Vector2d(vsfm_reconstruction.measurements[i].x,
-                        vsfm_reconstruction.measurements[i].y));
-    const int img_id = vsfm_reconstruction.camera_index[i];
-    tracks[vsfm_reconstruction.point_index[i]].emplace_back(img_id, feature);
+  // Allocate the tracks and the features of each view at once.
+  std::unordered_map<ViewId, int> num_observations_per_view;
+  for (const NVMPoint& point : points) {
+    for (const auto& observation : point.observations) {
+      ++num_observations_per_view[view_ids[observation.first]];
+    }
   }
+  reconstruction->ReserveTracks(points.size(), num_observations_per_view);
 
   // Add all tracks to the reconstruction and set the 3d position.
-  for (int i = 0; i < vsfm_reconstruction.point_data.size(); i++) {
-    Eigen::Vector4f point(vsfm_reconstruction.point_data[i].xyz[0],
-                          vsfm_reconstruction.point_data[i].xyz[1],
-                          vsfm_reconstruction.point_data[i].xyz[2],
-                          1.0);
-    Eigen::Vector3i color(vsfm_reconstruction.point_colors[3 * i],
-                          vsfm_reconstruction.point_colors[3 * i + 1],
-                          vsfm_reconstruction.point_colors[3 * i + 2]);
-    const auto& features = FindOrDie(tracks, i);
+  int num_invalid_tracks = 0;
+  std::vector<std::pair<ViewId, Feature> > features;
+  for (const NVMPoint& point : points) {
+    features.clear();
+    for (const auto& observation : point.observations) {
+      features.emplace_back(view_ids[observation.first],
+                            Feature(observation.second));
+    }
     const TrackId track_id = reconstruction->AddTrack(features);
-    CHECK_NE(track_id, kInvalidTrackId);
+    if (track_id == kInvalidTrackId) {
+      ++num_invalid_tracks;
+      continue;
+    }
     Track* track = reconstruction->MutableTrack(track_id);
     track->SetEstimated(true);
-    *track->MutablePoint() = point.cast<double>();
-    *track->MutableColor() = color.cast<uint8_t>();
+    *track->MutablePoint() = point.position.homogeneous();
+    *track->MutableColor() = point.color.cast<uint8_t>();
   }
 
+  if (num_invalid_tracks > 0) {
+    LOG(INFO) << "Could not load " << num_invalid_tracks
+              << " invalid tracks out of " << points.size()
+              << " total tracks from the NVM file. This occurs when tracks "
+                 "have fewer than two observations or multiple observations "
+                 "from the same image.";
+  }
   return true;
 }
 
@@ -45,8 +45,12 @@ class Reconstruction;
 // Theia reconstruction. This file contains a 3D reconstruction along with
 // correspondence information. More information on NVM files can be found at
 // http://ccwu.me/vsfm/
+//
+// Only the first model of the file is imported. The points are parsed with
+// num_threads threads.
 bool ImportNVMFile(const std::string& nvm_filepath,
-                   Reconstruction* reconstruction);
+                   Reconstruction* reconstruction,
+                   const int num_threads = 1);
 
 }  // namespace theia
 
@@ -0,0 +1,177 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#include <Eigen/Core>
+#include <Eigen/Geometry>
+
+#include <fstream>  // NOLINT
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "theia/io/import_nvm_file.h"
+#include "theia/sfm/camera/camera.h"
+#include "theia/sfm/reconstruction.h"
+#include "theia/sfm/track.h"
+#include "theia/sfm/view.h"
+
+namespace theia {
+
+namespace {
+
+static const double kTolerance = 1e-12;
+
+std::string WriteTestFile(const std::string& name,
+                          const std::string& contents) {
+  const std::string filepath = testing::internal::TempDir() + name;
+  std::ofstream ofs(filepath);
+  ofs << contents;
+  return filepath;
+}
+
+// The second camera is rotated by 90 degrees about the z axis and its center is
+// at (1, 2, 3). The R9T format stores the same rotation as a matrix and the
+// translation -R * c instead of the center.
+static const char kNVMFile[] =
+    "NVM_V3\n"
+    "\n"
+    "2\n"
+    "images/a.jpg 500 1 0 0 0 0 0 0 0 0\n"
+    "images/b.jpg 600 0.70710678118654752 0 0 0.70710678118654752 1 2 3 0 0\n"
+    "3\n"
+    "0.5 1.5 -2 255 0 10 2 0 4 10.5 -3 1 7 -1 2.25\n"
+    "1 2 3 1 2 3 2 1 0 0 0 0 1 3 3\n"
+    "-1 -2 -3 4 5 6 2 1 1 5 5 0 2 6 6\n"
+    "\n"
+    "0\n";
+
+static const char kNVMR9TFile[] =
+    "NVM_V3_R9T\n"
+    "\n"
+    "2\n"
+    "images/a.jpg 500 1 0 0 0 1 0 0 0 1 0 0 0 0 0\n"
+    "images/b.jpg 600 0 -1 0 1 0 0 0 0 1 2 -1 -3 0 0\n"
+    "0\n";
+
+void ExpectCameras(const Reconstruction& reconstruction) {
+  ASSERT_EQ(reconstruction.NumViews(), 2);
+  const View* view_a =
+      reconstruction.View(reconstruction.ViewIdFromName("a.jpg"));
+  const View* view_b =
+      reconstruction.View(reconstruction.ViewIdFromName("b.jpg"));
+  ASSERT_TRUE(view_a != nullptr);
+  ASSERT_TRUE(view_b != nullptr);
+  EXPECT_TRUE(view_a->IsEstimated());
+  EXPECT_EQ(view_a->Camera().FocalLength(), 500.0);
+  EXPECT_EQ(view_b->Camera().FocalLength(), 600.0);
+  EXPECT_TRUE(view_a->Camera().GetOrientationAsRotationMatrix().isApprox(
+      Eigen::Matrix3d::Identity(), kTolerance));
+  EXPECT_LT(view_a->Camera().GetPosition().norm(), kTolerance);
+
+  const Eigen::Matrix3d expected_rotation =
+      Eigen::AngleAxisd(M_PI / 2.0, Eigen::Vector3d::UnitZ())
+          .toRotationMatrix();
+  EXPECT_TRUE(view_b->Camera().GetOrientationAsRotationMatrix().isApprox(
+      expected_rotation, 1e-8));
+  EXPECT_TRUE(view_b->Camera().GetPosition().isApprox(
+      Eigen::Vector3d(1.0, 2.0, 3.0), 1e-8));
+}
+
+}  // namespace
+
+TEST(ImportNVMFile, CamerasAndPoints) {
+  const std::string nvm_file = WriteTestFile("test.nvm", kNVMFile);
+  for (const int num_threads : {1, 4}) {
+    Reconstruction reconstruction;
+    EXPECT_TRUE(ImportNVMFile(nvm_file, &reconstruction, num_threads));
+    ExpectCameras(reconstruction);
+
+    const ViewId view_a = reconstruction.ViewIdFromName("a.jpg");
+    const ViewId view_b = reconstruction.ViewIdFromName("b.jpg");
+    ASSERT_EQ(reconstruction.NumTracks(), 3);
+    const std::vector<TrackId> track_ids = reconstruction.TrackIds();
+    TrackId track_id = kInvalidTrackId;
+    for (const TrackId id : track_ids) {
+      if (reconstruction.Track(id)->Point().x() == 0.5) {
+        track_id = id;
+      }
+    }
+    ASSERT_NE(track_id, kInvalidTrackId);
+    const Track* track = reconstruction.Track(track_id);
+    EXPECT_TRUE(track->IsEstimated());
+    EXPECT_TRUE(track->Point() == Eigen::Vector4d(0.5, 1.5, -2.0, 1.0));
+    EXPECT_EQ(track->Color()[0], 255);
+    EXPECT_EQ(track->Color()[2], 10);
+    ASSERT_EQ(track->NumViews(), 2);
+    const Feature* feature_a =
+        reconstruction.View(view_a)->GetFeature(track_id);
+    const Feature* feature_b =
+        reconstruction.View(view_b)->GetFeature(track_id);
+    ASSERT_TRUE(feature_a != nullptr);
+    ASSERT_TRUE(feature_b != nullptr);
+    EXPECT_EQ(feature_a->x(), 10.5);
+    EXPECT_EQ(feature_a->y(), -3.0);
+    EXPECT_EQ(feature_b->x(), -1.0);
+    EXPECT_EQ(feature_b->y(), 2.25);
+
+    int num_observations = 0;
+    for (const TrackId id : track_ids) {
+      num_observations += reconstruction.Track(id)->NumViews();
+    }
+    EXPECT_EQ(num_observations, 6);
+  }
+}
+
+TEST(ImportNVMFile, RotationMatrixFormat) {
+  const std::string nvm_file = WriteTestFile("test_r9t.nvm", kNVMR9TFile);
+  Reconstruction reconstruction;
+  EXPECT_TRUE(ImportNVMFile(nvm_file, &reconstruction));
+  ExpectCameras(reconstruction);
+  EXPECT_EQ(reconstruction.NumTracks(), 0);
+}
+
+TEST(ImportNVMFile, InvalidFiles) {
+  Reconstruction reconstruction;
+  EXPECT_FALSE(ImportNVMFile(
+      testing::internal::TempDir() + "missing.nvm", &reconstruction));
+
+  // An observation of a camera that does not exist.
+  const std::string nvm_file = WriteTestFile(
+      "invalid.nvm", "NVM_V3\n\n1\na.jpg 500 1 0 0 0 0 0 0 0 0\n1\n"
+                     "0 0 0 0 0 0 1 3 0 1 1\n");
+  EXPECT_FALSE(ImportNVMFile(nvm_file, &reconstruction));
+}
+
+}  // namespace theia
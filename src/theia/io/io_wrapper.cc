@@ -1,9 +1,13 @@
 #include "theia/io/io_wrapper.h"
 
+#include "theia/io/columnar_reconstruction.h"
+#include "theia/io/columnar_view_graph.h"
 #include "theia/io/import_nvm_file.h"
 #include "theia/io/populate_image_sizes.h"
 #include "theia/io/read_1dsfm.h"
+#include "theia/io/read_bal_file.h"
 #include "theia/io/read_bundler_files.h"
+#include "theia/io/read_colmap_files.h"
 #include "theia/io/read_keypoints_and_descriptors.h"
 #include "theia/io/read_strecha_dataset.h"
 #include "theia/io/reconstruction_reader.h"
@@ -13,9 +17,9 @@
 namespace theia {
 
 std::tuple<bool, Reconstruction> ImportNVMFileWrapper(
-    const std::string& nvm_filepath) {
+    const std::string& nvm_filepath, const int num_threads) {
   Reconstruction reconstr = Reconstruction();
-  const bool success = ImportNVMFile(nvm_filepath, &reconstr);
+  const bool success = ImportNVMFile(nvm_filepath, &reconstr, num_threads);
   return std::make_tuple(success, reconstr);
 }
 
@@ -28,17 +32,28 @@ std::tuple<bool, Reconstruction> PopulateImageSizesAndPrincipalPointsWrapper(
 }
 
 std::tuple<bool, Reconstruction, ViewGraph> Read1DSFMWrapper(
-    const std::string& dataset_directory) {
+    const std::string& dataset_directory, const int num_threads) {
   ViewGraph view_graph = ViewGraph();
   Reconstruction reconstr = Reconstruction();
-  const bool success = Read1DSFM(dataset_directory, &reconstr, &view_graph);
+  const bool success =
+      Read1DSFM(dataset_directory, &reconstr, &view_graph, num_threads);
   return std::make_tuple(success, reconstr, view_graph);
 }
 
+std::tuple<bool, Reconstruction> ReadBalFileWrapper(
+    const std::string& bal_file) {
+  Reconstruction reconstr = Reconstruction();
+  const bool success = ReadBalFile(bal_file, &reconstr);
+  return std::make_tuple(success, reconstr);
+}
+
 std::tuple<bool, Reconstruction> ReadBundlerFilesWrapper(
-    const std::string& lists_file, const std::string& bundle_file) {
+    const std::string& lists_file,
+    const std::string& bundle_file,
+    const int num_threads) {
   Reconstruction reconstr = Reconstruction();
-  const bool success = ReadBundlerFiles(lists_file, bundle_file, &reconstr);
+  const bool success =
+      ReadBundlerFiles(lists_file, bundle_file, &reconstr, num_threads);
   return std::make_tuple(success, reconstr);
 }
 
@@ -65,6 +80,28 @@ std::tuple<bool, Reconstruction> ReadReconstructionWrapper(
   return std::make_tuple(success, reconstr);
 }
 
+std::tuple<bool, Reconstruction> ReadColmapBinaryFilesWrapper(
+    const std::string& input_directory) {
+  Reconstruction reconstr = Reconstruction();
+  const bool success = ReadColmapBinaryFiles(input_directory, &reconstr);
+  return std::make_tuple(success, reconstr);
+}
+
+std::tuple<bool, Reconstruction> ReadColumnarReconstructionWrapper(
+    const std::string& input_file, const int num_threads) {
+  Reconstruction reconstr = Reconstruction();
+  const bool success =
+      ReadColumnarReconstruction(input_file, &reconstr, num_threads);
+  return std::make_tuple(success, reconstr);
+}
+
+std::tuple<bool, ViewGraph> ReadColumnarViewGraphWrapper(
+    const std::string& input_file) {
+  ViewGraph view_graph;
+  const bool success = ReadColumnarViewGraph(input_file, &view_graph);
+  return std::make_tuple(success, view_graph);
+}
+
 std::tuple<bool, std::vector<Eigen::VectorXf>, std::vector<Keypoint>>
 ReadSiftKeyBinaryFileWrapper(const std::string& input_sift_key_file) {
   std::vector<Eigen::VectorXf> descriptor;
@@ -83,4 +120,22 @@ ReadSiftKeyTextFileWrapper(const std::string& sift_key_file) {
   return std::make_tuple(success, descriptor, keypoint);
 }
 
+std::tuple<bool, KeypointsAndDescriptors>
+ReadSiftKeyBinaryFileToFeaturesWrapper(const std::string& input_sift_key_file,
+                                       const int num_threads) {
+  KeypointsAndDescriptors features;
+  const bool success =
+      ReadSiftKeyBinaryFile(input_sift_key_file, num_threads, &features);
+  return std::make_tuple(success, features);
+}
+
+std::tuple<bool, KeypointsAndDescriptors>
+ReadSiftKeyTextFileToFeaturesWrapper(const std::string& sift_key_file,
+                                     const int num_threads) {
+  KeypointsAndDescriptors features;
+  const bool success =
+      ReadSiftKeyTextFile(sift_key_file, num_threads, &features);
+  return std::make_tuple(success, features);
+}
+
 }  // namespace theia
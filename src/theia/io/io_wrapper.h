@@ -5,6 +5,7 @@
 #include <vector>
 
 #include "theia/image/keypoint_detector/keypoint.h"
+#include "theia/matching/keypoints_and_descriptors.h"
 #include "theia/sfm/reconstruction.h"
 #include "theia/sfm/view_graph/view_graph.h"
 
@@ -14,22 +15,38 @@ class Reconstruction;
 class ViewGraph;
 
 std::tuple<bool, Reconstruction> ImportNVMFileWrapper(
-    const std::string& nvm_filepath);
+    const std::string& nvm_filepath, const int num_threads = 1);
 std::tuple<bool, Reconstruction> PopulateImageSizesAndPrincipalPointsWrapper(
     const std::string& image_directory);
 std::tuple<bool, Reconstruction, ViewGraph> Read1DSFMWrapper(
-    const std::string& dataset_directory);
+    const std::string& dataset_directory, const int num_threads = 1);
+std::tuple<bool, Reconstruction> ReadBalFileWrapper(
+    const std::string& bal_file);
 std::tuple<bool, Reconstruction> ReadBundlerFilesWrapper(
-    const std::string& lists_file, const std::string& bundle_file);
+    const std::string& lists_file,
+    const std::string& bundle_file,
+    const int num_threads = 1);
 std::tuple<bool, std::vector<Keypoint>, std::vector<Eigen::VectorXf>>
 ReadKeypointsAndDescriptorsWrapper(const std::string& features_file);
 std::tuple<bool, Reconstruction> ReadStrechaDatasetWrapper(
     const std::string& dataset_directory);
 std::tuple<bool, Reconstruction> ReadReconstructionWrapper(
     const std::string& input_file);
+std::tuple<bool, Reconstruction> ReadColmapBinaryFilesWrapper(
+    const std::string& input_directory);
+std::tuple<bool, Reconstruction> ReadColumnarReconstructionWrapper(
+    const std::string& input_file, const int num_threads);
+std::tuple<bool, ViewGraph> ReadColumnarViewGraphWrapper(
+    const std::string& input_file);
 std::tuple<bool, std::vector<Eigen::VectorXf>, std::vector<Keypoint>>
 ReadSiftKeyBinaryFileWrapper(const std::string& input_sift_key_file);
 std::tuple<bool, std::vector<Eigen::VectorXf>, std::vector<Keypoint>>
 ReadSiftKeyTextFileWrapper(const std::string& sift_key_file);
+std::tuple<bool, KeypointsAndDescriptors>
+ReadSiftKeyBinaryFileToFeaturesWrapper(const std::string& input_sift_key_file,
+                                       const int num_threads);
+std::tuple<bool, KeypointsAndDescriptors>
+ReadSiftKeyTextFileToFeaturesWrapper(const std::string& sift_key_file,
+                                     const int num_threads);
 
 }  // namespace theia
@@ -40,6 +40,7 @@
 #include <glog/logging.h>
 
 #include <algorithm>
+#include <atomic>
 #include <fstream>  // NOLINT
 #include <string>
 #include <unordered_map>
@@ -47,23 +48,50 @@
 #include <utility>
 #include <vector>
 
-#include "theia/sfm/find_common_tracks_in_views.h"
+#include "theia/io/text_parser.h"
 #include "theia/sfm/reconstruction.h"
 #include "theia/sfm/track.h"
 #include "theia/sfm/types.h"
 #include "theia/sfm/view.h"
 #include "theia/sfm/view_graph/view_graph.h"
+#include "theia/util/executor.h"
 #include "theia/util/filesystem.h"
 #include "theia/util/map_util.h"
+#include "theia/util/mapped_file.h"
 
 namespace theia {
+namespace {
+
+// Returns the number of tracks in both sorted vectors of track ids.
+int NumCommonTracks(const std::vector<TrackId>& sorted_track_ids1,
+                    const std::vector<TrackId>& sorted_track_ids2) {
+  int num_common_tracks = 0;
+  auto it1 = sorted_track_ids1.begin();
+  auto it2 = sorted_track_ids2.begin();
+  while (it1 != sorted_track_ids1.end() && it2 != sorted_track_ids2.end()) {
+    if (*it1 < *it2) {
+      ++it1;
+    } else if (*it2 < *it1) {
+      ++it2;
+    } else {
+      ++num_common_tracks;
+      ++it1;
+      ++it2;
+    }
+  }
+  return num_common_tracks;
+}
+
+}  // namespace
 
 class Input1DSFM {
  public:
   Input1DSFM(const std::string& dataset_directory,
+             const int num_threads,
              Reconstruction* reconstruction,
              ViewGraph* view_graph)
       : dataset_directory_(dataset_directory),
+        num_threads_(num_threads),
         reconstruction_(reconstruction),
         view_graph_(view_graph) {}
 
@@ -79,6 +107,7 @@ class Input1DSFM {
                             int* num_keys);
 
   const std::string& dataset_directory_;
+  const int num_threads_;
   Reconstruction* reconstruction_;
   ViewGraph* view_graph_;
 
@@ -168,23 +197,29 @@ bool Input1DSFM::ReadListsFile(
   return true;
 }
 
+// Reads the header line of the keys of an image. Returns false if the line is
+// not a header line. The view id is set to kInvalidViewId if the image is not
+// in the connected component.
 bool Input1DSFM::ReadCoordsHeaderLine(const std::string& line,
                                       ViewId* view_id,
                                       int* num_keys) {
   float principal_point_x, principal_point_y, focal_length;
   char name[256];
-  sscanf(line.c_str(),
-         "#index = %d, name = %s keys = %d, px = %f, py = %f, focal = %f",
-         view_id,
-         name,
-         num_keys,
-         &principal_point_x,
-         &principal_point_y,
-         &focal_length);
+  if (sscanf(line.c_str(),
+             "#index = %d, name = %s keys = %d, px = %f, py = %f, focal = %f",
+             view_id,
+             name,
+             num_keys,
+             &principal_point_x,
+             &principal_point_y,
+             &focal_length) != 6) {
+    return false;
+  }
 
   View* view = reconstruction_->MutableView(*view_id);
   if (view == nullptr) {
-    return false;
+    *view_id = kInvalidViewId;
+    return true;
   }
 
   // Set the metadata.
@@ -197,152 +232,260 @@ bool Input1DSFM::ReadCoordsHeaderLine(const std::string& line,
   return true;
 }
 
-// Reads the coords file. Only the coords with a valid track in the connected
-// component are kept.
+// Reads the coords file. Only the coords of the images in the connected
+// component are kept. The header lines are found first by skipping over the
+// keys, and then the keys of all images are parsed in parallel.
 bool Input1DSFM::ReadCoords() {
   const std::string coords_filename = dataset_directory_ + "/coords.txt";
-  std::ifstream ifs(coords_filename.c_str(), std::ios::in);
-  if (!ifs.is_open()) {
+  if (!FileExists(coords_filename)) {
     LOG(ERROR) << "Cannot read the coords file from " << coords_filename;
     return false;
   }
-
+  const MappedFile file(coords_filename);
+  const char* position = file.data();
+  const char* file_end = file.data() + file.size();
+
+  // The keys of an image in the connected component.
+  struct Keys {
+    std::vector<Feature>* features;
+    std::vector<Eigen::Matrix<uint8_t, 3, 1> >* colors;
+    const char* begin;
+    const char* end;
+  };
+  std::vector<Keys> keys;
   feature_coordinates_.reserve(reconstruction_->NumViews());
   feature_colors_.reserve(reconstruction_->NumViews());
-  while (!ifs.eof()) {
-    std::string line;
-    std::getline(ifs, line);
-    if (ifs.eof()) {
-      break;
+  while (position != file_end) {
+    const char* next_line = SkipLines(position, file_end, 1);
+    if (TextParser(position, next_line).AtEnd()) {
+      position = next_line;
+      continue;
     }
 
     int num_keys;
     ViewId view_id;
+    if (!ReadCoordsHeaderLine(
+            std::string(position, next_line), &view_id, &num_keys) ||
+        num_keys < 0) {
+      LOG(ERROR) << "Invalid header line in " << coords_filename << ": "
+                 << std::string(position, next_line);
+      return false;
+    }
+    position = SkipLines(next_line, file_end, num_keys);
+
     // If the image is not in the connected component then do not read it.
-    if (!ReadCoordsHeaderLine(line, &view_id, &num_keys)) {
-      for (int i = 0; i < num_keys; i++) {
-        std::getline(ifs, line);
-      }
+    if (view_id == kInvalidViewId) {
       continue;
     }
+    std::vector<Feature>* features = &feature_coordinates_[view_id];
+    features->resize(num_keys);
+    std::vector<Eigen::Matrix<uint8_t, 3, 1> >* colors =
+        &feature_colors_[view_id];
+    colors->resize(num_keys);
+    keys.push_back({features, colors, next_line, position});
+  }
 
-    auto& features = feature_coordinates_[view_id];
-    features.reserve(num_keys);
-    auto& colors = feature_colors_[view_id];
-    colors.reserve(num_keys);
-
-    Eigen::Vector2d keypoint;
-    Eigen::Vector3i color;
-    for (int i = 0; i < num_keys; i++) {
-      std::getline(ifs, line);
-      sscanf(line.c_str(),
-             "%*d %lf %lf 0 0 %d %d %d",
-             &keypoint[0],
-             &keypoint[1],
-             &color[0],
-             &color[1],
-             &color[2]);
-      features.emplace_back(keypoint);
-      colors.emplace_back(color.cast<uint8_t>());
+  // Each key has the form: <index> <x> <y> <scale> <orientation> <r> <g> <b>.
+  std::atomic<bool> success(true);
+  ParallelFor(num_threads_, keys.size(), [&](const int begin, const int end) {
+    for (int i = begin; i < end && success; i++) {
+      TextParser parser(keys[i].begin, keys[i].end);
+      for (int j = 0; j < keys[i].features->size(); j++) {
+        int index;
+        Eigen::Vector2d keypoint;
+        double scale, orientation;
+        Eigen::Vector3i color;
+        if (!parser.ParseInt(&index) || !parser.ParseDouble(&keypoint[0]) ||
+            !parser.ParseDouble(&keypoint[1]) || !parser.ParseDouble(&scale) ||
+            !parser.ParseDouble(&orientation) || !parser.ParseInt(&color[0]) ||
+            !parser.ParseInt(&color[1]) || !parser.ParseInt(&color[2])) {
+          success = false;
+          break;
+        }
+        (*keys[i].features)[j] = Feature(keypoint);
+        (*keys[i].colors)[j] = color.cast<uint8_t>();
+      }
     }
+  });
+  if (!success) {
+    LOG(ERROR) << "Could not parse the keys in " << coords_filename;
+    return false;
   }
 
   return true;
 }
 
+// Reads the tracks file, which holds the number of tracks followed by one
+// track per line of the form:
+//   <num features> <image index 1> <key index 1> <image index 2> ...
+// The tracks are parsed in parallel and then added to the reconstruction.
 bool Input1DSFM::ReadTracks() {
   const std::string tracks_filename = dataset_directory_ + "/tracks.txt";
-  std::ifstream ifs(tracks_filename.c_str(), std::ios::in);
-  if (!ifs.is_open()) {
-    LOG(ERROR) << "Cannot read the coords file from " << tracks_filename;
+  if (!FileExists(tracks_filename)) {
+    LOG(ERROR) << "Cannot read the tracks file from " << tracks_filename;
     return false;
   }
+  const MappedFile file(tracks_filename);
+  const char* end = file.data() + file.size();
+  TextParser in(file.data(), end);
 
   // Read number of tracks.
   int num_tracks;
-  ifs >> num_tracks;
+  if (!in.ParseInt(&num_tracks) || num_tracks < 0) {
+    LOG(ERROR) << "Cannot read the number of tracks from " << tracks_filename;
+    return false;
+  }
 
-  for (int i = 0; i < num_tracks; i++) {
+  std::vector<std::vector<std::pair<ViewId, Feature> > > tracks(num_tracks);
+  std::vector<Eigen::Matrix<uint8_t, 3, 1> > track_colors(num_tracks);
+  const auto read_track = [&](TextParser* parser, const int i) {
     int num_features;
-    ifs >> num_features;
+    if (!parser->ParseInt(&num_features) || num_features < 0) {
+      return false;
+    }
 
-    std::vector<std::pair<ViewId, Feature> > track;
+    std::vector<std::pair<ViewId, Feature> >& track = tracks[i];
+    track.clear();
     track.reserve(num_features);
-    int feature_id;
-    ViewId view_id;
     Eigen::Vector3f color = Eigen::Vector3f::Zero();
     for (int j = 0; j < num_features; j++) {
-      ifs >> view_id;
-      ifs >> feature_id;
+      int view_id, feature_id;
+      if (!parser->ParseInt(&view_id) || !parser->ParseInt(&feature_id)) {
+        return false;
+      }
 
       // Aggregate the features that form this track.
-      const auto& features = FindOrDie(feature_coordinates_, view_id);
-      const Feature& feature = features[feature_id];
-      track.emplace_back(view_id, feature);
+      const auto* features = FindOrNull(feature_coordinates_, view_id);
+      if (features == nullptr || feature_id < 0 ||
+          feature_id >= features->size()) {
+        return false;
+      }
+      track.emplace_back(view_id, (*features)[feature_id]);
 
       // Add the color of the feature to form the mean color of the point.
       const auto& colors = FindOrDie(feature_colors_, view_id);
       color += colors[feature_id].cast<float>();
     }
-    // Add the track to the reconstruction.
-    const TrackId track_id = reconstruction_->AddTrack(track);
+    if (num_features > 0) {
+      color /= static_cast<float>(num_features);
+    }
+    track_colors[i] = color.cast<uint8_t>();
+    return true;
+  };
+  if (!ParseRecords(in.position(),
+                    end,
+                    num_tracks,
+                    1,
+                    num_threads_,
+                    read_track,
+                    nullptr)) {
+    LOG(ERROR) << "Could not parse the tracks in " << tracks_filename
+               << ". The tracks must refer to keys of the images in the "
+                  "connected component.";
+    return false;
+  }
+
+  // Add the tracks to the reconstruction.
+  std::unordered_map<ViewId, int> num_observations_per_view;
+  for (const auto& track : tracks) {
+    for (const auto& observation : track) {
+      ++num_observations_per_view[observation.first];
+    }
+  }
+  reconstruction_->ReserveTracks(num_tracks, num_observations_per_view);
+  for (int i = 0; i < num_tracks; i++) {
+    const TrackId track_id = reconstruction_->AddTrack(tracks[i]);
     CHECK_NE(track_id, kInvalidTrackId);
 
     // Set the color of the track.
-    color /= static_cast<float>(track.size());
-    *reconstruction_->MutableTrack(track_id)->MutableColor() =
-        color.cast<uint8_t>();
+    *reconstruction_->MutableTrack(track_id)->MutableColor() = track_colors[i];
   }
 
   return true;
 }
 
-// Reads the epipolar geometry files.
+// Reads the epipolar geometry files. Each line holds the two image indices,
+// the row-major rotation from the second to the first camera and the position
+// of the second camera. The lines are parsed in parallel and the edges are
+// then added to the view graph.
 bool Input1DSFM::ReadEGs() {
   const std::string eg_filename = dataset_directory_ + "/EGs.txt";
-  std::ifstream ifs(eg_filename.c_str(), std::ios::in);
-  if (!ifs.is_open()) {
+  if (!FileExists(eg_filename)) {
     LOG(ERROR) << "Cannot read the EG file from " << eg_filename;
     return false;
   }
+  const MappedFile file(eg_filename);
+  const char* file_begin = file.data();
+  const char* file_end = file.data() + file.size();
+
+  // The tracks of each view in increasing order, so that the common tracks of
+  // two views are counted with a linear merge.
+  const std::vector<ViewId> view_ids = reconstruction_->ViewIds();
+  std::unordered_map<ViewId, std::vector<TrackId> > sorted_track_ids;
+  for (const ViewId view_id : view_ids) {
+    sorted_track_ids[view_id];
+  }
+  ParallelFor(
+      num_threads_, view_ids.size(), [&](const int begin, const int end) {
+        for (int i = begin; i < end; i++) {
+          std::vector<TrackId>& track_ids =
+              FindOrDie(sorted_track_ids, view_ids[i]);
+          track_ids = reconstruction_->View(view_ids[i])->TrackIds();
+          std::sort(track_ids.begin(), track_ids.end());
+        }
+      });
 
   const Eigen::Matrix3d bundler_to_theia =
       Eigen::Vector3d(1.0, -1.0, -1.0).asDiagonal();
-  while (!ifs.eof()) {
-    TwoViewInfo info;
-    ViewId view_id1, view_id2;
-    ifs >> view_id1;
-    ifs >> view_id2;
+  const int num_edges = NumNonEmptyLines(file_begin, file_end);
+  std::vector<ViewIdPair> view_id_pairs(num_edges);
+  std::vector<TwoViewInfo> infos(num_edges);
+  const auto read_edge = [&](TextParser* parser, const int i) {
+    TwoViewInfo& info = infos[i];
+    int view_id1, view_id2;
+    if (!parser->ParseInt(&view_id1) || !parser->ParseInt(&view_id2)) {
+      return false;
+    }
+    view_id_pairs[i] = ViewIdPair(view_id1, view_id2);
 
     // The rotation defines the camera 2 to camera 1 transformation in row-major
     // order). We want a camera 1 to camera 2 transformation so we read in the
     // transpose (i.e., column-major order).
     Eigen::Matrix3d rotation;
-    for (int i = 0; i < 3; i++) {
-      for (int j = 0; j < 3; j++) {
-        ifs >> rotation(i, j);
+    for (int row = 0; row < 3; row++) {
+      for (int col = 0; col < 3; col++) {
+        if (!parser->ParseDouble(&rotation(row, col))) {
+          return false;
+        }
       }
     }
 
+    // Assign the position.
+    if (!parser->ParseDouble(&info.position_2[0]) ||
+        !parser->ParseDouble(&info.position_2[1]) ||
+        !parser->ParseDouble(&info.position_2[2])) {
+      return false;
+    }
+
+    // Edges to images that are not in the connected component are skipped.
+    const View* view1 = reconstruction_->View(view_id1);
+    const View* view2 = reconstruction_->View(view_id2);
+    if (view1 == nullptr || view2 == nullptr) {
+      return true;
+    }
+
     rotation = bundler_to_theia * rotation.transpose() * bundler_to_theia;
 
     // Convert to angle axis.
     ceres::RotationMatrixToAngleAxis(rotation.data(), info.rotation_2.data());
 
-    // Assign the position.
-    ifs >> info.position_2[0];
-    ifs >> info.position_2[1];
-    ifs >> info.position_2[2];
-
     info.position_2 = bundler_to_theia * info.position_2;
 
     // Add the focal lengths. If they are known from EXIF, add that value
     // otherwise add a focal length guess correspdonding to a median viewing
     // angle.
-    const CameraIntrinsicsPrior prior1 =
-        reconstruction_->View(view_id1)->CameraIntrinsicsPrior();
-    const CameraIntrinsicsPrior prior2 =
-        reconstruction_->View(view_id2)->CameraIntrinsicsPrior();
+    const CameraIntrinsicsPrior& prior1 = view1->CameraIntrinsicsPrior();
+    const CameraIntrinsicsPrior& prior2 = view2->CameraIntrinsicsPrior();
     if (prior1.focal_length.is_set) {
       info.focal_length_1 = prior1.focal_length.value[0];
     } else {
@@ -356,19 +499,34 @@ bool Input1DSFM::ReadEGs() {
     }
 
     // Add the number of inliers.
-    const std::vector<ViewId> views = {view_id1, view_id2};
-    const std::vector<TrackId> common_tracks =
-        FindCommonTracksInViews(*reconstruction_, views);
-    info.num_verified_matches = common_tracks.size();
+    const int num_common_tracks =
+        NumCommonTracks(FindOrDie(sorted_track_ids, view_id1),
+                        FindOrDie(sorted_track_ids, view_id2));
+    info.num_verified_matches = num_common_tracks;
     // We set the visibility score to be the number of common tracks since we do
     // not have knowledge about the image sizes and therefore cannot compute the
     // visibility score using the VisibilityPyramid.
-    info.visibility_score = common_tracks.size();
+    info.visibility_score = num_common_tracks;
+    return true;
+  };
+  if (!ParseRecords(file_begin,
+                    file_end,
+                    num_edges,
+                    1,
+                    num_threads_,
+                    read_edge,
+                    nullptr)) {
+    LOG(ERROR) << "Could not parse the epipolar geometries in " << eg_filename;
+    return false;
+  }
 
-    // Add the match to the output.
+  // Add the matches to the output.
+  for (int i = 0; i < num_edges; i++) {
+    const ViewId view_id1 = view_id_pairs[i].first;
+    const ViewId view_id2 = view_id_pairs[i].second;
     if (reconstruction_->View(view_id1) != nullptr &&
         reconstruction_->View(view_id2) != nullptr) {
-      view_graph_->AddEdge(view_id1, view_id2, info);
+      view_graph_->AddEdge(view_id1, view_id2, infos[i]);
     }
   }
   return true;
@@ -376,11 +534,13 @@ bool Input1DSFM::ReadEGs() {
 
 bool Read1DSFM(const std::string& dataset_directory,
                Reconstruction* reconstruction,
-               ViewGraph* view_graph) {
+               ViewGraph* view_graph,
+               const int num_threads) {
   CHECK_NOTNULL(reconstruction);
   CHECK_NOTNULL(view_graph);
 
-  Input1DSFM input_reader(dataset_directory, reconstruction, view_graph);
+  Input1DSFM input_reader(
+      dataset_directory, num_threads, reconstruction, view_graph);
 
   LOG(INFO) << "Reading connected components.";
   std::unordered_set<int> valid_images;
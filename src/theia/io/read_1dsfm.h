@@ -62,11 +62,15 @@ class ViewGraph;
 // exactly correspond to the input data. These objects may then be passed to the
 // ReconstructionEstimator to estimate global poses and triangulate 3D points.
 //
+// The large coords, tracks and EGs files are memory mapped and parsed with
+// num_threads threads.
+//
 // Returns true on success, and false if one or more of the input files could
-// not be found.
+// not be found or parsed.
 bool Read1DSFM(const std::string& dataset_directory,
                Reconstruction* reconstruction,
-               ViewGraph* view_graph);
+               ViewGraph* view_graph,
+               const int num_threads = 1);
 
 }  // namespace theia
 
@@ -0,0 +1,154 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#include <Eigen/Core>
+
+#include <fstream>  // NOLINT
+#include <string>
+
+#include "gtest/gtest.h"
+
+#include "theia/io/read_1dsfm.h"
+#include "theia/sfm/reconstruction.h"
+#include "theia/sfm/track.h"
+#include "theia/sfm/twoview_info.h"
+#include "theia/sfm/view.h"
+#include "theia/sfm/view_graph/view_graph.h"
+#include "theia/util/filesystem.h"
+
+namespace theia {
+
+namespace {
+
+static const double kTolerance = 1e-12;
+
+void WriteTestFile(const std::string& directory,
+                   const std::string& name,
+                   const std::string& contents) {
+  std::ofstream ofs(directory + "/" + name);
+  ofs << contents;
+}
+
+// Writes a dataset of three images where the third image is not in the
+// connected component. The images share two tracks.
+std::string WriteDataset(const std::string& name) {
+  const std::string directory = testing::internal::TempDir() + name;
+  if (!DirectoryExists(directory)) {
+    CHECK(CreateNewDirectory(directory));
+  }
+  WriteTestFile(directory, "cc.txt", "0\n1\n");
+  WriteTestFile(directory,
+                "list.txt",
+                "images/a.jpg 0 500\nimages/b.jpg\nimages/c.jpg\n");
+  WriteTestFile(
+      directory,
+      "coords.txt",
+      "#index = 0, name = a.jpg, keys = 2, px = 320.0, py = 240.0, focal = "
+      "500.0\n"
+      "0 10 20 0 0 255 0 0\n"
+      "1 30 40 0 0 0 255 0\n"
+      "#index = 1, name = b.jpg, keys = 2, px = 320.0, py = 240.0, focal = "
+      "0.0\n"
+      "0 11 21 0 0 0 0 255\n"
+      "1 31.5 41.5 0 0 100 100 100\n"
+      "#index = 2, name = c.jpg, keys = 1, px = 320.0, py = 240.0, focal = "
+      "0.0\n"
+      "0 5 5 0 0 0 0 0\n");
+  WriteTestFile(directory, "tracks.txt", "2\n2 0 0 1 0\n2 0 1 1 1\n");
+  WriteTestFile(directory,
+                "EGs.txt",
+                "0 1 1 0 0 0 1 0 0 0 1 0.1 0.2 0.3\n"
+                "0 2 1 0 0 0 1 0 0 0 1 1 0 0\n");
+  return directory;
+}
+
+}  // namespace
+
+TEST(Read1DSFM, ReadDataset) {
+  const std::string directory = WriteDataset("1dsfm");
+  for (const int num_threads : {1, 4}) {
+    Reconstruction reconstruction;
+    ViewGraph view_graph;
+    EXPECT_TRUE(
+        Read1DSFM(directory, &reconstruction, &view_graph, num_threads));
+
+    ASSERT_EQ(reconstruction.NumViews(), 2);
+    const View* view_a = reconstruction.View(0);
+    const View* view_b = reconstruction.View(1);
+    ASSERT_TRUE(view_a != nullptr);
+    ASSERT_TRUE(view_b != nullptr);
+    EXPECT_EQ(view_a->Name(), "a.jpg");
+    EXPECT_EQ(view_a->CameraIntrinsicsPrior().focal_length.value[0], 500.0);
+    EXPECT_EQ(view_b->CameraIntrinsicsPrior().principal_point.value[0], 320.0);
+
+    ASSERT_EQ(reconstruction.NumTracks(), 2);
+    for (const TrackId track_id : reconstruction.TrackIds()) {
+      const Track* track = reconstruction.Track(track_id);
+      ASSERT_EQ(track->NumViews(), 2);
+      const Feature* feature = view_b->GetFeature(track_id);
+      ASSERT_TRUE(feature != nullptr);
+      if (feature->x() == 31.5) {
+        EXPECT_EQ(feature->y(), 41.5);
+        // The mean of the colors of the features.
+        EXPECT_EQ(track->Color()[0], 50);
+        EXPECT_EQ(track->Color()[1], 177);
+        EXPECT_EQ(track->Color()[2], 50);
+      } else {
+        EXPECT_EQ(feature->x(), 11.0);
+      }
+    }
+
+    // The edge to the image that is not in the connected component is skipped.
+    ASSERT_EQ(view_graph.NumEdges(), 1);
+    const TwoViewInfo* info = view_graph.GetEdge(0, 1);
+    ASSERT_TRUE(info != nullptr);
+    EXPECT_EQ(info->num_verified_matches, 2);
+    EXPECT_EQ(info->focal_length_1, 500.0);
+    EXPECT_EQ(info->focal_length_2, 1.2 * 320.0);
+    EXPECT_LT(info->rotation_2.norm(), kTolerance);
+    EXPECT_TRUE(info->position_2.isApprox(Eigen::Vector3d(0.1, -0.2, -0.3),
+                                          kTolerance));
+  }
+}
+
+TEST(Read1DSFM, InvalidTracks) {
+  const std::string directory = WriteDataset("1dsfm_invalid");
+  // The track refers to a key that does not exist.
+  WriteTestFile(directory, "tracks.txt", "1\n2 0 0 1 5\n");
+  Reconstruction reconstruction;
+  ViewGraph view_graph;
+  EXPECT_FALSE(Read1DSFM(directory, &reconstruction, &view_graph, 4));
+}
+
+}  // namespace theia
@@ -0,0 +1,155 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#include "theia/io/read_bal_file.h"
+
+#include <Eigen/Core>
+#include <glog/logging.h>
+
+#include <fstream>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "theia/sfm/camera/camera.h"
+#include "theia/sfm/camera/pinhole_camera_model.h"
+#include "theia/sfm/feature.h"
+#include "theia/sfm/reconstruction.h"
+#include "theia/sfm/track.h"
+#include "theia/sfm/types.h"
+#include "theia/sfm/view.h"
+#include "theia/util/map_util.h"
+#include "theia/util/stringprintf.h"
+
+namespace theia {
+
+bool ReadBalFile(const std::string& bal_file, Reconstruction* reconstruction) {
+  CHECK_NOTNULL(reconstruction);
+
+  std::ifstream ifs(bal_file.c_str(), std::ios::in);
+  if (!ifs.is_open()) {
+    LOG(ERROR) << "Cannot read the BAL file from " << bal_file;
+    return false;
+  }
+
+  int num_cameras, num_points, num_observations;
+  if (!(ifs >> num_cameras >> num_points >> num_observations) ||
+      num_cameras < 0 || num_points < 0 || num_observations < 0) {
+    LOG(ERROR) << "Invalid header in the BAL file " << bal_file;
+    return false;
+  }
+
+  // The observations are grouped by point. The y axis is flipped into the
+  // image coordinates of Theia.
+  std::vector<std::vector<std::pair<int, Feature> > > point_observations(
+      num_points);
+  for (int i = 0; i < num_observations; i++) {
+    int camera_index, point_index;
+    double x, y;
+    if (!(ifs >> camera_index >> point_index >> x >> y) || camera_index < 0 ||
+        camera_index >= num_cameras || point_index < 0 ||
+        point_index >= num_points) {
+      LOG(ERROR) << "Invalid observation " << i << " in the BAL file "
+                 << bal_file;
+      return false;
+    }
+    point_observations[point_index].emplace_back(
+        camera_index, Feature(Eigen::Vector2d(x, -y)));
+  }
+
+  // Rotating the BAL camera frame by 180 degrees around the x axis makes the
+  // camera look down the positive z axis, which negates the y image axis.
+  const Eigen::Vector3d flip(1.0, -1.0, -1.0);
+  std::vector<ViewId> view_ids(num_cameras);
+  for (int i = 0; i < num_cameras; i++) {
+    double parameters[9];
+    for (int j = 0; j < 9; j++) {
+      if (!(ifs >> parameters[j])) {
+        LOG(ERROR) << "Invalid camera " << i << " in the BAL file " << bal_file;
+        return false;
+      }
+    }
+
+    view_ids[i] = reconstruction->AddView(StringPrintf("%d", i), i);
+    CHECK_NE(view_ids[i], kInvalidViewId);
+    View* view = reconstruction->MutableView(view_ids[i]);
+    view->SetEstimated(true);
+
+    Camera* camera = view->MutableCamera();
+    camera->SetCameraIntrinsicsModelType(CameraIntrinsicsModelType::PINHOLE);
+    camera->SetFocalLength(parameters[6]);
+    camera->SetPrincipalPoint(0.0, 0.0);
+    camera->mutable_intrinsics()[PinholeCameraModel::RADIAL_DISTORTION_1] =
+        parameters[7];
+    camera->mutable_intrinsics()[PinholeCameraModel::RADIAL_DISTORTION_2] =
+        parameters[8];
+
+    camera->SetOrientationFromAngleAxis(
+        Eigen::Map<const Eigen::Vector3d>(parameters));
+    const Eigen::Matrix3d bal_rotation =
+        camera->GetOrientationAsRotationMatrix();
+    camera->SetOrientationFromRotationMatrix(flip.asDiagonal() * bal_rotation);
+    // The camera center is the same in both frames.
+    camera->SetPosition(-bal_rotation.transpose() *
+                        Eigen::Map<const Eigen::Vector3d>(parameters + 3));
+  }
+
+  for (int i = 0; i < num_points; i++) {
+    Eigen::Vector3d point;
+    if (!(ifs >> point[0] >> point[1] >> point[2])) {
+      LOG(ERROR) << "Invalid point " << i << " in the BAL file " << bal_file;
+      return false;
+    }
+
+    std::vector<std::pair<ViewId, Feature> > features;
+    features.reserve(point_observations[i].size());
+    for (const auto& observation : point_observations[i]) {
+      features.emplace_back(view_ids[observation.first], observation.second);
+    }
+    const TrackId track_id = reconstruction->AddTrack(features);
+    if (track_id == kInvalidTrackId) {
+      LOG(WARNING) << "Could not add point " << i << " of the BAL file "
+                   << bal_file;
+      continue;
+    }
+    Track* track = reconstruction->MutableTrack(track_id);
+    track->SetEstimated(true);
+    *track->MutablePoint() = point.homogeneous();
+  }
+
+  return true;
+}
+
+}  // namespace theia
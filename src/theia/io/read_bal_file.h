@@ -0,0 +1,60 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#ifndef THEIA_IO_READ_BAL_FILE_H_
+#define THEIA_IO_READ_BAL_FILE_H_
+
+#include <string>
+
+namespace theia {
+
+class Reconstruction;
+
+// Reads a problem of the Bundle Adjustment in the Large dataset
+// (http://grail.cs.washington.edu/projects/bal/) into a reconstruction. The
+// (uncompressed) text file contains the number of cameras, points and
+// observations, followed by the observations as "camera point x y", the 9
+// parameters of each camera (angle-axis rotation, translation, focal length and
+// two radial distortion coefficients) and the 3 coordinates of each point.
+//
+// BAL cameras look down the negative z axis and the image y axis points up.
+// Each camera is converted to a view with its own PINHOLE intrinsics (principal
+// point at the origin) such that the reprojection errors of the reconstruction
+// are the same as those of the BAL problem. Returns false if the file could not
+// be read.
+bool ReadBalFile(const std::string& bal_file, Reconstruction* reconstruction);
+
+}  // namespace theia
+
+#endif  // THEIA_IO_READ_BAL_FILE_H_
@@ -0,0 +1,138 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#include <Eigen/Core>
+#include <Eigen/Geometry>
+#include <glog/logging.h>
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+
+#include "gtest/gtest.h"
+
+#include "theia/io/read_bal_file.h"
+#include "theia/sfm/camera/camera.h"
+#include "theia/sfm/reconstruction.h"
+#include "theia/sfm/track.h"
+#include "theia/sfm/view.h"
+
+namespace theia {
+
+namespace {
+
+const std::string bal_filepath =
+    THEIA_DATA_DIR + std::string("/io/read_bal_file_test.txt");
+
+// Projects a point with the BAL camera model.
+Eigen::Vector2d ProjectBal(const Eigen::Vector3d& angle_axis,
+                           const Eigen::Vector3d& translation,
+                           const double focal_length,
+                           const double k1,
+                           const double k2,
+                           const Eigen::Vector3d& point) {
+  const Eigen::Vector3d point_in_camera =
+      Eigen::AngleAxisd(angle_axis.norm(), angle_axis.normalized()) * point +
+      translation;
+  const Eigen::Vector2d p = -point_in_camera.hnormalized();
+  const double r_sq = p.squaredNorm();
+  return focal_length * (1.0 + k1 * r_sq + k2 * r_sq * r_sq) * p;
+}
+
+}  // namespace
+
+TEST(ReadBalFile, ReprojectionsMatchBalCameraModel) {
+  const Eigen::Vector3d angle_axis[2] = {Eigen::Vector3d(0.1, -0.2, 0.05),
+                                         Eigen::Vector3d(-0.05, 0.3, 0.1)};
+  const Eigen::Vector3d translation[2] = {Eigen::Vector3d(0.2, 0.1, -0.3),
+                                          Eigen::Vector3d(-0.4, 0.0, 0.2)};
+  const double focal_length[2] = {500.0, 650.0};
+  const double k1[2] = {-0.1, 0.05};
+  const double k2[2] = {0.01, -0.02};
+  // Points in front of BAL cameras have a negative depth.
+  const Eigen::Vector3d points[2] = {Eigen::Vector3d(0.3, -0.2, -4.0),
+                                     Eigen::Vector3d(-0.5, 0.4, -5.0)};
+
+  Eigen::Vector2d observations[2][2];
+  {
+    std::ofstream ofs(bal_filepath.c_str());
+    ofs.precision(17);
+    ofs << "2 2 4\n";
+    for (int p = 0; p < 2; p++) {
+      for (int c = 0; c < 2; c++) {
+        observations[c][p] = ProjectBal(angle_axis[c],
+                                        translation[c],
+                                        focal_length[c],
+                                        k1[c],
+                                        k2[c],
+                                        points[p]);
+        ofs << c << " " << p << " " << observations[c][p].x() << " "
+            << observations[c][p].y() << "\n";
+      }
+    }
+    for (int c = 0; c < 2; c++) {
+      ofs << angle_axis[c].transpose() << " " << translation[c].transpose()
+          << " " << focal_length[c] << " " << k1[c] << " " << k2[c] << "\n";
+    }
+    for (int p = 0; p < 2; p++) {
+      ofs << points[p].transpose() << "\n";
+    }
+  }
+
+  Reconstruction reconstruction;
+  ASSERT_TRUE(ReadBalFile(bal_filepath, &reconstruction));
+  std::remove(bal_filepath.c_str());
+  ASSERT_EQ(reconstruction.NumViews(), 2);
+  ASSERT_EQ(reconstruction.NumTracks(), 2);
+
+  for (const TrackId track_id : reconstruction.TrackIds()) {
+    const Track* track = reconstruction.Track(track_id);
+    EXPECT_TRUE(track->IsEstimated());
+    for (const ViewId view_id : track->ViewIds()) {
+      const View* view = reconstruction.View(view_id);
+      const Feature* feature = view->GetFeature(track_id);
+      Eigen::Vector2d reprojection;
+      EXPECT_GT(view->Camera().ProjectPoint(track->Point(), &reprojection),
+                0.0);
+      EXPECT_LT((reprojection - feature->point_).norm(), 1e-4);
+    }
+  }
+}
+
+TEST(ReadBalFile, MissingFile) {
+  Reconstruction reconstruction;
+  EXPECT_FALSE(ReadBalFile(bal_filepath + ".missing", &reconstruction));
+}
+
+}  // namespace theia
@@ -42,6 +42,8 @@
 #include <fstream>   // NOLINT
 #include <iostream>  // NOLINT
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 
@@ -149,8 +151,18 @@ int AddTracksToReconstruction(const BundlerFileReader& reader,
   int num_invalid_tracks = 0;
   const int num_points = reader.NumPoints();
   const std::vector<BundlerPoint>& points = reader.points();
+
+  // Allocate the tracks and the features of each view at once.
+  std::unordered_map<ViewId, int> num_observations_per_view;
+  for (const BundlerPoint& point : points) {
+    for (const FeatureInfo& feature_info : point.view_list) {
+      ++num_observations_per_view[feature_info.camera_index];
+    }
+  }
+  reconstruction->ReserveTracks(num_points, num_observations_per_view);
+
   for (int i = 0; i < num_points; i++) {
-    const BundlerPoint point = points[i];
+    const BundlerPoint& point = points[i];
     const Eigen::Vector3d& position = point.position;
     const Eigen::Vector3d& color = point.color;
     const int num_views = point.view_list.size();
@@ -240,7 +252,8 @@ int AddTracksToReconstruction(const BundlerFileReader& reader,
 // width and height of the image).
 bool ReadBundlerFiles(const std::string& lists_file,
                       const std::string& bundle_file,
-                      Reconstruction* reconstruction) {
+                      Reconstruction* reconstruction,
+                      const int num_threads) {
   CHECK_EQ(reconstruction->NumViews(), 0)
       << "An empty reconstruction must be provided to load a bundler dataset.";
   CHECK_EQ(reconstruction->NumTracks(), 0)
@@ -255,7 +268,7 @@ bool ReadBundlerFiles(const std::string& lists_file,
   }
 
   VLOG(1) << "Parsing bundler file: " << bundle_file;
-  if (!bundler_file_reader.ParseBundleFile()) {
+  if (!bundler_file_reader.ParseBundleFile(num_threads)) {
     LOG(ERROR) << "Could not parse the bundler file from " << bundle_file;
     return false;
   }
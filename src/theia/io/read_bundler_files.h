@@ -57,9 +57,11 @@ class Reconstruction;
 //   reconstruction: A Theia Reconstruction containing the camera, track, and
 //       point cloud information. See theia/sfm/reconstruction.h for more
 //       information.
+//   num_threads: the number of threads used to parse the 3D points.
 bool ReadBundlerFiles(const std::string& lists_file,
                       const std::string& bundle_file,
-                      Reconstruction* reconstruction);
+                      Reconstruction* reconstruction,
+                      const int num_threads = 1);
 
 }  // namespace theia
 
@@ -0,0 +1,166 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#include <Eigen/Core>
+
+#include <fstream>  // NOLINT
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "theia/io/read_bundler_files.h"
+#include "theia/sfm/camera/camera.h"
+#include "theia/sfm/reconstruction.h"
+#include "theia/sfm/track.h"
+#include "theia/sfm/view.h"
+
+namespace theia {
+
+namespace {
+
+static const double kTolerance = 1e-12;
+
+static const char kListsFile[] = "images/a.jpg 0 500.0\nimages/b.jpg\n";
+
+// Two cameras and two points. The cameras have no rotation and the second
+// camera has the translation (1, 2, 3).
+static const char kBundleFile[] =
+    "# Bundle file v0.3\n"
+    "2 2\n"
+    "500 0 0\n"
+    "1 0 0\n"
+    "0 1 0\n"
+    "0 0 1\n"
+    "0 0 0\n"
+    "600 0.1 0.01\n"
+    "1 0 0\n"
+    "0 1 0\n"
+    "0 0 1\n"
+    "1 2 3\n"
+    "1 2 3\n"
+    "255 128 0\n"
+    "2 0 5 10.0 20.0 1 6 -30.0 40.0\n"
+    "-1 -2 -3\n"
+    "0 0 0\n"
+    "2 0 7 1 2 1 8 3 4\n";
+
+std::string WriteTestFile(const std::string& name,
+                          const std::string& contents) {
+  const std::string filepath = testing::internal::TempDir() + name;
+  std::ofstream ofs(filepath);
+  ofs << contents;
+  return filepath;
+}
+
+void ExpectReconstruction(const Reconstruction& reconstruction) {
+  ASSERT_EQ(reconstruction.NumViews(), 2);
+  const ViewId view_a = reconstruction.ViewIdFromName("a.jpg");
+  const ViewId view_b = reconstruction.ViewIdFromName("b.jpg");
+  ASSERT_NE(view_a, kInvalidViewId);
+  ASSERT_NE(view_b, kInvalidViewId);
+  EXPECT_EQ(reconstruction.View(view_a)->Camera().FocalLength(), 500.0);
+  EXPECT_EQ(reconstruction.View(view_b)->Camera().FocalLength(), 600.0);
+  EXPECT_TRUE(reconstruction.View(view_a)
+                  ->CameraIntrinsicsPrior()
+                  .focal_length.is_set);
+  EXPECT_FALSE(reconstruction.View(view_b)
+                   ->CameraIntrinsicsPrior()
+                   .focal_length.is_set);
+  EXPECT_TRUE(reconstruction.View(view_b)->Camera().GetPosition().isApprox(
+      Eigen::Vector3d(-1.0, -2.0, -3.0), kTolerance));
+
+  ASSERT_EQ(reconstruction.NumTracks(), 2);
+  for (const TrackId track_id : reconstruction.TrackIds()) {
+    const Track* track = reconstruction.Track(track_id);
+    EXPECT_TRUE(track->IsEstimated());
+    EXPECT_EQ(track->NumViews(), 2);
+    if (track->Point().x() == 1.0) {
+      EXPECT_TRUE(track->Point() == Eigen::Vector4d(1.0, 2.0, 3.0, 1.0));
+      EXPECT_EQ(track->Color()[1], 128);
+      // The y axis of the features is flipped.
+      const Feature* feature =
+          reconstruction.View(view_b)->GetFeature(track_id);
+      ASSERT_TRUE(feature != nullptr);
+      EXPECT_EQ(feature->x(), -30.0);
+      EXPECT_EQ(feature->y(), -40.0);
+    }
+  }
+}
+
+}  // namespace
+
+TEST(ReadBundlerFiles, ReadFiles) {
+  const std::string lists_file = WriteTestFile("list.txt", kListsFile);
+  const std::string bundle_file = WriteTestFile("bundle.out", kBundleFile);
+  for (const int num_threads : {1, 4}) {
+    Reconstruction reconstruction;
+    EXPECT_TRUE(ReadBundlerFiles(
+        lists_file, bundle_file, &reconstruction, num_threads));
+    ExpectReconstruction(reconstruction);
+  }
+}
+
+TEST(ReadBundlerFiles, PointsWithLineBreaks) {
+  // The view lists of the points are split over several lines, so the points
+  // cannot be split at lines for parallel parsing.
+  std::string contents = kBundleFile;
+  for (int i = 0; i < contents.size(); i++) {
+    if (contents.compare(i, 7, "10.0 20") == 0 ||
+        contents.compare(i, 3, "1 8") == 0) {
+      contents[i - 1] = '\n';
+    }
+  }
+  const std::string lists_file = WriteTestFile("list.txt", kListsFile);
+  const std::string bundle_file = WriteTestFile("wrapped.out", contents);
+  Reconstruction reconstruction;
+  EXPECT_TRUE(ReadBundlerFiles(lists_file, bundle_file, &reconstruction, 4));
+  ExpectReconstruction(reconstruction);
+}
+
+TEST(ReadBundlerFiles, InvalidFiles) {
+  const std::string lists_file = WriteTestFile("list.txt", kListsFile);
+  Reconstruction reconstruction;
+  EXPECT_FALSE(ReadBundlerFiles(lists_file,
+                                testing::internal::TempDir() + "missing.out",
+                                &reconstruction));
+
+  // The file ends before the last point.
+  std::string contents = kBundleFile;
+  contents.resize(contents.size() - 10);
+  const std::string bundle_file = WriteTestFile("truncated.out", contents);
+  EXPECT_FALSE(ReadBundlerFiles(lists_file, bundle_file, &reconstruction, 4));
+}
+
+}  // namespace theia
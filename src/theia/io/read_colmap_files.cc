@@ -0,0 +1,324 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#include "theia/io/read_colmap_files.h"
+
+#include <Eigen/Core>
+#include <Eigen/Geometry>
+#include <glog/logging.h>
+
+#include <cstring>
+#include <limits>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "theia/io/colmap_camera_models.h"
+#include "theia/sfm/camera/camera.h"
+#include "theia/sfm/feature.h"
+#include "theia/sfm/reconstruction.h"
+#include "theia/sfm/track.h"
+#include "theia/sfm/types.h"
+#include "theia/sfm/view.h"
+#include "theia/util/filesystem.h"
+#include "theia/util/map_util.h"
+#include "theia/util/mapped_file.h"
+
+namespace theia {
+
+namespace {
+
+// COLMAP marks the 2D points that do not belong to a 3D point with this id.
+static const uint64_t kInvalidColmapPoint3DId =
+    std::numeric_limits<uint64_t>::max();
+
+// Reads values from a memory mapped binary file in the byte order of the
+// machine. COLMAP binary files are little-endian.
+class BinaryFileReader {
+ public:
+  explicit BinaryFileReader(const std::string& filepath)
+      : file_(filepath), position_(0) {}
+
+  template <typename T>
+  bool Read(T* value) {
+    if (file_.size() - position_ < sizeof(*value)) {
+      return false;
+    }
+    memcpy(value, file_.data() + position_, sizeof(*value));
+    position_ += sizeof(*value);
+    return true;
+  }
+
+  // Reads a null-terminated string.
+  bool ReadString(std::string* value) {
+    const char* begin = file_.data() + position_;
+    const char* end = static_cast<const char*>(
+        memchr(begin, '\0', file_.size() - position_));
+    if (end == nullptr) {
+      return false;
+    }
+    value->assign(begin, end);
+    position_ += end - begin + 1;
+    return true;
+  }
+
+ private:
+  const MappedFile file_;
+  uint64_t position_;
+};
+
+struct ColmapCamera {
+  int model_id;
+  uint64_t width;
+  uint64_t height;
+  std::vector<double> parameters;
+  // The first view with this camera, which determines the intrinsics group of
+  // the other views.
+  ViewId view_id = kInvalidViewId;
+};
+
+struct ColmapImage {
+  ViewId view_id;
+  std::vector<Eigen::Vector2d> points;
+};
+
+bool ReadCameras(const std::string& cameras_file,
+                 std::unordered_map<uint32_t, ColmapCamera>* cameras) {
+  BinaryFileReader reader(cameras_file);
+  uint64_t num_cameras;
+  if (!reader.Read(&num_cameras)) {
+    return false;
+  }
+  for (uint64_t i = 0; i < num_cameras; i++) {
+    uint32_t camera_id;
+    int32_t model_id;
+    ColmapCamera camera;
+    if (!reader.Read(&camera_id) || !reader.Read(&model_id) ||
+        !reader.Read(&camera.width) || !reader.Read(&camera.height)) {
+      return false;
+    }
+    camera.model_id = model_id;
+    const int num_parameters = NumColmapCameraParameters(model_id);
+    if (num_parameters < 0) {
+      LOG(ERROR) << "Unknown COLMAP camera model " << model_id;
+      return false;
+    }
+    camera.parameters.resize(num_parameters);
+    for (double& parameter : camera.parameters) {
+      if (!reader.Read(&parameter)) {
+        return false;
+      }
+    }
+    (*cameras)[camera_id] = camera;
+  }
+  return true;
+}
+
+bool ReadImages(const std::string& images_file,
+                std::unordered_map<uint32_t, ColmapCamera>* cameras,
+                std::unordered_map<uint32_t, ColmapImage>* images,
+                std::unordered_map<ViewId, int>* num_observations_per_view,
+                Reconstruction* reconstruction) {
+  BinaryFileReader reader(images_file);
+  uint64_t num_images;
+  if (!reader.Read(&num_images)) {
+    return false;
+  }
+  for (uint64_t i = 0; i < num_images; i++) {
+    uint32_t image_id;
+    double orientation[4];
+    double translation[3];
+    uint32_t camera_id;
+    std::string name;
+    uint64_t num_points;
+    if (!reader.Read(&image_id) || !reader.Read(&orientation) ||
+        !reader.Read(&translation) || !reader.Read(&camera_id) ||
+        !reader.ReadString(&name) || !reader.Read(&num_points)) {
+      return false;
+    }
+
+    ColmapCamera* colmap_camera = FindOrNull(*cameras, camera_id);
+    if (colmap_camera == nullptr) {
+      LOG(ERROR) << "The image " << name << " has the unknown camera "
+                 << camera_id;
+      return false;
+    }
+
+    // Views with the same COLMAP camera share their intrinsics.
+    const bool is_first_view_of_camera =
+        colmap_camera->view_id == kInvalidViewId;
+    const ViewId view_id =
+        is_first_view_of_camera
+            ? reconstruction->AddView(name, i)
+            : reconstruction->AddView(
+                  name,
+                  reconstruction->CameraIntrinsicsGroupIdFromViewId(
+                      colmap_camera->view_id),
+                  i);
+    if (view_id == kInvalidViewId) {
+      LOG(ERROR) << "Could not add the image " << name
+                 << " to the reconstruction.";
+      return false;
+    }
+
+    View* view = reconstruction->MutableView(view_id);
+    view->SetEstimated(true);
+    Camera* camera = view->MutableCamera();
+    if (is_first_view_of_camera) {
+      colmap_camera->view_id = view_id;
+      if (!CameraFromColmapCamera(
+              colmap_camera->model_id, colmap_camera->parameters, camera)) {
+        return false;
+      }
+    }
+    camera->SetImageSize(colmap_camera->width, colmap_camera->height);
+    const Eigen::Matrix3d rotation =
+        Eigen::Quaterniond(
+            orientation[0], orientation[1], orientation[2], orientation[3])
+            .normalized()
+            .toRotationMatrix();
+    camera->SetOrientationFromRotationMatrix(rotation);
+    camera->SetPosition(-rotation.transpose() *
+                        Eigen::Map<const Eigen::Vector3d>(translation));
+
+    ColmapImage& image = (*images)[image_id];
+    image.view_id = view_id;
+    image.points.resize(num_points);
+    int num_observations = 0;
+    for (Eigen::Vector2d& point : image.points) {
+      uint64_t point3D_id;
+      if (!reader.Read(&point.x()) || !reader.Read(&point.y()) ||
+          !reader.Read(&point3D_id)) {
+        return false;
+      }
+      if (point3D_id != kInvalidColmapPoint3DId) {
+        ++num_observations;
+      }
+    }
+    (*num_observations_per_view)[view_id] = num_observations;
+  }
+  return true;
+}
+
+bool ReadPoints(
+    const std::string& points_file,
+    const std::unordered_map<uint32_t, ColmapImage>& images,
+    const std::unordered_map<ViewId, int>& num_observations_per_view,
+    Reconstruction* reconstruction) {
+  BinaryFileReader reader(points_file);
+  uint64_t num_points;
+  if (!reader.Read(&num_points)) {
+    return false;
+  }
+  reconstruction->ReserveTracks(num_points, num_observations_per_view);
+  for (uint64_t i = 0; i < num_points; i++) {
+    uint64_t point3D_id;
+    Eigen::Vector3d point;
+    Eigen::Matrix<uint8_t, 3, 1> color;
+    double error;
+    uint64_t track_length;
+    if (!reader.Read(&point3D_id) || !reader.Read(&point.x()) ||
+        !reader.Read(&point.y()) || !reader.Read(&point.z()) ||
+        !reader.Read(&color[0]) || !reader.Read(&color[1]) ||
+        !reader.Read(&color[2]) || !reader.Read(&error) ||
+        !reader.Read(&track_length)) {
+      return false;
+    }
+
+    const TrackId track_id = reconstruction->AddTrack();
+    for (uint64_t j = 0; j < track_length; j++) {
+      uint32_t image_id;
+      uint32_t point2D_index;
+      if (!reader.Read(&image_id) || !reader.Read(&point2D_index)) {
+        return false;
+      }
+      const ColmapImage* image = FindOrNull(images, image_id);
+      if (image == nullptr || point2D_index >= image->points.size()) {
+        LOG(ERROR) << "The point " << point3D_id
+                   << " has an invalid observation in image " << image_id;
+        return false;
+      }
+      reconstruction->AddObservation(
+          image->view_id, track_id, Feature(image->points[point2D_index]));
+    }
+
+    Track* track = reconstruction->MutableTrack(track_id);
+    track->SetPoint(point.homogeneous());
+    track->SetColor(color);
+    track->SetEstimated(true);
+  }
+  return true;
+}
+
+}  // namespace
+
+bool ReadColmapBinaryFiles(const std::string& input_directory,
+                           Reconstruction* reconstruction) {
+  CHECK_NOTNULL(reconstruction);
+  const std::string cameras_file = input_directory + "/cameras.bin";
+  const std::string images_file = input_directory + "/images.bin";
+  const std::string points_file = input_directory + "/points3D.bin";
+  for (const std::string& file : {cameras_file, images_file, points_file}) {
+    if (!FileExists(file)) {
+      LOG(ERROR) << "Could not open the file: " << file << " for reading.";
+      return false;
+    }
+  }
+
+  std::unordered_map<uint32_t, ColmapCamera> cameras;
+  if (!ReadCameras(cameras_file, &cameras)) {
+    LOG(ERROR) << "Could not read the COLMAP cameras from " << cameras_file;
+    return false;
+  }
+
+  std::unordered_map<uint32_t, ColmapImage> images;
+  std::unordered_map<ViewId, int> num_observations_per_view;
+  if (!ReadImages(images_file,
+                  &cameras,
+                  &images,
+                  &num_observations_per_view,
+                  reconstruction)) {
+    LOG(ERROR) << "Could not read the COLMAP images from " << images_file;
+    return false;
+  }
+
+  if (!ReadPoints(
+          points_file, images, num_observations_per_view, reconstruction)) {
+    LOG(ERROR) << "Could not read the COLMAP points from " << points_file;
+    return false;
+  }
+  return true;
+}
+
+}  // namespace theia
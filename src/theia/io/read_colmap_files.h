@@ -0,0 +1,56 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#ifndef THEIA_IO_READ_COLMAP_FILES_H_
+#define THEIA_IO_READ_COLMAP_FILES_H_
+
+#include <string>
+
+namespace theia {
+
+class Reconstruction;
+
+// Reads a reconstruction from the COLMAP binary files cameras.bin, images.bin
+// and points3D.bin in the input directory, as written by COLMAP or by
+// WriteColmapBinaryFiles. Each COLMAP camera becomes a camera intrinsics group
+// and all views and tracks are estimated. The 2D points that do not belong to
+// a 3D point are skipped. The ids of the views and tracks are not preserved.
+// Returns false if the files could not be read or if a camera model cannot be
+// represented in Theia (see colmap_camera_models.h).
+bool ReadColmapBinaryFiles(const std::string& input_directory,
+                           Reconstruction* reconstruction);
+
+}  // namespace theia
+
+#endif  // THEIA_IO_READ_COLMAP_FILES_H_
@@ -0,0 +1,318 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#include <Eigen/Core>
+#include <Eigen/Geometry>
+
+#include <fstream>  // NOLINT
+#include <map>
+#include <sstream>  // NOLINT
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "theia/io/read_colmap_files.h"
+#include "theia/io/write_colmap_files.h"
+#include "theia/sfm/camera/camera.h"
+#include "theia/sfm/camera/fisheye_camera_model.h"
+#include "theia/sfm/camera/pinhole_camera_model.h"
+#include "theia/sfm/camera/pinhole_radial_tangential_camera_model.h"
+#include "theia/sfm/reconstruction.h"
+#include "theia/sfm/track.h"
+#include "theia/sfm/view.h"
+#include "theia/util/random.h"
+#include "theia/util/stringprintf.h"
+
+namespace theia {
+
+namespace {
+
+static const int kNumTracks = 200;
+static const double kTolerance = 1e-12;
+
+typedef std::tuple<double, double, double> PointKey;
+
+std::string TestDirectory() { return testing::internal::TempDir(); }
+
+// Builds a reconstruction with two pinhole views that share their intrinsics,
+// a pinhole view with an aspect ratio, a pinhole radial tangential view, a
+// fisheye view and a view that is not estimated.
+void BuildReconstruction(Reconstruction* reconstruction) {
+  RandomNumberGenerator rng(61);
+  const ViewId view_0 = reconstruction->AddView("view_0.jpg", 0);
+  reconstruction->AddView(
+      "view_1.jpg",
+      reconstruction->CameraIntrinsicsGroupIdFromViewId(view_0),
+      1);
+  reconstruction->AddView("view_2.jpg", 2);
+  reconstruction->AddView("view_3.jpg", 3);
+  reconstruction->AddView("view_4.jpg", 4);
+  reconstruction->AddView("view_5.jpg", 5);
+
+  for (const ViewId view_id : reconstruction->ViewIds()) {
+    View* view = reconstruction->MutableView(view_id);
+    view->SetEstimated(view->Name() != "view_5.jpg");
+    Camera* camera = view->MutableCamera();
+    camera->SetPosition(rng.RandVector3d());
+    camera->SetOrientationFromAngleAxis(0.2 * rng.RandVector3d());
+    camera->SetImageSize(640, 480);
+  }
+
+  Camera* camera = reconstruction->MutableView(view_0)->MutableCamera();
+  double* intrinsics = camera->mutable_intrinsics();
+  intrinsics[PinholeCameraModel::FOCAL_LENGTH] = 500.0;
+  intrinsics[PinholeCameraModel::PRINCIPAL_POINT_X] = 320.0;
+  intrinsics[PinholeCameraModel::PRINCIPAL_POINT_Y] = 240.0;
+  intrinsics[PinholeCameraModel::RADIAL_DISTORTION_1] = -0.1;
+  intrinsics[PinholeCameraModel::RADIAL_DISTORTION_2] = 0.01;
+
+  camera = reconstruction->MutableView(2)->MutableCamera();
+  intrinsics = camera->mutable_intrinsics();
+  intrinsics[PinholeCameraModel::FOCAL_LENGTH] = 600.0;
+  intrinsics[PinholeCameraModel::ASPECT_RATIO] = 1.25;
+  intrinsics[PinholeCameraModel::PRINCIPAL_POINT_X] = 330.0;
+  intrinsics[PinholeCameraModel::PRINCIPAL_POINT_Y] = 250.0;
+
+  camera = reconstruction->MutableView(3)->MutableCamera();
+  camera->SetCameraIntrinsicsModelType(
+      CameraIntrinsicsModelType::PINHOLE_RADIAL_TANGENTIAL);
+  intrinsics = camera->mutable_intrinsics();
+  intrinsics[PinholeRadialTangentialCameraModel::FOCAL_LENGTH] = 700.0;
+  intrinsics[PinholeRadialTangentialCameraModel::ASPECT_RATIO] = 1.1;
+  intrinsics[PinholeRadialTangentialCameraModel::PRINCIPAL_POINT_X] = 310.0;
+  intrinsics[PinholeRadialTangentialCameraModel::PRINCIPAL_POINT_Y] = 230.0;
+  intrinsics[PinholeRadialTangentialCameraModel::RADIAL_DISTORTION_1] = 0.1;
+  intrinsics[PinholeRadialTangentialCameraModel::RADIAL_DISTORTION_2] = 0.02;
+  intrinsics[PinholeRadialTangentialCameraModel::RADIAL_DISTORTION_3] = 0.003;
+  intrinsics[PinholeRadialTangentialCameraModel::TANGENTIAL_DISTORTION_1] =
+      0.001;
+  intrinsics[PinholeRadialTangentialCameraModel::TANGENTIAL_DISTORTION_2] =
+      0.002;
+
+  camera = reconstruction->MutableView(4)->MutableCamera();
+  camera->SetCameraIntrinsicsModelType(CameraIntrinsicsModelType::FISHEYE);
+  intrinsics = camera->mutable_intrinsics();
+  intrinsics[FisheyeCameraModel::FOCAL_LENGTH] = 300.0;
+  intrinsics[FisheyeCameraModel::PRINCIPAL_POINT_X] = 320.0;
+  intrinsics[FisheyeCameraModel::PRINCIPAL_POINT_Y] = 240.0;
+  intrinsics[FisheyeCameraModel::RADIAL_DISTORTION_1] = 0.1;
+  intrinsics[FisheyeCameraModel::RADIAL_DISTORTION_2] = 0.2;
+  intrinsics[FisheyeCameraModel::RADIAL_DISTORTION_3] = 0.3;
+  intrinsics[FisheyeCameraModel::RADIAL_DISTORTION_4] = 0.4;
+
+  const std::vector<ViewId> view_ids = reconstruction->ViewIds();
+  for (int i = 0; i < kNumTracks; i++) {
+    const TrackId track_id = reconstruction->AddTrack();
+    for (int j = 0; j < 3; j++) {
+      reconstruction->AddObservation(
+          view_ids[(i + 2 * j) % view_ids.size()],
+          track_id,
+          Feature(rng.RandVector2d(0.0, 480.0)));
+    }
+    Track* track = reconstruction->MutableTrack(track_id);
+    track->SetEstimated(true);
+    track->SetPoint((10.0 * rng.RandVector3d()).homogeneous());
+    track->SetColor(Eigen::Matrix<uint8_t, 3, 1>(i % 256, 3, 7));
+  }
+}
+
+void ExpectViewsEqual(const Reconstruction& expected,
+                      const Reconstruction& actual) {
+  int num_estimated_views = 0;
+  for (const ViewId expected_view_id : expected.ViewIds()) {
+    const View* expected_view = expected.View(expected_view_id);
+    const ViewId actual_view_id =
+        actual.ViewIdFromName(expected_view->Name());
+    if (!expected_view->IsEstimated()) {
+      EXPECT_EQ(actual_view_id, kInvalidViewId);
+      continue;
+    }
+    ++num_estimated_views;
+    ASSERT_NE(actual_view_id, kInvalidViewId);
+    const View* actual_view = actual.View(actual_view_id);
+    EXPECT_TRUE(actual_view->IsEstimated());
+
+    const Camera& expected_camera = expected_view->Camera();
+    const Camera& actual_camera = actual_view->Camera();
+    EXPECT_LT((expected_camera.GetPosition() - actual_camera.GetPosition())
+                  .norm(),
+              kTolerance);
+    EXPECT_LT((expected_camera.GetOrientationAsRotationMatrix() -
+               actual_camera.GetOrientationAsRotationMatrix())
+                  .norm(),
+              kTolerance);
+    EXPECT_EQ(expected_camera.ImageWidth(), actual_camera.ImageWidth());
+    EXPECT_EQ(expected_camera.ImageHeight(), actual_camera.ImageHeight());
+    ASSERT_EQ(expected_camera.GetCameraIntrinsicsModelType(),
+              actual_camera.GetCameraIntrinsicsModelType());
+    const int num_parameters =
+        expected_camera.CameraIntrinsics()->NumParameters();
+    for (int i = 0; i < num_parameters; i++) {
+      EXPECT_NEAR(expected_camera.intrinsics()[i],
+                  actual_camera.intrinsics()[i],
+                  kTolerance);
+    }
+  }
+  EXPECT_EQ(actual.NumViews(), num_estimated_views);
+
+  // The views that share their intrinsics are in the same group.
+  EXPECT_EQ(actual.CameraIntrinsicsGroupIdFromViewId(
+                actual.ViewIdFromName("view_0.jpg")),
+            actual.CameraIntrinsicsGroupIdFromViewId(
+                actual.ViewIdFromName("view_1.jpg")));
+  EXPECT_EQ(actual.NumCameraIntrinsicGroups(), num_estimated_views - 1);
+}
+
+void ExpectTracksEqual(const Reconstruction& expected,
+                       const Reconstruction& actual) {
+  std::map<PointKey, TrackId> actual_track_ids;
+  for (const TrackId track_id : actual.TrackIds()) {
+    const Eigen::Vector4d& point = actual.Track(track_id)->Point();
+    actual_track_ids[PointKey(point[0], point[1], point[2])] = track_id;
+  }
+  ASSERT_EQ(actual_track_ids.size(), actual.NumTracks());
+
+  int num_written_tracks = 0;
+  for (const TrackId expected_track_id : expected.TrackIds()) {
+    const Track* expected_track = expected.Track(expected_track_id);
+    // Only the observations in estimated views are written.
+    std::vector<ViewId> estimated_view_ids;
+    for (const ViewId view_id : expected_track->ViewIds()) {
+      if (expected.View(view_id)->IsEstimated()) {
+        estimated_view_ids.emplace_back(view_id);
+      }
+    }
+    if (estimated_view_ids.size() < 2) {
+      continue;
+    }
+    ++num_written_tracks;
+
+    const Eigen::Vector4d& point = expected_track->Point();
+    const auto actual_track_id =
+        actual_track_ids.find(PointKey(point[0], point[1], point[2]));
+    ASSERT_TRUE(actual_track_id != actual_track_ids.end());
+    const Track* actual_track = actual.Track(actual_track_id->second);
+    EXPECT_TRUE(actual_track->IsEstimated());
+    EXPECT_EQ(expected_track->Color(), actual_track->Color());
+    ASSERT_EQ(actual_track->NumViews(), estimated_view_ids.size());
+    for (const ViewId expected_view_id : estimated_view_ids) {
+      const View* expected_view = expected.View(expected_view_id);
+      const View* actual_view =
+          actual.View(actual.ViewIdFromName(expected_view->Name()));
+      const Feature* actual_feature =
+          actual_view->GetFeature(actual_track_id->second);
+      ASSERT_TRUE(actual_feature != nullptr);
+      EXPECT_EQ(expected_view->GetFeature(expected_track_id)->point_,
+                actual_feature->point_);
+    }
+  }
+  EXPECT_EQ(actual.NumTracks(), num_written_tracks);
+}
+
+}  // namespace
+
+TEST(ReadColmapFiles, WriteAndReadBinaryFiles) {
+  Reconstruction expected;
+  BuildReconstruction(&expected);
+  EXPECT_TRUE(WriteColmapBinaryFiles(expected, TestDirectory()));
+
+  Reconstruction actual;
+  EXPECT_TRUE(ReadColmapBinaryFiles(TestDirectory(), &actual));
+  ExpectViewsEqual(expected, actual);
+  ExpectTracksEqual(expected, actual);
+}
+
+TEST(ReadColmapFiles, WriteInParallelAndReadBinaryFiles) {
+  Reconstruction expected;
+  BuildReconstruction(&expected);
+  EXPECT_TRUE(WriteColmapBinaryFiles(expected, TestDirectory(), 4));
+
+  Reconstruction actual;
+  EXPECT_TRUE(ReadColmapBinaryFiles(TestDirectory(), &actual));
+  ExpectViewsEqual(expected, actual);
+  ExpectTracksEqual(expected, actual);
+}
+
+TEST(ReadColmapFiles, TextCamerasUseColmapModels) {
+  Reconstruction reconstruction;
+  BuildReconstruction(&reconstruction);
+  EXPECT_TRUE(WriteColmapFiles(reconstruction, TestDirectory(), 2));
+
+  std::ifstream ifs(TestDirectory() + "/cameras.txt");
+  ASSERT_TRUE(ifs.is_open());
+  std::map<int, std::string> models;
+  std::map<int, std::vector<double> > parameters;
+  int camera_id;
+  while (ifs >> camera_id) {
+    int width, height;
+    ifs >> models[camera_id] >> width >> height;
+    std::string line;
+    std::getline(ifs, line);
+    std::istringstream line_stream(line);
+    double parameter;
+    while (line_stream >> parameter) {
+      parameters[camera_id].emplace_back(parameter);
+    }
+  }
+
+  const CameraIntrinsicsGroupId group_id =
+      reconstruction.CameraIntrinsicsGroupIdFromViewId(0);
+  EXPECT_EQ(models[group_id], "RADIAL");
+  EXPECT_EQ(parameters[group_id],
+            std::vector<double>({500.0, 320.0, 240.0, -0.1, 0.01}));
+  EXPECT_EQ(models[reconstruction.CameraIntrinsicsGroupIdFromViewId(2)],
+            "OPENCV");
+  EXPECT_EQ(models[reconstruction.CameraIntrinsicsGroupIdFromViewId(3)],
+            "FULL_OPENCV");
+  EXPECT_EQ(models[reconstruction.CameraIntrinsicsGroupIdFromViewId(4)],
+            "OPENCV_FISHEYE");
+}
+
+TEST(ReadColmapFiles, UnsupportedCameraModel) {
+  Reconstruction reconstruction;
+  BuildReconstruction(&reconstruction);
+  reconstruction.MutableView(2)->MutableCamera()->SetCameraIntrinsicsModelType(
+      CameraIntrinsicsModelType::FOV);
+  EXPECT_FALSE(WriteColmapBinaryFiles(reconstruction, TestDirectory()));
+}
+
+TEST(ReadColmapFiles, MissingFiles) {
+  Reconstruction reconstruction;
+  EXPECT_FALSE(ReadColmapBinaryFiles(TestDirectory() + "/missing_model",
+                                     &reconstruction));
+}
+
+}  // namespace theia
@@ -47,6 +47,7 @@
 #include <vector>
 
 #include "theia/sfm/reconstruction.h"
+#include "theia/util/memory_stream_buffer.h"
 
 namespace theia {
 
@@ -75,4 +76,29 @@ bool ReadReconstruction(const std::string& input_file,
   return true;
 }
 
+bool ReadReconstructionFromBuffer(const char* data,
+                                  const size_t size,
+                                  Reconstruction* reconstruction) {
+  CHECK_NOTNULL(reconstruction);
+  CHECK_EQ(reconstruction->NumViews(), 0) << "You must provide an empty "
+                                             "reconstruction before reading a "
+                                             "reconstruction from a buffer";
+  CHECK_EQ(reconstruction->NumTracks(), 0) << "You must provide an empty "
+                                              "reconstruction before reading a "
+                                              "reconstruction from a buffer";
+
+  ArrayInputStreamBuffer stream_buffer(data, size);
+  std::istream input_stream(&stream_buffer);
+  try {
+    cereal::PortableBinaryInputArchive input_archive(input_stream);
+    input_archive(*reconstruction);
+  } catch (const cereal::Exception& e) {
+    LOG(ERROR) << "Could not read the reconstruction from the buffer: "
+               << e.what();
+    *reconstruction = Reconstruction();
+    return false;
+  }
+  return true;
+}
+
 }  // namespace theia
@@ -35,6 +35,7 @@
 #ifndef THEIA_IO_RECONSTRUCTION_READER_H_
 #define THEIA_IO_RECONSTRUCTION_READER_H_
 
+#include <cstddef>
 #include <string>
 
 namespace theia {
@@ -50,6 +51,13 @@ class Reconstruction;
 bool ReadReconstruction(const std::string& input_file,
                         Reconstruction* reconstruction);
 
+// Reads a reconstruction written with WriteReconstructionToBuffer into an empty
+// reconstruction. The buffer is read in place. Returns false if the buffer is
+// not a valid serialized reconstruction.
+bool ReadReconstructionFromBuffer(const char* data,
+                                  const size_t size,
+                                  Reconstruction* reconstruction);
+
 }  // namespace theia
 
 #endif  // THEIA_IO_RECONSTRUCTION_READER_H_
@@ -0,0 +1,121 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+
+#include <Eigen/Core>
+#include <string>
+
+#include "gtest/gtest.h"
+
+#include "theia/io/reconstruction_reader.h"
+#include "theia/io/reconstruction_writer.h"
+#include "theia/sfm/feature.h"
+#include "theia/sfm/reconstruction.h"
+#include "theia/sfm/track.h"
+#include "theia/sfm/view.h"
+#include "theia/util/stringprintf.h"
+
+namespace theia {
+
+namespace {
+
+static const int kNumViews = 5;
+static const int kNumTracks = 20;
+
+void BuildReconstruction(Reconstruction* reconstruction) {
+  for (int i = 0; i < kNumViews; i++) {
+    const ViewId view_id =
+        reconstruction->AddView(StringPrintf("%d.jpg", i), 0.5 * i);
+    reconstruction->MutableView(view_id)->SetEstimated(true);
+    reconstruction->MutableView(view_id)->MutableCamera()->SetPosition(
+        Eigen::Vector3d(i, 0.0, 0.0));
+  }
+  for (int i = 0; i < kNumTracks; i++) {
+    const TrackId track_id = reconstruction->AddTrack();
+    reconstruction->MutableTrack(track_id)->SetEstimated(true);
+    *reconstruction->MutableTrack(track_id)->MutablePoint() =
+        Eigen::Vector4d(i, i + 1.0, i + 2.0, 1.0);
+    for (int j = 0; j < kNumViews; j++) {
+      reconstruction->AddObservation(j, track_id, Feature(i, j));
+    }
+  }
+}
+
+}  // namespace
+
+TEST(ReconstructionReader, BufferRoundTrip) {
+  Reconstruction reconstruction;
+  BuildReconstruction(&reconstruction);
+
+  std::string buffer = "previous contents";
+  WriteReconstructionToBuffer(reconstruction, &buffer);
+
+  Reconstruction read_reconstruction;
+  ASSERT_TRUE(ReadReconstructionFromBuffer(
+      buffer.data(), buffer.size(), &read_reconstruction));
+  ASSERT_EQ(read_reconstruction.NumViews(), kNumViews);
+  ASSERT_EQ(read_reconstruction.NumTracks(), kNumTracks);
+  for (const ViewId view_id : reconstruction.ViewIds()) {
+    const View* view = reconstruction.View(view_id);
+    const View* read_view = read_reconstruction.View(view_id);
+    ASSERT_NE(read_view, nullptr);
+    EXPECT_EQ(read_view->Name(), view->Name());
+    EXPECT_EQ(read_reconstruction.ViewIdFromTimestamp(view->GetTimestamp()),
+              view_id);
+    EXPECT_EQ(read_view->Camera().GetPosition(),
+              view->Camera().GetPosition());
+    EXPECT_EQ(read_view->NumFeatures(), view->NumFeatures());
+  }
+  for (const TrackId track_id : reconstruction.TrackIds()) {
+    const Track* read_track = read_reconstruction.Track(track_id);
+    ASSERT_NE(read_track, nullptr);
+    EXPECT_EQ(read_track->Point(), reconstruction.Track(track_id)->Point());
+    EXPECT_EQ(read_track->ViewIds(), reconstruction.Track(track_id)->ViewIds());
+  }
+}
+
+TEST(ReconstructionReader, TruncatedBuffer) {
+  Reconstruction reconstruction;
+  BuildReconstruction(&reconstruction);
+  std::string buffer;
+  WriteReconstructionToBuffer(reconstruction, &buffer);
+
+  Reconstruction read_reconstruction;
+  EXPECT_FALSE(ReadReconstructionFromBuffer(
+      buffer.data(), buffer.size() / 2, &read_reconstruction));
+  EXPECT_EQ(read_reconstruction.NumViews(), 0);
+  EXPECT_EQ(read_reconstruction.NumTracks(), 0);
+}
+
+}  // namespace theia
@@ -48,6 +48,7 @@
 #include "theia/sfm/reconstruction_estimator_utils.h"
 
 #include "theia/util/json.h"
+#include "theia/util/memory_stream_buffer.h"
 
 namespace theia {
 
@@ -71,6 +72,15 @@ bool WriteReconstruction(const Reconstruction& reconstruction,
   return true;
 }
 
+void WriteReconstructionToBuffer(const Reconstruction& reconstruction,
+                                 std::string* buffer) {
+  CHECK_NOTNULL(buffer)->clear();
+  StringOutputStreamBuffer stream_buffer(buffer);
+  std::ostream output_stream(&stream_buffer);
+  cereal::PortableBinaryOutputArchive output_archive(output_stream);
+  output_archive(reconstruction);
+}
+
 bool WriteReconstructionJson(const Reconstruction& reconstruction,
                              const std::string& output_json_file) {
   nlohmann::json calib_out_json;
@@ -49,6 +49,12 @@ class Reconstruction;
 bool WriteReconstruction(const Reconstruction& reconstruction,
                          const std::string& output_file);
 
+// Serializes the reconstruction in the binary format of WriteReconstruction
+// into the buffer, whose contents are replaced. This is used to send
+// reconstructions between processes without going through a file.
+void WriteReconstructionToBuffer(const Reconstruction& reconstruction,
+                                 std::string* buffer);
+
 // Writes the reconstruction to a json file. Only the estimated views and
 // tracks are output.
 bool WriteReconstructionJson(const Reconstruction& reconstruction,
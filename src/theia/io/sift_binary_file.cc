@@ -39,12 +39,17 @@
 #include <stdint.h>
 
 #include <cstdlib>
+#include <cstring>
 #include <fstream>   // NOLINT
 #include <iostream>  // NOLINT
 #include <string>
 #include <vector>
 
 #include "theia/image/keypoint_detector/keypoint.h"
+#include "theia/matching/keypoints_and_descriptors.h"
+#include "theia/util/executor.h"
+#include "theia/util/filesystem.h"
+#include "theia/util/mapped_file.h"
 
 namespace theia {
 
@@ -56,47 +61,75 @@ namespace theia {
 //   128 ints describing sift descriptor. Normalizing this 128-vector to unit
 //     length will yield the float sift descriptor.
 bool ReadSiftKeyBinaryFile(const std::string& sift_key_file,
-                           std::vector<Eigen::VectorXf>* descriptor,
-                           std::vector<Keypoint>* keypoint) {
-  CHECK_NOTNULL(descriptor)->clear();
-  CHECK_NOTNULL(keypoint)->clear();
-
-  std::ifstream ifs(sift_key_file.c_str(), std::ios::in | std::ios::binary);
-  if (!ifs.is_open()) {
+                           const int num_threads,
+                           KeypointsAndDescriptors* features) {
+  CHECK_NOTNULL(features);
+  features->keypoints.clear();
+  features->descriptor_matrix.resize(0, 0);
+  features->binary_descriptor_matrix.resize(0, 0);
+  features->quantized_descriptor_matrix.resize(0, 0);
+  features->descriptor_quantization_scale = 0.0f;
+
+  if (!FileExists(sift_key_file)) {
     LOG(ERROR) << "Could not read the sift key binary file from "
                << sift_key_file;
     return false;
   }
+  const MappedFile file(sift_key_file);
 
   // Number of descriptors and the length of the descriptors.
   int num_descriptors, len;
-  ifs.read(reinterpret_cast<char*>(&num_descriptors), sizeof(num_descriptors));
-  ifs.read(reinterpret_cast<char*>(&len), sizeof(len));
-  CHECK_EQ(len, 128);
+  if (file.size() < sizeof(num_descriptors) + sizeof(len)) {
+    LOG(ERROR) << "Invalid sift key binary file header in " << sift_key_file;
+    return false;
+  }
+  std::memcpy(&num_descriptors, file.data(), sizeof(num_descriptors));
+  std::memcpy(&len, file.data() + sizeof(num_descriptors), sizeof(len));
+  const uint64_t key_size = 4 * sizeof(float) + len;
+  if (num_descriptors < 0 || len <= 0 ||
+      file.size() < sizeof(num_descriptors) + sizeof(len) +
+                        num_descriptors * key_size) {
+    LOG(ERROR) << "Invalid sift key binary file " << sift_key_file;
+    return false;
+  }
+  const char* keys = file.data() + sizeof(num_descriptors) + sizeof(len);
+
+  features->keypoints.resize(num_descriptors);
+  features->quantized_descriptor_matrix.resize(num_descriptors, len);
+  ParallelFor(
+      num_threads, num_descriptors, [&](const int first, const int last) {
+        for (int i = first; i < last; i++) {
+          const char* key = keys + i * key_size;
+          // Keypoint params = y, x, scale, orientation.
+          float keypoint_params[4];
+          std::memcpy(keypoint_params, key, sizeof(keypoint_params));
+          Keypoint* keypoint = &features->keypoints[i];
+          *keypoint =
+              Keypoint(keypoint_params[1], keypoint_params[0], Keypoint::SIFT);
+          keypoint->set_scale(keypoint_params[2]);
+          keypoint->set_orientation(keypoint_params[3]);
+          std::memcpy(features->quantized_descriptor_matrix.row(i).data(),
+                      key + sizeof(keypoint_params),
+                      len);
+        }
+      });
+  features->descriptor_quantization_scale =
+      kSiftKeyFileDescriptorQuantizationScale;
+  return true;
+}
 
-  descriptor->reserve(num_descriptors);
-  keypoint->reserve(num_descriptors);
+bool ReadSiftKeyBinaryFile(const std::string& sift_key_file,
+                           std::vector<Eigen::VectorXf>* descriptor,
+                           std::vector<Keypoint>* keypoint) {
+  CHECK_NOTNULL(descriptor)->clear();
+  CHECK_NOTNULL(keypoint)->clear();
 
-  for (int i = 0; i < num_descriptors; i++) {
-    // Keypoint params = y, x, scale, orientation.
-    float keypoint_params[4];
-    ifs.read(reinterpret_cast<char*>(keypoint_params),
-             4 * sizeof(keypoint_params[0]));
-
-    Keypoint kp(keypoint_params[1], keypoint_params[0], Keypoint::SIFT);
-    kp.set_scale(keypoint_params[2]);
-    kp.set_orientation(keypoint_params[3]);
-    keypoint->push_back(kp);
-
-    Eigen::Matrix<uint8_t, Eigen::Dynamic, 1> int_desc(128);
-    ifs.read(reinterpret_cast<char*>(int_desc.data()),
-             int_desc.size() * sizeof(int_desc[0]));
-    Eigen::VectorXf float_descriptor = int_desc.cast<float>();
-    float_descriptor /= 255.0;
-    descriptor->push_back(float_descriptor);
+  KeypointsAndDescriptors features;
+  if (!ReadSiftKeyBinaryFile(sift_key_file, 1, &features)) {
+    return false;
   }
-  ifs.close();
-
+  *descriptor = features.GetDescriptors();
+  keypoint->swap(features.keypoints);
   return true;
 }
 
@@ -143,4 +176,51 @@ bool WriteSiftKeyBinaryFile(const std::string& output_sift_key_file,
   return true;
 }
 
+bool WriteSiftKeyBinaryFile(const std::string& output_sift_key_file,
+                            const KeypointsAndDescriptors& features) {
+  CHECK_EQ(features.NumDescriptors(), features.keypoints.size());
+
+  // The bytes of the descriptors, which are scaled by 255 and truncated as in
+  // the method above unless they were read from a SIFT key file.
+  QuantizedDescriptorMatrix scaled_descriptors;
+  const QuantizedDescriptorMatrix* descriptors = &scaled_descriptors;
+  if (features.HasOnlyQuantizedDescriptors() &&
+      features.descriptor_quantization_scale ==
+          kSiftKeyFileDescriptorQuantizationScale) {
+    descriptors = &features.quantized_descriptor_matrix;
+  } else {
+    DescriptorMatrix buffer;
+    scaled_descriptors =
+        (features.FloatDescriptors(&buffer) * 255.0f).cast<uint8_t>();
+  }
+
+  std::ofstream ofs(output_sift_key_file.c_str(),
+                    std::ios::out | std::ios::binary);
+  if (!ofs.is_open()) {
+    LOG(ERROR) << "Could not write the sift key binary file to "
+               << output_sift_key_file;
+    return false;
+  }
+
+  // Output number of descriptors and descriptor length.
+  const int num_descriptors = descriptors->rows();
+  const int len = descriptors->cols();
+  ofs.write(reinterpret_cast<const char*>(&num_descriptors),
+            sizeof(num_descriptors));
+  ofs.write(reinterpret_cast<const char*>(&len), sizeof(len));
+
+  for (int i = 0; i < num_descriptors; i++) {
+    const Keypoint& keypoint = features.keypoints[i];
+    float kp[4];
+    kp[0] = keypoint.y();
+    kp[1] = keypoint.x();
+    kp[2] = keypoint.scale();
+    kp[3] = keypoint.orientation();
+    ofs.write(reinterpret_cast<const char*>(kp), 4 * sizeof(kp[0]));
+    ofs.write(reinterpret_cast<const char*>(descriptors->row(i).data()), len);
+  }
+  ofs.close();
+  return true;
+}
+
 }  // namespace theia
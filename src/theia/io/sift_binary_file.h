@@ -41,6 +41,7 @@
 
 namespace theia {
 class Keypoint;
+struct KeypointsAndDescriptors;
 
 // Reads a SIFT key files as computed by Lowe's SIFT software:
 // http://www.cs.ubc.ca/~lowe/keypoints/
@@ -52,12 +53,28 @@ bool ReadSiftKeyBinaryFile(const std::string& input_sift_key_file,
                            std::vector<Eigen::VectorXf>* descriptor,
                            std::vector<Keypoint>* keypoint);
 
+// Reads a binary SIFT key file from a memory mapping of the file directly into
+// the keypoints and the contiguous descriptor block of features. As with
+// ReadSiftKeyTextFile, the descriptor bytes are kept in the quantized
+// descriptor matrix with a quantization scale of 255. The keypoints are copied
+// in parallel with num_threads threads. Returns false if the file cannot be
+// read or is malformed.
+bool ReadSiftKeyBinaryFile(const std::string& input_sift_key_file,
+                           const int num_threads,
+                           KeypointsAndDescriptors* features);
+
 // Outputs the SIFT features in the same format as Lowe's sift key files, but
 // stores it as a binary file for faster loading.
 bool WriteSiftKeyBinaryFile(const std::string& output_sift_key_file,
                             const std::vector<Eigen::VectorXf>& descriptor,
                             const std::vector<Keypoint>& keypoint);
 
+// Writes the keypoints and the float or quantized descriptors of features as a
+// binary SIFT key file. Descriptors read from SIFT key files are written
+// without a round trip through floats.
+bool WriteSiftKeyBinaryFile(const std::string& output_sift_key_file,
+                            const KeypointsAndDescriptors& features);
+
 }  // namespace theia
 
 #endif  // THEIA_IO_SIFT_BINARY_FILE_H_
@@ -0,0 +1,156 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#include <Eigen/Core>
+#include <stdint.h>
+
+#include <fstream>  // NOLINT
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "theia/image/keypoint_detector/keypoint.h"
+#include "theia/io/sift_binary_file.h"
+#include "theia/matching/keypoints_and_descriptors.h"
+
+namespace theia {
+
+namespace {
+
+static const int kNumKeys = 41;
+static const int kDescriptorLength = 128;
+
+void CreateFeatures(std::vector<Eigen::VectorXf>* descriptors,
+                    std::vector<Keypoint>* keypoints) {
+  for (int i = 0; i < kNumKeys; i++) {
+    Keypoint keypoint(3 * i, i + 0.25, Keypoint::SIFT);
+    keypoint.set_scale(2.0);
+    keypoint.set_orientation(0.75);
+    keypoints->emplace_back(keypoint);
+
+    Eigen::VectorXf descriptor(kDescriptorLength);
+    for (int j = 0; j < kDescriptorLength; j++) {
+      descriptor[j] = ((i * 13 + j * 5) % 256) / 255.0f;
+    }
+    descriptors->emplace_back(descriptor);
+  }
+}
+
+void VerifyFeatures(const std::vector<Eigen::VectorXf>& descriptors,
+                    const std::vector<Keypoint>& keypoints,
+                    const KeypointsAndDescriptors& features) {
+  ASSERT_EQ(features.keypoints.size(), keypoints.size());
+  ASSERT_EQ(features.NumDescriptors(), descriptors.size());
+  EXPECT_TRUE(features.HasOnlyQuantizedDescriptors());
+  for (int i = 0; i < keypoints.size(); i++) {
+    EXPECT_EQ(features.keypoints[i].x(), keypoints[i].x());
+    EXPECT_EQ(features.keypoints[i].y(), keypoints[i].y());
+    EXPECT_EQ(features.keypoints[i].scale(), keypoints[i].scale());
+    EXPECT_EQ(features.keypoints[i].orientation(), keypoints[i].orientation());
+    EXPECT_TRUE(features.FloatDescriptor(i) == descriptors[i].transpose());
+  }
+}
+
+}  // namespace
+
+TEST(SiftKeyBinaryFile, ReadIntoDescriptorMatrix) {
+  std::vector<Eigen::VectorXf> descriptors;
+  std::vector<Keypoint> keypoints;
+  CreateFeatures(&descriptors, &keypoints);
+  const std::string filepath = testing::internal::TempDir() + "keys.bin";
+  EXPECT_TRUE(WriteSiftKeyBinaryFile(filepath, descriptors, keypoints));
+
+  for (const int num_threads : {1, 4}) {
+    KeypointsAndDescriptors features;
+    EXPECT_TRUE(ReadSiftKeyBinaryFile(filepath, num_threads, &features));
+    VerifyFeatures(descriptors, keypoints, features);
+  }
+
+  std::vector<Eigen::VectorXf> read_descriptors;
+  std::vector<Keypoint> read_keypoints;
+  EXPECT_TRUE(
+      ReadSiftKeyBinaryFile(filepath, &read_descriptors, &read_keypoints));
+  ASSERT_EQ(read_descriptors.size(), descriptors.size());
+  for (int i = 0; i < descriptors.size(); i++) {
+    EXPECT_TRUE(read_descriptors[i] == descriptors[i]);
+  }
+}
+
+TEST(SiftKeyBinaryFile, WriteDescriptorMatrix) {
+  std::vector<Eigen::VectorXf> descriptors;
+  std::vector<Keypoint> keypoints;
+  CreateFeatures(&descriptors, &keypoints);
+
+  // Float descriptors are scaled to bytes and quantized descriptors that were
+  // read from a key file are written as they are.
+  KeypointsAndDescriptors features;
+  features.keypoints = keypoints;
+  features.SetDescriptors(descriptors);
+  const std::string filepath = testing::internal::TempDir() + "matrix.bin";
+  EXPECT_TRUE(WriteSiftKeyBinaryFile(filepath, features));
+  KeypointsAndDescriptors read_features;
+  EXPECT_TRUE(ReadSiftKeyBinaryFile(filepath, 2, &read_features));
+  VerifyFeatures(descriptors, keypoints, read_features);
+
+  const std::string copy_filepath = testing::internal::TempDir() + "copy.bin";
+  EXPECT_TRUE(WriteSiftKeyBinaryFile(copy_filepath, read_features));
+  KeypointsAndDescriptors copied_features;
+  EXPECT_TRUE(ReadSiftKeyBinaryFile(copy_filepath, 2, &copied_features));
+  VerifyFeatures(descriptors, keypoints, copied_features);
+}
+
+TEST(SiftKeyBinaryFile, TruncatedFile) {
+  std::vector<Eigen::VectorXf> descriptors;
+  std::vector<Keypoint> keypoints;
+  CreateFeatures(&descriptors, &keypoints);
+  const std::string filepath = testing::internal::TempDir() + "truncated.bin";
+  EXPECT_TRUE(WriteSiftKeyBinaryFile(filepath, descriptors, keypoints));
+
+  std::string contents;
+  {
+    std::ifstream ifs(filepath, std::ios::in | std::ios::binary);
+    contents.assign(std::istreambuf_iterator<char>(ifs),
+                    std::istreambuf_iterator<char>());
+  }
+  {
+    std::ofstream ofs(filepath, std::ios::out | std::ios::binary);
+    ofs.write(contents.data(), contents.size() - 1);
+  }
+  KeypointsAndDescriptors features;
+  EXPECT_FALSE(ReadSiftKeyBinaryFile(filepath, 1, &features));
+}
+
+}  // namespace theia
@@ -38,17 +38,50 @@
 #include <glog/logging.h>
 #include <stdint.h>
 
-#include <cstdio>
-#include <cstdlib>
-#include <fstream>   // NOLINT
-#include <iostream>  // NOLINT
 #include <string>
 #include <vector>
 
 #include "theia/image/keypoint_detector/keypoint.h"
+#include "theia/io/text_parser.h"
+#include "theia/matching/keypoints_and_descriptors.h"
+#include "theia/util/filesystem.h"
+#include "theia/util/mapped_file.h"
 
 namespace theia {
 
+namespace {
+
+// Lowe's SIFT software writes 20 descriptor values per line.
+static const int kNumDescriptorValuesPerLine = 20;
+
+// Parses a keypoint and its descriptor, which is stored in row index of
+// descriptors.
+bool ParseSiftKey(const int index,
+                  TextParser* in,
+                  Keypoint* keypoint,
+                  QuantizedDescriptorMatrix* descriptors) {
+  float x, y, scale, orientation;
+  if (!in->ParseFloat(&y) || !in->ParseFloat(&x) || !in->ParseFloat(&scale) ||
+      !in->ParseFloat(&orientation)) {
+    return false;
+  }
+  *keypoint = Keypoint(x, y, Keypoint::SIFT);
+  keypoint->set_scale(scale);
+  keypoint->set_orientation(orientation);
+
+  uint8_t* descriptor = descriptors->row(index).data();
+  for (int i = 0; i < descriptors->cols(); i++) {
+    int value;
+    if (!in->ParseInt(&value) || value < 0 || value > 255) {
+      return false;
+    }
+    descriptor[i] = static_cast<uint8_t>(value);
+  }
+  return true;
+}
+
+}  // namespace
+
 // The sift key file has the following format:
 //
 // number_of_keypoints sift_descriptor_dimensions (both as ints)
@@ -56,92 +89,68 @@ namespace theia {
 //   row col scale orientation (all as floats)
 //   128 ints describing sift descriptor. Normalizing this 128-vector to unit
 //     length will yield the true sift descriptor.
-// NOTE: We use getline and strtof which should be much faster than letting the
-// stream parse the string with operator >>.
 bool ReadSiftKeyTextFile(const std::string& sift_key_file,
-                         std::vector<Eigen::VectorXf>* descriptor,
-                         std::vector<Keypoint>* keypoint) {
-  CHECK_NOTNULL(descriptor)->clear();
-  CHECK_NOTNULL(keypoint)->clear();
+                         const int num_threads,
+                         KeypointsAndDescriptors* features) {
+  CHECK_NOTNULL(features);
+  features->keypoints.clear();
+  features->descriptor_matrix.resize(0, 0);
+  features->binary_descriptor_matrix.resize(0, 0);
+  features->quantized_descriptor_matrix.resize(0, 0);
+  features->descriptor_quantization_scale = 0.0f;
+
+  if (!FileExists(sift_key_file)) {
+    LOG(ERROR) << "Could not open the sift key text file: " << sift_key_file;
+    return false;
+  }
+  const MappedFile file(sift_key_file);
+  const char* end = file.data() + file.size();
+  TextParser in(file.data(), end);
 
-  FILE* fp = fopen(sift_key_file.c_str(), "r");
   int num_descriptors, len;
-  if (fp == nullptr) {
+  if (!in.ParseInt(&num_descriptors) || !in.ParseInt(&len) ||
+      num_descriptors < 0 || len <= 0) {
+    LOG(ERROR) << "Invalid sift key text file header in " << sift_key_file;
     return false;
   }
 
-  if (fscanf(fp, "%d %d", &num_descriptors, &len) != 2) {
-    printf("Invalid keypoint file\n");
-    return 0;
+  std::vector<Keypoint> keypoints(num_descriptors);
+  QuantizedDescriptorMatrix descriptors(num_descriptors, len);
+  const int num_lines_per_key =
+      1 + (len + kNumDescriptorValuesPerLine - 1) / kNumDescriptorValuesPerLine;
+  const auto parse_key = [&](TextParser* parser, const int i) {
+    return ParseSiftKey(i, parser, &keypoints[i], &descriptors);
+  };
+  if (!ParseRecords(in.position(),
+                    end,
+                    num_descriptors,
+                    num_lines_per_key,
+                    num_threads,
+                    parse_key,
+                    nullptr)) {
+    LOG(ERROR) << "Invalid sift key text file format in " << sift_key_file;
+    return false;
   }
 
-  CHECK_EQ(len, 128);
-
-  descriptor->reserve(num_descriptors);
-  keypoint->reserve(num_descriptors);
-
-  for (int i = 0; i < num_descriptors; i++) {
-    float x, y, scale, ori;
+  features->keypoints.swap(keypoints);
+  features->quantized_descriptor_matrix.swap(descriptors);
+  features->descriptor_quantization_scale =
+      kSiftKeyFileDescriptorQuantizationScale;
+  return true;
+}
 
-    if (fscanf(fp, "%f %f %f %f\n", &y, &x, &scale, &ori) != 4) {
-      printf("Invalid keypoint file format.");
-      return 0;
-    }
+bool ReadSiftKeyTextFile(const std::string& sift_key_file,
+                         std::vector<Eigen::VectorXf>* descriptor,
+                         std::vector<Keypoint>* keypoint) {
+  CHECK_NOTNULL(descriptor)->clear();
+  CHECK_NOTNULL(keypoint)->clear();
 
-    Keypoint kp(x, y, Keypoint::SIFT);
-    kp.set_scale(scale);
-    kp.set_orientation(ori);
-    keypoint->push_back(kp);
-
-    char buf[1024];
-    Eigen::Matrix<uint8_t, Eigen::Dynamic, 1> int_descriptor(128);
-    uint8_t* p = int_descriptor.data();
-    for (int line = 0; line < 6; line++) {
-      CHECK_NOTNULL(fgets(buf, 1024, fp));
-      sscanf(buf,
-             "%hhu %hhu %hhu %hhu %hhu %hhu %hhu %hhu %hhu %hhu "
-             "%hhu %hhu %hhu %hhu %hhu %hhu %hhu %hhu %hhu %hhu",
-             p + 0,
-             p + 1,
-             p + 2,
-             p + 3,
-             p + 4,
-             p + 5,
-             p + 6,
-             p + 7,
-             p + 8,
-             p + 9,
-             p + 10,
-             p + 11,
-             p + 12,
-             p + 13,
-             p + 14,
-             p + 15,
-             p + 16,
-             p + 17,
-             p + 18,
-             p + 19);
-
-      p += 20;
-    }
-    CHECK_NOTNULL(fgets(buf, 1024, fp));
-    sscanf(buf,
-           "%hhu %hhu %hhu %hhu %hhu %hhu %hhu %hhu",
-           p + 0,
-           p + 1,
-           p + 2,
-           p + 3,
-           p + 4,
-           p + 5,
-           p + 6,
-           p + 7);
-
-    Eigen::VectorXf float_descriptor = int_descriptor.cast<float>();
-    float_descriptor /= 255.0;
-    descriptor->push_back(float_descriptor);
+  KeypointsAndDescriptors features;
+  if (!ReadSiftKeyTextFile(sift_key_file, 1, &features)) {
+    return false;
   }
-
-  fclose(fp);
+  *descriptor = features.GetDescriptors();
+  keypoint->swap(features.keypoints);
   return true;
 }
 
@@ -41,6 +41,7 @@
 
 namespace theia {
 class Keypoint;
+struct KeypointsAndDescriptors;
 
 // Reads a SIFT key files as computed by Lowe's SIFT software:
 // http://www.cs.ubc.ca/~lowe/keypoints/
@@ -52,6 +53,17 @@ bool ReadSiftKeyTextFile(const std::string& sift_key_file,
                          std::vector<Eigen::VectorXf>* descriptor,
                          std::vector<Keypoint>* keypoint);
 
+// Reads a SIFT key text file from a memory mapping of the file directly into
+// the keypoints and the contiguous descriptor block of features. Lowe's format
+// stores each descriptor dimension as a byte, so the descriptors are kept in
+// the quantized descriptor matrix with a quantization scale of 255, which
+// dequantizes to the same float descriptors as the method above. The keypoints
+// are parsed in parallel with num_threads threads. Returns false if the file
+// cannot be read or is malformed.
+bool ReadSiftKeyTextFile(const std::string& sift_key_file,
+                         const int num_threads,
+                         KeypointsAndDescriptors* features);
+
 }  // namespace theia
 
 #endif  // THEIA_IO_SIFT_TEXT_FILE_H_
@@ -0,0 +1,155 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#include <Eigen/Core>
+#include <stdint.h>
+
+#include <fstream>  // NOLINT
+#include <sstream>  // NOLINT
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "theia/image/keypoint_detector/keypoint.h"
+#include "theia/io/sift_text_file.h"
+#include "theia/matching/keypoints_and_descriptors.h"
+
+namespace theia {
+
+namespace {
+
+static const int kNumKeys = 37;
+static const int kDescriptorLength = 128;
+
+uint8_t DescriptorValue(const int key, const int dimension) {
+  return static_cast<uint8_t>((key * 31 + dimension * 7) % 256);
+}
+
+// Writes a key file in the layout of Lowe's SIFT software with values_per_line
+// descriptor values per line.
+std::string WriteKeyFile(const std::string& name, const int values_per_line) {
+  std::stringstream contents;
+  contents << kNumKeys << " " << kDescriptorLength << "\n";
+  for (int i = 0; i < kNumKeys; i++) {
+    contents << i + 0.5 << " " << 2 * i << " " << 1.25 << " " << -0.5 << "\n";
+    for (int j = 0; j < kDescriptorLength; j++) {
+      contents << " " << static_cast<int>(DescriptorValue(i, j));
+      if ((j + 1) % values_per_line == 0 || j + 1 == kDescriptorLength) {
+        contents << "\n";
+      }
+    }
+  }
+
+  const std::string filepath = testing::internal::TempDir() + name;
+  std::ofstream ofs(filepath);
+  ofs << contents.str();
+  return filepath;
+}
+
+void VerifyFeatures(const KeypointsAndDescriptors& features) {
+  ASSERT_EQ(features.keypoints.size(), kNumKeys);
+  ASSERT_EQ(features.NumDescriptors(), kNumKeys);
+  ASSERT_EQ(features.DescriptorDimension(), kDescriptorLength);
+  EXPECT_TRUE(features.HasOnlyQuantizedDescriptors());
+  EXPECT_EQ(features.descriptor_quantization_scale,
+            kSiftKeyFileDescriptorQuantizationScale);
+  for (int i = 0; i < kNumKeys; i++) {
+    const Keypoint& keypoint = features.keypoints[i];
+    EXPECT_EQ(keypoint.keypoint_type(), Keypoint::SIFT);
+    EXPECT_EQ(keypoint.x(), 2 * i);
+    EXPECT_EQ(keypoint.y(), i + 0.5);
+    EXPECT_EQ(keypoint.scale(), 1.25);
+    EXPECT_EQ(keypoint.orientation(), -0.5);
+    for (int j = 0; j < kDescriptorLength; j++) {
+      EXPECT_EQ(features.quantized_descriptor_matrix(i, j),
+                DescriptorValue(i, j));
+    }
+  }
+}
+
+}  // namespace
+
+TEST(ReadSiftKeyTextFile, Parallel) {
+  const std::string filepath = WriteKeyFile("parallel.key", 20);
+  for (const int num_threads : {1, 4}) {
+    KeypointsAndDescriptors features;
+    EXPECT_TRUE(ReadSiftKeyTextFile(filepath, num_threads, &features));
+    VerifyFeatures(features);
+  }
+}
+
+TEST(ReadSiftKeyTextFile, OtherLineLayout) {
+  const std::string filepath = WriteKeyFile("other_layout.key", 64);
+  KeypointsAndDescriptors features;
+  EXPECT_TRUE(ReadSiftKeyTextFile(filepath, 4, &features));
+  VerifyFeatures(features);
+}
+
+TEST(ReadSiftKeyTextFile, DescriptorVectors) {
+  const std::string filepath = WriteKeyFile("vectors.key", 20);
+  std::vector<Eigen::VectorXf> descriptors;
+  std::vector<Keypoint> keypoints;
+  EXPECT_TRUE(ReadSiftKeyTextFile(filepath, &descriptors, &keypoints));
+  ASSERT_EQ(descriptors.size(), kNumKeys);
+  ASSERT_EQ(keypoints.size(), kNumKeys);
+  for (int i = 0; i < kNumKeys; i++) {
+    EXPECT_EQ(keypoints[i].x(), 2 * i);
+    ASSERT_EQ(descriptors[i].size(), kDescriptorLength);
+    for (int j = 0; j < kDescriptorLength; j++) {
+      EXPECT_EQ(descriptors[i][j], DescriptorValue(i, j) / 255.0f);
+    }
+  }
+}
+
+TEST(ReadSiftKeyTextFile, InvalidFiles) {
+  KeypointsAndDescriptors features;
+  EXPECT_FALSE(ReadSiftKeyTextFile(
+      testing::internal::TempDir() + "missing.key", 1, &features));
+
+  const std::string filepath = testing::internal::TempDir() + "invalid.key";
+  {
+    std::ofstream ofs(filepath);
+    ofs << "1 4\n1 2 3 4\n1 2 300 4\n";
+  }
+  EXPECT_FALSE(ReadSiftKeyTextFile(filepath, 1, &features));
+
+  {
+    std::ofstream ofs(filepath);
+    ofs << "2 4\n1 2 3 4\n1 2 3 4\n";
+  }
+  EXPECT_FALSE(ReadSiftKeyTextFile(filepath, 1, &features));
+}
+
+}  // namespace theia
@@ -0,0 +1,307 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#include "theia/io/text_parser.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <vector>
+
+namespace theia {
+namespace {
+
+// The powers of ten that are exactly representable as a double.
+static const double kPowersOfTen[] = {
+    1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+// Significands up to this value are exactly representable as a double.
+static const uint64_t kMaxExactSignificand = uint64_t(1) << 53;
+
+// Numbers longer than this are never written by SfM tools and are not parsed.
+static const int kMaxNumberLength = 128;
+
+inline bool IsWhitespace(const char c) {
+  return c == ' ' || c == '\n' || c == '\t' || c == '\r' || c == '\v' ||
+         c == '\f';
+}
+
+inline bool IsDigit(const char c) { return c >= '0' && c <= '9'; }
+
+// Parses a number with strtod, which handles the numbers that the fast path in
+// ParseDouble does not.
+const char* ParseDoubleWithStrtod(const char* begin,
+                                  const char* end,
+                                  double* value) {
+  char buffer[kMaxNumberLength + 1];
+  int length = 0;
+  while (begin + length != end && length < kMaxNumberLength &&
+         !IsWhitespace(begin[length])) {
+    buffer[length] = begin[length];
+    ++length;
+  }
+  buffer[length] = '\0';
+  char* parsed_end;
+  const double parsed_value = std::strtod(buffer, &parsed_end);
+  if (parsed_end == buffer) {
+    return nullptr;
+  }
+  *value = parsed_value;
+  return begin + (parsed_end - buffer);
+}
+
+bool IsEmptyLine(const char* begin, const char* end) {
+  return std::find_if(begin, end, [](const char c) {
+           return !IsWhitespace(c);
+         }) == end;
+}
+
+// Returns the beginning of the next line, or end if this is the last line.
+const char* NextLine(const char* begin, const char* end) {
+  const char* newline =
+      static_cast<const char*>(std::memchr(begin, '\n', end - begin));
+  return newline == nullptr ? end : newline + 1;
+}
+
+}  // namespace
+
+const char* ParseDouble(const char* begin, const char* end, double* value) {
+  const char* position = begin;
+  bool negative = false;
+  if (position != end && (*position == '-' || *position == '+')) {
+    negative = *position == '-';
+    ++position;
+  }
+
+  // Accumulate up to 19 significant digits, which always fit in 64 bits.
+  uint64_t significand = 0;
+  int num_significant_digits = 0;
+  int exponent = 0;
+  bool has_digits = false;
+  bool is_truncated = false;
+  for (; position != end && IsDigit(*position); ++position) {
+    has_digits = true;
+    if (num_significant_digits < 19) {
+      significand = 10 * significand + (*position - '0');
+      num_significant_digits += significand > 0;
+    } else {
+      ++exponent;
+      is_truncated |= *position != '0';
+    }
+  }
+  if (position != end && *position == '.') {
+    for (++position; position != end && IsDigit(*position); ++position) {
+      has_digits = true;
+      if (num_significant_digits < 19) {
+        significand = 10 * significand + (*position - '0');
+        num_significant_digits += significand > 0;
+        --exponent;
+      } else {
+        is_truncated |= *position != '0';
+      }
+    }
+  }
+  if (!has_digits) {
+    // Infinity and NaN.
+    return ParseDoubleWithStrtod(begin, end, value);
+  }
+
+  if (position != end && (*position == 'e' || *position == 'E')) {
+    const char* exponent_position = position + 1;
+    bool negative_exponent = false;
+    if (exponent_position != end &&
+        (*exponent_position == '-' || *exponent_position == '+')) {
+      negative_exponent = *exponent_position == '-';
+      ++exponent_position;
+    }
+    if (exponent_position == end || !IsDigit(*exponent_position)) {
+      return ParseDoubleWithStrtod(begin, end, value);
+    }
+    int explicit_exponent = 0;
+    for (; exponent_position != end && IsDigit(*exponent_position);
+         ++exponent_position) {
+      if (explicit_exponent < 100000) {
+        explicit_exponent = 10 * explicit_exponent + (*exponent_position - '0');
+      }
+    }
+    exponent += negative_exponent ? -explicit_exponent : explicit_exponent;
+    position = exponent_position;
+  }
+
+  if (significand == 0) {
+    *value = negative ? -0.0 : 0.0;
+    return position;
+  }
+
+  // A product or quotient of two exact doubles is rounded correctly.
+  if (is_truncated || significand > kMaxExactSignificand || exponent < -22 ||
+      exponent > 22) {
+    return ParseDoubleWithStrtod(begin, end, value);
+  }
+  double result = static_cast<double>(significand);
+  result = exponent < 0 ? result / kPowersOfTen[-exponent]
+                        : result * kPowersOfTen[exponent];
+  *value = negative ? -result : result;
+  return position;
+}
+
+const char* ParseInt(const char* begin, const char* end, int* value) {
+  const char* position = begin;
+  bool negative = false;
+  if (position != end && (*position == '-' || *position == '+')) {
+    negative = *position == '-';
+    ++position;
+  }
+  const char* digits_begin = position;
+  int64_t result = 0;
+  for (; position != end && IsDigit(*position); ++position) {
+    result = 10 * result + (*position - '0');
+    if (result > static_cast<int64_t>(std::numeric_limits<int>::max()) + 1) {
+      return nullptr;
+    }
+  }
+  if (position == digits_begin) {
+    return nullptr;
+  }
+  result = negative ? -result : result;
+  if (result > std::numeric_limits<int>::max()) {
+    return nullptr;
+  }
+  *value = static_cast<int>(result);
+  return position;
+}
+
+void TextParser::SkipWhitespace() {
+  while (position_ != end_ && IsWhitespace(*position_)) {
+    ++position_;
+  }
+}
+
+bool TextParser::AtEnd() {
+  SkipWhitespace();
+  return position_ == end_;
+}
+
+bool TextParser::ParseInt(int* value) {
+  SkipWhitespace();
+  const char* parsed_end = theia::ParseInt(position_, end_, value);
+  if (parsed_end == nullptr) {
+    return false;
+  }
+  position_ = parsed_end;
+  return true;
+}
+
+bool TextParser::ParseDouble(double* value) {
+  SkipWhitespace();
+  const char* parsed_end = theia::ParseDouble(position_, end_, value);
+  if (parsed_end == nullptr) {
+    return false;
+  }
+  position_ = parsed_end;
+  return true;
+}
+
+bool TextParser::ParseFloat(float* value) {
+  double double_value;
+  if (!ParseDouble(&double_value)) {
+    return false;
+  }
+  *value = static_cast<float>(double_value);
+  return true;
+}
+
+bool TextParser::ParseToken(std::string* token) {
+  SkipWhitespace();
+  const char* token_end = position_;
+  while (token_end != end_ && !IsWhitespace(*token_end)) {
+    ++token_end;
+  }
+  if (token_end == position_) {
+    return false;
+  }
+  token->assign(position_, token_end);
+  position_ = token_end;
+  return true;
+}
+
+void TextParser::SkipLine() { position_ = NextLine(position_, end_); }
+
+int NumNonEmptyLines(const char* begin, const char* end) {
+  int num_lines = 0;
+  while (begin != end) {
+    const char* next_line = NextLine(begin, end);
+    num_lines += !IsEmptyLine(begin, next_line);
+    begin = next_line;
+  }
+  return num_lines;
+}
+
+const char* SkipLines(const char* begin, const char* end, const int num_lines) {
+  for (int i = 0; i < num_lines && begin != end; i++) {
+    begin = NextLine(begin, end);
+  }
+  return begin;
+}
+
+bool FindLineRecords(const char* begin,
+                     const char* end,
+                     const int num_records,
+                     const int num_lines_per_record,
+                     std::vector<const char*>* record_begins) {
+  record_begins->clear();
+  record_begins->reserve(num_records + 1);
+  const char* position = begin;
+  for (int i = 0; i < num_records; i++) {
+    // Skip the rest of the previous line and any empty lines.
+    const char* next_line = NextLine(position, end);
+    while (position != end && IsEmptyLine(position, next_line)) {
+      position = next_line;
+      next_line = NextLine(position, end);
+    }
+    if (position == end) {
+      return false;
+    }
+    record_begins->emplace_back(position);
+    position = SkipLines(position, end, num_lines_per_record);
+  }
+  record_begins->emplace_back(position);
+  return true;
+}
+
+}  // namespace theia
@@ -0,0 +1,159 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#ifndef THEIA_IO_TEXT_PARSER_H_
+#define THEIA_IO_TEXT_PARSER_H_
+
+#include <atomic>
+#include <string>
+#include <vector>
+
+#include "theia/util/executor.h"
+
+namespace theia {
+
+// Parses a double from the characters in [begin, end) in the C locale and
+// returns a pointer past the last character parsed, or nullptr if no number
+// could be parsed. Numbers with at most 19 significant digits and a decimal
+// exponent of at most 22 in magnitude, which includes all numbers written by
+// SfM tools, are parsed without strtod and rounded correctly. Other numbers
+// fall back to strtod.
+const char* ParseDouble(const char* begin, const char* end, double* value);
+
+// Parses an int from the characters in [begin, end) and returns a pointer past
+// the last character parsed, or nullptr if no int could be parsed.
+const char* ParseInt(const char* begin, const char* end, int* value);
+
+// A cursor over a range of characters that parses whitespace-separated values,
+// similar to reading from an std::istream with operator>> but much faster. The
+// parser does not own the characters, which are typically a memory mapping of
+// a text file.
+class TextParser {
+ public:
+  TextParser(const char* begin, const char* end)
+      : position_(begin), end_(end) {}
+
+  // Skips whitespace and returns true if there are no characters left.
+  bool AtEnd();
+
+  // Parse the next whitespace-separated value. These return false and leave the
+  // position unchanged if the next value is missing or cannot be parsed.
+  bool ParseInt(int* value);
+  bool ParseDouble(double* value);
+  bool ParseFloat(float* value);
+  bool ParseToken(std::string* token);
+
+  // Moves the position past the end of the current line.
+  void SkipLine();
+
+  const char* position() const { return position_; }
+
+ private:
+  void SkipWhitespace();
+
+  const char* position_;
+  const char* end_;
+};
+
+// Returns the number of lines in [begin, end) that contain characters other
+// than whitespace.
+int NumNonEmptyLines(const char* begin, const char* end);
+
+// Returns the position of the num_lines-th line after the current one, or end
+// if there are fewer lines.
+const char* SkipLines(const char* begin, const char* end, const int num_lines);
+
+// Finds the beginning of num_records records of num_lines_per_record lines each
+// in [begin, end). Empty lines between records are skipped. The end of the last
+// record is appended as well, so that record i is in the range
+// [(*record_begins)[i], (*record_begins)[i + 1]). Returns false if there are
+// fewer lines in the range.
+bool FindLineRecords(const char* begin,
+                     const char* end,
+                     const int num_records,
+                     const int num_lines_per_record,
+                     std::vector<const char*>* record_begins);
+
+// Parses num_records records from [begin, end) with
+// parse_record(&text_parser, record_index), which must return false if the
+// record could not be parsed. If every record is written on
+// num_lines_per_record lines, the records are split at the lines and parsed in
+// parallel with num_threads threads. Files that do not follow this layout
+// (e.g., because of line breaks within a record) are parsed sequentially
+// instead, so parse_record must overwrite any output of a previous call with
+// the same index. The end of the last record is returned in records_end if it
+// is not null. Returns false if a record could not be parsed.
+template <class ParseRecordFunction>
+bool ParseRecords(const char* begin,
+                  const char* end,
+                  const int num_records,
+                  const int num_lines_per_record,
+                  const int num_threads,
+                  const ParseRecordFunction& parse_record,
+                  const char** records_end) {
+  std::vector<const char*> record_begins;
+  if (FindLineRecords(
+          begin, end, num_records, num_lines_per_record, &record_begins)) {
+    std::atomic<bool> success(true);
+    ParallelFor(num_threads, num_records, [&](const int first, const int last) {
+      for (int i = first; i < last && success; i++) {
+        TextParser parser(record_begins[i], record_begins[i + 1]);
+        if (!parse_record(&parser, i) || !parser.AtEnd()) {
+          success = false;
+        }
+      }
+    });
+    if (success) {
+      if (records_end != nullptr) {
+        *records_end = record_begins.back();
+      }
+      return true;
+    }
+  }
+
+  TextParser parser(begin, end);
+  for (int i = 0; i < num_records; i++) {
+    if (!parse_record(&parser, i)) {
+      return false;
+    }
+  }
+  if (records_end != nullptr) {
+    *records_end = parser.position();
+  }
+  return true;
+}
+
+}  // namespace theia
+
+#endif  // THEIA_IO_TEXT_PARSER_H_
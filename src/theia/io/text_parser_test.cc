@@ -0,0 +1,233 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "theia/io/text_parser.h"
+#include "theia/util/random.h"
+
+namespace theia {
+
+namespace {
+
+double ParseDoubleOrDie(const std::string& text) {
+  double value;
+  const char* end = ParseDouble(text.data(), text.data() + text.size(), &value);
+  EXPECT_EQ(end, text.data() + text.size()) << text;
+  return value;
+}
+
+// Parses records of the form "<n> <value 1> ... <value n>" into values.
+bool ParseSumRecords(const std::string& text,
+                     const int num_records,
+                     const int num_lines_per_record,
+                     const int num_threads,
+                     std::vector<double>* sums) {
+  sums->assign(num_records, 0.0);
+  const auto parse_record = [&](TextParser* parser, const int i) {
+    int num_values;
+    if (!parser->ParseInt(&num_values)) {
+      return false;
+    }
+    (*sums)[i] = 0.0;
+    for (int j = 0; j < num_values; j++) {
+      double value;
+      if (!parser->ParseDouble(&value)) {
+        return false;
+      }
+      (*sums)[i] += value;
+    }
+    return true;
+  };
+  return ParseRecords(text.data(),
+                      text.data() + text.size(),
+                      num_records,
+                      num_lines_per_record,
+                      num_threads,
+                      parse_record,
+                      nullptr);
+}
+
+}  // namespace
+
+TEST(TextParser, ParseDouble) {
+  EXPECT_EQ(ParseDoubleOrDie("0"), 0.0);
+  EXPECT_EQ(ParseDoubleOrDie("-0.0"), 0.0);
+  EXPECT_TRUE(std::signbit(ParseDoubleOrDie("-0.0")));
+  EXPECT_EQ(ParseDoubleOrDie("1"), 1.0);
+  EXPECT_EQ(ParseDoubleOrDie("+2.5"), 2.5);
+  EXPECT_EQ(ParseDoubleOrDie("-0.125"), -0.125);
+  EXPECT_EQ(ParseDoubleOrDie(".5"), 0.5);
+  EXPECT_EQ(ParseDoubleOrDie("5."), 5.0);
+  EXPECT_EQ(ParseDoubleOrDie("1e3"), 1000.0);
+  EXPECT_EQ(ParseDoubleOrDie("1.5E-3"), 1.5e-3);
+  EXPECT_EQ(ParseDoubleOrDie("0.1"), 0.1);
+  EXPECT_EQ(ParseDoubleOrDie("1e300"), 1e300);
+  EXPECT_EQ(ParseDoubleOrDie("4.9406564584124654e-324"),
+            4.9406564584124654e-324);
+  EXPECT_EQ(ParseDoubleOrDie("123456789012345678901234567890"),
+            123456789012345678901234567890.0);
+  EXPECT_TRUE(std::isinf(ParseDoubleOrDie("inf")));
+  EXPECT_TRUE(std::isnan(ParseDoubleOrDie("nan")));
+
+  // Only the number is parsed.
+  const std::string text = "-12.5e1 7";
+  double value;
+  const char* end = ParseDouble(text.data(), text.data() + text.size(), &value);
+  EXPECT_EQ(value, -125.0);
+  EXPECT_EQ(end, text.data() + 7);
+
+  // The range does not need to be terminated.
+  const std::string digits = "31415";
+  EXPECT_EQ(ParseDouble(digits.data(), digits.data() + 3, &value),
+            digits.data() + 3);
+  EXPECT_EQ(value, 314.0);
+
+  const std::string invalid = "abc";
+  EXPECT_EQ(
+      ParseDouble(invalid.data(), invalid.data() + invalid.size(), &value),
+      nullptr);
+}
+
+TEST(TextParser, ParseDoubleMatchesStrtod) {
+  RandomNumberGenerator rng(53);
+  const char* formats[] = {"%.17g", "%.6f", "%g", "%.9e", "%.3f"};
+  char buffer[64];
+  for (int i = 0; i < 100000; i++) {
+    const double value =
+        rng.RandDouble(-1.0, 1.0) * std::pow(10.0, rng.RandInt(-30, 30));
+    snprintf(buffer, sizeof(buffer), formats[i % 5], value);
+    const std::string text(buffer);
+    EXPECT_EQ(ParseDoubleOrDie(text), std::strtod(buffer, nullptr)) << text;
+  }
+}
+
+TEST(TextParser, ParseInt) {
+  const std::string text = "42 -7 +3 2147483647 -2147483648 2147483648 x";
+  TextParser parser(text.data(), text.data() + text.size());
+  int value;
+  EXPECT_TRUE(parser.ParseInt(&value));
+  EXPECT_EQ(value, 42);
+  EXPECT_TRUE(parser.ParseInt(&value));
+  EXPECT_EQ(value, -7);
+  EXPECT_TRUE(parser.ParseInt(&value));
+  EXPECT_EQ(value, 3);
+  EXPECT_TRUE(parser.ParseInt(&value));
+  EXPECT_EQ(value, 2147483647);
+  EXPECT_TRUE(parser.ParseInt(&value));
+  EXPECT_EQ(value, -2147483647 - 1);
+  // Out of range.
+  EXPECT_FALSE(parser.ParseInt(&value));
+}
+
+TEST(TextParser, ParseTokensAndLines) {
+  const std::string text = "  name.jpg 1.5\n# comment\n\t7  \n\n";
+  TextParser parser(text.data(), text.data() + text.size());
+  std::string token;
+  EXPECT_TRUE(parser.ParseToken(&token));
+  EXPECT_EQ(token, "name.jpg");
+  float value;
+  EXPECT_TRUE(parser.ParseFloat(&value));
+  EXPECT_EQ(value, 1.5f);
+  parser.SkipLine();
+  parser.SkipLine();
+  int int_value;
+  EXPECT_TRUE(parser.ParseInt(&int_value));
+  EXPECT_EQ(int_value, 7);
+  EXPECT_TRUE(parser.AtEnd());
+  EXPECT_FALSE(parser.ParseToken(&token));
+  EXPECT_FALSE(parser.ParseInt(&int_value));
+
+  EXPECT_EQ(NumNonEmptyLines(text.data(), text.data() + text.size()), 3);
+}
+
+TEST(TextParser, FindLineRecords) {
+  const std::string text = "1 2\n3\n\n4 5\n6\n7 8\n";
+  std::vector<const char*> record_begins;
+  EXPECT_TRUE(FindLineRecords(
+      text.data(), text.data() + text.size(), 3, 2, &record_begins));
+  ASSERT_EQ(record_begins.size(), 4);
+  EXPECT_EQ(record_begins[0], text.data());
+  EXPECT_EQ(record_begins[1], text.data() + 7);
+  EXPECT_EQ(record_begins[2], text.data() + 13);
+  EXPECT_EQ(record_begins[3], text.data() + text.size());
+
+  EXPECT_FALSE(FindLineRecords(
+      text.data(), text.data() + text.size(), 4, 2, &record_begins));
+}
+
+TEST(TextParser, ParseRecordsInParallel) {
+  RandomNumberGenerator rng(59);
+  static const int kNumRecords = 5000;
+  std::string text;
+  std::vector<double> expected_sums(kNumRecords, 0.0);
+  for (int i = 0; i < kNumRecords; i++) {
+    const int num_values = rng.RandInt(0, 10);
+    text += std::to_string(num_values);
+    for (int j = 0; j < num_values; j++) {
+      const int value = rng.RandInt(0, 1000);
+      text += " " + std::to_string(value) + ".5";
+      expected_sums[i] += value + 0.5;
+    }
+    text += "\n";
+  }
+
+  std::vector<double> sums;
+  EXPECT_TRUE(ParseSumRecords(text, kNumRecords, 1, 4, &sums));
+  EXPECT_EQ(sums, expected_sums);
+  EXPECT_TRUE(ParseSumRecords(text, kNumRecords, 1, 1, &sums));
+  EXPECT_EQ(sums, expected_sums);
+
+  // Records that span several lines are parsed sequentially.
+  std::string wrapped_text = text;
+  for (int i = 0; i < wrapped_text.size(); i += 97) {
+    if (wrapped_text[i] == ' ') {
+      wrapped_text[i] = '\n';
+    }
+  }
+  EXPECT_TRUE(ParseSumRecords(wrapped_text, kNumRecords, 1, 4, &sums));
+  EXPECT_EQ(sums, expected_sums);
+
+  // Missing records.
+  EXPECT_FALSE(ParseSumRecords(text, kNumRecords + 1, 1, 4, &sums));
+}
+
+}  // namespace theia
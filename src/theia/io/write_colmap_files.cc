@@ -38,25 +38,100 @@
 #include <Eigen/Geometry>
 #include <fstream>  // NOLINT
 #include <glog/logging.h>
+#include <algorithm>
 #include <memory>
+#include <sstream>  // NOLINT
 #include <string>
 #include <unordered_map>
 #include <vector>
 
+#include "theia/io/colmap_camera_models.h"
+#include "theia/io/write_in_chunks.h"
 #include "theia/sfm/camera/camera.h"
-#include "theia/sfm/camera/camera_intrinsics_model.h"
-#include "theia/sfm/camera/pinhole_camera_model.h"
-#include "theia/sfm/camera_intrinsics_prior.h"
 #include "theia/sfm/reconstruction.h"
 #include "theia/sfm/reconstruction_estimator_utils.h"
 #include "theia/sfm/track.h"
 #include "theia/sfm/types.h"
 #include "theia/sfm/view.h"
+#include "theia/util/executor.h"
 #include "theia/util/map_util.h"
 
 namespace theia {
 namespace {
 
+// The images and points are formatted in chunks of this many items.
+static const int kNumItemsPerChunk = 1024;
+
+// The tracks observed by each view in increasing order. This is the order in
+// which the 2D points of the views are written, so the COLMAP index of an
+// observation is found with a binary search.
+class ViewObservations {
+ public:
+  ViewObservations(const Reconstruction& reconstruction,
+                   const std::vector<ViewId>& view_ids,
+                   const int num_threads)
+      : track_ids_(view_ids.size()) {
+    for (int i = 0; i < view_ids.size(); i++) {
+      view_indices_[view_ids[i]] = i;
+    }
+    ParallelFor(
+        num_threads, view_ids.size(), [&](const int begin, const int end) {
+          for (int i = begin; i < end; i++) {
+            track_ids_[i] = reconstruction.View(view_ids[i])->TrackIds();
+            std::sort(track_ids_[i].begin(), track_ids_[i].end());
+          }
+        });
+  }
+
+  const std::vector<TrackId>& TrackIds(const ViewId view_id) const {
+    return track_ids_[FindOrDie(view_indices_, view_id)];
+  }
+
+  uint32_t Point2DIndex(const ViewId view_id, const TrackId track_id) const {
+    const std::vector<TrackId>& track_ids = TrackIds(view_id);
+    return std::lower_bound(track_ids.begin(), track_ids.end(), track_id) -
+           track_ids.begin();
+  }
+
+ private:
+  std::unordered_map<ViewId, int> view_indices_;
+  std::vector<std::vector<TrackId> > track_ids_;
+};
+
+// The COLMAP pose of a camera, which is the rotation from world to camera
+// coordinates and the translation of the world origin in camera coordinates.
+void GetColmapPose(const Camera& camera,
+                   Eigen::Quaterniond* orientation,
+                   Eigen::Vector3d* translation) {
+  const Eigen::Matrix3d rotation = camera.GetOrientationAsRotationMatrix();
+  *orientation = Eigen::Quaterniond(rotation);
+  *translation = -rotation * camera.GetPosition();
+}
+
+bool GetColmapCamera(const Reconstruction& reconstruction,
+                     const CameraIntrinsicsGroupId group_id,
+                     ColmapCameraModel* model,
+                     std::vector<double>* parameters,
+                     const Camera** camera) {
+  const View* view = reconstruction.View(
+      *reconstruction.GetViewsInCameraIntrinsicGroup(group_id).begin());
+  *camera = &view->Camera();
+  if (!ColmapCameraFromCamera(**camera, model, parameters)) {
+    LOG(ERROR) << "Could not add camera " << view->Name()
+               << " to the COLMAP output file because COLMAP doesn't support "
+                  "its camera intrinsics model.";
+    return false;
+  }
+  return true;
+}
+
+// Appends the value to the buffer in the byte order of the machine. COLMAP
+// binary files are little-endian.
+template <typename T>
+void AppendBinary(const T& value, std::string* buffer) {
+  buffer->append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
 bool WriteCamerasFile(const Reconstruction& reconstruction,
                       const std::string& cameras_file) {
   std::ofstream ofs_cameras(cameras_file);
@@ -68,26 +143,20 @@ bool WriteCamerasFile(const Reconstruction& reconstruction,
   const auto& group_ids = reconstruction.CameraIntrinsicsGroupIds();
 
   for (auto group_id : group_ids) {
-    const View* view = reconstruction.View(
-        *reconstruction.GetViewsInCameraIntrinsicGroup(group_id).begin());
-    const Camera& camera = view->Camera();
-    if (camera.GetCameraIntrinsicsModelType() !=
-        CameraIntrinsicsModelType::PINHOLE) {
-      LOG(ERROR) << "Could not add camera " << view->Name()
-                 << " to the COLMAP output file because COLMAP doesn't support "
-                    "FOV or fisheye cameras.";
+    ColmapCameraModel model;
+    std::vector<double> parameters;
+    const Camera* camera;
+    if (!GetColmapCamera(
+            reconstruction, group_id, &model, &parameters, &camera)) {
       return false;
     }
 
-    const CameraIntrinsicsModel& intrinsics = *camera.CameraIntrinsics();
-    ofs_cameras
-        << group_id << " RADIAL " << camera.ImageWidth() << " "
-        << camera.ImageHeight() << " " << camera.FocalLength() << " "
-        << camera.PrincipalPointX() << " " << camera.PrincipalPointY() << " "
-        << intrinsics.GetParameter(PinholeCameraModel::RADIAL_DISTORTION_1)
-        << " "
-        << intrinsics.GetParameter(PinholeCameraModel::RADIAL_DISTORTION_1)
-        << std::endl;
+    ofs_cameras << group_id << " " << ColmapCameraModelName(model) << " "
+                << camera->ImageWidth() << " " << camera->ImageHeight();
+    for (const double parameter : parameters) {
+      ofs_cameras << " " << parameter;
+    }
+    ofs_cameras << std::endl;
   }
   ofs_cameras.close();
 
@@ -95,6 +164,9 @@ bool WriteCamerasFile(const Reconstruction& reconstruction,
 }
 
 bool WriteImagesFile(const Reconstruction& reconstruction,
+                     const std::vector<ViewId>& view_ids,
+                     const ViewObservations& observations,
+                     const int num_threads,
                      const std::string& images_file) {
   std::ofstream ofs_images(images_file);
 
@@ -103,32 +175,41 @@ bool WriteImagesFile(const Reconstruction& reconstruction,
     return false;
   }
 
-  for (auto view_id : reconstruction.ViewIds()) {
-    const View* view = reconstruction.View(view_id);
-    const Camera& camera = view->Camera();
-    const Eigen::Vector3d translation =
-        -camera.GetOrientationAsRotationMatrix() * camera.GetPosition();
-    const Eigen::Quaterniond orientation(
-        camera.GetOrientationAsRotationMatrix());
-    ofs_images << view_id << " " << orientation.w() << " " << orientation.x()
-               << " " << orientation.y() << " " << orientation.z() << " "
-               << translation.x() << " " << translation.y() << " "
-               << translation.z() << " "
-               << reconstruction.CameraIntrinsicsGroupIdFromViewId(view_id)
-               << " " << view->Name() << std::endl;
-    const auto& track_ids = view->TrackIds();
-    for (auto track_id : track_ids) {
-      auto feature = view->GetFeature(track_id);
-      ofs_images << feature->point_.x() << " " << feature->point_.y() << " "
-                 << track_id << " ";
+  const auto format_images = [&](const int begin,
+                                 const int end,
+                                 std::string* buffer) {
+    std::ostringstream ofs_chunk;
+    for (int i = begin; i < end; i++) {
+      const ViewId view_id = view_ids[i];
+      const View* view = reconstruction.View(view_id);
+      Eigen::Quaterniond orientation;
+      Eigen::Vector3d translation;
+      GetColmapPose(view->Camera(), &orientation, &translation);
+      ofs_chunk << view_id << " " << orientation.w() << " " << orientation.x()
+                << " " << orientation.y() << " " << orientation.z() << " "
+                << translation.x() << " " << translation.y() << " "
+                << translation.z() << " "
+                << reconstruction.CameraIntrinsicsGroupIdFromViewId(view_id)
+                << " " << view->Name() << std::endl;
+      for (const TrackId track_id : observations.TrackIds(view_id)) {
+        const Feature* feature = view->GetFeature(track_id);
+        ofs_chunk << feature->point_.x() << " " << feature->point_.y() << " "
+                  << track_id << " ";
+      }
+      ofs_chunk << std::endl;
     }
-    ofs_images << std::endl;
-  }
-  ofs_images.close();
-  return true;
+    *buffer = ofs_chunk.str();
+  };
+  return WriteInChunks(view_ids.size(),
+                       kNumItemsPerChunk,
+                       num_threads,
+                       format_images,
+                       &ofs_images);
 }
 
 bool WritePointsFile(const Reconstruction& reconstruction,
+                     const ViewObservations& observations,
+                     const int num_threads,
                      const std::string& points_file) {
   std::ofstream ofs_points(points_file);
   if (!ofs_points.is_open()) {
@@ -136,33 +217,170 @@ bool WritePointsFile(const Reconstruction& reconstruction,
     return false;
   }
 
-  for (auto track_id : reconstruction.TrackIds()) {
-    const Track* track = reconstruction.Track(track_id);
-    const Eigen::Vector3d point = track->Point().hnormalized();
-    const auto& color = track->Color();
-    ofs_points << track_id << " " << point.x() << " " << point.y() << " "
-               << point.z() << " " << static_cast<int>(color[0]) << " "
-               << static_cast<int>(color[1]) << " "
-               << static_cast<int>(color[2]) << " " << 0.0 << " ";
-    for (auto view_id : track->ViewIds()) {
+  const std::vector<TrackId> track_ids = reconstruction.TrackIds();
+  const auto format_points = [&](const int begin,
+                                 const int end,
+                                 std::string* buffer) {
+    std::ostringstream ofs_chunk;
+    for (int i = begin; i < end; i++) {
+      const TrackId track_id = track_ids[i];
+      const Track* track = reconstruction.Track(track_id);
+      const Eigen::Vector3d point = track->Point().hnormalized();
+      const auto& color = track->Color();
+      ofs_chunk << track_id << " " << point.x() << " " << point.y() << " "
+                << point.z() << " " << static_cast<int>(color[0]) << " "
+                << static_cast<int>(color[1]) << " "
+                << static_cast<int>(color[2]) << " " << 0.0 << " ";
+      for (const ViewId view_id : track->ViewIds()) {
+        ofs_chunk << view_id << " "
+                  << observations.Point2DIndex(view_id, track_id) << " ";
+      }
+      ofs_chunk << std::endl;
+    }
+    *buffer = ofs_chunk.str();
+  };
+  return WriteInChunks(track_ids.size(),
+                       kNumItemsPerChunk,
+                       num_threads,
+                       format_points,
+                       &ofs_points);
+}
+
+bool WriteCamerasBinaryFile(const Reconstruction& reconstruction,
+                            const std::string& cameras_file) {
+  std::ofstream ofs_cameras(cameras_file, std::ios::out | std::ios::binary);
+  if (!ofs_cameras.is_open()) {
+    LOG(ERROR) << "Cannot open the file: " << cameras_file << " for writing.";
+    return false;
+  }
+
+  const auto& group_ids = reconstruction.CameraIntrinsicsGroupIds();
+  std::string buffer;
+  AppendBinary<uint64_t>(group_ids.size(), &buffer);
+  for (const CameraIntrinsicsGroupId group_id : group_ids) {
+    ColmapCameraModel model;
+    std::vector<double> parameters;
+    const Camera* camera;
+    if (!GetColmapCamera(
+            reconstruction, group_id, &model, &parameters, &camera)) {
+      return false;
+    }
+
+    AppendBinary<uint32_t>(group_id, &buffer);
+    AppendBinary<int32_t>(static_cast<int32_t>(model), &buffer);
+    AppendBinary<uint64_t>(camera->ImageWidth(), &buffer);
+    AppendBinary<uint64_t>(camera->ImageHeight(), &buffer);
+    for (const double parameter : parameters) {
+      AppendBinary(parameter, &buffer);
+    }
+  }
+  ofs_cameras.write(buffer.data(), buffer.size());
+  return ofs_cameras.good();
+}
+
+bool WriteImagesBinaryFile(const Reconstruction& reconstruction,
+                           const std::vector<ViewId>& view_ids,
+                           const ViewObservations& observations,
+                           const int num_threads,
+                           const std::string& images_file) {
+  std::ofstream ofs_images(images_file, std::ios::out | std::ios::binary);
+  if (!ofs_images.is_open()) {
+    LOG(ERROR) << "Cannot open the file: " << images_file << " for writing.";
+    return false;
+  }
+
+  const uint64_t num_images = view_ids.size();
+  ofs_images.write(reinterpret_cast<const char*>(&num_images),
+                   sizeof(num_images));
+  const auto format_images = [&](const int begin,
+                                 const int end,
+                                 std::string* buffer) {
+    for (int i = begin; i < end; i++) {
+      const ViewId view_id = view_ids[i];
       const View* view = reconstruction.View(view_id);
-      const auto& track_ids = view->TrackIds();
-      const int point_index =
-          std::find(track_ids.begin(), track_ids.end(), track_id) -
-          track_ids.begin();
-      ofs_points << view_id << " " << point_index << " ";
+      Eigen::Quaterniond orientation;
+      Eigen::Vector3d translation;
+      GetColmapPose(view->Camera(), &orientation, &translation);
+      AppendBinary<uint32_t>(view_id, buffer);
+      AppendBinary(orientation.w(), buffer);
+      AppendBinary(orientation.x(), buffer);
+      AppendBinary(orientation.y(), buffer);
+      AppendBinary(orientation.z(), buffer);
+      AppendBinary(translation.x(), buffer);
+      AppendBinary(translation.y(), buffer);
+      AppendBinary(translation.z(), buffer);
+      AppendBinary<uint32_t>(
+          reconstruction.CameraIntrinsicsGroupIdFromViewId(view_id), buffer);
+      buffer->append(view->Name().c_str(), view->Name().size() + 1);
+
+      const std::vector<TrackId>& track_ids = observations.TrackIds(view_id);
+      AppendBinary<uint64_t>(track_ids.size(), buffer);
+      for (const TrackId track_id : track_ids) {
+        const Feature* feature = view->GetFeature(track_id);
+        AppendBinary(feature->point_.x(), buffer);
+        AppendBinary(feature->point_.y(), buffer);
+        AppendBinary<uint64_t>(track_id, buffer);
+      }
     }
-    ofs_points << std::endl;
+  };
+  return WriteInChunks(view_ids.size(),
+                       kNumItemsPerChunk,
+                       num_threads,
+                       format_images,
+                       &ofs_images);
+}
+
+bool WritePointsBinaryFile(const Reconstruction& reconstruction,
+                           const ViewObservations& observations,
+                           const int num_threads,
+                           const std::string& points_file) {
+  std::ofstream ofs_points(points_file, std::ios::out | std::ios::binary);
+  if (!ofs_points.is_open()) {
+    LOG(ERROR) << "Cannot open the file: " << points_file << " for writing.";
+    return false;
   }
 
-  ofs_points.close();
-  return true;
+  const std::vector<TrackId> track_ids = reconstruction.TrackIds();
+  const uint64_t num_points = track_ids.size();
+  ofs_points.write(reinterpret_cast<const char*>(&num_points),
+                   sizeof(num_points));
+  const auto format_points = [&](const int begin,
+                                 const int end,
+                                 std::string* buffer) {
+    for (int i = begin; i < end; i++) {
+      const TrackId track_id = track_ids[i];
+      const Track* track = reconstruction.Track(track_id);
+      const Eigen::Vector3d point = track->Point().hnormalized();
+      const auto& color = track->Color();
+      AppendBinary<uint64_t>(track_id, buffer);
+      AppendBinary(point.x(), buffer);
+      AppendBinary(point.y(), buffer);
+      AppendBinary(point.z(), buffer);
+      AppendBinary(color[0], buffer);
+      AppendBinary(color[1], buffer);
+      AppendBinary(color[2], buffer);
+      // The reprojection error is not stored in the reconstruction.
+      AppendBinary(0.0, buffer);
+      AppendBinary<uint64_t>(track->NumViews(), buffer);
+      for (const ViewId view_id : track->ViewIds()) {
+        AppendBinary<uint32_t>(view_id, buffer);
+        AppendBinary<uint32_t>(observations.Point2DIndex(view_id, track_id),
+                               buffer);
+      }
+    }
+  };
+  return WriteInChunks(track_ids.size(),
+                       kNumItemsPerChunk,
+                       num_threads,
+                       format_points,
+                       &ofs_points);
 }
 
 }  // namespace
 
 bool WriteColmapFiles(const Reconstruction& reconstruction,
-                      const std::string& output_directory) {
+                      const std::string& output_directory,
+                      const int num_threads) {
   Reconstruction estimated_reconstruction;
   CreateEstimatedSubreconstruction(reconstruction, &estimated_reconstruction);
 
@@ -170,13 +388,51 @@ bool WriteColmapFiles(const Reconstruction& reconstruction,
   const std::string& images_file = output_directory + "/images.txt";
   const std::string& points_file = output_directory + "/points3D.txt";
 
+  const std::vector<ViewId> view_ids = estimated_reconstruction.ViewIds();
+  const ViewObservations observations(
+      estimated_reconstruction, view_ids, AvailableNumThreads(num_threads));
   if (!WriteCamerasFile(estimated_reconstruction, cameras_file)) {
     return false;
   }
-  if (!WriteImagesFile(estimated_reconstruction, images_file)) {
+  if (!WriteImagesFile(estimated_reconstruction,
+                       view_ids,
+                       observations,
+                       num_threads,
+                       images_file)) {
+    return false;
+  }
+  if (!WritePointsFile(
+          estimated_reconstruction, observations, num_threads, points_file)) {
+    return false;
+  }
+  return true;
+}
+
+bool WriteColmapBinaryFiles(const Reconstruction& reconstruction,
+                            const std::string& output_directory,
+                            const int num_threads) {
+  Reconstruction estimated_reconstruction;
+  CreateEstimatedSubreconstruction(reconstruction, &estimated_reconstruction);
+
+  const std::string& cameras_file = output_directory + "/cameras.bin";
+  const std::string& images_file = output_directory + "/images.bin";
+  const std::string& points_file = output_directory + "/points3D.bin";
+
+  const std::vector<ViewId> view_ids = estimated_reconstruction.ViewIds();
+  const ViewObservations observations(
+      estimated_reconstruction, view_ids, AvailableNumThreads(num_threads));
+  if (!WriteCamerasBinaryFile(estimated_reconstruction, cameras_file)) {
+    return false;
+  }
+  if (!WriteImagesBinaryFile(estimated_reconstruction,
+                             view_ids,
+                             observations,
+                             num_threads,
+                             images_file)) {
     return false;
   }
-  if (!WritePointsFile(estimated_reconstruction, points_file)) {
+  if (!WritePointsBinaryFile(
+          estimated_reconstruction, observations, num_threads, points_file)) {
     return false;
   }
   return true;
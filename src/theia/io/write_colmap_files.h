@@ -49,8 +49,21 @@ class Reconstruction;
 //       information.
 //   output_directory: The directory to which the COLMAP text files will be
 //   written. This includes three files: cameras.txt, images.txt, points3D.txt
+//   num_threads: The number of threads used to format the images and points.
+//
+// Only the estimated views and tracks are written. The camera ids are the
+// camera intrinsics group ids, and the image and point ids are the view and
+// track ids. See colmap_camera_models.h for how the cameras are converted.
 bool WriteColmapFiles(const Reconstruction& reconstruction,
-                      const std::string& output_directory);
+                      const std::string& output_directory,
+                      const int num_threads = 1);
+
+// Writes the reconstruction into the COLMAP binary format as in
+// WriteColmapFiles. The files are cameras.bin, images.bin and points3D.bin,
+// which are much smaller and faster to write and read than the text files.
+bool WriteColmapBinaryFiles(const Reconstruction& reconstruction,
+                            const std::string& output_directory,
+                            const int num_threads = 1);
 
 }  // namespace theia
 
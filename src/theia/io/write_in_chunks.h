@@ -0,0 +1,85 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#ifndef THEIA_IO_WRITE_IN_CHUNKS_H_
+#define THEIA_IO_WRITE_IN_CHUNKS_H_
+
+#include <algorithm>
+#include <fstream>  // NOLINT
+#include <string>
+#include <vector>
+
+#include "theia/util/executor.h"
+
+namespace theia {
+
+// Formats the items [0, num_items) in chunks of num_items_per_chunk items with
+// format_chunk(begin, end, &buffer) and writes the chunks in order. The chunks
+// are formatted in parallel in batches, so that only a few chunks per thread
+// are held in memory at a time. Returns false if writing failed.
+template <class FormatFunction>
+bool WriteInChunks(const int num_items,
+                   const int num_items_per_chunk,
+                   const int num_threads,
+                   const FormatFunction& format_chunk,
+                   std::ofstream* ofs) {
+  const int num_chunks =
+      (num_items + num_items_per_chunk - 1) / num_items_per_chunk;
+  const int num_formatting_threads = AvailableNumThreads(num_threads);
+  const int batch_size = 4 * num_formatting_threads;
+  for (int batch_start = 0; batch_start < num_chunks;
+       batch_start += batch_size) {
+    const int batch_end = std::min(batch_start + batch_size, num_chunks);
+    std::vector<std::string> buffers(batch_end - batch_start);
+    ParallelFor(num_formatting_threads,
+                buffers.size(),
+                [&](const int begin, const int end) {
+                  for (int i = begin; i < end; i++) {
+                    const int first_item =
+                        (batch_start + i) * num_items_per_chunk;
+                    const int last_item =
+                        std::min(first_item + num_items_per_chunk, num_items);
+                    format_chunk(first_item, last_item, &buffers[i]);
+                  }
+                });
+    for (const std::string& buffer : buffers) {
+      ofs->write(buffer.data(), buffer.size());
+    }
+  }
+  return ofs->good();
+}
+
+}  // namespace theia
+
+#endif  // THEIA_IO_WRITE_IN_CHUNKS_H_
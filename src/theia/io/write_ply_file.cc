@@ -34,93 +34,250 @@
 
 #include "theia/io/write_ply_file.h"
 
-#include <fstream>  // NOLINT
+#include <Eigen/Core>
 #include <glog/logging.h>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>  // NOLINT
+#include <sstream>  // NOLINT
 #include <string>
 #include <vector>
 
+#include "theia/io/write_in_chunks.h"
 #include "theia/sfm/reconstruction.h"
+#include "theia/util/executor.h"
 
 namespace theia {
+namespace {
+
+// The vertices are formatted in chunks of this many vertices, which is about
+// 1MB of binary output.
+static const int kNumVerticesPerChunk = 65536;
+
+// The size of a binary vertex: three floats followed by three uchars.
+static const int kBinaryVertexSize = 3 * sizeof(float) + 3 * sizeof(uint8_t);
+
+struct PlyVertex {
+  Eigen::Vector3f point;
+  Eigen::Matrix<uint8_t, 3, 1> color;
+};
+
+bool IsLittleEndian() {
+  const uint16_t one = 1;
+  return *reinterpret_cast<const uint8_t*>(&one) == 1;
+}
+
+PlyVertex TrackVertex(const Track& track) {
+  PlyVertex vertex;
+  vertex.point = track.Point().hnormalized().cast<float>();
+  vertex.color = track.Color();
+  return vertex;
+}
 
-// Gather points from tracks.
-void GatherTracks(const Reconstruction& reconstruction,
-                  std::vector<Eigen::Vector3d>* points_to_write,
-                  std::vector<Eigen::Vector3i>* colors_to_write) {
+// Returns the estimated tracks with enough observations.
+std::vector<TrackId> SelectTracks(const Reconstruction& reconstruction,
+                                  const int min_num_observations_per_point) {
+  std::vector<TrackId> track_ids;
+  track_ids.reserve(reconstruction.NumTracks());
   for (const TrackId track_id : reconstruction.TrackIds()) {
     const Track& track = *reconstruction.Track(track_id);
-    points_to_write->emplace_back(track.Point().hnormalized());
-    colors_to_write->emplace_back(
-        track.Color()[0], track.Color()[1], track.Color()[2]);
+    if (track.IsEstimated() &&
+        track.NumViews() >= min_num_observations_per_point) {
+      track_ids.emplace_back(track_id);
+    }
+  }
+  return track_ids;
+}
+
+// Replaces the points in each occupied voxel of the grid by their mean
+// position and color. The voxels are found by sorting the points by their
+// voxel coordinates, so the output does not depend on the number of threads.
+std::vector<PlyVertex> DecimatePoints(const Reconstruction& reconstruction,
+                                      const std::vector<TrackId>& track_ids,
+                                      const double voxel_size,
+                                      const int num_threads) {
+  typedef std::pair<std::array<int64_t, 3>, int> VoxelAndIndex;
+  std::vector<Eigen::Vector3d> points(track_ids.size());
+  std::vector<VoxelAndIndex> voxels(track_ids.size());
+  std::vector<char> is_finite(track_ids.size());
+  ParallelFor(
+      num_threads, track_ids.size(), [&](const int begin, const int end) {
+        for (int i = begin; i < end; i++) {
+          points[i] = reconstruction.Track(track_ids[i])->Point().hnormalized();
+          is_finite[i] = points[i].allFinite();
+          voxels[i].second = i;
+          for (int j = 0; j < 3; j++) {
+            voxels[i].first[j] =
+                is_finite[i] ? static_cast<int64_t>(
+                                   std::floor(points[i][j] / voxel_size))
+                             : 0;
+          }
+        }
+      });
+
+  // Points at infinity do not belong to any voxel.
+  voxels.erase(std::remove_if(voxels.begin(),
+                              voxels.end(),
+                              [&](const VoxelAndIndex& voxel) {
+                                return !is_finite[voxel.second];
+                              }),
+               voxels.end());
+  std::sort(voxels.begin(), voxels.end());
+
+  std::vector<PlyVertex> vertices;
+  for (int begin = 0; begin < voxels.size();) {
+    int end = begin + 1;
+    while (end < voxels.size() && voxels[end].first == voxels[begin].first) {
+      ++end;
+    }
+
+    Eigen::Vector3d point_sum = Eigen::Vector3d::Zero();
+    Eigen::Vector3d color_sum = Eigen::Vector3d::Zero();
+    for (int i = begin; i < end; i++) {
+      const int index = voxels[i].second;
+      point_sum += points[index];
+      color_sum +=
+          reconstruction.Track(track_ids[index])->Color().cast<double>();
+    }
+    PlyVertex vertex;
+    vertex.point = (point_sum / (end - begin)).cast<float>();
+    vertex.color = (color_sum / (end - begin))
+                       .array()
+                       .round()
+                       .cast<uint8_t>()
+                       .matrix();
+    vertices.emplace_back(vertex);
+    begin = end;
   }
+  return vertices;
 }
 
 // Gather camera positions.
-void GatherCameras(const Reconstruction& reconstruction,
-                   const Eigen::Vector3i& camera_color,
-                   std::vector<Eigen::Vector3d>* points_to_write,
-                   std::vector<Eigen::Vector3i>* colors_to_write) {
+std::vector<PlyVertex> GatherCameras(const Reconstruction& reconstruction,
+                                     const Eigen::Vector3i& camera_color) {
+  std::vector<PlyVertex> vertices;
   for (const ViewId view_id : reconstruction.ViewIds()) {
     const View& view = *reconstruction.View(view_id);
     if (!view.IsEstimated()) {
       continue;
     }
-    points_to_write->emplace_back(view.Camera().GetPosition());
-    colors_to_write->emplace_back(camera_color);
+    PlyVertex vertex;
+    vertex.point = view.Camera().GetPosition().cast<float>();
+    vertex.color = camera_color.cast<uint8_t>();
+    vertices.emplace_back(vertex);
   }
+  return vertices;
 }
 
-// Writes a PLY file for viewing in software such as MeshLab.
+void AppendBinaryVertex(const PlyVertex& vertex, char* buffer) {
+  std::memcpy(buffer, vertex.point.data(), 3 * sizeof(float));
+  std::memcpy(buffer + 3 * sizeof(float), vertex.color.data(), 3);
+}
+
+void AppendAsciiVertex(const PlyVertex& vertex, std::ostringstream* stream) {
+  *stream << vertex.point.x() << " " << vertex.point.y() << " "
+          << vertex.point.z() << " " << static_cast<int>(vertex.color[0])
+          << " " << static_cast<int>(vertex.color[1]) << " "
+          << static_cast<int>(vertex.color[2]) << "\n";
+}
+
+}  // namespace
+
 bool WritePlyFile(const std::string& ply_file,
-                  const Reconstruction& const_reconstruction,
-                  const Eigen::Vector3i& camera_color,
-                  const int min_num_observations_per_point) {
+                  const Reconstruction& reconstruction,
+                  const WritePlyFileOptions& options) {
   CHECK_GT(ply_file.length(), 0);
 
   // Return false if the file cannot be opened for writing.
-  std::ofstream ply_writer(ply_file, std::ofstream::out);
+  std::ofstream ply_writer(ply_file,
+                           std::ofstream::out | std::ofstream::binary);
   if (!ply_writer.is_open()) {
     LOG(ERROR) << "Could not open the file: " << ply_file
                << " for writing a PLY file.";
     return false;
   }
 
-  // First, remove any points that are unestimated or do not have enough 3D
-  // points.
-  Reconstruction reconstruction = const_reconstruction;
-  const auto& track_ids = reconstruction.TrackIds();
-  for (const TrackId track_id : track_ids) {
-    const Track& track = *reconstruction.Track(track_id);
-    if (!track.IsEstimated() ||
-        track.NumViews() < min_num_observations_per_point) {
-      reconstruction.RemoveTrack(track_id);
-    }
+  // The points are read directly from the tracks unless they are decimated.
+  const std::vector<TrackId> track_ids =
+      SelectTracks(reconstruction, options.min_num_observations_per_point);
+  std::vector<PlyVertex> decimated_points;
+  const bool decimate = options.voxel_size > 0.0;
+  if (decimate) {
+    decimated_points = DecimatePoints(
+        reconstruction, track_ids, options.voxel_size, options.num_threads);
   }
+  const int num_points = decimate ? decimated_points.size() : track_ids.size();
+  const std::vector<PlyVertex> cameras =
+      GatherCameras(reconstruction, options.camera_color);
+  const auto get_vertex = [&](const int i) {
+    if (i >= num_points) {
+      return cameras[i - num_points];
+    }
+    return decimate ? decimated_points[i]
+                    : TrackVertex(*reconstruction.Track(track_ids[i]));
+  };
+  const int num_vertices = num_points + cameras.size();
 
-  // Extract points that we will write to the PLY file.
-  std::vector<Eigen::Vector3d> points_to_write;
-  std::vector<Eigen::Vector3i> colors_to_write;
-  GatherTracks(reconstruction, &points_to_write, &colors_to_write);
-  GatherCameras(
-      reconstruction, camera_color, &points_to_write, &colors_to_write);
-
+  const std::string format =
+      !options.binary
+          ? "ascii"
+          : (IsLittleEndian() ? "binary_little_endian" : "binary_big_endian");
   ply_writer << "ply" << '\n'
-             << "format ascii 1.0" << '\n'
-             << "element vertex " << points_to_write.size() << '\n'
+             << "format " << format << " 1.0" << '\n'
+             << "element vertex " << num_vertices << '\n'
              << "property float x" << '\n'
              << "property float y" << '\n'
              << "property float z" << '\n'
              << "property uchar red" << '\n'
              << "property uchar green" << '\n'
              << "property uchar blue" << '\n'
-             << "end_header" << std::endl;
+             << "end_header" << '\n';
 
-  for (int i = 0; i < points_to_write.size(); i++) {
-    ply_writer << points_to_write[i].transpose() << " "
-               << colors_to_write[i].transpose() << "\n";
+  if (options.binary) {
+    const auto format_vertices = [&](const int begin,
+                                     const int end,
+                                     std::string* buffer) {
+      buffer->resize((end - begin) * kBinaryVertexSize);
+      for (int i = begin; i < end; i++) {
+        AppendBinaryVertex(get_vertex(i),
+                           &(*buffer)[(i - begin) * kBinaryVertexSize]);
+      }
+    };
+    return WriteInChunks(num_vertices,
+                         kNumVerticesPerChunk,
+                         options.num_threads,
+                         format_vertices,
+                         &ply_writer);
   }
 
-  return true;
+  const auto format_vertices = [&](const int begin,
+                                   const int end,
+                                   std::string* buffer) {
+    std::ostringstream stream;
+    for (int i = begin; i < end; i++) {
+      AppendAsciiVertex(get_vertex(i), &stream);
+    }
+    *buffer = stream.str();
+  };
+  return WriteInChunks(num_vertices,
+                       kNumVerticesPerChunk,
+                       options.num_threads,
+                       format_vertices,
+                       &ply_writer);
+}
+
+bool WritePlyFile(const std::string& ply_file,
+                  const Reconstruction& reconstruction,
+                  const Eigen::Vector3i& camera_color,
+                  const int min_num_observations_per_point) {
+  WritePlyFileOptions options;
+  options.camera_color = camera_color;
+  options.min_num_observations_per_point = min_num_observations_per_point;
+  options.binary = false;
+  return WritePlyFile(ply_file, reconstruction, options);
 }
 
 }  // namespace theia
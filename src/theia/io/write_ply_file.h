@@ -42,7 +42,36 @@ namespace theia {
 
 class Reconstruction;
 
-// Writes a PLY file for viewing in software such as MeshLab.
+struct WritePlyFileOptions {
+  // The color of the camera positions.
+  Eigen::Vector3i camera_color = Eigen::Vector3i(0, 255, 0);
+
+  // Only estimated points that are observed by at least this many views are
+  // written.
+  int min_num_observations_per_point = 2;
+
+  // If true, the vertices are written in the binary PLY format, which is about
+  // 5x smaller than the ASCII format and much faster to write and parse.
+  bool binary = true;
+
+  // If positive, the points are decimated on a voxel grid with this cell size
+  // and each occupied voxel is written as the mean position and color of its
+  // points. This is useful for light-weight previews of large models. Camera
+  // positions are never decimated.
+  double voxel_size = 0.0;
+
+  // The number of threads used to decimate and, for ASCII files, to format the
+  // vertices.
+  int num_threads = 1;
+};
+
+// Writes a PLY file for viewing in software such as MeshLab. The vertices are
+// the 3D points followed by the positions of the estimated cameras.
+bool WritePlyFile(const std::string& ply_file,
+                  const Reconstruction& reconstruction,
+                  const WritePlyFileOptions& options);
+
+// Writes an ASCII PLY file without decimation.
 bool WritePlyFile(const std::string& ply_file,
                   const Reconstruction& reconstruction,
                   const Eigen::Vector3i& camera_color,
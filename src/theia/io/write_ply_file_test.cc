@@ -0,0 +1,234 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#include <Eigen/Core>
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>  // NOLINT
+#include <sstream>  // NOLINT
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "theia/io/write_ply_file.h"
+#include "theia/sfm/reconstruction.h"
+#include "theia/sfm/track.h"
+#include "theia/sfm/view.h"
+#include "theia/util/random.h"
+
+namespace theia {
+
+namespace {
+
+static const int kNumTracks = 1000;
+
+struct Vertex {
+  Eigen::Vector3f point;
+  Eigen::Vector3i color;
+};
+
+std::string TestFile(const std::string& name) {
+  return testing::internal::TempDir() + name;
+}
+
+// Builds a reconstruction with an estimated and an unestimated view and with
+// tracks in the unit cube. Every third track is observed by only one view and
+// every fifth track is not estimated.
+void BuildReconstruction(Reconstruction* reconstruction) {
+  RandomNumberGenerator rng(59);
+  const ViewId view_0 = reconstruction->AddView("view_0.jpg", 0);
+  const ViewId view_1 = reconstruction->AddView("view_1.jpg", 1);
+  reconstruction->MutableView(view_0)->SetEstimated(true);
+  reconstruction->MutableView(view_0)->MutableCamera()->SetPosition(
+      Eigen::Vector3d(0.5, 0.5, -2.0));
+
+  for (int i = 0; i < kNumTracks; i++) {
+    const TrackId track_id = reconstruction->AddTrack();
+    reconstruction->AddObservation(view_0, track_id, Feature(i, i));
+    if (i % 3 != 0) {
+      reconstruction->AddObservation(view_1, track_id, Feature(i, i));
+    }
+    Track* track = reconstruction->MutableTrack(track_id);
+    Eigen::Vector3d point;
+    rng.SetRandom(&point);
+    track->SetPoint((0.5 * point.array() + 0.5).matrix().homogeneous());
+    *track->MutableColor() << 10 * (i % 20), 20, 30;
+    track->SetEstimated(i % 5 != 0);
+  }
+}
+
+// Reads the header and the vertices of a PLY file written by WritePlyFile.
+void ReadPlyFile(const std::string& ply_file,
+                 std::string* format,
+                 std::vector<Vertex>* vertices) {
+  std::ifstream ifs(ply_file, std::ifstream::in | std::ifstream::binary);
+  ASSERT_TRUE(ifs.is_open());
+  std::string line;
+  int num_vertices = 0;
+  while (std::getline(ifs, line) && line != "end_header") {
+    std::istringstream stream(line);
+    std::string keyword;
+    stream >> keyword;
+    if (keyword == "format") {
+      stream >> *format;
+    } else if (keyword == "element") {
+      std::string element;
+      stream >> element >> num_vertices;
+    }
+  }
+
+  vertices->resize(num_vertices);
+  for (Vertex& vertex : *vertices) {
+    if (*format == "ascii") {
+      ifs >> vertex.point.x() >> vertex.point.y() >> vertex.point.z() >>
+          vertex.color.x() >> vertex.color.y() >> vertex.color.z();
+    } else {
+      char buffer[15];
+      ifs.read(buffer, sizeof(buffer));
+      std::memcpy(vertex.point.data(), buffer, 3 * sizeof(float));
+      for (int i = 0; i < 3; i++) {
+        vertex.color[i] = static_cast<uint8_t>(buffer[12 + i]);
+      }
+    }
+  }
+  ASSERT_TRUE(ifs.good());
+  // There must not be any trailing data.
+  if (*format == "ascii") {
+    ifs >> std::ws;
+  }
+  ifs.get();
+  EXPECT_TRUE(ifs.eof());
+}
+
+int NumExpectedPoints(const Reconstruction& reconstruction) {
+  int num_points = 0;
+  for (const TrackId track_id : reconstruction.TrackIds()) {
+    const Track* track = reconstruction.Track(track_id);
+    if (track->IsEstimated() && track->NumViews() >= 2) {
+      ++num_points;
+    }
+  }
+  return num_points;
+}
+
+}  // namespace
+
+TEST(WritePlyFile, BinaryAndAsciiFilesMatch) {
+  Reconstruction reconstruction;
+  BuildReconstruction(&reconstruction);
+
+  WritePlyFileOptions options;
+  options.camera_color = Eigen::Vector3i(0, 255, 0);
+  options.num_threads = 4;
+  options.binary = true;
+  const std::string binary_file = TestFile("binary.ply");
+  EXPECT_TRUE(WritePlyFile(binary_file, reconstruction, options));
+  options.binary = false;
+  const std::string ascii_file = TestFile("ascii.ply");
+  EXPECT_TRUE(WritePlyFile(ascii_file, reconstruction, options));
+
+  std::string binary_format, ascii_format;
+  std::vector<Vertex> binary_vertices, ascii_vertices;
+  ReadPlyFile(binary_file, &binary_format, &binary_vertices);
+  ReadPlyFile(ascii_file, &ascii_format, &ascii_vertices);
+  EXPECT_EQ(binary_format.find("binary_"), 0);
+  EXPECT_EQ(ascii_format, "ascii");
+
+  // All the points with enough observations and the estimated camera.
+  const int num_points = NumExpectedPoints(reconstruction);
+  ASSERT_EQ(binary_vertices.size(), num_points + 1);
+  ASSERT_EQ(ascii_vertices.size(), binary_vertices.size());
+  for (int i = 0; i < binary_vertices.size(); i++) {
+    EXPECT_TRUE(binary_vertices[i].point.isApprox(ascii_vertices[i].point,
+                                                  1e-5f));
+    EXPECT_TRUE(binary_vertices[i].color == ascii_vertices[i].color);
+  }
+  EXPECT_TRUE(binary_vertices.back().point == Eigen::Vector3f(0.5, 0.5, -2.0));
+  EXPECT_TRUE(binary_vertices.back().color == Eigen::Vector3i(0, 255, 0));
+
+  // The legacy overload writes the same ASCII file.
+  const std::string legacy_file = TestFile("legacy.ply");
+  EXPECT_TRUE(WritePlyFile(
+      legacy_file, reconstruction, Eigen::Vector3i(0, 255, 0), 2));
+  std::string legacy_format;
+  std::vector<Vertex> legacy_vertices;
+  ReadPlyFile(legacy_file, &legacy_format, &legacy_vertices);
+  EXPECT_EQ(legacy_format, "ascii");
+  EXPECT_EQ(legacy_vertices.size(), ascii_vertices.size());
+}
+
+TEST(WritePlyFile, VoxelDecimation) {
+  Reconstruction reconstruction;
+  BuildReconstruction(&reconstruction);
+
+  WritePlyFileOptions options;
+  options.voxel_size = 0.5;
+  options.num_threads = 4;
+  const std::string ply_file = TestFile("decimated.ply");
+  EXPECT_TRUE(WritePlyFile(ply_file, reconstruction, options));
+
+  std::string format;
+  std::vector<Vertex> vertices;
+  ReadPlyFile(ply_file, &format, &vertices);
+
+  // The points lie in the unit cube, so there are at most 8 voxels, plus the
+  // camera which is not decimated.
+  ASSERT_GT(vertices.size(), 1);
+  EXPECT_LE(vertices.size(), 8 + 1);
+  for (int i = 0; i + 1 < vertices.size(); i++) {
+    EXPECT_GE(vertices[i].point.minCoeff(), 0.0f);
+    EXPECT_LE(vertices[i].point.maxCoeff(), 1.0f);
+    EXPECT_EQ(vertices[i].color.y(), 20);
+    EXPECT_EQ(vertices[i].color.z(), 30);
+  }
+  EXPECT_TRUE(vertices.back().point == Eigen::Vector3f(0.5, 0.5, -2.0));
+
+  // A single voxel averages all points.
+  options.voxel_size = 10.0;
+  EXPECT_TRUE(WritePlyFile(ply_file, reconstruction, options));
+  ReadPlyFile(ply_file, &format, &vertices);
+  EXPECT_EQ(vertices.size(), 2);
+}
+
+TEST(WritePlyFile, CannotOpenFile) {
+  Reconstruction reconstruction;
+  BuildReconstruction(&reconstruction);
+  EXPECT_FALSE(WritePlyFile(TestFile("missing_directory/points.ply"),
+                            reconstruction,
+                            WritePlyFileOptions()));
+}
+
+}  // namespace theia
@@ -37,32 +37,60 @@
 #include <Eigen/Core>
 #include <algorithm>
 #include <glog/logging.h>
+#include <stdint.h>
 #include <vector>
 
 #include "theia/matching/distance.h"
 #include "theia/matching/feature_matcher_utils.h"
 #include "theia/matching/indexed_feature_match.h"
+#include "theia/matching/keypoints_and_descriptors.h"
+#include "theia/util/arena.h"
 
 namespace theia {
-
 bool BruteForceFeatureMatcher::MatchImagePair(
     const KeypointsAndDescriptors& features1,
     const KeypointsAndDescriptors& features2,
     std::vector<IndexedFeatureMatch>* matches) {
-  const std::vector<Eigen::VectorXf>& descriptors1 = features1.descriptors;
-  const std::vector<Eigen::VectorXf>& descriptors2 = features2.descriptors;
-  matches->reserve(descriptors1.size());
+  if (features1.HasBinaryDescriptors() && features2.HasBinaryDescriptors()) {
+    return MatchImagePairBinary(features1, features2, matches);
+  }
+  if (features1.HasQuantizedDescriptors() &&
+      features2.HasQuantizedDescriptors()) {
+    return MatchImagePairQuantized(features1, features2, matches);
+  }
+
+  if (this->options_.use_blocked_brute_force_matching) {
+    return MatchImagePairBlocked(features1, features2, matches);
+  }
+
+  const int num_descriptors1 = features1.NumDescriptors();
+  const int num_descriptors2 = features2.NumDescriptors();
+  if (num_descriptors1 == 0 || num_descriptors2 == 0) {
+    return false;
+  }
+  matches->reserve(num_descriptors1);
 
   const double sq_lowes_ratio =
       this->options_.lowes_ratio * this->options_.lowes_ratio;
 
+  // The scratch buffers are allocated from the arena of the thread, which is
+  // rewound once the pair is matched.
+  ArenaScope arena_scope(ThreadLocalArena());
+  const ArenaAllocator<IndexedFeatureMatch> allocator(arena_scope.arena());
+
   // Compute forward matches.
   L2 distance;
-  std::vector<IndexedFeatureMatch> temp_matches(descriptors2.size());
-  for (int i = 0; i < descriptors1.size(); i++) {
-    for (int j = 0; j < descriptors2.size(); j++) {
-      temp_matches[j] =
-          IndexedFeatureMatch(i, j, distance(descriptors1[i], descriptors2[j]));
+  const int descriptor_dimension = features1.DescriptorDimension();
+  ArenaVector<IndexedFeatureMatch> temp_matches(num_descriptors2, allocator);
+  for (int i = 0; i < num_descriptors1; i++) {
+    const float* descriptor1 = features1.descriptor_matrix.row(i).data();
+    for (int j = 0; j < num_descriptors2; j++) {
+      temp_matches[j] = IndexedFeatureMatch(
+          i,
+          j,
+          distance(descriptor1,
+                   features2.descriptor_matrix.row(j).data(),
+                   descriptor_dimension));
     }
 
     // Get the lowest distance matches.
@@ -85,13 +113,19 @@ bool BruteForceFeatureMatcher::MatchImagePair(
 
   // Compute the symmetric matches, if applicable.
   if (this->options_.keep_only_symmetric_matches) {
-    std::vector<IndexedFeatureMatch> reverse_matches;
-    temp_matches.resize(descriptors1.size());
+    ArenaVector<IndexedFeatureMatch> reverse_matches(allocator);
+    reverse_matches.reserve(num_descriptors2);
+    temp_matches.resize(num_descriptors1);
     // Only compute the distances for the valid matches.
-    for (int i = 0; i < descriptors2.size(); i++) {
-      for (int j = 0; j < descriptors1.size(); j++) {
+    for (int i = 0; i < num_descriptors2; i++) {
+      const float* descriptor2 = features2.descriptor_matrix.row(i).data();
+      for (int j = 0; j < num_descriptors1; j++) {
         temp_matches[j] = IndexedFeatureMatch(
-            i, j, distance(descriptors2[i], descriptors1[j]));
+            i,
+            j,
+            distance(descriptor2,
+                     features1.descriptor_matrix.row(j).data(),
+                     descriptor_dimension));
       }
 
       // Get the lowest distance matches.
@@ -114,4 +148,214 @@ bool BruteForceFeatureMatcher::MatchImagePair(
   return matches->size() >= this->options_.min_num_feature_matches;
 }
 
+bool BruteForceFeatureMatcher::MatchImagePairBlocked(
+    const KeypointsAndDescriptors& features1,
+    const KeypointsAndDescriptors& features2,
+    std::vector<IndexedFeatureMatch>* matches) {
+  const DescriptorMatrix& descriptors1 = features1.descriptor_matrix;
+  const DescriptorMatrix& descriptors2 = features2.descriptor_matrix;
+  const int num_descriptors1 = descriptors1.rows();
+  const int num_descriptors2 = descriptors2.rows();
+  if (num_descriptors1 == 0 || num_descriptors2 == 0) {
+    return false;
+  }
+  CHECK_EQ(descriptors1.cols(), descriptors2.cols());
+  CHECK_GT(this->options_.brute_force_block_size, 0);
+
+  const bool compute_reverse_matches =
+      this->options_.keep_only_symmetric_matches;
+  const float sq_lowes_ratio =
+      this->options_.lowes_ratio * this->options_.lowes_ratio;
+  const int block_size = this->options_.brute_force_block_size;
+
+  const Eigen::VectorXf sq_norms1 = descriptors1.rowwise().squaredNorm();
+  const Eigen::VectorXf sq_norms2 = descriptors2.rowwise().squaredNorm();
+
+  // The scratch buffers are allocated from the arena of the thread.
+  ArenaScope arena_scope(ThreadLocalArena());
+  const ArenaAllocator<TopTwoNeighbors> allocator(arena_scope.arena());
+
+  // The nearest neighbors in image 2 of each descriptor in image 1 and, if
+  // symmetric matching is desired, vice versa.
+  ArenaVector<TopTwoNeighbors> forward_neighbors(num_descriptors1, allocator);
+  ArenaVector<TopTwoNeighbors> reverse_neighbors(
+      compute_reverse_matches ? num_descriptors2 : 0, allocator);
+
+  // Preallocate the distance tile so that it is reused for all blocks.
+  Eigen::MatrixXf distances(block_size, block_size);
+  for (int i = 0; i < num_descriptors1; i += block_size) {
+    const int rows = std::min(block_size, num_descriptors1 - i);
+    for (int j = 0; j < num_descriptors2; j += block_size) {
+      const int cols = std::min(block_size, num_descriptors2 - j);
+
+      // ||a - b||^2 = ||a||^2 + ||b||^2 - 2 * a^t * b.
+      auto distance_block = distances.topLeftCorner(rows, cols);
+      distance_block.noalias() = -2.0f * descriptors1.middleRows(i, rows) *
+                                 descriptors2.middleRows(j, cols).transpose();
+      distance_block.colwise() += sq_norms1.segment(i, rows);
+      distance_block.rowwise() += sq_norms2.segment(j, cols).transpose();
+
+      // Update the nearest neighbors of the rows and columns of the tile.
+      for (int c = 0; c < cols; c++) {
+        for (int r = 0; r < rows; r++) {
+          // Numerical cancellation can produce tiny negative values.
+          const float distance = std::max(distance_block(r, c), 0.0f);
+          forward_neighbors[i + r].Update(distance, j + c);
+          if (compute_reverse_matches) {
+            reverse_neighbors[j + c].Update(distance, i + r);
+          }
+        }
+      }
+    }
+  }
+
+  matches->reserve(num_descriptors1);
+  NeighborsToMatches(forward_neighbors,
+                     this->options_.use_lowes_ratio,
+                     sq_lowes_ratio,
+                     matches);
+  if (matches->size() < this->options_.min_num_feature_matches) {
+    return false;
+  }
+
+  // Compute the symmetric matches, if applicable.
+  if (compute_reverse_matches) {
+    ArenaVector<IndexedFeatureMatch> reverse_matches(allocator);
+    reverse_matches.reserve(num_descriptors2);
+    NeighborsToMatches(reverse_neighbors,
+                       this->options_.use_lowes_ratio,
+                       sq_lowes_ratio,
+                       &reverse_matches);
+    IntersectMatches(reverse_matches, matches);
+  }
+
+  return matches->size() >= this->options_.min_num_feature_matches;
+}
+
+bool BruteForceFeatureMatcher::MatchImagePairBinary(
+    const KeypointsAndDescriptors& features1,
+    const KeypointsAndDescriptors& features2,
+    std::vector<IndexedFeatureMatch>* matches) {
+  const int num_descriptors1 = features1.NumBinaryDescriptors();
+  const int num_descriptors2 = features2.NumBinaryDescriptors();
+  const int num_bytes = features1.BinaryDescriptorSizeInBytes();
+  CHECK_EQ(num_bytes, features2.BinaryDescriptorSizeInBytes());
+
+  const bool compute_reverse_matches =
+      this->options_.keep_only_symmetric_matches;
+  // Hamming distances are not squared so the ratio is used as is.
+  const float lowes_ratio = this->options_.lowes_ratio;
+
+  // The scratch buffers are allocated from the arena of the thread.
+  ArenaScope arena_scope(ThreadLocalArena());
+  const ArenaAllocator<TopTwoNeighbors> allocator(arena_scope.arena());
+
+  // A single pass over all pairs gathers both the forward and the reverse
+  // nearest neighbors.
+  Hamming distance;
+  ArenaVector<TopTwoNeighbors> forward_neighbors(num_descriptors1, allocator);
+  ArenaVector<TopTwoNeighbors> reverse_neighbors(
+      compute_reverse_matches ? num_descriptors2 : 0, allocator);
+  for (int i = 0; i < num_descriptors1; i++) {
+    const uint8_t* descriptor1 = features1.BinaryDescriptor(i);
+    for (int j = 0; j < num_descriptors2; j++) {
+      const float hamming_distance = static_cast<float>(
+          distance(descriptor1, features2.BinaryDescriptor(j), num_bytes));
+      forward_neighbors[i].Update(hamming_distance, j);
+      if (compute_reverse_matches) {
+        reverse_neighbors[j].Update(hamming_distance, i);
+      }
+    }
+  }
+
+  matches->reserve(num_descriptors1);
+  NeighborsToMatches(
+      forward_neighbors, this->options_.use_lowes_ratio, lowes_ratio, matches);
+  if (matches->size() < this->options_.min_num_feature_matches) {
+    return false;
+  }
+
+  // Compute the symmetric matches, if applicable.
+  if (compute_reverse_matches) {
+    ArenaVector<IndexedFeatureMatch> reverse_matches(allocator);
+    reverse_matches.reserve(num_descriptors2);
+    NeighborsToMatches(reverse_neighbors,
+                       this->options_.use_lowes_ratio,
+                       lowes_ratio,
+                       &reverse_matches);
+    IntersectMatches(reverse_matches, matches);
+  }
+
+  return matches->size() >= this->options_.min_num_feature_matches;
+}
+
+bool BruteForceFeatureMatcher::MatchImagePairQuantized(
+    const KeypointsAndDescriptors& features1,
+    const KeypointsAndDescriptors& features2,
+    std::vector<IndexedFeatureMatch>* matches) {
+  const int num_descriptors1 = features1.quantized_descriptor_matrix.rows();
+  const int num_descriptors2 = features2.quantized_descriptor_matrix.rows();
+  const int descriptor_dimension = features1.quantized_descriptor_matrix.cols();
+  CHECK_EQ(descriptor_dimension, features2.quantized_descriptor_matrix.cols());
+  CHECK_EQ(features1.descriptor_quantization_scale,
+           features2.descriptor_quantization_scale)
+      << "Descriptors quantized with different scales cannot be compared.";
+
+  const bool compute_reverse_matches =
+      this->options_.keep_only_symmetric_matches;
+  const float sq_lowes_ratio =
+      this->options_.lowes_ratio * this->options_.lowes_ratio;
+  // Report the distances in the units of the float descriptors.
+  const float inverse_sq_scale =
+      1.0f / (features1.descriptor_quantization_scale *
+              features1.descriptor_quantization_scale);
+
+  // The scratch buffers are allocated from the arena of the thread.
+  ArenaScope arena_scope(ThreadLocalArena());
+  const ArenaAllocator<TopTwoNeighbors> allocator(arena_scope.arena());
+
+  // A single pass over all pairs gathers both the forward and the reverse
+  // nearest neighbors.
+  QuantizedL2 distance;
+  ArenaVector<TopTwoNeighbors> forward_neighbors(num_descriptors1, allocator);
+  ArenaVector<TopTwoNeighbors> reverse_neighbors(
+      compute_reverse_matches ? num_descriptors2 : 0, allocator);
+  for (int i = 0; i < num_descriptors1; i++) {
+    const uint8_t* descriptor1 = features1.QuantizedDescriptor(i);
+    for (int j = 0; j < num_descriptors2; j++) {
+      const float sq_distance =
+          inverse_sq_scale * static_cast<float>(distance(
+                                 descriptor1,
+                                 features2.QuantizedDescriptor(j),
+                                 descriptor_dimension));
+      forward_neighbors[i].Update(sq_distance, j);
+      if (compute_reverse_matches) {
+        reverse_neighbors[j].Update(sq_distance, i);
+      }
+    }
+  }
+
+  matches->reserve(num_descriptors1);
+  NeighborsToMatches(forward_neighbors,
+                     this->options_.use_lowes_ratio,
+                     sq_lowes_ratio,
+                     matches);
+  if (matches->size() < this->options_.min_num_feature_matches) {
+    return false;
+  }
+
+  // Compute the symmetric matches, if applicable.
+  if (compute_reverse_matches) {
+    ArenaVector<IndexedFeatureMatch> reverse_matches(allocator);
+    reverse_matches.reserve(num_descriptors2);
+    NeighborsToMatches(reverse_neighbors,
+                       this->options_.use_lowes_ratio,
+                       sq_lowes_ratio,
+                       &reverse_matches);
+    IntersectMatches(reverse_matches, matches);
+  }
+
+  return matches->size() >= this->options_.min_num_feature_matches;
+}
+
 }  // namespace theia
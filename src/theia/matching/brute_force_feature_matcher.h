@@ -62,6 +62,25 @@ class BruteForceFeatureMatcher : public FeatureMatcher {
       const KeypointsAndDescriptors& features2,
       std::vector<IndexedFeatureMatch>* matched_featuers) override;
 
+  // Computes the matches from tiles of the full distance matrix obtained with
+  // matrix-matrix products. Both the forward and reverse nearest neighbors are
+  // gathered from the same tiles.
+  bool MatchImagePairBlocked(const KeypointsAndDescriptors& features1,
+                             const KeypointsAndDescriptors& features2,
+                             std::vector<IndexedFeatureMatch>* matches);
+
+  // Matches bit-packed binary descriptors by their Hamming distance. This is
+  // used automatically when both images have binary descriptors.
+  bool MatchImagePairBinary(const KeypointsAndDescriptors& features1,
+                            const KeypointsAndDescriptors& features2,
+                            std::vector<IndexedFeatureMatch>* matches);
+
+  // Matches quantized descriptors by their exact integer squared L2 distance.
+  // This is used automatically when both images have quantized descriptors.
+  bool MatchImagePairQuantized(const KeypointsAndDescriptors& features1,
+                               const KeypointsAndDescriptors& features2,
+                               std::vector<IndexedFeatureMatch>* matches);
+
   DISALLOW_COPY_AND_ASSIGN(BruteForceFeatureMatcher);
 };
 }  // namespace theia
@@ -33,6 +33,7 @@
 // Author: Chris Sweeney (cmsweeney@cs.ucsb.edu)
 
 #include <Eigen/Core>
+#include <string>
 #include <vector>
 
 #include "theia/matching/brute_force_feature_matcher.h"
@@ -54,14 +55,15 @@ static const int kNumDescriptorDimensions = 10;
 TEST(BruteForceFeatureMatcherTest, NoOptions) {
   // Set up descriptors.
   KeypointsAndDescriptors features1, features2;
-  features1.descriptors.resize(kNumDescriptors);
-  features2.descriptors.resize(kNumDescriptors);
+  std::vector<VectorXf> descriptors1, descriptors2;
+  descriptors1.resize(kNumDescriptors);
+  descriptors2.resize(kNumDescriptors);
   for (int i = 0; i < kNumDescriptors; i++) {
     // Avoid a zero vector.
-    features1.descriptors[i] = VectorXf::Constant(kNumDescriptorDimensions, 1);
-    features2.descriptors[i] = VectorXf::Constant(kNumDescriptorDimensions, 1);
-    features1.descriptors[i].normalize();
-    features2.descriptors[i].normalize();
+    descriptors1[i] = VectorXf::Constant(kNumDescriptorDimensions, 1);
+    descriptors2[i] = VectorXf::Constant(kNumDescriptorDimensions, 1);
+    descriptors1[i].normalize();
+    descriptors2[i].normalize();
   }
 
   // Set options.
@@ -72,8 +74,10 @@ TEST(BruteForceFeatureMatcherTest, NoOptions) {
   options.perform_geometric_verification = false;
 
   // Add features.
-  features1.keypoints.resize(features1.descriptors.size());
-  features2.keypoints.resize(features2.descriptors.size());
+  features1.SetDescriptors(descriptors1);
+  features2.SetDescriptors(descriptors2);
+  features1.keypoints.resize(descriptors1.size());
+  features2.keypoints.resize(descriptors2.size());
   InMemoryFeaturesAndMatchesDatabase database;
   database.PutFeatures("1", features1);
   database.PutFeatures("2", features2);
@@ -92,20 +96,21 @@ TEST(BruteForceFeatureMatcherTest, NoOptions) {
 TEST(BruteForceFeatureMatcherTest, RatioTest) {
   // Set up descriptors.
   KeypointsAndDescriptors features1, features2;
-  features1.descriptors.resize(1);
-  features2.descriptors.resize(2);
+  std::vector<VectorXf> descriptors1, descriptors2;
+  descriptors1.resize(1);
+  descriptors2.resize(2);
 
-  features1.descriptors[0] =
+  descriptors1[0] =
       VectorXf::Constant(kNumDescriptorDimensions, 1).normalized();
 
   // Set the two descriptors to be very close to each other so that they do not
   // pass the ratio test.
-  features2.descriptors[0] = VectorXf::Constant(kNumDescriptorDimensions, 1);
-  features2.descriptors[0](0) = 0.9;
-  features2.descriptors[0].normalize();
-  features2.descriptors[1] = VectorXf::Constant(kNumDescriptorDimensions, 1);
-  features2.descriptors[1](0) = 0.89;
-  features2.descriptors[1].normalize();
+  descriptors2[0] = VectorXf::Constant(kNumDescriptorDimensions, 1);
+  descriptors2[0](0) = 0.9;
+  descriptors2[0].normalize();
+  descriptors2[1] = VectorXf::Constant(kNumDescriptorDimensions, 1);
+  descriptors2[1](0) = 0.89;
+  descriptors2[1].normalize();
 
   // Set options.
   FeatureMatcherOptions options;
@@ -115,8 +120,10 @@ TEST(BruteForceFeatureMatcherTest, RatioTest) {
   options.perform_geometric_verification = false;
 
   // Add features.
-  features1.keypoints.resize(features1.descriptors.size());
-  features2.keypoints.resize(features2.descriptors.size());
+  features1.SetDescriptors(descriptors1);
+  features2.SetDescriptors(descriptors2);
+  features1.keypoints.resize(descriptors1.size());
+  features2.keypoints.resize(descriptors2.size());
 
   InMemoryFeaturesAndMatchesDatabase database;
   database.PutFeatures("1", features1);
@@ -136,23 +143,24 @@ TEST(BruteForceFeatureMatcherTest, RatioTest) {
 TEST(BruteForceFeatureMatcherTest, SymmetricMatches) {
   // Set up descriptors.
   KeypointsAndDescriptors features1, features2;
-  features1.descriptors.resize(2);
-  features2.descriptors.resize(2);
+  std::vector<VectorXf> descriptors1, descriptors2;
+  descriptors1.resize(2);
+  descriptors2.resize(2);
 
-  features1.descriptors[0] =
+  descriptors1[0] =
       VectorXf::Constant(kNumDescriptorDimensions, 1).normalized();
-  features1.descriptors[1] = VectorXf::Constant(kNumDescriptorDimensions, 0);
-  features1.descriptors[1](0) = 1.0;
+  descriptors1[1] = VectorXf::Constant(kNumDescriptorDimensions, 0);
+  descriptors1[1](0) = 1.0;
 
-  // Set the two descriptors to be closer to features1.descriptors[0] so that
+  // Set the two descriptors to be closer to descriptors1[0] so that
   // the symmetric matching produces only 1 match.
-  features2.descriptors[0] = VectorXf::Constant(kNumDescriptorDimensions, 1);
-  features2.descriptors[0](0) = 0;
-  features2.descriptors[0].normalize();
-  features2.descriptors[1] = VectorXf::Constant(kNumDescriptorDimensions, 1);
-  features2.descriptors[1](1) = 0;
-  features2.descriptors[1](2) = 0;
-  features2.descriptors[1].normalize();
+  descriptors2[0] = VectorXf::Constant(kNumDescriptorDimensions, 1);
+  descriptors2[0](0) = 0;
+  descriptors2[0].normalize();
+  descriptors2[1] = VectorXf::Constant(kNumDescriptorDimensions, 1);
+  descriptors2[1](1) = 0;
+  descriptors2[1](2) = 0;
+  descriptors2[1].normalize();
 
   // Set options.
   FeatureMatcherOptions options;
@@ -162,8 +170,10 @@ TEST(BruteForceFeatureMatcherTest, SymmetricMatches) {
   options.perform_geometric_verification = false;
 
   // Add features.
-  features1.keypoints.resize(features1.descriptors.size());
-  features2.keypoints.resize(features2.descriptors.size());
+  features1.SetDescriptors(descriptors1);
+  features2.SetDescriptors(descriptors2);
+  features1.keypoints.resize(descriptors1.size());
+  features2.keypoints.resize(descriptors2.size());
 
   InMemoryFeaturesAndMatchesDatabase database;
   database.PutFeatures("1", features1);
@@ -180,4 +190,329 @@ TEST(BruteForceFeatureMatcherTest, SymmetricMatches) {
   EXPECT_EQ(database.NumMatches(), 1);
 }
 
+TEST(BruteForceFeatureMatcherTest, BlockedMatchingEqualsExhaustiveMatching) {
+  static const int kNumDescriptors1 = 100;
+  static const int kNumDescriptors2 = 150;
+  static const int kBlockSize = 16;
+
+  // Set up random descriptors with unique keypoint locations. The first
+  // descriptors of image 2 are slightly perturbed copies of the descriptors of
+  // image 1 so that they pass the ratio test, and the rest are distractors.
+  static const float kNoise = 1e-3f;
+  KeypointsAndDescriptors features1, features2;
+  features1.descriptor_matrix.setRandom(kNumDescriptors1,
+                                        kNumDescriptorDimensions);
+  features1.descriptor_matrix.rowwise().normalize();
+  features2.descriptor_matrix.setRandom(kNumDescriptors2,
+                                        kNumDescriptorDimensions);
+  features2.descriptor_matrix.topRows(kNumDescriptors1) =
+      features1.descriptor_matrix +
+      kNoise * features2.descriptor_matrix.topRows(kNumDescriptors1);
+  features2.descriptor_matrix.rowwise().normalize();
+  for (int i = 0; i < kNumDescriptors1; i++) {
+    features1.keypoints.emplace_back(i, i, Keypoint::OTHER);
+  }
+  for (int i = 0; i < kNumDescriptors2; i++) {
+    features2.keypoints.emplace_back(i, i, Keypoint::OTHER);
+  }
+
+  // Set options.
+  FeatureMatcherOptions options;
+  options.min_num_feature_matches = 0;
+  options.keep_only_symmetric_matches = true;
+  options.use_lowes_ratio = true;
+  options.perform_geometric_verification = false;
+
+  InMemoryFeaturesAndMatchesDatabase database;
+  database.PutFeatures("1", features1);
+  database.PutFeatures("2", features2);
+  BruteForceFeatureMatcher matcher(options, &database);
+  matcher.AddImage("1");
+  matcher.AddImage("2");
+  matcher.MatchImages();
+
+  options.use_blocked_brute_force_matching = true;
+  options.brute_force_block_size = kBlockSize;
+  InMemoryFeaturesAndMatchesDatabase blocked_database;
+  blocked_database.PutFeatures("1", features1);
+  blocked_database.PutFeatures("2", features2);
+  BruteForceFeatureMatcher blocked_matcher(options, &blocked_database);
+  blocked_matcher.AddImage("1");
+  blocked_matcher.AddImage("2");
+  blocked_matcher.MatchImages();
+
+  // Both strategies must produce identical correspondences.
+  ASSERT_GT(database.NumMatches(), 0);
+  ASSERT_EQ(database.NumMatches(), blocked_database.NumMatches());
+  const ImagePairMatch match = database.GetImagePairMatch("1", "2");
+  const ImagePairMatch blocked_match =
+      blocked_database.GetImagePairMatch("1", "2");
+  ASSERT_GT(match.correspondences.size(), 0);
+  ASSERT_EQ(match.correspondences.size(),
+            blocked_match.correspondences.size());
+  for (int i = 0; i < match.correspondences.size(); i++) {
+    EXPECT_TRUE(match.correspondences[i] == blocked_match.correspondences[i]);
+  }
+}
+
+TEST(BruteForceFeatureMatcherTest, BinaryDescriptors) {
+  static const int kNumBytes = 32;
+
+  // The first descriptor of image 2 differs from the first descriptor of
+  // image 1 by a single bit. The second descriptors of both images are almost
+  // as far from each other as from the first descriptors.
+  KeypointsAndDescriptors features1, features2;
+  features1.binary_descriptor_matrix.setZero(2, kNumBytes);
+  features1.binary_descriptor_matrix.row(1).setConstant(0x0f);
+  features2.binary_descriptor_matrix.setZero(2, kNumBytes);
+  features2.binary_descriptor_matrix(0, 0) = 0x01;
+  features2.binary_descriptor_matrix.row(1).setConstant(0xff);
+  for (int i = 0; i < 2; i++) {
+    features1.keypoints.emplace_back(i, i, Keypoint::AKAZE);
+    features2.keypoints.emplace_back(i, i, Keypoint::AKAZE);
+  }
+
+  // Set options.
+  FeatureMatcherOptions options;
+  options.min_num_feature_matches = 0;
+  options.keep_only_symmetric_matches = true;
+  options.use_lowes_ratio = true;
+  options.perform_geometric_verification = false;
+
+  InMemoryFeaturesAndMatchesDatabase database;
+  database.PutFeatures("1", features1);
+  database.PutFeatures("2", features2);
+  BruteForceFeatureMatcher matcher(options, &database);
+  matcher.AddImage("1");
+  matcher.AddImage("2");
+  matcher.MatchImages();
+
+  // Descriptor 0 matches at distance 1 (vs. 256). Descriptor 1 of image 1 is
+  // 127 and 128 bits away from the descriptors of image 2 so it fails the ratio
+  // test.
+  ASSERT_EQ(database.NumMatches(), 1);
+  const ImagePairMatch match = database.GetImagePairMatch("1", "2");
+  ASSERT_EQ(match.correspondences.size(), 1);
+  EXPECT_EQ(match.correspondences[0].feature1.point_,
+            Eigen::Vector2d(0, 0));
+  EXPECT_EQ(match.correspondences[0].feature2.point_,
+            Eigen::Vector2d(0, 0));
+}
+
+TEST(BruteForceFeatureMatcherTest, QuantizedDescriptorsMatchFloatDescriptors) {
+  static const int kNumFeatures = 200;
+  static const int kSiftDimensions = 128;
+
+  // Non-negative unit-norm descriptors like SIFT, where the second image
+  // observes a noisy and shuffled copy of the first.
+  KeypointsAndDescriptors features1, features2;
+  features1.image_name = "1";
+  features2.image_name = "2";
+  features1.descriptor_matrix =
+      DescriptorMatrix::Random(kNumFeatures, kSiftDimensions).cwiseAbs();
+  features2.descriptor_matrix.resize(kNumFeatures, kSiftDimensions);
+  for (int i = 0; i < kNumFeatures; i++) {
+    features2.descriptor_matrix.row((i * 7) % kNumFeatures) =
+        (features1.descriptor_matrix.row(i) +
+         0.05 * DescriptorMatrix::Random(1, kSiftDimensions))
+            .cwiseAbs();
+    features1.keypoints.emplace_back(i, 0, Keypoint::OTHER);
+    features2.keypoints.emplace_back(i, 0, Keypoint::OTHER);
+  }
+  features1.descriptor_matrix.rowwise().normalize();
+  features2.descriptor_matrix.rowwise().normalize();
+
+  FeatureMatcherOptions options;
+  options.min_num_feature_matches = 0;
+  options.perform_geometric_verification = false;
+
+  InMemoryFeaturesAndMatchesDatabase database;
+  database.PutFeatures("1", features1);
+  database.PutFeatures("2", features2);
+  BruteForceFeatureMatcher matcher(options, &database);
+  matcher.AddImages({"1", "2"});
+  matcher.MatchImages();
+
+  features1.QuantizeDescriptors();
+  features2.QuantizeDescriptors();
+  EXPECT_TRUE(features1.HasOnlyQuantizedDescriptors());
+  EXPECT_EQ(features1.NumDescriptors(), kNumFeatures);
+  EXPECT_EQ(features1.DescriptorDimension(), kSiftDimensions);
+  InMemoryFeaturesAndMatchesDatabase quantized_database;
+  quantized_database.PutFeatures("1", features1);
+  quantized_database.PutFeatures("2", features2);
+  BruteForceFeatureMatcher quantized_matcher(options, &quantized_database);
+  quantized_matcher.AddImages({"1", "2"});
+  quantized_matcher.MatchImages();
+
+  // The quantized matches must be the same as the float matches.
+  ASSERT_EQ(database.NumMatches(), 1);
+  ASSERT_EQ(quantized_database.NumMatches(), 1);
+  const ImagePairMatch match = database.GetImagePairMatch("1", "2");
+  const ImagePairMatch quantized_match =
+      quantized_database.GetImagePairMatch("1", "2");
+  EXPECT_GT(match.correspondences.size(), kNumFeatures * 0.9);
+  ASSERT_EQ(match.correspondences.size(),
+            quantized_match.correspondences.size());
+  for (int i = 0; i < match.correspondences.size(); i++) {
+    EXPECT_EQ(match.correspondences[i].feature1.point_,
+              quantized_match.correspondences[i].feature1.point_);
+    EXPECT_EQ(match.correspondences[i].feature2.point_,
+              quantized_match.correspondences[i].feature2.point_);
+  }
+
+  // The dequantized descriptors are close to the originals.
+  DescriptorMatrix dequantized_descriptors;
+  const DescriptorMatrix& descriptors =
+      features1.FloatDescriptors(&dequantized_descriptors);
+  EXPECT_EQ(&descriptors, &dequantized_descriptors);
+  EXPECT_EQ(descriptors.rows(), kNumFeatures);
+  EXPECT_NEAR(descriptors.row(0).norm(), 1.0f, 0.05f);
+}
+
+TEST(BruteForceFeatureMatcherTest, MatchPairsInBlocks) {
+  static const int kNumImages = 12;
+  static const int kNumFeatures = 50;
+
+  // Every image observes the same descriptors with a small amount of noise.
+  DescriptorMatrix descriptors(kNumFeatures, kNumDescriptorDimensions);
+  descriptors.setRandom();
+  std::vector<std::string> image_names;
+  std::vector<KeypointsAndDescriptors> features(kNumImages);
+  for (int i = 0; i < kNumImages; i++) {
+    image_names.emplace_back(std::to_string(i));
+    features[i].image_name = image_names[i];
+    features[i].descriptor_matrix =
+        descriptors +
+        0.01 * DescriptorMatrix::Random(kNumFeatures, kNumDescriptorDimensions);
+    features[i].descriptor_matrix.rowwise().normalize();
+    for (int j = 0; j < kNumFeatures; j++) {
+      features[i].keypoints.emplace_back(j, i, Keypoint::OTHER);
+    }
+  }
+
+  FeatureMatcherOptions options;
+  options.num_threads = 2;
+  options.min_num_feature_matches = 0;
+  options.perform_geometric_verification = false;
+
+  InMemoryFeaturesAndMatchesDatabase database;
+  for (int i = 0; i < kNumImages; i++) {
+    database.PutFeatures(image_names[i], features[i]);
+  }
+  BruteForceFeatureMatcher matcher(options, &database);
+  matcher.AddImages(image_names);
+  matcher.MatchImages();
+
+  // Each thread caches the features of 4 images so the blocks cover 2 images.
+  options.match_pairs_in_blocks = true;
+  options.cache_capacity = 8;
+  InMemoryFeaturesAndMatchesDatabase blocked_database;
+  for (int i = 0; i < kNumImages; i++) {
+    blocked_database.PutFeatures(image_names[i], features[i]);
+  }
+  BruteForceFeatureMatcher blocked_matcher(options, &blocked_database);
+  blocked_matcher.AddImages(image_names);
+  blocked_matcher.MatchImages();
+
+  // Every pair must be matched exactly as without blocks.
+  EXPECT_EQ(database.NumMatches(), kNumImages * (kNumImages - 1) / 2);
+  ASSERT_EQ(database.NumMatches(), blocked_database.NumMatches());
+  for (const auto& image_names : database.ImageNamesOfMatches()) {
+    const ImagePairMatch match =
+        database.GetImagePairMatch(image_names.first, image_names.second);
+    const ImagePairMatch blocked_match = blocked_database.GetImagePairMatch(
+        image_names.first, image_names.second);
+    EXPECT_EQ(match.correspondences.size(),
+              blocked_match.correspondences.size());
+  }
+}
+
+TEST(BruteForceFeatureMatcherTest, MatchIncrementally) {
+  static const int kNumOldImages = 4;
+  static const int kNumNewImages = 2;
+  static const int kNumFeatures = 50;
+  static const int kNumDescriptorDimensions = 32;
+
+  // All images observe the same descriptors except for the last new image,
+  // which cannot be matched to any other image.
+  DescriptorMatrix descriptors(kNumFeatures, kNumDescriptorDimensions);
+  descriptors.setRandom();
+  InMemoryFeaturesAndMatchesDatabase database;
+  std::vector<std::string> image_names;
+  for (int i = 0; i < kNumOldImages + kNumNewImages; i++) {
+    image_names.emplace_back(std::to_string(i));
+    KeypointsAndDescriptors features;
+    features.image_name = image_names[i];
+    features.descriptor_matrix =
+        i + 1 < kNumOldImages + kNumNewImages
+            ? DescriptorMatrix(descriptors +
+                               0.01 * DescriptorMatrix::Random(
+                                          kNumFeatures, kNumDescriptorDimensions))
+            : DescriptorMatrix(DescriptorMatrix::Random(
+                  kNumFeatures, kNumDescriptorDimensions));
+    features.descriptor_matrix.rowwise().normalize();
+    for (int j = 0; j < kNumFeatures; j++) {
+      features.keypoints.emplace_back(j, i, Keypoint::OTHER);
+    }
+    database.PutFeatures(image_names[i], features);
+  }
+
+  FeatureMatcherOptions options;
+  options.min_num_feature_matches = kNumFeatures / 2;
+  options.perform_geometric_verification = false;
+  options.match_incrementally = true;
+
+  // Match the old images.
+  const std::vector<std::string> old_image_names(
+      image_names.begin(), image_names.begin() + kNumOldImages);
+  {
+    BruteForceFeatureMatcher matcher(options, &database);
+    matcher.AddImages(old_image_names);
+    matcher.MatchImages();
+  }
+  EXPECT_EQ(database.NumMatches(), kNumOldImages * (kNumOldImages - 1) / 2);
+  EXPECT_TRUE(database.ImageNamesOfFailedImagePairs().empty());
+
+  // Replace the old matches with empty ones so that we can tell whether they
+  // were recomputed.
+  for (const auto& pair : database.ImageNamesOfMatches()) {
+    ImagePairMatch match;
+    match.image1 = pair.first;
+    match.image2 = pair.second;
+    database.PutImagePairMatch(pair.first, pair.second, match);
+  }
+
+  // Match all images incrementally.
+  {
+    BruteForceFeatureMatcher matcher(options, &database);
+    matcher.AddImages(image_names);
+    matcher.MatchImages();
+  }
+  const int num_images = kNumOldImages + kNumNewImages;
+  EXPECT_EQ(database.NumMatches() + database.ImageNamesOfFailedImagePairs().size(),
+            num_images * (num_images - 1) / 2);
+  // Every pair with the last image fails.
+  EXPECT_EQ(database.ImageNamesOfFailedImagePairs().size(), num_images - 1);
+  for (int i = 0; i < kNumOldImages; i++) {
+    for (int j = i + 1; j < kNumOldImages; j++) {
+      EXPECT_TRUE(database.GetImagePairMatch(image_names[i], image_names[j])
+                      .correspondences.empty());
+    }
+    EXPECT_FALSE(
+        database.GetImagePairMatch(image_names[i], image_names[kNumOldImages])
+            .correspondences.empty());
+  }
+
+  // Failed pairs are not retried, even if the images would match now.
+  const size_t num_matches = database.NumMatches();
+  database.PutFeatures(image_names.back(), database.GetFeatures("0"));
+  {
+    BruteForceFeatureMatcher matcher(options, &database);
+    matcher.AddImages(image_names);
+    matcher.MatchImages();
+  }
+  EXPECT_EQ(database.NumMatches(), num_matches);
+}
+
 }  // namespace theia
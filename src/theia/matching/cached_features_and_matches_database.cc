@@ -0,0 +1,404 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#include "theia/matching/cached_features_and_matches_database.h"
+
+#include <glog/logging.h>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "theia/util/map_util.h"
+#include "theia/util/memory_accounting.h"
+#include "theia/util/metrics.h"
+
+namespace theia {
+
+CachedFeaturesAndMatchesDatabase::CachedFeaturesAndMatchesDatabase(
+    FeaturesAndMatchesDatabase* database, const size_t max_cache_size_in_bytes)
+    : database_(CHECK_NOTNULL(database)),
+      max_size_in_bytes_(max_cache_size_in_bytes),
+      size_in_bytes_(0),
+      features_version_(0),
+      num_cache_hits_(0),
+      num_cache_misses_(0),
+      num_evictions_(0) {
+  CHECK_GT(max_size_in_bytes_, 0)
+      << "The memory budget of the features cache must be positive.";
+  memory_consumer_.reset(new ScopedMemoryConsumer(
+      "feature_cache",
+      [this]() { return SizeInBytes(); },
+      [this](const size_t num_bytes) { return ReleaseMemory(num_bytes); }));
+}
+
+bool CachedFeaturesAndMatchesDatabase::ContainsCameraIntrinsicsPrior(
+    const std::string& image_name) {
+  return database_->ContainsCameraIntrinsicsPrior(image_name);
+}
+
+CameraIntrinsicsPrior
+CachedFeaturesAndMatchesDatabase::GetCameraIntrinsicsPrior(
+    const std::string& image_name) {
+  return database_->GetCameraIntrinsicsPrior(image_name);
+}
+
+void CachedFeaturesAndMatchesDatabase::PutCameraIntrinsicsPrior(
+    const std::string& image_name, const CameraIntrinsicsPrior& intrinsics) {
+  database_->PutCameraIntrinsicsPrior(image_name, intrinsics);
+}
+
+std::vector<std::string>
+CachedFeaturesAndMatchesDatabase::ImageNamesOfCameraIntrinsicsPriors() {
+  return database_->ImageNamesOfCameraIntrinsicsPriors();
+}
+
+size_t CachedFeaturesAndMatchesDatabase::NumCameraIntrinsicsPrior() {
+  return database_->NumCameraIntrinsicsPrior();
+}
+
+bool CachedFeaturesAndMatchesDatabase::ContainsFeatures(
+    const std::string& image_name) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (ContainsKey(entries_, image_name)) {
+      return true;
+    }
+  }
+  return database_->ContainsFeatures(image_name);
+}
+
+KeypointsAndDescriptors CachedFeaturesAndMatchesDatabase::GetFeatures(
+    const std::string& image_name) {
+  return *GetSharedFeatures(image_name);
+}
+
+std::shared_ptr<const KeypointsAndDescriptors>
+CachedFeaturesAndMatchesDatabase::GetSharedFeatures(
+    const std::string& image_name) {
+  static Counter* const num_hits = Metrics::GetCounter(
+      "theia_feature_cache_hits_total", "Hits of the feature cache.");
+  static Counter* const num_misses = Metrics::GetCounter(
+      "theia_feature_cache_misses_total", "Misses of the feature cache.");
+
+  uint64_t features_version;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const auto it = entries_.find(image_name);
+    if (it != entries_.end()) {
+      ++num_cache_hits_;
+      num_hits->Increment();
+      lru_list_.splice(lru_list_.end(), lru_list_, it->second.lru_position);
+      return it->second.features;
+    }
+    ++num_cache_misses_;
+    num_misses->Increment();
+    features_version = features_version_;
+  }
+
+  // Read the features without holding the lock so that misses of different
+  // images are served in parallel.
+  const std::shared_ptr<const KeypointsAndDescriptors> features =
+      database_->GetSharedFeatures(image_name);
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    InsertIntoCache(image_name, features_version, features);
+  }
+
+  MemoryAccounting::EnforceBudget();
+  return features;
+}
+
+std::vector<std::shared_ptr<const KeypointsAndDescriptors>>
+CachedFeaturesAndMatchesDatabase::GetSharedFeaturesBatch(
+    const std::vector<std::string>& image_names) {
+  static Counter* const num_hits = Metrics::GetCounter(
+      "theia_feature_cache_hits_total", "Hits of the feature cache.");
+  static Counter* const num_misses = Metrics::GetCounter(
+      "theia_feature_cache_misses_total", "Misses of the feature cache.");
+
+  std::vector<std::shared_ptr<const KeypointsAndDescriptors>> features(
+      image_names.size());
+  std::vector<std::string> missing_image_names;
+  std::vector<int> missing_indices;
+  uint64_t features_version;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (int i = 0; i < image_names.size(); i++) {
+      const auto it = entries_.find(image_names[i]);
+      if (it != entries_.end()) {
+        ++num_cache_hits_;
+        num_hits->Increment();
+        lru_list_.splice(lru_list_.end(), lru_list_, it->second.lru_position);
+        features[i] = it->second.features;
+      } else {
+        ++num_cache_misses_;
+        num_misses->Increment();
+        missing_image_names.emplace_back(image_names[i]);
+        missing_indices.emplace_back(i);
+      }
+    }
+    features_version = features_version_;
+  }
+  if (missing_image_names.empty()) {
+    return features;
+  }
+
+  // The misses are read from the wrapped database in one batch.
+  const std::vector<std::shared_ptr<const KeypointsAndDescriptors>>
+      missing_features = database_->GetSharedFeaturesBatch(missing_image_names);
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (int i = 0; i < missing_indices.size(); i++) {
+      features[missing_indices[i]] = missing_features[i];
+      InsertIntoCache(missing_image_names[i], features_version,
+                      missing_features[i]);
+    }
+  }
+
+  MemoryAccounting::EnforceBudget();
+  return features;
+}
+
+std::vector<Keypoint> CachedFeaturesAndMatchesDatabase::GetKeypoints(
+    const std::string& image_name) {
+  std::shared_ptr<const KeypointsAndDescriptors> features;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const auto it = entries_.find(image_name);
+    if (it != entries_.end()) {
+      features = it->second.features;
+    }
+  }
+  if (features != nullptr) {
+    return features->keypoints;
+  }
+  return database_->GetKeypoints(image_name);
+}
+
+void CachedFeaturesAndMatchesDatabase::PutFeatures(
+    const std::string& image_name, const KeypointsAndDescriptors& features) {
+  database_->PutFeatures(image_name, features);
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  ++features_version_;
+  const auto it = entries_.find(image_name);
+  if (it != entries_.end()) {
+    Evict(it);
+  }
+}
+
+std::vector<std::string>
+CachedFeaturesAndMatchesDatabase::ImageNamesOfFeatures() {
+  return database_->ImageNamesOfFeatures();
+}
+
+size_t CachedFeaturesAndMatchesDatabase::NumImages() {
+  return database_->NumImages();
+}
+
+ImageId CachedFeaturesAndMatchesDatabase::GetOrAddImageId(
+    const std::string& image_name) {
+  return database_->GetOrAddImageId(image_name);
+}
+
+ImageId CachedFeaturesAndMatchesDatabase::FindImageId(
+    const std::string& image_name) {
+  return database_->FindImageId(image_name);
+}
+
+const std::string& CachedFeaturesAndMatchesDatabase::ImageNameOfId(
+    const ImageId image_id) {
+  return database_->ImageNameOfId(image_id);
+}
+
+int CachedFeaturesAndMatchesDatabase::NumImageIds() {
+  return database_->NumImageIds();
+}
+
+ImagePairMatch CachedFeaturesAndMatchesDatabase::GetImagePairMatch(
+    const std::string& image_name1, const std::string& image_name2) {
+  return database_->GetImagePairMatch(image_name1, image_name2);
+}
+
+void CachedFeaturesAndMatchesDatabase::PutImagePairMatch(
+    const std::string& image_name1,
+    const std::string& image_name2,
+    const ImagePairMatch& matches) {
+  database_->PutImagePairMatch(image_name1, image_name2, matches);
+}
+
+std::vector<std::pair<std::string, std::string>>
+CachedFeaturesAndMatchesDatabase::ImageNamesOfMatches() {
+  return database_->ImageNamesOfMatches();
+}
+
+size_t CachedFeaturesAndMatchesDatabase::NumMatches() {
+  return database_->NumMatches();
+}
+
+bool CachedFeaturesAndMatchesDatabase::ContainsImagePairMatch(
+    const std::string& image_name1, const std::string& image_name2) {
+  return database_->ContainsImagePairMatch(image_name1, image_name2);
+}
+
+void CachedFeaturesAndMatchesDatabase::ForEachMatchedImagePair(
+    const ImagePairCallback& callback) {
+  database_->ForEachMatchedImagePair(callback);
+}
+
+void CachedFeaturesAndMatchesDatabase::ForEachImagePairMatch(
+    const ImagePairMatchCallback& callback) {
+  database_->ForEachImagePairMatch(callback);
+}
+
+void CachedFeaturesAndMatchesDatabase::RemoveAllMatches() {
+  database_->RemoveAllMatches();
+}
+
+void CachedFeaturesAndMatchesDatabase::PutFailedImagePair(
+    const std::string& image_name1, const std::string& image_name2) {
+  database_->PutFailedImagePair(image_name1, image_name2);
+}
+
+std::vector<std::pair<std::string, std::string>>
+CachedFeaturesAndMatchesDatabase::ImageNamesOfFailedImagePairs() {
+  return database_->ImageNamesOfFailedImagePairs();
+}
+
+bool CachedFeaturesAndMatchesDatabase::ContainsFailedImagePair(
+    const std::string& image_name1, const std::string& image_name2) {
+  return database_->ContainsFailedImagePair(image_name1, image_name2);
+}
+
+void CachedFeaturesAndMatchesDatabase::ForEachFailedImagePair(
+    const ImagePairCallback& callback) {
+  database_->ForEachFailedImagePair(callback);
+}
+
+void CachedFeaturesAndMatchesDatabase::Flush() { database_->Flush(); }
+
+bool CachedFeaturesAndMatchesDatabase::GetHashedImage(
+    const std::string& image_name, HashedImage* hashed_image) {
+  return database_->GetHashedImage(image_name, hashed_image);
+}
+
+void CachedFeaturesAndMatchesDatabase::PutHashedImage(
+    const std::string& image_name, const HashedImage& hashed_image) {
+  database_->PutHashedImage(image_name, hashed_image);
+}
+
+bool CachedFeaturesAndMatchesDatabase::GetImageFileSignature(
+    const std::string& image_name, FileSignature* signature) {
+  return database_->GetImageFileSignature(image_name, signature);
+}
+
+void CachedFeaturesAndMatchesDatabase::PutImageFileSignature(
+    const std::string& image_name, const FileSignature& signature) {
+  database_->PutImageFileSignature(image_name, signature);
+}
+
+size_t CachedFeaturesAndMatchesDatabase::SizeInBytes() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return size_in_bytes_;
+}
+
+int CachedFeaturesAndMatchesDatabase::Size() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return entries_.size();
+}
+
+int CachedFeaturesAndMatchesDatabase::NumCacheHits() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return num_cache_hits_;
+}
+
+int CachedFeaturesAndMatchesDatabase::NumCacheMisses() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return num_cache_misses_;
+}
+
+int CachedFeaturesAndMatchesDatabase::NumEvictions() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return num_evictions_;
+}
+
+void CachedFeaturesAndMatchesDatabase::Evict(
+    const std::unordered_map<std::string, Entry>::iterator& entry_iterator) {
+  size_in_bytes_ -= entry_iterator->second.size_in_bytes;
+  lru_list_.erase(entry_iterator->second.lru_position);
+  entries_.erase(entry_iterator);
+  ++num_evictions_;
+}
+
+void CachedFeaturesAndMatchesDatabase::InsertIntoCache(
+    const std::string& image_name,
+    const uint64_t features_version,
+    const std::shared_ptr<const KeypointsAndDescriptors>& features) {
+  // Do not cache features that were replaced while they were read, that do not
+  // fit into the cache or that another thread cached in the meantime.
+  const size_t size_in_bytes = features->SizeInBytes();
+  if (features_version != features_version_ ||
+      size_in_bytes > max_size_in_bytes_ || ContainsKey(entries_, image_name)) {
+    return;
+  }
+
+  Entry& entry = entries_[image_name];
+  entry.features = features;
+  entry.size_in_bytes = size_in_bytes;
+  entry.lru_position = lru_list_.insert(lru_list_.end(), image_name);
+  size_in_bytes_ += size_in_bytes;
+  EvictUntilSizeIsAtMost(max_size_in_bytes_);
+}
+
+void CachedFeaturesAndMatchesDatabase::EvictUntilSizeIsAtMost(
+    const size_t size_in_bytes) {
+  while (size_in_bytes_ > size_in_bytes) {
+    CHECK(!lru_list_.empty());
+    Evict(entries_.find(lru_list_.front()));
+  }
+}
+
+size_t CachedFeaturesAndMatchesDatabase::ReleaseMemory(
+    const size_t num_bytes) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  const size_t old_size_in_bytes = size_in_bytes_;
+  EvictUntilSizeIsAtMost(
+      old_size_in_bytes > num_bytes ? old_size_in_bytes - num_bytes : 0);
+  return old_size_in_bytes - size_in_bytes_;
+}
+
+}  // namespace theia
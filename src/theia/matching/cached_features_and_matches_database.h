@@ -0,0 +1,207 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#ifndef THEIA_MATCHING_CACHED_FEATURES_AND_MATCHES_DATABASE_H_
+#define THEIA_MATCHING_CACHED_FEATURES_AND_MATCHES_DATABASE_H_
+
+#include <stdint.h>
+#include <list>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "theia/matching/features_and_matches_database.h"
+#include "theia/matching/image_pair_match.h"
+#include "theia/matching/keypoints_and_descriptors.h"
+#include "theia/sfm/camera_intrinsics_prior.h"
+#include "theia/util/memory_accounting.h"
+#include "theia/util/util.h"
+
+namespace theia {
+
+// A database that keeps recently used features of another database in a
+// thread-safe, memory-budgeted LRU cache. GetSharedFeatures returns shared
+// handles to the cached features, so cache hits do not copy or deserialize the
+// descriptors, and evicted features remain valid for as long as a caller holds
+// them. This is most useful in front of databases that store the features on
+// disk (e.g. RocksDbFeaturesAndMatchesDatabase), where every GetFeatures call
+// reads and decodes the features.
+//
+// Everything else is forwarded to the wrapped database. PutFeatures writes the
+// features through to the wrapped database and drops the cached entry. This
+// class is guaranteed to be thread safe if the wrapped database is.
+class CachedFeaturesAndMatchesDatabase : public FeaturesAndMatchesDatabase {
+ public:
+  // The wrapped database is not owned and must outlive this object. Features
+  // that are larger than the cache are returned but not cached.
+  CachedFeaturesAndMatchesDatabase(FeaturesAndMatchesDatabase* database,
+                                   const size_t max_cache_size_in_bytes);
+  ~CachedFeaturesAndMatchesDatabase() {}
+
+  bool ContainsCameraIntrinsicsPrior(const std::string& image_name) override;
+  CameraIntrinsicsPrior GetCameraIntrinsicsPrior(
+      const std::string& image_name) override;
+  void PutCameraIntrinsicsPrior(
+      const std::string& image_name,
+      const CameraIntrinsicsPrior& intrinsics) override;
+  std::vector<std::string> ImageNamesOfCameraIntrinsicsPriors() override;
+  size_t NumCameraIntrinsicsPrior() override;
+
+  bool ContainsFeatures(const std::string& image_name) override;
+
+  // Returns a copy of the cached features. Prefer GetSharedFeatures.
+  KeypointsAndDescriptors GetFeatures(const std::string& image_name) override;
+
+  // Returns the cached features, reading them from the wrapped database on a
+  // cache miss.
+  std::shared_ptr<const KeypointsAndDescriptors> GetSharedFeatures(
+      const std::string& image_name) override;
+
+  // Reads the features that are not cached with one batched read of the
+  // wrapped database.
+  std::vector<std::shared_ptr<const KeypointsAndDescriptors>>
+  GetSharedFeaturesBatch(const std::vector<std::string>& image_names) override;
+
+  // Returns the keypoints of the cached features, or reads only the keypoints
+  // from the wrapped database on a cache miss. The features are not cached.
+  std::vector<Keypoint> GetKeypoints(const std::string& image_name) override;
+
+  void PutFeatures(const std::string& image_name,
+                   const KeypointsAndDescriptors& features) override;
+  std::vector<std::string> ImageNamesOfFeatures() override;
+  size_t NumImages() override;
+
+  ImageId GetOrAddImageId(const std::string& image_name) override;
+  ImageId FindImageId(const std::string& image_name) override;
+  const std::string& ImageNameOfId(const ImageId image_id) override;
+  int NumImageIds() override;
+
+  ImagePairMatch GetImagePairMatch(const std::string& image_name1,
+                                   const std::string& image_name2) override;
+  void PutImagePairMatch(const std::string& image_name1,
+                         const std::string& image_name2,
+                         const ImagePairMatch& matches) override;
+  std::vector<std::pair<std::string, std::string>> ImageNamesOfMatches()
+      override;
+  size_t NumMatches() override;
+  bool ContainsImagePairMatch(const std::string& image_name1,
+                              const std::string& image_name2) override;
+  void ForEachMatchedImagePair(const ImagePairCallback& callback) override;
+  void ForEachImagePairMatch(const ImagePairMatchCallback& callback) override;
+  void RemoveAllMatches() override;
+
+  void PutFailedImagePair(const std::string& image_name1,
+                          const std::string& image_name2) override;
+  std::vector<std::pair<std::string, std::string>>
+  ImageNamesOfFailedImagePairs() override;
+  bool ContainsFailedImagePair(const std::string& image_name1,
+                               const std::string& image_name2) override;
+  void ForEachFailedImagePair(const ImagePairCallback& callback) override;
+
+  void Flush() override;
+
+  bool GetHashedImage(const std::string& image_name,
+                      HashedImage* hashed_image) override;
+  void PutHashedImage(const std::string& image_name,
+                      const HashedImage& hashed_image) override;
+  bool GetImageFileSignature(const std::string& image_name,
+                             FileSignature* signature) override;
+  void PutImageFileSignature(const std::string& image_name,
+                             const FileSignature& signature) override;
+
+  // Various statistics for the cache.
+  size_t MaxSizeInBytes() const { return max_size_in_bytes_; }
+  size_t SizeInBytes();
+  int Size();
+  int NumCacheHits();
+  int NumCacheMisses();
+  int NumEvictions();
+
+ private:
+  struct Entry {
+    std::shared_ptr<const KeypointsAndDescriptors> features;
+    size_t size_in_bytes = 0;
+    // The position of the image in the LRU list.
+    std::list<std::string>::iterator lru_position;
+  };
+
+  // Caches the features that were read while the features version was
+  // features_version, unless the features were replaced since.
+  //
+  // NOTE: This method is not thread-safe and must be called with the mutex
+  // locked.
+  void InsertIntoCache(
+      const std::string& image_name,
+      const uint64_t features_version,
+      const std::shared_ptr<const KeypointsAndDescriptors>& features);
+
+  // Removes the entry and updates the memory usage.
+  //
+  // NOTE: These methods are not thread-safe and must be called with the mutex
+  // locked.
+  void Evict(
+      const std::unordered_map<std::string, Entry>::iterator& entry_iterator);
+  void EvictUntilSizeIsAtMost(const size_t size_in_bytes);
+
+  // Evicts entries until at least num_bytes are released. Returns the number of
+  // bytes that were released.
+  size_t ReleaseMemory(const size_t num_bytes);
+
+  FeaturesAndMatchesDatabase* database_;
+  const size_t max_size_in_bytes_;
+
+  std::mutex mutex_;
+  std::unordered_map<std::string, Entry> entries_;
+  // The least recently used image is at the front.
+  std::list<std::string> lru_list_;
+  size_t size_in_bytes_;
+  // Incremented by every PutFeatures so that features read from the wrapped
+  // database before they were replaced are not cached.
+  uint64_t features_version_;
+  int num_cache_hits_;
+  int num_cache_misses_;
+  int num_evictions_;
+
+  // Declared last so that it is unregistered before the entries are destroyed.
+  std::unique_ptr<ScopedMemoryConsumer> memory_consumer_;
+
+  DISALLOW_COPY_AND_ASSIGN(CachedFeaturesAndMatchesDatabase);
+};
+
+}  // namespace theia
+
+#endif  // THEIA_MATCHING_CACHED_FEATURES_AND_MATCHES_DATABASE_H_
@@ -0,0 +1,366 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#include <memory>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "theia/matching/cached_features_and_matches_database.h"
+#include "theia/matching/image_pair_match.h"
+#include "theia/matching/in_memory_features_and_matches_database.h"
+#include "theia/matching/keypoints_and_descriptors.h"
+#include "theia/util/timer.h"
+
+namespace theia {
+
+namespace {
+
+KeypointsAndDescriptors RandomFeatures(const int num_features) {
+  KeypointsAndDescriptors features;
+  features.keypoints.resize(num_features);
+  features.descriptor_matrix.setRandom(num_features, 128);
+  return features;
+}
+
+}  // namespace
+
+TEST(InMemoryFeaturesAndMatchesDatabase, SharedFeaturesAreNotCopied) {
+  InMemoryFeaturesAndMatchesDatabase database;
+  database.PutFeatures("1", RandomFeatures(10));
+  const std::shared_ptr<const KeypointsAndDescriptors> features =
+      database.GetSharedFeatures("1");
+  EXPECT_EQ(features.get(), database.GetSharedFeatures("1").get());
+
+  // Replacing the features does not change the old handle.
+  database.PutFeatures("1", RandomFeatures(20));
+  EXPECT_EQ(features->NumDescriptors(), 10);
+  EXPECT_EQ(database.GetSharedFeatures("1")->NumDescriptors(), 20);
+}
+
+TEST(InMemoryFeaturesAndMatchesDatabase, ContainsAndIteratesMatches) {
+  InMemoryFeaturesAndMatchesDatabase database;
+  database.PutImagePairMatch("1", "2", ImagePairMatch());
+  database.PutImagePairMatch("1", "3", ImagePairMatch());
+  database.PutFailedImagePair("2", "3");
+
+  // The existence checks are forwarded by the cache.
+  CachedFeaturesAndMatchesDatabase cached_database(&database, 1 << 20);
+  EXPECT_TRUE(cached_database.ContainsImagePairMatch("1", "2"));
+  EXPECT_FALSE(cached_database.ContainsImagePairMatch("2", "1"));
+  EXPECT_FALSE(cached_database.ContainsImagePairMatch("2", "3"));
+  EXPECT_TRUE(cached_database.ContainsFailedImagePair("2", "3"));
+  EXPECT_FALSE(cached_database.ContainsFailedImagePair("1", "2"));
+
+  int num_matches = 0;
+  cached_database.ForEachImagePairMatch(
+      [&](const std::string& image1,
+          const std::string& image2,
+          const ImagePairMatch&) {
+        EXPECT_EQ(image1, "1");
+        ++num_matches;
+        return true;
+      });
+  EXPECT_EQ(num_matches, 2);
+
+  // Iteration stops when the callback returns false.
+  int num_visited_pairs = 0;
+  cached_database.ForEachMatchedImagePair(
+      [&](const std::string&, const std::string&) {
+        ++num_visited_pairs;
+        return false;
+      });
+  EXPECT_EQ(num_visited_pairs, 1);
+
+  int num_failed_pairs = 0;
+  cached_database.ForEachFailedImagePair(
+      [&](const std::string& image1, const std::string& image2) {
+        EXPECT_EQ(image1, "2");
+        EXPECT_EQ(image2, "3");
+        ++num_failed_pairs;
+        return true;
+      });
+  EXPECT_EQ(num_failed_pairs, 1);
+}
+
+TEST(InMemoryFeaturesAndMatchesDatabase, ConcurrentPutsAndGets) {
+  static const int kNumImages = 50;
+  static const int kNumThreads = 8;
+  InMemoryFeaturesAndMatchesDatabase database;
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kNumThreads; t++) {
+    threads.emplace_back([&, t]() {
+      // Every thread adds its own images and matches and reads those of the
+      // other threads that were already added.
+      for (int i = t; i < kNumImages; i += kNumThreads) {
+        const std::string image_name = std::to_string(i);
+        database.PutFeatures(image_name, RandomFeatures(i + 1));
+        for (int j = 0; j < i; j++) {
+          const std::string image_name2 = std::to_string(j);
+          ImagePairMatch match;
+          match.image1 = image_name2;
+          match.image2 = image_name;
+          if (j % 2 == 0) {
+            database.PutImagePairMatch(image_name2, image_name, match);
+          } else {
+            database.PutFailedImagePair(image_name2, image_name);
+          }
+          if (database.ContainsFeatures(image_name2)) {
+            EXPECT_EQ(database.GetSharedFeatures(image_name2)->NumDescriptors(),
+                      j + 1);
+          }
+        }
+      }
+    });
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+
+  int num_matches = 0;
+  int num_failed_image_pairs = 0;
+  for (int i = 0; i < kNumImages; i++) {
+    for (int j = 0; j < i; j++) {
+      num_matches += (j % 2 == 0);
+      num_failed_image_pairs += (j % 2 == 1);
+    }
+  }
+  EXPECT_EQ(database.NumImages(), kNumImages);
+  EXPECT_EQ(database.ImageNamesOfFeatures().size(), kNumImages);
+  EXPECT_EQ(database.NumMatches(), num_matches);
+  EXPECT_EQ(database.ImageNamesOfMatches().size(), num_matches);
+  EXPECT_EQ(database.ImageNamesOfFailedImagePairs().size(),
+            num_failed_image_pairs);
+  EXPECT_EQ(database.GetImagePairMatch("2", "7").image1, "2");
+  EXPECT_TRUE(database.ContainsFailedImagePair("3", "7"));
+  EXPECT_FALSE(database.ContainsImagePairMatch("3", "7"));
+
+  // The callbacks may access the database.
+  int num_visited_matches = 0;
+  database.ForEachImagePairMatch([&](const std::string& image1,
+                                     const std::string& image2,
+                                     const ImagePairMatch& match) {
+    EXPECT_TRUE(database.ContainsImagePairMatch(image1, image2));
+    EXPECT_EQ(match.image2, image2);
+    ++num_visited_matches;
+    return true;
+  });
+  EXPECT_EQ(num_visited_matches, num_matches);
+
+  database.RemoveAllMatches();
+  EXPECT_EQ(database.NumMatches(), 0);
+  EXPECT_TRUE(database.ImageNamesOfFailedImagePairs().empty());
+  EXPECT_EQ(database.NumImages(), kNumImages);
+}
+
+// Reads the features of random image pairs from many threads, as the feature
+// matchers do, and logs the throughput.
+TEST(InMemoryFeaturesAndMatchesDatabase, ConcurrentReadThroughput) {
+  static const int kNumImages = 200;
+  static const int kNumReadsPerThread = 20000;
+  InMemoryFeaturesAndMatchesDatabase database;
+  for (int i = 0; i < kNumImages; i++) {
+    database.PutFeatures(std::to_string(i), RandomFeatures(10));
+  }
+  std::vector<std::string> image_names;
+  for (int i = 0; i < kNumImages; i++) {
+    image_names.emplace_back(std::to_string(i));
+  }
+
+  for (const int num_threads : {1, 4, 16}) {
+    Timer timer;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < num_threads; t++) {
+      threads.emplace_back([&, t]() {
+        int num_descriptors = 0;
+        for (int i = 0; i < kNumReadsPerThread; i++) {
+          const std::string& image_name =
+              image_names[(i * 7919 + t * 104729) % kNumImages];
+          num_descriptors +=
+              database.GetSharedFeatures(image_name)->NumDescriptors();
+          database.PutImagePairMatch(image_name, image_names[t],
+                                     ImagePairMatch());
+        }
+        EXPECT_EQ(num_descriptors, 10 * kNumReadsPerThread);
+      });
+    }
+    for (std::thread& thread : threads) {
+      thread.join();
+    }
+    const double elapsed_time = timer.ElapsedTimeInSeconds();
+    LOG(INFO) << num_threads << " threads: "
+              << num_threads * kNumReadsPerThread / elapsed_time
+              << " reads and writes per second.";
+  }
+}
+
+TEST(CachedFeaturesAndMatchesDatabase, HitsAndMisses) {
+  InMemoryFeaturesAndMatchesDatabase database;
+  CachedFeaturesAndMatchesDatabase cached_database(&database, 1 << 20);
+  cached_database.PutFeatures("1", RandomFeatures(10));
+  cached_database.PutFeatures("2", RandomFeatures(20));
+
+  EXPECT_EQ(cached_database.GetSharedFeatures("1")->NumDescriptors(), 10);
+  EXPECT_EQ(cached_database.GetSharedFeatures("2")->NumDescriptors(), 20);
+  EXPECT_EQ(cached_database.GetFeatures("1").NumDescriptors(), 10);
+  EXPECT_EQ(cached_database.NumCacheMisses(), 2);
+  EXPECT_EQ(cached_database.NumCacheHits(), 1);
+  EXPECT_EQ(cached_database.Size(), 2);
+  EXPECT_EQ(cached_database.SizeInBytes(),
+            database.GetFeatures("1").SizeInBytes() +
+                database.GetFeatures("2").SizeInBytes());
+  EXPECT_EQ(cached_database.NumImages(), 2);
+}
+
+TEST(CachedFeaturesAndMatchesDatabase, GetKeypoints) {
+  InMemoryFeaturesAndMatchesDatabase database;
+  CachedFeaturesAndMatchesDatabase cached_database(&database, 1 << 20);
+  cached_database.PutFeatures("1", RandomFeatures(10));
+
+  // Reading the keypoints of uncached features does not cache them.
+  EXPECT_EQ(cached_database.GetKeypoints("1").size(), 10);
+  EXPECT_EQ(cached_database.Size(), 0);
+  EXPECT_EQ(cached_database.GetSharedFeatures("1")->NumDescriptors(), 10);
+  EXPECT_EQ(cached_database.GetKeypoints("1").size(), 10);
+  EXPECT_EQ(cached_database.NumCacheMisses(), 1);
+}
+
+TEST(CachedFeaturesAndMatchesDatabase, GetSharedFeaturesBatch) {
+  InMemoryFeaturesAndMatchesDatabase database;
+  CachedFeaturesAndMatchesDatabase cached_database(&database, 1 << 20);
+  for (int i = 0; i < 3; i++) {
+    cached_database.PutFeatures(std::to_string(i), RandomFeatures(10 + i));
+  }
+  cached_database.GetSharedFeatures("1");
+
+  // Only the uncached images are read, and the features are returned in the
+  // order of the image names.
+  const std::vector<std::shared_ptr<const KeypointsAndDescriptors>> features =
+      cached_database.GetSharedFeaturesBatch({"2", "1", "0"});
+  ASSERT_EQ(features.size(), 3);
+  EXPECT_EQ(features[0]->NumDescriptors(), 12);
+  EXPECT_EQ(features[1]->NumDescriptors(), 11);
+  EXPECT_EQ(features[2]->NumDescriptors(), 10);
+  EXPECT_EQ(cached_database.NumCacheHits(), 1);
+  EXPECT_EQ(cached_database.NumCacheMisses(), 3);
+  EXPECT_EQ(cached_database.Size(), 3);
+  EXPECT_EQ(cached_database.GetSharedFeatures("0"), features[2]);
+}
+
+TEST(CachedFeaturesAndMatchesDatabase, EvictsLeastRecentlyUsed) {
+  InMemoryFeaturesAndMatchesDatabase database;
+  const KeypointsAndDescriptors features = RandomFeatures(100);
+  // Room for two images.
+  CachedFeaturesAndMatchesDatabase cached_database(
+      &database, 2 * features.SizeInBytes() + features.SizeInBytes() / 2);
+  for (const std::string image_name : {"1", "2", "3"}) {
+    database.PutFeatures(image_name, features);
+  }
+
+  const std::shared_ptr<const KeypointsAndDescriptors> features1 =
+      cached_database.GetSharedFeatures("1");
+  cached_database.GetSharedFeatures("2");
+  // Image 1 becomes the most recently used image so image 2 is evicted.
+  cached_database.GetSharedFeatures("1");
+  cached_database.GetSharedFeatures("3");
+  EXPECT_EQ(cached_database.NumEvictions(), 1);
+  EXPECT_EQ(cached_database.Size(), 2);
+  EXPECT_LE(cached_database.SizeInBytes(), cached_database.MaxSizeInBytes());
+
+  const int num_cache_misses = cached_database.NumCacheMisses();
+  cached_database.GetSharedFeatures("1");
+  EXPECT_EQ(cached_database.NumCacheMisses(), num_cache_misses);
+  cached_database.GetSharedFeatures("2");
+  EXPECT_EQ(cached_database.NumCacheMisses(), num_cache_misses + 1);
+
+  // Handles stay valid after their entry was evicted.
+  cached_database.GetSharedFeatures("3");
+  EXPECT_EQ(features1->NumDescriptors(), 100);
+}
+
+TEST(CachedFeaturesAndMatchesDatabase, PutFeaturesReplacesCachedFeatures) {
+  InMemoryFeaturesAndMatchesDatabase database;
+  CachedFeaturesAndMatchesDatabase cached_database(&database, 1 << 20);
+  cached_database.PutFeatures("1", RandomFeatures(10));
+  EXPECT_EQ(cached_database.GetSharedFeatures("1")->NumDescriptors(), 10);
+  cached_database.PutFeatures("1", RandomFeatures(20));
+  EXPECT_EQ(cached_database.GetSharedFeatures("1")->NumDescriptors(), 20);
+  EXPECT_EQ(database.GetFeatures("1").NumDescriptors(), 20);
+}
+
+TEST(CachedFeaturesAndMatchesDatabase, LargeFeaturesAreNotCached) {
+  InMemoryFeaturesAndMatchesDatabase database;
+  CachedFeaturesAndMatchesDatabase cached_database(&database, 1024);
+  database.PutFeatures("1", RandomFeatures(100));
+  EXPECT_EQ(cached_database.GetSharedFeatures("1")->NumDescriptors(), 100);
+  EXPECT_EQ(cached_database.Size(), 0);
+  EXPECT_EQ(cached_database.SizeInBytes(), 0);
+}
+
+TEST(CachedFeaturesAndMatchesDatabase, ConcurrentReads) {
+  static const int kNumImages = 20;
+  static const int kNumThreads = 8;
+  InMemoryFeaturesAndMatchesDatabase database;
+  const KeypointsAndDescriptors features = RandomFeatures(10);
+  for (int i = 0; i < kNumImages; i++) {
+    database.PutFeatures(std::to_string(i), features);
+  }
+  // Room for half of the images.
+  CachedFeaturesAndMatchesDatabase cached_database(
+      &database, kNumImages / 2 * features.SizeInBytes());
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kNumThreads; t++) {
+    threads.emplace_back([&, t]() {
+      for (int i = 0; i < 100; i++) {
+        const std::string image_name =
+            std::to_string((i * (t + 1)) % kNumImages);
+        EXPECT_EQ(
+            cached_database.GetSharedFeatures(image_name)->NumDescriptors(),
+            10);
+      }
+    });
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(cached_database.NumCacheHits() + cached_database.NumCacheMisses(),
+            kNumThreads * 100);
+  EXPECT_LE(cached_database.SizeInBytes(), cached_database.MaxSizeInBytes());
+}
+
+}  // namespace theia
@@ -39,6 +39,7 @@
 #include <stdint.h>
 
 #include <algorithm>
+#include <array>
 #include <cmath>
 #include <utility>
 #include <vector>
@@ -46,23 +47,103 @@
 #include "theia/matching/distance.h"
 #include "theia/matching/feature_matcher.h"
 #include "theia/matching/indexed_feature_match.h"
+#include "theia/util/arena.h"
 #include "theia/util/random.h"
 
 namespace theia {
 
 namespace {
 
-void GetZeroMeanDescriptor(const std::vector<Eigen::VectorXf>& sift_desc,
+void GetZeroMeanDescriptor(const DescriptorMatrix& sift_desc,
                            Eigen::VectorXf* mean) {
-  mean->setZero(sift_desc[0].size());
-  for (int i = 0; i < sift_desc.size(); i++) {
-    *mean += sift_desc[i];
+  *mean = sift_desc.colwise().mean().transpose();
+}
+
+// Accumulates the bytes of the matrix into a 64-bit FNV-1a hash.
+void UpdateFingerprint(const Eigen::MatrixXf& matrix, uint64_t* fingerprint) {
+  static const uint64_t kFnvPrime = 1099511628211ULL;
+  const uint8_t* bytes = reinterpret_cast<const uint8_t*>(matrix.data());
+  for (int i = 0; i < matrix.size() * sizeof(float); i++) {
+    *fingerprint = (*fingerprint ^ bytes[i]) * kFnvPrime;
+  }
+}
+
+// Returns the Hamming distance between two hash codes.
+inline int HashCodeDistance(const uint64_t* code1, const uint64_t* code2) {
+  return __builtin_popcountll(code1[0] ^ code2[0]) +
+         __builtin_popcountll(code1[1] ^ code2[1]);
+}
+
+// Computes the Hamming distances between the query hash code and the hash codes
+// of the candidates.
+inline void ComputeHashCodeDistancesImpl(
+    const uint64_t* query_code,
+    const std::vector<HashedSiftDescriptor>& hashed_desc,
+    const int* candidate_ids,
+    const int num_candidates,
+    uint8_t* distances) {
+  for (int k = 0; k < num_candidates; k++) {
+    distances[k] = HashCodeDistance(
+        query_code, hashed_desc[candidate_ids[k]].hash_code.data());
   }
-  *mean /= static_cast<double>(sift_desc.size());
 }
 
+void ComputeHashCodeDistancesDefault(
+    const uint64_t* query_code,
+    const std::vector<HashedSiftDescriptor>& hashed_desc,
+    const int* candidate_ids,
+    const int num_candidates,
+    uint8_t* distances) {
+  ComputeHashCodeDistancesImpl(
+      query_code, hashed_desc, candidate_ids, num_candidates, distances);
+}
+
+// The baseline x86 ISA has no popcount instruction, so a kernel with the POPCNT
+// instruction is compiled separately and used whenever the distance kernels of
+// the library use it (see distance.h).
+#if (defined(__x86_64__) || defined(__i386__)) && \
+    (defined(__GNUC__) || defined(__clang__))
+#define THEIA_CASCADE_HASHER_POPCNT
+__attribute__((target("popcnt"))) void ComputeHashCodeDistancesPopcnt(
+    const uint64_t* query_code,
+    const std::vector<HashedSiftDescriptor>& hashed_desc,
+    const int* candidate_ids,
+    const int num_candidates,
+    uint8_t* distances) {
+  ComputeHashCodeDistancesImpl(
+      query_code, hashed_desc, candidate_ids, num_candidates, distances);
+}
+#endif
+
 }  // namespace
 
+void HashedImage::BuildBuckets() {
+  buckets.clear();
+  buckets.resize(kNumBucketGroups);
+  for (int i = 0; i < kNumBucketGroups; i++) {
+    buckets[i].resize(kNumBucketsPerGroup);
+    // Add the descriptor ID to the proper bucket group and id.
+    for (int j = 0; j < hashed_desc.size(); j++) {
+      const uint16_t bucket_id = hashed_desc[j].bucket_ids[i];
+      buckets[i][bucket_id].push_back(j);
+    }
+  }
+}
+
+size_t HashedImage::SizeInBytes() const {
+  size_t size_in_bytes =
+      sizeof(*this) + mean_descriptor.size() * sizeof(float) +
+      hashed_desc.size() *
+          (sizeof(HashedSiftDescriptor) + kNumBucketGroups * sizeof(uint16_t));
+  for (const std::vector<Bucket>& bucket_group : buckets) {
+    size_in_bytes += bucket_group.size() * sizeof(Bucket);
+    for (const Bucket& bucket : bucket_group) {
+      size_in_bytes += bucket.capacity() * sizeof(int);
+    }
+  }
+  return size_in_bytes;
+}
+
 bool CascadeHasher::Initialize(const int num_dimensions_of_descriptor) {
   num_dimensions_of_descriptor_ = num_dimensions_of_descriptor;
   primary_hash_projection_.resize(kHashCodeSize, num_dimensions_of_descriptor_);
@@ -85,73 +166,74 @@ bool CascadeHasher::Initialize(const int num_dimensions_of_descriptor) {
     }
   }
 
+  // Compute the fingerprint of the projections.
+  fingerprint_ = 14695981039346656037ULL;
+  UpdateFingerprint(primary_hash_projection_, &fingerprint_);
+  for (int i = 0; i < kNumBucketGroups; i++) {
+    UpdateFingerprint(secondary_hash_projection_[i], &fingerprint_);
+  }
+
   return true;
 }
 
 void CascadeHasher::CreateHashedDescriptors(
-    const std::vector<Eigen::VectorXf>& sift_desc,
+    const DescriptorMatrix& sift_desc,
     HashedImage* hashed_image) const {
-  for (int i = 0; i < sift_desc.size(); i++) {
-    // Use the zero-mean shifted descriptor.
-    const auto descriptor = sift_desc[i] - hashed_image->mean_descriptor;
+  // Use the zero-mean shifted descriptors. Since the descriptors are stored
+  // contiguously the projections for all descriptors are computed with a single
+  // matrix product.
+  const DescriptorMatrix descriptors =
+      sift_desc.rowwise() - hashed_image->mean_descriptor.transpose();
+
+  // Compute hash codes.
+  const Eigen::MatrixXf primary_projection =
+      descriptors * primary_hash_projection_.transpose();
+  for (int i = 0; i < sift_desc.rows(); i++) {
     auto& hash_code = hashed_image->hashed_desc[i].hash_code;
-
-    // Compute hash code.
-    const Eigen::VectorXf primary_projection =
-        primary_hash_projection_ * descriptor;
+    hash_code.fill(0);
     for (int j = 0; j < kHashCodeSize; j++) {
-      hash_code[j] = primary_projection(j) > 0;
+      hash_code[j / 64] |=
+          static_cast<uint64_t>(primary_projection(i, j) > 0) << (j % 64);
     }
+  }
 
-    // Determine the bucket index for each group.
-    for (int j = 0; j < kNumBucketGroups; j++) {
+  // Determine the bucket index for each group.
+  for (int j = 0; j < kNumBucketGroups; j++) {
+    const Eigen::MatrixXf secondary_projection =
+        descriptors * secondary_hash_projection_[j].transpose();
+    for (int i = 0; i < sift_desc.rows(); i++) {
       uint16_t bucket_id = 0;
-      const Eigen::VectorXf secondary_projection =
-          secondary_hash_projection_[j] * descriptor;
-
       for (int k = 0; k < kNumBucketBits; k++) {
-        bucket_id = (bucket_id << 1) + (secondary_projection(k) > 0 ? 1 : 0);
+        bucket_id =
+            (bucket_id << 1) + (secondary_projection(i, k) > 0 ? 1 : 0);
       }
       hashed_image->hashed_desc[i].bucket_ids[j] = bucket_id;
     }
   }
 }
 
-void CascadeHasher::BuildBuckets(HashedImage* hashed_image) const {
-  for (int i = 0; i < kNumBucketGroups; i++) {
-    // Add the descriptor ID to the proper bucket group and id.
-    for (int j = 0; j < hashed_image->hashed_desc.size(); j++) {
-      const uint16_t bucket_id = hashed_image->hashed_desc[j].bucket_ids[i];
-      hashed_image->buckets[i][bucket_id].push_back(j);
-    }
-  }
-}
-
 // Steps:
 //   1) Get zero mean descriptor.
 //   2) Compute hash code and hash buckets.
 //   3) Construct buckets.
 HashedImage CascadeHasher::CreateHashedSiftDescriptors(
-    const std::vector<Eigen::VectorXf>& sift_desc) const {
+    const DescriptorMatrix& sift_desc) const {
   HashedImage hashed_image;
+  hashed_image.hasher_fingerprint = fingerprint_;
 
-  // Allocate the buckets even if no descriptors exist to fill them.
-  hashed_image.buckets.resize(kNumBucketGroups);
-  for (int i = 0; i < kNumBucketGroups; i++) {
-    hashed_image.buckets[i].resize(kNumBucketsPerGroup);
-  }
-
-  if (sift_desc.size() == 0) {
+  if (sift_desc.rows() == 0) {
+    // Allocate the buckets even if no descriptors exist to fill them.
+    hashed_image.BuildBuckets();
     return hashed_image;
   }
 
   GetZeroMeanDescriptor(sift_desc, &hashed_image.mean_descriptor);
 
   // Allocate space for hash codes and bucket ids.
-  hashed_image.hashed_desc.resize(sift_desc.size());
+  hashed_image.hashed_desc.resize(sift_desc.rows());
 
   // Allocate space for each bucket id.
-  for (int i = 0; i < sift_desc.size(); i++) {
+  for (int i = 0; i < sift_desc.rows(); i++) {
     hashed_image.hashed_desc[i].bucket_ids.resize(kNumBucketGroups);
   }
 
@@ -159,7 +241,7 @@ HashedImage CascadeHasher::CreateHashedSiftDescriptors(
   CreateHashedDescriptors(sift_desc, &hashed_image);
 
   // Build the buckets.
-  BuildBuckets(&hashed_image);
+  hashed_image.BuildBuckets();
   return hashed_image;
 }
 
@@ -167,12 +249,12 @@ HashedImage CascadeHasher::CreateHashedSiftDescriptors(
 // previously generated.
 void CascadeHasher::MatchImages(
     const HashedImage& hashed_image1,
-    const std::vector<Eigen::VectorXf>& descriptors1,
+    const DescriptorMatrix& descriptors1,
     const HashedImage& hashed_image2,
-    const std::vector<Eigen::VectorXf>& descriptors2,
+    const DescriptorMatrix& descriptors2,
     const double lowes_ratio,
     std::vector<IndexedFeatureMatch>* matches) const {
-  if (descriptors1.size() == 0 || descriptors2.size() == 0) {
+  if (descriptors1.rows() == 0 || descriptors2.rows() == 0) {
     return;
   }
 
@@ -180,90 +262,129 @@ void CascadeHasher::MatchImages(
   const double sq_lowes_ratio = lowes_ratio * lowes_ratio;
   L2 l2_distance;
 
+#ifdef THEIA_CASCADE_HASHER_POPCNT
+  const auto compute_hash_code_distances =
+      GetDistanceInstructionSet() == DistanceInstructionSet::SCALAR
+          ? ComputeHashCodeDistancesDefault
+          : ComputeHashCodeDistancesPopcnt;
+#else
+  const auto compute_hash_code_distances = ComputeHashCodeDistancesDefault;
+#endif
+
   // Reserve space for the matches.
   matches->reserve(
-      static_cast<int>(std::min(descriptors1.size(), descriptors2.size())));
-
-  // Preallocate the candidate descriptors container.
-  std::vector<int> candidate_descriptors;
-  candidate_descriptors.reserve(descriptors2.size());
-
-  // Preallocated hamming distances. Each column indicates the hamming distance
-  // and the rows collect the descriptor ids with that
-  // distance. num_descriptors_with_hamming_distance keeps track of how many
-  // descriptors have that distance.
-  Eigen::MatrixXi candidate_hamming_distances(descriptors2.size(),
-                                              kHashCodeSize + 1);
-  Eigen::VectorXi num_descriptors_with_hamming_distance(kHashCodeSize + 1);
-
-  // Preallocate the container for keeping euclidean distances.
-  std::vector<std::pair<float, int> > candidate_euclidean_distances;
-  candidate_euclidean_distances.reserve(kNumTopCandidates);
-
-  // A preallocated vector to determine if we have already used a particular
-  // feature for matching (i.e., prevents duplicates).
-  std::vector<bool> used_descriptor(descriptors2.size());
+      static_cast<int>(std::min(descriptors1.rows(), descriptors2.rows())));
+
+  // The scratch buffers are allocated from the arena of the thread, which is
+  // rewound once the pair is matched.
+  ArenaScope arena_scope(ThreadLocalArena());
+  Arena* arena = arena_scope.arena();
+
+  // Preallocate the candidate descriptors container and the Hamming distances
+  // of the candidates.
+  ArenaVector<int> candidate_descriptors{ArenaAllocator<int>(arena)};
+  candidate_descriptors.reserve(descriptors2.rows());
+  ArenaVector<uint8_t> candidate_hamming_distances(
+      descriptors2.rows(), 0, ArenaAllocator<uint8_t>(arena));
+
+  // The last query descriptor that each descriptor of the second image was a
+  // candidate of. This prevents duplicate candidates without resetting a flag
+  // for every candidate.
+  ArenaVector<int> last_query(descriptors2.rows(), -1,
+                              ArenaAllocator<int>(arena));
+
+  // The candidates are ranked by a counting sort on their Hamming distance,
+  // which is bounded by the size of the hash code. Only the top candidates are
+  // kept, in the order in which they were found within each distance.
+  std::array<int, kHashCodeSize + 1> num_descriptors_with_hamming_distance;
+  std::array<int, kNumTopCandidates + 1> top_candidates;
+  std::array<std::pair<float, int>, kNumTopCandidates + 1>
+      candidate_euclidean_distances;
+
   for (int i = 0; i < hashed_image1.hashed_desc.size(); i++) {
     candidate_descriptors.clear();
-    num_descriptors_with_hamming_distance.setZero();
-    candidate_euclidean_distances.clear();
-
     const auto& hashed_desc = hashed_image1.hashed_desc[i];
 
     // Accumulate all descriptors in each bucket group that are in the same
     // bucket id as the query descriptor.
+    int num_candidates_with_duplicates = 0;
     for (int j = 0; j < kNumBucketGroups; j++) {
       const uint16_t bucket_id = hashed_desc.bucket_ids[j];
-      for (const auto& feature_id : hashed_image2.buckets[j][bucket_id]) {
-        candidate_descriptors.emplace_back(feature_id);
-        used_descriptor[feature_id] = false;
+      const Bucket& bucket = hashed_image2.buckets[j][bucket_id];
+      num_candidates_with_duplicates += bucket.size();
+      for (const int feature_id : bucket) {
+        if (last_query[feature_id] != i) {
+          last_query[feature_id] = i;
+          candidate_descriptors.emplace_back(feature_id);
+        }
       }
     }
 
-    // Skip matching this descriptor if there are not at least 2 candidates.
-    if (candidate_descriptors.size() <= kNumTopCandidates) {
+    // Skip matching this descriptor if there are not enough candidates.
+    if (num_candidates_with_duplicates <= kNumTopCandidates ||
+        candidate_descriptors.size() < 2) {
       continue;
     }
 
-    // Compute the hamming distance of all candidates based on the comp hash
-    // code. Put the descriptors into buckets corresponding to their hamming
-    // distance.
-    for (const int candidate_id : candidate_descriptors) {
-      if (used_descriptor[candidate_id]) {
-        continue;
+    // Compute the hamming distance of all candidates based on the hash code
+    // and count the candidates with each distance.
+    const int num_candidates = candidate_descriptors.size();
+    compute_hash_code_distances(hashed_desc.hash_code.data(),
+                                hashed_image2.hashed_desc,
+                                candidate_descriptors.data(),
+                                num_candidates,
+                                candidate_hamming_distances.data());
+    num_descriptors_with_hamming_distance.fill(0);
+    for (int k = 0; k < num_candidates; k++) {
+      ++num_descriptors_with_hamming_distance[candidate_hamming_distances[k]];
+    }
+
+    // Convert the counts to the position of the first candidate with each
+    // distance, up to the distance that contains the last top candidate.
+    const int num_top_candidates =
+        std::min(num_candidates, kNumTopCandidates + 1);
+    int max_hamming_distance = 0;
+    int num_ranked_candidates = 0;
+    for (; max_hamming_distance <= kHashCodeSize; max_hamming_distance++) {
+      const int count =
+          num_descriptors_with_hamming_distance[max_hamming_distance];
+      num_descriptors_with_hamming_distance[max_hamming_distance] =
+          num_ranked_candidates;
+      num_ranked_candidates += count;
+      if (num_ranked_candidates >= num_top_candidates) {
+        break;
       }
-      used_descriptor[candidate_id] = true;
-      const uint8_t hamming_distance =
-          (hashed_desc.hash_code ^
-           hashed_image2.hashed_desc[candidate_id].hash_code)
-              .count();
-      candidate_hamming_distances(
-          num_descriptors_with_hamming_distance(hamming_distance)++,
-          hamming_distance) = candidate_id;
     }
 
-    // Compute the euclidean distance of the k descriptors with the best hamming
-    // distance.
-    candidate_euclidean_distances.reserve(kNumTopCandidates);
-    for (int j = 0; j < candidate_hamming_distances.cols(); j++) {
-      for (int k = 0; k < num_descriptors_with_hamming_distance(j); k++) {
-        const int candidate_id = candidate_hamming_distances(k, j);
-        const float distance =
-            l2_distance(descriptors2[candidate_id], descriptors1[i]);
-        candidate_euclidean_distances.emplace_back(distance, candidate_id);
-        if (candidate_euclidean_distances.size() > kNumTopCandidates) {
-          break;
-        }
+    for (int k = 0; k < num_candidates; k++) {
+      const int hamming_distance = candidate_hamming_distances[k];
+      if (hamming_distance > max_hamming_distance) {
+        continue;
       }
-      if (candidate_euclidean_distances.size() > kNumTopCandidates) {
-        break;
+      const int position =
+          num_descriptors_with_hamming_distance[hamming_distance]++;
+      if (position < num_top_candidates) {
+        top_candidates[position] = candidate_descriptors[k];
       }
     }
 
+    // Compute the euclidean distance of the k descriptors with the best hamming
+    // distance. The rows of the descriptor matrices are contiguous.
+    const float* query_descriptor = descriptors1.row(i).data();
+    for (int k = 0; k < num_top_candidates; k++) {
+      const int candidate_id = top_candidates[k];
+      candidate_euclidean_distances[k] = std::make_pair(
+          l2_distance(descriptors2.row(candidate_id).data(),
+                      query_descriptor,
+                      descriptors1.cols()),
+          candidate_id);
+    }
+
     // Find the top 2 candidates based on euclidean distance.
     std::partial_sort(candidate_euclidean_distances.begin(),
                       candidate_euclidean_distances.begin() + 2,
-                      candidate_euclidean_distances.end());
+                      candidate_euclidean_distances.begin() +
+                          num_top_candidates);
 
     // Only add to output matches if it passes the ratio test.
     if (candidate_euclidean_distances[0].first >
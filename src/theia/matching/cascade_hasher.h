@@ -36,11 +36,18 @@
 #define THEIA_MATCHING_CASCADE_HASHER_H_
 
 #include <Eigen/Core>
+#include <array>
 #include <bitset>
+#include <cereal/access.hpp>
+#include <cereal/cereal.hpp>
+#include <cereal/types/bitset.hpp>
+#include <cereal/types/vector.hpp>
 #include <memory>
 #include <stdint.h>
 #include <vector>
 
+#include "theia/io/eigen_serializable.h"
+#include "theia/matching/keypoints_and_descriptors.h"
 #include "theia/util/random.h"
 
 namespace theia {
@@ -50,6 +57,8 @@ typedef std::vector<int> Bucket;
 
 // The number of dimensions of the Hash code.
 static const int kHashCodeSize = 128;
+// The number of 64-bit words of the hash code.
+static const int kNumHashCodeWords = kHashCodeSize / 64;
 // The number of bucket bits.
 static const int kNumBucketBits = 10;
 // The number of bucket groups.
@@ -58,16 +67,46 @@ static const int kNumBucketGroups = 6;
 static const int kNumBucketsPerGroup = 1 << kNumBucketBits;
 
 struct HashedSiftDescriptor {
-  // Hash code generated by the primary hashing function.
-  std::bitset<kHashCodeSize> hash_code;
+  // Hash code generated by the primary hashing function. Bit j of the code is
+  // bit j % 64 of word j / 64, so that the Hamming distance of two codes is
+  // computed with one popcount per word.
+  alignas(16) std::array<uint64_t, kNumHashCodeWords> hash_code;
   // Each bucket_ids[x] = y means the descriptor belongs to bucket y in bucket
   // group x.
   std::vector<uint16_t> bucket_ids;
+
+ private:
+  // Templated methods for disk I/O with cereal. The hash code is stored as a
+  // std::bitset so that hashed images written by older versions can be read.
+  friend class cereal::access;
+  template <class Archive>
+  void save(Archive& ar, const std::uint32_t version) const {  // NOLINT
+    std::bitset<kHashCodeSize> hash_code_bits;
+    for (int j = 0; j < kHashCodeSize; j++) {
+      hash_code_bits[j] = (hash_code[j / 64] >> (j % 64)) & 1;
+    }
+    ar(hash_code_bits, bucket_ids);
+  }
+
+  template <class Archive>
+  void load(Archive& ar, const std::uint32_t version) {  // NOLINT
+    std::bitset<kHashCodeSize> hash_code_bits;
+    ar(hash_code_bits, bucket_ids);
+    hash_code.fill(0);
+    for (int j = 0; j < kHashCodeSize; j++) {
+      hash_code[j / 64] |= static_cast<uint64_t>(hash_code_bits[j]) << (j % 64);
+    }
+  }
 };
 
 struct HashedImage {
   HashedImage() {}
 
+  // Identifies the hash projections that produced this hashed image (see
+  // CascadeHasher::Fingerprint). Hashed images are only comparable if they
+  // were created with the same projections.
+  uint64_t hasher_fingerprint = 0;
+
   // The mean of all descriptors (used for hashing).
   Eigen::VectorXf mean_descriptor;
 
@@ -76,6 +115,27 @@ struct HashedImage {
 
   // buckets[bucket_group][bucket_id] = bucket (container of sift ids).
   std::vector<std::vector<Bucket> > buckets;
+
+  // Fills the buckets from the bucket ids of the hashed descriptors.
+  void BuildBuckets();
+
+  // An estimate of the memory used by the hashed image.
+  size_t SizeInBytes() const;
+
+ private:
+  // Templated method for disk I/O with cereal. The buckets are fully determined
+  // by the bucket ids so they are rebuilt when loading instead of being stored.
+  friend class cereal::access;
+  template <class Archive>
+  void save(Archive& ar, const std::uint32_t version) const {  // NOLINT
+    ar(hasher_fingerprint, mean_descriptor, hashed_desc);
+  }
+
+  template <class Archive>
+  void load(Archive& ar, const std::uint32_t version) {  // NOLINT
+    ar(hasher_fingerprint, mean_descriptor, hashed_desc);
+    BuildBuckets();
+  }
 };
 
 // This hasher will hash SIFT descriptors with a two-step hashing system. The
@@ -95,17 +155,22 @@ class CascadeHasher {
   // cascade hasher.
   bool Initialize(const int num_dimensions_of_descriptor);
 
+  // Returns a checksum of the hash projections. It is stored in every hashed
+  // image so that hashed images saved by a differently initialized hasher are
+  // never used for matching.
+  uint64_t Fingerprint() const { return fingerprint_; }
+
   // Creates the hash codes for the sift descriptors and returns the hashed
-  // information.
+  // information. Each row of sift_desc is one descriptor.
   HashedImage CreateHashedSiftDescriptors(
-      const std::vector<Eigen::VectorXf>& sift_desc) const;
+      const DescriptorMatrix& sift_desc) const;
 
   // Matches images with a fast matching scheme based on the hash codes
   // previously generated.
   void MatchImages(const HashedImage& hashed_desc1,
-                   const std::vector<Eigen::VectorXf>& descriptors1,
+                   const DescriptorMatrix& descriptors1,
                    const HashedImage& hashed_desc2,
-                   const std::vector<Eigen::VectorXf>& descriptors2,
+                   const DescriptorMatrix& descriptors2,
                    const double lowes_ratio,
                    std::vector<IndexedFeatureMatch>* matches) const;
 
@@ -114,13 +179,9 @@ class CascadeHasher {
 
   // Creates the hash code for each descriptor and determines which buckets each
   // descriptor belongs to.
-  void CreateHashedDescriptors(const std::vector<Eigen::VectorXf>& sift_desc,
+  void CreateHashedDescriptors(const DescriptorMatrix& sift_desc,
                                HashedImage* hashed_image) const;
 
-  // Builds the buckets for an image based on the bucket ids and groups of the
-  // sift descriptors.
-  void BuildBuckets(HashedImage* hashed_image) const;
-
   // Number of dimensions of the descriptors.
   int num_dimensions_of_descriptor_;
 
@@ -129,8 +190,14 @@ class CascadeHasher {
 
   // Projection matrices of the secondary hashing function.
   Eigen::MatrixXf secondary_hash_projection_[kNumBucketGroups];
+
+  // Checksum of the projection matrices.
+  uint64_t fingerprint_ = 0;
 };
 
 }  // namespace theia
 
+CEREAL_CLASS_VERSION(theia::HashedSiftDescriptor, 0);
+CEREAL_CLASS_VERSION(theia::HashedImage, 0);
+
 #endif  // THEIA_MATCHING_CASCADE_HASHER_H_
@@ -41,6 +41,7 @@
 #include <mutex>  // NOLINT
 #include <string>
 #include <thread>  // NOLINT
+#include <utility>
 #include <vector>
 
 #include "theia/matching/cascade_hasher.h"
@@ -48,12 +49,19 @@
 #include "theia/matching/feature_matcher_utils.h"
 #include "theia/matching/features_and_matches_database.h"
 #include "theia/matching/indexed_feature_match.h"
-#include "theia/util/lru_cache.h"
+#include "theia/matching/hashed_image_cache.h"
 #include "theia/util/map_util.h"
+#include "theia/util/random.h"
 #include "theia/util/threadpool.h"
 #include "theia/util/util.h"
 
 namespace theia {
+namespace {
+// The hash projections are generated from a fixed seed so that hashed images
+// stored in the database remain valid across runs.
+static const unsigned kCascadeHasherSeed = 67;
+}  // namespace
+
 CascadeHashingFeatureMatcher::CascadeHashingFeatureMatcher(
     const FeatureMatcherOptions& options,
     FeaturesAndMatchesDatabase* features_and_matches_database)
@@ -64,19 +72,33 @@ CascadeHashingFeatureMatcher::CascadeHashingFeatureMatcher(
           std::bind(&CascadeHashingFeatureMatcher::FetchHashedImage,
                     this,
                     std::placeholders::_1);
-  // TODO: Stop hardcoding this!
-  static constexpr int kNumImagesInCache = 256;
+  const size_t cache_size_in_bytes =
+      static_cast<size_t>(options.hashed_images_cache_size_in_mb) << 20;
   hashed_images_.reset(
-      new HashedImageCache(fetch_hashed_images, kNumImagesInCache));
+      new HashedImageCache(fetch_hashed_images, cache_size_in_bytes));
 }
 
 CascadeHashingFeatureMatcher::~CascadeHashingFeatureMatcher() {}
 
 std::shared_ptr<HashedImage> CascadeHashingFeatureMatcher::FetchHashedImage(
     const std::string& image_name) {
-  const auto features = this->feature_and_matches_db_->GetFeatures(image_name);
-  return std::make_shared<HashedImage>(
-      cascade_hasher_->CreateHashedSiftDescriptors(features.descriptors));
+  auto hashed_image = std::make_shared<HashedImage>();
+  if (this->options_.store_hashed_images_in_database &&
+      this->feature_and_matches_db_->GetHashedImage(image_name,
+                                                    hashed_image.get()) &&
+      hashed_image->hasher_fingerprint == cascade_hasher_->Fingerprint()) {
+    return hashed_image;
+  }
+
+  const auto features =
+      this->feature_and_matches_db_->GetSharedFeatures(image_name);
+  DescriptorMatrix dequantized_descriptors;
+  *hashed_image = cascade_hasher_->CreateHashedSiftDescriptors(
+      features->FloatDescriptors(&dequantized_descriptors));
+  if (this->options_.store_hashed_images_in_database) {
+    this->feature_and_matches_db_->PutHashedImage(image_name, *hashed_image);
+  }
+  return hashed_image;
 }
 
 // Initializes the cascade hasher (only if needed).
@@ -84,7 +106,8 @@ void CascadeHashingFeatureMatcher::InitializeCascadeHasher(
     int descriptor_dimension) {
   CHECK_GT(descriptor_dimension, 0);
   // Initialize the cascade hasher
-  cascade_hasher_.reset(new CascadeHasher());
+  cascade_hasher_.reset(new CascadeHasher(
+      std::make_shared<RandomNumberGenerator>(kCascadeHasherSeed)));
   CHECK(cascade_hasher_->Initialize(descriptor_dimension))
       << "Could not initialize the cascade hasher.";
 }
@@ -101,12 +124,12 @@ void CascadeHashingFeatureMatcher::AddImage(const std::string& image_name) {
   const KeypointsAndDescriptors& features =
       this->feature_and_matches_db_->GetFeatures(image_name);
 
-  if (features.descriptors.size() == 0) {
+  if (features.NumDescriptors() == 0) {
     return;
   }
 
   // Initialize the cascade hasher if needed.
-  InitializeCascadeHasher(features.descriptors[0].size());
+  InitializeCascadeHasher(features.DescriptorDimension());
 }
 
 void CascadeHashingFeatureMatcher::AddImages(
@@ -120,13 +143,31 @@ void CascadeHashingFeatureMatcher::AddImages(
   for (int i = 0; i < image_names.size(); i++) {
     const KeypointsAndDescriptors& init_features =
         this->feature_and_matches_db_->GetFeatures(image_names[i]);
-    if (init_features.descriptors.size() > 0) {
-      InitializeCascadeHasher(init_features.descriptors[0].size());
+    if (init_features.NumDescriptors() > 0) {
+      InitializeCascadeHasher(init_features.DescriptorDimension());
       return;
     }
   }
 }
 
+void CascadeHashingFeatureMatcher::MatchImages() {
+  SelectPairsToMatchIfNeeded();
+  // The hashed images are cached by image name.
+  std::vector<std::pair<std::string, std::string>> image_name_pairs;
+  image_name_pairs.reserve(pairs_to_match_.size());
+  for (const auto& pair : pairs_to_match_) {
+    image_name_pairs.emplace_back(
+        feature_and_matches_db_->ImageNameOfId(pair.first),
+        feature_and_matches_db_->ImageNameOfId(pair.second));
+  }
+  hashed_images_->SetSchedule(image_name_pairs);
+  FeatureMatcher::MatchImages();
+
+  VLOG(1) << "Hashed image cache: " << hashed_images_->NumCacheHits()
+          << " hits, " << hashed_images_->NumCacheMisses() << " misses, "
+          << hashed_images_->NumEvictions() << " evictions.";
+}
+
 bool CascadeHashingFeatureMatcher::MatchImagePair(
     const KeypointsAndDescriptors& features1,
     const KeypointsAndDescriptors& features2,
@@ -137,16 +178,24 @@ bool CascadeHashingFeatureMatcher::MatchImagePair(
 
   // If no hashed features exist for either image, skip.
   if (!hashed_features1 || !hashed_features2) {
+    hashed_images_->Release(features1.image_name);
+    hashed_images_->Release(features2.image_name);
     return false;
   }
 
-  // Match features between the images.
+  // Match features between the images. Quantized descriptors are dequantized
+  // since the cascade hasher compares float descriptors.
+  DescriptorMatrix dequantized_descriptors1, dequantized_descriptors2;
+  const DescriptorMatrix& descriptors1 =
+      features1.FloatDescriptors(&dequantized_descriptors1);
+  const DescriptorMatrix& descriptors2 =
+      features2.FloatDescriptors(&dequantized_descriptors2);
   const double lowes_ratio =
       (this->options_.use_lowes_ratio) ? this->options_.lowes_ratio : 1.0;
   cascade_hasher_->MatchImages(*hashed_features1,
-                               features1.descriptors,
+                               descriptors1,
                                *hashed_features2,
-                               features2.descriptors,
+                               descriptors2,
                                lowes_ratio,
                                matches);
   // Only do symmetric matching if enough matches exist to begin with.
@@ -154,14 +203,16 @@ bool CascadeHashingFeatureMatcher::MatchImagePair(
       this->options_.keep_only_symmetric_matches) {
     std::vector<IndexedFeatureMatch> backwards_matches;
     cascade_hasher_->MatchImages(*hashed_features2,
-                                 features2.descriptors,
+                                 descriptors2,
                                  *hashed_features1,
-                                 features1.descriptors,
+                                 descriptors1,
                                  lowes_ratio,
                                  &backwards_matches);
     IntersectMatches(backwards_matches, matches);
   }
 
+  hashed_images_->Release(features1.image_name);
+  hashed_images_->Release(features2.image_name);
   return matches->size() >= this->options_.min_num_feature_matches;
 }
 
@@ -44,7 +44,7 @@
 #include "theia/matching/cascade_hasher.h"
 #include "theia/matching/feature_matcher.h"
 #include "theia/matching/features_and_matches_database.h"
-#include "theia/util/lru_cache.h"
+#include "theia/matching/hashed_image_cache.h"
 
 namespace theia {
 class Keypoint;
@@ -70,18 +70,24 @@ class CascadeHashingFeatureMatcher : public FeatureMatcher {
   // parallel.
   void AddImages(const std::vector<std::string>& image_names) override;
 
+  // Matches the image pairs as in the base class. The pair schedule is given to
+  // the hashed image cache first so that each hashed image is dropped as soon
+  // as its last pair has been matched.
+  void MatchImages() override;
+
  private:
   bool MatchImagePair(const KeypointsAndDescriptors& features1,
                       const KeypointsAndDescriptors& features2,
                       std::vector<IndexedFeatureMatch>* matches) override;
 
-  // Method to fetch hashed images and store them in a cache.
+  // Method to fetch hashed images and store them in a cache. Hashed images are
+  // read from the database if they were stored with the same hasher, and are
+  // otherwise created and written to the database.
   std::shared_ptr<HashedImage> FetchHashedImage(const std::string& image_name);
 
   // Initializes the cascade hasher (only if needed).
   void InitializeCascadeHasher(int descriptor_dimension);
 
-  using HashedImageCache = LRUCache<std::string, std::shared_ptr<HashedImage>>;
   std::unique_ptr<HashedImageCache> hashed_images_;
   std::unique_ptr<CascadeHasher> cascade_hasher_;
 
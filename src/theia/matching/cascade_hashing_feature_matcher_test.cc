@@ -53,16 +53,17 @@ static const int kNumDescriptorDimensions = 10;
 TEST(CascadeHashingFeatureMatcherTest, NoOptions) {
   // Set up descriptors.
   KeypointsAndDescriptors features1, features2;
+  std::vector<VectorXf> descriptors1, descriptors2;
   features1.image_name = "1";
   features2.image_name = "2";
-  features1.descriptors.resize(kNumDescriptors);
-  features2.descriptors.resize(kNumDescriptors);
+  descriptors1.resize(kNumDescriptors);
+  descriptors2.resize(kNumDescriptors);
   for (int i = 0; i < kNumDescriptors; i++) {
     // Avoid a zero vector.
-    features1.descriptors[i] = VectorXf::Constant(kNumDescriptorDimensions, 1);
-    features2.descriptors[i] = VectorXf::Constant(kNumDescriptorDimensions, 1);
-    features1.descriptors[i].normalize();
-    features2.descriptors[i].normalize();
+    descriptors1[i] = VectorXf::Constant(kNumDescriptorDimensions, 1);
+    descriptors2[i] = VectorXf::Constant(kNumDescriptorDimensions, 1);
+    descriptors1[i].normalize();
+    descriptors2[i].normalize();
   }
 
   // Set options.
@@ -73,8 +74,10 @@ TEST(CascadeHashingFeatureMatcherTest, NoOptions) {
   options.perform_geometric_verification = false;
 
   // Add features.
-  features1.keypoints.resize(features1.descriptors.size());
-  features2.keypoints.resize(features2.descriptors.size());
+  features1.SetDescriptors(descriptors1);
+  features2.SetDescriptors(descriptors2);
+  features1.keypoints.resize(descriptors1.size());
+  features2.keypoints.resize(descriptors2.size());
 
   InMemoryFeaturesAndMatchesDatabase database;
   database.PutFeatures("1", features1);
@@ -94,21 +97,22 @@ TEST(CascadeHashingFeatureMatcherTest, NoOptions) {
 TEST(CascadeHashingFeatureMatcherTest, RatioTest) {
   // Set up descriptors.
   KeypointsAndDescriptors features1, features2;
+  std::vector<VectorXf> descriptors1, descriptors2;
   features1.image_name = "1";
   features2.image_name = "2";
-  features1.descriptors.resize(1);
-  features2.descriptors.resize(2);
-  features1.descriptors[0] =
+  descriptors1.resize(1);
+  descriptors2.resize(2);
+  descriptors1[0] =
       VectorXf::Constant(kNumDescriptorDimensions, 1).normalized();
 
   // Set the two descriptors to be very close to each other so that they do not
   // pass the ratio test.
-  features2.descriptors[0] = VectorXf::Constant(kNumDescriptorDimensions, 1);
-  features2.descriptors[0](0) = 0.9;
-  features2.descriptors[0].normalize();
-  features2.descriptors[1] = VectorXf::Constant(kNumDescriptorDimensions, 1);
-  features2.descriptors[1](0) = 0.89;
-  features2.descriptors[1].normalize();
+  descriptors2[0] = VectorXf::Constant(kNumDescriptorDimensions, 1);
+  descriptors2[0](0) = 0.9;
+  descriptors2[0].normalize();
+  descriptors2[1] = VectorXf::Constant(kNumDescriptorDimensions, 1);
+  descriptors2[1](0) = 0.89;
+  descriptors2[1].normalize();
 
   // Set options.
   FeatureMatcherOptions options;
@@ -118,8 +122,10 @@ TEST(CascadeHashingFeatureMatcherTest, RatioTest) {
   options.perform_geometric_verification = false;
 
   // Add features.
-  features1.keypoints.resize(features1.descriptors.size());
-  features2.keypoints.resize(features2.descriptors.size());
+  features1.SetDescriptors(descriptors1);
+  features2.SetDescriptors(descriptors2);
+  features1.keypoints.resize(descriptors1.size());
+  features2.keypoints.resize(descriptors2.size());
 
   InMemoryFeaturesAndMatchesDatabase database;
   database.PutFeatures("1", features1);
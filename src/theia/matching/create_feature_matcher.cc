@@ -42,6 +42,8 @@
 #include "theia/matching/distance.h"
 #include "theia/matching/feature_matcher.h"
 #include "theia/matching/features_and_matches_database.h"
+#include "theia/matching/kd_tree_feature_matcher.h"
+#include "theia/matching/lsh_feature_matcher.h"
 
 namespace theia {
 
@@ -56,6 +58,12 @@ std::unique_ptr<FeatureMatcher> CreateFeatureMatcher(
   } else if (matching_strategy == MatchingStrategy::BRUTE_FORCE) {
     matcher.reset(
         new BruteForceFeatureMatcher(options, features_and_matches_database));
+  } else if (matching_strategy == MatchingStrategy::BINARY_LSH) {
+    matcher.reset(
+        new LshFeatureMatcher(options, features_and_matches_database));
+  } else if (matching_strategy == MatchingStrategy::KD_TREE) {
+    matcher.reset(
+        new KdTreeFeatureMatcher(options, features_and_matches_database));
   } else {
     LOG(FATAL) << "Invalid matching strategy specified.";
   }
@@ -46,10 +46,13 @@ struct FeatureMatcherOptions;
 enum class MatchingStrategy {
   BRUTE_FORCE = 0,
   CASCADE_HASHING = 1,
+  BINARY_LSH = 2,
+  KD_TREE = 3,
 };
 
-// A factory method for creating an L2-based feature matcher (i.e. for float
-// descriptors).
+// A factory method for creating a feature matcher. BRUTE_FORCE works with both
+// float and binary descriptors, CASCADE_HASHING and KD_TREE only with float
+// descriptors and BINARY_LSH only with binary descriptors.
 std::unique_ptr<FeatureMatcher> CreateFeatureMatcher(
     const MatchingStrategy& matching_strategy,
     const FeatureMatcherOptions& options,
@@ -0,0 +1,65 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+
+#ifndef THEIA_MATCHING_DESCRIPTOR_TYPES_H_
+#define THEIA_MATCHING_DESCRIPTOR_TYPES_H_
+
+#include <Eigen/Core>
+#include <stdint.h>
+
+namespace theia {
+
+// All descriptors of an image are stored in a single contiguous row-major
+// block so that row i holds the descriptor of keypoint i. This avoids one heap
+// allocation per descriptor and allows the matchers to stream through memory.
+typedef Eigen::Matrix<float, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>
+    DescriptorMatrix;
+
+// Float descriptors quantized to one byte per dimension, stored one per row.
+// A value x is stored as round(x * scale) clamped to [0, 255], so squared L2
+// distances between quantized descriptors are scale^2 times the float
+// distances.
+typedef Eigen::Matrix<uint8_t, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>
+    QuantizedDescriptorMatrix;
+
+// Bit-packed binary descriptors (e.g. AKAZE MLDB) stored one per row. Each row
+// holds ceil(num_bits / 8) bytes with the first bit in the least significant
+// bit of the first byte.
+typedef Eigen::Matrix<uint8_t, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>
+    BinaryDescriptorMatrix;
+
+}  // namespace theia
+
+#endif  // THEIA_MATCHING_DESCRIPTOR_TYPES_H_
@@ -0,0 +1,728 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#include "theia/matching/distance.h"
+
+#include <glog/logging.h>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+
+// Runtime dispatch on x86 relies on per-function target attributes so that
+// the kernels may be compiled without raising the baseline ISA of the library.
+#if (defined(__x86_64__) || defined(__i386__)) && \
+    (defined(__GNUC__) || defined(__clang__))
+#define THEIA_DISTANCE_X86_KERNELS
+#include <immintrin.h>
+#endif
+
+// NEON is mandatory on AArch64 so it can be selected at compile time.
+#if defined(__aarch64__) && defined(__ARM_NEON)
+#define THEIA_DISTANCE_NEON_KERNELS
+#include <arm_neon.h>
+#endif
+
+namespace theia {
+
+namespace {
+
+static const int kSiftDescriptorSize = 128;
+static const int kNumBytes256BitDescriptor = 32;
+static const int kNumBytes486BitDescriptor = 61;
+
+typedef float (*SquaredL2Kernel)(const float*, const float*, const int);
+typedef int (*HammingKernel)(const uint8_t*, const uint8_t*, const int);
+typedef int (*QuantizedSquaredL2Kernel)(const uint8_t*,
+                                        const uint8_t*,
+                                        const int);
+
+// The set of kernels for a single instruction set.
+struct DistanceKernels {
+  DistanceInstructionSet instruction_set;
+  SquaredL2Kernel squared_l2;
+  SquaredL2Kernel squared_l2_128;
+  QuantizedSquaredL2Kernel quantized_squared_l2;
+  HammingKernel hamming;
+  HammingKernel hamming_256;
+  HammingKernel hamming_486;
+};
+
+inline uint64_t LoadUint64(const uint8_t* data) {
+  uint64_t value;
+  std::memcpy(&value, data, sizeof(value));
+  return value;
+}
+
+// ---------------------------------- Scalar ----------------------------------
+
+inline int PopulationCount(uint64_t x) {
+  x = x - ((x >> 1) & 0x5555555555555555ULL);
+  x = (x & 0x3333333333333333ULL) + ((x >> 2) & 0x3333333333333333ULL);
+  x = (x + (x >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+  return static_cast<int>((x * 0x0101010101010101ULL) >> 56);
+}
+
+inline float SquaredL2DistanceScalarImpl(const float* a,
+                                         const float* b,
+                                         const int size) {
+  float sum0 = 0, sum1 = 0, sum2 = 0, sum3 = 0;
+  int i = 0;
+  for (; i + 4 <= size; i += 4) {
+    const float diff0 = a[i] - b[i];
+    const float diff1 = a[i + 1] - b[i + 1];
+    const float diff2 = a[i + 2] - b[i + 2];
+    const float diff3 = a[i + 3] - b[i + 3];
+    sum0 += diff0 * diff0;
+    sum1 += diff1 * diff1;
+    sum2 += diff2 * diff2;
+    sum3 += diff3 * diff3;
+  }
+  for (; i < size; i++) {
+    const float diff = a[i] - b[i];
+    sum0 += diff * diff;
+  }
+  return (sum0 + sum1) + (sum2 + sum3);
+}
+
+inline int QuantizedSquaredL2DistanceScalarImpl(const uint8_t* a,
+                                                const uint8_t* b,
+                                                const int size) {
+  int distance = 0;
+  for (int i = 0; i < size; i++) {
+    const int diff = static_cast<int>(a[i]) - static_cast<int>(b[i]);
+    distance += diff * diff;
+  }
+  return distance;
+}
+
+inline int HammingDistanceScalarImpl(const uint8_t* a,
+                                     const uint8_t* b,
+                                     const int num_bytes) {
+  int distance = 0;
+  int i = 0;
+  for (; i + 8 <= num_bytes; i += 8) {
+    distance += PopulationCount(LoadUint64(a + i) ^ LoadUint64(b + i));
+  }
+  for (; i < num_bytes; i++) {
+    distance += PopulationCount(static_cast<uint64_t>(a[i] ^ b[i]));
+  }
+  return distance;
+}
+
+float SquaredL2DistanceScalar(const float* a, const float* b, const int size) {
+  return SquaredL2DistanceScalarImpl(a, b, size);
+}
+
+float SquaredL2Distance128Scalar(const float* a, const float* b, const int) {
+  return SquaredL2DistanceScalarImpl(a, b, kSiftDescriptorSize);
+}
+
+int QuantizedSquaredL2DistanceScalar(const uint8_t* a,
+                                     const uint8_t* b,
+                                     const int size) {
+  return QuantizedSquaredL2DistanceScalarImpl(a, b, size);
+}
+
+int HammingDistanceScalar(const uint8_t* a, const uint8_t* b, const int size) {
+  return HammingDistanceScalarImpl(a, b, size);
+}
+
+int HammingDistance256Scalar(const uint8_t* a, const uint8_t* b, const int) {
+  return HammingDistanceScalarImpl(a, b, kNumBytes256BitDescriptor);
+}
+
+int HammingDistance486Scalar(const uint8_t* a, const uint8_t* b, const int) {
+  return HammingDistanceScalarImpl(a, b, kNumBytes486BitDescriptor);
+}
+
+const DistanceKernels kScalarKernels = {DistanceInstructionSet::SCALAR,
+                                        SquaredL2DistanceScalar,
+                                        SquaredL2Distance128Scalar,
+                                        QuantizedSquaredL2DistanceScalar,
+                                        HammingDistanceScalar,
+                                        HammingDistance256Scalar,
+                                        HammingDistance486Scalar};
+
+#ifdef THEIA_DISTANCE_X86_KERNELS
+
+// ----------------------------------- SSE4 -----------------------------------
+
+#define THEIA_TARGET_SSE4 __attribute__((target("sse4.2,popcnt")))
+
+THEIA_TARGET_SSE4 inline float HorizontalSum(const __m128 x) {
+  const __m128 shuffled = _mm_movehdup_ps(x);
+  const __m128 sums = _mm_add_ps(x, shuffled);
+  return _mm_cvtss_f32(_mm_add_ss(sums, _mm_movehl_ps(shuffled, sums)));
+}
+
+THEIA_TARGET_SSE4 inline float SquaredL2DistanceSSE4Impl(const float* a,
+                                                         const float* b,
+                                                         const int size) {
+  __m128 sum0 = _mm_setzero_ps();
+  __m128 sum1 = _mm_setzero_ps();
+  int i = 0;
+  for (; i + 8 <= size; i += 8) {
+    const __m128 diff0 = _mm_sub_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i));
+    const __m128 diff1 =
+        _mm_sub_ps(_mm_loadu_ps(a + i + 4), _mm_loadu_ps(b + i + 4));
+    sum0 = _mm_add_ps(sum0, _mm_mul_ps(diff0, diff0));
+    sum1 = _mm_add_ps(sum1, _mm_mul_ps(diff1, diff1));
+  }
+  for (; i + 4 <= size; i += 4) {
+    const __m128 diff = _mm_sub_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i));
+    sum0 = _mm_add_ps(sum0, _mm_mul_ps(diff, diff));
+  }
+  float distance = HorizontalSum(_mm_add_ps(sum0, sum1));
+  for (; i < size; i++) {
+    const float diff = a[i] - b[i];
+    distance += diff * diff;
+  }
+  return distance;
+}
+
+// Widens 16 bytes at a time to 16-bit differences whose squares are summed in
+// pairs into 32-bit lanes with PMADDWD.
+THEIA_TARGET_SSE4 inline int QuantizedSquaredL2DistanceSSE4Impl(
+    const uint8_t* a, const uint8_t* b, const int size) {
+  const __m128i zero = _mm_setzero_si128();
+  __m128i sum = _mm_setzero_si128();
+  int i = 0;
+  for (; i + 16 <= size; i += 16) {
+    const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+    const __m128i y = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+    const __m128i diff_low =
+        _mm_sub_epi16(_mm_unpacklo_epi8(x, zero), _mm_unpacklo_epi8(y, zero));
+    const __m128i diff_high =
+        _mm_sub_epi16(_mm_unpackhi_epi8(x, zero), _mm_unpackhi_epi8(y, zero));
+    sum = _mm_add_epi32(sum, _mm_madd_epi16(diff_low, diff_low));
+    sum = _mm_add_epi32(sum, _mm_madd_epi16(diff_high, diff_high));
+  }
+  sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(1, 0, 3, 2)));
+  sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+  int distance = _mm_cvtsi128_si32(sum);
+  for (; i < size; i++) {
+    const int diff = static_cast<int>(a[i]) - static_cast<int>(b[i]);
+    distance += diff * diff;
+  }
+  return distance;
+}
+
+// Uses the hardware POPCNT instruction on 64-bit words.
+THEIA_TARGET_SSE4 inline int HammingDistancePopcntImpl(const uint8_t* a,
+                                                       const uint8_t* b,
+                                                       const int num_bytes) {
+  int distance = 0;
+  int i = 0;
+  for (; i + 8 <= num_bytes; i += 8) {
+    distance += __builtin_popcountll(LoadUint64(a + i) ^ LoadUint64(b + i));
+  }
+  for (; i < num_bytes; i++) {
+    distance += __builtin_popcount(a[i] ^ b[i]);
+  }
+  return distance;
+}
+
+THEIA_TARGET_SSE4 float SquaredL2DistanceSSE4(const float* a,
+                                              const float* b,
+                                              const int size) {
+  return SquaredL2DistanceSSE4Impl(a, b, size);
+}
+
+THEIA_TARGET_SSE4 float SquaredL2Distance128SSE4(const float* a,
+                                                 const float* b,
+                                                 const int) {
+  return SquaredL2DistanceSSE4Impl(a, b, kSiftDescriptorSize);
+}
+
+THEIA_TARGET_SSE4 int QuantizedSquaredL2DistanceSSE4(const uint8_t* a,
+                                                     const uint8_t* b,
+                                                     const int size) {
+  return QuantizedSquaredL2DistanceSSE4Impl(a, b, size);
+}
+
+THEIA_TARGET_SSE4 int HammingDistancePopcnt(const uint8_t* a,
+                                            const uint8_t* b,
+                                            const int num_bytes) {
+  return HammingDistancePopcntImpl(a, b, num_bytes);
+}
+
+THEIA_TARGET_SSE4 int HammingDistance256Popcnt(const uint8_t* a,
+                                               const uint8_t* b,
+                                               const int) {
+  return HammingDistancePopcntImpl(a, b, kNumBytes256BitDescriptor);
+}
+
+THEIA_TARGET_SSE4 int HammingDistance486Popcnt(const uint8_t* a,
+                                               const uint8_t* b,
+                                               const int) {
+  return HammingDistancePopcntImpl(a, b, kNumBytes486BitDescriptor);
+}
+
+const DistanceKernels kSSE4Kernels = {DistanceInstructionSet::SSE4,
+                                      SquaredL2DistanceSSE4,
+                                      SquaredL2Distance128SSE4,
+                                      QuantizedSquaredL2DistanceSSE4,
+                                      HammingDistancePopcnt,
+                                      HammingDistance256Popcnt,
+                                      HammingDistance486Popcnt};
+
+// ----------------------------------- AVX2 -----------------------------------
+
+#define THEIA_TARGET_AVX2 __attribute__((target("avx2,fma,popcnt")))
+
+THEIA_TARGET_AVX2 inline float HorizontalSum(const __m256 x) {
+  const __m128 sum = _mm_add_ps(_mm256_castps256_ps128(x),
+                                _mm256_extractf128_ps(x, 1));
+  const __m128 shuffled = _mm_movehdup_ps(sum);
+  const __m128 sums = _mm_add_ps(sum, shuffled);
+  return _mm_cvtss_f32(_mm_add_ss(sums, _mm_movehl_ps(shuffled, sums)));
+}
+
+THEIA_TARGET_AVX2 inline float SquaredL2DistanceAVX2Impl(const float* a,
+                                                         const float* b,
+                                                         const int size) {
+  __m256 sum0 = _mm256_setzero_ps();
+  __m256 sum1 = _mm256_setzero_ps();
+  int i = 0;
+  for (; i + 16 <= size; i += 16) {
+    const __m256 diff0 =
+        _mm256_sub_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i));
+    const __m256 diff1 =
+        _mm256_sub_ps(_mm256_loadu_ps(a + i + 8), _mm256_loadu_ps(b + i + 8));
+    sum0 = _mm256_fmadd_ps(diff0, diff0, sum0);
+    sum1 = _mm256_fmadd_ps(diff1, diff1, sum1);
+  }
+  for (; i + 8 <= size; i += 8) {
+    const __m256 diff =
+        _mm256_sub_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i));
+    sum0 = _mm256_fmadd_ps(diff, diff, sum0);
+  }
+  float distance = HorizontalSum(_mm256_add_ps(sum0, sum1));
+  for (; i < size; i++) {
+    const float diff = a[i] - b[i];
+    distance += diff * diff;
+  }
+  return distance;
+}
+
+THEIA_TARGET_AVX2 inline int QuantizedSquaredL2DistanceAVX2Impl(
+    const uint8_t* a, const uint8_t* b, const int size) {
+  __m256i sum0 = _mm256_setzero_si256();
+  __m256i sum1 = _mm256_setzero_si256();
+  int i = 0;
+  for (; i + 32 <= size; i += 32) {
+    const __m128i* x = reinterpret_cast<const __m128i*>(a + i);
+    const __m128i* y = reinterpret_cast<const __m128i*>(b + i);
+    const __m256i diff0 =
+        _mm256_sub_epi16(_mm256_cvtepu8_epi16(_mm_loadu_si128(x)),
+                         _mm256_cvtepu8_epi16(_mm_loadu_si128(y)));
+    const __m256i diff1 =
+        _mm256_sub_epi16(_mm256_cvtepu8_epi16(_mm_loadu_si128(x + 1)),
+                         _mm256_cvtepu8_epi16(_mm_loadu_si128(y + 1)));
+    sum0 = _mm256_add_epi32(sum0, _mm256_madd_epi16(diff0, diff0));
+    sum1 = _mm256_add_epi32(sum1, _mm256_madd_epi16(diff1, diff1));
+  }
+  for (; i + 16 <= size; i += 16) {
+    const __m256i diff = _mm256_sub_epi16(
+        _mm256_cvtepu8_epi16(
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i))),
+        _mm256_cvtepu8_epi16(
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i))));
+    sum0 = _mm256_add_epi32(sum0, _mm256_madd_epi16(diff, diff));
+  }
+  const __m256i sum256 = _mm256_add_epi32(sum0, sum1);
+  __m128i sum = _mm_add_epi32(_mm256_castsi256_si128(sum256),
+                              _mm256_extracti128_si256(sum256, 1));
+  sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(1, 0, 3, 2)));
+  sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+  int distance = _mm_cvtsi128_si32(sum);
+  for (; i < size; i++) {
+    const int diff = static_cast<int>(a[i]) - static_cast<int>(b[i]);
+    distance += diff * diff;
+  }
+  return distance;
+}
+
+// Counts bits 32 bytes at a time with a nibble lookup table (Mula et al.).
+THEIA_TARGET_AVX2 inline int HammingDistanceAVX2Impl(const uint8_t* a,
+                                                     const uint8_t* b,
+                                                     const int num_bytes) {
+  const __m256i lookup = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3,
+                                          1, 2, 2, 3, 2, 3, 3, 4,
+                                          0, 1, 1, 2, 1, 2, 2, 3,
+                                          1, 2, 2, 3, 2, 3, 3, 4);
+  const __m256i low_mask = _mm256_set1_epi8(0x0f);
+  __m256i sum = _mm256_setzero_si256();
+  int i = 0;
+  for (; i + 32 <= num_bytes; i += 32) {
+    const __m256i x = _mm256_xor_si256(
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i)),
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i)));
+    const __m256i low = _mm256_and_si256(x, low_mask);
+    const __m256i high = _mm256_and_si256(_mm256_srli_epi16(x, 4), low_mask);
+    const __m256i counts = _mm256_add_epi8(_mm256_shuffle_epi8(lookup, low),
+                                           _mm256_shuffle_epi8(lookup, high));
+    sum = _mm256_add_epi64(sum,
+                           _mm256_sad_epu8(counts, _mm256_setzero_si256()));
+  }
+  int distance = static_cast<int>(_mm256_extract_epi64(sum, 0) +
+                                  _mm256_extract_epi64(sum, 1) +
+                                  _mm256_extract_epi64(sum, 2) +
+                                  _mm256_extract_epi64(sum, 3));
+  for (; i + 8 <= num_bytes; i += 8) {
+    distance += __builtin_popcountll(LoadUint64(a + i) ^ LoadUint64(b + i));
+  }
+  for (; i < num_bytes; i++) {
+    distance += __builtin_popcount(a[i] ^ b[i]);
+  }
+  return distance;
+}
+
+THEIA_TARGET_AVX2 float SquaredL2DistanceAVX2(const float* a,
+                                              const float* b,
+                                              const int size) {
+  return SquaredL2DistanceAVX2Impl(a, b, size);
+}
+
+THEIA_TARGET_AVX2 float SquaredL2Distance128AVX2(const float* a,
+                                                 const float* b,
+                                                 const int) {
+  return SquaredL2DistanceAVX2Impl(a, b, kSiftDescriptorSize);
+}
+
+THEIA_TARGET_AVX2 int QuantizedSquaredL2DistanceAVX2(const uint8_t* a,
+                                                     const uint8_t* b,
+                                                     const int size) {
+  return QuantizedSquaredL2DistanceAVX2Impl(a, b, size);
+}
+
+THEIA_TARGET_AVX2 int HammingDistanceAVX2(const uint8_t* a,
+                                          const uint8_t* b,
+                                          const int num_bytes) {
+  return HammingDistanceAVX2Impl(a, b, num_bytes);
+}
+
+THEIA_TARGET_AVX2 int HammingDistance256AVX2(const uint8_t* a,
+                                             const uint8_t* b,
+                                             const int) {
+  return HammingDistanceAVX2Impl(a, b, kNumBytes256BitDescriptor);
+}
+
+THEIA_TARGET_AVX2 int HammingDistance486AVX2(const uint8_t* a,
+                                             const uint8_t* b,
+                                             const int) {
+  return HammingDistanceAVX2Impl(a, b, kNumBytes486BitDescriptor);
+}
+
+const DistanceKernels kAVX2Kernels = {DistanceInstructionSet::AVX2,
+                                      SquaredL2DistanceAVX2,
+                                      SquaredL2Distance128AVX2,
+                                      QuantizedSquaredL2DistanceAVX2,
+                                      HammingDistanceAVX2,
+                                      HammingDistance256AVX2,
+                                      HammingDistance486AVX2};
+
+// ---------------------------------- AVX-512 ---------------------------------
+
+#define THEIA_TARGET_AVX512 __attribute__((target("avx512f")))
+
+THEIA_TARGET_AVX512 inline float SquaredL2DistanceAVX512Impl(const float* a,
+                                                             const float* b,
+                                                             const int size) {
+  __m512 sum0 = _mm512_setzero_ps();
+  __m512 sum1 = _mm512_setzero_ps();
+  int i = 0;
+  for (; i + 32 <= size; i += 32) {
+    const __m512 diff0 =
+        _mm512_sub_ps(_mm512_loadu_ps(a + i), _mm512_loadu_ps(b + i));
+    const __m512 diff1 = _mm512_sub_ps(_mm512_loadu_ps(a + i + 16),
+                                       _mm512_loadu_ps(b + i + 16));
+    sum0 = _mm512_fmadd_ps(diff0, diff0, sum0);
+    sum1 = _mm512_fmadd_ps(diff1, diff1, sum1);
+  }
+  for (; i + 16 <= size; i += 16) {
+    const __m512 diff =
+        _mm512_sub_ps(_mm512_loadu_ps(a + i), _mm512_loadu_ps(b + i));
+    sum0 = _mm512_fmadd_ps(diff, diff, sum0);
+  }
+  // The remaining elements are handled with a masked load.
+  if (i < size) {
+    const __mmask16 mask = static_cast<__mmask16>((1u << (size - i)) - 1);
+    const __m512 diff = _mm512_sub_ps(_mm512_maskz_loadu_ps(mask, a + i),
+                                      _mm512_maskz_loadu_ps(mask, b + i));
+    sum1 = _mm512_fmadd_ps(diff, diff, sum1);
+  }
+  return _mm512_reduce_add_ps(_mm512_add_ps(sum0, sum1));
+}
+
+THEIA_TARGET_AVX512 float SquaredL2DistanceAVX512(const float* a,
+                                                  const float* b,
+                                                  const int size) {
+  return SquaredL2DistanceAVX512Impl(a, b, size);
+}
+
+THEIA_TARGET_AVX512 float SquaredL2Distance128AVX512(const float* a,
+                                                     const float* b,
+                                                     const int) {
+  return SquaredL2DistanceAVX512Impl(a, b, kSiftDescriptorSize);
+}
+
+// Binary and quantized descriptors are at most a few cache lines long, so the
+// AVX2 kernels are used for Hamming and quantized distances.
+const DistanceKernels kAVX512Kernels = {DistanceInstructionSet::AVX512,
+                                        SquaredL2DistanceAVX512,
+                                        SquaredL2Distance128AVX512,
+                                        QuantizedSquaredL2DistanceAVX2,
+                                        HammingDistanceAVX2,
+                                        HammingDistance256AVX2,
+                                        HammingDistance486AVX2};
+
+#endif  // THEIA_DISTANCE_X86_KERNELS
+
+#ifdef THEIA_DISTANCE_NEON_KERNELS
+
+// ----------------------------------- NEON -----------------------------------
+
+inline float SquaredL2DistanceNEONImpl(const float* a,
+                                       const float* b,
+                                       const int size) {
+  float32x4_t sum0 = vdupq_n_f32(0.0f);
+  float32x4_t sum1 = vdupq_n_f32(0.0f);
+  int i = 0;
+  for (; i + 8 <= size; i += 8) {
+    const float32x4_t diff0 = vsubq_f32(vld1q_f32(a + i), vld1q_f32(b + i));
+    const float32x4_t diff1 =
+        vsubq_f32(vld1q_f32(a + i + 4), vld1q_f32(b + i + 4));
+    sum0 = vfmaq_f32(sum0, diff0, diff0);
+    sum1 = vfmaq_f32(sum1, diff1, diff1);
+  }
+  for (; i + 4 <= size; i += 4) {
+    const float32x4_t diff = vsubq_f32(vld1q_f32(a + i), vld1q_f32(b + i));
+    sum0 = vfmaq_f32(sum0, diff, diff);
+  }
+  float distance = vaddvq_f32(vaddq_f32(sum0, sum1));
+  for (; i < size; i++) {
+    const float diff = a[i] - b[i];
+    distance += diff * diff;
+  }
+  return distance;
+}
+
+inline int QuantizedSquaredL2DistanceNEONImpl(const uint8_t* a,
+                                              const uint8_t* b,
+                                              const int size) {
+  uint32x4_t sum = vdupq_n_u32(0);
+  int i = 0;
+  for (; i + 16 <= size; i += 16) {
+    const uint8x16_t diff = vabdq_u8(vld1q_u8(a + i), vld1q_u8(b + i));
+    const uint8x8_t diff_low = vget_low_u8(diff);
+    const uint8x8_t diff_high = vget_high_u8(diff);
+    sum = vpadalq_u16(sum, vmull_u8(diff_low, diff_low));
+    sum = vpadalq_u16(sum, vmull_u8(diff_high, diff_high));
+  }
+  int distance = static_cast<int>(vaddvq_u32(sum));
+  for (; i < size; i++) {
+    const int diff = static_cast<int>(a[i]) - static_cast<int>(b[i]);
+    distance += diff * diff;
+  }
+  return distance;
+}
+
+inline int HammingDistanceNEONImpl(const uint8_t* a,
+                                   const uint8_t* b,
+                                   const int num_bytes) {
+  int distance = 0;
+  int i = 0;
+  for (; i + 16 <= num_bytes; i += 16) {
+    const uint8x16_t x = veorq_u8(vld1q_u8(a + i), vld1q_u8(b + i));
+    distance += vaddvq_u8(vcntq_u8(x));
+  }
+  for (; i < num_bytes; i++) {
+    distance += PopulationCount(static_cast<uint64_t>(a[i] ^ b[i]));
+  }
+  return distance;
+}
+
+float SquaredL2DistanceNEON(const float* a, const float* b, const int size) {
+  return SquaredL2DistanceNEONImpl(a, b, size);
+}
+
+float SquaredL2Distance128NEON(const float* a, const float* b, const int) {
+  return SquaredL2DistanceNEONImpl(a, b, kSiftDescriptorSize);
+}
+
+int QuantizedSquaredL2DistanceNEON(const uint8_t* a,
+                                   const uint8_t* b,
+                                   const int size) {
+  return QuantizedSquaredL2DistanceNEONImpl(a, b, size);
+}
+
+int HammingDistanceNEON(const uint8_t* a,
+                        const uint8_t* b,
+                        const int num_bytes) {
+  return HammingDistanceNEONImpl(a, b, num_bytes);
+}
+
+int HammingDistance256NEON(const uint8_t* a, const uint8_t* b, const int) {
+  return HammingDistanceNEONImpl(a, b, kNumBytes256BitDescriptor);
+}
+
+int HammingDistance486NEON(const uint8_t* a, const uint8_t* b, const int) {
+  return HammingDistanceNEONImpl(a, b, kNumBytes486BitDescriptor);
+}
+
+const DistanceKernels kNEONKernels = {DistanceInstructionSet::NEON,
+                                      SquaredL2DistanceNEON,
+                                      SquaredL2Distance128NEON,
+                                      QuantizedSquaredL2DistanceNEON,
+                                      HammingDistanceNEON,
+                                      HammingDistance256NEON,
+                                      HammingDistance486NEON};
+
+#endif  // THEIA_DISTANCE_NEON_KERNELS
+
+// Returns the kernels for the instruction set, or nullptr if they are not
+// supported on this host.
+const DistanceKernels* GetKernels(
+    const DistanceInstructionSet instruction_set) {
+  switch (instruction_set) {
+    case DistanceInstructionSet::SCALAR:
+      return &kScalarKernels;
+#ifdef THEIA_DISTANCE_X86_KERNELS
+    case DistanceInstructionSet::SSE4:
+      return (__builtin_cpu_supports("sse4.2") &&
+              __builtin_cpu_supports("popcnt"))
+                 ? &kSSE4Kernels
+                 : nullptr;
+    case DistanceInstructionSet::AVX2:
+      return (__builtin_cpu_supports("avx2") &&
+              __builtin_cpu_supports("fma") &&
+              __builtin_cpu_supports("popcnt"))
+                 ? &kAVX2Kernels
+                 : nullptr;
+    case DistanceInstructionSet::AVX512:
+      return (__builtin_cpu_supports("avx512f") &&
+              __builtin_cpu_supports("avx2") &&
+              __builtin_cpu_supports("popcnt"))
+                 ? &kAVX512Kernels
+                 : nullptr;
+#endif
+#ifdef THEIA_DISTANCE_NEON_KERNELS
+    case DistanceInstructionSet::NEON:
+      return &kNEONKernels;
+#endif
+    default:
+      return nullptr;
+  }
+}
+
+const DistanceKernels* DetectBestKernels() {
+  static const DistanceInstructionSet kPreferredInstructionSets[] = {
+      DistanceInstructionSet::AVX512,
+      DistanceInstructionSet::AVX2,
+      DistanceInstructionSet::SSE4,
+      DistanceInstructionSet::NEON};
+  for (const DistanceInstructionSet instruction_set :
+       kPreferredInstructionSets) {
+    const DistanceKernels* kernels = GetKernels(instruction_set);
+    if (kernels != nullptr) {
+      return kernels;
+    }
+  }
+  return &kScalarKernels;
+}
+
+// The active kernels. They are detected on first use and may be overridden
+// with SetDistanceInstructionSet.
+std::atomic<const DistanceKernels*>& ActiveKernels() {
+  static std::atomic<const DistanceKernels*> active_kernels(
+      DetectBestKernels());
+  return active_kernels;
+}
+
+}  // namespace
+
+bool IsDistanceInstructionSetSupported(
+    const DistanceInstructionSet instruction_set) {
+  return GetKernels(instruction_set) != nullptr;
+}
+
+DistanceInstructionSet GetDistanceInstructionSet() {
+  return ActiveKernels().load(std::memory_order_relaxed)->instruction_set;
+}
+
+bool SetDistanceInstructionSet(const DistanceInstructionSet instruction_set) {
+  const DistanceKernels* kernels = GetKernels(instruction_set);
+  if (kernels == nullptr) {
+    return false;
+  }
+  ActiveKernels().store(kernels, std::memory_order_relaxed);
+  return true;
+}
+
+float SquaredL2Distance(const float* descriptor_a,
+                        const float* descriptor_b,
+                        const int size) {
+  const DistanceKernels* kernels =
+      ActiveKernels().load(std::memory_order_relaxed);
+  if (size == kSiftDescriptorSize) {
+    return kernels->squared_l2_128(descriptor_a, descriptor_b, size);
+  }
+  return kernels->squared_l2(descriptor_a, descriptor_b, size);
+}
+
+int QuantizedSquaredL2Distance(const uint8_t* descriptor_a,
+                               const uint8_t* descriptor_b,
+                               const int size) {
+  return ActiveKernels()
+      .load(std::memory_order_relaxed)
+      ->quantized_squared_l2(descriptor_a, descriptor_b, size);
+}
+
+int HammingDistance(const uint8_t* descriptor_a,
+                    const uint8_t* descriptor_b,
+                    const int num_bytes) {
+  const DistanceKernels* kernels =
+      ActiveKernels().load(std::memory_order_relaxed);
+  switch (num_bytes) {
+    case kNumBytes256BitDescriptor:
+      return kernels->hamming_256(descriptor_a, descriptor_b, num_bytes);
+    case kNumBytes486BitDescriptor:
+      return kernels->hamming_486(descriptor_a, descriptor_b, num_bytes);
+    default:
+      return kernels->hamming(descriptor_a, descriptor_b, num_bytes);
+  }
+}
+
+}  // namespace theia
@@ -37,10 +37,55 @@
 
 #include <Eigen/Core>
 #include <glog/logging.h>
+#include <cstdint>
 
 namespace theia {
 // This file includes all of the distance metrics that are used:
-// L2 distance for euclidean features.
+// L2 distance for euclidean features and Hamming distance for binary features.
+
+// The instruction sets that distance kernels may be dispatched to. The best
+// instruction set supported by the host CPU is detected once at runtime, so a
+// single binary runs the fastest available kernels on every machine.
+enum class DistanceInstructionSet {
+  SCALAR = 0,
+  SSE4 = 1,
+  AVX2 = 2,
+  AVX512 = 3,
+  NEON = 4
+};
+
+// Returns true if the distance kernels for the instruction set were compiled
+// in and the host CPU supports them. SCALAR is always supported.
+bool IsDistanceInstructionSetSupported(
+    const DistanceInstructionSet instruction_set);
+
+// Returns the instruction set currently used by the distance kernels.
+DistanceInstructionSet GetDistanceInstructionSet();
+
+// Overrides the runtime detection, e.g. for benchmarking or testing. Returns
+// false and leaves the kernels untouched if the instruction set is not
+// supported.
+bool SetDistanceInstructionSet(const DistanceInstructionSet instruction_set);
+
+// Returns the squared Euclidean distance between two float arrays of length
+// size. SIFT-sized (128 dimensional) descriptors use a dedicated kernel.
+float SquaredL2Distance(const float* descriptor_a,
+                        const float* descriptor_b,
+                        const int size);
+
+// Returns the squared Euclidean distance between two uint8 arrays of length
+// size, e.g. quantized descriptors. The distance is computed exactly with
+// integer arithmetic.
+int QuantizedSquaredL2Distance(const uint8_t* descriptor_a,
+                               const uint8_t* descriptor_b,
+                               const int size);
+
+// Returns the number of differing bits between two bit-packed binary
+// descriptors that are num_bytes long. 256-bit (e.g. ORB/BRIEF) and 486-bit
+// (AKAZE MLDB, stored in 61 bytes) descriptors use dedicated kernels.
+int HammingDistance(const uint8_t* descriptor_a,
+                    const uint8_t* descriptor_b,
+                    const int num_bytes);
 
 // Squared Euclidean distance functor. We let Eigen handle the SSE optimization.
 // NOTE: This assumes that each vector has a unit norm:
@@ -49,11 +94,45 @@ struct L2 {
   typedef float DistanceType;
   typedef Eigen::VectorXf DescriptorType;
 
-  DistanceType operator()(const Eigen::VectorXf& descriptor_a,
-                          const Eigen::VectorXf& descriptor_b) const {
+  // Templated on the Eigen expression type so that rows of a DescriptorMatrix
+  // or Eigen::Map views may be used without copying them into a VectorXf.
+  template <typename DerivedA, typename DerivedB>
+  DistanceType operator()(
+      const Eigen::MatrixBase<DerivedA>& descriptor_a,
+      const Eigen::MatrixBase<DerivedB>& descriptor_b) const {
     DCHECK_EQ(descriptor_a.size(), descriptor_b.size());
     return (descriptor_a - descriptor_b).squaredNorm();
   }
+
+  // Uses the runtime-dispatched SIMD kernel on contiguous descriptors, e.g. the
+  // rows of a DescriptorMatrix.
+  DistanceType operator()(const float* descriptor_a,
+                          const float* descriptor_b,
+                          const int size) const {
+    return SquaredL2Distance(descriptor_a, descriptor_b, size);
+  }
+};
+
+// Squared Euclidean distance functor for quantized descriptors.
+struct QuantizedL2 {
+  typedef int DistanceType;
+
+  DistanceType operator()(const uint8_t* descriptor_a,
+                          const uint8_t* descriptor_b,
+                          const int size) const {
+    return QuantizedSquaredL2Distance(descriptor_a, descriptor_b, size);
+  }
+};
+
+// Hamming distance functor for bit-packed binary descriptors.
+struct Hamming {
+  typedef int DistanceType;
+
+  DistanceType operator()(const uint8_t* descriptor_a,
+                          const uint8_t* descriptor_b,
+                          const int num_bytes) const {
+    return HammingDistance(descriptor_a, descriptor_b, num_bytes);
+  }
 };
 
 }  // namespace theia
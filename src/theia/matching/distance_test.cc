@@ -76,5 +76,113 @@ TEST(L2Distance, KnownDistance) {
   }
 }
 
+static const DistanceInstructionSet kInstructionSets[] = {
+    DistanceInstructionSet::SCALAR,
+    DistanceInstructionSet::SSE4,
+    DistanceInstructionSet::AVX2,
+    DistanceInstructionSet::AVX512,
+    DistanceInstructionSet::NEON};
+
+// The SIMD kernels must agree with Eigen for every supported instruction set,
+// including dimensions that are not a multiple of the vector width.
+TEST(L2Distance, SimdKernelsMatchEigen) {
+  const DistanceInstructionSet default_instruction_set =
+      GetDistanceInstructionSet();
+  const int kDimensions[] = {1, 3, 8, 17, 64, 100, 128, 133};
+  for (const DistanceInstructionSet instruction_set : kInstructionSets) {
+    if (!SetDistanceInstructionSet(instruction_set)) {
+      continue;
+    }
+    for (const int num_dimensions : kDimensions) {
+      Eigen::VectorXf descriptor1(num_dimensions);
+      Eigen::VectorXf descriptor2(num_dimensions);
+      for (int n = 0; n < kNumTrials; n++) {
+        rng.SetRandom(&descriptor1);
+        rng.SetRandom(&descriptor2);
+        const float expected_dist = (descriptor1 - descriptor2).squaredNorm();
+        L2 l2_dist;
+        const float dist =
+            l2_dist(descriptor1.data(), descriptor2.data(), num_dimensions);
+        ASSERT_NEAR(dist, expected_dist, 1e-5 * (1.0 + expected_dist));
+      }
+    }
+  }
+  EXPECT_TRUE(SetDistanceInstructionSet(default_instruction_set));
+}
+
+// Compare the Hamming kernels to std::bitset for 256-bit, 486-bit (61 bytes)
+// and irregularly sized binary descriptors.
+TEST(HammingDistance, SimdKernelsMatchBitset) {
+  const DistanceInstructionSet default_instruction_set =
+      GetDistanceInstructionSet();
+  static const int kMaxNumBytes = 64;
+  const int kNumBytes[] = {1, 7, 16, 32, 45, 61, 64};
+  for (const DistanceInstructionSet instruction_set : kInstructionSets) {
+    if (!SetDistanceInstructionSet(instruction_set)) {
+      continue;
+    }
+    for (const int num_bytes : kNumBytes) {
+      uint8_t descriptor1[kMaxNumBytes];
+      uint8_t descriptor2[kMaxNumBytes];
+      for (int n = 0; n < kNumTrials; n++) {
+        int expected_dist = 0;
+        for (int i = 0; i < num_bytes; i++) {
+          descriptor1[i] = static_cast<uint8_t>(rng.RandInt(0, 255));
+          descriptor2[i] = static_cast<uint8_t>(rng.RandInt(0, 255));
+          expected_dist +=
+              std::bitset<8>(descriptor1[i] ^ descriptor2[i]).count();
+        }
+        Hamming hamming_dist;
+        ASSERT_EQ(hamming_dist(descriptor1, descriptor2, num_bytes),
+                  expected_dist);
+      }
+    }
+  }
+  EXPECT_TRUE(SetDistanceInstructionSet(default_instruction_set));
+}
+
+// The quantized kernels compute exact integer distances, including extreme
+// values and sizes that are not a multiple of the vector width.
+TEST(QuantizedL2Distance, SimdKernelsMatchScalar) {
+  const DistanceInstructionSet default_instruction_set =
+      GetDistanceInstructionSet();
+  static const int kMaxSize = 160;
+  const int kSizes[] = {1, 7, 16, 31, 32, 48, 64, 128, 133, 160};
+  for (const DistanceInstructionSet instruction_set : kInstructionSets) {
+    if (!SetDistanceInstructionSet(instruction_set)) {
+      continue;
+    }
+    for (const int size : kSizes) {
+      uint8_t descriptor1[kMaxSize];
+      uint8_t descriptor2[kMaxSize];
+      for (int n = 0; n < kNumTrials; n++) {
+        int expected_dist = 0;
+        for (int i = 0; i < size; i++) {
+          // Use the extreme values in the first trial.
+          descriptor1[i] =
+              n == 0 ? 255 : static_cast<uint8_t>(rng.RandInt(0, 255));
+          descriptor2[i] =
+              n == 0 ? 0 : static_cast<uint8_t>(rng.RandInt(0, 255));
+          const int diff = descriptor1[i] - descriptor2[i];
+          expected_dist += diff * diff;
+        }
+        QuantizedL2 quantized_l2_dist;
+        ASSERT_EQ(quantized_l2_dist(descriptor1, descriptor2, size),
+                  expected_dist);
+        ASSERT_EQ(quantized_l2_dist(descriptor2, descriptor1, size),
+                  expected_dist);
+      }
+    }
+  }
+  EXPECT_TRUE(SetDistanceInstructionSet(default_instruction_set));
+}
+
+// The scalar kernels are always available.
+TEST(DistanceInstructionSet, ScalarIsSupported) {
+  EXPECT_TRUE(
+      IsDistanceInstructionSetSupported(DistanceInstructionSet::SCALAR));
+  EXPECT_TRUE(IsDistanceInstructionSetSupported(GetDistanceInstructionSet()));
+}
+
 }  // namespace
 }  // namespace theia
@@ -0,0 +1,113 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+
+#include "theia/matching/feature_correspondence_arrays.h"
+
+#include <Eigen/Core>
+#include <vector>
+
+#include "theia/matching/feature_correspondence.h"
+#include "theia/matching/image_pair_match.h"
+
+namespace theia {
+
+namespace {
+
+// The coordinates of consecutive correspondences are this many doubles apart.
+static_assert(sizeof(FeatureCorrespondence) % sizeof(double) == 0,
+              "FeatureCorrespondence must be a whole number of doubles.");
+constexpr int kCorrespondenceStride =
+    sizeof(FeatureCorrespondence) / sizeof(double);
+
+// Maps the given coordinate (0 for x, 1 for y) of the first or second feature
+// of all correspondences.
+StridedCoordinateMap MapCoordinate(
+    const std::vector<FeatureCorrespondence>& correspondences,
+    const bool first_feature,
+    const int coordinate) {
+  const double* data = nullptr;
+  if (!correspondences.empty()) {
+    data = first_feature ? correspondences[0].feature1.point_.data()
+                         : correspondences[0].feature2.point_.data();
+    data += coordinate;
+  }
+  return StridedCoordinateMap(data,
+                              correspondences.size(),
+                              Eigen::InnerStride<>(kCorrespondenceStride));
+}
+
+}  // namespace
+
+FeatureCorrespondenceArrays::FeatureCorrespondenceArrays(
+    const std::vector<FeatureCorrespondence>& correspondences) {
+  Assign(correspondences);
+}
+
+FeatureCorrespondenceArrays::FeatureCorrespondenceArrays(
+    const ImagePairMatch& match) {
+  Assign(match.correspondences);
+}
+
+void FeatureCorrespondenceArrays::Assign(
+    const std::vector<FeatureCorrespondence>& correspondences) {
+  const int num_correspondences = correspondences.size();
+  x1.resize(num_correspondences);
+  y1.resize(num_correspondences);
+  x2.resize(num_correspondences);
+  y2.resize(num_correspondences);
+  for (int i = 0; i < num_correspondences; i++) {
+    x1[i] = correspondences[i].feature1.point_.x();
+    y1[i] = correspondences[i].feature1.point_.y();
+    x2[i] = correspondences[i].feature2.point_.x();
+    y2[i] = correspondences[i].feature2.point_.y();
+  }
+}
+
+FeatureCorrespondence FeatureCorrespondenceArrays::Get(const int i) const {
+  return FeatureCorrespondence(Feature(x1[i], y1[i]), Feature(x2[i], y2[i]));
+}
+
+FeatureCorrespondenceView::FeatureCorrespondenceView(
+    const std::vector<FeatureCorrespondence>& correspondences)
+    : x1(MapCoordinate(correspondences, true, 0)),
+      y1(MapCoordinate(correspondences, true, 1)),
+      x2(MapCoordinate(correspondences, false, 0)),
+      y2(MapCoordinate(correspondences, false, 1)) {}
+
+FeatureCorrespondenceView::FeatureCorrespondenceView(
+    const ImagePairMatch& match)
+    : FeatureCorrespondenceView(match.correspondences) {}
+
+}  // namespace theia
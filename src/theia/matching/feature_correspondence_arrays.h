@@ -0,0 +1,99 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+
+#ifndef THEIA_MATCHING_FEATURE_CORRESPONDENCE_ARRAYS_H_
+#define THEIA_MATCHING_FEATURE_CORRESPONDENCE_ARRAYS_H_
+
+#include <Eigen/Core>
+#include <vector>
+
+#include "theia/matching/feature_correspondence.h"
+
+namespace theia {
+
+struct ImagePairMatch;
+
+// A contiguous array of coordinates that is aligned for vectorized loads.
+typedef std::vector<double, Eigen::aligned_allocator<double> >
+    AlignedCoordinateArray;
+
+// A structure-of-arrays copy of the point locations of feature
+// correspondences: correspondence i is (x1[i], y1[i]) <-> (x2[i], y2[i]).
+// Estimators that evaluate the same model on all correspondences (e.g. when
+// RANSAC scores a hypothesis) can loop over these arrays with contiguous loads
+// instead of gathering the points out of FeatureCorrespondence objects, which
+// also carry the feature covariances and depth priors.
+struct FeatureCorrespondenceArrays {
+  FeatureCorrespondenceArrays() {}
+  explicit FeatureCorrespondenceArrays(
+      const std::vector<FeatureCorrespondence>& correspondences);
+  explicit FeatureCorrespondenceArrays(const ImagePairMatch& match);
+
+  // Replaces the contents with the point locations of the correspondences.
+  void Assign(const std::vector<FeatureCorrespondence>& correspondences);
+
+  int size() const { return static_cast<int>(x1.size()); }
+
+  // Returns correspondence i. Only the point locations are set.
+  FeatureCorrespondence Get(const int i) const;
+
+  AlignedCoordinateArray x1, y1, x2, y2;
+};
+
+// A strided, read-only view of one coordinate of a vector of
+// FeatureCorrespondence.
+typedef Eigen::
+    Map<const Eigen::VectorXd, Eigen::Unaligned, Eigen::InnerStride<> >
+        StridedCoordinateMap;
+
+// A zero-copy view of the point locations of a vector of feature
+// correspondences with the same interface as FeatureCorrespondenceArrays,
+// i.e. x1[i] is the x coordinate of correspondences[i].feature1. The
+// coordinates are read in place with a stride of one correspondence, so this is
+// cheap to create but does not give contiguous loads. The view is only valid as
+// long as the correspondences are neither destroyed nor resized.
+struct FeatureCorrespondenceView {
+  explicit FeatureCorrespondenceView(
+      const std::vector<FeatureCorrespondence>& correspondences);
+  explicit FeatureCorrespondenceView(const ImagePairMatch& match);
+
+  int size() const { return static_cast<int>(x1.size()); }
+
+  StridedCoordinateMap x1, y1, x2, y2;
+};
+
+}  // namespace theia
+
+#endif  // THEIA_MATCHING_FEATURE_CORRESPONDENCE_ARRAYS_H_
@@ -0,0 +1,108 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+
+#include <Eigen/Core>
+#include <vector>
+#include "gtest/gtest.h"
+
+#include "theia/matching/feature_correspondence.h"
+#include "theia/matching/feature_correspondence_arrays.h"
+#include "theia/matching/image_pair_match.h"
+
+namespace theia {
+
+namespace {
+
+ImagePairMatch CreateMatch(const int num_correspondences) {
+  ImagePairMatch match;
+  for (int i = 0; i < num_correspondences; i++) {
+    match.correspondences.emplace_back(Feature(i, 2.0 * i),
+                                       Feature(-i, 0.5 * i));
+    match.correspondences.back().feature1.covariance_ *= i + 1.0;
+  }
+  return match;
+}
+
+}  // namespace
+
+TEST(FeatureCorrespondenceArrays, CopiesPointLocations) {
+  const ImagePairMatch match = CreateMatch(10);
+  const FeatureCorrespondenceArrays arrays(match);
+  ASSERT_EQ(arrays.size(), match.correspondences.size());
+  for (int i = 0; i < arrays.size(); i++) {
+    const FeatureCorrespondence& correspondence = match.correspondences[i];
+    EXPECT_EQ(arrays.x1[i], correspondence.feature1.x());
+    EXPECT_EQ(arrays.y1[i], correspondence.feature1.y());
+    EXPECT_EQ(arrays.x2[i], correspondence.feature2.x());
+    EXPECT_EQ(arrays.y2[i], correspondence.feature2.y());
+    EXPECT_TRUE(arrays.Get(i) == correspondence);
+  }
+}
+
+TEST(FeatureCorrespondenceArrays, Assign) {
+  FeatureCorrespondenceArrays arrays(CreateMatch(10));
+  arrays.Assign(CreateMatch(3).correspondences);
+  EXPECT_EQ(arrays.size(), 3);
+  EXPECT_EQ(arrays.y2.size(), 3);
+  EXPECT_EQ(arrays.x1[2], 2.0);
+
+  arrays.Assign(std::vector<FeatureCorrespondence>());
+  EXPECT_EQ(arrays.size(), 0);
+}
+
+TEST(FeatureCorrespondenceView, ReadsPointLocationsInPlace) {
+  const ImagePairMatch match = CreateMatch(10);
+  const FeatureCorrespondenceView view(match);
+  ASSERT_EQ(view.size(), match.correspondences.size());
+  const FeatureCorrespondence& first = match.correspondences[0];
+  EXPECT_EQ(view.x1.data(), first.feature1.point_.data());
+  EXPECT_EQ(view.y1.data(), first.feature1.point_.data() + 1);
+  EXPECT_EQ(view.x2.data(), first.feature2.point_.data());
+  EXPECT_EQ(view.y2.data(), first.feature2.point_.data() + 1);
+  for (int i = 0; i < view.size(); i++) {
+    const FeatureCorrespondence& correspondence = match.correspondences[i];
+    EXPECT_EQ(view.x1[i], correspondence.feature1.x());
+    EXPECT_EQ(view.y1[i], correspondence.feature1.y());
+    EXPECT_EQ(view.x2[i], correspondence.feature2.x());
+    EXPECT_EQ(view.y2[i], correspondence.feature2.y());
+  }
+}
+
+TEST(FeatureCorrespondenceView, Empty) {
+  const FeatureCorrespondenceView view(CreateMatch(0));
+  EXPECT_EQ(view.size(), 0);
+}
+
+}  // namespace theia
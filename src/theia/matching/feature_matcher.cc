@@ -37,8 +37,11 @@
 #include <glog/logging.h>
 
 #include <algorithm>
+#include <functional>
+#include <future>  // NOLINT
 #include <limits>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <unordered_map>
 #include <utility>
@@ -49,32 +52,179 @@
 #include "theia/matching/feature_correspondence.h"
 #include "theia/matching/feature_matcher_options.h"
 #include "theia/matching/features_and_matches_database.h"
+#include "theia/matching/image_pair_bitset.h"
 #include "theia/matching/image_pair_match.h"
 #include "theia/matching/keypoints_and_descriptors.h"
 #include "theia/sfm/camera_intrinsics_prior.h"
 #include "theia/sfm/two_view_match_geometric_verification.h"
 
+#include "theia/util/executor.h"
+#include "theia/util/hash.h"
+#include "theia/util/lru_cache.h"
 #include "theia/util/map_util.h"
-#include "theia/util/threadpool.h"
+#include "theia/util/metrics.h"
+#include "theia/util/random.h"
+#include "theia/util/trace.h"
 #include "theia/util/util.h"
+#include "theia/util/work_stealing_scheduler.h"
 
 namespace theia {
 namespace {
-void SelectAllPairs(
-    const std::vector<std::string>& image_names,
-    std::vector<std::pair<std::string, std::string>>* pairs_to_match) {
+typedef std::pair<ImageId, ImageId> ImageIdPair;
+
+void SelectAllPairs(const std::vector<ImageId>& image_ids,
+                    std::vector<ImageIdPair>* pairs_to_match) {
   // Compute the total number of potential matches.
   const int num_pairs_to_match =
-      image_names.size() * (image_names.size() - 1) / 2;
+      image_ids.size() * (image_ids.size() - 1) / 2;
 
   pairs_to_match->reserve(num_pairs_to_match);
   // Create a list of all possible image pairs.
-  for (int i = 0; i < image_names.size(); i++) {
-    for (int j = i + 1; j < image_names.size(); j++) {
-      pairs_to_match->emplace_back(image_names[i], image_names[j]);
+  for (int i = 0; i < image_ids.size(); i++) {
+    for (int j = i + 1; j < image_ids.size(); j++) {
+      pairs_to_match->emplace_back(image_ids[i], image_ids[j]);
+    }
+  }
+}
+
+// The image pairs that have a stored match or a stored failure in the
+// database, over the ids of the images. Images that appear in a pair with a
+// result are old.
+struct ImagePairsWithResults {
+  explicit ImagePairsWithResults(const int num_images)
+      : pairs(num_images), is_old_image(num_images, false) {}
+
+  ImagePairBitset pairs;
+  std::vector<bool> is_old_image;
+};
+
+// Streams the names of the pairs with results from the database rather than
+// materializing them, and keeps one bit per pair of images with ids. Images
+// without an id are not matched, so their pairs are skipped.
+ImagePairsWithResults GetImagePairsWithResults(
+    FeaturesAndMatchesDatabase* feature_and_matches_db) {
+  ImagePairsWithResults pairs_with_results(
+      feature_and_matches_db->NumImageIds());
+  const auto add_pair = [&](const std::string& image_name1,
+                            const std::string& image_name2) {
+    const ImageId image_id1 = feature_and_matches_db->FindImageId(image_name1);
+    const ImageId image_id2 = feature_and_matches_db->FindImageId(image_name2);
+    if (image_id1 != kInvalidImageId) {
+      pairs_with_results.is_old_image[image_id1] = true;
+    }
+    if (image_id2 != kInvalidImageId) {
+      pairs_with_results.is_old_image[image_id2] = true;
+    }
+    if (image_id1 != kInvalidImageId && image_id2 != kInvalidImageId &&
+        image_id1 != image_id2) {
+      pairs_with_results.pairs.Insert(image_id1, image_id2);
+    }
+    return true;
+  };
+  feature_and_matches_db->ForEachMatchedImagePair(add_pair);
+  feature_and_matches_db->ForEachFailedImagePair(add_pair);
+  return pairs_with_results;
+}
+
+// Selects the new-vs-old and new-vs-new image pairs, where the old images are
+// the images that appear in a pair with a result.
+void SelectPairsWithNewImages(const std::vector<ImageId>& image_ids,
+                              const ImagePairsWithResults& pairs_with_results,
+                              std::vector<ImageIdPair>* pairs_to_match) {
+  for (int i = 0; i < image_ids.size(); i++) {
+    const bool is_new_image1 = !pairs_with_results.is_old_image[image_ids[i]];
+    for (int j = i + 1; j < image_ids.size(); j++) {
+      if (is_new_image1 || !pairs_with_results.is_old_image[image_ids[j]]) {
+        pairs_to_match->emplace_back(image_ids[i], image_ids[j]);
+      }
+    }
+  }
+}
+
+// The cost of matching a pair is roughly proportional to the product of the
+// number of features in the two images. The features of each image are read
+// once to count them.
+std::vector<double> EstimatePairMatchingCosts(
+    FeaturesAndMatchesDatabase& feature_and_matches_db,
+    const std::vector<ImageIdPair>& pairs_to_match) {
+  std::vector<double> num_features(feature_and_matches_db.NumImageIds(), -1.0);
+  const auto get_num_features = [&](const ImageId image_id) {
+    if (num_features[image_id] < 0.0) {
+      const std::shared_ptr<const KeypointsAndDescriptors> features =
+          feature_and_matches_db.GetSharedFeatures(
+              feature_and_matches_db.ImageNameOfId(image_id));
+      num_features[image_id] = features->keypoints.size();
+    }
+    return num_features[image_id];
+  };
+
+  std::vector<double> costs;
+  costs.reserve(pairs_to_match.size());
+  for (const auto& pair : pairs_to_match) {
+    costs.emplace_back(get_num_features(pair.first) *
+                       get_num_features(pair.second));
+  }
+  return costs;
+}
+
+// Groups the pairs into square blocks of the image-pair matrix such that each
+// block involves at most 2 * block_size images. Images are numbered in the
+// order in which they first appear in the pairs, and the pairs of each block
+// keep their relative order.
+std::vector<std::vector<int>> GroupPairsIntoBlocks(
+    const std::vector<ImageIdPair>& pairs_to_match,
+    const int num_image_ids,
+    const int block_size) {
+  CHECK_GT(block_size, 0);
+  std::vector<int> image_indices(num_image_ids, -1);
+  int num_images = 0;
+  const auto get_block = [&](const ImageId image_id) {
+    if (image_indices[image_id] < 0) {
+      image_indices[image_id] = num_images++;
+    }
+    return image_indices[image_id] / block_size;
+  };
+
+  std::unordered_map<std::pair<int, int>, int> block_indices;
+  std::vector<std::vector<int>> blocks;
+  for (int i = 0; i < pairs_to_match.size(); i++) {
+    const int block1 = get_block(pairs_to_match[i].first);
+    const int block2 = get_block(pairs_to_match[i].second);
+    const std::pair<int, int> block_key(std::min(block1, block2),
+                                        std::max(block1, block2));
+    const int block_index =
+        block_indices.emplace(block_key, blocks.size()).first->second;
+    if (block_index == blocks.size()) {
+      blocks.emplace_back();
     }
+    blocks[block_index].push_back(i);
   }
+  return blocks;
 }
+
+void LogSchedulerStatistics(
+    const std::vector<WorkStealingScheduler::WorkerStatistics>& statistics) {
+  double wall_time = 0.0, busy_time = 0.0;
+  for (int i = 0; i < statistics.size(); i++) {
+    wall_time = std::max(wall_time, statistics[i].wall_time_in_seconds);
+    busy_time += statistics[i].busy_time_in_seconds;
+  }
+  if (wall_time <= 0.0) {
+    return;
+  }
+
+  for (int i = 0; i < statistics.size(); i++) {
+    VLOG(2) << "Matching thread " << i << " matched "
+            << statistics[i].num_tasks << " pairs ("
+            << statistics[i].num_stolen_tasks << " stolen) and was busy "
+            << 100.0 * statistics[i].busy_time_in_seconds / wall_time
+            << "% of the time.";
+  }
+  VLOG(1) << "Matching took " << wall_time << " seconds with "
+          << statistics.size() << " threads and an average utilization of "
+          << 100.0 * busy_time / (wall_time * statistics.size()) << "%.";
+}
+
 }  // namespace
 
 FeatureMatcher::~FeatureMatcher() {}
@@ -98,101 +248,331 @@ void FeatureMatcher::AddImages(const std::vector<std::string>& image_names) {
 
 void FeatureMatcher::SetImagePairsToMatch(
     const std::vector<std::pair<std::string, std::string>>& pairs_to_match) {
-  pairs_to_match_ = pairs_to_match;
+  pairs_to_match_.clear();
+  pairs_to_match_.reserve(pairs_to_match.size());
+  for (const auto& pair : pairs_to_match) {
+    pairs_to_match_.emplace_back(
+        feature_and_matches_db_->GetOrAddImageId(pair.first),
+        feature_and_matches_db_->GetOrAddImageId(pair.second));
+  }
+}
+
+void FeatureMatcher::SelectPairsToMatchIfNeeded() {
+  std::vector<ImageId> image_ids;
+  image_ids.reserve(image_names_.size());
+  for (const std::string& image_name : image_names_) {
+    image_ids.emplace_back(feature_and_matches_db_->GetOrAddImageId(image_name));
+  }
+
+  if (!options_.match_incrementally) {
+    if (pairs_to_match_.empty()) {
+      SelectAllPairs(image_ids, &pairs_to_match_);
+    }
+    return;
+  }
+
+  const ImagePairsWithResults pairs_with_results =
+      GetImagePairsWithResults(feature_and_matches_db_);
+  if (pairs_to_match_.empty()) {
+    SelectPairsWithNewImages(image_ids, pairs_with_results, &pairs_to_match_);
+  }
+
+  // Remove the pairs that were already matched.
+  const int num_pairs = pairs_to_match_.size();
+  pairs_to_match_.erase(
+      std::remove_if(pairs_to_match_.begin(),
+                     pairs_to_match_.end(),
+                     [&](const ImageIdPair& pair) {
+                       return pair.first != pair.second &&
+                              pairs_with_results.pairs.Contains(pair.first,
+                                                                pair.second);
+                     }),
+      pairs_to_match_.end());
+  VLOG(1) << "Incremental matching skips "
+          << num_pairs - pairs_to_match_.size() << " of " << num_pairs
+          << " image pairs that were already matched.";
 }
 
 void FeatureMatcher::MatchImages() {
+  THEIA_TRACE_SCOPE("FeatureMatcher::MatchImages");
   // If SetImagePairsToMatch has not been called, match all image-to-image
   // pairs.
-  if (pairs_to_match_.empty()) {
-    SelectAllPairs(image_names_, &pairs_to_match_);
+  SelectPairsToMatchIfNeeded();
+  {
+    std::lock_guard<std::mutex> lock(verification_summary_mutex_);
+    verification_summary_ = GeometricVerificationSummary();
   }
 
-  // Add workers for matching. It is more efficient to let each thread compute
-  // multiple matches at a time than add each matching task to the pool. This is
-  // sort of like OpenMP's dynamic schedule in that it is able to balance
-  // threads fairly efficiently.
   const int num_matches = pairs_to_match_.size();
+  if (num_matches == 0) {
+    return;
+  }
+  const ScopedNumaAffinity numa_affinity(options_.numa_aware);
+
+  // Pairs vary greatly in cost, so they are handed to a work-stealing scheduler
+  // that runs the most expensive pairs first and lets idle threads take over
+  // the remaining pairs of busy threads.
+  const std::vector<double> costs =
+      options_.schedule_pairs_by_cost ? EstimatePairMatchingCosts(
+                                            *feature_and_matches_db_,
+                                            pairs_to_match_)
+                                      : std::vector<double>(num_matches, 1.0);
   const int num_threads =
-      std::min(options_.num_threads, static_cast<int>(num_matches));
-  std::unique_ptr<ThreadPool> pool(new ThreadPool(num_threads));
-  const int interval_step =
-      std::min(this->kMaxThreadingStepSize_, num_matches / num_threads);
-  for (int i = 0; i < num_matches; i += interval_step) {
-    const int end_interval = std::min(num_matches, i + interval_step);
-    pool->Add(&FeatureMatcher::MatchAndVerifyImagePairs, this, i, end_interval);
+      std::max(1, std::min(options_.num_threads, num_matches));
+  if (options_.match_pairs_in_blocks) {
+    MatchImagePairsInBlocks(costs, num_threads);
+  } else {
+    WorkStealingScheduler scheduler(num_threads);
+    scheduler.Run(costs, [this](const int thread_id, const int i) {
+      MatchAndVerifyImagePairs(i, i + 1);
+    });
+    LogSchedulerStatistics(scheduler.GetWorkerStatistics());
   }
-  // Wait for all threads to finish.
-  pool.reset(nullptr);
+
+  // Make sure that all matches have been stored.
+  feature_and_matches_db_->Flush();
 
   VLOG(1) << "Matched " << feature_and_matches_db_->NumMatches()
           << " image pairs out of " << num_matches
           << " pairs selected for matching.";
+  if (options_.geometric_verification_options.pre_verification) {
+    const GeometricVerificationSummary summary =
+        GetGeometricVerificationSummary();
+    VLOG(1) << "Pre-verification rejected "
+            << summary.num_pre_verification_rejections << " out of "
+            << summary.num_verified_pairs << " image pairs after evaluating "
+            << summary.num_pre_verification_hypotheses << " hypotheses ("
+            << summary.num_pre_verification_hypotheses_rejected_by_sprt
+            << " rejected early by SPRT) and "
+            << summary.num_pre_verification_residuals_evaluated
+            << " residuals.";
+  }
 }
 
-void FeatureMatcher::MatchAndVerifyImagePairs(const int start_index,
-                                              const int end_index) {
-  for (int i = start_index; i < end_index; i++) {
-    const std::string image1_name = pairs_to_match_[i].first;
-    const std::string image2_name = pairs_to_match_[i].second;
+FeatureMatcher::GeometricVerificationSummary
+FeatureMatcher::GetGeometricVerificationSummary() const {
+  std::lock_guard<std::mutex> lock(verification_summary_mutex_);
+  return verification_summary_;
+}
 
-    // Match the image pair. If the pair fails to match then continue to the
-    // next match.
-    ImagePairMatch image_pair_match;
-    image_pair_match.image1 = image1_name;
-    image_pair_match.image2 = image2_name;
+void FeatureMatcher::MatchImagePairsInBlocks(const std::vector<double>& costs,
+                                             const int num_threads) {
+  // Each block covers at most half of the feature cache of a thread so that all
+  // of its images stay in the cache while the block is matched.
+  const int cache_capacity_per_thread =
+      std::max(2, options_.cache_capacity / num_threads);
+  const std::vector<std::vector<int>> blocks =
+      GroupPairsIntoBlocks(pairs_to_match_,
+                           feature_and_matches_db_->NumImageIds(),
+                           cache_capacity_per_thread / 2);
+  std::vector<double> block_costs(blocks.size(), 0.0);
+  for (int i = 0; i < blocks.size(); i++) {
+    for (const int pair_index : blocks[i]) {
+      block_costs[i] += costs[pair_index];
+    }
+  }
 
-    // Get the keypoints and descriptors from the db.
-    const KeypointsAndDescriptors& features1 =
-        feature_and_matches_db_->GetFeatures(image1_name);
-    const KeypointsAndDescriptors& features2 =
-        feature_and_matches_db_->GetFeatures(image2_name);
-
-    // Compute the visual matches from feature descriptors.
-    std::vector<IndexedFeatureMatch> putative_matches;
-    if (!MatchImagePair(features1, features2, &putative_matches)) {
-      VLOG(2)
-          << "Could not match a sufficient number of features between images "
-          << image1_name << " and " << image2_name;
-      continue;
-    }
-
-    // Perform geometric verification if applicable.
-    if (options_.perform_geometric_verification) {
-      // If geometric verification fails, do not add the match to the output.
-      if (!GeometricVerification(
-              features1, features2, putative_matches, &image_pair_match)) {
-        VLOG(2) << "Geometric verification between images " << image1_name
-                << " and " << image2_name << " failed.";
-        continue;
+  // Each thread owns a feature cache so that threads never contend for it.
+  const std::function<std::shared_ptr<const KeypointsAndDescriptors>(
+      const ImageId&)>
+      fetch_features = [this](const ImageId& image_id) {
+        return feature_and_matches_db_->GetSharedFeatures(
+            feature_and_matches_db_->ImageNameOfId(image_id));
+      };
+  std::vector<std::unique_ptr<FeatureCache>> feature_caches(num_threads);
+  for (int i = 0; i < num_threads; i++) {
+    feature_caches[i].reset(
+        new FeatureCache(fetch_features, cache_capacity_per_thread));
+  }
+
+  // Returns the images of the block whose features are not in the cache.
+  const auto uncached_images_of_block = [&](FeatureCache* feature_cache,
+                                            const int block) {
+    std::vector<ImageId> image_ids;
+    for (const int pair_index : blocks[block]) {
+      for (const ImageId image_id : {pairs_to_match_[pair_index].first,
+                                     pairs_to_match_[pair_index].second}) {
+        if (!feature_cache->ExistsInCache(image_id) &&
+            std::find(image_ids.begin(), image_ids.end(), image_id) ==
+                image_ids.end()) {
+          image_ids.emplace_back(image_id);
+        }
+      }
+    }
+    return image_ids;
+  };
+
+  // Reads the features of the images with one batched read of the database.
+  const auto read_features = [this](const std::vector<ImageId>& image_ids) {
+    std::vector<std::string> image_names;
+    image_names.reserve(image_ids.size());
+    for (const ImageId image_id : image_ids) {
+      image_names.emplace_back(feature_and_matches_db_->ImageNameOfId(image_id));
+    }
+    return feature_and_matches_db_->GetSharedFeaturesBatch(image_names);
+  };
+
+  // The features of the next block of each thread, which are read in the
+  // background while the thread matches its current block. The block is -1 if
+  // no read is pending. Blocks cover at most half of the cache, so the features
+  // of the current and of the next block fit into the cache together.
+  struct Prefetch {
+    int block = -1;
+    std::vector<ImageId> image_ids;
+    std::future<std::vector<std::shared_ptr<const KeypointsAndDescriptors>>>
+        features;
+  };
+  std::vector<Prefetch> prefetches(num_threads);
+  std::vector<int> num_batched_feature_loads(num_threads, 0);
+
+  WorkStealingScheduler scheduler(num_threads);
+  scheduler.Run(block_costs, [&](const int thread_id, const int block) {
+    FeatureCache* feature_cache = feature_caches[thread_id].get();
+    if (options_.prefetch_features) {
+      // Use the prefetched features if this is the block that was expected,
+      // otherwise (e.g. the block was stolen) read the features now.
+      Prefetch& prefetch = prefetches[thread_id];
+      std::vector<ImageId> image_ids;
+      std::vector<std::shared_ptr<const KeypointsAndDescriptors>> features;
+      if (prefetch.block == block) {
+        image_ids = std::move(prefetch.image_ids);
+        features = prefetch.features.get();
+      } else {
+        if (prefetch.features.valid()) {
+          prefetch.features.wait();
+        }
+        image_ids = uncached_images_of_block(feature_cache, block);
+        features = read_features(image_ids);
+      }
+      num_batched_feature_loads[thread_id] += image_ids.size();
+      for (int i = 0; i < image_ids.size(); i++) {
+        if (!feature_cache->ExistsInCache(image_ids[i])) {
+          feature_cache->Insert(image_ids[i], features[i]);
+        }
       }
-    } else {
-      // If no geometric verification is performed then the putative matches are
-      // output.
-      image_pair_match.correspondences.reserve(putative_matches.size());
-      for (int i = 0; i < putative_matches.size(); i++) {
-        const Keypoint& keypoint1 =
-            features1.keypoints[putative_matches[i].feature1_ind];
-        const Keypoint& keypoint2 =
-            features2.keypoints[putative_matches[i].feature2_ind];
-        image_pair_match.correspondences.emplace_back(
-            Feature(keypoint1.x(), keypoint1.y()),
-            Feature(keypoint2.x(), keypoint2.y()));
+
+      prefetch.block = scheduler.PeekNextTask(thread_id);
+      prefetch.features = {};
+      if (prefetch.block >= 0) {
+        prefetch.image_ids =
+            uncached_images_of_block(feature_cache, prefetch.block);
+        prefetch.features = std::async(std::launch::async,
+                                       read_features,
+                                       prefetch.image_ids);
       }
     }
 
-    // Log information about the matching results.
-    VLOG(1) << "Images " << image1_name << " and " << image2_name
-            << " were matched with " << image_pair_match.correspondences.size()
-            << " verified matches and "
-            << image_pair_match.twoview_info.num_homography_inliers
-            << " homography matches out of " << putative_matches.size()
-            << " putative matches.";
+    for (const int pair_index : blocks[block]) {
+      const auto& pair = pairs_to_match_[pair_index];
+      const std::shared_ptr<const KeypointsAndDescriptors> features1 =
+          feature_cache->Fetch(pair.first);
+      const std::shared_ptr<const KeypointsAndDescriptors> features2 =
+          feature_cache->Fetch(pair.second);
+      MatchAndVerifyImagePair(feature_and_matches_db_->ImageNameOfId(pair.first),
+                              feature_and_matches_db_->ImageNameOfId(pair.second),
+                              *features1,
+                              *features2);
+    }
+  });
+  LogSchedulerStatistics(scheduler.GetWorkerStatistics());
+
+  // Wait for the reads of blocks that were stolen after they were prefetched.
+  for (Prefetch& prefetch : prefetches) {
+    if (prefetch.features.valid()) {
+      prefetch.features.wait();
+    }
+  }
 
-    // This operation is thread safe.
-    feature_and_matches_db_->PutImagePairMatch(
-        image1_name, image2_name, image_pair_match);
+  int num_feature_loads = 0;
+  for (int i = 0; i < num_threads; i++) {
+    num_feature_loads +=
+        feature_caches[i]->NumCacheMisses() + num_batched_feature_loads[i];
   }
+  VLOG(1) << "Matched " << pairs_to_match_.size() << " pairs in "
+          << blocks.size() << " blocks with " << num_feature_loads
+          << " feature reads from the database.";
+}
+
+void FeatureMatcher::MatchAndVerifyImagePairs(const int start_index,
+                                              const int end_index) {
+  for (int i = start_index; i < end_index; i++) {
+    const std::string& image1_name =
+        feature_and_matches_db_->ImageNameOfId(pairs_to_match_[i].first);
+    const std::string& image2_name =
+        feature_and_matches_db_->ImageNameOfId(pairs_to_match_[i].second);
+    // Get the keypoints and descriptors from the db.
+    const std::shared_ptr<const KeypointsAndDescriptors> features1 =
+        feature_and_matches_db_->GetSharedFeatures(image1_name);
+    const std::shared_ptr<const KeypointsAndDescriptors> features2 =
+        feature_and_matches_db_->GetSharedFeatures(image2_name);
+    MatchAndVerifyImagePair(image1_name, image2_name, *features1, *features2);
+  }
+}
+
+void FeatureMatcher::MatchAndVerifyImagePair(
+    const std::string& image1_name,
+    const std::string& image2_name,
+    const KeypointsAndDescriptors& features1,
+    const KeypointsAndDescriptors& features2) {
+  THEIA_TRACE_SCOPE("FeatureMatcher::MatchAndVerifyImagePair");
+  static Counter* const num_pairs_matched = Metrics::GetCounter(
+      "theia_image_pairs_matched_total", "Image pairs that were matched.");
+  static Counter* const num_pairs_accepted =
+      Metrics::GetCounter("theia_image_pairs_accepted_total",
+                          "Image pairs whose matches were stored.");
+  num_pairs_matched->Increment();
+  // Match the image pair. If the pair fails to match then return.
+  ImagePairMatch image_pair_match;
+  image_pair_match.image1 = image1_name;
+  image_pair_match.image2 = image2_name;
+
+  // Compute the visual matches from feature descriptors.
+  std::vector<IndexedFeatureMatch> putative_matches;
+  if (!MatchImagePair(features1, features2, &putative_matches)) {
+    VLOG(2)
+        << "Could not match a sufficient number of features between images "
+        << image1_name << " and " << image2_name;
+    feature_and_matches_db_->PutFailedImagePair(image1_name, image2_name);
+    return;
+  }
+
+  // Perform geometric verification if applicable.
+  if (options_.perform_geometric_verification) {
+    // If geometric verification fails, do not add the match to the output.
+    if (!GeometricVerification(
+            features1, features2, putative_matches, &image_pair_match)) {
+      VLOG(2) << "Geometric verification between images " << image1_name
+              << " and " << image2_name << " failed.";
+      feature_and_matches_db_->PutFailedImagePair(image1_name, image2_name);
+      return;
+    }
+  } else {
+    // If no geometric verification is performed then the putative matches are
+    // output.
+    image_pair_match.correspondences.reserve(putative_matches.size());
+    for (int i = 0; i < putative_matches.size(); i++) {
+      const Keypoint& keypoint1 =
+          features1.keypoints[putative_matches[i].feature1_ind];
+      const Keypoint& keypoint2 =
+          features2.keypoints[putative_matches[i].feature2_ind];
+      image_pair_match.correspondences.emplace_back(
+          Feature(keypoint1.x(), keypoint1.y()),
+          Feature(keypoint2.x(), keypoint2.y()));
+    }
+  }
+
+  // Log information about the matching results.
+  VLOG(1) << "Images " << image1_name << " and " << image2_name
+          << " were matched with " << image_pair_match.correspondences.size()
+          << " verified matches and "
+          << image_pair_match.twoview_info.num_homography_inliers
+          << " homography matches out of " << putative_matches.size()
+          << " putative matches.";
+
+  // This operation is thread safe.
+  feature_and_matches_db_->PutImagePairMatch(
+      image1_name, image2_name, image_pair_match);
+  num_pairs_accepted->Increment();
 }
 
 bool FeatureMatcher::GeometricVerification(
@@ -200,6 +580,7 @@ bool FeatureMatcher::GeometricVerification(
     const KeypointsAndDescriptors& features2,
     const std::vector<IndexedFeatureMatch>& putative_matches,
     ImagePairMatch* image_pair_match) {
+  THEIA_TRACE_SCOPE("FeatureMatcher::GeometricVerification");
   CameraIntrinsicsPrior intrinsics1, intrinsics2;
 
   // Load camera intrinsics if they are available.
@@ -214,17 +595,65 @@ bool FeatureMatcher::GeometricVerification(
         feature_and_matches_db_->GetCameraIntrinsicsPrior(features2.image_name);
   }
 
+  // Verify each image pair with its own random stream so that the result for
+  // a pair does not depend on which thread verifies it or in which order.
+  TwoViewMatchGeometricVerification::Options verification_options =
+      options_.geometric_verification_options;
+  std::shared_ptr<RandomNumberGenerator>& rng =
+      verification_options.estimate_twoview_info_options.rng;
+  if (rng != nullptr) {
+    rng = rng->Split(std::hash<std::pair<std::string, std::string> >()(
+        std::make_pair(features1.image_name, features2.image_name)));
+  }
+
   TwoViewMatchGeometricVerification geometric_verification(
-      options_.geometric_verification_options,
+      verification_options,
       intrinsics1,
       intrinsics2,
       features1,
       features2,
       putative_matches);
 
-  // Return whether geometric verification succeeds.
-  return geometric_verification.VerifyMatches(
+  const bool success = geometric_verification.VerifyMatches(
       &image_pair_match->correspondences, &image_pair_match->twoview_info);
+
+  static Counter* const num_verifications =
+      Metrics::GetCounter("theia_geometric_verifications_total",
+                          "Image pairs that were geometrically verified.");
+  static Counter* const num_accepted_verifications = Metrics::GetCounter(
+      "theia_geometric_verifications_accepted_total",
+      "Image pairs that passed the geometric verification.");
+  static Gauge* const acceptance_rate = Metrics::GetGauge(
+      "theia_geometric_verification_acceptance_rate",
+      "The fraction of the verified image pairs that passed the verification.");
+  num_verifications->Increment();
+  if (success) {
+    num_accepted_verifications->Increment();
+  }
+  acceptance_rate->Set(
+      static_cast<double>(num_accepted_verifications->Value()) /
+      num_verifications->Value());
+
+  // Record the verification statistics.
+  const TwoViewMatchGeometricVerification::PreVerificationSummary&
+      pre_verification_summary =
+          geometric_verification.pre_verification_summary();
+  std::lock_guard<std::mutex> lock(verification_summary_mutex_);
+  ++verification_summary_.num_verified_pairs;
+  if (pre_verification_summary.rejected) {
+    ++verification_summary_.num_pre_verification_rejections;
+  }
+  verification_summary_.num_pre_verification_hypotheses +=
+      pre_verification_summary.num_hypotheses;
+  verification_summary_.num_pre_verification_hypotheses_rejected_by_sprt +=
+      pre_verification_summary.num_hypotheses_rejected_by_sprt;
+  verification_summary_.num_pre_verification_residuals_evaluated +=
+      pre_verification_summary.num_residuals_evaluated;
+  verification_summary_.ransac_statistics.Merge(
+      geometric_verification.ransac_statistics());
+
+  // Return whether geometric verification succeeds.
+  return success;
 }
 
 }  // namespace theia
@@ -37,13 +37,18 @@
 
 #include <Eigen/Core>
 
+#include <cstdint>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <unordered_map>
 #include <utility>
 #include <vector>
 
 #include "theia/matching/feature_matcher_options.h"
+#include "theia/matching/image_id_map.h"
+#include "theia/solvers/ransac_statistics.h"
+#include "theia/util/lru_cache.h"
 #include "theia/util/util.h"
 
 namespace theia {
@@ -76,6 +81,26 @@ struct KeypointsAndDescriptors;
 // matching.
 class FeatureMatcher {
  public:
+  // Statistics about the geometric verification of the image pairs matched in
+  // the last call to MatchImages.
+  struct GeometricVerificationSummary {
+    // Number of image pairs that went through geometric verification.
+    int num_verified_pairs = 0;
+
+    // Number of image pairs that the pre-verification stage rejected before
+    // the full two-view estimation was run.
+    int num_pre_verification_rejections = 0;
+
+    // Totals over all pre-verified image pairs.
+    int64_t num_pre_verification_hypotheses = 0;
+    int64_t num_pre_verification_hypotheses_rejected_by_sprt = 0;
+    int64_t num_pre_verification_residuals_evaluated = 0;
+
+    // The RANSAC statistics of the two view estimations, merged over all
+    // image pairs that reached the estimation.
+    RansacStatistics ransac_statistics;
+  };
+
   FeatureMatcher(const FeatureMatcherOptions& matcher_options,
                  FeaturesAndMatchesDatabase* feature_and_matches_db);
   virtual ~FeatureMatcher();
@@ -104,7 +129,17 @@ class FeatureMatcher {
   virtual void SetImagePairsToMatch(
       const std::vector<std::pair<std::string, std::string> >& pairs_to_match);
 
+  // Returns the statistics of the geometric verification performed by the last
+  // call to MatchImages.
+  GeometricVerificationSummary GetGeometricVerificationSummary() const;
+
  protected:
+  // Selects all image-to-image pairs for matching if SetImagePairsToMatch has
+  // not been called. When matching incrementally, only pairs with a new image
+  // are selected and pairs that already have a result in the database are
+  // removed.
+  void SelectPairsToMatchIfNeeded();
+
   // NOTE: This method should be overridden in the subclass implementations!
   // Returns true if the image pair is a valid match.
   virtual bool MatchImagePair(
@@ -118,6 +153,13 @@ class FeatureMatcher {
   virtual void MatchAndVerifyImagePairs(const int start_index,
                                         const int end_index);
 
+  // Matches and verifies a single pair of images and stores the result in the
+  // database if it is successful.
+  void MatchAndVerifyImagePair(const std::string& image1_name,
+                               const std::string& image2_name,
+                               const KeypointsAndDescriptors& features1,
+                               const KeypointsAndDescriptors& features2);
+
   // Performs geometric verification. By making this a virtual method, derived
   // classes may implement custom verification methods (e.g., if rotations are
   // known then custom solvers can be used to solve for only the relative
@@ -128,12 +170,6 @@ class FeatureMatcher {
       const std::vector<IndexedFeatureMatch>& putative_matches,
       ImagePairMatch* image_pair_match);
 
-  // Each Threadpool worker will perform matching on this many image pairs.  It
-  // is more efficient to let each thread compute multiple matches at a time
-  // than add each matching task to the pool. This is sort of like OpenMP's
-  // dynamic schedule in that it is able to balance threads fairly efficiently.
-  const int kMaxThreadingStepSize_ = 20;
-
   FeatureMatcherOptions options_;
 
   // A container for the image names.
@@ -142,10 +178,26 @@ class FeatureMatcher {
   // DB to store and retrieve features and matches.
   FeaturesAndMatchesDatabase* feature_and_matches_db_;
 
-  // Pairs that we will perform matching on.
-  std::vector<std::pair<std::string, std::string> > pairs_to_match_;
+  // Pairs that we will perform matching on, as the image ids of the database.
+  // The image names are only looked up to read the features and to store the
+  // results.
+  std::vector<std::pair<ImageId, ImageId> > pairs_to_match_;
+
+  // Geometric verification statistics. Many threads update them, so they are
+  // guarded by a mutex.
+  GeometricVerificationSummary verification_summary_;
+  mutable std::mutex verification_summary_mutex_;
 
  private:
+  typedef LRUCache<ImageId, std::shared_ptr<const KeypointsAndDescriptors> >
+      FeatureCache;
+
+  // Matches pairs_to_match_ block by block where each thread keeps the features
+  // of the images of its current block in its own cache. costs are the
+  // estimated costs of the pairs.
+  void MatchImagePairsInBlocks(const std::vector<double>& costs,
+                               const int num_threads);
+
   DISALLOW_COPY_AND_ASSIGN(FeatureMatcher);
 };
 
@@ -46,6 +46,21 @@ struct FeatureMatcherOptions {
   // Number of threads to use in parallel for matching.
   int num_threads = 1;
 
+  // If true, the threads of the global executor are pinned to the NUMA nodes
+  // of the machine while matching (see ScopedNumaAffinity). The per-thread
+  // feature caches of match_pairs_in_blocks and the scratch arenas are then
+  // filled on the node of their thread, and idle threads take over the blocks
+  // of threads on the same node first. This has no effect on machines with a
+  // single NUMA node.
+  bool numa_aware = false;
+
+  // Image pairs are matched by a work-stealing scheduler that runs the most
+  // expensive pairs first. If true, the cost of a pair is estimated as the
+  // product of the number of features in the two images, which requires
+  // reading the features of every image once before matching. Otherwise all
+  // pairs are assumed to have the same cost.
+  bool schedule_pairs_by_cost = true;
+
   // Matching may be performed in core (i.e. all in memory) or out-of-core. For
   // the latter, features are written and read to/from disk as needed (utilizing
   // an LRU cache). The out-of-core strategy is more scalable since the memory
@@ -63,6 +78,21 @@ struct FeatureMatcherOptions {
   // perform image-to-image matching.
   int cache_capacity = 128;
 
+  // If true, the image pairs are grouped into square blocks of the image-pair
+  // matrix and every thread keeps the features of up to
+  // cache_capacity / num_threads images in its own LRU cache. Each block covers
+  // at most half of that cache, so the features of an image are read from the
+  // database roughly once per block instead of once per pair. This greatly
+  // reduces the reads for out-of-core databases.
+  bool match_pairs_in_blocks = false;
+
+  // If true and the pairs are matched in blocks, each thread reads the features
+  // of the images of its next block with one batched read of the database
+  // (FeaturesAndMatchesDatabase::GetSharedFeaturesBatch) in the background
+  // while it matches the current block. This hides the read latency of
+  // databases that store the features on slow or remote storage.
+  bool prefetch_features = true;
+
   // Only symmetric matches are kept.
   bool keep_only_symmetric_matches = true;
 
@@ -72,6 +102,52 @@ struct FeatureMatcherOptions {
   bool use_lowes_ratio = true;
   float lowes_ratio = 0.8;
 
+  // If true, the brute force matcher computes the descriptor distances in
+  // tiles of block_size x block_size as ||a||^2 + ||b||^2 - 2 * A * B^t so that
+  // the bulk of the work is a matrix-matrix product. The two nearest neighbors
+  // of each row and each column are tracked together, so the symmetric
+  // (reverse) matches come from the same tiles instead of a second sweep. This
+  // is much faster for large feature sets. It assumes the L2 distance.
+  bool use_blocked_brute_force_matching = false;
+  int brute_force_block_size = 512;
+
+  // Options for the LSH matcher of binary descriptors. Each of the
+  // num_lsh_tables hash tables buckets the descriptors by lsh_key_size_in_bits
+  // randomly sampled bits, and only descriptors that share a bucket in at least
+  // one table are compared. More tables find more true neighbors at a higher
+  // cost while longer keys make the buckets smaller. Keys are at most 32 bits.
+  int num_lsh_tables = 8;
+  int lsh_key_size_in_bits = 16;
+
+  // Options for the KD-tree matcher, which searches a FLANN randomized KD-forest
+  // of num_kd_trees trees and visits at most num_kd_tree_checks leaves for each
+  // query. More trees and checks find more true nearest neighbors at a higher
+  // cost. The indices of the kd_tree_index_cache_size most recently matched
+  // images are kept so that they are not rebuilt for every pair.
+  int num_kd_trees = 4;
+  int num_kd_tree_checks = 256;
+  int kd_tree_index_cache_size = 64;
+
+  // The cascade hashing matcher keeps the hashed images of up to this many
+  // megabytes in memory. Hashed images are evicted once all of their scheduled
+  // pairs have been matched, or earlier if the budget is exceeded.
+  int hashed_images_cache_size_in_mb = 1024;
+
+  // If true, the cascade hashing matcher stores the hashed images in the
+  // features and matches database (if the database supports it) so that they
+  // do not need to be recomputed when matching is run again.
+  bool store_hashed_images_in_database = true;
+
+  // If true, image pairs that already have a result in the features and
+  // matches database are not matched again. A result is either a stored match
+  // or a failed image pair (a pair that did not produce enough feature matches
+  // or failed geometric verification), so negative results are not retried.
+  // If SetImagePairsToMatch has not been called, only the pairs that contain a
+  // new image are selected, i.e., new images are matched against the old images
+  // and against each other. Old images are the images that appear in any stored
+  // result. This is useful when images are appended to an existing project.
+  bool match_incrementally = false;
+
   // After performing feature matching with descriptors typically the 2-view
   // geometry is estimated using RANSAC (from the matched descriptors) and only
   // the features that support the estimated geometry are "verified" as
@@ -35,15 +35,96 @@
 #ifndef THEIA_MATCHING_FEATURE_MATCHER_UTILS_H_
 #define THEIA_MATCHING_FEATURE_MATCHER_UTILS_H_
 
+#include <functional>
+#include <limits>
+#include <memory>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
+#include "theia/matching/indexed_feature_match.h"
+#include "theia/util/map_util.h"
+
 namespace theia {
-struct IndexedFeatureMatch;
 
 // Modifies forward matches so that it removes all matches that are not
-// contained in the backwards matches.
-void IntersectMatches(const std::vector<IndexedFeatureMatch>& backwards_matches,
-                      std::vector<IndexedFeatureMatch>* forward_matches);
+// contained in the backwards matches. The containers may use any allocator so
+// that the scratch matches of a matcher can be allocated from an arena.
+template <class BackwardsAllocator, class ForwardAllocator>
+void IntersectMatches(
+    const std::vector<IndexedFeatureMatch, BackwardsAllocator>&
+        backwards_matches,
+    std::vector<IndexedFeatureMatch, ForwardAllocator>* forward_matches) {
+  // The lookup uses the allocator of the backwards matches as well.
+  typedef typename std::allocator_traits<BackwardsAllocator>::
+      template rebind_alloc<std::pair<const int, int> >
+          IndexMapAllocator;
+  std::unordered_map<int, int, std::hash<int>, std::equal_to<int>,
+                     IndexMapAllocator>
+      index_map(backwards_matches.size(),
+                std::hash<int>(),
+                std::equal_to<int>(),
+                IndexMapAllocator(backwards_matches.get_allocator()));
+  // Add all feature2 -> feature1 matches to the map.
+  for (const IndexedFeatureMatch& feature_match : backwards_matches) {
+    InsertOrDie(
+        &index_map, feature_match.feature1_ind, feature_match.feature2_ind);
+  }
+
+  // Search the map for feature1 -> feature2 matches that are also present in
+  // the feature2 -> feature1 matches.
+  auto match_iterator = forward_matches->begin();
+  while (match_iterator != forward_matches->end()) {
+    if (match_iterator->feature1_ind !=
+        FindWithDefault(index_map, match_iterator->feature2_ind, -1)) {
+      match_iterator = forward_matches->erase(match_iterator);
+      continue;
+    }
+
+    ++match_iterator;
+  }
+}
+
+// The two nearest neighbors found so far for a single query descriptor.
+struct TopTwoNeighbors {
+  float best_distance = std::numeric_limits<float>::max();
+  float second_best_distance = std::numeric_limits<float>::max();
+  int best_index = -1;
+
+  inline void Update(const float distance, const int index) {
+    if (distance < best_distance) {
+      second_best_distance = best_distance;
+      best_distance = distance;
+      best_index = index;
+    } else if (distance < second_best_distance) {
+      second_best_distance = distance;
+    }
+  }
+};
+
+// Converts the nearest neighbors into matches, applying the ratio test if
+// desired. The ratio must be expressed in the units of the distances (i.e.
+// squared for squared L2 distances). The index of each query is stored as
+// feature1_ind.
+template <class NeighborsAllocator, class MatchesAllocator>
+void NeighborsToMatches(
+    const std::vector<TopTwoNeighbors, NeighborsAllocator>& neighbors,
+    const bool use_lowes_ratio,
+    const float distance_ratio,
+    std::vector<IndexedFeatureMatch, MatchesAllocator>* matches) {
+  for (int i = 0; i < neighbors.size(); i++) {
+    const TopTwoNeighbors& neighbor = neighbors[i];
+    if (neighbor.best_index < 0) {
+      continue;
+    }
+
+    if (!use_lowes_ratio ||
+        neighbor.best_distance <
+            distance_ratio * neighbor.second_best_distance) {
+      matches->emplace_back(i, neighbor.best_index, neighbor.best_distance);
+    }
+  }
+}
 
 }  // namespace theia
 
@@ -53,4 +53,29 @@ TEST(FeatureMatcherUtils, IntersectMatches) {
   EXPECT_EQ(matches[0].feature2_ind, 1);
 }
 
+TEST(FeatureMatcherUtils, NeighborsToMatches) {
+  std::vector<TopTwoNeighbors> neighbors(3);
+  neighbors[0].Update(1.0, 4);
+  neighbors[0].Update(4.0, 2);
+  neighbors[1].Update(3.0, 1);
+  neighbors[1].Update(2.0, 0);
+  // neighbors[2] has no candidates and never produces a match.
+
+  // Without the ratio test every query with a neighbor gets matched.
+  std::vector<IndexedFeatureMatch> matches;
+  NeighborsToMatches(neighbors, false, 0.5, &matches);
+  ASSERT_EQ(matches.size(), 2);
+  EXPECT_EQ(matches[0].feature1_ind, 0);
+  EXPECT_EQ(matches[0].feature2_ind, 4);
+  EXPECT_EQ(matches[1].feature1_ind, 1);
+  EXPECT_EQ(matches[1].feature2_ind, 0);
+  EXPECT_EQ(matches[1].distance, 2.0);
+
+  // Only the first neighbor is distinctive enough to pass the ratio test.
+  matches.clear();
+  NeighborsToMatches(neighbors, true, 0.5, &matches);
+  ASSERT_EQ(matches.size(), 1);
+  EXPECT_EQ(matches[0].feature1_ind, 0);
+}
+
 }  // namespace theia
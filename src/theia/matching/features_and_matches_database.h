@@ -35,13 +35,19 @@
 #ifndef THEIA_MATCHING_FEATURES_AND_MATCHES_DATABASE_H_
 #define THEIA_MATCHING_FEATURES_AND_MATCHES_DATABASE_H_
 
+#include <algorithm>
+#include <functional>
+#include <memory>
 #include <string>
 #include <utility>
 #include <vector>
 
+#include "theia/matching/cascade_hasher.h"
+#include "theia/matching/image_id_map.h"
 #include "theia/matching/image_pair_match.h"
 #include "theia/matching/keypoints_and_descriptors.h"
 #include "theia/sfm/camera_intrinsics_prior.h"
+#include "theia/util/filesystem.h"
 
 namespace theia {
 
@@ -73,6 +79,40 @@ class FeaturesAndMatchesDatabase {
   virtual KeypointsAndDescriptors GetFeatures(
       const std::string& image_name) = 0;
 
+  // Returns a shared, immutable handle to the features for the image. Callers
+  // that only read the features should prefer this method: databases that keep
+  // the features in memory return them without copying the descriptors. The
+  // default implementation copies the result of GetFeatures.
+  virtual std::shared_ptr<const KeypointsAndDescriptors> GetSharedFeatures(
+      const std::string& image_name) {
+    return std::make_shared<const KeypointsAndDescriptors>(
+        GetFeatures(image_name));
+  }
+
+  // Returns the shared features of each of the images, in the order of
+  // image_names. Databases that store the features on disk should override this
+  // method to issue the reads together, so that a caller that knows the images
+  // it will need next (e.g. the next block of image pairs of a matching thread)
+  // waits for the slowest read rather than for the sum of all reads. The
+  // default implementation calls GetSharedFeatures for each image.
+  virtual std::vector<std::shared_ptr<const KeypointsAndDescriptors>>
+  GetSharedFeaturesBatch(const std::vector<std::string>& image_names) {
+    std::vector<std::shared_ptr<const KeypointsAndDescriptors>> features;
+    features.reserve(image_names.size());
+    for (const std::string& image_name : image_names) {
+      features.emplace_back(GetSharedFeatures(image_name));
+    }
+    return features;
+  }
+
+  // Returns only the keypoints of the image. Stages that do not match
+  // descriptors (e.g. track building) should use this method: databases that
+  // store the keypoints separately read a fraction of the bytes of
+  // GetFeatures. The default implementation reads the features.
+  virtual std::vector<Keypoint> GetKeypoints(const std::string& image_name) {
+    return GetSharedFeatures(image_name)->keypoints;
+  }
+
   // Set the features for the image.
   virtual void PutFeatures(const std::string& image_name,
                            const KeypointsAndDescriptors& features) = 0;
@@ -81,6 +121,23 @@ class FeaturesAndMatchesDatabase {
   virtual std::vector<std::string> ImageNamesOfFeatures() = 0;
   virtual size_t NumImages() = 0;
 
+  // Dense integer ids of the images, which matching uses in place of the image
+  // names. An id is assigned the first time GetOrAddImageId is called with the
+  // image name and is stable for the lifetime of the database; persistent
+  // databases keep the ids across runs. FindImageId returns kInvalidImageId for
+  // images without an id. The returned name references remain valid for the
+  // lifetime of the database.
+  virtual ImageId GetOrAddImageId(const std::string& image_name) {
+    return image_ids_.GetOrAddImageId(image_name);
+  }
+  virtual ImageId FindImageId(const std::string& image_name) {
+    return image_ids_.FindImageId(image_name);
+  }
+  virtual const std::string& ImageNameOfId(const ImageId image_id) {
+    return image_ids_.ImageName(image_id);
+  }
+  virtual int NumImageIds() { return image_ids_.NumImages(); }
+
   // Get the image pair match for the images.
   virtual ImagePairMatch GetImagePairMatch(const std::string& image_name1,
                                            const std::string& image_name2) = 0;
@@ -95,8 +152,117 @@ class FeaturesAndMatchesDatabase {
   ImageNamesOfMatches() = 0;
   virtual size_t NumMatches() = 0;
 
-  // Clear all matches from the DB.
+  // Called with the image names of each stored image pair. Returning false
+  // stops the iteration.
+  typedef std::function<bool(const std::string& image_name1,
+                             const std::string& image_name2)>
+      ImagePairCallback;
+  typedef std::function<bool(const std::string& image_name1,
+                             const std::string& image_name2,
+                             const ImagePairMatch& match)>
+      ImagePairMatchCallback;
+
+  // Returns true if a match is stored for the image pair in the given order.
+  // Databases should override this with a direct lookup; the default
+  // implementation lists all matches.
+  virtual bool ContainsImagePairMatch(const std::string& image_name1,
+                                      const std::string& image_name2) {
+    const auto image_pairs = ImageNamesOfMatches();
+    return std::find(image_pairs.begin(),
+                     image_pairs.end(),
+                     std::make_pair(image_name1, image_name2)) !=
+           image_pairs.end();
+  }
+
+  // Streams the image names of the stored matches, or the matches themselves,
+  // in an unspecified order without materializing the list of all image
+  // pairs. The database must not be written to during the iteration. The
+  // default implementations iterate over ImageNamesOfMatches.
+  virtual void ForEachMatchedImagePair(const ImagePairCallback& callback) {
+    for (const auto& image_pair : ImageNamesOfMatches()) {
+      if (!callback(image_pair.first, image_pair.second)) {
+        return;
+      }
+    }
+  }
+  virtual void ForEachImagePairMatch(const ImagePairMatchCallback& callback) {
+    for (const auto& image_pair : ImageNamesOfMatches()) {
+      if (!callback(image_pair.first,
+                    image_pair.second,
+                    GetImagePairMatch(image_pair.first, image_pair.second))) {
+        return;
+      }
+    }
+  }
+
+  // Clear all matches (and failed image pairs) from the DB.
   virtual void RemoveAllMatches() = 0;
+
+  // Optional storage for the image pairs that were matched but did not produce
+  // a match (e.g., too few feature matches or failed geometric verification)
+  // so that incremental matching does not retry them. Databases that do not
+  // override these methods do not store failed image pairs.
+  virtual void PutFailedImagePair(const std::string& image_name1,
+                                  const std::string& image_name2) {}
+  virtual std::vector<std::pair<std::string, std::string>>
+  ImageNamesOfFailedImagePairs() {
+    return {};
+  }
+
+  // The failed image pair counterparts of ContainsImagePairMatch and
+  // ForEachMatchedImagePair, with default implementations that use
+  // ImageNamesOfFailedImagePairs.
+  virtual bool ContainsFailedImagePair(const std::string& image_name1,
+                                       const std::string& image_name2) {
+    const auto image_pairs = ImageNamesOfFailedImagePairs();
+    return std::find(image_pairs.begin(),
+                     image_pairs.end(),
+                     std::make_pair(image_name1, image_name2)) !=
+           image_pairs.end();
+  }
+  virtual void ForEachFailedImagePair(const ImagePairCallback& callback) {
+    for (const auto& image_pair : ImageNamesOfFailedImagePairs()) {
+      if (!callback(image_pair.first, image_pair.second)) {
+        return;
+      }
+    }
+  }
+
+  // Blocks until all pending writes have been stored. Persistent databases also
+  // make the stored data durable. Databases that write synchronously need not
+  // override this method.
+  virtual void Flush() {}
+
+  // Optional storage for the hashed images of the cascade hashing matcher so
+  // that subsequent runs do not need to hash the descriptors again. Databases
+  // that do not override these methods do not store hashed images. Returns
+  // true and sets hashed_image if a hashed image exists for the image.
+  virtual bool GetHashedImage(const std::string& image_name,
+                              HashedImage* hashed_image) {
+    return false;
+  }
+
+  // Stores the hashed image, replacing any previous value.
+  virtual void PutHashedImage(const std::string& image_name,
+                              const HashedImage& hashed_image) {}
+
+  // Optional storage for the signatures (size and modification time) of the
+  // image files whose camera intrinsics priors were extracted from the image
+  // metadata, so that subsequent runs only scan the images that changed.
+  // Databases that do not override these methods do not store signatures.
+  // Returns true and sets signature if a signature exists for the image.
+  virtual bool GetImageFileSignature(const std::string& image_name,
+                                     FileSignature* signature) {
+    return false;
+  }
+
+  // Stores the image file signature, replacing any previous value.
+  virtual void PutImageFileSignature(const std::string& image_name,
+                                     const FileSignature& signature) {}
+
+ protected:
+  // The image ids of databases that do not override the image id methods.
+  ImageIdMap image_ids_;
 };
 }  // namespace theia
 #endif  // THEIA_MATCHING_FEATURES_AND_MATCHES_DATABASE_H_
@@ -0,0 +1,213 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+
+#include "theia/matching/features_and_matches_database_shards.h"
+
+#include <glog/logging.h>
+#include <cstdint>
+#include <string>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "theia/matching/features_and_matches_database.h"
+#include "theia/matching/image_pair_match.h"
+#include "theia/util/hash.h"
+#include "theia/util/map_util.h"
+
+namespace theia {
+
+namespace {
+
+static const uint64_t kFnvOffsetBasis = 14695981039346656037ull;
+
+// The 64 bit FNV-1a hash. Unlike std::hash it gives the same value on every
+// platform, which all workers of a sharded run must agree on.
+uint64_t HashImageName(const std::string& image_name, uint64_t hash) {
+  static const uint64_t kFnvPrime = 1099511628211ull;
+  for (const char c : image_name) {
+    hash ^= static_cast<unsigned char>(c);
+    hash *= kFnvPrime;
+  }
+  return hash;
+}
+
+typedef std::pair<std::string, std::string> ImageNamePair;
+
+// The matched and failed image pairs of the database, in both orders.
+std::unordered_set<ImageNamePair> MatchedImagePairs(
+    FeaturesAndMatchesDatabase* database) {
+  std::unordered_set<ImageNamePair> matched_image_pairs;
+  for (const auto& image_pairs : {database->ImageNamesOfMatches(),
+                                  database->ImageNamesOfFailedImagePairs()}) {
+    for (const ImageNamePair& image_pair : image_pairs) {
+      matched_image_pairs.emplace(image_pair);
+      matched_image_pairs.emplace(image_pair.second, image_pair.first);
+    }
+  }
+  return matched_image_pairs;
+}
+
+}  // namespace
+
+int ShardOfImage(const std::string& image_name, const int num_shards) {
+  CHECK_GT(num_shards, 0);
+  return HashImageName(image_name, kFnvOffsetBasis) % num_shards;
+}
+
+int ShardOfImagePair(const std::string& image_name1,
+                     const std::string& image_name2,
+                     const int num_shards) {
+  CHECK_GT(num_shards, 0);
+  const bool ordered = image_name1 < image_name2;
+  const std::string& first = ordered ? image_name1 : image_name2;
+  const std::string& second = ordered ? image_name2 : image_name1;
+  // Hash a separator between the names so that e.g. ("ab", "c") and ("a",
+  // "bc") are hashed differently.
+  const uint64_t hash = HashImageName(
+      second, HashImageName(std::string(1, '\0'),
+                            HashImageName(first, kFnvOffsetBasis)));
+  return hash % num_shards;
+}
+
+std::vector<std::string> ImagesOfShard(
+    const std::vector<std::string>& image_names,
+    const int num_shards,
+    const int shard_index) {
+  CHECK_GE(shard_index, 0);
+  CHECK_LT(shard_index, num_shards);
+  std::vector<std::string> shard;
+  for (const std::string& image_name : image_names) {
+    if (ShardOfImage(image_name, num_shards) == shard_index) {
+      shard.emplace_back(image_name);
+    }
+  }
+  return shard;
+}
+
+std::vector<ImageNamePair> ImagePairsOfShard(
+    const std::vector<ImageNamePair>& image_pairs,
+    const int num_shards,
+    const int shard_index) {
+  CHECK_GE(shard_index, 0);
+  CHECK_LT(shard_index, num_shards);
+  std::vector<ImageNamePair> shard;
+  for (const ImageNamePair& image_pair : image_pairs) {
+    if (ShardOfImagePair(image_pair.first, image_pair.second, num_shards) ==
+        shard_index) {
+      shard.emplace_back(image_pair);
+    }
+  }
+  return shard;
+}
+
+void RemoveImagesWithFeatures(FeaturesAndMatchesDatabase* database,
+                              std::vector<std::string>* image_names) {
+  CHECK_NOTNULL(database);
+  CHECK_NOTNULL(image_names);
+  auto it = image_names->begin();
+  for (const std::string& image_name : *image_names) {
+    if (!database->ContainsFeatures(image_name)) {
+      *it++ = image_name;
+    }
+  }
+  image_names->erase(it, image_names->end());
+}
+
+void RemoveMatchedImagePairs(FeaturesAndMatchesDatabase* database,
+                             std::vector<ImageNamePair>* image_pairs) {
+  CHECK_NOTNULL(database);
+  CHECK_NOTNULL(image_pairs);
+  const std::unordered_set<ImageNamePair> matched_image_pairs =
+      MatchedImagePairs(database);
+  auto it = image_pairs->begin();
+  for (const ImageNamePair& image_pair : *image_pairs) {
+    if (!ContainsKey(matched_image_pairs, image_pair)) {
+      *it++ = image_pair;
+    }
+  }
+  image_pairs->erase(it, image_pairs->end());
+}
+
+int MergeFeaturesAndMatchesDatabases(
+    const std::vector<FeaturesAndMatchesDatabase*>& shards,
+    FeaturesAndMatchesDatabase* merged) {
+  CHECK_NOTNULL(merged);
+  std::unordered_set<ImageNamePair> merged_image_pairs =
+      MatchedImagePairs(merged);
+
+  int num_copied = 0;
+  for (FeaturesAndMatchesDatabase* shard : shards) {
+    CHECK_NOTNULL(shard);
+    // The priors are small, so they are always copied.
+    for (const std::string& image_name :
+         shard->ImageNamesOfCameraIntrinsicsPriors()) {
+      merged->PutCameraIntrinsicsPrior(
+          image_name, shard->GetCameraIntrinsicsPrior(image_name));
+    }
+
+    for (const std::string& image_name : shard->ImageNamesOfFeatures()) {
+      if (!merged->ContainsFeatures(image_name)) {
+        merged->PutFeatures(image_name, shard->GetFeatures(image_name));
+        ++num_copied;
+      }
+    }
+
+    for (const ImageNamePair& image_pair : shard->ImageNamesOfMatches()) {
+      if (merged_image_pairs.emplace(image_pair).second) {
+        merged_image_pairs.emplace(image_pair.second, image_pair.first);
+        merged->PutImagePairMatch(
+            image_pair.first,
+            image_pair.second,
+            shard->GetImagePairMatch(image_pair.first, image_pair.second));
+        ++num_copied;
+      }
+    }
+
+    for (const ImageNamePair& image_pair :
+         shard->ImageNamesOfFailedImagePairs()) {
+      if (merged_image_pairs.emplace(image_pair).second) {
+        merged_image_pairs.emplace(image_pair.second, image_pair.first);
+        merged->PutFailedImagePair(image_pair.first, image_pair.second);
+      }
+    }
+  }
+
+  // Persistent databases only make the merged data durable on Flush.
+  merged->Flush();
+  return num_copied;
+}
+
+}  // namespace theia
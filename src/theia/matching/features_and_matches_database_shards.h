@@ -0,0 +1,92 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+
+#ifndef THEIA_MATCHING_FEATURES_AND_MATCHES_DATABASE_SHARDS_H_
+#define THEIA_MATCHING_FEATURES_AND_MATCHES_DATABASE_SHARDS_H_
+
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace theia {
+
+class FeaturesAndMatchesDatabase;
+
+// Helpers to split feature extraction and matching across several processes
+// (e.g. the nodes of a cluster) that see the same images. Each worker extracts
+// the features of its shard of the images and matches its shard of the image
+// pairs into its own database, and the shard databases are merged afterwards.
+// The shards are derived from the image names only, so every worker computes
+// the same assignment without coordinating with the others, and a worker that
+// is restarted resumes its shard by skipping the work found in its database.
+
+// Returns the shard in [0, num_shards) of the image or image pair. The shard is
+// computed from a hash of the names that does not depend on the platform, and
+// the shard of an image pair does not depend on the order of the images.
+int ShardOfImage(const std::string& image_name, const int num_shards);
+int ShardOfImagePair(const std::string& image_name1,
+                     const std::string& image_name2,
+                     const int num_shards);
+
+// Returns the images or image pairs of the shard, in their input order.
+std::vector<std::string> ImagesOfShard(
+    const std::vector<std::string>& image_names,
+    const int num_shards,
+    const int shard_index);
+std::vector<std::pair<std::string, std::string> > ImagePairsOfShard(
+    const std::vector<std::pair<std::string, std::string> >& image_pairs,
+    const int num_shards,
+    const int shard_index);
+
+// Removes the images whose features are in the database, and the image pairs
+// that were matched or failed to match (in either order), so that an
+// interrupted shard only processes the remaining work.
+void RemoveImagesWithFeatures(FeaturesAndMatchesDatabase* database,
+                              std::vector<std::string>* image_names);
+void RemoveMatchedImagePairs(
+    FeaturesAndMatchesDatabase* database,
+    std::vector<std::pair<std::string, std::string> >* image_pairs);
+
+// Copies the camera intrinsics priors, features, matches and failed image pairs
+// of the shard databases to the merged database. Features and matches that are
+// already in the merged database are not copied again, so an interrupted merge
+// can be restarted. Returns the number of features and matches copied.
+int MergeFeaturesAndMatchesDatabases(
+    const std::vector<FeaturesAndMatchesDatabase*>& shards,
+    FeaturesAndMatchesDatabase* merged);
+
+}  // namespace theia
+
+#endif  // THEIA_MATCHING_FEATURES_AND_MATCHES_DATABASE_SHARDS_H_
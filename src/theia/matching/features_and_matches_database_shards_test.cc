@@ -0,0 +1,149 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "theia/matching/features_and_matches_database_shards.h"
+#include "theia/matching/image_pair_match.h"
+#include "theia/matching/in_memory_features_and_matches_database.h"
+#include "theia/matching/keypoints_and_descriptors.h"
+
+namespace theia {
+
+namespace {
+
+std::vector<std::string> ImageNames(const int num_images) {
+  std::vector<std::string> image_names;
+  for (int i = 0; i < num_images; i++) {
+    image_names.emplace_back("image" + std::to_string(i) + ".jpg");
+  }
+  return image_names;
+}
+
+ImagePairMatch MatchOfImages(const std::string& image1,
+                             const std::string& image2) {
+  ImagePairMatch match;
+  match.image1 = image1;
+  match.image2 = image2;
+  match.correspondences.resize(3);
+  return match;
+}
+
+}  // namespace
+
+TEST(FeaturesAndMatchesDatabaseShards, ShardsPartitionImagesAndPairs) {
+  static const int kNumShards = 4;
+  const std::vector<std::string> image_names = ImageNames(100);
+  std::vector<std::pair<std::string, std::string> > image_pairs;
+  for (int i = 0; i < image_names.size(); i++) {
+    for (int j = i + 1; j < image_names.size(); j++) {
+      image_pairs.emplace_back(image_names[i], image_names[j]);
+    }
+  }
+
+  int num_images = 0;
+  int num_image_pairs = 0;
+  for (int i = 0; i < kNumShards; i++) {
+    const auto images_of_shard = ImagesOfShard(image_names, kNumShards, i);
+    const auto image_pairs_of_shard =
+        ImagePairsOfShard(image_pairs, kNumShards, i);
+    // The shards are roughly balanced.
+    EXPECT_GT(images_of_shard.size(), image_names.size() / kNumShards / 2);
+    EXPECT_GT(image_pairs_of_shard.size(),
+              image_pairs.size() / kNumShards / 2);
+    for (const auto& image_name : images_of_shard) {
+      EXPECT_EQ(ShardOfImage(image_name, kNumShards), i);
+    }
+    num_images += images_of_shard.size();
+    num_image_pairs += image_pairs_of_shard.size();
+  }
+  EXPECT_EQ(num_images, image_names.size());
+  EXPECT_EQ(num_image_pairs, image_pairs.size());
+
+  // The shard of a pair does not depend on the order of the images.
+  for (const auto& image_pair : image_pairs) {
+    EXPECT_EQ(
+        ShardOfImagePair(image_pair.first, image_pair.second, kNumShards),
+        ShardOfImagePair(image_pair.second, image_pair.first, kNumShards));
+  }
+}
+
+TEST(FeaturesAndMatchesDatabaseShards, RemoveCompletedWork) {
+  InMemoryFeaturesAndMatchesDatabase database;
+  database.PutFeatures("a", KeypointsAndDescriptors());
+  database.PutImagePairMatch("a", "b", MatchOfImages("a", "b"));
+  database.PutFailedImagePair("c", "a");
+
+  std::vector<std::string> image_names = {"a", "b", "c"};
+  RemoveImagesWithFeatures(&database, &image_names);
+  EXPECT_EQ(image_names, std::vector<std::string>({"b", "c"}));
+
+  std::vector<std::pair<std::string, std::string> > image_pairs = {
+      {"a", "b"}, {"b", "a"}, {"a", "c"}, {"b", "c"}};
+  RemoveMatchedImagePairs(&database, &image_pairs);
+  ASSERT_EQ(image_pairs.size(), 1);
+  EXPECT_EQ(image_pairs[0], std::make_pair(std::string("b"), std::string("c")));
+}
+
+TEST(FeaturesAndMatchesDatabaseShards, MergeShards) {
+  InMemoryFeaturesAndMatchesDatabase shard1, shard2, merged;
+  shard1.PutFeatures("a", KeypointsAndDescriptors());
+  shard1.PutFeatures("b", KeypointsAndDescriptors());
+  shard2.PutFeatures("c", KeypointsAndDescriptors());
+  shard1.PutImagePairMatch("a", "b", MatchOfImages("a", "b"));
+  shard2.PutImagePairMatch("b", "c", MatchOfImages("b", "c"));
+  shard2.PutFailedImagePair("a", "c");
+  CameraIntrinsicsPrior prior;
+  prior.focal_length.is_set = true;
+  prior.focal_length.value[0] = 500.0;
+  shard2.PutCameraIntrinsicsPrior("c", prior);
+
+  EXPECT_EQ(MergeFeaturesAndMatchesDatabases({&shard1, &shard2}, &merged), 5);
+  EXPECT_EQ(merged.NumImages(), 3);
+  EXPECT_EQ(merged.NumMatches(), 2);
+  EXPECT_EQ(merged.GetImagePairMatch("b", "c").correspondences.size(), 3);
+  EXPECT_EQ(merged.ImageNamesOfFailedImagePairs().size(), 1);
+  EXPECT_EQ(merged.GetCameraIntrinsicsPrior("c").focal_length.value[0], 500.0);
+
+  // Merging again copies nothing, so an interrupted merge can be resumed.
+  EXPECT_EQ(MergeFeaturesAndMatchesDatabases({&shard1, &shard2}, &merged), 0);
+  EXPECT_EQ(merged.NumMatches(), 2);
+}
+
+}  // namespace theia
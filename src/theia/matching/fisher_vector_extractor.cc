@@ -32,14 +32,15 @@
 // Please contact the author of this library if you have any questions.
 // Author: Chris Sweeney (sweeney.chris.m@gmail.com)
 
-extern "C" {
-#include <vlfeat/vl/fisher.h>
-#include <vlfeat/vl/gmm.h>
-}
-
 #include <Eigen/Core>
+#include <cereal/archives/portable_binary.hpp>
 #include <glog/logging.h>
+#include <algorithm>
+#include <cmath>
+#include <fstream>  // NOLINT
+#include <limits>
 #include <memory>
+#include <string>
 #include <vector>
 
 #include "theia/matching/fisher_vector_extractor.h"
@@ -54,74 +55,205 @@ Eigen::MatrixXf ConvertVectorOfFeaturesToMatrix(
   }
   return feature_table;
 }
-}  // namespace
-
-// Wrapper for the VlFeat gmm.
-class FisherVectorExtractor::GaussianMixtureModel {
- public:
-  // NOTE: We need the unique_ptr to use vlfeat's delete function for the GMM.
-  GaussianMixtureModel(const int num_clusters)
-      : num_clusters_(num_clusters), gmm_(nullptr, vl_gmm_delete) {}
 
-  int num_clusters() const { return num_clusters_; }
+// Components with a smaller prior are skipped, as are the contributions of
+// features with a smaller posterior, as in VLFeat.
+static const float kMinPrior = 1e-6f;
+static const float kMinPosterior = 1e-6f;
 
-  // Computes the Gaussian mixture model based on the input training features.
-  bool Compute(const Eigen::MatrixXf& data_points) {
-    CHECK(!data_points.hasNaN());
-
-    // Create the GMM instance.
-    gmm_.reset(vl_gmm_new(VL_TYPE_FLOAT, data_points.rows(), num_clusters_));
-    if (!gmm_) {
-      return false;
-    }
-    // Compute the model.
-    const double distortion =
-        vl_gmm_cluster(gmm_.get(), data_points.data(), data_points.cols());
-    CHECK(!std::isnan(distortion));
-    return true;
-  }
+// The training features are sampled with a fixed seed so that the same images,
+// added in the same order, always train the same GMM.
+static const unsigned kTrainingFeatureSamplerSeed = 53;
 
-  // Helper accessor methods for retreiving VLFeat types.
-  void const* GetMeans() const { return vl_gmm_get_means(gmm_.get()); }
-  void const* GetCovariances() const {
-    return vl_gmm_get_covariances(gmm_.get());
-  }
-  void const* GetPriors() const { return vl_gmm_get_priors(gmm_.get()); }
+}  // namespace
 
- private:
-  // Number of clusters.
-  const int num_clusters_;
-  // The VlFeat GMM model.
-  std::unique_ptr<VlGMM, void (*)(VlGMM*)> gmm_;
+// The intermediate results of Encode, which are reused across images.
+struct FisherVectorExtractor::EncodingBuffers {
+  Eigen::MatrixXf log_densities;
+  Eigen::MatrixXf mean_deviations;
+  Eigen::MatrixXf variance_deviations;
+  Eigen::VectorXf normalized_difference;
+  std::vector<int> components;
+  DescriptorMatrix dequantized_descriptors;
 };
 
 FisherVectorExtractor::FisherVectorExtractor(const Options& options)
-    : gmm_(new GaussianMixtureModel(options.num_gmm_clusters)),
-      training_feature_sampler_(options.max_num_features_for_training) {}
-
-FisherVectorExtractor::~FisherVectorExtractor() {}
+    : options_(options),
+      training_feature_sampler_(options.max_num_features_for_training,
+                                kTrainingFeatureSamplerSeed),
+      num_training_features_(0) {}
 
 void FisherVectorExtractor::AddFeaturesForTraining(
     const std::vector<Eigen::VectorXf>& features) {
+  if (features.empty()) {
+    return;
+  }
+  if (training_features_.size() == 0) {
+    training_features_.resize(
+        features[0].size(),
+        std::min<int>(features.size(), options_.max_num_features_for_training));
+  }
+
   for (const Eigen::VectorXf& feature : features) {
     CHECK(!feature.hasNaN()) << "Feature: " << feature.transpose();
-    training_feature_sampler_.AddElementToSampler(feature);
+    CHECK_EQ(feature.size(), training_features_.rows());
+    const int sample_index = training_feature_sampler_.NextSampleIndex();
+    if (sample_index < 0) {
+      continue;
+    }
+    // Grow the sample matrix geometrically until it holds all samples.
+    if (sample_index == training_features_.cols()) {
+      training_features_.conservativeResize(
+          Eigen::NoChange,
+          std::min(2 * sample_index, options_.max_num_features_for_training));
+    }
+    training_features_.col(sample_index) = feature;
+    num_training_features_ = std::max(num_training_features_, sample_index + 1);
   }
 }
 
 bool FisherVectorExtractor::Train() {
   // Get the features randomly sampled for training.
-  const auto& sampled_features = training_feature_sampler_.GetAllSamples();
-  CHECK_GT(sampled_features.size(), 0);
+  CHECK_GT(num_training_features_, 0);
   LOG(INFO) << "Training GMM for Fisher Vector extractin with "
-            << sampled_features.size() << " features sampled from "
+            << num_training_features_ << " features sampled from "
             << training_feature_sampler_.NumElementsAdded()
             << " total features.";
 
   // Train the GMM using the training feaures.
-  const Eigen::MatrixXf feature_table =
-      ConvertVectorOfFeaturesToMatrix(sampled_features);
-  return gmm_->Compute(feature_table);
+  GaussianMixtureModel::Options gmm_options;
+  gmm_options.num_components = options_.num_gmm_clusters;
+  gmm_options.num_threads = options_.num_threads;
+  if (!gmm_.Fit(gmm_options,
+                training_features_.leftCols(num_training_features_))) {
+    return false;
+  }
+  PrepareEncoding();
+  return true;
+}
+
+void FisherVectorExtractor::PrepareEncoding() {
+  const Eigen::MatrixXf& means = gmm_.Means();
+  const Eigen::MatrixXf& variances = gmm_.Variances();
+  static const double kLogTwoPi = std::log(2.0 * M_PI);
+  linear_coefficients_ = means.cwiseQuotient(variances).transpose();
+  quadratic_coefficients_ = (-0.5f * variances.cwiseInverse()).transpose();
+  inverse_standard_deviations_ = variances.cwiseSqrt().cwiseInverse();
+  log_density_constants_.resize(gmm_.NumComponents());
+  for (int k = 0; k < gmm_.NumComponents(); k++) {
+    if (gmm_.Priors()(k) < kMinPrior) {
+      log_density_constants_(k) = -std::numeric_limits<float>::infinity();
+      continue;
+    }
+    log_density_constants_(k) = static_cast<float>(
+        std::log(static_cast<double>(gmm_.Priors()(k))) -
+        0.5 * (variances.col(k).cast<double>().array().log().sum() +
+               gmm_.Dimension() * kLogTwoPi +
+               means.col(k)
+                   .cast<double>()
+                   .cwiseAbs2()
+                   .cwiseQuotient(variances.col(k).cast<double>())
+                   .sum()));
+  }
+}
+
+Eigen::VectorXf FisherVectorExtractor::Encode(
+    const Eigen::Ref<const Eigen::MatrixXf>& features,
+    EncodingBuffers* buffers) const {
+  const int dimension = gmm_.Dimension();
+  const int num_components = gmm_.NumComponents();
+  const int num_features = features.cols();
+  CHECK_EQ(features.rows(), dimension);
+  const int max_num_components =
+      options_.max_num_components_per_feature > 0
+          ? std::min(options_.max_num_components_per_feature, num_components)
+          : num_components;
+
+  // The log densities of all components at all features.
+  Eigen::MatrixXf& log_densities = buffers->log_densities;
+  log_densities.noalias() = linear_coefficients_ * features;
+  log_densities.noalias() += quadratic_coefficients_ * features.cwiseAbs2();
+  log_densities.colwise() += log_density_constants_;
+
+  // The deviations of the features from the means and variances of the
+  // components, weighted by the posteriors.
+  Eigen::MatrixXf& mean_deviations = buffers->mean_deviations;
+  Eigen::MatrixXf& variance_deviations = buffers->variance_deviations;
+  Eigen::VectorXf& normalized_difference = buffers->normalized_difference;
+  std::vector<int>& components = buffers->components;
+  mean_deviations.setZero(dimension, num_components);
+  variance_deviations.setZero(dimension, num_components);
+  components.resize(num_components);
+  for (int i = 0; i < num_features; i++) {
+    const auto log_density = log_densities.col(i);
+    for (int k = 0; k < num_components; k++) {
+      components[k] = k;
+    }
+    if (max_num_components < num_components) {
+      std::partial_sort(components.begin(),
+                        components.begin() + max_num_components,
+                        components.end(),
+                        [&](const int k1, const int k2) {
+                          return log_density(k1) > log_density(k2);
+                        });
+    }
+
+    // The posteriors of the retained components, normalized with the
+    // log-sum-exp trick.
+    float max_log_density = -std::numeric_limits<float>::infinity();
+    for (int j = 0; j < max_num_components; j++) {
+      max_log_density = std::max(max_log_density, log_density(components[j]));
+    }
+    if (!std::isfinite(max_log_density)) {
+      continue;
+    }
+    float sum = 0.0f;
+    for (int j = 0; j < max_num_components; j++) {
+      sum += std::exp(log_density(components[j]) - max_log_density);
+    }
+
+    for (int j = 0; j < max_num_components; j++) {
+      const int k = components[j];
+      const float posterior =
+          std::exp(log_density(k) - max_log_density) / sum;
+      if (posterior < kMinPosterior) {
+        continue;
+      }
+      normalized_difference =
+          (features.col(i) - gmm_.Means().col(k))
+              .cwiseProduct(inverse_standard_deviations_.col(k));
+      mean_deviations.col(k) += posterior * normalized_difference;
+      variance_deviations.col(k).array() +=
+          posterior * (normalized_difference.array().square() - 1.0f);
+    }
+  }
+
+  // The Fisher vector is the concatenation of the normalized mean deviations
+  // and variance deviations of all components. The improved Fisher vector
+  // takes the signed square root of each entry and is L2 normalized.
+  Eigen::VectorXf fisher_vector(2 * dimension * num_components);
+  Eigen::Map<Eigen::MatrixXf> mean_part(
+      fisher_vector.data(), dimension, num_components);
+  Eigen::Map<Eigen::MatrixXf> variance_part(
+      fisher_vector.data() + dimension * num_components,
+      dimension,
+      num_components);
+  for (int k = 0; k < num_components; k++) {
+    const float prior = gmm_.Priors()(k);
+    if (prior < kMinPrior || num_features == 0) {
+      mean_part.col(k).setZero();
+      variance_part.col(k).setZero();
+      continue;
+    }
+    mean_part.col(k) =
+        mean_deviations.col(k) / (num_features * std::sqrt(prior));
+    variance_part.col(k) =
+        variance_deviations.col(k) / (num_features * std::sqrt(2.0f * prior));
+  }
+  fisher_vector = fisher_vector.cwiseSign().cwiseProduct(
+      fisher_vector.cwiseAbs().cwiseSqrt());
+  fisher_vector /= std::max(fisher_vector.norm(), 1e-12f);
+  return fisher_vector;
 }
 
 Eigen::VectorXf FisherVectorExtractor::ExtractGlobalDescriptor(
@@ -129,26 +261,78 @@ Eigen::VectorXf FisherVectorExtractor::ExtractGlobalDescriptor(
   // Ensure there are input features and they are not zero dimensions.
   CHECK_GT(features.size(), 0);
   CHECK_GT(features[0].size(), 0);
+  CHECK(gmm_.IsFitted()) << "The GMM must be trained or read from disk first.";
 
   // Convert the features into a continuous memory block. The matrix is of size
   // D x N where D is the number of descrip
   const Eigen::MatrixXf feature_table =
       ConvertVectorOfFeaturesToMatrix(features);
-  // Compute the fisher vector encoding.
-  Eigen::VectorXf fisher_vector(2 * feature_table.rows() *
-                                gmm_->num_clusters());
-  vl_fisher_encode(fisher_vector.data(),
-                   VL_TYPE_FLOAT,
-                   gmm_->GetMeans(),
-                   feature_table.rows(),
-                   gmm_->num_clusters(),
-                   gmm_->GetCovariances(),
-                   gmm_->GetPriors(),
-                   feature_table.data(),
-                   feature_table.cols(),
-                   VL_FISHER_FLAG_IMPROVED);
-  DCHECK(std::isfinite(fisher_vector.sum()));
-  return fisher_vector;
+  EncodingBuffers buffers;
+  return Encode(feature_table, &buffers);
+}
+
+void FisherVectorExtractor::ExtractGlobalDescriptors(
+    const std::vector<std::shared_ptr<const KeypointsAndDescriptors> >&
+        features,
+    std::vector<Eigen::VectorXf>* global_descriptors) {
+  CHECK(gmm_.IsFitted()) << "The GMM must be trained or read from disk first.";
+  EncodingBuffers buffers;
+  global_descriptors->resize(features.size());
+  for (int i = 0; i < features.size(); i++) {
+    // The row-major descriptor matrix holds one descriptor per column of its
+    // column-major transpose, which is encoded in place.
+    const DescriptorMatrix& descriptors =
+        features[i]->FloatDescriptors(&buffers.dequantized_descriptors);
+    CHECK_GT(descriptors.rows(), 0);
+    (*global_descriptors)[i] = Encode(
+        Eigen::Map<const Eigen::MatrixXf>(
+            descriptors.data(), descriptors.cols(), descriptors.rows()),
+        &buffers);
+  }
+}
+
+bool FisherVectorExtractor::ReadFromDisk(const std::string& input_filepath) {
+  std::ifstream input_reader(input_filepath, std::ios::in | std::ios::binary);
+  if (!input_reader.is_open()) {
+    LOG(ERROR) << "Could not open the file: " << input_filepath
+               << " for reading.";
+    return false;
+  }
+
+  {
+    cereal::PortableBinaryInputArchive input_archive(input_reader);
+    input_archive(gmm_);
+  }
+
+  if (!gmm_.IsFitted() || gmm_.Means().cols() != gmm_.NumComponents() ||
+      gmm_.Variances().rows() != gmm_.Dimension() ||
+      gmm_.Variances().cols() != gmm_.NumComponents()) {
+    LOG(ERROR) << "The GMM in " << input_filepath << " is corrupted.";
+    return false;
+  }
+  if (gmm_.NumComponents() != options_.num_gmm_clusters) {
+    LOG(WARNING) << "The GMM read from " << input_filepath << " has "
+                 << gmm_.NumComponents() << " components but "
+                 << options_.num_gmm_clusters << " were requested.";
+  }
+  PrepareEncoding();
+  return true;
+}
+
+bool FisherVectorExtractor::WriteToDisk(
+    const std::string& output_filepath) const {
+  CHECK(gmm_.IsFitted()) << "Only a trained GMM can be written to disk.";
+  std::ofstream output_writer(output_filepath,
+                              std::ios::out | std::ios::binary);
+  if (!output_writer.is_open()) {
+    LOG(ERROR) << "Could not open the file: " << output_filepath
+               << " for writing.";
+    return false;
+  }
+
+  cereal::PortableBinaryOutputArchive output_archive(output_writer);
+  output_archive(gmm_);
+  return true;
 }
 
 }  // namespace theia
@@ -37,9 +37,11 @@
 
 #include <Eigen/Core>
 #include <memory>
+#include <string>
 #include <vector>
 
 #include "theia/matching/global_descriptor_extractor.h"
+#include "theia/math/gaussian_mixture_model.h"
 #include "theia/math/reservoir_sampler.h"
 
 namespace theia {
@@ -61,12 +63,22 @@ class FisherVectorExtractor : public GlobalDescriptorExtractor {
     // max_num_features_for_training using a memory efficient Reservoir sampler
     // to avoid holding all features in memory.
     int max_num_features_for_training = 100000;
+
+    // Number of threads used to fit the GMM.
+    int num_threads = 1;
+
+    // Each feature only contributes to the Fisher vector through the
+    // components with the largest posteriors, at most this many. The
+    // posteriors of high dimensional features are concentrated on very few
+    // components, so the others are negligible. If this is not positive all
+    // components are used, which matches VLFeat's encoding.
+    int max_num_components_per_feature = 4;
   };
 
   // The number of clusters to use for the GMM.
   FisherVectorExtractor(const Options& options);
 
-  ~FisherVectorExtractor();
+  ~FisherVectorExtractor() {}
 
   // Add features to the descriptor extractor for training. This method may be
   // called multiple times to add multiple sets of features (e.g., once per
@@ -83,15 +95,53 @@ class FisherVectorExtractor : public GlobalDescriptorExtractor {
   Eigen::VectorXf ExtractGlobalDescriptor(
       const std::vector<Eigen::VectorXf>& features) override;
 
+  // Computes the Fisher vectors of a batch of images directly from their
+  // descriptor matrices, reusing the encoding buffers across the images.
+  void ExtractGlobalDescriptors(
+      const std::vector<std::shared_ptr<const KeypointsAndDescriptors> >&
+          features,
+      std::vector<Eigen::VectorXf>* global_descriptors) override;
+
+  // The trained GMM may be written to disk and read back instead of training,
+  // e.g. to reuse the model of a large training set across reconstructions.
+  bool ReadFromDisk(const std::string& input_filepath);
+  bool WriteToDisk(const std::string& output_filepath) const;
+
  private:
+  struct EncodingBuffers;
+
+  // Precomputes the GMM parameters in the layout used by Encode. This must be
+  // called whenever the GMM changes.
+  void PrepareEncoding();
+
+  // Computes the improved Fisher vector (Perronnin et al., ECCV 2010) of the
+  // features, which are the columns of the matrix.
+  Eigen::VectorXf Encode(const Eigen::Ref<const Eigen::MatrixXf>& features,
+                         EncodingBuffers* buffers) const;
+
+  const Options options_;
+
   // A Gaussian Mixture Model is used to compute the Fisher Kernel.
-  class GaussianMixtureModel;
-  std::unique_ptr<GaussianMixtureModel> gmm_;
+  GaussianMixtureModel gmm_;
+
+  // The log density of component k at x is
+  //   log_density_constants_(k) + linear_coefficients_.row(k) * x +
+  //   quadratic_coefficients_.row(k) * x^2,
+  // so the densities of all features are two matrix products. The components
+  // are the rows so that the densities of a feature are contiguous.
+  Eigen::MatrixXf linear_coefficients_;
+  Eigen::MatrixXf quadratic_coefficients_;
+  Eigen::VectorXf log_density_constants_;
+  Eigen::MatrixXf inverse_standard_deviations_;
 
   // The GMM is trained from a set of feature descriptors. A reservoir sampler
   // is used to randomly sample features from an unknown number of input
-  // features for training.
-  ReservoirSampler<Eigen::VectorXf> training_feature_sampler_;
+  // features for training. The samples are the columns of a matrix, which
+  // grows as features are added up to max_num_features_for_training columns,
+  // so that training does not copy them.
+  ReservoirSampler<int> training_feature_sampler_;
+  Eigen::MatrixXf training_features_;
+  int num_training_features_;
 };
 
 }  // namespace theia
@@ -0,0 +1,200 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+
+extern "C" {
+#include <vlfeat/vl/fisher.h>
+}
+
+#include <Eigen/Core>
+#include <cereal/archives/portable_binary.hpp>
+
+#include <fstream>  // NOLINT
+#include <memory>
+#include <string>
+#include <vector>
+#include "gtest/gtest.h"
+
+#include "theia/matching/fisher_vector_extractor.h"
+#include "theia/matching/keypoints_and_descriptors.h"
+#include "theia/util/random.h"
+
+namespace theia {
+
+namespace {
+
+static const int kDimension = 16;
+static const int kNumClusters = 4;
+
+// Returns features drawn around kNumClusters random centers.
+std::vector<Eigen::VectorXf> SampleFeatures(const int num_features,
+                                            RandomNumberGenerator* rng) {
+  std::vector<Eigen::VectorXf> centers(kNumClusters);
+  RandomNumberGenerator center_rng(71, 0);
+  for (Eigen::VectorXf& center : centers) {
+    center.resize(kDimension);
+    for (int i = 0; i < kDimension; i++) {
+      center(i) = center_rng.RandDouble(-2.0, 2.0);
+    }
+  }
+
+  std::vector<Eigen::VectorXf> features(num_features);
+  for (int i = 0; i < num_features; i++) {
+    features[i] = centers[rng->RandInt(0, kNumClusters - 1)];
+    for (int j = 0; j < kDimension; j++) {
+      features[i](j) += rng->RandGaussian(0.0, 0.5);
+    }
+  }
+  return features;
+}
+
+FisherVectorExtractor::Options ExtractorOptions() {
+  FisherVectorExtractor::Options options;
+  options.num_gmm_clusters = kNumClusters;
+  options.max_num_features_for_training = 2000;
+  return options;
+}
+
+}  // namespace
+
+TEST(FisherVectorExtractor, MatchesVLFeatEncoding) {
+  RandomNumberGenerator rng(72, 0);
+  FisherVectorExtractor::Options options = ExtractorOptions();
+  options.max_num_components_per_feature = 0;
+  FisherVectorExtractor extractor(options);
+  extractor.AddFeaturesForTraining(SampleFeatures(5000, &rng));
+  ASSERT_TRUE(extractor.Train());
+  const std::string gmm_filepath =
+      testing::internal::TempDir() + "fisher_vector_extractor_test.bin";
+  ASSERT_TRUE(extractor.WriteToDisk(gmm_filepath));
+
+  // Read the parameters of the GMM back to encode with VLFeat.
+  FisherVectorExtractor reloaded_extractor(options);
+  ASSERT_TRUE(reloaded_extractor.ReadFromDisk(gmm_filepath));
+
+  const std::vector<Eigen::VectorXf> features = SampleFeatures(300, &rng);
+  const Eigen::VectorXf fisher_vector =
+      extractor.ExtractGlobalDescriptor(features);
+  ASSERT_EQ(fisher_vector.size(), 2 * kDimension * kNumClusters);
+  EXPECT_NEAR(fisher_vector.norm(), 1.0, 1e-5);
+  EXPECT_LT((reloaded_extractor.ExtractGlobalDescriptor(features) -
+             fisher_vector).norm(),
+            1e-6);
+
+  GaussianMixtureModel gmm;
+  {
+    std::ifstream input_reader(gmm_filepath, std::ios::binary);
+    cereal::PortableBinaryInputArchive input_archive(input_reader);
+    input_archive(gmm);
+  }
+  Eigen::MatrixXf feature_table(kDimension, features.size());
+  for (int i = 0; i < features.size(); i++) {
+    feature_table.col(i) = features[i];
+  }
+  Eigen::VectorXf expected_fisher_vector(fisher_vector.size());
+  vl_fisher_encode(expected_fisher_vector.data(),
+                   VL_TYPE_FLOAT,
+                   gmm.Means().data(),
+                   kDimension,
+                   kNumClusters,
+                   gmm.Variances().data(),
+                   gmm.Priors().data(),
+                   feature_table.data(),
+                   feature_table.cols(),
+                   VL_FISHER_FLAG_IMPROVED);
+  EXPECT_LT((fisher_vector - expected_fisher_vector).norm(), 1e-4);
+}
+
+TEST(FisherVectorExtractor, PrunedPosteriorsAreClose) {
+  RandomNumberGenerator rng(73, 0);
+  FisherVectorExtractor::Options options = ExtractorOptions();
+  FisherVectorExtractor extractor(options);
+  extractor.AddFeaturesForTraining(SampleFeatures(5000, &rng));
+  ASSERT_TRUE(extractor.Train());
+  const std::string gmm_filepath =
+      testing::internal::TempDir() + "fisher_vector_extractor_test.bin";
+  ASSERT_TRUE(extractor.WriteToDisk(gmm_filepath));
+
+  options.max_num_components_per_feature = 0;
+  FisherVectorExtractor dense_extractor(options);
+  ASSERT_TRUE(dense_extractor.ReadFromDisk(gmm_filepath));
+  options.max_num_components_per_feature = 1;
+  FisherVectorExtractor hard_extractor(options);
+  ASSERT_TRUE(hard_extractor.ReadFromDisk(gmm_filepath));
+
+  const std::vector<Eigen::VectorXf> features = SampleFeatures(300, &rng);
+  const Eigen::VectorXf dense_fisher_vector =
+      dense_extractor.ExtractGlobalDescriptor(features);
+  EXPECT_LT((extractor.ExtractGlobalDescriptor(features) -
+             dense_fisher_vector).norm(),
+            1e-3);
+  EXPECT_GT(hard_extractor.ExtractGlobalDescriptor(features).dot(
+                dense_fisher_vector),
+            0.9);
+}
+
+TEST(FisherVectorExtractor, BatchedExtraction) {
+  RandomNumberGenerator rng(74, 0);
+  FisherVectorExtractor extractor(ExtractorOptions());
+  extractor.AddFeaturesForTraining(SampleFeatures(3000, &rng));
+  ASSERT_TRUE(extractor.Train());
+
+  std::vector<std::shared_ptr<const KeypointsAndDescriptors> > images;
+  std::vector<std::vector<Eigen::VectorXf> > features_of_images;
+  for (int i = 0; i < 3; i++) {
+    features_of_images.emplace_back(SampleFeatures(100 + 50 * i, &rng));
+    std::shared_ptr<KeypointsAndDescriptors> image =
+        std::make_shared<KeypointsAndDescriptors>();
+    image->SetDescriptors(features_of_images.back());
+    // Quantized descriptors are dequantized before they are encoded.
+    if (i == 2) {
+      image->descriptor_matrix = image->descriptor_matrix.cwiseAbs();
+      image->QuantizeDescriptors(64.0f);
+      features_of_images.back() = image->GetDescriptors();
+    }
+    images.emplace_back(image);
+  }
+
+  std::vector<Eigen::VectorXf> fisher_vectors;
+  extractor.ExtractGlobalDescriptors(images, &fisher_vectors);
+  ASSERT_EQ(fisher_vectors.size(), images.size());
+  for (int i = 0; i < images.size(); i++) {
+    EXPECT_LT((fisher_vectors[i] -
+               extractor.ExtractGlobalDescriptor(features_of_images[i]))
+                  .norm(),
+              1e-5);
+  }
+}
+
+}  // namespace theia
@@ -0,0 +1,86 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#ifndef THEIA_MATCHING_FLANN_SIMD_L2_H_
+#define THEIA_MATCHING_FLANN_SIMD_L2_H_
+
+#include <type_traits>
+
+#include "flann/flann.hpp"
+
+#include "theia/matching/distance.h"
+
+namespace theia {
+
+// A FLANN distance functor that evaluates leaf distances with the runtime
+// dispatched SIMD kernels from distance.h. The bounding box distances used to
+// traverse the KD-tree are unchanged.
+struct FlannSimdL2 : public flann::L2<float> {
+  template <typename Iterator1, typename Iterator2>
+  ResultType operator()(Iterator1 a,
+                        Iterator2 b,
+                        size_t size,
+                        ResultType worst_dist = -1) const {
+    // Only contiguous float data may use the SIMD kernels. Other element types
+    // (e.g. cluster centers of other index types) use the FLANN implementation.
+    typedef std::integral_constant<
+        bool,
+        std::is_convertible<Iterator1, const float*>::value &&
+            std::is_convertible<Iterator2, const float*>::value>
+        IsFloatPointer;
+    return Evaluate(a, b, size, worst_dist, IsFloatPointer());
+  }
+
+ private:
+  ResultType Evaluate(const float* a,
+                      const float* b,
+                      size_t size,
+                      ResultType /* worst_dist */,
+                      std::true_type) const {
+    return SquaredL2Distance(a, b, static_cast<int>(size));
+  }
+
+  template <typename Iterator1, typename Iterator2>
+  ResultType Evaluate(Iterator1 a,
+                      Iterator2 b,
+                      size_t size,
+                      ResultType worst_dist,
+                      std::false_type) const {
+    return flann::L2<float>::operator()(a, b, size, worst_dist);
+  }
+};
+
+}  // namespace theia
+
+#endif  // THEIA_MATCHING_FLANN_SIMD_L2_H_
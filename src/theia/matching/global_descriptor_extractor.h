@@ -36,10 +36,20 @@
 #define THEIA_MATCHING_GLOBAL_DESCRIPTOR_EXTRACTOR_H_
 
 #include <Eigen/Core>
+#include <memory>
 #include <vector>
 
+#include "theia/matching/keypoints_and_descriptors.h"
+
 namespace theia {
 
+// The types of global descriptor extractors available for selecting image
+// pairs to match.
+enum class GlobalDescriptorExtractorType {
+  FISHER_VECTOR = 0,
+  VOCABULARY_TREE = 1,
+};
+
 // Global descriptors provide a summary of an entire image into a single feature
 // descriptor. These descriptors may be formed using training data (e.g., SIFT
 // features) or may be directly computed from the image itself. Global
@@ -63,6 +73,21 @@ class GlobalDescriptorExtractor {
   // Compute a global image descriptor for the set of input features.
   virtual Eigen::VectorXf ExtractGlobalDescriptor(
       const std::vector<Eigen::VectorXf>& features) = 0;
+
+  // Computes the global descriptors of a batch of images. Extractors may
+  // override this to read the descriptor matrices without copying them and to
+  // reuse their buffers across the images. The default implementation calls
+  // ExtractGlobalDescriptor for each image.
+  virtual void ExtractGlobalDescriptors(
+      const std::vector<std::shared_ptr<const KeypointsAndDescriptors> >&
+          features,
+      std::vector<Eigen::VectorXf>* global_descriptors) {
+    global_descriptors->resize(features.size());
+    for (int i = 0; i < features.size(); i++) {
+      (*global_descriptors)[i] =
+          ExtractGlobalDescriptor(features[i]->GetDescriptors());
+    }
+  }
 };
 
 }  // namespace theia
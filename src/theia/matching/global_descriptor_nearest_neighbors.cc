@@ -0,0 +1,136 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+
+#include "theia/matching/global_descriptor_nearest_neighbors.h"
+
+#include <Eigen/Core>
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include "theia/util/executor.h"
+
+namespace theia {
+
+namespace {
+
+// The number of descriptors in a block. The distances of a block pair take
+// kBlockSize^2 floats, which stay in cache while the neighbors are updated.
+static const int kBlockSize = 512;
+
+}  // namespace
+
+void FindNearestNeighborsOfGlobalDescriptors(
+    const Eigen::MatrixXf& descriptors,
+    const int num_nearest_neighbors,
+    const int num_threads,
+    std::vector<std::vector<int> >* nearest_neighbors) {
+  CHECK_NOTNULL(nearest_neighbors);
+  CHECK_GE(num_nearest_neighbors, 0);
+  const int num_descriptors = descriptors.cols();
+  const int k = std::min(num_nearest_neighbors, num_descriptors - 1);
+  nearest_neighbors->clear();
+  nearest_neighbors->resize(num_descriptors);
+  if (k <= 0) {
+    return;
+  }
+
+  const Eigen::RowVectorXf squared_norms =
+      descriptors.colwise().squaredNorm();
+  const int num_blocks = (num_descriptors + kBlockSize - 1) / kBlockSize;
+  ParallelFor(num_threads, num_blocks, [&](const int start, const int end) {
+    Eigen::MatrixXf distances;
+    // A max-heap of the (distance, index) of the k nearest neighbors found so
+    // far for each query of the block.
+    std::vector<std::vector<std::pair<float, int> > > heaps;
+    for (int query_block = start; query_block < end; query_block++) {
+      const int first_query = query_block * kBlockSize;
+      const int num_queries =
+          std::min(kBlockSize, num_descriptors - first_query);
+      heaps.assign(num_queries, std::vector<std::pair<float, int> >());
+      for (auto& heap : heaps) {
+        heap.reserve(k);
+      }
+
+      for (int first_neighbor = 0; first_neighbor < num_descriptors;
+           first_neighbor += kBlockSize) {
+        const int num_neighbors =
+            std::min(kBlockSize, num_descriptors - first_neighbor);
+        // distances(j, i) is the distance between neighbor j and query i, so
+        // that the distances of a query are contiguous.
+        distances.noalias() =
+            -2.0f * descriptors.middleCols(first_neighbor, num_neighbors)
+                        .transpose() *
+            descriptors.middleCols(first_query, num_queries);
+        distances.colwise() +=
+            squared_norms.segment(first_neighbor, num_neighbors).transpose();
+        distances.rowwise() += squared_norms.segment(first_query, num_queries);
+
+        for (int i = 0; i < num_queries; i++) {
+          std::vector<std::pair<float, int> >& heap = heaps[i];
+          const int query = first_query + i;
+          for (int j = 0; j < num_neighbors; j++) {
+            const int neighbor = first_neighbor + j;
+            if (neighbor == query) {
+              continue;
+            }
+            const std::pair<float, int> candidate(distances(j, i), neighbor);
+            if (heap.size() < k) {
+              heap.emplace_back(candidate);
+              std::push_heap(heap.begin(), heap.end());
+            } else if (candidate < heap.front()) {
+              std::pop_heap(heap.begin(), heap.end());
+              heap.back() = candidate;
+              std::push_heap(heap.begin(), heap.end());
+            }
+          }
+        }
+      }
+
+      for (int i = 0; i < num_queries; i++) {
+        std::sort_heap(heaps[i].begin(), heaps[i].end());
+        std::vector<int>& neighbors = (*nearest_neighbors)[first_query + i];
+        neighbors.reserve(k);
+        for (const auto& neighbor : heaps[i]) {
+          neighbors.emplace_back(neighbor.second);
+        }
+      }
+    }
+  });
+}
+
+}  // namespace theia
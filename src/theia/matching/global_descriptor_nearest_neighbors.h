@@ -0,0 +1,60 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+
+#ifndef THEIA_MATCHING_GLOBAL_DESCRIPTOR_NEAREST_NEIGHBORS_H_
+#define THEIA_MATCHING_GLOBAL_DESCRIPTOR_NEAREST_NEIGHBORS_H_
+
+#include <Eigen/Core>
+#include <vector>
+
+namespace theia {
+
+// Finds the num_nearest_neighbors nearest neighbors of each global image
+// descriptor among all other descriptors, in squared Euclidean distance. The
+// descriptors are the columns of the matrix. The search is exhaustive, but the
+// distances between a block of query descriptors and a block of database
+// descriptors are computed at once as ||a||^2 + ||b||^2 - 2 a^T b, where the
+// dot products are a single matrix product (GEMM). The blocks of queries are
+// spread over num_threads threads. The neighbors of each descriptor are sorted
+// by increasing distance, and ties are broken by the smaller index.
+void FindNearestNeighborsOfGlobalDescriptors(
+    const Eigen::MatrixXf& descriptors,
+    const int num_nearest_neighbors,
+    const int num_threads,
+    std::vector<std::vector<int> >* nearest_neighbors);
+
+}  // namespace theia
+
+#endif  // THEIA_MATCHING_GLOBAL_DESCRIPTOR_NEAREST_NEIGHBORS_H_
@@ -0,0 +1,114 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+
+#include <Eigen/Core>
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+#include "gtest/gtest.h"
+
+#include "theia/matching/global_descriptor_nearest_neighbors.h"
+
+namespace theia {
+
+namespace {
+
+// Finds the nearest neighbors by comparing all pairs of descriptors.
+std::vector<std::vector<int> > FindNearestNeighborsByBruteForce(
+    const Eigen::MatrixXf& descriptors, const int num_nearest_neighbors) {
+  std::vector<std::vector<int> > nearest_neighbors(descriptors.cols());
+  for (int i = 0; i < descriptors.cols(); i++) {
+    std::vector<std::pair<float, int> > distances;
+    for (int j = 0; j < descriptors.cols(); j++) {
+      if (i != j) {
+        distances.emplace_back(
+            (descriptors.col(i) - descriptors.col(j)).squaredNorm(), j);
+      }
+    }
+    std::sort(distances.begin(), distances.end());
+    for (int j = 0; j < num_nearest_neighbors; j++) {
+      nearest_neighbors[i].emplace_back(distances[j].second);
+    }
+  }
+  return nearest_neighbors;
+}
+
+}  // namespace
+
+TEST(FindNearestNeighborsOfGlobalDescriptors, MatchesBruteForce) {
+  static const int kNumNearestNeighbors = 10;
+  // More descriptors than fit in one block.
+  const Eigen::MatrixXf descriptors = Eigen::MatrixXf::Random(32, 1300);
+  const std::vector<std::vector<int> > expected_nearest_neighbors =
+      FindNearestNeighborsByBruteForce(descriptors, kNumNearestNeighbors);
+
+  for (const int num_threads : {1, 4}) {
+    std::vector<std::vector<int> > nearest_neighbors;
+    FindNearestNeighborsOfGlobalDescriptors(
+        descriptors, kNumNearestNeighbors, num_threads, &nearest_neighbors);
+    ASSERT_EQ(nearest_neighbors.size(), descriptors.cols());
+    int num_equal_neighbors = 0;
+    for (int i = 0; i < descriptors.cols(); i++) {
+      ASSERT_EQ(nearest_neighbors[i].size(), kNumNearestNeighbors);
+      // The distances are computed differently, so neighbors with almost the
+      // same distance may be swapped.
+      num_equal_neighbors += std::equal(nearest_neighbors[i].begin(),
+                                        nearest_neighbors[i].end(),
+                                        expected_nearest_neighbors[i].begin());
+      EXPECT_EQ(nearest_neighbors[i][0], expected_nearest_neighbors[i][0]);
+    }
+    EXPECT_GT(num_equal_neighbors, 0.99 * descriptors.cols());
+  }
+}
+
+TEST(FindNearestNeighborsOfGlobalDescriptors, FewDescriptors) {
+  Eigen::MatrixXf descriptors(1, 3);
+  descriptors << 0.0f, 1.0f, 3.0f;
+  std::vector<std::vector<int> > nearest_neighbors;
+  FindNearestNeighborsOfGlobalDescriptors(
+      descriptors, 5, 1, &nearest_neighbors);
+  ASSERT_EQ(nearest_neighbors.size(), 3);
+  EXPECT_EQ(nearest_neighbors[0], std::vector<int>({1, 2}));
+  EXPECT_EQ(nearest_neighbors[1], std::vector<int>({0, 2}));
+  EXPECT_EQ(nearest_neighbors[2], std::vector<int>({1, 0}));
+
+  FindNearestNeighborsOfGlobalDescriptors(
+      Eigen::MatrixXf::Random(4, 1), 5, 1, &nearest_neighbors);
+  ASSERT_EQ(nearest_neighbors.size(), 1);
+  EXPECT_TRUE(nearest_neighbors[0].empty());
+}
+
+}  // namespace theia
@@ -36,20 +36,19 @@
 
 #include <Eigen/Core>
 #include <algorithm>
-#include <limits>
+#include <cmath>
 #include <stdint.h>
-#include <unordered_map>
 #include <unordered_set>
 #include <vector>
 
 #include "flann/flann.hpp"
 
 #include "theia/matching/distance.h"
+#include "theia/matching/flann_simd_l2.h"
 #include "theia/matching/indexed_feature_match.h"
 #include "theia/matching/keypoints_and_descriptors.h"
 #include "theia/sfm/camera/camera.h"
 #include "theia/sfm/pose/fundamental_matrix_util.h"
-#include "theia/util/hash.h"
 #include "theia/util/map_util.h"
 #include "theia/util/random.h"
 
@@ -105,40 +104,40 @@ bool GuidedEpipolarMatcher::Initialize(
     matched_features2_.insert(match.feature2_ind);
   }
 
-  const double half_cell_width = options_.guided_matching_max_distance_pixels;
-  const double offset = half_cell_width;
-  image_grids_.emplace_back(ImageGrid(half_cell_width, 0, 0));
-  image_grids_.emplace_back(ImageGrid(half_cell_width, offset, 0));
-  image_grids_.emplace_back(ImageGrid(half_cell_width, 0, offset));
-  image_grids_.emplace_back(ImageGrid(half_cell_width, offset, offset));
-
-  // These helper vectors will be used to find the bounding box of the
-  // features. This will help constrain the search along epipolar lines later.
-  std::vector<double> x, y;
-  x.reserve(features2_.keypoints.size());
-  y.reserve(features2_.keypoints.size());
-  // For each grid, add all features from features2.
+  // Gather the unmatched features of image 2 and find their bounding box. This
+  // will help constrain the search along epipolar lines later.
+  std::vector<int> feature_indices;
+  std::vector<Eigen::Vector2d> positions;
+  feature_indices.reserve(features2_.keypoints.size());
+  positions.reserve(features2_.keypoints.size());
   for (int i = 0; i < features2_.keypoints.size(); i++) {
     // TODO(csweeney): Test if the epipolar line of feature2 features is within
     // the image bounds of image 1. If not, we can skip the feature entirely.
     if (ContainsKey(matched_features2_, i)) {
       continue;
     }
-    for (int j = 0; j < image_grids_.size(); j++) {
-      image_grids_[j].AddFeature(
-          i, features2_.keypoints[i].x(), features2_.keypoints[i].y());
-    }
-    x.emplace_back(features2_.keypoints[i].x());
-    y.emplace_back(features2_.keypoints[i].y());
+    feature_indices.emplace_back(i);
+    positions.emplace_back(features2_.keypoints[i].x(),
+                           features2_.keypoints[i].y());
+  }
+  if (feature_indices.empty()) {
+    return false;
+  }
+
+  top_left_ = positions[0];
+  bottom_right_ = positions[0];
+  for (const Eigen::Vector2d& position : positions) {
+    top_left_ = top_left_.cwiseMin(position);
+    bottom_right_ = bottom_right_.cwiseMax(position);
   }
 
-  // Set the bounding box of the features.
-  const auto& minmax_x = std::minmax_element(x.begin(), x.end());
-  const auto& minmax_y = std::minmax_element(y.begin(), y.end());
-  top_left_.x() = *minmax_x.first;
-  top_left_.y() = *minmax_y.first;
-  bottom_right_.x() = *minmax_x.second;
-  bottom_right_.y() = *minmax_y.second;
+  // Size the cells so that there is roughly one feature per cell on average,
+  // but never make them smaller than the epipolar band.
+  const Eigen::Vector2d extent = bottom_right_ - top_left_;
+  const double cell_size = std::max(
+      2.0 * options_.guided_matching_max_distance_pixels,
+      std::sqrt(extent.x() * extent.y() / feature_indices.size()));
+  feature_grid_.reset(new FeatureGrid(feature_indices, positions, cell_size));
 
   return true;
 }
@@ -148,7 +147,10 @@ bool GuidedEpipolarMatcher::GetMatches(
   const int num_input_matches = matches->size();
   const double lowes_ratio_sq = options_.lowes_ratio * options_.lowes_ratio;
 
-  Initialize(*matches);
+  // If all features are already matched there is nothing left to match.
+  if (!Initialize(*matches)) {
+    return true;
+  }
 
   // Group all epipolar lines.
   std::vector<EpilineGroup> epiline_groups;
@@ -248,10 +250,13 @@ void GuidedEpipolarMatcher::GroupEpipolarLines(
     std::vector<Eigen::Vector2d> line_endpoints;
     DecodeLineEndpoints(sorted_endpoints[i].first, &line_endpoints);
 
-    // See if an epipolar endpoint exists nearby. If it does not, then add a new
-    // endpoint group.
-    if (i == 0 || (epiline_groups->back().endpoints[0] - line_endpoints[0])
-                          .squaredNorm() > sq_max_distance_pixels) {
+    // See if the epipolar endpoints of the current group are nearby. If they are
+    // not, then add a new endpoint group.
+    if (i == 0 ||
+        (epiline_groups->back().endpoints[0] - line_endpoints[0])
+                .squaredNorm() > sq_max_distance_pixels ||
+        (epiline_groups->back().endpoints[1] - line_endpoints[1])
+                .squaredNorm() > sq_max_distance_pixels) {
       // Create a new epiline group.
       EpilineGroup epiline_group;
       epiline_group.endpoints = line_endpoints;
@@ -271,6 +276,41 @@ void GuidedEpipolarMatcher::GroupEpipolarLines(
         (1.0 - weight_of_current_match) * epiline_groups->back().endpoints[1] +
         weight_of_current_match * line_endpoints[1];
   }
+
+  // The band of each group must contain the bands of all of its features. The
+  // distance of a feature's epiline to the group epiline is largest at one of
+  // the endpoints since both are clipped to the same bounding box.
+  int group_index = -1;
+  int num_features_in_group = 0;
+  for (int i = 0; i < sorted_endpoints.size(); i++) {
+    if (num_features_in_group == 0) {
+      ++group_index;
+      num_features_in_group = (*epiline_groups)[group_index].features.size();
+      (*epiline_groups)[group_index].max_distance =
+          options_.guided_matching_max_distance_pixels;
+    }
+    --num_features_in_group;
+
+    EpilineGroup& epiline_group = (*epiline_groups)[group_index];
+    const Eigen::Vector3d group_line =
+        epiline_group.endpoints[0].homogeneous().cross(
+            epiline_group.endpoints[1].homogeneous());
+    const double group_line_norm = group_line.head<2>().norm();
+    if (group_line_norm == 0.0) {
+      continue;
+    }
+
+    std::vector<Eigen::Vector2d> line_endpoints;
+    DecodeLineEndpoints(sorted_endpoints[i].first, &line_endpoints);
+    for (const Eigen::Vector2d& line_endpoint : line_endpoints) {
+      const double distance =
+          std::abs(group_line.dot(line_endpoint.homogeneous())) /
+          group_line_norm;
+      epiline_group.max_distance =
+          std::max(epiline_group.max_distance,
+                   distance + options_.guided_matching_max_distance_pixels);
+    }
+  }
 }
 
 void GuidedEpipolarMatcher::FindFeaturesNearEpipolarLines(
@@ -280,41 +320,34 @@ void GuidedEpipolarMatcher::FindFeaturesNearEpipolarLines(
 
   const std::vector<Eigen::Vector2d>& line_endpoints = epiline_group.endpoints;
 
-  // The number of steps required to "walk" between the line endpoints.
-  const int num_steps =
-      static_cast<int>((line_endpoints[1] - line_endpoints[0]).norm() /
-                       options_.guided_matching_max_distance_pixels);
-
-  // Sample the epipolar line equally between the points where it intersects
-  // the features bounding box.
-  std::unordered_set<int> candidate_keypoints;
-  const Eigen::Vector2d line_delta =
-      (line_endpoints[0] - line_endpoints[1]) / static_cast<double>(num_steps);
-  Eigen::Vector2d sample_point = line_endpoints[1];
-
-  for (int i = 0; i < num_steps; i++) {
-    sample_point += line_delta;
-
-    // Find the cell center among all grids that is closest and add the
-    // keypoints belonging to that cell.
-    std::vector<int> new_keypoints;
-    FindClosestCellAndKeypoints(sample_point, &new_keypoints);
-    candidate_keypoints.insert(new_keypoints.begin(), new_keypoints.end());
+  // Find all features in the band around the epipolar line. Lines with
+  // coincident endpoints (e.g., at a corner of the bounding box) have no
+  // direction and only receive random features below.
+  Eigen::Vector3d epipolar_line =
+      line_endpoints[0].homogeneous().cross(line_endpoints[1].homogeneous());
+  const double epipolar_line_norm = epipolar_line.head<2>().norm();
+  if (epipolar_line_norm > 0.0) {
+    epipolar_line /= epipolar_line_norm;
+    feature_grid_->FindFeaturesNearLine(epipolar_line,
+                                        epiline_group.max_distance,
+                                        candidate_keypoint_indices);
   }
 
   // If we do not have enough features then the lowes ratio test is not
   // meaningful. Add some random features here so that lowes ratio is more
   // informative of whether we have a good match or not.
-  if (candidate_keypoints.size() < kMinNumMatchesFound) {
-    const int num_current_keypoints = candidate_keypoints.size();
-    for (int i = num_current_keypoints; i < kMinNumMatchesFound; i++) {
-      candidate_keypoints.insert(
-          rng_->RandInt(0, features2_.keypoints.size() - 1));
+  if (candidate_keypoint_indices->size() < kMinNumMatchesFound) {
+    std::unordered_set<int> candidate_keypoints(
+        candidate_keypoint_indices->begin(), candidate_keypoint_indices->end());
+    for (int i = candidate_keypoint_indices->size(); i < kMinNumMatchesFound;
+         i++) {
+      const int random_keypoint =
+          rng_->RandInt(0, features2_.keypoints.size() - 1);
+      if (candidate_keypoints.insert(random_keypoint).second) {
+        candidate_keypoint_indices->emplace_back(random_keypoint);
+      }
     }
   }
-  candidate_keypoint_indices->insert(candidate_keypoint_indices->end(),
-                                     candidate_keypoints.begin(),
-                                     candidate_keypoints.end());
 }
 
 void GuidedEpipolarMatcher::FindEpipolarLineIntersection(
@@ -361,27 +394,25 @@ void GuidedEpipolarMatcher::FindKNearestNeighbors(
     std::vector<std::vector<int> >* nn_indices) {
   static const int kNumNearestNeighbors = 2;
   static const int kMinNumLeafsVisited = 50;
-  const int num_descriptor_dimensions = features1_.descriptors[0].size();
+  const int num_descriptor_dimensions = features1_.DescriptorDimension();
 
   // Gather the query descriptors.
-  Eigen::Matrix<float, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>
-      query_descriptors(query_feature_indices.size(),
-                        num_descriptor_dimensions);
+  DescriptorMatrix query_descriptors(query_feature_indices.size(),
+                                     num_descriptor_dimensions);
   for (int i = 0; i < query_feature_indices.size(); i++) {
     const int match_index = query_feature_indices[i];
-    query_descriptors.row(i) = features1_.descriptors[match_index];
+    query_descriptors.row(i) = features1_.FloatDescriptor(match_index);
   }
   flann::Matrix<float> flann_query_descriptors(query_descriptors.data(),
                                                query_descriptors.rows(),
                                                query_descriptors.cols());
 
   // Gather the candidate matching descriptors.
-  Eigen::Matrix<float, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>
-      candidate_descriptors(candidate_feature_indices.size(),
-                            num_descriptor_dimensions);
+  DescriptorMatrix candidate_descriptors(candidate_feature_indices.size(),
+                                         num_descriptor_dimensions);
   for (int i = 0; i < candidate_feature_indices.size(); i++) {
     const int match_index = candidate_feature_indices[i];
-    candidate_descriptors.row(i) = features2_.descriptors[match_index];
+    candidate_descriptors.row(i) = features2_.FloatDescriptor(match_index);
   }
 
   // Create the searchable KD-tree with FLANN.
@@ -390,7 +421,7 @@ void GuidedEpipolarMatcher::FindKNearestNeighbors(
       candidate_descriptors.rows(),
       candidate_descriptors.cols());
 
-  flann::Index<flann::L2<float> > flann_kd_tree(
+  flann::Index<FlannSimdL2> flann_kd_tree(
       flann_candidate_descriptors, flann::KDTreeSingleIndexParams());
   flann_kd_tree.buildIndex();
 
@@ -415,58 +446,128 @@ void GuidedEpipolarMatcher::FindKNearestNeighbors(
   }
 }
 
-void GuidedEpipolarMatcher::FindClosestCellAndKeypoints(
-    const Eigen::Vector2d& point, std::vector<int>* new_keypoints) {
-  int min_grid = 0;
-  Eigen::Vector2i min_grid_center;
-  double min_dist = std::numeric_limits<double>::max();
-
-  // Find the grid cell with the closest center.
-  for (int i = 0; i < 4; i++) {
-    Eigen::Vector2i grid_center;
-    image_grids_[i].GetClosestGridCenter(point.x(), point.y(), &grid_center);
-    const double dist = (grid_center.cast<double>() - point).squaredNorm();
-    if (dist < min_dist) {
-      min_grid = i;
-      min_dist = dist;
-      std::swap(min_grid_center, grid_center);
-    }
+GuidedEpipolarMatcher::FeatureGrid::FeatureGrid(
+    const std::vector<int>& feature_indices,
+    const std::vector<Eigen::Vector2d>& positions,
+    const double cell_size)
+    : cell_size_(cell_size) {
+  CHECK_EQ(feature_indices.size(), positions.size());
+  CHECK_GT(cell_size, 0.0);
+  origin_ = positions[0];
+  Eigen::Vector2d max_position = positions[0];
+  for (const Eigen::Vector2d& position : positions) {
+    origin_ = origin_.cwiseMin(position);
+    max_position = max_position.cwiseMax(position);
   }
-
-  // Get the features from the closest grid cell.
-  image_grids_[min_grid].GetFeaturesFromCell(min_grid_center, new_keypoints);
+  num_cols_ =
+      static_cast<int>(std::floor((max_position.x() - origin_.x()) / cell_size)) +
+      1;
+  num_rows_ =
+      static_cast<int>(std::floor((max_position.y() - origin_.y()) / cell_size)) +
+      1;
+
+  BuildLayout(feature_indices, positions, true, &row_major_);
+  BuildLayout(feature_indices, positions, false, &col_major_);
 }
 
-GuidedEpipolarMatcher::ImageGrid::ImageGrid(const double cell_size,
-                                            const double cell_offset_x,
-                                            const double cell_offset_y)
-    : cell_size_(cell_size),
-      cell_offset_x_(cell_offset_x),
-      cell_offset_y_(cell_offset_y) {
-  cells_.reserve(10000);
-}
+void GuidedEpipolarMatcher::FeatureGrid::BuildLayout(
+    const std::vector<int>& feature_indices,
+    const std::vector<Eigen::Vector2d>& positions,
+    const bool row_major,
+    Layout* layout) {
+  // Compute the cell of each feature in the order of the layout.
+  std::vector<int> cells(positions.size());
+  for (int i = 0; i < positions.size(); i++) {
+    const int col = std::min(
+        static_cast<int>((positions[i].x() - origin_.x()) / cell_size_),
+        num_cols_ - 1);
+    const int row = std::min(
+        static_cast<int>((positions[i].y() - origin_.y()) / cell_size_),
+        num_rows_ - 1);
+    cells[i] = row_major ? row * num_cols_ + col : col * num_rows_ + row;
+  }
 
-void GuidedEpipolarMatcher::ImageGrid::AddFeature(const int feature_index,
-                                                  const double x,
-                                                  const double y) {
-  Eigen::Vector2i grid_center;
-  GetClosestGridCenter(x, y, &grid_center);
-  cells_[grid_center].emplace_back(feature_index);
+  // Sort the features by cell with a counting sort.
+  const int num_cells = num_cols_ * num_rows_;
+  layout->cell_begin.assign(num_cells + 1, 0);
+  for (const int cell : cells) {
+    ++layout->cell_begin[cell + 1];
+  }
+  for (int i = 0; i < num_cells; i++) {
+    layout->cell_begin[i + 1] += layout->cell_begin[i];
+  }
+
+  std::vector<int> next_position(layout->cell_begin.begin(),
+                                 layout->cell_begin.end() - 1);
+  layout->feature_indices.resize(feature_indices.size());
+  layout->positions.resize(positions.size());
+  for (int i = 0; i < cells.size(); i++) {
+    const int index = next_position[cells[i]]++;
+    layout->feature_indices[index] = feature_indices[i];
+    layout->positions[index] = positions[i];
+  }
 }
 
-void GuidedEpipolarMatcher::ImageGrid::GetClosestGridCenter(
-    const double x, const double y, Eigen::Vector2i* grid_center) {
-  grid_center->x() = static_cast<int>(
-      std::floor((x - cell_offset_x_) / (2.0 * cell_size_)) * 2.0 * cell_size_ +
-      cell_size_ + cell_offset_x_);
-  grid_center->y() = static_cast<int>(
-      std::floor((y - cell_offset_y_) / (2.0 * cell_size_)) * 2.0 * cell_size_ +
-      +cell_size_ + cell_offset_y_);
+void GuidedEpipolarMatcher::FeatureGrid::FindFeaturesNearLine(
+    const Eigen::Vector3d& line,
+    const double max_distance,
+    std::vector<int>* feature_indices) const {
+  // Steep lines cover few columns in each row and shallow lines few rows in
+  // each column.
+  if (std::abs(line.x()) >= std::abs(line.y())) {
+    ScanBand(row_major_, true, line, max_distance, feature_indices);
+  } else {
+    ScanBand(col_major_, false, line, max_distance, feature_indices);
+  }
 }
 
-void GuidedEpipolarMatcher::ImageGrid::GetFeaturesFromCell(
-    const Eigen::Vector2i& cell_center, std::vector<int>* feature_indices) {
-  *feature_indices = FindWithDefault(cells_, cell_center, std::vector<int>());
+void GuidedEpipolarMatcher::FeatureGrid::ScanBand(
+    const Layout& layout,
+    const bool row_major,
+    const Eigen::Vector3d& line,
+    const double max_distance,
+    std::vector<int>* feature_indices) const {
+  // The line is a * minor + b * major + c = 0, where the major axis is the axis
+  // along which the band is traversed (y for row-major layouts).
+  const double a = row_major ? line.x() : line.y();
+  const double b = row_major ? line.y() : line.x();
+  const double c = line.z();
+  const double minor_origin = row_major ? origin_.x() : origin_.y();
+  const double major_origin = row_major ? origin_.y() : origin_.x();
+  const int num_minor = row_major ? num_cols_ : num_rows_;
+  const int num_major = row_major ? num_rows_ : num_cols_;
+
+  // The band is max_distance / |a| wide along the minor axis.
+  const double half_width = max_distance / std::abs(a);
+  for (int major = 0; major < num_major; major++) {
+    const double major_begin = major_origin + major * cell_size_;
+    const double major_end = major_begin + cell_size_;
+    const double minor_at_begin = -(c + b * major_begin) / a;
+    const double minor_at_end = -(c + b * major_end) / a;
+    const double minor_min =
+        std::min(minor_at_begin, minor_at_end) - half_width - minor_origin;
+    const double minor_max =
+        std::max(minor_at_begin, minor_at_end) + half_width - minor_origin;
+    if (minor_max < 0.0 || minor_min >= num_minor * cell_size_) {
+      continue;
+    }
+
+    const int first_cell = std::max(
+        0, static_cast<int>(std::floor(minor_min / cell_size_)));
+    const int last_cell = std::min(
+        num_minor - 1, static_cast<int>(std::floor(minor_max / cell_size_)));
+
+    // The cells of the band in this row (or column) are contiguous so their
+    // features form a single span.
+    const int span_begin = layout.cell_begin[major * num_minor + first_cell];
+    const int span_end = layout.cell_begin[major * num_minor + last_cell + 1];
+    for (int i = span_begin; i < span_end; i++) {
+      if (std::abs(line.dot(layout.positions[i].homogeneous())) <=
+          max_distance) {
+        feature_indices->emplace_back(layout.feature_indices[i]);
+      }
+    }
+  }
 }
 
 }  // namespace theia
@@ -37,7 +37,6 @@
 
 #include <Eigen/Core>
 #include <memory>
-#include <unordered_map>
 #include <unordered_set>
 #include <utility>
 #include <vector>
@@ -45,7 +44,6 @@
 #include "theia/alignment/alignment.h"
 #include "theia/matching/keypoints_and_descriptors.h"
 #include "theia/sfm/camera/camera.h"
-#include "theia/util/hash.h"
 
 namespace theia {
 class RandomNumberGenerator;
@@ -86,37 +84,61 @@ class GuidedEpipolarMatcher {
   bool GetMatches(std::vector<IndexedFeatureMatch>* matches);
 
  private:
-  // This helper class provides quick and easy access to the image grids that
-  // are used to rapidly find features near epipolar lines.
-  class ImageGrid {
+  // A uniform grid over the unmatched features of image 2 that is used to
+  // rapidly find the features near epipolar lines. The feature indices (and
+  // their positions) are stored contiguously sorted by cell, once with the
+  // cells in row-major and once in column-major order. An epipolar band then
+  // covers one contiguous range of cells per row (for steep lines) or per
+  // column (for shallow lines), so each of these ranges is a single contiguous
+  // span of candidates.
+  class FeatureGrid {
    public:
-    ImageGrid(const double cell_size,
-              const double cell_offset_x,
-              const double cell_offset_y);
+    // Builds the grid over the bounding box of the positions.
+    FeatureGrid(const std::vector<int>& feature_indices,
+                const std::vector<Eigen::Vector2d>& positions,
+                const double cell_size);
 
-    // Add a feature the the grid and assign it to a cell.
-    void AddFeature(const int feature_index, const double x, const double y);
-
-    // Retrieve the closest cell center to the point.
-    void GetClosestGridCenter(const double x,
-                              const double y,
-                              Eigen::Vector2i* grid_center);
-
-    // Get all features that lie within the cell specified by the center.
-    void GetFeaturesFromCell(const Eigen::Vector2i& cell_center,
-                             std::vector<int>* feature_indices);
+    // Appends the features whose distance to the normalized line (i.e.
+    // l.head<2>().norm() == 1) is at most max_distance.
+    void FindFeaturesNearLine(const Eigen::Vector3d& line,
+                              const double max_distance,
+                              std::vector<int>* feature_indices) const;
 
    private:
-    // A container for the grid cells. The mapping is such the the cell center
-    // contains all keypoints in the cell.
-    std::unordered_map<Eigen::Vector2i, std::vector<int>> cells_;
-    double cell_size_, cell_offset_x_, cell_offset_y_;
+    // The features sorted by cell, where cell_begin[i] is the first feature of
+    // the i-th cell in the layout order.
+    struct Layout {
+      std::vector<int> cell_begin;
+      std::vector<int> feature_indices;
+      std::vector<Eigen::Vector2d> positions;
+    };
+
+    void BuildLayout(const std::vector<int>& feature_indices,
+                     const std::vector<Eigen::Vector2d>& positions,
+                     const bool row_major,
+                     Layout* layout);
+
+    // Scans the cells of a layout that are intersected by the band around the
+    // line. The band is traversed along the major axis of the layout.
+    void ScanBand(const Layout& layout,
+                  const bool row_major,
+                  const Eigen::Vector3d& line,
+                  const double max_distance,
+                  std::vector<int>* feature_indices) const;
+
+    Eigen::Vector2d origin_;
+    double cell_size_;
+    int num_cols_, num_rows_;
+    Layout row_major_, col_major_;
   };
 
   // Holds a group of features with similar epiplines as a single epiline.
   struct EpilineGroup {
     std::vector<Eigen::Vector2d> endpoints;
     std::vector<int> features;
+    // The half width of the band around the epiline that contains the
+    // candidate matches of all features in the group.
+    double max_distance = 0.0;
   };
 
   // Creates the grid structure for the fast epipolar lookup.
@@ -126,7 +148,7 @@ class GuidedEpipolarMatcher {
   // workload may be reduced.
   void GroupEpipolarLines(std::vector<EpilineGroup>* epiline_groups);
 
-  // Finds all features near a given epipolar line.
+  // Finds all features within the band of a given epipolar line group.
   void FindFeaturesNearEpipolarLines(
       const EpilineGroup& epiline_group,
       std::vector<int>* candidate_keypoint_indices);
@@ -139,11 +161,6 @@ class GuidedEpipolarMatcher {
   // Computes a fundamental matrix from the cameras.
   Eigen::Matrix3d ComputeFundamentalMatrix();
 
-  // Finds the closest grid cell among all image grids and returns the keypoints
-  // in that cell.
-  void FindClosestCellAndKeypoints(const Eigen::Vector2d& point,
-                                   std::vector<int>* new_keypoints);
-
   // Given the set of query descriptors (in features1) and the candidate matches
   // (in features2), return the top 2 nearest neighbor distances and indices
   // where the index is the index in features2 of the match. The format is
@@ -161,7 +178,7 @@ class GuidedEpipolarMatcher {
   std::shared_ptr<RandomNumberGenerator> rng_;
 
   Eigen::Vector2d top_left_, bottom_right_;
-  std::vector<ImageGrid> image_grids_;
+  std::unique_ptr<FeatureGrid> feature_grid_;
   std::unordered_set<int> matched_features1_, matched_features2_;
 };
 
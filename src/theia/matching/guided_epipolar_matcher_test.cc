@@ -71,6 +71,7 @@ void TestGuidedEpipolarMatcher(const int num_valid_matches,
   // Create 3d points and reproject them into both images to form
   // correspondences.
   KeypointsAndDescriptors features1, features2;
+  std::vector<Eigen::VectorXf> descriptors1, descriptors2;
   for (int i = 0; i < num_valid_matches; i++) {
     Eigen::Vector4d point(rng->RandDouble(-2.0, 2.0),
                           rng->RandDouble(-2.0, 2.0),
@@ -89,8 +90,8 @@ void TestGuidedEpipolarMatcher(const int num_valid_matches,
     Eigen::VectorXf descriptor(kNumDescriptorDimensions);
     rng->SetRandom(&descriptor);
     descriptor.normalize();
-    features1.descriptors.emplace_back(descriptor);
-    features2.descriptors.emplace_back(descriptor);
+    descriptors1.emplace_back(descriptor);
+    descriptors2.emplace_back(descriptor);
   }
 
   // Add bogus features to the image that have no matches.
@@ -104,11 +105,14 @@ void TestGuidedEpipolarMatcher(const int num_valid_matches,
                                      Keypoint::OTHER);
     Eigen::VectorXf rand_vec(kNumDescriptorDimensions);
     rng->SetRandom(&rand_vec);
-    features1.descriptors.emplace_back(rand_vec.normalized());
+    descriptors1.emplace_back(rand_vec.normalized());
     rng->SetRandom(&rand_vec);
-    features2.descriptors.emplace_back(rand_vec.normalized());
+    descriptors2.emplace_back(rand_vec.normalized());
   }
 
+  features1.SetDescriptors(descriptors1);
+  features2.SetDescriptors(descriptors2);
+
   // Add some pre-computed matches if applicable.
   std::vector<IndexedFeatureMatch> matches;
   for (int i = 0; i < num_provided_matches; i++) {
@@ -116,7 +120,7 @@ void TestGuidedEpipolarMatcher(const int num_valid_matches,
     match.feature1_ind = i;
     match.feature2_ind = i;
     match.distance =
-        (features1.descriptors[i] - features2.descriptors[i]).squaredNorm();
+        (descriptors1[i] - descriptors2[i]).squaredNorm();
     matches.emplace_back(match);
   }
 
@@ -0,0 +1,223 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#include "theia/matching/hashed_image_cache.h"
+
+#include <glog/logging.h>
+#include <future>  // NOLINT
+#include <limits>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "theia/util/map_util.h"
+#include "theia/util/memory_accounting.h"
+#include "theia/util/metrics.h"
+
+namespace theia {
+
+HashedImageCache::HashedImageCache(
+    const CreateHashedImageFunction& create_hashed_image,
+    const size_t max_size_in_bytes)
+    : create_hashed_image_(create_hashed_image),
+      max_size_in_bytes_(max_size_in_bytes),
+      size_in_bytes_(0),
+      access_counter_(0),
+      num_cache_hits_(0),
+      num_cache_misses_(0),
+      num_evictions_(0) {
+  CHECK_GT(max_size_in_bytes_, 0)
+      << "The memory budget of the hashed image cache must be positive.";
+  memory_consumer_.reset(new ScopedMemoryConsumer(
+      "hashed_image_cache",
+      [this]() { return SizeInBytes(); },
+      [this](const size_t num_bytes) { return ReleaseMemory(num_bytes); }));
+}
+
+void HashedImageCache::SetSchedule(
+    const std::vector<std::pair<std::string, std::string> >& pairs) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  remaining_uses_.clear();
+  for (const auto& pair : pairs) {
+    ++remaining_uses_[pair.first];
+    ++remaining_uses_[pair.second];
+  }
+
+  // Drop the entries that will not be used again.
+  auto it = entries_.begin();
+  while (it != entries_.end()) {
+    if (it->second.is_ready && !ContainsKey(remaining_uses_, it->first)) {
+      size_in_bytes_ -= it->second.size_in_bytes;
+      ++num_evictions_;
+      it = entries_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
+std::shared_ptr<const HashedImage> HashedImageCache::Fetch(
+    const std::string& image_name) {
+  static Counter* const num_hits = Metrics::GetCounter(
+      "theia_hashed_image_cache_hits_total", "Hits of the hashed image cache.");
+  static Counter* const num_misses =
+      Metrics::GetCounter("theia_hashed_image_cache_misses_total",
+                          "Misses of the hashed image cache.");
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  auto it = entries_.find(image_name);
+  if (it != entries_.end()) {
+    ++num_cache_hits_;
+    num_hits->Increment();
+    it->second.last_access = ++access_counter_;
+    // Copy the future so that the entry may be evicted while we wait.
+    const auto hashed_image = it->second.hashed_image;
+    lock.unlock();
+    return hashed_image.get();
+  }
+
+  // Reserve the entry so that concurrent requests wait for this creation, then
+  // create the hashed image without holding the lock.
+  ++num_cache_misses_;
+  num_misses->Increment();
+  std::promise<std::shared_ptr<const HashedImage> > promise;
+  Entry& entry = entries_[image_name];
+  entry.hashed_image = promise.get_future().share();
+  entry.last_access = ++access_counter_;
+  lock.unlock();
+
+  const std::shared_ptr<const HashedImage> hashed_image =
+      create_hashed_image_(image_name);
+  promise.set_value(hashed_image);
+
+  lock.lock();
+  // Entries that are not ready are never evicted so the entry still exists.
+  Entry& ready_entry = FindOrDie(entries_, image_name);
+  ready_entry.is_ready = true;
+  ready_entry.size_in_bytes =
+      hashed_image == nullptr ? 0 : hashed_image->SizeInBytes();
+  size_in_bytes_ += ready_entry.size_in_bytes;
+  EvictUntilSizeIsAtMost(max_size_in_bytes_);
+  lock.unlock();
+
+  MemoryAccounting::EnforceBudget();
+  return hashed_image;
+}
+
+void HashedImageCache::Release(const std::string& image_name) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto uses_it = remaining_uses_.find(image_name);
+  if (uses_it != remaining_uses_.end()) {
+    if (--uses_it->second > 0) {
+      return;
+    }
+    remaining_uses_.erase(uses_it);
+  }
+
+  // The image is not needed anymore.
+  auto entry_it = entries_.find(image_name);
+  if (entry_it != entries_.end() && entry_it->second.is_ready) {
+    Evict(entry_it);
+  }
+}
+
+void HashedImageCache::Evict(
+    const std::unordered_map<std::string, Entry>::iterator& entry_iterator) {
+  size_in_bytes_ -= entry_iterator->second.size_in_bytes;
+  ++num_evictions_;
+  entries_.erase(entry_iterator);
+}
+
+void HashedImageCache::EvictUntilSizeIsAtMost(const size_t size_in_bytes) {
+  while (size_in_bytes_ > size_in_bytes) {
+    // Evict the entry with the fewest remaining uses, breaking ties by the
+    // least recent access.
+    auto entry_to_evict = entries_.end();
+    int min_remaining_uses = std::numeric_limits<int>::max();
+    for (auto it = entries_.begin(); it != entries_.end(); ++it) {
+      if (!it->second.is_ready) {
+        continue;
+      }
+      const int remaining_uses = FindWithDefault(remaining_uses_, it->first, 0);
+      if (remaining_uses < min_remaining_uses ||
+          (remaining_uses == min_remaining_uses &&
+           it->second.last_access < entry_to_evict->second.last_access)) {
+        min_remaining_uses = remaining_uses;
+        entry_to_evict = it;
+      }
+    }
+
+    if (entry_to_evict == entries_.end()) {
+      return;
+    }
+    Evict(entry_to_evict);
+  }
+}
+
+size_t HashedImageCache::ReleaseMemory(const size_t num_bytes) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  const size_t old_size_in_bytes = size_in_bytes_;
+  EvictUntilSizeIsAtMost(
+      old_size_in_bytes > num_bytes ? old_size_in_bytes - num_bytes : 0);
+  return old_size_in_bytes - size_in_bytes_;
+}
+
+size_t HashedImageCache::SizeInBytes() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return size_in_bytes_;
+}
+
+int HashedImageCache::Size() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return entries_.size();
+}
+
+int HashedImageCache::NumCacheHits() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return num_cache_hits_;
+}
+
+int HashedImageCache::NumCacheMisses() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return num_cache_misses_;
+}
+
+int HashedImageCache::NumEvictions() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return num_evictions_;
+}
+
+}  // namespace theia
@@ -0,0 +1,134 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#ifndef THEIA_MATCHING_HASHED_IMAGE_CACHE_H_
+#define THEIA_MATCHING_HASHED_IMAGE_CACHE_H_
+
+#include <stdint.h>
+#include <functional>
+#include <future>  // NOLINT
+#include <memory>
+#include <mutex>  // NOLINT
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "theia/matching/cascade_hasher.h"
+#include "theia/util/memory_accounting.h"
+#include "theia/util/util.h"
+
+namespace theia {
+
+// A thread-safe, memory-budgeted cache of the hashed images used by the cascade
+// hashing matcher. Unlike a plain LRU cache, eviction follows the pair schedule:
+// each image knows how many scheduled pairs still need it, an image is dropped
+// as soon as its last pair has been matched, and when the memory budget is
+// exceeded the images with the fewest remaining pairs are evicted first.
+//
+// Hashed images are created outside of the lock so that different images may
+// be hashed in parallel, and concurrent requests for the same image wait for a
+// single creation. The cache reports its memory to the MemoryAccounting and
+// evicts images when the global memory budget is exceeded.
+class HashedImageCache {
+ public:
+  typedef std::function<std::shared_ptr<HashedImage>(const std::string&)>
+      CreateHashedImageFunction;
+
+  HashedImageCache(const CreateHashedImageFunction& create_hashed_image,
+                   const size_t max_size_in_bytes);
+
+  // Sets the image pairs that are about to be matched. Each image is expected to
+  // be fetched and released once for every pair it appears in. Images that are
+  // not part of the schedule are evicted as soon as they are released.
+  void SetSchedule(
+      const std::vector<std::pair<std::string, std::string> >& pairs);
+
+  // Returns the hashed image, creating it if it is not in the cache. The
+  // returned pointer remains valid even if the entry is evicted.
+  std::shared_ptr<const HashedImage> Fetch(const std::string& image_name);
+
+  // Marks one scheduled use of the image as finished.
+  void Release(const std::string& image_name);
+
+  // Various statistics for the cache.
+  size_t MaxSizeInBytes() const { return max_size_in_bytes_; }
+  size_t SizeInBytes();
+  int Size();
+  int NumCacheHits();
+  int NumCacheMisses();
+  int NumEvictions();
+
+ private:
+  struct Entry {
+    std::shared_future<std::shared_ptr<const HashedImage> > hashed_image;
+    // Entries that are still being created cannot be evicted.
+    bool is_ready = false;
+    size_t size_in_bytes = 0;
+    uint64_t last_access = 0;
+  };
+
+  // Removes the entry and updates the memory usage.
+  //
+  // NOTE: These methods are not thread-safe and must be called with the mutex
+  // locked.
+  void Evict(
+      const std::unordered_map<std::string, Entry>::iterator& entry_iterator);
+  void EvictUntilSizeIsAtMost(const size_t size_in_bytes);
+
+  // Evicts entries until at least num_bytes are released. Returns the number of
+  // bytes that were released.
+  size_t ReleaseMemory(const size_t num_bytes);
+
+  const CreateHashedImageFunction create_hashed_image_;
+  const size_t max_size_in_bytes_;
+
+  std::mutex mutex_;
+  std::unordered_map<std::string, Entry> entries_;
+  std::unordered_map<std::string, int> remaining_uses_;
+  size_t size_in_bytes_;
+  uint64_t access_counter_;
+  int num_cache_hits_;
+  int num_cache_misses_;
+  int num_evictions_;
+
+  // Declared last so that it is unregistered before the entries are destroyed.
+  std::unique_ptr<ScopedMemoryConsumer> memory_consumer_;
+
+  DISALLOW_COPY_AND_ASSIGN(HashedImageCache);
+};
+
+}  // namespace theia
+
+#endif  // THEIA_MATCHING_HASHED_IMAGE_CACHE_H_
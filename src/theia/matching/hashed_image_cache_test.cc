@@ -0,0 +1,208 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#include <Eigen/Core>
+#include <bitset>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <cereal/archives/portable_binary.hpp>
+#include <cereal/types/bitset.hpp>
+#include <cereal/types/vector.hpp>
+
+#include "gtest/gtest.h"
+#include "theia/matching/cascade_hasher.h"
+#include "theia/matching/hashed_image_cache.h"
+#include "theia/matching/keypoints_and_descriptors.h"
+#include "theia/util/random.h"
+
+namespace theia {
+
+namespace {
+
+static const int kNumDescriptors = 100;
+static const int kNumDimensions = 128;
+
+class HashedImageCacheTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    hasher_.reset(
+        new CascadeHasher(std::make_shared<RandomNumberGenerator>(59)));
+    CHECK(hasher_->Initialize(kNumDimensions));
+  }
+
+  std::shared_ptr<HashedImage> CreateHashedImage(const std::string& name) {
+    ++num_created_;
+    RandomNumberGenerator rng(name.size());
+    DescriptorMatrix descriptors(kNumDescriptors, kNumDimensions);
+    for (int i = 0; i < kNumDescriptors; i++) {
+      for (int j = 0; j < kNumDimensions; j++) {
+        descriptors(i, j) = rng.RandDouble(0.0, 1.0);
+      }
+      descriptors.row(i).normalize();
+    }
+    return std::make_shared<HashedImage>(
+        hasher_->CreateHashedSiftDescriptors(descriptors));
+  }
+
+  HashedImageCache::CreateHashedImageFunction CreateFunction() {
+    return std::bind(&HashedImageCacheTest::CreateHashedImage,
+                     this,
+                     std::placeholders::_1);
+  }
+
+  std::unique_ptr<CascadeHasher> hasher_;
+  int num_created_ = 0;
+};
+
+}  // namespace
+
+TEST_F(HashedImageCacheTest, HashesEachScheduledImageOnce) {
+  HashedImageCache cache(CreateFunction(), 1 << 30);
+  const std::vector<std::pair<std::string, std::string> > pairs = {
+      {"a", "b"}, {"a", "c"}, {"b", "c"}};
+  cache.SetSchedule(pairs);
+
+  for (const auto& pair : pairs) {
+    EXPECT_NE(cache.Fetch(pair.first), nullptr);
+    EXPECT_NE(cache.Fetch(pair.second), nullptr);
+    cache.Release(pair.first);
+    cache.Release(pair.second);
+  }
+
+  EXPECT_EQ(num_created_, 3);
+  EXPECT_EQ(cache.NumCacheMisses(), 3);
+  EXPECT_EQ(cache.NumCacheHits(), 3);
+  // Every image is dropped once its last pair has been matched.
+  EXPECT_EQ(cache.Size(), 0);
+  EXPECT_EQ(cache.SizeInBytes(), 0);
+}
+
+TEST_F(HashedImageCacheTest, EvictsImagesWithoutRemainingUses) {
+  HashedImageCache cache(CreateFunction(), 1 << 30);
+  cache.SetSchedule({{"a", "b"}, {"a", "c"}});
+
+  cache.Fetch("a");
+  cache.Fetch("b");
+  cache.Release("a");
+  cache.Release("b");
+
+  // "b" has no remaining pairs while "a" is still needed by ("a", "c").
+  EXPECT_EQ(cache.Size(), 1);
+  EXPECT_EQ(cache.NumEvictions(), 1);
+  cache.Fetch("a");
+  EXPECT_EQ(num_created_, 2);
+}
+
+TEST_F(HashedImageCacheTest, StaysWithinMemoryBudget) {
+  const size_t image_size = CreateHashedImage("a")->SizeInBytes();
+  num_created_ = 0;
+
+  // Only two hashed images fit in the budget.
+  HashedImageCache cache(CreateFunction(), 2 * image_size + image_size / 2);
+  cache.SetSchedule({{"a", "b"}, {"a", "c"}, {"a", "d"}, {"b", "c"}});
+  cache.Fetch("a");
+  cache.Fetch("b");
+  cache.Fetch("d");
+
+  // "d" has the fewest remaining uses so it is evicted first.
+  EXPECT_EQ(cache.Size(), 2);
+  EXPECT_LE(cache.SizeInBytes(), cache.MaxSizeInBytes());
+  cache.Fetch("a");
+  cache.Fetch("b");
+  EXPECT_EQ(num_created_, 3);
+}
+
+TEST_F(HashedImageCacheTest, SerializationRebuildsBuckets) {
+  const std::shared_ptr<HashedImage> hashed_image = CreateHashedImage("a");
+  EXPECT_EQ(hashed_image->hasher_fingerprint, hasher_->Fingerprint());
+
+  std::stringstream ss;
+  {
+    cereal::PortableBinaryOutputArchive output_archive(ss);
+    output_archive(*hashed_image);
+  }
+  HashedImage loaded_image;
+  {
+    cereal::PortableBinaryInputArchive input_archive(ss);
+    input_archive(loaded_image);
+  }
+
+  EXPECT_EQ(loaded_image.hasher_fingerprint, hashed_image->hasher_fingerprint);
+  EXPECT_EQ(loaded_image.mean_descriptor, hashed_image->mean_descriptor);
+  ASSERT_EQ(loaded_image.hashed_desc.size(), hashed_image->hashed_desc.size());
+  for (int i = 0; i < loaded_image.hashed_desc.size(); i++) {
+    EXPECT_EQ(loaded_image.hashed_desc[i].hash_code,
+              hashed_image->hashed_desc[i].hash_code);
+    EXPECT_EQ(loaded_image.hashed_desc[i].bucket_ids,
+              hashed_image->hashed_desc[i].bucket_ids);
+  }
+  EXPECT_EQ(loaded_image.buckets, hashed_image->buckets);
+}
+
+// Hash codes are stored as std::bitset, which is how they were represented
+// before they were packed into 64-bit words.
+TEST_F(HashedImageCacheTest, SerializedHashCodesAreBitsets) {
+  std::bitset<kHashCodeSize> hash_code_bits;
+  hash_code_bits[0] = hash_code_bits[63] = hash_code_bits[64] = true;
+  hash_code_bits[127] = true;
+  const std::vector<uint16_t> bucket_ids(kNumBucketGroups, 7);
+
+  std::stringstream ss;
+  {
+    // Cereal writes the class version before the first HashedSiftDescriptor.
+    cereal::PortableBinaryOutputArchive output_archive(ss);
+    output_archive(static_cast<std::uint32_t>(0), hash_code_bits, bucket_ids);
+  }
+  HashedSiftDescriptor hashed_desc;
+  {
+    cereal::PortableBinaryInputArchive input_archive(ss);
+    input_archive(hashed_desc);
+  }
+  EXPECT_EQ(hashed_desc.hash_code[0], 1 | (1ULL << 63));
+  EXPECT_EQ(hashed_desc.hash_code[1], 1 | (1ULL << 63));
+  EXPECT_EQ(hashed_desc.bucket_ids, bucket_ids);
+
+  std::stringstream ss2;
+  {
+    cereal::PortableBinaryOutputArchive output_archive(ss2);
+    output_archive(hashed_desc);
+  }
+  EXPECT_EQ(ss2.str(), ss.str());
+}
+
+}  // namespace theia
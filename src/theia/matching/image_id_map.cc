@@ -1,4 +1,4 @@
-// Copyright (C) 2014 The Regents of the University of California (Regents).
+// Copyright (C) 2026 agent
 // All rights reserved.
 //
 // Redistribution and use in source and binary forms, with or without
@@ -30,43 +30,54 @@
 // POSSIBILITY OF SUCH DAMAGE.
 //
 // Please contact the author of this library if you have any questions.
-// Author: Chris Sweeney (cmsweeney@cs.ucsb.edu)
+// Author: agent (agent@local)
 
-#include "theia/matching/feature_matcher_utils.h"
+
+#include "theia/matching/image_id_map.h"
 
 #include <glog/logging.h>
-#include <unordered_map>
-#include <vector>
 
-#include "theia/matching/indexed_feature_match.h"
-#include "theia/util/map_util.h"
+#include <mutex>  // NOLINT
+#include <string>
 
 namespace theia {
 
-// Modifies forward matches so that it removes all matches that are not
-// contained in the backwards matches.
-void IntersectMatches(const std::vector<IndexedFeatureMatch>& backwards_matches,
-                      std::vector<IndexedFeatureMatch>* forward_matches) {
-  std::unordered_map<int, int> index_map;
-  index_map.reserve(backwards_matches.size());
-  // Add all feature2 -> feature1 matches to the map.
-  for (const IndexedFeatureMatch& feature_match : backwards_matches) {
-    InsertOrDie(
-        &index_map, feature_match.feature1_ind, feature_match.feature2_ind);
+ImageId ImageIdMap::GetOrAddImageId(const std::string& image_name,
+                                    bool* is_new_image) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  const auto inserted =
+      image_ids_.emplace(image_name, static_cast<ImageId>(image_names_.size()));
+  if (inserted.second) {
+    image_names_.emplace_back(image_name);
+  }
+  if (is_new_image != nullptr) {
+    *is_new_image = inserted.second;
   }
+  return inserted.first->second;
+}
 
-  // Search the map for feature1 -> feature2 matches that are also present in
-  // the feature2 -> feature1 matches.
-  auto match_iterator = forward_matches->begin();
-  while (match_iterator != forward_matches->end()) {
-    if (match_iterator->feature1_ind !=
-        FindWithDefault(index_map, match_iterator->feature2_ind, -1)) {
-      match_iterator = forward_matches->erase(match_iterator);
-      continue;
-    }
+ImageId ImageIdMap::FindImageId(const std::string& image_name) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  const auto it = image_ids_.find(image_name);
+  return it == image_ids_.end() ? kInvalidImageId : it->second;
+}
 
-    ++match_iterator;
-  }
+const std::string& ImageIdMap::ImageName(const ImageId image_id) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  CHECK_GE(image_id, 0);
+  CHECK_LT(image_id, image_names_.size()) << "Unknown image id " << image_id;
+  return image_names_[image_id];
+}
+
+int ImageIdMap::NumImages() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return image_names_.size();
+}
+
+void ImageIdMap::Clear() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  image_ids_.clear();
+  image_names_.clear();
 }
 
 }  // namespace theia
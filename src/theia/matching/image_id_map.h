@@ -0,0 +1,91 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+
+#ifndef THEIA_MATCHING_IMAGE_ID_MAP_H_
+#define THEIA_MATCHING_IMAGE_ID_MAP_H_
+
+#include <deque>
+#include <mutex>  // NOLINT
+#include <string>
+#include <unordered_map>
+
+#include "theia/util/util.h"
+
+namespace theia {
+
+// Dense integer ids of images. Matching refers to images by these ids so that
+// the image pairs are pairs of integers rather than of strings, and the image
+// names are only used to read and write the features and matches.
+typedef int ImageId;
+static const ImageId kInvalidImageId = -1;
+
+// A thread safe, bidirectional map between image names and dense image ids.
+// Ids are assigned in the order in which the names are added, starting at 0,
+// and are never reassigned.
+class ImageIdMap {
+ public:
+  ImageIdMap() {}
+
+  // Returns the id of the image, assigning the next id if the image does not
+  // have one yet. If is_new_image is not null, it is set to whether the id was
+  // assigned by this call.
+  ImageId GetOrAddImageId(const std::string& image_name,
+                          bool* is_new_image = nullptr);
+
+  // Returns the id of the image or kInvalidImageId if it has none.
+  ImageId FindImageId(const std::string& image_name) const;
+
+  // Returns the name of the image with the id, which must be valid. The
+  // reference remains valid for the lifetime of the map.
+  const std::string& ImageName(const ImageId image_id) const;
+
+  // The number of images, i.e. one more than the largest id.
+  int NumImages() const;
+
+  // Removes all images.
+  void Clear();
+
+ private:
+  mutable std::mutex mutex_;
+  std::unordered_map<std::string, ImageId> image_ids_;
+  // A deque keeps the references to the names valid when names are added.
+  std::deque<std::string> image_names_;
+
+  DISALLOW_COPY_AND_ASSIGN(ImageIdMap);
+};
+
+}  // namespace theia
+
+#endif  // THEIA_MATCHING_IMAGE_ID_MAP_H_
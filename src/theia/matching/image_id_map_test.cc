@@ -0,0 +1,100 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "theia/matching/image_id_map.h"
+
+namespace theia {
+
+TEST(ImageIdMap, AssignsDenseIds) {
+  ImageIdMap image_ids;
+  bool is_new_image = false;
+  EXPECT_EQ(image_ids.GetOrAddImageId("a.jpg", &is_new_image), 0);
+  EXPECT_TRUE(is_new_image);
+  EXPECT_EQ(image_ids.GetOrAddImageId("b.jpg"), 1);
+  EXPECT_EQ(image_ids.GetOrAddImageId("a.jpg", &is_new_image), 0);
+  EXPECT_FALSE(is_new_image);
+
+  EXPECT_EQ(image_ids.NumImages(), 2);
+  EXPECT_EQ(image_ids.FindImageId("b.jpg"), 1);
+  EXPECT_EQ(image_ids.FindImageId("c.jpg"), kInvalidImageId);
+  EXPECT_EQ(image_ids.ImageName(0), "a.jpg");
+  EXPECT_EQ(image_ids.ImageName(1), "b.jpg");
+
+  image_ids.Clear();
+  EXPECT_EQ(image_ids.NumImages(), 0);
+  EXPECT_EQ(image_ids.FindImageId("a.jpg"), kInvalidImageId);
+}
+
+TEST(ImageIdMap, NameReferencesSurviveInsertions) {
+  ImageIdMap image_ids;
+  image_ids.GetOrAddImageId("first");
+  const std::string& name = image_ids.ImageName(0);
+  for (int i = 0; i < 10000; i++) {
+    image_ids.GetOrAddImageId(std::to_string(i));
+  }
+  EXPECT_EQ(name, "first");
+}
+
+TEST(ImageIdMap, ConcurrentInsertions) {
+  static const int kNumThreads = 4;
+  static const int kNumImages = 1000;
+  ImageIdMap image_ids;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kNumThreads; t++) {
+    threads.emplace_back([&]() {
+      for (int i = 0; i < kNumImages; i++) {
+        image_ids.GetOrAddImageId(std::to_string(i));
+      }
+    });
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+
+  ASSERT_EQ(image_ids.NumImages(), kNumImages);
+  for (int i = 0; i < kNumImages; i++) {
+    const ImageId image_id = image_ids.FindImageId(std::to_string(i));
+    ASSERT_NE(image_id, kInvalidImageId);
+    EXPECT_EQ(image_ids.ImageName(image_id), std::to_string(i));
+  }
+}
+
+}  // namespace theia
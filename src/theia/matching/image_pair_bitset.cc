@@ -0,0 +1,81 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+
+#include "theia/matching/image_pair_bitset.h"
+
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <cstdint>
+
+namespace theia {
+
+ImagePairBitset::ImagePairBitset(const int num_images)
+    : num_images_(num_images), size_(0) {
+  CHECK_GE(num_images, 0);
+  const int64_t num_pairs =
+      static_cast<int64_t>(num_images) * (num_images - 1) / 2;
+  words_.resize((num_pairs + 63) / 64, 0);
+}
+
+int64_t ImagePairBitset::BitIndex(const int image_index1,
+                                  const int image_index2) const {
+  DCHECK_NE(image_index1, image_index2);
+  DCHECK_GE(std::min(image_index1, image_index2), 0);
+  DCHECK_LT(std::max(image_index1, image_index2), num_images_);
+  const int64_t i = std::min(image_index1, image_index2);
+  const int64_t j = std::max(image_index1, image_index2);
+  // Row i of the upper triangle starts after the i rows above it, which hold
+  // (n - 1) + (n - 2) + ... + (n - i) pairs.
+  return i * (2 * num_images_ - i - 1) / 2 + (j - i - 1);
+}
+
+void ImagePairBitset::Insert(const int image_index1, const int image_index2) {
+  const int64_t bit = BitIndex(image_index1, image_index2);
+  const uint64_t mask = uint64_t{1} << (bit % 64);
+  uint64_t& word = words_[bit / 64];
+  if ((word & mask) == 0) {
+    word |= mask;
+    ++size_;
+  }
+}
+
+bool ImagePairBitset::Contains(const int image_index1,
+                               const int image_index2) const {
+  const int64_t bit = BitIndex(image_index1, image_index2);
+  return (words_[bit / 64] >> (bit % 64)) & 1;
+}
+
+}  // namespace theia
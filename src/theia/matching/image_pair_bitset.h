@@ -0,0 +1,76 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+
+#ifndef THEIA_MATCHING_IMAGE_PAIR_BITSET_H_
+#define THEIA_MATCHING_IMAGE_PAIR_BITSET_H_
+
+#include <cstdint>
+#include <vector>
+
+namespace theia {
+
+// A compact set of unordered image pairs over images that are numbered densely
+// from 0 to num_images - 1. Only the upper triangle of the image-pair matrix is
+// stored, one bit per pair, so the set of 10,000 images takes about 6 MB
+// where a hash set of image name pairs takes several hundred bytes per pair.
+// Pairs are unordered: (i, j) and (j, i) are the same pair. Insertions are not
+// thread safe.
+class ImagePairBitset {
+ public:
+  explicit ImagePairBitset(const int num_images);
+
+  // Adds the pair of images i and j, which must be different.
+  void Insert(const int image_index1, const int image_index2);
+
+  // Returns true if the pair of images i and j was inserted.
+  bool Contains(const int image_index1, const int image_index2) const;
+
+  // The number of distinct pairs that were inserted.
+  int64_t Size() const { return size_; }
+
+  int NumImages() const { return num_images_; }
+
+ private:
+  // The position of the pair in the row-major upper triangle.
+  int64_t BitIndex(const int image_index1, const int image_index2) const;
+
+  int num_images_;
+  int64_t size_;
+  std::vector<uint64_t> words_;
+};
+
+}  // namespace theia
+
+#endif  // THEIA_MATCHING_IMAGE_PAIR_BITSET_H_
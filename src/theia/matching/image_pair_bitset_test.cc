@@ -0,0 +1,95 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+
+#include <algorithm>
+#include <set>
+#include <utility>
+
+#include "gtest/gtest.h"
+
+#include "theia/matching/image_pair_bitset.h"
+#include "theia/util/random.h"
+
+namespace theia {
+
+TEST(ImagePairBitset, EmptySet) {
+  ImagePairBitset pairs(5);
+  EXPECT_EQ(pairs.NumImages(), 5);
+  EXPECT_EQ(pairs.Size(), 0);
+  for (int i = 0; i < 5; i++) {
+    for (int j = 0; j < 5; j++) {
+      if (i != j) {
+        EXPECT_FALSE(pairs.Contains(i, j));
+      }
+    }
+  }
+}
+
+TEST(ImagePairBitset, PairsAreUnordered) {
+  ImagePairBitset pairs(4);
+  pairs.Insert(3, 1);
+  EXPECT_TRUE(pairs.Contains(1, 3));
+  EXPECT_TRUE(pairs.Contains(3, 1));
+  pairs.Insert(1, 3);
+  EXPECT_EQ(pairs.Size(), 1);
+  EXPECT_FALSE(pairs.Contains(0, 1));
+  EXPECT_FALSE(pairs.Contains(2, 3));
+}
+
+TEST(ImagePairBitset, MatchesSetOfPairs) {
+  static const int kNumImages = 131;
+  RandomNumberGenerator rng(56);
+  ImagePairBitset pairs(kNumImages);
+  std::set<std::pair<int, int>> expected_pairs;
+  for (int k = 0; k < 2000; k++) {
+    const int i = rng.RandInt(0, kNumImages - 1);
+    const int j = rng.RandInt(0, kNumImages - 1);
+    if (i == j) {
+      continue;
+    }
+    pairs.Insert(i, j);
+    expected_pairs.emplace(std::min(i, j), std::max(i, j));
+  }
+
+  EXPECT_EQ(pairs.Size(), expected_pairs.size());
+  for (int i = 0; i < kNumImages; i++) {
+    for (int j = i + 1; j < kNumImages; j++) {
+      EXPECT_EQ(pairs.Contains(i, j),
+                expected_pairs.count(std::make_pair(i, j)) > 0);
+    }
+  }
+}
+
+}  // namespace theia
@@ -0,0 +1,543 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+
+#include "theia/matching/image_pair_match_encoding.h"
+
+#include <Eigen/Core>
+#include <glog/logging.h>
+#include <stdint.h>
+
+#include <algorithm>
+#include <cstring>
+#include <numeric>
+#include <string>
+#include <vector>
+
+#ifdef WITH_ZSTD
+#include <zstd.h>
+#endif
+
+#include "theia/image/keypoint_detector/keypoint.h"
+#include "theia/matching/feature_correspondence.h"
+#include "theia/matching/image_pair_match.h"
+#include "theia/matching/keypoints_and_descriptors.h"
+
+namespace theia {
+namespace {
+
+// The first byte of an encoded match. Cereal's portable binary archive starts
+// with its endianness flag, which is 0 or 1.
+static const uint8_t kMagicByte = 0xE7;
+// Version 1 did not store the covariances and depth priors of the features.
+static const uint8_t kVersion = 2;
+
+enum Codec : uint8_t {
+  NO_COMPRESSION = 0,
+  ZSTD = 1,
+};
+
+// Encoded matches claiming to be larger than this once decompressed are
+// considered corrupt.
+static const uint64_t kMaxDecompressedSize = 1ull << 32;
+
+uint64_t ZigZagEncode(const int64_t value) {
+  return (static_cast<uint64_t>(value) << 1) ^
+         static_cast<uint64_t>(value >> 63);
+}
+
+int64_t ZigZagDecode(const uint64_t value) {
+  return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+void WriteVarint(uint64_t value, std::string* output) {
+  while (value >= 0x80) {
+    output->push_back(static_cast<char>((value & 0x7F) | 0x80));
+    value >>= 7;
+  }
+  output->push_back(static_cast<char>(value));
+}
+
+// Doubles are written bit-exact in little-endian byte order.
+void WriteDouble(const double value, std::string* output) {
+  uint64_t bits;
+  memcpy(&bits, &value, sizeof(bits));
+  for (size_t i = 0; i < sizeof(bits); i++) {
+    output->push_back(static_cast<char>((bits >> (8 * i)) & 0xFF));
+  }
+}
+
+void WriteString(const std::string& value, std::string* output) {
+  WriteVarint(value.size(), output);
+  output->append(value);
+}
+
+// Reads the values written by the functions above. Every read fails once the
+// data is exhausted.
+class Reader {
+ public:
+  Reader(const char* data, const size_t size)
+      : data_(data), end_(data + size) {}
+
+  size_t NumRemainingBytes() const { return end_ - data_; }
+
+  bool ReadByte(uint8_t* value) {
+    if (data_ == end_) {
+      return false;
+    }
+    *value = static_cast<uint8_t>(*data_++);
+    return true;
+  }
+
+  bool ReadVarint(uint64_t* value) {
+    *value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+      uint8_t byte;
+      if (!ReadByte(&byte)) {
+        return false;
+      }
+      *value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+      if ((byte & 0x80) == 0) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  bool ReadSignedVarint(int64_t* value) {
+    uint64_t encoded;
+    if (!ReadVarint(&encoded)) {
+      return false;
+    }
+    *value = ZigZagDecode(encoded);
+    return true;
+  }
+
+  bool ReadInt(int* value) {
+    int64_t wide_value;
+    if (!ReadSignedVarint(&wide_value)) {
+      return false;
+    }
+    *value = static_cast<int>(wide_value);
+    return true;
+  }
+
+  bool ReadDouble(double* value) {
+    if (NumRemainingBytes() < sizeof(uint64_t)) {
+      return false;
+    }
+    uint64_t bits = 0;
+    for (size_t i = 0; i < sizeof(bits); i++) {
+      bits |= static_cast<uint64_t>(static_cast<uint8_t>(*data_++)) << (8 * i);
+    }
+    memcpy(value, &bits, sizeof(bits));
+    return true;
+  }
+
+  bool ReadString(std::string* value) {
+    uint64_t size;
+    if (!ReadVarint(&size) || size > NumRemainingBytes()) {
+      return false;
+    }
+    value->assign(data_, size);
+    data_ += size;
+    return true;
+  }
+
+ private:
+  const char* data_;
+  const char* end_;
+};
+
+// Finds the index of a keypoint from its coordinates.
+class KeypointIndex {
+ public:
+  explicit KeypointIndex(const std::vector<Keypoint>& keypoints)
+      : keypoints_(keypoints), order_(keypoints.size()) {
+    std::iota(order_.begin(), order_.end(), 0);
+    std::sort(order_.begin(), order_.end(), [this](const int i, const int j) {
+      return Less(keypoints_[i], keypoints_[j].x(), keypoints_[j].y());
+    });
+  }
+
+  // Returns the index of a keypoint at the point or -1 if there is none.
+  int Find(const Eigen::Vector2d& point) const {
+    const auto it = std::lower_bound(
+        order_.begin(),
+        order_.end(),
+        point,
+        [this](const int i, const Eigen::Vector2d& point) {
+          return Less(keypoints_[i], point.x(), point.y());
+        });
+    if (it == order_.end() || keypoints_[*it].x() != point.x() ||
+        keypoints_[*it].y() != point.y()) {
+      return -1;
+    }
+    return *it;
+  }
+
+ private:
+  // Orders by x, then by y.
+  static bool Less(const Keypoint& keypoint, const double x, const double y) {
+    return keypoint.x() < x || (keypoint.x() == x && keypoint.y() < y);
+  }
+
+  const std::vector<Keypoint>& keypoints_;
+  std::vector<int> order_;
+};
+
+void EncodeTwoViewInfo(const TwoViewInfo& info, std::string* output) {
+  WriteDouble(info.focal_length_1, output);
+  WriteDouble(info.focal_length_2, output);
+  for (int i = 0; i < 3; i++) {
+    WriteDouble(info.position_2[i], output);
+  }
+  for (int i = 0; i < 3; i++) {
+    WriteDouble(info.rotation_2[i], output);
+  }
+  WriteVarint(ZigZagEncode(info.num_verified_matches), output);
+  WriteVarint(ZigZagEncode(info.num_homography_inliers), output);
+  WriteVarint(ZigZagEncode(info.visibility_score), output);
+}
+
+bool DecodeTwoViewInfo(Reader* reader, TwoViewInfo* info) {
+  if (!reader->ReadDouble(&info->focal_length_1) ||
+      !reader->ReadDouble(&info->focal_length_2)) {
+    return false;
+  }
+  for (int i = 0; i < 3; i++) {
+    if (!reader->ReadDouble(&info->position_2[i])) {
+      return false;
+    }
+  }
+  for (int i = 0; i < 3; i++) {
+    if (!reader->ReadDouble(&info->rotation_2[i])) {
+      return false;
+    }
+  }
+  return reader->ReadInt(&info->num_verified_matches) &&
+         reader->ReadInt(&info->num_homography_inliers) &&
+         reader->ReadInt(&info->visibility_score);
+}
+
+// Returns true if the covariance and depth prior of the feature are the
+// defaults, which the encoding does not store.
+bool HasDefaultAttributes(const Feature& feature) {
+  return feature.covariance_ == Eigen::Matrix2d::Identity() &&
+         feature.depth_prior_ == 0.0 && feature.depth_prior_variance_ == 0.0;
+}
+
+void EncodeFeatureAttributes(const Feature& feature, std::string* output) {
+  for (int i = 0; i < feature.covariance_.size(); i++) {
+    WriteDouble(feature.covariance_(i), output);
+  }
+  WriteDouble(feature.depth_prior_, output);
+  WriteDouble(feature.depth_prior_variance_, output);
+}
+
+bool DecodeFeatureAttributes(Reader* reader, Feature* feature) {
+  for (int i = 0; i < feature->covariance_.size(); i++) {
+    if (!reader->ReadDouble(&feature->covariance_(i))) {
+      return false;
+    }
+  }
+  return reader->ReadDouble(&feature->depth_prior_) &&
+         reader->ReadDouble(&feature->depth_prior_variance_);
+}
+
+// Writes the body of the encoded match, i.e. everything after the header.
+void EncodeBody(const ImagePairMatch& match,
+                const KeypointsAndDescriptors& features1,
+                const KeypointsAndDescriptors& features2,
+                std::string* body) {
+  WriteString(match.image1, body);
+  WriteString(match.image2, body);
+  EncodeTwoViewInfo(match.twoview_info, body);
+
+  const KeypointIndex keypoint_index1(features1.keypoints);
+  const KeypointIndex keypoint_index2(features2.keypoints);
+  const int num_correspondences = match.correspondences.size();
+  std::vector<int> indices1(num_correspondences), indices2(num_correspondences);
+  std::vector<int> verbatim_correspondences;
+  for (int i = 0; i < num_correspondences; i++) {
+    const FeatureCorrespondence& correspondence = match.correspondences[i];
+    indices1[i] = keypoint_index1.Find(correspondence.feature1.point_);
+    indices2[i] = keypoint_index2.Find(correspondence.feature2.point_);
+    if (indices1[i] == -1 || indices2[i] == -1) {
+      verbatim_correspondences.emplace_back(i);
+    }
+  }
+
+  // The correspondences that are not between keypoints come first, with their
+  // delta encoded positions.
+  WriteVarint(num_correspondences, body);
+  WriteVarint(verbatim_correspondences.size(), body);
+  int previous_position = 0;
+  for (const int position : verbatim_correspondences) {
+    WriteVarint(position - previous_position, body);
+    previous_position = position;
+    const FeatureCorrespondence& correspondence =
+        match.correspondences[position];
+    WriteDouble(correspondence.feature1.x(), body);
+    WriteDouble(correspondence.feature1.y(), body);
+    WriteDouble(correspondence.feature2.x(), body);
+    WriteDouble(correspondence.feature2.y(), body);
+  }
+
+  int previous_index1 = 0, previous_index2 = 0;
+  for (int i = 0; i < num_correspondences; i++) {
+    if (indices1[i] == -1 || indices2[i] == -1) {
+      continue;
+    }
+    WriteVarint(ZigZagEncode(static_cast<int64_t>(indices1[i]) -
+                             previous_index1),
+                body);
+    WriteVarint(ZigZagEncode(static_cast<int64_t>(indices2[i]) -
+                             previous_index2),
+                body);
+    previous_index1 = indices1[i];
+    previous_index2 = indices2[i];
+  }
+
+  // The covariances and depth priors of the correspondences whose features do
+  // not have the defaults come last, with their delta encoded positions.
+  std::vector<int> correspondences_with_attributes;
+  for (int i = 0; i < num_correspondences; i++) {
+    const FeatureCorrespondence& correspondence = match.correspondences[i];
+    if (!HasDefaultAttributes(correspondence.feature1) ||
+        !HasDefaultAttributes(correspondence.feature2)) {
+      correspondences_with_attributes.emplace_back(i);
+    }
+  }
+  WriteVarint(correspondences_with_attributes.size(), body);
+  previous_position = 0;
+  for (const int position : correspondences_with_attributes) {
+    WriteVarint(position - previous_position, body);
+    previous_position = position;
+    EncodeFeatureAttributes(match.correspondences[position].feature1, body);
+    EncodeFeatureAttributes(match.correspondences[position].feature2, body);
+  }
+}
+
+bool DecodeBody(const uint8_t version,
+                const char* data,
+                const size_t size,
+                const KeypointsAndDescriptors& features1,
+                const KeypointsAndDescriptors& features2,
+                ImagePairMatch* match) {
+  Reader reader(data, size);
+  if (!reader.ReadString(&match->image1) ||
+      !reader.ReadString(&match->image2) ||
+      !DecodeTwoViewInfo(&reader, &match->twoview_info)) {
+    return false;
+  }
+
+  // Every correspondence takes at least two bytes.
+  uint64_t num_correspondences, num_verbatim_correspondences;
+  if (!reader.ReadVarint(&num_correspondences) ||
+      num_correspondences > reader.NumRemainingBytes() / 2 ||
+      !reader.ReadVarint(&num_verbatim_correspondences) ||
+      num_verbatim_correspondences > num_correspondences) {
+    return false;
+  }
+
+  match->correspondences.clear();
+  match->correspondences.resize(num_correspondences);
+  std::vector<bool> is_verbatim(num_correspondences, false);
+  uint64_t position = 0;
+  for (uint64_t i = 0; i < num_verbatim_correspondences; i++) {
+    uint64_t delta;
+    if (!reader.ReadVarint(&delta) || (i > 0 && delta == 0)) {
+      return false;
+    }
+    position += delta;
+    if (position >= num_correspondences) {
+      return false;
+    }
+    double x1, y1, x2, y2;
+    if (!reader.ReadDouble(&x1) || !reader.ReadDouble(&y1) ||
+        !reader.ReadDouble(&x2) || !reader.ReadDouble(&y2)) {
+      return false;
+    }
+    match->correspondences[position] =
+        FeatureCorrespondence(Feature(x1, y1), Feature(x2, y2));
+    is_verbatim[position] = true;
+  }
+
+  const int64_t num_keypoints1 = features1.keypoints.size();
+  const int64_t num_keypoints2 = features2.keypoints.size();
+  int64_t index1 = 0, index2 = 0;
+  for (uint64_t i = 0; i < num_correspondences; i++) {
+    if (is_verbatim[i]) {
+      continue;
+    }
+    int64_t delta1, delta2;
+    if (!reader.ReadSignedVarint(&delta1) ||
+        !reader.ReadSignedVarint(&delta2)) {
+      return false;
+    }
+    index1 += delta1;
+    index2 += delta2;
+    if (index1 < 0 || index1 >= num_keypoints1 || index2 < 0 ||
+        index2 >= num_keypoints2) {
+      return false;
+    }
+    const Keypoint& keypoint1 = features1.keypoints[index1];
+    const Keypoint& keypoint2 = features2.keypoints[index2];
+    match->correspondences[i] =
+        FeatureCorrespondence(Feature(keypoint1.x(), keypoint1.y()),
+                              Feature(keypoint2.x(), keypoint2.y()));
+  }
+
+  if (version >= 2) {
+    uint64_t num_correspondences_with_attributes;
+    if (!reader.ReadVarint(&num_correspondences_with_attributes) ||
+        num_correspondences_with_attributes > num_correspondences) {
+      return false;
+    }
+    position = 0;
+    for (uint64_t i = 0; i < num_correspondences_with_attributes; i++) {
+      uint64_t delta;
+      if (!reader.ReadVarint(&delta) || (i > 0 && delta == 0)) {
+        return false;
+      }
+      position += delta;
+      if (position >= num_correspondences) {
+        return false;
+      }
+      FeatureCorrespondence& correspondence = match->correspondences[position];
+      if (!DecodeFeatureAttributes(&reader, &correspondence.feature1) ||
+          !DecodeFeatureAttributes(&reader, &correspondence.feature2)) {
+        return false;
+      }
+    }
+  }
+  return reader.NumRemainingBytes() == 0;
+}
+
+}  // namespace
+
+void EncodeImagePairMatch(const ImagePairMatchEncodingOptions& options,
+                          const ImagePairMatch& match,
+                          const KeypointsAndDescriptors& features1,
+                          const KeypointsAndDescriptors& features2,
+                          std::string* encoded) {
+  CHECK_NOTNULL(encoded)->clear();
+  std::string body;
+  EncodeBody(match, features1, features2, &body);
+
+  encoded->push_back(static_cast<char>(kMagicByte));
+  encoded->push_back(static_cast<char>(kVersion));
+#ifdef WITH_ZSTD
+  if (options.compress) {
+    std::string compressed(ZSTD_compressBound(body.size()), '\0');
+    const size_t compressed_size = ZSTD_compress(&compressed[0],
+                                                 compressed.size(),
+                                                 body.data(),
+                                                 body.size(),
+                                                 options.compression_level);
+    if (!ZSTD_isError(compressed_size) && compressed_size < body.size()) {
+      encoded->push_back(static_cast<char>(ZSTD));
+      WriteVarint(body.size(), encoded);
+      encoded->append(compressed.data(), compressed_size);
+      return;
+    }
+  }
+#endif
+  encoded->push_back(static_cast<char>(NO_COMPRESSION));
+  encoded->append(body);
+}
+
+bool IsEncodedImagePairMatch(const char* data, const size_t size) {
+  return size > 0 && static_cast<uint8_t>(data[0]) == kMagicByte;
+}
+
+bool DecodeImagePairMatch(const char* data,
+                          const size_t size,
+                          const KeypointsAndDescriptors& features1,
+                          const KeypointsAndDescriptors& features2,
+                          ImagePairMatch* match) {
+  CHECK_NOTNULL(match);
+  Reader reader(data, size);
+  uint8_t magic_byte, version, codec;
+  if (!reader.ReadByte(&magic_byte) || magic_byte != kMagicByte ||
+      !reader.ReadByte(&version) || version < 1 || version > kVersion ||
+      !reader.ReadByte(&codec)) {
+    LOG(ERROR) << "The data is not an encoded image pair match.";
+    return false;
+  }
+
+  const char* body = data + 3;
+  size_t body_size = size - 3;
+  std::string decompressed;
+  if (codec == ZSTD) {
+#ifdef WITH_ZSTD
+    uint64_t decompressed_size;
+    if (!reader.ReadVarint(&decompressed_size) ||
+        decompressed_size > kMaxDecompressedSize) {
+      LOG(ERROR) << "The encoded image pair match is corrupt.";
+      return false;
+    }
+    const size_t compressed_size = reader.NumRemainingBytes();
+    decompressed.resize(decompressed_size);
+    const size_t actual_size = ZSTD_decompress(&decompressed[0],
+                                               decompressed.size(),
+                                               data + size - compressed_size,
+                                               compressed_size);
+    if (ZSTD_isError(actual_size) || actual_size != decompressed_size) {
+      LOG(ERROR) << "Could not decompress the encoded image pair match.";
+      return false;
+    }
+    body = decompressed.data();
+    body_size = decompressed.size();
+#else
+    LOG(ERROR) << "The image pair match is compressed with zstd but Theia was "
+                  "built without zstd. Please build with WITH_ZSTD.";
+    return false;
+#endif
+  } else if (codec != NO_COMPRESSION) {
+    LOG(ERROR) << "Unknown compression of the encoded image pair match.";
+    return false;
+  }
+
+  if (!DecodeBody(version, body, body_size, features1, features2, match)) {
+    LOG(ERROR) << "The encoded image pair match of images " << match->image1
+               << " and " << match->image2
+               << " is corrupt or does not match the features.";
+    return false;
+  }
+  return true;
+}
+
+}  // namespace theia
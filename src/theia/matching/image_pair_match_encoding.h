@@ -0,0 +1,92 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+
+#ifndef THEIA_MATCHING_IMAGE_PAIR_MATCH_ENCODING_H_
+#define THEIA_MATCHING_IMAGE_PAIR_MATCH_ENCODING_H_
+
+#include <cstddef>
+#include <string>
+
+namespace theia {
+
+struct ImagePairMatch;
+struct KeypointsAndDescriptors;
+
+// A compact encoding of image pair matches for storage and transport. Instead
+// of the coordinates of both features, each correspondence is stored as the
+// indices of its features in the keypoints of the two images. The indices are
+// delta encoded against the previous correspondence (in zigzag form, since the
+// indices of the second image are not sorted) and written as varints, which
+// takes 2-4 bytes per correspondence instead of 32. Matchers output the
+// correspondences in the order of the features of the first image, so its
+// deltas are mostly a single byte. The coordinates are looked up in the
+// keypoints when the match is decoded.
+//
+// Correspondences whose coordinates are not the coordinates of a keypoint are
+// stored verbatim, as are the covariances and depth priors of the features if
+// they are not the defaults, so the encoding is lossless and keeps the order
+// of the correspondences.
+struct ImagePairMatchEncodingOptions {
+  // If true and Theia is built with zstd (WITH_ZSTD), the encoded match is
+  // compressed with zstd at the given level when this makes it smaller.
+  bool compress = true;
+  int compression_level = 3;
+};
+
+// Encodes the match, whose correspondences are in the pixel coordinates of the
+// keypoints of features1 and features2.
+void EncodeImagePairMatch(const ImagePairMatchEncodingOptions& options,
+                          const ImagePairMatch& match,
+                          const KeypointsAndDescriptors& features1,
+                          const KeypointsAndDescriptors& features2,
+                          std::string* encoded);
+
+// Returns true if the data starts like an encoded match. Matches serialized
+// with cereal's portable binary archive never do, so both formats may be
+// stored side by side.
+bool IsEncodedImagePairMatch(const char* data, const size_t size);
+
+// Decodes the match with the keypoints of the features it was encoded with.
+// Returns false if the data is corrupt, refers to keypoints that do not exist,
+// or is compressed while Theia was built without zstd.
+bool DecodeImagePairMatch(const char* data,
+                          const size_t size,
+                          const KeypointsAndDescriptors& features1,
+                          const KeypointsAndDescriptors& features2,
+                          ImagePairMatch* match);
+
+}  // namespace theia
+
+#endif  // THEIA_MATCHING_IMAGE_PAIR_MATCH_ENCODING_H_
@@ -0,0 +1,243 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+
+#include <cereal/archives/portable_binary.hpp>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "theia/matching/image_pair_match.h"
+#include "theia/matching/image_pair_match_encoding.h"
+#include "theia/matching/keypoints_and_descriptors.h"
+#include "theia/util/random.h"
+
+namespace theia {
+namespace {
+
+static const int kNumKeypoints = 2000;
+
+KeypointsAndDescriptors RandomFeatures(const std::string& image_name,
+                                       RandomNumberGenerator* rng) {
+  KeypointsAndDescriptors features;
+  features.image_name = image_name;
+  for (int i = 0; i < kNumKeypoints; i++) {
+    features.keypoints.emplace_back(rng->RandDouble(0.0, 1000.0),
+                                    rng->RandDouble(0.0, 1000.0),
+                                    Keypoint::SIFT);
+  }
+  return features;
+}
+
+// Matches every third feature of the first image to a random feature of the
+// second image, in the order of the first image as matchers do.
+ImagePairMatch RandomMatch(const KeypointsAndDescriptors& features1,
+                           const KeypointsAndDescriptors& features2,
+                           RandomNumberGenerator* rng) {
+  ImagePairMatch match;
+  match.image1 = features1.image_name;
+  match.image2 = features2.image_name;
+  match.twoview_info.focal_length_1 = 1200.5;
+  match.twoview_info.focal_length_2 = 980.25;
+  match.twoview_info.position_2 = Eigen::Vector3d(0.1, -0.7, 0.3);
+  match.twoview_info.rotation_2 = Eigen::Vector3d(0.01, 0.2, -0.05);
+  match.twoview_info.num_homography_inliers = 17;
+  match.twoview_info.visibility_score = 123;
+  for (int i = 0; i < kNumKeypoints; i += 3) {
+    const Keypoint& keypoint1 = features1.keypoints[i];
+    const Keypoint& keypoint2 =
+        features2.keypoints[rng->RandInt(0, kNumKeypoints - 1)];
+    match.correspondences.emplace_back(Feature(keypoint1.x(), keypoint1.y()),
+                                       Feature(keypoint2.x(), keypoint2.y()));
+  }
+  match.twoview_info.num_verified_matches = match.correspondences.size();
+  return match;
+}
+
+// Feature equality only compares the positions.
+void ExpectFeatureAttributesAreEqual(const Feature& expected,
+                                     const Feature& actual) {
+  EXPECT_TRUE(actual.covariance_ == expected.covariance_);
+  EXPECT_EQ(actual.depth_prior_, expected.depth_prior_);
+  EXPECT_EQ(actual.depth_prior_variance_, expected.depth_prior_variance_);
+}
+
+void ExpectMatchesAreEqual(const ImagePairMatch& expected,
+                           const ImagePairMatch& actual) {
+  EXPECT_EQ(actual.image1, expected.image1);
+  EXPECT_EQ(actual.image2, expected.image2);
+  EXPECT_EQ(actual.twoview_info.focal_length_1,
+            expected.twoview_info.focal_length_1);
+  EXPECT_EQ(actual.twoview_info.focal_length_2,
+            expected.twoview_info.focal_length_2);
+  EXPECT_EQ(actual.twoview_info.position_2, expected.twoview_info.position_2);
+  EXPECT_EQ(actual.twoview_info.rotation_2, expected.twoview_info.rotation_2);
+  EXPECT_EQ(actual.twoview_info.num_verified_matches,
+            expected.twoview_info.num_verified_matches);
+  EXPECT_EQ(actual.twoview_info.num_homography_inliers,
+            expected.twoview_info.num_homography_inliers);
+  EXPECT_EQ(actual.twoview_info.visibility_score,
+            expected.twoview_info.visibility_score);
+  ASSERT_EQ(actual.correspondences.size(), expected.correspondences.size());
+  for (int i = 0; i < expected.correspondences.size(); i++) {
+    EXPECT_EQ(actual.correspondences[i], expected.correspondences[i]);
+    ExpectFeatureAttributesAreEqual(expected.correspondences[i].feature1,
+                                    actual.correspondences[i].feature1);
+    ExpectFeatureAttributesAreEqual(expected.correspondences[i].feature2,
+                                    actual.correspondences[i].feature2);
+  }
+}
+
+std::string SerializeWithCereal(const ImagePairMatch& match) {
+  std::stringstream ss;
+  {
+    cereal::PortableBinaryOutputArchive output_archive(ss);
+    output_archive(match);
+  }
+  return ss.str();
+}
+
+TEST(ImagePairMatchEncoding, RoundTrip) {
+  RandomNumberGenerator rng(71);
+  const KeypointsAndDescriptors features1 = RandomFeatures("a.jpg", &rng);
+  const KeypointsAndDescriptors features2 = RandomFeatures("b.jpg", &rng);
+  const ImagePairMatch match = RandomMatch(features1, features2, &rng);
+
+  std::string encoded;
+  EncodeImagePairMatch(
+      ImagePairMatchEncodingOptions(), match, features1, features2, &encoded);
+  EXPECT_TRUE(IsEncodedImagePairMatch(encoded.data(), encoded.size()));
+
+  ImagePairMatch decoded;
+  EXPECT_TRUE(DecodeImagePairMatch(
+      encoded.data(), encoded.size(), features1, features2, &decoded));
+  ExpectMatchesAreEqual(match, decoded);
+
+  // The indices take a few bytes per correspondence instead of four doubles.
+  const std::string serialized = SerializeWithCereal(match);
+  EXPECT_FALSE(IsEncodedImagePairMatch(serialized.data(), serialized.size()));
+  EXPECT_LT(encoded.size() * 8, serialized.size());
+}
+
+TEST(ImagePairMatchEncoding, CorrespondencesBetweenNonKeypointsAreKept) {
+  RandomNumberGenerator rng(73);
+  const KeypointsAndDescriptors features1 = RandomFeatures("a.jpg", &rng);
+  const KeypointsAndDescriptors features2 = RandomFeatures("b.jpg", &rng);
+  ImagePairMatch match = RandomMatch(features1, features2, &rng);
+
+  // Move some of the features off their keypoints, e.g. as refined positions.
+  for (int i = 0; i < match.correspondences.size(); i += 50) {
+    match.correspondences[i].feature1.point_.x() += 0.25;
+  }
+  match.correspondences.back().feature2.point_.y() += 0.5;
+  match.correspondences.emplace_back(Feature(-1.0, -2.0), Feature(3.0, 4.0));
+
+  std::string encoded;
+  EncodeImagePairMatch(
+      ImagePairMatchEncodingOptions(), match, features1, features2, &encoded);
+  ImagePairMatch decoded;
+  EXPECT_TRUE(DecodeImagePairMatch(
+      encoded.data(), encoded.size(), features1, features2, &decoded));
+  ExpectMatchesAreEqual(match, decoded);
+}
+
+TEST(ImagePairMatchEncoding, FeatureCovariancesAndDepthPriorsAreKept) {
+  RandomNumberGenerator rng(77);
+  const KeypointsAndDescriptors features1 = RandomFeatures("a.jpg", &rng);
+  const KeypointsAndDescriptors features2 = RandomFeatures("b.jpg", &rng);
+  ImagePairMatch match = RandomMatch(features1, features2, &rng);
+
+  Eigen::Matrix2d covariance;
+  covariance << 2.0, 0.5, 0.5, 3.0;
+  match.correspondences[0].feature1.covariance_ = covariance;
+  match.correspondences[7].feature2.depth_prior_ = 4.5;
+  match.correspondences[7].feature2.depth_prior_variance_ = 0.25;
+  match.correspondences.back().feature1 =
+      Feature(Eigen::Vector2d(-1.0, -2.0), covariance, 12.0, 1.5);
+
+  std::string encoded;
+  EncodeImagePairMatch(
+      ImagePairMatchEncodingOptions(), match, features1, features2, &encoded);
+  ImagePairMatch decoded;
+  EXPECT_TRUE(DecodeImagePairMatch(
+      encoded.data(), encoded.size(), features1, features2, &decoded));
+  ExpectMatchesAreEqual(match, decoded);
+}
+
+TEST(ImagePairMatchEncoding, EmptyMatch) {
+  const KeypointsAndDescriptors features;
+  ImagePairMatch match;
+  match.image1 = "a.jpg";
+  match.image2 = "b.jpg";
+
+  std::string encoded;
+  ImagePairMatchEncodingOptions options;
+  options.compress = false;
+  EncodeImagePairMatch(options, match, features, features, &encoded);
+  ImagePairMatch decoded;
+  EXPECT_TRUE(DecodeImagePairMatch(
+      encoded.data(), encoded.size(), features, features, &decoded));
+  ExpectMatchesAreEqual(match, decoded);
+}
+
+TEST(ImagePairMatchEncoding, RejectsCorruptData) {
+  RandomNumberGenerator rng(79);
+  const KeypointsAndDescriptors features1 = RandomFeatures("a.jpg", &rng);
+  const KeypointsAndDescriptors features2 = RandomFeatures("b.jpg", &rng);
+  const ImagePairMatch match = RandomMatch(features1, features2, &rng);
+
+  ImagePairMatchEncodingOptions options;
+  options.compress = false;
+  std::string encoded;
+  EncodeImagePairMatch(options, match, features1, features2, &encoded);
+
+  ImagePairMatch decoded;
+  EXPECT_FALSE(DecodeImagePairMatch(
+      encoded.data(), encoded.size() - 1, features1, features2, &decoded));
+  EXPECT_FALSE(DecodeImagePairMatch(
+      encoded.data(), 2, features1, features2, &decoded));
+  EXPECT_FALSE(DecodeImagePairMatch(
+      encoded.data() + 1, encoded.size() - 1, features1, features2, &decoded));
+
+  // The keypoints of the second image do not cover the indices.
+  KeypointsAndDescriptors fewer_features2 = features2;
+  fewer_features2.keypoints.resize(10);
+  EXPECT_FALSE(DecodeImagePairMatch(
+      encoded.data(), encoded.size(), features1, fewer_features2, &decoded));
+}
+
+}  // namespace
+}  // namespace theia
@@ -43,8 +43,11 @@
 #include <fstream>  // NOLINT
 #include <glog/logging.h>
 #include <iostream>  // NOLINT
-#include <mutex>     // NOLINT
+#include <memory>
+#include <shared_mutex>  // NOLINT
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "theia/matching/image_pair_match.h"
 #include "theia/matching/keypoints_and_descriptors.h"
@@ -52,8 +55,16 @@
 
 namespace theia {
 
+namespace {
+
+using ReadLock = std::shared_lock<std::shared_timed_mutex>;
+using WriteLock = std::unique_lock<std::shared_timed_mutex>;
+
+}  // namespace
+
 bool InMemoryFeaturesAndMatchesDatabase::ContainsCameraIntrinsicsPrior(
     const std::string& image_name) {
+  ReadLock lock(intrinsics_priors_mutex_);
   return ContainsKey(intrinsics_priors_, image_name);
 }
 
@@ -61,18 +72,21 @@ bool InMemoryFeaturesAndMatchesDatabase::ContainsCameraIntrinsicsPrior(
 CameraIntrinsicsPrior
 InMemoryFeaturesAndMatchesDatabase::GetCameraIntrinsicsPrior(
     const std::string& image_name) {
+  ReadLock lock(intrinsics_priors_mutex_);
   return FindOrDie(intrinsics_priors_, image_name);
 }
 
 // Set the features for the image.
 void InMemoryFeaturesAndMatchesDatabase::PutCameraIntrinsicsPrior(
     const std::string& image_name, const CameraIntrinsicsPrior& intrinsics) {
+  WriteLock lock(intrinsics_priors_mutex_);
   intrinsics_priors_[image_name] = intrinsics;
 }
 
 // Supply an iterator to iterate over the priors.
 std::vector<std::string>
 InMemoryFeaturesAndMatchesDatabase::ImageNamesOfCameraIntrinsicsPriors() {
+  ReadLock lock(intrinsics_priors_mutex_);
   std::vector<std::string> image_names;
   image_names.reserve(intrinsics_priors_.size());
   for (const auto& intrinsics : intrinsics_priors_) {
@@ -82,44 +96,72 @@ InMemoryFeaturesAndMatchesDatabase::ImageNamesOfCameraIntrinsicsPriors() {
 }
 
 size_t InMemoryFeaturesAndMatchesDatabase::NumCameraIntrinsicsPrior() {
+  ReadLock lock(intrinsics_priors_mutex_);
   return intrinsics_priors_.size();
 }
 
 bool InMemoryFeaturesAndMatchesDatabase::ContainsFeatures(
     const std::string& image_name) {
-  return ContainsKey(features_, image_name);
+  FeaturesShard& shard = FeaturesShardOfImage(image_name);
+  ReadLock lock(shard.mutex);
+  return ContainsKey(shard.features, image_name);
 }
 
-// Get/set the features for the image.
+// Get/set the features for the image. The features are copied after the lock
+// is released.
 KeypointsAndDescriptors InMemoryFeaturesAndMatchesDatabase::GetFeatures(
     const std::string& image_name) {
-  return FindOrDie(features_, image_name);
+  return *GetSharedFeatures(image_name);
 }
 
-// Set the features for the image.
+std::shared_ptr<const KeypointsAndDescriptors>
+InMemoryFeaturesAndMatchesDatabase::GetSharedFeatures(
+    const std::string& image_name) {
+  FeaturesShard& shard = FeaturesShardOfImage(image_name);
+  ReadLock lock(shard.mutex);
+  return FindOrDie(shard.features, image_name);
+}
+
+// Set the features for the image. The features are replaced rather than
+// modified so that shared handles to the old features remain valid. They are
+// copied before the lock is acquired.
 void InMemoryFeaturesAndMatchesDatabase::PutFeatures(
     const std::string& image_name, const KeypointsAndDescriptors& features) {
-  features_[image_name] = features;
+  std::shared_ptr<const KeypointsAndDescriptors> shared_features =
+      std::make_shared<const KeypointsAndDescriptors>(features);
+  FeaturesShard& shard = FeaturesShardOfImage(image_name);
+  WriteLock lock(shard.mutex);
+  shard.features[image_name].swap(shared_features);
 }
 
 std::vector<std::string>
 InMemoryFeaturesAndMatchesDatabase::ImageNamesOfFeatures() {
   std::vector<std::string> features_keys;
-  features_keys.reserve(features_.size());
-  for (const auto& features : features_) {
-    features_keys.push_back(features.first);
+  for (FeaturesShard& shard : features_shards_) {
+    ReadLock lock(shard.mutex);
+    for (const auto& features : shard.features) {
+      features_keys.push_back(features.first);
+    }
   }
   return features_keys;
 }
 
 size_t InMemoryFeaturesAndMatchesDatabase::NumImages() {
-  return features_.size();
+  size_t num_images = 0;
+  for (FeaturesShard& shard : features_shards_) {
+    ReadLock lock(shard.mutex);
+    num_images += shard.features.size();
+  }
+  return num_images;
 }
 
 // Get the image pair match for the images.
 ImagePairMatch InMemoryFeaturesAndMatchesDatabase::GetImagePairMatch(
     const std::string& image_name1, const std::string& image_name2) {
-  return FindOrDieNoPrint(matches_, std::make_pair(image_name1, image_name2));
+  const auto image_pair = std::make_pair(image_name1, image_name2);
+  MatchesShard& shard = MatchesShardOfImagePair(image_pair);
+  ReadLock lock(shard.mutex);
+  return FindOrDieNoPrint(shard.matches, image_pair);
 }
 
 // Set the image pair match for the images.
@@ -127,22 +169,77 @@ void InMemoryFeaturesAndMatchesDatabase::PutImagePairMatch(
     const std::string& image_name1,
     const std::string& image_name2,
     const ImagePairMatch& matches) {
-  std::lock_guard<std::mutex> lock(mutex_);
-  matches_[std::make_pair(image_name1, image_name2)] = matches;
+  const auto image_pair = std::make_pair(image_name1, image_name2);
+  MatchesShard& shard = MatchesShardOfImagePair(image_pair);
+  WriteLock lock(shard.mutex);
+  shard.matches[image_pair] = matches;
 }
 
 std::vector<std::pair<std::string, std::string>>
 InMemoryFeaturesAndMatchesDatabase::ImageNamesOfMatches() {
   std::vector<std::pair<std::string, std::string>> match_keys;
-  match_keys.reserve(matches_.size());
-  for (const auto& match : matches_) {
-    match_keys.push_back(match.first);
+  for (MatchesShard& shard : matches_shards_) {
+    ReadLock lock(shard.mutex);
+    for (const auto& match : shard.matches) {
+      match_keys.push_back(match.first);
+    }
   }
   return match_keys;
 }
 
 size_t InMemoryFeaturesAndMatchesDatabase::NumMatches() {
-  return matches_.size();
+  size_t num_matches = 0;
+  for (MatchesShard& shard : matches_shards_) {
+    ReadLock lock(shard.mutex);
+    num_matches += shard.matches.size();
+  }
+  return num_matches;
+}
+
+bool InMemoryFeaturesAndMatchesDatabase::ContainsImagePairMatch(
+    const std::string& image_name1, const std::string& image_name2) {
+  const auto image_pair = std::make_pair(image_name1, image_name2);
+  MatchesShard& shard = MatchesShardOfImagePair(image_pair);
+  ReadLock lock(shard.mutex);
+  return ContainsKey(shard.matches, image_pair);
+}
+
+// The callbacks are called without holding a lock so that they may access the
+// database. The contents of one shard are copied at a time.
+void InMemoryFeaturesAndMatchesDatabase::ForEachMatchedImagePair(
+    const ImagePairCallback& callback) {
+  for (MatchesShard& shard : matches_shards_) {
+    std::vector<std::pair<std::string, std::string>> image_pairs;
+    {
+      ReadLock lock(shard.mutex);
+      image_pairs.reserve(shard.matches.size());
+      for (const auto& match : shard.matches) {
+        image_pairs.push_back(match.first);
+      }
+    }
+    for (const auto& image_pair : image_pairs) {
+      if (!callback(image_pair.first, image_pair.second)) {
+        return;
+      }
+    }
+  }
+}
+
+void InMemoryFeaturesAndMatchesDatabase::ForEachImagePairMatch(
+    const ImagePairMatchCallback& callback) {
+  for (MatchesShard& shard : matches_shards_) {
+    std::vector<std::pair<std::pair<std::string, std::string>, ImagePairMatch>>
+        matches;
+    {
+      ReadLock lock(shard.mutex);
+      matches.assign(shard.matches.begin(), shard.matches.end());
+    }
+    for (const auto& match : matches) {
+      if (!callback(match.first.first, match.first.second, match.second)) {
+        return;
+      }
+    }
+  }
 }
 
 bool InMemoryFeaturesAndMatchesDatabase::ReadFromFile(
@@ -155,7 +252,8 @@ bool InMemoryFeaturesAndMatchesDatabase::ReadFromFile(
     return false;
   }
 
-  // Make sure that Cereal is able to finish executing before returning.
+  // Make sure that Cereal is able to finish executing before returning. The
+  // file is read before any lock is acquired.
   std::vector<ImagePairMatch> matches;
   std::vector<std::string> view_names;
   std::vector<CameraIntrinsicsPrior> camera_intrinsics_prior;
@@ -165,11 +263,14 @@ bool InMemoryFeaturesAndMatchesDatabase::ReadFromFile(
   }
   CHECK_EQ(view_names.size(), camera_intrinsics_prior.size());
 
-  matches_.reserve(matches.size());
-  for (const auto& match : matches) {
-    matches_[std::make_pair(match.image1, match.image2)] = match;
+  for (auto& match : matches) {
+    const auto image_pair = std::make_pair(match.image1, match.image2);
+    MatchesShard& shard = MatchesShardOfImagePair(image_pair);
+    WriteLock lock(shard.mutex);
+    shard.matches[image_pair] = std::move(match);
   }
 
+  WriteLock lock(intrinsics_priors_mutex_);
   intrinsics_priors_.reserve(camera_intrinsics_prior.size());
   for (int i = 0; i < view_names.size(); i++) {
     intrinsics_priors_[view_names[i]] = camera_intrinsics_prior[i];
@@ -187,21 +288,29 @@ bool InMemoryFeaturesAndMatchesDatabase::WriteToFile(
     return false;
   }
 
-  // Make sure that Cereal is able to finish executing before returning.
+  // Copy the contents of the database so that no lock is held while the file
+  // is written.
   std::vector<ImagePairMatch> matches;
-  matches.reserve(matches_.size());
-  for (const auto& match : matches_) {
-    matches.push_back(match.second);
+  for (MatchesShard& shard : matches_shards_) {
+    ReadLock lock(shard.mutex);
+    for (const auto& match : shard.matches) {
+      matches.push_back(match.second);
+    }
   }
 
   std::vector<std::string> view_names;
-  view_names.reserve(intrinsics_priors_.size());
   std::vector<CameraIntrinsicsPrior> camera_intrinsics_prior;
-  camera_intrinsics_prior.reserve(intrinsics_priors_.size());
-  for (const auto& prior : intrinsics_priors_) {
-    view_names.push_back(prior.first);
-    camera_intrinsics_prior.push_back(prior.second);
+  {
+    ReadLock lock(intrinsics_priors_mutex_);
+    view_names.reserve(intrinsics_priors_.size());
+    camera_intrinsics_prior.reserve(intrinsics_priors_.size());
+    for (const auto& prior : intrinsics_priors_) {
+      view_names.push_back(prior.first);
+      camera_intrinsics_prior.push_back(prior.second);
+    }
   }
+
+  // Make sure that Cereal is able to finish executing before returning.
   {
     cereal::PortableBinaryOutputArchive output_archive(matches_writer);
     output_archive(view_names, camera_intrinsics_prior, matches);
@@ -211,7 +320,48 @@ bool InMemoryFeaturesAndMatchesDatabase::WriteToFile(
 }
 
 void InMemoryFeaturesAndMatchesDatabase::RemoveAllMatches() {
-  matches_.clear();
+  for (MatchesShard& shard : matches_shards_) {
+    WriteLock lock(shard.mutex);
+    shard.matches.clear();
+    shard.failed_image_pairs.clear();
+  }
+}
+
+void InMemoryFeaturesAndMatchesDatabase::PutFailedImagePair(
+    const std::string& image_name1, const std::string& image_name2) {
+  auto image_pair = std::make_pair(image_name1, image_name2);
+  MatchesShard& shard = MatchesShardOfImagePair(image_pair);
+  WriteLock lock(shard.mutex);
+  shard.failed_image_pairs.emplace(std::move(image_pair));
+}
+
+std::vector<std::pair<std::string, std::string>>
+InMemoryFeaturesAndMatchesDatabase::ImageNamesOfFailedImagePairs() {
+  std::vector<std::pair<std::string, std::string>> image_pairs;
+  for (MatchesShard& shard : matches_shards_) {
+    ReadLock lock(shard.mutex);
+    image_pairs.insert(image_pairs.end(),
+                       shard.failed_image_pairs.begin(),
+                       shard.failed_image_pairs.end());
+  }
+  return image_pairs;
+}
+
+bool InMemoryFeaturesAndMatchesDatabase::ContainsFailedImagePair(
+    const std::string& image_name1, const std::string& image_name2) {
+  const auto image_pair = std::make_pair(image_name1, image_name2);
+  MatchesShard& shard = MatchesShardOfImagePair(image_pair);
+  ReadLock lock(shard.mutex);
+  return ContainsKey(shard.failed_image_pairs, image_pair);
+}
+
+void InMemoryFeaturesAndMatchesDatabase::ForEachFailedImagePair(
+    const ImagePairCallback& callback) {
+  for (const auto& image_pair : ImageNamesOfFailedImagePairs()) {
+    if (!callback(image_pair.first, image_pair.second)) {
+      return;
+    }
+  }
 }
 
 }  // namespace theia
@@ -35,10 +35,15 @@
 #ifndef THEIA_MATCHING_IN_MEMORY_FEATURES_AND_MATCHES_DATABASE_H_
 #define THEIA_MATCHING_IN_MEMORY_FEATURES_AND_MATCHES_DATABASE_H_
 
-#include <mutex>  // NOLINT
+#include <array>
+#include <functional>
+#include <memory>
+#include <shared_mutex>  // NOLINT
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
 #include <utility>
+#include <vector>
 
 #include "theia/io/read_keypoints_and_descriptors.h"
 #include "theia/io/write_keypoints_and_descriptors.h"
@@ -47,11 +52,16 @@
 #include "theia/matching/keypoints_and_descriptors.h"
 #include "theia/sfm/camera_intrinsics_prior.h"
 #include "theia/util/filesystem.h"
+#include "theia/util/hash.h"
 #include "theia/util/util.h"
 
 namespace theia {
 
 // A simple implementation for storing features and feature matches in memory.
+// This class is thread safe. The features and matches are split into shards
+// by the hash of the image name (or pair of names) and every shard has its own
+// reader-writer lock, so that the matching threads rarely contend for a lock
+// and concurrent reads never block each other.
 class InMemoryFeaturesAndMatchesDatabase : public FeaturesAndMatchesDatabase {
  public:
   InMemoryFeaturesAndMatchesDatabase() = default;
@@ -77,6 +87,10 @@ class InMemoryFeaturesAndMatchesDatabase : public FeaturesAndMatchesDatabase {
   // Get/set the features for the image.
   KeypointsAndDescriptors GetFeatures(const std::string& image_name) override;
 
+  // Returns the stored features without copying them.
+  std::shared_ptr<const KeypointsAndDescriptors> GetSharedFeatures(
+      const std::string& image_name) override;
+
   // Set the features for the image.
   void PutFeatures(const std::string& image_name,
                    const KeypointsAndDescriptors& features) override;
@@ -98,20 +112,68 @@ class InMemoryFeaturesAndMatchesDatabase : public FeaturesAndMatchesDatabase {
   std::vector<std::pair<std::string, std::string>> ImageNamesOfMatches()
       override;
   size_t NumMatches() override;
+  bool ContainsImagePairMatch(const std::string& image_name1,
+                              const std::string& image_name2) override;
+  void ForEachMatchedImagePair(const ImagePairCallback& callback) override;
+  void ForEachImagePairMatch(const ImagePairMatchCallback& callback) override;
 
   bool ReadFromFile(const std::string& filepath);
   bool WriteToFile(const std::string& filepath);
 
   void RemoveAllMatches() override;
 
+  // The failed image pairs are only kept in memory and are not written by
+  // WriteToFile.
+  void PutFailedImagePair(const std::string& image_name1,
+                          const std::string& image_name2) override;
+  std::vector<std::pair<std::string, std::string>>
+  ImageNamesOfFailedImagePairs() override;
+  bool ContainsFailedImagePair(const std::string& image_name1,
+                               const std::string& image_name2) override;
+  void ForEachFailedImagePair(const ImagePairCallback& callback) override;
+
  private:
   DISALLOW_COPY_AND_ASSIGN(InMemoryFeaturesAndMatchesDatabase);
 
-  std::mutex mutex_;
+  // The number of shards of the features and matches. This is much larger
+  // than the number of threads that typically access the database, so that
+  // two threads rarely lock the same shard.
+  static const int kNumShards = 64;
+
+  struct FeaturesShard {
+    std::shared_timed_mutex mutex;
+    std::unordered_map<std::string,
+                       std::shared_ptr<const KeypointsAndDescriptors>>
+        features;
+  };
+
+  struct MatchesShard {
+    std::shared_timed_mutex mutex;
+    std::unordered_map<std::pair<std::string, std::string>, ImagePairMatch>
+        matches;
+    std::unordered_set<std::pair<std::string, std::string>>
+        failed_image_pairs;
+  };
+
+  FeaturesShard& FeaturesShardOfImage(const std::string& image_name) {
+    return features_shards_[std::hash<std::string>()(image_name) %
+                            kNumShards];
+  }
+
+  MatchesShard& MatchesShardOfImagePair(
+      const std::pair<std::string, std::string>& image_pair) {
+    return matches_shards_
+        [std::hash<std::pair<std::string, std::string>>()(image_pair) %
+         kNumShards];
+  }
+
+  // The intrinsics priors are only accessed when images are added, so they
+  // share a single lock.
+  std::shared_timed_mutex intrinsics_priors_mutex_;
   std::unordered_map<std::string, CameraIntrinsicsPrior> intrinsics_priors_;
-  std::unordered_map<std::string, KeypointsAndDescriptors> features_;
-  std::unordered_map<std::pair<std::string, std::string>, ImagePairMatch>
-      matches_;
+
+  std::array<FeaturesShard, kNumShards> features_shards_;
+  std::array<MatchesShard, kNumShards> matches_shards_;
 };
 }  // namespace theia
 #endif  // THEIA_MATCHING_IN_MEMORY_FEATURES_AND_MATCHES_DATABASE_H_
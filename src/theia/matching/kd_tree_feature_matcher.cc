@@ -0,0 +1,171 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#include "theia/matching/kd_tree_feature_matcher.h"
+
+#include <glog/logging.h>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "flann/flann.hpp"
+
+#include "theia/matching/feature_matcher_utils.h"
+#include "theia/matching/flann_simd_l2.h"
+#include "theia/matching/indexed_feature_match.h"
+#include "theia/matching/keypoints_and_descriptors.h"
+
+namespace theia {
+
+// The descriptors of an image and the KD-forest built over them. The index
+// refers to the descriptors so they are kept together.
+struct KdTreeFeatureMatcher::DescriptorIndex {
+  DescriptorMatrix descriptors;
+  std::unique_ptr<flann::Index<FlannSimdL2> > index;
+};
+
+KdTreeFeatureMatcher::KdTreeFeatureMatcher(
+    const FeatureMatcherOptions& options,
+    FeaturesAndMatchesDatabase* features_and_matches_database)
+    : FeatureMatcher(options, features_and_matches_database) {
+  CHECK_GT(this->options_.num_kd_trees, 0);
+  CHECK_GT(this->options_.num_kd_tree_checks, 0);
+  CHECK_GT(this->options_.kd_tree_index_cache_size, 0);
+}
+
+KdTreeFeatureMatcher::~KdTreeFeatureMatcher() {}
+
+std::shared_ptr<const KdTreeFeatureMatcher::DescriptorIndex>
+KdTreeFeatureMatcher::GetIndex(const KeypointsAndDescriptors& features) {
+  {
+    std::lock_guard<std::mutex> lock(index_cache_mutex_);
+    const auto it = index_cache_entries_.find(features.image_name);
+    if (it != index_cache_entries_.end()) {
+      // Move the entry to the front of the list as the most recently used.
+      index_cache_.splice(index_cache_.begin(), index_cache_, it->second);
+      return it->second->second;
+    }
+  }
+
+  std::shared_ptr<DescriptorIndex> index = std::make_shared<DescriptorIndex>();
+  DescriptorMatrix dequantized_descriptors;
+  index->descriptors = features.FloatDescriptors(&dequantized_descriptors);
+  const flann::Matrix<float> flann_descriptors(index->descriptors.data(),
+                                               index->descriptors.rows(),
+                                               index->descriptors.cols());
+  index->index.reset(new flann::Index<FlannSimdL2>(
+      flann_descriptors,
+      flann::KDTreeIndexParams(this->options_.num_kd_trees)));
+  index->index->buildIndex();
+
+  std::lock_guard<std::mutex> lock(index_cache_mutex_);
+  // Another thread may have built the same index in the meantime.
+  if (index_cache_entries_.count(features.image_name) == 0) {
+    index_cache_.emplace_front(features.image_name, index);
+    index_cache_entries_[features.image_name] = index_cache_.begin();
+    if (index_cache_.size() > this->options_.kd_tree_index_cache_size) {
+      index_cache_entries_.erase(index_cache_.back().first);
+      index_cache_.pop_back();
+    }
+  }
+  return index;
+}
+
+void KdTreeFeatureMatcher::FindMatches(
+    const KeypointsAndDescriptors& query_features,
+    const DescriptorIndex& index,
+    std::vector<IndexedFeatureMatch>* matches) const {
+  static const int kNumNearestNeighbors = 2;
+
+  // FLANN does not modify the query but only takes mutable pointers.
+  DescriptorMatrix dequantized_descriptors;
+  const DescriptorMatrix& query_descriptors =
+      query_features.FloatDescriptors(&dequantized_descriptors);
+  const flann::Matrix<float> flann_queries(
+      const_cast<float*>(query_descriptors.data()),
+      query_descriptors.rows(),
+      query_descriptors.cols());
+  std::vector<std::vector<int> > nn_indices;
+  std::vector<std::vector<float> > nn_distances;
+  index.index->knnSearch(flann_queries,
+                         nn_indices,
+                         nn_distances,
+                         kNumNearestNeighbors,
+                         flann::SearchParams(this->options_.num_kd_tree_checks));
+
+  std::vector<TopTwoNeighbors> neighbors(nn_indices.size());
+  for (int i = 0; i < nn_indices.size(); i++) {
+    for (int j = 0; j < nn_indices[i].size(); j++) {
+      if (nn_indices[i][j] >= 0) {
+        neighbors[i].Update(nn_distances[i][j], nn_indices[i][j]);
+      }
+    }
+  }
+
+  // The distances are squared so the ratio must be squared as well.
+  const float sq_lowes_ratio =
+      this->options_.lowes_ratio * this->options_.lowes_ratio;
+  matches->reserve(neighbors.size());
+  NeighborsToMatches(
+      neighbors, this->options_.use_lowes_ratio, sq_lowes_ratio, matches);
+}
+
+bool KdTreeFeatureMatcher::MatchImagePair(
+    const KeypointsAndDescriptors& features1,
+    const KeypointsAndDescriptors& features2,
+    std::vector<IndexedFeatureMatch>* matches) {
+  if (features1.NumDescriptors() == 0 || features2.NumDescriptors() == 0) {
+    return false;
+  }
+  CHECK_EQ(features1.DescriptorDimension(), features2.DescriptorDimension());
+
+  // Compute forward matches.
+  FindMatches(features1, *GetIndex(features2), matches);
+  if (matches->size() < this->options_.min_num_feature_matches) {
+    return false;
+  }
+
+  // Compute the symmetric matches, if applicable.
+  if (this->options_.keep_only_symmetric_matches) {
+    std::vector<IndexedFeatureMatch> reverse_matches;
+    FindMatches(features2, *GetIndex(features1), &reverse_matches);
+    IntersectMatches(reverse_matches, matches);
+  }
+
+  return matches->size() >= this->options_.min_num_feature_matches;
+}
+
+}  // namespace theia
@@ -0,0 +1,102 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#ifndef THEIA_MATCHING_KD_TREE_FEATURE_MATCHER_H_
+#define THEIA_MATCHING_KD_TREE_FEATURE_MATCHER_H_
+
+#include <list>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "theia/matching/feature_matcher.h"
+#include "theia/matching/features_and_matches_database.h"
+#include "theia/util/util.h"
+
+namespace theia {
+struct FeatureMatcherOptions;
+struct IndexedFeatureMatch;
+struct KeypointsAndDescriptors;
+
+// Performs approximate nearest neighbor matching of float descriptors with a
+// FLANN randomized KD-forest. Unlike cascade hashing, this makes no assumption
+// about the distribution of the descriptors so it applies to descriptors such
+// as RootSIFT or learned descriptors. The recall and speed are controlled with
+// the number of trees and the number of leaves checked per query. The index of
+// each image is kept in a small LRU cache so that it is built only once when an
+// image is matched against many partners.
+class KdTreeFeatureMatcher : public FeatureMatcher {
+ public:
+  KdTreeFeatureMatcher(
+      const FeatureMatcherOptions& options,
+      FeaturesAndMatchesDatabase* features_and_matches_database);
+  ~KdTreeFeatureMatcher();
+
+ private:
+  struct DescriptorIndex;
+
+  bool MatchImagePair(const KeypointsAndDescriptors& features1,
+                      const KeypointsAndDescriptors& features2,
+                      std::vector<IndexedFeatureMatch>* matches) override;
+
+  // Returns the index of the descriptors of the image, building it if it is not
+  // in the cache.
+  std::shared_ptr<const DescriptorIndex> GetIndex(
+      const KeypointsAndDescriptors& features);
+
+  // Finds the matches of the query descriptors in the index.
+  void FindMatches(const KeypointsAndDescriptors& query_features,
+                   const DescriptorIndex& index,
+                   std::vector<IndexedFeatureMatch>* matches) const;
+
+  // An LRU cache of the indices of the most recently matched images. Indices
+  // are built outside of the lock.
+  std::mutex index_cache_mutex_;
+  std::list<std::pair<std::string, std::shared_ptr<const DescriptorIndex> > >
+      index_cache_;
+  std::unordered_map<
+      std::string,
+      std::list<std::pair<std::string,
+                          std::shared_ptr<const DescriptorIndex> > >::iterator>
+      index_cache_entries_;
+
+  DISALLOW_COPY_AND_ASSIGN(KdTreeFeatureMatcher);
+};
+
+}  // namespace theia
+
+#endif  // THEIA_MATCHING_KD_TREE_FEATURE_MATCHER_H_
@@ -0,0 +1,164 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#include <Eigen/Core>
+#include <algorithm>
+#include <numeric>
+#include <vector>
+
+#include "theia/matching/feature_matcher_options.h"
+#include "theia/matching/image_pair_match.h"
+#include "theia/matching/in_memory_features_and_matches_database.h"
+#include "theia/matching/kd_tree_feature_matcher.h"
+#include "theia/matching/keypoints_and_descriptors.h"
+#include "theia/util/random.h"
+
+#include "gtest/gtest.h"
+
+namespace theia {
+
+namespace {
+
+static const int kNumDescriptorDimensions = 128;
+
+RandomNumberGenerator rng(61);
+
+void SetRandomDescriptors(const int num_descriptors,
+                          KeypointsAndDescriptors* features) {
+  features->descriptor_matrix.resize(num_descriptors,
+                                     kNumDescriptorDimensions);
+  for (int i = 0; i < num_descriptors; i++) {
+    for (int j = 0; j < kNumDescriptorDimensions; j++) {
+      features->descriptor_matrix(i, j) = rng.RandFloat(0.0, 1.0);
+    }
+    features->descriptor_matrix.row(i).normalize();
+    features->keypoints.emplace_back(i, i, Keypoint::OTHER);
+  }
+}
+
+}  // namespace
+
+TEST(KdTreeFeatureMatcherTest, FindsNoisyCopies) {
+  static const int kNumDescriptors = 500;
+  static const float kNoise = 0.01;
+
+  // The second image observes a shuffled and slightly perturbed copy of the
+  // descriptors of the first image.
+  KeypointsAndDescriptors features1, features2;
+  features1.image_name = "1";
+  features2.image_name = "2";
+  SetRandomDescriptors(kNumDescriptors, &features1);
+  std::vector<int> permutation(kNumDescriptors);
+  std::iota(permutation.begin(), permutation.end(), 0);
+  std::random_shuffle(permutation.begin(), permutation.end());
+  features2.descriptor_matrix.resize(kNumDescriptors, kNumDescriptorDimensions);
+  features2.keypoints.resize(kNumDescriptors);
+  for (int i = 0; i < kNumDescriptors; i++) {
+    features2.descriptor_matrix.row(permutation[i]) =
+        features1.descriptor_matrix.row(i);
+    for (int j = 0; j < kNumDescriptorDimensions; j++) {
+      features2.descriptor_matrix(permutation[i], j) +=
+          rng.RandFloat(-kNoise, kNoise);
+    }
+    features2.descriptor_matrix.row(permutation[i]).normalize();
+    features2.keypoints[permutation[i]] = Keypoint(i, 0, Keypoint::OTHER);
+  }
+
+  FeatureMatcherOptions options;
+  options.min_num_feature_matches = 0;
+  options.perform_geometric_verification = false;
+
+  InMemoryFeaturesAndMatchesDatabase database;
+  database.PutFeatures("1", features1);
+  database.PutFeatures("2", features2);
+  KdTreeFeatureMatcher matcher(options, &database);
+  matcher.AddImage("1");
+  matcher.AddImage("2");
+  matcher.MatchImages();
+
+  // The x coordinate of each keypoint is the index of the original descriptor,
+  // so correct matches have the same x coordinate.
+  ASSERT_EQ(database.NumMatches(), 1);
+  const ImagePairMatch match = database.GetImagePairMatch("1", "2");
+  EXPECT_GT(match.correspondences.size(), 0.95 * kNumDescriptors);
+  int num_correct_matches = 0;
+  for (const auto& correspondence : match.correspondences) {
+    if (correspondence.feature1.x() == correspondence.feature2.x()) {
+      ++num_correct_matches;
+    }
+  }
+  EXPECT_EQ(num_correct_matches, match.correspondences.size());
+}
+
+TEST(KdTreeFeatureMatcherTest, RatioTest) {
+  KeypointsAndDescriptors features1, features2;
+  features1.image_name = "1";
+  features2.image_name = "2";
+  SetRandomDescriptors(1, &features1);
+
+  // Two candidates that are almost equally close to the query do not pass the
+  // ratio test.
+  SetRandomDescriptors(2, &features2);
+  features2.descriptor_matrix.row(0) = features1.descriptor_matrix.row(0);
+  features2.descriptor_matrix(0, 0) += 0.1;
+  features2.descriptor_matrix.row(1) = features1.descriptor_matrix.row(0);
+  features2.descriptor_matrix(1, 1) += 0.1;
+
+  FeatureMatcherOptions options;
+  options.min_num_feature_matches = 1;
+  options.keep_only_symmetric_matches = false;
+  options.perform_geometric_verification = false;
+
+  InMemoryFeaturesAndMatchesDatabase database;
+  database.PutFeatures("1", features1);
+  database.PutFeatures("2", features2);
+  KdTreeFeatureMatcher matcher(options, &database);
+  matcher.AddImage("1");
+  matcher.AddImage("2");
+  matcher.MatchImages();
+  EXPECT_EQ(database.NumMatches(), 0);
+
+  // Without the ratio test the closest candidate is matched.
+  options.use_lowes_ratio = false;
+  InMemoryFeaturesAndMatchesDatabase database_without_ratio;
+  database_without_ratio.PutFeatures("1", features1);
+  database_without_ratio.PutFeatures("2", features2);
+  KdTreeFeatureMatcher matcher_without_ratio(options, &database_without_ratio);
+  matcher_without_ratio.AddImage("1");
+  matcher_without_ratio.AddImage("2");
+  matcher_without_ratio.MatchImages();
+  EXPECT_EQ(database_without_ratio.NumMatches(), 1);
+}
+
+}  // namespace theia
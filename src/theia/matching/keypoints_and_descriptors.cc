@@ -0,0 +1,108 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#include "theia/matching/keypoints_and_descriptors.h"
+
+#include <Eigen/Core>
+#include <glog/logging.h>
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace theia {
+
+void KeypointsAndDescriptors::QuantizeDescriptors(const float scale) {
+  CHECK_GT(scale, 0.0f);
+  quantized_descriptor_matrix.resize(descriptor_matrix.rows(),
+                                     descriptor_matrix.cols());
+  for (int i = 0; i < descriptor_matrix.rows(); i++) {
+    for (int j = 0; j < descriptor_matrix.cols(); j++) {
+      const float value = std::round(descriptor_matrix(i, j) * scale);
+      quantized_descriptor_matrix(i, j) =
+          static_cast<uint8_t>(std::min(std::max(value, 0.0f), 255.0f));
+    }
+  }
+  descriptor_quantization_scale = scale;
+  descriptor_matrix.resize(0, 0);
+}
+
+const DescriptorMatrix& KeypointsAndDescriptors::FloatDescriptors(
+    DescriptorMatrix* buffer) const {
+  if (!HasOnlyQuantizedDescriptors()) {
+    return descriptor_matrix;
+  }
+  *CHECK_NOTNULL(buffer) = quantized_descriptor_matrix.cast<float>() /
+                           descriptor_quantization_scale;
+  return *buffer;
+}
+
+Eigen::RowVectorXf KeypointsAndDescriptors::FloatDescriptor(const int i) const {
+  if (!HasOnlyQuantizedDescriptors()) {
+    return descriptor_matrix.row(i);
+  }
+  return quantized_descriptor_matrix.row(i).cast<float>() /
+         descriptor_quantization_scale;
+}
+
+size_t KeypointsAndDescriptors::SizeInBytes() const {
+  return sizeof(*this) + image_name.capacity() +
+         keypoints.capacity() * sizeof(Keypoint) +
+         descriptor_matrix.size() * sizeof(float) +
+         binary_descriptor_matrix.size() + quantized_descriptor_matrix.size();
+}
+
+std::vector<Eigen::VectorXf> KeypointsAndDescriptors::GetDescriptors() const {
+  std::vector<Eigen::VectorXf> descriptors(NumDescriptors());
+  for (int i = 0; i < descriptors.size(); i++) {
+    descriptors[i] = FloatDescriptor(i).transpose();
+  }
+  return descriptors;
+}
+
+void KeypointsAndDescriptors::SetDescriptors(
+    const std::vector<Eigen::VectorXf>& descriptors) {
+  quantized_descriptor_matrix.resize(0, 0);
+  if (descriptors.empty()) {
+    descriptor_matrix.resize(0, 0);
+    return;
+  }
+
+  descriptor_matrix.resize(descriptors.size(), descriptors[0].size());
+  for (int i = 0; i < descriptors.size(); i++) {
+    DCHECK_EQ(descriptors[i].size(), descriptor_matrix.cols());
+    descriptor_matrix.row(i) = descriptors[i].transpose();
+  }
+}
+
+}  // namespace theia
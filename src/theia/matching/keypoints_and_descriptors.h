@@ -36,21 +36,126 @@
 #define THEIA_MATCHING_KEYPOINTS_AND_DESCRIPTORS_H_
 
 #include <Eigen/Core>
+#include <cereal/access.hpp>
+#include <cereal/cereal.hpp>
+#include <cereal/types/string.hpp>
+#include <cereal/types/vector.hpp>
+#include <stdint.h>
 #include <string>
 #include <vector>
 
 #include "theia/image/keypoint_detector/keypoint.h"
+#include "theia/io/eigen_serializable.h"
+#include "theia/matching/descriptor_types.h"
 
 namespace theia {
 
+// SIFT (and RootSIFT) descriptors are unit-norm and non-negative, and their
+// components rarely exceed 0.5. Scaling by 512 (as VLFeat and COLMAP do) maps
+// them into a byte with negligible loss in matching accuracy.
+static const float kDefaultDescriptorQuantizationScale = 512.0f;
+
+// Lowe's SIFT key files store each descriptor dimension as a byte, which the
+// key file readers map to [0, 1] by dividing by 255.
+static const float kSiftKeyFileDescriptorQuantizationScale = 255.0f;
+
 // This struct is used by the internal cache to hold keypoints and descriptors
-// when the are retrieved from the cache.
+// when the are retrieved from the cache. An image holds either float
+// descriptors (e.g. SIFT) in descriptor_matrix or bit-packed binary
+// descriptors (e.g. AKAZE MLDB) in binary_descriptor_matrix. Float descriptors
+// may be quantized into quantized_descriptor_matrix, which releases the float
+// descriptors and cuts their memory and storage by 4x.
 struct KeypointsAndDescriptors {
   std::string image_name;
   std::vector<Keypoint> keypoints;
-  std::vector<Eigen::VectorXf> descriptors;
+  DescriptorMatrix descriptor_matrix;
+  BinaryDescriptorMatrix binary_descriptor_matrix;
+  QuantizedDescriptorMatrix quantized_descriptor_matrix;
+  float descriptor_quantization_scale = 0.0f;
+
+  // The number of descriptors and the dimension of each descriptor. These
+  // describe the quantized descriptors if only those are stored.
+  int NumDescriptors() const {
+    return HasOnlyQuantizedDescriptors() ? quantized_descriptor_matrix.rows()
+                                         : descriptor_matrix.rows();
+  }
+  int DescriptorDimension() const {
+    return HasOnlyQuantizedDescriptors() ? quantized_descriptor_matrix.cols()
+                                         : descriptor_matrix.cols();
+  }
+
+  // The number of binary descriptors and the length of each in bytes.
+  int NumBinaryDescriptors() const { return binary_descriptor_matrix.rows(); }
+  int BinaryDescriptorSizeInBytes() const {
+    return binary_descriptor_matrix.cols();
+  }
+  bool HasBinaryDescriptors() const {
+    return binary_descriptor_matrix.rows() > 0;
+  }
+
+  bool HasQuantizedDescriptors() const {
+    return quantized_descriptor_matrix.rows() > 0;
+  }
+  bool HasOnlyQuantizedDescriptors() const {
+    return HasQuantizedDescriptors() && descriptor_matrix.rows() == 0;
+  }
+
+  // Returns a pointer to the bytes of the i-th quantized descriptor.
+  const uint8_t* QuantizedDescriptor(const int i) const {
+    return quantized_descriptor_matrix.row(i).data();
+  }
+
+  // Quantizes the float descriptors with the given scale and releases them.
+  // The descriptors must be non-negative (e.g. SIFT); larger values saturate.
+  void QuantizeDescriptors(
+      const float scale = kDefaultDescriptorQuantizationScale);
+
+  // Returns the float descriptors. If only quantized descriptors are stored,
+  // they are dequantized into buffer and a reference to buffer is returned.
+  // This allows matchers that require float descriptors to read both.
+  const DescriptorMatrix& FloatDescriptors(DescriptorMatrix* buffer) const;
+
+  // Returns the i-th descriptor as floats, dequantizing it if needed.
+  Eigen::RowVectorXf FloatDescriptor(const int i) const;
+
+  // An estimate of the memory used by the keypoints and descriptors.
+  size_t SizeInBytes() const;
+
+  // Returns a pointer to the bytes of the i-th binary descriptor.
+  const uint8_t* BinaryDescriptor(const int i) const {
+    return binary_descriptor_matrix.row(i).data();
+  }
+
+  // Returns a (non-owning) column vector view of the i-th descriptor.
+  Eigen::Map<const Eigen::VectorXf> Descriptor(const int i) const {
+    return Eigen::Map<const Eigen::VectorXf>(descriptor_matrix.row(i).data(),
+                                             descriptor_matrix.cols());
+  }
+
+  // Compatibility accessors for callers that work with one vector per
+  // descriptor. These copy the descriptors so they should not be used in
+  // performance critical code. Quantized descriptors are dequantized.
+  std::vector<Eigen::VectorXf> GetDescriptors() const;
+  void SetDescriptors(const std::vector<Eigen::VectorXf>& descriptors);
+
+ private:
+  // Templated method for disk I/O with cereal. This method tells cereal which
+  // data members should be used when reading/writing to/from disk.
+  friend class cereal::access;
+  template <class Archive>
+  void serialize(Archive& ar, const std::uint32_t version) {  // NOLINT
+    ar(image_name, keypoints, descriptor_matrix);
+    if (version > 0) {
+      ar(binary_descriptor_matrix);
+    }
+    if (version > 1) {
+      ar(quantized_descriptor_matrix, descriptor_quantization_scale);
+    }
+  }
 };
 
 }  // namespace theia
 
+CEREAL_CLASS_VERSION(theia::KeypointsAndDescriptors, 2);
+
 #endif  // THEIA_MATCHING_KEYPOINTS_AND_DESCRIPTORS_H_
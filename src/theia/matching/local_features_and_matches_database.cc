@@ -108,7 +108,7 @@ void LocalFeaturesAndMatchesDatabase::PutFeatures(
   const std::string features_file =
       FeatureFilenameFromImage(directory_, image_name);
   CHECK(WriteKeypointsAndDescriptors(
-      features_file, features.keypoints, features.descriptors))
+      features_file, features.keypoints, features.GetDescriptors()))
       << "Could not write features for image " << image_name << " to file "
       << features_file;
   image_names_.insert(image_name);
@@ -158,10 +158,12 @@ void LocalFeaturesAndMatchesDatabase::PutImagePairMatch(
 KeypointsAndDescriptors LocalFeaturesAndMatchesDatabase::FetchImages(
     const std::string& image_name) {
   KeypointsAndDescriptors features;
+  std::vector<Eigen::VectorXf> descriptors;
   CHECK(ReadKeypointsAndDescriptors(
       FeatureFilenameFromImage(directory_, image_name),
       &features.keypoints,
-      &features.descriptors));
+      &descriptors));
+  features.SetDescriptors(descriptors);
   features.image_name = image_name;
   return features;
 }
@@ -0,0 +1,207 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#include "theia/matching/lsh_feature_matcher.h"
+
+#include <glog/logging.h>
+#include <stdint.h>
+#include <algorithm>
+#include <unordered_map>
+#include <vector>
+
+#include "theia/matching/distance.h"
+#include "theia/matching/feature_matcher_utils.h"
+#include "theia/matching/indexed_feature_match.h"
+#include "theia/matching/keypoints_and_descriptors.h"
+#include "theia/util/random.h"
+
+namespace theia {
+namespace {
+
+// The bits sampled by the hash tables are drawn with a fixed seed so that all
+// images are hashed the same way.
+static const unsigned kHashBitsSeed = 53;
+static const int kMaxKeySizeInBits = 32;
+
+typedef std::unordered_map<uint32_t, std::vector<int> > HashTable;
+
+uint32_t ComputeHashKey(const uint8_t* descriptor,
+                        const std::vector<int>& hash_bits) {
+  uint32_t key = 0;
+  for (int i = 0; i < hash_bits.size(); i++) {
+    const int bit = hash_bits[i];
+    key |= static_cast<uint32_t>((descriptor[bit >> 3] >> (bit & 7)) & 1) << i;
+  }
+  return key;
+}
+
+// Buckets all descriptors of the image into each hash table.
+std::vector<HashTable> BuildHashTables(
+    const KeypointsAndDescriptors& features,
+    const std::vector<std::vector<int> >& hash_bits) {
+  std::vector<HashTable> hash_tables(hash_bits.size());
+  for (int t = 0; t < hash_bits.size(); t++) {
+    hash_tables[t].reserve(features.NumBinaryDescriptors());
+    for (int i = 0; i < features.NumBinaryDescriptors(); i++) {
+      hash_tables[t][ComputeHashKey(features.BinaryDescriptor(i),
+                                    hash_bits[t])]
+          .emplace_back(i);
+    }
+  }
+  return hash_tables;
+}
+
+// Finds the two nearest neighbors of each query descriptor among the database
+// descriptors that share at least one bucket with it.
+void FindNearestNeighbors(const KeypointsAndDescriptors& query_features,
+                          const KeypointsAndDescriptors& database_features,
+                          const std::vector<HashTable>& database_hash_tables,
+                          const std::vector<std::vector<int> >& hash_bits,
+                          std::vector<TopTwoNeighbors>* neighbors) {
+  const int num_bytes = query_features.BinaryDescriptorSizeInBytes();
+  Hamming distance;
+
+  // The last query that each database descriptor was compared to. This avoids
+  // computing the distance twice when a candidate is found in multiple tables.
+  std::vector<int> last_query(database_features.NumBinaryDescriptors(), -1);
+
+  neighbors->resize(query_features.NumBinaryDescriptors());
+  for (int i = 0; i < query_features.NumBinaryDescriptors(); i++) {
+    const uint8_t* query_descriptor = query_features.BinaryDescriptor(i);
+    for (int t = 0; t < hash_bits.size(); t++) {
+      const auto& bucket = database_hash_tables[t].find(
+          ComputeHashKey(query_descriptor, hash_bits[t]));
+      if (bucket == database_hash_tables[t].end()) {
+        continue;
+      }
+
+      for (const int candidate : bucket->second) {
+        if (last_query[candidate] == i) {
+          continue;
+        }
+        last_query[candidate] = i;
+        const float hamming_distance = static_cast<float>(
+            distance(query_descriptor,
+                     database_features.BinaryDescriptor(candidate),
+                     num_bytes));
+        (*neighbors)[i].Update(hamming_distance, candidate);
+      }
+    }
+  }
+}
+
+}  // namespace
+
+LshFeatureMatcher::LshFeatureMatcher(
+    const FeatureMatcherOptions& options,
+    FeaturesAndMatchesDatabase* features_and_matches_database)
+    : FeatureMatcher(options, features_and_matches_database) {
+  CHECK_GT(this->options_.num_lsh_tables, 0);
+  CHECK_GT(this->options_.lsh_key_size_in_bits, 0);
+  CHECK_LE(this->options_.lsh_key_size_in_bits, kMaxKeySizeInBits);
+}
+
+std::vector<std::vector<int> > LshFeatureMatcher::SampleHashBits(
+    const int num_bits) const {
+  RandomNumberGenerator rng(kHashBitsSeed);
+  const int key_size = std::min(this->options_.lsh_key_size_in_bits, num_bits);
+
+  std::vector<std::vector<int> > hash_bits(this->options_.num_lsh_tables);
+  std::vector<int> bits(num_bits);
+  for (int i = 0; i < num_bits; i++) {
+    bits[i] = i;
+  }
+  for (std::vector<int>& table_bits : hash_bits) {
+    // Sample the key bits without replacement with a partial shuffle.
+    for (int i = 0; i < key_size; i++) {
+      std::swap(bits[i], bits[rng.RandInt(i, num_bits - 1)]);
+    }
+    table_bits.assign(bits.begin(), bits.begin() + key_size);
+  }
+  return hash_bits;
+}
+
+bool LshFeatureMatcher::MatchImagePair(
+    const KeypointsAndDescriptors& features1,
+    const KeypointsAndDescriptors& features2,
+    std::vector<IndexedFeatureMatch>* matches) {
+  if (!features1.HasBinaryDescriptors() || !features2.HasBinaryDescriptors()) {
+    LOG(ERROR) << "LSH matching requires binary descriptors. No binary "
+                  "descriptors were found for "
+               << features1.image_name << " or " << features2.image_name;
+    return false;
+  }
+  CHECK_EQ(features1.BinaryDescriptorSizeInBytes(),
+           features2.BinaryDescriptorSizeInBytes());
+
+  const std::vector<std::vector<int> > hash_bits =
+      SampleHashBits(8 * features1.BinaryDescriptorSizeInBytes());
+  // Hamming distances are not squared so the ratio is used as is.
+  const float lowes_ratio = this->options_.lowes_ratio;
+
+  // Compute forward matches.
+  std::vector<TopTwoNeighbors> forward_neighbors;
+  FindNearestNeighbors(features1,
+                       features2,
+                       BuildHashTables(features2, hash_bits),
+                       hash_bits,
+                       &forward_neighbors);
+  matches->reserve(features1.NumBinaryDescriptors());
+  NeighborsToMatches(
+      forward_neighbors, this->options_.use_lowes_ratio, lowes_ratio, matches);
+  if (matches->size() < this->options_.min_num_feature_matches) {
+    return false;
+  }
+
+  // Compute the symmetric matches, if applicable.
+  if (this->options_.keep_only_symmetric_matches) {
+    std::vector<TopTwoNeighbors> reverse_neighbors;
+    FindNearestNeighbors(features2,
+                         features1,
+                         BuildHashTables(features1, hash_bits),
+                         hash_bits,
+                         &reverse_neighbors);
+    std::vector<IndexedFeatureMatch> reverse_matches;
+    reverse_matches.reserve(features2.NumBinaryDescriptors());
+    NeighborsToMatches(reverse_neighbors,
+                       this->options_.use_lowes_ratio,
+                       lowes_ratio,
+                       &reverse_matches);
+    IntersectMatches(reverse_matches, matches);
+  }
+
+  return matches->size() >= this->options_.min_num_feature_matches;
+}
+
+}  // namespace theia
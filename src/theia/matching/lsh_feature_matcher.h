@@ -0,0 +1,75 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#ifndef THEIA_MATCHING_LSH_FEATURE_MATCHER_H_
+#define THEIA_MATCHING_LSH_FEATURE_MATCHER_H_
+
+#include <vector>
+
+#include "theia/matching/feature_matcher.h"
+#include "theia/matching/features_and_matches_database.h"
+#include "theia/util/util.h"
+
+namespace theia {
+struct FeatureMatcherOptions;
+struct IndexedFeatureMatch;
+struct KeypointsAndDescriptors;
+
+// Performs feature matching between bit-packed binary descriptors (e.g. AKAZE
+// MLDB) with bit-sampling locality sensitive hashing. Each hash table keys the
+// descriptors by a fixed random subset of their bits, and a query is only
+// compared (by its Hamming distance) to the descriptors that fall into the same
+// bucket in at least one table. The sampled bits are the same for all images so
+// that results are deterministic.
+class LshFeatureMatcher : public FeatureMatcher {
+ public:
+  LshFeatureMatcher(const FeatureMatcherOptions& options,
+                    FeaturesAndMatchesDatabase* features_and_matches_database);
+  ~LshFeatureMatcher() {}
+
+ private:
+  bool MatchImagePair(const KeypointsAndDescriptors& features1,
+                      const KeypointsAndDescriptors& features2,
+                      std::vector<IndexedFeatureMatch>* matches) override;
+
+  // Returns the bits sampled by each hash table for descriptors with num_bits
+  // bits.
+  std::vector<std::vector<int> > SampleHashBits(const int num_bits) const;
+
+  DISALLOW_COPY_AND_ASSIGN(LshFeatureMatcher);
+};
+
+}  // namespace theia
+
+#endif  // THEIA_MATCHING_LSH_FEATURE_MATCHER_H_
@@ -0,0 +1,130 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#include <stdint.h>
+#include <vector>
+
+#include "theia/matching/feature_matcher_options.h"
+#include "theia/matching/image_pair_match.h"
+#include "theia/matching/in_memory_features_and_matches_database.h"
+#include "theia/matching/keypoints_and_descriptors.h"
+#include "theia/matching/lsh_feature_matcher.h"
+#include "theia/util/random.h"
+
+#include "gtest/gtest.h"
+
+namespace theia {
+
+namespace {
+
+// AKAZE MLDB descriptors are 486 bits long.
+static const int kNumBytes = 61;
+
+RandomNumberGenerator rng(59);
+
+void SetRandomBinaryDescriptors(const int num_descriptors,
+                                KeypointsAndDescriptors* features) {
+  features->binary_descriptor_matrix.resize(num_descriptors, kNumBytes);
+  for (int i = 0; i < num_descriptors; i++) {
+    for (int j = 0; j < kNumBytes; j++) {
+      features->binary_descriptor_matrix(i, j) =
+          static_cast<uint8_t>(rng.RandInt(0, 255));
+    }
+    features->keypoints.emplace_back(i, i, Keypoint::AKAZE);
+  }
+}
+
+}  // namespace
+
+// Image 2 holds noisy copies of the descriptors of image 1 so the true matches
+// are known.
+TEST(LshFeatureMatcherTest, RecoversNoisyCopies) {
+  static const int kNumDescriptors = 200;
+  static const int kNumFlippedBits = 20;
+
+  KeypointsAndDescriptors features1, features2;
+  SetRandomBinaryDescriptors(kNumDescriptors, &features1);
+  features2 = features1;
+  for (int i = 0; i < kNumDescriptors; i++) {
+    for (int k = 0; k < kNumFlippedBits; k++) {
+      const int bit = rng.RandInt(0, 8 * kNumBytes - 1);
+      features2.binary_descriptor_matrix(i, bit / 8) ^= 1 << (bit % 8);
+    }
+  }
+
+  FeatureMatcherOptions options;
+  options.min_num_feature_matches = 0;
+  options.keep_only_symmetric_matches = true;
+  options.use_lowes_ratio = true;
+  options.perform_geometric_verification = false;
+
+  InMemoryFeaturesAndMatchesDatabase database;
+  database.PutFeatures("1", features1);
+  database.PutFeatures("2", features2);
+  LshFeatureMatcher matcher(options, &database);
+  matcher.AddImage("1");
+  matcher.AddImage("2");
+  matcher.MatchImages();
+
+  // Nearly all descriptors must be matched to their own copy.
+  ASSERT_EQ(database.NumMatches(), 1);
+  const ImagePairMatch match = database.GetImagePairMatch("1", "2");
+  EXPECT_GT(match.correspondences.size(), 0.9 * kNumDescriptors);
+  for (const FeatureCorrespondence& correspondence : match.correspondences) {
+    EXPECT_EQ(correspondence.feature1.point_, correspondence.feature2.point_);
+  }
+}
+
+// Float descriptors cannot be matched with LSH.
+TEST(LshFeatureMatcherTest, FloatDescriptorsAreNotMatched) {
+  KeypointsAndDescriptors features1, features2;
+  features1.descriptor_matrix.setOnes(10, 8);
+  features1.keypoints.resize(10);
+  features2 = features1;
+
+  FeatureMatcherOptions options;
+  options.min_num_feature_matches = 0;
+  options.perform_geometric_verification = false;
+
+  InMemoryFeaturesAndMatchesDatabase database;
+  database.PutFeatures("1", features1);
+  database.PutFeatures("2", features2);
+  LshFeatureMatcher matcher(options, &database);
+  matcher.AddImage("1");
+  matcher.AddImage("2");
+  matcher.MatchImages();
+  EXPECT_EQ(database.NumMatches(), 0);
+}
+
+}  // namespace theia
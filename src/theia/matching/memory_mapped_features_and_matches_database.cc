@@ -0,0 +1,416 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#include "theia/matching/memory_mapped_features_and_matches_database.h"
+
+#include <glog/logging.h>
+#include <cstring>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <string>
+#include <vector>
+
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+#include "theia/image/keypoint_detector/keypoint.h"
+#include "theia/matching/keypoints_and_descriptors.h"
+#include "theia/util/filesystem.h"
+#include "theia/util/map_util.h"
+#include "theia/util/mapped_file.h"
+
+namespace theia {
+
+namespace {
+
+// Records and descriptor blocks start at multiples of this many bytes so that
+// the descriptors in the mapping are aligned for vector loads.
+static const uint64_t kRecordAlignment = 64;
+static const uint32_t kRecordMagic = 0x544D4654;  // "TFMT"
+static const uint32_t kRecordVersion = 1;
+
+// The fixed header of the features of one image. It is followed by the image
+// name, the keypoints and the float, binary and quantized descriptor blocks,
+// each padded to kRecordAlignment bytes.
+struct RecordHeader {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t image_name_length;
+  uint32_t num_keypoints;
+  uint32_t num_float_descriptors;
+  uint32_t float_descriptor_dimension;
+  uint32_t num_binary_descriptors;
+  uint32_t binary_descriptor_size_in_bytes;
+  uint32_t num_quantized_descriptors;
+  uint32_t quantized_descriptor_dimension;
+  float descriptor_quantization_scale;
+  uint32_t reserved;
+  uint64_t payload_size;
+  uint64_t reserved2;
+};
+static_assert(sizeof(RecordHeader) == kRecordAlignment,
+              "The record header must fill exactly one aligned block.");
+
+// The flat layout of a keypoint.
+struct FlatKeypoint {
+  double x;
+  double y;
+  double strength;
+  double scale;
+  double orientation;
+  int32_t keypoint_type;
+  int32_t reserved;
+};
+static_assert(sizeof(FlatKeypoint) == 48, "Unexpected keypoint padding.");
+
+uint64_t AlignUp(const uint64_t value) {
+  return (value + kRecordAlignment - 1) / kRecordAlignment * kRecordAlignment;
+}
+
+// The sizes of the blocks that follow the record header.
+struct RecordLayout {
+  uint64_t image_name_offset;
+  uint64_t keypoints_offset;
+  uint64_t float_descriptors_offset;
+  uint64_t binary_descriptors_offset;
+  uint64_t quantized_descriptors_offset;
+  uint64_t size;
+};
+
+RecordLayout ComputeRecordLayout(const RecordHeader& header) {
+  RecordLayout layout;
+  layout.image_name_offset = sizeof(RecordHeader);
+  layout.keypoints_offset =
+      AlignUp(layout.image_name_offset + header.image_name_length);
+  layout.float_descriptors_offset =
+      AlignUp(layout.keypoints_offset +
+              static_cast<uint64_t>(header.num_keypoints) *
+                  sizeof(FlatKeypoint));
+  layout.binary_descriptors_offset =
+      AlignUp(layout.float_descriptors_offset +
+              static_cast<uint64_t>(header.num_float_descriptors) *
+                  header.float_descriptor_dimension * sizeof(float));
+  layout.quantized_descriptors_offset =
+      AlignUp(layout.binary_descriptors_offset +
+              static_cast<uint64_t>(header.num_binary_descriptors) *
+                  header.binary_descriptor_size_in_bytes);
+  layout.size = AlignUp(layout.quantized_descriptors_offset +
+                        static_cast<uint64_t>(header.num_quantized_descriptors) *
+                            header.quantized_descriptor_dimension);
+  return layout;
+}
+
+// Serializes the features into a single record.
+std::vector<char> CreateRecord(const std::string& image_name,
+                               const KeypointsAndDescriptors& features) {
+  RecordHeader header;
+  memset(&header, 0, sizeof(header));
+  header.magic = kRecordMagic;
+  header.version = kRecordVersion;
+  header.image_name_length = image_name.size();
+  header.num_keypoints = features.keypoints.size();
+  header.num_float_descriptors = features.descriptor_matrix.rows();
+  header.float_descriptor_dimension = features.descriptor_matrix.cols();
+  header.num_binary_descriptors = features.binary_descriptor_matrix.rows();
+  header.binary_descriptor_size_in_bytes =
+      features.binary_descriptor_matrix.cols();
+  header.num_quantized_descriptors =
+      features.quantized_descriptor_matrix.rows();
+  header.quantized_descriptor_dimension =
+      features.quantized_descriptor_matrix.cols();
+  header.descriptor_quantization_scale = features.descriptor_quantization_scale;
+
+  const RecordLayout layout = ComputeRecordLayout(header);
+  header.payload_size = layout.size - sizeof(RecordHeader);
+
+  // The padding between the blocks stays zero.
+  std::vector<char> record(layout.size, 0);
+  memcpy(record.data(), &header, sizeof(header));
+  memcpy(record.data() + layout.image_name_offset,
+         image_name.data(),
+         image_name.size());
+
+  FlatKeypoint* keypoints =
+      reinterpret_cast<FlatKeypoint*>(record.data() + layout.keypoints_offset);
+  for (int i = 0; i < features.keypoints.size(); i++) {
+    const Keypoint& keypoint = features.keypoints[i];
+    keypoints[i].x = keypoint.x();
+    keypoints[i].y = keypoint.y();
+    keypoints[i].strength = keypoint.strength();
+    keypoints[i].scale = keypoint.scale();
+    keypoints[i].orientation = keypoint.orientation();
+    keypoints[i].keypoint_type = keypoint.keypoint_type();
+    keypoints[i].reserved = 0;
+  }
+
+  // The matrices are row-major so each block is a single copy.
+  memcpy(record.data() + layout.float_descriptors_offset,
+         features.descriptor_matrix.data(),
+         features.descriptor_matrix.size() * sizeof(float));
+  memcpy(record.data() + layout.binary_descriptors_offset,
+         features.binary_descriptor_matrix.data(),
+         features.binary_descriptor_matrix.size());
+  memcpy(record.data() + layout.quantized_descriptors_offset,
+         features.quantized_descriptor_matrix.data(),
+         features.quantized_descriptor_matrix.size());
+  return record;
+}
+
+// Copies the features out of a record. Only the image name and keypoints are
+// copied unless read_descriptors is true.
+KeypointsAndDescriptors ReadRecord(const char* record,
+                                   const uint64_t record_size,
+                                   const bool read_descriptors) {
+  RecordHeader header;
+  memcpy(&header, record, sizeof(header));
+  CHECK_EQ(header.magic, kRecordMagic) << "Corrupted features record.";
+  CHECK_EQ(header.version, kRecordVersion)
+      << "Unsupported features record version.";
+  const RecordLayout layout = ComputeRecordLayout(header);
+  CHECK_EQ(layout.size, record_size) << "Corrupted features record.";
+
+  KeypointsAndDescriptors features;
+  features.image_name.assign(record + layout.image_name_offset,
+                             header.image_name_length);
+
+  const FlatKeypoint* keypoints =
+      reinterpret_cast<const FlatKeypoint*>(record + layout.keypoints_offset);
+  features.keypoints.reserve(header.num_keypoints);
+  for (int i = 0; i < header.num_keypoints; i++) {
+    features.keypoints.emplace_back(
+        keypoints[i].x,
+        keypoints[i].y,
+        static_cast<Keypoint::KeypointType>(keypoints[i].keypoint_type));
+    Keypoint& keypoint = features.keypoints.back();
+    keypoint.set_strength(keypoints[i].strength);
+    keypoint.set_scale(keypoints[i].scale);
+    keypoint.set_orientation(keypoints[i].orientation);
+  }
+  if (!read_descriptors) {
+    return features;
+  }
+
+  features.descriptor_matrix.resize(header.num_float_descriptors,
+                                    header.float_descriptor_dimension);
+  memcpy(features.descriptor_matrix.data(),
+         record + layout.float_descriptors_offset,
+         features.descriptor_matrix.size() * sizeof(float));
+  features.binary_descriptor_matrix.resize(
+      header.num_binary_descriptors, header.binary_descriptor_size_in_bytes);
+  memcpy(features.binary_descriptor_matrix.data(),
+         record + layout.binary_descriptors_offset,
+         features.binary_descriptor_matrix.size());
+  features.quantized_descriptor_matrix.resize(
+      header.num_quantized_descriptors, header.quantized_descriptor_dimension);
+  memcpy(features.quantized_descriptor_matrix.data(),
+         record + layout.quantized_descriptors_offset,
+         features.quantized_descriptor_matrix.size());
+  features.descriptor_quantization_scale = header.descriptor_quantization_scale;
+  return features;
+}
+
+}  // namespace
+
+MemoryMappedFeaturesAndMatchesDatabase::MemoryMappedFeaturesAndMatchesDatabase(
+    const std::string& directory)
+    : features_filepath_(directory + "/features.bin"),
+      index_filepath_(directory + "/features_index.bin") {
+  if (!DirectoryExists(directory)) {
+    CHECK(CreateNewDirectory(directory))
+        << "Could not create the directory " << directory;
+  }
+
+  // The files are opened for appending so that all writes go to the end.
+  features_file_ = fopen(features_filepath_.c_str(), "ab");
+  CHECK(features_file_ != nullptr)
+      << "Could not open " << features_filepath_ << " for writing.";
+  CHECK_EQ(fseek(features_file_, 0, SEEK_END), 0);
+  features_file_size_ = ftell(features_file_);
+
+  ReadIndex();
+  index_file_ = fopen(index_filepath_.c_str(), "ab");
+  CHECK(index_file_ != nullptr)
+      << "Could not open " << index_filepath_ << " for writing.";
+
+  mapping_ = std::make_shared<const MappedFile>(features_filepath_,
+                                                features_file_size_);
+}
+
+MemoryMappedFeaturesAndMatchesDatabase::
+    ~MemoryMappedFeaturesAndMatchesDatabase() {
+  mapping_.reset();
+  fclose(index_file_);
+  fclose(features_file_);
+}
+
+void MemoryMappedFeaturesAndMatchesDatabase::ReadIndex() {
+  FILE* index_file = fopen(index_filepath_.c_str(), "rb");
+  if (index_file == nullptr) {
+    return;
+  }
+
+  // Each entry is the length of the image name, the image name and the
+  // record. A crash while writing may leave a truncated entry at the end, or
+  // an entry for a record that did not reach the features file.
+  uint32_t image_name_length;
+  while (fread(&image_name_length, sizeof(image_name_length), 1, index_file) ==
+         1) {
+    std::string image_name(image_name_length, '\0');
+    Record record;
+    if (fread(&image_name[0], 1, image_name_length, index_file) !=
+            image_name_length ||
+        fread(&record, sizeof(record), 1, index_file) != 1) {
+      LOG(WARNING) << "Ignoring a truncated entry at the end of "
+                   << index_filepath_;
+      break;
+    }
+    if (record.offset + record.size > features_file_size_) {
+      LOG(WARNING) << "Ignoring the incomplete features record of image "
+                   << image_name;
+      continue;
+    }
+    records_[image_name] = record;
+  }
+  fclose(index_file);
+}
+
+std::shared_ptr<const MappedFile>
+MemoryMappedFeaturesAndMatchesDatabase::MappingForRecord(const Record& record) {
+  std::lock_guard<std::mutex> lock(features_mutex_);
+  if (mapping_->size() < record.offset + record.size) {
+    mapping_ = std::make_shared<const MappedFile>(features_filepath_,
+                                                  features_file_size_);
+  }
+  return mapping_;
+}
+
+bool MemoryMappedFeaturesAndMatchesDatabase::ContainsFeatures(
+    const std::string& image_name) {
+  std::lock_guard<std::mutex> lock(features_mutex_);
+  return ContainsKey(records_, image_name);
+}
+
+KeypointsAndDescriptors MemoryMappedFeaturesAndMatchesDatabase::GetFeatures(
+    const std::string& image_name) {
+  Record record;
+  {
+    std::lock_guard<std::mutex> lock(features_mutex_);
+    record = FindOrDie(records_, image_name);
+  }
+  // The features are copied out of the mapping without holding the lock.
+  const std::shared_ptr<const MappedFile> mapping = MappingForRecord(record);
+  return ReadRecord(mapping->data() + record.offset, record.size, true);
+}
+
+std::vector<Keypoint> MemoryMappedFeaturesAndMatchesDatabase::GetKeypoints(
+    const std::string& image_name) {
+  Record record;
+  {
+    std::lock_guard<std::mutex> lock(features_mutex_);
+    record = FindOrDie(records_, image_name);
+  }
+  const std::shared_ptr<const MappedFile> mapping = MappingForRecord(record);
+  return ReadRecord(mapping->data() + record.offset, record.size, false)
+      .keypoints;
+}
+
+std::shared_ptr<const KeypointsAndDescriptors>
+MemoryMappedFeaturesAndMatchesDatabase::GetSharedFeatures(
+    const std::string& image_name) {
+  return std::make_shared<const KeypointsAndDescriptors>(
+      GetFeatures(image_name));
+}
+
+void MemoryMappedFeaturesAndMatchesDatabase::PutFeatures(
+    const std::string& image_name, const KeypointsAndDescriptors& features) {
+  const std::vector<char> record_data = CreateRecord(image_name, features);
+
+  std::lock_guard<std::mutex> lock(features_mutex_);
+  // Pad the features file so the record starts aligned. The padding is only
+  // needed after a previous write was interrupted.
+  Record record;
+  record.offset = AlignUp(features_file_size_);
+  record.size = record_data.size();
+  const std::vector<char> padding(record.offset - features_file_size_, 0);
+  CHECK_EQ(fwrite(padding.data(), 1, padding.size(), features_file_),
+           padding.size());
+  CHECK_EQ(fwrite(record_data.data(), 1, record_data.size(), features_file_),
+           record_data.size())
+      << "Could not write the features of image " << image_name;
+  // The record must be in the file before it can be mapped.
+  CHECK_EQ(fflush(features_file_), 0);
+  features_file_size_ = record.offset + record.size;
+
+  // The index entry is written after the record so that the index never
+  // refers to a record that is not in the features file.
+  const uint32_t image_name_length = image_name.size();
+  CHECK_EQ(fwrite(&image_name_length, sizeof(image_name_length), 1,
+                  index_file_),
+           1);
+  CHECK_EQ(fwrite(image_name.data(), 1, image_name.size(), index_file_),
+           image_name.size());
+  CHECK_EQ(fwrite(&record, sizeof(record), 1, index_file_), 1);
+  CHECK_EQ(fflush(index_file_), 0);
+
+  records_[image_name] = record;
+}
+
+std::vector<std::string>
+MemoryMappedFeaturesAndMatchesDatabase::ImageNamesOfFeatures() {
+  std::lock_guard<std::mutex> lock(features_mutex_);
+  std::vector<std::string> image_names;
+  image_names.reserve(records_.size());
+  for (const auto& record : records_) {
+    image_names.push_back(record.first);
+  }
+  return image_names;
+}
+
+size_t MemoryMappedFeaturesAndMatchesDatabase::NumImages() {
+  std::lock_guard<std::mutex> lock(features_mutex_);
+  return records_.size();
+}
+
+void MemoryMappedFeaturesAndMatchesDatabase::Flush() {
+  std::lock_guard<std::mutex> lock(features_mutex_);
+  // The files are flushed after every write, so only the data in the page
+  // cache must be made durable.
+#ifndef _WIN32
+  fsync(fileno(features_file_));
+  fsync(fileno(index_file_));
+#endif
+}
+
+}  // namespace theia
@@ -0,0 +1,133 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#ifndef THEIA_MATCHING_MEMORY_MAPPED_FEATURES_AND_MATCHES_DATABASE_H_
+#define THEIA_MATCHING_MEMORY_MAPPED_FEATURES_AND_MATCHES_DATABASE_H_
+
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "theia/matching/in_memory_features_and_matches_database.h"
+#include "theia/matching/keypoints_and_descriptors.h"
+#include "theia/util/util.h"
+
+namespace theia {
+
+class MappedFile;
+
+// A read-optimized database for features. Features are written once into an
+// append-only flat file in which each image is stored as a fixed header
+// followed by the keypoint array and the raw descriptor blocks. An index file
+// maps the image names to the records. The features file is memory mapped for
+// reading, so GetFeatures only copies the keypoints and descriptors out of the
+// mapping instead of decoding a cereal archive. The page cache keeps recently
+// used features in memory, so no feature cache is needed on top of this
+// database.
+//
+// Putting features for an image that already exists appends a new record that
+// replaces the old one; the space of the old record is not reclaimed. Camera
+// intrinsics priors and matches are kept in memory exactly as in
+// InMemoryFeaturesAndMatchesDatabase.
+//
+// The files are written in the native byte order and are not portable between
+// machines with different endianness. This class is guaranteed to be thread
+// safe.
+class MemoryMappedFeaturesAndMatchesDatabase
+    : public InMemoryFeaturesAndMatchesDatabase {
+ public:
+  // Opens the database in the directory, creating the directory and the files
+  // if they do not exist. Features from previous runs are available right away.
+  explicit MemoryMappedFeaturesAndMatchesDatabase(const std::string& directory);
+  ~MemoryMappedFeaturesAndMatchesDatabase();
+
+  bool ContainsFeatures(const std::string& image_name) override;
+
+  // Get/set the features for the image.
+  KeypointsAndDescriptors GetFeatures(const std::string& image_name) override;
+  std::shared_ptr<const KeypointsAndDescriptors> GetSharedFeatures(
+      const std::string& image_name) override;
+
+  // Copies only the keypoints out of the mapping, so the pages of the
+  // descriptors are not read.
+  std::vector<Keypoint> GetKeypoints(const std::string& image_name) override;
+
+  // Appends the features for the image to the features file.
+  void PutFeatures(const std::string& image_name,
+                   const KeypointsAndDescriptors& features) override;
+
+  // Supply an iterator to iterate over the features.
+  std::vector<std::string> ImageNamesOfFeatures() override;
+  size_t NumImages() override;
+
+  // Flushes the features and index files to disk.
+  void Flush() override;
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(MemoryMappedFeaturesAndMatchesDatabase);
+
+  // The location of a features record in the features file.
+  struct Record {
+    uint64_t offset;
+    uint64_t size;
+  };
+
+  // Reads the index file and drops the entries of records that were not
+  // completely written to the features file.
+  void ReadIndex();
+
+  // Returns a mapping that covers the record, remapping the features file if
+  // the record was appended after the current mapping was created.
+  std::shared_ptr<const MappedFile> MappingForRecord(const Record& record);
+
+  const std::string features_filepath_;
+  const std::string index_filepath_;
+
+  std::mutex features_mutex_;
+  FILE* features_file_;
+  FILE* index_file_;
+  uint64_t features_file_size_;
+  std::unordered_map<std::string, Record> records_;
+  // Readers hold a reference to the mapping they use so that a remap never
+  // unmaps memory that is still being read.
+  std::shared_ptr<const MappedFile> mapping_;
+};
+
+}  // namespace theia
+
+#endif  // THEIA_MATCHING_MEMORY_MAPPED_FEATURES_AND_MATCHES_DATABASE_H_
@@ -0,0 +1,232 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#include <cstdio>
+#include <fstream>  // NOLINT
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "theia/image/keypoint_detector/keypoint.h"
+#include "theia/matching/image_pair_match.h"
+#include "theia/matching/keypoints_and_descriptors.h"
+#include "theia/matching/memory_mapped_features_and_matches_database.h"
+
+namespace theia {
+
+namespace {
+
+static const std::string kDatabaseDirectory =
+    THEIA_DATA_DIR + std::string("/memory_mapped_database");
+
+void RemoveDatabaseFiles() {
+  std::remove((kDatabaseDirectory + "/features.bin").c_str());
+  std::remove((kDatabaseDirectory + "/features_index.bin").c_str());
+}
+
+KeypointsAndDescriptors RandomFeatures(const int num_features) {
+  KeypointsAndDescriptors features;
+  features.keypoints.resize(num_features);
+  for (int i = 0; i < num_features; i++) {
+    features.keypoints[i] = Keypoint(i, i + 1, Keypoint::SIFT);
+    features.keypoints[i].set_scale(0.5 * i);
+    features.keypoints[i].set_orientation(0.1 * i);
+  }
+  features.descriptor_matrix.setRandom(num_features, 128);
+  return features;
+}
+
+template <typename MatrixType>
+void ExpectMatricesEqual(const MatrixType& matrix,
+                         const MatrixType& db_matrix) {
+  ASSERT_EQ(db_matrix.rows(), matrix.rows());
+  ASSERT_EQ(db_matrix.cols(), matrix.cols());
+  EXPECT_TRUE(db_matrix == matrix);
+}
+
+void ExpectFeaturesEqual(const KeypointsAndDescriptors& features,
+                         const KeypointsAndDescriptors& db_features) {
+  ASSERT_EQ(db_features.keypoints.size(), features.keypoints.size());
+  for (int i = 0; i < features.keypoints.size(); i++) {
+    EXPECT_EQ(db_features.keypoints[i].x(), features.keypoints[i].x());
+    EXPECT_EQ(db_features.keypoints[i].y(), features.keypoints[i].y());
+    EXPECT_EQ(db_features.keypoints[i].keypoint_type(),
+              features.keypoints[i].keypoint_type());
+    EXPECT_EQ(db_features.keypoints[i].has_strength(),
+              features.keypoints[i].has_strength());
+    EXPECT_EQ(db_features.keypoints[i].scale(), features.keypoints[i].scale());
+    EXPECT_EQ(db_features.keypoints[i].orientation(),
+              features.keypoints[i].orientation());
+  }
+  ExpectMatricesEqual(features.descriptor_matrix,
+                      db_features.descriptor_matrix);
+  ExpectMatricesEqual(features.binary_descriptor_matrix,
+                      db_features.binary_descriptor_matrix);
+  ExpectMatricesEqual(features.quantized_descriptor_matrix,
+                      db_features.quantized_descriptor_matrix);
+  EXPECT_EQ(db_features.descriptor_quantization_scale,
+            features.descriptor_quantization_scale);
+}
+
+}  // namespace
+
+TEST(MemoryMappedFeaturesAndMatchesDatabase, PutAndGetFeatures) {
+  RemoveDatabaseFiles();
+  MemoryMappedFeaturesAndMatchesDatabase db(kDatabaseDirectory);
+
+  const KeypointsAndDescriptors float_features = RandomFeatures(1000);
+  KeypointsAndDescriptors binary_features;
+  binary_features.keypoints.resize(10);
+  binary_features.binary_descriptor_matrix.setConstant(10, 61, 7);
+  KeypointsAndDescriptors quantized_features = RandomFeatures(33);
+  quantized_features.descriptor_matrix =
+      quantized_features.descriptor_matrix.cwiseAbs() / 16.0f;
+  quantized_features.QuantizeDescriptors(
+      kDefaultDescriptorQuantizationScale);
+
+  db.PutFeatures("float", float_features);
+  db.PutFeatures("binary", binary_features);
+  db.PutFeatures("quantized", quantized_features);
+  db.PutFeatures("empty", KeypointsAndDescriptors());
+
+  EXPECT_EQ(db.NumImages(), 4);
+  EXPECT_TRUE(db.ContainsFeatures("float"));
+  EXPECT_FALSE(db.ContainsFeatures("missing"));
+  ExpectFeaturesEqual(float_features, db.GetFeatures("float"));
+  ExpectFeaturesEqual(binary_features, db.GetFeatures("binary"));
+  ExpectFeaturesEqual(quantized_features, db.GetFeatures("quantized"));
+  EXPECT_EQ(db.GetFeatures("empty").NumDescriptors(), 0);
+  RemoveDatabaseFiles();
+}
+
+TEST(MemoryMappedFeaturesAndMatchesDatabase, GetKeypoints) {
+  RemoveDatabaseFiles();
+  MemoryMappedFeaturesAndMatchesDatabase db(kDatabaseDirectory);
+  const KeypointsAndDescriptors features = RandomFeatures(100);
+  db.PutFeatures("image", features);
+  db.PutFeatures("empty", KeypointsAndDescriptors());
+
+  const std::vector<Keypoint> keypoints = db.GetKeypoints("image");
+  ASSERT_EQ(keypoints.size(), features.keypoints.size());
+  for (int i = 0; i < keypoints.size(); i++) {
+    EXPECT_EQ(keypoints[i].x(), features.keypoints[i].x());
+    EXPECT_EQ(keypoints[i].y(), features.keypoints[i].y());
+    EXPECT_EQ(keypoints[i].scale(), features.keypoints[i].scale());
+    EXPECT_EQ(keypoints[i].orientation(), features.keypoints[i].orientation());
+  }
+  EXPECT_TRUE(db.GetKeypoints("empty").empty());
+  RemoveDatabaseFiles();
+}
+
+TEST(MemoryMappedFeaturesAndMatchesDatabase, ReopenDatabase) {
+  RemoveDatabaseFiles();
+  const KeypointsAndDescriptors features1 = RandomFeatures(100);
+  const KeypointsAndDescriptors features2 = RandomFeatures(200);
+  {
+    MemoryMappedFeaturesAndMatchesDatabase db(kDatabaseDirectory);
+    db.PutFeatures("1", features1);
+    db.PutFeatures("2", features1);
+    db.Flush();
+  }
+
+  {
+    // Replacing the features of an image appends a new record.
+    MemoryMappedFeaturesAndMatchesDatabase db(kDatabaseDirectory);
+    EXPECT_EQ(db.NumImages(), 2);
+    ExpectFeaturesEqual(features1, db.GetFeatures("2"));
+    db.PutFeatures("2", features2);
+    ExpectFeaturesEqual(features2, db.GetFeatures("2"));
+  }
+
+  MemoryMappedFeaturesAndMatchesDatabase db(kDatabaseDirectory);
+  EXPECT_EQ(db.NumImages(), 2);
+  ExpectFeaturesEqual(features1, db.GetFeatures("1"));
+  ExpectFeaturesEqual(features2, db.GetFeatures("2"));
+  RemoveDatabaseFiles();
+}
+
+TEST(MemoryMappedFeaturesAndMatchesDatabase, IgnoresIncompleteRecords) {
+  RemoveDatabaseFiles();
+  const KeypointsAndDescriptors features = RandomFeatures(100);
+  {
+    MemoryMappedFeaturesAndMatchesDatabase db(kDatabaseDirectory);
+    db.PutFeatures("1", features);
+    db.PutFeatures("2", features);
+  }
+
+  // Simulate a crash while the features of image 2 were being written by
+  // truncating the features file, and a crash while writing an index entry by
+  // appending part of one.
+  std::ifstream reader(kDatabaseDirectory + "/features.bin",
+                       std::ios::in | std::ios::binary);
+  std::vector<char> data((std::istreambuf_iterator<char>(reader)),
+                         std::istreambuf_iterator<char>());
+  reader.close();
+  std::ofstream writer(kDatabaseDirectory + "/features.bin",
+                       std::ios::out | std::ios::binary | std::ios::trunc);
+  writer.write(data.data(), data.size() - 100);
+  writer.close();
+  std::ofstream index_writer(kDatabaseDirectory + "/features_index.bin",
+                             std::ios::out | std::ios::binary | std::ios::app);
+  const uint32_t image_name_length = 1;
+  index_writer.write(reinterpret_cast<const char*>(&image_name_length),
+                     sizeof(image_name_length));
+  index_writer.close();
+
+  MemoryMappedFeaturesAndMatchesDatabase db(kDatabaseDirectory);
+  EXPECT_EQ(db.NumImages(), 1);
+  ExpectFeaturesEqual(features, db.GetFeatures("1"));
+
+  // New records are still readable after the incomplete one.
+  db.PutFeatures("2", features);
+  ExpectFeaturesEqual(features, db.GetFeatures("2"));
+  RemoveDatabaseFiles();
+}
+
+TEST(MemoryMappedFeaturesAndMatchesDatabase, MatchesAreKeptInMemory) {
+  RemoveDatabaseFiles();
+  MemoryMappedFeaturesAndMatchesDatabase db(kDatabaseDirectory);
+  ImagePairMatch match;
+  match.image1 = "1";
+  match.image2 = "2";
+  db.PutImagePairMatch("1", "2", match);
+  EXPECT_EQ(db.NumMatches(), 1);
+  EXPECT_EQ(db.GetImagePairMatch("1", "2").image2, "2");
+  db.RemoveAllMatches();
+  EXPECT_EQ(db.NumMatches(), 0);
+  RemoveDatabaseFiles();
+}
+
+}  // namespace theia
@@ -36,26 +36,42 @@
 
 #ifdef WITH_ROCKSDB
 
+#include <chrono>  // NOLINT
+#include <cstdio>
 #include <cstdlib>
 #include <glog/logging.h>
 #include <istream>
+#include <map>
+#include <memory>
 #include <mutex>
 #include <streambuf>
 #include <string>
+#include <thread>
+#include <utility>
+#include <vector>
 
 #include <cereal/archives/portable_binary.hpp>
+#include <cereal/types/bitset.hpp>
 #include <cereal/types/string.hpp>
 #include <cereal/types/unordered_map.hpp>
 #include <cereal/types/utility.hpp>
 #include <cereal/types/vector.hpp>
+#include <rocksdb/cache.h>
 #include <rocksdb/db.h>
+#include <rocksdb/env.h>
 #include <rocksdb/filter_policy.h>
+#include <rocksdb/options.h>
+#include <rocksdb/sst_file_writer.h>
 #include <rocksdb/table.h>
+#include <rocksdb/version.h>
+#include <rocksdb/write_batch.h>
 
 #include "theia/matching/image_pair_match.h"
+#include "theia/matching/image_pair_match_encoding.h"
 #include "theia/matching/keypoints_and_descriptors.h"
 #include "theia/util/filesystem.h"
 #include "theia/util/map_util.h"
+#include "theia/util/metrics.h"
 #include "theia/util/string.h"
 
 namespace theia {
@@ -64,9 +80,16 @@ using StringPair = std::pair<std::string, std::string>;
 
 static const std::string kFeaturesColumnFamilyName =
     "keypoints_and_descriptors";
+static const std::string kKeypointsColumnFamilyName = "keypoints";
 static const std::string kMatchesColumnFamilyName = "image_pair_matches";
 static const std::string kIntrinsicsColumnFamilyName =
     "camera_intrinsics_prior";
+static const std::string kHashedImagesColumnFamilyName = "hashed_images";
+static const std::string kFailedImagePairsColumnFamilyName =
+    "failed_image_pairs";
+static const std::string kImageFileSignaturesColumnFamilyName =
+    "image_file_signatures";
+static const std::string kImageIdsColumnFamilyName = "image_ids";
 static const std::string kNamePairSeparator = "/";
 
 // For serialization using the Cereal library we must provide a stream for the
@@ -80,14 +103,126 @@ struct ZeroCopyBuffer : std::streambuf {
 };
 
 // Creates a column family with the specified name and returns the handle.s
-rocksdb::ColumnFamilyHandle* CreateColumnFamily(const rocksdb::Options& options,
-                                                const std::string& column_name,
-                                                rocksdb::DB* database) {
+rocksdb::ColumnFamilyHandle* CreateColumnFamily(
+    const rocksdb::ColumnFamilyOptions& options,
+    const std::string& column_name,
+    rocksdb::DB* database) {
   rocksdb::ColumnFamilyHandle* temp_col_family_handle = nullptr;
   database->CreateColumnFamily(options, column_name, &temp_col_family_handle);
   return temp_col_family_handle;
 }
 
+rocksdb::CompressionType ToRocksDbCompression(
+    const RocksDbFeaturesAndMatchesDatabase::Compression compression) {
+  switch (compression) {
+    case RocksDbFeaturesAndMatchesDatabase::Compression::NONE:
+      return rocksdb::kNoCompression;
+    case RocksDbFeaturesAndMatchesDatabase::Compression::SNAPPY:
+      return rocksdb::kSnappyCompression;
+    case RocksDbFeaturesAndMatchesDatabase::Compression::LZ4:
+      return rocksdb::kLZ4Compression;
+    case RocksDbFeaturesAndMatchesDatabase::Compression::ZSTD:
+      return rocksdb::kZSTD;
+    default:
+      LOG(FATAL) << "Invalid compression specified.";
+      return rocksdb::kNoCompression;
+  }
+}
+
+// Applies the tuning of a group of column families to the column family options.
+void SetColumnFamilyOptions(
+    const RocksDbFeaturesAndMatchesDatabase::ColumnFamilyOptions& tuning,
+    rocksdb::ColumnFamilyOptions* options) {
+  options->compression = ToRocksDbCompression(tuning.compression);
+  options->write_buffer_size = tuning.write_buffer_size;
+
+  rocksdb::BlockBasedTableOptions table_options;
+  table_options.block_size = tuning.block_size;
+  if (tuning.block_cache_size > 0) {
+    table_options.block_cache = rocksdb::NewLRUCache(tuning.block_cache_size);
+  } else {
+    table_options.no_block_cache = true;
+  }
+  if (tuning.bloom_filter_bits_per_key > 0) {
+    table_options.filter_policy.reset(
+        rocksdb::NewBloomFilterPolicy(tuning.bloom_filter_bits_per_key));
+    // Keep the filters and indices in the block cache so that their memory is
+    // bounded by the cache size.
+    table_options.cache_index_and_filter_blocks = tuning.block_cache_size > 0;
+    table_options.pin_l0_filter_and_index_blocks_in_cache =
+        tuning.block_cache_size > 0;
+  }
+  options->table_factory.reset(
+      rocksdb::NewBlockBasedTableFactory(table_options));
+}
+
+KeypointsAndDescriptors DeserializeFeatures(const char* data,
+                                            const size_t size) {
+  // Create a stream wrapped around the serialized features.
+  ZeroCopyBuffer buffer(data, size);
+  std::istream ins(&buffer);
+
+  // Load the keypoints and descriptors.
+  KeypointsAndDescriptors features;
+  {
+    cereal::PortableBinaryInputArchive input_archive(ins);
+    input_archive(features);
+  }
+  return features;
+}
+
+std::string SerializeKeypoints(const std::vector<Keypoint>& keypoints) {
+  std::stringstream ss;
+  {
+    cereal::PortableBinaryOutputArchive output_archive(ss);
+    output_archive(keypoints);
+  }
+  return ss.str();
+}
+
+std::vector<Keypoint> DeserializeKeypoints(const char* data,
+                                           const size_t size) {
+  ZeroCopyBuffer buffer(data, size);
+  std::istream ins(&buffer);
+  std::vector<Keypoint> keypoints;
+  {
+    cereal::PortableBinaryInputArchive input_archive(ins);
+    input_archive(keypoints);
+  }
+  return keypoints;
+}
+
+// Writes the sorted keys and values to an SST file of the column family and
+// ingests it.
+void IngestSortedValues(const std::map<std::string, std::string>& values,
+                        const rocksdb::Options& options,
+                        const std::string& sst_filepath,
+                        rocksdb::ColumnFamilyHandle* column_family,
+                        rocksdb::DB* database) {
+  rocksdb::SstFileWriter writer(rocksdb::EnvOptions(), options, column_family);
+  rocksdb::Status status = writer.Open(sst_filepath);
+  CHECK(status.ok()) << "Could not open the SST file " << sst_filepath << ": "
+                     << status.ToString();
+  for (const auto& value : values) {
+    status = writer.Put(value.first, value.second);
+    CHECK(status.ok()) << "Could not write the value of " << value.first
+                       << " to the SST file: " << status.ToString();
+  }
+  status = writer.Finish();
+  CHECK(status.ok()) << "Could not write the SST file " << sst_filepath << ": "
+                     << status.ToString();
+
+  rocksdb::IngestExternalFileOptions ingest_options;
+  ingest_options.move_files = true;
+  status = database->IngestExternalFile(
+      column_family, {sst_filepath}, ingest_options);
+  CHECK(status.ok()) << "Could not ingest the bulk loaded values: "
+                     << status.ToString();
+  // The database links the file into its own directory structure, so our
+  // link is removed if it still exists.
+  std::remove(sst_filepath.c_str());
+}
+
 std::string ComposeImageNamePair(const std::string& image1,
                                  const std::string& image2) {
   return image1 + kNamePairSeparator + image2;
@@ -98,13 +233,73 @@ StringPair DecomposeImageNamePair(const std::string& image_pair) {
   return std::make_pair(image_pair.substr(0, delimiter_index),
                         image_pair.substr(delimiter_index + 1));
 }
+
+// Image ids are stored as fixed width big-endian integers, so that the keys of
+// the image ids sort by id and an image pair key is always 8 bytes.
+static const int kImageIdKeySize = 4;
+
+void AppendImageIdKey(const ImageId image_id, std::string* key) {
+  const uint32_t id = static_cast<uint32_t>(image_id);
+  key->push_back(static_cast<char>((id >> 24) & 0xFF));
+  key->push_back(static_cast<char>((id >> 16) & 0xFF));
+  key->push_back(static_cast<char>((id >> 8) & 0xFF));
+  key->push_back(static_cast<char>(id & 0xFF));
+}
+
+ImageId ReadImageIdKey(const char* key) {
+  const unsigned char* bytes = reinterpret_cast<const unsigned char*>(key);
+  return static_cast<ImageId>((static_cast<uint32_t>(bytes[0]) << 24) |
+                              (static_cast<uint32_t>(bytes[1]) << 16) |
+                              (static_cast<uint32_t>(bytes[2]) << 8) |
+                              static_cast<uint32_t>(bytes[3]));
+}
+
+std::string ComposeImageIdPair(const ImageId image_id1,
+                               const ImageId image_id2) {
+  std::string key;
+  key.reserve(2 * kImageIdKeySize);
+  AppendImageIdKey(image_id1, &key);
+  AppendImageIdKey(image_id2, &key);
+  return key;
+}
+
+// Reads the value of the key and records the latency of the read.
+rocksdb::Status ReadWithLatency(rocksdb::DB* database,
+                                rocksdb::ColumnFamilyHandle* column_family,
+                                const rocksdb::Slice& key,
+                                rocksdb::PinnableSlice* value) {
+  static Histogram* const read_latency = Metrics::GetHistogram(
+      "theia_rocksdb_read_latency_seconds",
+      "The latency of reads from the RocksDB features and matches database.");
+  const auto start_time = std::chrono::steady_clock::now();
+  const rocksdb::Status status =
+      database->Get(rocksdb::ReadOptions(), column_family, key, value);
+  read_latency->Observe(std::chrono::duration<double>(
+                            std::chrono::steady_clock::now() - start_time)
+                            .count());
+  return status;
+}
 }  // namespace
 
 RocksDbFeaturesAndMatchesDatabase::RocksDbFeaturesAndMatchesDatabase(
     const std::string& directory)
-    : directory_(directory) {
+    : RocksDbFeaturesAndMatchesDatabase(directory, Options()) {}
+
+RocksDbFeaturesAndMatchesDatabase::RocksDbFeaturesAndMatchesDatabase(
+    const std::string& directory, const Options& options)
+    : directory_(directory),
+      database_options_(options),
+      bulk_load_bytes_(0),
+      num_bulk_load_files_(0),
+      queued_match_bytes_(0),
+      is_writing_matches_(false),
+      stop_match_writer_(false) {
   AppendTrailingSlashIfNeeded(&directory_);
   InitializeRocksDB();
+  if (database_options_.write_matches_asynchronously) {
+    match_writer_ =
+        std::thread(&RocksDbFeaturesAndMatchesDatabase::WriteQueuedMatches, this);
+  }
 }
 
 void RocksDbFeaturesAndMatchesDatabase::InitializeRocksDB() {
@@ -118,16 +313,38 @@ void RocksDbFeaturesAndMatchesDatabase::InitializeRocksDB() {
   options_->create_if_missing = true;
   options_->level_compaction_dynamic_level_bytes = true;
   options_->statistics = rocksdb::CreateDBStatistics();
+  options_->use_direct_reads = database_options_.use_direct_reads;
+  options_->use_direct_io_for_flush_and_compaction =
+      database_options_.use_direct_io_for_flush_and_compaction;
 
-  rocksdb::BlockBasedTableOptions table_options;
-  // 512 MB.
-  //  table_options.block_cache = rocksdb::NewLRUCache(512 << 20);
-  //  table_options.block_size = 16 * 1024;
-  //  table_options.cache_index_and_filter_blocks = true;
-  //  table_options.pin_l0_filter_and_index_blocks_in_cache = true;
-  //  table_options.filter_policy.reset(rocksdb::NewBloomFilterPolicy(10,
-  //  false)); options_->table_factory.reset(
-  //      rocksdb::NewBlockBasedTableFactory(table_options));
+  // Each group of column families shares its options and block cache.
+  features_column_family_options_.reset(new rocksdb::Options(*options_));
+  SetColumnFamilyOptions(database_options_.features_options,
+                         features_column_family_options_.get());
+  matches_column_family_options_.reset(
+      new rocksdb::ColumnFamilyOptions(*options_));
+  SetColumnFamilyOptions(database_options_.matches_options,
+                         matches_column_family_options_.get());
+  intrinsics_column_family_options_.reset(
+      new rocksdb::ColumnFamilyOptions(*options_));
+  SetColumnFamilyOptions(database_options_.intrinsics_options,
+                         intrinsics_column_family_options_.get());
+  const auto column_family_options =
+      [this](const std::string& column_family) -> rocksdb::ColumnFamilyOptions {
+    if (column_family == kFeaturesColumnFamilyName ||
+        column_family == kKeypointsColumnFamilyName ||
+        column_family == kHashedImagesColumnFamilyName) {
+      return *features_column_family_options_;
+    } else if (column_family == kMatchesColumnFamilyName ||
+               column_family == kFailedImagePairsColumnFamilyName ||
+               column_family == kImageIdsColumnFamilyName) {
+      return *matches_column_family_options_;
+    } else if (column_family == kIntrinsicsColumnFamilyName ||
+               column_family == kImageFileSignaturesColumnFamilyName) {
+      return *intrinsics_column_family_options_;
+    }
+    return *options_;
+  };
 
   // Get column family descriptors to open the database.
   std::vector<rocksdb::ColumnFamilyDescriptor> column_descriptors;
@@ -141,7 +358,8 @@ void RocksDbFeaturesAndMatchesDatabase::InitializeRocksDB() {
     LOG(INFO) << "Reading existing DB.";
     // Create column descriptors from the existing names.
     for (const std::string& column_family : existing_column_families) {
-      column_descriptors.emplace_back(column_family, *options_);
+      column_descriptors.emplace_back(column_family,
+                                      column_family_options(column_family));
     }
   } else {
     // RocksDB requires you to have the default column family when creating a
@@ -168,36 +386,315 @@ void RocksDbFeaturesAndMatchesDatabase::InitializeRocksDB() {
   // If the DB is new (i.e. no existing column families are present), then we
   // need to create the column families.
   if (existing_column_families.empty()) {
-    features_handle_.reset(CreateColumnFamily(
-        *options_, kFeaturesColumnFamilyName, database_.get()));
-    matches_handle_.reset(CreateColumnFamily(
-        *options_, kMatchesColumnFamilyName, database_.get()));
-    intrinsics_prior_handle_.reset(CreateColumnFamily(
-        *options_, kIntrinsicsColumnFamilyName, database_.get()));
+    features_handle_.reset(CreateColumnFamily(*features_column_family_options_,
+                                              kFeaturesColumnFamilyName,
+                                              database_.get()));
+    keypoints_handle_.reset(CreateColumnFamily(*features_column_family_options_,
+                                               kKeypointsColumnFamilyName,
+                                               database_.get()));
+    matches_handle_.reset(CreateColumnFamily(*matches_column_family_options_,
+                                             kMatchesColumnFamilyName,
+                                             database_.get()));
+    intrinsics_prior_handle_.reset(
+        CreateColumnFamily(*intrinsics_column_family_options_,
+                           kIntrinsicsColumnFamilyName,
+                           database_.get()));
+    hashed_images_handle_.reset(
+        CreateColumnFamily(*features_column_family_options_,
+                           kHashedImagesColumnFamilyName,
+                           database_.get()));
+    failed_image_pairs_handle_.reset(
+        CreateColumnFamily(*matches_column_family_options_,
+                           kFailedImagePairsColumnFamilyName,
+                           database_.get()));
+    image_file_signatures_handle_.reset(
+        CreateColumnFamily(*intrinsics_column_family_options_,
+                           kImageFileSignaturesColumnFamilyName,
+                           database_.get()));
+    image_ids_handle_.reset(CreateColumnFamily(*matches_column_family_options_,
+                                               kImageIdsColumnFamilyName,
+                                               database_.get()));
   } else {
     // Otherwise, set up the mapping for the existing column families in the
     // database.
     for (int i = 0; i < temp_col_family_handles.size(); i++) {
       if (existing_column_families[i] == kFeaturesColumnFamilyName) {
         features_handle_.reset(temp_col_family_handles[i]);
+      } else if (existing_column_families[i] == kKeypointsColumnFamilyName) {
+        keypoints_handle_.reset(temp_col_family_handles[i]);
       } else if (existing_column_families[i] == kMatchesColumnFamilyName) {
         matches_handle_.reset(temp_col_family_handles[i]);
       } else if (existing_column_families[i] == kIntrinsicsColumnFamilyName) {
         intrinsics_prior_handle_.reset(temp_col_family_handles[i]);
+      } else if (existing_column_families[i] ==
+                 kHashedImagesColumnFamilyName) {
+        hashed_images_handle_.reset(temp_col_family_handles[i]);
+      } else if (existing_column_families[i] ==
+                 kFailedImagePairsColumnFamilyName) {
+        failed_image_pairs_handle_.reset(temp_col_family_handles[i]);
+      } else if (existing_column_families[i] ==
+                 kImageFileSignaturesColumnFamilyName) {
+        image_file_signatures_handle_.reset(temp_col_family_handles[i]);
+      } else if (existing_column_families[i] == kImageIdsColumnFamilyName) {
+        image_ids_handle_.reset(temp_col_family_handles[i]);
+      }
+    }
+
+    // Databases written before the keypoints were stored separately lack the
+    // column. GetKeypoints reads the features of their images.
+    if (!keypoints_handle_) {
+      keypoints_handle_.reset(
+          CreateColumnFamily(*features_column_family_options_,
+                             kKeypointsColumnFamilyName,
+                             database_.get()));
+    }
+    // Databases written before hashed images were stored lack the column.
+    if (!hashed_images_handle_) {
+      hashed_images_handle_.reset(
+          CreateColumnFamily(*features_column_family_options_,
+                             kHashedImagesColumnFamilyName,
+                             database_.get()));
+    }
+    if (!failed_image_pairs_handle_) {
+      failed_image_pairs_handle_.reset(
+          CreateColumnFamily(*matches_column_family_options_,
+                             kFailedImagePairsColumnFamilyName,
+                             database_.get()));
+    }
+    if (!image_file_signatures_handle_) {
+      image_file_signatures_handle_.reset(
+          CreateColumnFamily(*intrinsics_column_family_options_,
+                             kImageFileSignaturesColumnFamilyName,
+                             database_.get()));
+    }
+
+    // Databases written before image ids were introduced key their matches
+    // by image names. They keep doing so until their matches are removed.
+    if (!image_ids_handle_ && !HasKeys(matches_handle_.get()) &&
+        !HasKeys(failed_image_pairs_handle_.get())) {
+      image_ids_handle_.reset(
+          CreateColumnFamily(*matches_column_family_options_,
+                             kImageIdsColumnFamilyName,
+                             database_.get()));
+    }
+  }
+
+  if (image_ids_handle_) {
+    LoadImageIds();
+  } else {
+    LOG(INFO) << "The matches of the database are keyed by image names.";
+  }
+}
+
+bool RocksDbFeaturesAndMatchesDatabase::HasKeys(
+    rocksdb::ColumnFamilyHandle* column_family) {
+  std::unique_ptr<rocksdb::Iterator> it(
+      database_->NewIterator(rocksdb::ReadOptions(), column_family));
+  it->SeekToFirst();
+  return it->Valid();
+}
+
+void RocksDbFeaturesAndMatchesDatabase::LoadImageIds() {
+  // The keys sort by id, so the ids are added in order.
+  std::unique_ptr<rocksdb::Iterator> it(
+      database_->NewIterator(rocksdb::ReadOptions(), image_ids_handle_.get()));
+  for (it->SeekToFirst(); it->Valid(); it->Next()) {
+    CHECK_EQ(it->key().size(), kImageIdKeySize);
+    const ImageId image_id = ReadImageIdKey(it->key().data());
+    CHECK_EQ(image_ids_.GetOrAddImageId(it->value().ToString()), image_id)
+        << "The image ids of the database are not dense.";
+  }
+  VLOG(1) << "Loaded the ids of " << image_ids_.NumImages() << " images.";
+}
+
+ImageId RocksDbFeaturesAndMatchesDatabase::GetOrAddImageId(
+    const std::string& image_name) {
+  const ImageId image_id = image_ids_.FindImageId(image_name);
+  if (image_id != kInvalidImageId) {
+    return image_id;
+  }
+
+  // New ids are written before they are returned, so that no stored match
+  // refers to an id that is not in the database.
+  std::lock_guard<std::mutex> lock(image_ids_mutex_);
+  bool is_new_image = false;
+  const ImageId new_image_id =
+      image_ids_.GetOrAddImageId(image_name, &is_new_image);
+  if (is_new_image && image_ids_handle_) {
+    std::string key;
+    AppendImageIdKey(new_image_id, &key);
+    const rocksdb::Status status = database_->Put(
+        rocksdb::WriteOptions(), image_ids_handle_.get(), key, image_name);
+    CHECK(status.ok()) << "Could not insert the image id of " << image_name
+                       << " into the database: " << status.ToString();
+  }
+  return new_image_id;
+}
+
+std::string RocksDbFeaturesAndMatchesDatabase::ImagePairKey(
+    const std::string& image_name1, const std::string& image_name2) {
+  if (!image_ids_handle_) {
+    return ComposeImageNamePair(image_name1, image_name2);
+  }
+  return ComposeImageIdPair(GetOrAddImageId(image_name1),
+                            GetOrAddImageId(image_name2));
+}
+
+bool RocksDbFeaturesAndMatchesDatabase::FindImagePairKey(
+    const std::string& image_name1,
+    const std::string& image_name2,
+    std::string* key) {
+  if (!image_ids_handle_) {
+    *key = ComposeImageNamePair(image_name1, image_name2);
+    return true;
+  }
+  const ImageId image_id1 = image_ids_.FindImageId(image_name1);
+  const ImageId image_id2 = image_ids_.FindImageId(image_name2);
+  if (image_id1 == kInvalidImageId || image_id2 == kInvalidImageId) {
+    return false;
+  }
+  *key = ComposeImageIdPair(image_id1, image_id2);
+  return true;
+}
+
+StringPair RocksDbFeaturesAndMatchesDatabase::ImageNamesOfImagePairKey(
+    const rocksdb::Slice& key) {
+  if (!image_ids_handle_) {
+    return DecomposeImageNamePair(key.ToString());
+  }
+  CHECK_EQ(key.size(), 2 * kImageIdKeySize);
+  return StringPair(
+      image_ids_.ImageName(ReadImageIdKey(key.data())),
+      image_ids_.ImageName(ReadImageIdKey(key.data() + kImageIdKeySize)));
+}
+
+RocksDbFeaturesAndMatchesDatabase::~RocksDbFeaturesAndMatchesDatabase() {
+  // Write the remaining matches before closing the database.
+  Flush();
+  if (match_writer_.joinable()) {
+    {
+      std::lock_guard<std::mutex> lock(match_queue_mutex_);
+      stop_match_writer_ = true;
+    }
+    match_queue_condition_.notify_all();
+    match_writer_.join();
+  }
+}
+
+void RocksDbFeaturesAndMatchesDatabase::WriteQueuedMatches() {
+  rocksdb::WriteOptions options;
+  options.disableWAL = database_options_.disable_write_ahead_log_for_matches;
+
+  std::vector<std::pair<std::string, std::string>> matches_to_write;
+  std::vector<std::string> failed_image_pairs_to_write;
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(match_queue_mutex_);
+      match_queue_condition_.wait(lock, [this]() {
+        return stop_match_writer_ || !queued_matches_.empty() ||
+               !queued_failed_image_pairs_.empty();
+      });
+      if (queued_matches_.empty() && queued_failed_image_pairs_.empty()) {
+        return;
       }
+      // Take all queued matches at once so that the matching threads can keep
+      // queueing while the batch is written.
+      matches_to_write.swap(queued_matches_);
+      failed_image_pairs_to_write.swap(queued_failed_image_pairs_);
+      queued_match_bytes_ = 0;
+      is_writing_matches_ = true;
     }
+    // Wake up the threads waiting for space in the queue.
+    match_queue_condition_.notify_all();
+
+    rocksdb::WriteBatch batch;
+    for (const auto& match : matches_to_write) {
+      batch.Put(matches_handle_.get(), match.first, match.second);
+    }
+    for (const std::string& image_name_pair : failed_image_pairs_to_write) {
+      batch.Put(failed_image_pairs_handle_.get(), image_name_pair, "");
+    }
+    const rocksdb::Status status = database_->Write(options, &batch);
+    CHECK(status.ok()) << "Could not write the matches to the database: "
+                       << status.ToString();
+    matches_to_write.clear();
+    failed_image_pairs_to_write.clear();
+
+    {
+      std::lock_guard<std::mutex> lock(match_queue_mutex_);
+      is_writing_matches_ = false;
+    }
+    match_queue_condition_.notify_all();
   }
 }
 
-RocksDbFeaturesAndMatchesDatabase::~RocksDbFeaturesAndMatchesDatabase() {}
+void RocksDbFeaturesAndMatchesDatabase::WaitForQueuedMatches() {
+  if (!database_options_.write_matches_asynchronously) {
+    return;
+  }
+  std::unique_lock<std::mutex> lock(match_queue_mutex_);
+  match_queue_condition_.wait(lock, [this]() {
+    return queued_matches_.empty() && queued_failed_image_pairs_.empty() &&
+           !is_writing_matches_;
+  });
+}
+
+void RocksDbFeaturesAndMatchesDatabase::IngestBulkLoadedFeatures() {
+  if (bulk_load_features_.empty()) {
+    return;
+  }
+
+  // The keypoints are ingested first: keypoints without features are never
+  // read, while features without keypoints fall back to reading the features.
+  const std::string sst_filepath_prefix =
+      directory_ + "bulk_load_features_" +
+      std::to_string(num_bulk_load_files_++);
+  IngestSortedValues(bulk_load_keypoints_,
+                     *features_column_family_options_,
+                     sst_filepath_prefix + "_keypoints.sst",
+                     keypoints_handle_.get(),
+                     database_.get());
+  IngestSortedValues(bulk_load_features_,
+                     *features_column_family_options_,
+                     sst_filepath_prefix + ".sst",
+                     features_handle_.get(),
+                     database_.get());
+
+  VLOG(2) << "Ingested the features of " << bulk_load_features_.size()
+          << " images.";
+  bulk_load_features_.clear();
+  bulk_load_keypoints_.clear();
+  bulk_load_bytes_ = 0;
+}
+
+void RocksDbFeaturesAndMatchesDatabase::Flush() {
+  {
+    std::lock_guard<std::mutex> lock(bulk_load_mutex_);
+    IngestBulkLoadedFeatures();
+  }
+  WaitForQueuedMatches();
+
+  // Matches written without the write-ahead log only live in the memtable until
+  // it is flushed to disk.
+  rocksdb::Status status;
+  if (database_options_.disable_write_ahead_log_for_matches) {
+    status = database_->Flush(rocksdb::FlushOptions(), matches_handle_.get());
+    if (status.ok()) {
+      status = database_->Flush(rocksdb::FlushOptions(),
+                                failed_image_pairs_handle_.get());
+    }
+  } else {
+    status = database_->SyncWAL();
+  }
+  CHECK(status.ok()) << "Could not flush the database: " << status.ToString();
+}
 
 bool RocksDbFeaturesAndMatchesDatabase::ContainsCameraIntrinsicsPrior(
     const std::string& image_name) {
-  rocksdb::ReadOptions options;
   const rocksdb::Slice key(image_name);
   rocksdb::PinnableSlice value;
-  const rocksdb::Status status =
-      database_->Get(options, intrinsics_prior_handle_.get(), key, &value);
+  const rocksdb::Status status = ReadWithLatency(
+      database_.get(), intrinsics_prior_handle_.get(), key, &value);
   return !status.IsNotFound();
 }
 
@@ -205,11 +702,10 @@ bool RocksDbFeaturesAndMatchesDatabase::ContainsCameraIntrinsicsPrior(
 CameraIntrinsicsPrior
 RocksDbFeaturesAndMatchesDatabase::GetCameraIntrinsicsPrior(
     const std::string& image_name) {
-  rocksdb::ReadOptions options;
   const rocksdb::Slice key(image_name);
   rocksdb::PinnableSlice value;
-  const rocksdb::Status status =
-      database_->Get(options, intrinsics_prior_handle_.get(), key, &value);
+  const rocksdb::Status status = ReadWithLatency(
+      database_.get(), intrinsics_prior_handle_.get(), key, &value);
   CHECK(!status.IsNotFound())
       << "Could not find intrinsics for " << image_name << " in the database.";
 
@@ -268,59 +764,170 @@ size_t RocksDbFeaturesAndMatchesDatabase::NumCameraIntrinsicsPrior() {
 
 bool RocksDbFeaturesAndMatchesDatabase::ContainsFeatures(
     const std::string& image_name) {
-  rocksdb::ReadOptions options;
+  if (database_options_.bulk_load_features) {
+    std::lock_guard<std::mutex> lock(bulk_load_mutex_);
+    if (ContainsKey(bulk_load_features_, image_name)) {
+      return true;
+    }
+  }
+
   const rocksdb::Slice key(image_name);
   rocksdb::PinnableSlice value;
-  const rocksdb::Status status =
-      database_->Get(options, features_handle_.get(), key, &value);
+  const rocksdb::Status status = ReadWithLatency(
+      database_.get(), features_handle_.get(), key, &value);
   return !status.IsNotFound();
 }
 
 // Get/set the features for the image.
 KeypointsAndDescriptors RocksDbFeaturesAndMatchesDatabase::GetFeatures(
     const std::string& image_name) {
-  rocksdb::ReadOptions options;
+  // Features that are waiting to be bulk loaded are read from memory.
+  if (database_options_.bulk_load_features) {
+    std::lock_guard<std::mutex> lock(bulk_load_mutex_);
+    const std::string* value = FindOrNull(bulk_load_features_, image_name);
+    if (value != nullptr) {
+      return DeserializeFeatures(value->data(), value->size());
+    }
+  }
+
   const rocksdb::Slice key(image_name);
   rocksdb::PinnableSlice value;
-  const rocksdb::Status status =
-      database_->Get(options, features_handle_.get(), key, &value);
+  const rocksdb::Status status = ReadWithLatency(
+      database_.get(), features_handle_.get(), key, &value);
   CHECK(!status.IsNotFound())
       << "Could not find features for " << image_name << " in the database.";
+  return DeserializeFeatures(value.data(), value.size());
+}
 
-  // Create a stream wrapped around the rocksdb value.
-  ZeroCopyBuffer buffer(value.data(), value.size());
-  std::istream ins(&buffer);
+std::vector<std::shared_ptr<const KeypointsAndDescriptors>>
+RocksDbFeaturesAndMatchesDatabase::GetSharedFeaturesBatch(
+    const std::vector<std::string>& image_names) {
+  static Histogram* const read_latency = Metrics::GetHistogram(
+      "theia_rocksdb_batch_read_latency_seconds",
+      "The latency of batched reads of features from the RocksDB features and "
+      "matches database.");
+  std::vector<std::shared_ptr<const KeypointsAndDescriptors>> features(
+      image_names.size());
 
-  // Load the keypoints and descriptors.
-  KeypointsAndDescriptors features;
+  // Features that are waiting to be bulk loaded are read from memory.
+  std::vector<rocksdb::Slice> keys;
+  std::vector<int> key_indices;
+  keys.reserve(image_names.size());
+  key_indices.reserve(image_names.size());
   {
-    cereal::PortableBinaryInputArchive input_archive(ins);
-    input_archive(
-        features.image_name, features.keypoints, features.descriptors);
+    std::unique_lock<std::mutex> lock(bulk_load_mutex_, std::defer_lock);
+    if (database_options_.bulk_load_features) {
+      lock.lock();
+    }
+    for (int i = 0; i < image_names.size(); i++) {
+      const std::string* value =
+          database_options_.bulk_load_features
+              ? FindOrNull(bulk_load_features_, image_names[i])
+              : nullptr;
+      if (value != nullptr) {
+        features[i] = std::make_shared<const KeypointsAndDescriptors>(
+            DeserializeFeatures(value->data(), value->size()));
+      } else {
+        keys.emplace_back(image_names[i]);
+        key_indices.emplace_back(i);
+      }
+    }
+  }
+  if (keys.empty()) {
+    return features;
+  }
+
+  // The remaining features are read with one MultiGet, which looks up the keys
+  // of the same block once and, with async_io, reads the blocks of different
+  // files in parallel.
+  rocksdb::ReadOptions read_options;
+#if ROCKSDB_MAJOR >= 7
+  read_options.async_io = true;
+#endif
+  std::vector<rocksdb::PinnableSlice> values(keys.size());
+  std::vector<rocksdb::Status> statuses(keys.size());
+  const auto start_time = std::chrono::steady_clock::now();
+  database_->MultiGet(read_options, features_handle_.get(), keys.size(),
+                      keys.data(), values.data(), statuses.data());
+  read_latency->Observe(std::chrono::duration<double>(
+                            std::chrono::steady_clock::now() - start_time)
+                            .count());
+
+  for (int i = 0; i < keys.size(); i++) {
+    const std::string& image_name = image_names[key_indices[i]];
+    CHECK(!statuses[i].IsNotFound())
+        << "Could not find features for " << image_name << " in the database.";
+    CHECK(statuses[i].ok()) << "Could not read the features for " << image_name
+                            << ": " << statuses[i].ToString();
+    features[key_indices[i]] = std::make_shared<const KeypointsAndDescriptors>(
+        DeserializeFeatures(values[i].data(), values[i].size()));
   }
   return features;
 }
 
-// Set the features for the image.
+std::vector<Keypoint> RocksDbFeaturesAndMatchesDatabase::GetKeypoints(
+    const std::string& image_name) {
+  if (database_options_.bulk_load_features) {
+    std::lock_guard<std::mutex> lock(bulk_load_mutex_);
+    const std::string* value = FindOrNull(bulk_load_keypoints_, image_name);
+    if (value != nullptr) {
+      return DeserializeKeypoints(value->data(), value->size());
+    }
+  }
+
+  const rocksdb::Slice key(image_name);
+  rocksdb::PinnableSlice value;
+  const rocksdb::Status status = ReadWithLatency(
+      database_.get(), keypoints_handle_.get(), key, &value);
+  if (status.IsNotFound()) {
+    return GetFeatures(image_name).keypoints;
+  }
+  return DeserializeKeypoints(value.data(), value.size());
+}
+
+// Set the features for the image. The keypoints are written to their own
+// column family as well.
 void RocksDbFeaturesAndMatchesDatabase::PutFeatures(
     const std::string& image_name, const KeypointsAndDescriptors& features) {
   std::stringstream ss;
   {
     cereal::PortableBinaryOutputArchive output_archive(ss);
-    output_archive(
-        features.image_name, features.keypoints, features.descriptors);
+    output_archive(features);
   }
+  std::string keypoints_value = SerializeKeypoints(features.keypoints);
 
-  rocksdb::WriteOptions options;
-  const rocksdb::Slice key(image_name);
+  if (database_options_.bulk_load_features) {
+    std::string value = ss.str();
+    std::lock_guard<std::mutex> lock(bulk_load_mutex_);
+    std::string& bulk_load_value = bulk_load_features_[image_name];
+    std::string& bulk_load_keypoints_value = bulk_load_keypoints_[image_name];
+    bulk_load_bytes_ -=
+        bulk_load_value.size() + bulk_load_keypoints_value.size();
+    bulk_load_bytes_ += value.size() + keypoints_value.size();
+    bulk_load_value = std::move(value);
+    bulk_load_keypoints_value = std::move(keypoints_value);
+    if (bulk_load_bytes_ > database_options_.bulk_load_batch_size_in_bytes) {
+      IngestBulkLoadedFeatures();
+    }
+    return;
+  }
+
+  // The features and keypoints are written atomically.
+  rocksdb::WriteBatch batch;
+  batch.Put(features_handle_.get(), image_name, ss.str());
+  batch.Put(keypoints_handle_.get(), image_name, keypoints_value);
   const rocksdb::Status status =
-      database_->Put(options, features_handle_.get(), key, ss.str());
+      database_->Write(rocksdb::WriteOptions(), &batch);
   CHECK(status.ok()) << "Could not insert features for " << image_name
                      << " into the database.";
 }
 
 std::vector<std::string>
 RocksDbFeaturesAndMatchesDatabase::ImageNamesOfFeatures() {
+  if (database_options_.bulk_load_features) {
+    std::lock_guard<std::mutex> lock(bulk_load_mutex_);
+    IngestBulkLoadedFeatures();
+  }
   // Iterate over the features column family and grab the keys.
   std::vector<std::string> image_names;
   auto it =
@@ -333,6 +940,10 @@ RocksDbFeaturesAndMatchesDatabase::ImageNamesOfFeatures() {
 }
 
 size_t RocksDbFeaturesAndMatchesDatabase::NumImages() {
+  if (database_options_.bulk_load_features) {
+    std::lock_guard<std::mutex> lock(bulk_load_mutex_);
+    IngestBulkLoadedFeatures();
+  }
   std::uint64_t num_images;
   database_->GetIntProperty(
       features_handle_.get(), "rocksdb.estimate-num-keys", &num_images);
@@ -342,23 +953,43 @@ size_t RocksDbFeaturesAndMatchesDatabase::NumImages() {
 // Get the image pair match for the images.
 ImagePairMatch RocksDbFeaturesAndMatchesDatabase::GetImagePairMatch(
     const std::string& image_name1, const std::string& image_name2) {
-  const std::string image_name_pair =
-      ComposeImageNamePair(image_name1, image_name2);
+  WaitForQueuedMatches();
+  std::string image_name_pair;
+  CHECK(FindImagePairKey(image_name1, image_name2, &image_name_pair))
+      << "Could not find the image pair match for (" << image_name1 << ", "
+      << image_name2 << ")";
 
-  rocksdb::ReadOptions options;
   const rocksdb::Slice key(image_name_pair);
   rocksdb::PinnableSlice value;
-  const rocksdb::Status status =
-      database_->Get(options, matches_handle_.get(), key, &value);
+  const rocksdb::Status status = ReadWithLatency(
+      database_.get(), matches_handle_.get(), key, &value);
   CHECK(!status.IsNotFound()) << "Could not find the image pair match for ("
                               << image_name1 << ", " << image_name2 << ")";
+  return DeserializeImagePairMatch(image_name1, image_name2, value);
+}
+
+ImagePairMatch RocksDbFeaturesAndMatchesDatabase::DeserializeImagePairMatch(
+    const std::string& image_name1,
+    const std::string& image_name2,
+    const rocksdb::Slice& value) {
+  ImagePairMatch matches;
+  if (IsEncodedImagePairMatch(value.data(), value.size())) {
+    const auto keypoints = KeypointsOfImagePair(image_name1, image_name2);
+    CHECK(DecodeImagePairMatch(value.data(),
+                               value.size(),
+                               keypoints.first,
+                               keypoints.second,
+                               &matches))
+        << "Could not decode the image pair match for (" << image_name1
+        << ", " << image_name2 << ")";
+    return matches;
+  }
 
   // Create a stream wrapped around the rocksdb value.
   ZeroCopyBuffer buffer(value.data(), value.size());
   std::istream ins(&buffer);
 
   // Load the keypoints and descriptors.
-  ImagePairMatch matches;
   {
     cereal::PortableBinaryInputArchive input_archive(ins);
     input_archive(matches);
@@ -366,41 +997,134 @@ ImagePairMatch RocksDbFeaturesAndMatchesDatabase::GetImagePairMatch(
   return matches;
 }
 
+std::pair<KeypointsAndDescriptors, KeypointsAndDescriptors>
+RocksDbFeaturesAndMatchesDatabase::KeypointsOfImagePair(
+    const std::string& image_name1, const std::string& image_name2) {
+  std::pair<KeypointsAndDescriptors, KeypointsAndDescriptors> keypoints;
+  keypoints.first.keypoints = GetKeypoints(image_name1);
+  keypoints.second.keypoints = GetKeypoints(image_name2);
+  return keypoints;
+}
+
+bool RocksDbFeaturesAndMatchesDatabase::ContainsKeyInColumnFamily(
+    rocksdb::ColumnFamilyHandle* column_family, const std::string& key) {
+  // KeyMayExist only consults the memtables, the block cache and the bloom
+  // filters, so a negative answer is definitive and cheap. A positive answer
+  // may be a false positive of the bloom filter and is confirmed with a read.
+  std::string unused_value;
+  if (!database_->KeyMayExist(
+          rocksdb::ReadOptions(), column_family, key, &unused_value)) {
+    return false;
+  }
+  rocksdb::PinnableSlice value;
+  const rocksdb::Status status =
+      ReadWithLatency(database_.get(), column_family, key, &value);
+  return status.ok();
+}
+
 // Set the image pair match for the images.
 void RocksDbFeaturesAndMatchesDatabase::PutImagePairMatch(
     const std::string& image_name1,
     const std::string& image_name2,
     const ImagePairMatch& matches) {
-  const std::string image_name_pair =
-      ComposeImageNamePair(image_name1, image_name2);
+  const std::string image_name_pair = ImagePairKey(image_name1, image_name2);
 
-  std::stringstream ss;
-  {
-    cereal::PortableBinaryOutputArchive output_archive(ss);
-    output_archive(matches);
+  std::string value;
+  if (database_options_.encode_matches_with_feature_indices &&
+      ContainsFeatures(image_name1) && ContainsFeatures(image_name2)) {
+    const auto keypoints = KeypointsOfImagePair(image_name1, image_name2);
+    EncodeImagePairMatch(database_options_.match_encoding_options,
+                         matches,
+                         keypoints.first,
+                         keypoints.second,
+                         &value);
+  } else {
+    std::stringstream ss;
+    {
+      cereal::PortableBinaryOutputArchive output_archive(ss);
+      output_archive(matches);
+    }
+    value = ss.str();
+  }
+
+  if (database_options_.write_matches_asynchronously) {
+    {
+      std::unique_lock<std::mutex> lock(match_queue_mutex_);
+      match_queue_condition_.wait(lock, [this]() {
+        return queued_match_bytes_ <=
+               database_options_.max_pending_match_bytes;
+      });
+      queued_match_bytes_ += image_name_pair.size() + value.size();
+      queued_matches_.emplace_back(image_name_pair, std::move(value));
+    }
+    match_queue_condition_.notify_all();
+    return;
   }
 
   rocksdb::WriteOptions options;
+  options.disableWAL = database_options_.disable_write_ahead_log_for_matches;
   const rocksdb::Slice key(image_name_pair);
   const rocksdb::Status status =
-      database_->Put(options, matches_handle_.get(), key, ss.str());
+      database_->Put(options, matches_handle_.get(), key, value);
   CHECK(status.ok());
 }
 
 std::vector<StringPair>
 RocksDbFeaturesAndMatchesDatabase::ImageNamesOfMatches() {
+  WaitForQueuedMatches();
   // Iterate over the features column family and grab the keys.
   std::vector<StringPair> image_match_names;
   auto it =
       database_->NewIterator(rocksdb::ReadOptions(), matches_handle_.get());
   for (it->SeekToFirst(); it->Valid(); it->Next()) {
-    image_match_names.push_back(DecomposeImageNamePair(it->key().ToString()));
+    image_match_names.push_back(ImageNamesOfImagePairKey(it->key()));
   }
 
   return image_match_names;
 }
 
+bool RocksDbFeaturesAndMatchesDatabase::ContainsImagePairMatch(
+    const std::string& image_name1, const std::string& image_name2) {
+  WaitForQueuedMatches();
+  std::string key;
+  return FindImagePairKey(image_name1, image_name2, &key) &&
+         ContainsKeyInColumnFamily(matches_handle_.get(), key);
+}
+
+void RocksDbFeaturesAndMatchesDatabase::ForEachMatchedImagePair(
+    const ImagePairCallback& callback) {
+  WaitForQueuedMatches();
+  std::unique_ptr<rocksdb::Iterator> it(
+      database_->NewIterator(rocksdb::ReadOptions(), matches_handle_.get()));
+  for (it->SeekToFirst(); it->Valid(); it->Next()) {
+    const StringPair image_names = ImageNamesOfImagePairKey(it->key());
+    if (!callback(image_names.first, image_names.second)) {
+      return;
+    }
+  }
+}
+
+void RocksDbFeaturesAndMatchesDatabase::ForEachImagePairMatch(
+    const ImagePairMatchCallback& callback) {
+  WaitForQueuedMatches();
+  // The matches are read once in key order, so they should not displace the
+  // features from the block cache.
+  rocksdb::ReadOptions read_options;
+  read_options.fill_cache = false;
+  std::unique_ptr<rocksdb::Iterator> it(
+      database_->NewIterator(read_options, matches_handle_.get()));
+  for (it->SeekToFirst(); it->Valid(); it->Next()) {
+    const StringPair image_names = ImageNamesOfImagePairKey(it->key());
+    const ImagePairMatch matches = DeserializeImagePairMatch(
+        image_names.first, image_names.second, it->value());
+    if (!callback(image_names.first, image_names.second, matches)) {
+      return;
+    }
+  }
+}
+
 size_t RocksDbFeaturesAndMatchesDatabase::NumMatches() {
+  WaitForQueuedMatches();
   std::uint64_t num_matches;
   database_->GetIntProperty(
       matches_handle_.get(), "rocksdb.estimate-num-keys", &num_matches);
@@ -408,13 +1132,173 @@ size_t RocksDbFeaturesAndMatchesDatabase::NumMatches() {
 }
 
 void RocksDbFeaturesAndMatchesDatabase::RemoveAllMatches() {
+  WaitForQueuedMatches();
   // Drop the column family handle -- this deletes all key/values in the column
   // family.
   database_->DropColumnFamily(matches_handle_.get());
 
   // Add the column family back again.
-  matches_handle_.reset(
-      CreateColumnFamily(*options_, kMatchesColumnFamilyName, database_.get()));
+  matches_handle_.reset(CreateColumnFamily(*matches_column_family_options_,
+                                           kMatchesColumnFamilyName,
+                                           database_.get()));
+
+  database_->DropColumnFamily(failed_image_pairs_handle_.get());
+  failed_image_pairs_handle_.reset(
+      CreateColumnFamily(*matches_column_family_options_,
+                         kFailedImagePairsColumnFamilyName,
+                         database_.get()));
+
+  // Without matches, databases that key their matches by image names switch
+  // to image ids.
+  if (!image_ids_handle_) {
+    image_ids_handle_.reset(CreateColumnFamily(*matches_column_family_options_,
+                                               kImageIdsColumnFamilyName,
+                                               database_.get()));
+    std::lock_guard<std::mutex> lock(image_ids_mutex_);
+    for (ImageId image_id = 0; image_id < image_ids_.NumImages(); image_id++) {
+      std::string key;
+      AppendImageIdKey(image_id, &key);
+      const rocksdb::Status status =
+          database_->Put(rocksdb::WriteOptions(),
+                         image_ids_handle_.get(),
+                         key,
+                         image_ids_.ImageName(image_id));
+      CHECK(status.ok()) << "Could not insert the image ids into the "
+                            "database: "
+                         << status.ToString();
+    }
+  }
+}
+
+void RocksDbFeaturesAndMatchesDatabase::PutFailedImagePair(
+    const std::string& image_name1, const std::string& image_name2) {
+  std::string image_name_pair = ImagePairKey(image_name1, image_name2);
+  if (database_options_.write_matches_asynchronously) {
+    {
+      std::unique_lock<std::mutex> lock(match_queue_mutex_);
+      match_queue_condition_.wait(lock, [this]() {
+        return queued_match_bytes_ <=
+               database_options_.max_pending_match_bytes;
+      });
+      queued_match_bytes_ += image_name_pair.size();
+      queued_failed_image_pairs_.emplace_back(std::move(image_name_pair));
+    }
+    match_queue_condition_.notify_all();
+    return;
+  }
+
+  rocksdb::WriteOptions options;
+  options.disableWAL = database_options_.disable_write_ahead_log_for_matches;
+  const rocksdb::Status status = database_->Put(
+      options, failed_image_pairs_handle_.get(), image_name_pair, "");
+  CHECK(status.ok()) << "Could not insert the failed image pair ("
+                     << image_name1 << ", " << image_name2
+                     << ") into the database.";
+}
+
+std::vector<StringPair>
+RocksDbFeaturesAndMatchesDatabase::ImageNamesOfFailedImagePairs() {
+  WaitForQueuedMatches();
+  std::vector<StringPair> image_pair_names;
+  auto it = database_->NewIterator(rocksdb::ReadOptions(),
+                                   failed_image_pairs_handle_.get());
+  for (it->SeekToFirst(); it->Valid(); it->Next()) {
+    image_pair_names.push_back(ImageNamesOfImagePairKey(it->key()));
+  }
+
+  return image_pair_names;
+}
+
+bool RocksDbFeaturesAndMatchesDatabase::ContainsFailedImagePair(
+    const std::string& image_name1, const std::string& image_name2) {
+  WaitForQueuedMatches();
+  std::string key;
+  return FindImagePairKey(image_name1, image_name2, &key) &&
+         ContainsKeyInColumnFamily(failed_image_pairs_handle_.get(), key);
+}
+
+void RocksDbFeaturesAndMatchesDatabase::ForEachFailedImagePair(
+    const ImagePairCallback& callback) {
+  WaitForQueuedMatches();
+  std::unique_ptr<rocksdb::Iterator> it(database_->NewIterator(
+      rocksdb::ReadOptions(), failed_image_pairs_handle_.get()));
+  for (it->SeekToFirst(); it->Valid(); it->Next()) {
+    const StringPair image_names = ImageNamesOfImagePairKey(it->key());
+    if (!callback(image_names.first, image_names.second)) {
+      return;
+    }
+  }
+}
+
+bool RocksDbFeaturesAndMatchesDatabase::GetHashedImage(
+    const std::string& image_name, HashedImage* hashed_image) {
+  const rocksdb::Slice key(image_name);
+  rocksdb::PinnableSlice value;
+  const rocksdb::Status status = ReadWithLatency(
+      database_.get(), hashed_images_handle_.get(), key, &value);
+  if (!status.ok()) {
+    return false;
+  }
+
+  // Create a stream wrapped around the rocksdb value.
+  ZeroCopyBuffer buffer(value.data(), value.size());
+  std::istream ins(&buffer);
+  {
+    cereal::PortableBinaryInputArchive input_archive(ins);
+    input_archive(*hashed_image);
+  }
+  return true;
+}
+
+void RocksDbFeaturesAndMatchesDatabase::PutHashedImage(
+    const std::string& image_name, const HashedImage& hashed_image) {
+  std::stringstream ss;
+  {
+    cereal::PortableBinaryOutputArchive output_archive(ss);
+    output_archive(hashed_image);
+  }
+
+  rocksdb::WriteOptions options;
+  const rocksdb::Slice key(image_name);
+  const rocksdb::Status status =
+      database_->Put(options, hashed_images_handle_.get(), key, ss.str());
+  CHECK(status.ok()) << "Could not insert the hashed image for " << image_name
+                     << " into the database.";
+}
+
+bool RocksDbFeaturesAndMatchesDatabase::GetImageFileSignature(
+    const std::string& image_name, FileSignature* signature) {
+  const rocksdb::Slice key(image_name);
+  rocksdb::PinnableSlice value;
+  const rocksdb::Status status = ReadWithLatency(
+      database_.get(), image_file_signatures_handle_.get(), key, &value);
+  if (!status.ok()) {
+    return false;
+  }
+
+  ZeroCopyBuffer buffer(value.data(), value.size());
+  std::istream ins(&buffer);
+  {
+    cereal::PortableBinaryInputArchive input_archive(ins);
+    input_archive(signature->size, signature->modification_time);
+  }
+  return true;
+}
+
+void RocksDbFeaturesAndMatchesDatabase::PutImageFileSignature(
+    const std::string& image_name, const FileSignature& signature) {
+  std::stringstream ss;
+  {
+    cereal::PortableBinaryOutputArchive output_archive(ss);
+    output_archive(signature.size, signature.modification_time);
+  }
+
+  rocksdb::WriteOptions options;
+  const rocksdb::Slice key(image_name);
+  const rocksdb::Status status = database_->Put(
+      options, image_file_signatures_handle_.get(), key, ss.str());
+  CHECK(status.ok()) << "Could not insert the image file signature for "
+                     << image_name << " into the database.";
 }
 
 }  // namespace theia
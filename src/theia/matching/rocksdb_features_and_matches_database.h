@@ -34,14 +34,19 @@
 
 #pragma once
 
+#include <condition_variable>  // NOLINT
+#include <map>
+#include <memory>
 #include <mutex>  // NOLINT
 #include <string>
+#include <thread>  // NOLINT
 #include <unordered_map>
 #include <utility>
 #include <vector>
 
 #include "theia/matching/features_and_matches_database.h"
 #include "theia/matching/image_pair_match.h"
+#include "theia/matching/image_pair_match_encoding.h"
 #include "theia/matching/keypoints_and_descriptors.h"
 #include "theia/util/hash.h"
 #include "theia/util/lru_cache.h"
@@ -50,6 +55,8 @@
 namespace rocksdb {
 class ColumnFamilyHandle;
 class DB;
+class Slice;
+struct ColumnFamilyOptions;
 struct Options;
 }  // namespace rocksdb
 
@@ -62,7 +69,96 @@ namespace theia {
 // matches are kept in memory. This class is guaranteed to be thread safe.
 class RocksDbFeaturesAndMatchesDatabase : public FeaturesAndMatchesDatabase {
  public:
+  // The block compression of a column family. Compression algorithms that
+  // RocksDB was not built with make opening the database fail.
+  enum class Compression {
+    NONE = 0,
+    SNAPPY = 1,
+    LZ4 = 2,
+    ZSTD = 3,
+  };
+
+  // The tuning of a group of column families.
+  struct ColumnFamilyOptions {
+    // Size of the LRU cache for uncompressed blocks in bytes. Each group of
+    // column families has its own cache. Set to 0 to disable the block cache.
+    size_t block_cache_size = 64 << 20;
+
+    // Size of the uncompressed data blocks in bytes.
+    size_t block_size = 16 << 10;
+
+    Compression compression = Compression::LZ4;
+
+    // Bits per key of the bloom filter. Bloom filters avoid disk reads when
+    // looking up keys that do not exist, e.g. in ContainsFeatures. Set to 0 to
+    // disable bloom filters.
+    int bloom_filter_bits_per_key = 10;
+
+    // Size of each memtable in bytes before it is flushed to disk.
+    size_t write_buffer_size = 64 << 20;
+  };
+
+  struct Options {
+    // The tuning of the features (and keypoints and hashed images), matches
+    // (and failed image pairs) and camera intrinsics priors (and image file
+    // signatures) column families. Features are large and read repeatedly
+    // during matching so they get the largest cache. Features use a 256 MB
+    // block cache and 64 KB blocks, intrinsics priors a 8 MB block cache.
+    ColumnFamilyOptions features_options = {256 << 20, 64 << 10};
+    ColumnFamilyOptions matches_options;
+    ColumnFamilyOptions intrinsics_options = {8 << 20};
+
+    // Direct I/O bypasses the page cache, which avoids caching the data twice
+    // (in the page cache and the block cache) and keeps bulk writes from
+    // evicting the data being read. It requires a filesystem with O_DIRECT
+    // support.
+    bool use_direct_reads = false;
+    bool use_direct_io_for_flush_and_compaction = false;
+
+    // If true, PutFeatures collects the serialized features in memory and
+    // writes them, sorted by image name, to SST files that are ingested with
+    // IngestExternalFile. The features bypass the write-ahead log, the
+    // memtable and the compaction of level 0, which avoids the write
+    // amplification and compaction stalls of writing the features of a whole
+    // image collection during extraction. Pending features are read from
+    // memory. Listing the features (ImageNamesOfFeatures and NumImages) and
+    // Flush() ingest the pending features first, and the destructor ingests
+    // the remaining ones.
+    bool bulk_load_features = false;
+
+    // The pending features are written to an SST file and ingested when they
+    // exceed this many bytes.
+    size_t bulk_load_batch_size_in_bytes = 256 << 20;
+
+    // If true, PutImagePairMatch only serializes the match and queues it. A
+    // writer thread stores the queued matches in batches so that the matching
+    // threads do not wait for disk writes. Reading matches waits for the
+    // queued matches to be written first.
+    bool write_matches_asynchronously = true;
+
+    // If true, the batched match writes skip the write-ahead log. This is much
+    // faster for bulk matching but matches written since the last Flush() are
+    // lost if the process crashes.
+    bool disable_write_ahead_log_for_matches = false;
+
+    // PutImagePairMatch blocks while more than this many bytes of serialized
+    // matches are waiting to be written.
+    size_t max_pending_match_bytes = 256 << 20;
+
+    // If true, the matches of images whose features are in the database are
+    // stored with EncodeImagePairMatch, i.e. as delta encoded indices into the
+    // keypoints of the two images, which is about 10x smaller than the cereal
+    // serialization of the coordinates. Reading such a match reads the
+    // keypoints of both images to restore the coordinates. Matches stored with
+    // cereal are read either way, but older versions of Theia cannot read the
+    // encoded matches.
+    bool encode_matches_with_feature_indices = false;
+    ImagePairMatchEncodingOptions match_encoding_options;
+  };
+
   explicit RocksDbFeaturesAndMatchesDatabase(const std::string& directory);
+  RocksDbFeaturesAndMatchesDatabase(const std::string& directory,
+                                    const Options& options);
   ~RocksDbFeaturesAndMatchesDatabase();
 
   bool ContainsCameraIntrinsicsPrior(const std::string& image_name) override;
@@ -86,6 +182,17 @@ class RocksDbFeaturesAndMatchesDatabase : public FeaturesAndMatchesDatabase {
   // the database and false otherwise.
   KeypointsAndDescriptors GetFeatures(const std::string& image_name) override;
 
+  // Reads the features of all images with one MultiGet. With RocksDB 7 or
+  // later the reads use async_io, so the data blocks of the images are read in
+  // parallel.
+  std::vector<std::shared_ptr<const KeypointsAndDescriptors>>
+  GetSharedFeaturesBatch(const std::vector<std::string>& image_names) override;
+
+  // The keypoints are also stored in their own column family, so that reading
+  // them does not read the descriptors. Databases written before the keypoints
+  // were stored separately read them from the features.
+  std::vector<Keypoint> GetKeypoints(const std::string& image_name) override;
+
   // Set the features for the image.
   void PutFeatures(const std::string& image_name,
                    const KeypointsAndDescriptors& features) override;
@@ -94,6 +201,13 @@ class RocksDbFeaturesAndMatchesDatabase : public FeaturesAndMatchesDatabase {
   std::vector<std::string> ImageNamesOfFeatures() override;
   size_t NumImages() override;
 
+  // The image ids are stored in their own column family and loaded when the
+  // database is opened. The matches and failed image pairs are keyed by the
+  // two image ids as fixed width big-endian integers. Databases written before
+  // image ids were introduced keep their image name keys until
+  // RemoveAllMatches is called.
+  ImageId GetOrAddImageId(const std::string& image_name) override;
+
   // Get the image pair match for the images.Returns true if the features exist
   // in the database and false otherwise.
   ImagePairMatch GetImagePairMatch(const std::string& image_name1,
@@ -108,19 +222,136 @@ class RocksDbFeaturesAndMatchesDatabase : public FeaturesAndMatchesDatabase {
       override;
   size_t NumMatches() override;
 
+  // Existence checks consult the bloom filter of the column family first, so
+  // that pairs that were never matched are rejected without reading a block.
+  // The iterators stream the column family and decode one match at a time.
+  bool ContainsImagePairMatch(const std::string& image_name1,
+                              const std::string& image_name2) override;
+  void ForEachMatchedImagePair(const ImagePairCallback& callback) override;
+  void ForEachImagePairMatch(const ImagePairMatchCallback& callback) override;
+
   void RemoveAllMatches() override;
 
+  // Get/set the hashed images of the cascade hashing matcher. These are kept in
+  // their own column family so that re-runs can skip hashing.
+  bool GetHashedImage(const std::string& image_name,
+                      HashedImage* hashed_image) override;
+  void PutHashedImage(const std::string& image_name,
+                      const HashedImage& hashed_image) override;
+
+  // Get/set the image file signatures. These are kept in their own column
+  // family next to the camera intrinsics priors.
+  bool GetImageFileSignature(const std::string& image_name,
+                             FileSignature* signature) override;
+  void PutImageFileSignature(const std::string& image_name,
+                             const FileSignature& signature) override;
+
+  // Failed image pairs are kept in their own column family. They are written
+  // through the same queue as the matches.
+  void PutFailedImagePair(const std::string& image_name1,
+                          const std::string& image_name2) override;
+  std::vector<std::pair<std::string, std::string>>
+  ImageNamesOfFailedImagePairs() override;
+  bool ContainsFailedImagePair(const std::string& image_name1,
+                               const std::string& image_name2) override;
+  void ForEachFailedImagePair(const ImagePairCallback& callback) override;
+
+  // Writes all queued matches and bulk loaded features and makes them durable.
+  void Flush() override;
+
  private:
   DISALLOW_COPY_AND_ASSIGN(RocksDbFeaturesAndMatchesDatabase);
 
   void InitializeRocksDB();
 
+  // The loop of the writer thread that stores the queued matches in batches.
+  void WriteQueuedMatches();
+
+  // Blocks until all queued matches have been written.
+  void WaitForQueuedMatches();
+
+  // Returns true if the column family has at least one key.
+  bool HasKeys(rocksdb::ColumnFamilyHandle* column_family);
+
+  // Reads the image ids from their column family.
+  void LoadImageIds();
+
+  // Returns the key of the image pair in the matches and failed image pairs
+  // column families, assigning ids to the images if needed. FindImagePairKey
+  // returns false instead if an image has no id, in which case the pair cannot
+  // be in the database.
+  std::string ImagePairKey(const std::string& image_name1,
+                           const std::string& image_name2);
+  bool FindImagePairKey(const std::string& image_name1,
+                        const std::string& image_name2,
+                        std::string* key);
+  std::pair<std::string, std::string> ImageNamesOfImagePairKey(
+      const rocksdb::Slice& key);
+
+  // Returns true if the key is in the column family. The bloom filter answers
+  // for most missing keys without a read.
+  bool ContainsKeyInColumnFamily(rocksdb::ColumnFamilyHandle* column_family,
+                                 const std::string& key);
+
+  // Deserializes a stored image pair match, which is either a cereal archive
+  // or encoded with the feature indices of the images.
+  ImagePairMatch DeserializeImagePairMatch(const std::string& image_name1,
+                                           const std::string& image_name2,
+                                           const rocksdb::Slice& value);
+
+  // Returns the keypoints of both images, stored in otherwise empty features,
+  // for encoding and decoding the matches.
+  std::pair<KeypointsAndDescriptors, KeypointsAndDescriptors>
+  KeypointsOfImagePair(const std::string& image_name1,
+                       const std::string& image_name2);
+
+  // Writes the pending bulk loaded features and keypoints to SST files and
+  // ingests them into the features and keypoints column families.
+  void IngestBulkLoadedFeatures();
+
   std::unique_ptr<rocksdb::Options> options_;
   std::string directory_;
   std::unique_ptr<rocksdb::DB> database_;
   std::unique_ptr<rocksdb::ColumnFamilyHandle> intrinsics_prior_handle_;
   std::unique_ptr<rocksdb::ColumnFamilyHandle> features_handle_;
+  std::unique_ptr<rocksdb::ColumnFamilyHandle> keypoints_handle_;
   std::unique_ptr<rocksdb::ColumnFamilyHandle> matches_handle_;
+  std::unique_ptr<rocksdb::ColumnFamilyHandle> hashed_images_handle_;
+  std::unique_ptr<rocksdb::ColumnFamilyHandle> failed_image_pairs_handle_;
+  std::unique_ptr<rocksdb::ColumnFamilyHandle> image_file_signatures_handle_;
+  // Null if the matches are keyed by image names.
+  std::unique_ptr<rocksdb::ColumnFamilyHandle> image_ids_handle_;
+
+  // Serializes the assignment and the writing of new image ids.
+  std::mutex image_ids_mutex_;
+
+  const Options database_options_;
+
+  // The options of each group of column families. The SST files of bulk
+  // loaded features are written with the database and features options.
+  std::unique_ptr<rocksdb::Options> features_column_family_options_;
+  std::unique_ptr<rocksdb::ColumnFamilyOptions> matches_column_family_options_;
+  std::unique_ptr<rocksdb::ColumnFamilyOptions>
+      intrinsics_column_family_options_;
+
+  // Serialized features and keypoints waiting to be bulk loaded, sorted by
+  // image name as required by the SST file writer.
+  std::mutex bulk_load_mutex_;
+  std::map<std::string, std::string> bulk_load_features_;
+  std::map<std::string, std::string> bulk_load_keypoints_;
+  size_t bulk_load_bytes_;
+  int num_bulk_load_files_;
+
+  // Serialized matches (key and value) waiting to be written by the writer
+  // thread.
+  std::mutex match_queue_mutex_;
+  std::condition_variable match_queue_condition_;
+  std::vector<std::pair<std::string, std::string>> queued_matches_;
+  std::vector<std::string> queued_failed_image_pairs_;
+  size_t queued_match_bytes_;
+  bool is_writing_matches_;
+  bool stop_match_writer_;
+  std::thread match_writer_;
 };
 
 #endif  // PYTHON_BUILD
@@ -8,6 +8,7 @@
 namespace theia {
 namespace {
 static std::string db_directory = THEIA_DATA_DIR + std::string("/database");
+static const int kNumDescriptorDimensions = 128;
 
 std::string RandomString(size_t length) {
   auto randchar = []() -> char {
@@ -36,10 +37,9 @@ TEST(RocksDbFeaturesAndMatchesDatabase, PutFeature) {
   // Create some features.
   KeypointsAndDescriptors features;
   features.keypoints.resize(kNumFeatures);
-  features.descriptors.resize(kNumFeatures);
+  features.descriptor_matrix.setRandom(kNumFeatures, kNumDescriptorDimensions);
   for (int i = 0; i < kNumFeatures; i++) {
     features.keypoints[i] = Keypoint(i, i + 1, Keypoint::OTHER);
-    features.descriptors[i].setRandom();
   }
 
   RocksDbFeaturesAndMatchesDatabase db(db_directory);
@@ -50,16 +50,86 @@ TEST(RocksDbFeaturesAndMatchesDatabase, PutFeature) {
   // Get the features and ensure they are correct.
   const KeypointsAndDescriptors db_features = db.GetFeatures(kImageName);
   ASSERT_EQ(db_features.keypoints.size(), kNumFeatures);
-  ASSERT_EQ(db_features.descriptors.size(), kNumFeatures);
+  ASSERT_EQ(db_features.NumDescriptors(), kNumFeatures);
   for (int i = 0; i < kNumFeatures; i++) {
     EXPECT_EQ(db_features.keypoints[i].x(), features.keypoints[i].x());
     EXPECT_EQ(db_features.keypoints[i].y(), features.keypoints[i].y());
-    EXPECT_EQ(db_features.descriptors[i], features.descriptors[i]);
+    EXPECT_EQ(db_features.Descriptor(i), features.Descriptor(i));
   }
 
   rocksdb::DestroyDB(db_directory, rocksdb::Options());
 }
 
+TEST(RocksDbFeaturesAndMatchesDatabase, GetKeypoints) {
+  static const int kNumFeatures = 100;
+  KeypointsAndDescriptors features;
+  features.keypoints.resize(kNumFeatures);
+  features.descriptor_matrix.setRandom(kNumFeatures, kNumDescriptorDimensions);
+  for (int i = 0; i < kNumFeatures; i++) {
+    features.keypoints[i] = Keypoint(i, i + 1, Keypoint::OTHER);
+  }
+
+  for (const bool bulk_load_features : {false, true}) {
+    RocksDbFeaturesAndMatchesDatabase::Options options;
+    options.bulk_load_features = bulk_load_features;
+    {
+      RocksDbFeaturesAndMatchesDatabase db(db_directory, options);
+      db.PutFeatures("image", features);
+      // Pending bulk loaded keypoints are read from memory.
+      EXPECT_EQ(db.GetKeypoints("image").size(), kNumFeatures);
+    }
+
+    RocksDbFeaturesAndMatchesDatabase db(db_directory);
+    const std::vector<Keypoint> keypoints = db.GetKeypoints("image");
+    ASSERT_EQ(keypoints.size(), kNumFeatures);
+    for (int i = 0; i < kNumFeatures; i++) {
+      EXPECT_EQ(keypoints[i].x(), features.keypoints[i].x());
+      EXPECT_EQ(keypoints[i].y(), features.keypoints[i].y());
+    }
+    rocksdb::DestroyDB(db_directory, rocksdb::Options());
+  }
+}
+
+TEST(RocksDbFeaturesAndMatchesDatabase, GetSharedFeaturesBatch) {
+  static const int kNumImages = 5;
+  for (const bool bulk_load_features : {false, true}) {
+    RocksDbFeaturesAndMatchesDatabase::Options options;
+    options.bulk_load_features = bulk_load_features;
+    {
+      RocksDbFeaturesAndMatchesDatabase db(db_directory, options);
+      std::vector<std::string> image_names;
+      for (int i = 0; i < kNumImages; i++) {
+        KeypointsAndDescriptors features;
+        features.keypoints.resize(10 + i);
+        features.descriptor_matrix.setRandom(10 + i, kNumDescriptorDimensions);
+        image_names.emplace_back(std::to_string(i));
+        db.PutFeatures(image_names.back(), features);
+      }
+      // Ingest the bulk loaded features so that the batch mixes features that
+      // are read from the database and from memory.
+      if (bulk_load_features) {
+        db.Flush();
+        db.PutFeatures("pending", db.GetFeatures("0"));
+        image_names.emplace_back("pending");
+      }
+
+      std::reverse(image_names.begin(), image_names.end());
+      const std::vector<std::shared_ptr<const KeypointsAndDescriptors>>
+          features = db.GetSharedFeaturesBatch(image_names);
+      ASSERT_EQ(features.size(), image_names.size());
+      for (int i = 0; i < image_names.size(); i++) {
+        const KeypointsAndDescriptors expected_features =
+            db.GetFeatures(image_names[i]);
+        EXPECT_EQ(features[i]->keypoints.size(),
+                  expected_features.keypoints.size());
+        EXPECT_TRUE(features[i]->descriptor_matrix ==
+                    expected_features.descriptor_matrix);
+      }
+    }
+    rocksdb::DestroyDB(db_directory, rocksdb::Options());
+  }
+}
+
 TEST(RocksDbFeaturesAndMatchesDatabase, GetFeatureFromInputDB) {
   static const std::string kImageName = "image_name";
   static const int kNumFeatures = 1000;
@@ -67,10 +137,9 @@ TEST(RocksDbFeaturesAndMatchesDatabase, GetFeatureFromInputDB) {
   // Create some features.
   KeypointsAndDescriptors features;
   features.keypoints.resize(kNumFeatures);
-  features.descriptors.resize(kNumFeatures);
+  features.descriptor_matrix.setRandom(kNumFeatures, kNumDescriptorDimensions);
   for (int i = 0; i < kNumFeatures; i++) {
     features.keypoints[i] = Keypoint(i, i + 1, Keypoint::OTHER);
-    features.descriptors[i].setRandom();
   }
 
   {
@@ -94,11 +163,11 @@ TEST(RocksDbFeaturesAndMatchesDatabase, GetFeatureFromInputDB) {
     // Get the features and ensure they are correct.
     const KeypointsAndDescriptors db_features = db.GetFeatures(kImageName);
     ASSERT_EQ(db_features.keypoints.size(), kNumFeatures);
-    ASSERT_EQ(db_features.descriptors.size(), kNumFeatures);
+    ASSERT_EQ(db_features.NumDescriptors(), kNumFeatures);
     for (int i = 0; i < kNumFeatures; i++) {
       EXPECT_EQ(db_features.keypoints[i].x(), features.keypoints[i].x());
       EXPECT_EQ(db_features.keypoints[i].y(), features.keypoints[i].y());
-      EXPECT_EQ(db_features.descriptors[i], features.descriptors[i]);
+      EXPECT_EQ(db_features.Descriptor(i), features.Descriptor(i));
     }
   }
 
@@ -154,7 +223,69 @@ TEST(RocksDbFeaturesAndMatchesDatabase, PutMatch) {}
 
 TEST(RocksDbFeaturesAndMatchesDatabase, GetMatchFromInputDB) {}
 
-TEST(RocksDbFeaturesAndMatchesDatabase, ContainsMatch) {}
+TEST(RocksDbFeaturesAndMatchesDatabase, ContainsMatch) {
+  static const int kNumPairs = 100;
+  static const int kStringLength = 64;
+
+  RocksDbFeaturesAndMatchesDatabase::Options options;
+  options.write_matches_asynchronously = true;
+  RocksDbFeaturesAndMatchesDatabase db(db_directory, options);
+
+  std::vector<std::pair<std::string, std::string>> random_strings;
+  ImagePairMatch match;
+  match.correspondences.resize(3);
+  for (int i = 0; i < kNumPairs; i++) {
+    random_strings.emplace_back(RandomString(kStringLength),
+                                RandomString(kStringLength));
+    if (i % 2 == 0) {
+      db.PutImagePairMatch(
+          random_strings[i].first, random_strings[i].second, match);
+    } else {
+      db.PutFailedImagePair(random_strings[i].first, random_strings[i].second);
+    }
+  }
+
+  // The existence checks see the queued writes.
+  for (int i = 0; i < kNumPairs; i++) {
+    const std::string& image1 = random_strings[i].first;
+    const std::string& image2 = random_strings[i].second;
+    EXPECT_EQ(db.ContainsImagePairMatch(image1, image2), i % 2 == 0);
+    EXPECT_EQ(db.ContainsFailedImagePair(image1, image2), i % 2 == 1);
+    // Pairs are ordered.
+    EXPECT_FALSE(db.ContainsImagePairMatch(image2, image1));
+  }
+
+  // The iterators visit every pair once and stop when the callback returns
+  // false.
+  int num_matches = 0;
+  db.ForEachImagePairMatch([&](const std::string& image1,
+                               const std::string& image2,
+                               const ImagePairMatch& stored_match) {
+    EXPECT_TRUE(db.ContainsImagePairMatch(image1, image2));
+    EXPECT_EQ(stored_match.correspondences.size(), 3);
+    ++num_matches;
+    return true;
+  });
+  EXPECT_EQ(num_matches, kNumPairs / 2);
+
+  int num_failed_pairs = 0;
+  db.ForEachFailedImagePair(
+      [&](const std::string& image1, const std::string& image2) {
+        EXPECT_TRUE(db.ContainsFailedImagePair(image1, image2));
+        ++num_failed_pairs;
+        return true;
+      });
+  EXPECT_EQ(num_failed_pairs, kNumPairs / 2);
+
+  int num_visited_pairs = 0;
+  db.ForEachMatchedImagePair([&](const std::string&, const std::string&) {
+    return ++num_visited_pairs < 5;
+  });
+  EXPECT_EQ(num_visited_pairs, 5);
+
+  rocksdb::DestroyDB(db_directory, rocksdb::Options());
+}
+
 TEST(RocksDbFeaturesAndMatchesDatabase, MatchNames) {
   static const int kNumMatches = 1000;
   static const int kStringLength = 64;
@@ -182,4 +313,262 @@ TEST(RocksDbFeaturesAndMatchesDatabase, MatchNames) {
 
   rocksdb::DestroyDB(db_directory, rocksdb::Options());
 }
+
+TEST(RocksDbFeaturesAndMatchesDatabase, ImageIdsPersist) {
+  {
+    RocksDbFeaturesAndMatchesDatabase db(db_directory);
+    EXPECT_EQ(db.GetOrAddImageId("a"), 0);
+    db.PutImagePairMatch("b", "c", ImagePairMatch());
+    EXPECT_EQ(db.FindImageId("b"), 1);
+    EXPECT_EQ(db.FindImageId("c"), 2);
+    EXPECT_EQ(db.FindImageId("d"), kInvalidImageId);
+    // Looking up a pair does not assign ids.
+    EXPECT_FALSE(db.ContainsImagePairMatch("a", "d"));
+    EXPECT_EQ(db.NumImageIds(), 3);
+  }
+
+  // The ids are restored when the database is opened again, and the matches
+  // keyed by them are found.
+  RocksDbFeaturesAndMatchesDatabase db(db_directory);
+  EXPECT_EQ(db.NumImageIds(), 3);
+  EXPECT_EQ(db.ImageNameOfId(0), "a");
+  EXPECT_EQ(db.FindImageId("c"), 2);
+  EXPECT_EQ(db.GetOrAddImageId("d"), 3);
+  EXPECT_TRUE(db.ContainsImagePairMatch("b", "c"));
+  const std::vector<std::pair<std::string, std::string>> match_names =
+      db.ImageNamesOfMatches();
+  ASSERT_EQ(match_names.size(), 1);
+  EXPECT_EQ(match_names[0], std::make_pair(std::string("b"), std::string("c")));
+
+  rocksdb::DestroyDB(db_directory, rocksdb::Options());
+}
+
+TEST(RocksDbFeaturesAndMatchesDatabase, AsynchronousMatchWrites) {
+  static const int kNumMatches = 1000;
+  static const int kStringLength = 64;
+
+  std::vector<std::pair<std::string, std::string>> random_strings;
+  {
+    RocksDbFeaturesAndMatchesDatabase::Options options;
+    options.write_matches_asynchronously = true;
+    options.disable_write_ahead_log_for_matches = true;
+    // Force the matching thread to wait for the writer.
+    options.max_pending_match_bytes = 1024;
+    RocksDbFeaturesAndMatchesDatabase db(db_directory, options);
+
+    ImagePairMatch match;
+    match.correspondences.resize(10);
+    for (int i = 0; i < kNumMatches; i++) {
+      random_strings.emplace_back(RandomString(kStringLength),
+                                  RandomString(kStringLength));
+      db.PutImagePairMatch(
+          random_strings[i].first, random_strings[i].second, match);
+    }
+
+    // Reading the matches waits for the queued writes.
+    EXPECT_EQ(db.GetImagePairMatch(random_strings[0].first,
+                                   random_strings[0].second)
+                  .correspondences.size(),
+              10);
+    // The database is flushed when it goes out of scope.
+  }
+
+  // The matches must survive closing the database without the WAL.
+  RocksDbFeaturesAndMatchesDatabase db(db_directory);
+  std::sort(random_strings.begin(), random_strings.end());
+  std::vector<std::pair<std::string, std::string>> match_names =
+      db.ImageNamesOfMatches();
+  std::sort(match_names.begin(), match_names.end());
+  ASSERT_EQ(random_strings.size(), match_names.size());
+  for (int i = 0; i < random_strings.size(); i++) {
+    EXPECT_EQ(random_strings[i], match_names[i]);
+  }
+
+  rocksdb::DestroyDB(db_directory, rocksdb::Options());
+}
+
+TEST(RocksDbFeaturesAndMatchesDatabase, MatchesEncodedWithFeatureIndices) {
+  static const int kNumFeatures = 1000;
+
+  KeypointsAndDescriptors features1, features2;
+  for (int i = 0; i < kNumFeatures; i++) {
+    features1.keypoints.emplace_back(i, i + 1, Keypoint::OTHER);
+    features2.keypoints.emplace_back(2 * i, i + 3, Keypoint::OTHER);
+  }
+
+  // The last correspondence is not between keypoints.
+  ImagePairMatch match;
+  match.image1 = "image1";
+  match.image2 = "image2";
+  for (int i = 0; i < kNumFeatures; i += 2) {
+    const int j = kNumFeatures - 1 - i;
+    match.correspondences.emplace_back(
+        Feature(features1.keypoints[i].x(), features1.keypoints[i].y()),
+        Feature(features2.keypoints[j].x(), features2.keypoints[j].y()));
+  }
+  match.correspondences.emplace_back(Feature(0.5, 0.5), Feature(1.5, 1.5));
+
+  {
+    RocksDbFeaturesAndMatchesDatabase::Options options;
+    options.encode_matches_with_feature_indices = true;
+    RocksDbFeaturesAndMatchesDatabase db(db_directory, options);
+    db.PutFeatures("image1", features1);
+    db.PutFeatures("image2", features2);
+    db.PutImagePairMatch("image1", "image2", match);
+    // Images without features fall back to cereal.
+    db.PutImagePairMatch("image3", "image4", match);
+  }
+
+  // The encoded matches are read without the option, too.
+  RocksDbFeaturesAndMatchesDatabase db(db_directory);
+  const std::vector<std::pair<std::string, std::string>> image_pairs = {
+      {"image1", "image2"}, {"image3", "image4"}};
+  for (const auto& image_names : image_pairs) {
+    const ImagePairMatch db_match =
+        db.GetImagePairMatch(image_names.first, image_names.second);
+    EXPECT_EQ(db_match.image1, match.image1);
+    EXPECT_EQ(db_match.image2, match.image2);
+    EXPECT_EQ(db_match.correspondences, match.correspondences);
+  }
+
+  rocksdb::DestroyDB(db_directory, rocksdb::Options());
+}
+
+TEST(RocksDbFeaturesAndMatchesDatabase, FailedImagePairs) {
+  static const int kNumPairs = 100;
+  static const int kStringLength = 64;
+
+  std::vector<std::pair<std::string, std::string>> random_strings;
+  {
+    RocksDbFeaturesAndMatchesDatabase db(db_directory);
+    for (int i = 0; i < kNumPairs; i++) {
+      random_strings.emplace_back(RandomString(kStringLength),
+                                  RandomString(kStringLength));
+      db.PutFailedImagePair(random_strings[i].first, random_strings[i].second);
+    }
+    // Failed pairs are not matches.
+    EXPECT_TRUE(db.ImageNamesOfMatches().empty());
+  }
+
+  // The failed pairs must survive closing the database.
+  {
+    RocksDbFeaturesAndMatchesDatabase db(db_directory);
+    std::sort(random_strings.begin(), random_strings.end());
+    std::vector<std::pair<std::string, std::string>> failed_pairs =
+        db.ImageNamesOfFailedImagePairs();
+    std::sort(failed_pairs.begin(), failed_pairs.end());
+    ASSERT_EQ(random_strings.size(), failed_pairs.size());
+    for (int i = 0; i < random_strings.size(); i++) {
+      EXPECT_EQ(random_strings[i], failed_pairs[i]);
+    }
+
+    // Removing the matches also removes the failed pairs.
+    db.RemoveAllMatches();
+    EXPECT_TRUE(db.ImageNamesOfFailedImagePairs().empty());
+  }
+
+  rocksdb::DestroyDB(db_directory, rocksdb::Options());
+}
+
+TEST(RocksDbFeaturesAndMatchesDatabase, ImageFileSignatures) {
+  FileSignature signature;
+  signature.size = 123456789;
+  signature.modification_time = 1600000000;
+  {
+    RocksDbFeaturesAndMatchesDatabase db(db_directory);
+    FileSignature missing_signature;
+    EXPECT_FALSE(db.GetImageFileSignature("img1.jpg", &missing_signature));
+    db.PutImageFileSignature("img1.jpg", signature);
+  }
+
+  // The signatures must survive closing the database and are not priors.
+  {
+    RocksDbFeaturesAndMatchesDatabase db(db_directory);
+    FileSignature stored_signature;
+    EXPECT_TRUE(db.GetImageFileSignature("img1.jpg", &stored_signature));
+    EXPECT_EQ(stored_signature, signature);
+    EXPECT_FALSE(db.ContainsCameraIntrinsicsPrior("img1.jpg"));
+  }
+
+  rocksdb::DestroyDB(db_directory, rocksdb::Options());
+}
+
+TEST(RocksDbFeaturesAndMatchesDatabase, TunedColumnFamilies) {
+  static const int kNumFeatures = 100;
+
+  KeypointsAndDescriptors features;
+  features.keypoints.resize(kNumFeatures);
+  features.descriptor_matrix.setRandom(kNumFeatures, kNumDescriptorDimensions);
+
+  RocksDbFeaturesAndMatchesDatabase::Options options;
+  options.features_options.compression =
+      RocksDbFeaturesAndMatchesDatabase::Compression::NONE;
+  options.features_options.block_cache_size = 0;
+  options.matches_options.bloom_filter_bits_per_key = 0;
+  options.intrinsics_options.block_size = 4 << 10;
+  {
+    RocksDbFeaturesAndMatchesDatabase db(db_directory, options);
+    db.PutFeatures("image", features);
+    db.PutCameraIntrinsicsPrior("image", CameraIntrinsicsPrior());
+  }
+
+  // The database may be reopened with different tuning.
+  RocksDbFeaturesAndMatchesDatabase db(db_directory);
+  EXPECT_TRUE(db.ContainsCameraIntrinsicsPrior("image"));
+  const KeypointsAndDescriptors db_features = db.GetFeatures("image");
+  ASSERT_EQ(db_features.NumDescriptors(), kNumFeatures);
+  for (int i = 0; i < kNumFeatures; i++) {
+    EXPECT_EQ(db_features.Descriptor(i), features.Descriptor(i));
+  }
+
+  rocksdb::DestroyDB(db_directory, rocksdb::Options());
+}
+
+TEST(RocksDbFeaturesAndMatchesDatabase, BulkLoadFeatures) {
+  static const int kNumImages = 20;
+  static const int kNumFeatures = 100;
+
+  KeypointsAndDescriptors features;
+  features.keypoints.resize(kNumFeatures);
+  features.descriptor_matrix.setRandom(kNumFeatures, kNumDescriptorDimensions);
+
+  // A small batch size so that several SST files are ingested.
+  RocksDbFeaturesAndMatchesDatabase::Options options;
+  options.bulk_load_features = true;
+  options.bulk_load_batch_size_in_bytes = 8 * kNumFeatures * sizeof(float) *
+                                          kNumDescriptorDimensions;
+  std::vector<std::string> image_names;
+  {
+    RocksDbFeaturesAndMatchesDatabase db(db_directory, options);
+    for (int i = 0; i < kNumImages; i++) {
+      // Images are not added in sorted order.
+      image_names.emplace_back(RandomString(16));
+      db.PutFeatures(image_names.back(), features);
+      // Pending features are available before they are ingested.
+      EXPECT_TRUE(db.ContainsFeatures(image_names.back()));
+      EXPECT_EQ(db.GetFeatures(image_names.back()).NumDescriptors(),
+                kNumFeatures);
+    }
+    EXPECT_EQ(db.ImageNamesOfFeatures().size(), kNumImages);
+
+    // Replacing the features of an ingested image keeps the newest features.
+    KeypointsAndDescriptors new_features;
+    new_features.keypoints.resize(1);
+    new_features.descriptor_matrix.setRandom(1, kNumDescriptorDimensions);
+    db.PutFeatures(image_names[0], new_features);
+    // The destructor ingests the remaining features.
+  }
+
+  RocksDbFeaturesAndMatchesDatabase db(db_directory);
+  EXPECT_EQ(db.GetFeatures(image_names[0]).NumDescriptors(), 1);
+  for (int i = 1; i < kNumImages; i++) {
+    EXPECT_EQ(db.GetFeatures(image_names[i]).NumDescriptors(), kNumFeatures);
+  }
+  std::vector<std::string> db_image_names = db.ImageNamesOfFeatures();
+  std::sort(image_names.begin(), image_names.end());
+  std::sort(db_image_names.begin(), db_image_names.end());
+  EXPECT_EQ(db_image_names, image_names);
+
+  rocksdb::DestroyDB(db_directory, rocksdb::Options());
+}
 }  // namespace theia
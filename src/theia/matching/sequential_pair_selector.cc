@@ -0,0 +1,105 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#include "theia/matching/sequential_pair_selector.h"
+
+#include <glog/logging.h>
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+namespace theia {
+
+SequentialPairSelector::SequentialPairSelector(const Options& options,
+                                               const int num_images)
+    : options_(options),
+      num_images_(num_images),
+      window_size_(num_images, options.min_window_size),
+      num_matched_images_(num_images, 0),
+      num_consecutive_inliers_(num_images, 0) {
+  CHECK_GT(options_.min_window_size, 0);
+  CHECK_GE(options_.max_window_size, options_.min_window_size);
+  CHECK_GE(options_.min_inlier_ratio_to_grow_window, 0.0);
+}
+
+const std::vector<std::pair<int, int> >&
+SequentialPairSelector::NextPairsToMatch() {
+  pairs_to_match_.clear();
+  for (int i = 0; i < num_images_; i++) {
+    const int window_size = std::min(window_size_[i], num_images_ - 1 - i);
+    for (int j = num_matched_images_[i] + 1; j <= window_size; j++) {
+      pairs_to_match_.emplace_back(i, i + j);
+    }
+    num_matched_images_[i] = std::max(num_matched_images_[i], window_size);
+  }
+  return pairs_to_match_;
+}
+
+void SequentialPairSelector::UpdateWindows(
+    const std::vector<int>& num_verified_matches) {
+  CHECK_EQ(num_verified_matches.size(), pairs_to_match_.size());
+
+  // Pairs are ordered by the first image, so the last pair of each image is the
+  // one at the end of its window.
+  for (int i = 0; i < pairs_to_match_.size(); i++) {
+    const int image_index = pairs_to_match_[i].first;
+    const int offset = pairs_to_match_[i].second - image_index;
+    if (offset == 1) {
+      num_consecutive_inliers_[image_index] = num_verified_matches[i];
+    }
+
+    const bool is_end_of_window =
+        i + 1 == pairs_to_match_.size() ||
+        pairs_to_match_[i + 1].first != image_index;
+    if (!is_end_of_window || offset != window_size_[image_index] ||
+        window_size_[image_index] >= options_.max_window_size ||
+        num_consecutive_inliers_[image_index] == 0) {
+      continue;
+    }
+
+    const double inlier_ratio =
+        static_cast<double>(num_verified_matches[i]) /
+        static_cast<double>(num_consecutive_inliers_[image_index]);
+    if (inlier_ratio >= options_.min_inlier_ratio_to_grow_window) {
+      window_size_[image_index] = std::min(2 * window_size_[image_index],
+                                           options_.max_window_size);
+    }
+  }
+}
+
+int SequentialPairSelector::WindowSize(const int image_index) const {
+  return window_size_[image_index];
+}
+
+}  // namespace theia
@@ -0,0 +1,103 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#ifndef THEIA_MATCHING_SEQUENTIAL_PAIR_SELECTOR_H_
+#define THEIA_MATCHING_SEQUENTIAL_PAIR_SELECTOR_H_
+
+#include <utility>
+#include <vector>
+
+namespace theia {
+
+// Selects the image pairs to match for an image sequence (e.g., video or drone
+// captures) so that matching is linear rather than quadratic in the number of
+// images. Images are identified by their index in temporal order and each
+// image i is matched to the images i + 1, ..., i + w_i that follow it.
+//
+// The window size w_i adapts to the overlap of the sequence: every window
+// starts at min_window_size and is doubled (up to max_window_size) for as long
+// as the pair at its far end still verifies with at least
+// min_inlier_ratio_to_grow_window times as many inliers as the pair of
+// consecutive images (i, i + 1). Slow camera motion therefore leads to wide
+// windows and fast motion to narrow ones.
+//
+// Pairs are selected in rounds: NextPairsToMatch returns the pairs that have
+// not been matched yet, and after matching them UpdateWindows must be called
+// with their number of verified inliers to decide which windows to grow.
+class SequentialPairSelector {
+ public:
+  struct Options {
+    // The initial and maximum number of subsequent images that each image is
+    // matched to.
+    int min_window_size = 5;
+    int max_window_size = 40;
+
+    // The window of an image is grown if the pair at the end of its window has
+    // at least this ratio of the number of inliers of the consecutive pair.
+    double min_inlier_ratio_to_grow_window = 0.5;
+  };
+
+  SequentialPairSelector(const Options& options, const int num_images);
+
+  // Returns the pairs (i, j) with i < j within the current windows that have
+  // not been returned yet. Returns an empty vector once no window grows.
+  const std::vector<std::pair<int, int> >& NextPairsToMatch();
+
+  // Sets the number of verified inliers (0 if verification failed) of each of
+  // the pairs returned by the last call to NextPairsToMatch, in the same order,
+  // and grows the windows accordingly.
+  void UpdateWindows(const std::vector<int>& num_verified_matches);
+
+  // The current window size of the image.
+  int WindowSize(const int image_index) const;
+
+ private:
+  const Options options_;
+  const int num_images_;
+
+  // The current window size of each image and the number of subsequent images
+  // that it has been matched to.
+  std::vector<int> window_size_;
+  std::vector<int> num_matched_images_;
+
+  // The number of inliers between each image and the next image.
+  std::vector<int> num_consecutive_inliers_;
+
+  // The pairs returned by the last call to NextPairsToMatch.
+  std::vector<std::pair<int, int> > pairs_to_match_;
+};
+
+}  // namespace theia
+
+#endif  // THEIA_MATCHING_SEQUENTIAL_PAIR_SELECTOR_H_
@@ -0,0 +1,116 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#include <algorithm>
+#include <set>
+#include <utility>
+#include <vector>
+
+#include "theia/matching/sequential_pair_selector.h"
+
+#include "gtest/gtest.h"
+
+namespace theia {
+
+namespace {
+
+static const int kNumImages = 100;
+
+// The first half of the sequence moves slowly so that images overlap with the
+// following 40 images, while the second half only overlaps with 4 images.
+int NumVerifiedMatches(const int image1, const int image2) {
+  const double overlap = image1 < kNumImages / 2 ? 40.0 : 4.0;
+  return static_cast<int>(
+      100.0 * std::max(0.0, 1.0 - (image2 - image1) / overlap));
+}
+
+}  // namespace
+
+TEST(SequentialPairSelectorTest, AdaptsWindowsToOverlap) {
+  SequentialPairSelector::Options options;
+  options.min_window_size = 2;
+  options.max_window_size = 16;
+  options.min_inlier_ratio_to_grow_window = 0.5;
+  SequentialPairSelector selector(options, kNumImages);
+
+  std::set<std::pair<int, int> > matched_pairs;
+  int num_rounds = 0;
+  while (true) {
+    const std::vector<std::pair<int, int> > pairs =
+        selector.NextPairsToMatch();
+    if (pairs.empty()) {
+      break;
+    }
+    ++num_rounds;
+
+    std::vector<int> num_verified_matches;
+    for (const auto& pair : pairs) {
+      EXPECT_LT(pair.first, pair.second);
+      // Each pair is only returned once.
+      EXPECT_TRUE(matched_pairs.insert(pair).second);
+      num_verified_matches.emplace_back(
+          NumVerifiedMatches(pair.first, pair.second));
+    }
+    selector.UpdateWindows(num_verified_matches);
+  }
+
+  // 2 -> 4 -> 8 -> 16 requires four rounds of matching.
+  EXPECT_EQ(num_rounds, 4);
+  EXPECT_EQ(selector.WindowSize(0), 16);
+  EXPECT_EQ(selector.WindowSize(kNumImages / 2), 4);
+
+  // All pairs within the final windows were matched.
+  for (int i = 0; i < kNumImages; i++) {
+    for (int j = i + 1; j <= std::min(kNumImages - 1, i + selector.WindowSize(i));
+         j++) {
+      EXPECT_EQ(matched_pairs.count(std::make_pair(i, j)), 1);
+    }
+  }
+  EXPECT_LT(matched_pairs.size(), kNumImages * 16);
+}
+
+TEST(SequentialPairSelectorTest, FailedConsecutivePairDoesNotGrowWindow) {
+  SequentialPairSelector::Options options;
+  options.min_window_size = 1;
+  options.max_window_size = 8;
+  SequentialPairSelector selector(options, 10);
+
+  const std::vector<std::pair<int, int> > pairs = selector.NextPairsToMatch();
+  EXPECT_EQ(pairs.size(), 9);
+  selector.UpdateWindows(std::vector<int>(pairs.size(), 0));
+  EXPECT_TRUE(selector.NextPairsToMatch().empty());
+  EXPECT_EQ(selector.WindowSize(0), 1);
+}
+
+}  // namespace theia
@@ -0,0 +1,113 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#include "theia/matching/spatial_pair_selection.h"
+
+#include <Eigen/Core>
+#include <glog/logging.h>
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include "flann/flann.hpp"
+
+namespace theia {
+
+void SelectImagePairsWithPositionPriors(
+    const SpatialPairSelectionOptions& options,
+    const std::vector<Eigen::Vector3d>& positions,
+    std::vector<std::pair<int, int> >* image_pairs) {
+  CHECK_NOTNULL(image_pairs)->clear();
+  CHECK(options.num_nearest_neighbors > 0 || options.max_distance > 0.0)
+      << "Either the number of nearest neighbors or the maximum distance must "
+         "be set to select image pairs from position priors.";
+  if (positions.size() < 2) {
+    return;
+  }
+
+  // Eigen::Vector3d is not padded, so the positions may be used as a row-major
+  // matrix directly.
+  flann::Matrix<double> flann_positions(
+      const_cast<double*>(positions[0].data()), positions.size(), 3);
+  flann::Index<flann::L2<double> > kd_tree(flann_positions,
+                                           flann::KDTreeSingleIndexParams());
+  kd_tree.buildIndex();
+
+  // The search is exact. Each query returns the image itself as well, so one
+  // more neighbor is requested.
+  flann::SearchParams search_params(flann::FLANN_CHECKS_UNLIMITED);
+  std::vector<std::vector<size_t> > nn_indices;
+  std::vector<std::vector<double> > nn_distances;
+  if (options.max_distance > 0.0) {
+    search_params.max_neighbors = options.num_nearest_neighbors > 0
+                                      ? options.num_nearest_neighbors + 1
+                                      : -1;
+    // FLANN uses squared distances.
+    kd_tree.radiusSearch(flann_positions,
+                         nn_indices,
+                         nn_distances,
+                         options.max_distance * options.max_distance,
+                         search_params);
+  } else {
+    const int num_nearest_neighbors =
+        std::min(options.num_nearest_neighbors + 1,
+                 static_cast<int>(positions.size()));
+    kd_tree.knnSearch(flann_positions,
+                      nn_indices,
+                      nn_distances,
+                      num_nearest_neighbors,
+                      search_params);
+  }
+
+  for (int i = 0; i < nn_indices.size(); i++) {
+    int num_neighbors = 0;
+    for (const size_t j : nn_indices[i]) {
+      if (j == i) {
+        continue;
+      }
+      if (options.num_nearest_neighbors > 0 &&
+          num_neighbors == options.num_nearest_neighbors) {
+        break;
+      }
+      image_pairs->emplace_back(std::min<int>(i, j), std::max<int>(i, j));
+      ++num_neighbors;
+    }
+  }
+
+  std::sort(image_pairs->begin(), image_pairs->end());
+  image_pairs->erase(std::unique(image_pairs->begin(), image_pairs->end()),
+                     image_pairs->end());
+}
+
+}  // namespace theia
@@ -0,0 +1,69 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#ifndef THEIA_MATCHING_SPATIAL_PAIR_SELECTION_H_
+#define THEIA_MATCHING_SPATIAL_PAIR_SELECTION_H_
+
+#include <Eigen/Core>
+#include <utility>
+#include <vector>
+
+namespace theia {
+
+struct SpatialPairSelectionOptions {
+  // Each image is paired with (at most) this many of its nearest neighbors. If
+  // this is not positive then the number of neighbors is unbounded and
+  // max_distance must be set.
+  int num_nearest_neighbors = 20;
+
+  // If positive, only images whose positions are within this distance of each
+  // other are paired. The distance is in the units of the positions (i.e.,
+  // meters for ECEF coordinates).
+  double max_distance = 0.0;
+};
+
+// Selects the image pairs to match from position priors (e.g., GPS positions
+// converted to ECEF coordinates with GPSConverter::LLAToECEF). A KD-tree is
+// built over the positions and each image is paired with its k-nearest and/or
+// radius neighbors, so the number of pairs is linear in the number of images.
+// The output pairs (i, j) index into positions, have i < j, and are sorted and
+// unique.
+void SelectImagePairsWithPositionPriors(
+    const SpatialPairSelectionOptions& options,
+    const std::vector<Eigen::Vector3d>& positions,
+    std::vector<std::pair<int, int> >* image_pairs);
+
+}  // namespace theia
+
+#endif  // THEIA_MATCHING_SPATIAL_PAIR_SELECTION_H_
@@ -0,0 +1,121 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#include <Eigen/Core>
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include "theia/matching/spatial_pair_selection.h"
+
+#include "gtest/gtest.h"
+
+namespace theia {
+
+namespace {
+
+static const int kGridSize = 10;
+static const double kGridSpacing = 10.0;
+
+// Positions on a regular grid, offset by a typical ECEF position.
+std::vector<Eigen::Vector3d> GridPositions() {
+  const Eigen::Vector3d origin(-2.7e6, -4.3e6, 3.9e6);
+  std::vector<Eigen::Vector3d> positions;
+  for (int i = 0; i < kGridSize; i++) {
+    for (int j = 0; j < kGridSize; j++) {
+      positions.emplace_back(origin +
+                             Eigen::Vector3d(i * kGridSpacing, j * kGridSpacing,
+                                             0.0));
+    }
+  }
+  return positions;
+}
+
+bool ContainsPair(const std::vector<std::pair<int, int> >& image_pairs,
+                  const int image1,
+                  const int image2) {
+  return std::binary_search(
+      image_pairs.begin(), image_pairs.end(), std::make_pair(image1, image2));
+}
+
+}  // namespace
+
+TEST(SpatialPairSelectionTest, RadiusNeighbors) {
+  SpatialPairSelectionOptions options;
+  options.num_nearest_neighbors = 0;
+  options.max_distance = 1.05 * kGridSpacing;
+  std::vector<std::pair<int, int> > image_pairs;
+  SelectImagePairsWithPositionPriors(options, GridPositions(), &image_pairs);
+
+  // Only the horizontal and vertical grid neighbors are within the radius.
+  EXPECT_EQ(image_pairs.size(), 2 * kGridSize * (kGridSize - 1));
+  EXPECT_TRUE(ContainsPair(image_pairs, 0, 1));
+  EXPECT_TRUE(ContainsPair(image_pairs, 0, kGridSize));
+  EXPECT_FALSE(ContainsPair(image_pairs, 0, kGridSize + 1));
+  for (const auto& image_pair : image_pairs) {
+    EXPECT_LT(image_pair.first, image_pair.second);
+  }
+}
+
+TEST(SpatialPairSelectionTest, NearestNeighbors) {
+  SpatialPairSelectionOptions options;
+  options.num_nearest_neighbors = 2;
+  std::vector<std::pair<int, int> > image_pairs;
+  SelectImagePairsWithPositionPriors(options, GridPositions(), &image_pairs);
+
+  // The corner image only has two neighbors at the grid spacing.
+  EXPECT_TRUE(ContainsPair(image_pairs, 0, 1));
+  EXPECT_TRUE(ContainsPair(image_pairs, 0, kGridSize));
+  EXPECT_FALSE(ContainsPair(image_pairs, 0, kGridSize + 1));
+
+  // Every image is paired with at least 2 and each image adds at most 2 pairs.
+  std::vector<int> num_pairs(kGridSize * kGridSize, 0);
+  for (const auto& image_pair : image_pairs) {
+    ++num_pairs[image_pair.first];
+    ++num_pairs[image_pair.second];
+  }
+  EXPECT_GE(*std::min_element(num_pairs.begin(), num_pairs.end()), 2);
+  EXPECT_LE(image_pairs.size(), 2 * kGridSize * kGridSize);
+}
+
+TEST(SpatialPairSelectionTest, NearestNeighborsWithinRadius) {
+  SpatialPairSelectionOptions options;
+  options.num_nearest_neighbors = 8;
+  options.max_distance = 1.05 * kGridSpacing;
+  std::vector<std::pair<int, int> > image_pairs;
+  SelectImagePairsWithPositionPriors(options, GridPositions(), &image_pairs);
+  EXPECT_EQ(image_pairs.size(), 2 * kGridSize * (kGridSize - 1));
+}
+
+}  // namespace theia
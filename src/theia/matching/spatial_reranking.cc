@@ -0,0 +1,382 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+
+#include "theia/matching/spatial_reranking.h"
+
+#include <Eigen/Core>
+#include <Eigen/QR>
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <complex>
+#include <limits>
+#include <numeric>
+#include <utility>
+#include <vector>
+
+#include "theia/matching/keypoints_and_descriptors.h"
+#include "theia/util/executor.h"
+
+namespace theia {
+
+namespace {
+
+// Similarity hypotheses are generated from all pairs of the best matches up to
+// this number, which bounds the number of two point hypotheses to 120.
+static const int kMaxNumMatchesForTwoPointHypotheses = 16;
+
+// Hypotheses from two points that are closer than this many pixels or that
+// change the scale by more than this factor are degenerate and skipped.
+static const double kMinPointDistance = 1.0;
+static const double kMaxScaleChange = 10.0;
+
+// A ratio test match between the subsampled features of two images. Points
+// are represented as complex numbers so that a similarity transformation is
+// z2 = a * z1 + b.
+struct Correspondence {
+  std::complex<double> point1;
+  std::complex<double> point2;
+  float distance;
+  int index1;
+  int index2;
+};
+
+// Matches the features of the first image to the features of the second image
+// with Lowe's ratio test. The correspondences are sorted by increasing
+// descriptor distance.
+void MatchFeatures(const SpatialRerankingOptions& options,
+                   const SpatialRerankingFeatures& features1,
+                   const SpatialRerankingFeatures& features2,
+                   std::vector<Correspondence>* correspondences) {
+  correspondences->clear();
+  const int num_features1 = features1.descriptors.cols();
+  const int num_features2 = features2.descriptors.cols();
+  if (num_features1 == 0 || num_features2 < 2) {
+    return;
+  }
+
+  // distances(j, i) is the squared distance between feature j of the second
+  // image and feature i of the first image, up to the squared norm of feature
+  // i which does not change the nearest neighbors or the ratio test.
+  Eigen::MatrixXf distances =
+      -2.0f * features2.descriptors.transpose() * features1.descriptors;
+  distances.colwise() +=
+      features2.descriptors.colwise().squaredNorm().transpose();
+  const Eigen::RowVectorXf squared_norms1 =
+      features1.descriptors.colwise().squaredNorm();
+
+  const float squared_ratio = options.lowes_ratio * options.lowes_ratio;
+  for (int i = 0; i < num_features1; i++) {
+    float best_distance = std::numeric_limits<float>::max();
+    float second_best_distance = std::numeric_limits<float>::max();
+    int best_index = -1;
+    for (int j = 0; j < num_features2; j++) {
+      const float distance = distances(j, i);
+      if (distance < best_distance) {
+        second_best_distance = best_distance;
+        best_distance = distance;
+        best_index = j;
+      } else if (distance < second_best_distance) {
+        second_best_distance = distance;
+      }
+    }
+    best_distance = std::max(0.0f, best_distance + squared_norms1(i));
+    second_best_distance =
+        std::max(0.0f, second_best_distance + squared_norms1(i));
+    if (best_distance > squared_ratio * second_best_distance) {
+      continue;
+    }
+
+    const Keypoint& keypoint1 = features1.keypoints[i];
+    const Keypoint& keypoint2 = features2.keypoints[best_index];
+    Correspondence correspondence;
+    correspondence.point1 = std::complex<double>(keypoint1.x(), keypoint1.y());
+    correspondence.point2 = std::complex<double>(keypoint2.x(), keypoint2.y());
+    correspondence.distance = best_distance;
+    correspondence.index1 = i;
+    correspondence.index2 = best_index;
+    correspondences->emplace_back(correspondence);
+  }
+
+  std::sort(correspondences->begin(),
+            correspondences->end(),
+            [](const Correspondence& lhs, const Correspondence& rhs) {
+              return lhs.distance < rhs.distance;
+            });
+}
+
+// Counts the correspondences that the similarity z2 = a * z1 + b transfers
+// within the threshold.
+int CountSimilarityInliers(const std::vector<Correspondence>& correspondences,
+                           const std::complex<double>& a,
+                           const std::complex<double>& b,
+                           const double squared_threshold) {
+  int num_inliers = 0;
+  for (const Correspondence& correspondence : correspondences) {
+    if (std::norm(a * correspondence.point1 + b - correspondence.point2) <=
+        squared_threshold) {
+      ++num_inliers;
+    }
+  }
+  return num_inliers;
+}
+
+// Returns the indices of the correspondences that the affine transformation
+// transfers within the threshold. The affine transformation maps the row
+// vector (x, y, 1) to the row vector (x', y').
+void FindAffineInliers(const std::vector<Correspondence>& correspondences,
+                       const Eigen::Matrix<double, 3, 2>& affine,
+                       const double squared_threshold,
+                       std::vector<int>* inliers) {
+  inliers->clear();
+  for (int i = 0; i < correspondences.size(); i++) {
+    const Correspondence& correspondence = correspondences[i];
+    const Eigen::RowVector2d transferred =
+        Eigen::RowVector3d(correspondence.point1.real(),
+                           correspondence.point1.imag(),
+                           1.0) *
+        affine;
+    const Eigen::RowVector2d point2(correspondence.point2.real(),
+                                    correspondence.point2.imag());
+    if ((transferred - point2).squaredNorm() <= squared_threshold) {
+      inliers->emplace_back(i);
+    }
+  }
+}
+
+bool IsPlausibleSimilarity(const std::complex<double>& a) {
+  const double scale = std::abs(a);
+  return scale <= kMaxScaleChange && scale >= 1.0 / kMaxScaleChange;
+}
+
+}  // namespace
+
+void SelectSpatialRerankingFeatures(const SpatialRerankingOptions& options,
+                                    const KeypointsAndDescriptors& features,
+                                    SpatialRerankingFeatures* subsample) {
+  CHECK_NOTNULL(subsample);
+  CHECK_GT(options.max_num_features, 0);
+  subsample->keypoints.clear();
+  subsample->descriptors.resize(0, 0);
+  if (features.HasBinaryDescriptors()) {
+    return;
+  }
+  const int num_features = features.NumDescriptors();
+  CHECK_EQ(features.keypoints.size(), num_features);
+
+  std::vector<int> indices(num_features);
+  std::iota(indices.begin(), indices.end(), 0);
+  const int num_selected = std::min(num_features, options.max_num_features);
+  const bool has_strength =
+      std::all_of(features.keypoints.begin(),
+                  features.keypoints.end(),
+                  [](const Keypoint& keypoint) {
+                    return keypoint.has_strength();
+                  });
+  if (has_strength && num_selected < num_features) {
+    std::nth_element(indices.begin(),
+                     indices.begin() + num_selected,
+                     indices.end(),
+                     [&](const int lhs, const int rhs) {
+                       return features.keypoints[lhs].strength() >
+                              features.keypoints[rhs].strength();
+                     });
+    std::sort(indices.begin(), indices.begin() + num_selected);
+  }
+
+  subsample->keypoints.reserve(num_selected);
+  subsample->descriptors.resize(features.DescriptorDimension(), num_selected);
+  for (int i = 0; i < num_selected; i++) {
+    subsample->keypoints.emplace_back(features.keypoints[indices[i]]);
+    subsample->descriptors.col(i) =
+        features.FloatDescriptor(indices[i]).transpose();
+  }
+}
+
+int ComputeSpatialRerankingScore(const SpatialRerankingOptions& options,
+                                 const SpatialRerankingFeatures& features1,
+                                 const SpatialRerankingFeatures& features2) {
+  std::vector<Correspondence> correspondences;
+  MatchFeatures(options, features1, features2, &correspondences);
+  if (correspondences.size() < 2) {
+    return 0;
+  }
+  const double squared_threshold =
+      options.max_transfer_error_pixels * options.max_transfer_error_pixels;
+
+  // Find the similarity with the most inliers.
+  int best_num_inliers = 0;
+  std::complex<double> best_a, best_b;
+  const auto score_hypothesis = [&](const std::complex<double>& a,
+                                    const std::complex<double>& b) {
+    const int num_inliers =
+        CountSimilarityInliers(correspondences, a, b, squared_threshold);
+    if (num_inliers > best_num_inliers) {
+      best_num_inliers = num_inliers;
+      best_a = a;
+      best_b = b;
+    }
+  };
+
+  // One point hypotheses from the scale and orientation of the keypoints.
+  for (const Correspondence& correspondence : correspondences) {
+    const Keypoint& keypoint1 = features1.keypoints[correspondence.index1];
+    const Keypoint& keypoint2 = features2.keypoints[correspondence.index2];
+    if (!keypoint1.has_scale() || !keypoint2.has_scale() ||
+        !keypoint1.has_orientation() || !keypoint2.has_orientation() ||
+        keypoint1.scale() <= 0.0 || keypoint2.scale() <= 0.0) {
+      continue;
+    }
+    const std::complex<double> a =
+        std::polar(keypoint2.scale() / keypoint1.scale(),
+                   keypoint2.orientation() - keypoint1.orientation());
+    if (IsPlausibleSimilarity(a)) {
+      score_hypothesis(a, correspondence.point2 - a * correspondence.point1);
+    }
+  }
+
+  // Two point hypotheses from pairs of the best matches. These do not rely on
+  // the keypoint orientations, whose conventions differ between detectors.
+  const int num_matches_for_two_point_hypotheses =
+      std::min(static_cast<int>(correspondences.size()),
+               kMaxNumMatchesForTwoPointHypotheses);
+  for (int i = 0; i < num_matches_for_two_point_hypotheses; i++) {
+    for (int j = i + 1; j < num_matches_for_two_point_hypotheses; j++) {
+      const std::complex<double> delta1 =
+          correspondences[j].point1 - correspondences[i].point1;
+      if (std::abs(delta1) < kMinPointDistance) {
+        continue;
+      }
+      const std::complex<double> a =
+          (correspondences[j].point2 - correspondences[i].point2) / delta1;
+      if (IsPlausibleSimilarity(a)) {
+        score_hypothesis(
+            a, correspondences[i].point2 - a * correspondences[i].point1);
+      }
+    }
+  }
+  if (best_num_inliers < 3) {
+    return best_num_inliers;
+  }
+
+  // Refine the best similarity to an affine transformation by least squares on
+  // its inliers, which accounts for the perspective foreshortening of (locally)
+  // planar scenes.
+  Eigen::Matrix<double, 3, 2> affine;
+  affine << best_a.real(), best_a.imag(), -best_a.imag(), best_a.real(),
+      best_b.real(), best_b.imag();
+  std::vector<int> inliers;
+  FindAffineInliers(correspondences, affine, squared_threshold, &inliers);
+  Eigen::MatrixX3d points1(inliers.size(), 3);
+  Eigen::MatrixX2d points2(inliers.size(), 2);
+  for (int i = 0; i < inliers.size(); i++) {
+    const Correspondence& correspondence = correspondences[inliers[i]];
+    points1.row(i) << correspondence.point1.real(),
+        correspondence.point1.imag(), 1.0;
+    points2.row(i) << correspondence.point2.real(),
+        correspondence.point2.imag();
+  }
+  const Eigen::ColPivHouseholderQR<Eigen::MatrixX3d> qr(points1);
+  if (qr.rank() < 3) {
+    return best_num_inliers;
+  }
+  affine = qr.solve(points2);
+  FindAffineInliers(correspondences, affine, squared_threshold, &inliers);
+  return std::max(best_num_inliers, static_cast<int>(inliers.size()));
+}
+
+void RerankImagePairs(const SpatialRerankingOptions& options,
+                      const std::vector<SpatialRerankingFeatures>& features,
+                      std::vector<std::pair<int, int> >* image_pairs) {
+  CHECK_NOTNULL(image_pairs);
+  const int num_pairs = image_pairs->size();
+
+  // Pairs that cannot be re-ranked get a negative score.
+  std::vector<int> scores(num_pairs, -1);
+  ParallelFor(options.num_threads, num_pairs, [&](const int start,
+                                                  const int end) {
+    for (int i = start; i < end; i++) {
+      const std::pair<int, int>& image_pair = (*image_pairs)[i];
+      CHECK_LT(image_pair.first, features.size());
+      CHECK_LT(image_pair.second, features.size());
+      const SpatialRerankingFeatures& features1 = features[image_pair.first];
+      const SpatialRerankingFeatures& features2 = features[image_pair.second];
+      if (features1.descriptors.cols() > 0 &&
+          features2.descriptors.cols() > 0) {
+        scores[i] =
+            ComputeSpatialRerankingScore(options, features1, features2);
+      }
+    }
+  });
+
+  std::vector<bool> keep_pair(num_pairs);
+  std::vector<std::vector<int> > pairs_of_image(features.size());
+  for (int i = 0; i < num_pairs; i++) {
+    keep_pair[i] = scores[i] < 0 || scores[i] >= options.min_num_inliers;
+    if (scores[i] >= 0) {
+      pairs_of_image[(*image_pairs)[i].first].emplace_back(i);
+      pairs_of_image[(*image_pairs)[i].second].emplace_back(i);
+    }
+  }
+
+  // Keep the best pairs of each image regardless of their score.
+  for (std::vector<int>& pairs : pairs_of_image) {
+    const int num_kept_pairs =
+        std::min(static_cast<int>(pairs.size()),
+                 options.min_num_pairs_per_image);
+    std::partial_sort(pairs.begin(),
+                      pairs.begin() + num_kept_pairs,
+                      pairs.end(),
+                      [&](const int lhs, const int rhs) {
+                        return scores[lhs] > scores[rhs] ||
+                               (scores[lhs] == scores[rhs] && lhs < rhs);
+                      });
+    for (int i = 0; i < num_kept_pairs; i++) {
+      keep_pair[pairs[i]] = true;
+    }
+  }
+
+  int num_kept_pairs = 0;
+  for (int i = 0; i < num_pairs; i++) {
+    if (keep_pair[i]) {
+      (*image_pairs)[num_kept_pairs++] = (*image_pairs)[i];
+    }
+  }
+  image_pairs->resize(num_kept_pairs);
+  VLOG(1) << num_kept_pairs << " of " << num_pairs
+          << " image pairs passed the spatial re-ranking.";
+}
+
+}  // namespace theia
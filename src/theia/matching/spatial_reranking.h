@@ -0,0 +1,109 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+
+#ifndef THEIA_MATCHING_SPATIAL_RERANKING_H_
+#define THEIA_MATCHING_SPATIAL_RERANKING_H_
+
+#include <Eigen/Core>
+#include <utility>
+#include <vector>
+
+#include "theia/image/keypoint_detector/keypoint.h"
+
+namespace theia {
+
+struct KeypointsAndDescriptors;
+
+struct SpatialRerankingOptions {
+  // Only this many features of each image are matched. The strongest features
+  // are used if the keypoints have a strength, otherwise the first ones.
+  int max_num_features = 128;
+
+  // Lowe's ratio test on the (squared) distances of the two nearest neighbors.
+  float lowes_ratio = 0.8f;
+
+  // A correspondence is consistent with a similarity or affine transformation
+  // if it is transferred within this many pixels of its match. The threshold is
+  // loose since the transformation only approximates the two view geometry.
+  double max_transfer_error_pixels = 20.0;
+
+  // Image pairs with at least this many consistent correspondences pass the
+  // re-ranking.
+  int min_num_inliers = 8;
+
+  // Each image keeps (at least) its best scoring pairs up to this number, even
+  // if they have too few inliers, so that no image is disconnected by the
+  // re-ranking.
+  int min_num_pairs_per_image = 5;
+
+  int num_threads = 1;
+};
+
+// The subsample of the features of an image used for re-ranking. The
+// descriptors are stored one per column.
+struct SpatialRerankingFeatures {
+  std::vector<Keypoint> keypoints;
+  Eigen::MatrixXf descriptors;
+};
+
+// Selects the features of an image used for re-ranking. Quantized descriptors
+// are dequantized. Images with binary descriptors get no re-ranking features,
+// and their pairs are never removed by the re-ranking.
+void SelectSpatialRerankingFeatures(const SpatialRerankingOptions& options,
+                                    const KeypointsAndDescriptors& features,
+                                    SpatialRerankingFeatures* subsample);
+
+// Scores an image pair by the number of ratio test matches between the
+// subsampled features that are consistent with a single similarity or affine
+// transformation. Similarity hypotheses are generated from single matches if
+// the keypoints have a scale and an orientation, and from pairs of the best
+// matches otherwise. The best hypothesis is refined to an affine transformation
+// by least squares on its inliers.
+int ComputeSpatialRerankingScore(const SpatialRerankingOptions& options,
+                                 const SpatialRerankingFeatures& features1,
+                                 const SpatialRerankingFeatures& features2);
+
+// Removes the image pairs (i, j), which index into features, that fail the
+// re-ranking. Pairs of images without re-ranking features are always kept. The
+// order of the remaining pairs is preserved. This is a cheap filter between
+// image retrieval and the much more expensive feature matching and geometric
+// verification of all features.
+void RerankImagePairs(const SpatialRerankingOptions& options,
+                      const std::vector<SpatialRerankingFeatures>& features,
+                      std::vector<std::pair<int, int> >* image_pairs);
+
+}  // namespace theia
+
+#endif  // THEIA_MATCHING_SPATIAL_RERANKING_H_
@@ -0,0 +1,190 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+
+#include <Eigen/Core>
+#include <cmath>
+#include <utility>
+#include <vector>
+
+#include "theia/image/keypoint_detector/keypoint.h"
+#include "theia/matching/keypoints_and_descriptors.h"
+#include "theia/matching/spatial_reranking.h"
+#include "theia/util/random.h"
+
+#include "gtest/gtest.h"
+
+namespace theia {
+
+namespace {
+
+static const int kNumFeatures = 100;
+static const int kDescriptorDimension = 32;
+
+// Random features inside a 1000x1000 image.
+SpatialRerankingFeatures RandomFeatures(RandomNumberGenerator* rng) {
+  SpatialRerankingFeatures features;
+  features.descriptors.resize(kDescriptorDimension, kNumFeatures);
+  for (int i = 0; i < kNumFeatures; i++) {
+    features.keypoints.emplace_back(rng->RandDouble(0.0, 1000.0),
+                                    rng->RandDouble(0.0, 1000.0),
+                                    Keypoint::OTHER);
+    for (int j = 0; j < kDescriptorDimension; j++) {
+      features.descriptors(j, i) = rng->RandFloat(0.0f, 1.0f);
+    }
+    features.descriptors.col(i).normalize();
+  }
+  return features;
+}
+
+// Features of the same scene seen under a similarity transformation. Only the
+// first num_visible features are visible, the others are replaced by random
+// features.
+SpatialRerankingFeatures TransformedFeatures(
+    const SpatialRerankingFeatures& features,
+    const int num_visible,
+    RandomNumberGenerator* rng) {
+  const double scale = 1.3;
+  const double angle = 0.4;
+  SpatialRerankingFeatures transformed = RandomFeatures(rng);
+  for (int i = 0; i < num_visible; i++) {
+    const Keypoint& keypoint = features.keypoints[i];
+    const double x = scale * (std::cos(angle) * keypoint.x() -
+                              std::sin(angle) * keypoint.y()) +
+                     50.0 + rng->RandGaussian(0.0, 1.0);
+    const double y = scale * (std::sin(angle) * keypoint.x() +
+                              std::cos(angle) * keypoint.y()) -
+                     80.0 + rng->RandGaussian(0.0, 1.0);
+    transformed.keypoints[i] = Keypoint(x, y, Keypoint::OTHER);
+    transformed.descriptors.col(i) = features.descriptors.col(i);
+  }
+  return transformed;
+}
+
+}  // namespace
+
+TEST(SpatialRerankingTest, SelectStrongestFeatures) {
+  KeypointsAndDescriptors features;
+  features.descriptor_matrix.resize(10, 4);
+  for (int i = 0; i < 10; i++) {
+    features.keypoints.emplace_back(i, i, Keypoint::SIFT);
+    features.keypoints.back().set_strength(i % 5);
+    features.descriptor_matrix.row(i).setConstant(i);
+  }
+
+  SpatialRerankingOptions options;
+  options.max_num_features = 4;
+  SpatialRerankingFeatures subsample;
+  SelectSpatialRerankingFeatures(options, features, &subsample);
+  ASSERT_EQ(subsample.keypoints.size(), 4);
+  ASSERT_EQ(subsample.descriptors.rows(), 4);
+  ASSERT_EQ(subsample.descriptors.cols(), 4);
+  // The features with strengths 3 and 4 are selected in their original order.
+  const int expected_indices[] = {3, 4, 8, 9};
+  for (int i = 0; i < 4; i++) {
+    EXPECT_EQ(subsample.keypoints[i].x(), expected_indices[i]);
+    EXPECT_EQ(subsample.descriptors(0, i), expected_indices[i]);
+  }
+
+  // Quantized descriptors are dequantized.
+  features.QuantizeDescriptors(10.0f);
+  SelectSpatialRerankingFeatures(options, features, &subsample);
+  ASSERT_EQ(subsample.descriptors.cols(), 4);
+  EXPECT_NEAR(subsample.descriptors(0, 3), 9.0f, 0.1f);
+
+  // Binary descriptors are not re-ranked.
+  features.binary_descriptor_matrix.resize(10, 8);
+  SelectSpatialRerankingFeatures(options, features, &subsample);
+  EXPECT_EQ(subsample.descriptors.cols(), 0);
+}
+
+TEST(SpatialRerankingTest, ScoreOverlappingImages) {
+  RandomNumberGenerator rng(52);
+  const SpatialRerankingOptions options;
+  const SpatialRerankingFeatures features = RandomFeatures(&rng);
+  const SpatialRerankingFeatures overlapping =
+      TransformedFeatures(features, 30, &rng);
+  const SpatialRerankingFeatures unrelated = RandomFeatures(&rng);
+
+  EXPECT_GE(ComputeSpatialRerankingScore(options, features, overlapping), 28);
+  EXPECT_LT(ComputeSpatialRerankingScore(options, features, unrelated),
+            options.min_num_inliers);
+}
+
+TEST(SpatialRerankingTest, ScoreWithKeypointOrientations) {
+  RandomNumberGenerator rng(53);
+  const SpatialRerankingOptions options;
+  SpatialRerankingFeatures features = RandomFeatures(&rng);
+  for (Keypoint& keypoint : features.keypoints) {
+    keypoint.set_scale(2.0);
+    keypoint.set_orientation(0.1);
+  }
+  SpatialRerankingFeatures overlapping =
+      TransformedFeatures(features, 30, &rng);
+  for (Keypoint& keypoint : overlapping.keypoints) {
+    keypoint.set_scale(2.6);
+    keypoint.set_orientation(0.5);
+  }
+  EXPECT_GE(ComputeSpatialRerankingScore(options, features, overlapping), 28);
+}
+
+TEST(SpatialRerankingTest, RerankImagePairs) {
+  RandomNumberGenerator rng(54);
+  std::vector<SpatialRerankingFeatures> features;
+  features.emplace_back(RandomFeatures(&rng));
+  features.emplace_back(TransformedFeatures(features[0], 30, &rng));
+  features.emplace_back(TransformedFeatures(features[0], 40, &rng));
+  features.emplace_back(RandomFeatures(&rng));
+  // An image without re-ranking features, e.g. with binary descriptors.
+  features.emplace_back();
+
+  std::vector<std::pair<int, int> > image_pairs = {
+      {0, 1}, {0, 2}, {0, 3}, {1, 2}, {1, 3}, {2, 3}, {0, 4}};
+
+  SpatialRerankingOptions options;
+  options.min_num_pairs_per_image = 0;
+  std::vector<std::pair<int, int> > reranked_pairs = image_pairs;
+  RerankImagePairs(options, features, &reranked_pairs);
+  const std::vector<std::pair<int, int> > expected_pairs = {
+      {0, 1}, {0, 2}, {1, 2}, {0, 4}};
+  EXPECT_EQ(reranked_pairs, expected_pairs);
+
+  // Image 3 keeps its best pair.
+  options.min_num_pairs_per_image = 1;
+  reranked_pairs = image_pairs;
+  RerankImagePairs(options, features, &reranked_pairs);
+  EXPECT_EQ(reranked_pairs.size(), expected_pairs.size() + 1);
+}
+
+}  // namespace theia
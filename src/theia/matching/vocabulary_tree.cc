@@ -0,0 +1,293 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+extern "C" {
+#include <vlfeat/vl/kmeans.h>
+}
+
+#include "theia/matching/vocabulary_tree.h"
+
+#include <Eigen/Core>
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace theia {
+namespace {
+// The training features are sampled with a fixed seed so that the same images,
+// added in the same order, always train the same vocabulary.
+static const unsigned kTrainingFeatureSamplerSeed = 53;
+}  // namespace
+
+VocabularyTree::VocabularyTree(const Options& options)
+    : options_(options),
+      training_feature_sampler_(options.max_num_features_for_training,
+                                kTrainingFeatureSamplerSeed),
+      num_words_(0),
+      num_images_(0) {
+  CHECK_GT(options_.branching_factor, 1);
+  CHECK_GT(options_.depth, 0);
+  CHECK_GT(options_.max_num_kmeans_iterations, 0);
+}
+
+VocabularyTree::~VocabularyTree() {}
+
+void VocabularyTree::AddFeaturesForTraining(
+    const std::vector<Eigen::VectorXf>& features) {
+  std::lock_guard<std::mutex> lock(training_mutex_);
+  for (const Eigen::VectorXf& feature : features) {
+    CHECK(!feature.hasNaN()) << "Feature: " << feature.transpose();
+    training_feature_sampler_.AddElementToSampler(feature);
+  }
+}
+
+bool VocabularyTree::Train() {
+  const auto& training_features = training_feature_sampler_.GetAllSamples();
+  CHECK_GT(training_features.size(), 0);
+  LOG(INFO) << "Training a vocabulary tree with "
+            << training_features.size() << " features sampled from "
+            << training_feature_sampler_.NumElementsAdded()
+            << " total features.";
+
+  // The root center is never used for quantization.
+  const int dimension = training_features[0].size();
+  std::vector<int> feature_indices(training_features.size());
+  for (int i = 0; i < feature_indices.size(); i++) {
+    feature_indices[i] = i;
+  }
+
+  node_centers_.resize(dimension, 1);
+  node_centers_.col(0).setZero();
+  first_child_.assign(1, 0);
+  num_children_.assign(1, 0);
+  word_id_.assign(1, -1);
+  num_words_ = 0;
+  BuildNode(0, 0, training_features, feature_indices);
+  node_centers_.conservativeResize(dimension, first_child_.size());
+
+  inverted_file_.clear();
+  inverted_file_.resize(num_words_);
+  num_images_ = 0;
+
+  VLOG(1) << "Built a vocabulary tree with " << first_child_.size()
+          << " nodes and " << num_words_ << " visual words.";
+  return num_words_ > 0;
+}
+
+void VocabularyTree::BuildNode(
+    const int node,
+    const int level,
+    const std::vector<Eigen::VectorXf>& training_features,
+    const std::vector<int>& feature_indices) {
+  // Nodes at the maximum depth or with too few features to split become
+  // visual words.
+  if (level == options_.depth ||
+      feature_indices.size() <= options_.branching_factor) {
+    word_id_[node] = num_words_++;
+    return;
+  }
+
+  // Cluster the features of this node.
+  const int dimension = node_centers_.rows();
+  Eigen::MatrixXf data(dimension, feature_indices.size());
+  for (int i = 0; i < feature_indices.size(); i++) {
+    data.col(i) = training_features[feature_indices[i]];
+  }
+
+  std::unique_ptr<VlKMeans, void (*)(VlKMeans*)> kmeans(
+      vl_kmeans_new(VL_TYPE_FLOAT, VlDistanceL2), vl_kmeans_delete);
+  vl_kmeans_set_algorithm(kmeans.get(), VlKMeansElkan);
+  vl_kmeans_set_initialization(kmeans.get(), VlKMeansPlusPlus);
+  vl_kmeans_set_max_num_iterations(kmeans.get(),
+                                   options_.max_num_kmeans_iterations);
+  vl_kmeans_cluster(kmeans.get(),
+                    data.data(),
+                    dimension,
+                    data.cols(),
+                    options_.branching_factor);
+
+  std::vector<vl_uint32> assignments(data.cols());
+  vl_kmeans_quantize(
+      kmeans.get(), assignments.data(), nullptr, data.data(), data.cols());
+
+  // Allocate the children contiguously so that quantization can compare a
+  // feature against all children of a node at once.
+  const int first_child = first_child_.size();
+  first_child_[node] = first_child;
+  num_children_[node] = options_.branching_factor;
+  const int num_nodes = first_child + options_.branching_factor;
+  if (node_centers_.cols() < num_nodes) {
+    node_centers_.conservativeResize(Eigen::NoChange,
+                                     std::max(num_nodes,
+                                              2 * static_cast<int>(
+                                                      node_centers_.cols())));
+  }
+  node_centers_.middleCols(first_child, options_.branching_factor) =
+      Eigen::Map<const Eigen::MatrixXf>(
+          static_cast<const float*>(vl_kmeans_get_centers(kmeans.get())),
+          dimension,
+          options_.branching_factor);
+  first_child_.resize(num_nodes, 0);
+  num_children_.resize(num_nodes, 0);
+  word_id_.resize(num_nodes, -1);
+
+  std::vector<std::vector<int> > child_feature_indices(
+      options_.branching_factor);
+  for (int i = 0; i < assignments.size(); i++) {
+    child_feature_indices[assignments[i]].emplace_back(feature_indices[i]);
+  }
+  // Release the memory of the clustering before recursing.
+  data.resize(0, 0);
+  kmeans.reset(nullptr);
+  assignments.clear();
+
+  for (int i = 0; i < options_.branching_factor; i++) {
+    BuildNode(first_child + i,
+              level + 1,
+              training_features,
+              child_feature_indices[i]);
+  }
+}
+
+int VocabularyTree::Quantize(const Eigen::VectorXf& descriptor) const {
+  CHECK_GT(num_words_, 0) << "The vocabulary tree must be trained first.";
+  DCHECK_EQ(descriptor.size(), node_centers_.rows());
+
+  int node = 0;
+  while (num_children_[node] > 0) {
+    int nearest_child;
+    (node_centers_.middleCols(first_child_[node], num_children_[node])
+         .colwise() -
+     descriptor)
+        .colwise()
+        .squaredNorm()
+        .minCoeff(&nearest_child);
+    node = first_child_[node] + nearest_child;
+  }
+  return word_id_[node];
+}
+
+std::vector<std::pair<int, float> > VocabularyTree::ComputeTermFrequencies(
+    const std::vector<Eigen::VectorXf>& features) const {
+  std::vector<int> words(features.size());
+  for (int i = 0; i < features.size(); i++) {
+    words[i] = Quantize(features[i]);
+  }
+  std::sort(words.begin(), words.end());
+
+  std::vector<std::pair<int, float> > term_frequencies;
+  const float weight = 1.0f / static_cast<float>(features.size());
+  for (int i = 0; i < words.size(); i++) {
+    if (term_frequencies.empty() || term_frequencies.back().first != words[i]) {
+      term_frequencies.emplace_back(words[i], 0.0f);
+    }
+    term_frequencies.back().second += weight;
+  }
+  return term_frequencies;
+}
+
+Eigen::VectorXf VocabularyTree::ExtractGlobalDescriptor(
+    const std::vector<Eigen::VectorXf>& features) {
+  Eigen::VectorXf histogram = Eigen::VectorXf::Zero(num_words_);
+  for (const auto& term_frequency : ComputeTermFrequencies(features)) {
+    histogram(term_frequency.first) = term_frequency.second;
+  }
+  return histogram;
+}
+
+void VocabularyTree::AddImage(const int image_id,
+                              const std::vector<Eigen::VectorXf>& features) {
+  if (features.empty()) {
+    return;
+  }
+
+  // Quantization is the expensive part so it is done outside of the lock.
+  const std::vector<std::pair<int, float> > term_frequencies =
+      ComputeTermFrequencies(features);
+
+  std::lock_guard<std::mutex> lock(inverted_file_mutex_);
+  for (const auto& term_frequency : term_frequencies) {
+    inverted_file_[term_frequency.first].emplace_back(
+        Posting{image_id, term_frequency.second});
+  }
+  ++num_images_;
+}
+
+void VocabularyTree::Query(
+    const std::vector<Eigen::VectorXf>& features,
+    const int num_images,
+    std::vector<std::pair<float, int> >* results) const {
+  CHECK_NOTNULL(results)->clear();
+  if (features.empty() || num_images <= 0 || num_images_ == 0) {
+    return;
+  }
+
+  // Accumulate the scores of all images that share a word with the query.
+  std::unordered_map<int, float> scores;
+  for (const auto& term_frequency : ComputeTermFrequencies(features)) {
+    const std::vector<Posting>& postings = inverted_file_[term_frequency.first];
+    if (postings.empty()) {
+      continue;
+    }
+    const float idf = std::log(static_cast<float>(num_images_) /
+                               static_cast<float>(postings.size()));
+    if (idf <= 0.0f) {
+      continue;
+    }
+    for (const Posting& posting : postings) {
+      scores[posting.image_id] +=
+          idf * std::min(term_frequency.second, posting.term_frequency);
+    }
+  }
+
+  results->reserve(scores.size());
+  for (const auto& score : scores) {
+    results->emplace_back(score.second, score.first);
+  }
+  const int num_results =
+      std::min(num_images, static_cast<int>(results->size()));
+  std::partial_sort(results->begin(),
+                    results->begin() + num_results,
+                    results->end(),
+                    std::greater<std::pair<float, int> >());
+  results->resize(num_results);
+}
+
+}  // namespace theia
@@ -0,0 +1,172 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#ifndef THEIA_MATCHING_VOCABULARY_TREE_H_
+#define THEIA_MATCHING_VOCABULARY_TREE_H_
+
+#include <Eigen/Core>
+#include <mutex>  // NOLINT
+#include <utility>
+#include <vector>
+
+#include "theia/matching/global_descriptor_extractor.h"
+#include "theia/math/reservoir_sampler.h"
+
+namespace theia {
+
+// A vocabulary tree (Nister and Stewenius, "Scalable Recognition with a
+// Vocabulary Tree", CVPR 2006) quantizes local features into visual words by
+// hierarchical k-means clustering. Each leaf of the tree is a visual word and a
+// feature is quantized by descending to the nearest child center at each
+// level, so quantization costs O(branching_factor * depth) distance
+// evaluations instead of one per word.
+//
+// In addition to the GlobalDescriptorExtractor interface (which returns a dense
+// histogram of visual words), the tree maintains an inverted file that maps
+// each visual word to the images containing it. Images may be added to the
+// inverted file incrementally with AddImage and the most similar images to a
+// query are found with Query. A query only visits the posting lists of the
+// words it contains, so the cost scales with the number of images that share
+// words with the query rather than with the total number of images.
+//
+// Images are scored with TF-IDF weighted histogram intersection:
+//   score(q, d) = sum_w idf_w * min(tf_q(w), tf_d(w)),
+// where tf is the L1-normalized term frequency and idf_w = log(N / N_w) for N
+// indexed images, N_w of which contain word w. Only term frequencies are stored
+// in the inverted file and idf weights are evaluated at query time, so the
+// scores remain exact as images are inserted.
+class VocabularyTree : public GlobalDescriptorExtractor {
+ public:
+  struct Options {
+    // The number of children of each interior node and the number of levels of
+    // the tree. The vocabulary contains at most branching_factor^depth words.
+    int branching_factor = 10;
+    int depth = 5;
+
+    // If more than this number of features are added for training then we
+    // randomly sample max_num_features_for_training using a Reservoir sampler
+    // to avoid holding all features in memory.
+    int max_num_features_for_training = 1000000;
+
+    // The maximum number of iterations of k-means clustering for each node.
+    int max_num_kmeans_iterations = 25;
+  };
+
+  explicit VocabularyTree(const Options& options);
+  ~VocabularyTree();
+
+  // Add features to the vocabulary tree for training. This method may be
+  // called multiple times (and from multiple threads) to add multiple sets of
+  // features.
+  void AddFeaturesForTraining(
+      const std::vector<Eigen::VectorXf>& features) override;
+
+  // Builds the tree by hierarchical k-means clustering of the training
+  // features. Any images previously added to the inverted file are removed.
+  bool Train() override;
+
+  // Returns the L1-normalized histogram of visual words of the features. The
+  // descriptor has NumWords() entries.
+  Eigen::VectorXf ExtractGlobalDescriptor(
+      const std::vector<Eigen::VectorXf>& features) override;
+
+  // Returns the visual word that the descriptor is quantized to.
+  int Quantize(const Eigen::VectorXf& descriptor) const;
+
+  // Quantizes the features and adds the image to the inverted file. The image
+  // ids do not need to be contiguous but each image may only be added once.
+  // This method is thread-safe with respect to other calls to AddImage but
+  // must not be called concurrently with Query.
+  void AddImage(const int image_id,
+                const std::vector<Eigen::VectorXf>& features);
+
+  // Finds the (at most) num_images most similar images in the inverted file to
+  // the query features. The results are (score, image id) pairs sorted from
+  // most to least similar. Images that share no visual words with the query
+  // are never returned. This method is thread-safe with respect to other
+  // calls to Query.
+  void Query(const std::vector<Eigen::VectorXf>& features,
+             const int num_images,
+             std::vector<std::pair<float, int> >* results) const;
+
+  // The number of visual words (i.e. leaves) of the trained tree.
+  int NumWords() const { return num_words_; }
+
+  // The number of images in the inverted file.
+  int NumImages() const { return num_images_; }
+
+ private:
+  // An inverted file entry: an image and the term frequency of the word in it.
+  struct Posting {
+    int image_id;
+    float term_frequency;
+  };
+
+  // Recursively clusters the training features with the given indices into
+  // the children of the node.
+  void BuildNode(const int node,
+                 const int level,
+                 const std::vector<Eigen::VectorXf>& training_features,
+                 const std::vector<int>& feature_indices);
+
+  // Returns the sparse, L1-normalized term frequency histogram of the
+  // features as (word, term frequency) pairs sorted by word.
+  std::vector<std::pair<int, float> > ComputeTermFrequencies(
+      const std::vector<Eigen::VectorXf>& features) const;
+
+  const Options options_;
+
+  // Training features are randomly sampled from all features added.
+  ReservoirSampler<Eigen::VectorXf> training_feature_sampler_;
+  std::mutex training_mutex_;
+
+  // The tree is stored as a flat array of nodes, where node 0 is the root.
+  // The children of node i are the nodes [first_child_[i], first_child_[i] +
+  // num_children_[i]) and the center of node i is column i of node_centers_.
+  // Leaves have no children and are assigned a visual word in word_id_.
+  Eigen::MatrixXf node_centers_;
+  std::vector<int> first_child_;
+  std::vector<int> num_children_;
+  std::vector<int> word_id_;
+  int num_words_;
+
+  // The inverted file: the posting list of each visual word.
+  std::vector<std::vector<Posting> > inverted_file_;
+  int num_images_;
+  std::mutex inverted_file_mutex_;
+};
+
+}  // namespace theia
+
+#endif  // THEIA_MATCHING_VOCABULARY_TREE_H_
@@ -0,0 +1,158 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#include <Eigen/Core>
+#include <utility>
+#include <vector>
+
+#include "theia/matching/vocabulary_tree.h"
+#include "theia/util/random.h"
+
+#include "gtest/gtest.h"
+
+namespace theia {
+
+namespace {
+
+static const int kNumDescriptorDimensions = 32;
+static const int kNumLandmarksPerScene = 100;
+static const int kNumScenes = 10;
+static const float kNoise = 0.01;
+
+RandomNumberGenerator rng(59);
+
+Eigen::VectorXf RandomDescriptor() {
+  Eigen::VectorXf descriptor(kNumDescriptorDimensions);
+  for (int i = 0; i < kNumDescriptorDimensions; i++) {
+    descriptor(i) = rng.RandFloat(0.0, 1.0);
+  }
+  return descriptor.normalized();
+}
+
+// Each scene is a set of landmark descriptors. Images of a scene observe noisy
+// copies of its landmarks.
+std::vector<Eigen::VectorXf> ObserveScene(
+    const std::vector<Eigen::VectorXf>& landmarks) {
+  std::vector<Eigen::VectorXf> features;
+  for (const Eigen::VectorXf& landmark : landmarks) {
+    Eigen::VectorXf feature = landmark;
+    for (int i = 0; i < kNumDescriptorDimensions; i++) {
+      feature(i) += rng.RandFloat(-kNoise, kNoise);
+    }
+    features.emplace_back(feature.normalized());
+  }
+  return features;
+}
+
+// Creates two images of each scene, so images 2 * i and 2 * i + 1 overlap.
+void CreateImages(std::vector<std::vector<Eigen::VectorXf> >* images) {
+  for (int i = 0; i < kNumScenes; i++) {
+    std::vector<Eigen::VectorXf> landmarks(kNumLandmarksPerScene);
+    for (int j = 0; j < kNumLandmarksPerScene; j++) {
+      landmarks[j] = RandomDescriptor();
+    }
+    images->emplace_back(ObserveScene(landmarks));
+    images->emplace_back(ObserveScene(landmarks));
+  }
+}
+
+VocabularyTree::Options TreeOptions() {
+  VocabularyTree::Options options;
+  options.branching_factor = 8;
+  options.depth = 3;
+  return options;
+}
+
+}  // namespace
+
+TEST(VocabularyTreeTest, ExtractGlobalDescriptor) {
+  std::vector<std::vector<Eigen::VectorXf> > images;
+  CreateImages(&images);
+
+  VocabularyTree vocabulary_tree(TreeOptions());
+  for (const auto& image : images) {
+    vocabulary_tree.AddFeaturesForTraining(image);
+  }
+  EXPECT_TRUE(vocabulary_tree.Train());
+  EXPECT_GT(vocabulary_tree.NumWords(), 8);
+  EXPECT_LE(vocabulary_tree.NumWords(), 8 * 8 * 8);
+
+  // The histogram is L1-normalized and counts the quantized words.
+  const Eigen::VectorXf histogram =
+      vocabulary_tree.ExtractGlobalDescriptor(images[0]);
+  EXPECT_EQ(histogram.size(), vocabulary_tree.NumWords());
+  EXPECT_NEAR(histogram.sum(), 1.0, 1e-5);
+  const int word = vocabulary_tree.Quantize(images[0][0]);
+  EXPECT_GE(histogram(word), 1.0 / kNumLandmarksPerScene - 1e-6);
+}
+
+TEST(VocabularyTreeTest, QueryFindsOverlappingImages) {
+  std::vector<std::vector<Eigen::VectorXf> > images;
+  CreateImages(&images);
+
+  VocabularyTree vocabulary_tree(TreeOptions());
+  for (const auto& image : images) {
+    vocabulary_tree.AddFeaturesForTraining(image);
+  }
+  EXPECT_TRUE(vocabulary_tree.Train());
+
+  // Insert the images incrementally. Only the first image of each scene is in
+  // the inverted file before all queries of the first batch.
+  for (int i = 0; i < images.size(); i += 2) {
+    vocabulary_tree.AddImage(i, images[i]);
+  }
+  EXPECT_EQ(vocabulary_tree.NumImages(), kNumScenes);
+  std::vector<std::pair<float, int> > results;
+  for (int i = 1; i < images.size(); i += 2) {
+    vocabulary_tree.Query(images[i], 1, &results);
+    ASSERT_EQ(results.size(), 1);
+    EXPECT_EQ(results[0].second, i - 1);
+  }
+
+  for (int i = 1; i < images.size(); i += 2) {
+    vocabulary_tree.AddImage(i, images[i]);
+  }
+  EXPECT_EQ(vocabulary_tree.NumImages(), 2 * kNumScenes);
+  for (int i = 0; i < images.size(); i++) {
+    // The best match is the image itself, followed by the other image of the
+    // same scene.
+    vocabulary_tree.Query(images[i], 2, &results);
+    ASSERT_EQ(results.size(), 2);
+    EXPECT_EQ(results[0].second, i);
+    EXPECT_EQ(results[1].second, i ^ 1);
+    EXPECT_GE(results[0].first, results[1].first);
+  }
+}
+
+}  // namespace theia
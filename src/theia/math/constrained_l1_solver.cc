@@ -41,6 +41,7 @@
 #include <algorithm>
 #include <string>
 
+#include "theia/math/l1_solver.h"
 #include "theia/math/matrix/sparse_cholesky_llt.h"
 #include "theia/util/stringprintf.h"
 
@@ -54,7 +55,8 @@ ConstrainedL1Solver::ConstrainedL1Solver(
     const Eigen::VectorXd& geq_vec)
     : options_(options),
       num_l1_residuals_(b.size()),
-      num_inequality_constraints_(geq_vec.size()) {
+      num_inequality_constraints_(geq_vec.size()),
+      rho_(options.rho) {
   CHECK_EQ(A.cols(), geq_mat.cols());
   CHECK_EQ(A.rows(), b.rows());
   CHECK_EQ(geq_mat.rows(), geq_vec.rows());
@@ -84,6 +86,9 @@ ConstrainedL1Solver::ConstrainedL1Solver(
 
   linear_solver_.Compute(spd_mat);
   CHECK_EQ(linear_solver_.Info(), Eigen::Success);
+  if (options_.num_threads > 1) {
+    A_row_major_ = A_;
+  }
 
   // Set the modified b vector.
   b_.resize(b.size() + geq_vec.size());
@@ -110,13 +115,33 @@ ConstrainedL1Solver::ConstrainedL1Solver(
 // This can now be solved in the same form as the L1 minimization, with a
 // slightly different z update.
 void ConstrainedL1Solver::Solve(Eigen::VectorXd* solution) {
-  CHECK_NOTNULL(solution)->resize(A_.cols());
+  CHECK_NOTNULL(solution);
   Eigen::VectorXd& x = *solution;
-  Eigen::VectorXd z(A_.rows()), u(A_.rows());
-  z.setZero();
-  u.setZero();
+  const int num_threads = options_.num_threads;
+
+  // The products of A^t with z and u are kept up to date, which saves the
+  // separate products of the convergence tests.
+  Eigen::VectorXd z(A_.rows()), a_transpose_z, a_transpose_u;
+  if (options_.warm_start && x.size() == A_.cols()) {
+    l1_solver_internal::Multiply(A_, A_row_major_, x, num_threads, &z);
+    z -= b_;
+  } else {
+    z.setZero();
+  }
+  x.resize(A_.cols());
+  if (!options_.warm_start || u_.size() != A_.rows()) {
+    u_.setZero(A_.rows());
+    rho_ = options_.rho;
+  }
+  Eigen::VectorXd& u = u_;
+  l1_solver_internal::MultiplyTransposed(A_, z, num_threads, &a_transpose_z);
+  l1_solver_internal::MultiplyTransposed(A_, u, num_threads, &a_transpose_u);
+
+  Eigen::VectorXd a_transpose_b;
+  l1_solver_internal::MultiplyTransposed(A_, b_, num_threads, &a_transpose_b);
 
   Eigen::VectorXd a_times_x(A_.rows()), z_old(z.size()), ax_hat(A_.rows());
+  Eigen::VectorXd a_transpose_z_old(A_.cols());
   // Precompute some convergence terms.
   const double rhs_norm = b_.norm();
   const double primal_abs_tolerance_eps =
@@ -124,13 +149,15 @@ void ConstrainedL1Solver::Solve(Eigen::VectorXd* solution) {
   const double dual_abs_tolerance_eps =
       std::sqrt(A_.cols()) * options_.absolute_tolerance;
   VLOG(2) << "Iteration   R norm          S norm          Primal eps      "
-             "Dual eps";
+             "Dual eps        Rho";
   const std::string row_format =
-      "  % 4d     % 4.4e     % 4.4e     % 4.4e     % 4.4e";
+      "  % 4d     % 4.4e     % 4.4e     % 4.4e     % 4.4e     % 4.4e";
 
-  // qp_options.max_num_iterations = 100;
+  num_iterations_ = 0;
   for (int i = 0; i < options_.max_num_iterations; i++) {
-    x.noalias() = linear_solver_.Solve(A_.transpose() * (b_ + z - u));
+    num_iterations_ = i + 1;
+    x.noalias() =
+        linear_solver_.Solve(a_transpose_b + a_transpose_z - a_transpose_u);
 
     if (linear_solver_.Info() != Eigen::Success) {
       LOG(ERROR) << "L1 Minimization failed. Could not solve the sparse "
@@ -138,34 +165,47 @@ void ConstrainedL1Solver::Solve(Eigen::VectorXd* solution) {
       return;
     }
 
-    a_times_x.noalias() = A_ * x;
+    l1_solver_internal::Multiply(A_, A_row_major_, x, num_threads, &a_times_x);
     ax_hat.noalias() = options_.alpha * a_times_x;
     ax_hat.noalias() += (1.0 - options_.alpha) * (z + b_);
 
     // Update z and set z_old.
     std::swap(z, z_old);
-    z.noalias() = ModifiedShrinkage(ax_hat - b_ + u, 1.0 / options_.rho);
+    std::swap(a_transpose_z, a_transpose_z_old);
+    z.noalias() = ModifiedShrinkage(ax_hat - b_ + u, 1.0 / rho_);
+    l1_solver_internal::MultiplyTransposed(A_, z, num_threads, &a_transpose_z);
 
     // Update u.
     u.noalias() += ax_hat - z - b_;
+    l1_solver_internal::MultiplyTransposed(A_, u, num_threads, &a_transpose_u);
 
     // Compute the convergence terms.
     const double r_norm = (a_times_x - z - b_).norm();
-    const double s_norm = (-options_.rho * A_.transpose() * (z - z_old)).norm();
+    const double s_norm = rho_ * (a_transpose_z - a_transpose_z_old).norm();
     const double max_norm = std::max({a_times_x.norm(), z.norm(), rhs_norm});
     const double primal_eps =
         primal_abs_tolerance_eps + options_.relative_tolerance * max_norm;
     const double dual_eps =
-        dual_abs_tolerance_eps + options_.relative_tolerance *
-                                     (options_.rho * A_.transpose() * u).norm();
+        dual_abs_tolerance_eps +
+        options_.relative_tolerance * rho_ * a_transpose_u.norm();
 
     // Log the result to the screen.
     VLOG(2) << theia::StringPrintf(
-        row_format.c_str(), i, r_norm, s_norm, primal_eps, dual_eps);
+        row_format.c_str(), i, r_norm, s_norm, primal_eps, dual_eps, rho_);
     // Determine if the minimizer has converged.
     if (r_norm < primal_eps && s_norm < dual_eps) {
       break;
     }
+
+    if (options_.adaptive_rho) {
+      l1_solver_internal::BalanceRho(r_norm,
+                                     s_norm,
+                                     options_.rho_balance_ratio,
+                                     options_.rho_scale_factor,
+                                     &rho_,
+                                     &u,
+                                     &a_transpose_u);
+    }
   }
 }
 
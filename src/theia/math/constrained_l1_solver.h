@@ -58,7 +58,8 @@ namespace theia {
 // few number of iterations, but can spend many iterations subsuquently refining
 // the solution to optain the global optimum. The speed improvements are because
 // the linear system only needs to be factorized (e.g., by Cholesky
-// decomposition) once, as opposed to every iteration.
+// decomposition) once, as opposed to every iteration. As for L1Solver, the
+// linear system does not depend on rho, so rho may be adapted during the solve.
 class ConstrainedL1Solver {
  public:
   struct Options {
@@ -71,6 +72,18 @@ class ConstrainedL1Solver {
     // Stopping criteria.
     double absolute_tolerance = 1e-4;
     double relative_tolerance = 1e-2;
+
+    // Residual balancing of rho, see L1Solver::Options.
+    bool adaptive_rho = false;
+    double rho_balance_ratio = 10.0;
+    double rho_scale_factor = 2.0;
+
+    // If true, Solve starts from the solution that is passed in and from the
+    // dual variables and rho of the previous call to Solve.
+    bool warm_start = false;
+
+    // The number of threads used for the products with A and A^t.
+    int num_threads = 1;
   };
 
   // The linear system along with the equality and inequality constraints.
@@ -83,6 +96,12 @@ class ConstrainedL1Solver {
   // Solve the constrained L1 minimization above.
   void Solve(Eigen::VectorXd* solution);
 
+  // The value of rho at the end of the last call to Solve.
+  double Rho() const { return rho_; }
+
+  // The number of ADMM iterations of the last call to Solve.
+  int NumIterations() const { return num_iterations_; }
+
  private:
   // This method is used for the z-update, which is conveniently an element-wise
   // update. For the terms in vec corresponding to the L1 minimization, we
@@ -99,10 +118,17 @@ class ConstrainedL1Solver {
   // Matrix A where || Ax - b ||_1 is the problem we are solving.
   Eigen::SparseMatrix<double> A_;
   Eigen::VectorXd b_;
+  // A row-major copy of A for the parallel products with A.
+  Eigen::SparseMatrix<double, Eigen::RowMajor> A_row_major_;
 
   // Cholesky linear solver. Since our linear system will be a SPD matrix we can
   // utilize the Cholesky factorization.
   SparseCholeskyLLt linear_solver_;
+
+  // The scaled dual variable and rho at the end of the last solve.
+  Eigen::VectorXd u_;
+  double rho_;
+  int num_iterations_ = 0;
 };
 
 }  // namespace theia
@@ -0,0 +1,455 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#ifndef THEIA_MATH_FIND_POLYNOMIAL_ROOTS_STURM_H_
+#define THEIA_MATH_FIND_POLYNOMIAL_ROOTS_STURM_H_
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace theia {
+
+// Real root finding for polynomials of a fixed, small degree N as they appear
+// in minimal solvers. As in polynomial.h the polynomials are of the form
+//
+//   sum_{i=0}^N polynomial[i] x^{N-i}
+//
+// and given by N + 1 coefficients. Leading zero coefficients are allowed and
+// reduce the degree of the polynomial.
+//
+// The real roots are isolated with a Sturm sequence and bisection and then
+// polished with a few Newton iterations that are clamped to the isolating
+// interval. Unlike FindPolynomialRoots this does not allocate, only returns
+// real roots (in ascending order, each distinct root once) and avoids the
+// eigen decomposition of the companion matrix.
+
+// Finds the real roots of the polynomial and writes them to roots, which must
+// have room for N values. Returns the number of real roots.
+template <int N>
+int FindRealPolynomialRootsSturm(const double* polynomial, double* roots);
+
+// Finds the real roots of num_polynomials polynomials of the same degree.
+// polynomials holds the N + 1 coefficients of each polynomial one after
+// another, and the roots of the i-th polynomial are written to
+// roots[N * i, N * i + num_roots[i]). The Newton polishing of all roots of the
+// batch runs in one branch-free loop over contiguous arrays, which the
+// compiler vectorizes, so solving many polynomials at once is faster than
+// calling FindRealPolynomialRootsSturm for each.
+template <int N>
+void FindRealPolynomialRootsSturmBatched(const int num_polynomials,
+                                         const double* polynomials,
+                                         double* roots,
+                                         int* num_roots);
+
+// ------------------------- Implementation ------------------------------ //
+
+namespace internal {
+
+// Coefficients whose magnitude relative to the largest coefficient is below
+// this are treated as zero when building the Sturm sequence.
+static const double kSturmZeroTolerance = 1e-14;
+// Isolated roots are bisected until the interval is this small relative to
+// its position before they are polished with Newton's method.
+static const double kSturmBisectionTolerance = 1e-7;
+static const int kSturmMaxBisectionIterations = 100;
+static const int kSturmNumNewtonIterations = 3;
+
+// A Sturm sequence p_0 = p, p_1 = p', p_k = -rem(p_{k-2}, p_{k-1}) of a
+// polynomial of degree at most N. Each member is stored with its highest
+// coefficient first and scaled so that its largest coefficient is 1, which
+// does not change the signs that the sequence is used for.
+template <int N>
+struct SturmSequence {
+  double coefficients[N + 1][N + 1];
+  int degrees[N + 1];
+  int size;
+
+  // Builds the sequence of the polynomial with the given degree. The leading
+  // coefficient must be non-zero.
+  void Build(const double* polynomial, const int degree);
+
+  // The number of sign changes of the sequence evaluated at x.
+  int NumSignChanges(const double x) const;
+
+  // The number of sign changes of the sequence at -infinity and +infinity.
+  int NumSignChangesAtInfinity(const bool positive) const;
+};
+
+// Scales the polynomial so that its largest coefficient has magnitude one and
+// removes the leading coefficients that are zero relative to it. Returns the
+// new degree, or -1 if the polynomial is zero.
+inline int NormalizePolynomial(double* polynomial, int degree) {
+  double max_coefficient = 0.0;
+  for (int i = 0; i <= degree; ++i) {
+    max_coefficient = std::max(max_coefficient, std::abs(polynomial[i]));
+  }
+  if (max_coefficient == 0.0) {
+    return -1;
+  }
+
+  int num_leading_zeros = 0;
+  while (num_leading_zeros < degree &&
+         std::abs(polynomial[num_leading_zeros]) <=
+             kSturmZeroTolerance * max_coefficient) {
+    ++num_leading_zeros;
+  }
+  for (int i = num_leading_zeros; i <= degree; ++i) {
+    polynomial[i - num_leading_zeros] = polynomial[i] / max_coefficient;
+  }
+  return degree - num_leading_zeros;
+}
+
+inline double EvaluatePolynomial(const double* polynomial,
+                                 const int degree,
+                                 const double x) {
+  double value = polynomial[0];
+  for (int i = 1; i <= degree; ++i) {
+    value = value * x + polynomial[i];
+  }
+  return value;
+}
+
+template <int N>
+void SturmSequence<N>::Build(const double* polynomial, const int degree) {
+  std::copy(polynomial, polynomial + degree + 1, coefficients[0]);
+  degrees[0] = NormalizePolynomial(coefficients[0], degree);
+  size = 1;
+  if (degrees[0] < 1) {
+    return;
+  }
+
+  for (int i = 0; i < degrees[0]; ++i) {
+    coefficients[1][i] = (degrees[0] - i) * coefficients[0][i];
+  }
+  degrees[1] = NormalizePolynomial(coefficients[1], degrees[0] - 1);
+  size = 2;
+
+  while (degrees[size - 1] > 0) {
+    const double* dividend = coefficients[size - 2];
+    const double* divisor = coefficients[size - 1];
+    const int dividend_degree = degrees[size - 2];
+    const int divisor_degree = degrees[size - 1];
+
+    // Synthetic division, the remainder is left in the last divisor_degree
+    // entries of the dividend.
+    double remainder[N + 1];
+    std::copy(dividend, dividend + dividend_degree + 1, remainder);
+    for (int i = 0; i <= dividend_degree - divisor_degree; ++i) {
+      const double quotient = remainder[i] / divisor[0];
+      for (int j = 0; j <= divisor_degree; ++j) {
+        remainder[i + j] -= quotient * divisor[j];
+      }
+    }
+
+    // The next member of the sequence is the negated remainder. A zero
+    // remainder means the polynomial has repeated roots and the sequence ends
+    // with their greatest common divisor.
+    double* next = coefficients[size];
+    const double* remainder_begin =
+        remainder + dividend_degree - divisor_degree + 1;
+    double max_remainder = 0.0;
+    for (int i = 0; i < divisor_degree; ++i) {
+      next[i] = -remainder_begin[i];
+      max_remainder = std::max(max_remainder, std::abs(next[i]));
+    }
+    if (max_remainder <= kSturmZeroTolerance) {
+      break;
+    }
+    degrees[size] = NormalizePolynomial(next, divisor_degree - 1);
+    ++size;
+  }
+}
+
+template <int N>
+int SturmSequence<N>::NumSignChanges(const double x) const {
+  int num_sign_changes = 0;
+  double previous_value = 0.0;
+  for (int i = 0; i < size; ++i) {
+    const double value = EvaluatePolynomial(coefficients[i], degrees[i], x);
+    if (value == 0.0) {
+      continue;
+    }
+    if (previous_value != 0.0 && (value < 0.0) != (previous_value < 0.0)) {
+      ++num_sign_changes;
+    }
+    previous_value = value;
+  }
+  return num_sign_changes;
+}
+
+template <int N>
+int SturmSequence<N>::NumSignChangesAtInfinity(const bool positive) const {
+  int num_sign_changes = 0;
+  bool previous_is_negative = false;
+  for (int i = 0; i < size; ++i) {
+    const bool flip_sign = !positive && degrees[i] % 2 == 1;
+    const bool is_negative = (coefficients[i][0] < 0.0) != flip_sign;
+    if (i > 0 && is_negative != previous_is_negative) {
+      ++num_sign_changes;
+    }
+    previous_is_negative = is_negative;
+  }
+  return num_sign_changes;
+}
+
+// Shrinks the interval (lower, upper] containing a single root by bisection.
+// Bisection uses the sign of the polynomial if it differs at both ends and the
+// Sturm sequence otherwise, e.g. for a double root.
+template <int N>
+void BisectRoot(const SturmSequence<N>& sequence,
+                const int lower_sign_changes,
+                double* lower,
+                double* upper) {
+  const double* polynomial = sequence.coefficients[0];
+  const int degree = sequence.degrees[0];
+  const double upper_value = EvaluatePolynomial(polynomial, degree, *upper);
+  if (upper_value == 0.0) {
+    *lower = *upper;
+    return;
+  }
+  const bool upper_is_negative = upper_value < 0.0;
+  const bool has_sign_change =
+      (EvaluatePolynomial(polynomial, degree, *lower) < 0.0) !=
+      upper_is_negative;
+
+  for (int i = 0; i < kSturmMaxBisectionIterations; ++i) {
+    if (*upper - *lower <= kSturmBisectionTolerance *
+                               (1.0 + std::abs(*lower) + std::abs(*upper))) {
+      return;
+    }
+    const double midpoint = 0.5 * (*lower + *upper);
+    bool root_is_below_midpoint;
+    if (has_sign_change) {
+      const double value = EvaluatePolynomial(polynomial, degree, midpoint);
+      if (value == 0.0) {
+        *lower = *upper = midpoint;
+        return;
+      }
+      root_is_below_midpoint = (value < 0.0) == upper_is_negative;
+    } else {
+      root_is_below_midpoint =
+          sequence.NumSignChanges(midpoint) < lower_sign_changes;
+    }
+
+    if (root_is_below_midpoint) {
+      *upper = midpoint;
+    } else {
+      *lower = midpoint;
+    }
+  }
+}
+
+// Recursively bisects (lower, upper] until each interval contains a single
+// root, which is then bisected further with BisectRoot. The number of roots in the interval is the difference of the number
+// of sign changes at its ends.
+template <int N>
+void IsolateRoots(const SturmSequence<N>& sequence,
+                  const double lower,
+                  const double upper,
+                  const int lower_sign_changes,
+                  const int upper_sign_changes,
+                  double* root_lower,
+                  double* root_upper,
+                  int* num_roots) {
+  const int num_roots_in_interval = lower_sign_changes - upper_sign_changes;
+  if (num_roots_in_interval <= 0) {
+    return;
+  }
+
+  const double midpoint = 0.5 * (lower + upper);
+  // Roots closer together than the precision of the interval cannot be
+  // separated and are reported with the same interval.
+  if (num_roots_in_interval == 1 || midpoint <= lower || midpoint >= upper) {
+    for (int i = 0; i < num_roots_in_interval && *num_roots < N; ++i) {
+      root_lower[*num_roots] = lower;
+      root_upper[*num_roots] = upper;
+      if (num_roots_in_interval == 1) {
+        BisectRoot(sequence,
+                   lower_sign_changes,
+                   root_lower + *num_roots,
+                   root_upper + *num_roots);
+      }
+      ++(*num_roots);
+    }
+    return;
+  }
+
+  const int midpoint_sign_changes = sequence.NumSignChanges(midpoint);
+  IsolateRoots(sequence,
+               lower,
+               midpoint,
+               lower_sign_changes,
+               midpoint_sign_changes,
+               root_lower,
+               root_upper,
+               num_roots);
+  IsolateRoots(sequence,
+               midpoint,
+               upper,
+               midpoint_sign_changes,
+               upper_sign_changes,
+               root_lower,
+               root_upper,
+               num_roots);
+}
+
+// Finds intervals that each contain one real root of the polynomial. Returns
+// the number of roots.
+template <int N>
+int IsolateAndBisectRoots(const double* polynomial,
+                          double* root_lower,
+                          double* root_upper) {
+  double normalized[N + 1];
+  std::copy(polynomial, polynomial + N + 1, normalized);
+  const int degree = NormalizePolynomial(normalized, N);
+  if (degree < 1) {
+    return 0;
+  }
+
+  SturmSequence<N> sequence;
+  sequence.Build(normalized, degree);
+
+  // Cauchy's bound on the magnitude of the roots.
+  double bound = 0.0;
+  for (int i = 1; i <= degree; ++i) {
+    bound = std::max(bound, std::abs(normalized[i] / normalized[0]));
+  }
+  bound += 1.0;
+
+  int num_roots = 0;
+  IsolateRoots(sequence,
+               -bound,
+               bound,
+               sequence.NumSignChangesAtInfinity(false),
+               sequence.NumSignChangesAtInfinity(true),
+               root_lower,
+               root_upper,
+               &num_roots);
+  return num_roots;
+}
+
+// Runs Newton's method on num_roots roots at once. The polynomial of the i-th
+// root has the coefficients coefficients[k * num_roots + i] for k = 0..N, and
+// each root is kept inside [lower[i], upper[i]]. The loop over the roots has
+// no branches so that it is vectorized.
+template <int N>
+void PolishRootsNewton(const int num_roots,
+                       const double* coefficients,
+                       const double* lower,
+                       const double* upper,
+                       double* roots) {
+  for (int iteration = 0; iteration < kSturmNumNewtonIterations; ++iteration) {
+    for (int i = 0; i < num_roots; ++i) {
+      const double x = roots[i];
+      double value = coefficients[i];
+      double derivative = 0.0;
+      for (int k = 1; k <= N; ++k) {
+        derivative = derivative * x + value;
+        value = value * x + coefficients[k * num_roots + i];
+      }
+      const double step = derivative != 0.0 ? value / derivative : 0.0;
+      roots[i] = std::min(std::max(x - step, lower[i]), upper[i]);
+    }
+  }
+}
+
+}  // namespace internal
+
+template <int N>
+int FindRealPolynomialRootsSturm(const double* polynomial, double* roots) {
+  static_assert(N > 0, "The polynomial must have a positive degree.");
+  double lower[N];
+  double upper[N];
+  const int num_roots =
+      internal::IsolateAndBisectRoots<N>(polynomial, lower, upper);
+
+  double coefficients[(N + 1) * N];
+  for (int i = 0; i < num_roots; ++i) {
+    for (int k = 0; k <= N; ++k) {
+      coefficients[k * num_roots + i] = polynomial[k];
+    }
+    roots[i] = 0.5 * (lower[i] + upper[i]);
+  }
+  internal::PolishRootsNewton<N>(num_roots, coefficients, lower, upper, roots);
+  return num_roots;
+}
+
+template <int N>
+void FindRealPolynomialRootsSturmBatched(const int num_polynomials,
+                                         const double* polynomials,
+                                         double* roots,
+                                         int* num_roots) {
+  static_assert(N > 0, "The polynomial must have a positive degree.");
+  std::vector<double> lower(num_polynomials * N);
+  std::vector<double> upper(num_polynomials * N);
+  int total_num_roots = 0;
+  for (int i = 0; i < num_polynomials; ++i) {
+    num_roots[i] =
+        internal::IsolateAndBisectRoots<N>(polynomials + (N + 1) * i,
+                                           lower.data() + total_num_roots,
+                                           upper.data() + total_num_roots);
+    total_num_roots += num_roots[i];
+  }
+
+  // Lay out the roots and the coefficients of their polynomials as a
+  // structure of arrays so that all roots are polished in one pass.
+  std::vector<double> coefficients((N + 1) * total_num_roots);
+  std::vector<double> batch_roots(total_num_roots);
+  for (int i = 0, root = 0; i < num_polynomials; ++i) {
+    for (int j = 0; j < num_roots[i]; ++j, ++root) {
+      for (int k = 0; k <= N; ++k) {
+        coefficients[k * total_num_roots + root] =
+            polynomials[(N + 1) * i + k];
+      }
+      batch_roots[root] = 0.5 * (lower[root] + upper[root]);
+    }
+  }
+  internal::PolishRootsNewton<N>(total_num_roots,
+                                 coefficients.data(),
+                                 lower.data(),
+                                 upper.data(),
+                                 batch_roots.data());
+
+  for (int i = 0, root = 0; i < num_polynomials; ++i) {
+    std::copy(batch_roots.begin() + root,
+              batch_roots.begin() + root + num_roots[i],
+              roots + N * i);
+    root += num_roots[i];
+  }
+}
+
+}  // namespace theia
+
+#endif  // THEIA_MATH_FIND_POLYNOMIAL_ROOTS_STURM_H_
@@ -0,0 +1,192 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#include "gtest/gtest.h"
+#include <algorithm>
+#include <glog/logging.h>
+#include <vector>
+
+#include "theia/math/find_polynomial_roots_sturm.h"
+#include "theia/math/polynomial.h"
+#include "theia/util/random.h"
+
+namespace theia {
+
+using Eigen::VectorXd;
+
+namespace {
+
+RandomNumberGenerator rng(67);
+
+const double kEpsilon = 1e-10;
+// Double roots can only be found to about the square root of the precision.
+const double kEpsilonDoubleRoot = 1e-6;
+
+// Returns the polynomial 1.23 * prod_i (x - roots[i]) with its highest
+// coefficient first.
+template <int N>
+VectorXd PolynomialFromRoots(const double (&roots)[N]) {
+  VectorXd polynomial = VectorXd::Zero(N + 1);
+  polynomial(0) = 1.23;
+  for (int i = 0; i < N; ++i) {
+    for (int j = i + 1; j > 0; --j) {
+      polynomial(j) -= roots[i] * polynomial(j - 1);
+    }
+  }
+  return polynomial;
+}
+
+template <int N>
+void RunRealRootsTest(const double (&expected_roots)[N],
+                      const double epsilon) {
+  const VectorXd polynomial = PolynomialFromRoots(expected_roots);
+  double roots[N];
+  ASSERT_EQ(FindRealPolynomialRootsSturm<N>(polynomial.data(), roots), N);
+  for (int i = 0; i < N; ++i) {
+    EXPECT_NEAR(
+        roots[i], expected_roots[i], epsilon * (1.0 + std::abs(roots[i])));
+  }
+}
+
+}  // namespace
+
+TEST(FindRealPolynomialRootsSturm, ZeroPolynomialHasNoRoots) {
+  const double polynomial[3] = {0.0, 0.0, 0.0};
+  double roots[2];
+  EXPECT_EQ(FindRealPolynomialRootsSturm<2>(polynomial, roots), 0);
+}
+
+TEST(FindRealPolynomialRootsSturm, ConstantPolynomialHasNoRoots) {
+  const double polynomial[3] = {0.0, 0.0, 1.23};
+  double roots[2];
+  EXPECT_EQ(FindRealPolynomialRootsSturm<2>(polynomial, roots), 0);
+}
+
+TEST(FindRealPolynomialRootsSturm, LinearPolynomial) {
+  const double roots[1] = {-42.42};
+  RunRealRootsTest(roots, kEpsilon);
+}
+
+TEST(FindRealPolynomialRootsSturm, LeadingZerosReduceTheDegree) {
+  // 0 * x^3 + 2 * x^2 - 2.
+  const double polynomial[4] = {0.0, 2.0, 0.0, -2.0};
+  double roots[3];
+  ASSERT_EQ(FindRealPolynomialRootsSturm<3>(polynomial, roots), 2);
+  EXPECT_NEAR(roots[0], -1.0, kEpsilon);
+  EXPECT_NEAR(roots[1], 1.0, kEpsilon);
+}
+
+TEST(FindRealPolynomialRootsSturm, ComplexRootsAreIgnored) {
+  // (x - 2) * (x^2 + 1).
+  const double polynomial[4] = {1.0, -2.0, 1.0, -2.0};
+  double roots[3];
+  ASSERT_EQ(FindRealPolynomialRootsSturm<3>(polynomial, roots), 1);
+  EXPECT_NEAR(roots[0], 2.0, kEpsilon);
+}
+
+TEST(FindRealPolynomialRootsSturm, CubicPolynomial) {
+  const double roots[3] = {-1.5, 0.25, 42.42};
+  RunRealRootsTest(roots, kEpsilon);
+}
+
+TEST(FindRealPolynomialRootsSturm, QuarticPolynomial) {
+  const double roots[4] = {1.23e-4, 1.23e-1, 1.23e+2, 1.23e+5};
+  RunRealRootsTest(roots, kEpsilon);
+}
+
+TEST(FindRealPolynomialRootsSturm, QuarticPolynomialWithCloseRoots) {
+  const double roots[4] = {-3.0, 42.42, 42.43, 50.0};
+  RunRealRootsTest(roots, kEpsilon);
+}
+
+TEST(FindRealPolynomialRootsSturm, DoubleRootIsReturnedOnce) {
+  // (x + 2) * (x - 1)^2.
+  const double polynomial[4] = {1.0, 0.0, -3.0, 2.0};
+  double roots[3];
+  ASSERT_EQ(FindRealPolynomialRootsSturm<3>(polynomial, roots), 2);
+  EXPECT_NEAR(roots[0], -2.0, kEpsilon);
+  EXPECT_NEAR(roots[1], 1.0, kEpsilonDoubleRoot);
+}
+
+TEST(FindRealPolynomialRootsSturm, MatchesCompanionMatrixOnRandomPolynomials) {
+  static const int kNumPolynomials = 100;
+  for (int i = 0; i < kNumPolynomials; ++i) {
+    VectorXd polynomial(7);
+    rng.SetRandom(&polynomial);
+
+    VectorXd real;
+    VectorXd imaginary;
+    ASSERT_TRUE(FindPolynomialRoots(polynomial, &real, &imaginary));
+    std::vector<double> expected_roots;
+    for (int j = 0; j < real.size(); ++j) {
+      if (std::abs(imaginary(j)) < 1e-12) {
+        expected_roots.emplace_back(real(j));
+      }
+    }
+    std::sort(expected_roots.begin(), expected_roots.end());
+
+    double roots[6];
+    const int num_roots =
+        FindRealPolynomialRootsSturm<6>(polynomial.data(), roots);
+    ASSERT_EQ(num_roots, expected_roots.size());
+    for (int j = 0; j < num_roots; ++j) {
+      EXPECT_NEAR(roots[j], expected_roots[j], 1e-8);
+    }
+  }
+}
+
+TEST(FindRealPolynomialRootsSturm, BatchedMatchesSinglePolynomial) {
+  static const int kNumPolynomials = 50;
+  VectorXd polynomials(5 * kNumPolynomials);
+  rng.SetRandom(&polynomials);
+
+  std::vector<double> batched_roots(4 * kNumPolynomials);
+  std::vector<int> num_batched_roots(kNumPolynomials);
+  FindRealPolynomialRootsSturmBatched<4>(kNumPolynomials,
+                                         polynomials.data(),
+                                         batched_roots.data(),
+                                         num_batched_roots.data());
+
+  for (int i = 0; i < kNumPolynomials; ++i) {
+    double roots[4];
+    const int num_roots =
+        FindRealPolynomialRootsSturm<4>(polynomials.data() + 5 * i, roots);
+    ASSERT_EQ(num_batched_roots[i], num_roots);
+    for (int j = 0; j < num_roots; ++j) {
+      EXPECT_DOUBLE_EQ(batched_roots[4 * i + j], roots[j]);
+    }
+  }
+}
+
+}  // namespace theia
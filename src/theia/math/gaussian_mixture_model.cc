@@ -0,0 +1,287 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+
+#include "theia/math/gaussian_mixture_model.h"
+
+#include <Eigen/Core>
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <vector>
+
+#include "theia/util/random.h"
+#include "theia/util/threadpool.h"
+
+namespace theia {
+
+namespace {
+
+// The number of data points whose responsibilities are computed at once. The
+// responsibilities of a chunk take num_components * kChunkSize floats.
+static const int kChunkSize = 2048;
+
+// The sufficient statistics of the data points of one chunk.
+struct SufficientStatistics {
+  SufficientStatistics(const int dimension, const int num_components)
+      : responsibilities(Eigen::VectorXd::Zero(num_components)),
+        weighted_sums(Eigen::MatrixXd::Zero(dimension, num_components)),
+        weighted_squared_sums(Eigen::MatrixXd::Zero(dimension, num_components)),
+        log_likelihood(0.0) {}
+
+  Eigen::VectorXd responsibilities;
+  Eigen::MatrixXd weighted_sums;
+  Eigen::MatrixXd weighted_squared_sums;
+  double log_likelihood;
+};
+
+// Runs function(chunk_index, chunk) for every chunk of the data points.
+template <class F>
+void ForEachChunk(ThreadPool* thread_pool,
+                  const int num_threads,
+                  const Eigen::Ref<const Eigen::MatrixXf>& data_points,
+                  const F& function) {
+  const int num_chunks = (data_points.cols() + kChunkSize - 1) / kChunkSize;
+  ParallelFor(thread_pool,
+              num_chunks,
+              std::min(num_threads, num_chunks),
+              [&](const int start, const int end) {
+                for (int i = start; i < end; i++) {
+                  const int first_column = i * kChunkSize;
+                  const int num_columns = std::min(
+                      kChunkSize,
+                      static_cast<int>(data_points.cols()) - first_column);
+                  function(i, data_points.middleCols(first_column,
+                                                     num_columns));
+                }
+              });
+}
+
+}  // namespace
+
+bool GaussianMixtureModel::Fit(
+    const Options& options,
+    const Eigen::Ref<const Eigen::MatrixXf>& data_points) {
+  const int dimension = data_points.rows();
+  const int num_points = data_points.cols();
+  const int num_components = options.num_components;
+  CHECK_GT(num_components, 0);
+  CHECK_GT(options.max_num_iterations, 0);
+  CHECK_GT(options.num_threads, 0);
+  if (dimension == 0 || num_points < num_components) {
+    LOG(ERROR) << "Cannot fit a GMM with " << num_components
+               << " components to " << num_points << " points of dimension "
+               << dimension << ".";
+    return false;
+  }
+  if (data_points.hasNaN()) {
+    LOG(ERROR) << "Cannot fit a GMM to data points that contain NaNs.";
+    return false;
+  }
+
+  std::unique_ptr<ThreadPool> thread_pool;
+  if (options.num_threads > 1) {
+    thread_pool.reset(new ThreadPool(options.num_threads));
+  }
+  const int num_chunks = (num_points + kChunkSize - 1) / kChunkSize;
+
+  // The mean and variance of the data, accumulated per chunk.
+  std::vector<Eigen::VectorXd> chunk_sums(num_chunks);
+  std::vector<Eigen::VectorXd> chunk_squared_sums(num_chunks);
+  ForEachChunk(
+      thread_pool.get(),
+      options.num_threads,
+      data_points,
+      [&](const int chunk_index,
+          const Eigen::Ref<const Eigen::MatrixXf>& chunk) {
+        chunk_sums[chunk_index] = chunk.rowwise().sum().cast<double>();
+        chunk_squared_sums[chunk_index] =
+            chunk.array().square().rowwise().sum().cast<double>();
+      });
+  Eigen::VectorXd data_mean = Eigen::VectorXd::Zero(dimension);
+  Eigen::VectorXd data_variance = Eigen::VectorXd::Zero(dimension);
+  for (int i = 0; i < num_chunks; i++) {
+    data_mean += chunk_sums[i];
+    data_variance += chunk_squared_sums[i];
+  }
+  data_mean /= num_points;
+  data_variance = (data_variance / num_points - data_mean.cwiseAbs2())
+                      .cwiseMax(0.0);
+  const double min_variance = std::max(
+      options.min_variance_ratio * data_variance.maxCoeff(), 1e-12);
+  data_variance = data_variance.cwiseMax(min_variance);
+
+  // The initial means are chosen among the data points as in k-means++: each
+  // point is chosen with a probability proportional to its squared distance
+  // to the closest mean chosen before. All components start with the variance
+  // of the data and equal priors.
+  RandomNumberGenerator rng(options.seed, 0);
+  means_.resize(dimension, num_components);
+  means_.col(0) = data_points.col(rng.RandInt(0, num_points - 1));
+  Eigen::VectorXd squared_distances =
+      (data_points.colwise() - means_.col(0))
+          .colwise()
+          .squaredNorm()
+          .transpose()
+          .cast<double>();
+  for (int k = 1; k < num_components; k++) {
+    const double total_squared_distance = squared_distances.sum();
+    int point_index = rng.RandInt(0, num_points - 1);
+    if (total_squared_distance > 0.0) {
+      double threshold = rng.RandDouble(0.0, total_squared_distance);
+      for (point_index = 0; point_index < num_points - 1; point_index++) {
+        threshold -= squared_distances(point_index);
+        if (threshold <= 0.0) {
+          break;
+        }
+      }
+    }
+    means_.col(k) = data_points.col(point_index);
+    squared_distances = squared_distances.cwiseMin(
+        (data_points.colwise() - means_.col(k))
+            .colwise()
+            .squaredNorm()
+            .transpose()
+            .cast<double>());
+  }
+  variances_ = data_variance.cast<float>().replicate(1, num_components);
+  priors_.setConstant(num_components, 1.0f / num_components);
+
+  static const double kLogTwoPi = std::log(2.0 * M_PI);
+  std::vector<SufficientStatistics> statistics(
+      num_chunks, SufficientStatistics(dimension, num_components));
+  double previous_log_likelihood = -std::numeric_limits<double>::infinity();
+  for (num_iterations_ = 1; num_iterations_ <= options.max_num_iterations;
+       num_iterations_++) {
+    // The log density of component k at x is
+    //   log_normalizer_k - 0.5 * (x^2 . inverse_variances_k
+    //                             - 2 * x . scaled_means_k),
+    // so the densities of a chunk are two matrix products.
+    const Eigen::MatrixXf inverse_variances =
+        variances_.cwiseInverse().transpose();
+    const Eigen::MatrixXf scaled_means =
+        means_.cwiseQuotient(variances_).transpose();
+    Eigen::VectorXf log_normalizers(num_components);
+    for (int k = 0; k < num_components; k++) {
+      log_normalizers(k) = static_cast<float>(
+          std::log(static_cast<double>(priors_(k))) -
+          0.5 * (variances_.col(k).cast<double>().array().log().sum() +
+                 dimension * kLogTwoPi +
+                 means_.col(k)
+                     .cast<double>()
+                     .cwiseAbs2()
+                     .cwiseQuotient(variances_.col(k).cast<double>())
+                     .sum()));
+    }
+
+    // E-step: the responsibilities of the components for each point, and the
+    // M-step sums weighted by them.
+    ForEachChunk(
+        thread_pool.get(),
+        options.num_threads,
+        data_points,
+        [&](const int chunk_index,
+            const Eigen::Ref<const Eigen::MatrixXf>& chunk) {
+          const Eigen::MatrixXf squared_chunk = chunk.cwiseAbs2();
+          Eigen::MatrixXf log_densities =
+              scaled_means * chunk - 0.5f * inverse_variances * squared_chunk;
+          log_densities.colwise() += log_normalizers;
+
+          // Normalize the densities of each point with the log-sum-exp trick.
+          const Eigen::RowVectorXf max_log_densities =
+              log_densities.colwise().maxCoeff();
+          log_densities.rowwise() -= max_log_densities;
+          Eigen::MatrixXf responsibilities = log_densities.array().exp();
+          const Eigen::RowVectorXf sums = responsibilities.colwise().sum();
+          responsibilities.array().rowwise() /= sums.array();
+
+          SufficientStatistics& chunk_statistics = statistics[chunk_index];
+          chunk_statistics.log_likelihood =
+              (max_log_densities.array().cast<double>() +
+               sums.array().cast<double>().log())
+                  .sum();
+          chunk_statistics.responsibilities =
+              responsibilities.rowwise().sum().cast<double>();
+          chunk_statistics.weighted_sums =
+              (chunk * responsibilities.transpose()).cast<double>();
+          chunk_statistics.weighted_squared_sums =
+              (squared_chunk * responsibilities.transpose()).cast<double>();
+        });
+
+    SufficientStatistics total(dimension, num_components);
+    for (const SufficientStatistics& chunk_statistics : statistics) {
+      total.responsibilities += chunk_statistics.responsibilities;
+      total.weighted_sums += chunk_statistics.weighted_sums;
+      total.weighted_squared_sums += chunk_statistics.weighted_squared_sums;
+      total.log_likelihood += chunk_statistics.log_likelihood;
+    }
+
+    // M-step. Components that no point is assigned to are restarted at a
+    // random data point.
+    for (int k = 0; k < num_components; k++) {
+      const double responsibility = total.responsibilities(k);
+      if (responsibility < 1e-6 * num_points) {
+        means_.col(k) = data_points.col(rng.RandInt(0, num_points - 1));
+        variances_.col(k) = data_variance.cast<float>();
+        priors_(k) = 1.0f / num_components;
+        continue;
+      }
+      const Eigen::VectorXd mean = total.weighted_sums.col(k) / responsibility;
+      const Eigen::VectorXd variance =
+          total.weighted_squared_sums.col(k) / responsibility -
+          mean.cwiseAbs2();
+      means_.col(k) = mean.cast<float>();
+      variances_.col(k) = variance.cwiseMax(min_variance).cast<float>();
+      priors_(k) = responsibility / num_points;
+    }
+    priors_ /= priors_.sum();
+
+    average_log_likelihood_ = total.log_likelihood / num_points;
+    const double improvement = total.log_likelihood - previous_log_likelihood;
+    previous_log_likelihood = total.log_likelihood;
+    VLOG(3) << "GMM iteration " << num_iterations_
+            << ": average log likelihood = " << average_log_likelihood_;
+    if (improvement <=
+        options.relative_tolerance * std::abs(total.log_likelihood)) {
+      break;
+    }
+  }
+  num_iterations_ = std::min(num_iterations_, options.max_num_iterations);
+  return true;
+}
+
+}  // namespace theia
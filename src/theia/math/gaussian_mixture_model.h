@@ -0,0 +1,122 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+
+#ifndef THEIA_MATH_GAUSSIAN_MIXTURE_MODEL_H_
+#define THEIA_MATH_GAUSSIAN_MIXTURE_MODEL_H_
+
+#include <Eigen/Core>
+#include <cereal/access.hpp>
+#include <cereal/cereal.hpp>
+
+#include <cstdint>
+
+#include "theia/io/eigen_serializable.h"
+
+namespace theia {
+
+// A Gaussian mixture model with diagonal covariances, fitted to data with the
+// expectation maximization (EM) algorithm. The data points are processed in
+// fixed size chunks: the responsibilities of a chunk are computed for all
+// components at once with matrix products, and the chunks are spread over
+// threads. Each chunk accumulates its own sufficient statistics, which are
+// summed in chunk order, so the model does not depend on the number of
+// threads.
+class GaussianMixtureModel {
+ public:
+  struct Options {
+    // The number of Gaussian components.
+    int num_components = 16;
+
+    // EM stops after this many iterations or when the log likelihood improves
+    // by less than relative_tolerance times its magnitude.
+    int max_num_iterations = 100;
+    double relative_tolerance = 1e-6;
+
+    // The variances are kept above this fraction of the largest variance of
+    // the data, which prevents components from collapsing onto a few points.
+    double min_variance_ratio = 1e-4;
+
+    // Number of threads used for the E and M steps.
+    int num_threads = 1;
+
+    // The seed of the random choice of the initial means.
+    unsigned seed = 67;
+  };
+
+  GaussianMixtureModel() {}
+
+  // Fits the model to the data points, which are the columns of the matrix.
+  // There must be at least as many points as components. Returns false if the
+  // data is unsuitable, e.g. if it contains NaNs.
+  bool Fit(const Options& options,
+           const Eigen::Ref<const Eigen::MatrixXf>& data_points);
+
+  bool IsFitted() const { return priors_.size() > 0; }
+  int NumComponents() const { return priors_.size(); }
+  int Dimension() const { return means_.rows(); }
+
+  // The means and the diagonals of the covariances of the components, one
+  // component per column, and the prior (weight) of each component. The
+  // layout is the one VLFeat expects for Fisher vector encoding.
+  const Eigen::MatrixXf& Means() const { return means_; }
+  const Eigen::MatrixXf& Variances() const { return variances_; }
+  const Eigen::VectorXf& Priors() const { return priors_; }
+
+  // The average log likelihood of the data points after the last iteration of
+  // Fit, and the number of iterations that were run.
+  double AverageLogLikelihood() const { return average_log_likelihood_; }
+  int NumIterations() const { return num_iterations_; }
+
+ private:
+  // Templated method for disk I/O with cereal. Only the parameters of the model
+  // are stored.
+  friend class cereal::access;
+  template <class Archive>
+  void serialize(Archive& ar, const std::uint32_t version) {  // NOLINT
+    ar(means_, variances_, priors_);
+  }
+
+  Eigen::MatrixXf means_;
+  Eigen::MatrixXf variances_;
+  Eigen::VectorXf priors_;
+  double average_log_likelihood_ = 0.0;
+  int num_iterations_ = 0;
+};
+
+}  // namespace theia
+
+CEREAL_CLASS_VERSION(theia::GaussianMixtureModel, 0);
+
+#endif  // THEIA_MATH_GAUSSIAN_MIXTURE_MODEL_H_
@@ -0,0 +1,157 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+
+#include <Eigen/Core>
+#include <cereal/archives/portable_binary.hpp>
+
+#include <algorithm>
+#include <limits>
+#include <sstream>
+#include <vector>
+#include "gtest/gtest.h"
+
+#include "theia/math/gaussian_mixture_model.h"
+#include "theia/util/random.h"
+
+namespace theia {
+
+namespace {
+
+// Returns num_points points drawn from each of the Gaussians with the given
+// means and a standard deviation of sigma in every dimension.
+Eigen::MatrixXf SampleClusters(const Eigen::MatrixXf& means,
+                               const int num_points,
+                               const double sigma,
+                               RandomNumberGenerator* rng) {
+  Eigen::MatrixXf data_points(means.rows(), means.cols() * num_points);
+  for (int i = 0; i < data_points.cols(); i++) {
+    for (int j = 0; j < data_points.rows(); j++) {
+      data_points(j, i) =
+          means(j, i % means.cols()) + rng->RandGaussian(0.0, sigma);
+    }
+  }
+  return data_points;
+}
+
+}  // namespace
+
+TEST(GaussianMixtureModel, RecoversSeparatedClusters) {
+  RandomNumberGenerator rng(52);
+  Eigen::MatrixXf means(3, 4);
+  means << 0, 10, 0, 10,
+           0, 0, 10, 10,
+           0, 5, -5, 0;
+  const Eigen::MatrixXf data_points = SampleClusters(means, 1000, 0.5, &rng);
+
+  GaussianMixtureModel::Options options;
+  options.num_components = 4;
+  GaussianMixtureModel gmm;
+  ASSERT_TRUE(gmm.Fit(options, data_points));
+  EXPECT_TRUE(gmm.IsFitted());
+  EXPECT_EQ(gmm.NumComponents(), 4);
+  EXPECT_EQ(gmm.Dimension(), 3);
+  EXPECT_NEAR(gmm.Priors().sum(), 1.0, 1e-5);
+
+  // Every true cluster is matched by a component with the right parameters.
+  for (int i = 0; i < means.cols(); i++) {
+    int nearest_component = 0;
+    (gmm.Means().colwise() - means.col(i))
+        .colwise()
+        .squaredNorm()
+        .minCoeff(&nearest_component);
+    EXPECT_LT((gmm.Means().col(nearest_component) - means.col(i)).norm(), 0.1);
+    EXPECT_NEAR(gmm.Priors()(nearest_component), 0.25, 0.01);
+    for (int j = 0; j < 3; j++) {
+      EXPECT_NEAR(gmm.Variances()(j, nearest_component), 0.25, 0.05);
+    }
+  }
+}
+
+TEST(GaussianMixtureModel, ResultDoesNotDependOnNumThreads) {
+  RandomNumberGenerator rng(53);
+  const Eigen::MatrixXf means = Eigen::MatrixXf::Random(16, 8) * 4.0f;
+  const Eigen::MatrixXf data_points = SampleClusters(means, 2000, 1.0, &rng);
+
+  GaussianMixtureModel::Options options;
+  options.num_components = 8;
+  options.max_num_iterations = 20;
+  GaussianMixtureModel gmm1, gmm4;
+  ASSERT_TRUE(gmm1.Fit(options, data_points));
+  options.num_threads = 4;
+  ASSERT_TRUE(gmm4.Fit(options, data_points));
+
+  EXPECT_EQ(gmm1.NumIterations(), gmm4.NumIterations());
+  EXPECT_EQ(gmm1.AverageLogLikelihood(), gmm4.AverageLogLikelihood());
+  EXPECT_TRUE(gmm1.Means() == gmm4.Means());
+  EXPECT_TRUE(gmm1.Variances() == gmm4.Variances());
+  EXPECT_TRUE(gmm1.Priors() == gmm4.Priors());
+}
+
+TEST(GaussianMixtureModel, RejectsUnsuitableData) {
+  GaussianMixtureModel::Options options;
+  options.num_components = 4;
+  GaussianMixtureModel gmm;
+  EXPECT_FALSE(gmm.Fit(options, Eigen::MatrixXf::Random(2, 3)));
+
+  Eigen::MatrixXf data_points = Eigen::MatrixXf::Random(2, 100);
+  data_points(1, 10) = std::numeric_limits<float>::quiet_NaN();
+  EXPECT_FALSE(gmm.Fit(options, data_points));
+  EXPECT_FALSE(gmm.IsFitted());
+}
+
+TEST(GaussianMixtureModel, Serialization) {
+  RandomNumberGenerator rng(54);
+  const Eigen::MatrixXf means = Eigen::MatrixXf::Random(5, 3) * 4.0f;
+  GaussianMixtureModel::Options options;
+  options.num_components = 3;
+  GaussianMixtureModel gmm;
+  ASSERT_TRUE(gmm.Fit(options, SampleClusters(means, 100, 1.0, &rng)));
+
+  std::stringstream stream;
+  {
+    cereal::PortableBinaryOutputArchive output_archive(stream);
+    output_archive(gmm);
+  }
+  GaussianMixtureModel gmm2;
+  {
+    cereal::PortableBinaryInputArchive input_archive(stream);
+    input_archive(gmm2);
+  }
+  EXPECT_TRUE(gmm.Means() == gmm2.Means());
+  EXPECT_TRUE(gmm.Variances() == gmm2.Variances());
+  EXPECT_TRUE(gmm.Priors() == gmm2.Priors());
+}
+
+}  // namespace theia
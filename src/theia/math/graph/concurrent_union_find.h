@@ -0,0 +1,127 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#ifndef THEIA_MATH_GRAPH_CONCURRENT_UNION_FIND_H_
+#define THEIA_MATH_GRAPH_CONCURRENT_UNION_FIND_H_
+
+#include <glog/logging.h>
+#include <stdint.h>
+
+#include <atomic>
+#include <utility>
+#include <vector>
+
+namespace theia {
+
+// A union-find structure over the dense elements [0, num_elements) that may be
+// queried and merged from many threads at once without locks. Each element
+// stores its parent in an atomic, Find halves the path to the root with
+// compare-and-swap and Union links one root to the other with a single
+// compare-and-swap that is retried if a concurrent union changed either root.
+//
+// The root with the larger id is always linked to the root with the smaller
+// id, so the root of every set is its smallest element. The resulting sets
+// (and their roots) therefore do not depend on the order in which Union is
+// called from different threads. Unlike ConnectedComponents this class does not
+// support a maximum set size, since the size of a set is not known until all
+// unions are done.
+class ConcurrentUnionFind {
+ public:
+  explicit ConcurrentUnionFind(const uint32_t num_elements)
+      : parents_(num_elements) {
+    for (uint32_t i = 0; i < num_elements; i++) {
+      parents_[i].store(i, std::memory_order_relaxed);
+    }
+  }
+
+  uint32_t size() const { return parents_.size(); }
+
+  // Returns the root, i.e. the smallest element, of the set of the element.
+  uint32_t Find(uint32_t element) {
+    DCHECK_LT(element, parents_.size());
+    while (true) {
+      uint32_t parent = parents_[element].load(std::memory_order_relaxed);
+      if (parent == element) {
+        return element;
+      }
+      const uint32_t grandparent =
+          parents_[parent].load(std::memory_order_relaxed);
+      // Path halving: point the element to its grandparent. If another thread
+      // changed the parent in the meantime the update is skipped, which is
+      // fine since both are ancestors of the element.
+      if (grandparent != parent) {
+        parents_[element].compare_exchange_weak(
+            parent, grandparent, std::memory_order_relaxed);
+      }
+      element = grandparent;
+    }
+  }
+
+  // Merges the sets of the two elements.
+  void Union(uint32_t element1, uint32_t element2) {
+    while (true) {
+      element1 = Find(element1);
+      element2 = Find(element2);
+      if (element1 == element2) {
+        return;
+      }
+      if (element1 < element2) {
+        std::swap(element1, element2);
+      }
+      // Link the larger root to the smaller one. This fails if element1 is no
+      // longer a root, in which case the roots are found again.
+      uint32_t expected_root = element1;
+      if (parents_[element1].compare_exchange_strong(
+              expected_root,
+              element2,
+              std::memory_order_acq_rel,
+              std::memory_order_relaxed)) {
+        return;
+      }
+    }
+  }
+
+  // Returns true if both elements are in the same set. This is only reliable
+  // if no unions are performed concurrently.
+  bool InSameSet(const uint32_t element1, const uint32_t element2) {
+    return Find(element1) == Find(element2);
+  }
+
+ private:
+  std::vector<std::atomic<uint32_t> > parents_;
+};
+
+}  // namespace theia
+
+#endif  // THEIA_MATH_GRAPH_CONCURRENT_UNION_FIND_H_
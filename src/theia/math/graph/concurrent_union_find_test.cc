@@ -0,0 +1,92 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#include <stdint.h>
+
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "theia/math/graph/concurrent_union_find.h"
+#include "gtest/gtest.h"
+
+namespace theia {
+
+TEST(ConcurrentUnionFind, Disconnected) {
+  ConcurrentUnionFind union_find(10);
+  for (uint32_t i = 0; i < union_find.size(); i++) {
+    EXPECT_EQ(union_find.Find(i), i);
+  }
+}
+
+TEST(ConcurrentUnionFind, RootIsSmallestElement) {
+  ConcurrentUnionFind union_find(10);
+  union_find.Union(9, 7);
+  union_find.Union(7, 5);
+  union_find.Union(8, 6);
+  union_find.Union(6, 9);
+
+  for (const uint32_t element : {5, 6, 7, 8, 9}) {
+    EXPECT_EQ(union_find.Find(element), 5);
+  }
+  EXPECT_TRUE(union_find.InSameSet(8, 5));
+  EXPECT_FALSE(union_find.InSameSet(4, 5));
+  EXPECT_EQ(union_find.Find(4), 4);
+}
+
+// Unions the elements i and i + 2 from several threads in an interleaved
+// order, which must result in exactly two sets: the even and the odd elements.
+TEST(ConcurrentUnionFind, ConcurrentUnions) {
+  static const int kNumThreads = 4;
+  static const uint32_t kNumElements = 100000;
+
+  ConcurrentUnionFind union_find(kNumElements);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kNumThreads; t++) {
+    threads.emplace_back([&union_find, t]() {
+      for (uint32_t i = t; i + 2 < kNumElements; i += kNumThreads) {
+        union_find.Union(kNumElements - 1 - i, kNumElements - 3 - i);
+      }
+    });
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+
+  for (uint32_t i = 0; i < kNumElements; i++) {
+    EXPECT_EQ(union_find.Find(i), i % 2);
+  }
+}
+
+}  // namespace theia
@@ -0,0 +1,160 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#ifndef THEIA_MATH_GRAPH_PARALLEL_CONNECTED_COMPONENTS_H_
+#define THEIA_MATH_GRAPH_PARALLEL_CONNECTED_COMPONENTS_H_
+
+#include <glog/logging.h>
+#include <stdint.h>
+
+#include <algorithm>
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "theia/math/graph/concurrent_union_find.h"
+#include "theia/util/executor.h"
+#include "theia/util/util.h"
+
+namespace theia {
+
+// A multithreaded counterpart of ConnectedComponents for large graphs. Edges
+// are only collected by AddEdge. The components are computed lazily: the nodes
+// are remapped to dense indices and all edges are merged into a
+// ConcurrentUnionFind from several threads at once.
+//
+// Each connected component is keyed by its smallest node, so the output does
+// not depend on the number of threads or the order of the edges. Unlike
+// ConnectedComponents, a maximum component size is not supported.
+//
+// NOTE: The template parameter T must be hashable and support operator<.
+template <typename T>
+class ParallelConnectedComponents {
+ public:
+  explicit ParallelConnectedComponents(const int num_threads = 1)
+      : num_threads_(num_threads), is_up_to_date_(true) {
+    CHECK_GT(num_threads_, 0);
+  }
+
+  // Adds an edge connecting the two nodes to the graph.
+  void AddEdge(const T& node1, const T& node2) {
+    edges_.emplace_back(node1, node2);
+    is_up_to_date_ = false;
+  }
+
+  // Computes the connected components and returns the disjointed sets.
+  void Extract(
+      std::unordered_map<T, std::unordered_set<T> >* connected_components) {
+    CHECK_NOTNULL(connected_components)->clear();
+    ComputeComponents();
+    for (int i = 0; i < nodes_.size(); i++) {
+      (*connected_components)[nodes_[roots_[i]]].insert(nodes_[i]);
+    }
+  }
+
+  // Returns true if both nodes are in the same connected component and false
+  // otherwise.
+  bool NodesInSameConnectedComponent(const T& node1, const T& node2) {
+    ComputeComponents();
+    const int index1 = NodeIndex(node1);
+    const int index2 = NodeIndex(node2);
+    if (index1 < 0 || index2 < 0) {
+      return false;
+    }
+    return roots_[index1] == roots_[index2];
+  }
+
+ private:
+  // Returns the dense index of the node or -1 if it is not in the graph.
+  int NodeIndex(const T& node) const {
+    const auto it = std::lower_bound(nodes_.begin(), nodes_.end(), node);
+    if (it == nodes_.end() || *it != node) {
+      return -1;
+    }
+    return std::distance(nodes_.begin(), it);
+  }
+
+  // Computes the root of each node if edges were added since the last call.
+  void ComputeComponents() {
+    if (is_up_to_date_) {
+      return;
+    }
+
+    nodes_.clear();
+    nodes_.reserve(2 * edges_.size());
+    for (const auto& edge : edges_) {
+      nodes_.emplace_back(edge.first);
+      nodes_.emplace_back(edge.second);
+    }
+    std::sort(nodes_.begin(), nodes_.end());
+    nodes_.erase(std::unique(nodes_.begin(), nodes_.end()), nodes_.end());
+
+    ConcurrentUnionFind union_find(nodes_.size());
+    ParallelFor(num_threads_,
+                edges_.size(),
+                [&](const int start, const int end) {
+                  for (int i = start; i < end; i++) {
+                    union_find.Union(NodeIndex(edges_[i].first),
+                                     NodeIndex(edges_[i].second));
+                  }
+                });
+
+    roots_.resize(nodes_.size());
+    ParallelFor(num_threads_,
+                nodes_.size(),
+                [&](const int start, const int end) {
+                  for (int i = start; i < end; i++) {
+                    roots_[i] = union_find.Find(i);
+                  }
+                });
+    is_up_to_date_ = true;
+  }
+
+  const int num_threads_;
+  std::vector<std::pair<T, T> > edges_;
+
+  // The sorted unique nodes of the graph and the index of the root of each
+  // node, which is the smallest node of its connected component.
+  std::vector<T> nodes_;
+  std::vector<uint32_t> roots_;
+  bool is_up_to_date_;
+
+  DISALLOW_COPY_AND_ASSIGN(ParallelConnectedComponents);
+};
+
+}  // namespace theia
+
+#endif  // THEIA_MATH_GRAPH_PARALLEL_CONNECTED_COMPONENTS_H_
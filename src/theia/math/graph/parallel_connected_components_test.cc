@@ -0,0 +1,126 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#include <algorithm>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "theia/math/graph/connected_components.h"
+#include "theia/math/graph/parallel_connected_components.h"
+#include "theia/util/map_util.h"
+#include "theia/util/random.h"
+#include "gtest/gtest.h"
+
+namespace theia {
+
+namespace {
+
+typedef std::unordered_map<int, std::unordered_set<int> > Components;
+
+// Adds the same random edges to the serial and the parallel extractor and
+// checks that both produce the same components.
+void CompareToSerialConnectedComponents(const int num_nodes,
+                                        const int num_edges,
+                                        const int num_threads) {
+  RandomNumberGenerator rng(59);
+  ConnectedComponents<int> serial_cc;
+  ParallelConnectedComponents<int> parallel_cc(num_threads);
+  for (int i = 0; i < num_edges; i++) {
+    const int node1 = rng.RandInt(0, num_nodes - 1);
+    const int node2 = rng.RandInt(0, num_nodes - 1);
+    serial_cc.AddEdge(node1, node2);
+    parallel_cc.AddEdge(node1, node2);
+  }
+
+  Components serial_components, parallel_components;
+  serial_cc.Extract(&serial_components);
+  parallel_cc.Extract(&parallel_components);
+  ASSERT_EQ(serial_components.size(), parallel_components.size());
+
+  // The components are keyed differently, so compare them by their contents.
+  for (const auto& serial_component : serial_components) {
+    const int smallest_node = *std::min_element(
+        serial_component.second.begin(), serial_component.second.end());
+    const std::unordered_set<int>* parallel_component =
+        FindOrNull(parallel_components, smallest_node);
+    ASSERT_TRUE(parallel_component != nullptr);
+    EXPECT_EQ(*parallel_component, serial_component.second);
+  }
+}
+
+}  // namespace
+
+TEST(ParallelConnectedComponents, NoEdges) {
+  ParallelConnectedComponents<int> cc;
+  Components components;
+  cc.Extract(&components);
+  EXPECT_TRUE(components.empty());
+  EXPECT_FALSE(cc.NodesInSameConnectedComponent(0, 1));
+}
+
+TEST(ParallelConnectedComponents, ComponentsAreKeyedBySmallestNode) {
+  ParallelConnectedComponents<int> cc;
+  cc.AddEdge(9, 7);
+  cc.AddEdge(7, 5);
+  cc.AddEdge(3, 1);
+  cc.AddEdge(6, 2);
+
+  Components components;
+  cc.Extract(&components);
+  ASSERT_EQ(components.size(), 3);
+  EXPECT_EQ(components[5], std::unordered_set<int>({5, 7, 9}));
+  EXPECT_EQ(components[1], std::unordered_set<int>({1, 3}));
+  EXPECT_EQ(components[2], std::unordered_set<int>({2, 6}));
+
+  EXPECT_TRUE(cc.NodesInSameConnectedComponent(9, 5));
+  EXPECT_FALSE(cc.NodesInSameConnectedComponent(9, 3));
+  EXPECT_FALSE(cc.NodesInSameConnectedComponent(9, 4));
+
+  // Adding an edge afterwards updates the components.
+  cc.AddEdge(2, 3);
+  EXPECT_TRUE(cc.NodesInSameConnectedComponent(6, 1));
+}
+
+TEST(ParallelConnectedComponents, SingleThreadMatchesSerial) {
+  CompareToSerialConnectedComponents(1000, 800, 1);
+}
+
+TEST(ParallelConnectedComponents, MultithreadedMatchesSerial) {
+  CompareToSerialConnectedComponents(1000, 800, 4);
+  CompareToSerialConnectedComponents(10000, 20000, 8);
+}
+
+}  // namespace theia
@@ -0,0 +1,244 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#ifndef THEIA_MATH_GRAPH_PARALLEL_MINIMUM_SPANNING_TREE_H_
+#define THEIA_MATH_GRAPH_PARALLEL_MINIMUM_SPANNING_TREE_H_
+
+#include <glog/logging.h>
+#include <stdint.h>
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "theia/math/graph/concurrent_union_find.h"
+#include "theia/util/executor.h"
+#include "theia/util/hash.h"
+#include "theia/util/util.h"
+
+namespace theia {
+
+// A multithreaded counterpart of MinimumSpanningTree for large graphs based on
+// Boruvka's algorithm. In each round every component selects its lightest
+// outgoing edge in parallel, all selected edges are added to the tree, and the
+// edges that became internal to a component are filtered out. The number of
+// components at least halves in each round, so there are at most O(log V)
+// rounds of O(E / num_threads) work each. For more details please see:
+//   https://en.wikipedia.org/wiki/Bor%C5%AFvka%27s_algorithm
+//
+// Ties in the edge weights are broken by the order in which the edges were
+// added, which makes the minimum spanning tree unique and independent of the
+// number of threads.
+//
+// NOTE: The template parameter T must be hashable and support operator<, and V
+// must support operator<.
+template <typename T, typename V>
+class ParallelMinimumSpanningTree {
+ public:
+  explicit ParallelMinimumSpanningTree(const int num_threads = 1)
+      : num_threads_(num_threads) {
+    CHECK_GT(num_threads_, 0);
+  }
+
+  // Add an edge in the graph.
+  void AddEdge(const T& node1, const T& node2, const V& weight) {
+    edges_.emplace_back(weight, std::pair<T, T>(node1, node2));
+  }
+
+  // Extracts the minimum spanning tree. Returns true on success and false upon
+  // failure. If true is returned, the output variable contains the edge list of
+  // the minimum spanning tree. If the graph is disconnected, false is returned
+  // and the output contains a minimum spanning forest.
+  bool Extract(std::unordered_set<std::pair<T, T> >* minimum_spanning_tree) {
+    CHECK_NOTNULL(minimum_spanning_tree)->clear();
+    if (edges_.size() == 0) {
+      VLOG(2) << "No edges were passed to the minimum spanning tree extractor!";
+      return false;
+    }
+
+    const int num_blocks = kNumBlocksPerThread * num_threads_;
+
+    // Remap the nodes to dense indices.
+    std::vector<T> nodes;
+    nodes.reserve(2 * edges_.size());
+    for (const auto& edge : edges_) {
+      nodes.emplace_back(edge.second.first);
+      nodes.emplace_back(edge.second.second);
+    }
+    std::sort(nodes.begin(), nodes.end());
+    nodes.erase(std::unique(nodes.begin(), nodes.end()), nodes.end());
+    const int num_nodes = nodes.size();
+
+    std::vector<std::pair<uint32_t, uint32_t> > edge_nodes(edges_.size());
+    ParallelFor(num_threads_,
+                edges_.size(),
+                [&](const int start, const int end) {
+                  for (int i = start; i < end; i++) {
+                    edge_nodes[i].first =
+                        NodeIndex(nodes, edges_[i].second.first);
+                    edge_nodes[i].second =
+                        NodeIndex(nodes, edges_[i].second.second);
+                  }
+                });
+
+    std::vector<int> active_edges;
+    active_edges.reserve(edges_.size());
+    for (int i = 0; i < edges_.size(); i++) {
+      if (edge_nodes[i].first != edge_nodes[i].second) {
+        active_edges.emplace_back(i);
+      }
+    }
+
+    ConcurrentUnionFind union_find(num_nodes);
+    std::vector<std::atomic<int> > lightest_edge(num_nodes);
+    std::vector<std::vector<int> > remaining_edges(num_blocks);
+    minimum_spanning_tree->reserve(num_nodes - 1);
+    while (!active_edges.empty() &&
+           minimum_spanning_tree->size() < num_nodes - 1) {
+      for (int i = 0; i < num_nodes; i++) {
+        lightest_edge[i].store(-1, std::memory_order_relaxed);
+      }
+
+      // Find the lightest outgoing edge of each component. No unions happen
+      // during this phase so the roots are stable.
+      ParallelFor(num_threads_,
+                  active_edges.size(),
+                  [&](const int start, const int end) {
+                    for (int i = start; i < end; i++) {
+                      const int edge_index = active_edges[i];
+                      const uint32_t root1 =
+                          union_find.Find(edge_nodes[edge_index].first);
+                      const uint32_t root2 =
+                          union_find.Find(edge_nodes[edge_index].second);
+                      if (root1 == root2) {
+                        continue;
+                      }
+                      UpdateLightestEdge(edge_index, &lightest_edge[root1]);
+                      UpdateLightestEdge(edge_index, &lightest_edge[root2]);
+                    }
+                  });
+
+      // Add the selected edges. Two components may select the same edge, in
+      // which case it is only added once.
+      for (int i = 0; i < num_nodes; i++) {
+        const int edge_index = lightest_edge[i].load(std::memory_order_relaxed);
+        if (edge_index < 0 ||
+            union_find.InSameSet(edge_nodes[edge_index].first,
+                                 edge_nodes[edge_index].second)) {
+          continue;
+        }
+        union_find.Union(edge_nodes[edge_index].first,
+                         edge_nodes[edge_index].second);
+        minimum_spanning_tree->emplace(edges_[edge_index].second);
+      }
+
+      // Remove the edges that are now internal to a component. Each block
+      // writes the edges it keeps into its own buffer.
+      for (std::vector<int>& remaining : remaining_edges) {
+        remaining.clear();
+      }
+      const int block_size =
+          (static_cast<int>(active_edges.size()) + num_blocks - 1) / num_blocks;
+      ParallelFor(
+          num_threads_, num_blocks, [&](const int start, const int end) {
+            for (int block = start; block < end; block++) {
+              const int end_edge = std::min<int>((block + 1) * block_size,
+                                                 active_edges.size());
+              for (int i = block * block_size; i < end_edge; i++) {
+                const int edge_index = active_edges[i];
+                if (!union_find.InSameSet(edge_nodes[edge_index].first,
+                                          edge_nodes[edge_index].second)) {
+                  remaining_edges[block].emplace_back(edge_index);
+                }
+              }
+            }
+          });
+      int num_remaining_edges = 0;
+      for (int i = 0; i < num_blocks; i++) {
+        std::copy(remaining_edges[i].begin(),
+                  remaining_edges[i].end(),
+                  active_edges.begin() + num_remaining_edges);
+        num_remaining_edges += remaining_edges[i].size();
+      }
+      active_edges.resize(num_remaining_edges);
+    }
+
+    return minimum_spanning_tree->size() == num_nodes - 1;
+  }
+
+ private:
+  static const int kNumBlocksPerThread = 4;
+
+  static int NodeIndex(const std::vector<T>& nodes, const T& node) {
+    return std::distance(nodes.begin(),
+                         std::lower_bound(nodes.begin(), nodes.end(), node));
+  }
+
+  // Returns true if edge1 is lighter than edge2. Ties are broken by the edge
+  // index.
+  bool IsLighter(const int edge1, const int edge2) const {
+    if (edges_[edge1].first < edges_[edge2].first) {
+      return true;
+    }
+    if (edges_[edge2].first < edges_[edge1].first) {
+      return false;
+    }
+    return edge1 < edge2;
+  }
+
+  // Atomically replaces the lightest edge if the edge is lighter.
+  void UpdateLightestEdge(const int edge_index,
+                          std::atomic<int>* lightest_edge) const {
+    int current_edge = lightest_edge->load(std::memory_order_relaxed);
+    while (current_edge < 0 || IsLighter(edge_index, current_edge)) {
+      if (lightest_edge->compare_exchange_weak(current_edge,
+                                               edge_index,
+                                               std::memory_order_relaxed)) {
+        return;
+      }
+    }
+  }
+
+  const int num_threads_;
+  std::vector<std::pair<V, std::pair<T, T> > > edges_;
+
+  DISALLOW_COPY_AND_ASSIGN(ParallelMinimumSpanningTree);
+};
+
+}  // namespace theia
+
+#endif  // THEIA_MATH_GRAPH_PARALLEL_MINIMUM_SPANNING_TREE_H_
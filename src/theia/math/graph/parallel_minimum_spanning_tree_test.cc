@@ -0,0 +1,167 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "theia/math/graph/minimum_spanning_tree.h"
+#include "theia/math/graph/parallel_connected_components.h"
+#include "theia/math/graph/parallel_minimum_spanning_tree.h"
+#include "theia/util/map_util.h"
+#include "theia/util/random.h"
+#include "gtest/gtest.h"
+
+namespace theia {
+
+namespace {
+
+typedef std::pair<int, int> IntPair;
+
+double TreeCost(const std::unordered_map<IntPair, double>& edges,
+                const std::unordered_set<IntPair>& tree) {
+  double cost = 0;
+  for (const auto& edge : tree) {
+    cost += FindOrDieNoPrint(edges, edge);
+  }
+  return cost;
+}
+
+// Creates a random graph with distinct random weights and checks that the
+// parallel extractor returns the same tree as the serial extractor.
+void CompareToSerialMinimumSpanningTree(const int num_nodes,
+                                        const int num_edges,
+                                        const int num_threads) {
+  RandomNumberGenerator rng(61);
+  MinimumSpanningTree<int, double> serial_mst;
+  ParallelMinimumSpanningTree<int, double> parallel_mst(num_threads);
+  std::unordered_map<IntPair, double> edges;
+
+  // A chain makes sure the graph is connected.
+  for (int i = 0; i < num_nodes - 1; i++) {
+    edges.emplace(IntPair(i, i + 1), rng.RandDouble(0.0, 10.0));
+  }
+  while (edges.size() < num_edges) {
+    const int node1 = rng.RandInt(0, num_nodes - 1);
+    const int node2 = rng.RandInt(0, num_nodes - 1);
+    if (node1 == node2 || ContainsKey(edges, IntPair(node1, node2)) ||
+        ContainsKey(edges, IntPair(node2, node1))) {
+      continue;
+    }
+    edges.emplace(IntPair(node1, node2), rng.RandDouble(0.0, 10.0));
+  }
+  for (const auto& edge : edges) {
+    serial_mst.AddEdge(edge.first.first, edge.first.second, edge.second);
+    parallel_mst.AddEdge(edge.first.first, edge.first.second, edge.second);
+  }
+
+  std::unordered_set<IntPair> serial_tree, parallel_tree;
+  EXPECT_TRUE(serial_mst.Extract(&serial_tree));
+  EXPECT_TRUE(parallel_mst.Extract(&parallel_tree));
+  EXPECT_EQ(parallel_tree.size(), num_nodes - 1);
+
+  // With distinct weights the minimum spanning tree is unique.
+  EXPECT_EQ(parallel_tree, serial_tree);
+  EXPECT_NEAR(TreeCost(edges, parallel_tree),
+              TreeCost(edges, serial_tree),
+              1e-8);
+}
+
+}  // namespace
+
+TEST(ParallelMinimumSpanningTree, NoEdges) {
+  ParallelMinimumSpanningTree<int, double> mst;
+  std::unordered_set<IntPair> spanning_tree;
+  EXPECT_FALSE(mst.Extract(&spanning_tree));
+}
+
+TEST(ParallelMinimumSpanningTree, SimpleSpanningGraph) {
+  ParallelMinimumSpanningTree<int, double> mst;
+  for (int i = 0; i < 9; i++) {
+    mst.AddEdge(i, i + 1, 1.0);
+  }
+  mst.AddEdge(0, 9, 2.0);
+
+  std::unordered_set<IntPair> spanning_tree;
+  EXPECT_TRUE(mst.Extract(&spanning_tree));
+  EXPECT_EQ(spanning_tree.size(), 9);
+  EXPECT_FALSE(ContainsKey(spanning_tree, IntPair(0, 9)));
+}
+
+TEST(ParallelMinimumSpanningTree, EqualWeights) {
+  // A complete graph with equal weights; any spanning tree is minimal, but it
+  // must be a tree.
+  ParallelMinimumSpanningTree<int, int> mst(4);
+  for (int i = 0; i < 20; i++) {
+    for (int j = i + 1; j < 20; j++) {
+      mst.AddEdge(i, j, 1);
+    }
+  }
+
+  std::unordered_set<IntPair> spanning_tree;
+  EXPECT_TRUE(mst.Extract(&spanning_tree));
+  EXPECT_EQ(spanning_tree.size(), 19);
+
+  ParallelConnectedComponents<int> cc;
+  for (const IntPair& edge : spanning_tree) {
+    cc.AddEdge(edge.first, edge.second);
+  }
+  std::unordered_map<int, std::unordered_set<int> > components;
+  cc.Extract(&components);
+  EXPECT_EQ(components.size(), 1);
+}
+
+TEST(ParallelMinimumSpanningTree, DisconnectedGraph) {
+  // Create a graph: 0 -> 1 -> 2  and 3 -> 4 -> 5
+  ParallelMinimumSpanningTree<int, double> mst;
+  mst.AddEdge(0, 1, 1.0);
+  mst.AddEdge(1, 2, 1.0);
+  mst.AddEdge(3, 4, 1.0);
+  mst.AddEdge(4, 5, 1.0);
+  std::unordered_set<IntPair> spanning_forest;
+  EXPECT_FALSE(mst.Extract(&spanning_forest));
+  EXPECT_EQ(spanning_forest.size(), 4);
+}
+
+TEST(ParallelMinimumSpanningTree, SingleThreadMatchesSerial) {
+  CompareToSerialMinimumSpanningTree(100, 500, 1);
+}
+
+TEST(ParallelMinimumSpanningTree, MultithreadedMatchesSerial) {
+  CompareToSerialMinimumSpanningTree(100, 500, 4);
+  CompareToSerialMinimumSpanningTree(5000, 50000, 8);
+}
+
+}  // namespace theia
@@ -38,7 +38,8 @@
 #include <stdint.h>
 
 #include <algorithm>
-#include <set>
+#include <memory>
+#include <tuple>
 #include <unordered_map>
 #include <unordered_set>
 #include <utility>
@@ -46,7 +47,9 @@
 
 #include "theia/math/graph/connected_components.h"
 #include "theia/sfm/types.h"
+#include "theia/util/executor.h"
 #include "theia/util/hash.h"
+#include "theia/util/map_util.h"
 #include "theia/util/util.h"
 
 namespace theia {
@@ -61,7 +64,12 @@ class TripletExtractor {
   typedef std::pair<T, T> TypePair;
   typedef std::tuple<T, T, T> TypeTriplet;
 
-  TripletExtractor() {}
+  TripletExtractor() : num_threads_(1) {}
+
+  // The triplets are enumerated with the given number of threads.
+  explicit TripletExtractor(const int num_threads) : num_threads_(num_threads) {
+    CHECK_GT(num_threads_, 0);
+  }
 
   // Extracts all triplets from the view pairs (which should be edges in a view
   // graph). Triplets are grouped by connectivity, and vector represents a
@@ -70,10 +78,13 @@ class TripletExtractor {
       const std::unordered_set<TypePair>& edge_graph,
       std::vector<std::vector<TypeTriplet>>* connected_triplets);
 
- private:
-  // Finds all triplets in the view pairs.
-  void FindTriplets(const std::unordered_set<TypePair>& edge_graph);
+  // Finds all triplets in the view pairs without grouping them by
+  // connectivity. Each triplet is sorted in increasing order. This is much
+  // cheaper than ExtractTriplets when the triplet graphs are not needed.
+  void FindAllTriplets(const std::unordered_set<TypePair>& edge_graph,
+                       std::vector<TypeTriplet>* triplets) const;
 
+ private:
   // Each view triplet contains 3 view pairs, so we use the lookup map to add
   // all triplets that share one of the view pairs as neighbors in the connected
   // component analysis.
@@ -81,9 +92,11 @@ class TripletExtractor {
       std::unordered_map<TripletId, std::unordered_set<TripletId>>*
           connected_triplet_graphs);
 
-  // Store the triplet in the internal container and add the entries to the edge
-  // list appropriatesly.
-  void StoreTriplet(const T& a, const T& b, const T& c);
+  // Store the (sorted) triplet in the internal container and add the entries to
+  // the edge list appropriatesly.
+  void StoreTriplet(const TypeTriplet& triplet);
+
+  const int num_threads_;
 
   // Container for all triplets found in the view pairs.
   std::vector<TypeTriplet> triplets_;
@@ -130,7 +143,11 @@ bool TripletExtractor<T>::ExtractTriplets(
   triplet_edges_.reserve(edge_graph.size());
 
   // Find all the triplets.
-  FindTriplets(edge_graph);
+  std::vector<TypeTriplet> triplets;
+  FindAllTriplets(edge_graph, &triplets);
+  for (const TypeTriplet& triplet : triplets) {
+    StoreTriplet(triplet);
+  }
 
   // Split the triplets into connected triplet graphs.
   std::unordered_map<TripletId, std::unordered_set<TripletId>>
@@ -160,56 +177,111 @@ bool TripletExtractor<T>::ExtractTriplets(
   return true;
 }
 
-// Finds all triplets in the view pairs. We find loops by examining a sorted
-// list of the view ids of the edges in the view graph.
+// Finds all triplets in the view pairs. Each edge is directed from the node
+// with the lower degree to the node with the higher degree (ties are broken by
+// the node id), and the triplets are found from their lowest node u by
+// intersecting the outgoing neighbors of u with those of each outgoing neighbor
+// of u. This finds each triplet exactly once and bounds the number of outgoing
+// neighbors of any node by O(sqrt(E)), so high-degree nodes do not dominate the
+// runtime. The nodes are split between blocks that are processed in parallel,
+// each block writing its triplets to its own buffer.
 template <typename T>
-void TripletExtractor<T>::FindTriplets(
-    const std::unordered_set<TypePair>& edge_graph) {
-  // Create an adjacency graph.
-  std::unordered_map<T, std::set<T>> adjacency_graph;
-  adjacency_graph.reserve(edge_graph.size());
+void TripletExtractor<T>::FindAllTriplets(
+    const std::unordered_set<TypePair>& edge_graph,
+    std::vector<TypeTriplet>* triplets) const {
+  CHECK_NOTNULL(triplets)->clear();
+
+  // Interleaving the nodes of more blocks than threads balances the load.
+  static const int kNumBlocksPerThread = 4;
+
+  // Order the nodes by degree.
+  std::unordered_map<T, int> degrees;
+  degrees.reserve(edge_graph.size());
   for (const TypePair& edge : edge_graph) {
-    adjacency_graph[edge.first].emplace(edge.second);
-    adjacency_graph[edge.second].emplace(edge.first);
+    if (edge.first != edge.second) {
+      ++degrees[edge.first];
+      ++degrees[edge.second];
+    }
+  }
+  std::vector<std::pair<int, T>> ordered_nodes;
+  ordered_nodes.reserve(degrees.size());
+  for (const auto& degree : degrees) {
+    ordered_nodes.emplace_back(degree.second, degree.first);
   }
+  std::sort(ordered_nodes.begin(), ordered_nodes.end());
+  const int num_nodes = ordered_nodes.size();
+  std::unordered_map<T, int> node_rank;
+  node_rank.reserve(num_nodes);
+  for (int i = 0; i < num_nodes; i++) {
+    node_rank[ordered_nodes[i].second] = i;
+  }
+
+  // Create the directed adjacency graph on the node ranks.
+  std::vector<std::vector<int>> outgoing_neighbors(num_nodes);
+  for (const TypePair& edge : edge_graph) {
+    if (edge.first == edge.second) {
+      continue;
+    }
+    const int rank1 = FindOrDie(node_rank, edge.first);
+    const int rank2 = FindOrDie(node_rank, edge.second);
+    outgoing_neighbors[std::min(rank1, rank2)].emplace_back(
+        std::max(rank1, rank2));
+  }
+
+  const int num_blocks = kNumBlocksPerThread * num_threads_;
 
-  // Iterate over the adjacency graph and find all triplets.
-  for (const auto& edge : edge_graph) {
-    // Find any nodes that contain edges to both of the nodes for the current
-    // edge. Any such nodes form a triplet in the graph. We do this efficiently
-    // using a set intersection on the list of adjacent nodes to each of the
-    // nodes in the current edges.
-    const std::set<T>& edges_to_node1 =
-        theia::FindOrDie(adjacency_graph, edge.first);
-    const std::set<T>& edges_to_node2 =
-        theia::FindOrDie(adjacency_graph, edge.second);
-
-    // Compute the intersection between the two adjacency lists to find
-    // triplets.
-    std::vector<T> node_intersection;
-    node_intersection.reserve(
-        std::min(edges_to_node1.size(), edges_to_node2.size()));
-    std::set_intersection(edges_to_node1.begin(),
-                          edges_to_node1.end(),
-                          edges_to_node2.begin(),
-                          edges_to_node2.end(),
-                          std::back_inserter(node_intersection));
-    // Keep track of each triplet.
-    for (int i = 0; i < node_intersection.size(); i++) {
-      StoreTriplet(edge.first, edge.second, node_intersection[i]);
+  // Sort the neighbors for the intersections. Duplicates only occur if the
+  // edge graph contains an edge in both directions.
+  ParallelFor(num_threads_, num_nodes, [&](const int start, const int end) {
+    for (int i = start; i < end; i++) {
+      std::vector<int>& neighbors = outgoing_neighbors[i];
+      std::sort(neighbors.begin(), neighbors.end());
+      neighbors.erase(std::unique(neighbors.begin(), neighbors.end()),
+                      neighbors.end());
+    }
+  });
+
+  // Find the triplets of each block of nodes.
+  std::vector<std::vector<TypeTriplet>> block_triplets(num_blocks);
+  ParallelFor(num_threads_, num_blocks, [&](const int start, const int end) {
+    std::vector<int> node_intersection;
+    for (int block = start; block < end; block++) {
+      for (int u = block; u < num_nodes; u += num_blocks) {
+        const std::vector<int>& neighbors_u = outgoing_neighbors[u];
+        for (const int v : neighbors_u) {
+          const std::vector<int>& neighbors_v = outgoing_neighbors[v];
+          node_intersection.clear();
+          std::set_intersection(neighbors_u.begin(),
+                                neighbors_u.end(),
+                                neighbors_v.begin(),
+                                neighbors_v.end(),
+                                std::back_inserter(node_intersection));
+          const T& a = ordered_nodes[u].second;
+          const T& b = ordered_nodes[v].second;
+          for (const int w : node_intersection) {
+            TypeTriplet triplet(
+                std::min(a, b), std::max(a, b), ordered_nodes[w].second);
+            internal::SortTriplet(&triplet);
+            block_triplets[block].emplace_back(triplet);
+          }
+        }
+      }
     }
-    // Remove the edge from the adjacency graph. Since this step found all
-    // triplets that contain the edge, there are no possible triplets remaining
-    // that include the edge so it may be safely removed to improve efficiency.
-    adjacency_graph[edge.first].erase(edge.second);
-    adjacency_graph[edge.second].erase(edge.first);
+  });
+
+  // Concatenate the triplets of all blocks.
+  int num_triplets = 0;
+  for (const std::vector<TypeTriplet>& block : block_triplets) {
+    num_triplets += block.size();
+  }
+  triplets->reserve(num_triplets);
+  for (const std::vector<TypeTriplet>& block : block_triplets) {
+    triplets->insert(triplets->end(), block.begin(), block.end());
   }
 }
 
 template <typename T>
-void TripletExtractor<T>::StoreTriplet(const T& a, const T& b, const T& c) {
-  TypeTriplet triplet(a, b, c);
-  internal::SortTriplet(&triplet);
+void TripletExtractor<T>::StoreTriplet(const TypeTriplet& triplet) {
   triplets_.emplace_back(triplet);
 
   // Add each edge of the triplet to the edge lookup map. This will be used
@@ -32,7 +32,9 @@
 // Please contact the author of this library if you have any questions.
 // Author: Chris Sweeney (cmsweeney@cs.ucsb.edu)
 
+#include <algorithm>
 #include <memory>
+#include <set>
 #include <tuple>
 #include <utility>
 #include <vector>
@@ -40,6 +42,7 @@
 #include "gtest/gtest.h"
 
 #include "theia/math/graph/triplet_extractor.h"
+#include "theia/util/random.h"
 
 namespace theia {
 typedef std::pair<int, int> IntPair;
@@ -93,4 +96,48 @@ TEST(ViewTriplet, DisconnectedSets) {
   EXPECT_EQ(triplets.at(1).size(), 1);
 }
 
+TEST(ViewTriplet, MultithreadedMatchesBruteForce) {
+  static const int kNumNodes = 60;
+  static const double kEdgeProbability = 0.3;
+  RandomNumberGenerator rng(52);
+
+  std::unordered_set<IntPair> edges;
+  for (int i = 0; i < kNumNodes; i++) {
+    for (int j = i + 1; j < kNumNodes; j++) {
+      if (rng.RandDouble(0.0, 1.0) < kEdgeProbability) {
+        edges.emplace(i, j);
+      }
+    }
+  }
+
+  std::set<IntTriplet> expected_triplets;
+  for (int i = 0; i < kNumNodes; i++) {
+    for (int j = i + 1; j < kNumNodes; j++) {
+      for (int k = j + 1; k < kNumNodes; k++) {
+        if (edges.count(IntPair(i, j)) && edges.count(IntPair(i, k)) &&
+            edges.count(IntPair(j, k))) {
+          expected_triplets.emplace(i, j, k);
+        }
+      }
+    }
+  }
+
+  for (const int num_threads : {1, 4}) {
+    TripletExtractor<int> triplet_extractor(num_threads);
+    std::vector<std::vector<IntTriplet> > triplets;
+    triplet_extractor.ExtractTriplets(edges, &triplets);
+
+    std::set<IntTriplet> extracted_triplets;
+    int num_triplets = 0;
+    for (const auto& connected_triplets : triplets) {
+      extracted_triplets.insert(connected_triplets.begin(),
+                                connected_triplets.end());
+      num_triplets += connected_triplets.size();
+    }
+    // Each triplet is extracted exactly once and sorted.
+    EXPECT_EQ(num_triplets, expected_triplets.size());
+    EXPECT_EQ(extracted_triplets, expected_triplets);
+  }
+}
+
 }  // namespace theia
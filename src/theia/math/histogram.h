@@ -35,6 +35,10 @@
 #ifndef THEIA_MATH_HISTOGRAM_H_
 #define THEIA_MATH_HISTOGRAM_H_
 
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <limits>
 #include <string>
 #include <vector>
 
@@ -43,10 +47,14 @@
 namespace theia {
 
 // A simple histogram counter that will create a histogram composed of fixed
-// bins that are specified by the user.
+// bins that are specified by the user. Histograms with the same bins can be
+// merged, so values may be counted in several histograms in parallel (e.g. one
+// per thread) and combined afterwards without keeping the values.
 template <typename T>
 class Histogram {
  public:
+  Histogram() : Histogram(std::vector<T>()) {}
+
   // Initialize the historgram with its bins. The boundaries vector must be
   // sorted.
   explicit Histogram(const std::vector<T>& boundaries)
@@ -68,6 +76,39 @@ class Histogram {
     ++histogram_count_[bin_index];
   }
 
+  // Adds the counts of the other histogram, which must have the same bins.
+  void Merge(const Histogram<T>& other) {
+    CHECK(boundaries_ == other.boundaries_)
+        << "Only histograms with the same bins can be merged.";
+    for (int i = 0; i < histogram_count_.size(); i++) {
+      histogram_count_[i] += other.histogram_count_[i];
+    }
+  }
+
+  // The total number of values added.
+  int NumValues() const {
+    int num_values = 0;
+    for (const int count : histogram_count_) {
+      num_values += count;
+    }
+    return num_values;
+  }
+
+  // The bins as specified by the user.
+  std::vector<T> Boundaries() const {
+    return std::vector<T>(boundaries_.begin() + 1, boundaries_.end() - 1);
+  }
+
+  // The number of values of each bin, starting with the values less than the
+  // first boundary and ending with the values greater than or equal to the
+  // last boundary. There is one more count than there are boundaries.
+  std::vector<int> Counts() const {
+    std::vector<int> counts(histogram_count_.begin(),
+                            histogram_count_.end() - 1);
+    counts.back() += histogram_count_.back();
+    return counts;
+  }
+
   // Returns the histogram printed in a message. For example, a histogram with
   // boundaries of [0, 1, 2, 3] may return a printed string of:
   //    < 0 = 2
@@ -75,7 +116,7 @@ class Histogram {
   //    [1 - 2) = 3
   //    [2 - 3) = 7
   //    > 3 = 2
-  std::string PrintString() {
+  std::string PrintString() const {
     std::string msg = "";
 
     // Print the bin containing elements less then the lower bound. Only print
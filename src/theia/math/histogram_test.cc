@@ -0,0 +1,66 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+
+#include "theia/math/histogram.h"
+
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace theia {
+
+TEST(Histogram, Counts) {
+  Histogram<double> histogram({1.0, 2.0, 3.0});
+  for (const double value : {0.5, 1.0, 1.5, 2.5, 2.9, 10.0}) {
+    histogram.Add(value);
+  }
+  EXPECT_EQ(histogram.Boundaries(), std::vector<double>({1.0, 2.0, 3.0}));
+  EXPECT_EQ(histogram.Counts(), std::vector<int>({1, 2, 2, 1}));
+  EXPECT_EQ(histogram.NumValues(), 6);
+}
+
+TEST(Histogram, Merge) {
+  const std::vector<int> bins = {2, 4, 8};
+  Histogram<int> histogram1(bins), histogram2(bins), expected(bins);
+  for (int i = 0; i < 20; i++) {
+    (i % 3 == 0 ? histogram1 : histogram2).Add(i);
+    expected.Add(i);
+  }
+  histogram1.Merge(histogram2);
+  EXPECT_EQ(histogram1.Counts(), expected.Counts());
+  EXPECT_EQ(histogram1.NumValues(), 20);
+}
+
+}  // namespace theia
@@ -40,9 +40,11 @@
 #include <glog/logging.h>
 
 #include <algorithm>
+#include <cmath>
 #include <string>
 
 #include "theia/math/matrix/sparse_cholesky_llt.h"
+#include "theia/util/executor.h"
 #include "theia/util/stringprintf.h"
 
 namespace theia {
@@ -62,6 +64,80 @@ inline void Compute(const Eigen::MatrixXd& spd_mat,
   linear_solver->Compute(spd_mat.sparseView());
 }
 
+typedef Eigen::SparseMatrix<double, Eigen::RowMajor> RowMajorSparseMatrix;
+
+inline RowMajorSparseMatrix ToRowMajor(const Eigen::SparseMatrix<double>& mat) {
+  return mat;
+}
+
+inline RowMajorSparseMatrix ToRowMajor(const Eigen::MatrixXd& mat) {
+  return mat.sparseView();
+}
+
+// Computes result = mat * vec. mat_row_major is a row-major copy of mat, which
+// is only used (and only needs to be set) if num_threads > 1. The rows are
+// split among the threads.
+template <class MatrixType>
+void Multiply(const MatrixType& mat,
+              const RowMajorSparseMatrix& mat_row_major,
+              const Eigen::VectorXd& vec,
+              const int num_threads,
+              Eigen::VectorXd* result) {
+  result->resize(mat.rows());
+  if (num_threads <= 1) {
+    result->noalias() = mat * vec;
+    return;
+  }
+  ParallelFor(num_threads, mat.rows(), [&](const int start, const int end) {
+    result->segment(start, end - start).noalias() =
+        mat_row_major.middleRows(start, end - start) * vec;
+  });
+}
+
+// Computes result = mat^t * vec. The columns of the column-major mat are split
+// among the threads.
+template <class MatrixType>
+void MultiplyTransposed(const MatrixType& mat,
+                        const Eigen::VectorXd& vec,
+                        const int num_threads,
+                        Eigen::VectorXd* result) {
+  result->resize(mat.cols());
+  if (num_threads <= 1) {
+    result->noalias() = mat.transpose() * vec;
+    return;
+  }
+  ParallelFor(num_threads, mat.cols(), [&](const int start, const int end) {
+    result->segment(start, end - start).noalias() =
+        mat.middleCols(start, end - start).transpose() * vec;
+  });
+}
+
+// Residual balancing for the augmented Lagrangian parameter rho, see section
+// 3.4.1 of Boyd et al. If the primal residual is much larger than the dual
+// residual rho is increased, and vice versa. The scaled dual variable u is
+// inversely proportional to rho and is rescaled with it, along with its
+// product a_transpose_u with A^t. Returns true if rho was changed.
+inline bool BalanceRho(const double primal_residual,
+                       const double dual_residual,
+                       const double balance_ratio,
+                       const double scale_factor,
+                       double* rho,
+                       Eigen::VectorXd* u,
+                       Eigen::VectorXd* a_transpose_u) {
+  double scale = 1.0;
+  if (primal_residual > balance_ratio * dual_residual) {
+    scale = scale_factor;
+  } else if (dual_residual > balance_ratio * primal_residual) {
+    scale = 1.0 / scale_factor;
+  } else {
+    return false;
+  }
+  *rho *= scale;
+  *u /= scale;
+  *a_transpose_u /= scale;
+  return true;
+}
+
 }  // namespace l1_solver_internal
 
 // An L1 norm approximation solver. This class will attempt to solve the
@@ -79,7 +155,9 @@ inline void Compute(const Eigen::MatrixXd& spd_mat,
 // few number of iterations, but can spend many iterations subsuquently refining
 // the solution to optain the global optimum. The speed improvements are because
 // the matrix A only needs to be factorized (by Cholesky decomposition) once, as
-// opposed to every iteration.
+// opposed to every iteration. In this formulation the x-update solves with A^t
+// * A regardless of rho, so rho can be adapted during the solve (by residual
+// balancing) without refactorizing.
 //
 // This implementation is based off of the code found at:
 //   https://web.stanford.edu/~boyd/papers/admm/least_abs_deviations/lad.html
@@ -95,36 +173,82 @@ class L1Solver {
 
     double absolute_tolerance = 1e-4;
     double relative_tolerance = 1e-2;
+
+    // If true, rho is adapted after each iteration so that the primal and
+    // dual residuals stay within a factor rho_balance_ratio of each other, by
+    // scaling it with rho_scale_factor.
+    bool adaptive_rho = false;
+    double rho_balance_ratio = 10.0;
+    double rho_scale_factor = 2.0;
+
+    // If true, Solve starts from the solution that is passed in and from the
+    // dual variables and rho of the previous call to Solve, instead of from
+    // zero. This speeds up sequences of similar problems, e.g. the iterations
+    // of robust rotation averaging.
+    bool warm_start = false;
+
+    // The number of threads used for the products with A and A^t.
+    int num_threads = 1;
   };
 
   L1Solver(const Options& options, const MatrixType& mat)
-      : options_(options), a_(mat) {
+      : options_(options), a_(mat), rho_(options.rho) {
     // Analyze the sparsity pattern once. Only the values of the entries will be
     // changed with each iteration.
     const MatrixType spd_mat = a_.transpose() * a_;
     l1_solver_internal::Compute(spd_mat, &linear_solver_);
     CHECK_EQ(linear_solver_.Info(), Eigen::Success);
+    if (options_.num_threads > 1) {
+      a_row_major_ = l1_solver_internal::ToRowMajor(a_);
+    }
   }
 
   void SetMaxIterations(const int max_iterations) {
     options_.max_num_iterations = max_iterations;
   }
 
+  // The value of rho at the end of the last call to Solve.
+  double Rho() const { return rho_; }
+
+  // The number of ADMM iterations of the last call to Solve.
+  int NumIterations() const { return num_iterations_; }
+
   // Solves ||Ax - b||_1 for the optimial L1 solution given an initial guess for
   // x. To solve this we introduce an auxillary variable y such that the
   // solution to:
   //        min   1 * y
   //   s.t. [  A   -I ] [ x ] < [  b ]
   //        [ -A   -I ] [ y ]   [ -b ]
-  // which is an equivalent linear program.
+  // which is an equivalent linear program. The initial guess is only used if
+  // options.warm_start is set.
   void Solve(const Eigen::VectorXd& rhs, Eigen::VectorXd* solution) {
     CHECK_NOTNULL(solution);
+    CHECK_EQ(rhs.size(), a_.rows());
     Eigen::VectorXd& x = *solution;
-    Eigen::VectorXd z(a_.rows()), u(a_.rows());
-    z.setZero();
-    u.setZero();
+
+    // z is the auxiliary variable Ax - b and u is the scaled dual variable.
+    // The products of A^t with z and u are kept up to date, which saves the
+    // separate products of the convergence tests.
+    Eigen::VectorXd z(a_.rows()), a_transpose_z, a_transpose_u;
+    if (options_.warm_start && x.size() == a_.cols()) {
+      Multiply(x, &z);
+      z -= rhs;
+    } else {
+      z.setZero();
+    }
+    if (!options_.warm_start || u_.size() != a_.rows()) {
+      u_.setZero(a_.rows());
+      rho_ = options_.rho;
+    }
+    Eigen::VectorXd& u = u_;
+    MultiplyTransposed(z, &a_transpose_z);
+    MultiplyTransposed(u, &a_transpose_u);
+
+    Eigen::VectorXd a_transpose_rhs;
+    MultiplyTransposed(rhs, &a_transpose_rhs);
 
     Eigen::VectorXd a_times_x(a_.rows()), z_old(z.size()), ax_hat(a_.rows());
+    Eigen::VectorXd a_transpose_z_old(a_.cols());
     // Precompute some convergence terms.
     const double rhs_norm = rhs.norm();
     const double primal_abs_tolerance_eps =
@@ -132,47 +256,62 @@ class L1Solver {
     const double dual_abs_tolerance_eps =
         std::sqrt(a_.cols()) * options_.absolute_tolerance;
     VLOG(2) << "Iteration   R norm          S norm          Primal eps      "
-               "Dual eps";
+               "Dual eps        Rho";
     const std::string row_format =
-        "  % 4d     % 4.4e     % 4.4e     % 4.4e     % 4.4e";
+        "  % 4d     % 4.4e     % 4.4e     % 4.4e     % 4.4e     % 4.4e";
+    num_iterations_ = 0;
     for (int i = 0; i < options_.max_num_iterations; i++) {
+      num_iterations_ = i + 1;
       // Update x.
-      x.noalias() = linear_solver_.Solve(a_.transpose() * (rhs + z - u));
+      x.noalias() =
+          linear_solver_.Solve(a_transpose_rhs + a_transpose_z - a_transpose_u);
       if (linear_solver_.Info() != Eigen::Success) {
         LOG(ERROR) << "L1 Minimization failed. Could not solve the sparse "
                       "linear system with Cholesky Decomposition";
         return;
       }
 
-      a_times_x.noalias() = a_ * x;
+      Multiply(x, &a_times_x);
       ax_hat.noalias() = options_.alpha * a_times_x;
       ax_hat.noalias() += (1.0 - options_.alpha) * (z + rhs);
 
       // Update z and set z_old.
       std::swap(z, z_old);
-      z.noalias() = Shrinkage(ax_hat - rhs + u, 1.0 / options_.rho);
+      std::swap(a_transpose_z, a_transpose_z_old);
+      z.noalias() = Shrinkage(ax_hat - rhs + u, 1.0 / rho_);
+      MultiplyTransposed(z, &a_transpose_z);
 
       // Update u.
       u.noalias() += ax_hat - z - rhs;
+      MultiplyTransposed(u, &a_transpose_u);
 
       // Compute the convergence terms.
       const double r_norm = (a_times_x - z - rhs).norm();
-      const double s_norm =
-          (-options_.rho * a_.transpose() * (z - z_old)).norm();
+      const double s_norm = rho_ * (a_transpose_z - a_transpose_z_old).norm();
       const double max_norm = std::max({a_times_x.norm(), z.norm(), rhs_norm});
       const double primal_eps =
           primal_abs_tolerance_eps + options_.relative_tolerance * max_norm;
-      const double dual_eps = dual_abs_tolerance_eps +
-                              options_.relative_tolerance *
-                                  (options_.rho * a_.transpose() * u).norm();
+      const double dual_eps =
+          dual_abs_tolerance_eps +
+          options_.relative_tolerance * rho_ * a_transpose_u.norm();
 
       // Log the result to the screen.
       VLOG(2) << StringPrintf(
-          row_format.c_str(), i, r_norm, s_norm, primal_eps, dual_eps);
+          row_format.c_str(), i, r_norm, s_norm, primal_eps, dual_eps, rho_);
       // Determine if the minimizer has converged.
       if (r_norm < primal_eps && s_norm < dual_eps) {
         break;
       }
+
+      if (options_.adaptive_rho) {
+        l1_solver_internal::BalanceRho(r_norm,
+                                       s_norm,
+                                       options_.rho_balance_ratio,
+                                       options_.rho_scale_factor,
+                                       &rho_,
+                                       &u,
+                                       &a_transpose_u);
+      }
     }
   }
 
@@ -182,10 +321,30 @@ class L1Solver {
   // Matrix A where || Ax - b ||_1 is the problem we are solving.
   MatrixType a_;
 
+  // A row-major copy of A for the parallel products with A.
+  l1_solver_internal::RowMajorSparseMatrix a_row_major_;
+
   // Cholesky linear solver. Since our linear system will be a SPD matrix we can
   // utilize the Cholesky factorization.
   SparseCholeskyLLt linear_solver_;
 
+  // The scaled dual variable and rho at the end of the last solve, which are
+  // the starting point of the next solve if warm starting.
+  Eigen::VectorXd u_;
+  double rho_;
+  int num_iterations_ = 0;
+
+  void Multiply(const Eigen::VectorXd& vec, Eigen::VectorXd* result) const {
+    l1_solver_internal::Multiply(
+        a_, a_row_major_, vec, options_.num_threads, result);
+  }
+
+  void MultiplyTransposed(const Eigen::VectorXd& vec,
+                          Eigen::VectorXd* result) const {
+    l1_solver_internal::MultiplyTransposed(
+        a_, vec, options_.num_threads, result);
+  }
+
   Eigen::VectorXd Shrinkage(const Eigen::VectorXd& vec, const double kappa) {
     Eigen::ArrayXd zero_vec(vec.size());
     zero_vec.setZero();
@@ -35,6 +35,7 @@
 #include "gtest/gtest.h"
 #include <Eigen/Core>
 #include <Eigen/LU>
+#include <Eigen/SparseCore>
 
 #include "theia/math/l1_solver.h"
 #include "theia/util/random.h"
@@ -131,4 +132,106 @@ TEST(L1Solver, Decoding) {
   }
 }
 
+// A sparse version of the decoding problem above: each row of A has a few
+// random entries, and 20% of the observations are corrupted.
+void SparseDecodingProblem(RandomNumberGenerator* rng,
+                           Eigen::SparseMatrix<double>* mat,
+                           Eigen::VectorXd* code_word,
+                           Eigen::VectorXd* observation) {
+  static const int kSourceLength = 200;
+  static const int kCodewordLength = 4 * kSourceLength;
+  static const int kNumEntriesPerRow = 6;
+
+  std::vector<Eigen::Triplet<double> > triplets;
+  for (int i = 0; i < kCodewordLength; i++) {
+    triplets.emplace_back(i, i % kSourceLength, 1.0);
+    for (int j = 1; j < kNumEntriesPerRow; j++) {
+      triplets.emplace_back(
+          i, rng->RandInt(0, kSourceLength - 1), rng->RandDouble(-1.0, 1.0));
+    }
+  }
+  mat->resize(kCodewordLength, kSourceLength);
+  mat->setFromTriplets(triplets.begin(), triplets.end());
+
+  Eigen::VectorXd source_word(kSourceLength);
+  rng->SetRandom(&source_word);
+  *code_word = *mat * source_word;
+  *observation = *code_word;
+  for (int i = 0; i < kCodewordLength / 5; i++) {
+    (*observation)(rng->RandInt(0, kCodewordLength - 1)) =
+        rng->RandDouble(-0.5, 0.5);
+  }
+}
+
+TEST(L1Solver, AdaptiveRhoAndThreads) {
+  RandomNumberGenerator rng(95);
+  static const double kTolerance = 1e-6;
+  Eigen::SparseMatrix<double> mat;
+  Eigen::VectorXd code_word, observation;
+  SparseDecodingProblem(&rng, &mat, &code_word, &observation);
+
+  L1Solver<Eigen::SparseMatrix<double> >::Options options;
+  options.absolute_tolerance = 1e-8;
+  options.relative_tolerance = 1e-8;
+  options.max_num_iterations = 5000;
+  // A poor choice of rho for this problem.
+  options.rho = 100.0;
+  L1Solver<Eigen::SparseMatrix<double> > fixed_rho_solver(options, mat);
+  Eigen::VectorXd fixed_rho_solution;
+  fixed_rho_solver.Solve(observation, &fixed_rho_solution);
+
+  options.adaptive_rho = true;
+  options.num_threads = 4;
+  L1Solver<Eigen::SparseMatrix<double> > adaptive_rho_solver(options, mat);
+  Eigen::VectorXd adaptive_rho_solution;
+  adaptive_rho_solver.Solve(observation, &adaptive_rho_solution);
+  EXPECT_LT(adaptive_rho_solver.NumIterations(),
+            fixed_rho_solver.NumIterations());
+  EXPECT_NE(adaptive_rho_solver.Rho(), options.rho);
+
+  const Eigen::VectorXd residual = mat * adaptive_rho_solution - code_word;
+  for (int i = 0; i < residual.size(); i++) {
+    EXPECT_NEAR(residual(i), 0.0, kTolerance);
+  }
+  for (int i = 0; i < adaptive_rho_solution.size(); i++) {
+    EXPECT_NEAR(adaptive_rho_solution(i), fixed_rho_solution(i), kTolerance);
+  }
+}
+
+TEST(L1Solver, WarmStart) {
+  RandomNumberGenerator rng(96);
+  Eigen::SparseMatrix<double> mat;
+  Eigen::VectorXd code_word, observation;
+  SparseDecodingProblem(&rng, &mat, &code_word, &observation);
+
+  L1Solver<Eigen::SparseMatrix<double> >::Options options;
+  options.absolute_tolerance = 1e-6;
+  options.relative_tolerance = 1e-6;
+  options.max_num_iterations = 5000;
+  options.adaptive_rho = true;
+  options.warm_start = true;
+  L1Solver<Eigen::SparseMatrix<double> > warm_solver(options, mat);
+  Eigen::VectorXd solution;
+  warm_solver.Solve(observation, &solution);
+
+  // Corrupt a few more observations and solve again, from the previous
+  // solution and from scratch.
+  Eigen::VectorXd perturbed_observation = observation;
+  for (int i = 0; i < 10; i++) {
+    perturbed_observation(rng.RandInt(0, observation.size() - 1)) =
+        rng.RandDouble(-0.5, 0.5);
+  }
+  warm_solver.Solve(perturbed_observation, &solution);
+
+  options.warm_start = false;
+  L1Solver<Eigen::SparseMatrix<double> > cold_solver(options, mat);
+  Eigen::VectorXd cold_solution;
+  cold_solver.Solve(perturbed_observation, &cold_solution);
+
+  EXPECT_LT(warm_solver.NumIterations(), cold_solver.NumIterations());
+  for (int i = 0; i < solution.size(); i++) {
+    EXPECT_NEAR(solution(i), cold_solution(i), 1e-4);
+  }
+}
+
 }  // namespace theia
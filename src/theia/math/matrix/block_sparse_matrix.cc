@@ -0,0 +1,200 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#include "theia/math/matrix/block_sparse_matrix.h"
+
+#include <Eigen/Core>
+#include <Eigen/SparseCore>
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace theia {
+
+namespace {
+
+// Accumulates Y_j * A_ji over the nonzero blocks of a block column. The block
+// dimension is a template parameter so that the products of the 3x3 blocks of
+// rotation averaging are unrolled.
+template <int kBlockDim>
+void LeftMultiplyBlockColumnImpl(const int block_dim,
+                                 const int num_blocks,
+                                 const int* block_rows,
+                                 const double* values,
+                                 const int excluded_block_row,
+                                 const Eigen::MatrixXd& y,
+                                 Eigen::MatrixXd* result) {
+  typedef Eigen::Matrix<double, kBlockDim, kBlockDim> BlockType;
+  typedef Eigen::Block<const Eigen::MatrixXd, Eigen::Dynamic, kBlockDim>
+      YBlockType;
+
+  result->setZero(y.rows(), block_dim);
+  const int block_size = block_dim * block_dim;
+  for (int k = 0; k < num_blocks; k++) {
+    if (block_rows[k] == excluded_block_row) {
+      continue;
+    }
+    const Eigen::Map<const BlockType> block(
+        values + k * block_size, block_dim, block_dim);
+    const YBlockType y_j(y, 0, block_rows[k] * block_dim, y.rows(), block_dim);
+    result->noalias() += y_j * block;
+  }
+}
+
+}  // namespace
+
+BlockSparseMatrix::BlockSparseMatrix() : block_dim_(1), column_offsets_(1, 0) {}
+
+BlockSparseMatrix::BlockSparseMatrix(const Eigen::SparseMatrix<double>& matrix,
+                                     const int block_dim)
+    : block_dim_(block_dim) {
+  CHECK_GT(block_dim_, 0);
+  CHECK_EQ(matrix.rows(), matrix.cols());
+  CHECK_EQ(matrix.cols() % block_dim_, 0);
+  const int num_block_columns = matrix.cols() / block_dim_;
+
+  // Find the nonzero blocks of each block column.
+  column_offsets_.reserve(num_block_columns + 1);
+  column_offsets_.emplace_back(0);
+  std::vector<int> column_block_rows;
+  for (int i = 0; i < num_block_columns; i++) {
+    column_block_rows.clear();
+    for (int c = i * block_dim_; c < (i + 1) * block_dim_; c++) {
+      for (Eigen::SparseMatrix<double>::InnerIterator it(matrix, c); it;
+           ++it) {
+        column_block_rows.emplace_back(it.row() / block_dim_);
+      }
+    }
+    std::sort(column_block_rows.begin(), column_block_rows.end());
+    column_block_rows.erase(
+        std::unique(column_block_rows.begin(), column_block_rows.end()),
+        column_block_rows.end());
+    block_rows_.insert(block_rows_.end(),
+                       column_block_rows.begin(),
+                       column_block_rows.end());
+    column_offsets_.emplace_back(block_rows_.size());
+  }
+
+  // Copy the entries into their blocks.
+  const int block_size = block_dim_ * block_dim_;
+  values_.resize(block_rows_.size() * block_size, 0.0);
+  for (int i = 0; i < num_block_columns; i++) {
+    const int* begin = BlockRows(i);
+    const int* end = begin + ColumnDegree(i);
+    for (int c = i * block_dim_; c < (i + 1) * block_dim_; c++) {
+      for (Eigen::SparseMatrix<double>::InnerIterator it(matrix, c); it;
+           ++it) {
+        const int k = column_offsets_[i] +
+                      (std::lower_bound(begin, end, it.row() / block_dim_) -
+                       begin);
+        values_[k * block_size + (c % block_dim_) * block_dim_ +
+                it.row() % block_dim_] += it.value();
+      }
+    }
+  }
+}
+
+void BlockSparseMatrix::LeftMultiplyBlockColumn(const Eigen::MatrixXd& y,
+                                                const int i,
+                                                Eigen::MatrixXd* result) const {
+  LeftMultiplyBlockColumn(y, i, -1, result);
+}
+
+void BlockSparseMatrix::LeftMultiplyBlockColumn(const Eigen::MatrixXd& y,
+                                                const int i,
+                                                const int excluded_block_row,
+                                                Eigen::MatrixXd* result) const {
+  DCHECK_EQ(y.cols(), NumBlockColumns() * block_dim_);
+  const int offset = column_offsets_[i];
+  const double* values = values_.data() + offset * block_dim_ * block_dim_;
+  if (block_dim_ == 3) {
+    LeftMultiplyBlockColumnImpl<3>(block_dim_,
+                                   ColumnDegree(i),
+                                   block_rows_.data() + offset,
+                                   values,
+                                   excluded_block_row,
+                                   y,
+                                   result);
+  } else {
+    LeftMultiplyBlockColumnImpl<Eigen::Dynamic>(block_dim_,
+                                                ColumnDegree(i),
+                                                block_rows_.data() + offset,
+                                                values,
+                                                excluded_block_row,
+                                                y,
+                                                result);
+  }
+}
+
+void BlockSparseMatrix::LeftMultiply(const Eigen::MatrixXd& y,
+                                     Eigen::MatrixXd* result) const {
+  CHECK_EQ(y.cols(), NumBlockColumns() * block_dim_);
+  result->resize(y.rows(), y.cols());
+  Eigen::MatrixXd block_column;
+  for (int i = 0; i < NumBlockColumns(); i++) {
+    LeftMultiplyBlockColumn(y, i, &block_column);
+    result->middleCols(i * block_dim_, block_dim_) = block_column;
+  }
+}
+
+std::vector<int> BlockSparseMatrix::PartitionByDegree(
+    const std::vector<int>& block_columns, const int num_partitions) const {
+  CHECK_GT(num_partitions, 0);
+  // Each block column costs one unit for its own output block in addition to
+  // its nonzero blocks.
+  int64_t total_cost = 0;
+  for (const int i : block_columns) {
+    total_cost += ColumnDegree(i) + 1;
+  }
+
+  std::vector<int> boundaries(1, 0);
+  boundaries.reserve(num_partitions + 1);
+  int64_t cost = 0;
+  for (int k = 0; k < block_columns.size(); k++) {
+    cost += ColumnDegree(block_columns[k]) + 1;
+    // Close the current partition once it reaches its share of the cost.
+    while (boundaries.size() < num_partitions &&
+           cost * num_partitions >= total_cost * boundaries.size()) {
+      boundaries.emplace_back(k + 1);
+    }
+  }
+  while (boundaries.size() < num_partitions + 1) {
+    boundaries.emplace_back(block_columns.size());
+  }
+  return boundaries;
+}
+
+}  // namespace theia
@@ -0,0 +1,109 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#ifndef THEIA_MATH_MATRIX_BLOCK_SPARSE_MATRIX_H_
+#define THEIA_MATH_MATRIX_BLOCK_SPARSE_MATRIX_H_
+
+#include <Eigen/Core>
+#include <Eigen/SparseCore>
+
+#include <vector>
+
+namespace theia {
+
+// A square sparse matrix of block_dim x block_dim blocks that only stores its
+// nonzero blocks, e.g., the blocks of the edges of a view graph in rotation
+// averaging. The blocks are stored contiguously by block column with their
+// block rows in increasing order, so that the product of a wide matrix Y with
+// a block column streams through the blocks of the column and the blocks of Y
+// they touch in order. Each block column can be computed independently, which
+// allows them to be computed in parallel.
+class BlockSparseMatrix {
+ public:
+  BlockSparseMatrix();
+
+  // Extracts the nonzero blocks of the matrix. The size of the matrix must be a
+  // multiple of block_dim.
+  BlockSparseMatrix(const Eigen::SparseMatrix<double>& matrix,
+                    const int block_dim);
+
+  int NumBlockColumns() const { return column_offsets_.size() - 1; }
+  int BlockDim() const { return block_dim_; }
+  int NumNonzeroBlocks() const { return block_rows_.size(); }
+
+  // The number of nonzero blocks in block column i.
+  int ColumnDegree(const int i) const {
+    return column_offsets_[i + 1] - column_offsets_[i];
+  }
+
+  // The block rows of the nonzero blocks of block column i.
+  const int* BlockRows(const int i) const {
+    return block_rows_.data() + column_offsets_[i];
+  }
+
+  // Computes block column i of Y * A, i.e., the sum of Y_j * A_ji over the
+  // nonzero blocks A_ji of block column i, where Y_j is block column j of Y.
+  void LeftMultiplyBlockColumn(const Eigen::MatrixXd& y,
+                               const int i,
+                               Eigen::MatrixXd* result) const;
+
+  // Same as above, but skips the block of block row excluded_block_row.
+  void LeftMultiplyBlockColumn(const Eigen::MatrixXd& y,
+                               const int i,
+                               const int excluded_block_row,
+                               Eigen::MatrixXd* result) const;
+
+  // Computes Y * A one block column at a time.
+  void LeftMultiply(const Eigen::MatrixXd& y, Eigen::MatrixXd* result) const;
+
+  // Splits the sequence of block columns into num_partitions contiguous ranges
+  // with similar numbers of nonzero blocks, so that each range takes about the
+  // same time to compute. Returns the num_partitions + 1 boundaries of the
+  // ranges in the sequence; some ranges may be empty.
+  std::vector<int> PartitionByDegree(const std::vector<int>& block_columns,
+                                     const int num_partitions) const;
+
+ private:
+  int block_dim_;
+
+  // The nonzero blocks of block column i are column_offsets_[i] to
+  // column_offsets_[i + 1] - 1. Each block is stored in column-major order.
+  std::vector<int> column_offsets_;
+  std::vector<int> block_rows_;
+  std::vector<double> values_;
+};
+
+}  // namespace theia
+
+#endif  // THEIA_MATH_MATRIX_BLOCK_SPARSE_MATRIX_H_
@@ -0,0 +1,161 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#include "theia/math/matrix/block_sparse_matrix.h"
+
+#include <Eigen/Core>
+#include <Eigen/SparseCore>
+
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "theia/util/random.h"
+
+namespace theia {
+
+namespace {
+
+RandomNumberGenerator rng(62);
+
+// Creates a symmetric matrix with random nonzero blocks.
+Eigen::SparseMatrix<double> CreateRandomBlockSparseMatrix(
+    const int num_block_columns, const int num_blocks, const int block_dim) {
+  std::vector<Eigen::Triplet<double> > triplets;
+  for (int k = 0; k < num_blocks; k++) {
+    const int i = rng.RandInt(0, num_block_columns - 1);
+    const int j = rng.RandInt(0, num_block_columns - 1);
+    const Eigen::MatrixXd block = Eigen::MatrixXd::Random(block_dim, block_dim);
+    for (int r = 0; r < block_dim; r++) {
+      for (int c = 0; c < block_dim; c++) {
+        triplets.emplace_back(i * block_dim + r, j * block_dim + c, block(r, c));
+        triplets.emplace_back(j * block_dim + c, i * block_dim + r, block(r, c));
+      }
+    }
+  }
+  Eigen::SparseMatrix<double> matrix(num_block_columns * block_dim,
+                                     num_block_columns * block_dim);
+  matrix.setFromTriplets(triplets.begin(), triplets.end());
+  return matrix;
+}
+
+void TestLeftMultiply(const int block_dim) {
+  static const int kNumBlockColumns = 50;
+  static const int kRank = 5;
+  const Eigen::SparseMatrix<double> matrix =
+      CreateRandomBlockSparseMatrix(kNumBlockColumns, 200, block_dim);
+  const BlockSparseMatrix block_sparse_matrix(matrix, block_dim);
+  EXPECT_EQ(block_sparse_matrix.NumBlockColumns(), kNumBlockColumns);
+  EXPECT_EQ(block_sparse_matrix.BlockDim(), block_dim);
+
+  const Eigen::MatrixXd y =
+      Eigen::MatrixXd::Random(kRank, kNumBlockColumns * block_dim);
+  const Eigen::MatrixXd expected_result = y * matrix;
+  Eigen::MatrixXd result;
+  block_sparse_matrix.LeftMultiply(y, &result);
+  EXPECT_LT((result - expected_result).norm(), 1e-10);
+
+  // Exclude the diagonal block of each block column.
+  for (int i = 0; i < kNumBlockColumns; i++) {
+    Eigen::MatrixXd block_column;
+    block_sparse_matrix.LeftMultiplyBlockColumn(y, i, i, &block_column);
+    const Eigen::MatrixXd expected_block_column =
+        expected_result.middleCols(i * block_dim, block_dim) -
+        y.middleCols(i * block_dim, block_dim) *
+            Eigen::MatrixXd(matrix).block(
+                i * block_dim, i * block_dim, block_dim, block_dim);
+    EXPECT_LT((block_column - expected_block_column).norm(), 1e-10);
+  }
+}
+
+}  // namespace
+
+TEST(BlockSparseMatrix, LeftMultiply3x3Blocks) {
+  TestLeftMultiply(3);
+}
+
+TEST(BlockSparseMatrix, LeftMultiplyDynamicBlocks) {
+  TestLeftMultiply(2);
+  TestLeftMultiply(4);
+}
+
+TEST(BlockSparseMatrix, NonzeroBlocks) {
+  // A 3x3 block matrix with the blocks (0, 1), (1, 0) and (2, 2).
+  Eigen::SparseMatrix<double> matrix(6, 6);
+  matrix.insert(0, 3) = 1.0;
+  matrix.insert(3, 0) = 1.0;
+  matrix.insert(5, 4) = 2.0;
+  const BlockSparseMatrix block_sparse_matrix(matrix, 2);
+  EXPECT_EQ(block_sparse_matrix.NumNonzeroBlocks(), 3);
+  EXPECT_EQ(block_sparse_matrix.ColumnDegree(0), 1);
+  EXPECT_EQ(block_sparse_matrix.BlockRows(0)[0], 1);
+  EXPECT_EQ(block_sparse_matrix.ColumnDegree(1), 1);
+  EXPECT_EQ(block_sparse_matrix.BlockRows(1)[0], 0);
+  EXPECT_EQ(block_sparse_matrix.ColumnDegree(2), 1);
+  EXPECT_EQ(block_sparse_matrix.BlockRows(2)[0], 2);
+}
+
+TEST(BlockSparseMatrix, PartitionByDegree) {
+  static const int kNumBlockColumns = 100;
+  static const int kNumPartitions = 4;
+  const Eigen::SparseMatrix<double> matrix =
+      CreateRandomBlockSparseMatrix(kNumBlockColumns, 1000, 3);
+  const BlockSparseMatrix block_sparse_matrix(matrix, 3);
+
+  std::vector<int> block_columns(kNumBlockColumns);
+  int max_cost = 0;
+  int total_cost = 0;
+  for (int i = 0; i < kNumBlockColumns; i++) {
+    block_columns[i] = i;
+    const int cost = block_sparse_matrix.ColumnDegree(i) + 1;
+    max_cost = std::max(max_cost, cost);
+    total_cost += cost;
+  }
+
+  const std::vector<int> boundaries =
+      block_sparse_matrix.PartitionByDegree(block_columns, kNumPartitions);
+  ASSERT_EQ(boundaries.size(), kNumPartitions + 1);
+  EXPECT_EQ(boundaries.front(), 0);
+  EXPECT_EQ(boundaries.back(), kNumBlockColumns);
+  for (int p = 0; p < kNumPartitions; p++) {
+    EXPECT_LE(boundaries[p], boundaries[p + 1]);
+    int cost = 0;
+    for (int k = boundaries[p]; k < boundaries[p + 1]; k++) {
+      cost += block_sparse_matrix.ColumnDegree(block_columns[k]) + 1;
+    }
+    // Each partition is within one block column of its share of the cost.
+    EXPECT_LE(cost, total_cost / kNumPartitions + max_cost);
+  }
+}
+
+}  // namespace theia
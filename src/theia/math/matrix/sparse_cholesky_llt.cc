@@ -76,6 +76,10 @@
 #include <Eigen/SparseCore>
 #include <glog/logging.h>
 
+#include <algorithm>
+
+#include "theia/util/executor.h"
+
 // UF_long is deprecated but SuiteSparse_long is only available in
 // newer versions of SuiteSparse. So for older versions of
 // SuiteSparse, we define SuiteSparse_long to be the same as UF_long,
@@ -94,26 +98,74 @@ namespace theia {
 SparseCholeskyLLt::SparseCholeskyLLt(const Eigen::SparseMatrix<double>& mat)
     : is_factorization_ok_(false),
       is_analysis_ok_(false),
-      info_(Eigen::Success) {
+      info_(Eigen::Success),
+      analyzed_rows_(0),
+      analyzed_cols_(0),
+      num_analyses_(0) {
   Compute(mat);
 }
 
 SparseCholeskyLLt::SparseCholeskyLLt()
     : is_factorization_ok_(false),
       is_analysis_ok_(false),
-      info_(Eigen::Success) {}
+      info_(Eigen::Success),
+      analyzed_rows_(0),
+      analyzed_cols_(0),
+      num_analyses_(0) {}
 
 SparseCholeskyLLt::~SparseCholeskyLLt() {}
 
 void SparseCholeskyLLt::AnalyzePattern(const Eigen::SparseMatrix<double>& mat) {
   solver_.analyzePattern(mat);
+  ++num_analyses_;
   info_ = solver_.info();
-  if (info_ == Eigen::Success)
+  if (info_ == Eigen::Success) {
     is_analysis_ok_ = true;
-  else
+    SetAnalyzedPattern(mat);
+  } else {
     is_analysis_ok_ = false;
+  }
   is_factorization_ok_ = false;
-  info_ = Eigen::Success;
+}
+
+bool SparseCholeskyLLt::HasAnalyzedPattern(
+    const Eigen::SparseMatrix<double>& mat) const {
+  if (!is_analysis_ok_ || mat.rows() != analyzed_rows_ ||
+      mat.cols() != analyzed_cols_ ||
+      mat.nonZeros() != analyzed_inner_indices_.size()) {
+    return false;
+  }
+  // The pattern of uncompressed matrices is compared column by column.
+  for (int col = 0; col < mat.outerSize(); col++) {
+    const int start = mat.outerIndexPtr()[col];
+    const int size = mat.isCompressed() ? mat.outerIndexPtr()[col + 1] - start
+                                        : mat.innerNonZeroPtr()[col];
+    if (size != analyzed_outer_indices_[col + 1] -
+                    analyzed_outer_indices_[col] ||
+        !std::equal(mat.innerIndexPtr() + start,
+                    mat.innerIndexPtr() + start + size,
+                    analyzed_inner_indices_.begin() +
+                        analyzed_outer_indices_[col])) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void SparseCholeskyLLt::SetAnalyzedPattern(
+    const Eigen::SparseMatrix<double>& mat) {
+  analyzed_rows_ = mat.rows();
+  analyzed_cols_ = mat.cols();
+  analyzed_outer_indices_.resize(mat.outerSize() + 1);
+  analyzed_inner_indices_.clear();
+  analyzed_inner_indices_.reserve(mat.nonZeros());
+  analyzed_outer_indices_[0] = 0;
+  for (int col = 0; col < mat.outerSize(); col++) {
+    for (Eigen::SparseMatrix<double>::InnerIterator it(mat, col); it; ++it) {
+      analyzed_inner_indices_.emplace_back(it.row());
+    }
+    analyzed_outer_indices_[col + 1] = analyzed_inner_indices_.size();
+  }
 }
 
 void SparseCholeskyLLt::Factorize(const Eigen::SparseMatrix<double>& mat) {
@@ -127,12 +179,13 @@ void SparseCholeskyLLt::Factorize(const Eigen::SparseMatrix<double>& mat) {
 }
 
 void SparseCholeskyLLt::Compute(const Eigen::SparseMatrix<double>& mat) {
-  solver_.compute(mat);
-  info_ = solver_.info();
-  if (info_ == Eigen::Success) {
-    is_factorization_ok_ = true;
-    is_analysis_ok_ = true;
+  if (!HasAnalyzedPattern(mat)) {
+    AnalyzePattern(mat);
+    if (info_ != Eigen::Success) {
+      return;
+    }
   }
+  Factorize(mat);
 }
 
 Eigen::ComputationInfo SparseCholeskyLLt::Info() { return info_; }
@@ -152,4 +205,22 @@ Eigen::VectorXd SparseCholeskyLLt::Solve(const Eigen::VectorXd& rhs) {
   return solution;
 }
 
+void SparseCholeskyLLt::Solve(const Eigen::MatrixXd& rhs,
+                              const int num_threads,
+                              Eigen::MatrixXd* solution) const {
+  CHECK_NOTNULL(solution);
+  CHECK(is_analysis_ok_) << "Cannot call Solve() because symbolic analysis "
+                            "of the matrix (i.e. AnalyzePattern()) failed!";
+  CHECK(is_factorization_ok_)
+      << "Cannot call Solve() because numeric factorization "
+         "of the matrix (i.e. Factorize()) failed!";
+  CHECK_EQ(rhs.rows(), analyzed_rows_);
+
+  solution->resize(rhs.rows(), rhs.cols());
+  ParallelFor(num_threads, rhs.cols(), [&](const int start, const int end) {
+    solution->middleCols(start, end - start) =
+        solver_.solve(rhs.middleCols(start, end - start));
+  });
+}
+
 }  // namespace theia
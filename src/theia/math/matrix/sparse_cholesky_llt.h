@@ -41,8 +41,10 @@
 #ifndef THEIA_MATH_MATRIX_SPARSE_CHOLESKY_LLT_H_
 #define THEIA_MATH_MATRIX_SPARSE_CHOLESKY_LLT_H_
 
+#include <Eigen/Core>
 #include <Eigen/SparseCholesky>
 #include <Eigen/SparseCore>
+#include <vector>
 
 namespace theia {
 
@@ -54,6 +56,13 @@ namespace theia {
 // and requires sparse matrices.
 //
 // NOTE: The matrix mat should be a symmetric matrix.
+//
+// The symbolic analysis only depends on the sparsity pattern of the matrix.
+// Compute() keeps the pattern of the last analysis and skips the analysis if
+// it is called again with a matrix of the same pattern, so loops that
+// refactorize matrices with a fixed pattern (e.g., IRLS) only pay for the
+// numeric factorization. AnalyzePattern() and Factorize() make the two steps
+// explicit.
 class SparseCholeskyLLt {
  public:
   explicit SparseCholeskyLLt(const Eigen::SparseMatrix<double>& mat);
@@ -72,9 +81,17 @@ class SparseCholeskyLLt {
   void Factorize(const Eigen::SparseMatrix<double>& mat);
 
   // Computes the Cholesky decomposition of mat. This is the same as calling
-  // AnalyzePattern() followed by Factorize().
+  // AnalyzePattern() followed by Factorize(), except that the analysis is
+  // skipped if mat has the sparsity pattern of the last analysis.
   void Compute(const Eigen::SparseMatrix<double>& mat);
 
+  // Returns true if the symbolic analysis of the last call to AnalyzePattern()
+  // or Compute() succeeded for a matrix with the sparsity pattern of mat.
+  bool HasAnalyzedPattern(const Eigen::SparseMatrix<double>& mat) const;
+
+  // The number of symbolic analyses performed so far.
+  int NumAnalyses() const { return num_analyses_; }
+
   // Returns the current state of the decomposition. After each step users
   // should ensure that Info() returns Eigen::Success.
   Eigen::ComputationInfo Info();
@@ -84,11 +101,26 @@ class SparseCholeskyLLt {
   // where lhs is the factorized matrix.
   Eigen::VectorXd Solve(const Eigen::VectorXd& rhs);
 
+  // Solves for all columns of rhs at once. The columns are split among
+  // num_threads threads, which share the factorization.
+  void Solve(const Eigen::MatrixXd& rhs,
+             const int num_threads,
+             Eigen::MatrixXd* solution) const;
+
  private:
+  // Stores the sparsity pattern of mat as the pattern of the analysis.
+  void SetAnalyzedPattern(const Eigen::SparseMatrix<double>& mat);
+
   Eigen::SimplicialLDLT<Eigen::SparseMatrix<double>, Eigen::Upper> solver_;
 
   bool is_factorization_ok_, is_analysis_ok_;
   Eigen::ComputationInfo info_;
+
+  // The sparsity pattern of the last analysis, in compressed column form.
+  int analyzed_rows_, analyzed_cols_;
+  std::vector<int> analyzed_outer_indices_;
+  std::vector<int> analyzed_inner_indices_;
+  int num_analyses_;
 };
 
 }  // namespace theia
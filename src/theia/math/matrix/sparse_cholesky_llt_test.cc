@@ -0,0 +1,144 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#include "theia/math/matrix/sparse_cholesky_llt.h"
+
+#include <Eigen/Core>
+#include <Eigen/SparseCore>
+
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "theia/util/random.h"
+
+namespace theia {
+namespace {
+
+static const double kTolerance = 1e-10;
+
+// A random symmetric positive definite matrix with a tridiagonal pattern plus
+// the given number of random off-diagonal entries.
+Eigen::SparseMatrix<double> RandomSpdMatrix(const int size,
+                                            const int num_extra_entries,
+                                            RandomNumberGenerator* rng) {
+  Eigen::SparseMatrix<double> lower(size, size);
+  std::vector<Eigen::Triplet<double> > triplets;
+  for (int i = 0; i < size; i++) {
+    triplets.emplace_back(i, i, rng->RandDouble(1.0, 2.0));
+    if (i > 0) {
+      triplets.emplace_back(i, i - 1, rng->RandDouble(-1.0, 1.0));
+    }
+  }
+  for (int i = 0; i < num_extra_entries; i++) {
+    const int row = rng->RandInt(1, size - 1);
+    triplets.emplace_back(
+        row, rng->RandInt(0, row - 1), rng->RandDouble(-1.0, 1.0));
+  }
+  lower.setFromTriplets(triplets.begin(), triplets.end());
+  return lower * Eigen::SparseMatrix<double>(lower.transpose());
+}
+
+TEST(SparseCholeskyLLt, ComputeReusesTheAnalysisOfTheSamePattern) {
+  RandomNumberGenerator rng(52);
+  Eigen::SparseMatrix<double> mat = RandomSpdMatrix(50, 20, &rng);
+  Eigen::VectorXd rhs(50);
+  rng.SetRandom(&rhs);
+
+  SparseCholeskyLLt solver;
+  for (int i = 0; i < 3; i++) {
+    // Same pattern, new values.
+    for (int k = 0; k < mat.outerSize(); k++) {
+      for (Eigen::SparseMatrix<double>::InnerIterator it(mat, k); it; ++it) {
+        if (it.row() == it.col()) {
+          it.valueRef() += 1.0;
+        }
+      }
+    }
+    solver.Compute(mat);
+    ASSERT_EQ(solver.Info(), Eigen::Success);
+    const Eigen::VectorXd solution = solver.Solve(rhs);
+    EXPECT_LT((mat * solution - rhs).norm(), kTolerance);
+  }
+  EXPECT_EQ(solver.NumAnalyses(), 1);
+  EXPECT_TRUE(solver.HasAnalyzedPattern(mat));
+
+  // A new pattern is analyzed again.
+  const Eigen::SparseMatrix<double> other_mat = RandomSpdMatrix(50, 30, &rng);
+  EXPECT_FALSE(solver.HasAnalyzedPattern(other_mat));
+  solver.Compute(other_mat);
+  ASSERT_EQ(solver.Info(), Eigen::Success);
+  EXPECT_EQ(solver.NumAnalyses(), 2);
+  EXPECT_LT((other_mat * solver.Solve(rhs) - rhs).norm(), kTolerance);
+}
+
+TEST(SparseCholeskyLLt, AnalyzeOnceFactorizeMany) {
+  RandomNumberGenerator rng(53);
+  Eigen::SparseMatrix<double> mat = RandomSpdMatrix(40, 10, &rng);
+  Eigen::VectorXd rhs(40);
+  rng.SetRandom(&rhs);
+
+  SparseCholeskyLLt solver;
+  solver.AnalyzePattern(mat);
+  ASSERT_EQ(solver.Info(), Eigen::Success);
+  for (int i = 0; i < 3; i++) {
+    mat *= 2.0;
+    solver.Factorize(mat);
+    ASSERT_EQ(solver.Info(), Eigen::Success);
+    EXPECT_LT((mat * solver.Solve(rhs) - rhs).norm(), kTolerance);
+  }
+  EXPECT_EQ(solver.NumAnalyses(), 1);
+}
+
+TEST(SparseCholeskyLLt, MultipleRightHandSides) {
+  RandomNumberGenerator rng(54);
+  const Eigen::SparseMatrix<double> mat = RandomSpdMatrix(60, 40, &rng);
+  Eigen::MatrixXd rhs(60, 25);
+  rng.SetRandom(&rhs);
+
+  SparseCholeskyLLt solver(mat);
+  ASSERT_EQ(solver.Info(), Eigen::Success);
+  Eigen::MatrixXd solution, multi_threaded_solution;
+  solver.Solve(rhs, 1, &solution);
+  solver.Solve(rhs, 4, &multi_threaded_solution);
+  EXPECT_LT((mat * solution - rhs).norm(), kTolerance);
+  for (int i = 0; i < rhs.cols(); i++) {
+    const Eigen::VectorXd column_solution = solver.Solve(rhs.col(i));
+    EXPECT_LT((solution.col(i) - column_solution).norm(), kTolerance);
+    EXPECT_LT((multi_threaded_solution.col(i) - column_solution).norm(),
+              kTolerance);
+  }
+}
+
+}  // namespace
+}  // namespace theia
@@ -48,10 +48,20 @@ namespace theia {
 class SparseSymShiftSolveLLT {
  public:
   explicit SparseSymShiftSolveLLT(const Eigen::SparseMatrix<double>& mat)
-      : mat_(mat) {
+      : SparseSymShiftSolveLLT(mat, nullptr) {}
+
+  // Same as above, but the decomposition is computed with linear_solver. The
+  // solver keeps its symbolic analysis, so solving matrices with the same
+  // sparsity pattern one after another only pays for the numeric
+  // factorization.
+  SparseSymShiftSolveLLT(const Eigen::SparseMatrix<double>& mat,
+                         SparseCholeskyLLt* linear_solver)
+      : mat_(mat),
+        linear_solver_(linear_solver != nullptr ? linear_solver
+                                                : &owned_linear_solver_) {
     CHECK_EQ(mat_.rows(), mat_.cols());
-    linear_solver_.Compute(mat_);
-    if (linear_solver_.Info() != Eigen::Success) {
+    linear_solver_->Compute(mat_);
+    if (linear_solver_->Info() != Eigen::Success) {
       LOG(FATAL)
           << "Could not perform Cholesky decomposition on the matrix. Are "
              "you sure it is positive semi-definite?";
@@ -66,8 +76,8 @@ class SparseSymShiftSolveLLT {
   void perform_op(double* x_in, double* y_out) {
     Eigen::Map<Eigen::VectorXd> x(x_in, mat_.rows());
     Eigen::Map<Eigen::VectorXd> y(y_out, mat_.cols());
-    y = linear_solver_.Solve(x);
-    if (linear_solver_.Info() != Eigen::Success) {
+    y = linear_solver_->Solve(x);
+    if (linear_solver_->Info() != Eigen::Success) {
       LOG(FATAL)
           << "Could not perform Cholesky decomposition on the matrix. Are "
              "you sure it is positive semi-definite?";
@@ -75,7 +85,8 @@ class SparseSymShiftSolveLLT {
   }
 
   const Eigen::SparseMatrix<double>& mat_;
-  SparseCholeskyLLt linear_solver_;
+  SparseCholeskyLLt owned_linear_solver_;
+  SparseCholeskyLLt* linear_solver_;
   double sigma_;
 };
 
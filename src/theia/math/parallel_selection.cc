@@ -0,0 +1,141 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#include "theia/math/parallel_selection.h"
+
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "theia/util/executor.h"
+
+namespace theia {
+
+namespace {
+
+// Fewer values are selected on the calling thread.
+static const int kMinNumValuesForParallelSelection = 1 << 16;
+
+// The number of sampled values from which the pivots are chosen, and the
+// distance in sample ranks of the pivots from the sample rank of k. With s
+// samples, the rank of k within the sample has a standard deviation of at most
+// sqrt(s) / 2, so the pivots bracket rank k with high probability.
+static const int kNumSamples = 1 << 12;
+static const int kPivotMargin = 128;
+
+double SelectFromCopy(const std::vector<double>& values, const int k) {
+  std::vector<double> copy = values;
+  std::nth_element(copy.begin(), copy.begin() + k, copy.end());
+  return copy[k];
+}
+
+// The values between the pivots and the number of values below them.
+struct Partition {
+  int64_t num_below = 0;
+  std::vector<double> candidates;
+};
+
+}  // namespace
+
+double ParallelSelect(const std::vector<double>& values,
+                      const int k,
+                      const int num_threads) {
+  CHECK(!values.empty());
+  CHECK_GE(k, 0);
+  CHECK_LT(k, values.size());
+  const int num_values = values.size();
+  if (num_threads <= 1 || num_values < kMinNumValuesForParallelSelection) {
+    return SelectFromCopy(values, k);
+  }
+
+  std::vector<double> samples(kNumSamples);
+  for (int i = 0; i < kNumSamples; i++) {
+    samples[i] = values[static_cast<int64_t>(i) * num_values / kNumSamples];
+  }
+  std::sort(samples.begin(), samples.end());
+
+  const int sample_rank =
+      static_cast<int>(static_cast<int64_t>(k) * kNumSamples / num_values);
+  const int lower_rank = sample_rank - kPivotMargin;
+  const int upper_rank = sample_rank + kPivotMargin;
+  const double lower = lower_rank < 0
+                           ? -std::numeric_limits<double>::infinity()
+                           : samples[lower_rank];
+  const double upper = upper_rank >= kNumSamples
+                           ? std::numeric_limits<double>::infinity()
+                           : samples[upper_rank];
+
+  Partition partition = ParallelReduce(
+      num_threads,
+      num_values,
+      Partition(),
+      [&](const int start, const int end) {
+        Partition block;
+        for (int i = start; i < end; i++) {
+          if (values[i] < lower) {
+            ++block.num_below;
+          } else if (values[i] <= upper) {
+            block.candidates.emplace_back(values[i]);
+          }
+        }
+        return block;
+      },
+      [](Partition partition, const Partition& block) {
+        partition.num_below += block.num_below;
+        partition.candidates.insert(partition.candidates.end(),
+                                    block.candidates.begin(),
+                                    block.candidates.end());
+        return partition;
+      });
+
+  const int64_t candidate_rank = k - partition.num_below;
+  if (candidate_rank < 0 || candidate_rank >= partition.candidates.size()) {
+    return SelectFromCopy(values, k);
+  }
+  std::nth_element(partition.candidates.begin(),
+                   partition.candidates.begin() + candidate_rank,
+                   partition.candidates.end());
+  return partition.candidates[candidate_rank];
+}
+
+double ParallelMedian(const std::vector<double>& values,
+                      const int num_threads) {
+  return ParallelSelect(values, values.size() / 2, num_threads);
+}
+
+}  // namespace theia
@@ -0,0 +1,63 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#ifndef THEIA_MATH_PARALLEL_SELECTION_H_
+#define THEIA_MATH_PARALLEL_SELECTION_H_
+
+#include <vector>
+
+namespace theia {
+
+// Returns the value of rank k (starting at 0) of the values, i.e. the value
+// that std::nth_element moves to position k. The values are not modified.
+//
+// With more than one thread, the values are first bracketed by two pivots
+// chosen from an evenly spaced sample. The values below the lower pivot are
+// counted and those between the pivots are collected in parallel, and the
+// value of rank k is then selected among the collected values. If the pivots
+// do not bracket rank k (which is unlikely unless the values are ordered
+// adversarially), the value is selected from a copy of all values. The result
+// is the same for any number of threads.
+double ParallelSelect(const std::vector<double>& values,
+                      const int k,
+                      const int num_threads);
+
+// Returns the value of rank n / 2 of the n values, which is the median for an
+// odd number of values and the upper median for an even number.
+double ParallelMedian(const std::vector<double>& values,
+                      const int num_threads);
+
+}  // namespace theia
+
+#endif  // THEIA_MATH_PARALLEL_SELECTION_H_
@@ -0,0 +1,96 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#include <glog/logging.h>
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "theia/math/parallel_selection.h"
+#include "theia/util/random.h"
+
+namespace theia {
+
+namespace {
+
+double SerialSelect(std::vector<double> values, const int k) {
+  std::nth_element(values.begin(), values.begin() + k, values.end());
+  return values[k];
+}
+
+}  // namespace
+
+TEST(ParallelSelection, MatchesSerialSelection) {
+  static const int kNumValues = 200000;
+  RandomNumberGenerator rng(52);
+  std::vector<double> values(kNumValues);
+  for (int i = 0; i < kNumValues; i++) {
+    values[i] = rng.RandGaussian(0.0, 10.0);
+  }
+
+  for (const int k : {0, 1, 1000, kNumValues / 2, kNumValues - 1}) {
+    const double expected = SerialSelect(values, k);
+    for (const int num_threads : {1, 2, 4, 7}) {
+      EXPECT_EQ(ParallelSelect(values, k, num_threads), expected);
+    }
+  }
+  EXPECT_EQ(ParallelMedian(values, 4), SerialSelect(values, kNumValues / 2));
+}
+
+TEST(ParallelSelection, SortedAndRepeatedValues) {
+  static const int kNumValues = 100000;
+  // Sorted values place the sampled pivots exactly.
+  std::vector<double> sorted(kNumValues);
+  // Few distinct values put many values equal to the pivots.
+  std::vector<double> repeated(kNumValues);
+  for (int i = 0; i < kNumValues; i++) {
+    sorted[i] = i;
+    repeated[i] = i % 3;
+  }
+
+  for (const int k : {0, 5000, kNumValues / 2, kNumValues - 1}) {
+    EXPECT_EQ(ParallelSelect(sorted, k, 4), k);
+    EXPECT_EQ(ParallelSelect(repeated, k, 4), SerialSelect(repeated, k));
+  }
+}
+
+TEST(ParallelSelection, FewValues) {
+  const std::vector<double> values = {5.0, -1.0, 3.0, 2.0};
+  EXPECT_EQ(ParallelSelect(values, 0, 4), -1.0);
+  EXPECT_EQ(ParallelMedian(values, 4), 3.0);
+  EXPECT_EQ(ParallelMedian({7.0}, 4), 7.0);
+}
+
+}  // namespace theia
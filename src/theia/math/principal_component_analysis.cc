@@ -0,0 +1,186 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+
+#include "theia/math/principal_component_analysis.h"
+
+#include <Eigen/Core>
+#include <Eigen/Eigenvalues>
+#include <Eigen/QR>
+#include <glog/logging.h>
+
+#include <algorithm>
+
+#include "theia/util/random.h"
+#include "theia/util/executor.h"
+
+namespace theia {
+
+namespace {
+
+// The rows of the products below are computed in blocks of this many rows,
+// which are distributed over the threads.
+static const int kBlockSize = 256;
+
+// Returns an orthonormal basis of the columns of the matrix.
+Eigen::MatrixXf Orthonormalize(const Eigen::MatrixXf& matrix) {
+  const Eigen::HouseholderQR<Eigen::MatrixXf> qr(matrix);
+  return qr.householderQ() *
+         Eigen::MatrixXf::Identity(matrix.rows(), matrix.cols());
+}
+
+// Computes (X - mean * 1^T)^T * matrix, where X are the data points.
+Eigen::MatrixXf CenteredTransposeProduct(
+    const int num_threads,
+    const Eigen::Ref<const Eigen::MatrixXf>& data_points,
+    const Eigen::VectorXf& mean,
+    const Eigen::MatrixXf& matrix) {
+  const Eigen::RowVectorXf mean_product = mean.transpose() * matrix;
+  Eigen::MatrixXf product(data_points.cols(), matrix.cols());
+  const int num_blocks = (data_points.cols() + kBlockSize - 1) / kBlockSize;
+  ParallelFor(num_threads, num_blocks, [&](const int start, const int end) {
+    const int first = start * kBlockSize;
+    const int num_rows =
+        std::min(end * kBlockSize, static_cast<int>(data_points.cols())) -
+        first;
+    product.middleRows(first, num_rows).noalias() =
+        data_points.middleCols(first, num_rows).transpose() * matrix;
+    product.middleRows(first, num_rows).rowwise() -= mean_product;
+  });
+  return product;
+}
+
+// Computes (X - mean * 1^T) * matrix, where X are the data points.
+Eigen::MatrixXf CenteredProduct(
+    const int num_threads,
+    const Eigen::Ref<const Eigen::MatrixXf>& data_points,
+    const Eigen::VectorXf& mean,
+    const Eigen::MatrixXf& matrix) {
+  const Eigen::RowVectorXf column_sums = matrix.colwise().sum();
+  Eigen::MatrixXf product(data_points.rows(), matrix.cols());
+  const int num_blocks = (data_points.rows() + kBlockSize - 1) / kBlockSize;
+  ParallelFor(num_threads, num_blocks, [&](const int start, const int end) {
+    const int first = start * kBlockSize;
+    const int num_rows =
+        std::min(end * kBlockSize, static_cast<int>(data_points.rows())) -
+        first;
+    product.middleRows(first, num_rows).noalias() =
+        data_points.middleRows(first, num_rows) * matrix;
+    product.middleRows(first, num_rows).noalias() -=
+        mean.segment(first, num_rows) * column_sums;
+  });
+  return product;
+}
+
+}  // namespace
+
+bool PrincipalComponentAnalysis::Fit(
+    const Options& options,
+    const Eigen::Ref<const Eigen::MatrixXf>& data_points) {
+  CHECK_GT(options.num_components, 0);
+  CHECK_GE(options.oversampling, 0);
+  CHECK_GE(options.num_power_iterations, 0);
+  CHECK_GT(options.num_threads, 0);
+  const int dimension = data_points.rows();
+  const int num_points = data_points.cols();
+  if (dimension == 0 || num_points < 2) {
+    LOG(ERROR) << "Cannot compute the principal components of " << num_points
+               << " points of dimension " << dimension << ".";
+    return false;
+  }
+
+  mean_ = (data_points.rowwise().sum().cast<double>() / num_points)
+              .cast<float>();
+
+  // The data has at most min(D, N - 1) directions of nonzero variance.
+  const int num_components =
+      std::min(options.num_components, std::min(dimension, num_points - 1));
+  const int subspace_dimension =
+      std::min(num_components + options.oversampling,
+               std::min(dimension, num_points));
+
+  // Subspace iteration: the basis is alternately multiplied with the centered
+  // data and its transpose, which amplifies the directions of large variance.
+  RandomNumberGenerator rng(options.seed, 0);
+  Eigen::MatrixXf basis(dimension, subspace_dimension);
+  for (int i = 0; i < basis.size(); i++) {
+    basis(i) = rng.RandGaussian(0.0, 1.0);
+  }
+  basis = Orthonormalize(basis);
+  for (int i = 0; i < options.num_power_iterations; i++) {
+    const Eigen::MatrixXf point_basis = Orthonormalize(CenteredTransposeProduct(
+        options.num_threads, data_points, mean_, basis));
+    basis = Orthonormalize(CenteredProduct(
+        options.num_threads, data_points, mean_, point_basis));
+  }
+
+  // The principal components are the eigenvectors of the covariance of the
+  // data restricted to the subspace.
+  const Eigen::MatrixXf projected_points = CenteredTransposeProduct(
+      options.num_threads, data_points, mean_, basis);
+  const Eigen::MatrixXd covariance =
+      (projected_points.transpose() * projected_points).cast<double>() /
+      (num_points - 1);
+  const Eigen::SelfAdjointEigenSolver<Eigen::MatrixXd> eigen_solver(covariance);
+
+  // The eigenvalues are sorted in increasing order.
+  components_.resize(dimension, num_components);
+  variances_.resize(num_components);
+  for (int i = 0; i < num_components; i++) {
+    const int index = subspace_dimension - 1 - i;
+    components_.col(i) =
+        basis * eigen_solver.eigenvectors().col(index).cast<float>();
+    variances_(i) = std::max(eigen_solver.eigenvalues()(index), 0.0);
+  }
+
+  projection_ = components_.transpose();
+  if (options.whiten) {
+    const float regularization =
+        options.whitening_regularization * variances_(0) + 1e-12f;
+    projection_ = (variances_.array() + regularization)
+                      .rsqrt()
+                      .matrix()
+                      .asDiagonal() *
+                  projection_;
+  }
+  return true;
+}
+
+Eigen::MatrixXf PrincipalComponentAnalysis::Project(
+    const Eigen::Ref<const Eigen::MatrixXf>& data_points) const {
+  CHECK_EQ(data_points.rows(), Dimension());
+  return projection_ * (data_points.colwise() - mean_);
+}
+
+}  // namespace theia
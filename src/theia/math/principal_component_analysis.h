@@ -0,0 +1,111 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+
+#ifndef THEIA_MATH_PRINCIPAL_COMPONENT_ANALYSIS_H_
+#define THEIA_MATH_PRINCIPAL_COMPONENT_ANALYSIS_H_
+
+#include <Eigen/Core>
+
+namespace theia {
+
+// Principal component analysis (PCA) that projects data points onto the
+// directions of largest variance, e.g. to compress high dimensional global
+// image descriptors before they are compared. The leading components are found
+// with randomized subspace iteration (Halko et al., "Finding Structure with
+// Randomness", 2011), which only needs products of the data with tall, thin
+// matrices instead of the full D x D covariance and its eigendecomposition.
+class PrincipalComponentAnalysis {
+ public:
+  struct Options {
+    // The number of principal components to keep. Fewer are kept if the data
+    // has fewer dimensions or points.
+    int num_components = 256;
+
+    // If true, the projected points are scaled by the inverse standard
+    // deviation along each component so that their covariance is the
+    // identity. Whitening gives the weak components the same weight as the
+    // dominant ones, which improves image retrieval with global descriptors.
+    bool whiten = true;
+
+    // Whitening divides by sqrt(variance + whitening_regularization * largest
+    // variance) so that components with almost no variance are not amplified.
+    double whitening_regularization = 1e-3;
+
+    // The subspace iteration estimates num_components + oversampling
+    // directions and runs num_power_iterations power iterations. More power
+    // iterations are more accurate when the spectrum decays slowly.
+    int oversampling = 16;
+    int num_power_iterations = 3;
+
+    // Number of threads used for the products with the data.
+    int num_threads = 1;
+
+    // The seed of the random starting subspace.
+    unsigned seed = 67;
+  };
+
+  PrincipalComponentAnalysis() {}
+
+  // Computes the principal components of the data points, which are the
+  // columns of the matrix. Returns false if there are fewer than two points.
+  bool Fit(const Options& options,
+           const Eigen::Ref<const Eigen::MatrixXf>& data_points);
+
+  // Projects the data points (columns) onto the principal components. The
+  // result has one column with NumComponents() entries per point.
+  Eigen::MatrixXf Project(
+      const Eigen::Ref<const Eigen::MatrixXf>& data_points) const;
+
+  int NumComponents() const { return projection_.rows(); }
+  int Dimension() const { return mean_.size(); }
+
+  // The mean of the data, the principal components (one per column, sorted by
+  // decreasing variance) and the variance of the data along each of them.
+  const Eigen::VectorXf& Mean() const { return mean_; }
+  const Eigen::MatrixXf& Components() const { return components_; }
+  const Eigen::VectorXf& Variances() const { return variances_; }
+
+ private:
+  Eigen::VectorXf mean_;
+  Eigen::MatrixXf components_;
+  Eigen::VectorXf variances_;
+
+  // The (possibly whitening) projection, num_components x D.
+  Eigen::MatrixXf projection_;
+};
+
+}  // namespace theia
+
+#endif  // THEIA_MATH_PRINCIPAL_COMPONENT_ANALYSIS_H_
@@ -0,0 +1,155 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+
+#include <Eigen/Core>
+#include <Eigen/QR>
+
+#include <cmath>
+#include "gtest/gtest.h"
+
+#include "theia/math/principal_component_analysis.h"
+#include "theia/util/random.h"
+
+namespace theia {
+
+namespace {
+
+// Returns num_points points with a standard deviation of standard_deviations(i)
+// along the i-th column of a random rotation, around a random mean.
+Eigen::MatrixXf SamplePoints(const Eigen::VectorXf& standard_deviations,
+                             const Eigen::MatrixXf& rotation,
+                             const Eigen::VectorXf& mean,
+                             const int num_points,
+                             RandomNumberGenerator* rng) {
+  Eigen::MatrixXf coefficients(standard_deviations.size(), num_points);
+  for (int i = 0; i < coefficients.size(); i++) {
+    coefficients(i) = rng->RandGaussian(0.0, 1.0);
+  }
+  return (rotation * standard_deviations.asDiagonal() * coefficients)
+             .colwise() +
+         mean;
+}
+
+Eigen::MatrixXf RandomRotation(const int dimension,
+                               RandomNumberGenerator* rng) {
+  Eigen::MatrixXf matrix(dimension, dimension);
+  for (int i = 0; i < matrix.size(); i++) {
+    matrix(i) = rng->RandGaussian(0.0, 1.0);
+  }
+  return Eigen::HouseholderQR<Eigen::MatrixXf>(matrix).householderQ();
+}
+
+}  // namespace
+
+TEST(PrincipalComponentAnalysis, RecoversComponents) {
+  static const int kDimension = 40;
+  RandomNumberGenerator rng(61, 0);
+  Eigen::VectorXf standard_deviations =
+      Eigen::VectorXf::Constant(kDimension, 0.1f);
+  standard_deviations.head<3>() << 10.0f, 5.0f, 2.0f;
+  const Eigen::MatrixXf rotation = RandomRotation(kDimension, &rng);
+  const Eigen::VectorXf mean = Eigen::VectorXf::Random(kDimension);
+  const Eigen::MatrixXf data_points =
+      SamplePoints(standard_deviations, rotation, mean, 5000, &rng);
+
+  PrincipalComponentAnalysis::Options options;
+  options.num_components = 3;
+  options.whiten = false;
+  options.num_threads = 4;
+  PrincipalComponentAnalysis pca;
+  ASSERT_TRUE(pca.Fit(options, data_points));
+  EXPECT_EQ(pca.NumComponents(), 3);
+  EXPECT_EQ(pca.Dimension(), kDimension);
+  EXPECT_LT((pca.Mean() - mean).norm(), 0.5);
+  for (int i = 0; i < 3; i++) {
+    EXPECT_NEAR(std::abs(pca.Components().col(i).dot(rotation.col(i))),
+                1.0,
+                1e-3);
+    EXPECT_NEAR(std::sqrt(pca.Variances()(i)),
+                standard_deviations(i),
+                0.05 * standard_deviations(i));
+  }
+
+  // Without whitening the projection is onto the orthonormal components.
+  const Eigen::MatrixXf projected_points = pca.Project(data_points);
+  ASSERT_EQ(projected_points.rows(), 3);
+  ASSERT_EQ(projected_points.cols(), data_points.cols());
+  EXPECT_NEAR(projected_points.row(0).squaredNorm() / (data_points.cols() - 1),
+              pca.Variances()(0),
+              1e-2 * pca.Variances()(0));
+}
+
+TEST(PrincipalComponentAnalysis, WhitenedPointsHaveUnitCovariance) {
+  static const int kDimension = 64;
+  RandomNumberGenerator rng(62, 0);
+  Eigen::VectorXf standard_deviations(kDimension);
+  for (int i = 0; i < kDimension; i++) {
+    standard_deviations(i) = 20.0f / (i + 1);
+  }
+  const Eigen::MatrixXf data_points =
+      SamplePoints(standard_deviations,
+                   RandomRotation(kDimension, &rng),
+                   Eigen::VectorXf::Zero(kDimension),
+                   2000,
+                   &rng);
+
+  PrincipalComponentAnalysis::Options options;
+  options.num_components = 8;
+  options.whitening_regularization = 0.0;
+  PrincipalComponentAnalysis pca;
+  ASSERT_TRUE(pca.Fit(options, data_points));
+
+  Eigen::MatrixXf projected_points = pca.Project(data_points);
+  projected_points.colwise() -= projected_points.rowwise().mean();
+  const Eigen::MatrixXf covariance = projected_points *
+                                     projected_points.transpose() /
+                                     (data_points.cols() - 1);
+  EXPECT_LT((covariance - Eigen::MatrixXf::Identity(8, 8)).norm(), 1e-2);
+}
+
+TEST(PrincipalComponentAnalysis, FewPoints) {
+  RandomNumberGenerator rng(63, 0);
+  PrincipalComponentAnalysis::Options options;
+  options.num_components = 16;
+  PrincipalComponentAnalysis pca;
+  EXPECT_FALSE(pca.Fit(options, Eigen::MatrixXf::Random(10, 1)));
+
+  // Five points span at most four dimensions.
+  ASSERT_TRUE(pca.Fit(options, Eigen::MatrixXf::Random(10, 5)));
+  EXPECT_EQ(pca.NumComponents(), 4);
+  EXPECT_TRUE(pca.Project(Eigen::MatrixXf::Random(10, 3)).allFinite());
+}
+
+}  // namespace theia
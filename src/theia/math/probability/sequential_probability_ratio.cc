@@ -72,12 +72,29 @@ bool SequentialProbabilityRatioTest(const std::vector<double>& residuals,
                                     double decision_threshold,
                                     int* num_tested_points,
                                     double* observed_inlier_ratio) {
+  return SequentialProbabilityRatioTest(
+      residuals.size(),
+      [&](const int i) { return residuals[i] < error_thresh; },
+      sigma,
+      epsilon,
+      decision_threshold,
+      num_tested_points,
+      observed_inlier_ratio);
+}
+
+bool SequentialProbabilityRatioTest(const int num_points,
+                                    const std::function<bool(int)>& is_inlier,
+                                    double sigma,
+                                    double epsilon,
+                                    double decision_threshold,
+                                    int* num_tested_points,
+                                    double* observed_inlier_ratio) {
   int observed_num_inliers = 0;
   double likelihood_ratio = 1.0;
-  for (int i = 0; i < residuals.size(); i++) {
+  for (int i = 0; i < num_points; i++) {
     // Check whether i-th data point is consistent with the model. Update the
     // likelihood ratio accordingly.
-    if (residuals[i] < error_thresh) {
+    if (is_inlier(i)) {
       likelihood_ratio *= sigma / epsilon;
       observed_num_inliers += 1;
     } else {
@@ -94,8 +111,8 @@ bool SequentialProbabilityRatioTest(const std::vector<double>& residuals,
   }
 
   *observed_inlier_ratio = static_cast<double>(observed_num_inliers) /
-                           static_cast<double>(residuals.size());
-  *num_tested_points = residuals.size();
+                           static_cast<double>(num_points);
+  *num_tested_points = num_points;
   return true;
 }
 }  // namespace theia
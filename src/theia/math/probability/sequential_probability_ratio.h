@@ -35,6 +35,7 @@
 #ifndef THEIA_MATH_PROBABILITY_SEQUENTIAL_PROBABILITY_RATIO_H_
 #define THEIA_MATH_PROBABILITY_SEQUENTIAL_PROBABILITY_RATIO_H_
 
+#include <functional>
 #include <vector>
 
 namespace theia {
@@ -70,6 +71,19 @@ bool SequentialProbabilityRatioTest(const std::vector<double>& residuals,
                                     int* num_tested_points,
                                     double* observed_inlier_ratio);
 
+// Same as above, but the data points are evaluated lazily so that the residual
+// of a point is only computed when the test reaches it. This is what makes SPRT
+// cheap for bad models: they are typically rejected after a handful of points.
+// num_points: Number of data points to test.
+// is_inlier: Returns true if the i-th data point is consistent with the model.
+bool SequentialProbabilityRatioTest(int num_points,
+                                    const std::function<bool(int)>& is_inlier,
+                                    double sigma,
+                                    double epsilon,
+                                    double decision_threshold,
+                                    int* num_tested_points,
+                                    double* observed_inlier_ratio);
+
 }  // namespace theia
 
 #endif  // THEIA_MATH_PROBABILITY_SEQUENTIAL_PROBABILITY_RATIO_H_
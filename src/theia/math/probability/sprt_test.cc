@@ -201,4 +201,58 @@ TEST(SPRTTest, SequentialProbabilityRatioTestFail) {
   EXPECT_FALSE(sprt_success);
 }
 
+TEST(SPRTTest, LazySequentialProbabilityRatioTest) {
+  // Create a set of points along y=x with a small random pertubation.
+  vector<Point> input_points;
+  for (int i = 0; i < 10000; ++i) {
+    double noise_x = rng.RandDouble(-1, 1);
+    double noise_y = rng.RandDouble(-1, 1);
+    input_points.push_back(Point(i + noise_x, i + noise_y));
+  }
+  LineEstimator estimator;
+  const double error_thresh = 0.5;
+  const double sigma = 0.05;
+  const double epsilon = 0.6;
+  const double decision_threshold =
+      CalculateSPRTDecisionThreshold(sigma, epsilon);
+
+  int num_tested_points;
+  double observed_inlier_ratio;
+  int num_evaluated_residuals = 0;
+
+  // A good model must be tested against all points.
+  const Line fitting_line(1.0, 0.0);
+  EXPECT_TRUE(SequentialProbabilityRatioTest(
+      input_points.size(),
+      [&](const int i) {
+        ++num_evaluated_residuals;
+        return estimator.Error(input_points[i], fitting_line) < error_thresh;
+      },
+      sigma,
+      epsilon,
+      decision_threshold,
+      &num_tested_points,
+      &observed_inlier_ratio));
+  EXPECT_EQ(num_tested_points, input_points.size());
+  EXPECT_EQ(num_evaluated_residuals, input_points.size());
+
+  // A bad model should be rejected after only evaluating a few residuals.
+  num_evaluated_residuals = 0;
+  const Line not_fitting_line(-1.0, 50);
+  EXPECT_FALSE(SequentialProbabilityRatioTest(
+      input_points.size(),
+      [&](const int i) {
+        ++num_evaluated_residuals;
+        return estimator.Error(input_points[i], not_fitting_line) <
+               error_thresh;
+      },
+      sigma,
+      epsilon,
+      decision_threshold,
+      &num_tested_points,
+      &observed_inlier_ratio));
+  EXPECT_EQ(num_tested_points, num_evaluated_residuals);
+  EXPECT_LT(num_evaluated_residuals, 100);
+}
+
 }  // namespace theia
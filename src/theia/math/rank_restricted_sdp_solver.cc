@@ -35,11 +35,18 @@
 #include "theia/math/rank_restricted_sdp_solver.h"
 
 #include <glog/logging.h>
+#include <algorithm>
+#include <functional>
 #include <limits>
+#include <numeric>
+#include <vector>
 
 #include <Eigen/Eigenvalues>
 #include <Eigen/QR>
 
+#include "theia/math/matrix/block_sparse_matrix.h"
+#include "theia/util/threadpool.h"
+
 namespace theia {
 namespace math {
 
@@ -51,24 +58,87 @@ RankRestrictedSDPSolver::RankRestrictedSDPSolver(
     const size_t n,
     const size_t block_dim,
     const math::SDPSolverOptions& options)
-    : BCMSDPSolver(n, block_dim, options), rank_(3) {
+    : BCMSDPSolver(n, block_dim, options),
+      num_threads_(std::max(options.num_threads, 1)),
+      rank_(3) {
   Y_ = Eigen::MatrixXd::Zero(rank_, dim_ * n_);
+  if (num_threads_ > 1) {
+    thread_pool_.reset(new ThreadPool(num_threads_));
+  }
+  SetupBlockSparseCovariance();
 }
 
-void RankRestrictedSDPSolver::Solve(math::Summary& summary) {
-  Eigen::MatrixXd G = Eigen::MatrixXd::Zero(rank_, dim_ * n_);
+RankRestrictedSDPSolver::~RankRestrictedSDPSolver() {}
 
-#pragma omp parallel for num_threads(sdp_solver_options_.num_threads)
-  // Compute inital G according to Equ.(3)
-  for (size_t i = 0; i < n_; i++) {
-    const std::vector<size_t>& adjs = adj_edges_[i];
-    for (auto j : adjs) {
-      G.block(0, i * dim_, rank_, dim_) +=
-          Y_.block(0, j * dim_, rank_, dim_) *
-          Q_.block(j * dim_, i * dim_, dim_, dim_);
+void RankRestrictedSDPSolver::SetCovariance(
+    const Eigen::SparseMatrix<double>& Q) {
+  BCMSDPSolver::SetCovariance(Q);
+  SetupBlockSparseCovariance();
+}
+
+void RankRestrictedSDPSolver::SetupBlockSparseCovariance() {
+  q_blocks_ = BlockSparseMatrix(Q_, dim_);
+
+  blocks_.resize(n_);
+  std::iota(blocks_.begin(), blocks_.end(), 0);
+  block_partition_ = q_blocks_.PartitionByDegree(blocks_, num_threads_);
+
+  // Greedily color the blocks in order of decreasing degree, which keeps the
+  // number of colors small.
+  std::vector<int> order = blocks_;
+  std::stable_sort(order.begin(), order.end(), [&](const int i, const int j) {
+    return q_blocks_.ColumnDegree(i) > q_blocks_.ColumnDegree(j);
+  });
+  std::vector<int> colors(n_, -1);
+  std::vector<int> color_used_by(0);
+  for (const int i : order) {
+    const int* neighbors = q_blocks_.BlockRows(i);
+    for (int k = 0; k < q_blocks_.ColumnDegree(i); k++) {
+      if (colors[neighbors[k]] >= 0) {
+        color_used_by[colors[neighbors[k]]] = i;
+      }
+    }
+    int color = 0;
+    while (color < color_used_by.size() && color_used_by[color] == i) {
+      ++color;
+    }
+    if (color == color_used_by.size()) {
+      color_used_by.emplace_back(-1);
     }
+    colors[i] = color;
   }
 
+  color_classes_.assign(color_used_by.size(), std::vector<int>());
+  for (size_t i = 0; i < n_; i++) {
+    color_classes_[colors[i]].emplace_back(i);
+  }
+  color_class_partitions_.resize(color_classes_.size());
+  for (int c = 0; c < color_classes_.size(); c++) {
+    color_class_partitions_[c] =
+        q_blocks_.PartitionByDegree(color_classes_[c], num_threads_);
+  }
+}
+
+void RankRestrictedSDPSolver::ParallelForBlocks(
+    const std::vector<int>& blocks,
+    const std::vector<int>& partition_boundaries,
+    const std::function<void(const int, const int)>& function) const {
+  const int num_partitions = partition_boundaries.size() - 1;
+  ParallelFor(thread_pool_.get(),
+              num_partitions,
+              num_partitions,
+              [&](const int start, const int end) {
+                for (int p = start; p < end; p++) {
+                  for (int k = partition_boundaries[p];
+                       k < partition_boundaries[p + 1];
+                       k++) {
+                    function(p, blocks[k]);
+                  }
+                }
+              });
+}
+
+void RankRestrictedSDPSolver::Solve(math::Summary& summary) {
   double prev_func_val = std::numeric_limits<double>::max();
   double cur_func_val = this->EvaluateFuncVal();
   double duration = 0.0;
@@ -91,23 +161,21 @@ void RankRestrictedSDPSolver::Solve(math::Summary& summary) {
       break;
     }
 
-    for (size_t i = 0; i < n_; i++) {
-      const Eigen::MatrixXd G_block = G.block(0, i * dim_, rank_, dim_);
-      Eigen::JacobiSVD<Eigen::MatrixXd> jacobi_svd(
-          -G_block, Eigen::ComputeThinU | Eigen::ComputeThinV);
-
-      const Eigen::MatrixXd prev_Y = Y_.block(0, i * dim_, rank_, dim_).eval();
-      Y_.block(0, i * dim_, rank_, dim_) =
-          jacobi_svd.matrixU() * jacobi_svd.matrixV().transpose();
-
-      const std::vector<size_t>& adjs = adj_edges_[i];
-#pragma omp parallel for num_threads(sdp_solver_options_.num_threads)
-      for (size_t idx = 0; idx < adjs.size(); ++idx) {
-        const size_t j = adjs[idx];
-        G.block(0, j * dim_, rank_, dim_) +=
-            (Y_.block(0, i * dim_, rank_, dim_) - prev_Y) *
-            Q_.block(i * dim_, j * dim_, dim_, dim_);
-      }
+    // Minimize over one block at a time according to Equ.(3). The blocks of
+    // one color are not adjacent, so their G blocks only depend on blocks of
+    // other colors and they are minimized in parallel.
+    for (int c = 0; c < color_classes_.size(); c++) {
+      ParallelForBlocks(
+          color_classes_[c],
+          color_class_partitions_[c],
+          [&](const int partition, const int i) {
+            Eigen::MatrixXd G_block;
+            q_blocks_.LeftMultiplyBlockColumn(Y_, i, i, &G_block);
+            Eigen::JacobiSVD<Eigen::MatrixXd> jacobi_svd(
+                -G_block, Eigen::ComputeThinU | Eigen::ComputeThinV);
+            Y_.block(0, i * dim_, rank_, dim_) =
+                jacobi_svd.matrixU() * jacobi_svd.matrixV().transpose();
+          });
     }
 
     summary.total_iterations_num++;
@@ -142,35 +210,56 @@ const Eigen::MatrixXd& RankRestrictedSDPSolver::GetYStar() const { return Y_; }
 
 const Eigen::MatrixXd RankRestrictedSDPSolver::ComputeQYt(
     const Eigen::MatrixXd& Y) const {
-  return Q_ * Y.transpose();
+  // Q * Y^T = (Y * Q)^T since Q is symmetric.
+  Eigen::MatrixXd QYt(dim_ * n_, Y.rows());
+  ParallelForBlocks(blocks_,
+                    block_partition_,
+                    [&](const int partition, const int i) {
+                      Eigen::MatrixXd YQ_block;
+                      q_blocks_.LeftMultiplyBlockColumn(Y, i, &YQ_block);
+                      QYt.block(i * dim_, 0, dim_, Y.rows()) =
+                          YQ_block.transpose();
+                    });
+  return QYt;
 }
 
 Eigen::MatrixXd RankRestrictedSDPSolver::ComputeLambdaMatrix() const {
-  const Eigen::MatrixXd QYt = this->ComputeQYt(Y_);
-
   const size_t rank = Y_.rows();
   // \Lambda = \SymblockDiag(Q * Y^T * Y).
   Eigen::MatrixXd Lambda = Eigen::MatrixXd::Zero(dim_, n_ * dim_);
 
-#pragma omp parallel for num_threads(sdp_solver_options_.num_threads)
-  for (size_t i = 0; i < n_; ++i) {
-    Eigen::MatrixXd P =
-        QYt.block(i * dim_, 0, dim_, rank) * Y_.block(0, i * dim_, rank, dim_);
-    Lambda.block(0, i * dim_, dim_, dim_) = 0.5 * (P + P.transpose());
-  }
+  ParallelForBlocks(
+      blocks_, block_partition_, [&](const int partition, const int i) {
+        Eigen::MatrixXd YQ_block;
+        q_blocks_.LeftMultiplyBlockColumn(Y_, i, &YQ_block);
+        const Eigen::MatrixXd P =
+            YQ_block.transpose() * Y_.block(0, i * dim_, rank, dim_);
+        Lambda.block(0, i * dim_, dim_, dim_) = 0.5 * (P + P.transpose());
+      });
 
   return Lambda;
 }
 
 double RankRestrictedSDPSolver::EvaluateFuncVal() const {
-  // tr(Q * Y^T * Y) = tr(Y * Q * Y^T)
-  // return (Q_ * Y_.transpose() * Y_).trace();
-  return (Y_ * (Q_ * Y_.transpose())).trace();
+  return EvaluateFuncVal(Y_);
 }
 
 double RankRestrictedSDPSolver::EvaluateFuncVal(
     const Eigen::MatrixXd& Y) const {
-  return (Y * (Q_ * Y.transpose())).trace();
+  // tr(Q * Y^T * Y) = tr(Y * Q * Y^T), which is the sum of the inner products
+  // of the blocks of Y and Y * Q.
+  std::vector<double> partial_sums(block_partition_.size() - 1, 0.0);
+  ParallelForBlocks(blocks_,
+                    block_partition_,
+                    [&](const int partition, const int i) {
+                      Eigen::MatrixXd YQ_block;
+                      q_blocks_.LeftMultiplyBlockColumn(Y, i, &YQ_block);
+                      partial_sums[partition] +=
+                          Y.block(0, i * dim_, Y.rows(), dim_)
+                              .cwiseProduct(YQ_block)
+                              .sum();
+                    });
+  return std::accumulate(partial_sums.begin(), partial_sums.end(), 0.0);
 }
 
 void RankRestrictedSDPSolver::AugmentRank() {
@@ -196,17 +285,18 @@ Eigen::MatrixXd RankRestrictedSDPSolver::Project(
 
   Eigen::MatrixXd P(rank_, dim_ * n_);
 
-#pragma omp parallel for num_threads(sdp_solver_options_.num_threads)
-  for (size_t i = 0; i < n_; ++i) {
-    // Compute the (thin) SVD of the ith block of A
-    Eigen::JacobiSVD<Eigen::MatrixXd> SVD(
-        A.block(0, i * dim_, rank_, dim_),
-        Eigen::ComputeThinU | Eigen::ComputeThinV);
-
-    // Set the ith block of P to the SVD-based projection of the ith block of A
-    P.block(0, i * dim_, rank_, dim_) =
-        SVD.matrixU() * SVD.matrixV().transpose();
-  }
+  ParallelForBlocks(
+      blocks_, block_partition_, [&](const int partition, const int i) {
+        // Compute the (thin) SVD of the ith block of A
+        Eigen::JacobiSVD<Eigen::MatrixXd> SVD(
+            A.block(0, i * dim_, rank_, dim_),
+            Eigen::ComputeThinU | Eigen::ComputeThinV);
+
+        // Set the ith block of P to the SVD-based projection of the ith block
+        // of A
+        P.block(0, i * dim_, rank_, dim_) =
+            SVD.matrixU() * SVD.matrixV().transpose();
+      });
   return P;
 }
 
@@ -219,7 +309,7 @@ Eigen::MatrixXd RankRestrictedSDPSolver::Retract(
 
 Eigen::MatrixXd RankRestrictedSDPSolver::EuclideanGradient(
     const Eigen::MatrixXd& Y) const {
-  return 2.0 * (Q_ * Y.transpose()).transpose();
+  return 2.0 * ComputeQYt(Y).transpose();
 }
 
 Eigen::MatrixXd RankRestrictedSDPSolver::RiemannianGradient(
@@ -244,16 +334,17 @@ Eigen::MatrixXd RankRestrictedSDPSolver::SymBlockDiagProduct(
   // Preallocate result matrix
   Eigen::MatrixXd R(rank_, dim_ * n_);
 
-#pragma omp parallel for num_threads(sdp_solver_options_.num_threads)
-  for (size_t i = 0; i < n_; ++i) {
-    // Compute block product Bi' * Ci.
-    Eigen::MatrixXd P = B.block(0, i * dim_, rank_, dim_).transpose() *
-                        C.block(0, i * dim_, rank_, dim_);
-    // Symmetrize this block.
-    Eigen::MatrixXd S = 0.5 * (P + P.transpose());
-    // Compute Ai * S and set corresponding block of R.
-    R.block(0, i * dim_, rank_, dim_) = A.block(0, i * dim_, rank_, dim_) * S;
-  }
+  ParallelForBlocks(
+      blocks_, block_partition_, [&](const int partition, const int i) {
+        // Compute block product Bi' * Ci.
+        Eigen::MatrixXd P = B.block(0, i * dim_, rank_, dim_).transpose() *
+                            C.block(0, i * dim_, rank_, dim_);
+        // Symmetrize this block.
+        Eigen::MatrixXd S = 0.5 * (P + P.transpose());
+        // Compute Ai * S and set corresponding block of R.
+        R.block(0, i * dim_, rank_, dim_) =
+            A.block(0, i * dim_, rank_, dim_) * S;
+      });
   return R;
 }
 
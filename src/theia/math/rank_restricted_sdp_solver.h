@@ -35,15 +35,21 @@
 #ifndef THEIA_MATH_RANK_RESTRICTED_SDP_SOLVER_H_
 #define THEIA_MATH_RANK_RESTRICTED_SDP_SOLVER_H_
 
+#include <functional>
+#include <memory>
 #include <unordered_map>
+#include <vector>
 
 #include <Eigen/Core>
 #include <Eigen/SVD>
 
 #include "theia/math/bcm_sdp_solver.h"
+#include "theia/math/matrix/block_sparse_matrix.h"
 #include "theia/math/sdp_solver.h"
 
 namespace theia {
+class ThreadPool;
+
 namespace math {
 // This algorithm has superior efficiency than the normal BCMSDPSolver in large
 // scale SDP optimization problems. Instead of solving the original SDP problem:
@@ -60,6 +66,11 @@ namespace math {
 // where St(d,r)^n = {Y = [Y1 Y2 ... Yn] \in R^{rxdn}: Yi \in St(d,r)},
 // and the Stiefel manifold St(d,r) = {Y \in R^{rxd}: Y^TY=I_d}
 //
+// Q is stored as a block-sparse matrix of its nonzero (edge) blocks, so all
+// products with Q cost O(r * d^2) per edge. The blocks are colored such that
+// no two adjacent blocks share a color. Blocks of the same color do not
+// depend on each other and are updated in parallel, split across the threads
+// by their degree.
 class RankRestrictedSDPSolver : public BCMSDPSolver {
  public:
   RankRestrictedSDPSolver(const size_t n, const size_t block_dim);
@@ -68,6 +79,10 @@ class RankRestrictedSDPSolver : public BCMSDPSolver {
                           const size_t block_dim,
                           const math::SDPSolverOptions& options);
 
+  ~RankRestrictedSDPSolver() override;
+
+  void SetCovariance(const Eigen::SparseMatrix<double>& Q) override;
+
   void Solve(math::Summary& summary) override;
 
   Eigen::MatrixXd GetSolution() const override;
@@ -104,10 +119,33 @@ class RankRestrictedSDPSolver : public BCMSDPSolver {
                                const Eigen::MatrixXd& dotY) const;
 
  private:
+  // Extracts the nonzero blocks of Q_ and colors them.
+  void SetupBlockSparseCovariance();
+
+  // Calls function(partition, i) for each block i of the given blocks, where
+  // the blocks of each partition run on the same thread.
+  void ParallelForBlocks(
+      const std::vector<int>& blocks,
+      const std::vector<int>& partition_boundaries,
+      const std::function<void(const int, const int)>& function) const;
+
   // The rank-deficient first-order critical point
   // with row-block size is rank_*dim_.
   Eigen::MatrixXd Y_;
 
+  // The nonzero blocks of Q_.
+  BlockSparseMatrix q_blocks_;
+
+  // All blocks and the blocks of each color, with their partitions into
+  // ranges of similar total degree for the threads.
+  std::vector<int> blocks_;
+  std::vector<int> block_partition_;
+  std::vector<std::vector<int>> color_classes_;
+  std::vector<std::vector<int>> color_class_partitions_;
+
+  int num_threads_;
+  std::unique_ptr<ThreadPool> thread_pool_;
+
   // initial rank of Y_.
   size_t rank_;
 };
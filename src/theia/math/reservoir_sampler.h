@@ -52,8 +52,6 @@ namespace theia {
 template <typename ElementType>
 class ReservoirSampler {
  public:
-  // TODO(sweeneychris): Add a constructor to set the RNG or the seed.
-
   // The number of elements we would like to sample from the entire sequence.
   explicit ReservoirSampler(const int num_elements_to_sample)
       : num_elements_to_sample_(num_elements_to_sample),
@@ -61,27 +59,50 @@ class ReservoirSampler {
     randomly_sampled_elements_.reserve(num_elements_to_sample_);
   }
 
+  // Same as above, but the random choices are made with the given seed so that
+  // the samples are reproducible.
+  ReservoirSampler(const int num_elements_to_sample, const unsigned seed)
+      : num_elements_to_sample_(num_elements_to_sample),
+        num_elements_added_(0),
+        rng_(seed, 0) {
+    randomly_sampled_elements_.reserve(num_elements_to_sample_);
+  }
+
+  // Counts one more element of the sequence and returns the index of the sample
+  // it replaces, or -1 if the element is not sampled. The indices of the first
+  // K elements are 0, ..., K - 1. This lets callers keep the samples in their
+  // own storage (e.g. the columns of a matrix) instead of in the sampler.
+  int NextSampleIndex() {
+    // If we do not have enough samples yet, add the element to the sampling
+    // with probabiliy of 1.
+    if (num_elements_added_ < num_elements_to_sample_) {
+      return num_elements_added_++;
+    }
+
+    // Otherwise, we want to add the new element to our sampling with if
+    //   Rand(0.0, 1.0) < K / i.
+    // This is equivalent to evaluating the probability that Random(0, N) < K
+    // where N is the number of elements added so far, but this version avoids
+    // costly division operators for each sample.
+    const int modified_sample_probability =
+        rng_.RandInt(0, num_elements_added_);
+    ++num_elements_added_;
+    return modified_sample_probability < num_elements_to_sample_
+               ? modified_sample_probability
+               : -1;
+  }
+
   // Add a single element to the sampler. The element will be retained (i.e.
   // will be considered a part of the random K samples) with probability K / i,
   // where i is the # of elements added to the sampler so far.
   void AddElementToSampler(const ElementType& element) {
-    // If we do not have enough samples yet, add the element to the sampling
-    // with probabiliy of 1.
-    if (num_elements_added_ < num_elements_to_sample_) {
+    const int sample_index = NextSampleIndex();
+    if (sample_index ==
+        static_cast<int>(randomly_sampled_elements_.size())) {
       randomly_sampled_elements_.push_back(element);
-    } else {
-      // Otherwise, we want to add the new element to our sampling with if
-      //   Rand(0.0, 1.0) < K / i.
-      // This is equivalent to evaluating the probability that Random(0, N) < K
-      // where N is the number of elements added so far, but this version avoids
-      // costly division operators for each sample.
-      const int modified_sample_probability =
-          rng_.RandInt(0, num_elements_added_);
-      if (modified_sample_probability < num_elements_to_sample_) {
-        randomly_sampled_elements_[modified_sample_probability] = element;
-      }
+    } else if (sample_index >= 0) {
+      randomly_sampled_elements_[sample_index] = element;
     }
-    ++num_elements_added_;
   }
 
   // Returns all of the samples
@@ -35,6 +35,7 @@
 #include <glog/logging.h>
 #include <gtest/gtest.h>
 #include <set>
+#include <vector>
 
 #include "theia/math/reservoir_sampler.h"
 #include "theia/util/random.h"
@@ -64,4 +65,28 @@ TEST(ReservoirSampler, Sanity) {
   LOG(INFO) << "Num unique random samples: " << rand_samples.size();
 }
 
+TEST(ReservoirSampler, SampleIndicesAreReproducible) {
+  constexpr int kNumElements = 10000;
+  constexpr int kNumSampledElements = 100;
+  ReservoirSampler<int> sampler1(kNumSampledElements, 13);
+  ReservoirSampler<int> sampler2(kNumSampledElements, 13);
+
+  std::vector<int> samples(kNumSampledElements, -1);
+  for (int i = 0; i < kNumElements; i++) {
+    const int sample_index = sampler1.NextSampleIndex();
+    if (i < kNumSampledElements) {
+      EXPECT_EQ(sample_index, i);
+    }
+    ASSERT_LT(sample_index, kNumSampledElements);
+    if (sample_index >= 0) {
+      samples[sample_index] = i;
+    }
+    sampler2.AddElementToSampler(i);
+  }
+
+  EXPECT_EQ(sampler1.NumElementsAdded(), kNumElements);
+  EXPECT_EQ(sampler2.NumElementsAdded(), kNumElements);
+  EXPECT_EQ(samples, sampler2.GetAllSamples());
+}
+
 }  // namespace theia
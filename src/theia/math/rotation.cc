@@ -44,6 +44,7 @@
 #include <Eigen/Geometry>
 #include <glog/logging.h>
 #include <limits>
+#include <vector>
 
 #include "theia/math/util.h"
 #include "theia/util/map_util.h"
@@ -102,6 +103,47 @@ struct RotationAlignmentError {
   Eigen::Matrix3d unaligned_rotation_mat_;
 };
 
+typedef Eigen::Array<double, 1, Eigen::Dynamic> RowArray;
+
+// The row of entry (row, col) of the rotation matrices in a
+// RotationMatrixBatch.
+inline int EntryIndex(const int row, const int col) { return 3 * col + row; }
+
+// Computes c_n = a_n * b_n, or c_n = a_n * b_n^t if transpose_b is true, for
+// all rotation matrices of the batches.
+void MultiplyRotationMatrixBatches(const theia::RotationMatrixBatch& a,
+                                   const theia::RotationMatrixBatch& b,
+                                   const bool transpose_b,
+                                   theia::RotationMatrixBatch* c) {
+  CHECK_EQ(a.cols(), b.cols());
+  c->resize(9, a.cols());
+  for (int col = 0; col < 3; col++) {
+    for (int row = 0; row < 3; row++) {
+      auto entry = c->row(EntryIndex(row, col)).array();
+      for (int k = 0; k < 3; k++) {
+        const auto a_entry = a.row(EntryIndex(row, k)).array();
+        const auto b_entry =
+            b.row(transpose_b ? EntryIndex(col, k) : EntryIndex(k, col))
+                .array();
+        if (k == 0) {
+          entry = a_entry * b_entry;
+        } else {
+          entry += a_entry * b_entry;
+        }
+      }
+    }
+  }
+}
+
+theia::AngleAxisBatch ToAngleAxisBatch(
+    const std::vector<Eigen::Vector3d>& rotations) {
+  theia::AngleAxisBatch batch(3, rotations.size());
+  for (int i = 0; i < rotations.size(); i++) {
+    batch.col(i) = rotations[i];
+  }
+  return batch;
+}
+
 // Apply the rotation alignment to all rotations in the vector.
 void ApplyRotationTransformation(const Eigen::Vector3d& rotation_alignment,
                                  std::vector<Eigen::Vector3d>* rotation) {
@@ -110,21 +152,29 @@ void ApplyRotationTransformation(const Eigen::Vector3d& rotation_alignment,
       rotation_alignment.data(),
       ceres::ColumnMajorAdapter3x3(rotation_alignment_mat.data()));
 
-  for (size_t i = 0; i < rotation->size(); i++) {
-    // Convert the current rotation to a rotation matrix.
-    Eigen::Matrix3d rotation_mat;
-    ceres::AngleAxisToRotationMatrix(
-        rotation->at(i).data(),
-        ceres::ColumnMajorAdapter3x3(rotation_mat.data()));
-
-    // Apply the rotation transformation.
-    const Eigen::Matrix3d aligned_rotation =
-        rotation_mat * rotation_alignment_mat;
+  // Apply the rotation transformation to all rotations as a batch.
+  theia::RotationMatrixBatch rotation_mats;
+  theia::AngleAxisToRotationMatrices(ToAngleAxisBatch(*rotation),
+                                     &rotation_mats);
+  theia::RotationMatrixBatch aligned_rotation_mats(9, rotation_mats.cols());
+  for (int col = 0; col < 3; col++) {
+    for (int row = 0; row < 3; row++) {
+      aligned_rotation_mats.row(EntryIndex(row, col)) =
+          rotation_mats.row(EntryIndex(row, 0)) *
+              rotation_alignment_mat(0, col) +
+          rotation_mats.row(EntryIndex(row, 1)) *
+              rotation_alignment_mat(1, col) +
+          rotation_mats.row(EntryIndex(row, 2)) *
+              rotation_alignment_mat(2, col);
+    }
+  }
 
-    // Convert back to angle axis.
-    ceres::RotationMatrixToAngleAxis(
-        ceres::ColumnMajorAdapter3x3(aligned_rotation.data()),
-        rotation->at(i).data());
+  // Convert back to angle axis.
+  theia::AngleAxisBatch aligned_rotations;
+  theia::RotationMatricesToAngleAxis(aligned_rotation_mats,
+                                     &aligned_rotations);
+  for (int i = 0; i < rotation->size(); i++) {
+    (*rotation)[i] = aligned_rotations.col(i);
   }
 }
 
@@ -147,6 +197,124 @@ Eigen::Vector3d MultiplyRotations(const Eigen::Vector3d& rotation1,
   return rotation_aa;
 }
 
+void RelativeRotationErrors(const int num_edges,
+                            const Eigen::Matrix3d* relative_rotations,
+                            const int* rotation_indices,
+                            const Eigen::Matrix3d* rotations,
+                            double* errors) {
+  for (int e = 0; e < num_edges; e++) {
+    const Eigen::Matrix3d& rotation1 = rotations[rotation_indices[2 * e]];
+    const Eigen::Matrix3d& rotation2 = rotations[rotation_indices[2 * e + 1]];
+    const Eigen::AngleAxisd error(
+        rotation2.transpose() * (relative_rotations[e] * rotation1));
+    Eigen::Map<Eigen::Vector3d>(errors + 3 * e) = error.angle() * error.axis();
+  }
+}
+
+void AngleAxisToRotationMatrices(const AngleAxisBatch& angle_axis,
+                                 RotationMatrixBatch* rotation_matrices) {
+  CHECK_NOTNULL(rotation_matrices)->resize(9, angle_axis.cols());
+  const auto x = angle_axis.row(0).array();
+  const auto y = angle_axis.row(1).array();
+  const auto z = angle_axis.row(2).array();
+  const RowArray theta_sq = x.square() + y.square() + z.square();
+  const RowArray theta = theta_sq.sqrt();
+
+  // R = I + a * [w]_x + b * [w]_x^2 with a = sin(theta) / theta and
+  // b = (1 - cos(theta)) / theta^2, which is computed from the half angle to
+  // avoid cancellation. Their limits at theta = 0 are 1 and 1/2.
+  const auto is_nonzero = theta_sq > std::numeric_limits<double>::min();
+  const RowArray a = is_nonzero.select(theta.sin() / theta, 1.0);
+  const RowArray b = is_nonzero.select(
+      2.0 * (0.5 * theta).sin().square() / theta_sq, 0.5);
+
+  auto R = [&](const int row, const int col) {
+    return rotation_matrices->row(EntryIndex(row, col)).array();
+  };
+  R(0, 0) = 1.0 - b * (y.square() + z.square());
+  R(1, 0) = a * z + b * x * y;
+  R(2, 0) = -a * y + b * x * z;
+  R(0, 1) = -a * z + b * x * y;
+  R(1, 1) = 1.0 - b * (x.square() + z.square());
+  R(2, 1) = a * x + b * y * z;
+  R(0, 2) = a * y + b * x * z;
+  R(1, 2) = -a * x + b * y * z;
+  R(2, 2) = 1.0 - b * (x.square() + y.square());
+}
+
+void RotationMatricesToAngleAxis(const RotationMatrixBatch& rotation_matrices,
+                                 AngleAxisBatch* angle_axis) {
+  // Below this sine of the angle, rotations by more than pi / 2 are converted
+  // through quaternions.
+  static const double kMinSinThetaNearPi = 1e-3;
+
+  const int num_rotations = rotation_matrices.cols();
+  CHECK_NOTNULL(angle_axis)->resize(3, num_rotations);
+  auto R = [&](const int row, const int col) {
+    return rotation_matrices.row(EntryIndex(row, col)).array();
+  };
+
+  // The antisymmetric part of R is sin(theta) * [axis]_x and its trace is
+  // 1 + 2 * cos(theta).
+  angle_axis->row(0).array() = 0.5 * (R(2, 1) - R(1, 2));
+  angle_axis->row(1).array() = 0.5 * (R(0, 2) - R(2, 0));
+  angle_axis->row(2).array() = 0.5 * (R(1, 0) - R(0, 1));
+  const RowArray sin_theta = (angle_axis->row(0).array().square() +
+                              angle_axis->row(1).array().square() +
+                              angle_axis->row(2).array().square())
+                                 .sqrt();
+  const RowArray cos_theta =
+      (0.5 * (R(0, 0) + R(1, 1) + R(2, 2) - 1.0)).max(-1.0).min(1.0);
+
+  // The half angle formula is accurate for all angles but those close to pi.
+  const RowArray theta = 2.0 * (sin_theta / (1.0 + cos_theta)).atan();
+  const RowArray scale = (sin_theta > 0.0).select(theta / sin_theta, 1.0);
+  for (int i = 0; i < 3; i++) {
+    angle_axis->row(i).array() *= scale;
+  }
+
+  // Close to pi the antisymmetric part does not determine the axis
+  // accurately. These rotations are rare and are converted one by one.
+  for (int i = 0; i < num_rotations; i++) {
+    if (cos_theta[i] >= 0.0 || sin_theta[i] >= kMinSinThetaNearPi) {
+      continue;
+    }
+    Eigen::Matrix3d rotation_matrix;
+    for (int col = 0; col < 3; col++) {
+      for (int row = 0; row < 3; row++) {
+        rotation_matrix(row, col) = rotation_matrices(EntryIndex(row, col), i);
+      }
+    }
+    const Eigen::AngleAxisd rotation(rotation_matrix);
+    angle_axis->col(i) = rotation.angle() * rotation.axis();
+  }
+}
+
+void MultiplyRotations(const AngleAxisBatch& rotations1,
+                       const AngleAxisBatch& rotations2,
+                       AngleAxisBatch* rotations) {
+  CHECK_EQ(rotations1.cols(), rotations2.cols());
+  RotationMatrixBatch rotation_mats1, rotation_mats2, rotation_mats;
+  AngleAxisToRotationMatrices(rotations1, &rotation_mats1);
+  AngleAxisToRotationMatrices(rotations2, &rotation_mats2);
+  MultiplyRotationMatrixBatches(
+      rotation_mats1, rotation_mats2, false, &rotation_mats);
+  RotationMatricesToAngleAxis(rotation_mats, CHECK_NOTNULL(rotations));
+}
+
+void RelativeRotationsFromTwoRotations(const AngleAxisBatch& rotations1,
+                                       const AngleAxisBatch& rotations2,
+                                       AngleAxisBatch* relative_rotations) {
+  CHECK_EQ(rotations1.cols(), rotations2.cols());
+  RotationMatrixBatch rotation_mats1, rotation_mats2, relative_rotation_mats;
+  AngleAxisToRotationMatrices(rotations1, &rotation_mats1);
+  AngleAxisToRotationMatrices(rotations2, &rotation_mats2);
+  MultiplyRotationMatrixBatches(
+      rotation_mats2, rotation_mats1, true, &relative_rotation_mats);
+  RotationMatricesToAngleAxis(relative_rotation_mats,
+                              CHECK_NOTNULL(relative_rotations));
+}
+
 Eigen::Vector3d RelativeTranslationFromTwoPositions(
     const Eigen::Vector3d& position1,
     const Eigen::Vector3d& position2,
@@ -166,8 +334,31 @@ Eigen::Vector3d RelativeTranslationFromTwoPositions(
 void AlignRotations(const std::vector<Eigen::Vector3d>& gt_rotation,
                     std::vector<Eigen::Vector3d>* rotation) {
   CHECK_EQ(gt_rotation.size(), rotation->size());
+  if (rotation->empty()) {
+    return;
+  }
 
-  Eigen::Vector3d rotation_alignment = Eigen::Vector3d::Zero();
+  // Initialize the alignment with the rotation R that minimizes the chordal
+  // distance sum_i || R_i * R - R_gt_i ||_F^2, which is the projection of
+  // sum_i R_i^t * R_gt_i onto SO(3).
+  RotationMatrixBatch rotation_mats, gt_rotation_mats;
+  AngleAxisToRotationMatrices(ToAngleAxisBatch(*rotation), &rotation_mats);
+  AngleAxisToRotationMatrices(ToAngleAxisBatch(gt_rotation),
+                              &gt_rotation_mats);
+  Eigen::MatrixXd correlation = Eigen::MatrixXd::Zero(3, 3);
+  for (int col = 0; col < 3; col++) {
+    for (int row = 0; row < 3; row++) {
+      for (int k = 0; k < 3; k++) {
+        correlation(row, col) +=
+            rotation_mats.row(EntryIndex(k, row))
+                .dot(gt_rotation_mats.row(EntryIndex(k, col)));
+      }
+    }
+  }
+  const Eigen::Matrix3d initial_alignment = ProjectToSOd(correlation);
+  const Eigen::AngleAxisd initial_alignment_aa(initial_alignment);
+  Eigen::Vector3d rotation_alignment =
+      initial_alignment_aa.angle() * initial_alignment_aa.axis();
 
   // Set up the nonlinear system and adds all residuals.
   ceres::Problem problem;
@@ -85,6 +85,47 @@ Eigen::Vector3d RelativeTranslationFromTwoPositions(
     const Eigen::Vector3d& position1,
     const Eigen::Vector3d& position2,
     const Eigen::Vector3d& rotation1);
+
+// Computes the angle-axis errors R_err = R_j^t * R_ij * R_i of a batch of
+// relative rotations stored in contiguous arrays. relative_rotations holds R_ij
+// of each edge, rotation_indices holds the indices i and j of each edge into
+// rotations, and the error of edge e is written to errors[3 * e]. Working on
+// rotation matrices costs two 3x3 products and one conversion to angle-axis
+// per edge. Disjoint ranges of edges may be computed in parallel.
+void RelativeRotationErrors(const int num_edges,
+                            const Eigen::Matrix3d* relative_rotations,
+                            const int* rotation_indices,
+                            const Eigen::Matrix3d* rotations,
+                            double* errors);
+
+// Batched rotation kernels. A batch stores its rotations as a structure of
+// arrays, i.e., each component of all rotations is contiguous, so that the
+// kernels run as vectorized array operations: N angle-axis rotations are the
+// columns of a 3 x N row-major matrix, and N rotation matrices are the columns
+// of a 9 x N row-major matrix, with the entries of each rotation matrix in
+// column-major order.
+typedef Eigen::Matrix<double, 3, Eigen::Dynamic, Eigen::RowMajor>
+    AngleAxisBatch;
+typedef Eigen::Matrix<double, 9, Eigen::Dynamic, Eigen::RowMajor>
+    RotationMatrixBatch;
+
+// Converts angle-axis rotations to rotation matrices with Rodrigues' formula.
+void AngleAxisToRotationMatrices(const AngleAxisBatch& angle_axis,
+                                 RotationMatrixBatch* rotation_matrices);
+
+// Converts rotation matrices to angle-axis rotations with angles in [0, pi].
+void RotationMatricesToAngleAxis(const RotationMatrixBatch& rotation_matrices,
+                                 AngleAxisBatch* angle_axis);
+
+// Computes R_n = R1_n * R2_n for all rotations of the batches.
+void MultiplyRotations(const AngleAxisBatch& rotations1,
+                       const AngleAxisBatch& rotations2,
+                       AngleAxisBatch* rotations);
+
+// Computes R_ij = R_j * R_i^t for all rotations of the batches.
+void RelativeRotationsFromTwoRotations(const AngleAxisBatch& rotations1,
+                                       const AngleAxisBatch& rotations2,
+                                       AngleAxisBatch* relative_rotations);
 }  // namespace theia
 
 #endif  // THEIA_MATH_ROTATION_H_
@@ -35,11 +35,13 @@
 #include <Eigen/Core>
 #include <Eigen/Geometry>
 #include <ceres/rotation.h>
+#include <vector>
 
 #include "gtest/gtest.h"
 
 #include "theia/math/rotation.h"
 #include "theia/math/util.h"
+#include "theia/util/random.h"
 
 namespace theia {
 
@@ -113,4 +115,181 @@ TEST(MultiplyRotations, DifficultRotatations) {
   const Eigen::Vector3d rotation2(0.0158538, -2.07541, 0.356276);
   TestTwoRotations(rotation1, rotation2, kToleranceDegrees);
 }
+
+TEST(RelativeRotationErrors, MatchesComposedRotations) {
+  static const double kTolerance = 1e-12;
+  static const int kNumRotations = 10;
+  static const int kNumEdges = 30;
+  RandomNumberGenerator rng(49);
+
+  std::vector<Eigen::Vector3d> rotations(kNumRotations);
+  std::vector<Eigen::Matrix3d> rotation_matrices(kNumRotations);
+  for (int i = 0; i < kNumRotations; i++) {
+    rng.SetRandom(&rotations[i]);
+    ceres::AngleAxisToRotationMatrix(
+        rotations[i].data(),
+        ceres::ColumnMajorAdapter3x3(rotation_matrices[i].data()));
+  }
+
+  // Half of the relative rotations are exact and the others are perturbed.
+  std::vector<Eigen::Matrix3d> relative_rotations(kNumEdges);
+  std::vector<int> rotation_indices(2 * kNumEdges);
+  for (int e = 0; e < kNumEdges; e++) {
+    rotation_indices[2 * e] = e % kNumRotations;
+    rotation_indices[2 * e + 1] = (e + 1 + e / kNumRotations) % kNumRotations;
+    relative_rotations[e] =
+        rotation_matrices[rotation_indices[2 * e + 1]] *
+        rotation_matrices[rotation_indices[2 * e]].transpose();
+    if (e % 2 == 1) {
+      Eigen::Vector3d noise;
+      rng.SetRandom(&noise);
+      relative_rotations[e] *=
+          Eigen::AngleAxisd(noise.norm(), noise.normalized()).matrix();
+    }
+  }
+
+  std::vector<double> errors(3 * kNumEdges);
+  RelativeRotationErrors(kNumEdges,
+                         relative_rotations.data(),
+                         rotation_indices.data(),
+                         rotation_matrices.data(),
+                         errors.data());
+
+  for (int e = 0; e < kNumEdges; e++) {
+    const Eigen::Vector3d error(errors.data() + 3 * e);
+    if (e % 2 == 0) {
+      EXPECT_LT(error.norm(), kTolerance);
+      continue;
+    }
+    Eigen::Matrix3d error_matrix;
+    ceres::AngleAxisToRotationMatrix(
+        error.data(), ceres::ColumnMajorAdapter3x3(error_matrix.data()));
+    const Eigen::Matrix3d expected_error_matrix =
+        rotation_matrices[rotation_indices[2 * e + 1]].transpose() *
+        relative_rotations[e] * rotation_matrices[rotation_indices[2 * e]];
+    EXPECT_LT((error_matrix - expected_error_matrix).norm(), kTolerance);
+  }
+}
+
+// Angle-axis rotations with small, large, zero and near pi angles.
+AngleAxisBatch TestRotationBatch(const int num_random_rotations) {
+  RandomNumberGenerator rng(50);
+  AngleAxisBatch rotations(3, num_random_rotations + 5);
+  for (int i = 0; i < num_random_rotations; i++) {
+    Eigen::Vector3d axis;
+    rng.SetRandom(&axis);
+    rotations.col(i) = rng.RandDouble(0.0, M_PI) * axis.normalized();
+  }
+  rotations.col(num_random_rotations) = Eigen::Vector3d::Zero();
+  rotations.col(num_random_rotations + 1) = Eigen::Vector3d(1e-12, 4e-10, 0);
+  rotations.col(num_random_rotations + 2) = Eigen::Vector3d(M_PI, 0, 0);
+  rotations.col(num_random_rotations + 3) =
+      (M_PI - 1e-7) * Eigen::Vector3d(1, 2, 3).normalized();
+  rotations.col(num_random_rotations + 4) =
+      (M_PI - 1e-3) * Eigen::Vector3d(-1, 1, 1).normalized();
+  return rotations;
+}
+
+Eigen::Matrix3d RotationMatrixOfBatch(const RotationMatrixBatch& batch,
+                                      const int i) {
+  Eigen::Matrix3d rotation;
+  for (int col = 0; col < 3; col++) {
+    for (int row = 0; row < 3; row++) {
+      rotation(row, col) = batch(3 * col + row, i);
+    }
+  }
+  return rotation;
+}
+
+Eigen::Matrix3d RotationMatrixOfAngleAxis(const Eigen::Vector3d& angle_axis) {
+  Eigen::Matrix3d rotation;
+  ceres::AngleAxisToRotationMatrix(
+      angle_axis.data(), ceres::ColumnMajorAdapter3x3(rotation.data()));
+  return rotation;
+}
+
+TEST(RotationBatch, AngleAxisToRotationMatrices) {
+  static const double kTolerance = 1e-14;
+  const AngleAxisBatch rotations = TestRotationBatch(100);
+  RotationMatrixBatch rotation_matrices;
+  AngleAxisToRotationMatrices(rotations, &rotation_matrices);
+  ASSERT_EQ(rotation_matrices.cols(), rotations.cols());
+  for (int i = 0; i < rotations.cols(); i++) {
+    const Eigen::Matrix3d expected_rotation =
+        RotationMatrixOfAngleAxis(rotations.col(i));
+    EXPECT_LT((RotationMatrixOfBatch(rotation_matrices, i) - expected_rotation)
+                  .norm(),
+              kTolerance);
+  }
+}
+
+TEST(RotationBatch, RotationMatricesToAngleAxis) {
+  static const double kTolerance = 1e-12;
+  const AngleAxisBatch rotations = TestRotationBatch(100);
+  RotationMatrixBatch rotation_matrices;
+  AngleAxisToRotationMatrices(rotations, &rotation_matrices);
+  AngleAxisBatch converted_rotations;
+  RotationMatricesToAngleAxis(rotation_matrices, &converted_rotations);
+  ASSERT_EQ(converted_rotations.cols(), rotations.cols());
+  for (int i = 0; i < rotations.cols(); i++) {
+    // Rotations by pi have two angle-axis representations, so the rotation
+    // matrices are compared.
+    EXPECT_LE(converted_rotations.col(i).norm(), M_PI + kTolerance);
+    EXPECT_LT((RotationMatrixOfAngleAxis(converted_rotations.col(i)) -
+               RotationMatrixOfBatch(rotation_matrices, i))
+                  .norm(),
+              kTolerance);
+  }
+  EXPECT_LT((converted_rotations.leftCols(100) - rotations.leftCols(100))
+                .cwiseAbs()
+                .maxCoeff(),
+            kTolerance);
+}
+
+TEST(RotationBatch, MultiplyAndRelativeRotations) {
+  static const double kTolerance = 1e-12;
+  const AngleAxisBatch rotations1 = TestRotationBatch(50);
+  const AngleAxisBatch rotations2 = rotations1.rowwise().reverse();
+  AngleAxisBatch products, relative_rotations;
+  MultiplyRotations(rotations1, rotations2, &products);
+  RelativeRotationsFromTwoRotations(
+      rotations1, rotations2, &relative_rotations);
+  for (int i = 0; i < rotations1.cols(); i++) {
+    const Eigen::Matrix3d rotation1 =
+        RotationMatrixOfAngleAxis(rotations1.col(i));
+    const Eigen::Matrix3d rotation2 =
+        RotationMatrixOfAngleAxis(rotations2.col(i));
+    EXPECT_LT((RotationMatrixOfAngleAxis(products.col(i)) -
+               rotation1 * rotation2)
+                  .norm(),
+              kTolerance);
+    EXPECT_LT((RotationMatrixOfAngleAxis(relative_rotations.col(i)) -
+               rotation2 * rotation1.transpose())
+                  .norm(),
+              kTolerance);
+  }
+}
+
+TEST(AlignRotations, RecoversAlignment) {
+  static const double kTolerance = 1e-10;
+  const AngleAxisBatch batch = TestRotationBatch(20);
+  const Eigen::Matrix3d alignment =
+      RotationMatrixOfAngleAxis(Eigen::Vector3d(0.3, -0.5, 1.2));
+  std::vector<Eigen::Vector3d> gt_rotations, rotations;
+  for (int i = 0; i < batch.cols(); i++) {
+    gt_rotations.emplace_back(batch.col(i));
+    const Eigen::AngleAxisd rotation(
+        RotationMatrixOfAngleAxis(batch.col(i)) * alignment.transpose());
+    rotations.emplace_back(rotation.angle() * rotation.axis());
+  }
+
+  AlignRotations(gt_rotations, &rotations);
+  for (int i = 0; i < rotations.size(); i++) {
+    EXPECT_LT((RotationMatrixOfAngleAxis(rotations[i]) -
+               RotationMatrixOfAngleAxis(gt_rotations[i]))
+                  .norm(),
+              kTolerance);
+  }
+}
+
 }  // namespace theia
@@ -100,7 +100,9 @@ struct SDPSolverOptions {
     max_iterations = option.max_iterations;
     tolerance = option.tolerance;
     verbose = option.verbose;
+    num_threads = option.num_threads;
     solver_type = option.solver_type;
+    preconditioner_type = option.preconditioner_type;
     riemannian_staircase_options = option.riemannian_staircase_options;
   }
 };
@@ -0,0 +1,357 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+
+#include "theia/sfm/batched_two_view_match_geometric_verification.h"
+
+#include <Eigen/Core>
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <future>
+#include <map>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "theia/matching/keypoints_and_descriptors.h"
+#include "theia/sfm/camera/camera.h"
+#include "theia/sfm/camera_intrinsics_prior.h"
+#include "theia/sfm/estimators/batch_estimators.h"
+#include "theia/sfm/reconstruction_estimator_utils.h"
+#include "theia/solvers/sample_consensus_estimator.h"
+#include "theia/util/random.h"
+#include "theia/util/threadpool.h"
+
+namespace theia {
+namespace {
+
+// The pairs of a batch whose correspondences are normalized the same way and
+// share the inlier threshold, so they are screened by one batched call.
+typedef std::pair<bool, double> ScreeningGroupKey;
+
+// Returns the screening threshold of the pair, with the same scaling as
+// EstimateTwoViewInfo.
+double ScreeningThreshold(const EstimateTwoViewInfoOptions& options,
+                          const CameraIntrinsicsPrior& intrinsics1,
+                          const CameraIntrinsicsPrior& intrinsics2,
+                          const bool calibrated) {
+  const double max_sampson_error_pixels1 =
+      ComputeResolutionScaledThreshold(options.max_sampson_error_pixels,
+                                       intrinsics1.image_width,
+                                       intrinsics1.image_height);
+  const double max_sampson_error_pixels2 =
+      ComputeResolutionScaledThreshold(options.max_sampson_error_pixels,
+                                       intrinsics2.image_width,
+                                       intrinsics2.image_height);
+  const double threshold =
+      max_sampson_error_pixels1 * max_sampson_error_pixels2;
+  if (!calibrated) {
+    return threshold;
+  }
+  return threshold / (intrinsics1.focal_length.value[0] *
+                      intrinsics2.focal_length.value[0]);
+}
+
+// Writes the normalized correspondences of the pair into the rows of the
+// matrix starting at first_row. Correspondences of uncalibrated pairs are only
+// centered at the principal points, as in EstimateTwoViewInfo.
+void NormalizeMatches(const TwoViewMatchesToVerify& pair,
+                      const bool calibrated,
+                      const int first_row,
+                      TwoViewCorrespondenceMatrix* correspondences) {
+  Camera camera1, camera2;
+  camera1.SetFromCameraIntrinsicsPriors(*pair.intrinsics1);
+  camera2.SetFromCameraIntrinsicsPriors(*pair.intrinsics2);
+  if (!calibrated) {
+    camera1.SetFocalLength(1.0);
+    camera2.SetFocalLength(1.0);
+  }
+
+  const std::vector<IndexedFeatureMatch>& matches = *pair.matches;
+  for (int i = 0; i < matches.size(); i++) {
+    const Keypoint& keypoint1 =
+        pair.features1->keypoints[matches[i].feature1_ind];
+    const Keypoint& keypoint2 =
+        pair.features2->keypoints[matches[i].feature2_ind];
+    const Eigen::Vector2d feature1 =
+        camera1
+            .PixelToNormalizedCoordinates(
+                Eigen::Vector2d(keypoint1.x(), keypoint1.y()))
+            .hnormalized();
+    const Eigen::Vector2d feature2 =
+        camera2
+            .PixelToNormalizedCoordinates(
+                Eigen::Vector2d(keypoint2.x(), keypoint2.y()))
+            .hnormalized();
+    correspondences->row(first_row + i) << feature1.x(), feature1.y(),
+        feature2.x(), feature2.y();
+  }
+}
+
+// Screens the pairs [begin, end) with batched RANSAC. The inlier matches of
+// the pairs that pass are stored in inlier_matches and passed is set for them,
+// both indexed by the position of the pair in the batch.
+// Returns the number of screened pairs that were rejected.
+int ScreenBatch(const BatchedGeometricVerificationOptions& options,
+                const std::vector<TwoViewMatchesToVerify>& pairs,
+                const int begin,
+                const int end,
+                std::vector<std::vector<IndexedFeatureMatch> >* inlier_matches,
+                std::vector<char>* passed) {
+  const TwoViewMatchGeometricVerification::Options& verification_options =
+      options.verification_options;
+  const EstimateTwoViewInfoOptions& twoview_info_options =
+      verification_options.estimate_twoview_info_options;
+
+  std::map<ScreeningGroupKey, std::vector<int> > groups;
+  for (int i = begin; i < end; i++) {
+    if (pairs[i].matches->size() <
+        verification_options.min_num_inlier_matches) {
+      continue;
+    }
+    const bool calibrated = pairs[i].intrinsics1->focal_length.is_set &&
+                            pairs[i].intrinsics2->focal_length.is_set;
+    groups[ScreeningGroupKey(calibrated,
+                             ScreeningThreshold(twoview_info_options,
+                                                *pairs[i].intrinsics1,
+                                                *pairs[i].intrinsics2,
+                                                calibrated))]
+        .emplace_back(i);
+  }
+
+  RansacParameters ransac_params;
+  ransac_params.failure_probability =
+      1.0 - twoview_info_options.expected_ransac_confidence;
+  ransac_params.min_iterations = twoview_info_options.min_ransac_iterations;
+  ransac_params.max_iterations = twoview_info_options.max_ransac_iterations;
+  ransac_params.use_mle = twoview_info_options.use_mle;
+
+  int num_rejected = 0;
+  TwoViewCorrespondenceMatrix correspondences;
+  BatchEstimationResult result;
+  for (const auto& group : groups) {
+    const bool calibrated = group.first.first;
+    const std::vector<int>& group_pairs = group.second;
+
+    Eigen::VectorXi offsets(group_pairs.size() + 1);
+    offsets(0) = 0;
+    for (int j = 0; j < group_pairs.size(); j++) {
+      offsets(j + 1) = offsets(j) + pairs[group_pairs[j]].matches->size();
+    }
+    correspondences.resize(offsets(group_pairs.size()), 4);
+    for (int j = 0; j < group_pairs.size(); j++) {
+      NormalizeMatches(
+          pairs[group_pairs[j]], calibrated, offsets(j), &correspondences);
+    }
+
+    // The screening streams follow the streams of the pairs.
+    ransac_params.error_thresh = group.first.second;
+    if (twoview_info_options.rng != nullptr) {
+      ransac_params.rng =
+          twoview_info_options.rng->Split(pairs.size() + group_pairs[0]);
+    }
+    if (calibrated) {
+      EstimateEssentialMatrices(ransac_params,
+                                twoview_info_options.ransac_type,
+                                correspondences,
+                                offsets,
+                                options.num_threads_per_shard,
+                                &result);
+    } else {
+      EstimateFundamentalMatrices(ransac_params,
+                                  twoview_info_options.ransac_type,
+                                  correspondences,
+                                  offsets,
+                                  options.num_threads_per_shard,
+                                  &result);
+    }
+
+    for (int j = 0; j < group_pairs.size(); j++) {
+      const int pair_index = group_pairs[j];
+      if (!result.success(j) ||
+          result.num_inliers(j) < verification_options.min_num_inlier_matches) {
+        ++num_rejected;
+        continue;
+      }
+      const std::vector<IndexedFeatureMatch>& matches =
+          *pairs[pair_index].matches;
+      std::vector<IndexedFeatureMatch>& pair_inlier_matches =
+          (*inlier_matches)[pair_index - begin];
+      pair_inlier_matches.reserve(result.num_inliers(j));
+      for (int k = 0; k < matches.size(); k++) {
+        if (result.inliers(offsets(j) + k)) {
+          pair_inlier_matches.emplace_back(matches[k]);
+        }
+      }
+      (*passed)[pair_index - begin] = true;
+    }
+  }
+  return num_rejected;
+}
+
+// Runs the full verification of the pair and stores the result in the image
+// pair match. Returns true if the pair passed.
+bool VerifyPair(const TwoViewMatchGeometricVerification::Options& options,
+                const int pair_index,
+                const TwoViewMatchesToVerify& pair,
+                const std::vector<IndexedFeatureMatch>& matches,
+                ImagePairMatch* image_pair_match) {
+  TwoViewMatchGeometricVerification::Options pair_options = options;
+  std::shared_ptr<RandomNumberGenerator>& rng =
+      pair_options.estimate_twoview_info_options.rng;
+  if (rng != nullptr) {
+    rng = rng->Split(pair_index);
+  }
+
+  image_pair_match->image1 = pair.features1->image_name;
+  image_pair_match->image2 = pair.features2->image_name;
+  TwoViewMatchGeometricVerification geometric_verification(pair_options,
+                                                           *pair.intrinsics1,
+                                                           *pair.intrinsics2,
+                                                           *pair.features1,
+                                                           *pair.features2,
+                                                           matches);
+  if (!geometric_verification.VerifyMatches(
+          &image_pair_match->correspondences,
+          &image_pair_match->twoview_info)) {
+    image_pair_match->correspondences.clear();
+    image_pair_match->twoview_info = TwoViewInfo();
+    return false;
+  }
+  return true;
+}
+
+}  // namespace
+
+int VerifyTwoViewMatchesInBatches(
+    const BatchedGeometricVerificationOptions& options,
+    const std::vector<TwoViewMatchesToVerify>& pairs,
+    std::vector<ImagePairMatch>* image_pair_matches,
+    std::vector<bool>* success,
+    BatchedGeometricVerificationSummary* summary) {
+  CHECK_NOTNULL(image_pair_matches);
+  CHECK_NOTNULL(success);
+  CHECK_GT(options.batch_size, 0);
+  CHECK_GT(options.num_shards, 0);
+  CHECK_GT(options.num_threads_per_shard, 0);
+  for (const TwoViewMatchesToVerify& pair : pairs) {
+    CHECK_NOTNULL(pair.intrinsics1);
+    CHECK_NOTNULL(pair.intrinsics2);
+    CHECK_NOTNULL(pair.features1);
+    CHECK_NOTNULL(pair.features2);
+    CHECK_NOTNULL(pair.matches);
+  }
+
+  const int num_pairs = pairs.size();
+  const int num_batches = (num_pairs + options.batch_size - 1) /
+                          options.batch_size;
+  image_pair_matches->clear();
+  image_pair_matches->resize(num_pairs);
+
+  // The shards write the flags of different pairs concurrently, which
+  // std::vector<bool> does not allow.
+  std::vector<char> verified(num_pairs, false);
+  std::vector<int> num_rejected_by_screening(options.num_shards, 0);
+  const auto verify_shard = [&](const int shard) {
+    std::unique_ptr<ThreadPool> pool;
+    if (options.num_threads_per_shard > 1) {
+      pool.reset(new ThreadPool(options.num_threads_per_shard));
+    }
+
+    // The screened matches of the pairs of the current batch.
+    std::vector<std::vector<IndexedFeatureMatch> > inlier_matches;
+    std::vector<char> passed;
+    for (int batch = shard; batch < num_batches; batch += options.num_shards) {
+      const int begin = batch * options.batch_size;
+      const int end = std::min(begin + options.batch_size, num_pairs);
+      if (options.screen_putative_matches) {
+        inlier_matches.assign(end - begin, std::vector<IndexedFeatureMatch>());
+        passed.assign(end - begin, false);
+        num_rejected_by_screening[shard] +=
+            ScreenBatch(options, pairs, begin, end, &inlier_matches, &passed);
+      }
+
+      ParallelFor(pool.get(),
+                  end - begin,
+                  options.num_threads_per_shard,
+                  [&](const int start, const int stop) {
+                    for (int i = begin + start; i < begin + stop; i++) {
+                      if (options.screen_putative_matches &&
+                          !passed[i - begin]) {
+                        continue;
+                      }
+                      verified[i] = VerifyPair(
+                          options.verification_options,
+                          i,
+                          pairs[i],
+                          options.screen_putative_matches
+                              ? inlier_matches[i - begin]
+                              : *pairs[i].matches,
+                          &(*image_pair_matches)[i]);
+                    }
+                  });
+    }
+  };
+
+  if (options.num_shards == 1 || num_batches <= 1) {
+    verify_shard(0);
+  } else {
+    ThreadPool shard_pool(std::min(options.num_shards, num_batches));
+    std::vector<std::future<void> > shards;
+    for (int shard = 0; shard < std::min(options.num_shards, num_batches);
+         shard++) {
+      shards.emplace_back(shard_pool.Add(verify_shard, shard));
+    }
+    for (std::future<void>& shard : shards) {
+      shard.get();
+    }
+  }
+
+  success->assign(verified.begin(), verified.end());
+  const int num_verified_pairs =
+      std::count(verified.begin(), verified.end(), true);
+  if (summary != nullptr) {
+    summary->num_pairs = num_pairs;
+    summary->num_batches = num_batches;
+    summary->num_rejected_by_screening = 0;
+    for (const int num_rejected : num_rejected_by_screening) {
+      summary->num_rejected_by_screening += num_rejected;
+    }
+    summary->num_verified_pairs = num_verified_pairs;
+  }
+  return num_verified_pairs;
+}
+
+}  // namespace theia
@@ -0,0 +1,114 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+
+#ifndef THEIA_SFM_BATCHED_TWO_VIEW_MATCH_GEOMETRIC_VERIFICATION_H_
+#define THEIA_SFM_BATCHED_TWO_VIEW_MATCH_GEOMETRIC_VERIFICATION_H_
+
+#include <vector>
+
+#include "theia/matching/image_pair_match.h"
+#include "theia/matching/indexed_feature_match.h"
+#include "theia/sfm/two_view_match_geometric_verification.h"
+
+namespace theia {
+
+struct CameraIntrinsicsPrior;
+struct KeypointsAndDescriptors;
+
+// The putative matches of an image pair to verify. The pointers must stay
+// valid while the pairs are verified.
+struct TwoViewMatchesToVerify {
+  const CameraIntrinsicsPrior* intrinsics1 = nullptr;
+  const CameraIntrinsicsPrior* intrinsics2 = nullptr;
+  const KeypointsAndDescriptors* features1 = nullptr;
+  const KeypointsAndDescriptors* features2 = nullptr;
+  const std::vector<IndexedFeatureMatch>* matches = nullptr;
+};
+
+struct BatchedGeometricVerificationOptions {
+  // The options of the verification of each image pair.
+  TwoViewMatchGeometricVerification::Options verification_options;
+
+  // The image pairs are verified in batches of batch_size consecutive pairs.
+  // The batches are distributed round-robin over num_shards shards that run
+  // concurrently and each verify their batches with num_threads_per_shard
+  // threads, so that at most batch_size * num_shards pairs are in flight.
+  int batch_size = 1024;
+  int num_shards = 1;
+  int num_threads_per_shard = 1;
+
+  // If true, the putative matches of all pairs of a batch are first screened
+  // with one batched RANSAC call: 5-point essential matrices for the pairs
+  // whose views both have a focal length prior and 8-point fundamental
+  // matrices for the other pairs, with the Sampson error threshold of
+  // EstimateTwoViewInfo. Pairs with fewer than min_num_inlier_matches inliers
+  // are rejected, and the full verification of the others only runs on the
+  // inliers of the screening, where RANSAC terminates after few iterations.
+  // The homography inliers of the two view info are counted among these
+  // inliers as well.
+  bool screen_putative_matches = true;
+};
+
+struct BatchedGeometricVerificationSummary {
+  int num_pairs = 0;
+  int num_batches = 0;
+
+  // Pairs that the batched screening rejected.
+  int num_rejected_by_screening = 0;
+
+  // Pairs that passed the verification.
+  int num_verified_pairs = 0;
+};
+
+// Verifies the putative matches of many image pairs, e.g. of all candidate
+// pairs of a dataset, with the batched engine described above. On return,
+// image_pair_matches and success have one entry per pair. The entries of the
+// pairs that passed hold their two view info and inlier correspondences in
+// pixel coordinates, as TwoViewMatchGeometricVerification::VerifyMatches
+// returns them, and the image names of the features. If
+// options.verification_options.estimate_twoview_info_options.rng is set, the
+// pairs use streams split from it by their index, so the results do not depend
+// on the number of shards or threads. The summary may be null. Returns the
+// number of verified pairs.
+int VerifyTwoViewMatchesInBatches(
+    const BatchedGeometricVerificationOptions& options,
+    const std::vector<TwoViewMatchesToVerify>& pairs,
+    std::vector<ImagePairMatch>* image_pair_matches,
+    std::vector<bool>* success,
+    BatchedGeometricVerificationSummary* summary);
+
+}  // namespace theia
+
+#endif  // THEIA_SFM_BATCHED_TWO_VIEW_MATCH_GEOMETRIC_VERIFICATION_H_
@@ -0,0 +1,243 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+
+#include <Eigen/Core>
+#include <Eigen/Geometry>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "theia/matching/keypoints_and_descriptors.h"
+#include "theia/sfm/batched_two_view_match_geometric_verification.h"
+#include "theia/sfm/camera_intrinsics_prior.h"
+#include "theia/util/random.h"
+
+namespace theia {
+namespace {
+
+using Eigen::AngleAxisd;
+using Eigen::Vector2d;
+using Eigen::Vector3d;
+
+static const int kNumMatches = 200;
+static const int kNumOutliers = 40;
+static const double kFocalLength = 800.0;
+static const double kImageSize = 1000.0;
+
+// The inputs of the pairs, which must outlive the verification.
+struct Pairs {
+  std::vector<CameraIntrinsicsPrior> intrinsics;
+  std::vector<KeypointsAndDescriptors> features;
+  std::vector<std::vector<IndexedFeatureMatch> > matches;
+  std::vector<TwoViewMatchesToVerify> pairs;
+};
+
+CameraIntrinsicsPrior Intrinsics(const bool calibrated) {
+  CameraIntrinsicsPrior intrinsics;
+  intrinsics.image_width = kImageSize;
+  intrinsics.image_height = kImageSize;
+  intrinsics.principal_point.is_set = true;
+  intrinsics.principal_point.value[0] = kImageSize / 2.0;
+  intrinsics.principal_point.value[1] = kImageSize / 2.0;
+  intrinsics.focal_length.is_set = calibrated;
+  intrinsics.focal_length.value[0] = kFocalLength;
+  return intrinsics;
+}
+
+Vector2d Project(const Vector3d& point) {
+  return kFocalLength * point.hnormalized() +
+         Vector2d(kImageSize / 2.0, kImageSize / 2.0);
+}
+
+// Adds the features of two views of random points. The last kNumOutliers
+// matches of a geometrically valid pair are outliers, and all matches of an
+// invalid pair are random.
+void AddPair(const bool calibrated,
+             const bool valid,
+             RandomNumberGenerator* rng,
+             Pairs* pairs) {
+  const int index = pairs->matches.size();
+  KeypointsAndDescriptors features1, features2;
+  features1.image_name = std::to_string(2 * index) + ".jpg";
+  features2.image_name = std::to_string(2 * index + 1) + ".jpg";
+  const Eigen::Matrix3d rotation =
+      AngleAxisd(rng->RandDouble(-0.2, 0.2), Vector3d::UnitY())
+          .toRotationMatrix();
+  const Vector3d translation(1.0, rng->RandDouble(-0.2, 0.2), 0.1);
+
+  std::vector<IndexedFeatureMatch> matches;
+  for (int i = 0; i < kNumMatches; i++) {
+    const Vector3d point(rng->RandDouble(-2.0, 2.0),
+                         rng->RandDouble(-2.0, 2.0),
+                         rng->RandDouble(4.0, 8.0));
+    Vector2d pixel1 = Project(point);
+    Vector2d pixel2 = Project(rotation * point + translation);
+    if (!valid || i >= kNumMatches - kNumOutliers) {
+      pixel2 = Vector2d(rng->RandDouble(0.0, kImageSize),
+                        rng->RandDouble(0.0, kImageSize));
+    }
+    features1.keypoints.emplace_back(pixel1.x(), pixel1.y(), Keypoint::OTHER);
+    features2.keypoints.emplace_back(pixel2.x(), pixel2.y(), Keypoint::OTHER);
+    matches.emplace_back(i, i, 0.0f);
+  }
+
+  pairs->intrinsics.emplace_back(Intrinsics(calibrated));
+  pairs->intrinsics.emplace_back(Intrinsics(calibrated));
+  pairs->features.emplace_back(features1);
+  pairs->features.emplace_back(features2);
+  pairs->matches.emplace_back(matches);
+}
+
+// Points the pairs at their inputs once all of them have been added.
+void SetPairs(Pairs* pairs) {
+  pairs->pairs.resize(pairs->matches.size());
+  for (int i = 0; i < pairs->matches.size(); i++) {
+    TwoViewMatchesToVerify& pair = pairs->pairs[i];
+    pair.intrinsics1 = &pairs->intrinsics[2 * i];
+    pair.intrinsics2 = &pairs->intrinsics[2 * i + 1];
+    pair.features1 = &pairs->features[2 * i];
+    pair.features2 = &pairs->features[2 * i + 1];
+    pair.matches = &pairs->matches[i];
+  }
+}
+
+BatchedGeometricVerificationOptions Options() {
+  BatchedGeometricVerificationOptions options;
+  options.verification_options.bundle_adjustment = false;
+  options.verification_options.refine_relative_pose = false;
+  options.verification_options.estimate_twoview_info_options
+      .max_sampson_error_pixels = 2.0;
+  options.verification_options.estimate_twoview_info_options.rng =
+      std::make_shared<RandomNumberGenerator>(59);
+  options.batch_size = 3;
+  return options;
+}
+
+TEST(VerifyTwoViewMatchesInBatches, AcceptsValidPairsAndRejectsRandomOnes) {
+  RandomNumberGenerator rng(53);
+  Pairs pairs;
+  for (int i = 0; i < 8; i++) {
+    AddPair(i % 2 == 0, i % 4 != 3, &rng, &pairs);
+  }
+  SetPairs(&pairs);
+
+  BatchedGeometricVerificationOptions options = Options();
+  options.num_shards = 2;
+  options.num_threads_per_shard = 2;
+  std::vector<ImagePairMatch> image_pair_matches;
+  std::vector<bool> success;
+  BatchedGeometricVerificationSummary summary;
+  EXPECT_EQ(VerifyTwoViewMatchesInBatches(
+                options, pairs.pairs, &image_pair_matches, &success, &summary),
+            6);
+
+  EXPECT_EQ(summary.num_pairs, 8);
+  EXPECT_EQ(summary.num_batches, 3);
+  EXPECT_EQ(summary.num_rejected_by_screening, 2);
+  EXPECT_EQ(summary.num_verified_pairs, 6);
+  ASSERT_EQ(image_pair_matches.size(), 8);
+  ASSERT_EQ(success.size(), 8);
+  for (int i = 0; i < 8; i++) {
+    EXPECT_EQ(success[i], i % 4 != 3);
+    if (!success[i]) {
+      EXPECT_TRUE(image_pair_matches[i].correspondences.empty());
+      continue;
+    }
+    EXPECT_EQ(image_pair_matches[i].image1, pairs.features[2 * i].image_name);
+    EXPECT_EQ(image_pair_matches[i].image2,
+              pairs.features[2 * i + 1].image_name);
+    EXPECT_GE(image_pair_matches[i].correspondences.size(),
+              kNumMatches - kNumOutliers);
+    EXPECT_LE(image_pair_matches[i].correspondences.size(), kNumMatches);
+    EXPECT_EQ(image_pair_matches[i].twoview_info.num_verified_matches,
+              image_pair_matches[i].correspondences.size());
+  }
+}
+
+TEST(VerifyTwoViewMatchesInBatches, ResultsDoNotDependOnSharding) {
+  RandomNumberGenerator rng(61);
+  Pairs pairs;
+  for (int i = 0; i < 10; i++) {
+    AddPair(i % 3 != 0, true, &rng, &pairs);
+  }
+  SetPairs(&pairs);
+
+  BatchedGeometricVerificationOptions options = Options();
+  std::vector<ImagePairMatch> expected_matches;
+  std::vector<bool> expected_success;
+  VerifyTwoViewMatchesInBatches(
+      options, pairs.pairs, &expected_matches, &expected_success, nullptr);
+
+  options.num_shards = 3;
+  options.num_threads_per_shard = 2;
+  std::vector<ImagePairMatch> image_pair_matches;
+  std::vector<bool> success;
+  VerifyTwoViewMatchesInBatches(
+      options, pairs.pairs, &image_pair_matches, &success, nullptr);
+
+  EXPECT_EQ(success, expected_success);
+  for (int i = 0; i < pairs.pairs.size(); i++) {
+    EXPECT_EQ(image_pair_matches[i].correspondences.size(),
+              expected_matches[i].correspondences.size());
+    EXPECT_EQ(image_pair_matches[i].twoview_info.rotation_2,
+              expected_matches[i].twoview_info.rotation_2);
+    EXPECT_EQ(image_pair_matches[i].twoview_info.position_2,
+              expected_matches[i].twoview_info.position_2);
+  }
+}
+
+TEST(VerifyTwoViewMatchesInBatches, WithoutScreening) {
+  RandomNumberGenerator rng(67);
+  Pairs pairs;
+  AddPair(true, true, &rng, &pairs);
+  AddPair(true, false, &rng, &pairs);
+  SetPairs(&pairs);
+
+  BatchedGeometricVerificationOptions options = Options();
+  options.screen_putative_matches = false;
+  std::vector<ImagePairMatch> image_pair_matches;
+  std::vector<bool> success;
+  BatchedGeometricVerificationSummary summary;
+  EXPECT_EQ(VerifyTwoViewMatchesInBatches(
+                options, pairs.pairs, &image_pair_matches, &success, &summary),
+            1);
+  EXPECT_EQ(success, std::vector<bool>({true, false}));
+  EXPECT_EQ(summary.num_rejected_by_screening, 0);
+}
+
+}  // namespace
+}  // namespace theia
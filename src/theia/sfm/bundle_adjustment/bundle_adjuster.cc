@@ -38,6 +38,7 @@
 #include <ceres/ceres.h>
 #include <glog/logging.h>
 #include <memory>
+#include <string>
 #include <unordered_set>
 #include <vector>
 
@@ -46,15 +47,24 @@
 #include "theia/sfm/bundle_adjustment/position_error.h"
 #include "theia/sfm/camera/camera.h"
 #include "theia/sfm/camera/create_reprojection_error_cost_function.h"
+#include "theia/sfm/camera_rig.h"
 #include "theia/sfm/bundle_adjustment/position_error.h"
 #include "theia/sfm/bundle_adjustment/gravity_error.h"
 #include "theia/sfm/bundle_adjustment/depth_prior_error.h"
+#include "theia/sfm/bundle_adjustment/marginal_covariance.h"
+#include "theia/sfm/bundle_adjustment/rig_cost_function.h"
+#include "theia/sfm/bundle_adjustment/select_linear_solver.h"
 
 #include "theia/sfm/reconstruction.h"
 #include "theia/sfm/reconstruction_estimator_utils.h"
+#include "theia/sfm/select_track_observations_for_bundle_adjustment.h"
 #include "theia/sfm/types.h"
+#include "theia/util/executor.h"
+#include "theia/util/hash.h"
 #include "theia/util/map_util.h"
+#include "theia/util/numa.h"
 #include "theia/util/timer.h"
+#include "theia/util/trace.h"
 
 namespace theia {
 namespace {
@@ -76,6 +86,7 @@ void SetSolverOptions(const BundleAdjustmentOptions& options,
   solver_options->gradient_tolerance = options.gradient_tolerance;
   solver_options->parameter_tolerance = options.parameter_tolerance;
   solver_options->max_trust_region_radius = options.max_trust_region_radius;
+  SetBundleAdjustmentBackend(options, solver_options);
 
   // Solver options takes ownership of the ordering so that we can order the BA
   // problem by points and cameras.
@@ -86,7 +97,9 @@ void SetSolverOptions(const BundleAdjustmentOptions& options,
 
 BundleAdjuster::BundleAdjuster(const BundleAdjustmentOptions& options,
                                Reconstruction* reconstruction)
-    : options_(options), reconstruction_(reconstruction) {
+    : options_(options),
+      reconstruction_(reconstruction),
+      single_precision_jacobians_(options.use_mixed_precision) {
   CHECK_NOTNULL(reconstruction);
 
   // Start setup timer.
@@ -119,6 +132,9 @@ void BundleAdjuster::AddView(const ViewId view_id) {
   // Mark the view as optimized.
   optimized_views_.emplace(view_id);
 
+  // Parameterize the view by its rig frame if it belongs to a camera rig.
+  AddCameraRigParameters(view_id);
+
   // Set the grouping for schur elimination.
   SetCameraSchurGroups(view_id);
 
@@ -127,6 +143,22 @@ void BundleAdjuster::AddView(const ViewId view_id) {
       reconstruction_->CameraIntrinsicsGroupIdFromViewId(view_id);
   optimized_camera_intrinsics_groups_.emplace(intrinsics_group_id);
 
+  // Keep all observations of the view if too few of them would be optimized
+  // otherwise.
+  if (options_.max_num_optimized_observations_per_track > 0) {
+    int num_optimized_observations = 0;
+    for (const TrackId track_id : view->TrackIds()) {
+      const Track* track = reconstruction_->Track(track_id);
+      if (track->IsEstimated() && IsObservationOptimized(track_id, view_id)) {
+        ++num_optimized_observations;
+      }
+    }
+    if (num_optimized_observations <
+        options_.min_num_optimized_observations_per_view) {
+      views_with_all_observations_.emplace(view_id);
+    }
+  }
+
   // Fetch the camera that will be optimized.
   Camera* camera = view->MutableCamera();
   // Add residuals for all tracks in the view.
@@ -134,7 +166,7 @@ void BundleAdjuster::AddView(const ViewId view_id) {
     const Feature* feature = CHECK_NOTNULL(view->GetFeature(track_id));
     Track* track = CHECK_NOTNULL(reconstruction_->MutableTrack(track_id));
     // Only consider tracks with an estimated 3d point.
-    if (!track->IsEstimated()) {
+    if (!track->IsEstimated() || !IsObservationOptimized(track_id, view_id)) {
       continue;
     }
 
@@ -178,7 +210,8 @@ void BundleAdjuster::AddTrack(const TrackId track_id,
   for (const ViewId view_id : observed_view_ids) {
     View* view = CHECK_NOTNULL(reconstruction_->MutableView(view_id));
     // Only optimize estimated views that have not already been added.
-    if (ContainsKey(optimized_views_, view_id) || !view->IsEstimated()) {
+    if (ContainsKey(optimized_views_, view_id) || !view->IsEstimated() ||
+        !IsObservationOptimized(track_id, view_id)) {
       continue;
     }
 
@@ -208,10 +241,36 @@ void BundleAdjuster::AddTrack(const TrackId track_id,
   }
 }
 
+bool BundleAdjuster::IsObservationOptimized(const TrackId track_id,
+                                            const ViewId view_id) {
+  if (options_.max_num_optimized_observations_per_track <= 0 ||
+      ContainsKey(views_with_all_observations_, view_id)) {
+    return true;
+  }
+  const Track* track = reconstruction_->Track(track_id);
+  if (track->NumViews() <= options_.max_num_optimized_observations_per_track) {
+    return true;
+  }
+
+  auto it = selected_track_observations_.find(track_id);
+  if (it == selected_track_observations_.end()) {
+    it = selected_track_observations_
+             .emplace(track_id,
+                      SelectWellSpreadTrackObservations(
+                          *reconstruction_,
+                          track_id,
+                          options_.max_num_optimized_observations_per_track))
+             .first;
+  }
+  return std::binary_search(it->second.begin(), it->second.end(), view_id);
+}
+
 BundleAdjustmentSummary BundleAdjuster::Optimize() {
+  THEIA_TRACE_SCOPE("BundleAdjuster::Optimize");
   // Set extrinsics parameterization of the camera poses. This will set
   // orientation and/or positions as constant if desired.
   SetCameraExtrinsicsParameterization();
+  SetCameraRigExtrinsicsParameterization();
 
   // Set intrinsics group parameterization. This will control which of the
   // intrinsics parameters or optimized or held constant. Note that each camera
@@ -219,6 +278,10 @@ BundleAdjustmentSummary BundleAdjuster::Optimize() {
   // intrinsics model.
   SetCameraIntrinsicsParameterization();
 
+  if (options_.select_linear_solver_automatically) {
+    SelectLinearSolverFromProblemStructure();
+  }
+
   // NOTE: csweeney found a thread on the Ceres Solver email group that
   // indicated using the reverse BA order (i.e., using cameras then points) is a
   // good idea for inner iterations.
@@ -230,50 +293,198 @@ BundleAdjustmentSummary BundleAdjuster::Optimize() {
 
   // Solve the problem.
   const double internal_setup_time = timer_.ElapsedTimeInSeconds();
-  ceres::Solver::Summary solver_summary;
-  ceres::Solve(solver_options_, problem_.get(), &solver_summary);
-  LOG_IF(INFO, options_.verbose) << solver_summary.FullReport();
-
-  // Set the BundleAdjustmentSummary.
-  BundleAdjustmentSummary summary;
-  summary.setup_time_in_seconds =
-      internal_setup_time + solver_summary.preprocessor_time_in_seconds;
-  summary.solve_time_in_seconds = solver_summary.total_time_in_seconds;
-  summary.initial_cost = solver_summary.initial_cost;
-  summary.final_cost = solver_summary.final_cost;
-
-  // This only indicates whether the optimization was successfully run and makes
-  // no guarantees on the quality or convergence.
-  summary.success = solver_summary.IsSolutionUsable();
-
+  const int num_cpus_of_numa_node =
+      GetNumaNodes()[CurrentNumaNodeIndex()].cpus.size();
+  const ScopedNumaNodeAffinity numa_node_affinity(
+      options_.numa_aware &&
+      solver_options_.num_threads <= num_cpus_of_numa_node);
+  BundleAdjustmentSummary summary = SolveBundleAdjustmentProblem(
+      options_, solver_options_, &single_precision_jacobians_, problem_.get());
+  summary.setup_time_in_seconds += internal_setup_time;
+  SetViewPosesFromCameraRigs();
+
+  // NOTE: success only indicates whether the optimization was successfully run
+  // and makes no guarantees on the quality or convergence.
   return summary;
 }
 
+void BundleAdjuster::SelectLinearSolverFromProblemStructure() {
+  BundleAdjustmentProblemStructure structure;
+  // The views of a rig frame share their pose parameters, so each rig frame
+  // is represented by one of its views.
+  std::unordered_map<ViewId, ViewId> camera_of_view;
+  if (!options_.constant_camera_orientation ||
+      !options_.constant_camera_position) {
+    structure.num_cameras =
+        ViewsWithDistinctExtrinsics(optimized_views_).size();
+    for (const ViewId view_id : optimized_views_) {
+      const CameraRigParameters* rig_parameters = FindOrNull(
+          camera_rig_parameters_,
+          reconstruction_->View(view_id)->Camera().extrinsics());
+      camera_of_view.emplace(view_id,
+                             rig_parameters != nullptr
+                                 ? rig_parameters->rig_frame->view_id
+                                 : view_id);
+    }
+  }
+  if (options_.intrinsics_to_optimize != OptimizeIntrinsicsType::NONE) {
+    structure.num_camera_intrinsics_groups =
+        optimized_camera_intrinsics_groups_.size();
+  }
+  structure.num_points = optimized_tracks_.size();
+
+  // Count the pairs of optimized views that share an optimized track.
+  if (structure.num_cameras > 0) {
+    std::unordered_set<ViewIdPair> covisible_view_pairs;
+    std::vector<ViewId> view_ids;
+    for (const TrackId track_id : optimized_tracks_) {
+      view_ids.clear();
+      for (const ViewId view_id : reconstruction_->Track(track_id)->ViewIds()) {
+        if (ContainsKey(optimized_views_, view_id)) {
+          view_ids.emplace_back(FindOrDie(camera_of_view, view_id));
+        }
+      }
+      std::sort(view_ids.begin(), view_ids.end());
+      view_ids.erase(std::unique(view_ids.begin(), view_ids.end()),
+                     view_ids.end());
+      for (int i = 0; i < view_ids.size(); i++) {
+        for (int j = i + 1; j < view_ids.size(); j++) {
+          covisible_view_pairs.emplace(view_ids[i], view_ids[j]);
+        }
+      }
+    }
+    structure.num_covisible_camera_pairs = covisible_view_pairs.size();
+  }
+
+  SelectBundleAdjustmentLinearSolver(options_, structure, &solver_options_);
+}
+
 void BundleAdjuster::SetCameraExtrinsicsParameterization() {
+  // The parameterization is set once per parameter block, i.e. once per rig
+  // frame for the views of camera rigs.
+  const std::vector<ViewId> view_ids =
+      ViewsWithDistinctExtrinsics(optimized_views_);
   if (options_.constant_camera_orientation &&
       options_.constant_camera_position) {
     // If all extrinsics are constant then mark the entire parameter block
     // as constant.
-    for (const ViewId view_id : optimized_views_) {
+    for (const ViewId view_id : view_ids) {
       SetCameraExtrinsicsConstant(view_id);
     }
   } else if (options_.constant_camera_orientation) {
-    for (const ViewId view_id : optimized_views_) {
+    for (const ViewId view_id : view_ids) {
       SetCameraOrientationConstant(view_id);
     }
   } else if (options_.constant_camera_position) {
-    for (const ViewId view_id : optimized_views_) {
+    for (const ViewId view_id : view_ids) {
       SetCameraPositionConstant(view_id);
     }
   }
   // for orthographic cameras we set tz constant = 0
   if (options_.orthographic_camera) {
-    for (const ViewId view_id : optimized_views_) {
+    for (const ViewId view_id : view_ids) {
       SetTzConstant(view_id);
     }
   }
 }
 
+void BundleAdjuster::AddCameraRigParameters(const ViewId view_id) {
+  static const int kIntrinsicsParameterGroup = 1;
+  if (!options_.use_camera_rigs) {
+    return;
+  }
+  const CameraRigMembership* membership =
+      reconstruction_->CameraRigMembershipFromViewId(view_id);
+  if (membership == nullptr) {
+    return;
+  }
+  CameraRig* camera_rig =
+      CHECK_NOTNULL(reconstruction_->MutableCameraRig(membership->rig_id));
+  Camera* camera = reconstruction_->MutableView(view_id)->MutableCamera();
+
+  // The rig frame pose is initialized from the first view of the frame.
+  const auto frame_key =
+      std::make_pair(membership->rig_id, membership->frame_id);
+  auto rig_frame = rig_frames_.find(frame_key);
+  if (rig_frame == rig_frames_.end()) {
+    rig_frame = rig_frames_.emplace(frame_key, RigFrame()).first;
+    rig_frame->second.view_id = view_id;
+    camera_rig->RigPoseFromCamera(membership->camera_index,
+                                  *camera,
+                                  rig_frame->second.extrinsics.data());
+  }
+
+  // The rig camera extrinsics are shared by all frames of the rig, so they are
+  // grouped with the intrinsics for Schur elimination.
+  double* camera_to_rig_extrinsics =
+      camera_rig->MutableCameraExtrinsics(membership->camera_index);
+  if (rig_camera_extrinsics_
+          .emplace(std::make_pair(membership->rig_id,
+                                  membership->camera_index),
+                   camera_to_rig_extrinsics)
+          .second) {
+    parameter_ordering_->AddElementToGroup(camera_to_rig_extrinsics,
+                                           kIntrinsicsParameterGroup);
+  }
+
+  CameraRigParameters& rig_parameters =
+      camera_rig_parameters_[camera->extrinsics()];
+  rig_parameters.rig_frame = &rig_frame->second;
+  rig_parameters.camera_to_rig_extrinsics = camera_to_rig_extrinsics;
+}
+
+double* BundleAdjuster::MutableExtrinsicsParameterBlock(const ViewId view_id) {
+  Camera* camera = reconstruction_->MutableView(view_id)->MutableCamera();
+  CameraRigParameters* rig_parameters =
+      FindOrNull(camera_rig_parameters_, camera->extrinsics());
+  return rig_parameters != nullptr
+             ? rig_parameters->rig_frame->extrinsics.data()
+             : camera->mutable_extrinsics();
+}
+
+std::vector<ViewId> BundleAdjuster::ViewsWithDistinctExtrinsics(
+    const std::unordered_set<ViewId>& view_ids) {
+  std::vector<ViewId> distinct_view_ids;
+  distinct_view_ids.reserve(view_ids.size());
+  for (const ViewId view_id : view_ids) {
+    const CameraRigParameters* rig_parameters =
+        FindOrNull(camera_rig_parameters_,
+                   reconstruction_->View(view_id)->Camera().extrinsics());
+    if (rig_parameters == nullptr ||
+        rig_parameters->rig_frame->view_id == view_id) {
+      distinct_view_ids.emplace_back(view_id);
+    }
+  }
+  return distinct_view_ids;
+}
+
+void BundleAdjuster::SetCameraRigExtrinsicsParameterization() {
+  CameraRigId previous_rig_id = kInvalidCameraRigId;
+  for (const auto& rig_camera : rig_camera_extrinsics_) {
+    // The cameras are sorted by rig and camera index, so the first camera of
+    // each rig has the lowest index.
+    const bool is_reference_camera =
+        rig_camera.first.first != previous_rig_id;
+    previous_rig_id = rig_camera.first.first;
+    if (!options_.optimize_camera_rig_extrinsics || is_reference_camera) {
+      problem_->SetParameterBlockConstant(rig_camera.second);
+    }
+  }
+}
+
+void BundleAdjuster::SetViewPosesFromCameraRigs() {
+  for (const ViewId view_id : optimized_views_) {
+    Camera* camera = reconstruction_->MutableView(view_id)->MutableCamera();
+    const CameraRigParameters* rig_parameters =
+        FindOrNull(camera_rig_parameters_, camera->extrinsics());
+    if (rig_parameters != nullptr) {
+      ComposeRigCameraExtrinsics(rig_parameters->rig_frame->extrinsics.data(),
+                                 rig_parameters->camera_to_rig_extrinsics,
+                                 camera->mutable_extrinsics());
+    }
+  }
+}
+
 void BundleAdjuster::SetCameraIntrinsicsParameterization() {
   // Loop through all optimized camera intrinsics groups to set the intrinsics
   // parameterization.
@@ -370,9 +581,7 @@ BundleAdjuster::GetIntrinsicsForCameraIntrinsicsGroup(
 }
 
 void BundleAdjuster::SetCameraExtrinsicsConstant(const ViewId view_id) {
-  View* view = reconstruction_->MutableView(view_id);
-  Camera* camera = view->MutableCamera();
-  problem_->SetParameterBlockConstant(camera->mutable_extrinsics());
+  problem_->SetParameterBlockConstant(MutableExtrinsicsParameterBlock(view_id));
 }
 
 void BundleAdjuster::SetCameraPositionConstant(const ViewId view_id) {
@@ -381,9 +590,7 @@ void BundleAdjuster::SetCameraPositionConstant(const ViewId view_id) {
   ceres::SubsetManifold* subset_parameterization =
       new ceres::SubsetManifold(Camera::kExtrinsicsSize,
                                         position_parameters);
-  View* view = reconstruction_->MutableView(view_id);
-  Camera* camera = view->MutableCamera();
-  problem_->SetManifold(camera->mutable_extrinsics(),
+  problem_->SetManifold(MutableExtrinsicsParameterBlock(view_id),
                         subset_parameterization);
 }
 
@@ -395,9 +602,7 @@ void BundleAdjuster::SetCameraOrientationConstant(const ViewId view_id) {
   ceres::SubsetManifold* subset_parameterization =
       new ceres::SubsetManifold(Camera::kExtrinsicsSize,
                                         orientation_parameters);
-  View* view = reconstruction_->MutableView(view_id);
-  Camera* camera = view->MutableCamera();
-  problem_->SetManifold(camera->mutable_extrinsics(),
+  problem_->SetManifold(MutableExtrinsicsParameterBlock(view_id),
                         subset_parameterization);
 }
 
@@ -406,9 +611,7 @@ void BundleAdjuster::SetTzConstant(const ViewId view_id) {
     ceres::SubsetManifold* subset_parameterization =
         new ceres::SubsetManifold(Camera::kExtrinsicsSize,
                                           position_parameters);
-    View* view = reconstruction_->MutableView(view_id);
-    Camera* camera = view->MutableCamera();
-    problem_->SetManifold(camera->mutable_extrinsics(),
+    problem_->SetManifold(MutableExtrinsicsParameterBlock(view_id),
                           subset_parameterization);
 }
 
@@ -443,8 +646,8 @@ void BundleAdjuster::SetCameraSchurGroups(const ViewId view_id) {
   // independent set. Since the intrinsics may be shared, they are not
   // guaranteed to form an independent set and so we must use the extrinsics
   // in group 2.
-  parameter_ordering_->AddElementToGroup(camera->mutable_extrinsics(),
-                                         kExtrinsicsParameterGroup);
+  parameter_ordering_->AddElementToGroup(
+      MutableExtrinsicsParameterBlock(view_id), kExtrinsicsParameterGroup);
   parameter_ordering_->AddElementToGroup(camera->mutable_intrinsics(),
                                          kIntrinsicsParameterGroup);
 }
@@ -464,42 +667,72 @@ void BundleAdjuster::AddReprojectionErrorResidual(const Feature& feature,
   // Add the residual for the track to the problem. The shared intrinsics
   // parameter block will be set to constant after the loop if no optimized
   // cameras share the same camera intrinsics.
-  problem_->AddResidualBlock(
+  AddExtrinsicsResidualBlock(
       CreateReprojectionErrorCostFunction(
-          camera->GetCameraIntrinsicsModelType(), feature),
+          camera->GetCameraIntrinsicsModelType(),
+          feature,
+          options_.use_analytic_reprojection_jacobians ||
+              options_.use_mixed_precision,
+          &single_precision_jacobians_),
       loss_function_.get(),
-      camera->mutable_extrinsics(),
-      camera->mutable_intrinsics(),
-      track->MutablePoint()->data());
+      camera,
+      {camera->mutable_intrinsics(), track->MutablePoint()->data()});
 }
 
 void BundleAdjuster::AddPositionPriorErrorResidual(View* view, Camera* camera) {
   // Adds a position priors to the camera poses. This can for example be a GPS
   // position.
-  problem_->AddResidualBlock(
+  AddExtrinsicsResidualBlock(
       PositionError::Create(view->GetPositionPrior(),
                             view->GetPositionPriorSqrtInformation()),
       NULL,
-      camera->mutable_extrinsics());
+      camera,
+      {});
 }
 
 void BundleAdjuster::AddGravityPriorErrorResidual(View* view, Camera* camera) {
   // Adds a gravity priors to the camera orientation
-  problem_->AddResidualBlock(
+  AddExtrinsicsResidualBlock(
       GravityError::Create(view->GetGravityPrior(),
                            view->GetGravityPriorSqrtInformation()),
       NULL,
-      camera->mutable_extrinsics());
+      camera,
+      {});
 }
 
 void BundleAdjuster::AddDepthPriorErrorResidual(const Feature& feature,
                                           Camera* camera,
                                           Track* track) {
 
+  AddExtrinsicsResidualBlock(DepthPriorError::Create(feature),
+                             depth_prior_loss_function_.get(),
+                             camera,
+                             {track->MutablePoint()->data()});
+}
+
+void BundleAdjuster::AddExtrinsicsResidualBlock(
+    ceres::CostFunction* cost_function,
+    ceres::LossFunction* loss_function,
+    Camera* camera,
+    const std::vector<double*>& parameter_blocks) {
+  std::vector<double*> residual_parameter_blocks;
+  residual_parameter_blocks.reserve(parameter_blocks.size() + 2);
+  const CameraRigParameters* rig_parameters =
+      FindOrNull(camera_rig_parameters_, camera->extrinsics());
+  if (rig_parameters != nullptr) {
+    cost_function = new RigCostFunction(cost_function);
+    residual_parameter_blocks.emplace_back(
+        rig_parameters->rig_frame->extrinsics.data());
+    residual_parameter_blocks.emplace_back(
+        rig_parameters->camera_to_rig_extrinsics);
+  } else {
+    residual_parameter_blocks.emplace_back(camera->mutable_extrinsics());
+  }
+  residual_parameter_blocks.insert(residual_parameter_blocks.end(),
+                                   parameter_blocks.begin(),
+                                   parameter_blocks.end());
   problem_->AddResidualBlock(
-    DepthPriorError::Create(feature),
-    depth_prior_loss_function_.get(),
-    camera->mutable_extrinsics(), track->MutablePoint()->data());
+      cost_function, loss_function, residual_parameter_blocks);
 }
 
 bool BundleAdjuster::GetCovarianceForTrack(const TrackId track_id,
@@ -513,6 +746,15 @@ bool BundleAdjuster::GetCovarianceForTrack(const TrackId track_id,
 
   if (!problem_->IsParameterBlockConstant(track->Point().data()) &&
       problem_->HasParameterBlock(track->Point().data())) {
+    if (options_.use_marginal_covariance_estimation) {
+      std::vector<Eigen::MatrixXd> covariances;
+      if (!ComputeMarginalCovariances({track->Point().data()}, &covariances) ||
+          covariances[0].rows() != 3) {
+        return false;
+      }
+      *covariance_matrix = covariances[0];
+      return true;
+    }
     if (!covariance_estimator.Compute(covariance_blocks, problem_.get())) {
       return false;
     }
@@ -546,6 +788,25 @@ bool BundleAdjuster::GetCovarianceForTracks(
     }
   }
 
+  if (options_.use_marginal_covariance_estimation) {
+    std::vector<const double*> parameter_blocks;
+    for (const auto& covariance_block : covariance_blocks) {
+      parameter_blocks.emplace_back(covariance_block.first);
+    }
+    std::vector<Eigen::MatrixXd> covariances;
+    if (!ComputeMarginalCovariances(parameter_blocks, &covariances)) {
+      return false;
+    }
+    for (size_t i = 0; i < est_track_ids.size(); ++i) {
+      if (covariances[i].rows() != 3) {
+        return false;
+      }
+      covariance_matrices->insert(
+          std::make_pair(est_track_ids[i], Eigen::Matrix3d(covariances[i])));
+    }
+    return true;
+  }
+
   if (!covariance_estimator.Compute(covariance_blocks, problem_.get())) {
     return false;
   }
@@ -570,8 +831,18 @@ bool BundleAdjuster::GetCovarianceForView(const ViewId view_id,
   std::vector<std::pair<const double*, const double*>> covariance_blocks = {
       std::make_pair(camera.extrinsics(), camera.extrinsics())};
 
-  if (!problem_->IsParameterBlockConstant(camera.extrinsics()) &&
-      problem_->HasParameterBlock(camera.extrinsics())) {
+  // The extrinsics of the views of camera rigs are not part of the problem.
+  if (problem_->HasParameterBlock(camera.extrinsics()) &&
+      !problem_->IsParameterBlockConstant(camera.extrinsics())) {
+    if (options_.use_marginal_covariance_estimation) {
+      std::vector<Eigen::MatrixXd> covariances;
+      if (!ComputeMarginalCovariances({camera.extrinsics()}, &covariances) ||
+          covariances[0].rows() != 6) {
+        return false;
+      }
+      *covariance_matrix = covariances[0];
+      return true;
+    }
     if (!covariance_estimator.Compute(covariance_blocks, problem_.get())) {
       return false;
     }
@@ -591,8 +862,8 @@ bool BundleAdjuster::GetCovarianceForViews(
   std::vector<ViewId> est_view_ids;
   for (const auto& v_id : view_ids) {
     const auto extr_ptr = reconstruction_->View(v_id)->Camera().extrinsics();
-    if (!problem_->IsParameterBlockConstant(extr_ptr) &&
-        problem_->HasParameterBlock(extr_ptr)) {
+    if (problem_->HasParameterBlock(extr_ptr) &&
+        !problem_->IsParameterBlockConstant(extr_ptr)) {
       est_view_ids.push_back(v_id);
       covariance_blocks.push_back(std::make_pair(extr_ptr, extr_ptr));
     } else {
@@ -603,6 +874,25 @@ bool BundleAdjuster::GetCovarianceForViews(
     }
   }
 
+  if (options_.use_marginal_covariance_estimation) {
+    std::vector<const double*> parameter_blocks;
+    for (const auto& covariance_block : covariance_blocks) {
+      parameter_blocks.emplace_back(covariance_block.first);
+    }
+    std::vector<Eigen::MatrixXd> covariances;
+    if (!ComputeMarginalCovariances(parameter_blocks, &covariances)) {
+      return false;
+    }
+    for (size_t i = 0; i < est_view_ids.size(); ++i) {
+      if (covariances[i].rows() != 6) {
+        return false;
+      }
+      covariance_matrices->insert(
+          std::make_pair(est_view_ids[i], Matrix6d(covariances[i])));
+    }
+    return true;
+  }
+
   if (!covariance_estimator.Compute(covariance_blocks, problem_.get())) {
     return false;
   }
@@ -617,4 +907,38 @@ bool BundleAdjuster::GetCovarianceForViews(
   return true;
 }
 
+bool BundleAdjuster::ComputeMarginalCovariances(
+    const std::vector<const double*>& parameter_blocks,
+    std::vector<Eigen::MatrixXd>* covariance_matrices) {
+  MarginalCovarianceOptions covariance_options;
+  covariance_options.num_threads = AvailableNumThreads(options_.num_threads);
+  covariance_options.max_memory_in_bytes =
+      options_.covariance_max_memory_in_bytes;
+  covariance_options.apply_loss_function =
+      covariance_options_.apply_loss_function;
+
+  // The points of the tracks do not share residuals with each other and are
+  // eliminated.
+  std::unordered_set<const double*> eliminated_blocks;
+  for (const TrackId track_id : optimized_tracks_) {
+    const double* point = reconstruction_->Track(track_id)->Point().data();
+    if (problem_->HasParameterBlock(point)) {
+      eliminated_blocks.emplace(point);
+    }
+  }
+
+  MarginalCovarianceEstimator covariance_estimator(covariance_options);
+  if (!covariance_estimator.Compute(
+          parameter_blocks, eliminated_blocks, problem_.get())) {
+    return false;
+  }
+
+  covariance_matrices->resize(parameter_blocks.size());
+  for (size_t i = 0; i < parameter_blocks.size(); ++i) {
+    CHECK(covariance_estimator.GetCovarianceBlock(
+        parameter_blocks[i], &(*covariance_matrices)[i]));
+  }
+  return true;
+}
+
 }  // namespace theia
@@ -37,7 +37,12 @@
 
 #include <ceres/ceres.h>
 #include <ceres/types.h>
+#include <array>
+#include <map>
+#include <unordered_map>
 #include <unordered_set>
+#include <utility>
+#include <vector>
 
 #include "theia/sfm/bundle_adjustment/bundle_adjustment.h"
 #include "theia/sfm/feature.h"
@@ -55,7 +60,9 @@ class View;
 // This class sets up nonlinear optimization problems for bundle adjustment.
 // Bundle adjustment problems are set up by adding views and tracks to be
 // optimized. Only the views and tracks supplied with AddView and AddTrack will
-// be optimized. All other parameters are held constant.
+// be optimized. All other parameters are held constant. With
+// BundleAdjustmentOptions::use_camera_rigs, the optimized views of a rig frame
+// share the pose of the rig frame.
 //
 // NOTE: It is required that AddViews is called before AddTracks if any views
 // are being optimized.
@@ -114,6 +121,15 @@ class BundleAdjuster {
   virtual void SetTrackVariable(const TrackId track_id);
   virtual void SetHomogeneousPointParametrization(const TrackId track_id);
 
+  // Returns false if the observation of the track in the view is left out of
+  // the problem by the subsampling of long tracks (see
+  // BundleAdjustmentOptions::max_num_optimized_observations_per_track).
+  bool IsObservationOptimized(const TrackId track_id, const ViewId view_id);
+
+  // Sets the linear solver and preconditioner of the solver options with
+  // SelectLinearSolver from the views and tracks in the problem.
+  void SelectLinearSolverFromProblemStructure();
+
   // Set the schur ordering for the parameters.
   virtual void SetCameraSchurGroups(const ViewId view_id);
   virtual void SetTrackSchurGroup(const TrackId track_id);
@@ -133,6 +149,34 @@ class BundleAdjuster {
                                           Camera* camera,
                                           Track* track);
 
+  // Adds a residual whose first parameter block is the camera extrinsics,
+  // followed by the remaining parameter blocks. For the views of a camera rig
+  // the residual is wrapped in a RigCostFunction that depends on the rig frame
+  // pose and the rig camera extrinsics instead.
+  void AddExtrinsicsResidualBlock(ceres::CostFunction* cost_function,
+                                  ceres::LossFunction* loss_function,
+                                  Camera* camera,
+                                  const std::vector<double*>& parameter_blocks);
+
+  // Sets up the rig frame pose and the rig camera extrinsics of the view if it
+  // belongs to a camera rig and camera rigs are used.
+  void AddCameraRigParameters(const ViewId view_id);
+
+  // Returns the parameter block that holds the pose of the view: the rig frame
+  // pose for the views of a camera rig and the camera extrinsics otherwise.
+  double* MutableExtrinsicsParameterBlock(const ViewId view_id);
+
+  // Returns the views with distinct pose parameter blocks, i.e. one view per
+  // rig frame.
+  std::vector<ViewId> ViewsWithDistinctExtrinsics(
+      const std::unordered_set<ViewId>& view_ids);
+
+  // Sets the rig camera extrinsics constant if they are not optimized (or to
+  // fix the gauge of each rig) and composes the optimized rig frame poses into
+  // the camera extrinsics of their views.
+  void SetCameraRigExtrinsicsParameterization();
+  void SetViewPosesFromCameraRigs();
+
   const BundleAdjustmentOptions options_;
   Reconstruction* reconstruction_;
   Timer timer_;
@@ -157,6 +201,12 @@ class BundleAdjuster {
   // The optimized tracks.
   std::unordered_set<TrackId> optimized_tracks_;
 
+  // The views whose observations are selected for the subsampled tracks,
+  // computed when the track is first needed, and the optimized views that
+  // keep all of their observations.
+  std::unordered_map<TrackId, std::vector<ViewId>> selected_track_observations_;
+  std::unordered_set<ViewId> views_with_all_observations_;
+
   // The intrinsics groups that are optimized.
   std::unordered_set<CameraIntrinsicsGroupId>
       optimized_camera_intrinsics_groups_;
@@ -167,8 +217,36 @@ class BundleAdjuster {
   std::unordered_set<CameraIntrinsicsGroupId>
       potentially_constant_camera_intrinsics_groups_;
 
+  // Computes the covariances of the parameter blocks in their tangent space
+  // with the MarginalCovarianceEstimator, eliminating the track points.
+  bool ComputeMarginalCovariances(
+      const std::vector<const double*>& parameter_blocks,
+      std::vector<Eigen::MatrixXd>* covariance_matrices);
+
   // Covariance estimator
   ceres::Covariance::Options covariance_options_;
+
+  // Whether the reprojection errors currently compute single precision
+  // Jacobians. Only used with mixed precision bundle adjustment.
+  bool single_precision_jacobians_;
+
+  // The rig frame poses of the optimized views of camera rigs, keyed by the rig
+  // and frame ids, with the first view of the frame that was added.
+  struct RigFrame {
+    ViewId view_id = kInvalidViewId;
+    std::array<double, Camera::kExtrinsicsSize> extrinsics;
+  };
+  std::map<std::pair<CameraRigId, int>, RigFrame> rig_frames_;
+  // The parameter blocks that replace the camera extrinsics of the optimized
+  // views of camera rigs, keyed by the camera extrinsics.
+  struct CameraRigParameters {
+    RigFrame* rig_frame = nullptr;
+    double* camera_to_rig_extrinsics = nullptr;
+  };
+  std::unordered_map<const double*, CameraRigParameters> camera_rig_parameters_;
+  // The rig camera extrinsics in the problem, keyed by the rig id and camera
+  // index.
+  std::map<std::pair<CameraRigId, int>, double*> rig_camera_extrinsics_;
 };
 
 }  // namespace theia
@@ -34,15 +34,398 @@
 
 #include "theia/sfm/bundle_adjustment/bundle_adjustment.h"
 
+#include <ceres/ceres.h>
 #include <glog/logging.h>
+#include <algorithm>
+#include <memory>
+#include <string>
 #include <unordered_set>
+#include <vector>
 
 #include "theia/sfm/bundle_adjustment/bundle_adjuster.h"
+#include "theia/sfm/bundle_adjustment/partitioned_bundle_adjustment.h"
+#include "theia/sfm/bundle_adjustment/refine_tracks.h"
 #include "theia/sfm/reconstruction.h"
+#include "theia/sfm/sub_reconstruction.h"
+#include "theia/sfm/track.h"
 #include "theia/sfm/types.h"
+#include "theia/sfm/view.h"
+#include "theia/util/executor.h"
+#include "theia/util/memory_accounting.h"
+#include "theia/util/metrics.h"
 
 namespace theia {
 
+namespace {
+
+#if !defined(CERES_NO_CUDA) && \
+    (CERES_VERSION_MAJOR > 2 ||   \
+     (CERES_VERSION_MAJOR == 2 && CERES_VERSION_MINOR >= 2))
+#define THEIA_CERES_HAS_CUDA_SOLVERS
+#endif
+
+#ifdef THEIA_CERES_HAS_CUDA_SOLVERS
+// Returns the GPU configurations to try, in order of preference, for the linear
+// solver of the solver options.
+std::vector<ceres::Solver::Options> CudaSolverCandidates(
+    const ceres::Solver::Options& solver_options) {
+  std::vector<ceres::Solver::Options> candidates;
+  ceres::Solver::Options candidate = solver_options;
+  switch (solver_options.linear_solver_type) {
+    case ceres::DENSE_QR:
+    case ceres::DENSE_NORMAL_CHOLESKY:
+    case ceres::DENSE_SCHUR:
+      candidate.dense_linear_algebra_library_type = ceres::CUDA;
+      candidates.emplace_back(candidate);
+      break;
+    case ceres::SPARSE_NORMAL_CHOLESKY:
+    case ceres::CGNR:
+      candidate.sparse_linear_algebra_library_type = ceres::CUDA_SPARSE;
+      candidates.emplace_back(candidate);
+      break;
+    case ceres::SPARSE_SCHUR:
+      candidate.sparse_linear_algebra_library_type = ceres::CUDA_SPARSE;
+      candidates.emplace_back(candidate);
+      // Without a sparse direct solver on the GPU the Schur complement is
+      // solved iteratively instead.
+      candidate.linear_solver_type = ceres::ITERATIVE_SCHUR;
+      candidate.preconditioner_type = ceres::SCHUR_POWER_SERIES_EXPANSION;
+      candidates.emplace_back(candidate);
+      break;
+    case ceres::ITERATIVE_SCHUR:
+      candidate.sparse_linear_algebra_library_type = ceres::CUDA_SPARSE;
+      candidates.emplace_back(candidate);
+      candidate.preconditioner_type = ceres::SCHUR_POWER_SERIES_EXPANSION;
+      candidates.emplace_back(candidate);
+      break;
+    default:
+      break;
+  }
+  return candidates;
+}
+#endif  // THEIA_CERES_HAS_CUDA_SOLVERS
+
+// Adds the timings of a Ceres solve to the summary and sets its final cost.
+void AccumulateSolverSummary(const ceres::Solver::Summary& solver_summary,
+                             BundleAdjustmentSummary* summary) {
+  summary->setup_time_in_seconds += solver_summary.preprocessor_time_in_seconds;
+  summary->solve_time_in_seconds += solver_summary.total_time_in_seconds;
+  summary->num_iterations += solver_summary.num_successful_steps +
+                             solver_summary.num_unsuccessful_steps;
+  summary->residual_evaluation_time_in_seconds +=
+      solver_summary.residual_evaluation_time_in_seconds;
+  summary->jacobian_evaluation_time_in_seconds +=
+      solver_summary.jacobian_evaluation_time_in_seconds;
+  summary->linear_solver_time_in_seconds +=
+      solver_summary.linear_solver_time_in_seconds;
+  summary->final_cost = solver_summary.final_cost;
+  summary->success = solver_summary.IsSolutionUsable();
+}
+
+// Forwards the iteration summaries of Ceres to the iteration callback of the
+// bundle adjustment options. The iterations and the time continue across
+// consecutive solves.
+class IterationCallbackAdapter : public ceres::IterationCallback {
+ public:
+  explicit IterationCallbackAdapter(
+      const BundleAdjustmentIterationCallback& callback)
+      : callback_(callback) {}
+
+  ceres::CallbackReturnType operator()(
+      const ceres::IterationSummary& iteration_summary) override {
+    BundleAdjustmentIterationSummary summary;
+    summary.iteration = first_iteration_ + iteration_summary.iteration;
+    summary.step_is_successful = iteration_summary.step_is_successful;
+    summary.cost = iteration_summary.cost;
+    summary.cost_change = iteration_summary.cost_change;
+    summary.gradient_max_norm = iteration_summary.gradient_max_norm;
+    summary.step_norm = iteration_summary.step_norm;
+    summary.trust_region_radius = iteration_summary.trust_region_radius;
+    summary.linear_solver_iterations =
+        iteration_summary.linear_solver_iterations;
+    summary.iteration_time_in_seconds =
+        iteration_summary.iteration_time_in_seconds;
+    summary.cumulative_time_in_seconds =
+        start_time_in_seconds_ + iteration_summary.cumulative_time_in_seconds;
+    last_iteration_ = summary.iteration;
+
+    if (callback_(summary)) {
+      return ceres::SOLVER_CONTINUE;
+    }
+    stopped_ = true;
+    return ceres::SOLVER_TERMINATE_SUCCESSFULLY;
+  }
+
+  // Continues the iterations and the time of the next solve after the solve
+  // with the given summary.
+  void ContinueAfter(const ceres::Solver::Summary& solver_summary) {
+    first_iteration_ = last_iteration_ + 1;
+    start_time_in_seconds_ += solver_summary.total_time_in_seconds;
+  }
+
+  bool stopped() const { return stopped_; }
+
+ private:
+  const BundleAdjustmentIterationCallback& callback_;
+  int first_iteration_ = 0;
+  int last_iteration_ = 0;
+  double start_time_in_seconds_ = 0.0;
+  bool stopped_ = false;
+};
+
+// Returns the maximum number of views per partition such that the bundle
+// adjustment of a partition fits into the available memory, or 0 if the
+// bundle adjustment of the whole reconstruction fits.
+int MaxNumViewsForMemoryBudget(const Reconstruction& reconstruction) {
+  // The partitions are copies of the reconstruction with their own consensus
+  // terms, so only part of the available memory is planned for a partition.
+  static const double kPartitionMemoryFraction = 0.5;
+  static const int kMinNumViewsPerPartition = 10;
+
+  int num_views = 0;
+  for (const ViewId view_id : reconstruction.ViewIds()) {
+    if (reconstruction.View(view_id)->IsEstimated()) {
+      ++num_views;
+    }
+  }
+  int num_tracks = 0;
+  int num_observations = 0;
+  for (const TrackId track_id : reconstruction.TrackIds()) {
+    const Track* track = reconstruction.Track(track_id);
+    if (track->IsEstimated()) {
+      ++num_tracks;
+      num_observations += track->NumViews();
+    }
+  }
+
+  // Each view has extrinsics and (possibly shared) intrinsics parameters and
+  // each observation has a reprojection error with two residuals.
+  const size_t size_in_bytes = EstimateBundleAdjustmentMemoryUsage(
+      2 * num_views + num_tracks, num_observations, 2 * num_observations);
+  const size_t available_bytes = MemoryAccounting::AvailableBytes();
+  if (size_in_bytes <= available_bytes) {
+    return 0;
+  }
+
+  const int max_num_views_per_partition = std::max(
+      kMinNumViewsPerPartition,
+      static_cast<int>(kPartitionMemoryFraction * num_views *
+                       available_bytes / size_in_bytes));
+  return max_num_views_per_partition < num_views ? max_num_views_per_partition
+                                                 : 0;
+}
+
+BundleAdjustmentSummary BundleAdjustReconstructionByPartitions(
+    const BundleAdjustmentOptions& options,
+    const int max_num_views_per_partition,
+    Reconstruction* reconstruction) {
+  LOG(INFO) << "The bundle adjustment does not fit into the memory budget. "
+               "Bundle adjusting partitions of at most "
+            << max_num_views_per_partition << " views instead.";
+
+  // Solve one partition at a time so that only one of them is in memory.
+  PartitionedBundleAdjustmentOptions partitioned_options;
+  partitioned_options.ba_options = options;
+  partitioned_options.max_num_views_per_partition =
+      max_num_views_per_partition;
+  partitioned_options.num_threads = 1;
+  const PartitionedBundleAdjustmentSummary partitioned_summary =
+      BundleAdjustReconstructionPartitioned(partitioned_options,
+                                            reconstruction);
+
+  BundleAdjustmentSummary summary;
+  summary.success = partitioned_summary.success;
+  summary.solve_time_in_seconds = partitioned_summary.total_time_in_seconds;
+  if (!partitioned_summary.rounds.empty()) {
+    summary.initial_cost = partitioned_summary.rounds.front().cost;
+    summary.final_cost = partitioned_summary.rounds.back().cost;
+  }
+  summary.num_iterations = partitioned_summary.rounds.size();
+  return summary;
+}
+
+}  // namespace
+
+bool SetBundleAdjustmentBackend(const BundleAdjustmentOptions& options,
+                                ceres::Solver::Options* solver_options) {
+  CHECK_NOTNULL(solver_options);
+  if (options.backend == BundleAdjustmentBackend::CPU) {
+    return true;
+  }
+
+#ifdef THEIA_CERES_HAS_CUDA_SOLVERS
+  std::string error;
+  for (const ceres::Solver::Options& candidate :
+       CudaSolverCandidates(*solver_options)) {
+    if (candidate.IsValid(&error)) {
+      *solver_options = candidate;
+      return true;
+    }
+  }
+  LOG(WARNING) << "No CUDA solver is available for linear solver "
+               << ceres::LinearSolverTypeToString(
+                      solver_options->linear_solver_type)
+               << ". Bundle adjustment will run on the CPU.";
+#else
+  LOG(WARNING) << "Ceres was built without CUDA solvers. Bundle adjustment "
+                  "will run on the CPU.";
+#endif  // THEIA_CERES_HAS_CUDA_SOLVERS
+  return false;
+}
+
+void SelectBundleAdjustmentLinearSolver(
+    const BundleAdjustmentOptions& options,
+    const BundleAdjustmentProblemStructure& structure,
+    ceres::Solver::Options* solver_options) {
+  CHECK_NOTNULL(solver_options);
+  SelectLinearSolver(options.linear_solver_selection_options,
+                     structure,
+                     &solver_options->linear_solver_type,
+                     &solver_options->preconditioner_type);
+
+  // Select the linear algebra libraries again for the new linear solver.
+  const ceres::Solver::Options default_solver_options;
+  solver_options->dense_linear_algebra_library_type =
+      default_solver_options.dense_linear_algebra_library_type;
+  solver_options->sparse_linear_algebra_library_type =
+      default_solver_options.sparse_linear_algebra_library_type;
+
+  // Not every build of Ceres has a sparse linear algebra library, which
+  // SPARSE_SCHUR and CLUSTER_JACOBI require.
+  std::string error;
+  if (solver_options->preconditioner_type == ceres::CLUSTER_JACOBI &&
+      !solver_options->IsValid(&error)) {
+    solver_options->preconditioner_type = ceres::SCHUR_JACOBI;
+  }
+  if (solver_options->linear_solver_type == ceres::SPARSE_SCHUR &&
+      !solver_options->IsValid(&error)) {
+    solver_options->linear_solver_type = ceres::ITERATIVE_SCHUR;
+  }
+  SetBundleAdjustmentBackend(options, solver_options);
+
+  LOG_IF(INFO, options.verbose)
+      << "Using " << ceres::LinearSolverTypeToString(
+                         solver_options->linear_solver_type)
+      << " with " << ceres::PreconditionerTypeToString(
+                         solver_options->preconditioner_type)
+      << " for " << structure.num_cameras << " cameras, "
+      << structure.num_camera_intrinsics_groups << " intrinsics groups, "
+      << structure.num_points << " points and "
+      << structure.num_covisible_camera_pairs << " covisible camera pairs.";
+}
+
+BundleAdjustmentSummary SolveBundleAdjustmentProblem(
+    const BundleAdjustmentOptions& options,
+    const ceres::Solver::Options& solver_options,
+    bool* single_precision_jacobians,
+    ceres::Problem* problem) {
+  CHECK_NOTNULL(single_precision_jacobians);
+  CHECK_NOTNULL(problem);
+
+  std::unique_ptr<IterationCallbackAdapter> iteration_callback;
+  if (options.iteration_callback) {
+    iteration_callback.reset(
+        new IterationCallbackAdapter(options.iteration_callback));
+  }
+
+  // A solve that runs within a parallel stage, e.g. the bundle adjustment of
+  // one of several partitions, only uses the threads that are not busy.
+  const int num_threads = AvailableNumThreads(solver_options.num_threads);
+
+  // Account for the memory of the solver while it runs, and make room for it
+  // by shrinking the caches if a memory budget is set.
+  const size_t solver_size_in_bytes =
+      EstimateBundleAdjustmentMemoryUsage(problem->NumParameterBlocks(),
+                                          problem->NumResidualBlocks(),
+                                          problem->NumResiduals());
+  ScopedMemoryConsumer memory_consumer(
+      "bundle_adjustment", [solver_size_in_bytes]() {
+        return solver_size_in_bytes;
+      });
+  MemoryAccounting::EnforceBudget();
+
+  ceres::Solver::Options mixed_precision_options = solver_options;
+  mixed_precision_options.num_threads = num_threads;
+  *single_precision_jacobians = options.use_mixed_precision;
+  if (options.use_mixed_precision) {
+    // Not every linear solver supports mixed precision solves.
+    mixed_precision_options.use_mixed_precision_solves = true;
+    std::string error;
+    if (!mixed_precision_options.IsValid(&error)) {
+      mixed_precision_options.use_mixed_precision_solves = false;
+    }
+  }
+  if (iteration_callback != nullptr) {
+    mixed_precision_options.callbacks.push_back(iteration_callback.get());
+  }
+
+  ceres::Solver::Summary solver_summary;
+  ceres::Solve(mixed_precision_options, problem, &solver_summary);
+  LOG_IF(INFO, options.verbose) << solver_summary.FullReport();
+
+  BundleAdjustmentSummary summary;
+  summary.initial_cost = solver_summary.initial_cost;
+  AccumulateSolverSummary(solver_summary, &summary);
+
+  // Continue from the current estimate in double precision if the mixed
+  // precision solve stalled and there is time left.
+  const double remaining_time_in_seconds =
+      solver_options.max_solver_time_in_seconds -
+      solver_summary.total_time_in_seconds;
+  if (options.use_mixed_precision &&
+      solver_summary.termination_type != ceres::CONVERGENCE &&
+      solver_summary.termination_type != ceres::USER_SUCCESS &&
+      remaining_time_in_seconds > 0.0) {
+    LOG_IF(INFO, options.verbose)
+        << "Mixed precision bundle adjustment did not converge. Continuing in "
+           "double precision.";
+    *single_precision_jacobians = false;
+    ceres::Solver::Options double_precision_options = solver_options;
+    double_precision_options.num_threads = num_threads;
+    double_precision_options.max_solver_time_in_seconds =
+        remaining_time_in_seconds;
+    if (iteration_callback != nullptr) {
+      iteration_callback->ContinueAfter(solver_summary);
+      double_precision_options.callbacks.push_back(iteration_callback.get());
+    }
+    ceres::Solve(double_precision_options, problem, &solver_summary);
+    LOG_IF(INFO, options.verbose) << solver_summary.FullReport();
+    AccumulateSolverSummary(solver_summary, &summary);
+  }
+  summary.stopped_by_iteration_callback =
+      iteration_callback != nullptr && iteration_callback->stopped();
+  summary.linear_solver_type = solver_options.linear_solver_type;
+  summary.preconditioner_type = solver_options.preconditioner_type;
+
+  static Counter* const num_bundle_adjustments = Metrics::GetCounter(
+      "theia_bundle_adjustments_total", "Bundle adjustment problems solved.");
+  static Counter* const num_iterations = Metrics::GetCounter(
+      "theia_bundle_adjustment_iterations_total",
+      "Iterations of all bundle adjustment solves.");
+  num_bundle_adjustments->Increment();
+  num_iterations->Increment(summary.num_iterations);
+  return summary;
+}
+
+size_t EstimateBundleAdjustmentMemoryUsage(const int num_parameter_blocks,
+                                           const int num_residual_blocks,
+                                           const int num_residuals) {
+  // A parameter block holds its state, the local parameterization and the
+  // diagonal blocks of the reduced camera system.
+  static const size_t kBytesPerParameterBlock = 512;
+  // A residual block holds the cost function and the pointers to its
+  // parameter blocks.
+  static const size_t kBytesPerResidualBlock = 256;
+  // A residual holds a row of the Jacobian for about 20 parameters (camera,
+  // intrinsics and point), its contribution to the off-diagonal blocks of the
+  // reduced camera system and the residual vectors of the solver.
+  static const size_t kBytesPerResidual = 256;
+
+  return num_parameter_blocks * kBytesPerParameterBlock +
+         num_residual_blocks * kBytesPerResidualBlock +
+         num_residuals * kBytesPerResidual;
+}
+
 // Bundle adjust the specified views and tracks.
 BundleAdjustmentSummary BundleAdjustPartialReconstruction(
     const BundleAdjustmentOptions& options,
@@ -63,6 +446,19 @@ BundleAdjustmentSummary BundleAdjustPartialReconstruction(
   return bundle_adjuster.Optimize();
 }
 
+BundleAdjustmentSummary BundleAdjustSubReconstruction(
+    const BundleAdjustmentOptions& options,
+    SubReconstruction* sub_reconstruction) {
+  CHECK_NOTNULL(sub_reconstruction);
+  CHECK(sub_reconstruction->WriteBack())
+      << "Cannot bundle adjust a sub-reconstruction of a const reconstruction.";
+
+  return BundleAdjustPartialReconstruction(options,
+                                           sub_reconstruction->ViewIds(),
+                                           sub_reconstruction->TrackIds(),
+                                           sub_reconstruction->MutableParent());
+}
+
 // Bundle adjust the specified views.
 BundleAdjustmentSummary
 BundleAdjustPartialViewsConstant(const BundleAdjustmentOptions &options,
@@ -92,6 +488,15 @@ BundleAdjustPartialViewsConstant(const BundleAdjustmentOptions &options,
 // Bundle adjust the entire reconstruction.
 BundleAdjustmentSummary BundleAdjustReconstruction(
     const BundleAdjustmentOptions& options, Reconstruction* reconstruction) {
+  if (MemoryAccounting::Budget() > 0) {
+    const int max_num_views_per_partition =
+        MaxNumViewsForMemoryBudget(*reconstruction);
+    if (max_num_views_per_partition > 0) {
+      return BundleAdjustReconstructionByPartitions(
+          options, max_num_views_per_partition, reconstruction);
+    }
+  }
+
   const auto& view_ids = reconstruction->ViewIds();
   const auto& track_ids = reconstruction->TrackIds();
 
@@ -141,6 +546,11 @@ BundleAdjustmentSummary BundleAdjustTrack(
     const BundleAdjustmentOptions& options,
     const TrackId track_id,
     Reconstruction* reconstruction) {
+  if (options.refine_tracks_independently) {
+    return RefineTracksWithConstantCameras(
+        options, std::vector<TrackId>{track_id}, reconstruction);
+  }
+
   BundleAdjustmentOptions ba_options = options;
   ba_options.linear_solver_type = ceres::DENSE_QR;
   ba_options.use_inner_iterations = false;
@@ -240,6 +650,11 @@ BundleAdjustmentSummary BundleAdjustTracks(
     const BundleAdjustmentOptions& options,
     const std::vector<TrackId>& tracks_to_optimize,
     Reconstruction* reconstruction) {
+  if (options.refine_tracks_independently) {
+    return RefineTracksWithConstantCameras(
+        options, tracks_to_optimize, reconstruction);
+  }
+
   BundleAdjustmentOptions ba_options = options;
   ba_options.linear_solver_type = ceres::DENSE_QR;
   ba_options.use_inner_iterations = false;
@@ -35,13 +35,18 @@
 #ifndef THEIA_SFM_BUNDLE_ADJUSTMENT_BUNDLE_ADJUSTMENT_H_
 #define THEIA_SFM_BUNDLE_ADJUSTMENT_BUNDLE_ADJUSTMENT_H_
 
+#include <ceres/solver.h>
 #include <ceres/types.h>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
 #include <map>
 #include <unordered_set>
 #include <vector>
 #include <thread>
 
 #include "theia/sfm/bundle_adjustment/create_loss_function.h"
+#include "theia/sfm/bundle_adjustment/select_linear_solver.h"
 #include "theia/sfm/types.h"
 #include "theia/util/enable_enum_bitmask_operators.h"
 
@@ -51,6 +56,7 @@ using Matrix3d = Eigen::Matrix<double, 3, 3>;
 using Matrix6d = Eigen::Matrix<double, 6, 6>;
 
 class Reconstruction;
+class SubReconstruction;
 
 // The camera intrinsics parameters are defined by:
 //   - Focal length
@@ -83,6 +89,38 @@ enum class OptimizeIntrinsicsType {
 };
 ENABLE_ENUM_BITMASK_OPERATORS(OptimizeIntrinsicsType)
 
+// The device used to solve the linear systems of bundle adjustment. The CUDA
+// backend uses the GPU solvers of Ceres and requires Ceres 2.2 or newer built
+// with CUDA support. Residuals and Jacobians are always evaluated on the CPU,
+// so every residual type and shared intrinsics are supported by both backends.
+// If the CUDA backend is unavailable for the chosen linear solver, bundle
+// adjustment falls back to the CPU.
+enum class BundleAdjustmentBackend {
+  CPU = 0,
+  CUDA = 1,
+};
+
+// Statistics of a single iteration of bundle adjustment, as reported by Ceres.
+// Iteration 0 is the initial state. If a mixed precision solve is continued in
+// double precision, the iterations and the time continue across both solves.
+struct BundleAdjustmentIterationSummary {
+  int iteration = 0;
+  bool step_is_successful = false;
+  double cost = 0.0;
+  double cost_change = 0.0;
+  double gradient_max_norm = 0.0;
+  double step_norm = 0.0;
+  double trust_region_radius = 0.0;
+  int linear_solver_iterations = 0;
+  double iteration_time_in_seconds = 0.0;
+  double cumulative_time_in_seconds = 0.0;
+};
+
+// Called after every iteration of bundle adjustment. Returning false stops the
+// optimization and keeps the current estimate.
+typedef std::function<bool(const BundleAdjustmentIterationSummary&)>
+    BundleAdjustmentIterationCallback;
+
 struct BundleAdjustmentOptions {
   // The type of loss function used for BA. By default, we use a standard L2
   // loss function, but robust cost functions could be used.
@@ -98,6 +136,18 @@ struct BundleAdjustmentOptions {
   ceres::VisibilityClusteringType visibility_clustering_type =
       ceres::CANONICAL_VIEWS;
 
+  // If true, BundleAdjuster::Optimize and IncrementalBundleAdjuster::Optimize
+  // choose the linear solver and preconditioner from the structure of the
+  // problem with SelectLinearSolver
+  // instead of using linear_solver_type and preconditioner_type. Since the
+  // choice is made for every problem, it follows a reconstruction as it grows.
+  bool select_linear_solver_automatically = false;
+  LinearSolverSelectionOptions linear_solver_selection_options;
+
+  // Whether the linear solver runs on the CPU or the GPU. See
+  // BundleAdjustmentBackend for details.
+  BundleAdjustmentBackend backend = BundleAdjustmentBackend::CPU;
+
   // If true, ceres will log verbosely.
   bool verbose = false;
 
@@ -111,6 +161,21 @@ struct BundleAdjustmentOptions {
   // space. Reduce from dim 4 -> 3
   bool use_homogeneous_point_parametrization = true;
 
+  // If true, reprojection errors of pinhole, pinhole radial tangential,
+  // fisheye and double sphere cameras are evaluated with hand-derived
+  // Jacobians instead of automatic differentiation, which is faster. Other
+  // camera models always use automatic differentiation.
+  bool use_analytic_reprojection_jacobians = false;
+
+  // If true, bundle adjustment runs in mixed precision. The Jacobians of the
+  // reprojection errors are computed in single precision (this implies
+  // analytic Jacobians for the camera models that support them), and linear
+  // solvers that support it factorize in single precision with iterative
+  // refinement in double precision. Residuals, the normal equations and the
+  // parameter updates remain in double precision. If a mixed precision solve
+  // does not converge, the optimization is continued in double precision.
+  bool use_mixed_precision = false;
+
   // Indicates which intrinsics should be optimized as part of bundle
   // adjustment. Default to NONE!
   OptimizeIntrinsicsType intrinsics_to_optimize = OptimizeIntrinsicsType::NONE;
@@ -118,6 +183,12 @@ struct BundleAdjustmentOptions {
   int num_threads = std::thread::hardware_concurrency();
   int max_num_iterations = 100;
 
+  // If true and num_threads does not exceed the number of CPUs of a NUMA node,
+  // the problem is solved on the node that the calling thread runs on. Ceres
+  // starts its threads from the calling thread, so they stay on that node and
+  // use its memory.
+  bool numa_aware = false;
+
   // Max BA time is 1 hour.
   double max_solver_time_in_seconds = 3600.0;
 
@@ -142,6 +213,60 @@ struct BundleAdjustmentOptions {
 
   // Use gravity priors
   bool use_gravity_priors = false;
+
+  // If true, the views that belong to a camera rig (see
+  // Reconstruction::AddViewToCameraRig) are parameterized by the pose of their
+  // rig frame and the extrinsics of their camera relative to the rig. All
+  // views of a rig frame then share 6 pose parameters, which shrinks the
+  // reduced camera system of the Schur solvers. The rig frame poses are
+  // initialized from the first optimized view of each frame and the composed
+  // poses are written back to the views. The rig extrinsics must be in the
+  // scale of the reconstruction. Only supported by the BundleAdjuster (not by
+  // the IncrementalBundleAdjuster), and covariances are not available for the
+  // views of a rig.
+  bool use_camera_rigs = false;
+
+  // If true, the extrinsics of the rig cameras relative to their rig are
+  // optimized as well. The camera with the lowest index of each rig is held
+  // constant to fix the gauge.
+  bool optimize_camera_rig_extrinsics = false;
+
+  // If true, covariances of tracks and views are computed with the
+  // MarginalCovarianceEstimator instead of ceres::Covariance. It eliminates the
+  // points with the Schur complement and only computes the columns of the
+  // inverse reduced system needed for the requested blocks, which scales to
+  // problems with many thousands of cameras.
+  bool use_marginal_covariance_estimation = false;
+
+  // Memory budget for the marginal covariance estimation.
+  int64_t covariance_max_memory_in_bytes = int64_t(1) << 30;
+
+  // If true, problems that only optimize tracks (BundleAdjustTrack(s) and the
+  // joint track refinement in TrackEstimator) solve each point independently
+  // with a small Levenberg-Marquardt solver in parallel instead of building a
+  // Ceres problem. The same cost is minimized. The overloads that compute
+  // covariances always use Ceres.
+  bool refine_tracks_independently = true;
+
+  // If positive, only this many observations of each track are optimized by
+  // the BundleAdjuster and the IncrementalBundleAdjuster. For longer tracks,
+  // the observations are chosen such that the camera centers are spread out
+  // along the baseline (see SelectWellSpreadTrackObservations) and the
+  // redundant observations are left out of the problem, which shrinks long
+  // street-like sequences considerably. The left out observations are not
+  // changed and are still checked by the outlier filtering after bundle
+  // adjustment.
+  int max_num_optimized_observations_per_track = 0;
+
+  // Views that would keep fewer than this many observations after the
+  // subsampling above keep all of their observations so that they remain well
+  // constrained.
+  int min_num_optimized_observations_per_view = 100;
+
+  // If set, this is called with the statistics of every iteration of the
+  // solver, e.g. to monitor where a solve stalls or to stop it when a time
+  // budget is exceeded.
+  BundleAdjustmentIterationCallback iteration_callback;
 };
 
 // Some important metrics for analyzing bundle adjustment results.
@@ -153,9 +278,65 @@ struct BundleAdjustmentSummary {
   double final_cost = 0.0;
   double setup_time_in_seconds = 0.0;
   double solve_time_in_seconds = 0.0;
+
+  // Breakdown of the solve as reported by Ceres.
+  int num_iterations = 0;
+  double residual_evaluation_time_in_seconds = 0.0;
+  double jacobian_evaluation_time_in_seconds = 0.0;
+  double linear_solver_time_in_seconds = 0.0;
+
+  // True if the optimization was stopped by the iteration callback.
+  bool stopped_by_iteration_callback = false;
+
+  // The linear solver and preconditioner that the problem was solved with.
+  ceres::LinearSolverType linear_solver_type = ceres::SPARSE_SCHUR;
+  ceres::PreconditionerType preconditioner_type = ceres::SCHUR_JACOBI;
 };
 
-// Bundle adjust all views and tracks in the reconstruction.
+// Sets the linear algebra libraries of the solver options to run the linear
+// solver on the backend chosen in the bundle adjustment options. The linear
+// solver and preconditioner types must already be set. For the CUDA backend,
+// SPARSE_SCHUR is replaced by ITERATIVE_SCHUR if Ceres has no sparse Schur
+// solver on the GPU. Returns false and leaves the solver options untouched if
+// the backend is not available.
+bool SetBundleAdjustmentBackend(const BundleAdjustmentOptions& options,
+                                ceres::Solver::Options* solver_options);
+
+// Sets the linear solver and preconditioner of the solver options with
+// SelectLinearSolver for a problem of the given structure. Solvers that the
+// Ceres build cannot run are replaced by ones that it can, and the linear
+// algebra libraries are set for the backend of the options.
+void SelectBundleAdjustmentLinearSolver(
+    const BundleAdjustmentOptions& options,
+    const BundleAdjustmentProblemStructure& structure,
+    ceres::Solver::Options* solver_options);
+
+// Solves a bundle adjustment problem. With mixed precision (see
+// BundleAdjustmentOptions::use_mixed_precision), single_precision_jacobians is
+// the flag shared with the reprojection error cost functions: it is set for
+// the first solve, and cleared to continue in double precision if that solve
+// does not converge. The double precision solve only gets the remaining solver
+// time. The iteration callback of the options is attached to the solves. The
+// number of threads of the solver options is limited to AvailableNumThreads.
+// The setup time of the summary only includes the time of the Ceres
+// preprocessor.
+BundleAdjustmentSummary SolveBundleAdjustmentProblem(
+    const BundleAdjustmentOptions& options,
+    const ceres::Solver::Options& solver_options,
+    bool* single_precision_jacobians,
+    ceres::Problem* problem);
+
+// Returns a rough estimate of the memory in bytes that Ceres needs to solve a
+// bundle adjustment problem of the given size, i.e. the problem itself, the
+// Jacobian and the reduced camera system. This is used for memory accounting.
+size_t EstimateBundleAdjustmentMemoryUsage(const int num_parameter_blocks,
+                                           const int num_residual_blocks,
+                                           const int num_residuals);
+
+// Bundle adjust all views and tracks in the reconstruction. If a memory budget
+// is set (see MemoryAccounting) and the problem would not fit into the memory
+// that is left, the reconstruction is bundle adjusted by partitions instead
+// (see BundleAdjustReconstructionPartitioned), one partition at a time.
 BundleAdjustmentSummary BundleAdjustReconstruction(
     const BundleAdjustmentOptions& options, Reconstruction* reconstruction);
 
@@ -166,6 +347,14 @@ BundleAdjustmentSummary BundleAdjustPartialReconstruction(
     const std::unordered_set<TrackId>& tracks_to_optimize,
     Reconstruction* reconstruction);
 
+// Bundle adjust the views and tracks of a sub-reconstruction in place in its
+// parent, without copying them. Pending changes of the sub-reconstruction are
+// written back first. Observations of the tracks in views outside of the
+// subset are kept as constant constraints. The parent must not be const.
+BundleAdjustmentSummary BundleAdjustSubReconstruction(
+    const BundleAdjustmentOptions& options,
+    SubReconstruction* sub_reconstruction);
+
 BundleAdjustmentSummary
 BundleAdjustPartialViewsConstant(
     const BundleAdjustmentOptions &options,
@@ -35,8 +35,11 @@
 #include <Eigen/Core>
 #include <Eigen/LU>
 #include <algorithm>
+#include <ceres/ceres.h>
 #include <ceres/rotation.h>
 #include <glog/logging.h>
+#include <string>
+#include <vector>
 
 #include "theia/matching/feature_correspondence.h"
 #include "theia/math/util.h"
@@ -62,7 +65,9 @@ Camera RandomCamera() {
   return camera;
 }
 
-void TestOptimizeView(const int kNumPoints, const double kPixelNoise) {
+void TestOptimizeView(const int kNumPoints,
+                      const double kPixelNoise,
+                      BundleAdjustmentOptions opts = BundleAdjustmentOptions()) {
   // Set up random cameras.
   Camera camera1 = RandomCamera();
   Reconstruction reconstruction;
@@ -89,7 +94,6 @@ void TestOptimizeView(const int kNumPoints, const double kPixelNoise) {
     }
   }
 
-  BundleAdjustmentOptions opts;
   opts.verbose = true;
   BundleAdjustmentSummary sum = BundleAdjustView(opts, vid, &reconstruction);
   std::cout << "Success: " << sum.success << "\n";
@@ -118,4 +122,128 @@ TEST(OptimizeView, Noise) {
   TestOptimizeView(kNumPoints, kPixelNoise);
 }
 
+// Without CUDA support in Ceres this falls back to the CPU.
+TEST(OptimizeView, CudaBackend) {
+  static const double kPixelNoise = 0.1;
+  static const int kNumPoints = 100;
+  BundleAdjustmentOptions options;
+  options.backend = BundleAdjustmentBackend::CUDA;
+  TestOptimizeView(kNumPoints, kPixelNoise, options);
+}
+
+TEST(OptimizeView, MixedPrecision) {
+  static const double kPixelNoise = 0.1;
+  static const int kNumPoints = 100;
+  BundleAdjustmentOptions options;
+  options.use_mixed_precision = true;
+  TestOptimizeView(kNumPoints, kPixelNoise, options);
+}
+
+namespace {
+
+// Bundle adjusts a view whose position is perturbed with the given options.
+BundleAdjustmentSummary OptimizePerturbedView(
+    const BundleAdjustmentOptions& options) {
+  static const int kNumPoints = 100;
+  Reconstruction reconstruction;
+  const ViewId view_id = reconstruction.AddView("0", 0, 0.0);
+  View* view = reconstruction.MutableView(view_id);
+  view->MutableCamera()->DeepCopy(RandomCamera());
+  view->SetEstimated(true);
+  for (int i = 0; i < kNumPoints; i++) {
+    const Eigen::Vector3d point(rng.RandDouble(-5.0, 5.0),
+                                rng.RandDouble(-5.0, 5.0),
+                                rng.RandDouble(4.0, 10.0));
+    const TrackId track_id = reconstruction.AddTrack();
+    reconstruction.MutableTrack(track_id)->SetPoint(point.homogeneous());
+    reconstruction.MutableTrack(track_id)->SetEstimated(true);
+
+    Eigen::Vector2d pixel;
+    if (view->Camera().ProjectPoint(point.homogeneous(), &pixel) > 0.0) {
+      reconstruction.AddObservation(view_id, track_id, Feature(pixel));
+    }
+  }
+  view->MutableCamera()->SetPosition(view->Camera().GetPosition() +
+                                     0.1 * rng.RandVector3d());
+  return BundleAdjustView(options, view_id, &reconstruction);
+}
+
+}  // namespace
+
+TEST(OptimizeView, IterationCallbackReportsEveryIteration) {
+  std::vector<BundleAdjustmentIterationSummary> iterations;
+  BundleAdjustmentOptions options;
+  options.iteration_callback =
+      [&](const BundleAdjustmentIterationSummary& iteration) {
+        iterations.emplace_back(iteration);
+        return true;
+      };
+  const BundleAdjustmentSummary summary = OptimizePerturbedView(options);
+  EXPECT_TRUE(summary.success);
+  EXPECT_FALSE(summary.stopped_by_iteration_callback);
+  ASSERT_GT(iterations.size(), 1);
+  for (int i = 0; i < iterations.size(); i++) {
+    EXPECT_EQ(iterations[i].iteration, i);
+    if (i > 0) {
+      EXPECT_GE(iterations[i].cumulative_time_in_seconds,
+                iterations[i - 1].cumulative_time_in_seconds);
+    }
+  }
+  EXPECT_DOUBLE_EQ(iterations.front().cost, summary.initial_cost);
+}
+
+TEST(OptimizeView, IterationCallbackStopsTheSolve) {
+  static const int kMaxIteration = 1;
+  int num_calls = 0;
+  BundleAdjustmentOptions options;
+  options.iteration_callback =
+      [&](const BundleAdjustmentIterationSummary& iteration) {
+        ++num_calls;
+        return iteration.iteration < kMaxIteration;
+      };
+  const BundleAdjustmentSummary summary = OptimizePerturbedView(options);
+  EXPECT_TRUE(summary.success);
+  EXPECT_TRUE(summary.stopped_by_iteration_callback);
+  EXPECT_EQ(num_calls, kMaxIteration + 1);
+  EXPECT_LT(summary.final_cost, summary.initial_cost);
+}
+
+TEST(SetBundleAdjustmentBackend, CpuLeavesSolverOptionsUntouched) {
+  BundleAdjustmentOptions options;
+  ceres::Solver::Options solver_options;
+  solver_options.linear_solver_type = ceres::SPARSE_SCHUR;
+  const ceres::Solver::Options original_options = solver_options;
+  EXPECT_TRUE(SetBundleAdjustmentBackend(options, &solver_options));
+  EXPECT_EQ(solver_options.linear_solver_type,
+            original_options.linear_solver_type);
+  EXPECT_EQ(solver_options.sparse_linear_algebra_library_type,
+            original_options.sparse_linear_algebra_library_type);
+  EXPECT_EQ(solver_options.dense_linear_algebra_library_type,
+            original_options.dense_linear_algebra_library_type);
+}
+
+TEST(SetBundleAdjustmentBackend, CudaProducesValidSolverOptions) {
+  BundleAdjustmentOptions options;
+  options.backend = BundleAdjustmentBackend::CUDA;
+  for (const ceres::LinearSolverType linear_solver_type :
+       {ceres::DENSE_SCHUR, ceres::SPARSE_SCHUR, ceres::ITERATIVE_SCHUR}) {
+    ceres::Solver::Options solver_options;
+    solver_options.linear_solver_type = linear_solver_type;
+    solver_options.preconditioner_type = ceres::SCHUR_JACOBI;
+    const ceres::Solver::Options original_options = solver_options;
+    if (SetBundleAdjustmentBackend(options, &solver_options)) {
+      std::string error;
+      EXPECT_TRUE(solver_options.IsValid(&error)) << error;
+    } else {
+      // The solver options are left on the CPU.
+      EXPECT_EQ(solver_options.linear_solver_type,
+                original_options.linear_solver_type);
+      EXPECT_EQ(solver_options.sparse_linear_algebra_library_type,
+                original_options.sparse_linear_algebra_library_type);
+      EXPECT_EQ(solver_options.dense_linear_algebra_library_type,
+                original_options.dense_linear_algebra_library_type);
+    }
+  }
+}
+
 }  // namespace theia
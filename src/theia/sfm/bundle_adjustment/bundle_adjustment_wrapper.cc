@@ -11,6 +11,15 @@ BundleAdjustmentSummary BundleAdjustTwoViewsAngularWrapper(
   return ba_summary;
 }
 
+BundleAdjustmentSummary RefineRelativePoseWrapper(
+    const BundleAdjustmentOptions& options,
+    const std::vector<FeatureCorrespondence>& correspondences,
+    TwoViewInfo& two_view_info_prior) {
+  BundleAdjustmentSummary ba_summary =
+      RefineRelativePose(options, correspondences, &two_view_info_prior);
+  return ba_summary;
+}
+
 BundleAdjustmentSummary BundleAdjustViewWrapper(
     Reconstruction& reconstruction,
     const BundleAdjustmentOptions& options,
@@ -113,6 +122,14 @@ BundleAdjustmentSummary BundleAdjustPartialReconstructionWrapper(
     return ba_summary;
 }
 
+BundleAdjustmentSummary BundleAdjustSubReconstructionWrapper(
+    const BundleAdjustmentOptions& options,
+    SubReconstruction& sub_reconstruction) {
+    BundleAdjustmentSummary ba_summary =
+        BundleAdjustSubReconstruction(options, &sub_reconstruction);
+    return ba_summary;
+}
+
 BundleAdjustmentSummary BundleAdjustPartialViewsConstantWrapper(
     const BundleAdjustmentOptions& options,
     const std::vector<ViewId> &var_view_ids,
@@ -3,8 +3,10 @@
 #include "theia/sfm/bundle_adjustment/bundle_adjust_two_views.h"
 #include "theia/sfm/bundle_adjustment/bundle_adjustment.h"
 #include "theia/sfm/bundle_adjustment/optimize_relative_position_with_known_rotation.h"
+#include "theia/sfm/bundle_adjustment/refine_relative_pose.h"
 #include "theia/sfm/camera/camera.h"
 #include "theia/sfm/reconstruction.h"
+#include "theia/sfm/sub_reconstruction.h"
 #include "theia/sfm/twoview_info.h"
 
 namespace theia {
@@ -17,6 +19,11 @@ BundleAdjustmentSummary BundleAdjustTwoViewsAngularWrapper(
     const std::vector<FeatureCorrespondence>& correspondences,
     TwoViewInfo& two_view_info_prior);
 
+BundleAdjustmentSummary RefineRelativePoseWrapper(
+    const BundleAdjustmentOptions& options,
+    const std::vector<FeatureCorrespondence>& correspondences,
+    TwoViewInfo& two_view_info_prior);
+
 BundleAdjustmentSummary BundleAdjustViewWrapper(
     Reconstruction& reconstruction,
     const BundleAdjustmentOptions& options,
@@ -67,6 +74,10 @@ BundleAdjustmentSummary BundleAdjustPartialReconstructionWrapper(
     const std::unordered_set<TrackId>& tracks_to_optimize,
     Reconstruction& reconstruction);
 
+BundleAdjustmentSummary BundleAdjustSubReconstructionWrapper(
+    const BundleAdjustmentOptions& options,
+    SubReconstruction& sub_reconstruction);
+
 BundleAdjustmentSummary BundleAdjustPartialViewsConstantWrapper(
     const BundleAdjustmentOptions& options,
     const std::vector<ViewId>& views_to_optimize,
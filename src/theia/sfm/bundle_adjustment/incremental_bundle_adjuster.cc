@@ -0,0 +1,684 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#include "theia/sfm/bundle_adjustment/incremental_bundle_adjuster.h"
+
+#include <ceres/ceres.h>
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "theia/sfm/bundle_adjustment/bundle_adjustment.h"
+#include "theia/sfm/bundle_adjustment/create_loss_function.h"
+#include "theia/sfm/bundle_adjustment/depth_prior_error.h"
+#include "theia/sfm/bundle_adjustment/gravity_error.h"
+#include "theia/sfm/bundle_adjustment/position_error.h"
+#include "theia/sfm/camera/camera.h"
+#include "theia/sfm/camera/create_reprojection_error_cost_function.h"
+#include "theia/sfm/reconstruction.h"
+#include "theia/sfm/select_track_observations_for_bundle_adjustment.h"
+#include "theia/sfm/track.h"
+#include "theia/sfm/types.h"
+#include "theia/sfm/view.h"
+#include "theia/util/hash.h"
+#include "theia/util/map_util.h"
+#include "theia/util/timer.h"
+#include "theia/util/trace.h"
+
+namespace theia {
+namespace {
+
+static const int kTrackParameterGroup = 0;
+static const int kIntrinsicsParameterGroup = 1;
+static const int kExtrinsicsParameterGroup = 2;
+static const int kPointSize = 4;
+
+// Copies the solver related options. The parameter ordering is left untouched.
+void SetCeresSolverOptions(const BundleAdjustmentOptions& options,
+                           ceres::Solver::Options* solver_options) {
+  solver_options->linear_solver_type = options.linear_solver_type;
+  solver_options->preconditioner_type = options.preconditioner_type;
+  solver_options->visibility_clustering_type =
+      options.visibility_clustering_type;
+  solver_options->logging_type =
+      options.verbose ? ceres::PER_MINIMIZER_ITERATION : ceres::SILENT;
+  solver_options->num_threads = options.num_threads;
+  solver_options->max_num_iterations = options.max_num_iterations;
+  solver_options->max_solver_time_in_seconds =
+      options.max_solver_time_in_seconds;
+  solver_options->use_inner_iterations = options.use_inner_iterations;
+  solver_options->function_tolerance = options.function_tolerance;
+  solver_options->gradient_tolerance = options.gradient_tolerance;
+  solver_options->parameter_tolerance = options.parameter_tolerance;
+  solver_options->max_trust_region_radius = options.max_trust_region_radius;
+  SetBundleAdjustmentBackend(options, solver_options);
+}
+
+ceres::Problem* CreateProblem() {
+  ceres::Problem::Options problem_options;
+  problem_options.loss_function_ownership = ceres::DO_NOT_TAKE_OWNERSHIP;
+  problem_options.manifold_ownership = ceres::DO_NOT_TAKE_OWNERSHIP;
+  // Residuals are removed whenever the set of optimized views changes.
+  problem_options.enable_fast_removal = true;
+  return new ceres::Problem(problem_options);
+}
+
+}  // namespace
+
+IncrementalBundleAdjuster::IncrementalBundleAdjuster(
+    const BundleAdjustmentOptions& options, Reconstruction* reconstruction)
+    : options_(options),
+      reconstruction_(CHECK_NOTNULL(reconstruction)),
+      problem_changed_(true),
+      single_precision_jacobians_(options.use_mixed_precision) {
+  loss_function_ =
+      CreateLossFunction(options.loss_function_type, options.robust_loss_width);
+  depth_prior_loss_function_ = CreateLossFunction(
+      options.loss_function_type, options.robust_loss_width_depth_prior);
+
+  // The extrinsics parameterization only depends on the options so a single
+  // instance is shared by all cameras. The same holds for the points.
+  if (options_.orthographic_camera) {
+    extrinsics_manifold_.reset(new ceres::SubsetManifold(
+        Camera::kExtrinsicsSize, {Camera::POSITION + 2}));
+  } else if (options_.constant_camera_orientation &&
+             !options_.constant_camera_position) {
+    extrinsics_manifold_.reset(new ceres::SubsetManifold(
+        Camera::kExtrinsicsSize,
+        {Camera::ORIENTATION + 0,
+         Camera::ORIENTATION + 1,
+         Camera::ORIENTATION + 2}));
+  } else if (options_.constant_camera_position &&
+             !options_.constant_camera_orientation) {
+    extrinsics_manifold_.reset(new ceres::SubsetManifold(
+        Camera::kExtrinsicsSize,
+        {Camera::POSITION + 0, Camera::POSITION + 1, Camera::POSITION + 2}));
+  }
+  if (options_.use_homogeneous_point_parametrization) {
+    point_manifold_.reset(new ceres::SphereManifold<kPointSize>());
+  }
+
+  problem_.reset(CreateProblem());
+  SetCeresSolverOptions(options_, &solver_options_);
+}
+
+IncrementalBundleAdjuster::~IncrementalBundleAdjuster() {
+  // The problem refers to the loss functions and manifolds, so it must be
+  // destroyed first.
+  problem_.reset();
+}
+
+void IncrementalBundleAdjuster::SetSolverOptions(
+    const BundleAdjustmentOptions& options) {
+  options_.linear_solver_type = options.linear_solver_type;
+  options_.preconditioner_type = options.preconditioner_type;
+  options_.visibility_clustering_type = options.visibility_clustering_type;
+  options_.backend = options.backend;
+  options_.verbose = options.verbose;
+  options_.num_threads = options.num_threads;
+  options_.max_num_iterations = options.max_num_iterations;
+  options_.max_solver_time_in_seconds = options.max_solver_time_in_seconds;
+  options_.use_inner_iterations = options.use_inner_iterations;
+  options_.function_tolerance = options.function_tolerance;
+  options_.gradient_tolerance = options.gradient_tolerance;
+  options_.parameter_tolerance = options.parameter_tolerance;
+  options_.max_trust_region_radius = options.max_trust_region_radius;
+  options_.select_linear_solver_automatically =
+      options.select_linear_solver_automatically;
+  options_.linear_solver_selection_options =
+      options.linear_solver_selection_options;
+  SetCeresSolverOptions(options_, &solver_options_);
+}
+
+void IncrementalBundleAdjuster::Clear() {
+  problem_.reset(CreateProblem());
+  intrinsics_manifolds_.clear();
+  constant_intrinsics_.clear();
+  observations_.clear();
+  view_priors_.clear();
+  num_references_.clear();
+  optimized_views_.clear();
+  optimized_tracks_.clear();
+  problem_changed_ = true;
+}
+
+int IncrementalBundleAdjuster::NumObservations() const {
+  return observations_.size();
+}
+
+uint64_t IncrementalBundleAdjuster::ObservationKey(const ViewId view_id,
+                                                   const TrackId track_id) {
+  return (static_cast<uint64_t>(view_id) << 32) | track_id;
+}
+
+BundleAdjustmentSummary IncrementalBundleAdjuster::Optimize(
+    const std::unordered_set<ViewId>& view_ids,
+    const std::unordered_set<TrackId>& track_ids) {
+  THEIA_TRACE_SCOPE("IncrementalBundleAdjuster::Optimize");
+  Timer timer;
+
+  // Only estimated views and tracks are optimized.
+  std::unordered_set<ViewId> views_to_optimize;
+  for (const ViewId view_id : view_ids) {
+    const View* view = reconstruction_->View(view_id);
+    if (view != nullptr && view->IsEstimated()) {
+      views_to_optimize.emplace(view_id);
+    }
+  }
+  std::unordered_set<TrackId> tracks_to_optimize;
+  for (const TrackId track_id : track_ids) {
+    const Track* track = reconstruction_->Track(track_id);
+    if (track != nullptr && track->IsEstimated()) {
+      tracks_to_optimize.emplace(track_id);
+    }
+  }
+  if (views_to_optimize != optimized_views_ ||
+      tracks_to_optimize != optimized_tracks_) {
+    problem_changed_ = true;
+  }
+
+  std::unordered_set<uint64_t> desired_observations;
+  GetDesiredObservations(
+      views_to_optimize, tracks_to_optimize, &desired_observations);
+
+  // Remove the residuals that are no longer needed or that refer to cameras or
+  // points that the reconstruction has replaced.
+  for (auto it = observations_.begin(); it != observations_.end();) {
+    const Observation& observation = it->second;
+    bool keep = ContainsKey(desired_observations, it->first);
+    if (keep) {
+      Camera* camera =
+          reconstruction_->MutableView(observation.view_id)->MutableCamera();
+      keep = observation.extrinsics == camera->mutable_extrinsics() &&
+             observation.intrinsics == camera->mutable_intrinsics() &&
+             observation.point == reconstruction_->MutableTrack(
+                                      observation.track_id)
+                                      ->MutablePoint()
+                                      ->data();
+    }
+    if (keep) {
+      desired_observations.erase(it->first);
+      ++it;
+      continue;
+    }
+    RemoveObservation(observation);
+    it = observations_.erase(it);
+    problem_changed_ = true;
+  }
+
+  // Add the new residuals.
+  for (const uint64_t key : desired_observations) {
+    if (AddObservation(static_cast<ViewId>(key >> 32),
+                       static_cast<TrackId>(key & 0xFFFFFFFF))) {
+      problem_changed_ = true;
+    }
+  }
+  if (UpdateViewPriors(views_to_optimize)) {
+    problem_changed_ = true;
+  }
+
+  // The constant/variable states and the Schur ordering only depend on the
+  // residuals and the optimized views and tracks.
+  if (problem_changed_) {
+    SetParameterBlockStates(views_to_optimize, tracks_to_optimize);
+    optimized_views_.swap(views_to_optimize);
+    optimized_tracks_.swap(tracks_to_optimize);
+    problem_changed_ = false;
+  }
+
+  if (options_.select_linear_solver_automatically) {
+    SelectLinearSolverFromProblemStructure();
+  }
+
+  // NOTE: csweeney found a thread on the Ceres Solver email group that
+  // indicated using the reverse BA order (i.e., using cameras then points) is a
+  // good idea for inner iterations.
+  if (solver_options_.use_inner_iterations) {
+    solver_options_.inner_iteration_ordering.reset(
+        new ceres::ParameterBlockOrdering(
+            *solver_options_.linear_solver_ordering));
+    solver_options_.inner_iteration_ordering->Reverse();
+  } else {
+    solver_options_.inner_iteration_ordering.reset();
+  }
+
+  // Solve the problem.
+  const double internal_setup_time = timer.ElapsedTimeInSeconds();
+  BundleAdjustmentSummary summary = SolveBundleAdjustmentProblem(
+      options_, solver_options_, &single_precision_jacobians_, problem_.get());
+  summary.setup_time_in_seconds += internal_setup_time;
+  return summary;
+}
+
+void IncrementalBundleAdjuster::GetDesiredObservations(
+    const std::unordered_set<ViewId>& view_ids,
+    const std::unordered_set<TrackId>& track_ids,
+    std::unordered_set<uint64_t>* observations) {
+  selected_track_observations_.clear();
+  views_with_all_observations_.clear();
+
+  for (const ViewId view_id : view_ids) {
+    const View* view = reconstruction_->View(view_id);
+    // Keep all observations of the view if too few of them would be optimized
+    // otherwise.
+    if (options_.max_num_optimized_observations_per_track > 0) {
+      int num_optimized_observations = 0;
+      for (const TrackId track_id : view->TrackIds()) {
+        const Track* track = reconstruction_->Track(track_id);
+        if (track != nullptr && track->IsEstimated() &&
+            IsObservationOptimized(track_id, view_id)) {
+          ++num_optimized_observations;
+        }
+      }
+      if (num_optimized_observations <
+          options_.min_num_optimized_observations_per_view) {
+        views_with_all_observations_.emplace(view_id);
+      }
+    }
+
+    for (const TrackId track_id : view->TrackIds()) {
+      const Track* track = reconstruction_->Track(track_id);
+      if (track != nullptr && track->IsEstimated() &&
+          IsObservationOptimized(track_id, view_id)) {
+        observations->emplace(ObservationKey(view_id, track_id));
+      }
+    }
+  }
+
+  for (const TrackId track_id : track_ids) {
+    for (const ViewId view_id : reconstruction_->Track(track_id)->ViewIds()) {
+      const View* view = reconstruction_->View(view_id);
+      if (view != nullptr && view->IsEstimated() &&
+          IsObservationOptimized(track_id, view_id)) {
+        observations->emplace(ObservationKey(view_id, track_id));
+      }
+    }
+  }
+}
+
+bool IncrementalBundleAdjuster::IsObservationOptimized(const TrackId track_id,
+                                                       const ViewId view_id) {
+  if (options_.max_num_optimized_observations_per_track <= 0 ||
+      ContainsKey(views_with_all_observations_, view_id)) {
+    return true;
+  }
+  const Track* track = reconstruction_->Track(track_id);
+  if (track->NumViews() <= options_.max_num_optimized_observations_per_track) {
+    return true;
+  }
+
+  auto it = selected_track_observations_.find(track_id);
+  if (it == selected_track_observations_.end()) {
+    it = selected_track_observations_
+             .emplace(track_id,
+                      SelectWellSpreadTrackObservations(
+                          *reconstruction_,
+                          track_id,
+                          options_.max_num_optimized_observations_per_track))
+             .first;
+  }
+  return std::binary_search(it->second.begin(), it->second.end(), view_id);
+}
+
+bool IncrementalBundleAdjuster::AddObservation(const ViewId view_id,
+                                               const TrackId track_id) {
+  View* view = reconstruction_->MutableView(view_id);
+  Track* track = reconstruction_->MutableTrack(track_id);
+  const Feature* feature = view->GetFeature(track_id);
+  if (feature == nullptr) {
+    return false;
+  }
+
+  Camera* camera = view->MutableCamera();
+  Observation observation;
+  observation.view_id = view_id;
+  observation.track_id = track_id;
+  observation.extrinsics = camera->mutable_extrinsics();
+  observation.intrinsics = camera->mutable_intrinsics();
+  observation.point = track->MutablePoint()->data();
+
+  AddParameterBlockReference(observation.extrinsics,
+                             Camera::kExtrinsicsSize,
+                             extrinsics_manifold_.get());
+  AddIntrinsicsReference(*camera, observation.intrinsics);
+  AddParameterBlockReference(
+      observation.point, kPointSize, point_manifold_.get());
+  observation.reprojection_residual = problem_->AddResidualBlock(
+      CreateReprojectionErrorCostFunction(
+          camera->GetCameraIntrinsicsModelType(),
+          *feature,
+          options_.use_analytic_reprojection_jacobians ||
+              options_.use_mixed_precision,
+          &single_precision_jacobians_),
+      loss_function_.get(),
+      observation.extrinsics,
+      observation.intrinsics,
+      observation.point);
+
+  // A depth of zero does not make much sense for a camera.
+  if (options_.use_depth_priors && feature->depth_prior() != 0.0) {
+    AddParameterBlockReference(observation.extrinsics,
+                               Camera::kExtrinsicsSize,
+                               extrinsics_manifold_.get());
+    AddParameterBlockReference(
+        observation.point, kPointSize, point_manifold_.get());
+    observation.depth_prior_residual =
+        problem_->AddResidualBlock(DepthPriorError::Create(*feature),
+                                   depth_prior_loss_function_.get(),
+                                   observation.extrinsics,
+                                   observation.point);
+  }
+
+  observations_.emplace(ObservationKey(view_id, track_id), observation);
+  return true;
+}
+
+void IncrementalBundleAdjuster::RemoveObservation(
+    const Observation& observation) {
+  problem_->RemoveResidualBlock(observation.reprojection_residual);
+  RemoveParameterBlockReference(observation.extrinsics);
+  RemoveParameterBlockReference(observation.intrinsics);
+  RemoveParameterBlockReference(observation.point);
+
+  if (observation.depth_prior_residual != nullptr) {
+    problem_->RemoveResidualBlock(observation.depth_prior_residual);
+    RemoveParameterBlockReference(observation.extrinsics);
+    RemoveParameterBlockReference(observation.point);
+  }
+}
+
+bool IncrementalBundleAdjuster::UpdateViewPriors(
+    const std::unordered_set<ViewId>& view_ids) {
+  if (!options_.use_position_priors && !options_.use_gravity_priors) {
+    return false;
+  }
+
+  // Priors are only added for the optimized views.
+  bool changed = false;
+  for (auto it = view_priors_.begin(); it != view_priors_.end();) {
+    const ViewPriors& priors = it->second;
+    if (ContainsKey(view_ids, it->first) &&
+        priors.extrinsics == reconstruction_->MutableView(it->first)
+                                 ->MutableCamera()
+                                 ->mutable_extrinsics()) {
+      ++it;
+      continue;
+    }
+    RemoveViewPriors(priors);
+    it = view_priors_.erase(it);
+    changed = true;
+  }
+
+  for (const ViewId view_id : view_ids) {
+    if (ContainsKey(view_priors_, view_id)) {
+      continue;
+    }
+
+    View* view = reconstruction_->MutableView(view_id);
+    ViewPriors priors;
+    priors.extrinsics = view->MutableCamera()->mutable_extrinsics();
+    if (options_.use_position_priors && view->HasPositionPrior()) {
+      AddParameterBlockReference(priors.extrinsics,
+                                 Camera::kExtrinsicsSize,
+                                 extrinsics_manifold_.get());
+      priors.position_prior_residual = problem_->AddResidualBlock(
+          PositionError::Create(view->GetPositionPrior(),
+                                view->GetPositionPriorSqrtInformation()),
+          NULL,
+          priors.extrinsics);
+    }
+    if (options_.use_gravity_priors && view->HasGravityPrior()) {
+      AddParameterBlockReference(priors.extrinsics,
+                                 Camera::kExtrinsicsSize,
+                                 extrinsics_manifold_.get());
+      priors.gravity_prior_residual = problem_->AddResidualBlock(
+          GravityError::Create(view->GetGravityPrior(),
+                               view->GetGravityPriorSqrtInformation()),
+          NULL,
+          priors.extrinsics);
+    }
+    view_priors_.emplace(view_id, priors);
+    changed = true;
+  }
+  return changed;
+}
+
+void IncrementalBundleAdjuster::RemoveViewPriors(const ViewPriors& priors) {
+  if (priors.position_prior_residual != nullptr) {
+    problem_->RemoveResidualBlock(priors.position_prior_residual);
+    RemoveParameterBlockReference(priors.extrinsics);
+  }
+  if (priors.gravity_prior_residual != nullptr) {
+    problem_->RemoveResidualBlock(priors.gravity_prior_residual);
+    RemoveParameterBlockReference(priors.extrinsics);
+  }
+}
+
+void IncrementalBundleAdjuster::AddParameterBlockReference(
+    double* block, const int size, ceres::Manifold* manifold) {
+  int& num_references = num_references_[block];
+  if (num_references == 0) {
+    if (manifold != nullptr) {
+      problem_->AddParameterBlock(block, size, manifold);
+    } else {
+      problem_->AddParameterBlock(block, size);
+    }
+  }
+  ++num_references;
+}
+
+void IncrementalBundleAdjuster::RemoveParameterBlockReference(double* block) {
+  auto it = num_references_.find(block);
+  CHECK(it != num_references_.end());
+  if (--it->second > 0) {
+    return;
+  }
+
+  // No residual depends on the block anymore, so this is cheap with fast
+  // removal enabled.
+  problem_->RemoveParameterBlock(block);
+  num_references_.erase(it);
+  intrinsics_manifolds_.erase(block);
+  constant_intrinsics_.erase(block);
+}
+
+void IncrementalBundleAdjuster::AddIntrinsicsReference(const Camera& camera,
+                                                       double* intrinsics) {
+  if (ContainsKey(num_references_, intrinsics)) {
+    ++num_references_[intrinsics];
+    return;
+  }
+
+  const CameraIntrinsicsModel& camera_intrinsics = *camera.CameraIntrinsics();
+  const int num_parameters = camera_intrinsics.NumParameters();
+
+  // Get the subset parameterization of the intrinsics to keep constant.
+  const std::vector<int> constant_parameters =
+      camera_intrinsics.GetSubsetFromOptimizeIntrinsicsType(
+          options_.intrinsics_to_optimize);
+  ceres::Manifold* manifold = nullptr;
+  if (static_cast<int>(constant_parameters.size()) == num_parameters) {
+    constant_intrinsics_.emplace(intrinsics);
+  } else if (!constant_parameters.empty()) {
+    manifold = new ceres::SubsetManifold(num_parameters, constant_parameters);
+    intrinsics_manifolds_[intrinsics].reset(manifold);
+  }
+  AddParameterBlockReference(intrinsics, num_parameters, manifold);
+
+  // Set a lower bound for the focal length.
+  const std::vector<int> focal_length_id =
+      camera_intrinsics.GetSubsetFromOptimizeIntrinsicsType(
+          OptimizeIntrinsicsType::ASPECT_RATIO |
+          OptimizeIntrinsicsType::PRINCIPAL_POINTS |
+          OptimizeIntrinsicsType::RADIAL_DISTORTION |
+          OptimizeIntrinsicsType::SKEW |
+          OptimizeIntrinsicsType::TANGENTIAL_DISTORTION);
+  problem_->SetParameterLowerBound(intrinsics, focal_length_id[0], 1.0);
+
+  if (camera_intrinsics.Type() == CameraIntrinsicsModelType::DOUBLE_SPHERE) {
+    problem_->SetParameterLowerBound(intrinsics, 5, -1.0);
+    problem_->SetParameterUpperBound(intrinsics, 5, 1.0);
+    problem_->SetParameterLowerBound(intrinsics, 6, 0.0);
+    problem_->SetParameterUpperBound(intrinsics, 6, 1.0);
+  } else if (camera_intrinsics.Type() ==
+             CameraIntrinsicsModelType::EXTENDED_UNIFIED) {
+    problem_->SetParameterLowerBound(intrinsics, 5, 0.0);
+    problem_->SetParameterUpperBound(intrinsics, 5, 1.0);
+    problem_->SetParameterLowerBound(intrinsics, 6, 0.1);
+  }
+}
+
+void IncrementalBundleAdjuster::SetParameterBlockStates(
+    const std::unordered_set<ViewId>& view_ids,
+    const std::unordered_set<TrackId>& track_ids) {
+  std::unordered_set<CameraIntrinsicsGroupId> optimized_intrinsics_groups;
+  for (const ViewId view_id : view_ids) {
+    optimized_intrinsics_groups.emplace(
+        reconstruction_->CameraIntrinsicsGroupIdFromViewId(view_id));
+  }
+  const bool constant_extrinsics = options_.constant_camera_orientation &&
+                                   options_.constant_camera_position;
+
+  // Every parameter block is visited once even though it is shared by many
+  // observations.
+  std::shared_ptr<ceres::ParameterBlockOrdering> ordering(
+      new ceres::ParameterBlockOrdering);
+  std::unordered_set<double*> visited_blocks;
+  visited_blocks.reserve(num_references_.size());
+  for (const auto& entry : observations_) {
+    const Observation& observation = entry.second;
+    if (visited_blocks.emplace(observation.extrinsics).second) {
+      if (ContainsKey(view_ids, observation.view_id) && !constant_extrinsics) {
+        problem_->SetParameterBlockVariable(observation.extrinsics);
+        ordering->AddElementToGroup(observation.extrinsics,
+                                    kExtrinsicsParameterGroup);
+      } else {
+        problem_->SetParameterBlockConstant(observation.extrinsics);
+      }
+    }
+
+    // The shared intrinsics are only held constant if no camera of the
+    // intrinsics group is optimized.
+    if (visited_blocks.emplace(observation.intrinsics).second) {
+      const CameraIntrinsicsGroupId intrinsics_group_id =
+          reconstruction_->CameraIntrinsicsGroupIdFromViewId(
+              observation.view_id);
+      if (ContainsKey(optimized_intrinsics_groups, intrinsics_group_id) &&
+          !ContainsKey(constant_intrinsics_, observation.intrinsics)) {
+        problem_->SetParameterBlockVariable(observation.intrinsics);
+        ordering->AddElementToGroup(observation.intrinsics,
+                                    kIntrinsicsParameterGroup);
+      } else {
+        problem_->SetParameterBlockConstant(observation.intrinsics);
+      }
+    }
+
+    if (visited_blocks.emplace(observation.point).second) {
+      if (ContainsKey(track_ids, observation.track_id)) {
+        problem_->SetParameterBlockVariable(observation.point);
+        ordering->AddElementToGroup(observation.point, kTrackParameterGroup);
+      } else {
+        problem_->SetParameterBlockConstant(observation.point);
+      }
+    }
+  }
+
+  // Views that only have priors (i.e. observe no estimated track).
+  for (const auto& entry : view_priors_) {
+    if (visited_blocks.emplace(entry.second.extrinsics).second) {
+      if (constant_extrinsics) {
+        problem_->SetParameterBlockConstant(entry.second.extrinsics);
+      } else {
+        problem_->SetParameterBlockVariable(entry.second.extrinsics);
+        ordering->AddElementToGroup(entry.second.extrinsics,
+                                    kExtrinsicsParameterGroup);
+      }
+    }
+  }
+
+  solver_options_.linear_solver_ordering = ordering;
+}
+
+void IncrementalBundleAdjuster::SelectLinearSolverFromProblemStructure() {
+  BundleAdjustmentProblemStructure structure;
+  if (!options_.constant_camera_orientation ||
+      !options_.constant_camera_position) {
+    structure.num_cameras = optimized_views_.size();
+  }
+  if (options_.intrinsics_to_optimize != OptimizeIntrinsicsType::NONE) {
+    std::unordered_set<double*> optimized_intrinsics;
+    for (const ViewId view_id : optimized_views_) {
+      double* intrinsics =
+          reconstruction_->MutableView(view_id)->MutableCamera()
+              ->mutable_intrinsics();
+      if (!ContainsKey(constant_intrinsics_, intrinsics)) {
+        optimized_intrinsics.emplace(intrinsics);
+      }
+    }
+    structure.num_camera_intrinsics_groups = optimized_intrinsics.size();
+  }
+  structure.num_points = optimized_tracks_.size();
+
+  // Count the pairs of optimized views that share an optimized track in the
+  // problem.
+  if (structure.num_cameras > 0) {
+    std::unordered_map<TrackId, std::vector<ViewId> > views_of_track;
+    for (const auto& observation : observations_) {
+      if (ContainsKey(optimized_views_, observation.second.view_id) &&
+          ContainsKey(optimized_tracks_, observation.second.track_id)) {
+        views_of_track[observation.second.track_id].emplace_back(
+            observation.second.view_id);
+      }
+    }
+    std::unordered_set<ViewIdPair> covisible_view_pairs;
+    for (auto& track_views : views_of_track) {
+      std::vector<ViewId>& view_ids = track_views.second;
+      std::sort(view_ids.begin(), view_ids.end());
+      for (int i = 0; i < view_ids.size(); i++) {
+        for (int j = i + 1; j < view_ids.size(); j++) {
+          covisible_view_pairs.emplace(view_ids[i], view_ids[j]);
+        }
+      }
+    }
+    structure.num_covisible_camera_pairs = covisible_view_pairs.size();
+  }
+
+  SelectBundleAdjustmentLinearSolver(options_, structure, &solver_options_);
+}
+
+}  // namespace theia
@@ -0,0 +1,197 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#ifndef THEIA_SFM_BUNDLE_ADJUSTMENT_INCREMENTAL_BUNDLE_ADJUSTER_H_
+#define THEIA_SFM_BUNDLE_ADJUSTMENT_INCREMENTAL_BUNDLE_ADJUSTER_H_
+
+#include <ceres/ceres.h>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "theia/sfm/bundle_adjustment/bundle_adjustment.h"
+#include "theia/sfm/types.h"
+
+namespace theia {
+class Camera;
+class Reconstruction;
+
+// A bundle adjuster that keeps its Ceres problem alive across calls. The
+// BundleAdjuster builds a new problem (residuals, parameterizations and Schur
+// ordering) for every optimization, which during incremental SfM repeats the
+// same work thousands of times for a problem that only grows slowly.
+//
+// Each call to Optimize() describes the desired problem with the same semantics
+// as BundleAdjustPartialReconstruction: the views are optimized, the tracks are
+// optimized, and every other estimated view observing one of the tracks (or
+// estimated track observed by one of the views) is held constant. Only the
+// residuals that differ from the previous call are added to or removed from
+// the problem. Loss functions and parameterizations are created once and
+// shared by all residuals and parameter blocks. When neither the residuals nor
+// the sets of optimized views and tracks changed since the last call, the
+// parameter block states and the Schur ordering are reused as well.
+//
+// The reconstruction may be modified between calls (views and tracks added,
+// removed or set to unestimated); residuals referring to removed or
+// unestimated entities are dropped on the next call.
+class IncrementalBundleAdjuster {
+ public:
+  // The loss function, priors and parameterization options are fixed for the
+  // lifetime of the bundle adjuster.
+  IncrementalBundleAdjuster(const BundleAdjustmentOptions& options,
+                            Reconstruction* reconstruction);
+  ~IncrementalBundleAdjuster();
+
+  // Updates the options that only affect the solver (linear solver type or its
+  // automatic selection, number of threads, iterations, tolerances, inner
+  // iterations and verbosity) for subsequent calls to Optimize.
+  void SetSolverOptions(const BundleAdjustmentOptions& options);
+
+  // Optimizes the given views and tracks as described above.
+  BundleAdjustmentSummary Optimize(const std::unordered_set<ViewId>& view_ids,
+                                   const std::unordered_set<TrackId>& track_ids);
+
+  // Removes all residuals and parameter blocks from the problem.
+  void Clear();
+
+  // The number of observations (view/track pairs) currently in the problem.
+  int NumObservations() const;
+
+ private:
+  // The residuals created for a single observation of a track in a view. The
+  // parameter block pointers are stored so that stale residuals can be detected
+  // if the reconstruction replaced a camera or track.
+  struct Observation {
+    ViewId view_id = kInvalidViewId;
+    TrackId track_id = kInvalidTrackId;
+    ceres::ResidualBlockId reprojection_residual = nullptr;
+    ceres::ResidualBlockId depth_prior_residual = nullptr;
+    double* extrinsics = nullptr;
+    double* intrinsics = nullptr;
+    double* point = nullptr;
+  };
+
+  // The prior residuals of an optimized view.
+  struct ViewPriors {
+    ceres::ResidualBlockId position_prior_residual = nullptr;
+    ceres::ResidualBlockId gravity_prior_residual = nullptr;
+    double* extrinsics = nullptr;
+  };
+
+  static uint64_t ObservationKey(const ViewId view_id, const TrackId track_id);
+
+  // Collects the observations that the problem should contain.
+  void GetDesiredObservations(const std::unordered_set<ViewId>& view_ids,
+                              const std::unordered_set<TrackId>& track_ids,
+                              std::unordered_set<uint64_t>* observations);
+
+  // Returns false if the observation of the track in the view is left out of
+  // the problem by the subsampling of long tracks (see
+  // BundleAdjustmentOptions::max_num_optimized_observations_per_track).
+  bool IsObservationOptimized(const TrackId track_id, const ViewId view_id);
+
+  // Add or remove the residuals of an observation or the priors of a view.
+  // Returns true if the problem changed.
+  bool AddObservation(const ViewId view_id, const TrackId track_id);
+  void RemoveObservation(const Observation& observation);
+  bool UpdateViewPriors(const std::unordered_set<ViewId>& view_ids);
+  void RemoveViewPriors(const ViewPriors& priors);
+
+  // Reference counting of parameter blocks. Parameter blocks are added with
+  // their parameterization on the first reference and removed from the problem
+  // once no residual depends on them.
+  void AddParameterBlockReference(double* block,
+                                  const int size,
+                                  ceres::Manifold* manifold);
+  void RemoveParameterBlockReference(double* block);
+
+  // Adds the intrinsics block of the camera with its bounds and
+  // parameterization on the first reference.
+  void AddIntrinsicsReference(const Camera& camera, double* intrinsics);
+
+  // Sets the parameter blocks constant or variable, applies the intrinsics
+  // parameterizations and bounds and rebuilds the Schur ordering.
+  void SetParameterBlockStates(const std::unordered_set<ViewId>& view_ids,
+                               const std::unordered_set<TrackId>& track_ids);
+
+  // Sets the linear solver and preconditioner with SelectLinearSolver from the
+  // optimized views and tracks and the observations in the problem.
+  void SelectLinearSolverFromProblemStructure();
+
+  BundleAdjustmentOptions options_;
+  Reconstruction* reconstruction_;
+
+  std::unique_ptr<ceres::Problem> problem_;
+  ceres::Solver::Options solver_options_;
+
+  // Shared loss functions and parameterizations. The problem does not take
+  // ownership of them.
+  std::unique_ptr<ceres::LossFunction> loss_function_;
+  std::unique_ptr<ceres::LossFunction> depth_prior_loss_function_;
+  std::unique_ptr<ceres::Manifold> extrinsics_manifold_;
+  std::unique_ptr<ceres::Manifold> point_manifold_;
+  std::unordered_map<double*, std::unique_ptr<ceres::Manifold> >
+      intrinsics_manifolds_;
+
+  // Intrinsics blocks for which no parameter is optimized.
+  std::unordered_set<double*> constant_intrinsics_;
+
+  // The subsampled observations of long tracks and the optimized views that
+  // keep all of their observations. Both are selected anew for every call
+  // since the views of the tracks and their positions change between calls.
+  std::unordered_map<TrackId, std::vector<ViewId> >
+      selected_track_observations_;
+  std::unordered_set<ViewId> views_with_all_observations_;
+
+  std::unordered_map<uint64_t, Observation> observations_;
+  std::unordered_map<ViewId, ViewPriors> view_priors_;
+  std::unordered_map<double*, int> num_references_;
+
+  // The optimized views and tracks of the last call, used to detect whether
+  // the parameter states and the ordering can be reused.
+  std::unordered_set<ViewId> optimized_views_;
+  std::unordered_set<TrackId> optimized_tracks_;
+  bool problem_changed_;
+
+  // Whether the reprojection errors currently compute single precision
+  // Jacobians. Only used with mixed precision bundle adjustment, which is
+  // fixed for the lifetime of the bundle adjuster.
+  bool single_precision_jacobians_;
+};
+
+}  // namespace theia
+
+#endif  // THEIA_SFM_BUNDLE_ADJUSTMENT_INCREMENTAL_BUNDLE_ADJUSTER_H_
@@ -0,0 +1,224 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#include <Eigen/Core>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "theia/sfm/bundle_adjustment/bundle_adjustment.h"
+#include "theia/sfm/bundle_adjustment/incremental_bundle_adjuster.h"
+#include "theia/sfm/camera/camera.h"
+#include "theia/sfm/reconstruction.h"
+#include "theia/sfm/types.h"
+#include "theia/util/random.h"
+#include "gtest/gtest.h"
+
+namespace theia {
+
+namespace {
+RandomNumberGenerator rng(59);
+
+// Creates a reconstruction with cameras along the x axis looking at random
+// points in front of them. Every point is observed by every camera.
+void BuildReconstruction(const int num_views,
+                         const int num_points,
+                         Reconstruction* reconstruction) {
+  for (int i = 0; i < num_views; i++) {
+    const ViewId view_id =
+        reconstruction->AddView(std::to_string(i), 0, static_cast<double>(i));
+    Camera* camera = reconstruction->MutableView(view_id)->MutableCamera();
+    camera->SetPosition(Eigen::Vector3d(i, 0, 0));
+    camera->SetOrientationFromAngleAxis(Eigen::Vector3d::Zero());
+    camera->SetImageSize(1000, 1000);
+    camera->SetFocalLength(500);
+    camera->SetPrincipalPoint(500, 500);
+    reconstruction->MutableView(view_id)->SetEstimated(true);
+  }
+
+  for (int i = 0; i < num_points; i++) {
+    const Eigen::Vector3d point(rng.RandDouble(-5.0, 5.0),
+                                rng.RandDouble(-5.0, 5.0),
+                                rng.RandDouble(8.0, 12.0));
+    const TrackId track_id = reconstruction->AddTrack();
+    Track* track = reconstruction->MutableTrack(track_id);
+    track->SetPoint(point.homogeneous());
+    track->SetEstimated(true);
+    for (const ViewId view_id : reconstruction->ViewIds()) {
+      Eigen::Vector2d pixel;
+      reconstruction->View(view_id)->Camera().ProjectPoint(point.homogeneous(),
+                                                           &pixel);
+      reconstruction->AddObservation(view_id, track_id, Feature(pixel));
+    }
+  }
+}
+
+}  // namespace
+
+TEST(IncrementalBundleAdjuster, ReusesObservationsAcrossCalls) {
+  static const int kNumViews = 4;
+  static const int kNumPoints = 50;
+  Reconstruction reconstruction;
+  BuildReconstruction(kNumViews, kNumPoints, &reconstruction);
+
+  const std::vector<TrackId> track_ids = reconstruction.TrackIds();
+  const std::unordered_set<TrackId> all_tracks(track_ids.begin(),
+                                               track_ids.end());
+
+  BundleAdjustmentOptions options;
+  options.num_threads = 1;
+  options.linear_solver_type = ceres::DENSE_SCHUR;
+  options.use_inner_iterations = false;
+  IncrementalBundleAdjuster bundle_adjuster(options, &reconstruction);
+
+  // Optimizing view 1 adds residuals for all points it observes, and the
+  // points' other observations are added for the optimized tracks.
+  BundleAdjustmentSummary summary =
+      bundle_adjuster.Optimize({1}, all_tracks);
+  EXPECT_TRUE(summary.success);
+  EXPECT_EQ(bundle_adjuster.NumObservations(), kNumViews * kNumPoints);
+
+  // Without optimized tracks only the observations of the optimized views
+  // remain in the problem.
+  summary = bundle_adjuster.Optimize({2, 3}, {});
+  EXPECT_TRUE(summary.success);
+  EXPECT_EQ(bundle_adjuster.NumObservations(), 2 * kNumPoints);
+
+  // Tracks that are set to unestimated are dropped from the problem.
+  reconstruction.MutableTrack(track_ids[0])->SetEstimated(false);
+  summary = bundle_adjuster.Optimize({2, 3}, {});
+  EXPECT_EQ(bundle_adjuster.NumObservations(), 2 * (kNumPoints - 1));
+
+  bundle_adjuster.Clear();
+  EXPECT_EQ(bundle_adjuster.NumObservations(), 0);
+}
+
+TEST(IncrementalBundleAdjuster, SubsamplesLongTracks) {
+  static const int kNumViews = 8;
+  static const int kNumPoints = 50;
+  static const int kMaxNumObservationsPerTrack = 3;
+  Reconstruction reconstruction;
+  BuildReconstruction(kNumViews, kNumPoints, &reconstruction);
+
+  const std::vector<TrackId> track_ids = reconstruction.TrackIds();
+  const std::unordered_set<TrackId> all_tracks(track_ids.begin(),
+                                               track_ids.end());
+
+  BundleAdjustmentOptions options;
+  options.num_threads = 1;
+  options.linear_solver_type = ceres::DENSE_SCHUR;
+  options.use_inner_iterations = false;
+  options.max_num_optimized_observations_per_track =
+      kMaxNumObservationsPerTrack;
+  options.min_num_optimized_observations_per_view = kNumPoints + 1;
+  IncrementalBundleAdjuster bundle_adjuster(options, &reconstruction);
+
+  // Only the selected observations of the optimized tracks are added.
+  BundleAdjustmentSummary summary = bundle_adjuster.Optimize({}, all_tracks);
+  EXPECT_TRUE(summary.success);
+  EXPECT_EQ(bundle_adjuster.NumObservations(),
+            kMaxNumObservationsPerTrack * kNumPoints);
+
+  // An optimized view that would keep too few observations keeps all of them.
+  summary = bundle_adjuster.Optimize({1}, {});
+  EXPECT_TRUE(summary.success);
+  EXPECT_EQ(bundle_adjuster.NumObservations(), kNumPoints);
+}
+
+TEST(IncrementalBundleAdjuster, SelectsLinearSolverAutomatically) {
+  static const int kNumViews = 4;
+  static const int kNumPoints = 50;
+  Reconstruction reconstruction;
+  BuildReconstruction(kNumViews, kNumPoints, &reconstruction);
+
+  const std::vector<TrackId> track_ids = reconstruction.TrackIds();
+  const std::unordered_set<TrackId> all_tracks(track_ids.begin(),
+                                               track_ids.end());
+
+  BundleAdjustmentOptions options;
+  options.num_threads = 1;
+  options.linear_solver_type = ceres::SPARSE_SCHUR;
+  options.use_inner_iterations = false;
+  options.select_linear_solver_automatically = true;
+  IncrementalBundleAdjuster bundle_adjuster(options, &reconstruction);
+
+  // The reduced camera system of a few cameras is solved densely.
+  BundleAdjustmentSummary summary =
+      bundle_adjuster.Optimize({1, 2}, all_tracks);
+  EXPECT_TRUE(summary.success);
+  EXPECT_EQ(summary.linear_solver_type, ceres::DENSE_SCHUR);
+
+  // The solver is selected again for every call, here with thresholds under
+  // which the same problem is large.
+  options.linear_solver_selection_options.max_blocks_for_small_dense_schur = 1;
+  options.linear_solver_selection_options.max_blocks_for_dense_schur = 1;
+  options.linear_solver_selection_options.min_blocks_for_iterative_schur = 2;
+  bundle_adjuster.SetSolverOptions(options);
+  summary = bundle_adjuster.Optimize({1, 2}, all_tracks);
+  EXPECT_TRUE(summary.success);
+  EXPECT_EQ(summary.linear_solver_type, ceres::ITERATIVE_SCHUR);
+
+  // Without automatic selection the linear solver of the options is used.
+  options.select_linear_solver_automatically = false;
+  bundle_adjuster.SetSolverOptions(options);
+  summary = bundle_adjuster.Optimize({1, 2}, all_tracks);
+  EXPECT_EQ(summary.linear_solver_type, ceres::SPARSE_SCHUR);
+}
+
+TEST(IncrementalBundleAdjuster, RecoversPerturbedView) {
+  static const int kNumViews = 3;
+  static const int kNumPoints = 100;
+  Reconstruction reconstruction;
+  BuildReconstruction(kNumViews, kNumPoints, &reconstruction);
+
+  BundleAdjustmentOptions options;
+  options.num_threads = 1;
+  options.linear_solver_type = ceres::DENSE_SCHUR;
+  options.use_inner_iterations = false;
+  IncrementalBundleAdjuster bundle_adjuster(options, &reconstruction);
+
+  // Perturb one view and optimize it repeatedly with the points held
+  // constant. The problem is reused between calls.
+  Camera* camera = reconstruction.MutableView(2)->MutableCamera();
+  const Eigen::Vector3d position = camera->GetPosition();
+  camera->SetPosition(position + Eigen::Vector3d(0.05, -0.05, 0.05));
+  for (int i = 0; i < 2; i++) {
+    const BundleAdjustmentSummary summary =
+        bundle_adjuster.Optimize({2}, {});
+    EXPECT_TRUE(summary.success);
+  }
+  EXPECT_LT((camera->GetPosition() - position).norm(), 1e-6);
+}
+
+}  // namespace theia
@@ -0,0 +1,383 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#include "theia/sfm/bundle_adjustment/marginal_covariance.h"
+
+#include <Eigen/Core>
+#include <Eigen/Eigenvalues>
+#include <Eigen/SparseCholesky>
+#include <Eigen/SparseCore>
+#include <ceres/ceres.h>
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "theia/util/executor.h"
+#include "theia/util/map_util.h"
+
+namespace theia {
+
+namespace {
+
+typedef Eigen::SparseMatrix<double> SparseMatrix;
+
+// A requested covariance block along with the rows and columns of S^-1 it
+// depends on.
+struct CovarianceRequest {
+  const double* parameter_block;
+  bool eliminated;
+  // Offset and size of the parameter block in its part of the Jacobian.
+  int offset;
+  int size;
+  // Sorted indices of the reduced system that this block depends on and the
+  // corresponding submatrix of S^-1.
+  std::vector<int> reduced_indices;
+  Eigen::MatrixXd reduced_inverse;
+};
+
+// Inverts a symmetric positive definite matrix. Returns false if the matrix is
+// rank deficient.
+bool InvertSymmetric(const Eigen::MatrixXd& matrix,
+                     const double min_relative_pivot,
+                     Eigen::MatrixXd* inverse) {
+  const Eigen::SelfAdjointEigenSolver<Eigen::MatrixXd> eigen_solver(matrix);
+  if (eigen_solver.info() != Eigen::Success) {
+    return false;
+  }
+  const Eigen::VectorXd& eigenvalues = eigen_solver.eigenvalues();
+  if (eigenvalues.size() == 0 ||
+      eigenvalues(0) <= min_relative_pivot * eigenvalues.maxCoeff()) {
+    return false;
+  }
+  *inverse = eigen_solver.eigenvectors() *
+             eigenvalues.cwiseInverse().asDiagonal() *
+             eigen_solver.eigenvectors().transpose();
+  return true;
+}
+
+}  // namespace
+
+MarginalCovarianceEstimator::MarginalCovarianceEstimator(
+    const MarginalCovarianceOptions& options)
+    : options_(options) {
+  CHECK_GT(options_.num_threads, 0);
+  CHECK_GT(options_.max_memory_in_bytes, 0);
+}
+
+bool MarginalCovarianceEstimator::Compute(
+    const std::vector<const double*>& covariance_blocks,
+    const std::unordered_set<const double*>& eliminated_blocks,
+    ceres::Problem* problem) {
+  CHECK_NOTNULL(problem);
+  covariances_.clear();
+
+  // Split the variable parameter blocks into reduced and eliminated blocks and
+  // determine their columns in the Jacobian. The reduced blocks come first.
+  std::vector<double*> parameter_blocks;
+  problem->GetParameterBlocks(&parameter_blocks);
+  std::vector<double*> reduced_parameter_blocks, eliminated_parameter_blocks;
+  for (double* parameter_block : parameter_blocks) {
+    if (problem->IsParameterBlockConstant(parameter_block)) {
+      continue;
+    }
+    if (ContainsKey(eliminated_blocks, parameter_block)) {
+      eliminated_parameter_blocks.emplace_back(parameter_block);
+    } else {
+      reduced_parameter_blocks.emplace_back(parameter_block);
+    }
+  }
+
+  std::unordered_map<const double*, std::pair<int, int> > columns;
+  int num_reduced_cols = 0;
+  for (const double* parameter_block : reduced_parameter_blocks) {
+    const int size = problem->ParameterBlockTangentSize(parameter_block);
+    columns[parameter_block] = std::make_pair(num_reduced_cols, size);
+    num_reduced_cols += size;
+  }
+  int num_eliminated_cols = 0;
+  for (const double* parameter_block : eliminated_parameter_blocks) {
+    const int size = problem->ParameterBlockTangentSize(parameter_block);
+    columns[parameter_block] = std::make_pair(num_eliminated_cols, size);
+    num_eliminated_cols += size;
+  }
+
+  std::vector<CovarianceRequest> requests;
+  requests.reserve(covariance_blocks.size());
+  for (const double* parameter_block : covariance_blocks) {
+    const std::pair<int, int>* column =
+        FindOrNull(columns, parameter_block);
+    if (column == nullptr) {
+      LOG(ERROR) << "Cannot compute the covariance of a parameter block that "
+                    "is not a variable parameter block of the problem.";
+      return false;
+    }
+    CovarianceRequest request;
+    request.parameter_block = parameter_block;
+    request.eliminated = ContainsKey(eliminated_blocks, parameter_block);
+    request.offset = column->first;
+    request.size = column->second;
+    requests.emplace_back(request);
+  }
+
+  // Evaluate the Jacobian in the tangent space.
+  ceres::Problem::EvaluateOptions evaluate_options;
+  evaluate_options.parameter_blocks = reduced_parameter_blocks;
+  evaluate_options.parameter_blocks.insert(
+      evaluate_options.parameter_blocks.end(),
+      eliminated_parameter_blocks.begin(),
+      eliminated_parameter_blocks.end());
+  evaluate_options.apply_loss_function = options_.apply_loss_function;
+  evaluate_options.num_threads = AvailableNumThreads(options_.num_threads);
+  ceres::CRSMatrix crs_jacobian;
+  if (!problem->Evaluate(
+          evaluate_options, nullptr, nullptr, nullptr, &crs_jacobian)) {
+    LOG(ERROR) << "Could not evaluate the Jacobian of the problem.";
+    return false;
+  }
+
+  std::vector<Eigen::Triplet<double> > triplets;
+  triplets.reserve(crs_jacobian.values.size());
+  for (int row = 0; row < crs_jacobian.num_rows; row++) {
+    for (int i = crs_jacobian.rows[row]; i < crs_jacobian.rows[row + 1]; i++) {
+      triplets.emplace_back(row, crs_jacobian.cols[i], crs_jacobian.values[i]);
+    }
+  }
+  SparseMatrix jacobian(crs_jacobian.num_rows, crs_jacobian.num_cols);
+  jacobian.setFromTriplets(triplets.begin(), triplets.end());
+  const SparseMatrix jacobian_reduced = jacobian.leftCols(num_reduced_cols);
+  const SparseMatrix jacobian_eliminated =
+      jacobian.rightCols(num_eliminated_cols);
+
+  // Invert the block diagonal H_ee.
+  const SparseMatrix hessian_ee =
+      jacobian_eliminated.transpose() * jacobian_eliminated;
+  std::vector<Eigen::MatrixXd> hessian_ee_inverses(
+      eliminated_parameter_blocks.size());
+  std::vector<char> is_invertible(eliminated_parameter_blocks.size(), 0);
+  ParallelFor(options_.num_threads,
+              eliminated_parameter_blocks.size(),
+              [&](const int start, const int end) {
+                for (int i = start; i < end; i++) {
+                  const std::pair<int, int>& column =
+                      columns[eliminated_parameter_blocks[i]];
+                  const Eigen::MatrixXd block(hessian_ee.block(
+                      column.first, column.first, column.second, column.second));
+                  is_invertible[i] = InvertSymmetric(block,
+                                                     options_.min_relative_pivot,
+                                                     &hessian_ee_inverses[i]);
+                }
+              });
+  if (std::find(is_invertible.begin(), is_invertible.end(), 0) !=
+      is_invertible.end()) {
+    LOG(ERROR) << "The Hessian of an eliminated parameter block is rank "
+                  "deficient. Cannot compute the covariances.";
+    return false;
+  }
+
+  std::unordered_map<const double*, int> eliminated_index;
+  triplets.clear();
+  for (int i = 0; i < eliminated_parameter_blocks.size(); i++) {
+    eliminated_index[eliminated_parameter_blocks[i]] = i;
+    const int offset = columns[eliminated_parameter_blocks[i]].first;
+    const Eigen::MatrixXd& inverse = hessian_ee_inverses[i];
+    for (int r = 0; r < inverse.rows(); r++) {
+      for (int c = 0; c < inverse.cols(); c++) {
+        triplets.emplace_back(offset + r, offset + c, inverse(r, c));
+      }
+    }
+  }
+  SparseMatrix hessian_ee_inverse(num_eliminated_cols, num_eliminated_cols);
+  hessian_ee_inverse.setFromTriplets(triplets.begin(), triplets.end());
+
+  // Form and factorize the Schur complement of the eliminated blocks.
+  const SparseMatrix hessian_re =
+      jacobian_reduced.transpose() * jacobian_eliminated;
+  Eigen::SimplicialLDLT<SparseMatrix> schur_ldlt;
+  if (num_reduced_cols > 0) {
+    const SparseMatrix hessian_rr =
+        jacobian_reduced.transpose() * jacobian_reduced;
+    const SparseMatrix hessian_re_ee_inverse =
+        hessian_re * hessian_ee_inverse;
+    const SparseMatrix schur_complement =
+        hessian_rr - hessian_re_ee_inverse * SparseMatrix(hessian_re.transpose());
+    schur_ldlt.compute(schur_complement);
+    if (schur_ldlt.info() != Eigen::Success) {
+      LOG(ERROR) << "Could not factorize the reduced system.";
+      return false;
+    }
+    const Eigen::VectorXd& pivots = schur_ldlt.vectorD();
+    if (pivots.minCoeff() <= options_.min_relative_pivot * pivots.maxCoeff()) {
+      LOG(ERROR) << "The reduced system is rank deficient. Make sure that the "
+                    "gauge of the problem is fixed.";
+      return false;
+    }
+  }
+
+  // Determine the columns of S^-1 that each request depends on.
+  std::unordered_map<int, std::vector<std::pair<int, int> > > column_consumers;
+  for (int i = 0; i < requests.size(); i++) {
+    CovarianceRequest& request = requests[i];
+    if (!request.eliminated) {
+      for (int j = 0; j < request.size; j++) {
+        request.reduced_indices.emplace_back(request.offset + j);
+      }
+    } else {
+      for (int c = request.offset; c < request.offset + request.size; c++) {
+        for (SparseMatrix::InnerIterator it(hessian_re, c); it; ++it) {
+          request.reduced_indices.emplace_back(it.row());
+        }
+      }
+      std::sort(request.reduced_indices.begin(), request.reduced_indices.end());
+      request.reduced_indices.erase(std::unique(request.reduced_indices.begin(),
+                                                request.reduced_indices.end()),
+                                    request.reduced_indices.end());
+    }
+    const int num_indices = request.reduced_indices.size();
+    request.reduced_inverse.resize(num_indices, num_indices);
+    for (int j = 0; j < num_indices; j++) {
+      column_consumers[request.reduced_indices[j]].emplace_back(i, j);
+    }
+  }
+
+  // Compute the needed columns of S^-1 in batches. At most num_threads
+  // batches of num_reduced_cols x columns_per_batch are alive at any time.
+  std::vector<int> needed_columns;
+  needed_columns.reserve(column_consumers.size());
+  for (const auto& column_consumer : column_consumers) {
+    needed_columns.emplace_back(column_consumer.first);
+  }
+  std::sort(needed_columns.begin(), needed_columns.end());
+  const int64_t bytes_per_column =
+      std::max<int64_t>(1, sizeof(double) * num_reduced_cols);
+  const int columns_per_batch = static_cast<int>(std::max<int64_t>(
+      1,
+      options_.max_memory_in_bytes /
+          (bytes_per_column * options_.num_threads)));
+  const int num_batches =
+      (needed_columns.size() + columns_per_batch - 1) / columns_per_batch;
+  VLOG(2) << "Computing " << needed_columns.size() << " of "
+          << num_reduced_cols << " columns of the inverse reduced system in "
+          << num_batches << " batches.";
+  ParallelFor(
+      options_.num_threads,
+      num_batches,
+      [&](const int start, const int end) {
+        for (int batch = start; batch < end; batch++) {
+          const int first = batch * columns_per_batch;
+          const int last = std::min<int>(first + columns_per_batch,
+                                         needed_columns.size());
+          Eigen::MatrixXd identity =
+              Eigen::MatrixXd::Zero(num_reduced_cols, last - first);
+          for (int j = first; j < last; j++) {
+            identity(needed_columns[j], j - first) = 1.0;
+          }
+          const Eigen::MatrixXd inverse_columns = schur_ldlt.solve(identity);
+          // Each column of a request is written by exactly one batch.
+          for (int j = first; j < last; j++) {
+            for (const std::pair<int, int>& consumer :
+                 column_consumers.at(needed_columns[j])) {
+              CovarianceRequest& request = requests[consumer.first];
+              for (int k = 0; k < request.reduced_indices.size(); k++) {
+                request.reduced_inverse(k, consumer.second) =
+                    inverse_columns(request.reduced_indices[k], j - first);
+              }
+            }
+          }
+        }
+      });
+
+  // Assemble the covariances.
+  std::vector<Eigen::MatrixXd> covariances(requests.size());
+  ParallelFor(
+      options_.num_threads,
+      requests.size(),
+      [&](const int start, const int end) {
+        for (int i = start; i < end; i++) {
+          const CovarianceRequest& request = requests[i];
+          if (!request.eliminated) {
+            covariances[i] = request.reduced_inverse;
+            continue;
+          }
+
+          const Eigen::MatrixXd& hessian_inverse = hessian_ee_inverses
+              [eliminated_index.at(request.parameter_block)];
+          covariances[i] = hessian_inverse;
+          if (request.reduced_indices.empty()) {
+            continue;
+          }
+
+          // The rows of H_re of the block restricted to the reduced indices.
+          Eigen::MatrixXd hessian_block = Eigen::MatrixXd::Zero(
+              request.reduced_indices.size(), request.size);
+          for (int c = 0; c < request.size; c++) {
+            for (SparseMatrix::InnerIterator it(hessian_re, request.offset + c);
+                 it;
+                 ++it) {
+              const int k = std::lower_bound(request.reduced_indices.begin(),
+                                             request.reduced_indices.end(),
+                                             it.row()) -
+                            request.reduced_indices.begin();
+              hessian_block(k, c) = it.value();
+            }
+          }
+          const Eigen::MatrixXd projection = hessian_block * hessian_inverse;
+          covariances[i] += projection.transpose() * request.reduced_inverse *
+                            projection;
+        }
+      });
+
+  for (int i = 0; i < requests.size(); i++) {
+    covariances_[requests[i].parameter_block] = covariances[i];
+  }
+  return true;
+}
+
+bool MarginalCovarianceEstimator::GetCovarianceBlock(
+    const double* parameter_block, Eigen::MatrixXd* covariance) const {
+  CHECK_NOTNULL(covariance);
+  const Eigen::MatrixXd* block = FindOrNull(covariances_, parameter_block);
+  if (block == nullptr) {
+    return false;
+  }
+  *covariance = *block;
+  return true;
+}
+
+}  // namespace theia
@@ -0,0 +1,114 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#ifndef THEIA_SFM_BUNDLE_ADJUSTMENT_MARGINAL_COVARIANCE_H_
+#define THEIA_SFM_BUNDLE_ADJUSTMENT_MARGINAL_COVARIANCE_H_
+
+#include <Eigen/Core>
+#include <ceres/ceres.h>
+#include <cstdint>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace theia {
+
+struct MarginalCovarianceOptions {
+  // Number of threads used to evaluate the Jacobian and to compute the
+  // covariance blocks.
+  int num_threads = 1;
+
+  // The columns of the inverse of the reduced system are computed in batches.
+  // This bounds the memory used by all batches that are processed at the same
+  // time.
+  int64_t max_memory_in_bytes = int64_t(1) << 30;
+
+  // Systems (or eliminated blocks) with a pivot smaller than this fraction of
+  // the largest pivot are considered rank deficient, in which case no
+  // covariance is computed.
+  double min_relative_pivot = 1e-14;
+
+  // Whether the robust loss functions are applied to the Jacobian, as in
+  // ceres::Covariance.
+  bool apply_loss_function = true;
+};
+
+// Computes selected marginal covariance blocks of a least squares problem, i.e.
+// blocks of the inverse of J^T * J where J is the Jacobian at the current
+// parameters in the tangent space of the parameter blocks. Constant parameter
+// blocks are treated as known.
+//
+// Unlike ceres::Covariance, which factorizes the Jacobian of the whole
+// problem, the eliminated parameter blocks (typically the 3D points, which do
+// not share residuals with each other) are first removed with the Schur
+// complement:
+//
+//   S = H_rr - H_re * H_ee^-1 * H_er.
+//
+// S is factorized with a sparse LDLT and only the columns of S^-1 that are
+// needed for the requested blocks are computed, in parallel batches that fit
+// into the memory budget. The covariance of a reduced block is the
+// corresponding block of S^-1 and the covariance of an eliminated block e is
+//
+//   H_ee^-1 + H_ee^-1 * H_er * S^-1 * H_re * H_ee^-1,
+//
+// which only involves the columns of S^-1 of the reduced blocks that share a
+// residual with e. The gauge of the problem must be fixed (e.g. by constant
+// parameter blocks or priors), otherwise the system is rank deficient.
+class MarginalCovarianceEstimator {
+ public:
+  explicit MarginalCovarianceEstimator(const MarginalCovarianceOptions& options);
+
+  // Computes the covariances of the covariance blocks. All eliminated blocks
+  // must be variable parameter blocks that do not share a residual with any
+  // other eliminated block. Returns false if a covariance block is not a
+  // variable parameter block of the problem or if the system is rank
+  // deficient.
+  bool Compute(const std::vector<const double*>& covariance_blocks,
+               const std::unordered_set<const double*>& eliminated_blocks,
+               ceres::Problem* problem);
+
+  // Returns the covariance of a block passed to Compute in the tangent space of
+  // the parameter block, or false if it was not computed.
+  bool GetCovarianceBlock(const double* parameter_block,
+                          Eigen::MatrixXd* covariance) const;
+
+ private:
+  const MarginalCovarianceOptions options_;
+  std::unordered_map<const double*, Eigen::MatrixXd> covariances_;
+};
+
+}  // namespace theia
+
+#endif  // THEIA_SFM_BUNDLE_ADJUSTMENT_MARGINAL_COVARIANCE_H_
@@ -0,0 +1,271 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#include <Eigen/Core>
+#include <Eigen/LU>
+#include <ceres/ceres.h>
+
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "theia/sfm/bundle_adjustment/marginal_covariance.h"
+#include "theia/util/random.h"
+
+namespace theia {
+
+namespace {
+
+// A linear residual A_1 * x_1 + ... + A_n * x_n whose Jacobians are the
+// matrices A_i.
+class LinearCostFunction : public ceres::CostFunction {
+ public:
+  explicit LinearCostFunction(const std::vector<Eigen::MatrixXd>& jacobians)
+      : jacobians_(jacobians) {
+    set_num_residuals(jacobians_[0].rows());
+    for (const Eigen::MatrixXd& jacobian : jacobians_) {
+      mutable_parameter_block_sizes()->push_back(jacobian.cols());
+    }
+  }
+
+  bool Evaluate(double const* const* parameters,
+                double* residuals,
+                double** jacobians) const override {
+    Eigen::Map<Eigen::VectorXd> residual(residuals, num_residuals());
+    residual.setZero();
+    for (int i = 0; i < jacobians_.size(); i++) {
+      residual += jacobians_[i] *
+                  Eigen::Map<const Eigen::VectorXd>(parameters[i],
+                                                    jacobians_[i].cols());
+      if (jacobians != nullptr && jacobians[i] != nullptr) {
+        Eigen::Map<Eigen::Matrix<double,
+                                 Eigen::Dynamic,
+                                 Eigen::Dynamic,
+                                 Eigen::RowMajor> >(
+            jacobians[i], jacobians_[i].rows(), jacobians_[i].cols()) =
+            jacobians_[i];
+      }
+    }
+    return true;
+  }
+
+ private:
+  const std::vector<Eigen::MatrixXd> jacobians_;
+};
+
+// A problem with 6-dimensional "cameras" and 3-dimensional "points" where
+// every point is observed by 3 of 4 cameras, optionally with priors on the
+// cameras.
+class MarginalCovarianceProblem {
+ public:
+  explicit MarginalCovarianceProblem(const bool add_priors)
+      : cameras_(kNumCameras, Eigen::VectorXd::Zero(6)),
+        points_(kNumPoints, Eigen::VectorXd::Zero(3)) {
+    RandomNumberGenerator rng(52);
+    int num_residuals = 0;
+    for (int p = 0; p < kNumPoints; p++) {
+      for (int c = 0; c < kNumCameras; c++) {
+        if ((p + c) % kNumCameras == 0) {
+          continue;
+        }
+        AddResidual({cameras_[c].data(), points_[p].data()},
+                    {RandomMatrix(&rng, 2, 6), RandomMatrix(&rng, 2, 3)});
+      }
+    }
+    if (add_priors) {
+      for (int c = 0; c < kNumCameras; c++) {
+        AddResidual({cameras_[c].data()}, {RandomMatrix(&rng, 6, 6)});
+      }
+    }
+  }
+
+  // Returns the covariance of a parameter block by inverting the dense normal
+  // equations of the variable parameter blocks.
+  Eigen::MatrixXd ExpectedCovariance(const double* parameter_block) const {
+    std::unordered_map<const double*, int> offsets;
+    int num_cols = 0;
+    for (const Eigen::VectorXd& camera : cameras_) {
+      if (!problem_.IsParameterBlockConstant(camera.data())) {
+        offsets[camera.data()] = num_cols;
+        num_cols += camera.size();
+      }
+    }
+    for (const Eigen::VectorXd& point : points_) {
+      offsets[point.data()] = num_cols;
+      num_cols += point.size();
+    }
+
+    Eigen::MatrixXd hessian = Eigen::MatrixXd::Zero(num_cols, num_cols);
+    for (const auto& residual : residuals_) {
+      Eigen::MatrixXd jacobian =
+          Eigen::MatrixXd::Zero(residual.second[0].rows(), num_cols);
+      for (int i = 0; i < residual.first.size(); i++) {
+        if (offsets.count(residual.first[i]) > 0) {
+          jacobian.middleCols(offsets[residual.first[i]],
+                              residual.second[i].cols()) = residual.second[i];
+        }
+      }
+      hessian += jacobian.transpose() * jacobian;
+    }
+    const Eigen::MatrixXd covariance = hessian.inverse();
+    const int size = Points().count(parameter_block) > 0 ? 3 : 6;
+    return covariance.block(offsets.at(parameter_block),
+                            offsets.at(parameter_block),
+                            size,
+                            size);
+  }
+
+  std::unordered_set<const double*> Points() const {
+    std::unordered_set<const double*> points;
+    for (const Eigen::VectorXd& point : points_) {
+      points.emplace(point.data());
+    }
+    return points;
+  }
+
+  static const int kNumCameras = 4;
+  static const int kNumPoints = 10;
+
+  ceres::Problem problem_;
+  std::vector<Eigen::VectorXd> cameras_;
+  std::vector<Eigen::VectorXd> points_;
+
+ private:
+  Eigen::MatrixXd RandomMatrix(RandomNumberGenerator* rng,
+                               const int rows,
+                               const int cols) {
+    Eigen::MatrixXd matrix(rows, cols);
+    for (int r = 0; r < rows; r++) {
+      for (int c = 0; c < cols; c++) {
+        matrix(r, c) = rng->RandDouble(-1.0, 1.0);
+      }
+    }
+    return matrix;
+  }
+
+  void AddResidual(const std::vector<double*>& parameter_blocks,
+                   const std::vector<Eigen::MatrixXd>& jacobians) {
+    problem_.AddResidualBlock(
+        new LinearCostFunction(jacobians), nullptr, parameter_blocks);
+    residuals_.emplace_back(
+        std::vector<const double*>(parameter_blocks.begin(),
+                                   parameter_blocks.end()),
+        jacobians);
+  }
+
+  std::vector<std::pair<std::vector<const double*>,
+                        std::vector<Eigen::MatrixXd> > >
+      residuals_;
+};
+
+void ExpectCovariancesMatch(const MarginalCovarianceOptions& options,
+                            MarginalCovarianceProblem* problem) {
+  const std::vector<const double*> covariance_blocks = {
+      problem->cameras_[1].data(),
+      problem->cameras_[3].data(),
+      problem->points_[0].data(),
+      problem->points_[5].data(),
+      problem->points_[9].data()};
+
+  MarginalCovarianceEstimator covariance_estimator(options);
+  ASSERT_TRUE(covariance_estimator.Compute(
+      covariance_blocks, problem->Points(), &problem->problem_));
+
+  for (const double* parameter_block : covariance_blocks) {
+    Eigen::MatrixXd covariance;
+    ASSERT_TRUE(
+        covariance_estimator.GetCovarianceBlock(parameter_block, &covariance));
+    const Eigen::MatrixXd expected_covariance =
+        problem->ExpectedCovariance(parameter_block);
+    ASSERT_EQ(covariance.rows(), expected_covariance.rows());
+    ASSERT_EQ(covariance.cols(), expected_covariance.cols());
+    for (int r = 0; r < covariance.rows(); r++) {
+      for (int c = 0; c < covariance.cols(); c++) {
+        EXPECT_NEAR(covariance(r, c), expected_covariance(r, c), 1e-8);
+      }
+    }
+  }
+}
+
+}  // namespace
+
+TEST(MarginalCovarianceEstimator, MatchesDenseInverse) {
+  MarginalCovarianceProblem problem(true);
+  ExpectCovariancesMatch(MarginalCovarianceOptions(), &problem);
+}
+
+TEST(MarginalCovarianceEstimator, SmallMemoryBudgetAndThreads) {
+  MarginalCovarianceProblem problem(true);
+  MarginalCovarianceOptions options;
+  options.num_threads = 4;
+  // Forces one column of the inverse reduced system per batch.
+  options.max_memory_in_bytes = 1;
+  ExpectCovariancesMatch(options, &problem);
+}
+
+TEST(MarginalCovarianceEstimator, ConstantParameterBlocks) {
+  MarginalCovarianceProblem problem(false);
+  // Fixing two cameras fixes the gauge.
+  problem.problem_.SetParameterBlockConstant(problem.cameras_[0].data());
+  problem.problem_.SetParameterBlockConstant(problem.cameras_[2].data());
+  ExpectCovariancesMatch(MarginalCovarianceOptions(), &problem);
+
+  const MarginalCovarianceOptions options;
+  MarginalCovarianceEstimator covariance_estimator(options);
+  EXPECT_FALSE(covariance_estimator.Compute({problem.cameras_[0].data()},
+                                            problem.Points(),
+                                            &problem.problem_));
+}
+
+TEST(MarginalCovarianceEstimator, RankDeficientProblem) {
+  MarginalCovarianceProblem problem(true);
+  // A point observed by a single camera is not constrained along its ray.
+  Eigen::Vector3d point = Eigen::Vector3d::Zero();
+  problem.problem_.AddResidualBlock(
+      new LinearCostFunction(
+          {Eigen::MatrixXd::Random(2, 6), Eigen::MatrixXd::Random(2, 3)}),
+      nullptr,
+      std::vector<double*>{problem.cameras_[1].data(), point.data()});
+  std::unordered_set<const double*> points = problem.Points();
+  points.emplace(point.data());
+
+  const MarginalCovarianceOptions options;
+  MarginalCovarianceEstimator covariance_estimator(options);
+  EXPECT_FALSE(covariance_estimator.Compute(
+      {problem.cameras_[1].data()}, points, &problem.problem_));
+}
+
+}  // namespace theia
@@ -0,0 +1,530 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#include "theia/sfm/bundle_adjustment/partitioned_bundle_adjustment.h"
+
+#include <Eigen/Core>
+#include <ceres/ceres.h>
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "theia/math/graph/normalized_graph_cut.h"
+#include "theia/sfm/bundle_adjustment/bundle_adjuster.h"
+#include "theia/sfm/camera/camera.h"
+#include "theia/sfm/camera/camera_intrinsics_model.h"
+#include "theia/sfm/reconstruction.h"
+#include "theia/sfm/track.h"
+#include "theia/sfm/view.h"
+#include "theia/util/executor.h"
+#include "theia/util/hash.h"
+#include "theia/util/map_util.h"
+#include "theia/util/timer.h"
+
+namespace theia {
+
+namespace {
+
+// Residual balancing of the penalty as in Section 3.4.1 of "Distributed
+// Optimization and Statistical Learning via the Alternating Direction Method
+// of Multipliers" by Boyd et al.
+static const double kResidualBalancingRatio = 10.0;
+static const double kPenaltyScale = 2.0;
+
+// The consensus term (penalty / 2) * |x - target|^2 of a parameter block,
+// where target is the consensus value minus the scaled dual variable.
+class ConsensusError : public ceres::CostFunction {
+ public:
+  ConsensusError(const Eigen::VectorXd& target, const double penalty)
+      : target_(target), sqrt_penalty_(std::sqrt(penalty)) {
+    set_num_residuals(target_.size());
+    mutable_parameter_block_sizes()->push_back(target_.size());
+  }
+
+  bool Evaluate(double const* const* parameters,
+                double* residuals,
+                double** jacobians) const override {
+    const int size = target_.size();
+    Eigen::Map<Eigen::VectorXd>(residuals, size) =
+        sqrt_penalty_ *
+        (Eigen::Map<const Eigen::VectorXd>(parameters[0], size) - target_);
+    if (jacobians != nullptr && jacobians[0] != nullptr) {
+      Eigen::Map<Eigen::MatrixXd>(jacobians[0], size, size) =
+          sqrt_penalty_ * Eigen::MatrixXd::Identity(size, size);
+    }
+    return true;
+  }
+
+ private:
+  const Eigen::VectorXd target_;
+  const double sqrt_penalty_;
+};
+
+// A bundle adjuster that can add consensus terms to its problem.
+class ConsensusBundleAdjuster : public BundleAdjuster {
+ public:
+  ConsensusBundleAdjuster(const BundleAdjustmentOptions& options,
+                          Reconstruction* reconstruction)
+      : BundleAdjuster(options, reconstruction) {}
+
+  // Adds the consensus term for the parameter block if it is part of the
+  // problem.
+  void AddConsensusTerm(double* parameters,
+                        const Eigen::VectorXd& target,
+                        const double penalty) {
+    if (problem_->HasParameterBlock(parameters)) {
+      problem_->AddResidualBlock(
+          new ConsensusError(target, penalty), nullptr, parameters);
+    }
+  }
+};
+
+// A variable shared by several partitions. Each partition optimizes its own
+// copy together with a scaled dual variable.
+struct ConsensusVariable {
+  Eigen::VectorXd consensus;
+  std::vector<int> partitions;
+  std::vector<double*> copies;
+  std::vector<Eigen::VectorXd> duals;
+};
+
+// Returns the covisibility graph of the views: the weight of an edge is the
+// number of estimated tracks observed by both views.
+std::unordered_map<std::pair<ViewId, ViewId>, double> CovisibilityEdges(
+    const Reconstruction& reconstruction,
+    const std::unordered_set<ViewId>& view_ids) {
+  std::unordered_map<std::pair<ViewId, ViewId>, double> edges;
+  for (const TrackId track_id : reconstruction.TrackIds()) {
+    const Track* track = reconstruction.Track(track_id);
+    if (!track->IsEstimated()) {
+      continue;
+    }
+    std::vector<ViewId> observing_views;
+    for (const ViewId view_id : track->ViewIds()) {
+      if (ContainsKey(view_ids, view_id)) {
+        observing_views.emplace_back(view_id);
+      }
+    }
+    std::sort(observing_views.begin(), observing_views.end());
+    for (int i = 0; i < observing_views.size(); i++) {
+      for (int j = i + 1; j < observing_views.size(); j++) {
+        edges[std::make_pair(observing_views[i], observing_views[j])] += 1.0;
+      }
+    }
+  }
+  return edges;
+}
+
+// Splits the views into two halves. Normalized graph cuts are used when
+// possible and the sorted views are split in the middle otherwise.
+void BisectViews(
+    const std::unordered_set<ViewId>& view_ids,
+    const std::unordered_map<std::pair<ViewId, ViewId>, double>& edges,
+    std::unordered_set<ViewId>* subset1,
+    std::unordered_set<ViewId>* subset2) {
+  // The graph cut needs at least 4 nodes.
+  static const int kMinNumNodesForGraphCut = 4;
+
+  std::unordered_map<std::pair<ViewId, ViewId>, double> subset_edges;
+  std::unordered_set<ViewId> connected_views;
+  for (const auto& edge : edges) {
+    if (ContainsKey(view_ids, edge.first.first) &&
+        ContainsKey(view_ids, edge.first.second)) {
+      subset_edges.emplace(edge);
+      connected_views.emplace(edge.first.first);
+      connected_views.emplace(edge.first.second);
+    }
+  }
+
+  if (connected_views.size() >= kMinNumNodesForGraphCut) {
+    NormalizedGraphCut<ViewId>::Options cut_options;
+    NormalizedGraphCut<ViewId> graph_cut(cut_options);
+    if (graph_cut.ComputeCut(subset_edges, subset1, subset2, nullptr) &&
+        !subset1->empty() && !subset2->empty()) {
+      // Views without covisible views are not part of the graph.
+      for (const ViewId view_id : view_ids) {
+        if (!ContainsKey(connected_views, view_id)) {
+          (subset1->size() < subset2->size() ? subset1 : subset2)
+              ->emplace(view_id);
+        }
+      }
+      return;
+    }
+  }
+
+  subset1->clear();
+  subset2->clear();
+  std::vector<ViewId> sorted_view_ids(view_ids.begin(), view_ids.end());
+  std::sort(sorted_view_ids.begin(), sorted_view_ids.end());
+  const int half = sorted_view_ids.size() / 2;
+  subset1->insert(sorted_view_ids.begin(), sorted_view_ids.begin() + half);
+  subset2->insert(sorted_view_ids.begin() + half, sorted_view_ids.end());
+}
+
+// Creates the reconstruction of a partition. The intrinsics are deep copied
+// (once per intrinsics group) so that partitions can be optimized in
+// parallel.
+void CreatePartitionReconstruction(const Reconstruction& reconstruction,
+                                   const std::unordered_set<ViewId>& view_ids,
+                                   Reconstruction* partition) {
+  reconstruction.GetSubReconstruction(view_ids, partition);
+  std::unordered_map<CameraIntrinsicsGroupId,
+                     std::shared_ptr<CameraIntrinsicsModel>>
+      intrinsics_copies;
+  for (const ViewId view_id : view_ids) {
+    Camera* camera = partition->MutableView(view_id)->MutableCamera();
+    const CameraIntrinsicsGroupId group_id =
+        partition->CameraIntrinsicsGroupIdFromViewId(view_id);
+    auto intrinsics_copy = intrinsics_copies.find(group_id);
+    if (intrinsics_copy == intrinsics_copies.end()) {
+      Camera camera_copy;
+      camera_copy.DeepCopy(*camera);
+      intrinsics_copy =
+          intrinsics_copies
+              .emplace(group_id, camera_copy.MutableCameraIntrinsics())
+              .first;
+    }
+    camera->MutableCameraIntrinsics() = intrinsics_copy->second;
+  }
+}
+
+}  // namespace
+
+void PartitionViewsForBundleAdjustment(
+    const Reconstruction& reconstruction,
+    const int max_num_views_per_partition,
+    std::vector<std::unordered_set<ViewId>>* partitions) {
+  CHECK_NOTNULL(partitions)->clear();
+  CHECK_GT(max_num_views_per_partition, 0);
+
+  std::unordered_set<ViewId> estimated_views;
+  for (const ViewId view_id : reconstruction.ViewIds()) {
+    if (reconstruction.View(view_id)->IsEstimated()) {
+      estimated_views.emplace(view_id);
+    }
+  }
+  if (estimated_views.empty()) {
+    return;
+  }
+
+  const std::unordered_map<std::pair<ViewId, ViewId>, double> edges =
+      CovisibilityEdges(reconstruction, estimated_views);
+  std::vector<std::unordered_set<ViewId>> subsets_to_split = {estimated_views};
+  while (!subsets_to_split.empty()) {
+    std::unordered_set<ViewId> subset = std::move(subsets_to_split.back());
+    subsets_to_split.pop_back();
+    if (subset.size() <= max_num_views_per_partition) {
+      partitions->emplace_back(std::move(subset));
+      continue;
+    }
+
+    std::unordered_set<ViewId> subset1, subset2;
+    BisectViews(subset, edges, &subset1, &subset2);
+    subsets_to_split.emplace_back(std::move(subset1));
+    subsets_to_split.emplace_back(std::move(subset2));
+  }
+}
+
+PartitionedBundleAdjustmentSummary BundleAdjustReconstructionPartitioned(
+    const PartitionedBundleAdjustmentOptions& options,
+    Reconstruction* reconstruction) {
+  CHECK_NOTNULL(reconstruction);
+  CHECK_GT(options.num_threads, 0);
+  CHECK_GT(options.max_num_rounds, 0);
+  CHECK_GT(options.initial_penalty, 0.0);
+
+  Timer timer;
+  PartitionedBundleAdjustmentSummary summary;
+
+  std::vector<std::unordered_set<ViewId>> partition_view_ids;
+  PartitionViewsForBundleAdjustment(
+      *reconstruction, options.max_num_views_per_partition, &partition_view_ids);
+  summary.num_partitions = partition_view_ids.size();
+  if (partition_view_ids.size() <= 1) {
+    const BundleAdjustmentSummary ba_summary =
+        BundleAdjustReconstruction(options.ba_options, reconstruction);
+    summary.success = ba_summary.success;
+    summary.converged = ba_summary.success;
+    PartitionedBundleAdjustmentRound round;
+    round.penalty = options.initial_penalty;
+    round.cost = ba_summary.final_cost;
+    summary.rounds.emplace_back(round);
+    summary.total_time_in_seconds = timer.ElapsedTimeInSeconds();
+    return summary;
+  }
+
+  // Copy the data of each partition.
+  const int num_partitions = partition_view_ids.size();
+  std::vector<std::unique_ptr<Reconstruction>> partitions(num_partitions);
+  for (int i = 0; i < num_partitions; i++) {
+    partitions[i].reset(new Reconstruction());
+    CreatePartitionReconstruction(
+        *reconstruction, partition_view_ids[i], partitions[i].get());
+  }
+
+  // Find the separator variables. Estimated tracks are shared by all
+  // partitions that observe them. Intrinsics groups are only shared when
+  // intrinsics are optimized.
+  std::unordered_map<TrackId, std::vector<int>> track_partitions;
+  std::unordered_map<CameraIntrinsicsGroupId, std::vector<int>>
+      intrinsics_partitions;
+  for (int i = 0; i < num_partitions; i++) {
+    for (const TrackId track_id : partitions[i]->TrackIds()) {
+      if (partitions[i]->Track(track_id)->IsEstimated()) {
+        track_partitions[track_id].emplace_back(i);
+      }
+    }
+    for (const CameraIntrinsicsGroupId group_id :
+         partitions[i]->CameraIntrinsicsGroupIds()) {
+      intrinsics_partitions[group_id].emplace_back(i);
+    }
+  }
+
+  std::vector<ConsensusVariable> variables;
+  std::vector<std::vector<std::pair<int, int>>> partition_variables(
+      num_partitions);
+  const auto add_variable = [&](const std::vector<int>& partition_indices,
+                                const double* value,
+                                const int size,
+                                const std::function<double*(int)>& copy) {
+    ConsensusVariable variable;
+    variable.consensus = Eigen::Map<const Eigen::VectorXd>(value, size);
+    for (const int partition : partition_indices) {
+      partition_variables[partition].emplace_back(variables.size(),
+                                                  variable.copies.size());
+      variable.partitions.emplace_back(partition);
+      variable.copies.emplace_back(copy(partition));
+      variable.duals.emplace_back(Eigen::VectorXd::Zero(size));
+    }
+    variables.emplace_back(std::move(variable));
+  };
+
+  for (const auto& track : track_partitions) {
+    if (track.second.size() < 2) {
+      continue;
+    }
+    const TrackId track_id = track.first;
+    add_variable(track.second,
+                 reconstruction->Track(track_id)->Point().data(),
+                 4,
+                 [&](const int partition) {
+                   return partitions[partition]
+                       ->MutableTrack(track_id)
+                       ->MutablePoint()
+                       ->data();
+                 });
+    ++summary.num_separator_tracks;
+  }
+  if (options.ba_options.intrinsics_to_optimize !=
+      OptimizeIntrinsicsType::NONE) {
+    for (const auto& group : intrinsics_partitions) {
+      if (group.second.size() < 2) {
+        continue;
+      }
+      const CameraIntrinsicsGroupId group_id = group.first;
+      const Camera& camera =
+          reconstruction
+              ->View(*reconstruction->GetViewsInCameraIntrinsicGroup(group_id)
+                          .begin())
+              ->Camera();
+      add_variable(
+          group.second,
+          camera.intrinsics(),
+          camera.CameraIntrinsics()->NumParameters(),
+          [&](const int partition) {
+            Reconstruction* partition_reconstruction =
+                partitions[partition].get();
+            const ViewId view_id =
+                *partition_reconstruction
+                     ->GetViewsInCameraIntrinsicGroup(group_id)
+                     .begin();
+            return partition_reconstruction->MutableView(view_id)
+                ->MutableCamera()
+                ->mutable_intrinsics();
+          });
+      ++summary.num_separator_intrinsics_groups;
+    }
+  }
+
+  VLOG(2) << "Bundle adjusting " << num_partitions << " partitions with "
+          << summary.num_separator_tracks << " separator tracks and "
+          << summary.num_separator_intrinsics_groups
+          << " separator intrinsics groups.";
+
+  double penalty = options.initial_penalty;
+  std::vector<BundleAdjustmentSummary> partition_summaries(num_partitions);
+  summary.success = true;
+  for (int round = 0; round < options.max_num_rounds; round++) {
+    // Bundle adjust each partition with the consensus terms of its copies.
+    ParallelFor(options.num_threads,
+                num_partitions,
+                [&](const int start, const int end) {
+                  for (int i = start; i < end; i++) {
+                    Reconstruction* partition = partitions[i].get();
+                    ConsensusBundleAdjuster bundle_adjuster(
+                        options.ba_options, partition);
+                    for (const ViewId view_id : partition_view_ids[i]) {
+                      bundle_adjuster.AddView(view_id);
+                    }
+                    for (const TrackId track_id : partition->TrackIds()) {
+                      bundle_adjuster.AddTrack(
+                          track_id,
+                          options.ba_options
+                              .use_homogeneous_point_parametrization);
+                    }
+                    for (const auto& index : partition_variables[i]) {
+                      const ConsensusVariable& variable =
+                          variables[index.first];
+                      bundle_adjuster.AddConsensusTerm(
+                          variable.copies[index.second],
+                          variable.consensus - variable.duals[index.second],
+                          penalty);
+                    }
+                    partition_summaries[i] = bundle_adjuster.Optimize();
+                  }
+                });
+
+    PartitionedBundleAdjustmentRound round_summary;
+    round_summary.penalty = penalty;
+    for (const BundleAdjustmentSummary& partition_summary :
+         partition_summaries) {
+      summary.success &= partition_summary.success;
+      round_summary.cost += partition_summary.final_cost;
+    }
+
+    // Update the consensus values and the scaled dual variables.
+    double primal_sq = 0.0, dual_sq = 0.0;
+    double consensus_sq = 0.0, scaled_dual_sq = 0.0;
+    for (ConsensusVariable& variable : variables) {
+      const int size = variable.consensus.size();
+      const Eigen::VectorXd previous_consensus = variable.consensus;
+      variable.consensus.setZero();
+      for (int i = 0; i < variable.copies.size(); i++) {
+        variable.consensus +=
+            Eigen::Map<const Eigen::VectorXd>(variable.copies[i], size) +
+            variable.duals[i];
+      }
+      variable.consensus /= variable.copies.size();
+
+      for (int i = 0; i < variable.copies.size(); i++) {
+        const Eigen::VectorXd difference =
+            Eigen::Map<const Eigen::VectorXd>(variable.copies[i], size) -
+            variable.consensus;
+        variable.duals[i] += difference;
+        primal_sq += difference.squaredNorm();
+        scaled_dual_sq += penalty * penalty * variable.duals[i].squaredNorm();
+      }
+      dual_sq += variable.copies.size() *
+                 (variable.consensus - previous_consensus).squaredNorm();
+      consensus_sq += variable.copies.size() * variable.consensus.squaredNorm();
+    }
+    round_summary.primal_residual = std::sqrt(primal_sq);
+    round_summary.dual_residual = penalty * std::sqrt(dual_sq);
+    summary.rounds.emplace_back(round_summary);
+    LOG_IF(INFO, options.ba_options.verbose)
+        << "Partitioned bundle adjustment round " << round
+        << ": cost = " << round_summary.cost
+        << ", primal residual = " << round_summary.primal_residual
+        << ", dual residual = " << round_summary.dual_residual
+        << ", penalty = " << round_summary.penalty;
+
+    if (!summary.success) {
+      break;
+    }
+    if (round_summary.primal_residual <=
+            options.convergence_tolerance * std::sqrt(consensus_sq) &&
+        round_summary.dual_residual <=
+            options.convergence_tolerance * std::sqrt(scaled_dual_sq)) {
+      summary.converged = true;
+      break;
+    }
+
+    // Rescale the penalty so that neither residual dominates. The scaled dual
+    // variables are inversely proportional to the penalty.
+    double dual_scale = 1.0;
+    if (round_summary.primal_residual >
+        kResidualBalancingRatio * round_summary.dual_residual) {
+      dual_scale = 1.0 / kPenaltyScale;
+    } else if (round_summary.dual_residual >
+               kResidualBalancingRatio * round_summary.primal_residual) {
+      dual_scale = kPenaltyScale;
+    }
+    if (dual_scale != 1.0) {
+      penalty /= dual_scale;
+      for (ConsensusVariable& variable : variables) {
+        for (Eigen::VectorXd& dual : variable.duals) {
+          dual *= dual_scale;
+        }
+      }
+    }
+  }
+
+  // Copy the solution back. Separator variables take their consensus value,
+  // after which all copies of a variable agree and any partition can be used.
+  for (const ConsensusVariable& variable : variables) {
+    for (double* copy : variable.copies) {
+      Eigen::Map<Eigen::VectorXd>(copy, variable.consensus.size()) =
+          variable.consensus;
+    }
+  }
+  for (int i = 0; i < num_partitions; i++) {
+    for (const ViewId view_id : partition_view_ids[i]) {
+      const Camera& partition_camera = partitions[i]->View(view_id)->Camera();
+      Camera* camera = reconstruction->MutableView(view_id)->MutableCamera();
+      std::copy(partition_camera.extrinsics(),
+                partition_camera.extrinsics() + Camera::kExtrinsicsSize,
+                camera->mutable_extrinsics());
+      std::copy(partition_camera.intrinsics(),
+                partition_camera.intrinsics() +
+                    partition_camera.CameraIntrinsics()->NumParameters(),
+                camera->mutable_intrinsics());
+    }
+  }
+  for (const auto& track : track_partitions) {
+    *reconstruction->MutableTrack(track.first)->MutablePoint() =
+        partitions[track.second.front()]->Track(track.first)->Point();
+  }
+
+  summary.total_time_in_seconds = timer.ElapsedTimeInSeconds();
+  return summary;
+}
+
+}  // namespace theia
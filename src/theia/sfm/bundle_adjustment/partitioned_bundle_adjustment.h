@@ -0,0 +1,135 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#ifndef THEIA_SFM_BUNDLE_ADJUSTMENT_PARTITIONED_BUNDLE_ADJUSTMENT_H_
+#define THEIA_SFM_BUNDLE_ADJUSTMENT_PARTITIONED_BUNDLE_ADJUSTMENT_H_
+
+#include <unordered_set>
+#include <vector>
+
+#include "theia/sfm/bundle_adjustment/bundle_adjustment.h"
+#include "theia/sfm/types.h"
+
+namespace theia {
+
+class Reconstruction;
+
+struct PartitionedBundleAdjustmentOptions {
+  // The options used to bundle adjust each partition.
+  BundleAdjustmentOptions ba_options;
+
+  // The estimated views are recursively split with normalized graph cuts on
+  // the covisibility graph until no partition has more views than this.
+  int max_num_views_per_partition = 1000;
+
+  // The number of partitions that are optimized in parallel. Each partition
+  // uses ba_options.num_threads threads.
+  int num_threads = 1;
+
+  // The maximum number of consensus rounds. Every round bundle adjusts all
+  // partitions once and then updates the consensus variables.
+  int max_num_rounds = 20;
+
+  // The initial weight of the consensus term that pulls the copies of a
+  // separator variable towards their consensus value. It is measured in
+  // squared (weighted) pixels per squared unit of the variable and is adapted
+  // after every round to balance the primal and dual residuals.
+  double initial_penalty = 1.0;
+
+  // The rounds stop once both the primal and the dual residual are below this
+  // fraction of the norm of the consensus variables and the dual variables
+  // respectively.
+  double convergence_tolerance = 1e-4;
+};
+
+// The convergence of a single consensus round.
+struct PartitionedBundleAdjustmentRound {
+  // The norm of the differences between the partitions' copies of the
+  // separator variables and their consensus values.
+  double primal_residual = 0.0;
+  // The norm of the change of the consensus values, scaled by the penalty.
+  double dual_residual = 0.0;
+  // The penalty used in this round.
+  double penalty = 0.0;
+  // The sum of the final costs of all partitions, including consensus terms.
+  double cost = 0.0;
+};
+
+struct PartitionedBundleAdjustmentSummary {
+  // True if the bundle adjustment of every partition succeeded in every round.
+  bool success = false;
+  // True if the consensus rounds converged before max_num_rounds.
+  bool converged = false;
+  int num_partitions = 0;
+  // Tracks observed by views of more than one partition, and intrinsics
+  // groups shared by views of more than one partition when intrinsics are
+  // optimized.
+  int num_separator_tracks = 0;
+  int num_separator_intrinsics_groups = 0;
+  std::vector<PartitionedBundleAdjustmentRound> rounds;
+  double total_time_in_seconds = 0.0;
+};
+
+// Splits the estimated views of the reconstruction into partitions of at most
+// max_num_views_per_partition views. Partitions are computed by recursive
+// bisection of the covisibility graph (weighted by the number of shared
+// estimated tracks) with normalized graph cuts, so that few tracks are shared
+// between partitions.
+void PartitionViewsForBundleAdjustment(
+    const Reconstruction& reconstruction,
+    const int max_num_views_per_partition,
+    std::vector<std::unordered_set<ViewId>>* partitions);
+
+// Bundle adjusts all estimated views and tracks of the reconstruction by
+// divide and conquer. The views are split into partitions (see
+// PartitionViewsForBundleAdjustment) that are bundle adjusted independently,
+// each on its own copy of the data. The separator variables (tracks and
+// intrinsics shared by several partitions) are reconciled with consensus
+// ADMM: each partition adds a quadratic penalty pulling its copies towards the
+// consensus values, after which the consensus values and the dual variables
+// are updated. The partitions of one round can therefore be solved on
+// different threads (or, with the same scheme, on different machines), and no
+// single problem contains the whole reconstruction.
+//
+// The solution converges to that of BundleAdjustReconstruction, although
+// typically more slowly per parameter than a single joint optimization. If all
+// views fit into one partition this is equivalent to
+// BundleAdjustReconstruction.
+PartitionedBundleAdjustmentSummary BundleAdjustReconstructionPartitioned(
+    const PartitionedBundleAdjustmentOptions& options,
+    Reconstruction* reconstruction);
+
+}  // namespace theia
+
+#endif  // THEIA_SFM_BUNDLE_ADJUSTMENT_PARTITIONED_BUNDLE_ADJUSTMENT_H_
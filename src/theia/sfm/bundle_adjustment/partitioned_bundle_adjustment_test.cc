@@ -0,0 +1,198 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#include <Eigen/Core>
+#include <cmath>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "theia/sfm/bundle_adjustment/partitioned_bundle_adjustment.h"
+#include "theia/sfm/camera/camera.h"
+#include "theia/sfm/reconstruction.h"
+#include "theia/sfm/types.h"
+#include "theia/util/random.h"
+#include "gtest/gtest.h"
+
+namespace theia {
+
+namespace {
+RandomNumberGenerator rng(53);
+
+// Creates a reconstruction with cameras along the x axis. Each point is only
+// observed by the cameras close to it so that the covisibility graph is a
+// chain.
+void BuildReconstruction(const int num_views,
+                         const int num_points,
+                         Reconstruction* reconstruction) {
+  static const double kMaxObservationDistance = 2.5;
+  for (int i = 0; i < num_views; i++) {
+    const ViewId view_id =
+        reconstruction->AddView(std::to_string(i), 0, static_cast<double>(i));
+    Camera* camera = reconstruction->MutableView(view_id)->MutableCamera();
+    camera->SetPosition(Eigen::Vector3d(i, 0, 0));
+    camera->SetOrientationFromAngleAxis(Eigen::Vector3d::Zero());
+    camera->SetImageSize(1000, 1000);
+    camera->SetFocalLength(500);
+    camera->SetPrincipalPoint(500, 500);
+    reconstruction->MutableView(view_id)->SetEstimated(true);
+  }
+
+  for (int i = 0; i < num_points; i++) {
+    const Eigen::Vector3d point(rng.RandDouble(0.0, num_views - 1.0),
+                                rng.RandDouble(-3.0, 3.0),
+                                rng.RandDouble(8.0, 12.0));
+    const TrackId track_id = reconstruction->AddTrack();
+    Track* track = reconstruction->MutableTrack(track_id);
+    track->SetPoint(point.homogeneous());
+    track->SetEstimated(true);
+    for (const ViewId view_id : reconstruction->ViewIds()) {
+      const Camera& camera = reconstruction->View(view_id)->Camera();
+      if (std::abs(camera.GetPosition().x() - point.x()) >
+          kMaxObservationDistance) {
+        continue;
+      }
+      Eigen::Vector2d pixel;
+      camera.ProjectPoint(point.homogeneous(), &pixel);
+      reconstruction->AddObservation(view_id, track_id, Feature(pixel));
+    }
+  }
+}
+
+double MeanSquaredReprojectionError(const Reconstruction& reconstruction) {
+  double error_sum = 0.0;
+  int num_observations = 0;
+  for (const TrackId track_id : reconstruction.TrackIds()) {
+    const Track* track = reconstruction.Track(track_id);
+    for (const ViewId view_id : track->ViewIds()) {
+      const View* view = reconstruction.View(view_id);
+      Eigen::Vector2d pixel;
+      view->Camera().ProjectPoint(track->Point(), &pixel);
+      error_sum += (pixel - view->GetFeature(track_id)->point_).squaredNorm();
+      ++num_observations;
+    }
+  }
+  return error_sum / num_observations;
+}
+
+}  // namespace
+
+TEST(PartitionViewsForBundleAdjustment, PartitionsAreDisjointAndSmall) {
+  static const int kNumViews = 16;
+  static const int kNumPoints = 400;
+  static const int kMaxNumViewsPerPartition = 5;
+  Reconstruction reconstruction;
+  BuildReconstruction(kNumViews, kNumPoints, &reconstruction);
+
+  std::vector<std::unordered_set<ViewId>> partitions;
+  PartitionViewsForBundleAdjustment(
+      reconstruction, kMaxNumViewsPerPartition, &partitions);
+  EXPECT_GE(partitions.size(), kNumViews / kMaxNumViewsPerPartition);
+
+  std::unordered_set<ViewId> partitioned_views;
+  for (const auto& partition : partitions) {
+    EXPECT_GT(partition.size(), 0);
+    EXPECT_LE(partition.size(), kMaxNumViewsPerPartition);
+    for (const ViewId view_id : partition) {
+      EXPECT_TRUE(partitioned_views.emplace(view_id).second);
+    }
+  }
+  EXPECT_EQ(partitioned_views.size(), kNumViews);
+}
+
+TEST(PartitionViewsForBundleAdjustment, SkipsUnestimatedViews) {
+  Reconstruction reconstruction;
+  BuildReconstruction(6, 100, &reconstruction);
+  reconstruction.MutableView(0)->SetEstimated(false);
+
+  std::vector<std::unordered_set<ViewId>> partitions;
+  PartitionViewsForBundleAdjustment(reconstruction, 10, &partitions);
+  ASSERT_EQ(partitions.size(), 1);
+  EXPECT_EQ(partitions[0].size(), 5);
+  EXPECT_EQ(partitions[0].count(0), 0);
+}
+
+TEST(BundleAdjustReconstructionPartitioned, ReducesReprojectionError) {
+  static const int kNumViews = 12;
+  static const int kNumPoints = 400;
+  static const double kPointNoise = 0.05;
+  Reconstruction reconstruction;
+  BuildReconstruction(kNumViews, kNumPoints, &reconstruction);
+
+  // Perturb the points.
+  for (const TrackId track_id : reconstruction.TrackIds()) {
+    Eigen::Vector4d* point =
+        reconstruction.MutableTrack(track_id)->MutablePoint();
+    point->head<3>() += kPointNoise * rng.RandVector3d();
+  }
+  const double initial_error = MeanSquaredReprojectionError(reconstruction);
+
+  PartitionedBundleAdjustmentOptions options;
+  options.max_num_views_per_partition = 4;
+  options.num_threads = 2;
+  options.ba_options.num_threads = 1;
+  options.ba_options.linear_solver_type = ceres::DENSE_SCHUR;
+  options.ba_options.use_inner_iterations = false;
+  options.ba_options.constant_camera_orientation = true;
+  options.ba_options.constant_camera_position = true;
+  const PartitionedBundleAdjustmentSummary summary =
+      BundleAdjustReconstructionPartitioned(options, &reconstruction);
+
+  EXPECT_TRUE(summary.success);
+  EXPECT_GE(summary.num_partitions, 3);
+  EXPECT_GT(summary.num_separator_tracks, 0);
+  EXPECT_EQ(summary.num_separator_intrinsics_groups, 0);
+  EXPECT_FALSE(summary.rounds.empty());
+  EXPECT_LE(summary.rounds.size(), options.max_num_rounds);
+  EXPECT_LT(summary.rounds.back().primal_residual,
+            summary.rounds.front().primal_residual);
+  EXPECT_LT(MeanSquaredReprojectionError(reconstruction), 0.01 * initial_error);
+}
+
+TEST(BundleAdjustReconstructionPartitioned, SinglePartition) {
+  Reconstruction reconstruction;
+  BuildReconstruction(4, 100, &reconstruction);
+
+  PartitionedBundleAdjustmentOptions options;
+  options.ba_options.num_threads = 1;
+  options.ba_options.linear_solver_type = ceres::DENSE_SCHUR;
+  const PartitionedBundleAdjustmentSummary summary =
+      BundleAdjustReconstructionPartitioned(options, &reconstruction);
+  EXPECT_TRUE(summary.success);
+  EXPECT_EQ(summary.num_partitions, 1);
+  EXPECT_EQ(summary.num_separator_tracks, 0);
+  EXPECT_EQ(summary.rounds.size(), 1);
+}
+
+}  // namespace theia
@@ -0,0 +1,314 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#include "theia/sfm/bundle_adjustment/refine_relative_pose.h"
+
+#include <Eigen/Cholesky>
+#include <Eigen/Core>
+#include <Eigen/Geometry>
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <vector>
+
+#include "theia/matching/feature_correspondence.h"
+#include "theia/sfm/twoview_info.h"
+#include "theia/util/threadpool.h"
+#include "theia/util/timer.h"
+
+namespace theia {
+
+namespace {
+
+typedef Eigen::Matrix<double, 5, 1> Vector5d;
+typedef Eigen::Matrix<double, 5, 5> Matrix5d;
+typedef Eigen::Matrix<double, 3, 2> Matrix3x2d;
+
+// An orthonormal basis of the tangent space of the unit sphere at the position.
+Matrix3x2d PositionBasis(const Eigen::Vector3d& position) {
+  Eigen::Vector3d v = position;
+  v[2] += position[2] < 0.0 ? -1.0 : 1.0;
+  const Eigen::Matrix3d householder =
+      Eigen::Matrix3d::Identity() - 2.0 * v * v.transpose() / v.squaredNorm();
+  return householder.leftCols<2>();
+}
+
+// Evaluates the angular epipolar error of AngularEpipolarError and, if jacobian
+// is not null, its derivatives with respect to the rotation update
+// R * exp([w]_x) and the position update t + basis * d, i.e. (w, d).
+bool EvaluateAngularEpipolarError(const Eigen::Vector3d& feature1,
+                                  const Eigen::Vector3d& feature2,
+                                  const Eigen::Matrix3d& rotation,
+                                  const Eigen::Vector3d& position,
+                                  const Matrix3x2d& basis,
+                                  double* error,
+                                  Vector5d* jacobian) {
+  const Eigen::Vector3d rotated_feature2 = rotation * feature2;
+  const Eigen::Vector3d unrotated_feature2 = rotation.transpose() * feature2;
+  const double position_dot_feature1 = position.dot(feature1);
+  const double position_dot_rotated = position.dot(rotated_feature2);
+  const double position_dot_unrotated = position.dot(unrotated_feature2);
+
+  // Eq. 11 of Oliensis, with the projections (I - t * t^T) applied explicitly.
+  const Eigen::Vector3d projected_feature1 =
+      feature1 - position_dot_feature1 * position;
+  const Eigen::Vector3d projected_rotated =
+      rotated_feature2 - position_dot_rotated * position;
+  const Eigen::Vector3d projected_unrotated =
+      unrotated_feature2 - position_dot_unrotated * position;
+  const double a = feature1.dot(projected_feature1) +
+                   rotated_feature2.dot(projected_unrotated);
+  const Eigen::Vector3d feature1_cross_unrotated =
+      feature1.cross(unrotated_feature2);
+  const double b_sqrt = position.dot(feature1_cross_unrotated);
+
+  const double sqrt_term = a * a / 4.0 - b_sqrt * b_sqrt;
+  if (sqrt_term < 0.0) {
+    return false;
+  }
+  const double sqrt_value = std::sqrt(sqrt_term);
+  *error = a / 2.0 - sqrt_value;
+  if (jacobian == nullptr) {
+    return true;
+  }
+  if (sqrt_value == 0.0) {
+    return false;
+  }
+
+  // Derivatives of a and b with respect to the rotation and position updates.
+  const Eigen::Vector3d da_drotation =
+      feature2.cross(rotation.transpose() * projected_unrotated) +
+      projected_rotated.cross(unrotated_feature2);
+  const Eigen::Vector2d da_dposition =
+      basis.transpose() * (-2.0 * position_dot_feature1 * feature1 -
+                           position_dot_unrotated * rotated_feature2 -
+                           position_dot_rotated * unrotated_feature2);
+  const Eigen::Vector3d db_drotation =
+      position.cross(feature1).cross(unrotated_feature2);
+  const Eigen::Vector2d db_dposition =
+      basis.transpose() * feature1_cross_unrotated;
+
+  const double de_da = 0.5 - a / (4.0 * sqrt_value);
+  const double de_db = b_sqrt / sqrt_value;
+  jacobian->head<3>() = de_da * da_drotation + de_db * db_drotation;
+  jacobian->tail<2>() = de_da * da_dposition + de_db * db_dposition;
+  return true;
+}
+
+// Returns the cost 0.5 * sum_i e_i^2 of the relative pose. If hessian and
+// gradient are not null, the Gauss-Newton normal equations are computed as
+// well.
+bool EvaluateCost(const std::vector<FeatureCorrespondence>& correspondences,
+                  const Eigen::Matrix3d& rotation,
+                  const Eigen::Vector3d& position,
+                  const Matrix3x2d& basis,
+                  double* cost,
+                  Matrix5d* hessian,
+                  Vector5d* gradient) {
+  const bool compute_derivatives = hessian != nullptr;
+  *cost = 0.0;
+  if (compute_derivatives) {
+    hessian->setZero();
+    gradient->setZero();
+  }
+
+  double error;
+  Vector5d jacobian;
+  for (const FeatureCorrespondence& correspondence : correspondences) {
+    if (!EvaluateAngularEpipolarError(
+            correspondence.feature1.point_.homogeneous(),
+            correspondence.feature2.point_.homogeneous(),
+            rotation,
+            position,
+            basis,
+            &error,
+            compute_derivatives ? &jacobian : nullptr)) {
+      return false;
+    }
+    *cost += 0.5 * error * error;
+    if (compute_derivatives) {
+      hessian->selfadjointView<Eigen::Lower>().rankUpdate(jacobian);
+      gradient->noalias() += error * jacobian;
+    }
+  }
+  if (compute_derivatives) {
+    *hessian = hessian->selfadjointView<Eigen::Lower>();
+  }
+  return std::isfinite(*cost);
+}
+
+}  // namespace
+
+BundleAdjustmentSummary RefineRelativePose(
+    const BundleAdjustmentOptions& options,
+    const std::vector<FeatureCorrespondence>& correspondences,
+    TwoViewInfo* info) {
+  static const double kInitialDamping = 1e-4;
+  static const double kMaxDamping = 1e32;
+  static const double kMinDiagonal = 1e-6;
+  CHECK_NOTNULL(info);
+
+  BundleAdjustmentSummary summary;
+  Timer timer;
+  const double position_norm = info->position_2.norm();
+  if (position_norm == 0.0) {
+    return summary;
+  }
+
+  const double angle = info->rotation_2.norm();
+  Eigen::Matrix3d rotation =
+      angle == 0.0 ? Eigen::Matrix3d::Identity()
+                   : Eigen::AngleAxisd(angle, info->rotation_2 / angle)
+                         .toRotationMatrix();
+  Eigen::Vector3d position = info->position_2 / position_norm;
+  Matrix3x2d basis = PositionBasis(position);
+
+  Matrix5d hessian;
+  Vector5d gradient;
+  double cost;
+  if (!EvaluateCost(correspondences,
+                    rotation,
+                    position,
+                    basis,
+                    &cost,
+                    &hessian,
+                    &gradient)) {
+    return summary;
+  }
+  summary.success = true;
+  summary.initial_cost = cost;
+
+  const double min_damping = 1.0 / options.max_trust_region_radius;
+  double damping = kInitialDamping;
+  bool converged = false;
+  while (!converged && summary.num_iterations < options.max_num_iterations) {
+    if (gradient.lpNorm<Eigen::Infinity>() <= options.gradient_tolerance) {
+      break;
+    }
+
+    // Solve the damped normal equations and try the step.
+    Matrix5d damped_hessian = hessian;
+    damped_hessian.diagonal() +=
+        damping * hessian.diagonal().cwiseMax(kMinDiagonal);
+    const Vector5d delta = damped_hessian.ldlt().solve(-gradient);
+    ++summary.num_iterations;
+    if (delta.norm() <= options.parameter_tolerance *
+                            (1.0 + options.parameter_tolerance)) {
+      break;
+    }
+
+    const Eigen::Vector3d rotation_delta = delta.head<3>();
+    const double angle_delta = rotation_delta.norm();
+    const Eigen::Matrix3d new_rotation =
+        angle_delta == 0.0
+            ? rotation
+            : Eigen::Matrix3d(
+                  rotation *
+                  Eigen::AngleAxisd(angle_delta, rotation_delta / angle_delta)
+                      .toRotationMatrix());
+    const Eigen::Vector3d new_position =
+        (position + basis * delta.tail<2>()).normalized();
+    double new_cost;
+    if (!EvaluateCost(correspondences,
+                      new_rotation,
+                      new_position,
+                      basis,
+                      &new_cost,
+                      nullptr,
+                      nullptr) ||
+        new_cost >= cost) {
+      damping *= 10.0;
+      if (damping > kMaxDamping) {
+        break;
+      }
+      continue;
+    }
+
+    converged = cost - new_cost <= options.function_tolerance * cost;
+    damping = std::max(damping / 10.0, min_damping);
+    rotation = new_rotation;
+    position = new_position;
+    basis = PositionBasis(position);
+    if (!EvaluateCost(correspondences,
+                      rotation,
+                      position,
+                      basis,
+                      &cost,
+                      &hessian,
+                      &gradient)) {
+      break;
+    }
+  }
+
+  const Eigen::AngleAxisd angle_axis(rotation);
+  info->rotation_2 = angle_axis.angle() * angle_axis.axis();
+  info->position_2 = position;
+  summary.final_cost = cost;
+  summary.solve_time_in_seconds = timer.ElapsedTimeInSeconds();
+  return summary;
+}
+
+std::vector<BundleAdjustmentSummary> RefineRelativePoses(
+    const BundleAdjustmentOptions& options,
+    const std::vector<std::vector<FeatureCorrespondence> >& correspondences,
+    std::vector<TwoViewInfo>* infos,
+    ThreadPool* thread_pool) {
+  CHECK_NOTNULL(infos);
+  CHECK_EQ(correspondences.size(), infos->size());
+
+  const int num_view_pairs = infos->size();
+  const int num_blocks =
+      std::max(1, std::min(options.num_threads, num_view_pairs));
+  std::unique_ptr<ThreadPool> local_pool;
+  if (thread_pool == nullptr && num_blocks > 1) {
+    local_pool.reset(new ThreadPool(num_blocks));
+    thread_pool = local_pool.get();
+  }
+
+  std::vector<BundleAdjustmentSummary> summaries(num_view_pairs);
+  ParallelFor(thread_pool,
+              num_view_pairs,
+              num_blocks,
+              [&](const int start, const int end) {
+                for (int i = start; i < end; i++) {
+                  summaries[i] = RefineRelativePose(
+                      options, correspondences[i], &(*infos)[i]);
+                }
+              });
+  return summaries;
+}
+
+}  // namespace theia
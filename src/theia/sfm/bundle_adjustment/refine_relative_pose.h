@@ -0,0 +1,80 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#ifndef THEIA_SFM_BUNDLE_ADJUSTMENT_REFINE_RELATIVE_POSE_H_
+#define THEIA_SFM_BUNDLE_ADJUSTMENT_REFINE_RELATIVE_POSE_H_
+
+#include <vector>
+
+#include "theia/sfm/bundle_adjustment/bundle_adjustment.h"
+
+namespace theia {
+
+class ThreadPool;
+class TwoViewInfo;
+struct FeatureCorrespondence;
+
+// Refines the relative rotation and position of the two views by minimizing
+// the same angular epipolar error as BundleAdjustTwoViewsAngular. Instead of
+// setting up a Ceres problem, the 5 degrees of freedom of the relative pose are
+// optimized with a small Levenberg-Marquardt solver using analytic Jacobians
+// and fixed-size normal equations, so no memory is allocated. This makes it
+// cheap enough to refine every verified view pair.
+//
+// The rotation is updated multiplicatively and the position on the unit sphere.
+// The solver stops after options.max_num_iterations or when the function,
+// gradient or parameter tolerance of the options is reached. Only the
+// optimization options of the BundleAdjustmentOptions are used.
+//
+// NOTE: The correspondences must be normalized by the focal length and
+// principal point.
+BundleAdjustmentSummary RefineRelativePose(
+    const BundleAdjustmentOptions& options,
+    const std::vector<FeatureCorrespondence>& correspondences,
+    TwoViewInfo* info);
+
+// Refines the relative poses of many view pairs in parallel with
+// RefineRelativePose. The correspondences of the i-th view pair refine the i-th
+// TwoViewInfo. The thread pool is used if it is not null, otherwise the pairs
+// are refined on options.num_threads threads. The summary of each view pair is
+// returned.
+std::vector<BundleAdjustmentSummary> RefineRelativePoses(
+    const BundleAdjustmentOptions& options,
+    const std::vector<std::vector<FeatureCorrespondence> >& correspondences,
+    std::vector<TwoViewInfo>* infos,
+    ThreadPool* thread_pool = nullptr);
+
+}  // namespace theia
+
+#endif  // THEIA_SFM_BUNDLE_ADJUSTMENT_REFINE_RELATIVE_POSE_H_
@@ -0,0 +1,185 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#include <Eigen/Core>
+#include <Eigen/Geometry>
+
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "theia/matching/feature_correspondence.h"
+#include "theia/sfm/bundle_adjustment/refine_relative_pose.h"
+#include "theia/sfm/pose/test_util.h"
+#include "theia/sfm/twoview_info.h"
+#include "theia/util/random.h"
+#include "theia/util/threadpool.h"
+
+namespace theia {
+
+using Eigen::AngleAxisd;
+using Eigen::Matrix3d;
+using Eigen::Vector2d;
+using Eigen::Vector3d;
+
+namespace {
+
+static const double kFocalLength = 800.0;
+
+// Creates normalized correspondences of a view pair where the second camera is
+// rotated by rotation and positioned at position, with pixel_noise pixels of
+// noise for a camera with kFocalLength.
+std::vector<FeatureCorrespondence> CreateCorrespondences(
+    const Matrix3d& rotation,
+    const Vector3d& position,
+    const int num_correspondences,
+    const double pixel_noise,
+    RandomNumberGenerator* rng) {
+  std::vector<Vector3d> points;
+  CreateRandomPointsInFrustum(
+      0.8, 0.6, 4.0, 8.0, num_correspondences, rng, &points);
+
+  std::vector<FeatureCorrespondence> correspondences;
+  for (const Vector3d& point : points) {
+    Vector2d feature1 = point.hnormalized();
+    Vector2d feature2 = (rotation * (point - position)).hnormalized();
+    if (pixel_noise > 0.0) {
+      AddNoiseToProjection(pixel_noise / kFocalLength, rng, &feature1);
+      AddNoiseToProjection(pixel_noise / kFocalLength, rng, &feature2);
+    }
+    correspondences.emplace_back(Feature(feature1), Feature(feature2));
+  }
+  return correspondences;
+}
+
+TwoViewInfo CreateTwoViewInfo(const Matrix3d& rotation,
+                              const Vector3d& position) {
+  TwoViewInfo info;
+  const AngleAxisd angle_axis(rotation);
+  info.rotation_2 = angle_axis.angle() * angle_axis.axis();
+  info.position_2 = position.normalized();
+  return info;
+}
+
+// Perturbs the relative pose by a few degrees.
+void PerturbTwoViewInfo(RandomNumberGenerator* rng, TwoViewInfo* info) {
+  info->rotation_2 += 0.03 * rng->RandVector3d();
+  info->position_2 = (info->position_2 + 0.05 * rng->RandVector3d()).normalized();
+}
+
+}  // namespace
+
+// The angular epipolar error grows quadratically with the pose error, so the
+// solver only converges linearly. The tolerances are disabled so that it runs
+// until the steps are negligible.
+TEST(RefineRelativePose, RecoversTheGroundTruthWithoutNoise) {
+  static const double kTolerance = 1e-6;
+  RandomNumberGenerator rng(58);
+  BundleAdjustmentOptions options;
+  options.function_tolerance = 0.0;
+  options.gradient_tolerance = 0.0;
+  for (int i = 0; i < 10; i++) {
+    const Matrix3d rotation = RandomRotation(10.0, &rng);
+    const Vector3d position =
+        Vector3d(1.0, 0.0, 0.0) + 0.2 * rng.RandVector3d();
+    const std::vector<FeatureCorrespondence> correspondences =
+        CreateCorrespondences(rotation, position, 100, 0.0, &rng);
+    const TwoViewInfo expected_info = CreateTwoViewInfo(rotation, position);
+
+    TwoViewInfo info = expected_info;
+    PerturbTwoViewInfo(&rng, &info);
+    const BundleAdjustmentSummary summary =
+        RefineRelativePose(options, correspondences, &info);
+    EXPECT_TRUE(summary.success);
+    EXPECT_GT(summary.initial_cost, summary.final_cost);
+    EXPECT_LT((info.rotation_2 - expected_info.rotation_2).norm(), kTolerance);
+    EXPECT_LT((info.position_2 - expected_info.position_2).norm(), kTolerance);
+    EXPECT_NEAR(info.position_2.norm(), 1.0, 1e-12);
+  }
+}
+
+TEST(RefineRelativePose, ReducesTheCostWithNoise) {
+  static const double kPixelNoise = 1.0;
+  static const double kRotationToleranceDegrees = 0.5;
+  RandomNumberGenerator rng(58);
+  const Matrix3d rotation = RandomRotation(10.0, &rng);
+  const Vector3d position = Vector3d(1.0, 0.0, 0.0) + 0.2 * rng.RandVector3d();
+  const std::vector<FeatureCorrespondence> correspondences =
+      CreateCorrespondences(rotation, position, 200, kPixelNoise, &rng);
+  const TwoViewInfo expected_info = CreateTwoViewInfo(rotation, position);
+
+  TwoViewInfo info = expected_info;
+  PerturbTwoViewInfo(&rng, &info);
+  const BundleAdjustmentSummary summary =
+      RefineRelativePose(BundleAdjustmentOptions(), correspondences, &info);
+  EXPECT_TRUE(summary.success);
+  EXPECT_GT(summary.initial_cost, summary.final_cost);
+  EXPECT_LT((info.rotation_2 - expected_info.rotation_2).norm(),
+            kRotationToleranceDegrees * M_PI / 180.0);
+}
+
+TEST(RefineRelativePoses, MatchesRefineRelativePose) {
+  static const int kNumViewPairs = 12;
+  RandomNumberGenerator rng(58);
+  std::vector<std::vector<FeatureCorrespondence> > correspondences(
+      kNumViewPairs);
+  std::vector<TwoViewInfo> infos(kNumViewPairs);
+  for (int i = 0; i < kNumViewPairs; i++) {
+    const Matrix3d rotation = RandomRotation(10.0, &rng);
+    const Vector3d position =
+        Vector3d(1.0, 0.0, 0.0) + 0.2 * rng.RandVector3d();
+    correspondences[i] =
+        CreateCorrespondences(rotation, position, 50 + 10 * i, 0.5, &rng);
+    infos[i] = CreateTwoViewInfo(rotation, position);
+    PerturbTwoViewInfo(&rng, &infos[i]);
+  }
+
+  BundleAdjustmentOptions options;
+  std::vector<TwoViewInfo> expected_infos = infos;
+  for (int i = 0; i < kNumViewPairs; i++) {
+    RefineRelativePose(options, correspondences[i], &expected_infos[i]);
+  }
+
+  ThreadPool thread_pool(4);
+  const std::vector<BundleAdjustmentSummary> summaries =
+      RefineRelativePoses(options, correspondences, &infos, &thread_pool);
+  ASSERT_EQ(summaries.size(), kNumViewPairs);
+  for (int i = 0; i < kNumViewPairs; i++) {
+    EXPECT_TRUE(summaries[i].success);
+    EXPECT_EQ(infos[i].rotation_2, expected_infos[i].rotation_2);
+    EXPECT_EQ(infos[i].position_2, expected_infos[i].position_2);
+  }
+}
+
+}  // namespace theia
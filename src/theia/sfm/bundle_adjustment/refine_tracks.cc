@@ -0,0 +1,439 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#include "theia/sfm/bundle_adjustment/refine_tracks.h"
+
+#include <Eigen/Cholesky>
+#include <Eigen/Core>
+#include <ceres/ceres.h>
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "theia/sfm/bundle_adjustment/create_loss_function.h"
+#include "theia/sfm/camera/camera.h"
+#include "theia/sfm/camera/camera_intrinsics_model_type.h"
+#include "theia/sfm/camera/division_undistortion_camera_model.h"
+#include "theia/sfm/camera/double_sphere_camera_model.h"
+#include "theia/sfm/camera/extended_unified_camera_model.h"
+#include "theia/sfm/camera/fisheye_camera_model.h"
+#include "theia/sfm/camera/fov_camera_model.h"
+#include "theia/sfm/camera/orthographic_camera_model.h"
+#include "theia/sfm/camera/pinhole_camera_model.h"
+#include "theia/sfm/camera/pinhole_radial_tangential_camera_model.h"
+#include "theia/sfm/camera/reprojection_error.h"
+#include "theia/sfm/feature.h"
+#include "theia/sfm/reconstruction.h"
+#include "theia/sfm/track.h"
+#include "theia/sfm/view.h"
+#include "theia/util/threadpool.h"
+#include "theia/util/timer.h"
+
+namespace theia {
+
+namespace {
+
+typedef Eigen::Matrix<double, 2, 4> Matrix2x4d;
+typedef Eigen::Matrix<double, 4, 3> Matrix4x3d;
+using internal::TrackObservation;
+
+// The outcome of refining a single track.
+struct TrackRefinementResult {
+  bool success = false;
+  double initial_cost = 0.0;
+  double final_cost = 0.0;
+  int num_iterations = 0;
+};
+
+// Evaluates the reprojection error of bundle adjustment and, if jacobian is not
+// null, its Jacobian with respect to the homogeneous point. The derivatives are
+// computed with a 4 dimensional Jet so that only the point is differentiated.
+template <class CameraModel>
+bool EvaluateReprojectionError(const TrackObservation& observation,
+                               const Eigen::Vector4d& point,
+                               Eigen::Vector2d* residual,
+                               Matrix2x4d* jacobian) {
+  const ReprojectionError<CameraModel> reprojection_error(
+      *observation.feature);
+  if (jacobian == nullptr) {
+    return reprojection_error(observation.extrinsics,
+                              observation.intrinsics,
+                              point.data(),
+                              residual->data());
+  }
+
+  typedef ceres::Jet<double, 4> JetT;
+  JetT extrinsics[Camera::kExtrinsicsSize];
+  for (int i = 0; i < Camera::kExtrinsicsSize; i++) {
+    extrinsics[i] = JetT(observation.extrinsics[i]);
+  }
+  JetT intrinsics[CameraModel::kIntrinsicsSize];
+  for (int i = 0; i < CameraModel::kIntrinsicsSize; i++) {
+    intrinsics[i] = JetT(observation.intrinsics[i]);
+  }
+  JetT jet_point[4];
+  for (int i = 0; i < 4; i++) {
+    jet_point[i] = JetT(point[i], i);
+  }
+
+  JetT jet_residual[2];
+  if (!reprojection_error(extrinsics, intrinsics, jet_point, jet_residual)) {
+    return false;
+  }
+  for (int i = 0; i < 2; i++) {
+    (*residual)[i] = jet_residual[i].a;
+    jacobian->row(i) = jet_residual[i].v.transpose();
+  }
+  return true;
+}
+
+bool EvaluateReprojectionError(const TrackObservation& observation,
+                               const Eigen::Vector4d& point,
+                               Eigen::Vector2d* residual,
+                               Matrix2x4d* jacobian) {
+  switch (observation.camera_model_type) {
+    case CameraIntrinsicsModelType::PINHOLE:
+      return EvaluateReprojectionError<PinholeCameraModel>(
+          observation, point, residual, jacobian);
+    case CameraIntrinsicsModelType::PINHOLE_RADIAL_TANGENTIAL:
+      return EvaluateReprojectionError<PinholeRadialTangentialCameraModel>(
+          observation, point, residual, jacobian);
+    case CameraIntrinsicsModelType::FISHEYE:
+      return EvaluateReprojectionError<FisheyeCameraModel>(
+          observation, point, residual, jacobian);
+    case CameraIntrinsicsModelType::FOV:
+      return EvaluateReprojectionError<FOVCameraModel>(
+          observation, point, residual, jacobian);
+    case CameraIntrinsicsModelType::DIVISION_UNDISTORTION:
+      return EvaluateReprojectionError<DivisionUndistortionCameraModel>(
+          observation, point, residual, jacobian);
+    case CameraIntrinsicsModelType::DOUBLE_SPHERE:
+      return EvaluateReprojectionError<DoubleSphereCameraModel>(
+          observation, point, residual, jacobian);
+    case CameraIntrinsicsModelType::EXTENDED_UNIFIED:
+      return EvaluateReprojectionError<ExtendedUnifiedCameraModel>(
+          observation, point, residual, jacobian);
+    case CameraIntrinsicsModelType::ORTHOGRAPHIC:
+      return EvaluateReprojectionError<OrthographicCameraModel>(
+          observation, point, residual, jacobian);
+    default:
+      LOG(FATAL) << "Invalid camera type. Please see camera_intrinsics_model.h "
+                    "for a list of valid camera models.";
+      return false;
+  }
+}
+
+// A basis of the 3 dimensional space in which the point is updated. For
+// homogeneous points this is the tangent space of the unit sphere at the point,
+// given by the Householder reflection that maps the point to the last axis.
+Matrix4x3d UpdateBasis(const Eigen::Vector4d& point,
+                       const bool use_homogeneous) {
+  if (!use_homogeneous) {
+    return Matrix4x3d::Identity();
+  }
+  Eigen::Vector4d v = point;
+  v[3] += point[3] < 0.0 ? -1.0 : 1.0;
+  const Eigen::Matrix4d householder =
+      Eigen::Matrix4d::Identity() - 2.0 * v * v.transpose() / v.squaredNorm();
+  return householder.leftCols<3>();
+}
+
+Eigen::Vector4d UpdatePoint(const Eigen::Vector4d& point,
+                            const Matrix4x3d& basis,
+                            const Eigen::Vector3d& delta,
+                            const bool use_homogeneous) {
+  const Eigen::Vector4d updated_point = point + basis * delta;
+  return use_homogeneous ? updated_point.normalized() : updated_point;
+}
+
+// Returns the cost 0.5 * sum_i rho(|r_i|^2) of the point. If hessian and
+// gradient are not null, the reweighted Gauss-Newton normal equations in the
+// update basis are computed as well.
+bool EvaluateTrackCost(const std::vector<TrackObservation>& observations,
+                       const ceres::LossFunction* loss_function,
+                       const Eigen::Vector4d& point,
+                       const Matrix4x3d& basis,
+                       double* cost,
+                       Eigen::Matrix3d* hessian,
+                       Eigen::Vector3d* gradient) {
+  const bool compute_derivatives = hessian != nullptr;
+  *cost = 0.0;
+  if (compute_derivatives) {
+    hessian->setZero();
+    gradient->setZero();
+  }
+
+  Eigen::Vector2d residual;
+  Matrix2x4d jacobian;
+  for (const TrackObservation& observation : observations) {
+    if (!EvaluateReprojectionError(observation,
+                                   point,
+                                   &residual,
+                                   compute_derivatives ? &jacobian : nullptr)) {
+      return false;
+    }
+
+    const double squared_norm = residual.squaredNorm();
+    double rho[3] = {squared_norm, 1.0, 0.0};
+    if (loss_function != nullptr) {
+      loss_function->Evaluate(squared_norm, rho);
+    }
+    *cost += 0.5 * rho[0];
+
+    if (compute_derivatives) {
+      const Eigen::Matrix<double, 2, 3> local_jacobian = jacobian * basis;
+      hessian->noalias() +=
+          rho[1] * local_jacobian.transpose() * local_jacobian;
+      gradient->noalias() += rho[1] * local_jacobian.transpose() * residual;
+    }
+  }
+  return std::isfinite(*cost);
+}
+
+// Refines the point with Levenberg-Marquardt. The damping is relative to the
+// diagonal of the normal equations, as in Ceres.
+TrackRefinementResult RefineTrack(
+    const BundleAdjustmentOptions& options,
+    const ceres::LossFunction* loss_function,
+    const std::vector<TrackObservation>& observations,
+    Eigen::Vector4d* point) {
+  static const double kInitialDamping = 1e-4;
+  static const double kMaxDamping = 1e32;
+  static const double kMinDiagonal = 1e-6;
+  const double min_damping = 1.0 / options.max_trust_region_radius;
+  const bool use_homogeneous = options.use_homogeneous_point_parametrization;
+
+  TrackRefinementResult result;
+  const double scale = use_homogeneous ? point->norm() : 1.0;
+  if (scale == 0.0) {
+    return result;
+  }
+  Eigen::Vector4d x = *point / scale;
+
+  Matrix4x3d basis = UpdateBasis(x, use_homogeneous);
+  Eigen::Matrix3d hessian;
+  Eigen::Vector3d gradient;
+  double cost;
+  if (!EvaluateTrackCost(observations,
+                         loss_function,
+                         x,
+                         basis,
+                         &cost,
+                         &hessian,
+                         &gradient)) {
+    return result;
+  }
+  result.success = true;
+  result.initial_cost = cost;
+
+  double damping = kInitialDamping;
+  bool converged = false;
+  while (!converged && result.num_iterations < options.max_num_iterations) {
+    if (gradient.lpNorm<Eigen::Infinity>() <= options.gradient_tolerance) {
+      break;
+    }
+
+    // Solve the damped normal equations and try the step.
+    Eigen::Matrix3d damped_hessian = hessian;
+    damped_hessian.diagonal() +=
+        damping * hessian.diagonal().cwiseMax(kMinDiagonal);
+    const Eigen::Vector3d delta = damped_hessian.ldlt().solve(-gradient);
+    ++result.num_iterations;
+    if (delta.norm() <=
+        options.parameter_tolerance * (x.norm() + options.parameter_tolerance)) {
+      break;
+    }
+
+    const Eigen::Vector4d x_new =
+        UpdatePoint(x, basis, delta, use_homogeneous);
+    double new_cost;
+    if (!EvaluateTrackCost(observations,
+                           loss_function,
+                           x_new,
+                           basis,
+                           &new_cost,
+                           nullptr,
+                           nullptr) ||
+        new_cost >= cost) {
+      damping *= 10.0;
+      if (damping > kMaxDamping) {
+        break;
+      }
+      continue;
+    }
+
+    converged = cost - new_cost <= options.function_tolerance * cost;
+    damping = std::max(damping / 10.0, min_damping);
+    x = x_new;
+    basis = UpdateBasis(x, use_homogeneous);
+    if (!EvaluateTrackCost(observations,
+                           loss_function,
+                           x,
+                           basis,
+                           &cost,
+                           &hessian,
+                           &gradient)) {
+      break;
+    }
+  }
+
+  result.final_cost = cost;
+  *point = scale * x;
+  return result;
+}
+
+// Gathers the observations of the track in estimated views.
+void GetTrackObservations(const TrackId track_id,
+                          const Track& track,
+                          const Reconstruction& reconstruction,
+                          std::vector<TrackObservation>* observations) {
+  observations->clear();
+  for (const ViewId view_id : track.ViewIds()) {
+    const View* view = reconstruction.View(view_id);
+    if (view == nullptr || !view->IsEstimated()) {
+      continue;
+    }
+    const Feature* feature = view->GetFeature(track_id);
+    if (feature == nullptr) {
+      continue;
+    }
+    const Camera& camera = view->Camera();
+    observations->push_back({camera.GetCameraIntrinsicsModelType(),
+                             camera.extrinsics(),
+                             camera.intrinsics(),
+                             feature});
+  }
+}
+
+}  // namespace
+
+BundleAdjustmentSummary RefineTracksWithConstantCameras(
+    const BundleAdjustmentOptions& options,
+    const std::vector<TrackId>& track_ids,
+    Reconstruction* reconstruction,
+    ThreadPool* thread_pool) {
+  CHECK_NOTNULL(reconstruction);
+  Timer timer;
+
+  // Gather the tracks up front so that the workers do not look them up.
+  std::vector<std::pair<TrackId, Track*> > tracks;
+  tracks.reserve(track_ids.size());
+  for (const TrackId track_id : track_ids) {
+    Track* track = reconstruction->MutableTrack(track_id);
+    if (track != nullptr && track->IsEstimated()) {
+      tracks.emplace_back(track_id, track);
+    }
+  }
+
+  const int num_tracks = tracks.size();
+  const int num_blocks = std::max(1, std::min(options.num_threads, num_tracks));
+  std::unique_ptr<ThreadPool> local_pool;
+  if (thread_pool == nullptr && num_blocks > 1) {
+    local_pool.reset(new ThreadPool(num_blocks));
+    thread_pool = local_pool.get();
+  }
+
+  const std::unique_ptr<ceres::LossFunction> loss_function =
+      CreateLossFunction(options.loss_function_type, options.robust_loss_width);
+  std::vector<TrackRefinementResult> results(num_tracks);
+  ParallelFor(
+      thread_pool,
+      num_tracks,
+      num_blocks,
+      [&](const int start, const int end) {
+        std::vector<TrackObservation> observations;
+        for (int i = start; i < end; i++) {
+          const TrackId track_id = tracks[i].first;
+          Track* track = tracks[i].second;
+          GetTrackObservations(
+              track_id, *track, *reconstruction, &observations);
+          if (observations.empty()) {
+            results[i].success = true;
+            continue;
+          }
+          results[i] = RefineTrack(options,
+                                   loss_function.get(),
+                                   observations,
+                                   track->MutablePoint());
+        }
+      });
+
+  BundleAdjustmentSummary summary;
+  summary.success = true;
+  for (const TrackRefinementResult& result : results) {
+    summary.success = summary.success && result.success;
+    summary.initial_cost += result.initial_cost;
+    summary.final_cost += result.final_cost;
+    summary.num_iterations += result.num_iterations;
+  }
+  summary.solve_time_in_seconds = timer.ElapsedTimeInSeconds();
+  return summary;
+}
+
+TrackRefiner::TrackRefiner(const BundleAdjustmentOptions& options)
+    : options_(options),
+      loss_function_(CreateLossFunction(options.loss_function_type,
+                                        options.robust_loss_width)) {}
+
+TrackRefiner::~TrackRefiner() {}
+
+BundleAdjustmentSummary TrackRefiner::Refine(const TrackId track_id,
+                                             Reconstruction* reconstruction) {
+  CHECK_NOTNULL(reconstruction);
+  BundleAdjustmentSummary summary;
+  Track* track = reconstruction->MutableTrack(track_id);
+  if (track == nullptr || !track->IsEstimated()) {
+    summary.success = true;
+    return summary;
+  }
+
+  GetTrackObservations(track_id, *track, *reconstruction, &observations_);
+  if (observations_.empty()) {
+    summary.success = true;
+    return summary;
+  }
+  const TrackRefinementResult result = RefineTrack(
+      options_, loss_function_.get(), observations_, track->MutablePoint());
+  summary.success = result.success;
+  summary.initial_cost = result.initial_cost;
+  summary.final_cost = result.final_cost;
+  summary.num_iterations = result.num_iterations;
+  return summary;
+}
+
+}  // namespace theia
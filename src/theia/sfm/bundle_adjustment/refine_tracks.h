@@ -0,0 +1,113 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#ifndef THEIA_SFM_BUNDLE_ADJUSTMENT_REFINE_TRACKS_H_
+#define THEIA_SFM_BUNDLE_ADJUSTMENT_REFINE_TRACKS_H_
+
+#include <memory>
+#include <vector>
+
+#include "theia/sfm/bundle_adjustment/bundle_adjustment.h"
+#include "theia/sfm/camera/camera_intrinsics_model_type.h"
+#include "theia/sfm/types.h"
+
+namespace ceres {
+class LossFunction;
+}  // namespace ceres
+
+namespace theia {
+
+class Feature;
+class Reconstruction;
+class ThreadPool;
+
+namespace internal {
+
+// An observation of a track in a constant camera.
+struct TrackObservation {
+  CameraIntrinsicsModelType camera_model_type;
+  const double* extrinsics;
+  const double* intrinsics;
+  const Feature* feature;
+};
+
+}  // namespace internal
+
+// Refines the 3D points of the tracks with all cameras held constant. The
+// points are then independent of each other, so instead of building a Ceres
+// problem each track is refined with a small Levenberg-Marquardt solver whose
+// 3x3 normal equations live on the stack. The tracks are refined in parallel on
+// the thread pool, or on a pool of options.num_threads threads if it is null.
+//
+// The same robustified reprojection error as in bundle adjustment is
+// minimized, with the robust loss applied by iteratively reweighted least
+// squares. With options.use_homogeneous_point_parametrization the points are
+// updated on the unit sphere (which also handles points at infinity),
+// otherwise the first three coordinates are updated. The solver stops after
+// options.max_num_iterations or when the function, gradient or parameter
+// tolerance of the options is reached.
+//
+// Only estimated tracks are refined, using their observations in estimated
+// views. Tracks whose reprojection error cannot be evaluated at the initial
+// point are left unchanged, in which case success is false. The costs and
+// the number of iterations are summed over all tracks.
+BundleAdjustmentSummary RefineTracksWithConstantCameras(
+    const BundleAdjustmentOptions& options,
+    const std::vector<TrackId>& track_ids,
+    Reconstruction* reconstruction,
+    ThreadPool* thread_pool = nullptr);
+
+// Refines one track at a time on the calling thread in the same way as
+// RefineTracksWithConstantCameras. The loss function and the observation
+// buffer are reused across calls, so a worker that refines its tracks one by
+// one (e.g. during track estimation) does not allocate for every track. A
+// refiner must not be used by several threads at once.
+class TrackRefiner {
+ public:
+  explicit TrackRefiner(const BundleAdjustmentOptions& options);
+  ~TrackRefiner();
+
+  // Refines the track if it is estimated. The summary has no timings.
+  BundleAdjustmentSummary Refine(const TrackId track_id,
+                                 Reconstruction* reconstruction);
+
+ private:
+  const BundleAdjustmentOptions options_;
+  std::unique_ptr<ceres::LossFunction> loss_function_;
+  std::vector<internal::TrackObservation> observations_;
+};
+
+}  // namespace theia
+
+#endif  // THEIA_SFM_BUNDLE_ADJUSTMENT_REFINE_TRACKS_H_
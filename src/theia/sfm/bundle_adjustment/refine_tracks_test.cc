@@ -0,0 +1,224 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#include <Eigen/Core>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "theia/sfm/bundle_adjustment/bundle_adjustment.h"
+#include "theia/sfm/bundle_adjustment/refine_tracks.h"
+#include "theia/sfm/camera/camera.h"
+#include "theia/sfm/reconstruction.h"
+#include "theia/util/random.h"
+#include "theia/util/threadpool.h"
+
+namespace theia {
+
+namespace {
+
+static const int kNumViews = 4;
+static const int kNumTracks = 50;
+
+// Builds a reconstruction with exact observations of random points and
+// perturbs the points. Returns the true points.
+std::vector<Eigen::Vector3d> SetupReconstruction(
+    const double point_noise, Reconstruction* reconstruction) {
+  RandomNumberGenerator rng(57);
+  for (int i = 0; i < kNumViews; i++) {
+    const ViewId view_id = reconstruction->AddView(std::to_string(i), 0, i);
+    View* view = reconstruction->MutableView(view_id);
+    Camera* camera = view->MutableCamera();
+    camera->SetPosition(rng.RandVector3d());
+    camera->SetOrientationFromAngleAxis(0.1 * rng.RandVector3d());
+    camera->SetImageSize(1000, 1000);
+    camera->SetFocalLength(500);
+    camera->SetPrincipalPoint(500, 500);
+    view->SetEstimated(true);
+  }
+
+  std::vector<Eigen::Vector3d> points;
+  for (int i = 0; i < kNumTracks; i++) {
+    const Eigen::Vector3d point(rng.RandDouble(-2.0, 2.0),
+                                rng.RandDouble(-2.0, 2.0),
+                                rng.RandDouble(6.0, 10.0));
+    const TrackId track_id = reconstruction->AddTrack();
+    for (const ViewId view_id : reconstruction->ViewIds()) {
+      Eigen::Vector2d pixel;
+      reconstruction->View(view_id)->Camera().ProjectPoint(point.homogeneous(),
+                                                           &pixel);
+      reconstruction->AddObservation(view_id, track_id, Feature(pixel));
+    }
+    Track* track = reconstruction->MutableTrack(track_id);
+    track->SetPoint((point + point_noise * rng.RandVector3d()).homogeneous());
+    track->SetEstimated(true);
+    points.emplace_back(point);
+  }
+  return points;
+}
+
+void TestRefineTracks(const BundleAdjustmentOptions& options,
+                      ThreadPool* thread_pool) {
+  static const double kPointNoise = 0.1;
+  static const double kTolerance = 1e-6;
+
+  Reconstruction reconstruction;
+  const std::vector<Eigen::Vector3d> points =
+      SetupReconstruction(kPointNoise, &reconstruction);
+  const std::vector<TrackId> track_ids = reconstruction.TrackIds();
+
+  const BundleAdjustmentSummary summary = RefineTracksWithConstantCameras(
+      options, track_ids, &reconstruction, thread_pool);
+  EXPECT_TRUE(summary.success);
+  EXPECT_GT(summary.initial_cost, summary.final_cost);
+  EXPECT_LT(summary.final_cost, kTolerance);
+  for (int i = 0; i < track_ids.size(); i++) {
+    const Eigen::Vector3d point =
+        reconstruction.Track(track_ids[i])->Point().hnormalized();
+    EXPECT_LT((point - points[track_ids[i]]).norm(), kTolerance);
+  }
+}
+
+}  // namespace
+
+TEST(RefineTracksWithConstantCameras, HomogeneousPoints) {
+  BundleAdjustmentOptions options;
+  options.use_homogeneous_point_parametrization = true;
+  TestRefineTracks(options, nullptr);
+}
+
+TEST(RefineTracksWithConstantCameras, EuclideanPoints) {
+  BundleAdjustmentOptions options;
+  options.use_homogeneous_point_parametrization = false;
+  TestRefineTracks(options, nullptr);
+}
+
+TEST(RefineTracksWithConstantCameras, ThreadPool) {
+  BundleAdjustmentOptions options;
+  ThreadPool thread_pool(4);
+  TestRefineTracks(options, &thread_pool);
+}
+
+TEST(RefineTracksWithConstantCameras, RobustLossRejectsOutlier) {
+  static const double kPointNoise = 0.1;
+  static const double kTolerance = 1e-3;
+
+  Reconstruction reconstruction;
+  const std::vector<Eigen::Vector3d> points =
+      SetupReconstruction(kPointNoise, &reconstruction);
+
+  // Observe the first track in one more view with a gross outlier.
+  const TrackId track_id = reconstruction.TrackIds()[0];
+  const Camera& camera =
+      reconstruction.View(reconstruction.ViewIds()[0])->Camera();
+  const ViewId view_id = reconstruction.AddView("outlier", 0, kNumViews);
+  reconstruction.MutableView(view_id)->MutableCamera()->DeepCopy(camera);
+  reconstruction.MutableView(view_id)->SetEstimated(true);
+  Eigen::Vector2d pixel;
+  camera.ProjectPoint(points[track_id].homogeneous(), &pixel);
+  reconstruction.AddObservation(
+      view_id, track_id, Feature(pixel + Eigen::Vector2d(200.0, -150.0)));
+
+  BundleAdjustmentOptions options;
+  options.loss_function_type = LossFunctionType::CAUCHY;
+  options.robust_loss_width = 1.0;
+  const BundleAdjustmentSummary summary = RefineTracksWithConstantCameras(
+      options, {track_id}, &reconstruction);
+  EXPECT_TRUE(summary.success);
+  const Eigen::Vector3d point =
+      reconstruction.Track(track_id)->Point().hnormalized();
+  EXPECT_LT((point - points[track_id]).norm(), kTolerance);
+}
+
+TEST(RefineTracksWithConstantCameras, MatchesBundleAdjustTracks) {
+  static const double kPointNoise = 0.1;
+
+  Reconstruction reconstruction;
+  SetupReconstruction(kPointNoise, &reconstruction);
+  Reconstruction ceres_reconstruction;
+  SetupReconstruction(kPointNoise, &ceres_reconstruction);
+  const std::vector<TrackId> track_ids = reconstruction.TrackIds();
+
+  BundleAdjustmentOptions options;
+  const BundleAdjustmentSummary summary =
+      BundleAdjustTracks(options, track_ids, &reconstruction);
+  options.refine_tracks_independently = false;
+  const BundleAdjustmentSummary ceres_summary =
+      BundleAdjustTracks(options, track_ids, &ceres_reconstruction);
+  EXPECT_TRUE(summary.success);
+  EXPECT_TRUE(ceres_summary.success);
+  EXPECT_NEAR(summary.initial_cost, ceres_summary.initial_cost, 1e-8);
+  for (const TrackId track_id : track_ids) {
+    EXPECT_LT((reconstruction.Track(track_id)->Point().hnormalized() -
+               ceres_reconstruction.Track(track_id)->Point().hnormalized())
+                  .norm(),
+              1e-6);
+  }
+}
+
+TEST(TrackRefiner, MatchesRefineTracksWithConstantCameras) {
+  static const double kPointNoise = 0.1;
+
+  Reconstruction reconstruction;
+  SetupReconstruction(kPointNoise, &reconstruction);
+  Reconstruction expected_reconstruction;
+  SetupReconstruction(kPointNoise, &expected_reconstruction);
+  const std::vector<TrackId> track_ids = reconstruction.TrackIds();
+
+  // The refiner is reused for all tracks.
+  BundleAdjustmentOptions options;
+  options.num_threads = 1;
+  TrackRefiner refiner(options);
+  for (const TrackId track_id : track_ids) {
+    const BundleAdjustmentSummary summary =
+        refiner.Refine(track_id, &reconstruction);
+    const BundleAdjustmentSummary expected_summary =
+        RefineTracksWithConstantCameras(
+            options, {track_id}, &expected_reconstruction);
+    EXPECT_TRUE(summary.success);
+    EXPECT_EQ(summary.initial_cost, expected_summary.initial_cost);
+    EXPECT_EQ(summary.final_cost, expected_summary.final_cost);
+    EXPECT_EQ(reconstruction.Track(track_id)->Point(),
+              expected_reconstruction.Track(track_id)->Point());
+  }
+
+  // Unestimated tracks are not refined.
+  const TrackId track_id = track_ids[0];
+  reconstruction.MutableTrack(track_id)->SetEstimated(false);
+  const Eigen::Vector4d point = reconstruction.Track(track_id)->Point();
+  EXPECT_TRUE(refiner.Refine(track_id, &reconstruction).success);
+  EXPECT_EQ(reconstruction.Track(track_id)->Point(), point);
+}
+
+}  // namespace theia
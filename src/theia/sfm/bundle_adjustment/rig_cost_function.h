@@ -0,0 +1,170 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+
+#ifndef THEIA_SFM_BUNDLE_ADJUSTMENT_RIG_COST_FUNCTION_H_
+#define THEIA_SFM_BUNDLE_ADJUSTMENT_RIG_COST_FUNCTION_H_
+
+#include <ceres/ceres.h>
+
+#include <Eigen/Core>
+#include <memory>
+#include <vector>
+
+#include "theia/sfm/camera/camera.h"
+#include "theia/sfm/camera_rig.h"
+
+namespace theia {
+
+// Composes the camera extrinsics from the rig pose and the extrinsics of the
+// camera relative to the rig.
+struct ComposeRigCameraExtrinsicsFunctor {
+  template <typename T>
+  bool operator()(const T* rig_extrinsics,
+                  const T* camera_to_rig_extrinsics,
+                  T* camera_extrinsics) const {
+    ComposeRigCameraExtrinsics(
+        rig_extrinsics, camera_to_rig_extrinsics, camera_extrinsics);
+    return true;
+  }
+};
+
+// Wraps a cost function whose first parameter block is the camera extrinsics
+// (e.g., the reprojection error or a position prior) so that the camera of a
+// multi-camera rig is parameterized by the rig pose and the extrinsics of the
+// camera relative to the rig instead. The parameter blocks are the rig pose,
+// the camera to rig extrinsics and the remaining parameter blocks of the
+// wrapped cost function. The Jacobians of the wrapped cost function with
+// respect to the camera extrinsics are chained with the Jacobians of the pose
+// composition, so any cost function (with automatic or analytic derivatives)
+// may be wrapped. Takes ownership of the wrapped cost function.
+class RigCostFunction : public ceres::CostFunction {
+ public:
+  explicit RigCostFunction(ceres::CostFunction* cost_function)
+      : cost_function_(cost_function),
+        compose_(new ceres::AutoDiffCostFunction<
+                 ComposeRigCameraExtrinsicsFunctor,
+                 Camera::kExtrinsicsSize,
+                 Camera::kExtrinsicsSize,
+                 Camera::kExtrinsicsSize>(
+            new ComposeRigCameraExtrinsicsFunctor)) {
+    const std::vector<int32_t>& block_sizes =
+        cost_function_->parameter_block_sizes();
+    CHECK_EQ(block_sizes[0], Camera::kExtrinsicsSize);
+    set_num_residuals(cost_function_->num_residuals());
+    mutable_parameter_block_sizes()->push_back(Camera::kExtrinsicsSize);
+    mutable_parameter_block_sizes()->push_back(Camera::kExtrinsicsSize);
+    mutable_parameter_block_sizes()->insert(
+        mutable_parameter_block_sizes()->end(),
+        block_sizes.begin() + 1,
+        block_sizes.end());
+  }
+
+  bool Evaluate(double const* const* parameters,
+                double* residuals,
+                double** jacobians) const override {
+    typedef Eigen::Matrix<double,
+                          Camera::kExtrinsicsSize,
+                          Camera::kExtrinsicsSize,
+                          Eigen::RowMajor>
+        ExtrinsicsJacobian;
+    typedef Eigen::
+        Matrix<double, Eigen::Dynamic, Camera::kExtrinsicsSize, Eigen::RowMajor>
+            ResidualJacobian;
+
+    const int num_blocks = cost_function_->parameter_block_sizes().size();
+    const bool compute_pose_jacobians =
+        jacobians != nullptr &&
+        (jacobians[0] != nullptr || jacobians[1] != nullptr);
+
+    // Compose the camera extrinsics.
+    double camera_extrinsics[Camera::kExtrinsicsSize];
+    ExtrinsicsJacobian rig_jacobian, camera_to_rig_jacobian;
+    double* compose_jacobians[2] = {rig_jacobian.data(),
+                                    camera_to_rig_jacobian.data()};
+    if (!compose_->Evaluate(parameters,
+                            camera_extrinsics,
+                            compute_pose_jacobians ? compose_jacobians
+                                                   : nullptr)) {
+      return false;
+    }
+
+    // Evaluate the wrapped cost function with the composed extrinsics.
+    std::vector<const double*> cost_parameters(num_blocks);
+    cost_parameters[0] = camera_extrinsics;
+    for (int i = 1; i < num_blocks; i++) {
+      cost_parameters[i] = parameters[i + 1];
+    }
+    ResidualJacobian extrinsics_jacobian(num_residuals(),
+                                         Camera::kExtrinsicsSize);
+    std::vector<double*> cost_jacobians;
+    if (jacobians != nullptr) {
+      cost_jacobians.resize(num_blocks);
+      cost_jacobians[0] =
+          compute_pose_jacobians ? extrinsics_jacobian.data() : nullptr;
+      for (int i = 1; i < num_blocks; i++) {
+        cost_jacobians[i] = jacobians[i + 1];
+      }
+    }
+    if (!cost_function_->Evaluate(
+            cost_parameters.data(),
+            residuals,
+            jacobians != nullptr ? cost_jacobians.data() : nullptr)) {
+      return false;
+    }
+
+    // Chain rule for the rig pose and the camera to rig extrinsics.
+    if (compute_pose_jacobians) {
+      if (jacobians[0] != nullptr) {
+        Eigen::Map<ResidualJacobian>(
+            jacobians[0], num_residuals(), Camera::kExtrinsicsSize) =
+            extrinsics_jacobian * rig_jacobian;
+      }
+      if (jacobians[1] != nullptr) {
+        Eigen::Map<ResidualJacobian>(
+            jacobians[1], num_residuals(), Camera::kExtrinsicsSize) =
+            extrinsics_jacobian * camera_to_rig_jacobian;
+      }
+    }
+    return true;
+  }
+
+ private:
+  std::unique_ptr<ceres::CostFunction> cost_function_;
+  std::unique_ptr<ceres::CostFunction> compose_;
+};
+
+}  // namespace theia
+
+#endif  // THEIA_SFM_BUNDLE_ADJUSTMENT_RIG_COST_FUNCTION_H_
@@ -0,0 +1,93 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#include "theia/sfm/bundle_adjustment/select_linear_solver.h"
+
+#include <ceres/types.h>
+#include <glog/logging.h>
+
+#include <cstdint>
+
+namespace theia {
+
+void SelectLinearSolver(const LinearSolverSelectionOptions& options,
+                        const BundleAdjustmentProblemStructure& structure,
+                        ceres::LinearSolverType* linear_solver_type,
+                        ceres::PreconditionerType* preconditioner_type) {
+  CHECK_NOTNULL(linear_solver_type);
+  CHECK_NOTNULL(preconditioner_type);
+
+  // The blocks of the reduced camera system and its nonzero blocks. Each
+  // intrinsics group is coupled with all cameras.
+  const int64_t num_blocks =
+      structure.num_cameras + structure.num_camera_intrinsics_groups;
+  const int64_t num_nonzero_blocks =
+      num_blocks +
+      2 * (structure.num_covisible_camera_pairs +
+           static_cast<int64_t>(structure.num_camera_intrinsics_groups) *
+               structure.num_cameras);
+  const double density =
+      num_blocks == 0
+          ? 1.0
+          : static_cast<double>(num_nonzero_blocks) / (num_blocks * num_blocks);
+
+  *preconditioner_type = ceres::SCHUR_JACOBI;
+  if (num_blocks <= options.max_blocks_for_small_dense_schur ||
+      (num_blocks <= options.max_blocks_for_dense_schur &&
+       density >= options.min_density_for_dense_schur)) {
+    *linear_solver_type = ceres::DENSE_SCHUR;
+    return;
+  }
+
+  if (num_blocks < options.min_blocks_for_iterative_schur &&
+      num_nonzero_blocks <= options.max_nonzero_blocks_for_sparse_schur) {
+    *linear_solver_type = ceres::SPARSE_SCHUR;
+    return;
+  }
+
+  *linear_solver_type = ceres::ITERATIVE_SCHUR;
+  const double mean_covisibility =
+      structure.num_cameras == 0
+          ? 0.0
+          : 2.0 * structure.num_covisible_camera_pairs / structure.num_cameras;
+  if (structure.num_cameras >= options.min_cameras_for_jacobi) {
+    *preconditioner_type = ceres::JACOBI;
+  } else if (structure.num_cameras <= options.max_cameras_for_cluster_jacobi &&
+             mean_covisibility >=
+                 options.min_mean_covisibility_for_cluster_jacobi) {
+    *preconditioner_type = ceres::CLUSTER_JACOBI;
+  }
+}
+
+}  // namespace theia
@@ -0,0 +1,107 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#ifndef THEIA_SFM_BUNDLE_ADJUSTMENT_SELECT_LINEAR_SOLVER_H_
+#define THEIA_SFM_BUNDLE_ADJUSTMENT_SELECT_LINEAR_SOLVER_H_
+
+#include <ceres/types.h>
+#include <cstdint>
+
+namespace theia {
+
+// The structure of a bundle adjustment problem that determines the cost of its
+// linear systems. The points are eliminated with the Schur complement, which
+// leaves a reduced camera system with a block for each optimized camera and
+// each optimized camera intrinsics group.
+struct BundleAdjustmentProblemStructure {
+  // The number of cameras with optimized extrinsics.
+  int num_cameras = 0;
+
+  // The number of optimized camera intrinsics groups. Since a group is shared
+  // by its cameras, it is treated as a camera that is covisible with all
+  // cameras.
+  int num_camera_intrinsics_groups = 0;
+
+  // The number of optimized points.
+  int num_points = 0;
+
+  // The number of pairs of optimized cameras that observe a common optimized
+  // point. Each pair is a nonzero off-diagonal block of the reduced camera
+  // system.
+  int64_t num_covisible_camera_pairs = 0;
+};
+
+// Thresholds of the policy in SelectLinearSolver. The defaults of the camera
+// counts match the static choice that was used by the reconstruction
+// estimators.
+struct LinearSolverSelectionOptions {
+  // DENSE_SCHUR is used for reduced camera systems with at most this many
+  // blocks, or with at most max_blocks_for_dense_schur blocks if at least
+  // min_density_for_dense_schur of the blocks are nonzero.
+  int max_blocks_for_small_dense_schur = 150;
+  int max_blocks_for_dense_schur = 600;
+  double min_density_for_dense_schur = 0.5;
+
+  // ITERATIVE_SCHUR is used for reduced camera systems with at least this many
+  // blocks, or with more than max_nonzero_blocks_for_sparse_schur nonzero
+  // blocks, since the sparse factorization would need too much time and
+  // memory. SPARSE_SCHUR is used otherwise.
+  int min_blocks_for_iterative_schur = 1000;
+  int64_t max_nonzero_blocks_for_sparse_schur = 2000000;
+
+  // The preconditioner of ITERATIVE_SCHUR. CLUSTER_JACOBI captures the coupling
+  // of covisible cameras, which pays off if every camera is covisible with at
+  // least min_mean_covisibility_for_cluster_jacobi cameras on average, but it
+  // is only used up to max_cameras_for_cluster_jacobi cameras since the
+  // clustering and its factorization grow with the problem. JACOBI, which
+  // ignores the points, is used from min_cameras_for_jacobi cameras to keep
+  // the iterations cheap. SCHUR_JACOBI is used otherwise.
+  double min_mean_covisibility_for_cluster_jacobi = 20.0;
+  int max_cameras_for_cluster_jacobi = 10000;
+  int min_cameras_for_jacobi = 50000;
+};
+
+// Chooses among DENSE_SCHUR, SPARSE_SCHUR and ITERATIVE_SCHUR, and for the
+// latter among the JACOBI, SCHUR_JACOBI and CLUSTER_JACOBI preconditioners,
+// based on the size and sparsity of the reduced camera system. The
+// preconditioner is set to SCHUR_JACOBI for the direct solvers, where it is
+// unused.
+void SelectLinearSolver(const LinearSolverSelectionOptions& options,
+                        const BundleAdjustmentProblemStructure& structure,
+                        ceres::LinearSolverType* linear_solver_type,
+                        ceres::PreconditionerType* preconditioner_type);
+
+}  // namespace theia
+
+#endif  // THEIA_SFM_BUNDLE_ADJUSTMENT_SELECT_LINEAR_SOLVER_H_
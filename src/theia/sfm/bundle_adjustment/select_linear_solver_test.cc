@@ -0,0 +1,131 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#include "theia/sfm/bundle_adjustment/select_linear_solver.h"
+
+#include <ceres/types.h>
+
+#include "gtest/gtest.h"
+
+namespace theia {
+
+namespace {
+
+BundleAdjustmentProblemStructure MakeStructure(
+    const int num_cameras,
+    const int num_camera_intrinsics_groups,
+    const int64_t num_covisible_camera_pairs) {
+  BundleAdjustmentProblemStructure structure;
+  structure.num_cameras = num_cameras;
+  structure.num_camera_intrinsics_groups = num_camera_intrinsics_groups;
+  structure.num_points = 100 * num_cameras;
+  structure.num_covisible_camera_pairs = num_covisible_camera_pairs;
+  return structure;
+}
+
+void ExpectSelection(const BundleAdjustmentProblemStructure& structure,
+                     const ceres::LinearSolverType expected_linear_solver_type,
+                     const ceres::PreconditionerType expected_preconditioner) {
+  const LinearSolverSelectionOptions options;
+  ceres::LinearSolverType linear_solver_type;
+  ceres::PreconditionerType preconditioner_type;
+  SelectLinearSolver(
+      options, structure, &linear_solver_type, &preconditioner_type);
+  EXPECT_EQ(linear_solver_type, expected_linear_solver_type);
+  EXPECT_EQ(preconditioner_type, expected_preconditioner);
+}
+
+}  // namespace
+
+TEST(SelectLinearSolver, EmptyProblem) {
+  ExpectSelection(MakeStructure(0, 0, 0), ceres::DENSE_SCHUR,
+                  ceres::SCHUR_JACOBI);
+}
+
+TEST(SelectLinearSolver, SmallProblem) {
+  ExpectSelection(MakeStructure(100, 1, 500), ceres::DENSE_SCHUR,
+                  ceres::SCHUR_JACOBI);
+}
+
+TEST(SelectLinearSolver, DenseMediumProblem) {
+  // All pairs of 400 cameras are covisible.
+  ExpectSelection(MakeStructure(400, 1, 400 * 399 / 2), ceres::DENSE_SCHUR,
+                  ceres::SCHUR_JACOBI);
+}
+
+TEST(SelectLinearSolver, SparseMediumProblem) {
+  ExpectSelection(MakeStructure(400, 1, 4000), ceres::SPARSE_SCHUR,
+                  ceres::SCHUR_JACOBI);
+}
+
+TEST(SelectLinearSolver, LargeSparseProblem) {
+  ExpectSelection(MakeStructure(20000, 1, 100000), ceres::ITERATIVE_SCHUR,
+                  ceres::SCHUR_JACOBI);
+}
+
+TEST(SelectLinearSolver, ManyNonzeroBlocksProblem) {
+  // Fewer blocks than min_blocks_for_iterative_schur, but too many nonzero
+  // blocks for the sparse factorization.
+  LinearSolverSelectionOptions options;
+  options.min_blocks_for_iterative_schur = 5000;
+  options.max_nonzero_blocks_for_sparse_schur = 100000;
+  ceres::LinearSolverType linear_solver_type;
+  ceres::PreconditionerType preconditioner_type;
+  SelectLinearSolver(options,
+                     MakeStructure(2000, 1, 50000),
+                     &linear_solver_type,
+                     &preconditioner_type);
+  EXPECT_EQ(linear_solver_type, ceres::ITERATIVE_SCHUR);
+  EXPECT_EQ(preconditioner_type, ceres::CLUSTER_JACOBI);
+
+  options.max_nonzero_blocks_for_sparse_schur = 1000000;
+  SelectLinearSolver(options,
+                     MakeStructure(2000, 1, 50000),
+                     &linear_solver_type,
+                     &preconditioner_type);
+  EXPECT_EQ(linear_solver_type, ceres::SPARSE_SCHUR);
+}
+
+TEST(SelectLinearSolver, LargeCovisibleProblem) {
+  // Every camera is covisible with 50 cameras on average.
+  ExpectSelection(MakeStructure(5000, 1, 125000), ceres::ITERATIVE_SCHUR,
+                  ceres::CLUSTER_JACOBI);
+}
+
+TEST(SelectLinearSolver, HugeProblem) {
+  ExpectSelection(MakeStructure(100000, 1, 5000000), ceres::ITERATIVE_SCHUR,
+                  ceres::JACOBI);
+}
+
+}  // namespace theia
@@ -0,0 +1,306 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+
+#include "theia/sfm/calibrate_intrinsics_groups.h"
+
+#include <Eigen/Core>
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "theia/sfm/bundle_adjustment/bundle_adjustment.h"
+#include "theia/sfm/camera/camera.h"
+#include "theia/sfm/camera/camera_intrinsics_model.h"
+#include "theia/sfm/reconstruction.h"
+#include "theia/sfm/select_good_tracks_for_bundle_adjustment.h"
+#include "theia/sfm/view.h"
+#include "theia/util/executor.h"
+#include "theia/util/json.h"
+
+namespace theia {
+
+namespace {
+
+typedef std::unordered_map<CameraIntrinsicsGroupId,
+                           IntrinsicsGroupCalibration>
+    IntrinsicsGroupCalibrations;
+
+// A group that is calibrated on its own copy of the reconstruction.
+struct GroupProblem {
+  CameraIntrinsicsGroupId group_id;
+  std::unordered_set<ViewId> view_ids;
+  std::unique_ptr<Reconstruction> reconstruction;
+  std::vector<double> initial_parameters;
+
+  // The result of the calibration.
+  IntrinsicsGroupCalibration calibration;
+  std::unordered_map<ViewId, Eigen::Vector3d> positions;
+  std::unordered_map<ViewId, Eigen::Vector3d> orientations;
+};
+
+std::vector<double> IntrinsicsParameters(
+    const CameraIntrinsicsModel& intrinsics) {
+  return std::vector<double>(
+      intrinsics.parameters(),
+      intrinsics.parameters() + intrinsics.NumParameters());
+}
+
+void SetIntrinsicsParameters(const std::vector<double>& parameters,
+                             CameraIntrinsicsModel* intrinsics) {
+  std::copy(
+      parameters.begin(), parameters.end(), intrinsics->mutable_parameters());
+}
+
+bool HasConverged(const std::vector<double>& initial_parameters,
+                  const std::vector<double>& parameters,
+                  const double tolerance) {
+  for (int i = 0; i < parameters.size(); i++) {
+    const double change = std::abs(parameters[i] - initial_parameters[i]);
+    if (change > tolerance * std::max(1.0, std::abs(initial_parameters[i]))) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Copies the estimated views of the group and the selected tracks into the
+// problem. The views of the copy share a deep copy of the intrinsics, so the
+// intrinsics of the input reconstruction are not modified by the calibration.
+void CreateGroupProblem(const CalibrateIntrinsicsGroupsOptions& options,
+                        const Reconstruction& reconstruction,
+                        const IntrinsicsGroupCalibrations& calibrations,
+                        GroupProblem* problem) {
+  std::unordered_set<TrackId> tracks_to_optimize;
+  SelectGoodTracksForBundleAdjustment(
+      reconstruction,
+      problem->view_ids,
+      options.long_track_length_threshold,
+      options.image_grid_cell_size_pixels,
+      options.min_num_optimized_tracks_per_view,
+      1,
+      &tracks_to_optimize);
+
+  problem->reconstruction.reset(new Reconstruction);
+  reconstruction.GetSubReconstruction(problem->view_ids,
+                                      problem->reconstruction.get());
+  for (const TrackId track_id : problem->reconstruction->TrackIds()) {
+    if (tracks_to_optimize.count(track_id) == 0) {
+      problem->reconstruction->RemoveTrack(track_id);
+    }
+  }
+
+  std::shared_ptr<CameraIntrinsicsModel> intrinsics;
+  for (const ViewId view_id : problem->view_ids) {
+    Camera* camera =
+        problem->reconstruction->MutableView(view_id)->MutableCamera();
+    if (intrinsics == nullptr) {
+      Camera camera_copy;
+      camera_copy.DeepCopy(*camera);
+      intrinsics = camera_copy.MutableCameraIntrinsics();
+    }
+    camera->MutableCameraIntrinsics() = intrinsics;
+  }
+
+  // Continue from the parameters of a previous calibration that did not
+  // converge.
+  const auto cached = calibrations.find(problem->group_id);
+  if (cached != calibrations.end() &&
+      cached->second.parameters.size() == intrinsics->NumParameters()) {
+    SetIntrinsicsParameters(cached->second.parameters, intrinsics.get());
+  }
+  problem->initial_parameters = IntrinsicsParameters(*intrinsics);
+  problem->calibration.num_views = problem->view_ids.size();
+  problem->calibration.num_tracks = problem->reconstruction->NumTracks();
+}
+
+void CalibrateGroup(const CalibrateIntrinsicsGroupsOptions& options,
+                    GroupProblem* problem) {
+  const BundleAdjustmentSummary summary = BundleAdjustReconstruction(
+      options.bundle_adjustment_options, problem->reconstruction.get());
+  IntrinsicsGroupCalibration& calibration = problem->calibration;
+  for (const ViewId view_id : problem->view_ids) {
+    const Camera& camera = problem->reconstruction->View(view_id)->Camera();
+    calibration.parameters = IntrinsicsParameters(*camera.CameraIntrinsics());
+    problem->positions[view_id] = camera.GetPosition();
+    problem->orientations[view_id] = camera.GetOrientationAsAngleAxis();
+  }
+  calibration.initial_cost = summary.initial_cost;
+  calibration.final_cost = summary.final_cost;
+  calibration.converged =
+      summary.success && HasConverged(problem->initial_parameters,
+                                      calibration.parameters,
+                                      options.convergence_tolerance);
+  if (!summary.success) {
+    LOG(WARNING) << "Bundle adjustment of intrinsics group "
+                 << problem->group_id << " failed.";
+    calibration.parameters = problem->initial_parameters;
+    problem->positions.clear();
+    problem->orientations.clear();
+  }
+  // Release the copy of the reconstruction.
+  problem->reconstruction.reset();
+}
+
+}  // namespace
+
+int CalibrateIntrinsicsGroups(const CalibrateIntrinsicsGroupsOptions& options,
+                              Reconstruction* reconstruction,
+                              IntrinsicsGroupCalibrations* calibrations) {
+  CHECK_NOTNULL(reconstruction);
+  CHECK_NOTNULL(calibrations);
+
+  // Gather the groups that must be calibrated, and apply the cached
+  // calibrations of the converged groups.
+  std::vector<std::unique_ptr<GroupProblem> > problems;
+  for (const CameraIntrinsicsGroupId group_id :
+       reconstruction->CameraIntrinsicsGroupIds()) {
+    std::unordered_set<ViewId> view_ids;
+    for (const ViewId view_id :
+         reconstruction->GetViewsInCameraIntrinsicGroup(group_id)) {
+      if (reconstruction->View(view_id)->IsEstimated()) {
+        view_ids.emplace(view_id);
+      }
+    }
+    if (view_ids.empty()) {
+      continue;
+    }
+
+    const auto cached = calibrations->find(group_id);
+    CameraIntrinsicsModel* intrinsics =
+        reconstruction->MutableView(*view_ids.begin())
+            ->MutableCamera()
+            ->MutableCameraIntrinsics()
+            .get();
+    if (cached != calibrations->end() && cached->second.converged &&
+        cached->second.parameters.size() == intrinsics->NumParameters()) {
+      VLOG(2) << "Intrinsics group " << group_id << " is already calibrated.";
+      SetIntrinsicsParameters(cached->second.parameters, intrinsics);
+      continue;
+    }
+
+    problems.emplace_back(new GroupProblem);
+    problems.back()->group_id = group_id;
+    problems.back()->view_ids.swap(view_ids);
+  }
+
+  // The problems are created from the unmodified reconstruction and are
+  // calibrated independently of each other.
+  ParallelFor(options.num_threads, problems.size(),
+              [&](const int start, const int end) {
+                for (int i = start; i < end; i++) {
+                  CreateGroupProblem(
+                      options, *reconstruction, *calibrations,
+                      problems[i].get());
+                  CalibrateGroup(options, problems[i].get());
+                }
+              });
+
+  for (const auto& problem : problems) {
+    for (const ViewId view_id : problem->view_ids) {
+      Camera* camera = reconstruction->MutableView(view_id)->MutableCamera();
+      SetIntrinsicsParameters(problem->calibration.parameters,
+                              camera->MutableCameraIntrinsics().get());
+      const auto position = problem->positions.find(view_id);
+      if (position != problem->positions.end()) {
+        camera->SetPosition(position->second);
+        camera->SetOrientationFromAngleAxis(
+            problem->orientations.at(view_id));
+      }
+    }
+    VLOG(2) << "Calibrated intrinsics group " << problem->group_id << " with "
+            << problem->calibration.num_views << " views and "
+            << problem->calibration.num_tracks << " tracks. Final cost: "
+            << problem->calibration.final_cost;
+    (*calibrations)[problem->group_id] = problem->calibration;
+  }
+  return problems.size();
+}
+
+std::string IntrinsicsGroupCalibrationsToJson(
+    const IntrinsicsGroupCalibrations& calibrations) {
+  // Sort the groups so that the output is stable.
+  std::vector<CameraIntrinsicsGroupId> group_ids;
+  for (const auto& calibration : calibrations) {
+    group_ids.emplace_back(calibration.first);
+  }
+  std::sort(group_ids.begin(), group_ids.end());
+
+  nlohmann::json json = nlohmann::json::array();
+  for (const CameraIntrinsicsGroupId group_id : group_ids) {
+    const IntrinsicsGroupCalibration& calibration = calibrations.at(group_id);
+    json.push_back({{"group_id", group_id},
+                    {"parameters", calibration.parameters},
+                    {"converged", calibration.converged},
+                    {"num_views", calibration.num_views},
+                    {"num_tracks", calibration.num_tracks},
+                    {"initial_cost", calibration.initial_cost},
+                    {"final_cost", calibration.final_cost}});
+  }
+  return json.dump(2);
+}
+
+bool IntrinsicsGroupCalibrationsFromJson(
+    const std::string& json, IntrinsicsGroupCalibrations* calibrations) {
+  CHECK_NOTNULL(calibrations);
+  const nlohmann::json parsed = nlohmann::json::parse(json, nullptr, false);
+  if (parsed.is_discarded() || !parsed.is_array()) {
+    return false;
+  }
+  for (const nlohmann::json& entry : parsed) {
+    if (!entry.is_object() || !entry.contains("group_id") ||
+        !entry.contains("parameters") || !entry["parameters"].is_array()) {
+      return false;
+    }
+    IntrinsicsGroupCalibration calibration;
+    calibration.parameters =
+        entry["parameters"].get<std::vector<double> >();
+    calibration.converged = entry.value("converged", false);
+    calibration.num_views = entry.value("num_views", 0);
+    calibration.num_tracks = entry.value("num_tracks", 0);
+    calibration.initial_cost = entry.value("initial_cost", 0.0);
+    calibration.final_cost = entry.value("final_cost", 0.0);
+    (*calibrations)[entry["group_id"].get<CameraIntrinsicsGroupId>()] =
+        calibration;
+  }
+  return true;
+}
+
+}  // namespace theia
@@ -0,0 +1,115 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+
+#ifndef THEIA_SFM_CALIBRATE_INTRINSICS_GROUPS_H_
+#define THEIA_SFM_CALIBRATE_INTRINSICS_GROUPS_H_
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "theia/sfm/bundle_adjustment/bundle_adjustment.h"
+#include "theia/sfm/types.h"
+
+namespace theia {
+
+class Reconstruction;
+
+struct CalibrateIntrinsicsGroupsOptions {
+  // Number of intrinsics groups that are calibrated in parallel. Each group is
+  // bundle adjusted with the number of threads of the bundle adjustment
+  // options.
+  int num_threads = 1;
+
+  // The bundle adjustment used to calibrate a group. intrinsics_to_optimize
+  // selects the intrinsics that are calibrated.
+  BundleAdjustmentOptions bundle_adjustment_options;
+
+  // Each group is only bundle adjusted with a subsample of the tracks that it
+  // observes, chosen with SelectGoodTracksForBundleAdjustment so that they are
+  // well distributed in every image of the group.
+  int long_track_length_threshold = 10;
+  int image_grid_cell_size_pixels = 100;
+  int min_num_optimized_tracks_per_view = 100;
+
+  // A group is converged if no intrinsics parameter changed by more than this
+  // fraction of its value (or absolutely, for values below 1) during its
+  // calibration.
+  double convergence_tolerance = 1e-4;
+};
+
+// The calibration of one intrinsics group.
+struct IntrinsicsGroupCalibration {
+  // The calibrated intrinsics parameters of the group.
+  std::vector<double> parameters;
+  bool converged = false;
+
+  int num_views = 0;
+  int num_tracks = 0;
+  double initial_cost = 0.0;
+  double final_cost = 0.0;
+};
+
+// Calibrates the camera intrinsics of every intrinsics group of the
+// reconstruction independently. Each group is bundle adjusted on a copy of its
+// estimated views and a subsample of their tracks, so the groups are
+// calibrated in parallel without touching shared tracks. The calibrated
+// intrinsics and the poses of the views are then written to the
+// reconstruction. The track positions are not changed.
+//
+// calibrations is both a cache and the output. A group whose entry is
+// converged and matches its camera model is not calibrated again and gets the
+// cached parameters. A group with an entry that did not converge starts from
+// the cached parameters. The entries of all calibrated groups are updated.
+// Returns the number of groups that were calibrated.
+int CalibrateIntrinsicsGroups(
+    const CalibrateIntrinsicsGroupsOptions& options,
+    Reconstruction* reconstruction,
+    std::unordered_map<CameraIntrinsicsGroupId, IntrinsicsGroupCalibration>*
+        calibrations);
+
+// Reads and writes the calibrations as JSON, so that the converged groups are
+// cached across runs.
+std::string IntrinsicsGroupCalibrationsToJson(
+    const std::unordered_map<CameraIntrinsicsGroupId,
+                             IntrinsicsGroupCalibration>& calibrations);
+bool IntrinsicsGroupCalibrationsFromJson(
+    const std::string& json,
+    std::unordered_map<CameraIntrinsicsGroupId, IntrinsicsGroupCalibration>*
+        calibrations);
+
+}  // namespace theia
+
+#endif  // THEIA_SFM_CALIBRATE_INTRINSICS_GROUPS_H_
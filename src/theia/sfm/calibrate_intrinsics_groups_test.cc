@@ -0,0 +1,193 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+
+#include "theia/sfm/calibrate_intrinsics_groups.h"
+
+#include <Eigen/Core>
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "theia/sfm/camera/camera.h"
+#include "theia/sfm/reconstruction.h"
+
+namespace theia {
+
+namespace {
+
+static const double kFocalLength = 1000.0;
+static const int kNumViewsPerGroup = 6;
+static const int kNumTracks = 200;
+
+typedef std::unordered_map<CameraIntrinsicsGroupId,
+                           IntrinsicsGroupCalibration>
+    IntrinsicsGroupCalibrations;
+
+// Creates two intrinsics groups of views on a line that observe the same
+// tracks without noise. The focal lengths of the groups are then scaled by the
+// given factors.
+void CreateReconstruction(const double focal_length_scale0,
+                          const double focal_length_scale1,
+                          Reconstruction* reconstruction) {
+  std::vector<ViewId> view_ids;
+  for (int group = 0; group < 2; group++) {
+    for (int i = 0; i < kNumViewsPerGroup; i++) {
+      const std::string name = std::to_string(group) + "_" + std::to_string(i);
+      view_ids.emplace_back(reconstruction->AddView(
+          name, group, group * kNumViewsPerGroup + i));
+      View* view = reconstruction->MutableView(view_ids.back());
+      Camera* camera = view->MutableCamera();
+      camera->SetFocalLength(kFocalLength);
+      camera->SetPrincipalPoint(500.0, 500.0);
+      camera->SetImageSize(1000, 1000);
+      camera->SetPosition(
+          Eigen::Vector3d(0.5 * (group * kNumViewsPerGroup + i), 0.0, 0.0));
+      view->SetEstimated(true);
+    }
+  }
+
+  for (int i = 0; i < kNumTracks; i++) {
+    const TrackId track_id = reconstruction->AddTrack();
+    Track* track = reconstruction->MutableTrack(track_id);
+    const Eigen::Vector4d point(
+        3.0 * ((i % 20) / 10.0 - 1.0), 3.0 * ((i / 20) / 5.0 - 1.0),
+        8.0 + (i % 7), 1.0);
+    track->SetPoint(point);
+    track->SetEstimated(true);
+    for (const ViewId view_id : view_ids) {
+      Eigen::Vector2d pixel;
+      reconstruction->View(view_id)->Camera().ProjectPoint(point, &pixel);
+      reconstruction->AddObservation(view_id, track_id, Feature(pixel));
+    }
+  }
+
+  for (int group = 0; group < 2; group++) {
+    Camera* camera =
+        reconstruction->MutableView(view_ids[group * kNumViewsPerGroup])
+            ->MutableCamera();
+    camera->SetFocalLength(kFocalLength * (group == 0 ? focal_length_scale0
+                                                      : focal_length_scale1));
+  }
+}
+
+double GroupFocalLength(const Reconstruction& reconstruction,
+                        const CameraIntrinsicsGroupId group_id) {
+  const ViewId view_id =
+      *reconstruction.GetViewsInCameraIntrinsicGroup(group_id).begin();
+  return reconstruction.View(view_id)->Camera().FocalLength();
+}
+
+CalibrateIntrinsicsGroupsOptions FocalLengthCalibrationOptions() {
+  CalibrateIntrinsicsGroupsOptions options;
+  options.num_threads = 2;
+  options.bundle_adjustment_options.num_threads = 1;
+  options.bundle_adjustment_options.intrinsics_to_optimize =
+      OptimizeIntrinsicsType::FOCAL_LENGTH;
+  options.bundle_adjustment_options.constant_camera_position = true;
+  options.bundle_adjustment_options.constant_camera_orientation = true;
+  return options;
+}
+
+}  // namespace
+
+TEST(CalibrateIntrinsicsGroups, CalibratesEachGroup) {
+  Reconstruction reconstruction;
+  CreateReconstruction(1.1, 0.9, &reconstruction);
+
+  IntrinsicsGroupCalibrations calibrations;
+  EXPECT_EQ(CalibrateIntrinsicsGroups(FocalLengthCalibrationOptions(),
+                                      &reconstruction,
+                                      &calibrations),
+            2);
+  ASSERT_EQ(calibrations.size(), 2);
+  for (const auto& calibration : calibrations) {
+    EXPECT_EQ(calibration.second.num_views, kNumViewsPerGroup);
+    EXPECT_GT(calibration.second.num_tracks, 0);
+    EXPECT_LE(calibration.second.final_cost, calibration.second.initial_cost);
+    EXPECT_NEAR(GroupFocalLength(reconstruction, calibration.first),
+                kFocalLength,
+                1e-3 * kFocalLength);
+  }
+}
+
+TEST(CalibrateIntrinsicsGroups, ConvergedGroupsAreCached) {
+  Reconstruction reconstruction;
+  CreateReconstruction(1.0, 1.1, &reconstruction);
+
+  // The cached calibration of group 0 is applied instead of calibrating it.
+  const Camera& camera = reconstruction.View(0)->Camera();
+  IntrinsicsGroupCalibrations calibrations;
+  calibrations[0].parameters.assign(
+      camera.CameraIntrinsics()->parameters(),
+      camera.CameraIntrinsics()->parameters() +
+          camera.CameraIntrinsics()->NumParameters());
+  calibrations[0].parameters[0] = 1234.0;
+  calibrations[0].converged = true;
+
+  EXPECT_EQ(CalibrateIntrinsicsGroups(FocalLengthCalibrationOptions(),
+                                      &reconstruction,
+                                      &calibrations),
+            1);
+  EXPECT_EQ(GroupFocalLength(reconstruction, 0), 1234.0);
+  EXPECT_EQ(calibrations.size(), 2);
+}
+
+TEST(CalibrateIntrinsicsGroups, JsonRoundTrip) {
+  IntrinsicsGroupCalibrations calibrations;
+  calibrations[3].parameters = {1000.0, 1.0, 0.0, 500.0, 400.0};
+  calibrations[3].converged = true;
+  calibrations[3].num_views = 7;
+  calibrations[3].num_tracks = 100;
+  calibrations[3].final_cost = 0.5;
+  calibrations[1].parameters = {900.0};
+
+  IntrinsicsGroupCalibrations parsed;
+  ASSERT_TRUE(IntrinsicsGroupCalibrationsFromJson(
+      IntrinsicsGroupCalibrationsToJson(calibrations), &parsed));
+  ASSERT_EQ(parsed.size(), 2);
+  EXPECT_EQ(parsed[3].parameters, calibrations[3].parameters);
+  EXPECT_TRUE(parsed[3].converged);
+  EXPECT_EQ(parsed[3].num_views, 7);
+  EXPECT_EQ(parsed[3].num_tracks, 100);
+  EXPECT_EQ(parsed[3].final_cost, 0.5);
+  EXPECT_EQ(parsed[1].parameters, calibrations[1].parameters);
+  EXPECT_FALSE(parsed[1].converged);
+
+  EXPECT_FALSE(IntrinsicsGroupCalibrationsFromJson("{", &parsed));
+}
+
+}  // namespace theia
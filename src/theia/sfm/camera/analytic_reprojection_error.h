@@ -0,0 +1,542 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#ifndef THEIA_SFM_CAMERA_ANALYTIC_REPROJECTION_ERROR_H_
+#define THEIA_SFM_CAMERA_ANALYTIC_REPROJECTION_ERROR_H_
+
+#include <Eigen/Core>
+#include <ceres/ceres.h>
+#include <ceres/rotation.h>
+#include <cmath>
+#include <limits>
+
+#include "theia/sfm/camera/camera.h"
+#include "theia/sfm/camera/double_sphere_camera_model.h"
+#include "theia/sfm/camera/fisheye_camera_model.h"
+#include "theia/sfm/camera/pinhole_camera_model.h"
+#include "theia/sfm/camera/pinhole_radial_tangential_camera_model.h"
+#include "theia/sfm/feature.h"
+
+namespace theia {
+
+// The lens distortion of a camera model with hand-derived Jacobians. Given a
+// point in the camera coordinate system, Distort computes the distorted
+// normalized image point (before the focal length, skew, aspect ratio and
+// principal point are applied) and, if the Jacobians are requested, its
+// derivatives with respect to the point and the distortion parameters. The
+// Jacobian with respect to the intrinsics has one column per intrinsic
+// parameter, but only the columns of the distortion parameters are written.
+//
+// Specializations exist for the camera models listed in
+// HasAnalyticReprojectionError. They must compute exactly what the
+// CameraToPixelCoordinates method of the model computes.
+template <class CameraModel>
+struct AnalyticDistortion;
+
+template <>
+struct AnalyticDistortion<PinholeCameraModel> {
+  typedef Eigen::Matrix<double, 2, PinholeCameraModel::kIntrinsicsSize,
+                        Eigen::RowMajor>
+      IntrinsicsJacobian;
+
+  static bool Distort(const double* intrinsics,
+                      const Eigen::Vector3d& point,
+                      Eigen::Vector2d* distorted,
+                      Eigen::Matrix<double, 2, 3>* d_point,
+                      IntrinsicsJacobian* d_intrinsics) {
+    const double k1 = intrinsics[PinholeCameraModel::RADIAL_DISTORTION_1];
+    const double k2 = intrinsics[PinholeCameraModel::RADIAL_DISTORTION_2];
+
+    const double inv_depth = 1.0 / point.z();
+    const double x = point.x() * inv_depth;
+    const double y = point.y() * inv_depth;
+    const double r_sq = x * x + y * y;
+    const double d = 1.0 + r_sq * (k1 + k2 * r_sq);
+    *distorted << x * d, y * d;
+    if (d_point == nullptr) {
+      return true;
+    }
+
+    // Derivative with respect to the normalized point, then chain with the
+    // perspective division.
+    const double d_r_sq = k1 + 2.0 * k2 * r_sq;
+    Eigen::Matrix2d d_normalized;
+    d_normalized << d + 2.0 * x * x * d_r_sq, 2.0 * x * y * d_r_sq,
+        2.0 * x * y * d_r_sq, d + 2.0 * y * y * d_r_sq;
+    Eigen::Matrix<double, 2, 3> d_projection;
+    d_projection << inv_depth, 0.0, -x * inv_depth, 0.0, inv_depth,
+        -y * inv_depth;
+    d_point->noalias() = d_normalized * d_projection;
+
+    d_intrinsics->col(PinholeCameraModel::RADIAL_DISTORTION_1) << x * r_sq,
+        y * r_sq;
+    d_intrinsics->col(PinholeCameraModel::RADIAL_DISTORTION_2)
+        << x * r_sq * r_sq,
+        y * r_sq * r_sq;
+    return true;
+  }
+};
+
+template <>
+struct AnalyticDistortion<PinholeRadialTangentialCameraModel> {
+  typedef PinholeRadialTangentialCameraModel Model;
+  typedef Eigen::Matrix<double, 2, Model::kIntrinsicsSize, Eigen::RowMajor>
+      IntrinsicsJacobian;
+
+  static bool Distort(const double* intrinsics,
+                      const Eigen::Vector3d& point,
+                      Eigen::Vector2d* distorted,
+                      Eigen::Matrix<double, 2, 3>* d_point,
+                      IntrinsicsJacobian* d_intrinsics) {
+    const double k1 = intrinsics[Model::RADIAL_DISTORTION_1];
+    const double k2 = intrinsics[Model::RADIAL_DISTORTION_2];
+    const double k3 = intrinsics[Model::RADIAL_DISTORTION_3];
+    const double t1 = intrinsics[Model::TANGENTIAL_DISTORTION_1];
+    const double t2 = intrinsics[Model::TANGENTIAL_DISTORTION_2];
+
+    const double inv_depth = 1.0 / point.z();
+    const double x = point.x() * inv_depth;
+    const double y = point.y() * inv_depth;
+    const double xy = x * y;
+    const double r_sq = x * x + y * y;
+    const double rd = 1.0 + r_sq * (k1 + r_sq * (k2 + k3 * r_sq));
+    *distorted << x * rd + t2 * (r_sq + 2.0 * x * x) + 2.0 * t1 * xy,
+        y * rd + t1 * (r_sq + 2.0 * y * y) + 2.0 * t2 * xy;
+    if (d_point == nullptr) {
+      return true;
+    }
+
+    const double d_rd = k1 + r_sq * (2.0 * k2 + 3.0 * k3 * r_sq);
+    const double cross = 2.0 * xy * d_rd + 2.0 * t1 * x + 2.0 * t2 * y;
+    Eigen::Matrix2d d_normalized;
+    d_normalized << rd + 2.0 * x * x * d_rd + 6.0 * t2 * x + 2.0 * t1 * y,
+        cross, cross, rd + 2.0 * y * y * d_rd + 6.0 * t1 * y + 2.0 * t2 * x;
+    Eigen::Matrix<double, 2, 3> d_projection;
+    d_projection << inv_depth, 0.0, -x * inv_depth, 0.0, inv_depth,
+        -y * inv_depth;
+    d_point->noalias() = d_normalized * d_projection;
+
+    const double r_4 = r_sq * r_sq;
+    d_intrinsics->col(Model::RADIAL_DISTORTION_1) << x * r_sq, y * r_sq;
+    d_intrinsics->col(Model::RADIAL_DISTORTION_2) << x * r_4, y * r_4;
+    d_intrinsics->col(Model::RADIAL_DISTORTION_3) << x * r_4 * r_sq,
+        y * r_4 * r_sq;
+    d_intrinsics->col(Model::TANGENTIAL_DISTORTION_1) << 2.0 * xy,
+        r_sq + 2.0 * y * y;
+    d_intrinsics->col(Model::TANGENTIAL_DISTORTION_2) << r_sq + 2.0 * x * x,
+        2.0 * xy;
+    return true;
+  }
+};
+
+template <>
+struct AnalyticDistortion<FisheyeCameraModel> {
+  typedef Eigen::Matrix<double, 2, FisheyeCameraModel::kIntrinsicsSize,
+                        Eigen::RowMajor>
+      IntrinsicsJacobian;
+
+  static bool Distort(const double* intrinsics,
+                      const Eigen::Vector3d& point,
+                      Eigen::Vector2d* distorted,
+                      Eigen::Matrix<double, 2, 3>* d_point,
+                      IntrinsicsJacobian* d_intrinsics) {
+    static const double kVerySmallNumber = 1e-8;
+    const double k1 = intrinsics[FisheyeCameraModel::RADIAL_DISTORTION_1];
+    const double k2 = intrinsics[FisheyeCameraModel::RADIAL_DISTORTION_2];
+    const double k3 = intrinsics[FisheyeCameraModel::RADIAL_DISTORTION_3];
+    const double k4 = intrinsics[FisheyeCameraModel::RADIAL_DISTORTION_4];
+
+    // Close to the center of distortion the model is the identity on the x and
+    // y coordinates (see FisheyeCameraModel::DistortPoint).
+    const double r_sq = point.x() * point.x() + point.y() * point.y();
+    if (r_sq < kVerySmallNumber) {
+      *distorted = point.head<2>();
+      if (d_point != nullptr) {
+        *d_point << 1.0, 0.0, 0.0, 0.0, 1.0, 0.0;
+        d_intrinsics->rightCols<4>().setZero();
+      }
+      return true;
+    }
+
+    const double r = std::sqrt(r_sq);
+    const double abs_z = std::abs(point.z());
+    const double theta = std::atan2(r, abs_z);
+    const double theta_sq = theta * theta;
+    const double theta_d =
+        theta *
+        (1.0 + theta_sq * (k1 + theta_sq * (k2 + theta_sq * (k3 + theta_sq * k4))));
+    // Points behind the camera are mirrored.
+    const double sign = point.z() < 0.0 ? -1.0 : 1.0;
+    const double scale = sign * theta_d / r;
+    *distorted << scale * point.x(), scale * point.y();
+    if (d_point == nullptr) {
+      return true;
+    }
+
+    // distorted = sign * g(r, |z|) * (x, y) with g = theta_d / r.
+    const double d_theta_d =
+        1.0 + theta_sq * (3.0 * k1 +
+                          theta_sq * (5.0 * k2 +
+                                      theta_sq * (7.0 * k3 +
+                                                  9.0 * k4 * theta_sq)));
+    const double inv_norm_sq = 1.0 / (r_sq + abs_z * abs_z);
+    const double d_g_d_r =
+        (d_theta_d * abs_z * inv_norm_sq * r - theta_d) / r_sq;
+    const double d_g_d_z = -d_theta_d * r * inv_norm_sq * sign / r;
+    const double x_r = point.x() / r;
+    const double y_r = point.y() / r;
+    const double g = theta_d / r;
+    *d_point << g + point.x() * d_g_d_r * x_r, point.x() * d_g_d_r * y_r,
+        point.x() * d_g_d_z, point.y() * d_g_d_r * x_r,
+        g + point.y() * d_g_d_r * y_r, point.y() * d_g_d_z;
+    *d_point *= sign;
+
+    double theta_power = theta * theta_sq;
+    for (int i = 0; i < 4; i++) {
+      d_intrinsics->col(FisheyeCameraModel::RADIAL_DISTORTION_1 + i)
+          << sign * x_r * theta_power,
+          sign * y_r * theta_power;
+      theta_power *= theta_sq;
+    }
+    return true;
+  }
+};
+
+template <>
+struct AnalyticDistortion<DoubleSphereCameraModel> {
+  typedef Eigen::Matrix<double, 2, DoubleSphereCameraModel::kIntrinsicsSize,
+                        Eigen::RowMajor>
+      IntrinsicsJacobian;
+
+  static bool Distort(const double* intrinsics,
+                      const Eigen::Vector3d& point,
+                      Eigen::Vector2d* distorted,
+                      Eigen::Matrix<double, 2, 3>* d_point,
+                      IntrinsicsJacobian* d_intrinsics) {
+    const double alpha = intrinsics[DoubleSphereCameraModel::ALPHA];
+    const double xi = intrinsics[DoubleSphereCameraModel::XI];
+
+    const double r_sq = point.x() * point.x() + point.y() * point.y();
+    const double d1 = std::sqrt(r_sq + point.z() * point.z());
+
+    // Reject points outside of the valid projection area.
+    const double w1 =
+        alpha > 0.5 ? (1.0 - alpha) / alpha : alpha / (1.0 - alpha);
+    const double w2 = (w1 + xi) / std::sqrt(2.0 * w1 * xi + xi * xi + 1.0);
+    if (point.z() <= -w2 * d1) {
+      return false;
+    }
+
+    const double k = xi * d1 + point.z();
+    const double d2 = std::sqrt(r_sq + k * k);
+    const double norm = alpha * d2 + (1.0 - alpha) * k;
+    const double inv_norm = 1.0 / norm;
+    *distorted << point.x() * inv_norm, point.y() * inv_norm;
+    if (d_point == nullptr) {
+      return true;
+    }
+
+    const Eigen::Vector3d d_d1 = point / d1;
+    Eigen::Vector3d d_k = xi * d_d1;
+    d_k.z() += 1.0;
+    Eigen::Vector3d d_d2 = k * d_k;
+    d_d2.x() += point.x();
+    d_d2.y() += point.y();
+    d_d2 /= d2;
+    const Eigen::Vector3d d_norm = alpha * d_d2 + (1.0 - alpha) * d_k;
+
+    // distorted = (x, y) / norm.
+    const double inv_norm_sq = inv_norm * inv_norm;
+    d_point->row(0) = -point.x() * inv_norm_sq * d_norm.transpose();
+    d_point->row(1) = -point.y() * inv_norm_sq * d_norm.transpose();
+    (*d_point)(0, 0) += inv_norm;
+    (*d_point)(1, 1) += inv_norm;
+
+    const double d_norm_d_xi = alpha * k * d1 / d2 + (1.0 - alpha) * d1;
+    const double d_norm_d_alpha = d2 - k;
+    d_intrinsics->col(DoubleSphereCameraModel::XI)
+        << -point.x() * inv_norm_sq * d_norm_d_xi,
+        -point.y() * inv_norm_sq * d_norm_d_xi;
+    d_intrinsics->col(DoubleSphereCameraModel::ALPHA)
+        << -point.x() * inv_norm_sq * d_norm_d_alpha,
+        -point.y() * inv_norm_sq * d_norm_d_alpha;
+    return true;
+  }
+};
+
+// Whether an analytic reprojection error exists for the camera model.
+inline bool HasAnalyticReprojectionError(
+    const CameraIntrinsicsModelType& camera_model_type) {
+  return camera_model_type == CameraIntrinsicsModelType::PINHOLE ||
+         camera_model_type ==
+             CameraIntrinsicsModelType::PINHOLE_RADIAL_TANGENTIAL ||
+         camera_model_type == CameraIntrinsicsModelType::FISHEYE ||
+         camera_model_type == CameraIntrinsicsModelType::DOUBLE_SPHERE;
+}
+
+// The same reprojection error as ReprojectionError<CameraModel> but with
+// hand-derived Jacobians instead of automatic differentiation. All sizes are
+// known at compile time so that the Jacobians are computed with fixed-size
+// (and vectorizable) Eigen expressions. The parameter blocks are the camera
+// extrinsics, the camera intrinsics and the homogeneous 3D point.
+template <class CameraModel>
+class AnalyticReprojectionError
+    : public ceres::SizedCostFunction<2,
+                                      Camera::kExtrinsicsSize,
+                                      CameraModel::kIntrinsicsSize,
+                                      4> {
+ public:
+  static const int kIntrinsicsSize = CameraModel::kIntrinsicsSize;
+
+  // If single_precision_jacobians is not null, the Jacobians are computed in
+  // single precision whenever it points to true. The residuals are always
+  // computed in double precision. The flag may be changed between solves,
+  // e.g. to fall back to double precision.
+  explicit AnalyticReprojectionError(
+      const Feature& feature, const bool* single_precision_jacobians = nullptr)
+      : feature_(feature.point_),
+        sqrt_information_(1.0 / std::sqrt(feature.covariance_(0, 0)),
+                          1.0 / std::sqrt(feature.covariance_(1, 1))),
+        single_precision_jacobians_(single_precision_jacobians) {}
+
+  bool Evaluate(double const* const* parameters,
+                double* residuals,
+                double** jacobians) const override {
+    static const double kVerySmallNumber = 1e-8;
+
+    const double* extrinsics = parameters[0];
+    const double* intrinsics = parameters[1];
+    const double* point = parameters[2];
+
+    // Remove the translation. Points too close to the camera center cannot be
+    // constrained (see ReprojectionError).
+    const Eigen::Map<const Eigen::Vector3d> position(extrinsics +
+                                                     Camera::POSITION);
+    const Eigen::Vector3d adjusted_point =
+        Eigen::Map<const Eigen::Vector3d>(point) - point[3] * position;
+    if (adjusted_point.squaredNorm() < kVerySmallNumber) {
+      return false;
+    }
+
+    Eigen::Matrix3d rotation;
+    ceres::AngleAxisToRotationMatrix(
+        extrinsics + Camera::ORIENTATION,
+        ceres::ColumnMajorAdapter3x3(rotation.data()));
+    const Eigen::Vector3d rotated_point = rotation * adjusted_point;
+
+    const bool need_jacobians = jacobians != nullptr;
+    Eigen::Vector2d distorted;
+    Eigen::Matrix<double, 2, 3> d_distorted_d_point;
+    IntrinsicsJacobian d_intrinsics;
+    if (!AnalyticDistortion<CameraModel>::Distort(
+            intrinsics,
+            rotated_point,
+            &distorted,
+            need_jacobians ? &d_distorted_d_point : nullptr,
+            need_jacobians ? &d_intrinsics : nullptr)) {
+      return false;
+    }
+
+    // Apply the calibration.
+    const double focal_length = intrinsics[CameraModel::FOCAL_LENGTH];
+    const double aspect_ratio = intrinsics[CameraModel::ASPECT_RATIO];
+    const double skew = intrinsics[CameraModel::SKEW];
+    residuals[0] =
+        sqrt_information_.x() *
+        (focal_length * distorted.x() + skew * distorted.y() +
+         intrinsics[CameraModel::PRINCIPAL_POINT_X] - feature_.x());
+    residuals[1] = sqrt_information_.y() *
+                   (focal_length * aspect_ratio * distorted.y() +
+                    intrinsics[CameraModel::PRINCIPAL_POINT_Y] - feature_.y());
+    if (!need_jacobians) {
+      return true;
+    }
+
+    if (single_precision_jacobians_ != nullptr &&
+        *single_precision_jacobians_) {
+      EvaluateJacobians<float>(extrinsics,
+                               intrinsics,
+                               point,
+                               rotation,
+                               adjusted_point,
+                               distorted,
+                               d_distorted_d_point,
+                               d_intrinsics,
+                               jacobians);
+    } else {
+      EvaluateJacobians<double>(extrinsics,
+                                intrinsics,
+                                point,
+                                rotation,
+                                adjusted_point,
+                                distorted,
+                                d_distorted_d_point,
+                                d_intrinsics,
+                                jacobians);
+    }
+    return true;
+  }
+
+ private:
+  typedef typename AnalyticDistortion<CameraModel>::IntrinsicsJacobian
+      IntrinsicsJacobian;
+
+  // Chains the derivatives of the projection into the Jacobians of the
+  // parameter blocks, computing in scalar type T.
+  template <typename T>
+  void EvaluateJacobians(const double* extrinsics,
+                         const double* intrinsics,
+                         const double* point,
+                         const Eigen::Matrix3d& rotation,
+                         const Eigen::Vector3d& adjusted_point,
+                         const Eigen::Vector2d& distorted,
+                         const Eigen::Matrix<double, 2, 3>& d_distorted_d_point,
+                         const IntrinsicsJacobian& d_intrinsics,
+                         double** jacobians) const {
+    typedef Eigen::Matrix<double, 2, Camera::kExtrinsicsSize, Eigen::RowMajor>
+        ExtrinsicsJacobian;
+    typedef Eigen::Matrix<double, 2, 4, Eigen::RowMajor> PointJacobian;
+    static const int kNumDistortionParameters =
+        kIntrinsicsSize - CameraModel::PRINCIPAL_POINT_Y - 1;
+
+    const T focal_length = static_cast<T>(intrinsics[CameraModel::FOCAL_LENGTH]);
+    const T aspect_ratio = static_cast<T>(intrinsics[CameraModel::ASPECT_RATIO]);
+    const T skew = static_cast<T>(intrinsics[CameraModel::SKEW]);
+    const Eigen::Matrix<T, 2, 1> sqrt_information =
+        sqrt_information_.template cast<T>();
+    const Eigen::Matrix<T, 2, 1> distorted_point = distorted.template cast<T>();
+
+    // Derivative of the weighted residual with respect to the distorted point
+    // and the camera coordinates of the point.
+    Eigen::Matrix<T, 2, 2> d_residual_d_distorted;
+    d_residual_d_distorted << sqrt_information.x() * focal_length,
+        sqrt_information.x() * skew, T(0),
+        sqrt_information.y() * focal_length * aspect_ratio;
+    const Eigen::Matrix<T, 2, 3> d_residual_d_camera_point =
+        d_residual_d_distorted * d_distorted_d_point.template cast<T>();
+    const Eigen::Matrix<T, 2, 3> d_residual_d_adjusted_point =
+        d_residual_d_camera_point * rotation.template cast<T>();
+
+    if (jacobians[0] != nullptr) {
+      Eigen::Map<ExtrinsicsJacobian> d_extrinsics(jacobians[0]);
+      d_extrinsics.template block<2, 3>(0, Camera::POSITION) =
+          (-static_cast<T>(point[3]) * d_residual_d_adjusted_point)
+              .template cast<double>();
+      d_extrinsics.template block<2, 3>(0, Camera::ORIENTATION) =
+          (d_residual_d_camera_point *
+           RotatedPointJacobian<T>(
+               Eigen::Map<const Eigen::Vector3d>(extrinsics +
+                                                 Camera::ORIENTATION)
+                   .template cast<T>(),
+               rotation.template cast<T>(),
+               adjusted_point.template cast<T>()))
+              .template cast<double>();
+    }
+
+    if (jacobians[1] != nullptr) {
+      Eigen::Map<IntrinsicsJacobian> d_intrinsics_out(jacobians[1]);
+      d_intrinsics_out.template rightCols<kNumDistortionParameters>() =
+          (d_residual_d_distorted *
+           d_intrinsics.template rightCols<kNumDistortionParameters>()
+               .template cast<T>())
+              .template cast<double>();
+      d_intrinsics_out.col(CameraModel::FOCAL_LENGTH)
+          << sqrt_information.x() * distorted_point.x(),
+          sqrt_information.y() * aspect_ratio * distorted_point.y();
+      d_intrinsics_out.col(CameraModel::ASPECT_RATIO)
+          << 0.0,
+          sqrt_information.y() * focal_length * distorted_point.y();
+      d_intrinsics_out.col(CameraModel::SKEW)
+          << sqrt_information.x() * distorted_point.y(),
+          0.0;
+      d_intrinsics_out.col(CameraModel::PRINCIPAL_POINT_X)
+          << sqrt_information_.x(),
+          0.0;
+      d_intrinsics_out.col(CameraModel::PRINCIPAL_POINT_Y) << 0.0,
+          sqrt_information_.y();
+    }
+
+    if (jacobians[2] != nullptr) {
+      Eigen::Map<PointJacobian> d_point(jacobians[2]);
+      d_point.template leftCols<3>() =
+          d_residual_d_adjusted_point.template cast<double>();
+      d_point.col(3) = (-d_residual_d_adjusted_point *
+                        Eigen::Map<const Eigen::Vector3d>(extrinsics +
+                                                          Camera::POSITION)
+                            .template cast<T>())
+                           .template cast<double>();
+    }
+  }
+
+  // The derivative of R(w) * v with respect to the angle-axis rotation w is
+  // -R(w) * [v]_x * J_r(w), where J_r is the right Jacobian of SO(3). Near
+  // the identity J_r is approximated to first order.
+  template <typename T>
+  static Eigen::Matrix<T, 3, 3> RotatedPointJacobian(
+      const Eigen::Matrix<T, 3, 1>& w,
+      const Eigen::Matrix<T, 3, 3>& rotation,
+      const Eigen::Matrix<T, 3, 1>& v) {
+    const T theta_sq = w.squaredNorm();
+    const Eigen::Matrix<T, 3, 3> w_hat = CrossProductMatrix<T>(w);
+
+    Eigen::Matrix<T, 3, 3> right_jacobian;
+    if (theta_sq > std::numeric_limits<T>::epsilon()) {
+      const T theta = std::sqrt(theta_sq);
+      right_jacobian = Eigen::Matrix<T, 3, 3>::Identity() -
+                       (T(1) - std::cos(theta)) / theta_sq * w_hat +
+                       (theta - std::sin(theta)) / (theta_sq * theta) * w_hat *
+                           w_hat;
+    } else {
+      right_jacobian = Eigen::Matrix<T, 3, 3>::Identity() - T(0.5) * w_hat;
+    }
+    return -rotation * CrossProductMatrix<T>(v) * right_jacobian;
+  }
+
+  template <typename T>
+  static Eigen::Matrix<T, 3, 3> CrossProductMatrix(
+      const Eigen::Matrix<T, 3, 1>& v) {
+    Eigen::Matrix<T, 3, 3> cross_product_matrix;
+    cross_product_matrix << T(0), -v.z(), v.y(), v.z(), T(0), -v.x(), -v.y(),
+        v.x(), T(0);
+    return cross_product_matrix;
+  }
+
+  const Eigen::Vector2d feature_;
+  const Eigen::Vector2d sqrt_information_;
+  const bool* single_precision_jacobians_;
+};
+
+}  // namespace theia
+
+#endif  // THEIA_SFM_CAMERA_ANALYTIC_REPROJECTION_ERROR_H_
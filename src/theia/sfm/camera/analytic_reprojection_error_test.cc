@@ -0,0 +1,205 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#include <Eigen/Core>
+#include <ceres/ceres.h>
+#include <memory>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "theia/sfm/camera/analytic_reprojection_error.h"
+#include "theia/sfm/camera/camera.h"
+#include "theia/sfm/camera/create_reprojection_error_cost_function.h"
+#include "theia/sfm/feature.h"
+
+namespace theia {
+
+namespace {
+
+static const double kTolerance = 1e-8;
+
+// Evaluates the autodiff and the analytic reprojection error for the given
+// camera model and checks that the residuals and Jacobians agree.
+void CheckAgainstAutoDiff(const CameraIntrinsicsModelType type,
+                          std::vector<double> intrinsics,
+                          const Eigen::Vector4d& point_in) {
+  Feature feature(Eigen::Vector2d(300.0, 200.0));
+  feature.covariance_ << 4.0, 0.0, 0.0, 9.0;
+
+  std::unique_ptr<ceres::CostFunction> autodiff(
+      CreateReprojectionErrorCostFunction(type, feature, false));
+  std::unique_ptr<ceres::CostFunction> analytic(
+      CreateReprojectionErrorCostFunction(type, feature, true));
+  ASSERT_EQ(autodiff->parameter_block_sizes(),
+            analytic->parameter_block_sizes());
+  ASSERT_EQ(analytic->num_residuals(), 2);
+
+  double extrinsics[Camera::kExtrinsicsSize] = {0.3, -0.2, 0.5, 0.2, -0.4, 0.3};
+  Eigen::Vector4d point = point_in;
+  double* parameters[3] = {extrinsics, intrinsics.data(), point.data()};
+
+  const std::vector<int32_t>& block_sizes = analytic->parameter_block_sizes();
+  std::vector<std::vector<double>> autodiff_jacobians(3), analytic_jacobians(3);
+  double* autodiff_jacobian_ptrs[3];
+  double* analytic_jacobian_ptrs[3];
+  for (int i = 0; i < 3; i++) {
+    autodiff_jacobians[i].resize(2 * block_sizes[i]);
+    analytic_jacobians[i].resize(2 * block_sizes[i]);
+    autodiff_jacobian_ptrs[i] = autodiff_jacobians[i].data();
+    analytic_jacobian_ptrs[i] = analytic_jacobians[i].data();
+  }
+
+  double autodiff_residuals[2], analytic_residuals[2];
+  ASSERT_TRUE(autodiff->Evaluate(
+      parameters, autodiff_residuals, autodiff_jacobian_ptrs));
+  ASSERT_TRUE(analytic->Evaluate(
+      parameters, analytic_residuals, analytic_jacobian_ptrs));
+
+  for (int i = 0; i < 2; i++) {
+    EXPECT_NEAR(autodiff_residuals[i], analytic_residuals[i], kTolerance);
+  }
+  for (int i = 0; i < 3; i++) {
+    for (int j = 0; j < autodiff_jacobians[i].size(); j++) {
+      EXPECT_NEAR(autodiff_jacobians[i][j],
+                  analytic_jacobians[i][j],
+                  kTolerance * (1.0 + std::abs(autodiff_jacobians[i][j])))
+          << "Parameter block " << i << ", entry " << j;
+    }
+  }
+
+  // Only some of the Jacobians may be requested.
+  double* partial_jacobian_ptrs[3] = {nullptr, analytic_jacobian_ptrs[1],
+                                      nullptr};
+  EXPECT_TRUE(analytic->Evaluate(
+      parameters, analytic_residuals, partial_jacobian_ptrs));
+  EXPECT_TRUE(analytic->Evaluate(parameters, analytic_residuals, nullptr));
+}
+
+}  // namespace
+
+TEST(AnalyticReprojectionError, Pinhole) {
+  CheckAgainstAutoDiff(CameraIntrinsicsModelType::PINHOLE,
+                       {800.0, 1.1, 0.3, 320.0, 240.0, -0.1, 0.02},
+                       Eigen::Vector4d(1.2, -0.7, 6.0, 1.1));
+}
+
+TEST(AnalyticReprojectionError, PinholeRadialTangential) {
+  CheckAgainstAutoDiff(
+      CameraIntrinsicsModelType::PINHOLE_RADIAL_TANGENTIAL,
+      {800.0, 1.1, 0.3, 320.0, 240.0, -0.1, 0.02, 0.003, 0.001, -0.002},
+      Eigen::Vector4d(1.2, -0.7, 6.0, 1.1));
+}
+
+TEST(AnalyticReprojectionError, Fisheye) {
+  const std::vector<double> intrinsics = {
+      800.0, 1.1, 0.3, 320.0, 240.0, -0.1, 0.02, 0.003, 0.001};
+  CheckAgainstAutoDiff(CameraIntrinsicsModelType::FISHEYE,
+                       intrinsics,
+                       Eigen::Vector4d(1.2, -0.7, 6.0, 1.1));
+  // Points behind the camera are valid for fisheye cameras.
+  CheckAgainstAutoDiff(CameraIntrinsicsModelType::FISHEYE,
+                       intrinsics,
+                       Eigen::Vector4d(1.2, -0.7, -4.5, 1.1));
+}
+
+TEST(AnalyticReprojectionError, DoubleSphere) {
+  CheckAgainstAutoDiff(CameraIntrinsicsModelType::DOUBLE_SPHERE,
+                       {800.0, 1.1, 0.3, 320.0, 240.0, -0.2, 0.6},
+                       Eigen::Vector4d(1.2, -0.7, 6.0, 1.1));
+}
+
+TEST(AnalyticReprojectionError, SinglePrecisionJacobians) {
+  // Single precision Jacobians are accurate to about 1e-6 relative error and
+  // the residuals are unaffected.
+  static const double kSinglePrecisionTolerance = 1e-5;
+  Feature feature(Eigen::Vector2d(300.0, 200.0));
+  bool single_precision_jacobians = false;
+  AnalyticReprojectionError<PinholeRadialTangentialCameraModel> cost_function(
+      feature, &single_precision_jacobians);
+
+  double extrinsics[Camera::kExtrinsicsSize] = {0.3, -0.2, 0.5, 0.2, -0.4, 0.3};
+  double intrinsics[PinholeRadialTangentialCameraModel::kIntrinsicsSize] = {
+      800.0, 1.1, 0.3, 320.0, 240.0, -0.1, 0.02, 0.003, 0.001, -0.002};
+  double point[4] = {1.2, -0.7, 6.0, 1.1};
+  const double* parameters[3] = {extrinsics, intrinsics, point};
+
+  double double_residuals[2], single_residuals[2];
+  double double_jacobians[3][2 * 10], single_jacobians[3][2 * 10];
+  double* double_jacobian_ptrs[3] = {
+      double_jacobians[0], double_jacobians[1], double_jacobians[2]};
+  double* single_jacobian_ptrs[3] = {
+      single_jacobians[0], single_jacobians[1], single_jacobians[2]};
+  ASSERT_TRUE(cost_function.Evaluate(
+      parameters, double_residuals, double_jacobian_ptrs));
+  single_precision_jacobians = true;
+  ASSERT_TRUE(cost_function.Evaluate(
+      parameters, single_residuals, single_jacobian_ptrs));
+
+  EXPECT_EQ(double_residuals[0], single_residuals[0]);
+  EXPECT_EQ(double_residuals[1], single_residuals[1]);
+  const int block_sizes[3] = {
+      Camera::kExtrinsicsSize,
+      PinholeRadialTangentialCameraModel::kIntrinsicsSize,
+      4};
+  for (int i = 0; i < 3; i++) {
+    for (int j = 0; j < 2 * block_sizes[i]; j++) {
+      EXPECT_NEAR(double_jacobians[i][j],
+                  single_jacobians[i][j],
+                  kSinglePrecisionTolerance *
+                      (1.0 + std::abs(double_jacobians[i][j])));
+    }
+  }
+}
+
+TEST(AnalyticReprojectionError, PointAtCameraCenterIsRejected) {
+  Feature feature(Eigen::Vector2d(300.0, 200.0));
+  AnalyticReprojectionError<PinholeCameraModel> cost_function(feature);
+  double extrinsics[Camera::kExtrinsicsSize] = {1.0, 2.0, 3.0, 0.0, 0.0, 0.0};
+  double intrinsics[PinholeCameraModel::kIntrinsicsSize] = {
+      800.0, 1.0, 0.0, 320.0, 240.0, 0.0, 0.0};
+  double point[4] = {2.0, 4.0, 6.0, 2.0};
+  const double* parameters[3] = {extrinsics, intrinsics, point};
+  double residuals[2];
+  EXPECT_FALSE(cost_function.Evaluate(parameters, residuals, nullptr));
+}
+
+TEST(AnalyticReprojectionError, UnsupportedModelsUseAutoDiff) {
+  EXPECT_FALSE(
+      HasAnalyticReprojectionError(CameraIntrinsicsModelType::FOV));
+  EXPECT_TRUE(
+      HasAnalyticReprojectionError(CameraIntrinsicsModelType::FISHEYE));
+}
+
+}  // namespace theia
@@ -212,6 +212,18 @@ double Camera::ProjectPoint(const Vector4d& point, Vector2d* pixel) const {
   return rotated_point[2] / point[3];
 }
 
+void Camera::ProjectPoints(const Eigen::Matrix4Xd& points,
+                           Eigen::Matrix2Xd* pixels,
+                           Eigen::VectorXd* depths) const {
+  CHECK_NOTNULL(pixels);
+  CHECK_NOTNULL(depths);
+  const Matrix3d rotation = GetOrientationAsRotationMatrix();
+  const Eigen::Matrix3Xd rotated_points =
+      rotation * (points.topRows<3>() - GetPosition() * points.row(3));
+  camera_intrinsics_->CameraToImageCoordinates(rotated_points, pixels);
+  *depths = rotated_points.row(2).cwiseQuotient(points.row(3)).transpose();
+}
+
 Vector3d Camera::PixelToUnitDepthRay(const Vector2d& pixel) const {
   // Remove the effect of calibration.
   const Vector3d undistorted_point = PixelToNormalizedCoordinates(pixel);
@@ -226,6 +238,22 @@ Vector3d Camera::PixelToNormalizedCoordinates(const Vector2d& pixel) const {
   return camera_intrinsics_->ImageToCameraCoordinates(pixel);
 }
 
+void Camera::PixelsToBearings(const Eigen::Matrix2Xd& pixels,
+                              Eigen::Matrix3Xd* bearings) const {
+  CHECK_NOTNULL(bearings);
+  Eigen::Matrix3Xd normalized_points;
+  camera_intrinsics_->ImageToCameraCoordinates(pixels, &normalized_points);
+  *bearings = GetOrientationAsRotationMatrix().transpose() * normalized_points;
+  bearings->colwise().normalize();
+}
+
+void Camera::BuildUndistortionMap(const double grid_spacing_in_pixels) {
+  CHECK_GT(ImageWidth(), 0);
+  CHECK_GT(ImageHeight(), 0);
+  camera_intrinsics_->BuildUndistortionMap(
+      ImageWidth(), ImageHeight(), grid_spacing_in_pixels);
+}
+
 void Camera::PrintCameraIntrinsics() const {
   camera_intrinsics_->PrintIntrinsics();
 }
@@ -303,4 +331,20 @@ std::tuple<double, Eigen::Vector2d> Camera::ProjectPointWrapper(
   double depth = ProjectPoint(point, &pixel);
   return std::make_tuple(depth, pixel);
 }
+
+std::tuple<Eigen::VectorXd, Eigen::Matrix2Xd> Camera::ProjectPointsWrapper(
+    const Eigen::Matrix4Xd& points) {
+  Eigen::Matrix2Xd pixels;
+  Eigen::VectorXd depths;
+  ProjectPoints(points, &pixels, &depths);
+  return std::make_tuple(depths, pixels);
+}
+
+Eigen::Matrix3Xd Camera::PixelsToBearingsWrapper(
+    const Eigen::Matrix2Xd& pixels) {
+  Eigen::Matrix3Xd bearings;
+  PixelsToBearings(pixels, &bearings);
+  return bearings;
+}
+
 }  // namespace theia
@@ -124,6 +124,16 @@ class Camera {
   std::tuple<double, Eigen::Vector2d> ProjectPointWrapper(
       const Eigen::Vector4d& point);
 
+  // Batched version of ProjectPoint: projects each homogeneous point (one per
+  // column) and returns the pixels and depths in the corresponding columns and
+  // entries. The orientation is converted to a rotation matrix once and the
+  // intrinsics model is resolved once for the whole batch.
+  void ProjectPoints(const Eigen::Matrix4Xd& points,
+                     Eigen::Matrix2Xd* pixels,
+                     Eigen::VectorXd* depths) const;
+  std::tuple<Eigen::VectorXd, Eigen::Matrix2Xd> ProjectPointsWrapper(
+      const Eigen::Matrix4Xd& points);
+
   // Converts the pixel point to a ray in 3D space such that the origin of the
   // ray is at the camera center and the direction is the pixel direction
   // rotated according to the camera orientation in 3D space.
@@ -149,6 +159,19 @@ class Camera {
   Eigen::Vector3d PixelToNormalizedCoordinates(
       const Eigen::Vector2d& pixel) const;
 
+  // Converts each pixel (one per column) to the unit-norm direction of its ray
+  // in the world coordinate system, i.e. the normalized PixelToUnitDepthRay.
+  // The intrinsics model is resolved once for the whole batch.
+  void PixelsToBearings(const Eigen::Matrix2Xd& pixels,
+                        Eigen::Matrix3Xd* bearings) const;
+  Eigen::Matrix3Xd PixelsToBearingsWrapper(const Eigen::Matrix2Xd& pixels);
+
+  // Caches the inverse lens distortion of the camera intrinsics over the image
+  // so that pixels are converted by a lookup instead of an iterative
+  // undistortion. See CameraIntrinsicsModel::BuildUndistortionMap. The image
+  // size must be set.
+  void BuildUndistortionMap(const double grid_spacing_in_pixels = 4.0);
+
   // Print the camera intrinsics values in a human-readable format.
   void PrintCameraIntrinsics() const;
 
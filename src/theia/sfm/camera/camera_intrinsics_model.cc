@@ -35,6 +35,7 @@
 #include "theia/sfm/camera/camera_intrinsics_model.h"
 
 #include <Eigen/Core>
+#include <glog/logging.h>
 #include <memory>
 
 #include "theia/sfm/camera/division_undistortion_camera_model.h"
@@ -45,6 +46,7 @@
 #include "theia/sfm/camera/orthographic_camera_model.h"
 #include "theia/sfm/camera/pinhole_camera_model.h"
 #include "theia/sfm/camera/pinhole_radial_tangential_camera_model.h"
+#include "theia/sfm/camera/undistortion_map.h"
 
 namespace theia {
 
@@ -147,9 +149,29 @@ Eigen::Vector2d CameraIntrinsicsModel::CameraToImageCoordinates(
   return pixel;
 }
 
+void CameraIntrinsicsModel::CameraToImageCoordinates(
+    const Eigen::Matrix3Xd& points, Eigen::Matrix2Xd* pixels) const {
+  CHECK_NOTNULL(pixels);
+
+// Define the functions that we want to execute in every case of the switch
+// statement. CameraModel will be filled in with the appropriate derived
+// class.
+#define CAMERA_MODEL_CASE_BODY(CameraModel) \
+  BatchCameraToPixelCoordinates<CameraModel>(parameters(), points, pixels);
+
+  // Execute the switch statement.
+  CAMERA_MODEL_SWITCH_STATEMENT
+
+#undef CAMERA_MODEL_CASE_BODY
+}
+
 Eigen::Vector3d CameraIntrinsicsModel::ImageToCameraCoordinates(
     const Eigen::Vector2d& pixel) const {
   Eigen::Vector3d point;
+  if (HasValidUndistortionMap() &&
+      undistortion_map_->ImageToCameraCoordinates(*this, pixel, &point)) {
+    return point;
+  }
 
 // Define the functions that we want to execute in every case of the switch
 // statement. CameraModel will be filled in with the appropriate derived
@@ -166,6 +188,44 @@ Eigen::Vector3d CameraIntrinsicsModel::ImageToCameraCoordinates(
   return point;
 }
 
+void CameraIntrinsicsModel::ImageToCameraCoordinates(
+    const Eigen::Matrix2Xd& pixels, Eigen::Matrix3Xd* points) const {
+  CHECK_NOTNULL(points);
+  if (HasValidUndistortionMap()) {
+    undistortion_map_->ImageToCameraCoordinates(*this, pixels, points);
+    return;
+  }
+
+// Define the functions that we want to execute in every case of the switch
+// statement. CameraModel will be filled in with the appropriate derived
+// class.
+#define CAMERA_MODEL_CASE_BODY(CameraModel) \
+  BatchPixelToCameraCoordinates<CameraModel>(parameters(), pixels, points);
+
+  // Execute the switch statement.
+  CAMERA_MODEL_SWITCH_STATEMENT
+
+#undef CAMERA_MODEL_CASE_BODY
+}
+
+void CameraIntrinsicsModel::BuildUndistortionMap(
+    const int image_width,
+    const int image_height,
+    const double grid_spacing_in_pixels) {
+  // The grid must be tabulated with the exact undistortion.
+  undistortion_map_.reset();
+  undistortion_map_ = std::make_shared<const UndistortionMap>(
+      *this, image_width, image_height, grid_spacing_in_pixels);
+}
+
+void CameraIntrinsicsModel::ClearUndistortionMap() {
+  undistortion_map_.reset();
+}
+
+bool CameraIntrinsicsModel::HasValidUndistortionMap() const {
+  return undistortion_map_ != nullptr && undistortion_map_->IsValidFor(*this);
+}
+
 Eigen::Vector2d CameraIntrinsicsModel::DistortPoint(
     const Eigen::Vector2d& undistorted_point) const {
   Eigen::Vector2d distorted_point;
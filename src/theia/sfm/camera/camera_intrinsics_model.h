@@ -49,6 +49,8 @@
 
 namespace theia {
 
+class UndistortionMap;
+
 // This class encapsulates the camera lens model used for projecting points in
 // space onto the pixels in images. We utilize two coordinate systems:
 //
@@ -175,11 +177,37 @@ class CameraIntrinsicsModel {
   virtual Eigen::Vector2d CameraToImageCoordinates(
       const Eigen::Vector3d& point) const;
 
+  // Same as above, but projects each column of points into the corresponding
+  // column of pixels. The camera model is resolved once for the whole batch
+  // and the model's batched kernel (see BatchCameraToPixelCoordinates below)
+  // is then applied to all points, which avoids a virtual call and a switch
+  // per point.
+  void CameraToImageCoordinates(const Eigen::Matrix3Xd& points,
+                                Eigen::Matrix2Xd* pixels) const;
+
   // Converts image pixel coordinates to normalized coordinates in the camera
   // coordinates by removing the effect of camera intrinsics/calibration.
   virtual Eigen::Vector3d ImageToCameraCoordinates(
       const Eigen::Vector2d& pixel) const;
 
+  // Same as above, but converts each column of pixels into the corresponding
+  // column of points.
+  void ImageToCameraCoordinates(const Eigen::Matrix2Xd& pixels,
+                                Eigen::Matrix3Xd* points) const;
+
+  // Caches the inverse of the lens distortion on a grid over the image (see
+  // UndistortionMap) so that ImageToCameraCoordinates costs a bilinear lookup
+  // and one Newton step instead of an iterative undistortion. Cameras in the
+  // same intrinsics group share this object and therefore the cache. The cache
+  // is not serialized and is ignored once the parameters change, after which
+  // it must be rebuilt to take effect again. Building the cache is not thread
+  // safe, but using it is.
+  void BuildUndistortionMap(const int image_width,
+                            const int image_height,
+                            const double grid_spacing_in_pixels = 4.0);
+  void ClearUndistortionMap();
+  bool HasValidUndistortionMap() const;
+
   // Apply or remove radial distortion to the given point. Points should be
   // given in *normalized* coordinates such that the effects of camera
   // intrinsics are not present.
@@ -208,6 +236,7 @@ class CameraIntrinsicsModel {
 
  protected:
   std::vector<double> parameters_;
+  std::shared_ptr<const UndistortionMap> undistortion_map_;
 
   // Templated method for disk I/O with cereal. This method tells cereal which
   // data members should be used when reading/writing to/from disk.
@@ -218,6 +247,33 @@ class CameraIntrinsicsModel {
   }
 };
 
+// Batched projection kernels used by the batched CameraToImageCoordinates and
+// ImageToCameraCoordinates methods. By default the model's static per-point
+// method is applied to every column; models whose projection is a closed-form
+// expression specialize these templates with Eigen array expressions so that
+// the points are processed with SIMD instructions.
+template <class CameraModel>
+void BatchCameraToPixelCoordinates(const double* intrinsic_parameters,
+                                   const Eigen::Matrix3Xd& points,
+                                   Eigen::Matrix2Xd* pixels) {
+  pixels->resize(2, points.cols());
+  for (Eigen::Index i = 0; i < points.cols(); ++i) {
+    CameraModel::CameraToPixelCoordinates(
+        intrinsic_parameters, points.col(i).data(), pixels->col(i).data());
+  }
+}
+
+template <class CameraModel>
+void BatchPixelToCameraCoordinates(const double* intrinsic_parameters,
+                                   const Eigen::Matrix2Xd& pixels,
+                                   Eigen::Matrix3Xd* points) {
+  points->resize(3, pixels.cols());
+  for (Eigen::Index i = 0; i < pixels.cols(); ++i) {
+    CameraModel::PixelToCameraCoordinates(
+        intrinsic_parameters, pixels.col(i).data(), points->col(i).data());
+  }
+}
+
 }  // namespace theia
 
 CEREAL_CLASS_VERSION(theia::CameraIntrinsicsModel, 0)
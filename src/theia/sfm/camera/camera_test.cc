@@ -41,7 +41,9 @@
 #include "theia/alignment/alignment.h"
 #include "theia/sfm/camera/camera.h"
 #include "theia/sfm/camera/camera_intrinsics_model.h"
+#include "theia/sfm/camera/orthographic_camera_model.h"
 #include "theia/sfm/camera/pinhole_camera_model.h"
+#include "theia/sfm/camera/pinhole_radial_tangential_camera_model.h"
 #include "theia/test/test_utils.h"
 #include "theia/util/random.h"
 
@@ -219,6 +221,116 @@ TEST(Camera, Reprojection) {
   }
 }
 
+const CameraIntrinsicsModelType kModelTypes[] = {
+    CameraIntrinsicsModelType::PINHOLE,
+    CameraIntrinsicsModelType::PINHOLE_RADIAL_TANGENTIAL,
+    CameraIntrinsicsModelType::FISHEYE,
+    CameraIntrinsicsModelType::FOV,
+    CameraIntrinsicsModelType::DIVISION_UNDISTORTION,
+    CameraIntrinsicsModelType::DOUBLE_SPHERE,
+    CameraIntrinsicsModelType::EXTENDED_UNIFIED,
+    CameraIntrinsicsModelType::ORTHOGRAPHIC};
+
+// Adds lens distortion to the models that have a vectorized batch projection
+// so that the distortion terms are exercised.
+void SetDistortion(Camera* camera) {
+  double* intrinsics = camera->mutable_intrinsics();
+  switch (camera->GetCameraIntrinsicsModelType()) {
+    case CameraIntrinsicsModelType::PINHOLE:
+      intrinsics[PinholeCameraModel::RADIAL_DISTORTION_1] = 0.05;
+      intrinsics[PinholeCameraModel::RADIAL_DISTORTION_2] = -0.01;
+      break;
+    case CameraIntrinsicsModelType::PINHOLE_RADIAL_TANGENTIAL:
+      intrinsics[PinholeRadialTangentialCameraModel::RADIAL_DISTORTION_1] =
+          0.05;
+      intrinsics[PinholeRadialTangentialCameraModel::RADIAL_DISTORTION_2] =
+          -0.01;
+      intrinsics[PinholeRadialTangentialCameraModel::RADIAL_DISTORTION_3] =
+          0.001;
+      intrinsics[PinholeRadialTangentialCameraModel::TANGENTIAL_DISTORTION_1] =
+          0.002;
+      intrinsics[PinholeRadialTangentialCameraModel::TANGENTIAL_DISTORTION_2] =
+          -0.003;
+      break;
+    case CameraIntrinsicsModelType::ORTHOGRAPHIC:
+      intrinsics[OrthographicCameraModel::RADIAL_DISTORTION_1] = 0.01;
+      intrinsics[OrthographicCameraModel::RADIAL_DISTORTION_2] = -0.001;
+      break;
+    default:
+      break;
+  }
+}
+
+TEST(Camera, ProjectPointsMatchesProjectPoint) {
+  static const int kNumPoints = 50;
+
+  for (const CameraIntrinsicsModelType model_type : kModelTypes) {
+    Camera camera(model_type);
+    camera.SetFocalLength(500.0);
+    camera.SetPrincipalPoint(300.0, 200.0);
+    camera.SetPosition(rng.RandVector3d());
+    camera.SetOrientationFromAngleAxis(0.2 * rng.RandVector3d());
+    SetDistortion(&camera);
+
+    Eigen::Matrix4Xd points(4, kNumPoints);
+    for (int i = 0; i < kNumPoints; i++) {
+      const Vector3d point =
+          camera.GetPosition() +
+          camera.GetOrientationAsRotationMatrix().transpose() *
+              Vector3d(rng.RandDouble(-1.0, 1.0),
+                       rng.RandDouble(-1.0, 1.0),
+                       rng.RandDouble(2.0, 10.0));
+      const double scale = rng.RandDouble(0.5, 2.0);
+      points.col(i) << scale * point, scale;
+    }
+
+    Eigen::Matrix2Xd pixels;
+    Eigen::VectorXd depths;
+    camera.ProjectPoints(points, &pixels, &depths);
+    ASSERT_EQ(pixels.cols(), kNumPoints);
+    ASSERT_EQ(depths.size(), kNumPoints);
+    for (int i = 0; i < kNumPoints; i++) {
+      Vector2d pixel;
+      const double depth = camera.ProjectPoint(points.col(i), &pixel);
+      EXPECT_NEAR(depth, depths[i], 1e-8);
+      EXPECT_NEAR(pixel.x(), pixels(0, i), 1e-6);
+      EXPECT_NEAR(pixel.y(), pixels(1, i), 1e-6);
+    }
+  }
+}
+
+TEST(Camera, PixelsToBearingsMatchesPixelToUnitDepthRay) {
+  static const int kNumPixels = 50;
+
+  for (const CameraIntrinsicsModelType model_type : kModelTypes) {
+    if (model_type == CameraIntrinsicsModelType::ORTHOGRAPHIC) {
+      // Orthographic pixels do not back-project to rays through the center.
+      continue;
+    }
+    Camera camera(model_type);
+    camera.SetFocalLength(500.0);
+    camera.SetPrincipalPoint(300.0, 200.0);
+    camera.SetPosition(rng.RandVector3d());
+    camera.SetOrientationFromAngleAxis(0.2 * rng.RandVector3d());
+    SetDistortion(&camera);
+
+    Eigen::Matrix2Xd pixels(2, kNumPixels);
+    for (int i = 0; i < kNumPixels; i++) {
+      pixels.col(i) = Vector2d(rng.RandDouble(100.0, 500.0),
+                               rng.RandDouble(50.0, 350.0));
+    }
+
+    Eigen::Matrix3Xd bearings;
+    camera.PixelsToBearings(pixels, &bearings);
+    ASSERT_EQ(bearings.cols(), kNumPixels);
+    for (int i = 0; i < kNumPixels; i++) {
+      const Vector3d ray = camera.PixelToUnitDepthRay(pixels.col(i));
+      EXPECT_NEAR(bearings.col(i).norm(), 1.0, 1e-12);
+      EXPECT_LT((ray.normalized() - bearings.col(i)).norm(), 1e-12);
+    }
+  }
+}
+
 TEST(Camera, SetCameraIntrinsicsModelType) {
   static const double kFocalLength = 100.0;
 
@@ -35,6 +35,7 @@
 #ifndef THEIA_SFM_CAMERA_CREATE_REPROJECTION_ERROR_COST_FUNCTION_H_
 #define THEIA_SFM_CAMERA_CREATE_REPROJECTION_ERROR_COST_FUNCTION_H_
 
+#include "theia/sfm/camera/analytic_reprojection_error.h"
 #include "theia/sfm/camera/camera_intrinsics_model.h"
 #include "theia/sfm/camera/division_undistortion_camera_model.h"
 #include "theia/sfm/camera/double_sphere_camera_model.h"
@@ -51,11 +52,39 @@ namespace theia {
 // intrinsics model that is passed in. The ReprojectionError struct is templated
 // on the camera intrinsics model class and so it will automatically model the
 // reprojection error appropriately.
+//
+// If use_analytic_jacobians is true and the camera model has a hand-derived
+// Jacobian (see analytic_reprojection_error.h), that cost function is returned
+// instead of the automatically differentiated one. Both compute the same
+// residuals. For analytic cost functions, single_precision_jacobians controls
+// the precision of the Jacobians (see AnalyticReprojectionError).
 inline ceres::CostFunction* CreateReprojectionErrorCostFunction(
     const CameraIntrinsicsModelType& camera_model_type,
-    const Feature& feature) {
+    const Feature& feature,
+    const bool use_analytic_jacobians = false,
+    const bool* single_precision_jacobians = nullptr) {
   static const int kResidualSize = 2;
   static const int kPointSize = 4;
+  if (use_analytic_jacobians) {
+    switch (camera_model_type) {
+      case CameraIntrinsicsModelType::PINHOLE:
+        return new AnalyticReprojectionError<PinholeCameraModel>(
+            feature, single_precision_jacobians);
+      case CameraIntrinsicsModelType::PINHOLE_RADIAL_TANGENTIAL:
+        return new AnalyticReprojectionError<
+            PinholeRadialTangentialCameraModel>(feature,
+                                                single_precision_jacobians);
+      case CameraIntrinsicsModelType::FISHEYE:
+        return new AnalyticReprojectionError<FisheyeCameraModel>(
+            feature, single_precision_jacobians);
+      case CameraIntrinsicsModelType::DOUBLE_SPHERE:
+        return new AnalyticReprojectionError<DoubleSphereCameraModel>(
+            feature, single_precision_jacobians);
+      default:
+        break;
+    }
+  }
+
   // Return the appropriate reprojection error cost function based on the camera
   // model type.
   switch (camera_model_type) {
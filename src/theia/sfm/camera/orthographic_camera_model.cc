@@ -175,4 +175,41 @@ double OrthographicCameraModel::RadialDistortion2() const {
   return parameters_[RADIAL_DISTORTION_2];
 }
 
+template <>
+void BatchCameraToPixelCoordinates<OrthographicCameraModel>(
+    const double* intrinsic_parameters,
+    const Eigen::Matrix3Xd& points,
+    Eigen::Matrix2Xd* pixels) {
+  typedef Eigen::Array<double, 1, Eigen::Dynamic> RowArrayXd;
+  const double fx =
+      intrinsic_parameters[OrthographicCameraModel::FOCAL_LENGTH];
+  const double aspect_ratio =
+      intrinsic_parameters[OrthographicCameraModel::ASPECT_RATIO];
+  const double skew = intrinsic_parameters[OrthographicCameraModel::SKEW];
+  const double principal_point_x =
+      intrinsic_parameters[OrthographicCameraModel::PRINCIPAL_POINT_X];
+  const double principal_point_y =
+      intrinsic_parameters[OrthographicCameraModel::PRINCIPAL_POINT_Y];
+  const double radial_distortion1 =
+      intrinsic_parameters[OrthographicCameraModel::RADIAL_DISTORTION_1];
+  const double radial_distortion2 =
+      intrinsic_parameters[OrthographicCameraModel::RADIAL_DISTORTION_2];
+
+  // Apply radial distortion. The orthographic projection drops the depth.
+  const RowArrayXd x = points.row(0).array();
+  const RowArrayXd y = points.row(1).array();
+  const RowArrayXd r_sq = x.square() + y.square();
+  const RowArrayXd d =
+      1.0 + r_sq * (radial_distortion1 + radial_distortion2 * r_sq);
+  const RowArrayXd distorted_x = x * d;
+  const RowArrayXd distorted_y = y * d;
+
+  // Apply calibration parameters to transform normalized units into pixels.
+  const double fy = fx * aspect_ratio;
+  pixels->resize(2, points.cols());
+  pixels->row(0) =
+      (fx * distorted_x + skew * distorted_y + principal_point_x).matrix();
+  pixels->row(1) = (fy * distorted_y + principal_point_y).matrix();
+}
+
 }  // namespace theia
@@ -273,6 +273,13 @@ bool OrthographicCameraModel::UndistortPoint(const T* intrinsic_parameters,
   return true;
 }
 
+// Projects all points at once with Eigen array expressions.
+template <>
+void BatchCameraToPixelCoordinates<OrthographicCameraModel>(
+    const double* intrinsic_parameters,
+    const Eigen::Matrix3Xd& points,
+    Eigen::Matrix2Xd* pixels);
+
 }  // namespace theia
 
 #include <cereal/archives/portable_binary.hpp>
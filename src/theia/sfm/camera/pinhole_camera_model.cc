@@ -212,4 +212,44 @@ double PinholeCameraModel::RadialDistortion2() const {
   return parameters_[RADIAL_DISTORTION_2];
 }
 
+template <>
+void BatchCameraToPixelCoordinates<PinholeCameraModel>(
+    const double* intrinsic_parameters,
+    const Eigen::Matrix3Xd& points,
+    Eigen::Matrix2Xd* pixels) {
+  typedef Eigen::Array<double, 1, Eigen::Dynamic> RowArrayXd;
+  const double focal_length =
+      intrinsic_parameters[PinholeCameraModel::FOCAL_LENGTH];
+  const double skew = intrinsic_parameters[PinholeCameraModel::SKEW];
+  const double aspect_ratio =
+      intrinsic_parameters[PinholeCameraModel::ASPECT_RATIO];
+  const double principal_point_x =
+      intrinsic_parameters[PinholeCameraModel::PRINCIPAL_POINT_X];
+  const double principal_point_y =
+      intrinsic_parameters[PinholeCameraModel::PRINCIPAL_POINT_Y];
+  const double radial_distortion1 =
+      intrinsic_parameters[PinholeCameraModel::RADIAL_DISTORTION_1];
+  const double radial_distortion2 =
+      intrinsic_parameters[PinholeCameraModel::RADIAL_DISTORTION_2];
+
+  // Get normalized pixel projections at image plane depth = 1.
+  const RowArrayXd x = points.row(0).array() / points.row(2).array();
+  const RowArrayXd y = points.row(1).array() / points.row(2).array();
+
+  // Apply radial distortion.
+  const RowArrayXd r_sq = x.square() + y.square();
+  const RowArrayXd d =
+      1.0 + r_sq * (radial_distortion1 + radial_distortion2 * r_sq);
+  const RowArrayXd distorted_x = x * d;
+  const RowArrayXd distorted_y = y * d;
+
+  // Apply calibration parameters to transform normalized units into pixels.
+  pixels->resize(2, points.cols());
+  pixels->row(0) =
+      (focal_length * distorted_x + skew * distorted_y + principal_point_x)
+          .matrix();
+  pixels->row(1) =
+      (focal_length * aspect_ratio * distorted_y + principal_point_y).matrix();
+}
+
 }  // namespace theia
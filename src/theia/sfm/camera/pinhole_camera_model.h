@@ -299,6 +299,13 @@ bool PinholeCameraModel::UndistortPoint(const T* intrinsic_parameters,
   return true;
 }
 
+// Projects all points at once with Eigen array expressions.
+template <>
+void BatchCameraToPixelCoordinates<PinholeCameraModel>(
+    const double* intrinsic_parameters,
+    const Eigen::Matrix3Xd& points,
+    Eigen::Matrix2Xd* pixels);
+
 }  // namespace theia
 
 #include <cereal/archives/portable_binary.hpp>
@@ -264,4 +264,57 @@ double PinholeRadialTangentialCameraModel::TangentialDistortion2() const {
   return parameters_[TANGENTIAL_DISTORTION_2];
 }
 
+template <>
+void BatchCameraToPixelCoordinates<PinholeRadialTangentialCameraModel>(
+    const double* intrinsic_parameters,
+    const Eigen::Matrix3Xd& points,
+    Eigen::Matrix2Xd* pixels) {
+  typedef Eigen::Array<double, 1, Eigen::Dynamic> RowArrayXd;
+  const double focal_length =
+      intrinsic_parameters[PinholeRadialTangentialCameraModel::FOCAL_LENGTH];
+  const double skew =
+      intrinsic_parameters[PinholeRadialTangentialCameraModel::SKEW];
+  const double aspect_ratio =
+      intrinsic_parameters[PinholeRadialTangentialCameraModel::ASPECT_RATIO];
+  const double principal_point_x = intrinsic_parameters
+      [PinholeRadialTangentialCameraModel::PRINCIPAL_POINT_X];
+  const double principal_point_y = intrinsic_parameters
+      [PinholeRadialTangentialCameraModel::PRINCIPAL_POINT_Y];
+  const double radial_distortion1 = intrinsic_parameters
+      [PinholeRadialTangentialCameraModel::RADIAL_DISTORTION_1];
+  const double radial_distortion2 = intrinsic_parameters
+      [PinholeRadialTangentialCameraModel::RADIAL_DISTORTION_2];
+  const double radial_distortion3 = intrinsic_parameters
+      [PinholeRadialTangentialCameraModel::RADIAL_DISTORTION_3];
+  const double tangential_distortion1 = intrinsic_parameters
+      [PinholeRadialTangentialCameraModel::TANGENTIAL_DISTORTION_1];
+  const double tangential_distortion2 = intrinsic_parameters
+      [PinholeRadialTangentialCameraModel::TANGENTIAL_DISTORTION_2];
+
+  // Get normalized pixel projections at image plane depth = 1.
+  const RowArrayXd x = points.row(0).array() / points.row(2).array();
+  const RowArrayXd y = points.row(1).array() / points.row(2).array();
+
+  // Apply radial and tangential distortion.
+  const RowArrayXd r_sq = x.square() + y.square();
+  const RowArrayXd rd =
+      1.0 + r_sq * (radial_distortion1 +
+                    r_sq * (radial_distortion2 + radial_distortion3 * r_sq));
+  const RowArrayXd xy = x * y;
+  const RowArrayXd distorted_x =
+      x * rd + tangential_distortion2 * (r_sq + 2.0 * x.square()) +
+      2.0 * tangential_distortion1 * xy;
+  const RowArrayXd distorted_y =
+      y * rd + tangential_distortion1 * (r_sq + 2.0 * y.square()) +
+      2.0 * tangential_distortion2 * xy;
+
+  // Apply calibration parameters to transform normalized units into pixels.
+  pixels->resize(2, points.cols());
+  pixels->row(0) =
+      (focal_length * distorted_x + skew * distorted_y + principal_point_x)
+          .matrix();
+  pixels->row(1) =
+      (focal_length * aspect_ratio * distorted_y + principal_point_y).matrix();
+}
+
 }  // namespace theia
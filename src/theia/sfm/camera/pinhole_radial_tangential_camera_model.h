@@ -361,6 +361,13 @@ bool PinholeRadialTangentialCameraModel::UndistortPoint(
   return true;
 }
 
+// Projects all points at once with Eigen array expressions.
+template <>
+void BatchCameraToPixelCoordinates<PinholeRadialTangentialCameraModel>(
+    const double* intrinsic_parameters,
+    const Eigen::Matrix3Xd& points,
+    Eigen::Matrix2Xd* pixels);
+
 }  // namespace theia
 
 #include <cereal/archives/portable_binary.hpp>
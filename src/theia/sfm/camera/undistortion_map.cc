@@ -0,0 +1,170 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#include "theia/sfm/camera/undistortion_map.h"
+
+#include <Eigen/Core>
+#include <algorithm>
+#include <cmath>
+#include <glog/logging.h>
+#include <vector>
+
+#include "theia/sfm/camera/camera_intrinsics_model.h"
+
+namespace theia {
+
+UndistortionMap::UndistortionMap(const CameraIntrinsicsModel& intrinsics,
+                                 const int image_width,
+                                 const int image_height,
+                                 const double grid_spacing)
+    : type_(intrinsics.Type()),
+      parameters_(intrinsics.parameters(),
+                  intrinsics.parameters() + intrinsics.NumParameters()),
+      grid_spacing_(grid_spacing) {
+  CHECK_GT(image_width, 0);
+  CHECK_GT(image_height, 0);
+  CHECK_GT(grid_spacing, 0.0);
+
+  num_cells_x_ =
+      std::max(1, static_cast<int>(std::ceil(image_width / grid_spacing)));
+  num_cells_y_ =
+      std::max(1, static_cast<int>(std::ceil(image_height / grid_spacing)));
+
+  Eigen::Matrix2Xd grid_pixels(2, (num_cells_x_ + 1) * (num_cells_y_ + 1));
+  for (int y = 0; y <= num_cells_y_; y++) {
+    for (int x = 0; x <= num_cells_x_; x++) {
+      grid_pixels.col(y * (num_cells_x_ + 1) + x) =
+          Eigen::Vector2d(x * grid_spacing_, y * grid_spacing_);
+    }
+  }
+
+  Eigen::Matrix3Xd grid_points;
+  intrinsics.ImageToCameraCoordinates(grid_pixels, &grid_points);
+  nodes_.resize(grid_points.cols());
+  for (int i = 0; i < grid_points.cols(); i++) {
+    nodes_[i] = grid_points.col(i);
+  }
+}
+
+bool UndistortionMap::IsValidFor(
+    const CameraIntrinsicsModel& intrinsics) const {
+  return intrinsics.Type() == type_ &&
+         intrinsics.NumParameters() == parameters_.size() &&
+         std::equal(
+             parameters_.begin(), parameters_.end(), intrinsics.parameters());
+}
+
+bool UndistortionMap::Interpolate(const Eigen::Vector2d& pixel,
+                                  Eigen::Vector3d* point,
+                                  Eigen::Matrix<double, 3, 2>* jacobian) const {
+  const double u = pixel.x() / grid_spacing_;
+  const double v = pixel.y() / grid_spacing_;
+  // Written so that NaN pixels are rejected as well.
+  if (!(u >= 0.0 && u <= num_cells_x_ && v >= 0.0 && v <= num_cells_y_)) {
+    return false;
+  }
+
+  const int x = std::min(static_cast<int>(u), num_cells_x_ - 1);
+  const int y = std::min(static_cast<int>(v), num_cells_y_ - 1);
+  const double fu = u - x;
+  const double fv = v - y;
+  const Eigen::Vector3d& p00 = Node(x, y);
+  const Eigen::Vector3d& p10 = Node(x + 1, y);
+  const Eigen::Vector3d& p01 = Node(x, y + 1);
+  const Eigen::Vector3d& p11 = Node(x + 1, y + 1);
+  if (!p00.allFinite() || !p10.allFinite() || !p01.allFinite() ||
+      !p11.allFinite()) {
+    return false;
+  }
+
+  *point = (1.0 - fv) * ((1.0 - fu) * p00 + fu * p10) +
+           fv * ((1.0 - fu) * p01 + fu * p11);
+  jacobian->col(0) =
+      ((1.0 - fv) * (p10 - p00) + fv * (p11 - p01)) / grid_spacing_;
+  jacobian->col(1) =
+      ((1.0 - fu) * (p01 - p00) + fu * (p11 - p10)) / grid_spacing_;
+  return true;
+}
+
+bool UndistortionMap::ImageToCameraCoordinates(
+    const CameraIntrinsicsModel& intrinsics,
+    const Eigen::Vector2d& pixel,
+    Eigen::Vector3d* point) const {
+  Eigen::Matrix<double, 3, 2> jacobian;
+  if (!Interpolate(pixel, point, &jacobian)) {
+    return false;
+  }
+
+  // Newton step on the projection.
+  const Eigen::Vector2d projection =
+      intrinsics.CameraToImageCoordinates(*point);
+  *point += jacobian * (pixel - projection);
+  return true;
+}
+
+void UndistortionMap::ImageToCameraCoordinates(
+    const CameraIntrinsicsModel& intrinsics,
+    const Eigen::Matrix2Xd& pixels,
+    Eigen::Matrix3Xd* points) const {
+  points->resize(3, pixels.cols());
+  Eigen::Matrix3Xd jacobians_x(3, pixels.cols());
+  Eigen::Matrix3Xd jacobians_y(3, pixels.cols());
+  std::vector<char> interpolated(pixels.cols());
+  for (int i = 0; i < pixels.cols(); i++) {
+    Eigen::Vector3d point;
+    Eigen::Matrix<double, 3, 2> jacobian;
+    interpolated[i] = Interpolate(pixels.col(i), &point, &jacobian);
+    if (interpolated[i]) {
+      points->col(i) = point;
+      jacobians_x.col(i) = jacobian.col(0);
+      jacobians_y.col(i) = jacobian.col(1);
+    } else {
+      points->col(i) = intrinsics.ImageToCameraCoordinates(
+          Eigen::Vector2d(pixels.col(i)));
+    }
+  }
+
+  // Newton step on the projections of all interpolated points at once.
+  Eigen::Matrix2Xd projections;
+  intrinsics.CameraToImageCoordinates(*points, &projections);
+  for (int i = 0; i < pixels.cols(); i++) {
+    if (interpolated[i]) {
+      const Eigen::Vector2d residual = pixels.col(i) - projections.col(i);
+      points->col(i) +=
+          residual.x() * jacobians_x.col(i) + residual.y() * jacobians_y.col(i);
+    }
+  }
+}
+
+}  // namespace theia
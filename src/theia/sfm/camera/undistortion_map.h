@@ -0,0 +1,106 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#ifndef THEIA_SFM_CAMERA_UNDISTORTION_MAP_H_
+#define THEIA_SFM_CAMERA_UNDISTORTION_MAP_H_
+
+#include <Eigen/Core>
+#include <vector>
+
+#include "theia/sfm/camera/camera_intrinsics_model_type.h"
+
+namespace theia {
+
+class CameraIntrinsicsModel;
+
+// A cached inverse of the lens distortion of a camera intrinsics model. The
+// exact ImageToCameraCoordinates of the model is tabulated on a regular grid of
+// pixels covering the image. A pixel is then converted by bilinear
+// interpolation of the grid followed by one Newton step: the interpolated point
+// is projected back into the image and the pixel residual is mapped back
+// through the derivative of the interpolant, which approximates the inverse of
+// the projection Jacobian. This costs one forward projection per pixel instead
+// of an iterative undistortion.
+//
+// The map remembers the intrinsics parameters it was built from and is only
+// valid for a model with exactly the same type and parameters.
+class UndistortionMap {
+ public:
+  // Tabulates the intrinsics on nodes spaced grid_spacing pixels apart that
+  // cover the image [0, image_width] x [0, image_height].
+  UndistortionMap(const CameraIntrinsicsModel& intrinsics,
+                  const int image_width,
+                  const int image_height,
+                  const double grid_spacing);
+
+  // Returns true if the map was built from intrinsics with the same type and
+  // parameters as the input.
+  bool IsValidFor(const CameraIntrinsicsModel& intrinsics) const;
+
+  // Converts the pixel to camera coordinates. Returns false if the pixel lies
+  // outside of the grid or too close to a region where the exact
+  // undistortion is undefined, in which case the caller should fall back to
+  // the exact method.
+  bool ImageToCameraCoordinates(const CameraIntrinsicsModel& intrinsics,
+                                const Eigen::Vector2d& pixel,
+                                Eigen::Vector3d* point) const;
+
+  // Same as above for each column of pixels. Pixels that cannot be looked up
+  // are converted with the exact method of the intrinsics.
+  void ImageToCameraCoordinates(const CameraIntrinsicsModel& intrinsics,
+                                const Eigen::Matrix2Xd& pixels,
+                                Eigen::Matrix3Xd* points) const;
+
+ private:
+  // Bilinearly interpolates the grid at the pixel and returns the derivative
+  // of the interpolant with respect to the pixel.
+  bool Interpolate(const Eigen::Vector2d& pixel,
+                   Eigen::Vector3d* point,
+                   Eigen::Matrix<double, 3, 2>* jacobian) const;
+
+  const Eigen::Vector3d& Node(const int x, const int y) const {
+    return nodes_[y * (num_cells_x_ + 1) + x];
+  }
+
+  CameraIntrinsicsModelType type_;
+  std::vector<double> parameters_;
+  double grid_spacing_;
+  int num_cells_x_;
+  int num_cells_y_;
+  std::vector<Eigen::Vector3d> nodes_;
+};
+
+}  // namespace theia
+
+#endif  // THEIA_SFM_CAMERA_UNDISTORTION_MAP_H_
@@ -0,0 +1,176 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#include <Eigen/Core>
+#include <memory>
+
+#include "gtest/gtest.h"
+
+#include "theia/sfm/camera/camera_intrinsics_model.h"
+#include "theia/sfm/camera/fisheye_camera_model.h"
+#include "theia/sfm/camera/pinhole_camera_model.h"
+#include "theia/sfm/camera/pinhole_radial_tangential_camera_model.h"
+#include "theia/sfm/camera/undistortion_map.h"
+#include "theia/util/random.h"
+
+namespace theia {
+
+namespace {
+
+RandomNumberGenerator rng(61);
+
+static const int kImageWidth = 1200;
+static const int kImageHeight = 800;
+
+// Checks that the cached undistortion reprojects to within tolerance pixels of
+// the input and that the batched lookup matches the single lookup.
+void TestUndistortionMap(const CameraIntrinsicsModel& intrinsics,
+                         const double tolerance) {
+  std::shared_ptr<CameraIntrinsicsModel> cached_intrinsics =
+      CameraIntrinsicsModel::Create(intrinsics.Type());
+  *cached_intrinsics = intrinsics;
+  cached_intrinsics->BuildUndistortionMap(kImageWidth, kImageHeight);
+  ASSERT_TRUE(cached_intrinsics->HasValidUndistortionMap());
+
+  static const int kNumPixels = 1000;
+  Eigen::Matrix2Xd pixels(2, kNumPixels);
+  for (int i = 0; i < kNumPixels; i++) {
+    pixels.col(i) = Eigen::Vector2d(rng.RandDouble(0.0, kImageWidth),
+                                    rng.RandDouble(0.0, kImageHeight));
+  }
+
+  Eigen::Matrix3Xd points;
+  cached_intrinsics->ImageToCameraCoordinates(pixels, &points);
+  for (int i = 0; i < kNumPixels; i++) {
+    const Eigen::Vector2d pixel = pixels.col(i);
+    const Eigen::Vector3d point =
+        cached_intrinsics->ImageToCameraCoordinates(pixel);
+    EXPECT_LT((intrinsics.CameraToImageCoordinates(point) - pixel).norm(),
+              tolerance);
+    EXPECT_LT((points.col(i) - point).norm(), 1e-12);
+  }
+}
+
+}  // namespace
+
+TEST(UndistortionMap, Pinhole) {
+  PinholeCameraModel intrinsics;
+  intrinsics.SetFocalLength(1000.0);
+  intrinsics.SetPrincipalPoint(600.0, 400.0);
+  intrinsics.SetParameter(PinholeCameraModel::RADIAL_DISTORTION_1, -0.2);
+  intrinsics.SetParameter(PinholeCameraModel::RADIAL_DISTORTION_2, 0.05);
+  TestUndistortionMap(intrinsics, 1e-5);
+}
+
+TEST(UndistortionMap, PinholeRadialTangential) {
+  PinholeRadialTangentialCameraModel intrinsics;
+  intrinsics.SetFocalLength(1000.0);
+  intrinsics.SetPrincipalPoint(600.0, 400.0);
+  intrinsics.SetParameter(
+      PinholeRadialTangentialCameraModel::RADIAL_DISTORTION_1, -0.2);
+  intrinsics.SetParameter(
+      PinholeRadialTangentialCameraModel::RADIAL_DISTORTION_2, 0.05);
+  intrinsics.SetParameter(
+      PinholeRadialTangentialCameraModel::TANGENTIAL_DISTORTION_1, 0.001);
+  intrinsics.SetParameter(
+      PinholeRadialTangentialCameraModel::TANGENTIAL_DISTORTION_2, -0.002);
+  TestUndistortionMap(intrinsics, 1e-5);
+}
+
+TEST(UndistortionMap, Fisheye) {
+  FisheyeCameraModel intrinsics;
+  intrinsics.SetFocalLength(500.0);
+  intrinsics.SetPrincipalPoint(600.0, 400.0);
+  intrinsics.SetParameter(FisheyeCameraModel::RADIAL_DISTORTION_1, 0.1);
+  intrinsics.SetParameter(FisheyeCameraModel::RADIAL_DISTORTION_2, -0.02);
+  TestUndistortionMap(intrinsics, 1e-3);
+}
+
+TEST(UndistortionMap, InvalidatedByParameterChange) {
+  PinholeCameraModel intrinsics;
+  intrinsics.SetFocalLength(1000.0);
+  intrinsics.SetPrincipalPoint(600.0, 400.0);
+  intrinsics.SetParameter(PinholeCameraModel::RADIAL_DISTORTION_1, -0.2);
+  intrinsics.BuildUndistortionMap(kImageWidth, kImageHeight);
+  EXPECT_TRUE(intrinsics.HasValidUndistortionMap());
+
+  intrinsics.SetParameter(PinholeCameraModel::RADIAL_DISTORTION_1, -0.1);
+  EXPECT_FALSE(intrinsics.HasValidUndistortionMap());
+
+  // The stale map must not be used.
+  PinholeCameraModel expected_intrinsics;
+  expected_intrinsics = intrinsics;
+  const Eigen::Vector2d pixel(100.0, 50.0);
+  EXPECT_LT((intrinsics.ImageToCameraCoordinates(pixel) -
+             expected_intrinsics.ImageToCameraCoordinates(pixel))
+                .norm(),
+            1e-12);
+
+  intrinsics.BuildUndistortionMap(kImageWidth, kImageHeight);
+  EXPECT_TRUE(intrinsics.HasValidUndistortionMap());
+  intrinsics.ClearUndistortionMap();
+  EXPECT_FALSE(intrinsics.HasValidUndistortionMap());
+}
+
+TEST(UndistortionMap, PixelsOutsideOfImage) {
+  PinholeCameraModel intrinsics;
+  intrinsics.SetFocalLength(1000.0);
+  intrinsics.SetPrincipalPoint(600.0, 400.0);
+  intrinsics.SetParameter(PinholeCameraModel::RADIAL_DISTORTION_1, -0.05);
+  const UndistortionMap undistortion_map(
+      intrinsics, kImageWidth, kImageHeight, 4.0);
+
+  Eigen::Vector3d point;
+  EXPECT_FALSE(undistortion_map.ImageToCameraCoordinates(
+      intrinsics, Eigen::Vector2d(-1.0, 10.0), &point));
+  EXPECT_FALSE(undistortion_map.ImageToCameraCoordinates(
+      intrinsics, Eigen::Vector2d(10.0, kImageHeight + 10.0), &point));
+  EXPECT_TRUE(undistortion_map.ImageToCameraCoordinates(
+      intrinsics, Eigen::Vector2d(kImageWidth, kImageHeight), &point));
+
+  // The batched version falls back to the exact undistortion.
+  Eigen::Matrix2Xd pixels(2, 2);
+  pixels.col(0) = Eigen::Vector2d(-100.0, 10.0);
+  pixels.col(1) = Eigen::Vector2d(300.0, 200.0);
+  Eigen::Matrix3Xd points;
+  undistortion_map.ImageToCameraCoordinates(intrinsics, pixels, &points);
+  for (int i = 0; i < 2; i++) {
+    EXPECT_LT((points.col(i) - intrinsics.ImageToCameraCoordinates(
+                                   Eigen::Vector2d(pixels.col(i))))
+                  .norm(),
+              1e-8);
+  }
+}
+
+}  // namespace theia
@@ -0,0 +1,135 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+
+#include "theia/sfm/camera_rig.h"
+
+#include <Eigen/Core>
+#include <ceres/rotation.h>
+#include <glog/logging.h>
+
+#include "theia/sfm/camera/camera.h"
+
+namespace theia {
+
+void RigExtrinsicsFromCameraExtrinsics(const double* camera_extrinsics,
+                                       const double* camera_to_rig_extrinsics,
+                                       double* rig_extrinsics) {
+  // R_rig = R_cam^T * R and c_rig = c - R_rig^T * c_cam.
+  double camera_rotation[4], rotation[4], rig_rotation[4];
+  ceres::AngleAxisToQuaternion(camera_to_rig_extrinsics + Camera::ORIENTATION,
+                               camera_rotation);
+  ceres::AngleAxisToQuaternion(camera_extrinsics + Camera::ORIENTATION,
+                               rotation);
+  camera_rotation[1] = -camera_rotation[1];
+  camera_rotation[2] = -camera_rotation[2];
+  camera_rotation[3] = -camera_rotation[3];
+  ceres::QuaternionProduct(camera_rotation, rotation, rig_rotation);
+  ceres::QuaternionToAngleAxis(rig_rotation,
+                               rig_extrinsics + Camera::ORIENTATION);
+
+  const double inverse_rig_rotation[3] = {
+      -rig_extrinsics[Camera::ORIENTATION + 0],
+      -rig_extrinsics[Camera::ORIENTATION + 1],
+      -rig_extrinsics[Camera::ORIENTATION + 2]};
+  double offset[3];
+  ceres::AngleAxisRotatePoint(inverse_rig_rotation,
+                              camera_to_rig_extrinsics + Camera::POSITION,
+                              offset);
+  for (int i = 0; i < 3; i++) {
+    rig_extrinsics[Camera::POSITION + i] =
+        camera_extrinsics[Camera::POSITION + i] - offset[i];
+  }
+}
+
+int CameraRig::AddCamera(const Eigen::Vector3d& position,
+                         const Eigen::Vector3d& orientation_angle_axis) {
+  camera_extrinsics_.emplace_back();
+  const int camera_index = camera_extrinsics_.size() - 1;
+  SetCameraPosition(camera_index, position);
+  SetCameraOrientationFromAngleAxis(camera_index, orientation_angle_axis);
+  return camera_index;
+}
+
+const double* CameraRig::CameraExtrinsics(const int camera_index) const {
+  CHECK_GE(camera_index, 0);
+  CHECK_LT(camera_index, camera_extrinsics_.size());
+  return camera_extrinsics_[camera_index].data();
+}
+
+double* CameraRig::MutableCameraExtrinsics(const int camera_index) {
+  CHECK_GE(camera_index, 0);
+  CHECK_LT(camera_index, camera_extrinsics_.size());
+  return camera_extrinsics_[camera_index].data();
+}
+
+Eigen::Vector3d CameraRig::CameraPosition(const int camera_index) const {
+  return Eigen::Map<const Eigen::Vector3d>(CameraExtrinsics(camera_index) +
+                                           Camera::POSITION);
+}
+
+Eigen::Vector3d CameraRig::CameraOrientationAsAngleAxis(
+    const int camera_index) const {
+  return Eigen::Map<const Eigen::Vector3d>(CameraExtrinsics(camera_index) +
+                                           Camera::ORIENTATION);
+}
+
+void CameraRig::SetCameraPosition(const int camera_index,
+                                  const Eigen::Vector3d& position) {
+  Eigen::Map<Eigen::Vector3d>(MutableCameraExtrinsics(camera_index) +
+                              Camera::POSITION) = position;
+}
+
+void CameraRig::SetCameraOrientationFromAngleAxis(
+    const int camera_index, const Eigen::Vector3d& orientation_angle_axis) {
+  Eigen::Map<Eigen::Vector3d>(MutableCameraExtrinsics(camera_index) +
+                              Camera::ORIENTATION) = orientation_angle_axis;
+}
+
+void CameraRig::ComposeCameraPose(const int camera_index,
+                                  const double* rig_extrinsics,
+                                  Camera* camera) const {
+  ComposeRigCameraExtrinsics(rig_extrinsics,
+                             CameraExtrinsics(camera_index),
+                             camera->mutable_extrinsics());
+}
+
+void CameraRig::RigPoseFromCamera(const int camera_index,
+                                  const Camera& camera,
+                                  double* rig_extrinsics) const {
+  RigExtrinsicsFromCameraExtrinsics(
+      camera.extrinsics(), CameraExtrinsics(camera_index), rig_extrinsics);
+}
+
+}  // namespace theia
@@ -0,0 +1,165 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+
+#ifndef THEIA_SFM_CAMERA_RIG_H_
+#define THEIA_SFM_CAMERA_RIG_H_
+
+#include <Eigen/Core>
+#include <array>
+#include <cereal/access.hpp>
+#include <cereal/cereal.hpp>
+#include <cereal/types/array.hpp>
+#include <cereal/types/vector.hpp>
+#include <ceres/rotation.h>
+#include <stdint.h>
+#include <vector>
+
+#include "theia/sfm/camera/camera.h"
+#include "theia/sfm/types.h"
+
+namespace theia {
+
+// Composes the extrinsics of a camera from the pose of the rig that it is
+// mounted on and the pose of the camera relative to the rig. All extrinsics
+// use the layout of Camera::mutable_extrinsics(): the position followed by the
+// angle-axis rotation from the world (or rig) frame to the camera frame. A
+// point X in world coordinates is mapped to the rig frame by
+// R_rig * (X - c_rig) and then to the camera frame by R_cam * (x_rig - c_cam),
+// so the camera has the rotation R_cam * R_rig and the position
+// c_rig + R_rig^T * c_cam. This is templated so that it may be used in cost
+// functions.
+template <typename T>
+void ComposeRigCameraExtrinsics(const T* rig_extrinsics,
+                                const T* camera_to_rig_extrinsics,
+                                T* camera_extrinsics) {
+  T rig_rotation[4], camera_rotation[4], rotation[4];
+  ceres::AngleAxisToQuaternion(rig_extrinsics + Camera::ORIENTATION,
+                               rig_rotation);
+  ceres::AngleAxisToQuaternion(
+      camera_to_rig_extrinsics + Camera::ORIENTATION, camera_rotation);
+  ceres::QuaternionProduct(camera_rotation, rig_rotation, rotation);
+  ceres::QuaternionToAngleAxis(rotation,
+                               camera_extrinsics + Camera::ORIENTATION);
+
+  const T inverse_rig_rotation[3] = {-rig_extrinsics[Camera::ORIENTATION + 0],
+                                     -rig_extrinsics[Camera::ORIENTATION + 1],
+                                     -rig_extrinsics[Camera::ORIENTATION + 2]};
+  T offset[3];
+  ceres::AngleAxisRotatePoint(inverse_rig_rotation,
+                              camera_to_rig_extrinsics + Camera::POSITION,
+                              offset);
+  for (int i = 0; i < 3; i++) {
+    camera_extrinsics[Camera::POSITION + i] =
+        rig_extrinsics[Camera::POSITION + i] + offset[i];
+  }
+}
+
+// The inverse of ComposeRigCameraExtrinsics: recovers the rig pose from the
+// extrinsics of one of its cameras.
+void RigExtrinsicsFromCameraExtrinsics(const double* camera_extrinsics,
+                                       const double* camera_to_rig_extrinsics,
+                                       double* rig_extrinsics);
+
+// A multi-camera rig is a set of cameras that are rigidly mounted to a common
+// body (e.g., the cameras of a capture vehicle) and capture their images at
+// the same time. Each camera of the rig is described by its extrinsics relative
+// to the rig frame, in the same layout as the camera extrinsics. The images
+// that the cameras capture at one timestamp form a rig frame, whose views all
+// share a single rig pose (see Reconstruction::AddViewToCameraRig). Camera 0
+// is typically the reference camera of the rig with identity extrinsics.
+class CameraRig {
+ public:
+  CameraRig() {}
+  ~CameraRig() {}
+
+  // Adds a camera to the rig with its position in the rig frame and the
+  // angle-axis rotation from the rig frame to the camera frame. Returns the
+  // index of the camera in the rig.
+  int AddCamera(const Eigen::Vector3d& position,
+                const Eigen::Vector3d& orientation_angle_axis);
+
+  int NumCameras() const { return camera_extrinsics_.size(); }
+
+  // The extrinsics of the camera relative to the rig frame.
+  const double* CameraExtrinsics(const int camera_index) const;
+  double* MutableCameraExtrinsics(const int camera_index);
+
+  Eigen::Vector3d CameraPosition(const int camera_index) const;
+  Eigen::Vector3d CameraOrientationAsAngleAxis(const int camera_index) const;
+  void SetCameraPosition(const int camera_index,
+                         const Eigen::Vector3d& position);
+  void SetCameraOrientationFromAngleAxis(
+      const int camera_index, const Eigen::Vector3d& orientation_angle_axis);
+
+  // Sets the camera extrinsics from the pose of the rig and vice versa.
+  void ComposeCameraPose(const int camera_index,
+                         const double* rig_extrinsics,
+                         Camera* camera) const;
+  void RigPoseFromCamera(const int camera_index,
+                         const Camera& camera,
+                         double* rig_extrinsics) const;
+
+ private:
+  // Templated method for disk I/O with cereal. This method tells cereal which
+  // data members should be used when reading/writing to/from disk.
+  friend class cereal::access;
+  template <class Archive>
+  void serialize(Archive& ar, const std::uint32_t version) {  // NOLINT
+    ar(camera_extrinsics_);
+  }
+
+  std::vector<std::array<double, Camera::kExtrinsicsSize> > camera_extrinsics_;
+};
+
+// The rig, camera of the rig and rig frame (timestamp index) of a view.
+struct CameraRigMembership {
+  CameraRigId rig_id = kInvalidCameraRigId;
+  int camera_index = -1;
+  int frame_id = -1;
+
+ private:
+  friend class cereal::access;
+  template <class Archive>
+  void serialize(Archive& ar, const std::uint32_t version) {  // NOLINT
+    ar(rig_id, camera_index, frame_id);
+  }
+};
+
+}  // namespace theia
+
+CEREAL_CLASS_VERSION(theia::CameraRig, 0);
+CEREAL_CLASS_VERSION(theia::CameraRigMembership, 0);
+
+#endif  // THEIA_SFM_CAMERA_RIG_H_
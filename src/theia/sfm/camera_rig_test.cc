@@ -0,0 +1,115 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+
+#include <Eigen/Core>
+#include <Eigen/Geometry>
+
+#include "gtest/gtest.h"
+
+#include "theia/sfm/camera/camera.h"
+#include "theia/sfm/camera_rig.h"
+#include "theia/util/random.h"
+
+namespace theia {
+
+namespace {
+
+RandomNumberGenerator rng(58);
+
+// Returns the point in the camera frame.
+Eigen::Vector3d PointInCameraFrame(const double* extrinsics,
+                                   const Eigen::Vector3d& point) {
+  Camera camera;
+  std::copy(extrinsics,
+            extrinsics + Camera::kExtrinsicsSize,
+            camera.mutable_extrinsics());
+  return camera.GetOrientationAsRotationMatrix() *
+         (point - camera.GetPosition());
+}
+
+}  // namespace
+
+TEST(CameraRig, AddCamera) {
+  CameraRig camera_rig;
+  EXPECT_EQ(camera_rig.NumCameras(), 0);
+  const Eigen::Vector3d position(1.0, 2.0, 3.0);
+  const Eigen::Vector3d orientation(0.1, 0.2, 0.3);
+  EXPECT_EQ(camera_rig.AddCamera(Eigen::Vector3d::Zero(),
+                                 Eigen::Vector3d::Zero()),
+            0);
+  EXPECT_EQ(camera_rig.AddCamera(position, orientation), 1);
+  EXPECT_EQ(camera_rig.NumCameras(), 2);
+  EXPECT_EQ(camera_rig.CameraPosition(1), position);
+  EXPECT_EQ(camera_rig.CameraOrientationAsAngleAxis(1), orientation);
+  EXPECT_EQ(camera_rig.CameraExtrinsics(1)[Camera::POSITION + 2], 3.0);
+  EXPECT_EQ(camera_rig.CameraExtrinsics(1)[Camera::ORIENTATION + 2], 0.3);
+}
+
+TEST(CameraRig, ComposeCameraPose) {
+  static const double kTolerance = 1e-10;
+  CameraRig camera_rig;
+  camera_rig.AddCamera(rng.RandVector3d(), 0.5 * rng.RandVector3d());
+
+  for (int i = 0; i < 10; i++) {
+    double rig_extrinsics[Camera::kExtrinsicsSize];
+    Eigen::Map<Eigen::Vector3d>(rig_extrinsics + Camera::POSITION) =
+        5.0 * rng.RandVector3d();
+    Eigen::Map<Eigen::Vector3d>(rig_extrinsics + Camera::ORIENTATION) =
+        rng.RandVector3d();
+
+    // Mapping a point to the rig frame and then to the camera frame must be
+    // the same as mapping it with the composed camera pose.
+    Camera camera;
+    camera_rig.ComposeCameraPose(0, rig_extrinsics, &camera);
+    const Eigen::Vector3d point = 10.0 * rng.RandVector3d();
+    const Eigen::Vector3d point_in_rig =
+        PointInCameraFrame(rig_extrinsics, point);
+    const Eigen::Vector3d expected_point =
+        PointInCameraFrame(camera_rig.CameraExtrinsics(0), point_in_rig);
+    EXPECT_LT((PointInCameraFrame(camera.extrinsics(), point) -
+               expected_point)
+                  .norm(),
+              kTolerance);
+
+    // The rig pose is recovered from the camera pose.
+    double recovered_rig_extrinsics[Camera::kExtrinsicsSize];
+    camera_rig.RigPoseFromCamera(0, camera, recovered_rig_extrinsics);
+    for (int j = 0; j < Camera::kExtrinsicsSize; j++) {
+      EXPECT_NEAR(recovered_rig_extrinsics[j], rig_extrinsics[j], kTolerance);
+    }
+  }
+}
+
+}  // namespace theia
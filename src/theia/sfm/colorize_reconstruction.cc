@@ -36,9 +36,12 @@
 
 #include <Eigen/Core>
 
+#include <algorithm>
+#include <atomic>
 #include <memory>
-#include <mutex>  // NOLINT
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 //#include "theia/image/image.h"
 #include "theia/sfm/reconstruction.h"
@@ -52,36 +55,53 @@
 namespace theia {
 namespace {
 
+// The sum of the observed colors and the number of observations of each track,
+// indexed by the dense index of the track. Each thread owns an accumulator so
+// that no locking is needed while sampling the images.
+struct ColorAccumulator {
+  explicit ColorAccumulator(const int num_tracks)
+      : color_sums(num_tracks, Eigen::Vector3f::Zero()),
+        num_observations(num_tracks, 0) {}
+
+  std::vector<Eigen::Vector3f> color_sums;
+  std::vector<int> num_observations;
+};
+
 void ExtractColorsFromImage(
     const std::string& image_file,
+    const int scale_denominator,
     const View& view,
-    std::unordered_map<TrackId, Eigen::Vector3f>* colors,
-    std::mutex* mutex_lock) {
-  // LOG(INFO) << "Extracting color for features in image: " << image_file;
-  // const FloatImage image(image_file);
-
+    const std::unordered_map<TrackId, int>& track_indices,
+    ColorAccumulator* accumulator) {
+  // VLOG(2) << "Extracting color for features in image: " << image_file;
+  // const FloatImage image(image_file, scale_denominator);
+  // if (image.Channels() != 3 && image.Channels() != 1) {
+  //   LOG(FATAL) << "The image file at: " << image_file
+  //              << " is not an RGB or a grayscale image so the color cannot "
+  //                 "be extracted.";
+  // }
+  //
   // const auto& track_ids = view.TrackIds();
-  // if (image.Channels() == 3) {
-  //   for (const TrackId track_id : track_ids) {
-  //     const Feature feature = *view.GetFeature(track_id);
-  //     const int x = static_cast<int>(feature.x());
-  //     const int y = static_cast<int>(feature.y());
-  //     std::lock_guard<std::mutex> lock(*mutex_lock);
-  //     (*colors)[track_id] += 255.0 * image.GetXY(x, y);
+  // for (const TrackId track_id : track_ids) {
+  //   const int* track_index = FindOrNull(track_indices, track_id);
+  //   if (track_index == nullptr) {
+  //     continue;
   //   }
-  // } else if (image.Channels() == 1) {
-  //   for (const TrackId track_id : track_ids) {
-  //     const Feature feature = *view.GetFeature(track_id);
-  //     const int x = static_cast<int>(feature.x());
-  //     const int y = static_cast<int>(feature.y());
-  //     std::lock_guard<std::mutex> lock(*mutex_lock);
-  //     (*colors)[track_id] += 255.0 * image.GetXY(x, y);
+  //
+  //   // Take the nearest pixel of the downscaled image.
+  //   const Eigen::Vector2d pixel =
+  //       view.GetFeature(track_id)->point_ / scale_denominator;
+  //   const int x = std::min(std::max(static_cast<int>(pixel.x()), 0),
+  //                          image.Width() - 1);
+  //   const int y = std::min(std::max(static_cast<int>(pixel.y()), 0),
+  //                          image.Height() - 1);
+  //   if (image.Channels() == 3) {
+  //     accumulator->color_sums[*track_index] += 255.0 * image.GetXY(x, y);
+  //   } else {
+  //     accumulator->color_sums[*track_index] +=
+  //         Eigen::Vector3f::Constant(255.0 * image.GetXY(x, y, 0));
   //   }
-  // } else {
-  //   LOG(FATAL) << "The image file at: " << image_file
-  //              << " is not an RGB or a grayscale image so the color cannot be
-  //              "
-  //                 "extracted.";
+  //   ++accumulator->num_observations[*track_index];
   // }
 }
 
@@ -90,41 +110,80 @@ void ExtractColorsFromImage(
 void ColorizeReconstruction(const std::string& image_directory,
                             const int num_threads,
                             Reconstruction* reconstruction) {
+  ColorizeReconstruction(image_directory, 1, num_threads, reconstruction);
+}
+
+void ColorizeReconstruction(const std::string& image_directory,
+                            const int scale_denominator,
+                            const int num_threads,
+                            Reconstruction* reconstruction) {
   CHECK(DirectoryExists(image_directory))
       << "The image directory " << image_directory << " does not exist.";
+  CHECK_GT(scale_denominator, 0);
   CHECK_GT(num_threads, 0);
   CHECK_NOTNULL(reconstruction);
 
-  // Initialize the colors to be (0, 0, 0).
+  // Assign a dense index to each track so that the colors may be accumulated
+  // in arrays rather than hash maps.
   const auto& track_ids = reconstruction->TrackIds();
-  std::unordered_map<TrackId, Eigen::Vector3f> colors;
-  for (const TrackId track_id : track_ids) {
-    colors[track_id].setZero();
+  std::unordered_map<TrackId, int> track_indices;
+  track_indices.reserve(track_ids.size());
+  for (int i = 0; i < track_ids.size(); i++) {
+    track_indices.emplace(track_ids[i], i);
   }
 
-  // For each image, find the color of each feature and add the value to the
-  // colors map.
-  std::unique_ptr<ThreadPool> pool(new ThreadPool(num_threads));
-  std::mutex mutex_lock;
   const auto& view_ids = reconstruction->ViewIds();
-  for (const ViewId view_id : view_ids) {
-    const View* view = reconstruction->View(view_id);
-    const std::string image_filepath = image_directory + view->Name();
-    CHECK(FileExists(image_filepath))
-        << "The image file: " << image_filepath << " does not exist!";
-    pool->Add(
-        ExtractColorsFromImage, image_filepath, *view, &colors, &mutex_lock);
+  std::vector<std::string> image_filepaths(view_ids.size());
+  for (int i = 0; i < view_ids.size(); i++) {
+    image_filepaths[i] =
+        image_directory + reconstruction->View(view_ids[i])->Name();
+    CHECK(FileExists(image_filepaths[i]))
+        << "The image file: " << image_filepaths[i] << " does not exist!";
+  }
+
+  // Each thread takes the next view that has not been processed yet, so every
+  // image is decoded exactly once and at most num_threads images are in memory
+  // at any time.
+  const int num_workers =
+      std::max(1, std::min<int>(num_threads, view_ids.size()));
+  std::vector<std::unique_ptr<ColorAccumulator> > accumulators(num_workers);
+  std::atomic<int> next_view_index(0);
+  const auto extract_colors = [&](const int worker) {
+    accumulators[worker].reset(new ColorAccumulator(track_ids.size()));
+    for (int i = next_view_index++; i < view_ids.size();
+         i = next_view_index++) {
+      ExtractColorsFromImage(image_filepaths[i],
+                             scale_denominator,
+                             *reconstruction->View(view_ids[i]),
+                             track_indices,
+                             accumulators[worker].get());
+    }
+  };
+  {
+    ThreadPool pool(num_workers);
+    for (int worker = 0; worker < num_workers; worker++) {
+      pool.Add(extract_colors, worker);
+    }
+    // Wait for all threads to finish before proceeding.
   }
-  // Wait for all threads to finish before proceeding.
-  pool.reset(nullptr);
 
-  // The colors map now contains a sum of all colors, so to get the mean we must
-  // divide by the number of observations in each track.
-  for (const TrackId track_id : track_ids) {
-    Eigen::Vector3f color = FindOrDie(colors, track_id);
+  // The accumulators contain the sums of all observed colors, so to get the
+  // mean we must divide by the number of observations of each track. Tracks
+  // without any observed color keep their current color.
+  for (int i = 0; i < track_ids.size(); i++) {
+    Eigen::Vector3f color_sum = Eigen::Vector3f::Zero();
+    int num_observations = 0;
+    for (const auto& accumulator : accumulators) {
+      color_sum += accumulator->color_sums[i];
+      num_observations += accumulator->num_observations[i];
+    }
+    if (num_observations == 0) {
+      continue;
+    }
 
-    Track* track = reconstruction->MutableTrack(track_id);
-    color /= static_cast<float>(track->NumViews());
+    Track* track = reconstruction->MutableTrack(track_ids[i]);
+    const Eigen::Vector3f color =
+        color_sum / static_cast<float>(num_observations);
     *track->MutableColor() = color.cast<uint8_t>();
   }
 }
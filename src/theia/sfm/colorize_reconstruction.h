@@ -51,6 +51,17 @@ void ColorizeReconstruction(const std::string& image_directory,
                             const int num_threads,
                             Reconstruction* reconstruction);
 
+// Same as above, but samples the colors from the images decoded at
+// 1 / scale_denominator of the full resolution, which is much faster for large
+// JPEG images (see ReadImageAtScale) and good enough for previews. Each image
+// is decoded exactly once and only num_threads images are held in memory at
+// any time. Every thread accumulates the colors into its own buffer so that
+// the threads never contend for a lock.
+void ColorizeReconstruction(const std::string& image_directory,
+                            const int scale_denominator,
+                            const int num_threads,
+                            Reconstruction* reconstruction);
+
 }  // namespace theia
 
 #endif  // THEIA_SFM_COLORIZE_RECONSTRUCTION_H_
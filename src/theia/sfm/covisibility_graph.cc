@@ -0,0 +1,155 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#include "theia/sfm/covisibility_graph.h"
+
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "theia/sfm/reconstruction.h"
+#include "theia/sfm/track.h"
+#include "theia/sfm/types.h"
+#include "theia/sfm/view.h"
+#include "theia/util/map_util.h"
+
+namespace theia {
+
+void CovisibilityGraph::AddView(const Reconstruction& reconstruction,
+                                const ViewId view_id) {
+  if (ContainsKey(edges_, view_id)) {
+    return;
+  }
+
+  const View* view = CHECK_NOTNULL(reconstruction.View(view_id));
+  std::unordered_map<ViewId, int>& neighbors = edges_[view_id];
+  for (const TrackId track_id : view->TrackIds()) {
+    const Track* track = reconstruction.Track(track_id);
+    if (track == nullptr) {
+      continue;
+    }
+
+    for (const ViewId other_view_id : track->ViewIds()) {
+      if (other_view_id == view_id) {
+        continue;
+      }
+      auto other_neighbors = edges_.find(other_view_id);
+      if (other_neighbors == edges_.end()) {
+        continue;
+      }
+      ++neighbors[other_view_id];
+      ++other_neighbors->second[view_id];
+    }
+  }
+}
+
+bool CovisibilityGraph::RemoveView(const ViewId view_id) {
+  auto view_edges = edges_.find(view_id);
+  if (view_edges == edges_.end()) {
+    return false;
+  }
+
+  for (const auto& neighbor : view_edges->second) {
+    auto neighbor_edges = edges_.find(neighbor.first);
+    if (neighbor_edges != edges_.end()) {
+      neighbor_edges->second.erase(view_id);
+    }
+  }
+  edges_.erase(view_edges);
+  return true;
+}
+
+void CovisibilityGraph::Clear() { edges_.clear(); }
+
+bool CovisibilityGraph::HasView(const ViewId view_id) const {
+  return ContainsKey(edges_, view_id);
+}
+
+int CovisibilityGraph::NumViews() const { return edges_.size(); }
+
+int CovisibilityGraph::NumSharedTracks(const ViewId view_id1,
+                                       const ViewId view_id2) const {
+  const auto view_edges = edges_.find(view_id1);
+  if (view_edges == edges_.end()) {
+    return 0;
+  }
+  return FindWithDefault(view_edges->second, view_id2, 0);
+}
+
+std::vector<ViewId> CovisibilityGraph::MostCovisibleViews(
+    const std::vector<ViewId>& view_ids, const int max_num_neighbors) const {
+  std::vector<ViewId> most_covisible_views;
+  if (max_num_neighbors <= 0) {
+    return most_covisible_views;
+  }
+
+  // Accumulate the number of shared tracks with all input views.
+  const std::unordered_set<ViewId> input_views(view_ids.begin(),
+                                               view_ids.end());
+  std::unordered_map<ViewId, int> num_shared_tracks;
+  for (const ViewId view_id : input_views) {
+    const auto view_edges = edges_.find(view_id);
+    if (view_edges == edges_.end()) {
+      continue;
+    }
+    for (const auto& neighbor : view_edges->second) {
+      if (!ContainsKey(input_views, neighbor.first)) {
+        num_shared_tracks[neighbor.first] += neighbor.second;
+      }
+    }
+  }
+
+  // Sort by decreasing weight and increasing view id.
+  std::vector<std::pair<int, ViewId> > scores;
+  scores.reserve(num_shared_tracks.size());
+  for (const auto& neighbor : num_shared_tracks) {
+    scores.emplace_back(-neighbor.second, neighbor.first);
+  }
+  const int num_neighbors =
+      std::min(max_num_neighbors, static_cast<int>(scores.size()));
+  std::partial_sort(
+      scores.begin(), scores.begin() + num_neighbors, scores.end());
+
+  most_covisible_views.reserve(num_neighbors);
+  for (int i = 0; i < num_neighbors; i++) {
+    most_covisible_views.emplace_back(scores[i].second);
+  }
+  return most_covisible_views;
+}
+
+}  // namespace theia
@@ -0,0 +1,90 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#ifndef THEIA_SFM_COVISIBILITY_GRAPH_H_
+#define THEIA_SFM_COVISIBILITY_GRAPH_H_
+
+#include <unordered_map>
+#include <vector>
+
+#include "theia/sfm/types.h"
+
+namespace theia {
+
+class Reconstruction;
+
+// A covisibility graph over the views of a reconstruction. Two views are
+// connected if they observe a common track, and the edge weight is the number
+// of tracks they share. The graph is meant to be maintained incrementally:
+// views are added as they are localized and the edges to all views already in
+// the graph are computed from the track observations of the new view.
+//
+// During incremental SfM this is used to choose the views that are most
+// strongly coupled to the newly added views for local bundle adjustment.
+class CovisibilityGraph {
+ public:
+  CovisibilityGraph() {}
+
+  // Adds the view to the graph and connects it to all views already in the
+  // graph that observe one of its tracks. Adding a view twice has no effect.
+  void AddView(const Reconstruction& reconstruction, const ViewId view_id);
+
+  // Removes the view and all of its edges. Returns false if the view was not
+  // in the graph.
+  bool RemoveView(const ViewId view_id);
+
+  // Removes all views and edges.
+  void Clear();
+
+  bool HasView(const ViewId view_id) const;
+  int NumViews() const;
+
+  // Returns the number of tracks observed by both views, or 0 if the views are
+  // not connected.
+  int NumSharedTracks(const ViewId view_id1, const ViewId view_id2) const;
+
+  // Returns up to max_num_neighbors views that are not in view_ids, sorted by
+  // the total number of tracks they share with the views in view_ids (ties are
+  // broken by the smaller view id).
+  std::vector<ViewId> MostCovisibleViews(const std::vector<ViewId>& view_ids,
+                                         const int max_num_neighbors) const;
+
+ private:
+  // For each view, the views it shares tracks with and how many tracks.
+  std::unordered_map<ViewId, std::unordered_map<ViewId, int> > edges_;
+};
+
+}  // namespace theia
+
+#endif  // THEIA_SFM_COVISIBILITY_GRAPH_H_
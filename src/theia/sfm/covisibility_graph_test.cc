@@ -0,0 +1,124 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "theia/sfm/covisibility_graph.h"
+#include "theia/sfm/reconstruction.h"
+#include "theia/sfm/types.h"
+#include "gtest/gtest.h"
+
+namespace theia {
+
+namespace {
+
+// Builds a reconstruction with 4 views where views 0 and 1 share two tracks,
+// views 1 and 2 share one track and view 3 only shares a track with view 2.
+void BuildReconstruction(Reconstruction* reconstruction) {
+  const Feature feature;
+  for (int i = 0; i < 4; i++) {
+    reconstruction->AddView(std::to_string(i), static_cast<double>(i));
+  }
+  reconstruction->AddTrack({{0, feature}, {1, feature}});
+  reconstruction->AddTrack({{0, feature}, {1, feature}});
+  reconstruction->AddTrack({{1, feature}, {2, feature}});
+  reconstruction->AddTrack({{2, feature}, {3, feature}});
+}
+
+}  // namespace
+
+TEST(CovisibilityGraph, EdgesOnlyToViewsInTheGraph) {
+  Reconstruction reconstruction;
+  BuildReconstruction(&reconstruction);
+
+  CovisibilityGraph graph;
+  graph.AddView(reconstruction, 0);
+  EXPECT_EQ(graph.NumSharedTracks(0, 1), 0);
+
+  graph.AddView(reconstruction, 1);
+  graph.AddView(reconstruction, 2);
+  // Adding a view twice must not double count the edges.
+  graph.AddView(reconstruction, 2);
+  EXPECT_EQ(graph.NumViews(), 3);
+  EXPECT_EQ(graph.NumSharedTracks(0, 1), 2);
+  EXPECT_EQ(graph.NumSharedTracks(1, 0), 2);
+  EXPECT_EQ(graph.NumSharedTracks(1, 2), 1);
+  EXPECT_EQ(graph.NumSharedTracks(0, 2), 0);
+  EXPECT_EQ(graph.NumSharedTracks(2, 3), 0);
+}
+
+TEST(CovisibilityGraph, RemoveView) {
+  Reconstruction reconstruction;
+  BuildReconstruction(&reconstruction);
+
+  CovisibilityGraph graph;
+  for (int i = 0; i < 4; i++) {
+    graph.AddView(reconstruction, i);
+  }
+  EXPECT_TRUE(graph.RemoveView(1));
+  EXPECT_FALSE(graph.RemoveView(1));
+  EXPECT_FALSE(graph.HasView(1));
+  EXPECT_EQ(graph.NumSharedTracks(0, 1), 0);
+  EXPECT_EQ(graph.NumSharedTracks(2, 1), 0);
+  EXPECT_EQ(graph.NumSharedTracks(2, 3), 1);
+
+  // Re-adding the view restores its edges.
+  graph.AddView(reconstruction, 1);
+  EXPECT_EQ(graph.NumSharedTracks(0, 1), 2);
+  EXPECT_EQ(graph.NumSharedTracks(2, 1), 1);
+}
+
+TEST(CovisibilityGraph, MostCovisibleViews) {
+  Reconstruction reconstruction;
+  BuildReconstruction(&reconstruction);
+
+  CovisibilityGraph graph;
+  for (int i = 0; i < 4; i++) {
+    graph.AddView(reconstruction, i);
+  }
+
+  // View 0 shares two tracks with view 1 while view 2 shares only one.
+  EXPECT_EQ(graph.MostCovisibleViews({1}, 2), std::vector<ViewId>({0, 2}));
+  EXPECT_EQ(graph.MostCovisibleViews({1}, 1), std::vector<ViewId>({0}));
+  EXPECT_EQ(graph.MostCovisibleViews({1}, 0).size(), 0);
+
+  // The input views are never returned and weights are accumulated over all
+  // input views.
+  EXPECT_EQ(graph.MostCovisibleViews({1, 3}, 5), std::vector<ViewId>({0, 2}));
+  EXPECT_EQ(graph.MostCovisibleViews({0, 1, 2, 3}, 5).size(), 0);
+}
+
+}  // namespace theia
@@ -39,6 +39,7 @@
 
 #include "theia/solvers/exhaustive_ransac.h"
 #include "theia/solvers/lmed.h"
+#include "theia/solvers/preemptive_ransac.h"
 #include "theia/solvers/prosac.h"
 #include "theia/solvers/ransac.h"
 #include "theia/solvers/evsac.h"
@@ -53,7 +54,8 @@ enum class RansacType {
   RANSAC = 0,
   PROSAC = 1,
   LMED = 2,
-  EXHAUSTIVE = 3
+  EXHAUSTIVE = 3,
+  PREEMPTIVE = 4
 };
 
 // Factory method to create a ransac variant based on the specified options. The
@@ -78,6 +80,10 @@ CreateAndInitializeRansacVariant(const RansacType& ransac_type,
       ransac_variant.reset(
           new ExhaustiveRansac<Estimator>(ransac_options, estimator));
       break;
+    case RansacType::PREEMPTIVE:
+      ransac_variant.reset(
+          new PreemptiveRansac<Estimator>(ransac_options, estimator));
+      break;
 //    case RansacType::EVSAC:
 //      ransac_variant.reset(new Evsac<Estimator>(ransac_options, estimator));
 //      break;
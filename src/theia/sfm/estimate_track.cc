@@ -36,11 +36,15 @@
 
 #include <Eigen/Core>
 #include <Eigen/Geometry>
+#include <algorithm>
+#include <cstdint>
 #include <memory>
 #include <vector>
 
 #include "theia/math/util.h"
+#include "theia/sfm/bundle_adjustment/bundle_adjuster.h"
 #include "theia/sfm/bundle_adjustment/bundle_adjustment.h"
+#include "theia/sfm/bundle_adjustment/refine_tracks.h"
 #include "theia/sfm/estimators/estimate_triangulation.h"
 #include "theia/sfm/feature.h"
 #include "theia/sfm/reconstruction.h"
@@ -48,46 +52,15 @@
 #include "theia/sfm/track.h"
 #include "theia/sfm/triangulation/triangulation.h"
 #include "theia/sfm/types.h"
+#include "theia/sfm/view.h"
 #include "theia/util/map_util.h"
 #include "theia/util/threadpool.h"
+#include "theia/util/trace.h"
 
 namespace theia {
 
 namespace {
 
-void GetObservationsFromTrackViews(
-    const TrackId track_id,
-    const Reconstruction& reconstruction,
-    std::vector<ViewId>* view_ids,
-    std::vector<Eigen::Vector2d>* features,
-    std::vector<Eigen::Vector3d>* origins,
-    std::vector<Matrix3x4d>* proj_matrices,
-    std::vector<Eigen::Vector3d>* ray_directions) {
-  const Track* track = reconstruction.Track(track_id);
-  for (const ViewId view_id : track->ViewIds()) {
-    const View* view = reconstruction.View(view_id);
-
-    // Skip this view if it does not exist or has not been estimated yet.
-    if (view == nullptr || !view->IsEstimated()) {
-      continue;
-    }
-
-    // If the feature is not in the view then we have an ill-formed
-    // reconstruction.
-    const Feature* feature = CHECK_NOTNULL(view->GetFeature(track_id));
-    const Eigen::Vector3d image_ray =
-        view->Camera().PixelToUnitDepthRay((*feature).point_).normalized();
-
-    features->emplace_back((*feature).point_);
-    view_ids->emplace_back(view_id);
-    origins->emplace_back(view->Camera().GetPosition());
-    Matrix3x4d proj_mat;
-    view->Camera().GetProjectionMatrix(&proj_mat);
-    proj_matrices->emplace_back(proj_mat);
-    ray_directions->emplace_back(image_ray);
-  }
-}
-
 // Returns false if the reprojection error of the triangulated point is greater
 // than the max allowable reprojection error (for any observation) and true
 // otherwise.
@@ -120,8 +93,105 @@ bool AcceptableReprojectionError(
 
 }  // namespace
 
+struct TrackEstimator::Workspace {
+  explicit Workspace(const BundleAdjustmentOptions& ba_options)
+      : track_refiner(ba_options) {}
+
+  // The observations of the current track in estimated views.
+  std::vector<ViewId> view_ids;
+  std::vector<Eigen::Vector2d> features;
+  std::vector<Eigen::Vector3d> origins;
+  std::vector<Matrix3x4d> proj_matrices;
+  std::vector<Eigen::Vector3d> ray_directions;
+
+  TrackRefiner track_refiner;
+};
+
+void TrackEstimator::GatherViewCameras(
+    const std::unordered_set<ViewId>& view_ids, ThreadPool* pool) {
+  view_camera_indices_.clear();
+  std::vector<const View*> views;
+  for (const ViewId view_id : view_ids) {
+    const View* view = reconstruction_->View(view_id);
+    if (view != nullptr && view->IsEstimated()) {
+      view_camera_indices_.emplace(view_id, views.size());
+      views.emplace_back(view);
+    }
+  }
+
+  const int num_views = views.size();
+  view_cameras_.resize(num_views);
+  ParallelFor(pool,
+              num_views,
+              std::max(1, std::min(options_.num_threads, num_views)),
+              [&](const int start, const int end) {
+                for (int i = start; i < end; i++) {
+                  const Camera& camera = views[i]->Camera();
+                  view_cameras_[i].position = camera.GetPosition();
+                  camera.GetProjectionMatrix(
+                      &view_cameras_[i].projection_matrix);
+                }
+              });
+}
+
+std::vector<int> TrackEstimator::BalancedTrackRanges(
+    const int num_blocks) const {
+  // The cost of a track grows with the number of views that observe it.
+  int64_t total_length = 0;
+  for (const TrackId track_id : tracks_to_estimate_) {
+    total_length += reconstruction_->Track(track_id)->NumViews();
+  }
+
+  const int num_tracks = tracks_to_estimate_.size();
+  std::vector<int> range_starts = {0};
+  int64_t length = 0;
+  for (int i = 0; i < num_tracks; i++) {
+    length += reconstruction_->Track(tracks_to_estimate_[i])->NumViews();
+    const int num_ranges = range_starts.size();
+    if (num_ranges < num_blocks && i + 1 < num_tracks &&
+        length * num_blocks >= total_length * num_ranges) {
+      range_starts.emplace_back(i + 1);
+    }
+  }
+  range_starts.emplace_back(num_tracks);
+  return range_starts;
+}
+
+void TrackEstimator::GetObservations(const TrackId track_id,
+                                     Workspace* workspace) const {
+  workspace->view_ids.clear();
+  workspace->features.clear();
+  workspace->origins.clear();
+  workspace->proj_matrices.clear();
+  workspace->ray_directions.clear();
+
+  const Track* track = reconstruction_->Track(track_id);
+  for (const ViewId view_id : track->ViewIds()) {
+    // Skip this view if it does not exist or has not been estimated yet.
+    const auto view_camera_index = view_camera_indices_.find(view_id);
+    if (view_camera_index == view_camera_indices_.end()) {
+      continue;
+    }
+    const View* view = reconstruction_->View(view_id);
+    const ViewCamera& view_camera = view_cameras_[view_camera_index->second];
+
+    // If the feature is not in the view then we have an ill-formed
+    // reconstruction.
+    const Feature* feature = CHECK_NOTNULL(view->GetFeature(track_id));
+    Eigen::Vector3d image_ray;
+    CHECK(view->GetBearingVector(track_id, &image_ray));
+
+    workspace->features.emplace_back((*feature).point_);
+    workspace->view_ids.emplace_back(view_id);
+    workspace->origins.emplace_back(view_camera.position);
+    workspace->proj_matrices.emplace_back(view_camera.projection_matrix);
+    workspace->ray_directions.emplace_back(image_ray);
+  }
+}
+
 // Estimate only the tracks supplied by the user.
 TrackEstimator::Summary TrackEstimator::EstimateAllTracks() {
+  THEIA_TRACE_SCOPE("TrackEstimator::EstimateAllTracks");
   // Estimate all tracks that are seen by estimated views.
   const auto& view_ids = reconstruction_->ViewIds();
   std::unordered_set<TrackId> tracks;
@@ -139,6 +209,7 @@ TrackEstimator::Summary TrackEstimator::EstimateAllTracks() {
 
 TrackEstimator::Summary TrackEstimator::EstimateTracks(
     const std::unordered_set<TrackId>& track_ids) {
+  THEIA_TRACE_SCOPE("TrackEstimator::EstimateTracks");
   tracks_to_estimate_.clear();
   summary_ = TrackEstimator::Summary();
   num_bad_angles_ = 0;
@@ -153,6 +224,9 @@ TrackEstimator::Summary TrackEstimator::EstimateTracks(
       tracks_to_estimate_.emplace_back(track_id);
     }
   }
+  // The order of the track set depends on how it was built, so the tracks are
+  // sorted to estimate them (and report them) in the same order every time.
+  std::sort(tracks_to_estimate_.begin(), tracks_to_estimate_.end());
   summary_.input_num_estimated_tracks =
       track_ids.size() - tracks_to_estimate_.size();
   summary_.num_triangulation_attempts = tracks_to_estimate_.size();
@@ -167,21 +241,60 @@ TrackEstimator::Summary TrackEstimator::EstimateTracks(
   // tracks). Since estimating the tracks is so fast, this strategy is better
   // helps speed up multithreaded estimation by reducing the overhead of
   // starting/stopping threads.
-  const int num_threads = std::min(
-      options_.num_threads, static_cast<int>(tracks_to_estimate_.size()));
-  const int interval_step =
-      std::min(options_.multithreaded_step_size,
-               static_cast<int>(tracks_to_estimate_.size()) / num_threads);
-
-  std::unique_ptr<ThreadPool> pool(new ThreadPool(num_threads));
-  for (int i = 0; i < tracks_to_estimate_.size(); i += interval_step) {
-    const int end_interval = std::min(
-        static_cast<int>(tracks_to_estimate_.size()), i + interval_step);
-    pool->Add(&TrackEstimator::EstimateTrackSet, this, i, end_interval);
+  const int num_tracks = static_cast<int>(tracks_to_estimate_.size());
+  const int num_threads =
+      std::max(1, std::min(options_.num_threads, num_tracks));
+  const int interval_step = std::max(
+      1, std::min(options_.multithreaded_step_size, num_tracks / num_threads));
+  const int num_blocks = (num_tracks + interval_step - 1) / interval_step;
+
+  // Reuse the caller's thread pool when one was provided.
+  std::unique_ptr<ThreadPool> local_pool;
+  ThreadPool* pool = thread_pool_;
+  if (pool == nullptr && num_threads > 1) {
+    local_pool.reset(new ThreadPool(num_threads));
+    pool = local_pool.get();
   }
 
-  // Wait for all tracks to be estimated.
-  pool.reset(nullptr);
+  // The cameras (and the bearing vectors) of the observing views are gathered
+  // once for all tracks, since the views are shared by many tracks.
+  std::unordered_set<ViewId> view_ids;
+  for (const TrackId track_id : tracks_to_estimate_) {
+    const auto& track_view_ids = reconstruction_->Track(track_id)->ViewIds();
+    view_ids.insert(track_view_ids.begin(), track_view_ids.end());
+  }
+  if (options_.cache_bearing_vectors) {
+    reconstruction_->UpdateBearingVectors(view_ids, options_.num_threads);
+  }
+  GatherViewCameras(view_ids, pool);
+
+  // Long tracks take longer to estimate, so the blocks are balanced by the
+  // total track length rather than by the number of tracks.
+  const std::vector<int> ranges = BalancedTrackRanges(num_blocks);
+  const int num_ranges = static_cast<int>(ranges.size()) - 1;
+  // Each range collects its own tracks, which are merged in range order so
+  // that the results do not depend on the thread scheduling.
+  std::vector<std::vector<TrackId> > estimated_tracks(num_ranges);
+  ParallelFor(pool, num_ranges, num_ranges, [&](const int start,
+                                                const int end) {
+    for (int i = start; i < end; i++) {
+      EstimateTrackSet(ranges[i], ranges[i + 1], &estimated_tracks[i]);
+    }
+  });
+  triangulated_tracks_.clear();
+  for (const std::vector<TrackId>& range_tracks : estimated_tracks) {
+    if (options_.joint_bundle_adjustment) {
+      triangulated_tracks_.insert(
+          triangulated_tracks_.end(), range_tracks.begin(), range_tracks.end());
+    } else {
+      summary_.estimated_tracks.insert(range_tracks.begin(),
+                                       range_tracks.end());
+    }
+  }
+
+  if (options_.joint_bundle_adjustment) {
+    JointlyBundleAdjustTracks(pool);
+  }
 
   LOG(INFO) << summary_.estimated_tracks.size() << " tracks were estimated of "
             << summary_.num_triangulation_attempts << " possible tracks. "
@@ -192,43 +305,107 @@ TrackEstimator::Summary TrackEstimator::EstimateTracks(
   return summary_;
 }
 
-void TrackEstimator::EstimateTrackSet(const int start, const int end) {
-  std::unordered_set<TrackId> estimated_tracks;
+void TrackEstimator::EstimateTrackSet(const int start,
+                                      const int end,
+                                      std::vector<TrackId>* estimated_tracks) {
+  Workspace workspace(options_.ba_options);
+
+  // When bundle adjusting jointly, only triangulate here. The tracks are
+  // refined and validated afterwards in one problem.
   for (int i = start; i < end; i++) {
-    if (EstimateTrack(tracks_to_estimate_[i])) {
-      estimated_tracks.emplace(tracks_to_estimate_[i]);
+    const bool success =
+        options_.joint_bundle_adjustment
+            ? TriangulateTrack(tracks_to_estimate_[i], &workspace)
+            : EstimateTrack(tracks_to_estimate_[i], &workspace);
+    if (success) {
+      estimated_tracks->emplace_back(tracks_to_estimate_[i]);
+    }
+  }
+}
+
+void TrackEstimator::JointlyBundleAdjustTracks(ThreadPool* pool) {
+  if (triangulated_tracks_.empty()) {
+    return;
+  }
+
+  // The tracks are sorted by id (as tracks_to_estimate_), so the problem is
+  // built in a deterministic order regardless of the thread scheduling.
+  for (const TrackId track_id : triangulated_tracks_) {
+    reconstruction_->MutableTrack(track_id)->SetEstimated(true);
+  }
+
+  // No views are added, so all cameras are held constant and only the new
+  // points are optimized. The points are either refined independently in
+  // parallel, or share a single problem and solver. Points that did not
+  // converge are rejected by the reprojection error check below.
+  if (options_.bundle_adjustment &&
+      options_.ba_options.refine_tracks_independently) {
+    BundleAdjustmentOptions ba_options = options_.ba_options;
+    ba_options.num_threads = std::max(1, options_.num_threads);
+    RefineTracksWithConstantCameras(
+        ba_options, triangulated_tracks_, reconstruction_, pool);
+  } else if (options_.bundle_adjustment) {
+    BundleAdjustmentOptions ba_options = options_.ba_options;
+    ba_options.num_threads = std::max(1, options_.num_threads);
+    ba_options.use_inner_iterations = false;
+    BundleAdjuster bundle_adjuster(ba_options, reconstruction_);
+    for (const TrackId track_id : triangulated_tracks_) {
+      bundle_adjuster.AddTrack(
+          track_id, ba_options.use_homogeneous_point_parametrization);
+    }
+    const BundleAdjustmentSummary summary = bundle_adjuster.Optimize();
+    if (!summary.success) {
+      for (const TrackId track_id : triangulated_tracks_) {
+        reconstruction_->MutableTrack(track_id)->SetEstimated(false);
+      }
+      return;
     }
   }
 
-  // Add the estimated tracks to the output summary.
-  std::lock_guard<std::mutex> guard(summary_mutex_);
-  summary_.estimated_tracks.insert(estimated_tracks.begin(),
-                                   estimated_tracks.end());
+  // Validate the reprojection errors in parallel. Each worker only touches the
+  // tracks in its own range.
+  const int num_tracks = static_cast<int>(triangulated_tracks_.size());
+  const int num_blocks = std::max(
+      1,
+      std::min(options_.num_threads,
+               num_tracks / std::max(1, options_.multithreaded_step_size)));
+  std::vector<char> is_acceptable(num_tracks, 0);
+  ParallelFor(pool, num_tracks, num_blocks, [&](const int start,
+                                                const int end) {
+    Workspace workspace(options_.ba_options);
+    for (int i = start; i < end; i++) {
+      is_acceptable[i] =
+          HasAcceptableReprojectionError(triangulated_tracks_[i], &workspace);
+    }
+  });
+
+  for (int i = 0; i < num_tracks; i++) {
+    if (is_acceptable[i]) {
+      summary_.estimated_tracks.emplace(triangulated_tracks_[i]);
+    } else {
+      reconstruction_->MutableTrack(triangulated_tracks_[i])
+          ->SetEstimated(false);
+      ++num_bad_reprojections_;
+    }
+  }
 }
 
-bool TrackEstimator::EstimateTrack(const TrackId track_id) {
+bool TrackEstimator::TriangulateTrack(const TrackId track_id,
+                                      Workspace* workspace) {
   static const int kMinNumObservationsForTriangulation = 2;
 
   Track* track = reconstruction_->MutableTrack(track_id);
-  if (track->IsEstimated()) {
-    return true;
-  }      
 
   // Gather projection matrices and features.
-  std::vector<ViewId> view_ids;
-  std::vector<Eigen::Vector2d> features;
-  std::vector<Eigen::Vector3d> origins, ray_directions;
-  std::vector<Matrix3x4d> norm_proj_matrices;
-  GetObservationsFromTrackViews(track_id,
-                                *reconstruction_,
-                                &view_ids,
-                                &features,
-                                &origins,
-                                &norm_proj_matrices,
-                                &ray_directions);
+  GetObservations(track_id, workspace);
+  const std::vector<Eigen::Vector3d>& origins = workspace->origins;
+  const std::vector<Eigen::Vector3d>& ray_directions =
+      workspace->ray_directions;
+  const std::vector<Matrix3x4d>& norm_proj_matrices = workspace->proj_matrices;
+  const std::vector<Eigen::Vector2d>& features = workspace->features;
 
   // Check the angle between views.
-  if (view_ids.size() < kMinNumObservationsForTriangulation ||
+  if (workspace->view_ids.size() < kMinNumObservationsForTriangulation ||
       !SufficientTriangulationAngle(ray_directions,
                                     options_.min_triangulation_angle_degrees)) {
     ++num_bad_angles_;
@@ -258,11 +435,41 @@ bool TrackEstimator::EstimateTrack(const TrackId track_id) {
         return false;
       }
   }
-  // Bundle adjust the track.
+  return true;
+}
+
+bool TrackEstimator::HasAcceptableReprojectionError(const TrackId track_id,
+                                                    Workspace* workspace) {
+  GetObservations(track_id, workspace);
+  const double sq_max_reprojection_error_pixels =
+      options_.max_acceptable_reprojection_error_pixels *
+      options_.max_acceptable_reprojection_error_pixels;
+  return AcceptableReprojectionError(*reconstruction_,
+                                     track_id,
+                                     workspace->view_ids,
+                                     workspace->features,
+                                     sq_max_reprojection_error_pixels);
+}
+
+bool TrackEstimator::EstimateTrack(const TrackId track_id,
+                                   Workspace* workspace) {
+  Track* track = reconstruction_->MutableTrack(track_id);
+  if (track->IsEstimated()) {
+    return true;
+  }
+
+  if (!TriangulateTrack(track_id, workspace)) {
+    return false;
+  }
+
+  // Bundle adjust the track. With constant cameras the point is refined by the
+  // small solver of the workspace instead of a Ceres problem.
   if (options_.bundle_adjustment) {
     track->SetEstimated(true);
     const BundleAdjustmentSummary summary =
-        BundleAdjustTrack(options_.ba_options, track_id, reconstruction_);
+        options_.ba_options.refine_tracks_independently
+            ? workspace->track_refiner.Refine(track_id, reconstruction_)
+            : BundleAdjustTrack(options_.ba_options, track_id, reconstruction_);
     track->SetEstimated(false);
     if (!summary.success) {
       return false;
@@ -276,8 +483,8 @@ bool TrackEstimator::EstimateTrack(const TrackId track_id) {
 
   if (!AcceptableReprojectionError(*reconstruction_,
                                    track_id,
-                                   view_ids,
-                                   features,
+                                   workspace->view_ids,
+                                   workspace->features,
                                    sq_max_reprojection_error_pixels)) {
     ++num_bad_reprojections_;
     return false;
@@ -35,8 +35,9 @@
 #ifndef THEIA_SFM_ESTIMATE_TRACK_H_
 #define THEIA_SFM_ESTIMATE_TRACK_H_
 
+#include <Eigen/Core>
 #include <atomic>
-#include <mutex>
+#include <unordered_map>
 #include <unordered_set>
 #include <vector>
 
@@ -45,6 +46,7 @@
 
 namespace theia {
 class Reconstruction;
+class ThreadPool;
 
 enum class TriangulationMethodType {
     MIDPOINT,
@@ -84,6 +86,18 @@ class TrackEstimator {
 
     // Triangulation method
     TriangulationMethodType triangulation_method = TriangulationMethodType::MIDPOINT;
+
+    // If true (and bundle_adjustment is true), all newly triangulated tracks
+    // are refined in a single bundle adjustment problem with the cameras held
+    // constant instead of building one small problem per track. The problem is
+    // solved with num_threads threads.
+    bool joint_bundle_adjustment = false;
+
+    // If true, the bearing vectors of the views that observe the tracks are
+    // cached in the views (see View::UpdateBearingVectors), so the features
+    // are only undistorted again when the intrinsics change. Tracks that fail
+    // to triangulate are retried in later calls, which then reuse the cache.
+    bool cache_bearing_vectors = true;
   };
 
   struct Summary {
@@ -99,7 +113,18 @@ class TrackEstimator {
   };
 
   TrackEstimator(const Options& options, Reconstruction* reconstruction)
-      : options_(options), reconstruction_(reconstruction) {}
+      : options_(options),
+        reconstruction_(reconstruction),
+        thread_pool_(nullptr) {}
+
+  // Uses the provided thread pool (which must outlive the estimator) instead
+  // of creating a new pool for each call to EstimateTracks.
+  TrackEstimator(const Options& options,
+                 Reconstruction* reconstruction,
+                 ThreadPool* thread_pool)
+      : options_(options),
+        reconstruction_(reconstruction),
+        thread_pool_(thread_pool) {}
 
   // Attempts to estimate all unestimated tracks.
   Summary EstimateAllTracks();
@@ -108,16 +133,48 @@ class TrackEstimator {
   Summary EstimateTracks(const std::unordered_set<TrackId>& track_ids);
 
  private:
-  void EstimateTrackSet(const int start, const int stop);
-  bool EstimateTrack(const TrackId track_id);
+  // The buffers that a worker reuses for all tracks it estimates.
+  struct Workspace;
+
+  // The position and projection matrix of an estimated view, which are
+  // gathered once per call to EstimateTracks instead of once per track.
+  struct ViewCamera {
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+    Eigen::Vector3d position;
+    Matrix3x4d projection_matrix;
+  };
+
+  void GatherViewCameras(const std::unordered_set<ViewId>& view_ids,
+                         ThreadPool* pool);
+  // Splits the tracks to estimate into num_blocks ranges with roughly the same
+  // total track length and returns the start of each range and the end.
+  std::vector<int> BalancedTrackRanges(const int num_blocks) const;
+  void GetObservations(const TrackId track_id, Workspace* workspace) const;
+
+  // Estimates (or, for joint bundle adjustment, triangulates) the tracks in
+  // the range and appends the successful tracks to estimated_tracks in the
+  // order of tracks_to_estimate_.
+  void EstimateTrackSet(const int start,
+                        const int stop,
+                        std::vector<TrackId>* estimated_tracks);
+  bool EstimateTrack(const TrackId track_id, Workspace* workspace);
+  bool TriangulateTrack(const TrackId track_id, Workspace* workspace);
+  bool HasAcceptableReprojectionError(const TrackId track_id,
+                                      Workspace* workspace);
+
+  // Refines all triangulated tracks in one bundle adjustment problem and
+  // keeps the ones with acceptable reprojection error.
+  void JointlyBundleAdjustTracks(ThreadPool* pool);
 
   const Options options_;
   Reconstruction* reconstruction_;
+  ThreadPool* thread_pool_;
   std::vector<TrackId> tracks_to_estimate_;
+  std::unordered_map<ViewId, int> view_camera_indices_;
+  std::vector<ViewCamera, Eigen::aligned_allocator<ViewCamera> > view_cameras_;
+  std::vector<TrackId> triangulated_tracks_;
 
-  // A mutex lock for setting the summary
   TrackEstimator::Summary summary_;
-  std::mutex summary_mutex_;
 
   std::atomic_int num_bad_angles_, num_failed_triangulations_,
       num_bad_reprojections_;
@@ -38,6 +38,8 @@
 #include <Eigen/Geometry>
 #include <glog/logging.h>
 
+#include <algorithm>
+#include <memory>
 #include <vector>
 
 #include "theia/matching/feature_correspondence.h"
@@ -53,6 +55,8 @@
 #include "theia/sfm/types.h"
 #include "theia/sfm/visibility_pyramid.h"
 #include "theia/solvers/sample_consensus_estimator.h"
+#include "theia/util/random.h"
+#include "theia/util/threadpool.h"
 
 namespace theia {
 
@@ -63,13 +67,14 @@ using Eigen::Vector3d;
 
 namespace {
 
-// Normalizes the image features by the camera intrinsics.
+// Normalizes the image features by the camera intrinsics. The output vector is
+// only resized so that its memory is reused across view pairs.
 void NormalizeFeatures(
     const CameraIntrinsicsPrior& prior1,
     const CameraIntrinsicsPrior& prior2,
     const std::vector<FeatureCorrespondence>& correspondences,
     std::vector<FeatureCorrespondence>* normalized_correspondences) {
-  CHECK_NOTNULL(normalized_correspondences)->clear();
+  CHECK_NOTNULL(normalized_correspondences);
 
   Camera camera1, camera2;
   camera1.SetFromCameraIntrinsicsPriors(prior1);
@@ -84,9 +89,11 @@ void NormalizeFeatures(
     camera2.SetFocalLength(1.0);
   }
 
-  normalized_correspondences->reserve(correspondences.size());
-  for (const FeatureCorrespondence& correspondence : correspondences) {
-    FeatureCorrespondence normalized_correspondence;
+  normalized_correspondences->resize(correspondences.size());
+  for (int i = 0; i < correspondences.size(); i++) {
+    const FeatureCorrespondence& correspondence = correspondences[i];
+    FeatureCorrespondence& normalized_correspondence =
+        (*normalized_correspondences)[i];
     const Eigen::Vector3d normalized_feature1 =
         camera1.PixelToNormalizedCoordinates(correspondence.feature1.point_);
     normalized_correspondence.feature1 =
@@ -96,8 +103,6 @@ void NormalizeFeatures(
         camera2.PixelToNormalizedCoordinates(correspondence.feature2.point_);
     normalized_correspondence.feature2 =
         Feature(normalized_feature2.hnormalized());
-
-    normalized_correspondences->emplace_back(normalized_correspondence);
   }
 }
 
@@ -135,12 +140,13 @@ bool EstimateTwoViewInfoCalibrated(
     const CameraIntrinsicsPrior& intrinsics1,
     const CameraIntrinsicsPrior& intrinsics2,
     const std::vector<FeatureCorrespondence>& correspondences,
+    std::vector<FeatureCorrespondence>* normalized_correspondences,
     TwoViewInfo* twoview_info,
-    std::vector<int>* inlier_indices) {
+    std::vector<int>* inlier_indices,
+    RansacStatistics* ransac_statistics) {
   // Normalize features w.r.t focal length.
-  std::vector<FeatureCorrespondence> normalized_correspondences;
   NormalizeFeatures(
-      intrinsics1, intrinsics2, correspondences, &normalized_correspondences);
+      intrinsics1, intrinsics2, correspondences, normalized_correspondences);
 
   // Set the ransac parameters.
   RansacParameters ransac_options;
@@ -150,6 +156,8 @@ bool EstimateTwoViewInfoCalibrated(
   ransac_options.max_iterations = options.max_ransac_iterations;
   ransac_options.use_lo = options.use_lo;
   ransac_options.lo_start_iterations = options.lo_start_iterations;
+  ransac_options.lo_type = options.lo_type;
+  ransac_options.collect_statistics = options.collect_ransac_statistics;
 
   // Compute the sampson error threshold to account for the resolution of the
   // images.
@@ -170,11 +178,17 @@ bool EstimateTwoViewInfoCalibrated(
   RansacSummary summary;
   if (!EstimateRelativePose(ransac_options,
                             options.ransac_type,
-                            normalized_correspondences,
+                            *normalized_correspondences,
                             &relative_pose,
                             &summary)) {
+    if (ransac_statistics != nullptr) {
+      *ransac_statistics = summary.statistics;
+    }
     return false;
   }
+  if (ransac_statistics != nullptr) {
+    *ransac_statistics = summary.statistics;
+  }
   AngleAxisd rotation(relative_pose.rotation);
 
   // Set the twoview info.
@@ -197,12 +211,13 @@ bool EstimateTwoViewInfoUncalibrated(
     const CameraIntrinsicsPrior& intrinsics2,
     const std::vector<FeatureCorrespondence>& correspondences,
     const Eigen::Vector2d& min_max_focal_lengths,
+    std::vector<FeatureCorrespondence>* centered_correspondences,
     TwoViewInfo* twoview_info,
-    std::vector<int>* inlier_indices) {
+    std::vector<int>* inlier_indices,
+    RansacStatistics* ransac_statistics) {
   // Normalize features w.r.t principal point.
-  std::vector<FeatureCorrespondence> centered_correspondences;
   NormalizeFeatures(
-      intrinsics1, intrinsics2, correspondences, &centered_correspondences);
+      intrinsics1, intrinsics2, correspondences, centered_correspondences);
 
   // Set the ransac parameters.
   RansacParameters ransac_options;
@@ -212,6 +227,8 @@ bool EstimateTwoViewInfoUncalibrated(
   ransac_options.max_iterations = options.max_ransac_iterations;
   ransac_options.use_lo = options.use_lo;
   ransac_options.lo_start_iterations = options.lo_start_iterations;
+  ransac_options.lo_type = options.lo_type;
+  ransac_options.collect_statistics = options.collect_ransac_statistics;
   
   // Compute the sampson error threshold to account for the resolution of the
   // images.
@@ -230,12 +247,18 @@ bool EstimateTwoViewInfoUncalibrated(
   RansacSummary summary;
   if (!EstimateUncalibratedRelativePose(ransac_options,
                                         options.ransac_type,
-                                        centered_correspondences,
+                                        *centered_correspondences,
                                         min_max_focal_lengths,
                                         &relative_pose,
                                         &summary)) {
+    if (ransac_statistics != nullptr) {
+      *ransac_statistics = summary.statistics;
+    }
     return false;
   }
+  if (ransac_statistics != nullptr) {
+    *ransac_statistics = summary.statistics;
+  }
 
   AngleAxisd rotation(relative_pose.rotation);
 
@@ -254,15 +277,17 @@ bool EstimateTwoViewInfoUncalibrated(
   return true;
 }
 
-}  // namespace
-
-bool EstimateTwoViewInfo(
+// Estimates the two view info with the given buffer for the normalized
+// correspondences.
+bool EstimateTwoViewInfoWithBuffer(
     const EstimateTwoViewInfoOptions& options,
     const CameraIntrinsicsPrior& intrinsics1,
     const CameraIntrinsicsPrior& intrinsics2,
     const std::vector<FeatureCorrespondence>& correspondences,
+    std::vector<FeatureCorrespondence>* normalized_correspondences,
     TwoViewInfo* twoview_info,
-    std::vector<int>* inlier_indices) {
+    std::vector<int>* inlier_indices,
+    RansacStatistics* ransac_statistics) {
   CHECK_NOTNULL(twoview_info);
   CHECK_NOTNULL(inlier_indices)->clear();
 
@@ -272,8 +297,10 @@ bool EstimateTwoViewInfo(
                                          intrinsics1,
                                          intrinsics2,
                                          correspondences,
+                                         normalized_correspondences,
                                          twoview_info,
-                                         inlier_indices);
+                                         inlier_indices,
+                                         ransac_statistics);
   }
 
   // Only one of the focal lengths is set.
@@ -294,8 +321,10 @@ bool EstimateTwoViewInfo(
                                            intrinsics2,
                                            correspondences,
                                            min_max_focal_length,
+                                           normalized_correspondences,
                                            twoview_info,
-                                           inlier_indices);
+                                           inlier_indices,
+                                           ransac_statistics);
   }
 
   // Assume both views are uncalibrated.
@@ -305,8 +334,89 @@ bool EstimateTwoViewInfo(
                                          intrinsics2,
                                          correspondences,
                                          min_max_focal_length,
+                                         normalized_correspondences,
                                          twoview_info,
-                                         inlier_indices);
+                                         inlier_indices,
+                                         ransac_statistics);
+}
+
+}  // namespace
+
+bool EstimateTwoViewInfo(
+    const EstimateTwoViewInfoOptions& options,
+    const CameraIntrinsicsPrior& intrinsics1,
+    const CameraIntrinsicsPrior& intrinsics2,
+    const std::vector<FeatureCorrespondence>& correspondences,
+    TwoViewInfo* twoview_info,
+    std::vector<int>* inlier_indices,
+    RansacStatistics* ransac_statistics) {
+  std::vector<FeatureCorrespondence> normalized_correspondences;
+  return EstimateTwoViewInfoWithBuffer(options,
+                                       intrinsics1,
+                                       intrinsics2,
+                                       correspondences,
+                                       &normalized_correspondences,
+                                       twoview_info,
+                                       inlier_indices,
+                                       ransac_statistics);
+}
+
+int EstimateTwoViewInfos(
+    const EstimateTwoViewInfoOptions& options,
+    const int num_threads,
+    const std::vector<CameraIntrinsicsPrior>& intrinsics1,
+    const std::vector<CameraIntrinsicsPrior>& intrinsics2,
+    const std::vector<std::vector<FeatureCorrespondence> >& correspondences,
+    std::vector<TwoViewInfo>* twoview_infos,
+    std::vector<std::vector<int> >* inlier_indices,
+    std::vector<bool>* success) {
+  CHECK_GE(num_threads, 1);
+  CHECK_EQ(intrinsics1.size(), correspondences.size());
+  CHECK_EQ(intrinsics2.size(), correspondences.size());
+  CHECK_NOTNULL(twoview_infos);
+  CHECK_NOTNULL(inlier_indices);
+  CHECK_NOTNULL(success);
+
+  const int num_pairs = correspondences.size();
+  twoview_infos->assign(num_pairs, TwoViewInfo());
+  inlier_indices->assign(num_pairs, std::vector<int>());
+  // std::vector<bool> packs its values so it may not be written concurrently.
+  std::vector<char> pair_success(num_pairs, 0);
+
+  // The pairs differ a lot in their number of correspondences, so they are
+  // split into more blocks than threads to balance the load. Each block
+  // reuses one buffer for the normalized correspondences of its pairs.
+  static const int kNumBlocksPerThread = 8;
+  std::unique_ptr<ThreadPool> pool;
+  if (num_threads > 1 && num_pairs > 1) {
+    pool.reset(new ThreadPool(std::min(num_threads, num_pairs)));
+  }
+  ParallelFor(pool.get(),
+              num_pairs,
+              num_threads * kNumBlocksPerThread,
+              [&](const int start, const int end) {
+                std::vector<FeatureCorrespondence> normalized_correspondences;
+                EstimateTwoViewInfoOptions pair_options = options;
+                for (int i = start; i < end; i++) {
+                  // Each pair gets its own random stream so that the results
+                  // do not depend on the number of threads.
+                  if (options.rng != nullptr) {
+                    pair_options.rng = options.rng->Split(i);
+                  }
+                  pair_success[i] = EstimateTwoViewInfoWithBuffer(
+                      pair_options,
+                      intrinsics1[i],
+                      intrinsics2[i],
+                      correspondences[i],
+                      &normalized_correspondences,
+                      &(*twoview_infos)[i],
+                      &(*inlier_indices)[i],
+                      nullptr);
+                }
+              });
+
+  success->assign(pair_success.begin(), pair_success.end());
+  return std::count(pair_success.begin(), pair_success.end(), 1);
 }
 
 }  // namespace theia
@@ -39,6 +39,7 @@
 #include <vector>
 
 #include "theia/sfm/create_and_initialize_ransac_variant.h"
+#include "theia/solvers/ransac_statistics.h"
 
 namespace theia {
 
@@ -72,6 +73,10 @@ struct EstimateTwoViewInfoOptions {
   bool use_mle = true;
   bool use_lo = false;
   int lo_start_iterations = 10;
+  LocalOptimizationType lo_type = LocalOptimizationType::REFINE_MODEL;
+
+  // Time the stages of RANSAC (see RansacParameters::collect_statistics).
+  bool collect_ransac_statistics = false;
 };
 
 // Estimates two view info for the given view pair from the correspondences. The
@@ -88,14 +93,36 @@ struct EstimateTwoViewInfoOptions {
 //      currently unsupported, and case 2) will be used instead.
 //
 // Returns true if a two view info could be successfully estimated and false if
-// not.
+// not. If ransac_statistics is not null, it is set to the statistics of the
+// RANSAC estimation, even if the estimation fails.
 bool EstimateTwoViewInfo(
     const EstimateTwoViewInfoOptions& options,
     const CameraIntrinsicsPrior& intrinsics1,
     const CameraIntrinsicsPrior& intrinsics2,
     const std::vector<FeatureCorrespondence>& correspondences,
     TwoViewInfo* twoview_info,
-    std::vector<int>* inlier_indices);
+    std::vector<int>* inlier_indices,
+    RansacStatistics* ransac_statistics = nullptr);
+
+// Estimates the two view infos of many view pairs at once, which avoids the
+// overhead of one call per pair. The i-th view pair has the intrinsics
+// intrinsics1[i] and intrinsics2[i] and the correspondences correspondences[i]
+// in pixel coordinates. The pairs are estimated in parallel with num_threads
+// threads that reuse their buffers for the normalized correspondences across
+// pairs. If options.rng is set, the i-th pair uses the random stream
+// options.rng->Split(i) so that the results do not depend on num_threads.
+//
+// On return, twoview_infos, inlier_indices and success have one entry per view
+// pair. Returns the number of pairs whose two view info could be estimated.
+int EstimateTwoViewInfos(
+    const EstimateTwoViewInfoOptions& options,
+    const int num_threads,
+    const std::vector<CameraIntrinsicsPrior>& intrinsics1,
+    const std::vector<CameraIntrinsicsPrior>& intrinsics2,
+    const std::vector<std::vector<FeatureCorrespondence> >& correspondences,
+    std::vector<TwoViewInfo>* twoview_infos,
+    std::vector<std::vector<int> >* inlier_indices,
+    std::vector<bool>* success);
 
 }  // namespace theia
 
@@ -0,0 +1,166 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#include <Eigen/Core>
+#include <Eigen/Geometry>
+
+#include <memory>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "theia/matching/feature_correspondence.h"
+#include "theia/sfm/camera_intrinsics_prior.h"
+#include "theia/sfm/estimate_twoview_info.h"
+#include "theia/sfm/pose/test_util.h"
+#include "theia/sfm/twoview_info.h"
+#include "theia/util/random.h"
+
+namespace theia {
+
+using Eigen::AngleAxisd;
+using Eigen::Matrix3d;
+using Eigen::Vector2d;
+using Eigen::Vector3d;
+
+namespace {
+
+static const double kFocalLength = 800.0;
+static const int kImageWidth = 800;
+static const int kImageHeight = 600;
+
+CameraIntrinsicsPrior CalibratedPrior() {
+  CameraIntrinsicsPrior prior;
+  prior.image_width = kImageWidth;
+  prior.image_height = kImageHeight;
+  prior.focal_length.is_set = true;
+  prior.focal_length.value[0] = kFocalLength;
+  prior.principal_point.is_set = true;
+  prior.principal_point.value[0] = kImageWidth / 2.0;
+  prior.principal_point.value[1] = kImageHeight / 2.0;
+  return prior;
+}
+
+Vector2d Project(const Vector3d& point) {
+  return kFocalLength * point.hnormalized() +
+         Vector2d(kImageWidth / 2.0, kImageHeight / 2.0);
+}
+
+// Creates the pixel correspondences of a view pair where the second camera is
+// rotated by rotation and positioned at position.
+std::vector<FeatureCorrespondence> CreateCorrespondences(
+    const Matrix3d& rotation,
+    const Vector3d& position,
+    const int num_correspondences,
+    RandomNumberGenerator* rng) {
+  std::vector<Vector3d> points;
+  CreateRandomPointsInFrustum(
+      0.8, 0.6, 4.0, 8.0, num_correspondences, rng, &points);
+
+  std::vector<FeatureCorrespondence> correspondences;
+  for (const Vector3d& point : points) {
+    Vector2d pixel1 = Project(point);
+    Vector2d pixel2 = Project(rotation * (point - position));
+    AddNoiseToProjection(0.5, rng, &pixel1);
+    AddNoiseToProjection(0.5, rng, &pixel2);
+    correspondences.emplace_back(Feature(pixel1), Feature(pixel2));
+  }
+  return correspondences;
+}
+
+}  // namespace
+
+TEST(EstimateTwoViewInfos, MatchesTheGroundTruthForAnyNumberOfThreads) {
+  static const int kNumPairs = 12;
+  RandomNumberGenerator rng(53);
+
+  std::vector<CameraIntrinsicsPrior> intrinsics(kNumPairs, CalibratedPrior());
+  std::vector<std::vector<FeatureCorrespondence> > correspondences(kNumPairs);
+  std::vector<Matrix3d> rotations(kNumPairs);
+  for (int i = 0; i < kNumPairs; i++) {
+    rotations[i] = RandomRotation(10.0, &rng);
+    const Vector3d position =
+        Vector3d(1.0, 0.0, 0.0) + 0.1 * rng.RandVector3d();
+    correspondences[i] =
+        CreateCorrespondences(rotations[i], position, 100 + 20 * i, &rng);
+  }
+
+  EstimateTwoViewInfoOptions options;
+  options.rng = std::make_shared<RandomNumberGenerator>(59);
+
+  std::vector<TwoViewInfo> twoview_infos;
+  std::vector<std::vector<int> > inlier_indices;
+  std::vector<bool> success;
+  EXPECT_EQ(EstimateTwoViewInfos(options,
+                                 1,
+                                 intrinsics,
+                                 intrinsics,
+                                 correspondences,
+                                 &twoview_infos,
+                                 &inlier_indices,
+                                 &success),
+            kNumPairs);
+
+  std::vector<TwoViewInfo> parallel_twoview_infos;
+  std::vector<std::vector<int> > parallel_inlier_indices;
+  std::vector<bool> parallel_success;
+  EXPECT_EQ(EstimateTwoViewInfos(options,
+                                 4,
+                                 intrinsics,
+                                 intrinsics,
+                                 correspondences,
+                                 &parallel_twoview_infos,
+                                 &parallel_inlier_indices,
+                                 &parallel_success),
+            kNumPairs);
+
+  for (int i = 0; i < kNumPairs; i++) {
+    ASSERT_TRUE(success[i]);
+    const Matrix3d estimated_rotation =
+        AngleAxisd(twoview_infos[i].rotation_2.norm(),
+                   twoview_infos[i].rotation_2.normalized())
+            .toRotationMatrix();
+    EXPECT_LT(AngleAxisd(estimated_rotation.transpose() * rotations[i]).angle(),
+              0.01);
+
+    EXPECT_EQ(parallel_success[i], success[i]);
+    EXPECT_EQ(parallel_twoview_infos[i].rotation_2,
+              twoview_infos[i].rotation_2);
+    EXPECT_EQ(parallel_twoview_infos[i].position_2,
+              twoview_infos[i].position_2);
+    EXPECT_EQ(parallel_inlier_indices[i], inlier_indices[i]);
+  }
+}
+
+}  // namespace theia
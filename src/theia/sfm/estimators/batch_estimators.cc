@@ -0,0 +1,590 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#include "theia/sfm/estimators/batch_estimators.h"
+
+#include <Eigen/Core>
+#include <glog/logging.h>
+#include <algorithm>
+#include <limits>
+#include <memory>
+#include <vector>
+
+#include "theia/matching/feature_correspondence.h"
+#include "theia/sfm/estimators/estimate_essential_matrix.h"
+#include "theia/sfm/estimators/estimate_fundamental_matrix.h"
+#include "theia/sfm/estimators/estimate_homography.h"
+#include "theia/sfm/estimators/estimate_relative_pose.h"
+#include "theia/sfm/estimators/feature_correspondence_2d_3d.h"
+#include "theia/sfm/similarity_transformation.h"
+#include "theia/sfm/transformation/align_point_clouds.h"
+#include "theia/sfm/transformation/gdls_similarity_transform.h"
+#include "theia/solvers/estimator.h"
+#include "theia/solvers/sample_consensus_estimator.h"
+#include "theia/util/random.h"
+#include "theia/util/threadpool.h"
+
+namespace theia {
+namespace {
+
+// The problems differ a lot in their number of correspondences, so they are
+// split into more blocks than threads to balance the load.
+static const int kNumBlocksPerThread = 8;
+
+// The seed of the random term of gDLS when no rng is given.
+static const unsigned kDefaultGdlsSeed = 67;
+
+struct PointCorrespondence3D3D {
+  Eigen::Vector3d point1;
+  Eigen::Vector3d point2;
+};
+
+struct RayCorrespondence {
+  Eigen::Vector3d origin;
+  Eigen::Vector3d direction;
+  Eigen::Vector3d point;
+};
+
+// Estimates the similarity transformation x1 = s * R * x2 + t from 4 or more
+// 3D-3D correspondences. Minimal samples are copied into fixed-size arrays, so
+// estimating a model does not allocate.
+class SimilarityTransformationEstimator
+    : public Estimator<PointCorrespondence3D3D, SimilarityTransformation> {
+ public:
+  SimilarityTransformationEstimator() {}
+
+  double SampleSize() const override { return 4; }
+
+  bool EstimateModel(const std::vector<PointCorrespondence3D3D>& data,
+                     std::vector<SimilarityTransformation>* models)
+      const override {
+    static const int kSampleSize = 4;
+    if (data.size() != kSampleSize) {
+      return EstimateModelNonminimal(data, models);
+    }
+    Eigen::Vector3d points1[kSampleSize], points2[kSampleSize];
+    for (int i = 0; i < kSampleSize; i++) {
+      points1[i] = data[i].point1;
+      points2[i] = data[i].point2;
+    }
+    SimilarityTransformation model;
+    AlignPointCloudsUmeyama(kSampleSize,
+                            points2,
+                            points1,
+                            nullptr,
+                            &model.rotation,
+                            &model.translation,
+                            &model.scale);
+    models->emplace_back(model);
+    return true;
+  }
+
+  bool EstimateModelNonminimal(
+      const std::vector<PointCorrespondence3D3D>& data,
+      std::vector<SimilarityTransformation>* models) const override {
+    std::vector<Eigen::Vector3d> points1(data.size()), points2(data.size());
+    for (int i = 0; i < data.size(); i++) {
+      points1[i] = data[i].point1;
+      points2[i] = data[i].point2;
+    }
+    SimilarityTransformation model;
+    AlignPointCloudsUmeyama(points2,
+                            points1,
+                            &model.rotation,
+                            &model.translation,
+                            &model.scale);
+    models->emplace_back(model);
+    return true;
+  }
+
+  double Error(const PointCorrespondence3D3D& correspondence,
+               const SimilarityTransformation& model) const override {
+    return (correspondence.point1 -
+            (model.scale * model.rotation * correspondence.point2 +
+             model.translation))
+        .squaredNorm();
+  }
+};
+
+// Estimates the similarity transformation that puts the points on the
+// transformed rays, X = R * (s * c + alpha * d) + t, from 4 ray to point
+// correspondences with gDLS. The solver uses fixed-size matrices. Its random
+// term is drawn from a generator of the given seed that is local to each call,
+// since RANSAC may estimate models on several threads at once.
+class RaySimilarityTransformationEstimator
+    : public Estimator<RayCorrespondence, SimilarityTransformation> {
+ public:
+  explicit RaySimilarityTransformationEstimator(const unsigned seed)
+      : seed_(seed) {}
+
+  double SampleSize() const override { return 4; }
+
+  bool EstimateModel(const std::vector<RayCorrespondence>& data,
+                     std::vector<SimilarityTransformation>* models)
+      const override {
+    static const int kSampleSize = 4;
+    Eigen::Vector3d origins[kSampleSize], directions[kSampleSize],
+        points[kSampleSize];
+    for (int i = 0; i < kSampleSize; i++) {
+      origins[i] = data[i].origin;
+      directions[i] = data[i].direction.normalized();
+      points[i] = data[i].point;
+    }
+
+    // gDLS returns R, t and s such that s * c + alpha * d = R * X + t, which
+    // is inverted to express the points in terms of the rays.
+    RandomNumberGenerator rng(seed_, 0);
+    GdlsSolutions solutions;
+    GdlsSimilarityTransform(
+        kSampleSize, origins, directions, points, &rng, &solutions);
+    for (int i = 0; i < solutions.num_solutions; i++) {
+      SimilarityTransformation model;
+      model.rotation = solutions.rotation[i].toRotationMatrix().transpose();
+      model.translation = -model.rotation * solutions.translation[i];
+      model.scale = solutions.scale[i];
+      models->emplace_back(model);
+    }
+    return solutions.num_solutions > 0;
+  }
+
+  double Error(const RayCorrespondence& correspondence,
+               const SimilarityTransformation& model) const override {
+    // The direction from the ray origin to the point, in the ray frame.
+    const Eigen::Vector3d ray_to_point =
+        model.rotation.transpose() *
+            (correspondence.point - model.translation) -
+        model.scale * correspondence.origin;
+    if (ray_to_point.dot(correspondence.direction) <= 0.0) {
+      return std::numeric_limits<double>::max();
+    }
+    return (ray_to_point.normalized() -
+            correspondence.direction.normalized())
+        .squaredNorm();
+  }
+
+ private:
+  const unsigned seed_;
+};
+
+bool ValidateOffsets(const Eigen::VectorXi& offsets, const int num_rows) {
+  if (offsets.size() == 0 || offsets(0) != 0 ||
+      offsets(offsets.size() - 1) != num_rows) {
+    LOG(ERROR) << "The offsets must start at 0 and end with the number of "
+                  "correspondences ("
+               << num_rows << ").";
+    return false;
+  }
+  for (int i = 1; i < offsets.size(); i++) {
+    if (offsets(i) < offsets(i - 1)) {
+      LOG(ERROR) << "The offsets must be non-decreasing.";
+      return false;
+    }
+  }
+  return true;
+}
+
+void GetCorrespondences(
+    const Eigen::Ref<const TwoViewCorrespondenceMatrix>& matrix,
+    const int first,
+    const int last,
+    std::vector<FeatureCorrespondence>* correspondences) {
+  correspondences->clear();
+  correspondences->reserve(last - first);
+  for (int i = first; i < last; i++) {
+    correspondences->emplace_back(Feature(matrix(i, 0), matrix(i, 1)),
+                                  Feature(matrix(i, 2), matrix(i, 3)));
+  }
+}
+
+void GetCorrespondences(
+    const Eigen::Ref<const Correspondence2D3DMatrix>& matrix,
+    const int first,
+    const int last,
+    std::vector<FeatureCorrespondence2D3D>* correspondences) {
+  correspondences->clear();
+  correspondences->reserve(last - first);
+  for (int i = first; i < last; i++) {
+    correspondences->emplace_back(matrix.block<1, 2>(i, 0).transpose(),
+                                  matrix.block<1, 3>(i, 2).transpose());
+  }
+}
+
+void GetCorrespondences(
+    const Eigen::Ref<const Correspondence3D3DMatrix>& matrix,
+    const int first,
+    const int last,
+    std::vector<PointCorrespondence3D3D>* correspondences) {
+  correspondences->resize(last - first);
+  for (int i = first; i < last; i++) {
+    (*correspondences)[i - first].point1 =
+        matrix.block<1, 3>(i, 0).transpose();
+    (*correspondences)[i - first].point2 =
+        matrix.block<1, 3>(i, 3).transpose();
+  }
+}
+
+void GetCorrespondences(const Eigen::Ref<const RayCorrespondenceMatrix>& matrix,
+                        const int first,
+                        const int last,
+                        std::vector<RayCorrespondence>* correspondences) {
+  correspondences->resize(last - first);
+  for (int i = first; i < last; i++) {
+    (*correspondences)[i - first].origin = matrix.block<1, 3>(i, 0).transpose();
+    (*correspondences)[i - first].direction =
+        matrix.block<1, 3>(i, 3).transpose();
+    (*correspondences)[i - first].point = matrix.block<1, 3>(i, 6).transpose();
+  }
+}
+
+// Writes the matrix into the row of the models in row-major order, starting
+// at the given column.
+template <int kRows, int kCols>
+void SetModel(const Eigen::Matrix<double, kRows, kCols>& matrix,
+              const int problem,
+              const int column,
+              BatchEstimationResult* result) {
+  for (int row = 0; row < kRows; row++) {
+    for (int col = 0; col < kCols; col++) {
+      result->models(problem, column + row * kCols + col) = matrix(row, col);
+    }
+  }
+}
+
+// Runs estimate(ransac_params, correspondences, problem, ransac_summary) on
+// the correspondences of each problem, which stores the model of the problem
+// in the result and returns true on success. Problems with fewer than
+// sample_size correspondences fail without running RANSAC, which requires at
+// least one minimal sample.
+template <class Correspondence, class CorrespondenceMatrix, class Estimate>
+bool EstimateInBatch(const RansacParameters& ransac_params,
+                     const Eigen::Ref<const CorrespondenceMatrix>& matrix,
+                     const Eigen::VectorXi& offsets,
+                     const int num_threads,
+                     const int sample_size,
+                     const int model_size,
+                     const Estimate& estimate,
+                     BatchEstimationResult* result) {
+  CHECK_NOTNULL(result);
+  CHECK_GT(num_threads, 0);
+  if (!ValidateOffsets(offsets, matrix.rows())) {
+    return false;
+  }
+
+  const int num_problems = offsets.size() - 1;
+  result->success.setConstant(num_problems, false);
+  result->models.setZero(num_problems, model_size);
+  result->num_inliers.setZero(num_problems);
+  result->inliers.setConstant(matrix.rows(), false);
+
+  std::unique_ptr<ThreadPool> pool;
+  if (num_threads > 1 && num_problems > 1) {
+    pool.reset(new ThreadPool(std::min(num_threads, num_problems)));
+  }
+  ParallelFor(pool.get(),
+              num_problems,
+              num_threads * kNumBlocksPerThread,
+              [&](const int start, const int end) {
+                std::vector<Correspondence> correspondences;
+                RansacParameters problem_params = ransac_params;
+                for (int i = start; i < end; i++) {
+                  if (offsets(i + 1) - offsets(i) < sample_size) {
+                    continue;
+                  }
+                  GetCorrespondences(
+                      matrix, offsets(i), offsets(i + 1), &correspondences);
+                  if (ransac_params.rng != nullptr) {
+                    problem_params.rng = ransac_params.rng->Split(i);
+                  }
+                  RansacSummary summary;
+                  if (!estimate(problem_params, correspondences, i, &summary)) {
+                    continue;
+                  }
+                  result->success(i) = true;
+                  result->num_inliers(i) = summary.inliers.size();
+                  for (const int inlier : summary.inliers) {
+                    result->inliers(offsets(i) + inlier) = true;
+                  }
+                }
+              });
+  return true;
+}
+
+// Batch estimation of the 3x3 matrix models of two views.
+template <class EstimateMatrix>
+bool EstimateMatricesInBatch(
+    const RansacParameters& ransac_params,
+    const RansacType& ransac_type,
+    const Eigen::Ref<const TwoViewCorrespondenceMatrix>& correspondences,
+    const Eigen::VectorXi& offsets,
+    const int num_threads,
+    const int sample_size,
+    const EstimateMatrix& estimate_matrix,
+    BatchEstimationResult* result) {
+  return EstimateInBatch<FeatureCorrespondence, TwoViewCorrespondenceMatrix>(
+      ransac_params,
+      correspondences,
+      offsets,
+      num_threads,
+      sample_size,
+      9,
+      [&](const RansacParameters& problem_params,
+          const std::vector<FeatureCorrespondence>& problem_correspondences,
+          const int problem,
+          RansacSummary* summary) {
+        Eigen::Matrix3d matrix;
+        if (!estimate_matrix(problem_params,
+                             ransac_type,
+                             problem_correspondences,
+                             &matrix,
+                             summary)) {
+          return false;
+        }
+        SetModel(matrix, problem, 0, result);
+        return true;
+      },
+      result);
+}
+
+// Stores the similarity transformation as the row-major rotation, the
+// translation and the scale.
+void SetSimilarityTransformation(
+    const SimilarityTransformation& similarity_transformation,
+    const int problem,
+    BatchEstimationResult* result) {
+  SetModel(similarity_transformation.rotation, problem, 0, result);
+  SetModel(similarity_transformation.translation, problem, 9, result);
+  result->models(problem, 12) = similarity_transformation.scale;
+}
+
+}  // namespace
+
+bool EstimateEssentialMatrices(
+    const RansacParameters& ransac_params,
+    const RansacType& ransac_type,
+    const Eigen::Ref<const TwoViewCorrespondenceMatrix>&
+        normalized_correspondences,
+    const Eigen::VectorXi& offsets,
+    const int num_threads,
+    BatchEstimationResult* result) {
+  return EstimateMatricesInBatch(ransac_params,
+                                 ransac_type,
+                                 normalized_correspondences,
+                                 offsets,
+                                 num_threads,
+                                 5,
+                                 EstimateEssentialMatrix,
+                                 result);
+}
+
+bool EstimateFundamentalMatrices(
+    const RansacParameters& ransac_params,
+    const RansacType& ransac_type,
+    const Eigen::Ref<const TwoViewCorrespondenceMatrix>& correspondences,
+    const Eigen::VectorXi& offsets,
+    const int num_threads,
+    BatchEstimationResult* result) {
+  return EstimateMatricesInBatch(ransac_params,
+                                 ransac_type,
+                                 correspondences,
+                                 offsets,
+                                 num_threads,
+                                 8,
+                                 EstimateFundamentalMatrix,
+                                 result);
+}
+
+bool EstimateHomographies(
+    const RansacParameters& ransac_params,
+    const RansacType& ransac_type,
+    const Eigen::Ref<const TwoViewCorrespondenceMatrix>& correspondences,
+    const Eigen::VectorXi& offsets,
+    const int num_threads,
+    BatchEstimationResult* result) {
+  return EstimateMatricesInBatch(ransac_params,
+                                 ransac_type,
+                                 correspondences,
+                                 offsets,
+                                 num_threads,
+                                 4,
+                                 EstimateHomography,
+                                 result);
+}
+
+bool EstimateRelativePoses(
+    const RansacParameters& ransac_params,
+    const RansacType& ransac_type,
+    const Eigen::Ref<const TwoViewCorrespondenceMatrix>&
+        normalized_correspondences,
+    const Eigen::VectorXi& offsets,
+    const int num_threads,
+    BatchEstimationResult* result) {
+  return EstimateInBatch<FeatureCorrespondence, TwoViewCorrespondenceMatrix>(
+      ransac_params,
+      normalized_correspondences,
+      offsets,
+      num_threads,
+      5,
+      12,
+      [&](const RansacParameters& problem_params,
+          const std::vector<FeatureCorrespondence>& correspondences,
+          const int problem,
+          RansacSummary* summary) {
+        RelativePose relative_pose;
+        if (!EstimateRelativePose(problem_params,
+                                  ransac_type,
+                                  correspondences,
+                                  &relative_pose,
+                                  summary)) {
+          return false;
+        }
+        SetModel(relative_pose.rotation, problem, 0, result);
+        SetModel(relative_pose.position, problem, 9, result);
+        return true;
+      },
+      result);
+}
+
+bool EstimateCalibratedAbsolutePoses(
+    const RansacParameters& ransac_params,
+    const RansacType& ransac_type,
+    const PnPType& pnp_type,
+    const Eigen::Ref<const Correspondence2D3DMatrix>&
+        normalized_correspondences,
+    const Eigen::VectorXi& offsets,
+    const int num_threads,
+    BatchEstimationResult* result) {
+  return EstimateInBatch<FeatureCorrespondence2D3D, Correspondence2D3DMatrix>(
+      ransac_params,
+      normalized_correspondences,
+      offsets,
+      num_threads,
+      3,
+      12,
+      [&](const RansacParameters& problem_params,
+          const std::vector<FeatureCorrespondence2D3D>& correspondences,
+          const int problem,
+          RansacSummary* summary) {
+        CalibratedAbsolutePose pose;
+        if (!EstimateCalibratedAbsolutePose(problem_params,
+                                            ransac_type,
+                                            pnp_type,
+                                            correspondences,
+                                            &pose,
+                                            summary)) {
+          return false;
+        }
+        SetModel(pose.rotation, problem, 0, result);
+        SetModel(pose.position, problem, 9, result);
+        return true;
+      },
+      result);
+}
+
+bool EstimateSimilarityTransformations(
+    const RansacParameters& ransac_params,
+    const RansacType& ransac_type,
+    const Eigen::Ref<const Correspondence3D3DMatrix>& correspondences,
+    const Eigen::VectorXi& offsets,
+    const int num_threads,
+    BatchEstimationResult* result) {
+  return EstimateInBatch<PointCorrespondence3D3D, Correspondence3D3DMatrix>(
+      ransac_params,
+      correspondences,
+      offsets,
+      num_threads,
+      4,
+      13,
+      [&](const RansacParameters& problem_params,
+          const std::vector<PointCorrespondence3D3D>& problem_correspondences,
+          const int problem,
+          RansacSummary* summary) {
+        SimilarityTransformationEstimator estimator;
+        const std::unique_ptr<
+            SampleConsensusEstimator<SimilarityTransformationEstimator> >
+            ransac = CreateAndInitializeRansacVariant(
+                ransac_type, problem_params, estimator);
+        SimilarityTransformation similarity_transformation;
+        if (!ransac->Estimate(problem_correspondences,
+                              &similarity_transformation,
+                              summary)) {
+          return false;
+        }
+        SetSimilarityTransformation(similarity_transformation, problem, result);
+        return true;
+      },
+      result);
+}
+
+bool EstimateSimilarityTransformationsFromRays(
+    const RansacParameters& ransac_params,
+    const RansacType& ransac_type,
+    const Eigen::Ref<const RayCorrespondenceMatrix>& correspondences,
+    const Eigen::VectorXi& offsets,
+    const int num_threads,
+    BatchEstimationResult* result) {
+  return EstimateInBatch<RayCorrespondence, RayCorrespondenceMatrix>(
+      ransac_params,
+      correspondences,
+      offsets,
+      num_threads,
+      4,
+      13,
+      [&](const RansacParameters& problem_params,
+          const std::vector<RayCorrespondence>& problem_correspondences,
+          const int problem,
+          RansacSummary* summary) {
+        // The seed of the solver is drawn from the stream of the problem, so
+        // the models do not depend on the number of threads either.
+        RaySimilarityTransformationEstimator estimator(
+            problem_params.rng == nullptr
+                ? kDefaultGdlsSeed
+                : problem_params.rng->RandInt(
+                      0, std::numeric_limits<int>::max()));
+        const std::unique_ptr<
+            SampleConsensusEstimator<RaySimilarityTransformationEstimator> >
+            ransac = CreateAndInitializeRansacVariant(
+                ransac_type, problem_params, estimator);
+        SimilarityTransformation similarity_transformation;
+        if (!ransac->Estimate(problem_correspondences,
+                              &similarity_transformation,
+                              summary)) {
+          return false;
+        }
+        SetSimilarityTransformation(similarity_transformation, problem, result);
+        return true;
+      },
+      result);
+}
+
+}  // namespace theia
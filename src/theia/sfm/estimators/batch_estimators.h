@@ -0,0 +1,175 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#ifndef THEIA_SFM_ESTIMATORS_BATCH_ESTIMATORS_H_
+#define THEIA_SFM_ESTIMATORS_BATCH_ESTIMATORS_H_
+
+#include <Eigen/Core>
+
+#include "theia/sfm/create_and_initialize_ransac_variant.h"
+#include "theia/sfm/estimators/estimate_calibrated_absolute_pose.h"
+
+namespace theia {
+
+struct RansacParameters;
+
+// The functions below run the same robust estimator on many independent
+// problems, e.g. to verify all image pairs of a dataset at once. The
+// correspondences of all problems are stacked into one matrix, one
+// correspondence per row, and the correspondences of problem i are the rows
+// [offsets(i), offsets(i + 1)). offsets must start at 0, be non-decreasing and
+// end with the number of rows. The problems are solved in parallel with
+// num_threads threads. If ransac_params.rng is set, problem i uses the stream
+// ransac_params.rng->Split(i), so the results do not depend on num_threads.
+//
+// Problems with fewer correspondences than the minimal sample of the estimator
+// fail. Each function returns false without estimating anything if the offsets
+// are invalid.
+
+// Two-view correspondences as rows of (x1, y1, x2, y2).
+typedef Eigen::Matrix<double, Eigen::Dynamic, 4, Eigen::RowMajor>
+    TwoViewCorrespondenceMatrix;
+
+// 2D-3D correspondences as rows of (x, y, X, Y, Z).
+typedef Eigen::Matrix<double, Eigen::Dynamic, 5, Eigen::RowMajor>
+    Correspondence2D3DMatrix;
+
+// 3D-3D correspondences as rows of (x1, y1, z1, x2, y2, z2).
+typedef Eigen::Matrix<double, Eigen::Dynamic, 6, Eigen::RowMajor>
+    Correspondence3D3DMatrix;
+
+// Ray to 3D point correspondences as rows of the ray origin, the ray direction
+// and the point, (cx, cy, cz, dx, dy, dz, X, Y, Z).
+typedef Eigen::Matrix<double, Eigen::Dynamic, 9, Eigen::RowMajor>
+    RayCorrespondenceMatrix;
+
+struct BatchEstimationResult {
+  // True if a model was estimated for problem i.
+  Eigen::Matrix<bool, Eigen::Dynamic, 1> success;
+
+  // Row i holds the model of problem i. Matrices are stored in row-major
+  // order, and poses as the row-major rotation followed by the position. The
+  // rows of failed problems are zero.
+  Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> models;
+
+  // The number of inliers of problem i.
+  Eigen::VectorXi num_inliers;
+
+  // True if correspondence j is an inlier to the model of its problem.
+  Eigen::Matrix<bool, Eigen::Dynamic, 1> inliers;
+};
+
+// Models are 3x3 essential matrices (9 columns). See EstimateEssentialMatrix.
+bool EstimateEssentialMatrices(
+    const RansacParameters& ransac_params,
+    const RansacType& ransac_type,
+    const Eigen::Ref<const TwoViewCorrespondenceMatrix>&
+        normalized_correspondences,
+    const Eigen::VectorXi& offsets,
+    const int num_threads,
+    BatchEstimationResult* result);
+
+// Models are 3x3 fundamental matrices (9 columns). See
+// EstimateFundamentalMatrix.
+bool EstimateFundamentalMatrices(
+    const RansacParameters& ransac_params,
+    const RansacType& ransac_type,
+    const Eigen::Ref<const TwoViewCorrespondenceMatrix>& correspondences,
+    const Eigen::VectorXi& offsets,
+    const int num_threads,
+    BatchEstimationResult* result);
+
+// Models are 3x3 homographies (9 columns). See EstimateHomography.
+bool EstimateHomographies(
+    const RansacParameters& ransac_params,
+    const RansacType& ransac_type,
+    const Eigen::Ref<const TwoViewCorrespondenceMatrix>& correspondences,
+    const Eigen::VectorXi& offsets,
+    const int num_threads,
+    BatchEstimationResult* result);
+
+// Models are relative rotations and positions (12 columns). See
+// EstimateRelativePose.
+bool EstimateRelativePoses(
+    const RansacParameters& ransac_params,
+    const RansacType& ransac_type,
+    const Eigen::Ref<const TwoViewCorrespondenceMatrix>&
+        normalized_correspondences,
+    const Eigen::VectorXi& offsets,
+    const int num_threads,
+    BatchEstimationResult* result);
+
+// Models are camera rotations and positions (12 columns). See
+// EstimateCalibratedAbsolutePose.
+bool EstimateCalibratedAbsolutePoses(
+    const RansacParameters& ransac_params,
+    const RansacType& ransac_type,
+    const PnPType& pnp_type,
+    const Eigen::Ref<const Correspondence2D3DMatrix>&
+        normalized_correspondences,
+    const Eigen::VectorXi& offsets,
+    const int num_threads,
+    BatchEstimationResult* result);
+
+// Models are the similarity transformations s, R, t that align the second
+// points to the first ones, x1 = s * R * x2 + t, stored as the row-major
+// rotation, the translation and the scale (13 columns). Minimal samples are
+// aligned with AlignPointCloudsUmeyama and the error is the squared distance
+// between x1 and the transformed x2.
+bool EstimateSimilarityTransformations(
+    const RansacParameters& ransac_params,
+    const RansacType& ransac_type,
+    const Eigen::Ref<const Correspondence3D3DMatrix>& correspondences,
+    const Eigen::VectorXi& offsets,
+    const int num_threads,
+    BatchEstimationResult* result);
+
+// Models are the similarity transformations s, R, t that align the rays with
+// the points, i.e. the point X lies on the transformed ray
+// R * (s * c + alpha * d) + t for some depth alpha > 0, stored as in
+// EstimateSimilarityTransformations (13 columns). Minimal samples of 4 rays
+// are solved with GdlsSimilarityTransform. The error is the squared distance
+// between the unit ray direction and the unit direction from the ray origin to
+// the point, which is about the squared angle between them for small angles.
+bool EstimateSimilarityTransformationsFromRays(
+    const RansacParameters& ransac_params,
+    const RansacType& ransac_type,
+    const Eigen::Ref<const RayCorrespondenceMatrix>& correspondences,
+    const Eigen::VectorXi& offsets,
+    const int num_threads,
+    BatchEstimationResult* result);
+
+}  // namespace theia
+
+#endif  // THEIA_SFM_ESTIMATORS_BATCH_ESTIMATORS_H_
@@ -0,0 +1,331 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#include <Eigen/Core>
+#include <Eigen/Geometry>
+#include <memory>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "theia/matching/feature_correspondence.h"
+#include "theia/sfm/estimators/batch_estimators.h"
+#include "theia/sfm/estimators/estimate_essential_matrix.h"
+#include "theia/sfm/estimators/estimate_homography.h"
+#include "theia/solvers/sample_consensus_estimator.h"
+#include "theia/util/random.h"
+
+namespace theia {
+namespace {
+
+using Eigen::AngleAxisd;
+using Eigen::Matrix3d;
+using Eigen::Vector2d;
+using Eigen::Vector3d;
+
+static const double kErrorThreshold = 1e-6;
+
+// Stacks the correspondences of two views of random points for each problem.
+// The last 20% of the correspondences of each problem are outliers, and every
+// third problem lies on the plane z = 5.
+void GenerateProblems(const std::vector<int>& num_correspondences,
+                      RandomNumberGenerator* rng,
+                      TwoViewCorrespondenceMatrix* matrix,
+                      Eigen::VectorXi* offsets,
+                      std::vector<std::vector<FeatureCorrespondence> >*
+                          problems) {
+  offsets->resize(num_correspondences.size() + 1);
+  (*offsets)(0) = 0;
+  for (int i = 0; i < num_correspondences.size(); i++) {
+    (*offsets)(i + 1) = (*offsets)(i) + num_correspondences[i];
+  }
+  matrix->resize((*offsets)(num_correspondences.size()), 4);
+  problems->resize(num_correspondences.size());
+
+  for (int i = 0; i < num_correspondences.size(); i++) {
+    const Matrix3d rotation =
+        AngleAxisd(rng->RandDouble(-0.2, 0.2), Vector3d::UnitY())
+            .toRotationMatrix();
+    const Vector3d translation(1.0, rng->RandDouble(-0.2, 0.2), 0.1);
+    for (int j = 0; j < num_correspondences[i]; j++) {
+      const Vector3d point(rng->RandDouble(-2.0, 2.0),
+                           rng->RandDouble(-2.0, 2.0),
+                           i % 3 == 0 ? 5.0 : rng->RandDouble(4.0, 6.0));
+      Vector2d feature1 = point.hnormalized();
+      Vector2d feature2 = (rotation * point + translation).hnormalized();
+      if (j >= 0.8 * num_correspondences[i]) {
+        feature2 = Vector2d(rng->RandDouble(-1.0, 1.0),
+                            rng->RandDouble(-1.0, 1.0));
+      }
+      matrix->row((*offsets)(i) + j) << feature1.transpose(),
+          feature2.transpose();
+      (*problems)[i].emplace_back(Feature(feature1), Feature(feature2));
+    }
+  }
+}
+
+RansacParameters SeededRansacParameters() {
+  RansacParameters params;
+  params.rng = std::make_shared<RandomNumberGenerator>(57);
+  params.error_thresh = kErrorThreshold;
+  params.failure_probability = 0.001;
+  return params;
+}
+
+TEST(BatchEstimators, EssentialMatricesMatchSingleEstimates) {
+  RandomNumberGenerator rng(59);
+  TwoViewCorrespondenceMatrix matrix;
+  Eigen::VectorXi offsets;
+  std::vector<std::vector<FeatureCorrespondence> > problems;
+  GenerateProblems({40, 0, 25, 60, 3, 50}, &rng, &matrix, &offsets, &problems);
+
+  const RansacParameters params = SeededRansacParameters();
+  BatchEstimationResult result;
+  EXPECT_TRUE(EstimateEssentialMatrices(
+      params, RansacType::RANSAC, matrix, offsets, 1, &result));
+  ASSERT_EQ(result.models.rows(), problems.size());
+  ASSERT_EQ(result.models.cols(), 9);
+  ASSERT_EQ(result.inliers.size(), matrix.rows());
+
+  for (int i = 0; i < problems.size(); i++) {
+    // Problems with fewer correspondences than the minimal sample fail.
+    if (problems[i].size() < 5) {
+      EXPECT_FALSE(result.success(i));
+      EXPECT_TRUE(result.models.row(i).isZero());
+      continue;
+    }
+
+    RansacParameters problem_params = params;
+    problem_params.rng = params.rng->Split(i);
+    Matrix3d essential_matrix;
+    RansacSummary summary;
+    const bool success = EstimateEssentialMatrix(problem_params,
+                                                 RansacType::RANSAC,
+                                                 problems[i],
+                                                 &essential_matrix,
+                                                 &summary);
+    ASSERT_TRUE(success);
+    EXPECT_TRUE(result.success(i));
+
+    const Eigen::Matrix<double, 3, 3, Eigen::RowMajor> model =
+        Eigen::Map<const Eigen::Matrix<double, 3, 3, Eigen::RowMajor> >(
+            result.models.row(i).data());
+    EXPECT_TRUE(model == essential_matrix);
+    EXPECT_EQ(result.num_inliers(i), summary.inliers.size());
+    for (const int inlier : summary.inliers) {
+      EXPECT_TRUE(result.inliers(offsets(i) + inlier));
+    }
+  }
+  EXPECT_EQ(result.inliers.count(), result.num_inliers.sum());
+}
+
+TEST(BatchEstimators, ResultsDoNotDependOnNumThreads) {
+  RandomNumberGenerator rng(61);
+  TwoViewCorrespondenceMatrix matrix;
+  Eigen::VectorXi offsets;
+  std::vector<std::vector<FeatureCorrespondence> > problems;
+  GenerateProblems(
+      {30, 45, 20, 35, 40, 25, 30, 50}, &rng, &matrix, &offsets, &problems);
+
+  const RansacParameters params = SeededRansacParameters();
+  BatchEstimationResult single_threaded, multi_threaded;
+  EXPECT_TRUE(EstimateHomographies(
+      params, RansacType::RANSAC, matrix, offsets, 1, &single_threaded));
+  EXPECT_TRUE(EstimateHomographies(
+      params, RansacType::RANSAC, matrix, offsets, 4, &multi_threaded));
+  EXPECT_TRUE(single_threaded.success == multi_threaded.success);
+  EXPECT_TRUE(single_threaded.models == multi_threaded.models);
+  EXPECT_TRUE(single_threaded.inliers == multi_threaded.inliers);
+
+  // The homographies of the planar problems fit all of their inliers.
+  for (int i = 0; i < problems.size(); i += 3) {
+    EXPECT_TRUE(single_threaded.success(i));
+    EXPECT_GE(single_threaded.num_inliers(i), 0.8 * problems[i].size());
+  }
+}
+
+TEST(BatchEstimators, InvalidOffsets) {
+  RandomNumberGenerator rng(67);
+  TwoViewCorrespondenceMatrix matrix;
+  Eigen::VectorXi offsets;
+  std::vector<std::vector<FeatureCorrespondence> > problems;
+  GenerateProblems({20, 20}, &rng, &matrix, &offsets, &problems);
+
+  const RansacParameters params = SeededRansacParameters();
+  BatchEstimationResult result;
+  Eigen::VectorXi invalid_offsets(3);
+  // Does not cover all correspondences.
+  invalid_offsets << 0, 20, 30;
+  EXPECT_FALSE(EstimateFundamentalMatrices(
+      params, RansacType::RANSAC, matrix, invalid_offsets, 1, &result));
+  // Does not start at zero.
+  invalid_offsets << 5, 20, 40;
+  EXPECT_FALSE(EstimateFundamentalMatrices(
+      params, RansacType::RANSAC, matrix, invalid_offsets, 1, &result));
+  // Decreasing.
+  invalid_offsets << 0, 45, 40;
+  EXPECT_FALSE(EstimateFundamentalMatrices(
+      params, RansacType::RANSAC, matrix, invalid_offsets, 1, &result));
+  EXPECT_FALSE(EstimateFundamentalMatrices(
+      params, RansacType::RANSAC, matrix, Eigen::VectorXi(), 1, &result));
+
+  EXPECT_TRUE(EstimateFundamentalMatrices(
+      params, RansacType::RANSAC, matrix, offsets, 2, &result));
+  EXPECT_EQ(result.success.size(), 2);
+}
+
+// The similarity transformation of a row of the models.
+void GetSimilarityTransformation(const BatchEstimationResult& result,
+                                 const int problem,
+                                 Matrix3d* rotation,
+                                 Vector3d* translation,
+                                 double* scale) {
+  *rotation = Eigen::Map<const Eigen::Matrix<double, 3, 3, Eigen::RowMajor> >(
+      result.models.row(problem).data());
+  *translation = result.models.row(problem).segment<3>(9).transpose();
+  *scale = result.models(problem, 12);
+}
+
+TEST(BatchEstimators, SimilarityTransformations) {
+  static const int kNumProblems = 6;
+  static const int kNumCorrespondences = 40;
+  static const int kNumOutliers = 8;
+  RandomNumberGenerator rng(71);
+
+  Correspondence3D3DMatrix matrix(kNumProblems * kNumCorrespondences, 6);
+  Eigen::VectorXi offsets(kNumProblems + 1);
+  std::vector<Matrix3d> rotations(kNumProblems);
+  std::vector<Vector3d> translations(kNumProblems);
+  std::vector<double> scales(kNumProblems);
+  for (int i = 0; i < kNumProblems; i++) {
+    offsets(i) = i * kNumCorrespondences;
+    rotations[i] = AngleAxisd(rng.RandDouble(-1.0, 1.0),
+                              rng.RandVector3d().normalized())
+                       .toRotationMatrix();
+    translations[i] = rng.RandVector3d(-5.0, 5.0);
+    scales[i] = rng.RandDouble(0.5, 2.0);
+    for (int j = 0; j < kNumCorrespondences; j++) {
+      const Vector3d point2 = rng.RandVector3d(-10.0, 10.0);
+      Vector3d point1 = scales[i] * rotations[i] * point2 + translations[i];
+      if (j < kNumOutliers) {
+        point1 += rng.RandVector3d(5.0, 10.0);
+      }
+      matrix.row(offsets(i) + j) << point1.transpose(), point2.transpose();
+    }
+  }
+  offsets(kNumProblems) = kNumProblems * kNumCorrespondences;
+
+  RansacParameters params = SeededRansacParameters();
+  params.error_thresh = 1e-4;
+  BatchEstimationResult result, multi_threaded;
+  EXPECT_TRUE(EstimateSimilarityTransformations(
+      params, RansacType::RANSAC, matrix, offsets, 1, &result));
+  EXPECT_TRUE(EstimateSimilarityTransformations(
+      params, RansacType::RANSAC, matrix, offsets, 3, &multi_threaded));
+  ASSERT_EQ(result.models.cols(), 13);
+  EXPECT_TRUE(result.models == multi_threaded.models);
+
+  for (int i = 0; i < kNumProblems; i++) {
+    EXPECT_TRUE(result.success(i));
+    EXPECT_EQ(result.num_inliers(i), kNumCorrespondences - kNumOutliers);
+    Matrix3d rotation;
+    Vector3d translation;
+    double scale;
+    GetSimilarityTransformation(result, i, &rotation, &translation, &scale);
+    EXPECT_LT((rotation - rotations[i]).norm(), 1e-6);
+    EXPECT_LT((translation - translations[i]).norm(), 1e-6);
+    EXPECT_NEAR(scale, scales[i], 1e-6);
+  }
+}
+
+TEST(BatchEstimators, SimilarityTransformationsFromRays) {
+  static const int kNumProblems = 4;
+  static const int kNumCorrespondences = 30;
+  static const int kNumOutliers = 5;
+  RandomNumberGenerator rng(73);
+
+  RayCorrespondenceMatrix matrix(kNumProblems * kNumCorrespondences, 9);
+  Eigen::VectorXi offsets(kNumProblems + 1);
+  std::vector<Matrix3d> rotations(kNumProblems);
+  std::vector<Vector3d> translations(kNumProblems);
+  std::vector<double> scales(kNumProblems);
+  for (int i = 0; i < kNumProblems; i++) {
+    offsets(i) = i * kNumCorrespondences;
+    rotations[i] = AngleAxisd(rng.RandDouble(-0.5, 0.5),
+                              rng.RandVector3d().normalized())
+                       .toRotationMatrix();
+    translations[i] = rng.RandVector3d(-2.0, 2.0);
+    scales[i] = rng.RandDouble(0.5, 2.0);
+    for (int j = 0; j < kNumCorrespondences; j++) {
+      // Rays of a few cameras looking at points in front of them.
+      const Vector3d origin = rng.RandVector3d(-1.0, 1.0);
+      const Vector3d point_in_ray_frame =
+          Vector3d(rng.RandDouble(-3.0, 3.0), rng.RandDouble(-3.0, 3.0), 8.0);
+      Vector3d direction =
+          (point_in_ray_frame - scales[i] * origin).normalized();
+      if (j < kNumOutliers) {
+        direction = (direction + rng.RandVector3d(0.2, 0.4)).normalized();
+      }
+      const Vector3d point =
+          rotations[i] * point_in_ray_frame + translations[i];
+      matrix.row(offsets(i) + j) << origin.transpose(), direction.transpose(),
+          point.transpose();
+    }
+  }
+  offsets(kNumProblems) = kNumProblems * kNumCorrespondences;
+
+  RansacParameters params = SeededRansacParameters();
+  params.error_thresh = 1e-8;
+  BatchEstimationResult result, multi_threaded;
+  EXPECT_TRUE(EstimateSimilarityTransformationsFromRays(
+      params, RansacType::RANSAC, matrix, offsets, 1, &result));
+  EXPECT_TRUE(EstimateSimilarityTransformationsFromRays(
+      params, RansacType::RANSAC, matrix, offsets, 2, &multi_threaded));
+  EXPECT_TRUE(result.models == multi_threaded.models);
+
+  for (int i = 0; i < kNumProblems; i++) {
+    EXPECT_TRUE(result.success(i));
+    EXPECT_EQ(result.num_inliers(i), kNumCorrespondences - kNumOutliers);
+    Matrix3d rotation;
+    Vector3d translation;
+    double scale;
+    GetSimilarityTransformation(result, i, &rotation, &translation, &scale);
+    EXPECT_LT((rotation - rotations[i]).norm(), 1e-3);
+    EXPECT_LT((translation - translations[i]).norm(), 1e-3);
+    EXPECT_NEAR(scale, scales[i], 1e-3);
+  }
+}
+
+}  // namespace
+}  // namespace theia
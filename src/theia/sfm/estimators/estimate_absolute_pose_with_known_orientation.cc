@@ -82,7 +82,8 @@ class AbsolutePoseWithKnownOrientationEstimator
   AbsolutePoseWithKnownOrientationEstimator() {}
 
   // 2 correspondences are needed to determine the absolute position.
-  double SampleSize() const { return 2; }
+  static constexpr int kSampleSize = 2;
+  double SampleSize() const { return kSampleSize; }
 
   // Estimates candidate absolute poses from correspondences.
   bool EstimateModel(
@@ -44,8 +44,10 @@
 #include "theia/sfm/pose/perspective_three_point.h"
 #include "theia/sfm/pose/sqpnp.h"
 #include "theia/sfm/pose/dls_pnp.h"
+#include "theia/sfm/pose/two_point_pose_partial_rotation.h"
 #include "theia/solvers/estimator.h"
 #include "theia/solvers/sample_consensus_estimator.h"
+#include "theia/util/fixed_capacity_vector.h"
 #include "theia/util/util.h"
 
 #include "theia/sfm/reconstruction.h"
@@ -71,37 +73,49 @@ class CalibratedAbsolutePoseEstimator
 
   CalibratedAbsolutePoseEstimator(const PnPType& pnp_type) : pnp_type_(pnp_type) {}
   // 3 correspondences are needed to determine the absolute pose.
-  double SampleSize() const { return 3; }
+  static constexpr int kSampleSize = 3;
+  double SampleSize() const { return kSampleSize; }
 
-  // Estimates candidate absolute poses from correspondences.
+  // Estimates candidate absolute poses from correspondences. The Kneip solver
+  // runs without allocating memory.
   bool EstimateModel(
       const std::vector<FeatureCorrespondence2D3D>& correspondences,
       std::vector<CalibratedAbsolutePose>* absolute_poses) const {
-    std::vector<Eigen::Vector2d> features(3);
-    std::vector<Eigen::Vector3d> world_points(3);
+    Eigen::Vector2d features[3];
+    Eigen::Vector3d world_points[3];
     for (int i = 0; i < 3; ++i) {
         features[i] = correspondences[i].feature;
         world_points[i] = correspondences[i].world_point;
     }
 
+    if (pnp_type_ == PnPType::KNEIP || pnp_type_ == PnPType::CASCADE) {
+      FixedCapacityVector<Eigen::Matrix3d, 4> rotations;
+      FixedCapacityVector<Eigen::Vector3d, 4> translations;
+      if (!PoseFromThreePoints(
+              features, world_points, &rotations, &translations)) {
+        return false;
+      }
+      AddPoses(rotations, translations, absolute_poses);
+      return absolute_poses->size() > 0;
+    }
+
+    const std::vector<Eigen::Vector2d> feature_vector(features, features + 3);
+    const std::vector<Eigen::Vector3d> world_point_vector(world_points,
+                                                          world_points + 3);
     std::vector<Eigen::Matrix3d> rotations;
     std::vector<Eigen::Vector3d> translations;
     std::vector<Eigen::Quaterniond> quats;
 
-    if (pnp_type_ == PnPType::KNEIP) {
-        if (!PoseFromThreePoints(
-                features, world_points, &rotations, &translations)) {
-          return false;
-        }
-    } else if (pnp_type_ == PnPType::DLS) {
-        if (!DlsPnp(features, world_points, &quats, &translations)) {
+    if (pnp_type_ == PnPType::DLS) {
+        if (!DlsPnp(
+                feature_vector, world_point_vector, &quats, &translations)) {
             return false;
         }
         for (const auto& q : quats) {
             rotations.push_back(q.matrix());
         }
     } else if (pnp_type_ == PnPType::SQPnP) {
-      if (!SQPnP(features, world_points, &quats, &translations)) {
+      if (!SQPnP(feature_vector, world_point_vector, &quats, &translations)) {
           return false;
       }
       for (const auto& q : quats) {
@@ -109,13 +123,7 @@ class CalibratedAbsolutePoseEstimator
       }
     }
 
-    for (size_t i = 0; i < rotations.size(); i++) {
-      CalibratedAbsolutePose pose;
-      pose.rotation = rotations[i];
-      pose.position = -pose.rotation.transpose() * translations[i];
-      absolute_poses->emplace_back(pose);
-    }
-
+    AddPoses(rotations, translations, absolute_poses);
     return absolute_poses->size() > 0;
   }
 
@@ -158,12 +166,179 @@ class CalibratedAbsolutePoseEstimator
     return (reprojected_feature - correspondence.feature).squaredNorm();
   }
 
+  // Computes the same errors as Error for all correspondences at once. The
+  // points are transformed as R * X + t with the translation t = -R * c
+  // computed once for the model. If the correspondences are the ones passed to
+  // SetCorrespondences they are read from the structure-of-arrays copy.
+  void Residuals(const std::vector<FeatureCorrespondence2D3D>& correspondences,
+                 const CalibratedAbsolutePose& absolute_pose,
+                 std::vector<double>* residuals) const {
+    residuals->resize(correspondences.size());
+    const Eigen::Matrix3d& rotation = absolute_pose.rotation;
+    const Eigen::Vector3d translation = -rotation * absolute_pose.position;
+    if (&correspondences != correspondences_) {
+      for (int i = 0; i < correspondences.size(); i++) {
+        const Eigen::Vector2d reprojected_feature =
+            (rotation * correspondences[i].world_point + translation)
+                .hnormalized();
+        (*residuals)[i] =
+            (reprojected_feature - correspondences[i].feature).squaredNorm();
+      }
+      return;
+    }
+
+    const FeatureCorrespondence2D3DArrays& arrays = correspondence_arrays_;
+    for (int i = 0; i < arrays.size(); i++) {
+      const Eigen::Vector3d world_point(
+          arrays.point_x[i], arrays.point_y[i], arrays.point_z[i]);
+      const Eigen::Vector3d point = rotation * world_point + translation;
+      const double dx = point.x() / point.z() - arrays.feature_x[i];
+      const double dy = point.y() / point.z() - arrays.feature_y[i];
+      (*residuals)[i] = dx * dx + dy * dy;
+    }
+  }
+
+  // Copies the correspondences that will be passed to Residuals into
+  // structure-of-arrays form. The correspondences must outlive the estimation.
+  void SetCorrespondences(
+      const std::vector<FeatureCorrespondence2D3D>& correspondences) {
+    correspondences_ = &correspondences;
+    correspondence_arrays_.Assign(correspondences);
+  }
+
+ protected:
+  // Converts the rotations and translations returned by the solvers to poses.
+  template <class Rotations, class Translations>
+  static void AddPoses(const Rotations& rotations,
+                       const Translations& translations,
+                       std::vector<CalibratedAbsolutePose>* absolute_poses) {
+    for (int i = 0; i < rotations.size(); i++) {
+      CalibratedAbsolutePose pose;
+      pose.rotation = rotations[i];
+      pose.position = -pose.rotation.transpose() * translations[i];
+      absolute_poses->emplace_back(pose);
+    }
+  }
+
  private:
   PnPType pnp_type_;
   theia::BundleAdjustmentOptions ba_opts_;
+  const std::vector<FeatureCorrespondence2D3D>* correspondences_ = nullptr;
+  FeatureCorrespondence2D3DArrays correspondence_arrays_;
   DISALLOW_COPY_AND_ASSIGN(CalibratedAbsolutePoseEstimator);
 };
 
+// An estimator for computing the absolute pose of a camera with a known
+// gravity direction from 2 feature correspondences. The rotation is the
+// rotation that aligns the world gravity (0, 0, -1) with the gravity in the
+// camera, followed by an unknown rotation about the world gravity, which is
+// solved for by TwoPointPosePartialRotation.
+class GravityAwareAbsolutePoseEstimator
+    : public CalibratedAbsolutePoseEstimator {
+ public:
+  // The gravity is the direction of the world gravity in camera coordinates,
+  // as in View::GetGravityPrior.
+  explicit GravityAwareAbsolutePoseEstimator(const Eigen::Vector3d& gravity)
+      : CalibratedAbsolutePoseEstimator(PnPType::KNEIP),
+        tilt_(Eigen::Quaterniond::FromTwoVectors(-Vector3d::UnitZ(),
+                                                 gravity.normalized())) {}
+
+  // 2 correspondences are needed to determine the remaining rotation about the
+  // gravity and the position.
+  static constexpr int kSampleSize = 2;
+  double SampleSize() const { return kSampleSize; }
+
+  bool EstimateModel(
+      const std::vector<FeatureCorrespondence2D3D>& correspondences,
+      std::vector<CalibratedAbsolutePose>* absolute_poses) const {
+    // Undo the tilt of the camera so that the rays only differ from the world
+    // by a rotation about the gravity.
+    const Vector3d image_rays[2] = {
+        tilt_.conjugate() *
+            correspondences[0].feature.homogeneous().normalized(),
+        tilt_.conjugate() *
+            correspondences[1].feature.homogeneous().normalized()};
+    Eigen::Quaterniond rotations[2];
+    Vector3d translations[2];
+    const int num_solutions =
+        TwoPointPosePartialRotation(Vector3d::UnitZ(),
+                                    correspondences[0].world_point,
+                                    correspondences[1].world_point,
+                                    image_rays[0],
+                                    image_rays[1],
+                                    rotations,
+                                    translations);
+    FixedCapacityVector<Matrix3d, 2> camera_rotations;
+    FixedCapacityVector<Vector3d, 2> camera_translations;
+    for (int i = 0; i < num_solutions; i++) {
+      camera_rotations.emplace_back((tilt_ * rotations[i]).toRotationMatrix());
+      camera_translations.emplace_back(tilt_ * translations[i]);
+    }
+    AddPoses(camera_rotations, camera_translations, absolute_poses);
+    return num_solutions > 0;
+  }
+
+ private:
+  const Eigen::Quaterniond tilt_;
+  DISALLOW_COPY_AND_ASSIGN(GravityAwareAbsolutePoseEstimator);
+};
+
+// Returns the correspondences whose error under the pose is below the
+// threshold.
+void GetInliers(const CalibratedAbsolutePoseEstimator& estimator,
+                const std::vector<FeatureCorrespondence2D3D>& correspondences,
+                const CalibratedAbsolutePose& pose,
+                const double error_thresh,
+                std::vector<int>* inliers) {
+  std::vector<double> residuals;
+  estimator.Residuals(correspondences, pose, &residuals);
+  inliers->clear();
+  for (int i = 0; i < residuals.size(); i++) {
+    if (residuals[i] < error_thresh) {
+      inliers->emplace_back(i);
+    }
+  }
+}
+
+// Refits the pose found by RANSAC with SQPnP on all of its inliers. The refit
+// pose replaces the RANSAC pose if it has at least as many inliers, in which
+// case the inliers of the summary are updated.
+void RefitPoseToInliers(
+    const CalibratedAbsolutePoseEstimator& estimator,
+    const double error_thresh,
+    const std::vector<FeatureCorrespondence2D3D>& correspondences,
+    CalibratedAbsolutePose* absolute_pose,
+    RansacSummary* ransac_summary) {
+  const std::vector<int>& inliers = ransac_summary->inliers;
+  if (inliers.size() < 3) {
+    return;
+  }
+  std::vector<Eigen::Vector2d> features(inliers.size());
+  std::vector<Vector3d> world_points(inliers.size());
+  for (int i = 0; i < inliers.size(); i++) {
+    features[i] = correspondences[inliers[i]].feature;
+    world_points[i] = correspondences[inliers[i]].world_point;
+  }
+  std::vector<Eigen::Quaterniond> rotations;
+  std::vector<Vector3d> translations;
+  if (!SQPnP(features, world_points, &rotations, &translations)) {
+    return;
+  }
+
+  std::vector<int> refit_inliers;
+  for (int i = 0; i < rotations.size(); i++) {
+    CalibratedAbsolutePose refit_pose;
+    refit_pose.rotation = rotations[i].toRotationMatrix();
+    refit_pose.position = -refit_pose.rotation.transpose() * translations[i];
+    GetInliers(
+        estimator, correspondences, refit_pose, error_thresh, &refit_inliers);
+    if (refit_inliers.size() >= ransac_summary->inliers.size()) {
+      *absolute_pose = refit_pose;
+      std::swap(ransac_summary->inliers, refit_inliers);
+    }
+  }
+}
+
 }  // namespace
 
 bool EstimateCalibratedAbsolutePose(
@@ -174,12 +349,49 @@ bool EstimateCalibratedAbsolutePose(
     CalibratedAbsolutePose* absolute_pose,
     RansacSummary* ransac_summary) {
   CalibratedAbsolutePoseEstimator absolute_pose_estimator(pnp_type);
+  absolute_pose_estimator.SetCorrespondences(normalized_correspondences);
   std::unique_ptr<SampleConsensusEstimator<CalibratedAbsolutePoseEstimator> >
       ransac = CreateAndInitializeRansacVariant(
           ransac_type, ransac_params, absolute_pose_estimator);
   // Estimate the absolute pose.
-  return ransac->Estimate(
-      normalized_correspondences, absolute_pose, ransac_summary);
+  if (!ransac->Estimate(
+          normalized_correspondences, absolute_pose, ransac_summary)) {
+    return false;
+  }
+  if (pnp_type == PnPType::CASCADE) {
+    RefitPoseToInliers(absolute_pose_estimator,
+                       ransac_params.error_thresh,
+                       normalized_correspondences,
+                       absolute_pose,
+                       ransac_summary);
+  }
+  return true;
+}
+
+bool EstimateCalibratedAbsolutePoseWithKnownGravity(
+    const RansacParameters& ransac_params,
+    const RansacType& ransac_type,
+    const Eigen::Vector3d& gravity,
+    const std::vector<FeatureCorrespondence2D3D>& normalized_correspondences,
+    CalibratedAbsolutePose* absolute_pose,
+    RansacSummary* ransac_summary) {
+  GravityAwareAbsolutePoseEstimator absolute_pose_estimator(gravity);
+  absolute_pose_estimator.SetCorrespondences(normalized_correspondences);
+  std::unique_ptr<SampleConsensusEstimator<GravityAwareAbsolutePoseEstimator> >
+      ransac = CreateAndInitializeRansacVariant(
+          ransac_type, ransac_params, absolute_pose_estimator);
+  if (!ransac->Estimate(
+          normalized_correspondences, absolute_pose, ransac_summary)) {
+    return false;
+  }
+  // The gravity prior is only used to find the inliers. The final pose is
+  // estimated from all inliers without it.
+  RefitPoseToInliers(absolute_pose_estimator,
+                     ransac_params.error_thresh,
+                     normalized_correspondences,
+                     absolute_pose,
+                     ransac_summary);
+  return true;
 }
 
 }  // namespace theia
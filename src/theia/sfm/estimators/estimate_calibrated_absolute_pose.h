@@ -51,7 +51,11 @@ struct CalibratedAbsolutePose {
   Eigen::Vector3d position;
 };
 
-enum class PnPType {KNEIP, SQPnP, DLS};
+// The solver used for the hypotheses of EstimateCalibratedAbsolutePose. CASCADE
+// samples minimal hypotheses with P3P (KNEIP) like KNEIP and refits the best
+// hypothesis with SQPnP on all of its inliers, which is nearly as cheap as
+// KNEIP and nearly as accurate as running the non-minimal solvers in RANSAC.
+enum class PnPType {KNEIP, SQPnP, DLS, CASCADE};
 
 // Estimates the calibrated absolute pose using the ransac variant of choice
 // (e.g. Ransac, Prosac, etc.). Correspondences must be normalized by the camera
@@ -64,6 +68,21 @@ bool EstimateCalibratedAbsolutePose(const RansacParameters& ransac_params,
     CalibratedAbsolutePose* absolute_pose,
     RansacSummary* ransac_summary);
 
+// Same as above for a camera with a known gravity direction, e.g. from an
+// accelerometer. The gravity is the direction of the world gravity (0, 0, -1)
+// in camera coordinates, as in View::GetGravityPrior. The hypotheses are
+// computed from 2 correspondences with TwoPointPosePartialRotation, so far
+// fewer samples are needed than with P3P, and the best hypothesis is refit
+// with SQPnP on all of its inliers. The gravity only needs to be accurate
+// enough to find the inliers.
+bool EstimateCalibratedAbsolutePoseWithKnownGravity(
+    const RansacParameters& ransac_params,
+    const RansacType& ransac_type,
+    const Eigen::Vector3d& gravity,
+    const std::vector<FeatureCorrespondence2D3D>& normalized_correspondences,
+    CalibratedAbsolutePose* absolute_pose,
+    RansacSummary* ransac_summary);
+
 }  // namespace theia
 
 #endif  // THEIA_SFM_ESTIMATORS_ESTIMATE_CALIBRATED_ABSOLUTE_POSE_H_
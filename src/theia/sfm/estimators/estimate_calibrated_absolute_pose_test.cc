@@ -72,7 +72,8 @@ void ExecuteRandomTest(const RansacParameters& options,
                        const double inlier_ratio,
                        const double noise,
                        const double tolerance,
-                       const PnPType pnp_type) {
+                       const PnPType pnp_type,
+                       const bool use_gravity = false) {
   // Create feature correspondences (inliers and outliers) and add noise if
   // appropriate.
   std::vector<FeatureCorrespondence2D3D> correspondences;
@@ -103,8 +104,16 @@ void ExecuteRandomTest(const RansacParameters& options,
   // Estimate the absolute pose.
   CalibratedAbsolutePose pose;
   RansacSummary ransac_summary;
-  EXPECT_TRUE(EstimateCalibratedAbsolutePose(
-      options, RansacType::RANSAC, pnp_type, correspondences, &pose, &ransac_summary));
+  if (use_gravity) {
+    const Vector3d gravity = rotation * Vector3d(0.0, 0.0, -1.0);
+    EXPECT_TRUE(EstimateCalibratedAbsolutePoseWithKnownGravity(
+        options, RansacType::RANSAC, gravity, correspondences, &pose,
+        &ransac_summary));
+  } else {
+    EXPECT_TRUE(EstimateCalibratedAbsolutePose(
+        options, RansacType::RANSAC, pnp_type, correspondences, &pose,
+        &ransac_summary));
+  }
 
   // Expect that the inlier ratio is close to the ground truth.
   EXPECT_GT(static_cast<double>(ransac_summary.inliers.size()), 3);
@@ -307,6 +316,68 @@ TEST(EstimateCalibratedAbsolutePose, OutliersWithNoiseKNEIP) {
   }
 }
 
+TEST(EstimateCalibratedAbsolutePose, OutliersWithNoiseCASCADE) {
+  RansacParameters options;
+  options.rng = std::make_shared<RandomNumberGenerator>(rng);
+  options.use_mle = true;
+  options.error_thresh = kErrorThreshold;
+  options.failure_probability = 0.001;
+  options.min_iterations = kMinIterations;
+  const double kInlierRatio = 0.7;
+  const double kNoise = 1.0;
+  const double kPoseTolerance = 1e-2;
+  const PnPType type = PnPType::CASCADE;
+
+  const std::vector<Matrix3d> rotations = {Matrix3d::Identity(),
+                                           RandomRotation(10.0, &rng)};
+  const std::vector<Vector3d> positions = {Vector3d(1, 0, 0),
+                                           Vector3d(0, 1, 0)};
+
+  for (size_t i = 0; i < rotations.size(); i++) {
+    for (size_t j = 0; j < positions.size(); j++) {
+      ExecuteRandomTest(options,
+                        rotations[i],
+                        positions[j],
+                        kInlierRatio,
+                        kNoise,
+                        kPoseTolerance,
+                        type);
+    }
+  }
+}
+
+TEST(EstimateCalibratedAbsolutePose, OutliersWithNoiseKnownGravity) {
+  RansacParameters options;
+  options.rng = std::make_shared<RandomNumberGenerator>(rng);
+  options.use_mle = true;
+  options.error_thresh = kErrorThreshold;
+  options.failure_probability = 0.001;
+  options.min_iterations = kMinIterations;
+  const double kInlierRatio = 0.5;
+  const double kNoise = 1.0;
+  const double kPoseTolerance = 1e-2;
+
+  const std::vector<Matrix3d> rotations = {
+      Matrix3d::Identity(),
+      AngleAxisd(DegToRad(12.0), Vector3d::UnitY()).toRotationMatrix(),
+      RandomRotation(10.0, &rng)};
+  const std::vector<Vector3d> positions = {Vector3d(1, 0, 0),
+                                           Vector3d(0, 1, 0)};
+
+  for (size_t i = 0; i < rotations.size(); i++) {
+    for (size_t j = 0; j < positions.size(); j++) {
+      ExecuteRandomTest(options,
+                        rotations[i],
+                        positions[j],
+                        kInlierRatio,
+                        kNoise,
+                        kPoseTolerance,
+                        PnPType::KNEIP,
+                        true);
+    }
+  }
+}
+
 TEST(EstimateCalibratedAbsolutePose, OutliersWithNoiseDLS) {
   RansacParameters options;
   options.rng = std::make_shared<RandomNumberGenerator>(rng);
@@ -35,15 +35,23 @@
 #include "theia/sfm/estimators/estimate_dominant_plane_from_points.h"
 
 #include <Eigen/Core>
+#include <Eigen/Eigenvalues>
 #include <Eigen/Geometry>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <iterator>
 #include <limits>
 #include <memory>
+#include <numeric>
+#include <utility>
 #include <vector>
 
 #include "theia/sfm/create_and_initialize_ransac_variant.h"
 #include "theia/sfm/pose/util.h"
 #include "theia/solvers/estimator.h"
 #include "theia/solvers/sample_consensus_estimator.h"
+#include "theia/util/executor.h"
 #include "theia/util/util.h"
 
 namespace theia {
@@ -51,13 +59,36 @@ namespace {
 
 using Eigen::Vector3d;
 
+// Fits a plane to the points with least squares. The normal is the direction
+// of least variance of the points.
+Plane FitPlane(const std::vector<Vector3d>& points,
+               const std::vector<int>& indices) {
+  Vector3d centroid = Vector3d::Zero();
+  for (const int index : indices) {
+    centroid += points[index];
+  }
+  centroid /= indices.size();
+  Eigen::Matrix3d covariance = Eigen::Matrix3d::Zero();
+  for (const int index : indices) {
+    const Vector3d offset = points[index] - centroid;
+    covariance += offset * offset.transpose();
+  }
+  const Eigen::SelfAdjointEigenSolver<Eigen::Matrix3d> eigen_solver(
+      covariance);
+  Plane plane;
+  plane.point = centroid;
+  plane.unit_normal = eigen_solver.eigenvectors().col(0);
+  return plane;
+}
+
 // An estimator for computing a dominant plane from a set of 3D points.
 class DominantPlaneEstimator : public Estimator<Vector3d, Plane> {
  public:
   DominantPlaneEstimator() {}
 
   // 3 non-collinear points are needed to determine a plane.
-  double SampleSize() const { return 3; }
+  static constexpr int kSampleSize = 3;
+  double SampleSize() const { return kSampleSize; }
 
   // Estimates candidate dominant planes from three 3D points.
   bool EstimateModel(const std::vector<Vector3d>& points,
@@ -80,15 +111,98 @@ class DominantPlaneEstimator : public Estimator<Vector3d, Plane> {
     return true;
   }
 
+  // Fits a plane to all points with least squares.
+  bool EstimateModelNonminimal(const std::vector<Vector3d>& points,
+                               std::vector<Plane>* planes) const {
+    std::vector<int> indices(points.size());
+    std::iota(indices.begin(), indices.end(), 0);
+    planes->emplace_back(FitPlane(points, indices));
+    return true;
+  }
+
   // The error for a point given a plane model is the point-to-plane distance.
   double Error(const Vector3d& point, const Plane& plane) const {
     return std::abs(plane.unit_normal.dot(point - plane.point));
   }
 
+  // Computes the same errors as Error for all points with the offset of the
+  // plane computed once.
+  void Residuals(const std::vector<Vector3d>& points,
+                 const Plane& plane,
+                 std::vector<double>* residuals) const {
+    residuals->resize(points.size());
+    const double offset = plane.unit_normal.dot(plane.point);
+    for (int i = 0; i < points.size(); i++) {
+      (*residuals)[i] = std::abs(plane.unit_normal.dot(points[i]) - offset);
+    }
+  }
+
  private:
   DISALLOW_COPY_AND_ASSIGN(DominantPlaneEstimator);
 };
 
+// Replaces the points in each occupied voxel of the grid by their mean. The
+// voxels are found by sorting the points by their voxel coordinates, so the
+// output does not depend on the number of threads.
+void DecimatePoints(const std::vector<Vector3d>& points,
+                    const std::vector<int>& indices,
+                    const double voxel_size,
+                    const int num_threads,
+                    std::vector<Vector3d>* decimated_points) {
+  typedef std::pair<std::array<int64_t, 3>, int> VoxelAndIndex;
+  std::vector<VoxelAndIndex> voxels(indices.size());
+  ParallelFor(num_threads, indices.size(), [&](const int begin, const int end) {
+    for (int i = begin; i < end; i++) {
+      voxels[i].second = indices[i];
+      for (int j = 0; j < 3; j++) {
+        voxels[i].first[j] = static_cast<int64_t>(
+            std::floor(points[indices[i]][j] / voxel_size));
+      }
+    }
+  });
+  std::sort(voxels.begin(), voxels.end());
+
+  decimated_points->clear();
+  for (int begin = 0; begin < voxels.size();) {
+    int end = begin + 1;
+    while (end < voxels.size() && voxels[end].first == voxels[begin].first) {
+      ++end;
+    }
+    Vector3d point_sum = Vector3d::Zero();
+    for (int i = begin; i < end; i++) {
+      point_sum += points[voxels[i].second];
+    }
+    decimated_points->emplace_back(point_sum / (end - begin));
+    begin = end;
+  }
+}
+
+// Finds the points among the candidates that are closer to the plane than the
+// threshold, in the order of the candidates.
+void FindInliers(const std::vector<Vector3d>& points,
+                 const std::vector<int>& candidates,
+                 const Plane& plane,
+                 const double threshold,
+                 const int num_threads,
+                 std::vector<int>* inliers) {
+  const double offset = plane.unit_normal.dot(plane.point);
+  std::vector<char> is_inlier(candidates.size());
+  ParallelFor(
+      num_threads, candidates.size(), [&](const int begin, const int end) {
+        for (int i = begin; i < end; i++) {
+          is_inlier[i] =
+              std::abs(plane.unit_normal.dot(points[candidates[i]]) - offset) <
+              threshold;
+        }
+      });
+  inliers->clear();
+  for (int i = 0; i < candidates.size(); i++) {
+    if (is_inlier[i]) {
+      inliers->emplace_back(candidates[i]);
+    }
+  }
+}
+
 }  // namespace
 
 bool EstimateDominantPlaneFromPoints(const RansacParameters& ransac_params,
@@ -104,4 +218,105 @@ bool EstimateDominantPlaneFromPoints(const RansacParameters& ransac_params,
   return ransac->Estimate(points, plane, ransac_summary);
 }
 
+bool EstimateDominantPlanesFromPoints(
+    const RansacParameters& ransac_params,
+    const RansacType& ransac_type,
+    const DominantPlanesOptions& options,
+    const std::vector<Vector3d>& points,
+    std::vector<Plane>* planes,
+    std::vector<std::vector<int> >* inliers) {
+  CHECK_NOTNULL(planes)->clear();
+  CHECK_NOTNULL(inliers)->clear();
+  CHECK_GT(options.max_num_planes, 0);
+
+  DominantPlaneEstimator dominant_plane_estimator;
+  // The points that are not inliers of the planes found so far, in order.
+  std::vector<int> remaining_points(points.size());
+  std::iota(remaining_points.begin(), remaining_points.end(), 0);
+  std::vector<Vector3d> ransac_points;
+  while (planes->size() < options.max_num_planes) {
+    if (options.voxel_size > 0.0) {
+      DecimatePoints(points,
+                     remaining_points,
+                     options.voxel_size,
+                     options.num_threads,
+                     &ransac_points);
+    } else {
+      ransac_points.resize(remaining_points.size());
+      for (int i = 0; i < remaining_points.size(); i++) {
+        ransac_points[i] = points[remaining_points[i]];
+      }
+    }
+    if (ransac_points.size() < dominant_plane_estimator.SampleSize()) {
+      break;
+    }
+
+    // A plane needs at least min_num_inliers of the remaining points, which
+    // bounds the number of iterations. Otherwise the search for a plane among
+    // the remaining outliers would run for the maximum number of iterations.
+    RansacParameters plane_ransac_params = ransac_params;
+    plane_ransac_params.min_inlier_ratio =
+        std::max(ransac_params.min_inlier_ratio,
+                 std::min(1.0,
+                          static_cast<double>(options.min_num_inliers) /
+                              remaining_points.size()));
+    std::unique_ptr<SampleConsensusEstimator<DominantPlaneEstimator> > ransac =
+        CreateAndInitializeRansacVariant(
+            ransac_type, plane_ransac_params, dominant_plane_estimator);
+    Plane plane;
+    RansacSummary ransac_summary;
+    if (!ransac->Estimate(ransac_points, &plane, &ransac_summary)) {
+      break;
+    }
+
+    // LMed chooses its own inlier threshold.
+    double threshold = ransac_params.error_thresh;
+    if (ransac_type == RansacType::LMED) {
+      threshold = 0.0;
+      for (const int i : ransac_summary.inliers) {
+        threshold = std::max(
+            threshold, dominant_plane_estimator.Error(ransac_points[i], plane));
+      }
+      threshold = std::nextafter(threshold,
+                                 std::numeric_limits<double>::infinity());
+    }
+
+    // Refit the plane to its inliers among all remaining points.
+    std::vector<int> plane_inliers;
+    FindInliers(points,
+                remaining_points,
+                plane,
+                threshold,
+                options.num_threads,
+                &plane_inliers);
+    if (plane_inliers.size() >= dominant_plane_estimator.SampleSize()) {
+      const Plane refit_plane = FitPlane(points, plane_inliers);
+      const double sign =
+          refit_plane.unit_normal.dot(plane.unit_normal) < 0.0 ? -1.0 : 1.0;
+      plane.point = refit_plane.point;
+      plane.unit_normal = sign * refit_plane.unit_normal;
+      FindInliers(points,
+                  remaining_points,
+                  plane,
+                  threshold,
+                  options.num_threads,
+                  &plane_inliers);
+    }
+    if (plane_inliers.size() < options.min_num_inliers) {
+      break;
+    }
+
+    std::vector<int> outliers;
+    std::set_difference(remaining_points.begin(),
+                        remaining_points.end(),
+                        plane_inliers.begin(),
+                        plane_inliers.end(),
+                        std::back_inserter(outliers));
+    remaining_points.swap(outliers);
+    planes->emplace_back(plane);
+    inliers->emplace_back(std::move(plane_inliers));
+  }
+  return !planes->empty();
+}
+
 }  // namespace theia
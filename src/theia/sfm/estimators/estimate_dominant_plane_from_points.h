@@ -60,6 +60,42 @@ bool EstimateDominantPlaneFromPoints(const RansacParameters& ransac_params,
                                      Plane* plane,
                                      RansacSummary* ransac_summary);
 
+struct DominantPlanesOptions {
+  // If positive, the RANSAC hypotheses are scored against the points
+  // decimated to the mean point of each occupied voxel of this size, which
+  // bounds the cost of scoring for dense point clouds. Each plane is refit to
+  // all of its inliers among the input points afterwards.
+  double voxel_size = 0.0;
+
+  // The number of threads used to decimate the points and to find the inliers
+  // of the refit planes. The hypotheses are generated and scored in parallel
+  // with RansacParameters::num_threads.
+  int num_threads = 1;
+
+  // The maximum number of planes. Each plane is estimated from the points that
+  // are not inliers of the previous planes.
+  int max_num_planes = 1;
+
+  // Planes with fewer inliers than this are discarded and end the search. The
+  // corresponding inlier ratio bounds the number of RANSAC iterations of each
+  // plane (see RansacParameters::min_inlier_ratio).
+  int min_num_inliers = 3;
+};
+
+// Estimates up to options.max_num_planes planes from a set of 3D points in the
+// order of decreasing support. The planes are refit to their inliers with
+// least squares. The inliers of the i-th plane are returned as indices of the
+// points in inliers[i], which are disjoint. The inlier threshold is
+// ransac_params.error_thresh, or the largest distance of the inliers found
+// by LMed. Returns false if no plane was found.
+bool EstimateDominantPlanesFromPoints(
+    const RansacParameters& ransac_params,
+    const RansacType& ransac_type,
+    const DominantPlanesOptions& options,
+    const std::vector<Eigen::Vector3d>& points,
+    std::vector<Plane>* planes,
+    std::vector<std::vector<int> >* inliers);
+
 }  // namespace theia
 
 #endif  // THEIA_SFM_ESTIMATORS_ESTIMATE_DOMINANT_PLANE_FROM_POINTS_H_
@@ -180,5 +180,82 @@ TEST(EstimateDominantPlane, OutliersWithNoise) {
   ExecuteRandomTest(options, kInlierRatio, kNoise);
 }
 
+// Points on the planes z = 0 and x = 5 and random outliers.
+void GeneratePointsOnTwoPlanes(std::vector<Vector3d>* points) {
+  static const int kNumPointsOnFirstPlane = 20000;
+  static const int kNumPointsOnSecondPlane = 10000;
+  static const int kNumOutliers = 5000;
+  static const double kNoise = 0.01;
+  for (int i = 0; i < kNumPointsOnFirstPlane; i++) {
+    points->emplace_back(rng.RandDouble(-10.0, 10.0),
+                         rng.RandDouble(-10.0, 10.0),
+                         rng.RandGaussian(0.0, kNoise));
+  }
+  for (int i = 0; i < kNumPointsOnSecondPlane; i++) {
+    points->emplace_back(5.0 + rng.RandGaussian(0.0, kNoise),
+                         rng.RandDouble(-10.0, 10.0),
+                         rng.RandDouble(-10.0, 10.0));
+  }
+  for (int i = 0; i < kNumOutliers; i++) {
+    points->emplace_back(rng.RandDouble(-10.0, 10.0),
+                         rng.RandDouble(-10.0, 10.0),
+                         rng.RandDouble(-10.0, 10.0));
+  }
+}
+
+void ExecuteTwoPlanesTest(const RansacType ransac_type,
+                          const double voxel_size,
+                          const int max_num_planes) {
+  std::vector<Vector3d> points;
+  GeneratePointsOnTwoPlanes(&points);
+
+  RansacParameters ransac_params;
+  ransac_params.rng = std::make_shared<RandomNumberGenerator>(rng);
+  ransac_params.error_thresh = 0.05;
+  ransac_params.num_threads = 4;
+  DominantPlanesOptions options;
+  options.voxel_size = voxel_size;
+  options.num_threads = 4;
+  options.max_num_planes = max_num_planes;
+  options.min_num_inliers = 2000;
+
+  std::vector<Plane> planes;
+  std::vector<std::vector<int> > inliers;
+  EXPECT_TRUE(EstimateDominantPlanesFromPoints(
+      ransac_params, ransac_type, options, points, &planes, &inliers));
+
+  // Only the two planes have enough inliers, and they are found in the order
+  // of their support.
+  ASSERT_EQ(planes.size(), 2);
+  ASSERT_EQ(inliers.size(), 2);
+  EXPECT_GT(std::abs(planes[0].unit_normal.z()), 1.0 - 1e-4);
+  EXPECT_NEAR(planes[0].point.z(), 0.0, 1e-3);
+  EXPECT_GT(std::abs(planes[1].unit_normal.x()), 1.0 - 1e-4);
+  EXPECT_NEAR(planes[1].point.x(), 5.0, 1e-3);
+  EXPECT_NEAR(inliers[0].size(), 20000, 300);
+  EXPECT_NEAR(inliers[1].size(), 10000, 300);
+
+  // The inliers of the planes are disjoint.
+  std::vector<int> all_inliers = inliers[0];
+  all_inliers.insert(all_inliers.end(), inliers[1].begin(), inliers[1].end());
+  std::sort(all_inliers.begin(), all_inliers.end());
+  EXPECT_TRUE(std::adjacent_find(all_inliers.begin(), all_inliers.end()) ==
+              all_inliers.end());
+}
+
+TEST(EstimateDominantPlanes, TwoPlanes) {
+  ExecuteTwoPlanesTest(RansacType::RANSAC, 0.0, 3);
+}
+
+TEST(EstimateDominantPlanes, TwoPlanesWithVoxelSubsampling) {
+  ExecuteTwoPlanesTest(RansacType::RANSAC, 0.5, 3);
+}
+
+// LMed finds a plane in any point set since it chooses its own threshold, so
+// only two planes are requested.
+TEST(EstimateDominantPlanes, TwoPlanesLMed) {
+  ExecuteTwoPlanesTest(RansacType::LMED, 0.0, 2);
+}
+
 }  // namespace
 }  // namespace theia
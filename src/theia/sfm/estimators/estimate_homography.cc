@@ -41,6 +41,7 @@
 #include <vector>
 
 #include "theia/matching/feature_correspondence.h"
+#include "theia/matching/feature_correspondence_arrays.h"
 #include "theia/sfm/create_and_initialize_ransac_variant.h"
 #include "theia/sfm/pose/four_point_homography.h"
 #include "theia/sfm/pose/util.h"
@@ -54,6 +55,27 @@ namespace {
 using Eigen::Matrix3d;
 using Eigen::Vector3d;
 
+// Computes the asymmetric reprojection error of all correspondences given a
+// homography. Correspondences are either FeatureCorrespondenceArrays or a
+// FeatureCorrespondenceView.
+template <class Correspondences>
+void HomographyResiduals(const Correspondences& correspondences,
+                         const Matrix3d& homography,
+                         std::vector<double>* residuals) {
+  const int num_correspondences = correspondences.size();
+  residuals->resize(num_correspondences);
+  for (int i = 0; i < num_correspondences; i++) {
+    const Vector3d reprojected_point =
+        homography *
+        Vector3d(correspondences.x1[i], correspondences.y1[i], 1.0);
+    const double dx =
+        correspondences.x2[i] - reprojected_point.x() / reprojected_point.z();
+    const double dy =
+        correspondences.y2[i] - reprojected_point.y() / reprojected_point.z();
+    (*residuals)[i] = dx * dx + dy * dy;
+  }
+}
+
 // An estimator for computing a homography from 4 feature correspondences. The
 // feature correspondences should be normalized by the focal length with the
 // principal point at (0, 0).
@@ -65,10 +87,11 @@ class HomographyEstimator
   // 4 correspondences are needed to determine a homography.
   double SampleSize() const { return 4; }
 
-  // Estimates candidate relative poses from correspondences.
+  // Estimates candidate homographies from correspondences with the
+  // allocation-free four point solver.
   bool EstimateModel(const std::vector<FeatureCorrespondence>& correspondences,
                      std::vector<Eigen::Matrix3d>* homography) const {
-    std::vector<Eigen::Vector2d> image1_points(4), image2_points(4);
+    Eigen::Vector2d image1_points[4], image2_points[4];
     for (int i = 0; i < 4; i++) {
       image1_points[i] = correspondences[i].feature1.point_;
       image2_points[i] = correspondences[i].feature2.point_;
@@ -94,7 +117,31 @@ class HomographyEstimator
         .squaredNorm();
   }
 
+  // Computes the same errors as Error for all correspondences at once. If the
+  // correspondences are the ones passed to SetCorrespondences they are read
+  // from the structure-of-arrays copy, otherwise they are read in place.
+  void Residuals(const std::vector<FeatureCorrespondence>& correspondences,
+                 const Eigen::Matrix3d& homography,
+                 std::vector<double>* residuals) const {
+    if (&correspondences == correspondences_) {
+      HomographyResiduals(correspondence_arrays_, homography, residuals);
+    } else {
+      HomographyResiduals(
+          FeatureCorrespondenceView(correspondences), homography, residuals);
+    }
+  }
+
+  // Copies the correspondences that will be passed to Residuals into
+  // structure-of-arrays form. The correspondences must outlive the estimation.
+  void SetCorrespondences(
+      const std::vector<FeatureCorrespondence>& correspondences) {
+    correspondences_ = &correspondences;
+    correspondence_arrays_.Assign(correspondences);
+  }
+
  private:
+  const std::vector<FeatureCorrespondence>* correspondences_ = nullptr;
+  FeatureCorrespondenceArrays correspondence_arrays_;
   DISALLOW_COPY_AND_ASSIGN(HomographyEstimator);
 };
 
@@ -107,6 +154,7 @@ bool EstimateHomography(
     Eigen::Matrix3d* homography,
     RansacSummary* ransac_summary) {
   HomographyEstimator homography_estimator;
+  homography_estimator.SetCorrespondences(correspondences);
   std::unique_ptr<SampleConsensusEstimator<HomographyEstimator> > ransac =
       CreateAndInitializeRansacVariant(
           ransac_type, ransac_params, homography_estimator);
@@ -41,6 +41,7 @@
 #include <vector>
 
 #include "theia/matching/feature_correspondence.h"
+#include "theia/matching/feature_correspondence_arrays.h"
 #include "theia/sfm/create_and_initialize_ransac_variant.h"
 #include "theia/sfm/pose/essential_matrix_utils.h"
 #include "theia/sfm/pose/five_point_relative_pose.h"
@@ -48,6 +49,7 @@
 #include "theia/sfm/triangulation/triangulation.h"
 #include "theia/solvers/estimator.h"
 #include "theia/solvers/sample_consensus_estimator.h"
+#include "theia/util/fixed_capacity_vector.h"
 #include "theia/util/util.h"
 #include "theia/sfm/bundle_adjustment/bundle_adjust_two_views.h"
 #include "theia/sfm/twoview_info.h"
@@ -58,6 +60,48 @@ namespace {
 using Eigen::Matrix3d;
 using Eigen::Vector3d;
 
+// Computes the squared Sampson error of all correspondences given a relative
+// pose, or the max double value for correspondences that do not triangulate in
+// front of both cameras. Correspondences are either FeatureCorrespondenceArrays
+// or a FeatureCorrespondenceView. The model dependent terms of the cheirality
+// test and the Sampson distance are computed once.
+template <class Correspondences>
+void RelativePoseResiduals(const Correspondences& correspondences,
+                           const RelativePose& relative_pose,
+                           std::vector<double>* residuals) {
+  const int num_correspondences = correspondences.size();
+  residuals->resize(num_correspondences);
+  const Matrix3d& essential_matrix = relative_pose.essential_matrix;
+  const Matrix3d rotation_transpose = relative_pose.rotation.transpose();
+  const Vector3d& position = relative_pose.position;
+  for (int i = 0; i < num_correspondences; i++) {
+    const Vector3d point1(correspondences.x1[i], correspondences.y1[i], 1.0);
+    const Vector3d point2(correspondences.x2[i], correspondences.y2[i], 1.0);
+
+    // Check that the triangulated point is in front of both cameras (see
+    // IsTriangulatedPointInFrontOfCameras).
+    const Vector3d dir2 = rotation_transpose * point2;
+    const double dir1_sq = point1.squaredNorm();
+    const double dir2_sq = dir2.squaredNorm();
+    const double dir1_dir2 = point1.dot(dir2);
+    const double dir1_pos = point1.dot(position);
+    const double dir2_pos = dir2.dot(position);
+    if (dir2_sq * dir1_pos - dir1_dir2 * dir2_pos <= 0 ||
+        dir1_dir2 * dir1_pos - dir1_sq * dir2_pos <= 0) {
+      (*residuals)[i] = std::numeric_limits<double>::max();
+      continue;
+    }
+
+    // The squared Sampson distance (see SquaredSampsonDistance).
+    const Vector3d epiline1 = essential_matrix * point1;
+    const Vector3d epiline2 = essential_matrix.transpose() * point2;
+    const double numerator_sqrt = point2.dot(epiline1);
+    (*residuals)[i] = numerator_sqrt * numerator_sqrt /
+                      (epiline2.head<2>().squaredNorm() +
+                       epiline1.head<2>().squaredNorm());
+  }
+}
+
 // An estimator for computing the relative pose from 5 feature
 // correspondences. The feature correspondences should be normalized
 // by the focal length with the principal point at (0, 0).
@@ -72,21 +116,37 @@ class RelativePoseEstimator
   // relative pose..
   double SampleSize() const { return 5; }
 
-  // Estimates candidate relative poses from correspondences.
+  // Estimates candidate relative poses from correspondences. Minimal samples
+  // use the allocation-free five point solver.
   bool EstimateModel(const std::vector<FeatureCorrespondence>& correspondences,
                      std::vector<RelativePose>* relative_poses) const {
-    std::vector<Eigen::Vector2d> image1_points, image2_points;
-    image1_points.reserve(correspondences.size());
-    image2_points.reserve(correspondences.size());
-    for (int i = 0; i < correspondences.size(); i++) {
-      image1_points.emplace_back(correspondences[i].feature1.point_);
-      image2_points.emplace_back(correspondences[i].feature2.point_);
-    }
-
-    std::vector<Matrix3d> essential_matrices;
-    if (!FivePointRelativePose(
-            image1_points, image2_points, &essential_matrices)) {
-      return false;
+    FixedCapacityVector<Matrix3d, 10> essential_matrices;
+    if (correspondences.size() == 5) {
+      Eigen::Vector2d image1_points[5], image2_points[5];
+      for (int i = 0; i < 5; i++) {
+        image1_points[i] = correspondences[i].feature1.point_;
+        image2_points[i] = correspondences[i].feature2.point_;
+      }
+      if (!FivePointRelativePose(
+              image1_points, image2_points, &essential_matrices)) {
+        return false;
+      }
+    } else {
+      std::vector<Eigen::Vector2d> image1_points, image2_points;
+      image1_points.reserve(correspondences.size());
+      image2_points.reserve(correspondences.size());
+      for (int i = 0; i < correspondences.size(); i++) {
+        image1_points.emplace_back(correspondences[i].feature1.point_);
+        image2_points.emplace_back(correspondences[i].feature2.point_);
+      }
+      std::vector<Matrix3d> essential_matrix_vector;
+      if (!FivePointRelativePose(
+              image1_points, image2_points, &essential_matrix_vector)) {
+        return false;
+      }
+      for (const Matrix3d& essential_matrix : essential_matrix_vector) {
+        essential_matrices.push_back(essential_matrix);
+      }
     }
 
     relative_poses->reserve(essential_matrices.size() * 4);
@@ -139,8 +199,33 @@ class RelativePoseEstimator
     return std::numeric_limits<double>::max();
   }
 
+  // Computes the same errors as Error for all correspondences at once. If the
+  // correspondences are the ones passed to SetCorrespondences they are read
+  // from the structure-of-arrays copy, otherwise they are read in place.
+  void Residuals(const std::vector<FeatureCorrespondence>& correspondences,
+                 const RelativePose& relative_pose,
+                 std::vector<double>* residuals) const {
+    if (&correspondences == correspondences_) {
+      RelativePoseResiduals(correspondence_arrays_, relative_pose, residuals);
+    } else {
+      RelativePoseResiduals(FeatureCorrespondenceView(correspondences),
+                            relative_pose,
+                            residuals);
+    }
+  }
+
+  // Copies the correspondences that will be passed to Residuals into
+  // structure-of-arrays form. The correspondences must outlive the estimation.
+  void SetCorrespondences(
+      const std::vector<FeatureCorrespondence>& correspondences) {
+    correspondences_ = &correspondences;
+    correspondence_arrays_.Assign(correspondences);
+  }
+
  private:
   theia::BundleAdjustmentOptions ba_opts_;
+  const std::vector<FeatureCorrespondence>* correspondences_ = nullptr;
+  FeatureCorrespondenceArrays correspondence_arrays_;
   DISALLOW_COPY_AND_ASSIGN(RelativePoseEstimator);
 };
 
@@ -153,6 +238,7 @@ bool EstimateRelativePose(
     RelativePose* relative_pose,
     RansacSummary* ransac_summary) {
   RelativePoseEstimator relative_pose_estimator;
+  relative_pose_estimator.SetCorrespondences(normalized_correspondences);
   std::unique_ptr<SampleConsensusEstimator<RelativePoseEstimator> > ransac =
       CreateAndInitializeRansacVariant(
           ransac_type, ransac_params, relative_pose_estimator);
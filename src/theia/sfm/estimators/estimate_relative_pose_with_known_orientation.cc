@@ -28,7 +28,8 @@ class RelativePoseWithKnownOrientationEstimator
   RelativePoseWithKnownOrientationEstimator() {}
 
   // 2 correspondences are needed to determine the relative position.
-  double SampleSize() const { return 2; }
+  static constexpr int kSampleSize = 2;
+  double SampleSize() const { return kSampleSize; }
 
   // Estimates candidate relative poses from correspondences.
   bool EstimateModel(const std::vector<FeatureCorrespondence>& correspondences,
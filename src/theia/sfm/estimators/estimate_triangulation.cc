@@ -71,7 +71,8 @@ class TriangulationEstimator
  public:
   TriangulationEstimator() {}
 
-  double SampleSize() const { return 2; }
+  static constexpr int kSampleSize = 2;
+  double SampleSize() const { return kSampleSize; }
 
   // Triangulates the 3D point from 2 observations.
   bool EstimateModel(const std::vector<PointObservation>& observations,
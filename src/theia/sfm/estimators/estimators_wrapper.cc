@@ -1,5 +1,6 @@
 #include "theia/sfm/estimators/estimators_wrapper.h"
 
+#include "theia/sfm/estimators/batch_estimators.h"
 #include "theia/sfm/estimators/camera_and_feature_correspondence_2d_3d.h"
 #include "theia/sfm/estimators/estimate_absolute_pose_with_known_orientation.h"
 #include "theia/sfm/estimators/estimate_calibrated_absolute_pose.h"
@@ -55,6 +56,24 @@ EstimateCalibratedAbsolutePoseWrapper(
   return std::make_tuple(success, absolute_pose, ransac_summary);
 }
 
+std::tuple<bool, CalibratedAbsolutePose, RansacSummary>
+EstimateCalibratedAbsolutePoseWithKnownGravityWrapper(
+    const RansacParameters& ransac_params,
+    const RansacType& ransac_type,
+    const Eigen::Vector3d& gravity,
+    const std::vector<FeatureCorrespondence2D3D>& normalized_correspondences) {
+  CalibratedAbsolutePose absolute_pose;
+  RansacSummary ransac_summary;
+  const bool success =
+      EstimateCalibratedAbsolutePoseWithKnownGravity(ransac_params,
+                                                     ransac_type,
+                                                     gravity,
+                                                     normalized_correspondences,
+                                                     &absolute_pose,
+                                                     &ransac_summary);
+  return std::make_tuple(success, absolute_pose, ransac_summary);
+}
+
 std::tuple<bool, Plane, RansacSummary> EstimateDominantPlaneFromPointsWrapper(
     const RansacParameters& ransac_params,
     const RansacType& ransac_type,
@@ -66,6 +85,19 @@ std::tuple<bool, Plane, RansacSummary> EstimateDominantPlaneFromPointsWrapper(
   return std::make_tuple(success, plane, ransac_summary);
 }
 
+std::tuple<bool, std::vector<Plane>, std::vector<std::vector<int> > >
+EstimateDominantPlanesFromPointsWrapper(
+    const RansacParameters& ransac_params,
+    const RansacType& ransac_type,
+    const DominantPlanesOptions& options,
+    const std::vector<Eigen::Vector3d>& points) {
+  std::vector<Plane> planes;
+  std::vector<std::vector<int> > inliers;
+  const bool success = EstimateDominantPlanesFromPoints(
+      ransac_params, ransac_type, options, points, &planes, &inliers);
+  return std::make_tuple(success, planes, inliers);
+}
+
 std::tuple<bool, Eigen::Matrix3d, RansacSummary> EstimateEssentialMatrixWrapper(
     const RansacParameters& ransac_params,
     const RansacType& ransac_type,
@@ -251,4 +283,90 @@ EstimateUncalibratedRelativePoseWrapper(
   return std::make_tuple(success, relative_pose, ransac_summary);
 }
 
+std::tuple<bool, BatchEstimationResult> EstimateCalibratedAbsolutePosesWrapper(
+    const RansacParameters& ransac_params,
+    const RansacType& ransac_type,
+    const PnPType& pnp_type,
+    const Eigen::Ref<const Correspondence2D3DMatrix>&
+        normalized_correspondences,
+    const Eigen::VectorXi& offsets,
+    const int num_threads) {
+  BatchEstimationResult result;
+  const bool success =
+      EstimateCalibratedAbsolutePoses(ransac_params,
+                                      ransac_type,
+                                      pnp_type,
+                                      normalized_correspondences,
+                                      offsets,
+                                      num_threads,
+                                      &result);
+  return std::make_tuple(success, result);
+}
+
+std::tuple<bool, BatchEstimationResult> EstimateEssentialMatricesWrapper(
+    const RansacParameters& ransac_params,
+    const RansacType& ransac_type,
+    const Eigen::Ref<const TwoViewCorrespondenceMatrix>&
+        normalized_correspondences,
+    const Eigen::VectorXi& offsets,
+    const int num_threads) {
+  BatchEstimationResult result;
+  const bool success = EstimateEssentialMatrices(ransac_params,
+                                                 ransac_type,
+                                                 normalized_correspondences,
+                                                 offsets,
+                                                 num_threads,
+                                                 &result);
+  return std::make_tuple(success, result);
+}
+
+std::tuple<bool, BatchEstimationResult> EstimateFundamentalMatricesWrapper(
+    const RansacParameters& ransac_params,
+    const RansacType& ransac_type,
+    const Eigen::Ref<const TwoViewCorrespondenceMatrix>& correspondences,
+    const Eigen::VectorXi& offsets,
+    const int num_threads) {
+  BatchEstimationResult result;
+  const bool success = EstimateFundamentalMatrices(ransac_params,
+                                                   ransac_type,
+                                                   correspondences,
+                                                   offsets,
+                                                   num_threads,
+                                                   &result);
+  return std::make_tuple(success, result);
+}
+
+std::tuple<bool, BatchEstimationResult> EstimateHomographiesWrapper(
+    const RansacParameters& ransac_params,
+    const RansacType& ransac_type,
+    const Eigen::Ref<const TwoViewCorrespondenceMatrix>& correspondences,
+    const Eigen::VectorXi& offsets,
+    const int num_threads) {
+  BatchEstimationResult result;
+  const bool success = EstimateHomographies(ransac_params,
+                                            ransac_type,
+                                            correspondences,
+                                            offsets,
+                                            num_threads,
+                                            &result);
+  return std::make_tuple(success, result);
+}
+
+std::tuple<bool, BatchEstimationResult> EstimateRelativePosesWrapper(
+    const RansacParameters& ransac_params,
+    const RansacType& ransac_type,
+    const Eigen::Ref<const TwoViewCorrespondenceMatrix>&
+        normalized_correspondences,
+    const Eigen::VectorXi& offsets,
+    const int num_threads) {
+  BatchEstimationResult result;
+  const bool success = EstimateRelativePoses(ransac_params,
+                                             ransac_type,
+                                             normalized_correspondences,
+                                             offsets,
+                                             num_threads,
+                                             &result);
+  return std::make_tuple(success, result);
+}
+
 }  // namespace theia
@@ -9,6 +9,7 @@
 #include "theia/sfm/pose/six_point_radial_distortion_homography.h"
 #include "theia/sfm/types.h"
 
+#include "theia/sfm/estimators/batch_estimators.h"
 #include "theia/sfm/estimators/estimate_calibrated_absolute_pose.h"
 #include "theia/sfm/estimators/estimate_dominant_plane_from_points.h"
 #include "theia/sfm/estimators/estimate_radial_distortion_homography.h"
@@ -39,11 +40,25 @@ EstimateCalibratedAbsolutePoseWrapper(
     const PnPType& pnp_type,
     const std::vector<FeatureCorrespondence2D3D>& normalized_correspondences);
 
+std::tuple<bool, CalibratedAbsolutePose, RansacSummary>
+EstimateCalibratedAbsolutePoseWithKnownGravityWrapper(
+    const RansacParameters& ransac_params,
+    const RansacType& ransac_type,
+    const Eigen::Vector3d& gravity,
+    const std::vector<FeatureCorrespondence2D3D>& normalized_correspondences);
+
 std::tuple<bool, Plane, RansacSummary> EstimateDominantPlaneFromPointsWrapper(
     const RansacParameters& ransac_params,
     const RansacType& ransac_type,
     const std::vector<Eigen::Vector3d>& points);
 
+std::tuple<bool, std::vector<Plane>, std::vector<std::vector<int> > >
+EstimateDominantPlanesFromPointsWrapper(
+    const RansacParameters& ransac_params,
+    const RansacType& ransac_type,
+    const DominantPlanesOptions& options,
+    const std::vector<Eigen::Vector3d>& points);
+
 std::tuple<bool, Eigen::Matrix3d, RansacSummary> EstimateEssentialMatrixWrapper(
     const RansacParameters& ransac_params,
     const RansacType& ransac_type,
@@ -114,4 +129,44 @@ EstimateUncalibratedRelativePoseWrapper(
     const std::vector<FeatureCorrespondence>& centered_correspondences,
     const Eigen::Vector2d& min_max_focal_length);
 
+// Batch variants of the estimators above. See batch_estimators.h.
+std::tuple<bool, BatchEstimationResult> EstimateCalibratedAbsolutePosesWrapper(
+    const RansacParameters& ransac_params,
+    const RansacType& ransac_type,
+    const PnPType& pnp_type,
+    const Eigen::Ref<const Correspondence2D3DMatrix>&
+        normalized_correspondences,
+    const Eigen::VectorXi& offsets,
+    const int num_threads);
+
+std::tuple<bool, BatchEstimationResult> EstimateEssentialMatricesWrapper(
+    const RansacParameters& ransac_params,
+    const RansacType& ransac_type,
+    const Eigen::Ref<const TwoViewCorrespondenceMatrix>&
+        normalized_correspondences,
+    const Eigen::VectorXi& offsets,
+    const int num_threads);
+
+std::tuple<bool, BatchEstimationResult> EstimateFundamentalMatricesWrapper(
+    const RansacParameters& ransac_params,
+    const RansacType& ransac_type,
+    const Eigen::Ref<const TwoViewCorrespondenceMatrix>& correspondences,
+    const Eigen::VectorXi& offsets,
+    const int num_threads);
+
+std::tuple<bool, BatchEstimationResult> EstimateHomographiesWrapper(
+    const RansacParameters& ransac_params,
+    const RansacType& ransac_type,
+    const Eigen::Ref<const TwoViewCorrespondenceMatrix>& correspondences,
+    const Eigen::VectorXi& offsets,
+    const int num_threads);
+
+std::tuple<bool, BatchEstimationResult> EstimateRelativePosesWrapper(
+    const RansacParameters& ransac_params,
+    const RansacType& ransac_type,
+    const Eigen::Ref<const TwoViewCorrespondenceMatrix>&
+        normalized_correspondences,
+    const Eigen::VectorXi& offsets,
+    const int num_threads);
+
 }  // namespace theia
@@ -36,6 +36,7 @@
 #define THEIA_SFM_ESTIMATORS_FEATURE_CORRESPONDENCE_2D_3D_H_
 
 #include <Eigen/Core>
+#include <vector>
 
 namespace theia {
 
@@ -48,6 +49,42 @@ struct FeatureCorrespondence2D3D {
   Eigen::Vector3d world_point;
 };
 
+// A structure-of-arrays copy of 2D-3D correspondences: correspondence i is the
+// feature (feature_x[i], feature_y[i]) of the world point (point_x[i],
+// point_y[i], point_z[i]). Estimators may use this to evaluate a model on all
+// correspondences with contiguous, aligned loads.
+struct FeatureCorrespondence2D3DArrays {
+  typedef std::vector<double, Eigen::aligned_allocator<double> > Array;
+
+  FeatureCorrespondence2D3DArrays() {}
+  explicit FeatureCorrespondence2D3DArrays(
+      const std::vector<FeatureCorrespondence2D3D>& correspondences) {
+    Assign(correspondences);
+  }
+
+  // Replaces the contents with the given correspondences.
+  void Assign(const std::vector<FeatureCorrespondence2D3D>& correspondences) {
+    const int num_correspondences = correspondences.size();
+    feature_x.resize(num_correspondences);
+    feature_y.resize(num_correspondences);
+    point_x.resize(num_correspondences);
+    point_y.resize(num_correspondences);
+    point_z.resize(num_correspondences);
+    for (int i = 0; i < num_correspondences; i++) {
+      feature_x[i] = correspondences[i].feature.x();
+      feature_y[i] = correspondences[i].feature.y();
+      point_x[i] = correspondences[i].world_point.x();
+      point_y[i] = correspondences[i].world_point.y();
+      point_z[i] = correspondences[i].world_point.z();
+    }
+  }
+
+  int size() const { return static_cast<int>(feature_x.size()); }
+
+  Array feature_x, feature_y;
+  Array point_x, point_y, point_z;
+};
+
 }  // namespace theia
 
 #endif  // THEIA_SFM_ESTIMATORS_FEATURE_CORRESPONDENCE_2D_3D_H_
@@ -0,0 +1,248 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+
+#include "theia/sfm/evaluate_relative_poses.h"
+
+#include <Eigen/Core>
+#include <ceres/rotation.h>
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "theia/matching/features_and_matches_database.h"
+#include "theia/matching/image_pair_match.h"
+#include "theia/math/histogram.h"
+#include "theia/math/util.h"
+#include "theia/sfm/reconstruction.h"
+#include "theia/sfm/twoview_info.h"
+#include "theia/sfm/types.h"
+#include "theia/sfm/view.h"
+#include "theia/sfm/view_graph/view_graph.h"
+#include "theia/util/executor.h"
+#include "theia/util/stringprintf.h"
+
+namespace theia {
+
+namespace {
+
+// The histograms of the view pairs of a block of a batch.
+struct BlockHistograms {
+  Histogram<double> rotation;
+  Histogram<double> translation;
+};
+
+// Returns the message of PoseError for the errors.
+std::string PrintErrors(const std::string& name,
+                        const std::vector<double>& errors,
+                        const Histogram<double>& histogram) {
+  std::vector<double> sorted_errors = errors;
+  const auto median = sorted_errors.begin() + sorted_errors.size() / 2;
+  std::nth_element(sorted_errors.begin(), median, sorted_errors.end());
+  const double mean =
+      std::accumulate(errors.begin(), errors.end(), 0.0) / errors.size();
+  return StringPrintf("%s Error:\nMean = %lf \nMedian = %lf\nHistogram:\n%s",
+                      name.c_str(),
+                      mean,
+                      *median,
+                      histogram.PrintString().c_str());
+}
+
+}  // namespace
+
+double RelativeRotationError(const Eigen::Matrix3d& rotation1,
+                             const Eigen::Matrix3d& rotation2,
+                             const Eigen::Vector3d& relative_rotation) {
+  Eigen::Matrix3d relative_rotation_matrix;
+  ceres::AngleAxisToRotationMatrix(
+      relative_rotation.data(),
+      ceres::ColumnMajorAdapter3x3(relative_rotation_matrix.data()));
+  const Eigen::Matrix3d loop_rotation = relative_rotation_matrix.transpose() *
+                                        (rotation2 * rotation1.transpose());
+  Eigen::Vector3d loop_rotation_aa;
+  ceres::RotationMatrixToAngleAxis(
+      ceres::ColumnMajorAdapter3x3(loop_rotation.data()),
+      loop_rotation_aa.data());
+  return RadToDeg(loop_rotation_aa.norm());
+}
+
+double RelativeTranslationError(const Eigen::Vector3d& position1,
+                                const Eigen::Vector3d& position2,
+                                const Eigen::Matrix3d& rotation1,
+                                const Eigen::Vector3d& relative_translation) {
+  const Eigen::Vector3d world_translation =
+      rotation1 * (position2 - position1).normalized();
+  return RadToDeg(
+      std::acos(Clamp(relative_translation.dot(world_translation), -1.0, 1.0)));
+}
+
+RelativePoseEvaluator::RelativePoseEvaluator(
+    const RelativePoseEvaluatorOptions& options,
+    const Reconstruction& ground_truth)
+    : options_(options),
+      ground_truth_(ground_truth),
+      rotation_histogram_(options.rotation_histogram_bins),
+      translation_histogram_(options.translation_histogram_bins),
+      num_skipped_view_pairs_(0) {
+  CHECK_GT(options_.num_threads, 0);
+  CHECK_GT(options_.batch_size, 0);
+}
+
+int RelativePoseEvaluator::AddRelativePoses(
+    const std::vector<ViewIdPair>& view_pairs,
+    const std::vector<TwoViewInfo>& twoview_infos) {
+  CHECK_EQ(view_pairs.size(), twoview_infos.size());
+  const int num_view_pairs = view_pairs.size();
+
+  // Skipped view pairs keep a NaN error. Each block fills its own histograms so
+  // that the threads do not share any counters.
+  const double kNaN = std::numeric_limits<double>::quiet_NaN();
+  std::vector<double> rotation_errors(num_view_pairs, kNaN);
+  std::vector<double> translation_errors(num_view_pairs, kNaN);
+  const BlockHistograms empty_histograms = {
+      Histogram<double>(options_.rotation_histogram_bins),
+      Histogram<double>(options_.translation_histogram_bins)};
+  const BlockHistograms histograms = ParallelReduce(
+      options_.num_threads,
+      num_view_pairs,
+      empty_histograms,
+      [&](const int start, const int end) {
+        BlockHistograms block_histograms = empty_histograms;
+        for (int i = start; i < end; i++) {
+          const View* view1 = ground_truth_.View(view_pairs[i].first);
+          const View* view2 = ground_truth_.View(view_pairs[i].second);
+          if (view1 == nullptr || view2 == nullptr || !view1->IsEstimated() ||
+              !view2->IsEstimated()) {
+            continue;
+          }
+
+          const Camera& camera1 = view1->Camera();
+          const Camera& camera2 = view2->Camera();
+          const Eigen::Matrix3d rotation1 =
+              camera1.GetOrientationAsRotationMatrix();
+          rotation_errors[i] =
+              RelativeRotationError(rotation1,
+                                    camera2.GetOrientationAsRotationMatrix(),
+                                    twoview_infos[i].rotation_2);
+          translation_errors[i] =
+              RelativeTranslationError(camera1.GetPosition(),
+                                       camera2.GetPosition(),
+                                       rotation1,
+                                       twoview_infos[i].position_2);
+          block_histograms.rotation.Add(rotation_errors[i]);
+          block_histograms.translation.Add(translation_errors[i]);
+        }
+        return block_histograms;
+      },
+      [](BlockHistograms result, const BlockHistograms& block_histograms) {
+        result.rotation.Merge(block_histograms.rotation);
+        result.translation.Merge(block_histograms.translation);
+        return result;
+      });
+  rotation_histogram_.Merge(histograms.rotation);
+  translation_histogram_.Merge(histograms.translation);
+
+  int num_evaluated_view_pairs = 0;
+  for (int i = 0; i < num_view_pairs; i++) {
+    if (std::isnan(rotation_errors[i])) {
+      ++num_skipped_view_pairs_;
+      continue;
+    }
+    evaluated_view_pairs_.emplace_back(view_pairs[i]);
+    rotation_errors_.emplace_back(rotation_errors[i]);
+    translation_errors_.emplace_back(translation_errors[i]);
+    ++num_evaluated_view_pairs;
+  }
+  return num_evaluated_view_pairs;
+}
+
+int RelativePoseEvaluator::AddViewGraph(const ViewGraph& view_graph) {
+  const std::unordered_map<ViewIdPair, TwoViewInfo>& edges =
+      view_graph.GetAllEdges();
+  // Evaluate the edges in a deterministic order.
+  std::vector<ViewIdPair> view_pairs;
+  view_pairs.reserve(edges.size());
+  for (const auto& edge : edges) {
+    view_pairs.emplace_back(edge.first);
+  }
+  std::sort(view_pairs.begin(), view_pairs.end());
+
+  std::vector<TwoViewInfo> twoview_infos;
+  twoview_infos.reserve(view_pairs.size());
+  for (const ViewIdPair& view_pair : view_pairs) {
+    twoview_infos.emplace_back(edges.at(view_pair));
+  }
+  return AddRelativePoses(view_pairs, twoview_infos);
+}
+
+int RelativePoseEvaluator::AddMatches(FeaturesAndMatchesDatabase* database) {
+  CHECK_NOTNULL(database);
+  // Only the two view infos of a batch are held in memory while the matches
+  // are streamed from the database.
+  std::vector<ViewIdPair> view_pairs;
+  std::vector<TwoViewInfo> twoview_infos;
+  int num_evaluated_view_pairs = 0;
+  database->ForEachImagePairMatch([&](const std::string& image_name1,
+                                      const std::string& image_name2,
+                                      const ImagePairMatch& match) {
+    view_pairs.emplace_back(ground_truth_.ViewIdFromName(image_name1),
+                            ground_truth_.ViewIdFromName(image_name2));
+    twoview_infos.emplace_back(match.twoview_info);
+    if (view_pairs.size() == options_.batch_size) {
+      num_evaluated_view_pairs += AddRelativePoses(view_pairs, twoview_infos);
+      view_pairs.clear();
+      twoview_infos.clear();
+    }
+    return true;
+  });
+  num_evaluated_view_pairs += AddRelativePoses(view_pairs, twoview_infos);
+  return num_evaluated_view_pairs;
+}
+
+std::string RelativePoseEvaluator::PrintMeanMedianHistogram() const {
+  if (rotation_errors_.empty()) {
+    return "There were no poses that were common to the model.";
+  }
+  return PrintErrors("Rotation", rotation_errors_, rotation_histogram_) +
+         "\n" +
+         PrintErrors("Position", translation_errors_, translation_histogram_);
+}
+
+}  // namespace theia
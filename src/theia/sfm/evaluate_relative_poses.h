@@ -0,0 +1,153 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+
+#ifndef THEIA_SFM_EVALUATE_RELATIVE_POSES_H_
+#define THEIA_SFM_EVALUATE_RELATIVE_POSES_H_
+
+#include <Eigen/Core>
+#include <string>
+#include <vector>
+
+#include "theia/math/histogram.h"
+#include "theia/sfm/types.h"
+#include "theia/util/util.h"
+
+namespace theia {
+
+class FeaturesAndMatchesDatabase;
+class Reconstruction;
+class TwoViewInfo;
+class ViewGraph;
+
+// Returns the angle in degrees between the relative rotation (as angle-axis)
+// of a two view estimate and the relative rotation of the world-to-camera
+// rotations of the ground truth.
+double RelativeRotationError(const Eigen::Matrix3d& rotation1,
+                             const Eigen::Matrix3d& rotation2,
+                             const Eigen::Vector3d& relative_rotation);
+
+// Returns the angle in degrees between the relative translation direction of a
+// two view estimate and the direction from position1 to position2 in the
+// coordinate system of the first camera.
+double RelativeTranslationError(const Eigen::Vector3d& position1,
+                                const Eigen::Vector3d& position2,
+                                const Eigen::Matrix3d& rotation1,
+                                const Eigen::Vector3d& relative_translation);
+
+struct RelativePoseEvaluatorOptions {
+  // Number of threads used to compute the errors of a batch of view pairs.
+  int num_threads = 1;
+
+  // The matches of a database are read and evaluated this many image pairs at
+  // a time, which bounds the memory used for the two view infos.
+  int batch_size = 4096;
+
+  // The bins of the rotation and translation error histograms in degrees.
+  std::vector<double> rotation_histogram_bins = {
+      2, 5, 10, 15, 25, 50, 90, 135, 180, 225, 270, 316};
+  std::vector<double> translation_histogram_bins = {
+      2, 5, 10, 15, 25, 50, 90, 135, 180, 225, 270, 316};
+};
+
+// Evaluates the relative poses of view pairs (e.g. the two view infos of a
+// view graph or of the matches in a database) against a ground truth
+// reconstruction. The errors of each batch of view pairs are computed in
+// parallel and every thread fills its own histograms, which are merged at the
+// end of the batch, so the evaluation scales to benchmark-sized datasets.
+// Batches may be added repeatedly; the errors and histograms accumulate over
+// all batches, in the order the view pairs were added.
+//
+// View pairs whose views are not estimated in the ground truth are skipped.
+class RelativePoseEvaluator {
+ public:
+  // The ground truth must outlive the evaluator.
+  RelativePoseEvaluator(const RelativePoseEvaluatorOptions& options,
+                        const Reconstruction& ground_truth);
+  ~RelativePoseEvaluator() {}
+
+  // Evaluates the two view info of each view pair, where the two view info
+  // describes the pose of the second view relative to the first view. Returns
+  // the number of view pairs that were evaluated.
+  int AddRelativePoses(const std::vector<ViewIdPair>& view_pairs,
+                       const std::vector<TwoViewInfo>& twoview_infos);
+
+  // Evaluates all edges of the view graph, whose view ids must be the view ids
+  // of the ground truth.
+  int AddViewGraph(const ViewGraph& view_graph);
+
+  // Evaluates the two view infos of all matches in the database. The images are
+  // identified with the views of the ground truth by their names.
+  int AddMatches(FeaturesAndMatchesDatabase* database);
+
+  int NumEvaluatedViewPairs() const { return evaluated_view_pairs_.size(); }
+  int NumSkippedViewPairs() const { return num_skipped_view_pairs_; }
+
+  // The evaluated view pairs and their errors in degrees.
+  const std::vector<ViewIdPair>& EvaluatedViewPairs() const {
+    return evaluated_view_pairs_;
+  }
+  const std::vector<double>& RotationErrors() const { return rotation_errors_; }
+  const std::vector<double>& TranslationErrors() const {
+    return translation_errors_;
+  }
+
+  const Histogram<double>& RotationHistogram() const {
+    return rotation_histogram_;
+  }
+  const Histogram<double>& TranslationHistogram() const {
+    return translation_histogram_;
+  }
+
+  // Returns the mean, median and histogram of the rotation and translation
+  // errors in the format of PoseError.
+  std::string PrintMeanMedianHistogram() const;
+
+ private:
+  const RelativePoseEvaluatorOptions options_;
+  const Reconstruction& ground_truth_;
+
+  std::vector<ViewIdPair> evaluated_view_pairs_;
+  std::vector<double> rotation_errors_;
+  std::vector<double> translation_errors_;
+  Histogram<double> rotation_histogram_;
+  Histogram<double> translation_histogram_;
+  int num_skipped_view_pairs_;
+
+  DISALLOW_COPY_AND_ASSIGN(RelativePoseEvaluator);
+};
+
+}  // namespace theia
+
+#endif  // THEIA_SFM_EVALUATE_RELATIVE_POSES_H_
@@ -0,0 +1,227 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+
+#include <Eigen/Core>
+#include <Eigen/Geometry>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "theia/matching/image_pair_match.h"
+#include "theia/matching/in_memory_features_and_matches_database.h"
+#include "theia/math/util.h"
+#include "theia/sfm/evaluate_relative_poses.h"
+#include "theia/sfm/reconstruction.h"
+#include "theia/sfm/twoview_info.h"
+#include "theia/sfm/types.h"
+#include "theia/sfm/view_graph/view_graph.h"
+#include "theia/util/random.h"
+#include "theia/util/stringprintf.h"
+
+namespace theia {
+
+namespace {
+
+RandomNumberGenerator rng(59);
+
+// Adds views with random poses to the reconstruction. The last view is not
+// estimated.
+void CreateGroundTruth(const int num_views, Reconstruction* reconstruction) {
+  for (int i = 0; i < num_views; i++) {
+    const ViewId view_id =
+        reconstruction->AddView(StringPrintf("view_%d", i), i);
+    View* view = reconstruction->MutableView(view_id);
+    view->MutableCamera()->SetPosition(rng.RandVector3d());
+    view->MutableCamera()->SetOrientationFromAngleAxis(
+        0.5 * rng.RandVector3d());
+    view->SetEstimated(i + 1 < num_views);
+  }
+}
+
+// Returns the relative pose of the views with the relative rotation rotated by
+// rotation_error_degrees about an axis orthogonal to the relative translation,
+// and the relative translation rotated by translation_error_degrees about the
+// same axis.
+TwoViewInfo PerturbedTwoViewInfo(const Reconstruction& reconstruction,
+                                 const ViewId view_id1,
+                                 const ViewId view_id2,
+                                 const double rotation_error_degrees,
+                                 const double translation_error_degrees) {
+  TwoViewInfo info;
+  TwoViewInfoFromTwoCameras(reconstruction.View(view_id1)->Camera(),
+                            reconstruction.View(view_id2)->Camera(),
+                            &info);
+  const Eigen::Vector3d axis =
+      info.position_2.cross(Eigen::Vector3d::UnitZ()).normalized();
+
+  const Eigen::AngleAxisd rotation(info.rotation_2.norm(),
+                                   info.rotation_2.normalized());
+  const Eigen::AngleAxisd rotation_noise(DegToRad(rotation_error_degrees),
+                                         axis);
+  const Eigen::AngleAxisd perturbed_rotation(rotation_noise * rotation);
+  info.rotation_2 = perturbed_rotation.angle() * perturbed_rotation.axis();
+
+  info.position_2 = Eigen::AngleAxisd(DegToRad(translation_error_degrees),
+                                      axis) *
+                    info.position_2;
+  return info;
+}
+
+}  // namespace
+
+TEST(RelativePoseErrors, KnownErrors) {
+  Reconstruction reconstruction;
+  CreateGroundTruth(3, &reconstruction);
+  const TwoViewInfo info =
+      PerturbedTwoViewInfo(reconstruction, 0, 1, 3.0, 7.0);
+  const Camera& camera1 = reconstruction.View(0)->Camera();
+  const Camera& camera2 = reconstruction.View(1)->Camera();
+  EXPECT_NEAR(RelativeRotationError(camera1.GetOrientationAsRotationMatrix(),
+                                    camera2.GetOrientationAsRotationMatrix(),
+                                    info.rotation_2),
+              3.0,
+              1e-6);
+  EXPECT_NEAR(
+      RelativeTranslationError(camera1.GetPosition(),
+                               camera2.GetPosition(),
+                               camera1.GetOrientationAsRotationMatrix(),
+                               info.position_2),
+      7.0,
+      1e-4);
+}
+
+TEST(RelativePoseEvaluator, ParallelEvaluationMatchesSerialEvaluation) {
+  static const int kNumViews = 40;
+  Reconstruction reconstruction;
+  CreateGroundTruth(kNumViews, &reconstruction);
+
+  std::vector<ViewIdPair> view_pairs;
+  std::vector<TwoViewInfo> twoview_infos;
+  for (ViewId i = 0; i < kNumViews; i++) {
+    for (ViewId j = i + 1; j < kNumViews; j++) {
+      view_pairs.emplace_back(i, j);
+      twoview_infos.emplace_back(PerturbedTwoViewInfo(
+          reconstruction, i, j, (i + j) % 20, (i * j) % 90));
+    }
+  }
+  // Pairs with an unknown view are skipped as well.
+  view_pairs.emplace_back(0, kInvalidViewId);
+  twoview_infos.emplace_back();
+
+  RelativePoseEvaluatorOptions options;
+  RelativePoseEvaluator serial_evaluator(options, reconstruction);
+  options.num_threads = 4;
+  RelativePoseEvaluator parallel_evaluator(options, reconstruction);
+  // Add the pairs in two batches to the parallel evaluator.
+  const int num_first_batch = view_pairs.size() / 3;
+  const int num_evaluated_view_pairs =
+      parallel_evaluator.AddRelativePoses(
+          std::vector<ViewIdPair>(view_pairs.begin(),
+                                  view_pairs.begin() + num_first_batch),
+          std::vector<TwoViewInfo>(twoview_infos.begin(),
+                                   twoview_infos.begin() + num_first_batch)) +
+      parallel_evaluator.AddRelativePoses(
+          std::vector<ViewIdPair>(view_pairs.begin() + num_first_batch,
+                                  view_pairs.end()),
+          std::vector<TwoViewInfo>(twoview_infos.begin() + num_first_batch,
+                                   twoview_infos.end()));
+  serial_evaluator.AddRelativePoses(view_pairs, twoview_infos);
+
+  // The pairs with the last view, which is not estimated, are skipped.
+  const int num_estimated_view_pairs = (kNumViews - 1) * (kNumViews - 2) / 2;
+  EXPECT_EQ(num_evaluated_view_pairs, num_estimated_view_pairs);
+  EXPECT_EQ(parallel_evaluator.NumEvaluatedViewPairs(),
+            num_estimated_view_pairs);
+  EXPECT_EQ(parallel_evaluator.NumSkippedViewPairs(), kNumViews);
+  EXPECT_EQ(parallel_evaluator.EvaluatedViewPairs(),
+            serial_evaluator.EvaluatedViewPairs());
+  EXPECT_EQ(parallel_evaluator.RotationErrors(),
+            serial_evaluator.RotationErrors());
+  EXPECT_EQ(parallel_evaluator.TranslationErrors(),
+            serial_evaluator.TranslationErrors());
+  EXPECT_EQ(parallel_evaluator.RotationHistogram().Counts(),
+            serial_evaluator.RotationHistogram().Counts());
+  EXPECT_EQ(parallel_evaluator.TranslationHistogram().Counts(),
+            serial_evaluator.TranslationHistogram().Counts());
+  EXPECT_EQ(parallel_evaluator.RotationHistogram().NumValues(),
+            num_estimated_view_pairs);
+  EXPECT_EQ(parallel_evaluator.PrintMeanMedianHistogram(),
+            serial_evaluator.PrintMeanMedianHistogram());
+
+  for (int i = 0; i < num_estimated_view_pairs; i++) {
+    const ViewIdPair& view_pair = parallel_evaluator.EvaluatedViewPairs()[i];
+    EXPECT_NEAR(parallel_evaluator.RotationErrors()[i],
+                (view_pair.first + view_pair.second) % 20,
+                1e-6);
+    EXPECT_NEAR(parallel_evaluator.TranslationErrors()[i],
+                (view_pair.first * view_pair.second) % 90,
+                1e-4);
+  }
+}
+
+TEST(RelativePoseEvaluator, ViewGraphAndMatches) {
+  static const int kNumViews = 10;
+  Reconstruction reconstruction;
+  CreateGroundTruth(kNumViews, &reconstruction);
+
+  ViewGraph view_graph;
+  InMemoryFeaturesAndMatchesDatabase database;
+  for (ViewId i = 0; i + 1 < kNumViews; i++) {
+    const TwoViewInfo info =
+        PerturbedTwoViewInfo(reconstruction, i, i + 1, 1.0, 1.0);
+    view_graph.AddEdge(i, i + 1, info);
+    ImagePairMatch match;
+    match.image1 = reconstruction.View(i)->Name();
+    match.image2 = reconstruction.View(i + 1)->Name();
+    match.twoview_info = info;
+    database.PutImagePairMatch(match.image1, match.image2, match);
+  }
+
+  RelativePoseEvaluatorOptions options;
+  options.num_threads = 2;
+  options.batch_size = 4;
+  RelativePoseEvaluator view_graph_evaluator(options, reconstruction);
+  EXPECT_EQ(view_graph_evaluator.AddViewGraph(view_graph), kNumViews - 2);
+  RelativePoseEvaluator matches_evaluator(options, reconstruction);
+  EXPECT_EQ(matches_evaluator.AddMatches(&database), kNumViews - 2);
+  EXPECT_EQ(matches_evaluator.NumSkippedViewPairs(), 1);
+  for (const double error : matches_evaluator.RotationErrors()) {
+    EXPECT_NEAR(error, 1.0, 1e-6);
+  }
+  EXPECT_EQ(matches_evaluator.RotationHistogram().Counts(),
+            view_graph_evaluator.RotationHistogram().Counts());
+}
+
+}  // namespace theia
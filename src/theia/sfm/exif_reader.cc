@@ -120,8 +120,15 @@ bool ExifReader::ExtractEXIFMetadata(
     CameraIntrinsicsPrior* camera_intrinsics_prior) const {
   CHECK_NOTNULL(camera_intrinsics_prior);
 
-  oiio::ImageBuf image(image_file);
-  oiio::ImageSpec image_spec = image.spec();
+  // Only the header (including the EXIF block) is read. The pixels are never
+  // decoded and the file is not added to the shared image cache.
+  auto image_input = oiio::ImageInput::open(image_file);
+  if (!image_input) {
+    LOG(ERROR) << "Could not open the image file " << image_file;
+    return false;
+  }
+  const oiio::ImageSpec image_spec = image_input->spec();
+  image_input->close();
 
   // Set the image dimensions.
   camera_intrinsics_prior->image_width = image_spec.width;
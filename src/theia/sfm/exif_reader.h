@@ -63,10 +63,11 @@ class ExifReader {
   ExifReader();
 
   // Extracts EXIF metadata from the image file and populates the intrinsics
-  // prior object. If the file could not be opened then the function returns
-  // false. If no EXIF data is found in the image, then it will be a valid
-  // CameraIntrinsicsPrior object with the is_set field set to false for all
-  // metadata field. The function will return true in this case.
+  // prior object. Only the image header is read, so this is cheap even for
+  // very large images. If the file could not be opened then the function
+  // returns false. If no EXIF data is found in the image, then it will be a
+  // valid CameraIntrinsicsPrior object with the is_set field set to false for
+  // all metadata field. The function will return true in this case.
   bool ExtractEXIFMetadata(
       const std::string& image_file,
       CameraIntrinsicsPrior* camera_intrinsics_prior) const;
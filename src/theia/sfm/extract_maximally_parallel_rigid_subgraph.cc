@@ -35,135 +35,406 @@
 #include "theia/sfm/extract_maximally_parallel_rigid_subgraph.h"
 
 #include <Eigen/Core>
-#include <Eigen/LU>
+#include <Eigen/Eigenvalues>
+#include <Eigen/QR>
+#include <Eigen/SparseCore>
 #include <ceres/rotation.h>
+#include <glog/logging.h>
 
 #include <algorithm>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
+#include "theia/math/matrix/sparse_cholesky_llt.h"
 #include "theia/sfm/pose/util.h"
 #include "theia/sfm/types.h"
 #include "theia/sfm/view_graph/view_graph.h"
 #include "theia/util/map_util.h"
+#include "theia/util/random.h"
 
 namespace theia {
 namespace {
 
-void FormAngleMeasurementMatrix(
-    const std::unordered_map<ViewId, Eigen::Vector3d>& orientations,
-    const ViewGraph& view_graph,
-    const std::unordered_map<ViewId, int>& view_ids_to_index,
-    Eigen::MatrixXd* angle_measurements) {
-  const auto& view_pairs = view_graph.GetAllEdges();
-  angle_measurements->setZero();
-
-  // Set up the matrix such that t_{i,j} x (c_j - c_i) = 0.
-  int i = 0;
-  for (const auto& view_pair : view_pairs) {
-    // Get t_{i,j} and rotate it such that it is oriented in the global
-    // reference frame.
-    Eigen::Matrix3d world_to_view1_rotation;
-    ceres::AngleAxisToRotationMatrix(
-        FindOrDie(orientations, view_pair.first.first).data(),
-        ceres::ColumnMajorAdapter3x3(world_to_view1_rotation.data()));
-    const Eigen::Vector3d rotated_translation =
-        world_to_view1_rotation.transpose() * view_pair.second.position_2;
-    const Eigen::Matrix3d cross_product_mat =
-        CrossProductMatrix(rotated_translation);
+typedef std::pair<int, int> IndexEdge;
 
-    // Find the column locations of the two views.
-    const int view1_col =
-        3 * FindOrDie(view_ids_to_index, view_pair.first.first);
-    const int view2_col =
-        3 * FindOrDie(view_ids_to_index, view_pair.first.second);
+// Removes views with fewer than two edges until none are left. A view with a
+// single edge may slide along its relative translation, so it is only rigid
+// with its neighbor and cannot be part of a rigid component of three or more
+// views. Removing it does not change the rigidity of the other views.
+void RemoveLeafViews(const std::vector<IndexEdge>& edges,
+                     std::vector<bool>* removed) {
+  const int num_views = removed->size();
+  std::vector<std::vector<int> > neighbors(num_views);
+  for (const IndexEdge& edge : edges) {
+    neighbors[edge.first].emplace_back(edge.second);
+    neighbors[edge.second].emplace_back(edge.first);
+  }
 
-    angle_measurements->block<3, 3>(3 * i, view1_col) = -cross_product_mat;
-    angle_measurements->block<3, 3>(3 * i, view2_col) = cross_product_mat;
-    ++i;
+  std::vector<int> degree(num_views);
+  std::vector<int> leaves;
+  for (int i = 0; i < num_views; i++) {
+    degree[i] = neighbors[i].size();
+    if (degree[i] < 2) {
+      leaves.emplace_back(i);
+      (*removed)[i] = true;
+    }
+  }
+  while (!leaves.empty()) {
+    const int leaf = leaves.back();
+    leaves.pop_back();
+    for (const int neighbor : neighbors[leaf]) {
+      if (!(*removed)[neighbor] && --degree[neighbor] < 2) {
+        leaves.emplace_back(neighbor);
+        (*removed)[neighbor] = true;
+      }
+    }
   }
 }
 
-// Computes the cosine distance in each dimension x, y, and z and returns the
-// maximum cosine distance.
-//
-// cos distance = 1.0 - a.dot(b) / (norm(a) * norm(b))
-double ComputeCosineDistance(const Eigen::MatrixXd& mat1,
-                             const Eigen::MatrixXd& mat2) {
-  Eigen::Vector3d cos_distance;
-  for (int i = 0; i < 3; i++) {
-    cos_distance(i) = 1.0 - std::abs(mat1.row(i).dot(mat2.row(i)));
-  }
-  return cos_distance.maxCoeff();
+// Returns the connected components of the views that are not removed, largest
+// first.
+std::vector<std::vector<int> > FindConnectedComponents(
+    const std::vector<IndexEdge>& edges, const std::vector<bool>& removed) {
+  const int num_views = removed.size();
+  std::vector<std::vector<int> > neighbors(num_views);
+  for (const IndexEdge& edge : edges) {
+    if (!removed[edge.first] && !removed[edge.second]) {
+      neighbors[edge.first].emplace_back(edge.second);
+      neighbors[edge.second].emplace_back(edge.first);
+    }
+  }
+
+  std::vector<std::vector<int> > components;
+  std::vector<bool> visited(num_views, false);
+  for (int i = 0; i < num_views; i++) {
+    if (removed[i] || visited[i]) {
+      continue;
+    }
+    std::vector<int> component(1, i);
+    visited[i] = true;
+    for (int j = 0; j < component.size(); j++) {
+      for (const int neighbor : neighbors[component[j]]) {
+        if (!visited[neighbor]) {
+          visited[neighbor] = true;
+          component.emplace_back(neighbor);
+        }
+      }
+    }
+    std::sort(component.begin(), component.end());
+    components.emplace_back(std::move(component));
+  }
+  std::stable_sort(components.begin(),
+                   components.end(),
+                   [](const std::vector<int>& component1,
+                      const std::vector<int>& component2) {
+                     return component1.size() > component2.size();
+                   });
+  return components;
 }
 
-// Find the maximal rigid component containing fixed_node. This is done by
-// examining which nodes are parallel when removing node fixed_node from the
-// null space. The nodes are only parallel if they are part of the maximal rigid
-// component with fixed_node.
-void FindMaximalParallelRigidComponent(const Eigen::MatrixXd& null_space,
-                                       const int fixed_node,
-                                       std::unordered_set<int>* largest_cc) {
-  static const double kMaxCosDistance = 1e-5;
-  static const double kMaxNorm = 1e-10;
+// Forms the sparse matrix of the constraints t_{i,j} x (c_j - c_i) = 0, where
+// t_{i,j} is the relative translation rotated to the global frame. The first
+// view of the component is held fixed at the origin to remove the global
+// translation from the null space, so its columns are omitted.
+void FormAngleMeasurementMatrix(
+    const std::vector<Eigen::Vector3d>& rotated_translations,
+    const std::vector<IndexEdge>& edges,
+    const std::vector<int>& component_index,
+    const int num_views,
+    Eigen::SparseMatrix<double>* angle_measurements) {
+  std::vector<Eigen::Triplet<double> > triplets;
+  triplets.reserve(2 * 9 * edges.size());
+  int row = 0;
+  for (int e = 0; e < edges.size(); e++) {
+    const int index1 = component_index[edges[e].first];
+    const int index2 = component_index[edges[e].second];
+    if (index1 < 0 || index2 < 0) {
+      continue;
+    }
 
-  const int num_nodes = null_space.rows() / 3;
+    const Eigen::Matrix3d cross_product_mat =
+        CrossProductMatrix(rotated_translations[e]);
+    for (int r = 0; r < 3; r++) {
+      for (int c = 0; c < 3; c++) {
+        if (cross_product_mat(r, c) == 0.0) {
+          continue;
+        }
+        if (index1 > 0) {
+          triplets.emplace_back(
+              row + r, 3 * (index1 - 1) + c, -cross_product_mat(r, c));
+        }
+        if (index2 > 0) {
+          triplets.emplace_back(
+              row + r, 3 * (index2 - 1) + c, cross_product_mat(r, c));
+        }
+      }
+    }
+    row += 3;
+  }
+
+  angle_measurements->resize(row, 3 * (num_views - 1));
+  angle_measurements->setFromTriplets(triplets.begin(), triplets.end());
+  angle_measurements->makeCompressed();
+}
 
-  largest_cc->insert(fixed_node);
+// Computes an orthonormal basis of the null space of the matrix A from the
+// eigenvectors of A^t * A with (nearly) zero eigenvalues. A^t * A + shift * I is
+// positive definite and as sparse as the view graph, so its sparse Cholesky
+// decomposition is cheap. Inverse iterations with a block of vectors quickly
+// converge to the eigenvectors with the smallest eigenvalues since the null
+// space is amplified by 1 / shift. The block is enlarged until it contains an
+// eigenvector that is not in the null space, i.e. the whole null space was
+// found.
+void ComputeNullSpace(const Eigen::SparseMatrix<double>& angle_measurements,
+                      const int num_threads,
+                      Eigen::MatrixXd* null_space) {
+  static const double kRelativeShift = 1e-8;
+  static const double kRelativeNullSpaceThreshold = 1e-10;
+  static const int kInitialBlockSize = 8;
+  static const int kNumInverseIterations = 3;
+  static const unsigned kSeed = 59;
 
-  const Eigen::MatrixXd fixed_null_space_component =
-      null_space.block(3 * fixed_node, 0, 3, null_space.cols());
+  const int num_cols = angle_measurements.cols();
+  const Eigen::SparseMatrix<double> ata =
+      angle_measurements.transpose() * angle_measurements;
+  const double mean_diagonal = ata.diagonal().sum() / num_cols;
+  Eigen::SparseMatrix<double> shift(num_cols, num_cols);
+  shift.setIdentity();
+  shift *= kRelativeShift * mean_diagonal;
 
-  // Remove the fixed node from the rest of the null space.
-  Eigen::MatrixXd modified_null_space =
-      null_space - fixed_null_space_component.replicate(num_nodes, 1);
+  SparseCholeskyLLt linear_solver;
+  linear_solver.Compute(ata + shift);
+  CHECK_EQ(linear_solver.Info(), Eigen::Success)
+      << "Could not factorize the angle measurements matrix.";
 
-  // Normalize all rows to be unit-norm. If the rows have a very small norm then
-  // they are parallel to the fixed_node. and should be set to zero.
-  const Eigen::VectorXd norms = modified_null_space.rowwise().norm();
+  RandomNumberGenerator rng(kSeed);
+  int block_size = std::min(kInitialBlockSize, num_cols);
+  while (true) {
+    Eigen::MatrixXd basis(num_cols, block_size), solution;
+    rng.SetRandom(&basis);
+    for (int i = 0; i < kNumInverseIterations; i++) {
+      linear_solver.Solve(basis, num_threads, &solution);
+      Eigen::HouseholderQR<Eigen::MatrixXd> qr(solution);
+      basis = qr.householderQ() * Eigen::MatrixXd::Identity(num_cols,
+                                                            block_size);
+    }
 
-  modified_null_space.rowwise().normalize();
+    // The eigenvectors of A^t * A in the span of the block.
+    const Eigen::MatrixXd projected_ata = basis.transpose() * (ata * basis);
+    const Eigen::SelfAdjointEigenSolver<Eigen::MatrixXd> eigen_solver(
+        projected_ata);
+    int nullity = 0;
+    while (nullity < block_size &&
+           eigen_solver.eigenvalues()(nullity) <
+               kRelativeNullSpaceThreshold * mean_diagonal) {
+      ++nullity;
+    }
 
-  // Find the pairs to match. Add all indices that are close to 0-vectors, as
-  // they are clearly part of the rigid component.
-  std::vector<int> indices_to_match;
+    if (nullity < block_size || block_size == num_cols) {
+      *null_space = basis * eigen_solver.eigenvectors().leftCols(nullity);
+      return;
+    }
+    block_size = std::min(2 * block_size, num_cols);
+  }
+}
+
+// Finds the maximal rigid components containing fixed_node. The null space has
+// a 3x3 block for each view (the fixed first view of the component has a zero
+// block). If we hold fixed_node at the origin by subtracting its block, then
+// all views of a rigid component with fixed_node may only move by a common
+// scale, so the rows of their blocks are all parallel to the same direction. The
+// views are grouped by this direction, and each group together with
+// fixed_node (and any view whose block is zero) is a maximal rigid component.
+void FindMaximalParallelRigidComponents(
+    const Eigen::MatrixXd& null_space,
+    const int fixed_node,
+    std::vector<std::vector<int> >* components) {
+  static const double kMaxCosDistance = 1e-5;
+  static const double kMaxNorm = 1e-10;
+
+  const int num_nodes = null_space.rows() / 3;
+
+  std::vector<int> zero_nodes;
+  std::vector<Eigen::VectorXd> directions;
+  std::vector<std::vector<int> > groups;
   for (int i = 0; i < num_nodes; i++) {
-    // Skip this index if it is fixed.
     if (i == fixed_node) {
       continue;
     }
+    const Eigen::MatrixXd block =
+        null_space.middleRows(3 * i, 3) -
+        null_space.middleRows(3 * fixed_node, 3);
+    int max_row;
+    const double max_norm = block.rowwise().norm().maxCoeff(&max_row);
+    if (max_norm < kMaxNorm) {
+      zero_nodes.emplace_back(i);
+      continue;
+    }
 
-    // Skip this index if it is nearly a 0-vector because this means it is
-    // clearly part of the rigid component.
-    if (norms(3 * i) < kMaxNorm && norms(3 * i + 1) < kMaxNorm &&
-        norms(3 * i + 2) < kMaxNorm) {
-      largest_cc->insert(i);
+    // All rows must be parallel to the row with the largest norm unless they
+    // are (nearly) zero.
+    Eigen::VectorXd direction = block.row(max_row).transpose() / max_norm;
+    bool is_rank_one = true;
+    for (int r = 0; r < 3 && is_rank_one; r++) {
+      const double norm = block.row(r).norm();
+      if (r == max_row || norm < kMaxNorm) {
+        continue;
+      }
+      is_rank_one = 1.0 - std::abs(block.row(r).dot(direction)) / norm <
+                    kMaxCosDistance;
+    }
+    if (!is_rank_one) {
       continue;
     }
 
-    indices_to_match.emplace_back(i);
+    int group = 0;
+    for (; group < groups.size(); group++) {
+      if (1.0 - std::abs(directions[group].dot(direction)) < kMaxCosDistance) {
+        break;
+      }
+    }
+    if (group == groups.size()) {
+      directions.emplace_back(std::move(direction));
+      groups.emplace_back();
+    }
+    groups[group].emplace_back(i);
+  }
+
+  // If there is no group, the views with zero blocks are still rigid with
+  // fixed_node.
+  if (groups.empty()) {
+    groups.emplace_back();
+  }
+  components->clear();
+  for (const std::vector<int>& group : groups) {
+    std::vector<int> component(1, fixed_node);
+    component.insert(component.end(), zero_nodes.begin(), zero_nodes.end());
+    component.insert(component.end(), group.begin(), group.end());
+    components->emplace_back(std::move(component));
+  }
+  VLOG(3) << "Found " << components->size()
+          << " rigid components containing node " << fixed_node << ".";
+}
+
+// Finds the largest maximal rigid component of a connected component of the
+// view graph, returned as indices into component. The maximal rigid components
+// partition the edges (two of them share at most one view), so we repeatedly
+// find all rigid components containing the view with the most edges that are
+// not yet part of a found component. A component that is not yet found only
+// contains views with such edges, so we can stop once the largest component is
+// at least as large as the number of these views.
+std::vector<int> FindLargestRigidComponent(
+    const std::vector<Eigen::Vector3d>& rotated_translations,
+    const std::vector<IndexEdge>& edges,
+    const std::vector<int>& component,
+    const int num_views,
+    const int num_threads) {
+  std::vector<int> component_index(num_views, -1);
+  for (int i = 0; i < component.size(); i++) {
+    component_index[component[i]] = i;
+  }
+
+  Eigen::SparseMatrix<double> angle_measurements;
+  FormAngleMeasurementMatrix(rotated_translations,
+                             edges,
+                             component_index,
+                             component.size(),
+                             &angle_measurements);
+  Eigen::MatrixXd reduced_null_space;
+  ComputeNullSpace(angle_measurements, num_threads, &reduced_null_space);
+  VLOG(2) << "The angle measurements matrix of " << component.size()
+          << " views has a null space of dimension "
+          << reduced_null_space.cols() << ".";
+
+  // The whole component is rigid if the only motion is a global translation.
+  if (reduced_null_space.cols() == 0) {
+    std::vector<int> all_nodes(component.size());
+    for (int i = 0; i < component.size(); i++) {
+      all_nodes[i] = i;
+    }
+    return all_nodes;
   }
 
-  // Each node has three dimensions (x, y, z). We only compare parallel-ness
-  // between similar dimensions. If all x, y, z dimensions are parallel then
-  // the two nodes will be parallel.
-  for (int i = 0; i < indices_to_match.size(); i++) {
-    // Test all other nodes (that have not been tested) to determine if they are
-    // parallel to this node.
-    const Eigen::MatrixXd& block1 = modified_null_space.block(
-        3 * indices_to_match[i], 0, 3, null_space.cols());
+  // Add the zero block of the view that was held fixed.
+  Eigen::MatrixXd null_space(3 * component.size(), reduced_null_space.cols());
+  null_space.topRows(3).setZero();
+  null_space.bottomRows(reduced_null_space.rows()) = reduced_null_space;
 
-    for (int j = i + 1; j < indices_to_match.size(); j++) {
-      const Eigen::MatrixXd& block2 = modified_null_space.block(
-          3 * indices_to_match[j], 0, 3, null_space.cols());
+  // The edges of the component by node, and the number of edges of each node
+  // that are not part of a found rigid component.
+  std::vector<std::vector<std::pair<int, int> > > node_edges(component.size());
+  for (int e = 0; e < edges.size(); e++) {
+    const int index1 = component_index[edges[e].first];
+    const int index2 = component_index[edges[e].second];
+    if (index1 >= 0 && index2 >= 0) {
+      node_edges[index1].emplace_back(index2, e);
+      node_edges[index2].emplace_back(index1, e);
+    }
+  }
+  std::vector<bool> is_edge_found(edges.size(), false);
+  std::vector<int> num_remaining_edges(component.size());
+  for (int i = 0; i < component.size(); i++) {
+    num_remaining_edges[i] = node_edges[i].size();
+  }
+  const auto mark_edge_found = [&](const int edge, const int node1,
+                                   const int node2) {
+    if (!is_edge_found[edge]) {
+      is_edge_found[edge] = true;
+      --num_remaining_edges[node1];
+      --num_remaining_edges[node2];
+    }
+  };
 
-      const double cos_distance = ComputeCosineDistance(block1, block2);
-      if (cos_distance < kMaxCosDistance) {
-        largest_cc->insert(indices_to_match[i]);
-        largest_cc->insert(indices_to_match[j]);
+  std::vector<int> largest_component;
+  std::vector<bool> in_component(component.size(), false);
+  std::vector<std::vector<int> > rigid_components;
+  while (true) {
+    int fixed_node = -1;
+    int num_remaining_nodes = 0;
+    for (int i = 0; i < component.size(); i++) {
+      if (num_remaining_edges[i] == 0) {
+        continue;
       }
+      ++num_remaining_nodes;
+      if (fixed_node < 0 ||
+          num_remaining_edges[i] > num_remaining_edges[fixed_node]) {
+        fixed_node = i;
+      }
+    }
+    if (num_remaining_nodes <= largest_component.size()) {
+      break;
+    }
+
+    FindMaximalParallelRigidComponents(
+        null_space, fixed_node, &rigid_components);
+    for (const std::vector<int>& rigid_component : rigid_components) {
+      for (const int node : rigid_component) {
+        in_component[node] = true;
+      }
+      for (const int node : rigid_component) {
+        for (const auto& neighbor : node_edges[node]) {
+          if (in_component[neighbor.first]) {
+            mark_edge_found(neighbor.second, node, neighbor.first);
+          }
+        }
+      }
+      for (const int node : rigid_component) {
+        in_component[node] = false;
+      }
+      if (rigid_component.size() > largest_component.size()) {
+        largest_component = rigid_component;
+      }
+    }
+
+    // Each edge of the fixed node is part of one of its rigid components, but
+    // make sure we progress even if a view was not grouped due to numerical
+    // issues.
+    for (const auto& neighbor : node_edges[fixed_node]) {
+      mark_edge_found(neighbor.second, fixed_node, neighbor.first);
     }
   }
+  return largest_component;
 }
 
 }  // namespace
@@ -171,54 +442,93 @@ void FindMaximalParallelRigidComponent(const Eigen::MatrixXd& null_space,
 void ExtractMaximallyParallelRigidSubgraph(
     const std::unordered_map<ViewId, Eigen::Vector3d>& orientations,
     ViewGraph* view_graph) {
+  ExtractMaximallyParallelRigidSubgraph(orientations, 1, view_graph);
+}
+
+void ExtractMaximallyParallelRigidSubgraph(
+    const std::unordered_map<ViewId, Eigen::Vector3d>& orientations,
+    const int num_threads,
+    ViewGraph* view_graph) {
+  CHECK_GT(num_threads, 0);
   // Create a mapping of indexes to ViewIds for our linear system.
   std::unordered_map<ViewId, int> view_ids_to_index;
+  std::vector<ViewId> view_ids;
   view_ids_to_index.reserve(orientations.size());
   for (const auto& orientation : orientations) {
     if (!view_graph->HasView(orientation.first)) {
       continue;
     }
-    const int current_index = view_ids_to_index.size();
-    InsertIfNotPresent(&view_ids_to_index, orientation.first, current_index);
+    const int current_index = view_ids.size();
+    if (InsertIfNotPresent(
+            &view_ids_to_index, orientation.first, current_index)) {
+      view_ids.emplace_back(orientation.first);
+    }
   }
+  const int num_views = view_ids.size();
 
-  // Form the global angle measurements matrix from:
-  //    t_{i,j} x (c_j - c_i) = 0.
-  Eigen::MatrixXd angle_measurements(3 * view_graph->NumEdges(),
-                                     3 * orientations.size());
-  FormAngleMeasurementMatrix(
-      orientations, *view_graph, view_ids_to_index, &angle_measurements);
+  // Get t_{i,j} of each edge and rotate it such that it is oriented in the
+  // global reference frame.
+  std::vector<IndexEdge> edges;
+  std::vector<Eigen::Vector3d> rotated_translations;
+  edges.reserve(view_graph->NumEdges());
+  rotated_translations.reserve(view_graph->NumEdges());
+  for (const auto& view_pair : view_graph->GetAllEdges()) {
+    const int* index1 = FindOrNull(view_ids_to_index, view_pair.first.first);
+    const int* index2 = FindOrNull(view_ids_to_index, view_pair.first.second);
+    if (index1 == nullptr || index2 == nullptr) {
+      continue;
+    }
+    Eigen::Matrix3d world_to_view1_rotation;
+    ceres::AngleAxisToRotationMatrix(
+        FindOrDie(orientations, view_pair.first.first).data(),
+        ceres::ColumnMajorAdapter3x3(world_to_view1_rotation.data()));
+    edges.emplace_back(*index1, *index2);
+    rotated_translations.emplace_back(world_to_view1_rotation.transpose() *
+                                      view_pair.second.position_2);
+  }
 
-  // Extract the null space of the angle measurements matrix.
-  Eigen::FullPivLU<Eigen::MatrixXd> lu(angle_measurements.transpose() *
-                                       angle_measurements);
-  const Eigen::MatrixXd null_space = lu.kernel();
+  // Views that cannot be part of a rigid component with three or more views
+  // are removed before factorizing, and each connected component of the
+  // remaining views is processed independently with a sparse factorization.
+  // The components are processed from largest to smallest, so we may stop as
+  // soon as a component is not larger than the largest rigid component found.
+  std::vector<bool> removed(num_views, false);
+  RemoveLeafViews(edges, &removed);
+  const std::vector<std::vector<int> > connected_components =
+      FindConnectedComponents(edges, removed);
 
-  // For each node in the graph (i.e. each camera), set the null space component
-  // to be zero such that the camera position would be fixed at the origin. If
-  // two nodes i and j are in the same rigid component, then their null spaces
-  // will be parallel because the camera positions may only change by a
-  // scale. We find all components that are parallel to find the rigid
-  // components. The largest of such component is the maximally parallel rigid
-  // component of the graph.
-  std::unordered_set<int> maximal_rigid_component;
-  for (int i = 0; i < orientations.size(); i++) {
-    std::unordered_set<int> temp_cc;
-    FindMaximalParallelRigidComponent(null_space, i, &temp_cc);
-    if (temp_cc.size() > maximal_rigid_component.size()) {
-      std::swap(temp_cc, maximal_rigid_component);
+  std::vector<int> maximal_rigid_component;
+  for (const std::vector<int>& component : connected_components) {
+    if (component.size() <= maximal_rigid_component.size()) {
+      break;
+    }
+    const std::vector<int> rigid_component = FindLargestRigidComponent(
+        rotated_translations, edges, component, num_views, num_threads);
+    if (rigid_component.size() > maximal_rigid_component.size()) {
+      maximal_rigid_component.clear();
+      for (const int index : rigid_component) {
+        maximal_rigid_component.emplace_back(component[index]);
+      }
     }
   }
 
-  // Only keep the nodes in the largest maximally parallel rigid component.
-  for (const auto& orientation : orientations) {
-    const int index = FindOrDie(view_ids_to_index, orientation.first);
+  // If every view was removed as a leaf, the largest rigid component is a
+  // single edge.
+  if (maximal_rigid_component.empty() && !edges.empty()) {
+    maximal_rigid_component = {edges[0].first, edges[0].second};
+  }
+
+  // Only keep the views in the largest maximally parallel rigid component.
+  std::vector<bool> is_rigid(num_views, false);
+  for (const int index : maximal_rigid_component) {
+    is_rigid[index] = true;
+  }
+  for (int i = 0; i < num_views; i++) {
     // If the view is not in the maximal rigid component then remove it from the
     // view graph.
-    if (!ContainsKey(maximal_rigid_component, index) &&
-        view_graph->HasView(orientation.first)) {
-      CHECK(view_graph->RemoveView(orientation.first))
-          << "Could not remove view id " << orientation.first
+    if (!is_rigid[i]) {
+      CHECK(view_graph->RemoveView(view_ids[i]))
+          << "Could not remove view id " << view_ids[i]
           << " from the view graph because it does not exist.";
     }
   }
@@ -60,8 +60,20 @@ class ViewGraph;
 // utilized in "Robust Camera Location Estimation by Convex Programming" by
 // Ozyesil and Singer (CVPR 2015) as a filter prior to robust global position
 // estimation. Please cite these papers if using this method.
+//
+// The null space of the sparse bearing constraints is computed separately for
+// each connected component after removing views that can only be rigid with a
+// single neighbor, so the method scales to view graphs with many thousands of
+// views.
+void ExtractMaximallyParallelRigidSubgraph(
+    const std::unordered_map<ViewId, Eigen::Vector3d>& orientations,
+    ViewGraph* view_graph);
+
+// Same as above, but the linear systems for the null space are solved with
+// num_threads threads. The result does not depend on the number of threads.
 void ExtractMaximallyParallelRigidSubgraph(
     const std::unordered_map<ViewId, Eigen::Vector3d>& orientations,
+    const int num_threads,
     ViewGraph* view_graph);
 
 }  // namespace theia
@@ -35,6 +35,7 @@
 #include <Eigen/Core>
 #include <Eigen/Geometry>
 #include <ceres/rotation.h>
+#include <algorithm>
 #include <unordered_map>
 #include <vector>
 
@@ -164,6 +165,53 @@ void TestExtractMaximallyParallelRigidSubgraph(
   EXPECT_EQ(view_graph.NumViews(), num_views);
 }
 
+// Adds edges between all pairs of the views, which makes them rigid.
+void AddCompleteSubgraph(
+    const std::vector<ViewId>& view_ids,
+    const std::unordered_map<ViewId, Vector3d>& orientations,
+    const std::unordered_map<ViewId, Vector3d>& positions,
+    ViewGraph* view_graph) {
+  for (int i = 0; i < view_ids.size(); i++) {
+    for (int j = i + 1; j < view_ids.size(); j++) {
+      const ViewIdPair view_id_pair(std::min(view_ids[i], view_ids[j]),
+                                    std::max(view_ids[i], view_ids[j]));
+      view_graph->AddEdge(
+          view_id_pair.first,
+          view_id_pair.second,
+          CreateTwoViewInfo(orientations, positions, view_id_pair));
+    }
+  }
+}
+
+// Views 0-9 and views 10-14 form two rigid components. They are joined by a
+// single edge (or by sharing view 9 if share_view is true), which does not make
+// the union rigid since the smaller component may still move with respect to
+// the larger one. Views 15 and 16 hang off the larger component as a chain.
+void TestRemovesNonRigidViews(const bool share_view) {
+  std::unordered_map<ViewId, Vector3d> orientations;
+  std::unordered_map<ViewId, Vector3d> positions;
+  CreateViewsWithRandomPoses(17, &orientations, &positions);
+  ViewGraph view_graph;
+  AddCompleteSubgraph(
+      {0, 1, 2, 3, 4, 5, 6, 7, 8, 9}, orientations, positions, &view_graph);
+  if (share_view) {
+    AddCompleteSubgraph(
+        {9, 10, 11, 12, 13, 14}, orientations, positions, &view_graph);
+  } else {
+    AddCompleteSubgraph(
+        {10, 11, 12, 13, 14}, orientations, positions, &view_graph);
+    AddCompleteSubgraph({9, 10}, orientations, positions, &view_graph);
+  }
+  AddCompleteSubgraph({0, 15}, orientations, positions, &view_graph);
+  AddCompleteSubgraph({15, 16}, orientations, positions, &view_graph);
+
+  ExtractMaximallyParallelRigidSubgraph(orientations, &view_graph);
+  EXPECT_EQ(view_graph.NumViews(), 10);
+  for (ViewId view_id = 0; view_id < 10; view_id++) {
+    EXPECT_TRUE(view_graph.HasView(view_id));
+  }
+}
+
 }  // namespace
 
 TEST(ExtractMaximallyParallelRigidSubgraph, NoBadRotations) {
@@ -178,4 +226,39 @@ TEST(ExtractMaximallyParallelRigidSubgraph, ManyBadRotations) {
   TestExtractMaximallyParallelRigidSubgraph(30, 100, 30);
 }
 
+TEST(ExtractMaximallyParallelRigidSubgraph, RemovesComponentJoinedByAnEdge) {
+  TestRemovesNonRigidViews(false);
+}
+
+TEST(ExtractMaximallyParallelRigidSubgraph, RemovesComponentSharingAView) {
+  TestRemovesNonRigidViews(true);
+}
+
+TEST(ExtractMaximallyParallelRigidSubgraph, LargeSequentialGraph) {
+  // Each view is connected to the next three views, so every view is part of a
+  // triangle and the graph is rigid. A chain of two views at the end is not.
+  static const int kNumRigidViews = 5000;
+  std::unordered_map<ViewId, Vector3d> orientations;
+  std::unordered_map<ViewId, Vector3d> positions;
+  CreateViewsWithRandomPoses(kNumRigidViews + 2, &orientations, &positions);
+  ViewGraph view_graph;
+  for (ViewId i = 0; i < kNumRigidViews; i++) {
+    for (ViewId j = i + 1; j < std::min<ViewId>(i + 4, kNumRigidViews); j++) {
+      AddCompleteSubgraph({i, j}, orientations, positions, &view_graph);
+    }
+  }
+  AddCompleteSubgraph(
+      {kNumRigidViews - 1, kNumRigidViews}, orientations, positions,
+      &view_graph);
+  AddCompleteSubgraph(
+      {kNumRigidViews, kNumRigidViews + 1}, orientations, positions,
+      &view_graph);
+
+  static const int kNumThreads = 4;
+  ExtractMaximallyParallelRigidSubgraph(orientations, kNumThreads, &view_graph);
+  EXPECT_EQ(view_graph.NumViews(), kNumRigidViews);
+  EXPECT_FALSE(view_graph.HasView(kNumRigidViews));
+  EXPECT_FALSE(view_graph.HasView(kNumRigidViews + 1));
+}
+
 }  // namespace theia
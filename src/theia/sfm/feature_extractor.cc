@@ -45,8 +45,8 @@
 #include "theia/io/write_keypoints_and_descriptors.h"
 //#include "theia/image/image.h"
 #include "theia/image/keypoint_detector/keypoint.h"
+#include "theia/util/executor.h"
 #include "theia/util/filesystem.h"
-#include "theia/util/threadpool.h"
 
 namespace theia {
 
@@ -60,23 +60,26 @@ bool FeatureExtractor::Extract(
   CHECK_NOTNULL(keypoints)->resize(filenames.size());
   CHECK_NOTNULL(descriptors)->resize(filenames.size());
 
-  // The thread pool will wait to finish all jobs when it goes out of scope.
+  // If there are fewer images than threads, the remaining threads are used to
+  // extract the features within each image.
+  num_threads_per_image_ =
+      NumThreadsPerImage(options_.num_threads, filenames.size());
   const int num_threads =
-      std::min(options_.num_threads, static_cast<int>(filenames.size()));
-  ThreadPool feature_extractor_pool(num_threads);
-  for (int i = 0; i < filenames.size(); i++) {
-    if (!FileExists(filenames[i])) {
-      LOG(ERROR) << "Could not extract features for " << filenames[i]
-                 << " because the file cannot be found.";
-      continue;
-    }
-
-    feature_extractor_pool.Add(&FeatureExtractor::ExtractFeatures,
-                               this,
-                               filenames[i],
-                               &(*keypoints)[i],
-                               &(*descriptors)[i]);
-  }
+      std::max(1, options_.num_threads / num_threads_per_image_);
+  ParallelFor(num_threads,
+              filenames.size(),
+              [&](const int start, const int end) {
+                for (int i = start; i < end; i++) {
+                  if (!FileExists(filenames[i])) {
+                    LOG(ERROR) << "Could not extract features for "
+                               << filenames[i]
+                               << " because the file cannot be found.";
+                    continue;
+                  }
+                  ExtractFeatures(
+                      filenames[i], &(*keypoints)[i], &(*descriptors)[i]);
+                }
+              });
   return true;
 }
 
@@ -173,7 +176,9 @@ bool FeatureExtractor::ExtractFeatures(
 //   // exactly one object.
 //   std::unique_ptr<DescriptorExtractor> descriptor_extractor =
 //       CreateDescriptorExtractor(options_.descriptor_extractor_type,
-//                                 options_.feature_density);
+//                                 options_.feature_density,
+//                                 num_threads_per_image_,
+//                                 options_.max_num_features);
 
 //   // Exit if the descriptor extraction fails.
 //   if (!descriptor_extractor->DetectAndExtractDescriptors(image,
@@ -60,7 +60,9 @@ class FeatureExtractor {
     // extracted.
     FeatureDensity feature_density = FeatureDensity::NORMAL;
 
-    // The features returned will be no larger than this size.
+    // The features returned will be no larger than this size. SIFT keypoints
+    // are selected uniformly over the image by their response before their
+    // descriptors are computed, see SiftParameters::max_num_features.
     int max_num_features = 16384;
 
     // If we wish to write the features to disk, they will be output in this
@@ -70,7 +72,9 @@ class FeatureExtractor {
   };
 
   explicit FeatureExtractor(const Options& options)
-      : options_(options), write_features_to_disk_(false) {}
+      : options_(options),
+        write_features_to_disk_(false),
+        num_threads_per_image_(1) {}
   ~FeatureExtractor() {}
 
   // Method to extract descriptors.
@@ -102,6 +106,10 @@ class FeatureExtractor {
   const Options options_;
   bool write_features_to_disk_;
 
+  // The threads are split between processing images in parallel and
+  // processing each image with multiple threads, see NumThreadsPerImage.
+  int num_threads_per_image_;
+
   DISALLOW_COPY_AND_ASSIGN(FeatureExtractor);
 };
 
@@ -36,14 +36,18 @@
 
 #include <Eigen/Core>
 #include <algorithm>
+#include <atomic>
+#include <cstdlib>
 #include <glog/logging.h>
 #include <memory>
+#include <set>
 #include <string>
 #include <thread>  // NOLINT
 #include <vector>
 
 //#include "theia/image/descriptor/create_descriptor_extractor.h"
 //#include "theia/image/descriptor/descriptor_extractor.h"
+//#include "theia/image/descriptor/tiled_descriptor_extractor.h"
 //#include "theia/image/image.h"
 //#include "theia/image/keypoint_detector/keypoint.h"
 #include "theia/matching/create_feature_matcher.h"
@@ -52,14 +56,26 @@
 #include "theia/matching/features_and_matches_database.h"
 #include "theia/matching/fisher_vector_extractor.h"
 #include "theia/matching/global_descriptor_extractor.h"
+#include "theia/matching/global_descriptor_nearest_neighbors.h"
 #include "theia/matching/image_pair_match.h"
+#include "theia/matching/keypoints_and_descriptors.h"
+#include "theia/matching/sequential_pair_selector.h"
+#include "theia/matching/spatial_pair_selection.h"
+#include "theia/matching/spatial_reranking.h"
+#include "theia/matching/vocabulary_tree.h"
+#include "theia/math/principal_component_analysis.h"
 #include "theia/sfm/camera_intrinsics_prior.h"
 #include "theia/sfm/estimate_twoview_info.h"
 //#include "theia/sfm/exif_reader.h"
 #include "theia/sfm/two_view_match_geometric_verification.h"
+#include "theia/util/bounded_queue.h"
+#include "theia/util/executor.h"
 #include "theia/util/filesystem.h"
+#include "theia/util/map_util.h"
+#include "theia/util/metrics.h"
 #include "theia/util/string.h"
 #include "theia/util/threadpool.h"
+#include "theia/util/trace.h"
 
 namespace theia {
 namespace {
@@ -70,12 +86,12 @@ struct MatchedImages {
 };
 
 void ExtractFeatures(const FeatureExtractorAndMatcher::Options& options,
+                     const int num_threads_per_image,
                      const std::string& image_filepath,
                      const std::string& imagemask_filepath,
                      std::vector<Keypoint>* keypoints,
                      std::vector<Eigen::VectorXf>* descriptors) {
   static const float kMaskThreshold = 0.5;
-  //  std::unique_ptr<FloatImage> image(new FloatImage(image_filepath));
   //  // We create these variable here instead of upon the construction of the
   //  // object so that they can be thread-safe. We *should* be able to use the
   //  // static thread_local keywords, but apparently Mac OS-X's version of
@@ -87,16 +103,33 @@ void ExtractFeatures(const FeatureExtractorAndMatcher::Options& options,
   //  // exactly one object.
   //  std::unique_ptr<DescriptorExtractor> descriptor_extractor =
   //      CreateDescriptorExtractor(options.descriptor_extractor_type,
-  //                                options.feature_density);
-
+  //                                options.feature_density,
+  //                                num_threads_per_image,
+  //                                options.max_num_features);
+
+  //  // Tiled extraction reads the image and the mask tile by tile, so the
+  //  // image is never decoded as a whole and the mask is applied per tile.
+  //  if (options.use_tiled_extraction) {
+  //    TiledExtractionOptions tiled_options = options.tiled_extraction_options;
+  //    tiled_options.num_threads = num_threads_per_image;
+  //    TiledDescriptorExtractor tiled_extractor(tiled_options, [&options]() {
+  //      return CreateDescriptorExtractor(options.descriptor_extractor_type,
+  //                                       options.feature_density);
+  //    });
+  //    if (!tiled_extractor.DetectAndExtractDescriptors(
+  //            image_filepath, imagemask_filepath, keypoints, descriptors)) {
+  //      LOG(ERROR) << "Could not extract descriptors in image "
+  //                 << image_filepath;
+  //      return;
+  //    }
   //  // Exit if the descriptor extraction fails.
-  //  if (!descriptor_extractor->DetectAndExtractDescriptors(
-  //          *image, keypoints, descriptors)) {
+  //  } else if (!descriptor_extractor->DetectAndExtractDescriptors(
+  //                 *image, keypoints, descriptors)) {
   //    LOG(ERROR) << "Could not extract descriptors in image " <<
   //    image_filepath; return;
   //  }
 
-  //  if (imagemask_filepath.size() > 0) {
+  //  if (!options.use_tiled_extraction && imagemask_filepath.size() > 0) {
   //    std::unique_ptr<FloatImage> image_mask(new
   //    FloatImage(imagemask_filepath));
   //    // Check the size of the image and its associated mask.
@@ -144,7 +177,10 @@ FeatureExtractorAndMatcher::FeatureExtractorAndMatcher(
     const FeatureExtractorAndMatcher::Options& options,
     FeaturesAndMatchesDatabase* features_and_matches_database)
     : options_(options),
-      features_and_matches_database_(features_and_matches_database) {
+      features_and_matches_database_(features_and_matches_database),
+      num_threads_per_image_(1),
+      vocabulary_tree_(nullptr),
+      next_image_to_add_(0) {
   // Create the feature matcher.
   FeatureMatcherOptions matcher_options = options_.feature_matcher_options;
   matcher_options.num_threads = options_.num_threads;
@@ -158,11 +194,22 @@ FeatureExtractorAndMatcher::FeatureExtractorAndMatcher(
                                   features_and_matches_database_);
 
   // Initialize the global image descriptor extractor if desired.
-  if (options_.select_image_pairs_with_global_image_descriptor_matching) {
+  if (options_.select_image_pairs_with_global_image_descriptor_matching &&
+      options_.global_descriptor_extractor_type ==
+          GlobalDescriptorExtractorType::VOCABULARY_TREE) {
+    VocabularyTree::Options vt_options;
+    vt_options.branching_factor = options_.vocabulary_tree_branching_factor;
+    vt_options.depth = options_.vocabulary_tree_depth;
+    vt_options.max_num_features_for_training =
+        options_.max_num_features_for_vocabulary_tree_training;
+    vocabulary_tree_ = new VocabularyTree(vt_options);
+    global_image_descriptor_extractor_.reset(vocabulary_tree_);
+  } else if (options_.select_image_pairs_with_global_image_descriptor_matching) {
     FisherVectorExtractor::Options fv_options;
     fv_options.num_gmm_clusters = options_.num_gmm_clusters_for_fisher_vector;
     fv_options.max_num_features_for_training =
         options_.max_num_features_for_fisher_vector_training;
+    fv_options.num_threads = options_.num_threads;
     global_image_descriptor_extractor_.reset(
         new FisherVectorExtractor(fv_options));
   }
@@ -215,43 +262,154 @@ void FeatureExtractorAndMatcher::SetPairsToMatch(
   matcher_->SetImagePairsToMatch(image_pairs);
 }
 
+void FeatureExtractorAndMatcher::SetImagePositionPrior(
+    const std::string& image_filepath, const Eigen::Vector3d& position) {
+  std::string image_filename;
+  CHECK(GetFilenameFromFilepath(image_filepath, true, &image_filename));
+  image_position_priors_[image_filename] = position;
+}
+
+void FeatureExtractorAndMatcher::SetImageTimestamp(
+    const std::string& image_filepath, const double timestamp) {
+  std::string image_filename;
+  CHECK(GetFilenameFromFilepath(image_filepath, true, &image_filename));
+  image_timestamps_[image_filename] = timestamp;
+}
+
 // Performs feature matching between all images provided by the image
 // filepaths. Features are extracted and matched between the images according to
 // the options passed in. Only matches that have passed geometric verification
 // are kept.
 void FeatureExtractorAndMatcher::ExtractAndMatchFeatures() {
+  THEIA_TRACE_SCOPE("FeatureExtractorAndMatcher::ExtractAndMatchFeatures");
   CHECK_NOTNULL(matcher_.get());
-
-  // For each image, process the features and add it to the matcher.
+  CHECK_GT(options_.num_decode_threads, 0);
+  CHECK_GT(options_.num_write_threads, 0);
+  CHECK_GT(options_.max_num_queued_images, 0);
+
+  // Decoding is bound by I/O and extraction by the CPU, so each stage of the
+  // feature extraction runs in its own thread pool. Images whose features are
+  // already in the database skip the extraction stage.
+  // If there are fewer images than threads, the remaining extraction threads
+  // are used within each image.
+  const int num_images = image_filepaths_.size();
+  num_threads_per_image_ = NumThreadsPerImage(options_.num_threads, num_images);
   const int num_threads =
-      std::min(options_.num_threads, static_cast<int>(image_filepaths_.size()));
-  std::unique_ptr<ThreadPool> thread_pool(new ThreadPool(num_threads));
-  for (int i = 0; i < image_filepaths_.size(); i++) {
-    if (!FileExists(image_filepaths_[i])) {
-      LOG(ERROR) << "Could not extract features for " << image_filepaths_[i]
-                 << " because the file cannot be found.";
-      continue;
-    }
-    thread_pool->Add(&FeatureExtractorAndMatcher::ProcessImage, this, i);
+      std::max(1, options_.num_threads / num_threads_per_image_);
+  out_of_order_images_.clear();
+  out_of_order_images_.resize(num_images);
+  is_image_finished_.assign(num_images, false);
+  next_image_to_add_ = 0;
+  BoundedQueue<std::unique_ptr<ImageToProcess>> decoded_images(
+      options_.max_num_queued_images);
+  BoundedQueue<std::unique_ptr<ImageToProcess>> extracted_images(
+      options_.max_num_queued_images);
+
+  std::atomic<int> next_image(0);
+  std::unique_ptr<ThreadPool> decode_pool(
+      new ThreadPool(options_.num_decode_threads));
+  for (int i = 0; i < options_.num_decode_threads; i++) {
+    decode_pool->Add([&]() {
+      for (int image_index = next_image++; image_index < num_images;
+           image_index = next_image++) {
+        std::unique_ptr<ImageToProcess> image(new ImageToProcess);
+        if (!DecodeImage(image_index, image.get())) {
+          FinishImage(image_index, nullptr);
+          continue;
+        }
+        if (image->extract_features) {
+          decoded_images.Push(std::move(image));
+        } else {
+          extracted_images.Push(std::move(image));
+        }
+      }
+    });
+  }
+
+  std::unique_ptr<ThreadPool> extract_pool(new ThreadPool(num_threads));
+  for (int i = 0; i < num_threads; i++) {
+    extract_pool->Add([&]() {
+      std::unique_ptr<ImageToProcess> image;
+      while (decoded_images.Pop(&image)) {
+        if (ExtractImageFeatures(image.get())) {
+          extracted_images.Push(std::move(image));
+        } else {
+          FinishImage(image->index, nullptr);
+        }
+      }
+    });
+  }
+
+  std::unique_ptr<ThreadPool> write_pool(
+      new ThreadPool(options_.num_write_threads));
+  for (int i = 0; i < options_.num_write_threads; i++) {
+    write_pool->Add([&]() {
+      std::unique_ptr<ImageToProcess> image;
+      while (extracted_images.Pop(&image)) {
+        StoreImageFeatures(std::move(image));
+      }
+    });
+  }
+
+  // Each stage finishes once the stage before it finished and its input queue
+  // is drained. Destroying a thread pool waits for all of its tasks.
+  decode_pool.reset(nullptr);
+  decoded_images.Close();
+  extract_pool.reset(nullptr);
+  extracted_images.Close();
+  write_pool.reset(nullptr);
+  CHECK_EQ(next_image_to_add_, num_images);
+  out_of_order_images_.clear();
+  if (!options_.match_features) {
+    return;
   }
-  // This forces all tasks to complete before proceeding.
-  thread_pool.reset(nullptr);
 
   // After all threads complete feature extraction, perform matching.
-  SelectImagePairsWithGlobalDescriptorMatching();
+  if (options_.select_image_pairs_sequentially) {
+    LOG(INFO) << "Matching images sequentially...";
+    MatchImagesSequentially();
+    global_image_descriptor_extractor_.reset();
+    vocabulary_tree_ = nullptr;
+    return;
+  }
+
+  std::vector<std::pair<std::string, std::string> > image_pairs;
+  if (options_.select_image_pairs_with_global_image_descriptor_matching) {
+    SelectImagePairsWithGlobalDescriptorMatching(&image_pairs);
+    if (options_.rerank_retrieved_image_pairs) {
+      RerankRetrievedImagePairs(&image_pairs);
+    }
+  }
   // Free up memory.
-  global_image_descriptor_extractor_.release();
+  global_image_descriptor_extractor_.reset();
+  vocabulary_tree_ = nullptr;
+
+  if (options_.select_image_pairs_with_position_priors) {
+    SelectImagePairsWithPositionPriors(&image_pairs);
+  }
+  if (options_.select_image_pairs_with_global_image_descriptor_matching ||
+      options_.select_image_pairs_with_position_priors) {
+    matcher_->SetImagePairsToMatch(image_pairs);
+  }
 
   LOG(INFO) << "Matching images...";
   matcher_->MatchImages();
 }
 
-void FeatureExtractorAndMatcher::ProcessImage(const int i) {
-  const std::string& image_filepath = image_filepaths_[i];
+bool FeatureExtractorAndMatcher::DecodeImage(const int i,
+                                             ImageToProcess* image) {
+  image->index = i;
+  image->image_filepath = image_filepaths_[i];
+  const std::string& image_filepath = image->image_filepath;
+  if (!FileExists(image_filepath)) {
+    LOG(ERROR) << "Could not extract features for " << image_filepath
+               << " because the file cannot be found.";
+    return false;
+  }
 
   // Get the image filename without the directory.
-  std::string image_filename;
-  CHECK(GetFilenameFromFilepath(image_filepath, true, &image_filename));
+  CHECK(GetFilenameFromFilepath(image_filepath, true, &image->image_filename));
+  const std::string& image_filename = image->image_filename;
 
   // Get the camera intrinsics prior if it was provided.
   CameraIntrinsicsPrior intrinsics;
@@ -262,8 +420,7 @@ void FeatureExtractorAndMatcher::ProcessImage(const int i) {
   }
 
   // Get the associated mask if it was provided.
-  const std::string mask_filepath =
-      FindWithDefault(image_masks_, image_filepath, "");
+  image->mask_filepath = FindWithDefault(image_masks_, image_filepath, "");
 
   //  // Extract an EXIF focal length if it was not provided.
   //  if (!intrinsics.focal_length.is_set) {
@@ -288,7 +445,7 @@ void FeatureExtractorAndMatcher::ProcessImage(const int i) {
   if (options_.only_calibrated_views && !intrinsics.focal_length.is_set) {
     LOG(INFO) << "Image " << image_filepath
               << " did not contain an EXIF focal length. Skipping this image.";
-    return;
+    return false;
   } else {
     LOG(INFO) << "Image " << image_filepath
               << " is initialized with the focal length: "
@@ -298,67 +455,268 @@ void FeatureExtractorAndMatcher::ProcessImage(const int i) {
                                                              intrinsics);
   }
 
-  // Extract the features if necessary.
+  // Only decode the image if its features have to be extracted.
   if (features_and_matches_database_->ContainsFeatures(image_filename)) {
     VLOG(1) << "Loading features for " << image_filename
             << " from the features and matches database.";
-  } else {
-    // Extract Features.
-    KeypointsAndDescriptors features;
-    features.image_name = image_filename;
-    ExtractFeatures(options_,
-                    image_filepath,
-                    mask_filepath,
-                    &features.keypoints,
-                    &features.descriptors);
-
-    // Skip the image if not descriptors were extracted.
-    if (features.descriptors.size() == 0) {
-      return;
+    image->extract_features = false;
+    if (options_.select_image_pairs_with_global_image_descriptor_matching) {
+      image->features =
+          features_and_matches_database_->GetSharedFeatures(image_filename);
+    }
+    return true;
+  }
+
+  return true;
+}
+
+bool FeatureExtractorAndMatcher::ExtractImageFeatures(ImageToProcess* image) {
+  THEIA_TRACE_SCOPE("FeatureExtractorAndMatcher::ExtractImageFeatures");
+  std::shared_ptr<KeypointsAndDescriptors> features =
+      std::make_shared<KeypointsAndDescriptors>();
+  features->image_name = image->image_filename;
+  std::vector<Eigen::VectorXf> descriptors;
+  ExtractFeatures(options_,
+                  num_threads_per_image_,
+                  image->image_filepath,
+                  image->mask_filepath,
+                  &features->keypoints,
+                  &descriptors);
+  // The decoded image is not needed anymore.
+  //  image->image.reset();
+
+  // Skip the image if not descriptors were extracted.
+  if (descriptors.size() == 0) {
+    return false;
+  }
+  features->SetDescriptors(descriptors);
+  if (options_.quantize_descriptors) {
+    features->QuantizeDescriptors();
+  }
+  image->features = features;
+
+  static Counter* const num_images_extracted = Metrics::GetCounter(
+      "theia_images_extracted_total", "Images whose features were extracted.");
+  num_images_extracted->Increment();
+  return true;
+}
+
+void FeatureExtractorAndMatcher::StoreImageFeatures(
+    std::unique_ptr<ImageToProcess> image) {
+  // Add the features to the DB.
+  if (image->extract_features) {
+    features_and_matches_database_->PutFeatures(image->image_filename,
+                                                 *image->features);
+  }
+  const int image_index = image->index;
+  FinishImage(image_index, std::move(image));
+}
+
+void FeatureExtractorAndMatcher::FinishImage(
+    const int image_index, std::unique_ptr<ImageToProcess> image) {
+  std::lock_guard<std::mutex> lock(matcher_mutex_);
+  if (!options_.deterministic) {
+    if (image != nullptr) {
+      AddImageToMatcher(*image);
     }
+    next_image_to_add_++;
+    return;
+  }
 
-    // Add the features to the DB.
-    features_and_matches_database_->PutFeatures(image_filename, features);
+  // Hold the image back until all images before it are finished, then add
+  // all consecutive finished images.
+  out_of_order_images_[image_index] = std::move(image);
+  is_image_finished_[image_index] = true;
+  while (next_image_to_add_ < static_cast<int>(is_image_finished_.size()) &&
+         is_image_finished_[next_image_to_add_]) {
+    std::unique_ptr<ImageToProcess>& next_image =
+        out_of_order_images_[next_image_to_add_];
+    if (next_image != nullptr) {
+      AddImageToMatcher(*next_image);
+      next_image.reset();
+    }
+    next_image_to_add_++;
   }
+}
 
+void FeatureExtractorAndMatcher::AddImageToMatcher(
+    const ImageToProcess& image) {
   // Add the descriptors to the global image descriptor extractor for training
-  // if using a global image descriptor extractor.
+  // if using a global image descriptor extractor. The features are handed over
+  // by the previous stages so they are not read back from the database.
   if (options_.select_image_pairs_with_global_image_descriptor_matching) {
-    const KeypointsAndDescriptors& features =
-        features_and_matches_database_->GetFeatures(image_filename);
-    CHECK_GT(features.descriptors.size(), 0);
+    CHECK_GT(image.features->NumDescriptors(), 0);
     global_image_descriptor_extractor_->AddFeaturesForTraining(
-        features.descriptors);
+        image.features->GetDescriptors());
   }
 
   // Add the image to the matcher.
-  std::lock_guard<std::mutex> lock(matcher_mutex_);
-  matcher_->AddImage(image_filename);
-  return;
+  matcher_->AddImage(image.image_filename);
 }
 
 void FeatureExtractorAndMatcher::ExtractGlobalDesriptors(
     const std::vector<std::string>& image_names,
-    std::vector<Eigen::VectorXf>* global_descriptors) {
-  // Extract the global descriptors in parallel.
-  ThreadPool pool(options_.num_threads);
-  global_descriptors->resize(image_names.size());
-  for (int i = 0; i < image_names.size(); i++) {
-    pool.Add(
-        [&](const int i) {
+    const PrincipalComponentAnalysis* pca,
+    Eigen::MatrixXf* global_descriptors) {
+  // The global descriptors are extracted in batches of images, which lets the
+  // extractor reuse its buffers and read the descriptors without copying them.
+  static const int kBatchSize = 16;
+  const auto extract_global_descriptors =
+      [&](const int start,
+          const int end,
+          std::vector<Eigen::VectorXf>* batch_descriptors) {
+        std::vector<std::shared_ptr<const KeypointsAndDescriptors> > features;
+        features.reserve(end - start);
+        for (int i = start; i < end; i++) {
+          features.emplace_back(
+              features_and_matches_database_->GetSharedFeatures(
+                  image_names[i]));
+        }
+        global_image_descriptor_extractor_->ExtractGlobalDescriptors(
+            features, batch_descriptors);
+      };
+  if (image_names.empty()) {
+    global_descriptors->resize(0, 0);
+    return;
+  }
+
+  // The dimension of uncompressed descriptors is only known once the first
+  // one is extracted.
+  int first_image = 0;
+  if (pca != nullptr) {
+    global_descriptors->resize(pca->NumComponents(), image_names.size());
+  } else {
+    std::vector<Eigen::VectorXf> first_descriptor;
+    extract_global_descriptors(0, 1, &first_descriptor);
+    global_descriptors->resize(first_descriptor[0].size(), image_names.size());
+    global_descriptors->col(0) = first_descriptor[0];
+    first_image = 1;
+  }
+
+  // Extract the global descriptors in parallel. Only the compressed
+  // descriptors are kept, so the full descriptors of all images are never held
+  // in memory at once.
+  ParallelFor(
+      options_.num_threads,
+      image_names.size() - first_image,
+      [&](const int start, const int end) {
+        std::vector<Eigen::VectorXf> batch_descriptors;
+        for (int batch_start = first_image + start;
+             batch_start < first_image + end;
+             batch_start += kBatchSize) {
+          const int batch_end =
+              std::min(batch_start + kBatchSize, first_image + end);
+          extract_global_descriptors(
+              batch_start, batch_end, &batch_descriptors);
+          for (int i = batch_start; i < batch_end; i++) {
+            const Eigen::VectorXf& global_descriptor =
+                batch_descriptors[i - batch_start];
+            if (pca == nullptr) {
+              global_descriptors->col(i) = global_descriptor;
+            } else {
+              global_descriptors->col(i) = pca->Project(global_descriptor);
+              global_descriptors->col(i).normalize();
+            }
+          }
+        }
+      });
+}
+
+void FeatureExtractorAndMatcher::FindNearestNeighborsWithGlobalDescriptors(
+    const std::vector<std::string>& image_names,
+    const int num_nearest_neighbors,
+    std::vector<std::vector<int> >* nearest_neighbors) {
+  // Compress the global descriptors with a PCA fitted to the descriptors of
+  // evenly spaced images.
+  std::unique_ptr<PrincipalComponentAnalysis> pca;
+  if (options_.global_descriptor_pca_dimension > 0 && image_names.size() > 2) {
+    THEIA_TRACE_SCOPE("FeatureExtractorAndMatcher::FitGlobalDescriptorPca");
+    const int num_training_images =
+        std::min(static_cast<int>(image_names.size()),
+                 options_.max_num_images_for_global_descriptor_pca);
+    std::vector<std::string> training_image_names(num_training_images);
+    for (int i = 0; i < num_training_images; i++) {
+      training_image_names[i] = image_names[static_cast<int64_t>(i) *
+                                            image_names.size() /
+                                            num_training_images];
+    }
+    Eigen::MatrixXf training_descriptors;
+    ExtractGlobalDesriptors(
+        training_image_names, nullptr, &training_descriptors);
+
+    VLOG(2) << "Compressing global descriptors of dimension "
+            << training_descriptors.rows() << " to "
+            << options_.global_descriptor_pca_dimension
+            << " dimensions with a PCA of " << num_training_images
+            << " images...";
+    PrincipalComponentAnalysis::Options pca_options;
+    pca_options.num_components = options_.global_descriptor_pca_dimension;
+    pca_options.num_threads = options_.num_threads;
+    pca.reset(new PrincipalComponentAnalysis());
+    CHECK(pca->Fit(pca_options, training_descriptors));
+  }
+
+  // Extract global image descriptors.
+  Eigen::MatrixXf global_descriptors;
+  ExtractGlobalDesriptors(image_names, pca.get(), &global_descriptors);
+
+  VLOG(2) << "Computing image-to-image similarity scores with global "
+             "descriptors...";
+
+  // Match all pairs of global descriptors. For each image, the K most similar
+  // image (i.e. the ones with the lowest distance between global descriptors)
+  // are set for matching.
+  FindNearestNeighborsOfGlobalDescriptors(global_descriptors,
+                                          num_nearest_neighbors,
+                                          options_.num_threads,
+                                          nearest_neighbors);
+}
+
+void FeatureExtractorAndMatcher::FindNearestNeighborsWithVocabularyTree(
+    const std::vector<std::string>& image_names,
+    const int num_nearest_neighbors,
+    std::vector<std::vector<int> >* nearest_neighbors) {
+  // Index all images in the inverted file of the vocabulary tree.
+  ParallelFor(options_.num_threads,
+              image_names.size(),
+              [&](const int start, const int end) {
+                for (int i = start; i < end; i++) {
+                  const KeypointsAndDescriptors& features =
+                      features_and_matches_database_->GetFeatures(
+                          image_names[i]);
+                  vocabulary_tree_->AddImage(i, features.GetDescriptors());
+                }
+              });
+
+  VLOG(2) << "Querying the vocabulary tree for the nearest neighbors of "
+          << image_names.size() << " images...";
+
+  // Each image is its own best match so one extra neighbor is retrieved.
+  nearest_neighbors->resize(image_names.size());
+  ParallelFor(
+      options_.num_threads,
+      image_names.size(),
+      [&](const int start, const int end) {
+        for (int i = start; i < end; i++) {
           const KeypointsAndDescriptors& features =
               features_and_matches_database_->GetFeatures(image_names[i]);
-          // Extract the global descriptors
-          (*global_descriptors)[i] =
-              global_image_descriptor_extractor_->ExtractGlobalDescriptor(
-                  features.descriptors);
-        },
-        i);
-  }
+          std::vector<std::pair<float, int> > results;
+          vocabulary_tree_->Query(
+              features.GetDescriptors(), num_nearest_neighbors + 1, &results);
+          for (const auto& result : results) {
+            if (result.second != i &&
+                (*nearest_neighbors)[i].size() < num_nearest_neighbors) {
+              (*nearest_neighbors)[i].emplace_back(result.second);
+            }
+          }
+        }
+      });
 }
 
-void FeatureExtractorAndMatcher::
-    SelectImagePairsWithGlobalDescriptorMatching() {
+void FeatureExtractorAndMatcher::SelectImagePairsWithGlobalDescriptorMatching(
+    std::vector<std::pair<std::string, std::string> >* image_names_to_match) {
+  THEIA_TRACE_SCOPE("FeatureExtractorAndMatcher::"
+                    "SelectImagePairsWithGlobalDescriptorMatching");
   // Train the global descriptor extractor based on the input features.
   VLOG(2) << "Training global image descriptor...";
   CHECK(global_image_descriptor_extractor_->Train());
@@ -367,44 +725,23 @@ void FeatureExtractorAndMatcher::
   const std::vector<std::string> image_names =
       features_and_matches_database_->ImageNamesOfFeatures();
 
-  // Extract global image descriptors.
-  std::vector<Eigen::VectorXf> global_descriptors;
-  ExtractGlobalDesriptors(image_names, &global_descriptors);
-
-  VLOG(2) << "Computing image-to-image similarity scores with global "
-             "descriptors...";
-
   // For each image, find the kNN and add those to our selection for matching.
   const int num_nearest_neighbors =
       std::min(static_cast<int>(image_names.size() - 1),
                options_.num_nearest_neighbors_for_global_descriptor_matching);
+  std::vector<std::vector<int> > nearest_neighbors;
+  if (vocabulary_tree_ != nullptr) {
+    FindNearestNeighborsWithVocabularyTree(
+        image_names, num_nearest_neighbors, &nearest_neighbors);
+  } else {
+    FindNearestNeighborsWithGlobalDescriptors(
+        image_names, num_nearest_neighbors, &nearest_neighbors);
+  }
 
   std::unordered_map<int, MatchedImages> pairs_to_match;
-
-  // Match all pairs of global descriptors. For each image, the K most similar
-  // image (i.e. the ones with the lowest distance between global descriptors)
-  // are set for matching.
-  std::vector<std::vector<std::pair<float, int>>> global_matching_scores(
-      global_descriptors.size());
-  for (int i = 0; i < global_descriptors.size(); i++) {
-    // Compute the matching scores between all (i, j) pairs.
-    for (int j = i + 1; j < global_descriptors.size(); j++) {
-      const float global_feature_match_score =
-          (global_descriptors[i] - global_descriptors[j]).squaredNorm();
-      // Add the global feature matching score to both images.
-      global_matching_scores[i].emplace_back(global_feature_match_score, j);
-      global_matching_scores[j].emplace_back(global_feature_match_score, i);
-    }
-
-    // Find the top K matching results for image i.
-    std::partial_sort(global_matching_scores[i].begin(),
-                      global_matching_scores[i].begin() + num_nearest_neighbors,
-                      global_matching_scores[i].end());
-
+  for (int i = 0; i < nearest_neighbors.size(); i++) {
     // Add each of the kNN to the output indices.
-    for (int j = 0; j < num_nearest_neighbors; j++) {
-      const int second_id = global_matching_scores[i][j].second;
-
+    for (const int second_id : nearest_neighbors[i]) {
       // Perform query expansion by adding image i as a candidate match to all
       // of its matches neighbors.
       const auto& neighbors_of_second_id =
@@ -418,39 +755,241 @@ void FeatureExtractorAndMatcher::
       pairs_to_match[i].ranked_matches.insert(second_id);
       pairs_to_match[second_id].ranked_matches.insert(i);
     }
-
-    // Remove the matching scores for image i to free up memory.
-    global_matching_scores[i].clear();
   }
 
   // Collect all matches into one container.
-  std::vector<std::pair<std::string, std::string>> image_names_to_match;
-  image_names_to_match.reserve(num_nearest_neighbors *
-                               global_descriptors.size());
+  image_names_to_match->clear();
+  image_names_to_match->reserve(num_nearest_neighbors * image_names.size());
   for (const auto& matches : pairs_to_match) {
     for (const int match : matches.second.ranked_matches) {
       if (matches.first < match) {
-        image_names_to_match.emplace_back(image_names[matches.first],
-                                          image_names[match]);
+        image_names_to_match->emplace_back(image_names[matches.first],
+                                           image_names[match]);
       }
     }
 
     for (const int match : matches.second.expanded_matches) {
       if (matches.first < match) {
-        image_names_to_match.emplace_back(image_names[matches.first],
-                                          image_names[match]);
+        image_names_to_match->emplace_back(image_names[matches.first],
+                                           image_names[match]);
       }
     }
   }
 
   // Uniquify the matches.
-  std::sort(image_names_to_match.begin(), image_names_to_match.end());
-  image_names_to_match.erase(
-      std::unique(image_names_to_match.begin(), image_names_to_match.end()),
-      image_names_to_match.end());
+  std::sort(image_names_to_match->begin(), image_names_to_match->end());
+  image_names_to_match->erase(
+      std::unique(image_names_to_match->begin(), image_names_to_match->end()),
+      image_names_to_match->end());
+}
 
-  // Tell the matcher which pairs to match.
-  matcher_->SetImagePairsToMatch(image_names_to_match);
+void FeatureExtractorAndMatcher::RerankRetrievedImagePairs(
+    std::vector<std::pair<std::string, std::string> >* image_pairs) {
+  THEIA_TRACE_SCOPE("FeatureExtractorAndMatcher::RerankRetrievedImagePairs");
+  // Index the images of the pairs.
+  std::vector<std::string> image_names;
+  std::unordered_map<std::string, int> image_indices;
+  const auto image_index = [&](const std::string& image_name) {
+    if (InsertIfNotPresent(&image_indices, image_name, image_names.size())) {
+      image_names.emplace_back(image_name);
+    }
+    return image_indices[image_name];
+  };
+  std::vector<std::pair<int, int> > indexed_pairs;
+  indexed_pairs.reserve(image_pairs->size());
+  for (const auto& image_pair : *image_pairs) {
+    indexed_pairs.emplace_back(image_index(image_pair.first),
+                               image_index(image_pair.second));
+  }
+
+  // Only the subsampled features of each image are kept in memory.
+  SpatialRerankingOptions reranking_options =
+      options_.spatial_reranking_options;
+  reranking_options.num_threads = options_.num_threads;
+  std::vector<SpatialRerankingFeatures> features(image_names.size());
+  ParallelFor(options_.num_threads,
+              image_names.size(),
+              [&](const int start, const int end) {
+                for (int i = start; i < end; i++) {
+                  SelectSpatialRerankingFeatures(
+                      reranking_options,
+                      features_and_matches_database_->GetFeatures(
+                          image_names[i]),
+                      &features[i]);
+                }
+              });
+
+  RerankImagePairs(reranking_options, features, &indexed_pairs);
+  image_pairs->clear();
+  image_pairs->reserve(indexed_pairs.size());
+  for (const auto& indexed_pair : indexed_pairs) {
+    image_pairs->emplace_back(image_names[indexed_pair.first],
+                              image_names[indexed_pair.second]);
+  }
+}
+
+void FeatureExtractorAndMatcher::SelectImagePairsWithPositionPriors(
+    std::vector<std::pair<std::string, std::string> >* image_pairs) {
+  THEIA_TRACE_SCOPE(
+      "FeatureExtractorAndMatcher::SelectImagePairsWithPositionPriors");
+  // Gather the positions of all images with features and a position prior.
+  std::vector<std::string> image_names;
+  std::vector<Eigen::Vector3d> positions;
+  for (const std::string& image_name :
+       features_and_matches_database_->ImageNamesOfFeatures()) {
+    const Eigen::Vector3d* position =
+        FindOrNull(image_position_priors_, image_name);
+    if (position != nullptr) {
+      image_names.emplace_back(image_name);
+      positions.emplace_back(*position);
+    }
+  }
+
+  std::vector<std::pair<int, int> > spatial_pairs;
+  theia::SelectImagePairsWithPositionPriors(
+      options_.spatial_pair_selection_options, positions, &spatial_pairs);
+  std::set<std::pair<std::string, std::string> > spatial_image_pairs;
+  for (const auto& spatial_pair : spatial_pairs) {
+    const std::string& image1 = image_names[spatial_pair.first];
+    const std::string& image2 = image_names[spatial_pair.second];
+    spatial_image_pairs.emplace(std::min(image1, image2),
+                                std::max(image1, image2));
+  }
+  VLOG(1) << "Selected " << spatial_image_pairs.size()
+          << " image pairs from the position priors of " << positions.size()
+          << " images.";
+
+  if (!options_.select_image_pairs_with_global_image_descriptor_matching) {
+    image_pairs->assign(spatial_image_pairs.begin(),
+                        spatial_image_pairs.end());
+    return;
+  }
+
+  // Combine the spatial pairs with the retrieved pairs. Retrieved pairs with an
+  // image that has no position prior cannot be checked and are always kept.
+  std::vector<std::pair<std::string, std::string> > combined_pairs;
+  for (const auto& image_pair : *image_pairs) {
+    const bool has_position_priors =
+        ContainsKey(image_position_priors_, image_pair.first) &&
+        ContainsKey(image_position_priors_, image_pair.second);
+    const std::pair<std::string, std::string> sorted_pair(
+        std::min(image_pair.first, image_pair.second),
+        std::max(image_pair.first, image_pair.second));
+    if (!has_position_priors ||
+        !options_.intersect_spatial_pairs_with_retrieval ||
+        spatial_image_pairs.count(sorted_pair) > 0) {
+      combined_pairs.emplace_back(sorted_pair);
+    }
+  }
+  if (!options_.intersect_spatial_pairs_with_retrieval) {
+    combined_pairs.insert(combined_pairs.end(),
+                          spatial_image_pairs.begin(),
+                          spatial_image_pairs.end());
+  }
+  std::sort(combined_pairs.begin(), combined_pairs.end());
+  combined_pairs.erase(std::unique(combined_pairs.begin(), combined_pairs.end()),
+                       combined_pairs.end());
+  VLOG(1) << combined_pairs.size() << " image pairs remain after combining the "
+          << image_pairs->size() << " retrieved image pairs with the spatial "
+          << "image pairs.";
+  image_pairs->swap(combined_pairs);
+}
+
+void FeatureExtractorAndMatcher::MatchImagesSequentially() {
+  THEIA_TRACE_SCOPE("FeatureExtractorAndMatcher::MatchImagesSequentially");
+  // Order the images by their timestamps. Images with equal (or no) timestamps
+  // keep the order in which they were added.
+  std::vector<std::string> image_names;
+  image_names.reserve(image_filepaths_.size());
+  for (const std::string& image_filepath : image_filepaths_) {
+    std::string image_filename;
+    CHECK(GetFilenameFromFilepath(image_filepath, true, &image_filename));
+    if (features_and_matches_database_->ContainsFeatures(image_filename)) {
+      image_names.emplace_back(image_filename);
+    }
+  }
+  std::stable_sort(image_names.begin(),
+                   image_names.end(),
+                   [this](const std::string& image1, const std::string& image2) {
+                     return FindWithDefault(image_timestamps_, image1, 0.0) <
+                            FindWithDefault(image_timestamps_, image2, 0.0);
+                   });
+
+  // Retrieved neighbors that are too far apart in time to be matched within a
+  // window are matched as loop closure candidates.
+  const int max_window_size =
+      options_.sequential_pair_selector_options.max_window_size;
+  std::vector<std::pair<std::string, std::string> > image_pairs;
+  if (options_.select_image_pairs_with_global_image_descriptor_matching &&
+      image_names.size() > 1) {
+    VLOG(2) << "Training global image descriptor...";
+    CHECK(global_image_descriptor_extractor_->Train());
+    const int num_nearest_neighbors = std::min(
+        static_cast<int>(image_names.size() - 1),
+        options_.num_nearest_neighbors_for_global_descriptor_matching);
+    std::vector<std::vector<int> > nearest_neighbors;
+    if (vocabulary_tree_ != nullptr) {
+      FindNearestNeighborsWithVocabularyTree(
+          image_names, num_nearest_neighbors, &nearest_neighbors);
+    } else {
+      FindNearestNeighborsWithGlobalDescriptors(
+          image_names, num_nearest_neighbors, &nearest_neighbors);
+    }
+
+    std::set<std::pair<int, int> > loop_closures;
+    for (int i = 0; i < nearest_neighbors.size(); i++) {
+      for (const int j : nearest_neighbors[i]) {
+        if (std::abs(i - j) > max_window_size) {
+          loop_closures.emplace(std::min(i, j), std::max(i, j));
+        }
+      }
+    }
+    for (const auto& loop_closure : loop_closures) {
+      image_pairs.emplace_back(image_names[loop_closure.first],
+                               image_names[loop_closure.second]);
+    }
+    VLOG(1) << "Selected " << image_pairs.size()
+            << " loop closure candidates with global descriptors.";
+  }
+
+  // Match the windows in rounds until no window grows anymore. The loop
+  // closure candidates are matched along with the first round.
+  SequentialPairSelector pair_selector(
+      options_.sequential_pair_selector_options, image_names.size());
+  while (true) {
+    const std::vector<std::pair<int, int> >& pairs =
+        pair_selector.NextPairsToMatch();
+    for (const auto& pair : pairs) {
+      image_pairs.emplace_back(image_names[pair.first],
+                               image_names[pair.second]);
+    }
+    if (image_pairs.empty()) {
+      break;
+    }
+
+    VLOG(1) << "Matching " << image_pairs.size() << " image pairs.";
+    matcher_->SetImagePairsToMatch(image_pairs);
+    matcher_->MatchImages();
+    image_pairs.clear();
+
+    // Only successfully matched pairs are stored in the database.
+    std::set<std::pair<std::string, std::string> > matched_pairs;
+    for (const auto& match_key :
+         features_and_matches_database_->ImageNamesOfMatches()) {
+      matched_pairs.insert(match_key);
+    }
+    std::vector<int> num_verified_matches(pairs.size(), 0);
+    for (int i = 0; i < pairs.size(); i++) {
+      const std::string& image1 = image_names[pairs[i].first];
+      const std::string& image2 = image_names[pairs[i].second];
+      if (matched_pairs.count(std::make_pair(image1, image2)) > 0) {
+        num_verified_matches[i] =
+            features_and_matches_database_->GetImagePairMatch(image1, image2)
+                .correspondences.size();
+      }
+    }
+    pair_selector.UpdateWindows(num_verified_matches);
+  }
 }
 
 }  // namespace theia
@@ -37,20 +37,30 @@
 
 #include <Eigen/Core>
 #include <mutex>  // NOLINT
+#include <memory>
+#include <mutex>  // NOLINT
 #include <string>
 #include <thread>  // NOLINT
+#include <unordered_map>
 #include <vector>
 
 #include "theia/image/descriptor/create_descriptor_extractor.h"
+#include "theia/image/descriptor/tiled_descriptor_extractor.h"
 #include "theia/matching/create_feature_matcher.h"
 #include "theia/matching/feature_matcher.h"
 #include "theia/matching/feature_matcher_options.h"
+#include "theia/matching/global_descriptor_extractor.h"
+#include "theia/matching/sequential_pair_selector.h"
+#include "theia/matching/spatial_pair_selection.h"
+#include "theia/matching/spatial_reranking.h"
 //#include "theia/sfm/exif_reader.h"
 
 namespace theia {
-class GlobalDescriptorExtractor;
+class PrincipalComponentAnalysis;
+class VocabularyTree;
 struct CameraIntrinsicsPrior;
 struct ImagePairMatch;
+struct KeypointsAndDescriptors;
 
 class FeatureExtractorAndMatcher {
  public:
@@ -58,6 +68,25 @@ class FeatureExtractorAndMatcher {
     // Number of threads for multithreading.
     int num_threads = 1;
 
+    // Features are extracted in a pipeline of three stages that are connected
+    // by bounded queues: num_decode_threads threads load the images and their
+    // camera intrinsics, num_threads threads detect and describe the features,
+    // and num_write_threads threads store the features in the database and add
+    // the images to the matcher. Each queue holds at most
+    // max_num_queued_images images, so a slow stage blocks the stages before it
+    // instead of accumulating decoded images in memory.
+    int num_decode_threads = 1;
+    int num_write_threads = 1;
+    int max_num_queued_images = 8;
+
+    // If true, the images are added to the matcher and to the training set of
+    // the global descriptor extractor in the order in which they were added
+    // with AddImage rather than in the order in which their features are
+    // stored, so that the results do not depend on the thread scheduling. The
+    // features are still extracted and stored in parallel; images that finish
+    // early wait (with their features) until all images before them are done.
+    bool deterministic = false;
+
     // If true, only images that contain EXIF focal length values have features
     // extracted and matched, and images that do not contain EXIF focal length
     // are not considered for the feature extraction and matching.
@@ -72,9 +101,27 @@ class FeatureExtractorAndMatcher {
     // extracted.
     FeatureDensity feature_density = FeatureDensity::NORMAL;
 
-    // The features returned will be no larger than this size.
+    // The features returned will be no larger than this size. SIFT keypoints
+    // are selected uniformly over the image by their response before their
+    // descriptors are computed, see SiftParameters::max_num_features.
     int max_num_features = 16384;
 
+    // If true, features are extracted from overlapping tiles that are read
+    // from the image file on demand instead of from the fully decoded image.
+    // This bounds the memory for very large images (e.g. aerial mosaics) and
+    // spreads the features uniformly with a per-tile feature budget. The tiles
+    // of an image are processed by the threads available to each image, see
+    // NumThreadsPerImage. Image masks are applied to each tile.
+    bool use_tiled_extraction = false;
+    TiledExtractionOptions tiled_extraction_options;
+
+    // If true, float descriptors (e.g. SIFT) are quantized to one byte per
+    // dimension before they are stored in the features and matches database.
+    // This cuts the storage and memory bandwidth of the descriptors by 4x. The
+    // brute force matcher matches quantized descriptors directly with integer
+    // distance kernels; other matchers dequantize them on the fly.
+    bool quantize_descriptors = false;
+
     // Minimum number of inliers to consider the matches a good match.
     int min_num_inlier_matches = 30;
 
@@ -94,6 +141,60 @@ class FeatureExtractorAndMatcher {
     // Specific options for Fisher Vector global feature extraction.
     int num_gmm_clusters_for_fisher_vector = 16;
     int max_num_features_for_fisher_vector_training = 1000000;
+
+    // Fisher vectors have 2 * num_gmm_clusters * descriptor dimension entries.
+    // If positive, they are compressed to this many dimensions with PCA
+    // whitening and L2 normalized before the nearest neighbors are searched,
+    // which makes the search much cheaper and usually improves retrieval. The
+    // PCA is fitted to the Fisher vectors of at most
+    // max_num_images_for_global_descriptor_pca evenly spaced images.
+    int global_descriptor_pca_dimension = 256;
+    int max_num_images_for_global_descriptor_pca = 10000;
+
+    // The global descriptor used to find the nearest neighbors of each image.
+    // Fisher vectors are compared between all pairs of images, which is
+    // quadratic in the number of images. The vocabulary tree indexes the images
+    // in an inverted file and only scores the images that share visual words
+    // with each query, which scales to much larger image collections.
+    GlobalDescriptorExtractorType global_descriptor_extractor_type =
+        GlobalDescriptorExtractorType::FISHER_VECTOR;
+
+    // Specific options for vocabulary tree global feature extraction. The
+    // vocabulary has at most branching_factor^depth visual words.
+    int vocabulary_tree_branching_factor = 10;
+    int vocabulary_tree_depth = 5;
+    int max_num_features_for_vocabulary_tree_training = 1000000;
+
+    // If true, the image pairs retrieved with global descriptor matching are
+    // re-ranked before they are matched: a small subsample of the features of
+    // the two images is matched and the pair is only kept if enough of these
+    // matches agree with a single similarity or affine transformation (see
+    // RerankImagePairs). This removes most of the retrieved pairs that do not
+    // overlap at a fraction of the cost of matching and verifying them.
+    bool rerank_retrieved_image_pairs = false;
+    SpatialRerankingOptions spatial_reranking_options;
+
+    // If true, the images are treated as a sequence (e.g., video frames) and
+    // each image is only matched to the images that follow it within an
+    // adaptive temporal window. Images are ordered by the timestamps set with
+    // SetImageTimestamp, or by the order in which they were added. If global
+    // descriptor matching is enabled as well, the retrieved nearest neighbors
+    // are matched as loop closure candidates.
+    bool select_image_pairs_sequentially = false;
+    SequentialPairSelector::Options sequential_pair_selector_options;
+
+    // If true, each image is only matched to its nearest neighbors according to
+    // the position priors set with SetImagePositionPrior (e.g., GPS positions
+    // in ECEF coordinates). If global descriptor matching is enabled as well,
+    // the retrieved pairs are intersected with the spatial pairs, or combined
+    // with them if intersect_spatial_pairs_with_retrieval is false. Retrieved
+    // pairs of images without position priors are always matched.
+    bool select_image_pairs_with_position_priors = false;
+    SpatialPairSelectionOptions spatial_pair_selection_options;
+    bool intersect_spatial_pairs_with_retrieval = true;
+
+    // If false, only the features are extracted and stored in the database.
+    bool match_features = true;
   };
 
   explicit FeatureExtractorAndMatcher(
@@ -120,6 +221,16 @@ class FeatureExtractorAndMatcher {
   void SetPairsToMatch(
       const std::vector<std::pair<std::string, std::string> >& pairs_to_match);
 
+  // Sets the capture time of an image, which determines the order of the
+  // images for sequential matching.
+  void SetImageTimestamp(const std::string& image_filepath,
+                         const double timestamp);
+
+  // Sets the position prior of an image, which is used to select image pairs if
+  // select_image_pairs_with_position_priors is true.
+  void SetImagePositionPrior(const std::string& image_filepath,
+                             const Eigen::Vector3d& position);
+
   // Performs feature matching between all images provided by the image
   // filepaths. Features are extracted and matched between the images according
   // to the options passed in. Only matches that have passed geometric
@@ -127,25 +238,107 @@ class FeatureExtractorAndMatcher {
   void ExtractAndMatchFeatures();
 
  protected:
-  // Processes a single image by extracting EXIF information, extracting
-  // features and descriptors, and adding the image to the matcher.
-  void ProcessImage(const int i);
+  // An image as it moves through the feature extraction pipeline.
+  struct ImageToProcess {
+    // The index of the image in image_filepaths_.
+    int index = -1;
+    std::string image_filepath;
+    std::string image_filename;
+    std::string mask_filepath;
+
+    // The decoded image.
+    // std::unique_ptr<FloatImage> image;
+
+    // True if the features have to be extracted, false if the database
+    // already contains them.
+    bool extract_features = true;
+
+    // The features of the image. They are handed from stage to stage so that
+    // no stage has to read them back from the database. Features that are
+    // already in the database are only loaded if the global descriptor
+    // extractor is trained on them.
+    std::shared_ptr<const KeypointsAndDescriptors> features;
+  };
+
+  // Decode stage: loads the image and its camera intrinsics (from the database
+  // or the EXIF metadata). If the database already contains the features of
+  // the image they are loaded instead, and the image skips the extraction
+  // stage. Returns false if the image should be skipped.
+  bool DecodeImage(const int i, ImageToProcess* image);
+
+  // Extraction stage: detects and describes the features of the decoded image.
+  // Returns false if no features were extracted.
+  bool ExtractImageFeatures(ImageToProcess* image);
+
+  // Write stage: stores the extracted features in the database and finishes
+  // the image.
+  void StoreImageFeatures(std::unique_ptr<ImageToProcess> image);
+
+  // Adds the features of the image to the global descriptor training set and
+  // the image to the matcher. A null image marks a skipped image. In
+  // deterministic mode the images are held back until all images with a
+  // smaller index are finished.
+  void FinishImage(const int image_index,
+                   std::unique_ptr<ImageToProcess> image);
+  void AddImageToMatcher(const ImageToProcess& image);
 
   // If global descriptor matching is used, select the best set of image pairs
   // to perform feature matching on. This dramatically speeds up the matching
   // pipeline over N^2 matching.
-  void SelectImagePairsWithGlobalDescriptorMatching();
-  void ExtractGlobalDesriptors(
+  void SelectImagePairsWithGlobalDescriptorMatching(
+      std::vector<std::pair<std::string, std::string> >* image_pairs);
+
+  // Removes the retrieved image pairs that fail the spatial re-ranking.
+  void RerankRetrievedImagePairs(
+      std::vector<std::pair<std::string, std::string> >* image_pairs);
+
+  // Selects the image pairs from the position priors. If global descriptor
+  // matching is enabled, image_pairs holds the retrieved pairs on input, which
+  // are combined with the spatial pairs.
+  void SelectImagePairsWithPositionPriors(
+      std::vector<std::pair<std::string, std::string> >* image_pairs);
+
+  // Matches each image to the subsequent images within its temporal window,
+  // growing the windows in rounds as described in SequentialPairSelector.
+  // Retrieved nearest neighbors are used as loop closure candidates if global
+  // descriptor matching is enabled.
+  void MatchImagesSequentially();
+
+  // Extracts the global descriptors of the images into the columns of the
+  // matrix. If pca is not null, the descriptors are projected with it and L2
+  // normalized.
+  void ExtractGlobalDesriptors(const std::vector<std::string>& image_names,
+                               const PrincipalComponentAnalysis* pca,
+                               Eigen::MatrixXf* global_descriptors);
+
+  // Finds the nearest neighbors of each image by comparing the (compressed)
+  // global descriptors of all pairs of images.
+  void FindNearestNeighborsWithGlobalDescriptors(
       const std::vector<std::string>& image_names,
-      std::vector<Eigen::VectorXf>* global_descriptors);
+      const int num_nearest_neighbors,
+      std::vector<std::vector<int> >* nearest_neighbors);
+
+  // Finds the nearest neighbors of each image by querying the inverted file of
+  // the vocabulary tree.
+  void FindNearestNeighborsWithVocabularyTree(
+      const std::vector<std::string>& image_names,
+      const int num_nearest_neighbors,
+      std::vector<std::vector<int> >* nearest_neighbors);
 
   const Options options_;
   FeaturesAndMatchesDatabase* features_and_matches_database_;
 
-  // Local copies of the images to be matches, masks for use and any priors on
-  // the camera intrinsics.
+  // The feature extraction threads are split between processing images in
+  // parallel and processing each image with multiple threads, see
+  // NumThreadsPerImage.
+  int num_threads_per_image_;
+
+  // Local copies of the images to be matches, masks for use, timestamps and any
+  // priors on the camera intrinsics and positions.
   std::vector<std::string> image_filepaths_;
   std::unordered_map<std::string, std::string> image_masks_;
+  std::unordered_map<std::string, double> image_timestamps_;
+  std::unordered_map<std::string, Eigen::Vector3d> image_position_priors_;
 
   // Exif reader for loading exif information. This object is created once so
   // that the EXIF focal length database does not have to be loaded multiple
@@ -156,10 +349,21 @@ class FeatureExtractorAndMatcher {
   // compact representation for each image and select a subset of kNN images to
   // perform explicit (and expensive) feature matching.
   std::unique_ptr<GlobalDescriptorExtractor> global_image_descriptor_extractor_;
+  // If the global descriptor extractor is a vocabulary tree, this points to it
+  // so that image pairs can be selected with its inverted file.
+  VocabularyTree* vocabulary_tree_;
 
-  // Feature matcher and mutex for thread-safe access.
+  // Feature matcher and mutex for thread-safe access. The mutex also guards
+  // the training set of the global image descriptor extractor.
   std::unique_ptr<FeatureMatcher> matcher_;
   std::mutex matcher_mutex_;
+
+  // The images that were finished out of order in deterministic mode, the
+  // images that are finished, and the index of the next image to add to the
+  // matcher. Guarded by matcher_mutex_.
+  std::vector<std::unique_ptr<ImageToProcess> > out_of_order_images_;
+  std::vector<bool> is_image_finished_;
+  int next_image_to_add_;
 };
 
 }  // namespace theia
@@ -37,111 +37,134 @@
 #include <Eigen/Core>
 #include <ceres/rotation.h>
 #include <glog/logging.h>
-#include <unordered_map>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <memory>
+#include <tuple>
+#include <unordered_set>
+#include <utility>
 #include <vector>
 
 #include "theia/math/graph/triplet_extractor.h"
 #include "theia/math/util.h"
 #include "theia/sfm/twoview_info.h"
 #include "theia/sfm/types.h"
+#include "theia/sfm/view_graph/compact_view_graph.h"
 #include "theia/sfm/view_graph/view_graph.h"
-#include "theia/sfm/view_triplet.h"
 #include "theia/util/hash.h"
+#include "theia/util/threadpool.h"
 
 namespace theia {
 namespace {
 
-double ComputeLoopRotationError(const TwoViewInfo& info_one_two,
-                                const TwoViewInfo& info_one_three,
-                                const TwoViewInfo& info_two_three) {
-  // Get relative rotation matrices.
-  Eigen::Matrix3d rotation1_2, rotation1_3, rotation2_3;
-  ceres::AngleAxisToRotationMatrix(
-      info_one_two.rotation_2.data(),
-      ceres::ColumnMajorAdapter3x3(rotation1_2.data()));
-  ceres::AngleAxisToRotationMatrix(
-      info_one_three.rotation_2.data(),
-      ceres::ColumnMajorAdapter3x3(rotation1_3.data()));
-  ceres::AngleAxisToRotationMatrix(
-      info_two_three.rotation_2.data(),
-      ceres::ColumnMajorAdapter3x3(rotation2_3.data()));
-
-  // Compute loop rotation.
-  const Eigen::Matrix3d loop_rotation =
-      rotation2_3 * rotation1_2 * rotation1_3.transpose();
-  Eigen::Vector3d loop_rotation_angle_axis;
-  ceres::RotationMatrixToAngleAxis(
-      ceres::ColumnMajorAdapter3x3(loop_rotation.data()),
-      loop_rotation_angle_axis.data());
-
-  // Return the angle of the loop rotation which is the error of the
-  // concatenated triplet rotation.
-  return RadToDeg(loop_rotation_angle_axis.norm());
-}
-
-void RemoveTripletEdgesFromInvalidViewPairs(
-    const ViewIdTriplet& triplet,
-    std::unordered_set<ViewIdPair>* invalid_view_pairs) {
-  const ViewIdPair pair_01(std::get<0>(triplet), std::get<1>(triplet));
-  const ViewIdPair pair_02(std::get<0>(triplet), std::get<2>(triplet));
-  const ViewIdPair pair_12(std::get<1>(triplet), std::get<2>(triplet));
-  invalid_view_pairs->erase(pair_01);
-  invalid_view_pairs->erase(pair_02);
-  invalid_view_pairs->erase(pair_12);
+// Interleaving more blocks than threads balances the load.
+static const int kNumBlocksPerThread = 4;
+
+// Returns the cosine of the angle of the loop rotation R_23 * R_12 * R_13^t.
+// The trace of A * B^t is the sum of the elementwise products of A and B, so
+// the loop rotation itself is never formed.
+double LoopRotationCosine(const Eigen::Matrix3d& rotation1_2,
+                          const Eigen::Matrix3d& rotation1_3,
+                          const Eigen::Matrix3d& rotation2_3) {
+  return 0.5 * ((rotation2_3 * rotation1_2).cwiseProduct(rotation1_3).sum() -
+                1.0);
 }
 
 }  // namespace
 
 void FilterViewGraphCyclesByRotation(const double max_loop_error_degrees,
                                      ViewGraph* view_graph) {
-  const std::unordered_map<ViewIdPair, TwoViewInfo>& view_pairs =
-      view_graph->GetAllEdges();
+  FilterViewGraphCyclesByRotation(max_loop_error_degrees, 1, view_graph);
+}
 
-  // Initialize a list of invalid view pairs to all view pairs. View pairs
-  // deemed valid will be removed from this list.
-  std::unordered_set<ViewIdPair> invalid_view_pairs;
-  invalid_view_pairs.reserve(view_pairs.size());
-  for (const auto& view_pair : view_pairs) {
-    invalid_view_pairs.insert(view_pair.first);
+void FilterViewGraphCyclesByRotation(const double max_loop_error_degrees,
+                                     const int num_threads,
+                                     ViewGraph* view_graph) {
+  CHECK_NOTNULL(view_graph);
+  CHECK_GT(num_threads, 0);
+
+  const CompactViewGraph compact_view_graph(*view_graph);
+  const int num_view_pairs = compact_view_graph.NumEdges();
+  std::unique_ptr<ThreadPool> pool;
+  if (num_threads > 1) {
+    pool.reset(new ThreadPool(num_threads));
   }
-
-  // Find all triplets.
-  TripletExtractor<ViewId> triplet_extractor;
-  std::vector<std::vector<ViewIdTriplet> > connected_triplets;
-  CHECK(triplet_extractor.ExtractTriplets(invalid_view_pairs,
-                                          &connected_triplets))
-      << "Could not extract triplets from view pairs.";
-
-  // Examine the cycles of size 3 to determine invalid view pairs from the
-  // rotations.
-  for (const auto& triplets : connected_triplets) {
-    for (const ViewIdTriplet& triplet : triplets) {
-      const TwoViewInfo& info_one_two =
-          *view_graph->GetEdge(std::get<0>(triplet), std::get<1>(triplet));
-      const TwoViewInfo& info_one_three =
-          *view_graph->GetEdge(std::get<0>(triplet), std::get<2>(triplet));
-      const TwoViewInfo& info_two_three =
-          *view_graph->GetEdge(std::get<1>(triplet), std::get<2>(triplet));
-
-      // Compute loop rotation error.
-      const double loop_rotation_error_degrees = ComputeLoopRotationError(
-          info_one_two, info_one_three, info_two_three);
-
-      // Add the view pairs to the list of valid view pairs if the loop error is
-      // within the designated tolerance.
-      if (loop_rotation_error_degrees < max_loop_error_degrees) {
-        RemoveTripletEdgesFromInvalidViewPairs(triplet, &invalid_view_pairs);
-      }
-    }
+  const int num_blocks = kNumBlocksPerThread * num_threads;
+
+  // Convert each relative rotation to a rotation matrix once instead of once
+  // per triplet it participates in.
+  std::vector<Eigen::Matrix3d> relative_rotations(num_view_pairs);
+  ParallelFor(pool.get(),
+              num_view_pairs,
+              num_blocks,
+              [&](const int start, const int end) {
+                for (int i = start; i < end; i++) {
+                  ceres::AngleAxisToRotationMatrix(
+                      compact_view_graph.Edge(i).rotation_2.data(),
+                      ceres::ColumnMajorAdapter3x3(
+                          relative_rotations[i].data()));
+                }
+              });
+
+  // Find all triplets on the dense view indices. Since view indices are
+  // ordered like the view ids, each triplet (i, j, k) satisfies i < j < k and
+  // its edges are oriented like the view pairs.
+  std::unordered_set<std::pair<int, int> > view_index_pairs;
+  view_index_pairs.reserve(num_view_pairs);
+  for (int i = 0; i < num_view_pairs; i++) {
+    view_index_pairs.emplace(compact_view_graph.EdgeView1(i),
+                             compact_view_graph.EdgeView2(i));
   }
-
-  VLOG(1) << "Removing " << invalid_view_pairs.size() << " of "
-          << view_pairs.size() << " view pairs from loop rotation filtering.";
+  TripletExtractor<int> triplet_extractor(num_threads);
+  std::vector<std::tuple<int, int, int> > triplets;
+  triplet_extractor.FindAllTriplets(view_index_pairs, &triplets);
+
+  // Examine the cycles of size 3 and mark the view pairs of each triplet with
+  // a loop error within the designated tolerance as valid.
+  const double min_loop_rotation_cosine =
+      std::cos(DegToRad(std::min(max_loop_error_degrees, 180.0)));
+  std::unique_ptr<std::atomic<bool>[]> is_valid(
+      new std::atomic<bool>[num_view_pairs]);
+  for (int i = 0; i < num_view_pairs; i++) {
+    is_valid[i].store(false, std::memory_order_relaxed);
+  }
+  ParallelFor(pool.get(),
+              triplets.size(),
+              num_blocks,
+              [&](const int start, const int end) {
+                for (int i = start; i < end; i++) {
+                  const int view_index1 = std::get<0>(triplets[i]);
+                  const int view_index2 = std::get<1>(triplets[i]);
+                  const int view_index3 = std::get<2>(triplets[i]);
+                  const int edge1_2 =
+                      compact_view_graph.EdgeIndex(view_index1, view_index2);
+                  const int edge1_3 =
+                      compact_view_graph.EdgeIndex(view_index1, view_index3);
+                  const int edge2_3 =
+                      compact_view_graph.EdgeIndex(view_index2, view_index3);
+                  if (LoopRotationCosine(relative_rotations[edge1_2],
+                                         relative_rotations[edge1_3],
+                                         relative_rotations[edge2_3]) >
+                      min_loop_rotation_cosine) {
+                    is_valid[edge1_2].store(true, std::memory_order_relaxed);
+                    is_valid[edge1_3].store(true, std::memory_order_relaxed);
+                    is_valid[edge2_3].store(true, std::memory_order_relaxed);
+                  }
+                }
+              });
 
   // Remove any view pairs not in the list of valid edges.
-  for (const ViewIdPair& view_pair_id : invalid_view_pairs) {
-    view_graph->RemoveEdge(view_pair_id.first, view_pair_id.second);
+  int num_invalid_view_pairs = 0;
+  for (int i = 0; i < num_view_pairs; i++) {
+    if (!is_valid[i].load(std::memory_order_relaxed)) {
+      const ViewIdPair view_id_pair = compact_view_graph.EdgeViewIds(i);
+      view_graph->RemoveEdge(view_id_pair.first, view_id_pair.second);
+      ++num_invalid_view_pairs;
+    }
   }
+  VLOG(1) << "Removing " << num_invalid_view_pairs << " of " << num_view_pairs
+          << " view pairs from loop rotation filtering.";
 }
 
 }  // namespace theia
@@ -47,6 +47,12 @@ class ViewGraph;
 void FilterViewGraphCyclesByRotation(const double max_loop_error_degrees,
                                      ViewGraph* view_pairs);
 
+// Same as above, but the triplets are found and checked with num_threads
+// threads. The result does not depend on the number of threads.
+void FilterViewGraphCyclesByRotation(const double max_loop_error_degrees,
+                                     const int num_threads,
+                                     ViewGraph* view_pairs);
+
 }  // namespace theia
 
 #endif  // THEIA_SFM_FILTER_VIEW_GRAPH_CYCLES_BY_ROTATION_H_
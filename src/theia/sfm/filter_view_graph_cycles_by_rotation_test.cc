@@ -174,4 +174,25 @@ TEST(FilterViewGraphCyclesByRotation, ManyBadRotations) {
   TestFilterViewGraphCyclesByRotation(10, 30, 15);
 }
 
+TEST(FilterViewGraphCyclesByRotation, ManyBadRotationsMultithreaded) {
+  static const double kMaxRelativeRotationDifferenceDegrees = 4.0;
+  static const int kNumValidViewPairs = 150;
+  static const int kNumThreads = 4;
+  std::unordered_map<ViewId, Vector3d> orientations;
+  CreateViewsWithRandomOrientations(20, &orientations);
+
+  ViewGraph view_graph;
+  CreateValidViewPairs(kNumValidViewPairs, orientations, &view_graph);
+  CreateInvalidViewPairs(30, orientations, &view_graph);
+  ViewGraph single_threaded_view_graph = view_graph;
+  FilterViewGraphCyclesByRotation(
+      kMaxRelativeRotationDifferenceDegrees, kNumThreads, &view_graph);
+  FilterViewGraphCyclesByRotation(kMaxRelativeRotationDifferenceDegrees,
+                                  &single_threaded_view_graph);
+  EXPECT_EQ(view_graph.NumEdges(), kNumValidViewPairs);
+  for (const auto& edge : single_threaded_view_graph.GetAllEdges()) {
+    EXPECT_TRUE(view_graph.HasEdge(edge.first.first, edge.first.second));
+  }
+}
+
 }  // namespace theia
@@ -15,35 +15,47 @@
 
 #include <Eigen/Core>
 #include <Eigen/Geometry>
+#include <ceres/rotation.h>
 #include <glog/logging.h>
+#include <algorithm>
+#include <cmath>
+#include <memory>
 #include <unordered_map>
-#include <unordered_set>
+#include <vector>
 
-#include "theia/math/rotation.h"
 #include "theia/math/util.h"
 #include "theia/sfm/twoview_info.h"
 #include "theia/sfm/types.h"
+#include "theia/sfm/view_graph/compact_view_graph.h"
 #include "theia/sfm/view_graph/view_graph.h"
-#include "theia/util/hash.h"
 #include "theia/util/map_util.h"
+#include "theia/util/threadpool.h"
 
 namespace theia {
 
 namespace {
 
-bool AngularDifferenceIsAcceptable(
-    const Eigen::Vector3d& orientation1,
-    const Eigen::Vector3d& orientation2,
-    const Eigen::Vector3d& relative_orientation,
-    const double sq_max_relative_rotation_difference_radians) {
-  const Eigen::Vector3d composed_relative_rotation =
-      MultiplyRotations(orientation2, -orientation1);
-  const Eigen::Vector3d loop_rotation =
-      MultiplyRotations(-relative_orientation, composed_relative_rotation);
-  const double sq_rotation_angular_difference_radians =
-      loop_rotation.squaredNorm();
-  return sq_rotation_angular_difference_radians <=
-         sq_max_relative_rotation_difference_radians;
+// Interleaving more blocks than threads balances the load.
+static const int kNumBlocksPerThread = 4;
+
+Eigen::Matrix3d AngleAxisToRotationMatrix(const Eigen::Vector3d& angle_axis) {
+  Eigen::Matrix3d rotation;
+  ceres::AngleAxisToRotationMatrix(
+      angle_axis.data(), ceres::ColumnMajorAdapter3x3(rotation.data()));
+  return rotation;
+}
+
+// Returns the cosine of the angle of R_{i,j}^t * R_j * R_i^t. The trace of
+// A^t * B is the sum of the elementwise products of A and B, so the loop
+// rotation itself is never formed.
+double LoopRotationCosine(const Eigen::Matrix3d& rotation1,
+                          const Eigen::Matrix3d& rotation2,
+                          const Eigen::Matrix3d& relative_rotation) {
+  const Eigen::Matrix3d composed_relative_rotation =
+      rotation2 * rotation1.transpose();
+  return 0.5 *
+         (relative_rotation.cwiseProduct(composed_relative_rotation).sum() -
+          1.0);
 }
 
 }  // namespace
@@ -52,51 +64,96 @@ void FilterViewPairsFromOrientation(
     const std::unordered_map<ViewId, Eigen::Vector3d>& orientations,
     const double max_relative_rotation_difference_degrees,
     ViewGraph* view_graph) {
+  FilterViewPairsFromOrientation(
+      orientations, max_relative_rotation_difference_degrees, 1, view_graph);
+}
+
+void FilterViewPairsFromOrientation(
+    const std::unordered_map<ViewId, Eigen::Vector3d>& orientations,
+    const double max_relative_rotation_difference_degrees,
+    const int num_threads,
+    ViewGraph* view_graph) {
   CHECK_NOTNULL(view_graph);
   CHECK_GE(max_relative_rotation_difference_degrees, 0.0);
+  CHECK_GT(num_threads, 0);
 
-  // Precompute the squared threshold in radians.
-  const double max_relative_rotation_difference_radians =
-      DegToRad(max_relative_rotation_difference_degrees);
-  const double sq_max_relative_rotation_difference_radians =
-      max_relative_rotation_difference_radians *
-      max_relative_rotation_difference_radians;
-
-  std::unordered_set<ViewIdPair> view_pairs_to_remove;
-  const auto& view_pairs = view_graph->GetAllEdges();
-  for (const auto& view_pair : view_pairs) {
-    const Eigen::Vector3d* orientation1 =
-        FindOrNull(orientations, view_pair.first.first);
-    const Eigen::Vector3d* orientation2 =
-        FindOrNull(orientations, view_pair.first.second);
+  // Comparing the cosines of the angles avoids converting the loop rotations
+  // back to angle-axis.
+  const double min_loop_rotation_cosine =
+      std::cos(DegToRad(std::min(max_relative_rotation_difference_degrees,
+                                 180.0)));
 
-    // If the view pair contains a view that does not have an orientation then
-    // remove it.
-    if (orientation1 == nullptr || orientation2 == nullptr) {
-      LOG(WARNING)
-          << "View pair (" << view_pair.first.first << ", "
-          << view_pair.first.second
-          << ") contains a view that does not exist! Removing the view pair.";
-      view_pairs_to_remove.insert(view_pair.first);
+  const CompactViewGraph compact_view_graph(*view_graph);
+  std::unique_ptr<ThreadPool> pool;
+  if (num_threads > 1) {
+    pool.reset(new ThreadPool(num_threads));
+  }
+  const int num_blocks = kNumBlocksPerThread * num_threads;
+
+  // Convert each orientation to a rotation matrix once instead of once per
+  // view pair.
+  std::vector<Eigen::Matrix3d> rotations(compact_view_graph.NumViews());
+  std::vector<char> has_orientation(compact_view_graph.NumViews(), 0);
+  ParallelFor(pool.get(),
+              compact_view_graph.NumViews(),
+              num_blocks,
+              [&](const int start, const int end) {
+                for (int i = start; i < end; i++) {
+                  const Eigen::Vector3d* orientation = FindOrNull(
+                      orientations, compact_view_graph.ViewIdForIndex(i));
+                  if (orientation != nullptr) {
+                    rotations[i] = AngleAxisToRotationMatrix(*orientation);
+                    has_orientation[i] = 1;
+                  }
+                }
+              });
+
+  // Flag the view pairs that are inconsistent with the orientations.
+  std::vector<char> should_remove(compact_view_graph.NumEdges(), 0);
+  ParallelFor(
+      pool.get(),
+      compact_view_graph.NumEdges(),
+      num_blocks,
+      [&](const int start, const int end) {
+        for (int i = start; i < end; i++) {
+          const int view_index1 = compact_view_graph.EdgeView1(i);
+          const int view_index2 = compact_view_graph.EdgeView2(i);
+          if (!has_orientation[view_index1] || !has_orientation[view_index2]) {
+            should_remove[i] = 1;
+            continue;
+          }
+
+          const Eigen::Matrix3d relative_rotation =
+              AngleAxisToRotationMatrix(compact_view_graph.Edge(i).rotation_2);
+          if (LoopRotationCosine(rotations[view_index1],
+                                 rotations[view_index2],
+                                 relative_rotation) <
+              min_loop_rotation_cosine) {
+            should_remove[i] = 1;
+          }
+        }
+      });
+
+  // Remove all the "bad" relative poses.
+  int num_removed_view_pairs = 0;
+  for (int i = 0; i < compact_view_graph.NumEdges(); i++) {
+    if (!should_remove[i]) {
       continue;
     }
 
-    // Remove the view pair if the relative rotation estimate is not within the
-    // tolerance.
-    if (!AngularDifferenceIsAcceptable(
-            *orientation1,
-            *orientation2,
-            view_pair.second.rotation_2,
-            sq_max_relative_rotation_difference_radians)) {
-      view_pairs_to_remove.insert(view_pair.first);
+    // If the view pair contains a view that does not have an orientation then
+    // it is removed as well.
+    const ViewIdPair view_id_pair = compact_view_graph.EdgeViewIds(i);
+    if (!has_orientation[compact_view_graph.EdgeView1(i)] ||
+        !has_orientation[compact_view_graph.EdgeView2(i)]) {
+      LOG(WARNING)
+          << "View pair (" << view_id_pair.first << ", " << view_id_pair.second
+          << ") contains a view that does not exist! Removing the view pair.";
     }
-  }
-
-  // Remove all the "bad" relative poses.
-  for (const ViewIdPair view_id_pair : view_pairs_to_remove) {
     view_graph->RemoveEdge(view_id_pair.first, view_id_pair.second);
+    ++num_removed_view_pairs;
   }
-  VLOG(1) << "Removed " << view_pairs_to_remove.size()
+  VLOG(1) << "Removed " << num_removed_view_pairs
           << " view pairs by rotation filtering.";
 }
 
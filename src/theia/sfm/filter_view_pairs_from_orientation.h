@@ -61,6 +61,13 @@ void FilterViewPairsFromOrientation(
     const double max_relative_rotation_difference_degrees,
     ViewGraph* view_pairs);
 
+// Same as above, but the view pairs are checked with num_threads threads.
+void FilterViewPairsFromOrientation(
+    const std::unordered_map<ViewId, Eigen::Vector3d>& orientations,
+    const double max_relative_rotation_difference_degrees,
+    const int num_threads,
+    ViewGraph* view_pairs);
+
 }  // namespace theia
 
 #endif  // THEIA_SFM_FILTER_VIEW_PAIRS_FROM_ORIENTATION_H_
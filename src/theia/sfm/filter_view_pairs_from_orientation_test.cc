@@ -162,4 +162,28 @@ TEST(FilterViewPairsFromOrientation, ManyBadRotations) {
   TestFilterViewPairsFromOrientation(10, 30, 15);
 }
 
+TEST(FilterViewPairsFromOrientation, ManyBadRotationsMultithreaded) {
+  static const double kMaxRelativeRotationDifferenceDegrees = 2.0;
+  static const int kNumValidViewPairs = 300;
+  static const int kNumThreads = 4;
+  std::unordered_map<ViewId, Vector3d> orientations;
+  CreateViewsWithRandomOrientations(50, &orientations);
+
+  ViewGraph view_graph;
+  CreateValidViewPairs(kNumValidViewPairs, orientations, &view_graph);
+  CreateInvalidViewPairs(100, orientations, &view_graph);
+  ViewGraph single_threaded_view_graph = view_graph;
+  FilterViewPairsFromOrientation(orientations,
+                                 kMaxRelativeRotationDifferenceDegrees,
+                                 kNumThreads,
+                                 &view_graph);
+  FilterViewPairsFromOrientation(orientations,
+                                 kMaxRelativeRotationDifferenceDegrees,
+                                 &single_threaded_view_graph);
+  EXPECT_EQ(view_graph.NumEdges(), kNumValidViewPairs);
+  for (const auto& edge : single_threaded_view_graph.GetAllEdges()) {
+    EXPECT_TRUE(view_graph.HasEdge(edge.first.first, edge.first.second));
+  }
+}
+
 }  // namespace theia
@@ -37,216 +37,286 @@
 #include <Eigen/Core>
 #include <Eigen/Geometry>
 #include <ceres/rotation.h>
+#include <algorithm>
+#include <cmath>
 #include <memory>
-#include <mutex>  // NOLINT
 #include <unordered_map>
+#include <vector>
 
 #include "theia/math/util.h"
 #include "theia/sfm/twoview_info.h"
 #include "theia/sfm/types.h"
 #include "theia/sfm/view_graph/view_graph.h"
+#include "theia/util/executor.h"
 #include "theia/util/hash.h"
 #include "theia/util/map_util.h"
 #include "theia/util/random.h"
-#include "theia/util/threadpool.h"
 
 namespace theia {
 using Eigen::Vector3d;
 
 namespace {
 
-// Helper struct to maintain the graph for the translation projection problem.
-struct MFASNode {
-  std::unordered_map<ViewId, double> incoming_nodes;
-  std::unordered_map<ViewId, double> outgoing_nodes;
-  double incoming_weight = 0;
-  double outgoing_weight = 0;
+// The view graph of the translation projection problem stored in flat arrays.
+// Views are indexed from 0 to num_views - 1, and the edges incident to each view
+// are stored contiguously so that the graph is traversed without hashing.
+struct TranslationProjectionGraph {
+  int NumViews() const { return incident_edge_offsets.size() - 1; }
+  int NumEdges() const { return translations.cols(); }
+
+  // The views of each edge, and its relative translation in the global frame
+  // pointing from the first to the second view.
+  std::vector<int> edge_view1;
+  std::vector<int> edge_view2;
+  Eigen::Matrix3Xd translations;
+
+  // The edges incident to view i are
+  // incident_edges[incident_edge_offsets[i], incident_edge_offsets[i + 1]).
+  std::vector<int> incident_edge_offsets;
+  std::vector<int> incident_edges;
 };
 
+// A candidate for the next view in the order. Sources (i.e., views with no
+// incoming edges) are always preferred to the other views.
+struct OrderCandidate {
+  bool is_source;
+  double score;
+  int view;
+  // The candidate is stale if the view was updated after it was pushed.
+  int version;
+
+  bool operator<(const OrderCandidate& rhs) const {
+    if (is_source != rhs.is_source) {
+      return rhs.is_source;
+    }
+    return score < rhs.score;
+  }
+};
+
+// The buffers used by the iterations of one thread. They are allocated once and
+// reused across iterations.
+struct TranslationFilteringWorkspace {
+  explicit TranslationFilteringWorkspace(
+      const TranslationProjectionGraph& graph)
+      : projections(graph.NumEdges()),
+        incoming_weight(graph.NumViews()),
+        outgoing_weight(graph.NumViews()),
+        num_incoming_edges(graph.NumViews()),
+        version(graph.NumViews()),
+        ordering(graph.NumViews()),
+        bad_edge_weight(graph.NumEdges(), 0.0) {
+    candidates.reserve(graph.NumViews() + graph.NumEdges());
+  }
+
+  Eigen::RowVectorXd projections;
+  std::vector<double> incoming_weight;
+  std::vector<double> outgoing_weight;
+  std::vector<int> num_incoming_edges;
+  std::vector<int> version;
+  // The position of each view in the ordering, or -1 if it is not ordered yet.
+  std::vector<int> ordering;
+  // A max-heap of the candidates for the next view in the order.
+  std::vector<OrderCandidate> candidates;
+
+  // Bad edge weights accumulated over the iterations of this thread.
+  std::vector<double> bad_edge_weight;
+};
+
+// Returns the index of the view, assigning it the next index if it is new.
+int GetViewIndex(const ViewId view_id,
+                 std::unordered_map<ViewId, int>* view_indices) {
+  const int next_index = view_indices->size();
+  return view_indices->emplace(view_id, next_index).first->second;
+}
+
 // Rotate the translation direction based on the known orientation such that the
-// translation is in the global reference frame.
-std::unordered_map<ViewIdPair, Vector3d>
-RotateRelativeTranslationsToGlobalFrame(
+// translation is in the global reference frame, and store the view graph in
+// flat arrays. The view pair of each edge is output in edges.
+void CreateTranslationProjectionGraph(
     const std::unordered_map<ViewId, Vector3d>& orientations,
-    const std::unordered_map<ViewIdPair, TwoViewInfo>& view_pairs) {
-  std::unordered_map<ViewIdPair, Vector3d> rotated_translations;
-  rotated_translations.reserve(orientations.size());
-
+    const std::unordered_map<ViewIdPair, TwoViewInfo>& view_pairs,
+    std::vector<ViewIdPair>* edges,
+    TranslationProjectionGraph* graph) {
+  std::unordered_map<ViewId, int> view_indices;
+  edges->reserve(view_pairs.size());
+  graph->edge_view1.reserve(view_pairs.size());
+  graph->edge_view2.reserve(view_pairs.size());
+  graph->translations.resize(3, view_pairs.size());
   for (const auto& view_pair : view_pairs) {
+    const int edge = edges->size();
+    edges->emplace_back(view_pair.first);
+    graph->edge_view1.emplace_back(
+        GetViewIndex(view_pair.first.first, &view_indices));
+    graph->edge_view2.emplace_back(
+        GetViewIndex(view_pair.first.second, &view_indices));
+
     const Vector3d view_to_world_rotation =
         -1.0 * FindOrDie(orientations, view_pair.first.first);
     Vector3d rotated_translation;
     ceres::AngleAxisRotatePoint(view_to_world_rotation.data(),
                                 view_pair.second.position_2.data(),
                                 rotated_translation.data());
-    rotated_translations.emplace(view_pair.first, rotated_translation);
+    graph->translations.col(edge) = rotated_translation;
   }
-  return rotated_translations;
-}
 
-// Find the next view to add to the order. We attempt to choose a source (i.e.,
-// a node with no incoming edges) or choose a node based on a heuristic such
-// that it has the most source-like properties.
-ViewId FindNextViewInOrder(
-    const std::unordered_map<ViewId, MFASNode>& degrees_for_view) {
-  ViewId best_choice = kInvalidViewId;
-  double best_score = 0;
-  for (const auto& view : degrees_for_view) {
-    // If the view is a source view, return it.
-    if (view.second.incoming_nodes.size() == 0) {
-      return view.first;
-    }
-
-    // Otherwise, keep track of the max score seen so far.
-    const double score = (view.second.outgoing_weight + 1.0) /
-                         (view.second.incoming_weight + 1.0);
-    if (score > best_score) {
-      best_choice = view.first;
-      best_score = score;
-    }
+  // Bucket the edges by view.
+  const int num_views = view_indices.size();
+  graph->incident_edge_offsets.assign(num_views + 1, 0);
+  for (int i = 0; i < graph->NumEdges(); i++) {
+    ++graph->incident_edge_offsets[graph->edge_view1[i] + 1];
+    ++graph->incident_edge_offsets[graph->edge_view2[i] + 1];
   }
+  for (int i = 0; i < num_views; i++) {
+    graph->incident_edge_offsets[i + 1] += graph->incident_edge_offsets[i];
+  }
+  graph->incident_edges.resize(2 * graph->NumEdges());
+  std::vector<int> next_incident_edge(graph->incident_edge_offsets.begin(),
+                                      graph->incident_edge_offsets.end() - 1);
+  for (int i = 0; i < graph->NumEdges(); i++) {
+    graph->incident_edges[next_incident_edge[graph->edge_view1[i]]++] = i;
+    graph->incident_edges[next_incident_edge[graph->edge_view2[i]]++] = i;
+  }
+}
 
-  return best_choice;
+// Pushes the view as a candidate for the next view in the order.
+void PushOrderCandidate(const int view,
+                        TranslationFilteringWorkspace* workspace) {
+  OrderCandidate candidate;
+  candidate.is_source = workspace->num_incoming_edges[view] == 0;
+  candidate.score = (workspace->outgoing_weight[view] + 1.0) /
+                    (workspace->incoming_weight[view] + 1.0);
+  candidate.view = view;
+  candidate.version = workspace->version[view];
+  workspace->candidates.emplace_back(candidate);
+  std::push_heap(workspace->candidates.begin(), workspace->candidates.end());
 }
 
-// Based on the 1D translation projections, compute an ordering of the
-// translations.
-std::unordered_map<ViewId, int> OrderTranslationsFromProjections(
-    const std::unordered_map<ViewIdPair, double>&
-        translation_direction_projections) {
+// Based on the 1D translation projections, compute an ordering of the views in
+// workspace->ordering. Each edge points in the direction of the positive
+// projection. The next view in the order is a source (i.e., a view with no
+// incoming edges) or otherwise the view with the most source-like properties.
+// The candidates are kept in a heap that is updated when a neighbor of a view
+// is ordered, so each iteration costs O(E log E).
+void OrderTranslationsFromProjections(
+    const TranslationProjectionGraph& graph,
+    TranslationFilteringWorkspace* workspace) {
+  const int num_views = graph.NumViews();
+  const Eigen::RowVectorXd& projections = workspace->projections;
+
   // Compute the degrees of all vertices as the sum of weights coming in or out.
-  std::unordered_map<ViewId, MFASNode> degrees_for_view;
-  for (const auto& translation_projection : translation_direction_projections) {
-    const ViewIdPair view_id_pair =
-        (translation_projection.second > 0)
-            ? translation_projection.first
-            : ViewIdPair(translation_projection.first.second,
-                         translation_projection.first.first);
-
-    // Update the MFAS entry.
-    const double weight = std::abs(translation_projection.second);
-    degrees_for_view[view_id_pair.second].incoming_weight += weight;
-    degrees_for_view[view_id_pair.first].outgoing_weight += weight;
-    degrees_for_view[view_id_pair.second].incoming_nodes.emplace(
-        view_id_pair.first, weight);
-    degrees_for_view[view_id_pair.first].outgoing_nodes.emplace(
-        view_id_pair.second, weight);
+  std::fill(workspace->incoming_weight.begin(),
+            workspace->incoming_weight.end(),
+            0.0);
+  std::fill(workspace->outgoing_weight.begin(),
+            workspace->outgoing_weight.end(),
+            0.0);
+  std::fill(workspace->num_incoming_edges.begin(),
+            workspace->num_incoming_edges.end(),
+            0);
+  std::fill(workspace->version.begin(), workspace->version.end(), 0);
+  std::fill(workspace->ordering.begin(), workspace->ordering.end(), -1);
+  for (int i = 0; i < graph.NumEdges(); i++) {
+    const double weight = std::abs(projections[i]);
+    const int source =
+        projections[i] > 0 ? graph.edge_view1[i] : graph.edge_view2[i];
+    const int target =
+        projections[i] > 0 ? graph.edge_view2[i] : graph.edge_view1[i];
+    workspace->outgoing_weight[source] += weight;
+    workspace->incoming_weight[target] += weight;
+    ++workspace->num_incoming_edges[target];
+  }
+
+  workspace->candidates.clear();
+  for (int i = 0; i < num_views; i++) {
+    PushOrderCandidate(i, workspace);
   }
 
   // Compute the ordering.
-  const int num_views = degrees_for_view.size();
-  std::unordered_map<ViewId, int> translation_ordering;
   for (int i = 0; i < num_views; i++) {
-    // Find the next view to add.
-    const ViewId next_view_in_order = FindNextViewInOrder(degrees_for_view);
-    translation_ordering[next_view_in_order] = i;
-
-    // Update the MFAS graph and remove the next view from the degrees_for_view.
-    const auto& next_view_info =
-        FindOrDie(degrees_for_view, next_view_in_order);
-    for (auto& neighbor_info : next_view_info.incoming_nodes) {
-      degrees_for_view[neighbor_info.first].outgoing_weight -=
-          neighbor_info.second;
-      degrees_for_view[neighbor_info.first].outgoing_nodes.erase(
-          next_view_in_order);
+    // Find the next view to add, skipping the stale candidates.
+    int next_view = -1;
+    while (next_view == -1) {
+      std::pop_heap(workspace->candidates.begin(),
+                    workspace->candidates.end());
+      const OrderCandidate& candidate = workspace->candidates.back();
+      if (workspace->ordering[candidate.view] == -1 &&
+          workspace->version[candidate.view] == candidate.version) {
+        next_view = candidate.view;
+      }
+      workspace->candidates.pop_back();
     }
-    for (auto& neighbor_info : next_view_info.outgoing_nodes) {
-      degrees_for_view[neighbor_info.first].incoming_weight -=
-          neighbor_info.second;
-      degrees_for_view[neighbor_info.first].incoming_nodes.erase(
-          next_view_in_order);
+    workspace->ordering[next_view] = i;
+
+    // Remove the edges of the view from its unordered neighbors.
+    for (int j = graph.incident_edge_offsets[next_view];
+         j < graph.incident_edge_offsets[next_view + 1];
+         j++) {
+      const int edge = graph.incident_edges[j];
+      const bool is_view1 = graph.edge_view1[edge] == next_view;
+      const int neighbor =
+          is_view1 ? graph.edge_view2[edge] : graph.edge_view1[edge];
+      if (workspace->ordering[neighbor] != -1) {
+        continue;
+      }
+
+      const double weight = std::abs(projections[edge]);
+      if ((projections[edge] > 0) == is_view1) {
+        // The edge points from the ordered view to the neighbor.
+        workspace->incoming_weight[neighbor] -= weight;
+        --workspace->num_incoming_edges[neighbor];
+      } else {
+        workspace->outgoing_weight[neighbor] -= weight;
+      }
+      ++workspace->version[neighbor];
+      PushOrderCandidate(neighbor, workspace);
     }
-    degrees_for_view.erase(next_view_in_order);
   }
-
-  return translation_ordering;
-}
-
-// Projects all the of the translation onto the given axis.
-std::unordered_map<ViewIdPair, double> ProjectTranslationsOntoAxis(
-    const Vector3d& axis,
-    const std::unordered_map<ViewIdPair, Vector3d>& relative_translations) {
-  std::unordered_map<ViewIdPair, double> projection_weights;
-  projection_weights.reserve(relative_translations.size());
-
-  for (const auto& relative_translation : relative_translations) {
-    const double projection_weight = relative_translation.second.dot(axis);
-    projection_weights.emplace(relative_translation.first, projection_weight);
-  }
-  return projection_weights;
 }
 
 // This chooses a random axis based on the given relative translations.
-void ComputeMeanVariance(
-    const std::unordered_map<ViewIdPair, Vector3d>& relative_translations,
-    Vector3d* mean,
-    Vector3d* variance) {
-  mean->setZero();
-  variance->setZero();
-  for (const auto& translation : relative_translations) {
-    *mean += translation.second;
-  }
-  *mean /= static_cast<double>(relative_translations.size());
-
-  for (const auto& translation : relative_translations) {
-    *variance += (translation.second - *mean).cwiseAbs2();
-  }
-  *variance /= static_cast<double>(relative_translations.size() - 1);
+void ComputeMeanVariance(const Eigen::Matrix3Xd& relative_translations,
+                         Vector3d* mean,
+                         Vector3d* variance) {
+  *mean = relative_translations.rowwise().mean();
+  *variance = (relative_translations.colwise() - *mean)
+                  .cwiseAbs2()
+                  .rowwise()
+                  .sum() /
+              static_cast<double>(relative_translations.cols() - 1);
 }
 
-// Performs a single iterations of the translation filtering. This method is
-// thread-safe.
+// Performs a single iterations of the translation filtering and accumulates the
+// bad edge weights in the workspace. Iterations that use different workspaces
+// may run concurrently.
 void TranslationFilteringIteration(
-    const std::unordered_map<ViewIdPair, Vector3d>& relative_translations,
+    const TranslationProjectionGraph& graph,
     const Vector3d& direction_mean,
     const Vector3d& direction_variance,
-    const std::shared_ptr<RandomNumberGenerator>& rng,
-    std::mutex* mutex,
-    std::unordered_map<ViewIdPair, double>* bad_edge_weight) {
-  // Create the random number generator within each thread. If the random number
-  // generator is not supplied then create a new one within each thread.
-  std::shared_ptr<RandomNumberGenerator> local_rng;
-  if (rng.get() == nullptr) {
-    local_rng = std::make_shared<RandomNumberGenerator>();
-  } else {
-    local_rng = rng;
-  }
-
+    RandomNumberGenerator* rng,
+    TranslationFilteringWorkspace* workspace) {
   // Get a random vector to project all relative translations on to.
   const Vector3d random_axis =
-      Vector3d(
-          local_rng->RandGaussian(direction_mean[0], direction_variance[0]),
-          local_rng->RandGaussian(direction_mean[1], direction_variance[1]),
-          local_rng->RandGaussian(direction_mean[2], direction_variance[2]))
+      Vector3d(rng->RandGaussian(direction_mean[0], direction_variance[0]),
+               rng->RandGaussian(direction_mean[1], direction_variance[1]),
+               rng->RandGaussian(direction_mean[2], direction_variance[2]))
           .normalized();
 
   // Project all vectors.
-  const std::unordered_map<ViewIdPair, double>&
-      translation_direction_projections =
-          ProjectTranslationsOntoAxis(random_axis, relative_translations);
+  workspace->projections.noalias() =
+      random_axis.transpose() * graph.translations;
 
   // Compute ordering.
-  const std::unordered_map<ViewId, int>& translation_ordering =
-      OrderTranslationsFromProjections(translation_direction_projections);
-
-  // Compute bad edge weights.
-  for (auto& edge : *bad_edge_weight) {
-    const int ordering_diff =
-        FindOrDie(translation_ordering, edge.first.second) -
-        FindOrDie(translation_ordering, edge.first.first);
-    const double& projection_weight_of_edge =
-        FindOrDieNoPrint(translation_direction_projections, edge.first);
-
-    VLOG(3) << "Edge (" << edge.first.first << ", " << edge.first.second
-            << ") has ordering diff of " << ordering_diff
-            << " and a projection of " << projection_weight_of_edge << " from "
-            << FindOrDieNoPrint(relative_translations, edge.first).transpose();
-    // If the ordering is inconsistent, add the absolute value of the bad weight
-    // to the aggregate bad weight.
+  OrderTranslationsFromProjections(graph, workspace);
+
+  // Compute bad edge weights. If the ordering is inconsistent, add the absolute
+  // value of the bad weight to the aggregate bad weight.
+  for (int i = 0; i < graph.NumEdges(); i++) {
+    const int ordering_diff = workspace->ordering[graph.edge_view2[i]] -
+                              workspace->ordering[graph.edge_view1[i]];
+    const double projection_weight_of_edge = workspace->projections[i];
     if ((ordering_diff < 0 && projection_weight_of_edge > 0) ||
         (ordering_diff > 0 && projection_weight_of_edge < 0)) {
-      std::lock_guard<std::mutex> lock(*mutex);
-      edge.second += std::abs(projection_weight_of_edge);
+      workspace->bad_edge_weight[i] += std::abs(projection_weight_of_edge);
     }
   }
 }
@@ -257,47 +327,74 @@ void FilterViewPairsFromRelativeTranslation(
     const FilterViewPairsFromRelativeTranslationOptions& options,
     const std::unordered_map<ViewId, Vector3d>& orientations,
     ViewGraph* view_graph) {
+  CHECK_GT(options.num_threads, 0);
   const auto& view_pairs = view_graph->GetAllEdges();
-
-  // Weights of edges that have been accumulated throughout the iterations. A
-  // higher weight means the edge is more likely to be bad.
-  std::unordered_map<ViewIdPair, double> bad_edge_weight;
-  for (const auto& view_pair : view_pairs) {
-    bad_edge_weight[view_pair.first] = 0.0;
+  if (view_pairs.empty()) {
+    return;
   }
 
   // Compute the adjusted translations so that they are oriented in the global
   // frame.
-  const std::unordered_map<ViewIdPair, Vector3d>& rotated_translations =
-      RotateRelativeTranslationsToGlobalFrame(orientations, view_pairs);
+  std::vector<ViewIdPair> edges;
+  TranslationProjectionGraph graph;
+  CreateTranslationProjectionGraph(orientations, view_pairs, &edges, &graph);
 
   Vector3d translation_mean, translation_variance;
   ComputeMeanVariance(
-      rotated_translations, &translation_mean, &translation_variance);
-
-  std::unique_ptr<ThreadPool> pool(new ThreadPool(options.num_threads));
-  std::mutex mutex;
-  for (int i = 0; i < options.num_iterations; i++) {
-    pool->Add(TranslationFilteringIteration,
-              rotated_translations,
-              translation_mean,
-              translation_variance,
-              options.rng,
-              &mutex,
-              &bad_edge_weight);
+      graph.translations, &translation_mean, &translation_variance);
+
+  // Each iteration draws its axis from its own random number stream, so the
+  // result does not depend on the number of threads. If no random number
+  // generator is supplied then a new one seeded with the current time is used.
+  const std::shared_ptr<RandomNumberGenerator> rng =
+      options.rng != nullptr ? options.rng
+                             : std::make_shared<RandomNumberGenerator>();
+
+  // The iterations are split into one block per thread. Each block has its own
+  // workspace so that no synchronization is needed.
+  const int num_blocks = std::min(options.num_threads, options.num_iterations);
+  std::vector<std::unique_ptr<TranslationFilteringWorkspace>> workspaces(
+      std::max(num_blocks, 1));
+  const int block_size =
+      (options.num_iterations + workspaces.size() - 1) / workspaces.size();
+  ParallelFor(num_blocks,
+              workspaces.size(),
+              [&](const int start, const int end) {
+                for (int block = start; block < end; block++) {
+                  workspaces[block].reset(
+                      new TranslationFilteringWorkspace(graph));
+                  const int end_iteration = std::min(
+                      (block + 1) * block_size, options.num_iterations);
+                  for (int i = block * block_size; i < end_iteration; i++) {
+                    const std::shared_ptr<RandomNumberGenerator>
+                        iteration_rng = rng->Split(i);
+                    TranslationFilteringIteration(graph,
+                                                  translation_mean,
+                                                  translation_variance,
+                                                  iteration_rng.get(),
+                                                  workspaces[block].get());
+                  }
+                }
+              });
+
+  // Weights of edges that have been accumulated throughout the iterations. A
+  // higher weight means the edge is more likely to be bad.
+  std::vector<double> bad_edge_weight(graph.NumEdges(), 0.0);
+  for (const auto& workspace : workspaces) {
+    for (int i = 0; i < graph.NumEdges(); i++) {
+      bad_edge_weight[i] += workspace->bad_edge_weight[i];
+    }
   }
-  // Wait for tasks to finish.
-  pool.reset(nullptr);
 
   // Remove all the bad edges.
   const double max_aggregated_projection_tolerance =
       options.translation_projection_tolerance * options.num_iterations;
   int num_view_pairs_removed = 0;
-  for (const auto& view_pair : bad_edge_weight) {
-    VLOG(3) << "View pair (" << view_pair.first.first << ", "
-            << view_pair.first.second << ") projection = " << view_pair.second;
-    if (view_pair.second > max_aggregated_projection_tolerance) {
-      view_graph->RemoveEdge(view_pair.first.first, view_pair.first.second);
+  for (int i = 0; i < graph.NumEdges(); i++) {
+    VLOG(3) << "View pair (" << edges[i].first << ", " << edges[i].second
+            << ") projection = " << bad_edge_weight[i];
+    if (bad_edge_weight[i] > max_aggregated_projection_tolerance) {
+      view_graph->RemoveEdge(edges[i].first, edges[i].second);
       ++num_view_pairs_removed;
     }
   }
@@ -52,6 +52,8 @@ struct FilterViewPairsFromRelativeTranslationOptions {
 
   // Filtering the translations is embarassingly parallel (each iteration can
   // be run independently) so we can use a thread pool to speed up computation.
+  // Each iteration uses its own stream of rng, so the filtered view pairs do
+  // not depend on the number of threads.
   int num_threads = 1;
 
   // The projection will be performed for the given number of iterations (we
@@ -206,4 +206,37 @@ TEST(FilterViewPairsFromRelativeTranslation, ManyBadRotations) {
   TestFilterViewPairsFromRelativeTranslation(30, 100, 30);
 }
 
+TEST(FilterViewPairsFromRelativeTranslation, ResultIndependentOfNumThreads) {
+  static const int kNumViews = 50;
+  static const int kNumValidViewPairs = 300;
+  static const int kNumInvalidViewPairs = 60;
+  std::unordered_map<ViewId, Vector3d> orientations;
+  std::unordered_map<ViewId, Vector3d> positions;
+  CreateViewsWithRandomPoses(kNumViews, &orientations, &positions);
+  ViewGraph view_graph;
+  CreateValidViewPairs(
+      kNumValidViewPairs, orientations, positions, &view_graph);
+  CreateInvalidViewPairs(
+      kNumInvalidViewPairs, orientations, positions, &view_graph);
+
+  FilterViewPairsFromRelativeTranslationOptions options;
+  options.rng = std::make_shared<RandomNumberGenerator>(71);
+  ViewGraph single_threaded_view_graph = view_graph;
+  FilterViewPairsFromRelativeTranslation(
+      options, orientations, &single_threaded_view_graph);
+
+  options.num_threads = 4;
+  ViewGraph multithreaded_view_graph = view_graph;
+  FilterViewPairsFromRelativeTranslation(
+      options, orientations, &multithreaded_view_graph);
+
+  EXPECT_LT(single_threaded_view_graph.NumEdges(), view_graph.NumEdges());
+  EXPECT_EQ(multithreaded_view_graph.NumEdges(),
+            single_threaded_view_graph.NumEdges());
+  for (const auto& view_pair : single_threaded_view_graph.GetAllEdges()) {
+    EXPECT_TRUE(multithreaded_view_graph.HasEdge(view_pair.first.first,
+                                                 view_pair.first.second));
+  }
+}
+
 }  // namespace theia
@@ -38,28 +38,21 @@
 
 #include <Eigen/Core>
 #include <Eigen/SparseCore>
-#include <Eigen/SparseLU>
-#include <Eigen/Geometry>
-#include <Eigen/Dense>
 #include <algorithm>
 #include <ceres/rotation.h>
 #include <glog/logging.h>
-#include <memory>
 #include <unordered_map>
-#include <unordered_set>
+#include <utility>
 #include <vector>
 
 #include "spectra/include/SymEigsShiftSolver.h"
 
-#include "theia/math/graph/triplet_extractor.h"
 #include "theia/math/matrix/spectra_linear_operator.h"
-#include "theia/sfm/find_common_tracks_in_views.h"
-#include "theia/sfm/global_pose_estimation/compute_triplet_baseline_ratios.h"
 #include "theia/sfm/reconstruction.h"
 #include "theia/sfm/types.h"
-#include "theia/sfm/view_triplet.h"
+#include "theia/util/executor.h"
+#include "theia/util/hash.h"
 #include "theia/util/map_util.h"
-#include "theia/util/threadpool.h"
 
 namespace theia {
 
@@ -68,81 +61,119 @@ using Eigen::Vector3d;
 
 namespace {
 
+// The 3x3 blocks of the upper triangular part of A^t * A, indexed by the
+// indices of the two views of the block.
+typedef std::unordered_map<std::pair<int, int>, Matrix3d> SymmetricBlocks;
+
+// The number of tracks whose blocks are accumulated by one task. The blocks of
+// a chunk only cover the views of its tracks, so chunks of nearby tracks stay
+// small.
+static const int kNumTracksPerChunk = 16384;
+
 Eigen::Matrix3d GetSkew(const Eigen::Vector3d& f) {
   Eigen::Matrix3d skew_mat;
   skew_mat << 0.0, -f(2), f(1), f(2), 0.0, -f(0), -f(1), f(0), 0.0;
   return skew_mat;
 }
 
-Eigen::Matrix3d GetRij(const Eigen::Matrix3d& i, const Eigen::Matrix3d& j) {
-  return j * i.transpose();
+// Returns the block of the two views, which is zero if it was not added yet.
+Matrix3d& GetBlock(const int view_index1,
+                   const int view_index2,
+                   SymmetricBlocks* blocks) {
+  return blocks
+      ->emplace(std::make_pair(view_index1, view_index2), Matrix3d::Zero())
+      .first->second;
 }
 
-double GetThetaSq(const Eigen::Vector3d& feat_i,
-                  const Eigen::Vector3d& feat_j,
-                  const Eigen::Matrix3d& Rij) {
-  return (GetSkew(feat_j) * Rij * feat_i).squaredNorm();
-}
-
-Eigen::Vector3d Get_aij(const Eigen::Matrix3d& Rij,
-                        const Eigen::Vector3d Xi,
-                        const Eigen::Vector3d Xj) {
-  return (GetSkew(Rij * Xi) * Xj).transpose() * GetSkew(Xj);
+// Adds constraint1^t * constraint2 to the block of the two views. Only the
+// upper triangular blocks are stored, so the transposed product is added if
+// view_index1 > view_index2.
+void AddToSymmetricBlock(const int view_index1,
+                         const int view_index2,
+                         const Matrix3d& constraint1,
+                         const Matrix3d& constraint2,
+                         SymmetricBlocks* blocks) {
+  if (view_index1 <= view_index2) {
+    Matrix3d& block = GetBlock(view_index1, view_index2, blocks);
+    block.noalias() += constraint1.transpose() * constraint2;
+  } else {
+    Matrix3d& block = GetBlock(view_index2, view_index1, blocks);
+    block.noalias() += constraint2.transpose() * constraint1;
+  }
 }
 
-// Adds the constraint from the triplet to the symmetric matrix. Our standard
-// constraint matrix A is a 3M x 3N matrix with M triplet constraints and N
-// cameras. We seek to construct A^t * A directly. For each triplet constraint
-// in our matrix A (i.e. a 3-row block), we can compute the corresponding
-// entries in A^t * A with the following summation:
+// Adds the triplet constraints of a track to A^t * A. Our standard constraint
+// matrix A is a 3M x 3N matrix with M triplet constraints and N cameras. For
+// each triplet constraint, i.e. a 3-row block Row(i) = [C | B | D] for the
+// left base view, the current view and the right base view, we add
 //
-//   A^t * A += Row(i)^t * Row(i)
+//   Row(i)^t * Row(i) = [ C^t * C  |  C^t * B  |  C^t * D]
+//                       [ B^t * C  |  B^t * B  |  B^t * D]
+//                       [ D^t * C  |  D^t * B  |  D^t * D]
 //
-// for each triplet constraint i.
-void AddTripletConstraintToSymmetricMatrix(
-    const std::vector<Matrix3d>& constraints,
-    const std::vector<int>& view_indices,
-    std::unordered_map<std::pair<int, int>, double>* sparse_matrix_entries) {
-  // Construct Row(i)^t * Row(i). If we denote the row as a block matrix:
-  //
-  //   Row(i) = [A | B | C]
-  //
-  // then we have:
-  //
-  //   Row(i)^t * Row(i) = [A | B | C]^t * [A | B | C]
-  //                     = [ A^t * A  |  A^t * B  |  A^t * C]
-  //                       [ B^t * A  |  B^t * B  |  B^t * C]
-  //                       [ C^t * A  |  C^t * B  |  C^t * C]
-  //
-  // Since A^t * A is symmetric, we only store the upper triangular portion.
-  for (int i = 0; i < 3; i++) {
-    for (int j = 0; j < 3; j++) {
-      // Skip any block entries that correspond to the lower triangular portion
-      // of the matrix.
-      if (view_indices[i] > view_indices[j]) {
-        continue;
-      }
-
-      // Compute the A^t * B, etc. matrix.
-      const Eigen::Matrix3d symmetric_constraint =
-          constraints[i].transpose() * constraints[j];
-
-      // Add to the 3x3 block corresponding to (i, j)
-      for (int r = 0; r < 3; r++) {
-        for (int c = 0; c < 3; c++) {
-          const std::pair<int, int> row_col(view_indices[i] + r,
-                                            view_indices[j] + c);
-          (*sparse_matrix_entries)[row_col] += symmetric_constraint(r, c);
-        }
-      }
+// to A^t * A directly. Since A^t * A is symmetric, we only store the upper
+// triangular blocks. The blocks of the two base views get a contribution from
+// every triplet of the track, so they are summed up before they are added.
+void AddTrackConstraintsToSymmetricBlocks(
+    const std::vector<std::pair<int, Vector3d> >& observations,
+    const std::vector<Matrix3d>& rotations,
+    const int base_observation1,
+    const int base_observation2,
+    SymmetricBlocks* blocks) {
+  const int view_index1 = observations[base_observation1].first;
+  const int view_index3 = observations[base_observation2].first;
+  const Vector3d& feature1 = observations[base_observation1].second;
+  const Vector3d& feature3 = observations[base_observation2].second;
+  const Matrix3d& rotation1 = rotations[view_index1];
+  const Matrix3d& rotation3 = rotations[view_index3];
+
+  // The parts of equations 17 and 18 that only depend on the base views.
+  const Matrix3d skew_feature1 = GetSkew(feature1);
+  const Vector3d rotated_feature3 =
+      skew_feature1 * (rotation1 * (rotation3.transpose() * feature3));
+  const Matrix3d skew_feature1_rotation1 = skew_feature1 * rotation1;
+  const Vector3d feature3_in_world = rotation3.transpose() * feature3;
+
+  Matrix3d block11 = Matrix3d::Zero();
+  Matrix3d block13 = Matrix3d::Zero();
+  Matrix3d block33 = Matrix3d::Zero();
+  for (int i = 0; i < observations.size(); ++i) {
+    if (i == base_observation1 || i == base_observation2) {
+      continue;
     }
+    const int view_index2 = observations[i].first;
+    const Vector3d& feature2 = observations[i].second;
+    const Matrix3d& rotation2 = rotations[view_index2];
+
+    // R_32 * f_3 with R_32 = R_2 * R_3^t.
+    const Vector3d feature32 = rotation2 * feature3_in_world;
+    const Vector3d cross32 = feature32.cross(feature2);
+    // a_32^t = (skew(R_32 * f_3) * f_2)^t * skew(f_2).
+    const Vector3d a32 = -GetSkew(feature2) * cross32;
+    // B = skew(f_1) * R_31 * f_3 * a_32^t * R_2 (equation 18).
+    const Matrix3d b = rotated_feature3 * (rotation2.transpose() * a32)
+                                               .transpose();
+    // C = theta_32 * skew(f_1) * R_1 with theta_32 = |skew(f_2) * R_32 * f_3|^2.
+    const Matrix3d c = cross32.squaredNorm() * skew_feature1_rotation1;
+    const Matrix3d d = -(b + c);
+
+    block11.noalias() += c.transpose() * c;
+    block33.noalias() += d.transpose() * d;
+    if (view_index1 <= view_index3) {
+      block13.noalias() += c.transpose() * d;
+    } else {
+      block13.noalias() += d.transpose() * c;
+    }
+    AddToSymmetricBlock(view_index2, view_index2, b, b, blocks);
+    AddToSymmetricBlock(view_index1, view_index2, c, b, blocks);
+    AddToSymmetricBlock(view_index2, view_index3, b, d, blocks);
   }
-}
 
-inline Matrix3d AngleAxisToRotationMatrix(const Vector3d angle_axis) {
-  const double angle = angle_axis.norm();
-  const Eigen::AngleAxisd rotation_aa(angle, angle_axis / angle);
-  return rotation_aa.toRotationMatrix();
+  GetBlock(view_index1, view_index1, blocks) += block11;
+  GetBlock(view_index3, view_index3, blocks) += block33;
+  GetBlock(std::min(view_index1, view_index3),
+           std::max(view_index1, view_index3),
+           blocks) += block13;
 }
 
 // Returns true if the vector R1 * (c2 - c1) is in the same direction as t_12.
@@ -159,55 +190,13 @@ bool VectorsAreSameDirection(const Vector3d& position1,
   return rotated_relative_position.dot(relative_position12) > 0;
 }
 
-// Returns the features as a unit-norm pixel ray after camera intrinsics
-// (i.e. focal length an principal point) have been removed.
-Feature GetNormalizedFeature(const View& view, const TrackId track_id) {
-  Feature feature = *view.GetFeature(track_id);
-  const Camera& camera = view.Camera();
-  Eigen::Vector3d ray = camera.PixelToNormalizedCoordinates(feature.point_);
-  Feature normalized_Feature(ray.hnormalized());
-  // todo normalized covariance?
-  return normalized_Feature;
-}
-
-std::pair<ViewId, ViewId> GetBestBaseViews(
-    const Reconstruction& reconstruction,
-    const TrackId& track_id) {
-
-    const Track* track = reconstruction.Track(track_id);
-    std::vector<ViewId> view_ids(track->ViewIds().begin(), track->ViewIds().end());
-    double theta_max = 0.0;
-    std::pair<ViewId, ViewId> base_views;
-    for (size_t i = 0; i < view_ids.size(); ++i) {
-      for (size_t j = i+1; j < view_ids.size(); ++j) {
-        ViewId id1 = view_ids[i];
-        ViewId id2 = view_ids[j];
-        const View* view1 = reconstruction.View(id1);
-        const View* view2 = reconstruction.View(id2);
-        const Vector3d feature1 =
-            GetNormalizedFeature(*view1, track_id).point_.homogeneous();
-        const Vector3d feature2 =
-            GetNormalizedFeature(*view2, track_id).point_.homogeneous();
-
-        const Eigen::Matrix3d R1 = view1->Camera().GetOrientationAsRotationMatrix();
-        const Eigen::Matrix3d R2 = view2->Camera().GetOrientationAsRotationMatrix();
-        const Matrix3d R12 = GetRij(R1, R2);
-        const double theta = GetThetaSq(feature1, feature2, R12);
-        if (theta > theta_max) {
-            base_views = std::make_pair(id1, id2);
-            theta_max = theta;
-        }
-      }
-    }
-    return base_views;
-}
-
 }  // namespace
 
 LiGTPositionEstimator::LiGTPositionEstimator(
     const Options& options, const Reconstruction& reconstruction)
     : options_(options), reconstruction_(reconstruction) {
   CHECK_GT(options.num_threads, 0);
+  CHECK_GE(options.max_num_tracks_per_view_pair, 0);
 }
 
 bool LiGTPositionEstimator::EstimatePositions(
@@ -215,275 +204,299 @@ bool LiGTPositionEstimator::EstimatePositions(
     const std::unordered_map<ViewId, Vector3d>& orientations,
     std::unordered_map<ViewId, Vector3d>* positions) {
   CHECK_NOTNULL(positions)->clear();
-
-  num_triplets_for_view_.clear();
-  linear_system_index_.clear();
-  BCDs_.clear();
-  triplets_for_tracks_.clear();
-
   view_pairs_ = &view_pairs;
   orientations_ = &orientations;
+  SetupViews(orientations);
+
+  VLOG(2) << "Finding the base views of the tracks.";
+  std::vector<TrackBaseViews> tracks;
+  FindBaseViewsOfTracks(&tracks);
+  SubsampleTracks(&tracks);
+  if (tracks.empty()) {
+    VLOG(2) << "No track is observed by three views with orientations.";
+    return false;
+  }
 
-  VLOG(2) << "Extracting triplets from tracks and calculating BCDs for tracks.";
-  FindTripletsForTracks();
-
-//  VLOG(2) << "Calculating BCD for tracks.";
-//  for (const auto& t : triplets_for_tracks_) {
-//    auto t_id = t.first;
-//    auto view_ids = t.second;
-//    for (const auto& vids : view_ids) {
-//      const auto view1 = reconstruction_.View(std::get<0>(vids));
-//      const auto view2 = reconstruction_.View(std::get<1>(vids));
-//      const auto view3 = reconstruction_.View(std::get<2>(vids));
-//      std::tuple<Matrix3d, Matrix3d, Matrix3d> BCD;
-//      CalculateBCDForTrack(view1, view2, view3, t_id, BCD);
-
-////      Eigen::Vector3d shouldnull = std::get<1>(BCD)*view1->Camera().GetPosition() +
-////              std::get<0>(BCD)*view2->Camera().GetPosition() +
-////              std::get<2>(BCD)*view3->Camera().GetPosition();
-////      std::cout<<"shouldnull: "<<shouldnull<<"\n";
-
-//      BCDs_[t_id].push_back(BCD);
-//    }
-//  }
-
-  VLOG(2) << "Building the constraint matrix...";
+  VLOG(2) << "Building the constraint matrix from " << tracks.size()
+          << " tracks...";
   // Create the linear system based on triplet constraints.
   Eigen::SparseMatrix<double> constraint_matrix;
-  CreateLinearSystem(&constraint_matrix);
+  CreateLinearSystem(tracks, &constraint_matrix);
+  if (constraint_matrix.rows() == 0) {
+    return false;
+  }
 
   // Solve for positions by examining the smallest eigenvalues. Since we have
   // set one position constant at the origin, we only need to solve for the
   // eigenvector corresponding to the smallest eigenvalue. This can be done
   // efficiently with inverse power iterations.
   VLOG(2) << "Solving for positions from the sparse eigenvalue problem...";
-  SparseSymShiftSolveLLT op(constraint_matrix);
+  SparseSymShiftSolveLLT op(constraint_matrix, &linear_solver_);
   Spectra::SymEigsShiftSolver<double, Spectra::LARGEST_MAGN,
                               SparseSymShiftSolveLLT>
   eigs(&op, 1, 6, 0.0);
   eigs.init();
-  eigs.compute();
+  eigs.compute(options_.max_power_iterations, options_.eigensolver_threshold);
+  if (eigs.info() != Spectra::SUCCESSFUL) {
+    LOG(WARNING) << "The eigensolver did not converge.";
+    return false;
+  }
 
-  // Compute with power iterations.
-  const Eigen::VectorXd solution = eigs.eigenvectors().col(0);
   // Add the solutions to the output. Set the position with an index of -1 to
   // be at the origin.
-  for (const auto &view_index : linear_system_index_) {
-    if (view_index.second < 0) {
-      (*positions)[view_index.first].setZero();
-    } else {
-      (*positions)[view_index.first] =
-          solution.segment<3>(view_index.second * 3);
+  const Eigen::VectorXd solution = eigs.eigenvectors().col(0);
+  for (int i = 0; i < view_ids_.size(); ++i) {
+    if (linear_system_index_[i] == kConstantPositionIndex) {
+      (*positions)[view_ids_[i]].setZero();
+    } else if (linear_system_index_[i] >= 0) {
+      (*positions)[view_ids_[i]] =
+          solution.segment<3>(3 * linear_system_index_[i]);
     }
   }
+  FlipSignOfPositionsIfNecessary(positions);
 
   return true;
 }
 
-void LiGTPositionEstimator::CalculateBCDForTrack(
-    const theia::View* view1,
-    const theia::View* view2,
-    const theia::View* view3,
-    const TrackId& track_id,
-    std::tuple<Eigen::Matrix3d, Eigen::Matrix3d, Eigen::Matrix3d>& BCD) {
-  const Vector3d feature1 =
-      GetNormalizedFeature(*view1, track_id).point_.homogeneous();
-  const Vector3d feature2 =
-      GetNormalizedFeature(*view2, track_id).point_.homogeneous();
-  const Vector3d feature3 =
-      GetNormalizedFeature(*view3, track_id).point_.homogeneous();
-
-  const Eigen::Matrix3d R1 = view1->Camera().GetOrientationAsRotationMatrix();
-  const Eigen::Matrix3d R2 = view2->Camera().GetOrientationAsRotationMatrix();
-  const Eigen::Matrix3d R3 = view3->Camera().GetOrientationAsRotationMatrix();
-
-  const Matrix3d R31 = GetRij(R3, R1);
-  const Matrix3d R32 = GetRij(R3, R2);
-
-  const Vector3d a32 = Get_aij(R32, feature3, feature2);
-
-  const Matrix3d skew_feat1 = GetSkew(feature1);
-  // equation 18
-  std::get<0>(BCD) = skew_feat1 * R31 * feature3 * a32.transpose() * R2;
-
-  const double theta = GetThetaSq(feature3, feature2, R32);
-  std::get<1>(BCD) = theta * skew_feat1 * R1;
-
-  std::get<2>(BCD) = -(std::get<0>(BCD) + std::get<1>(BCD));
+void LiGTPositionEstimator::SetupViews(
+    const std::unordered_map<ViewId, Vector3d>& orientations) {
+  view_ids_.clear();
+  view_ids_.reserve(orientations.size());
+  for (const auto& orientation : orientations) {
+    if (reconstruction_.View(orientation.first) != nullptr) {
+      view_ids_.emplace_back(orientation.first);
+    }
+  }
+  std::sort(view_ids_.begin(), view_ids_.end());
+
+  view_indices_.clear();
+  view_indices_.reserve(view_ids_.size());
+  rotations_.resize(view_ids_.size());
+  for (int i = 0; i < view_ids_.size(); ++i) {
+    view_indices_[view_ids_[i]] = i;
+    ceres::AngleAxisToRotationMatrix(
+        FindOrDie(orientations, view_ids_[i]).data(),
+        ceres::ColumnMajorAdapter3x3(rotations_[i].data()));
+  }
 }
 
-void LiGTPositionEstimator::FindTripletsForTracks() {
-  auto track_ids = reconstruction_.TrackIds();
-  uint32_t total_nr_triplets = 0;
-  for (size_t t = 0; t < track_ids.size(); ++t) {
-    auto t_id = track_ids[t];
-    //std::cout<<"searching triplet for "<<t_id<<"\n";
-
-    auto view_ids_for_track = reconstruction_.Track(t_id)->ViewIds();
-    //std::cout<<"view_ids_for_track size: "<<view_ids_for_track.size()<<"\n";
-    if (view_ids_for_track.size() < 3) {
+void LiGTPositionEstimator::GetTrackObservations(
+    const TrackId track_id,
+    std::vector<std::pair<int, Vector3d> >* observations) const {
+  observations->clear();
+  for (const ViewId view_id : reconstruction_.Track(track_id)->ViewIds()) {
+    const int* view_index = FindOrNull(view_indices_, view_id);
+    if (view_index == nullptr) {
       continue;
     }
-    // implements equation 29 from paper. Get base views for point
-    std::pair<ViewId, ViewId> base_views = GetBestBaseViews(reconstruction_, t_id);
-    // now iterate all other observations beside the base views
-    for (size_t v = 0; v < view_ids_for_track.size(); ++v) {
-      ViewId cur_id = *std::next(view_ids_for_track.begin(), v);
-      // check if the current id is one of the base views
-      if (cur_id == base_views.first || cur_id == base_views.second) {
-          continue;
-      }
-      //std::cout<<"Track: "<<t_id<<" triplet: (base l, central, base r) ("<<base_views.first<<", "<<cur_id<<", "<<base_views.second<<")\n";
-
-      ViewIdTriplet triplet = std::make_tuple(base_views.first, cur_id, base_views.second);
-      AddTripletConstraint(triplet);
-
-      const auto view1 = reconstruction_.View(base_views.first);
-      const auto view2 = reconstruction_.View(cur_id);
-      const auto view3 = reconstruction_.View(base_views.second);
-      std::tuple<Matrix3d, Matrix3d, Matrix3d> BCD;
-      CalculateBCDForTrack(view1, view2, view3, t_id, BCD);
-
-//      Eigen::Vector3d shouldbezero = std::get<1>(BCD)*view1->Camera().GetPosition() +
-//              std::get<0>(BCD)*view2->Camera().GetPosition() +
-//              std::get<2>(BCD)*view3->Camera().GetPosition();
-//      std::cout<<"shouldbezero: "<<shouldbezero<<"\n";
-
-      triplets_for_tracks_[t_id].push_back(triplet);
-      BCDs_[t_id].push_back(BCD);
-      total_nr_triplets++;
+    const View* view = reconstruction_.View(view_id);
+    const Feature* feature = view->GetFeature(track_id);
+    if (feature == nullptr) {
+      continue;
     }
+    // The feature as a pixel ray with z = 1 after the camera intrinsics (i.e.
+    // focal length and principal point) have been removed.
+    const Vector3d ray =
+        view->Camera().PixelToNormalizedCoordinates(feature->point_);
+    observations->emplace_back(*view_index, ray / ray.z());
   }
+  std::sort(observations->begin(),
+            observations->end(),
+            [](const std::pair<int, Vector3d>& observation1,
+               const std::pair<int, Vector3d>& observation2) {
+              return observation1.first < observation2.first;
+            });
+}
 
-  std::cout<<"Total number of triplets: "<<total_nr_triplets<<" for "<< track_ids.size()<<" tracks and "<<reconstruction_.ViewIds().size()<<" views.\n";
+void LiGTPositionEstimator::FindBaseViewsOfTracks(
+    std::vector<TrackBaseViews>* tracks) const {
+  const std::vector<TrackId> track_ids = reconstruction_.TrackIds();
+  tracks->resize(track_ids.size());
+  ParallelFor(
+      options_.num_threads,
+      track_ids.size(),
+      [&](const int start, const int end) {
+        std::vector<std::pair<int, Vector3d> > observations;
+        for (int t = start; t < end; ++t) {
+          TrackBaseViews& track = (*tracks)[t];
+          track.track_id = track_ids[t];
+          track.view_index1 = kUnconstrainedViewIndex;
+          GetTrackObservations(track_ids[t], &observations);
+          if (observations.size() < 3) {
+            continue;
+          }
+
+          // Implements equation 29 of the paper. The base views are the views
+          // with the largest parallax angle theta_ij = |skew(f_j) * R_ij *
+          // f_i|^2 of the observed point.
+          track.parallax = -1.0;
+          for (int i = 0; i < observations.size(); ++i) {
+            const Vector3d feature_i_in_world =
+                rotations_[observations[i].first].transpose() *
+                observations[i].second;
+            for (int j = i + 1; j < observations.size(); ++j) {
+              const double parallax =
+                  observations[j]
+                      .second
+                      .cross(rotations_[observations[j].first] *
+                             feature_i_in_world)
+                      .squaredNorm();
+              if (parallax > track.parallax) {
+                track.view_index1 = observations[i].first;
+                track.view_index2 = observations[j].first;
+                track.parallax = parallax;
+              }
+            }
+          }
+        }
+      });
+
+  tracks->erase(std::remove_if(tracks->begin(),
+                               tracks->end(),
+                               [](const TrackBaseViews& track) {
+                                 return track.view_index1 ==
+                                        kUnconstrainedViewIndex;
+                               }),
+                tracks->end());
 }
 
-// An alternative interface is to instead add triplets one by one to linear
-// estimator. This allows for adding redundant observations of triplets, which
-// may be useful if there are multiple estimates of the data.
-void LiGTPositionEstimator::AddTripletConstraint(
-    const ViewIdTriplet& view_triplet) {
-  num_triplets_for_view_[std::get<0>(view_triplet)] += 1;
-  num_triplets_for_view_[std::get<1>(view_triplet)] += 1;
-  num_triplets_for_view_[std::get<2>(view_triplet)] += 1;
-
-  // Determine the order of the views in the linear system. We subtract 1 from
-  // the linear system index so that the first position added to the system
-  // will be set constant (index of -1 is intentionally not evaluated later).
-  InsertIfNotPresent(&linear_system_index_,
-                     std::get<0>(view_triplet),
-                     linear_system_index_.size() - 1);
-  InsertIfNotPresent(&linear_system_index_,
-                     std::get<1>(view_triplet),
-                     linear_system_index_.size() - 1);
-  InsertIfNotPresent(&linear_system_index_,
-                     std::get<2>(view_triplet),
-                     linear_system_index_.size() - 1);
+void LiGTPositionEstimator::SubsampleTracks(
+    std::vector<TrackBaseViews>* tracks) const {
+  if (options_.max_num_tracks_per_view_pair == 0) {
+    return;
+  }
+
+  // Sort the tracks by their base views and then by decreasing parallax, and
+  // keep the first tracks of each pair of base views.
+  std::sort(tracks->begin(),
+            tracks->end(),
+            [](const TrackBaseViews& track1, const TrackBaseViews& track2) {
+              if (track1.view_index1 != track2.view_index1) {
+                return track1.view_index1 < track2.view_index1;
+              }
+              if (track1.view_index2 != track2.view_index2) {
+                return track1.view_index2 < track2.view_index2;
+              }
+              if (track1.parallax != track2.parallax) {
+                return track1.parallax > track2.parallax;
+              }
+              return track1.track_id < track2.track_id;
+            });
+  int num_tracks = 0;
+  int num_tracks_of_view_pair = 0;
+  for (int i = 0; i < tracks->size(); ++i) {
+    const TrackBaseViews& track = (*tracks)[i];
+    if (i > 0 && (track.view_index1 != (*tracks)[i - 1].view_index1 ||
+                  track.view_index2 != (*tracks)[i - 1].view_index2)) {
+      num_tracks_of_view_pair = 0;
+    }
+    if (num_tracks_of_view_pair < options_.max_num_tracks_per_view_pair) {
+      (*tracks)[num_tracks++] = track;
+      ++num_tracks_of_view_pair;
+    }
+  }
+  VLOG(2) << "Using " << num_tracks << " of " << tracks->size()
+          << " tracks after subsampling the tracks of each view pair.";
+  tracks->resize(num_tracks);
 }
 
 // Sets up the linear system with the constraints that each triplet adds.
 void LiGTPositionEstimator::CreateLinearSystem(
+    const std::vector<TrackBaseViews>& tracks,
     Eigen::SparseMatrix<double>* constraint_matrix) {
-  const int num_views = num_triplets_for_view_.size();
-
-    std::unordered_map<std::pair<int, int>, double> sparse_matrix_entries;
-    sparse_matrix_entries.reserve(27 * num_triplets_for_view_.size());
-    for (const auto& triplet_vector : triplets_for_tracks_) {
-        const TrackId t_id = triplet_vector.first;
-        const std::vector<ViewIdTriplet> triplet_v = triplet_vector.second;
-        for (size_t i = 0; i < triplet_v.size(); ++i) {
-            const ViewId &view_id1 = std::get<0>(triplet_v[i]);
-            const ViewId &view_id2 = std::get<1>(triplet_v[i]);
-            const ViewId &view_id3 = std::get<2>(triplet_v[i]);
-            AddTripletConstraintToSparseMatrix(view_id1, view_id2, view_id3,
-                                               BCDs_[t_id][i],
-                                               &sparse_matrix_entries);
-
+  // Accumulate the blocks of each chunk of tracks independently.
+  const int num_chunks =
+      (tracks.size() + kNumTracksPerChunk - 1) / kNumTracksPerChunk;
+  std::vector<SymmetricBlocks> chunk_blocks(num_chunks);
+  ParallelFor(
+      options_.num_threads, num_chunks, [&](const int start, const int end) {
+        std::vector<std::pair<int, Vector3d> > observations;
+        for (int chunk = start; chunk < end; ++chunk) {
+          const int chunk_end = std::min<int>(
+              tracks.size(), (chunk + 1) * kNumTracksPerChunk);
+          for (int t = chunk * kNumTracksPerChunk; t < chunk_end; ++t) {
+            GetTrackObservations(tracks[t].track_id, &observations);
+            int base_observation1 = 0, base_observation2 = 0;
+            for (int i = 0; i < observations.size(); ++i) {
+              if (observations[i].first == tracks[t].view_index1) {
+                base_observation1 = i;
+              } else if (observations[i].first == tracks[t].view_index2) {
+                base_observation2 = i;
+              }
+            }
+            AddTrackConstraintsToSymmetricBlocks(observations,
+                                                 rotations_,
+                                                 base_observation1,
+                                                 base_observation2,
+                                                 &chunk_blocks[chunk]);
+          }
         }
-    }
-
-    // Set the sparse matrix from the container of the accumulated entries.
-    std::vector<Eigen::Triplet<double>> triplet_list;
-    triplet_list.reserve(sparse_matrix_entries.size());
-    for (const auto &sparse_matrix_entry : sparse_matrix_entries) {
-      // Skip this entry if the indices are invalid. This only occurs when we
-      // encounter a constraint with the constant camera (which has a view index
-      // of -1).
-      if (sparse_matrix_entry.first.first < 0 ||
-          sparse_matrix_entry.first.second < 0) {
-        continue;
+      });
+
+  // Merge the blocks of the chunks in order.
+  SymmetricBlocks blocks = std::move(chunk_blocks[0]);
+  for (int chunk = 1; chunk < num_chunks; ++chunk) {
+    for (const auto& block : chunk_blocks[chunk]) {
+      auto inserted = blocks.emplace(block.first, block.second);
+      if (!inserted.second) {
+        inserted.first->second += block.second;
       }
-      triplet_list.emplace_back(sparse_matrix_entry.first.first,
-                                sparse_matrix_entry.first.second,
-                                sparse_matrix_entry.second);
     }
+    SymmetricBlocks().swap(chunk_blocks[chunk]);
+  }
 
-    // We construct the constraint matrix A^t * A directly, which is an
-    // N - 1 x N - 1 matrix where N is the number of cameras (and 3 entries per
-    // camera, corresponding to the camera position entries).
-
-    constraint_matrix->resize((num_views - 1) * 3, (num_views - 1) * 3);
-    constraint_matrix->setFromTriplets(triplet_list.begin(),
-    triplet_list.end());
-}
+  // Every constrained view has a diagonal block. The most constrained view,
+  // i.e. the view with the largest trace of its diagonal block, is held
+  // constant at the origin and the others are numbered in the order of their
+  // ids.
+  linear_system_index_.assign(view_ids_.size(),
+                              static_cast<int>(kUnconstrainedViewIndex));
+  int constant_view_index = kUnconstrainedViewIndex;
+  double max_trace = -1.0;
+  for (const auto& block : blocks) {
+    if (block.first.first != block.first.second) {
+      continue;
+    }
+    linear_system_index_[block.first.first] = 0;
+    const double trace = block.second.trace();
+    if (trace > max_trace ||
+        (trace == max_trace && block.first.first < constant_view_index)) {
+      constant_view_index = block.first.first;
+      max_trace = trace;
+    }
+  }
+  int num_positions = 0;
+  for (int i = 0; i < linear_system_index_.size(); ++i) {
+    if (i == constant_view_index) {
+      linear_system_index_[i] = kConstantPositionIndex;
+    } else if (linear_system_index_[i] != kUnconstrainedViewIndex) {
+      linear_system_index_[i] = num_positions++;
+    }
+  }
 
-void LiGTPositionEstimator::ComputeRotatedRelativeTranslationRotations(
-    const ViewId view_id0,
-    const ViewId view_id1,
-    const ViewId view_id2,
-    Eigen::Matrix3d* r012,
-    Eigen::Matrix3d* r201,
-    Eigen::Matrix3d* r120) {
-  // Relative camera positions.
-  const Eigen::Vector3d& orientation0_aa =
-      FindOrDieNoPrint(*orientations_, view_id0);
-  const Eigen::Vector3d& orientation1_aa =
-      FindOrDieNoPrint(*orientations_, view_id1);
-  const Matrix3d orientation0 = AngleAxisToRotationMatrix(orientation0_aa);
-  const Matrix3d orientation1 = AngleAxisToRotationMatrix(orientation1_aa);
-  const Vector3d t01 =
-      -orientation0.transpose() *
-      FindOrDieNoPrint(*view_pairs_, ViewIdPair(view_id0, view_id1)).position_2;
-  const Vector3d t02 =
-      -orientation0.transpose() *
-      FindOrDieNoPrint(*view_pairs_, ViewIdPair(view_id0, view_id2)).position_2;
-  const Vector3d t12 =
-      -orientation1.transpose() *
-      FindOrDieNoPrint(*view_pairs_, ViewIdPair(view_id1, view_id2)).position_2;
-
-  // Rotations between the translation vectors.
-  *r012 = Eigen::Quaterniond::FromTwoVectors(t12, -t01).toRotationMatrix();
-  *r201 = Eigen::Quaterniond::FromTwoVectors(t01, t02).toRotationMatrix();
-  *r120 = Eigen::Quaterniond::FromTwoVectors(-t02, -t12).toRotationMatrix();
-}
+  // Set the sparse matrix from the accumulated blocks. Blocks of the constant
+  // camera are skipped.
+  std::vector<Eigen::Triplet<double> > triplet_list;
+  triplet_list.reserve(9 * blocks.size());
+  for (const auto& block : blocks) {
+    const int row = linear_system_index_[block.first.first];
+    const int col = linear_system_index_[block.first.second];
+    if (row == kConstantPositionIndex || col == kConstantPositionIndex) {
+      continue;
+    }
+    for (int r = 0; r < 3; r++) {
+      for (int c = 0; c < 3; c++) {
+        triplet_list.emplace_back(3 * row + r, 3 * col + c, block.second(r, c));
+      }
+    }
+  }
 
-// Adds a triplet constraint to the linear system. The weight of the constraint
-// (w), the global orientations, baseline (ratios), and view triplet information
-// are needed to form the constraint.
-void LiGTPositionEstimator::AddTripletConstraintToSparseMatrix(
-    const ViewId view_id0,
-    const ViewId view_id1,
-    const ViewId view_id2,
-    const std::tuple<Matrix3d, Matrix3d, Matrix3d>& BCD,
-    std::unordered_map<std::pair<int, int>, double>* sparse_matrix_entries) {
-//  // Weight each term by the inverse of the # of triplet that the nodes
-//  // participate in.
-//  const double w =
-//      1.0 / std::sqrt(std::min({num_triplets_for_view_[view_id0],
-//                                num_triplets_for_view_[view_id1],
-//                                num_triplets_for_view_[view_id2]}));
-
-  // Get the index of each camera in the sparse matrix.
-  const std::vector<int> view_indices = {
-      static_cast<int>(3 * FindOrDie(linear_system_index_, view_id0)),
-      static_cast<int>(3 * FindOrDie(linear_system_index_, view_id1)),
-      static_cast<int>(3 * FindOrDie(linear_system_index_, view_id2))};
-
-  // important to use index 1 0 2 here.
-  // 0 ist the central camera and equation 17 is using it that way
-  std::vector<Matrix3d> constraints = {std::get<1>(BCD),std::get<0>(BCD),std::get<2>(BCD)};
-  AddTripletConstraintToSymmetricMatrix(
-      constraints, view_indices, sparse_matrix_entries);
+  // We construct the constraint matrix A^t * A directly, which is an
+  // N - 1 x N - 1 matrix where N is the number of cameras (and 3 entries per
+  // camera, corresponding to the camera position entries).
+  VLOG(2) << "The constraint matrix has " << num_positions << " positions.";
+  constraint_matrix->resize(3 * num_positions, 3 * num_positions);
+  constraint_matrix->setFromTriplets(triplet_list.begin(), triplet_list.end());
 }
 
 void LiGTPositionEstimator::FlipSignOfPositionsIfNecessary(
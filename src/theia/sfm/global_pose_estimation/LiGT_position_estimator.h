@@ -40,12 +40,13 @@
 #include <Eigen/Core>
 #include <Eigen/SparseCore>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
+#include "theia/math/matrix/sparse_cholesky_llt.h"
 #include "theia/sfm/feature.h"
 #include "theia/sfm/global_pose_estimation/position_estimator.h"
 #include "theia/sfm/types.h"
-#include "theia/sfm/view_triplet.h"
 #include "theia/util/util.h"
 #include "theia/sfm/reconstruction.h"
 
@@ -76,6 +77,13 @@ class LiGTPositionEstimator : public PositionEstimator {
     // The threshold at which to the iterative eigensolver method is considered
     // to be converged.
     double eigensolver_threshold = 1e-8;
+
+    // If positive, at most this many tracks are used for each pair of base
+    // views, i.e., the two views of a track with the largest parallax. The
+    // tracks with the largest parallax are kept. Large reconstructions have far
+    // more tracks per view pair than are needed to constrain the positions, so
+    // this bounds the size of the problem. All tracks are used if this is 0.
+    int max_num_tracks_per_view_pair = 0;
   };
 
   LiGTPositionEstimator(const Options& options,
@@ -93,36 +101,41 @@ class LiGTPositionEstimator : public PositionEstimator {
       const std::unordered_map<ViewId, Eigen::Vector3d>& orientation);
 
  private:
-  // Store the triplet.
-  void AddTripletConstraint(const ViewIdTriplet& view_triplet);
-
-  // Sets up the linear system with the constraints that each triplet adds.
-  void CreateLinearSystem(Eigen::SparseMatrix<double>* constraint_matrix);
-
-  //void CreateLinearSystem(Eigen::MatrixXd& constraint_matrix);
-  void AddTripletConstraintToSparseMatrix(const ViewId view_id1,
-      const ViewId view_id2,
-      const ViewId view_id3,
-      const std::tuple<Matrix3d, Matrix3d, Matrix3d> &BCD,
-      std::unordered_map<std::pair<int, int>, double>* sparse_matrix_entries);
-
-  void CalculateBCDForTrack(
-      const theia::View* view1,
-      const theia::View* view2,
-      const theia::View* view3,
-      const TrackId& track_id,
-      std::tuple<Eigen::Matrix3d, Eigen::Matrix3d, Eigen::Matrix3d>& BCD);
-
-  void FindTripletsForTracks();
-
-  // A helper method to compute the relative rotations between translation
-  // directions.
-  void ComputeRotatedRelativeTranslationRotations(const ViewId view_id0,
-                                                  const ViewId view_id1,
-                                                  const ViewId view_id2,
-                                                  Eigen::Matrix3d* r012,
-                                                  Eigen::Matrix3d* r201,
-                                                  Eigen::Matrix3d* r120);
+  // The two views of a track with the largest parallax angle, which are the
+  // base views of all triplet constraints of the track (eq. 29). The views are
+  // given by their index in view_ids_.
+  struct TrackBaseViews {
+    TrackId track_id;
+    int view_index1;
+    int view_index2;
+    double parallax;
+  };
+
+  // Computes the rotation of each view with an orientation.
+  void SetupViews(
+      const std::unordered_map<ViewId, Eigen::Vector3d>& orientations);
+
+  // Returns the views of the track that have an orientation, sorted by their
+  // index in view_ids_, with the normalized feature ray of each view.
+  void GetTrackObservations(
+      const TrackId track_id,
+      std::vector<std::pair<int, Eigen::Vector3d> >* observations) const;
+
+  // Finds the base views of all tracks that are observed by at least three
+  // views with an orientation. The tracks are processed in parallel.
+  void FindBaseViewsOfTracks(std::vector<TrackBaseViews>* tracks) const;
+
+  // Keeps the options_.max_num_tracks_per_view_pair tracks with the largest
+  // parallax of each pair of base views.
+  void SubsampleTracks(std::vector<TrackBaseViews>* tracks) const;
+
+  // Sets up the linear system A^t * A with the triplet constraints of the
+  // tracks and assigns the index of each constrained view in the linear
+  // system. The tracks are split into chunks whose 3x3 blocks of A^t * A are
+  // accumulated in parallel and then merged.
+  void CreateLinearSystem(const std::vector<TrackBaseViews>& tracks,
+                          Eigen::SparseMatrix<double>* constraint_matrix);
+
   // Positions are estimated from an eigenvector that is unit-norm with an
   // ambiguous sign. To ensure that the sign of the camera positions is correct,
   // we measure the relative translations from estimated camera positions and
@@ -136,17 +149,25 @@ class LiGTPositionEstimator : public PositionEstimator {
   const std::unordered_map<ViewIdPair, TwoViewInfo>* view_pairs_;
   const std::unordered_map<ViewId, Eigen::Vector3d>* orientations_;
 
-  // save a view triplet for each track, eq. 29
-  std::unordered_map<TrackId, std::vector<ViewIdTriplet>> triplets_for_tracks_;
-  std::unordered_map<TrackId,
-                     std::vector<std::tuple<Matrix3d, Matrix3d, Matrix3d>>> BCDs_;
+  // The views with an orientation in increasing order of their ids, the index
+  // of each view in view_ids_ and the rotation matrix of each view.
+  std::vector<ViewId> view_ids_;
+  std::unordered_map<ViewId, int> view_indices_;
+  std::vector<Eigen::Matrix3d> rotations_;
 
   // We keep one of the positions as constant to remove the ambiguity of the
-  // origin of the linear system.
+  // origin of the linear system. Views without constraints are not part of the
+  // linear system.
   static const int kConstantPositionIndex = -1;
+  static const int kUnconstrainedViewIndex = -2;
+
+  // The index of each view of view_ids_ in the linear system.
+  std::vector<int> linear_system_index_;
 
-  std::unordered_map<ViewId, int> num_triplets_for_view_;
-  std::unordered_map<ViewId, int> linear_system_index_;
+  // The decomposition of the linear system. The symbolic analysis is reused if
+  // EstimatePositions is called again for a linear system with the same
+  // sparsity pattern.
+  SparseCholeskyLLt linear_solver_;
 
   DISALLOW_COPY_AND_ASSIGN(LiGTPositionEstimator);
 };
@@ -84,13 +84,7 @@ bool HybridRotationEstimator::EstimateRotations(
   ViewIdToAscentIndex(*global_rotations, &view_id_to_index_);
   ld_rotation_estimator_->SetViewIdToIndex(view_id_to_index_);
 
-  Eigen::SparseMatrix<double> sparse_matrix;
-  SetupLinearSystem(view_pairs,
-                    (*global_rotations).size(),
-                    view_id_to_index_,
-                    &sparse_matrix);
   irls_rotation_refiner_->SetViewIdToIndex(view_id_to_index_);
-  irls_rotation_refiner_->SetSparseMatrix(sparse_matrix);
 
   // Estimate global rotations that resides within the cone of
   // convergence for IRLS.
@@ -34,12 +34,14 @@
 
 #include "theia/sfm/global_pose_estimation/irls_rotation_local_refiner.h"
 
+#include <ceres/rotation.h>
 #include <glog/logging.h>
+#include <Eigen/Geometry>
 #include <iomanip>
 #include <iostream>
 
-#include "theia/math/matrix/sparse_cholesky_llt.h"
 #include "theia/math/rotation.h"
+#include "theia/sfm/global_pose_estimation/rotation_averaging_linear_system.h"
 #include "theia/sfm/global_pose_estimation/rotation_estimator.h"
 #include "theia/sfm/global_pose_estimation/rotation_estimator_util.h"
 #include "theia/sfm/types.h"
@@ -69,11 +71,6 @@ void IRLSRotationLocalRefiner::SetViewIdToIndex(
   view_id_to_index_ = view_id_to_index;
 }
 
-void IRLSRotationLocalRefiner::SetSparseMatrix(
-    const Eigen::SparseMatrix<double>& sparse_matrix) {
-  sparse_matrix_ = sparse_matrix;
-}
-
 bool IRLSRotationLocalRefiner::SolveIRLS(
     const std::unordered_map<ViewIdPair, TwoViewInfo>& relative_rotations,
     std::unordered_map<ViewId, Eigen::Vector3d>* global_rotations) {
@@ -87,61 +84,78 @@ bool IRLSRotationLocalRefiner::SolveIRLS(
     ViewIdToAscentIndex(*global_rotations, &view_id_to_index_);
   }
 
-  if (sparse_matrix_.rows() == 0) {
-    SetupLinearSystem(relative_rotations,
-                      (*global_rotations).size(),
-                      view_id_to_index_,
-                      &sparse_matrix_);
+  tangent_space_residual_.resize(3 * num_edges);
+
+  // Store the global rotations as rotation matrices indexed by their position
+  // in the linear system.
+  const int num_rotations = global_rotations->size();
+  view_ids_.resize(num_rotations);
+  rotation_matrices_.resize(num_rotations);
+  for (const auto& rotation : *global_rotations) {
+    const int index = FindOrDie(view_id_to_index_, rotation.first);
+    CHECK_LT(index, num_rotations);
+    view_ids_[index] = rotation.first;
+    ceres::AngleAxisToRotationMatrix(
+        rotation.second.data(),
+        ceres::ColumnMajorAdapter3x3(rotation_matrices_[index].data()));
   }
 
-  // Set up the linear solver and analyze the sparsity pattern of the
-  // system. Since the sparsity pattern will not change with each linear solve
-  // this can help speed up the solution time.
-  SparseCholeskyLLt linear_solver;
-  linear_solver.AnalyzePattern(sparse_matrix_.transpose() * sparse_matrix_);
-  if (linear_solver.Info() != Eigen::Success) {
-    LOG(ERROR) << "Cholesky decomposition failed.";
-    return false;
+  // Set up the linear system from the view graph. Since the sparsity pattern
+  // will not change with each linear solve, the symbolic factorization is only
+  // computed once, which speeds up the solution time.
+  relative_rotation_matrices_.resize(num_edges);
+  edge_rotation_indices_.resize(2 * num_edges);
+  std::vector<std::pair<int, int> > edges;
+  edges.reserve(num_edges);
+  int edge_index = 0;
+  for (const auto& relative_rotation : relative_rotations) {
+    const int index1 =
+        FindOrDie(view_id_to_index_, relative_rotation.first.first);
+    const int index2 =
+        FindOrDie(view_id_to_index_, relative_rotation.first.second);
+    ceres::AngleAxisToRotationMatrix(
+        relative_rotation.second.rotation_2.data(),
+        ceres::ColumnMajorAdapter3x3(
+            relative_rotation_matrices_[edge_index].data()));
+    edge_rotation_indices_[2 * edge_index] = index1;
+    edge_rotation_indices_[2 * edge_index + 1] = index2;
+    edges.emplace_back(index1 - 1, index2 - 1);
+    ++edge_index;
   }
+  linear_system_.reset(new RotationAveragingLinearSystem(
+      num_rotations - 1, edges, options_.num_threads));
 
   LOG(INFO) << std::setw(12) << std::setfill(' ') << "Iter " << std::setw(16)
             << std::setfill(' ') << "SqError " << std::setw(16)
             << std::setfill(' ') << "Delta ";
 
-  ComputeResiduals(relative_rotations, global_rotations);
+  ComputeResiduals();
 
-  Eigen::ArrayXd weights(num_edges * 3);
-  Eigen::SparseMatrix<double> at_weight;
+  Eigen::VectorXd weights(num_edges);
   Timer timer;
   for (int i = 0; i < options_.max_num_irls_iterations; i++) {
     // Compute the Huber-like weights for each error term.
-    const double& sigma = options_.irls_loss_parameter_sigma;
-#pragma omp parallel for num_threads(options_.num_threads)
-    for (int k = 0; k < num_edges; ++k) {
-      double e_sq = tangent_space_residual_.segment<3>(3 * k).squaredNorm();
-      double tmp = e_sq + sigma * sigma;
-      double w = sigma / (tmp * tmp);
-      weights.segment<3>(3 * k).setConstant(w);
-    }
-
-    // Update the factorization for the weighted values.
-    at_weight = sparse_matrix_.transpose() * weights.matrix().asDiagonal();
-    linear_solver.Factorize(at_weight * sparse_matrix_);
-    if (linear_solver.Info() != Eigen::Success) {
-      LOG(ERROR) << "Failed to factorize the least squares system.";
-      return false;
-    }
-
-    // Solve the least squares problem.
-    tangent_space_step_ =
-        linear_solver.Solve(at_weight * tangent_space_residual_);
-    if (linear_solver.Info() != Eigen::Success) {
+    const double sigma = options_.irls_loss_parameter_sigma;
+    linear_system_->RunInParallel(num_edges, [&](const int start,
+                                                 const int end) {
+      for (int k = start; k < end; ++k) {
+        const double e_sq =
+            tangent_space_residual_.segment<3>(3 * k).squaredNorm();
+        const double tmp = e_sq + sigma * sigma;
+        weights[k] = sigma / (tmp * tmp);
+      }
+    });
+
+    // Solve the weighted least squares problem.
+    if (!linear_system_->SolveWeightedLeastSquares(
+            weights, tangent_space_residual_, &tangent_space_step_)) {
       LOG(ERROR) << "Failed to solve the least squares system.";
+      CopyGlobalRotations(global_rotations);
       return false;
     }
 
-    UpdateGlobalRotations(global_rotations);
-    ComputeResiduals(relative_rotations, global_rotations);
+    UpdateGlobalRotations();
+    ComputeResiduals();
     const double avg_step_size = ComputeAverageStepSize();
 
     LOG(INFO) << std::setw(12) << std::setfill(' ') << i << std::setw(16)
@@ -156,43 +170,46 @@ bool IRLSRotationLocalRefiner::SolveIRLS(
 
   LOG(INFO) << "Total time [IRLS]: " << timer.ElapsedTimeInSeconds() * 1e3
             << " ms.";
+  CopyGlobalRotations(global_rotations);
   return true;
 }
 
-void IRLSRotationLocalRefiner::UpdateGlobalRotations(
-    std::unordered_map<ViewId, Eigen::Vector3d>* global_rotations) {
-  for (auto& rotation : *global_rotations) {
-    const int view_index = FindOrDie(view_id_to_index_, rotation.first) - 1;
-    if (view_index == kConstantRotationIndex) {
-      continue;
-    }
-
-    // Apply the rotation change to the global orientation.
-    const Eigen::Vector3d& rotation_change =
-        tangent_space_step_.segment<3>(3 * view_index);
-    rotation.second = MultiplyRotations(rotation.second, rotation_change);
-  }
+void IRLSRotationLocalRefiner::UpdateGlobalRotations() {
+  // Apply the rotation change to the global orientations. The rotation at
+  // index 0 is held constant.
+  linear_system_->RunInParallel(
+      rotation_matrices_.size() - 1, [&](const int start, const int end) {
+        for (int view_index = start; view_index < end; ++view_index) {
+          const Eigen::Vector3d rotation_change =
+              tangent_space_step_.segment<3>(3 * view_index);
+          Eigen::Matrix3d rotation_change_matrix;
+          ceres::AngleAxisToRotationMatrix(
+              rotation_change.data(),
+              ceres::ColumnMajorAdapter3x3(rotation_change_matrix.data()));
+          rotation_matrices_[view_index + 1] *= rotation_change_matrix;
+        }
+      });
 }
 
-void IRLSRotationLocalRefiner::ComputeResiduals(
-    const std::unordered_map<ViewIdPair, TwoViewInfo>& relative_rotations,
-    std::unordered_map<ViewId, Eigen::Vector3d>* global_rotations) {
-  int rotation_error_index = 0;
+void IRLSRotationLocalRefiner::ComputeResiduals() {
+  // Compute the relative rotation error as:
+  //   R_err = R2^t * R_12 * R1.
+  linear_system_->RunInParallel(
+      relative_rotation_matrices_.size(), [&](const int start, const int end) {
+        RelativeRotationErrors(end - start,
+                               relative_rotation_matrices_.data() + start,
+                               edge_rotation_indices_.data() + 2 * start,
+                               rotation_matrices_.data(),
+                               tangent_space_residual_.data() + 3 * start);
+      });
+}
 
-  for (const auto& relative_rotation : relative_rotations) {
-    const Eigen::Vector3d& relative_rotation_aa =
-        relative_rotation.second.rotation_2;
-    const Eigen::Vector3d& rotation1 =
-        FindOrDie(*global_rotations, relative_rotation.first.first);
-    const Eigen::Vector3d& rotation2 =
-        FindOrDie(*global_rotations, relative_rotation.first.second);
-
-    // Compute the relative rotation error as:
-    //   R_err = R2^t * R_12 * R1.
-    tangent_space_residual_.segment<3>(3 * rotation_error_index) =
-        MultiplyRotations(-rotation2,
-                          MultiplyRotations(relative_rotation_aa, rotation1));
-    ++rotation_error_index;
+void IRLSRotationLocalRefiner::CopyGlobalRotations(
+    std::unordered_map<ViewId, Eigen::Vector3d>* global_rotations) const {
+  // The constant rotation at index 0 is left untouched.
+  for (int i = 1; i < rotation_matrices_.size(); i++) {
+    const Eigen::AngleAxisd rotation(rotation_matrices_[i]);
+    (*global_rotations)[view_ids_[i]] = rotation.angle() * rotation.axis();
   }
 }
 
@@ -35,12 +35,14 @@
 #ifndef THEIA_SFM_GLOBAL_POSE_ESTIMATION_IRLS_ROTATION_LOCAL_REFINE_H_
 #define THEIA_SFM_GLOBAL_POSE_ESTIMATION_IRLS_ROTATION_LOCAL_REFINE_H_
 
+#include <memory>
 #include <unordered_map>
 #include <utility>
 #include <vector>
 
 #include "theia/math/rotation.h"
 #include "theia/math/util.h"
+#include "theia/sfm/global_pose_estimation/rotation_averaging_linear_system.h"
 #include "theia/sfm/types.h"
 
 #include <Eigen/Core>
@@ -52,6 +54,8 @@ class TwoViewInfo;
 class IRLSRotationLocalRefiner {
  public:
   struct IRLSRefinerOptions {
+    // The number of threads used to solve the linear systems and to compute the
+    // residuals and weights of the relative rotations.
     int num_threads = 8;
 
     // The number of iterative reweighted least squares iterations to perform.
@@ -74,8 +78,6 @@ class IRLSRotationLocalRefiner {
   void SetViewIdToIndex(
       const std::unordered_map<ViewId, int>& view_id_to_index);
 
-  void SetSparseMatrix(const Eigen::SparseMatrix<double>& sparse_matrix);
-
   bool SolveIRLS(
       const std::unordered_map<ViewIdPair, TwoViewInfo>& relative_rotations,
       std::unordered_map<ViewId, Eigen::Vector3d>* global_rotations);
@@ -87,14 +89,16 @@ class IRLSRotationLocalRefiner {
  private:
   // Update the global orientations using the current value in the
   // rotation_change.
-  void UpdateGlobalRotations(
-      std::unordered_map<ViewId, Eigen::Vector3d>* global_rotations);
+  void UpdateGlobalRotations();
 
   // Computes the relative rotation error based on the current global
   // orientation estimates.
-  void ComputeResiduals(
-      const std::unordered_map<ViewIdPair, TwoViewInfo>& relative_rotations,
-      std::unordered_map<ViewId, Eigen::Vector3d>* global_rotations);
+  void ComputeResiduals();
+
+  // Writes the current global rotations in angle-axis form to
+  // global_rotations.
+  void CopyGlobalRotations(
+      std::unordered_map<ViewId, Eigen::Vector3d>* global_rotations) const;
 
   // Computes the average size of the most recent step of the algorithm.
   // The is the average over all non-fixed global_rotations_ of their
@@ -107,9 +111,23 @@ class IRLSRotationLocalRefiner {
   // the linear system.
   std::unordered_map<ViewId, int> view_id_to_index_;
 
-  // The sparse matrix used to maintain the linear system. This is matrix A in
-  // Ax = b.
-  Eigen::SparseMatrix<double> sparse_matrix_;
+  // The global rotations as rotation matrices and their ViewIds, indexed by
+  // the values of view_id_to_index_. They are updated in place during the
+  // IRLS iterations and only converted back to angle-axis at the end.
+  std::vector<ViewId> view_ids_;
+  std::vector<Eigen::Matrix3d> rotation_matrices_;
+
+  // The relative rotations as rotation matrices in the order of the edges of
+  // the linear system, and the indices of the two rotations of each edge into
+  // rotation_matrices_. The contiguous arrays let the residuals be computed by
+  // the batch kernel RelativeRotationErrors without any lookups.
+  std::vector<Eigen::Matrix3d> relative_rotation_matrices_;
+  std::vector<int> edge_rotation_indices_;
+
+  // The linear system Ax = b, which is built from a CSR representation of the
+  // view graph and reuses the symbolic factorization of its normal equations
+  // across IRLS iterations.
+  std::unique_ptr<RotationAveragingLinearSystem> linear_system_;
 
   // x in the linear system Ax = b.
   Eigen::VectorXd tangent_space_step_;
@@ -86,14 +86,18 @@ bool L1RotationGlobalEstimator::SolveL1Regression(
 
   L1Solver<Eigen::SparseMatrix<double>>::Options l1_solver_options;
   l1_solver_options.max_num_iterations = 5;
+  // As in RobustRotationEstimator, each solve starts from the dual variables
+  // and rho of the previous one.
+  l1_solver_options.adaptive_rho = true;
+  l1_solver_options.warm_start = true;
   L1Solver<Eigen::SparseMatrix<double>> l1_solver(l1_solver_options,
                                                   sparse_matrix_);
 
-  tangent_space_step_.setZero();
   ComputeResiduals(relative_rotations, global_rotations);
 
   Timer timer;
   for (int i = 0; i < options_.max_num_l1_iterations; i++) {
+    tangent_space_step_.setZero();
     l1_solver.Solve(tangent_space_residual_, &tangent_space_step_);
     UpdateGlobalRotations(global_rotations);
     ComputeResiduals(relative_rotations, global_rotations);
@@ -102,6 +102,8 @@ bool LeastUnsquaredDeviationPositionEstimator::EstimatePositions(
   // Solve for camera positions by solving a constrained L1 problem to enforce
   // all relative translations scales > 1.
   ConstrainedL1Solver::Options l1_options;
+  l1_options.adaptive_rho = true;
+  l1_options.num_threads = options_.num_threads;
   ConstrainedL1Solver solver(
       l1_options, constraint_matrix_, b, geq_mat, geq_vec);
   solver.Solve(&solution);
@@ -66,6 +66,9 @@ class LeastUnsquaredDeviationPositionEstimator : public PositionEstimator {
 
     // A measurement for convergence criterion.
     double convergence_criterion = 1e-4;
+
+    // The number of threads used by the L1 solver.
+    int num_threads = 1;
   };
 
   LeastUnsquaredDeviationPositionEstimator(
@@ -49,7 +49,6 @@
 
 #include "theia/math/graph/triplet_extractor.h"
 #include "theia/math/matrix/spectra_linear_operator.h"
-#include "theia/sfm/find_common_tracks_in_views.h"
 #include "theia/sfm/global_pose_estimation/compute_triplet_baseline_ratios.h"
 #include "theia/sfm/reconstruction.h"
 #include "theia/sfm/types.h"
@@ -64,8 +63,13 @@ using Eigen::Vector3d;
 
 namespace {
 
+// The triplets and views are processed in more blocks than threads so that the
+// load is balanced when the work per item varies.
+static const int kNumBlocksPerThread = 4;
+
 std::vector<ViewIdTriplet> GetLargetConnectedTripletGraph(
-    const std::unordered_map<ViewIdPair, TwoViewInfo>& view_pairs) {
+    const std::unordered_map<ViewIdPair, TwoViewInfo>& view_pairs,
+    const int num_threads) {
   static const int kLargestCCIndex = 0;
 
   // Get a list of all edges in the view graph.
@@ -76,7 +80,7 @@ std::vector<ViewIdTriplet> GetLargetConnectedTripletGraph(
   }
 
   // Extract connected triplets.
-  TripletExtractor<ViewId> extractor;
+  TripletExtractor<ViewId> extractor(num_threads);
   std::vector<std::vector<ViewIdTriplet> > triplets;
   CHECK(extractor.ExtractTriplets(view_id_pairs, &triplets));
   CHECK_GT(triplets.size(), 0);
@@ -171,21 +175,32 @@ bool LinearPositionEstimator::EstimatePositions(
   // Extract triplets from the view pairs. As of now, we only consider the
   // largest connected triplet in the viewing graph.
   VLOG(2) << "Extracting triplets from the viewing graph.";
-  triplets_ = GetLargetConnectedTripletGraph(view_pairs);
+  triplets_ = GetLargetConnectedTripletGraph(view_pairs, options_.num_threads);
+  for (const ViewIdTriplet& triplet : triplets_) {
+    AddTripletConstraint(triplet);
+  }
 
   VLOG(2) << "Determining baseline ratios within each triplet...";
+  std::unique_ptr<ThreadPool> pool;
+  if (options_.num_threads > 1) {
+    pool.reset(new ThreadPool(options_.num_threads));
+  }
+  const int num_blocks = kNumBlocksPerThread * options_.num_threads;
+  IndexSharedFeatures(pool.get());
+
   // Baselines where (x, y, z) corresponds to the baseline of the first,
   // second, and third view pair in the triplet.
-  std::unique_ptr<ThreadPool> pool(new ThreadPool(options_.num_threads));
   baselines_.resize(triplets_.size());
-  for (size_t i = 0; i < triplets_.size(); i++) {
-    AddTripletConstraint(triplets_[i]);
-    pool->Add(&LinearPositionEstimator::ComputeBaselineRatioForTriplet,
-              this,
-              triplets_[i],
-              &baselines_[i]);
-  }
+  ParallelFor(pool.get(),
+              triplets_.size(),
+              num_blocks,
+              [this](const int start, const int end) {
+                for (int i = start; i < end; i++) {
+                  ComputeBaselineRatioForTriplet(triplets_[i], &baselines_[i]);
+                }
+              });
   pool.reset(nullptr);
+  shared_features_.clear();
 
   VLOG(2) << "Building the constraint matrix...";
   // Create the linear system based on triplet constraints.
@@ -247,29 +262,108 @@ void LinearPositionEstimator::AddTripletConstraint(
                      linear_system_index_.size() - 1);
 }
 
+void LinearPositionEstimator::IndexSharedFeatures(ThreadPool* pool) {
+  const int num_blocks = kNumBlocksPerThread * options_.num_threads;
+
+  // Collect the views and view pairs of the triplets.
+  std::unordered_map<ViewId, int> view_indices;
+  std::vector<ViewId> view_ids;
+  std::unordered_set<ViewIdPair> view_pair_set;
+  for (const ViewIdTriplet& triplet : triplets_) {
+    const ViewId triplet_view_ids[3] = {
+        std::get<0>(triplet), std::get<1>(triplet), std::get<2>(triplet)};
+    for (const ViewId view_id : triplet_view_ids) {
+      if (InsertIfNotPresent(&view_indices, view_id, view_ids.size())) {
+        view_ids.emplace_back(view_id);
+      }
+    }
+    view_pair_set.emplace(triplet_view_ids[0], triplet_view_ids[1]);
+    view_pair_set.emplace(triplet_view_ids[0], triplet_view_ids[2]);
+    view_pair_set.emplace(triplet_view_ids[1], triplet_view_ids[2]);
+  }
+  const std::vector<ViewIdPair> view_pairs(view_pair_set.begin(),
+                                           view_pair_set.end());
+
+  // Normalize the features of each view once, sorted by track id.
+  std::vector<std::vector<std::pair<TrackId, Feature>>> normalized_features(
+      view_ids.size());
+  ParallelFor(pool, view_ids.size(), num_blocks, [&](const int start,
+                                                     const int end) {
+    for (int i = start; i < end; i++) {
+      const View& view = *reconstruction_.View(view_ids[i]);
+      std::vector<TrackId> track_ids = view.TrackIds();
+      std::sort(track_ids.begin(), track_ids.end());
+      normalized_features[i].reserve(track_ids.size());
+      for (const TrackId track_id : track_ids) {
+        normalized_features[i].emplace_back(
+            track_id, GetNormalizedFeature(view, track_id));
+      }
+    }
+  });
+
+  // Intersect the sorted features of the views of each view pair.
+  std::vector<SharedFeatures> shared_features(view_pairs.size());
+  ParallelFor(pool, view_pairs.size(), num_blocks, [&](const int start,
+                                                       const int end) {
+    for (int i = start; i < end; i++) {
+      const auto& features1 =
+          normalized_features[FindOrDie(view_indices, view_pairs[i].first)];
+      const auto& features2 =
+          normalized_features[FindOrDie(view_indices, view_pairs[i].second)];
+      SharedFeatures& shared = shared_features[i];
+      auto it1 = features1.begin();
+      auto it2 = features2.begin();
+      while (it1 != features1.end() && it2 != features2.end()) {
+        if (it1->first < it2->first) {
+          ++it1;
+        } else if (it2->first < it1->first) {
+          ++it2;
+        } else {
+          shared.track_ids.emplace_back(it1->first);
+          shared.features1.emplace_back(it1->second);
+          shared.features2.emplace_back(it2->second);
+          ++it1;
+          ++it2;
+        }
+      }
+    }
+  });
+
+  shared_features_.clear();
+  shared_features_.reserve(view_pairs.size());
+  for (int i = 0; i < view_pairs.size(); i++) {
+    shared_features_.emplace(view_pairs[i], std::move(shared_features[i]));
+  }
+}
+
 void LinearPositionEstimator::ComputeBaselineRatioForTriplet(
     const ViewIdTriplet& triplet, Vector3d* baseline) {
   baseline->setZero();
 
-  const View& view1 = *reconstruction_.View(std::get<0>(triplet));
-  const View& view2 = *reconstruction_.View(std::get<1>(triplet));
-  const View& view3 = *reconstruction_.View(std::get<2>(triplet));
-
-  // Find common tracks.
-  const std::vector<ViewId> triplet_view_ids = {
-      std::get<0>(triplet), std::get<1>(triplet), std::get<2>(triplet)};
-  const std::vector<TrackId>& common_tracks =
-      FindCommonTracksInViews(reconstruction_, triplet_view_ids);
-
-  // Normalize all features.
+  // The tracks common to all three views are the tracks shared by both the
+  // first and second view pairs. Both lists are sorted by track id.
+  const SharedFeatures& shared_features12 = FindOrDie(
+      shared_features_,
+      ViewIdPair(std::get<0>(triplet), std::get<1>(triplet)));
+  const SharedFeatures& shared_features13 = FindOrDie(
+      shared_features_,
+      ViewIdPair(std::get<0>(triplet), std::get<2>(triplet)));
   std::vector<Feature> feature1, feature2, feature3;
-  feature1.reserve(common_tracks.size());
-  feature2.reserve(common_tracks.size());
-  feature3.reserve(common_tracks.size());
-  for (const TrackId track_id : common_tracks) {
-    feature1.emplace_back(GetNormalizedFeature(view1, track_id).point_);
-    feature2.emplace_back(GetNormalizedFeature(view2, track_id).point_);
-    feature3.emplace_back(GetNormalizedFeature(view3, track_id).point_);
+  int i = 0, j = 0;
+  while (i < shared_features12.track_ids.size() &&
+         j < shared_features13.track_ids.size()) {
+    if (shared_features12.track_ids[i] < shared_features13.track_ids[j]) {
+      ++i;
+    } else if (shared_features13.track_ids[j] <
+               shared_features12.track_ids[i]) {
+      ++j;
+    } else {
+      feature1.emplace_back(shared_features12.features1[i]);
+      feature2.emplace_back(shared_features12.features2[i]);
+      feature3.emplace_back(shared_features13.features2[j]);
+      ++i;
+      ++j;
+    }
   }
 
   // Get the baseline ratios.
@@ -48,6 +48,7 @@
 
 namespace theia {
 class Reconstruction;
+class ThreadPool;
 class TwoViewInfo;
 class View;
 
@@ -87,6 +88,10 @@ class LinearPositionEstimator : public PositionEstimator {
   // (i.e. focal length an principal point) have been removed.
   Feature GetNormalizedFeature(const View& view, const TrackId track_id);
 
+  // Normalizes the features of all views in the triplets once and indexes the
+  // features shared by the views of each view pair in the triplets.
+  void IndexSharedFeatures(ThreadPool* pool);
+
   // Computes the relative baselines between three views in a triplet. The
   // baseline is estimated from the depths of triangulated 3D points. The
   // relative positions of the triplets are then scaled to account for the
@@ -131,6 +136,16 @@ class LinearPositionEstimator : public PositionEstimator {
   std::vector<ViewIdTriplet> triplets_;
   std::vector<Eigen::Vector3d> baselines_;
 
+  // The normalized features of the tracks observed by both views of a view
+  // pair, sorted by track id. This is only populated while the baselines are
+  // computed.
+  struct SharedFeatures {
+    std::vector<TrackId> track_ids;
+    std::vector<Feature> features1;
+    std::vector<Feature> features2;
+  };
+  std::unordered_map<ViewIdPair, SharedFeatures> shared_features_;
+
   // We keep one of the positions as constant to remove the ambiguity of the
   // origin of the linear system.
   static const int kConstantPositionIndex = -1;
@@ -277,4 +277,14 @@ TEST_F(EstimatePositionsLinearTest, SmallTestWithNoise) {
                               kTolerance);
 }
 
+TEST_F(EstimatePositionsLinearTest, MultithreadedNoNoise) {
+  static const double kTolerance = 1e-4;
+  static const int kNumViews = 12;
+  static const int kNumTracksPerView = 50;
+  static const int kNumViewPairs = 66;
+  options_.num_threads = 4;
+  TestLinearPositionEstimator(
+      kNumViews, kNumTracksPerView, kNumViewPairs, 0.0, kTolerance);
+}
+
 }  // namespace theia
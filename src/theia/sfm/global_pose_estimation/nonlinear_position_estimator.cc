@@ -38,13 +38,17 @@
 #include <algorithm>
 #include <ceres/ceres.h>
 #include <ceres/rotation.h>
+#include <cmath>
 #include <unordered_map>
 #include <unordered_set>
 #include <utility>
 #include <vector>
 
+#include "theia/math/graph/parallel_minimum_spanning_tree.h"
+#include "theia/sfm/global_pose_estimation/LiGT_position_estimator.h"
 #include "theia/sfm/global_pose_estimation/pairwise_translation_error.h"
 #include "theia/sfm/reconstruction.h"
+#include "theia/sfm/sub_reconstruction.h"
 #include "theia/sfm/types.h"
 #include "theia/util/map_util.h"
 #include "theia/util/random.h"
@@ -91,6 +95,7 @@ NonlinearPositionEstimator::NonlinearPositionEstimator(
   CHECK_GE(options_.min_num_points_per_view, 0);
   CHECK_GT(options_.point_to_camera_weight, 0);
   CHECK_GT(options_.robust_loss_width, 0);
+  CHECK_GE(options_.min_num_view_pairs_per_view, 0);
 
   if (options_.rng.get() == nullptr) {
     rng_ = std::make_shared<RandomNumberGenerator>();
@@ -106,11 +111,12 @@ bool NonlinearPositionEstimator::EstimateRemainingPositionsInRecon(
     std::unordered_map<ViewId, Eigen::Vector3d>* positions) {
   triangulated_points_.clear();
 
-  // first grab a subreconstruction
-  Reconstruction sub_reconstruction;
-  reconstruction_.GetSubReconstruction(views_in_subrecon, &sub_reconstruction);
+  // first grab a subreconstruction. The cameras are only read so the views are
+  // not copied.
+  const SubReconstruction sub_reconstruction(reconstruction_,
+                                             views_in_subrecon);
 
-  const auto view_ids = sub_reconstruction.ViewIds();
+  const auto& view_ids = sub_reconstruction.ViewIds();
   std::unordered_map<ViewId, Vector3d> orientations;
   // get last view id as we assume sequential processing
   for (auto& v_id : view_ids) {
@@ -133,6 +139,12 @@ std::pair<bool, std::unordered_map<ViewId, Eigen::Vector3d>> NonlinearPositionEs
   return std::make_pair(success, positions);
 }
 
+void NonlinearPositionEstimator::SetViewsFixed(
+    const std::vector<ViewId>& fixed_views) {
+  fixed_views_.clear();
+  fixed_views_.insert(fixed_views.begin(), fixed_views.end());
+}
+
 bool NonlinearPositionEstimator::EstimatePositions(
     const std::unordered_map<ViewIdPair, TwoViewInfo>& view_pairs,
     const std::unordered_map<ViewId, Vector3d>& orientations,
@@ -146,14 +158,21 @@ bool NonlinearPositionEstimator::EstimatePositions(
   triangulated_points_.clear();
   problem_.reset(new ceres::Problem());
   view_pairs_ = &view_pairs;
+  if (options_.subsample_view_pairs) {
+    SubsampleViewPairs(view_pairs);
+    view_pairs_ = &subsampled_view_pairs_;
+  }
 
   // Iterative schur is only used if the problem is large enough, otherwise
   // sparse schur is used.
   static const int kMinNumCamerasForIterativeSolve = 1000;
 
-  // Initialize positions to be random.
+  // Initialize positions from LiGT if desired, otherwise randomly.
   if (fixed_views_.size() == 0) {
-    InitializeRandomPositions(orientations, positions);
+    if (!options_.initialize_with_ligt ||
+        !InitializePositionsWithLiGT(orientations, positions)) {
+      InitializeRandomPositions(orientations, positions);
+    }
   }
 
   // Add the constraints to the problem.
@@ -223,6 +242,130 @@ void NonlinearPositionEstimator::InitializeRandomPositions(
   }
 }
 
+bool NonlinearPositionEstimator::InitializePositionsWithLiGT(
+    const std::unordered_map<ViewId, Vector3d>& orientations,
+    std::unordered_map<ViewId, Vector3d>* positions) {
+  LiGTPositionEstimator::Options ligt_options;
+  ligt_options.num_threads = options_.num_threads;
+  LiGTPositionEstimator ligt_estimator(ligt_options, reconstruction_);
+  std::unordered_map<ViewId, Vector3d> ligt_positions;
+  if (!ligt_estimator.EstimatePositions(
+          *view_pairs_, orientations, &ligt_positions) ||
+      ligt_positions.size() < 2) {
+    VLOG(2) << "LiGT initialization failed. Falling back to random positions.";
+    return false;
+  }
+
+  // The LiGT solution is only defined up to sign. Flip it if the majority of
+  // the relative translations point the wrong way.
+  int num_consistent_view_pairs = 0;
+  int num_inconsistent_view_pairs = 0;
+  for (const auto& view_pair : *view_pairs_) {
+    const Vector3d* position1 =
+        FindOrNull(ligt_positions, view_pair.first.first);
+    const Vector3d* position2 =
+        FindOrNull(ligt_positions, view_pair.first.second);
+    const Vector3d* orientation1 =
+        FindOrNull(orientations, view_pair.first.first);
+    if (position1 == nullptr || position2 == nullptr ||
+        orientation1 == nullptr) {
+      continue;
+    }
+    const Vector3d translation_direction =
+        GetRotatedTranslation(*orientation1, view_pair.second.position_2);
+    if ((*position2 - *position1).dot(translation_direction) >= 0.0) {
+      ++num_consistent_view_pairs;
+    } else {
+      ++num_inconsistent_view_pairs;
+    }
+  }
+  const double sign =
+      num_inconsistent_view_pairs > num_consistent_view_pairs ? -1.0 : 1.0;
+
+  // Views that LiGT could not estimate are placed randomly within the extent
+  // of the LiGT solution.
+  Vector3d centroid = Vector3d::Zero();
+  for (const auto& position : ligt_positions) {
+    centroid += sign * position.second;
+  }
+  centroid /= static_cast<double>(ligt_positions.size());
+  double extent = 0.0;
+  for (const auto& position : ligt_positions) {
+    extent += (sign * position.second - centroid).squaredNorm();
+  }
+  extent = std::sqrt(extent / static_cast<double>(ligt_positions.size()));
+
+  std::unordered_set<ViewId> constrained_positions;
+  constrained_positions.reserve(orientations.size());
+  for (const auto& view_pair : *view_pairs_) {
+    constrained_positions.insert(view_pair.first.first);
+    constrained_positions.insert(view_pair.first.second);
+  }
+
+  positions->reserve(orientations.size());
+  for (const auto& orientation : orientations) {
+    if (!ContainsKey(constrained_positions, orientation.first)) {
+      continue;
+    }
+    const Vector3d* ligt_position =
+        FindOrNull(ligt_positions, orientation.first);
+    if (ligt_position != nullptr) {
+      (*positions)[orientation.first] = sign * (*ligt_position);
+    } else {
+      (*positions)[orientation.first] =
+          centroid + extent * rng_->RandVector3d();
+    }
+  }
+  return true;
+}
+
+void NonlinearPositionEstimator::SubsampleViewPairs(
+    const std::unordered_map<ViewIdPair, TwoViewInfo>& view_pairs) {
+  subsampled_view_pairs_.clear();
+
+  // Keep a maximum spanning tree so that the view graph stays connected. The
+  // MST extractor minimizes the weight so the number of matches is negated.
+  ParallelMinimumSpanningTree<ViewId, int> mst_extractor(options_.num_threads);
+  for (const auto& view_pair : view_pairs) {
+    mst_extractor.AddEdge(view_pair.first.first,
+                          view_pair.first.second,
+                          -view_pair.second.num_verified_matches);
+  }
+  std::unordered_set<ViewIdPair> spanning_tree;
+  mst_extractor.Extract(&spanning_tree);
+  for (const ViewIdPair& view_id_pair : spanning_tree) {
+    subsampled_view_pairs_.emplace(view_id_pair,
+                                   FindOrDie(view_pairs, view_id_pair));
+  }
+
+  // Add the strongest view pairs of each view until each view has the minimum
+  // number of constraints.
+  std::unordered_map<ViewId, std::vector<std::pair<int, ViewIdPair> > >
+      view_pairs_per_view;
+  for (const auto& view_pair : view_pairs) {
+    const std::pair<int, ViewIdPair> edge(
+        -view_pair.second.num_verified_matches, view_pair.first);
+    view_pairs_per_view[view_pair.first.first].emplace_back(edge);
+    view_pairs_per_view[view_pair.first.second].emplace_back(edge);
+  }
+  for (auto& incident_view_pairs : view_pairs_per_view) {
+    auto& edges = incident_view_pairs.second;
+    const int num_edges_to_add =
+        std::min(static_cast<int>(edges.size()),
+                 options_.min_num_view_pairs_per_view);
+    std::partial_sort(
+        edges.begin(), edges.begin() + num_edges_to_add, edges.end());
+    for (int i = 0; i < num_edges_to_add; i++) {
+      subsampled_view_pairs_.emplace(edges[i].second,
+                                     FindOrDie(view_pairs, edges[i].second));
+    }
+  }
+
+  VLOG(2) << "Subsampled " << view_pairs.size() << " view pairs to "
+          << subsampled_view_pairs_.size()
+          << " view pairs for position estimation.";
+}
+
 void NonlinearPositionEstimator::AddCameraToCameraConstraints(
     const std::unordered_map<ViewId, Vector3d>& orientations,
     std::unordered_map<ViewId, Vector3d>* positions) {
@@ -243,7 +386,10 @@ void NonlinearPositionEstimator::AddCameraToCameraConstraints(
         FindOrDie(orientations, view_id1), view_pair.second.position_2);
 
     ceres::CostFunction* cost_function =
-        PairwiseTranslationError::Create(translation_direction, 1.0);
+        options_.use_analytic_jacobians
+            ? PairwiseTranslationError::CreateAnalytic(translation_direction,
+                                                       1.0)
+            : PairwiseTranslationError::Create(translation_direction, 1.0);
 
     problem_->AddResidualBlock(cost_function,
                                new ceres::HuberLoss(options_.robust_loss_width),
@@ -400,7 +546,11 @@ void NonlinearPositionEstimator::AddTrackToProblem(
     // Rotate the relative translation so that it is aligned to the global
     // orientation frame.
     ceres::CostFunction* cost_function =
-        PairwiseTranslationError::Create(feature_ray, point_to_camera_weight);
+        options_.use_analytic_jacobians
+            ? PairwiseTranslationError::CreateAnalytic(feature_ray,
+                                                       point_to_camera_weight)
+            : PairwiseTranslationError::Create(feature_ray,
+                                               point_to_camera_weight);
 
     // Add the residual block
     problem_->AddResidualBlock(cost_function,
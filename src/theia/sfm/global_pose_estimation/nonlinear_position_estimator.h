@@ -39,18 +39,20 @@
 #include <ceres/problem.h>
 #include <ceres/solver.h>
 #include <memory>
+#include <set>
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
 
 #include "theia/sfm/global_pose_estimation/position_estimator.h"
+#include "theia/sfm/twoview_info.h"
 #include "theia/sfm/types.h"
+#include "theia/util/hash.h"
 #include "theia/util/util.h"
 
 namespace theia {
 class RandomNumberGenerator;
 class Reconstruction;
-class TwoViewInfo;
 class View;
 
 // Estimates the camera position of views given pairwise relative poses and the
@@ -79,6 +81,27 @@ class NonlinearPositionEstimator : public PositionEstimator {
     // The total weight of all point to camera correspondences compared to
     // camera to camera correspondences.
     double point_to_camera_weight = 0.5;
+
+    // Use closed-form jacobians for the pairwise translation constraints
+    // instead of automatic differentiation.
+    bool use_analytic_jacobians = true;
+
+    // On dense view graphs the number of camera to camera constraints grows
+    // much faster than the number of cameras. If this is set, only a subset of
+    // the view pairs is used: a maximum spanning tree of the view graph
+    // (weighted by the number of verified matches) so that the graph stays
+    // connected, plus the strongest view pairs of each view until every view
+    // has at least min_num_view_pairs_per_view constraints. The problem size
+    // then scales with the number of views rather than the number of view
+    // pairs.
+    bool subsample_view_pairs = false;
+    int min_num_view_pairs_per_view = 10;
+
+    // If true, the positions are initialized with the linear
+    // LiGTPositionEstimator instead of randomly. This requires the tracks of
+    // the reconstruction. Views that are not estimated by LiGT are initialized
+    // randomly.
+    bool initialize_with_ligt = false;
   };
 
   NonlinearPositionEstimator(const NonlinearPositionEstimator::Options& options,
@@ -108,7 +131,9 @@ class NonlinearPositionEstimator : public PositionEstimator {
     const std::unordered_set<ViewId>& views_in_subrecon,
     const std::unordered_map<ViewIdPair, TwoViewInfo>& view_pairs_sub_recon);
 
-  // Set view ids fixed
+  // Holds the positions of these views constant in EstimatePositions. Their
+  // positions must be given and the positions of the other views must be
+  // initialized by the caller.
   void SetViewsFixed(const std::vector<ViewId>& fixed_views);
 
  private:
@@ -118,6 +143,17 @@ class NonlinearPositionEstimator : public PositionEstimator {
       const std::unordered_map<ViewId, Eigen::Vector3d>& orientations,
       std::unordered_map<ViewId, Eigen::Vector3d>* positions);
 
+  // Initialize the cameras with the linear LiGT position estimator. Returns
+  // false if LiGT failed, in which case the positions are left untouched.
+  bool InitializePositionsWithLiGT(
+      const std::unordered_map<ViewId, Eigen::Vector3d>& orientations,
+      std::unordered_map<ViewId, Eigen::Vector3d>* positions);
+
+  // Selects the view pairs used for camera to camera constraints as described
+  // in Options::subsample_view_pairs.
+  void SubsampleViewPairs(
+      const std::unordered_map<ViewIdPair, TwoViewInfo>& view_pairs);
+
   // Creates camera to camera constraints from relative translations.
   void AddCameraToCameraConstraints(
       const std::unordered_map<ViewId, Eigen::Vector3d>& orientations,
@@ -159,6 +195,7 @@ class NonlinearPositionEstimator : public PositionEstimator {
   const NonlinearPositionEstimator::Options options_;
   const Reconstruction& reconstruction_;
   const std::unordered_map<ViewIdPair, TwoViewInfo>* view_pairs_;
+  std::unordered_map<ViewIdPair, TwoViewInfo> subsampled_view_pairs_;
   std::set<ViewId> fixed_views_;
 
   std::shared_ptr<RandomNumberGenerator> rng_;
@@ -367,4 +367,49 @@ TEST_F(EstimatePositionsNonlinearTest, LargeTestNoiseFixedCamsSequential) {
                                  kNrPointsPerView);
 }
 
+TEST_F(EstimatePositionsNonlinearTest, SubsampledViewPairsNoNoise) {
+  static const double kTolerance = 1e-2;
+  static const int kNumViews = 30;
+  static const int kNumTracksPerView = 10;
+  static const int kNumViewPairs = 300;
+  std::set<ViewId> fixed_views;
+  options_.subsample_view_pairs = true;
+  options_.min_num_view_pairs_per_view = 4;
+  TestNonlinearPositionEstimator(
+      kNumViews, kNumTracksPerView, kNumViewPairs,
+      0.0, kTolerance, fixed_views);
+}
+
+TEST_F(EstimatePositionsNonlinearTest, AutodiffJacobiansWithNoise) {
+  static const double kTolerance = 0.1;
+  static const int kNumViews = 4;
+  static const int kNumTracksPerView = 10;
+  static const int kNumViewPairs = 6;
+  static const double kPoseNoiseDegrees = 1.0;
+  std::set<ViewId> fixed_views;
+  options_.use_analytic_jacobians = false;
+  TestNonlinearPositionEstimator(kNumViews,
+                                 kNumTracksPerView,
+                                 kNumViewPairs,
+                                 kPoseNoiseDegrees,
+                                 kTolerance,
+                                 fixed_views);
+}
+
+TEST_F(EstimatePositionsNonlinearTest, LiGTInitializationWithNoise) {
+  static const double kTolerance = 0.1;
+  static const int kNumViews = 20;
+  static const int kNumTracksPerView = 50;
+  static const int kNumViewPairs = 60;
+  static const double kPoseNoiseDegrees = 0.5;
+  std::set<ViewId> fixed_views;
+  options_.initialize_with_ligt = true;
+  TestNonlinearPositionEstimator(kNumViews,
+                                 kNumTracksPerView,
+                                 kNumViewPairs,
+                                 kPoseNoiseDegrees,
+                                 kTolerance,
+                                 fixed_views);
+}
+
 }  // namespace theia
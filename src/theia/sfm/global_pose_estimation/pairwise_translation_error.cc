@@ -39,6 +39,68 @@
 
 namespace theia {
 
+namespace {
+
+class AnalyticPairwiseTranslationError
+    : public ceres::SizedCostFunction<3, 3, 3> {
+ public:
+  AnalyticPairwiseTranslationError(const Eigen::Vector3d& translation_direction,
+                                   const double weight)
+      : translation_direction_(translation_direction), weight_(weight) {
+    CHECK_GT(weight_, 0);
+  }
+
+  bool Evaluate(double const* const* parameters,
+                double* residuals,
+                double** jacobians) const {
+    static const double kNormTolerance = 1e-12;
+
+    const Eigen::Map<const Eigen::Vector3d> position1(parameters[0]);
+    const Eigen::Map<const Eigen::Vector3d> position2(parameters[1]);
+    const Eigen::Vector3d translation = position2 - position1;
+    double norm = translation.norm();
+
+    // Mirror the autodiff version: tiny translations are not normalized and
+    // the norm is treated as a constant.
+    const bool is_degenerate = norm < kNormTolerance;
+    if (is_degenerate) {
+      norm = 1.0;
+    }
+
+    const Eigen::Vector3d unit_translation = translation / norm;
+    Eigen::Map<Eigen::Vector3d> residual(residuals);
+    residual = weight_ * (unit_translation - translation_direction_);
+
+    if (jacobians == nullptr) {
+      return true;
+    }
+
+    Eigen::Matrix3d jacobian = (weight_ / norm) * Eigen::Matrix3d::Identity();
+    if (!is_degenerate) {
+      jacobian -= (weight_ / norm) * unit_translation *
+                  unit_translation.transpose();
+    }
+
+    // Ceres expects row-major jacobians. The jacobian is symmetric so the
+    // storage order does not matter.
+    if (jacobians[0] != nullptr) {
+      Eigen::Map<Eigen::Matrix3d> jacobian1(jacobians[0]);
+      jacobian1 = -jacobian;
+    }
+    if (jacobians[1] != nullptr) {
+      Eigen::Map<Eigen::Matrix3d> jacobian2(jacobians[1]);
+      jacobian2 = jacobian;
+    }
+    return true;
+  }
+
+ private:
+  const Eigen::Vector3d translation_direction_;
+  const double weight_;
+};
+
+}  // namespace
+
 PairwiseTranslationError::PairwiseTranslationError(
     const Eigen::Vector3d& translation_direction, const double weight)
     : translation_direction_(translation_direction), weight_(weight) {
@@ -51,4 +113,9 @@ ceres::CostFunction* PairwiseTranslationError::Create(
       new PairwiseTranslationError(translation_direction, weight)));
 }
 
+ceres::CostFunction* PairwiseTranslationError::CreateAnalytic(
+    const Eigen::Vector3d& translation_direction, const double weight) {
+  return new AnalyticPairwiseTranslationError(translation_direction, weight);
+}
+
 }  // namespace theia
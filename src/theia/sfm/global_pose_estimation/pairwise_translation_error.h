@@ -56,6 +56,13 @@ struct PairwiseTranslationError {
   static ceres::CostFunction* Create(
       const Eigen::Vector3d& translation_direction, const double weight);
 
+  // Same residual as above, but the jacobians are computed in closed form
+  // instead of with automatic differentiation. The jacobian w.r.t. position2
+  // is weight / |c_j - c_i| * (I - u * u^T) with u the unit translation, and
+  // the jacobian w.r.t. position1 is its negative.
+  static ceres::CostFunction* CreateAnalytic(
+      const Eigen::Vector3d& translation_direction, const double weight);
+
   const Eigen::Vector3d translation_direction_;
   const double weight_;
 };
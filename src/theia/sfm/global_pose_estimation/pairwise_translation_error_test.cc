@@ -34,6 +34,7 @@
 
 #include <ceres/ceres.h>
 #include <glog/logging.h>
+#include <memory>
 
 #include "theia/sfm/global_pose_estimation/pairwise_translation_error.h"
 #include "gtest/gtest.h"
@@ -70,6 +71,37 @@ void PairwiseTranslationErrorTest(const Vector3d& known_translation,
   EXPECT_DOUBLE_EQ(error(2), expected_error(2));
 }
 
+// Evaluates the autodiff and analytic cost functions at the given positions and
+// checks that both the residuals and the jacobians agree.
+void AnalyticJacobianTest(const Vector3d& known_translation,
+                          const double weight,
+                          const Vector3d& position_1,
+                          const Vector3d& position_2) {
+  static const double kTolerance = 1e-12;
+
+  std::unique_ptr<ceres::CostFunction> autodiff_cost_function(
+      PairwiseTranslationError::Create(known_translation, weight));
+  std::unique_ptr<ceres::CostFunction> analytic_cost_function(
+      PairwiseTranslationError::CreateAnalytic(known_translation, weight));
+
+  const double* parameters[2] = {position_1.data(), position_2.data()};
+  Vector3d autodiff_residual, analytic_residual;
+  Matrix3d autodiff_jacobian1, autodiff_jacobian2;
+  Matrix3d analytic_jacobian1, analytic_jacobian2;
+  double* autodiff_jacobians[2] = {autodiff_jacobian1.data(),
+                                   autodiff_jacobian2.data()};
+  double* analytic_jacobians[2] = {analytic_jacobian1.data(),
+                                   analytic_jacobian2.data()};
+  EXPECT_TRUE(autodiff_cost_function->Evaluate(
+      parameters, autodiff_residual.data(), autodiff_jacobians));
+  EXPECT_TRUE(analytic_cost_function->Evaluate(
+      parameters, analytic_residual.data(), analytic_jacobians));
+
+  EXPECT_LT((autodiff_residual - analytic_residual).norm(), kTolerance);
+  EXPECT_LT((autodiff_jacobian1 - analytic_jacobian1).norm(), kTolerance);
+  EXPECT_LT((autodiff_jacobian2 - analytic_jacobian2).norm(), kTolerance);
+}
+
 }  // namespace
 
 TEST(PairwiseTranslationError, NoTranslation) {
@@ -120,4 +152,27 @@ TEST(PairwiseTranslationError, NontrivialWeight) {
       relative_translation, kNontrivialWeight, position_1, position_2);
 }
 
+TEST(PairwiseTranslationError, AnalyticJacobianMatchesAutodiff) {
+  const Vector3d position_1(0.3, -1.2, 0.5);
+  const Vector3d position_2(2.0, 0.4, -0.7);
+  const Vector3d relative_translation =
+      ((position_2 - position_1).normalized() + Vector3d(0.05, -0.02, 0.01))
+          .normalized();
+
+  static const double kNontrivialWeight = 1.1;
+  AnalyticJacobianTest(
+      relative_translation, kNontrivialWeight, position_1, position_2);
+}
+
+TEST(PairwiseTranslationError, AnalyticJacobianNoTranslation) {
+  const Vector3d position_1(1.0, 0.0, 0.0);
+  const Vector3d position_2(1.0, 0.0, 0.0);
+  const Vector3d relative_translation(1.0, 0.0, 0.0);
+
+  AnalyticJacobianTest(relative_translation,
+                       kRelativeTranslationWeight,
+                       position_1,
+                       position_2);
+}
+
 }  // namespace theia
@@ -40,8 +40,8 @@
 #include <unordered_map>
 
 #include "theia/math/l1_solver.h"
-#include "theia/math/matrix/sparse_cholesky_llt.h"
 #include "theia/math/rotation.h"
+#include "theia/sfm/global_pose_estimation/rotation_averaging_linear_system.h"
 #include "theia/sfm/types.h"
 #include "theia/util/hash.h"
 #include "theia/util/map_util.h"
@@ -112,63 +112,42 @@ bool RobustRotationEstimator::EstimateRotations(
 void RobustRotationEstimator::SetupLinearSystem() {
   // The rotation change is one less than the number of global rotations because
   // we keep one rotation constant.
-  tangent_space_step_.resize((global_orientations_->size() - nr_fixed_rotations_) * 3);
+  const int num_rotations =
+      global_orientations_->size() - nr_fixed_rotations_;
+  tangent_space_step_.resize(num_rotations * 3);
   tangent_space_residual_.resize(relative_rotations_.size() * 3);
-  sparse_matrix_.resize(relative_rotations_.size() * 3,
-                        (global_orientations_->size() - nr_fixed_rotations_) * 3);
 
-  // For each relative rotation constraint, add an entry to the sparse
-  // matrix. We use the first order approximation of angle axis such that:
+  // For each relative rotation constraint, add an edge between the views. We
+  // use the first order approximation of angle axis such that:
   // R_ij = R_j - R_i. This makes the sparse matrix just a bunch of identity
-  // matrices.
-  int rotation_error_index = 0;
-  std::vector<Eigen::Triplet<double> > triplet_list;
+  // matrices. The fixed views have negative indices and are held constant.
+  std::vector<std::pair<int, int> > edges;
+  edges.reserve(relative_rotations_.size());
   for (const auto& relative_rotation : relative_rotations_) {
-
-    // see if this rotation should be fixed
-    if (fixed_view_ids_.find(relative_rotation.first.first) == fixed_view_ids_.end()) {
-      const int view1_index =
-        FindOrDie(view_id_to_index_, relative_rotation.first.first);
-
-      triplet_list.emplace_back(3 * rotation_error_index,
-                                3 * view1_index,
-                                -1.0);
-      triplet_list.emplace_back(3 * rotation_error_index + 1,
-                                3 * view1_index + 1,
-                                -1.0);
-      triplet_list.emplace_back(3 * rotation_error_index + 2,
-                                3 * view1_index + 2,
-                                -1.0);
-
-    }
-    if (fixed_view_ids_.find(relative_rotation.first.second) == fixed_view_ids_.end())  {
-      const int view2_index =
-        FindOrDie(view_id_to_index_, relative_rotation.first.second);
-      triplet_list.emplace_back(3 * rotation_error_index + 0,
-                                3 * view2_index + 0,
-                                1.0);
-      triplet_list.emplace_back(3 * rotation_error_index + 1,
-                                3 * view2_index + 1,
-                                1.0);
-      triplet_list.emplace_back(3 * rotation_error_index + 2,
-                                3 * view2_index + 2,
-                                1.0);
-
-    }
-
-    ++rotation_error_index;
+    edges.emplace_back(
+        FindOrDie(view_id_to_index_, relative_rotation.first.first),
+        FindOrDie(view_id_to_index_, relative_rotation.first.second));
   }
-  sparse_matrix_.setFromTriplets(triplet_list.begin(), triplet_list.end());
+  linear_system_.reset(new RotationAveragingLinearSystem(
+      num_rotations, edges, options_.num_threads));
+  sparse_matrix_ = linear_system_->Matrix();
 }
 
 bool RobustRotationEstimator::SolveL1Regression() {
   L1Solver<Eigen::SparseMatrix<double> >::Options options;
   options.max_num_iterations = 5;
+  // The residuals change little between the iterations below, so each solve
+  // starts from the dual variables and rho of the previous one.
+  options.adaptive_rho = true;
+  options.warm_start = true;
+  options.num_threads = options_.num_threads;
   L1Solver<Eigen::SparseMatrix<double> > l1_solver(options, sparse_matrix_);
 
-  tangent_space_step_.setZero();
   ComputeResiduals();
   for (int i = 0; i < options_.max_num_l1_iterations; i++) {
+    // The rotations were updated with the previous step, so the new step
+    // starts from zero.
+    tangent_space_step_.setZero();
     l1_solver.Solve(tangent_space_residual_, &tangent_space_step_);
     UpdateGlobalRotations();
     ComputeResiduals();
@@ -187,45 +166,30 @@ bool RobustRotationEstimator::SolveL1Regression() {
 bool RobustRotationEstimator::SolveIRLS() {
   const int num_edges = tangent_space_residual_.size() / 3;
 
-  // Set up the linear solver and analyze the sparsity pattern of the
-  // system. Since the sparsity pattern will not change with each linear solve
-  // this can help speed up the solution time.
-  SparseCholeskyLLt linear_solver;
-  linear_solver.AnalyzePattern(sparse_matrix_.transpose() * sparse_matrix_);
-  if (linear_solver.Info() != Eigen::Success) {
-    LOG(ERROR) << "Cholesky decomposition failed.";
-    return false;
-  }
-
   VLOG(2) << "Iteration   SqError         Delta";
   const std::string row_format = "  % 4d     % 4.4e     % 4.4e";
 
   ComputeResiduals();
 
-  Eigen::ArrayXd weights(num_edges * 3);
-  Eigen::SparseMatrix<double> at_weight;
+  Eigen::VectorXd weights(num_edges);
   for (int i = 0; i < options_.max_num_irls_iterations; i++) {
     // Compute the Huber-like weights for each error term.
-    const double& sigma = options_.irls_loss_parameter_sigma;
-    for (int k = 0; k < num_edges; ++k) {
-      double e_sq = tangent_space_residual_.segment<3>(3 * k).squaredNorm();
-      double tmp = e_sq + sigma * sigma;
-      double w = sigma / (tmp * tmp);
-      weights.segment<3>(3 * k).setConstant(w);
-    }
-
-    // Update the factorization for the weighted values.
-    at_weight = sparse_matrix_.transpose() * weights.matrix().asDiagonal();
-    linear_solver.Factorize(at_weight * sparse_matrix_);
-    if (linear_solver.Info() != Eigen::Success) {
-      LOG(ERROR) << "Failed to factorize the least squares system.";
-      return false;
-    }
+    const double sigma = options_.irls_loss_parameter_sigma;
+    linear_system_->RunInParallel(num_edges, [&](const int start,
+                                                 const int end) {
+      for (int k = start; k < end; ++k) {
+        const double e_sq =
+            tangent_space_residual_.segment<3>(3 * k).squaredNorm();
+        const double tmp = e_sq + sigma * sigma;
+        weights[k] = sigma / (tmp * tmp);
+      }
+    });
 
-    // Solve the least squares problem..
-    tangent_space_step_ =
-        linear_solver.Solve(at_weight * tangent_space_residual_);
-    if (linear_solver.Info() != Eigen::Success) {
+    // Solve the weighted least squares problem. The symbolic factorization of
+    // the normal equations is computed in the first iteration and reused
+    // since the sparsity pattern does not change.
+    if (!linear_system_->SolveWeightedLeastSquares(
+            weights, tangent_space_residual_, &tangent_space_step_)) {
       LOG(ERROR) << "Failed to solve the least squares system.";
       return false;
     }
@@ -266,21 +230,27 @@ void RobustRotationEstimator::UpdateGlobalRotations() {
 // Computes the relative rotation error based on the current global
 // orientation estimates.
 void RobustRotationEstimator::ComputeResiduals() {
-  int rotation_error_index = 0;
-  for (const auto& relative_rotation : relative_rotations_) {
-    const Eigen::Vector3d& relative_rotation_aa = relative_rotation.second;
-    const Eigen::Vector3d& rotation1 =
-        FindOrDie(*global_orientations_, relative_rotation.first.first);
-    const Eigen::Vector3d& rotation2 =
-        FindOrDie(*global_orientations_, relative_rotation.first.second);
-
-    // Compute the relative rotation error as:
-    //   R_err = R2^t * R_12 * R1.
-    tangent_space_residual_.segment<3>(3 * rotation_error_index) =
-        MultiplyRotations(-rotation2,
-                          MultiplyRotations(relative_rotation_aa, rotation1));
-    ++rotation_error_index;
-  }
+  linear_system_->RunInParallel(
+      relative_rotations_.size(), [&](const int start, const int end) {
+        for (int rotation_error_index = start; rotation_error_index < end;
+             ++rotation_error_index) {
+          const auto& relative_rotation =
+              relative_rotations_[rotation_error_index];
+          const Eigen::Vector3d& relative_rotation_aa =
+              relative_rotation.second;
+          const Eigen::Vector3d& rotation1 =
+              FindOrDie(*global_orientations_, relative_rotation.first.first);
+          const Eigen::Vector3d& rotation2 =
+              FindOrDie(*global_orientations_, relative_rotation.first.second);
+
+          // Compute the relative rotation error as:
+          //   R_err = R2^t * R_12 * R1.
+          tangent_space_residual_.segment<3>(3 * rotation_error_index) =
+              MultiplyRotations(
+                  -rotation2,
+                  MultiplyRotations(relative_rotation_aa, rotation1));
+        }
+      });
 }
 
 double RobustRotationEstimator::ComputeAverageStepSize() {
@@ -37,10 +37,12 @@
 
 #include <Eigen/Core>
 #include <Eigen/SparseCore>
+#include <memory>
 #include <unordered_map>
 #include <set>
 
 #include "theia/math/util.h"
+#include "theia/sfm/global_pose_estimation/rotation_averaging_linear_system.h"
 #include "theia/sfm/global_pose_estimation/rotation_estimator.h"
 #include "theia/sfm/types.h"
 #include "theia/util/hash.h"
@@ -80,6 +82,10 @@ class RobustRotationEstimator : public RotationEstimator {
     // This is the point where the Huber-like cost function switches from L1 to
     // L2.
     double irls_loss_parameter_sigma = DegToRad(5.0);
+
+    // The number of threads used to build and solve the linear systems and to
+    // compute the residuals and weights of the relative rotations.
+    int num_threads = 1;
   };
 
   explicit RobustRotationEstimator(const Options& options)
@@ -161,6 +167,10 @@ class RobustRotationEstimator : public RotationEstimator {
   // the linear system.
   std::unordered_map<ViewId, int> view_id_to_index_;
   
+  // The linear system, which is built from a CSR representation of the view
+  // graph and solves the weighted least squares problems of IRLS.
+  std::unique_ptr<RotationAveragingLinearSystem> linear_system_;
+
   // The sparse matrix used to maintain the linear system. This is matrix A in
   // Ax = b.
   Eigen::SparseMatrix<double> sparse_matrix_;
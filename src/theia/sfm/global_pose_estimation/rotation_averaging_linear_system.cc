@@ -0,0 +1,308 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#include "theia/sfm/global_pose_estimation/rotation_averaging_linear_system.h"
+
+#include <Eigen/Core>
+#include <Eigen/SparseCore>
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include "theia/math/matrix/sparse_cholesky_llt.h"
+#include "theia/util/threadpool.h"
+
+namespace theia {
+
+RotationAveragingLinearSystem::RotationAveragingLinearSystem(
+    const int num_rotations,
+    const std::vector<std::pair<int, int> >& edges,
+    const int num_threads)
+    : num_rotations_(num_rotations),
+      num_threads_(std::max(num_threads, 1)),
+      edges_(edges),
+      is_pattern_analyzed_(false) {
+  CHECK_GE(num_rotations_, 0);
+  if (num_threads_ > 1) {
+    thread_pool_.reset(new ThreadPool(num_threads_));
+  }
+
+  // Count the incident edges of each rotation.
+  rotation_offsets_.assign(num_rotations_ + 1, 0);
+  for (const auto& edge : edges_) {
+    CHECK_LT(edge.first, num_rotations_);
+    CHECK_LT(edge.second, num_rotations_);
+    CHECK(edge.first < 0 || edge.first != edge.second)
+        << "An edge must connect two different rotations.";
+    if (edge.first >= 0) {
+      ++rotation_offsets_[edge.first + 1];
+    }
+    if (edge.second >= 0) {
+      ++rotation_offsets_[edge.second + 1];
+    }
+  }
+  for (int i = 0; i < num_rotations_; i++) {
+    rotation_offsets_[i + 1] += rotation_offsets_[i];
+  }
+
+  // Fill in the incident edges in increasing order. The first rotation of an
+  // edge enters its constraint with a negative sign.
+  incident_edges_.resize(rotation_offsets_.back());
+  incident_edge_signs_.resize(rotation_offsets_.back());
+  std::vector<int> next_incident_edge(rotation_offsets_.begin(),
+                                      rotation_offsets_.end() - 1);
+  for (int e = 0; e < edges_.size(); e++) {
+    if (edges_[e].first >= 0) {
+      const int k = next_incident_edge[edges_[e].first]++;
+      incident_edges_[k] = e;
+      incident_edge_signs_[k] = -1.0;
+    }
+    if (edges_[e].second >= 0) {
+      const int k = next_incident_edge[edges_[e].second]++;
+      incident_edges_[k] = e;
+      incident_edge_signs_[k] = 1.0;
+    }
+  }
+
+  BuildMatrices();
+}
+
+RotationAveragingLinearSystem::~RotationAveragingLinearSystem() {}
+
+void RotationAveragingLinearSystem::BuildMatrices() {
+  const int num_columns = 3 * num_rotations_;
+
+  // The column of A for component d of rotation i has an entry in the row of
+  // component d of each incident edge.
+  matrix_.resize(3 * edges_.size(), num_columns);
+  matrix_.resizeNonZeros(3 * incident_edges_.size());
+  int num_entries = 0;
+  for (int i = 0; i < num_rotations_; i++) {
+    for (int d = 0; d < 3; d++) {
+      matrix_.outerIndexPtr()[3 * i + d] = num_entries;
+      for (int k = rotation_offsets_[i]; k < rotation_offsets_[i + 1]; k++) {
+        matrix_.innerIndexPtr()[num_entries] = 3 * incident_edges_[k] + d;
+        matrix_.valuePtr()[num_entries] = incident_edge_signs_[k];
+        ++num_entries;
+      }
+    }
+  }
+  matrix_.outerIndexPtr()[num_columns] = num_entries;
+
+  // The column of A^T * W * A for component d of rotation i has an entry in the
+  // row of component d of the rotation itself and of each non-constant
+  // rotation that shares an edge with it.
+  diagonal_entry_positions_.resize(num_rotations_);
+  off_diagonal_entry_positions_.resize(incident_edges_.size());
+  std::vector<int> normal_outer_indices(num_columns + 1);
+  std::vector<int> normal_inner_indices;
+  normal_inner_indices.reserve(3 * (num_rotations_ + incident_edges_.size()));
+  std::vector<int> neighbors;
+  for (int i = 0; i < num_rotations_; i++) {
+    neighbors.clear();
+    neighbors.emplace_back(i);
+    for (int k = rotation_offsets_[i]; k < rotation_offsets_[i + 1]; k++) {
+      const auto& edge = edges_[incident_edges_[k]];
+      const int other = edge.first == i ? edge.second : edge.first;
+      if (other >= 0) {
+        neighbors.emplace_back(other);
+      }
+    }
+    std::sort(neighbors.begin(), neighbors.end());
+    neighbors.erase(std::unique(neighbors.begin(), neighbors.end()),
+                    neighbors.end());
+
+    diagonal_entry_positions_[i] =
+        std::lower_bound(neighbors.begin(), neighbors.end(), i) -
+        neighbors.begin();
+    for (int k = rotation_offsets_[i]; k < rotation_offsets_[i + 1]; k++) {
+      const auto& edge = edges_[incident_edges_[k]];
+      const int other = edge.first == i ? edge.second : edge.first;
+      off_diagonal_entry_positions_[k] =
+          other < 0 ? -1
+                    : std::lower_bound(
+                          neighbors.begin(), neighbors.end(), other) -
+                          neighbors.begin();
+    }
+
+    for (int d = 0; d < 3; d++) {
+      normal_outer_indices[3 * i + d] = normal_inner_indices.size();
+      for (const int neighbor : neighbors) {
+        normal_inner_indices.emplace_back(3 * neighbor + d);
+      }
+    }
+  }
+  normal_outer_indices[num_columns] = normal_inner_indices.size();
+
+  normal_matrix_.resize(num_columns, num_columns);
+  normal_matrix_.resizeNonZeros(normal_inner_indices.size());
+  std::copy(normal_outer_indices.begin(),
+            normal_outer_indices.end(),
+            normal_matrix_.outerIndexPtr());
+  std::copy(normal_inner_indices.begin(),
+            normal_inner_indices.end(),
+            normal_matrix_.innerIndexPtr());
+  std::fill(normal_matrix_.valuePtr(),
+            normal_matrix_.valuePtr() + normal_inner_indices.size(),
+            0.0);
+}
+
+void RotationAveragingLinearSystem::Multiply(const Eigen::VectorXd& x,
+                                             Eigen::VectorXd* y) const {
+  CHECK_EQ(x.size(), 3 * num_rotations_);
+  CHECK_NOTNULL(y)->resize(3 * edges_.size());
+  ParallelFor(thread_pool_.get(),
+              edges_.size(),
+              num_threads_,
+              [&](const int start, const int end) {
+                for (int e = start; e < end; e++) {
+                  auto y_e = y->segment<3>(3 * e);
+                  y_e.setZero();
+                  if (edges_[e].first >= 0) {
+                    y_e -= x.segment<3>(3 * edges_[e].first);
+                  }
+                  if (edges_[e].second >= 0) {
+                    y_e += x.segment<3>(3 * edges_[e].second);
+                  }
+                }
+              });
+}
+
+void RotationAveragingLinearSystem::TransposeMultiply(
+    const Eigen::VectorXd& x, Eigen::VectorXd* y) const {
+  CHECK_EQ(x.size(), 3 * edges_.size());
+  CHECK_NOTNULL(y)->resize(3 * num_rotations_);
+  ParallelFor(thread_pool_.get(),
+              num_rotations_,
+              num_threads_,
+              [&](const int start, const int end) {
+                for (int i = start; i < end; i++) {
+                  Eigen::Vector3d y_i = Eigen::Vector3d::Zero();
+                  for (int k = rotation_offsets_[i];
+                       k < rotation_offsets_[i + 1];
+                       k++) {
+                    y_i += incident_edge_signs_[k] *
+                           x.segment<3>(3 * incident_edges_[k]);
+                  }
+                  y->segment<3>(3 * i) = y_i;
+                }
+              });
+}
+
+void RotationAveragingLinearSystem::ComputeNormalEquations(
+    const Eigen::VectorXd& edge_weights,
+    const Eigen::VectorXd& residuals,
+    Eigen::SparseMatrix<double>* normal_matrix,
+    Eigen::VectorXd* normal_rhs) const {
+  *CHECK_NOTNULL(normal_matrix) = normal_matrix_;
+  SetNormalEquationValues(
+      edge_weights, residuals, normal_matrix, CHECK_NOTNULL(normal_rhs));
+}
+
+void RotationAveragingLinearSystem::SetNormalEquationValues(
+    const Eigen::VectorXd& edge_weights,
+    const Eigen::VectorXd& residuals,
+    Eigen::SparseMatrix<double>* normal_matrix,
+    Eigen::VectorXd* normal_rhs) const {
+  CHECK_EQ(edge_weights.size(), edges_.size());
+  CHECK_EQ(residuals.size(), 3 * edges_.size());
+  normal_rhs->resize(3 * num_rotations_);
+
+  // Each thread sets the columns of its rotations, so no two threads write to
+  // the same entry.
+  const int* outer_indices = normal_matrix->outerIndexPtr();
+  double* values = normal_matrix->valuePtr();
+  ParallelFor(
+      thread_pool_.get(),
+      num_rotations_,
+      num_threads_,
+      [&](const int start, const int end) {
+        for (int i = start; i < end; i++) {
+          const int column_size =
+              outer_indices[3 * i + 1] - outer_indices[3 * i];
+          double* columns[3];
+          for (int d = 0; d < 3; d++) {
+            columns[d] = values + outer_indices[3 * i + d];
+            std::fill(columns[d], columns[d] + column_size, 0.0);
+          }
+
+          Eigen::Vector3d rhs_i = Eigen::Vector3d::Zero();
+          for (int k = rotation_offsets_[i]; k < rotation_offsets_[i + 1];
+               k++) {
+            const int e = incident_edges_[k];
+            const double weight = edge_weights[e];
+            for (int d = 0; d < 3; d++) {
+              columns[d][diagonal_entry_positions_[i]] += weight;
+              if (off_diagonal_entry_positions_[k] >= 0) {
+                columns[d][off_diagonal_entry_positions_[k]] -= weight;
+              }
+            }
+            rhs_i += incident_edge_signs_[k] * weight *
+                     residuals.segment<3>(3 * e);
+          }
+          normal_rhs->segment<3>(3 * i) = rhs_i;
+        }
+      });
+}
+
+bool RotationAveragingLinearSystem::SolveWeightedLeastSquares(
+    const Eigen::VectorXd& edge_weights,
+    const Eigen::VectorXd& residuals,
+    Eigen::VectorXd* solution) {
+  CHECK_NOTNULL(solution);
+  SetNormalEquationValues(
+      edge_weights, residuals, &normal_matrix_, &normal_rhs_);
+
+  // The sparsity pattern does not depend on the weights, so it only needs to
+  // be analyzed once.
+  if (!is_pattern_analyzed_) {
+    linear_solver_.AnalyzePattern(normal_matrix_);
+    if (linear_solver_.Info() != Eigen::Success) {
+      return false;
+    }
+    is_pattern_analyzed_ = true;
+  }
+
+  linear_solver_.Factorize(normal_matrix_);
+  if (linear_solver_.Info() != Eigen::Success) {
+    return false;
+  }
+
+  *solution = linear_solver_.Solve(normal_rhs_);
+  return linear_solver_.Info() == Eigen::Success;
+}
+
+}  // namespace theia
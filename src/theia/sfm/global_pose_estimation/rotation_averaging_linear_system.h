@@ -0,0 +1,152 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#ifndef THEIA_SFM_GLOBAL_POSE_ESTIMATION_ROTATION_AVERAGING_LINEAR_SYSTEM_H_
+#define THEIA_SFM_GLOBAL_POSE_ESTIMATION_ROTATION_AVERAGING_LINEAR_SYSTEM_H_
+
+#include <Eigen/Core>
+#include <Eigen/SparseCore>
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "theia/math/matrix/sparse_cholesky_llt.h"
+#include "theia/util/threadpool.h"
+
+namespace theia {
+
+// The linear system of the first-order rotation averaging problem
+// dR_ij = dR_j - dR_i that is solved by the L1 and IRLS rotation estimators.
+//
+// The view graph is stored in compressed sparse row (CSR) form: the row of each
+// rotation lists its incident edges in increasing order. This is the
+// compressed column storage of the matrix A of the linear system, so A and the
+// sparsity pattern of the normal equations A^T * W * A are built directly
+// without triplets or sparse matrix products. The values of the normal
+// equations are computed column by column for each new set of weights, and the
+// sparse matrix-vector products with A and A^T are computed edge by edge and
+// rotation by rotation respectively. All of these are independent of each
+// other and run on num_threads threads.
+class RotationAveragingLinearSystem {
+ public:
+  // The edges are given as the indices of the two rotations of each edge in the
+  // linear system, i.e., the 3-vector of rotation i is the segment starting at
+  // 3 * i of the solution. A negative index marks a rotation that is held
+  // constant. Each edge contributes the three rows starting at 3 * edge_index.
+  RotationAveragingLinearSystem(
+      const int num_rotations,
+      const std::vector<std::pair<int, int> >& edges,
+      const int num_threads);
+  ~RotationAveragingLinearSystem();
+
+  int NumRotations() const { return num_rotations_; }
+  int NumEdges() const { return edges_.size(); }
+
+  // The matrix A of the linear system with 3 * NumEdges() rows and
+  // 3 * NumRotations() columns.
+  const Eigen::SparseMatrix<double>& Matrix() const { return matrix_; }
+
+  // Computes y = A * x.
+  void Multiply(const Eigen::VectorXd& x, Eigen::VectorXd* y) const;
+
+  // Computes y = A^T * x.
+  void TransposeMultiply(const Eigen::VectorXd& x, Eigen::VectorXd* y) const;
+
+  // Computes the normal equations A^T * W * A and A^T * W * b of the weighted
+  // least squares problem, where W holds the weight of each edge for its three
+  // rows. The normal matrix has the same sparsity pattern for all weights.
+  void ComputeNormalEquations(const Eigen::VectorXd& edge_weights,
+                              const Eigen::VectorXd& residuals,
+                              Eigen::SparseMatrix<double>* normal_matrix,
+                              Eigen::VectorXd* normal_rhs) const;
+
+  // Solves the weighted least squares problem min || W^(1/2) (A * x - b) ||^2.
+  // The symbolic factorization of the normal equations is computed on the first
+  // call and reused by all subsequent calls, e.g., for each IRLS iteration.
+  // Returns false if the normal equations could not be factorized or solved.
+  bool SolveWeightedLeastSquares(const Eigen::VectorXd& edge_weights,
+                                 const Eigen::VectorXd& residuals,
+                                 Eigen::VectorXd* solution);
+
+  // Calls function(start, end) for blocks of the range [0, num_items) on the
+  // threads of the linear system, e.g., to compute the residuals and weights of
+  // the edges in parallel.
+  template <class F>
+  void RunInParallel(const int num_items, const F& function) const {
+    ParallelFor(thread_pool_.get(), num_items, num_threads_, function);
+  }
+
+ private:
+  // Builds A and the sparsity pattern of the normal equations from the CSR view
+  // graph.
+  void BuildMatrices();
+
+  // Sets the values of the normal equations, which must have the sparsity
+  // pattern of normal_matrix_.
+  void SetNormalEquationValues(const Eigen::VectorXd& edge_weights,
+                               const Eigen::VectorXd& residuals,
+                               Eigen::SparseMatrix<double>* normal_matrix,
+                               Eigen::VectorXd* normal_rhs) const;
+
+  const int num_rotations_;
+  const int num_threads_;
+  const std::vector<std::pair<int, int> > edges_;
+  std::unique_ptr<ThreadPool> thread_pool_;
+
+  // The CSR view graph. The incident edges of rotation i are
+  // incident_edges_[rotation_offsets_[i]] to
+  // incident_edges_[rotation_offsets_[i + 1] - 1], with the sign of the
+  // rotation in the edge's constraint in incident_edge_signs_.
+  std::vector<int> rotation_offsets_;
+  std::vector<int> incident_edges_;
+  std::vector<double> incident_edge_signs_;
+
+  // The position of the diagonal entry within the three columns of the normal
+  // matrix of each rotation, and for each incident edge the position of the
+  // entry of the other rotation of the edge, or -1 if it is constant.
+  std::vector<int> diagonal_entry_positions_;
+  std::vector<int> off_diagonal_entry_positions_;
+
+  Eigen::SparseMatrix<double> matrix_;
+  Eigen::SparseMatrix<double> normal_matrix_;
+  Eigen::VectorXd normal_rhs_;
+
+  SparseCholeskyLLt linear_solver_;
+  bool is_pattern_analyzed_;
+};
+
+}  // namespace theia
+
+#endif  // THEIA_SFM_GLOBAL_POSE_ESTIMATION_ROTATION_AVERAGING_LINEAR_SYSTEM_H_
@@ -0,0 +1,181 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#include "theia/sfm/global_pose_estimation/rotation_averaging_linear_system.h"
+
+#include <Eigen/Cholesky>
+#include <Eigen/Core>
+#include <Eigen/SparseCore>
+
+#include <utility>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "theia/util/random.h"
+
+namespace theia {
+
+namespace {
+
+RandomNumberGenerator rng(59);
+
+// Creates a random connected view graph in which rotation -1 is constant.
+std::vector<std::pair<int, int> > CreateRandomEdges(const int num_rotations,
+                                                    const int num_edges) {
+  std::vector<std::pair<int, int> > edges;
+  for (int i = 0; i < num_rotations; i++) {
+    edges.emplace_back(i - 1, i);
+  }
+  while (edges.size() < num_edges) {
+    const int i = rng.RandInt(-1, num_rotations - 1);
+    const int j = rng.RandInt(-1, num_rotations - 1);
+    if (i != j) {
+      edges.emplace_back(i, j);
+    }
+  }
+  return edges;
+}
+
+// Builds A from triplets as in SetupLinearSystem.
+Eigen::SparseMatrix<double> ReferenceMatrix(
+    const int num_rotations, const std::vector<std::pair<int, int> >& edges) {
+  std::vector<Eigen::Triplet<double> > triplets;
+  for (int e = 0; e < edges.size(); e++) {
+    for (int d = 0; d < 3; d++) {
+      if (edges[e].first >= 0) {
+        triplets.emplace_back(3 * e + d, 3 * edges[e].first + d, -1.0);
+      }
+      if (edges[e].second >= 0) {
+        triplets.emplace_back(3 * e + d, 3 * edges[e].second + d, 1.0);
+      }
+    }
+  }
+  Eigen::SparseMatrix<double> matrix(3 * edges.size(), 3 * num_rotations);
+  matrix.setFromTriplets(triplets.begin(), triplets.end());
+  return matrix;
+}
+
+void TestLinearSystem(const int num_rotations,
+                      const int num_edges,
+                      const int num_threads) {
+  static const double kTolerance = 1e-8;
+  const std::vector<std::pair<int, int> > edges =
+      CreateRandomEdges(num_rotations, num_edges);
+  RotationAveragingLinearSystem system(num_rotations, edges, num_threads);
+  EXPECT_EQ(system.NumRotations(), num_rotations);
+  EXPECT_EQ(system.NumEdges(), edges.size());
+
+  const Eigen::MatrixXd reference_matrix =
+      Eigen::MatrixXd(ReferenceMatrix(num_rotations, edges));
+  const Eigen::MatrixXd matrix = Eigen::MatrixXd(system.Matrix());
+  EXPECT_EQ((matrix - reference_matrix).norm(), 0.0);
+
+  // Sparse matrix-vector products.
+  const Eigen::VectorXd x = Eigen::VectorXd::Random(3 * num_rotations);
+  Eigen::VectorXd y;
+  system.Multiply(x, &y);
+  EXPECT_LT((y - reference_matrix * x).norm(), kTolerance);
+
+  const Eigen::VectorXd residuals = Eigen::VectorXd::Random(3 * edges.size());
+  system.TransposeMultiply(residuals, &y);
+  EXPECT_LT((y - reference_matrix.transpose() * residuals).norm(), kTolerance);
+
+  // Normal equations.
+  const Eigen::VectorXd edge_weights =
+      Eigen::VectorXd::Random(edges.size()).cwiseAbs().array() + 0.1;
+  Eigen::VectorXd row_weights(3 * edges.size());
+  for (int e = 0; e < edges.size(); e++) {
+    row_weights.segment<3>(3 * e).setConstant(edge_weights[e]);
+  }
+  const Eigen::MatrixXd reference_normal_matrix =
+      reference_matrix.transpose() * row_weights.asDiagonal() *
+      reference_matrix;
+  const Eigen::VectorXd reference_normal_rhs =
+      reference_matrix.transpose() * row_weights.asDiagonal() * residuals;
+
+  Eigen::SparseMatrix<double> normal_matrix;
+  Eigen::VectorXd normal_rhs;
+  system.ComputeNormalEquations(
+      edge_weights, residuals, &normal_matrix, &normal_rhs);
+  EXPECT_LT((Eigen::MatrixXd(normal_matrix) - reference_normal_matrix).norm(),
+            kTolerance);
+  EXPECT_LT((normal_rhs - reference_normal_rhs).norm(), kTolerance);
+
+  // Weighted least squares, solved twice to reuse the symbolic factorization.
+  Eigen::VectorXd solution;
+  for (int i = 0; i < 2; i++) {
+    EXPECT_TRUE(
+        system.SolveWeightedLeastSquares(edge_weights, residuals, &solution));
+    const Eigen::VectorXd reference_solution =
+        reference_normal_matrix.ldlt().solve(reference_normal_rhs);
+    EXPECT_LT((solution - reference_solution).norm(), kTolerance);
+  }
+}
+
+}  // namespace
+
+TEST(RotationAveragingLinearSystem, SmallGraph) {
+  TestLinearSystem(5, 12, 1);
+}
+
+TEST(RotationAveragingLinearSystem, DuplicateEdges) {
+  const int kNumRotations = 3;
+  const std::vector<std::pair<int, int> > edges = {
+      {-1, 0}, {0, 1}, {1, 0}, {0, 1}, {1, 2}, {2, -1}};
+  RotationAveragingLinearSystem system(kNumRotations, edges, 1);
+
+  const Eigen::VectorXd edge_weights = Eigen::VectorXd::Ones(edges.size());
+  Eigen::SparseMatrix<double> normal_matrix;
+  Eigen::VectorXd normal_rhs;
+  system.ComputeNormalEquations(edge_weights,
+                                Eigen::VectorXd::Zero(3 * edges.size()),
+                                &normal_matrix,
+                                &normal_rhs);
+  const Eigen::MatrixXd reference_matrix =
+      Eigen::MatrixXd(ReferenceMatrix(kNumRotations, edges));
+  EXPECT_LT((Eigen::MatrixXd(normal_matrix) -
+             reference_matrix.transpose() * reference_matrix)
+                .norm(),
+            1e-12);
+}
+
+TEST(RotationAveragingLinearSystem, LargeGraph) {
+  TestLinearSystem(100, 1000, 1);
+}
+
+TEST(RotationAveragingLinearSystem, LargeGraphMultiThreaded) {
+  TestLinearSystem(100, 1000, 4);
+}
+
+}  // namespace theia
@@ -35,8 +35,17 @@
 #include "theia/sfm/global_reconstruction_estimator.h"
 
 #include <Eigen/Core>
+#include <ceres/rotation.h>
+#include <algorithm>
 #include <memory>
+#include <set>
 #include <sstream>  // NOLINT
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "theia/math/rotation.h"
 
 #include "theia/sfm/bundle_adjustment/bundle_adjustment.h"
 #include "theia/sfm/estimate_track.h"
@@ -63,14 +72,19 @@
 #include "theia/sfm/twoview_info.h"
 #include "theia/sfm/view_graph/orientations_from_maximum_spanning_tree.h"
 #include "theia/sfm/view_graph/remove_disconnected_view_pairs.h"
+#include "theia/sfm/view_graph/sparsify_view_graph.h"
 #include "theia/sfm/view_graph/view_graph.h"
 #include "theia/solvers/sample_consensus_estimator.h"
+#include "theia/util/executor.h"
+#include "theia/util/map_util.h"
 #include "theia/util/random.h"
 #include "theia/util/timer.h"
 #include "theia/io/write_ply_file.h"
+#include "theia/util/trace.h"
 
 namespace theia {
 
+using Eigen::Matrix3d;
 using Eigen::Vector3d;
 
 namespace {
@@ -84,6 +98,8 @@ struct GlobalReconstructionEstimatorTimings {
   double relative_translation_optimization_time = 0.0;
   double relative_translation_filtering_time = 0.0;
   double position_estimation_time = 0.0;
+  double triangulation_time = 0.0;
+  double bundle_adjustment_time = 0.0;
 };
 
 FilterViewPairsFromRelativeTranslationOptions
@@ -108,6 +124,157 @@ void SetUnderconstrainedAsUnestimated(Reconstruction* reconstruction) {
   }
 }
 
+TrackEstimator::Options SetTriangulationOptions(
+    const ReconstructionEstimatorOptions& options) {
+  TrackEstimator::Options triangulation_options;
+  triangulation_options.max_acceptable_reprojection_error_pixels =
+      options.triangulation_max_reprojection_error_in_pixels;
+  triangulation_options.min_triangulation_angle_degrees =
+      options.min_triangulation_angle_degrees;
+  triangulation_options.bundle_adjustment = options.bundle_adjust_tracks;
+  triangulation_options.ba_options = SetBundleAdjustmentOptions(options, 0);
+  triangulation_options.ba_options.num_threads = 1;
+  triangulation_options.ba_options.verbose = false;
+  triangulation_options.num_threads = options.num_threads;
+  triangulation_options.triangulation_method = options.triangulation_method;
+  return triangulation_options;
+}
+
+Vector3d GetRotatedTranslation(const Vector3d& rotation_angle_axis,
+                               const Vector3d& translation) {
+  Matrix3d rotation;
+  ceres::AngleAxisToRotationMatrix(
+      rotation_angle_axis.data(),
+      ceres::ColumnMajorAdapter3x3(rotation.data()));
+  return rotation.transpose() * translation;
+}
+
+// Returns the new views that are connected to the views of known_poses in
+// breadth first order. Each new view is paired with the neighbor that its pose
+// is initialized from, which is the known or earlier view with the most
+// verified matches.
+std::vector<std::pair<ViewId, ViewId> > OrderNewViewsFromKnownViews(
+    const ViewGraph& view_graph,
+    const std::unordered_set<ViewId>& new_views,
+    const std::unordered_map<ViewId, Vector3d>& known_poses) {
+  std::vector<ViewId> remaining_views;
+  for (const ViewId view_id : new_views) {
+    if (view_graph.HasView(view_id)) {
+      remaining_views.emplace_back(view_id);
+    }
+  }
+  std::sort(remaining_views.begin(), remaining_views.end());
+
+  std::unordered_set<ViewId> ordered_view_ids;
+  std::vector<std::pair<ViewId, ViewId> > ordered_views;
+  while (!remaining_views.empty()) {
+    std::vector<std::pair<ViewId, ViewId> > next_views;
+    std::vector<ViewId> unreached_views;
+    for (const ViewId view_id : remaining_views) {
+      ViewId best_neighbor_id = kInvalidViewId;
+      int best_num_verified_matches = -1;
+      for (const ViewId neighbor_id :
+           *view_graph.GetNeighborIdsForView(view_id)) {
+        if (!ContainsKey(known_poses, neighbor_id) &&
+            !ContainsKey(ordered_view_ids, neighbor_id)) {
+          continue;
+        }
+        const int num_verified_matches =
+            view_graph.GetEdge(view_id, neighbor_id)->num_verified_matches;
+        if (num_verified_matches > best_num_verified_matches ||
+            (num_verified_matches == best_num_verified_matches &&
+             neighbor_id < best_neighbor_id)) {
+          best_neighbor_id = neighbor_id;
+          best_num_verified_matches = num_verified_matches;
+        }
+      }
+
+      if (best_neighbor_id == kInvalidViewId) {
+        unreached_views.emplace_back(view_id);
+      } else {
+        next_views.emplace_back(view_id, best_neighbor_id);
+      }
+    }
+    if (next_views.empty()) {
+      break;
+    }
+
+    for (const auto& next_view : next_views) {
+      ordered_view_ids.insert(next_view.first);
+      ordered_views.emplace_back(next_view);
+    }
+    remaining_views.swap(unreached_views);
+  }
+  return ordered_views;
+}
+
+// Removes all views from the view graph and the poses that are not connected
+// to a fixed view through the view pairs. Fixed views without view pairs are
+// removed as well.
+void RemoveViewsNotConnectedToFixedViews(
+    const std::set<ViewId>& fixed_views,
+    ViewGraph* view_graph,
+    std::unordered_map<ViewId, Vector3d>* poses) {
+  std::unordered_set<ViewId> connected_views;
+  std::vector<ViewId> views_to_visit;
+  for (const ViewId view_id : fixed_views) {
+    const auto* neighbor_ids = view_graph->GetNeighborIdsForView(view_id);
+    if (neighbor_ids != nullptr && !neighbor_ids->empty()) {
+      connected_views.insert(view_id);
+      views_to_visit.emplace_back(view_id);
+    }
+  }
+  while (!views_to_visit.empty()) {
+    const ViewId view_id = views_to_visit.back();
+    views_to_visit.pop_back();
+    for (const ViewId neighbor_id :
+         *view_graph->GetNeighborIdsForView(view_id)) {
+      if (connected_views.insert(neighbor_id).second) {
+        views_to_visit.emplace_back(neighbor_id);
+      }
+    }
+  }
+
+  for (const ViewId view_id : view_graph->ViewIds()) {
+    if (!ContainsKey(connected_views, view_id)) {
+      view_graph->RemoveView(view_id);
+    }
+  }
+  for (auto it = poses->begin(); it != poses->end();) {
+    if (ContainsKey(connected_views, it->first)) {
+      ++it;
+    } else {
+      it = poses->erase(it);
+    }
+  }
+}
+
+// Returns the median distance between the fixed views and their estimated
+// neighbors in the view graph, which is the baseline used to initialize the
+// positions of the new views. Returns 1 if there is no such view pair.
+double MedianBaselineOfFixedViews(const ViewGraph& view_graph,
+                                  const Reconstruction& reconstruction,
+                                  const std::set<ViewId>& fixed_views) {
+  std::vector<double> baselines;
+  for (const ViewId view_id : fixed_views) {
+    const Vector3d position =
+        reconstruction.View(view_id)->Camera().GetPosition();
+    for (const ViewId neighbor_id : *view_graph.GetNeighborIdsForView(view_id)) {
+      const View* neighbor = reconstruction.View(neighbor_id);
+      if (neighbor != nullptr && neighbor->IsEstimated()) {
+        baselines.emplace_back(
+            (neighbor->Camera().GetPosition() - position).norm());
+      }
+    }
+  }
+  if (baselines.empty()) {
+    return 1.0;
+  }
+  auto median = baselines.begin() + baselines.size() / 2;
+  std::nth_element(baselines.begin(), median, baselines.end());
+  return *median;
+}
+
 }  // namespace
 
 GlobalReconstructionEstimator::GlobalReconstructionEstimator(
@@ -120,6 +287,9 @@ GlobalReconstructionEstimator::GlobalReconstructionEstimator(
       options_.num_threads;
   options_.linear_triplet_position_estimator_options.num_threads =
       options_.num_threads;
+  options_.least_unsquared_deviation_position_estimator_options.num_threads =
+      options_.num_threads;
+  options_.ligt_position_estimator_options.num_threads = options_.num_threads;
   ransac_params_ = SetRansacParameters(options);
 }
 
@@ -139,8 +309,13 @@ GlobalReconstructionEstimator::GlobalReconstructionEstimator(
 //
 // After each filtering step we remove any views which are no longer connected
 // to the largest connected component in the view graph.
+//
+// Steps 1, 3 and 4 only use the view graph and step 2 only the camera
+// intrinsics, so with multiple threads the calibration runs on the executor
+// while the rotations are estimated and is waited for before step 5.
 ReconstructionEstimatorSummary GlobalReconstructionEstimator::Estimate(
     ViewGraph* view_graph, Reconstruction* reconstruction) {
+  THEIA_TRACE_SCOPE("GlobalReconstructionEstimator::Estimate");
   CHECK_NOTNULL(reconstruction);
   reconstruction_ = reconstruction;
   view_graph_ = view_graph;
@@ -152,67 +327,115 @@ ReconstructionEstimatorSummary GlobalReconstructionEstimator::Estimate(
   Timer total_timer;
   Timer timer;
 
-  // Step 1. Filter the initial view graph and remove any bad two view
-  // geometries.
-  LOG(INFO) << "Filtering the intial view graph.";
-  timer.Reset();
-  if (!FilterInitialViewGraph()) {
-    LOG(INFO) << "Insufficient view pairs to perform estimation.";
-    return summary;
+  // Resume after the last stage that a checkpoint was written for.
+  const ReconstructionCheckpointStage checkpoint_stage =
+      options_.checkpoint != nullptr ? options_.checkpoint->Stage()
+                                     : ReconstructionCheckpointStage::NONE;
+  if (checkpoint_stage >= ReconstructionCheckpointStage::ROTATIONS_ESTIMATED) {
+    LOG(INFO) << "Resuming from the global rotations of the checkpoint.";
+    orientations_ = options_.checkpoint->Orientations();
+  }
+  if (checkpoint_stage >= ReconstructionCheckpointStage::POSITIONS_ESTIMATED) {
+    LOG(INFO) << "Resuming from the global positions of the checkpoint.";
+    positions_ = options_.checkpoint->Positions();
   }
-  global_estimator_timings.initial_view_graph_filtering_time =
-      timer.ElapsedTimeInSeconds();
 
-  // Step 2. Calibrate any uncalibrated cameras.
-  LOG(INFO) << "Calibrating any uncalibrated cameras.";
-  timer.Reset();
-  CalibrateCameras();
-  summary.camera_intrinsics_calibration_time = timer.ElapsedTimeInSeconds();
+  // Waits for the calibration of the cameras if it runs concurrently. Declared
+  // before the early returns so that the calibration finishes before them.
+  TaskGroup calibration_task;
 
-  // Step 3. Estimate global rotations.
-  LOG(INFO) << "Estimating the global rotations of all cameras.";
-  timer.Reset();
-  if (!EstimateGlobalRotations()) {
-    LOG(WARNING) << "Rotation estimation failed!";
-    summary.success = false;
+  if (checkpoint_stage < ReconstructionCheckpointStage::ROTATIONS_ESTIMATED) {
+    // Step 2. Calibrate any uncalibrated cameras. This is independent of the
+    // view graph filtering and the rotation estimation.
+    LOG(INFO) << "Calibrating any uncalibrated cameras.";
+    const auto calibrate_cameras = [this, &global_estimator_timings]() {
+      Timer calibration_timer;
+      CalibrateCameras();
+      global_estimator_timings.camera_intrinsics_calibration_time =
+          calibration_timer.ElapsedTimeInSeconds();
+    };
+    if (options_.num_threads > 1) {
+      calibration_task.Run(calibrate_cameras);
+    } else {
+      calibrate_cameras();
+    }
+
+    // Step 1. Filter the initial view graph and remove any bad two view
+    // geometries.
+    LOG(INFO) << "Filtering the intial view graph.";
+    timer.Reset();
+    if (!FilterInitialViewGraph()) {
+      LOG(INFO) << "Insufficient view pairs to perform estimation.";
+      return summary;
+    }
+    global_estimator_timings.initial_view_graph_filtering_time =
+        timer.ElapsedTimeInSeconds();
+
+    // Step 3. Estimate global rotations.
+    LOG(INFO) << "Estimating the global rotations of all cameras.";
+    timer.Reset();
+    if (!EstimateGlobalRotations()) {
+      LOG(WARNING) << "Rotation estimation failed!";
+      summary.success = false;
+      return summary;
+    }
+    global_estimator_timings.rotation_estimation_time =
+        timer.ElapsedTimeInSeconds();
+
+    // Step 4. Filter bad rotations.
+    LOG(INFO) << "Filtering any bad rotation estimations.";
+    timer.Reset();
+    FilterRotations();
+    global_estimator_timings.rotation_filtering_time =
+        timer.ElapsedTimeInSeconds();
+
+    // The checkpoint stores the calibrated cameras of the reconstruction.
+    calibration_task.Wait();
+    summary.camera_intrinsics_calibration_time =
+        global_estimator_timings.camera_intrinsics_calibration_time;
+    WriteCheckpoint(ReconstructionCheckpointStage::ROTATIONS_ESTIMATED);
+  }
+  if (options_.stop_stage ==
+      ReconstructionCheckpointStage::ROTATIONS_ESTIMATED) {
+    summary.message = "Stopped after the rotation estimation.";
     return summary;
   }
-  global_estimator_timings.rotation_estimation_time =
-      timer.ElapsedTimeInSeconds();
 
-  // Step 4. Filter bad rotations.
-  LOG(INFO) << "Filtering any bad rotation estimations.";
-  timer.Reset();
-  FilterRotations();
-  global_estimator_timings.rotation_filtering_time =
-      timer.ElapsedTimeInSeconds();
+  if (checkpoint_stage < ReconstructionCheckpointStage::POSITIONS_ESTIMATED) {
+    // Step 5. Optimize relative translations.
+    LOG(INFO) << "Optimizing the pairwise translation estimations.";
+    timer.Reset();
+    OptimizePairwiseTranslations();
+    global_estimator_timings.relative_translation_optimization_time =
+        timer.ElapsedTimeInSeconds();
 
-  // Step 5. Optimize relative translations.
-  LOG(INFO) << "Optimizing the pairwise translation estimations.";
-  timer.Reset();
-  OptimizePairwiseTranslations();
-  global_estimator_timings.relative_translation_optimization_time =
-      timer.ElapsedTimeInSeconds();
+    // Step 6. Filter bad relative translations.
+    LOG(INFO) << "Filtering any bad relative translations.";
+    timer.Reset();
+    FilterRelativeTranslation();
+    global_estimator_timings.relative_translation_filtering_time =
+        timer.ElapsedTimeInSeconds();
 
-  // Step 6. Filter bad relative translations.
-  LOG(INFO) << "Filtering any bad relative translations.";
-  timer.Reset();
-  FilterRelativeTranslation();
-  global_estimator_timings.relative_translation_filtering_time =
-      timer.ElapsedTimeInSeconds();
+    // Step 7. Estimate global positions.
+    LOG(INFO) << "Estimating the positions of all cameras.";
+    timer.Reset();
+    if (!EstimatePosition()) {
+      LOG(WARNING) << "Position estimation failed!";
+      summary.success = false;
+      return summary;
+    }
+    LOG(INFO) << positions_.size()
+              << " camera positions were estimated successfully.";
+    global_estimator_timings.position_estimation_time =
+        timer.ElapsedTimeInSeconds();
 
-  // Step 7. Estimate global positions.
-  LOG(INFO) << "Estimating the positions of all cameras.";
-  timer.Reset();
-  if (!EstimatePosition()) {
-    LOG(WARNING) << "Position estimation failed!";
-    summary.success = false;
+    WriteCheckpoint(ReconstructionCheckpointStage::POSITIONS_ESTIMATED);
+  }
+  if (options_.stop_stage ==
+      ReconstructionCheckpointStage::POSITIONS_ESTIMATED) {
+    summary.message = "Stopped after the position estimation.";
     return summary;
   }
-  LOG(INFO) << positions_.size()
-            << " camera positions were estimated successfully.";
-  global_estimator_timings.position_estimation_time =
-      timer.ElapsedTimeInSeconds();
 
   summary.pose_estimation_time =
       global_estimator_timings.rotation_estimation_time +
@@ -232,7 +455,7 @@ ReconstructionEstimatorSummary GlobalReconstructionEstimator::Estimate(
     LOG(INFO) << "Triangulating all features.";
     timer.Reset();
     EstimateStructure();
-    summary.triangulation_time += timer.ElapsedTimeInSeconds();
+    global_estimator_timings.triangulation_time += timer.ElapsedTimeInSeconds();
 
     SetUnderconstrainedAsUnestimated(reconstruction_);
 
@@ -245,7 +468,8 @@ ReconstructionEstimatorSummary GlobalReconstructionEstimator::Estimate(
                    "camera positions and 3d points.";
       timer.Reset();
       BundleAdjustCameraPositionsAndPoints();
-      summary.bundle_adjustment_time += timer.ElapsedTimeInSeconds();
+      global_estimator_timings.bundle_adjustment_time +=
+          timer.ElapsedTimeInSeconds();
     }
 
     // Step 9. Bundle Adjustment.
@@ -256,11 +480,13 @@ ReconstructionEstimatorSummary GlobalReconstructionEstimator::Estimate(
       LOG(WARNING) << "Bundle adjustment failed!";
       return summary;
     }
-    summary.bundle_adjustment_time += timer.ElapsedTimeInSeconds();
+    global_estimator_timings.bundle_adjustment_time +=
+        timer.ElapsedTimeInSeconds();
 
     int num_points_removed =
         SetOutlierTracksToUnestimated(options_.max_reprojection_error_in_pixels,
                                       options_.min_triangulation_angle_degrees,
+                                      options_.num_threads,
                                       reconstruction_);
     LOG(INFO) << num_points_removed << " outlier points were removed.";
   }
@@ -270,6 +496,9 @@ ReconstructionEstimatorSummary GlobalReconstructionEstimator::Estimate(
                                       &summary.estimated_views);
   GetEstimatedTracksFromReconstruction(*reconstruction_,
                                        &summary.estimated_tracks);
+  summary.triangulation_time = global_estimator_timings.triangulation_time;
+  summary.bundle_adjustment_time =
+      global_estimator_timings.bundle_adjustment_time;
   summary.success = true;
   summary.total_time = total_timer.ElapsedTimeInSeconds();
 
@@ -280,7 +509,7 @@ ReconstructionEstimatorSummary GlobalReconstructionEstimator::Estimate(
       << "\n\tInitial view graph filtering time = "
       << global_estimator_timings.initial_view_graph_filtering_time
       << "\n\tCamera intrinsic calibration time = "
-      << summary.camera_intrinsics_calibration_time
+      << global_estimator_timings.camera_intrinsics_calibration_time
       << "\n\tRotation estimation time = "
       << global_estimator_timings.rotation_estimation_time
       << "\n\tRotation filtering time = "
@@ -290,13 +519,367 @@ ReconstructionEstimatorSummary GlobalReconstructionEstimator::Estimate(
       << "\n\tRelative translation filtering time = "
       << global_estimator_timings.relative_translation_filtering_time
       << "\n\tPosition estimation time = "
-      << global_estimator_timings.position_estimation_time;
+      << global_estimator_timings.position_estimation_time
+      << "\n\tTriangulation time = "
+      << global_estimator_timings.triangulation_time
+      << "\n\tBundle adjustment time = "
+      << global_estimator_timings.bundle_adjustment_time;
   summary.message = string_stream.str();
 
   return summary;
 }
 
+ReconstructionEstimatorSummary GlobalReconstructionEstimator::EstimateNewViews(
+    ViewGraph* view_graph, Reconstruction* reconstruction) {
+  THEIA_TRACE_SCOPE("GlobalReconstructionEstimator::EstimateNewViews");
+  CHECK_NOTNULL(view_graph);
+  CHECK_NOTNULL(reconstruction);
+  CHECK_GE(options_.incremental_global_update_neighborhood_size, 0);
+  reconstruction_ = reconstruction;
+  view_graph_ = view_graph;
+  orientations_.clear();
+  positions_.clear();
+
+  ReconstructionEstimatorSummary summary;
+  Timer total_timer;
+  Timer timer;
+
+  // The new views are the views of the view graph that are not estimated yet.
+  // Their view pairs with too few inliers are removed as in the initial view
+  // graph filtering.
+  std::unordered_set<ViewId> new_views;
+  for (const ViewId view_id : view_graph_->ViewIds()) {
+    const View* view = reconstruction_->View(view_id);
+    if (view != nullptr && !view->IsEstimated()) {
+      new_views.insert(view_id);
+    }
+  }
+  for (const ViewId view_id : new_views) {
+    const std::unordered_set<ViewId> neighbor_ids =
+        *view_graph_->GetNeighborIdsForView(view_id);
+    for (const ViewId neighbor_id : neighbor_ids) {
+      if (view_graph_->GetEdge(view_id, neighbor_id)->num_verified_matches <
+          options_.min_num_two_view_inliers) {
+        view_graph_->RemoveEdge(view_id, neighbor_id);
+      }
+    }
+  }
+  if (new_views.empty()) {
+    summary.success = true;
+    summary.message = "There are no new views to estimate.";
+    return summary;
+  }
+
+  // Select the estimated views within the neighborhood of the new views, which
+  // are updated along with them, and the estimated views adjacent to the
+  // neighborhood, which are held fixed.
+  std::unordered_set<ViewId> updated_views = new_views;
+  std::set<ViewId> fixed_views;
+  std::vector<ViewId> views_to_visit(new_views.begin(), new_views.end());
+  for (int distance = 0; !views_to_visit.empty(); ++distance) {
+    std::vector<ViewId> next_views_to_visit;
+    for (const ViewId view_id : views_to_visit) {
+      for (const ViewId neighbor_id :
+           *view_graph_->GetNeighborIdsForView(view_id)) {
+        if (ContainsKey(updated_views, neighbor_id) ||
+            ContainsKey(fixed_views, neighbor_id)) {
+          continue;
+        }
+        if (distance < options_.incremental_global_update_neighborhood_size) {
+          updated_views.insert(neighbor_id);
+          next_views_to_visit.emplace_back(neighbor_id);
+        } else {
+          fixed_views.insert(neighbor_id);
+        }
+      }
+    }
+    views_to_visit.swap(next_views_to_visit);
+  }
+  // If the neighborhood covers all views connected to the new views, only the
+  // new views are updated.
+  if (fixed_views.empty()) {
+    for (const ViewId view_id : updated_views) {
+      if (!ContainsKey(new_views, view_id)) {
+        fixed_views.insert(view_id);
+      }
+    }
+    for (const ViewId view_id : fixed_views) {
+      updated_views.erase(view_id);
+    }
+  }
+  if (fixed_views.empty()) {
+    LOG(WARNING) << "The new views are not connected to any estimated view.";
+    summary.message = "The new views are not connected to any estimated view.";
+    return summary;
+  }
+  LOG(INFO) << "Updating " << updated_views.size() << " views of which "
+            << new_views.size() << " are new, holding " << fixed_views.size()
+            << " views fixed.";
+
+  // The view pairs of the updated views. View pairs between two fixed views do
+  // not constrain the update.
+  ViewGraph subgraph;
+  for (const ViewId view_id : updated_views) {
+    for (const ViewId neighbor_id :
+         *view_graph_->GetNeighborIdsForView(view_id)) {
+      if (ContainsKey(fixed_views, neighbor_id) ||
+          (ContainsKey(updated_views, neighbor_id) && view_id < neighbor_id)) {
+        subgraph.AddEdge(view_id,
+                         neighbor_id,
+                         *view_graph_->GetEdge(view_id, neighbor_id));
+      }
+    }
+  }
+  std::vector<ViewIdPair> subgraph_view_pairs;
+  subgraph_view_pairs.reserve(subgraph.NumEdges());
+  for (const auto& view_pair : subgraph.GetAllEdges()) {
+    subgraph_view_pairs.emplace_back(view_pair.first);
+  }
+
+  // Steps 1 - 5. Estimate the poses.
+  timer.Reset();
+  if (!EstimateNewViewRotations(new_views, fixed_views, &subgraph)) {
+    LOG(WARNING) << "Rotation estimation failed!";
+    return summary;
+  }
+  if (!EstimateNewViewPositions(new_views, fixed_views, &subgraph)) {
+    LOG(WARNING) << "Position estimation failed!";
+    return summary;
+  }
+  summary.pose_estimation_time = timer.ElapsedTimeInSeconds();
+
+  // Keep the refined view pairs and remove the filtered ones from the view
+  // graph.
+  for (const ViewIdPair& view_pair : subgraph_view_pairs) {
+    const TwoViewInfo* info =
+        subgraph.GetEdge(view_pair.first, view_pair.second);
+    if (info == nullptr) {
+      view_graph_->RemoveEdge(view_pair.first, view_pair.second);
+    } else {
+      *view_graph_->GetMutableEdge(view_pair.first, view_pair.second) = *info;
+    }
+  }
+
+  std::unordered_set<ViewId> views_to_optimize;
+  for (const auto& position : positions_) {
+    if (ContainsKey(fixed_views, position.first)) {
+      continue;
+    }
+    View* view = reconstruction_->MutableView(position.first);
+    view->MutableCamera()->SetPosition(position.second);
+    view->MutableCamera()->SetOrientationFromAngleAxis(
+        FindOrDie(orientations_, position.first));
+    view->SetEstimated(true);
+    views_to_optimize.insert(position.first);
+  }
+  LOG(INFO) << views_to_optimize.size()
+            << " camera poses were estimated successfully.";
+
+  // Step 6. Triangulate the tracks of the new views. New views that observe
+  // too few estimated tracks are set to unestimated.
+  timer.Reset();
+  std::unordered_set<TrackId> tracks_to_estimate;
+  for (const ViewId view_id : views_to_optimize) {
+    if (!ContainsKey(new_views, view_id)) {
+      continue;
+    }
+    for (const TrackId track_id : reconstruction_->View(view_id)->TrackIds()) {
+      if (!reconstruction_->Track(track_id)->IsEstimated()) {
+        tracks_to_estimate.insert(track_id);
+      }
+    }
+  }
+  TrackEstimator track_estimator(SetTriangulationOptions(options_),
+                                 reconstruction_);
+  track_estimator.EstimateTracks(tracks_to_estimate);
+  summary.triangulation_time = timer.ElapsedTimeInSeconds();
+
+  static const int kMinNumEstimatedTracks = 3;
+  for (const ViewId view_id : new_views) {
+    View* view = reconstruction_->MutableView(view_id);
+    if (!view->IsEstimated()) {
+      continue;
+    }
+    int num_estimated_tracks = 0;
+    for (const TrackId track_id : view->TrackIds()) {
+      if (reconstruction_->Track(track_id)->IsEstimated() &&
+          ++num_estimated_tracks >= kMinNumEstimatedTracks) {
+        break;
+      }
+    }
+    if (num_estimated_tracks < kMinNumEstimatedTracks) {
+      view->SetEstimated(false);
+      views_to_optimize.erase(view_id);
+    }
+  }
+
+  // Step 7. Bundle adjust the updated views and their tracks. The fixed views
+  // that observe these tracks are held constant.
+  timer.Reset();
+  std::unordered_set<TrackId> tracks_to_optimize;
+  for (const ViewId view_id : views_to_optimize) {
+    for (const TrackId track_id : reconstruction_->View(view_id)->TrackIds()) {
+      if (reconstruction_->Track(track_id)->IsEstimated()) {
+        tracks_to_optimize.insert(track_id);
+      }
+    }
+  }
+  bundle_adjustment_options_ =
+      SetBundleAdjustmentOptions(options_, views_to_optimize.size());
+  const BundleAdjustmentSummary bundle_adjustment_summary =
+      BundleAdjustPartialReconstruction(bundle_adjustment_options_,
+                                        views_to_optimize,
+                                        tracks_to_optimize,
+                                        reconstruction_);
+  summary.bundle_adjustment_time = timer.ElapsedTimeInSeconds();
+  if (!bundle_adjustment_summary.success) {
+    LOG(WARNING) << "Bundle adjustment failed!";
+    return summary;
+  }
+  const int num_points_removed =
+      SetOutlierTracksToUnestimated(tracks_to_optimize,
+                                    options_.max_reprojection_error_in_pixels,
+                                    options_.min_triangulation_angle_degrees,
+                                    options_.num_threads,
+                                    reconstruction_);
+  LOG(INFO) << num_points_removed << " outlier points were removed.";
+
+  summary.estimated_views = views_to_optimize;
+  for (const TrackId track_id : tracks_to_optimize) {
+    if (reconstruction_->Track(track_id)->IsEstimated()) {
+      summary.estimated_tracks.insert(track_id);
+    }
+  }
+  summary.success = true;
+  summary.total_time = total_timer.ElapsedTimeInSeconds();
+
+  std::ostringstream string_stream;
+  string_stream << "Global Reconstruction Estimator update timings:"
+                << "\n\tPose estimation time = " << summary.pose_estimation_time
+                << "\n\tTriangulation time = " << summary.triangulation_time
+                << "\n\tBundle adjustment time = "
+                << summary.bundle_adjustment_time;
+  summary.message = string_stream.str();
+  return summary;
+}
+
+bool GlobalReconstructionEstimator::EstimateNewViewRotations(
+    const std::unordered_set<ViewId>& new_views,
+    const std::set<ViewId>& fixed_views,
+    ViewGraph* subgraph) {
+  THEIA_TRACE_SCOPE("GlobalReconstructionEstimator::EstimateNewViewRotations");
+  // Step 1. The estimated views start from their current orientations and each
+  // new view from the orientation of a neighbor and their relative rotation.
+  for (const ViewId view_id : subgraph->ViewIds()) {
+    if (!ContainsKey(new_views, view_id)) {
+      orientations_[view_id] =
+          reconstruction_->View(view_id)->Camera().GetOrientationAsAngleAxis();
+    }
+  }
+  for (const auto& view_and_neighbor :
+       OrderNewViewsFromKnownViews(*subgraph, new_views, orientations_)) {
+    const ViewId view_id = view_and_neighbor.first;
+    const ViewId neighbor_id = view_and_neighbor.second;
+    const Vector3d& relative_rotation =
+        subgraph->GetEdge(view_id, neighbor_id)->rotation_2;
+    orientations_[view_id] = ApplyRelativeRotation(
+        FindOrDie(orientations_, neighbor_id),
+        neighbor_id < view_id ? relative_rotation
+                              : Vector3d(-relative_rotation));
+  }
+  RemoveViewsNotConnectedToFixedViews(fixed_views, subgraph, &orientations_);
+  if (subgraph->NumEdges() == 0) {
+    return false;
+  }
+
+  // Step 2. Estimate the rotations with the orientations of the fixed views
+  // held constant.
+  RobustRotationEstimator::Options robust_rotation_estimator_options;
+  robust_rotation_estimator_options.num_threads = options_.num_threads;
+  RobustRotationEstimator rotation_estimator(robust_rotation_estimator_options);
+  std::set<ViewId> fixed_rotations;
+  for (const ViewId view_id : fixed_views) {
+    if (ContainsKey(orientations_, view_id)) {
+      fixed_rotations.insert(view_id);
+    }
+  }
+  rotation_estimator.SetFixedGlobalRotations(fixed_rotations);
+  if (!rotation_estimator.EstimateRotations(subgraph->GetAllEdges(),
+                                            &orientations_)) {
+    return false;
+  }
+
+  // Step 3. Filter the view pairs that are inconsistent with the rotations.
+  FilterViewPairsFromOrientation(
+      orientations_,
+      options_.rotation_filtering_max_difference_degrees,
+      options_.num_threads,
+      subgraph);
+  RemoveViewsNotConnectedToFixedViews(fixed_views, subgraph, &orientations_);
+  return subgraph->NumEdges() > 0;
+}
+
+bool GlobalReconstructionEstimator::EstimateNewViewPositions(
+    const std::unordered_set<ViewId>& new_views,
+    const std::set<ViewId>& fixed_views,
+    ViewGraph* subgraph) {
+  THEIA_TRACE_SCOPE("GlobalReconstructionEstimator::EstimateNewViewPositions");
+  // Step 4. Optimize and filter the relative translations.
+  if (options_.refine_relative_translations_after_rotation_estimation) {
+    RefineRelativeTranslationsWithKnownRotations(
+        *reconstruction_, orientations_, options_.num_threads, subgraph);
+  }
+  if (options_.filter_relative_translations_with_1dsfm) {
+    FilterViewPairsFromRelativeTranslation(
+        translation_filter_options_, orientations_, subgraph);
+  }
+  RemoveViewsNotConnectedToFixedViews(fixed_views, subgraph, &orientations_);
+  if (subgraph->NumEdges() == 0) {
+    return false;
+  }
+
+  // Step 5. The estimated views start from their current positions and each
+  // new view at the median baseline of the fixed views from a neighbor in the
+  // direction of their relative translation. The positions are then estimated
+  // with the positions of the fixed views held constant, which also fixes the
+  // scale of the update.
+  for (const auto& orientation : orientations_) {
+    if (!ContainsKey(new_views, orientation.first)) {
+      positions_[orientation.first] =
+          reconstruction_->View(orientation.first)->Camera().GetPosition();
+    }
+  }
+  const double baseline =
+      MedianBaselineOfFixedViews(*view_graph_, *reconstruction_, fixed_views);
+  for (const auto& view_and_neighbor :
+       OrderNewViewsFromKnownViews(*subgraph, new_views, positions_)) {
+    const ViewId view_id = view_and_neighbor.first;
+    const ViewId neighbor_id = view_and_neighbor.second;
+    // The relative translation is the direction from the view with the lower
+    // id to the other view in the coordinate system of the former.
+    const Vector3d translation_direction = GetRotatedTranslation(
+        FindOrDie(orientations_, std::min(view_id, neighbor_id)),
+        subgraph->GetEdge(view_id, neighbor_id)->position_2);
+    positions_[view_id] =
+        FindOrDie(positions_, neighbor_id) +
+        (neighbor_id < view_id ? baseline : -baseline) * translation_direction;
+  }
+
+  std::vector<ViewId> fixed_positions;
+  for (const ViewId view_id : fixed_views) {
+    if (ContainsKey(positions_, view_id)) {
+      fixed_positions.emplace_back(view_id);
+    }
+  }
+  NonlinearPositionEstimator position_estimator(
+      options_.nonlinear_position_estimator_options, *reconstruction_);
+  position_estimator.SetViewsFixed(fixed_positions);
+  return position_estimator.EstimatePositions(
+      subgraph->GetAllEdges(), orientations_, &positions_);
+}
+
 bool GlobalReconstructionEstimator::FilterInitialViewGraph() {
+  THEIA_TRACE_SCOPE("GlobalReconstructionEstimator::FilterInitialViewGraph");
   // Remove any view pairs that do not have a sufficient number of inliers.
   std::unordered_set<ViewIdPair> view_pairs_to_remove;
   const auto& view_pairs = view_graph_->GetAllEdges();
@@ -312,14 +895,37 @@ bool GlobalReconstructionEstimator::FilterInitialViewGraph() {
 
   // Only reconstruct the largest connected component.
   RemoveDisconnectedViewPairs(view_graph_);
+
+  if (options_.view_graph_sparsification_num_edges_per_view > 0) {
+    SparsifyViewGraphOptions sparsify_options;
+    sparsify_options.num_edges_per_view =
+        options_.view_graph_sparsification_num_edges_per_view;
+    sparsify_options.use_visibility_score =
+        options_.view_graph_sparsification_use_visibility_score;
+    sparsify_options.num_threads = options_.num_threads;
+    SparsifyViewGraph(sparsify_options, view_graph_);
+  }
   return view_graph_->NumEdges() >= 1;
 }
 
 void GlobalReconstructionEstimator::CalibrateCameras() {
+  THEIA_TRACE_SCOPE("GlobalReconstructionEstimator::CalibrateCameras");
   SetCameraIntrinsicsFromPriors(reconstruction_);
 }
 
+void GlobalReconstructionEstimator::WriteCheckpoint(
+    const ReconstructionCheckpointStage stage) {
+  if (options_.checkpoint == nullptr) {
+    return;
+  }
+  if (!options_.checkpoint->Write(
+          stage, *view_graph_, *reconstruction_, orientations_, positions_)) {
+    LOG(WARNING) << "Could not write the checkpoint.";
+  }
+}
+
 bool GlobalReconstructionEstimator::EstimateGlobalRotations() {
+  THEIA_TRACE_SCOPE("GlobalReconstructionEstimator::EstimateGlobalRotations");
   const auto& view_pairs = view_graph_->GetAllEdges();
 
   // Choose the global rotation estimation type.
@@ -328,8 +934,10 @@ bool GlobalReconstructionEstimator::EstimateGlobalRotations() {
     case GlobalRotationEstimatorType::ROBUST_L1L2: {
       // Initialize the orientation estimations by walking along the maximum
       // spanning tree.
-      OrientationsFromMaximumSpanningTree(*view_graph_, &orientations_);
+      OrientationsFromMaximumSpanningTree(
+          *view_graph_, options_.num_threads, &orientations_);
       RobustRotationEstimator::Options robust_rotation_estimator_options;
+      robust_rotation_estimator_options.num_threads = options_.num_threads;
       rotation_estimator.reset(
           new RobustRotationEstimator(robust_rotation_estimator_options));
       break;
@@ -337,7 +945,8 @@ bool GlobalReconstructionEstimator::EstimateGlobalRotations() {
     case GlobalRotationEstimatorType::NONLINEAR: {
       // Initialize the orientation estimations by walking along the maximum
       // spanning tree.
-      OrientationsFromMaximumSpanningTree(*view_graph_, &orientations_);
+      OrientationsFromMaximumSpanningTree(
+          *view_graph_, options_.num_threads, &orientations_);
       rotation_estimator.reset(new NonlinearRotationEstimator());
       break;
     }
@@ -348,12 +957,14 @@ bool GlobalReconstructionEstimator::EstimateGlobalRotations() {
       break;
     }
     case GlobalRotationEstimatorType::LAGRANGE_DUAL: {
-      OrientationsFromMaximumSpanningTree(*view_graph_, &orientations_);
+      OrientationsFromMaximumSpanningTree(
+          *view_graph_, options_.num_threads, &orientations_);
       rotation_estimator.reset(new LagrangeDualRotationEstimator());
       break;
     }
     case GlobalRotationEstimatorType::HYBRID: {
-      OrientationsFromMaximumSpanningTree(*view_graph_, &orientations_);
+      OrientationsFromMaximumSpanningTree(
+          *view_graph_, options_.num_threads, &orientations_);
       rotation_estimator.reset(new HybridRotationEstimator());
       break;
     }
@@ -367,11 +978,13 @@ bool GlobalReconstructionEstimator::EstimateGlobalRotations() {
 }
 
 void GlobalReconstructionEstimator::FilterRotations() {
+  THEIA_TRACE_SCOPE("GlobalReconstructionEstimator::FilterRotations");
   // Filter view pairs based on the relative rotation and the estimated global
   // orientations.
   FilterViewPairsFromOrientation(
       orientations_,
       options_.rotation_filtering_max_difference_degrees,
+      options_.num_threads,
       view_graph_);
   // Remove any disconnected views from the estimation.
   const std::unordered_set<ViewId> removed_views =
@@ -382,6 +995,8 @@ void GlobalReconstructionEstimator::FilterRotations() {
 }
 
 void GlobalReconstructionEstimator::OptimizePairwiseTranslations() {
+  THEIA_TRACE_SCOPE(
+      "GlobalReconstructionEstimator::OptimizePairwiseTranslations");
   if (options_.refine_relative_translations_after_rotation_estimation) {
     RefineRelativeTranslationsWithKnownRotations(
         *reconstruction_, orientations_, options_.num_threads, view_graph_);
@@ -389,11 +1004,14 @@ void GlobalReconstructionEstimator::OptimizePairwiseTranslations() {
 }
 
 void GlobalReconstructionEstimator::FilterRelativeTranslation() {
+  THEIA_TRACE_SCOPE(
+      "GlobalReconstructionEstimator::FilterRelativeTranslation");
   if (options_.extract_maximal_rigid_subgraph) {
     LOG(INFO) << "Extracting maximal rigid component of viewing graph to "
                  "determine which cameras are well-constrained for position "
                  "estimation.";
-    ExtractMaximallyParallelRigidSubgraph(orientations_, view_graph_);
+    ExtractMaximallyParallelRigidSubgraph(
+        orientations_, options_.num_threads, view_graph_);
   }
 
   // Filter potentially bad relative translations.
@@ -411,6 +1029,7 @@ void GlobalReconstructionEstimator::FilterRelativeTranslation() {
 }
 
 bool GlobalReconstructionEstimator::EstimatePosition() {
+  THEIA_TRACE_SCOPE("GlobalReconstructionEstimator::EstimatePosition");
   // Estimate position.
   const auto& view_pairs = view_graph_->GetAllEdges();
   std::unique_ptr<PositionEstimator> position_estimator;
@@ -450,23 +1069,15 @@ bool GlobalReconstructionEstimator::EstimatePosition() {
 }
 
 void GlobalReconstructionEstimator::EstimateStructure() {
+  THEIA_TRACE_SCOPE("GlobalReconstructionEstimator::EstimateStructure");
   // Estimate all tracks.
-  TrackEstimator::Options triangulation_options;
-  triangulation_options.max_acceptable_reprojection_error_pixels =
-      options_.triangulation_max_reprojection_error_in_pixels;
-  triangulation_options.min_triangulation_angle_degrees =
-      options_.min_triangulation_angle_degrees;
-  triangulation_options.bundle_adjustment = options_.bundle_adjust_tracks;
-  triangulation_options.ba_options = SetBundleAdjustmentOptions(options_, 0);
-  triangulation_options.ba_options.num_threads = 1;
-  triangulation_options.ba_options.verbose = false;
-  triangulation_options.num_threads = options_.num_threads;
-  triangulation_options.triangulation_method = options_.triangulation_method;
-  TrackEstimator track_estimator(triangulation_options, reconstruction_);
+  TrackEstimator track_estimator(SetTriangulationOptions(options_),
+                                 reconstruction_);
   const TrackEstimator::Summary summary = track_estimator.EstimateAllTracks();
 }
 
 bool GlobalReconstructionEstimator::BundleAdjustment() {
+  THEIA_TRACE_SCOPE("GlobalReconstructionEstimator::BundleAdjustment");
   // Bundle adjustment.
   bundle_adjustment_options_ =
       SetBundleAdjustmentOptions(options_, positions_.size());
@@ -482,6 +1093,7 @@ bool GlobalReconstructionEstimator::BundleAdjustment() {
           options_.track_subset_selection_long_track_length_threshold,
           options_.track_selection_image_grid_cell_size_pixels,
           options_.min_num_optimized_tracks_per_view,
+          options_.num_threads,
           &tracks_to_optimize)) {
     // Set all tracks that were not chosen for BA to be unestimated so that they
     // do not affect the bundle adjustment optimization.
@@ -506,6 +1118,8 @@ bool GlobalReconstructionEstimator::BundleAdjustment() {
 }
 
 bool GlobalReconstructionEstimator::BundleAdjustCameraPositionsAndPoints() {
+  THEIA_TRACE_SCOPE(
+      "GlobalReconstructionEstimator::BundleAdjustCameraPositionsAndPoints");
   bundle_adjustment_options_ =
       SetBundleAdjustmentOptions(options_, positions_.size());
   bundle_adjustment_options_.constant_camera_orientation = true;
@@ -523,6 +1137,7 @@ bool GlobalReconstructionEstimator::BundleAdjustCameraPositionsAndPoints() {
           options_.track_subset_selection_long_track_length_threshold,
           options_.track_selection_image_grid_cell_size_pixels,
           options_.min_num_optimized_tracks_per_view,
+          options_.num_threads,
           &tracks_to_optimize)) {
     GetEstimatedTracksFromReconstruction(*reconstruction_, &tracks_to_optimize);
   }
@@ -35,8 +35,14 @@
 #ifndef THEIA_SFM_GLOBAL_RECONSTRUCTION_ESTIMATOR_H_
 #define THEIA_SFM_GLOBAL_RECONSTRUCTION_ESTIMATOR_H_
 
+#include <Eigen/Core>
+#include <set>
+#include <unordered_map>
+#include <unordered_set>
+
 #include "theia/sfm/bundle_adjustment/bundle_adjustment.h"
 #include "theia/sfm/filter_view_pairs_from_relative_translation.h"
+#include "theia/sfm/reconstruction_checkpoint.h"
 #include "theia/sfm/reconstruction_estimator.h"
 #include "theia/sfm/reconstruction_estimator_options.h"
 #include "theia/sfm/types.h"
@@ -67,7 +73,17 @@ class ViewGraph;
 //   10) Retriangulate, and bundle adjust.
 //
 // After each filtering step we remove any views which are no longer connected
-// to the largest connected component in the view graph.
+// to the largest connected component in the view graph. With multiple threads,
+// step 2 runs concurrently with steps 1, 3 and 4, and the per-edge steps run on
+// the shared executor (see theia/util/executor.h).
+//
+// If a checkpoint is given in the options, it is written after steps 4 and 7
+// and the estimation resumes after the last of these steps that the checkpoint
+// was written for.
+//
+// Views that are added to a reconstruction after it was estimated are
+// estimated with EstimateNewViews, which only solves for the new views and
+// their neighborhood in the view graph instead of the whole reconstruction.
 class GlobalReconstructionEstimator : public ReconstructionEstimator {
  public:
   GlobalReconstructionEstimator(const ReconstructionEstimatorOptions& options);
@@ -75,6 +91,27 @@ class GlobalReconstructionEstimator : public ReconstructionEstimator {
   ReconstructionEstimatorSummary Estimate(ViewGraph* view_graph,
                                           Reconstruction* reconstruction);
 
+  // Estimates the views of the view graph that are not estimated in the
+  // reconstruction, e.g., images that were added to a reconstruction estimated
+  // by Estimate. The new views and the estimated views that are within
+  // options.incremental_global_update_neighborhood_size edges of them in the
+  // view graph are updated as follows:
+  //   1) Initialize the orientations of the new views from their neighbors.
+  //   2) Estimate the rotations with the RobustRotationEstimator.
+  //   3) Remove view pairs that are inconsistent with the rotations.
+  //   4) Optimize and filter the relative translations.
+  //   5) Estimate the positions with the NonlinearPositionEstimator.
+  //   6) Triangulate the tracks of the new views.
+  //   7) Bundle adjust the updated views and their tracks.
+  // The estimated views adjacent to the updated views are held fixed in all
+  // steps, so the update keeps the frame and scale of the reconstruction and
+  // its cost depends on the size of the neighborhood rather than on the size
+  // of the reconstruction. New views that are not connected to an estimated
+  // view, directly or through other new views, remain unestimated. The summary
+  // lists the updated views and the tracks they observe.
+  ReconstructionEstimatorSummary EstimateNewViews(
+      ViewGraph* view_graph, Reconstruction* reconstruction);
+
  private:
   bool FilterInitialViewGraph();
   void CalibrateCameras();
@@ -89,6 +126,19 @@ class GlobalReconstructionEstimator : public ReconstructionEstimator {
   // and intrinsics are held constant.
   bool BundleAdjustCameraPositionsAndPoints();
 
+  // Steps of EstimateNewViews. The view pairs of the update are held in
+  // subgraph and orientations_ and positions_ only hold the views of the
+  // update, where the fixed views are given by fixed_views.
+  bool EstimateNewViewRotations(const std::unordered_set<ViewId>& new_views,
+                                const std::set<ViewId>& fixed_views,
+                                ViewGraph* subgraph);
+  bool EstimateNewViewPositions(const std::unordered_set<ViewId>& new_views,
+                                const std::set<ViewId>& fixed_views,
+                                ViewGraph* subgraph);
+  // Writes the view graph, reconstruction and poses to the checkpoint of the
+  // options, if any.
+  void WriteCheckpoint(const ReconstructionCheckpointStage stage);
+
   ViewGraph* view_graph_;
   Reconstruction* reconstruction_;
 
@@ -0,0 +1,181 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#include <Eigen/Core>
+#include <algorithm>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "theia/io/reconstruction_reader.h"
+#include "theia/math/rotation.h"
+#include "theia/math/util.h"
+#include "theia/matching/image_pair_match.h"
+#include "theia/matching/in_memory_features_and_matches_database.h"
+#include "theia/sfm/global_reconstruction_estimator.h"
+#include "theia/sfm/reconstruction.h"
+#include "theia/sfm/reconstruction_estimator_options.h"
+#include "theia/sfm/reconstruction_estimator_utils.h"
+#include "theia/sfm/twoview_info.h"
+#include "theia/sfm/view_graph/view_graph.h"
+#include "theia/util/map_util.h"
+
+namespace theia {
+namespace {
+
+// Reads the estimated fountain reconstruction and its view graph.
+void ReadInput(Reconstruction* reconstruction, ViewGraph* view_graph) {
+  const std::string reconstruction_filename =
+      THEIA_DATA_DIR + std::string("/sfm/fountain11.bin");
+  const std::string matches_filename =
+      THEIA_DATA_DIR + std::string("/sfm/fountain11_matches.bin");
+  CHECK(ReadReconstruction(reconstruction_filename, reconstruction));
+
+  InMemoryFeaturesAndMatchesDatabase matches_database;
+  CHECK(matches_database.ReadFromFile(matches_filename));
+  for (const auto& match_key : matches_database.ImageNamesOfMatches()) {
+    const ImagePairMatch& match =
+        matches_database.GetImagePairMatch(match_key.first, match_key.second);
+    TwoViewInfo info = match.twoview_info;
+    const ViewId view_id1 = reconstruction->ViewIdFromName(match.image1);
+    const ViewId view_id2 = reconstruction->ViewIdFromName(match.image2);
+    if (view_id1 == kInvalidViewId || view_id2 == kInvalidViewId) {
+      continue;
+    }
+    if (view_id1 > view_id2) {
+      SwapCameras(&info);
+    }
+    view_graph->AddEdge(view_id1, view_id2, info);
+  }
+}
+
+// Sets the views with the given indices in the estimated views of the fountain
+// reconstruction to unestimated, adds them back with EstimateNewViews and
+// checks that their poses are recovered and that the views outside of the
+// update did not move.
+void EstimateAndVerifyNewViews(const std::vector<int>& new_view_indices,
+                               const ReconstructionEstimatorOptions& options) {
+  static const double kRelativePositionTolerance = 0.05;
+  static const double kOrientationToleranceDegrees = 1.0;
+
+  ViewGraph view_graph;
+  Reconstruction reconstruction;
+  ReadInput(&reconstruction, &view_graph);
+
+  std::vector<ViewId> estimated_views;
+  std::unordered_map<ViewId, Eigen::Vector3d> positions, orientations;
+  for (const ViewId view_id : reconstruction.ViewIds()) {
+    const View* view = reconstruction.View(view_id);
+    if (!view->IsEstimated()) {
+      continue;
+    }
+    estimated_views.emplace_back(view_id);
+    positions[view_id] = view->Camera().GetPosition();
+    orientations[view_id] = view->Camera().GetOrientationAsAngleAxis();
+  }
+  std::sort(estimated_views.begin(), estimated_views.end());
+  std::unordered_set<ViewId> new_views;
+  for (const int index : new_view_indices) {
+    ASSERT_LT(index, static_cast<int>(estimated_views.size()));
+    new_views.insert(estimated_views[index]);
+    reconstruction.MutableView(estimated_views[index])->SetEstimated(false);
+  }
+
+  // The positions are compared relative to the extent of the cameras.
+  double scene_scale = 0.0;
+  for (const auto& position : positions) {
+    scene_scale = std::max(
+        scene_scale, (position.second - positions.begin()->second).norm());
+  }
+
+  GlobalReconstructionEstimator estimator(options);
+  const ReconstructionEstimatorSummary summary =
+      estimator.EstimateNewViews(&view_graph, &reconstruction);
+  ASSERT_TRUE(summary.success);
+
+  for (const ViewId view_id : estimated_views) {
+    const View* view = reconstruction.View(view_id);
+    EXPECT_TRUE(view->IsEstimated());
+    const Eigen::Vector3d position = view->Camera().GetPosition();
+    const Eigen::Vector3d orientation =
+        view->Camera().GetOrientationAsAngleAxis();
+    if (!ContainsKey(summary.estimated_views, view_id)) {
+      EXPECT_TRUE(position == positions[view_id]);
+      EXPECT_TRUE(orientation == orientations[view_id]);
+      continue;
+    }
+
+    EXPECT_LT((position - positions[view_id]).norm(),
+              kRelativePositionTolerance * scene_scale);
+    const Eigen::Vector3d rotation_error = RelativeRotationFromTwoRotations(
+        orientations[view_id], orientation);
+    EXPECT_LT(RadToDeg(rotation_error.norm()), kOrientationToleranceDegrees);
+  }
+  for (const ViewId view_id : new_views) {
+    EXPECT_TRUE(ContainsKey(summary.estimated_views, view_id));
+  }
+}
+
+}  // namespace
+
+TEST(GlobalReconstructionEstimator, EstimateNewViews) {
+  ReconstructionEstimatorOptions options;
+  options.intrinsics_to_optimize = OptimizeIntrinsicsType::NONE;
+  EstimateAndVerifyNewViews({0, 5}, options);
+}
+
+TEST(GlobalReconstructionEstimator, EstimateNewViewsWithoutNeighborhood) {
+  ReconstructionEstimatorOptions options;
+  options.intrinsics_to_optimize = OptimizeIntrinsicsType::NONE;
+  options.incremental_global_update_neighborhood_size = 0;
+  EstimateAndVerifyNewViews({3}, options);
+}
+
+TEST(GlobalReconstructionEstimator, NoNewViews) {
+  ViewGraph view_graph;
+  Reconstruction reconstruction;
+  ReadInput(&reconstruction, &view_graph);
+
+  ReconstructionEstimatorOptions options;
+  GlobalReconstructionEstimator estimator(options);
+  const ReconstructionEstimatorSummary summary =
+      estimator.EstimateNewViews(&view_graph, &reconstruction);
+  EXPECT_TRUE(summary.success);
+  EXPECT_TRUE(summary.estimated_views.empty());
+}
+
+}  // namespace theia
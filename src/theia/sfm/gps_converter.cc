@@ -32,7 +32,9 @@
 // Please contact the author of this library if you have any questions.
 // Author: Chris Sweeney (cmsweeney@cs.ucsb.edu)
 
+#include <Eigen/Core>
 #include <glog/logging.h>
+#include <cmath>
 
 #include "theia/math/util.h"
 #include "theia/sfm/gps_converter.h"
@@ -124,4 +126,69 @@ Eigen::Vector3d GPSConverter::LLAToECEF(const Eigen::Vector3d& lla) {
   return ecef;
 }
 
+Eigen::Matrix3Xd GPSConverter::ECEFToLLABatch(const Eigen::Matrix3Xd& ecef) {
+  // The method of Olson branches on the latitude, so each coordinate is
+  // converted on its own.
+  Eigen::Matrix3Xd lla(3, ecef.cols());
+  for (int i = 0; i < ecef.cols(); i++) {
+    lla.col(i) = ECEFToLLA(ecef.col(i));
+  }
+  return lla;
+}
+
+Eigen::Matrix3Xd GPSConverter::LLAToECEFBatch(const Eigen::Matrix3Xd& lla) {
+  const Eigen::ArrayXd lat = lla.row(0).transpose().array() * kDegToRad;
+  const Eigen::ArrayXd lon = lla.row(1).transpose().array() * kDegToRad;
+  const Eigen::ArrayXd alt = lla.row(2).transpose().array();
+  const Eigen::ArrayXd sin_lat = lat.sin();
+  const Eigen::ArrayXd cos_lat = lat.cos();
+  const Eigen::ArrayXd n = a / (1.0 - e2 * sin_lat.square()).sqrt();
+
+  Eigen::Matrix3Xd ecef(3, lla.cols());
+  ecef.row(0) = ((n + alt) * cos_lat * lon.cos()).matrix().transpose();
+  ecef.row(1) = ((n + alt) * cos_lat * lon.sin()).matrix().transpose();
+  ecef.row(2) = ((n * (1.0 - e2) + alt) * sin_lat).matrix().transpose();
+  return ecef;
+}
+
+Eigen::Matrix3d GPSConverter::ECEFToENURotation(
+    const Eigen::Vector3d& reference_lla) {
+  const double lat = theia::DegToRad(reference_lla[0]);
+  const double lon = theia::DegToRad(reference_lla[1]);
+  const double sin_lat = std::sin(lat);
+  const double cos_lat = std::cos(lat);
+  const double sin_lon = std::sin(lon);
+  const double cos_lon = std::cos(lon);
+
+  Eigen::Matrix3d rotation;
+  rotation << -sin_lon, cos_lon, 0.0,
+      -sin_lat * cos_lon, -sin_lat * sin_lon, cos_lat,
+      cos_lat * cos_lon, cos_lat * sin_lon, sin_lat;
+  return rotation;
+}
+
+Eigen::Matrix3Xd GPSConverter::ECEFToENU(const Eigen::Matrix3Xd& ecef,
+                                         const Eigen::Vector3d& reference_lla) {
+  const Eigen::Vector3d reference_ecef = LLAToECEF(reference_lla);
+  return ECEFToENURotation(reference_lla) *
+         (ecef.colwise() - reference_ecef);
+}
+
+Eigen::Matrix3Xd GPSConverter::ENUToECEF(const Eigen::Matrix3Xd& enu,
+                                         const Eigen::Vector3d& reference_lla) {
+  const Eigen::Vector3d reference_ecef = LLAToECEF(reference_lla);
+  return (ECEFToENURotation(reference_lla).transpose() * enu).colwise() +
+         reference_ecef;
+}
+
+Eigen::Matrix3Xd GPSConverter::LLAToENU(const Eigen::Matrix3Xd& lla,
+                                        const Eigen::Vector3d& reference_lla) {
+  return ECEFToENU(LLAToECEFBatch(lla), reference_lla);
+}
+
+Eigen::Matrix3Xd GPSConverter::ENUToLLA(const Eigen::Matrix3Xd& enu,
+                                        const Eigen::Vector3d& reference_lla) {
+  return ECEFToLLABatch(ENUToECEF(enu, reference_lla));
+}
+
 }  // namespace theia
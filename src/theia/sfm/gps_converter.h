@@ -64,6 +64,34 @@ class GPSConverter {
   // latitude and longitude should be in degrees and the altitude in meters. The
   // returned ECEF coordinates will be in meters.
   static Eigen::Vector3d LLAToECEF(const Eigen::Vector3d& lla);
+
+  // Batched versions of the conversions above, with one coordinate per column.
+  // The trigonometric functions of LLAToECEFBatch are evaluated with Eigen's
+  // vectorized array functions over all coordinates at once.
+  static Eigen::Matrix3Xd ECEFToLLABatch(const Eigen::Matrix3Xd& ecef);
+  static Eigen::Matrix3Xd LLAToECEFBatch(const Eigen::Matrix3Xd& lla);
+
+  // Returns the rotation from ECEF coordinates to the local east-north-up (ENU)
+  // frame at the reference latitude, longitude and altitude.
+  static Eigen::Matrix3d ECEFToENURotation(
+      const Eigen::Vector3d& reference_lla);
+
+  // Converts between ECEF coordinates and coordinates in meters in the local
+  // ENU frame whose origin is at the reference latitude, longitude and
+  // altitude, with one coordinate per column. ENU coordinates are a convenient
+  // metric frame for position priors of a reconstruction, since ECEF
+  // coordinates are very large.
+  static Eigen::Matrix3Xd ECEFToENU(const Eigen::Matrix3Xd& ecef,
+                                    const Eigen::Vector3d& reference_lla);
+  static Eigen::Matrix3Xd ENUToECEF(const Eigen::Matrix3Xd& enu,
+                                    const Eigen::Vector3d& reference_lla);
+
+  // Converts between latitude, longitude and altitude and the local ENU frame
+  // at the reference latitude, longitude and altitude.
+  static Eigen::Matrix3Xd LLAToENU(const Eigen::Matrix3Xd& lla,
+                                   const Eigen::Vector3d& reference_lla);
+  static Eigen::Matrix3Xd ENUToLLA(const Eigen::Matrix3Xd& enu,
+                                   const Eigen::Vector3d& reference_lla);
 };
 
 }  // namespace theia
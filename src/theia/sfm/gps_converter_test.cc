@@ -86,4 +86,69 @@ TEST(GPSConverter, RoundTrip) {
   }
 }
 
+TEST(GPSConverter, BatchMatchesSingleConversions) {
+  RandomNumberGenerator rng(70);
+
+  static const double kTolerance = 1e-8;
+  static const int kNumPoints = 100;
+  Eigen::Matrix3Xd lla(3, kNumPoints);
+  for (int i = 0; i < kNumPoints; i++) {
+    lla.col(i) = Eigen::Vector3d(rng.RandDouble(-90.0, 90.0),
+                                 rng.RandDouble(-180.0, 180.0),
+                                 rng.RandDouble(-10000, 100000));
+  }
+
+  const Eigen::Matrix3Xd ecef = GPSConverter::LLAToECEFBatch(lla);
+  const Eigen::Matrix3Xd round_trip_lla = GPSConverter::ECEFToLLABatch(ecef);
+  ASSERT_EQ(ecef.cols(), kNumPoints);
+  ASSERT_EQ(round_trip_lla.cols(), kNumPoints);
+  for (int i = 0; i < kNumPoints; i++) {
+    const Eigen::Vector3d expected_ecef = GPSConverter::LLAToECEF(lla.col(i));
+    EXPECT_NEAR((ecef.col(i) - expected_ecef).norm(), 0.0, kTolerance);
+    EXPECT_NEAR((round_trip_lla.col(i) - lla.col(i)).norm(), 0.0, kTolerance);
+  }
+}
+
+TEST(GPSConverter, ENU) {
+  static const double kTolerance = 1e-6;
+  const Eigen::Vector3d taj_mahal_lla(27.173891, 78.042068, 168.0);
+
+  // The reference is the origin of the ENU frame.
+  Eigen::Matrix3Xd lla(3, 4);
+  lla.col(0) = taj_mahal_lla;
+  // 10 meters up.
+  lla.col(1) = taj_mahal_lla + Eigen::Vector3d(0.0, 0.0, 10.0);
+  // North and east of the reference.
+  lla.col(2) = taj_mahal_lla + Eigen::Vector3d(0.001, 0.0, 0.0);
+  lla.col(3) = taj_mahal_lla + Eigen::Vector3d(0.0, 0.001, 0.0);
+
+  const Eigen::Matrix3Xd enu = GPSConverter::LLAToENU(lla, taj_mahal_lla);
+  EXPECT_NEAR(enu.col(0).norm(), 0.0, kTolerance);
+  EXPECT_NEAR((enu.col(1) - Eigen::Vector3d(0.0, 0.0, 10.0)).norm(),
+              0.0,
+              kTolerance);
+  // One thousandth of a degree is roughly 111 meters north, and roughly 99
+  // meters east at this latitude.
+  EXPECT_NEAR(enu(0, 2), 0.0, 1e-3);
+  EXPECT_NEAR(enu(1, 2), 110.8, 0.5);
+  EXPECT_NEAR(enu(0, 3), 99.1, 0.5);
+  EXPECT_NEAR(enu(1, 3), 0.0, 1e-2);
+  EXPECT_NEAR(enu(2, 2), 0.0, 1e-2);
+  EXPECT_NEAR(enu(2, 3), 0.0, 1e-2);
+
+  // The rotation is orthonormal and the conversions invert each other.
+  const Eigen::Matrix3d rotation =
+      GPSConverter::ECEFToENURotation(taj_mahal_lla);
+  EXPECT_NEAR((rotation * rotation.transpose() - Eigen::Matrix3d::Identity())
+                  .norm(),
+              0.0,
+              1e-12);
+  const Eigen::Matrix3Xd round_trip_lla =
+      GPSConverter::ENUToLLA(enu, taj_mahal_lla);
+  EXPECT_NEAR((round_trip_lla - lla).norm(), 0.0, 1e-8);
+  const Eigen::Matrix3Xd ecef = GPSConverter::LLAToECEFBatch(lla);
+  EXPECT_NEAR(
+      (GPSConverter::ENUToECEF(enu, taj_mahal_lla) - ecef).norm(), 0.0, 1e-6);
+}
+
 }  // namespace theia
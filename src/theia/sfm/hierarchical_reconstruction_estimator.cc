@@ -0,0 +1,640 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#include "theia/sfm/hierarchical_reconstruction_estimator.h"
+
+#include <Eigen/Core>
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <sstream>  // NOLINT
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "theia/math/graph/normalized_graph_cut.h"
+#include "theia/sfm/bundle_adjustment/bundle_adjustment.h"
+#include "theia/sfm/camera/camera.h"
+#include "theia/sfm/estimate_track.h"
+#include "theia/sfm/reconstruction.h"
+#include "theia/sfm/reconstruction_estimator_options.h"
+#include "theia/sfm/reconstruction_estimator_utils.h"
+#include "theia/sfm/select_good_tracks_for_bundle_adjustment.h"
+#include "theia/sfm/set_camera_intrinsics_from_priors.h"
+#include "theia/sfm/set_outlier_tracks_to_unestimated.h"
+#include "theia/sfm/track.h"
+#include "theia/sfm/transformation/align_multiple_reconstructions.h"
+#include "theia/sfm/twoview_info.h"
+#include "theia/sfm/view.h"
+#include "theia/sfm/view_graph/view_graph.h"
+#include "theia/util/executor.h"
+#include "theia/util/hash.h"
+#include "theia/util/map_util.h"
+#include "theia/util/timer.h"
+#include "theia/util/trace.h"
+
+namespace theia {
+
+namespace {
+
+// The minimum number of inlier correspondences (shared views and tracks) two
+// clusters must have to be aligned. This is the minimal sample of the RANSAC
+// alignment.
+static const int kMinNumAlignmentCorrespondences = 4;
+
+// All times are given in seconds.
+struct HierarchicalReconstructionEstimatorTimings {
+  double view_graph_partitioning_time = 0.0;
+  double cluster_estimation_time = 0.0;
+  double cluster_merging_time = 0.0;
+};
+
+void SetUnderconstrainedAsUnestimated(Reconstruction* reconstruction) {
+  int num_underconstrained_views = -1;
+  int num_underconstrained_tracks = -1;
+  while (num_underconstrained_views != 0 && num_underconstrained_tracks != 0) {
+    num_underconstrained_views =
+        SetUnderconstrainedViewsToUnestimated(reconstruction);
+    num_underconstrained_tracks =
+        SetUnderconstrainedTracksToUnestimated(reconstruction);
+  }
+}
+
+// Reconstruction::GetSubReconstruction shares the camera intrinsics with the
+// original reconstruction. Each intrinsics group of the subreconstruction is
+// given its own copy so that clusters may refine them concurrently.
+void CopyCameraIntrinsics(Reconstruction* reconstruction) {
+  const auto group_ids = reconstruction->CameraIntrinsicsGroupIds();
+  for (const CameraIntrinsicsGroupId group_id : group_ids) {
+    const auto view_ids =
+        reconstruction->GetViewsInCameraIntrinsicGroup(group_id);
+    Camera camera;
+    camera.DeepCopy(reconstruction->View(*view_ids.begin())->Camera());
+    for (const ViewId view_id : view_ids) {
+      reconstruction->MutableView(view_id)
+          ->MutableCamera()
+          ->MutableCameraIntrinsics() = camera.CameraIntrinsics();
+    }
+  }
+}
+
+// Copies the poses of the views and the points of the tracks that are
+// estimated in the (aligned) cluster but not yet in the reconstruction. The
+// intrinsics of an intrinsics group are taken from the first cluster that
+// estimates one of its views. The poses of the copied views are also added to
+// merged_cameras, which holds the views that are already merged.
+// Returns the number of views that were copied.
+int CopyClusterEstimates(
+    const Reconstruction& cluster,
+    std::unordered_set<CameraIntrinsicsGroupId>* merged_intrinsics_groups,
+    Reconstruction* merged_cameras,
+    Reconstruction* reconstruction) {
+  int num_copied_views = 0;
+  const auto view_ids = cluster.ViewIds();
+  for (const ViewId view_id : view_ids) {
+    const View* cluster_view = cluster.View(view_id);
+    View* view = reconstruction->MutableView(view_id);
+    if (!cluster_view->IsEstimated() || view == nullptr ||
+        merged_cameras->ViewIdFromName(view->Name()) != kInvalidViewId) {
+      continue;
+    }
+
+    const Camera& cluster_camera = cluster_view->Camera();
+    Camera* camera = view->MutableCamera();
+    camera->SetPosition(cluster_camera.GetPosition());
+    camera->SetOrientationFromRotationMatrix(
+        cluster_camera.GetOrientationAsRotationMatrix());
+    const CameraIntrinsicsGroupId group_id =
+        reconstruction->CameraIntrinsicsGroupIdFromViewId(view_id);
+    if (merged_intrinsics_groups->insert(group_id).second &&
+        camera->GetCameraIntrinsicsModelType() ==
+            cluster_camera.GetCameraIntrinsicsModelType()) {
+      std::copy(cluster_camera.intrinsics(),
+                cluster_camera.intrinsics() +
+                    cluster_camera.CameraIntrinsics()->NumParameters(),
+                camera->mutable_intrinsics());
+    }
+    view->SetEstimated(true);
+    ++num_copied_views;
+
+    // Timestamps must be unique but are otherwise irrelevant for the merged
+    // cameras, so the view index is used.
+    const ViewId merged_view_id = merged_cameras->AddView(
+        view->Name(), static_cast<double>(merged_cameras->NumViews()));
+    View* merged_view = merged_cameras->MutableView(merged_view_id);
+    *merged_view->MutableCamera() = cluster_camera;
+    merged_view->SetEstimated(true);
+  }
+
+  const auto track_ids = cluster.TrackIds();
+  for (const TrackId track_id : track_ids) {
+    const Track* cluster_track = cluster.Track(track_id);
+    Track* track = reconstruction->MutableTrack(track_id);
+    if (!cluster_track->IsEstimated() || track == nullptr ||
+        track->IsEstimated()) {
+      continue;
+    }
+    *track->MutablePoint() = cluster_track->Point();
+    track->SetEstimated(true);
+  }
+  return num_copied_views;
+}
+
+}  // namespace
+
+HierarchicalReconstructionEstimator::HierarchicalReconstructionEstimator(
+    const ReconstructionEstimatorOptions& options) {
+  CHECK(options.hierarchical_cluster_estimator_type !=
+        ReconstructionEstimatorType::HIERARCHICAL)
+      << "The clusters of hierarchical SfM cannot be reconstructed with "
+         "hierarchical SfM.";
+  CHECK_GT(options.hierarchical_max_views_per_cluster, 0);
+  CHECK_GE(options.hierarchical_num_overlapping_views, 0);
+  CHECK_GT(options.hierarchical_alignment_relative_error_threshold, 0.0);
+  options_ = options;
+}
+
+ReconstructionEstimatorSummary HierarchicalReconstructionEstimator::Estimate(
+    ViewGraph* view_graph, Reconstruction* reconstruction) {
+  THEIA_TRACE_SCOPE("HierarchicalReconstructionEstimator::Estimate");
+  CHECK_NOTNULL(reconstruction);
+  reconstruction_ = reconstruction;
+  view_graph_ = view_graph;
+  clusters_.clear();
+  cluster_reconstructions_.clear();
+
+  ReconstructionEstimatorSummary summary;
+  HierarchicalReconstructionEstimatorTimings hierarchical_estimator_timings;
+  Timer total_timer;
+  Timer timer;
+
+  // Step 1. Partition the view graph.
+  LOG(INFO) << "Partitioning the view graph.";
+  timer.Reset();
+  PartitionViewGraph();
+  hierarchical_estimator_timings.view_graph_partitioning_time =
+      timer.ElapsedTimeInSeconds();
+
+  // Small problems do not need to be divided.
+  if (clusters_.size() <= 1) {
+    LOG(INFO) << "The view graph forms a single cluster. Reconstructing it "
+                 "directly.";
+    ReconstructionEstimatorOptions cluster_options = options_;
+    cluster_options.reconstruction_estimator_type =
+        options_.hierarchical_cluster_estimator_type;
+    std::unique_ptr<ReconstructionEstimator> estimator(
+        ReconstructionEstimator::Create(cluster_options));
+    return estimator->Estimate(view_graph_, reconstruction_);
+  }
+
+  // Step 2. Calibrate any uncalibrated cameras. This gives the clusters and the
+  // final bundle adjustment the same initial intrinsics.
+  LOG(INFO) << "Calibrating any uncalibrated cameras.";
+  timer.Reset();
+  SetCameraIntrinsicsFromPriors(reconstruction_);
+  summary.camera_intrinsics_calibration_time = timer.ElapsedTimeInSeconds();
+
+  // Step 3. Make the clusters overlap.
+  timer.Reset();
+  ExpandClusters();
+  hierarchical_estimator_timings.view_graph_partitioning_time +=
+      timer.ElapsedTimeInSeconds();
+
+  // Step 4. Reconstruct each cluster.
+  LOG(INFO) << "Reconstructing " << clusters_.size() << " clusters.";
+  timer.Reset();
+  const int num_estimated_clusters = EstimateClusters();
+  hierarchical_estimator_timings.cluster_estimation_time =
+      timer.ElapsedTimeInSeconds();
+  if (num_estimated_clusters == 0) {
+    LOG(WARNING) << "No cluster could be reconstructed.";
+    return summary;
+  }
+
+  // Step 5. Merge the cluster reconstructions.
+  LOG(INFO) << "Merging " << num_estimated_clusters
+            << " cluster reconstructions.";
+  timer.Reset();
+  const int num_merged_clusters = MergeClusters();
+  hierarchical_estimator_timings.cluster_merging_time =
+      timer.ElapsedTimeInSeconds();
+  summary.pose_estimation_time =
+      hierarchical_estimator_timings.cluster_estimation_time +
+      hierarchical_estimator_timings.cluster_merging_time;
+
+  // Always triangulate once, then retriangulate and remove outliers depending
+  // on the reconstruciton estimator options.
+  for (int i = 0; i < options_.num_retriangulation_iterations + 1; i++) {
+    // Step 6. Triangulate the tracks that no cluster estimated.
+    LOG(INFO) << "Triangulating all features.";
+    timer.Reset();
+    EstimateStructure();
+    summary.triangulation_time += timer.ElapsedTimeInSeconds();
+
+    SetUnderconstrainedAsUnestimated(reconstruction_);
+
+    // Step 7. Bundle Adjustment.
+    LOG(INFO) << "Performing bundle adjustment.";
+    timer.Reset();
+    if (!BundleAdjustment()) {
+      summary.success = false;
+      LOG(WARNING) << "Bundle adjustment failed!";
+      return summary;
+    }
+    summary.bundle_adjustment_time += timer.ElapsedTimeInSeconds();
+
+    int num_points_removed =
+        SetOutlierTracksToUnestimated(options_.max_reprojection_error_in_pixels,
+                                      options_.min_triangulation_angle_degrees,
+                                      options_.num_threads,
+                                      reconstruction_);
+    LOG(INFO) << num_points_removed << " outlier points were removed.";
+  }
+
+  // Set the output parameters.
+  GetEstimatedViewsFromReconstruction(*reconstruction_,
+                                      &summary.estimated_views);
+  GetEstimatedTracksFromReconstruction(*reconstruction_,
+                                       &summary.estimated_tracks);
+  summary.success = true;
+  summary.total_time = total_timer.ElapsedTimeInSeconds();
+
+  // Output some timing statistics.
+  std::ostringstream string_stream;
+  string_stream
+      << "Hierarchical Reconstruction Estimator timings:"
+      << "\n\tView graph partitioning time = "
+      << hierarchical_estimator_timings.view_graph_partitioning_time
+      << "\n\tCamera intrinsic calibration time = "
+      << summary.camera_intrinsics_calibration_time
+      << "\n\tCluster estimation time = "
+      << hierarchical_estimator_timings.cluster_estimation_time
+      << "\n\tCluster merging time = "
+      << hierarchical_estimator_timings.cluster_merging_time
+      << "\n\tNumber of clusters = " << clusters_.size()
+      << "\n\tNumber of estimated clusters = " << num_estimated_clusters
+      << "\n\tNumber of merged clusters = " << num_merged_clusters;
+  summary.message = string_stream.str();
+
+  clusters_.clear();
+  cluster_reconstructions_.clear();
+  return summary;
+}
+
+void HierarchicalReconstructionEstimator::PartitionViewGraph() {
+  THEIA_TRACE_SCOPE("HierarchicalReconstructionEstimator::PartitionViewGraph");
+  const auto& view_pairs = view_graph_->GetAllEdges();
+  const NormalizedGraphCut<ViewId>::Options ncut_options;
+
+  std::vector<std::unordered_set<ViewId>> clusters_to_split;
+  clusters_to_split.emplace_back(view_graph_->ViewIds());
+  while (!clusters_to_split.empty()) {
+    std::unordered_set<ViewId> cluster = std::move(clusters_to_split.back());
+    clusters_to_split.pop_back();
+    if (cluster.size() <= options_.hierarchical_max_views_per_cluster) {
+      clusters_.emplace_back(std::move(cluster));
+      continue;
+    }
+
+    // Collect the edges within the cluster, weighted by their number of
+    // verified matches.
+    std::unordered_map<ViewIdPair, double> edges;
+    std::unordered_set<ViewId> connected_views;
+    for (const auto& view_pair : view_pairs) {
+      const ViewId view_id1 = view_pair.first.first;
+      const ViewId view_id2 = view_pair.first.second;
+      if (!ContainsKey(cluster, view_id1) || !ContainsKey(cluster, view_id2)) {
+        continue;
+      }
+      edges.emplace(view_pair.first, view_pair.second.num_verified_matches);
+      connected_views.emplace(view_id1);
+      connected_views.emplace(view_id2);
+    }
+
+    // Views without edges inside the cluster are dropped by the cut. They
+    // may still be added back to a neighboring cluster in ExpandClusters.
+    std::unordered_set<ViewId> subgraph1, subgraph2;
+    NormalizedGraphCut<ViewId> ncut(ncut_options);
+    if (connected_views.size() < 4 ||
+        !ncut.ComputeCut(edges, &subgraph1, &subgraph2, nullptr) ||
+        subgraph1.empty() || subgraph2.empty()) {
+      LOG(WARNING) << "Could not split a cluster of " << cluster.size()
+                   << " views.";
+      clusters_.emplace_back(std::move(cluster));
+      continue;
+    }
+    clusters_to_split.emplace_back(std::move(subgraph1));
+    clusters_to_split.emplace_back(std::move(subgraph2));
+  }
+}
+
+void HierarchicalReconstructionEstimator::ExpandClusters() {
+  THEIA_TRACE_SCOPE("HierarchicalReconstructionEstimator::ExpandClusters");
+  std::unordered_map<ViewId, int> view_to_cluster;
+  for (int i = 0; i < clusters_.size(); i++) {
+    for (const ViewId view_id : clusters_[i]) {
+      view_to_cluster[view_id] = i;
+    }
+  }
+
+  // Collect the edges that were cut between each pair of clusters. The view
+  // pairs are ordered so that the first view is in the first cluster.
+  std::unordered_map<std::pair<int, int>,
+                     std::vector<std::pair<double, ViewIdPair>>>
+      cut_edges;
+  const auto& view_pairs = view_graph_->GetAllEdges();
+  for (const auto& view_pair : view_pairs) {
+    const ViewId view_id1 = view_pair.first.first;
+    const ViewId view_id2 = view_pair.first.second;
+    const int cluster1 = FindWithDefault(view_to_cluster, view_id1, -1);
+    const int cluster2 = FindWithDefault(view_to_cluster, view_id2, -1);
+    if (cluster1 == -1 || cluster2 == -1 || cluster1 == cluster2) {
+      continue;
+    }
+    const double weight = view_pair.second.num_verified_matches;
+    if (cluster1 < cluster2) {
+      cut_edges[std::make_pair(cluster1, cluster2)].emplace_back(
+          weight, ViewIdPair(view_id1, view_id2));
+    } else {
+      cut_edges[std::make_pair(cluster2, cluster1)].emplace_back(
+          weight, ViewIdPair(view_id2, view_id1));
+    }
+  }
+
+  // Add both views of the strongest cut edges to both clusters until they
+  // share enough views.
+  for (auto& cluster_pair : cut_edges) {
+    std::vector<std::pair<double, ViewIdPair>>& edges = cluster_pair.second;
+    std::sort(edges.begin(),
+              edges.end(),
+              std::greater<std::pair<double, ViewIdPair>>());
+    std::unordered_set<ViewId> shared_views;
+    for (const auto& edge : edges) {
+      if (shared_views.size() >= options_.hierarchical_num_overlapping_views) {
+        break;
+      }
+      shared_views.emplace(edge.second.first);
+      shared_views.emplace(edge.second.second);
+    }
+    clusters_[cluster_pair.first.first].insert(shared_views.begin(),
+                                               shared_views.end());
+    clusters_[cluster_pair.first.second].insert(shared_views.begin(),
+                                                shared_views.end());
+  }
+}
+
+int HierarchicalReconstructionEstimator::EstimateClusters() {
+  THEIA_TRACE_SCOPE("HierarchicalReconstructionEstimator::EstimateClusters");
+  const int num_clusters = clusters_.size();
+  const int num_parallel_clusters =
+      std::max(1, std::min(options_.num_threads, num_clusters));
+
+  // Each cluster gets its own view graph, reconstruction, and random number
+  // generator so that the clusters are independent. The threads are split
+  // between the clusters that are reconstructed at the same time.
+  std::vector<ReconstructionEstimatorOptions> cluster_options(num_clusters,
+                                                              options_);
+  std::vector<std::unique_ptr<ViewGraph>> cluster_view_graphs(num_clusters);
+  cluster_reconstructions_.resize(num_clusters);
+  for (int i = 0; i < num_clusters; i++) {
+    cluster_options[i].reconstruction_estimator_type =
+        options_.hierarchical_cluster_estimator_type;
+    cluster_options[i].num_threads =
+        std::max(1, options_.num_threads / num_parallel_clusters);
+    if (options_.rng != nullptr) {
+      cluster_options[i].rng = options_.rng->Split(i);
+    }
+    // The checkpoint stores the state of the whole reconstruction, not of the
+    // clusters.
+    cluster_options[i].checkpoint.reset();
+
+    cluster_view_graphs[i].reset(new ViewGraph);
+    view_graph_->ExtractSubgraph(clusters_[i], cluster_view_graphs[i].get());
+    cluster_reconstructions_[i].reset(new Reconstruction);
+    reconstruction_->GetSubReconstruction(clusters_[i],
+                                          cluster_reconstructions_[i].get());
+    CopyCameraIntrinsics(cluster_reconstructions_[i].get());
+  }
+
+  // Start with the largest clusters so that the threads stay busy.
+  std::vector<int> cluster_order(num_clusters);
+  for (int i = 0; i < num_clusters; i++) {
+    cluster_order[i] = i;
+  }
+  std::sort(cluster_order.begin(),
+            cluster_order.end(),
+            [this](const int cluster1, const int cluster2) {
+              return clusters_[cluster1].size() > clusters_[cluster2].size();
+            });
+
+  // The clusters are handed out in this order, and the parallel stages within
+  // each cluster share the threads of the global executor.
+  std::vector<ReconstructionEstimatorSummary> summaries(num_clusters);
+  ParallelFor(
+      num_parallel_clusters, num_clusters, [&](const int start, const int end) {
+        for (int k = start; k < end; k++) {
+          const int i = cluster_order[k];
+          std::unique_ptr<ReconstructionEstimator> estimator(
+              ReconstructionEstimator::Create(cluster_options[i]));
+          summaries[i] = estimator->Estimate(cluster_view_graphs[i].get(),
+                                             cluster_reconstructions_[i].get());
+        }
+      });
+
+  // Only keep the estimated part of each cluster.
+  int num_estimated_clusters = 0;
+  for (int i = 0; i < num_clusters; i++) {
+    LOG(INFO) << "Cluster " << i << ": estimated "
+              << summaries[i].estimated_views.size() << " of "
+              << clusters_[i].size() << " views.";
+    if (!summaries[i].success) {
+      cluster_reconstructions_[i].reset();
+      continue;
+    }
+    std::unique_ptr<Reconstruction> estimated_reconstruction(
+        new Reconstruction);
+    CreateEstimatedSubreconstruction(*cluster_reconstructions_[i],
+                                     estimated_reconstruction.get());
+    cluster_reconstructions_[i] = std::move(estimated_reconstruction);
+    ++num_estimated_clusters;
+  }
+  return num_estimated_clusters;
+}
+
+int HierarchicalReconstructionEstimator::MergeClusters() {
+  THEIA_TRACE_SCOPE("HierarchicalReconstructionEstimator::MergeClusters");
+  // Align all clusters jointly to the largest cluster.
+  std::vector<int> cluster_indices;
+  std::vector<Reconstruction*> clusters;
+  MultipleReconstructionAlignmentOptions alignment_options;
+  for (int i = 0; i < cluster_reconstructions_.size(); i++) {
+    if (cluster_reconstructions_[i] == nullptr) {
+      continue;
+    }
+    Reconstruction* cluster = cluster_reconstructions_[i].get();
+    if (!clusters.empty() &&
+        cluster->NumViews() >
+            clusters[alignment_options.reference_reconstruction]->NumViews()) {
+      alignment_options.reference_reconstruction = clusters.size();
+    }
+    cluster_indices.emplace_back(i);
+    clusters.emplace_back(cluster);
+  }
+  if (clusters.empty()) {
+    return 0;
+  }
+
+  alignment_options.num_threads = options_.num_threads;
+  alignment_options.min_num_correspondences = kMinNumAlignmentCorrespondences;
+  alignment_options.relative_error_threshold =
+      options_.hierarchical_alignment_relative_error_threshold;
+  MultipleReconstructionAlignmentSummary alignment_summary;
+  AlignMultipleReconstructions(alignment_options, clusters, &alignment_summary);
+  for (int i = 0; i < clusters.size(); i++) {
+    if (!alignment_summary.aligned[i]) {
+      LOG(WARNING) << "Cluster " << cluster_indices[i]
+                   << " does not share enough views with the other clusters "
+                      "and could not be merged.";
+      cluster_reconstructions_[cluster_indices[i]].reset();
+    }
+  }
+
+  // The poses of the merged views. A view shared by several clusters takes
+  // its pose from the first merged cluster that estimates it.
+  Reconstruction merged_cameras;
+  std::unordered_set<CameraIntrinsicsGroupId> merged_intrinsics_groups;
+  int num_merged_clusters = 0;
+  while (true) {
+    // The largest cluster is merged first. Afterwards, the cluster sharing the
+    // most estimated views with the merged clusters is added.
+    int best_cluster = -1;
+    int best_num_views = -1;
+    for (int i = 0; i < cluster_reconstructions_.size(); i++) {
+      if (cluster_reconstructions_[i] == nullptr) {
+        continue;
+      }
+      int num_views = cluster_reconstructions_[i]->NumViews();
+      if (num_merged_clusters > 0) {
+        num_views = 0;
+        const Reconstruction& cluster = *cluster_reconstructions_[i];
+        for (const ViewId view_id : cluster.ViewIds()) {
+          if (merged_cameras.ViewIdFromName(cluster.View(view_id)->Name()) !=
+              kInvalidViewId) {
+            ++num_views;
+          }
+        }
+      }
+      if (num_views > best_num_views) {
+        best_cluster = i;
+        best_num_views = num_views;
+      }
+    }
+    if (best_cluster == -1) {
+      break;
+    }
+
+    const Reconstruction& cluster = *cluster_reconstructions_[best_cluster];
+    const int num_copied_views = CopyClusterEstimates(
+        cluster, &merged_intrinsics_groups, &merged_cameras, reconstruction_);
+    LOG(INFO) << "Merged cluster " << best_cluster << " sharing "
+              << cluster.NumViews() - num_copied_views
+              << " views with the previous clusters and adding "
+              << num_copied_views << " views.";
+    cluster_reconstructions_[best_cluster].reset();
+    ++num_merged_clusters;
+  }
+  return num_merged_clusters;
+}
+
+void HierarchicalReconstructionEstimator::EstimateStructure() {
+  THEIA_TRACE_SCOPE("HierarchicalReconstructionEstimator::EstimateStructure");
+  // Estimate all tracks that are not estimated yet.
+  TrackEstimator::Options triangulation_options;
+  triangulation_options.max_acceptable_reprojection_error_pixels =
+      options_.triangulation_max_reprojection_error_in_pixels;
+  triangulation_options.min_triangulation_angle_degrees =
+      options_.min_triangulation_angle_degrees;
+  triangulation_options.bundle_adjustment = options_.bundle_adjust_tracks;
+  triangulation_options.ba_options = SetBundleAdjustmentOptions(options_, 0);
+  triangulation_options.ba_options.num_threads = 1;
+  triangulation_options.ba_options.verbose = false;
+  triangulation_options.num_threads = options_.num_threads;
+  triangulation_options.triangulation_method = options_.triangulation_method;
+  TrackEstimator track_estimator(triangulation_options, reconstruction_);
+  track_estimator.EstimateAllTracks();
+}
+
+bool HierarchicalReconstructionEstimator::BundleAdjustment() {
+  THEIA_TRACE_SCOPE("HierarchicalReconstructionEstimator::BundleAdjustment");
+  std::unordered_set<ViewId> views_to_optimize;
+  GetEstimatedViewsFromReconstruction(*reconstruction_, &views_to_optimize);
+  const BundleAdjustmentOptions bundle_adjustment_options =
+      SetBundleAdjustmentOptions(options_, views_to_optimize.size());
+
+  // If desired, select good tracks to optimize for BA. This dramatically
+  // reduces the number of parameters in bundle adjustment, and does a decent
+  // job of filtering tracks with outliers that may slow down the nonlinear
+  // optimization.
+  std::unordered_set<TrackId> tracks_to_optimize;
+  if (options_.subsample_tracks_for_bundle_adjustment &&
+      SelectGoodTracksForBundleAdjustment(
+          *reconstruction_,
+          options_.track_subset_selection_long_track_length_threshold,
+          options_.track_selection_image_grid_cell_size_pixels,
+          options_.min_num_optimized_tracks_per_view,
+          options_.num_threads,
+          &tracks_to_optimize)) {
+    // Set all tracks that were not chosen for BA to be unestimated so that they
+    // do not affect the bundle adjustment optimization.
+    const auto& view_ids = reconstruction_->ViewIds();
+    SetTracksInViewsToUnestimated(
+        view_ids, tracks_to_optimize, reconstruction_);
+  } else {
+    GetEstimatedTracksFromReconstruction(*reconstruction_, &tracks_to_optimize);
+  }
+  LOG(INFO) << "Selected " << tracks_to_optimize.size()
+            << " tracks to optimize.";
+
+  const auto& bundle_adjustment_summary =
+      BundleAdjustPartialReconstruction(bundle_adjustment_options,
+                                        views_to_optimize,
+                                        tracks_to_optimize,
+                                        reconstruction_);
+  return bundle_adjustment_summary.success;
+}
+
+}  // namespace theia
@@ -0,0 +1,111 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#ifndef THEIA_SFM_HIERARCHICAL_RECONSTRUCTION_ESTIMATOR_H_
+#define THEIA_SFM_HIERARCHICAL_RECONSTRUCTION_ESTIMATOR_H_
+
+#include <memory>
+#include <unordered_set>
+#include <vector>
+
+#include "theia/sfm/reconstruction.h"
+#include "theia/sfm/reconstruction_estimator.h"
+#include "theia/sfm/reconstruction_estimator_options.h"
+#include "theia/sfm/types.h"
+#include "theia/util/util.h"
+
+namespace theia {
+
+class ViewGraph;
+
+// Estimates the camera poses and 3D structure of the scene by dividing the
+// problem into smaller, overlapping subproblems that are solved independently
+// and then merged. This keeps the size of each subproblem bounded, so that
+// large scenes may be reconstructed with the (more accurate) global or
+// incremental methods and the subproblems may be solved in parallel.
+//
+// The hierarchical SfM pipeline is as follows:
+//   1) Calibrate any uncalibrated cameras.
+//   2) Recursively split the view graph with normalized graph cuts until each
+//      cluster has at most hierarchical_max_views_per_cluster views.
+//   3) Grow each pair of adjacent clusters along their strongest cut edges so
+//      that they share hierarchical_num_overlapping_views views.
+//   4) Reconstruct each cluster in parallel with the estimator given by
+//      hierarchical_cluster_estimator_type.
+//   5) Starting from the largest cluster reconstruction, repeatedly align the
+//      cluster sharing the most estimated views with the merged reconstruction
+//      using a robust similarity transformation, and add its views and tracks.
+//   6) Triangulate the tracks that were not estimated by any cluster.
+//   7) Bundle adjust the full reconstruction.
+//
+// If the view graph is small enough to form a single cluster, the cluster
+// estimator is run directly on the full problem.
+class HierarchicalReconstructionEstimator : public ReconstructionEstimator {
+ public:
+  HierarchicalReconstructionEstimator(
+      const ReconstructionEstimatorOptions& options);
+
+  ReconstructionEstimatorSummary Estimate(ViewGraph* view_graph,
+                                          Reconstruction* reconstruction);
+
+ private:
+  // Splits the views of the view graph into disjoint clusters.
+  void PartitionViewGraph();
+  // Adds views across the cuts so that adjacent clusters overlap.
+  void ExpandClusters();
+  // Reconstructs all clusters. Returns the number of successful clusters.
+  int EstimateClusters();
+  // Aligns the cluster reconstructions and copies them into reconstruction_.
+  // Returns the number of clusters that were merged.
+  int MergeClusters();
+  void EstimateStructure();
+  bool BundleAdjustment();
+
+  ViewGraph* view_graph_;
+  Reconstruction* reconstruction_;
+
+  ReconstructionEstimatorOptions options_;
+
+  // The views of each cluster and the estimated part of its reconstruction.
+  // The cluster reconstructions keep the view and track ids of
+  // reconstruction_.
+  std::vector<std::unordered_set<ViewId>> clusters_;
+  std::vector<std::unique_ptr<Reconstruction>> cluster_reconstructions_;
+
+  DISALLOW_COPY_AND_ASSIGN(HierarchicalReconstructionEstimator);
+};
+
+}  // namespace theia
+
+#endif  // THEIA_SFM_HIERARCHICAL_RECONSTRUCTION_ESTIMATOR_H_
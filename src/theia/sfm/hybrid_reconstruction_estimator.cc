@@ -55,6 +55,7 @@
 #include "theia/sfm/global_pose_estimation/robust_rotation_estimator.h"
 #include "theia/sfm/global_pose_estimation/rotation_estimator.h"
 #include "theia/sfm/localize_view_to_reconstruction.h"
+#include "theia/sfm/next_best_view_selector.h"
 #include "theia/sfm/reconstruction.h"
 #include "theia/sfm/reconstruction_estimator.h"
 #include "theia/sfm/reconstruction_estimator_options.h"
@@ -66,16 +67,22 @@
 #include "theia/sfm/types.h"
 #include "theia/sfm/view_graph/orientations_from_maximum_spanning_tree.h"
 #include "theia/sfm/view_graph/view_graph.h"
-#include "theia/sfm/visibility_pyramid.h"
 #include "theia/solvers/sample_consensus_estimator.h"
 #include "theia/util/map_util.h"
 #include "theia/util/stringprintf.h"
+#include "theia/util/threadpool.h"
 #include "theia/util/timer.h"
+#include "theia/util/trace.h"
 #include "theia/util/util.h"
 
 namespace theia {
 namespace {
 
+// Views must observe this many estimated tracks to be localized, and they are
+// ranked by the visibility pyramid with this many levels.
+static const int kMinNumObserved3dPoints = 30;
+static const int kNumPyramidLevels = 6;
+
 void SetReconstructionAsUnestimated(Reconstruction* reconstruction) {
   // Set tracks as unestimated.
   const auto& track_ids = reconstruction->TrackIds();
@@ -133,12 +140,22 @@ HybridReconstructionEstimator::HybridReconstructionEstimator(
   localization_options_.ba_options.verbose = false;
   localization_options_.min_num_inliers =
       options_.min_num_absolute_pose_inliers;
+  localization_options_.pnp_type = options_.absolute_pose_pnp_type;
+  localization_options_.use_gravity_prior =
+      options_.localize_with_gravity_priors;
 
   num_optimized_views_ = 0;
+
+  if (options_.num_threads > 1) {
+    thread_pool_.reset(new ThreadPool(options_.num_threads));
+  }
 }
 
+HybridReconstructionEstimator::~HybridReconstructionEstimator() {}
+
 ReconstructionEstimatorSummary HybridReconstructionEstimator::Estimate(
     ViewGraph* view_graph, Reconstruction* reconstruction) {
+  THEIA_TRACE_SCOPE("HybridReconstructionEstimator::Estimate");
   reconstruction_ = reconstruction;
   view_graph_ = view_graph;
 
@@ -182,6 +199,14 @@ ReconstructionEstimatorSummary HybridReconstructionEstimator::Estimate(
   }
   time_to_find_initial_seed = timer.ElapsedTimeInSeconds();
 
+  // Rank the unlocalized views by the tracks of the initial reconstruction.
+  next_best_view_selector_.reset(
+      new NextBestViewSelector(kNumPyramidLevels, kMinNumObserved3dPoints));
+  next_best_view_selector_->UpdateTracks(*reconstruction_);
+  for (const ViewId view_id : unlocalized_views_) {
+    next_best_view_selector_->AddView(*reconstruction_, view_id);
+  }
+
   // Try to add as many views as possible to the reconstruction until no more
   // views can be localized.
   std::vector<ViewId> views_to_localize;
@@ -195,70 +220,50 @@ ReconstructionEstimatorSummary HybridReconstructionEstimator::Estimate(
     // Compute the 2D-3D point count to determine which views should be
     // localized.
     timer.Reset();
-    FindViewsToLocalize(&views_to_localize);
+    int num_best_views_to_localize = 0;
+    FindViewsToLocalize(&views_to_localize, &num_best_views_to_localize);
     summary_.pose_estimation_time += timer.ElapsedTimeInSeconds();
 
     // Attempt to localize all candidate views and estimate new 3D
     // points. Bundle Adjustment is run as either partial or full BA depending
-    // on the current state of the reconstruction.
-    for (int i = 0; i < views_to_localize.size(); i++) {
-      timer.Reset();
-
-      // Localize the view to the reconstruciton. If the orientation was
+    // on the current state of the reconstruction. With multiple threads, the
+    // best candidate views form the first batch and the remaining views are
+    // localized in batches of num_threads views. Since the orientations are
+    // known, the views of a batch are localized independently of each other.
+    int batch_start = 0;
+    while (batch_start < views_to_localize.size()) {
+      const int batch_end =
+          thread_pool_ == nullptr
+              ? batch_start + 1
+              : (batch_start == 0
+                     ? std::max(num_best_views_to_localize, 1)
+                     : std::min(static_cast<int>(views_to_localize.size()),
+                                batch_start + options_.num_threads));
+      const std::vector<ViewId> batch(views_to_localize.begin() + batch_start,
+                                      views_to_localize.begin() + batch_end);
+      batch_start = batch_end;
+
+      // Localize the views to the reconstruction. If the orientation was
       // estimated from the global algorithm, this will first try to use a
       // simplified solver to estimate the camera position assuming the known
       // orientation.
-      if (!LocalizeView(views_to_localize[i])) {
+      timer.Reset();
+      std::vector<ViewId> localized_views;
+      if (thread_pool_ != nullptr) {
+        failed_localization_attempts +=
+            LocalizeViewsInParallel(batch, &localized_views);
+      } else if (LocalizeView(batch[0], localization_options_)) {
+        localized_views.emplace_back(batch[0]);
+      } else {
         ++failed_localization_attempts;
-        continue;
       }
       summary_.pose_estimation_time += timer.ElapsedTimeInSeconds();
-
-      reconstructed_views_.push_back(views_to_localize[i]);
-      unlocalized_views_.erase(views_to_localize[i]);
-
-      // Remove any tracks that have very bad 3D point reprojections after the
-      // new view has been merged. This can happen when a new observation of a
-      // 3D point has a very high reprojection error in the newly localized
-      // view.
-      const auto& tracks_in_new_view_vec =
-          reconstruction_->View(reconstructed_views_.back())->TrackIds();
-      const std::unordered_set<TrackId> tracks_in_new_view(
-          tracks_in_new_view_vec.begin(), tracks_in_new_view_vec.end());
-      RemoveOutlierTracks(
-          tracks_in_new_view,
-          triangulation_options_.max_acceptable_reprojection_error_pixels);
-
-      // Step 5: Estimate new 3D points. and Step 6: Bundle adjustment.
-      bool ba_success = false;
-      if (UnoptimizedGrowthPercentage() <
-          options_.full_bundle_adjustment_growth_percent) {
-        // Step 5: Perform triangulation on the most recent view.
-        timer.Reset();
-        EstimateStructure(reconstructed_views_.back());
-        summary_.triangulation_time += timer.ElapsedTimeInSeconds();
-
-        // Step 6: Then perform partial Bundle Adjustment.
-        timer.Reset();
-        ba_success = PartialBundleAdjustment();
-        summary_.bundle_adjustment_time += timer.ElapsedTimeInSeconds();
-      } else {
-        // Step 5: Perform triangulation on all views.
-        timer.Reset();
-        TrackEstimator track_estimator(triangulation_options_, reconstruction_);
-        const TrackEstimator::Summary triangulation_summary =
-            track_estimator.EstimateAllTracks();
-        summary_.triangulation_time += timer.ElapsedTimeInSeconds();
-
-        // Step 6: Full Bundle Adjustment.
-        timer.Reset();
-        ba_success = FullBundleAdjustment();
-        summary_.bundle_adjustment_time += timer.ElapsedTimeInSeconds();
+      if (localized_views.empty()) {
+        continue;
       }
 
-      SetUnderconstrainedAsUnestimated();
-
-      if (!ba_success) {
+      // Steps 5 and 6: Estimate new 3D points and bundle adjust.
+      if (!AddLocalizedViews(localized_views)) {
         LOG(WARNING) << "Bundle adjustment failed!";
         summary_.success = false;
         return summary_;
@@ -282,12 +287,15 @@ ReconstructionEstimatorSummary HybridReconstructionEstimator::Estimate(
   return summary_;
 }
 
-bool HybridReconstructionEstimator::LocalizeView(const ViewId view_id) {
+bool HybridReconstructionEstimator::LocalizeView(
+    const ViewId view_id,
+    LocalizeViewToReconstructionOptions localization_options) {
+  THEIA_TRACE_SCOPE("HybridReconstructionEstimator::LocalizeView");
   if (ContainsKey(orientations_, view_id)) {
-    localization_options_.assume_known_orientation = true;
+    localization_options.assume_known_orientation = true;
     RansacSummary unused_ransac_summary;
     if (LocalizeViewToReconstruction(view_id,
-                                     localization_options_,
+                                     localization_options,
                                      reconstruction_,
                                      &unused_ransac_summary)) {
       return true;
@@ -297,13 +305,140 @@ bool HybridReconstructionEstimator::LocalizeView(const ViewId view_id) {
   // If we reached here, then either the orientation of this view was not
   // computed during global orientation estimation or the localization of
   // only the position failed.
-  localization_options_.assume_known_orientation = false;
+  localization_options.assume_known_orientation = false;
   RansacSummary unused_ransac_summary;
   return LocalizeViewToReconstruction(
-      view_id, localization_options_, reconstruction_, &unused_ransac_summary);
+      view_id, localization_options, reconstruction_, &unused_ransac_summary);
+}
+
+int HybridReconstructionEstimator::LocalizeViewsInParallel(
+    const std::vector<ViewId>& views_to_localize,
+    std::vector<ViewId>* localized_views) {
+  THEIA_TRACE_SCOPE("HybridReconstructionEstimator::LocalizeViewsInParallel");
+  // Localization only modifies the camera of the localized view and reads the
+  // estimated tracks, which are not modified until all views of the batch are
+  // localized. The camera intrinsics are shared by the views of an intrinsics
+  // group though, so views that may modify their intrinsics (when the full pose
+  // is estimated with an unknown focal length) are localized sequentially with
+  // the other views of their group.
+  const bool optimize_intrinsics =
+      localization_options_.bundle_adjust_view &&
+      localization_options_.ba_options.intrinsics_to_optimize !=
+          OptimizeIntrinsicsType::NONE;
+  std::vector<std::vector<int> > tasks;
+  std::unordered_map<CameraIntrinsicsGroupId, int> intrinsics_group_to_task;
+  for (int i = 0; i < views_to_localize.size(); i++) {
+    const View* view = reconstruction_->View(views_to_localize[i]);
+    if (!optimize_intrinsics &&
+        view->CameraIntrinsicsPrior().focal_length.is_set) {
+      tasks.emplace_back(1, i);
+      continue;
+    }
+    const CameraIntrinsicsGroupId intrinsics_group_id =
+        reconstruction_->CameraIntrinsicsGroupIdFromViewId(
+            views_to_localize[i]);
+    const auto task =
+        intrinsics_group_to_task.emplace(intrinsics_group_id, tasks.size());
+    if (task.second) {
+      tasks.emplace_back();
+    }
+    tasks[task.first->second].emplace_back(i);
+  }
+
+  // Each view draws its random numbers from its own stream so that the result
+  // does not depend on the scheduling of the threads.
+  const uint64_t stream_offset =
+      static_cast<uint64_t>(reconstructed_views_.size()) << 32;
+  std::vector<char> is_localized(views_to_localize.size(), false);
+  ParallelFor(thread_pool_.get(),
+              tasks.size(),
+              tasks.size(),
+              [&](const int start, const int end) {
+                for (int t = start; t < end; t++) {
+                  for (const int i : tasks[t]) {
+                    LocalizeViewToReconstructionOptions localization_options =
+                        localization_options_;
+                    localization_options.ba_options.num_threads = 1;
+                    if (localization_options.ransac_params.rng != nullptr) {
+                      localization_options.ransac_params.rng =
+                          localization_options.ransac_params.rng->Split(
+                              stream_offset + views_to_localize[i]);
+                    }
+                    is_localized[i] =
+                        LocalizeView(views_to_localize[i], localization_options);
+                  }
+                }
+              });
+
+  // Commit the localized views in the order of the candidates.
+  int num_failed_localizations = 0;
+  for (int i = 0; i < views_to_localize.size(); i++) {
+    if (is_localized[i]) {
+      localized_views->emplace_back(views_to_localize[i]);
+    } else {
+      ++num_failed_localizations;
+    }
+  }
+  return num_failed_localizations;
+}
+
+bool HybridReconstructionEstimator::AddLocalizedViews(
+    const std::vector<ViewId>& localized_views) {
+  THEIA_TRACE_SCOPE("HybridReconstructionEstimator::AddLocalizedViews");
+  Timer timer;
+  for (const ViewId view_id : localized_views) {
+    reconstructed_views_.push_back(view_id);
+    unlocalized_views_.erase(view_id);
+    next_best_view_selector_->RemoveView(view_id);
+
+    // Remove any tracks that have very bad 3D point reprojections after the
+    // new view has been merged. This can happen when a new observation of a
+    // 3D point has a very high reprojection error in the newly localized
+    // view.
+    const auto& tracks_in_new_view_vec =
+        reconstruction_->View(view_id)->TrackIds();
+    const std::unordered_set<TrackId> tracks_in_new_view(
+        tracks_in_new_view_vec.begin(), tracks_in_new_view_vec.end());
+    RemoveOutlierTracks(
+        tracks_in_new_view,
+        triangulation_options_.max_acceptable_reprojection_error_pixels);
+  }
+
+  // Step 5: Estimate new 3D points. and Step 6: Bundle adjustment.
+  bool ba_success = false;
+  if (UnoptimizedGrowthPercentage() <
+      options_.full_bundle_adjustment_growth_percent) {
+    // Step 5: Perform triangulation on the most recent views.
+    timer.Reset();
+    EstimateStructure(localized_views);
+    summary_.triangulation_time += timer.ElapsedTimeInSeconds();
+
+    // Step 6: Then perform partial Bundle Adjustment.
+    timer.Reset();
+    ba_success = PartialBundleAdjustment();
+    summary_.bundle_adjustment_time += timer.ElapsedTimeInSeconds();
+  } else {
+    // Step 5: Perform triangulation on all views.
+    timer.Reset();
+    TrackEstimator track_estimator(
+        triangulation_options_, reconstruction_, thread_pool_.get());
+    const TrackEstimator::Summary triangulation_summary =
+        track_estimator.EstimateAllTracks();
+    summary_.triangulation_time += timer.ElapsedTimeInSeconds();
+
+    // Step 6: Full Bundle Adjustment.
+    timer.Reset();
+    ba_success = FullBundleAdjustment();
+    summary_.bundle_adjustment_time += timer.ElapsedTimeInSeconds();
+  }
+
+  SetUnderconstrainedAsUnestimated();
+  return ba_success;
 }
 
 bool HybridReconstructionEstimator::EstimateCameraOrientations() {
+  THEIA_TRACE_SCOPE(
+      "HybridReconstructionEstimator::EstimateCameraOrientations");
   // TODO(csweeney): Currently we use all view pairs to estimate the orientation
   // for all possible cameras. This ignores any information about views that are
   // already estimated, which should instead be exposed to improve the
@@ -316,9 +451,11 @@ bool HybridReconstructionEstimator::EstimateCameraOrientations() {
     case GlobalRotationEstimatorType::ROBUST_L1L2: {
       // Initialize the orientation estimations by walking along the maximum
       // spanning tree.
-      CHECK(OrientationsFromMaximumSpanningTree(*view_graph_, &orientations_))
+      CHECK(OrientationsFromMaximumSpanningTree(
+          *view_graph_, options_.num_threads, &orientations_))
           << "Could not estimate orientations from a spanning tree.";
       RobustRotationEstimator::Options robust_rotation_estimator_options;
+      robust_rotation_estimator_options.num_threads = options_.num_threads;
       rotation_estimator.reset(
           new RobustRotationEstimator(robust_rotation_estimator_options));
       break;
@@ -326,7 +463,8 @@ bool HybridReconstructionEstimator::EstimateCameraOrientations() {
     case GlobalRotationEstimatorType::NONLINEAR: {
       // Initialize the orientation estimations by walking along the maximum
       // spanning tree.
-      CHECK(OrientationsFromMaximumSpanningTree(*view_graph_, &orientations_))
+      CHECK(OrientationsFromMaximumSpanningTree(
+          *view_graph_, options_.num_threads, &orientations_))
           << "Could not estimate orientations from a spanning tree.";
       rotation_estimator.reset(new NonlinearRotationEstimator());
       break;
@@ -365,10 +503,6 @@ bool HybridReconstructionEstimator::EstimateCameraOrientations() {
 
 double HybridReconstructionEstimator::ComputeMedianTriangulationAngle(
     const ViewIdPair& view_ids) {
-  const std::vector<ViewId> views = {view_ids.first, view_ids.second};
-  const std::vector<TrackId> common_tracks =
-      FindCommonTracksInViews(*reconstruction_, views);
-
   // Fetch the view and camera objects for this pair.
   const View* view1 = reconstruction_->View(view_ids.first);
   const View* view2 = reconstruction_->View(view_ids.second);
@@ -391,6 +525,10 @@ double HybridReconstructionEstimator::ComputeMedianTriangulationAngle(
   // angle between principal viewing rays as the angular constraint for the view
   // pair. The code for using the median triangulation angle is below.
   //
+  // const std::vector<ViewId> views = {view_ids.first, view_ids.second};
+  // const std::vector<TrackId> common_tracks =
+  //     FindCommonTracksInViews(*reconstruction_, views);
+  //
   // std::vector<double> triangulation_angles;
   // triangulation_angles.reserve(common_tracks.size());
   // // Compute the triangulation angle for each view. We store the cosine of
@@ -470,12 +608,11 @@ bool HybridReconstructionEstimator::InitializeCamerasWithKnownOrientation(
   for (const TrackId track_id : common_tracks) {
     // Retrieve the rotated and normalized correspondences.
     FeatureCorrespondence match;
-    match.feature1 = Feature(
-        camera1.PixelToUnitDepthRay((*view1->GetFeature(track_id)).point_)
-            .hnormalized());
-    match.feature2 = Feature(
-        camera2->PixelToUnitDepthRay((*view2->GetFeature(track_id)).point_)
-            .hnormalized());
+    Eigen::Vector3d bearing_vector1, bearing_vector2;
+    CHECK(view1->GetBearingVector(track_id, &bearing_vector1));
+    CHECK(view2->GetBearingVector(track_id, &bearing_vector2));
+    match.feature1 = Feature(bearing_vector1.hnormalized());
+    match.feature2 = Feature(bearing_vector2.hnormalized());
     rotated_correspondences.emplace_back(match);
   }
 
@@ -518,14 +655,17 @@ bool HybridReconstructionEstimator::InitializeCamerasWithKnownOrientation(
 }
 
 bool HybridReconstructionEstimator::ChooseInitialViewPair() {
+  THEIA_TRACE_SCOPE("HybridReconstructionEstimator::ChooseInitialViewPair");
   static const int kMinNumInitialTracks = 100;
 
-  // Sort the view pairs by the number of geometrically verified matches.
-  std::vector<ViewIdPair> candidate_initial_view_pairs;
+  // Order the view pairs by the initialization criterion. The candidates are
+  // popped from a heap, so the search stops sorting at the first pair that
+  // initializes the reconstruction.
+  InitialViewPairQueue candidate_initial_view_pairs;
   OrderViewPairsByInitializationCriterion(kMinNumInitialTracks,
                                           &candidate_initial_view_pairs);
 
-  if (candidate_initial_view_pairs.size() == 0) {
+  if (candidate_initial_view_pairs.empty()) {
     return false;
   }
 
@@ -533,7 +673,11 @@ bool HybridReconstructionEstimator::ChooseInitialViewPair() {
   // initial seed is only considered valid if the baseline relative to the 3D
   // point depths is sufficient. This robustness is measured by the angle of all
   // 3D points.
-  for (const ViewIdPair view_id_pair : candidate_initial_view_pairs) {
+  while (!candidate_initial_view_pairs.empty()) {
+    const ViewIdPair view_id_pair =
+        std::get<2>(candidate_initial_view_pairs.top());
+    candidate_initial_view_pairs.pop();
+
     // Set all values as unestimated and try to use the next candidate pair.
     SetReconstructionAsUnestimated(reconstruction_);
 
@@ -547,7 +691,7 @@ bool HybridReconstructionEstimator::ChooseInitialViewPair() {
     }
 
     // Estimate 3D structure of the scene.
-    EstimateStructure(view_id_pair.first);
+    EstimateStructure({view_id_pair.first});
 
     // If we did not triangulate enough tracks then skip this view and try
     // another.
@@ -582,114 +726,109 @@ bool HybridReconstructionEstimator::ChooseInitialViewPair() {
 }
 
 void HybridReconstructionEstimator::OrderViewPairsByInitializationCriterion(
-    const int min_num_verified_matches,
-    std::vector<ViewIdPair>* view_id_pairs) {
+    const int min_num_verified_matches, InitialViewPairQueue* view_id_pairs) {
   static const double kMaxTriangulationAngleDegrees = 45;
 
+  // Only the view pairs with enough verified matches can be chosen, so the
+  // other pairs are discarded before their triangulation angle is computed.
+  // TODO(csweeney): Prefer view pairs with known intrinsics.
   const auto& view_pairs = view_graph_->GetAllEdges();
-  view_id_pairs->reserve(view_pairs.size());
-
-  // Choose the initialization criterion based on the estimated triangulation
-  // angle between the views and the number of features matched between the view
-  // pairs.
-  std::vector<std::tuple<int, double, ViewIdPair> >
-      initialization_criterion_for_view_pairs;
-  initialization_criterion_for_view_pairs.reserve(view_pairs.size());
+  std::vector<const std::pair<const ViewIdPair, TwoViewInfo>*> candidates;
+  candidates.reserve(view_pairs.size());
   for (const auto& view_pair : view_pairs) {
-    // Estimate the triangulation angle if the orientations are known. If either
-    // one of the orientations are not known then set the angle to zero. This
-    // will push this view pair to the back of the list of camera
-    // initialization, allowing it to still be used if all pairs with known
-    // orientation fail.
-    double median_triangulation_angle = 0;
-    if (ContainsKey(orientations_, view_pair.first.first) &&
-        ContainsKey(orientations_, view_pair.first.second)) {
-      median_triangulation_angle =
-          ComputeMedianTriangulationAngle(view_pair.first);
-    }
-
-    // Take the scaled sqrt of the triangulation angle and round it to the
-    // nearest integer. This essentially buckets the triangulation angles in a
-    // geometric sequence. We additionally cap the triangulation angle at 45
-    // degrees to prevent favoring view pairs with too wide of a baseline that
-    // do not have sufficiently many matched features. This allows us to choose
-    // the view pair with the most number of features that have a sufficiently
-    // large triangulation angle.
-    const int normalized_triangulation_angle =
-        std::round(2.0 * std::sqrt(std::min(median_triangulation_angle,
-                                            kMaxTriangulationAngleDegrees)));
-
-    // TODO(csweeney): Prefer view pairs with known intrinsics.
     if (view_pair.second.num_verified_matches > min_num_verified_matches) {
-      // Insert negative values so that the largest triangulation angles and
-      // highest number of matches appear at the front.
-      initialization_criterion_for_view_pairs.emplace_back(
-          -normalized_triangulation_angle,
-          -view_pair.second.num_verified_matches,
-          view_pair.first);
+      candidates.emplace_back(&view_pair);
     }
   }
 
-  // Sort the views such that the view pairs with the largest triangulation
+  // Choose the initialization criterion based on the estimated triangulation
+  // angle between the views and the number of features matched between the view
+  // pairs. The view pairs are scored independently of each other.
+  std::vector<InitialViewPairCandidate> initialization_criterion_for_view_pairs(
+      candidates.size());
+  const int num_threads = std::max(options_.num_threads, 1);
+  ParallelFor(
+      thread_pool_.get(),
+      candidates.size(),
+      num_threads,
+      [&](const int start, const int end) {
+        for (int i = start; i < end; i++) {
+          const auto& view_pair = *candidates[i];
+          // Estimate the triangulation angle if the orientations are known.
+          // If either one of the orientations are not known then set the
+          // angle to zero. This will push this view pair to the back of the
+          // list of camera initialization, allowing it to still be used if
+          // all pairs with known orientation fail.
+          double median_triangulation_angle = 0;
+          if (ContainsKey(orientations_, view_pair.first.first) &&
+              ContainsKey(orientations_, view_pair.first.second)) {
+            median_triangulation_angle =
+                ComputeMedianTriangulationAngle(view_pair.first);
+          }
+
+          // Take the scaled sqrt of the triangulation angle and round it to
+          // the nearest integer. This essentially buckets the triangulation
+          // angles in a geometric sequence. We additionally cap the
+          // triangulation angle at 45 degrees to prevent favoring view pairs
+          // with too wide of a baseline that do not have sufficiently many
+          // matched features. This allows us to choose the view pair with the
+          // most number of features that have a sufficiently large
+          // triangulation angle.
+          const int normalized_triangulation_angle = std::round(
+              2.0 * std::sqrt(std::min(median_triangulation_angle,
+                                       kMaxTriangulationAngleDegrees)));
+
+          // Insert negative values so that the largest triangulation angles
+          // and highest number of matches appear at the front.
+          initialization_criterion_for_view_pairs[i] =
+              InitialViewPairCandidate(-normalized_triangulation_angle,
+                                       -view_pair.second.num_verified_matches,
+                                       view_pair.first);
+        }
+      });
+
+  // Order the views such that the view pairs with the largest triangulation
   // angles and the most matched features appear at the front.
-  std::sort(initialization_criterion_for_view_pairs.begin(),
-            initialization_criterion_for_view_pairs.end());
-  for (int i = 0; i < initialization_criterion_for_view_pairs.size(); i++) {
-    view_id_pairs->emplace_back(
-        std::get<2>(initialization_criterion_for_view_pairs[i]));
-  }
+  *view_id_pairs =
+      InitialViewPairQueue(std::greater<InitialViewPairCandidate>(),
+                           std::move(initialization_criterion_for_view_pairs));
 }
 
 void HybridReconstructionEstimator::FindViewsToLocalize(
-    std::vector<ViewId>* views_to_localize) {
-  // We localize all views that observe 75% or more of the best visibility
-  // score.
-  static const int kMinNumObserved3dPoints = 30;
-  static const int kNumPyramidLevels = 6;
-
-  // Determine the number of estimated tracks that each view observes.
-  std::vector<std::pair<int, ViewId> > next_best_view_scores;
-  next_best_view_scores.reserve(unlocalized_views_.size());
-  for (const ViewId view_id : unlocalized_views_) {
-    // Do not consider estimated views since they have already been localized.
-    const View* view = reconstruction_->View(view_id);
-    const Camera& camera = view->Camera();
-
-    // Count the number of estimated tracks for this view.
-    const auto& track_ids = view->TrackIds();
-    VisibilityPyramid pyramid(
-        camera.ImageWidth(), camera.ImageHeight(), kNumPyramidLevels);
-    int num_estimated_tracks = 0;
-    for (const TrackId track_id : track_ids) {
-      if (reconstruction_->Track(track_id)->IsEstimated()) {
-        ++num_estimated_tracks;
-        pyramid.AddPoint((*view->GetFeature(track_id)).point_);
-      }
-    }
-
-    // If enough 3d points are observed then add the visibility score to the
-    // candidate views to localize.
-    if (num_estimated_tracks >= kMinNumObserved3dPoints) {
-      next_best_view_scores.emplace_back(pyramid.ComputeScore(), view_id);
-    }
-  }
-
-  // Sort such that the best score is at the front.
-  std::sort(next_best_view_scores.begin(),
-            next_best_view_scores.end(),
-            std::greater<std::pair<int, ViewId> >());
+    std::vector<ViewId>* views_to_localize, int* num_best_views_to_localize) {
+  // The views are sorted such that the best visibility score is at the front.
+  // Only the views observing tracks whose estimated state changed since the
+  // last round are rescored.
+  next_best_view_selector_->UpdateTracks(*reconstruction_);
+  const std::vector<std::pair<int, ViewId> > next_best_view_scores =
+      next_best_view_selector_->RankedViews();
+
+  *num_best_views_to_localize = 0;
   for (int i = 0; i < next_best_view_scores.size(); i++) {
     views_to_localize->emplace_back(next_best_view_scores[i].second);
+    if (next_best_view_scores[i].first >=
+        options_.multiple_view_localization_ratio *
+            next_best_view_scores[0].first) {
+      ++(*num_best_views_to_localize);
+    }
   }
 }
 
-void HybridReconstructionEstimator::EstimateStructure(const ViewId view_id) {
+void HybridReconstructionEstimator::EstimateStructure(
+    const std::vector<ViewId>& view_ids) {
+  THEIA_TRACE_SCOPE("HybridReconstructionEstimator::EstimateStructure");
+  // Gather the tracks of all views so that tracks seen by several of the new
+  // views are only triangulated once.
+  std::unordered_set<TrackId> tracks_to_triangulate;
+  for (const ViewId view_id : view_ids) {
+    const std::vector<TrackId>& tracks_in_view =
+        reconstruction_->View(view_id)->TrackIds();
+    tracks_to_triangulate.insert(tracks_in_view.begin(), tracks_in_view.end());
+  }
+
   // Estimate all tracks.
-  TrackEstimator track_estimator(triangulation_options_, reconstruction_);
-  const std::vector<TrackId>& tracks_in_view =
-      reconstruction_->View(view_id)->TrackIds();
-  const std::unordered_set<TrackId> tracks_to_triangulate(
-      tracks_in_view.begin(), tracks_in_view.end());
+  TrackEstimator track_estimator(
+      triangulation_options_, reconstruction_, thread_pool_.get());
   const TrackEstimator::Summary summary =
       track_estimator.EstimateTracks(tracks_to_triangulate);
 }
@@ -700,6 +839,7 @@ double HybridReconstructionEstimator::UnoptimizedGrowthPercentage() {
 }
 
 bool HybridReconstructionEstimator::FullBundleAdjustment() {
+  THEIA_TRACE_SCOPE("HybridReconstructionEstimator::FullBundleAdjustment");
   // Full bundle adjustment.
   LOG(INFO) << "Running full bundle adjustment on the entire reconstruction.";
 
@@ -727,6 +867,7 @@ bool HybridReconstructionEstimator::FullBundleAdjustment() {
           options_.track_subset_selection_long_track_length_threshold,
           options_.track_selection_image_grid_cell_size_pixels,
           options_.min_num_optimized_tracks_per_view,
+          options_.num_threads,
           &tracks_to_optimize)) {
     SetTracksInViewsToUnestimated(
         reconstructed_views_, tracks_to_optimize, reconstruction_);
@@ -754,6 +895,7 @@ bool HybridReconstructionEstimator::FullBundleAdjustment() {
 }
 
 bool HybridReconstructionEstimator::PartialBundleAdjustment() {
+  THEIA_TRACE_SCOPE("HybridReconstructionEstimator::PartialBundleAdjustment");
   // Partial bundle adjustment only only the k most recently added views that
   // have not been optimized by full BA.
   const int partial_ba_size =
@@ -796,6 +938,7 @@ bool HybridReconstructionEstimator::PartialBundleAdjustment() {
           options_.track_subset_selection_long_track_length_threshold,
           options_.track_selection_image_grid_cell_size_pixels,
           options_.min_num_optimized_tracks_per_view,
+          options_.num_threads,
           &tracks_to_optimize)) {
     SetTracksInViewsToUnestimated(
         views_to_optimize, tracks_to_optimize, reconstruction_);
@@ -836,6 +979,7 @@ void HybridReconstructionEstimator::RemoveOutlierTracks(
       SetOutlierTracksToUnestimated(tracks_to_check,
                                     max_reprojection_error_in_pixels,
                                     options_.min_triangulation_angle_degrees,
+                                    options_.num_threads,
                                     reconstruction_);
   LOG(INFO) << num_points_removed << " outlier points were removed.";
 }
@@ -858,6 +1002,7 @@ void HybridReconstructionEstimator::SetUnderconstrainedAsUnestimated() {
       if (!reconstruction_->View(view_id)->IsEstimated() &&
           !ContainsKey(unlocalized_views_, view_id)) {
         unlocalized_views_.insert(view_id);
+        next_best_view_selector_->AddView(*reconstruction_, view_id);
 
         // Remove the view from the list of localized views.
         auto view_to_remove = std::find(
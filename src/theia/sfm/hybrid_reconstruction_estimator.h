@@ -35,14 +35,17 @@
 #ifndef THEIA_SFM_HYBRID_RECONSTRUCTION_ESTIMATOR_H_
 #define THEIA_SFM_HYBRID_RECONSTRUCTION_ESTIMATOR_H_
 
+#include <memory>
 #include <unordered_map>
 #include <vector>
 
 #include "theia/sfm/bundle_adjustment/bundle_adjustment.h"
 #include "theia/sfm/estimate_track.h"
 #include "theia/sfm/localize_view_to_reconstruction.h"
+#include "theia/sfm/next_best_view_selector.h"
 #include "theia/sfm/reconstruction_estimator.h"
 #include "theia/sfm/reconstruction_estimator_options.h"
+#include "theia/sfm/reconstruction_estimator_utils.h"
 #include "theia/sfm/types.h"
 #include "theia/solvers/sample_consensus_estimator.h"
 #include "theia/util/util.h"
@@ -50,6 +53,7 @@
 namespace theia {
 
 class Reconstruction;
+class ThreadPool;
 class ViewGraph;
 
 // Estimates the camera position and 3D structure of the scene using an hybrid
@@ -72,6 +76,9 @@ class ViewGraph;
 //   4) Localize a new camera position to the current 3D points. Choose the
 //      camera that observes the most 3D points currently in the scene.
 //   4a) If localizing the position alone fails, try localizing the full pose.
+//   4b) With multiple threads, the candidate views are localized in parallel
+//       batches and the localized views of a batch are added in the order of
+//       their scores.
 //   5) Estimate new 3D structure.
 //   6) Bundle adjustment if the model has grown by more than 5% since the last
 //      bundle adjustment.
@@ -86,6 +93,7 @@ class ViewGraph;
 class HybridReconstructionEstimator : public ReconstructionEstimator {
  public:
   HybridReconstructionEstimator(const ReconstructionEstimatorOptions& options);
+  ~HybridReconstructionEstimator();
 
   // Estimates the camera parameters and 3D points from the view graph and
   // tracks. The reconstruction may or may not contain estimated views and
@@ -96,8 +104,10 @@ class HybridReconstructionEstimator : public ReconstructionEstimator {
  private:
   // Localize the view. If the camera orientation is known then first try to
   // estimate the position assuming the known rotation. If that fails, or the
-  // orientation is not known use standard localization.
-  bool LocalizeView(const ViewId view_id);
+  // orientation is not known use standard localization. The localization
+  // options are copied so that views can be localized concurrently.
+  bool LocalizeView(const ViewId view_id,
+                    LocalizeViewToReconstructionOptions localization_options);
 
   // Estimate the camera orientations from the relative rotations using a global
   // rotation estimation algorithm.
@@ -114,9 +124,11 @@ class HybridReconstructionEstimator : public ReconstructionEstimator {
   // ad-hoc metric for this weight:
   //
   //   Score = median triangulation angle * 0.2 * sqrt(
+  //
+  // Only the view pairs with more than min_num_verified_matches are scored,
+  // in parallel, and they are returned in a heap to be popped in order.
   void OrderViewPairsByInitializationCriterion(
-      const int min_num_verified_matches,
-      std::vector<ViewIdPair>* view_id_pairs);
+      const int min_num_verified_matches, InitialViewPairQueue* view_id_pairs);
 
   // Compute the median triangulation angle of the features between the two
   // views. This assumes that the camera orientation has been set for both
@@ -133,10 +145,10 @@ class HybridReconstructionEstimator : public ReconstructionEstimator {
   // utilizes the known orientation to simplify the problem.
   bool InitializeCamerasWithKnownOrientation(const ViewIdPair& view_ids);
 
-  // Estimates all possible 3D points in the view. This is useful during
+  // Estimates all possible 3D points in the views. This is useful during
   // incremental SfM because we only need to triangulate points that were added
   // with new views.
-  void EstimateStructure(const ViewId view_id);
+  void EstimateStructure(const std::vector<ViewId>& view_ids);
 
   // The current percentage of cameras that have not been optimized by full BA.
   double UnoptimizedGrowthPercentage();
@@ -150,8 +162,22 @@ class HybridReconstructionEstimator : public ReconstructionEstimator {
 
   // Chooses the next cameras to be localized according to which camera observes
   // the highest number of 3D points in the scene. This view is then localized
-  // to using the calibrated or uncalibrated absolute pose algorithm.
-  void FindViewsToLocalize(std::vector<ViewId>* views_to_localize);
+  // to using the calibrated or uncalibrated absolute pose algorithm. The views
+  // are sorted by their score and the first num_best_views_to_localize views
+  // have at least multiple_view_localization_ratio times the best score.
+  void FindViewsToLocalize(std::vector<ViewId>* views_to_localize,
+                           int* num_best_views_to_localize);
+
+  // Localizes all views of the batch in parallel against the current
+  // reconstruction. The localized views are returned in the order of the
+  // batch, and the number of failed localizations is returned.
+  int LocalizeViewsInParallel(const std::vector<ViewId>& views_to_localize,
+                              std::vector<ViewId>* localized_views);
+
+  // Adds the localized views to the reconstruction, estimates the new 3D points
+  // observed by them and runs partial or full bundle adjustment. Returns false
+  // if bundle adjustment failed.
+  bool AddLocalizedViews(const std::vector<ViewId>& localized_views);
 
   // Remove any features that have too high of reprojection errors or are not
   // well-constrained. Only the input features are checked for outliers.
@@ -190,6 +216,13 @@ class HybridReconstructionEstimator : public ReconstructionEstimator {
   // Indicates the number of views that have been optimized with full BA.
   int num_optimized_views_;
 
+  // Maintains the visibility scores of the unlocalized views as tracks are
+  // estimated so that they are not recomputed for every new view.
+  std::unique_ptr<NextBestViewSelector> next_best_view_selector_;
+
+  // Used to localize views and estimate tracks in parallel if num_threads > 1.
+  std::unique_ptr<ThreadPool> thread_pool_;
+
   DISALLOW_COPY_AND_ASSIGN(HybridReconstructionEstimator);
 };
 
@@ -160,6 +160,16 @@ TEST(HybridReconstructionEstimator, BasicTest) {
   BuildAndVerifyReconstruction(kPositionToleranceMeters, options);
 }
 
+TEST(HybridReconstructionEstimator, MultipleThreads) {
+  static const double kPositionToleranceMeters = 1e-2;
+
+  ReconstructionEstimatorOptions options;
+  options.reconstruction_estimator_type = ReconstructionEstimatorType::HYBRID;
+  options.intrinsics_to_optimize = OptimizeIntrinsicsType::NONE;
+  options.num_threads = 4;
+  BuildAndVerifyReconstruction(kPositionToleranceMeters, options);
+}
+
 TEST(HybridReconstructionEstimator, RobustCostFunction) {
   static const double kPositionToleranceMeters = 1e-2;
 
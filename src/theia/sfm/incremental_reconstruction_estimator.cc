@@ -34,23 +34,30 @@
 
 #include "theia/sfm/incremental_reconstruction_estimator.h"
 
+#include <Eigen/Core>
 #include <ceres/rotation.h>
 #include <glog/logging.h>
 
 #include <algorithm>
 #include <functional>
+#include <memory>
 #include <sstream>  // NOLINT
 #include <tuple>
 #include <unordered_map>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 
 #include "theia/matching/feature_correspondence.h"
 #include "theia/math/util.h"
 #include "theia/sfm/bundle_adjustment/bundle_adjustment.h"
+#include "theia/sfm/bundle_adjustment/incremental_bundle_adjuster.h"
+#include "theia/sfm/camera_rig.h"
+#include "theia/sfm/covisibility_graph.h"
 #include "theia/sfm/create_and_initialize_ransac_variant.h"
 #include "theia/sfm/find_common_tracks_in_views.h"
 #include "theia/sfm/localize_view_to_reconstruction.h"
+#include "theia/sfm/next_best_view_selector.h"
 #include "theia/sfm/reconstruction.h"
 #include "theia/sfm/reconstruction_estimator.h"
 #include "theia/sfm/reconstruction_estimator_options.h"
@@ -58,19 +65,26 @@
 #include "theia/sfm/select_good_tracks_for_bundle_adjustment.h"
 #include "theia/sfm/set_camera_intrinsics_from_priors.h"
 #include "theia/sfm/set_outlier_tracks_to_unestimated.h"
+#include "theia/sfm/transformation/transform_reconstruction.h"
 #include "theia/sfm/twoview_info.h"
 #include "theia/sfm/types.h"
 #include "theia/sfm/view_graph/view_graph.h"
-#include "theia/sfm/visibility_pyramid.h"
 #include "theia/solvers/sample_consensus_estimator.h"
 #include "theia/util/map_util.h"
 #include "theia/util/stringprintf.h"
+#include "theia/util/threadpool.h"
 #include "theia/util/timer.h"
+#include "theia/util/trace.h"
 #include "theia/util/util.h"
 
 namespace theia {
 namespace {
 
+// Views must observe this many estimated tracks to be localized, and they are
+// ranked by the visibility pyramid with this many levels.
+static const int kMinNumObserved3dPoints = 30;
+static const int kNumPyramidLevels = 6;
+
 void SetReconstructionAsUnestimated(Reconstruction* reconstruction) {
   // Set tracks as unestimated.
   const auto& track_ids = reconstruction->TrackIds();
@@ -91,6 +105,37 @@ void SetReconstructionAsUnestimated(Reconstruction* reconstruction) {
   }
 }
 
+// Returns the mean reprojection error of all observations of the estimated
+// tracks in estimated views. Points behind a camera are ignored.
+double MeanReprojectionError(const Reconstruction& reconstruction,
+                             const std::unordered_set<TrackId>& track_ids) {
+  double sum_reprojection_error = 0;
+  int num_observations = 0;
+  for (const TrackId track_id : track_ids) {
+    const Track* track = reconstruction.Track(track_id);
+    if (track == nullptr || !track->IsEstimated()) {
+      continue;
+    }
+
+    for (const ViewId view_id : track->ViewIds()) {
+      const View* view = reconstruction.View(view_id);
+      if (view == nullptr || !view->IsEstimated()) {
+        continue;
+      }
+      const Feature* feature = view->GetFeature(track_id);
+      Eigen::Vector2d reprojection;
+      if (feature == nullptr ||
+          view->Camera().ProjectPoint(track->Point(), &reprojection) < 0) {
+        continue;
+      }
+      sum_reprojection_error += (feature->point_ - reprojection).norm();
+      ++num_observations;
+    }
+  }
+  return num_observations == 0 ? 0.0
+                               : sum_reprojection_error / num_observations;
+}
+
 }  // namespace
 
 IncrementalReconstructionEstimator::IncrementalReconstructionEstimator(
@@ -103,6 +148,8 @@ IncrementalReconstructionEstimator::IncrementalReconstructionEstimator(
       << "The bundle adjustment growth percent must be greater than 0 percent.";
   CHECK_GE(options.partial_bundle_adjustment_num_views, 0)
       << "The bundle adjustment growth percent must be greater than 0 percent.";
+  CHECK_GE(options.full_bundle_adjustment_drift_ratio, 0.0)
+      << "The bundle adjustment drift ratio must not be negative.";
 
   options_ = options;
   ransac_params_ = SetRansacParameters(options);
@@ -117,6 +164,7 @@ IncrementalReconstructionEstimator::IncrementalReconstructionEstimator(
   triangulation_options_.ba_options.num_threads = 1;
   triangulation_options_.ba_options.verbose = false;
   triangulation_options_.num_threads = options_.num_threads;
+  triangulation_options_.joint_bundle_adjustment = true;
 
   // Localization options.
   localization_options_.reprojection_error_threshold_pixels =
@@ -127,10 +175,22 @@ IncrementalReconstructionEstimator::IncrementalReconstructionEstimator(
   localization_options_.ba_options.verbose = false;
   localization_options_.min_num_inliers =
       options_.min_num_absolute_pose_inliers;
+  localization_options_.pnp_type = options_.absolute_pose_pnp_type;
+  localization_options_.use_gravity_prior =
+      options_.localize_with_gravity_priors;
 
   num_optimized_views_ = 0;
+  full_ba_reprojection_error_ = 0;
+  use_camera_rigs_ = false;
+  camera_rigs_are_scaled_ = false;
+
+  if (options_.num_threads > 1) {
+    thread_pool_.reset(new ThreadPool(options_.num_threads));
+  }
 }
 
+IncrementalReconstructionEstimator::~IncrementalReconstructionEstimator() {}
+
 // Estimates the camera position and 3D structure of the scene using an
 // incremental Structure from Motion approach. The method begins by first
 // estimating the 3D structure and camera poses of 2 cameras based on their
@@ -147,7 +207,8 @@ IncrementalReconstructionEstimator::IncrementalReconstructionEstimator(
 //      observes the most 3D points currently in the scene.
 //   5) Estimate new 3D structure.
 //   6) Bundle adjustment if the model has grown by more than 5% since the last
-//      bundle adjustment.
+//      bundle adjustment or if partial bundle adjustment of the views most
+//      covisible with the new views indicates that the model has drifted.
 //   7) Repeat steps 4-6 until all cameras have been added.
 //
 // Note that steps 1-3 are skipped if an "initialized" reconstruction (one that
@@ -159,9 +220,15 @@ IncrementalReconstructionEstimator::IncrementalReconstructionEstimator(
 // is very costly) and so incremental SfM is not as efficient or scalable.
 ReconstructionEstimatorSummary IncrementalReconstructionEstimator::Estimate(
     ViewGraph* view_graph, Reconstruction* reconstruction) {
+  THEIA_TRACE_SCOPE("IncrementalReconstructionEstimator::Estimate");
   reconstruction_ = reconstruction;
   view_graph_ = view_graph;
 
+  // Partial and full BA share one problem that is updated between calls. Only
+  // the solver options change with the size of the problem.
+  bundle_adjuster_.reset(new IncrementalBundleAdjuster(
+      SetBundleAdjustmentOptions(options_, 0), reconstruction_));
+
   // Initialize the unlocalized_views_ variable.
   const auto& view_ids = view_graph_->ViewIds();
   unlocalized_views_.reserve(view_ids.size());
@@ -176,6 +243,19 @@ ReconstructionEstimatorSummary IncrementalReconstructionEstimator::Estimate(
   Timer timer;
   double time_to_find_initial_seed = 0;
 
+  // Rigs whose cameras share a single position do not constrain the scale.
+  use_camera_rigs_ =
+      options_.use_camera_rigs && reconstruction_->NumCameraRigs() > 0;
+  camera_rigs_are_scaled_ = true;
+  for (const CameraRigId rig_id : reconstruction_->CameraRigIds()) {
+    const CameraRig* camera_rig = reconstruction_->CameraRig(rig_id);
+    for (int i = 1; i < camera_rig->NumCameras(); i++) {
+      if (camera_rig->CameraPosition(i) != camera_rig->CameraPosition(0)) {
+        camera_rigs_are_scaled_ = false;
+      }
+    }
+  }
+
   // Set the known camera intrinsics.
   timer.Reset();
   SetCameraIntrinsicsFromPriors(reconstruction_);
@@ -197,6 +277,22 @@ ReconstructionEstimatorSummary IncrementalReconstructionEstimator::Estimate(
     time_to_find_initial_seed = timer.ElapsedTimeInSeconds();
   }
 
+  // Add the views of the initial reconstruction to the covisibility graph.
+  covisibility_graph_.Clear();
+  for (const ViewId view_id : reconstruction_->ViewIds()) {
+    if (reconstruction_->View(view_id)->IsEstimated()) {
+      covisibility_graph_.AddView(*reconstruction_, view_id);
+    }
+  }
+
+  // Rank the unlocalized views by the tracks of the initial reconstruction.
+  next_best_view_selector_.reset(
+      new NextBestViewSelector(kNumPyramidLevels, kMinNumObserved3dPoints));
+  next_best_view_selector_->UpdateTracks(*reconstruction_);
+  for (const ViewId view_id : unlocalized_views_) {
+    next_best_view_selector_->AddView(*reconstruction_, view_id);
+  }
+
   // Try to add as many views as possible to the reconstruction until no more
   // views can be localized.
   std::vector<ViewId> views_to_localize;
@@ -210,77 +306,45 @@ ReconstructionEstimatorSummary IncrementalReconstructionEstimator::Estimate(
     // Compute the 2D-3D point count to determine which views should be
     // localized.
     timer.Reset();
-    FindViewsToLocalize(&views_to_localize);
+    int num_best_views_to_localize = 0;
+    FindViewsToLocalize(&views_to_localize, &num_best_views_to_localize);
     summary_.pose_estimation_time += timer.ElapsedTimeInSeconds();
 
-    // Attempt to localize all candidate views and estimate new 3D
-    // points. Bundle Adjustment is run as either partial or full BA depending
-    // on the current state of the reconstruction.
-    for (int i = 0; i < views_to_localize.size(); i++) {
-      timer.Reset();
-      RansacSummary unused_ransac_summary;
-      if (!LocalizeViewToReconstruction(views_to_localize[i],
-                                        localization_options_,
-                                        reconstruction_,
-                                        &unused_ransac_summary)) {
+    // Attempt to localize the candidate views in order until one succeeds.
+    // With multiple threads, the best candidate views are localized at once
+    // and all views that were localized are added to the reconstruction.
+    std::vector<ViewId> localized_views;
+    timer.Reset();
+    if (thread_pool_ != nullptr) {
+      failed_localization_attempts = LocalizeViewsInParallel(
+          views_to_localize, num_best_views_to_localize, &localized_views);
+    } else {
+      for (int i = 0; i < views_to_localize.size(); i++) {
+        RansacSummary unused_ransac_summary;
+        if (LocalizeViewToReconstruction(views_to_localize[i],
+                                         localization_options_,
+                                         reconstruction_,
+                                         &unused_ransac_summary)) {
+          localized_views.emplace_back(views_to_localize[i]);
+          break;
+        }
         ++failed_localization_attempts;
-        continue;
-      }
-      summary_.pose_estimation_time += timer.ElapsedTimeInSeconds();
-
-      reconstructed_views_.push_back(views_to_localize[i]);
-      unlocalized_views_.erase(views_to_localize[i]);
-
-      // Remove any tracks that have very bad 3D point reprojections after the
-      // new view has been merged. This can happen when a new observation of a
-      // 3D point has a very high reprojection error in the newly localized
-      // view.
-      const auto& tracks_in_new_view_vec =
-          reconstruction_->View(reconstructed_views_.back())->TrackIds();
-      const std::unordered_set<TrackId> tracks_in_new_view(
-          tracks_in_new_view_vec.begin(), tracks_in_new_view_vec.end());
-      RemoveOutlierTracks(
-          tracks_in_new_view,
-          triangulation_options_.max_acceptable_reprojection_error_pixels);
-
-      // Step 5: Estimate new 3D points. and Step 6: Bundle adjustment.
-      bool ba_success = false;
-      if (UnoptimizedGrowthPercentage() <
-          options_.full_bundle_adjustment_growth_percent) {
-        // Step 5: Perform triangulation on the most recent view.
-        timer.Reset();
-        EstimateStructure(reconstructed_views_.back());
-        summary_.triangulation_time += timer.ElapsedTimeInSeconds();
-
-        // Step 6: Then perform partial Bundle Adjustment.
-        timer.Reset();
-        ba_success = PartialBundleAdjustment();
-        summary_.bundle_adjustment_time += timer.ElapsedTimeInSeconds();
-      } else {
-        // Step 5: Perform triangulation on all views.
-        timer.Reset();
-        TrackEstimator track_estimator(triangulation_options_, reconstruction_);
-        const TrackEstimator::Summary triangulation_summary =
-            track_estimator.EstimateAllTracks();
-        summary_.triangulation_time += timer.ElapsedTimeInSeconds();
-
-        // Step 6: Full Bundle Adjustment.
-        timer.Reset();
-        ba_success = FullBundleAdjustment();
-        summary_.bundle_adjustment_time += timer.ElapsedTimeInSeconds();
-      }
-
-      SetUnderconstrainedAsUnestimated();
-
-      if (!ba_success) {
-        LOG(WARNING) << "Bundle adjustment failed!";
-        summary_.success = false;
-        return summary_;
       }
+    }
+    summary_.pose_estimation_time += timer.ElapsedTimeInSeconds();
+    if (localized_views.empty()) {
+      continue;
+    }
+    if (use_camera_rigs_) {
+      LocalizeCameraRigFrames(&localized_views);
+    }
 
-      // Force exiting the loop so that the next best view scores are
-      // recomputed.
-      break;
+    // Steps 5 and 6: Estimate new 3D points and bundle adjust. The view scores
+    // are recomputed in the next iteration.
+    if (!AddLocalizedViews(localized_views)) {
+      LOG(WARNING) << "Bundle adjustment failed!";
+      summary_.success = false;
+      return summary_;
     }
   }
 
@@ -321,14 +385,18 @@ void IncrementalReconstructionEstimator::InitializeCamerasFromTwoViewInfo(
 }
 
 bool IncrementalReconstructionEstimator::ChooseInitialViewPair() {
+  THEIA_TRACE_SCOPE(
+      "IncrementalReconstructionEstimator::ChooseInitialViewPair");
   static const int kMinNumInitialTracks = 100;
 
-  // Sort the view pairs by the number of geometrically verified matches.
-  std::vector<ViewIdPair> candidate_initial_view_pairs;
+  // Order the view pairs by the initialization criterion. The candidates are
+  // popped from a heap, so the search stops sorting at the first pair that
+  // initializes the reconstruction.
+  InitialViewPairQueue candidate_initial_view_pairs;
   OrderViewPairsByInitializationCriterion(kMinNumInitialTracks,
                                           &candidate_initial_view_pairs);
 
-  if (candidate_initial_view_pairs.size() == 0) {
+  if (candidate_initial_view_pairs.empty()) {
     return false;
   }
 
@@ -336,7 +404,11 @@ bool IncrementalReconstructionEstimator::ChooseInitialViewPair() {
   // initial seed is only considered valid if the baseline relative to the 3D
   // point depths is sufficient. This robustness is measured by the angle of all
   // 3D points.
-  for (const ViewIdPair view_id_pair : candidate_initial_view_pairs) {
+  while (!candidate_initial_view_pairs.empty()) {
+    const ViewIdPair view_id_pair =
+        std::get<2>(candidate_initial_view_pairs.top());
+    candidate_initial_view_pairs.pop();
+
     // Set all values as unestimated and try to use the next candidate pair.
     SetReconstructionAsUnestimated(reconstruction_);
 
@@ -345,7 +417,7 @@ bool IncrementalReconstructionEstimator::ChooseInitialViewPair() {
     InitializeCamerasFromTwoViewInfo(view_id_pair);
 
     // Estimate 3D structure of the scene.
-    EstimateStructure(view_id_pair.first);
+    EstimateStructure({view_id_pair.first});
 
     // If we did not triangulate enough tracks then skip this view and try
     // another.
@@ -382,9 +454,8 @@ bool IncrementalReconstructionEstimator::ChooseInitialViewPair() {
 void IncrementalReconstructionEstimator::
     OrderViewPairsByInitializationCriterion(
         const int min_num_verified_matches,
-        std::vector<ViewIdPair>* view_id_pairs) {
+        InitialViewPairQueue* view_id_pairs) {
   const auto& view_pairs = view_graph_->GetAllEdges();
-  view_id_pairs->reserve(view_pairs.size());
 
   // Collect the number of inliers for each view pair. The tuples store:
   //     # homography inliers, negative of essential matrix inliers, ViewIdPair
@@ -394,8 +465,7 @@ void IncrementalReconstructionEstimator::
   // essential matrix inliers. This situation only arises if there were a
   // tiebreaker in the number of homography inliers, or if (for some unknown
   // reason) the number of homography inliers is set to 0 for all view pairs.
-  std::vector<std::tuple<int, int, ViewIdPair> >
-      initialization_criterion_for_view_pairs;
+  std::vector<InitialViewPairCandidate> initialization_criterion_for_view_pairs;
   initialization_criterion_for_view_pairs.reserve(view_pairs.size());
   for (const auto& view_pair : view_pairs) {
     // TODO(cmsweeney): Prefer view pairs with known intrinsics.
@@ -407,67 +477,271 @@ void IncrementalReconstructionEstimator::
     }
   }
 
-  // Sort the views to find the ones that are least well-modelled by a
+  // Order the views to find the ones that are least well-modelled by a
   // homography.
-  std::sort(initialization_criterion_for_view_pairs.begin(),
-            initialization_criterion_for_view_pairs.end());
-  for (int i = 0; i < initialization_criterion_for_view_pairs.size(); i++) {
-    view_id_pairs->emplace_back(
-        std::get<2>(initialization_criterion_for_view_pairs[i]));
+  *view_id_pairs =
+      InitialViewPairQueue(std::greater<InitialViewPairCandidate>(),
+                           std::move(initialization_criterion_for_view_pairs));
+}
+
+int IncrementalReconstructionEstimator::LocalizeViewsInParallel(
+    const std::vector<ViewId>& views_to_localize,
+    const int num_best_views_to_localize,
+    std::vector<ViewId>* localized_views) {
+  THEIA_TRACE_SCOPE(
+      "IncrementalReconstructionEstimator::LocalizeViewsInParallel");
+  // The first batch holds the best views to localize. If none of them can be
+  // localized, the remaining views are tried in batches of num_threads views.
+  int num_failed_localizations = 0;
+  int batch_start = 0;
+  while (batch_start < views_to_localize.size() && localized_views->empty()) {
+    const int batch_end =
+        batch_start == 0
+            ? std::max(num_best_views_to_localize, 1)
+            : std::min(static_cast<int>(views_to_localize.size()),
+                       batch_start + options_.num_threads);
+
+    // Localization only modifies the camera of the localized view and reads the
+    // estimated tracks, which are not modified until all views of the batch
+    // are localized. The camera intrinsics are shared by the views of an
+    // intrinsics group though, so views that may modify their intrinsics (when
+    // the focal length is estimated or the intrinsics are bundle adjusted) are
+    // localized sequentially with the other views of their group.
+    const bool optimize_intrinsics =
+        localization_options_.ba_options.intrinsics_to_optimize !=
+        OptimizeIntrinsicsType::NONE;
+    std::vector<std::vector<int> > tasks;
+    std::unordered_map<CameraIntrinsicsGroupId, int> intrinsics_group_to_task;
+    for (int i = batch_start; i < batch_end; i++) {
+      const View* view = reconstruction_->View(views_to_localize[i]);
+      if (!optimize_intrinsics &&
+          view->CameraIntrinsicsPrior().focal_length.is_set) {
+        tasks.emplace_back(1, i);
+        continue;
+      }
+      const CameraIntrinsicsGroupId intrinsics_group_id =
+          reconstruction_->CameraIntrinsicsGroupIdFromViewId(
+              views_to_localize[i]);
+      const auto task = intrinsics_group_to_task.emplace(intrinsics_group_id,
+                                                         tasks.size());
+      if (task.second) {
+        tasks.emplace_back();
+      }
+      tasks[task.first->second].emplace_back(i);
+    }
+
+    // Each view draws its random numbers from its own stream so that the
+    // result does not depend on the scheduling of the threads.
+    const uint64_t stream_offset = static_cast<uint64_t>(
+                                       reconstructed_views_.size())
+                                   << 32;
+    std::vector<char> is_localized(views_to_localize.size(), false);
+    ParallelFor(
+        thread_pool_.get(),
+        tasks.size(),
+        tasks.size(),
+        [&](const int start, const int end) {
+          for (int t = start; t < end; t++) {
+            for (const int i : tasks[t]) {
+              LocalizeViewToReconstructionOptions localization_options =
+                  localization_options_;
+              localization_options.ba_options.num_threads = 1;
+              if (localization_options.ransac_params.rng != nullptr) {
+                localization_options.ransac_params.rng =
+                    localization_options.ransac_params.rng->Split(
+                        stream_offset + views_to_localize[i]);
+              }
+              RansacSummary unused_ransac_summary;
+              is_localized[i] =
+                  LocalizeViewToReconstruction(views_to_localize[i],
+                                               localization_options,
+                                               reconstruction_,
+                                               &unused_ransac_summary);
+            }
+          }
+        });
+
+    // Commit the localized views in the order of the candidates.
+    for (int i = batch_start; i < batch_end; i++) {
+      if (is_localized[i]) {
+        localized_views->emplace_back(views_to_localize[i]);
+      } else {
+        ++num_failed_localizations;
+      }
+    }
+    batch_start = batch_end;
   }
+  return num_failed_localizations;
 }
 
-void IncrementalReconstructionEstimator::FindViewsToLocalize(
-    std::vector<ViewId>* views_to_localize) {
-  // We localize all views that observe 75% or more of the best visibility
-  // score.
-  static const int kMinNumObserved3dPoints = 30;
-  static const int kNumPyramidLevels = 6;
+void IncrementalReconstructionEstimator::LocalizeCameraRigFrames(
+    std::vector<ViewId>* localized_views) {
+  // The rig extrinsics can only be applied to the reconstruction once it has
+  // the scale of the rigs.
+  double scale = 1.0;
+  if (!camera_rigs_are_scaled_) {
+    if (!EstimateCameraRigScale(*reconstruction_, &scale)) {
+      return;
+    }
+    LOG(INFO) << "Scaling the reconstruction by " << scale
+              << " to the units of the camera rigs.";
+    TransformReconstruction(Eigen::Matrix3d::Identity(),
+                            Eigen::Vector3d::Zero(),
+                            scale,
+                            options_.num_threads,
+                            reconstruction_);
+    // The rig baselines are scaled with the reconstruction, so they are
+    // restored to their calibrated values.
+    for (const CameraRigId rig_id : reconstruction_->CameraRigIds()) {
+      CameraRig* camera_rig = reconstruction_->MutableCameraRig(rig_id);
+      for (int i = 0; i < camera_rig->NumCameras(); i++) {
+        camera_rig->SetCameraPosition(i,
+                                      camera_rig->CameraPosition(i) / scale);
+      }
+    }
+    camera_rigs_are_scaled_ = true;
+  }
 
-  // Determine the number of estimated tracks that each view observes.
-  std::vector<std::pair<int, ViewId> > next_best_view_scores;
-  next_best_view_scores.reserve(unlocalized_views_.size());
-  for (const ViewId view_id : unlocalized_views_) {
-    // Do not consider estimated views since they have already been localized.
-    const View* view = reconstruction_->View(view_id);
-    const Camera& camera = view->Camera();
-
-    // Count the number of estimated tracks for this view.
-    const auto& track_ids = view->TrackIds();
-    VisibilityPyramid pyramid(
-        camera.ImageWidth(), camera.ImageHeight(), kNumPyramidLevels);
-    int num_estimated_tracks = 0;
-    for (const TrackId track_id : track_ids) {
-      if (reconstruction_->Track(track_id)->IsEstimated()) {
-        ++num_estimated_tracks;
-        pyramid.AddPoint((*view->GetFeature(track_id)).point_);
+  const int num_localized_views = localized_views->size();
+  for (int i = 0; i < num_localized_views; i++) {
+    const CameraRigMembership* membership =
+        reconstruction_->CameraRigMembershipFromViewId((*localized_views)[i]);
+    if (membership == nullptr) {
+      continue;
+    }
+    const CameraRig* camera_rig =
+        reconstruction_->CameraRig(membership->rig_id);
+    double rig_extrinsics[Camera::kExtrinsicsSize];
+    camera_rig->RigPoseFromCamera(
+        membership->camera_index,
+        reconstruction_->View((*localized_views)[i])->Camera(),
+        rig_extrinsics);
+
+    // Only views with a focal length prior have usable intrinsics without
+    // being localized.
+    for (const ViewId view_id : reconstruction_->GetViewsInCameraRigFrame(
+             membership->rig_id, membership->frame_id)) {
+      View* view = reconstruction_->MutableView(view_id);
+      if (!ContainsKey(unlocalized_views_, view_id) || view->IsEstimated() ||
+          !view->CameraIntrinsicsPrior().focal_length.is_set) {
+        continue;
       }
+      camera_rig->ComposeCameraPose(
+          reconstruction_->CameraRigMembershipFromViewId(view_id)
+              ->camera_index,
+          rig_extrinsics,
+          view->MutableCamera());
+      view->SetEstimated(true);
+      localized_views->emplace_back(view_id);
     }
+  }
+}
+
+bool IncrementalReconstructionEstimator::AddLocalizedViews(
+    const std::vector<ViewId>& localized_views) {
+  THEIA_TRACE_SCOPE("IncrementalReconstructionEstimator::AddLocalizedViews");
+  Timer timer;
+  for (const ViewId view_id : localized_views) {
+    reconstructed_views_.push_back(view_id);
+    unlocalized_views_.erase(view_id);
+    next_best_view_selector_->RemoveView(view_id);
+    covisibility_graph_.AddView(*reconstruction_, view_id);
+
+    // Remove any tracks that have very bad 3D point reprojections after the
+    // new view has been merged. This can happen when a new observation of a
+    // 3D point has a very high reprojection error in the newly localized
+    // view.
+    const auto& tracks_in_new_view_vec =
+        reconstruction_->View(view_id)->TrackIds();
+    const std::unordered_set<TrackId> tracks_in_new_view(
+        tracks_in_new_view_vec.begin(), tracks_in_new_view_vec.end());
+    RemoveOutlierTracks(
+        tracks_in_new_view,
+        triangulation_options_.max_acceptable_reprojection_error_pixels);
+  }
+
+  // Step 5: Estimate new 3D points. and Step 6: Bundle adjustment.
+  bool ba_success = false;
+  if (UnoptimizedGrowthPercentage() <
+      options_.full_bundle_adjustment_growth_percent) {
+    // Step 5: Perform triangulation on the most recent views.
+    timer.Reset();
+    EstimateStructure(localized_views);
+    summary_.triangulation_time += timer.ElapsedTimeInSeconds();
 
-    // If enough 3d points are observed then add the visibility score to the
-    // candidate views to localize.
-    if (num_estimated_tracks >= kMinNumObserved3dPoints) {
-      next_best_view_scores.emplace_back(pyramid.ComputeScore(), view_id);
+    // Step 6: Then perform partial Bundle Adjustment. If the optimized tracks
+    // fit noticeably worse than the model did after the last full BA, the
+    // local window could not absorb the error and full BA is run as well.
+    timer.Reset();
+    double partial_ba_reprojection_error = 0;
+    ba_success = PartialBundleAdjustment(localized_views,
+                                         &partial_ba_reprojection_error);
+    if (ba_success && options_.full_bundle_adjustment_drift_ratio > 0 &&
+        full_ba_reprojection_error_ > 0 &&
+        partial_ba_reprojection_error >
+            options_.full_bundle_adjustment_drift_ratio *
+                full_ba_reprojection_error_) {
+      LOG(INFO) << "Mean reprojection error after partial BA ("
+                << partial_ba_reprojection_error
+                << " px) exceeds the error after the last full BA ("
+                << full_ba_reprojection_error_ << " px).";
+      ba_success = FullBundleAdjustment();
     }
+    summary_.bundle_adjustment_time += timer.ElapsedTimeInSeconds();
+  } else {
+    // Step 5: Perform triangulation on all views.
+    timer.Reset();
+    TrackEstimator track_estimator(
+        triangulation_options_, reconstruction_, thread_pool_.get());
+    const TrackEstimator::Summary triangulation_summary =
+        track_estimator.EstimateAllTracks();
+    summary_.triangulation_time += timer.ElapsedTimeInSeconds();
+
+    // Step 6: Full Bundle Adjustment.
+    timer.Reset();
+    ba_success = FullBundleAdjustment();
+    summary_.bundle_adjustment_time += timer.ElapsedTimeInSeconds();
   }
 
-  // Sort such that the best score is at the front.
-  std::sort(next_best_view_scores.begin(),
-            next_best_view_scores.end(),
-            std::greater<std::pair<int, ViewId> >());
+  SetUnderconstrainedAsUnestimated();
+  return ba_success;
+}
+
+void IncrementalReconstructionEstimator::FindViewsToLocalize(
+    std::vector<ViewId>* views_to_localize, int* num_best_views_to_localize) {
+  // We localize all views that observe 75% or more of the best visibility
+  // score. Only the views observing tracks whose estimated state changed since
+  // the last round are rescored.
+  next_best_view_selector_->UpdateTracks(*reconstruction_);
+  const std::vector<std::pair<int, ViewId> > next_best_view_scores =
+      next_best_view_selector_->RankedViews();
+
+  *num_best_views_to_localize = 0;
   for (int i = 0; i < next_best_view_scores.size(); i++) {
     views_to_localize->emplace_back(next_best_view_scores[i].second);
+    if (next_best_view_scores[i].first >=
+        options_.multiple_view_localization_ratio *
+            next_best_view_scores[0].first) {
+      ++(*num_best_views_to_localize);
+    }
   }
 }
 
 void IncrementalReconstructionEstimator::EstimateStructure(
-    const ViewId view_id) {
+    const std::vector<ViewId>& view_ids) {
+  THEIA_TRACE_SCOPE("IncrementalReconstructionEstimator::EstimateStructure");
+  // Gather the tracks of all views so that tracks seen by several of the new
+  // views are only triangulated once.
+  std::unordered_set<TrackId> tracks_to_triangulate;
+  for (const ViewId view_id : view_ids) {
+    const std::vector<TrackId>& tracks_in_view =
+        reconstruction_->View(view_id)->TrackIds();
+    tracks_to_triangulate.insert(tracks_in_view.begin(), tracks_in_view.end());
+  }
+
   // Estimate all tracks.
-  TrackEstimator track_estimator(triangulation_options_, reconstruction_);
-  const std::vector<TrackId>& tracks_in_view =
-      reconstruction_->View(view_id)->TrackIds();
-  const std::unordered_set<TrackId> tracks_to_triangulate(
-      tracks_in_view.begin(), tracks_in_view.end());
+  TrackEstimator track_estimator(
+      triangulation_options_, reconstruction_, thread_pool_.get());
   const TrackEstimator::Summary summary =
       track_estimator.EstimateTracks(tracks_to_triangulate);
 }
@@ -478,6 +752,8 @@ double IncrementalReconstructionEstimator::UnoptimizedGrowthPercentage() {
 }
 
 bool IncrementalReconstructionEstimator::FullBundleAdjustment() {
+  THEIA_TRACE_SCOPE(
+      "IncrementalReconstructionEstimator::FullBundleAdjustment");
   // Full bundle adjustment.
   LOG(INFO) << "Running full bundle adjustment on the entire reconstruction.";
 
@@ -501,6 +777,7 @@ bool IncrementalReconstructionEstimator::FullBundleAdjustment() {
           options_.track_subset_selection_long_track_length_threshold,
           options_.track_selection_image_grid_cell_size_pixels,
           options_.min_num_optimized_tracks_per_view,
+          options_.num_threads,
           &tracks_to_optimize)) {
     SetTracksInViewsToUnestimated(
         reconstructed_views_, tracks_to_optimize, reconstruction_);
@@ -513,26 +790,35 @@ bool IncrementalReconstructionEstimator::FullBundleAdjustment() {
   std::unordered_set<ViewId> views_to_optimize;
   GetEstimatedViewsFromReconstruction(*reconstruction_, &views_to_optimize);
   const auto& ba_summary =
-      BundleAdjustPartialReconstruction(bundle_adjustment_options_,
-                                        views_to_optimize,
-                                        tracks_to_optimize,
-                                        reconstruction_);
+      BundleAdjustViewsAndTracks(views_to_optimize, tracks_to_optimize);
   num_optimized_views_ = reconstructed_views_.size();
 
   const auto& track_ids = reconstruction_->TrackIds();
   const std::unordered_set<TrackId> all_tracks(track_ids.begin(),
                                                track_ids.end());
   RemoveOutlierTracks(all_tracks, options_.max_reprojection_error_in_pixels);
+  full_ba_reprojection_error_ =
+      MeanReprojectionError(*reconstruction_, all_tracks);
 
   return ba_summary.success;
 }
 
-bool IncrementalReconstructionEstimator::PartialBundleAdjustment() {
-  // Partial bundle adjustment only only the k most recently added views that
-  // have not been optimized by full BA.
-  const int partial_ba_size =
-      std::min(static_cast<int>(reconstructed_views_.size()),
-               options_.partial_bundle_adjustment_num_views);
+bool IncrementalReconstructionEstimator::PartialBundleAdjustment(
+    const std::vector<ViewId>& new_views, double* mean_reprojection_error) {
+  THEIA_TRACE_SCOPE(
+      "IncrementalReconstructionEstimator::PartialBundleAdjustment");
+  // Partial bundle adjustment optimizes the new views and the views that share
+  // the most tracks with them. Views that observe the optimized tracks but are
+  // not part of this window only contribute residuals and are held constant.
+  const std::vector<ViewId> covisible_views =
+      covisibility_graph_.MostCovisibleViews(
+          new_views,
+          options_.partial_bundle_adjustment_num_views -
+              static_cast<int>(new_views.size()));
+  std::unordered_set<ViewId> views_to_optimize(new_views.begin(),
+                                               new_views.end());
+  views_to_optimize.insert(covisible_views.begin(), covisible_views.end());
+  const int partial_ba_size = views_to_optimize.size();
   LOG(INFO) << "Running partial bundle adjustment on " << partial_ba_size
             << " views.";
 
@@ -550,10 +836,6 @@ bool IncrementalReconstructionEstimator::PartialBundleAdjustment() {
   // model. Otherwise, run partial BA.
   BundleAdjustmentSummary ba_summary;
 
-  // Get the views to optimize for partial BA.
-  std::unordered_set<ViewId> views_to_optimize(
-      reconstructed_views_.end() - partial_ba_size, reconstructed_views_.end());
-
   // If desired, select good tracks to optimize for BA. This dramatically
   // reduces the number of parameters in bundle adjustment, and does a decent
   // job of filtering tracks with outliers that may slow down the nonlinear
@@ -566,6 +848,7 @@ bool IncrementalReconstructionEstimator::PartialBundleAdjustment() {
           options_.track_subset_selection_long_track_length_threshold,
           options_.track_selection_image_grid_cell_size_pixels,
           options_.min_num_optimized_tracks_per_view,
+          options_.num_threads,
           &tracks_to_optimize)) {
     SetTracksInViewsToUnestimated(
         views_to_optimize, tracks_to_optimize, reconstruction_);
@@ -584,16 +867,34 @@ bool IncrementalReconstructionEstimator::PartialBundleAdjustment() {
             << " tracks to optimize.";
 
   // Perform partial BA.
-  ba_summary = BundleAdjustPartialReconstruction(bundle_adjustment_options_,
-                                                 views_to_optimize,
-                                                 tracks_to_optimize,
-                                                 reconstruction_);
+  ba_summary =
+      BundleAdjustViewsAndTracks(views_to_optimize, tracks_to_optimize);
 
   RemoveOutlierTracks(tracks_to_optimize,
                       options_.max_reprojection_error_in_pixels);
+  *mean_reprojection_error =
+      MeanReprojectionError(*reconstruction_, tracks_to_optimize);
   return ba_summary.success;
 }
 
+BundleAdjustmentSummary
+IncrementalReconstructionEstimator::BundleAdjustViewsAndTracks(
+    const std::unordered_set<ViewId>& views_to_optimize,
+    const std::unordered_set<TrackId>& tracks_to_optimize) {
+  // The incremental bundle adjuster does not support camera rigs.
+  if (use_camera_rigs_ && camera_rigs_are_scaled_) {
+    bundle_adjustment_options_.use_camera_rigs = true;
+    bundle_adjustment_options_.optimize_camera_rig_extrinsics =
+        options_.optimize_camera_rig_extrinsics;
+    return BundleAdjustPartialReconstruction(bundle_adjustment_options_,
+                                             views_to_optimize,
+                                             tracks_to_optimize,
+                                             reconstruction_);
+  }
+  bundle_adjuster_->SetSolverOptions(bundle_adjustment_options_);
+  return bundle_adjuster_->Optimize(views_to_optimize, tracks_to_optimize);
+}
+
 void IncrementalReconstructionEstimator::RemoveOutlierTracks(
     const std::unordered_set<TrackId>& tracks_to_check,
     const double max_reprojection_error_in_pixels) {
@@ -603,6 +904,7 @@ void IncrementalReconstructionEstimator::RemoveOutlierTracks(
       SetOutlierTracksToUnestimated(tracks_to_check,
                                     max_reprojection_error_in_pixels,
                                     options_.min_triangulation_angle_degrees,
+                                    options_.num_threads,
                                     reconstruction_);
   LOG(INFO) << num_points_removed << " outlier points were removed.";
 }
@@ -626,11 +928,13 @@ void IncrementalReconstructionEstimator::SetUnderconstrainedAsUnestimated() {
       if (view != nullptr && !view->IsEstimated() &&
           !ContainsKey(unlocalized_views_, view_id)) {
         unlocalized_views_.insert(view_id);
+        next_best_view_selector_->AddView(*reconstruction_, view_id);
 
         // Remove the view from the list of localized views.
         auto view_to_remove = std::find(
             reconstructed_views_.begin(), reconstructed_views_.end(), view_id);
         reconstructed_views_.erase(view_to_remove);
+        covisibility_graph_.RemoveView(view_id);
         --num_optimized_views_;
       }
     }
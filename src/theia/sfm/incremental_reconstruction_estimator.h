@@ -35,21 +35,27 @@
 #ifndef THEIA_SFM_INCREMENTAL_RECONSTRUCTION_ESTIMATOR_H_
 #define THEIA_SFM_INCREMENTAL_RECONSTRUCTION_ESTIMATOR_H_
 
+#include <memory>
 #include <unordered_map>
 #include <vector>
 
 #include "theia/sfm/bundle_adjustment/bundle_adjustment.h"
+#include "theia/sfm/covisibility_graph.h"
 #include "theia/sfm/estimate_track.h"
 #include "theia/sfm/localize_view_to_reconstruction.h"
+#include "theia/sfm/next_best_view_selector.h"
 #include "theia/sfm/reconstruction_estimator.h"
 #include "theia/sfm/reconstruction_estimator_options.h"
+#include "theia/sfm/reconstruction_estimator_utils.h"
 #include "theia/sfm/types.h"
 #include "theia/solvers/sample_consensus_estimator.h"
 #include "theia/util/util.h"
 
 namespace theia {
 
+class IncrementalBundleAdjuster;
 class Reconstruction;
+class ThreadPool;
 class ViewGraph;
 
 // Estimates the camera position and 3D structure of the scene using an
@@ -82,6 +88,7 @@ class IncrementalReconstructionEstimator : public ReconstructionEstimator {
  public:
   IncrementalReconstructionEstimator(
       const ReconstructionEstimatorOptions& options);
+  ~IncrementalReconstructionEstimator();
 
   // Estimates the camera parameters and 3D points from the view graph and
   // tracks. The reconstruction may or may not contain estimated views and
@@ -101,34 +108,69 @@ class IncrementalReconstructionEstimator : public ReconstructionEstimator {
   // well-constrained baseline between cameras is the number of inliers when
   // estimating a homography (more inliers means it is less constrained i.e.,
   // bad). This method chooses the view pairs with more than
-  // min_num_verified_matches that have the fewest homography inliers.
+  // min_num_verified_matches that have the fewest homography inliers. The view
+  // pairs are returned in a heap to be popped in order.
   void OrderViewPairsByInitializationCriterion(
-      const int min_num_verified_matches,
-      std::vector<ViewIdPair>* view_id_pairs);
+      const int min_num_verified_matches, InitialViewPairQueue* view_id_pairs);
 
   // Initialize the views based on the TwoViewInfo of the view pairs and set the
   // views as estimated.
   void InitializeCamerasFromTwoViewInfo(const ViewIdPair& view_ids);
 
-  // Estimates all possible 3D points in the view. This is useful during
+  // Estimates all possible 3D points in the views. This is useful during
   // incremental SfM because we only need to triangulate points that were added
-  // with new views.
-  void EstimateStructure(const ViewId view_id);
+  // with new views. The tracks of all views are triangulated as one batch in
+  // parallel and refined in a single bundle adjustment problem.
+  void EstimateStructure(const std::vector<ViewId>& view_ids);
 
   // The current percentage of cameras that have not been optimized by full BA.
   double UnoptimizedGrowthPercentage();
 
-  // Performs partial bundle adjustment on the model. Only the k most recent
-  // cameras (and the tracks observed in those views) are optimized.
-  bool PartialBundleAdjustment();
+  // Performs partial bundle adjustment on the model. The new views and their
+  // most covisible views (up to partial_bundle_adjustment_num_views in total)
+  // are optimized along with the tracks observed in those views. All other
+  // views observing these tracks are held constant. The mean reprojection error
+  // of the optimized tracks after BA is returned in mean_reprojection_error.
+  bool PartialBundleAdjustment(const std::vector<ViewId>& new_views,
+                               double* mean_reprojection_error);
 
   // Performs full bundle adjustment on the model.
   bool FullBundleAdjustment();
 
   // Chooses the next cameras to be localized according to which camera observes
   // the highest number of 3D points in the scene. This view is then localized
-  // to using the calibrated or uncalibrated absolute pose algorithm.
-  void FindViewsToLocalize(std::vector<ViewId>* views_to_localize);
+  // to using the calibrated or uncalibrated absolute pose algorithm. The views
+  // are sorted by their score and the first num_best_views_to_localize views
+  // have at least multiple_view_localization_ratio times the best score.
+  void FindViewsToLocalize(std::vector<ViewId>* views_to_localize,
+                           int* num_best_views_to_localize);
+
+  // Localizes the best views to localize in parallel. If none of them can be
+  // localized, the remaining views are localized in batches of num_threads
+  // views until a batch localizes at least one view. The localized views are
+  // returned in the order of views_to_localize, and the number of failed
+  // localizations is returned.
+  int LocalizeViewsInParallel(const std::vector<ViewId>& views_to_localize,
+                              const int num_best_views_to_localize,
+                              std::vector<ViewId>* localized_views);
+
+  // Adds the localized views to the reconstruction, estimates the new 3D points
+  // observed by them and runs partial or full bundle adjustment. Returns false
+  // if bundle adjustment failed.
+  bool AddLocalizedViews(const std::vector<ViewId>& localized_views);
+
+  // Bundle adjusts the views and tracks with the incremental bundle adjuster,
+  // or with one pose per rig frame once the camera rigs are in the scale of
+  // the reconstruction.
+  BundleAdjustmentSummary BundleAdjustViewsAndTracks(
+      const std::unordered_set<ViewId>& views_to_optimize,
+      const std::unordered_set<TrackId>& tracks_to_optimize);
+
+  // Scales the reconstruction to the camera rigs if it is not scaled yet and
+  // then sets the poses of the unlocalized views that share a rig frame with
+  // the localized views from the rig extrinsics. The views whose poses are set
+  // are appended to localized_views.
+  void LocalizeCameraRigFrames(std::vector<ViewId>* localized_views);
 
   // Remove any features that have too high of reprojection errors or are not
   // well-constrained. Only the input features are checked for outliers.
@@ -162,6 +204,29 @@ class IncrementalReconstructionEstimator : public ReconstructionEstimator {
   // Indicates the number of views that have been optimized with full BA.
   int num_optimized_views_;
 
+  // Connects the reconstructed views by the number of tracks they share. It is
+  // used to choose the views that are optimized during partial BA.
+  CovisibilityGraph covisibility_graph_;
+
+  // Mean reprojection error of the reconstruction after the last full BA. The
+  // reprojection error after partial BA is compared against it to detect drift.
+  double full_ba_reprojection_error_;
+
+  // Whether the camera rigs are used and whether the reconstruction has been
+  // scaled to the units of the rig extrinsics.
+  bool use_camera_rigs_;
+  bool camera_rigs_are_scaled_;
+
+  // Used to localize multiple views at once if num_threads > 1.
+  std::unique_ptr<ThreadPool> thread_pool_;
+
+  // Keeps the bundle adjustment problem alive between partial and full BA.
+  std::unique_ptr<IncrementalBundleAdjuster> bundle_adjuster_;
+
+  // Maintains the visibility scores of the unlocalized views as tracks are
+  // estimated so that they are not recomputed for every new view.
+  std::unique_ptr<NextBestViewSelector> next_best_view_selector_;
+
   DISALLOW_COPY_AND_ASSIGN(IncrementalReconstructionEstimator);
 };
 
@@ -0,0 +1,470 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#include "theia/sfm/localization_index.h"
+
+#include <Eigen/Core>
+#include <cereal/archives/portable_binary.hpp>
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <fstream>  // NOLINT
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "flann/flann.hpp"
+
+#include "theia/matching/flann_simd_l2.h"
+#include "theia/sfm/bundle_adjustment/bundle_adjustment.h"
+#include "theia/sfm/camera/camera.h"
+#include "theia/sfm/estimators/estimate_absolute_pose_with_known_orientation.h"
+#include "theia/sfm/estimators/estimate_calibrated_absolute_pose.h"
+#include "theia/sfm/estimators/feature_correspondence_2d_3d.h"
+#include "theia/sfm/feature.h"
+#include "theia/sfm/reconstruction.h"
+#include "theia/sfm/reconstruction_estimator_utils.h"
+#include "theia/util/executor.h"
+
+namespace theia {
+namespace {
+
+// Refines the pose of the camera against the inlier 2D-3D matches by bundle
+// adjusting a reconstruction that holds only the query view and the matched
+// points. The points are held constant.
+bool RefinePose(const BundleAdjustmentOptions& ba_options,
+                const std::vector<Eigen::Vector2d>& pixels,
+                const std::vector<Eigen::Vector3d>& points,
+                Camera* camera) {
+  Reconstruction reconstruction;
+  const ViewId view_id = reconstruction.AddView("query", 0, 0);
+  View* view = reconstruction.MutableView(view_id);
+  *view->MutableCamera() = *camera;
+  view->SetEstimated(true);
+  for (int i = 0; i < points.size(); i++) {
+    const TrackId track_id = reconstruction.AddTrack();
+    Track* track = reconstruction.MutableTrack(track_id);
+    track->SetEstimated(true);
+    track->SetPoint(points[i].homogeneous());
+    view->AddFeature(track_id, Feature(pixels[i]));
+  }
+
+  const BundleAdjustmentSummary summary =
+      BundleAdjustView(ba_options, view_id, &reconstruction);
+  if (!summary.success) {
+    return false;
+  }
+
+  const Camera& refined_camera = reconstruction.View(view_id)->Camera();
+  camera->SetOrientationFromRotationMatrix(
+      refined_camera.GetOrientationAsRotationMatrix());
+  camera->SetPosition(refined_camera.GetPosition());
+  return true;
+}
+
+}  // namespace
+
+// The KD-forest over the indexed descriptors. The FLANN index refers to the
+// descriptors of the LocalizationIndex so it must be rebuilt whenever they
+// change.
+struct LocalizationIndex::KdForest {
+  std::unique_ptr<flann::Index<FlannSimdL2> > index;
+};
+
+LocalizationIndex::LocalizationIndex(const LocalizationIndexOptions& options)
+    : options_(options) {
+  CHECK_GT(options_.num_kd_trees, 0);
+  CHECK_GT(options_.num_kd_tree_checks, 0);
+  CHECK_GE(options_.num_candidate_views, 0);
+  CHECK_GT(options_.num_threads, 0);
+}
+
+LocalizationIndex::~LocalizationIndex() {}
+
+bool LocalizationIndex::Build(const Reconstruction& reconstruction) {
+  // Sort the track ids so that the index does not depend on the hash order.
+  std::vector<TrackId> track_ids = reconstruction.TrackIds();
+  std::sort(track_ids.begin(), track_ids.end());
+
+  track_ids_.clear();
+  view_ids_.clear();
+  track_view_offsets_.assign(1, 0);
+  track_views_.clear();
+  int descriptor_dimension = 0;
+  std::unordered_map<ViewId, int> view_indices;
+  for (const TrackId track_id : track_ids) {
+    const Track* track = reconstruction.Track(track_id);
+    if (!track->IsEstimated() || track->ReferenceDescriptor().size() == 0) {
+      continue;
+    }
+    if (descriptor_dimension == 0) {
+      descriptor_dimension = track->ReferenceDescriptor().size();
+    }
+    CHECK_EQ(track->ReferenceDescriptor().size(), descriptor_dimension)
+        << "All reference descriptors must have the same dimension.";
+
+    track_ids_.emplace_back(track_id);
+    for (const ViewId view_id : track->ViewIds()) {
+      const auto it = view_indices.emplace(view_id, view_ids_.size());
+      if (it.second) {
+        view_ids_.emplace_back(view_id);
+      }
+      track_views_.emplace_back(it.first->second);
+    }
+    track_view_offsets_.emplace_back(track_views_.size());
+  }
+
+  points_.resize(3, track_ids_.size());
+  descriptors_.resize(track_ids_.size(), descriptor_dimension);
+  for (int i = 0; i < track_ids_.size(); i++) {
+    const Track* track = reconstruction.Track(track_ids_[i]);
+    points_.col(i) = track->Point().hnormalized();
+    descriptors_.row(i) = track->ReferenceDescriptor().transpose();
+  }
+
+  VLOG(2) << "Indexed " << track_ids_.size() << " of " << track_ids.size()
+          << " tracks observed by " << view_ids_.size() << " views.";
+  if (track_ids_.empty()) {
+    kd_forest_.reset();
+    return false;
+  }
+  BuildKdForest();
+  return true;
+}
+
+void LocalizationIndex::BuildKdForest() {
+  const flann::Matrix<float> flann_descriptors(
+      descriptors_.data(), descriptors_.rows(), descriptors_.cols());
+  kd_forest_.reset(new KdForest);
+  kd_forest_->index.reset(new flann::Index<FlannSimdL2>(
+      flann_descriptors, flann::KDTreeIndexParams(options_.num_kd_trees)));
+  kd_forest_->index->buildIndex();
+}
+
+void LocalizationIndex::FindPutativeMatches(
+    const KeypointsAndDescriptors& features,
+    std::vector<std::pair<int, int> >* matches) const {
+  static const int kNumNearestNeighbors = 2;
+
+  // FLANN does not modify the queries but only takes mutable pointers.
+  DescriptorMatrix dequantized_descriptors;
+  const DescriptorMatrix& query_descriptors =
+      features.FloatDescriptors(&dequantized_descriptors);
+  const int num_queries = query_descriptors.rows();
+
+  // The queries are searched in blocks so that the blocks may be searched in
+  // parallel. Each query keeps the index of its nearest track and the squared
+  // distance to it, or -1 if it fails the ratio test.
+  const float sq_lowes_ratio = options_.lowes_ratio * options_.lowes_ratio;
+  std::vector<int> nearest_tracks(num_queries, -1);
+  std::vector<float> nearest_distances(num_queries);
+  const auto search_queries = [&](const int start, const int end) {
+    const flann::Matrix<float> flann_queries(
+        const_cast<float*>(query_descriptors.row(start).data()),
+        end - start,
+        query_descriptors.cols());
+    std::vector<std::vector<int> > nn_indices;
+    std::vector<std::vector<float> > nn_distances;
+    kd_forest_->index->knnSearch(
+        flann_queries,
+        nn_indices,
+        nn_distances,
+        kNumNearestNeighbors,
+        flann::SearchParams(options_.num_kd_tree_checks));
+    for (int i = 0; i < nn_indices.size(); i++) {
+      if (nn_indices[i].empty() || nn_indices[i][0] < 0) {
+        continue;
+      }
+      // The distances are squared so the ratio is squared as well. A single
+      // indexed track always passes the ratio test.
+      if (nn_indices[i].size() < kNumNearestNeighbors ||
+          nn_indices[i][1] < 0 ||
+          nn_distances[i][0] < sq_lowes_ratio * nn_distances[i][1]) {
+        nearest_tracks[start + i] = nn_indices[i][0];
+        nearest_distances[start + i] = nn_distances[i][0];
+      }
+    }
+  };
+
+  ParallelFor(options_.num_threads, num_queries, search_queries);
+
+  // Each track keeps only its closest feature so that a 3D point is not used
+  // twice by RANSAC.
+  std::vector<std::pair<int, int> > sorted_matches;
+  sorted_matches.reserve(num_queries);
+  for (int i = 0; i < num_queries; i++) {
+    if (nearest_tracks[i] >= 0) {
+      sorted_matches.emplace_back(nearest_tracks[i], i);
+    }
+  }
+  std::sort(sorted_matches.begin(),
+            sorted_matches.end(),
+            [&](const std::pair<int, int>& lhs,
+                const std::pair<int, int>& rhs) {
+              if (lhs.first != rhs.first) {
+                return lhs.first < rhs.first;
+              }
+              return nearest_distances[lhs.second] <
+                     nearest_distances[rhs.second];
+            });
+
+  matches->clear();
+  matches->reserve(sorted_matches.size());
+  for (int i = 0; i < sorted_matches.size(); i++) {
+    if (i > 0 && sorted_matches[i].first == sorted_matches[i - 1].first) {
+      continue;
+    }
+    matches->emplace_back(sorted_matches[i].second, sorted_matches[i].first);
+  }
+}
+
+void LocalizationIndex::FilterMatchesByCovisibility(
+    std::vector<std::pair<int, int> >* matches,
+    std::vector<ViewId>* candidate_view_ids) const {
+  candidate_view_ids->clear();
+  if (options_.num_candidate_views == 0) {
+    return;
+  }
+
+  // Each match votes for the views that observe its track.
+  std::vector<int> votes(view_ids_.size(), 0);
+  for (const auto& match : *matches) {
+    for (int i = track_view_offsets_[match.second];
+         i < track_view_offsets_[match.second + 1];
+         i++) {
+      ++votes[track_views_[i]];
+    }
+  }
+
+  std::vector<int> voted_views;
+  for (int i = 0; i < votes.size(); i++) {
+    if (votes[i] > 0) {
+      voted_views.emplace_back(i);
+    }
+  }
+  const int num_candidate_views =
+      std::min<int>(options_.num_candidate_views, voted_views.size());
+  std::partial_sort(voted_views.begin(),
+                    voted_views.begin() + num_candidate_views,
+                    voted_views.end(),
+                    [&](const int lhs, const int rhs) {
+                      if (votes[lhs] != votes[rhs]) {
+                        return votes[lhs] > votes[rhs];
+                      }
+                      return lhs < rhs;
+                    });
+
+  std::vector<bool> is_candidate_view(view_ids_.size(), false);
+  candidate_view_ids->reserve(num_candidate_views);
+  for (int i = 0; i < num_candidate_views; i++) {
+    is_candidate_view[voted_views[i]] = true;
+    candidate_view_ids->emplace_back(view_ids_[voted_views[i]]);
+  }
+
+  // Keep the matches to tracks that are covisible with a candidate view.
+  const auto is_covisible = [&](const std::pair<int, int>& match) {
+    for (int i = track_view_offsets_[match.second];
+         i < track_view_offsets_[match.second + 1];
+         i++) {
+      if (is_candidate_view[track_views_[i]]) {
+        return true;
+      }
+    }
+    return false;
+  };
+  matches->erase(std::remove_if(matches->begin(),
+                                matches->end(),
+                                [&](const std::pair<int, int>& match) {
+                                  return !is_covisible(match);
+                                }),
+                 matches->end());
+}
+
+bool LocalizationIndex::Localize(const KeypointsAndDescriptors& features,
+                                 Camera* camera,
+                                 LocalizationSummary* summary) const {
+  CHECK_NOTNULL(camera);
+  CHECK_NOTNULL(summary);
+  const LocalizeViewToReconstructionOptions& localization_options =
+      options_.localization_options;
+
+  summary->candidate_view_ids.clear();
+  summary->matches.clear();
+  summary->ransac_summary = RansacSummary();
+  summary->ransac_summary.num_input_data_points = 0;
+  if (kd_forest_ == nullptr || features.NumDescriptors() == 0) {
+    return false;
+  }
+  CHECK_EQ(features.DescriptorDimension(), descriptors_.cols());
+  CHECK_EQ(features.keypoints.size(), features.NumDescriptors());
+
+  std::vector<std::pair<int, int> > matches;
+  FindPutativeMatches(features, &matches);
+  FilterMatchesByCovisibility(&matches, &summary->candidate_view_ids);
+
+  // Exit early if there are not enough putative matches.
+  summary->ransac_summary.num_input_data_points = matches.size();
+  if (matches.size() < localization_options.min_num_inliers) {
+    VLOG(2) << "Not enough 2D-3D correspondences to localize "
+            << features.image_name;
+    return false;
+  }
+
+  std::vector<FeatureCorrespondence2D3D> correspondences(matches.size());
+  summary->matches.reserve(matches.size());
+  for (int i = 0; i < matches.size(); i++) {
+    const Keypoint& keypoint = features.keypoints[matches[i].first];
+    correspondences[i].feature =
+        camera->PixelToNormalizedCoordinates(
+                  Eigen::Vector2d(keypoint.x(), keypoint.y()))
+            .hnormalized();
+    correspondences[i].world_point = points_.col(matches[i].second);
+    summary->matches.emplace_back(matches[i].first,
+                                  track_ids_[matches[i].second]);
+  }
+
+  // The reprojection error threshold is scaled to the image resolution and
+  // normalized by the focal length.
+  RansacParameters ransac_parameters = localization_options.ransac_params;
+  const double threshold_pixels = ComputeResolutionScaledThreshold(
+      localization_options.reprojection_error_threshold_pixels,
+      camera->ImageWidth(),
+      camera->ImageHeight());
+  ransac_parameters.error_thresh = threshold_pixels * threshold_pixels /
+                                   (camera->FocalLength() *
+                                    camera->FocalLength());
+
+  bool success = false;
+  if (localization_options.assume_known_orientation) {
+    Eigen::Vector3d position;
+    success = EstimateAbsolutePoseWithKnownOrientation(
+        ransac_parameters,
+        RansacType::RANSAC,
+        camera->GetOrientationAsAngleAxis(),
+        correspondences,
+        &position,
+        &summary->ransac_summary);
+    if (success) {
+      camera->SetPosition(position);
+    }
+  } else {
+    CalibratedAbsolutePose pose;
+    success = EstimateCalibratedAbsolutePose(ransac_parameters,
+                                             RansacType::RANSAC,
+                                             localization_options.pnp_type,
+                                             correspondences,
+                                             &pose,
+                                             &summary->ransac_summary);
+    if (success) {
+      camera->SetOrientationFromRotationMatrix(pose.rotation);
+      camera->SetPosition(pose.position);
+    }
+  }
+
+  const std::vector<int>& inliers = summary->ransac_summary.inliers;
+  if (!success || inliers.size() < localization_options.min_num_inliers) {
+    VLOG(2) << "Failed to localize " << features.image_name << " with only "
+            << inliers.size() << " out of " << matches.size()
+            << " features as inliers.";
+    return false;
+  }
+
+  // Refine the pose against the inliers if desired.
+  if (localization_options.bundle_adjust_view) {
+    std::vector<Eigen::Vector2d> inlier_pixels(inliers.size());
+    std::vector<Eigen::Vector3d> inlier_points(inliers.size());
+    for (int i = 0; i < inliers.size(); i++) {
+      const Keypoint& keypoint =
+          features.keypoints[matches[inliers[i]].first];
+      inlier_pixels[i] = Eigen::Vector2d(keypoint.x(), keypoint.y());
+      inlier_points[i] = correspondences[inliers[i]].world_point;
+    }
+    success = RefinePose(
+        localization_options.ba_options, inlier_pixels, inlier_points, camera);
+  }
+
+  VLOG(2) << "Localized " << features.image_name << " with " << inliers.size()
+          << " inliers out of " << matches.size() << " 2D-3D matches.";
+  return success;
+}
+
+bool LocalizationIndex::ReadFromDisk(const std::string& input_filepath) {
+  std::ifstream input_reader(input_filepath, std::ios::in | std::ios::binary);
+  if (!input_reader.is_open()) {
+    LOG(ERROR) << "Could not open the file: " << input_filepath
+               << " for reading.";
+    return false;
+  }
+
+  {
+    cereal::PortableBinaryInputArchive input_archive(input_reader);
+    input_archive(*this);
+  }
+
+  if (track_view_offsets_.size() != track_ids_.size() + 1 ||
+      points_.cols() != track_ids_.size() ||
+      descriptors_.rows() != track_ids_.size()) {
+    LOG(ERROR) << "The localization index in " << input_filepath
+               << " is corrupted.";
+    return false;
+  }
+
+  if (track_ids_.empty()) {
+    kd_forest_.reset();
+  } else {
+    BuildKdForest();
+  }
+  return true;
+}
+
+bool LocalizationIndex::WriteToDisk(const std::string& output_filepath) const {
+  std::ofstream output_writer(output_filepath,
+                              std::ios::out | std::ios::binary);
+  if (!output_writer.is_open()) {
+    LOG(ERROR) << "Could not open the file: " << output_filepath
+               << " for writing.";
+    return false;
+  }
+
+  // Make sure that Cereal is able to finish executing before returning.
+  {
+    cereal::PortableBinaryOutputArchive output_archive(output_writer);
+    output_archive(*this);
+  }
+  return true;
+}
+
+}  // namespace theia
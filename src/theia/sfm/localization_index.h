@@ -0,0 +1,188 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#ifndef THEIA_SFM_LOCALIZATION_INDEX_H_
+#define THEIA_SFM_LOCALIZATION_INDEX_H_
+
+#include <Eigen/Core>
+#include <cereal/access.hpp>
+#include <cereal/cereal.hpp>
+#include <cereal/types/vector.hpp>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "theia/io/eigen_serializable.h"
+#include "theia/matching/keypoints_and_descriptors.h"
+#include "theia/sfm/localize_view_to_reconstruction.h"
+#include "theia/sfm/types.h"
+#include "theia/solvers/sample_consensus_estimator.h"
+#include "theia/util/util.h"
+
+namespace theia {
+
+class Camera;
+class Reconstruction;
+
+struct LocalizationIndexOptions {
+  // The number of randomized KD-trees of the descriptor index and the number
+  // of leaves checked per query descriptor. These trade recall for speed.
+  int num_kd_trees = 4;
+  int num_kd_tree_checks = 64;
+
+  // Putative 2D-3D matches must pass Lowe's ratio test with this ratio.
+  float lowes_ratio = 0.8f;
+
+  // The putative matches vote for the views that observe their tracks and
+  // only matches to tracks seen in one of the num_candidate_views highest
+  // voted views are kept. This removes most of the outliers of large scenes
+  // before RANSAC. Set to 0 to keep all putative matches.
+  int num_candidate_views = 20;
+
+  // The number of threads used to match the query descriptors.
+  int num_threads = 1;
+
+  // The pose estimation options. The intrinsics of the query camera must be
+  // known so the view is localized with P3P (or with the known orientation
+  // solver) and, if bundle_adjust_view is set, refined against the matched
+  // 3D points, which are held constant.
+  LocalizeViewToReconstructionOptions localization_options;
+};
+
+struct LocalizationSummary {
+  // The views of the reconstruction that were selected as candidates for the
+  // query, sorted from most to least votes.
+  std::vector<ViewId> candidate_view_ids;
+
+  // The putative 2D-3D matches given to RANSAC as (feature index, track id)
+  // pairs. The RANSAC inliers index into this vector.
+  std::vector<std::pair<int, TrackId> > matches;
+  RansacSummary ransac_summary;
+};
+
+// A persistent index from the 3D points of a reconstruction to their
+// descriptors, used to localize new images against the reconstruction without
+// any prior correspondences (e.g. for relocalization). The index stores the
+// reference descriptor, position and observing views of each estimated track
+// and searches the descriptors with a FLANN randomized KD-forest.
+//
+// Localizing a query matches all of its descriptors against the index in one
+// batched search, keeps the matches that are covisible with the best
+// candidate views, and then estimates the pose with RANSAC. Only the tracks
+// with a reference descriptor (see Track::SetReferenceDescriptor) are indexed.
+//
+// The index may be written to disk and read back so it only has to be built
+// once per reconstruction. The KD-forest itself is rebuilt when reading.
+class LocalizationIndex {
+ public:
+  explicit LocalizationIndex(const LocalizationIndexOptions& options);
+  ~LocalizationIndex();
+
+  // Builds the index from the estimated tracks of the reconstruction that
+  // have a reference descriptor. Returns false if no track could be indexed.
+  bool Build(const Reconstruction& reconstruction);
+
+  // Localizes the query features, whose keypoints are in pixels of the given
+  // camera. The camera intrinsics must be set and, if assume_known_orientation
+  // is set, its orientation as well. On success, the pose of the camera is
+  // set and true is returned. This method is thread-safe with respect to
+  // other calls to Localize.
+  bool Localize(const KeypointsAndDescriptors& features,
+                Camera* camera,
+                LocalizationSummary* summary) const;
+
+  // Utilities to read and write the index to/from disk.
+  bool ReadFromDisk(const std::string& input_filepath);
+  bool WriteToDisk(const std::string& output_filepath) const;
+
+  // The number of indexed tracks and the number of views observing them.
+  int NumTracks() const { return track_ids_.size(); }
+  int NumViews() const { return view_ids_.size(); }
+
+ private:
+  struct KdForest;
+
+  // Builds the KD-forest over the indexed descriptors.
+  void BuildKdForest();
+
+  // Finds the putative matches of the query descriptors as (feature index,
+  // track index) pairs. A track is matched by at most one feature.
+  void FindPutativeMatches(const KeypointsAndDescriptors& features,
+                           std::vector<std::pair<int, int> >* matches) const;
+
+  // Keeps only the matches to tracks observed by one of the views that are
+  // observed by the most matches. The candidate views are returned.
+  void FilterMatchesByCovisibility(std::vector<std::pair<int, int> >* matches,
+                                   std::vector<ViewId>* candidate_view_ids)
+      const;
+
+  // Templated method for disk I/O with cereal. Only the indexed data is
+  // written, the KD-forest is rebuilt after reading.
+  friend class cereal::access;
+  template <class Archive>
+  void serialize(Archive& ar, const std::uint32_t version) {  // NOLINT
+    ar(track_ids_,
+       points_,
+       descriptors_,
+       view_ids_,
+       track_view_offsets_,
+       track_views_);
+  }
+
+  const LocalizationIndexOptions options_;
+
+  // The id, position and reference descriptor of each indexed track. Row i of
+  // the descriptors belongs to track i.
+  std::vector<TrackId> track_ids_;
+  Eigen::Matrix3Xd points_;
+  DescriptorMatrix descriptors_;
+
+  // The views observing the tracks. The views of track i are the indices
+  // track_views_[track_view_offsets_[i], track_view_offsets_[i + 1]) into
+  // view_ids_ so that views may be voted for with a dense array.
+  std::vector<ViewId> view_ids_;
+  std::vector<int> track_view_offsets_;
+  std::vector<int> track_views_;
+
+  std::unique_ptr<KdForest> kd_forest_;
+
+  DISALLOW_COPY_AND_ASSIGN(LocalizationIndex);
+};
+
+}  // namespace theia
+
+CEREAL_CLASS_VERSION(theia::LocalizationIndex, 0);
+
+#endif  // THEIA_SFM_LOCALIZATION_INDEX_H_
@@ -0,0 +1,322 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#include <Eigen/Core>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "theia/image/keypoint_detector/keypoint.h"
+#include "theia/matching/keypoints_and_descriptors.h"
+#include "theia/sfm/camera/camera.h"
+#include "theia/sfm/feature.h"
+#include "theia/sfm/localization_index.h"
+#include "theia/sfm/reconstruction.h"
+#include "theia/sfm/track.h"
+#include "theia/sfm/view.h"
+#include "theia/util/random.h"
+#include "theia/util/stringprintf.h"
+
+namespace theia {
+
+namespace {
+
+static const int kNumViews = 12;
+static const int kNumTracks = 1200;
+static const int kDescriptorDimension = 32;
+static const double kPoseTolerance = 1e-2;
+
+// Sets the camera to look at the origin from the given angle on a circle.
+void SetCameraOnCircle(const double angle, Camera* camera) {
+  camera->SetFocalLength(800.0);
+  camera->SetPrincipalPoint(400.0, 300.0);
+  camera->SetPosition(
+      Eigen::Vector3d(10.0 * std::sin(angle), 0.0, -10.0 * std::cos(angle)));
+  camera->SetOrientationFromAngleAxis(Eigen::Vector3d(0.0, -angle, 0.0));
+}
+
+// Builds a reconstruction with cameras on a circle looking at the origin.
+// Track i has a random unit-norm reference descriptor and is observed by the
+// views i, i + 1 and i + 2 (modulo the number of views).
+void BuildReconstruction(RandomNumberGenerator* rng,
+                         Reconstruction* reconstruction,
+                         std::vector<TrackId>* track_ids) {
+  std::vector<ViewId> view_ids;
+  for (int i = 0; i < kNumViews; i++) {
+    const ViewId view_id = reconstruction->AddView(StringPrintf("%d", i), i);
+    View* view = reconstruction->MutableView(view_id);
+    view->SetEstimated(true);
+    SetCameraOnCircle(2.0 * M_PI * i / kNumViews, view->MutableCamera());
+    view_ids.emplace_back(view_id);
+  }
+
+  for (int i = 0; i < kNumTracks; i++) {
+    const Eigen::Vector3d point = rng->RandVector3d();
+    std::vector<std::pair<ViewId, Feature> > observations;
+    for (int j = 0; j < 3; j++) {
+      const ViewId view_id = view_ids[(i + j) % kNumViews];
+      Eigen::Vector2d pixel;
+      reconstruction->View(view_id)->Camera().ProjectPoint(point.homogeneous(),
+                                                           &pixel);
+      observations.emplace_back(view_id, Feature(pixel));
+    }
+    const TrackId track_id = reconstruction->AddTrack(observations);
+    Track* track = reconstruction->MutableTrack(track_id);
+    track->SetEstimated(true);
+    *track->MutablePoint() = point.homogeneous();
+
+    Eigen::VectorXf descriptor(kDescriptorDimension);
+    for (int j = 0; j < kDescriptorDimension; j++) {
+      descriptor[j] = rng->RandGaussian(0.0, 1.0);
+    }
+    track->SetReferenceDescriptor(descriptor.normalized());
+    track_ids->emplace_back(track_id);
+  }
+}
+
+// Adds a query feature at the pixel with a noisy copy of the descriptor.
+void AddQueryFeature(RandomNumberGenerator* rng,
+                     const Eigen::Vector2d& pixel,
+                     const Eigen::VectorXf& descriptor,
+                     KeypointsAndDescriptors* features) {
+  features->keypoints.emplace_back(pixel.x(), pixel.y(), Keypoint::OTHER);
+  const int row = features->descriptor_matrix.rows();
+  features->descriptor_matrix.conservativeResize(row + 1,
+                                                 kDescriptorDimension);
+  for (int i = 0; i < kDescriptorDimension; i++) {
+    features->descriptor_matrix(row, i) =
+        descriptor[i] + rng->RandGaussian(0.0, 0.01);
+  }
+}
+
+// Returns the query features of the tracks observed by the camera. Every
+// outlier_stride-th track is given a random pixel instead of its projection.
+void QueryTracks(RandomNumberGenerator* rng,
+                 const Reconstruction& reconstruction,
+                 const std::vector<TrackId>& track_ids,
+                 const Camera& camera,
+                 const int outlier_stride,
+                 KeypointsAndDescriptors* features) {
+  features->image_name = "query";
+  for (int i = 0; i < track_ids.size(); i++) {
+    const Track* track = reconstruction.Track(track_ids[i]);
+    Eigen::Vector2d pixel;
+    camera.ProjectPoint(track->Point(), &pixel);
+    if (i % outlier_stride == 0) {
+      pixel = rng->RandVector2d(0.0, 800.0);
+    }
+    AddQueryFeature(rng, pixel, track->ReferenceDescriptor(), features);
+  }
+}
+
+LocalizationIndexOptions DefaultOptions() {
+  LocalizationIndexOptions options;
+  options.localization_options.bundle_adjust_view = false;
+  options.localization_options.ransac_params.rng =
+      std::make_shared<RandomNumberGenerator>(53);
+  return options;
+}
+
+void ExpectPosesNear(const Camera& expected, const Camera& actual) {
+  EXPECT_LT((expected.GetPosition() - actual.GetPosition()).norm(),
+            kPoseTolerance);
+  EXPECT_LT((expected.GetOrientationAsAngleAxis() -
+             actual.GetOrientationAsAngleAxis())
+                .norm(),
+            kPoseTolerance);
+}
+
+}  // namespace
+
+TEST(LocalizationIndex, IndexesTracksWithReferenceDescriptors) {
+  RandomNumberGenerator rng(59);
+  Reconstruction reconstruction;
+  std::vector<TrackId> track_ids;
+  BuildReconstruction(&rng, &reconstruction, &track_ids);
+  reconstruction.MutableTrack(track_ids[0])->SetEstimated(false);
+  reconstruction.MutableTrack(track_ids[1])->SetReferenceDescriptor(
+      Eigen::VectorXf());
+
+  LocalizationIndex index(DefaultOptions());
+  EXPECT_TRUE(index.Build(reconstruction));
+  EXPECT_EQ(index.NumTracks(), kNumTracks - 2);
+  EXPECT_EQ(index.NumViews(), kNumViews);
+
+  Reconstruction empty_reconstruction;
+  EXPECT_FALSE(index.Build(empty_reconstruction));
+  EXPECT_EQ(index.NumTracks(), 0);
+}
+
+TEST(LocalizationIndex, LocalizesQuery) {
+  RandomNumberGenerator rng(59);
+  Reconstruction reconstruction;
+  std::vector<TrackId> track_ids;
+  BuildReconstruction(&rng, &reconstruction, &track_ids);
+
+  Camera expected_camera;
+  SetCameraOnCircle(0.1, &expected_camera);
+  KeypointsAndDescriptors features;
+  QueryTracks(&rng, reconstruction, track_ids, expected_camera, 5, &features);
+
+  for (const int num_threads : {1, 4}) {
+    LocalizationIndexOptions options = DefaultOptions();
+    options.num_candidate_views = 0;
+    options.num_threads = num_threads;
+    LocalizationIndex index(options);
+    ASSERT_TRUE(index.Build(reconstruction));
+
+    Camera camera;
+    camera.SetFocalLength(800.0);
+    camera.SetPrincipalPoint(400.0, 300.0);
+    LocalizationSummary summary;
+    EXPECT_TRUE(index.Localize(features, &camera, &summary));
+    ExpectPosesNear(expected_camera, camera);
+    EXPECT_GE(summary.ransac_summary.inliers.size(), kNumTracks * 3 / 4);
+    EXPECT_TRUE(summary.candidate_view_ids.empty());
+  }
+}
+
+TEST(LocalizationIndex, FiltersMatchesByCovisibility) {
+  RandomNumberGenerator rng(59);
+  Reconstruction reconstruction;
+  std::vector<TrackId> track_ids;
+  BuildReconstruction(&rng, &reconstruction, &track_ids);
+
+  // The query observes the tracks of views 0, 1 and 2 and has a smaller
+  // number of wrong matches to the tracks of views 6, 7 and 8.
+  Camera expected_camera;
+  SetCameraOnCircle(0.1, &expected_camera);
+  KeypointsAndDescriptors features;
+  std::unordered_set<TrackId> outlier_track_ids;
+  for (int i = 0; i < kNumTracks; i++) {
+    const Track* track = reconstruction.Track(track_ids[i]);
+    if (i % kNumViews == 0) {
+      Eigen::Vector2d pixel;
+      expected_camera.ProjectPoint(track->Point(), &pixel);
+      AddQueryFeature(&rng, pixel, track->ReferenceDescriptor(), &features);
+    } else if (i % (2 * kNumViews) == 6) {
+      AddQueryFeature(&rng,
+                      rng.RandVector2d(0.0, 800.0),
+                      track->ReferenceDescriptor(),
+                      &features);
+      outlier_track_ids.insert(track_ids[i]);
+    }
+  }
+
+  LocalizationIndexOptions options = DefaultOptions();
+  options.num_candidate_views = 3;
+  LocalizationIndex index(options);
+  ASSERT_TRUE(index.Build(reconstruction));
+
+  Camera camera;
+  camera.SetFocalLength(800.0);
+  camera.SetPrincipalPoint(400.0, 300.0);
+  LocalizationSummary summary;
+  EXPECT_TRUE(index.Localize(features, &camera, &summary));
+  ExpectPosesNear(expected_camera, camera);
+
+  const std::vector<ViewId> expected_candidate_view_ids = {
+      reconstruction.ViewIdFromName("0"),
+      reconstruction.ViewIdFromName("1"),
+      reconstruction.ViewIdFromName("2")};
+  EXPECT_EQ(summary.candidate_view_ids, expected_candidate_view_ids);
+  EXPECT_EQ(summary.matches.size(), kNumTracks / kNumViews);
+  for (const auto& match : summary.matches) {
+    EXPECT_EQ(outlier_track_ids.count(match.second), 0);
+  }
+}
+
+TEST(LocalizationIndex, FailsWithoutEnoughMatches) {
+  RandomNumberGenerator rng(59);
+  Reconstruction reconstruction;
+  std::vector<TrackId> track_ids;
+  BuildReconstruction(&rng, &reconstruction, &track_ids);
+  LocalizationIndex index(DefaultOptions());
+  ASSERT_TRUE(index.Build(reconstruction));
+
+  // Random descriptors rarely pass the ratio test.
+  KeypointsAndDescriptors features;
+  for (int i = 0; i < 10; i++) {
+    Eigen::VectorXf descriptor(kDescriptorDimension);
+    for (int j = 0; j < kDescriptorDimension; j++) {
+      descriptor[j] = rng.RandGaussian(0.0, 1.0);
+    }
+    AddQueryFeature(
+        &rng, rng.RandVector2d(0.0, 800.0), descriptor.normalized(), &features);
+  }
+
+  Camera camera;
+  camera.SetFocalLength(800.0);
+  camera.SetPrincipalPoint(400.0, 300.0);
+  LocalizationSummary summary;
+  EXPECT_FALSE(index.Localize(features, &camera, &summary));
+}
+
+TEST(LocalizationIndex, ReadWriteRoundTrip) {
+  RandomNumberGenerator rng(59);
+  Reconstruction reconstruction;
+  std::vector<TrackId> track_ids;
+  BuildReconstruction(&rng, &reconstruction, &track_ids);
+
+  Camera expected_camera;
+  SetCameraOnCircle(0.1, &expected_camera);
+  KeypointsAndDescriptors features;
+  QueryTracks(&rng, reconstruction, track_ids, expected_camera, 5, &features);
+
+  LocalizationIndex index(DefaultOptions());
+  ASSERT_TRUE(index.Build(reconstruction));
+  const std::string filepath =
+      testing::internal::TempDir() + "localization_index_test.bin";
+  ASSERT_TRUE(index.WriteToDisk(filepath));
+
+  LocalizationIndex read_index(DefaultOptions());
+  ASSERT_TRUE(read_index.ReadFromDisk(filepath));
+  std::remove(filepath.c_str());
+  EXPECT_EQ(read_index.NumTracks(), index.NumTracks());
+  EXPECT_EQ(read_index.NumViews(), index.NumViews());
+
+  Camera camera;
+  camera.SetFocalLength(800.0);
+  camera.SetPrincipalPoint(400.0, 300.0);
+  LocalizationSummary summary;
+  EXPECT_TRUE(read_index.Localize(features, &camera, &summary));
+  ExpectPosesNear(expected_camera, camera);
+}
+
+}  // namespace theia
@@ -190,8 +190,23 @@ bool EstimateCameraPose(const bool known_intrinsics,
         resolution_scaled_reprojection_error_threshold_pixels /
         (camera->FocalLength() * camera->FocalLength());
     CalibratedAbsolutePose pose;
-    if (EstimateCalibratedAbsolutePose(
-            ransac_parameters, RansacType::RANSAC, PnPType::KNEIP, matches, &pose, summary)) {
+    if (options.use_gravity_prior && view->HasGravityPrior()) {
+      success = EstimateCalibratedAbsolutePoseWithKnownGravity(
+          ransac_parameters,
+          RansacType::RANSAC,
+          view->GetGravityPrior(),
+          matches,
+          &pose,
+          summary);
+    } else {
+      success = EstimateCalibratedAbsolutePose(ransac_parameters,
+                                               RansacType::RANSAC,
+                                               options.pnp_type,
+                                               matches,
+                                               &pose,
+                                               summary);
+    }
+    if (success) {
       camera->SetOrientationFromRotationMatrix(pose.rotation);
       camera->SetPosition(pose.position);
       return true;
@@ -36,6 +36,7 @@
 #define THEIA_SFM_LOCALIZE_VIEW_TO_RECONSTRUCTION_H_
 
 #include "theia/sfm/bundle_adjustment/bundle_adjustment.h"
+#include "theia/sfm/estimators/estimate_calibrated_absolute_pose.h"
 #include "theia/sfm/types.h"
 #include "theia/solvers/sample_consensus_estimator.h"
 
@@ -60,6 +61,15 @@ struct LocalizeViewToReconstructionOptions {
   // then standard P3P is used.
   bool assume_known_orientation = false;
 
+  // The solver used to estimate the pose of calibrated views. CASCADE refits
+  // the P3P pose to all inliers.
+  PnPType pnp_type = PnPType::KNEIP;
+
+  // If true, calibrated views with a gravity prior are localized with the two
+  // point gravity-aware solver, which needs far fewer RANSAC samples than P3P.
+  // See EstimateCalibratedAbsolutePoseWithKnownGravity.
+  bool use_gravity_prior = false;
+
   // The RANSAC parameters used for robust estimation in the localization
   // algorithms.
   RansacParameters ransac_params;
@@ -0,0 +1,190 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#include "theia/sfm/next_best_view_selector.h"
+
+#include <glog/logging.h>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "theia/sfm/camera/camera.h"
+#include "theia/sfm/feature.h"
+#include "theia/sfm/reconstruction.h"
+#include "theia/sfm/track.h"
+#include "theia/sfm/view.h"
+#include "theia/util/map_util.h"
+
+namespace theia {
+
+NextBestViewSelector::NextBestViewSelector(const int num_pyramid_levels,
+                                           const int min_num_estimated_tracks)
+    : num_pyramid_levels_(num_pyramid_levels),
+      min_num_estimated_tracks_(min_num_estimated_tracks) {
+  CHECK_GT(num_pyramid_levels_, 0);
+}
+
+void NextBestViewSelector::AddView(const Reconstruction& reconstruction,
+                                   const ViewId view_id) {
+  if (ContainsKey(candidates_, view_id)) {
+    return;
+  }
+
+  const View* view = reconstruction.View(view_id);
+  CHECK_NOTNULL(view);
+  const Camera& camera = view->Camera();
+  Candidate candidate(VisibilityPyramid(
+      camera.ImageWidth(), camera.ImageHeight(), num_pyramid_levels_));
+  for (const TrackId track_id : view->TrackIds()) {
+    if (ContainsKey(estimated_tracks_, track_id)) {
+      candidate.pyramid.AddPoint(view->GetFeature(track_id)->point_);
+      ++candidate.num_estimated_tracks;
+    }
+  }
+
+  const auto it = candidates_.emplace(view_id, candidate).first;
+  Rank(view_id, it->second, 0, 0);
+}
+
+bool NextBestViewSelector::RemoveView(const ViewId view_id) {
+  const auto it = candidates_.find(view_id);
+  if (it == candidates_.end()) {
+    return false;
+  }
+  ranked_views_.erase(
+      std::make_pair(it->second.pyramid.ComputeScore(), view_id));
+  candidates_.erase(it);
+  return true;
+}
+
+void NextBestViewSelector::UpdateTracks(const Reconstruction& reconstruction) {
+  int num_estimated_tracks = 0;
+  for (const TrackId track_id : reconstruction.TrackIds()) {
+    const bool is_estimated = reconstruction.Track(track_id)->IsEstimated();
+    num_estimated_tracks += is_estimated;
+    if (is_estimated == ContainsKey(estimated_tracks_, track_id)) {
+      continue;
+    }
+
+    if (is_estimated) {
+      estimated_tracks_.insert(track_id);
+    } else {
+      estimated_tracks_.erase(track_id);
+    }
+    UpdateTrack(reconstruction, track_id, is_estimated);
+  }
+
+  // If estimated tracks were removed from the reconstruction then their
+  // observations are no longer known, so the pyramids are rebuilt.
+  if (num_estimated_tracks != estimated_tracks_.size()) {
+    for (auto it = estimated_tracks_.begin(); it != estimated_tracks_.end();) {
+      if (reconstruction.Track(*it) == nullptr) {
+        it = estimated_tracks_.erase(it);
+      } else {
+        ++it;
+      }
+    }
+
+    std::vector<ViewId> view_ids;
+    view_ids.reserve(candidates_.size());
+    for (const auto& candidate : candidates_) {
+      view_ids.emplace_back(candidate.first);
+    }
+    candidates_.clear();
+    ranked_views_.clear();
+    for (const ViewId view_id : view_ids) {
+      AddView(reconstruction, view_id);
+    }
+  }
+}
+
+void NextBestViewSelector::UpdateTrack(const Reconstruction& reconstruction,
+                                       const TrackId track_id,
+                                       const bool is_estimated) {
+  for (const ViewId view_id : reconstruction.Track(track_id)->ViewIds()) {
+    const auto it = candidates_.find(view_id);
+    if (it == candidates_.end()) {
+      continue;
+    }
+    const Feature* feature =
+        reconstruction.View(view_id)->GetFeature(track_id);
+    if (feature == nullptr) {
+      continue;
+    }
+
+    Candidate& candidate = it->second;
+    const int previous_score = candidate.pyramid.ComputeScore();
+    const int previous_num_estimated_tracks = candidate.num_estimated_tracks;
+    if (is_estimated) {
+      candidate.pyramid.AddPoint(feature->point_);
+      ++candidate.num_estimated_tracks;
+    } else {
+      candidate.pyramid.RemovePoint(feature->point_);
+      --candidate.num_estimated_tracks;
+    }
+    Rank(view_id, candidate, previous_score, previous_num_estimated_tracks);
+  }
+}
+
+void NextBestViewSelector::Rank(const ViewId view_id,
+                                const Candidate& candidate,
+                                const int previous_score,
+                                const int previous_num_estimated_tracks) {
+  if (previous_num_estimated_tracks >= min_num_estimated_tracks_) {
+    ranked_views_.erase(std::make_pair(previous_score, view_id));
+  }
+  if (candidate.num_estimated_tracks >= min_num_estimated_tracks_) {
+    ranked_views_.emplace(candidate.pyramid.ComputeScore(), view_id);
+  }
+}
+
+void NextBestViewSelector::Clear() {
+  candidates_.clear();
+  estimated_tracks_.clear();
+  ranked_views_.clear();
+}
+
+bool NextBestViewSelector::HasView(const ViewId view_id) const {
+  return ContainsKey(candidates_, view_id);
+}
+
+int NextBestViewSelector::NumViews() const { return candidates_.size(); }
+
+std::vector<std::pair<int, ViewId> > NextBestViewSelector::RankedViews()
+    const {
+  return std::vector<std::pair<int, ViewId> >(ranked_views_.begin(),
+                                              ranked_views_.end());
+}
+
+}  // namespace theia
@@ -0,0 +1,126 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#ifndef THEIA_SFM_NEXT_BEST_VIEW_SELECTOR_H_
+#define THEIA_SFM_NEXT_BEST_VIEW_SELECTOR_H_
+
+#include <functional>
+#include <set>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "theia/sfm/types.h"
+#include "theia/sfm/visibility_pyramid.h"
+
+namespace theia {
+
+class Reconstruction;
+
+// Ranks the views that are not yet localized during incremental SfM by the
+// visibility pyramid score of their estimated tracks (see VisibilityPyramid).
+// Instead of rebuilding the pyramids of all candidate views each time the next
+// best view is chosen, the pyramid of each candidate view is maintained
+// incrementally: when a track becomes estimated (or unestimated) only the
+// pyramids of the candidate views observing it are updated, and the candidate
+// views are kept sorted by their scores.
+class NextBestViewSelector {
+ public:
+  // Only candidate views that observe at least min_num_estimated_tracks
+  // estimated tracks are ranked.
+  NextBestViewSelector(const int num_pyramid_levels,
+                       const int min_num_estimated_tracks);
+
+  // Adds a candidate view. Its pyramid is built from the tracks that were
+  // estimated at the last call to UpdateTracks. Adding a view twice has no
+  // effect.
+  void AddView(const Reconstruction& reconstruction, const ViewId view_id);
+
+  // Removes a candidate view (e.g. once it is localized). Returns false if the
+  // view was not a candidate.
+  bool RemoveView(const ViewId view_id);
+
+  // Updates the pyramids of the candidate views observing the tracks whose
+  // estimated state changed since the last update. Only a flag is checked per
+  // track so the cost is dominated by the number of changed observations.
+  void UpdateTracks(const Reconstruction& reconstruction);
+
+  // Removes all candidate views and forgets the estimated tracks.
+  void Clear();
+
+  bool HasView(const ViewId view_id) const;
+  int NumViews() const;
+
+  // Returns the (score, view id) pairs of the ranked candidate views sorted
+  // from the best to the worst score. Ties are broken by the larger view id.
+  std::vector<std::pair<int, ViewId> > RankedViews() const;
+
+ private:
+  struct Candidate {
+    explicit Candidate(const VisibilityPyramid& pyramid) : pyramid(pyramid) {}
+
+    VisibilityPyramid pyramid;
+    int num_estimated_tracks = 0;
+  };
+
+  // Adds or removes the observation of the track to the pyramid of each
+  // candidate view that observes it.
+  void UpdateTrack(const Reconstruction& reconstruction,
+                   const TrackId track_id,
+                   const bool is_estimated);
+
+  // Removes the candidate from the ranking and re-inserts it with its current
+  // score if it observes enough estimated tracks.
+  void Rank(const ViewId view_id,
+            const Candidate& candidate,
+            const int previous_score,
+            const int previous_num_estimated_tracks);
+
+  const int num_pyramid_levels_;
+  const int min_num_estimated_tracks_;
+
+  std::unordered_map<ViewId, Candidate> candidates_;
+
+  // The tracks that were estimated at the last update.
+  std::unordered_set<TrackId> estimated_tracks_;
+
+  // The ranked candidate views ordered by decreasing (score, view id).
+  std::set<std::pair<int, ViewId>, std::greater<std::pair<int, ViewId> > >
+      ranked_views_;
+};
+
+}  // namespace theia
+
+#endif  // THEIA_SFM_NEXT_BEST_VIEW_SELECTOR_H_
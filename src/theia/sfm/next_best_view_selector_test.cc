@@ -0,0 +1,238 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#include <Eigen/Core>
+#include <algorithm>
+#include <functional>
+#include <string>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "theia/sfm/camera/camera.h"
+#include "theia/sfm/feature.h"
+#include "theia/sfm/next_best_view_selector.h"
+#include "theia/sfm/reconstruction.h"
+#include "theia/sfm/track.h"
+#include "theia/sfm/types.h"
+#include "theia/sfm/view.h"
+#include "theia/sfm/visibility_pyramid.h"
+#include "theia/util/random.h"
+
+namespace theia {
+
+namespace {
+
+static const int kImageWidth = 640;
+static const int kImageHeight = 480;
+static const int kNumPyramidLevels = 4;
+static const int kMinNumEstimatedTracks = 5;
+
+// Builds a reconstruction where every track is observed by a random subset of
+// the views at random pixels. No track is estimated.
+void BuildReconstruction(const int num_views,
+                         const int num_tracks,
+                         RandomNumberGenerator* rng,
+                         Reconstruction* reconstruction) {
+  for (int i = 0; i < num_views; i++) {
+    const ViewId view_id = reconstruction->AddView(std::to_string(i), i);
+    reconstruction->MutableView(view_id)->MutableCamera()->SetImageSize(
+        kImageWidth, kImageHeight);
+  }
+  for (int i = 0; i < num_tracks; i++) {
+    std::vector<std::pair<ViewId, Feature> > observations;
+    for (ViewId view_id = 0; view_id < num_views; view_id++) {
+      if (rng->RandDouble(0.0, 1.0) < 0.5) {
+        const Feature feature(
+            Eigen::Vector2d(rng->RandDouble(0.0, kImageWidth),
+                            rng->RandDouble(0.0, kImageHeight)));
+        observations.emplace_back(view_id, feature);
+      }
+    }
+    if (observations.size() >= 2) {
+      reconstruction->AddTrack(observations);
+    }
+  }
+}
+
+// Scores the views from scratch, as done before the scores were maintained
+// incrementally.
+std::vector<std::pair<int, ViewId> > RankViewsFromScratch(
+    const Reconstruction& reconstruction,
+    const std::unordered_set<ViewId>& view_ids) {
+  std::vector<std::pair<int, ViewId> > ranked_views;
+  for (const ViewId view_id : view_ids) {
+    const View* view = reconstruction.View(view_id);
+    VisibilityPyramid pyramid(
+        kImageWidth, kImageHeight, kNumPyramidLevels);
+    int num_estimated_tracks = 0;
+    for (const TrackId track_id : view->TrackIds()) {
+      if (reconstruction.Track(track_id)->IsEstimated()) {
+        ++num_estimated_tracks;
+        pyramid.AddPoint(view->GetFeature(track_id)->point_);
+      }
+    }
+    if (num_estimated_tracks >= kMinNumEstimatedTracks) {
+      ranked_views.emplace_back(pyramid.ComputeScore(), view_id);
+    }
+  }
+  std::sort(ranked_views.begin(),
+            ranked_views.end(),
+            std::greater<std::pair<int, ViewId> >());
+  return ranked_views;
+}
+
+// Randomly sets tracks as estimated or unestimated.
+void ToggleRandomTracks(const int num_toggles,
+                        RandomNumberGenerator* rng,
+                        Reconstruction* reconstruction) {
+  const std::vector<TrackId> track_ids = reconstruction->TrackIds();
+  for (int i = 0; i < num_toggles; i++) {
+    Track* track = reconstruction->MutableTrack(
+        track_ids[rng->RandInt(0, track_ids.size() - 1)]);
+    track->SetEstimated(!track->IsEstimated());
+  }
+}
+
+}  // namespace
+
+TEST(VisibilityPyramid, RemovePointRestoresScore) {
+  RandomNumberGenerator rng(59);
+  VisibilityPyramid pyramid(kImageWidth, kImageHeight, kNumPyramidLevels);
+  std::vector<Eigen::Vector2d> points;
+  for (int i = 0; i < 50; i++) {
+    points.emplace_back(rng.RandDouble(0.0, kImageWidth),
+                        rng.RandDouble(0.0, kImageHeight));
+  }
+
+  std::vector<int> scores;
+  for (const Eigen::Vector2d& point : points) {
+    scores.emplace_back(pyramid.ComputeScore());
+    pyramid.AddPoint(point);
+  }
+  for (int i = points.size() - 1; i >= 0; i--) {
+    pyramid.RemovePoint(points[i]);
+    EXPECT_EQ(pyramid.ComputeScore(), scores[i]);
+  }
+  EXPECT_EQ(pyramid.ComputeScore(), 0);
+}
+
+TEST(NextBestViewSelector, MatchesScoresFromScratch) {
+  RandomNumberGenerator rng(59);
+  Reconstruction reconstruction;
+  BuildReconstruction(20, 300, &rng, &reconstruction);
+
+  NextBestViewSelector selector(kNumPyramidLevels, kMinNumEstimatedTracks);
+  std::unordered_set<ViewId> candidate_view_ids;
+  for (const ViewId view_id : reconstruction.ViewIds()) {
+    selector.AddView(reconstruction, view_id);
+    candidate_view_ids.insert(view_id);
+  }
+  EXPECT_EQ(selector.NumViews(), 20);
+  EXPECT_TRUE(selector.RankedViews().empty());
+
+  for (int round = 0; round < 20; round++) {
+    ToggleRandomTracks(40, &rng, &reconstruction);
+
+    // Remove a candidate view and add back a previously removed view, whose
+    // pyramid is rebuilt from the estimated tracks.
+    const ViewId view_id_to_remove = round % 20;
+    EXPECT_EQ(selector.RemoveView(view_id_to_remove),
+              candidate_view_ids.erase(view_id_to_remove) > 0);
+    if (round > 0 && round % 3 == 0) {
+      const ViewId view_id_to_add = round - 3;
+      selector.AddView(reconstruction, view_id_to_add);
+      candidate_view_ids.insert(view_id_to_add);
+    }
+
+    selector.UpdateTracks(reconstruction);
+    EXPECT_EQ(selector.RankedViews(),
+              RankViewsFromScratch(reconstruction, candidate_view_ids));
+  }
+}
+
+TEST(NextBestViewSelector, AddViewUsesLastUpdate) {
+  RandomNumberGenerator rng(59);
+  Reconstruction reconstruction;
+  BuildReconstruction(4, 100, &rng, &reconstruction);
+  for (const TrackId track_id : reconstruction.TrackIds()) {
+    reconstruction.MutableTrack(track_id)->SetEstimated(true);
+  }
+
+  NextBestViewSelector selector(kNumPyramidLevels, kMinNumEstimatedTracks);
+  selector.AddView(reconstruction, 0);
+  EXPECT_TRUE(selector.HasView(0));
+  EXPECT_FALSE(selector.HasView(1));
+  EXPECT_TRUE(selector.RankedViews().empty());
+
+  selector.UpdateTracks(reconstruction);
+  EXPECT_EQ(selector.RankedViews(),
+            RankViewsFromScratch(reconstruction, {0}));
+  selector.AddView(reconstruction, 1);
+  EXPECT_EQ(selector.RankedViews(),
+            RankViewsFromScratch(reconstruction, {0, 1}));
+
+  EXPECT_FALSE(selector.RemoveView(2));
+  selector.Clear();
+  EXPECT_EQ(selector.NumViews(), 0);
+  EXPECT_TRUE(selector.RankedViews().empty());
+}
+
+TEST(NextBestViewSelector, HandlesRemovedTracks) {
+  RandomNumberGenerator rng(59);
+  Reconstruction reconstruction;
+  BuildReconstruction(6, 100, &rng, &reconstruction);
+  for (const TrackId track_id : reconstruction.TrackIds()) {
+    reconstruction.MutableTrack(track_id)->SetEstimated(true);
+  }
+
+  NextBestViewSelector selector(kNumPyramidLevels, kMinNumEstimatedTracks);
+  selector.UpdateTracks(reconstruction);
+  const std::unordered_set<ViewId> view_ids = {0, 1, 2, 3, 4, 5};
+  for (const ViewId view_id : view_ids) {
+    selector.AddView(reconstruction, view_id);
+  }
+
+  const std::vector<TrackId> track_ids = reconstruction.TrackIds();
+  for (int i = 0; i < track_ids.size(); i += 3) {
+    ASSERT_TRUE(reconstruction.RemoveTrack(track_ids[i]));
+  }
+  selector.UpdateTracks(reconstruction);
+  EXPECT_EQ(selector.RankedViews(),
+            RankViewsFromScratch(reconstruction, view_ids));
+}
+
+}  // namespace theia
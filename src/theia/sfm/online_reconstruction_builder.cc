@@ -0,0 +1,632 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#include "theia/sfm/online_reconstruction_builder.h"
+
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "theia/matching/feature_matcher.h"
+#include "theia/matching/features_and_matches_database.h"
+#include "theia/matching/image_pair_match.h"
+#include "theia/matching/vocabulary_tree.h"
+#include "theia/sfm/bundle_adjustment/bundle_adjustment.h"
+#include "theia/sfm/camera/camera.h"
+#include "theia/sfm/incremental_reconstruction_estimator.h"
+#include "theia/sfm/reconstruction.h"
+#include "theia/sfm/reconstruction_estimator_utils.h"
+#include "theia/sfm/set_outlier_tracks_to_unestimated.h"
+#include "theia/sfm/track_builder.h"
+#include "theia/sfm/twoview_info.h"
+#include "theia/sfm/view_graph/view_graph.h"
+#include "theia/util/map_util.h"
+#include "theia/util/threadpool.h"
+
+namespace theia {
+namespace {
+
+void SetReconstructionAsUnestimated(Reconstruction* reconstruction) {
+  for (const TrackId track_id : reconstruction->TrackIds()) {
+    reconstruction->MutableTrack(track_id)->SetEstimated(false);
+  }
+  for (const ViewId view_id : reconstruction->ViewIds()) {
+    reconstruction->MutableView(view_id)->SetEstimated(false);
+  }
+}
+
+// Gives each intrinsics group of the reconstruction its own copy of the
+// intrinsics so that they are not shared with the reconstruction it was copied
+// from.
+void CopyCameraIntrinsics(Reconstruction* reconstruction) {
+  const auto group_ids = reconstruction->CameraIntrinsicsGroupIds();
+  for (const CameraIntrinsicsGroupId group_id : group_ids) {
+    const auto view_ids =
+        reconstruction->GetViewsInCameraIntrinsicGroup(group_id);
+    if (view_ids.empty()) {
+      continue;
+    }
+    Camera camera;
+    camera.DeepCopy(reconstruction->View(*view_ids.begin())->Camera());
+    for (const ViewId view_id : view_ids) {
+      reconstruction->MutableView(view_id)
+          ->MutableCamera()
+          ->MutableCameraIntrinsics() = camera.CameraIntrinsics();
+    }
+  }
+}
+
+}  // namespace
+
+OnlineReconstructionBuilder::OnlineReconstructionBuilder(
+    const OnlineReconstructionBuilderOptions& options,
+    FeaturesAndMatchesDatabase* features_and_matches_database)
+    : options_(options),
+      features_and_matches_database_(
+          CHECK_NOTNULL(features_and_matches_database)),
+      is_initialized_(false),
+      num_localized_views_since_bundle_adjustment_(0),
+      image_queue_(options.queue_capacity),
+      num_unprocessed_images_(0),
+      is_bundle_adjusting_(false),
+      is_stopped_(false) {
+  CHECK_GT(options_.num_threads, 0);
+  CHECK_GE(options_.num_sequential_images_to_match, 0);
+  CHECK_GE(options_.num_retrieved_images_to_match, 0);
+  CHECK_GT(options_.max_num_localization_attempts, 0);
+  CHECK_GE(options_.full_bundle_adjustment_interval, 0);
+
+  ReconstructionEstimatorOptions& estimator_options =
+      options_.reconstruction_estimator_options;
+  estimator_options.rng = options_.rng;
+  estimator_options.num_threads = options_.num_threads;
+
+  reconstruction_.reset(new Reconstruction());
+  view_graph_.reset(new ViewGraph());
+  track_builder_.reset(
+      new TrackBuilder(options_.min_track_length, options_.max_track_length));
+
+  // Set up matching.
+  FeatureMatcherOptions matcher_options = options_.matching_options;
+  matcher_options.num_threads = options_.num_threads;
+  matcher_options.geometric_verification_options.min_num_inlier_matches =
+      options_.min_num_inlier_matches;
+  matcher_options.geometric_verification_options.estimate_twoview_info_options
+      .rng = options_.rng;
+  matcher_ = CreateFeatureMatcher(options_.matching_strategy,
+                                  matcher_options,
+                                  features_and_matches_database_);
+
+  // The new views are localized and triangulated with the same options as in
+  // the incremental reconstruction estimator.
+  localization_options_.reprojection_error_threshold_pixels =
+      estimator_options.absolute_pose_reprojection_error_threshold;
+  localization_options_.ransac_params = SetRansacParameters(estimator_options);
+  localization_options_.bundle_adjust_view = true;
+  localization_options_.ba_options =
+      SetBundleAdjustmentOptions(estimator_options, 0);
+  localization_options_.ba_options.verbose = false;
+  localization_options_.min_num_inliers =
+      estimator_options.min_num_absolute_pose_inliers;
+
+  triangulation_options_.max_acceptable_reprojection_error_pixels =
+      estimator_options.triangulation_max_reprojection_error_in_pixels;
+  triangulation_options_.min_triangulation_angle_degrees =
+      estimator_options.min_triangulation_angle_degrees;
+  triangulation_options_.bundle_adjustment =
+      estimator_options.bundle_adjust_tracks;
+  triangulation_options_.ba_options =
+      SetBundleAdjustmentOptions(estimator_options, 0);
+  triangulation_options_.ba_options.num_threads = 1;
+  triangulation_options_.ba_options.verbose = false;
+  triangulation_options_.num_threads = options_.num_threads;
+  triangulation_options_.joint_bundle_adjustment = true;
+
+  if (options_.num_threads > 1) {
+    thread_pool_.reset(new ThreadPool(options_.num_threads));
+  }
+
+  worker_ = std::thread(&OnlineReconstructionBuilder::ProcessImages, this);
+}
+
+OnlineReconstructionBuilder::~OnlineReconstructionBuilder() { Stop(); }
+
+bool OnlineReconstructionBuilder::AddImage(
+    const std::string& image_name,
+    const double timestamp,
+    const CameraIntrinsicsPrior& camera_intrinsics_prior,
+    const KeypointsAndDescriptors& features) {
+  return AddImage(image_name,
+                  timestamp,
+                  camera_intrinsics_prior,
+                  kInvalidCameraIntrinsicsGroupId,
+                  features);
+}
+
+bool OnlineReconstructionBuilder::AddImage(
+    const std::string& image_name,
+    const double timestamp,
+    const CameraIntrinsicsPrior& camera_intrinsics_prior,
+    const CameraIntrinsicsGroupId camera_intrinsics_group,
+    const KeypointsAndDescriptors& features) {
+  ImageToProcess image;
+  image.image_name = image_name;
+  image.timestamp = timestamp;
+  image.camera_intrinsics_prior = camera_intrinsics_prior;
+  image.camera_intrinsics_group = camera_intrinsics_group;
+  image.features = std::make_shared<KeypointsAndDescriptors>(features);
+  image.features->image_name = image_name;
+
+  {
+    std::lock_guard<std::mutex> lock(state_mutex_);
+    if (is_stopped_) {
+      LOG(WARNING) << "Could not add image " << image_name
+                   << " because the online reconstruction builder was "
+                      "stopped.";
+      return false;
+    }
+    ++num_unprocessed_images_;
+  }
+
+  if (!image_queue_.Push(std::move(image))) {
+    {
+      std::lock_guard<std::mutex> lock(state_mutex_);
+      --num_unprocessed_images_;
+    }
+    idle_condition_.notify_all();
+    return false;
+  }
+  return true;
+}
+
+void OnlineReconstructionBuilder::WaitUntilIdle() {
+  std::unique_lock<std::mutex> lock(state_mutex_);
+  idle_condition_.wait(lock, [this]() {
+    return num_unprocessed_images_ == 0 && !is_bundle_adjusting_;
+  });
+}
+
+void OnlineReconstructionBuilder::Stop() {
+  {
+    std::lock_guard<std::mutex> lock(state_mutex_);
+    is_stopped_ = true;
+  }
+  image_queue_.Close();
+  if (worker_.joinable()) {
+    worker_.join();
+  }
+  // The bundle adjustment thread is only started by the worker thread, so no
+  // new one can be started at this point.
+  if (bundle_adjustment_thread_.joinable()) {
+    bundle_adjustment_thread_.join();
+  }
+}
+
+void OnlineReconstructionBuilder::GetSnapshot(
+    Reconstruction* reconstruction) const {
+  CHECK_NOTNULL(reconstruction);
+  {
+    std::lock_guard<std::mutex> lock(reconstruction_mutex_);
+    *reconstruction = *reconstruction_;
+  }
+  CopyCameraIntrinsics(reconstruction);
+}
+
+int OnlineReconstructionBuilder::NumViews() const {
+  std::lock_guard<std::mutex> lock(reconstruction_mutex_);
+  return reconstruction_->NumViews();
+}
+
+int OnlineReconstructionBuilder::NumEstimatedViews() const {
+  std::lock_guard<std::mutex> lock(reconstruction_mutex_);
+  return theia::NumEstimatedViews(*reconstruction_);
+}
+
+void OnlineReconstructionBuilder::ProcessImages() {
+  ImageToProcess image;
+  while (image_queue_.Pop(&image)) {
+    ProcessImage(image);
+    {
+      std::lock_guard<std::mutex> lock(state_mutex_);
+      --num_unprocessed_images_;
+    }
+    idle_condition_.notify_all();
+  }
+}
+
+void OnlineReconstructionBuilder::ProcessImage(const ImageToProcess& image) {
+  features_and_matches_database_->PutCameraIntrinsicsPrior(
+      image.image_name, image.camera_intrinsics_prior);
+  features_and_matches_database_->PutFeatures(image.image_name,
+                                              *image.features);
+
+  const ViewId view_id = AddView(image);
+  if (view_id == kInvalidViewId) {
+    return;
+  }
+
+  // Matching only reads the features and matches database, so the snapshot
+  // reads are not blocked while the image is matched.
+  const std::vector<std::pair<std::string, std::string> > matched_pairs =
+      MatchImage(image);
+  image_names_.emplace_back(image.image_name);
+  if (matched_pairs.empty()) {
+    VLOG(1) << "Image " << image.image_name
+            << " could not be matched to any of the previous images.";
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(reconstruction_mutex_);
+    AddMatches(matched_pairs);
+    if (!is_initialized_) {
+      is_initialized_ = InitializeReconstruction();
+    } else {
+      const int num_localized_views = LocalizeViews(view_id);
+      VLOG(1) << "Adding image " << image.image_name << " localized "
+              << num_localized_views << " views.";
+    }
+  }
+
+  StartBundleAdjustmentIfNeeded();
+}
+
+ViewId OnlineReconstructionBuilder::AddView(const ImageToProcess& image) {
+  std::lock_guard<std::mutex> lock(reconstruction_mutex_);
+  const ViewId view_id =
+      image.camera_intrinsics_group == kInvalidCameraIntrinsicsGroupId
+          ? reconstruction_->AddView(image.image_name, image.timestamp)
+          : reconstruction_->AddView(image.image_name,
+                                     image.camera_intrinsics_group,
+                                     image.timestamp);
+  if (view_id == kInvalidViewId) {
+    return kInvalidViewId;
+  }
+
+  // Views of an existing intrinsics group share the (possibly already
+  // optimized) intrinsics of the group, so only the intrinsics of a new group
+  // are set from the prior.
+  View* view = reconstruction_->MutableView(view_id);
+  view->SetCameraIntrinsicsPrior(image.camera_intrinsics_prior);
+  const CameraIntrinsicsGroupId group_id =
+      reconstruction_->CameraIntrinsicsGroupIdFromViewId(view_id);
+  if (reconstruction_->GetViewsInCameraIntrinsicGroup(group_id).size() == 1) {
+    view->MutableCamera()->SetFromCameraIntrinsicsPriors(
+        image.camera_intrinsics_prior);
+  }
+  return view_id;
+}
+
+std::vector<std::pair<std::string, std::string> >
+OnlineReconstructionBuilder::MatchImage(const ImageToProcess& image) {
+  // The candidates are the most recent images and the images retrieved with
+  // the vocabulary tree.
+  std::unordered_set<std::string> candidates;
+  const int num_sequential_images =
+      std::min(options_.num_sequential_images_to_match,
+               static_cast<int>(image_names_.size()));
+  for (int i = image_names_.size() - num_sequential_images;
+       i < image_names_.size();
+       i++) {
+    candidates.emplace(image_names_[i]);
+  }
+
+  if (options_.vocabulary_tree != nullptr) {
+    const std::vector<Eigen::VectorXf> descriptors =
+        image.features->GetDescriptors();
+    if (options_.num_retrieved_images_to_match > 0 &&
+        options_.vocabulary_tree->NumImages() > 0) {
+      std::vector<std::pair<float, int> > retrieved_images;
+      options_.vocabulary_tree->Query(descriptors,
+                                      options_.num_retrieved_images_to_match,
+                                      &retrieved_images);
+      for (const auto& retrieved_image : retrieved_images) {
+        candidates.emplace(image_names_[retrieved_image.second]);
+      }
+    }
+    // The images are indexed by their position in image_names_.
+    options_.vocabulary_tree->AddImage(image_names_.size(), descriptors);
+  }
+
+  matcher_->AddImage(image.image_name);
+  if (candidates.empty()) {
+    return {};
+  }
+
+  std::vector<std::pair<std::string, std::string> > pairs_to_match;
+  pairs_to_match.reserve(candidates.size());
+  for (const std::string& candidate : candidates) {
+    pairs_to_match.emplace_back(candidate, image.image_name);
+  }
+  matcher_->SetImagePairsToMatch(pairs_to_match);
+  matcher_->MatchImages();
+
+  // The database only tells which pairs were matched through the list of all
+  // matches.
+  std::vector<std::pair<std::string, std::string> > matched_pairs;
+  for (const auto& pair :
+       features_and_matches_database_->ImageNamesOfMatches()) {
+    if ((pair.first == image.image_name &&
+         ContainsKey(candidates, pair.second)) ||
+        (pair.second == image.image_name &&
+         ContainsKey(candidates, pair.first))) {
+      matched_pairs.emplace_back(pair);
+    }
+  }
+  return matched_pairs;
+}
+
+void OnlineReconstructionBuilder::AddMatches(
+    const std::vector<std::pair<std::string, std::string> >& matched_pairs) {
+  for (const auto& pair : matched_pairs) {
+    const ImagePairMatch match =
+        features_and_matches_database_->GetImagePairMatch(pair.first,
+                                                          pair.second);
+    const ViewId view_id1 = reconstruction_->ViewIdFromName(pair.first);
+    const ViewId view_id2 = reconstruction_->ViewIdFromName(pair.second);
+    CHECK_NE(view_id1, kInvalidViewId);
+    CHECK_NE(view_id2, kInvalidViewId);
+
+    // The view graph requires the two view info to specify the transformation
+    // from the smaller view id to the larger view id.
+    TwoViewInfo twoview_info = match.twoview_info;
+    if (view_id1 > view_id2) {
+      SwapCameras(&twoview_info);
+    }
+    view_graph_->AddEdge(view_id1, view_id2, twoview_info);
+
+    for (const auto& correspondence : match.correspondences) {
+      track_builder_->AddFeatureCorrespondence(view_id1,
+                                               correspondence.feature1,
+                                               view_id2,
+                                               correspondence.feature2);
+    }
+  }
+  track_builder_->BuildTracksIncremental(reconstruction_.get());
+}
+
+bool OnlineReconstructionBuilder::InitializeReconstruction() {
+  if (view_graph_->NumViews() < 2) {
+    return false;
+  }
+
+  IncrementalReconstructionEstimator estimator(
+      options_.reconstruction_estimator_options);
+  const ReconstructionEstimatorSummary summary =
+      estimator.Estimate(view_graph_.get(), reconstruction_.get());
+  if (!summary.success || summary.estimated_views.size() < 2) {
+    // Try again from scratch once more images are matched.
+    SetReconstructionAsUnestimated(reconstruction_.get());
+    return false;
+  }
+
+  LOG(INFO) << "Initialized the online reconstruction with "
+            << summary.estimated_views.size() << " views and "
+            << summary.estimated_tracks.size() << " tracks.";
+  for (const ViewId view_id : reconstruction_->ViewIds()) {
+    if (!reconstruction_->View(view_id)->IsEstimated()) {
+      unlocalized_views_.emplace(view_id, 0);
+    }
+  }
+  // The incremental reconstruction estimator ends with bundle adjustment.
+  num_localized_views_since_bundle_adjustment_ = 0;
+  return true;
+}
+
+int OnlineReconstructionBuilder::LocalizeViews(const ViewId view_id) {
+  unlocalized_views_.emplace(view_id, 0);
+
+  // The tracks triangulated from a newly localized view may allow views that
+  // could not be localized before to be localized, so the views are retried
+  // until no more views can be localized.
+  int num_localized_views = 0;
+  bool localized_view = true;
+  while (localized_view) {
+    localized_view = false;
+    for (auto it = unlocalized_views_.begin();
+         it != unlocalized_views_.end();) {
+      if (LocalizeView(it->first)) {
+        ++num_localized_views;
+        localized_view = true;
+        it = unlocalized_views_.erase(it);
+      } else if (++it->second >= options_.max_num_localization_attempts) {
+        it = unlocalized_views_.erase(it);
+      } else {
+        ++it;
+      }
+    }
+  }
+  return num_localized_views;
+}
+
+bool OnlineReconstructionBuilder::LocalizeView(const ViewId view_id) {
+  RansacSummary unused_ransac_summary;
+  if (!LocalizeViewToReconstruction(view_id,
+                                    localization_options_,
+                                    reconstruction_.get(),
+                                    &unused_ransac_summary)) {
+    return false;
+  }
+
+  // Remove the tracks that do not agree with the new view, then estimate the
+  // tracks that the view observes.
+  const std::vector<TrackId>& track_ids =
+      reconstruction_->View(view_id)->TrackIds();
+  const std::unordered_set<TrackId> tracks_in_view(track_ids.begin(),
+                                                   track_ids.end());
+  SetOutlierTracksToUnestimated(
+      tracks_in_view,
+      triangulation_options_.max_acceptable_reprojection_error_pixels,
+      triangulation_options_.min_triangulation_angle_degrees,
+      options_.num_threads,
+      reconstruction_.get());
+  TrackEstimator track_estimator(
+      triangulation_options_, reconstruction_.get(), thread_pool_.get());
+  track_estimator.EstimateTracks(tracks_in_view);
+
+  ++num_localized_views_since_bundle_adjustment_;
+  return true;
+}
+
+void OnlineReconstructionBuilder::StartBundleAdjustmentIfNeeded() {
+  if (options_.full_bundle_adjustment_interval == 0 ||
+      num_localized_views_since_bundle_adjustment_ <
+          options_.full_bundle_adjustment_interval) {
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(state_mutex_);
+    if (is_bundle_adjusting_) {
+      return;
+    }
+    is_bundle_adjusting_ = true;
+  }
+  if (bundle_adjustment_thread_.joinable()) {
+    bundle_adjustment_thread_.join();
+  }
+
+  std::unique_ptr<Reconstruction> snapshot(new Reconstruction());
+  GetSnapshot(snapshot.get());
+  num_localized_views_since_bundle_adjustment_ = 0;
+  bundle_adjustment_thread_ =
+      std::thread(&OnlineReconstructionBuilder::BundleAdjustSnapshot,
+                  this,
+                  std::move(snapshot));
+}
+
+void OnlineReconstructionBuilder::BundleAdjustSnapshot(
+    std::unique_ptr<Reconstruction> snapshot) {
+  const ReconstructionEstimatorOptions& estimator_options =
+      options_.reconstruction_estimator_options;
+  BundleAdjustmentOptions ba_options = SetBundleAdjustmentOptions(
+      estimator_options, theia::NumEstimatedViews(*snapshot));
+  ba_options.use_inner_iterations = false;
+  const BundleAdjustmentSummary summary =
+      BundleAdjustReconstruction(ba_options, snapshot.get());
+  if (summary.success) {
+    SetOutlierTracksToUnestimated(
+        estimator_options.max_reprojection_error_in_pixels,
+        estimator_options.min_triangulation_angle_degrees,
+        options_.num_threads,
+        snapshot.get());
+
+    std::lock_guard<std::mutex> lock(reconstruction_mutex_);
+    MergeBundleAdjustedSnapshot(*snapshot);
+  } else {
+    LOG(WARNING) << "Bundle adjustment of the online reconstruction failed.";
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(state_mutex_);
+    is_bundle_adjusting_ = false;
+  }
+  idle_condition_.notify_all();
+}
+
+void OnlineReconstructionBuilder::MergeBundleAdjustedSnapshot(
+    const Reconstruction& snapshot) {
+  // Copy the optimized poses. The views that were localized while the snapshot
+  // was optimized are re-localized to the optimized points below.
+  std::vector<ViewId> views_to_relocalize;
+  for (const ViewId view_id : reconstruction_->ViewIds()) {
+    View* view = reconstruction_->MutableView(view_id);
+    if (!view->IsEstimated()) {
+      continue;
+    }
+    const View* optimized_view = snapshot.View(view_id);
+    if (optimized_view == nullptr || !optimized_view->IsEstimated()) {
+      views_to_relocalize.emplace_back(view_id);
+      continue;
+    }
+    std::copy(optimized_view->Camera().extrinsics(),
+              optimized_view->Camera().extrinsics() + Camera::kExtrinsicsSize,
+              view->MutableCamera()->mutable_extrinsics());
+  }
+
+  // Copy the optimized intrinsics of each intrinsics group.
+  for (const CameraIntrinsicsGroupId group_id :
+       snapshot.CameraIntrinsicsGroupIds()) {
+    const auto view_ids = snapshot.GetViewsInCameraIntrinsicGroup(group_id);
+    if (view_ids.empty()) {
+      continue;
+    }
+    const Camera& optimized_camera = snapshot.View(*view_ids.begin())->Camera();
+    Camera* camera =
+        reconstruction_->MutableView(*view_ids.begin())->MutableCamera();
+    std::copy(optimized_camera.intrinsics(),
+              optimized_camera.intrinsics() +
+                  optimized_camera.CameraIntrinsics()->NumParameters(),
+              camera->mutable_intrinsics());
+  }
+
+  // Copy the optimized points. Tracks that were triangulated from views that
+  // were localized in the meantime are estimated again.
+  std::unordered_set<TrackId> tracks_to_estimate;
+  for (const TrackId track_id : reconstruction_->TrackIds()) {
+    Track* track = reconstruction_->MutableTrack(track_id);
+    if (!track->IsEstimated()) {
+      continue;
+    }
+    const Track* optimized_track = snapshot.Track(track_id);
+    if (optimized_track == nullptr || !optimized_track->IsEstimated()) {
+      track->SetEstimated(false);
+      tracks_to_estimate.emplace(track_id);
+      continue;
+    }
+    track->SetPoint(optimized_track->Point());
+  }
+
+  if (!views_to_relocalize.empty()) {
+    BundleAdjustViews(localization_options_.ba_options,
+                      views_to_relocalize,
+                      reconstruction_.get());
+    for (const ViewId view_id : views_to_relocalize) {
+      const std::vector<TrackId>& track_ids =
+          reconstruction_->View(view_id)->TrackIds();
+      tracks_to_estimate.insert(track_ids.begin(), track_ids.end());
+    }
+  }
+  TrackEstimator track_estimator(triangulation_options_, reconstruction_.get());
+  track_estimator.EstimateTracks(tracks_to_estimate);
+  VLOG(1) << "Merged the bundle adjusted reconstruction and re-localized "
+          << views_to_relocalize.size() << " views.";
+}
+
+}  // namespace theia
@@ -0,0 +1,265 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#ifndef THEIA_SFM_ONLINE_RECONSTRUCTION_BUILDER_H_
+#define THEIA_SFM_ONLINE_RECONSTRUCTION_BUILDER_H_
+
+#include <condition_variable>  // NOLINT
+#include <map>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <string>
+#include <thread>  // NOLINT
+#include <utility>
+#include <vector>
+
+#include "theia/matching/create_feature_matcher.h"
+#include "theia/matching/feature_matcher_options.h"
+#include "theia/matching/keypoints_and_descriptors.h"
+#include "theia/sfm/camera_intrinsics_prior.h"
+#include "theia/sfm/estimate_track.h"
+#include "theia/sfm/localize_view_to_reconstruction.h"
+#include "theia/sfm/reconstruction_estimator_options.h"
+#include "theia/sfm/types.h"
+#include "theia/util/bounded_queue.h"
+#include "theia/util/util.h"
+
+namespace theia {
+class FeatureMatcher;
+class FeaturesAndMatchesDatabase;
+class RandomNumberGenerator;
+class Reconstruction;
+class ThreadPool;
+class TrackBuilder;
+class ViewGraph;
+class VocabularyTree;
+
+struct OnlineReconstructionBuilderOptions {
+  // The random number generator used to generate random numbers through the
+  // reconstruction building process. If this is a nullptr then the random
+  // generator will be initialized based on the current time.
+  std::shared_ptr<RandomNumberGenerator> rng;
+
+  // Number of threads used for matching, localization and triangulation.
+  int num_threads = 1;
+
+  // Maximum number of images that may wait to be processed. AddImage blocks
+  // while this many images are queued so that a fast producer is throttled
+  // instead of queueing features without bound.
+  int queue_capacity = 16;
+
+  // Minimum and maximum allowable track length.
+  int min_track_length = 2;
+  int max_track_length = 50;
+
+  // Minimum number of geometrically verified inliers that a view pair must have
+  // in order to be considered a good match.
+  int min_num_inlier_matches = 30;
+
+  // Matching strategy type and options for computing matches between images.
+  // See //theia/matching/create_feature_matcher.h
+  MatchingStrategy matching_strategy = MatchingStrategy::BRUTE_FORCE;
+  FeatureMatcherOptions matching_options;
+
+  // Each new image is matched to this many of the images that were added right
+  // before it, which covers the overlap of consecutive frames of a video or
+  // drone feed.
+  int num_sequential_images_to_match = 10;
+
+  // If set, each new image is also matched to the num_retrieved_images_to_match
+  // most similar earlier images according to this vocabulary tree, which
+  // closes loops when the camera revisits a part of the scene. The tree must
+  // already be trained; its inverted file is filled with the added images.
+  std::shared_ptr<VocabularyTree> vocabulary_tree;
+  int num_retrieved_images_to_match = 10;
+
+  // Views that cannot be localized when they are added are retried whenever
+  // another view is localized, up to this many times.
+  int max_num_localization_attempts = 5;
+
+  // After this many views have been localized since the last bundle
+  // adjustment, the whole reconstruction is bundle adjusted in the background.
+  // A value of 0 disables bundle adjustment of the whole reconstruction.
+  int full_bundle_adjustment_interval = 20;
+
+  // Options for initializing the reconstruction with the incremental
+  // reconstruction estimator and for the localization, triangulation and
+  // bundle adjustment of the views added afterwards.
+  // See //theia/sfm/reconstruction_estimator_options.h
+  ReconstructionEstimatorOptions reconstruction_estimator_options;
+};
+
+// Builds a reconstruction from a stream of images, e.g. the frames of a drone
+// feed, while the images are still being added. AddImage queues the features
+// of an image and returns; a worker thread then processes the images in order:
+//
+//   1) The image is matched to the last num_sequential_images_to_match images
+//      and to the images retrieved with the vocabulary tree, if any.
+//   2) The verified matches are added to the view graph and the tracks are
+//      extended with them.
+//   3) Until the reconstruction is initialized, the incremental reconstruction
+//      estimator is run on all views. Afterwards the new view is localized to
+//      the estimated tracks and its tracks are triangulated. Views that could
+//      not be localized are retried once more tracks are estimated.
+//   4) Every full_bundle_adjustment_interval localized views, a copy of the
+//      reconstruction is bundle adjusted in a background thread while new
+//      images keep being processed. The optimized poses, intrinsics and points
+//      are then merged back, and the views localized in the meantime are
+//      re-localized to the optimized points.
+//
+// GetSnapshot may be called at any time from any thread and returns a
+// consistent copy of the live reconstruction.
+class OnlineReconstructionBuilder {
+ public:
+  OnlineReconstructionBuilder(
+      const OnlineReconstructionBuilderOptions& options,
+      FeaturesAndMatchesDatabase* features_and_matches_database);
+
+  // Stops the builder, see Stop.
+  ~OnlineReconstructionBuilder();
+
+  // Queues an image with its features for processing. The features are stored
+  // in the features and matches database before they are matched. Blocks while
+  // the queue is full and returns false if the builder was stopped.
+  bool AddImage(const std::string& image_name,
+                const double timestamp,
+                const CameraIntrinsicsPrior& camera_intrinsics_prior,
+                const KeypointsAndDescriptors& features);
+  // Same as above, but with the camera intrinsics group specified to enable
+  // shared camera intrinsics.
+  bool AddImage(const std::string& image_name,
+                const double timestamp,
+                const CameraIntrinsicsPrior& camera_intrinsics_prior,
+                const CameraIntrinsicsGroupId camera_intrinsics_group,
+                const KeypointsAndDescriptors& features);
+
+  // Blocks until all queued images are processed and the background bundle
+  // adjustment, if any, has been merged.
+  void WaitUntilIdle();
+
+  // Processes the images that are still queued, waits for the background
+  // bundle adjustment and stops the worker threads. Images added afterwards are
+  // rejected.
+  void Stop();
+
+  // Copies the current state of the reconstruction. The intrinsics of the copy
+  // are not shared with the live reconstruction.
+  void GetSnapshot(Reconstruction* reconstruction) const;
+
+  // Number of views and estimated views in the live reconstruction.
+  int NumViews() const;
+  int NumEstimatedViews() const;
+
+ private:
+  struct ImageToProcess {
+    std::string image_name;
+    double timestamp;
+    CameraIntrinsicsPrior camera_intrinsics_prior;
+    CameraIntrinsicsGroupId camera_intrinsics_group;
+    std::shared_ptr<KeypointsAndDescriptors> features;
+  };
+
+  // Processes the queued images until the queue is closed.
+  void ProcessImages();
+  void ProcessImage(const ImageToProcess& image);
+
+  // Adds the view of the image to the reconstruction. Returns kInvalidViewId if
+  // the view could not be added.
+  ViewId AddView(const ImageToProcess& image);
+
+  // Matches the image to the candidate images and returns the image pairs that
+  // were successfully matched.
+  std::vector<std::pair<std::string, std::string> > MatchImage(
+      const ImageToProcess& image);
+
+  // Adds the matches to the view graph and extends the tracks with them.
+  void AddMatches(
+      const std::vector<std::pair<std::string, std::string> >& matched_pairs);
+
+  // Attempts to initialize the reconstruction with the incremental
+  // reconstruction estimator. Returns true if the reconstruction is
+  // initialized.
+  bool InitializeReconstruction();
+
+  // Localizes the view, triangulates its tracks and retries the views that
+  // could not be localized before. Returns the number of localized views.
+  int LocalizeViews(const ViewId view_id);
+  bool LocalizeView(const ViewId view_id);
+
+  // Starts the background bundle adjustment if enough views were localized
+  // since the last one.
+  void StartBundleAdjustmentIfNeeded();
+
+  // Bundle adjusts the snapshot and merges it into the live reconstruction.
+  void BundleAdjustSnapshot(std::unique_ptr<Reconstruction> snapshot);
+  void MergeBundleAdjustedSnapshot(const Reconstruction& snapshot);
+
+  OnlineReconstructionBuilderOptions options_;
+  FeaturesAndMatchesDatabase* features_and_matches_database_;
+  std::unique_ptr<FeatureMatcher> matcher_;
+  std::unique_ptr<ThreadPool> thread_pool_;
+  LocalizeViewToReconstructionOptions localization_options_;
+  TrackEstimator::Options triangulation_options_;
+
+  // SfM objects. The reconstruction is guarded by reconstruction_mutex_ since
+  // it is read by GetSnapshot and merged into by the bundle adjustment thread.
+  std::unique_ptr<Reconstruction> reconstruction_;
+  std::unique_ptr<ViewGraph> view_graph_;
+  std::unique_ptr<TrackBuilder> track_builder_;
+  mutable std::mutex reconstruction_mutex_;
+
+  // The state of the worker thread.
+  std::vector<std::string> image_names_;
+  bool is_initialized_;
+  // The number of localization attempts of each view that is not localized.
+  std::map<ViewId, int> unlocalized_views_;
+  int num_localized_views_since_bundle_adjustment_;
+
+  // The images are handed to the worker thread through the queue. The number
+  // of images that are queued or being processed and whether the background
+  // bundle adjustment is running are guarded by state_mutex_.
+  BoundedQueue<ImageToProcess> image_queue_;
+  std::thread worker_;
+  std::thread bundle_adjustment_thread_;
+  std::mutex state_mutex_;
+  std::condition_variable idle_condition_;
+  int num_unprocessed_images_;
+  bool is_bundle_adjusting_;
+  bool is_stopped_;
+
+  DISALLOW_COPY_AND_ASSIGN(OnlineReconstructionBuilder);
+};
+}  // namespace theia
+
+#endif  // THEIA_SFM_ONLINE_RECONSTRUCTION_BUILDER_H_
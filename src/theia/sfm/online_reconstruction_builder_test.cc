@@ -0,0 +1,156 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#include <Eigen/Core>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "theia/image/keypoint_detector/keypoint.h"
+#include "theia/matching/in_memory_features_and_matches_database.h"
+#include "theia/matching/keypoints_and_descriptors.h"
+#include "theia/sfm/camera_intrinsics_prior.h"
+#include "theia/sfm/online_reconstruction_builder.h"
+#include "theia/sfm/reconstruction.h"
+#include "theia/sfm/types.h"
+#include "theia/util/random.h"
+#include "theia/util/stringprintf.h"
+
+namespace theia {
+
+namespace {
+
+static const int kNumImages = 6;
+static const int kNumFeatures = 100;
+static const int kDescriptorDimension = 32;
+
+// Returns the same random features for every image so that all image pairs
+// match.
+KeypointsAndDescriptors RandomFeatures(RandomNumberGenerator* rng) {
+  KeypointsAndDescriptors features;
+  std::vector<Eigen::VectorXf> descriptors(kNumFeatures);
+  for (int i = 0; i < kNumFeatures; i++) {
+    features.keypoints.emplace_back(
+        rng->RandDouble(0, 1000), rng->RandDouble(0, 1000), Keypoint::OTHER);
+    descriptors[i].resize(kDescriptorDimension);
+    rng->SetRandom(&descriptors[i]);
+    descriptors[i].normalize();
+  }
+  features.SetDescriptors(descriptors);
+  return features;
+}
+
+OnlineReconstructionBuilderOptions MatchingOptions(
+    const int num_sequential_images_to_match) {
+  OnlineReconstructionBuilderOptions options;
+  options.rng = std::make_shared<RandomNumberGenerator>(52);
+  options.num_sequential_images_to_match = num_sequential_images_to_match;
+  options.matching_options.min_num_feature_matches = 0;
+  options.matching_options.perform_geometric_verification = false;
+  return options;
+}
+
+}  // namespace
+
+TEST(OnlineReconstructionBuilder, ImagesAreAddedAsViews) {
+  RandomNumberGenerator rng(52);
+  const KeypointsAndDescriptors features = RandomFeatures(&rng);
+  InMemoryFeaturesAndMatchesDatabase database;
+  OnlineReconstructionBuilder builder(MatchingOptions(0), &database);
+  for (int i = 0; i < kNumImages; i++) {
+    EXPECT_TRUE(builder.AddImage(
+        StringPrintf("%d.jpg", i), i, CameraIntrinsicsPrior(), features));
+  }
+  builder.WaitUntilIdle();
+
+  EXPECT_EQ(builder.NumViews(), kNumImages);
+  EXPECT_EQ(builder.NumEstimatedViews(), 0);
+  EXPECT_EQ(database.NumImages(), kNumImages);
+  EXPECT_EQ(database.NumMatches(), 0);
+
+  Reconstruction snapshot;
+  builder.GetSnapshot(&snapshot);
+  EXPECT_EQ(snapshot.NumViews(), kNumImages);
+  for (int i = 0; i < kNumImages; i++) {
+    EXPECT_NE(snapshot.ViewIdFromName(StringPrintf("%d.jpg", i)),
+              kInvalidViewId);
+  }
+}
+
+TEST(OnlineReconstructionBuilder, MatchesRecentImages) {
+  RandomNumberGenerator rng(52);
+  const KeypointsAndDescriptors features = RandomFeatures(&rng);
+
+  // Each image is only matched to the image before it.
+  InMemoryFeaturesAndMatchesDatabase sequential_database;
+  OnlineReconstructionBuilder sequential_builder(MatchingOptions(1),
+                                                 &sequential_database);
+  for (int i = 0; i < kNumImages; i++) {
+    sequential_builder.AddImage(
+        StringPrintf("%d.jpg", i), i, CameraIntrinsicsPrior(), features);
+  }
+  sequential_builder.WaitUntilIdle();
+  EXPECT_EQ(sequential_database.NumMatches(), kNumImages - 1);
+
+  // Each image is matched to all images before it.
+  InMemoryFeaturesAndMatchesDatabase exhaustive_database;
+  OnlineReconstructionBuilder exhaustive_builder(MatchingOptions(kNumImages),
+                                                 &exhaustive_database);
+  for (int i = 0; i < kNumImages; i++) {
+    exhaustive_builder.AddImage(
+        StringPrintf("%d.jpg", i), i, CameraIntrinsicsPrior(), features);
+  }
+  exhaustive_builder.WaitUntilIdle();
+  EXPECT_EQ(exhaustive_database.NumMatches(),
+            kNumImages * (kNumImages - 1) / 2);
+}
+
+TEST(OnlineReconstructionBuilder, AddImageFailsAfterStop) {
+  RandomNumberGenerator rng(52);
+  const KeypointsAndDescriptors features = RandomFeatures(&rng);
+  InMemoryFeaturesAndMatchesDatabase database;
+  OnlineReconstructionBuilder builder(MatchingOptions(0), &database);
+  EXPECT_TRUE(
+      builder.AddImage("0.jpg", 0, CameraIntrinsicsPrior(), features));
+  builder.Stop();
+
+  // The queued image is processed before the builder stops.
+  EXPECT_EQ(builder.NumViews(), 1);
+  EXPECT_FALSE(
+      builder.AddImage("1.jpg", 1, CameraIntrinsicsPrior(), features));
+  EXPECT_EQ(builder.NumViews(), 1);
+}
+
+}  // namespace theia
@@ -0,0 +1,594 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#include "theia/sfm/paged_track_store.h"
+
+#include <Eigen/Core>
+#include <Eigen/Geometry>
+#include <cereal/archives/portable_binary.hpp>
+#include <cereal/types/vector.hpp>
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>  // NOLINT
+#include <map>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <sstream>  // NOLINT
+#include <string>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "theia/sfm/feature.h"
+#include "theia/sfm/reconstruction.h"
+#include "theia/sfm/sort_tracks_spatially.h"
+#include "theia/sfm/track.h"
+#include "theia/sfm/types.h"
+#include "theia/sfm/view.h"
+#include "theia/util/metrics.h"
+
+namespace theia {
+
+namespace {
+
+// The number of values of each feature: the point, the covariance, the depth
+// prior and its variance.
+static const int kFeatureSize = 8;
+
+}  // namespace
+
+// The tracks of a chunk, stored column by column in increasing order of their
+// ids.
+struct PagedTrackStore::Chunk {
+  std::vector<TrackId> track_ids;
+  std::vector<double> points;
+  std::vector<double> reference_bearings;
+  std::vector<double> inverse_depths;
+  std::vector<uint8_t> colors;
+  std::vector<uint8_t> is_estimated;
+  // The observations of track i are those in
+  // [observation_offsets[i], observation_offsets[i + 1]).
+  std::vector<uint32_t> observation_offsets = std::vector<uint32_t>(1, 0);
+  std::vector<ViewId> observation_view_ids;
+  std::vector<double> features;
+
+  int NumTracks() const { return track_ids.size(); }
+
+  // Returns the index of the track in the chunk, or -1.
+  int Find(const TrackId track_id) const {
+    const auto it =
+        std::lower_bound(track_ids.begin(), track_ids.end(), track_id);
+    if (it == track_ids.end() || *it != track_id) {
+      return -1;
+    }
+    return std::distance(track_ids.begin(), it);
+  }
+
+  // Appends the track of the reconstruction. Tracks must be appended in
+  // increasing order of their ids.
+  void AddTrack(const TrackId track_id, const Reconstruction& reconstruction) {
+    const Track& track = *reconstruction.Track(track_id);
+    track_ids.emplace_back(track_id);
+    points.insert(points.end(), track.Point().data(), track.Point().data() + 4);
+    reference_bearings.insert(reference_bearings.end(),
+                              track.ReferenceBearingVector().data(),
+                              track.ReferenceBearingVector().data() + 3);
+    inverse_depths.emplace_back(track.InverseDepth());
+    colors.insert(colors.end(), track.Color().data(), track.Color().data() + 3);
+    is_estimated.emplace_back(track.IsEstimated() ? 1 : 0);
+
+    // The reference view is stored first since the first view that is added
+    // to a track becomes its reference view.
+    std::vector<ViewId> view_ids(track.ViewIds().begin(),
+                                 track.ViewIds().end());
+    const auto reference_view = std::find(
+        view_ids.begin(), view_ids.end(), track.ReferenceViewId());
+    if (reference_view != view_ids.end()) {
+      std::rotate(view_ids.begin(), reference_view, reference_view + 1);
+    }
+    for (const ViewId view_id : view_ids) {
+      const Feature& feature =
+          *reconstruction.View(view_id)->GetFeature(track_id);
+      observation_view_ids.emplace_back(view_id);
+      features.insert(
+          features.end(), feature.point_.data(), feature.point_.data() + 2);
+      features.insert(features.end(),
+                      feature.covariance_.data(),
+                      feature.covariance_.data() + 4);
+      features.emplace_back(feature.depth_prior_);
+      features.emplace_back(feature.depth_prior_variance_);
+    }
+    observation_offsets.emplace_back(observation_view_ids.size());
+  }
+
+  // Appends the track at the index of the other chunk.
+  void CopyTrack(const Chunk& other, const int index) {
+    track_ids.emplace_back(other.track_ids[index]);
+    points.insert(points.end(),
+                  other.points.begin() + 4 * index,
+                  other.points.begin() + 4 * (index + 1));
+    reference_bearings.insert(
+        reference_bearings.end(),
+        other.reference_bearings.begin() + 3 * index,
+        other.reference_bearings.begin() + 3 * (index + 1));
+    inverse_depths.emplace_back(other.inverse_depths[index]);
+    colors.insert(colors.end(),
+                  other.colors.begin() + 3 * index,
+                  other.colors.begin() + 3 * (index + 1));
+    is_estimated.emplace_back(other.is_estimated[index]);
+
+    const uint32_t begin = other.observation_offsets[index];
+    const uint32_t end = other.observation_offsets[index + 1];
+    observation_view_ids.insert(observation_view_ids.end(),
+                                other.observation_view_ids.begin() + begin,
+                                other.observation_view_ids.begin() + end);
+    features.insert(features.end(),
+                    other.features.begin() + kFeatureSize * begin,
+                    other.features.begin() + kFeatureSize * end);
+    observation_offsets.emplace_back(observation_view_ids.size());
+  }
+
+  // Adds the track at the index to the reconstruction and returns the number
+  // of observations that were skipped because their view does not exist.
+  int AddToReconstruction(const int index,
+                          Reconstruction* reconstruction) const {
+    const TrackId track_id = track_ids[index];
+    reconstruction->AddTrack(track_id);
+
+    int num_skipped_observations = 0;
+    for (uint32_t i = observation_offsets[index];
+         i < observation_offsets[index + 1];
+         i++) {
+      if (reconstruction->View(observation_view_ids[i]) == nullptr) {
+        ++num_skipped_observations;
+        continue;
+      }
+      const double* values = features.data() + kFeatureSize * i;
+      const Feature feature(Eigen::Map<const Eigen::Vector2d>(values),
+                            Eigen::Map<const Eigen::Matrix2d>(values + 2),
+                            values[6],
+                            values[7]);
+      reconstruction->AddObservation(
+          observation_view_ids[i], track_id, feature);
+    }
+
+    Track* track = reconstruction->MutableTrack(track_id);
+    track->SetPoint(Eigen::Map<const Eigen::Vector4d>(&points[4 * index]));
+    track->SetReferenceBearingVector(
+        Eigen::Map<const Eigen::Vector3d>(&reference_bearings[3 * index]));
+    track->SetInverseDepth(inverse_depths[index]);
+    track->SetColor(
+        Eigen::Map<const Eigen::Matrix<uint8_t, 3, 1> >(&colors[3 * index]));
+    track->SetEstimated(is_estimated[index] != 0);
+    return num_skipped_observations;
+  }
+
+  // The bounding box of the finite points.
+  Eigen::AlignedBox3d Bounds() const {
+    Eigen::AlignedBox3d bounds;
+    for (int i = 0; i < NumTracks(); i++) {
+      const Eigen::Map<const Eigen::Vector4d> point(&points[4 * i]);
+      if (IsFinitePoint(point)) {
+        bounds.extend(point.hnormalized());
+      }
+    }
+    return bounds;
+  }
+
+  template <class Archive>
+  void serialize(Archive& ar) {  // NOLINT
+    ar(track_ids,
+       points,
+       reference_bearings,
+       inverse_depths,
+       colors,
+       is_estimated,
+       observation_offsets,
+       observation_view_ids,
+       features);
+  }
+};
+
+PagedTrackStore::PagedTrackStore(const std::string& filepath,
+                                 const PagedTrackStoreOptions& options)
+    : filepath_(filepath),
+      options_(options),
+      file_size_(0),
+      chunk_cache_(
+          [this](const int chunk_index) {
+            return ReadChunkFromFile(chunk_index);
+          },
+          options.max_resident_chunks) {
+  CHECK_GT(options_.num_tracks_per_chunk, 0);
+}
+
+PagedTrackStore::~PagedTrackStore() {
+  if (file_.is_open()) {
+    file_.close();
+    std::remove(filepath_.c_str());
+  }
+}
+
+bool PagedTrackStore::Initialize(Reconstruction* reconstruction) {
+  CHECK_NOTNULL(reconstruction);
+  CHECK(!file_.is_open()) << "The paged track store is already initialized.";
+
+  file_.open(filepath_,
+             std::ios::in | std::ios::out | std::ios::binary |
+                 std::ios::trunc);
+  if (!file_.is_open()) {
+    LOG(ERROR) << "Could not create the track chunk file " << filepath_;
+    return false;
+  }
+
+  const std::vector<TrackId> track_ids = SortTracksSpatially(*reconstruction);
+  track_chunks_.reserve(track_ids.size());
+  for (int i = 0; i < track_ids.size(); i += options_.num_tracks_per_chunk) {
+    const int end = std::min<int>(i + options_.num_tracks_per_chunk,
+                                  track_ids.size());
+    if (!AppendChunk(std::vector<TrackId>(track_ids.begin() + i,
+                                          track_ids.begin() + end),
+                     reconstruction)) {
+      return false;
+    }
+  }
+  std::sort(track_chunks_.begin(), track_chunks_.end());
+  return true;
+}
+
+bool PagedTrackStore::Contains(const TrackId track_id) const {
+  return FindChunk(track_id) >= 0 &&
+         paged_in_tracks_.find(track_id) == paged_in_tracks_.end();
+}
+
+const Eigen::AlignedBox3d& PagedTrackStore::ChunkBounds(
+    const int chunk_index) const {
+  CHECK_GE(chunk_index, 0);
+  CHECK_LT(chunk_index, chunks_.size());
+  return chunks_[chunk_index].bounds;
+}
+
+std::vector<int> PagedTrackStore::ChunksInBox(
+    const Eigen::AlignedBox3d& box) const {
+  std::vector<int> chunk_indices;
+  for (int i = 0; i < chunks_.size(); i++) {
+    if (!chunks_[i].bounds.isEmpty() && chunks_[i].bounds.intersects(box)) {
+      chunk_indices.emplace_back(i);
+    }
+  }
+  return chunk_indices;
+}
+
+bool PagedTrackStore::ChunkTrackIds(const int chunk_index,
+                                    std::vector<TrackId>* track_ids) {
+  CHECK_NOTNULL(track_ids);
+  const std::shared_ptr<const Chunk> chunk = ReadChunk(chunk_index);
+  if (chunk == nullptr) {
+    return false;
+  }
+  *track_ids = chunk->track_ids;
+  return true;
+}
+
+bool PagedTrackStore::PageIn(const std::vector<TrackId>& track_ids,
+                             Reconstruction* reconstruction) {
+  CHECK_NOTNULL(reconstruction);
+
+  // Tracks are paged in chunk by chunk so that each chunk is read once.
+  std::map<int, std::vector<TrackId> > track_ids_by_chunk;
+  for (const TrackId track_id : track_ids) {
+    const int chunk_index = FindChunk(track_id);
+    if (chunk_index >= 0 &&
+        paged_in_tracks_.find(track_id) == paged_in_tracks_.end()) {
+      track_ids_by_chunk[chunk_index].emplace_back(track_id);
+    }
+  }
+
+  int num_skipped_observations = 0;
+  for (const auto& chunk_tracks : track_ids_by_chunk) {
+    const std::shared_ptr<const Chunk> chunk = ReadChunk(chunk_tracks.first);
+    if (chunk == nullptr) {
+      return false;
+    }
+    for (const TrackId track_id : chunk_tracks.second) {
+      const int index = chunk->Find(track_id);
+      if (index < 0 || !paged_in_tracks_.insert(track_id).second) {
+        continue;
+      }
+      if (reconstruction->Track(track_id) != nullptr) {
+        LOG(WARNING) << "Track " << track_id
+                     << " is paged out but the reconstruction contains a "
+                        "track with the same id. It is not paged in.";
+        paged_in_tracks_.erase(track_id);
+        continue;
+      }
+      num_skipped_observations +=
+          chunk->AddToReconstruction(index, reconstruction);
+    }
+  }
+
+  LOG_IF(WARNING, num_skipped_observations > 0)
+      << num_skipped_observations
+      << " observations were not paged in because their views are no longer "
+         "in the reconstruction.";
+  return true;
+}
+
+bool PagedTrackStore::PageInChunk(const int chunk_index,
+                                  Reconstruction* reconstruction,
+                                  std::vector<TrackId>* track_ids) {
+  CHECK_NOTNULL(track_ids)->clear();
+  std::vector<TrackId> chunk_track_ids;
+  if (!ChunkTrackIds(chunk_index, &chunk_track_ids)) {
+    return false;
+  }
+  for (const TrackId track_id : chunk_track_ids) {
+    if (paged_in_tracks_.find(track_id) == paged_in_tracks_.end()) {
+      track_ids->emplace_back(track_id);
+    }
+  }
+  return PageIn(*track_ids, reconstruction);
+}
+
+bool PagedTrackStore::PageOut(const std::vector<TrackId>& track_ids,
+                              Reconstruction* reconstruction) {
+  CHECK_NOTNULL(reconstruction);
+
+  std::map<int, std::vector<TrackId> > track_ids_by_chunk;
+  std::vector<TrackId> new_track_ids;
+  for (const TrackId track_id : track_ids) {
+    const int chunk_index = FindChunk(track_id);
+    if (chunk_index < 0) {
+      if (reconstruction->Track(track_id) != nullptr) {
+        new_track_ids.emplace_back(track_id);
+      }
+    } else if (paged_in_tracks_.find(track_id) != paged_in_tracks_.end()) {
+      track_ids_by_chunk[chunk_index].emplace_back(track_id);
+    }
+  }
+
+  // Each chunk is rewritten with the current state of its paged in tracks.
+  std::unordered_set<TrackId> removed_track_ids;
+  for (auto& chunk_tracks : track_ids_by_chunk) {
+    const std::shared_ptr<const Chunk> old_chunk =
+        ReadChunk(chunk_tracks.first);
+    if (old_chunk == nullptr) {
+      return false;
+    }
+
+    std::vector<TrackId>& paged_out_track_ids = chunk_tracks.second;
+    std::sort(paged_out_track_ids.begin(), paged_out_track_ids.end());
+    std::shared_ptr<Chunk> chunk(new Chunk);
+    for (int i = 0; i < old_chunk->NumTracks(); i++) {
+      const TrackId track_id = old_chunk->track_ids[i];
+      if (!std::binary_search(paged_out_track_ids.begin(),
+                              paged_out_track_ids.end(),
+                              track_id)) {
+        chunk->CopyTrack(*old_chunk, i);
+      } else if (reconstruction->Track(track_id) != nullptr) {
+        chunk->AddTrack(track_id, *reconstruction);
+      } else {
+        removed_track_ids.insert(track_id);
+      }
+    }
+    if (!WriteChunk(chunk_tracks.first, chunk)) {
+      return false;
+    }
+
+    for (const TrackId track_id : paged_out_track_ids) {
+      if (reconstruction->Track(track_id) != nullptr) {
+        reconstruction->RemoveTrack(track_id);
+      }
+      paged_in_tracks_.erase(track_id);
+    }
+  }
+
+  if (!removed_track_ids.empty()) {
+    track_chunks_.erase(
+        std::remove_if(track_chunks_.begin(),
+                       track_chunks_.end(),
+                       [&](const std::pair<TrackId, int>& track_chunk) {
+                         return removed_track_ids.count(track_chunk.first) > 0;
+                       }),
+        track_chunks_.end());
+  }
+
+  // Tracks that are new to the store are added in new chunks.
+  if (!new_track_ids.empty()) {
+    const int num_sorted_tracks = track_chunks_.size();
+    new_track_ids = SortTracksSpatially(*reconstruction, new_track_ids);
+    for (int i = 0; i < new_track_ids.size();
+         i += options_.num_tracks_per_chunk) {
+      const int end = std::min<int>(i + options_.num_tracks_per_chunk,
+                                    new_track_ids.size());
+      if (!AppendChunk(std::vector<TrackId>(new_track_ids.begin() + i,
+                                            new_track_ids.begin() + end),
+                       reconstruction)) {
+        return false;
+      }
+    }
+    std::sort(track_chunks_.begin() + num_sorted_tracks, track_chunks_.end());
+    std::inplace_merge(track_chunks_.begin(),
+                       track_chunks_.begin() + num_sorted_tracks,
+                       track_chunks_.end());
+  }
+  return true;
+}
+
+bool PagedTrackStore::ForEachChunk(
+    const std::function<void(const std::unordered_set<TrackId>&)>& function,
+    Reconstruction* reconstruction) {
+  for (int i = 0; i < chunks_.size(); i++) {
+    std::vector<TrackId> track_ids;
+    if (!PageInChunk(i, reconstruction, &track_ids)) {
+      return false;
+    }
+    function(std::unordered_set<TrackId>(track_ids.begin(), track_ids.end()));
+    if (!PageOut(track_ids, reconstruction)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+int PagedTrackStore::FindChunk(const TrackId track_id) const {
+  const auto it = std::lower_bound(
+      track_chunks_.begin(),
+      track_chunks_.end(),
+      track_id,
+      [](const std::pair<TrackId, int>& track_chunk, const TrackId track_id) {
+        return track_chunk.first < track_id;
+      });
+  if (it == track_chunks_.end() || it->first != track_id) {
+    return -1;
+  }
+  return it->second;
+}
+
+std::shared_ptr<const PagedTrackStore::Chunk> PagedTrackStore::ReadChunk(
+    const int chunk_index) {
+  CHECK_GE(chunk_index, 0);
+  CHECK_LT(chunk_index, chunks_.size());
+  const std::shared_ptr<const Chunk> chunk = chunk_cache_.Fetch(chunk_index);
+  if (chunk == nullptr) {
+    // Failed reads are not cached so that they are retried.
+    chunk_cache_.Erase(chunk_index);
+    LOG(ERROR) << "Could not read chunk " << chunk_index
+               << " of the track chunk file " << filepath_;
+  }
+  return chunk;
+}
+
+std::shared_ptr<const PagedTrackStore::Chunk>
+PagedTrackStore::ReadChunkFromFile(const int chunk_index) {
+  static Counter* const num_chunk_reads =
+      Metrics::GetCounter("theia_paged_track_chunk_reads_total",
+                          "Track chunks read from the paged track store.");
+
+  std::string data;
+  {
+    std::lock_guard<std::mutex> lock(file_mutex_);
+    const ChunkSlot& slot = chunks_[chunk_index];
+    data.resize(slot.size);
+    file_.seekg(slot.offset);
+    file_.read(&data[0], slot.size);
+    if (!file_.good()) {
+      file_.clear();
+      return nullptr;
+    }
+  }
+  num_chunk_reads->Increment();
+
+  std::shared_ptr<Chunk> chunk(new Chunk);
+  try {
+    std::istringstream input_stream(data);
+    cereal::PortableBinaryInputArchive input_archive(input_stream);
+    input_archive(*chunk);
+  } catch (const std::exception& e) {
+    LOG(ERROR) << "A track chunk is corrupt: " << e.what();
+    return nullptr;
+  }
+  return chunk;
+}
+
+bool PagedTrackStore::WriteChunk(const int chunk_index,
+                                 const std::shared_ptr<Chunk>& chunk) {
+  static Counter* const num_chunk_writes =
+      Metrics::GetCounter("theia_paged_track_chunk_writes_total",
+                          "Track chunks written to the paged track store.");
+
+  std::ostringstream output_stream;
+  {
+    cereal::PortableBinaryOutputArchive output_archive(output_stream);
+    output_archive(*chunk);
+  }
+  const std::string data = output_stream.str();
+
+  {
+    std::lock_guard<std::mutex> lock(file_mutex_);
+    ChunkSlot& slot = chunks_[chunk_index];
+    // A chunk that grew beyond its slot is moved to the end of the file with
+    // some room to grow. The old slot is not reused.
+    if (data.size() > slot.capacity) {
+      slot.offset = file_size_;
+      slot.capacity = data.size() + data.size() / 4;
+      file_size_ += slot.capacity;
+    }
+    slot.size = data.size();
+    slot.num_tracks = chunk->NumTracks();
+    slot.bounds = chunk->Bounds();
+
+    file_.seekp(slot.offset);
+    file_.write(data.data(), data.size());
+    const std::string padding(slot.capacity - slot.size, '\0');
+    file_.write(padding.data(), padding.size());
+    if (!file_.good()) {
+      LOG(ERROR) << "Could not write to the track chunk file " << filepath_;
+      file_.clear();
+      return false;
+    }
+  }
+  num_chunk_writes->Increment();
+
+  chunk_cache_.Insert(chunk_index, chunk);
+  return true;
+}
+
+bool PagedTrackStore::AppendChunk(const std::vector<TrackId>& track_ids,
+                                  Reconstruction* reconstruction) {
+  std::vector<TrackId> sorted_track_ids = track_ids;
+  std::sort(sorted_track_ids.begin(), sorted_track_ids.end());
+  std::shared_ptr<Chunk> chunk(new Chunk);
+  for (const TrackId track_id : sorted_track_ids) {
+    chunk->AddTrack(track_id, *reconstruction);
+  }
+
+  const int chunk_index = chunks_.size();
+  chunks_.emplace_back();
+  if (!WriteChunk(chunk_index, chunk)) {
+    return false;
+  }
+
+  // The caller sorts the appended entries.
+  for (const TrackId track_id : sorted_track_ids) {
+    track_chunks_.emplace_back(track_id, chunk_index);
+    reconstruction->RemoveTrack(track_id);
+    paged_in_tracks_.erase(track_id);
+  }
+  return true;
+}
+
+}  // namespace theia
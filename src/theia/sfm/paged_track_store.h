@@ -0,0 +1,204 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#ifndef THEIA_SFM_PAGED_TRACK_STORE_H_
+#define THEIA_SFM_PAGED_TRACK_STORE_H_
+
+#include <Eigen/Core>
+#include <Eigen/Geometry>
+
+#include <fstream>  // NOLINT
+#include <functional>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <string>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "theia/sfm/types.h"
+#include "theia/util/sharded_lru_cache.h"
+#include "theia/util/util.h"
+
+namespace theia {
+
+class Reconstruction;
+
+struct PagedTrackStoreOptions {
+  // The maximum number of tracks in each chunk. Tracks are paged in and out of
+  // the file a chunk at a time.
+  int num_tracks_per_chunk = 65536;
+
+  // The maximum number of decoded chunks that are kept in memory.
+  int max_resident_chunks = 8;
+};
+
+// An out-of-core store for the tracks of reconstructions that are too large to
+// keep in memory. The views stay in the reconstruction, while the tracks and
+// their observations are moved to a chunk file and only the tracks that are
+// needed are added back:
+//
+//   PagedTrackStore store("/tmp/tracks.bin");
+//   CHECK(store.Initialize(&reconstruction));
+//
+//   // Run an algorithm on all tracks, one chunk at a time.
+//   CHECK(store.ForEachChunk(
+//       [&](const std::unordered_set<TrackId>& track_ids) {
+//         SetOutlierTracksToUnestimated(
+//             track_ids, 4.0, 1.0, &reconstruction);
+//       },
+//       &reconstruction));
+//
+//   // Bundle adjust a subset of the tracks.
+//   CHECK(store.PageIn(track_ids, &reconstruction));
+//   BundleAdjustPartialReconstruction(
+//       options, view_ids, track_ids_set, &reconstruction);
+//   CHECK(store.PageOut(track_ids, &reconstruction));
+//
+// The tracks are sorted along a space-filling curve before they are split into
+// chunks, so each chunk covers a compact region of the scene and tracks that
+// are close in space are usually paged in together. The ids of the tracks are
+// preserved. The most recently used chunks are kept in memory, so paging in
+// the tracks of a region again does not read the file.
+//
+// The file is a scratch file that is removed when the store is destroyed.
+// Paging in and out is not thread-safe, since the reconstruction is not.
+class PagedTrackStore {
+ public:
+  explicit PagedTrackStore(
+      const std::string& filepath,
+      const PagedTrackStoreOptions& options = PagedTrackStoreOptions());
+  ~PagedTrackStore();
+
+  // Moves all tracks of the reconstruction and their observations to the
+  // store. The views remain in the reconstruction without the features of the
+  // tracks. Returns false if the file could not be written.
+  bool Initialize(Reconstruction* reconstruction);
+
+  // The number of tracks in the store, including those that are paged in.
+  int NumTracks() const { return track_chunks_.size(); }
+  int NumPagedInTracks() const { return paged_in_tracks_.size(); }
+  int NumChunks() const { return chunks_.size(); }
+
+  // Returns true if the track is in the store and is not paged in.
+  bool Contains(const TrackId track_id) const;
+
+  // The bounding box of the finite points of the chunk, and the chunks whose
+  // bounding box intersects the box.
+  const Eigen::AlignedBox3d& ChunkBounds(const int chunk_index) const;
+  std::vector<int> ChunksInBox(const Eigen::AlignedBox3d& box) const;
+
+  // The tracks of the chunk in increasing order of their ids.
+  bool ChunkTrackIds(const int chunk_index, std::vector<TrackId>* track_ids);
+
+  // Adds the tracks and their observations to the reconstruction with their
+  // original ids. Tracks that are not in the store or are already paged in are
+  // skipped, as are the observations of views that are no longer in the
+  // reconstruction. Returns false if a chunk could not be read.
+  bool PageIn(const std::vector<TrackId>& track_ids,
+              Reconstruction* reconstruction);
+  bool PageInChunk(const int chunk_index,
+                   Reconstruction* reconstruction,
+                   std::vector<TrackId>* track_ids);
+
+  // Writes the tracks, including any changes to their points, colors and
+  // observations, to the store and removes them from the reconstruction.
+  // Tracks that are not in the reconstruction (e.g. because they were removed
+  // as outliers) are dropped, and tracks that were added to the reconstruction
+  // after it was initialized are stored in new chunks. Returns false if the
+  // file could not be written.
+  bool PageOut(const std::vector<TrackId>& track_ids,
+               Reconstruction* reconstruction);
+
+  // Pages in the tracks of each chunk in turn, calls the function with them
+  // and pages them out again. This runs an algorithm on all tracks (e.g.
+  // outlier filtering, colorization or export) while holding only one chunk of
+  // tracks in the reconstruction.
+  bool ForEachChunk(
+      const std::function<void(const std::unordered_set<TrackId>&)>& function,
+      Reconstruction* reconstruction);
+
+  // Statistics of the cache of decoded chunks.
+  int NumCacheHits() const { return chunk_cache_.NumCacheHits(); }
+  int NumCacheMisses() const { return chunk_cache_.NumCacheMisses(); }
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(PagedTrackStore);
+
+  struct Chunk;
+
+  // The location of a chunk in the file. A rewritten chunk that does not fit
+  // into its slot is appended to the file.
+  struct ChunkSlot {
+    uint64_t offset = 0;
+    uint64_t capacity = 0;
+    uint64_t size = 0;
+    int num_tracks = 0;
+    Eigen::AlignedBox3d bounds;
+  };
+
+  // Returns the index of the chunk that stores the track, or -1.
+  int FindChunk(const TrackId track_id) const;
+
+  // Returns the chunk from the cache, reading it from the file on a cache
+  // miss. Returns nullptr if the chunk could not be read.
+  std::shared_ptr<const Chunk> ReadChunk(const int chunk_index);
+  std::shared_ptr<const Chunk> ReadChunkFromFile(const int chunk_index);
+
+  // Writes the chunk to its slot in the file and replaces the cached chunk.
+  bool WriteChunk(const int chunk_index, const std::shared_ptr<Chunk>& chunk);
+
+  // Moves the tracks of the reconstruction into a new chunk.
+  bool AppendChunk(const std::vector<TrackId>& track_ids,
+                   Reconstruction* reconstruction);
+
+  const std::string filepath_;
+  const PagedTrackStoreOptions options_;
+
+  std::mutex file_mutex_;
+  std::fstream file_;
+  uint64_t file_size_;
+
+  std::vector<ChunkSlot> chunks_;
+  // The chunk of each track, sorted by track id. The chunks keep the tracks
+  // that are paged in until they are paged out again.
+  std::vector<std::pair<TrackId, int> > track_chunks_;
+  std::unordered_set<TrackId> paged_in_tracks_;
+
+  ShardedLRUCache<int, std::shared_ptr<const Chunk> > chunk_cache_;
+};
+
+}  // namespace theia
+
+#endif  // THEIA_SFM_PAGED_TRACK_STORE_H_
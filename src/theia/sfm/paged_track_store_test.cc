@@ -0,0 +1,237 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#include <Eigen/Core>
+#include <Eigen/Geometry>
+#include <string>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "theia/sfm/feature.h"
+#include "theia/sfm/paged_track_store.h"
+#include "theia/sfm/reconstruction.h"
+#include "theia/sfm/track.h"
+#include "theia/sfm/types.h"
+#include "theia/sfm/view.h"
+#include "theia/util/filesystem.h"
+#include "theia/util/stringprintf.h"
+
+namespace theia {
+
+namespace {
+
+static const int kNumViews = 10;
+static const int kNumTracks = 1000;
+static const int kNumObservationsPerTrack = 3;
+
+std::string TestFilepath(const std::string& filename) {
+  return testing::internal::TempDir() + "/" + filename;
+}
+
+// Each track i is observed by the views i, ..., i + kNumObservationsPerTrack - 1
+// (modulo the number of views). The points lie on a 10 x 10 x 10 grid.
+void BuildReconstruction(Reconstruction* reconstruction) {
+  for (int i = 0; i < kNumViews; i++) {
+    reconstruction->AddView(StringPrintf("%d", i), i);
+  }
+  for (int i = 0; i < kNumTracks; i++) {
+    std::vector<std::pair<ViewId, Feature> > track;
+    for (int j = 0; j < kNumObservationsPerTrack; j++) {
+      track.emplace_back((i + j) % kNumViews, Feature(i, j));
+    }
+    const TrackId track_id = reconstruction->AddTrack(track);
+    Track* mutable_track = reconstruction->MutableTrack(track_id);
+    mutable_track->SetPoint(
+        Eigen::Vector4d(i % 10, (i / 10) % 10, i / 100, 1.0));
+    mutable_track->SetColor(Eigen::Matrix<uint8_t, 3, 1>(i % 256, 1, 2));
+    mutable_track->SetEstimated(true);
+  }
+}
+
+void ExpectTracksAreEqual(const Reconstruction& expected,
+                          const Reconstruction& actual,
+                          const TrackId track_id) {
+  const Track* expected_track = expected.Track(track_id);
+  const Track* actual_track = actual.Track(track_id);
+  ASSERT_NE(actual_track, nullptr);
+  EXPECT_EQ(expected_track->Point(), actual_track->Point());
+  EXPECT_EQ(expected_track->Color(), actual_track->Color());
+  EXPECT_EQ(expected_track->IsEstimated(), actual_track->IsEstimated());
+  EXPECT_EQ(expected_track->ReferenceViewId(),
+            actual_track->ReferenceViewId());
+  ASSERT_EQ(expected_track->NumViews(), actual_track->NumViews());
+  for (const ViewId view_id : expected_track->ViewIds()) {
+    const Feature* feature = actual.View(view_id)->GetFeature(track_id);
+    ASSERT_NE(feature, nullptr);
+    EXPECT_EQ(*expected.View(view_id)->GetFeature(track_id), *feature);
+  }
+}
+
+}  // namespace
+
+TEST(PagedTrackStore, PageInAndOut) {
+  Reconstruction expected;
+  BuildReconstruction(&expected);
+  Reconstruction reconstruction;
+  BuildReconstruction(&reconstruction);
+
+  PagedTrackStoreOptions options;
+  options.num_tracks_per_chunk = 100;
+  options.max_resident_chunks = 2;
+  const std::string filepath = TestFilepath("paged_track_store.bin");
+  {
+    PagedTrackStore store(filepath, options);
+    ASSERT_TRUE(store.Initialize(&reconstruction));
+    EXPECT_EQ(store.NumTracks(), kNumTracks);
+    EXPECT_EQ(store.NumChunks(), kNumTracks / options.num_tracks_per_chunk);
+    EXPECT_EQ(reconstruction.NumTracks(), 0);
+    EXPECT_EQ(reconstruction.NumViews(), kNumViews);
+    for (const ViewId view_id : reconstruction.ViewIds()) {
+      EXPECT_EQ(reconstruction.View(view_id)->NumFeatures(), 0);
+    }
+
+    // The tracks keep their ids and observations.
+    const std::vector<TrackId> track_ids = {0, 17, 500, 999};
+    ASSERT_TRUE(store.PageIn(track_ids, &reconstruction));
+    EXPECT_EQ(reconstruction.NumTracks(), track_ids.size());
+    EXPECT_EQ(store.NumPagedInTracks(), track_ids.size());
+    for (const TrackId track_id : track_ids) {
+      EXPECT_FALSE(store.Contains(track_id));
+      ExpectTracksAreEqual(expected, reconstruction, track_id);
+    }
+
+    // Changes are kept when the tracks are paged out, and removed tracks are
+    // removed from the store.
+    const Eigen::Vector4d point(1.0, 2.0, 3.0, 1.0);
+    reconstruction.MutableTrack(0)->SetPoint(point);
+    reconstruction.MutableTrack(17)->SetEstimated(false);
+    reconstruction.RemoveTrack(500);
+    ASSERT_TRUE(store.PageOut(track_ids, &reconstruction));
+    EXPECT_EQ(reconstruction.NumTracks(), 0);
+    EXPECT_EQ(store.NumTracks(), kNumTracks - 1);
+    EXPECT_TRUE(store.Contains(0));
+    EXPECT_FALSE(store.Contains(500));
+
+    ASSERT_TRUE(store.PageIn({0, 17, 500}, &reconstruction));
+    EXPECT_EQ(reconstruction.NumTracks(), 2);
+    EXPECT_EQ(reconstruction.Track(0)->Point(), point);
+    EXPECT_FALSE(reconstruction.Track(17)->IsEstimated());
+    EXPECT_EQ(reconstruction.Track(500), nullptr);
+    ASSERT_TRUE(store.PageOut({0, 17}, &reconstruction));
+    EXPECT_TRUE(FileExists(filepath));
+  }
+  // The scratch file is removed with the store.
+  EXPECT_FALSE(FileExists(filepath));
+}
+
+TEST(PagedTrackStore, ChunksAreSpatiallyCompact) {
+  Reconstruction reconstruction;
+  BuildReconstruction(&reconstruction);
+
+  PagedTrackStoreOptions options;
+  options.num_tracks_per_chunk = 125;
+  PagedTrackStore store(TestFilepath("paged_track_store_spatial.bin"),
+                        options);
+  ASSERT_TRUE(store.Initialize(&reconstruction));
+  ASSERT_EQ(store.NumChunks(), 8);
+
+  // The Morton order splits the 10 x 10 x 10 grid into its octants.
+  for (int i = 0; i < store.NumChunks(); i++) {
+    EXPECT_EQ(store.ChunkBounds(i).sizes(), Eigen::Vector3d(4.0, 4.0, 4.0));
+  }
+  const Eigen::AlignedBox3d box(Eigen::Vector3d(0.0, 0.0, 0.0),
+                                Eigen::Vector3d(1.0, 1.0, 1.0));
+  const std::vector<int> chunk_indices = store.ChunksInBox(box);
+  ASSERT_EQ(chunk_indices.size(), 1);
+
+  std::vector<TrackId> track_ids;
+  ASSERT_TRUE(
+      store.PageInChunk(chunk_indices[0], &reconstruction, &track_ids));
+  EXPECT_EQ(track_ids.size(), 125);
+  for (const TrackId track_id : track_ids) {
+    EXPECT_LE(reconstruction.Track(track_id)->Point().maxCoeff(), 4.0);
+  }
+}
+
+TEST(PagedTrackStore, ForEachChunk) {
+  Reconstruction reconstruction;
+  BuildReconstruction(&reconstruction);
+
+  PagedTrackStoreOptions options;
+  options.num_tracks_per_chunk = 64;
+  options.max_resident_chunks = 1;
+  PagedTrackStore store(TestFilepath("paged_track_store_each.bin"), options);
+  ASSERT_TRUE(store.Initialize(&reconstruction));
+
+  // Set the tracks with an even x coordinate to unestimated.
+  int num_tracks = 0;
+  ASSERT_TRUE(store.ForEachChunk(
+      [&](const std::unordered_set<TrackId>& track_ids) {
+        EXPECT_EQ(reconstruction.NumTracks(), track_ids.size());
+        num_tracks += track_ids.size();
+        for (const TrackId track_id : track_ids) {
+          Track* track = reconstruction.MutableTrack(track_id);
+          if (static_cast<int>(track->Point().x()) % 2 == 0) {
+            track->SetEstimated(false);
+          }
+        }
+      },
+      &reconstruction));
+  EXPECT_EQ(num_tracks, kNumTracks);
+  EXPECT_EQ(reconstruction.NumTracks(), 0);
+
+  // Tracks that are added to the reconstruction are paged out to a new chunk.
+  const TrackId new_track_id =
+      reconstruction.AddTrack({{0, Feature(1.0, 2.0)}, {1, Feature(3.0, 4.0)}});
+  ASSERT_TRUE(store.PageOut({new_track_id}, &reconstruction));
+  EXPECT_TRUE(store.Contains(new_track_id));
+  EXPECT_EQ(store.NumTracks(), kNumTracks + 1);
+
+  std::vector<TrackId> all_track_ids(kNumTracks);
+  for (int i = 0; i < kNumTracks; i++) {
+    all_track_ids[i] = i;
+  }
+  ASSERT_TRUE(store.PageIn(all_track_ids, &reconstruction));
+  EXPECT_EQ(reconstruction.NumTracks(), kNumTracks);
+  for (const TrackId track_id : all_track_ids) {
+    const Track* track = reconstruction.Track(track_id);
+    EXPECT_EQ(track->IsEstimated(),
+              static_cast<int>(track->Point().x()) % 2 != 0);
+  }
+}
+
+}  // namespace theia
@@ -0,0 +1,350 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#include "theia/sfm/parallel_track_builder.h"
+
+#include <Eigen/Core>
+#include <glog/logging.h>
+#include <stdint.h>
+
+#include <algorithm>
+#include <atomic>
+#include <limits>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "theia/math/graph/concurrent_union_find.h"
+#include "theia/matching/features_and_matches_database.h"
+#include "theia/matching/image_pair_match.h"
+#include "theia/matching/keypoints_and_descriptors.h"
+#include "theia/sfm/feature.h"
+#include "theia/sfm/reconstruction.h"
+#include "theia/sfm/types.h"
+#include "theia/util/executor.h"
+#include "theia/util/map_util.h"
+#include "theia/util/trace.h"
+
+namespace theia {
+
+namespace {
+
+// The keypoint locations of one view. The observations of the view are the
+// feature ids [offset, offset + points.size()), where feature id offset + i is
+// keypoint i.
+struct ViewKeypoints {
+  std::string image_name;
+  ViewId view_id = kInvalidViewId;
+  uint32_t offset = 0;
+  std::vector<Eigen::Vector2d, Eigen::aligned_allocator<Eigen::Vector2d> >
+      points;
+  // The keypoint indices sorted by location (and by index for keypoints at the
+  // same location) to find the keypoint of a correspondence.
+  std::vector<uint32_t> sorted_indices;
+};
+
+bool PointLess(const Eigen::Vector2d& point1, const Eigen::Vector2d& point2) {
+  return point1.x() < point2.x() ||
+         (point1.x() == point2.x() && point1.y() < point2.y());
+}
+
+void SetKeypoints(const std::vector<Keypoint>& keypoints,
+                  ViewKeypoints* view) {
+  view->points.resize(keypoints.size());
+  view->sorted_indices.resize(keypoints.size());
+  for (size_t i = 0; i < keypoints.size(); i++) {
+    view->points[i] << keypoints[i].x(), keypoints[i].y();
+    view->sorted_indices[i] = i;
+  }
+  const auto& points = view->points;
+  std::sort(view->sorted_indices.begin(),
+            view->sorted_indices.end(),
+            [&points](const uint32_t index1, const uint32_t index2) {
+              return PointLess(points[index1], points[index2]) ||
+                     (points[index1] == points[index2] && index1 < index2);
+            });
+}
+
+// Returns the feature id of the keypoint at the location, or false if there is
+// no keypoint at this location. If several keypoints share the location the
+// one with the smallest index is used.
+bool FindFeatureId(const ViewKeypoints& view,
+                   const Eigen::Vector2d& point,
+                   uint32_t* feature_id) {
+  const auto it = std::lower_bound(
+      view.sorted_indices.begin(),
+      view.sorted_indices.end(),
+      point,
+      [&view](const uint32_t index, const Eigen::Vector2d& point) {
+        return PointLess(view.points[index], point);
+      });
+  if (it == view.sorted_indices.end() || view.points[*it] != point) {
+    return false;
+  }
+  *feature_id = view.offset + *it;
+  return true;
+}
+
+}  // namespace
+
+ParallelTrackBuilder::ParallelTrackBuilder(const int min_track_length,
+                                           const int max_track_length,
+                                           const int num_threads)
+    : min_track_length_(min_track_length),
+      max_track_length_(max_track_length),
+      num_threads_(num_threads) {
+  CHECK_GT(min_track_length_, 0);
+  CHECK_GE(max_track_length_, min_track_length_);
+  CHECK_GT(num_threads_, 0);
+}
+
+int ParallelTrackBuilder::BuildTracks(FeaturesAndMatchesDatabase* database,
+                                      Reconstruction* reconstruction) {
+  return BuildTracks(database, nullptr, reconstruction);
+}
+
+int ParallelTrackBuilder::BuildTracks(FeaturesAndMatchesDatabase* database,
+                                      const MatchCallback& callback,
+                                      Reconstruction* reconstruction) {
+  THEIA_TRACE_SCOPE("ParallelTrackBuilder::BuildTracks");
+  CHECK_NOTNULL(database);
+  CHECK_NOTNULL(reconstruction);
+
+  // Gather the views that have features and assign a contiguous range of
+  // feature ids to the keypoints of each view. The views are sorted by view id
+  // since the database lists the images in an unspecified order, and the order
+  // of the feature ids determines the order of the tracks.
+  std::vector<ViewKeypoints> views;
+  for (const std::string& image_name : database->ImageNamesOfFeatures()) {
+    const ViewId view_id = reconstruction->ViewIdFromName(image_name);
+    if (view_id == kInvalidViewId) {
+      continue;
+    }
+    views.emplace_back();
+    views.back().image_name = image_name;
+    views.back().view_id = view_id;
+  }
+  std::sort(views.begin(),
+            views.end(),
+            [](const ViewKeypoints& lhs, const ViewKeypoints& rhs) {
+              return lhs.view_id < rhs.view_id;
+            });
+  std::unordered_map<std::string, int> image_name_to_view_index;
+  for (int i = 0; i < static_cast<int>(views.size()); i++) {
+    image_name_to_view_index.emplace(views[i].image_name, i);
+  }
+
+  ParallelFor(num_threads_,
+              views.size(),
+              [&](const int start, const int end) {
+                // Only the keypoints are read, not the descriptors.
+                for (int i = start; i < end; i++) {
+                  SetKeypoints(database->GetKeypoints(views[i].image_name),
+                               &views[i]);
+                }
+              });
+
+  uint64_t num_features = 0;
+  for (ViewKeypoints& view : views) {
+    view.offset = num_features;
+    num_features += view.points.size();
+  }
+  CHECK_LE(num_features, std::numeric_limits<int>::max())
+      << "Too many features to build tracks.";
+
+  // Merge the features of all correspondences while the matches are read from
+  // the database.
+  ConcurrentUnionFind union_find(num_features);
+  const std::vector<std::pair<std::string, std::string> > image_pairs =
+      database->ImageNamesOfMatches();
+  std::atomic<int64_t> num_ignored_correspondences(0);
+  ParallelFor(
+      num_threads_,
+      image_pairs.size(),
+      [&](const int start, const int end) {
+        int64_t num_ignored = 0;
+        for (int i = start; i < end; i++) {
+          const std::string& image_name1 = image_pairs[i].first;
+          const std::string& image_name2 = image_pairs[i].second;
+          const int* view_index1 =
+              FindOrNull(image_name_to_view_index, image_name1);
+          const int* view_index2 =
+              FindOrNull(image_name_to_view_index, image_name2);
+          if (view_index1 == nullptr || view_index2 == nullptr ||
+              *view_index1 == *view_index2) {
+            continue;
+          }
+
+          const ImagePairMatch match =
+              database->GetImagePairMatch(image_name1, image_name2);
+          if (callback && !callback(image_name1, image_name2, match)) {
+            continue;
+          }
+
+          const ViewKeypoints& view1 = views[*view_index1];
+          const ViewKeypoints& view2 = views[*view_index2];
+          for (const auto& correspondence : match.correspondences) {
+            uint32_t feature_id1, feature_id2;
+            if (!FindFeatureId(view1, correspondence.feature1.point_,
+                               &feature_id1) ||
+                !FindFeatureId(view2, correspondence.feature2.point_,
+                               &feature_id2)) {
+              ++num_ignored;
+              continue;
+            }
+            union_find.Union(feature_id1, feature_id2);
+          }
+        }
+        num_ignored_correspondences += num_ignored;
+      });
+
+  // Group the features by the root of their track. Since the root of each set
+  // is its smallest element, the tracks are ordered by their smallest feature
+  // id and the features of each track are sorted by id, i.e. by view and then
+  // by keypoint index.
+  std::vector<uint32_t> roots(num_features);
+  ParallelFor(num_threads_,
+              num_features,
+              [&](const int start, const int end) {
+                for (int i = start; i < end; i++) {
+                  roots[i] = union_find.Find(i);
+                }
+              });
+
+  std::vector<uint32_t> track_offsets(num_features + 1, 0);
+  for (const uint32_t root : roots) {
+    ++track_offsets[root + 1];
+  }
+  std::vector<uint32_t> track_roots;
+  for (uint32_t i = 0; i < num_features; i++) {
+    // Singletons are features without correspondences.
+    const int track_size = track_offsets[i + 1];
+    if (track_size > 1 && track_size >= min_track_length_) {
+      track_roots.emplace_back(i);
+    }
+    track_offsets[i + 1] += track_offsets[i];
+  }
+  std::vector<uint32_t> track_features(num_features);
+  {
+    std::vector<uint32_t> next_feature(track_offsets.begin(),
+                                       track_offsets.end() - 1);
+    for (uint32_t i = 0; i < num_features; i++) {
+      track_features[next_feature[roots[i]]++] = i;
+    }
+  }
+  roots.clear();
+  roots.shrink_to_fit();
+
+  // Resolve the tracks that observe several features in one view by keeping
+  // the first feature of each view, and discard tracks of invalid length.
+  std::vector<std::vector<std::pair<ViewId, Feature> > > tracks(
+      track_roots.size());
+  std::atomic<int64_t> num_inconsistent_features(0);
+  std::atomic<int64_t> num_small_tracks(0);
+  std::atomic<int64_t> num_large_tracks(0);
+  ParallelFor(
+      num_threads_,
+      track_roots.size(),
+      [&](const int start, const int end) {
+        int64_t num_inconsistent = 0, num_small = 0, num_large = 0;
+        for (int i = start; i < end; i++) {
+          const uint32_t root = track_roots[i];
+          auto& track = tracks[i];
+          int view_index = -1;
+          for (uint32_t j = track_offsets[root]; j < track_offsets[root + 1];
+               j++) {
+            const uint32_t feature_id = track_features[j];
+            if (view_index >= 0 &&
+                feature_id <
+                    views[view_index].offset + views[view_index].points.size()) {
+              ++num_inconsistent;
+              continue;
+            }
+            // Find the view of the feature. The features are sorted by id, so
+            // only the views after the current one need to be searched.
+            view_index = std::upper_bound(
+                             views.begin() + view_index + 1,
+                             views.end(),
+                             feature_id,
+                             [](const uint32_t id, const ViewKeypoints& view) {
+                               return id < view.offset;
+                             }) -
+                         views.begin() - 1;
+            const ViewKeypoints& view = views[view_index];
+            track.emplace_back(view.view_id,
+                               Feature(view.points[feature_id - view.offset]));
+          }
+
+          if (track.size() < static_cast<size_t>(min_track_length_)) {
+            ++num_small;
+            track.clear();
+          } else if (track.size() > static_cast<size_t>(max_track_length_)) {
+            ++num_large;
+            track.clear();
+          }
+        }
+        num_inconsistent_features += num_inconsistent;
+        num_small_tracks += num_small;
+        num_large_tracks += num_large;
+      });
+
+  // Add the tracks to the reconstruction at once so that the features of each
+  // view are added and indexed in bulk.
+  tracks.erase(
+      std::remove_if(tracks.begin(),
+                     tracks.end(),
+                     [](const std::vector<std::pair<ViewId, Feature> >& track) {
+                       return track.empty();
+                     }),
+      tracks.end());
+  const int num_tracks = tracks.size();
+  for (const TrackId track_id : reconstruction->AddTracks(tracks)) {
+    CHECK_NE(track_id, kInvalidTrackId) << "Could not build tracks.";
+  }
+
+  LOG(INFO) << num_tracks << " tracks were created from "
+            << image_pairs.size() << " image pair matches. "
+            << num_inconsistent_features
+            << " features were dropped because they formed inconsistent "
+               "tracks, "
+            << num_small_tracks << " tracks were too short, "
+            << num_large_tracks << " tracks were too long, and "
+            << num_ignored_correspondences
+            << " correspondences did not match the keypoints of their images.";
+  return num_tracks;
+}
+
+}  // namespace theia
@@ -0,0 +1,98 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#ifndef THEIA_SFM_PARALLEL_TRACK_BUILDER_H_
+#define THEIA_SFM_PARALLEL_TRACK_BUILDER_H_
+
+#include <functional>
+#include <string>
+
+namespace theia {
+
+class FeaturesAndMatchesDatabase;
+class Reconstruction;
+struct ImagePairMatch;
+
+// Builds tracks from all image pair matches stored in a
+// FeaturesAndMatchesDatabase using multiple threads. Unlike TrackBuilder, which
+// hashes the coordinates of each (view, feature) observation and merges them
+// serially, each observation is identified by the index of its keypoint in the
+// features of the image and the tracks are merged with a lock-free union-find
+// while the matches are read from the database in parallel.
+//
+// If a track observes several features in one view, only the feature with the
+// smallest keypoint index is kept. This is done in parallel for all tracks
+// once all matches are merged. Tracks observed in fewer than min_track_length
+// views are discarded. Since the size of a track is only known once all matches
+// are merged, tracks observed in more than max_track_length views are
+// discarded as well instead of being split as in TrackBuilder. The resulting
+// tracks, and the order in which they are added, do not depend on the number
+// of threads or on the order in which the database lists the images: the
+// tracks are ordered by the view id and keypoint index of their first
+// observation.
+class ParallelTrackBuilder {
+ public:
+  // Called for each image pair match after it is read from the database. The
+  // correspondences of the match are only added to the tracks if this returns
+  // true. The callback may be called from several threads at once.
+  typedef std::function<bool(const std::string& image_name1,
+                             const std::string& image_name2,
+                             const ImagePairMatch& match)>
+      MatchCallback;
+
+  ParallelTrackBuilder(const int min_track_length,
+                       const int max_track_length,
+                       const int num_threads);
+
+  // Builds tracks from all matches in the database and adds them to the
+  // reconstruction. Views are found by the image names of the database, and
+  // images without features or without a view in the reconstruction are
+  // ignored. Correspondences must use the keypoint locations of the features in
+  // the database (as the FeatureMatcher outputs them); other correspondences
+  // are ignored. Returns the number of tracks that were added.
+  int BuildTracks(FeaturesAndMatchesDatabase* database,
+                  Reconstruction* reconstruction);
+  int BuildTracks(FeaturesAndMatchesDatabase* database,
+                  const MatchCallback& callback,
+                  Reconstruction* reconstruction);
+
+ private:
+  const int min_track_length_;
+  const int max_track_length_;
+  const int num_threads_;
+};
+
+}  // namespace theia
+
+#endif  // THEIA_SFM_PARALLEL_TRACK_BUILDER_H_
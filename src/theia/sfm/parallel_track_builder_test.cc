@@ -0,0 +1,243 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#include <algorithm>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "theia/image/keypoint_detector/keypoint.h"
+#include "theia/matching/image_pair_match.h"
+#include "theia/matching/in_memory_features_and_matches_database.h"
+#include "theia/matching/keypoints_and_descriptors.h"
+#include "theia/sfm/parallel_track_builder.h"
+#include "theia/sfm/reconstruction.h"
+#include "theia/sfm/track.h"
+#include "theia/sfm/types.h"
+#include "theia/util/stringprintf.h"
+
+namespace theia {
+
+namespace {
+
+static const int kMinTrackLength = 2;
+
+// Adds kNumKeypoints keypoints at (i, i) to each image. Keypoint kNumKeypoints
+// duplicates the location of keypoint 0.
+static const int kNumKeypoints = 10;
+
+void AddViewsAndFeatures(const int num_views,
+                         InMemoryFeaturesAndMatchesDatabase* database,
+                         Reconstruction* reconstruction) {
+  for (int i = 0; i < num_views; i++) {
+    const std::string image_name = StringPrintf("%d", i);
+    KeypointsAndDescriptors features;
+    features.image_name = image_name;
+    for (int j = 0; j <= kNumKeypoints; j++) {
+      const int location = j % kNumKeypoints;
+      features.keypoints.emplace_back(location, location, Keypoint::OTHER);
+    }
+    database->PutFeatures(image_name, features);
+    reconstruction->AddView(image_name, i);
+  }
+}
+
+// Adds matches between the keypoints with the given indices of the images.
+void AddMatch(const int image1,
+              const int image2,
+              const std::vector<std::pair<int, int> >& keypoints,
+              InMemoryFeaturesAndMatchesDatabase* database) {
+  ImagePairMatch match;
+  match.image1 = StringPrintf("%d", image1);
+  match.image2 = StringPrintf("%d", image2);
+  for (const auto& keypoint : keypoints) {
+    match.correspondences.emplace_back(
+        Feature(keypoint.first, keypoint.first),
+        Feature(keypoint.second, keypoint.second));
+  }
+  database->PutImagePairMatch(match.image1, match.image2, match);
+}
+
+// Ensure that each track has been added to every view.
+void VerifyTracks(const Reconstruction& reconstruction) {
+  for (const TrackId track_id : reconstruction.TrackIds()) {
+    const Track* track = CHECK_NOTNULL(reconstruction.Track(track_id));
+    for (const ViewId view_id : track->ViewIds()) {
+      const View* view = CHECK_NOTNULL(reconstruction.View(view_id));
+      EXPECT_NE(view->GetFeature(track_id), nullptr);
+    }
+  }
+}
+
+}  // namespace
+
+TEST(ParallelTrackBuilder, ConsistentTracks) {
+  static const int kMaxTrackLength = 10;
+  InMemoryFeaturesAndMatchesDatabase database;
+  Reconstruction reconstruction;
+  AddViewsAndFeatures(3, &database, &reconstruction);
+  AddMatch(0, 1, {{0, 0}, {1, 1}}, &database);
+  AddMatch(1, 2, {{2, 2}, {3, 3}}, &database);
+
+  ParallelTrackBuilder track_builder(kMinTrackLength, kMaxTrackLength, 2);
+  EXPECT_EQ(track_builder.BuildTracks(&database, &reconstruction), 4);
+  VerifyTracks(reconstruction);
+  EXPECT_EQ(reconstruction.NumTracks(), 4);
+}
+
+TEST(ParallelTrackBuilder, MergedTracks) {
+  static const int kMaxTrackLength = 10;
+  InMemoryFeaturesAndMatchesDatabase database;
+  Reconstruction reconstruction;
+  AddViewsAndFeatures(4, &database, &reconstruction);
+  AddMatch(0, 1, {{0, 0}, {1, 1}}, &database);
+  AddMatch(1, 2, {{0, 0}}, &database);
+  AddMatch(3, 2, {{5, 0}}, &database);
+
+  ParallelTrackBuilder track_builder(kMinTrackLength, kMaxTrackLength, 2);
+  EXPECT_EQ(track_builder.BuildTracks(&database, &reconstruction), 2);
+  VerifyTracks(reconstruction);
+
+  int num_long_tracks = 0;
+  for (const TrackId track_id : reconstruction.TrackIds()) {
+    if (reconstruction.Track(track_id)->NumViews() == 4) {
+      ++num_long_tracks;
+    }
+  }
+  EXPECT_EQ(num_long_tracks, 1);
+}
+
+TEST(ParallelTrackBuilder, InconsistentTracks) {
+  static const int kMaxTrackLength = 10;
+  InMemoryFeaturesAndMatchesDatabase database;
+  Reconstruction reconstruction;
+  AddViewsAndFeatures(3, &database, &reconstruction);
+  // Keypoints 1 and 2 of view 1 end up in the same track, so only keypoint 1
+  // is kept.
+  AddMatch(0, 1, {{0, 1}}, &database);
+  AddMatch(0, 2, {{0, 3}}, &database);
+  AddMatch(2, 1, {{3, 2}}, &database);
+
+  ParallelTrackBuilder track_builder(kMinTrackLength, kMaxTrackLength, 1);
+  EXPECT_EQ(track_builder.BuildTracks(&database, &reconstruction), 1);
+  VerifyTracks(reconstruction);
+
+  const Track* track = reconstruction.Track(reconstruction.TrackIds()[0]);
+  EXPECT_EQ(track->NumViews(), 3);
+  const View* view = reconstruction.View(reconstruction.ViewIdFromName("1"));
+  EXPECT_EQ(view->GetFeature(reconstruction.TrackIds()[0])->x(), 1);
+}
+
+TEST(ParallelTrackBuilder, TrackLengthLimits) {
+  static const int kMinLongTrackLength = 3;
+  static const int kMaxTrackLength = 4;
+  InMemoryFeaturesAndMatchesDatabase database;
+  Reconstruction reconstruction;
+  AddViewsAndFeatures(6, &database, &reconstruction);
+  // Keypoint 1 is observed in two views, keypoint 2 in three views and
+  // keypoint 3 in all six views.
+  AddMatch(0, 1, {{1, 1}, {2, 2}, {3, 3}}, &database);
+  AddMatch(1, 2, {{2, 2}, {3, 3}}, &database);
+  for (int i = 2; i < 5; i++) {
+    AddMatch(i, i + 1, {{3, 3}}, &database);
+  }
+
+  ParallelTrackBuilder track_builder(kMinLongTrackLength, kMaxTrackLength, 4);
+  EXPECT_EQ(track_builder.BuildTracks(&database, &reconstruction), 1);
+  EXPECT_EQ(reconstruction.NumTracks(), 1);
+  EXPECT_EQ(reconstruction.Track(reconstruction.TrackIds()[0])->NumViews(), 3);
+}
+
+TEST(ParallelTrackBuilder, MatchCallback) {
+  static const int kMaxTrackLength = 10;
+  InMemoryFeaturesAndMatchesDatabase database;
+  Reconstruction reconstruction;
+  AddViewsAndFeatures(3, &database, &reconstruction);
+  AddMatch(0, 1, {{0, 0}}, &database);
+  AddMatch(1, 2, {{1, 1}, {4, 4}}, &database);
+  // Correspondences that are not keypoints are ignored.
+  AddMatch(0, 2, {{20, 20}}, &database);
+
+  ParallelTrackBuilder track_builder(kMinTrackLength, kMaxTrackLength, 2);
+  const auto skip_first_image = [](const std::string& image_name1,
+                                   const std::string& image_name2,
+                                   const ImagePairMatch& match) {
+    return image_name1 != "0";
+  };
+  EXPECT_EQ(
+      track_builder.BuildTracks(&database, skip_first_image, &reconstruction),
+      2);
+}
+
+TEST(ParallelTrackBuilder, TracksAreOrderedByTheirFirstObservation) {
+  static const int kMaxTrackLength = 10;
+  static const int kNumViews = 4;
+  InMemoryFeaturesAndMatchesDatabase database;
+  Reconstruction unused_reconstruction;
+  AddViewsAndFeatures(kNumViews, &database, &unused_reconstruction);
+
+  // Add the views in the reverse order of the images so that the view ids do
+  // not follow the image names.
+  Reconstruction reconstruction;
+  for (int i = kNumViews - 1; i >= 0; i--) {
+    reconstruction.AddView(StringPrintf("%d", i), i);
+  }
+  AddMatch(0, 1, {{0, 0}, {5, 5}}, &database);
+  AddMatch(1, 2, {{1, 1}}, &database);
+  AddMatch(2, 3, {{2, 2}, {6, 6}}, &database);
+
+  ParallelTrackBuilder track_builder(kMinTrackLength, kMaxTrackLength, 2);
+  EXPECT_EQ(track_builder.BuildTracks(&database, &reconstruction), 5);
+
+  std::vector<TrackId> track_ids = reconstruction.TrackIds();
+  std::sort(track_ids.begin(), track_ids.end());
+  std::pair<ViewId, Feature> previous_observation(kInvalidViewId, Feature());
+  for (const TrackId track_id : track_ids) {
+    const Track* track = reconstruction.Track(track_id);
+    const ViewId view_id =
+        *std::min_element(track->ViewIds().begin(), track->ViewIds().end());
+    const Feature& feature =
+        *reconstruction.View(view_id)->GetFeature(track_id);
+    if (previous_observation.first != kInvalidViewId) {
+      EXPECT_TRUE(previous_observation.first < view_id ||
+                  (previous_observation.first == view_id &&
+                   previous_observation.second.x() < feature.x()));
+    }
+    previous_observation = std::make_pair(view_id, feature);
+  }
+}
+
+}  // namespace theia
@@ -342,7 +342,17 @@ MatrixXd CreateMacaulayMatrix(const double a[20],
                               const double c[20],
                               const double u[4]) {
   MatrixXd macaulay_matrix(120, 120);
-  macaulay_matrix.setZero();
+  CreateMacaulayMatrix(a, b, c, u, macaulay_matrix.data());
+  return macaulay_matrix;
+}
+
+void CreateMacaulayMatrix(const double a[20],
+                          const double b[20],
+                          const double c[20],
+                          const double u[4],
+                          double* macaulay_matrix) {
+  Eigen::Map<Matrix<double, 14400, 1> > macaulay_vec(macaulay_matrix);
+  macaulay_vec.setZero();
 
   // The matrix is very large (14400 elements!) and sparse (1968 non-zero
   // elements) so we load it from pre-computed values calculated in matlab.
@@ -745,12 +755,9 @@ MatrixXd CreateMacaulayMatrix(const double a[20],
       b[18], b[7],  b[13], c[13], c[7],  c[12], c[19], c[3],  c[18], a[19],
       a[18], a[7],  b[19], b[18], b[7],  c[7],  c[19], c[18]};
 
-  Eigen::Map<Matrix<double, 14400, 1> > macaulay_vec(macaulay_matrix.data());
   for (int i = 0; i < 1968; i++) {
     macaulay_vec(indices[i]) = values[i];
   }
-
-  return macaulay_matrix;
 }
 
 }  // namespace dls_impl
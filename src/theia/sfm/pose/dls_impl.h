@@ -63,6 +63,14 @@ Eigen::MatrixXd CreateMacaulayMatrix(const double f1_coeff[20],
                                      const double f3_coeff[20],
                                      const double rand_term[4]);
 
+// Same as above, but writes the 120x120 matrix in column-major order into the
+// given storage instead of allocating it.
+void CreateMacaulayMatrix(const double f1_coeff[20],
+                          const double f2_coeff[20],
+                          const double f3_coeff[20],
+                          const double rand_term[4],
+                          double* macaulay_matrix);
+
 }  // namespace dls_impl
 }  // namespace theia
 
@@ -43,6 +43,7 @@
 
 #include "theia/math/polynomial.h"
 #include "theia/sfm/pose/util.h"
+#include "theia/util/fixed_capacity_vector.h"
 
 namespace theia {
 
@@ -205,23 +206,20 @@ Matrix<double, 10, 20> BuildConstraintMatrix(
   return constraint_matrix;
 }
 
-}  // namespace
-
-// Implementation of Nister from "An Efficient Solution to the Five-Point
-// Relative Pose Problem"
-bool FivePointRelativePose(const std::vector<Vector2d>& image1_points,
-                           const std::vector<Vector2d>& image2_points,
-                           std::vector<Matrix3d>* essential_matrices) {
-  CHECK_EQ(image1_points.size(), image2_points.size());
-  CHECK_GE(image1_points.size(), 5) << "You must supply at least 5 "
-                                       "correspondences for the 5 point "
-                                       "essential matrix algorithm.";
-
+// Extracts the null space of the epipolar constraints of the points and
+// computes the essential matrices. The constraint matrix has kNumPoints rows,
+// so for a fixed number of points nothing is allocated. EssentialMatrices is
+// either a std::vector or a FixedCapacityVector of Matrix3d.
+template <int kNumPoints, class EssentialMatrices>
+bool ComputeEssentialMatrices(const Vector2d* image1_points,
+                              const Vector2d* image2_points,
+                              const int num_points,
+                              EssentialMatrices* essential_matrices) {
   // Step 1. Create the nx9 matrix containing epipolar constraints.
   //   Essential matrix is a linear combination of the 4 vectors spanning the
   //   null space of this matrix.
-  MatrixXd epipolar_constraint(image1_points.size(), 9);
-  for (int i = 0; i < image1_points.size(); i++) {
+  Matrix<double, kNumPoints, 9> epipolar_constraint(num_points, 9);
+  for (int i = 0; i < num_points; i++) {
     // Fill matrix with the epipolar constraint from q'_t*E*q = 0. Where q is
     // from the first image, and q' is from the second.
     epipolar_constraint.row(i) << image2_points[i].x() * image1_points[i].x(),
@@ -235,17 +233,18 @@ bool FivePointRelativePose(const std::vector<Vector2d>& image1_points,
 
   // Extract the null space from a minimal sampling (using LU) or non-minimal
   // sampling (using SVD).
-  if (image1_points.size() == 5) {
-    const Eigen::FullPivLU<MatrixXd> lu(epipolar_constraint);
+  if (num_points == 5) {
+    const Eigen::FullPivLU<Matrix<double, kNumPoints, 9> > lu(
+        epipolar_constraint);
     if (lu.dimensionOfKernel() != 4) {
       return false;
     }
     null_space = lu.kernel();
   } else {
-    const Eigen::JacobiSVD<MatrixXd> svd(
+    const Eigen::JacobiSVD<Matrix<double, 9, 9> > svd(
         epipolar_constraint.transpose() * epipolar_constraint,
         Eigen::ComputeFullV);
-    null_space = svd.matrixV().rightCols<4>();
+    null_space = svd.matrixV().template rightCols<4>();
   }
 
   const Matrix<double, 1, 4> null_space_matrix[3][3] = {
@@ -292,4 +291,36 @@ bool FivePointRelativePose(const std::vector<Vector2d>& image1_points,
   return essential_matrices->size() > 0;
 }
 
+}  // namespace
+
+// Implementation of Nister from "An Efficient Solution to the Five-Point
+// Relative Pose Problem"
+bool FivePointRelativePose(const std::vector<Vector2d>& image1_points,
+                           const std::vector<Vector2d>& image2_points,
+                           std::vector<Matrix3d>* essential_matrices) {
+  CHECK_EQ(image1_points.size(), image2_points.size());
+  CHECK_GE(image1_points.size(), 5) << "You must supply at least 5 "
+                                       "correspondences for the 5 point "
+                                       "essential matrix algorithm.";
+  if (image1_points.size() == 5) {
+    return ComputeEssentialMatrices<5>(image1_points.data(),
+                                       image2_points.data(),
+                                       5,
+                                       essential_matrices);
+  }
+  return ComputeEssentialMatrices<Eigen::Dynamic>(image1_points.data(),
+                                                  image2_points.data(),
+                                                  image1_points.size(),
+                                                  essential_matrices);
+}
+
+bool FivePointRelativePose(
+    const Vector2d image1_points[5],
+    const Vector2d image2_points[5],
+    FixedCapacityVector<Matrix3d, 10>* essential_matrices) {
+  essential_matrices->clear();
+  return ComputeEssentialMatrices<5>(
+      image1_points, image2_points, 5, essential_matrices);
+}
+
 }  // namespace theia
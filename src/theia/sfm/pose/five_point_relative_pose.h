@@ -39,6 +39,7 @@
 #include <vector>
 
 #include "theia/alignment/alignment.h"
+#include "theia/util/fixed_capacity_vector.h"
 
 namespace theia {
 
@@ -60,6 +61,15 @@ namespace theia {
 bool FivePointRelativePose(const std::vector<Eigen::Vector2d>& image1_points,
                            const std::vector<Eigen::Vector2d>& image2_points,
                            std::vector<Eigen::Matrix3d>* essential_matrices);
+
+// The same as above for exactly 5 correspondences, which has up to 10
+// solutions. This version does not allocate any memory, so it should be
+// preferred in the inner loop of RANSAC.
+bool FivePointRelativePose(
+    const Eigen::Vector2d image1_points[5],
+    const Eigen::Vector2d image2_points[5],
+    FixedCapacityVector<Eigen::Matrix3d, 10>* essential_matrices);
+
 }  // namespace theia
 
 #endif  // THEIA_SFM_POSE_FIVE_POINT_RELATIVE_POSE_H_
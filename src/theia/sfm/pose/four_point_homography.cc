@@ -39,6 +39,7 @@
 #include <Eigen/LU>
 #include <Eigen/SVD>
 #include <glog/logging.h>
+#include <cmath>
 #include <vector>
 
 #include "theia/sfm/pose/util.h"
@@ -63,6 +64,63 @@ inline Matrix<double, 2, 9> CreateActionConstraint(const Vector2d& img1_point,
   return constraint;
 }
 
+// Normalizes the points (the columns of the matrix) as in NormalizeImagePoints.
+template <int kNumPoints>
+void NormalizePoints(const Matrix<double, 2, kNumPoints>& points,
+                     Matrix<double, 2, kNumPoints>* normalized_points,
+                     Matrix3d* normalization_matrix) {
+  // Compute centroid.
+  const Vector2d centroid(points.rowwise().mean());
+
+  // Calculate average RMS distance to centroid.
+  const double rms_mean_dist =
+      sqrt((points.colwise() - centroid).squaredNorm() / points.cols());
+
+  // Create normalization matrix.
+  const double norm_factor = sqrt(2.0) / rms_mean_dist;
+  *normalization_matrix << norm_factor, 0, -1.0 * norm_factor * centroid.x(), 0,
+      norm_factor, -1.0 * norm_factor * centroid.y(), 0, 0, 1;
+
+  // Normalize image points.
+  *normalized_points =
+      ((*normalization_matrix) * points.colwise().homogeneous())
+          .colwise()
+          .hnormalized();
+}
+
+// Computes the homography from the points stored in the columns of the
+// matrices. For a fixed number of points no memory is allocated.
+template <int kNumPoints>
+void ComputeHomography(const Matrix<double, 2, kNumPoints>& image_1_points,
+                       const Matrix<double, 2, kNumPoints>& image_2_points,
+                       Matrix3d* homography) {
+  // Normalize the image points.
+  Matrix<double, 2, kNumPoints> norm_image_1_points, norm_image_2_points;
+  Matrix3d norm_image_1_mat, norm_image_2_mat;
+  NormalizePoints(image_1_points, &norm_image_1_points, &norm_image_1_mat);
+  NormalizePoints(image_2_points, &norm_image_2_points, &norm_image_2_mat);
+
+  // Create the constraint matrix based on x' = Hx (Eq. 4.1 in Hartley and
+  // Zisserman).
+  const int num_points = image_1_points.cols();
+  Matrix<double, kNumPoints == Eigen::Dynamic ? Eigen::Dynamic : 2 * kNumPoints,
+         9>
+      action_matrix(2 * num_points, 9);
+  for (int i = 0; i < num_points; i++) {
+    action_matrix.template block<2, 9>(2 * i, 0) = CreateActionConstraint(
+        norm_image_1_points.col(i), norm_image_2_points.col(i));
+  }
+
+  const Matrix<double, 9, 9> normal_matrix =
+      action_matrix.transpose() * action_matrix;
+  const Matrix<double, 9, 1> null_vector =
+      normal_matrix.jacobiSvd(Eigen::ComputeFullV).matrixV().col(8);
+
+  *homography = norm_image_2_mat.inverse() *
+                Eigen::Map<const Matrix3d>(null_vector.data()).transpose() *
+                norm_image_1_mat;
+}
+
 }  // namespace
 
 // Normalized DLT method to compute the homography H that maps image points in
@@ -75,29 +133,28 @@ bool FourPointHomography(const std::vector<Vector2d>& image_1_points,
   CHECK_GE(image_1_points.size(), 4);
   CHECK_EQ(image_1_points.size(), image_2_points.size());
 
-  // Normalize the image points.
-  std::vector<Vector2d> norm_image_1_points, norm_image_2_points;
-  Matrix3d norm_image_1_mat, norm_image_2_mat;
-  NormalizeImagePoints(image_1_points, &norm_image_1_points, &norm_image_1_mat);
-  NormalizeImagePoints(image_2_points, &norm_image_2_points, &norm_image_2_mat);
-
-  // Create the constraint matrix based on x' = Hx (Eq. 4.1 in Hartley and
-  // Zisserman).
-  Matrix<double, Eigen::Dynamic, 9> action_matrix(2 * image_1_points.size(), 9);
-  for (int i = 0; i < image_1_points.size(); i++) {
-    action_matrix.block<2, 9>(2 * i, 0) =
-        CreateActionConstraint(norm_image_1_points[i], norm_image_2_points[i]);
+  if (image_1_points.size() == 4) {
+    return FourPointHomography(
+        image_1_points.data(), image_2_points.data(), homography);
   }
 
-  const Matrix<double, 9, 1> null_vector =
-      (action_matrix.transpose() * action_matrix)
-          .jacobiSvd(Eigen::ComputeFullV)
-          .matrixV()
-          .rightCols<1>();
+  const Map<const Matrix<double, 2, Eigen::Dynamic> > image_1_points_mat(
+      image_1_points[0].data(), 2, image_1_points.size());
+  const Map<const Matrix<double, 2, Eigen::Dynamic> > image_2_points_mat(
+      image_2_points[0].data(), 2, image_2_points.size());
+  ComputeHomography<Eigen::Dynamic>(
+      image_1_points_mat, image_2_points_mat, homography);
+  return true;
+}
 
-  *homography = norm_image_2_mat.inverse() *
-                Eigen::Map<const Matrix3d>(null_vector.data()).transpose() *
-                norm_image_1_mat;
+bool FourPointHomography(const Vector2d image_1_points[4],
+                         const Vector2d image_2_points[4],
+                         Matrix3d* homography) {
+  const Map<const Matrix<double, 2, 4> > image_1_points_mat(
+      image_1_points[0].data());
+  const Map<const Matrix<double, 2, 4> > image_2_points_mat(
+      image_2_points[0].data());
+  ComputeHomography<4>(image_1_points_mat, image_2_points_mat, homography);
   return true;
 }
 
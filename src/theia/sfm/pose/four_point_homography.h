@@ -49,6 +49,12 @@ bool FourPointHomography(const std::vector<Eigen::Vector2d>& image_1_points,
                          const std::vector<Eigen::Vector2d>& image_2_points,
                          Eigen::Matrix3d* homography);
 
+// The same as above for exactly 4 correspondences. This version does not
+// allocate any memory, so it should be preferred in the inner loop of RANSAC.
+bool FourPointHomography(const Eigen::Vector2d image_1_points[4],
+                         const Eigen::Vector2d image_2_points[4],
+                         Eigen::Matrix3d* homography);
+
 }  // namespace theia
 
 #endif  // THEIA_SFM_POSE_FOUR_POINT_HOMOGRAPHY_H_
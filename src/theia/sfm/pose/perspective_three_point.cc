@@ -42,6 +42,7 @@
 
 #include "theia/math/polynomial.h"
 #include "theia/sfm/pose/util.h"
+#include "theia/util/fixed_capacity_vector.h"
 
 namespace theia {
 using Eigen::Map;
@@ -177,12 +178,13 @@ void Backsubstitute(const Matrix3d& intermediate_world_frame,
   *translation = -(*rotation) * (*translation);
 }
 
-}  // namespace
-
-bool PoseFromThreePoints(const std::vector<Vector2d>& feature_point,
-                         const std::vector<Vector3d>& points_3d,
-                         std::vector<Matrix3d>* solution_rotations,
-                         std::vector<Vector3d>* solution_translations) {
+// Computes the poses from the first three points of each array. The solution
+// containers are either std::vectors or FixedCapacityVectors.
+template <class Rotations, class Translations>
+bool ComputePosesFromThreePoints(const Vector2d* feature_point,
+                                 const Vector3d* points_3d,
+                                 Rotations* solution_rotations,
+                                 Translations* solution_translations) {
   Vector3d normalized_image_points[3];
   // Store points_3d in world_points for ease of use. NOTE: we cannot use a
   // const ref or a Map because the world_points entries may be swapped later.
@@ -283,11 +285,34 @@ bool PoseFromThreePoints(const std::vector<Vector2d>& feature_point,
                    cot_alphas[i],
                    d_12,
                    b,
-                   &solution_translations->at(i),
-                   &solution_rotations->at(i));
+                   &(*solution_translations)[i],
+                   &(*solution_rotations)[i]);
   }
 
   return num_solutions > 0;
 }
 
+}  // namespace
+
+bool PoseFromThreePoints(const std::vector<Vector2d>& feature_point,
+                         const std::vector<Vector3d>& points_3d,
+                         std::vector<Matrix3d>* solution_rotations,
+                         std::vector<Vector3d>* solution_translations) {
+  return ComputePosesFromThreePoints(feature_point.data(),
+                                     points_3d.data(),
+                                     solution_rotations,
+                                     solution_translations);
+}
+
+bool PoseFromThreePoints(
+    const Vector2d feature_point[3],
+    const Vector3d points_3d[3],
+    FixedCapacityVector<Matrix3d, 4>* solution_rotations,
+    FixedCapacityVector<Vector3d, 4>* solution_translations) {
+  return ComputePosesFromThreePoints(feature_point,
+                                     points_3d,
+                                     solution_rotations,
+                                     solution_translations);
+}
+
 }  // namespace theia
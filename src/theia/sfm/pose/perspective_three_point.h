@@ -38,6 +38,8 @@
 #include <Eigen/Core>
 #include <vector>
 
+#include "theia/util/fixed_capacity_vector.h"
+
 namespace theia {
 // Computes camera pose using the three point algorithm and returns all possible
 // solutions (up to 4). Follows steps from the paper "A Novel Parameterization
@@ -58,6 +60,15 @@ bool PoseFromThreePoints(const std::vector<Eigen::Vector2d>& feature_point,
                          std::vector<Eigen::Matrix3d>* solution_rotations,
                          std::vector<Eigen::Vector3d>* solution_translations);
 
+// The same as above with the solutions returned in fixed capacity vectors so
+// that no memory is allocated for them, which is preferable in the inner loop
+// of RANSAC.
+bool PoseFromThreePoints(
+    const Eigen::Vector2d feature_point[3],
+    const Eigen::Vector3d world_point[3],
+    FixedCapacityVector<Eigen::Matrix3d, 4>* solution_rotations,
+    FixedCapacityVector<Eigen::Vector3d, 4>* solution_translations);
+
 }  // namespace theia
 
 #endif  // THEIA_SFM_POSE_PERSPECTIVE_THREE_POINT_H_
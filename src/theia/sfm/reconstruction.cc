@@ -39,17 +39,22 @@
 #include <glog/logging.h>
 
 #include <algorithm>
+#include <cmath>
+#include <iterator>
+#include <map>
 #include <string>
 #include <unordered_map>
 #include <utility>
 #include <vector>
 
+#include "theia/math/parallel_selection.h"
 #include "theia/sfm/feature.h"
 #include "theia/sfm/pose/util.h"
 #include "theia/sfm/track.h"
 #include "theia/sfm/transformation/transform_reconstruction.h"
 #include "theia/sfm/types.h"
 #include "theia/sfm/view.h"
+#include "theia/util/executor.h"
 #include "theia/util/map_util.h"
 #include "theia/util/util.h"
 
@@ -70,19 +75,13 @@ bool DuplicateViewsExistInTrack(
           view_ids.end());
 }
 
-double Median(std::vector<double>* data) {
-  int n = data->size();
-  std::vector<double>::iterator mid_point = data->begin() + n / 2;
-  std::nth_element(data->begin(), mid_point, data->end());
-  return *mid_point;
-}
-
 }  // namespace
 
 Reconstruction::Reconstruction()
     : next_track_id_(0),
       next_view_id_(0),
-      next_camera_intrinsics_group_id_(0) {}
+      next_camera_intrinsics_group_id_(0),
+      next_camera_rig_id_(0) {}
 
 Reconstruction::~Reconstruction() {}
 
@@ -94,6 +93,67 @@ ViewId Reconstruction::ViewIdFromTimestamp(const double& timestamp_s) const {
   return FindWithDefault(view_timestamp_to_id_, timestamp_s, kInvalidViewId);
 }
 
+std::vector<ViewId> Reconstruction::ViewIdsSortedByTimestamp() const {
+  std::vector<ViewId> view_ids;
+  view_ids.reserve(view_timestamp_to_id_.size());
+  for (const auto& timestamp_and_view_id : view_timestamp_to_id_) {
+    view_ids.emplace_back(timestamp_and_view_id.second);
+  }
+  return view_ids;
+}
+
+std::vector<ViewId> Reconstruction::ViewIdsInTimeRange(
+    const double start_timestamp_s, const double end_timestamp_s) const {
+  std::vector<ViewId> view_ids;
+  if (!(start_timestamp_s <= end_timestamp_s)) {
+    return view_ids;
+  }
+  const auto end = view_timestamp_to_id_.upper_bound(end_timestamp_s);
+  for (auto it = view_timestamp_to_id_.lower_bound(start_timestamp_s);
+       it != end;
+       ++it) {
+    view_ids.emplace_back(it->second);
+  }
+  return view_ids;
+}
+
+ViewId Reconstruction::ViewIdNearestToTimestamp(
+    const double timestamp_s) const {
+  const std::vector<ViewId> view_ids =
+      KNearestViewIdsToTimestamp(timestamp_s, 1);
+  return view_ids.empty() ? kInvalidViewId : view_ids[0];
+}
+
+std::vector<ViewId> Reconstruction::KNearestViewIdsToTimestamp(
+    const double timestamp_s, const int k) const {
+  std::vector<ViewId> view_ids;
+  if (std::isnan(timestamp_s) || k <= 0) {
+    return view_ids;
+  }
+  view_ids.reserve(std::min<size_t>(k, view_timestamp_to_id_.size()));
+
+  // Merge the views before and after the timestamp outwards from it.
+  auto after = view_timestamp_to_id_.lower_bound(timestamp_s);
+  auto before = after;
+  while (static_cast<int>(view_ids.size()) < k) {
+    const bool has_before = before != view_timestamp_to_id_.begin();
+    const bool has_after = after != view_timestamp_to_id_.end();
+    if (!has_before && !has_after) {
+      break;
+    }
+    if (has_before &&
+        (!has_after || timestamp_s - std::prev(before)->first <=
+                           after->first - timestamp_s)) {
+      --before;
+      view_ids.emplace_back(before->second);
+    } else {
+      view_ids.emplace_back(after->second);
+      ++after;
+    }
+  }
+  return view_ids;
+}
+
 ViewId Reconstruction::AddView(const std::string& view_name,
                                const double timestamp) {
   const ViewId view_id =
@@ -111,6 +171,12 @@ ViewId Reconstruction::AddView(const std::string& view_name,
     return kInvalidViewId;
   }
 
+  if (std::isnan(timestamp)) {
+    LOG(WARNING) << "Could not add view with the name " << view_name
+                 << " because its timestamp is NaN.";
+    return kInvalidViewId;
+  }
+
   if (ContainsKey(view_timestamp_to_id_, timestamp)) {
     LOG(WARNING)
         << "Could not add view with the timestamp " << timestamp
@@ -132,7 +198,7 @@ ViewId Reconstruction::AddView(const std::string& view_name,
     const ViewId view_id_in_intrinsics_group =
         *camera_intrinsics_groups_[group_id].begin();
     const Camera& intrinsics_group_camera =
-        FindOrDie(views_, view_id_in_intrinsics_group).Camera();
+        CHECK_NOTNULL(views_.Find(view_id_in_intrinsics_group))->Camera();
 
     // Set the shared_ptr objects to point to the same place so that the
     // intrinsics are truly shared.
@@ -141,7 +207,7 @@ ViewId Reconstruction::AddView(const std::string& view_name,
   }
   new_view.SetTimestamp(timestamp);
   // Add the view to the reconstruction.
-  views_.emplace(next_view_id_, new_view);
+  views_.Insert(next_view_id_, std::move(new_view));
   view_name_to_id_.emplace(view_name, next_view_id_);
   view_timestamp_to_id_.emplace(timestamp, next_view_id_);
   // Add this view to the camera intrinsics group, and vice versa.
@@ -153,7 +219,7 @@ ViewId Reconstruction::AddView(const std::string& view_name,
 }
 
 bool Reconstruction::RemoveView(const ViewId view_id) {
-  class View* view = FindOrNull(views_, view_id);
+  class View* view = views_.Find(view_id);
   if (view == nullptr) {
     LOG(WARNING)
         << "Could not remove the view from the reconstruction because the view "
@@ -198,19 +264,35 @@ bool Reconstruction::RemoveView(const ViewId view_id) {
     camera_intrinsics_groups_.erase(group_id);
   }
 
+  // Remove the view from its rig frame.
+  const CameraRigMembership* membership =
+      FindOrNull(view_id_to_camera_rig_membership_, view_id);
+  if (membership != nullptr) {
+    const uint64_t frame_key =
+        CameraRigFrameKey(membership->rig_id, membership->frame_id);
+    std::vector<ViewId>& frame_views =
+        FindOrDie(camera_rig_frames_, frame_key);
+    frame_views.erase(
+        std::find(frame_views.begin(), frame_views.end(), view_id));
+    if (frame_views.empty()) {
+      camera_rig_frames_.erase(frame_key);
+    }
+    view_id_to_camera_rig_membership_.erase(view_id);
+  }
+
   // Remove the view.
-  views_.erase(view_id);
+  views_.Erase(view_id);
   return true;
 }
 
 int Reconstruction::NumViews() const { return views_.size(); }
 
 const class View* Reconstruction::View(const ViewId view_id) const {
-  return FindOrNull(views_, view_id);
+  return views_.Find(view_id);
 }
 
 class View* Reconstruction::MutableView(const ViewId view_id) {
-  return FindOrNull(views_, view_id);
+  return views_.Find(view_id);
 }
 
 std::vector<ViewId> Reconstruction::ViewIds() const {
@@ -252,38 +334,123 @@ int Reconstruction::NumCameraIntrinsicGroups() const {
   return camera_intrinsics_groups_.size();
 }
 
+uint64_t Reconstruction::CameraRigFrameKey(const CameraRigId rig_id,
+                                          const int frame_id) {
+  return (static_cast<uint64_t>(rig_id) << 32) |
+         static_cast<uint32_t>(frame_id);
+}
+
+CameraRigId Reconstruction::AddCameraRig(const class CameraRig& camera_rig) {
+  camera_rigs_.emplace(next_camera_rig_id_, camera_rig);
+  ++next_camera_rig_id_;
+  return next_camera_rig_id_ - 1;
+}
+
+int Reconstruction::NumCameraRigs() const { return camera_rigs_.size(); }
+
+const class CameraRig* Reconstruction::CameraRig(
+    const CameraRigId rig_id) const {
+  return FindOrNull(camera_rigs_, rig_id);
+}
+
+class CameraRig* Reconstruction::MutableCameraRig(const CameraRigId rig_id) {
+  return FindOrNull(camera_rigs_, rig_id);
+}
+
+std::vector<CameraRigId> Reconstruction::CameraRigIds() const {
+  std::vector<CameraRigId> rig_ids;
+  rig_ids.reserve(camera_rigs_.size());
+  for (const auto& camera_rig : camera_rigs_) {
+    rig_ids.emplace_back(camera_rig.first);
+  }
+  return rig_ids;
+}
+
+bool Reconstruction::AddViewToCameraRig(const ViewId view_id,
+                                        const CameraRigId rig_id,
+                                        const int camera_index,
+                                        const int frame_id) {
+  const class CameraRig* camera_rig = FindOrNull(camera_rigs_, rig_id);
+  if (!views_.Contains(view_id) || camera_rig == nullptr) {
+    LOG(WARNING) << "Could not add the view to the camera rig because the view "
+                    "or the rig does not exist.";
+    return false;
+  }
+  if (camera_index < 0 || camera_index >= camera_rig->NumCameras()) {
+    LOG(WARNING) << "Could not add the view to the camera rig because the rig "
+                    "has no camera "
+                 << camera_index;
+    return false;
+  }
+  if (ContainsKey(view_id_to_camera_rig_membership_, view_id)) {
+    LOG(WARNING) << "Could not add the view to the camera rig because the view "
+                    "already belongs to a rig.";
+    return false;
+  }
+
+  std::vector<ViewId>& frame_views =
+      camera_rig_frames_[CameraRigFrameKey(rig_id, frame_id)];
+  for (const ViewId frame_view_id : frame_views) {
+    if (FindOrDie(view_id_to_camera_rig_membership_, frame_view_id)
+            .camera_index == camera_index) {
+      LOG(WARNING) << "Could not add the view to the camera rig because the "
+                      "camera already has a view in rig frame "
+                   << frame_id;
+      return false;
+    }
+  }
+  frame_views.emplace_back(view_id);
+
+  CameraRigMembership membership;
+  membership.rig_id = rig_id;
+  membership.camera_index = camera_index;
+  membership.frame_id = frame_id;
+  view_id_to_camera_rig_membership_.emplace(view_id, membership);
+  return true;
+}
+
+const CameraRigMembership* Reconstruction::CameraRigMembershipFromViewId(
+    const ViewId view_id) const {
+  return FindOrNull(view_id_to_camera_rig_membership_, view_id);
+}
+
+std::vector<ViewId> Reconstruction::GetViewsInCameraRigFrame(
+    const CameraRigId rig_id, const int frame_id) const {
+  return FindWithDefault(camera_rig_frames_,
+                         CameraRigFrameKey(rig_id, frame_id),
+                         std::vector<ViewId>());
+}
+
 TrackId Reconstruction::AddTrack() {
   const TrackId new_track_id = next_track_id_;
-  CHECK(!ContainsKey(tracks_, new_track_id))
+  CHECK(!tracks_.Contains(new_track_id))
       << "The reconstruction already contains a track with id: "
       << new_track_id;
 
-  class Track new_track;
-  tracks_.emplace(new_track_id, new_track);
+  tracks_.Insert(new_track_id, theia::Track());
   ++next_track_id_;
   return new_track_id;
 }
 
 void Reconstruction::AddTrack(const theia::TrackId& track_id) {
-  CHECK(!ContainsKey(tracks_, track_id))
+  CHECK(!tracks_.Contains(track_id))
       << "The reconstruction already contains a track with id: " << track_id;
 
-  class Track new_track;
-  tracks_.emplace(track_id, new_track);
+  tracks_.Insert(track_id, theia::Track());
 }
 
 bool Reconstruction::AddObservation(const ViewId view_id,
                                     const TrackId track_id,
                                     const Feature& feature) {
-  CHECK(ContainsKey(views_, view_id))
+  CHECK(views_.Contains(view_id))
       << "View does not exist. AddObservation may only be used to add "
          "observations to an existing view.";
-  CHECK(ContainsKey(tracks_, track_id))
+  CHECK(tracks_.Contains(track_id))
       << "Track does not exist. AddObservation may only be used to add "
          "observations to an existing track.";
 
-  class View* view = FindOrNull(views_, view_id);
-  class Track* track = FindOrNull(tracks_, track_id);
+  class View* view = views_.Find(view_id);
+  class Track* track = tracks_.Find(track_id);
   if (view->GetFeature(track_id) != nullptr) {
     LOG(WARNING)
         << "Cannot add a new observation of track " << track_id
@@ -291,8 +458,7 @@ bool Reconstruction::AddObservation(const ViewId view_id,
     return false;
   }
 
-  const std::unordered_set<ViewId>& views_observing_track = track->ViewIds();
-  if (ContainsKey(views_observing_track, view_id)) {
+  if (ContainsKey(track->ViewIds(), view_id)) {
     LOG(WARNING) << "Cannot add a new observation of track " << track_id
                  << " because the track is already observed by view "
                  << view_id;
@@ -319,14 +485,14 @@ TrackId Reconstruction::AddTrack(
   }
 
   const TrackId new_track_id = next_track_id_;
-  CHECK(!ContainsKey(tracks_, new_track_id))
+  CHECK(!tracks_.Contains(new_track_id))
       << "The reconstruction already contains a track with id: "
       << new_track_id;
 
   class Track new_track;
   for (const auto& observation : track) {
     // Make sure the view exists in the model.
-    CHECK(ContainsKey(views_, observation.first))
+    CHECK(views_.Contains(observation.first))
         << "Cannot add a track with containing an observation in view id "
         << observation.first << " because the view does not exist.";
 
@@ -338,13 +504,69 @@ TrackId Reconstruction::AddTrack(
     view->AddFeature(new_track_id, observation.second);
   }
 
-  tracks_.emplace(new_track_id, new_track);
+  tracks_.Insert(new_track_id, std::move(new_track));
   ++next_track_id_;
   return new_track_id;
 }
 
+std::vector<TrackId> Reconstruction::AddTracks(
+    const std::vector<std::vector<std::pair<ViewId, Feature> > >& tracks) {
+  std::vector<TrackId> track_ids(tracks.size(), kInvalidTrackId);
+  std::unordered_map<ViewId, std::vector<std::pair<TrackId, Feature> > >
+      features_per_view;
+  tracks_.reserve(next_track_id_ + tracks.size());
+  for (int i = 0; i < tracks.size(); i++) {
+    const std::vector<std::pair<ViewId, Feature> >& track = tracks[i];
+    if (track.size() < 2) {
+      LOG(WARNING) << "Tracks must have at least 2 observations ("
+                   << track.size()
+                   << " were given). Cannot add track to the reconstruction";
+      continue;
+    }
+    if (DuplicateViewsExistInTrack(track)) {
+      LOG(WARNING) << "Cannot add a track that contains the same view twice "
+                      "to the reconstruction.";
+      continue;
+    }
+
+    const TrackId new_track_id = next_track_id_;
+    CHECK(!tracks_.Contains(new_track_id))
+        << "The reconstruction already contains a track with id: "
+        << new_track_id;
+    class Track new_track;
+    for (const auto& observation : track) {
+      CHECK(views_.Contains(observation.first))
+          << "Cannot add a track with containing an observation in view id "
+          << observation.first << " because the view does not exist.";
+      new_track.AddView(observation.first);
+      features_per_view[observation.first].emplace_back(new_track_id,
+                                                        observation.second);
+    }
+    tracks_.Insert(new_track_id, std::move(new_track));
+    ++next_track_id_;
+    track_ids[i] = new_track_id;
+  }
+
+  for (const auto& view_features : features_per_view) {
+    views_.Find(view_features.first)->AddFeatures(view_features.second);
+  }
+  return track_ids;
+}
+
+void Reconstruction::ReserveTracks(
+    const int num_tracks,
+    const std::unordered_map<ViewId, int>& num_observations_per_view) {
+  tracks_.reserve(next_track_id_ + num_tracks);
+  for (const auto& num_observations : num_observations_per_view) {
+    class View* view = views_.Find(num_observations.first);
+    if (view != nullptr) {
+      view->ReserveFeatures(view->NumFeatures() + num_observations.second);
+    }
+  }
+}
+
 bool Reconstruction::RemoveTrack(const TrackId track_id) {
-  class Track* track = FindOrNull(tracks_, track_id);
+  class Track* track = tracks_.Find(track_id);
   if (track == nullptr) {
     LOG(WARNING) << "Cannot remove a track that does not exist";
     return false;
@@ -352,7 +574,7 @@ bool Reconstruction::RemoveTrack(const TrackId track_id) {
 
   // Remove track from views.
   for (const ViewId view_id : track->ViewIds()) {
-    class View* view = FindOrNull(views_, view_id);
+    class View* view = views_.Find(view_id);
     if (view == nullptr) {
       LOG(WARNING) << "Could not remove a track from the view because the view "
                       "does not exist";
@@ -367,18 +589,18 @@ bool Reconstruction::RemoveTrack(const TrackId track_id) {
   }
 
   // Delete from the reconstruction.
-  tracks_.erase(track_id);
+  tracks_.Erase(track_id);
   return true;
 }
 
 int Reconstruction::NumTracks() const { return tracks_.size(); }
 
 const class Track* Reconstruction::Track(const TrackId track_id) const {
-  return FindOrNull(tracks_, track_id);
+  return tracks_.Find(track_id);
 }
 
 class Track* Reconstruction::MutableTrack(const TrackId track_id) {
-  return FindOrNull(tracks_, track_id);
+  return tracks_.Find(track_id);
 }
 
 std::vector<TrackId> Reconstruction::TrackIds() const {
@@ -390,84 +612,140 @@ std::vector<TrackId> Reconstruction::TrackIds() const {
   return track_ids;
 }
 
-void Reconstruction::Normalize() {
-  // First normalize the position so that the marginal median of the camera
-  // positions is at the origin.
-  std::vector<std::vector<double> > camera_positions(3);
-  Eigen::Vector3d median_camera_position;
-  const auto& view_ids = ViewIds();
+size_t Reconstruction::EstimateMemoryUsage() const {
+  // The features of a view are stored in a FlatHashMap, i.e. the keys, the
+  // values and an index table of roughly twice the number of entries.
+  static const size_t kBytesPerFeature =
+      sizeof(TrackId) + sizeof(Feature) + 2 * sizeof(uint32_t);
+  // Bookkeeping of a view in the maps from names and timestamps to ids.
+  static const size_t kBytesPerViewEntry = 96;
+
+  size_t bytes = 0;
+  for (const auto& view : views_) {
+    bytes += sizeof(class View) + kBytesPerViewEntry +
+             view.second.Name().capacity() +
+             view.second.NumFeatures() * kBytesPerFeature;
+  }
+  for (const auto& track : tracks_) {
+    const size_t num_views = track.second.NumViews();
+    bytes += sizeof(class Track) +
+             (num_views > 4 ? num_views * sizeof(ViewId) : 0) +
+             track.second.ReferenceDescriptor().size() * sizeof(float);
+  }
+  return bytes;
+}
+
+void Reconstruction::UpdateBearingVectors(
+    const std::unordered_set<ViewId>& view_ids, const int num_threads) {
+  std::vector<class View*> views;
+  views.reserve(view_ids.size());
   for (const ViewId view_id : view_ids) {
-    const class View* view = View(view_id);
-    if (view == nullptr || !view->IsEstimated()) {
-      continue;
+    class View* view = views_.Find(view_id);
+    if (view != nullptr && !view->HasBearingVectors()) {
+      views.emplace_back(view);
     }
-
-    const Eigen::Vector3d point = view->Camera().GetPosition();
-    camera_positions[0].push_back(point[0]);
-    camera_positions[1].push_back(point[1]);
-    camera_positions[2].push_back(point[2]);
   }
-  median_camera_position(0) = Median(&camera_positions[0]);
-  median_camera_position(1) = Median(&camera_positions[1]);
-  median_camera_position(2) = Median(&camera_positions[2]);
-  TransformReconstruction(
-      Eigen::Matrix3d::Identity(), -median_camera_position, 1.0, this);
+  ParallelFor(num_threads, views.size(), [&](const int start, const int end) {
+    for (int i = start; i < end; i++) {
+      views[i]->UpdateBearingVectors();
+    }
+  });
+}
 
-  // Get the estimated track ids.
-  const auto& temp_track_ids = TrackIds();
+void Reconstruction::Normalize() { Normalize(1); }
+
+void Reconstruction::Normalize(const int num_threads) {
+  // Get the estimated view and track ids.
+  std::vector<ViewId> view_ids;
+  view_ids.reserve(views_.size());
+  for (const auto& view : views_) {
+    if (view.second.IsEstimated()) {
+      view_ids.emplace_back(view.first);
+    }
+  }
   std::vector<TrackId> track_ids;
-  track_ids.reserve(temp_track_ids.size());
-  for (const TrackId track_id : temp_track_ids) {
-    const class Track* track = Track(track_id);
-    if (track == nullptr || !track->IsEstimated()) {
-      continue;
+  track_ids.reserve(tracks_.size());
+  for (const auto& track : tracks_) {
+    if (track.second.IsEstimated()) {
+      track_ids.emplace_back(track.first);
+    }
+  }
+
+  // First normalize the position so that the marginal median of the camera
+  // positions is at the origin.
+  std::vector<std::vector<double> > camera_positions(
+      3, std::vector<double>(view_ids.size()));
+  ParallelFor(num_threads,
+              view_ids.size(),
+              [&](const int start, const int end) {
+                for (int i = start; i < end; i++) {
+                  const Eigen::Vector3d position =
+                      View(view_ids[i])->Camera().GetPosition();
+                  camera_positions[0][i] = position[0];
+                  camera_positions[1][i] = position[1];
+                  camera_positions[2][i] = position[2];
+                }
+              });
+  Eigen::Vector3d median_camera_position = Eigen::Vector3d::Zero();
+  if (!view_ids.empty()) {
+    for (int i = 0; i < 3; i++) {
+      median_camera_position(i) =
+          ParallelMedian(camera_positions[i], num_threads);
     }
-    track_ids.emplace_back(track_id);
   }
 
   if (track_ids.size() == 0) {
+    TransformReconstruction(Eigen::Matrix3d::Identity(),
+                            -median_camera_position,
+                            1.0,
+                            num_threads,
+                            this);
     return;
   }
 
   // Compute the marginal median of the 3D points.
-  std::vector<std::vector<double> > points(3);
+  std::vector<Eigen::Vector3d> points(track_ids.size());
+  std::vector<std::vector<double> > coordinates(
+      3, std::vector<double>(track_ids.size()));
+  ParallelFor(num_threads,
+              track_ids.size(),
+              [&](const int start, const int end) {
+                for (int i = start; i < end; i++) {
+                  points[i] = Track(track_ids[i])->Point().hnormalized();
+                  coordinates[0][i] = points[i][0];
+                  coordinates[1][i] = points[i][1];
+                  coordinates[2][i] = points[i][2];
+                }
+              });
   Eigen::Vector3d median;
-  for (const TrackId track_id : track_ids) {
-    const class Track* track = Track(track_id);
-    const Eigen::Vector3d point = track->Point().hnormalized();
-    points[0].push_back(point[0]);
-    points[1].push_back(point[1]);
-    points[2].push_back(point[2]);
-  }
-  median(0) = Median(&points[0]);
-  median(1) = Median(&points[1]);
-  median(2) = Median(&points[2]);
-
-  // Find the median absolute deviation of the points from the median.
-  std::vector<double> distance_to_median;
-  distance_to_median.reserve(track_ids.size());
-  for (const TrackId track_id : track_ids) {
-    const class Track* track = Track(track_id);
-    const Eigen::Vector3d point = track->Point().hnormalized();
-    distance_to_median.emplace_back((point - median).lpNorm<1>());
+  for (int i = 0; i < 3; i++) {
+    median(i) = ParallelMedian(coordinates[i], num_threads);
   }
+
+  // Find the median absolute deviation of the points from the median. The
+  // deviation does not depend on the translation of the cameras above, so it
+  // is computed on the points as they are.
+  std::vector<double>& distance_to_median = coordinates[0];
+  ParallelFor(num_threads,
+              track_ids.size(),
+              [&](const int start, const int end) {
+                for (int i = start; i < end; i++) {
+                  distance_to_median[i] = (points[i] - median).lpNorm<1>();
+                }
+              });
   // This will scale the reconstruction so that the median absolute deviation of
   // the points is 100.
-  const double scale = 100.0 / Median(&distance_to_median);
-  TransformReconstruction(
-      Eigen::Matrix3d::Identity(), Eigen::Vector3d::Zero(), scale, this);
+  const double scale =
+      100.0 / ParallelMedian(distance_to_median, num_threads);
 
   // Most images are taken relatively upright with the x-direction of the image
   // parallel to the ground plane. We can solve for the transformation that
   // tries to best align the x-directions to the ground plane by finding the
-  // null vector of the covariance matrix of per-camera x-directions.
+  // null vector of the covariance matrix of per-camera x-directions. The
+  // translation and scale do not change the camera orientations.
   Eigen::Matrix3d correlation;
   correlation.setZero();
   for (const ViewId view_id : view_ids) {
-    const class View* view = View(view_id);
-    if (view == nullptr || !view->IsEstimated()) {
-      continue;
-    }
     const Camera& camera = View(view_id)->Camera();
     const Eigen::Vector3d x =
         camera.GetOrientationAsRotationMatrix().transpose() *
@@ -482,10 +760,17 @@ void Reconstruction::Normalize() {
   // We want the coordinate system to be such that the cameras lie on the x-z
   // plane with the y vector pointing up. Thus, the plane normal should be equal
   // to the positive y-direction.
-  Eigen::Matrix3d rotation =
+  const Eigen::Matrix3d rotation =
       Eigen::Quaterniond::FromTwoVectors(plane_normal, Eigen::Vector3d(0, 1, 0))
           .toRotationMatrix();
-  TransformReconstruction(rotation, Eigen::Vector3d::Zero(), 1.0, this);
+
+  // Translate, scale and rotate the reconstruction in a single pass:
+  // x' = R * s * (x - t) = s * R * x - s * R * t.
+  TransformReconstruction(rotation,
+                          -scale * rotation * median_camera_position,
+                          scale,
+                          num_threads,
+                          this);
 }
 
 void Reconstruction::GetSubReconstruction(
@@ -498,22 +783,27 @@ void Reconstruction::GetSubReconstruction(
   subreconstruction->next_view_id_ = next_view_id_;
   subreconstruction->next_camera_intrinsics_group_id_ =
       next_camera_intrinsics_group_id_;
+  subreconstruction->next_camera_rig_id_ = next_camera_rig_id_;
 
   // Copy the view information. Also store the tracks in each view so that we
   // may easily retreive them below.
-  subreconstruction->views_.reserve(views_in_subset.size());
   subreconstruction->view_name_to_id_.reserve(views_in_subset.size());
-  subreconstruction->view_timestamp_to_id_.reserve(views_in_subset.size());
   std::unordered_set<TrackId> tracks_in_views;
   for (const ViewId view_id : views_in_subset) {
-    const class View* view = FindOrNull(views_, view_id);
+    const class View* view = views_.Find(view_id);
     // Skip this view id if it does not exist in the reconstruction.
     if (view == nullptr) {
       continue;
     }
 
     // Set the view information.
-    subreconstruction->views_[view_id] = *view;
+    class View* subreconstruction_view =
+        subreconstruction->views_.Find(view_id);
+    if (subreconstruction_view != nullptr) {
+      *subreconstruction_view = *view;
+    } else {
+      subreconstruction->views_.Insert(view_id, *view);
+    }
     subreconstruction->view_name_to_id_[view->Name()] = view_id;
     subreconstruction->view_timestamp_to_id_[view->GetTimestamp()] = view_id;
     // Set the intrinsics group id information.
@@ -524,15 +814,30 @@ void Reconstruction::GetSubReconstruction(
     subreconstruction->camera_intrinsics_groups_[intrinsics_group_id].emplace(
         view_id);
 
+    // Copy the rig of the view and its membership.
+    const CameraRigMembership* membership =
+        FindOrNull(view_id_to_camera_rig_membership_, view_id);
+    if (membership != nullptr &&
+        !ContainsKey(subreconstruction->view_id_to_camera_rig_membership_,
+                     view_id)) {
+      subreconstruction->camera_rigs_.emplace(
+          membership->rig_id, FindOrDie(camera_rigs_, membership->rig_id));
+      subreconstruction->view_id_to_camera_rig_membership_.emplace(view_id,
+                                                                   *membership);
+      subreconstruction
+          ->camera_rig_frames_[CameraRigFrameKey(membership->rig_id,
+                                                 membership->frame_id)]
+          .emplace_back(view_id);
+    }
+
     // Add the tracks from this view to our track container.
     const auto& tracks_in_view = view->TrackIds();
     tracks_in_views.insert(tracks_in_view.begin(), tracks_in_view.end());
   }
 
   // Copy the tracks.
-  subreconstruction->tracks_.reserve(tracks_in_views.size());
   for (const TrackId track_id : tracks_in_views) {
-    const class Track* track = FindOrNull(tracks_, track_id);
+    const class Track* track = tracks_.Find(track_id);
     // Skip this track if it somehow is not present in the reconstruction.
     if (track == nullptr) {
       continue;
@@ -557,7 +862,7 @@ void Reconstruction::GetSubReconstruction(
     }
 
     // Set the track in the subreconstruction.
-    subreconstruction->tracks_.emplace(track_id, new_track);
+    subreconstruction->tracks_.Insert(track_id, std::move(new_track));
   }
 }
 
@@ -37,19 +37,25 @@
 
 #include <cereal/access.hpp>
 #include <cereal/cereal.hpp>
+#include <cereal/types/map.hpp>
 #include <cereal/types/string.hpp>
 #include <cereal/types/unordered_map.hpp>
+#include <cereal/types/unordered_set.hpp>
 #include <stdint.h>
+#include <map>
 #include <string>
+#include <type_traits>
 #include <unordered_map>
 #include <unordered_set>
 #include <utility>
 #include <vector>
 
+#include "theia/sfm/camera_rig.h"
 #include "theia/sfm/feature.h"
 #include "theia/sfm/track.h"
 #include "theia/sfm/types.h"
 #include "theia/sfm/view.h"
+#include "theia/util/slot_map.h"
 
 namespace theia {
 
@@ -78,6 +84,24 @@ class Reconstruction {
   // exist.
   ViewId ViewIdFromTimestamp(const double& timestamp_s) const;
 
+  // Temporal queries on the views, which are indexed by their timestamps so
+  // that each query takes O(log N + k) time for k returned views.
+  //
+  // Returns the ids of all views sorted by their timestamps.
+  std::vector<ViewId> ViewIdsSortedByTimestamp() const;
+  // Returns the ids of the views whose timestamps lie in
+  // [start_timestamp_s, end_timestamp_s], sorted by their timestamps.
+  std::vector<ViewId> ViewIdsInTimeRange(const double start_timestamp_s,
+                                         const double end_timestamp_s) const;
+  // Returns the id of the view whose timestamp is closest to timestamp_s, or
+  // kInvalidViewId if the reconstruction has no views. Ties are broken in favor
+  // of the earlier view.
+  ViewId ViewIdNearestToTimestamp(const double timestamp_s) const;
+  // Returns the ids of the (up to) k views whose timestamps are closest to
+  // timestamp_s, sorted by their distance to timestamp_s.
+  std::vector<ViewId> KNearestViewIdsToTimestamp(const double timestamp_s,
+                                                 const int k) const;
+
   // Creates a new view and returns the view id.
   ViewId AddView(const std::string& view_name, const double timestamp);
   // Creates a new view and assigns it to the specified camera intrinsics group.
@@ -110,6 +134,36 @@ class Reconstruction {
   // Returns all group ids.
   std::unordered_set<CameraIntrinsicsGroupId> CameraIntrinsicsGroupIds() const;
 
+  // Adds a multi-camera rig and returns its id.
+  CameraRigId AddCameraRig(const class CameraRig& camera_rig);
+  int NumCameraRigs() const;
+
+  // Returns the camera rig or a nullptr if the rig does not exist.
+  const class CameraRig* CameraRig(const CameraRigId rig_id) const;
+  class CameraRig* MutableCameraRig(const CameraRigId rig_id);
+
+  // Return all CameraRigIds in the reconstruction.
+  std::vector<CameraRigId> CameraRigIds() const;
+
+  // Assigns the view to the camera of the rig that captured it in the given
+  // rig frame, i.e. the timestamp index of the rig. All views of a rig frame
+  // share a single rig pose. Returns false if the view or rig does not exist,
+  // the camera index is not valid for the rig, the view already belongs to a
+  // rig or the camera of the rig frame already has a view.
+  bool AddViewToCameraRig(const ViewId view_id,
+                          const CameraRigId rig_id,
+                          const int camera_index,
+                          const int frame_id);
+
+  // Returns the rig membership of the view or a nullptr if the view does not
+  // belong to a rig.
+  const CameraRigMembership* CameraRigMembershipFromViewId(
+      const ViewId view_id) const;
+
+  // Returns the views of the rig frame.
+  std::vector<ViewId> GetViewsInCameraRigFrame(const CameraRigId rig_id,
+                                               const int frame_id) const;
+
   // Adds an empty track to the reconstruction. Note that this assumes that the
   // user will manage the visibility of the track.
   TrackId AddTrack();
@@ -135,6 +189,21 @@ class Reconstruction {
   // present, and kInvalidTrackId is returned.
   TrackId AddTrack(const std::vector<std::pair<ViewId, Feature> >& track);
 
+  // Adds many tracks at once and returns their ids, or kInvalidTrackId for the
+  // tracks that could not be added (see AddTrack). The observations are added
+  // to each view in bulk with View::AddFeatures, so the index from features to
+  // tracks of each view is built once.
+  std::vector<TrackId> AddTracks(
+      const std::vector<std::vector<std::pair<ViewId, Feature> > >& tracks);
+
+  // Reserves memory for num_tracks new tracks and for the additional
+  // observations of each view in num_observations_per_view. This is meant for
+  // adding many tracks at once (e.g., in TrackBuilder) so that the features of
+  // each view are allocated once with their final size.
+  void ReserveTracks(
+      const int num_tracks,
+      const std::unordered_map<ViewId, int>& num_observations_per_view);
+
   // Removes the track from the reconstruction including the corresponding
   // features that are present in the view that observe it.
   bool RemoveTrack(const TrackId track_id);
@@ -147,6 +216,11 @@ class Reconstruction {
   // Return all TrackIds in the reconstruction.
   std::vector<TrackId> TrackIds() const;
 
+  // Returns an estimate of the heap memory in bytes held by the views, their
+  // features and the tracks. This is used for memory accounting and does not
+  // include allocator overhead.
+  size_t EstimateMemoryUsage() const;
+
   // Normalizes the reconstruction such that the "center" of the reconstruction
   // is moved to the origin and the reconstruction is scaled such that the
   // median distance of 3D points from the origin is 100.0. This does not affect
@@ -157,6 +231,17 @@ class Reconstruction {
   // Ceres Solver.
   void Normalize();
 
+  // Same as above, but gathers the statistics and transforms the views and
+  // tracks with num_threads threads. The result does not depend on the number
+  // of threads.
+  void Normalize(const int num_threads);
+
+  // Updates the cached bearing vectors (see View::UpdateBearingVectors) of the
+  // views with num_threads threads. Views whose cache is up to date are
+  // skipped, so this is cheap unless intrinsics changed.
+  void UpdateBearingVectors(const std::unordered_set<ViewId>& view_ids,
+                            const int num_threads);
+
   // Obtain a sub-reconstruction which only contains the specified views and
   // corresponding tracks observed by those views. All views and tracks maintain
   // the same IDs as the original reconstruction.
@@ -179,25 +264,52 @@ class Reconstruction {
        tracks_,
        view_id_to_camera_intrinsics_group_id_,
        camera_intrinsics_groups_);
+    if (version > 0) {
+      ar(next_camera_rig_id_, camera_rigs_, view_id_to_camera_rig_membership_);
+      // The views of the rig frames are derived from the memberships.
+      if (std::is_base_of<cereal::detail::InputArchiveBase, Archive>::value) {
+        camera_rig_frames_.clear();
+        for (const auto& membership : view_id_to_camera_rig_membership_) {
+          camera_rig_frames_[CameraRigFrameKey(membership.second.rig_id,
+                                               membership.second.frame_id)]
+              .emplace_back(membership.first);
+        }
+      }
+    }
   }
 
+  static uint64_t CameraRigFrameKey(const CameraRigId rig_id,
+                                    const int frame_id);
+
   TrackId next_track_id_;
   ViewId next_view_id_;
   CameraIntrinsicsGroupId next_camera_intrinsics_group_id_;
 
   std::unordered_map<std::string, ViewId> view_name_to_id_;
-  std::unordered_map<double, ViewId> view_timestamp_to_id_;
-  std::unordered_map<ViewId, class View> views_;
-  std::unordered_map<TrackId, class Track> tracks_;
+  // Ordered so that the views can be queried by time ranges. The map is
+  // serialized in the same format as an unordered map.
+  std::map<double, ViewId> view_timestamp_to_id_;
+  // Views and tracks are stored in slot maps since there may be millions of
+  // them and their ids are assigned from the counters above.
+  SlotMap<ViewId, class View> views_;
+  SlotMap<TrackId, class Track> tracks_;
 
   std::unordered_map<ViewId, CameraIntrinsicsGroupId>
       view_id_to_camera_intrinsics_group_id_;
   std::unordered_map<CameraIntrinsicsGroupId, std::unordered_set<ViewId> >
       camera_intrinsics_groups_;
+
+  // The camera rigs, the rig memberships of the views and the views of each
+  // rig frame (keyed by CameraRigFrameKey).
+  CameraRigId next_camera_rig_id_;
+  std::unordered_map<CameraRigId, class CameraRig> camera_rigs_;
+  std::unordered_map<ViewId, CameraRigMembership>
+      view_id_to_camera_rig_membership_;
+  std::unordered_map<uint64_t, std::vector<ViewId> > camera_rig_frames_;
 };
 
 }  // namespace theia
 
-CEREAL_CLASS_VERSION(theia::Reconstruction, 0);
+CEREAL_CLASS_VERSION(theia::Reconstruction, 1);
 
 #endif  // THEIA_SFM_RECONSTRUCTION_H_
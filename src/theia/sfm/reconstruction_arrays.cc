@@ -0,0 +1,190 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#include "theia/sfm/reconstruction_arrays.h"
+
+#include <Eigen/Core>
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "theia/sfm/camera/camera.h"
+#include "theia/sfm/feature.h"
+#include "theia/sfm/reconstruction.h"
+#include "theia/sfm/track.h"
+#include "theia/sfm/view.h"
+#include "theia/util/executor.h"
+
+namespace theia {
+
+void GetViewArrays(const Reconstruction& reconstruction,
+                   const int num_threads,
+                   ViewArrays* arrays) {
+  std::vector<ViewId> view_ids = reconstruction.ViewIds();
+  std::sort(view_ids.begin(), view_ids.end());
+  const int num_views = view_ids.size();
+  arrays->view_ids.resize(num_views);
+  arrays->positions.resize(num_views, 3);
+  arrays->orientations.resize(num_views, 3);
+  arrays->is_estimated.resize(num_views);
+  ParallelFor(num_threads, num_views, [&](const int first, const int last) {
+    for (int i = first; i < last; i++) {
+      const View& view = *reconstruction.View(view_ids[i]);
+      arrays->view_ids[i] = view_ids[i];
+      arrays->positions.row(i) = view.Camera().GetPosition().transpose();
+      arrays->orientations.row(i) =
+          view.Camera().GetOrientationAsAngleAxis().transpose();
+      arrays->is_estimated[i] = view.IsEstimated();
+    }
+  });
+}
+
+void GetTrackArrays(const Reconstruction& reconstruction,
+                    const int num_threads,
+                    TrackArrays* arrays) {
+  std::vector<TrackId> track_ids = reconstruction.TrackIds();
+  std::sort(track_ids.begin(), track_ids.end());
+  const int num_tracks = track_ids.size();
+  arrays->track_ids.resize(num_tracks);
+  arrays->points.resize(num_tracks, 4);
+  arrays->colors.resize(num_tracks, 3);
+  arrays->is_estimated.resize(num_tracks);
+  ParallelFor(num_threads, num_tracks, [&](const int first, const int last) {
+    for (int i = first; i < last; i++) {
+      const Track& track = *reconstruction.Track(track_ids[i]);
+      arrays->track_ids[i] = track_ids[i];
+      arrays->points.row(i) = track.Point().transpose();
+      arrays->colors.row(i) = track.Color().transpose();
+      arrays->is_estimated[i] = track.IsEstimated();
+    }
+  });
+}
+
+void GetObservationArrays(const Reconstruction& reconstruction,
+                          const int num_threads,
+                          ObservationArrays* arrays) {
+  std::vector<ViewId> view_ids = reconstruction.ViewIds();
+  std::sort(view_ids.begin(), view_ids.end());
+
+  // The observations of view i are stored in rows [offsets[i], offsets[i + 1]).
+  std::vector<int64_t> offsets(view_ids.size() + 1, 0);
+  for (int i = 0; i < view_ids.size(); i++) {
+    offsets[i + 1] =
+        offsets[i] + reconstruction.View(view_ids[i])->NumFeatures();
+  }
+  const int64_t num_observations = offsets.back();
+  arrays->view_ids.resize(num_observations);
+  arrays->track_ids.resize(num_observations);
+  arrays->features.resize(num_observations, 2);
+  ParallelFor(
+      num_threads, view_ids.size(), [&](const int first, const int last) {
+        for (int i = first; i < last; i++) {
+          const View& view = *reconstruction.View(view_ids[i]);
+          std::vector<TrackId> track_ids = view.TrackIds();
+          std::sort(track_ids.begin(), track_ids.end());
+          int64_t row = offsets[i];
+          for (const TrackId track_id : track_ids) {
+            const Feature& feature = *view.GetFeature(track_id);
+            arrays->view_ids[row] = view_ids[i];
+            arrays->track_ids[row] = track_id;
+            arrays->features(row, 0) = feature.x();
+            arrays->features(row, 1) = feature.y();
+            ++row;
+          }
+        }
+      });
+}
+
+bool SetViewArrays(const ViewArrays& arrays,
+                   const int num_threads,
+                   Reconstruction* reconstruction) {
+  const int num_views = arrays.view_ids.size();
+  if (arrays.positions.rows() != num_views ||
+      arrays.orientations.rows() != num_views ||
+      arrays.is_estimated.size() != num_views) {
+    LOG(ERROR) << "The view arrays must have the same number of rows.";
+    return false;
+  }
+  for (int i = 0; i < num_views; i++) {
+    if (reconstruction->View(arrays.view_ids[i]) == nullptr) {
+      LOG(ERROR) << "View " << arrays.view_ids[i]
+                 << " is not in the reconstruction.";
+      return false;
+    }
+  }
+
+  ParallelFor(num_threads, num_views, [&](const int first, const int last) {
+    for (int i = first; i < last; i++) {
+      View* view = reconstruction->MutableView(arrays.view_ids[i]);
+      Camera* camera = view->MutableCamera();
+      camera->SetPosition(arrays.positions.row(i).transpose());
+      camera->SetOrientationFromAngleAxis(
+          arrays.orientations.row(i).transpose());
+      view->SetEstimated(arrays.is_estimated[i]);
+    }
+  });
+  return true;
+}
+
+bool SetTrackArrays(const TrackArrays& arrays,
+                    const int num_threads,
+                    Reconstruction* reconstruction) {
+  const int num_tracks = arrays.track_ids.size();
+  if (arrays.points.rows() != num_tracks ||
+      arrays.colors.rows() != num_tracks ||
+      arrays.is_estimated.size() != num_tracks) {
+    LOG(ERROR) << "The track arrays must have the same number of rows.";
+    return false;
+  }
+  for (int i = 0; i < num_tracks; i++) {
+    if (reconstruction->Track(arrays.track_ids[i]) == nullptr) {
+      LOG(ERROR) << "Track " << arrays.track_ids[i]
+                 << " is not in the reconstruction.";
+      return false;
+    }
+  }
+
+  ParallelFor(num_threads, num_tracks, [&](const int first, const int last) {
+    for (int i = first; i < last; i++) {
+      Track* track = reconstruction->MutableTrack(arrays.track_ids[i]);
+      track->SetPoint(arrays.points.row(i).transpose());
+      track->SetColor(arrays.colors.row(i).transpose());
+      track->SetEstimated(arrays.is_estimated[i]);
+    }
+  });
+  return true;
+}
+
+}  // namespace theia
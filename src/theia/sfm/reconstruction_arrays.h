@@ -0,0 +1,113 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#ifndef THEIA_SFM_RECONSTRUCTION_ARRAYS_H_
+#define THEIA_SFM_RECONSTRUCTION_ARRAYS_H_
+
+#include <Eigen/Core>
+#include <stdint.h>
+
+#include "theia/sfm/types.h"
+
+namespace theia {
+
+class Reconstruction;
+
+// Bulk copies of the geometry of a reconstruction in contiguous row-major
+// arrays, one row per view, track or observation. The views and tracks are
+// stored one object at a time in the reconstruction, so reading them into
+// arrays with the functions below is much faster than calling the accessors of
+// each object, in particular from Python where the arrays map directly to NumPy
+// arrays without another copy.
+typedef Eigen::Matrix<double, Eigen::Dynamic, 2, Eigen::RowMajor> RowMatrixX2d;
+typedef Eigen::Matrix<double, Eigen::Dynamic, 3, Eigen::RowMajor> RowMatrixX3d;
+typedef Eigen::Matrix<double, Eigen::Dynamic, 4, Eigen::RowMajor> RowMatrixX4d;
+typedef Eigen::Matrix<uint8_t, Eigen::Dynamic, 3, Eigen::RowMajor>
+    RowMatrixX3u8;
+
+// The camera poses of the views in increasing order of their ids.
+struct ViewArrays {
+  Eigen::Matrix<ViewId, Eigen::Dynamic, 1> view_ids;
+  // The camera positions in world coordinates.
+  RowMatrixX3d positions;
+  // The rotations from world to camera coordinates as angle-axis vectors.
+  RowMatrixX3d orientations;
+  Eigen::Matrix<bool, Eigen::Dynamic, 1> is_estimated;
+};
+
+// The points of the tracks in increasing order of their ids.
+struct TrackArrays {
+  Eigen::Matrix<TrackId, Eigen::Dynamic, 1> track_ids;
+  // Homogeneous points.
+  RowMatrixX4d points;
+  RowMatrixX3u8 colors;
+  Eigen::Matrix<bool, Eigen::Dynamic, 1> is_estimated;
+};
+
+// The observations of the tracks, i.e. the features of the views, ordered by
+// view id and then by track id.
+struct ObservationArrays {
+  Eigen::Matrix<ViewId, Eigen::Dynamic, 1> view_ids;
+  Eigen::Matrix<TrackId, Eigen::Dynamic, 1> track_ids;
+  // The pixel coordinates of the features.
+  RowMatrixX2d features;
+};
+
+// Copy the views, tracks or observations of the reconstruction into arrays
+// using num_threads threads.
+void GetViewArrays(const Reconstruction& reconstruction,
+                   const int num_threads,
+                   ViewArrays* arrays);
+void GetTrackArrays(const Reconstruction& reconstruction,
+                    const int num_threads,
+                    TrackArrays* arrays);
+void GetObservationArrays(const Reconstruction& reconstruction,
+                          const int num_threads,
+                          ObservationArrays* arrays);
+
+// Write the poses and estimated flags of the views, or the points, colors and
+// estimated flags of the tracks, back to the reconstruction. The arrays may
+// hold any subset of the views or tracks in any order, but each id may appear
+// only once. Returns false and leaves the reconstruction unchanged if the
+// arrays have different numbers of rows or an id is not in the reconstruction.
+bool SetViewArrays(const ViewArrays& arrays,
+                   const int num_threads,
+                   Reconstruction* reconstruction);
+bool SetTrackArrays(const TrackArrays& arrays,
+                    const int num_threads,
+                    Reconstruction* reconstruction);
+
+}  // namespace theia
+
+#endif  // THEIA_SFM_RECONSTRUCTION_ARRAYS_H_
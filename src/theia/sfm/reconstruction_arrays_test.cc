@@ -0,0 +1,188 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#include <Eigen/Core>
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "theia/sfm/camera/camera.h"
+#include "theia/sfm/feature.h"
+#include "theia/sfm/reconstruction.h"
+#include "theia/sfm/reconstruction_arrays.h"
+#include "theia/sfm/track.h"
+#include "theia/sfm/view.h"
+
+namespace theia {
+
+namespace {
+
+static const int kNumViews = 6;
+static const int kNumTracks = 300;
+
+// Each track is observed by two consecutive views.
+void CreateReconstruction(Reconstruction* reconstruction) {
+  for (int i = 0; i < kNumViews; i++) {
+    const ViewId view_id = reconstruction->AddView(std::to_string(i), i);
+    Camera* camera = reconstruction->MutableView(view_id)->MutableCamera();
+    camera->SetPosition(Eigen::Vector3d(i, 2.0 * i, -1.0));
+    camera->SetOrientationFromAngleAxis(Eigen::Vector3d(0.1 * i, 0.0, 0.2));
+    reconstruction->MutableView(view_id)->SetEstimated(i % 2 == 0);
+  }
+  for (int i = 0; i < kNumTracks; i++) {
+    const ViewId view_id = i % (kNumViews - 1);
+    const std::vector<std::pair<ViewId, Feature> > observations = {
+        {view_id, Feature(i, 0.5 * i)}, {view_id + 1, Feature(-i, i)}};
+    const TrackId track_id = reconstruction->AddTrack(observations);
+    Track* track = reconstruction->MutableTrack(track_id);
+    track->SetPoint(Eigen::Vector4d(i, i + 1, i + 2, 1.0));
+    track->SetColor(Eigen::Matrix<uint8_t, 3, 1>(i % 256, 1, 2));
+    track->SetEstimated(i % 3 != 0);
+  }
+}
+
+}  // namespace
+
+TEST(ReconstructionArrays, GetViewArrays) {
+  Reconstruction reconstruction;
+  CreateReconstruction(&reconstruction);
+  // Removed views leave free slots behind.
+  reconstruction.RemoveView(2);
+
+  ViewArrays arrays;
+  GetViewArrays(reconstruction, 4, &arrays);
+  ASSERT_EQ(arrays.view_ids.size(), kNumViews - 1);
+  for (int i = 0; i < arrays.view_ids.size(); i++) {
+    if (i > 0) {
+      EXPECT_LT(arrays.view_ids[i - 1], arrays.view_ids[i]);
+    }
+    const View& view = *reconstruction.View(arrays.view_ids[i]);
+    EXPECT_TRUE(arrays.positions.row(i).transpose() ==
+                view.Camera().GetPosition());
+    EXPECT_TRUE(arrays.orientations.row(i).transpose() ==
+                view.Camera().GetOrientationAsAngleAxis());
+    EXPECT_EQ(arrays.is_estimated[i], view.IsEstimated());
+  }
+}
+
+TEST(ReconstructionArrays, GetTrackArrays) {
+  Reconstruction reconstruction;
+  CreateReconstruction(&reconstruction);
+
+  TrackArrays arrays;
+  GetTrackArrays(reconstruction, 4, &arrays);
+  ASSERT_EQ(arrays.track_ids.size(), reconstruction.NumTracks());
+  for (int i = 0; i < arrays.track_ids.size(); i++) {
+    if (i > 0) {
+      EXPECT_LT(arrays.track_ids[i - 1], arrays.track_ids[i]);
+    }
+    const Track& track = *reconstruction.Track(arrays.track_ids[i]);
+    EXPECT_TRUE(arrays.points.row(i).transpose() == track.Point());
+    EXPECT_TRUE(arrays.colors.row(i).transpose() == track.Color());
+    EXPECT_EQ(arrays.is_estimated[i], track.IsEstimated());
+  }
+}
+
+TEST(ReconstructionArrays, GetObservationArrays) {
+  Reconstruction reconstruction;
+  CreateReconstruction(&reconstruction);
+
+  ObservationArrays arrays;
+  GetObservationArrays(reconstruction, 4, &arrays);
+  ASSERT_EQ(arrays.view_ids.size(), 2 * kNumTracks);
+  ASSERT_EQ(arrays.track_ids.size(), 2 * kNumTracks);
+  ASSERT_EQ(arrays.features.rows(), 2 * kNumTracks);
+  for (int i = 0; i < arrays.view_ids.size(); i++) {
+    if (i > 0) {
+      EXPECT_TRUE(arrays.view_ids[i - 1] < arrays.view_ids[i] ||
+                  (arrays.view_ids[i - 1] == arrays.view_ids[i] &&
+                   arrays.track_ids[i - 1] < arrays.track_ids[i]));
+    }
+    const Feature* feature = reconstruction.View(arrays.view_ids[i])
+                                 ->GetFeature(arrays.track_ids[i]);
+    ASSERT_NE(feature, nullptr);
+    EXPECT_EQ(arrays.features(i, 0), feature->x());
+    EXPECT_EQ(arrays.features(i, 1), feature->y());
+  }
+}
+
+TEST(ReconstructionArrays, SetArrays) {
+  Reconstruction reconstruction;
+  CreateReconstruction(&reconstruction);
+
+  ViewArrays view_arrays;
+  GetViewArrays(reconstruction, 1, &view_arrays);
+  view_arrays.positions.array() += 1.0;
+  view_arrays.orientations.col(1).setConstant(0.3);
+  view_arrays.is_estimated.setConstant(true);
+  EXPECT_TRUE(SetViewArrays(view_arrays, 4, &reconstruction));
+  ViewArrays updated_view_arrays;
+  GetViewArrays(reconstruction, 1, &updated_view_arrays);
+  EXPECT_TRUE(updated_view_arrays.positions == view_arrays.positions);
+  EXPECT_TRUE(updated_view_arrays.orientations.isApprox(
+      view_arrays.orientations, 1e-12));
+  EXPECT_TRUE(updated_view_arrays.is_estimated == view_arrays.is_estimated);
+
+  // Only a subset of the tracks is written back.
+  TrackArrays track_arrays;
+  GetTrackArrays(reconstruction, 1, &track_arrays);
+  TrackArrays subset;
+  subset.track_ids = track_arrays.track_ids.tail(10);
+  subset.points = track_arrays.points.bottomRows(10) * 2.0;
+  subset.colors = track_arrays.colors.bottomRows(10);
+  subset.colors.col(2).setConstant(7);
+  subset.is_estimated = track_arrays.is_estimated.tail(10);
+  EXPECT_TRUE(SetTrackArrays(subset, 4, &reconstruction));
+  TrackArrays updated_track_arrays;
+  GetTrackArrays(reconstruction, 1, &updated_track_arrays);
+  EXPECT_TRUE(updated_track_arrays.points.topRows(kNumTracks - 10) ==
+              track_arrays.points.topRows(kNumTracks - 10));
+  EXPECT_TRUE(updated_track_arrays.points.bottomRows(10) == subset.points);
+  EXPECT_TRUE(updated_track_arrays.colors.bottomRows(10) == subset.colors);
+
+  // Invalid arrays do not change the reconstruction.
+  subset.track_ids[0] = 100000;
+  subset.points.setZero();
+  EXPECT_FALSE(SetTrackArrays(subset, 1, &reconstruction));
+  subset.track_ids[0] = track_arrays.track_ids[0];
+  subset.is_estimated.resize(3);
+  EXPECT_FALSE(SetTrackArrays(subset, 1, &reconstruction));
+  GetTrackArrays(reconstruction, 1, &track_arrays);
+  EXPECT_TRUE(track_arrays.points == updated_track_arrays.points);
+}
+
+}  // namespace theia
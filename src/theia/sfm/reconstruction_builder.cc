@@ -35,27 +35,55 @@
 #include "theia/sfm/reconstruction_builder.h"
 
 #include <glog/logging.h>
+#include <algorithm>
 #include <memory>
+#include <mutex>  // NOLINT
 #include <string>
+#include <utility>
 #include <vector>
 
+#include "theia/io/chunked_matches_file.h"
 #include "theia/matching/features_and_matches_database.h"
 #include "theia/matching/image_pair_match.h"
 #include "theia/matching/rocksdb_features_and_matches_database.h"
 #include "theia/sfm/camera_intrinsics_prior.h"
 #include "theia/sfm/feature_extractor_and_matcher.h"
+#include "theia/sfm/parallel_track_builder.h"
 #include "theia/sfm/reconstruction.h"
+#include "theia/sfm/reconstruction_checkpoint.h"
 #include "theia/sfm/reconstruction_estimator.h"
 #include "theia/sfm/track_builder.h"
+#include "theia/sfm/twoview_info.h"
 #include "theia/sfm/types.h"
 #include "theia/sfm/view.h"
 #include "theia/sfm/view_graph/view_graph.h"
+#include "theia/util/executor.h"
 #include "theia/util/filesystem.h"
+#include "theia/util/memory_accounting.h"
+#include "theia/util/metrics.h"
+#include "theia/util/random.h"
+#include "theia/util/trace.h"
 
 namespace theia {
 
 namespace {
 
+// The seed of the random number generator in deterministic mode if none is
+// given.
+static const unsigned kDeterministicSeed = 41;
+
+// In deterministic mode, seeds the random number generator if it is not set
+// and makes the reconstruction estimator deterministic as well.
+void SetDeterministicOptions(ReconstructionBuilderOptions* options) {
+  if (!options->deterministic) {
+    return;
+  }
+  if (options->rng == nullptr) {
+    options->rng = std::make_shared<RandomNumberGenerator>(kDeterministicSeed);
+  }
+  options->reconstruction_estimator_options.deterministic = true;
+}
+
 // Add the view to the reconstruction. If the camera intrinsics group id is set
 // to an invalid group id then simply add the view to the reconstruction without
 // shared camera intrinsics.
@@ -148,6 +176,15 @@ void RemoveEstimatedViewsAndTracks(Reconstruction* reconstruction,
   }
 }
 
+std::unique_ptr<PeriodicMetricsWriter> CreateMetricsWriter(
+    const ReconstructionBuilderOptions& options) {
+  if (options.metrics_output_file.empty()) {
+    return nullptr;
+  }
+  return std::unique_ptr<PeriodicMetricsWriter>(new PeriodicMetricsWriter(
+      options.metrics_output_file, options.metrics_export_interval_in_seconds));
+}
+
 }  // namespace
 
 ReconstructionBuilder::ReconstructionBuilder(
@@ -156,19 +193,23 @@ ReconstructionBuilder::ReconstructionBuilder(
     std::unique_ptr<ViewGraph> view_graph)
     : options_(options),
       reconstruction_(std::move(reconstruction)),
-      view_graph_(std::move(view_graph)) {
+      view_graph_(std::move(view_graph)),
+      metrics_writer_(CreateMetricsWriter(options)) {
   CHECK_GT(options.num_threads, 0);
-  options_.reconstruction_estimator_options.rng = options.rng;
+  SetDeterministicOptions(&options_);
+  options_.reconstruction_estimator_options.rng = options_.rng;
 }
 
 ReconstructionBuilder::ReconstructionBuilder(
     const ReconstructionBuilderOptions& options,
     FeaturesAndMatchesDatabase* features_and_matches_database)
     : options_(options),
-      features_and_matches_database_(features_and_matches_database) {
+      features_and_matches_database_(features_and_matches_database),
+      metrics_writer_(CreateMetricsWriter(options)) {
   CHECK_GT(options.num_threads, 0);
 
-  options_.reconstruction_estimator_options.rng = options.rng;
+  SetDeterministicOptions(&options_);
+  options_.reconstruction_estimator_options.rng = options_.rng;
 
   reconstruction_.reset(new Reconstruction());
   view_graph_.reset(new ViewGraph());
@@ -178,10 +219,11 @@ ReconstructionBuilder::ReconstructionBuilder(
   // Set up feature extraction and matching.
   FeatureExtractorAndMatcher::Options feam_options;
   feam_options.num_threads = options_.num_threads;
+  feam_options.deterministic = options_.deterministic;
   feam_options.only_calibrated_views = options_.only_calibrated_views;
-  feam_options.num_threads = options_.num_threads;
   feam_options.descriptor_extractor_type = options_.descriptor_type;
   feam_options.feature_density = options_.feature_density;
+  feam_options.quantize_descriptors = options_.quantize_descriptors;
   feam_options.min_num_inlier_matches = options_.min_num_inlier_matches;
   feam_options.matching_strategy = options_.matching_strategy;
   feam_options.feature_matcher_options = options_.matching_options;
@@ -199,6 +241,29 @@ ReconstructionBuilder::ReconstructionBuilder(
       options_.num_gmm_clusters_for_fisher_vector;
   feam_options.max_num_features_for_fisher_vector_training =
       options_.max_num_features_for_fisher_vector_training;
+  feam_options.global_descriptor_pca_dimension =
+      options_.global_descriptor_pca_dimension;
+  feam_options.global_descriptor_extractor_type =
+      options_.global_descriptor_extractor_type;
+  feam_options.vocabulary_tree_branching_factor =
+      options_.vocabulary_tree_branching_factor;
+  feam_options.vocabulary_tree_depth = options_.vocabulary_tree_depth;
+  feam_options.max_num_features_for_vocabulary_tree_training =
+      options_.max_num_features_for_vocabulary_tree_training;
+  feam_options.rerank_retrieved_image_pairs =
+      options_.rerank_retrieved_image_pairs;
+  feam_options.spatial_reranking_options = options_.spatial_reranking_options;
+  feam_options.select_image_pairs_sequentially =
+      options_.select_image_pairs_sequentially;
+  feam_options.sequential_pair_selector_options =
+      options_.sequential_pair_selector_options;
+  feam_options.select_image_pairs_with_position_priors =
+      options_.select_image_pairs_with_position_priors;
+  feam_options.spatial_pair_selection_options =
+      options_.spatial_pair_selection_options;
+  feam_options.intersect_spatial_pairs_with_retrieval =
+      options_.intersect_spatial_pairs_with_retrieval;
+  feam_options.match_features = options_.match_features;
 
   feature_extractor_and_matcher_.reset(new FeatureExtractorAndMatcher(
       feam_options, features_and_matches_database_));
@@ -223,6 +288,7 @@ bool ReconstructionBuilder::AddImage(
                                reconstruction_.get())) {
     return false;
   }
+  feature_extractor_and_matcher_->SetImageTimestamp(image_filepath, timestamp);
   return feature_extractor_and_matcher_->AddImage(image_filepath);
 }
 
@@ -249,10 +315,32 @@ bool ReconstructionBuilder::AddImageWithCameraIntrinsicsPrior(
                                reconstruction_.get())) {
     return false;
   }
+  feature_extractor_and_matcher_->SetImageTimestamp(image_filepath, timestamp);
   return feature_extractor_and_matcher_->AddImage(image_filepath,
                                                   camera_intrinsics_prior);
 }
 
+bool ReconstructionBuilder::SetImagePositionPrior(
+    const std::string& image_filepath,
+    const Eigen::Vector3d& position_prior,
+    const Eigen::Matrix3d& position_prior_information) {
+  std::string image_filename;
+  CHECK(GetFilenameFromFilepath(image_filepath, true, &image_filename));
+  const ViewId view_id = reconstruction_->ViewIdFromName(image_filename);
+  if (view_id == kInvalidViewId) {
+    LOG(WARNING) << "Could not set the position prior of " << image_filename
+                 << " because it has not been added.";
+    return false;
+  }
+  reconstruction_->MutableView(view_id)->SetPositionPrior(
+      position_prior, position_prior_information);
+  if (feature_extractor_and_matcher_ != nullptr) {
+    feature_extractor_and_matcher_->SetImagePositionPrior(image_filepath,
+                                                          position_prior);
+  }
+  return true;
+}
+
 void ReconstructionBuilder::RemoveUncalibratedViews() {
   const auto& view_ids = reconstruction_->ViewIds();
   for (const ViewId view_id : view_ids) {
@@ -272,6 +360,7 @@ bool ReconstructionBuilder::AddMaskForFeaturesExtraction(
 }
 
 bool ReconstructionBuilder::ExtractAndMatchFeatures() {
+  THEIA_TRACE_SCOPE("ReconstructionBuilder::ExtractAndMatchFeatures");
   CHECK_EQ(view_graph_->NumViews(), 0) << "Cannot call ExtractAndMatchFeatures "
                                           "after TwoViewMatches has been "
                                           "called.";
@@ -311,22 +400,87 @@ bool ReconstructionBuilder::ExtractAndMatchFeatures() {
   //
   ///////////////////////////////////
 
-  // Add the matches to the view graph and reconstruction.
-  const auto& match_keys =
-      features_and_matches_database_->ImageNamesOfMatches();
-  for (const auto& match_key : match_keys) {
-    const ImagePairMatch& match =
-        features_and_matches_database_->GetImagePairMatch(match_key.first,
-                                                          match_key.second);
-    AddTwoViewMatch(match_key.first, match_key.second, match);
+  // Build the tracks in parallel while the matches are read from the database.
+  // The matches are read in the order the threads are scheduled, so the view
+  // pairs are collected and added to the view graph in the order of their view
+  // ids afterwards.
+  std::mutex view_pairs_mutex;
+  std::vector<std::pair<ViewIdPair, TwoViewInfo> > view_pairs;
+  ParallelTrackBuilder track_builder(options_.min_track_length,
+                                     options_.max_track_length,
+                                     options_.num_threads);
+  track_builder.BuildTracks(
+      features_and_matches_database_,
+      [this, &view_pairs_mutex, &view_pairs](const std::string& image1,
+                                             const std::string& image2,
+                                             const ImagePairMatch& match) {
+        const ViewIdPair view_id_pair(reconstruction_->ViewIdFromName(image1),
+                                      reconstruction_->ViewIdFromName(image2));
+        if (!IsValidMatch(view_id_pair.first, view_id_pair.second)) {
+          return false;
+        }
+        std::lock_guard<std::mutex> lock(view_pairs_mutex);
+        view_pairs.emplace_back(view_id_pair, match.twoview_info);
+        return true;
+      },
+      reconstruction_.get());
+
+  std::sort(view_pairs.begin(),
+            view_pairs.end(),
+            [](const std::pair<ViewIdPair, TwoViewInfo>& lhs,
+               const std::pair<ViewIdPair, TwoViewInfo>& rhs) {
+              return lhs.first < rhs.first;
+            });
+  ImagePairMatch image_matches;
+  for (const auto& view_pair : view_pairs) {
+    image_matches.twoview_info = view_pair.second;
+    AddMatchToViewGraph(
+        view_pair.first.first, view_pair.first.second, image_matches);
   }
 
+  LogMemoryUsage("feature matching and track building", {});
   return true;
 }
 
 bool ReconstructionBuilder::AddTwoViewMatch(const std::string& image1,
                                             const std::string& image2,
                                             const ImagePairMatch& matches) {
+  if (AddValidMatchToViewGraph(image1, image2, matches)) {
+    // Add tracks to the track builder.
+    AddTracksForMatch(reconstruction_->ViewIdFromName(image1),
+                      reconstruction_->ViewIdFromName(image2),
+                      matches);
+  }
+  return true;
+}
+
+bool ReconstructionBuilder::AddTwoViewMatchesFromFile(
+    const std::string& matches_file,
+    const CameraIntrinsicsGroupId camera_intrinsics_group) {
+  int num_images = 0;
+  int num_matches = 0;
+  const bool success = ReadChunkedMatches(
+      matches_file,
+      [&](const std::string& image_name, const CameraIntrinsicsPrior& prior) {
+        AddImageWithCameraIntrinsicsPrior(
+            image_name, prior, camera_intrinsics_group, num_images);
+        ++num_images;
+        return true;
+      },
+      [&](const ImagePairMatch& match) {
+        AddTwoViewMatch(match.image1, match.image2, match);
+        ++num_matches;
+        return true;
+      });
+  LOG(INFO) << "Loaded " << num_images << " images and " << num_matches
+            << " matches from " << matches_file;
+  return success;
+}
+
+bool ReconstructionBuilder::AddValidMatchToViewGraph(
+    const std::string& image1,
+    const std::string& image2,
+    const ImagePairMatch& matches) {
   // Get view ids from names and check that the views are valid (i.e. that
   // they have been added to the reconstruction).
   const ViewId view_id1 = reconstruction_->ViewIdFromName(image1);
@@ -337,43 +491,115 @@ bool ReconstructionBuilder::AddTwoViewMatch(const std::string& image1,
   CHECK_NE(view_id2, kInvalidViewId)
       << "Tried to add a view with the name " << image2
       << " to the view graph but does not exist in the reconstruction.";
-
-  // If we only want calibrated views, do not add the match if it contains an
-  // uncalibrated view since it will add uncalibrated views to the tracks.
-  const View* view1 = reconstruction_->View(view_id1);
-  const View* view2 = reconstruction_->View(view_id2);
-  if (options_.only_calibrated_views &&
-      (!view1->CameraIntrinsicsPrior().focal_length.is_set ||
-       !view2->CameraIntrinsicsPrior().focal_length.is_set)) {
-    return true;
+  if (!IsValidMatch(view_id1, view_id2)) {
+    return false;
   }
 
   // Add valid matches to view graph.
   AddMatchToViewGraph(view_id1, view_id2, matches);
-
-  // Add tracks to the track builder.
-  AddTracksForMatch(view_id1, view_id2, matches);
-
   return true;
 }
 
+bool ReconstructionBuilder::IsValidMatch(const ViewId view_id1,
+                                         const ViewId view_id2) const {
+  // If we only want calibrated views, do not add the match if it contains an
+  // uncalibrated view since it will add uncalibrated views to the tracks.
+  const View* view1 = reconstruction_->View(view_id1);
+  const View* view2 = reconstruction_->View(view_id2);
+  return !options_.only_calibrated_views ||
+         (view1->CameraIntrinsicsPrior().focal_length.is_set &&
+          view2->CameraIntrinsicsPrior().focal_length.is_set);
+}
+
 bool ReconstructionBuilder::BuildReconstruction(
     std::vector<Reconstruction*>* reconstructions) {
-  CHECK_GE(view_graph_->NumViews(), 2) << "At least 2 images must be provided "
-                                          "in order to create a "
-                                          "reconstruction.";
-
-  // Build tracks if they were not explicitly specified.
-  if (reconstruction_->NumTracks() == 0) {
-    track_builder_->BuildTracks(reconstruction_.get());
+  THEIA_TRACE_SCOPE("ReconstructionBuilder::BuildReconstruction");
+  // Resume from the last checkpoint if there is one.
+  std::shared_ptr<ReconstructionCheckpoint> checkpoint;
+  bool resumed_from_checkpoint = false;
+  if (!options_.checkpoint_directory.empty()) {
+    checkpoint = std::make_shared<ReconstructionCheckpoint>(
+        options_.checkpoint_directory);
+    std::unique_ptr<ViewGraph> view_graph(new ViewGraph());
+    std::unique_ptr<Reconstruction> reconstruction(new Reconstruction());
+    bool read_checkpoint =
+        options_.restart_stage != ReconstructionCheckpointStage::NONE &&
+        checkpoint->Read(view_graph.get(), reconstruction.get());
+    // Go back to the restart stage if the last checkpoint is past it.
+    if (read_checkpoint && checkpoint->Stage() > options_.restart_stage) {
+      view_graph.reset(new ViewGraph());
+      reconstruction.reset(new Reconstruction());
+      read_checkpoint = checkpoint->ReadStage(
+          options_.restart_stage, view_graph.get(), reconstruction.get());
+      LOG_IF(WARNING, !read_checkpoint)
+          << "The checkpoint has no state of the restart stage. Starting over.";
+    }
+    if (read_checkpoint) {
+      CHECK(checkpoint->ReadCompletedReconstructions(reconstructions))
+          << "Could not read the completed reconstructions of the checkpoint.";
+      view_graph_ = std::move(view_graph);
+      reconstruction_ = std::move(reconstruction);
+      resumed_from_checkpoint = true;
+      if (checkpoint->Stage() == ReconstructionCheckpointStage::FINISHED) {
+        return reconstructions->size() > 0;
+      }
+    }
   }
+  options_.reconstruction_estimator_options.checkpoint = checkpoint;
+  options_.reconstruction_estimator_options.stop_stage = options_.stop_stage;
+  const bool stop_after_first_estimation =
+      checkpoint != nullptr &&
+      options_.reconstruction_estimator_options.reconstruction_estimator_type ==
+          ReconstructionEstimatorType::GLOBAL &&
+      (options_.stop_stage ==
+           ReconstructionCheckpointStage::ROTATIONS_ESTIMATED ||
+       options_.stop_stage ==
+           ReconstructionCheckpointStage::POSITIONS_ESTIMATED);
+
+  // Marks the checkpoint as finished so that resuming from it only reads the
+  // completed reconstructions.
+  const auto finish = [&](const bool success) {
+    if (checkpoint != nullptr &&
+        !checkpoint->WriteFinished(*view_graph_, *reconstruction_)) {
+      LOG(WARNING) << "Could not write the checkpoint.";
+    }
+    return success;
+  };
 
-  // Remove uncalibrated views from the reconstruction and view graph.
-  if (options_.only_calibrated_views) {
-    LOG(INFO) << "Removing uncalibrated views.";
-    RemoveUncalibratedViews();
+  if (!resumed_from_checkpoint) {
+    CHECK_GE(view_graph_->NumViews(), 2) << "At least 2 images must be "
+                                            "provided in order to create a "
+                                            "reconstruction.";
+
+    // Build tracks if they were not explicitly specified.
+    if (reconstruction_->NumTracks() == 0) {
+      track_builder_->BuildTracks(reconstruction_.get());
+    }
+
+    // Remove uncalibrated views from the reconstruction and view graph.
+    if (options_.only_calibrated_views) {
+      LOG(INFO) << "Removing uncalibrated views.";
+      RemoveUncalibratedViews();
+    }
+
+    if (checkpoint != nullptr &&
+        !checkpoint->Write(ReconstructionCheckpointStage::TRACKS_BUILT,
+                           *view_graph_,
+                           *reconstruction_,
+                           {},
+                           {})) {
+      LOG(WARNING) << "Could not write the checkpoint.";
+    }
+    LogMemoryUsage("track building", *reconstructions);
+  }
+  if (checkpoint != nullptr &&
+      options_.stop_stage == ReconstructionCheckpointStage::TRACKS_BUILT) {
+    LOG(INFO) << "Stopped after building the tracks.";
+    return false;
   }
 
+  const ScopedNumaAffinity numa_affinity(
+      options_.reconstruction_estimator_options.numa_aware);
   while (reconstruction_->NumViews() > 1) {
     LOG(INFO) << "Attempting to reconstruct " << reconstruction_->NumViews()
               << " images from " << view_graph_->NumEdges()
@@ -385,10 +611,14 @@ bool ReconstructionBuilder::BuildReconstruction(
 
     const auto& summary = reconstruction_estimator->Estimate(
         view_graph_.get(), reconstruction_.get());
+    if (stop_after_first_estimation) {
+      LOG(INFO) << summary.message;
+      return false;
+    }
 
     // If a reconstruction can no longer be estimated, return.
     if (!summary.success) {
-      return reconstructions->size() > 0;
+      return finish(reconstructions->size() > 0);
     }
 
     LOG(INFO) << "\nReconstruction estimation statistics: "
@@ -409,19 +639,25 @@ bool ReconstructionBuilder::BuildReconstruction(
     reconstructions->emplace_back(
         CreateEstimatedSubreconstruction(*reconstruction_));
     RemoveEstimatedViewsAndTracks(reconstruction_.get(), view_graph_.get());
+    if (checkpoint != nullptr &&
+        !checkpoint->WriteCompletedReconstruction(
+            *reconstructions->back(), *view_graph_, *reconstruction_)) {
+      LOG(WARNING) << "Could not write the checkpoint.";
+    }
+    LogMemoryUsage("reconstruction estimation", *reconstructions);
 
     // Exit after the first reconstruction estimation if only the single largest
     // reconstruction is desired.
     if (options_.reconstruct_largest_connected_component) {
-      return reconstructions->size() > 0;
+      return finish(reconstructions->size() > 0);
     }
 
     if (reconstruction_->NumViews() < 3) {
       LOG(INFO) << "No more reconstructions can be estimated.";
-      return reconstructions->size() > 0;
+      return finish(reconstructions->size() > 0);
     }
   }
-  return true;
+  return finish(true);
 }
 
 void ReconstructionBuilder::AddMatchToViewGraph(
@@ -448,4 +684,16 @@ void ReconstructionBuilder::AddTracksForMatch(const ViewId view_id1,
   }
 }
 
+void ReconstructionBuilder::LogMemoryUsage(
+    const std::string& stage,
+    const std::vector<Reconstruction*>& reconstructions) {
+  size_t reconstructions_size_in_bytes = reconstruction_->EstimateMemoryUsage();
+  for (const Reconstruction* reconstruction : reconstructions) {
+    reconstructions_size_in_bytes += reconstruction->EstimateMemoryUsage();
+  }
+  MemoryAccounting::SetUsage("reconstruction", reconstructions_size_in_bytes);
+  MemoryAccounting::SetUsage("view_graph", view_graph_->EstimateMemoryUsage());
+  MemoryAccounting::LogUsage(stage);
+}
+
 }  // namespace theia
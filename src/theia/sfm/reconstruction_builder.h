@@ -42,6 +42,11 @@
 #include "theia/image/descriptor/create_descriptor_extractor.h"
 #include "theia/matching/create_feature_matcher.h"
 #include "theia/matching/feature_matcher_options.h"
+#include "theia/matching/global_descriptor_extractor.h"
+#include "theia/matching/sequential_pair_selector.h"
+#include "theia/matching/spatial_pair_selection.h"
+#include "theia/matching/spatial_reranking.h"
+#include "theia/sfm/reconstruction_checkpoint.h"
 #include "theia/sfm/reconstruction_estimator_options.h"
 #include "theia/sfm/types.h"
 #include "theia/util/util.h"
@@ -49,6 +54,7 @@
 namespace theia {
 class FeatureExtractorAndMatcher;
 class FeaturesAndMatchesDatabase;
+class PeriodicMetricsWriter;
 class RandomNumberGenerator;
 class Reconstruction;
 class TrackBuilder;
@@ -66,6 +72,15 @@ struct ReconstructionBuilderOptions {
   // matching, estimation, etc.) will use this number of threads.
   int num_threads = 1;
 
+  // If true, the same images and options always produce the same
+  // reconstruction, regardless of num_threads and of the thread scheduling:
+  // images are added to the matcher in the order of AddImage, matches are added
+  // to the view graph in the order of their view ids, and rng is seeded with a
+  // fixed seed if it is not set. Feature extraction, matching and track
+  // building stay parallel, but bundle adjustment runs on a single thread (see
+  // ReconstructionEstimatorOptions::deterministic).
+  bool deterministic = false;
+
   // By default, the ReconstructionBuilder will attempt to reconstruct as many
   // models as possible from the input data. If set to true, only the largest
   // connected component is reconstructed.
@@ -81,7 +96,9 @@ struct ReconstructionBuilderOptions {
   int min_track_length = 2;
 
   // Maximum allowable track length. Tracks that are too long are exceedingly
-  // likely to contain outliers.
+  // likely to contain outliers. Tracks built from the matches of
+  // ExtractAndMatchFeatures are discarded if they are too long, while tracks
+  // built from matches added with AddTwoViewMatch are split.
   int max_track_length = 50;
 
   // Minimum number of geometrically verified inliers that a view pair must have
@@ -97,6 +114,10 @@ struct ReconstructionBuilderOptions {
   // extracted.
   FeatureDensity feature_density = FeatureDensity::NORMAL;
 
+  // If true, float descriptors are stored quantized to one byte per dimension,
+  // which cuts their storage and memory bandwidth by 4x.
+  bool quantize_descriptors = false;
+
   // Keypoints and descriptors are stored to disk as they are added to the
   // FeatureMatcher. Features will be stored in this directory, which must be a
   // valid writeable directory.
@@ -122,6 +143,84 @@ struct ReconstructionBuilderOptions {
   int num_gmm_clusters_for_fisher_vector = 16;
   int max_num_features_for_fisher_vector_training = 1000000;
 
+  // If positive, Fisher vectors are compressed to this many dimensions with
+  // PCA whitening before the nearest neighbor images are searched. See
+  // FeatureExtractorAndMatcher::Options.
+  int global_descriptor_pca_dimension = 256;
+
+  // The global descriptor used to find the nearest neighbors of each image.
+  // Fisher vectors are compared between all pairs of images, which is
+  // quadratic in the number of images. The vocabulary tree indexes the images
+  // in an inverted file and only scores the images that share visual words
+  // with each query, which scales to much larger image collections.
+  GlobalDescriptorExtractorType global_descriptor_extractor_type =
+      GlobalDescriptorExtractorType::FISHER_VECTOR;
+
+  // Specific options for vocabulary tree global feature extraction. The
+  // vocabulary has at most branching_factor^depth visual words.
+  int vocabulary_tree_branching_factor = 10;
+  int vocabulary_tree_depth = 5;
+  int max_num_features_for_vocabulary_tree_training = 1000000;
+
+  // If true, the image pairs retrieved with global descriptor matching are only
+  // matched if a subsample of their features passes a cheap similarity/affine
+  // consistency check. See //theia/matching/spatial_reranking.h
+  bool rerank_retrieved_image_pairs = false;
+  SpatialRerankingOptions spatial_reranking_options;
+
+  // If true, the images are treated as a sequence ordered by their timestamps
+  // and each image is only matched to the images that follow it within an
+  // adaptive temporal window. If global descriptor matching is enabled as
+  // well, the retrieved nearest neighbors are matched as loop closure
+  // candidates. See //theia/matching/sequential_pair_selector.h
+  bool select_image_pairs_sequentially = false;
+  SequentialPairSelector::Options sequential_pair_selector_options;
+
+  // If true, each image is only matched to its nearest neighbors according to
+  // the position priors set with SetImagePositionPrior. If global descriptor
+  // matching is enabled as well, the retrieved pairs are intersected with the
+  // spatial pairs, or combined with them if
+  // intersect_spatial_pairs_with_retrieval is false.
+  // See //theia/matching/spatial_pair_selection.h
+  bool select_image_pairs_with_position_priors = false;
+  SpatialPairSelectionOptions spatial_pair_selection_options;
+  bool intersect_spatial_pairs_with_retrieval = true;
+
+  // If not empty, the state of the pipeline is written to this directory after
+  // the tracks are built, after the global rotations and positions are
+  // estimated and after each completed reconstruction. BuildReconstruction
+  // resumes from the last checkpoint in the directory, if any, so that an
+  // interrupted run does not have to start over.
+  // See //theia/sfm/reconstruction_checkpoint.h
+  std::string checkpoint_directory = "";
+
+  // BuildReconstruction resumes from the last checkpoint unless it is past
+  // restart_stage. In that case it restarts after restart_stage of the first
+  // reconstruction, e.g. POSITIONS_ESTIMATED only repeats the triangulation and
+  // bundle adjustment. NONE ignores the checkpoints and starts over from the
+  // matches.
+  ReconstructionCheckpointStage restart_stage =
+      ReconstructionCheckpointStage::FINISHED;
+
+  // BuildReconstruction returns false once the checkpoint of this stage is
+  // written, without estimating the reconstructions. TRACKS_BUILT stops after
+  // building the tracks, ROTATIONS_ESTIMATED and POSITIONS_ESTIMATED after
+  // these stages of the first reconstruction if the global estimator is used.
+  // Requires a checkpoint directory.
+  ReconstructionCheckpointStage stop_stage =
+      ReconstructionCheckpointStage::FINISHED;
+
+  // If false, ExtractAndMatchFeatures only extracts the features of the images
+  // and stores them in the database.
+  bool match_features = true;
+
+  // If not empty, the metrics of the pipeline (see //theia/util/metrics.h) are
+  // written to this file every metrics_export_interval_in_seconds while the
+  // builder exists, as Prometheus text if the file has the extension ".prom"
+  // and as JSON otherwise.
+  std::string metrics_output_file = "";
+  double metrics_export_interval_in_seconds = 30.0;
+
   // Options for estimating the reconstruction.
   // See //theia/sfm/reconstruction_estimator_options.h
   ReconstructionEstimatorOptions reconstruction_estimator_options;
@@ -164,17 +263,37 @@ class ReconstructionBuilder {
       const CameraIntrinsicsGroupId camera_intrinsics_group,
       const double timestamp);
 
+  // Sets the position prior (e.g., a GPS position in ECEF coordinates obtained
+  // with GPSConverter::LLAToECEF) of an image that has already been added. The
+  // prior is used to select the image pairs to match if
+  // select_image_pairs_with_position_priors is true.
+  bool SetImagePositionPrior(const std::string& image_filepath,
+                             const Eigen::Vector3d& position_prior,
+                             const Eigen::Matrix3d& position_prior_information);
+
   // Add a match to the view graph. Either this method is repeatedly called or
   // ExtractAndMatchFeatures must be called.
   bool AddTwoViewMatch(const std::string& image1,
                        const std::string& image2,
                        const ImagePairMatch& matches);
 
+  // Adds the images with their camera intrinsics priors and the matches stored
+  // in a chunked matches file (see theia/io/chunked_matches_file.h). The file
+  // is streamed so that only one chunk of matches is in memory at a time, and
+  // its priors must precede the matches of their images. The images are added
+  // to the given camera intrinsics group with consecutive timestamps in the
+  // order of the file. Returns false if the file could not be read.
+  bool AddTwoViewMatchesFromFile(
+      const std::string& matches_file,
+      const CameraIntrinsicsGroupId camera_intrinsics_group);
+
   // Assignes a mask to an image to indicate the area for keypoints extraction.
   bool AddMaskForFeaturesExtraction(const std::string& image_filepath,
                                     const std::string& mask_filepath);
 
-  // Extracts features and performs matching with geometric verification.
+  // Extracts features and performs matching with geometric verification. The
+  // matches are added to the view graph and the tracks are built from them with
+  // a ParallelTrackBuilder using num_threads threads.
   bool ExtractAndMatchFeatures();
 
   // Estimates a Structure-from-Motion reconstruction using the specified
@@ -183,10 +302,22 @@ class ReconstructionBuilder {
   // been estimated, all views that have been successfully estimated are added
   // to the output vector and we estimate a reconstruction from the remaining
   // unestimated views. We repeat this process until no more views can be
-  // successfully estimated.
+  // successfully estimated. If a checkpoint directory is set, the views, tracks
+  // and matches added to the builder are replaced by the state of the last
+  // checkpoint in it.
   bool BuildReconstruction(std::vector<Reconstruction*>* reconstructions);
 
  private:
+  // Adds the matches to the view graph if both views are valid. Returns true if
+  // the matches were added and should be used to build tracks.
+  bool AddValidMatchToViewGraph(const std::string& image1,
+                                const std::string& image2,
+                                const ImagePairMatch& matches);
+
+  // Returns true if the matches between the views should be used, i.e. if
+  // both views are calibrated or uncalibrated views are allowed.
+  bool IsValidMatch(const ViewId view_id1, const ViewId view_id2) const;
+
   // Adds the given matches as edges in the view graph.
   void AddMatchToViewGraph(const ViewId view_id1,
                            const ViewId view_id2,
@@ -201,6 +332,11 @@ class ReconstructionBuilder {
   // Removes all uncalibrated views from the reconstruction and view graph.
   void RemoveUncalibratedViews();
 
+  // Reports the memory of the reconstructions and the view graph to the
+  // MemoryAccounting and logs the memory usage after the stage.
+  void LogMemoryUsage(const std::string& stage,
+                      const std::vector<Reconstruction*>& reconstructions);
+
   ReconstructionBuilderOptions options_;
 
   // SfM objects.
@@ -217,6 +353,9 @@ class ReconstructionBuilder {
   // Module for performing feature extraction and matching.
   std::unique_ptr<FeatureExtractorAndMatcher> feature_extractor_and_matcher_;
 
+  // Writes the metrics periodically if an output file is set.
+  std::unique_ptr<PeriodicMetricsWriter> metrics_writer_;
+
   DISALLOW_COPY_AND_ASSIGN(ReconstructionBuilder);
 };
 }  // namespace theia
@@ -0,0 +1,283 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#include "theia/sfm/reconstruction_checkpoint.h"
+
+#include <Eigen/Core>
+#include <cereal/archives/portable_binary.hpp>
+#include <cereal/types/unordered_map.hpp>
+#include <glog/logging.h>
+
+#include <cstdio>
+#include <fstream>  // NOLINT
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "theia/io/eigen_serializable.h"
+#include "theia/sfm/reconstruction.h"
+#include "theia/sfm/types.h"
+#include "theia/sfm/view_graph/view_graph.h"
+#include "theia/util/filesystem.h"
+#include "theia/util/string.h"
+#include "theia/util/stringprintf.h"
+
+namespace theia {
+
+namespace {
+
+// Writes the objects to a temporary file which then replaces the output file,
+// so that the output file is either the old or the new one if the process is
+// interrupted.
+template <typename... Types>
+bool WriteFileAtomically(const std::string& output_filepath,
+                         const Types&... objects) {
+  const std::string temporary_filepath = output_filepath + ".tmp";
+  {
+    std::ofstream output_writer(temporary_filepath,
+                                std::ios::out | std::ios::binary);
+    if (!output_writer.is_open()) {
+      LOG(ERROR) << "Could not open the file: " << temporary_filepath
+                 << " for writing.";
+      return false;
+    }
+
+    // Make sure that Cereal is able to finish executing before closing the
+    // file.
+    {
+      cereal::PortableBinaryOutputArchive output_archive(output_writer);
+      output_archive(objects...);
+    }
+    if (!output_writer.good()) {
+      LOG(ERROR) << "Could not write the file: " << temporary_filepath;
+      return false;
+    }
+  }
+
+  if (std::rename(temporary_filepath.c_str(), output_filepath.c_str()) != 0) {
+    LOG(ERROR) << "Could not move " << temporary_filepath << " to "
+               << output_filepath;
+    return false;
+  }
+  return true;
+}
+
+}  // namespace
+
+ReconstructionCheckpoint::ReconstructionCheckpoint(
+    const std::string& directory)
+    : directory_(directory),
+      stage_(ReconstructionCheckpointStage::NONE),
+      num_completed_reconstructions_(0) {
+  AppendTrailingSlashIfNeeded(&directory_);
+  if (!DirectoryExists(directory_)) {
+    CHECK(CreateNewDirectory(directory_))
+        << "Could not create the checkpoint directory: " << directory_;
+  }
+}
+
+bool ReconstructionCheckpoint::Read(ViewGraph* view_graph,
+                                    Reconstruction* reconstruction) {
+  return ReadState(StateFilepath(), view_graph, reconstruction);
+}
+
+bool ReconstructionCheckpoint::ReadStage(
+    const ReconstructionCheckpointStage stage,
+    ViewGraph* view_graph,
+    Reconstruction* reconstruction) {
+  if (!ReadState(StageFilepath(stage), view_graph, reconstruction)) {
+    return false;
+  }
+  // Replace the last checkpoint so that an interrupted run resumes from this
+  // stage and not from the state of the previous run.
+  return Write(stage, *view_graph, *reconstruction, orientations_, positions_);
+}
+
+bool ReconstructionCheckpoint::ReadState(const std::string& state_filepath,
+                                         ViewGraph* view_graph,
+                                         Reconstruction* reconstruction) {
+  CHECK_NOTNULL(view_graph);
+  CHECK_NOTNULL(reconstruction);
+
+  if (!FileExists(state_filepath)) {
+    return false;
+  }
+  std::ifstream input_reader(state_filepath, std::ios::in | std::ios::binary);
+  if (!input_reader.is_open()) {
+    LOG(ERROR) << "Could not open the file: " << state_filepath
+               << " for reading.";
+    return false;
+  }
+
+  int stage;
+  {
+    cereal::PortableBinaryInputArchive input_archive(input_reader);
+    input_archive(stage,
+                  num_completed_reconstructions_,
+                  *view_graph,
+                  *reconstruction,
+                  orientations_,
+                  positions_);
+  }
+  stage_ = static_cast<ReconstructionCheckpointStage>(stage);
+
+  LOG(INFO) << "Read the checkpoint of stage " << stage << " with "
+            << num_completed_reconstructions_
+            << " completed reconstructions from " << state_filepath;
+  return true;
+}
+
+bool ReconstructionCheckpoint::Write(
+    const ReconstructionCheckpointStage stage,
+    const ViewGraph& view_graph,
+    const Reconstruction& reconstruction,
+    const std::unordered_map<ViewId, Eigen::Vector3d>& orientations,
+    const std::unordered_map<ViewId, Eigen::Vector3d>& positions) {
+  const int stage_index = static_cast<int>(stage);
+
+  // Save the state of the stages of the first reconstruction separately and
+  // remove the states of the later stages, which were estimated from a
+  // different state of this stage.
+  if (num_completed_reconstructions_ == 0 &&
+      stage != ReconstructionCheckpointStage::FINISHED) {
+    if (!WriteFileAtomically(StageFilepath(stage),
+                             stage_index,
+                             num_completed_reconstructions_,
+                             view_graph,
+                             reconstruction,
+                             orientations,
+                             positions)) {
+      return false;
+    }
+    const int finished_stage_index =
+        static_cast<int>(ReconstructionCheckpointStage::FINISHED);
+    for (int i = stage_index + 1; i < finished_stage_index; i++) {
+      const ReconstructionCheckpointStage later_stage =
+          static_cast<ReconstructionCheckpointStage>(i);
+      std::remove(StageFilepath(later_stage).c_str());
+    }
+  }
+
+  if (!WriteFileAtomically(StateFilepath(),
+                           stage_index,
+                           num_completed_reconstructions_,
+                           view_graph,
+                           reconstruction,
+                           orientations,
+                           positions)) {
+    return false;
+  }
+
+  stage_ = stage;
+  if (&orientations != &orientations_) {
+    orientations_ = orientations;
+  }
+  if (&positions != &positions_) {
+    positions_ = positions;
+  }
+  LOG(INFO) << "Wrote the checkpoint of stage " << stage_index << " to "
+            << directory_;
+  return true;
+}
+
+bool ReconstructionCheckpoint::WriteCompletedReconstruction(
+    const Reconstruction& completed_reconstruction,
+    const ViewGraph& view_graph,
+    const Reconstruction& reconstruction) {
+  // The completed reconstruction is only counted once the state is written, so
+  // it is written again if the process is interrupted in between.
+  if (!WriteFileAtomically(
+          CompletedReconstructionFilepath(num_completed_reconstructions_),
+          completed_reconstruction)) {
+    return false;
+  }
+
+  ++num_completed_reconstructions_;
+  if (!Write(ReconstructionCheckpointStage::TRACKS_BUILT,
+             view_graph,
+             reconstruction,
+             std::unordered_map<ViewId, Eigen::Vector3d>(),
+             std::unordered_map<ViewId, Eigen::Vector3d>())) {
+    --num_completed_reconstructions_;
+    return false;
+  }
+  return true;
+}
+
+bool ReconstructionCheckpoint::WriteFinished(
+    const ViewGraph& view_graph, const Reconstruction& reconstruction) {
+  return Write(ReconstructionCheckpointStage::FINISHED,
+               view_graph,
+               reconstruction,
+               std::unordered_map<ViewId, Eigen::Vector3d>(),
+               std::unordered_map<ViewId, Eigen::Vector3d>());
+}
+
+bool ReconstructionCheckpoint::ReadCompletedReconstructions(
+    std::vector<Reconstruction*>* reconstructions) const {
+  CHECK_NOTNULL(reconstructions);
+  for (int i = 0; i < num_completed_reconstructions_; i++) {
+    const std::string filepath = CompletedReconstructionFilepath(i);
+    std::ifstream input_reader(filepath, std::ios::in | std::ios::binary);
+    if (!input_reader.is_open()) {
+      LOG(ERROR) << "Could not open the file: " << filepath << " for reading.";
+      return false;
+    }
+
+    Reconstruction* reconstruction = new Reconstruction();
+    {
+      cereal::PortableBinaryInputArchive input_archive(input_reader);
+      input_archive(*reconstruction);
+    }
+    reconstructions->emplace_back(reconstruction);
+  }
+  return true;
+}
+
+std::string ReconstructionCheckpoint::StateFilepath() const {
+  return directory_ + "checkpoint.bin";
+}
+
+std::string ReconstructionCheckpoint::StageFilepath(
+    const ReconstructionCheckpointStage stage) const {
+  return directory_ +
+         StringPrintf("checkpoint-stage-%d.bin", static_cast<int>(stage));
+}
+
+std::string ReconstructionCheckpoint::CompletedReconstructionFilepath(
+    const int index) const {
+  return directory_ + StringPrintf("reconstruction-%d.bin", index);
+}
+
+}  // namespace theia
@@ -0,0 +1,153 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#ifndef THEIA_SFM_RECONSTRUCTION_CHECKPOINT_H_
+#define THEIA_SFM_RECONSTRUCTION_CHECKPOINT_H_
+
+#include <Eigen/Core>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "theia/sfm/types.h"
+
+namespace theia {
+
+class Reconstruction;
+class ViewGraph;
+
+// The stages of the reconstruction pipeline after which a checkpoint is
+// written, in the order in which they are completed for each reconstruction.
+enum class ReconstructionCheckpointStage {
+  // No checkpoint has been written.
+  NONE = 0,
+  // The tracks are built and the view graph and reconstruction are ready to be
+  // estimated.
+  TRACKS_BUILT = 1,
+  // The global orientations are estimated and filtered.
+  ROTATIONS_ESTIMATED = 2,
+  // The global positions are estimated.
+  POSITIONS_ESTIMATED = 3,
+  // No more reconstructions can be estimated.
+  FINISHED = 4
+};
+
+// Stores the state of the reconstruction pipeline in a work directory so that
+// an interrupted run can be resumed from the last completed stage. The state
+// consists of the view graph, the reconstruction being estimated and the global
+// orientations and positions estimated so far, along with the reconstructions
+// that were already completed. ReconstructionBuilder writes a checkpoint after
+// building the tracks and after each completed reconstruction, and the
+// GlobalReconstructionEstimator after rotation and position estimation.
+//
+// Each checkpoint is written to a temporary file that is then renamed, so a
+// crash while writing leaves the previous checkpoint intact.
+//
+// Until the first reconstruction is completed, the state after each stage is
+// also kept in a file of its own, so that a later run can restart from any of
+// these stages (e.g. to only repeat the structure estimation and bundle
+// adjustment with different settings). Writing the state of a stage removes
+// the saved states of the later stages, which no longer follow from it.
+class ReconstructionCheckpoint {
+ public:
+  explicit ReconstructionCheckpoint(const std::string& directory);
+
+  // Reads the last checkpoint in the directory. The view graph and the
+  // reconstruction are restored and the orientations and positions are kept
+  // in this object. Returns false if the directory contains no checkpoint.
+  bool Read(ViewGraph* view_graph, Reconstruction* reconstruction);
+
+  // Reads the saved state after the given stage of the first reconstruction
+  // and makes it the last checkpoint, so that the pipeline continues after
+  // this stage and the completed reconstructions are estimated again. Returns
+  // false if the state of the stage was not saved.
+  bool ReadStage(const ReconstructionCheckpointStage stage,
+                 ViewGraph* view_graph,
+                 Reconstruction* reconstruction);
+
+  // Writes the state of the pipeline after the given stage.
+  bool Write(const ReconstructionCheckpointStage stage,
+             const ViewGraph& view_graph,
+             const Reconstruction& reconstruction,
+             const std::unordered_map<ViewId, Eigen::Vector3d>& orientations,
+             const std::unordered_map<ViewId, Eigen::Vector3d>& positions);
+
+  // Writes a completed reconstruction, followed by the view graph and the
+  // reconstruction of the remaining views at the TRACKS_BUILT stage.
+  bool WriteCompletedReconstruction(
+      const Reconstruction& completed_reconstruction,
+      const ViewGraph& view_graph,
+      const Reconstruction& reconstruction);
+
+  // Marks the pipeline as finished.
+  bool WriteFinished(const ViewGraph& view_graph,
+                     const Reconstruction& reconstruction);
+
+  // Reads the completed reconstructions. The caller takes ownership of them.
+  bool ReadCompletedReconstructions(
+      std::vector<Reconstruction*>* reconstructions) const;
+
+  // The stage of the last checkpoint and the state written with it.
+  ReconstructionCheckpointStage Stage() const { return stage_; }
+  int NumCompletedReconstructions() const {
+    return num_completed_reconstructions_;
+  }
+  const std::unordered_map<ViewId, Eigen::Vector3d>& Orientations() const {
+    return orientations_;
+  }
+  const std::unordered_map<ViewId, Eigen::Vector3d>& Positions() const {
+    return positions_;
+  }
+
+ private:
+  std::string StateFilepath() const;
+  std::string StageFilepath(const ReconstructionCheckpointStage stage) const;
+
+  // Reads the state from the file.
+  bool ReadState(const std::string& state_filepath,
+                 ViewGraph* view_graph,
+                 Reconstruction* reconstruction);
+  std::string CompletedReconstructionFilepath(const int index) const;
+
+  std::string directory_;
+
+  ReconstructionCheckpointStage stage_;
+  int num_completed_reconstructions_;
+  std::unordered_map<ViewId, Eigen::Vector3d> orientations_;
+  std::unordered_map<ViewId, Eigen::Vector3d> positions_;
+};
+
+}  // namespace theia
+
+#endif  // THEIA_SFM_RECONSTRUCTION_CHECKPOINT_H_
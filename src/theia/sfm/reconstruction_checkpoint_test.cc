@@ -0,0 +1,271 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#include <Eigen/Core>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "theia/sfm/feature.h"
+#include "theia/sfm/reconstruction.h"
+#include "theia/sfm/reconstruction_checkpoint.h"
+#include "theia/sfm/twoview_info.h"
+#include "theia/sfm/types.h"
+#include "theia/sfm/view_graph/view_graph.h"
+#include "theia/util/filesystem.h"
+#include "theia/util/stringprintf.h"
+
+namespace theia {
+
+namespace {
+
+static const int kNumViews = 4;
+
+void BuildViewGraphAndReconstruction(ViewGraph* view_graph,
+                                     Reconstruction* reconstruction) {
+  for (int i = 0; i < kNumViews; i++) {
+    reconstruction->AddView(StringPrintf("%d", i), i);
+  }
+  for (int i = 0; i + 1 < kNumViews; i++) {
+    TwoViewInfo info;
+    info.num_verified_matches = 10 * (i + 1);
+    view_graph->AddEdge(i, i + 1, info);
+    reconstruction->AddTrack({{i, Feature(Eigen::Vector2d(i, i))},
+                              {i + 1, Feature(Eigen::Vector2d(i, i + 1))}});
+  }
+}
+
+std::string CheckpointDirectory(const std::string& name) {
+  return testing::internal::TempDir() + "reconstruction_checkpoint_" + name +
+         "/";
+}
+
+}  // namespace
+
+TEST(ReconstructionCheckpoint, NoCheckpoint) {
+  ReconstructionCheckpoint checkpoint(CheckpointDirectory("empty"));
+  ViewGraph view_graph;
+  Reconstruction reconstruction;
+  EXPECT_FALSE(checkpoint.Read(&view_graph, &reconstruction));
+  EXPECT_EQ(checkpoint.Stage(), ReconstructionCheckpointStage::NONE);
+  EXPECT_EQ(checkpoint.NumCompletedReconstructions(), 0);
+}
+
+TEST(ReconstructionCheckpoint, WriteAndRead) {
+  const std::string directory = CheckpointDirectory("write_and_read");
+  ViewGraph view_graph;
+  Reconstruction reconstruction;
+  BuildViewGraphAndReconstruction(&view_graph, &reconstruction);
+
+  std::unordered_map<ViewId, Eigen::Vector3d> orientations;
+  std::unordered_map<ViewId, Eigen::Vector3d> positions;
+  for (ViewId view_id = 0; view_id < kNumViews; view_id++) {
+    orientations[view_id] = Eigen::Vector3d::Random();
+    positions[view_id] = Eigen::Vector3d::Random();
+  }
+
+  {
+    ReconstructionCheckpoint checkpoint(directory);
+    EXPECT_TRUE(checkpoint.Write(
+        ReconstructionCheckpointStage::ROTATIONS_ESTIMATED,
+        view_graph,
+        reconstruction,
+        orientations,
+        {}));
+    EXPECT_TRUE(
+        checkpoint.Write(ReconstructionCheckpointStage::POSITIONS_ESTIMATED,
+                         view_graph,
+                         reconstruction,
+                         orientations,
+                         positions));
+    EXPECT_EQ(checkpoint.Stage(),
+              ReconstructionCheckpointStage::POSITIONS_ESTIMATED);
+  }
+  EXPECT_FALSE(FileExists(directory + "checkpoint.bin.tmp"));
+
+  // The last checkpoint is read back.
+  ReconstructionCheckpoint checkpoint(directory);
+  ViewGraph read_view_graph;
+  Reconstruction read_reconstruction;
+  ASSERT_TRUE(checkpoint.Read(&read_view_graph, &read_reconstruction));
+  EXPECT_EQ(checkpoint.Stage(),
+            ReconstructionCheckpointStage::POSITIONS_ESTIMATED);
+  EXPECT_EQ(checkpoint.NumCompletedReconstructions(), 0);
+
+  EXPECT_EQ(read_view_graph.NumViews(), view_graph.NumViews());
+  EXPECT_EQ(read_view_graph.NumEdges(), view_graph.NumEdges());
+  for (const auto& edge : view_graph.GetAllEdges()) {
+    const TwoViewInfo* info = read_view_graph.GetEdge(edge.first.first,
+                                                      edge.first.second);
+    ASSERT_NE(info, nullptr);
+    EXPECT_EQ(info->num_verified_matches, edge.second.num_verified_matches);
+  }
+  EXPECT_EQ(read_reconstruction.NumViews(), reconstruction.NumViews());
+  EXPECT_EQ(read_reconstruction.NumTracks(), reconstruction.NumTracks());
+  for (const TrackId track_id : reconstruction.TrackIds()) {
+    ASSERT_NE(read_reconstruction.Track(track_id), nullptr);
+    EXPECT_EQ(read_reconstruction.Track(track_id)->ViewIds(),
+              reconstruction.Track(track_id)->ViewIds());
+  }
+
+  ASSERT_EQ(checkpoint.Orientations().size(), orientations.size());
+  ASSERT_EQ(checkpoint.Positions().size(), positions.size());
+  for (ViewId view_id = 0; view_id < kNumViews; view_id++) {
+    EXPECT_EQ(checkpoint.Orientations().at(view_id), orientations[view_id]);
+    EXPECT_EQ(checkpoint.Positions().at(view_id), positions[view_id]);
+  }
+}
+
+TEST(ReconstructionCheckpoint, CompletedReconstructions) {
+  const std::string directory = CheckpointDirectory("completed");
+  ViewGraph view_graph;
+  Reconstruction reconstruction;
+  BuildViewGraphAndReconstruction(&view_graph, &reconstruction);
+
+  {
+    ReconstructionCheckpoint checkpoint(directory);
+    for (int i = 0; i < 2; i++) {
+      Reconstruction completed_reconstruction;
+      for (int j = 0; j <= i; j++) {
+        completed_reconstruction.AddView(StringPrintf("%d", j), j);
+      }
+      EXPECT_TRUE(checkpoint.WriteCompletedReconstruction(
+          completed_reconstruction, view_graph, reconstruction));
+      EXPECT_EQ(checkpoint.Stage(),
+                ReconstructionCheckpointStage::TRACKS_BUILT);
+      EXPECT_EQ(checkpoint.NumCompletedReconstructions(), i + 1);
+    }
+    EXPECT_TRUE(checkpoint.WriteFinished(view_graph, reconstruction));
+  }
+
+  ReconstructionCheckpoint checkpoint(directory);
+  ViewGraph read_view_graph;
+  Reconstruction read_reconstruction;
+  ASSERT_TRUE(checkpoint.Read(&read_view_graph, &read_reconstruction));
+  EXPECT_EQ(checkpoint.Stage(), ReconstructionCheckpointStage::FINISHED);
+  EXPECT_TRUE(checkpoint.Orientations().empty());
+  EXPECT_TRUE(checkpoint.Positions().empty());
+
+  std::vector<Reconstruction*> completed_reconstructions;
+  ASSERT_TRUE(
+      checkpoint.ReadCompletedReconstructions(&completed_reconstructions));
+  ASSERT_EQ(completed_reconstructions.size(), 2);
+  for (int i = 0; i < completed_reconstructions.size(); i++) {
+    std::unique_ptr<Reconstruction> completed_reconstruction(
+        completed_reconstructions[i]);
+    EXPECT_EQ(completed_reconstruction->NumViews(), i + 1);
+  }
+}
+
+TEST(ReconstructionCheckpoint, RestartFromStage) {
+  const std::string directory = CheckpointDirectory("restart_from_stage");
+  ViewGraph view_graph;
+  Reconstruction reconstruction;
+  BuildViewGraphAndReconstruction(&view_graph, &reconstruction);
+
+  std::unordered_map<ViewId, Eigen::Vector3d> orientations;
+  for (ViewId view_id = 0; view_id < kNumViews; view_id++) {
+    orientations[view_id] = Eigen::Vector3d::Random();
+  }
+
+  {
+    ReconstructionCheckpoint checkpoint(directory);
+    EXPECT_TRUE(checkpoint.Write(ReconstructionCheckpointStage::TRACKS_BUILT,
+                                 view_graph,
+                                 reconstruction,
+                                 {},
+                                 {}));
+    // The view graph is filtered by the later stages.
+    view_graph.RemoveEdge(0, 1);
+    EXPECT_TRUE(
+        checkpoint.Write(ReconstructionCheckpointStage::ROTATIONS_ESTIMATED,
+                         view_graph,
+                         reconstruction,
+                         orientations,
+                         {}));
+    EXPECT_TRUE(
+        checkpoint.Write(ReconstructionCheckpointStage::POSITIONS_ESTIMATED,
+                         view_graph,
+                         reconstruction,
+                         orientations,
+                         orientations));
+    EXPECT_TRUE(checkpoint.WriteFinished(view_graph, reconstruction));
+  }
+
+  // Restart from the rotations. The positions of the previous run are dropped.
+  {
+    ReconstructionCheckpoint checkpoint(directory);
+    ViewGraph read_view_graph;
+    Reconstruction read_reconstruction;
+    ASSERT_TRUE(
+        checkpoint.ReadStage(ReconstructionCheckpointStage::ROTATIONS_ESTIMATED,
+                             &read_view_graph,
+                             &read_reconstruction));
+    EXPECT_EQ(checkpoint.Stage(),
+              ReconstructionCheckpointStage::ROTATIONS_ESTIMATED);
+    EXPECT_EQ(checkpoint.Orientations().size(), kNumViews);
+    EXPECT_TRUE(checkpoint.Positions().empty());
+    EXPECT_EQ(read_view_graph.NumEdges(), kNumViews - 2);
+
+    ViewGraph unused_view_graph;
+    Reconstruction unused_reconstruction;
+    EXPECT_FALSE(
+        checkpoint.ReadStage(ReconstructionCheckpointStage::POSITIONS_ESTIMATED,
+                             &unused_view_graph,
+                             &unused_reconstruction));
+  }
+
+  // The restarted stage is the last checkpoint, and the tracks can still be
+  // restarted from.
+  ReconstructionCheckpoint checkpoint(directory);
+  ViewGraph read_view_graph;
+  Reconstruction read_reconstruction;
+  ASSERT_TRUE(checkpoint.Read(&read_view_graph, &read_reconstruction));
+  EXPECT_EQ(checkpoint.Stage(),
+            ReconstructionCheckpointStage::ROTATIONS_ESTIMATED);
+
+  ViewGraph tracks_view_graph;
+  Reconstruction tracks_reconstruction;
+  ASSERT_TRUE(checkpoint.ReadStage(ReconstructionCheckpointStage::TRACKS_BUILT,
+                                   &tracks_view_graph,
+                                   &tracks_reconstruction));
+  EXPECT_EQ(tracks_view_graph.NumEdges(), kNumViews - 1);
+  EXPECT_TRUE(checkpoint.Orientations().empty());
+}
+
+}  // namespace theia
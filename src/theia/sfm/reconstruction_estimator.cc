@@ -37,6 +37,7 @@
 #include <glog/logging.h>
 
 #include "theia/sfm/global_reconstruction_estimator.h"
+#include "theia/sfm/hierarchical_reconstruction_estimator.h"
 #include "theia/sfm/hybrid_reconstruction_estimator.h"
 #include "theia/sfm/incremental_reconstruction_estimator.h"
 #include "theia/sfm/reconstruction_estimator_options.h"
@@ -55,6 +56,9 @@ ReconstructionEstimator* ReconstructionEstimator::Create(
     case ReconstructionEstimatorType::HYBRID:
       return new HybridReconstructionEstimator(options);
       break;
+    case ReconstructionEstimatorType::HIERARCHICAL:
+      return new HierarchicalReconstructionEstimator(options);
+      break;
     default:
       LOG(FATAL) << "Invalid reconstruction estimator specified.";
   }
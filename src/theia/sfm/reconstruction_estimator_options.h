@@ -38,21 +38,26 @@
 #include <memory>
 
 #include "theia/sfm/bundle_adjustment/bundle_adjustment.h"
+#include "theia/sfm/estimators/estimate_calibrated_absolute_pose.h"
 #include "theia/sfm/global_pose_estimation/LiGT_position_estimator.h"
 #include "theia/sfm/global_pose_estimation/least_unsquared_deviation_position_estimator.h"
 #include "theia/sfm/global_pose_estimation/linear_position_estimator.h"
 #include "theia/sfm/global_pose_estimation/nonlinear_position_estimator.h"
 #include "theia/sfm/estimate_track.h"
+#include "theia/sfm/reconstruction_checkpoint.h"
 #include "theia/util/random.h"
 
 namespace theia {
 
 // Global SfM methods are considered to be more scalable while incremental SfM
-// is less scalable but often more robust.
+// is less scalable but often more robust. Hierarchical SfM splits the view
+// graph into overlapping clusters that are each reconstructed with one of the
+// other methods, then merges the cluster reconstructions.
 enum class ReconstructionEstimatorType {
   GLOBAL = 0,
   INCREMENTAL = 1,
-  HYBRID = 2
+  HYBRID = 2,
+  HIERARCHICAL = 3
 };
 
 // The recommended type of rotations solver is the Robust L1-L2 method. This
@@ -100,9 +105,37 @@ struct ReconstructionEstimatorOptions {
   // generator will be initialized based on the current time.
   std::shared_ptr<RandomNumberGenerator> rng;
 
+  // If set, the global estimator writes the view graph, reconstruction and
+  // poses to this checkpoint after rotation and position estimation and
+  // resumes from the stage of the checkpoint. ReconstructionBuilder sets this
+  // if a checkpoint directory is given.
+  std::shared_ptr<ReconstructionCheckpoint> checkpoint;
+
+  // If set to ROTATIONS_ESTIMATED or POSITIONS_ESTIMATED, the global estimator
+  // returns an unsuccessful summary once the poses of this stage are estimated
+  // (and written to the checkpoint). Other estimators ignore this.
+  ReconstructionCheckpointStage stop_stage =
+      ReconstructionCheckpointStage::FINISHED;
+
   // Number of threads to use.
   int num_threads = 1;
 
+  // If true, the estimation produces the same reconstruction for the same
+  // input regardless of num_threads and of the thread scheduling. The stages
+  // that only split independent work between threads stay parallel, but the
+  // bundle adjustment problems are solved with a single thread since Ceres
+  // accumulates the residuals of the threads in the order they finish. The
+  // RANSAC stages are only repeatable if rng is set as well.
+  bool deterministic = false;
+
+  // If true, the threads of the global executor are pinned to the NUMA nodes
+  // of the machine during the estimation (see ScopedNumaAffinity), and each
+  // bundle adjustment problem that needs no more threads than a node has is
+  // solved on the node of the calling thread so that the Ceres threads do not
+  // migrate between nodes. This has no effect on machines with a single NUMA
+  // node.
+  bool numa_aware = false;
+
   // Maximum reprojection error. This is the threshold used for filtering
   // outliers after bundle adjustment.
   double max_reprojection_error_in_pixels = 5.0;
@@ -111,6 +144,17 @@ struct ReconstructionEstimatorOptions {
   // be removed as an initial filtering step.
   int min_num_two_view_inliers = 30;
 
+  // Dense captures give views with hundreds of view pairs, most of which are
+  // redundant, while the cost of the global SfM stages grows with the number of
+  // view pairs. If view_graph_sparsification_num_edges_per_view is positive,
+  // the filtered initial view graph is sparsified to its maximum spanning tree
+  // plus this many of the strongest view pairs of each view (see
+  // SparsifyViewGraph). The strength of a view pair is its visibility score if
+  // view_graph_sparsification_use_visibility_score is true and its number of
+  // verified matches otherwise.
+  int view_graph_sparsification_num_edges_per_view = 0;
+  bool view_graph_sparsification_use_visibility_score = false;
+
   // --------------- RANSAC Options --------------- //
   double ransac_confidence = 0.9999;
   int ransac_min_iterations = 50;
@@ -135,8 +179,9 @@ struct ReconstructionEstimatorOptions {
 
   // If true, the maximal rigid component of the viewing graph will be
   // extracted. This means that only the cameras that are well-constrained for
-  // position estimation will be used. This method is somewhat slow, so enabling
-  // it will cause a performance hit in terms of efficiency.
+  // position estimation will be used. The null space of the bearing
+  // constraints is computed with sparse factorizations, so this is feasible
+  // for large view graphs, but it still adds a noticeable cost.
   //
   // NOTE: This method does not attempt to remove outlier 2-view geometries, it
   // only determines which cameras are well-conditioned for position estimation.
@@ -170,12 +215,23 @@ struct ReconstructionEstimatorOptions {
   // orientation and intrinsics constant.
   bool refine_camera_positions_and_points_after_position_estimation = true;
 
+  // GlobalReconstructionEstimator::EstimateNewViews re-estimates the new views
+  // together with the estimated views that are at most this many view graph
+  // edges away from a new view. The estimated views adjacent to this
+  // neighborhood are held fixed. A larger neighborhood spreads the update over
+  // more of the existing reconstruction at a higher cost.
+  int incremental_global_update_neighborhood_size = 1;
+
   // --------------------- Incremental SfM Options --------------------- //
 
   // If M is the maximum number of 3D points observed by any view, we want to
   // localize all views that observe > M * multiple_view_localization_ratio 3D
   // points. This allows for multiple well-conditioned views to be added to the
-  // reconstruction before needing bundle adjustment.
+  // reconstruction before needing bundle adjustment. These views are only
+  // localized together if num_threads > 1, in which case they are localized in
+  // parallel and all views that are localized successfully are added before
+  // the next bundle adjustment. Otherwise, only the first view that can be
+  // localized is added.
   double multiple_view_localization_ratio = 0.8;
 
   // When adding a new view to the current reconstruction, this is the
@@ -192,6 +248,12 @@ struct ReconstructionEstimatorOptions {
   // successful.
   int min_num_absolute_pose_inliers = 30;
 
+  // The solver used to localize views with known intrinsics (see PnPType). If
+  // localize_with_gravity_priors is true, views with a gravity prior are
+  // localized with the two point gravity-aware solver instead.
+  PnPType absolute_pose_pnp_type = PnPType::KNEIP;
+  bool localize_with_gravity_priors = false;
+
   // Bundle adjustment of the entire reconstruction is triggered when the
   // reconstruction has grown by more than this percent. That is, if we last ran
   // BA when there were K views in the reconstruction and there are now N views,
@@ -200,11 +262,31 @@ struct ReconstructionEstimatorOptions {
   // indicated in percent so e.g., 5.0 = 5%.
   double full_bundle_adjustment_growth_percent = 5.0;
 
-  // During incremental SfM we run "partial" bundle adjustment on the most
-  // recent views that have been added to the 3D reconstruction. This parameter
-  // controls how many views should be part of the partial BA.
+  // Full bundle adjustment is also triggered when the model drifts, i.e. when
+  // the mean reprojection error of the tracks optimized by partial BA is larger
+  // than this factor times the mean reprojection error of the reconstruction
+  // after the last full BA. Set to 0 to only trigger full BA by growth.
+  double full_bundle_adjustment_drift_ratio = 1.5;
+
+  // During incremental SfM we run "partial" bundle adjustment on the views that
+  // were just added to the 3D reconstruction and the views that share the most
+  // tracks with them. This parameter controls how many views should be part of
+  // the partial BA. Other views observing the optimized tracks are held
+  // constant.
   int partial_bundle_adjustment_num_views = 20;
 
+  // If true, the camera rigs of the reconstruction (see
+  // Reconstruction::AddViewToCameraRig) constrain incremental SfM. Once a rig
+  // frame has two independently localized views, the reconstruction is scaled
+  // to the units of the rig extrinsics. From then on, the pose of each
+  // localized view is propagated to the unlocalized views of its rig frame
+  // that have a focal length prior, and bundle adjustment optimizes a single
+  // pose per rig frame (see BundleAdjustmentOptions::use_camera_rigs). If
+  // optimize_camera_rig_extrinsics is true, bundle adjustment also refines the
+  // extrinsics of the rig cameras.
+  bool use_camera_rigs = false;
+  bool optimize_camera_rig_extrinsics = false;
+
   // --------------------- Hybrid SfM Options --------------------- //
 
   // The relative position of the initial pair used for the incremental portion
@@ -214,6 +296,30 @@ struct ReconstructionEstimatorOptions {
   // parameter.
   double relative_position_estimation_max_sampson_error_pixels = 4.0;
 
+  // --------------------- Hierarchical SfM Options --------------------- //
+
+  // The view graph is recursively split with normalized graph cuts until no
+  // cluster contains more than this many views.
+  int hierarchical_max_views_per_cluster = 100;
+
+  // Clusters that are connected in the view graph are grown so that they share
+  // up to this many views. The shared views are used to align the cluster
+  // reconstructions, so at least 4 are needed for a pair of clusters to be
+  // merged.
+  int hierarchical_num_overlapping_views = 10;
+
+  // The method used to reconstruct each cluster. Any type except HIERARCHICAL
+  // may be used.
+  ReconstructionEstimatorType hierarchical_cluster_estimator_type =
+      ReconstructionEstimatorType::GLOBAL;
+
+  // Cluster reconstructions are aligned with RANSAC on the positions of the
+  // shared views and the points of the shared tracks of each pair of clusters,
+  // and then jointly. The inlier threshold is this ratio times the median
+  // distance of the correspondences to their centroid, which makes it
+  // independent of the (arbitrary) scale of the reconstructions.
+  double hierarchical_alignment_relative_error_threshold = 0.1;
+
   // --------------- Triangulation Options --------------- //
 
   // Minimum angle required between a 3D point and 2 viewing rays in order to
@@ -257,6 +363,19 @@ struct ReconstructionEstimatorOptions {
   // for problems larger than this size.
   int min_cameras_for_iterative_solver = 1000;
 
+  // If true, the linear solver and preconditioner of each bundle adjustment
+  // problem are chosen from its structure (number of cameras, covisibility and
+  // intrinsics groups) instead of only from the number of cameras. See
+  // //theia/sfm/bundle_adjustment/select_linear_solver.h for the policy.
+  // min_cameras_for_iterative_solver is still used as its threshold for
+  // ITERATIVE_SCHUR.
+  bool select_bundle_adjustment_linear_solver_automatically = false;
+
+  // Solve the bundle adjustment linear systems on the CPU or on the GPU. See
+  // //theia/sfm/bundle_adjustment/bundle_adjustment.h for details.
+  BundleAdjustmentBackend bundle_adjustment_backend =
+      BundleAdjustmentBackend::CPU;
+
   // If accurate calibration is known ahead of time then it is recommended to
   // set the camera intrinsics constant during bundle adjustment. Othewise, you
   // can choose which intrinsics to optimize. See
@@ -306,6 +425,15 @@ struct ReconstructionEstimatorOptions {
   // track subsampling. If the view does not observe this many tracks, then all
   // tracks in the view are optimized.
   int min_num_optimized_tracks_per_view = 200;
+
+  // If positive, bundle adjustment only optimizes this many observations of
+  // each track, chosen such that their camera centers are spread out along the
+  // baseline. This is independent of the track subsampling above and mostly
+  // helps sequences where points are seen by hundreds of nearby views. Views
+  // that would keep fewer than min_num_optimized_observations_per_view
+  // observations keep all of them. See BundleAdjustmentOptions.
+  int max_num_optimized_observations_per_track = 0;
+  int min_num_optimized_observations_per_view = 100;
 };
 
 }  // namespace theia
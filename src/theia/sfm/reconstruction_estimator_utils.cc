@@ -45,6 +45,7 @@
 #include "theia/matching/feature_correspondence.h"
 #include "theia/sfm/bundle_adjustment/bundle_adjustment.h"
 #include "theia/sfm/bundle_adjustment/optimize_relative_position_with_known_rotation.h"
+#include "theia/sfm/camera_rig.h"
 #include "theia/sfm/camera/reprojection_error.h"
 #include "theia/sfm/global_pose_estimation/nonlinear_position_estimator.h"
 #include "theia/sfm/reconstruction.h"
@@ -54,8 +55,9 @@
 #include "theia/sfm/twoview_info.h"
 #include "theia/sfm/view_graph/view_graph.h"
 #include "theia/solvers/sample_consensus_estimator.h"
+#include "theia/util/executor.h"
+#include "theia/util/hash.h"
 #include "theia/util/map_util.h"
-#include "theia/util/threadpool.h"
 
 namespace theia {
 namespace {
@@ -115,11 +117,21 @@ BundleAdjustmentOptions SetBundleAdjustmentOptions(
   static const int kMinViewsForSparseSchur = 150;
 
   BundleAdjustmentOptions ba_options;
-  ba_options.num_threads = options.num_threads;
+  ba_options.num_threads = options.deterministic ? 1 : options.num_threads;
+  ba_options.numa_aware = options.numa_aware;
   ba_options.loss_function_type = options.bundle_adjustment_loss_function_type;
   ba_options.robust_loss_width = options.bundle_adjustment_robust_loss_width;
   ba_options.use_inner_iterations = true;
   ba_options.intrinsics_to_optimize = options.intrinsics_to_optimize;
+  ba_options.max_num_optimized_observations_per_track =
+      options.max_num_optimized_observations_per_track;
+  ba_options.min_num_optimized_observations_per_view =
+      options.min_num_optimized_observations_per_view;
+  ba_options.backend = options.bundle_adjustment_backend;
+  ba_options.select_linear_solver_automatically =
+      options.select_bundle_adjustment_linear_solver_automatically;
+  ba_options.linear_solver_selection_options.min_blocks_for_iterative_schur =
+      options.min_cameras_for_iterative_solver;
 
   if (num_views >= options.min_cameras_for_iterative_solver) {
     ba_options.linear_solver_type = ceres::ITERATIVE_SCHUR;
@@ -251,24 +263,34 @@ void RefineRelativeTranslationsWithKnownRotations(
     ViewGraph* view_graph) {
   CHECK_GE(num_threads, 1);
   const auto& view_pairs = view_graph->GetAllEdges();
-
-  ThreadPool pool(num_threads);
-  // Refine the translation estimation for each view pair.
+  std::vector<ViewIdPair> view_pair_ids;
+  view_pair_ids.reserve(view_pairs.size());
   for (const auto& view_pair : view_pairs) {
-    // Get all feature correspondences common to both views.
-    std::vector<FeatureCorrespondence> matches;
-    const View* view1 = reconstruction.View(view_pair.first.first);
-    const View* view2 = reconstruction.View(view_pair.first.second);
-    GetNormalizedFeatureCorrespondences(*view1, *view2, &matches);
-
-    TwoViewInfo* info = view_graph->GetMutableEdge(view_pair.first.first,
-                                                   view_pair.first.second);
-    pool.Add(OptimizeRelativePositionWithKnownRotation,
-             matches,
-             FindOrDie(orientations, view_pair.first.first),
-             FindOrDie(orientations, view_pair.first.second),
-             &info->position_2);
+    view_pair_ids.emplace_back(view_pair.first);
   }
+
+  // Refine the translation estimation for each view pair.
+  ParallelFor(
+      num_threads,
+      view_pair_ids.size(),
+      [&](const int start, const int end) {
+        for (int i = start; i < end; i++) {
+          const ViewIdPair& view_pair = view_pair_ids[i];
+          // Get all feature correspondences common to both views.
+          std::vector<FeatureCorrespondence> matches;
+          const View* view1 = reconstruction.View(view_pair.first);
+          const View* view2 = reconstruction.View(view_pair.second);
+          GetNormalizedFeatureCorrespondences(*view1, *view2, &matches);
+
+          TwoViewInfo* info =
+              view_graph->GetMutableEdge(view_pair.first, view_pair.second);
+          OptimizeRelativePositionWithKnownRotation(
+              matches,
+              FindOrDie(orientations, view_pair.first),
+              FindOrDie(orientations, view_pair.second),
+              &info->position_2);
+        }
+      });
 }
 
 int SetUnderconstrainedTracksToUnestimated(Reconstruction* reconstruction) {
@@ -344,6 +366,58 @@ int NumEstimatedViews(const Reconstruction& reconstruction) {
   return num_estimated_views;
 }
 
+bool EstimateCameraRigScale(const Reconstruction& reconstruction,
+                            double* scale) {
+  static const double kMinRigBaseline = 1e-6;
+
+  // Group the estimated views by their rig frame.
+  std::unordered_map<std::pair<CameraRigId, int>, std::vector<ViewId> >
+      rig_frames;
+  for (const ViewId view_id : reconstruction.ViewIds()) {
+    const CameraRigMembership* membership =
+        reconstruction.CameraRigMembershipFromViewId(view_id);
+    if (membership != nullptr &&
+        reconstruction.View(view_id)->IsEstimated()) {
+      rig_frames[std::make_pair(membership->rig_id, membership->frame_id)]
+          .emplace_back(view_id);
+    }
+  }
+
+  std::vector<double> scales;
+  for (const auto& rig_frame : rig_frames) {
+    const CameraRig& camera_rig =
+        *reconstruction.CameraRig(rig_frame.first.first);
+    const std::vector<ViewId>& view_ids = rig_frame.second;
+    for (int i = 0; i < view_ids.size(); i++) {
+      for (int j = i + 1; j < view_ids.size(); j++) {
+        const double rig_baseline =
+            (camera_rig.CameraPosition(
+                 reconstruction.CameraRigMembershipFromViewId(view_ids[i])
+                     ->camera_index) -
+             camera_rig.CameraPosition(
+                 reconstruction.CameraRigMembershipFromViewId(view_ids[j])
+                     ->camera_index))
+                .norm();
+        const double baseline =
+            (reconstruction.View(view_ids[i])->Camera().GetPosition() -
+             reconstruction.View(view_ids[j])->Camera().GetPosition())
+                .norm();
+        if (rig_baseline > kMinRigBaseline && baseline > 0) {
+          scales.emplace_back(rig_baseline / baseline);
+        }
+      }
+    }
+  }
+  if (scales.empty()) {
+    return false;
+  }
+
+  auto median = scales.begin() + scales.size() / 2;
+  std::nth_element(scales.begin(), median, scales.end());
+  *scale = *median;
+  return true;
+}
+
 int NumEstimatedTracks(const Reconstruction& reconstruction) {
   int num_estimated_tracks = 0;
   for (const TrackId track_id : reconstruction.TrackIds()) {
@@ -36,8 +36,12 @@
 #define THEIA_SFM_RECONSTRUCTION_ESTIMATOR_UTILS_H_
 
 #include <Eigen/Core>
+#include <functional>
+#include <queue>
+#include <tuple>
 #include <unordered_map>
 #include <unordered_set>
+#include <vector>
 
 #include "theia/sfm/bundle_adjustment/bundle_adjustment.h"
 #include "theia/sfm/reconstruction.h"
@@ -52,6 +56,19 @@ class Reconstruction;
 class ViewGraph;
 struct ReconstructionEstimatorOptions;
 
+// A candidate view pair for initializing a reconstruction with its two
+// initialization criteria. Smaller criteria are better and ties are broken by
+// the view ids.
+typedef std::tuple<int, int, ViewIdPair> InitialViewPairCandidate;
+
+// The candidate view pairs are arranged in a min-heap in linear time and popped
+// one at a time, so that only the candidates that are actually tried as the
+// initial pair are sorted.
+typedef std::priority_queue<InitialViewPairCandidate,
+                            std::vector<InitialViewPairCandidate>,
+                            std::greater<InitialViewPairCandidate> >
+    InitialViewPairQueue;
+
 // By default, Theia uses pixel error thresholds based on an image that is 1024
 // pixels wide. For images of different resolutions this function will scale the
 // threshold based on the maximum image dimensions. If the image dimensions are
@@ -114,6 +131,13 @@ int SetUnderconstrainedViewsToUnestimated(Reconstruction* reconstruction);
 int NumEstimatedViews(const Reconstruction& reconstruction);
 int NumEstimatedTracks(const Reconstruction& reconstruction);
 
+// Estimates the scale that maps the reconstruction to the units of the camera
+// rig extrinsics as the median ratio of the rig baselines to the baselines of
+// the estimated views of the same rig frame. Returns false if no rig frame has
+// two estimated views of cameras with distinct rig positions.
+bool EstimateCameraRigScale(const Reconstruction& reconstruction,
+                            double* scale);
+
 // A convenience method for setting a selection of tracks in the specified views
 // to be unestimated. The specified set of input tracks will remain as
 // "estimated", but all others will be set to unestimated.
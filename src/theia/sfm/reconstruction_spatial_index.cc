@@ -0,0 +1,231 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#include "theia/sfm/reconstruction_spatial_index.h"
+
+#include <Eigen/Core>
+#include <Eigen/Geometry>
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "theia/sfm/camera/camera.h"
+#include "theia/sfm/reconstruction.h"
+#include "theia/sfm/sort_tracks_spatially.h"
+#include "theia/sfm/track.h"
+#include "theia/sfm/types.h"
+#include "theia/sfm/view.h"
+
+namespace theia {
+
+namespace {
+
+// The number of pixels sampled along each side of the image border to bound
+// the rays of the camera. Lens distortion may bend the border, so the corners
+// alone do not bound the rays.
+static const int kNumBorderSamplesPerSide = 16;
+
+// Returns the largest angle between the optical axis and the rays through the
+// border of the image.
+double MaxAngleFromOpticalAxis(const Camera& camera,
+                               const Eigen::Vector3d& optical_axis) {
+  const double width = camera.ImageWidth();
+  const double height = camera.ImageHeight();
+  Eigen::Matrix2Xd pixels(2, 4 * kNumBorderSamplesPerSide);
+  for (int i = 0; i < kNumBorderSamplesPerSide; i++) {
+    const double t = static_cast<double>(i) / kNumBorderSamplesPerSide;
+    pixels.col(4 * i) << t * width, 0.0;
+    pixels.col(4 * i + 1) << width, t * height;
+    pixels.col(4 * i + 2) << (1.0 - t) * width, height;
+    pixels.col(4 * i + 3) << 0.0, (1.0 - t) * height;
+  }
+  Eigen::Matrix3Xd bearings;
+  camera.PixelsToBearings(pixels, &bearings);
+
+  double max_angle = 0.0;
+  for (int i = 0; i < bearings.cols(); i++) {
+    const double cos_angle =
+        std::max(-1.0, std::min(1.0, bearings.col(i).dot(optical_axis)));
+    max_angle = std::max(max_angle, std::acos(cos_angle));
+  }
+  return max_angle;
+}
+
+}  // namespace
+
+ReconstructionSpatialIndex::ReconstructionSpatialIndex(
+    const Reconstruction& reconstruction) {
+  Update(reconstruction);
+}
+
+void ReconstructionSpatialIndex::UpdateTrack(
+    const Reconstruction& reconstruction, const TrackId track_id) {
+  const Track* track = reconstruction.Track(track_id);
+  if (track == nullptr || !track->IsEstimated() ||
+      !IsFinitePoint(track->Point())) {
+    tracks_.Remove(track_id);
+    return;
+  }
+  tracks_.Insert(track_id, track->Point().hnormalized());
+}
+
+void ReconstructionSpatialIndex::UpdateView(
+    const Reconstruction& reconstruction, const ViewId view_id) {
+  const View* view = reconstruction.View(view_id);
+  if (view == nullptr || !view->IsEstimated()) {
+    views_.Remove(view_id);
+    return;
+  }
+  views_.Insert(view_id, view->Camera().GetPosition());
+}
+
+void ReconstructionSpatialIndex::Update(const Reconstruction& reconstruction) {
+  // Entries that are no longer in the reconstruction are removed first.
+  std::vector<TrackId> removed_track_ids;
+  for (const auto& track : tracks_.Positions()) {
+    if (reconstruction.Track(track.first) == nullptr) {
+      removed_track_ids.emplace_back(track.first);
+    }
+  }
+  for (const TrackId track_id : removed_track_ids) {
+    tracks_.Remove(track_id);
+  }
+  std::vector<ViewId> removed_view_ids;
+  for (const auto& view : views_.Positions()) {
+    if (reconstruction.View(view.first) == nullptr) {
+      removed_view_ids.emplace_back(view.first);
+    }
+  }
+  for (const ViewId view_id : removed_view_ids) {
+    views_.Remove(view_id);
+  }
+
+  // Insert does not modify the octree for points that did not move.
+  for (const TrackId track_id : reconstruction.TrackIds()) {
+    UpdateTrack(reconstruction, track_id);
+  }
+  for (const ViewId view_id : reconstruction.ViewIds()) {
+    UpdateView(reconstruction, view_id);
+  }
+}
+
+std::vector<TrackId> ReconstructionSpatialIndex::TracksInBox(
+    const Eigen::AlignedBox3d& box) const {
+  std::vector<TrackId> track_ids;
+  tracks_.PointsInBox(box, &track_ids);
+  return track_ids;
+}
+
+std::vector<TrackId> ReconstructionSpatialIndex::TracksInRadius(
+    const Eigen::Vector3d& center, const double radius) const {
+  std::vector<TrackId> track_ids;
+  tracks_.PointsInRadius(center, radius, &track_ids);
+  return track_ids;
+}
+
+std::vector<TrackId> ReconstructionSpatialIndex::NearestTracks(
+    const Eigen::Vector3d& point, const int k) const {
+  std::vector<TrackId> track_ids;
+  tracks_.NearestPoints(point, k, &track_ids);
+  return track_ids;
+}
+
+std::vector<TrackId> ReconstructionSpatialIndex::TracksInFrustum(
+    const Camera& camera, const double max_depth) const {
+  std::vector<TrackId> track_ids;
+  if (camera.ImageWidth() <= 0 || camera.ImageHeight() <= 0) {
+    LOG(WARNING) << "The image size of the camera must be set for frustum "
+                    "queries.";
+    return track_ids;
+  }
+
+  const Eigen::Vector3d center = camera.GetPosition();
+  const Eigen::Vector3d optical_axis =
+      camera.GetOrientationAsRotationMatrix().row(2).transpose();
+  const double max_angle = MaxAngleFromOpticalAxis(camera, optical_axis);
+  const double width = camera.ImageWidth();
+  const double height = camera.ImageHeight();
+
+  // A node may contain visible points if its bounding sphere intersects the
+  // cone of rays and is not beyond the maximum depth.
+  const auto node_may_be_visible = [&](const Eigen::AlignedBox3d& box) {
+    const Eigen::Vector3d offset = box.center() - center;
+    const double radius = 0.5 * box.diagonal().norm();
+    const double distance = offset.norm();
+    if (distance <= radius) {
+      return true;
+    }
+    const double depth = offset.dot(optical_axis);
+    if (depth - radius > max_depth) {
+      return false;
+    }
+    const double angle =
+        std::acos(std::max(-1.0, std::min(1.0, depth / distance)));
+    return angle - std::asin(radius / distance) <= max_angle;
+  };
+  const auto point_is_visible = [&](const TrackId,
+                                    const Eigen::Vector3d& position) {
+    Eigen::Vector2d pixel;
+    const double depth = camera.ProjectPoint(position.homogeneous(), &pixel);
+    return depth > 0.0 && depth <= max_depth && pixel.x() >= 0.0 &&
+           pixel.x() <= width && pixel.y() >= 0.0 && pixel.y() <= height;
+  };
+  tracks_.Search(node_may_be_visible, point_is_visible, &track_ids);
+  return track_ids;
+}
+
+std::vector<ViewId> ReconstructionSpatialIndex::ViewsInBox(
+    const Eigen::AlignedBox3d& box) const {
+  std::vector<ViewId> view_ids;
+  views_.PointsInBox(box, &view_ids);
+  return view_ids;
+}
+
+std::vector<ViewId> ReconstructionSpatialIndex::ViewsInRadius(
+    const Eigen::Vector3d& center, const double radius) const {
+  std::vector<ViewId> view_ids;
+  views_.PointsInRadius(center, radius, &view_ids);
+  return view_ids;
+}
+
+std::vector<ViewId> ReconstructionSpatialIndex::NearestViews(
+    const Eigen::Vector3d& point, const int k) const {
+  std::vector<ViewId> view_ids;
+  views_.NearestPoints(point, k, &view_ids);
+  return view_ids;
+}
+
+}  // namespace theia
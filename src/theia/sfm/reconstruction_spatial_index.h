@@ -0,0 +1,122 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#ifndef THEIA_SFM_RECONSTRUCTION_SPATIAL_INDEX_H_
+#define THEIA_SFM_RECONSTRUCTION_SPATIAL_INDEX_H_
+
+#include <Eigen/Core>
+#include <Eigen/Geometry>
+
+#include <limits>
+#include <vector>
+
+#include "theia/sfm/types.h"
+#include "theia/util/point_octree.h"
+
+namespace theia {
+
+class Camera;
+class Reconstruction;
+
+// A spatial index over the points of the estimated tracks and the centers of
+// the estimated views of a reconstruction. Spatial queries (cropping by a box,
+// neighborhoods of points, localization candidates, the points that a camera
+// sees) then visit only the parts of the scene they cover instead of every
+// track.
+//
+// The index is kept up to date incrementally: UpdateTrack and UpdateView
+// insert, move or remove a single entry to match the reconstruction, and
+// Update synchronizes all entries, touching the octree only for the tracks and
+// views that changed since the last update. Since tracks and views are mutated
+// directly through the reconstruction, the caller updates the index after
+// changing them, e.g. after bundle adjustment or outlier filtering.
+//
+// The queries may be called from several threads at once, but not while the
+// index is updated.
+class ReconstructionSpatialIndex {
+ public:
+  // Indexes the estimated tracks with finite points and the estimated views.
+  explicit ReconstructionSpatialIndex(const Reconstruction& reconstruction);
+
+  // Matches the entry of the track or view to the reconstruction: it is
+  // inserted or moved if the track or view is estimated (and the point is
+  // finite), and removed otherwise or if it is no longer in the
+  // reconstruction.
+  void UpdateTrack(const Reconstruction& reconstruction,
+                   const TrackId track_id);
+  void UpdateView(const Reconstruction& reconstruction, const ViewId view_id);
+
+  // Updates all tracks and views and removes those that are no longer in the
+  // reconstruction.
+  void Update(const Reconstruction& reconstruction);
+
+  int NumTracks() const { return tracks_.Size(); }
+  int NumViews() const { return views_.Size(); }
+
+  // The tracks whose points lie within the box or the radius of the center, in
+  // no particular order.
+  std::vector<TrackId> TracksInBox(const Eigen::AlignedBox3d& box) const;
+  std::vector<TrackId> TracksInRadius(const Eigen::Vector3d& center,
+                                      const double radius) const;
+
+  // The k tracks nearest to the point, sorted by increasing distance.
+  std::vector<TrackId> NearestTracks(const Eigen::Vector3d& point,
+                                     const int k) const;
+
+  // The tracks whose points the camera sees, i.e. that lie in front of the
+  // camera at a depth of at most max_depth and project into the image. The
+  // image size of the camera must be set. The octree is culled with a cone
+  // around the optical axis that contains the rays through the image border,
+  // and the points in the cone are projected into the image.
+  std::vector<TrackId> TracksInFrustum(
+      const Camera& camera,
+      const double max_depth = std::numeric_limits<double>::infinity()) const;
+
+  // The views whose centers lie within the box or the radius of the center,
+  // in no particular order, and the k views nearest to the point sorted by
+  // increasing distance.
+  std::vector<ViewId> ViewsInBox(const Eigen::AlignedBox3d& box) const;
+  std::vector<ViewId> ViewsInRadius(const Eigen::Vector3d& center,
+                                    const double radius) const;
+  std::vector<ViewId> NearestViews(const Eigen::Vector3d& point,
+                                   const int k) const;
+
+ private:
+  PointOctree<TrackId> tracks_;
+  PointOctree<ViewId> views_;
+};
+
+}  // namespace theia
+
+#endif  // THEIA_SFM_RECONSTRUCTION_SPATIAL_INDEX_H_
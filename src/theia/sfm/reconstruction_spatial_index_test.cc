@@ -0,0 +1,184 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#include <Eigen/Core>
+#include <Eigen/Geometry>
+#include <algorithm>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "theia/sfm/camera/camera.h"
+#include "theia/sfm/reconstruction.h"
+#include "theia/sfm/reconstruction_spatial_index.h"
+#include "theia/sfm/track.h"
+#include "theia/sfm/types.h"
+#include "theia/sfm/view.h"
+#include "theia/util/random.h"
+#include "theia/util/stringprintf.h"
+
+namespace theia {
+
+namespace {
+
+static const int kNumViews = 10;
+static const int kNumTracks = 2000;
+
+void BuildReconstruction(RandomNumberGenerator* rng,
+                         Reconstruction* reconstruction) {
+  for (int i = 0; i < kNumViews; i++) {
+    const ViewId view_id =
+        reconstruction->AddView(StringPrintf("%d", i), i);
+    View* view = reconstruction->MutableView(view_id);
+    Camera* camera = view->MutableCamera();
+    camera->SetFocalLength(500.0);
+    camera->SetPrincipalPoint(320.0, 240.0);
+    camera->SetImageSize(640, 480);
+    camera->SetPosition(rng->RandVector3d(-2.0, 2.0));
+    camera->SetOrientationFromAngleAxis(rng->RandVector3d(-0.3, 0.3));
+    view->SetEstimated(true);
+  }
+  for (int i = 0; i < kNumTracks; i++) {
+    const TrackId track_id = reconstruction->AddTrack();
+    Track* track = reconstruction->MutableTrack(track_id);
+    track->SetPoint(rng->RandVector3d(-10.0, 10.0).homogeneous());
+    track->SetEstimated(true);
+  }
+}
+
+template <typename IdType>
+std::vector<IdType> Sorted(std::vector<IdType> ids) {
+  std::sort(ids.begin(), ids.end());
+  return ids;
+}
+
+}  // namespace
+
+TEST(ReconstructionSpatialIndex, TrackAndViewQueries) {
+  RandomNumberGenerator rng(54);
+  Reconstruction reconstruction;
+  BuildReconstruction(&rng, &reconstruction);
+  // Unestimated tracks are not indexed.
+  reconstruction.MutableTrack(0)->SetEstimated(false);
+
+  const ReconstructionSpatialIndex index(reconstruction);
+  EXPECT_EQ(index.NumTracks(), kNumTracks - 1);
+  EXPECT_EQ(index.NumViews(), kNumViews);
+
+  const Eigen::AlignedBox3d box(Eigen::Vector3d(-3.0, -1.0, 0.0),
+                                Eigen::Vector3d(2.0, 4.0, 5.0));
+  const Eigen::Vector3d center(1.0, 2.0, 3.0);
+  std::vector<TrackId> expected_in_box, expected_in_radius;
+  for (const TrackId track_id : reconstruction.TrackIds()) {
+    const Track& track = *reconstruction.Track(track_id);
+    if (!track.IsEstimated()) {
+      continue;
+    }
+    const Eigen::Vector3d point = track.Point().hnormalized();
+    if (box.contains(point)) {
+      expected_in_box.emplace_back(track_id);
+    }
+    if ((point - center).norm() <= 3.0) {
+      expected_in_radius.emplace_back(track_id);
+    }
+  }
+  EXPECT_EQ(Sorted(index.TracksInBox(box)), Sorted(expected_in_box));
+  EXPECT_EQ(Sorted(index.TracksInRadius(center, 3.0)),
+            Sorted(expected_in_radius));
+
+  const std::vector<TrackId> nearest = index.NearestTracks(center, 5);
+  ASSERT_EQ(nearest.size(), 5);
+  const double fifth_distance =
+      (reconstruction.Track(nearest[4])->Point().hnormalized() - center)
+          .norm();
+  EXPECT_EQ(index.TracksInRadius(center, fifth_distance + 1e-9).size(), 5);
+
+  const Eigen::Vector3d position =
+      reconstruction.View(3)->Camera().GetPosition();
+  const std::vector<ViewId> nearest_views = index.NearestViews(position, 1);
+  ASSERT_EQ(nearest_views.size(), 1);
+  EXPECT_EQ(nearest_views[0], 3);
+  EXPECT_EQ(Sorted(index.ViewsInRadius(Eigen::Vector3d::Zero(), 100.0)),
+            Sorted(reconstruction.ViewIds()));
+}
+
+TEST(ReconstructionSpatialIndex, TracksInFrustum) {
+  RandomNumberGenerator rng(55);
+  Reconstruction reconstruction;
+  BuildReconstruction(&rng, &reconstruction);
+  const ReconstructionSpatialIndex index(reconstruction);
+
+  for (const ViewId view_id : reconstruction.ViewIds()) {
+    const Camera& camera = reconstruction.View(view_id)->Camera();
+    for (const double max_depth : {5.0, 1000.0}) {
+      std::vector<TrackId> expected_track_ids;
+      for (const TrackId track_id : reconstruction.TrackIds()) {
+        Eigen::Vector2d pixel;
+        const double depth = camera.ProjectPoint(
+            reconstruction.Track(track_id)->Point(), &pixel);
+        if (depth > 0.0 && depth <= max_depth && pixel.x() >= 0.0 &&
+            pixel.x() <= 640.0 && pixel.y() >= 0.0 && pixel.y() <= 480.0) {
+          expected_track_ids.emplace_back(track_id);
+        }
+      }
+      EXPECT_FALSE(expected_track_ids.empty());
+      EXPECT_EQ(Sorted(index.TracksInFrustum(camera, max_depth)),
+                Sorted(expected_track_ids));
+    }
+  }
+}
+
+TEST(ReconstructionSpatialIndex, IncrementalUpdates) {
+  RandomNumberGenerator rng(56);
+  Reconstruction reconstruction;
+  BuildReconstruction(&rng, &reconstruction);
+  ReconstructionSpatialIndex index(reconstruction);
+
+  const Eigen::Vector3d far_point(100.0, 100.0, 100.0);
+  reconstruction.MutableTrack(1)->SetPoint(far_point.homogeneous());
+  index.UpdateTrack(reconstruction, 1);
+  EXPECT_EQ(index.NearestTracks(far_point, 1), std::vector<TrackId>({1}));
+
+  // Update removes the tracks and views that were removed or unestimated.
+  reconstruction.RemoveTrack(1);
+  reconstruction.MutableTrack(2)->SetEstimated(false);
+  reconstruction.MutableView(0)->SetEstimated(false);
+  reconstruction.MutableTrack(3)->SetPoint(far_point.homogeneous());
+  index.Update(reconstruction);
+  EXPECT_EQ(index.NumTracks(), kNumTracks - 2);
+  EXPECT_EQ(index.NumViews(), kNumViews - 1);
+  EXPECT_EQ(index.NearestTracks(far_point, 1), std::vector<TrackId>({3}));
+}
+
+}  // namespace theia
@@ -0,0 +1,241 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+
+#include "theia/sfm/reconstruction_statistics.h"
+
+#include <Eigen/Core>
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <numeric>
+#include <string>
+#include <vector>
+
+#include "theia/sfm/reconstruction.h"
+#include "theia/sfm/track.h"
+#include "theia/sfm/view.h"
+#include "theia/util/executor.h"
+#include "theia/util/json.h"
+
+namespace theia {
+
+namespace {
+
+// Maps the track id to a uniformly distributed number in [0, 1) with the
+// finalizer of SplitMix64, so that the sample does not depend on the order of
+// the tracks.
+double TrackSamplingKey(const TrackId track_id) {
+  uint64_t key = static_cast<uint64_t>(track_id) + 0x9E3779B97F4A7C15ULL;
+  key = (key ^ (key >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  key = (key ^ (key >> 27)) * 0x94D049BB133111EBULL;
+  key = key ^ (key >> 31);
+  return (key >> 11) * (1.0 / (1ULL << 53));
+}
+
+// The statistics of a block of tracks that are combined by summation. The
+// mean is computed from the errors in their fixed order instead, since a sum
+// of partial sums would depend on the number of threads.
+struct PartialStatistics {
+  int num_observations = 0;
+  int num_projections_behind_camera = 0;
+  double max_reprojection_error = 0.0;
+  Histogram<double> reprojection_error_histogram;
+  Histogram<int> track_length_histogram;
+};
+
+PartialStatistics CombinePartialStatistics(PartialStatistics statistics,
+                                           const PartialStatistics& other) {
+  statistics.num_observations += other.num_observations;
+  statistics.num_projections_behind_camera +=
+      other.num_projections_behind_camera;
+  statistics.max_reprojection_error =
+      std::max(statistics.max_reprojection_error,
+               other.max_reprojection_error);
+  statistics.reprojection_error_histogram.Merge(
+      other.reprojection_error_histogram);
+  statistics.track_length_histogram.Merge(other.track_length_histogram);
+  return statistics;
+}
+
+template <typename T>
+nlohmann::json HistogramToJson(const Histogram<T>& histogram) {
+  return {{"boundaries", histogram.Boundaries()},
+          {"counts", histogram.Counts()}};
+}
+
+}  // namespace
+
+ReconstructionStatistics ComputeReconstructionStatistics(
+    const ReconstructionStatisticsOptions& options,
+    const Reconstruction& reconstruction) {
+  CHECK_GT(options.track_sampling_ratio, 0.0);
+
+  ReconstructionStatistics statistics;
+  statistics.num_views = reconstruction.NumViews();
+  statistics.num_tracks = reconstruction.NumTracks();
+  for (const ViewId view_id : reconstruction.ViewIds()) {
+    if (reconstruction.View(view_id)->IsEstimated()) {
+      ++statistics.num_estimated_views;
+    }
+  }
+
+  // Select the tracks to evaluate and the range of the reprojection errors of
+  // each of them, so that the errors are written in parallel in a fixed order.
+  std::vector<TrackId> track_ids;
+  std::vector<int> track_lengths;
+  std::vector<int> first_observations(1, 0);
+  for (const TrackId track_id : reconstruction.TrackIds()) {
+    const Track* track = reconstruction.Track(track_id);
+    if (!track->IsEstimated()) {
+      continue;
+    }
+    ++statistics.num_estimated_tracks;
+    if (options.track_sampling_ratio < 1.0 &&
+        TrackSamplingKey(track_id) >= options.track_sampling_ratio) {
+      continue;
+    }
+    track_ids.emplace_back(track_id);
+    track_lengths.emplace_back(track->NumViews());
+    first_observations.emplace_back(first_observations.back() +
+                                    track->NumViews());
+  }
+  statistics.num_evaluated_tracks = track_ids.size();
+
+  // Observations in views that are not estimated keep a negative error and
+  // are removed before the median is computed.
+  std::vector<double> reprojection_errors(first_observations.back(), -1.0);
+  PartialStatistics identity;
+  identity.reprojection_error_histogram =
+      Histogram<double>(options.reprojection_error_histogram_bins);
+  identity.track_length_histogram =
+      Histogram<int>(options.track_length_histogram_bins);
+  const PartialStatistics total = ParallelReduce(
+      options.num_threads,
+      track_ids.size(),
+      identity,
+      [&](const int start, const int end) {
+        PartialStatistics partial = identity;
+        for (int i = start; i < end; i++) {
+          const Track* track = reconstruction.Track(track_ids[i]);
+          partial.track_length_histogram.Add(track_lengths[i]);
+          int observation = first_observations[i];
+          for (const ViewId view_id : track->ViewIds()) {
+            const View* view = reconstruction.View(view_id);
+            const Feature* feature = view->GetFeature(track_ids[i]);
+            if (!view->IsEstimated() || feature == nullptr) {
+              ++observation;
+              continue;
+            }
+
+            Eigen::Vector2d projection;
+            if (view->Camera().ProjectPoint(track->Point(), &projection) <
+                0) {
+              ++partial.num_projections_behind_camera;
+            }
+            const double reprojection_error =
+                (feature->point_ - projection).norm();
+            reprojection_errors[observation++] = reprojection_error;
+            ++partial.num_observations;
+            partial.max_reprojection_error =
+                std::max(partial.max_reprojection_error, reprojection_error);
+            partial.reprojection_error_histogram.Add(reprojection_error);
+          }
+        }
+        return partial;
+      },
+      CombinePartialStatistics);
+
+  statistics.num_observations = total.num_observations;
+  statistics.num_projections_behind_camera =
+      total.num_projections_behind_camera;
+  statistics.max_reprojection_error = total.max_reprojection_error;
+  statistics.reprojection_error_histogram = total.reprojection_error_histogram;
+  statistics.track_length_histogram = total.track_length_histogram;
+
+  if (total.num_observations > 0) {
+    reprojection_errors.erase(std::remove(reprojection_errors.begin(),
+                                          reprojection_errors.end(),
+                                          -1.0),
+                              reprojection_errors.end());
+    statistics.mean_reprojection_error =
+        std::accumulate(
+            reprojection_errors.begin(), reprojection_errors.end(), 0.0) /
+        reprojection_errors.size();
+    const auto median = reprojection_errors.begin() +
+                        reprojection_errors.size() / 2;
+    std::nth_element(
+        reprojection_errors.begin(), median, reprojection_errors.end());
+    statistics.median_reprojection_error = *median;
+  }
+
+  if (!track_lengths.empty()) {
+    double sum_of_track_lengths = 0.0;
+    for (const int track_length : track_lengths) {
+      sum_of_track_lengths += track_length;
+    }
+    statistics.mean_track_length = sum_of_track_lengths / track_lengths.size();
+    std::nth_element(track_lengths.begin(),
+                     track_lengths.begin() + track_lengths.size() / 2,
+                     track_lengths.end());
+    statistics.median_track_length = track_lengths[track_lengths.size() / 2];
+  }
+  return statistics;
+}
+
+std::string ReconstructionStatisticsToJson(
+    const ReconstructionStatistics& statistics) {
+  nlohmann::json json;
+  json["num_views"] = statistics.num_views;
+  json["num_estimated_views"] = statistics.num_estimated_views;
+  json["num_tracks"] = statistics.num_tracks;
+  json["num_estimated_tracks"] = statistics.num_estimated_tracks;
+  json["num_evaluated_tracks"] = statistics.num_evaluated_tracks;
+  json["num_observations"] = statistics.num_observations;
+  json["num_projections_behind_camera"] =
+      statistics.num_projections_behind_camera;
+  json["reprojection_error"] = {
+      {"mean", statistics.mean_reprojection_error},
+      {"median", statistics.median_reprojection_error},
+      {"max", statistics.max_reprojection_error},
+      {"histogram", HistogramToJson(statistics.reprojection_error_histogram)}};
+  json["track_length"] = {
+      {"mean", statistics.mean_track_length},
+      {"median", statistics.median_track_length},
+      {"histogram", HistogramToJson(statistics.track_length_histogram)}};
+  return json.dump(2);
+}
+
+}  // namespace theia
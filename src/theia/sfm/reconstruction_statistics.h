@@ -0,0 +1,102 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+
+#ifndef THEIA_SFM_RECONSTRUCTION_STATISTICS_H_
+#define THEIA_SFM_RECONSTRUCTION_STATISTICS_H_
+
+#include <string>
+#include <vector>
+
+#include "theia/math/histogram.h"
+
+namespace theia {
+
+class Reconstruction;
+
+struct ReconstructionStatisticsOptions {
+  // Number of threads used to evaluate the tracks.
+  int num_threads = 1;
+
+  // Fraction of the estimated tracks that are evaluated. Tracks are sampled
+  // deterministically by their id, so values below 1 give approximate
+  // statistics of large reconstructions at a fraction of the cost, and the
+  // same tracks are sampled in every run.
+  double track_sampling_ratio = 1.0;
+
+  // The bins of the reprojection error (in pixels) and track length
+  // histograms.
+  std::vector<double> reprojection_error_histogram_bins = {
+      0.5, 1, 2, 4, 8, 16, 32};
+  std::vector<int> track_length_histogram_bins = {
+      2, 3, 4, 5, 6, 7, 8, 9, 10, 15, 20, 25, 50};
+};
+
+struct ReconstructionStatistics {
+  int num_views = 0;
+  int num_estimated_views = 0;
+  int num_tracks = 0;
+  int num_estimated_tracks = 0;
+
+  // The statistics below are computed over the evaluated (i.e. sampled)
+  // estimated tracks and their observations in estimated views.
+  int num_evaluated_tracks = 0;
+  int num_observations = 0;
+  int num_projections_behind_camera = 0;
+
+  double mean_reprojection_error = 0.0;
+  double median_reprojection_error = 0.0;
+  double max_reprojection_error = 0.0;
+  Histogram<double> reprojection_error_histogram;
+
+  double mean_track_length = 0.0;
+  int median_track_length = 0;
+  Histogram<int> track_length_histogram;
+};
+
+// Computes the reprojection error and track length statistics of the estimated
+// tracks of the reconstruction. The tracks are evaluated in parallel and the
+// histograms are accumulated per thread and merged. The result does not depend
+// on the number of threads.
+ReconstructionStatistics ComputeReconstructionStatistics(
+    const ReconstructionStatisticsOptions& options,
+    const Reconstruction& reconstruction);
+
+// Returns the statistics as a JSON object, e.g. for QA scripts.
+std::string ReconstructionStatisticsToJson(
+    const ReconstructionStatistics& statistics);
+
+}  // namespace theia
+
+#endif  // THEIA_SFM_RECONSTRUCTION_STATISTICS_H_
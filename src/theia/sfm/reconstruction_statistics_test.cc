@@ -0,0 +1,166 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+
+#include "theia/sfm/reconstruction_statistics.h"
+
+#include <Eigen/Core>
+
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "theia/sfm/reconstruction.h"
+#include "theia/util/json.h"
+
+namespace theia {
+
+namespace {
+
+static const int kNumTracks = 100;
+
+// Two estimated views and one unestimated view observe all tracks. The
+// observations of track i in the estimated views have a reprojection error of
+// 0.1 * i + 0.05 pixels.
+void CreateReconstruction(Reconstruction* reconstruction) {
+  std::vector<ViewId> view_ids;
+  for (int i = 0; i < 3; i++) {
+    view_ids.emplace_back(reconstruction->AddView(std::to_string(i), i));
+    View* view = reconstruction->MutableView(view_ids.back());
+    view->MutableCamera()->SetFocalLength(1.0);
+    view->MutableCamera()->SetPrincipalPoint(0.0, 0.0);
+    view->SetEstimated(i < 2);
+  }
+
+  for (int i = 0; i < kNumTracks; i++) {
+    const TrackId track_id = reconstruction->AddTrack();
+    Track* track = reconstruction->MutableTrack(track_id);
+    const Eigen::Vector2d projection(0.01 * i, -0.02 * i);
+    track->SetPoint(Eigen::Vector4d(5.0 * projection.x(),
+                                    5.0 * projection.y(),
+                                    5.0,
+                                    1.0));
+    track->SetEstimated(true);
+    const Eigen::Vector2d error(0.1 * i + 0.05, 0.0);
+    for (const ViewId view_id : view_ids) {
+      EXPECT_TRUE(reconstruction->AddObservation(
+          view_id, track_id, Feature(projection + error)));
+    }
+  }
+
+  // An unestimated track is ignored.
+  const TrackId track_id = reconstruction->AddTrack();
+  reconstruction->AddObservation(view_ids[0], track_id, Feature(100.0, 0.0));
+  reconstruction->AddObservation(view_ids[1], track_id, Feature(100.0, 0.0));
+}
+
+}  // namespace
+
+TEST(ReconstructionStatistics, ReprojectionErrorsAndTrackLengths) {
+  Reconstruction reconstruction;
+  CreateReconstruction(&reconstruction);
+
+  ReconstructionStatisticsOptions options;
+  const ReconstructionStatistics statistics =
+      ComputeReconstructionStatistics(options, reconstruction);
+  EXPECT_EQ(statistics.num_views, 3);
+  EXPECT_EQ(statistics.num_estimated_views, 2);
+  EXPECT_EQ(statistics.num_tracks, kNumTracks + 1);
+  EXPECT_EQ(statistics.num_estimated_tracks, kNumTracks);
+  EXPECT_EQ(statistics.num_evaluated_tracks, kNumTracks);
+  EXPECT_EQ(statistics.num_observations, 2 * kNumTracks);
+  EXPECT_EQ(statistics.num_projections_behind_camera, 0);
+  EXPECT_NEAR(statistics.mean_reprojection_error, 5.0, 1e-8);
+  EXPECT_NEAR(statistics.median_reprojection_error, 5.05, 1e-8);
+  EXPECT_NEAR(statistics.max_reprojection_error, 9.95, 1e-8);
+  EXPECT_EQ(statistics.reprojection_error_histogram.Counts(),
+            std::vector<int>({10, 10, 20, 40, 80, 40, 0, 0}));
+
+  // The unestimated view still counts towards the track length.
+  EXPECT_EQ(statistics.mean_track_length, 3.0);
+  EXPECT_EQ(statistics.median_track_length, 3);
+  EXPECT_EQ(statistics.track_length_histogram.NumValues(), kNumTracks);
+}
+
+TEST(ReconstructionStatistics, ResultDoesNotDependOnNumThreads) {
+  Reconstruction reconstruction;
+  CreateReconstruction(&reconstruction);
+
+  ReconstructionStatisticsOptions options;
+  const ReconstructionStatistics expected =
+      ComputeReconstructionStatistics(options, reconstruction);
+  options.num_threads = 4;
+  const ReconstructionStatistics statistics =
+      ComputeReconstructionStatistics(options, reconstruction);
+  EXPECT_EQ(ReconstructionStatisticsToJson(statistics),
+            ReconstructionStatisticsToJson(expected));
+}
+
+TEST(ReconstructionStatistics, SampledTracks) {
+  Reconstruction reconstruction;
+  CreateReconstruction(&reconstruction);
+
+  ReconstructionStatisticsOptions options;
+  options.track_sampling_ratio = 0.5;
+  const ReconstructionStatistics statistics =
+      ComputeReconstructionStatistics(options, reconstruction);
+  EXPECT_EQ(statistics.num_estimated_tracks, kNumTracks);
+  EXPECT_GT(statistics.num_evaluated_tracks, kNumTracks / 4);
+  EXPECT_LT(statistics.num_evaluated_tracks, 3 * kNumTracks / 4);
+  EXPECT_EQ(statistics.num_observations, 2 * statistics.num_evaluated_tracks);
+  EXPECT_EQ(statistics.reprojection_error_histogram.NumValues(),
+            statistics.num_observations);
+
+  // The same tracks are sampled every time.
+  EXPECT_EQ(ReconstructionStatisticsToJson(
+                ComputeReconstructionStatistics(options, reconstruction)),
+            ReconstructionStatisticsToJson(statistics));
+}
+
+TEST(ReconstructionStatistics, Json) {
+  Reconstruction reconstruction;
+  CreateReconstruction(&reconstruction);
+
+  const ReconstructionStatistics statistics = ComputeReconstructionStatistics(
+      ReconstructionStatisticsOptions(), reconstruction);
+  const nlohmann::json json =
+      nlohmann::json::parse(ReconstructionStatisticsToJson(statistics));
+  EXPECT_EQ(json["num_observations"].get<int>(), 2 * kNumTracks);
+  EXPECT_NEAR(json["reprojection_error"]["median"].get<double>(), 5.05, 1e-8);
+  EXPECT_EQ(json["reprojection_error"]["histogram"]["boundaries"].size(), 7);
+  EXPECT_EQ(json["reprojection_error"]["histogram"]["counts"].size(), 8);
+  EXPECT_EQ(json["track_length"]["median"].get<int>(), 3);
+}
+
+}  // namespace theia
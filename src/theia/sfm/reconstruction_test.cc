@@ -34,8 +34,17 @@
 
 #include "gtest/gtest.h"
 
+#include <Eigen/Core>
+#include <Eigen/Geometry>
+#include <algorithm>
+#include <cereal/archives/portable_binary.hpp>
+#include <sstream>  // NOLINT
+#include <vector>
+
+#include "theia/sfm/camera_rig.h"
 #include "theia/sfm/reconstruction.h"
 #include "theia/util/map_util.h"
+#include "theia/util/random.h"
 #include "theia/util/stringprintf.h"
 
 namespace theia {
@@ -119,6 +128,142 @@ TEST(Reconstruction, RemoveView) {
   EXPECT_FALSE(reconstruction.RemoveView(view_id1));
 }
 
+TEST(Reconstruction, TimestampQueries) {
+  Reconstruction reconstruction;
+  // The views are added out of order of their timestamps.
+  const std::vector<double> timestamps = {3.0, 0.5, 2.0, 1.0, 4.5};
+  std::vector<ViewId> view_ids;
+  for (int i = 0; i < timestamps.size(); i++) {
+    view_ids.emplace_back(
+        reconstruction.AddView(StringPrintf("%d", i), timestamps[i]));
+  }
+
+  const std::vector<ViewId> sorted_view_ids = {
+      view_ids[1], view_ids[3], view_ids[2], view_ids[0], view_ids[4]};
+  EXPECT_EQ(reconstruction.ViewIdsSortedByTimestamp(), sorted_view_ids);
+
+  const std::vector<ViewId> range_view_ids = {view_ids[3], view_ids[2]};
+  EXPECT_EQ(reconstruction.ViewIdsInTimeRange(1.0, 2.5), range_view_ids);
+  EXPECT_TRUE(reconstruction.ViewIdsInTimeRange(1.1, 1.9).empty());
+  EXPECT_TRUE(reconstruction.ViewIdsInTimeRange(2.5, 1.0).empty());
+
+  EXPECT_EQ(reconstruction.ViewIdNearestToTimestamp(-10.0), view_ids[1]);
+  EXPECT_EQ(reconstruction.ViewIdNearestToTimestamp(2.4), view_ids[2]);
+  EXPECT_EQ(reconstruction.ViewIdNearestToTimestamp(2.5), view_ids[2]);
+  EXPECT_EQ(reconstruction.ViewIdNearestToTimestamp(10.0), view_ids[4]);
+
+  const std::vector<ViewId> nearest_view_ids = {
+      view_ids[2], view_ids[0], view_ids[3]};
+  EXPECT_EQ(reconstruction.KNearestViewIdsToTimestamp(2.4, 3),
+            nearest_view_ids);
+  EXPECT_EQ(reconstruction.KNearestViewIdsToTimestamp(0.0, 10).size(),
+            timestamps.size());
+
+  // The index is updated when views are removed.
+  EXPECT_TRUE(reconstruction.RemoveView(view_ids[2]));
+  EXPECT_EQ(reconstruction.ViewIdNearestToTimestamp(2.4), view_ids[0]);
+  EXPECT_EQ(reconstruction.ViewIdsInTimeRange(1.0, 2.5).size(), 1);
+
+  Reconstruction empty_reconstruction;
+  EXPECT_EQ(empty_reconstruction.ViewIdNearestToTimestamp(0.0),
+            kInvalidViewId);
+}
+
+TEST(Reconstruction, AddViewToCameraRig) {
+  Reconstruction reconstruction;
+  const ViewId view_id1 = reconstruction.AddView(view_names[0], 0.0);
+  const ViewId view_id2 = reconstruction.AddView(view_names[1], 1.0);
+  const ViewId view_id3 = reconstruction.AddView(view_names[2], 2.0);
+
+  CameraRig camera_rig;
+  camera_rig.AddCamera(Eigen::Vector3d::Zero(), Eigen::Vector3d::Zero());
+  camera_rig.AddCamera(Eigen::Vector3d(1.0, 0.0, 0.0),
+                       Eigen::Vector3d(0.0, 0.5, 0.0));
+  const CameraRigId rig_id = reconstruction.AddCameraRig(camera_rig);
+  EXPECT_EQ(reconstruction.NumCameraRigs(), 1);
+  EXPECT_EQ(reconstruction.CameraRig(rig_id)->NumCameras(), 2);
+  EXPECT_EQ(reconstruction.CameraRig(rig_id + 1), nullptr);
+
+  EXPECT_TRUE(reconstruction.AddViewToCameraRig(view_id1, rig_id, 0, 7));
+  EXPECT_TRUE(reconstruction.AddViewToCameraRig(view_id2, rig_id, 1, 7));
+  // The camera of the rig frame already has a view.
+  EXPECT_FALSE(reconstruction.AddViewToCameraRig(view_id3, rig_id, 1, 7));
+  // The view already belongs to a rig.
+  EXPECT_FALSE(reconstruction.AddViewToCameraRig(view_id1, rig_id, 0, 8));
+  // Invalid rig, camera or view.
+  EXPECT_FALSE(reconstruction.AddViewToCameraRig(view_id3, rig_id + 1, 0, 8));
+  EXPECT_FALSE(reconstruction.AddViewToCameraRig(view_id3, rig_id, 2, 8));
+  EXPECT_FALSE(
+      reconstruction.AddViewToCameraRig(kInvalidViewId, rig_id, 0, 8));
+
+  const CameraRigMembership* membership =
+      reconstruction.CameraRigMembershipFromViewId(view_id2);
+  ASSERT_NE(membership, nullptr);
+  EXPECT_EQ(membership->rig_id, rig_id);
+  EXPECT_EQ(membership->camera_index, 1);
+  EXPECT_EQ(membership->frame_id, 7);
+  EXPECT_EQ(reconstruction.CameraRigMembershipFromViewId(view_id3), nullptr);
+  EXPECT_EQ(reconstruction.GetViewsInCameraRigFrame(rig_id, 7),
+            std::vector<ViewId>({view_id1, view_id2}));
+  EXPECT_TRUE(reconstruction.GetViewsInCameraRigFrame(rig_id, 8).empty());
+
+  // Sub-reconstructions keep the rigs of their views.
+  Reconstruction subreconstruction;
+  reconstruction.GetSubReconstruction({view_id2}, &subreconstruction);
+  EXPECT_EQ(subreconstruction.NumCameraRigs(), 1);
+  EXPECT_EQ(subreconstruction.GetViewsInCameraRigFrame(rig_id, 7),
+            std::vector<ViewId>({view_id2}));
+
+  // Removing a view removes it from its rig frame.
+  EXPECT_TRUE(reconstruction.RemoveView(view_id1));
+  EXPECT_EQ(reconstruction.CameraRigMembershipFromViewId(view_id1), nullptr);
+  EXPECT_EQ(reconstruction.GetViewsInCameraRigFrame(rig_id, 7),
+            std::vector<ViewId>({view_id2}));
+}
+
+TEST(Reconstruction, SerializeCameraRigs) {
+  Reconstruction reconstruction;
+  const ViewId view_id1 = reconstruction.AddView(view_names[0], 0.0);
+  const ViewId view_id2 = reconstruction.AddView(view_names[1], 1.0);
+  CameraRig camera_rig;
+  camera_rig.AddCamera(Eigen::Vector3d::Zero(), Eigen::Vector3d::Zero());
+  camera_rig.AddCamera(Eigen::Vector3d(1.0, 2.0, 3.0),
+                       Eigen::Vector3d(0.1, 0.2, 0.3));
+  const CameraRigId rig_id = reconstruction.AddCameraRig(camera_rig);
+  EXPECT_TRUE(reconstruction.AddViewToCameraRig(view_id1, rig_id, 0, 3));
+  EXPECT_TRUE(reconstruction.AddViewToCameraRig(view_id2, rig_id, 1, 3));
+
+  std::stringstream stream;
+  {
+    cereal::PortableBinaryOutputArchive output_archive(stream);
+    output_archive(reconstruction);
+  }
+  Reconstruction loaded_reconstruction;
+  {
+    cereal::PortableBinaryInputArchive input_archive(stream);
+    input_archive(loaded_reconstruction);
+  }
+
+  ASSERT_EQ(loaded_reconstruction.NumCameraRigs(), 1);
+  const CameraRig* loaded_camera_rig = loaded_reconstruction.CameraRig(rig_id);
+  ASSERT_NE(loaded_camera_rig, nullptr);
+  EXPECT_EQ(loaded_camera_rig->NumCameras(), 2);
+  EXPECT_EQ(loaded_camera_rig->CameraPosition(1),
+            camera_rig.CameraPosition(1));
+  EXPECT_EQ(loaded_camera_rig->CameraOrientationAsAngleAxis(1),
+            camera_rig.CameraOrientationAsAngleAxis(1));
+  EXPECT_EQ(loaded_reconstruction.CameraRigMembershipFromViewId(view_id2)
+                ->camera_index,
+            1);
+  std::vector<ViewId> frame_views =
+      loaded_reconstruction.GetViewsInCameraRigFrame(rig_id, 3);
+  std::sort(frame_views.begin(), frame_views.end());
+  EXPECT_EQ(frame_views, std::vector<ViewId>({view_id1, view_id2}));
+
+  // New rigs get new ids.
+  EXPECT_NE(loaded_reconstruction.AddCameraRig(camera_rig), rig_id);
+}
+
 TEST(Reconstruction, GetViewValid) {
   Reconstruction reconstruction;
   const ViewId view_id = reconstruction.AddView(view_names[0], 0.0);
@@ -291,6 +436,32 @@ TEST(Reconstruction, AddTrackInvalid) {
   EXPECT_EQ(reconstruction.NumTracks(), 0);
 }
 
+TEST(Reconstruction, AddTracks) {
+  Reconstruction reconstruction;
+  const ViewId view_id1 = reconstruction.AddView(view_names[0], 0.0);
+  const ViewId view_id2 = reconstruction.AddView(view_names[1], 1.0);
+
+  const std::vector<std::vector<std::pair<ViewId, Feature> > > tracks = {
+      {{view_id1, features[0]}, {view_id2, features[1]}},
+      // Invalid since it has a single observation.
+      {{view_id1, features[2]}},
+      {{view_id1, features[2]}, {view_id2, features[0]}}};
+  const std::vector<TrackId> track_ids = reconstruction.AddTracks(tracks);
+  ASSERT_EQ(track_ids.size(), 3);
+  EXPECT_NE(track_ids[0], kInvalidTrackId);
+  EXPECT_EQ(track_ids[1], kInvalidTrackId);
+  EXPECT_NE(track_ids[2], kInvalidTrackId);
+  EXPECT_EQ(reconstruction.NumTracks(), 2);
+
+  const View* view1 = reconstruction.View(view_id1);
+  EXPECT_EQ(view1->NumFeatures(), 2);
+  EXPECT_EQ(view1->GetTrack(features[0]), track_ids[0]);
+  EXPECT_EQ(view1->GetTrack(features[2]), track_ids[2]);
+  EXPECT_EQ(reconstruction.View(view_id2)->GetTrack(features[0]),
+            track_ids[2]);
+  EXPECT_EQ(reconstruction.Track(track_ids[2])->NumViews(), 2);
+}
+
 TEST(Reconstruction, RemoveTrackValid) {
   Reconstruction reconstruction;
 
@@ -341,6 +512,24 @@ TEST(Reconstruction, GetTrackInvalid) {
   EXPECT_EQ(mutable_track, nullptr);
 }
 
+TEST(Reconstruction, EstimateMemoryUsage) {
+  Reconstruction reconstruction;
+  EXPECT_EQ(reconstruction.EstimateMemoryUsage(), 0);
+
+  EXPECT_NE(reconstruction.AddView(view_names[0], 0.0), kInvalidViewId);
+  EXPECT_NE(reconstruction.AddView(view_names[1], 1.0), kInvalidViewId);
+  const size_t views_size_in_bytes = reconstruction.EstimateMemoryUsage();
+  EXPECT_GT(views_size_in_bytes, 0);
+
+  const std::vector<std::pair<ViewId, Feature> > track = {{0, features[0]},
+                                                          {1, features[1]}};
+  const TrackId track_id = reconstruction.AddTrack(track);
+  EXPECT_GT(reconstruction.EstimateMemoryUsage(), views_size_in_bytes);
+
+  EXPECT_TRUE(reconstruction.RemoveTrack(track_id));
+  EXPECT_EQ(reconstruction.EstimateMemoryUsage(), views_size_in_bytes);
+}
+
 TEST(Reconstruction, GetSubReconstruction) {
   static const int kNumViews = 100;
   static const int kNumTracks = 1000;
@@ -433,4 +622,59 @@ TEST(Reconstruction, GetSubReconstruction) {
   }
 }
 
+// Adds estimated cameras rotated about a common, tilted up axis and estimated
+// points.
+void BuildNormalizationScene(const int seed, Reconstruction* reconstruction) {
+  static const int kNumViews = 20;
+  static const int kNumTracks = 100000;
+  RandomNumberGenerator rng(seed);
+  const Eigen::Matrix3d tilt =
+      Eigen::AngleAxisd(0.3, Eigen::Vector3d(1.0, 0.0, 0.5).normalized())
+          .toRotationMatrix();
+  for (int i = 0; i < kNumViews; i++) {
+    const ViewId view_id =
+        reconstruction->AddView(StringPrintf("%d", i), i);
+    class View* view = reconstruction->MutableView(view_id);
+    view->MutableCamera()->SetOrientationFromRotationMatrix(
+        Eigen::AngleAxisd(rng.RandDouble(-1.0, 1.0), Eigen::Vector3d::UnitY())
+            .toRotationMatrix() *
+        tilt.transpose());
+    view->MutableCamera()->SetPosition(Eigen::Vector3d(
+        rng.RandDouble(5.0, 9.0), rng.RandDouble(-1.0, 1.0), 3.0));
+    view->SetEstimated(true);
+  }
+  for (int i = 0; i < kNumTracks; i++) {
+    const TrackId track_id = reconstruction->AddTrack();
+    class Track* track = reconstruction->MutableTrack(track_id);
+    *track->MutablePoint() = Eigen::Vector4d(rng.RandGaussian(0.0, 2.0),
+                                             rng.RandGaussian(1.0, 3.0),
+                                             rng.RandGaussian(-2.0, 1.0),
+                                             1.0);
+    track->SetEstimated(true);
+  }
+}
+
+TEST(Reconstruction, NormalizeIsIndependentOfNumThreads) {
+  Reconstruction serial, parallel;
+  BuildNormalizationScene(91, &serial);
+  BuildNormalizationScene(91, &parallel);
+  serial.Normalize();
+  parallel.Normalize(4);
+
+  for (const ViewId view_id : serial.ViewIds()) {
+    const Camera& camera = serial.View(view_id)->Camera();
+    EXPECT_EQ(camera.GetPosition(),
+              parallel.View(view_id)->Camera().GetPosition());
+    // The x-directions of the cameras are rotated into the x-z plane.
+    const Eigen::Vector3d x =
+        camera.GetOrientationAsRotationMatrix().transpose() *
+        Eigen::Vector3d::UnitX();
+    EXPECT_NEAR(x.y(), 0.0, 1e-9);
+  }
+  for (const TrackId track_id : serial.TrackIds()) {
+    EXPECT_EQ(serial.Track(track_id)->Point(),
+              parallel.Track(track_id)->Point());
+  }
+}
+
 }  // namespace theia
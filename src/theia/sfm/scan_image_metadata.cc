@@ -0,0 +1,120 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#include "theia/sfm/scan_image_metadata.h"
+
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "theia/matching/features_and_matches_database.h"
+#include "theia/sfm/camera_intrinsics_prior.h"
+#include "theia/sfm/exif_reader.h"
+#include "theia/util/executor.h"
+#include "theia/util/filesystem.h"
+
+namespace theia {
+namespace {
+
+// Returns true if the metadata of the image has to be (re-)extracted.
+bool ImageNeedsScan(const ScanImageMetadataOptions& options,
+                    const std::string& image_filename,
+                    const FileSignature& signature,
+                    FeaturesAndMatchesDatabase* database) {
+  if (!database->ContainsCameraIntrinsicsPrior(image_filename)) {
+    return true;
+  }
+
+  FileSignature stored_signature;
+  if (!database->GetImageFileSignature(image_filename, &stored_signature)) {
+    // The prior was not extracted from the image metadata, so it must be kept.
+    return false;
+  }
+  return !options.skip_unchanged_images || stored_signature != signature;
+}
+
+}  // namespace
+
+bool ScanImageMetadata(const ScanImageMetadataOptions& options,
+                       const std::vector<std::string>& image_filepaths,
+                       FeaturesAndMatchesDatabase* database) {
+  CHECK_GT(options.num_threads, 0);
+  CHECK_NOTNULL(database);
+
+  // The sensor database is loaded once and shared by all threads. Extracting
+  // the metadata does not modify the reader.
+  const ExifReader exif_reader;
+  std::atomic<int> num_scanned_images(0);
+  std::atomic<bool> success(true);
+  const auto scan_images = [&](const int start, const int end) {
+    for (int i = start; i < end; i++) {
+      const std::string& image_filepath = image_filepaths[i];
+      std::string image_filename;
+      FileSignature signature;
+      if (!GetFilenameFromFilepath(image_filepath, true, &image_filename) ||
+          !GetFileSignature(image_filepath, &signature)) {
+        LOG(ERROR) << "Could not find the image file " << image_filepath;
+        success = false;
+        continue;
+      }
+
+      if (!ImageNeedsScan(options, image_filename, signature, database)) {
+        continue;
+      }
+
+      CameraIntrinsicsPrior intrinsics;
+      if (!exif_reader.ExtractEXIFMetadata(image_filepath, &intrinsics)) {
+        success = false;
+        continue;
+      }
+      database->PutCameraIntrinsicsPrior(image_filename, intrinsics);
+      database->PutImageFileSignature(image_filename, signature);
+      ++num_scanned_images;
+    }
+  };
+
+  // Reading a header is fast, so the images are split into more blocks than
+  // threads to balance slow (e.g. network) files between the threads.
+  ParallelFor(options.num_threads, image_filepaths.size(), scan_images);
+
+  VLOG(1) << "Scanned the metadata of " << num_scanned_images << " of "
+          << image_filepaths.size() << " images.";
+  return success;
+}
+
+}  // namespace theia
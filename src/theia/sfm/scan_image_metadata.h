@@ -0,0 +1,73 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#ifndef THEIA_SFM_SCAN_IMAGE_METADATA_H_
+#define THEIA_SFM_SCAN_IMAGE_METADATA_H_
+
+#include <string>
+#include <vector>
+
+namespace theia {
+
+class FeaturesAndMatchesDatabase;
+
+struct ScanImageMetadataOptions {
+  // Number of threads used to read the image headers.
+  int num_threads = 1;
+
+  // If true, images whose size and modification time match the signature
+  // stored in the database by a previous scan are not read again.
+  bool skip_unchanged_images = true;
+};
+
+// Extracts the image size and EXIF metadata of the images and stores them as
+// camera intrinsics priors in the database, keyed by the image filename. This
+// is meant to be run once before feature extraction so that the extractor
+// finds the priors of all images in the database. Only the image headers are
+// read and the images are scanned in parallel.
+//
+// Along with each prior, the size and modification time of the image file are
+// stored (for databases that support it, see
+// FeaturesAndMatchesDatabase::PutImageFileSignature) so that re-runs only scan
+// new or modified images. Priors that were stored without a signature, e.g.
+// priors read from a calibration file, are never overwritten.
+//
+// Returns false if any of the images could not be read.
+bool ScanImageMetadata(const ScanImageMetadataOptions& options,
+                       const std::vector<std::string>& image_filepaths,
+                       FeaturesAndMatchesDatabase* database);
+
+}  // namespace theia
+
+#endif  // THEIA_SFM_SCAN_IMAGE_METADATA_H_
@@ -0,0 +1,98 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "theia/matching/in_memory_features_and_matches_database.h"
+#include "theia/sfm/camera_intrinsics_prior.h"
+#include "theia/sfm/scan_image_metadata.h"
+
+namespace theia {
+
+namespace {
+
+const std::string exif_img_filepath =
+    THEIA_DATA_DIR + std::string("/image/exif.jpg");
+const std::string gps_exif_img_filepath =
+    THEIA_DATA_DIR + std::string("/image/gps_exif.jpg");
+
+}  // namespace
+
+TEST(ScanImageMetadata, StoresPriors) {
+  ScanImageMetadataOptions options;
+  options.num_threads = 2;
+  InMemoryFeaturesAndMatchesDatabase database;
+  EXPECT_TRUE(ScanImageMetadata(
+      options, {exif_img_filepath, gps_exif_img_filepath}, &database));
+
+  ASSERT_TRUE(database.ContainsCameraIntrinsicsPrior("exif.jpg"));
+  ASSERT_TRUE(database.ContainsCameraIntrinsicsPrior("gps_exif.jpg"));
+  const CameraIntrinsicsPrior prior =
+      database.GetCameraIntrinsicsPrior("exif.jpg");
+  EXPECT_TRUE(prior.focal_length.is_set);
+  EXPECT_NEAR(prior.focal_length.value[0], 1304.84, 0.1);
+  EXPECT_EQ(prior.image_width, 960);
+  EXPECT_EQ(prior.image_height, 1280);
+  EXPECT_TRUE(
+      database.GetCameraIntrinsicsPrior("gps_exif.jpg").latitude.is_set);
+}
+
+TEST(ScanImageMetadata, KeepsPriorsWithoutSignature) {
+  InMemoryFeaturesAndMatchesDatabase database;
+  CameraIntrinsicsPrior calibrated_prior;
+  calibrated_prior.focal_length.is_set = true;
+  calibrated_prior.focal_length.value[0] = 100.0;
+  database.PutCameraIntrinsicsPrior("exif.jpg", calibrated_prior);
+
+  EXPECT_TRUE(ScanImageMetadata(
+      ScanImageMetadataOptions(), {exif_img_filepath}, &database));
+  EXPECT_EQ(database.GetCameraIntrinsicsPrior("exif.jpg").focal_length.value[0],
+            100.0);
+}
+
+TEST(ScanImageMetadata, MissingImage) {
+  InMemoryFeaturesAndMatchesDatabase database;
+  EXPECT_FALSE(ScanImageMetadata(
+      ScanImageMetadataOptions(),
+      {exif_img_filepath, THEIA_DATA_DIR + std::string("/image/missing.jpg")},
+      &database));
+  EXPECT_TRUE(database.ContainsCameraIntrinsicsPrior("exif.jpg"));
+  EXPECT_FALSE(database.ContainsCameraIntrinsicsPrior("missing.jpg"));
+}
+
+}  // namespace theia
@@ -34,7 +34,10 @@
 
 #include "theia/sfm/select_good_tracks_for_bundle_adjustment.h"
 
+#include <glog/logging.h>
+
 #include <algorithm>
+#include <memory>
 #include <unordered_map>
 #include <unordered_set>
 #include <utility>
@@ -46,11 +49,13 @@
 #include "theia/sfm/track.h"
 #include "theia/sfm/types.h"
 #include "theia/sfm/view.h"
+#include "theia/util/executor.h"
 #include "theia/util/hash.h"
 #include "theia/util/map_util.h"
 
 namespace theia {
 namespace {
+
 // Track statistics are the track length and mean reprojection error.
 typedef std::pair<int, double> TrackStatistics;
 typedef std::pair<TrackId, TrackStatistics> GridCellElement;
@@ -113,47 +118,56 @@ TrackStatistics ComputeStatisticsForTrack(
 // tracks are also more likely to contain outliers in our experience. Truncating
 // the track lengths enforces that the long tracks with the lowest reprojection
 // error are chosen.
+//
+// The tracks that are not yet in the map are gathered first and their
+// statistics are then computed in parallel, which only writes the values of the
+// map.
 void ComputeTrackStatistics(
     const Reconstruction& reconstruction,
-    const std::unordered_set<ViewId>& view_ids,
+    const std::vector<ViewId>& view_ids,
     const int long_track_length_threshold,
+    const int num_threads,
     std::unordered_map<TrackId, TrackStatistics>* track_statistics) {
-  // Iterate over all views and compute the track statistics for each track we
-  // encounter.
+  std::vector<std::pair<const TrackId, TrackStatistics>*> new_statistics;
   for (const ViewId view_id : view_ids) {
     const View* view = reconstruction.View(view_id);
     const auto& tracks_in_view = view->TrackIds();
-    // Compute statistics for each track in this view that we have not already
-    // computed statistics for.
     for (const TrackId track_id : tracks_in_view) {
       const Track* track = reconstruction.Track(track_id);
-      // Skip this track if the statistics were already computed, or if the
-      // track has not been estimated.
-      if (ContainsKey(*track_statistics, track_id) || track == nullptr ||
-          !track->IsEstimated()) {
+      // Skip this track if it has not been estimated.
+      if (track == nullptr || !track->IsEstimated()) {
         continue;
       }
-
-      // Compute the track statistics and add it to the output map.
-      const TrackStatistics& statistics_for_this_track =
-          ComputeStatisticsForTrack(
-              reconstruction, track_id, long_track_length_threshold);
-      track_statistics->emplace(track_id, statistics_for_this_track);
+      const auto it = track_statistics->emplace(track_id, TrackStatistics());
+      if (it.second) {
+        new_statistics.emplace_back(&(*it.first));
+      }
     }
   }
+
+  ParallelFor(num_threads,
+              new_statistics.size(),
+              [&](const int start, const int end) {
+                for (int i = start; i < end; i++) {
+                  new_statistics[i]->second = ComputeStatisticsForTrack(
+                      reconstruction,
+                      new_statistics[i]->first,
+                      long_track_length_threshold);
+                }
+              });
 }
 
 // Select tracks from the image to ensure good spatial coverage of the image. To
 // do this, we first bin the tracks into grid cells in an image grid. Then
 // within each cell we find the best ranked track and add it to the list of
-// tracks to optimize.
+// tracks chosen from the image grid.
 void SelectBestTracksFromEachImageGridCell(
     const Reconstruction& reconstruction,
     const View& view,
     const int grid_cell_size,
     const std::unordered_map<TrackId, TrackStatistics>& track_statistics,
-    std::unordered_set<TrackId>* tracks_to_optimize) {
-  static const double inv_grid_cell_size = 1.0 / grid_cell_size;
+    std::vector<TrackId>* tracks_in_image_grid) {
+  const double inv_grid_cell_size = 1.0 / grid_cell_size;
 
   // Hash each feature into a grid cell.
   ImageGrid image_grid;
@@ -173,8 +187,8 @@ void SelectBestTracksFromEachImageGridCell(
     image_grid[grid_cell].emplace_back(track_id, current_track_statistics);
   }
 
-  // Select the best feature from each grid cell and add it to the tracks to
-  // optimize.
+  // Select the best feature from each grid cell.
+  tracks_in_image_grid->reserve(image_grid.size());
   for (auto& grid_cell : image_grid) {
     // Order the features in each cell by track length first, then mean
     // reprojection error.
@@ -182,10 +196,31 @@ void SelectBestTracksFromEachImageGridCell(
         *std::min_element(grid_cell.second.begin(),
                           grid_cell.second.end(),
                           CompareGridCellElements);
+    tracks_in_image_grid->emplace_back(grid_cell_element.first);
+  }
+}
 
-    // Insert the track id in to the tracks to optimize.
-    tracks_to_optimize->emplace(grid_cell_element.first);
+// Returns true if the view observes fewer than the minimum number of optimized
+// tracks while some of its estimated tracks are not optimized.
+bool NeedsMoreOptimizedTracks(
+    const Reconstruction& reconstruction,
+    const View& view,
+    const int min_num_optimized_tracks_per_view,
+    const std::unordered_set<TrackId>& tracks_to_optimize) {
+  int num_optimized_tracks = 0;
+  int num_estimated_tracks = 0;
+  for (const TrackId track_id : view.TrackIds()) {
+    const Track* track = reconstruction.Track(track_id);
+    if (track == nullptr || !track->IsEstimated()) {
+      continue;
+    }
+    ++num_estimated_tracks;
+    if (ContainsKey(tracks_to_optimize, track_id) &&
+        ++num_optimized_tracks >= min_num_optimized_tracks_per_view) {
+      return false;
+    }
   }
+  return num_optimized_tracks != num_estimated_tracks;
 }
 
 // Selects the top ranked tracks that have not already been chosen until the
@@ -239,7 +274,8 @@ void SelectTopRankedTracksInView(
     std::partial_sort(
         ranked_candidate_tracks.begin(),
         ranked_candidate_tracks.begin() + num_optimized_tracks_needed,
-        ranked_candidate_tracks.end());
+        ranked_candidate_tracks.end(),
+        CompareGridCellElements);
     // Add the candidate tracks to the list of tracks to be optimized.
     for (int i = 0; i < num_optimized_tracks_needed; i++) {
       tracks_to_optimize->emplace(ranked_candidate_tracks[i].first);
@@ -247,6 +283,139 @@ void SelectTopRankedTracksInView(
   }
 }
 
+// Selects the tracks to optimize from the views. The tracks chosen from the
+// image grid of a view are reused from the cache (if one is given) unless the
+// view is in changed_view_ids.
+bool SelectGoodTracks(const Reconstruction& reconstruction,
+                      const std::unordered_set<ViewId>& view_ids,
+                      const std::unordered_set<ViewId>& changed_view_ids,
+                      const int long_track_length_threshold,
+                      const int image_grid_cell_size_pixels,
+                      const int min_num_optimized_tracks_per_view,
+                      const int num_threads,
+                      TrackSelectionCache* cache,
+                      std::unordered_set<TrackId>* tracks_to_optimize) {
+  CHECK_GT(num_threads, 0);
+  // The views are visited in the iteration order of the set so that views are
+  // given additional tracks in the same order for any number of threads.
+  const std::vector<ViewId> ordered_view_ids(view_ids.begin(), view_ids.end());
+
+  // Determine which views reuse the tracks chosen from their image grid.
+  if (cache != nullptr &&
+      (cache->long_track_length_threshold != long_track_length_threshold ||
+       cache->image_grid_cell_size_pixels != image_grid_cell_size_pixels)) {
+    cache->Clear();
+    cache->long_track_length_threshold = long_track_length_threshold;
+    cache->image_grid_cell_size_pixels = image_grid_cell_size_pixels;
+  }
+  std::vector<ViewId> views_to_grid;
+  std::vector<ViewId> cached_views;
+  for (const ViewId view_id : ordered_view_ids) {
+    if (cache != nullptr && !ContainsKey(changed_view_ids, view_id) &&
+        ContainsKey(cache->tracks_in_image_grid, view_id)) {
+      cached_views.emplace_back(view_id);
+    } else {
+      views_to_grid.emplace_back(view_id);
+    }
+  }
+
+  // Compute the track mean reprojection errors.
+  std::unordered_map<TrackId, TrackStatistics> track_statistics;
+  ComputeTrackStatistics(reconstruction,
+                         views_to_grid,
+                         long_track_length_threshold,
+                         num_threads,
+                         &track_statistics);
+
+  // For each image, divide the image into a grid and choose the highest quality
+  // tracks from each grid cell. This encourages good spatial coverage of tracks
+  // within each image.
+  std::vector<std::vector<TrackId> > tracks_in_image_grid(views_to_grid.size());
+  ParallelFor(num_threads,
+              views_to_grid.size(),
+              [&](const int start, const int end) {
+                for (int i = start; i < end; i++) {
+                  SelectBestTracksFromEachImageGridCell(
+                      reconstruction,
+                      *reconstruction.View(views_to_grid[i]),
+                      image_grid_cell_size_pixels,
+                      track_statistics,
+                      &tracks_in_image_grid[i]);
+                }
+              });
+  for (const std::vector<TrackId>& tracks : tracks_in_image_grid) {
+    tracks_to_optimize->insert(tracks.begin(), tracks.end());
+  }
+  for (const ViewId view_id : cached_views) {
+    for (const TrackId track_id :
+         FindOrDie(cache->tracks_in_image_grid, view_id)) {
+      const Track* track = reconstruction.Track(track_id);
+      if (track != nullptr && track->IsEstimated()) {
+        tracks_to_optimize->emplace(track_id);
+      }
+    }
+  }
+
+  // Update the cache with the new image grid selections and forget the views
+  // that are no longer selected from.
+  if (cache != nullptr) {
+    for (int i = 0; i < views_to_grid.size(); i++) {
+      cache->tracks_in_image_grid[views_to_grid[i]].swap(
+          tracks_in_image_grid[i]);
+    }
+    for (auto it = cache->tracks_in_image_grid.begin();
+         it != cache->tracks_in_image_grid.end();) {
+      if (ContainsKey(view_ids, it->first)) {
+        ++it;
+      } else {
+        it = cache->tracks_in_image_grid.erase(it);
+      }
+    }
+  }
+
+  // To this point, we have only added features that have as full spatial
+  // coverage as possible within each image but we have not ensured that each
+  // image is constrainted by at least K features. Adding tracks for one view
+  // can only satisfy other views, so the views that are not constrained enough
+  // are found in parallel and are then given the top M tracks that have not
+  // already been added in order.
+  std::vector<char> needs_more_tracks(ordered_view_ids.size(), false);
+  ParallelFor(num_threads,
+              ordered_view_ids.size(),
+              [&](const int start, const int end) {
+                for (int i = start; i < end; i++) {
+                  needs_more_tracks[i] = NeedsMoreOptimizedTracks(
+                      reconstruction,
+                      *reconstruction.View(ordered_view_ids[i]),
+                      min_num_optimized_tracks_per_view,
+                      *tracks_to_optimize);
+                }
+              });
+
+  for (int i = 0; i < ordered_view_ids.size(); i++) {
+    if (!needs_more_tracks[i]) {
+      continue;
+    }
+
+    // The statistics of the tracks of cached views may not be computed yet.
+    ComputeTrackStatistics(reconstruction,
+                           {ordered_view_ids[i]},
+                           long_track_length_threshold,
+                           1,
+                           &track_statistics);
+
+    // If this view is not constrained by enough optimized tracks, add the top
+    // ranked features until there are enough tracks constraining the view.
+    SelectTopRankedTracksInView(reconstruction,
+                                track_statistics,
+                                *reconstruction.View(ordered_view_ids[i]),
+                                min_num_optimized_tracks_per_view,
+                                tracks_to_optimize);
+  }
+
+  return true;
+}
+
 }  // namespace
 
 // The efficiency of large scale bundle adjustment can be dramatically increased
@@ -266,6 +435,37 @@ bool SelectGoodTracksForBundleAdjustment(
     const int image_grid_cell_size_pixels,
     const int min_num_optimized_tracks_per_view,
     std::unordered_set<TrackId>* tracks_to_optimize) {
+  return SelectGoodTracksForBundleAdjustment(reconstruction,
+                                             long_track_length_threshold,
+                                             image_grid_cell_size_pixels,
+                                             min_num_optimized_tracks_per_view,
+                                             1,
+                                             tracks_to_optimize);
+}
+
+bool SelectGoodTracksForBundleAdjustment(
+    const Reconstruction& reconstruction,
+    const std::unordered_set<ViewId>& view_ids,
+    const int long_track_length_threshold,
+    const int image_grid_cell_size_pixels,
+    const int min_num_optimized_tracks_per_view,
+    std::unordered_set<TrackId>* tracks_to_optimize) {
+  return SelectGoodTracksForBundleAdjustment(reconstruction,
+                                             view_ids,
+                                             long_track_length_threshold,
+                                             image_grid_cell_size_pixels,
+                                             min_num_optimized_tracks_per_view,
+                                             1,
+                                             tracks_to_optimize);
+}
+
+bool SelectGoodTracksForBundleAdjustment(
+    const Reconstruction& reconstruction,
+    const int long_track_length_threshold,
+    const int image_grid_cell_size_pixels,
+    const int min_num_optimized_tracks_per_view,
+    const int num_threads,
+    std::unordered_set<TrackId>* tracks_to_optimize) {
   std::unordered_set<ViewId> view_ids;
   GetEstimatedViewsFromReconstruction(reconstruction, &view_ids);
   return SelectGoodTracksForBundleAdjustment(reconstruction,
@@ -273,6 +473,7 @@ bool SelectGoodTracksForBundleAdjustment(
                                              long_track_length_threshold,
                                              image_grid_cell_size_pixels,
                                              min_num_optimized_tracks_per_view,
+                                             num_threads,
                                              tracks_to_optimize);
 }
 
@@ -282,44 +483,39 @@ bool SelectGoodTracksForBundleAdjustment(
     const int long_track_length_threshold,
     const int image_grid_cell_size_pixels,
     const int min_num_optimized_tracks_per_view,
+    const int num_threads,
     std::unordered_set<TrackId>* tracks_to_optimize) {
-  // Compute the track mean reprojection errors.
-  std::unordered_map<TrackId, TrackStatistics> track_statistics;
-  ComputeTrackStatistics(
-      reconstruction, view_ids, long_track_length_threshold, &track_statistics);
-
-  // For each image, divide the image into a grid and choose the highest quality
-  // tracks from each grid cell. This encourages good spatial coverage of tracks
-  // within each image.
-  for (const ViewId view_id : view_ids) {
-    const View* view = reconstruction.View(view_id);
-
-    // Select the best tracks from each grid cell in the image and add them to
-    // the container of tracks to be optimized.
-    SelectBestTracksFromEachImageGridCell(reconstruction,
-                                          *view,
-                                          image_grid_cell_size_pixels,
-                                          track_statistics,
-                                          tracks_to_optimize);
-  }
-
-  // To this point, we have only added features that have as full spatial
-  // coverage as possible within each image but we have not ensured that each
-  // image is constrainted by at least K features. So, we cycle through all
-  // views again and add the top M tracks that have not already been added.
-  for (const ViewId view_id : view_ids) {
-    const View* view = reconstruction.View(view_id);
-
-    // If this view is not constrained by enough optimized tracks, add the top
-    // ranked features until there are enough tracks constraining the view.
-    SelectTopRankedTracksInView(reconstruction,
-                                track_statistics,
-                                *view,
-                                min_num_optimized_tracks_per_view,
-                                tracks_to_optimize);
-  }
+  return SelectGoodTracks(reconstruction,
+                          view_ids,
+                          std::unordered_set<ViewId>(),
+                          long_track_length_threshold,
+                          image_grid_cell_size_pixels,
+                          min_num_optimized_tracks_per_view,
+                          num_threads,
+                          nullptr,
+                          tracks_to_optimize);
+}
 
-  return true;
+bool SelectGoodTracksForBundleAdjustment(
+    const Reconstruction& reconstruction,
+    const std::unordered_set<ViewId>& view_ids,
+    const std::unordered_set<ViewId>& changed_view_ids,
+    const int long_track_length_threshold,
+    const int image_grid_cell_size_pixels,
+    const int min_num_optimized_tracks_per_view,
+    const int num_threads,
+    TrackSelectionCache* cache,
+    std::unordered_set<TrackId>* tracks_to_optimize) {
+  CHECK_NOTNULL(cache);
+  return SelectGoodTracks(reconstruction,
+                          view_ids,
+                          changed_view_ids,
+                          long_track_length_threshold,
+                          image_grid_cell_size_pixels,
+                          min_num_optimized_tracks_per_view,
+                          num_threads,
+                          cache,
+                          tracks_to_optimize);
 }
 
 }  // namespace theia
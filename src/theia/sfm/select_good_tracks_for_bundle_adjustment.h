@@ -35,7 +35,9 @@
 #ifndef THEIA_SFM_SELECT_GOOD_TRACKS_FOR_BUNDLE_ADJUSTMENT_H_
 #define THEIA_SFM_SELECT_GOOD_TRACKS_FOR_BUNDLE_ADJUSTMENT_H_
 
+#include <unordered_map>
 #include <unordered_set>
+#include <vector>
 
 #include "theia/sfm/types.h"
 
@@ -81,6 +83,55 @@ bool SelectGoodTracksForBundleAdjustment(
     const int min_num_optimized_tracks_per_view,
     std::unordered_set<TrackId>* tracks_to_optimize);
 
+// Same as above, but the track statistics and the image grid of each view are
+// computed in parallel with num_threads threads. The selected tracks are the
+// same as with a single thread.
+bool SelectGoodTracksForBundleAdjustment(
+    const Reconstruction& reconstruction,
+    const int long_track_length_threshold,
+    const int image_grid_cell_size_pixels,
+    const int min_num_optimized_tracks_per_view,
+    const int num_threads,
+    std::unordered_set<TrackId>* tracks_to_optimize);
+
+bool SelectGoodTracksForBundleAdjustment(
+    const Reconstruction& reconstruction,
+    const std::unordered_set<ViewId>& view_ids,
+    const int long_track_length_threshold,
+    const int image_grid_cell_size_pixels,
+    const int min_num_optimized_tracks_per_view,
+    const int num_threads,
+    std::unordered_set<TrackId>* tracks_to_optimize);
+
+// The tracks chosen from the image grid of each view by the last selection and
+// the parameters they were chosen with. This allows the selection to be
+// updated when only some of the views have changed.
+struct TrackSelectionCache {
+  int long_track_length_threshold = 0;
+  int image_grid_cell_size_pixels = 0;
+  std::unordered_map<ViewId, std::vector<TrackId> > tracks_in_image_grid;
+
+  void Clear() { tracks_in_image_grid.clear(); }
+};
+
+// Same as above, but the tracks chosen from the image grid of the views that
+// are in the cache and not in changed_view_ids are reused instead of being
+// recomputed, which avoids computing the statistics of their tracks. Cached
+// tracks that are no longer estimated are skipped, but tracks that were
+// estimated since the views were cached are only chosen through other views or
+// to give a view the minimum number of optimized tracks. The cache is updated
+// with the views in view_ids and is reset if the parameters changed.
+bool SelectGoodTracksForBundleAdjustment(
+    const Reconstruction& reconstruction,
+    const std::unordered_set<ViewId>& view_ids,
+    const std::unordered_set<ViewId>& changed_view_ids,
+    const int long_track_length_threshold,
+    const int image_grid_cell_size_pixels,
+    const int min_num_optimized_tracks_per_view,
+    const int num_threads,
+    TrackSelectionCache* cache,
+    std::unordered_set<TrackId>* tracks_to_optimize);
+
 }  // namespace theia
 
 #endif  // THEIA_SFM_SELECT_GOOD_TRACKS_FOR_BUNDLE_ADJUSTMENT_H_
@@ -0,0 +1,285 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#include <Eigen/Core>
+#include <algorithm>
+#include <string>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "theia/sfm/camera/camera.h"
+#include "theia/sfm/feature.h"
+#include "theia/sfm/reconstruction.h"
+#include "theia/sfm/select_good_tracks_for_bundle_adjustment.h"
+#include "theia/sfm/track.h"
+#include "theia/sfm/types.h"
+#include "theia/sfm/view.h"
+#include "theia/util/random.h"
+
+namespace theia {
+
+namespace {
+
+static const int kImageWidth = 640;
+static const int kImageHeight = 480;
+static const int kLongTrackLengthThreshold = 4;
+static const int kImageGridCellSizePixels = 100;
+static const int kMinNumOptimizedTracksPerView = 30;
+
+// Builds a reconstruction of estimated views where every track is observed by a
+// random subset of the views at noisy pixels. Most tracks are estimated.
+void BuildReconstruction(const int num_views,
+                         const int num_tracks,
+                         RandomNumberGenerator* rng,
+                         Reconstruction* reconstruction) {
+  for (int i = 0; i < num_views; i++) {
+    const ViewId view_id = reconstruction->AddView(std::to_string(i), i);
+    View* view = reconstruction->MutableView(view_id);
+    view->MutableCamera()->SetImageSize(kImageWidth, kImageHeight);
+    view->MutableCamera()->SetFocalLength(500.0);
+    view->MutableCamera()->SetPrincipalPoint(kImageWidth / 2.0,
+                                             kImageHeight / 2.0);
+    view->MutableCamera()->SetPosition(
+        Eigen::Vector3d(rng->RandDouble(-1.0, 1.0), 0.0, 0.0));
+    view->SetEstimated(true);
+  }
+
+  for (int i = 0; i < num_tracks; i++) {
+    const Eigen::Vector4d point(rng->RandDouble(-2.0, 2.0),
+                                rng->RandDouble(-2.0, 2.0),
+                                rng->RandDouble(4.0, 8.0),
+                                1.0);
+    std::vector<std::pair<ViewId, Feature> > observations;
+    for (ViewId view_id = 0; view_id < num_views; view_id++) {
+      if (rng->RandDouble(0.0, 1.0) > 0.4) {
+        continue;
+      }
+      Eigen::Vector2d pixel;
+      reconstruction->View(view_id)->Camera().ProjectPoint(point, &pixel);
+      pixel += Eigen::Vector2d(rng->RandGaussian(0.0, 1.0),
+                               rng->RandGaussian(0.0, 1.0));
+      observations.emplace_back(view_id, Feature(pixel));
+    }
+    if (observations.size() < 2) {
+      continue;
+    }
+    const TrackId track_id = reconstruction->AddTrack(observations);
+    Track* track = reconstruction->MutableTrack(track_id);
+    *track->MutablePoint() = point;
+    track->SetEstimated(rng->RandDouble(0.0, 1.0) < 0.9);
+  }
+}
+
+// Each view must observe the minimum number of optimized tracks, or all of its
+// estimated tracks if it has fewer than that.
+void VerifyEachViewIsConstrained(
+    const Reconstruction& reconstruction,
+    const std::unordered_set<TrackId>& tracks_to_optimize) {
+  for (const ViewId view_id : reconstruction.ViewIds()) {
+    int num_estimated_tracks = 0;
+    int num_optimized_tracks = 0;
+    for (const TrackId track_id : reconstruction.View(view_id)->TrackIds()) {
+      if (!reconstruction.Track(track_id)->IsEstimated()) {
+        EXPECT_EQ(tracks_to_optimize.count(track_id), 0);
+        continue;
+      }
+      ++num_estimated_tracks;
+      num_optimized_tracks += tracks_to_optimize.count(track_id);
+    }
+    EXPECT_GE(num_optimized_tracks,
+              std::min(num_estimated_tracks, kMinNumOptimizedTracksPerView));
+  }
+}
+
+}  // namespace
+
+TEST(SelectGoodTracksForBundleAdjustment, EachViewIsConstrained) {
+  RandomNumberGenerator rng(52);
+  Reconstruction reconstruction;
+  BuildReconstruction(20, 2000, &rng, &reconstruction);
+
+  std::unordered_set<TrackId> tracks_to_optimize;
+  EXPECT_TRUE(SelectGoodTracksForBundleAdjustment(reconstruction,
+                                                  kLongTrackLengthThreshold,
+                                                  kImageGridCellSizePixels,
+                                                  kMinNumOptimizedTracksPerView,
+                                                  &tracks_to_optimize));
+  EXPECT_LT(tracks_to_optimize.size(), reconstruction.NumTracks());
+  VerifyEachViewIsConstrained(reconstruction, tracks_to_optimize);
+}
+
+TEST(SelectGoodTracksForBundleAdjustment, MultithreadedMatchesSingleThreaded) {
+  RandomNumberGenerator rng(52);
+  Reconstruction reconstruction;
+  BuildReconstruction(30, 3000, &rng, &reconstruction);
+
+  std::unordered_set<TrackId> single_threaded_tracks;
+  EXPECT_TRUE(SelectGoodTracksForBundleAdjustment(reconstruction,
+                                                  kLongTrackLengthThreshold,
+                                                  kImageGridCellSizePixels,
+                                                  kMinNumOptimizedTracksPerView,
+                                                  1,
+                                                  &single_threaded_tracks));
+  for (const int num_threads : {2, 4, 8}) {
+    std::unordered_set<TrackId> multithreaded_tracks;
+    EXPECT_TRUE(
+        SelectGoodTracksForBundleAdjustment(reconstruction,
+                                            kLongTrackLengthThreshold,
+                                            kImageGridCellSizePixels,
+                                            kMinNumOptimizedTracksPerView,
+                                            num_threads,
+                                            &multithreaded_tracks));
+    EXPECT_EQ(multithreaded_tracks, single_threaded_tracks);
+  }
+}
+
+TEST(SelectGoodTracksForBundleAdjustment, CachedSelectionMatchesFullSelection) {
+  RandomNumberGenerator rng(52);
+  Reconstruction reconstruction;
+  BuildReconstruction(20, 2000, &rng, &reconstruction);
+  const std::vector<ViewId> all_view_ids = reconstruction.ViewIds();
+  const std::unordered_set<ViewId> view_ids(all_view_ids.begin(),
+                                            all_view_ids.end());
+
+  std::unordered_set<TrackId> expected_tracks;
+  EXPECT_TRUE(SelectGoodTracksForBundleAdjustment(reconstruction,
+                                                  view_ids,
+                                                  kLongTrackLengthThreshold,
+                                                  kImageGridCellSizePixels,
+                                                  kMinNumOptimizedTracksPerView,
+                                                  4,
+                                                  &expected_tracks));
+
+  // The first selection fills the cache and the second one reuses it for all
+  // views. Both must match the selection without a cache.
+  TrackSelectionCache cache;
+  for (int i = 0; i < 2; i++) {
+    std::unordered_set<TrackId> tracks_to_optimize;
+    EXPECT_TRUE(SelectGoodTracksForBundleAdjustment(
+        reconstruction,
+        view_ids,
+        std::unordered_set<ViewId>(),
+        kLongTrackLengthThreshold,
+        kImageGridCellSizePixels,
+        kMinNumOptimizedTracksPerView,
+        4,
+        &cache,
+        &tracks_to_optimize));
+    EXPECT_EQ(tracks_to_optimize, expected_tracks);
+    EXPECT_EQ(cache.tracks_in_image_grid.size(), view_ids.size());
+  }
+
+  // Only the views that are still selected from are kept in the cache.
+  std::unordered_set<ViewId> subset_of_view_ids = {0, 1, 2};
+  std::unordered_set<TrackId> tracks_to_optimize;
+  EXPECT_TRUE(SelectGoodTracksForBundleAdjustment(reconstruction,
+                                                  subset_of_view_ids,
+                                                  std::unordered_set<ViewId>(),
+                                                  kLongTrackLengthThreshold,
+                                                  kImageGridCellSizePixels,
+                                                  kMinNumOptimizedTracksPerView,
+                                                  4,
+                                                  &cache,
+                                                  &tracks_to_optimize));
+  EXPECT_EQ(cache.tracks_in_image_grid.size(), subset_of_view_ids.size());
+}
+
+TEST(SelectGoodTracksForBundleAdjustment, CacheIsUpdatedForChangedViews) {
+  RandomNumberGenerator rng(52);
+  Reconstruction reconstruction;
+  BuildReconstruction(20, 2000, &rng, &reconstruction);
+  const std::vector<ViewId> all_view_ids = reconstruction.ViewIds();
+  const std::unordered_set<ViewId> view_ids(all_view_ids.begin(),
+                                            all_view_ids.end());
+
+  TrackSelectionCache cache;
+  std::unordered_set<TrackId> tracks_to_optimize;
+  EXPECT_TRUE(SelectGoodTracksForBundleAdjustment(reconstruction,
+                                                  view_ids,
+                                                  std::unordered_set<ViewId>(),
+                                                  kLongTrackLengthThreshold,
+                                                  kImageGridCellSizePixels,
+                                                  kMinNumOptimizedTracksPerView,
+                                                  1,
+                                                  &cache,
+                                                  &tracks_to_optimize));
+
+  // Unestimate all tracks of one view. Its cached selection is then stale, so
+  // it is passed as changed, and the result must match a full selection.
+  const ViewId changed_view_id = 3;
+  for (const TrackId track_id :
+       reconstruction.View(changed_view_id)->TrackIds()) {
+    reconstruction.MutableTrack(track_id)->SetEstimated(false);
+  }
+  tracks_to_optimize.clear();
+  EXPECT_TRUE(SelectGoodTracksForBundleAdjustment(reconstruction,
+                                                  view_ids,
+                                                  {changed_view_id},
+                                                  kLongTrackLengthThreshold,
+                                                  kImageGridCellSizePixels,
+                                                  kMinNumOptimizedTracksPerView,
+                                                  1,
+                                                  &cache,
+                                                  &tracks_to_optimize));
+  EXPECT_TRUE(cache.tracks_in_image_grid.at(changed_view_id).empty());
+  VerifyEachViewIsConstrained(reconstruction, tracks_to_optimize);
+
+  // Changing the parameters resets the cache, so the result matches the
+  // selection without a cache.
+  std::unordered_set<TrackId> expected_tracks;
+  EXPECT_TRUE(SelectGoodTracksForBundleAdjustment(reconstruction,
+                                                  view_ids,
+                                                  kLongTrackLengthThreshold,
+                                                  2 * kImageGridCellSizePixels,
+                                                  kMinNumOptimizedTracksPerView,
+                                                  1,
+                                                  &expected_tracks));
+  tracks_to_optimize.clear();
+  EXPECT_TRUE(SelectGoodTracksForBundleAdjustment(reconstruction,
+                                                  view_ids,
+                                                  std::unordered_set<ViewId>(),
+                                                  kLongTrackLengthThreshold,
+                                                  2 * kImageGridCellSizePixels,
+                                                  kMinNumOptimizedTracksPerView,
+                                                  1,
+                                                  &cache,
+                                                  &tracks_to_optimize));
+  EXPECT_EQ(tracks_to_optimize, expected_tracks);
+  EXPECT_EQ(cache.image_grid_cell_size_pixels, 2 * kImageGridCellSizePixels);
+}
+
+}  // namespace theia
@@ -0,0 +1,116 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+
+#include "theia/sfm/select_track_observations_for_bundle_adjustment.h"
+
+#include <Eigen/Core>
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <iterator>
+#include <limits>
+#include <vector>
+
+#include "theia/sfm/reconstruction.h"
+#include "theia/sfm/track.h"
+#include "theia/sfm/types.h"
+#include "theia/sfm/view.h"
+
+namespace theia {
+
+std::vector<ViewId> SelectWellSpreadTrackObservations(
+    const Reconstruction& reconstruction,
+    const TrackId track_id,
+    const int max_num_observations) {
+  CHECK_GT(max_num_observations, 0);
+  const Track* track = CHECK_NOTNULL(reconstruction.Track(track_id));
+
+  // Sort the views so that ties are broken the same way on every run.
+  std::vector<ViewId> view_ids;
+  view_ids.reserve(track->NumViews());
+  for (const ViewId view_id : track->ViewIds()) {
+    const View* view = reconstruction.View(view_id);
+    if (view != nullptr && view->IsEstimated()) {
+      view_ids.emplace_back(view_id);
+    }
+  }
+  std::sort(view_ids.begin(), view_ids.end());
+  if (view_ids.size() <= max_num_observations) {
+    return view_ids;
+  }
+
+  std::vector<Eigen::Vector3d> positions(view_ids.size());
+  Eigen::Vector3d centroid = Eigen::Vector3d::Zero();
+  for (int i = 0; i < view_ids.size(); i++) {
+    positions[i] = reconstruction.View(view_ids[i])->Camera().GetPosition();
+    centroid += positions[i];
+  }
+  centroid /= view_ids.size();
+
+  // Farthest point sampling of the camera centers, starting with the view
+  // farthest from the centroid. The squared distance of each view to the
+  // closest selected view is updated as views are selected.
+  std::vector<double> distances(view_ids.size());
+  for (int i = 0; i < view_ids.size(); i++) {
+    distances[i] = (positions[i] - centroid).squaredNorm();
+  }
+  int farthest = std::distance(
+      distances.begin(), std::max_element(distances.begin(), distances.end()));
+  std::fill(distances.begin(), distances.end(),
+            std::numeric_limits<double>::max());
+
+  std::vector<ViewId> selected_view_ids;
+  selected_view_ids.reserve(max_num_observations);
+  while (true) {
+    selected_view_ids.emplace_back(view_ids[farthest]);
+    if (selected_view_ids.size() == max_num_observations) {
+      break;
+    }
+    for (int i = 0; i < view_ids.size(); i++) {
+      distances[i] = std::min(
+          distances[i], (positions[i] - positions[farthest]).squaredNorm());
+    }
+    // Selected views have a distance of zero. Mark them so that views at the
+    // same position as a selected view are still chosen before them.
+    distances[farthest] = -1.0;
+    farthest = std::distance(
+        distances.begin(),
+        std::max_element(distances.begin(), distances.end()));
+  }
+  std::sort(selected_view_ids.begin(), selected_view_ids.end());
+  return selected_view_ids;
+}
+
+}  // namespace theia
@@ -0,0 +1,65 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+
+#ifndef THEIA_SFM_SELECT_TRACK_OBSERVATIONS_FOR_BUNDLE_ADJUSTMENT_H_
+#define THEIA_SFM_SELECT_TRACK_OBSERVATIONS_FOR_BUNDLE_ADJUSTMENT_H_
+
+#include <vector>
+
+#include "theia/sfm/types.h"
+
+namespace theia {
+class Reconstruction;
+
+// Very long tracks (e.g. hundreds of views along a street) add many highly
+// redundant reprojection residuals to bundle adjustment, since neighboring
+// views observe the point from almost the same direction. This selects up to
+// max_num_observations of the estimated views that observe the track such
+// that their camera centers are spread out along the baseline: the first view
+// is the one farthest from the centroid of the camera centers, i.e. an end of
+// the baseline, and each next view is the one farthest from the views that are
+// already selected. The widest baselines, which constrain the point the most,
+// are thus always kept.
+//
+// Returns the selected view ids in increasing order. All estimated views are
+// returned if there are at most max_num_observations of them.
+std::vector<ViewId> SelectWellSpreadTrackObservations(
+    const Reconstruction& reconstruction,
+    const TrackId track_id,
+    const int max_num_observations);
+
+}  // namespace theia
+
+#endif  // THEIA_SFM_SELECT_TRACK_OBSERVATIONS_FOR_BUNDLE_ADJUSTMENT_H_
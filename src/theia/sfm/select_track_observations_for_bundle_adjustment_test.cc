@@ -0,0 +1,127 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+
+#include <Eigen/Core>
+#include <algorithm>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "theia/sfm/camera/camera.h"
+#include "theia/sfm/feature.h"
+#include "theia/sfm/reconstruction.h"
+#include "theia/sfm/select_track_observations_for_bundle_adjustment.h"
+#include "theia/sfm/track.h"
+#include "theia/sfm/types.h"
+#include "theia/sfm/view.h"
+
+namespace theia {
+
+namespace {
+
+// Builds a street-like sequence of estimated views along the x axis with one
+// track that is observed by all of them.
+TrackId BuildStreetReconstruction(const int num_views,
+                                  Reconstruction* reconstruction) {
+  std::vector<std::pair<ViewId, Feature> > observations;
+  for (int i = 0; i < num_views; i++) {
+    const ViewId view_id = reconstruction->AddView(std::to_string(i), i);
+    View* view = reconstruction->MutableView(view_id);
+    view->MutableCamera()->SetPosition(Eigen::Vector3d(i, 0.0, 0.0));
+    view->SetEstimated(true);
+    observations.emplace_back(view_id, Feature(Eigen::Vector2d(0.0, 0.0)));
+  }
+  const TrackId track_id = reconstruction->AddTrack(observations);
+  reconstruction->MutableTrack(track_id)->SetEstimated(true);
+  return track_id;
+}
+
+}  // namespace
+
+TEST(SelectWellSpreadTrackObservations, KeepsEndsOfLongTracks) {
+  static const int kNumViews = 100;
+  static const int kMaxNumObservations = 5;
+  Reconstruction reconstruction;
+  const TrackId track_id =
+      BuildStreetReconstruction(kNumViews, &reconstruction);
+
+  const std::vector<ViewId> view_ids = SelectWellSpreadTrackObservations(
+      reconstruction, track_id, kMaxNumObservations);
+  ASSERT_EQ(view_ids.size(), kMaxNumObservations);
+  EXPECT_TRUE(std::is_sorted(view_ids.begin(), view_ids.end()));
+  EXPECT_EQ(std::adjacent_find(view_ids.begin(), view_ids.end()),
+            view_ids.end());
+
+  // The widest baseline is kept and the remaining views are spread out
+  // roughly evenly between its ends.
+  EXPECT_EQ(view_ids.front(), 0);
+  EXPECT_EQ(view_ids.back(), kNumViews - 1);
+  for (int i = 1; i < view_ids.size(); i++) {
+    EXPECT_GT(view_ids[i] - view_ids[i - 1], kNumViews / 8);
+  }
+}
+
+TEST(SelectWellSpreadTrackObservations, KeepsAllObservationsOfShortTracks) {
+  static const int kNumViews = 4;
+  Reconstruction reconstruction;
+  const TrackId track_id =
+      BuildStreetReconstruction(kNumViews, &reconstruction);
+
+  const std::vector<ViewId> view_ids =
+      SelectWellSpreadTrackObservations(reconstruction, track_id, kNumViews);
+  EXPECT_EQ(view_ids, std::vector<ViewId>({0, 1, 2, 3}));
+}
+
+TEST(SelectWellSpreadTrackObservations, IgnoresUnestimatedViews) {
+  static const int kNumViews = 10;
+  Reconstruction reconstruction;
+  const TrackId track_id =
+      BuildStreetReconstruction(kNumViews, &reconstruction);
+  reconstruction.MutableView(0)->SetEstimated(false);
+  reconstruction.MutableView(kNumViews - 1)->SetEstimated(false);
+
+  const std::vector<ViewId> view_ids =
+      SelectWellSpreadTrackObservations(reconstruction, track_id, 2);
+  EXPECT_EQ(view_ids, std::vector<ViewId>({1, kNumViews - 2}));
+
+  const std::vector<ViewId> all_view_ids =
+      SelectWellSpreadTrackObservations(reconstruction, track_id, kNumViews);
+  EXPECT_EQ(all_view_ids.size(), kNumViews - 2);
+  EXPECT_EQ(std::count(all_view_ids.begin(), all_view_ids.end(), 0), 0);
+}
+
+}  // namespace theia
@@ -36,19 +36,55 @@
 
 #include <Eigen/Core>
 #include <glog/logging.h>
+#include <memory>
+#include <unordered_map>
 #include <unordered_set>
+#include <vector>
 
 #include "theia/sfm/camera/camera.h"
+#include "theia/sfm/feature.h"
 #include "theia/sfm/reconstruction.h"
 #include "theia/sfm/track.h"
 #include "theia/sfm/triangulation/triangulation.h"
 #include "theia/sfm/types.h"
 #include "theia/sfm/view.h"
+#include "theia/util/executor.h"
 
 namespace theia {
 
+namespace {
+
+enum TrackStatus {
+  GOOD_TRACK = 0,
+  BAD_REPROJECTION = 1,
+  INSUFFICIENT_VIEWING_ANGLE = 2
+};
+
+}  // namespace
+
+int SetOutlierTracksToUnestimated(const double max_inlier_reprojection_error,
+                                  const double min_triangulation_angle_degrees,
+                                  Reconstruction* reconstruction) {
+  return SetOutlierTracksToUnestimated(max_inlier_reprojection_error,
+                                       min_triangulation_angle_degrees,
+                                       1,
+                                       reconstruction);
+}
+
+int SetOutlierTracksToUnestimated(const std::unordered_set<TrackId>& track_ids,
+                                  const double max_inlier_reprojection_error,
+                                  const double min_triangulation_angle_degrees,
+                                  Reconstruction* reconstruction) {
+  return SetOutlierTracksToUnestimated(track_ids,
+                                       max_inlier_reprojection_error,
+                                       min_triangulation_angle_degrees,
+                                       1,
+                                       reconstruction);
+}
+
 int SetOutlierTracksToUnestimated(const double max_inlier_reprojection_error,
                                   const double min_triangulation_angle_degrees,
+                                  const int num_threads,
                                   Reconstruction* reconstruction) {
   const auto& track_ids = reconstruction->TrackIds();
   const std::unordered_set<TrackId> all_tracks(track_ids.begin(),
@@ -56,74 +92,165 @@ int SetOutlierTracksToUnestimated(const double max_inlier_reprojection_error,
   return SetOutlierTracksToUnestimated(all_tracks,
                                        max_inlier_reprojection_error,
                                        min_triangulation_angle_degrees,
+                                       num_threads,
                                        reconstruction);
 }
 
 int SetOutlierTracksToUnestimated(const std::unordered_set<TrackId>& track_ids,
                                   const double max_inlier_reprojection_error,
                                   const double min_triangulation_angle_degrees,
+                                  const int num_threads,
                                   Reconstruction* reconstruction) {
+  CHECK_NOTNULL(reconstruction);
+  CHECK_GT(num_threads, 0);
   const double max_sq_reprojection_error =
       max_inlier_reprojection_error * max_inlier_reprojection_error;
 
-  int num_estimated_tracks = 0;
-  int num_bad_reprojections = 0;
-  int num_insufficient_viewing_angles = 0;
-
+  // Gather the estimated tracks and their observations in estimated views.
+  // Each track's observations occupy a contiguous range of slots, and the
+  // slots are also grouped by view so that every view projects all of its
+  // points in a single batch.
+  std::vector<TrackId> estimated_track_ids;
+  std::vector<const Track*> tracks;
+  std::vector<int> track_slot_offsets(1, 0);
+  std::vector<int> slot_view_indices;
+  std::vector<const View*> views;
+  std::unordered_map<ViewId, int> view_indices;
+  std::vector<int> num_view_slots;
+  estimated_track_ids.reserve(track_ids.size());
+  tracks.reserve(track_ids.size());
   for (const TrackId track_id : track_ids) {
-    Track* track = reconstruction->MutableTrack(track_id);
+    const Track* track = reconstruction->Track(track_id);
     if (!track->IsEstimated()) {
       continue;
     }
-    ++num_estimated_tracks;
+    estimated_track_ids.emplace_back(track_id);
+    tracks.emplace_back(track);
 
-    std::vector<Eigen::Vector3d> ray_directions;
-    const auto& view_ids = track->ViewIds();
-    int num_projections = 0;
-    double mean_sq_reprojection_error = 0;
-    for (const ViewId view_id : view_ids) {
+    for (const ViewId view_id : track->ViewIds()) {
       const View* view = CHECK_NOTNULL(reconstruction->View(view_id));
       if (!view->IsEstimated()) {
         continue;
       }
 
-      const Camera& camera = view->Camera();
-      const Eigen::Vector3d ray_direction =
-          track->Point().hnormalized() - camera.GetPosition();
-      ray_directions.push_back(ray_direction.normalized());
-
-      // Check the reprojection error.
-      const Feature* feature = view->GetFeature(track_id);
-      // Reproject the observations.
-      Eigen::Vector2d projection;
-      const double depth = camera.ProjectPoint(track->Point(), &projection);
-      // Remove the feature if the reprojection is behind the camera.
-      if (depth < 0) {
-        ++num_bad_reprojections;
-        track->SetEstimated(false);
-        break;
+      const auto inserted =
+          view_indices.emplace(view_id, static_cast<int>(views.size()));
+      if (inserted.second) {
+        views.emplace_back(view);
+        num_view_slots.emplace_back(0);
       }
-      mean_sq_reprojection_error +=
-          (projection - (*feature).point_).squaredNorm();
-      ++num_projections;
+      const int view_index = inserted.first->second;
+      slot_view_indices.emplace_back(view_index);
+      ++num_view_slots[view_index];
     }
+    track_slot_offsets.emplace_back(
+        static_cast<int>(slot_view_indices.size()));
+  }
+  const int num_tracks = static_cast<int>(tracks.size());
+  const int num_views = static_cast<int>(views.size());
+  const int num_slots = static_cast<int>(slot_view_indices.size());
 
-    mean_sq_reprojection_error /= static_cast<double>(num_projections);
-    if (track->IsEstimated() &&
-        mean_sq_reprojection_error > max_sq_reprojection_error) {
-      ++num_bad_reprojections;
-      track->SetEstimated(false);
+  // Bucket the slots by view.
+  std::vector<int> view_slot_offsets(num_views + 1, 0);
+  for (int i = 0; i < num_views; i++) {
+    view_slot_offsets[i + 1] = view_slot_offsets[i] + num_view_slots[i];
+  }
+  std::vector<int> view_slots(num_slots);
+  std::vector<int> view_slot_tracks(num_slots);
+  std::vector<int> view_slot_fill(view_slot_offsets.begin(),
+                                  view_slot_offsets.end() - 1);
+  for (int i = 0; i < num_tracks; i++) {
+    for (int slot = track_slot_offsets[i]; slot < track_slot_offsets[i + 1];
+         slot++) {
+      const int position = view_slot_fill[slot_view_indices[slot]]++;
+      view_slots[position] = slot;
+      view_slot_tracks[position] = i;
+    }
+  }
+
+  // Project the observations of each view in one batch.
+  std::vector<double> sq_reprojection_errors(num_slots);
+  std::vector<double> depths(num_slots);
+  ParallelFor(num_threads, num_views, [&](const int start, const int end) {
+    Eigen::Matrix4Xd points;
+    Eigen::Matrix2Xd projections;
+    Eigen::VectorXd view_depths;
+    for (int i = start; i < end; i++) {
+      const int offset = view_slot_offsets[i];
+      const int num_points = view_slot_offsets[i + 1] - offset;
+      points.resize(4, num_points);
+      for (int j = 0; j < num_points; j++) {
+        points.col(j) = tracks[view_slot_tracks[offset + j]]->Point();
+      }
+      views[i]->Camera().ProjectPoints(points, &projections, &view_depths);
+
+      for (int j = 0; j < num_points; j++) {
+        const TrackId track_id =
+            estimated_track_ids[view_slot_tracks[offset + j]];
+        const Feature* feature = views[i]->GetFeature(track_id);
+        const int slot = view_slots[offset + j];
+        sq_reprojection_errors[slot] =
+            (projections.col(j) - feature->point_).squaredNorm();
+        depths[slot] = view_depths[j];
+      }
     }
+  });
+
+  // Classify each track from its projections.
+  std::vector<char> track_status(num_tracks, GOOD_TRACK);
+  ParallelFor(num_threads, num_tracks, [&](const int start, const int end) {
+    std::vector<Eigen::Vector3d> ray_directions;
+    for (int i = start; i < end; i++) {
+      const int begin_slot = track_slot_offsets[i];
+      const int end_slot = track_slot_offsets[i + 1];
 
-    // The track will remain estimated if the reprojection errors were all
-    // good. We then test that the track is properly constrained by having at
-    // least two cameras view it with a sufficient viewing angle.
-    if (track->IsEstimated() &&
-        !SufficientTriangulationAngle(ray_directions,
-                                      min_triangulation_angle_degrees)) {
+      // Remove the track if any reprojection is behind the camera.
+      bool behind_camera = false;
+      double mean_sq_reprojection_error = 0;
+      for (int slot = begin_slot; slot < end_slot; slot++) {
+        if (depths[slot] < 0) {
+          behind_camera = true;
+          break;
+        }
+        mean_sq_reprojection_error += sq_reprojection_errors[slot];
+      }
+      mean_sq_reprojection_error /=
+          static_cast<double>(end_slot - begin_slot);
+      if (behind_camera ||
+          mean_sq_reprojection_error > max_sq_reprojection_error) {
+        track_status[i] = BAD_REPROJECTION;
+        continue;
+      }
+
+      // The reprojection errors were all good. We then test that the
+      // track is properly constrained by having at least two cameras view
+      // it with a sufficient viewing angle.
+      const Eigen::Vector3d point = tracks[i]->Point().hnormalized();
+      ray_directions.clear();
+      for (int slot = begin_slot; slot < end_slot; slot++) {
+        const Eigen::Vector3d ray_direction =
+            point - views[slot_view_indices[slot]]->Camera().GetPosition();
+        ray_directions.emplace_back(ray_direction.normalized());
+      }
+      if (!SufficientTriangulationAngle(ray_directions,
+                                        min_triangulation_angle_degrees)) {
+        track_status[i] = INSUFFICIENT_VIEWING_ANGLE;
+      }
+    }
+  });
+
+  int num_bad_reprojections = 0;
+  int num_insufficient_viewing_angles = 0;
+  for (int i = 0; i < num_tracks; i++) {
+    if (track_status[i] == GOOD_TRACK) {
+      continue;
+    }
+    if (track_status[i] == BAD_REPROJECTION) {
+      ++num_bad_reprojections;
+    } else {
       ++num_insufficient_viewing_angles;
-      track->SetEstimated(false);
     }
+    reconstruction->MutableTrack(estimated_track_ids[i])->SetEstimated(false);
   }
 
   LOG_IF(INFO, num_bad_reprojections > 0 || num_insufficient_viewing_angles > 0)
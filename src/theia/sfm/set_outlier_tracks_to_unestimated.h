@@ -54,6 +54,18 @@ int SetOutlierTracksToUnestimated(const double max_inlier_reprojection_error,
                                   const double min_triangulation_angle_degrees,
                                   Reconstruction* reconstruction);
 
+// Same as above, but the observations are projected view by view and the
+// tracks are checked with num_threads threads.
+int SetOutlierTracksToUnestimated(const std::unordered_set<TrackId>& tracks,
+                                  const double max_inlier_reprojection_error,
+                                  const double min_triangulation_angle_degrees,
+                                  const int num_threads,
+                                  Reconstruction* reconstruction);
+int SetOutlierTracksToUnestimated(const double max_inlier_reprojection_error,
+                                  const double min_triangulation_angle_degrees,
+                                  const int num_threads,
+                                  Reconstruction* reconstruction);
+
 }  // namespace theia
 
 #endif  // THEIA_SFM_SET_OUTLIER_TRACKS_TO_UNESTIMATED_H_
@@ -0,0 +1,200 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#include <Eigen/Core>
+#include <string>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "theia/sfm/camera/camera.h"
+#include "theia/sfm/feature.h"
+#include "theia/sfm/reconstruction.h"
+#include "theia/sfm/set_outlier_tracks_to_unestimated.h"
+#include "theia/sfm/track.h"
+#include "theia/sfm/view.h"
+#include "theia/util/random.h"
+#include "theia/util/stringprintf.h"
+
+namespace theia {
+
+namespace {
+
+RandomNumberGenerator rng(59);
+
+static const double kMaxReprojectionError = 2.0;
+static const double kMinTriangulationAngle = 2.0;
+
+// Builds a reconstruction with cameras on a circle looking at the origin.
+// Every fourth track has a noisy observation, every seventh track lies behind
+// the first camera it is observed in and the remaining tracks are clean.
+void BuildReconstruction(const int num_views,
+                         const int num_tracks,
+                         Reconstruction* reconstruction,
+                         std::unordered_set<TrackId>* expected_outliers) {
+  std::vector<ViewId> view_ids;
+  for (int i = 0; i < num_views; i++) {
+    const ViewId view_id =
+        reconstruction->AddView(StringPrintf("%d", i), i);
+    View* view = reconstruction->MutableView(view_id);
+    view->SetEstimated(true);
+    Camera* camera = view->MutableCamera();
+    camera->SetFocalLength(800.0);
+    camera->SetPrincipalPoint(400.0, 300.0);
+
+    const double angle = 0.1 * i;
+    camera->SetPosition(Eigen::Vector3d(10.0 * std::sin(angle),
+                                        0.0,
+                                        -10.0 * std::cos(angle)));
+    camera->SetOrientationFromAngleAxis(Eigen::Vector3d(0.0, -angle, 0.0));
+    view_ids.emplace_back(view_id);
+  }
+
+  for (int i = 0; i < num_tracks; i++) {
+    Eigen::Vector3d point = rng.RandVector3d();
+    if (i % 7 == 0) {
+      // Place the point behind the first camera.
+      point = reconstruction->View(view_ids[0])->Camera().GetPosition() +
+              Eigen::Vector3d(0.0, 0.0, -5.0);
+    }
+
+    std::vector<std::pair<ViewId, Feature> > observations;
+    for (const ViewId view_id : view_ids) {
+      Eigen::Vector2d pixel;
+      reconstruction->View(view_id)->Camera().ProjectPoint(
+          point.homogeneous(), &pixel);
+      if (i % 4 == 1) {
+        pixel += Eigen::Vector2d(50.0, -50.0);
+      }
+      observations.emplace_back(view_id, Feature(pixel));
+    }
+    const TrackId track_id = reconstruction->AddTrack(observations);
+    Track* track = reconstruction->MutableTrack(track_id);
+    track->SetEstimated(true);
+    *track->MutablePoint() = point.homogeneous();
+
+    if (i % 7 == 0 || i % 4 == 1) {
+      expected_outliers->insert(track_id);
+    }
+  }
+}
+
+}  // namespace
+
+TEST(SetOutlierTracksToUnestimated, RemovesOutliers) {
+  Reconstruction reconstruction;
+  std::unordered_set<TrackId> expected_outliers;
+  BuildReconstruction(5, 100, &reconstruction, &expected_outliers);
+
+  EXPECT_EQ(SetOutlierTracksToUnestimated(kMaxReprojectionError,
+                                          kMinTriangulationAngle,
+                                          &reconstruction),
+            expected_outliers.size());
+  for (const TrackId track_id : reconstruction.TrackIds()) {
+    EXPECT_EQ(reconstruction.Track(track_id)->IsEstimated(),
+              expected_outliers.count(track_id) == 0);
+  }
+}
+
+TEST(SetOutlierTracksToUnestimated, InsufficientTriangulationAngle) {
+  Reconstruction reconstruction;
+  std::unordered_set<TrackId> expected_outliers;
+  BuildReconstruction(2, 20, &reconstruction, &expected_outliers);
+
+  // The cameras are only ~5.7 degrees apart, so requiring a larger angle
+  // removes every track.
+  EXPECT_EQ(SetOutlierTracksToUnestimated(kMaxReprojectionError,
+                                          30.0,
+                                          &reconstruction),
+            reconstruction.NumTracks());
+}
+
+TEST(SetOutlierTracksToUnestimated, OnlyChecksInputTracks) {
+  Reconstruction reconstruction;
+  std::unordered_set<TrackId> expected_outliers;
+  BuildReconstruction(5, 100, &reconstruction, &expected_outliers);
+
+  std::unordered_set<TrackId> tracks_to_check;
+  for (const TrackId track_id : reconstruction.TrackIds()) {
+    if (track_id % 2 == 0) {
+      tracks_to_check.insert(track_id);
+    }
+  }
+
+  int num_expected_removed = 0;
+  for (const TrackId track_id : expected_outliers) {
+    num_expected_removed += tracks_to_check.count(track_id);
+  }
+  EXPECT_EQ(SetOutlierTracksToUnestimated(tracks_to_check,
+                                          kMaxReprojectionError,
+                                          kMinTriangulationAngle,
+                                          &reconstruction),
+            num_expected_removed);
+  for (const TrackId track_id : reconstruction.TrackIds()) {
+    EXPECT_EQ(reconstruction.Track(track_id)->IsEstimated(),
+              tracks_to_check.count(track_id) == 0 ||
+                  expected_outliers.count(track_id) == 0);
+  }
+}
+
+TEST(SetOutlierTracksToUnestimated, MultithreadedMatchesSingleThreaded) {
+  Reconstruction reconstruction1;
+  std::unordered_set<TrackId> expected_outliers;
+  BuildReconstruction(20, 2000, &reconstruction1, &expected_outliers);
+  Reconstruction reconstruction2;
+  expected_outliers.clear();
+  rng.Seed(59);
+  BuildReconstruction(20, 2000, &reconstruction2, &expected_outliers);
+
+  // Mark a view as unestimated so that its observations are skipped.
+  reconstruction1.MutableView(reconstruction1.ViewIds()[3])
+      ->SetEstimated(false);
+  reconstruction2.MutableView(reconstruction2.ViewIds()[3])
+      ->SetEstimated(false);
+
+  const int num_removed1 = SetOutlierTracksToUnestimated(
+      kMaxReprojectionError, kMinTriangulationAngle, 1, &reconstruction1);
+  const int num_removed2 = SetOutlierTracksToUnestimated(
+      kMaxReprojectionError, kMinTriangulationAngle, 4, &reconstruction2);
+  EXPECT_EQ(num_removed1, num_removed2);
+  EXPECT_GT(num_removed1, 0);
+  for (const TrackId track_id : reconstruction1.TrackIds()) {
+    EXPECT_EQ(reconstruction1.Track(track_id)->IsEstimated(),
+              reconstruction2.Track(track_id)->IsEstimated());
+  }
+}
+
+}  // namespace theia
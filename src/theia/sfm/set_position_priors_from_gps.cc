@@ -0,0 +1,86 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+
+#include "theia/sfm/set_position_priors_from_gps.h"
+
+#include <Eigen/Core>
+#include <glog/logging.h>
+#include <vector>
+
+#include "theia/sfm/camera_intrinsics_prior.h"
+#include "theia/sfm/gps_converter.h"
+#include "theia/sfm/reconstruction.h"
+#include "theia/sfm/types.h"
+#include "theia/sfm/view.h"
+
+namespace theia {
+
+int SetPositionPriorsFromGPS(
+    const Eigen::Vector3d& reference_lla,
+    const Eigen::Matrix3d& position_prior_sqrt_information,
+    Reconstruction* reconstruction) {
+  CHECK_NOTNULL(reconstruction);
+
+  // Gather the coordinates of all views with GPS priors first so that they are
+  // converted together.
+  std::vector<ViewId> view_ids;
+  std::vector<Eigen::Vector3d> lla;
+  for (const ViewId view_id : reconstruction->ViewIds()) {
+    const CameraIntrinsicsPrior& prior =
+        reconstruction->View(view_id)->CameraIntrinsicsPrior();
+    if (!prior.latitude.is_set || !prior.longitude.is_set) {
+      continue;
+    }
+    view_ids.emplace_back(view_id);
+    lla.emplace_back(prior.latitude.value[0],
+                     prior.longitude.value[0],
+                     prior.altitude.is_set ? prior.altitude.value[0]
+                                           : reference_lla[2]);
+  }
+  if (view_ids.empty()) {
+    return 0;
+  }
+
+  const Eigen::Matrix3Xd enu = GPSConverter::LLAToENU(
+      Eigen::Map<const Eigen::Matrix3Xd>(lla[0].data(), 3, lla.size()),
+      reference_lla);
+  for (int i = 0; i < view_ids.size(); i++) {
+    reconstruction->MutableView(view_ids[i])
+        ->SetPositionPrior(enu.col(i), position_prior_sqrt_information);
+  }
+  return view_ids.size();
+}
+
+}  // namespace theia
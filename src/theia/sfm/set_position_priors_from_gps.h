@@ -0,0 +1,59 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+
+#ifndef THEIA_SFM_SET_POSITION_PRIORS_FROM_GPS_H_
+#define THEIA_SFM_SET_POSITION_PRIORS_FROM_GPS_H_
+
+#include <Eigen/Core>
+
+namespace theia {
+
+class Reconstruction;
+
+// Sets the position prior of every view whose CameraIntrinsicsPrior has a
+// latitude and longitude (e.g. from EXIF or a calibration file) to its position
+// in meters in the local east-north-up frame at reference_lla (see
+// GPSConverter::LLAToENU), with the given square root information. Views
+// without an altitude prior are placed at the altitude of the reference. The
+// coordinates of all views are converted in one batch. Returns the number of
+// views whose position prior was set.
+int SetPositionPriorsFromGPS(
+    const Eigen::Vector3d& reference_lla,
+    const Eigen::Matrix3d& position_prior_sqrt_information,
+    Reconstruction* reconstruction);
+
+}  // namespace theia
+
+#endif  // THEIA_SFM_SET_POSITION_PRIORS_FROM_GPS_H_
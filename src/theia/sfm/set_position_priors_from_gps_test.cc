@@ -0,0 +1,96 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+
+#include <Eigen/Core>
+#include <string>
+
+#include "gtest/gtest.h"
+
+#include "theia/sfm/camera_intrinsics_prior.h"
+#include "theia/sfm/gps_converter.h"
+#include "theia/sfm/reconstruction.h"
+#include "theia/sfm/set_position_priors_from_gps.h"
+#include "theia/sfm/types.h"
+#include "theia/sfm/view.h"
+
+namespace theia {
+
+TEST(SetPositionPriorsFromGPS, SetsLocalPositions) {
+  const Eigen::Vector3d reference_lla(27.173891, 78.042068, 168.0);
+  Reconstruction reconstruction;
+  for (int i = 0; i < 3; i++) {
+    reconstruction.AddView(std::to_string(i), i);
+  }
+
+  // View 0 has a full GPS prior, view 1 has no altitude and view 2 has no GPS
+  // prior.
+  CameraIntrinsicsPrior* prior =
+      reconstruction.MutableView(0)->MutableCameraIntrinsicsPrior();
+  prior->latitude.is_set = true;
+  prior->latitude.value[0] = reference_lla[0] + 0.001;
+  prior->longitude.is_set = true;
+  prior->longitude.value[0] = reference_lla[1];
+  prior->altitude.is_set = true;
+  prior->altitude.value[0] = reference_lla[2] + 10.0;
+  prior = reconstruction.MutableView(1)->MutableCameraIntrinsicsPrior();
+  prior->latitude.is_set = true;
+  prior->latitude.value[0] = reference_lla[0];
+  prior->longitude.is_set = true;
+  prior->longitude.value[0] = reference_lla[1];
+
+  const Eigen::Matrix3d sqrt_information = 2.0 * Eigen::Matrix3d::Identity();
+  EXPECT_EQ(SetPositionPriorsFromGPS(
+                reference_lla, sqrt_information, &reconstruction),
+            2);
+
+  const View* view = reconstruction.View(0);
+  ASSERT_TRUE(view->HasPositionPrior());
+  const Eigen::Vector3d expected_position = GPSConverter::LLAToENU(
+      Eigen::Vector3d(reference_lla[0] + 0.001,
+                      reference_lla[1],
+                      reference_lla[2] + 10.0),
+      reference_lla);
+  EXPECT_NEAR(
+      (view->GetPositionPrior() - expected_position).norm(), 0.0, 1e-9);
+  EXPECT_NEAR(view->GetPositionPriorSqrtInformation()(0, 0), 2.0, 1e-12);
+
+  view = reconstruction.View(1);
+  ASSERT_TRUE(view->HasPositionPrior());
+  EXPECT_NEAR(view->GetPositionPrior().norm(), 0.0, 1e-6);
+
+  EXPECT_FALSE(reconstruction.View(2)->HasPositionPrior());
+}
+
+}  // namespace theia
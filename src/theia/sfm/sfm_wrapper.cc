@@ -24,6 +24,30 @@ std::tuple<bool, TwoViewInfo, std::vector<int>> EstimateTwoViewInfoWrapper(
   return std::make_tuple(success, twoview_info, inlier_indices);
 }
 
+std::tuple<int,
+           std::vector<bool>,
+           std::vector<TwoViewInfo>,
+           std::vector<std::vector<int>>>
+EstimateTwoViewInfosWrapper(
+    const EstimateTwoViewInfoOptions& options,
+    const int num_threads,
+    const std::vector<CameraIntrinsicsPrior>& intrinsics1,
+    const std::vector<CameraIntrinsicsPrior>& intrinsics2,
+    const std::vector<std::vector<FeatureCorrespondence>>& correspondences) {
+  std::vector<bool> success;
+  std::vector<TwoViewInfo> twoview_infos;
+  std::vector<std::vector<int>> inlier_indices;
+  const int num_estimated = EstimateTwoViewInfos(options,
+                                                 num_threads,
+                                                 intrinsics1,
+                                                 intrinsics2,
+                                                 correspondences,
+                                                 &twoview_infos,
+                                                 &inlier_indices,
+                                                 &success);
+  return std::make_tuple(num_estimated, success, twoview_infos, inlier_indices);
+}
+
 std::tuple<bool, std::unordered_set<TrackId>>
 SelectGoodTracksForBundleAdjustmentWrapper(
     const Reconstruction& reconstruction,
@@ -28,6 +28,17 @@ std::tuple<bool, TwoViewInfo, std::vector<int>> EstimateTwoViewInfoWrapper(
     const CameraIntrinsicsPrior& intrinsics1,
     const CameraIntrinsicsPrior& intrinsics2,
     const std::vector<FeatureCorrespondence>& correspondences);
+
+std::tuple<int,
+           std::vector<bool>,
+           std::vector<TwoViewInfo>,
+           std::vector<std::vector<int>>>
+EstimateTwoViewInfosWrapper(
+    const EstimateTwoViewInfoOptions& options,
+    const int num_threads,
+    const std::vector<CameraIntrinsicsPrior>& intrinsics1,
+    const std::vector<CameraIntrinsicsPrior>& intrinsics2,
+    const std::vector<std::vector<FeatureCorrespondence>>& correspondences);
     
 std::tuple<bool, std::unordered_set<TrackId>>
 SelectGoodTracksForBundleAdjustmentWrapper(
@@ -0,0 +1,117 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#include "theia/sfm/sort_tracks_spatially.h"
+
+#include <Eigen/Core>
+#include <Eigen/Geometry>
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+
+#include "theia/sfm/reconstruction.h"
+#include "theia/sfm/track.h"
+#include "theia/sfm/types.h"
+
+namespace theia {
+
+namespace {
+
+// Interleaves the lowest 21 bits of x with two zero bits after each bit.
+uint64_t SpreadBits(uint64_t x) {
+  x &= 0x1fffff;
+  x = (x | x << 32) & 0x1f00000000ffff;
+  x = (x | x << 16) & 0x1f0000ff0000ff;
+  x = (x | x << 8) & 0x100f00f00f00f00f;
+  x = (x | x << 4) & 0x10c30c30c30c30c3;
+  x = (x | x << 2) & 0x1249249249249249;
+  return x;
+}
+
+}  // namespace
+
+bool IsFinitePoint(const Eigen::Vector4d& point) {
+  return point[3] != 0.0 && point.allFinite();
+}
+
+std::vector<TrackId> SortTracksSpatially(
+    const Reconstruction& reconstruction,
+    const std::vector<TrackId>& track_ids) {
+  Eigen::AlignedBox3d bounds;
+  for (const TrackId track_id : track_ids) {
+    const Eigen::Vector4d& point = reconstruction.Track(track_id)->Point();
+    if (IsFinitePoint(point)) {
+      bounds.extend(point.hnormalized());
+    }
+  }
+
+  const double kMaxCoordinate = (1 << 21) - 1;
+  const Eigen::Vector3d extent =
+      bounds.sizes().cwiseMax(std::numeric_limits<double>::min());
+  const Eigen::Vector3d scale = kMaxCoordinate * extent.cwiseInverse();
+  std::vector<std::pair<uint64_t, TrackId> > sort_keys;
+  sort_keys.reserve(track_ids.size());
+  for (const TrackId track_id : track_ids) {
+    const Eigen::Vector4d& point = reconstruction.Track(track_id)->Point();
+    uint64_t code = std::numeric_limits<uint64_t>::max();
+    if (IsFinitePoint(point)) {
+      const Eigen::Vector3d coordinates =
+          (point.hnormalized() - bounds.min())
+              .cwiseProduct(scale)
+              .cwiseMax(0.0)
+              .cwiseMin(kMaxCoordinate);
+      code = SpreadBits(static_cast<uint64_t>(coordinates[0])) |
+             SpreadBits(static_cast<uint64_t>(coordinates[1])) << 1 |
+             SpreadBits(static_cast<uint64_t>(coordinates[2])) << 2;
+    }
+    sort_keys.emplace_back(code, track_id);
+  }
+  std::sort(sort_keys.begin(), sort_keys.end());
+
+  std::vector<TrackId> sorted_track_ids;
+  sorted_track_ids.reserve(sort_keys.size());
+  for (const auto& sort_key : sort_keys) {
+    sorted_track_ids.emplace_back(sort_key.second);
+  }
+  return sorted_track_ids;
+}
+
+std::vector<TrackId> SortTracksSpatially(const Reconstruction& reconstruction) {
+  return SortTracksSpatially(reconstruction, reconstruction.TrackIds());
+}
+
+}  // namespace theia
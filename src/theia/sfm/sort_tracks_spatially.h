@@ -0,0 +1,63 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#ifndef THEIA_SFM_SORT_TRACKS_SPATIALLY_H_
+#define THEIA_SFM_SORT_TRACKS_SPATIALLY_H_
+
+#include <Eigen/Core>
+#include <vector>
+
+#include "theia/sfm/types.h"
+
+namespace theia {
+
+class Reconstruction;
+
+// Returns true if the homogeneous point is finite, i.e. not at infinity.
+bool IsFinitePoint(const Eigen::Vector4d& point);
+
+// Returns the track ids sorted by the Morton code of their points within the
+// bounding box of the points, so that tracks that are close in the order are
+// close in space. Points at infinity are sorted last. Splitting the order into
+// consecutive runs gives chunks that each cover a compact region of the scene.
+std::vector<TrackId> SortTracksSpatially(
+    const Reconstruction& reconstruction,
+    const std::vector<TrackId>& track_ids);
+
+// Same as above for all tracks of the reconstruction.
+std::vector<TrackId> SortTracksSpatially(const Reconstruction& reconstruction);
+
+}  // namespace theia
+
+#endif  // THEIA_SFM_SORT_TRACKS_SPATIALLY_H_
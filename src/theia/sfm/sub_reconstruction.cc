@@ -0,0 +1,131 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#include "theia/sfm/sub_reconstruction.h"
+
+#include <glog/logging.h>
+
+#include <unordered_set>
+
+#include "theia/sfm/reconstruction.h"
+#include "theia/sfm/track.h"
+#include "theia/sfm/types.h"
+#include "theia/sfm/view.h"
+#include "theia/util/map_util.h"
+
+namespace theia {
+
+SubReconstruction::SubReconstruction(const Reconstruction& parent,
+                                     const std::unordered_set<ViewId>& view_ids)
+    : parent_(&parent), mutable_parent_(nullptr) {
+  view_ids_.reserve(view_ids.size());
+  for (const ViewId view_id : view_ids) {
+    const class View* view = parent_->View(view_id);
+    // Skip this view id if it does not exist in the reconstruction.
+    if (view == nullptr) {
+      continue;
+    }
+    view_ids_.emplace(view_id);
+    for (const TrackId track_id : view->TrackIds()) {
+      track_ids_.emplace(track_id);
+    }
+  }
+}
+
+SubReconstruction::SubReconstruction(Reconstruction* parent,
+                                     const std::unordered_set<ViewId>& view_ids)
+    : SubReconstruction(*CHECK_NOTNULL(parent), view_ids) {
+  mutable_parent_ = parent;
+}
+
+const View* SubReconstruction::View(const ViewId view_id) const {
+  if (!ContainsKey(view_ids_, view_id)) {
+    return nullptr;
+  }
+  const auto it = modified_views_.find(view_id);
+  return it != modified_views_.end() ? &it->second : parent_->View(view_id);
+}
+
+const Track* SubReconstruction::Track(const TrackId track_id) const {
+  if (!ContainsKey(track_ids_, track_id)) {
+    return nullptr;
+  }
+  const auto it = modified_tracks_.find(track_id);
+  return it != modified_tracks_.end() ? &it->second : parent_->Track(track_id);
+}
+
+View* SubReconstruction::MutableView(const ViewId view_id) {
+  if (!ContainsKey(view_ids_, view_id)) {
+    return nullptr;
+  }
+  auto it = modified_views_.find(view_id);
+  if (it == modified_views_.end()) {
+    it = modified_views_.emplace(view_id, *parent_->View(view_id)).first;
+  }
+  return &it->second;
+}
+
+Track* SubReconstruction::MutableTrack(const TrackId track_id) {
+  if (!ContainsKey(track_ids_, track_id)) {
+    return nullptr;
+  }
+  auto it = modified_tracks_.find(track_id);
+  if (it == modified_tracks_.end()) {
+    it = modified_tracks_.emplace(track_id, *parent_->Track(track_id)).first;
+  }
+  return &it->second;
+}
+
+bool SubReconstruction::WriteBack() {
+  if (mutable_parent_ == nullptr) {
+    LOG(ERROR) << "Cannot write back the changes to a const reconstruction.";
+    return false;
+  }
+
+  for (auto& view : modified_views_) {
+    *mutable_parent_->MutableView(view.first) = std::move(view.second);
+  }
+  for (auto& track : modified_tracks_) {
+    *mutable_parent_->MutableTrack(track.first) = std::move(track.second);
+  }
+  DiscardChanges();
+  return true;
+}
+
+void SubReconstruction::DiscardChanges() {
+  modified_views_.clear();
+  modified_tracks_.clear();
+}
+
+}  // namespace theia
@@ -0,0 +1,114 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#ifndef THEIA_SFM_SUB_RECONSTRUCTION_H_
+#define THEIA_SFM_SUB_RECONSTRUCTION_H_
+
+#include <unordered_map>
+#include <unordered_set>
+
+#include "theia/sfm/track.h"
+#include "theia/sfm/types.h"
+#include "theia/sfm/view.h"
+
+namespace theia {
+
+class Reconstruction;
+
+// A lightweight view of a subset of the views of a reconstruction and the
+// tracks observed by those views. Unlike Reconstruction::GetSubReconstruction,
+// nothing is copied when the sub-reconstruction is created: the views and
+// tracks are read from the parent reconstruction. A view or track is only
+// copied the first time it is mutated (copy-on-write) and the changes are
+// applied to the parent with WriteBack.
+//
+// The views and tracks keep the ids of the parent. Tracks returned by Track()
+// are those of the parent, so they also list the views outside of the subset
+// that observe them.
+//
+// The parent must outlive the sub-reconstruction and must not be modified
+// while the sub-reconstruction has pending changes.
+class SubReconstruction {
+ public:
+  // Views that do not exist in the parent are skipped. A sub-reconstruction
+  // of a const parent can be mutated but can not be written back.
+  SubReconstruction(const Reconstruction& parent,
+                    const std::unordered_set<ViewId>& view_ids);
+  SubReconstruction(Reconstruction* parent,
+                    const std::unordered_set<ViewId>& view_ids);
+
+  // The views in the subset and the tracks that they observe.
+  const std::unordered_set<ViewId>& ViewIds() const { return view_ids_; }
+  const std::unordered_set<TrackId>& TrackIds() const { return track_ids_; }
+  int NumViews() const { return view_ids_.size(); }
+  int NumTracks() const { return track_ids_.size(); }
+
+  // Returns the view or track, or a nullptr if it is not in the subset. The
+  // modified copy is returned if the view or track was mutated.
+  const class View* View(const ViewId view_id) const;
+  const class Track* Track(const TrackId track_id) const;
+
+  // Returns a mutable copy of the view or track, which is created on the first
+  // call. Returns a nullptr if the view or track is not in the subset.
+  class View* MutableView(const ViewId view_id);
+  class Track* MutableTrack(const TrackId track_id);
+
+  // The number of views and tracks that were copied because they were mutated.
+  int NumModifiedViews() const { return modified_views_.size(); }
+  int NumModifiedTracks() const { return modified_tracks_.size(); }
+
+  // Applies the modified views and tracks to the parent and releases the
+  // copies. Returns false if the parent is const.
+  bool WriteBack();
+
+  // Releases the copies without applying them to the parent.
+  void DiscardChanges();
+
+  // Returns the parent, or a nullptr if the parent is const.
+  Reconstruction* MutableParent() { return mutable_parent_; }
+
+ private:
+  const Reconstruction* parent_;
+  Reconstruction* mutable_parent_;
+
+  std::unordered_set<ViewId> view_ids_;
+  std::unordered_set<TrackId> track_ids_;
+
+  std::unordered_map<ViewId, class View> modified_views_;
+  std::unordered_map<TrackId, class Track> modified_tracks_;
+};
+
+}  // namespace theia
+
+#endif  // THEIA_SFM_SUB_RECONSTRUCTION_H_
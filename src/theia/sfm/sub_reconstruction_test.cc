@@ -0,0 +1,169 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#include <Eigen/Core>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "theia/sfm/feature.h"
+#include "theia/sfm/reconstruction.h"
+#include "theia/sfm/sub_reconstruction.h"
+#include "theia/sfm/track.h"
+#include "theia/sfm/types.h"
+#include "theia/sfm/view.h"
+#include "theia/util/map_util.h"
+#include "theia/util/stringprintf.h"
+
+namespace theia {
+
+namespace {
+
+static const int kNumViews = 20;
+static const int kNumTracks = 100;
+static const int kNumObservationsPerTrack = 4;
+
+// Each track i is observed by the views i, ..., i + kNumObservationsPerTrack - 1
+// (modulo the number of views).
+void BuildReconstruction(Reconstruction* reconstruction) {
+  for (int i = 0; i < kNumViews; i++) {
+    const ViewId view_id =
+        reconstruction->AddView(StringPrintf("%d", i), i);
+    reconstruction->MutableView(view_id)->SetEstimated(true);
+  }
+  for (int i = 0; i < kNumTracks; i++) {
+    std::vector<std::pair<ViewId, Feature> > track;
+    for (int j = 0; j < kNumObservationsPerTrack; j++) {
+      track.emplace_back((i + j) % kNumViews, Feature());
+    }
+    const TrackId track_id = reconstruction->AddTrack(track);
+    *reconstruction->MutableTrack(track_id)->MutablePoint() =
+        Eigen::Vector4d(i, 0.0, 1.0, 1.0);
+  }
+}
+
+}  // namespace
+
+TEST(SubReconstruction, ContainsTheViewsAndTheirTracks) {
+  Reconstruction reconstruction;
+  BuildReconstruction(&reconstruction);
+
+  // Views that do not exist are skipped.
+  const std::unordered_set<ViewId> views_in_subset = {2, 3, 4, kNumViews + 1};
+  const SubReconstruction subset(reconstruction, views_in_subset);
+  EXPECT_EQ(subset.NumViews(), 3);
+  EXPECT_EQ(subset.View(kNumViews + 1), nullptr);
+  EXPECT_EQ(subset.View(5), nullptr);
+
+  std::unordered_set<TrackId> expected_track_ids;
+  for (const ViewId view_id : subset.ViewIds()) {
+    // The views are not copied.
+    EXPECT_EQ(subset.View(view_id), reconstruction.View(view_id));
+    for (const TrackId track_id : reconstruction.View(view_id)->TrackIds()) {
+      expected_track_ids.emplace(track_id);
+    }
+  }
+  EXPECT_EQ(subset.TrackIds(), expected_track_ids);
+  for (const TrackId track_id : reconstruction.TrackIds()) {
+    if (ContainsKey(expected_track_ids, track_id)) {
+      EXPECT_EQ(subset.Track(track_id), reconstruction.Track(track_id));
+    } else {
+      EXPECT_EQ(subset.Track(track_id), nullptr);
+    }
+  }
+  EXPECT_EQ(subset.NumModifiedViews(), 0);
+  EXPECT_EQ(subset.NumModifiedTracks(), 0);
+}
+
+TEST(SubReconstruction, CopyOnWrite) {
+  Reconstruction reconstruction;
+  BuildReconstruction(&reconstruction);
+
+  SubReconstruction subset(&reconstruction, {0, 1});
+  const TrackId track_id = *subset.TrackIds().begin();
+  const Eigen::Vector4d point = reconstruction.Track(track_id)->Point();
+
+  View* view = subset.MutableView(0);
+  ASSERT_NE(view, nullptr);
+  EXPECT_NE(view, reconstruction.View(0));
+  EXPECT_EQ(subset.MutableView(0), view);
+  EXPECT_EQ(subset.View(0), view);
+  view->SetEstimated(false);
+  *subset.MutableTrack(track_id)->MutablePoint() = Eigen::Vector4d::Ones();
+  EXPECT_EQ(subset.NumModifiedViews(), 1);
+  EXPECT_EQ(subset.NumModifiedTracks(), 1);
+  EXPECT_EQ(subset.MutableView(5), nullptr);
+
+  // The parent is unchanged until the changes are written back.
+  EXPECT_TRUE(reconstruction.View(0)->IsEstimated());
+  EXPECT_EQ(reconstruction.Track(track_id)->Point(), point);
+  EXPECT_FALSE(subset.View(0)->IsEstimated());
+  EXPECT_EQ(subset.Track(track_id)->Point(), Eigen::Vector4d::Ones());
+
+  EXPECT_TRUE(subset.WriteBack());
+  EXPECT_EQ(subset.NumModifiedViews(), 0);
+  EXPECT_EQ(subset.NumModifiedTracks(), 0);
+  EXPECT_FALSE(reconstruction.View(0)->IsEstimated());
+  EXPECT_EQ(reconstruction.Track(track_id)->Point(), Eigen::Vector4d::Ones());
+  EXPECT_EQ(subset.View(0), reconstruction.View(0));
+}
+
+TEST(SubReconstruction, DiscardChanges) {
+  Reconstruction reconstruction;
+  BuildReconstruction(&reconstruction);
+
+  SubReconstruction subset(&reconstruction, {0, 1});
+  subset.MutableView(1)->SetEstimated(false);
+  subset.DiscardChanges();
+  EXPECT_TRUE(subset.View(1)->IsEstimated());
+  EXPECT_TRUE(subset.WriteBack());
+  EXPECT_TRUE(reconstruction.View(1)->IsEstimated());
+}
+
+TEST(SubReconstruction, ConstParentCannotBeWrittenBack) {
+  Reconstruction reconstruction;
+  BuildReconstruction(&reconstruction);
+
+  const Reconstruction& const_reconstruction = reconstruction;
+  SubReconstruction subset(const_reconstruction, {0, 1});
+  EXPECT_EQ(subset.MutableParent(), nullptr);
+  subset.MutableView(1)->SetEstimated(false);
+  EXPECT_FALSE(subset.WriteBack());
+  EXPECT_TRUE(reconstruction.View(1)->IsEstimated());
+  EXPECT_FALSE(subset.View(1)->IsEstimated());
+}
+
+}  // namespace theia
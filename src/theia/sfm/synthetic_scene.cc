@@ -0,0 +1,555 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#include "theia/sfm/synthetic_scene.h"
+
+#include <Eigen/Core>
+#include <Eigen/Geometry>
+#include <Eigen/StdVector>
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <iterator>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "theia/matching/feature_correspondence.h"
+#include "theia/matching/features_and_matches_database.h"
+#include "theia/matching/image_pair_match.h"
+#include "theia/matching/keypoints_and_descriptors.h"
+#include "theia/math/rotation.h"
+#include "theia/math/util.h"
+#include "theia/sfm/camera/camera.h"
+#include "theia/sfm/camera_intrinsics_prior.h"
+#include "theia/sfm/feature.h"
+#include "theia/sfm/reconstruction.h"
+#include "theia/sfm/track.h"
+#include "theia/sfm/twoview_info.h"
+#include "theia/sfm/types.h"
+#include "theia/sfm/view.h"
+#include "theia/sfm/view_graph/view_graph.h"
+#include "theia/util/executor.h"
+#include "theia/util/hash.h"
+#include "theia/util/random.h"
+#include "theia/util/stringprintf.h"
+
+namespace theia {
+
+namespace {
+
+// Each view, point, edge and track draws its random numbers from its own
+// stream of the seed so that the scene does not depend on the number of
+// threads or the order in which the items are generated.
+enum class StreamType : uint64_t {
+  VIEW = 0,
+  POINT = 1,
+  EDGE = 2,
+  DESCRIPTOR = 3,
+  DESCRIPTOR_NOISE = 4,
+};
+
+RandomNumberGenerator StreamGenerator(const SyntheticSceneOptions& options,
+                                      const StreamType type,
+                                      const uint64_t index) {
+  return RandomNumberGenerator(
+      options.seed, (static_cast<uint64_t>(type) << 56) | index);
+}
+
+struct SyntheticObservation {
+  int view_index;
+  Eigen::Vector2d pixel;
+};
+
+typedef std::vector<SyntheticObservation,
+                    Eigen::aligned_allocator<SyntheticObservation> >
+    SyntheticObservations;
+
+// Returns a random rotation (as an angle-axis vector) with an angle of at most
+// max_angle_degrees about a random axis.
+Eigen::Vector3d RandomAngleAxis(const double max_angle_degrees,
+                                RandomNumberGenerator* rng) {
+  Eigen::Vector3d axis = rng->RandVector3d();
+  while (axis.squaredNorm() < 1e-12) {
+    axis = rng->RandVector3d();
+  }
+  return axis.normalized() *
+         DegToRad(rng->RandDouble(0.0, max_angle_degrees));
+}
+
+Camera CreateCamera(const SyntheticSceneOptions& options,
+                    const int num_grid_columns,
+                    const int view_index) {
+  RandomNumberGenerator rng =
+      StreamGenerator(options, StreamType::VIEW, view_index);
+
+  // The world-to-camera rotation of a camera looking straight down with the
+  // image x axis along the world x axis.
+  Eigen::Matrix3d nadir_rotation;
+  nadir_rotation << 1.0, 0.0, 0.0, 0.0, -1.0, 0.0, 0.0, 0.0, -1.0;
+  const Eigen::Vector3d tilt =
+      RandomAngleAxis(options.max_camera_tilt_degrees, &rng);
+  const Eigen::Matrix3d rotation =
+      Eigen::AngleAxisd(tilt.norm(), tilt.normalized()).toRotationMatrix() *
+      nadir_rotation;
+
+  Camera camera;
+  camera.SetFocalLength(options.focal_length);
+  camera.SetPrincipalPoint(options.image_width / 2.0,
+                           options.image_height / 2.0);
+  camera.SetImageSize(options.image_width, options.image_height);
+  camera.SetPosition(
+      Eigen::Vector3d(options.camera_spacing * (view_index % num_grid_columns),
+                      options.camera_spacing * (view_index / num_grid_columns),
+                      options.camera_height));
+  camera.SetOrientationFromRotationMatrix(rotation);
+  return camera;
+}
+
+// The projection of a camera without distortion, which is evaluated for
+// every candidate view of every point. Camera::ProjectPoint converts the
+// angle-axis orientation of the camera on every call.
+struct PinholeProjection {
+  Eigen::Matrix3d rotation;
+  Eigen::Vector3d position;
+  double focal_length;
+  Eigen::Vector2d principal_point;
+
+  // Returns false if the point is behind the camera.
+  bool Project(const Eigen::Vector3d& point, Eigen::Vector2d* pixel) const {
+    const Eigen::Vector3d point_in_camera = rotation * (point - position);
+    if (point_in_camera.z() <= 0.0) {
+      return false;
+    }
+    *pixel =
+        focal_length * point_in_camera.hnormalized() + principal_point;
+    return true;
+  }
+};
+
+typedef std::vector<PinholeProjection,
+                    Eigen::aligned_allocator<PinholeProjection> >
+    PinholeProjections;
+
+bool IsInImage(const SyntheticSceneOptions& options,
+               const Eigen::Vector2d& pixel) {
+  return pixel.x() >= 0.0 && pixel.y() >= 0.0 &&
+         pixel.x() < options.image_width && pixel.y() < options.image_height;
+}
+
+// Generates the point and its observations in the views of the grid cells
+// that may see it.
+void GeneratePoint(const SyntheticSceneOptions& options,
+                   const PinholeProjections& cameras,
+                   const int num_grid_columns,
+                   const int num_grid_rows,
+                   const int point_index,
+                   Eigen::Vector4d* point,
+                   SyntheticObservations* observations) {
+  RandomNumberGenerator rng =
+      StreamGenerator(options, StreamType::POINT, point_index);
+  *point = Eigen::Vector4d(
+      rng.RandDouble(0.0, options.camera_spacing * (num_grid_columns - 1)),
+      rng.RandDouble(0.0, options.camera_spacing * (num_grid_rows - 1)),
+      rng.RandDouble(0.0, options.max_point_height),
+      1.0);
+
+  // The half extents of the image footprint on the ground, enlarged by the
+  // largest shift that the camera tilt may cause.
+  const double tilt_shift =
+      options.camera_height *
+      std::tan(DegToRad(options.max_camera_tilt_degrees));
+  const double search_radius_x = options.camera_height * options.image_width /
+                                     (2.0 * options.focal_length) +
+                                 tilt_shift;
+  const double search_radius_y = options.camera_height * options.image_height /
+                                     (2.0 * options.focal_length) +
+                                 tilt_shift;
+  const int min_column = std::max(
+      0,
+      static_cast<int>(
+          std::ceil((point->x() - search_radius_x) / options.camera_spacing)));
+  const int max_column = std::min(
+      num_grid_columns - 1,
+      static_cast<int>(
+          std::floor((point->x() + search_radius_x) / options.camera_spacing)));
+  const int min_row = std::max(
+      0,
+      static_cast<int>(
+          std::ceil((point->y() - search_radius_y) / options.camera_spacing)));
+  const int max_row = std::min(
+      num_grid_rows - 1,
+      static_cast<int>(
+          std::floor((point->y() + search_radius_y) / options.camera_spacing)));
+
+  std::vector<int> visible_views;
+  for (int row = min_row; row <= max_row; row++) {
+    for (int column = min_column; column <= max_column; column++) {
+      const int view_index = row * num_grid_columns + column;
+      if (view_index >= cameras.size()) {
+        break;
+      }
+      Eigen::Vector2d pixel;
+      if (cameras[view_index].Project(point->head<3>(), &pixel) &&
+          IsInImage(options, pixel)) {
+        visible_views.emplace_back(view_index);
+      }
+    }
+  }
+  if (visible_views.size() < 2) {
+    return;
+  }
+
+  // Keep a random subset of max_track_length views.
+  if (visible_views.size() > options.max_track_length) {
+    for (int i = 0; i < options.max_track_length; i++) {
+      std::swap(visible_views[i],
+                visible_views[rng.RandInt(i, visible_views.size() - 1)]);
+    }
+    visible_views.resize(options.max_track_length);
+    std::sort(visible_views.begin(), visible_views.end());
+  }
+
+  observations->reserve(visible_views.size());
+  for (const int view_index : visible_views) {
+    SyntheticObservation observation;
+    observation.view_index = view_index;
+    if (rng.RandDouble(0.0, 1.0) < options.outlier_observation_ratio) {
+      observation.pixel = Eigen::Vector2d(
+          rng.RandDouble(0.0, options.image_width),
+          rng.RandDouble(0.0, options.image_height));
+    } else {
+      cameras[view_index].Project(point->head<3>(), &observation.pixel);
+      observation.pixel.x() += rng.RandGaussian(0.0, options.pixel_noise);
+      observation.pixel.y() += rng.RandGaussian(0.0, options.pixel_noise);
+    }
+    observations->emplace_back(observation);
+  }
+}
+
+TwoViewInfo CreateTwoViewInfo(const SyntheticSceneOptions& options,
+                              const Camera& camera1,
+                              const Camera& camera2,
+                              const uint64_t edge_index,
+                              const int num_shared_tracks) {
+  RandomNumberGenerator rng =
+      StreamGenerator(options, StreamType::EDGE, edge_index);
+  TwoViewInfo info;
+  TwoViewInfoFromTwoCameras(camera1, camera2, &info);
+  if (rng.RandDouble(0.0, 1.0) < options.outlier_edge_ratio) {
+    info.rotation_2 = RandomAngleAxis(180.0, &rng);
+    info.position_2 = rng.RandVector3d().normalized();
+  } else if (options.relative_rotation_noise_degrees > 0.0) {
+    info.rotation_2 = MultiplyRotations(
+        RandomAngleAxis(options.relative_rotation_noise_degrees, &rng),
+        info.rotation_2);
+    const Eigen::Vector3d position_noise =
+        RandomAngleAxis(options.relative_rotation_noise_degrees, &rng);
+    info.position_2 = Eigen::AngleAxisd(position_noise.norm(),
+                                        position_noise.normalized()) *
+                      info.position_2;
+  }
+  info.num_verified_matches = num_shared_tracks;
+  info.num_homography_inliers = 0;
+  info.visibility_score = num_shared_tracks;
+  return info;
+}
+
+// Adds the edges between the views that share enough tracks.
+void AddViewGraphEdges(const SyntheticSceneOptions& options,
+                       const std::vector<Camera>& cameras,
+                       const std::vector<ViewId>& view_ids,
+                       const std::vector<SyntheticObservations>&
+                           point_observations,
+                       ViewGraph* view_graph) {
+  std::unordered_map<std::pair<int, int>, int> num_shared_tracks;
+  for (const auto& observations : point_observations) {
+    for (int i = 0; i < observations.size(); i++) {
+      for (int j = i + 1; j < observations.size(); j++) {
+        ++num_shared_tracks[std::make_pair(observations[i].view_index,
+                                           observations[j].view_index)];
+      }
+    }
+  }
+
+  std::vector<std::pair<std::pair<int, int>, int> > edges;
+  for (const auto& view_pair : num_shared_tracks) {
+    if (view_pair.second >= options.min_num_shared_tracks) {
+      edges.emplace_back(view_pair);
+    }
+  }
+  std::sort(edges.begin(), edges.end());
+
+  std::vector<TwoViewInfo> infos(edges.size());
+  ParallelFor(options.num_threads, edges.size(), [&](const int start,
+                                                     const int end) {
+    for (int i = start; i < end; i++) {
+      const int view_index1 = edges[i].first.first;
+      const int view_index2 = edges[i].first.second;
+      infos[i] = CreateTwoViewInfo(
+          options,
+          cameras[view_index1],
+          cameras[view_index2],
+          static_cast<uint64_t>(view_index1) * cameras.size() + view_index2,
+          edges[i].second);
+    }
+  });
+  for (int i = 0; i < edges.size(); i++) {
+    view_graph->AddEdge(view_ids[edges[i].first.first],
+                        view_ids[edges[i].first.second],
+                        infos[i]);
+  }
+}
+
+// Returns the descriptor of the keypoint of the track in the view.
+Eigen::VectorXf SyntheticDescriptor(const SyntheticSceneOptions& options,
+                                    const TrackId track_id,
+                                    RandomNumberGenerator* view_rng) {
+  RandomNumberGenerator track_rng =
+      StreamGenerator(options, StreamType::DESCRIPTOR, track_id);
+  Eigen::VectorXf descriptor(options.descriptor_dimension);
+  for (int i = 0; i < options.descriptor_dimension; i++) {
+    descriptor[i] = track_rng.RandFloat(0.0f, 1.0f);
+  }
+  descriptor.normalize();
+  for (int i = 0; i < options.descriptor_dimension; i++) {
+    descriptor[i] += view_rng->RandGaussian(0.0, 0.01);
+  }
+  descriptor.normalize();
+  return descriptor;
+}
+
+}  // namespace
+
+bool GenerateSyntheticScene(const SyntheticSceneOptions& options,
+                            Reconstruction* reconstruction,
+                            ViewGraph* view_graph) {
+  CHECK_NOTNULL(reconstruction);
+  CHECK_EQ(reconstruction->NumViews(), 0)
+      << "The reconstruction must be empty.";
+  CHECK_GE(options.num_views, 2);
+  CHECK_GE(options.max_track_length, 2);
+  CHECK_GT(options.camera_spacing, 0.0);
+  CHECK_GT(options.camera_height, options.max_point_height);
+
+  const int num_grid_columns =
+      static_cast<int>(std::ceil(std::sqrt(options.num_views)));
+  const int num_grid_rows =
+      (options.num_views + num_grid_columns - 1) / num_grid_columns;
+
+  std::vector<Camera> cameras(options.num_views);
+  ParallelFor(options.num_threads, options.num_views, [&](const int start,
+                                                          const int end) {
+    for (int i = start; i < end; i++) {
+      cameras[i] = CreateCamera(options, num_grid_columns, i);
+    }
+  });
+
+  std::vector<Eigen::Vector4d, Eigen::aligned_allocator<Eigen::Vector4d> >
+      points(options.num_points);
+  std::vector<SyntheticObservations> point_observations(options.num_points);
+  PinholeProjections projections(options.num_views);
+  for (int i = 0; i < options.num_views; i++) {
+    projections[i].rotation = cameras[i].GetOrientationAsRotationMatrix();
+    projections[i].position = cameras[i].GetPosition();
+    projections[i].focal_length = options.focal_length;
+    projections[i].principal_point = Eigen::Vector2d(
+        options.image_width / 2.0, options.image_height / 2.0);
+  }
+  ParallelFor(options.num_threads, options.num_points, [&](const int start,
+                                                           const int end) {
+    for (int i = start; i < end; i++) {
+      GeneratePoint(options,
+                    projections,
+                    num_grid_columns,
+                    num_grid_rows,
+                    i,
+                    &points[i],
+                    &point_observations[i]);
+    }
+  });
+
+  CameraIntrinsicsPrior prior;
+  prior.image_width = options.image_width;
+  prior.image_height = options.image_height;
+  prior.focal_length.is_set = true;
+  prior.focal_length.value[0] = options.focal_length;
+  prior.principal_point.is_set = true;
+  prior.principal_point.value[0] = options.image_width / 2.0;
+  prior.principal_point.value[1] = options.image_height / 2.0;
+
+  std::vector<ViewId> view_ids(options.num_views);
+  for (int i = 0; i < options.num_views; i++) {
+    const std::string view_name = StringPrintf("view_%06d.jpg", i);
+    view_ids[i] = options.shared_intrinsics
+                      ? reconstruction->AddView(view_name, 0, i)
+                      : reconstruction->AddView(view_name, i);
+    CHECK_NE(view_ids[i], kInvalidViewId);
+    View* view = reconstruction->MutableView(view_ids[i]);
+    view->SetCameraIntrinsicsPrior(prior);
+    Camera* camera = view->MutableCamera();
+    camera->SetFocalLength(options.focal_length);
+    camera->SetPrincipalPoint(options.image_width / 2.0,
+                              options.image_height / 2.0);
+    camera->SetImageSize(options.image_width, options.image_height);
+    camera->SetPosition(cameras[i].GetPosition());
+    camera->SetOrientationFromAngleAxis(
+        cameras[i].GetOrientationAsAngleAxis());
+    view->SetEstimated(true);
+  }
+
+  int num_tracks = 0;
+  std::vector<std::pair<ViewId, Feature> > track;
+  for (int i = 0; i < options.num_points; i++) {
+    if (point_observations[i].empty()) {
+      continue;
+    }
+    track.clear();
+    for (const SyntheticObservation& observation : point_observations[i]) {
+      track.emplace_back(view_ids[observation.view_index],
+                         Feature(observation.pixel));
+    }
+    const TrackId track_id = reconstruction->AddTrack(track);
+    CHECK_NE(track_id, kInvalidTrackId);
+    Track* mutable_track = reconstruction->MutableTrack(track_id);
+    mutable_track->SetPoint(points[i]);
+    mutable_track->SetEstimated(true);
+    ++num_tracks;
+  }
+
+  if (view_graph != nullptr) {
+    AddViewGraphEdges(
+        options, cameras, view_ids, point_observations, view_graph);
+  }
+
+  VLOG(2) << "Generated a synthetic scene with " << options.num_views
+          << " views and " << num_tracks << " tracks.";
+  return num_tracks > 0;
+}
+
+void WriteSyntheticSceneToDatabase(const SyntheticSceneOptions& options,
+                                   const Reconstruction& reconstruction,
+                                   const ViewGraph& view_graph,
+                                   FeaturesAndMatchesDatabase* database) {
+  CHECK_NOTNULL(database);
+
+  // The keypoints of each view are its observations sorted by track id, so the
+  // keypoint of a track is found by a binary search in the sorted track ids.
+  std::vector<ViewId> view_ids;
+  view_ids.reserve(reconstruction.NumViews());
+  for (const ViewId view_id : reconstruction.ViewIds()) {
+    view_ids.emplace_back(view_id);
+  }
+  std::sort(view_ids.begin(), view_ids.end());
+  std::unordered_map<ViewId, std::vector<TrackId> > view_track_ids;
+  for (const ViewId view_id : view_ids) {
+    std::vector<TrackId>& track_ids = view_track_ids[view_id];
+    track_ids = reconstruction.View(view_id)->TrackIds();
+    std::sort(track_ids.begin(), track_ids.end());
+  }
+
+  ParallelFor(options.num_threads, view_ids.size(), [&](const int start,
+                                                        const int end) {
+    for (int i = start; i < end; i++) {
+      const View& view = *reconstruction.View(view_ids[i]);
+      const std::vector<TrackId>& track_ids =
+          view_track_ids.at(view_ids[i]);
+      RandomNumberGenerator view_rng =
+          StreamGenerator(options, StreamType::DESCRIPTOR_NOISE, view_ids[i]);
+
+      KeypointsAndDescriptors features;
+      features.image_name = view.Name();
+      features.keypoints.reserve(track_ids.size());
+      if (options.descriptor_dimension > 0) {
+        features.descriptor_matrix.resize(track_ids.size(),
+                                          options.descriptor_dimension);
+      }
+      for (int j = 0; j < track_ids.size(); j++) {
+        const Feature& feature = *view.GetFeature(track_ids[j]);
+        features.keypoints.emplace_back(
+            feature.x(), feature.y(), Keypoint::OTHER);
+        if (options.descriptor_dimension > 0) {
+          features.descriptor_matrix.row(j) =
+              SyntheticDescriptor(options, track_ids[j], &view_rng)
+                  .transpose();
+        }
+      }
+      database->PutCameraIntrinsicsPrior(view.Name(),
+                                         view.CameraIntrinsicsPrior());
+      database->PutFeatures(view.Name(), features);
+    }
+  });
+
+  std::vector<std::pair<ViewIdPair, const TwoViewInfo*> > edges;
+  edges.reserve(view_graph.NumEdges());
+  for (const auto& edge : view_graph.GetAllEdges()) {
+    edges.emplace_back(edge.first, &edge.second);
+  }
+  std::sort(edges.begin(), edges.end());
+
+  ParallelFor(options.num_threads, edges.size(), [&](const int start,
+                                                     const int end) {
+    for (int i = start; i < end; i++) {
+      const View& view1 = *reconstruction.View(edges[i].first.first);
+      const View& view2 = *reconstruction.View(edges[i].first.second);
+      const std::vector<TrackId>& track_ids1 =
+          view_track_ids.at(edges[i].first.first);
+      const std::vector<TrackId>& track_ids2 =
+          view_track_ids.at(edges[i].first.second);
+
+      ImagePairMatch match;
+      match.image1 = view1.Name();
+      match.image2 = view2.Name();
+      match.twoview_info = *edges[i].second;
+      std::vector<TrackId> shared_track_ids;
+      std::set_intersection(track_ids1.begin(),
+                            track_ids1.end(),
+                            track_ids2.begin(),
+                            track_ids2.end(),
+                            std::back_inserter(shared_track_ids));
+      match.correspondences.reserve(shared_track_ids.size());
+      for (const TrackId track_id : shared_track_ids) {
+        match.correspondences.emplace_back(*view1.GetFeature(track_id),
+                                           *view2.GetFeature(track_id));
+      }
+      database->PutImagePairMatch(match.image1, match.image2, match);
+    }
+  });
+  database->Flush();
+}
+
+}  // namespace theia
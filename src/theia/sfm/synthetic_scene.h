@@ -0,0 +1,135 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#ifndef THEIA_SFM_SYNTHETIC_SCENE_H_
+#define THEIA_SFM_SYNTHETIC_SCENE_H_
+
+namespace theia {
+
+class FeaturesAndMatchesDatabase;
+class Reconstruction;
+class ViewGraph;
+
+// Options for generating a synthetic scene of arbitrary size. The cameras are
+// laid out as in an aerial survey: on a square grid at a constant height above
+// the ground, looking down with a small random tilt. The 3D points are spread
+// uniformly over the ground below the grid. Because a point is only visible to
+// the cameras above it, the work and memory needed to generate the scene grow
+// linearly with the number of views and points, so scenes with 100k views and
+// millions of points can be generated in seconds.
+//
+// The density of the scene is controlled by the camera spacing (relative to
+// the footprint of an image on the ground, which is camera_height times the
+// image size divided by the focal length), by the number of points and by
+// max_track_length. All randomness is drawn from streams of the seed that only
+// depend on the view or point index, so a scene is reproducible bit for bit
+// regardless of the number of threads.
+struct SyntheticSceneOptions {
+  int num_views = 100;
+  int num_points = 10000;
+
+  // The distance between neighboring cameras on the grid and the height of
+  // the cameras above the ground. The points have a height between 0 and
+  // max_point_height.
+  double camera_spacing = 1.0;
+  double camera_height = 10.0;
+  double max_point_height = 2.0;
+
+  // The maximum angle in degrees of the random rotation that is applied to
+  // each camera looking straight down.
+  double max_camera_tilt_degrees = 5.0;
+
+  // The intrinsics of all cameras. If shared_intrinsics is true, all views are
+  // in one camera intrinsics group.
+  int image_width = 1920;
+  int image_height = 1080;
+  double focal_length = 1500.0;
+  bool shared_intrinsics = true;
+
+  // A point that is visible to more views than max_track_length is only
+  // observed by a random subset of max_track_length of them. Points that are
+  // visible to fewer than two views are not added.
+  int max_track_length = 8;
+
+  // The standard deviation in pixels of the Gaussian noise that is added to
+  // the observations, and the fraction of observations that are replaced by a
+  // uniformly random pixel.
+  double pixel_noise = 0.5;
+  double outlier_observation_ratio = 0.0;
+
+  // A view graph edge is added between two views that observe at least
+  // min_num_shared_tracks common tracks. The relative pose of the edge is the
+  // ground truth relative pose with a random rotation of at most
+  // relative_rotation_noise_degrees applied to both the relative rotation and
+  // the relative position direction. The relative pose of a fraction of the
+  // edges is replaced by a random pose.
+  int min_num_shared_tracks = 16;
+  double relative_rotation_noise_degrees = 0.0;
+  double outlier_edge_ratio = 0.0;
+
+  // If greater than zero, WriteSyntheticSceneToDatabase stores a random
+  // descriptor of this dimension for each keypoint. The descriptors of all
+  // observations of a track are noisy copies of one descriptor.
+  int descriptor_dimension = 0;
+
+  unsigned seed = 42;
+  int num_threads = 1;
+};
+
+// Generates a synthetic scene. The reconstruction must be empty. It is filled
+// with the ground truth views and tracks; the tracks hold the (noisy and
+// outlier) observations, so the reconstruction doubles as the input of track
+// based estimators and as the reference to compare their output against. The
+// views are named "view_000000.jpg", ... in grid order. If view_graph is not
+// NULL, it is filled with the edges between views with enough shared tracks.
+// Returns false if the options do not produce a single track.
+bool GenerateSyntheticScene(const SyntheticSceneOptions& options,
+                            Reconstruction* reconstruction,
+                            ViewGraph* view_graph);
+
+// Writes the camera intrinsics priors and keypoints of the views and a
+// verified image pair match for each view graph edge of a generated scene to
+// the database, e.g. a RocksDbFeaturesAndMatchesDatabase, so that the matching
+// and reconstruction stages can be run on the scene. The keypoints of a view
+// are its observations in the order of the track ids, and the matches contain
+// the observations of all shared tracks together with the relative pose of the
+// edge. The options must be the ones the scene was generated with.
+void WriteSyntheticSceneToDatabase(const SyntheticSceneOptions& options,
+                                   const Reconstruction& reconstruction,
+                                   const ViewGraph& view_graph,
+                                   FeaturesAndMatchesDatabase* database);
+
+}  // namespace theia
+
+#endif  // THEIA_SFM_SYNTHETIC_SCENE_H_
@@ -0,0 +1,204 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#include <Eigen/Core>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "theia/matching/image_pair_match.h"
+#include "theia/matching/in_memory_features_and_matches_database.h"
+#include "theia/matching/keypoints_and_descriptors.h"
+#include "theia/sfm/camera/camera.h"
+#include "theia/sfm/reconstruction.h"
+#include "theia/sfm/synthetic_scene.h"
+#include "theia/sfm/track.h"
+#include "theia/sfm/twoview_info.h"
+#include "theia/sfm/view.h"
+#include "theia/sfm/view_graph/view_graph.h"
+
+namespace theia {
+
+namespace {
+
+SyntheticSceneOptions SmallSceneOptions() {
+  SyntheticSceneOptions options;
+  options.num_views = 30;
+  options.num_points = 3000;
+  options.pixel_noise = 0.0;
+  return options;
+}
+
+// Returns the fraction of the observations that are more than the threshold
+// away from the projection of their track.
+double FractionOfObservationsWithErrorAbove(
+    const Reconstruction& reconstruction, const double threshold) {
+  int num_observations = 0;
+  int num_above_threshold = 0;
+  for (const TrackId track_id : reconstruction.TrackIds()) {
+    const Track& track = *reconstruction.Track(track_id);
+    for (const ViewId view_id : track.ViewIds()) {
+      const View& view = *reconstruction.View(view_id);
+      Eigen::Vector2d pixel;
+      EXPECT_GT(view.Camera().ProjectPoint(track.Point(), &pixel), 0.0);
+      const Feature& feature = *view.GetFeature(track_id);
+      if ((pixel - feature.point_).norm() > threshold) {
+        ++num_above_threshold;
+      }
+      ++num_observations;
+    }
+  }
+  return static_cast<double>(num_above_threshold) / num_observations;
+}
+
+}  // namespace
+
+TEST(SyntheticScene, ObservationsAreProjectionsOfTracks) {
+  const SyntheticSceneOptions options = SmallSceneOptions();
+  Reconstruction reconstruction;
+  ViewGraph view_graph;
+  ASSERT_TRUE(GenerateSyntheticScene(options, &reconstruction, &view_graph));
+
+  EXPECT_EQ(reconstruction.NumViews(), options.num_views);
+  EXPECT_GT(reconstruction.NumTracks(), options.num_points / 2);
+  EXPECT_LE(reconstruction.NumTracks(), options.num_points);
+  for (const ViewId view_id : reconstruction.ViewIds()) {
+    EXPECT_TRUE(reconstruction.View(view_id)->IsEstimated());
+  }
+  for (const TrackId track_id : reconstruction.TrackIds()) {
+    const Track& track = *reconstruction.Track(track_id);
+    EXPECT_TRUE(track.IsEstimated());
+    EXPECT_GE(track.NumViews(), 2);
+    EXPECT_LE(track.NumViews(), options.max_track_length);
+  }
+  EXPECT_EQ(FractionOfObservationsWithErrorAbove(reconstruction, 1e-6), 0.0);
+
+  // The edges hold the ground truth relative poses of the views.
+  EXPECT_GT(view_graph.NumEdges(), 0);
+  for (const auto& edge : view_graph.GetAllEdges()) {
+    EXPECT_GE(edge.second.num_verified_matches, options.min_num_shared_tracks);
+    TwoViewInfo expected_info;
+    TwoViewInfoFromTwoCameras(
+        reconstruction.View(edge.first.first)->Camera(),
+        reconstruction.View(edge.first.second)->Camera(),
+        &expected_info);
+    EXPECT_LT((edge.second.rotation_2 - expected_info.rotation_2).norm(),
+              1e-12);
+    EXPECT_LT((edge.second.position_2 - expected_info.position_2).norm(),
+              1e-12);
+  }
+}
+
+TEST(SyntheticScene, OutlierObservations) {
+  SyntheticSceneOptions options = SmallSceneOptions();
+  options.outlier_observation_ratio = 0.3;
+  Reconstruction reconstruction;
+  ASSERT_TRUE(GenerateSyntheticScene(options, &reconstruction, nullptr));
+
+  // A few outliers land close to the projection by chance.
+  EXPECT_NEAR(
+      FractionOfObservationsWithErrorAbove(reconstruction, 1.0), 0.3, 0.05);
+}
+
+TEST(SyntheticScene, IsIndependentOfNumThreads) {
+  SyntheticSceneOptions options = SmallSceneOptions();
+  options.pixel_noise = 1.0;
+  options.relative_rotation_noise_degrees = 1.0;
+  options.outlier_edge_ratio = 0.1;
+
+  Reconstruction reconstruction1, reconstruction2;
+  ViewGraph view_graph1, view_graph2;
+  options.num_threads = 1;
+  ASSERT_TRUE(GenerateSyntheticScene(options, &reconstruction1, &view_graph1));
+  options.num_threads = 4;
+  ASSERT_TRUE(GenerateSyntheticScene(options, &reconstruction2, &view_graph2));
+
+  ASSERT_EQ(reconstruction1.NumTracks(), reconstruction2.NumTracks());
+  for (const TrackId track_id : reconstruction1.TrackIds()) {
+    const Track& track1 = *reconstruction1.Track(track_id);
+    const Track& track2 = *reconstruction2.Track(track_id);
+    EXPECT_EQ(track1.Point(), track2.Point());
+    ASSERT_EQ(track1.NumViews(), track2.NumViews());
+    for (const ViewId view_id : track1.ViewIds()) {
+      EXPECT_EQ(reconstruction1.View(view_id)->GetFeature(track_id)->point_,
+                reconstruction2.View(view_id)->GetFeature(track_id)->point_);
+    }
+  }
+
+  ASSERT_EQ(view_graph1.NumEdges(), view_graph2.NumEdges());
+  for (const auto& edge : view_graph1.GetAllEdges()) {
+    const TwoViewInfo* info2 =
+        view_graph2.GetEdge(edge.first.first, edge.first.second);
+    ASSERT_NE(info2, nullptr);
+    EXPECT_EQ(edge.second.rotation_2, info2->rotation_2);
+    EXPECT_EQ(edge.second.position_2, info2->position_2);
+  }
+}
+
+TEST(SyntheticScene, WriteToDatabase) {
+  SyntheticSceneOptions options = SmallSceneOptions();
+  options.descriptor_dimension = 32;
+  Reconstruction reconstruction;
+  ViewGraph view_graph;
+  ASSERT_TRUE(GenerateSyntheticScene(options, &reconstruction, &view_graph));
+
+  InMemoryFeaturesAndMatchesDatabase database;
+  WriteSyntheticSceneToDatabase(options, reconstruction, view_graph, &database);
+  EXPECT_EQ(database.NumImages(), options.num_views);
+  EXPECT_EQ(database.NumCameraIntrinsicsPrior(), options.num_views);
+  EXPECT_EQ(database.NumMatches(), view_graph.NumEdges());
+
+  for (const ViewId view_id : reconstruction.ViewIds()) {
+    const View& view = *reconstruction.View(view_id);
+    const KeypointsAndDescriptors features = database.GetFeatures(view.Name());
+    EXPECT_EQ(features.keypoints.size(), view.NumFeatures());
+    EXPECT_EQ(features.descriptor_matrix.rows(), view.NumFeatures());
+    EXPECT_EQ(features.descriptor_matrix.cols(), options.descriptor_dimension);
+  }
+
+  for (const auto& edge : view_graph.GetAllEdges()) {
+    const View& view1 = *reconstruction.View(edge.first.first);
+    const View& view2 = *reconstruction.View(edge.first.second);
+    const ImagePairMatch match =
+        database.GetImagePairMatch(view1.Name(), view2.Name());
+    EXPECT_EQ(match.correspondences.size(),
+              edge.second.num_verified_matches);
+    EXPECT_EQ(match.twoview_info.rotation_2, edge.second.rotation_2);
+  }
+}
+
+}  // namespace theia
@@ -35,7 +35,6 @@
 #include "theia/sfm/track.h"
 
 #include <Eigen/Core>
-#include <unordered_set>
 
 #include "theia/util/map_util.h"
 
@@ -92,7 +91,7 @@ bool Track::RemoveView(const ViewId view_id) {
   return successfull_removed;
 }
 
-const std::unordered_set<ViewId>& Track::ViewIds() const { return view_ids_; }
+const TrackViewIdSet& Track::ViewIds() const { return view_ids_; }
 
 ViewId Track::ReferenceViewId() const { return reference_view_id_; }
 
@@ -38,15 +38,19 @@
 #include <Eigen/Core>
 #include <cereal/access.hpp>
 #include <cereal/cereal.hpp>
-#include <cereal/types/unordered_set.hpp>
 #include <stdint.h>
-#include <unordered_set>
 
 #include "theia/io/eigen_serializable.h"
 #include "theia/sfm/types.h"
+#include "theia/util/flat_set.h"
+#include "theia/util/small_vector.h"
 
 namespace theia {
 
+// The views observing a track. Most tracks are observed by only a few views,
+// which are stored without a heap allocation.
+typedef FlatSet<ViewId, SmallVector<ViewId, 4> > TrackViewIdSet;
+
 // A track contains information about a 3D point and the views that observe the
 // point. This is based off of LibMV's Structure class:
 // https://github.com/libmv/libmv/blob/master/src/libmv/multiview/structure.h
@@ -73,7 +77,9 @@ class Track {
   void AddView(const ViewId view_id);
   bool RemoveView(const ViewId view_id);
 
-  const std::unordered_set<ViewId>& ViewIds() const;
+  // The views observing the track in increasing order. The set converts to a
+  // std::unordered_set<ViewId> where one is needed.
+  const TrackViewIdSet& ViewIds() const;
 
   ViewId ReferenceViewId() const;
 
@@ -104,7 +110,7 @@ class Track {
   }
 
   bool is_estimated_;
-  std::unordered_set<ViewId> view_ids_;
+  TrackViewIdSet view_ids_;
   ViewId reference_view_id_;
   double inverse_depth_;
   Eigen::Vector4d point_;
@@ -47,6 +47,7 @@
 #include "theia/sfm/reconstruction.h"
 #include "theia/sfm/types.h"
 #include "theia/util/map_util.h"
+#include "theia/util/trace.h"
 
 namespace theia {
 
@@ -77,6 +78,7 @@ void TrackBuilder::AddFeatureCorrespondence(const ViewId view_id1,
 }
 
 void TrackBuilder::BuildTracksIncremental(Reconstruction* reconstruction) {
+  THEIA_TRACE_SCOPE("TrackBuilder::BuildTracksIncremental");
   CHECK_NOTNULL(reconstruction);
 
   // Build a reverse map mapping feature ids to ImageNameFeaturePairs.
@@ -153,6 +155,7 @@ void TrackBuilder::BuildTracksIncremental(Reconstruction* reconstruction) {
 }
 
 void TrackBuilder::BuildTracks(Reconstruction* reconstruction) {
+  THEIA_TRACE_SCOPE("TrackBuilder::BuildTracks");
   CHECK_NOTNULL(reconstruction);
 
   // Build a reverse map mapping feature ids to ImageNameFeaturePairs.
@@ -166,7 +169,9 @@ void TrackBuilder::BuildTracks(Reconstruction* reconstruction) {
   std::unordered_map<uint64_t, std::unordered_set<uint64_t> > components;
   connected_components_->Extract(&components);
 
-  // Each connected component is a track. Add all tracks to the reconstruction.
+  // Each connected component is a track.
+  std::vector<std::vector<std::pair<ViewId, Feature> > > tracks;
+  tracks.reserve(components.size());
   int num_small_tracks = 0;
   int num_inconsistent_features = 0;
   for (const auto& component : components) {
@@ -194,8 +199,13 @@ void TrackBuilder::BuildTracks(Reconstruction* reconstruction) {
       track.emplace_back(feature_to_add);
     }
 
-    CHECK_NE(reconstruction->AddTrack(track), kInvalidTrackId)
-        << "Could not build tracks.";
+    tracks.emplace_back(std::move(track));
+  }
+
+  // Add all tracks at once so that the features of each view are added and
+  // indexed in bulk.
+  for (const TrackId track_id : reconstruction->AddTracks(tracks)) {
+    CHECK_NE(track_id, kInvalidTrackId) << "Could not build tracks.";
   }
 
   LOG(INFO)
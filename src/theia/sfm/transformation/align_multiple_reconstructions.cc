@@ -0,0 +1,528 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#include "theia/sfm/transformation/align_multiple_reconstructions.h"
+
+#include <Eigen/Core>
+#include <ceres/ceres.h>
+#include <ceres/rotation.h>
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "theia/sfm/feature.h"
+#include "theia/sfm/reconstruction.h"
+#include "theia/sfm/similarity_transformation.h"
+#include "theia/sfm/track.h"
+#include "theia/sfm/transformation/align_reconstructions.h"
+#include "theia/sfm/transformation/transform_reconstruction.h"
+#include "theia/sfm/types.h"
+#include "theia/sfm/view.h"
+#include "theia/util/executor.h"
+#include "theia/util/hash.h"
+#include "theia/util/random.h"
+
+namespace theia {
+
+namespace {
+
+// A similarity transformation is parameterized by its rotation in angle-axis
+// form, its translation and the logarithm of its scale.
+static const int kNumSimilarityParameters = 7;
+
+// Two reconstructions and the ids of the estimated views they share.
+struct ReconstructionPair {
+  int index1;
+  int index2;
+  std::vector<std::pair<ViewId, ViewId> > shared_views;
+};
+
+// The robust alignment of the second reconstruction of a pair to the first.
+struct PairAlignment {
+  int index1;
+  int index2;
+  SimilarityTransformation transformation;
+  int num_inliers = 0;
+  // The inlier threshold in the frame of the first reconstruction.
+  double error_threshold = 0.0;
+  // A subset of the inlier correspondences.
+  std::vector<Eigen::Vector3d> points1;
+  std::vector<Eigen::Vector3d> points2;
+};
+
+// The error of a correspondence between the points of two reconstructions
+// after both are moved into the common frame, in units of the inlier threshold
+// of the pair:
+//    error = (S1(point1) - S2(point2)) / (scale1 * error_threshold).
+// Dividing by the scale of the first reconstruction keeps the error from
+// vanishing when the scales of both shrink.
+struct SimilarityAlignmentError {
+  SimilarityAlignmentError(const Eigen::Vector3d& point1,
+                           const Eigen::Vector3d& point2,
+                           const double error_threshold)
+      : point1_(point1), point2_(point2), error_threshold_(error_threshold) {}
+
+  template <typename T>
+  bool operator()(const T* similarity1,
+                  const T* similarity2,
+                  T* residuals) const {
+    using std::exp;
+    const T point1[3] = {T(point1_[0]), T(point1_[1]), T(point1_[2])};
+    const T point2[3] = {T(point2_[0]), T(point2_[1]), T(point2_[2])};
+    T rotated_point1[3], rotated_point2[3];
+    ceres::AngleAxisRotatePoint(similarity1, point1, rotated_point1);
+    ceres::AngleAxisRotatePoint(similarity2, point2, rotated_point2);
+
+    const T scale1 = exp(similarity1[6]);
+    const T scale2 = exp(similarity2[6]);
+    for (int i = 0; i < 3; i++) {
+      residuals[i] = (scale1 * rotated_point1[i] + similarity1[3 + i] -
+                      scale2 * rotated_point2[i] - similarity2[3 + i]) /
+                     (scale1 * T(error_threshold_));
+    }
+    return true;
+  }
+
+  static ceres::CostFunction* Create(const Eigen::Vector3d& point1,
+                                     const Eigen::Vector3d& point2,
+                                     const double error_threshold) {
+    return new ceres::AutoDiffCostFunction<SimilarityAlignmentError,
+                                           3,
+                                           kNumSimilarityParameters,
+                                           kNumSimilarityParameters>(
+        new SimilarityAlignmentError(point1, point2, error_threshold));
+  }
+
+  const Eigen::Vector3d point1_;
+  const Eigen::Vector3d point2_;
+  const double error_threshold_;
+};
+
+SimilarityTransformation IdentityTransformation() {
+  SimilarityTransformation transformation;
+  transformation.rotation.setIdentity();
+  transformation.translation.setZero();
+  transformation.scale = 1.0;
+  return transformation;
+}
+
+// Returns the transformation that applies second and then first.
+SimilarityTransformation Compose(const SimilarityTransformation& first,
+                                 const SimilarityTransformation& second) {
+  SimilarityTransformation transformation;
+  transformation.rotation = first.rotation * second.rotation;
+  transformation.translation =
+      first.scale * first.rotation * second.translation + first.translation;
+  transformation.scale = first.scale * second.scale;
+  return transformation;
+}
+
+SimilarityTransformation Invert(const SimilarityTransformation& similarity) {
+  SimilarityTransformation transformation;
+  transformation.rotation = similarity.rotation.transpose();
+  transformation.scale = 1.0 / similarity.scale;
+  transformation.translation =
+      -transformation.scale * transformation.rotation * similarity.translation;
+  return transformation;
+}
+
+// Returns the median distance of the points to their centroid.
+double MedianDistanceToCentroid(const std::vector<Eigen::Vector3d>& points) {
+  Eigen::Vector3d centroid = Eigen::Vector3d::Zero();
+  for (const Eigen::Vector3d& point : points) {
+    centroid += point;
+  }
+  centroid /= static_cast<double>(points.size());
+
+  std::vector<double> distances;
+  distances.reserve(points.size());
+  for (const Eigen::Vector3d& point : points) {
+    distances.emplace_back((point - centroid).norm());
+  }
+  std::nth_element(distances.begin(),
+                   distances.begin() + distances.size() / 2,
+                   distances.end());
+  return distances[distances.size() / 2];
+}
+
+// Returns the pairs of reconstructions that share estimated views, in the
+// order of their indices.
+std::vector<ReconstructionPair> FindReconstructionPairs(
+    const std::vector<Reconstruction*>& reconstructions) {
+  std::unordered_map<std::string, std::vector<std::pair<int, ViewId> > >
+      views_by_name;
+  for (int i = 0; i < reconstructions.size(); i++) {
+    for (const ViewId view_id : reconstructions[i]->ViewIds()) {
+      const View* view = reconstructions[i]->View(view_id);
+      if (view->IsEstimated()) {
+        views_by_name[view->Name()].emplace_back(i, view_id);
+      }
+    }
+  }
+
+  std::map<std::pair<int, int>, ReconstructionPair> pairs;
+  for (const auto& views : views_by_name) {
+    for (int i = 0; i < views.second.size(); i++) {
+      for (int j = i + 1; j < views.second.size(); j++) {
+        ReconstructionPair& pair =
+            pairs[std::make_pair(views.second[i].first, views.second[j].first)];
+        pair.index1 = views.second[i].first;
+        pair.index2 = views.second[j].first;
+        pair.shared_views.emplace_back(views.second[i].second,
+                                       views.second[j].second);
+      }
+    }
+  }
+
+  std::vector<ReconstructionPair> reconstruction_pairs;
+  reconstruction_pairs.reserve(pairs.size());
+  for (auto& pair : pairs) {
+    // The shared views are sorted so that the correspondences do not depend
+    // on the order of the hash map.
+    std::sort(pair.second.shared_views.begin(),
+              pair.second.shared_views.end());
+    reconstruction_pairs.emplace_back(std::move(pair.second));
+  }
+  return reconstruction_pairs;
+}
+
+// Collects the camera positions of the shared views and, if enabled, the
+// points of the estimated tracks with the same features in at least
+// min_num_shared_observations shared views.
+void FindCorrespondences(const MultipleReconstructionAlignmentOptions& options,
+                         const Reconstruction& reconstruction1,
+                         const Reconstruction& reconstruction2,
+                         const ReconstructionPair& pair,
+                         std::vector<Eigen::Vector3d>* points1,
+                         std::vector<Eigen::Vector3d>* points2) {
+  for (const auto& shared_view : pair.shared_views) {
+    points1->emplace_back(
+        reconstruction1.View(shared_view.first)->Camera().GetPosition());
+    points2->emplace_back(
+        reconstruction2.View(shared_view.second)->Camera().GetPosition());
+  }
+  if (!options.use_shared_tracks) {
+    return;
+  }
+
+  std::unordered_map<std::pair<TrackId, TrackId>, int> num_shared_observations;
+  for (const auto& shared_view : pair.shared_views) {
+    const View* view1 = reconstruction1.View(shared_view.first);
+    const View* view2 = reconstruction2.View(shared_view.second);
+
+    // View::GetTrack is linear in the number of features, so the tracks of the
+    // second view are indexed by their features.
+    std::unordered_map<std::pair<double, double>, TrackId> tracks2;
+    for (const TrackId track_id2 : view2->TrackIds()) {
+      const Track* track2 = reconstruction2.Track(track_id2);
+      if (track2 != nullptr && track2->IsEstimated()) {
+        const Feature* feature = view2->GetFeature(track_id2);
+        tracks2.emplace(std::make_pair(feature->x(), feature->y()), track_id2);
+      }
+    }
+
+    for (const TrackId track_id1 : view1->TrackIds()) {
+      const Track* track1 = reconstruction1.Track(track_id1);
+      if (track1 == nullptr || !track1->IsEstimated()) {
+        continue;
+      }
+      const Feature* feature = view1->GetFeature(track_id1);
+      const auto track2 =
+          tracks2.find(std::make_pair(feature->x(), feature->y()));
+      if (track2 != tracks2.end()) {
+        ++num_shared_observations[std::make_pair(track_id1, track2->second)];
+      }
+    }
+  }
+
+  std::vector<std::pair<TrackId, TrackId> > shared_tracks;
+  for (const auto& shared_track : num_shared_observations) {
+    if (shared_track.second >= options.min_num_shared_observations) {
+      shared_tracks.emplace_back(shared_track.first);
+    }
+  }
+  std::sort(shared_tracks.begin(), shared_tracks.end());
+  for (const auto& shared_track : shared_tracks) {
+    points1->emplace_back(
+        reconstruction1.Track(shared_track.first)->Point().hnormalized());
+    points2->emplace_back(
+        reconstruction2.Track(shared_track.second)->Point().hnormalized());
+  }
+}
+
+// Robustly aligns the second reconstruction of the pair to the first. Returns
+// false if the pair has too few inlier correspondences.
+bool AlignPair(const MultipleReconstructionAlignmentOptions& options,
+               const std::vector<Reconstruction*>& reconstructions,
+               const ReconstructionPair& pair,
+               const int pair_index,
+               PairAlignment* alignment) {
+  std::vector<Eigen::Vector3d> points1, points2;
+  FindCorrespondences(options,
+                      *reconstructions[pair.index1],
+                      *reconstructions[pair.index2],
+                      pair,
+                      &points1,
+                      &points2);
+  if (points1.size() < std::max(options.min_num_correspondences, 4)) {
+    return false;
+  }
+
+  alignment->index1 = pair.index1;
+  alignment->index2 = pair.index2;
+  alignment->error_threshold =
+      options.relative_error_threshold * MedianDistanceToCentroid(points1);
+  if (alignment->error_threshold <= 0.0) {
+    return false;
+  }
+
+  const auto rng = std::make_shared<RandomNumberGenerator>(
+      options.random_seed, static_cast<uint64_t>(pair_index));
+  std::vector<int> inliers;
+  if (!EstimateSimilarityTransformationRobust(alignment->error_threshold,
+                                              points1,
+                                              points2,
+                                              rng,
+                                              &alignment->transformation,
+                                              &inliers) ||
+      inliers.size() < options.min_num_correspondences) {
+    return false;
+  }
+  alignment->num_inliers = inliers.size();
+
+  const int num_correspondences = std::min<int>(
+      inliers.size(), options.max_num_correspondences_per_pair);
+  alignment->points1.reserve(num_correspondences);
+  alignment->points2.reserve(num_correspondences);
+  for (int i = 0; i < num_correspondences; i++) {
+    const int inlier = inliers[static_cast<int64_t>(i) * inliers.size() /
+                               num_correspondences];
+    alignment->points1.emplace_back(points1[inlier]);
+    alignment->points2.emplace_back(points2[inlier]);
+  }
+  return true;
+}
+
+// Initializes the transformations along the maximum spanning tree of the
+// aligned pairs, weighted by their number of inliers, that is rooted at the
+// reference reconstruction.
+void InitializeTransformations(
+    const std::vector<PairAlignment>& alignments,
+    const int reference,
+    std::vector<SimilarityTransformation>* transformations,
+    std::vector<bool>* aligned) {
+  (*aligned)[reference] = true;
+  while (true) {
+    int best_alignment = -1;
+    for (int i = 0; i < alignments.size(); i++) {
+      const PairAlignment& alignment = alignments[i];
+      if ((*aligned)[alignment.index1] != (*aligned)[alignment.index2] &&
+          (best_alignment == -1 ||
+           alignment.num_inliers > alignments[best_alignment].num_inliers)) {
+        best_alignment = i;
+      }
+    }
+    if (best_alignment == -1) {
+      return;
+    }
+
+    // The pair transformation maps the second reconstruction into the first.
+    const PairAlignment& alignment = alignments[best_alignment];
+    if ((*aligned)[alignment.index1]) {
+      (*transformations)[alignment.index2] = Compose(
+          (*transformations)[alignment.index1], alignment.transformation);
+      (*aligned)[alignment.index2] = true;
+    } else {
+      (*transformations)[alignment.index1] =
+          Compose((*transformations)[alignment.index2],
+                  Invert(alignment.transformation));
+      (*aligned)[alignment.index1] = true;
+    }
+  }
+}
+
+// Refines the transformations of the aligned reconstructions jointly with the
+// inlier correspondences of all aligned pairs.
+void OptimizeTransformations(
+    const MultipleReconstructionAlignmentOptions& options,
+    const std::vector<PairAlignment>& alignments,
+    const std::vector<bool>& aligned,
+    std::vector<SimilarityTransformation>* transformations) {
+  std::vector<Eigen::Matrix<double, kNumSimilarityParameters, 1> > parameters(
+      transformations->size());
+  for (int i = 0; i < transformations->size(); i++) {
+    const SimilarityTransformation& transformation = (*transformations)[i];
+    ceres::RotationMatrixToAngleAxis(
+        ceres::ColumnMajorAdapter3x3(transformation.rotation.data()),
+        parameters[i].data());
+    parameters[i].segment<3>(3) = transformation.translation;
+    parameters[i][6] = std::log(transformation.scale);
+  }
+
+  // The residuals are in units of the inlier thresholds, so all pairs share
+  // the loss function.
+  ceres::Problem problem;
+  ceres::LossFunction* loss_function =
+      new ceres::HuberLoss(options.robust_loss_width);
+  for (const PairAlignment& alignment : alignments) {
+    if (!aligned[alignment.index1] || !aligned[alignment.index2]) {
+      continue;
+    }
+    for (int i = 0; i < alignment.points1.size(); i++) {
+      problem.AddResidualBlock(
+          SimilarityAlignmentError::Create(alignment.points1[i],
+                                           alignment.points2[i],
+                                           alignment.error_threshold),
+          loss_function,
+          parameters[alignment.index1].data(),
+          parameters[alignment.index2].data());
+    }
+  }
+  problem.SetParameterBlockConstant(
+      parameters[options.reference_reconstruction].data());
+
+  // Each reconstruction only shares correspondences with the few it overlaps,
+  // so the normal equations are sparse.
+  ceres::Solver::Options solver_options;
+  solver_options.linear_solver_type = ceres::SPARSE_NORMAL_CHOLESKY;
+  solver_options.max_num_iterations = options.max_num_iterations;
+  solver_options.num_threads = options.num_threads;
+  ceres::Solver::Summary solver_summary;
+  ceres::Solve(solver_options, &problem, &solver_summary);
+  VLOG(1) << solver_summary.FullReport();
+  if (!solver_summary.IsSolutionUsable()) {
+    LOG(WARNING) << "The joint alignment failed. The reconstructions are "
+                    "aligned by the pairwise alignments.";
+    return;
+  }
+
+  for (int i = 0; i < transformations->size(); i++) {
+    if (!aligned[i]) {
+      continue;
+    }
+    SimilarityTransformation& transformation = (*transformations)[i];
+    ceres::AngleAxisToRotationMatrix(
+        parameters[i].data(),
+        ceres::ColumnMajorAdapter3x3(transformation.rotation.data()));
+    transformation.translation = parameters[i].segment<3>(3);
+    transformation.scale = std::exp(parameters[i][6]);
+  }
+}
+
+}  // namespace
+
+bool AlignMultipleReconstructions(
+    const MultipleReconstructionAlignmentOptions& options,
+    const std::vector<Reconstruction*>& reconstructions,
+    MultipleReconstructionAlignmentSummary* summary) {
+  CHECK_NOTNULL(summary);
+  CHECK_GE(options.reference_reconstruction, 0);
+  CHECK_LT(options.reference_reconstruction, reconstructions.size());
+  for (const Reconstruction* reconstruction : reconstructions) {
+    CHECK_NOTNULL(reconstruction);
+  }
+
+  // Align all pairs of reconstructions that share views.
+  const std::vector<ReconstructionPair> pairs =
+      FindReconstructionPairs(reconstructions);
+  std::vector<PairAlignment> pair_alignments(pairs.size());
+  std::vector<char> pair_aligned(pairs.size(), false);
+  ParallelFor(options.num_threads,
+              pairs.size(),
+              [&](const int start, const int end) {
+                for (int i = start; i < end; i++) {
+                  pair_aligned[i] = AlignPair(options,
+                                              reconstructions,
+                                              pairs[i],
+                                              i,
+                                              &pair_alignments[i]);
+                }
+              });
+  std::vector<PairAlignment> alignments;
+  for (int i = 0; i < pairs.size(); i++) {
+    if (pair_aligned[i]) {
+      alignments.emplace_back(std::move(pair_alignments[i]));
+    }
+  }
+  VLOG(2) << alignments.size() << " of " << pairs.size()
+          << " pairs of reconstructions were aligned.";
+
+  summary->transformations.assign(reconstructions.size(),
+                                  IdentityTransformation());
+  summary->aligned.assign(reconstructions.size(), false);
+  InitializeTransformations(alignments,
+                            options.reference_reconstruction,
+                            &summary->transformations,
+                            &summary->aligned);
+  summary->num_aligned_pairs = 0;
+  for (const PairAlignment& alignment : alignments) {
+    if (summary->aligned[alignment.index1] &&
+        summary->aligned[alignment.index2]) {
+      ++summary->num_aligned_pairs;
+    }
+  }
+  if (summary->num_aligned_pairs > 0) {
+    OptimizeTransformations(options,
+                            alignments,
+                            summary->aligned,
+                            &summary->transformations);
+  }
+
+  bool all_aligned = true;
+  for (int i = 0; i < reconstructions.size(); i++) {
+    if (!summary->aligned[i]) {
+      all_aligned = false;
+      continue;
+    }
+    if (i != options.reference_reconstruction) {
+      const SimilarityTransformation& transformation =
+          summary->transformations[i];
+      TransformReconstruction(transformation.rotation,
+                              transformation.translation,
+                              transformation.scale,
+                              options.num_threads,
+                              reconstructions[i]);
+    }
+  }
+  return all_aligned;
+}
+
+}  // namespace theia
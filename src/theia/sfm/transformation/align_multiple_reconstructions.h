@@ -0,0 +1,114 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#ifndef THEIA_SFM_TRANSFORMATION_ALIGN_MULTIPLE_RECONSTRUCTIONS_H_
+#define THEIA_SFM_TRANSFORMATION_ALIGN_MULTIPLE_RECONSTRUCTIONS_H_
+
+#include <vector>
+
+#include "theia/sfm/similarity_transformation.h"
+
+namespace theia {
+class Reconstruction;
+
+struct MultipleReconstructionAlignmentOptions {
+  // The number of threads used to align the pairs of reconstructions, to
+  // solve the joint alignment and to transform the reconstructions.
+  int num_threads = 1;
+
+  // The reconstruction whose coordinate frame all others are aligned to.
+  int reference_reconstruction = 0;
+
+  // Two reconstructions are aligned if they have at least this many inlier
+  // correspondences. Each estimated view the reconstructions share (by name)
+  // gives a correspondence between its camera positions, and so does each
+  // pair of estimated tracks with the same features in the shared views.
+  int min_num_correspondences = 4;
+
+  // Whether tracks are used as correspondences in addition to the views, and
+  // the number of shared views in which two tracks must have the same features
+  // to correspond.
+  bool use_shared_tracks = true;
+  int min_num_shared_observations = 2;
+
+  // The RANSAC inlier threshold of a pair of reconstructions, relative to the
+  // median distance of its correspondences to their centroid.
+  double relative_error_threshold = 0.1;
+
+  // At most this many inlier correspondences of each pair, taken evenly, are
+  // used in the joint alignment.
+  int max_num_correspondences_per_pair = 200;
+
+  // The width of the Huber loss of the joint alignment, in units of the inlier
+  // threshold of the pair.
+  double robust_loss_width = 1.0;
+  int max_num_iterations = 100;
+
+  // The seed of the RANSAC samples of the pairs. Each pair draws from its own
+  // stream, so the result does not depend on the number of threads.
+  unsigned random_seed = 67;
+};
+
+struct MultipleReconstructionAlignmentSummary {
+  // The similarity transformation that was applied to each reconstruction to
+  // move it into the frame of the reference reconstruction.
+  std::vector<SimilarityTransformation> transformations;
+
+  // Whether each reconstruction is connected to the reference reconstruction
+  // by aligned pairs and was transformed. Unaligned reconstructions are left
+  // unchanged and have identity transformations.
+  std::vector<bool> aligned;
+
+  // The number of aligned pairs of reconstructions in the joint alignment.
+  int num_aligned_pairs = 0;
+};
+
+// Aligns the reconstructions to the reference reconstruction. Every pair of
+// reconstructions that shares views is aligned robustly with RANSAC over the
+// camera positions of the shared views and the points of the shared tracks, in
+// parallel. The similarity transformations of all reconstructions are then
+// estimated jointly from the inlier correspondences of all pairs in one sparse
+// nonlinear least squares problem, initialized from a maximum spanning tree of
+// the pairs (by number of inliers) rooted at the reference. This distributes
+// the alignment error over all overlaps instead of accumulating it along a
+// sequence of pairwise merges. Returns true if all reconstructions were
+// aligned.
+bool AlignMultipleReconstructions(
+    const MultipleReconstructionAlignmentOptions& options,
+    const std::vector<Reconstruction*>& reconstructions,
+    MultipleReconstructionAlignmentSummary* summary);
+
+}  // namespace theia
+
+#endif  // THEIA_SFM_TRANSFORMATION_ALIGN_MULTIPLE_RECONSTRUCTIONS_H_
@@ -0,0 +1,213 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#include <Eigen/Core>
+#include <Eigen/Geometry>
+#include <glog/logging.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "theia/sfm/reconstruction.h"
+#include "theia/sfm/transformation/align_multiple_reconstructions.h"
+#include "theia/sfm/transformation/transform_reconstruction.h"
+#include "theia/sfm/types.h"
+#include "theia/util/random.h"
+#include "theia/util/stringprintf.h"
+
+namespace theia {
+
+namespace {
+
+static const int kNumViews = 12;
+static const int kNumTracks = 100;
+
+struct Scene {
+  std::vector<Camera> cameras;
+  std::vector<Eigen::Vector3d> points;
+};
+
+Scene BuildScene(RandomNumberGenerator* rng) {
+  Scene scene;
+  for (int i = 0; i < kNumViews; i++) {
+    Camera camera;
+    camera.SetPosition(10.0 * rng->RandVector3d());
+    camera.SetOrientationFromAngleAxis(0.2 * rng->RandVector3d());
+    scene.cameras.emplace_back(camera);
+  }
+  for (int i = 0; i < kNumTracks; i++) {
+    scene.points.emplace_back(5.0 * rng->RandVector3d());
+  }
+  return scene;
+}
+
+// Adds the views of the scene in [first_view, last_view] and all tracks, and
+// moves the reconstruction into a random frame. Track i has the feature (i, j)
+// in view j, so the tracks of different reconstructions correspond through
+// their features.
+std::unique_ptr<Reconstruction> BuildReconstruction(
+    const Scene& scene,
+    const int first_view,
+    const int last_view,
+    const bool transform,
+    RandomNumberGenerator* rng) {
+  std::unique_ptr<Reconstruction> reconstruction(new Reconstruction);
+  std::vector<ViewId> view_ids;
+  for (int i = first_view; i <= last_view; i++) {
+    const ViewId view_id = reconstruction->AddView(StringPrintf("%d", i), i);
+    *reconstruction->MutableView(view_id)->MutableCamera() = scene.cameras[i];
+    reconstruction->MutableView(view_id)->SetEstimated(true);
+    view_ids.emplace_back(view_id);
+  }
+  for (int i = 0; i < scene.points.size(); i++) {
+    const TrackId track_id = reconstruction->AddTrack();
+    for (int j = 0; j < view_ids.size(); j++) {
+      reconstruction->AddObservation(
+          view_ids[j], track_id, Feature(i, first_view + j));
+    }
+    Track* track = reconstruction->MutableTrack(track_id);
+    *track->MutablePoint() = scene.points[i].homogeneous();
+    track->SetEstimated(true);
+  }
+
+  if (transform) {
+    const Eigen::Matrix3d rotation =
+        Eigen::AngleAxisd(rng->RandDouble(-3.0, 3.0),
+                          rng->RandVector3d().normalized())
+            .toRotationMatrix();
+    TransformReconstruction(rotation,
+                            10.0 * rng->RandVector3d(),
+                            rng->RandDouble(0.2, 5.0),
+                            reconstruction.get());
+  }
+  return reconstruction;
+}
+
+void VerifyAlignment(const Scene& scene, const Reconstruction& reconstruction) {
+  static const double kTolerance = 1e-6;
+  for (const ViewId view_id : reconstruction.ViewIds()) {
+    const View* view = reconstruction.View(view_id);
+    const Camera& camera = scene.cameras[std::stoi(view->Name())];
+    EXPECT_LT((view->Camera().GetPosition() - camera.GetPosition()).norm(),
+              kTolerance);
+    EXPECT_LT((view->Camera().GetOrientationAsRotationMatrix() -
+               camera.GetOrientationAsRotationMatrix())
+                  .norm(),
+              kTolerance);
+  }
+  for (const TrackId track_id : reconstruction.TrackIds()) {
+    EXPECT_LT((reconstruction.Track(track_id)->Point().hnormalized() -
+               scene.points[track_id])
+                  .norm(),
+              kTolerance);
+  }
+}
+
+}  // namespace
+
+TEST(AlignMultipleReconstructions, ChainOfReconstructions) {
+  RandomNumberGenerator rng(59);
+  const Scene scene = BuildScene(&rng);
+
+  // Neighboring reconstructions share two views, which are too few to align
+  // them by their cameras alone.
+  std::vector<std::unique_ptr<Reconstruction> > reconstructions;
+  reconstructions.emplace_back(BuildReconstruction(scene, 0, 4, false, &rng));
+  reconstructions.emplace_back(BuildReconstruction(scene, 3, 8, true, &rng));
+  reconstructions.emplace_back(BuildReconstruction(scene, 7, 11, true, &rng));
+  std::vector<Reconstruction*> reconstruction_ptrs;
+  for (const auto& reconstruction : reconstructions) {
+    reconstruction_ptrs.emplace_back(reconstruction.get());
+  }
+
+  MultipleReconstructionAlignmentOptions options;
+  options.num_threads = 2;
+  MultipleReconstructionAlignmentSummary summary;
+  EXPECT_TRUE(
+      AlignMultipleReconstructions(options, reconstruction_ptrs, &summary));
+  EXPECT_EQ(summary.num_aligned_pairs, 2);
+  for (const auto& reconstruction : reconstructions) {
+    VerifyAlignment(scene, *reconstruction);
+  }
+
+  // Without the tracks, the pairs do not have enough correspondences.
+  reconstructions[1] = BuildReconstruction(scene, 3, 8, true, &rng);
+  reconstruction_ptrs[1] = reconstructions[1].get();
+  options.use_shared_tracks = false;
+  EXPECT_FALSE(
+      AlignMultipleReconstructions(options, reconstruction_ptrs, &summary));
+  EXPECT_EQ(summary.aligned, std::vector<bool>({true, false, false}));
+}
+
+TEST(AlignMultipleReconstructions, OutlierCorrespondences) {
+  RandomNumberGenerator rng(61);
+  const Scene scene = BuildScene(&rng);
+
+  std::vector<std::unique_ptr<Reconstruction> > reconstructions;
+  reconstructions.emplace_back(BuildReconstruction(scene, 0, 7, true, &rng));
+  reconstructions.emplace_back(BuildReconstruction(scene, 2, 11, true, &rng));
+  reconstructions.emplace_back(BuildReconstruction(scene, 0, 11, false, &rng));
+
+  // Move some tracks of the first reconstruction away from the scene.
+  for (TrackId track_id = 0; track_id < 10; track_id++) {
+    Eigen::Vector4d* point =
+        reconstructions[0]->MutableTrack(track_id)->MutablePoint();
+    point->head<3>() += 100.0 * rng.RandVector3d() * point->w();
+  }
+
+  MultipleReconstructionAlignmentOptions options;
+  options.reference_reconstruction = 2;
+  MultipleReconstructionAlignmentSummary summary;
+  EXPECT_TRUE(AlignMultipleReconstructions(
+      options,
+      {reconstructions[0].get(),
+       reconstructions[1].get(),
+       reconstructions[2].get()},
+      &summary));
+  EXPECT_EQ(summary.num_aligned_pairs, 3);
+  for (const ViewId view_id : reconstructions[0]->ViewIds()) {
+    EXPECT_LT((reconstructions[0]->View(view_id)->Camera().GetPosition() -
+               scene.cameras[std::stoi(reconstructions[0]
+                                           ->View(view_id)
+                                           ->Name())]
+                   .GetPosition())
+                  .norm(),
+              1e-6);
+  }
+  VerifyAlignment(scene, *reconstructions[1]);
+}
+
+}  // namespace theia
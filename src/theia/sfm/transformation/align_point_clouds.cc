@@ -44,9 +44,14 @@ void AlignPointCloudsUmeyama(const std::vector<Eigen::Vector3d>& left,
                              Eigen::Matrix3d* rotation,
                              Eigen::Vector3d* translation,
                              double* scale) {
-  std::vector<double> weights(left.size(), 1.0);
-  AlignPointCloudsUmeyamaWithWeights(
-      left, right, weights, rotation, translation, scale);
+  CHECK_EQ(left.size(), right.size());
+  AlignPointCloudsUmeyama(left.size(),
+                          left.data(),
+                          right.data(),
+                          nullptr,
+                          rotation,
+                          translation,
+                          scale);
 }
 
 void AlignPointCloudsUmeyamaWithWeights(
@@ -58,6 +63,22 @@ void AlignPointCloudsUmeyamaWithWeights(
     double* scale) {
   CHECK_EQ(left.size(), right.size());
   CHECK_EQ(left.size(), weights.size());
+  AlignPointCloudsUmeyama(left.size(),
+                          left.data(),
+                          right.data(),
+                          weights.data(),
+                          rotation,
+                          translation,
+                          scale);
+}
+
+void AlignPointCloudsUmeyama(const int num_points,
+                             const Eigen::Vector3d* left,
+                             const Eigen::Vector3d* right,
+                             const double* weights,
+                             Eigen::Matrix3d* rotation,
+                             Eigen::Vector3d* translation,
+                             double* scale) {
   CHECK_NOTNULL(rotation);
   CHECK_NOTNULL(translation);
   CHECK_NOTNULL(scale);
@@ -67,22 +88,16 @@ void AlignPointCloudsUmeyamaWithWeights(
   *translation = Eigen::Vector3d::Zero();
   *rotation = Eigen::Matrix3d::Identity();
 
-  const size_t num_points = left.size();
-  Eigen::Map<const Eigen::Matrix<double, 3, Eigen::Dynamic> > left_points(
-      left[0].data(), 3, num_points);
-  Eigen::Map<const Eigen::Matrix<double, 3, Eigen::Dynamic> > right_points(
-      right[0].data(), 3, num_points);
-
   Eigen::Vector3d left_centroid, right_centroid;
   left_centroid.setZero();
   right_centroid.setZero();
   double weights_sum = 0.0;
-  for (size_t i = 0; i < num_points; i++) {
-    CHECK_GE(weights[i], 0)
-        << "The point weight must be greater or equal to zero.";
-    weights_sum += weights[i];
-    left_centroid += left[i] * weights[i];
-    right_centroid += right[i] * weights[i];
+  for (int i = 0; i < num_points; i++) {
+    const double weight = weights == nullptr ? 1.0 : weights[i];
+    CHECK_GE(weight, 0) << "The point weight must be greater or equal to zero.";
+    weights_sum += weight;
+    left_centroid += left[i] * weight;
+    right_centroid += right[i] * weight;
   }
   // Check if the sum is valid
   CHECK_GT(weights_sum, 0) << "The sum of weights must be greater than zero.";
@@ -90,19 +105,18 @@ void AlignPointCloudsUmeyamaWithWeights(
   left_centroid /= weights_sum;
   right_centroid /= weights_sum;
 
+  // Calculate the variance of the left points and the cross correlation matrix
+  // based on the points shifted about the centroid.
   double sigma = 0.0;
-  for (size_t i = 0; i < num_points; i++) {
-    sigma += (left[i] - left_centroid).squaredNorm() * weights[i];
-  }
-  sigma /= weights_sum;
-
-  // Calculate cross correlation matrix based on the points shifted about the
-  // centroid.
   Eigen::Matrix3d cross_correlation = Eigen::Matrix3d::Zero();
   for (int i = 0; i < num_points; i++) {
-    cross_correlation += weights[i] * (left_points.col(i) - left_centroid) *
-                         (right_points.col(i) - right_centroid).transpose();
+    const double weight = weights == nullptr ? 1.0 : weights[i];
+    const Eigen::Vector3d centered_left = left[i] - left_centroid;
+    sigma += centered_left.squaredNorm() * weight;
+    cross_correlation +=
+        weight * centered_left * (right[i] - right_centroid).transpose();
   }
+  sigma /= weights_sum;
   cross_correlation /= weights_sum;
 
   // Compute SVD decomposition of the cross correlation.
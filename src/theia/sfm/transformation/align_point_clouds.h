@@ -66,6 +66,16 @@ void AlignPointCloudsUmeyamaWithWeights(
     Eigen::Vector3d* translation,
     double* scale);
 
+// Same as AlignPointCloudsUmeyamaWithWeights for the num_points points of the
+// arrays, without allocating. All points have weight 1 if weights is null.
+void AlignPointCloudsUmeyama(const int num_points,
+                             const Eigen::Vector3d* left,
+                             const Eigen::Vector3d* right,
+                             const double* weights,
+                             Eigen::Matrix3d* rotation,
+                             Eigen::Vector3d* translation,
+                             double* scale);
+
 }  // namespace theia
 
 #endif  // THEIA_SFM_TRANSFORMATION_ALIGN_POINT_CLOUDS_H_
@@ -96,6 +96,13 @@ class CameraAlignmentEstimator
 
 SimilarityTransformation AlignReconstructions(
     const Reconstruction& reconstruction1, Reconstruction* reconstruction2) {
+  return AlignReconstructions(reconstruction1, 1, reconstruction2);
+}
+
+SimilarityTransformation AlignReconstructions(
+    const Reconstruction& reconstruction1,
+    const int num_threads,
+    Reconstruction* reconstruction2) {
   CHECK_NOTNULL(reconstruction2);
 
   const std::vector<std::string> common_view_names =
@@ -121,7 +128,8 @@ SimilarityTransformation AlignReconstructions(
       positions2, positions1, &rotation, &translation, &scale);
 
   // Apply the similarity transformation to the reconstruction.
-  TransformReconstruction(rotation, translation, scale, reconstruction2);
+  TransformReconstruction(
+      rotation, translation, scale, num_threads, reconstruction2);
 
   SimilarityTransformation result;
   result.rotation = rotation;
@@ -134,66 +142,106 @@ SimilarityTransformation AlignReconstructionsRobust(
     const double robust_error_threshold,
     const Reconstruction& reconstruction1,
     Reconstruction* reconstruction2) {
+  return AlignReconstructionsRobust(
+      robust_error_threshold, reconstruction1, 1, reconstruction2);
+}
+
+SimilarityTransformation AlignReconstructionsRobust(
+    const double robust_error_threshold,
+    const Reconstruction& reconstruction1,
+    const int num_threads,
+    Reconstruction* reconstruction2) {
   CHECK_NOTNULL(reconstruction2);
 
   const std::vector<std::string> common_view_names =
       FindCommonViewsByName(reconstruction1, *reconstruction2);
 
   // Collect the positions of all common views.
-  std::vector<CameraCorrespondence> correspondences(common_view_names.size());
+  std::vector<Eigen::Vector3d> positions1(common_view_names.size());
+  std::vector<Eigen::Vector3d> positions2(common_view_names.size());
   for (int i = 0; i < common_view_names.size(); i++) {
     const ViewId view_id1 =
         reconstruction1.ViewIdFromName(common_view_names[i]);
     const ViewId view_id2 =
         reconstruction2->ViewIdFromName(common_view_names[i]);
-    correspondences[i].camera1 =
-        reconstruction1.View(view_id1)->Camera().GetPosition();
-    correspondences[i].camera2 =
-        reconstruction2->View(view_id2)->Camera().GetPosition();
+    positions1[i] = reconstruction1.View(view_id1)->Camera().GetPosition();
+    positions2[i] = reconstruction2->View(view_id2)->Camera().GetPosition();
+  }
+
+  SimilarityTransformation sim_transform;
+  std::vector<int> inliers;
+  CHECK(EstimateSimilarityTransformationRobust(robust_error_threshold,
+                                               positions1,
+                                               positions2,
+                                               nullptr,
+                                               &sim_transform,
+                                               &inliers))
+      << "Could not align models with RANSAC. Try using a higher error "
+         "threshold.";
+
+  // Apply the similarity transformation to the reconstruction.
+  TransformReconstruction(sim_transform.rotation,
+                          sim_transform.translation,
+                          sim_transform.scale,
+                          num_threads,
+                          reconstruction2);
+
+  return sim_transform;
+}
+
+bool EstimateSimilarityTransformationRobust(
+    const double error_threshold,
+    const std::vector<Eigen::Vector3d>& points1,
+    const std::vector<Eigen::Vector3d>& points2,
+    const std::shared_ptr<RandomNumberGenerator>& rng,
+    SimilarityTransformation* similarity_transformation,
+    std::vector<int>* inliers) {
+  CHECK_EQ(points1.size(), points2.size());
+  CHECK_NOTNULL(similarity_transformation);
+  CHECK_NOTNULL(inliers)->clear();
+
+  std::vector<CameraCorrespondence> correspondences(points1.size());
+  for (int i = 0; i < points1.size(); i++) {
+    correspondences[i].camera1 = points1[i];
+    correspondences[i].camera2 = points2[i];
   }
 
   // Estimate with RANSAC.
   RansacParameters params;
+  params.rng = rng;
   params.max_iterations = 1000;
   params.use_mle = true;
-  params.error_thresh = robust_error_threshold * robust_error_threshold;
+  params.error_thresh = error_threshold * error_threshold;
   params.failure_probability = 1e-4;
 
   CameraAlignmentEstimator estimator;
   Ransac<CameraAlignmentEstimator> ransac(params, estimator);
-  CHECK(ransac.Initialize()) << "Could not initialize RANSAC for similarity "
-                                "transformation estimation.";
-  SimilarityTransformation sim_transform;
+  if (!ransac.Initialize()) {
+    LOG(ERROR) << "Could not initialize RANSAC for similarity transformation "
+                  "estimation.";
+    return false;
+  }
   RansacSummary summary;
-  CHECK(ransac.Estimate(correspondences, &sim_transform, &summary))
-      << "Could not align models with RANSAC";
-  CHECK_GT(summary.inliers.size(), 0)
-      << "No inliers could be found for estimating the similarity "
-         "transformation. Try using a higher error threshold.";
-
-  // Align the reconstructions using the inliers.
-  std::vector<Eigen::Vector3d> positions1(summary.inliers.size());
-  std::vector<Eigen::Vector3d> positions2(summary.inliers.size());
-  for (int i = 0; i < summary.inliers.size(); i++) {
-    positions1[i] = correspondences[summary.inliers[i]].camera1;
-    positions2[i] = correspondences[summary.inliers[i]].camera2;
+  if (!ransac.Estimate(
+          correspondences, similarity_transformation, &summary) ||
+      summary.inliers.empty()) {
+    return false;
   }
 
-  // Align the positions.
-  Eigen::Matrix3d rotation;
-  Eigen::Vector3d translation;
-  double scale;
-  AlignPointCloudsUmeyama(
-      positions2, positions1, &rotation, &translation, &scale);
-
-  // Apply the similarity transformation to the reconstruction.
-  TransformReconstruction(rotation, translation, scale, reconstruction2);
-
-  SimilarityTransformation result;
-  result.rotation = rotation;
-  result.translation = translation;
-  result.scale = scale;
-  return result;
+  // Refine the alignment using the inliers.
+  std::vector<Eigen::Vector3d> inlier_points1(summary.inliers.size());
+  std::vector<Eigen::Vector3d> inlier_points2(summary.inliers.size());
+  for (int i = 0; i < summary.inliers.size(); i++) {
+    inlier_points1[i] = points1[summary.inliers[i]];
+    inlier_points2[i] = points2[summary.inliers[i]];
+  }
+  AlignPointCloudsUmeyama(inlier_points2,
+                          inlier_points1,
+                          &similarity_transformation->rotation,
+                          &similarity_transformation->translation,
+                          &similarity_transformation->scale);
+  *inliers = summary.inliers;
+  return true;
 }
 
 }  // namespace theia
@@ -37,8 +37,11 @@
 
 #include "theia/sfm/similarity_transformation.h"
 #include <Eigen/Core>
+#include <memory>
+#include <vector>
 
 namespace theia {
+class RandomNumberGenerator;
 class Reconstruction;
 
 // Aligns the reconstructions so that their commons cameras have the closest
@@ -46,6 +49,10 @@ class Reconstruction;
 // Also returns the alignment result, i.e. rotation, translation and scale.
 SimilarityTransformation AlignReconstructions(
     const Reconstruction& reconstruction1, Reconstruction* reconstruction2);
+SimilarityTransformation AlignReconstructions(
+    const Reconstruction& reconstruction1,
+    const int num_threads,
+    Reconstruction* reconstruction2);
 
 // Aligns the reconstructions so that their commons cameras have the closest
 // positions. This method is robust by using RANSAC to compute similarity
@@ -58,6 +65,26 @@ SimilarityTransformation AlignReconstructionsRobust(
     const Reconstruction& reconstruction1,
     Reconstruction* reconstruction2);
 
+// Same as above, but reconstruction2 is transformed with num_threads threads.
+SimilarityTransformation AlignReconstructionsRobust(
+    const double robust_error_threshold,
+    const Reconstruction& reconstruction1,
+    const int num_threads,
+    Reconstruction* reconstruction2);
+
+// Estimates the similarity transformation that maps points2 onto points1 with
+// RANSAC and refines it on the inliers, i.e. the correspondences that are less
+// than error_threshold apart after the transformation. RANSAC draws its samples
+// from rng unless it is null. Returns false if no transformation could be
+// estimated.
+bool EstimateSimilarityTransformationRobust(
+    const double error_threshold,
+    const std::vector<Eigen::Vector3d>& points1,
+    const std::vector<Eigen::Vector3d>& points2,
+    const std::shared_ptr<RandomNumberGenerator>& rng,
+    SimilarityTransformation* similarity_transformation,
+    std::vector<int>* inliers);
+
 }  // namespace theia
 
 #endif  // THEIA_SFM_TRANSFORMATION_ALIGN_RECONSTRUCTIONS_H_
@@ -37,6 +37,7 @@
 #include <Eigen/Core>
 #include <Eigen/Eigenvalues>
 #include <Eigen/Geometry>
+#include <Eigen/LU>
 #include <cmath>
 #include <glog/logging.h>
 #include <vector>
@@ -53,7 +54,6 @@ using dls_impl::LeftMultiplyMatrix;
 using Eigen::Matrix;
 using Eigen::Matrix3d;
 using Eigen::Matrix4d;
-using Eigen::MatrixXd;
 using Eigen::Quaterniond;
 using Eigen::Vector3d;
 
@@ -65,15 +65,17 @@ using Eigen::Vector3d;
 // cost function, and solve these equations via a Macaulay matrix to obtain the
 // roots (i.e., the 3 parameters of rotation). The translation and scale can
 // then be obtained through back-substitution.
-void GdlsSimilarityTransform(const std::vector<Vector3d>& ray_origin,
-                             const std::vector<Vector3d>& ray_direction,
-                             const std::vector<Vector3d>& world_point,
-                             std::vector<Quaterniond>* solution_rotation,
-                             std::vector<Vector3d>* solution_translation,
-                             std::vector<double>* solution_scale) {
-  CHECK_GE(ray_direction.size(), 4);
+//
+// All matrices have fixed sizes, so this does not allocate.
+void GdlsSimilarityTransform(const int num_correspondences,
+                             const Vector3d* ray_origin,
+                             const Vector3d* ray_direction,
+                             const Vector3d* world_point,
+                             RandomNumberGenerator* rng,
+                             GdlsSolutions* solutions) {
+  CHECK_GE(num_correspondences, 4);
+  CHECK_NOTNULL(solutions)->num_solutions = 0;
 
-  const int num_correspondences = ray_direction.size();
   // The bottom-right symmetric block matrix of inverse(A^T * A). This is the
   // generalized version of Matrix H from Eq. 17 in the Appendix of the gDLS
   // paper (note that term appears exactly in the bottom right 3x3 of this
@@ -146,26 +148,41 @@ void GdlsSimilarityTransform(const std::vector<Vector3d>& ray_origin,
 
   // We create one equation with random terms that is generally non-zero at the
   // roots of our system.
-  const Eigen::Vector4d rand_vec = 100.0 * Eigen::Vector4d::Random();
+  Eigen::Vector4d rand_vec;
+  if (rng == nullptr) {
+    rand_vec = 100.0 * Eigen::Vector4d::Random();
+  } else {
+    for (int i = 0; i < 4; i++) {
+      rand_vec(i) = rng->RandDouble(-100.0, 100.0);
+    }
+  }
   const double macaulay_term[4] = {
       rand_vec(0), rand_vec(1), rand_vec(2), rand_vec(3)};
 
   // Create Macaulay matrix that will be used to solve our polynonomial system.
-  const MatrixXd& macaulay_matrix =
-      CreateMacaulayMatrix(f1_coeff, f2_coeff, f3_coeff, macaulay_term);
+  Matrix<double, 120, 120> macaulay_matrix;
+  CreateMacaulayMatrix(f1_coeff,
+                       f2_coeff,
+                       f3_coeff,
+                       macaulay_term,
+                       macaulay_matrix.data());
 
   // Via the Schur complement trick, the top-left of the Macaulay matrix
   // contains a multiplication matrix whose eigenvectors correspond to solutions
   // to our system of equations.
-  const MatrixXd solution_polynomial =
-      macaulay_matrix.block<27, 27>(0, 0) -
-      (macaulay_matrix.block<27, 93>(0, 27) *
-       macaulay_matrix.block<93, 93>(27, 27).partialPivLu().solve(
-           macaulay_matrix.block<93, 27>(27, 0)));
+  const Eigen::PartialPivLU<Matrix<double, 93, 93> > lu(
+      macaulay_matrix.block<93, 93>(27, 27));
+  const Matrix<double, 93, 27> schur_term =
+      lu.solve(macaulay_matrix.block<93, 27>(27, 0));
+  Matrix<double, 27, 27> solution_polynomial =
+      macaulay_matrix.block<27, 27>(0, 0);
+  solution_polynomial.noalias() -=
+      macaulay_matrix.block<27, 93>(0, 27) * schur_term;
 
   // Extract eigenvectors of the solution polynomial to obtain the roots which
   // are contained in the entries of the eigenvectors.
-  const Eigen::EigenSolver<MatrixXd> eigen_solver(solution_polynomial);
+  const Eigen::EigenSolver<Matrix<double, 27, 27> > eigen_solver(
+      solution_polynomial);
 
   // Many of the eigenvectors will contain complex solutions so we must filter
   // them to find the real solutions.
@@ -220,12 +237,35 @@ void GdlsSimilarityTransform(const std::vector<Vector3d>& ray_origin,
       }
 
       if (all_points_in_front_of_camera) {
-        solution_rotation->push_back(soln_rotation);
-        solution_translation->push_back(soln_translation);
-        solution_scale->push_back(soln_scale);
+        const int solution = solutions->num_solutions++;
+        solutions->rotation[solution] = soln_rotation;
+        solutions->translation[solution] = soln_translation;
+        solutions->scale[solution] = soln_scale;
       }
     }
   }
 }
 
+void GdlsSimilarityTransform(const std::vector<Vector3d>& ray_origin,
+                             const std::vector<Vector3d>& ray_direction,
+                             const std::vector<Vector3d>& world_point,
+                             std::vector<Quaterniond>* solution_rotation,
+                             std::vector<Vector3d>* solution_translation,
+                             std::vector<double>* solution_scale) {
+  CHECK_EQ(ray_origin.size(), ray_direction.size());
+  CHECK_EQ(world_point.size(), ray_direction.size());
+  GdlsSolutions solutions;
+  GdlsSimilarityTransform(ray_direction.size(),
+                          ray_origin.data(),
+                          ray_direction.data(),
+                          world_point.data(),
+                          nullptr,
+                          &solutions);
+  for (int i = 0; i < solutions.num_solutions; i++) {
+    solution_rotation->push_back(solutions.rotation[i]);
+    solution_translation->push_back(solutions.translation[i]);
+    solution_scale->push_back(solutions.scale[i]);
+  }
+}
+
 }  // namespace theia
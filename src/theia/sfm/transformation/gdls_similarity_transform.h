@@ -42,6 +42,9 @@
 #include "theia/alignment/alignment.h"
 
 namespace theia {
+
+class RandomNumberGenerator;
+
 // Computes the solution to the generalized pose and scale problem. That is,
 // given image rays from one coordinate system that correspond to 3D points in
 // another coordinate system, this function computes the rotation, translation,
@@ -72,6 +75,31 @@ void GdlsSimilarityTransform(const std::vector<Eigen::Vector3d>& ray_origin,
                              std::vector<Eigen::Quaterniond>* solution_rotation,
                              std::vector<Eigen::Vector3d>* solution_translation,
                              std::vector<double>* solution_scale);
+
+// The candidate solutions of the generalized pose and scale problem. There are
+// at most 27 of them.
+struct GdlsSolutions {
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+  static const int kMaxNumSolutions = 27;
+
+  int num_solutions = 0;
+  Eigen::Quaterniond rotation[kMaxNumSolutions];
+  Eigen::Vector3d translation[kMaxNumSolutions];
+  double scale[kMaxNumSolutions];
+};
+
+// Same as above for the num_correspondences correspondences of the arrays, with
+// fixed-size matrices only so that no memory is allocated (it uses about 250 KB
+// of stack instead). The random coefficients of the polynomial system are drawn
+// from rng, or from Eigen's global generator (which is not thread-safe) if rng
+// is null.
+void GdlsSimilarityTransform(const int num_correspondences,
+                             const Eigen::Vector3d* ray_origin,
+                             const Eigen::Vector3d* ray_direction,
+                             const Eigen::Vector3d* world_point,
+                             RandomNumberGenerator* rng,
+                             GdlsSolutions* solutions);
+
 }  // namespace theia
 
 #endif  // THEIA_SFM_TRANSFORMATION_GDLS_SIMILARITY_TRANSFORM_H_
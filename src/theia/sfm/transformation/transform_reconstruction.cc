@@ -35,12 +35,15 @@
 #include "theia/sfm/transformation/transform_reconstruction.h"
 
 #include <Eigen/Core>
+#include <vector>
 
 #include "theia/sfm/camera/camera.h"
+#include "theia/sfm/camera_rig.h"
 #include "theia/sfm/reconstruction.h"
 #include "theia/sfm/track.h"
 #include "theia/sfm/types.h"
 #include "theia/sfm/view.h"
+#include "theia/util/executor.h"
 
 namespace theia {
 namespace {
@@ -68,29 +71,56 @@ void TransformCamera(const Eigen::Matrix3d& rotation,
 
 }  // namespace
 
-// Applies the similarity transformation to the reconstruction, transforming the
-// 3d points and the cameras poses appropriately.
 void TransformReconstruction(const Eigen::Matrix3d& rotation,
                              const Eigen::Vector3d& translation,
                              const double scale,
                              Reconstruction* reconstruction) {
-  const auto& view_ids = reconstruction->ViewIds();
-  for (const ViewId view_id : view_ids) {
-    View* view = reconstruction->MutableView(view_id);
-    if (view->IsEstimated()) {
-      TransformCamera(rotation, translation, scale, view->MutableCamera());
-    }
-  }
+  TransformReconstruction(rotation, translation, scale, 1, reconstruction);
+}
 
-  const auto& track_ids = reconstruction->TrackIds();
-  for (const TrackId track_id : track_ids) {
-    Track* track = reconstruction->MutableTrack(track_id);
-    if (track->IsEstimated()) {
-      Eigen::Vector3d point = track->Point().hnormalized();
-      TransformPoint(rotation, translation, scale, &point);
-      *track->MutablePoint() = point.homogeneous();
+void TransformReconstruction(const Eigen::Matrix3d& rotation,
+                             const Eigen::Vector3d& translation,
+                             const double scale,
+                             const int num_threads,
+                             Reconstruction* reconstruction) {
+  // The views and tracks are modified in place, so each thread only touches
+  // its own entries.
+  const std::vector<ViewId> view_ids = reconstruction->ViewIds();
+  ParallelFor(num_threads,
+              view_ids.size(),
+              [&](const int start, const int end) {
+                for (int i = start; i < end; i++) {
+                  View* view = reconstruction->MutableView(view_ids[i]);
+                  if (view->IsEstimated()) {
+                    TransformCamera(
+                        rotation, translation, scale, view->MutableCamera());
+                  }
+                }
+              });
+
+  // The rig poses are transformed with the views, but the cameras of a rig
+  // keep their extrinsics relative to the rig, whose baselines must follow the
+  // scale of the reconstruction.
+  for (const CameraRigId rig_id : reconstruction->CameraRigIds()) {
+    CameraRig* camera_rig = reconstruction->MutableCameraRig(rig_id);
+    for (int i = 0; i < camera_rig->NumCameras(); i++) {
+      camera_rig->SetCameraPosition(i, scale * camera_rig->CameraPosition(i));
     }
   }
+
+  const std::vector<TrackId> track_ids = reconstruction->TrackIds();
+  ParallelFor(num_threads,
+              track_ids.size(),
+              [&](const int start, const int end) {
+                for (int i = start; i < end; i++) {
+                  Track* track = reconstruction->MutableTrack(track_ids[i]);
+                  if (track->IsEstimated()) {
+                    Eigen::Vector3d point = track->Point().hnormalized();
+                    TransformPoint(rotation, translation, scale, &point);
+                    *track->MutablePoint() = point.homogeneous();
+                  }
+                }
+              });
 }
 
 }  // namespace theia
@@ -47,6 +47,13 @@ void TransformReconstruction(const Eigen::Matrix3d& rotation,
                              const double scale,
                              Reconstruction* reconstruction);
 
+// Same as above, but transforms the views and tracks with num_threads threads.
+void TransformReconstruction(const Eigen::Matrix3d& rotation,
+                             const Eigen::Vector3d& translation,
+                             const double scale,
+                             const int num_threads,
+                             Reconstruction* reconstruction);
+
 }  // namespace theia
 
 #endif  // THEIA_SFM_TRANSFORMATION_TRANSFORM_RECONSTRUCTION_H_
@@ -93,4 +93,38 @@ void TransformReconstructionWrapper(Reconstruction& reconstruction,
   TransformReconstruction(rotation, translation, scale, &reconstruction);
 }
 
+std::tuple<bool, BatchEstimationResult> EstimateSimilarityTransformationsWrapper(
+    const RansacParameters& ransac_params,
+    const RansacType& ransac_type,
+    const Eigen::Ref<const Correspondence3D3DMatrix>& correspondences,
+    const Eigen::VectorXi& offsets,
+    const int num_threads) {
+  BatchEstimationResult result;
+  const bool success = EstimateSimilarityTransformations(ransac_params,
+                                                         ransac_type,
+                                                         correspondences,
+                                                         offsets,
+                                                         num_threads,
+                                                         &result);
+  return std::make_tuple(success, result);
+}
+
+std::tuple<bool, BatchEstimationResult>
+EstimateSimilarityTransformationsFromRaysWrapper(
+    const RansacParameters& ransac_params,
+    const RansacType& ransac_type,
+    const Eigen::Ref<const RayCorrespondenceMatrix>& correspondences,
+    const Eigen::VectorXi& offsets,
+    const int num_threads) {
+  BatchEstimationResult result;
+  const bool success =
+      EstimateSimilarityTransformationsFromRays(ransac_params,
+                                                ransac_type,
+                                                correspondences,
+                                                offsets,
+                                                num_threads,
+                                                &result);
+  return std::make_tuple(success, result);
+}
+
 }  // namespace theia
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "theia/sfm/estimators/batch_estimators.h"
 #include "theia/sfm/reconstruction.h"
 #include <Eigen/Core>
 #include <Eigen/Geometry>
@@ -42,4 +43,19 @@ void TransformReconstructionWrapper(Reconstruction& reconstruction,
                                     const Eigen::Matrix3d& rotation,
                                     const Eigen::Vector3d& translation,
                                     const double scale);
+
+std::tuple<bool, BatchEstimationResult> EstimateSimilarityTransformationsWrapper(
+    const RansacParameters& ransac_params,
+    const RansacType& ransac_type,
+    const Eigen::Ref<const Correspondence3D3DMatrix>& correspondences,
+    const Eigen::VectorXi& offsets,
+    const int num_threads);
+
+std::tuple<bool, BatchEstimationResult>
+EstimateSimilarityTransformationsFromRaysWrapper(
+    const RansacParameters& ransac_params,
+    const RansacType& ransac_type,
+    const Eigen::Ref<const RayCorrespondenceMatrix>& correspondences,
+    const Eigen::VectorXi& offsets,
+    const int num_threads);
 }  // namespace theia
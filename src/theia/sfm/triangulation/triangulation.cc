@@ -40,6 +40,7 @@
 #include <Eigen/Geometry>
 #include <Eigen/SVD>
 #include <glog/logging.h>
+#include <memory>
 #include <vector>
 
 #include "theia/matching/feature_correspondence.h"
@@ -47,6 +48,7 @@
 #include "theia/sfm/pose/essential_matrix_utils.h"
 #include "theia/sfm/pose/fundamental_matrix_util.h"
 #include "theia/sfm/pose/util.h"
+#include "theia/util/executor.h"
 
 namespace theia {
 namespace {
@@ -103,6 +105,46 @@ void FindOptimalImagePoints(const Matrix3d& ematrix,
           .hnormalized();
 }
 
+// Checks the inputs of the batch triangulation methods, triangulates every
+// point with triangulate_point(point_index, &triangulated_point) in parallel
+// and fills in the outputs.
+template <class TriangulatePointFunction>
+void TriangulateBatch(const std::vector<Matrix3x4d>& poses,
+                      const std::vector<int>& observation_offsets,
+                      const std::vector<int>& pose_indices,
+                      const std::vector<Vector2d>& points,
+                      const int num_threads,
+                      const TriangulatePointFunction& triangulate_point,
+                      std::vector<Vector4d>* triangulated_points,
+                      std::vector<bool>* success) {
+  CHECK_NOTNULL(triangulated_points);
+  CHECK_NOTNULL(success);
+  CHECK_GT(num_threads, 0);
+  CHECK(!observation_offsets.empty());
+  CHECK_EQ(observation_offsets.front(), 0);
+  CHECK_EQ(observation_offsets.back(), pose_indices.size());
+  CHECK_EQ(pose_indices.size(), points.size());
+  for (const int pose_index : pose_indices) {
+    CHECK(pose_index >= 0 && pose_index < poses.size())
+        << "Invalid pose index " << pose_index;
+  }
+
+  const int num_points = static_cast<int>(observation_offsets.size()) - 1;
+  triangulated_points->resize(num_points);
+  std::vector<char> triangulated(num_points, 0);
+
+  ParallelFor(num_threads,
+              num_points,
+              [&](const int start, const int end) {
+                for (int i = start; i < end; i++) {
+                  triangulated[i] =
+                      triangulate_point(i, &(*triangulated_points)[i]);
+                }
+              });
+
+  success->assign(triangulated.begin(), triangulated.end());
+}
+
 }  // namespace
 
 // Triangulates 2 posed views
@@ -180,7 +222,8 @@ bool TriangulateNViewSVD(const std::vector<Matrix3x4d>& poses,
                          Vector4d* triangulated_point) {
   CHECK_EQ(poses.size(), points.size());
 
-  MatrixXd design_matrix(3 * points.size(), 4 + points.size());
+  MatrixXd design_matrix =
+      MatrixXd::Zero(3 * points.size(), 4 + points.size());
 
   for (int i = 0; i < points.size(); i++) {
     design_matrix.block<3, 4>(3 * i, 0) = -poses[i].matrix();
@@ -213,6 +256,153 @@ bool TriangulateNView(const std::vector<Matrix3x4d>& poses,
   return eigen_solver.info() == Eigen::Success;
 }
 
+void TriangulateNViewBatch(const std::vector<Matrix3x4d>& poses,
+                           const std::vector<int>& observation_offsets,
+                           const std::vector<int>& pose_indices,
+                           const std::vector<Vector2d>& points,
+                           const int num_threads,
+                           std::vector<Vector4d>* triangulated_points,
+                           std::vector<bool>* success) {
+  // Since (I - n * n^t) is a projection, the cost term of TriangulateNView
+  // for an observation with normalized direction n simplifies to
+  // P^t * P - (P^t * n) * (P^t * n)^t, and P^t * P only depends on the view.
+  std::vector<Matrix4d> pose_products(poses.size());
+  for (int i = 0; i < poses.size(); i++) {
+    pose_products[i] = poses[i].transpose() * poses[i];
+  }
+
+  const auto triangulate_point = [&](const int point_index,
+                                     Vector4d* triangulated_point) {
+    const int begin = observation_offsets[point_index];
+    const int end = observation_offsets[point_index + 1];
+    if (end - begin < 2) {
+      return false;
+    }
+
+    Matrix4d design_matrix = Matrix4d::Zero();
+    for (int i = begin; i < end; i++) {
+      const Vector3d norm_point = points[i].homogeneous().normalized();
+      const Vector4d projected_direction =
+          poses[pose_indices[i]].transpose() * norm_point;
+      design_matrix += pose_products[pose_indices[i]] -
+                       projected_direction * projected_direction.transpose();
+    }
+
+    Eigen::SelfAdjointEigenSolver<Matrix4d> eigen_solver(design_matrix);
+    *triangulated_point = eigen_solver.eigenvectors().col(0);
+    return eigen_solver.info() == Eigen::Success;
+  };
+
+  TriangulateBatch(poses,
+                   observation_offsets,
+                   pose_indices,
+                   points,
+                   num_threads,
+                   triangulate_point,
+                   triangulated_points,
+                   success);
+}
+
+void TriangulateNViewSVDBatch(const std::vector<Matrix3x4d>& poses,
+                              const std::vector<int>& observation_offsets,
+                              const std::vector<int>& pose_indices,
+                              const std::vector<Vector2d>& points,
+                              const int num_threads,
+                              std::vector<Vector4d>* triangulated_points,
+                              std::vector<bool>* success) {
+  // The SVD also solves for the depth of every observation, so its size
+  // depends on the number of observations.
+  const auto triangulate_point = [&](const int point_index,
+                                     Vector4d* triangulated_point) {
+    const int begin = observation_offsets[point_index];
+    const int end = observation_offsets[point_index + 1];
+    const int num_observations = end - begin;
+    if (num_observations < 2) {
+      return false;
+    }
+
+    MatrixXd design_matrix =
+        MatrixXd::Zero(3 * num_observations, 4 + num_observations);
+    for (int i = 0; i < num_observations; i++) {
+      design_matrix.block<3, 4>(3 * i, 0) =
+          -poses[pose_indices[begin + i]].matrix();
+      design_matrix.block<3, 1>(3 * i, 4 + i) =
+          points[begin + i].homogeneous();
+    }
+
+    *triangulated_point = design_matrix.jacobiSvd(Eigen::ComputeFullV)
+                              .matrixV()
+                              .rightCols<1>()
+                              .head(4);
+    return true;
+  };
+
+  TriangulateBatch(poses,
+                   observation_offsets,
+                   pose_indices,
+                   points,
+                   num_threads,
+                   triangulate_point,
+                   triangulated_points,
+                   success);
+}
+
+void TriangulateMidpointBatch(const std::vector<Matrix3x4d>& poses,
+                              const std::vector<int>& observation_offsets,
+                              const std::vector<int>& pose_indices,
+                              const std::vector<Vector2d>& points,
+                              const int num_threads,
+                              std::vector<Vector4d>* triangulated_points,
+                              std::vector<bool>* success) {
+  // For P = [M | p], the camera center is -M^-1 * p and the ray through x is
+  // M^-1 * x.
+  std::vector<Matrix3d> inverse_ray_matrices(poses.size());
+  std::vector<Vector3d> origins(poses.size());
+  for (int i = 0; i < poses.size(); i++) {
+    inverse_ray_matrices[i] = poses[i].leftCols<3>().inverse();
+    origins[i] = -inverse_ray_matrices[i] * poses[i].col(3);
+  }
+
+  // The homogeneous coordinate of the midpoint system in TriangulateMidpoint
+  // decouples, so only the 3x3 block for the position is solved.
+  const auto triangulate_point = [&](const int point_index,
+                                     Vector4d* triangulated_point) {
+    const int begin = observation_offsets[point_index];
+    const int end = observation_offsets[point_index + 1];
+    if (end - begin < 2) {
+      return false;
+    }
+
+    Matrix3d A = Matrix3d::Zero();
+    Vector3d b = Vector3d::Zero();
+    for (int i = begin; i < end; i++) {
+      const Vector3d ray_direction =
+          (inverse_ray_matrices[pose_indices[i]] * points[i].homogeneous())
+              .normalized();
+      const Matrix3d A_term =
+          Matrix3d::Identity() - ray_direction * ray_direction.transpose();
+      A += A_term;
+      b += A_term * origins[pose_indices[i]];
+    }
+
+    Eigen::LLT<Matrix3d> linear_solver(A);
+    if (linear_solver.info() != Eigen::Success) {
+      return false;
+    }
+    *triangulated_point = linear_solver.solve(b).homogeneous();
+    return linear_solver.info() == Eigen::Success;
+  };
+
+  TriangulateBatch(poses,
+                   observation_offsets,
+                   pose_indices,
+                   points,
+                   num_threads,
+                   triangulate_point,
+                   triangulated_points,
+                   success);
+}
+
 bool IsTriangulatedPointInFrontOfCameras(
     const FeatureCorrespondence& correspondence,
     const Matrix3d& rotation,
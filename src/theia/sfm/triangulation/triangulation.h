@@ -88,6 +88,40 @@ bool TriangulateNView(const std::vector<Matrix3x4d>& poses,
                       const std::vector<Eigen::Vector2d>& points,
                       Eigen::Vector4d* triangulated_point);
 
+// Batch versions of TriangulateNView, TriangulateNViewSVD and
+// TriangulateMidpoint that triangulate many points at once. The projection
+// matrices are given once per view in poses, and the observations of point i
+// are the entries [observation_offsets[i], observation_offsets[i + 1]) of
+// pose_indices (indices into poses) and points. The points are triangulated in
+// parallel with num_threads threads, and success[i] is set to whether point i
+// could be triangulated. Points with fewer than two observations fail.
+//
+// TriangulateNViewBatch accumulates the 4x4 normal equations of each point
+// from a per-view product P^t * P that is computed once. TriangulateMidpointBatch
+// computes the camera center and the inverse of the left 3x3 block of each
+// projection matrix once to form the rays, so that block must be invertible.
+void TriangulateNViewBatch(const std::vector<Matrix3x4d>& poses,
+                           const std::vector<int>& observation_offsets,
+                           const std::vector<int>& pose_indices,
+                           const std::vector<Eigen::Vector2d>& points,
+                           const int num_threads,
+                           std::vector<Eigen::Vector4d>* triangulated_points,
+                           std::vector<bool>* success);
+void TriangulateNViewSVDBatch(const std::vector<Matrix3x4d>& poses,
+                              const std::vector<int>& observation_offsets,
+                              const std::vector<int>& pose_indices,
+                              const std::vector<Eigen::Vector2d>& points,
+                              const int num_threads,
+                              std::vector<Eigen::Vector4d>* triangulated_points,
+                              std::vector<bool>* success);
+void TriangulateMidpointBatch(const std::vector<Matrix3x4d>& poses,
+                              const std::vector<int>& observation_offsets,
+                              const std::vector<int>& pose_indices,
+                              const std::vector<Eigen::Vector2d>& points,
+                              const int num_threads,
+                              std::vector<Eigen::Vector4d>* triangulated_points,
+                              std::vector<bool>* success);
+
 // Determines if the 3D point is in front of the camera or not. We can simply
 // compute the homogeneous ray intersection (closest point to two rays) and
 // determine if the depth of the point is positive for both camera.
@@ -375,6 +375,127 @@ TEST(TriangulationNView, NoiseTest) {
   TestTriangulationManyPoints(kProjectionNoise, kReprojectionTolerance);
 }
 
+// Observations of random points in random views for the batch methods. The
+// last point only has one observation.
+struct BatchTriangulationProblem {
+  std::vector<Matrix3x4d> poses;
+  std::vector<int> observation_offsets;
+  std::vector<int> pose_indices;
+  std::vector<Vector2d> points;
+  std::vector<Vector3d> points_3d;
+};
+
+BatchTriangulationProblem CreateBatchTriangulationProblem(
+    const int num_views, const int num_points) {
+  BatchTriangulationProblem problem;
+  for (int i = 0; i < num_views; i++) {
+    Matrix3x4d pose;
+    pose << Eigen::AngleAxisd(DegToRad(rng.RandDouble(-15.0, 15.0)),
+                              rng.RandVector3d().normalized())
+                .toRotationMatrix(),
+        rng.RandVector3d();
+    problem.poses.emplace_back(pose);
+  }
+
+  problem.observation_offsets.emplace_back(0);
+  for (int i = 0; i < num_points; i++) {
+    const Vector3d point_3d(rng.RandDouble(-2.0, 2.0),
+                            rng.RandDouble(-2.0, 2.0),
+                            rng.RandDouble(6.0, 10.0));
+    problem.points_3d.emplace_back(point_3d);
+    const int num_observations =
+        i + 1 == num_points ? 1 : rng.RandInt(2, num_views);
+    const int first_view = rng.RandInt(0, num_views - 1);
+    for (int j = 0; j < num_observations; j++) {
+      const int pose_index = (first_view + j) % num_views;
+      problem.pose_indices.emplace_back(pose_index);
+      problem.points.emplace_back(
+          (problem.poses[pose_index] * point_3d.homogeneous()).hnormalized());
+    }
+    problem.observation_offsets.emplace_back(problem.points.size());
+  }
+  return problem;
+}
+
+TEST(TriangulationBatch, MatchesSinglePointMethods) {
+  static const int kNumViews = 10;
+  static const int kNumPoints = 200;
+  static const int kNumThreads = 4;
+  const BatchTriangulationProblem problem =
+      CreateBatchTriangulationProblem(kNumViews, kNumPoints);
+
+  std::vector<Vector4d> nview_points, svd_points, midpoint_points;
+  std::vector<bool> nview_success, svd_success, midpoint_success;
+  TriangulateNViewBatch(problem.poses,
+                        problem.observation_offsets,
+                        problem.pose_indices,
+                        problem.points,
+                        kNumThreads,
+                        &nview_points,
+                        &nview_success);
+  TriangulateNViewSVDBatch(problem.poses,
+                           problem.observation_offsets,
+                           problem.pose_indices,
+                           problem.points,
+                           kNumThreads,
+                           &svd_points,
+                           &svd_success);
+  TriangulateMidpointBatch(problem.poses,
+                           problem.observation_offsets,
+                           problem.pose_indices,
+                           problem.points,
+                           kNumThreads,
+                           &midpoint_points,
+                           &midpoint_success);
+  ASSERT_EQ(nview_points.size(), kNumPoints);
+  ASSERT_EQ(svd_points.size(), kNumPoints);
+  ASSERT_EQ(midpoint_points.size(), kNumPoints);
+
+  for (int i = 0; i < kNumPoints; i++) {
+    if (i + 1 == kNumPoints) {
+      EXPECT_FALSE(nview_success[i]);
+      EXPECT_FALSE(svd_success[i]);
+      EXPECT_FALSE(midpoint_success[i]);
+      continue;
+    }
+    ASSERT_TRUE(nview_success[i]);
+    ASSERT_TRUE(svd_success[i]);
+    ASSERT_TRUE(midpoint_success[i]);
+
+    std::vector<Matrix3x4d> poses;
+    std::vector<Vector2d> points;
+    std::vector<Vector3d> origins, directions;
+    for (int j = problem.observation_offsets[i];
+         j < problem.observation_offsets[i + 1];
+         j++) {
+      const Matrix3x4d& pose = problem.poses[problem.pose_indices[j]];
+      poses.emplace_back(pose);
+      points.emplace_back(problem.points[j]);
+      const Matrix3d rotation = pose.block<3, 3>(0, 0);
+      origins.emplace_back(-rotation.transpose() * pose.col(3));
+      directions.emplace_back(
+          (rotation.transpose() * problem.points[j].homogeneous())
+              .normalized());
+    }
+
+    Vector4d nview_point, svd_point, midpoint_point;
+    EXPECT_TRUE(TriangulateNView(poses, points, &nview_point));
+    EXPECT_TRUE(TriangulateNViewSVD(poses, points, &svd_point));
+    EXPECT_TRUE(TriangulateMidpoint(origins, directions, &midpoint_point));
+
+    EXPECT_LT((nview_points[i].hnormalized() - nview_point.hnormalized()).norm(),
+              1e-8);
+    EXPECT_LT((svd_points[i].hnormalized() - svd_point.hnormalized()).norm(),
+              1e-8);
+    EXPECT_LT(
+        (midpoint_points[i].hnormalized() - midpoint_point.hnormalized())
+            .norm(),
+        1e-8);
+    EXPECT_LT((nview_points[i].hnormalized() - problem.points_3d[i]).norm(),
+              1e-8);
+  }
+}
+
 void TestIsTriangulatedPointInFrontOfCameras(const Eigen::Vector3d& point3d,
                                              const Eigen::Matrix3d& rotation,
                                              const Eigen::Vector3d& translation,
@@ -54,4 +54,58 @@ std::tuple<bool, Vector4d> TriangulateDLTWrapper(const Matrix3x4d& pose1,
   return std::make_tuple(success, triangulated_point);
 }
 
+std::tuple<std::vector<bool>, std::vector<Vector4d>>
+TriangulateNViewBatchWrapper(const std::vector<Matrix3x4d>& poses,
+                             const std::vector<int>& observation_offsets,
+                             const std::vector<int>& pose_indices,
+                             const std::vector<Vector2d>& points,
+                             const int num_threads) {
+  std::vector<Vector4d> triangulated_points;
+  std::vector<bool> success;
+  TriangulateNViewBatch(poses,
+                        observation_offsets,
+                        pose_indices,
+                        points,
+                        num_threads,
+                        &triangulated_points,
+                        &success);
+  return std::make_tuple(success, triangulated_points);
+}
+
+std::tuple<std::vector<bool>, std::vector<Vector4d>>
+TriangulateNViewSVDBatchWrapper(const std::vector<Matrix3x4d>& poses,
+                                const std::vector<int>& observation_offsets,
+                                const std::vector<int>& pose_indices,
+                                const std::vector<Vector2d>& points,
+                                const int num_threads) {
+  std::vector<Vector4d> triangulated_points;
+  std::vector<bool> success;
+  TriangulateNViewSVDBatch(poses,
+                           observation_offsets,
+                           pose_indices,
+                           points,
+                           num_threads,
+                           &triangulated_points,
+                           &success);
+  return std::make_tuple(success, triangulated_points);
+}
+
+std::tuple<std::vector<bool>, std::vector<Vector4d>>
+TriangulateMidpointBatchWrapper(const std::vector<Matrix3x4d>& poses,
+                                const std::vector<int>& observation_offsets,
+                                const std::vector<int>& pose_indices,
+                                const std::vector<Vector2d>& points,
+                                const int num_threads) {
+  std::vector<Vector4d> triangulated_points;
+  std::vector<bool> success;
+  TriangulateMidpointBatch(poses,
+                           observation_offsets,
+                           pose_indices,
+                           points,
+                           num_threads,
+                           &triangulated_points,
+                           &success);
+  return std::make_tuple(success, triangulated_points);
+}
+
 }  // namespace theia
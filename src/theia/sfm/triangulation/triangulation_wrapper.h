@@ -30,4 +30,25 @@ std::tuple<bool, Eigen::Vector4d> TriangulateNViewWrapper(
     const std::vector<Matrix3x4d>& poses,
     const std::vector<Eigen::Vector2d>& points);
 
+std::tuple<std::vector<bool>, std::vector<Eigen::Vector4d>>
+TriangulateNViewBatchWrapper(const std::vector<Matrix3x4d>& poses,
+                             const std::vector<int>& observation_offsets,
+                             const std::vector<int>& pose_indices,
+                             const std::vector<Eigen::Vector2d>& points,
+                             const int num_threads);
+
+std::tuple<std::vector<bool>, std::vector<Eigen::Vector4d>>
+TriangulateNViewSVDBatchWrapper(const std::vector<Matrix3x4d>& poses,
+                                const std::vector<int>& observation_offsets,
+                                const std::vector<int>& pose_indices,
+                                const std::vector<Eigen::Vector2d>& points,
+                                const int num_threads);
+
+std::tuple<std::vector<bool>, std::vector<Eigen::Vector4d>>
+TriangulateMidpointBatchWrapper(const std::vector<Matrix3x4d>& poses,
+                                const std::vector<int>& observation_offsets,
+                                const std::vector<int>& pose_indices,
+                                const std::vector<Eigen::Vector2d>& points,
+                                const int num_threads);
+
 }  // namespace theia
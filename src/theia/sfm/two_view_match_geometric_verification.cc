@@ -35,19 +35,31 @@
 #include "theia/sfm/two_view_match_geometric_verification.h"
 
 #include <glog/logging.h>
+#include <Eigen/Core>
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <numeric>
 #include <vector>
 
+#include "theia/math/probability/sequential_probability_ratio.h"
 #include "theia/matching/feature_correspondence.h"
 #include "theia/matching/guided_epipolar_matcher.h"
 #include "theia/sfm/bundle_adjustment/bundle_adjust_two_views.h"
 #include "theia/sfm/bundle_adjustment/bundle_adjustment.h"
+#include "theia/sfm/bundle_adjustment/refine_relative_pose.h"
 #include "theia/sfm/camera_intrinsics_prior.h"
 #include "theia/sfm/estimate_twoview_info.h"
 #include "theia/sfm/estimators/estimate_homography.h"
+#include "theia/sfm/pose/seven_point_fundamental_matrix.h"
+#include "theia/sfm/pose/util.h"
 #include "theia/sfm/reconstruction_estimator_utils.h"
 #include "theia/sfm/set_camera_intrinsics_from_priors.h"
 #include "theia/sfm/triangulation/triangulation.h"
 #include "theia/sfm/twoview_info.h"
+#include "theia/util/arena.h"
+#include "theia/util/random.h"
 
 namespace theia {
 
@@ -83,6 +95,25 @@ bool AcceptableReprojectionError(
   return sq_reprojection_error < sq_max_reprojection_error_pixels;
 }
 
+// Returns the number of minimal samples required to draw an all-inlier sample
+// with probability 1 - failure_probability, capped at max_num_samples.
+int RequiredNumSamples(const double inlier_ratio,
+                       const int sample_size,
+                       const double failure_probability,
+                       const int max_num_samples) {
+  const double prob_all_inliers = std::pow(inlier_ratio, sample_size);
+  if (prob_all_inliers <= 0.0) {
+    return max_num_samples;
+  }
+  if (prob_all_inliers >= 1.0) {
+    return 1;
+  }
+  const double num_samples =
+      std::ceil(std::log(failure_probability) / std::log1p(-prob_all_inliers));
+  return static_cast<int>(
+      std::min(static_cast<double>(max_num_samples), num_samples));
+}
+
 }  // namespace
 
 TwoViewMatchGeometricVerification::TwoViewMatchGeometricVerification(
@@ -114,10 +145,20 @@ void TwoViewMatchGeometricVerification::CreateCorrespondencesFromIndexedMatches(
 bool TwoViewMatchGeometricVerification::VerifyMatches(
     std::vector<FeatureCorrespondence>* verified_matches,
     TwoViewInfo* twoview_info) {
+  pre_verification_summary_ = PreVerificationSummary();
+  ransac_statistics_ = RansacStatistics();
   if (matches_.size() < options_.min_num_inlier_matches) {
     return false;
   }
 
+  // Cheaply reject image pairs that cannot pass verification before running
+  // the (much more expensive) full estimation.
+  if (options_.pre_verification && !PreVerifyMatches()) {
+    VLOG(2) << "Image pair rejected by pre-verification after evaluating "
+            << pre_verification_summary_.num_hypotheses << " hypotheses.";
+    return false;
+  }
+
   std::vector<FeatureCorrespondence> correspondences;
   CreateCorrespondencesFromIndexedMatches(&correspondences);
 
@@ -131,7 +172,8 @@ bool TwoViewMatchGeometricVerification::VerifyMatches(
                            intrinsics2_,
                            correspondences,
                            twoview_info,
-                           &inlier_indices)) {
+                           &inlier_indices,
+                           &ransac_statistics_)) {
     return false;
   }
   VLOG(2) << inlier_indices.size()
@@ -174,6 +216,10 @@ bool TwoViewMatchGeometricVerification::VerifyMatches(
     if (!BundleAdjustRelativePose(twoview_info)) {
       return false;
     }
+  } else if (options_.refine_relative_pose &&
+             intrinsics1_.focal_length.is_set &&
+             intrinsics2_.focal_length.is_set) {
+    RefineRelativePoseFromMatches(twoview_info);
   }
 
   // Set the number of verified matches and the output verified_matches.
@@ -182,6 +228,157 @@ bool TwoViewMatchGeometricVerification::VerifyMatches(
   return verified_matches->size() > options_.min_num_inlier_matches;
 }
 
+bool TwoViewMatchGeometricVerification::PreVerifyMatches() {
+  static const int kSampleSize = 7;
+  const EstimateTwoViewInfoOptions& etvi_options =
+      options_.estimate_twoview_info_options;
+  const double sigma = options_.pre_verification_sprt_sigma;
+  CHECK_GT(sigma, 0.0);
+  CHECK_LT(sigma, 0.5);
+
+  pre_verification_summary_.performed = true;
+  const int num_matches = matches_.size();
+  if (num_matches < kSampleSize) {
+    return true;
+  }
+
+  // The scratch buffers are allocated from the arena of the thread, which is
+  // rewound once the pair is pre-verified.
+  ArenaScope arena_scope(ThreadLocalArena());
+  const ArenaAllocator<Eigen::Vector2d> allocator(arena_scope.arena());
+
+  // Normalize the points (shift each image to its centroid and apply a common
+  // isotropic scale) so that the 7-point solver is well-conditioned. The
+  // common scale keeps the Sampson error proportional to pixels.
+  ArenaVector<Eigen::Vector2d> points1(num_matches, allocator);
+  ArenaVector<Eigen::Vector2d> points2(num_matches, allocator);
+  Eigen::Vector2d mean1 = Eigen::Vector2d::Zero();
+  Eigen::Vector2d mean2 = Eigen::Vector2d::Zero();
+  for (int i = 0; i < num_matches; i++) {
+    const Keypoint& keypoint1 = features1_.keypoints[matches_[i].feature1_ind];
+    const Keypoint& keypoint2 = features2_.keypoints[matches_[i].feature2_ind];
+    points1[i] = Eigen::Vector2d(keypoint1.x(), keypoint1.y());
+    points2[i] = Eigen::Vector2d(keypoint2.x(), keypoint2.y());
+    mean1 += points1[i];
+    mean2 += points2[i];
+  }
+  mean1 /= num_matches;
+  mean2 /= num_matches;
+  double mean_distance = 0.0;
+  for (int i = 0; i < num_matches; i++) {
+    mean_distance += (points1[i] - mean1).norm() + (points2[i] - mean2).norm();
+  }
+  mean_distance /= 2.0 * num_matches;
+  const double scale = mean_distance > 0.0 ? M_SQRT2 / mean_distance : 1.0;
+  for (int i = 0; i < num_matches; i++) {
+    points1[i] = scale * (points1[i] - mean1);
+    points2[i] = scale * (points2[i] - mean2);
+  }
+
+  const double max_sampson_error_pixels1 = ComputeResolutionScaledThreshold(
+      options_.pre_verification_max_sampson_error_pixels,
+      intrinsics1_.image_width,
+      intrinsics1_.image_height);
+  const double max_sampson_error_pixels2 = ComputeResolutionScaledThreshold(
+      options_.pre_verification_max_sampson_error_pixels,
+      intrinsics2_.image_width,
+      intrinsics2_.image_height);
+  const double sq_max_sampson_error =
+      max_sampson_error_pixels1 * max_sampson_error_pixels2 * scale * scale;
+
+  std::shared_ptr<RandomNumberGenerator> rng = etvi_options.rng;
+  if (!rng) {
+    rng = std::make_shared<RandomNumberGenerator>();
+  }
+
+  // Putative matches are often sorted by descriptor distance, so the SPRT
+  // visits the data points in a random order to keep its samples unbiased.
+  ArenaVector<int> order(num_matches, ArenaAllocator<int>(allocator));
+  std::iota(order.begin(), order.end(), 0);
+  for (int i = num_matches - 1; i > 0; i--) {
+    std::swap(order[i], order[rng->RandInt(0, i)]);
+  }
+
+  // The weakest model we accept has min_num_inlier_matches inliers, so that
+  // inlier ratio is the "good model" hypothesis of the SPRT. It must be larger
+  // than sigma for the test to be meaningful.
+  const double min_inlier_ratio =
+      static_cast<double>(options_.min_num_inlier_matches) / num_matches;
+  const double epsilon = std::min(std::max(min_inlier_ratio, 2.0 * sigma), 0.95);
+  const double decision_threshold =
+      CalculateSPRTDecisionThreshold(sigma, epsilon);
+  const double failure_probability =
+      1.0 - etvi_options.expected_ransac_confidence;
+
+  // Only draw as many samples as are needed to find an all-inlier sample of the
+  // weakest acceptable model with the desired confidence.
+  const int max_num_samples =
+      RequiredNumSamples(min_inlier_ratio,
+                         kSampleSize,
+                         failure_probability,
+                         options_.pre_verification_max_num_samples);
+  std::vector<int> sample_indices;
+  sample_indices.reserve(kSampleSize);
+  std::vector<Eigen::Vector2d> sample1(kSampleSize), sample2(kSampleSize);
+  std::vector<Eigen::Matrix3d> fundamental_matrices;
+  PreVerificationSummary& summary = pre_verification_summary_;
+  while (summary.num_samples < max_num_samples) {
+    ++summary.num_samples;
+    sample_indices.clear();
+    while (sample_indices.size() < kSampleSize) {
+      const int index = rng->RandInt(0, num_matches - 1);
+      if (std::find(sample_indices.begin(), sample_indices.end(), index) ==
+          sample_indices.end()) {
+        sample_indices.emplace_back(index);
+      }
+    }
+    for (int i = 0; i < kSampleSize; i++) {
+      sample1[i] = points1[sample_indices[i]];
+      sample2[i] = points2[sample_indices[i]];
+    }
+
+    fundamental_matrices.clear();
+    if (!SevenPointFundamentalMatrix(sample1, sample2, &fundamental_matrices)) {
+      continue;
+    }
+
+    for (const Eigen::Matrix3d& fundamental_matrix : fundamental_matrices) {
+      ++summary.num_hypotheses;
+      int num_tested_points;
+      double observed_inlier_ratio;
+      const bool passed_sprt = SequentialProbabilityRatioTest(
+          num_matches,
+          [&](const int i) {
+            const int index = order[i];
+            return SquaredSampsonDistance(fundamental_matrix,
+                                          points1[index],
+                                          points2[index]) <
+                   sq_max_sampson_error;
+          },
+          sigma,
+          epsilon,
+          decision_threshold,
+          &num_tested_points,
+          &observed_inlier_ratio);
+      summary.num_residuals_evaluated += num_tested_points;
+      if (!passed_sprt) {
+        ++summary.num_hypotheses_rejected_by_sprt;
+        continue;
+      }
+
+      const int num_inliers =
+          static_cast<int>(std::round(observed_inlier_ratio * num_matches));
+      summary.max_num_inliers = std::max(summary.max_num_inliers, num_inliers);
+      if (num_inliers >= options_.min_num_inlier_matches) {
+        return true;
+      }
+    }
+  }
+
+  summary.rejected = true;
+  return false;
+}
+
 // Triangulates the points and updates the matches_
 void TwoViewMatchGeometricVerification::TriangulatePoints(
     std::vector<Eigen::Vector4d>* triangulated_points) {
@@ -326,6 +523,31 @@ bool TwoViewMatchGeometricVerification::BundleAdjustRelativePose(
   return true;
 }
 
+void TwoViewMatchGeometricVerification::RefineRelativePoseFromMatches(
+    TwoViewInfo* twoview_info) {
+  // The angular epipolar error is defined on normalized image coordinates.
+  std::vector<FeatureCorrespondence> normalized_correspondences;
+  CreateCorrespondencesFromIndexedMatches(&normalized_correspondences);
+  for (FeatureCorrespondence& correspondence : normalized_correspondences) {
+    correspondence.feature1 =
+        Feature(camera1_.PixelToNormalizedCoordinates(
+                            correspondence.feature1.point_)
+                    .hnormalized());
+    correspondence.feature2 =
+        Feature(camera2_.PixelToNormalizedCoordinates(
+                            correspondence.feature2.point_)
+                    .hnormalized());
+  }
+
+  BundleAdjustmentOptions ba_options;
+  ba_options.num_threads = 1;
+  const BundleAdjustmentSummary summary =
+      RefineRelativePose(ba_options, normalized_correspondences, twoview_info);
+  if (!summary.success) {
+    VLOG(2) << "Could not refine the relative pose. Keeping the estimated pose.";
+  }
+}
+
 // Compute a homography and return the number of inliers. This determines how
 // well a plane fits the two view geometry.
 int TwoViewMatchGeometricVerification::CountHomographyInliers() {
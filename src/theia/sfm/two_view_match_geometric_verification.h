@@ -43,6 +43,7 @@
 #include "theia/sfm/camera/camera.h"
 #include "theia/sfm/camera_intrinsics_prior.h"
 #include "theia/sfm/estimate_twoview_info.h"
+#include "theia/solvers/ransac_statistics.h"
 #include "theia/util/util.h"
 
 namespace theia {
@@ -58,6 +59,32 @@ class TwoViewMatchGeometricVerification {
     // Minimum number of inlier matches in order to return true.
     int min_num_inlier_matches = 30;
 
+    // Run a cheap pre-verification stage before the full two-view estimation.
+    // Fundamental matrix hypotheses are generated from minimal 7-point samples
+    // and evaluated with Wald's SPRT (as in Matas et. al. "Randomized RANSAC
+    // with Sequential Probability Ratio Test") so that bad hypotheses are
+    // dropped after a few residuals. The image pair is rejected without running
+    // the full estimator if no hypothesis with at least min_num_inlier_matches
+    // inliers is found within the hypothesis budget. This mostly pays off when
+    // many of the putative pairs are wrong (e.g., exhaustive matching).
+    bool pre_verification = false;
+
+    // Maximum number of minimal samples drawn during pre-verification. Fewer
+    // samples are drawn when min_num_inlier_matches is a large fraction of the
+    // putative matches. Note that pairs with a very low inlier ratio may be
+    // rejected if this budget is too small.
+    int pre_verification_max_num_samples = 500;
+
+    // Sampson error threshold in pixels (for a 1024 pixel image; it is scaled
+    // with the image resolution) for the pre-verification. This should be
+    // looser than the threshold of the full estimator since the 7-point
+    // hypotheses are noisier than the final RANSAC model.
+    double pre_verification_max_sampson_error_pixels = 8.0;
+
+    // The probability that a data point is consistent with a bad model. This
+    // is the sigma (delta in Matas et. al.) parameter of the SPRT.
+    double pre_verification_sprt_sigma = 0.05;
+
     // Perform guided matching to find more matches after initial geometry
     // estimation. Guided matching uses the current estimate for two-view
     // geometry to perform a constrained search along epipolar lines
@@ -90,6 +117,38 @@ class TwoViewMatchGeometricVerification {
     // inliers if the reprojection error after bundle adjustment is less than
     // this. This value is in pixels.
     double final_max_reprojection_error = 5.0;
+
+    // If bundle adjustment is disabled, the relative pose is still refined on
+    // the inliers by minimizing the angular epipolar error with
+    // RefineRelativePose. This needs no 3D points and costs a small fraction of
+    // two-view bundle adjustment. It is only performed when the focal lengths
+    // of both views are known.
+    bool refine_relative_pose = true;
+  };
+
+  // Statistics about the pre-verification stage of the last call to
+  // VerifyMatches.
+  struct PreVerificationSummary {
+    // True if the pre-verification stage was run.
+    bool performed = false;
+
+    // True if the image pair was rejected by the pre-verification.
+    bool rejected = false;
+
+    // The number of minimal samples drawn and the number of fundamental matrix
+    // hypotheses they produced.
+    int num_samples = 0;
+    int num_hypotheses = 0;
+
+    // Number of hypotheses that the SPRT rejected before all data points were
+    // tested.
+    int num_hypotheses_rejected_by_sprt = 0;
+
+    // Total number of Sampson errors that were evaluated.
+    int num_residuals_evaluated = 0;
+
+    // The maximum number of inliers of a hypothesis that passed the SPRT.
+    int max_num_inliers = 0;
   };
 
   TwoViewMatchGeometricVerification(
@@ -106,7 +165,24 @@ class TwoViewMatchGeometricVerification {
   bool VerifyMatches(std::vector<FeatureCorrespondence>* verified_matches,
                      TwoViewInfo* twoview_info);
 
+  // Returns the statistics of the pre-verification stage.
+  const PreVerificationSummary& pre_verification_summary() const {
+    return pre_verification_summary_;
+  }
+
+  // Returns the statistics of the RANSAC estimation of the two view geometry.
+  // The times are only measured if
+  // options.estimate_twoview_info_options.collect_ransac_statistics is set.
+  const RansacStatistics& ransac_statistics() const {
+    return ransac_statistics_;
+  }
+
  private:
+  // Returns true if a fundamental matrix with at least min_num_inlier_matches
+  // inliers was found using randomized 7-point sampling and SPRT model
+  // evaluation. The statistics are stored in pre_verification_summary_.
+  bool PreVerifyMatches();
+
   // A helper method that creates a vector of FeatureCorrespondence from the
   // matches_ vector of match indices.
   void CreateCorrespondencesFromIndexedMatches(
@@ -122,6 +198,9 @@ class TwoViewMatchGeometricVerification {
   // errors.
   bool BundleAdjustRelativePose(TwoViewInfo* twoview_info);
 
+  // Refines the relative pose on the current matches without 3D points.
+  void RefineRelativePoseFromMatches(TwoViewInfo* twoview_info);
+
   // Estimates a homography and returns the number of inliers.
   int CountHomographyInliers();
 
@@ -134,6 +213,9 @@ class TwoViewMatchGeometricVerification {
   // to it.
   std::vector<IndexedFeatureMatch> matches_;
 
+  PreVerificationSummary pre_verification_summary_;
+  RansacStatistics ransac_statistics_;
+
   DISALLOW_COPY_AND_ASSIGN(TwoViewMatchGeometricVerification);
 };
 
@@ -48,6 +48,7 @@ namespace theia {
 typedef uint32_t ViewId;
 typedef uint32_t TrackId;
 typedef uint32_t CameraIntrinsicsGroupId;
+typedef uint32_t CameraRigId;
 typedef std::pair<ViewId, ViewId> ViewIdPair;
 typedef std::tuple<ViewId, ViewId, ViewId> ViewIdTriplet;
 
@@ -55,6 +56,8 @@ static const ViewId kInvalidViewId = std::numeric_limits<ViewId>::max();
 static const TrackId kInvalidTrackId = std::numeric_limits<TrackId>::max();
 static const CameraIntrinsicsGroupId kInvalidCameraIntrinsicsGroupId =
     std::numeric_limits<CameraIntrinsicsGroupId>::max();
+static const CameraRigId kInvalidCameraRigId =
+    std::numeric_limits<CameraRigId>::max();
 
 // Used as the projection matrix type.
 typedef Eigen::Matrix<double, 3, 4> Matrix3x4d;
@@ -35,8 +35,15 @@
 #include "theia/sfm/undistort_image.h"
 
 #include <Eigen/Core>
+#include <glog/logging.h>
+
 #include <algorithm>
+#include <atomic>
+#include <condition_variable>  // NOLINT
 #include <limits>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <vector>
 
 #include "theia/image/image.h"
 #include "theia/sfm/camera/camera.h"
@@ -50,6 +57,7 @@
 #include "theia/sfm/track.h"
 #include "theia/sfm/types.h"
 #include "theia/sfm/view.h"
+#include "theia/util/executor.h"
 
 namespace theia {
 namespace {
@@ -149,72 +157,183 @@ void FindUndistortedImageBoundary(const Camera& distorted_camera,
   *bounds = Eigen::Vector4d(left_max_x, right_min_x, top_max_y, bottom_min_y);
 }
 
-// Create an undistorted image from the distorted image given the distorted and
-// undistorted camera parameters. This function only maps the pixels to create
-// the undistorted image and assumes the camera parameters and image sizes have
-// already been solved for.
-void RemoveImageLensDistortion(const Camera& distorted_camera,
-                               const FloatImage& distorted_image,
-                               const Camera& undistorted_camera,
-                               FloatImage* undistorted_image) {
+// Returns the key of the undistortion map of the cameras, which is made up of
+// the intrinsics model types, image sizes and intrinsics of both cameras.
+std::vector<double> UndistortionMapKey(const Camera& distorted_camera,
+                                       const Camera& undistorted_camera) {
+  std::vector<double> key;
+  for (const Camera* camera : {&distorted_camera, &undistorted_camera}) {
+    const CameraIntrinsicsModel& intrinsics = *camera->CameraIntrinsics();
+    key.emplace_back(static_cast<double>(intrinsics.Type()));
+    key.emplace_back(camera->ImageWidth());
+    key.emplace_back(camera->ImageHeight());
+    key.insert(key.end(),
+               intrinsics.parameters(),
+               intrinsics.parameters() + intrinsics.NumParameters());
+  }
+  return key;
+}
+
+}  // namespace
+
+UndistortionMap::UndistortionMap(const Camera& distorted_camera,
+                                 const Camera& undistorted_camera)
+    : width_(undistorted_camera.ImageWidth()),
+      height_(undistorted_camera.ImageHeight()),
+      distorted_width_(distorted_camera.ImageWidth()),
+      distorted_height_(distorted_camera.ImageHeight()) {
+  CHECK_GT(distorted_width_, 0);
+  CHECK_GT(distorted_height_, 0);
   const CameraIntrinsicsModel& distorted_intrinsics =
       *distorted_camera.CameraIntrinsics();
   const CameraIntrinsicsModel& undistorted_intrinsics =
       *undistorted_camera.CameraIntrinsics();
 
-  // For each pixel in the undistorted image, find the coordinate in the
-  // distorted image and set the pixel color accordingly.
+  const int num_pixels = width_ * height_;
+  top_left_index_.resize(num_pixels);
+  weight_x_.resize(num_pixels);
+  weight_y_.resize(num_pixels);
+  for (int y = 0; y < height_; ++y) {
+    for (int x = 0; x < width_; ++x) {
+      // Camera models assume that the upper left pixel center is (0.5, 0.5).
+      const Eigen::Vector3d distorted_point =
+          undistorted_intrinsics.ImageToCameraCoordinates(
+              Eigen::Vector2d(x + 0.5, y + 0.5));
+      const Eigen::Vector2d distorted_pixel =
+          distorted_intrinsics.CameraToImageCoordinates(distorted_point);
+
+      // FindUndistortedImageBoundary guarantees that the pixels are within
+      // the distorted image, but we clamp the locations to the pixel centers
+      // at the border anyways so that the 2x2 neighborhood is always valid.
+      const double distorted_x = std::min<double>(
+          std::max(distorted_pixel.x() - 0.5, 0.0), distorted_width_ - 1);
+      const double distorted_y = std::min<double>(
+          std::max(distorted_pixel.y() - 0.5, 0.0), distorted_height_ - 1);
+      const int x0 = std::min(static_cast<int>(distorted_x),
+                              std::max(distorted_width_ - 2, 0));
+      const int y0 = std::min(static_cast<int>(distorted_y),
+                              std::max(distorted_height_ - 2, 0));
+
+      const int index = y * width_ + x;
+      top_left_index_[index] = y0 * distorted_width_ + x0;
+      weight_x_[index] = static_cast<float>(distorted_x - x0);
+      weight_y_[index] = static_cast<float>(distorted_y - y0);
+    }
+  }
+}
+
+size_t UndistortionMap::SizeInBytes() const {
+  return top_left_index_.size() * sizeof(top_left_index_[0]) +
+         weight_x_.size() * sizeof(weight_x_[0]) +
+         weight_y_.size() * sizeof(weight_y_[0]);
+}
+
+void UndistortionMap::Remap(const FloatImage& distorted_image,
+                            const int num_threads,
+                            FloatImage* undistorted_image) const {
+  CHECK_EQ(distorted_image.Width(), distorted_width_);
+  CHECK_EQ(distorted_image.Height(), distorted_height_);
   const int num_channels = distorted_image.Channels();
-  oiio::ImageBuf& undistorted_img = undistorted_image->GetOpenImageIOImageBuf();
-  oiio::ImageBuf::Iterator<float> undistorted_it(undistorted_img);
-  for (; !undistorted_it.done(); ++undistorted_it) {
-    Eigen::Vector2d image_point(undistorted_it.x() + 0.5,
-                                undistorted_it.y() + 0.5);
-
-    // Camera models assume that the upper left pixel center is (0.5, 0.5).
-    const Eigen::Vector3d distorted_point =
-        undistorted_intrinsics.ImageToCameraCoordinates(image_point);
-    const Eigen::Vector2d distorted_pixel =
-        distorted_intrinsics.CameraToImageCoordinates(distorted_point);
-    const Eigen::Vector2d pixel(std::round<int>(distorted_pixel.x() - 0.5),
-                                std::round<int>(distorted_pixel.y() - 0.5));
-    // Set all color channels appropriately. Note that we do not need to check
-    // if the distorted pixel is within the image bounds since the
-    // FindUndistortedImageBoundary function has guaranteed that all pixels will
-    // be within the image borders.
-    for (int c = 0; c < num_channels; c++) {
-      undistorted_it[c] = distorted_image.BilinearInterpolate(
-          distorted_pixel.x(), distorted_pixel.y(), c);
+  if (undistorted_image->Width() != width_ ||
+      undistorted_image->Height() != height_ ||
+      undistorted_image->Channels() != num_channels) {
+    *undistorted_image = FloatImage(width_, height_, num_channels);
+  }
+
+  // The offsets of the right and bottom neighbors. Images that are a single
+  // pixel wide or tall use the same pixel for both neighbors.
+  const int step_x = distorted_width_ > 1 ? num_channels : 0;
+  const int step_y =
+      distorted_height_ > 1 ? distorted_width_ * num_channels : 0;
+  const float* distorted_data = distorted_image.Data();
+  float* undistorted_data = undistorted_image->Data();
+
+  // The pixels are interpolated from the raw buffers so that the inner loop
+  // over the channels is free of bounds checks and may be vectorized.
+  const auto remap_rows = [&](const int start_row, const int end_row) {
+    for (int index = start_row * width_; index < end_row * width_; ++index) {
+      const float wx = weight_x_[index];
+      const float wy = weight_y_[index];
+      const float w00 = (1.0f - wx) * (1.0f - wy);
+      const float w01 = wx * (1.0f - wy);
+      const float w10 = (1.0f - wx) * wy;
+      const float w11 = wx * wy;
+
+      const float* p00 =
+          distorted_data + top_left_index_[index] * num_channels;
+      const float* p01 = p00 + step_x;
+      const float* p10 = p00 + step_y;
+      const float* p11 = p10 + step_x;
+      float* output = undistorted_data + index * num_channels;
+      for (int c = 0; c < num_channels; ++c) {
+        output[c] = w00 * p00[c] + w01 * p01[c] + w10 * p10[c] + w11 * p11[c];
+      }
+    }
+  };
+
+  // Callers commonly undistort several images in parallel. The rows then run
+  // on the threads of the shared executor that are not busy with other images.
+  ParallelFor(num_threads, height_, remap_rows);
+}
+
+std::shared_ptr<const UndistortionMap> UndistortionMapCache::GetUndistortionMap(
+    const Camera& distorted_camera, const Camera& undistorted_camera) {
+  const std::vector<double> key =
+      UndistortionMapKey(distorted_camera, undistorted_camera);
+  std::promise<std::shared_ptr<const UndistortionMap> > promise;
+  std::shared_future<std::shared_ptr<const UndistortionMap> > pending_map;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const auto it = maps_.find(key);
+    if (it != maps_.end()) {
+      pending_map = it->second;
+    } else {
+      maps_.emplace(key, promise.get_future().share());
     }
   }
+  // Wait for the map if it is computed (or was computed) by another caller.
+  if (pending_map.valid()) {
+    return pending_map.get();
+  }
+
+  // Compute the map outside of the lock so that maps of other cameras may be
+  // computed concurrently.
+  std::shared_ptr<const UndistortionMap> map =
+      std::make_shared<const UndistortionMap>(distorted_camera,
+                                              undistorted_camera);
+  promise.set_value(map);
+  return map;
 }
 
-}  // namespace
+int UndistortionMapCache::Size() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return maps_.size();
+}
 
 bool UndistortImage(const Camera& distorted_camera,
                     const FloatImage& distorted_image,
                     const Camera& undistorted_camera,
                     FloatImage* undistorted_image) {
-  // Undistort the image.
-  if (distorted_image.Channels() == 1) {
-    undistorted_image->ConvertToGrayscaleImage();
-  } else {
-    undistorted_image->ConvertToRGBImage();
-  }
-  undistorted_image->Resize(undistorted_camera.ImageWidth(),
-                            undistorted_camera.ImageHeight());
+  const UndistortionMap undistortion_map(distorted_camera, undistorted_camera);
+  return UndistortImage(
+      undistortion_map, distorted_image, 1, undistorted_image);
+}
 
+bool UndistortImage(const UndistortionMap& undistortion_map,
+                    const FloatImage& distorted_image,
+                    const int num_threads,
+                    FloatImage* undistorted_image) {
   // Remap the distorted pixels into the undistorted image.
-  RemoveImageLensDistortion(
-      distorted_camera, distorted_image, undistorted_camera, undistorted_image);
-
+  undistortion_map.Remap(distorted_image, num_threads, undistorted_image);
   return true;
 }
 
 // Create the undistorted camera by removing radial distortion parameters.
 bool UndistortCamera(const Camera& distorted_camera,
                      Camera* undistorted_camera) {
-  *undistorted_camera = distorted_camera;
+  // The intrinsics must not be shared with the distorted camera, otherwise
+  // removing the distortion below would also modify the distorted camera.
+  undistorted_camera->DeepCopy(distorted_camera);
   SetLensDistortionToZero(undistorted_camera);
 
   Eigen::Vector4d undistorted_image_boundaries;
@@ -319,4 +438,67 @@ bool UndistortReconstruction(Reconstruction* reconstruction) {
   return true;
 }
 
+int UndistortImages(const UndistortImagesOptions& options,
+                    const std::vector<UndistortImageJob>& jobs,
+                    UndistortionMapCache* undistortion_maps) {
+  CHECK_GT(options.num_threads, 0);
+  CHECK_NOTNULL(undistortion_maps);
+  const int max_num_images_in_flight = options.max_num_images_in_flight > 0
+                                           ? options.max_num_images_in_flight
+                                           : 2 * options.num_threads;
+
+  std::mutex mutex;
+  std::condition_variable image_finished;
+  int num_images_in_flight = 0;
+  std::atomic<int> num_images_written(0);
+  const auto finish_image = [&]() {
+    std::lock_guard<std::mutex> lock(mutex);
+    --num_images_in_flight;
+    image_finished.notify_one();
+  };
+
+  // The writes are waited for after the reads, since the read tasks schedule
+  // them.
+  TaskGroup write_tasks;
+  TaskGroup read_tasks;
+  for (const UndistortImageJob& job : jobs) {
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      image_finished.wait(lock, [&]() {
+        return num_images_in_flight < max_num_images_in_flight;
+      });
+      ++num_images_in_flight;
+    }
+
+    read_tasks.Run([&, &job]() {
+      const FloatImage distorted_image(job.input_image_filepath);
+      if (distorted_image.Width() != job.distorted_camera.ImageWidth() ||
+          distorted_image.Height() != job.distorted_camera.ImageHeight()) {
+        LOG(WARNING) << "Skipping " << job.input_image_filepath
+                     << " because it could not be read or its size does not "
+                        "match the size of its camera.";
+        finish_image();
+        return;
+      }
+
+      std::shared_ptr<FloatImage> undistorted_image =
+          std::make_shared<FloatImage>();
+      UndistortImage(*undistortion_maps->GetUndistortionMap(
+                         job.distorted_camera, job.undistorted_camera),
+                     distorted_image,
+                     1,
+                     undistorted_image.get());
+
+      write_tasks.Run([&, &job, undistorted_image]() {
+        undistorted_image->Write(job.output_image_filepath);
+        ++num_images_written;
+        finish_image();
+      });
+    });
+  }
+  read_tasks.Wait();
+  write_tasks.Wait();
+  return num_images_written;
+}
+
 }  // namespace theia
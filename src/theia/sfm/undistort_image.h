@@ -34,13 +34,86 @@
 
 #ifndef THEIA_SFM_UNDISTORT_IMAGE_H_
 #define THEIA_SFM_UNDISTORT_IMAGE_H_
+#include <future>  // NOLINT
+#include <map>
 #include <memory>
+#include <mutex>  // NOLINT
+#include <string>
+#include <vector>
+
+#include "theia/sfm/camera/camera.h"
+#include "theia/util/util.h"
 
 namespace theia {
-class Camera;
 class FloatImage;
 class Reconstruction;
 
+// A precomputed remap table from the pixels of the undistorted image to
+// locations in the distorted image. Mapping a pixel requires unprojecting and
+// reprojecting it through the camera intrinsics models, which is much more
+// expensive than the interpolation itself, so the table should be computed once
+// per pair of cameras and reused for all images that share the intrinsics (see
+// UndistortionMapCache).
+class UndistortionMap {
+ public:
+  // The map is computed for images of the size of the distorted camera and
+  // produces images of the size of the undistorted camera.
+  UndistortionMap(const Camera& distorted_camera,
+                  const Camera& undistorted_camera);
+
+  // Size of the undistorted image.
+  int Width() const { return width_; }
+  int Height() const { return height_; }
+
+  size_t SizeInBytes() const;
+
+  // Remaps the distorted image into the undistorted image with bilinear
+  // interpolation. All channels of a pixel are interpolated with the same
+  // precomputed weights, and the rows are split between num_threads threads.
+  // The distorted image must have the size of the distorted camera and the
+  // undistorted image is resized to the size of the undistorted camera with
+  // the same number of channels.
+  void Remap(const FloatImage& distorted_image,
+             const int num_threads,
+             FloatImage* undistorted_image) const;
+
+ private:
+  int width_, height_;
+  int distorted_width_, distorted_height_;
+
+  // For each undistorted pixel, the index of the top-left pixel of the 2x2
+  // neighborhood in the distorted image and the weights of the right and
+  // bottom neighbors.
+  std::vector<int> top_left_index_;
+  std::vector<float> weight_x_;
+  std::vector<float> weight_y_;
+
+  DISALLOW_COPY_AND_ASSIGN(UndistortionMap);
+};
+
+// A thread-safe cache of undistortion maps keyed by the intrinsics and image
+// sizes of the distorted and undistorted cameras. Views that share a camera
+// then compute the map only once. Concurrent requests for the same map wait
+// for a single computation.
+class UndistortionMapCache {
+ public:
+  UndistortionMapCache() {}
+
+  std::shared_ptr<const UndistortionMap> GetUndistortionMap(
+      const Camera& distorted_camera, const Camera& undistorted_camera);
+
+  // The number of distinct maps that have been computed.
+  int Size();
+
+ private:
+  std::mutex mutex_;
+  std::map<std::vector<double>,
+           std::shared_future<std::shared_ptr<const UndistortionMap> > >
+      maps_;
+
+  DISALLOW_COPY_AND_ASSIGN(UndistortionMapCache);
+};
+
 // Given an image with lens distortion distortion described by the camera
 // parameters, undistort the image according to the parameters of the
 // undistorted camera to produce an image free of lens distortion. This is
@@ -55,6 +128,13 @@ bool UndistortImage(const Camera& distorted_camera,
                     const Camera& undistorted_camera,
                     FloatImage* undistorted_image);
 
+// Same as above, but samples the pixels with a precomputed undistortion map for
+// the cameras, e.g. from an UndistortionMapCache, using num_threads threads.
+bool UndistortImage(const UndistortionMap& undistortion_map,
+                    const FloatImage& distorted_image,
+                    const int num_threads,
+                    FloatImage* undistorted_image);
+
 // Create the undistorted camera by removing radial distortion parameters.
 bool UndistortCamera(const Camera& distorted_camera,
                      std::shared_ptr<Camera> undistorted_camera);
@@ -65,6 +145,35 @@ bool UndistortCamera(const Camera& distorted_camera,
 // reconstruction in place and potentially remove observations or tracks.
 bool UndistortReconstruction(Reconstruction* reconstruction);
 
+// An image to undistort with UndistortImages.
+struct UndistortImageJob {
+  std::string input_image_filepath;
+  std::string output_image_filepath;
+  Camera distorted_camera;
+  Camera undistorted_camera;
+};
+
+struct UndistortImagesOptions {
+  int num_threads = 1;
+
+  // The maximum number of images that are being read, undistorted or written
+  // at the same time, which bounds the memory used for the images. If 0,
+  // 2 * num_threads images are in flight so that writing the output overlaps
+  // with reading and undistorting the next images.
+  int max_num_images_in_flight = 0;
+};
+
+// Reads, undistorts and writes the images of the jobs in parallel. The
+// undistortion maps are taken from the cache, so they are computed once per
+// distinct pair of cameras. Writing an image is a separate task from reading
+// and undistorting it, so the encoding of the outputs does not hold up the
+// decoding of the next inputs. Images that cannot be read or that do not have
+// the size of their distorted camera are skipped with a warning. Returns the
+// number of images written.
+int UndistortImages(const UndistortImagesOptions& options,
+                    const std::vector<UndistortImageJob>& jobs,
+                    UndistortionMapCache* undistortion_maps);
+
 }  // namespace theia
 
 #endif  // THEIA_SFM_UNDISTORT_IMAGE_H_
@@ -34,9 +34,11 @@
 
 #include "theia/sfm/view.h"
 
+#include <algorithm>
+#include <iterator>
 #include <string>
-#include <unordered_map>
-#include <unordered_set>
+#include <utility>
+#include <vector>
 
 #include "theia/sfm/camera/camera.h"
 #include "theia/sfm/camera_intrinsics_prior.h"
@@ -47,12 +49,25 @@
 namespace theia {
 using Vector2d = Eigen::Vector2d;
 
+namespace {
+
+// Orders the entries of the feature index by their feature positions.
+template <class Entry>
+bool FeaturePositionLess(const Entry& lhs, const Entry& rhs) {
+  return lhs.x < rhs.x || (lhs.x == rhs.x && lhs.y < rhs.y);
+}
+
+}  // namespace
+
 View::View()
     : name_(""),
       is_estimated_(false),
       timestamp_(0.0),
       has_position_prior_(false),
-      has_gravity_prior_(false) {
+      has_gravity_prior_(false),
+      num_feature_index_entries_(0),
+      num_removed_feature_index_entries_(0),
+      bearing_vectors_intrinsics_type_(CameraIntrinsicsModelType::PINHOLE) {
   position_prior_.setZero();
   position_prior_sqrt_information_.setIdentity();
   gravity_prior_.setZero();
@@ -64,7 +79,10 @@ View::View(const std::string& name)
       is_estimated_(false),
       timestamp_(0.0),
       has_position_prior_(false),
-      has_gravity_prior_(false) {
+      has_gravity_prior_(false),
+      num_feature_index_entries_(0),
+      num_removed_feature_index_entries_(0),
+      bearing_vectors_intrinsics_type_(CameraIntrinsicsModelType::PINHOLE) {
   position_prior_.setZero();
   position_prior_sqrt_information_.setIdentity();
   gravity_prior_.setZero();
@@ -76,7 +94,10 @@ View::View(const std::string& name, const double timestamp)
       is_estimated_(false),
       timestamp_(timestamp),
       has_position_prior_(false),
-      has_gravity_prior_(false) {
+      has_gravity_prior_(false),
+      num_feature_index_entries_(0),
+      num_removed_feature_index_entries_(0),
+      bearing_vectors_intrinsics_type_(CameraIntrinsicsModelType::PINHOLE) {
   position_prior_.setZero();
   position_prior_sqrt_information_.setIdentity();
   gravity_prior_.setZero();
@@ -109,39 +130,235 @@ void View::SetCameraIntrinsicsPrior(struct CameraIntrinsicsPrior prior) {
 
 int View::NumFeatures() const { return features_.size(); }
 
-std::vector<TrackId> View::TrackIds() const {
-  std::vector<TrackId> track_ids;
-  track_ids.reserve(features_.size());
-  for (const auto& track : features_) {
-    track_ids.emplace_back(track.first);
-  }
-  return track_ids;
+void View::ReserveFeatures(const int num_features) {
+  features_.reserve(num_features);
 }
 
+std::vector<TrackId> View::TrackIds() const { return features_.keys(); }
+
 const Feature* View::GetFeature(const TrackId track_id) const {
-  return FindOrNull(features_, track_id);
+  return features_.Find(track_id);
 }
 
 const TrackId View::GetTrack(const Feature& feature) const {
-  const TrackId* t_id = FindOrNull(features_to_tracks_, feature);
-  if (t_id) {
-    return *t_id;
+  const FeatureTrack key = {feature.x(), feature.y(), kInvalidTrackId};
+  for (const std::vector<FeatureTrack>& run : feature_index_runs_) {
+    const auto range = std::equal_range(
+        run.begin(), run.end(), key, FeaturePositionLess<FeatureTrack>);
+    for (auto it = range.first; it != range.second; ++it) {
+      if (it->track_id != kInvalidTrackId) {
+        return it->track_id;
+      }
+    }
   }
   return kInvalidTrackId;
 }
 
 void View::AddFeature(const TrackId track_id, const Feature& feature) {
-  features_[track_id] = feature;
-  features_to_tracks_[feature] = track_id;
+  const Feature* existing_feature = features_.Find(track_id);
+  if (existing_feature != nullptr) {
+    RemoveFromFeatureIndex(track_id, *existing_feature);
+  }
+  InsertFeature(track_id, feature);
+  AddToFeatureIndex(track_id, feature);
+}
+
+void View::AddFeatures(
+    const std::vector<std::pair<TrackId, Feature> >& features) {
+  features_.reserve(features_.size() + features.size());
+  for (const auto& feature : features) {
+    InsertFeature(feature.first, feature.second);
+  }
+  BuildFeatureIndex();
+}
+
+void View::InsertFeature(const TrackId track_id, const Feature& feature) {
+  features_.InsertOrAssign(track_id, feature);
+  if (bearing_vectors_.empty()) {
+    return;
+  }
+  if (!HasBearingVectorsOfIntrinsics()) {
+    ClearBearingVectors();
+    return;
+  }
+
+  // Keep the cache aligned with the features: a new feature is appended and
+  // an existing feature is overwritten in place.
+  const Eigen::Vector3d bearing_vector =
+      camera_.PixelToUnitDepthRay(feature.point_).normalized();
+  const int64_t position = features_.Position(track_id);
+  if (position == bearing_vectors_.size()) {
+    bearing_vectors_.emplace_back(bearing_vector);
+  } else {
+    bearing_vectors_[position] = bearing_vector;
+  }
 }
 
 bool View::RemoveFeature(const TrackId track_id) {
-  const auto feature = FindOrNull(features_, track_id);
-  if (feature) {
-    return features_.erase(track_id) > 0 &&
-           features_to_tracks_.erase(*feature) > 0;
+  const Feature* feature = features_.Find(track_id);
+  if (feature == nullptr) {
+    return false;
+  }
+  RemoveFromFeatureIndex(track_id, *feature);
+  const int64_t position = features_.Position(track_id);
+  features_.Erase(track_id);
+  // The features map moves its last entry into the erased position, and so
+  // does the cache.
+  if (bearing_vectors_.size() == features_.size() + 1) {
+    bearing_vectors_[position] = bearing_vectors_.back();
+    bearing_vectors_.pop_back();
+  }
+  return true;
+}
+
+void View::AddToFeatureIndex(const TrackId track_id, const Feature& feature) {
+  const FeatureTrack entry = {feature.x(), feature.y(), track_id};
+  feature_index_runs_.emplace_back(1, entry);
+  ++num_feature_index_entries_;
+
+  // Merge the last run into the one before it until the runs shrink
+  // geometrically. The removed entries of the merged runs are dropped.
+  while (feature_index_runs_.size() > 1 &&
+         feature_index_runs_[feature_index_runs_.size() - 2].size() <=
+             2 * feature_index_runs_.back().size()) {
+    std::vector<FeatureTrack>& run1 =
+        feature_index_runs_[feature_index_runs_.size() - 2];
+    const std::vector<FeatureTrack>& run2 = feature_index_runs_.back();
+    std::vector<FeatureTrack> merged_run;
+    merged_run.reserve(run1.size() + run2.size());
+    std::merge(run1.begin(),
+               run1.end(),
+               run2.begin(),
+               run2.end(),
+               std::back_inserter(merged_run),
+               FeaturePositionLess<FeatureTrack>);
+    const int num_merged_entries = merged_run.size();
+    merged_run.erase(std::remove_if(merged_run.begin(),
+                                    merged_run.end(),
+                                    [](const FeatureTrack& merged_entry) {
+                                      return merged_entry.track_id ==
+                                             kInvalidTrackId;
+                                    }),
+                     merged_run.end());
+    num_feature_index_entries_ -= num_merged_entries - merged_run.size();
+    num_removed_feature_index_entries_ -=
+        num_merged_entries - merged_run.size();
+    run1.swap(merged_run);
+    feature_index_runs_.pop_back();
+  }
+}
+
+void View::RemoveFromFeatureIndex(const TrackId track_id,
+                                  const Feature& feature) {
+  const FeatureTrack key = {feature.x(), feature.y(), track_id};
+  for (std::vector<FeatureTrack>& run : feature_index_runs_) {
+    const auto range = std::equal_range(
+        run.begin(), run.end(), key, FeaturePositionLess<FeatureTrack>);
+    const auto removed_entry = std::find_if(
+        range.first, range.second, [&](const FeatureTrack& entry) {
+          return entry.track_id == track_id;
+        });
+    if (removed_entry != range.second) {
+      removed_entry->track_id = kInvalidTrackId;
+      ++num_removed_feature_index_entries_;
+      break;
+    }
+  }
+  if (2 * num_removed_feature_index_entries_ <= num_feature_index_entries_) {
+    return;
+  }
+
+  // Compact the index once half of its entries are removed. The features are
+  // updated after the index, so it is compacted without them.
+  std::vector<FeatureTrack> compacted_run;
+  compacted_run.reserve(num_feature_index_entries_ -
+                        num_removed_feature_index_entries_);
+  for (const std::vector<FeatureTrack>& run : feature_index_runs_) {
+    for (const FeatureTrack& entry : run) {
+      if (entry.track_id != kInvalidTrackId) {
+        compacted_run.emplace_back(entry);
+      }
+    }
+  }
+  std::sort(compacted_run.begin(),
+            compacted_run.end(),
+            FeaturePositionLess<FeatureTrack>);
+  feature_index_runs_.clear();
+  if (!compacted_run.empty()) {
+    feature_index_runs_.emplace_back(std::move(compacted_run));
+  }
+  num_feature_index_entries_ -= num_removed_feature_index_entries_;
+  num_removed_feature_index_entries_ = 0;
+}
+
+void View::BuildFeatureIndex() {
+  std::vector<FeatureTrack> run(features_.size());
+  for (int i = 0; i < features_.size(); i++) {
+    const Feature& feature = features_.values()[i];
+    run[i] = {feature.x(), feature.y(), features_.keys()[i]};
+  }
+  std::sort(run.begin(), run.end(), FeaturePositionLess<FeatureTrack>);
+  feature_index_runs_.clear();
+  if (!run.empty()) {
+    feature_index_runs_.emplace_back(std::move(run));
+  }
+  num_feature_index_entries_ = features_.size();
+  num_removed_feature_index_entries_ = 0;
+}
+
+bool View::HasBearingVectorsOfIntrinsics() const {
+  const CameraIntrinsicsModel& intrinsics = *camera_.CameraIntrinsics();
+  return intrinsics.Type() == bearing_vectors_intrinsics_type_ &&
+         intrinsics.NumParameters() == bearing_vectors_intrinsics_.size() &&
+         std::equal(bearing_vectors_intrinsics_.begin(),
+                    bearing_vectors_intrinsics_.end(),
+                    intrinsics.parameters());
+}
+
+void View::UpdateBearingVectors() {
+  if (HasBearingVectors()) {
+    return;
+  }
+  const CameraIntrinsicsModel& intrinsics = *camera_.CameraIntrinsics();
+  bearing_vectors_intrinsics_type_ = intrinsics.Type();
+  bearing_vectors_intrinsics_.assign(
+      intrinsics.parameters(),
+      intrinsics.parameters() + intrinsics.NumParameters());
+
+  bearing_vectors_.resize(features_.size());
+  for (int i = 0; i < features_.size(); i++) {
+    bearing_vectors_[i] =
+        camera_.PixelToUnitDepthRay(features_.values()[i].point_)
+            .normalized();
+  }
+}
+
+void View::ClearBearingVectors() {
+  bearing_vectors_.clear();
+  bearing_vectors_.shrink_to_fit();
+  bearing_vectors_intrinsics_.clear();
+}
+
+bool View::HasBearingVectors() const {
+  return !bearing_vectors_intrinsics_.empty() &&
+         bearing_vectors_.size() == features_.size() &&
+         HasBearingVectorsOfIntrinsics();
+}
+
+bool View::GetBearingVector(const TrackId track_id,
+                            Eigen::Vector3d* bearing_vector) const {
+  const int64_t position = features_.Position(track_id);
+  if (position < 0) {
+    return false;
+  }
+  if (HasBearingVectors()) {
+    *bearing_vector = bearing_vectors_[position];
+  } else {
+    *bearing_vector =
+        camera_.PixelToUnitDepthRay(features_.values()[position].point_)
+            .normalized();
   }
-  return false;
+  return true;
 }
 
 double View::GetTimestamp() const { return timestamp_; }
@@ -162,7 +379,7 @@ Eigen::Matrix3d View::GetPositionPriorSqrtInformation() const {
   return position_prior_sqrt_information_;
 }
 
-bool View::HasPositionPrior() const { return has_gravity_prior_; }
+bool View::HasPositionPrior() const { return has_position_prior_; }
 
 void View::SetGravityPrior(
     const Eigen::Vector3d& gravity_prior,
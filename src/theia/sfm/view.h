@@ -38,16 +38,16 @@
 #include <cereal/access.hpp>
 #include <cereal/cereal.hpp>
 #include <cereal/types/string.hpp>
-#include <cereal/types/unordered_map.hpp>
 #include <stdint.h>
 #include <string>
-#include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "theia/sfm/camera/camera.h"
 #include "theia/sfm/camera_intrinsics_prior.h"
 #include "theia/sfm/feature.h"
 #include "theia/sfm/types.h"
+#include "theia/util/flat_hash_map.h"
 
 namespace theia {
 
@@ -78,16 +78,48 @@ class View {
 
   int NumFeatures() const;
 
+  // Reserves memory for num_features features so that adding up to that many
+  // features does not reallocate.
+  void ReserveFeatures(const int num_features);
+
   std::vector<TrackId> TrackIds() const;
 
   const Feature* GetFeature(const TrackId track_id) const;
 
+  // Returns the track of the feature or kInvalidTrackId if the view has no
+  // such feature. The features are indexed by their positions, so this is a
+  // few binary searches.
   const TrackId GetTrack(const Feature& feature) const;
 
   void AddFeature(const TrackId track_id, const Feature& feature);
 
+  // Adds the features of many tracks at once. This is equivalent to calling
+  // AddFeature for each of them, but the index from features to tracks is
+  // built once for all features instead of being updated per feature.
+  void AddFeatures(const std::vector<std::pair<TrackId, Feature> >& features);
+
   bool RemoveFeature(const TrackId track_id);
 
+  // An optional cache of the bearing vectors of the features, i.e. the unit
+  // rays of the undistorted features in the camera coordinate system. Each
+  // bearing vector costs an (often iterative) undistortion, so consumers that
+  // look at the same observations repeatedly (e.g. track estimation) compute
+  // them once. The cache is stored alongside the features, is kept up to date
+  // when features are added or removed, and is invalid once the intrinsics of
+  // the camera change. It is not serialized.
+  //
+  // Computes the bearing vectors of all features with the current intrinsics
+  // unless they are already cached.
+  void UpdateBearingVectors();
+  void ClearBearingVectors();
+  // Returns true if the bearing vectors are cached and the intrinsics have
+  // not changed since.
+  bool HasBearingVectors() const;
+  // Returns the bearing vector of the feature, from the cache if it is valid
+  // and computed otherwise. Returns false if the view has no such feature.
+  bool GetBearingVector(const TrackId track_id,
+                        Eigen::Vector3d* bearing_vector) const;
+
   double GetTimestamp() const;
 
   void SetTimestamp(const double timestamp);
@@ -105,9 +137,58 @@ class View {
   bool HasGravityPrior() const;
 
  private:
+  // Returns true if the cached bearing vectors were computed with the current
+  // intrinsics of the camera.
+  bool HasBearingVectorsOfIntrinsics() const;
+
+  // Adds the feature to the features and the bearing vector cache, but not to
+  // the index from features to tracks.
+  void InsertFeature(const TrackId track_id, const Feature& feature);
+
+  // An entry of the index from features to tracks.
+  struct FeatureTrack {
+    double x;
+    double y;
+    TrackId track_id;
+  };
+
+  void AddToFeatureIndex(const TrackId track_id, const Feature& feature);
+  void RemoveFromFeatureIndex(const TrackId track_id, const Feature& feature);
+  // Rebuilds the index from features_ as a single sorted run.
+  void BuildFeatureIndex();
+
   // Templated method for disk I/O with cereal. This method tells cereal which
   // data members should be used when reading/writing to/from disk.
   friend class cereal::access;
+  // The map from features to tracks that archives contain after the features.
+  // It is written so that archives remain readable by older versions. When
+  // reading, it is skipped and the index is rebuilt from the features.
+  struct SerializedFeaturesToTracks {
+    View* view;
+
+    template <class Archive>
+    void save(Archive& ar) const {  // NOLINT
+      const FlatHashMap<TrackId, Feature>& features = view->features_;
+      ar(cereal::make_size_tag(
+          static_cast<cereal::size_type>(features.size())));
+      for (int i = 0; i < features.size(); i++) {
+        ar(cereal::make_map_item(features.values()[i], features.keys()[i]));
+      }
+    }
+
+    template <class Archive>
+    void load(Archive& ar) {  // NOLINT
+      cereal::size_type size;
+      ar(cereal::make_size_tag(size));
+      for (cereal::size_type i = 0; i < size; i++) {
+        Feature feature;
+        TrackId track_id;
+        ar(cereal::make_map_item(feature, track_id));
+      }
+      view->BuildFeatureIndex();
+    }
+  };
+
   template <class Archive>
   void serialize(Archive& ar, const std::uint32_t version) {  // NOLINT
     ar(name_,
@@ -116,7 +197,7 @@ class View {
        camera_,
        camera_intrinsics_prior_,
        features_,
-       features_to_tracks_,
+       SerializedFeaturesToTracks{this},
        position_prior_,
        position_prior_sqrt_information_,
        has_position_prior_,
@@ -130,8 +211,25 @@ class View {
   bool is_estimated_;
   class Camera camera_;
   struct CameraIntrinsicsPrior camera_intrinsics_prior_;
-  std::unordered_map<TrackId, Feature> features_;
-  std::unordered_map<Feature, TrackId> features_to_tracks_;
+  // The features are stored densely since views have many of them.
+  FlatHashMap<TrackId, Feature> features_;
+
+  // The index from features to tracks. It consists of runs that are each
+  // sorted by the feature positions and whose sizes decrease geometrically,
+  // so that a lookup binary searches O(log n) runs and adding a feature moves
+  // each entry O(log n) times. Removed entries are marked with
+  // kInvalidTrackId and dropped when their run is merged, or when half of the
+  // entries are removed.
+  std::vector<std::vector<FeatureTrack> > feature_index_runs_;
+  int num_feature_index_entries_;
+  int num_removed_feature_index_entries_;
+
+  // The bearing vector of the i-th feature, or empty if they are not cached,
+  // and the intrinsics they were computed with.
+  std::vector<Eigen::Vector3d, Eigen::aligned_allocator<Eigen::Vector3d> >
+      bearing_vectors_;
+  CameraIntrinsicsModelType bearing_vectors_intrinsics_type_;
+  std::vector<double> bearing_vectors_intrinsics_;
 
   // A prior on an absolute position (e.g. GPS)
   Eigen::Vector3d position_prior_;
@@ -0,0 +1,231 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#include "theia/sfm/view_graph/compact_view_graph.h"
+
+#include <glog/logging.h>
+#include <algorithm>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "theia/sfm/twoview_info.h"
+#include "theia/sfm/types.h"
+#include "theia/sfm/view_graph/view_graph.h"
+
+namespace theia {
+
+namespace {
+
+typedef std::pair<ViewIdPair, const TwoViewInfo*> SortableEdge;
+
+bool CompareSortableEdges(const SortableEdge& edge1, const SortableEdge& edge2) {
+  return edge1.first < edge2.first;
+}
+
+}  // namespace
+
+CompactViewGraph::CompactViewGraph(const ViewGraph& view_graph) {
+  // Views without any edges are part of the snapshot as well.
+  const std::unordered_set<ViewId> view_ids = view_graph.ViewIds();
+  view_ids_.assign(view_ids.begin(), view_ids.end());
+  std::sort(view_ids_.begin(), view_ids_.end());
+
+  std::vector<SortableEdge> sorted_edges;
+  sorted_edges.reserve(view_graph.NumEdges());
+  for (const auto& edge : view_graph.GetAllEdges()) {
+    sorted_edges.emplace_back(edge.first, &edge.second);
+  }
+  std::sort(sorted_edges.begin(), sorted_edges.end(), CompareSortableEdges);
+
+  edges_.reserve(sorted_edges.size());
+  edge_views_.reserve(sorted_edges.size());
+  for (const SortableEdge& edge : sorted_edges) {
+    edge_views_.emplace_back(ViewIndex(edge.first.first),
+                             ViewIndex(edge.first.second));
+    edges_.emplace_back(*edge.second);
+  }
+  BuildAdjacency();
+}
+
+CompactViewGraph::CompactViewGraph(
+    const std::unordered_map<ViewIdPair, TwoViewInfo>& view_pairs) {
+  std::vector<SortableEdge> sorted_edges;
+  sorted_edges.reserve(view_pairs.size());
+  view_ids_.reserve(2 * view_pairs.size());
+  for (const auto& view_pair : view_pairs) {
+    CHECK_LT(view_pair.first.first, view_pair.first.second);
+    sorted_edges.emplace_back(view_pair.first, &view_pair.second);
+    view_ids_.emplace_back(view_pair.first.first);
+    view_ids_.emplace_back(view_pair.first.second);
+  }
+  std::sort(sorted_edges.begin(), sorted_edges.end(), CompareSortableEdges);
+  std::sort(view_ids_.begin(), view_ids_.end());
+  view_ids_.erase(std::unique(view_ids_.begin(), view_ids_.end()),
+                  view_ids_.end());
+  view_ids_.shrink_to_fit();
+
+  edges_.reserve(sorted_edges.size());
+  edge_views_.reserve(sorted_edges.size());
+  for (const SortableEdge& edge : sorted_edges) {
+    edge_views_.emplace_back(ViewIndex(edge.first.first),
+                             ViewIndex(edge.first.second));
+    edges_.emplace_back(*edge.second);
+  }
+  BuildAdjacency();
+}
+
+CompactViewGraph::CompactViewGraph(
+    std::vector<ViewId> view_ids,
+    std::vector<std::pair<int, int> > edge_views,
+    std::vector<TwoViewInfo> edges)
+    : view_ids_(std::move(view_ids)),
+      edge_views_(std::move(edge_views)),
+      edges_(std::move(edges)) {
+  CHECK_EQ(edge_views_.size(), edges_.size());
+  BuildAdjacency();
+}
+
+void CompactViewGraph::BuildAdjacency() {
+  const int num_views = view_ids_.size();
+  offsets_.assign(num_views + 1, 0);
+  for (const auto& edge : edge_views_) {
+    ++offsets_[edge.first + 1];
+    ++offsets_[edge.second + 1];
+  }
+  for (int i = 0; i < num_views; i++) {
+    offsets_[i + 1] += offsets_[i];
+  }
+
+  // Since the edges are sorted, filling the rows in edge order leaves each
+  // neighbor list sorted: the neighbors with a smaller index come from edges
+  // that precede all edges where the view is the first view.
+  neighbors_.resize(offsets_[num_views]);
+  incident_edges_.resize(offsets_[num_views]);
+  std::vector<int> fill_position(offsets_.begin(), offsets_.end() - 1);
+  for (int i = 0; i < edge_views_.size(); i++) {
+    const int view1 = edge_views_[i].first;
+    const int view2 = edge_views_[i].second;
+    neighbors_[fill_position[view1]] = view2;
+    incident_edges_[fill_position[view1]++] = i;
+    neighbors_[fill_position[view2]] = view1;
+    incident_edges_[fill_position[view2]++] = i;
+  }
+}
+
+int CompactViewGraph::ViewIndex(const ViewId view_id) const {
+  const auto it =
+      std::lower_bound(view_ids_.begin(), view_ids_.end(), view_id);
+  if (it == view_ids_.end() || *it != view_id) {
+    return -1;
+  }
+  return std::distance(view_ids_.begin(), it);
+}
+
+int CompactViewGraph::EdgeIndex(const int view_index1,
+                                const int view_index2) const {
+  const int source =
+      Degree(view_index1) <= Degree(view_index2) ? view_index1 : view_index2;
+  const int target = source == view_index1 ? view_index2 : view_index1;
+  const int* neighbors_begin = Neighbors(source);
+  const int* neighbors_end = neighbors_begin + Degree(source);
+  const int* neighbor =
+      std::lower_bound(neighbors_begin, neighbors_end, target);
+  if (neighbor == neighbors_end || *neighbor != target) {
+    return -1;
+  }
+  return IncidentEdges(source)[neighbor - neighbors_begin];
+}
+
+int CompactViewGraph::ConnectedComponents(
+    std::vector<int>* component_labels) const {
+  CHECK_NOTNULL(component_labels)->assign(NumViews(), -1);
+
+  int num_components = 0;
+  std::vector<int> queue;
+  queue.reserve(NumViews());
+  for (int root = 0; root < NumViews(); root++) {
+    if ((*component_labels)[root] >= 0) {
+      continue;
+    }
+
+    // Breadth first search from the root.
+    queue.clear();
+    queue.emplace_back(root);
+    (*component_labels)[root] = num_components;
+    for (int i = 0; i < queue.size(); i++) {
+      const int view_index = queue[i];
+      const int* neighbors = Neighbors(view_index);
+      for (int j = 0; j < Degree(view_index); j++) {
+        if ((*component_labels)[neighbors[j]] < 0) {
+          (*component_labels)[neighbors[j]] = num_components;
+          queue.emplace_back(neighbors[j]);
+        }
+      }
+    }
+    ++num_components;
+  }
+  return num_components;
+}
+
+std::vector<int> CompactViewGraph::LargestConnectedComponent() const {
+  std::vector<int> component_labels;
+  const int num_components = ConnectedComponents(&component_labels);
+
+  std::vector<int> component_sizes(num_components, 0);
+  for (const int label : component_labels) {
+    ++component_sizes[label];
+  }
+
+  // Components are labeled in order of their smallest view index, so the first
+  // maximum breaks ties as documented.
+  std::vector<int> largest_component;
+  if (num_components == 0) {
+    return largest_component;
+  }
+  const int largest_label =
+      std::distance(component_sizes.begin(),
+                    std::max_element(component_sizes.begin(),
+                                     component_sizes.end()));
+  largest_component.reserve(component_sizes[largest_label]);
+  for (int i = 0; i < component_labels.size(); i++) {
+    if (component_labels[i] == largest_label) {
+      largest_component.emplace_back(i);
+    }
+  }
+  return largest_component;
+}
+
+}  // namespace theia
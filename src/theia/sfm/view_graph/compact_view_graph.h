@@ -0,0 +1,137 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#ifndef THEIA_SFM_VIEW_GRAPH_COMPACT_VIEW_GRAPH_H_
+#define THEIA_SFM_VIEW_GRAPH_COMPACT_VIEW_GRAPH_H_
+
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "theia/sfm/twoview_info.h"
+#include "theia/sfm/types.h"
+#include "theia/util/hash.h"
+
+namespace theia {
+
+class ViewGraph;
+
+// An immutable snapshot of a view graph stored in compressed sparse row (CSR)
+// form. Views are remapped to dense indices [0, NumViews()) in increasing view
+// id order and edges to dense indices [0, NumEdges()) in increasing
+// (view id 1, view id 2) order. The neighbors and incident edges of each view
+// are stored contiguously so that graph algorithms can traverse the graph
+// without any hash lookups. The snapshot does not track later modifications of
+// the graph it was created from.
+class CompactViewGraph {
+ public:
+  explicit CompactViewGraph(const ViewGraph& view_graph);
+  explicit CompactViewGraph(
+      const std::unordered_map<ViewIdPair, TwoViewInfo>& view_pairs);
+  // Builds the snapshot from its columns, e.g. when it is read from disk. The
+  // view ids must be strictly increasing and the edges must be given as pairs
+  // of view indices (view index 1 < view index 2) in strictly increasing
+  // order, with the edge values in the same order.
+  CompactViewGraph(std::vector<ViewId> view_ids,
+                   std::vector<std::pair<int, int> > edge_views,
+                   std::vector<TwoViewInfo> edges);
+
+  int NumViews() const { return view_ids_.size(); }
+  int NumEdges() const { return edges_.size(); }
+
+  // Conversion between view ids and dense view indices. ViewIndex returns -1
+  // if the view is not in the graph.
+  ViewId ViewIdForIndex(const int view_index) const {
+    return view_ids_[view_index];
+  }
+  int ViewIndex(const ViewId view_id) const;
+
+  // The neighbors of a view. Neighbors(i)[k] is connected to view i by the edge
+  // IncidentEdges(i)[k], for k in [0, Degree(i)). Neighbors are sorted by view
+  // index.
+  int Degree(const int view_index) const {
+    return offsets_[view_index + 1] - offsets_[view_index];
+  }
+  const int* Neighbors(const int view_index) const {
+    return neighbors_.data() + offsets_[view_index];
+  }
+  const int* IncidentEdges(const int view_index) const {
+    return incident_edges_.data() + offsets_[view_index];
+  }
+
+  // Returns the index of the edge between the two views or -1 if the views are
+  // not connected. This is a binary search in the neighbors of the view with
+  // the smaller degree.
+  int EdgeIndex(const int view_index1, const int view_index2) const;
+
+  // The view indices of an edge with EdgeView1(e) < EdgeView2(e), so that the
+  // edge value is the TwoViewInfo from view EdgeView1(e) to EdgeView2(e).
+  int EdgeView1(const int edge_index) const {
+    return edge_views_[edge_index].first;
+  }
+  int EdgeView2(const int edge_index) const {
+    return edge_views_[edge_index].second;
+  }
+  ViewIdPair EdgeViewIds(const int edge_index) const {
+    return ViewIdPair(view_ids_[edge_views_[edge_index].first],
+                      view_ids_[edge_views_[edge_index].second]);
+  }
+  const TwoViewInfo& Edge(const int edge_index) const {
+    return edges_[edge_index];
+  }
+
+  // Labels each view with the index of its connected component. Returns the
+  // number of connected components.
+  int ConnectedComponents(std::vector<int>* component_labels) const;
+
+  // Returns the sorted view indices of the largest connected component. Ties
+  // are broken in favor of the component containing the smallest view index.
+  std::vector<int> LargestConnectedComponent() const;
+
+ private:
+  // Builds the CSR arrays from the view ids and the edges, which must both be
+  // sorted already.
+  void BuildAdjacency();
+
+  std::vector<ViewId> view_ids_;
+  std::vector<int> offsets_;
+  std::vector<int> neighbors_;
+  std::vector<int> incident_edges_;
+  std::vector<std::pair<int, int> > edge_views_;
+  std::vector<TwoViewInfo> edges_;
+};
+
+}  // namespace theia
+
+#endif  // THEIA_SFM_VIEW_GRAPH_COMPACT_VIEW_GRAPH_H_
@@ -0,0 +1,168 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#include <algorithm>
+#include <unordered_map>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "theia/sfm/twoview_info.h"
+#include "theia/sfm/types.h"
+#include "theia/sfm/view_graph/compact_view_graph.h"
+#include "theia/sfm/view_graph/view_graph.h"
+#include "theia/util/random.h"
+
+namespace theia {
+
+TEST(CompactViewGraph, EmptyGraph) {
+  ViewGraph view_graph;
+  const CompactViewGraph compact_view_graph(view_graph);
+  EXPECT_EQ(compact_view_graph.NumViews(), 0);
+  EXPECT_EQ(compact_view_graph.NumEdges(), 0);
+  EXPECT_TRUE(compact_view_graph.LargestConnectedComponent().empty());
+}
+
+TEST(CompactViewGraph, Adjacency) {
+  TwoViewInfo info;
+  ViewGraph view_graph;
+  info.num_verified_matches = 1;
+  view_graph.AddEdge(10, 3, info);
+  info.num_verified_matches = 2;
+  view_graph.AddEdge(3, 7, info);
+  info.num_verified_matches = 3;
+  view_graph.AddEdge(7, 10, info);
+  info.num_verified_matches = 4;
+  view_graph.AddEdge(20, 21, info);
+
+  const CompactViewGraph compact_view_graph(view_graph);
+  EXPECT_EQ(compact_view_graph.NumViews(), 5);
+  EXPECT_EQ(compact_view_graph.NumEdges(), 4);
+
+  // Views are indexed in increasing view id order.
+  const std::vector<ViewId> expected_view_ids = {3, 7, 10, 20, 21};
+  for (int i = 0; i < expected_view_ids.size(); i++) {
+    EXPECT_EQ(compact_view_graph.ViewIdForIndex(i), expected_view_ids[i]);
+    EXPECT_EQ(compact_view_graph.ViewIndex(expected_view_ids[i]), i);
+  }
+  EXPECT_EQ(compact_view_graph.ViewIndex(4), -1);
+  EXPECT_EQ(compact_view_graph.ViewIndex(100), -1);
+
+  // Every neighbor entry must refer to an edge between the two views with the
+  // same edge value as the view graph.
+  for (int i = 0; i < compact_view_graph.NumViews(); i++) {
+    const ViewId view_id = compact_view_graph.ViewIdForIndex(i);
+    EXPECT_EQ(compact_view_graph.Degree(i),
+              view_graph.GetNeighborIdsForView(view_id)->size());
+    for (int j = 0; j < compact_view_graph.Degree(i); j++) {
+      const int neighbor = compact_view_graph.Neighbors(i)[j];
+      const int edge = compact_view_graph.IncidentEdges(i)[j];
+      if (j > 0) {
+        EXPECT_LT(compact_view_graph.Neighbors(i)[j - 1], neighbor);
+      }
+      EXPECT_EQ(std::min(i, neighbor), compact_view_graph.EdgeView1(edge));
+      EXPECT_EQ(std::max(i, neighbor), compact_view_graph.EdgeView2(edge));
+
+      const ViewId neighbor_id = compact_view_graph.ViewIdForIndex(neighbor);
+      EXPECT_EQ(compact_view_graph.Edge(edge).num_verified_matches,
+                view_graph.GetEdge(view_id, neighbor_id)->num_verified_matches);
+    }
+  }
+
+  EXPECT_EQ(compact_view_graph.EdgeIndex(0, 2), 1);
+  EXPECT_EQ(compact_view_graph.EdgeIndex(2, 0), 1);
+  EXPECT_EQ(compact_view_graph.EdgeIndex(3, 4), 3);
+  EXPECT_EQ(compact_view_graph.EdgeIndex(0, 3), -1);
+
+  // Edges are sorted by view id pair.
+  EXPECT_EQ(compact_view_graph.EdgeViewIds(0), ViewIdPair(3, 7));
+  EXPECT_EQ(compact_view_graph.EdgeViewIds(1), ViewIdPair(3, 10));
+  EXPECT_EQ(compact_view_graph.EdgeViewIds(2), ViewIdPair(7, 10));
+  EXPECT_EQ(compact_view_graph.EdgeViewIds(3), ViewIdPair(20, 21));
+}
+
+TEST(CompactViewGraph, ConnectedComponents) {
+  TwoViewInfo info;
+  ViewGraph view_graph;
+  view_graph.AddEdge(0, 1, info);
+  view_graph.AddEdge(5, 6, info);
+  view_graph.AddEdge(6, 7, info);
+  view_graph.AddEdge(2, 3, info);
+  view_graph.AddEdge(3, 4, info);
+
+  const CompactViewGraph compact_view_graph(view_graph);
+  std::vector<int> labels;
+  EXPECT_EQ(compact_view_graph.ConnectedComponents(&labels), 3);
+  EXPECT_EQ(labels[0], labels[1]);
+  EXPECT_EQ(labels[2], labels[3]);
+  EXPECT_EQ(labels[2], labels[4]);
+  EXPECT_EQ(labels[5], labels[6]);
+  EXPECT_NE(labels[0], labels[2]);
+  EXPECT_NE(labels[2], labels[5]);
+
+  // Both components of size 3 are largest; the one with view 2 comes first.
+  const std::vector<int> expected_largest = {2, 3, 4};
+  EXPECT_EQ(compact_view_graph.LargestConnectedComponent(), expected_largest);
+}
+
+TEST(CompactViewGraph, FromViewPairs) {
+  RandomNumberGenerator rng(52);
+  std::unordered_map<ViewIdPair, TwoViewInfo> view_pairs;
+  ViewGraph view_graph;
+  for (int i = 0; i < 200; i++) {
+    const ViewId view_id1 = rng.RandInt(0, 49);
+    const ViewId view_id2 = rng.RandInt(0, 49);
+    if (view_id1 == view_id2) {
+      continue;
+    }
+    TwoViewInfo info;
+    info.num_verified_matches = i;
+    const ViewIdPair view_id_pair(std::min(view_id1, view_id2),
+                                  std::max(view_id1, view_id2));
+    view_pairs[view_id_pair] = info;
+    view_graph.AddEdge(view_id_pair.first, view_id_pair.second, info);
+  }
+
+  const CompactViewGraph from_view_graph(view_graph);
+  const CompactViewGraph from_view_pairs(view_pairs);
+  ASSERT_EQ(from_view_graph.NumViews(), from_view_pairs.NumViews());
+  ASSERT_EQ(from_view_graph.NumEdges(), from_view_pairs.NumEdges());
+  for (int i = 0; i < from_view_graph.NumEdges(); i++) {
+    EXPECT_EQ(from_view_graph.EdgeViewIds(i), from_view_pairs.EdgeViewIds(i));
+    EXPECT_EQ(from_view_graph.Edge(i).num_verified_matches,
+              from_view_pairs.Edge(i).num_verified_matches);
+  }
+}
+
+}  // namespace theia
@@ -43,19 +43,16 @@
 #include <utility>
 #include <vector>
 
-#include "theia/math/graph/minimum_spanning_tree.h"
+#include "theia/math/graph/parallel_minimum_spanning_tree.h"
 #include "theia/sfm/twoview_info.h"
 #include "theia/sfm/types.h"
+#include "theia/sfm/view_graph/compact_view_graph.h"
 #include "theia/sfm/view_graph/view_graph.h"
+#include "theia/util/hash.h"
 #include "theia/util/map_util.h"
 
 namespace theia {
 namespace {
-typedef std::pair<TwoViewInfo, ViewIdPair> HeapElement;
-
-bool SortHeapElement(const HeapElement& h1, const HeapElement& h2) {
-  return h1.first.num_verified_matches > h2.first.num_verified_matches;
-}
 
 // Computes the orientation of the neighbor camera based on the orientation of
 // the source camera and the relative rotation between the cameras.
@@ -83,98 +80,95 @@ Eigen::Vector3d ComputeOrientation(const Eigen::Vector3d& source_orientation,
   return orientation;
 }
 
-// Adds all the edges of view_id to the heap. Only edges that do not already
-// have an orientation estimation are added.
-void AddEdgesToHeap(
-    const ViewGraph& view_graph,
-    const std::unordered_map<ViewId, Eigen::Vector3d>& orientations,
-    const ViewId view_id,
-    std::vector<HeapElement>* heap) {
-  const std::unordered_set<ViewId>* edge_ids =
-      view_graph.GetNeighborIdsForView(view_id);
-  for (const ViewId edge_id : *edge_ids) {
-    // Only add edges to the heap that contain a vertex that has not been seen.
-    if (ContainsKey(orientations, edge_id)) {
-      continue;
-    }
+}  // namespace
 
-    heap->emplace_back(*view_graph.GetEdge(view_id, edge_id),
-                       ViewIdPair(view_id, edge_id));
-    std::push_heap(heap->begin(), heap->end(), SortHeapElement);
-  }
+bool OrientationsFromMaximumSpanningTree(
+    const ViewGraph& view_graph,
+    std::unordered_map<ViewId, Eigen::Vector3d>* orientations) {
+  return OrientationsFromMaximumSpanningTree(view_graph, 1, orientations);
 }
 
-}  // namespace
-
 bool OrientationsFromMaximumSpanningTree(
     const ViewGraph& view_graph,
+    const int num_threads,
     std::unordered_map<ViewId, Eigen::Vector3d>* orientations) {
   CHECK_NOTNULL(orientations);
+  if (view_graph.NumEdges() == 0) {
+    VLOG(2)
+        << "Could not extract the maximum spanning tree from the view graph";
+    return false;
+  }
 
   // Compute the largest connected component of the input view graph since the
   // MST is only valid on a single connected component.
-  std::unordered_set<theia::ViewId> largest_cc;
-  view_graph.GetLargestConnectedComponentIds(&largest_cc);
-  ViewGraph largest_cc_subgraph;
-  view_graph.ExtractSubgraph(largest_cc, &largest_cc_subgraph);
-
-  // Compute maximum spanning tree.
-  const auto& all_edges = largest_cc_subgraph.GetAllEdges();
-  MinimumSpanningTree<ViewId, int> mst_extractor;
-  for (const auto& edge : all_edges) {
-    // Since we want the *maximum* spanning tree, we negate all of the edge
-    // weights in the *minimum* spanning tree extractor.
-    mst_extractor.AddEdge(
-        edge.first.first, edge.first.second, -edge.second.num_verified_matches);
+  const CompactViewGraph compact_view_graph(view_graph);
+  const std::vector<int> largest_cc =
+      compact_view_graph.LargestConnectedComponent();
+  std::vector<bool> is_in_largest_cc(compact_view_graph.NumViews(), false);
+  for (const int view_index : largest_cc) {
+    is_in_largest_cc[view_index] = true;
   }
 
-  std::unordered_set<ViewIdPair> mst;
+  // Compute the maximum spanning tree. Since we want the *maximum* spanning
+  // tree, we negate all of the edge weights in the *minimum* spanning tree
+  // extractor.
+  ParallelMinimumSpanningTree<int, int> mst_extractor(num_threads);
+  for (int i = 0; i < compact_view_graph.NumEdges(); i++) {
+    if (is_in_largest_cc[compact_view_graph.EdgeView1(i)]) {
+      mst_extractor.AddEdge(compact_view_graph.EdgeView1(i),
+                            compact_view_graph.EdgeView2(i),
+                            -compact_view_graph.Edge(i).num_verified_matches);
+    }
+  }
+  std::unordered_set<std::pair<int, int> > mst;
   if (!mst_extractor.Extract(&mst)) {
     VLOG(2)
         << "Could not extract the maximum spanning tree from the view graph";
     return false;
   }
 
-  // Create an MST view graph.
-  ViewGraph mst_view_graph;
-  for (const ViewIdPair& edge : mst) {
-    mst_view_graph.AddEdge(
-        edge.first,
-        edge.second,
-        *largest_cc_subgraph.GetEdge(edge.first, edge.second));
+  // Mark the tree edges. The tree contains the edges as they were added, i.e.
+  // as (view index 1, view index 2) pairs.
+  std::vector<bool> is_mst_edge(compact_view_graph.NumEdges(), false);
+  for (int i = 0; i < compact_view_graph.NumEdges(); i++) {
+    is_mst_edge[i] = ContainsKey(
+        mst,
+        std::make_pair(compact_view_graph.EdgeView1(i),
+                       compact_view_graph.EdgeView2(i)));
   }
 
-  // Chain the relative rotations together to compute orientations.  We use a
-  // heap to determine the next edges to add to the minimum spanning tree.
-  std::vector<HeapElement> heap;
-
-  // Set the root value.
-  const ViewId root_view_id = mst.begin()->first;
-  (*orientations)[root_view_id] = Eigen::Vector3d::Zero();
-  AddEdgesToHeap(mst_view_graph, *orientations, root_view_id, &heap);
-
-  while (!heap.empty()) {
-    const HeapElement next_edge = heap.front();
-    // Remove the best edge.
-    std::pop_heap(heap.begin(), heap.end(), SortHeapElement);
-    heap.pop_back();
-
-    // If the edge contains two vertices that have already been added then do
-    // nothing.
-    if (ContainsKey(*orientations, next_edge.second.second)) {
-      continue;
+  // Chain the relative rotations together along the tree edges to compute
+  // orientations. Each view is reached through exactly one tree path so the
+  // traversal order does not matter.
+  std::vector<bool> is_visited(compact_view_graph.NumViews(), false);
+  std::vector<int> queue;
+  queue.reserve(largest_cc.size());
+  const int root_view_index = largest_cc.front();
+  queue.emplace_back(root_view_index);
+  is_visited[root_view_index] = true;
+  (*orientations)[compact_view_graph.ViewIdForIndex(root_view_index)] =
+      Eigen::Vector3d::Zero();
+  for (int i = 0; i < queue.size(); i++) {
+    const int view_index = queue[i];
+    const ViewId view_id = compact_view_graph.ViewIdForIndex(view_index);
+    const Eigen::Vector3d& orientation = FindOrDie(*orientations, view_id);
+    const int* neighbors = compact_view_graph.Neighbors(view_index);
+    const int* incident_edges = compact_view_graph.IncidentEdges(view_index);
+    for (int j = 0; j < compact_view_graph.Degree(view_index); j++) {
+      if (!is_mst_edge[incident_edges[j]] || is_visited[neighbors[j]]) {
+        continue;
+      }
+      is_visited[neighbors[j]] = true;
+      queue.emplace_back(neighbors[j]);
+
+      const ViewId neighbor_view_id =
+          compact_view_graph.ViewIdForIndex(neighbors[j]);
+      (*orientations)[neighbor_view_id] =
+          ComputeOrientation(orientation,
+                             compact_view_graph.Edge(incident_edges[j]),
+                             view_id,
+                             neighbor_view_id);
     }
-
-    // Compute the orientation for the vertex.
-    (*orientations)[next_edge.second.second] =
-        ComputeOrientation(FindOrDie(*orientations, next_edge.second.first),
-                           next_edge.first,
-                           next_edge.second.first,
-                           next_edge.second.second);
-
-    // Add all edges to the heap.
-    AddEdgesToHeap(
-        mst_view_graph, *orientations, next_edge.second.second, &heap);
   }
   return true;
 }
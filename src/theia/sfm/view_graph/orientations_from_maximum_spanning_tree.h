@@ -51,6 +51,13 @@ bool OrientationsFromMaximumSpanningTree(
     const ViewGraph& view_graph,
     std::unordered_map<ViewId, Eigen::Vector3d>* orientations);
 
+// Same as above, but the maximum spanning tree is extracted with num_threads
+// threads. The resulting orientations do not depend on the number of threads.
+bool OrientationsFromMaximumSpanningTree(
+    const ViewGraph& view_graph,
+    const int num_threads,
+    std::unordered_map<ViewId, Eigen::Vector3d>* orientations);
+
 }  // namespace theia
 
 #endif  // THEIA_SFM_VIEW_GRAPH_ORIENTATIONS_FROM_MAXIMUM_SPANNING_TREE_H_
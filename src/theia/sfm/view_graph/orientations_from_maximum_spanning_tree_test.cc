@@ -160,4 +160,20 @@ TEST(OrientationsFromViewGraph, LargeTest) {
   TestOrientationsFromViewGraph(kNumViews, kNumEdges);
 }
 
+TEST(OrientationsFromViewGraph, LargeTestMultithreaded) {
+  const int kNumViews = 500;
+  const int kNumEdges = 2000;
+  const int kNumThreads = 4;
+  std::unordered_map<ViewId, Vector3d> orientations;
+  CreateViewsWithRandomOrientations(kNumViews, &orientations);
+  ViewGraph view_graph;
+  CreateViewGraph(kNumEdges, orientations, &view_graph);
+
+  std::unordered_map<ViewId, Vector3d> estimated_orientations;
+  EXPECT_TRUE(OrientationsFromMaximumSpanningTree(
+      view_graph, kNumThreads, &estimated_orientations));
+  EXPECT_EQ(estimated_orientations.size(), kNumViews);
+  VerifyOrientations(view_graph, orientations, estimated_orientations);
+}
+
 }  // namespace theia
@@ -37,9 +37,10 @@
 #include <glog/logging.h>
 #include <unordered_map>
 #include <unordered_set>
+#include <vector>
 
-#include "theia/math/graph/connected_components.h"
 #include "theia/sfm/types.h"
+#include "theia/sfm/view_graph/compact_view_graph.h"
 #include "theia/sfm/view_graph/view_graph.h"
 
 namespace theia {
@@ -49,40 +50,30 @@ std::unordered_set<ViewId> RemoveDisconnectedViewPairs(ViewGraph* view_graph) {
   CHECK_NOTNULL(view_graph);
   std::unordered_set<ViewId> removed_views;
 
-  // Extract all connected components.
-  ConnectedComponents<ViewId> cc_extractor;
-  const auto& view_pairs = view_graph->GetAllEdges();
-  for (const auto& view_pair : view_pairs) {
-    cc_extractor.AddEdge(view_pair.first.first, view_pair.first.second);
+  if (view_graph->NumEdges() == 0) {
+    return removed_views;
   }
-  std::unordered_map<ViewId, std::unordered_set<ViewId> > connected_components;
-  cc_extractor.Extract(&connected_components);
 
-  // Find the largest connected component.
-  int max_cc_size = 0;
-  ViewId largest_cc_root_id = kInvalidViewId;
-  for (const auto& connected_component : connected_components) {
-    if (connected_component.second.size() > max_cc_size) {
-      max_cc_size = connected_component.second.size();
-      largest_cc_root_id = connected_component.first;
-    }
-  }
+  // Label the connected components of a snapshot of the view graph.
+  const CompactViewGraph compact_view_graph(*view_graph);
+  std::vector<int> component_labels;
+  compact_view_graph.ConnectedComponents(&component_labels);
+  const std::vector<int> largest_component =
+      compact_view_graph.LargestConnectedComponent();
+  const int largest_cc_label = component_labels[largest_component.front()];
 
   // Remove all view pairs containing a view to remove (i.e. the ones that are
-  // not in the largest connectedcomponent).
+  // not in the largest connected component). Views without any view pairs are
+  // left untouched.
   const int num_view_pairs_before_filtering = view_graph->NumEdges();
-  for (const auto& connected_component : connected_components) {
-    if (connected_component.first == largest_cc_root_id) {
+  for (int i = 0; i < compact_view_graph.NumViews(); i++) {
+    if (component_labels[i] == largest_cc_label ||
+        compact_view_graph.Degree(i) == 0) {
       continue;
     }
-
-    // NOTE: The connected component will contain the root id as well, so we do
-    // not explicity have to remove connected_component.first since it will
-    // exist in connected_components.second
-    for (const ViewId view_id2 : connected_component.second) {
-      view_graph->RemoveView(view_id2);
-      removed_views.insert(view_id2);
-    }
+    const ViewId view_id = compact_view_graph.ViewIdForIndex(i);
+    view_graph->RemoveView(view_id);
+    removed_views.insert(view_id);
   }
 
   const int num_removed_view_pairs =
@@ -0,0 +1,198 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+
+#include "theia/sfm/view_graph/sparsify_view_graph.h"
+
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "theia/math/graph/parallel_minimum_spanning_tree.h"
+#include "theia/sfm/twoview_info.h"
+#include "theia/sfm/types.h"
+#include "theia/sfm/view_graph/compact_view_graph.h"
+#include "theia/sfm/view_graph/view_graph.h"
+#include "theia/util/executor.h"
+#include "theia/util/hash.h"
+
+namespace theia {
+
+int SparsifyViewGraph(const SparsifyViewGraphOptions& options,
+                      ViewGraph* view_graph) {
+  CHECK_NOTNULL(view_graph);
+  CHECK_GT(options.num_edges_per_view, 0);
+  CHECK_GT(options.num_threads, 0);
+
+  const CompactViewGraph compact_view_graph(*view_graph);
+  const int num_views = compact_view_graph.NumViews();
+  const int num_edges = compact_view_graph.NumEdges();
+  bool is_dense = false;
+  for (int i = 0; i < num_views; i++) {
+    if (compact_view_graph.Degree(i) > options.num_edges_per_view) {
+      is_dense = true;
+      break;
+    }
+  }
+  if (!is_dense) {
+    return 0;
+  }
+
+  std::vector<int> strengths(num_edges);
+  for (int i = 0; i < num_edges; i++) {
+    const TwoViewInfo& info = compact_view_graph.Edge(i);
+    strengths[i] = options.use_visibility_score ? info.visibility_score
+                                                : info.num_verified_matches;
+  }
+  // Stronger edges first, ties broken by the edge index so that the result is
+  // deterministic.
+  const auto is_stronger = [&strengths](const int edge1, const int edge2) {
+    return strengths[edge1] > strengths[edge2] ||
+           (strengths[edge1] == strengths[edge2] && edge1 < edge2);
+  };
+
+  // 1) The maximum spanning forest, with the negated strengths as weights of
+  // the minimum spanning forest.
+  ParallelMinimumSpanningTree<int, int> mst_extractor(options.num_threads);
+  for (int i = 0; i < num_edges; i++) {
+    mst_extractor.AddEdge(compact_view_graph.EdgeView1(i),
+                          compact_view_graph.EdgeView2(i),
+                          -strengths[i]);
+  }
+  std::unordered_set<std::pair<int, int> > mst;
+  mst_extractor.Extract(&mst);
+  std::vector<char> is_kept(num_edges, 0);
+  std::vector<int> tree_edges;
+  tree_edges.reserve(mst.size());
+  for (const auto& tree_edge : mst) {
+    const int edge_index =
+        compact_view_graph.EdgeIndex(tree_edge.first, tree_edge.second);
+    is_kept[edge_index] = 1;
+    tree_edges.emplace_back(edge_index);
+  }
+  std::sort(tree_edges.begin(), tree_edges.end());
+
+  // 2) The strongest edges of each view. The edges are marked after the
+  // parallel selection since both views of an edge may select it.
+  std::vector<std::vector<int> > strongest_edges(num_views);
+  ParallelFor(options.num_threads, num_views, [&](const int start,
+                                                  const int end) {
+    for (int i = start; i < end; i++) {
+      const int* incident_edges = compact_view_graph.IncidentEdges(i);
+      std::vector<int>& edges = strongest_edges[i];
+      edges.assign(incident_edges,
+                   incident_edges + compact_view_graph.Degree(i));
+      if (edges.size() > options.num_edges_per_view) {
+        std::nth_element(edges.begin(),
+                         edges.begin() + options.num_edges_per_view,
+                         edges.end(),
+                         is_stronger);
+        edges.resize(options.num_edges_per_view);
+      }
+    }
+  });
+  for (const std::vector<int>& edges : strongest_edges) {
+    for (const int edge_index : edges) {
+      is_kept[edge_index] = 1;
+    }
+  }
+
+  // 3) A triangle for each tree edge that is not part of a kept triangle yet.
+  // The strongest triangle maximizes the strength of its weaker edge. The
+  // common neighbors of the two views are found by merging their sorted
+  // neighbor lists.
+  std::vector<std::pair<int, int> > triangle_edges(tree_edges.size(),
+                                                   std::make_pair(-1, -1));
+  ParallelFor(options.num_threads, tree_edges.size(), [&](const int start,
+                                                          const int end) {
+    for (int i = start; i < end; i++) {
+      const int view1 = compact_view_graph.EdgeView1(tree_edges[i]);
+      const int view2 = compact_view_graph.EdgeView2(tree_edges[i]);
+      const int* neighbors1 = compact_view_graph.Neighbors(view1);
+      const int* neighbors2 = compact_view_graph.Neighbors(view2);
+      const int* edges1 = compact_view_graph.IncidentEdges(view1);
+      const int* edges2 = compact_view_graph.IncidentEdges(view2);
+      const int degree1 = compact_view_graph.Degree(view1);
+      const int degree2 = compact_view_graph.Degree(view2);
+      int best_strength = -1;
+      bool is_covered = false;
+      for (int j = 0, k = 0; j < degree1 && k < degree2 && !is_covered;) {
+        if (neighbors1[j] < neighbors2[k]) {
+          ++j;
+        } else if (neighbors2[k] < neighbors1[j]) {
+          ++k;
+        } else {
+          if (is_kept[edges1[j]] && is_kept[edges2[k]]) {
+            is_covered = true;
+          } else {
+            const int strength =
+                std::min(strengths[edges1[j]], strengths[edges2[k]]);
+            if (strength > best_strength) {
+              best_strength = strength;
+              triangle_edges[i] = std::make_pair(edges1[j], edges2[k]);
+            }
+          }
+          ++j;
+          ++k;
+        }
+      }
+      if (is_covered) {
+        triangle_edges[i] = std::make_pair(-1, -1);
+      }
+    }
+  });
+  for (const auto& edges : triangle_edges) {
+    if (edges.first != -1) {
+      is_kept[edges.first] = 1;
+      is_kept[edges.second] = 1;
+    }
+  }
+
+  int num_removed_view_pairs = 0;
+  for (int i = 0; i < num_edges; i++) {
+    if (!is_kept[i]) {
+      const ViewIdPair view_ids = compact_view_graph.EdgeViewIds(i);
+      view_graph->RemoveEdge(view_ids.first, view_ids.second);
+      ++num_removed_view_pairs;
+    }
+  }
+  LOG(INFO) << "Sparsified the view graph from " << num_edges << " to "
+            << num_edges - num_removed_view_pairs << " view pairs.";
+  return num_removed_view_pairs;
+}
+
+}  // namespace theia
@@ -0,0 +1,75 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+
+#ifndef THEIA_SFM_VIEW_GRAPH_SPARSIFY_VIEW_GRAPH_H_
+#define THEIA_SFM_VIEW_GRAPH_SPARSIFY_VIEW_GRAPH_H_
+
+namespace theia {
+
+class ViewGraph;
+
+struct SparsifyViewGraphOptions {
+  // Every view keeps its num_edges_per_view strongest view pairs. A view pair
+  // is kept if it is among the strongest view pairs of either of its views.
+  int num_edges_per_view = 10;
+
+  // The strength of a view pair is its visibility score if true and its number
+  // of verified matches otherwise.
+  bool use_visibility_score = false;
+
+  int num_threads = 1;
+};
+
+// Removes redundant view pairs from dense view graphs. The global rotation and
+// position estimators and the view pair filters scale with the number of view
+// pairs, while a view with hundreds of view pairs is already well constrained
+// by a few strong ones. The sparsified view graph consists of:
+//
+//   1) The maximum spanning tree (forest) of the view graph, so no connected
+//      component is split.
+//   2) The num_edges_per_view strongest view pairs of each view.
+//   3) For each tree edge that is not part of a triangle of the edges above,
+//      the strongest triangle of the view graph containing it. Every tree edge
+//      thus lies on a cycle (if the view graph has one), which keeps the cycle
+//      consistency filters meaningful and the graph parallel rigid around it.
+//
+// Views keep all of their view pairs if they have at most num_edges_per_view
+// of them. Returns the number of view pairs that were removed.
+int SparsifyViewGraph(const SparsifyViewGraphOptions& options,
+                      ViewGraph* view_graph);
+
+}  // namespace theia
+
+#endif  // THEIA_SFM_VIEW_GRAPH_SPARSIFY_VIEW_GRAPH_H_
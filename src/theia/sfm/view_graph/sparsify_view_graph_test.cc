@@ -0,0 +1,177 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+
+#include <algorithm>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "theia/sfm/twoview_info.h"
+#include "theia/sfm/types.h"
+#include "theia/sfm/view_graph/compact_view_graph.h"
+#include "theia/sfm/view_graph/sparsify_view_graph.h"
+#include "theia/sfm/view_graph/view_graph.h"
+#include "theia/util/random.h"
+
+namespace theia {
+
+namespace {
+
+// Adds the complete graph of the views [first_view_id, first_view_id +
+// num_views) with random numbers of verified matches.
+void AddCompleteGraph(const int first_view_id,
+                      const int num_views,
+                      RandomNumberGenerator* rng,
+                      ViewGraph* view_graph) {
+  for (int i = 0; i < num_views; i++) {
+    for (int j = i + 1; j < num_views; j++) {
+      TwoViewInfo info;
+      info.num_verified_matches = rng->RandInt(30, 1000);
+      view_graph->AddEdge(first_view_id + i, first_view_id + j, info);
+    }
+  }
+}
+
+// Returns true if the view is part of a triangle of the view graph.
+bool IsInTriangle(const CompactViewGraph& view_graph, const int view_index) {
+  const int* neighbors = view_graph.Neighbors(view_index);
+  for (int i = 0; i < view_graph.Degree(view_index); i++) {
+    for (int j = i + 1; j < view_graph.Degree(view_index); j++) {
+      if (view_graph.EdgeIndex(neighbors[i], neighbors[j]) != -1) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+}  // namespace
+
+TEST(SparsifyViewGraph, SparseViewGraphIsUnchanged) {
+  ViewGraph view_graph;
+  TwoViewInfo info;
+  view_graph.AddEdge(0, 1, info);
+  view_graph.AddEdge(1, 2, info);
+  view_graph.AddEdge(2, 3, info);
+  view_graph.AddEdge(3, 0, info);
+
+  SparsifyViewGraphOptions options;
+  options.num_edges_per_view = 2;
+  EXPECT_EQ(SparsifyViewGraph(options, &view_graph), 0);
+  EXPECT_EQ(view_graph.NumEdges(), 4);
+}
+
+TEST(SparsifyViewGraph, KeepsStrongestViewPairsAndConnectivity) {
+  static const int kNumViews = 40;
+  RandomNumberGenerator rng(52);
+  ViewGraph view_graph;
+  AddCompleteGraph(0, kNumViews, &rng, &view_graph);
+  const CompactViewGraph dense_view_graph(view_graph);
+
+  SparsifyViewGraphOptions options;
+  options.num_edges_per_view = 3;
+  options.num_threads = 4;
+  const int num_removed_view_pairs = SparsifyViewGraph(options, &view_graph);
+  EXPECT_EQ(num_removed_view_pairs,
+            dense_view_graph.NumEdges() - view_graph.NumEdges());
+  // At most 3 edges per view, the tree and 2 edges per tree edge are kept.
+  EXPECT_LE(view_graph.NumEdges(), 3 * kNumViews + 3 * (kNumViews - 1));
+
+  const CompactViewGraph sparse_view_graph(view_graph);
+  EXPECT_EQ(sparse_view_graph.LargestConnectedComponent().size(), kNumViews);
+  for (int i = 0; i < kNumViews; i++) {
+    // The strongest view pairs of each view are kept.
+    const int* incident_edges = dense_view_graph.IncidentEdges(i);
+    std::vector<std::pair<int, int> > edges;
+    for (int j = 0; j < dense_view_graph.Degree(i); j++) {
+      edges.emplace_back(
+          -dense_view_graph.Edge(incident_edges[j]).num_verified_matches,
+          incident_edges[j]);
+    }
+    std::sort(edges.begin(), edges.end());
+    for (int j = 0; j < options.num_edges_per_view; j++) {
+      const ViewIdPair view_ids = dense_view_graph.EdgeViewIds(edges[j].second);
+      EXPECT_TRUE(view_graph.HasEdge(view_ids.first, view_ids.second));
+    }
+
+    // Each view is incident to a tree edge, which lies on a triangle.
+    EXPECT_TRUE(IsInTriangle(sparse_view_graph,
+                             sparse_view_graph.ViewIndex(
+                                 dense_view_graph.ViewIdForIndex(i))));
+  }
+}
+
+TEST(SparsifyViewGraph, KeepsConnectedComponents) {
+  RandomNumberGenerator rng(52);
+  ViewGraph view_graph;
+  AddCompleteGraph(0, 10, &rng, &view_graph);
+  AddCompleteGraph(10, 10, &rng, &view_graph);
+
+  SparsifyViewGraphOptions options;
+  options.num_edges_per_view = 2;
+  EXPECT_GT(SparsifyViewGraph(options, &view_graph), 0);
+
+  const CompactViewGraph sparse_view_graph(view_graph);
+  std::vector<int> component_labels;
+  EXPECT_EQ(sparse_view_graph.ConnectedComponents(&component_labels), 2);
+  EXPECT_EQ(sparse_view_graph.NumViews(), 20);
+}
+
+TEST(SparsifyViewGraph, UseVisibilityScore) {
+  // A cycle of 4 views whose numbers of verified matches increase along the
+  // cycle while the visibility scores decrease. The cycle has no triangles, so
+  // only its weakest view pair is removed.
+  for (const bool use_visibility_score : {false, true}) {
+    ViewGraph view_graph;
+    for (int i = 0; i < 4; i++) {
+      TwoViewInfo info;
+      info.num_verified_matches = 100 * (i + 1);
+      info.visibility_score = 100 * (4 - i);
+      view_graph.AddEdge(i, (i + 1) % 4, info);
+    }
+
+    SparsifyViewGraphOptions options;
+    options.num_edges_per_view = 1;
+    options.use_visibility_score = use_visibility_score;
+    EXPECT_EQ(SparsifyViewGraph(options, &view_graph), 1);
+    if (use_visibility_score) {
+      EXPECT_FALSE(view_graph.HasEdge(3, 0));
+    } else {
+      EXPECT_FALSE(view_graph.HasEdge(0, 1));
+    }
+  }
+}
+
+}  // namespace theia
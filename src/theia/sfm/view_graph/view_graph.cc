@@ -41,10 +41,11 @@
 #include <iostream>  // NOLINT
 #include <unordered_map>
 #include <unordered_set>
+#include <vector>
 
-#include "theia/math/graph/connected_components.h"
 #include "theia/sfm/twoview_info.h"
 #include "theia/sfm/types.h"
+#include "theia/sfm/view_graph/compact_view_graph.h"
 #include "theia/util/hash.h"
 #include "theia/util/map_util.h"
 
@@ -152,6 +153,27 @@ void ViewGraph::AddEdge(const ViewId view_id_1,
   edges_[view_id_pair] = two_view_info;
 }
 
+void ViewGraph::SetFromCompactViewGraph(
+    const CompactViewGraph& compact_view_graph) {
+  vertices_.clear();
+  edges_.clear();
+  vertices_.reserve(compact_view_graph.NumViews());
+  edges_.reserve(compact_view_graph.NumEdges());
+  for (int i = 0; i < compact_view_graph.NumViews(); i++) {
+    std::unordered_set<ViewId>& neighbor_ids =
+        vertices_[compact_view_graph.ViewIdForIndex(i)];
+    neighbor_ids.reserve(compact_view_graph.Degree(i));
+    const int* neighbors = compact_view_graph.Neighbors(i);
+    for (int j = 0; j < compact_view_graph.Degree(i); j++) {
+      neighbor_ids.emplace(compact_view_graph.ViewIdForIndex(neighbors[j]));
+    }
+  }
+  for (int i = 0; i < compact_view_graph.NumEdges(); i++) {
+    edges_.emplace(compact_view_graph.EdgeViewIds(i),
+                   compact_view_graph.Edge(i));
+  }
+}
+
 // Removes the edge from the view graph. Returns true if the edge is removed
 // and false if the edge did not exist.
 bool ViewGraph::RemoveEdge(const ViewId view_id_1, const ViewId view_id_2) {
@@ -203,6 +225,21 @@ const std::unordered_map<ViewIdPair, TwoViewInfo>& ViewGraph::GetAllEdges()
   return edges_;
 }
 
+size_t ViewGraph::EstimateMemoryUsage() const {
+  // Approximate size of a node and its bucket in an unordered container.
+  static const size_t kHashNodeOverhead = 2 * sizeof(void*);
+
+  size_t bytes = vertices_.size() *
+                 (sizeof(ViewId) + sizeof(std::unordered_set<ViewId>) +
+                  kHashNodeOverhead);
+  for (const auto& vertex : vertices_) {
+    bytes += vertex.second.size() * (sizeof(ViewId) + kHashNodeOverhead);
+  }
+  bytes += edges_.size() *
+           (sizeof(ViewIdPair) + sizeof(TwoViewInfo) + kHashNodeOverhead);
+  return bytes;
+}
+
 // Extract a subgraph containing only the specified views.
 void ViewGraph::ExtractSubgraph(
     const std::unordered_set<ViewId>& views_in_subgraph,
@@ -239,29 +276,16 @@ void ViewGraph::ExtractSubgraph(
 
 void ViewGraph::GetLargestConnectedComponentIds(
     std::unordered_set<ViewId>* largest_cc) const {
-  ConnectedComponents<ViewId> cc_extractor;
-  // Add all edges to the connected components extractor.
-  for (const auto& edge : edges_) {
-    cc_extractor.AddEdge(edge.first.first, edge.first.second);
+  CHECK_GT(edges_.size(), 0);
+  const CompactViewGraph compact_view_graph(*this);
+  const std::vector<int> largest_component =
+      compact_view_graph.LargestConnectedComponent();
+
+  largest_cc->clear();
+  largest_cc->reserve(largest_component.size());
+  for (const int view_index : largest_component) {
+    largest_cc->emplace(compact_view_graph.ViewIdForIndex(view_index));
   }
-
-  // Extract all connected components.
-  std::unordered_map<ViewId, std::unordered_set<ViewId> > connected_components;
-  cc_extractor.Extract(&connected_components);
-
-  // Search for the largest CC in the viewing graph.
-  ViewId largest_cc_id = kInvalidViewId;
-  int largest_cc_size = 0;
-  for (const auto& connected_component : connected_components) {
-    if (connected_component.second.size() > largest_cc_size) {
-      largest_cc_size = connected_component.second.size();
-      largest_cc_id = connected_component.first;
-    }
-  }
-  CHECK_NE(largest_cc_id, kInvalidViewId);
-
-  // Swap the largest connected component to the output.
-  std::swap(*largest_cc, connected_components[largest_cc_id]);
 }
 
 }  // namespace theia
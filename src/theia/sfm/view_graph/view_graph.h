@@ -50,6 +50,8 @@
 
 namespace theia {
 
+class CompactViewGraph;
+
 // An undirected graph containing views in an SfM reconstruction. The graph is
 // efficienctly created by only holding view ids at the vertices and
 // TwoViewInfos for edge values.
@@ -110,6 +112,15 @@ class ViewGraph {
   // view id 2.
   const std::unordered_map<ViewIdPair, TwoViewInfo>& GetAllEdges() const;
 
+  // Replaces the views and edges of the view graph with those of the
+  // snapshot. The hash maps are sized up front from the degrees of the views,
+  // which is much faster than adding the edges one at a time.
+  void SetFromCompactViewGraph(const CompactViewGraph& compact_view_graph);
+
+  // Returns an estimate of the heap memory in bytes held by the vertices and
+  // edges of the view graph. This is used for memory accounting.
+  size_t EstimateMemoryUsage() const;
+
   // Extract a subgraph from this view graph which contains only the input
   // views. Note that this means that only edges between the input views will be
   // preserved in the subgraph.
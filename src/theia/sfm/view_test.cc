@@ -33,9 +33,14 @@
 // Author: Chris Sweeney (cmsweeney@cs.ucsb.edu)
 
 #include <algorithm>
+#include <sstream>
 #include <string>
+#include <utility>
 #include <vector>
 
+#include <Eigen/Core>
+#include <cereal/archives/portable_binary.hpp>
+
 #include "gtest/gtest.h"
 
 #include "theia/sfm/feature.h"
@@ -84,6 +89,74 @@ TEST(View, Features) {
   }
 }
 
+TEST(View, GetTrack) {
+  static const int kNumFeatures = 1000;
+  View view;
+  std::vector<Feature> features;
+  for (int i = 0; i < kNumFeatures; i++) {
+    features.emplace_back(i % 31, i / 31);
+    view.AddFeature(i, features[i]);
+  }
+  for (int i = 0; i < kNumFeatures; i++) {
+    EXPECT_EQ(view.GetTrack(features[i]), i);
+  }
+  EXPECT_EQ(view.GetTrack(Feature(0.5, 0.5)), kInvalidTrackId);
+
+  // Remove most of the features and move some of the others.
+  for (int i = 0; i < kNumFeatures; i++) {
+    if (i % 4 != 0) {
+      EXPECT_TRUE(view.RemoveFeature(i));
+    } else if (i % 8 == 0) {
+      const Feature old_feature = features[i];
+      features[i] = Feature(100.0 + i, 0.0);
+      view.AddFeature(i, features[i]);
+      EXPECT_EQ(view.GetTrack(old_feature), kInvalidTrackId);
+    }
+  }
+  for (int i = 0; i < kNumFeatures; i++) {
+    EXPECT_EQ(view.GetTrack(features[i]), i % 4 == 0 ? i : kInvalidTrackId);
+  }
+}
+
+TEST(View, AddFeatures) {
+  static const int kNumFeatures = 100;
+  View view;
+  view.AddFeature(kNumFeatures, Feature(-1.0, -1.0));
+  std::vector<std::pair<TrackId, Feature> > features;
+  for (int i = 0; i < kNumFeatures; i++) {
+    features.emplace_back(i, Feature(i % 10, i / 10));
+  }
+  view.AddFeatures(features);
+
+  EXPECT_EQ(view.NumFeatures(), kNumFeatures + 1);
+  EXPECT_EQ(view.GetTrack(Feature(-1.0, -1.0)), kNumFeatures);
+  for (const auto& feature : features) {
+    EXPECT_EQ(*view.GetFeature(feature.first), feature.second);
+    EXPECT_EQ(view.GetTrack(feature.second), feature.first);
+  }
+}
+
+TEST(View, GetTrackAfterSerialization) {
+  View view;
+  for (int i = 0; i < 10; i++) {
+    view.AddFeature(i, Feature(i, 2 * i));
+  }
+
+  std::stringstream stream;
+  {
+    cereal::PortableBinaryOutputArchive output_archive(stream);
+    output_archive(view);
+  }
+  View loaded_view;
+  {
+    cereal::PortableBinaryInputArchive input_archive(stream);
+    input_archive(loaded_view);
+  }
+  for (int i = 0; i < 10; i++) {
+    EXPECT_EQ(loaded_view.GetTrack(Feature(i, 2 * i)), i);
+  }
+}
+
 TEST(View, TrackIds) {
   View view;
   const std::vector<TrackId> track_ids = {0, 1, 2};
@@ -102,4 +175,49 @@ TEST(View, TrackIds) {
   }
 }
 
+TEST(View, BearingVectors) {
+  View view;
+  view.MutableCamera()->SetFocalLength(100.0);
+  view.MutableCamera()->SetPrincipalPoint(50.0, 50.0);
+  const auto expected_bearing_vector = [&view](const Feature& feature) {
+    return view.Camera().PixelToUnitDepthRay(feature.point_).normalized();
+  };
+  const std::vector<Feature> features = {
+      Feature(0, 0), Feature(10, 90), Feature(50, 50), Feature(70, 20)};
+  for (int i = 0; i < 3; i++) {
+    view.AddFeature(i, features[i]);
+  }
+
+  // Without the cache the bearing vectors are computed.
+  Eigen::Vector3d bearing_vector;
+  EXPECT_FALSE(view.HasBearingVectors());
+  EXPECT_TRUE(view.GetBearingVector(1, &bearing_vector));
+  EXPECT_TRUE(bearing_vector.isApprox(expected_bearing_vector(features[1])));
+  EXPECT_FALSE(view.GetBearingVector(5, &bearing_vector));
+
+  // The cache follows added, overwritten and removed features.
+  view.UpdateBearingVectors();
+  EXPECT_TRUE(view.HasBearingVectors());
+  view.AddFeature(3, features[3]);
+  view.AddFeature(2, features[0]);
+  view.RemoveFeature(0);
+  EXPECT_TRUE(view.HasBearingVectors());
+  for (const TrackId track_id : view.TrackIds()) {
+    ASSERT_TRUE(view.GetBearingVector(track_id, &bearing_vector));
+    EXPECT_TRUE(bearing_vector.isApprox(
+        expected_bearing_vector(*view.GetFeature(track_id))));
+  }
+
+  // Changing the intrinsics invalidates the cache.
+  view.MutableCamera()->SetFocalLength(200.0);
+  EXPECT_FALSE(view.HasBearingVectors());
+  ASSERT_TRUE(view.GetBearingVector(3, &bearing_vector));
+  EXPECT_TRUE(bearing_vector.isApprox(expected_bearing_vector(features[3])));
+  view.UpdateBearingVectors();
+  EXPECT_TRUE(view.HasBearingVectors());
+
+  view.ClearBearingVectors();
+  EXPECT_FALSE(view.HasBearingVectors());
+}
+
 }  // namespace theia
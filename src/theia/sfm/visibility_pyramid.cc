@@ -50,7 +50,8 @@ VisibilityPyramid::VisibilityPyramid(const int width,
     : width_(width),
       height_(height),
       num_pyramid_levels_(num_pyramid_levels),
-      max_cells_in_dimension_(1 << num_pyramid_levels) {
+      max_cells_in_dimension_(1 << num_pyramid_levels),
+      score_(0) {
   CHECK_GT(width_, 0);
   CHECK_GT(height_, 0);
   CHECK_GT(num_pyramid_levels_, 0);
@@ -64,29 +65,54 @@ VisibilityPyramid::VisibilityPyramid(const int width,
   }
 }
 
+Eigen::Vector2i VisibilityPyramid::FinestGridCell(
+    const Eigen::Vector2d& point) const {
+  return Eigen::Vector2i(
+      theia::Clamp(
+          static_cast<int>(max_cells_in_dimension_ * point.x() / width_),
+          0,
+          max_cells_in_dimension_ - 1),
+      theia::Clamp(
+          static_cast<int>(max_cells_in_dimension_ * point.y() / height_),
+          0,
+          max_cells_in_dimension_ - 1));
+}
+
 // Add a point to the visibility pyramid.
 void VisibilityPyramid::AddPoint(const Eigen::Vector2d& point) {
   // Determine the grid cell of the point in the highest-resolution level of the
   // pyramid.
-  int grid_cell_x = theia::Clamp(
-      static_cast<int>(max_cells_in_dimension_ * point.x() / width_),
-      0,
-      max_cells_in_dimension_ - 1);
-  int grid_cell_y = theia::Clamp(
-      static_cast<int>(max_cells_in_dimension_ * point.y() / height_),
-      0,
-      max_cells_in_dimension_ - 1);
+  Eigen::Vector2i grid_cell = FinestGridCell(point);
 
   // Go through the pyramid from fine to coarse and add the observation to the
-  // occupancy grid.
+  // occupancy grid. A cell that becomes occupied adds the weight of its level
+  // to the score.
   for (int i = pyramid_.size() - 1; i >= 0; --i) {
-    pyramid_[i](grid_cell_x, grid_cell_y) += 1;
+    int& num_points_in_cell = pyramid_[i](grid_cell.x(), grid_cell.y());
+    if (num_points_in_cell++ == 0) {
+      score_ += pyramid_[i].size();
+    }
 
     // The next coarsest level of the pyramid will have half the number of grid
     // cells so we can use a simple bitshift to get the next pyramid level's
     // grid cells.
-    grid_cell_x = grid_cell_x >> 1;
-    grid_cell_y = grid_cell_y >> 1;
+    grid_cell.x() >>= 1;
+    grid_cell.y() >>= 1;
+  }
+}
+
+// Remove a point from the visibility pyramid.
+void VisibilityPyramid::RemovePoint(const Eigen::Vector2d& point) {
+  Eigen::Vector2i grid_cell = FinestGridCell(point);
+  for (int i = pyramid_.size() - 1; i >= 0; --i) {
+    int& num_points_in_cell = pyramid_[i](grid_cell.x(), grid_cell.y());
+    CHECK_GT(num_points_in_cell, 0)
+        << "The point was not added to the visibility pyramid.";
+    if (--num_points_in_cell == 0) {
+      score_ -= pyramid_[i].size();
+    }
+    grid_cell.x() >>= 1;
+    grid_cell.y() >>= 1;
   }
 }
 
@@ -94,12 +120,6 @@ void VisibilityPyramid::AddPoint(const Eigen::Vector2d& point) {
 // of the pyramid. The score for each level is weighted by the number of grid
 // cells in that level of the pyramid. This scheme favors good spatial
 // distribution at high resolutions.
-int VisibilityPyramid::ComputeScore() const {
-  int score = 0;
-  for (int i = 0; i < pyramid_.size(); i++) {
-    score += pyramid_[i].count() * pyramid_[i].size();
-  }
-  return score;
-}
+int VisibilityPyramid::ComputeScore() const { return score_; }
 
 }  // namespace theia
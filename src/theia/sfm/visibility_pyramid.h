@@ -64,18 +64,29 @@ class VisibilityPyramid {
   // Add a point to the visibility pyramid.
   void AddPoint(const Eigen::Vector2d& point);
 
+  // Remove a point that was previously added to the visibility pyramid. This
+  // allows the pyramid of a view to be updated as its points change.
+  void RemovePoint(const Eigen::Vector2d& point);
+
   // Compute the score of the visibility pyramid. Higher scores indicate that
-  // the view is better constrained by the points.
+  // the view is better constrained by the points. The score is maintained as
+  // points are added and removed so this is O(1).
   int ComputeScore() const;
 
  private:
+  // Returns the grid cell of the point in the finest level of the pyramid.
+  Eigen::Vector2i FinestGridCell(const Eigen::Vector2d& point) const;
+
   const int width_, height_, num_pyramid_levels_, max_cells_in_dimension_;
   // The pyramid represents all levels of image grids that keep track of the
-  // features. The score of the pyramid may be efficiently computed with the
-  // count() method that Eigen provides to determine occupancy.
+  // number of features in each cell.
   //
   // The pyramid is stored from coarse to fine and is indexed as (x, y).
   std::vector<Eigen::MatrixXi> pyramid_;
+
+  // The sum over all levels of the number of occupied cells weighted by the
+  // number of cells in the level.
+  int score_;
 };
 }  // namespace theia
 
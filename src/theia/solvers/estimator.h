@@ -39,8 +39,13 @@
 #ifdef THEIA_USE_OPENMP
 #include <omp.h>
 #endif
+#include <type_traits>
 #include <vector>
 
+#ifdef THEIA_USE_OPENMP
+#include "theia/util/executor.h"
+#endif
+
 namespace theia {
 // Templated class for estimating a model for RANSAC. This class is purely a
 // virtual class and should be implemented for the specific task that RANSAC is
@@ -92,14 +97,33 @@ class Estimator {
   // that calls Error() on each data point, but this function can be useful if
   // the errors of multiple points may be estimated simultanesously (e.g.,
   // matrix multiplication to compute the reprojection error of many points at
-  // once).
-  virtual std::vector<double> Residuals(const std::vector<Datum>& data,
-                                        const Model& model) const {
-    std::vector<double> residuals(data.size());
+  // once, or hoisting the model dependent computations out of the loop over
+  // the data). The residuals are resized to the number of data points.
+  //
+  // Sample consensus estimators score every hypothesis with this method and
+  // reuse the same residuals buffer for all hypotheses, so estimators only need
+  // to override this method to speed up the scoring.
+  virtual void Residuals(const std::vector<Datum>& data,
+                         const Model& model,
+                         std::vector<double>* residuals) const {
+    residuals->resize(data.size());
+    // The OpenMP threads share the thread budget of the global executor, so
+    // scoring within a parallel stage does not oversubscribe the machine.
+#ifdef THEIA_USE_OPENMP
+#pragma omp parallel for num_threads(AvailableNumThreads(omp_get_max_threads()))
+#else
 #pragma omp parallel for
+#endif
     for (int i = 0; i < data.size(); i++) {
-      residuals[i] = Error(data[i], model);
+      (*residuals)[i] = Error(data[i], model);
     }
+  }
+
+  // Same as above, but returns the residuals.
+  std::vector<double> Residuals(const std::vector<Datum>& data,
+                                const Model& model) const {
+    std::vector<double> residuals;
+    Residuals(data, model, &residuals);
     return residuals;
   }
 
@@ -123,6 +147,22 @@ class Estimator {
   virtual bool ValidModel(const Model& model) const { return true; }
 };
 
+// The sample size of estimators that declare it as a compile-time constant,
+// e.g.
+//
+//   static constexpr int kSampleSize = 2;
+//   double SampleSize() const { return kSampleSize; }
+//
+// and 0 for all other estimators. Sample consensus estimators draw the samples
+// of estimators with a fixed sample size into arrays on the stack.
+template <class ModelEstimator, typename = void>
+struct FixedSampleSize : std::integral_constant<int, 0> {};
+
+template <class ModelEstimator>
+struct FixedSampleSize<ModelEstimator,
+                       decltype(void(ModelEstimator::kSampleSize))>
+    : std::integral_constant<int, ModelEstimator::kSampleSize> {};
+
 }  // namespace theia
 
 #endif  // THEIA_SOLVERS_ESTIMATOR_H_
@@ -69,15 +69,22 @@ class Evsac : public SampleConsensusEstimator<ModelEstimator> {
   ~Evsac() {}
 
   bool Initialize() {
-    Sampler* prosac_sampler =
-        new EvsacSampler<Datum>(this->estimator_.SampleSize(),
-                                this->sorted_distances_,
-                                this->predictor_threshold_,
-                                this->fitting_method_);
-    return SampleConsensusEstimator<ModelEstimator>::Initialize(prosac_sampler);
+    return SampleConsensusEstimator<ModelEstimator>::Initialize(
+        CreateSampler(this->ransac_params_.rng));
   }
 
  protected:
+  // EvsacSampler seeds itself from std::random_device and does not use rng, so
+  // the parallel mode is not deterministic for Evsac. Each thread's sampler fits the distributions
+  // of the distances when it is initialized.
+  Sampler* CreateSampler(
+      const std::shared_ptr<RandomNumberGenerator>& rng) const override {
+    return new EvsacSampler<Datum>(this->estimator_.SampleSize(),
+                                   this->sorted_distances_,
+                                   this->predictor_threshold_,
+                                   this->fitting_method_);
+  }
+
   // L2 descriptor sorted distances.
   // rows: num of reference features.
   // cols: k-th smallest distances.
@@ -35,12 +35,26 @@
 #ifndef THEIA_SOLVERS_EXHAUSTIVE_RANSAC_H_
 #define THEIA_SOLVERS_EXHAUSTIVE_RANSAC_H_
 
+#include <memory>
+#include <vector>
+
 #include "theia/solvers/exhaustive_sampler.h"
+#include "theia/solvers/quality_measurement.h"
 #include "theia/solvers/sample_consensus_estimator.h"
 #include "theia/solvers/sampler.h"
 
 namespace theia {
 
+// Estimates a model from every minimal sample of the data (see
+// ExhaustiveSampler), which is useful for small problems where the best model
+// must not be missed. If the data is sorted by quality (with the highest
+// quality at index 0, as for PROSAC), RansacParameters::
+// exhaustive_sample_by_quality tries the most promising samples first. Since a
+// good model is then found early, scoring a hypothesis stops as soon as its
+// cost reaches the cost of the best model, which avoids computing most
+// residuals of the remaining hypotheses. With
+// RansacParameters::num_threads > 1, the samples are split between the
+// threads.
 template <class ModelEstimator>
 class ExhaustiveRansac : public SampleConsensusEstimator<ModelEstimator> {
  public:
@@ -52,11 +66,52 @@ class ExhaustiveRansac : public SampleConsensusEstimator<ModelEstimator> {
       : SampleConsensusEstimator<ModelEstimator>(ransac_params, estimator) {}
   virtual ~ExhaustiveRansac() {}
 
-  // Initializes the random sampler and inlier support measurement.
+  // Initializes the exhaustive sampler and inlier support measurement.
   bool Initialize() {
-    Sampler* random_sampler = new ExhaustiveSampler(
-        this->ransac_params_.rng, this->estimator_.SampleSize());
-    return SampleConsensusEstimator<ModelEstimator>::Initialize(random_sampler);
+    return SampleConsensusEstimator<ModelEstimator>::Initialize(
+        CreateThreadSampler(this->ransac_params_.rng, 0, 1));
+  }
+
+ protected:
+  Sampler* CreateThreadSampler(
+      const std::shared_ptr<RandomNumberGenerator>& rng,
+      const int thread_index,
+      const int num_threads) const override {
+    return new ExhaustiveSampler(
+        rng,
+        this->estimator_.SampleSize(),
+        this->ransac_params_.exhaustive_sample_by_quality,
+        thread_index,
+        num_threads);
+  }
+
+  // Computes the residuals one at a time and stops once the cost reaches
+  // max_cost. The residuals are not returned.
+  double ScoreModel(const std::vector<Datum>& data,
+                    const Model& model,
+                    const double max_cost,
+                    std::vector<double>* residuals,
+                    std::vector<int>* inliers) const override {
+    const QualityMeasurement& quality_measurement =
+        *this->quality_measurement_;
+    if (!quality_measurement.HasResidualCosts()) {
+      return SampleConsensusEstimator<ModelEstimator>::ScoreModel(
+          data, model, max_cost, residuals, inliers);
+    }
+
+    inliers->clear();
+    double cost = 0.0;
+    for (int i = 0; i < data.size(); i++) {
+      const double residual = this->estimator_.Error(data[i], model);
+      if (residual < this->ransac_params_.error_thresh) {
+        inliers->emplace_back(i);
+      }
+      cost += quality_measurement.ResidualCost(residual);
+      if (cost >= max_cost) {
+        return max_cost;
+      }
+    }
+    return cost;
   }
 };
 
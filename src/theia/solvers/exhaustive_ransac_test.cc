@@ -34,6 +34,7 @@
 
 #include <glog/logging.h>
 #include <math.h>
+#include <memory>
 #include <vector>
 
 #include "gtest/gtest.h"
@@ -139,4 +140,68 @@ TEST(RansacTest, TerminationNumInliers) {
   ransac_line.Estimate(input_points, &line, &summary);
   ASSERT_GE(summary.inliers.size(), 2500);
 }
+
+TEST(RansacTest, EnumeratesEachSampleOnce) {
+  // All 45 samples of a small data set are tried, even though the minimum
+  // number of iterations is larger.
+  std::vector<Point> input_points;
+  for (int i = 0; i < 10; ++i) {
+    input_points.push_back(Point(i, i % 3 == 0 ? 2.0 * i : i));
+  }
+
+  LineEstimator line_estimator;
+  Line line;
+  RansacParameters params;
+  params.rng = std::make_shared<RandomNumberGenerator>(rng);
+  params.error_thresh = 0.5;
+  params.min_iterations = 100;
+  ExhaustiveRansac<LineEstimator> ransac_line(params, line_estimator);
+  ransac_line.Initialize();
+  RansacSummary summary;
+  ASSERT_TRUE(ransac_line.Estimate(input_points, &line, &summary));
+  EXPECT_EQ(summary.num_iterations, 45);
+  EXPECT_EQ(summary.inliers.size(), 7);
+  EXPECT_NEAR(line.m, 1.0, 1e-12);
+}
+
+TEST(RansacTest, MultithreadedEnumerationMatchesSingleThreaded) {
+  // The points are sorted by quality, so the inliers come first. All samples
+  // are tried, so both runs find a model with the most inliers.
+  std::vector<Point> input_points;
+  for (int i = 0; i < 200; ++i) {
+    if (i < 120) {
+      input_points.push_back(Point(i + rng.RandGaussian(0.0, 0.1),
+                                   i + rng.RandGaussian(0.0, 0.1)));
+    } else {
+      input_points.push_back(
+          Point(rng.RandDouble(0.0, 200.0), rng.RandDouble(0.0, 200.0)));
+    }
+  }
+
+  LineEstimator line_estimator;
+  RansacParameters params;
+  params.rng = std::make_shared<RandomNumberGenerator>(rng);
+  params.error_thresh = 0.5;
+  params.max_iterations = 19900;
+  params.min_iterations = 19900;
+  params.exhaustive_sample_by_quality = true;
+  ExhaustiveRansac<LineEstimator> ransac_line(params, line_estimator);
+  ransac_line.Initialize();
+  Line line;
+  RansacSummary summary;
+  ASSERT_TRUE(ransac_line.Estimate(input_points, &line, &summary));
+  EXPECT_EQ(summary.num_iterations, 19900);
+  EXPECT_GE(summary.inliers.size(), 110);
+
+  params.num_threads = 4;
+  ExhaustiveRansac<LineEstimator> parallel_ransac_line(params,
+                                                       line_estimator);
+  parallel_ransac_line.Initialize();
+  Line parallel_line;
+  RansacSummary parallel_summary;
+  ASSERT_TRUE(parallel_ransac_line.Estimate(
+      input_points, &parallel_line, &parallel_summary));
+  EXPECT_EQ(parallel_summary.num_iterations, 19900);
+  EXPECT_EQ(parallel_summary.inliers.size(), summary.inliers.size());
+}
 }  // namespace theia
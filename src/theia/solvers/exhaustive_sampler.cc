@@ -35,7 +35,9 @@
 #include "theia/solvers/exhaustive_sampler.h"
 
 #include <algorithm>
+#include <cmath>
 #include <glog/logging.h>
+#include <numeric>
 #include <vector>
 
 #include "theia/solvers/sampler.h"
@@ -44,37 +46,88 @@ namespace theia {
 
 ExhaustiveSampler::ExhaustiveSampler(
     const std::shared_ptr<RandomNumberGenerator>& rng,
-    const int min_num_samples)
-    : Sampler(rng, min_num_samples), i_(0), j_(1) {
-  CHECK_EQ(this->min_num_samples_, 2) << "ExhaustiveSampler makes a hard "
-                                         "assumption that the number of "
-                                         "samples needed is 2.";
+    const int min_num_samples,
+    const bool sample_by_quality,
+    const int stream_index,
+    const int num_streams)
+    : Sampler(rng, min_num_samples),
+      sample_by_quality_(sample_by_quality),
+      stream_index_(stream_index),
+      num_streams_(num_streams),
+      num_datapoints_(0) {
+  CHECK_GT(this->min_num_samples_, 0);
+  CHECK_GE(stream_index_, 0);
+  CHECK_LT(stream_index_, num_streams_);
 }
 
 bool ExhaustiveSampler::Initialize(const int num_datapoints) {
   CHECK_GE(num_datapoints, this->min_num_samples_);
   num_datapoints_ = num_datapoints;
+  combination_.resize(this->min_num_samples_);
+  std::iota(combination_.begin(), combination_.end(), 0);
+  for (int i = 0; i < stream_index_; i++) {
+    Advance();
+  }
   return true;
 }
 
+double ExhaustiveSampler::NumUniqueSamples() const {
+  double num_combinations = 1.0;
+  for (int i = 1; i <= this->min_num_samples_; i++) {
+    num_combinations =
+        num_combinations * (num_datapoints_ - this->min_num_samples_ + i) / i;
+  }
+  return std::round(num_combinations);
+}
+
 // The next sample is determined deterministically.
 bool ExhaustiveSampler::Sample(std::vector<int>* subset) {
-  subset->emplace_back(i_);
-  subset->emplace_back(j_);
+  subset->insert(subset->end(), combination_.begin(), combination_.end());
+  for (int i = 0; i < num_streams_; i++) {
+    Advance();
+  }
+  return true;
+}
 
-  // Increment j and adjust the implicit for loops accordingly.
-  ++j_;
-  if (j_ >= num_datapoints_) {
-    ++i_;
-    // If i >= num_datapoints then we have enumerated all possible combinations.
-    // We simply reset the outer loop (i) to 0 so that the combinations are
-    // rengenerated.
-    if (i_ >= num_datapoints_ - 1) {
-      i_ = 0;
-    }
-    j_ = i_ + 1;
+bool ExhaustiveSampler::SampleIndices(int* subset_indices) {
+  std::copy(combination_.begin(), combination_.end(), subset_indices);
+  for (int i = 0; i < num_streams_; i++) {
+    Advance();
   }
   return true;
 }
 
+void ExhaustiveSampler::Advance() {
+  const int size = combination_.size();
+  if (sample_by_quality_) {
+    // Increment the lowest index that does not run into the next one and reset
+    // all indices below it, e.g. (1, 2, 5) -> (0, 3, 5).
+    int i = 0;
+    while (i < size - 1 && combination_[i] + 1 == combination_[i + 1]) {
+      ++i;
+    }
+    ++combination_[i];
+    if (combination_[size - 1] >= num_datapoints_) {
+      // All combinations have been enumerated, so start over.
+      i = size;
+    }
+    std::iota(combination_.begin(), combination_.begin() + i, 0);
+    return;
+  }
+
+  // Increment the highest index that is not at its maximum and place the
+  // indices above it right after it, e.g. (1, 4, 5) -> (2, 3, 4) for 6 data
+  // points.
+  int i = size - 1;
+  while (i >= 0 && combination_[i] == num_datapoints_ - size + i) {
+    --i;
+  }
+  if (i < 0) {
+    // All combinations have been enumerated, so start over.
+    std::iota(combination_.begin(), combination_.end(), 0);
+    return;
+  }
+  std::iota(combination_.begin() + i, combination_.end(), combination_[i] + 1);
+}
+
 }  // namespace theia
@@ -35,43 +35,54 @@
 #ifndef THEIA_SOLVERS_EXHAUSTIVE_SAMPLER_H_
 #define THEIA_SOLVERS_EXHAUSTIVE_SAMPLER_H_
 
-#include <algorithm>
 #include <memory>
-#include <numeric>
-#include <stdlib.h>
 #include <vector>
 
 #include "theia/solvers/sampler.h"
 
 namespace theia {
 
-// This class exhaustively generates all possible combinations for the data
-// input. We limit this sampler to only enumerate combinations with sample sizes
-// of 2 for simplicity.
+// This class exhaustively generates all possible combinations of
+// min_num_samples data points. By default the combinations are enumerated in
+// lexicographic order. If sample_by_quality is true, they are enumerated in
+// colexicographic order instead, i.e. all combinations of the first m data
+// points are generated before any combination that contains data point m. As
+// in PROSAC, the samples of the highest ranked data points are thus tried first
+// if the data is sorted by quality (with the highest quality at index 0). After
+// the last combination, the enumeration starts over.
+//
+// The enumeration may be split between several streams (e.g. threads): stream
+// i of n generates the combinations i, i + n, i + 2n, ... so that the streams
+// are disjoint and each of them follows the quality order.
 class ExhaustiveSampler : public Sampler {
  public:
   ExhaustiveSampler(const std::shared_ptr<RandomNumberGenerator>& rng,
-                    const int min_num_samples);
+                    const int min_num_samples,
+                    const bool sample_by_quality = false,
+                    const int stream_index = 0,
+                    const int num_streams = 1);
   ~ExhaustiveSampler() {}
 
   bool Initialize(const int num_datapoints) override;
 
-  // Samples the input variable data and fills the vector subset with the
-  // random samples.
+  // Fills subset with the next combination of data point indices, in
+  // increasing order.
   bool Sample(std::vector<int>* subset) override;
+  bool SampleIndices(int* subset_indices) override;
+
+  // The number of combinations of min_num_samples data points.
+  double NumUniqueSamples() const override;
 
  private:
+  // Advances the combination to the next one of the stream.
+  void Advance();
+
+  const bool sample_by_quality_;
+  const int stream_index_;
+  const int num_streams_;
   int num_datapoints_;
-  // We generate combinations by essentially iterating over the nested loops:
-  //   for (int i = 0; i < num_datapoints; i++) {
-  //     for (int j = i + 1; j < num_datapoints; j++) {
-  //       sample = (i, j);
-  //     }
-  //   }
-  //
-  // We update i and j accordingly so that we do not need to store any other
-  // data.
-  int i_, j_;
+  // The current combination, in increasing order.
+  std::vector<int> combination_;
 };
 
 }  // namespace theia
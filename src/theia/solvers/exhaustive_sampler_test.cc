@@ -33,8 +33,11 @@
 // Author: Chris Sweeney (cmsweeney@cs.ucsb.edu)
 
 #include <algorithm>
+#include <array>
 #include <glog/logging.h>
 #include <memory>
+#include <numeric>
+#include <set>
 #include <utility>
 #include <vector>
 
@@ -55,6 +58,7 @@ TEST(ExhaustiveSampler, EnsureExhaustiveSample) {
 
   ExhaustiveSampler sampler(rng, kMinNumSamples);
   CHECK(sampler.Initialize(data_points.size()));
+  EXPECT_EQ(sampler.NumUniqueSamples(), kNumDataPoints * 99 / 2);
 
   for (int i = 0; i < data_points.size(); i++) {
     for (int j = i + 1; j < data_points.size(); j++) {
@@ -75,4 +79,79 @@ TEST(ExhaustiveSampler, EnsureExhaustiveSample) {
   EXPECT_EQ(subset[1], 1);
 }
 
+TEST(ExhaustiveSampler, EnumeratesLargerSamplesByQuality) {
+  static const int kMinNumSamples = 3;
+  static const int kNumDataPoints = 12;
+  ExhaustiveSampler sampler(nullptr, kMinNumSamples, true);
+  CHECK(sampler.Initialize(kNumDataPoints));
+  ASSERT_EQ(sampler.NumUniqueSamples(), 220);
+
+  std::set<std::vector<int> > samples;
+  int max_index = 0;
+  for (int i = 0; i < sampler.NumUniqueSamples(); i++) {
+    std::vector<int> subset;
+    EXPECT_TRUE(sampler.Sample(&subset));
+    ASSERT_EQ(subset.size(), kMinNumSamples);
+    EXPECT_TRUE(std::is_sorted(subset.begin(), subset.end()));
+    EXPECT_LT(subset.back(), kNumDataPoints);
+    // The highest index never decreases.
+    EXPECT_GE(subset.back(), max_index);
+    max_index = subset.back();
+    samples.emplace(subset);
+  }
+  EXPECT_EQ(samples.size(), sampler.NumUniqueSamples());
+
+  std::array<int, kMinNumSamples> subset;
+  EXPECT_TRUE(sampler.SampleIndices(subset.data()));
+  EXPECT_EQ(subset, (std::array<int, kMinNumSamples>{0, 1, 2}));
+}
+
+TEST(ExhaustiveSampler, EnumeratesLargerSamplesLexicographically) {
+  static const int kMinNumSamples = 3;
+  static const int kNumDataPoints = 12;
+  ExhaustiveSampler sampler(nullptr, kMinNumSamples);
+  CHECK(sampler.Initialize(kNumDataPoints));
+  ASSERT_EQ(sampler.NumUniqueSamples(), 220);
+
+  std::vector<int> previous_subset;
+  for (int i = 0; i < sampler.NumUniqueSamples(); i++) {
+    std::vector<int> subset;
+    EXPECT_TRUE(sampler.Sample(&subset));
+    ASSERT_EQ(subset.size(), kMinNumSamples);
+    EXPECT_TRUE(std::is_sorted(subset.begin(), subset.end()));
+    EXPECT_LT(subset.back(), kNumDataPoints);
+    EXPECT_LT(previous_subset, subset);
+    previous_subset = subset;
+  }
+
+  std::vector<int> subset;
+  EXPECT_TRUE(sampler.Sample(&subset));
+  EXPECT_EQ(subset, std::vector<int>({0, 1, 2}));
+}
+
+TEST(ExhaustiveSampler, StreamsAreDisjoint) {
+  static const int kMinNumSamples = 3;
+  static const int kNumDataPoints = 10;
+  static const int kNumStreams = 3;
+  for (const bool sample_by_quality : {false, true}) {
+    std::vector<std::unique_ptr<ExhaustiveSampler> > samplers;
+    for (int i = 0; i < kNumStreams; i++) {
+      samplers.emplace_back(new ExhaustiveSampler(
+          nullptr, kMinNumSamples, sample_by_quality, i, kNumStreams));
+      CHECK(samplers.back()->Initialize(kNumDataPoints));
+    }
+
+    // Drawing from the streams in turn enumerates the combinations in the
+    // same order as a single stream.
+    ExhaustiveSampler sampler(nullptr, kMinNumSamples, sample_by_quality);
+    CHECK(sampler.Initialize(kNumDataPoints));
+    for (int i = 0; i < sampler.NumUniqueSamples(); i++) {
+      std::vector<int> expected_subset, subset;
+      EXPECT_TRUE(sampler.Sample(&expected_subset));
+      EXPECT_TRUE(samplers[i % kNumStreams]->Sample(&subset));
+      EXPECT_EQ(subset, expected_subset);
+    }
+  }
+}
+
 }  // namespace theia
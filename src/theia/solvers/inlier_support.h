@@ -61,6 +61,28 @@ class InlierSupport : public QualityMeasurement {
     }
     return residuals.size() - inliers->size();
   }
+
+  // Stops counting once the number of outliers reaches max_cost.
+  double ComputeBoundedCost(const std::vector<double>& residuals,
+                            const double max_cost,
+                            std::vector<int>* inliers) override {
+    inliers->reserve(residuals.size());
+    int num_outliers = 0;
+    for (int i = 0; i < residuals.size(); i++) {
+      if (residuals[i] < this->error_thresh_) {
+        inliers->emplace_back(i);
+      } else if (++num_outliers >= max_cost) {
+        return max_cost;
+      }
+    }
+    return num_outliers;
+  }
+
+  // Each outlier costs 1.
+  bool HasResidualCosts() const override { return true; }
+  double ResidualCost(const double residual) const override {
+    return residual < this->error_thresh_ ? 0.0 : 1.0;
+  }
 };
 
 }  // namespace theia
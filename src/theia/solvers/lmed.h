@@ -61,12 +61,20 @@ class LMed : public SampleConsensusEstimator<ModelEstimator> {
 
   bool Initialize() override {
     const bool init_status =
-        SampleConsensusEstimator<ModelEstimator>::Initialize(new RandomSampler(
-            this->ransac_params_.rng, this->estimator_.SampleSize()));
+        SampleConsensusEstimator<ModelEstimator>::Initialize(
+            CreateSampler(this->ransac_params_.rng));
     this->quality_measurement_.reset(
-        new LmedQualityMeasurement(this->estimator_.SampleSize()));
+        new LmedQualityMeasurement(
+            this->estimator_.SampleSize(),
+            this->ransac_params_.lmed_approximate_median));
     return init_status;
   }
+
+ protected:
+  Sampler* CreateSampler(
+      const std::shared_ptr<RandomNumberGenerator>& rng) const override {
+    return new RandomSampler(rng, this->estimator_.SampleSize());
+  }
 };
 
 }  // namespace theia
@@ -38,6 +38,7 @@
 #include <algorithm>
 #include <cmath>
 #include <glog/logging.h>
+#include <limits>
 #include <vector>
 
 #include "theia/solvers/quality_measurement.h"
@@ -50,7 +51,16 @@ namespace theia {
 class LmedQualityMeasurement : public QualityMeasurement {
  public:
   explicit LmedQualityMeasurement(const int min_sample_size)
-      : min_sample_size_(min_sample_size) {}
+      : LmedQualityMeasurement(min_sample_size, false) {}
+
+  // If approximate_median is true, ComputeBoundedCost finds the median from a
+  // histogram of the squared residuals below max_cost instead of selecting it
+  // from a copy of all squared residuals. The median is then accurate up to
+  // max_cost / kNumHistogramBins.
+  LmedQualityMeasurement(const int min_sample_size,
+                         const bool approximate_median)
+      : min_sample_size_(min_sample_size),
+        approximate_median_(approximate_median) {}
   virtual ~LmedQualityMeasurement() {}
 
   // The cost is the squared residual. LMed minimizes the median of the squared
@@ -63,10 +73,55 @@ class LmedQualityMeasurement : public QualityMeasurement {
     return median;
   }
 
+  // The median is at least max_cost as soon as the lower of the (two) middle
+  // squared residuals is known to be at least max_cost, i.e. when enough
+  // squared residuals are at least max_cost. Most hypotheses of a problem with
+  // many outliers are rejected after a fraction of the residuals.
+  double ComputeBoundedCost(const std::vector<double>& residuals,
+                            const double max_cost,
+                            std::vector<int>* inliers) override {
+    if (residuals.empty() || max_cost == std::numeric_limits<double>::max()) {
+      return ComputeCost(residuals, inliers);
+    }
+    const int num_residuals = residuals.size();
+    const int num_residuals_to_reject = num_residuals - (num_residuals - 1) / 2;
+    if (max_cost <= 0.0) {
+      return max_cost;
+    }
+
+    double median;
+    if (approximate_median_) {
+      if (!CalculateApproximateMedianOfSquaredResiduals(
+              residuals, max_cost, num_residuals_to_reject, &median)) {
+        return max_cost;
+      }
+    } else {
+      std::vector<double> squared_residuals(num_residuals);
+      int num_rejected_residuals = 0;
+      for (int i = 0; i < num_residuals; i++) {
+        squared_residuals[i] = ComputeSquaredResidual(residuals[i]);
+        if (squared_residuals[i] >= max_cost &&
+            ++num_rejected_residuals == num_residuals_to_reject) {
+          return max_cost;
+        }
+      }
+      median = CalculateMedian(&squared_residuals);
+    }
+
+    inliers->reserve(num_residuals);
+    CalculateInliers(residuals, median, min_sample_size_, inliers);
+    return median;
+  }
+
  private:
+  // The number of bins of the histogram of the squared residuals below the
+  // bound. The histogram fits in the L1 cache.
+  static const int kNumHistogramBins = 512;
+
   // Minimum number of samples to generate a hypothesis. This is used to
   // calculate a good threshold to count inliers.
   const int min_sample_size_;
+  const bool approximate_median_;
 
   // --------------------------- Helper functions ------------------------------
   // Computes the squared of a residual.
@@ -86,21 +141,69 @@ class LmedQualityMeasurement : public QualityMeasurement {
                    residuals.end(),
                    squared_residuals.begin(),
                    ComputeSquaredResidual);
-    std::nth_element(squared_residuals.begin(),
-                     squared_residuals.begin() + squared_residuals.size() / 2,
-                     squared_residuals.end());
-    double median = squared_residuals[squared_residuals.size() / 2];
-    if ((squared_residuals.size() % 2) != 0) {
-      std::nth_element(
-          squared_residuals.begin(),
-          squared_residuals.begin() + (squared_residuals.size() / 2) - 1,
-          squared_residuals.end());
-      median = 0.5 *
-               (squared_residuals[(squared_residuals.size() / 2) - 1] + median);
+    return CalculateMedian(&squared_residuals);
+  }
+
+  // Calculates the median of the values, which are reordered.
+  static double CalculateMedian(std::vector<double>* values) {
+    const int middle = values->size() / 2;
+    std::nth_element(values->begin(), values->begin() + middle, values->end());
+    double median = (*values)[middle];
+    if ((values->size() % 2) == 0) {
+      median =
+          0.5 * (*std::max_element(values->begin(), values->begin() + middle) +
+                 median);
     }
     return median;
   }
 
+  // Approximates the median of the squared residuals by linear interpolation
+  // within the bin of a histogram over [0, max_cost) that contains the median.
+  // Returns false without a median as soon as num_residuals_to_reject squared
+  // residuals are at least max_cost.
+  // Params:
+  //   residuals:  The residuals for each of the data points.
+  //   max_cost:  The upper bound of the histogram.
+  //   num_residuals_to_reject:  The number of squared residuals of at least
+  //     max_cost that make the median at least max_cost.
+  //   median:  The approximate median.
+  bool CalculateApproximateMedianOfSquaredResiduals(
+      const std::vector<double>& residuals,
+      const double max_cost,
+      const int num_residuals_to_reject,
+      double* median) const {
+    int histogram[kNumHistogramBins] = {0};
+    const double bins_per_cost = kNumHistogramBins / max_cost;
+    int num_rejected_residuals = 0;
+    for (const double residual : residuals) {
+      const double squared_residual = ComputeSquaredResidual(residual);
+      if (squared_residual >= max_cost) {
+        if (++num_rejected_residuals == num_residuals_to_reject) {
+          return false;
+        }
+        continue;
+      }
+      const int bin =
+          std::min(static_cast<int>(squared_residual * bins_per_cost),
+                   kNumHistogramBins - 1);
+      ++histogram[bin];
+    }
+
+    // The (fractional) rank of the median among the sorted squared residuals.
+    const double median_rank = 0.5 * (residuals.size() - 1);
+    int num_below_bin = 0;
+    int bin = 0;
+    while (num_below_bin + histogram[bin] <= median_rank) {
+      num_below_bin += histogram[bin];
+      ++bin;
+    }
+    // Assume that the squared residuals are spread evenly in the bin.
+    const double position_in_bin =
+        (median_rank - num_below_bin + 0.5) / (histogram[bin] + 1);
+    *median = (bin + position_in_bin) / bins_per_cost;
+    return true;
+  }
+
   // Calculates the inlier ratio from the residuals.
   void CalculateInliers(const std::vector<double>& residuals,
                         const double median,
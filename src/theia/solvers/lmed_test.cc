@@ -136,6 +136,68 @@ TEST_F(LmedTest, ComputingQualityMeasureOfCorrectModel) {
   EXPECT_NEAR(inlier_ratio, 0.666, 0.1);
 }
 
+// Tests that a bounded cost is exact below the bound, and that hypotheses whose
+// median is above the bound are rejected with the bound as their cost.
+TEST_F(LmedTest, BoundedCost) {
+  LmedQualityMeasurement lmed_quality_measurement(2);
+  // The median of the squared residuals is 9.
+  const std::vector<double> residuals = {1.0, 5.0, 2.0, 3.0, 4.0};
+  std::vector<int> inliers;
+  EXPECT_EQ(lmed_quality_measurement.ComputeCost(residuals, &inliers), 9.0);
+  inliers.clear();
+  EXPECT_EQ(
+      lmed_quality_measurement.ComputeBoundedCost(residuals, 10.0, &inliers),
+      9.0);
+  EXPECT_EQ(inliers.size(), residuals.size());
+  inliers.clear();
+  EXPECT_EQ(
+      lmed_quality_measurement.ComputeBoundedCost(residuals, 9.0, &inliers),
+      9.0);
+  EXPECT_EQ(
+      lmed_quality_measurement.ComputeBoundedCost(residuals, 4.0, &inliers),
+      4.0);
+  EXPECT_TRUE(inliers.empty());
+
+  // The median of an even number of squared residuals is the mean of the two
+  // middle ones.
+  const std::vector<double> even_residuals = {1.0, 2.0, 3.0, 4.0};
+  EXPECT_EQ(lmed_quality_measurement.ComputeCost(even_residuals, &inliers),
+            6.5);
+}
+
+// Tests that the median interpolated from the histogram is close to the exact
+// median.
+TEST_F(LmedTest, ApproximateMedian) {
+  LineEstimator line_estimator;
+  LmedQualityMeasurement exact_quality_measurement(
+      line_estimator.SampleSize());
+  LmedQualityMeasurement approximate_quality_measurement(
+      line_estimator.SampleSize(), true);
+  const Line correct_line(1.0, 0.0);
+  std::vector<double> residuals(input_points->size());
+  for (int i = 0; i < residuals.size(); ++i) {
+    residuals[i] = line_estimator.Error(input_points->at(i), correct_line);
+  }
+  std::vector<int> exact_inliers;
+  const double exact_median =
+      exact_quality_measurement.ComputeCost(residuals, &exact_inliers);
+  const double max_cost = 4.0 * exact_median;
+  std::vector<int> approximate_inliers;
+  const double approximate_median =
+      approximate_quality_measurement.ComputeBoundedCost(
+          residuals, max_cost, &approximate_inliers);
+  EXPECT_NEAR(approximate_median, exact_median, 2.0 * max_cost / 512);
+  EXPECT_NEAR(approximate_inliers.size(), exact_inliers.size(),
+              0.01 * residuals.size());
+
+  // A hypothesis with a median above the bound is rejected.
+  approximate_inliers.clear();
+  EXPECT_EQ(approximate_quality_measurement.ComputeBoundedCost(
+                residuals, 0.5 * exact_median, &approximate_inliers),
+            0.5 * exact_median);
+  EXPECT_TRUE(approximate_inliers.empty());
+}
+
 // Tests the Lmed estimator by fitting a line to the input_points.
 TEST_F(LmedTest, LineFitting) {
   LineEstimator line_estimator;
@@ -155,4 +217,23 @@ TEST_F(LmedTest, LineFitting) {
       0.1);
 }
 
+// Tests the Lmed estimator with the approximate median.
+TEST_F(LmedTest, LineFittingWithApproximateMedian) {
+  LineEstimator line_estimator;
+  Line line;
+  RansacParameters params;
+  params.rng = std::make_shared<RandomNumberGenerator>(rng);
+  params.error_thresh = 5.0;
+  params.lmed_approximate_median = true;
+  LMed<LineEstimator> lmed_line(params, line_estimator);
+  lmed_line.Initialize();
+  RansacSummary summary;
+  CHECK(lmed_line.Estimate(*input_points, &line, &summary));
+  EXPECT_LT(fabs(line.m - 1.0), 0.1);
+  EXPECT_NEAR(
+      static_cast<double>(summary.inliers.size()) / input_points->size(),
+      0.666,
+      0.1);
+}
+
 }  // namespace theia
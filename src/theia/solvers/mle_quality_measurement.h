@@ -69,6 +69,12 @@ class MLEQualityMeasurement : public QualityMeasurement {
     }
     return mle_score;
   }
+
+  // Every residual adds its error, capped at the error threshold.
+  bool HasResidualCosts() const override { return true; }
+  double ResidualCost(const double residual) const override {
+    return std::min(residual, error_thresh_);
+  }
 };
 
 }  // namespace theia
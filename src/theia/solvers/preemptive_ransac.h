@@ -0,0 +1,287 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+
+#ifndef THEIA_SOLVERS_PREEMPTIVE_RANSAC_H_
+#define THEIA_SOLVERS_PREEMPTIVE_RANSAC_H_
+
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <numeric>
+#include <vector>
+
+#include "theia/solvers/random_sampler.h"
+#include "theia/solvers/sample_consensus_estimator.h"
+#include "theia/solvers/sampler.h"
+#include "theia/util/random.h"
+#include "theia/util/threadpool.h"
+#include "theia/util/timer.h"
+
+namespace theia {
+
+// Preemptive RANSAC as proposed by Nister in "Preemptive RANSAC for Live
+// Structure and Motion Estimation", ICCV 2003. A fixed number of hypotheses
+// (ransac_params.preemptive_num_hypotheses) is generated up front and scored
+// breadth-first on blocks of ransac_params.preemptive_block_size randomly
+// ordered data points. After each block only the best half of the remaining
+// hypotheses is kept, so the running time is bounded regardless of the inlier
+// ratio. This makes it suitable for real-time applications that need a bounded
+// latency rather than a confidence target. The costs of the blocks are summed,
+// so the quality measurement must be additive (inlier support or MLE).
+template <class ModelEstimator>
+class PreemptiveRansac : public SampleConsensusEstimator<ModelEstimator> {
+ public:
+  typedef typename ModelEstimator::Datum Datum;
+  typedef typename ModelEstimator::Model Model;
+
+  PreemptiveRansac(const RansacParameters& ransac_params,
+                   const ModelEstimator& estimator)
+      : SampleConsensusEstimator<ModelEstimator>(ransac_params, estimator) {
+    CHECK_GT(ransac_params.preemptive_num_hypotheses, 0);
+    CHECK_GT(ransac_params.preemptive_block_size, 0);
+  }
+  virtual ~PreemptiveRansac() {}
+
+  // Initializes the random sampler and inlier support measurement.
+  bool Initialize() {
+    return SampleConsensusEstimator<ModelEstimator>::Initialize(
+        CreateSampler(this->ransac_params_.rng));
+  }
+
+  // Generates the hypotheses and returns the one with the lowest cost after
+  // preemptive scoring. The time spent in each stage is stored in the summary.
+  bool Estimate(const std::vector<Datum>& data,
+                Model* best_model,
+                RansacSummary* summary) override;
+
+ protected:
+  Sampler* CreateSampler(
+      const std::shared_ptr<RandomNumberGenerator>& rng) const override {
+    return new RandomSampler(rng, this->estimator_.SampleSize());
+  }
+
+ private:
+  // Generates up to preemptive_num_hypotheses hypotheses from as many minimal
+  // samples.
+  void GenerateHypotheses(const std::vector<Datum>& data,
+                          std::vector<Model>* hypotheses,
+                          RansacSummary* summary);
+
+  // Scores the hypotheses on blocks of data in a random order and returns the
+  // index of the best hypothesis.
+  int ScoreHypotheses(const std::vector<Datum>& data,
+                      const std::vector<Model>& hypotheses);
+};
+
+// --------------------------- Implementation --------------------------------//
+
+template <class ModelEstimator>
+bool PreemptiveRansac<ModelEstimator>::Estimate(const std::vector<Datum>& data,
+                                                Model* best_model,
+                                                RansacSummary* summary) {
+  CHECK_GT(data.size(), 0)
+      << "Cannot perform estimation with 0 data measurements!";
+  CHECK_NOTNULL(this->sampler_.get());
+  CHECK_NOTNULL(this->quality_measurement_.get());
+  CHECK_NOTNULL(summary);
+  CHECK_NOTNULL(best_model);
+  summary->inliers.clear();
+  summary->num_input_data_points = data.size();
+  summary->statistics = RansacStatistics();
+  summary->statistics.num_estimations = 1;
+
+  if (!this->sampler_->Initialize(data.size())) {
+    return false;
+  }
+
+  Timer timer;
+  std::vector<Model> hypotheses;
+  GenerateHypotheses(data, &hypotheses, summary);
+  summary->hypothesis_generation_time = timer.ElapsedTimeInSeconds();
+  if (hypotheses.empty()) {
+    return false;
+  }
+
+  timer.Reset();
+  *best_model = hypotheses[ScoreHypotheses(data, hypotheses)];
+  summary->hypothesis_scoring_time = timer.ElapsedTimeInSeconds();
+
+  // Compute the final inliers for the best model.
+  timer.Reset();
+  std::vector<double> residuals;
+  this->estimator_.Residuals(data, *best_model, &residuals);
+  this->quality_measurement_->ComputeCost(residuals, &summary->inliers);
+
+  if (this->ransac_params_.use_lo) {
+    std::vector<Datum> inliers;
+    this->GetInlierDatum(data, inliers, summary->inliers);
+    this->estimator_.RefineModel(inliers, best_model);
+    ++summary->num_lo_iterations;
+  }
+  summary->refinement_time = timer.ElapsedTimeInSeconds();
+
+  const double inlier_ratio =
+      static_cast<double>(summary->inliers.size()) / data.size();
+  summary->confidence =
+      1.0 - pow(1.0 - pow(inlier_ratio, this->estimator_.SampleSize()),
+                summary->num_iterations);
+  // The stages are timed as a whole, so sampling and solving are not split.
+  if (this->ransac_params_.collect_statistics) {
+    summary->statistics.solver_time = summary->hypothesis_generation_time;
+    summary->statistics.scoring_time = summary->hypothesis_scoring_time;
+    summary->statistics.lo_time = summary->refinement_time;
+    summary->statistics.AddInlierRatio(inlier_ratio);
+  }
+  return true;
+}
+
+template <class ModelEstimator>
+void PreemptiveRansac<ModelEstimator>::GenerateHypotheses(
+    const std::vector<Datum>& data,
+    std::vector<Model>* hypotheses,
+    RansacSummary* summary) {
+  const int num_hypotheses = this->ransac_params_.preemptive_num_hypotheses;
+  hypotheses->reserve(num_hypotheses);
+
+  std::vector<int> data_subset_indices;
+  std::vector<Datum> data_subset;
+  std::vector<Model> temp_models;
+  for (summary->num_iterations = 0;
+       summary->num_iterations < num_hypotheses &&
+       hypotheses->size() < num_hypotheses;
+       summary->num_iterations++) {
+    ++summary->statistics.num_samples;
+    data_subset_indices.clear();
+    if (!this->sampler_->Sample(&data_subset_indices)) {
+      ++summary->statistics.num_degenerate_samples;
+      continue;
+    }
+
+    data_subset.resize(data_subset_indices.size());
+    for (int i = 0; i < data_subset_indices.size(); i++) {
+      data_subset[i] = data[data_subset_indices[i]];
+    }
+
+    temp_models.clear();
+    if (!this->estimator_.EstimateModel(data_subset, &temp_models) ||
+        temp_models.empty()) {
+      ++summary->statistics.num_degenerate_samples;
+      continue;
+    }
+    summary->statistics.num_models += temp_models.size();
+    for (const Model& temp_model : temp_models) {
+      if (hypotheses->size() < num_hypotheses) {
+        hypotheses->emplace_back(temp_model);
+      }
+    }
+  }
+}
+
+template <class ModelEstimator>
+int PreemptiveRansac<ModelEstimator>::ScoreHypotheses(
+    const std::vector<Datum>& data, const std::vector<Model>& hypotheses) {
+  const int block_size = this->ransac_params_.preemptive_block_size;
+  const int num_threads = std::max(this->ransac_params_.num_threads, 1);
+  if (num_threads > 1 && (this->thread_pool_ == nullptr ||
+                          this->thread_pool_size_ != num_threads)) {
+    this->thread_pool_.reset(new ThreadPool(num_threads));
+    this->thread_pool_size_ = num_threads;
+  }
+
+  // Score the data in a random order so that the blocks are unbiased samples.
+  std::vector<int> data_order(data.size());
+  std::iota(data_order.begin(), data_order.end(), 0);
+  for (int i = data_order.size() - 1; i > 0; i--) {
+    std::swap(data_order[i], data_order[this->rng_->RandInt(0, i)]);
+  }
+
+  std::vector<double> costs(hypotheses.size(), 0.0);
+  std::vector<int> remaining_hypotheses(hypotheses.size());
+  std::iota(remaining_hypotheses.begin(), remaining_hypotheses.end(), 0);
+  const auto is_better = [&costs](const int i, const int j) {
+    return costs[i] < costs[j] || (costs[i] == costs[j] && i < j);
+  };
+
+  std::vector<Datum> block;
+  block.reserve(block_size);
+  for (int block_start = 0, num_blocks = 1;
+       block_start < data.size() && remaining_hypotheses.size() > 1;
+       block_start += block_size, num_blocks++) {
+    const int block_end = std::min<int>(block_start + block_size, data.size());
+    block.clear();
+    for (int i = block_start; i < block_end; i++) {
+      block.emplace_back(data[data_order[i]]);
+    }
+
+    // Each hypothesis only writes its own cost, so they may be scored in
+    // parallel.
+    const auto score_block = [&](const int start, const int end) {
+      std::vector<double> residuals;
+      std::vector<int> inliers;
+      for (int i = start; i < end; i++) {
+        const int hypothesis = remaining_hypotheses[i];
+        this->estimator_.Residuals(block, hypotheses[hypothesis], &residuals);
+        inliers.clear();
+        costs[hypothesis] +=
+            this->quality_measurement_->ComputeCost(residuals, &inliers);
+      }
+    };
+    ParallelFor(this->thread_pool_.get(),
+                remaining_hypotheses.size(),
+                num_threads,
+                score_block);
+
+    // Keep the best M * 2^-k hypotheses after k blocks. Ties are broken by the
+    // generation order so that the result is deterministic.
+    const int num_to_keep = std::max(
+        1, static_cast<int>(hypotheses.size() >> std::min(num_blocks, 31)));
+    if (num_to_keep < remaining_hypotheses.size()) {
+      std::nth_element(remaining_hypotheses.begin(),
+                       remaining_hypotheses.begin() + num_to_keep,
+                       remaining_hypotheses.end(),
+                       is_better);
+      remaining_hypotheses.resize(num_to_keep);
+    }
+  }
+
+  return *std::min_element(
+      remaining_hypotheses.begin(), remaining_hypotheses.end(), is_better);
+}
+
+}  // namespace theia
+
+#endif  // THEIA_SOLVERS_PREEMPTIVE_RANSAC_H_
@@ -59,9 +59,16 @@ class Prosac : public SampleConsensusEstimator<ModelEstimator> {
   ~Prosac() {}
 
   bool Initialize() {
-    Sampler* prosac_sampler = new ProsacSampler(this->ransac_params_.rng,
-                                                this->estimator_.SampleSize());
-    return SampleConsensusEstimator<ModelEstimator>::Initialize(prosac_sampler);
+    return SampleConsensusEstimator<ModelEstimator>::Initialize(
+        CreateSampler(this->ransac_params_.rng));
+  }
+
+ protected:
+  // In the parallel mode each thread follows its own progressive sampling
+  // schedule, so the top ranked data is tried early by every thread.
+  Sampler* CreateSampler(
+      const std::shared_ptr<RandomNumberGenerator>& rng) const override {
+    return new ProsacSampler(rng, this->estimator_.SampleSize());
   }
 };
 }  // namespace theia
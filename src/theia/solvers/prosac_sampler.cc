@@ -65,6 +65,12 @@ void ProsacSampler::SetSampleNumber(int k) { kth_sample_number_ = k; }
 // NOTE: This assumes that data is in sorted order by quality where data[i] is
 // of higher quality than data[j] for all i < j.
 bool ProsacSampler::Sample(std::vector<int>* subset_indices) {
+  const int num_subset_indices = subset_indices->size();
+  subset_indices->resize(num_subset_indices + this->min_num_samples_);
+  return SampleIndices(subset_indices->data() + num_subset_indices);
+}
+
+bool ProsacSampler::SampleIndices(int* subset_indices) {
   // Set t_n according to the PROSAC paper's recommendation.
   double t_n = ransac_convergence_iterations_;
   int n = this->min_num_samples_;
@@ -83,46 +89,27 @@ bool ProsacSampler::Sample(std::vector<int>* subset_indices) {
       n++;
     }
   }
-  subset_indices->reserve(this->min_num_samples_);
-  if (t_n_prime < kth_sample_number_) {
-    // Randomly sample m data points from the top n data points.
-    std::vector<int> random_numbers;
-    for (int i = 0; i < this->min_num_samples_; i++) {
-      // Generate a random number that has not already been used.
-      int rand_number;
-      while (std::find(random_numbers.begin(),
-                       random_numbers.end(),
-                       (rand_number = this->rng_->RandInt(0, n - 1))) !=
-             random_numbers.end()) {
-      }
-
-      random_numbers.push_back(rand_number);
-
-      // Push the *unique* random index back.
-      subset_indices->push_back(rand_number);
-    }
-  } else {
-    std::vector<int> random_numbers;
-    // Randomly sample m-1 data points from the top n-1 data points.
-    for (int i = 0; i < this->min_num_samples_ - 1; i++) {
-      // Generate a random number that has not already been used.
-      int rand_number;
-      while (std::find(random_numbers.begin(),
-                       random_numbers.end(),
-                       (rand_number = this->rng_->RandInt(0, n - 2))) !=
-             random_numbers.end()) {
-      }
-      random_numbers.push_back(rand_number);
-
-      // Push the *unique* random index back.
-      subset_indices->push_back(rand_number);
+  // Randomly sample m data points from the top n data points, or m-1 data
+  // points from the top n-1 data points and the nth point.
+  const bool sample_nth_point = t_n_prime >= kth_sample_number_;
+  const int num_random_samples =
+      sample_nth_point ? this->min_num_samples_ - 1 : this->min_num_samples_;
+  const int max_index = sample_nth_point ? n - 2 : n - 1;
+  for (int i = 0; i < num_random_samples; i++) {
+    // Generate a random number that has not already been used.
+    int rand_number;
+    while (std::find(subset_indices,
+                     subset_indices + i,
+                     (rand_number = this->rng_->RandInt(0, max_index))) !=
+           subset_indices + i) {
     }
+    // Push the *unique* random index back.
+    subset_indices[i] = rand_number;
+  }
+  if (sample_nth_point) {
     // Make the last point from the nth position.
-    subset_indices->push_back(n);
+    subset_indices[num_random_samples] = n;
   }
-  CHECK_EQ(subset_indices->size(), this->min_num_samples_)
-      << "Prosac subset is incorrect "
-      << "size!";
   kth_sample_number_++;
   return true;
 }
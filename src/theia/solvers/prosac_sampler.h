@@ -53,7 +53,7 @@ class ProsacSampler : public Sampler {
                 const int min_num_samples);
   ~ProsacSampler() {}
 
-  bool Initialize(const int num_datapoints);
+  bool Initialize(const int num_datapoints) override;
   // Set the sample such that you are sampling the kth prosac sample (Eq. 6).
   void SetSampleNumber(int k);
 
@@ -61,7 +61,8 @@ class ProsacSampler : public Sampler {
   // samples.
   // NOTE: This assumes that data is in sorted order by quality where data[i] is
   // of higher quality than data[j] for all i < j.
-  bool Sample(std::vector<int>* subset_indices);
+  bool Sample(std::vector<int>* subset_indices) override;
+  bool SampleIndices(int* subset_indices) override;
 
  private:
   int num_datapoints_;
@@ -60,6 +60,22 @@ class QualityMeasurement {
   virtual double ComputeCost(const std::vector<double>& residuals,
                              std::vector<int>* inliers) = 0;
 
+  // Same as ComputeCost, but the cost is only needed if it is lower than
+  // max_cost, e.g. the cost of the best hypothesis so far. Measurements may
+  // stop early and return max_cost as soon as the cost is known to be at least
+  // max_cost, in which case the inliers are not computed.
+  virtual double ComputeBoundedCost(const std::vector<double>& residuals,
+                                    const double max_cost,
+                                    std::vector<int>* inliers) {
+    return ComputeCost(residuals, inliers);
+  }
+
+  // Returns true if the cost is the sum of ResidualCost over the residuals,
+  // so that the cost of a hypothesis is known to be at least max_cost before
+  // all of its residuals are computed.
+  virtual bool HasResidualCosts() const { return false; }
+  virtual double ResidualCost(const double residual) const { return 0.0; }
+
  protected:
   double error_thresh_;
 };
@@ -45,6 +45,45 @@
 #include "theia/util/random.h"
 
 namespace theia {
+namespace {
+
+// Floyd's algorithm for drawing num_samples distinct indices out of
+// [0, num_datapoints): the i-th sample is a random index up to
+// num_datapoints - num_samples + i, or that upper bound if the index was
+// already drawn.
+template <int kNumSamples>
+void DrawWithoutReplacement(RandomNumberGenerator* rng,
+                            const int num_datapoints,
+                            int* subset_indices) {
+  for (int i = 0; i < kNumSamples; i++) {
+    const int upper_bound = num_datapoints - kNumSamples + i;
+    int index = rng->RandInt(0, upper_bound);
+    for (int j = 0; j < i; j++) {
+      if (subset_indices[j] == index) {
+        index = upper_bound;
+        break;
+      }
+    }
+    subset_indices[i] = index;
+  }
+}
+
+void DrawWithoutReplacement(RandomNumberGenerator* rng,
+                            const int num_samples,
+                            const int num_datapoints,
+                            int* subset_indices) {
+  for (int i = 0; i < num_samples; i++) {
+    const int upper_bound = num_datapoints - num_samples + i;
+    const int index = rng->RandInt(0, upper_bound);
+    subset_indices[i] =
+        std::find(subset_indices, subset_indices + i, index) ==
+                subset_indices + i
+            ? index
+            : upper_bound;
+  }
+}
+
+}  // namespace
 
 RandomSampler::RandomSampler(const std::shared_ptr<RandomNumberGenerator>& rng,
                              const int min_num_samples)
@@ -71,4 +110,28 @@ bool RandomSampler::Sample(std::vector<int>* subset_indices) {
   return true;
 }
 
+bool RandomSampler::SampleIndices(int* subset_indices) {
+  const int num_datapoints = sample_indices_.size();
+  RandomNumberGenerator* rng = this->rng_.get();
+  switch (this->min_num_samples_) {
+    case 2:
+      DrawWithoutReplacement<2>(rng, num_datapoints, subset_indices);
+      break;
+    case 3:
+      DrawWithoutReplacement<3>(rng, num_datapoints, subset_indices);
+      break;
+    case 4:
+      DrawWithoutReplacement<4>(rng, num_datapoints, subset_indices);
+      break;
+    case 5:
+      DrawWithoutReplacement<5>(rng, num_datapoints, subset_indices);
+      break;
+    default:
+      DrawWithoutReplacement(
+          rng, this->min_num_samples_, num_datapoints, subset_indices);
+      break;
+  }
+  return true;
+}
+
 }  // namespace theia
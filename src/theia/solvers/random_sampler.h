@@ -60,6 +60,13 @@ class RandomSampler : public Sampler {
   // random samples.
   bool Sample(std::vector<int>* subset_indices) override;
 
+  // Draws the samples with Floyd's algorithm, which needs one random number
+  // per sample and does not touch the permutation of Sample. The loops are
+  // unrolled for the common minimal sample sizes. The samples are a uniformly
+  // random subset, but unlike the samples of Sample their order is not
+  // uniformly random.
+  bool SampleIndices(int* subset_indices) override;
+
  private:
   std::vector<int> sample_indices_;
 };
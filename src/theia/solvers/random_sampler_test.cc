@@ -70,4 +70,37 @@ TEST(RandomSampler, UniqueMinimalSample) {
   }
 }
 
+TEST(RandomSampler, UniqueFixedSizeSample) {
+  std::shared_ptr<RandomNumberGenerator> rng =
+      std::make_shared<RandomNumberGenerator>(55);
+  static const int kNumDataPoints = 11;
+  for (const int min_num_samples : {2, 3, 5, 7}) {
+    RandomSampler sampler(rng, min_num_samples);
+    CHECK(sampler.Initialize(kNumDataPoints));
+    std::vector<int> num_times_sampled(kNumDataPoints, 0);
+    static const int kNumSamples = 10000;
+    for (int i = 0; i < kNumSamples; i++) {
+      std::vector<int> subset(min_num_samples);
+      EXPECT_TRUE(sampler.SampleIndices(subset.data()));
+
+      // Make sure that the sampling is unique.
+      EXPECT_TRUE(IsUnique(subset));
+      for (const int index : subset) {
+        ASSERT_GE(index, 0);
+        ASSERT_LT(index, kNumDataPoints);
+        ++num_times_sampled[index];
+      }
+    }
+
+    // All data points are sampled equally often.
+    const double expected_num_times_sampled =
+        static_cast<double>(kNumSamples) * min_num_samples / kNumDataPoints;
+    for (const int num_times : num_times_sampled) {
+      EXPECT_NEAR(num_times,
+                  expected_num_times_sampled,
+                  0.1 * expected_num_times_sampled);
+    }
+  }
+}
+
 }  // namespace theia
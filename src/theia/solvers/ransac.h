@@ -53,9 +53,14 @@ class Ransac : public SampleConsensusEstimator<ModelEstimator> {
 
   // Initializes the random sampler and inlier support measurement.
   bool Initialize() {
-    Sampler* random_sampler = new RandomSampler(this->ransac_params_.rng,
-                                                this->estimator_.SampleSize());
-    return SampleConsensusEstimator<ModelEstimator>::Initialize(random_sampler);
+    return SampleConsensusEstimator<ModelEstimator>::Initialize(
+        CreateSampler(this->ransac_params_.rng));
+  }
+
+ protected:
+  Sampler* CreateSampler(
+      const std::shared_ptr<RandomNumberGenerator>& rng) const override {
+    return new RandomSampler(rng, this->estimator_.SampleSize());
   }
 };
 
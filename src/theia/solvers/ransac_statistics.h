@@ -0,0 +1,141 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#ifndef THEIA_SOLVERS_RANSAC_STATISTICS_H_
+#define THEIA_SOLVERS_RANSAC_STATISTICS_H_
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "theia/util/timer.h"
+
+namespace theia {
+
+// Instrumentation of RANSAC estimations. The sample and model counters are
+// always filled in, while the times and the inlier ratio histogram are only
+// collected when RansacParameters::collect_statistics is set. The statistics
+// of several estimations (e.g. of all image pairs during matching) can be
+// aggregated with Merge. Times are wall clock times in seconds. In the parallel
+// mode the times of all threads are summed.
+struct RansacStatistics {
+  // The number of bins of the inlier ratio histogram.
+  static const int kNumInlierRatioBins = 10;
+
+  RansacStatistics() : inlier_ratio_histogram(kNumInlierRatioBins, 0) {}
+
+  // The number of estimations that these statistics are aggregated over.
+  int num_estimations = 0;
+
+  // Time spent drawing minimal samples, running the minimal solver, computing
+  // the residuals and cost of the models, and in local optimization
+  // (including the refinement of the final model).
+  double sampling_time = 0.0;
+  double solver_time = 0.0;
+  double scoring_time = 0.0;
+  double lo_time = 0.0;
+
+  // The number of minimal samples drawn, the number of them that were
+  // degenerate (the sampler or the minimal solver failed) and the total number
+  // of models that the minimal solver returned.
+  int64_t num_samples = 0;
+  int64_t num_degenerate_samples = 0;
+  int64_t num_models = 0;
+
+  // The inlier ratio of the final model of each estimation. Bin i counts the
+  // estimations with an inlier ratio in [i, i + 1) / kNumInlierRatioBins and
+  // the last bin includes an inlier ratio of 1.
+  std::vector<int> inlier_ratio_histogram;
+
+  // The average number of models per minimal sample.
+  double SolutionsPerSample() const {
+    return num_samples > 0 ? static_cast<double>(num_models) / num_samples
+                           : 0.0;
+  }
+
+  // Adds the inlier ratio of a final model to the histogram.
+  void AddInlierRatio(const double inlier_ratio) {
+    const int bin =
+        std::min(static_cast<int>(inlier_ratio * kNumInlierRatioBins),
+                 kNumInlierRatioBins - 1);
+    ++inlier_ratio_histogram[std::max(bin, 0)];
+  }
+
+  // Adds the statistics of other to these statistics.
+  void Merge(const RansacStatistics& other) {
+    num_estimations += other.num_estimations;
+    sampling_time += other.sampling_time;
+    solver_time += other.solver_time;
+    scoring_time += other.scoring_time;
+    lo_time += other.lo_time;
+    num_samples += other.num_samples;
+    num_degenerate_samples += other.num_degenerate_samples;
+    num_models += other.num_models;
+    for (int i = 0; i < kNumInlierRatioBins; i++) {
+      inlier_ratio_histogram[i] += other.inlier_ratio_histogram[i];
+    }
+  }
+};
+
+// Accumulates the time between consecutive calls of Lap into the given
+// counters. Does nothing when disabled so that the instrumentation only costs
+// a branch if statistics are not collected.
+class RansacStatisticsTimer {
+ public:
+  explicit RansacStatisticsTimer(const bool enabled) : enabled_(enabled) {}
+
+  // Restarts the measurement.
+  void Reset() {
+    if (enabled_) {
+      timer_.Reset();
+    }
+  }
+
+  // Adds the time since the last call of Reset or Lap to time and restarts
+  // the measurement.
+  void Lap(double* time) {
+    if (enabled_) {
+      *time += timer_.ElapsedTimeInSeconds();
+      timer_.Reset();
+    }
+  }
+
+ private:
+  const bool enabled_;
+  Timer timer_;
+};
+
+}  // namespace theia
+
+#endif  // THEIA_SOLVERS_RANSAC_STATISTICS_H_
@@ -83,6 +83,62 @@ class LineEstimator : public Estimator<Point, Line> {
     return fabs(a * point.x + b * point.y + c) / sqrt(a * a + b * b);
   }
 };
+
+// A line estimator that scores all points at once and counts the number of
+// per-point Error calls.
+class BatchedLineEstimator : public LineEstimator {
+ public:
+  double Error(const Point& point, const Line& line) const {
+    ++num_error_calls;
+    return LineEstimator::Error(point, line);
+  }
+
+  void Residuals(const std::vector<Point>& data,
+                 const Line& line,
+                 std::vector<double>* residuals) const {
+    ++num_residuals_calls;
+    residuals->resize(data.size());
+    const double inverse_norm = 1.0 / sqrt(line.m * line.m + 1.0);
+    for (int i = 0; i < data.size(); i++) {
+      (*residuals)[i] =
+          fabs(data[i].y - line.m * data[i].x - line.b) * inverse_norm;
+    }
+  }
+
+  mutable int num_error_calls = 0;
+  mutable int num_residuals_calls = 0;
+};
+
+// A line estimator with a compile-time sample size, whose samples are drawn
+// into arrays on the stack.
+class FixedSampleSizeLineEstimator : public LineEstimator {
+ public:
+  static constexpr int kSampleSize = 2;
+};
+
+// A line estimator that fits non-minimal samples with least squares.
+class LeastSquaresLineEstimator : public LineEstimator {
+ public:
+  bool EstimateModelNonminimal(const std::vector<Point>& data,
+                               std::vector<Line>* models) const {
+    double mean_x = 0, mean_y = 0;
+    for (const Point& point : data) {
+      mean_x += point.x / data.size();
+      mean_y += point.y / data.size();
+    }
+    double covariance = 0, variance = 0;
+    for (const Point& point : data) {
+      covariance += (point.x - mean_x) * (point.y - mean_y);
+      variance += (point.x - mean_x) * (point.x - mean_x);
+    }
+    if (variance == 0) {
+      return false;
+    }
+    const double m = covariance / variance;
+    models->emplace_back(m, mean_y - m * mean_x);
+    return true;
+  }
+};
 }  // namespace
 
 TEST(RansacTest, LineFitting) {
@@ -112,6 +168,39 @@ TEST(RansacTest, LineFitting) {
   ASSERT_LT(fabs(line.m - 1.0), 0.1);
 }
 
+TEST(RansacTest, FixedSampleSize) {
+  static_assert(FixedSampleSize<LineEstimator>::value == 0,
+                "The sample size of LineEstimator is dynamic.");
+  static_assert(FixedSampleSize<FixedSampleSizeLineEstimator>::value == 2,
+                "The sample size of FixedSampleSizeLineEstimator is fixed.");
+
+  std::vector<Point> input_points;
+  for (int i = 0; i < 1000; ++i) {
+    if (i % 2 == 0) {
+      input_points.push_back(Point(i + rng.RandGaussian(0.0, 0.1),
+                                   i + rng.RandGaussian(0.0, 0.1)));
+    } else {
+      input_points.push_back(
+          Point(rng.RandDouble(0.0, 1000), rng.RandDouble(0.0, 1000)));
+    }
+  }
+
+  FixedSampleSizeLineEstimator line_estimator;
+  RansacParameters params;
+  params.error_thresh = 0.5;
+  for (const int num_threads : {1, 4}) {
+    params.rng = std::make_shared<RandomNumberGenerator>(59);
+    params.num_threads = num_threads;
+    Ransac<FixedSampleSizeLineEstimator> ransac_line(params, line_estimator);
+    ransac_line.Initialize();
+    Line line;
+    RansacSummary summary;
+    EXPECT_TRUE(ransac_line.Estimate(input_points, &line, &summary));
+    EXPECT_LT(fabs(line.m - 1.0), 0.1);
+    EXPECT_GE(summary.inliers.size(), 250);
+  }
+}
+
 TEST(RansacTest, TerminationNumInliers) {
   // Create a set of points along y=x with a small random pertubation.
   // Create a set of points along y=x with a small random pertubation.
@@ -139,4 +228,166 @@ TEST(RansacTest, TerminationNumInliers) {
   ransac_line.Estimate(input_points, &line, &summary);
   ASSERT_GE(summary.inliers.size(), 2500);
 }
+TEST(RansacTest, BatchedResiduals) {
+  std::vector<Point> input_points;
+  for (int i = 0; i < 1000; ++i) {
+    if (i % 2 == 0) {
+      input_points.push_back(Point(i + rng.RandGaussian(0.0, 0.1),
+                                   i + rng.RandGaussian(0.0, 0.1)));
+    } else {
+      input_points.push_back(
+          Point(rng.RandDouble(0.0, 1000), rng.RandDouble(0.0, 1000)));
+    }
+  }
+
+  BatchedLineEstimator line_estimator;
+  Line line;
+  RansacParameters params;
+  params.rng = std::make_shared<RandomNumberGenerator>(rng);
+  params.error_thresh = 0.5;
+  Ransac<BatchedLineEstimator> ransac_line(params, line_estimator);
+  ransac_line.Initialize();
+  RansacSummary summary;
+  EXPECT_TRUE(ransac_line.Estimate(input_points, &line, &summary));
+  EXPECT_LT(fabs(line.m - 1.0), 0.1);
+
+  // All hypotheses are scored with the batched residuals.
+  EXPECT_GT(line_estimator.num_residuals_calls, 0);
+  EXPECT_EQ(line_estimator.num_error_calls, 0);
+}
+
+TEST(RansacTest, InnerRansacLocalOptimization) {
+  // Noisy inliers make minimal models underestimate the inlier support.
+  std::vector<Point> input_points;
+  for (int i = 0; i < 2000; ++i) {
+    if (i % 4 == 0) {
+      input_points.push_back(Point(i + rng.RandGaussian(0.0, 0.5),
+                                   i + rng.RandGaussian(0.0, 0.5)));
+    } else {
+      input_points.push_back(
+          Point(rng.RandDouble(0.0, 2000), rng.RandDouble(0.0, 2000)));
+    }
+  }
+
+  LeastSquaresLineEstimator line_estimator;
+  RansacParameters params;
+  params.error_thresh = 0.5;
+  params.min_iterations = 1;
+
+  Line line;
+  RansacSummary summary;
+  params.rng = std::make_shared<RandomNumberGenerator>(59);
+  Ransac<LeastSquaresLineEstimator> ransac_line(params, line_estimator);
+  ransac_line.Initialize();
+  EXPECT_TRUE(ransac_line.Estimate(input_points, &line, &summary));
+
+  Line lo_line;
+  RansacSummary lo_summary;
+  params.rng = std::make_shared<RandomNumberGenerator>(59);
+  params.use_lo = true;
+  params.lo_start_iterations = 0;
+  params.lo_type = LocalOptimizationType::INNER_RANSAC;
+  Ransac<LeastSquaresLineEstimator> lo_ransac_line(params, line_estimator);
+  lo_ransac_line.Initialize();
+  EXPECT_TRUE(lo_ransac_line.Estimate(input_points, &lo_line, &lo_summary));
+
+  // The locally optimized model has more support, so fewer iterations are
+  // needed.
+  EXPECT_LT(fabs(lo_line.m - 1.0), 0.01);
+  EXPECT_GT(lo_summary.num_lo_iterations, 0);
+  EXPECT_GE(lo_summary.inliers.size(), summary.inliers.size());
+  EXPECT_LT(lo_summary.num_iterations, summary.num_iterations);
+}
+
+TEST(RansacTest, ParallelHypothesesAreDeterministic) {
+  std::vector<Point> input_points;
+  for (int i = 0; i < 1000; ++i) {
+    if (i % 2 == 0) {
+      input_points.push_back(Point(i + rng.RandGaussian(0.0, 0.1),
+                                   i + rng.RandGaussian(0.0, 0.1)));
+    } else {
+      input_points.push_back(
+          Point(rng.RandDouble(0.0, 1000), rng.RandDouble(0.0, 1000)));
+    }
+  }
+
+  LineEstimator line_estimator;
+  RansacParameters params;
+  params.error_thresh = 0.5;
+  params.num_threads = 4;
+
+  Line lines[2];
+  RansacSummary summaries[2];
+  for (int i = 0; i < 2; i++) {
+    params.rng = std::make_shared<RandomNumberGenerator>(59);
+    Ransac<LineEstimator> ransac_line(params, line_estimator);
+    ransac_line.Initialize();
+    EXPECT_TRUE(ransac_line.Estimate(input_points, &lines[i], &summaries[i]));
+    EXPECT_LT(fabs(lines[i].m - 1.0), 0.1);
+    EXPECT_GE(summaries[i].inliers.size(), 250);
+  }
+
+  // The same seed gives the same result regardless of thread scheduling.
+  EXPECT_EQ(lines[0].m, lines[1].m);
+  EXPECT_EQ(lines[0].b, lines[1].b);
+  EXPECT_EQ(summaries[0].num_iterations, summaries[1].num_iterations);
+  EXPECT_EQ(summaries[0].inliers, summaries[1].inliers);
+}
+
+TEST(RansacTest, CollectStatistics) {
+  std::vector<Point> input_points;
+  for (int i = 0; i < 1000; ++i) {
+    if (i % 2 == 0) {
+      input_points.push_back(Point(i + rng.RandGaussian(0.0, 0.1),
+                                   i + rng.RandGaussian(0.0, 0.1)));
+    } else {
+      input_points.push_back(
+          Point(rng.RandDouble(0.0, 1000), rng.RandDouble(0.0, 1000)));
+    }
+  }
+
+  LeastSquaresLineEstimator line_estimator;
+  RansacParameters params;
+  params.rng = std::make_shared<RandomNumberGenerator>(61);
+  params.error_thresh = 0.5;
+  params.use_lo = true;
+  params.collect_statistics = true;
+
+  for (const int num_threads : {1, 4}) {
+    params.num_threads = num_threads;
+    Ransac<LeastSquaresLineEstimator> ransac_line(params, line_estimator);
+    ransac_line.Initialize();
+    Line line;
+    RansacSummary summary;
+    EXPECT_TRUE(ransac_line.Estimate(input_points, &line, &summary));
+
+    // The line estimator returns one model for every sample.
+    const RansacStatistics& statistics = summary.statistics;
+    EXPECT_EQ(statistics.num_estimations, 1);
+    EXPECT_EQ(statistics.num_samples, summary.num_iterations);
+    EXPECT_EQ(statistics.num_degenerate_samples, 0);
+    EXPECT_EQ(statistics.num_models, summary.num_iterations);
+    EXPECT_EQ(statistics.SolutionsPerSample(), 1.0);
+    EXPECT_GT(statistics.solver_time + statistics.scoring_time, 0.0);
+    EXPECT_GE(statistics.lo_time, 0.0);
+
+    // About half of the points are inliers.
+    std::vector<int> expected_histogram(RansacStatistics::kNumInlierRatioBins);
+    const double inlier_ratio =
+        static_cast<double>(summary.inliers.size()) / input_points.size();
+    expected_histogram[static_cast<int>(
+        inlier_ratio * RansacStatistics::kNumInlierRatioBins)] = 1;
+    EXPECT_EQ(statistics.inlier_ratio_histogram, expected_histogram);
+
+    RansacStatistics merged;
+    merged.Merge(statistics);
+    merged.Merge(statistics);
+    EXPECT_EQ(merged.num_estimations, 2);
+    EXPECT_EQ(merged.num_samples, 2 * statistics.num_samples);
+    EXPECT_EQ(merged.inlier_ratio_histogram[static_cast<int>(
+                  inlier_ratio * RansacStatistics::kNumInlierRatioBins)],
+              2);
+  }
+}
+
 }  // namespace theia
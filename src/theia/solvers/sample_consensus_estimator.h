@@ -36,6 +36,7 @@
 #define THEIA_SOLVERS_SAMPLE_CONSENSUS_ESTIMATOR_H_
 
 #include <algorithm>
+#include <array>
 #include <cmath>
 #include <glog/logging.h>
 #include <limits>
@@ -46,10 +47,24 @@
 #include "theia/solvers/inlier_support.h"
 #include "theia/solvers/mle_quality_measurement.h"
 #include "theia/solvers/quality_measurement.h"
+#include "theia/solvers/ransac_statistics.h"
 #include "theia/solvers/sampler.h"
+#include "theia/util/random.h"
+#include "theia/util/threadpool.h"
 
 namespace theia {
 
+// The local optimization performed on a new best model when use_lo is set.
+enum class LocalOptimizationType {
+  // Refines the model on its inliers with Estimator::RefineModel.
+  REFINE_MODEL = 0,
+  // LO-RANSAC as in Lebeda et al., "Fixing the Locally Optimized RANSAC", BMVC
+  // 2012. Non-minimal models are estimated from random subsets of the inliers
+  // and refined by iterative least squares with a shrinking threshold. The
+  // tighter inlier support lets the adaptive iteration bound terminate sooner.
+  INNER_RANSAC = 1
+};
+
 // Helper struct to hold parameters to various RANSAC schemes. error_thresh is
 // the threshold for consider data points to be inliers to a model. This is the
 // only variable that must be explitly set, and the rest can be used with the
@@ -64,7 +79,17 @@ struct RansacParameters {
         use_mle(false),
         use_Tdd_test(false),
         use_lo(false),
-        lo_start_iterations(50) {}
+        lo_start_iterations(50),
+        lo_type(LocalOptimizationType::REFINE_MODEL),
+        lo_num_inner_iterations(10),
+        lo_num_least_squares_iterations(4),
+        lo_threshold_multiplier(3.0),
+        num_threads(1),
+        preemptive_num_hypotheses(500),
+        preemptive_block_size(100),
+        lmed_approximate_median(false),
+        exhaustive_sample_by_quality(false),
+        collect_statistics(false) {}
 
   // The random number generator used to compute random number during
   // RANSAC. This may be controlled by the caller for debugging purposes.
@@ -112,6 +137,17 @@ struct RansacParameters {
   // rather after ransac has performed some sifting already
   int lo_start_iterations;
 
+  // The type of local optimization. For INNER_RANSAC, lo_num_inner_iterations
+  // non-minimal samples of the inliers are drawn, and each resulting model is
+  // refined by lo_num_least_squares_iterations least squares fits to the data
+  // within a threshold that shrinks from lo_threshold_multiplier *
+  // error_thresh to error_thresh. The inlier support of the locally optimized
+  // model is used for the iteration bound.
+  LocalOptimizationType lo_type;
+  int lo_num_inner_iterations;
+  int lo_num_least_squares_iterations;
+  double lo_threshold_multiplier;
+
   // Whether to use the T_{d,d}, with d=1, test proposed in
   // Chum, O. and Matas, J.: Randomized RANSAC and T(d,d) test, BMVC 2002.
   // After computing the pose, RANSAC selects one match at random and evaluates
@@ -122,6 +158,37 @@ struct RansacParameters {
   //
   // NOTE: Not currently implemented!
   bool use_Tdd_test;
+
+  // The number of threads used to generate and score the hypotheses of a
+  // single problem. Every thread draws its samples from its own random stream
+  // and the threads share the best model and the iteration bound after each
+  // round of hypotheses, so for a seeded rng the result only depends on the
+  // seed and num_threads. Exhaustive sampling splits the enumeration of the
+  // samples between the threads instead.
+  int num_threads;
+
+  // The number of hypotheses generated up front and the number of data points
+  // in each block of preemptive scoring. Only used by PreemptiveRansac. The
+  // defaults are the values suggested by Nister.
+  int preemptive_num_hypotheses;
+  int preemptive_block_size;
+
+  // If true, hypotheses are scored with a median of the squared residuals
+  // interpolated from a histogram instead of an exact selection. Only used by
+  // LMed.
+  bool lmed_approximate_median;
+
+  // If true, ExhaustiveRansac enumerates all samples of the first m data points
+  // before any sample that contains data point m, so that the samples of the
+  // highest ranked data are tried first if the data is sorted by quality (as
+  // for PROSAC). Otherwise the samples are enumerated in lexicographic order.
+  bool exhaustive_sample_by_quality;
+
+  // If true, the time spent in each stage of the estimation and the inlier
+  // ratio of the final model are recorded in RansacSummary::statistics.
+  // Disabled by default since timing every sample is not free for fast
+  // minimal solvers.
+  bool collect_statistics;
 };
 
 // A struct to hold useful outputs of Ransac-like methods.
@@ -140,6 +207,16 @@ struct RansacSummary {
 
   // Number of local optimization iterations
   int num_lo_iterations = 0;
+
+  // The wall clock time in seconds spent generating the hypotheses, scoring
+  // them and computing and refining the final model. Only set by
+  // PreemptiveRansac.
+  double hypothesis_generation_time = 0.0;
+  double hypothesis_scoring_time = 0.0;
+  double refinement_time = 0.0;
+
+  // Per-stage instrumentation of the estimation. See RansacStatistics.
+  RansacStatistics statistics;
 };
 
 template <class ModelEstimator>
@@ -177,20 +254,109 @@ class SampleConsensusEstimator {
   //   particular type of sampling consensus.
   bool Initialize(Sampler* sampler);
 
+  // Returns a new sampler of the type passed to Initialize that draws from
+  // rng, or nullptr if the sampling strategy cannot be split into independent
+  // streams. Each thread gets its own sampler and random stream when
+  // ransac_params.num_threads > 1.
+  virtual Sampler* CreateSampler(
+      const std::shared_ptr<RandomNumberGenerator>& rng) const {
+    return nullptr;
+  }
+
+  // Returns the sampler of a thread when the hypotheses are generated by
+  // num_threads threads, or nullptr if the sampling cannot be split. By
+  // default every thread gets a sampler of CreateSampler that draws from its
+  // own random stream.
+  virtual Sampler* CreateThreadSampler(
+      const std::shared_ptr<RandomNumberGenerator>& rng,
+      const int thread_index,
+      const int num_threads) const {
+    return CreateSampler(rng);
+  }
+
+  // Computes the residuals of the model and returns its cost, which only needs
+  // to be exact if it is lower than max_cost (see
+  // QualityMeasurement::ComputeBoundedCost). The inliers are only valid in
+  // that case. Must be thread safe.
+  virtual double ScoreModel(const std::vector<Datum>& data,
+                            const Model& model,
+                            const double max_cost,
+                            std::vector<double>* residuals,
+                            std::vector<int>* inliers) const {
+    estimator_.Residuals(data, model, residuals);
+    inliers->clear();
+    return quality_measurement_->ComputeBoundedCost(
+        *residuals, max_cost, inliers);
+  }
+
   // Computes the maximum number of iterations required to ensure the inlier
   // ratio is the best with a probability corresponding to log_failure_prob.
   int ComputeMaxIterations(const double min_sample_size,
                            const double inlier_ratio,
                            const double log_failure_prob) const;
 
+  // Draws a sample with the sampler and copies the sampled data into
+  // data_subset. The indices of estimators with a fixed sample size are drawn
+  // into an array on the stack, otherwise into subset_indices.
+  bool SampleData(const std::vector<Datum>& data,
+                  Sampler* sampler,
+                  std::vector<int>* subset_indices,
+                  std::vector<Datum>* data_subset) const;
+
   // Get inlier datum points (for LO)
   void GetInlierDatum(const std::vector<Datum>& data,
                       std::vector<Datum>& inlier_datum, 
                       std::vector<int> inlier_indices);
 
+  // Generates and scores hypotheses in rounds with one sampler per thread,
+  // updating the best model and max_iterations after each round. Each sampler
+  // draws from its own stream split from rng_, so the result is deterministic
+  // for a seeded rng.
+  bool GenerateHypothesesInParallel(
+      const std::vector<Datum>& data,
+      const double log_failure_prob,
+      std::vector<std::unique_ptr<Sampler> >* samplers,
+      int* max_iterations,
+      double* best_cost,
+      Model* best_model,
+      RansacSummary* summary);
+
+  // Updates the best model if cost is lower than the best cost, running local
+  // optimization and lowering the maximum number of iterations as needed.
+  void UpdateBestModel(const std::vector<Datum>& data,
+                       const double log_failure_prob,
+                       const Model& model,
+                       const double cost,
+                       const std::vector<int>& inlier_indices,
+                       int* max_iterations,
+                       double* best_cost,
+                       Model* best_model,
+                       RansacSummary* summary);
+
+  // Runs the inner RANSAC of LO-RANSAC on the inliers of the model. Returns
+  // true and updates the model, its cost and its inliers if a model with a
+  // lower cost is found.
+  bool RunInnerRansac(const std::vector<Datum>& data,
+                      Model* model,
+                      double* cost,
+                      std::vector<int>* inlier_indices);
+
+  // Fits a non-minimal model to the data within a threshold that shrinks to
+  // error_thresh. Returns false if a fit fails.
+  bool IterativeLeastSquares(const std::vector<Datum>& data, Model* model);
+
   // The sampling strategy.
   std::unique_ptr<Sampler> sampler_;
 
+  // The random number generator of the parameters, or a new one if none was
+  // given.
+  std::shared_ptr<RandomNumberGenerator> rng_;
+
+  // The threads used for the hypotheses when ransac_params.num_threads > 1.
+  // The pool is created on the first parallel estimation.
+  std::unique_ptr<ThreadPool> thread_pool_;
+  int thread_pool_size_ = 0;
+
   // The quality metric for the estimated model and data.
   std::unique_ptr<QualityMeasurement> quality_measurement_;
 
@@ -214,12 +380,19 @@ SampleConsensusEstimator<ModelEstimator>::SampleConsensusEstimator(
   CHECK_LT(ransac_params.failure_probability, 1.0);
   CHECK_GT(ransac_params.failure_probability, 0.0);
   CHECK_GE(ransac_params.max_iterations, ransac_params.min_iterations);
+  if (FixedSampleSize<ModelEstimator>::value > 0) {
+    CHECK_EQ(estimator.SampleSize(), FixedSampleSize<ModelEstimator>::value);
+  }
 }
 
 template <class ModelEstimator>
 bool SampleConsensusEstimator<ModelEstimator>::Initialize(Sampler* sampler) {
   CHECK_NOTNULL(sampler);
   sampler_.reset(sampler);
+  rng_ = ransac_params_.rng;
+  if (rng_ == nullptr) {
+    rng_ = std::make_shared<RandomNumberGenerator>();
+  }
 
   if (ransac_params_.use_mle) {
     quality_measurement_.reset(
@@ -278,6 +451,8 @@ bool SampleConsensusEstimator<ModelEstimator>::Estimate(
   }
 
   summary->num_input_data_points = data.size();
+  summary->statistics = RansacStatistics();
+  summary->statistics.num_estimations = 1;
 
   const double log_failure_prob = log(ransac_params_.failure_probability);
   double best_cost = std::numeric_limits<double>::max();
@@ -292,84 +467,106 @@ bool SampleConsensusEstimator<ModelEstimator>::Estimate(
                  ransac_params_.max_iterations);
   }
 
-  for (summary->num_iterations = 0; summary->num_iterations < max_iterations;
+  // Samplers that enumerate their samples stop after the last one.
+  max_iterations = static_cast<int>(std::min<double>(
+      max_iterations, sampler_->NumUniqueSamples()));
+
+  // Use one sampler per thread if the hypotheses are generated in parallel.
+  // Each sampler owns a random stream split from rng_, so the samples of a
+  // thread do not depend on which worker runs it.
+  std::vector<std::unique_ptr<Sampler> > samplers;
+  if (ransac_params_.num_threads > 1) {
+    for (int i = 0; i < ransac_params_.num_threads; i++) {
+      Sampler* sampler =
+          CreateThreadSampler(rng_->Split(i), i, ransac_params_.num_threads);
+      if (sampler == nullptr) {
+        samplers.clear();
+        break;
+      }
+      samplers.emplace_back(sampler);
+    }
+  }
+
+  summary->num_iterations = 0;
+  if (!samplers.empty()) {
+    if (!GenerateHypothesesInParallel(data,
+                                      log_failure_prob,
+                                      &samplers,
+                                      &max_iterations,
+                                      &best_cost,
+                                      best_model,
+                                      summary)) {
+      return false;
+    }
+  }
+
+  // The residuals, samples and models buffers are shared by all iterations so
+  // that they are only allocated once. In the parallel mode all iterations
+  // have already been performed.
+  std::vector<double> residuals;
+  std::vector<int> data_subset_indices;
+  std::vector<Datum> data_subset;
+  std::vector<Model> temp_models;
+  std::vector<int> inlier_indices;
+  RansacStatistics* statistics = &summary->statistics;
+  RansacStatisticsTimer timer(ransac_params_.collect_statistics);
+  for (; summary->num_iterations < max_iterations;
        summary->num_iterations++) {
     // Sample subset. Proceed if successfully sampled.
-    std::vector<int> data_subset_indices;
-    if (!sampler_->Sample(&data_subset_indices)) {
+    timer.Reset();
+    ++statistics->num_samples;
+    if (!SampleData(
+            data, sampler_.get(), &data_subset_indices, &data_subset)) {
+      ++statistics->num_degenerate_samples;
+      timer.Lap(&statistics->sampling_time);
       continue;
     }
-
-    // Get the corresponding data elements for the subset.
-    std::vector<Datum> data_subset(data_subset_indices.size());
-    for (int i = 0; i < data_subset_indices.size(); i++) {
-      data_subset[i] = data[data_subset_indices[i]];
-    }
+    timer.Lap(&statistics->sampling_time);
 
     // Estimate model from subset. Skip to next iteration if the model fails to
     // estimate.
-    std::vector<Model> temp_models;
-    if (!estimator_.EstimateModel(data_subset, &temp_models)) {
+    temp_models.clear();
+    const bool estimated = estimator_.EstimateModel(data_subset, &temp_models);
+    timer.Lap(&statistics->solver_time);
+    if (!estimated || temp_models.empty()) {
+      ++statistics->num_degenerate_samples;
       continue;
     }
+    statistics->num_models += temp_models.size();
 
     // Calculate residuals from estimated model.
     for (const Model& temp_model : temp_models) {
-      const std::vector<double> residuals =
-          estimator_.Residuals(data, temp_model);
-
-      // Determine cost of the generated model.
-      std::vector<int> inlier_indices;
-      const double sample_cost =
-          quality_measurement_->ComputeCost(residuals, &inlier_indices);
-      const double inlier_ratio = static_cast<double>(inlier_indices.size()) /
-                                  static_cast<double>(data.size());
+      timer.Reset();
+      // Determine cost of the generated model. Models that are not better
+      // than the best model are rejected, so their cost may be bounded.
+      const double sample_cost = ScoreModel(
+          data, temp_model, best_cost, &residuals, &inlier_indices);
+      timer.Lap(&statistics->scoring_time);
 
       // Update best model if error is the best we have seen.
-      if (sample_cost < best_cost) {
-        *best_model = temp_model;
-        best_cost = sample_cost;
-
-        if (inlier_ratio <
-            estimator_.SampleSize() / static_cast<double>(data.size())) {
-          continue;
-        }
-
-
-        if (summary->num_iterations >= ransac_params_.lo_start_iterations &&
-            ransac_params_.use_lo) {
-          std::vector<Datum> inliers;
-          GetInlierDatum(data, inliers, inlier_indices);
-          if (!estimator_.RefineModel(inliers, best_model)) {
-            continue;
-          }
-          ++summary->num_lo_iterations;
-        }
-
-        // A better cost does not guarantee a higher inlier ratio (i.e, the MLE
-        // case) so we only update the max iterations if the number decreases.
-        max_iterations = std::min(
-            ComputeMaxIterations(
-                estimator_.SampleSize(), inlier_ratio, log_failure_prob),
-            max_iterations);
-
-        VLOG(3) << "Inlier ratio = " << inlier_ratio
-                << " and max number of iterations = " << max_iterations;
-      }
+      UpdateBestModel(data,
+                      log_failure_prob,
+                      temp_model,
+                      sample_cost,
+                      inlier_indices,
+                      &max_iterations,
+                      &best_cost,
+                      best_model,
+                      summary);
     }
-
   }
 
   // Compute the final inliers for the best model.
-  const std::vector<double> best_residuals =
-      estimator_.Residuals(data, *best_model);
-  quality_measurement_->ComputeCost(best_residuals, &summary->inliers);
+  estimator_.Residuals(data, *best_model, &residuals);
+  quality_measurement_->ComputeCost(residuals, &summary->inliers);
 
   if (ransac_params_.use_lo) {
+    timer.Reset();
     std::vector<Datum> inliers;
     GetInlierDatum(data, inliers, summary->inliers);
     estimator_.RefineModel(inliers, best_model);
     ++summary->num_lo_iterations;
+    timer.Lap(&statistics->lo_time);
   }
 
   const double inlier_ratio =
@@ -377,10 +574,330 @@ bool SampleConsensusEstimator<ModelEstimator>::Estimate(
   summary->confidence =
       1.0 - pow(1.0 - pow(inlier_ratio, estimator_.SampleSize()),
                 summary->num_iterations);
+  if (ransac_params_.collect_statistics) {
+    statistics->AddInlierRatio(inlier_ratio);
+  }
 
   return true;
 }
 
+template <class ModelEstimator>
+void SampleConsensusEstimator<ModelEstimator>::UpdateBestModel(
+    const std::vector<Datum>& data,
+    const double log_failure_prob,
+    const Model& model,
+    const double cost,
+    const std::vector<int>& inlier_indices,
+    int* max_iterations,
+    double* best_cost,
+    Model* best_model,
+    RansacSummary* summary) {
+  if (cost >= *best_cost) {
+    return;
+  }
+  *best_model = model;
+  *best_cost = cost;
+
+  double inlier_ratio = static_cast<double>(inlier_indices.size()) /
+                        static_cast<double>(data.size());
+  if (inlier_ratio <
+      estimator_.SampleSize() / static_cast<double>(data.size())) {
+    return;
+  }
+
+  if (summary->num_iterations >= ransac_params_.lo_start_iterations &&
+      ransac_params_.use_lo) {
+    RansacStatisticsTimer timer(ransac_params_.collect_statistics);
+    if (ransac_params_.lo_type == LocalOptimizationType::INNER_RANSAC) {
+      std::vector<int> lo_inlier_indices = inlier_indices;
+      if (RunInnerRansac(data, best_model, best_cost, &lo_inlier_indices)) {
+        inlier_ratio = static_cast<double>(lo_inlier_indices.size()) /
+                       static_cast<double>(data.size());
+      }
+      timer.Lap(&summary->statistics.lo_time);
+    } else {
+      std::vector<Datum> inliers;
+      GetInlierDatum(data, inliers, inlier_indices);
+      const bool refined = estimator_.RefineModel(inliers, best_model);
+      timer.Lap(&summary->statistics.lo_time);
+      if (!refined) {
+        return;
+      }
+    }
+    ++summary->num_lo_iterations;
+  }
+
+  // A better cost does not guarantee a higher inlier ratio (i.e, the MLE
+  // case) so we only update the max iterations if the number decreases.
+  *max_iterations = std::min(
+      ComputeMaxIterations(
+          estimator_.SampleSize(), inlier_ratio, log_failure_prob),
+      *max_iterations);
+
+  VLOG(3) << "Inlier ratio = " << inlier_ratio
+          << " and max number of iterations = " << *max_iterations;
+}
+
+template <class ModelEstimator>
+bool SampleConsensusEstimator<ModelEstimator>::RunInnerRansac(
+    const std::vector<Datum>& data,
+    Model* model,
+    double* cost,
+    std::vector<int>* inlier_indices) {
+  // The inner samples are larger than minimal but at most half of the inliers
+  // so that they differ from each other.
+  static const int kInnerSampleSizeMultiplier = 7;
+  const int min_sample_size = estimator_.SampleSize();
+  if (inlier_indices->size() <= min_sample_size) {
+    return false;
+  }
+
+  bool improved = false;
+  std::vector<int> sample_indices;
+  std::vector<Datum> inner_sample;
+  std::vector<Model> inner_models;
+  std::vector<double> residuals;
+  std::vector<int> inner_inlier_indices;
+  for (int i = 0; i < ransac_params_.lo_num_inner_iterations; i++) {
+    // Sample from the inliers of the best model found so far.
+    const int sample_size = std::max(
+        min_sample_size,
+        std::min<int>(kInnerSampleSizeMultiplier * min_sample_size,
+                      inlier_indices->size() / 2));
+    sample_indices = *inlier_indices;
+    inner_sample.resize(sample_size);
+    for (int j = 0; j < sample_size; j++) {
+      std::swap(sample_indices[j],
+                sample_indices[rng_->RandInt(j, sample_indices.size() - 1)]);
+      inner_sample[j] = data[sample_indices[j]];
+    }
+
+    inner_models.clear();
+    if (!estimator_.EstimateModelNonminimal(inner_sample, &inner_models)) {
+      continue;
+    }
+
+    for (Model& inner_model : inner_models) {
+      if (!IterativeLeastSquares(data, &inner_model)) {
+        continue;
+      }
+
+      estimator_.Residuals(data, inner_model, &residuals);
+      inner_inlier_indices.clear();
+      const double inner_cost =
+          quality_measurement_->ComputeCost(residuals, &inner_inlier_indices);
+      if (inner_cost < *cost) {
+        *model = inner_model;
+        *cost = inner_cost;
+        std::swap(*inlier_indices, inner_inlier_indices);
+        improved = true;
+      }
+    }
+  }
+  return improved;
+}
+
+template <class ModelEstimator>
+bool SampleConsensusEstimator<ModelEstimator>::IterativeLeastSquares(
+    const std::vector<Datum>& data, Model* model) {
+  const int num_iterations = ransac_params_.lo_num_least_squares_iterations;
+  const double threshold_step =
+      num_iterations > 1 ? (ransac_params_.lo_threshold_multiplier - 1.0) /
+                               (num_iterations - 1)
+                         : 0.0;
+
+  std::vector<double> residuals;
+  std::vector<Datum> inliers;
+  std::vector<Model> models;
+  for (int i = 0; i < num_iterations; i++) {
+    const double threshold =
+        ransac_params_.error_thresh *
+        (ransac_params_.lo_threshold_multiplier - i * threshold_step);
+    estimator_.Residuals(data, *model, &residuals);
+    inliers.clear();
+    for (int j = 0; j < residuals.size(); j++) {
+      if (residuals[j] < threshold) {
+        inliers.emplace_back(data[j]);
+      }
+    }
+    if (inliers.size() <= estimator_.SampleSize()) {
+      return false;
+    }
+
+    // Keep the fit with the most data within the threshold if the solver
+    // returns several models.
+    models.clear();
+    if (!estimator_.EstimateModelNonminimal(inliers, &models) ||
+        models.empty()) {
+      return false;
+    }
+    int best_num_inliers = -1;
+    for (const Model& candidate : models) {
+      estimator_.Residuals(data, candidate, &residuals);
+      const int num_inliers =
+          std::count_if(residuals.begin(),
+                        residuals.end(),
+                        [threshold](const double r) { return r < threshold; });
+      if (num_inliers > best_num_inliers) {
+        *model = candidate;
+        best_num_inliers = num_inliers;
+      }
+    }
+  }
+  return true;
+}
+
+template <class ModelEstimator>
+bool SampleConsensusEstimator<ModelEstimator>::GenerateHypothesesInParallel(
+    const std::vector<Datum>& data,
+    const double log_failure_prob,
+    std::vector<std::unique_ptr<Sampler> >* samplers,
+    int* max_iterations,
+    double* best_cost,
+    Model* best_model,
+    RansacSummary* summary) {
+  // Each thread generates this many hypotheses per round. Rounds are short so
+  // that the iteration bound found by one thread quickly stops the others.
+  static const int kNumHypothesesPerThread = 16;
+  const int num_threads = samplers->size();
+  for (const std::unique_ptr<Sampler>& sampler : *samplers) {
+    if (!sampler->Initialize(data.size())) {
+      return false;
+    }
+  }
+  if (thread_pool_ == nullptr || thread_pool_size_ != num_threads) {
+    thread_pool_.reset(new ThreadPool(num_threads));
+    thread_pool_size_ = num_threads;
+  }
+
+  // The state of each thread. Only the best hypothesis of the round is kept.
+  struct ThreadState {
+    int num_hypotheses;
+    std::vector<int> data_subset_indices;
+    std::vector<Datum> data_subset;
+    std::vector<Model> models;
+    std::vector<double> residuals;
+    std::vector<int> inlier_indices;
+    double best_cost;
+    std::vector<int> best_inlier_indices;
+    RansacStatistics statistics;
+  };
+  std::vector<ThreadState> states(num_threads);
+  std::vector<Model> round_best_models(num_threads);
+
+  const auto generate_hypotheses = [&](const int start, const int end) {
+    for (int t = start; t < end; t++) {
+      ThreadState& state = states[t];
+      RansacStatistics* statistics = &state.statistics;
+      RansacStatisticsTimer timer(ransac_params_.collect_statistics);
+      for (int i = 0; i < state.num_hypotheses; i++) {
+        timer.Reset();
+        ++statistics->num_samples;
+        if (!SampleData(data,
+                        (*samplers)[t].get(),
+                        &state.data_subset_indices,
+                        &state.data_subset)) {
+          ++statistics->num_degenerate_samples;
+          timer.Lap(&statistics->sampling_time);
+          continue;
+        }
+        timer.Lap(&statistics->sampling_time);
+
+        state.models.clear();
+        const bool estimated =
+            estimator_.EstimateModel(state.data_subset, &state.models);
+        timer.Lap(&statistics->solver_time);
+        if (!estimated || state.models.empty()) {
+          ++statistics->num_degenerate_samples;
+          continue;
+        }
+        statistics->num_models += state.models.size();
+
+        for (const Model& model : state.models) {
+          timer.Reset();
+          const double cost = ScoreModel(data,
+                                         model,
+                                         state.best_cost,
+                                         &state.residuals,
+                                         &state.inlier_indices);
+          timer.Lap(&statistics->scoring_time);
+          if (cost < state.best_cost) {
+            round_best_models[t] = model;
+            state.best_cost = cost;
+            std::swap(state.inlier_indices, state.best_inlier_indices);
+          }
+        }
+      }
+    }
+  };
+
+  while (summary->num_iterations < *max_iterations) {
+    const int num_hypotheses =
+        std::min(num_threads * kNumHypothesesPerThread,
+                 *max_iterations - summary->num_iterations);
+    for (int t = 0; t < num_threads; t++) {
+      states[t].num_hypotheses =
+          num_hypotheses / num_threads + (t < num_hypotheses % num_threads);
+      states[t].best_cost = *best_cost;
+    }
+
+    ParallelFor(
+        thread_pool_.get(), num_threads, num_threads, generate_hypotheses);
+    summary->num_iterations += num_hypotheses;
+
+    // Merge the rounds in thread order so that ties are resolved the same way
+    // in every run.
+    for (int t = 0; t < num_threads; t++) {
+      if (states[t].best_cost < *best_cost) {
+        UpdateBestModel(data,
+                        log_failure_prob,
+                        round_best_models[t],
+                        states[t].best_cost,
+                        states[t].best_inlier_indices,
+                        max_iterations,
+                        best_cost,
+                        best_model,
+                        summary);
+      }
+    }
+  }
+
+  for (const ThreadState& state : states) {
+    summary->statistics.Merge(state.statistics);
+  }
+  return true;
+}
+
+template <class ModelEstimator>
+bool SampleConsensusEstimator<ModelEstimator>::SampleData(
+    const std::vector<Datum>& data,
+    Sampler* sampler,
+    std::vector<int>* subset_indices,
+    std::vector<Datum>* data_subset) const {
+  static const int kSampleSize = FixedSampleSize<ModelEstimator>::value;
+  if (kSampleSize > 0) {
+    std::array<int, kSampleSize> sample;
+    if (!sampler->SampleIndices(sample.data())) {
+      return false;
+    }
+    data_subset->resize(kSampleSize);
+    for (int i = 0; i < kSampleSize; i++) {
+      (*data_subset)[i] = data[sample[i]];
+    }
+    return true;
+  }
+
+  subset_indices->clear();
+  if (!sampler->Sample(subset_indices)) {
+    return false;
+  }
+  data_subset->resize(subset_indices->size());
+  for (int i = 0; i < subset_indices->size(); i++) {
+    (*data_subset)[i] = data[(*subset_indices)[i]];
+  }
+  return true;
+}
+
 template <class ModelEstimator>
 void SampleConsensusEstimator<ModelEstimator>::GetInlierDatum(
   const std::vector<Datum>& data,
@@ -35,6 +35,9 @@
 #ifndef THEIA_SOLVERS_SAMPLER_H_
 #define THEIA_SOLVERS_SAMPLER_H_
 
+#include <algorithm>
+#include <glog/logging.h>
+#include <limits>
 #include <memory>
 #include <vector>
 
@@ -65,9 +68,34 @@ class Sampler {
   // samples.
   virtual bool Sample(std::vector<int>* subset_indices) = 0;
 
+  // Returns the number of distinct samples that are drawn before the samples
+  // repeat, or infinity for random samplers. Sample consensus estimators do
+  // not draw more samples than this. Must be called after Initialize.
+  virtual double NumUniqueSamples() const {
+    return std::numeric_limits<double>::infinity();
+  }
+
+  // Fills subset_indices, which holds min_num_samples entries, with the
+  // samples. Sample consensus estimators use this for estimators with a
+  // compile-time sample size (see FixedSampleSize in estimator.h) so that the
+  // samples are kept on the stack. By default the samples of Sample are
+  // copied.
+  virtual bool SampleIndices(int* subset_indices) {
+    sample_buffer_.clear();
+    if (!Sample(&sample_buffer_)) {
+      return false;
+    }
+    CHECK_EQ(sample_buffer_.size(), min_num_samples_);
+    std::copy(sample_buffer_.begin(), sample_buffer_.end(), subset_indices);
+    return true;
+  }
+
  protected:
   std::shared_ptr<RandomNumberGenerator> rng_;
   int min_num_samples_;
+
+ private:
+  std::vector<int> sample_buffer_;
 };
 
 }  // namespace theia
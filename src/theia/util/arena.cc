@@ -0,0 +1,143 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#include "theia/util/arena.h"
+
+#include <glog/logging.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <algorithm>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <thread>  // NOLINT
+#include <unordered_map>
+
+namespace theia {
+
+Arena::Arena(const size_t min_block_size) : min_block_size_(min_block_size) {
+  CHECK_GT(min_block_size_, 0);
+}
+
+Arena::~Arena() {}
+
+ptrdiff_t Arena::AlignedOffset(const Block& block,
+                               const size_t offset,
+                               const size_t size,
+                               const size_t alignment) {
+  const uintptr_t address = reinterpret_cast<uintptr_t>(block.data.get());
+  const uintptr_t aligned_address =
+      (address + offset + alignment - 1) & ~(alignment - 1);
+  const size_t aligned_offset = aligned_address - address;
+  if (aligned_offset + size > block.size) {
+    return -1;
+  }
+  return aligned_offset;
+}
+
+void* Arena::Allocate(const size_t size, const size_t alignment) {
+  DCHECK_EQ(alignment & (alignment - 1), 0)
+      << "The alignment must be a power of two.";
+
+  if (!blocks_.empty()) {
+    const ptrdiff_t offset = AlignedOffset(
+        blocks_[position_.block], position_.offset, size, alignment);
+    if (offset >= 0) {
+      position_.offset = offset + size;
+      return blocks_[position_.block].data.get() + offset;
+    }
+  }
+
+  // Move to the next block, inserting a new block if the next block is too
+  // small. The blocks after the current block are unused so the new block may
+  // be inserted before them.
+  const int next_block = blocks_.empty() ? 0 : position_.block + 1;
+  if (next_block == blocks_.size() ||
+      AlignedOffset(blocks_[next_block], 0, size, alignment) < 0) {
+    // Grow geometrically so that the number of blocks stays small.
+    Block block;
+    block.size = std::max(size + alignment,
+                          std::max(min_block_size_, 2 * Capacity()));
+    block.data.reset(new char[block.size]);
+    blocks_.insert(blocks_.begin() + next_block, std::move(block));
+  }
+
+  position_.block = next_block;
+  const ptrdiff_t offset =
+      AlignedOffset(blocks_[next_block], 0, size, alignment);
+  position_.offset = offset + size;
+  return blocks_[next_block].data.get() + offset;
+}
+
+Arena::Position Arena::GetPosition() const { return position_; }
+
+void Arena::Rewind(const Position& position) {
+  CHECK_LE(position.block, position_.block);
+  position_ = position;
+}
+
+void Arena::Reset() { position_ = Position(); }
+
+void Arena::Release() {
+  blocks_.clear();
+  position_ = Position();
+}
+
+size_t Arena::Capacity() const {
+  size_t capacity = 0;
+  for (const Block& block : blocks_) {
+    capacity += block.size;
+  }
+  return capacity;
+}
+
+Arena* ThreadLocalArena() {
+#ifdef THEIA_HAS_THREAD_LOCAL_KEYWORD
+  thread_local Arena arena;
+  return &arena;
+#else
+  // The arenas are leaked so that they remain valid for threads that outlive
+  // the static destructors.
+  static std::mutex* mutex = new std::mutex();
+  static auto* arenas =
+      new std::unordered_map<std::thread::id, std::unique_ptr<Arena> >();
+  std::lock_guard<std::mutex> lock(*mutex);
+  std::unique_ptr<Arena>& arena = (*arenas)[std::this_thread::get_id()];
+  if (arena == nullptr) {
+    arena.reset(new Arena());
+  }
+  return arena.get();
+#endif  // THEIA_HAS_THREAD_LOCAL_KEYWORD
+}
+
+}  // namespace theia
@@ -0,0 +1,175 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#ifndef THEIA_UTIL_ARENA_H_
+#define THEIA_UTIL_ARENA_H_
+
+#include <stddef.h>
+#include <memory>
+#include <vector>
+
+#include "theia/util/util.h"
+
+namespace theia {
+
+// A monotonic memory arena for short-lived scratch buffers. Allocations bump a
+// pointer into the current block and are never freed individually; instead the
+// arena is rewound to an earlier position, which makes all memory allocated
+// since then available again. Blocks are kept when the arena is rewound, so
+// once an arena has grown to the size needed by e.g. matching one image pair,
+// matching later pairs does not allocate from the heap at all.
+//
+// Scratch containers use the arena through ArenaAllocator, and an ArenaScope
+// rewinds the arena when the work that used it is done:
+//
+//   bool MatchImagePair(...) {
+//     ArenaScope arena_scope(ThreadLocalArena());
+//     ArenaVector<IndexedFeatureMatch> temp_matches(
+//         num_descriptors, ArenaAllocator<IndexedFeatureMatch>(
+//                              arena_scope.arena()));
+//     ...
+//   }
+//
+// An arena is not thread-safe. ThreadLocalArena returns an arena for the
+// calling thread so that threads never contend on the allocator.
+class Arena {
+ public:
+  // A position in the arena that it can be rewound to.
+  struct Position {
+    int block = 0;
+    size_t offset = 0;
+  };
+
+  explicit Arena(const size_t min_block_size = kDefaultMinBlockSize);
+  ~Arena();
+
+  // Returns size bytes aligned to the alignment, which must be a power of two.
+  void* Allocate(const size_t size, const size_t alignment);
+
+  // Returns the current position. Rewinding to the position releases all
+  // memory allocated after it was taken.
+  Position GetPosition() const;
+  void Rewind(const Position& position);
+
+  // Releases all allocations but keeps the blocks for reuse.
+  void Reset();
+
+  // Releases all allocations and frees the blocks.
+  void Release();
+
+  // The number of bytes of the blocks owned by the arena.
+  size_t Capacity() const;
+
+ private:
+  static const size_t kDefaultMinBlockSize = 64 * 1024;
+
+  struct Block {
+    std::unique_ptr<char[]> data;
+    size_t size;
+  };
+
+  // Returns the aligned offset of an allocation in the block, or -1 if the
+  // allocation does not fit into the rest of the block.
+  static ptrdiff_t AlignedOffset(const Block& block,
+                                 const size_t offset,
+                                 const size_t size,
+                                 const size_t alignment);
+
+  const size_t min_block_size_;
+  std::vector<Block> blocks_;
+  Position position_;
+
+  DISALLOW_COPY_AND_ASSIGN(Arena);
+};
+
+// Returns the arena of the calling thread.
+Arena* ThreadLocalArena();
+
+// Rewinds the arena to its position at construction when the scope ends.
+// Scopes may be nested, and containers that use the arena must not outlive the
+// scope.
+class ArenaScope {
+ public:
+  explicit ArenaScope(Arena* arena)
+      : arena_(arena), position_(arena->GetPosition()) {}
+  ~ArenaScope() { arena_->Rewind(position_); }
+
+  Arena* arena() const { return arena_; }
+
+ private:
+  Arena* arena_;
+  const Arena::Position position_;
+
+  DISALLOW_COPY_AND_ASSIGN(ArenaScope);
+};
+
+// A standard allocator that allocates from an arena. Deallocation is a no-op
+// since the memory is released when the arena is rewound.
+template <class T>
+class ArenaAllocator {
+ public:
+  typedef T value_type;
+
+  explicit ArenaAllocator(Arena* arena) : arena_(arena) {}
+  template <class U>
+  ArenaAllocator(const ArenaAllocator<U>& other)  // NOLINT
+      : arena_(other.arena()) {}
+
+  T* allocate(const size_t n) {
+    return static_cast<T*>(arena_->Allocate(n * sizeof(T), alignof(T)));
+  }
+  void deallocate(T* pointer, const size_t n) {}
+
+  Arena* arena() const { return arena_; }
+
+ private:
+  Arena* arena_;
+};
+
+template <class T, class U>
+bool operator==(const ArenaAllocator<T>& lhs, const ArenaAllocator<U>& rhs) {
+  return lhs.arena() == rhs.arena();
+}
+
+template <class T, class U>
+bool operator!=(const ArenaAllocator<T>& lhs, const ArenaAllocator<U>& rhs) {
+  return !(lhs == rhs);
+}
+
+template <class T>
+using ArenaVector = std::vector<T, ArenaAllocator<T> >;
+
+}  // namespace theia
+
+#endif  // THEIA_UTIL_ARENA_H_
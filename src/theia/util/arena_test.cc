@@ -0,0 +1,120 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#include "theia/util/arena.h"
+
+#include <stdint.h>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace theia {
+
+TEST(Arena, AllocationsAreAligned) {
+  Arena arena(64);
+  for (const size_t alignment : {1, 2, 4, 8, 16, 32, 64}) {
+    arena.Allocate(3, 1);
+    const void* pointer = arena.Allocate(8, alignment);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(pointer) % alignment, 0);
+  }
+}
+
+TEST(Arena, AllocatesLargerThanBlockSize) {
+  Arena arena(16);
+  char* data = static_cast<char*>(arena.Allocate(1000, 8));
+  for (int i = 0; i < 1000; i++) {
+    data[i] = i;
+  }
+  EXPECT_GE(arena.Capacity(), 1000);
+}
+
+TEST(Arena, RewindReusesMemory) {
+  Arena arena(1024);
+  const Arena::Position start = arena.GetPosition();
+  const void* first = arena.Allocate(100, 8);
+  // Force a second block.
+  arena.Allocate(2000, 8);
+  const size_t capacity = arena.Capacity();
+
+  arena.Rewind(start);
+  EXPECT_EQ(arena.Allocate(100, 8), first);
+  arena.Allocate(2000, 8);
+  // No new blocks are needed after the arena is rewound.
+  EXPECT_EQ(arena.Capacity(), capacity);
+
+  arena.Reset();
+  EXPECT_EQ(arena.Allocate(100, 8), first);
+
+  arena.Release();
+  EXPECT_EQ(arena.Capacity(), 0);
+  EXPECT_NE(arena.Allocate(100, 8), nullptr);
+}
+
+TEST(ArenaScope, NestedScopesRewind) {
+  Arena arena;
+  ArenaScope outer_scope(&arena);
+  arena.Allocate(10, 1);
+  const Arena::Position outer_position = arena.GetPosition();
+  {
+    ArenaScope inner_scope(&arena);
+    arena.Allocate(100, 1);
+  }
+  EXPECT_EQ(arena.GetPosition().block, outer_position.block);
+  EXPECT_EQ(arena.GetPosition().offset, outer_position.offset);
+}
+
+TEST(ArenaAllocator, VectorsUseTheArena) {
+  Arena arena;
+  ArenaScope arena_scope(&arena);
+  ArenaVector<int> values{ArenaAllocator<int>(&arena)};
+  for (int i = 0; i < 10000; i++) {
+    values.emplace_back(i);
+  }
+  for (int i = 0; i < 10000; i++) {
+    EXPECT_EQ(values[i], i);
+  }
+  EXPECT_GE(arena.Capacity(), 10000 * sizeof(int));
+}
+
+TEST(ThreadLocalArena, ThreadsHaveDifferentArenas) {
+  Arena* main_arena = ThreadLocalArena();
+  EXPECT_EQ(ThreadLocalArena(), main_arena);
+  Arena* thread_arena = nullptr;
+  std::thread thread([&]() { thread_arena = ThreadLocalArena(); });
+  thread.join();
+  EXPECT_NE(thread_arena, main_arena);
+}
+
+}  // namespace theia
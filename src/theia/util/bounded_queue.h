@@ -0,0 +1,125 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#ifndef THEIA_UTIL_BOUNDED_QUEUE_H_
+#define THEIA_UTIL_BOUNDED_QUEUE_H_
+
+#include <glog/logging.h>
+
+#include <condition_variable>  // NOLINT
+#include <cstddef>
+#include <deque>
+#include <mutex>  // NOLINT
+#include <utility>
+
+#include "theia/util/util.h"
+
+namespace theia {
+
+// A thread-safe FIFO queue that holds at most a fixed number of elements. It
+// connects the stages of a producer/consumer pipeline: Push blocks while the
+// queue is full so that a slow consumer throttles its producers instead of
+// letting the queued elements grow without bound, and Pop blocks until an
+// element is available. Once the producers are done, Close wakes up all
+// waiting threads so that the consumers exit after draining the queue.
+template <class T>
+class BoundedQueue {
+ public:
+  explicit BoundedQueue(const size_t capacity)
+      : capacity_(capacity), closed_(false) {
+    CHECK_GT(capacity_, 0) << "The queue capacity must be greater than 0.";
+  }
+
+  // Waits until there is room in the queue and adds the element to its back.
+  // Returns false and drops the element if the queue was closed.
+  bool Push(T element) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    not_full_.wait(lock,
+                   [this]() { return closed_ || queue_.size() < capacity_; });
+    if (closed_) {
+      return false;
+    }
+    queue_.emplace_back(std::move(element));
+    lock.unlock();
+    not_empty_.notify_one();
+    return true;
+  }
+
+  // Waits until an element is available and moves it out of the front of the
+  // queue. Returns false once the queue is closed and empty.
+  bool Pop(T* element) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    not_empty_.wait(lock, [this]() { return closed_ || !queue_.empty(); });
+    if (queue_.empty()) {
+      return false;
+    }
+    *element = std::move(queue_.front());
+    queue_.pop_front();
+    lock.unlock();
+    not_full_.notify_one();
+    return true;
+  }
+
+  // Closes the queue. Further calls to Push fail and Pop returns the remaining
+  // elements before failing.
+  void Close() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      closed_ = true;
+    }
+    not_full_.notify_all();
+    not_empty_.notify_all();
+  }
+
+  size_t Size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return queue_.size();
+  }
+
+  size_t Capacity() const { return capacity_; }
+
+ private:
+  const size_t capacity_;
+  mutable std::mutex mutex_;
+  std::condition_variable not_full_;
+  std::condition_variable not_empty_;
+  std::deque<T> queue_;
+  bool closed_;
+
+  DISALLOW_COPY_AND_ASSIGN(BoundedQueue);
+};
+
+}  // namespace theia
+
+#endif  // THEIA_UTIL_BOUNDED_QUEUE_H_
@@ -0,0 +1,140 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#include <atomic>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "theia/util/bounded_queue.h"
+
+namespace theia {
+
+TEST(BoundedQueue, FirstInFirstOut) {
+  BoundedQueue<int> queue(3);
+  EXPECT_EQ(queue.Capacity(), 3);
+  EXPECT_TRUE(queue.Push(1));
+  EXPECT_TRUE(queue.Push(2));
+  EXPECT_TRUE(queue.Push(3));
+  EXPECT_EQ(queue.Size(), 3);
+
+  int element;
+  for (int i = 1; i <= 3; i++) {
+    EXPECT_TRUE(queue.Pop(&element));
+    EXPECT_EQ(element, i);
+  }
+  EXPECT_EQ(queue.Size(), 0);
+}
+
+TEST(BoundedQueue, CloseDrainsRemainingElements) {
+  BoundedQueue<int> queue(2);
+  EXPECT_TRUE(queue.Push(1));
+  queue.Close();
+  EXPECT_FALSE(queue.Push(2));
+
+  int element;
+  EXPECT_TRUE(queue.Pop(&element));
+  EXPECT_EQ(element, 1);
+  EXPECT_FALSE(queue.Pop(&element));
+}
+
+TEST(BoundedQueue, PushBlocksWhileFull) {
+  static const int kNumElements = 1000;
+  static const int kCapacity = 4;
+  BoundedQueue<int> queue(kCapacity);
+
+  std::atomic<int> max_size(0);
+  std::thread producer([&]() {
+    for (int i = 0; i < kNumElements; i++) {
+      EXPECT_TRUE(queue.Push(i));
+      const int size = queue.Size();
+      if (size > max_size) {
+        max_size = size;
+      }
+    }
+    queue.Close();
+  });
+
+  std::vector<int> elements;
+  int element;
+  while (queue.Pop(&element)) {
+    elements.emplace_back(element);
+  }
+  producer.join();
+
+  ASSERT_EQ(elements.size(), kNumElements);
+  for (int i = 0; i < kNumElements; i++) {
+    EXPECT_EQ(elements[i], i);
+  }
+  EXPECT_LE(max_size, kCapacity);
+}
+
+TEST(BoundedQueue, MultipleProducersAndConsumers) {
+  static const int kNumThreads = 4;
+  static const int kNumElementsPerProducer = 500;
+  BoundedQueue<int> queue(8);
+
+  std::atomic<int> sum(0);
+  std::vector<std::thread> consumers;
+  for (int i = 0; i < kNumThreads; i++) {
+    consumers.emplace_back([&]() {
+      int element;
+      while (queue.Pop(&element)) {
+        sum += element;
+      }
+    });
+  }
+
+  std::vector<std::thread> producers;
+  for (int i = 0; i < kNumThreads; i++) {
+    producers.emplace_back([&]() {
+      for (int j = 1; j <= kNumElementsPerProducer; j++) {
+        EXPECT_TRUE(queue.Push(j));
+      }
+    });
+  }
+  for (std::thread& producer : producers) {
+    producer.join();
+  }
+  queue.Close();
+  for (std::thread& consumer : consumers) {
+    consumer.join();
+  }
+
+  EXPECT_EQ(sum, kNumThreads * kNumElementsPerProducer *
+                     (kNumElementsPerProducer + 1) / 2);
+}
+
+}  // namespace theia
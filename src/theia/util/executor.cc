@@ -0,0 +1,457 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#include "theia/util/executor.h"
+
+#include <glog/logging.h>
+#include <stdint.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <condition_variable>  // NOLINT
+#include <functional>
+#include <iterator>
+#include <mutex>  // NOLINT
+#include <thread>  // NOLINT
+#include <utility>
+#include <vector>
+
+#include "theia/util/arena.h"
+#include "theia/util/numa.h"
+
+namespace theia {
+
+namespace {
+
+// The number of blocks per thread of ParallelFor and ParallelReduce. A few
+// blocks per thread let the threads balance blocks of uneven cost while keeping
+// the per-block overhead small.
+static const int kNumBlocksPerThread = 4;
+
+// A thread waiting for a task group checks for new tasks it can help with at
+// this interval.
+static const std::chrono::milliseconds kTaskGroupPollInterval(1);
+
+std::mutex global_executor_mutex;
+std::atomic<Executor*> global_executor(nullptr);
+int global_executor_num_threads = 0;
+
+// Assigns the workers to the NUMA nodes in contiguous ranges in proportion to
+// the number of CPUs of each node that the workers may run on. Returns -1 for
+// all workers if fewer than two nodes are usable.
+std::vector<int> AssignWorkersToNumaNodes(
+    const int num_threads, const std::vector<int>& allowed_cpus) {
+  const std::vector<NumaNode>& nodes = GetNumaNodes();
+  std::vector<int> num_cpus_of_node(nodes.size(), 0);
+  int num_cpus = 0;
+  int num_usable_nodes = 0;
+  for (int i = 0; i < nodes.size(); i++) {
+    for (const int cpu : nodes[i].cpus) {
+      if (std::binary_search(allowed_cpus.begin(), allowed_cpus.end(), cpu)) {
+        ++num_cpus_of_node[i];
+      }
+    }
+    num_cpus += num_cpus_of_node[i];
+    if (num_cpus_of_node[i] > 0) {
+      ++num_usable_nodes;
+    }
+  }
+  std::vector<int> worker_nodes(num_threads, -1);
+  if (num_usable_nodes < 2) {
+    return worker_nodes;
+  }
+
+  for (int i = 0; i < num_threads; i++) {
+    // The position of the worker among the CPUs of all nodes.
+    int cpu =
+        static_cast<int>(static_cast<int64_t>(i) * num_cpus / num_threads);
+    int node = 0;
+    while (cpu >= num_cpus_of_node[node]) {
+      cpu -= num_cpus_of_node[node];
+      ++node;
+    }
+    worker_nodes[i] = node;
+  }
+  return worker_nodes;
+}
+
+}  // namespace
+
+Executor::Executor(const int num_threads)
+    : num_threads_(num_threads),
+      num_queued_tasks_(0),
+      num_busy_threads_(0),
+      stop_(false),
+      num_numa_affinity_scopes_(0),
+      pinned_to_numa_nodes_(false),
+      numa_affinity_generation_(0) {
+  CHECK_GE(num_threads_, 1)
+      << "The number of threads specified to the Executor is insufficient.";
+  // The workers inherit the affinity of the calling thread.
+  if (GetCurrentThreadAffinity(&unpinned_cpus_)) {
+    worker_numa_nodes_ =
+        AssignWorkersToNumaNodes(num_threads_, unpinned_cpus_);
+  } else {
+    worker_numa_nodes_.assign(num_threads_, -1);
+  }
+  worker_queues_.reserve(num_threads_);
+  for (int i = 0; i < num_threads_; i++) {
+    worker_queues_.emplace_back(new TaskQueue);
+  }
+  workers_.reserve(num_threads_);
+  for (int i = 0; i < num_threads_; i++) {
+    workers_.emplace_back(&Executor::RunWorker, this, i);
+  }
+}
+
+Executor::~Executor() {
+  {
+    std::lock_guard<std::mutex> lock(sleep_mutex_);
+    stop_ = true;
+  }
+  sleep_condition_.notify_all();
+  for (std::thread& worker : workers_) {
+    worker.join();
+  }
+}
+
+Executor* Executor::Global() {
+  Executor* executor = global_executor.load(std::memory_order_acquire);
+  if (executor != nullptr) {
+    return executor;
+  }
+
+  std::lock_guard<std::mutex> lock(global_executor_mutex);
+  executor = global_executor.load(std::memory_order_relaxed);
+  if (executor == nullptr) {
+    const int num_hardware_threads =
+        static_cast<int>(std::thread::hardware_concurrency());
+    const int num_threads = global_executor_num_threads > 0
+                                ? global_executor_num_threads
+                                : std::max(1, num_hardware_threads);
+    // The global executor is never destroyed so that it may be used during
+    // static destruction.
+    executor = new Executor(num_threads);
+    global_executor.store(executor, std::memory_order_release);
+  }
+  return executor;
+}
+
+void Executor::SetGlobalNumThreads(const int num_threads) {
+  CHECK_GE(num_threads, 1);
+  std::lock_guard<std::mutex> lock(global_executor_mutex);
+  CHECK(global_executor.load(std::memory_order_relaxed) == nullptr)
+      << "The number of threads of the global executor must be set before it "
+         "is first used.";
+  global_executor_num_threads = num_threads;
+}
+
+int Executor::WorkerIndex() const {
+  const std::thread::id thread_id = std::this_thread::get_id();
+  // The threads are only added in the constructor, before any task can run.
+  for (int i = 0; i < num_threads_; i++) {
+    if (workers_[i].get_id() == thread_id) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+int Executor::CurrentNumaNode() const {
+  if (!pinned_to_numa_nodes_.load(std::memory_order_relaxed)) {
+    return -1;
+  }
+  const int worker_index = WorkerIndex();
+  return worker_index >= 0 ? worker_numa_nodes_[worker_index] : -1;
+}
+
+void Executor::AddNumaAffinityScope() {
+  std::lock_guard<std::mutex> lock(numa_mutex_);
+  if (num_numa_affinity_scopes_++ > 0 || worker_numa_nodes_[0] < 0) {
+    return;
+  }
+  const std::vector<NumaNode>& nodes = GetNumaNodes();
+  for (int i = 0; i < num_threads_; i++) {
+    // Only the CPUs of the node that the worker was allowed to run on.
+    std::vector<int> cpus;
+    std::set_intersection(nodes[worker_numa_nodes_[i]].cpus.begin(),
+                          nodes[worker_numa_nodes_[i]].cpus.end(),
+                          unpinned_cpus_.begin(),
+                          unpinned_cpus_.end(),
+                          std::back_inserter(cpus));
+    if (!SetThreadAffinity(&workers_[i], cpus)) {
+      LOG(WARNING) << "Could not pin the worker threads to NUMA nodes.";
+      break;
+    }
+  }
+  pinned_to_numa_nodes_ = true;
+  ++numa_affinity_generation_;
+}
+
+void Executor::RemoveNumaAffinityScope() {
+  std::lock_guard<std::mutex> lock(numa_mutex_);
+  CHECK_GT(num_numa_affinity_scopes_, 0);
+  if (--num_numa_affinity_scopes_ > 0 || worker_numa_nodes_[0] < 0) {
+    return;
+  }
+  for (int i = 0; i < num_threads_; i++) {
+    SetThreadAffinity(&workers_[i], unpinned_cpus_);
+  }
+  pinned_to_numa_nodes_ = false;
+  ++numa_affinity_generation_;
+}
+
+void Executor::Schedule(std::function<void()> task) {
+  const int worker_index = WorkerIndex();
+  TaskQueue* queue = worker_index >= 0 ? worker_queues_[worker_index].get()
+                                       : &shared_queue_;
+  {
+    std::lock_guard<std::mutex> lock(queue->mutex);
+    queue->tasks.emplace_back(std::move(task));
+  }
+
+  // The count is updated under the sleep mutex so that a worker cannot miss the
+  // notification between checking the count and going to sleep.
+  {
+    std::lock_guard<std::mutex> lock(sleep_mutex_);
+    ++num_queued_tasks_;
+  }
+  sleep_condition_.notify_one();
+}
+
+bool Executor::PopTask(const int worker_index, std::function<void()>* task) {
+  const auto pop_front = [task](TaskQueue* queue) {
+    std::lock_guard<std::mutex> lock(queue->mutex);
+    if (queue->tasks.empty()) {
+      return false;
+    }
+    *task = std::move(queue->tasks.front());
+    queue->tasks.pop_front();
+    return true;
+  };
+
+  bool found_task = false;
+  // The newest task of our own queue is the most likely to use data that is
+  // still in the cache.
+  if (worker_index >= 0) {
+    TaskQueue* queue = worker_queues_[worker_index].get();
+    std::lock_guard<std::mutex> lock(queue->mutex);
+    if (!queue->tasks.empty()) {
+      *task = std::move(queue->tasks.back());
+      queue->tasks.pop_back();
+      found_task = true;
+    }
+  }
+
+  if (!found_task) {
+    found_task = pop_front(&shared_queue_);
+  }
+
+  // Steal the oldest task of another worker, which is usually the root of the
+  // largest amount of remaining work. Workers pinned to a NUMA node first try
+  // the workers of the same node, whose tasks likely use memory of the node.
+  const int first_victim = std::max(worker_index, 0);
+  const int numa_node =
+      worker_index >= 0 && pinned_to_numa_nodes_.load(std::memory_order_relaxed)
+          ? worker_numa_nodes_[worker_index]
+          : -1;
+  for (const bool same_node_only : {true, false}) {
+    if (same_node_only && numa_node < 0) {
+      continue;
+    }
+    for (int i = 0; i < num_threads_ && !found_task; i++) {
+      const int victim = (first_victim + i) % num_threads_;
+      if (victim != worker_index &&
+          (!same_node_only || worker_numa_nodes_[victim] == numa_node)) {
+        found_task = pop_front(worker_queues_[victim].get());
+      }
+    }
+  }
+
+  if (found_task) {
+    --num_queued_tasks_;
+  }
+  return found_task;
+}
+
+void Executor::RunTask(const std::function<void()>& task) {
+  num_busy_threads_.fetch_add(1, std::memory_order_relaxed);
+  task();
+  num_busy_threads_.fetch_sub(1, std::memory_order_relaxed);
+}
+
+bool Executor::RunPendingTask() {
+  std::function<void()> task;
+  if (!PopTask(WorkerIndex(), &task)) {
+    return false;
+  }
+  RunTask(task);
+  return true;
+}
+
+void Executor::RunWorker(const int worker_index) {
+  std::function<void()> task;
+  int numa_affinity_generation = 0;
+  while (true) {
+    // Once the worker is moved to another NUMA node, the blocks of its arena
+    // are freed so that the arena allocates them again on the new node. No
+    // task of the worker is running, so nothing is allocated from the arena.
+    const int current_generation = numa_affinity_generation_.load();
+    if (current_generation != numa_affinity_generation) {
+      numa_affinity_generation = current_generation;
+      ThreadLocalArena()->Release();
+    }
+
+    if (PopTask(worker_index, &task)) {
+      RunTask(task);
+      task = nullptr;
+      continue;
+    }
+
+    std::unique_lock<std::mutex> lock(sleep_mutex_);
+    sleep_condition_.wait(
+        lock, [this] { return stop_ || num_queued_tasks_.load() > 0; });
+    if (stop_ && num_queued_tasks_.load() <= 0) {
+      return;
+    }
+  }
+}
+
+ScopedNumaAffinity::ScopedNumaAffinity(const bool enabled)
+    : ScopedNumaAffinity(enabled, enabled ? Executor::Global() : nullptr) {}
+
+ScopedNumaAffinity::ScopedNumaAffinity(const bool enabled, Executor* executor)
+    : executor_(enabled ? CHECK_NOTNULL(executor) : nullptr) {
+  if (executor_ != nullptr) {
+    executor_->AddNumaAffinityScope();
+  }
+}
+
+ScopedNumaAffinity::~ScopedNumaAffinity() {
+  if (executor_ != nullptr) {
+    executor_->RemoveNumaAffinityScope();
+  }
+}
+
+TaskGroup::TaskGroup() : TaskGroup(Executor::Global()) {}
+
+TaskGroup::TaskGroup(Executor* executor)
+    : executor_(CHECK_NOTNULL(executor)), num_pending_tasks_(0) {}
+
+TaskGroup::~TaskGroup() { Wait(); }
+
+void TaskGroup::Run(std::function<void()> task) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ++num_pending_tasks_;
+  }
+  executor_->Schedule([this, task]() {
+    task();
+    // The count is decremented under the mutex so that Wait() cannot return,
+    // and the task group cannot be destroyed, before the mutex is released.
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (--num_pending_tasks_ == 0) {
+      condition_.notify_all();
+    }
+  });
+}
+
+void TaskGroup::Wait() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (num_pending_tasks_ > 0) {
+    // Help with the queued tasks rather than blocking a thread the remaining
+    // tasks of this group may be waiting for.
+    lock.unlock();
+    const bool ran_task = executor_->RunPendingTask();
+    lock.lock();
+    if (!ran_task) {
+      condition_.wait_for(lock, kTaskGroupPollInterval, [this] {
+        return num_pending_tasks_ == 0;
+      });
+    }
+  }
+}
+
+int AvailableNumThreads(const int num_threads) {
+  const int num_idle_threads = Executor::Global()->NumIdleThreads();
+  // The calling thread is always available to itself.
+  return std::max(1, std::min(num_threads, num_idle_threads + 1));
+}
+
+namespace internal {
+
+int NumParallelBlocks(const int num_threads, const int num_items) {
+  if (num_threads <= 1 || num_items <= 1) {
+    return 1;
+  }
+  return std::min(num_items, kNumBlocksPerThread * num_threads);
+}
+
+void ParallelBlockRange(const int num_items,
+                        const int num_blocks,
+                        const int block,
+                        int* start,
+                        int* end) {
+  *start =
+      static_cast<int>(static_cast<int64_t>(num_items) * block / num_blocks);
+  *end = static_cast<int>(static_cast<int64_t>(num_items) * (block + 1) /
+                          num_blocks);
+}
+
+void RunBlocksInParallel(const int num_threads,
+                         const int num_blocks,
+                         const std::function<void(const int)>& run_block) {
+  Executor* executor = Executor::Global();
+  std::atomic<int> next_block(0);
+  const auto run_blocks = [&]() {
+    for (int block = next_block++; block < num_blocks; block = next_block++) {
+      run_block(block);
+    }
+  };
+
+  // The calling thread runs blocks as well, so that the blocks are finished
+  // even if all the threads of the executor are busy.
+  const int num_helpers =
+      std::min(std::min(num_threads, num_blocks) - 1, executor->NumThreads());
+  TaskGroup task_group(executor);
+  for (int i = 0; i < num_helpers; i++) {
+    task_group.Run(run_blocks);
+  }
+  run_blocks();
+  task_group.Wait();
+}
+
+}  // namespace internal
+
+}  // namespace theia
@@ -0,0 +1,301 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#ifndef THEIA_UTIL_EXECUTOR_H_
+#define THEIA_UTIL_EXECUTOR_H_
+
+#include <atomic>
+#include <condition_variable>  // NOLINT
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "theia/util/util.h"
+
+namespace theia {
+
+// A process-wide pool of worker threads that is shared by all the parallel
+// stages of the library, so that threads are created once instead of for each
+// call and nested parallel stages do not multiply the number of threads.
+//
+// Each worker owns a deque of tasks. Tasks scheduled from a worker are pushed
+// onto its own deque and run last-in first-out, which keeps nested work on the
+// thread that created it. Tasks scheduled from other threads go to a shared
+// queue. A worker that runs out of tasks steals the oldest task from the other
+// workers. Most code should not use the executor directly but TaskGroup,
+// ParallelFor or ParallelReduce below.
+//
+// On machines with several NUMA nodes the workers may be pinned to the nodes
+// with a ScopedNumaAffinity. Idle workers then steal from the workers of their
+// own node first.
+class Executor {
+ public:
+  // All the threads are created upon construction.
+  explicit Executor(const int num_threads);
+  // Runs the remaining tasks and joins the threads.
+  ~Executor();
+
+  // The executor shared by the whole process. It has one thread per hardware
+  // thread unless SetGlobalNumThreads was called before its first use.
+  static Executor* Global();
+
+  // Sets the number of threads of the global executor. Must be called before
+  // the global executor is first used.
+  static void SetGlobalNumThreads(const int num_threads);
+
+  // Schedules the task to run on one of the worker threads.
+  void Schedule(std::function<void()> task);
+
+  // Runs one scheduled task on the calling thread if there is any. Returns
+  // false if no task was waiting. Threads that wait for tasks call this to help
+  // instead of blocking a thread that may be needed to finish the tasks.
+  bool RunPendingTask();
+
+  int NumThreads() const { return num_threads_; }
+
+  // The number of worker threads that are not running a task.
+  int NumIdleThreads() const {
+    return NumThreads() - num_busy_threads_.load(std::memory_order_relaxed);
+  }
+
+  // Returns true if the calling thread is a worker of this executor.
+  bool IsWorkerThread() const { return WorkerIndex() >= 0; }
+
+  // The index in GetNumaNodes() of the node that the calling worker is pinned
+  // to, or -1 if the calling thread is not a worker or the workers are not
+  // pinned to NUMA nodes.
+  int CurrentNumaNode() const;
+
+ private:
+  friend class ScopedNumaAffinity;
+
+  struct TaskQueue {
+    std::mutex mutex;
+    std::deque<std::function<void()> > tasks;
+  };
+
+  // The index of the calling thread among the workers, or -1.
+  int WorkerIndex() const;
+
+  // Pops a task from the queue of the worker, the shared queue or the queue of
+  // another worker, in that order. worker_index is -1 for other threads.
+  bool PopTask(const int worker_index, std::function<void()>* task);
+
+  // Runs the task and keeps track of the number of busy threads.
+  void RunTask(const std::function<void()>& task);
+
+  // The loop executed by each worker thread.
+  void RunWorker(const int worker_index);
+
+  // Pins the workers to their NUMA nodes while at least one ScopedNumaAffinity
+  // exists and restores their previous affinity afterwards.
+  void AddNumaAffinityScope();
+  void RemoveNumaAffinityScope();
+
+  const int num_threads_;
+  std::vector<std::thread> workers_;
+  std::vector<std::unique_ptr<TaskQueue> > worker_queues_;
+  TaskQueue shared_queue_;
+
+  // Workers sleep on the condition when there are no queued tasks.
+  std::mutex sleep_mutex_;
+  std::condition_variable sleep_condition_;
+  std::atomic<int> num_queued_tasks_;
+  std::atomic<int> num_busy_threads_;
+  bool stop_;
+
+  // The NUMA node of each worker, which is -1 for all workers if the machine
+  // has a single node, and the CPUs the workers may run on when unpinned.
+  std::vector<int> worker_numa_nodes_;
+  std::vector<int> unpinned_cpus_;
+  std::mutex numa_mutex_;
+  int num_numa_affinity_scopes_;
+  std::atomic<bool> pinned_to_numa_nodes_;
+  // Incremented whenever the workers are pinned or unpinned.
+  std::atomic<int> numa_affinity_generation_;
+
+  DISALLOW_COPY_AND_ASSIGN(Executor);
+};
+
+// Pins the workers of an executor to the NUMA nodes of the machine for the
+// lifetime of the object if enabled, so that the workers keep using the memory
+// of their node instead of fetching data allocated on another node. The workers
+// are split into contiguous ranges, one per node, in proportion to the number
+// of CPUs of the nodes, and each worker may run on any CPU of its node. Since
+// memory is allocated on the node of the thread that touches it first, the
+// data that a worker allocates, e.g. the features it reads and the blocks of
+// its ThreadLocalArena, stay on its node. Scopes may be nested or used from
+// several threads; the workers are unpinned when the last scope ends. This does
+// nothing on machines with a single NUMA node or if thread affinity is not
+// supported.
+class ScopedNumaAffinity {
+ public:
+  // Pins the workers of the global executor.
+  explicit ScopedNumaAffinity(const bool enabled);
+  ScopedNumaAffinity(const bool enabled, Executor* executor);
+  ~ScopedNumaAffinity();
+
+ private:
+  Executor* executor_;
+
+  DISALLOW_COPY_AND_ASSIGN(ScopedNumaAffinity);
+};
+
+// A set of tasks run on an executor that can be waited for together. Waiting
+// runs pending tasks on the calling thread, so task groups may be nested inside
+// the tasks of other task groups without deadlocking the executor.
+//
+// Example usage:
+//
+//   TaskGroup task_group;
+//   for (int i = 0; i < images.size(); i++) {
+//     task_group.Run([&, i]() { ProcessImage(images[i]); });
+//   }
+//   task_group.Wait();
+class TaskGroup {
+ public:
+  // Runs the tasks on the global executor.
+  TaskGroup();
+  explicit TaskGroup(Executor* executor);
+  // Waits for all tasks.
+  ~TaskGroup();
+
+  // Schedules the task to run on the executor.
+  void Run(std::function<void()> task);
+
+  // Blocks until all tasks that were run have finished.
+  void Wait();
+
+ private:
+  Executor* executor_;
+  std::mutex mutex_;
+  std::condition_variable condition_;
+  int num_pending_tasks_;
+
+  DISALLOW_COPY_AND_ASSIGN(TaskGroup);
+};
+
+// Returns the number of threads that a library with its own threads, such as
+// Ceres or OpenMP, should use when num_threads are requested. Threads of the
+// global executor that are busy running tasks are taken out of the budget, so
+// that a solver called from within a parallel stage does not oversubscribe the
+// machine. Always returns at least 1.
+int AvailableNumThreads(const int num_threads);
+
+namespace internal {
+
+// Calls run_block(i) for each block i in [0, num_blocks) using the calling
+// thread and up to num_threads - 1 threads of the global executor. Blocks are
+// handed out dynamically, so a busy executor only reduces the parallelism.
+void RunBlocksInParallel(const int num_threads,
+                         const int num_blocks,
+                         const std::function<void(const int)>& run_block);
+
+// The number of blocks the range [0, num_items) is split into, and the range
+// of a block.
+int NumParallelBlocks(const int num_threads, const int num_items);
+void ParallelBlockRange(const int num_items,
+                        const int num_blocks,
+                        const int block,
+                        int* start,
+                        int* end);
+
+}  // namespace internal
+
+// Splits the range [0, num_items) into contiguous blocks and calls
+// function(block_start, block_end) for each block using at most num_threads
+// threads of the global executor, including the calling thread. There are a
+// few blocks per thread so that uneven blocks are balanced. Returns once all
+// blocks are processed. If num_threads is 1 the whole range is processed on
+// the calling thread.
+template <class F>
+void ParallelFor(const int num_threads,
+                 const int num_items,
+                 const F& function) {
+  if (num_items <= 0) {
+    return;
+  }
+  const int num_blocks = internal::NumParallelBlocks(num_threads, num_items);
+  if (num_blocks == 1) {
+    function(0, num_items);
+    return;
+  }
+  internal::RunBlocksInParallel(
+      num_threads, num_blocks, [&](const int block) {
+        int start, end;
+        internal::ParallelBlockRange(
+            num_items, num_blocks, block, &start, &end);
+        function(start, end);
+      });
+}
+
+// Computes map(block_start, block_end) for the blocks of [0, num_items) as in
+// ParallelFor and combines the results with reduce(result1, result2), starting
+// from identity. The results are combined in the order of the blocks, so the
+// result is deterministic for a given number of threads even if reduce is not
+// associative, e.g. a floating point sum.
+template <typename T, class MapFunction, class ReduceFunction>
+T ParallelReduce(const int num_threads,
+                 const int num_items,
+                 const T& identity,
+                 const MapFunction& map,
+                 const ReduceFunction& reduce) {
+  if (num_items <= 0) {
+    return identity;
+  }
+  const int num_blocks = internal::NumParallelBlocks(num_threads, num_items);
+  if (num_blocks == 1) {
+    return reduce(identity, map(0, num_items));
+  }
+  std::vector<T> block_results(num_blocks, identity);
+  internal::RunBlocksInParallel(
+      num_threads, num_blocks, [&](const int block) {
+        int start, end;
+        internal::ParallelBlockRange(
+            num_items, num_blocks, block, &start, &end);
+        block_results[block] = map(start, end);
+      });
+  T result = identity;
+  for (const T& block_result : block_results) {
+    result = reduce(result, block_result);
+  }
+  return result;
+}
+
+}  // namespace theia
+
+#endif  // THEIA_UTIL_EXECUTOR_H_
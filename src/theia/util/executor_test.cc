@@ -0,0 +1,236 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#include <atomic>
+#include <mutex>  // NOLINT
+#include <set>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "theia/util/executor.h"
+#include "theia/util/numa.h"
+
+namespace theia {
+
+TEST(ExecutorTest, RunsScheduledTasks) {
+  static const int kNumTasks = 1000;
+  std::atomic<int> num_runs(0);
+  {
+    Executor executor(4);
+    EXPECT_EQ(executor.NumThreads(), 4);
+    EXPECT_FALSE(executor.IsWorkerThread());
+    for (int i = 0; i < kNumTasks; i++) {
+      executor.Schedule([&]() { ++num_runs; });
+    }
+  }
+  // The executor runs the remaining tasks when it is destroyed.
+  EXPECT_EQ(num_runs, kNumTasks);
+}
+
+TEST(ExecutorTest, RunsTasksWithNumaAffinity) {
+  static const int kNumTasks = 1000;
+  Executor executor(4);
+  std::atomic<int> num_runs(0);
+  std::atomic<int> num_invalid_nodes(0);
+  {
+    ScopedNumaAffinity numa_affinity(true, &executor);
+    // Scopes may be nested.
+    ScopedNumaAffinity nested_numa_affinity(true, &executor);
+    TaskGroup task_group(&executor);
+    for (int i = 0; i < kNumTasks; i++) {
+      task_group.Run([&]() {
+        const int node = executor.CurrentNumaNode();
+        if (node < -1 || node >= static_cast<int>(GetNumaNodes().size())) {
+          ++num_invalid_nodes;
+        }
+        ++num_runs;
+      });
+    }
+    task_group.Wait();
+  }
+  EXPECT_EQ(num_runs, kNumTasks);
+  EXPECT_EQ(num_invalid_nodes, 0);
+
+  // The workers are unpinned once the last scope ends.
+  std::atomic<int> num_pinned_tasks(0);
+  TaskGroup task_group(&executor);
+  for (int i = 0; i < kNumTasks; i++) {
+    task_group.Run([&]() {
+      if (executor.CurrentNumaNode() >= 0) {
+        ++num_pinned_tasks;
+      }
+    });
+  }
+  task_group.Wait();
+  EXPECT_EQ(num_pinned_tasks, 0);
+}
+
+TEST(TaskGroupTest, WaitsForAllTasks) {
+  static const int kNumTasks = 1000;
+  Executor executor(4);
+  std::vector<int> values(kNumTasks, 0);
+  TaskGroup task_group(&executor);
+  for (int i = 0; i < kNumTasks; i++) {
+    task_group.Run([&, i]() { values[i] = i; });
+  }
+  task_group.Wait();
+  for (int i = 0; i < kNumTasks; i++) {
+    EXPECT_EQ(values[i], i);
+  }
+}
+
+TEST(TaskGroupTest, NestedTaskGroupsDoNotDeadlock) {
+  // Every worker waits for a nested task group, which only finishes because
+  // waiting threads run the pending tasks themselves.
+  Executor executor(2);
+  std::atomic<int> num_runs(0);
+  TaskGroup outer_group(&executor);
+  for (int i = 0; i < 8; i++) {
+    outer_group.Run([&]() {
+      TaskGroup inner_group(&executor);
+      for (int j = 0; j < 8; j++) {
+        inner_group.Run([&]() { ++num_runs; });
+      }
+      inner_group.Wait();
+    });
+  }
+  outer_group.Wait();
+  EXPECT_EQ(num_runs, 64);
+}
+
+TEST(ParallelForTest, VisitsEachItemOnce) {
+  static const int kNumItems = 10007;
+  for (const int num_threads : {1, 2, 4, 16}) {
+    std::vector<std::atomic<int> > num_visits(kNumItems);
+    for (auto& num_visit : num_visits) {
+      num_visit = 0;
+    }
+    ParallelFor(num_threads, kNumItems, [&](const int start, const int end) {
+      EXPECT_LT(start, end);
+      for (int i = start; i < end; i++) {
+        ++num_visits[i];
+      }
+    });
+    for (int i = 0; i < kNumItems; i++) {
+      EXPECT_EQ(num_visits[i], 1);
+    }
+  }
+}
+
+TEST(ParallelForTest, UsesAtMostTheRequestedNumberOfThreads) {
+  static const int kNumThreads = 2;
+  std::mutex mutex;
+  std::set<std::thread::id> thread_ids;
+  ParallelFor(kNumThreads, 1000, [&](const int start, const int end) {
+    std::lock_guard<std::mutex> lock(mutex);
+    thread_ids.insert(std::this_thread::get_id());
+  });
+  EXPECT_LE(thread_ids.size(), kNumThreads);
+}
+
+TEST(ParallelForTest, Nested) {
+  static const int kNumItems = 64;
+  std::atomic<int> sum(0);
+  ParallelFor(4, kNumItems, [&](const int start, const int end) {
+    for (int i = start; i < end; i++) {
+      ParallelFor(4,
+                  kNumItems,
+                  [&](const int inner_start, const int inner_end) {
+                    sum += inner_end - inner_start;
+                  });
+    }
+  });
+  EXPECT_EQ(sum, kNumItems * kNumItems);
+}
+
+TEST(ParallelReduceTest, IsDeterministic) {
+  static const int kNumItems = 100000;
+  const auto sum_of_inverses = [](const int num_threads) {
+    return ParallelReduce(
+        num_threads,
+        kNumItems,
+        0.0,
+        [](const int start, const int end) {
+          double sum = 0.0;
+          for (int i = start; i < end; i++) {
+            sum += 1.0 / (i + 1);
+          }
+          return sum;
+        },
+        [](const double sum1, const double sum2) { return sum1 + sum2; });
+  };
+
+  const double sum = sum_of_inverses(4);
+  EXPECT_NEAR(sum, sum_of_inverses(1), 1e-9);
+  for (int i = 0; i < 10; i++) {
+    EXPECT_EQ(sum, sum_of_inverses(4));
+  }
+  const int empty_sum = ParallelReduce(
+      4,
+      0,
+      7,
+      [](const int start, const int end) { return 1; },
+      [](const int a, const int b) { return a + b; });
+  EXPECT_EQ(empty_sum, 7);
+}
+
+TEST(AvailableNumThreadsTest, IsAtLeastOne) {
+  EXPECT_GE(AvailableNumThreads(1), 1);
+  EXPECT_LE(AvailableNumThreads(2), 2);
+  EXPECT_EQ(AvailableNumThreads(1), 1);
+
+  // Within a parallel stage that occupies all threads of the global executor,
+  // nested solvers are left with the calling thread.
+  const int num_threads = Executor::Global()->NumThreads() + 1;
+  std::atomic<int> min_available_threads(num_threads);
+  std::atomic<int> num_started(0);
+  ParallelFor(num_threads, num_threads, [&](const int start, const int end) {
+    ++num_started;
+    // Wait until all threads are busy.
+    while (num_started < num_threads) {
+      std::this_thread::yield();
+    }
+    const int available_threads = AvailableNumThreads(num_threads);
+    int expected = min_available_threads.load();
+    while (available_threads < expected &&
+           !min_available_threads.compare_exchange_weak(expected,
+                                                        available_threads)) {
+    }
+  });
+  EXPECT_EQ(min_available_threads, 1);
+}
+
+}  // namespace theia
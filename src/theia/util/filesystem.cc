@@ -96,6 +96,16 @@ bool FileExists(const std::string& filename) {
   return stlplus::file_exists(filename);
 }
 
+bool GetFileSignature(const std::string& filepath, FileSignature* signature) {
+  CHECK_NOTNULL(signature);
+  if (!stlplus::file_exists(filepath)) {
+    return false;
+  }
+  signature->size = stlplus::file_size(filepath);
+  signature->modification_time = stlplus::file_modified(filepath);
+  return true;
+}
+
 // Returns true if the directory exists, false otherwise.
 bool DirectoryExists(const std::string& directory) {
   return stlplus::folder_exists(directory);
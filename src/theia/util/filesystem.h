@@ -35,11 +35,26 @@
 #ifndef THEIA_UTIL_FILESYSTEM_H_
 #define THEIA_UTIL_FILESYSTEM_H_
 
+#include <stdint.h>
 #include <string>
 #include <vector>
 
 namespace theia {
 
+// The size and last modification time of a file, which are used to detect
+// whether a file has changed without reading its contents.
+struct FileSignature {
+  uint64_t size = 0;
+  int64_t modification_time = 0;
+
+  bool operator==(const FileSignature& other) const {
+    return size == other.size && modification_time == other.modification_time;
+  }
+  bool operator!=(const FileSignature& other) const {
+    return !(*this == other);
+  }
+};
+
 // Gets the filepath of all files matching the input wildcard. Returns true if
 // the wildcard could be successfully evaluated and false otherwise (e.g. if the
 // folder does not exist).
@@ -60,6 +75,10 @@ bool GetDirectoryFromFilepath(const std::string& filepath,
 // Returns true if the file exists, false otherwise.
 bool FileExists(const std::string& filename);
 
+// Gets the size and modification time of the file. Returns false if the file
+// does not exist.
+bool GetFileSignature(const std::string& filepath, FileSignature* signature);
+
 // Returns true if the directory exists, false otherwise.
 bool DirectoryExists(const std::string& directory);
 
@@ -0,0 +1,127 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+
+#ifndef THEIA_UTIL_FIXED_CAPACITY_VECTOR_H_
+#define THEIA_UTIL_FIXED_CAPACITY_VECTOR_H_
+
+#include <Eigen/Core>
+#include <glog/logging.h>
+
+#include <utility>
+
+namespace theia {
+
+// A vector with a compile-time capacity whose elements are stored inline, so
+// it never allocates memory. This is meant for the solutions of minimal
+// solvers, which have a known maximum number of roots (e.g. up to 10 essential
+// matrices for the five point algorithm) and run millions of times in
+// RANSAC. Only the part of the std::vector interface that is needed by the
+// solvers and estimators is provided.
+//
+// All kCapacity elements are default constructed when the vector is created
+// and resizing only changes the size, so T must be default constructible and
+// cheap to construct (e.g. fixed-size Eigen types, which are left
+// uninitialized).
+template <typename T, int kCapacity>
+class FixedCapacityVector {
+ public:
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+  typedef T value_type;
+  typedef T* iterator;
+  typedef const T* const_iterator;
+
+  FixedCapacityVector() : size_(0) {}
+
+  static constexpr int capacity() { return kCapacity; }
+  int size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+
+  void clear() { size_ = 0; }
+
+  // Changes the size. Elements that become part of the vector keep whichever
+  // value they last had.
+  void resize(const int size) {
+    CHECK_GE(size, 0);
+    CHECK_LE(size, kCapacity) << "FixedCapacityVector capacity exceeded.";
+    size_ = size;
+  }
+
+  void push_back(const T& value) {
+    CHECK_LT(size_, kCapacity) << "FixedCapacityVector capacity exceeded.";
+    data_[size_++] = value;
+  }
+
+  template <typename... Args>
+  void emplace_back(Args&&... args) {
+    CHECK_LT(size_, kCapacity) << "FixedCapacityVector capacity exceeded.";
+    data_[size_++] = T(std::forward<Args>(args)...);
+  }
+
+  void pop_back() {
+    DCHECK_GT(size_, 0);
+    --size_;
+  }
+
+  T& operator[](const int i) {
+    DCHECK_LT(i, size_);
+    return data_[i];
+  }
+  const T& operator[](const int i) const {
+    DCHECK_LT(i, size_);
+    return data_[i];
+  }
+
+  T& front() { return (*this)[0]; }
+  const T& front() const { return (*this)[0]; }
+  T& back() { return (*this)[size_ - 1]; }
+  const T& back() const { return (*this)[size_ - 1]; }
+
+  T* data() { return data_; }
+  const T* data() const { return data_; }
+
+  iterator begin() { return data_; }
+  iterator end() { return data_ + size_; }
+  const_iterator begin() const { return data_; }
+  const_iterator end() const { return data_ + size_; }
+
+ private:
+  T data_[kCapacity];
+  int size_;
+};
+
+}  // namespace theia
+
+#endif  // THEIA_UTIL_FIXED_CAPACITY_VECTOR_H_
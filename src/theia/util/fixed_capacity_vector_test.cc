@@ -0,0 +1,84 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+
+#include "theia/util/fixed_capacity_vector.h"
+
+#include <Eigen/Core>
+#include "gtest/gtest.h"
+
+namespace theia {
+
+TEST(FixedCapacityVector, Empty) {
+  FixedCapacityVector<int, 4> vector;
+  EXPECT_EQ(vector.capacity(), 4);
+  EXPECT_EQ(vector.size(), 0);
+  EXPECT_TRUE(vector.empty());
+  EXPECT_EQ(vector.begin(), vector.end());
+}
+
+TEST(FixedCapacityVector, PushBackAndClear) {
+  FixedCapacityVector<int, 4> vector;
+  for (int i = 0; i < vector.capacity(); i++) {
+    vector.push_back(i);
+  }
+  EXPECT_EQ(vector.size(), 4);
+  EXPECT_EQ(vector.front(), 0);
+  EXPECT_EQ(vector.back(), 3);
+
+  int expected_value = 0;
+  for (const int value : vector) {
+    EXPECT_EQ(value, expected_value++);
+  }
+
+  vector.pop_back();
+  EXPECT_EQ(vector.size(), 3);
+  vector.clear();
+  EXPECT_TRUE(vector.empty());
+}
+
+TEST(FixedCapacityVector, EigenTypes) {
+  FixedCapacityVector<Eigen::Matrix3d, 10> matrices;
+  matrices.emplace_back(Eigen::Matrix3d::Identity());
+  matrices.emplace_back(2.0 * Eigen::Matrix3d::Identity());
+  EXPECT_EQ(matrices.size(), 2);
+  EXPECT_EQ(matrices[0], Eigen::Matrix3d::Identity());
+  EXPECT_EQ(matrices[1], 2.0 * Eigen::Matrix3d::Identity());
+
+  matrices.resize(1);
+  EXPECT_EQ(matrices.size(), 1);
+  EXPECT_EQ(matrices.back(), Eigen::Matrix3d::Identity());
+}
+
+}  // namespace theia
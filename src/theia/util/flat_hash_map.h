@@ -0,0 +1,243 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+#ifndef THEIA_UTIL_FLAT_HASH_MAP_H_
+#define THEIA_UTIL_FLAT_HASH_MAP_H_
+
+#include <Eigen/Core>
+#include <cereal/cereal.hpp>
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace theia {
+
+// A hash map from integer keys to values that stores the keys and values in
+// two dense vectors and finds them through an open addressing table of 32-bit
+// positions. Compared to std::unordered_map there is no heap node per entry,
+// so the memory overhead per entry is the key and a few bytes of table, and
+// iterating over the values is a linear scan. Erasing an entry moves the last
+// entry into its place, so pointers to values and the order of the entries are
+// only stable while no entries are erased.
+template <typename Key, typename Value>
+class FlatHashMap {
+  static_assert(std::is_integral<Key>::value,
+                "FlatHashMap keys must be integers.");
+
+ public:
+  typedef std::vector<Value, Eigen::aligned_allocator<Value> > ValueVector;
+
+  FlatHashMap() : table_shift_(64) {}
+
+  size_t size() const { return keys_.size(); }
+  bool empty() const { return keys_.empty(); }
+
+  void clear() {
+    keys_.clear();
+    values_.clear();
+    table_.clear();
+    table_shift_ = 64;
+  }
+
+  void reserve(const size_t size) {
+    keys_.reserve(size);
+    values_.reserve(size);
+    if (2 * size > table_.size()) {
+      Rehash(2 * size);
+    }
+  }
+
+  // The keys and values of the entries. The i-th value belongs to the i-th
+  // key.
+  const std::vector<Key>& keys() const { return keys_; }
+  const ValueVector& values() const { return values_; }
+
+  bool Contains(const Key key) const { return FindPosition(key) >= 0; }
+
+  // Returns the position of the key in keys() and values(), or -1 if the map
+  // does not contain it.
+  int64_t Position(const Key key) const { return FindPosition(key); }
+
+  // Returns the value of the key or nullptr if the map does not contain it.
+  const Value* Find(const Key key) const {
+    const int64_t position = FindPosition(key);
+    return position >= 0 ? &values_[position] : nullptr;
+  }
+  Value* Find(const Key key) {
+    const int64_t position = FindPosition(key);
+    return position >= 0 ? &values_[position] : nullptr;
+  }
+
+  // Sets the value of the key, inserting the key if it is not present.
+  void InsertOrAssign(const Key key, const Value& value) {
+    if (2 * (keys_.size() + 1) > table_.size()) {
+      Rehash(std::max<size_t>(16, 2 * table_.size()));
+    }
+    size_t i = Hash(key);
+    while (table_[i] != 0) {
+      if (keys_[table_[i] - 1] == key) {
+        values_[table_[i] - 1] = value;
+        return;
+      }
+      i = Next(i);
+    }
+    CHECK_LT(keys_.size(), std::numeric_limits<uint32_t>::max())
+        << "FlatHashMap capacity exceeded.";
+    keys_.emplace_back(key);
+    values_.emplace_back(value);
+    table_[i] = keys_.size();
+  }
+
+  // Erases the key. Returns false if the map does not contain it.
+  bool Erase(const Key key) {
+    if (table_.empty()) {
+      return false;
+    }
+    size_t i = Hash(key);
+    while (table_[i] != 0 && keys_[table_[i] - 1] != key) {
+      i = Next(i);
+    }
+    if (table_[i] == 0) {
+      return false;
+    }
+    const uint32_t position = table_[i] - 1;
+
+    // Remove the table entry by shifting the following entries of the probe
+    // sequence back, so that no tombstones are needed.
+    for (size_t j = Next(i); table_[j] != 0; j = Next(j)) {
+      const size_t home = Hash(keys_[table_[j] - 1]);
+      // Move the entry to the hole unless its home slot lies cyclically in
+      // (i, j].
+      const bool stays = (i < j) ? (i < home && home <= j)
+                                 : (i < home || home <= j);
+      if (!stays) {
+        table_[i] = table_[j];
+        i = j;
+      }
+    }
+    table_[i] = 0;
+
+    // Move the last entry into the erased position.
+    const uint32_t last = keys_.size() - 1;
+    if (position != last) {
+      size_t k = Hash(keys_[last]);
+      while (table_[k] != last + 1) {
+        k = Next(k);
+      }
+      table_[k] = position + 1;
+      keys_[position] = keys_[last];
+      values_[position] = std::move(values_[last]);
+    }
+    keys_.pop_back();
+    values_.pop_back();
+    return true;
+  }
+
+ private:
+  // Fibonacci hashing, which spreads consecutive keys over the table.
+  size_t Hash(const Key key) const {
+    return (static_cast<uint64_t>(key) * 0x9E3779B97F4A7C15ull) >>
+           table_shift_;
+  }
+
+  size_t Next(const size_t i) const { return (i + 1) & (table_.size() - 1); }
+
+  int64_t FindPosition(const Key key) const {
+    if (table_.empty()) {
+      return -1;
+    }
+    for (size_t i = Hash(key); table_[i] != 0; i = Next(i)) {
+      if (keys_[table_[i] - 1] == key) {
+        return table_[i] - 1;
+      }
+    }
+    return -1;
+  }
+
+  // Rebuilds the table with at least min_size slots.
+  void Rehash(const size_t min_size) {
+    int log_size = 4;
+    while ((size_t{1} << log_size) < min_size) {
+      ++log_size;
+    }
+    table_.assign(size_t{1} << log_size, 0);
+    table_shift_ = 64 - log_size;
+    for (uint32_t position = 0; position < keys_.size(); position++) {
+      size_t i = Hash(keys_[position]);
+      while (table_[i] != 0) {
+        i = Next(i);
+      }
+      table_[i] = position + 1;
+    }
+  }
+
+  std::vector<Key> keys_;
+  ValueVector values_;
+  // The position + 1 of the entry in each slot, or 0 if the slot is empty. The
+  // size is a power of two and at least twice the number of entries.
+  std::vector<uint32_t> table_;
+  int table_shift_;
+};
+
+// Cereal serialization in the same format as std::unordered_map so that
+// archives written with either container can be read with the other.
+template <class Archive, typename Key, typename Value>
+void save(Archive& ar, const FlatHashMap<Key, Value>& map) {  // NOLINT
+  ar(cereal::make_size_tag(static_cast<cereal::size_type>(map.size())));
+  for (size_t i = 0; i < map.size(); i++) {
+    ar(cereal::make_map_item(map.keys()[i], map.values()[i]));
+  }
+}
+
+template <class Archive, typename Key, typename Value>
+void load(Archive& ar, FlatHashMap<Key, Value>& map) {  // NOLINT
+  cereal::size_type size;
+  ar(cereal::make_size_tag(size));
+  map.clear();
+  map.reserve(size);
+  for (cereal::size_type i = 0; i < size; i++) {
+    Key key;
+    Value value;
+    ar(cereal::make_map_item(key, value));
+    map.InsertOrAssign(key, value);
+  }
+}
+
+}  // namespace theia
+
+#endif  // THEIA_UTIL_FLAT_HASH_MAP_H_
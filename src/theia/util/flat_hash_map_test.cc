@@ -0,0 +1,126 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+#include "theia/util/flat_hash_map.h"
+
+#include <cereal/archives/portable_binary.hpp>
+#include <cereal/types/unordered_map.hpp>
+
+#include <sstream>
+#include <unordered_map>
+#include "gtest/gtest.h"
+
+#include "theia/util/random.h"
+
+namespace theia {
+
+TEST(FlatHashMap, InsertFindAndErase) {
+  FlatHashMap<uint32_t, double> map;
+  EXPECT_TRUE(map.empty());
+  EXPECT_EQ(map.Find(3), nullptr);
+  EXPECT_FALSE(map.Erase(3));
+
+  map.InsertOrAssign(3, 1.0);
+  map.InsertOrAssign(4, 2.0);
+  map.InsertOrAssign(3, 3.0);
+  EXPECT_EQ(map.size(), 2);
+  EXPECT_EQ(*map.Find(3), 3.0);
+  EXPECT_EQ(*map.Find(4), 2.0);
+  EXPECT_TRUE(map.Contains(4));
+
+  EXPECT_TRUE(map.Erase(3));
+  EXPECT_FALSE(map.Contains(3));
+  EXPECT_EQ(*map.Find(4), 2.0);
+  EXPECT_EQ(map.keys().size(), 1);
+  EXPECT_EQ(map.values().size(), 1);
+}
+
+// Random insertions and removals give the same result as std::unordered_map.
+TEST(FlatHashMap, MatchesUnorderedMap) {
+  RandomNumberGenerator rng(53);
+  FlatHashMap<uint32_t, int> map;
+  std::unordered_map<uint32_t, int> expected;
+  for (int i = 0; i < 100000; i++) {
+    const uint32_t key = rng.RandInt(0, 2000);
+    if (rng.RandDouble(0.0, 1.0) < 0.6) {
+      map.InsertOrAssign(key, i);
+      expected[key] = i;
+    } else {
+      EXPECT_EQ(map.Erase(key), expected.erase(key) > 0);
+    }
+  }
+
+  ASSERT_EQ(map.size(), expected.size());
+  for (const auto& entry : expected) {
+    const int* value = map.Find(entry.first);
+    ASSERT_NE(value, nullptr);
+    EXPECT_EQ(*value, entry.second);
+  }
+  for (int i = 0; i < map.size(); i++) {
+    EXPECT_EQ(expected[map.keys()[i]], map.values()[i]);
+  }
+}
+
+TEST(FlatHashMap, SerializationMatchesUnorderedMap) {
+  FlatHashMap<uint32_t, int> map;
+  for (int i = 0; i < 100; i++) {
+    map.InsertOrAssign(3 * i, i);
+  }
+  std::stringstream stream;
+  {
+    cereal::PortableBinaryOutputArchive output_archive(stream);
+    output_archive(map);
+  }
+  std::unordered_map<uint32_t, int> unordered_map;
+  {
+    cereal::PortableBinaryInputArchive input_archive(stream);
+    input_archive(unordered_map);
+  }
+  EXPECT_EQ(unordered_map.size(), 100);
+  EXPECT_EQ(unordered_map[30], 10);
+
+  std::stringstream stream2;
+  {
+    cereal::PortableBinaryOutputArchive output_archive(stream2);
+    output_archive(unordered_map);
+  }
+  FlatHashMap<uint32_t, int> map2;
+  {
+    cereal::PortableBinaryInputArchive input_archive(stream2);
+    input_archive(map2);
+  }
+  EXPECT_EQ(map2.size(), 100);
+  EXPECT_EQ(*map2.Find(30), 10);
+}
+
+}  // namespace theia
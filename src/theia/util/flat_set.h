@@ -0,0 +1,143 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+#ifndef THEIA_UTIL_FLAT_SET_H_
+#define THEIA_UTIL_FLAT_SET_H_
+
+#include <cereal/cereal.hpp>
+
+#include <algorithm>
+#include <initializer_list>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace theia {
+
+// A set stored as a sorted vector. This uses a few bytes per element instead of
+// a heap node per element like std::unordered_set, and lookups are binary
+// searches over contiguous memory. Insertion and removal are linear in the size
+// of the set, so it is meant for small sets such as the views observing a
+// track. The part of the std::unordered_set interface used in the library is
+// provided, and the set converts to a std::unordered_set for code that needs
+// one.
+//
+// The elements are stored in a Container with the std::vector interface, e.g.
+// a SmallVector to avoid allocations for the smallest sets.
+template <typename T, typename Container = std::vector<T> >
+class FlatSet {
+ public:
+  typedef T value_type;
+  typedef typename Container::const_iterator iterator;
+  typedef typename Container::const_iterator const_iterator;
+
+  FlatSet() {}
+  FlatSet(std::initializer_list<T> values) {
+    for (const T& value : values) {
+      insert(value);
+    }
+  }
+
+  size_t size() const { return values_.size(); }
+  bool empty() const { return values_.empty(); }
+  void clear() { values_.clear(); }
+  void reserve(const size_t size) { values_.reserve(size); }
+
+  const_iterator begin() const { return values_.begin(); }
+  const_iterator end() const { return values_.end(); }
+
+  const_iterator find(const T& value) const {
+    const const_iterator it = std::lower_bound(begin(), end(), value);
+    return (it != end() && *it == value) ? it : end();
+  }
+
+  size_t count(const T& value) const { return find(value) != end() ? 1 : 0; }
+
+  std::pair<const_iterator, bool> insert(const T& value) {
+    const const_iterator it = std::lower_bound(begin(), end(), value);
+    if (it != end() && *it == value) {
+      return std::make_pair(it, false);
+    }
+    return std::make_pair(const_iterator(values_.insert(it, value)), true);
+  }
+
+  size_t erase(const T& value) {
+    const const_iterator it = std::lower_bound(begin(), end(), value);
+    if (it == end() || *it != value) {
+      return 0;
+    }
+    values_.erase(it);
+    return 1;
+  }
+
+  bool operator==(const FlatSet& other) const {
+    return values_ == other.values_;
+  }
+  bool operator!=(const FlatSet& other) const {
+    return values_ != other.values_;
+  }
+
+  operator std::unordered_set<T>() const {  // NOLINT
+    return std::unordered_set<T>(values_.begin(), values_.end());
+  }
+
+ private:
+  Container values_;
+};
+
+// Cereal serialization in the same format as std::unordered_set so that
+// archives written with either container can be read with the other.
+template <class Archive, typename T, typename Container>
+void save(Archive& ar, const FlatSet<T, Container>& set) {  // NOLINT
+  ar(cereal::make_size_tag(static_cast<cereal::size_type>(set.size())));
+  for (const T& value : set) {
+    ar(value);
+  }
+}
+
+template <class Archive, typename T, typename Container>
+void load(Archive& ar, FlatSet<T, Container>& set) {  // NOLINT
+  cereal::size_type size;
+  ar(cereal::make_size_tag(size));
+  set.clear();
+  set.reserve(size);
+  for (cereal::size_type i = 0; i < size; i++) {
+    T value;
+    ar(value);
+    set.insert(value);
+  }
+}
+
+}  // namespace theia
+
+#endif  // THEIA_UTIL_FLAT_SET_H_
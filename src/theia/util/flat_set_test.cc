@@ -0,0 +1,99 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+#include "theia/util/flat_set.h"
+
+#include <cereal/archives/portable_binary.hpp>
+#include <cereal/types/unordered_set.hpp>
+
+#include <sstream>
+#include <unordered_set>
+#include <vector>
+#include "gtest/gtest.h"
+
+#include "theia/util/map_util.h"
+
+namespace theia {
+
+TEST(FlatSet, InsertAndErase) {
+  FlatSet<int> set;
+  EXPECT_TRUE(set.empty());
+  EXPECT_TRUE(set.insert(5).second);
+  EXPECT_TRUE(set.insert(1).second);
+  EXPECT_FALSE(set.insert(5).second);
+  EXPECT_TRUE(set.insert(3).second);
+  EXPECT_EQ(set.size(), 3);
+  EXPECT_EQ(std::vector<int>(set.begin(), set.end()),
+            std::vector<int>({1, 3, 5}));
+
+  EXPECT_TRUE(ContainsKey(set, 3));
+  EXPECT_EQ(set.count(4), 0);
+  EXPECT_EQ(set.erase(3), 1);
+  EXPECT_EQ(set.erase(3), 0);
+  EXPECT_EQ(set, FlatSet<int>({5, 1}));
+}
+
+TEST(FlatSet, ConvertsToUnorderedSet) {
+  const FlatSet<int> set = {2, 4, 6};
+  const std::unordered_set<int> unordered_set = set;
+  EXPECT_EQ(unordered_set, std::unordered_set<int>({2, 4, 6}));
+}
+
+TEST(FlatSet, SerializationMatchesUnorderedSet) {
+  const std::unordered_set<int> unordered_set = {9, 2, 7, 4};
+  std::stringstream stream;
+  {
+    cereal::PortableBinaryOutputArchive output_archive(stream);
+    output_archive(unordered_set);
+  }
+  FlatSet<int> set;
+  {
+    cereal::PortableBinaryInputArchive input_archive(stream);
+    input_archive(set);
+  }
+  EXPECT_EQ(set, FlatSet<int>({2, 4, 7, 9}));
+
+  std::stringstream stream2;
+  {
+    cereal::PortableBinaryOutputArchive output_archive(stream2);
+    output_archive(set);
+  }
+  std::unordered_set<int> unordered_set2;
+  {
+    cereal::PortableBinaryInputArchive input_archive(stream2);
+    input_archive(unordered_set2);
+  }
+  EXPECT_EQ(unordered_set2, unordered_set);
+}
+
+}  // namespace theia
@@ -0,0 +1,111 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#include "theia/util/mapped_file.h"
+
+#include <glog/logging.h>
+#include <string>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#include "theia/util/filesystem.h"
+
+namespace theia {
+
+MappedFile::MappedFile(const std::string& filepath, const uint64_t size)
+    : data_(nullptr), size_(size) {
+  Map(filepath);
+}
+
+MappedFile::MappedFile(const std::string& filepath)
+    : data_(nullptr), size_(0) {
+  FileSignature signature;
+  CHECK(GetFileSignature(filepath, &signature)) << "Could not open "
+                                                << filepath;
+  size_ = signature.size;
+  Map(filepath);
+}
+
+void MappedFile::Map(const std::string& filepath) {
+  if (size_ == 0) {
+    return;
+  }
+#ifdef _WIN32
+  file_ = CreateFileA(filepath.c_str(),
+                      GENERIC_READ,
+                      FILE_SHARE_READ | FILE_SHARE_WRITE,
+                      nullptr,
+                      OPEN_EXISTING,
+                      FILE_ATTRIBUTE_NORMAL,
+                      nullptr);
+  CHECK(file_ != INVALID_HANDLE_VALUE) << "Could not open " << filepath;
+  mapping_ = CreateFileMappingA(file_,
+                                nullptr,
+                                PAGE_READONLY,
+                                static_cast<DWORD>(size_ >> 32),
+                                static_cast<DWORD>(size_),
+                                nullptr);
+  CHECK(mapping_ != nullptr) << "Could not map " << filepath;
+  data_ = static_cast<const char*>(
+      MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, size_));
+  CHECK(data_ != nullptr) << "Could not map " << filepath;
+#else
+  const int fd = open(filepath.c_str(), O_RDONLY);
+  CHECK_GE(fd, 0) << "Could not open " << filepath;
+  void* data = mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0);
+  // The mapping keeps its own reference to the file.
+  close(fd);
+  CHECK(data != MAP_FAILED) << "Could not map " << filepath;
+  data_ = static_cast<const char*>(data);
+#endif
+}
+
+MappedFile::~MappedFile() {
+  if (data_ == nullptr) {
+    return;
+  }
+#ifdef _WIN32
+  UnmapViewOfFile(data_);
+  CloseHandle(mapping_);
+  CloseHandle(file_);
+#else
+  munmap(const_cast<char*>(data_), size_);
+#endif
+}
+
+}  // namespace theia
@@ -0,0 +1,80 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#ifndef THEIA_UTIL_MAPPED_FILE_H_
+#define THEIA_UTIL_MAPPED_FILE_H_
+
+#include <cstdint>
+#include <string>
+
+#include "theia/util/util.h"
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#endif
+
+namespace theia {
+
+// A read-only memory mapping of the first size bytes of a file. The pages are
+// loaded by the operating system on first access, so only the parts of the
+// file that are read take up memory.
+class MappedFile {
+ public:
+  // Maps the first size bytes of the file, which must be at most the size of
+  // the file.
+  MappedFile(const std::string& filepath, const uint64_t size);
+  // Maps the whole file.
+  explicit MappedFile(const std::string& filepath);
+  ~MappedFile();
+
+  const char* data() const { return data_; }
+  uint64_t size() const { return size_; }
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(MappedFile);
+
+  void Map(const std::string& filepath);
+
+  const char* data_;
+  uint64_t size_;
+#ifdef _WIN32
+  HANDLE file_;
+  HANDLE mapping_;
+#endif
+};
+
+}  // namespace theia
+
+#endif  // THEIA_UTIL_MAPPED_FILE_H_
@@ -0,0 +1,290 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#include "theia/util/memory_accounting.h"
+
+#include <glog/logging.h>
+#include <stddef.h>
+#include <algorithm>
+#include <atomic>
+#include <fstream>  // NOLINT
+#include <limits>
+#include <map>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <string>
+#include <utility>
+#include <vector>
+
+#ifdef __linux__
+#include <unistd.h>
+#endif  // __linux__
+
+namespace theia {
+
+struct MemoryAccounting::Consumer {
+  std::string name;
+  ScopedMemoryConsumer::UsageFunction usage;
+  ScopedMemoryConsumer::ReleaseFunction release;
+
+  // Held while the functions are called so that the consumer cannot be
+  // unregistered (and destroyed) during a call.
+  std::mutex mutex;
+  bool is_registered = true;
+};
+
+namespace {
+
+constexpr double kBytesPerMegabyte = 1024.0 * 1024.0;
+
+}  // namespace
+
+struct MemoryAccounting::Registry {
+  std::mutex mutex;
+  std::map<std::string, size_t> snapshots;
+  std::vector<std::shared_ptr<Consumer> > consumers;
+  std::atomic<size_t> budget{0};
+
+  // Only one thread enforces the budget at a time so that concurrent calls do
+  // not release the same excess twice.
+  std::mutex enforce_budget_mutex;
+};
+
+MemoryAccounting::Registry& MemoryAccounting::GetRegistry() {
+  // Leaked so that consumers may be unregistered during static destruction.
+  static Registry* registry = new Registry();
+  return *registry;
+}
+
+std::vector<std::shared_ptr<MemoryAccounting::Consumer> >
+MemoryAccounting::GetConsumers() {
+  Registry& registry = GetRegistry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  return registry.consumers;
+}
+
+size_t MemoryAccounting::ConsumerUsage(Consumer* consumer) {
+  std::lock_guard<std::mutex> lock(consumer->mutex);
+  return consumer->is_registered ? consumer->usage() : 0;
+}
+
+void MemoryAccounting::SetUsage(const std::string& name, const size_t bytes) {
+  Registry& registry = GetRegistry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  registry.snapshots[name] = bytes;
+}
+
+void MemoryAccounting::ClearUsage(const std::string& name) {
+  Registry& registry = GetRegistry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  registry.snapshots.erase(name);
+}
+
+std::vector<MemoryAccounting::Usage> MemoryAccounting::GetUsage() {
+  std::map<std::string, Usage> usage_by_name;
+  {
+    Registry& registry = GetRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    for (const auto& snapshot : registry.snapshots) {
+      Usage& usage = usage_by_name[snapshot.first];
+      usage.name = snapshot.first;
+      usage.bytes += snapshot.second;
+    }
+  }
+
+  // The consumers are queried without the lock of the registry held.
+  for (const std::shared_ptr<Consumer>& consumer : GetConsumers()) {
+    Usage& usage = usage_by_name[consumer->name];
+    usage.name = consumer->name;
+    usage.bytes += ConsumerUsage(consumer.get());
+    usage.is_reclaimable |= consumer->release != nullptr;
+  }
+
+  std::vector<Usage> usages;
+  usages.reserve(usage_by_name.size());
+  for (const auto& usage : usage_by_name) {
+    usages.emplace_back(usage.second);
+  }
+  return usages;
+}
+
+size_t MemoryAccounting::TotalUsage() {
+  size_t total_bytes = 0;
+  for (const Usage& usage : GetUsage()) {
+    total_bytes += usage.bytes;
+  }
+  return total_bytes;
+}
+
+size_t MemoryAccounting::ProcessResidentBytes() {
+#ifdef __linux__
+  // The second field of statm is the number of resident pages.
+  std::ifstream statm("/proc/self/statm");
+  size_t num_pages, num_resident_pages;
+  if (statm >> num_pages >> num_resident_pages) {
+    return num_resident_pages * static_cast<size_t>(sysconf(_SC_PAGESIZE));
+  }
+#endif  // __linux__
+  return 0;
+}
+
+void MemoryAccounting::SetBudget(const size_t bytes) {
+  GetRegistry().budget = bytes;
+}
+
+size_t MemoryAccounting::Budget() { return GetRegistry().budget; }
+
+bool MemoryAccounting::IsOverBudget() {
+  const size_t budget = Budget();
+  return budget > 0 && TotalUsage() > budget;
+}
+
+size_t MemoryAccounting::AvailableBytes() {
+  const size_t budget = Budget();
+  if (budget == 0) {
+    return std::numeric_limits<size_t>::max();
+  }
+  EnforceBudget();
+  const size_t total_bytes = TotalUsage();
+  return total_bytes < budget ? budget - total_bytes : 0;
+}
+
+size_t MemoryAccounting::EnforceBudget() {
+  const size_t budget = Budget();
+  if (budget == 0) {
+    return 0;
+  }
+
+  Registry& registry = GetRegistry();
+  std::unique_lock<std::mutex> enforce_lock(registry.enforce_budget_mutex,
+                                            std::try_to_lock);
+  if (!enforce_lock.owns_lock()) {
+    return 0;
+  }
+
+  size_t total_bytes = TotalUsage();
+  if (total_bytes <= budget) {
+    return 0;
+  }
+
+  // Shrink the largest reclaimable consumers first.
+  std::vector<std::pair<size_t, std::shared_ptr<Consumer> > > reclaimable;
+  for (const std::shared_ptr<Consumer>& consumer : GetConsumers()) {
+    if (consumer->release != nullptr) {
+      reclaimable.emplace_back(ConsumerUsage(consumer.get()), consumer);
+    }
+  }
+  std::sort(reclaimable.begin(),
+            reclaimable.end(),
+            [](const std::pair<size_t, std::shared_ptr<Consumer> >& lhs,
+               const std::pair<size_t, std::shared_ptr<Consumer> >& rhs) {
+              return lhs.first > rhs.first;
+            });
+
+  size_t num_released_bytes = 0;
+  for (const auto& consumer : reclaimable) {
+    if (total_bytes <= budget) {
+      break;
+    }
+    std::lock_guard<std::mutex> lock(consumer.second->mutex);
+    if (!consumer.second->is_registered) {
+      continue;
+    }
+    const size_t released_bytes =
+        consumer.second->release(total_bytes - budget);
+    num_released_bytes += released_bytes;
+    total_bytes -= std::min(total_bytes, released_bytes);
+  }
+
+  VLOG(1) << "Released " << num_released_bytes / kBytesPerMegabyte
+          << " MB to stay within the memory budget of "
+          << budget / kBytesPerMegabyte << " MB.";
+  LOG_IF(WARNING, total_bytes > budget)
+      << "The accounted memory of " << total_bytes / kBytesPerMegabyte
+      << " MB exceeds the memory budget of " << budget / kBytesPerMegabyte
+      << " MB.";
+  return num_released_bytes;
+}
+
+void MemoryAccounting::LogUsage(const std::string& stage) {
+  EnforceBudget();
+  const std::vector<Usage> usages = GetUsage();
+  size_t total_bytes = 0;
+  for (const Usage& usage : usages) {
+    total_bytes += usage.bytes;
+    VLOG(1) << "  " << usage.name << ": " << usage.bytes / kBytesPerMegabyte
+            << " MB";
+  }
+  LOG(INFO) << "Memory after " << stage << ": "
+            << total_bytes / kBytesPerMegabyte << " MB accounted, "
+            << ProcessResidentBytes() / kBytesPerMegabyte << " MB resident.";
+}
+
+void MemoryAccounting::RegisterConsumer(
+    const std::shared_ptr<Consumer>& consumer) {
+  Registry& registry = GetRegistry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  registry.consumers.emplace_back(consumer);
+}
+
+void MemoryAccounting::UnregisterConsumer(
+    const std::shared_ptr<Consumer>& consumer) {
+  {
+    Registry& registry = GetRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    registry.consumers.erase(std::find(
+        registry.consumers.begin(), registry.consumers.end(), consumer));
+  }
+
+  // Wait for calls that are in progress.
+  std::lock_guard<std::mutex> lock(consumer->mutex);
+  consumer->is_registered = false;
+}
+
+ScopedMemoryConsumer::ScopedMemoryConsumer(const std::string& name,
+                                           const UsageFunction& usage,
+                                           const ReleaseFunction& release)
+    : consumer_(std::make_shared<MemoryAccounting::Consumer>()) {
+  CHECK(usage != nullptr);
+  consumer_->name = name;
+  consumer_->usage = usage;
+  consumer_->release = release;
+  MemoryAccounting::RegisterConsumer(consumer_);
+}
+
+ScopedMemoryConsumer::~ScopedMemoryConsumer() {
+  MemoryAccounting::UnregisterConsumer(consumer_);
+}
+
+}  // namespace theia
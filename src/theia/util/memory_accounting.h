@@ -0,0 +1,152 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#ifndef THEIA_UTIL_MEMORY_ACCOUNTING_H_
+#define THEIA_UTIL_MEMORY_ACCOUNTING_H_
+
+#include <stddef.h>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "theia/util/util.h"
+
+namespace theia {
+
+// A process-wide account of the memory held by the large data structures of the
+// pipeline (caches, the reconstruction, the view graph, bundle adjustment
+// problems) so that the memory of a job can be inspected at runtime and logged
+// per stage, and so that an optional memory budget can be enforced before the
+// process runs out of memory.
+//
+// Structures report their memory in one of two ways. Long-lived structures
+// whose size changes often, such as caches, register a ScopedMemoryConsumer
+// whose usage function is called whenever the memory is queried. Caches also
+// provide a release function so that they can be shrunk when the budget is
+// exceeded. Structures that are expensive to measure, such as the
+// reconstruction, report a snapshot of their size with SetUsage at the end of
+// each stage.
+//
+// Usage:
+//   MemoryAccounting::SetBudget(size_t(16) << 30);
+//   reconstruction_builder.BuildReconstruction(&reconstructions);
+//   for (const auto& usage : MemoryAccounting::GetUsage()) { ... }
+class MemoryAccounting {
+ public:
+  struct Usage {
+    std::string name;
+    size_t bytes = 0;
+    // The bytes that the consumers of this name can release on request.
+    bool is_reclaimable = false;
+  };
+
+  // Sets the memory held by the named structure, replacing the previous
+  // snapshot, or removes the snapshot.
+  static void SetUsage(const std::string& name, const size_t bytes);
+  static void ClearUsage(const std::string& name);
+
+  // Returns the usage of all snapshots and consumers sorted by name. The usage
+  // of consumers with the same name is summed.
+  static std::vector<Usage> GetUsage();
+  static size_t TotalUsage();
+
+  // The resident set size of the process in bytes, or 0 if it is not known on
+  // this platform. It includes memory that is not accounted for, e.g. the
+  // features held by callers and the allocator overhead.
+  static size_t ProcessResidentBytes();
+
+  // The memory budget in bytes. A budget of 0 (the default) disables the
+  // budget.
+  static void SetBudget(const size_t bytes);
+  static size_t Budget();
+
+  // Returns true if a budget is set and the accounted memory exceeds it.
+  static bool IsOverBudget();
+
+  // Returns the accounted memory that may still be used before the budget is
+  // exceeded, after shrinking the caches if necessary. Returns the maximum
+  // size_t if no budget is set.
+  static size_t AvailableBytes();
+
+  // Asks the reclaimable consumers, largest first, to release memory until the
+  // accounted memory is within the budget. Returns the number of bytes that
+  // were released. Consumers may call this after they grew.
+  static size_t EnforceBudget();
+
+  // Logs the memory usage after the named stage of the pipeline and enforces
+  // the budget.
+  static void LogUsage(const std::string& stage);
+
+ private:
+  friend class ScopedMemoryConsumer;
+  struct Consumer;
+  struct Registry;
+
+  static Registry& GetRegistry();
+  static std::vector<std::shared_ptr<Consumer> > GetConsumers();
+  // Returns 0 if the consumer was unregistered.
+  static size_t ConsumerUsage(Consumer* consumer);
+  static void RegisterConsumer(const std::shared_ptr<Consumer>& consumer);
+  static void UnregisterConsumer(const std::shared_ptr<Consumer>& consumer);
+};
+
+// Registers a consumer of memory with the MemoryAccounting for the lifetime of
+// this object. The usage function returns the bytes held by the consumer. The
+// optional release function is asked to release at least the given number of
+// bytes and returns the number of bytes it released.
+//
+// The functions are called without any lock of the accounting held, and they
+// are never called after the destructor of this object returned. The consumer
+// must not call into the MemoryAccounting while it holds a lock that its
+// functions acquire.
+class ScopedMemoryConsumer {
+ public:
+  typedef std::function<size_t()> UsageFunction;
+  typedef std::function<size_t(const size_t)> ReleaseFunction;
+
+  ScopedMemoryConsumer(const std::string& name,
+                       const UsageFunction& usage,
+                       const ReleaseFunction& release = nullptr);
+  ~ScopedMemoryConsumer();
+
+ private:
+  std::shared_ptr<MemoryAccounting::Consumer> consumer_;
+
+  DISALLOW_COPY_AND_ASSIGN(ScopedMemoryConsumer);
+};
+
+}  // namespace theia
+
+#endif  // THEIA_UTIL_MEMORY_ACCOUNTING_H_
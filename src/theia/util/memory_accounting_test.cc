@@ -0,0 +1,122 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#include "theia/util/memory_accounting.h"
+
+#include <algorithm>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace theia {
+
+namespace {
+
+size_t FindUsage(const std::string& name) {
+  for (const MemoryAccounting::Usage& usage : MemoryAccounting::GetUsage()) {
+    if (usage.name == name) {
+      return usage.bytes;
+    }
+  }
+  return 0;
+}
+
+}  // namespace
+
+TEST(MemoryAccounting, SnapshotsReplacePreviousUsage) {
+  MemoryAccounting::SetUsage("test_snapshot", 100);
+  EXPECT_EQ(FindUsage("test_snapshot"), 100);
+  MemoryAccounting::SetUsage("test_snapshot", 50);
+  EXPECT_EQ(FindUsage("test_snapshot"), 50);
+  MemoryAccounting::ClearUsage("test_snapshot");
+  EXPECT_EQ(FindUsage("test_snapshot"), 0);
+}
+
+TEST(MemoryAccounting, ConsumersWithTheSameNameAreSummed) {
+  const size_t total_usage = MemoryAccounting::TotalUsage();
+  {
+    ScopedMemoryConsumer consumer1("test_consumer", []() { return 10; });
+    ScopedMemoryConsumer consumer2("test_consumer", []() { return 20; });
+    EXPECT_EQ(FindUsage("test_consumer"), 30);
+    EXPECT_EQ(MemoryAccounting::TotalUsage(), total_usage + 30);
+  }
+  EXPECT_EQ(FindUsage("test_consumer"), 0);
+  EXPECT_EQ(MemoryAccounting::TotalUsage(), total_usage);
+}
+
+TEST(MemoryAccounting, EnforceBudgetReleasesLargestConsumersFirst) {
+  size_t small_bytes = 100;
+  size_t large_bytes = 1000;
+  const auto release = [](size_t* bytes, const size_t num_bytes) {
+    const size_t released_bytes = std::min(*bytes, num_bytes);
+    *bytes -= released_bytes;
+    return released_bytes;
+  };
+  ScopedMemoryConsumer small_consumer(
+      "test_small",
+      [&]() { return small_bytes; },
+      [&](const size_t num_bytes) { return release(&small_bytes, num_bytes); });
+  ScopedMemoryConsumer large_consumer(
+      "test_large",
+      [&]() { return large_bytes; },
+      [&](const size_t num_bytes) { return release(&large_bytes, num_bytes); });
+
+  // No budget is set by default.
+  EXPECT_EQ(MemoryAccounting::EnforceBudget(), 0);
+  EXPECT_FALSE(MemoryAccounting::IsOverBudget());
+
+  const size_t other_usage = MemoryAccounting::TotalUsage() - 1100;
+  MemoryAccounting::SetBudget(other_usage + 600);
+  EXPECT_TRUE(MemoryAccounting::IsOverBudget());
+  EXPECT_EQ(MemoryAccounting::EnforceBudget(), 500);
+  EXPECT_EQ(large_bytes, 500);
+  EXPECT_EQ(small_bytes, 100);
+  EXPECT_FALSE(MemoryAccounting::IsOverBudget());
+  EXPECT_EQ(MemoryAccounting::AvailableBytes(), 0);
+
+  MemoryAccounting::SetBudget(0);
+  EXPECT_EQ(MemoryAccounting::AvailableBytes(),
+            std::numeric_limits<size_t>::max());
+}
+
+TEST(MemoryAccounting, ProcessResidentBytes) {
+#ifdef __linux__
+  EXPECT_GT(MemoryAccounting::ProcessResidentBytes(), 0);
+#endif  // __linux__
+  MemoryAccounting::LogUsage("test");
+}
+
+}  // namespace theia
@@ -0,0 +1,92 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+
+#ifndef THEIA_UTIL_MEMORY_STREAM_BUFFER_H_
+#define THEIA_UTIL_MEMORY_STREAM_BUFFER_H_
+
+#include <cstddef>
+#include <streambuf>
+#include <string>
+
+#include "theia/util/util.h"
+
+namespace theia {
+
+// Stream buffers that let the stream based serializers (e.g. cereal) write to
+// and read from memory without the copies of std::stringstream, which copies
+// its contents into a new string when they are retrieved.
+
+// Appends everything written to the stream to a string, which must outlive the
+// stream buffer. Reserve the string beforehand if the size is known.
+class StringOutputStreamBuffer : public std::streambuf {
+ public:
+  explicit StringOutputStreamBuffer(std::string* output) : output_(output) {}
+
+ protected:
+  std::streamsize xsputn(const char* data, std::streamsize size) override {
+    output_->append(data, size);
+    return size;
+  }
+
+  int_type overflow(int_type c) override {
+    if (!traits_type::eq_int_type(c, traits_type::eof())) {
+      output_->push_back(traits_type::to_char_type(c));
+    }
+    return traits_type::not_eof(c);
+  }
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(StringOutputStreamBuffer);
+
+  std::string* output_;
+};
+
+// Reads the stream from an array, which must outlive the stream buffer, in
+// place.
+class ArrayInputStreamBuffer : public std::streambuf {
+ public:
+  ArrayInputStreamBuffer(const char* data, const size_t size) {
+    // std::streambuf only provides a mutable get area, which is never written.
+    char* begin = const_cast<char*>(data);
+    setg(begin, begin, begin + size);
+  }
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(ArrayInputStreamBuffer);
+};
+
+}  // namespace theia
+
+#endif  // THEIA_UTIL_MEMORY_STREAM_BUFFER_H_
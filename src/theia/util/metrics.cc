@@ -0,0 +1,417 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#include "theia/util/metrics.h"
+
+#include <glog/logging.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>  // NOLINT
+#include <cmath>
+#include <fstream>  // NOLINT
+#include <map>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <sstream>  // NOLINT
+#include <string>
+#include <vector>
+
+#include "theia/util/json.h"
+#include "theia/util/stringprintf.h"
+
+namespace theia {
+namespace {
+
+enum class MetricType { COUNTER, GAUGE, HISTOGRAM };
+
+// Adds to an atomic double, which has no fetch_add before C++20.
+void AtomicAdd(const double value, std::atomic<double>* sum) {
+  double old_sum = sum->load(std::memory_order_relaxed);
+  while (!sum->compare_exchange_weak(
+      old_sum, old_sum + value, std::memory_order_relaxed)) {
+  }
+}
+
+bool IsValidMetricName(const std::string& name) {
+  if (name.empty() || std::isdigit(name[0])) {
+    return false;
+  }
+  return std::all_of(name.begin(), name.end(), [](const char c) {
+    return std::isalnum(c) || c == '_' || c == ':';
+  });
+}
+
+std::string FormatValue(const double value) {
+  if (std::isnan(value)) {
+    return "NaN";
+  } else if (std::isinf(value)) {
+    return value > 0 ? "+Inf" : "-Inf";
+  }
+  return StringPrintf("%.15g", value);
+}
+
+// Escapes the help text as required by the Prometheus text format.
+std::string EscapeHelp(const std::string& help) {
+  std::string escaped;
+  escaped.reserve(help.size());
+  for (const char c : help) {
+    if (c == '\\') {
+      escaped += "\\\\";
+    } else if (c == '\n') {
+      escaped += "\\n";
+    } else {
+      escaped += c;
+    }
+  }
+  return escaped;
+}
+
+bool WriteFileAtomically(const std::string& filepath,
+                         const std::string& contents) {
+  const std::string temporary_filepath = filepath + ".tmp";
+  {
+    std::ofstream file(temporary_filepath);
+    if (!file.is_open()) {
+      LOG(ERROR) << "Could not open the metrics file " << temporary_filepath
+                 << " for writing.";
+      return false;
+    }
+    file << contents;
+    if (!file.good()) {
+      return false;
+    }
+  }
+  if (std::rename(temporary_filepath.c_str(), filepath.c_str()) != 0) {
+    LOG(ERROR) << "Could not move the metrics file to " << filepath;
+    return false;
+  }
+  return true;
+}
+
+}  // namespace
+
+void Gauge::Add(const double value) { AtomicAdd(value, &value_); }
+
+Histogram::Histogram(const std::vector<double>& bucket_bounds)
+    : bucket_bounds_(bucket_bounds),
+      bucket_counts_(new std::atomic<int64_t>[bucket_bounds.size()]),
+      count_(0),
+      sum_(0.0) {
+  CHECK(std::is_sorted(bucket_bounds_.begin(), bucket_bounds_.end()))
+      << "The bucket bounds of a histogram must be sorted.";
+  Reset();
+}
+
+void Histogram::Observe(const double value) {
+  const size_t bucket = std::lower_bound(bucket_bounds_.begin(),
+                                         bucket_bounds_.end(),
+                                         value) -
+                        bucket_bounds_.begin();
+  if (bucket < bucket_bounds_.size()) {
+    bucket_counts_[bucket].fetch_add(1, std::memory_order_relaxed);
+  }
+  count_.fetch_add(1, std::memory_order_relaxed);
+  AtomicAdd(value, &sum_);
+}
+
+std::vector<int64_t> Histogram::BucketCounts() const {
+  std::vector<int64_t> bucket_counts(bucket_bounds_.size());
+  for (int i = 0; i < bucket_counts.size(); i++) {
+    bucket_counts[i] = bucket_counts_[i].load(std::memory_order_relaxed);
+  }
+  return bucket_counts;
+}
+
+void Histogram::Reset() {
+  for (int i = 0; i < bucket_bounds_.size(); i++) {
+    bucket_counts_[i].store(0, std::memory_order_relaxed);
+  }
+  count_.store(0, std::memory_order_relaxed);
+  sum_.store(0.0, std::memory_order_relaxed);
+}
+
+namespace {
+
+struct Metric {
+  MetricType type;
+  std::string help;
+  std::unique_ptr<Counter> counter;
+  std::unique_ptr<Gauge> gauge;
+  std::unique_ptr<Histogram> histogram;
+};
+
+struct MetricsRegistry {
+  std::mutex mutex;
+  // Sorted by name for the export.
+  std::map<std::string, Metric> metrics;
+  const std::chrono::steady_clock::time_point start_time =
+      std::chrono::steady_clock::now();
+};
+
+MetricsRegistry& GetRegistry() {
+  // Leaked so that metrics may be updated during static destruction.
+  static MetricsRegistry* registry = new MetricsRegistry();
+  return *registry;
+}
+
+// Returns the metric with the name, or a new metric of the type if it does
+// not exist. The registry must be locked.
+Metric* FindOrAddMetric(const std::string& name,
+                        const std::string& help,
+                        const MetricType type,
+                        MetricsRegistry* registry) {
+  CHECK(IsValidMetricName(name)) << name << " is not a valid metric name.";
+  auto it = registry->metrics.find(name);
+  if (it == registry->metrics.end()) {
+    it = registry->metrics.emplace(name, Metric()).first;
+    it->second.type = type;
+    it->second.help = help;
+    return &it->second;
+  }
+  CHECK(it->second.type == type)
+      << "The metric " << name << " was registered with another type.";
+  return &it->second;
+}
+
+}  // namespace
+
+Counter* Metrics::GetCounter(const std::string& name,
+                             const std::string& help) {
+  MetricsRegistry& registry = GetRegistry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  Metric* metric =
+      FindOrAddMetric(name, help, MetricType::COUNTER, &registry);
+  if (metric->counter == nullptr) {
+    metric->counter.reset(new Counter());
+  }
+  return metric->counter.get();
+}
+
+Gauge* Metrics::GetGauge(const std::string& name, const std::string& help) {
+  MetricsRegistry& registry = GetRegistry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  Metric* metric = FindOrAddMetric(name, help, MetricType::GAUGE, &registry);
+  if (metric->gauge == nullptr) {
+    metric->gauge.reset(new Gauge());
+  }
+  return metric->gauge.get();
+}
+
+Histogram* Metrics::GetHistogram(const std::string& name,
+                                 const std::string& help,
+                                 const std::vector<double>& bucket_bounds) {
+  MetricsRegistry& registry = GetRegistry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  Metric* metric =
+      FindOrAddMetric(name, help, MetricType::HISTOGRAM, &registry);
+  if (metric->histogram == nullptr) {
+    metric->histogram.reset(new Histogram(bucket_bounds));
+  }
+  return metric->histogram.get();
+}
+
+std::vector<double> Metrics::LatencyBucketBoundsInSeconds() {
+  std::vector<double> bucket_bounds;
+  for (int exponent = -5; exponent <= 2; exponent++) {
+    const double power_of_ten = std::pow(10.0, exponent);
+    bucket_bounds.emplace_back(power_of_ten);
+    bucket_bounds.emplace_back(2.5 * power_of_ten);
+    bucket_bounds.emplace_back(5.0 * power_of_ten);
+  }
+  // End at 100s.
+  bucket_bounds.resize(bucket_bounds.size() - 2);
+  return bucket_bounds;
+}
+
+void Metrics::Reset() {
+  MetricsRegistry& registry = GetRegistry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  for (auto& metric : registry.metrics) {
+    if (metric.second.counter != nullptr) {
+      metric.second.counter->value_.store(0, std::memory_order_relaxed);
+    }
+    if (metric.second.gauge != nullptr) {
+      metric.second.gauge->Set(0.0);
+    }
+    if (metric.second.histogram != nullptr) {
+      metric.second.histogram->Reset();
+    }
+  }
+}
+
+double Metrics::UptimeInSeconds() {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                       GetRegistry().start_time)
+      .count();
+}
+
+std::string Metrics::PrometheusText() {
+  static const char* const kTypeNames[] = {"counter", "gauge", "histogram"};
+
+  std::ostringstream text;
+  MetricsRegistry& registry = GetRegistry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  for (const auto& entry : registry.metrics) {
+    const std::string& name = entry.first;
+    const Metric& metric = entry.second;
+    text << "# HELP " << name << " " << EscapeHelp(metric.help) << "\n"
+         << "# TYPE " << name << " "
+         << kTypeNames[static_cast<int>(metric.type)] << "\n";
+    switch (metric.type) {
+      case MetricType::COUNTER:
+        text << name << " " << metric.counter->Value() << "\n";
+        break;
+      case MetricType::GAUGE:
+        text << name << " " << FormatValue(metric.gauge->Value()) << "\n";
+        break;
+      case MetricType::HISTOGRAM: {
+        const Histogram& histogram = *metric.histogram;
+        const std::vector<int64_t> bucket_counts = histogram.BucketCounts();
+        int64_t cumulative_count = 0;
+        for (int i = 0; i < bucket_counts.size(); i++) {
+          cumulative_count += bucket_counts[i];
+          text << name << "_bucket{le=\""
+               << FormatValue(histogram.BucketBounds()[i]) << "\"} "
+               << cumulative_count << "\n";
+        }
+        text << name << "_bucket{le=\"+Inf\"} " << histogram.Count() << "\n"
+             << name << "_sum " << FormatValue(histogram.Sum()) << "\n"
+             << name << "_count " << histogram.Count() << "\n";
+        break;
+      }
+    }
+  }
+  return text.str();
+}
+
+std::string Metrics::Json() {
+  const double uptime_in_seconds = UptimeInSeconds();
+  nlohmann::json json;
+  json["uptime_seconds"] = uptime_in_seconds;
+  json["counters"] = nlohmann::json::object();
+  json["gauges"] = nlohmann::json::object();
+  json["histograms"] = nlohmann::json::object();
+
+  MetricsRegistry& registry = GetRegistry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  for (const auto& entry : registry.metrics) {
+    const std::string& name = entry.first;
+    const Metric& metric = entry.second;
+    switch (metric.type) {
+      case MetricType::COUNTER: {
+        const int64_t value = metric.counter->Value();
+        json["counters"][name] = {
+            {"value", value},
+            {"rate_per_second",
+             uptime_in_seconds > 0.0 ? value / uptime_in_seconds : 0.0}};
+        break;
+      }
+      case MetricType::GAUGE:
+        json["gauges"][name] = metric.gauge->Value();
+        break;
+      case MetricType::HISTOGRAM: {
+        const Histogram& histogram = *metric.histogram;
+        const std::vector<int64_t> bucket_counts = histogram.BucketCounts();
+        nlohmann::json buckets = nlohmann::json::array();
+        int64_t cumulative_count = 0;
+        for (int i = 0; i < bucket_counts.size(); i++) {
+          cumulative_count += bucket_counts[i];
+          buckets.push_back({{"le", histogram.BucketBounds()[i]},
+                             {"count", cumulative_count}});
+        }
+        json["histograms"][name] = {{"count", histogram.Count()},
+                                    {"sum", histogram.Sum()},
+                                    {"buckets", buckets}};
+        break;
+      }
+    }
+  }
+  return json.dump(2);
+}
+
+bool Metrics::WritePrometheusText(const std::string& filepath) {
+  return WriteFileAtomically(filepath, PrometheusText());
+}
+
+bool Metrics::WriteJson(const std::string& filepath) {
+  return WriteFileAtomically(filepath, Json());
+}
+
+PeriodicMetricsWriter::PeriodicMetricsWriter(const std::string& filepath,
+                                             const double interval_in_seconds)
+    : filepath_(filepath),
+      interval_in_seconds_(interval_in_seconds),
+      stop_(false) {
+  CHECK_GT(interval_in_seconds_, 0.0);
+  thread_ = std::thread([this]() {
+    const auto interval =
+        std::chrono::duration<double>(interval_in_seconds_);
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!stop_condition_.wait_for(
+        lock, interval, [this]() { return stop_; })) {
+      lock.unlock();
+      Write();
+      lock.lock();
+    }
+  });
+}
+
+PeriodicMetricsWriter::~PeriodicMetricsWriter() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  stop_condition_.notify_all();
+  thread_.join();
+  Write();
+}
+
+void PeriodicMetricsWriter::Write() const {
+  static const std::string kPrometheusExtension = ".prom";
+  const bool is_prometheus_text =
+      filepath_.size() >= kPrometheusExtension.size() &&
+      filepath_.compare(filepath_.size() - kPrometheusExtension.size(),
+                        kPrometheusExtension.size(),
+                        kPrometheusExtension) == 0;
+  if (is_prometheus_text) {
+    Metrics::WritePrometheusText(filepath_);
+  } else {
+    Metrics::WriteJson(filepath_);
+  }
+}
+
+}  // namespace theia
@@ -0,0 +1,192 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#ifndef THEIA_UTIL_METRICS_H_
+#define THEIA_UTIL_METRICS_H_
+
+#include <stdint.h>
+#include <atomic>
+#include <condition_variable>  // NOLINT
+#include <memory>
+#include <mutex>  // NOLINT
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "theia/util/util.h"
+
+namespace theia {
+
+// A monotonically increasing count, e.g. of the images that were extracted.
+class Counter {
+ public:
+  void Increment(const int64_t value = 1) {
+    value_.fetch_add(value, std::memory_order_relaxed);
+  }
+  int64_t Value() const { return value_.load(std::memory_order_relaxed); }
+
+ private:
+  friend class Metrics;
+  Counter() : value_(0) {}
+
+  std::atomic<int64_t> value_;
+
+  DISALLOW_COPY_AND_ASSIGN(Counter);
+};
+
+// A value that may go up and down, e.g. the hit rate of a cache.
+class Gauge {
+ public:
+  void Set(const double value) {
+    value_.store(value, std::memory_order_relaxed);
+  }
+  void Add(const double value);
+  double Value() const { return value_.load(std::memory_order_relaxed); }
+
+ private:
+  friend class Metrics;
+  Gauge() : value_(0.0) {}
+
+  std::atomic<double> value_;
+
+  DISALLOW_COPY_AND_ASSIGN(Gauge);
+};
+
+// The distribution of observed values, e.g. latencies, counted in buckets with
+// fixed upper bounds.
+class Histogram {
+ public:
+  void Observe(const double value);
+
+  // The upper bounds of the buckets in increasing order. Values larger than
+  // the last bound are only counted in Count.
+  const std::vector<double>& BucketBounds() const { return bucket_bounds_; }
+  // The number of observed values in each bucket, i.e. that are larger than
+  // the previous bound and at most the bound of the bucket.
+  std::vector<int64_t> BucketCounts() const;
+  int64_t Count() const { return count_.load(std::memory_order_relaxed); }
+  double Sum() const { return sum_.load(std::memory_order_relaxed); }
+
+ private:
+  friend class Metrics;
+  explicit Histogram(const std::vector<double>& bucket_bounds);
+  void Reset();
+
+  const std::vector<double> bucket_bounds_;
+  std::unique_ptr<std::atomic<int64_t>[]> bucket_counts_;
+  std::atomic<int64_t> count_;
+  std::atomic<double> sum_;
+
+  DISALLOW_COPY_AND_ASSIGN(Histogram);
+};
+
+// A process-wide registry of the metrics of long-running jobs: throughput
+// counters (images extracted, pairs matched), rates (verification acceptance,
+// cache hits), latencies and solver statistics. The pipeline updates the
+// metrics as it runs and they may be exported as Prometheus text, e.g. for the
+// textfile collector of the node exporter, or as JSON.
+//
+// Metrics are created on first use and live for the rest of the process, so
+// call sites look them up once and keep the pointer. Updates are lock-free:
+//
+//   static Counter* const num_images = Metrics::GetCounter(
+//       "theia_images_extracted_total", "Images that were extracted.");
+//   num_images->Increment();
+//
+// Metric names must be valid Prometheus names, and a name can only be used for
+// one type of metric.
+class Metrics {
+ public:
+  // Returns the metric with the name, creating it with the help text if it
+  // does not exist yet.
+  static Counter* GetCounter(const std::string& name, const std::string& help);
+  static Gauge* GetGauge(const std::string& name, const std::string& help);
+  // The bucket bounds are only used when the histogram is created.
+  static Histogram* GetHistogram(const std::string& name,
+                                 const std::string& help,
+                                 const std::vector<double>& bucket_bounds =
+                                     LatencyBucketBoundsInSeconds());
+
+  // Exponential bucket bounds from 10us to 100s.
+  static std::vector<double> LatencyBucketBoundsInSeconds();
+
+  // Resets the values of all metrics to zero. The metrics stay registered.
+  static void Reset();
+
+  // Seconds since the metrics were first used.
+  static double UptimeInSeconds();
+
+  // Returns all metrics sorted by name in the Prometheus text exposition
+  // format.
+  static std::string PrometheusText();
+
+  // Returns all metrics as a JSON object with the uptime and the counters,
+  // gauges and histograms by name. Counters include their average rate per
+  // second over the uptime, and histogram buckets are cumulative as in the
+  // Prometheus format.
+  static std::string Json();
+
+  // Writes PrometheusText or Json to the file. The file is replaced
+  // atomically so that readers never see a partial file. Returns false if the
+  // file could not be written.
+  static bool WritePrometheusText(const std::string& filepath);
+  static bool WriteJson(const std::string& filepath);
+};
+
+// Writes the metrics to a file periodically on a background thread, and once
+// more when it is destroyed. The format is Prometheus text if the file has the
+// extension ".prom" and JSON otherwise.
+class PeriodicMetricsWriter {
+ public:
+  PeriodicMetricsWriter(const std::string& filepath,
+                        const double interval_in_seconds);
+  ~PeriodicMetricsWriter();
+
+ private:
+  void Write() const;
+
+  const std::string filepath_;
+  const double interval_in_seconds_;
+
+  std::mutex mutex_;
+  std::condition_variable stop_condition_;
+  bool stop_;
+  std::thread thread_;
+
+  DISALLOW_COPY_AND_ASSIGN(PeriodicMetricsWriter);
+};
+
+}  // namespace theia
+
+#endif  // THEIA_UTIL_METRICS_H_
@@ -0,0 +1,144 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#include <stdint.h>
+#include <cstdio>
+#include <fstream>  // NOLINT
+#include <sstream>  // NOLINT
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "theia/util/json.h"
+#include "theia/util/metrics.h"
+
+namespace theia {
+
+TEST(Metrics, MetricsAreCreatedOnce) {
+  Counter* counter = Metrics::GetCounter("test_created_once_total", "Help.");
+  EXPECT_EQ(Metrics::GetCounter("test_created_once_total", "Help."), counter);
+}
+
+TEST(Metrics, ConcurrentUpdates) {
+  static const int kNumThreads = 8;
+  static const int kNumIncrements = 10000;
+  Counter* counter = Metrics::GetCounter("test_concurrent_total", "Help.");
+  Gauge* gauge = Metrics::GetGauge("test_concurrent_gauge", "Help.");
+  Histogram* histogram = Metrics::GetHistogram(
+      "test_concurrent_histogram", "Help.", {1.0, 2.0});
+  Metrics::Reset();
+
+  std::vector<std::thread> threads;
+  for (int i = 0; i < kNumThreads; i++) {
+    threads.emplace_back([&]() {
+      for (int j = 0; j < kNumIncrements; j++) {
+        counter->Increment();
+        gauge->Add(0.5);
+        histogram->Observe(1.5);
+      }
+    });
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+
+  EXPECT_EQ(counter->Value(), kNumThreads * kNumIncrements);
+  EXPECT_EQ(gauge->Value(), 0.5 * kNumThreads * kNumIncrements);
+  EXPECT_EQ(histogram->Count(), kNumThreads * kNumIncrements);
+  EXPECT_EQ(histogram->BucketCounts(),
+            std::vector<int64_t>({0, kNumThreads * kNumIncrements}));
+}
+
+TEST(Metrics, PrometheusText) {
+  Metrics::GetCounter("test_prometheus_total", "A counter.")->Increment(3);
+  Metrics::GetGauge("test_prometheus_gauge", "A gauge.")->Set(0.25);
+  Histogram* histogram = Metrics::GetHistogram(
+      "test_prometheus_seconds", "A histogram.", {0.1, 1.0});
+  histogram->Observe(0.05);
+  histogram->Observe(0.5);
+  histogram->Observe(5.0);
+
+  const std::string text = Metrics::PrometheusText();
+  EXPECT_NE(text.find("# HELP test_prometheus_total A counter.\n"
+                      "# TYPE test_prometheus_total counter\n"
+                      "test_prometheus_total 3\n"),
+            std::string::npos);
+  EXPECT_NE(text.find("# TYPE test_prometheus_gauge gauge\n"
+                      "test_prometheus_gauge 0.25\n"),
+            std::string::npos);
+  EXPECT_NE(text.find("# TYPE test_prometheus_seconds histogram\n"
+                      "test_prometheus_seconds_bucket{le=\"0.1\"} 1\n"
+                      "test_prometheus_seconds_bucket{le=\"1\"} 2\n"
+                      "test_prometheus_seconds_bucket{le=\"+Inf\"} 3\n"
+                      "test_prometheus_seconds_sum 5.55\n"
+                      "test_prometheus_seconds_count 3\n"),
+            std::string::npos);
+}
+
+TEST(Metrics, Json) {
+  Metrics::GetCounter("test_json_total", "A counter.")->Increment(2);
+  Metrics::GetHistogram("test_json_seconds", "A histogram.", {1.0})
+      ->Observe(0.5);
+
+  const nlohmann::json json = nlohmann::json::parse(Metrics::Json());
+  EXPECT_GT(json["uptime_seconds"].get<double>(), 0.0);
+  EXPECT_EQ(json["counters"]["test_json_total"]["value"].get<int>(), 2);
+  EXPECT_GT(json["counters"]["test_json_total"]["rate_per_second"]
+                .get<double>(),
+            0.0);
+  const nlohmann::json& histogram = json["histograms"]["test_json_seconds"];
+  EXPECT_EQ(histogram["count"].get<int>(), 1);
+  EXPECT_EQ(histogram["buckets"][0]["le"].get<double>(), 1.0);
+  EXPECT_EQ(histogram["buckets"][0]["count"].get<int>(), 1);
+}
+
+TEST(Metrics, PeriodicMetricsWriterWritesOnDestruction) {
+  const std::string filepath =
+      testing::internal::TempDir() + "/metrics_test.prom";
+  Metrics::GetCounter("test_writer_total", "A counter.")->Increment();
+  {
+    PeriodicMetricsWriter writer(filepath, 3600.0);
+  }
+
+  std::ifstream file(filepath);
+  ASSERT_TRUE(file.is_open());
+  std::stringstream contents;
+  contents << file.rdbuf();
+  EXPECT_NE(contents.str().find("test_writer_total 1\n"), std::string::npos);
+  std::remove(filepath.c_str());
+}
+
+}  // namespace theia
@@ -0,0 +1,245 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+
+#include "theia/util/numa.h"
+
+#include <glog/logging.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <fstream>  // NOLINT
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace theia {
+
+namespace {
+
+static const char kSysfsNodeDirectory[] = "/sys/devices/system/node";
+
+// Reads the first line of a file.
+bool ReadLine(const std::string& filename, std::string* line) {
+  std::ifstream file(filename);
+  return file.is_open() && static_cast<bool>(std::getline(file, *line));
+}
+
+// Parses a non-negative integer that makes up the whole string.
+bool ParseIndex(const std::string& str, int* index) {
+  if (str.empty() ||
+      !std::all_of(str.begin(), str.end(), [](const char c) {
+        return c >= '0' && c <= '9';
+      })) {
+    return false;
+  }
+  *index = atoi(str.c_str());
+  return true;
+}
+
+#ifdef __linux__
+void ToCpuSet(const std::vector<int>& cpus, cpu_set_t* cpu_set) {
+  CPU_ZERO(cpu_set);
+  if (cpus.empty()) {
+    for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+      CPU_SET(cpu, cpu_set);
+    }
+    return;
+  }
+  for (const int cpu : cpus) {
+    if (cpu < CPU_SETSIZE) {
+      CPU_SET(cpu, cpu_set);
+    }
+  }
+}
+
+bool SetAffinity(const pthread_t thread, const std::vector<int>& cpus) {
+  cpu_set_t cpu_set;
+  ToCpuSet(cpus, &cpu_set);
+  return pthread_setaffinity_np(thread, sizeof(cpu_set), &cpu_set) == 0;
+}
+#endif
+
+}  // namespace
+
+bool ParseCpuList(const std::string& cpu_list, std::vector<int>* cpus) {
+  CHECK_NOTNULL(cpus)->clear();
+  std::stringstream stream(cpu_list);
+  std::string range;
+  while (std::getline(stream, range, ',')) {
+    // Trailing whitespace, e.g. the newline of a sysfs file, is ignored.
+    range.erase(range.find_last_not_of(" \t\n") + 1);
+    if (range.empty()) {
+      continue;
+    }
+    const size_t dash = range.find('-');
+    int first, last;
+    if (dash == std::string::npos) {
+      if (!ParseIndex(range, &first)) {
+        return false;
+      }
+      last = first;
+    } else if (!ParseIndex(range.substr(0, dash), &first) ||
+               !ParseIndex(range.substr(dash + 1), &last) || last < first) {
+      return false;
+    }
+    for (int cpu = first; cpu <= last; cpu++) {
+      cpus->emplace_back(cpu);
+    }
+  }
+  std::sort(cpus->begin(), cpus->end());
+  cpus->erase(std::unique(cpus->begin(), cpus->end()), cpus->end());
+  return true;
+}
+
+bool ReadNumaNodes(const std::string& node_directory,
+                   std::vector<NumaNode>* nodes) {
+  CHECK_NOTNULL(nodes)->clear();
+  // The ids of the online nodes are listed in the same format as the CPUs.
+  std::string line;
+  std::vector<int> node_ids;
+  if (!ReadLine(node_directory + "/online", &line) ||
+      !ParseCpuList(line, &node_ids)) {
+    return false;
+  }
+
+  for (const int node_id : node_ids) {
+    NumaNode node;
+    node.id = node_id;
+    // Nodes without CPUs, e.g. memory-only nodes, are skipped.
+    if (ReadLine(node_directory + "/node" + std::to_string(node_id) +
+                     "/cpulist",
+                 &line) &&
+        ParseCpuList(line, &node.cpus) && !node.cpus.empty()) {
+      nodes->emplace_back(std::move(node));
+    }
+  }
+  return !nodes->empty();
+}
+
+const std::vector<NumaNode>& GetNumaNodes() {
+  static const std::vector<NumaNode>* nodes = []() {
+    auto* nodes = new std::vector<NumaNode>();
+    if (!ReadNumaNodes(kSysfsNodeDirectory, nodes)) {
+      nodes->resize(1);
+      const int num_cpus =
+          std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+      for (int cpu = 0; cpu < num_cpus; cpu++) {
+        nodes->front().cpus.emplace_back(cpu);
+      }
+    }
+    return nodes;
+  }();
+  return *nodes;
+}
+
+int CurrentNumaNodeIndex() {
+#ifdef __linux__
+  const int cpu = sched_getcpu();
+  const std::vector<NumaNode>& nodes = GetNumaNodes();
+  for (int i = 0; i < nodes.size(); i++) {
+    if (std::binary_search(nodes[i].cpus.begin(), nodes[i].cpus.end(), cpu)) {
+      return i;
+    }
+  }
+#endif
+  return 0;
+}
+
+bool GetCurrentThreadAffinity(std::vector<int>* cpus) {
+  CHECK_NOTNULL(cpus)->clear();
+#ifdef __linux__
+  cpu_set_t cpu_set;
+  if (pthread_getaffinity_np(pthread_self(), sizeof(cpu_set), &cpu_set) != 0) {
+    return false;
+  }
+  for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+    if (CPU_ISSET(cpu, &cpu_set)) {
+      cpus->emplace_back(cpu);
+    }
+  }
+  return true;
+#else
+  return false;
+#endif
+}
+
+bool SetCurrentThreadAffinity(const std::vector<int>& cpus) {
+#ifdef __linux__
+  return SetAffinity(pthread_self(), cpus);
+#else
+  return false;
+#endif
+}
+
+bool SetThreadAffinity(std::thread* thread, const std::vector<int>& cpus) {
+#ifdef __linux__
+  return SetAffinity(CHECK_NOTNULL(thread)->native_handle(), cpus);
+#else
+  return false;
+#endif
+}
+
+ScopedNumaNodeAffinity::ScopedNumaNodeAffinity(const bool enabled)
+    : node_(-1) {
+  if (!enabled || GetNumaNodes().size() <= 1 ||
+      !GetCurrentThreadAffinity(&previous_cpus_)) {
+    return;
+  }
+  // Only the CPUs of the node that the thread was allowed to run on.
+  const int node = CurrentNumaNodeIndex();
+  std::vector<int> cpus;
+  std::set_intersection(GetNumaNodes()[node].cpus.begin(),
+                        GetNumaNodes()[node].cpus.end(),
+                        previous_cpus_.begin(),
+                        previous_cpus_.end(),
+                        std::back_inserter(cpus));
+  if (!cpus.empty() && SetCurrentThreadAffinity(cpus)) {
+    node_ = node;
+  }
+}
+
+ScopedNumaNodeAffinity::~ScopedNumaNodeAffinity() {
+  if (node_ >= 0) {
+    SetCurrentThreadAffinity(previous_cpus_);
+  }
+}
+
+}  // namespace theia
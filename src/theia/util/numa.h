@@ -0,0 +1,102 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+
+#ifndef THEIA_UTIL_NUMA_H_
+#define THEIA_UTIL_NUMA_H_
+
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "theia/util/util.h"
+
+namespace theia {
+
+// A NUMA node of the machine and the CPUs that belong to it.
+struct NumaNode {
+  int id = 0;
+  std::vector<int> cpus;
+};
+
+// Parses a list of CPUs in the format of the Linux sysfs, e.g. "0-3,8,10-11".
+// Returns false if the list is malformed.
+bool ParseCpuList(const std::string& cpu_list, std::vector<int>* cpus);
+
+// Reads the NUMA nodes that have CPUs from a node directory in the layout of
+// /sys/devices/system/node. Returns false if no node could be read.
+bool ReadNumaNodes(const std::string& node_directory,
+                   std::vector<NumaNode>* nodes);
+
+// The NUMA nodes of this machine, ordered by id. The topology is read once. If
+// it is not available, e.g. on other platforms than Linux, all hardware
+// threads are reported as a single node.
+const std::vector<NumaNode>& GetNumaNodes();
+
+// Returns the index in GetNumaNodes() of the node of the CPU that the calling
+// thread currently runs on, or 0 if it is not known.
+int CurrentNumaNodeIndex();
+
+// Gets or restricts the CPUs that a thread may run on. An empty list of CPUs
+// lets the thread run on all CPUs. Threads inherit the affinity of the thread
+// that created them. These return false if thread affinity is not supported on
+// this platform or the system call failed.
+bool GetCurrentThreadAffinity(std::vector<int>* cpus);
+bool SetCurrentThreadAffinity(const std::vector<int>& cpus);
+bool SetThreadAffinity(std::thread* thread, const std::vector<int>& cpus);
+
+// Pins the calling thread to the CPUs of the NUMA node it runs on until the
+// scope ends, if enabled and the machine has more than one node. Memory that
+// the thread touches first is then allocated on that node, and libraries such
+// as Ceres that start their threads from the calling thread keep those threads
+// on the node as well.
+class ScopedNumaNodeAffinity {
+ public:
+  explicit ScopedNumaNodeAffinity(const bool enabled);
+  ~ScopedNumaNodeAffinity();
+
+  // The index in GetNumaNodes() of the node the thread is pinned to, or -1 if
+  // it is not pinned.
+  int node() const { return node_; }
+
+ private:
+  int node_;
+  std::vector<int> previous_cpus_;
+
+  DISALLOW_COPY_AND_ASSIGN(ScopedNumaNodeAffinity);
+};
+
+}  // namespace theia
+
+#endif  // THEIA_UTIL_NUMA_H_
@@ -0,0 +1,128 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+
+#include <algorithm>
+#include <fstream>  // NOLINT
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "theia/util/filesystem.h"
+#include "theia/util/numa.h"
+
+namespace theia {
+
+TEST(ParseCpuList, ParsesRangesAndSingleCpus) {
+  std::vector<int> cpus;
+  EXPECT_TRUE(ParseCpuList("0-3,8,10-11\n", &cpus));
+  EXPECT_EQ(cpus, std::vector<int>({0, 1, 2, 3, 8, 10, 11}));
+
+  EXPECT_TRUE(ParseCpuList("5", &cpus));
+  EXPECT_EQ(cpus, std::vector<int>({5}));
+
+  EXPECT_TRUE(ParseCpuList("\n", &cpus));
+  EXPECT_TRUE(cpus.empty());
+}
+
+TEST(ParseCpuList, RejectsMalformedLists) {
+  std::vector<int> cpus;
+  EXPECT_FALSE(ParseCpuList("0-", &cpus));
+  EXPECT_FALSE(ParseCpuList("3-1", &cpus));
+  EXPECT_FALSE(ParseCpuList("a,1", &cpus));
+}
+
+TEST(ReadNumaNodes, ReadsNodesWithCpus) {
+  const std::string directory =
+      testing::internal::TempDir() + "/numa_test_nodes";
+  ASSERT_TRUE(DirectoryExists(directory) || CreateNewDirectory(directory));
+  for (const char* node : {"node0", "node1", "node2"}) {
+    const std::string node_directory = directory + "/" + node;
+    ASSERT_TRUE(DirectoryExists(node_directory) ||
+                CreateNewDirectory(node_directory));
+  }
+  std::ofstream(directory + "/online") << "0-2\n";
+  std::ofstream(directory + "/node0/cpulist") << "0-1,4-5\n";
+  std::ofstream(directory + "/node1/cpulist") << "2-3,6-7\n";
+  // A node with memory but without CPUs.
+  std::ofstream(directory + "/node2/cpulist") << "\n";
+
+  std::vector<NumaNode> nodes;
+  ASSERT_TRUE(ReadNumaNodes(directory, &nodes));
+  ASSERT_EQ(nodes.size(), 2);
+  EXPECT_EQ(nodes[0].id, 0);
+  EXPECT_EQ(nodes[0].cpus, std::vector<int>({0, 1, 4, 5}));
+  EXPECT_EQ(nodes[1].id, 1);
+  EXPECT_EQ(nodes[1].cpus, std::vector<int>({2, 3, 6, 7}));
+
+  EXPECT_FALSE(ReadNumaNodes(directory + "/missing", &nodes));
+}
+
+TEST(GetNumaNodes, ReturnsAtLeastOneNode) {
+  const std::vector<NumaNode>& nodes = GetNumaNodes();
+  ASSERT_GE(nodes.size(), 1);
+  for (const NumaNode& node : nodes) {
+    EXPECT_FALSE(node.cpus.empty());
+  }
+  EXPECT_GE(CurrentNumaNodeIndex(), 0);
+  EXPECT_LT(CurrentNumaNodeIndex(), nodes.size());
+}
+
+TEST(ScopedNumaNodeAffinity, RestoresTheAffinity) {
+  std::vector<int> cpus;
+  if (!GetCurrentThreadAffinity(&cpus)) {
+    return;
+  }
+  {
+    ScopedNumaNodeAffinity numa_node_affinity(true);
+    std::vector<int> pinned_cpus;
+    ASSERT_TRUE(GetCurrentThreadAffinity(&pinned_cpus));
+    if (numa_node_affinity.node() >= 0) {
+      const std::vector<int>& node_cpus =
+          GetNumaNodes()[numa_node_affinity.node()].cpus;
+      EXPECT_TRUE(std::includes(node_cpus.begin(),
+                                node_cpus.end(),
+                                pinned_cpus.begin(),
+                                pinned_cpus.end()));
+    } else {
+      EXPECT_EQ(pinned_cpus, cpus);
+    }
+  }
+  std::vector<int> restored_cpus;
+  ASSERT_TRUE(GetCurrentThreadAffinity(&restored_cpus));
+  EXPECT_EQ(restored_cpus, cpus);
+}
+
+}  // namespace theia
@@ -0,0 +1,407 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#ifndef THEIA_UTIL_POINT_OCTREE_H_
+#define THEIA_UTIL_POINT_OCTREE_H_
+
+#include <Eigen/Core>
+#include <Eigen/Geometry>
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <limits>
+#include <memory>
+#include <queue>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace theia {
+
+// A dynamic octree over 3D points with ids. Points are inserted, moved and
+// removed one at a time, so the tree can be kept up to date while a
+// reconstruction changes instead of being rebuilt for every query. The root
+// grows to cover points that are inserted outside of it, and leaves are split
+// once they hold more than max_points_per_leaf points and merged again when
+// points are removed.
+//
+// The queries return the ids of the points within a box or a radius, the k
+// nearest points, or the points of the nodes and points accepted by custom
+// predicates (e.g. the view frustum of a camera). The octree is not
+// thread-safe for writes but may be queried from several threads at once.
+template <class IdType>
+class PointOctree {
+ public:
+  explicit PointOctree(const int max_points_per_leaf = 32)
+      : max_points_per_leaf_(max_points_per_leaf) {
+    CHECK_GT(max_points_per_leaf_, 0);
+  }
+
+  int Size() const { return positions_.size(); }
+  bool Contains(const IdType id) const { return positions_.count(id) > 0; }
+
+  // Returns the position of the point, or nullptr if it is not in the tree.
+  const Eigen::Vector3d* Position(const IdType id) const {
+    const auto it = positions_.find(id);
+    return it == positions_.end() ? nullptr : &it->second;
+  }
+
+  // The positions of all points by id.
+  const std::unordered_map<IdType, Eigen::Vector3d>& Positions() const {
+    return positions_;
+  }
+
+  // Inserts the point, or moves it if a point with the id is in the tree.
+  void Insert(const IdType id, const Eigen::Vector3d& position) {
+    CHECK(position.allFinite()) << "Points in the octree must be finite.";
+    const auto it = positions_.find(id);
+    if (it != positions_.end()) {
+      if (it->second == position) {
+        return;
+      }
+      RemoveFromNode(id, it->second, root_.get());
+      it->second = position;
+    } else {
+      positions_.emplace(id, position);
+    }
+
+    if (root_ == nullptr) {
+      root_.reset(new Node);
+      root_->box = Eigen::AlignedBox3d(position - Eigen::Vector3d::Ones(),
+                                       position + Eigen::Vector3d::Ones());
+    }
+    while (!root_->box.contains(position)) {
+      GrowRoot(position);
+    }
+    InsertIntoNode(id, position, root_.get());
+  }
+
+  // Removes the point. Returns false if it is not in the tree.
+  bool Remove(const IdType id) {
+    const auto it = positions_.find(id);
+    if (it == positions_.end()) {
+      return false;
+    }
+    RemoveFromNode(id, it->second, root_.get());
+    positions_.erase(it);
+    return true;
+  }
+
+  void Clear() {
+    root_.reset();
+    positions_.clear();
+  }
+
+  // Appends the ids of the points within the box, in no particular order.
+  void PointsInBox(const Eigen::AlignedBox3d& box,
+                   std::vector<IdType>* ids) const {
+    Search(
+        [&](const Eigen::AlignedBox3d& node_box) {
+          return node_box.intersects(box);
+        },
+        [&](const IdType, const Eigen::Vector3d& position) {
+          return box.contains(position);
+        },
+        ids);
+  }
+
+  // Appends the ids of the points within the radius of the center, in no
+  // particular order.
+  void PointsInRadius(const Eigen::Vector3d& center,
+                      const double radius,
+                      std::vector<IdType>* ids) const {
+    const double squared_radius = radius * radius;
+    Search(
+        [&](const Eigen::AlignedBox3d& node_box) {
+          return node_box.squaredExteriorDistance(center) <= squared_radius;
+        },
+        [&](const IdType, const Eigen::Vector3d& position) {
+          return (position - center).squaredNorm() <= squared_radius;
+        },
+        ids);
+  }
+
+  // Returns the ids of the k points nearest to the query, sorted by
+  // increasing distance, and optionally their squared distances.
+  void NearestPoints(const Eigen::Vector3d& query,
+                     const int k,
+                     std::vector<IdType>* ids,
+                     std::vector<double>* squared_distances = nullptr) const {
+    CHECK_NOTNULL(ids)->clear();
+    if (squared_distances != nullptr) {
+      squared_distances->clear();
+    }
+    if (root_ == nullptr || k <= 0) {
+      return;
+    }
+
+    // Nodes are visited in order of their distance to the query, and the
+    // search stops once the nearest node is farther than the kth point.
+    typedef std::pair<double, const Node*> NodeEntry;
+    std::priority_queue<NodeEntry,
+                        std::vector<NodeEntry>,
+                        std::greater<NodeEntry> >
+        nodes;
+    std::priority_queue<std::pair<double, IdType> > nearest;
+    nodes.emplace(root_->box.squaredExteriorDistance(query), root_.get());
+    while (!nodes.empty()) {
+      const NodeEntry entry = nodes.top();
+      nodes.pop();
+      if (nearest.size() == k && entry.first > nearest.top().first) {
+        break;
+      }
+      const Node* node = entry.second;
+      if (node->is_leaf) {
+        for (const auto& point : node->points) {
+          const double squared_distance = (point.second - query).squaredNorm();
+          if (nearest.size() < k) {
+            nearest.emplace(squared_distance, point.first);
+          } else if (squared_distance < nearest.top().first) {
+            nearest.pop();
+            nearest.emplace(squared_distance, point.first);
+          }
+        }
+        continue;
+      }
+      for (const auto& child : node->children) {
+        if (child != nullptr && child->num_points > 0) {
+          nodes.emplace(child->box.squaredExteriorDistance(query),
+                        child.get());
+        }
+      }
+    }
+
+    ids->resize(nearest.size());
+    if (squared_distances != nullptr) {
+      squared_distances->resize(nearest.size());
+    }
+    for (int i = nearest.size() - 1; i >= 0; i--) {
+      (*ids)[i] = nearest.top().second;
+      if (squared_distances != nullptr) {
+        (*squared_distances)[i] = nearest.top().first;
+      }
+      nearest.pop();
+    }
+  }
+
+  // Appends the ids of the points accepted by the point predicate within the
+  // nodes accepted by the node predicate. The node predicate receives the box
+  // of a node and must return true if the box may contain accepted points.
+  template <class NodePredicate, class PointPredicate>
+  void Search(const NodePredicate& node_predicate,
+              const PointPredicate& point_predicate,
+              std::vector<IdType>* ids) const {
+    CHECK_NOTNULL(ids);
+    if (root_ == nullptr) {
+      return;
+    }
+    std::vector<const Node*> nodes = {root_.get()};
+    while (!nodes.empty()) {
+      const Node* node = nodes.back();
+      nodes.pop_back();
+      if (node->num_points == 0 || !node_predicate(node->box)) {
+        continue;
+      }
+      if (node->is_leaf) {
+        for (const auto& point : node->points) {
+          if (point_predicate(point.first, point.second)) {
+            ids->emplace_back(point.first);
+          }
+        }
+        continue;
+      }
+      for (const auto& child : node->children) {
+        if (child != nullptr) {
+          nodes.emplace_back(child.get());
+        }
+      }
+    }
+  }
+
+ private:
+  struct Node {
+    Eigen::AlignedBox3d box;
+    // The number of points in the subtree.
+    int num_points = 0;
+    bool is_leaf = true;
+    // The points of a leaf.
+    std::vector<std::pair<IdType, Eigen::Vector3d> > points;
+    // The children of an inner node, which are created when a point is
+    // inserted into them. Child i covers the octant with the upper half of
+    // axis j if bit j of i is set.
+    std::unique_ptr<Node> children[8];
+  };
+
+  // Returns the index of the child octant of the box that contains the point.
+  static int ChildIndex(const Eigen::AlignedBox3d& box,
+                        const Eigen::Vector3d& position) {
+    const Eigen::Vector3d center = box.center();
+    return (position.x() >= center.x() ? 1 : 0) |
+           (position.y() >= center.y() ? 2 : 0) |
+           (position.z() >= center.z() ? 4 : 0);
+  }
+
+  static Eigen::AlignedBox3d ChildBox(const Eigen::AlignedBox3d& box,
+                                      const int child_index) {
+    const Eigen::Vector3d center = box.center();
+    Eigen::AlignedBox3d child_box = box;
+    for (int axis = 0; axis < 3; axis++) {
+      if (child_index & (1 << axis)) {
+        child_box.min()[axis] = center[axis];
+      } else {
+        child_box.max()[axis] = center[axis];
+      }
+    }
+    return child_box;
+  }
+
+  // Leaves whose box is too small to be split further within the precision of
+  // its coordinates hold any number of (nearly) identical points.
+  static bool CanSplit(const Eigen::AlignedBox3d& box) {
+    const double scale = std::max(box.min().cwiseAbs().maxCoeff(),
+                                  box.max().cwiseAbs().maxCoeff());
+    return box.sizes().minCoeff() >
+           64.0 * std::numeric_limits<double>::epsilon() * scale;
+  }
+
+  // Doubles the size of the root towards the position. The old root becomes a
+  // child of the new root.
+  void GrowRoot(const Eigen::Vector3d& position) {
+    const Eigen::Vector3d size = root_->box.sizes();
+    Eigen::AlignedBox3d box = root_->box;
+    int child_index = 0;
+    for (int axis = 0; axis < 3; axis++) {
+      if (position[axis] < root_->box.min()[axis]) {
+        box.min()[axis] -= size[axis];
+        child_index |= 1 << axis;
+      } else {
+        box.max()[axis] += size[axis];
+      }
+    }
+
+    std::unique_ptr<Node> new_root(new Node);
+    new_root->box = box;
+    new_root->num_points = root_->num_points;
+    new_root->is_leaf = false;
+    new_root->children[child_index] = std::move(root_);
+    root_ = std::move(new_root);
+  }
+
+  void InsertIntoNode(const IdType id,
+                      const Eigen::Vector3d& position,
+                      Node* node) {
+    while (!node->is_leaf) {
+      ++node->num_points;
+      const int child_index = ChildIndex(node->box, position);
+      std::unique_ptr<Node>& child = node->children[child_index];
+      if (child == nullptr) {
+        child.reset(new Node);
+        child->box = ChildBox(node->box, child_index);
+      }
+      node = child.get();
+    }
+
+    ++node->num_points;
+    node->points.emplace_back(id, position);
+    if (node->points.size() > max_points_per_leaf_ && CanSplit(node->box)) {
+      Split(node);
+    }
+  }
+
+  void Split(Node* node) {
+    std::vector<std::pair<IdType, Eigen::Vector3d> > points;
+    points.swap(node->points);
+    node->is_leaf = false;
+    node->num_points = 0;
+    for (const auto& point : points) {
+      InsertIntoNode(point.first, point.second, node);
+    }
+  }
+
+  // Removes the point from the subtree of the node and merges the subtree into
+  // a leaf once it holds few enough points.
+  void RemoveFromNode(const IdType id,
+                      const Eigen::Vector3d& position,
+                      Node* node) {
+    --node->num_points;
+    if (node->is_leaf) {
+      for (int i = 0; i < node->points.size(); i++) {
+        if (node->points[i].first == id) {
+          node->points[i] = node->points.back();
+          node->points.pop_back();
+          return;
+        }
+      }
+      LOG(FATAL) << "The point is not in the octree node that contains it.";
+    }
+
+    RemoveFromNode(
+        id, position, node->children[ChildIndex(node->box, position)].get());
+    if (node->num_points <= max_points_per_leaf_ / 2) {
+      Merge(node);
+    }
+  }
+
+  // Moves the points of the subtree into the node, which becomes a leaf.
+  void Merge(Node* node) {
+    std::vector<const Node*> nodes = {node};
+    std::vector<std::pair<IdType, Eigen::Vector3d> > points;
+    points.reserve(node->num_points);
+    while (!nodes.empty()) {
+      const Node* subtree_node = nodes.back();
+      nodes.pop_back();
+      points.insert(points.end(),
+                    subtree_node->points.begin(),
+                    subtree_node->points.end());
+      for (const auto& child : subtree_node->children) {
+        if (child != nullptr) {
+          nodes.emplace_back(child.get());
+        }
+      }
+    }
+    for (auto& child : node->children) {
+      child.reset();
+    }
+    node->points.swap(points);
+    node->is_leaf = true;
+  }
+
+  const int max_points_per_leaf_;
+  std::unique_ptr<Node> root_;
+  std::unordered_map<IdType, Eigen::Vector3d> positions_;
+};
+
+}  // namespace theia
+
+#endif  // THEIA_UTIL_POINT_OCTREE_H_
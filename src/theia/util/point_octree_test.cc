@@ -0,0 +1,153 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#include <Eigen/Core>
+#include <Eigen/Geometry>
+#include <algorithm>
+#include <unordered_map>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "theia/util/point_octree.h"
+#include "theia/util/random.h"
+
+namespace theia {
+
+namespace {
+
+std::vector<int> Sorted(std::vector<int> ids) {
+  std::sort(ids.begin(), ids.end());
+  return ids;
+}
+
+// Checks the queries of the octree against a linear scan of the points.
+void ExpectQueriesMatchLinearScan(
+    const PointOctree<int>& octree,
+    const std::unordered_map<int, Eigen::Vector3d>& points,
+    RandomNumberGenerator* rng) {
+  ASSERT_EQ(octree.Size(), points.size());
+  for (int trial = 0; trial < 10; trial++) {
+    const Eigen::Vector3d center = rng->RandVector3d(-10.0, 10.0);
+    const double radius = rng->RandDouble(0.5, 5.0);
+    const Eigen::AlignedBox3d box(center - Eigen::Vector3d::Constant(radius),
+                                  center + Eigen::Vector3d::Constant(radius));
+
+    std::vector<int> expected_in_box, expected_in_radius;
+    std::vector<std::pair<double, int> > distances;
+    for (const auto& point : points) {
+      if (box.contains(point.second)) {
+        expected_in_box.emplace_back(point.first);
+      }
+      const double squared_distance = (point.second - center).squaredNorm();
+      if (squared_distance <= radius * radius) {
+        expected_in_radius.emplace_back(point.first);
+      }
+      distances.emplace_back(squared_distance, point.first);
+    }
+    std::sort(distances.begin(), distances.end());
+
+    std::vector<int> in_box, in_radius;
+    octree.PointsInBox(box, &in_box);
+    octree.PointsInRadius(center, radius, &in_radius);
+    EXPECT_EQ(Sorted(in_box), Sorted(expected_in_box));
+    EXPECT_EQ(Sorted(in_radius), Sorted(expected_in_radius));
+
+    const int k = 7;
+    std::vector<int> nearest;
+    std::vector<double> squared_distances;
+    octree.NearestPoints(center, k, &nearest, &squared_distances);
+    ASSERT_EQ(nearest.size(), std::min<int>(k, points.size()));
+    for (int i = 0; i < nearest.size(); i++) {
+      EXPECT_DOUBLE_EQ(squared_distances[i], distances[i].first);
+      EXPECT_DOUBLE_EQ((points.at(nearest[i]) - center).squaredNorm(),
+                       distances[i].first);
+    }
+  }
+}
+
+}  // namespace
+
+TEST(PointOctree, QueriesMatchLinearScan) {
+  RandomNumberGenerator rng(52);
+  PointOctree<int> octree(8);
+  std::unordered_map<int, Eigen::Vector3d> points;
+  for (int i = 0; i < 2000; i++) {
+    points[i] = rng.RandVector3d(-10.0, 10.0);
+    octree.Insert(i, points[i]);
+  }
+  ExpectQueriesMatchLinearScan(octree, points, &rng);
+}
+
+TEST(PointOctree, MoveAndRemovePoints) {
+  RandomNumberGenerator rng(53);
+  PointOctree<int> octree(8);
+  std::unordered_map<int, Eigen::Vector3d> points;
+  for (int i = 0; i < 1000; i++) {
+    points[i] = rng.RandVector3d(-1.0, 1.0);
+    octree.Insert(i, points[i]);
+  }
+
+  // Moving points far outside of the root grows the tree.
+  for (int i = 0; i < 1000; i += 3) {
+    points[i] = rng.RandVector3d(-10.0, 10.0);
+    octree.Insert(i, points[i]);
+  }
+  ExpectQueriesMatchLinearScan(octree, points, &rng);
+
+  // Removing most points merges the leaves.
+  for (int i = 0; i < 1000; i++) {
+    if (i % 10 != 0) {
+      EXPECT_TRUE(octree.Remove(i));
+      points.erase(i);
+    }
+  }
+  EXPECT_FALSE(octree.Remove(1));
+  EXPECT_FALSE(octree.Contains(1));
+  EXPECT_TRUE(octree.Contains(10));
+  EXPECT_EQ(*octree.Position(10), points[10]);
+  ExpectQueriesMatchLinearScan(octree, points, &rng);
+}
+
+TEST(PointOctree, IdenticalPoints) {
+  PointOctree<int> octree(4);
+  for (int i = 0; i < 100; i++) {
+    octree.Insert(i, Eigen::Vector3d(1.0, 2.0, 3.0));
+  }
+  std::vector<int> ids;
+  octree.PointsInRadius(Eigen::Vector3d(1.0, 2.0, 3.0), 0.0, &ids);
+  EXPECT_EQ(ids.size(), 100);
+}
+
+}  // namespace theia
@@ -49,45 +49,80 @@ thread_local std::mt19937 util_generator;
 static std::mt19937 util_generator;
 #endif  // THEIA_HAS_THREAD_LOCAL_KEYWORD
 
+// Returns the key of the given stream of the seed.
+uint64_t StreamKey(const uint64_t seed_key, const uint64_t stream) {
+  return CounterRandomEngine::Mix(seed_key ^
+                                  CounterRandomEngine::Mix(stream + 1));
+}
+
 }  // namespace
 
-RandomNumberGenerator::RandomNumberGenerator() {
+RandomNumberGenerator::RandomNumberGenerator() : owns_stream_(false) {
   const unsigned seed =
       std::chrono::system_clock::now().time_since_epoch().count();
-  util_generator.seed(seed);
+  Seed(seed);
 }
 
-RandomNumberGenerator::RandomNumberGenerator(const unsigned seed) {
-  util_generator.seed(seed);
+RandomNumberGenerator::RandomNumberGenerator(const unsigned seed)
+    : owns_stream_(false) {
+  Seed(seed);
 }
 
+RandomNumberGenerator::RandomNumberGenerator(const unsigned seed,
+                                             const uint64_t stream)
+    : key_(CounterRandomEngine::Mix(seed)),
+      owns_stream_(true),
+      stream_(StreamKey(key_, stream)) {}
+
 void RandomNumberGenerator::Seed(const unsigned seed) {
-  util_generator.seed(seed);
+  key_ = CounterRandomEngine::Mix(seed);
+  if (owns_stream_) {
+    stream_ = CounterRandomEngine(key_);
+  } else {
+    util_generator.seed(seed);
+  }
+}
+
+std::shared_ptr<RandomNumberGenerator> RandomNumberGenerator::Split(
+    const uint64_t stream) const {
+  std::shared_ptr<RandomNumberGenerator> rng =
+      std::make_shared<RandomNumberGenerator>(*this);
+  rng->key_ = StreamKey(key_, stream);
+  rng->owns_stream_ = true;
+  rng->stream_ = CounterRandomEngine(rng->key_);
+  return rng;
+}
+
+template <typename Distribution>
+typename Distribution::result_type RandomNumberGenerator::Draw(
+    Distribution* distribution) {
+  return owns_stream_ ? (*distribution)(stream_)
+                      : (*distribution)(util_generator);
 }
 
 // Get a random double between lower and upper (inclusive).
 double RandomNumberGenerator::RandDouble(const double lower,
                                          const double upper) {
   std::uniform_real_distribution<double> distribution(lower, upper);
-  return distribution(util_generator);
+  return Draw(&distribution);
 }
 
 float RandomNumberGenerator::RandFloat(const float lower, const float upper) {
   std::uniform_real_distribution<float> distribution(lower, upper);
-  return distribution(util_generator);
+  return Draw(&distribution);
 }
 
 // Get a random int between lower and upper (inclusive).
 int RandomNumberGenerator::RandInt(const int lower, const int upper) {
   std::uniform_int_distribution<int> distribution(lower, upper);
-  return distribution(util_generator);
+  return Draw(&distribution);
 }
 
 // Gaussian Distribution with the corresponding mean and std dev.
 double RandomNumberGenerator::RandGaussian(const double mean,
                                            const double std_dev) {
   std::normal_distribution<double> distribution(mean, std_dev);
-  return distribution(util_generator);
+  return Draw(&distribution);
 }
 
 Eigen::Vector2d RandomNumberGenerator::RandVector2d(const double min,
@@ -36,13 +36,63 @@
 #define THEIA_UTIL_RANDOM_H_
 
 #include <Eigen/Core>
+#include <cstdint>
+#include <limits>
+#include <memory>
 #include <random>
 
 namespace theia {
 
+// A counter-based random engine: the i-th number of a stream is a hash of the
+// stream key and i (the SplitMix64 generator). Skipping ahead is free and
+// streams with different keys are independent, so a single seed can be split
+// into many streams without any shared state. Satisfies the C++11
+// UniformRandomBitGenerator requirements so that it can be used with the
+// std:: distributions.
+class CounterRandomEngine {
+ public:
+  typedef uint64_t result_type;
+
+  explicit CounterRandomEngine(const uint64_t key = 0)
+      : key_(key), counter_(0) {}
+
+  static constexpr result_type min() { return 0; }
+  static constexpr result_type max() {
+    return std::numeric_limits<result_type>::max();
+  }
+
+  result_type operator()() { return Mix(key_ + (++counter_) * kIncrement); }
+
+  // Skips the next num_values values of the stream.
+  void Discard(const uint64_t num_values) { counter_ += num_values; }
+
+  uint64_t key() const { return key_; }
+
+  // The SplitMix64 finalizer, a bijective hash of 64 bit values.
+  static uint64_t Mix(uint64_t value) {
+    value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    value = (value ^ (value >> 27)) * 0x94d049bb133111ebULL;
+    return value ^ (value >> 31);
+  }
+
+ private:
+  static const uint64_t kIncrement = 0x9e3779b97f4a7c15ULL;
+
+  uint64_t key_;
+  uint64_t counter_;
+};
+
 // A wrapper around the c++11 random generator utilities. This allows for a
 // thread-safe random number generator that may be easily instantiated and
 // passed around as an object.
+//
+// By default all generators draw from one engine per thread, so seeding any
+// generator seeds the numbers that all generators produce on that thread.
+// Generators returned by Split instead own an independent stream that is
+// derived from the seed and the stream id only. Giving each thread or task its
+// own split stream makes parallel code reproducible bit for bit regardless of
+// scheduling, without locking. A split stream must not be used by several
+// threads at the same time.
 class RandomNumberGenerator {
  public:
   // Creates the random number generator using the current time as the seed.
@@ -51,9 +101,18 @@ class RandomNumberGenerator {
   // Creates the random number generator using the given seed.
   explicit RandomNumberGenerator(const unsigned seed);
 
+  // Creates a generator that owns the stream with the given id of the seed.
+  // This is the same stream as RandomNumberGenerator(seed).Split(stream).
+  RandomNumberGenerator(const unsigned seed, const uint64_t stream);
+
   // Seeds the random number generator with the given value.
   void Seed(const unsigned seed);
 
+  // Returns a new generator that owns an independent stream. The stream only
+  // depends on the seed of this generator and the stream id, not on the
+  // numbers drawn so far, so this method may be called from several threads.
+  std::shared_ptr<RandomNumberGenerator> Split(const uint64_t stream) const;
+
   // Get a random double between lower and upper (inclusive).
   double RandDouble(const double lower, const double upper);
 
@@ -94,6 +153,16 @@ class RandomNumberGenerator {
       }
     }
   }
+
+ private:
+  // Draws from the stream of this generator or the engine of the thread.
+  template <typename Distribution>
+  typename Distribution::result_type Draw(Distribution* distribution);
+
+  // The key that the streams returned by Split are derived from.
+  uint64_t key_;
+  bool owns_stream_;
+  CounterRandomEngine stream_;
 };
 
 }  // namespace theia
@@ -0,0 +1,133 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#include "theia/util/random.h"
+
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace theia {
+
+namespace {
+
+std::vector<int> DrawInts(RandomNumberGenerator* rng, const int num_values) {
+  std::vector<int> values(num_values);
+  for (int i = 0; i < num_values; i++) {
+    values[i] = rng->RandInt(0, 1000000);
+  }
+  return values;
+}
+
+}  // namespace
+
+TEST(CounterRandomEngine, DiscardSkipsAhead) {
+  CounterRandomEngine engine1(42);
+  CounterRandomEngine engine2(42);
+  for (int i = 0; i < 10; i++) {
+    engine1();
+  }
+  engine2.Discard(10);
+  EXPECT_EQ(engine1(), engine2());
+}
+
+TEST(RandomNumberGenerator, SplitStreamsAreReproducible) {
+  const RandomNumberGenerator rng1(59);
+  const RandomNumberGenerator rng2(59);
+  RandomNumberGenerator rng3(59, 3);
+  EXPECT_EQ(DrawInts(rng1.Split(3).get(), 100),
+            DrawInts(rng2.Split(3).get(), 100));
+  EXPECT_EQ(DrawInts(rng1.Split(3).get(), 100), DrawInts(&rng3, 100));
+}
+
+TEST(RandomNumberGenerator, SplitStreamsDoNotDependOnDrawnNumbers) {
+  RandomNumberGenerator rng(59);
+  const std::vector<int> values = DrawInts(rng.Split(1).get(), 100);
+  DrawInts(&rng, 100);
+  EXPECT_EQ(DrawInts(rng.Split(1).get(), 100), values);
+}
+
+TEST(RandomNumberGenerator, DifferentStreamsAreDifferent) {
+  const RandomNumberGenerator rng(59);
+  EXPECT_NE(DrawInts(rng.Split(0).get(), 100),
+            DrawInts(rng.Split(1).get(), 100));
+  EXPECT_NE(DrawInts(rng.Split(0).get(), 100),
+            DrawInts(RandomNumberGenerator(61).Split(0).get(), 100));
+}
+
+TEST(RandomNumberGenerator, SplitStreamsOfSplitStreams) {
+  const RandomNumberGenerator rng(59);
+  const std::shared_ptr<RandomNumberGenerator> stream = rng.Split(0);
+  EXPECT_EQ(DrawInts(stream->Split(0).get(), 100),
+            DrawInts(rng.Split(0)->Split(0).get(), 100));
+  EXPECT_NE(DrawInts(stream->Split(0).get(), 100),
+            DrawInts(rng.Split(0).get(), 100));
+}
+
+TEST(RandomNumberGenerator, SplitStreamsAreIndependentOfThreads) {
+  static const int kNumThreads = 4;
+  static const int kNumValues = 1000;
+  const RandomNumberGenerator rng(59);
+
+  std::vector<std::vector<int> > values(kNumThreads);
+  std::vector<std::thread> threads;
+  for (int i = 0; i < kNumThreads; i++) {
+    threads.emplace_back([&, i]() {
+      values[i] = DrawInts(rng.Split(i).get(), kNumValues);
+    });
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+
+  for (int i = 0; i < kNumThreads; i++) {
+    EXPECT_EQ(values[i], DrawInts(rng.Split(i).get(), kNumValues));
+  }
+}
+
+TEST(RandomNumberGenerator, SplitStreamsRespectBounds) {
+  const std::shared_ptr<RandomNumberGenerator> rng =
+      RandomNumberGenerator(59).Split(0);
+  for (int i = 0; i < 1000; i++) {
+    const double value = rng->RandDouble(-2.0, 3.0);
+    EXPECT_GE(value, -2.0);
+    EXPECT_LE(value, 3.0);
+    const int int_value = rng->RandInt(-5, 5);
+    EXPECT_GE(int_value, -5);
+    EXPECT_LE(int_value, 5);
+  }
+}
+
+}  // namespace theia
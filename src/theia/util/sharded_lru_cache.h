@@ -0,0 +1,318 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#ifndef THEIA_UTIL_SHARDED_LRU_CACHE_H_
+#define THEIA_UTIL_SHARDED_LRU_CACHE_H_
+
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <functional>
+#include <future>  // NOLINT
+#include <list>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "theia/util/util.h"
+
+namespace theia {
+
+// A thread-safe LRU cache that splits the keys into shards with independent
+// locks so that threads fetching different keys rarely contend. Each shard
+// holds an equal part of the capacity and evicts its least recently used
+// entries once the total size of its entries exceeds that part.
+//
+// The size of an entry is given by the entry size function (e.g. the number of
+// bytes of an image) and is 1 if no function is given, in which case the
+// capacity is the maximum number of entries. Entries that are larger than the
+// capacity of a shard are returned but not cached.
+//
+// Cache misses are loaded with the fetch function without holding the lock of
+// the shard, so that different keys of the same shard may be loaded in
+// parallel. Concurrent fetches of a key that is being loaded wait for the
+// single load instead of loading the key again.
+template <class KeyType, class ValueType>
+class ShardedLRUCache {
+ public:
+  typedef std::function<ValueType(const KeyType&)> FetchEntryFunction;
+  typedef std::function<size_t(const ValueType&)> EntrySizeFunction;
+
+  static constexpr int kDefaultNumShards = 16;
+
+  // The number of shards is reduced if the capacity is smaller than the
+  // number of shards so that every shard can hold at least one entry.
+  ShardedLRUCache(const FetchEntryFunction& fetch_entry,
+                  const size_t capacity,
+                  const int num_shards = kDefaultNumShards,
+                  const EntrySizeFunction& entry_size = nullptr)
+      : fetch_entry_(fetch_entry),
+        entry_size_(entry_size),
+        capacity_(capacity),
+        num_cache_hits_(0),
+        num_cache_misses_(0),
+        num_deduplicated_loads_(0),
+        num_evictions_(0) {
+    CHECK(fetch_entry_ != nullptr);
+    CHECK_GT(capacity_, 0) << "The capacity of the cache must be positive.";
+    CHECK_GT(num_shards, 0) << "The cache must have at least one shard.";
+
+    const int num_used_shards =
+        static_cast<int>(std::min<size_t>(num_shards, capacity_));
+    shards_.reserve(num_used_shards);
+    for (int i = 0; i < num_used_shards; i++) {
+      shards_.emplace_back(new Shard);
+      // Distribute the remainder of the capacity over the first shards.
+      shards_.back()->capacity =
+          capacity_ / num_used_shards + (i < capacity_ % num_used_shards);
+    }
+  }
+
+  // Returns the value of the key, loading it with the fetch function on a
+  // cache miss. If another thread is loading the key, this waits for that load.
+  ValueType Fetch(const KeyType& key) {
+    Shard* shard = GetShard(key);
+    std::unique_lock<std::mutex> lock(shard->mutex);
+    auto it = shard->entries.find(key);
+    if (it != shard->entries.end()) {
+      ++num_cache_hits_;
+      MarkAsMostRecentlyUsed(it, shard);
+      return it->second.value;
+    }
+
+    const auto load_it = shard->pending_loads.find(key);
+    if (load_it != shard->pending_loads.end()) {
+      ++num_deduplicated_loads_;
+      // Copy the future so that the load may finish while we wait.
+      const std::shared_future<ValueType> pending_load = load_it->second;
+      lock.unlock();
+      return pending_load.get();
+    }
+
+    // Register the load so that concurrent fetches wait for it, then load the
+    // value without holding the lock.
+    ++num_cache_misses_;
+    std::promise<ValueType> promise;
+    shard->pending_loads.emplace(key, promise.get_future().share());
+    lock.unlock();
+
+    ValueType value;
+    try {
+      value = fetch_entry_(key);
+    } catch (...) {
+      // Waiting fetches receive the exception as well and later fetches
+      // retry the load.
+      lock.lock();
+      shard->pending_loads.erase(key);
+      lock.unlock();
+      promise.set_exception(std::current_exception());
+      throw;
+    }
+
+    lock.lock();
+    shard->pending_loads.erase(key);
+    // The key may have been inserted while it was loaded, in which case the
+    // inserted value is kept.
+    if (shard->entries.find(key) == shard->entries.end()) {
+      InsertIntoShard(key, value, shard);
+    }
+    lock.unlock();
+    promise.set_value(value);
+    return value;
+  }
+
+  // Returns true and sets the value if the key is in the cache. The key is not
+  // loaded on a miss.
+  bool Lookup(const KeyType& key, ValueType* value) {
+    Shard* shard = GetShard(key);
+    std::lock_guard<std::mutex> lock(shard->mutex);
+    auto it = shard->entries.find(key);
+    if (it == shard->entries.end()) {
+      return false;
+    }
+    MarkAsMostRecentlyUsed(it, shard);
+    *value = it->second.value;
+    return true;
+  }
+
+  // Inserts the key-value pair into the cache, replacing the value if the key
+  // is already in the cache.
+  void Insert(const KeyType& key, const ValueType& value) {
+    Shard* shard = GetShard(key);
+    std::lock_guard<std::mutex> lock(shard->mutex);
+    auto it = shard->entries.find(key);
+    if (it != shard->entries.end()) {
+      RemoveFromShard(it, shard);
+    }
+    InsertIntoShard(key, value, shard);
+  }
+
+  // Removes the key from the cache. Returns false if the key was not cached.
+  bool Erase(const KeyType& key) {
+    Shard* shard = GetShard(key);
+    std::lock_guard<std::mutex> lock(shard->mutex);
+    auto it = shard->entries.find(key);
+    if (it == shard->entries.end()) {
+      return false;
+    }
+    RemoveFromShard(it, shard);
+    return true;
+  }
+
+  // Removes all entries from the cache. Loads that are in flight are cached
+  // once they finish.
+  void Clear() {
+    for (const auto& shard : shards_) {
+      std::lock_guard<std::mutex> lock(shard->mutex);
+      shard->entries.clear();
+      shard->lru_order.clear();
+      shard->size = 0;
+    }
+  }
+
+  bool ExistsInCache(const KeyType& key) {
+    Shard* shard = GetShard(key);
+    std::lock_guard<std::mutex> lock(shard->mutex);
+    return shard->entries.find(key) != shard->entries.end();
+  }
+
+  // Various statistics for the cache. The size is the total size of the cached
+  // entries as given by the entry size function.
+  size_t Capacity() const { return capacity_; }
+  int NumShards() const { return shards_.size(); }
+  size_t Size() {
+    size_t size = 0;
+    for (const auto& shard : shards_) {
+      std::lock_guard<std::mutex> lock(shard->mutex);
+      size += shard->size;
+    }
+    return size;
+  }
+  int NumEntries() {
+    int num_entries = 0;
+    for (const auto& shard : shards_) {
+      std::lock_guard<std::mutex> lock(shard->mutex);
+      num_entries += shard->entries.size();
+    }
+    return num_entries;
+  }
+
+  // A cache miss is a fetch that loaded the key. Fetches that waited for the
+  // load of another fetch are counted as deduplicated loads instead.
+  int NumCacheHits() const { return num_cache_hits_; }
+  int NumCacheMisses() const { return num_cache_misses_; }
+  int NumDeduplicatedLoads() const { return num_deduplicated_loads_; }
+  int NumEvictions() const { return num_evictions_; }
+
+ private:
+  typedef std::list<KeyType> LRUList;
+
+  struct Entry {
+    ValueType value;
+    size_t size;
+    typename LRUList::iterator lru_position;
+  };
+
+  struct Shard {
+    std::mutex mutex;
+    std::unordered_map<KeyType, Entry> entries;
+    // The keys of the entries, from the least to the most recently used.
+    LRUList lru_order;
+    std::unordered_map<KeyType, std::shared_future<ValueType> > pending_loads;
+    size_t capacity = 0;
+    size_t size = 0;
+  };
+
+  typedef typename std::unordered_map<KeyType, Entry>::iterator EntryIterator;
+
+  Shard* GetShard(const KeyType& key) const {
+    return shards_[std::hash<KeyType>()(key) % shards_.size()].get();
+  }
+
+  // NOTE: The methods below are not thread-safe and must be called with the
+  // mutex of the shard locked.
+  void MarkAsMostRecentlyUsed(const EntryIterator& it, Shard* shard) {
+    shard->lru_order.splice(
+        shard->lru_order.end(), shard->lru_order, it->second.lru_position);
+  }
+
+  void InsertIntoShard(const KeyType& key,
+                       const ValueType& value,
+                       Shard* shard) {
+    const size_t size = entry_size_ == nullptr ? 1 : entry_size_(value);
+    if (size > shard->capacity) {
+      return;
+    }
+
+    while (shard->size + size > shard->capacity) {
+      ++num_evictions_;
+      RemoveFromShard(shard->entries.find(shard->lru_order.front()), shard);
+    }
+
+    Entry& entry = shard->entries[key];
+    entry.value = value;
+    entry.size = size;
+    entry.lru_position = shard->lru_order.insert(shard->lru_order.end(), key);
+    shard->size += size;
+  }
+
+  void RemoveFromShard(const EntryIterator& it, Shard* shard) {
+    shard->size -= it->second.size;
+    shard->lru_order.erase(it->second.lru_position);
+    shard->entries.erase(it);
+  }
+
+  const FetchEntryFunction fetch_entry_;
+  const EntrySizeFunction entry_size_;
+  const size_t capacity_;
+  std::vector<std::unique_ptr<Shard> > shards_;
+
+  std::atomic<int> num_cache_hits_;
+  std::atomic<int> num_cache_misses_;
+  std::atomic<int> num_deduplicated_loads_;
+  std::atomic<int> num_evictions_;
+
+  DISALLOW_COPY_AND_ASSIGN(ShardedLRUCache);
+};
+
+template <class KeyType, class ValueType>
+constexpr int ShardedLRUCache<KeyType, ValueType>::kDefaultNumShards;
+
+}  // namespace theia
+
+#endif  // THEIA_UTIL_SHARDED_LRU_CACHE_H_
@@ -0,0 +1,177 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#include "theia/util/sharded_lru_cache.h"
+
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <stdexcept>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace theia {
+
+namespace {
+
+int Square(const int& key) { return key * key; }
+
+}  // namespace
+
+TEST(ShardedLRUCache, FetchCountsHitsAndMisses) {
+  ShardedLRUCache<int, int> cache(Square, 10, 4);
+  EXPECT_EQ(cache.NumShards(), 4);
+  EXPECT_EQ(cache.Fetch(3), 9);
+  EXPECT_EQ(cache.Fetch(3), 9);
+  EXPECT_EQ(cache.Fetch(4), 16);
+  EXPECT_TRUE(cache.ExistsInCache(3));
+  EXPECT_EQ(cache.NumEntries(), 2);
+  EXPECT_EQ(cache.NumCacheMisses(), 2);
+  EXPECT_EQ(cache.NumCacheHits(), 1);
+}
+
+TEST(ShardedLRUCache, ReducesNumShardsToCapacity) {
+  ShardedLRUCache<int, int> cache(Square, 3, 16);
+  EXPECT_EQ(cache.NumShards(), 3);
+}
+
+TEST(ShardedLRUCache, EvictsLeastRecentlyUsedEntry) {
+  ShardedLRUCache<int, int> cache(Square, 3, 1);
+  cache.Fetch(0);
+  cache.Fetch(1);
+  cache.Fetch(2);
+  // Use key 0 so that key 1 is the least recently used entry.
+  cache.Fetch(0);
+  cache.Fetch(3);
+  EXPECT_TRUE(cache.ExistsInCache(0));
+  EXPECT_FALSE(cache.ExistsInCache(1));
+  EXPECT_TRUE(cache.ExistsInCache(2));
+  EXPECT_TRUE(cache.ExistsInCache(3));
+  EXPECT_EQ(cache.NumEvictions(), 1);
+}
+
+TEST(ShardedLRUCache, EvictsBySize) {
+  const auto fetch_string = [](const int& key) {
+    return std::string(key, 'a');
+  };
+  const auto string_size = [](const std::string& value) {
+    return value.size();
+  };
+  ShardedLRUCache<int, std::string> cache(fetch_string, 10, 1, string_size);
+  cache.Fetch(4);
+  cache.Fetch(5);
+  EXPECT_EQ(cache.Size(), 9);
+
+  // Both entries must be evicted to make room for the new entry.
+  cache.Fetch(8);
+  EXPECT_EQ(cache.Size(), 8);
+  EXPECT_EQ(cache.NumEntries(), 1);
+  EXPECT_EQ(cache.NumEvictions(), 2);
+
+  // Entries larger than the capacity are returned but not cached.
+  EXPECT_EQ(cache.Fetch(11).size(), 11);
+  EXPECT_FALSE(cache.ExistsInCache(11));
+  EXPECT_TRUE(cache.ExistsInCache(8));
+}
+
+TEST(ShardedLRUCache, InsertLookupAndErase) {
+  ShardedLRUCache<int, int> cache(Square, 10);
+  int value = 0;
+  EXPECT_FALSE(cache.Lookup(2, &value));
+  cache.Insert(2, 5);
+  EXPECT_TRUE(cache.Lookup(2, &value));
+  EXPECT_EQ(value, 5);
+  cache.Insert(2, 6);
+  EXPECT_EQ(cache.Fetch(2), 6);
+  EXPECT_EQ(cache.NumEntries(), 1);
+
+  EXPECT_TRUE(cache.Erase(2));
+  EXPECT_FALSE(cache.Erase(2));
+  EXPECT_EQ(cache.Fetch(2), 4);
+  cache.Clear();
+  EXPECT_EQ(cache.NumEntries(), 0);
+  EXPECT_EQ(cache.Size(), 0);
+}
+
+TEST(ShardedLRUCache, ConcurrentFetchesLoadEachKeyOnce) {
+  static const int kNumThreads = 8;
+  static const int kNumKeys = 4;
+  std::atomic<int> num_loads(0);
+  const auto slow_square = [&](const int& key) {
+    ++num_loads;
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    return key * key;
+  };
+  ShardedLRUCache<int, int> cache(slow_square, 100, 2);
+
+  std::vector<std::thread> threads;
+  std::atomic<int> num_errors(0);
+  for (int i = 0; i < kNumThreads; i++) {
+    threads.emplace_back([&]() {
+      for (int key = 0; key < kNumKeys; key++) {
+        if (cache.Fetch(key) != key * key) {
+          ++num_errors;
+        }
+      }
+    });
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+
+  EXPECT_EQ(num_errors, 0);
+  EXPECT_EQ(num_loads, kNumKeys);
+  EXPECT_EQ(cache.NumCacheMisses(), kNumKeys);
+  EXPECT_EQ(cache.NumCacheHits() + cache.NumDeduplicatedLoads(),
+            kNumThreads * kNumKeys - kNumKeys);
+}
+
+TEST(ShardedLRUCache, FailedLoadsAreRetried) {
+  bool fail = true;
+  const auto fetch = [&](const int& key) {
+    if (fail) {
+      throw std::runtime_error("load failed");
+    }
+    return key;
+  };
+  ShardedLRUCache<int, int> cache(fetch, 10);
+  EXPECT_THROW(cache.Fetch(1), std::runtime_error);
+  EXPECT_FALSE(cache.ExistsInCache(1));
+  fail = false;
+  EXPECT_EQ(cache.Fetch(1), 1);
+}
+
+}  // namespace theia
@@ -0,0 +1,341 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+#ifndef THEIA_UTIL_SLOT_MAP_H_
+#define THEIA_UTIL_SLOT_MAP_H_
+
+#include <Eigen/Core>
+#include <cereal/cereal.hpp>
+#include <glog/logging.h>
+
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace theia {
+
+// A map from integer ids to values that stores the values in contiguous slots
+// instead of one heap node per value like std::unordered_map. The values live
+// in fixed-size chunks of slots and an id is mapped to its slot with a vector
+// indexed by the id, so a lookup is two array accesses. The slots of erased
+// values are reused by later insertions.
+//
+// Values are only constructed in the slots they are inserted into and are
+// destroyed when they are erased, so unused slots cost no more than their raw
+// memory.
+//
+// Ids never change and pointers to a value stay valid until the value is
+// erased, as with std::unordered_map. The id index has one entry per id up to
+// the largest id, so the ids should be dense (e.g., assigned from a counter).
+// The largest value of Key is reserved as an invalid id.
+//
+// Iteration visits the values in slot order and yields (id, value reference)
+// pairs by value, e.g.:
+//
+//   for (const auto& entry : slot_map) {
+//     Use(entry.first, entry.second);
+//   }
+template <typename Key, typename Value>
+class SlotMap {
+  static_assert(std::is_integral<Key>::value && std::is_unsigned<Key>::value,
+                "SlotMap ids must be unsigned integers.");
+
+ public:
+  template <bool kIsConst>
+  class Iterator {
+   public:
+    typedef std::forward_iterator_tag iterator_category;
+    typedef typename std::conditional<kIsConst, const SlotMap, SlotMap>::type
+        Container;
+    typedef typename std::conditional<kIsConst, const Value, Value>::type
+        MappedType;
+    typedef std::pair<const Key, MappedType&> value_type;
+    typedef value_type reference;
+    typedef std::ptrdiff_t difference_type;
+    typedef void pointer;
+
+    Iterator(Container* map, const uint32_t slot) : map_(map), slot_(slot) {
+      SkipFreeSlots();
+    }
+
+    reference operator*() const {
+      return reference(map_->slot_keys_[slot_], map_->SlotValue(slot_));
+    }
+
+    Iterator& operator++() {
+      ++slot_;
+      SkipFreeSlots();
+      return *this;
+    }
+
+    bool operator==(const Iterator& other) const {
+      return slot_ == other.slot_;
+    }
+    bool operator!=(const Iterator& other) const {
+      return slot_ != other.slot_;
+    }
+
+   private:
+    void SkipFreeSlots() {
+      while (slot_ < map_->slot_keys_.size() &&
+             map_->slot_keys_[slot_] == kInvalidKey) {
+        ++slot_;
+      }
+    }
+
+    Container* map_;
+    uint32_t slot_;
+  };
+
+  typedef Iterator<false> iterator;
+  typedef Iterator<true> const_iterator;
+
+  SlotMap() : size_(0) {}
+  SlotMap(const SlotMap& other) : size_(0) { *this = other; }
+  SlotMap(SlotMap&& other) : size_(0) { *this = std::move(other); }
+  ~SlotMap() { DestroyValues(); }
+
+  SlotMap& operator=(const SlotMap& other) {
+    if (this == &other) {
+      return *this;
+    }
+    clear();
+    chunks_.reserve(other.chunks_.size());
+    for (size_t i = 0; i < other.chunks_.size(); i++) {
+      AddChunk();
+    }
+    // Only the slots that hold a value are copied.
+    for (uint32_t slot = 0; slot < other.slot_keys_.size(); slot++) {
+      if (other.slot_keys_[slot] != kInvalidKey) {
+        new (SlotAddress(slot)) Value(other.SlotValue(slot));
+      }
+    }
+    slot_keys_ = other.slot_keys_;
+    key_to_slot_ = other.key_to_slot_;
+    free_slots_ = other.free_slots_;
+    size_ = other.size_;
+    return *this;
+  }
+
+  // The values are not moved since the chunks change owner.
+  SlotMap& operator=(SlotMap&& other) {
+    if (this == &other) {
+      return *this;
+    }
+    clear();
+    chunks_.swap(other.chunks_);
+    slot_keys_.swap(other.slot_keys_);
+    key_to_slot_.swap(other.key_to_slot_);
+    free_slots_.swap(other.free_slots_);
+    std::swap(size_, other.size_);
+    return *this;
+  }
+
+  size_t size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+
+  void clear() {
+    DestroyValues();
+    chunks_.clear();
+    slot_keys_.clear();
+    key_to_slot_.clear();
+    free_slots_.clear();
+    size_ = 0;
+  }
+
+  // Reserves the bookkeeping for num_values values with ids below num_values.
+  void reserve(const size_t num_values) {
+    slot_keys_.reserve(num_values);
+    key_to_slot_.reserve(num_values);
+  }
+
+  bool Contains(const Key key) const { return FindSlot(key) != kNoSlot; }
+
+  // Returns the value of the id or nullptr if the map does not contain it.
+  const Value* Find(const Key key) const {
+    const uint32_t slot = FindSlot(key);
+    return slot == kNoSlot ? nullptr : &SlotValue(slot);
+  }
+  Value* Find(const Key key) {
+    const uint32_t slot = FindSlot(key);
+    return slot == kNoSlot ? nullptr : &SlotValue(slot);
+  }
+
+  // Inserts the value under the id and returns a pointer to the stored value,
+  // or returns nullptr and leaves the map unchanged if the id is present.
+  Value* Insert(const Key key, Value value) {
+    CHECK_NE(key, kInvalidKey) << "The largest id is reserved.";
+    if (Contains(key)) {
+      return nullptr;
+    }
+    if (key >= key_to_slot_.size()) {
+      key_to_slot_.resize(static_cast<size_t>(key) + 1, kNoSlot);
+    }
+
+    uint32_t slot;
+    if (!free_slots_.empty()) {
+      slot = free_slots_.back();
+      free_slots_.pop_back();
+    } else {
+      slot = slot_keys_.size();
+      CHECK_LT(slot, kNoSlot) << "SlotMap capacity exceeded.";
+      if (slot % kChunkSize == 0) {
+        AddChunk();
+      }
+      slot_keys_.emplace_back(kInvalidKey);
+    }
+
+    Value* stored_value = new (SlotAddress(slot)) Value(std::move(value));
+    slot_keys_[slot] = key;
+    key_to_slot_[key] = slot;
+    ++size_;
+    return stored_value;
+  }
+
+  // Erases the value of the id. Returns false if the map does not contain it.
+  bool Erase(const Key key) {
+    const uint32_t slot = FindSlot(key);
+    if (slot == kNoSlot) {
+      return false;
+    }
+    SlotValue(slot).~Value();
+    slot_keys_[slot] = kInvalidKey;
+    key_to_slot_[key] = kNoSlot;
+    free_slots_.emplace_back(slot);
+    --size_;
+    return true;
+  }
+
+  iterator begin() { return iterator(this, 0); }
+  iterator end() { return iterator(this, slot_keys_.size()); }
+  const_iterator begin() const { return const_iterator(this, 0); }
+  const_iterator end() const { return const_iterator(this, slot_keys_.size()); }
+
+ private:
+  static const uint32_t kChunkSize = 256;
+  static const Key kInvalidKey = std::numeric_limits<Key>::max();
+  static const uint32_t kNoSlot = std::numeric_limits<uint32_t>::max();
+
+  uint32_t FindSlot(const Key key) const {
+    return key < key_to_slot_.size() ? key_to_slot_[key] : kNoSlot;
+  }
+
+  // Uninitialized memory for a value.
+  typedef typename std::aligned_storage<sizeof(Value), alignof(Value)>::type
+      Slot;
+
+  // The chunks are allocated with the alignment of Eigen, which the values may
+  // need for their fixed-size Eigen members.
+  struct ChunkDeleter {
+    void operator()(Slot* chunk) const {
+      Eigen::aligned_allocator<Slot>().deallocate(chunk, kChunkSize);
+    }
+  };
+
+  void AddChunk() {
+    chunks_.emplace_back(Eigen::aligned_allocator<Slot>().allocate(kChunkSize));
+  }
+
+  void* SlotAddress(const uint32_t slot) {
+    return &chunks_[slot / kChunkSize][slot % kChunkSize];
+  }
+  Value& SlotValue(const uint32_t slot) {
+    return *reinterpret_cast<Value*>(
+        &chunks_[slot / kChunkSize][slot % kChunkSize]);
+  }
+  const Value& SlotValue(const uint32_t slot) const {
+    return *reinterpret_cast<const Value*>(
+        &chunks_[slot / kChunkSize][slot % kChunkSize]);
+  }
+
+  // Destroys the values in the slots that hold one. The bookkeeping is left
+  // untouched.
+  void DestroyValues() {
+    for (uint32_t slot = 0; slot < slot_keys_.size(); slot++) {
+      if (slot_keys_[slot] != kInvalidKey) {
+        SlotValue(slot).~Value();
+      }
+    }
+  }
+
+  // The memory of the values in chunks of kChunkSize slots. A value is only
+  // constructed while its slot is in use. Chunks are never moved or freed until
+  // the map is cleared, which keeps pointers to the values valid.
+  std::vector<std::unique_ptr<Slot[], ChunkDeleter> > chunks_;
+  // The id of the value in each slot or kInvalidKey if the slot is free.
+  std::vector<Key> slot_keys_;
+  // The slot of each id or kNoSlot if the map does not contain the id.
+  std::vector<uint32_t> key_to_slot_;
+  std::vector<uint32_t> free_slots_;
+  size_t size_;
+};
+
+template <typename Key, typename Value>
+const uint32_t SlotMap<Key, Value>::kChunkSize;
+template <typename Key, typename Value>
+const Key SlotMap<Key, Value>::kInvalidKey;
+template <typename Key, typename Value>
+const uint32_t SlotMap<Key, Value>::kNoSlot;
+
+// Cereal serialization in the same format as std::unordered_map so that
+// archives written with either container can be read with the other.
+template <class Archive, typename Key, typename Value>
+void save(Archive& ar, const SlotMap<Key, Value>& map) {  // NOLINT
+  ar(cereal::make_size_tag(static_cast<cereal::size_type>(map.size())));
+  for (const auto& entry : map) {
+    ar(cereal::make_map_item(entry.first, entry.second));
+  }
+}
+
+template <class Archive, typename Key, typename Value>
+void load(Archive& ar, SlotMap<Key, Value>& map) {  // NOLINT
+  cereal::size_type size;
+  ar(cereal::make_size_tag(size));
+  map.clear();
+  map.reserve(size);
+  for (cereal::size_type i = 0; i < size; i++) {
+    Key key;
+    Value value;
+    ar(cereal::make_map_item(key, value));
+    map.Insert(key, std::move(value));
+  }
+}
+
+}  // namespace theia
+
+#endif  // THEIA_UTIL_SLOT_MAP_H_
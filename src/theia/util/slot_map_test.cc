@@ -0,0 +1,202 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+#include "theia/util/slot_map.h"
+
+#include <cereal/archives/portable_binary.hpp>
+#include <cereal/types/string.hpp>
+#include <cereal/types/unordered_map.hpp>
+
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "gtest/gtest.h"
+
+namespace theia {
+
+TEST(SlotMap, InsertFindAndErase) {
+  SlotMap<uint32_t, std::string> map;
+  EXPECT_TRUE(map.empty());
+  EXPECT_EQ(map.Find(0), nullptr);
+
+  EXPECT_EQ(*map.Insert(0, "zero"), "zero");
+  EXPECT_EQ(*map.Insert(2, "two"), "two");
+  EXPECT_EQ(map.Insert(2, "other"), nullptr);
+  EXPECT_EQ(map.size(), 2);
+  EXPECT_TRUE(map.Contains(0));
+  EXPECT_FALSE(map.Contains(1));
+  EXPECT_EQ(*map.Find(2), "two");
+  EXPECT_EQ(map.Find(100), nullptr);
+
+  EXPECT_TRUE(map.Erase(0));
+  EXPECT_FALSE(map.Erase(0));
+  EXPECT_FALSE(map.Contains(0));
+  EXPECT_EQ(map.size(), 1);
+  EXPECT_EQ(*map.Find(2), "two");
+}
+
+TEST(SlotMap, PointersAreStable) {
+  SlotMap<uint32_t, int> map;
+  const int* first = map.Insert(0, 0);
+  for (int i = 1; i < 10000; i++) {
+    map.Insert(i, i);
+  }
+  for (int i = 1; i < 10000; i += 2) {
+    map.Erase(i);
+  }
+  for (int i = 10000; i < 15000; i++) {
+    map.Insert(i, i);
+  }
+  EXPECT_EQ(map.Find(0), first);
+  EXPECT_EQ(map.size(), 10000);
+  for (int i = 0; i < 15000; i++) {
+    const int* value = map.Find(i);
+    if (i < 10000 && i % 2 == 1) {
+      EXPECT_EQ(value, nullptr);
+    } else {
+      ASSERT_NE(value, nullptr);
+      EXPECT_EQ(*value, i);
+    }
+  }
+}
+
+TEST(SlotMap, Iteration) {
+  SlotMap<uint32_t, int> map;
+  std::unordered_map<uint32_t, int> expected;
+  for (int i = 0; i < 1000; i++) {
+    map.Insert(i, 2 * i);
+    expected[i] = 2 * i;
+  }
+  for (int i = 0; i < 1000; i += 3) {
+    map.Erase(i);
+    expected.erase(i);
+  }
+
+  std::unordered_map<uint32_t, int> visited;
+  for (const auto& entry : map) {
+    visited[entry.first] = entry.second;
+  }
+  EXPECT_EQ(visited, expected);
+
+  // Values may be modified through the iterator.
+  for (auto entry : map) {
+    entry.second += 1;
+  }
+  EXPECT_EQ(*map.Find(1), 3);
+}
+
+TEST(SlotMap, Copy) {
+  SlotMap<uint32_t, std::string> map;
+  map.Insert(1, "one");
+  map.Insert(300, "three hundred");
+  SlotMap<uint32_t, std::string> copy = map;
+  map.Erase(1);
+  EXPECT_EQ(copy.size(), 2);
+  EXPECT_EQ(*copy.Find(1), "one");
+  EXPECT_EQ(*copy.Find(300), "three hundred");
+}
+
+namespace {
+
+// Counts the instances that are alive.
+struct CountedValue {
+  static int num_instances;
+
+  CountedValue() { ++num_instances; }
+  CountedValue(const CountedValue&) { ++num_instances; }
+  CountedValue(CountedValue&&) { ++num_instances; }
+  ~CountedValue() { --num_instances; }
+};
+
+int CountedValue::num_instances = 0;
+
+}  // namespace
+
+// Only the inserted values are alive, including in copies of the map.
+TEST(SlotMap, ConstructsOnlyInsertedValues) {
+  {
+    SlotMap<uint32_t, CountedValue> map;
+    for (uint32_t i = 0; i < 10; i++) {
+      map.Insert(i, CountedValue());
+    }
+    EXPECT_EQ(CountedValue::num_instances, 10);
+    map.Erase(3);
+    map.Erase(4);
+    EXPECT_EQ(CountedValue::num_instances, 8);
+
+    SlotMap<uint32_t, CountedValue> copy = map;
+    EXPECT_EQ(CountedValue::num_instances, 16);
+    SlotMap<uint32_t, CountedValue> moved = std::move(copy);
+    EXPECT_EQ(CountedValue::num_instances, 16);
+    moved.clear();
+    EXPECT_EQ(CountedValue::num_instances, 8);
+    moved = map;
+    map = std::move(moved);
+    EXPECT_EQ(CountedValue::num_instances, 8);
+  }
+  EXPECT_EQ(CountedValue::num_instances, 0);
+}
+
+// The serialization is compatible with std::unordered_map in both directions.
+TEST(SlotMap, SerializationMatchesUnorderedMap) {
+  std::unordered_map<uint32_t, std::string> unordered_map = {
+      {0, "zero"}, {5, "five"}, {7, "seven"}};
+  std::stringstream stream;
+  {
+    cereal::PortableBinaryOutputArchive output_archive(stream);
+    output_archive(unordered_map);
+  }
+  SlotMap<uint32_t, std::string> map;
+  {
+    cereal::PortableBinaryInputArchive input_archive(stream);
+    input_archive(map);
+  }
+  EXPECT_EQ(map.size(), 3);
+  EXPECT_EQ(*map.Find(5), "five");
+
+  std::stringstream stream2;
+  {
+    cereal::PortableBinaryOutputArchive output_archive(stream2);
+    output_archive(map);
+  }
+  std::unordered_map<uint32_t, std::string> unordered_map2;
+  {
+    cereal::PortableBinaryInputArchive input_archive(stream2);
+    input_archive(unordered_map2);
+  }
+  EXPECT_EQ(unordered_map2, unordered_map);
+}
+
+}  // namespace theia
@@ -0,0 +1,193 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+#ifndef THEIA_UTIL_SMALL_VECTOR_H_
+#define THEIA_UTIL_SMALL_VECTOR_H_
+
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <initializer_list>
+#include <limits>
+#include <type_traits>
+#include <utility>
+
+namespace theia {
+
+// A vector of trivially copyable elements that stores up to kInlineCapacity
+// elements inside the object and only allocates memory for larger sizes. The
+// inline elements share their storage with the heap pointer, so e.g. a
+// SmallVector<uint32_t, 4> is as large as a std::vector but needs no
+// allocation for up to 4 elements. This is meant for the many short lists of
+// an SfM problem, such as the views observing a track. Only the part of the
+// std::vector interface needed by FlatSet is provided.
+template <typename T, int kInlineCapacity>
+class SmallVector {
+  static_assert(std::is_trivially_copyable<T>::value,
+                "SmallVector elements must be trivially copyable.");
+  static_assert(kInlineCapacity > 0, "The inline capacity must be positive.");
+
+ public:
+  typedef T value_type;
+  typedef T* iterator;
+  typedef const T* const_iterator;
+
+  SmallVector() : size_(0), capacity_(kInlineCapacity) {}
+  SmallVector(std::initializer_list<T> values) : SmallVector() {
+    reserve(values.size());
+    for (const T& value : values) {
+      data()[size_++] = value;
+    }
+  }
+  SmallVector(const SmallVector& other) : SmallVector() { *this = other; }
+  SmallVector(SmallVector&& other) : SmallVector() {
+    *this = std::move(other);
+  }
+  ~SmallVector() { Deallocate(); }
+
+  SmallVector& operator=(const SmallVector& other) {
+    if (this != &other) {
+      clear();
+      reserve(other.size_);
+      std::memcpy(data(), other.data(), other.size_ * sizeof(T));
+      size_ = other.size_;
+    }
+    return *this;
+  }
+
+  SmallVector& operator=(SmallVector&& other) {
+    if (this == &other) {
+      return *this;
+    }
+    if (other.IsInline()) {
+      *this = static_cast<const SmallVector&>(other);
+      other.clear();
+      return *this;
+    }
+    // Take over the allocation of other.
+    Deallocate();
+    storage_.heap = other.storage_.heap;
+    size_ = other.size_;
+    capacity_ = other.capacity_;
+    other.size_ = 0;
+    other.capacity_ = kInlineCapacity;
+    return *this;
+  }
+
+  size_t size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+  size_t capacity() const { return capacity_; }
+  void clear() { size_ = 0; }
+
+  void reserve(const size_t capacity) {
+    if (capacity <= capacity_) {
+      return;
+    }
+    CHECK_LE(capacity, std::numeric_limits<uint32_t>::max());
+    T* heap = static_cast<T*>(std::malloc(capacity * sizeof(T)));
+    CHECK_NOTNULL(heap);
+    std::memcpy(heap, data(), size_ * sizeof(T));
+    Deallocate();
+    storage_.heap = heap;
+    capacity_ = capacity;
+  }
+
+  T* data() { return IsInline() ? storage_.values : storage_.heap; }
+  const T* data() const {
+    return IsInline() ? storage_.values : storage_.heap;
+  }
+
+  T& operator[](const size_t i) { return data()[i]; }
+  const T& operator[](const size_t i) const { return data()[i]; }
+
+  iterator begin() { return data(); }
+  iterator end() { return data() + size_; }
+  const_iterator begin() const { return data(); }
+  const_iterator end() const { return data() + size_; }
+
+  void push_back(const T& value) { insert(end(), value); }
+
+  // Inserts the value before position and returns an iterator to it.
+  iterator insert(const_iterator position, const T& value) {
+    const size_t index = position - data();
+    if (size_ == capacity_) {
+      reserve(2 * capacity_);
+    }
+    T* values = data();
+    std::memmove(
+        values + index + 1, values + index, (size_ - index) * sizeof(T));
+    values[index] = value;
+    ++size_;
+    return values + index;
+  }
+
+  // Erases the element at position and returns an iterator to the element
+  // after it.
+  iterator erase(const_iterator position) {
+    const size_t index = position - data();
+    T* values = data();
+    std::memmove(
+        values + index, values + index + 1, (size_ - index - 1) * sizeof(T));
+    --size_;
+    return values + index;
+  }
+
+  bool operator==(const SmallVector& other) const {
+    return size_ == other.size_ && std::equal(begin(), end(), other.begin());
+  }
+  bool operator!=(const SmallVector& other) const { return !(*this == other); }
+
+ private:
+  bool IsInline() const { return capacity_ == kInlineCapacity; }
+
+  void Deallocate() {
+    if (!IsInline()) {
+      std::free(storage_.heap);
+      capacity_ = kInlineCapacity;
+    }
+  }
+
+  uint32_t size_;
+  uint32_t capacity_;
+  union Storage {
+    T* heap;
+    T values[kInlineCapacity];
+  } storage_;
+};
+
+}  // namespace theia
+
+#endif  // THEIA_UTIL_SMALL_VECTOR_H_
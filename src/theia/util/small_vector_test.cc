@@ -0,0 +1,101 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#include "theia/util/small_vector.h"
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include "gtest/gtest.h"
+
+#include "theia/util/flat_set.h"
+
+namespace theia {
+
+TEST(SmallVector, GrowsBeyondInlineCapacity) {
+  SmallVector<int, 2> vector;
+  EXPECT_TRUE(vector.empty());
+  EXPECT_EQ(vector.capacity(), 2);
+  for (int i = 0; i < 10; i++) {
+    vector.push_back(i);
+  }
+  EXPECT_EQ(vector.size(), 10);
+  EXPECT_GE(vector.capacity(), 10);
+  for (int i = 0; i < 10; i++) {
+    EXPECT_EQ(vector[i], i);
+  }
+}
+
+TEST(SmallVector, InsertAndErase) {
+  SmallVector<int, 4> vector = {1, 3, 5};
+  vector.insert(vector.begin() + 1, 2);
+  vector.insert(vector.end(), 6);
+  EXPECT_EQ(std::vector<int>(vector.begin(), vector.end()),
+            std::vector<int>({1, 2, 3, 5, 6}));
+
+  vector.erase(vector.begin());
+  vector.erase(vector.begin() + 2);
+  EXPECT_EQ(vector, (SmallVector<int, 4>({2, 3, 6})));
+}
+
+TEST(SmallVector, CopyAndMove) {
+  SmallVector<int, 2> inline_vector = {1, 2};
+  SmallVector<int, 2> heap_vector = {1, 2, 3, 4};
+
+  SmallVector<int, 2> copy = heap_vector;
+  EXPECT_EQ(copy, heap_vector);
+  copy = inline_vector;
+  EXPECT_EQ(copy, inline_vector);
+
+  SmallVector<int, 2> moved = std::move(heap_vector);
+  EXPECT_EQ(moved, (SmallVector<int, 2>({1, 2, 3, 4})));
+  EXPECT_TRUE(heap_vector.empty());
+  moved = std::move(inline_vector);
+  EXPECT_EQ(moved, (SmallVector<int, 2>({1, 2})));
+  EXPECT_TRUE(inline_vector.empty());
+}
+
+TEST(SmallVector, FlatSetStorage) {
+  FlatSet<uint32_t, SmallVector<uint32_t, 4> > set;
+  for (const uint32_t value : {7, 3, 9, 1, 5, 3}) {
+    set.insert(value);
+  }
+  EXPECT_EQ(set.size(), 5);
+  EXPECT_EQ(std::vector<uint32_t>(set.begin(), set.end()),
+            std::vector<uint32_t>({1, 3, 5, 7, 9}));
+  EXPECT_EQ(set.erase(5), 1);
+  EXPECT_EQ(set.count(5), 0);
+}
+
+}  // namespace theia
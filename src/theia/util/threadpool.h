@@ -63,6 +63,7 @@
 
 #include <glog/logging.h>
 
+#include <algorithm>
 #include <chrono>
 #include <condition_variable>
 #include <deque>
@@ -130,6 +131,37 @@ auto ThreadPool::Add(F&& f, Args&&... args)
   return res;
 }
 
+// Splits the range [0, num_items) into at most num_blocks contiguous blocks of
+// similar size and calls function(block_start, block_end) for each block on
+// the threads of the threadpool. Returns once all blocks are processed. If the
+// threadpool is null the whole range is processed on the calling thread.
+template <class F>
+void ParallelFor(ThreadPool* thread_pool,
+                 const int num_items,
+                 const int num_blocks,
+                 const F& function) {
+  CHECK_GT(num_blocks, 0);
+  if (num_items <= 0) {
+    return;
+  }
+  if (thread_pool == nullptr || num_blocks == 1) {
+    function(0, num_items);
+    return;
+  }
+
+  const int block_size = (num_items + num_blocks - 1) / num_blocks;
+  std::vector<std::future<void> > blocks;
+  blocks.reserve(num_blocks);
+  for (int start = 0; start < num_items; start += block_size) {
+    const int end = std::min(start + block_size, num_items);
+    blocks.emplace_back(
+        thread_pool->Add([&function, start, end]() { function(start, end); }));
+  }
+  for (std::future<void>& block : blocks) {
+    block.get();
+  }
+}
+
 }  // namespace theia
 
 #endif  // THEIA_UTIL_THREADPOOL_H_
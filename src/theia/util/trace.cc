@@ -0,0 +1,224 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#include "theia/util/trace.h"
+
+#include <glog/logging.h>
+
+#include <chrono>  // NOLINT
+#include <fstream>  // NOLINT
+#include <memory>
+#include <mutex>  // NOLINT
+#include <sstream>  // NOLINT
+#include <string>
+#include <thread>  // NOLINT
+#include <unordered_map>
+#include <vector>
+
+#include "theia/util/json.h"
+
+namespace theia {
+namespace {
+
+struct Span {
+  const char* name;
+  int64_t start_time_us;
+  int64_t duration_us;
+};
+
+// The spans recorded by one thread. The mutex is only contended while the
+// spans are exported or cleared.
+struct ThreadBuffer {
+  std::mutex mutex;
+  int thread_index;
+  std::string thread_name;
+  std::vector<Span> spans;
+};
+
+// The buffers of all threads that recorded a span. Buffers are kept after their
+// thread exits so that its spans can still be exported.
+struct ThreadBufferRegistry {
+  std::mutex mutex;
+  std::vector<std::shared_ptr<ThreadBuffer> > buffers;
+#ifndef THEIA_HAS_THREAD_LOCAL_KEYWORD
+  std::unordered_map<std::thread::id, std::shared_ptr<ThreadBuffer> >
+      thread_buffers;
+#endif  // THEIA_HAS_THREAD_LOCAL_KEYWORD
+};
+
+ThreadBufferRegistry& GetRegistry() {
+  static ThreadBufferRegistry* registry = new ThreadBufferRegistry();
+  return *registry;
+}
+
+std::shared_ptr<ThreadBuffer> CreateThreadBuffer(
+    ThreadBufferRegistry* registry) {
+  std::shared_ptr<ThreadBuffer> buffer = std::make_shared<ThreadBuffer>();
+  buffer->thread_index = registry->buffers.size();
+  registry->buffers.emplace_back(buffer);
+  return buffer;
+}
+
+ThreadBuffer* GetThreadBuffer() {
+#ifdef THEIA_HAS_THREAD_LOCAL_KEYWORD
+  thread_local std::shared_ptr<ThreadBuffer> thread_buffer;
+  if (thread_buffer == nullptr) {
+    ThreadBufferRegistry& registry = GetRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    thread_buffer = CreateThreadBuffer(&registry);
+  }
+  return thread_buffer.get();
+#else
+  ThreadBufferRegistry& registry = GetRegistry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  std::shared_ptr<ThreadBuffer>& thread_buffer =
+      registry.thread_buffers[std::this_thread::get_id()];
+  if (thread_buffer == nullptr) {
+    thread_buffer = CreateThreadBuffer(&registry);
+  }
+  return thread_buffer.get();
+#endif  // THEIA_HAS_THREAD_LOCAL_KEYWORD
+}
+
+std::string ToJsonString(const std::string& str) {
+  return nlohmann::json(str).dump();
+}
+
+}  // namespace
+
+std::atomic<bool> Tracer::is_enabled_(false);
+
+void Tracer::Enable() {
+  // Start the clock so that the first span does not pay for it.
+  NowInMicroseconds();
+  is_enabled_.store(true, std::memory_order_relaxed);
+}
+
+void Tracer::Disable() { is_enabled_.store(false, std::memory_order_relaxed); }
+
+void Tracer::Clear() {
+  ThreadBufferRegistry& registry = GetRegistry();
+  std::lock_guard<std::mutex> registry_lock(registry.mutex);
+  for (const auto& buffer : registry.buffers) {
+    std::lock_guard<std::mutex> lock(buffer->mutex);
+    buffer->spans.clear();
+  }
+}
+
+int Tracer::NumSpans() {
+  ThreadBufferRegistry& registry = GetRegistry();
+  std::lock_guard<std::mutex> registry_lock(registry.mutex);
+  int num_spans = 0;
+  for (const auto& buffer : registry.buffers) {
+    std::lock_guard<std::mutex> lock(buffer->mutex);
+    num_spans += buffer->spans.size();
+  }
+  return num_spans;
+}
+
+void Tracer::SetThreadName(const std::string& thread_name) {
+  ThreadBuffer* buffer = GetThreadBuffer();
+  std::lock_guard<std::mutex> lock(buffer->mutex);
+  buffer->thread_name = thread_name;
+}
+
+void Tracer::RecordSpan(const char* name,
+                        const int64_t start_time_us,
+                        const int64_t end_time_us) {
+  ThreadBuffer* buffer = GetThreadBuffer();
+  std::lock_guard<std::mutex> lock(buffer->mutex);
+  buffer->spans.push_back({name, start_time_us, end_time_us - start_time_us});
+}
+
+int64_t Tracer::NowInMicroseconds() {
+  static const std::chrono::steady_clock::time_point kStartTime =
+      std::chrono::steady_clock::now();
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+             std::chrono::steady_clock::now() - kStartTime)
+      .count();
+}
+
+std::string Tracer::ChromeTrace() {
+  std::ostringstream trace;
+  trace << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+  bool is_first_event = true;
+  const auto start_event = [&]() {
+    if (!is_first_event) {
+      trace << ",";
+    }
+    trace << "\n";
+    is_first_event = false;
+  };
+
+  ThreadBufferRegistry& registry = GetRegistry();
+  std::lock_guard<std::mutex> registry_lock(registry.mutex);
+  for (const auto& buffer : registry.buffers) {
+    std::lock_guard<std::mutex> lock(buffer->mutex);
+    if (!buffer->thread_name.empty()) {
+      start_event();
+      trace << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":"
+            << buffer->thread_index << ",\"args\":{\"name\":"
+            << ToJsonString(buffer->thread_name) << "}}";
+    }
+
+    // The names are string literals, so each name is only escaped once.
+    std::unordered_map<const char*, std::string> escaped_names;
+    for (const Span& span : buffer->spans) {
+      auto it = escaped_names.find(span.name);
+      if (it == escaped_names.end()) {
+        it = escaped_names.emplace(span.name, ToJsonString(span.name)).first;
+      }
+      start_event();
+      trace << "{\"name\":" << it->second
+            << ",\"cat\":\"theia\",\"ph\":\"X\",\"pid\":0,\"tid\":"
+            << buffer->thread_index << ",\"ts\":" << span.start_time_us
+            << ",\"dur\":" << span.duration_us << "}";
+    }
+  }
+  trace << "\n]}\n";
+  return trace.str();
+}
+
+bool Tracer::WriteChromeTrace(const std::string& filepath) {
+  std::ofstream trace_file(filepath);
+  if (!trace_file.is_open()) {
+    LOG(ERROR) << "Could not open the trace file " << filepath
+               << " for writing.";
+    return false;
+  }
+  trace_file << ChromeTrace();
+  return trace_file.good();
+}
+
+}  // namespace theia
@@ -0,0 +1,138 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#ifndef THEIA_UTIL_TRACE_H_
+#define THEIA_UTIL_TRACE_H_
+
+#include <stdint.h>
+#include <atomic>
+#include <string>
+
+#include "theia/util/util.h"
+
+namespace theia {
+
+// A lightweight tracer that records when the stages of the pipeline start and
+// end so that a long job can be inspected afterwards in chrome://tracing or
+// https://ui.perfetto.dev. Stages are traced with THEIA_TRACE_SCOPE, which
+// records a span from its declaration to the end of the enclosing scope:
+//
+//   void BundleAdjuster::Optimize() {
+//     THEIA_TRACE_SCOPE("BundleAdjuster::Optimize");
+//     ...
+//   }
+//
+// Spans nest by time on each thread. Each thread records its spans into its
+// own buffer so that threads do not contend while tracing. Tracing is disabled
+// by default, and a disabled span costs a single relaxed atomic load.
+//
+// Usage:
+//   Tracer::Enable();
+//   reconstruction_builder.BuildReconstruction(&reconstructions);
+//   Tracer::WriteChromeTrace("trace.json");
+class Tracer {
+ public:
+  // Starts or stops recording spans. Spans that are open when tracing is
+  // enabled are not recorded.
+  static void Enable();
+  static void Disable();
+  static bool IsEnabled() {
+    return is_enabled_.load(std::memory_order_relaxed);
+  }
+
+  // Removes all recorded spans.
+  static void Clear();
+
+  // The number of recorded spans of all threads.
+  static int NumSpans();
+
+  // Names the calling thread in the exported trace.
+  static void SetThreadName(const std::string& thread_name);
+
+  // Records a span of the calling thread. The name must outlive the tracer,
+  // which is the case for string literals. Times are in microseconds as
+  // returned by NowInMicroseconds.
+  static void RecordSpan(const char* name,
+                         const int64_t start_time_us,
+                         const int64_t end_time_us);
+
+  // Microseconds since the tracer was first used.
+  static int64_t NowInMicroseconds();
+
+  // Returns the recorded spans in the Chrome trace event format, a JSON object
+  // with one complete ("X") event per span, which is also read by Perfetto.
+  static std::string ChromeTrace();
+
+  // Writes ChromeTrace to the file. Returns false if the file could not be
+  // written.
+  static bool WriteChromeTrace(const std::string& filepath);
+
+ private:
+  static std::atomic<bool> is_enabled_;
+};
+
+// Records a span from its construction to its destruction if tracing is
+// enabled at construction. Use THEIA_TRACE_SCOPE instead of declaring it
+// directly.
+class ScopedTrace {
+ public:
+  explicit ScopedTrace(const char* name)
+      : name_(Tracer::IsEnabled() ? name : nullptr),
+        start_time_us_(name_ != nullptr ? Tracer::NowInMicroseconds() : 0) {}
+
+  ~ScopedTrace() {
+    if (name_ != nullptr) {
+      Tracer::RecordSpan(name_, start_time_us_, Tracer::NowInMicroseconds());
+    }
+  }
+
+ private:
+  const char* const name_;
+  const int64_t start_time_us_;
+
+  DISALLOW_COPY_AND_ASSIGN(ScopedTrace);
+};
+
+#define THEIA_TRACE_CONCATENATE_IMPL(x, y) x##y
+#define THEIA_TRACE_CONCATENATE(x, y) THEIA_TRACE_CONCATENATE_IMPL(x, y)
+
+// Traces the enclosing scope under the given name, which must be a string
+// literal.
+#define THEIA_TRACE_SCOPE(name)                                                \
+  ::theia::ScopedTrace THEIA_TRACE_CONCATENATE(theia_scoped_trace_, __LINE__)( \
+      name)
+
+}  // namespace theia
+
+#endif  // THEIA_UTIL_TRACE_H_
@@ -0,0 +1,157 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#include <fstream>  // NOLINT
+#include <string>
+#include <thread>  // NOLINT
+#include <unordered_map>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "theia/util/json.h"
+#include "theia/util/trace.h"
+
+namespace theia {
+
+namespace {
+
+// Returns the complete events of the trace by name.
+std::unordered_map<std::string, nlohmann::json> SpansByName(
+    const std::string& trace) {
+  const nlohmann::json json = nlohmann::json::parse(trace);
+  std::unordered_map<std::string, nlohmann::json> spans;
+  for (const nlohmann::json& event : json["traceEvents"]) {
+    if (event["ph"] == "X") {
+      spans[event["name"].get<std::string>()] = event;
+    }
+  }
+  return spans;
+}
+
+}  // namespace
+
+TEST(Tracer, DisabledTracerRecordsNothing) {
+  Tracer::Disable();
+  Tracer::Clear();
+  {
+    THEIA_TRACE_SCOPE("disabled");
+  }
+  EXPECT_EQ(Tracer::NumSpans(), 0);
+}
+
+TEST(Tracer, NestedSpans) {
+  Tracer::Clear();
+  Tracer::Enable();
+  {
+    THEIA_TRACE_SCOPE("outer");
+    {
+      THEIA_TRACE_SCOPE("inner");
+      std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+  }
+  Tracer::Disable();
+  EXPECT_EQ(Tracer::NumSpans(), 2);
+
+  const auto spans = SpansByName(Tracer::ChromeTrace());
+  ASSERT_EQ(spans.size(), 2);
+  const nlohmann::json& outer = spans.at("outer");
+  const nlohmann::json& inner = spans.at("inner");
+  EXPECT_EQ(outer["tid"], inner["tid"]);
+  EXPECT_GE(inner["dur"].get<int64_t>(), 2000);
+
+  // The inner span lies within the outer span.
+  EXPECT_LE(outer["ts"].get<int64_t>(), inner["ts"].get<int64_t>());
+  EXPECT_GE(outer["ts"].get<int64_t>() + outer["dur"].get<int64_t>(),
+            inner["ts"].get<int64_t>() + inner["dur"].get<int64_t>());
+}
+
+TEST(Tracer, ThreadsHaveSeparateBuffers) {
+  static const int kNumThreads = 4;
+  static const int kNumSpansPerThread = 100;
+  Tracer::Clear();
+  Tracer::Enable();
+  std::vector<std::thread> threads;
+  for (int i = 0; i < kNumThreads; i++) {
+    threads.emplace_back([i]() {
+      Tracer::SetThreadName("worker " + std::to_string(i));
+      for (int j = 0; j < kNumSpansPerThread; j++) {
+        THEIA_TRACE_SCOPE("work");
+      }
+    });
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+  Tracer::Disable();
+  EXPECT_EQ(Tracer::NumSpans(), kNumThreads * kNumSpansPerThread);
+
+  // Each thread has its own id in the trace and is named.
+  const nlohmann::json json = nlohmann::json::parse(Tracer::ChromeTrace());
+  std::unordered_map<int, int> num_spans_per_thread;
+  int num_named_threads = 0;
+  for (const nlohmann::json& event : json["traceEvents"]) {
+    if (event["ph"] == "X") {
+      ++num_spans_per_thread[event["tid"].get<int>()];
+    } else if (event["ph"] == "M" &&
+               event["args"]["name"].get<std::string>().find("worker") == 0) {
+      ++num_named_threads;
+    }
+  }
+  EXPECT_EQ(num_spans_per_thread.size(), kNumThreads);
+  for (const auto& num_spans : num_spans_per_thread) {
+    EXPECT_EQ(num_spans.second, kNumSpansPerThread);
+  }
+  EXPECT_EQ(num_named_threads, kNumThreads);
+}
+
+TEST(Tracer, WriteChromeTrace) {
+  Tracer::Clear();
+  Tracer::Enable();
+  {
+    THEIA_TRACE_SCOPE("written");
+  }
+  Tracer::Disable();
+
+  const std::string filepath =
+      testing::internal::TempDir() + "/tracer_write_chrome_trace.json";
+  ASSERT_TRUE(Tracer::WriteChromeTrace(filepath));
+  std::ifstream trace_file(filepath);
+  const std::string trace((std::istreambuf_iterator<char>(trace_file)),
+                          std::istreambuf_iterator<char>());
+  EXPECT_EQ(SpansByName(trace).count("written"), 1);
+  Tracer::Clear();
+}
+
+}  // namespace theia
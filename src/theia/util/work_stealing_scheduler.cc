@@ -0,0 +1,207 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#include "theia/util/work_stealing_scheduler.h"
+
+#include <glog/logging.h>
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <numeric>
+#include <vector>
+
+#include "theia/util/executor.h"
+#include "theia/util/timer.h"
+
+namespace theia {
+
+WorkStealingScheduler::WorkStealingScheduler(const int num_threads)
+    : num_threads_(num_threads) {
+  CHECK_GT(num_threads_, 0);
+  queues_.reserve(num_threads_);
+  for (int i = 0; i < num_threads_; i++) {
+    queues_.emplace_back(new WorkerQueue);
+  }
+}
+
+void WorkStealingScheduler::AssignTasks(const std::vector<double>& costs) {
+  std::vector<int> sorted_tasks(costs.size());
+  std::iota(sorted_tasks.begin(), sorted_tasks.end(), 0);
+  std::stable_sort(sorted_tasks.begin(),
+                   sorted_tasks.end(),
+                   [&costs](const int task1, const int task2) {
+                     return costs[task1] > costs[task2];
+                   });
+
+  // Longest processing time first: give each task to the least loaded worker.
+  for (const int task : sorted_tasks) {
+    WorkerQueue* least_loaded_queue = queues_[0].get();
+    for (int i = 1; i < num_threads_; i++) {
+      if (queues_[i]->remaining_cost < least_loaded_queue->remaining_cost) {
+        least_loaded_queue = queues_[i].get();
+      }
+    }
+    least_loaded_queue->tasks.push_back(task);
+    least_loaded_queue->remaining_cost += costs[task];
+  }
+}
+
+bool WorkStealingScheduler::NextTask(const int worker_id,
+                                     const std::vector<double>& costs,
+                                     int* task,
+                                     bool* is_stolen) {
+  // Run the most expensive task of our own queue first.
+  {
+    WorkerQueue* queue = queues_[worker_id].get();
+    std::lock_guard<std::mutex> lock(queue->mutex);
+    if (!queue->tasks.empty()) {
+      *task = queue->tasks.front();
+      queue->tasks.pop_front();
+      queue->remaining_cost -= costs[*task];
+      *is_stolen = false;
+      return true;
+    }
+  }
+
+  // Otherwise steal the cheapest task of the worker with the most remaining
+  // work, preferring the workers on the same NUMA node. The victim may be
+  // emptied by others in the meantime, in which case we look for a new victim.
+  const int numa_node = queues_[worker_id]->numa_node.load();
+  while (true) {
+    WorkerQueue* victim = nullptr;
+    double max_remaining_cost = -1.0;
+    bool victim_is_on_same_node = false;
+    for (int i = 0; i < num_threads_; i++) {
+      if (i == worker_id) {
+        continue;
+      }
+      const bool is_on_same_node =
+          numa_node >= 0 && queues_[i]->numa_node.load() == numa_node;
+      if (victim_is_on_same_node && !is_on_same_node) {
+        continue;
+      }
+      std::lock_guard<std::mutex> lock(queues_[i]->mutex);
+      if (is_on_same_node && !victim_is_on_same_node &&
+          !queues_[i]->tasks.empty()) {
+        max_remaining_cost = queues_[i]->remaining_cost;
+        victim = queues_[i].get();
+        victim_is_on_same_node = true;
+        continue;
+      }
+      if (!queues_[i]->tasks.empty() &&
+          queues_[i]->remaining_cost > max_remaining_cost) {
+        max_remaining_cost = queues_[i]->remaining_cost;
+        victim = queues_[i].get();
+      }
+    }
+
+    // Tasks are never added during Run() so no task remains anywhere.
+    if (victim == nullptr) {
+      return false;
+    }
+
+    std::lock_guard<std::mutex> lock(victim->mutex);
+    if (!victim->tasks.empty()) {
+      *task = victim->tasks.back();
+      victim->tasks.pop_back();
+      victim->remaining_cost -= costs[*task];
+      *is_stolen = true;
+      return true;
+    }
+  }
+}
+
+int WorkStealingScheduler::PeekNextTask(const int thread_id) {
+  WorkerQueue* queue = queues_[thread_id].get();
+  std::lock_guard<std::mutex> lock(queue->mutex);
+  return queue->tasks.empty() ? -1 : queue->tasks.front();
+}
+
+void WorkStealingScheduler::RunWorker(
+    const int worker_id,
+    const std::vector<double>& costs,
+    const std::function<void(const int, const int)>& task_function) {
+  WorkerStatistics& statistics = worker_statistics_[worker_id];
+  if (num_threads_ > 1) {
+    queues_[worker_id]->numa_node = Executor::Global()->CurrentNumaNode();
+  }
+  Timer wall_timer;
+  Timer task_timer;
+  int task;
+  bool is_stolen;
+  while (NextTask(worker_id, costs, &task, &is_stolen)) {
+    task_timer.Reset();
+    task_function(worker_id, task);
+    statistics.busy_time_in_seconds += task_timer.ElapsedTimeInSeconds();
+    ++statistics.num_tasks;
+    if (is_stolen) {
+      ++statistics.num_stolen_tasks;
+    }
+  }
+  statistics.wall_time_in_seconds = wall_timer.ElapsedTimeInSeconds();
+}
+
+void WorkStealingScheduler::Run(
+    const std::vector<double>& costs,
+    const std::function<void(const int, const int)>& task_function) {
+  worker_statistics_.assign(num_threads_, WorkerStatistics());
+  for (int i = 0; i < num_threads_; i++) {
+    queues_[i]->tasks.clear();
+    queues_[i]->remaining_cost = 0.0;
+    queues_[i]->numa_node = -1;
+  }
+  AssignTasks(costs);
+
+  // Run the tasks directly when there is only one worker.
+  if (num_threads_ == 1) {
+    RunWorker(0, costs, task_function);
+    return;
+  }
+
+  // The workers run on the threads of the global executor and the calling
+  // thread runs the first worker. If the executor is busy the calling thread
+  // steals the tasks of the workers that have not started yet.
+  TaskGroup task_group;
+  for (int i = 1; i < num_threads_; i++) {
+    task_group.Run([this, i, &costs, &task_function]() {
+      RunWorker(i, costs, task_function);
+    });
+  }
+  RunWorker(0, costs, task_function);
+  // Wait for all workers to finish.
+  task_group.Wait();
+}
+
+}  // namespace theia
@@ -0,0 +1,133 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#ifndef THEIA_UTIL_WORK_STEALING_SCHEDULER_H_
+#define THEIA_UTIL_WORK_STEALING_SCHEDULER_H_
+
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <vector>
+
+#include "theia/util/util.h"
+
+namespace theia {
+
+// Runs a set of independent tasks with uneven costs on multiple threads. The
+// tasks are sorted by their estimated cost and dealt out largest first to the
+// worker with the least assigned cost so far. Each worker runs its own queue
+// from the most to the least expensive task, and a worker whose queue is empty
+// steals the cheapest remaining task from the worker with the most remaining
+// cost. This keeps all threads busy until the very end even when the cost
+// estimates are inaccurate. If the executor threads are pinned to NUMA nodes
+// (see ScopedNumaAffinity), a worker steals from the workers on its own node
+// first so that tasks stay close to the data that their worker prepared.
+//
+// Example usage:
+//
+//   WorkStealingScheduler scheduler(num_threads);
+//   scheduler.Run(costs, [&](const int thread_id, const int task) {
+//     ProcessTask(task);
+//   });
+//   for (const auto& stats : scheduler.GetWorkerStatistics()) { ... }
+class WorkStealingScheduler {
+ public:
+  struct WorkerStatistics {
+    // Number of tasks run by the worker, including the stolen tasks.
+    int num_tasks = 0;
+    int num_stolen_tasks = 0;
+
+    // The time spent running tasks and the wall clock time from the start of
+    // Run() until the worker ran out of tasks.
+    double busy_time_in_seconds = 0.0;
+    double wall_time_in_seconds = 0.0;
+  };
+
+  explicit WorkStealingScheduler(const int num_threads);
+
+  // Runs task_function(thread_id, i) exactly once for each task i in
+  // [0, costs.size()), where costs[i] is the estimated cost of task i and
+  // thread_id in [0, num_threads) identifies the worker running the task. Tasks
+  // with the same thread_id never run concurrently, so thread_id may be used to
+  // index per-thread state. Blocks until all tasks have finished.
+  void Run(const std::vector<double>& costs,
+           const std::function<void(const int, const int)>& task_function);
+
+  // Returns the task that the worker thread_id runs next unless another worker
+  // steals it first, or -1 if the queue of the worker is empty. task_function
+  // may call this to prepare the input of its next task while it runs the
+  // current one.
+  int PeekNextTask(const int thread_id);
+
+  // The statistics of each worker thread for the last call to Run().
+  const std::vector<WorkerStatistics>& GetWorkerStatistics() const {
+    return worker_statistics_;
+  }
+
+ private:
+  struct WorkerQueue {
+    std::mutex mutex;
+    // Task ids ordered from the most to the least expensive.
+    std::deque<int> tasks;
+    double remaining_cost = 0.0;
+    // The NUMA node of the thread running the worker, or -1 if it is unknown.
+    std::atomic<int> numa_node{-1};
+  };
+
+  // Distributes the tasks to the worker queues.
+  void AssignTasks(const std::vector<double>& costs);
+
+  // Gets the next task for the worker, stealing one from another worker if the
+  // queue of the worker is empty. Returns false if no tasks remain.
+  bool NextTask(const int worker_id, const std::vector<double>& costs,
+                int* task, bool* is_stolen);
+
+  // The loop executed by each worker thread.
+  void RunWorker(
+      const int worker_id,
+      const std::vector<double>& costs,
+      const std::function<void(const int, const int)>& task_function);
+
+  const int num_threads_;
+  std::vector<std::unique_ptr<WorkerQueue> > queues_;
+  std::vector<WorkerStatistics> worker_statistics_;
+
+  DISALLOW_COPY_AND_ASSIGN(WorkStealingScheduler);
+};
+
+}  // namespace theia
+
+#endif  // THEIA_UTIL_WORK_STEALING_SCHEDULER_H_
@@ -0,0 +1,129 @@
+// Copyright (C) 2026 agent
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//
+//     * Neither the name of The Regents or University of California nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Please contact the author of this library if you have any questions.
+// Author: agent (agent@local)
+
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "theia/util/work_stealing_scheduler.h"
+
+namespace theia {
+
+TEST(WorkStealingSchedulerTest, RunsEachTaskOnce) {
+  static const int kNumTasks = 1000;
+  std::vector<double> costs(kNumTasks);
+  for (int i = 0; i < kNumTasks; i++) {
+    costs[i] = i % 17;
+  }
+
+  std::vector<std::atomic<int> > num_runs(kNumTasks);
+  for (auto& num_run : num_runs) {
+    num_run = 0;
+  }
+
+  WorkStealingScheduler scheduler(4);
+  scheduler.Run(costs, [&](const int thread_id, const int task) {
+    EXPECT_GE(thread_id, 0);
+    EXPECT_LT(thread_id, 4);
+    ++num_runs[task];
+  });
+  for (int i = 0; i < kNumTasks; i++) {
+    EXPECT_EQ(num_runs[i], 1);
+  }
+
+  int num_tasks = 0;
+  for (const auto& statistics : scheduler.GetWorkerStatistics()) {
+    num_tasks += statistics.num_tasks;
+    EXPECT_LE(statistics.busy_time_in_seconds,
+              statistics.wall_time_in_seconds);
+  }
+  EXPECT_EQ(num_tasks, kNumTasks);
+}
+
+TEST(WorkStealingSchedulerTest, RunsMostExpensiveTasksFirst) {
+  const std::vector<double> costs = {1.0, 5.0, 3.0, 4.0, 2.0};
+  std::vector<int> order;
+  WorkStealingScheduler scheduler(1);
+  scheduler.Run(costs, [&](const int thread_id, const int task) {
+    order.push_back(task);
+  });
+
+  const std::vector<int> expected_order = {1, 3, 2, 4, 0};
+  EXPECT_EQ(order, expected_order);
+}
+
+TEST(WorkStealingSchedulerTest, PeekNextTask) {
+  const std::vector<double> costs = {1.0, 5.0, 3.0, 4.0, 2.0};
+  std::vector<int> next_tasks;
+  WorkStealingScheduler scheduler(1);
+  scheduler.Run(costs, [&](const int thread_id, const int task) {
+    next_tasks.push_back(scheduler.PeekNextTask(thread_id));
+  });
+
+  const std::vector<int> expected_next_tasks = {3, 2, 4, 0, -1};
+  EXPECT_EQ(next_tasks, expected_next_tasks);
+}
+
+TEST(WorkStealingSchedulerTest, IdleWorkersStealTasks) {
+  // The first task takes much longer than estimated, so the worker that runs
+  // it falls behind and the other worker must steal its remaining tasks.
+  static const int kNumTasks = 20;
+  std::vector<double> costs(kNumTasks, 1.0);
+  costs[0] = 10.0;
+
+  WorkStealingScheduler scheduler(2);
+  scheduler.Run(costs, [&](const int thread_id, const int task) {
+    if (task == 0) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    }
+  });
+
+  int num_stolen_tasks = 0;
+  for (const auto& statistics : scheduler.GetWorkerStatistics()) {
+    num_stolen_tasks += statistics.num_stolen_tasks;
+  }
+  EXPECT_GT(num_stolen_tasks, 0);
+}
+
+TEST(WorkStealingSchedulerTest, NoTasks) {
+  WorkStealingScheduler scheduler(3);
+  scheduler.Run(std::vector<double>(),
+                [](const int thread_id, const int task) { FAIL(); });
+  EXPECT_EQ(scheduler.GetWorkerStatistics().size(), 3);
+}
+
+}  // namespace theia